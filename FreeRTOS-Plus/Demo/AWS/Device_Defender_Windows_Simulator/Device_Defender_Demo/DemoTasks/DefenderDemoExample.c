@@ -68,6 +68,9 @@
 /* JSON Library. */
 #include "core_json.h"
 
+/* TinyCBOR library for decoding the CBOR responses. */
+#include "cbor.h"
+
 /* Device Defender Client Library. */
 #include "defender.h"
 
@@ -80,6 +83,9 @@
 /* Report builder. */
 #include "report_builder.h"
 
+/* Arena allocator. */
+#include "arena.h"
+
 /**
  * democonfigTHING_NAME is required. Throw compilation error if it is not defined.
  */
@@ -109,6 +115,58 @@
  */
 #define DEFENDER_RESPONSE_REPORT_ID_FIELD_LENGTH    ( sizeof( DEFENDER_RESPONSE_REPORT_ID_FIELD ) - 1 )
 
+/**
+ * @brief Send the report in CBOR rather than JSON, see demo_config.h.
+ */
+#ifndef democonfigDEVICE_METRICS_REPORT_USE_CBOR
+    #define democonfigDEVICE_METRICS_REPORT_USE_CBOR    0
+#endif
+
+/**
+ * @brief Compare the size and generation time of both formats, see
+ * demo_config.h.
+ */
+#ifndef democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS
+    #define democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS    0
+#endif
+
+/**
+ * @brief Number of reports generated in each format to time them when
+ * #democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS is 1.
+ */
+#define DEFENDER_REPORT_COMPARE_ITERATIONS    ( 1000U )
+
+/**
+ * @brief Size of the arena holding the metrics of one report, which is reset
+ * after each report is generated.  It must hold a TaskStatus_t per task.
+ */
+#ifndef democonfigDEVICE_METRICS_ARENA_SIZE
+    #define democonfigDEVICE_METRICS_ARENA_SIZE    ( 32U * sizeof( TaskStatus_t ) )
+#endif
+
+/**
+ * @brief The topics and APIs of the report format that is sent.
+ */
+#if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+    #define DEFENDER_REPORT_ACCEPTED_API              DefenderCborReportAccepted
+    #define DEFENDER_REPORT_REJECTED_API              DefenderCborReportRejected
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC            DEFENDER_API_CBOR_ACCEPTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH     DEFENDER_API_LENGTH_CBOR_ACCEPTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_REJECTED_TOPIC            DEFENDER_API_CBOR_REJECTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_REJECTED_TOPIC_LENGTH     DEFENDER_API_LENGTH_CBOR_REJECTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_PUBLISH_TOPIC             DEFENDER_API_CBOR_PUBLISH( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_PUBLISH_TOPIC_LENGTH      DEFENDER_API_LENGTH_CBOR_PUBLISH( THING_NAME_LENGTH )
+#else
+    #define DEFENDER_REPORT_ACCEPTED_API              DefenderJsonReportAccepted
+    #define DEFENDER_REPORT_REJECTED_API              DefenderJsonReportRejected
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC            DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH     DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_REJECTED_TOPIC            DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_REJECTED_TOPIC_LENGTH     DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH )
+    #define DEFENDER_REPORT_PUBLISH_TOPIC             DEFENDER_API_JSON_PUBLISH( democonfigTHING_NAME )
+    #define DEFENDER_REPORT_PUBLISH_TOPIC_LENGTH      DEFENDER_API_LENGTH_JSON_PUBLISH( THING_NAME_LENGTH )
+#endif
+
 /**
  * @brief The maximum number of times to run the loop in this demo.
  *
@@ -210,7 +268,14 @@ static ReportStatus_t xReportStatus;
 /**
  * @brief Buffer for generating the Device Defender report.
  */
-static char pcDeviceMetricsJsonReport[ democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE ];
+static uint8_t ucDeviceMetricsReport[ democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE ];
+
+/**
+ * @brief Arena the task status array of each report is allocated from, and
+ * its memory.
+ */
+static Arena_t xDeviceMetricsArena;
+static uint8_t ucDeviceMetricsArenaBuffer[ democonfigDEVICE_METRICS_ARENA_SIZE ];
 
 /**
  * @brief Report ID sent in the defender report.
@@ -237,7 +302,8 @@ static void prvPublishCallback( MQTTContext_t * pxMqttContext,
 /**
  * @brief Collect all the metrics to be sent in the Device Defender report.
  *
- * On success, caller is responsible for freeing xDeviceMetrics.pxTaskStatusArray.
+ * The task status array is allocated from #xDeviceMetricsArena, which the
+ * caller resets once the report has been generated.
  *
  * @return true if all the metrics are successfully collected;
  * false otherwise.
@@ -254,6 +320,18 @@ static bool prvCollectDeviceMetrics( void );
  */
 static bool prvGenerateDeviceMetricsReport( size_t * pxOutReportLength );
 
+#if ( democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS == 1 )
+
+/**
+ * @brief Generate the report #DEFENDER_REPORT_COMPARE_ITERATIONS times in each
+ * format and log the size and the average generation time of each.
+ *
+ * The report buffer is overwritten, so call it before the report to send is
+ * generated.
+ */
+    static void prvCompareReportFormats( void );
+#endif
+
 /**
  * @brief Subscribe to the Device Defender topics.
  *
@@ -283,7 +361,8 @@ static bool prvPublishDeviceMetricsReport( size_t xReportLength );
 /**
  * @brief Validate the response received from the AWS IoT Device Defender Service.
  *
- * This functions checks that a valid JSON is received and the report ID
+ * This functions checks that a valid JSON or CBOR document, as per
+ * #democonfigDEVICE_METRICS_REPORT_USE_CBOR, is received and the report ID
  * is same as was sent in the published report.
  *
  * @param[in] pcDefenderResponse The defender response to validate.
@@ -297,6 +376,78 @@ static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
 
 /*-----------------------------------------------------------*/
 
+#if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+
+static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
+                                         size_t xDefenderResponseLength )
+{
+    bool xStatus = false;
+    CborError xCborRet;
+    CborParser xParser;
+    CborValue xMap;
+    CborValue xValue;
+    uint64_t ullReportIdInResponse = 0U;
+
+    configASSERT( pcDefenderResponse != NULL );
+
+    /* Is the response a CBOR map? */
+    xCborRet = cbor_parser_init( ( const uint8_t * ) pcDefenderResponse,
+                                 xDefenderResponseLength,
+                                 0,
+                                 &xParser,
+                                 &xMap );
+
+    if( ( xCborRet != CborNoError ) || ( cbor_value_get_type( &xMap ) != CborMapType ) )
+    {
+        LogError( ( "Invalid CBOR response of %u bytes from AWS IoT Device Defender Service.",
+                    ( unsigned int ) xDefenderResponseLength ) );
+        xCborRet = CborErrorIllegalType;
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        /* Search the ReportId key in the response. */
+        xCborRet = cbor_value_map_find_value( &xMap, DEFENDER_RESPONSE_REPORT_ID_FIELD, &xValue );
+
+        if( ( xCborRet != CborNoError ) || ( cbor_value_get_type( &xValue ) != CborIntegerType ) )
+        {
+            LogError( ( "%s key not found in the CBOR response from the "
+                        "AWS IoT Device Defender Service.",
+                        DEFENDER_RESPONSE_REPORT_ID_FIELD ) );
+            xCborRet = CborErrorIllegalType;
+        }
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_value_get_uint64( &xValue, &ullReportIdInResponse );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        /* Is the report ID present in the response same as was sent in the
+         * published report? */
+        if( ullReportIdInResponse == ulReportId )
+        {
+            LogInfo( ( "A valid response with report ID %u received from the "
+                       "AWS IoT Device Defender Service.", ulReportId ) );
+            xStatus = true;
+        }
+        else
+        {
+            LogError( ( "Unexpected %s found in the response from the AWS"
+                        "IoT Device Defender Service. Expected: %u, Found: %u.",
+                        DEFENDER_RESPONSE_REPORT_ID_FIELD,
+                        ulReportId,
+                        ( uint32_t ) ullReportIdInResponse ) );
+        }
+    }
+
+    return xStatus;
+}
+
+#else /* democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 */
+
 static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
                                          size_t xDefenderResponseLength )
 {
@@ -365,6 +516,8 @@ static bool prvValidateDefenderResponse( const char * pcDefenderResponse,
 
     return xStatus;
 }
+
+#endif /* democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 */
 /*-----------------------------------------------------------*/
 
 static void prvPublishCallback( MQTTContext_t * pxMqttContext,
@@ -403,7 +556,7 @@ static void prvPublishCallback( MQTTContext_t * pxMqttContext,
 
         if( xStatus == DefenderSuccess )
         {
-            if( xApi == DefenderJsonReportAccepted )
+            if( xApi == DEFENDER_REPORT_ACCEPTED_API )
             {
                 /* Check if the response is valid and is for the report we
                  * published. If so, report was accepted. */
@@ -412,13 +565,18 @@ static void prvPublishCallback( MQTTContext_t * pxMqttContext,
 
                 if( xValidationResult == true )
                 {
-                    LogInfo( ( "The defender report was accepted by the service. Response: %.*s.",
-                               ( int ) pxPublishInfo->payloadLength,
-                               ( const char * ) pxPublishInfo->pPayload ) );
+                    #if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+                        LogInfo( ( "The defender report was accepted by the service. Response length: %u.",
+                                   ( unsigned int ) pxPublishInfo->payloadLength ) );
+                    #else
+                        LogInfo( ( "The defender report was accepted by the service. Response: %.*s.",
+                                   ( int ) pxPublishInfo->payloadLength,
+                                   ( const char * ) pxPublishInfo->pPayload ) );
+                    #endif
                     xReportStatus = ReportStatusAccepted;
                 }
             }
-            else if( xApi == DefenderJsonReportRejected )
+            else if( xApi == DEFENDER_REPORT_REJECTED_API )
             {
                 /* Check if the response is valid and is for the report we
                  * published. If so, report was rejected. */
@@ -427,9 +585,14 @@ static void prvPublishCallback( MQTTContext_t * pxMqttContext,
 
                 if( xValidationResult == true )
                 {
-                    LogError( ( "The defender report was rejected by the service. Response: %.*s.",
-                                ( int ) pxPublishInfo->payloadLength,
-                                ( const char * ) pxPublishInfo->pPayload ) );
+                    #if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+                        LogError( ( "The defender report was rejected by the service. Response length: %u.",
+                                    ( unsigned int ) pxPublishInfo->payloadLength ) );
+                    #else
+                        LogError( ( "The defender report was rejected by the service. Response: %.*s.",
+                                    ( int ) pxPublishInfo->payloadLength,
+                                    ( const char * ) pxPublishInfo->pPayload ) );
+                    #endif
                     xReportStatus = ReportStatusRejected;
                 }
             }
@@ -465,13 +628,38 @@ static bool prvCollectDeviceMetrics( void )
     UBaseType_t uxNumTasksRunning;
     TaskStatus_t pxTaskStatus = { 0 };
     TaskStatus_t * pxTaskStatusArray = NULL;
+    MetricsChanges_t xChanges = { 0 };
+
+    /* Walk the socket table once for all the network metrics below, and find
+     * what changed since the previous report. */
+    eStatus = eUpdateMetricsSnapshot( &( xChanges ) );
+
+    if( eStatus != eMetricsCollectorSuccess )
+    {
+        LogError( ( "eUpdateMetricsSnapshot failed. Status: %d.",
+                    eStatus ) );
+    }
+    else
+    {
+        LogInfo( ( "Since the previous report: TCP ports +%u -%u, UDP ports +%u -%u, "
+                   "connections +%u -%u.",
+                   ( unsigned int ) xChanges.uxTcpPortsOpened,
+                   ( unsigned int ) xChanges.uxTcpPortsClosed,
+                   ( unsigned int ) xChanges.uxUdpPortsOpened,
+                   ( unsigned int ) xChanges.uxUdpPortsClosed,
+                   ( unsigned int ) xChanges.uxConnectionsOpened,
+                   ( unsigned int ) xChanges.uxConnectionsClosed ) );
+    }
 
     /* Collect bytes and packets sent and received. */
-    eStatus = eGetNetworkStats( &( xNetworkStats ) );
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        eStatus = eGetNetworkStats( &( xNetworkStats ) );
+    }
 
     if( eStatus != eMetricsCollectorSuccess )
     {
-        LogError( ( "xGetNetworkStats failed. Status: %d.",
+        LogError( ( "Collecting the network stats failed. Status: %d.",
                     eStatus ) );
     }
 
@@ -523,11 +711,11 @@ static bool prvCollectDeviceMetrics( void )
         uxNumTasksRunning = uxTaskGetNumberOfTasks();
 
         /* Allocate pxTaskStatusArray */
-        pxTaskStatusArray = pvPortMalloc( uxNumTasksRunning * sizeof( TaskStatus_t ) );
+        pxTaskStatusArray = pvArenaAlloc( &xDeviceMetricsArena, uxNumTasksRunning * sizeof( TaskStatus_t ) );
 
         if( pxTaskStatusArray == NULL )
         {
-            LogError( ( "Cannot allocate memory for pxTaskStatusArray: pvPortMalloc() failed." ) );
+            LogError( ( "Cannot allocate memory for pxTaskStatusArray: increase democonfigDEVICE_METRICS_ARENA_SIZE." ) );
             eStatus = eMetricsCollectorCollectionFailed;
         }
     }
@@ -584,41 +772,118 @@ static bool prvCollectDeviceMetrics( void )
     {
         /* Free pxTaskStatusArray if we allocated it but did not add it to the
          * xDeviceMetrics struct. */
-        if( pxTaskStatusArray != NULL )
-        {
-            vPortFree( pxTaskStatusArray );
-        }
+        vArenaReset( &xDeviceMetricsArena );
     }
 
     return xStatus;
 }
 /*-----------------------------------------------------------*/
 
+#if ( democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS == 1 )
+
+    static void prvCompareReportFormats( void )
+    {
+        eReportBuilderStatus eJsonStatus = eReportBuilderSuccess;
+        eReportBuilderStatus eCborStatus = eReportBuilderSuccess;
+        size_t uxJsonLength = 0U;
+        size_t uxCborLength = 0U;
+        TickType_t xJsonTicks;
+        TickType_t xCborTicks;
+        TickType_t xStart;
+        uint32_t ulIteration;
+
+        xStart = xTaskGetTickCount();
+
+        for( ulIteration = 0U; ( ulIteration < DEFENDER_REPORT_COMPARE_ITERATIONS ) && ( eJsonStatus == eReportBuilderSuccess ); ulIteration++ )
+        {
+            eJsonStatus = eGenerateJsonReport( ( char * ) &( ucDeviceMetricsReport[ 0 ] ),
+                                               democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
+                                               &( xDeviceMetrics ),
+                                               democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
+                                               democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
+                                               ulReportId,
+                                               &( uxJsonLength ) );
+        }
+
+        xJsonTicks = xTaskGetTickCount() - xStart;
+        xStart = xTaskGetTickCount();
+
+        for( ulIteration = 0U; ( ulIteration < DEFENDER_REPORT_COMPARE_ITERATIONS ) && ( eCborStatus == eReportBuilderSuccess ); ulIteration++ )
+        {
+            eCborStatus = eGenerateCborReport( &( ucDeviceMetricsReport[ 0 ] ),
+                                               democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
+                                               &( xDeviceMetrics ),
+                                               democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
+                                               democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
+                                               ulReportId,
+                                               &( uxCborLength ) );
+        }
+
+        xCborTicks = xTaskGetTickCount() - xStart;
+
+        if( ( eJsonStatus != eReportBuilderSuccess ) || ( eCborStatus != eReportBuilderSuccess ) )
+        {
+            LogWarn( ( "Report format comparison skipped. JSON status: %d, CBOR status: %d.",
+                       eJsonStatus,
+                       eCborStatus ) );
+        }
+        else
+        {
+            LogInfo( ( "JSON report: %u bytes, %u us to generate. CBOR report: %u bytes, %u us to generate.",
+                       ( unsigned int ) uxJsonLength,
+                       ( unsigned int ) ( ( ( uint64_t ) xJsonTicks * portTICK_PERIOD_MS * 1000U ) / DEFENDER_REPORT_COMPARE_ITERATIONS ),
+                       ( unsigned int ) uxCborLength,
+                       ( unsigned int ) ( ( ( uint64_t ) xCborTicks * portTICK_PERIOD_MS * 1000U ) / DEFENDER_REPORT_COMPARE_ITERATIONS ) ) );
+        }
+    }
+
+#endif /* democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS == 1 */
+/*-----------------------------------------------------------*/
+
 static bool prvGenerateDeviceMetricsReport( size_t * pxOutReportLength )
 {
     bool xStatus = false;
     eReportBuilderStatus eReportBuilderStatus;
 
+    #if ( democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS == 1 )
+        prvCompareReportFormats();
+    #endif
+
     /* Generate the metrics report in the format expected by the AWS IoT Device
      * Defender Service. */
-    eReportBuilderStatus = eGenerateJsonReport( &( pcDeviceMetricsJsonReport[ 0 ] ),
-                                                democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
-                                                &( xDeviceMetrics ),
-                                                democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
-                                                democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
-                                                ulReportId,
-                                                pxOutReportLength );
+    #if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+        eReportBuilderStatus = eGenerateCborReport( &( ucDeviceMetricsReport[ 0 ] ),
+                                                    democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
+                                                    &( xDeviceMetrics ),
+                                                    democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
+                                                    democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
+                                                    ulReportId,
+                                                    pxOutReportLength );
+    #else
+        eReportBuilderStatus = eGenerateJsonReport( ( char * ) &( ucDeviceMetricsReport[ 0 ] ),
+                                                    democonfigDEVICE_METRICS_REPORT_BUFFER_SIZE,
+                                                    &( xDeviceMetrics ),
+                                                    democonfigDEVICE_METRICS_REPORT_MAJOR_VERSION,
+                                                    democonfigDEVICE_METRICS_REPORT_MINOR_VERSION,
+                                                    ulReportId,
+                                                    pxOutReportLength );
+    #endif
 
     if( eReportBuilderStatus != eReportBuilderSuccess )
     {
-        LogError( ( "GenerateJsonReport failed. Status: %d.",
+        LogError( ( "Generating the report failed. Status: %d.",
                     eReportBuilderStatus ) );
     }
     else
     {
-        LogDebug( ( "Generated Report: %.*s.",
-                    *pxOutReportLength,
-                    &( pcDeviceMetricsJsonReport[ 0 ] ) ) );
+        #if ( democonfigDEVICE_METRICS_REPORT_USE_CBOR == 1 )
+            LogDebug( ( "Generated CBOR report of %u bytes.",
+                        ( unsigned int ) *pxOutReportLength ) );
+        #else
+            LogDebug( ( "Generated Report: %.*s.",
+                        *pxOutReportLength,
+                        ( const char * ) &( ucDeviceMetricsReport[ 0 ] ) ) );
+        #endif
         xStatus = true;
     }
 
@@ -632,28 +897,28 @@ static bool prvSubscribeToDefenderTopics( void )
 
     /* Subscribe to defender topic for responses for accepted reports. */
     xStatus = xSubscribeToTopic( &xMqttContext,
-                                 DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME ),
-                                 DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH ) );
+                                 DEFENDER_REPORT_ACCEPTED_TOPIC,
+                                 DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH );
 
     if( xStatus == false )
     {
         LogError( ( "Failed to subscribe to defender topic: %.*s.",
-                    DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH ),
-                    DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME ) ) );
+                    DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH,
+                    DEFENDER_REPORT_ACCEPTED_TOPIC ) );
     }
 
     if( xStatus == true )
     {
         /* Subscribe to defender topic for responses for rejected reports. */
         xStatus = xSubscribeToTopic( &xMqttContext,
-                                     DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME ),
-                                     DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH ) );
+                                     DEFENDER_REPORT_REJECTED_TOPIC,
+                                     DEFENDER_REPORT_REJECTED_TOPIC_LENGTH );
 
         if( xStatus == false )
         {
             LogError( ( "Failed to subscribe to defender topic: %.*s.",
-                        DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH ),
-                        DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME ) ) );
+                        DEFENDER_REPORT_REJECTED_TOPIC_LENGTH,
+                        DEFENDER_REPORT_REJECTED_TOPIC ) );
         }
     }
 
@@ -667,15 +932,15 @@ static bool prvUnsubscribeFromDefenderTopics( void )
 
     /* Unsubscribe from defender accepted topic. */
     xStatus = xUnsubscribeFromTopic( &xMqttContext,
-                                     DEFENDER_API_JSON_ACCEPTED( democonfigTHING_NAME ),
-                                     DEFENDER_API_LENGTH_JSON_ACCEPTED( THING_NAME_LENGTH ) );
+                                     DEFENDER_REPORT_ACCEPTED_TOPIC,
+                                     DEFENDER_REPORT_ACCEPTED_TOPIC_LENGTH );
 
     if( xStatus == true )
     {
         /* Unsubscribe from defender rejected topic. */
         xStatus = xUnsubscribeFromTopic( &xMqttContext,
-                                         DEFENDER_API_JSON_REJECTED( democonfigTHING_NAME ),
-                                         DEFENDER_API_LENGTH_JSON_REJECTED( THING_NAME_LENGTH ) );
+                                         DEFENDER_REPORT_REJECTED_TOPIC,
+                                         DEFENDER_REPORT_REJECTED_TOPIC_LENGTH );
     }
 
     return xStatus;
@@ -685,9 +950,9 @@ static bool prvUnsubscribeFromDefenderTopics( void )
 static bool prvPublishDeviceMetricsReport( size_t xReportLength )
 {
     return xPublishToTopic( &xMqttContext,
-                            DEFENDER_API_JSON_PUBLISH( democonfigTHING_NAME ),
-                            DEFENDER_API_LENGTH_JSON_PUBLISH( THING_NAME_LENGTH ),
-                            &( pcDeviceMetricsJsonReport[ 0 ] ),
+                            DEFENDER_REPORT_PUBLISH_TOPIC,
+                            DEFENDER_REPORT_PUBLISH_TOPIC_LENGTH,
+                            ( const char * ) &( ucDeviceMetricsReport[ 0 ] ),
                             xReportLength );
 }
 /*-----------------------------------------------------------*/
@@ -707,6 +972,9 @@ void prvDefenderDemoTask( void * pvParameters )
     /* Set the pParams member of the network context with desired transport. */
     xNetworkContext.pParams = &xTlsTransportParams;
 
+    /* The metrics of each report are allocated from an arena. */
+    vArenaInitStatic( &xDeviceMetricsArena, ucDeviceMetricsArenaBuffer, sizeof( ucDeviceMetricsArenaBuffer ) );
+
     /* Start with report not received. */
     xReportStatus = ReportStatusNotReceived;
 
@@ -761,9 +1029,10 @@ void prvDefenderDemoTask( void * pvParameters )
         /******************** Subscribe to Defender topics. *******************/
 
         /* Attempt to subscribe to the AWS IoT Device Defender topics.
-         * Since this demo is using JSON, in prvSubscribeToDefenderTopics() we
-         * subscribe to the topics to which accepted and rejected responses are
-         * received from after publishing a JSON report.
+         * In prvSubscribeToDefenderTopics() we subscribe to the topics to which
+         * accepted and rejected responses are received from after publishing a
+         * JSON report, or a CBOR report when
+         * #democonfigDEVICE_METRICS_REPORT_USE_CBOR is 1.
          *
          * This demo uses a constant #democonfigTHING_NAME known at compile time
          * therefore we use macros to assemble defender topic strings.
@@ -821,7 +1090,7 @@ void prvDefenderDemoTask( void * pvParameters )
 
         /********************** Generate defender report. *********************/
 
-        /* The data needs to be incorporated into a JSON formatted report,
+        /* The data needs to be incorporated into a JSON or CBOR formatted report,
          * which follows the format expected by the Device Defender service.
          * This format is documented here:
          * https://docs.aws.amazon.com/iot/latest/developerguide/detect-device-side-metrics.html
@@ -831,12 +1100,9 @@ void prvDefenderDemoTask( void * pvParameters )
             LogInfo( ( "Generating Device Defender report..." ) );
             xStatus = prvGenerateDeviceMetricsReport( &( uxReportLength ) );
 
-            /* Free the allocated array in xDeviceMetrics struct which is not
-             * used anymore after prvGenerateDeviceMetricsReport(). This code is
-             * only reached when prvCollectDeviceMetrics succeeded, so
-             * xDeviceMetrics.pxTaskStatusArray is a valid allocation that needs
-             * to be freed. */
-            vPortFree( xDeviceMetrics.pxTaskStatusArray );
+            /* Free the array in xDeviceMetrics struct which is not used
+             * anymore after prvGenerateDeviceMetricsReport(). */
+            vArenaReset( &xDeviceMetricsArena );
 
             if( xStatus != true )
             {
@@ -847,10 +1113,10 @@ void prvDefenderDemoTask( void * pvParameters )
         /********************** Publish defender report. **********************/
 
         /* The report is then published to the Device Defender service. This report
-         * is published to the MQTT topic for publishing JSON reports. As before,
-         * we use the defender library macros to create the topic string, though
-         * #Defender_GetTopic could be used if the Thing name is acquired at
-         * run time */
+         * is published to the MQTT topic for publishing reports in the chosen
+         * format. As before, we use the defender library macros to create the
+         * topic string, though #Defender_GetTopic could be used if the Thing
+         * name is acquired at run time */
         if( xStatus == true )
         {
             LogInfo( ( "Publishing Device Defender report..." ) );
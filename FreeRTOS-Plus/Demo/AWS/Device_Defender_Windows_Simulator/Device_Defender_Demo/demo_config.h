@@ -285,4 +285,18 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define democonfigDEVICE_METRICS_REPORT_MINOR_VERSION    0
 
+/**
+ * @brief Set to 1 to send the device defender report in CBOR rather than JSON.
+ *
+ * The CBOR report has the same content and is about a third smaller, which
+ * saves bandwidth and broker processing on constrained links.
+ */
+#define democonfigDEVICE_METRICS_REPORT_USE_CBOR         0
+
+/**
+ * @brief Set to 1 to log the size and the generation time of the report in
+ * both formats before the report is sent.
+ */
+#define democonfigDEVICE_METRICS_REPORT_COMPARE_FORMATS  0
+
 #endif /* DEMO_CONFIG_H */
@@ -50,42 +50,320 @@
 #include "metrics_collector.h"
 /*-----------------------------------------------------------*/
 
-eMetricsCollectorStatus eGetNetworkStats( NetworkStats_t * pxOutNetworkStats )
+/**
+ * @brief The last two snapshots of the tcp_netstat metrics.
+ *
+ * The socket table is walked once per snapshot rather than once per metric,
+ * and the changes since the previous report are found by comparing the two.
+ */
+static MetricsType_t xSnapshots[ 2 ];
+
+/**
+ * @brief Index of the current snapshot in xSnapshots.
+ */
+static size_t uxCurrentSnapshot = 0U;
+
+/**
+ * @brief Number of snapshots taken, saturated at 2.
+ */
+static size_t uxSnapshotCount = 0U;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the current snapshot, taking the first one if needed.
+ *
+ * @param[out] ppxOutMetrics The current snapshot.
+ *
+ * @return #eMetricsCollectorSuccess if a snapshot is available;
+ * #eMetricsCollectorCollectionFailed if the collection methods failed.
+ */
+static eMetricsCollectorStatus prvGetSnapshot( const MetricsType_t ** ppxOutMetrics );
+
+/**
+ * @brief Find the ports of one list that are not in another.
+ *
+ * @param[in] pusPorts The ports to look for.
+ * @param[in] uxPortCount Number of ports in pusPorts.
+ * @param[in] pusOtherPorts The ports to look in.
+ * @param[in] uxOtherPortCount Number of ports in pusOtherPorts.
+ * @param[out] pusOutPortsArray The array to write the ports that were not found
+ * into. This can be NULL, if only the number of ports is needed.
+ * @param[in] xPortsArrayLength Length of pusOutPortsArray, if it is not NULL.
+ *
+ * @return The number of ports that were not found if pusOutPortsArray is NULL,
+ * else the number of ports written.
+ */
+static size_t prvPortsNotIn( const uint16_t * pusPorts,
+                             size_t uxPortCount,
+                             const uint16_t * pusOtherPorts,
+                             size_t uxOtherPortCount,
+                             uint16_t * pusOutPortsArray,
+                             size_t xPortsArrayLength );
+
+/**
+ * @brief Find the connections of one snapshot that are not in another.
+ *
+ * @param[in] pxMetrics The snapshot with the connections to look for.
+ * @param[in] pxOtherMetrics The snapshot to look in.
+ * @param[out] pxOutConnectionsArray The array to write the connections that
+ * were not found into. This can be NULL, if only the number is needed.
+ * @param[in] xConnectionsArrayLength Length of pxOutConnectionsArray, if it is
+ * not NULL.
+ *
+ * @return The number of connections that were not found if
+ * pxOutConnectionsArray is NULL, else the number of connections written.
+ */
+static size_t prvConnectionsNotIn( const MetricsType_t * pxMetrics,
+                                   const MetricsType_t * pxOtherMetrics,
+                                   Connection_t * pxOutConnectionsArray,
+                                   size_t xConnectionsArrayLength );
+
+/**
+ * @brief Get the current and the previous snapshots for a changes query.
+ *
+ * The previous snapshot is empty until two snapshots were taken, so that
+ * everything is reported as opened after the first one.
+ *
+ * @param[out] ppxOutCurrent The current snapshot.
+ * @param[out] ppxOutPrevious The previous snapshot.
+ *
+ * @return #eMetricsCollectorSuccess if a snapshot is available;
+ * #eMetricsCollectorCollectionFailed if the collection methods failed.
+ */
+static eMetricsCollectorStatus prvGetSnapshotPair( const MetricsType_t ** ppxOutCurrent,
+                                                   const MetricsType_t ** ppxOutPrevious );
+/*-----------------------------------------------------------*/
+
+static eMetricsCollectorStatus prvGetSnapshot( const MetricsType_t ** ppxOutMetrics )
 {
     eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
 
-    MetricsType_t xMetrics = { 0 };
+    if( uxSnapshotCount == 0U )
+    {
+        eStatus = eUpdateMetricsSnapshot( NULL );
+    }
+
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        *ppxOutMetrics = &( xSnapshots[ uxCurrentSnapshot ] );
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
+
+static eMetricsCollectorStatus prvGetSnapshotPair( const MetricsType_t ** ppxOutCurrent,
+                                                   const MetricsType_t ** ppxOutPrevious )
+{
+    static const MetricsType_t xEmptyMetrics = { 0 };
+    eMetricsCollectorStatus eStatus;
+
+    eStatus = prvGetSnapshot( ppxOutCurrent );
+
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        if( uxSnapshotCount > 1U )
+        {
+            *ppxOutPrevious = &( xSnapshots[ uxCurrentSnapshot ^ 1U ] );
+        }
+        else
+        {
+            *ppxOutPrevious = &( xEmptyMetrics );
+        }
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvPortsNotIn( const uint16_t * pusPorts,
+                             size_t uxPortCount,
+                             const uint16_t * pusOtherPorts,
+                             size_t uxOtherPortCount,
+                             uint16_t * pusOutPortsArray,
+                             size_t xPortsArrayLength )
+{
+    size_t uxIdx, uxOtherIdx;
+    size_t uxFound = 0U;
+
+    for( uxIdx = 0U; uxIdx < uxPortCount; uxIdx++ )
+    {
+        for( uxOtherIdx = 0U; uxOtherIdx < uxOtherPortCount; uxOtherIdx++ )
+        {
+            if( pusPorts[ uxIdx ] == pusOtherPorts[ uxOtherIdx ] )
+            {
+                break;
+            }
+        }
+
+        if( uxOtherIdx == uxOtherPortCount )
+        {
+            if( pusOutPortsArray == NULL )
+            {
+                uxFound++;
+            }
+            else if( uxFound < xPortsArrayLength )
+            {
+                pusOutPortsArray[ uxFound ] = pusPorts[ uxIdx ];
+                uxFound++;
+            }
+            else
+            {
+                LogWarn( ( "Ports returned truncated due to insufficient buffer size." ) );
+                break;
+            }
+        }
+    }
+
+    return uxFound;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvConnectionsNotIn( const MetricsType_t * pxMetrics,
+                                   const MetricsType_t * pxOtherMetrics,
+                                   Connection_t * pxOutConnectionsArray,
+                                   size_t xConnectionsArrayLength )
+{
+    size_t uxIdx, uxOtherIdx;
+    size_t uxFound = 0U;
+    uint32_t ulLocalIp = 0UL;
+
+    if( pxOutConnectionsArray != NULL )
+    {
+        /* Get local IP as the tcp_netstat utility does not give it. */
+        ulLocalIp = FreeRTOS_GetIPAddress();
+    }
+
+    for( uxIdx = 0U; uxIdx < pxMetrics->xTCPSocketList.uxCount; uxIdx++ )
+    {
+        for( uxOtherIdx = 0U; uxOtherIdx < pxOtherMetrics->xTCPSocketList.uxCount; uxOtherIdx++ )
+        {
+            if( ( pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usLocalPort ==
+                  pxOtherMetrics->xTCPSocketList.xTCPList[ uxOtherIdx ].usLocalPort ) &&
+                ( pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP ==
+                  pxOtherMetrics->xTCPSocketList.xTCPList[ uxOtherIdx ].ulRemoteIP ) &&
+                ( pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usRemotePort ==
+                  pxOtherMetrics->xTCPSocketList.xTCPList[ uxOtherIdx ].usRemotePort ) )
+            {
+                break;
+            }
+        }
+
+        if( uxOtherIdx == pxOtherMetrics->xTCPSocketList.uxCount )
+        {
+            if( pxOutConnectionsArray == NULL )
+            {
+                uxFound++;
+            }
+            else if( uxFound < xConnectionsArrayLength )
+            {
+                pxOutConnectionsArray[ uxFound ].ulLocalIp = ulLocalIp;
+                pxOutConnectionsArray[ uxFound ].usLocalPort =
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usLocalPort;
+                pxOutConnectionsArray[ uxFound ].ulRemoteIp =
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP;
+                pxOutConnectionsArray[ uxFound ].usRemotePort =
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usRemotePort;
+                uxFound++;
+            }
+            else
+            {
+                LogWarn( ( "Connections returned truncated due to insufficient buffer size." ) );
+                break;
+            }
+        }
+    }
+
+    return uxFound;
+}
+/*-----------------------------------------------------------*/
+
+eMetricsCollectorStatus eUpdateMetricsSnapshot( MetricsChanges_t * pxOutChanges )
+{
+    eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
     BaseType_t xMetricsStatus = 0;
+    size_t uxNextSnapshot = uxCurrentSnapshot;
 
-    configASSERT( pxOutNetworkStats != NULL );
+    /* The first snapshot goes into the current slot, later ones into the
+     * other slot so that the current one becomes the previous one. */
+    if( uxSnapshotCount > 0U )
+    {
+        uxNextSnapshot ^= 1U;
+    }
 
-    /* Start with everything as zero. */
-    memset( pxOutNetworkStats, 0, sizeof( NetworkStats_t ) );
+    memset( &( xSnapshots[ uxNextSnapshot ] ), 0, sizeof( MetricsType_t ) );
 
     /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
+    xMetricsStatus = vGetMetrics( &( xSnapshots[ uxNextSnapshot ] ) );
 
     if( xMetricsStatus != 0 )
     {
         LogError( ( "Failed to acquire metrics from FreeRTOS+TCP tcp_netstat utility. Status: %d.",
                     ( int ) xMetricsStatus ) );
         eStatus = eMetricsCollectorCollectionFailed;
+
+        /* The previous snapshot was overwritten, so changes are reported
+         * against an empty one until the next snapshot. */
+        if( uxSnapshotCount > 1U )
+        {
+            uxSnapshotCount = 1U;
+        }
     }
 
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        uxCurrentSnapshot = uxNextSnapshot;
+
+        if( uxSnapshotCount < 2U )
+        {
+            uxSnapshotCount++;
+        }
+
+        if( pxOutChanges != NULL )
+        {
+            ( void ) eGetTcpPortChanges( NULL, 0U, &( pxOutChanges->uxTcpPortsOpened ),
+                                         NULL, 0U, &( pxOutChanges->uxTcpPortsClosed ) );
+            ( void ) eGetUdpPortChanges( NULL, 0U, &( pxOutChanges->uxUdpPortsOpened ),
+                                         NULL, 0U, &( pxOutChanges->uxUdpPortsClosed ) );
+            ( void ) eGetConnectionChanges( NULL, 0U, &( pxOutChanges->uxConnectionsOpened ),
+                                            NULL, 0U, &( pxOutChanges->uxConnectionsClosed ) );
+        }
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
+
+eMetricsCollectorStatus eGetNetworkStats( NetworkStats_t * pxOutNetworkStats )
+{
+    eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
+
+    const MetricsType_t * pxMetrics = NULL;
+
+    configASSERT( pxOutNetworkStats != NULL );
+
+    /* Start with everything as zero. */
+    memset( pxOutNetworkStats, 0, sizeof( NetworkStats_t ) );
+
+    /* Read the metrics from the last snapshot of the FreeRTOS+TCP tcp_netstat
+     * utility. */
+    eStatus = prvGetSnapshot( &( pxMetrics ) );
+
     /* Fill our response with values gotten from FreeRTOS+TCP. */
     if( eStatus == eMetricsCollectorSuccess )
     {
         LogDebug( ( "Network stats read. Bytes received: %lu, packets received: %lu, "
                     "bytes sent: %lu, packets sent: %lu.",
-                    ( unsigned long ) xMetrics.xInput.uxByteCount,
-                    ( unsigned long ) xMetrics.xInput.uxPacketCount,
-                    ( unsigned long ) xMetrics.xOutput.uxByteCount,
-                    ( unsigned long ) xMetrics.xOutput.uxPacketCount ) );
-
-        pxOutNetworkStats->uxBytesReceived = xMetrics.xInput.uxByteCount;
-        pxOutNetworkStats->uxPacketsReceived = xMetrics.xInput.uxPacketCount;
-        pxOutNetworkStats->uxBytesSent = xMetrics.xOutput.uxByteCount;
-        pxOutNetworkStats->uxPacketsSent = xMetrics.xOutput.uxPacketCount;
+                    ( unsigned long ) pxMetrics->xInput.uxByteCount,
+                    ( unsigned long ) pxMetrics->xInput.uxPacketCount,
+                    ( unsigned long ) pxMetrics->xOutput.uxByteCount,
+                    ( unsigned long ) pxMetrics->xOutput.uxPacketCount ) );
+
+        pxOutNetworkStats->uxBytesReceived = pxMetrics->xInput.uxByteCount;
+        pxOutNetworkStats->uxPacketsReceived = pxMetrics->xInput.uxPacketCount;
+        pxOutNetworkStats->uxBytesSent = pxMetrics->xOutput.uxByteCount;
+        pxOutNetworkStats->uxPacketsSent = pxMetrics->xOutput.uxPacketCount;
     }
 
     return eStatus;
@@ -98,22 +376,15 @@ eMetricsCollectorStatus eGetOpenTcpPorts( uint16_t * pusOutTcpPortsArray,
 {
     eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
 
-    MetricsType_t xMetrics = { 0 };
-    BaseType_t xMetricsStatus = 0;
+    const MetricsType_t * pxMetrics = NULL;
     size_t xCopyAmount = 0UL;
 
     /* pusOutTcpPortsArray can be NULL. */
     configASSERT( pxOutNumTcpOpenPorts != NULL );
 
-    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
-
-    if( xMetricsStatus != 0 )
-    {
-        LogError( ( "Failed to acquire metrics from FreeRTOS+TCP tcp_netstat utility. Status: %d.",
-                    ( int ) xMetricsStatus ) );
-        eStatus = eMetricsCollectorCollectionFailed;
-    }
+    /* Read the metrics from the last snapshot of the FreeRTOS+TCP tcp_netstat
+     * utility. */
+    eStatus = prvGetSnapshot( &( pxMetrics ) );
 
     if( eStatus == eMetricsCollectorSuccess )
     {
@@ -121,16 +392,16 @@ eMetricsCollectorStatus eGetOpenTcpPorts( uint16_t * pusOutTcpPortsArray,
          * given array. */
         if( pusOutTcpPortsArray != NULL )
         {
-            xCopyAmount = xMetrics.xTCPPortList.uxCount;
+            xCopyAmount = pxMetrics->xTCPPortList.uxCount;
 
             /* Limit the copied ports to what can fit in the output array. */
-            if( xTcpPortsArrayLength < xMetrics.xTCPPortList.uxCount )
+            if( xTcpPortsArrayLength < pxMetrics->xTCPPortList.uxCount )
             {
                 LogWarn( ( "Ports returned truncated due to insufficient buffer size." ) );
                 xCopyAmount = xTcpPortsArrayLength;
             }
 
-            memcpy( pusOutTcpPortsArray, &xMetrics.xTCPPortList.usTCPPortList, xCopyAmount * sizeof( uint16_t ) );
+            memcpy( pusOutTcpPortsArray, &pxMetrics->xTCPPortList.usTCPPortList, xCopyAmount * sizeof( uint16_t ) );
 
             /* Return the number of elements copied to the array. */
             *pxOutNumTcpOpenPorts = xCopyAmount;
@@ -138,7 +409,7 @@ eMetricsCollectorStatus eGetOpenTcpPorts( uint16_t * pusOutTcpPortsArray,
         else
         {
             /* Return the total number of open ports. */
-            *pxOutNumTcpOpenPorts = xMetrics.xTCPPortList.uxCount;
+            *pxOutNumTcpOpenPorts = pxMetrics->xTCPPortList.uxCount;
         }
     }
 
@@ -152,22 +423,15 @@ eMetricsCollectorStatus eGetOpenUdpPorts( uint16_t * pusOutUdpPortsArray,
 {
     eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
 
-    MetricsType_t xMetrics = { 0 };
-    BaseType_t xMetricsStatus = 0;
+    const MetricsType_t * pxMetrics = NULL;
     size_t xCopyAmount = 0UL;
 
     /* pusOutUdpPortsArray can be NULL. */
     configASSERT( pxOutNumUdpOpenPorts != NULL );
 
-    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
-
-    if( xMetricsStatus != 0 )
-    {
-        LogError( ( "Failed to acquire metrics from FreeRTOS+TCP tcp_netstat utility. Status: %d.",
-                    ( int ) xMetricsStatus ) );
-        eStatus = eMetricsCollectorCollectionFailed;
-    }
+    /* Read the metrics from the last snapshot of the FreeRTOS+TCP tcp_netstat
+     * utility. */
+    eStatus = prvGetSnapshot( &( pxMetrics ) );
 
     if( eStatus == eMetricsCollectorSuccess )
     {
@@ -175,16 +439,16 @@ eMetricsCollectorStatus eGetOpenUdpPorts( uint16_t * pusOutUdpPortsArray,
          * given array. */
         if( pusOutUdpPortsArray != NULL )
         {
-            xCopyAmount = xMetrics.xUDPPortList.uxCount;
+            xCopyAmount = pxMetrics->xUDPPortList.uxCount;
 
             /* Limit the copied ports to what can fit in the output array. */
-            if( xUdpPortsArrayLength < xMetrics.xUDPPortList.uxCount )
+            if( xUdpPortsArrayLength < pxMetrics->xUDPPortList.uxCount )
             {
                 LogWarn( ( "Ports returned truncated due to insufficient buffer size." ) );
                 xCopyAmount = xUdpPortsArrayLength;
             }
 
-            memcpy( pusOutUdpPortsArray, &xMetrics.xUDPPortList.usUDPPortList, xCopyAmount * sizeof( uint16_t ) );
+            memcpy( pusOutUdpPortsArray, &pxMetrics->xUDPPortList.usUDPPortList, xCopyAmount * sizeof( uint16_t ) );
 
             /* Return the number of elements copied to the array. */
             *pxOutNumUdpOpenPorts = xCopyAmount;
@@ -192,7 +456,7 @@ eMetricsCollectorStatus eGetOpenUdpPorts( uint16_t * pusOutUdpPortsArray,
         else
         {
             /* Return the total number of open ports. */
-            *pxOutNumUdpOpenPorts = xMetrics.xUDPPortList.uxCount;
+            *pxOutNumUdpOpenPorts = pxMetrics->xUDPPortList.uxCount;
         }
     }
 
@@ -207,8 +471,7 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
 {
     eMetricsCollectorStatus eStatus = eMetricsCollectorSuccess;
 
-    MetricsType_t xMetrics = { 0 };
-    BaseType_t xMetricsStatus = 0;
+    const MetricsType_t * pxMetrics = NULL;
     size_t xCopyAmount = 0UL;
     size_t uxIdx;
     uint32_t ulLocalIp = 0UL;
@@ -216,15 +479,9 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
     /* pxOutConnectionsArray can be NULL. */
     configASSERT( pxOutNumEstablishedConnections != NULL );
 
-    /* Get metrics from FreeRTOS+TCP tcp_netstat utility. */
-    xMetricsStatus = vGetMetrics( &xMetrics );
-
-    if( xMetricsStatus != 0 )
-    {
-        LogError( ( "Failed to acquire metrics from FreeRTOS+TCP tcp_netstat utility. Status: %d.",
-                    ( int ) xMetricsStatus ) );
-        eStatus = eMetricsCollectorCollectionFailed;
-    }
+    /* Read the metrics from the last snapshot of the FreeRTOS+TCP tcp_netstat
+     * utility. */
+    eStatus = prvGetSnapshot( &( pxMetrics ) );
 
     if( eStatus == eMetricsCollectorSuccess )
     {
@@ -232,13 +489,13 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
          * the given array. */
         if( pxOutConnectionsArray != NULL )
         {
-            xCopyAmount = xMetrics.xTCPSocketList.uxCount;
+            xCopyAmount = pxMetrics->xTCPSocketList.uxCount;
 
             /* Get local IP as the tcp_netstat utility does not give it. */
             ulLocalIp = FreeRTOS_GetIPAddress();
 
             /* Limit the outputted connections to what can fit in the output array. */
-            if( xConnectionsArrayLength < xMetrics.xTCPSocketList.uxCount )
+            if( xConnectionsArrayLength < pxMetrics->xTCPSocketList.uxCount )
             {
                 LogWarn( ( "Ports returned truncated due to insufficient buffer size." ) );
                 xCopyAmount = xConnectionsArrayLength;
@@ -248,11 +505,11 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
             {
                 pxOutConnectionsArray[ uxIdx ].ulLocalIp = ulLocalIp;
                 pxOutConnectionsArray[ uxIdx ].usLocalPort =
-                    xMetrics.xTCPSocketList.xTCPList[ uxIdx ].usLocalPort;
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usLocalPort;
                 pxOutConnectionsArray[ uxIdx ].ulRemoteIp =
-                    xMetrics.xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP;
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].ulRemoteIP;
                 pxOutConnectionsArray[ uxIdx ].usRemotePort =
-                    xMetrics.xTCPSocketList.xTCPList[ uxIdx ].usRemotePort;
+                    pxMetrics->xTCPSocketList.xTCPList[ uxIdx ].usRemotePort;
             }
 
             /* Return the number of elements copied to the array. */
@@ -261,10 +518,117 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
         else
         {
             /* Return the total number of established connections. */
-            *pxOutNumEstablishedConnections = xMetrics.xTCPSocketList.uxCount;
+            *pxOutNumEstablishedConnections = pxMetrics->xTCPSocketList.uxCount;
         }
     }
 
     return eStatus;
 }
 /*-----------------------------------------------------------*/
+
+eMetricsCollectorStatus eGetTcpPortChanges( uint16_t * pusOutOpenedPortsArray,
+                                            size_t xOpenedPortsArrayLength,
+                                            size_t * pxOutNumOpenedPorts,
+                                            uint16_t * pusOutClosedPortsArray,
+                                            size_t xClosedPortsArrayLength,
+                                            size_t * pxOutNumClosedPorts )
+{
+    eMetricsCollectorStatus eStatus;
+    const MetricsType_t * pxCurrent = NULL;
+    const MetricsType_t * pxPrevious = NULL;
+
+    /* pusOutOpenedPortsArray and pusOutClosedPortsArray can be NULL. */
+    configASSERT( pxOutNumOpenedPorts != NULL );
+    configASSERT( pxOutNumClosedPorts != NULL );
+
+    eStatus = prvGetSnapshotPair( &( pxCurrent ), &( pxPrevious ) );
+
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        *pxOutNumOpenedPorts = prvPortsNotIn( pxCurrent->xTCPPortList.usTCPPortList,
+                                              pxCurrent->xTCPPortList.uxCount,
+                                              pxPrevious->xTCPPortList.usTCPPortList,
+                                              pxPrevious->xTCPPortList.uxCount,
+                                              pusOutOpenedPortsArray,
+                                              xOpenedPortsArrayLength );
+        *pxOutNumClosedPorts = prvPortsNotIn( pxPrevious->xTCPPortList.usTCPPortList,
+                                              pxPrevious->xTCPPortList.uxCount,
+                                              pxCurrent->xTCPPortList.usTCPPortList,
+                                              pxCurrent->xTCPPortList.uxCount,
+                                              pusOutClosedPortsArray,
+                                              xClosedPortsArrayLength );
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
+
+eMetricsCollectorStatus eGetUdpPortChanges( uint16_t * pusOutOpenedPortsArray,
+                                            size_t xOpenedPortsArrayLength,
+                                            size_t * pxOutNumOpenedPorts,
+                                            uint16_t * pusOutClosedPortsArray,
+                                            size_t xClosedPortsArrayLength,
+                                            size_t * pxOutNumClosedPorts )
+{
+    eMetricsCollectorStatus eStatus;
+    const MetricsType_t * pxCurrent = NULL;
+    const MetricsType_t * pxPrevious = NULL;
+
+    /* pusOutOpenedPortsArray and pusOutClosedPortsArray can be NULL. */
+    configASSERT( pxOutNumOpenedPorts != NULL );
+    configASSERT( pxOutNumClosedPorts != NULL );
+
+    eStatus = prvGetSnapshotPair( &( pxCurrent ), &( pxPrevious ) );
+
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        *pxOutNumOpenedPorts = prvPortsNotIn( pxCurrent->xUDPPortList.usUDPPortList,
+                                              pxCurrent->xUDPPortList.uxCount,
+                                              pxPrevious->xUDPPortList.usUDPPortList,
+                                              pxPrevious->xUDPPortList.uxCount,
+                                              pusOutOpenedPortsArray,
+                                              xOpenedPortsArrayLength );
+        *pxOutNumClosedPorts = prvPortsNotIn( pxPrevious->xUDPPortList.usUDPPortList,
+                                              pxPrevious->xUDPPortList.uxCount,
+                                              pxCurrent->xUDPPortList.usUDPPortList,
+                                              pxCurrent->xUDPPortList.uxCount,
+                                              pusOutClosedPortsArray,
+                                              xClosedPortsArrayLength );
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
+
+eMetricsCollectorStatus eGetConnectionChanges( Connection_t * pxOutOpenedConnectionsArray,
+                                               size_t xOpenedConnectionsArrayLength,
+                                               size_t * pxOutNumOpenedConnections,
+                                               Connection_t * pxOutClosedConnectionsArray,
+                                               size_t xClosedConnectionsArrayLength,
+                                               size_t * pxOutNumClosedConnections )
+{
+    eMetricsCollectorStatus eStatus;
+    const MetricsType_t * pxCurrent = NULL;
+    const MetricsType_t * pxPrevious = NULL;
+
+    /* pxOutOpenedConnectionsArray and pxOutClosedConnectionsArray can be NULL. */
+    configASSERT( pxOutNumOpenedConnections != NULL );
+    configASSERT( pxOutNumClosedConnections != NULL );
+
+    eStatus = prvGetSnapshotPair( &( pxCurrent ), &( pxPrevious ) );
+
+    if( eStatus == eMetricsCollectorSuccess )
+    {
+        *pxOutNumOpenedConnections = prvConnectionsNotIn( pxCurrent,
+                                                          pxPrevious,
+                                                          pxOutOpenedConnectionsArray,
+                                                          xOpenedConnectionsArrayLength );
+        *pxOutNumClosedConnections = prvConnectionsNotIn( pxPrevious,
+                                                          pxCurrent,
+                                                          pxOutClosedConnectionsArray,
+                                                          xClosedConnectionsArrayLength );
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
@@ -68,10 +68,39 @@ typedef struct Connection
     uint16_t usRemotePort;
 } Connection_t;
 
+/**
+ * @brief Number of ports and connections opened and closed between the last
+ * two snapshots.
+ */
+typedef struct MetricsChanges
+{
+    size_t uxTcpPortsOpened;    /**< Number of TCP ports opened. */
+    size_t uxTcpPortsClosed;    /**< Number of TCP ports closed. */
+    size_t uxUdpPortsOpened;    /**< Number of UDP ports opened. */
+    size_t uxUdpPortsClosed;    /**< Number of UDP ports closed. */
+    size_t uxConnectionsOpened; /**< Number of established connections opened. */
+    size_t uxConnectionsClosed; /**< Number of established connections closed. */
+} MetricsChanges_t;
+
+/**
+ * @brief Take a snapshot of the metrics.
+ *
+ * The socket table is walked once here, and the other functions of this file
+ * read the last snapshot rather than walking it again. Call it once per
+ * report; if it was never called, the first query takes a snapshot.
+ *
+ * @param[out] pxOutChanges The number of ports and connections opened and
+ * closed since the previous snapshot. This can be NULL.
+ *
+ * @return #eMetricsCollectorSuccess if the snapshot is taken;
+ * #eMetricsCollectorCollectionFailed if the collection methods failed.
+ */
+eMetricsCollectorStatus eUpdateMetricsSnapshot( MetricsChanges_t * pxOutChanges );
+
 /**
  * @brief Get network stats.
  *
- * This function returns the network stats.
+ * This function returns the network stats of the last snapshot.
  *
  * @param[out] pxOutNetworkStats The network stats.
  *
@@ -84,8 +113,9 @@ eMetricsCollectorStatus eGetNetworkStats( NetworkStats_t * pxOutNetworkStats );
 /**
  * @brief Get a list of the open TCP ports.
  *
- * This function finds the open TCP ports. It can be called with
- * @p pusOutTcpPortsArray NULL to get the number of the open TCP ports.
+ * This function finds the open TCP ports in the last snapshot. It can be
+ * called with @p pusOutTcpPortsArray NULL to get the number of the open TCP
+ * ports.
  *
  * @param[out] pusOutTcpPortsArray The array to write the open TCP ports into. This
  * can be NULL, if only the number of open ports is needed.
@@ -105,8 +135,9 @@ eMetricsCollectorStatus eGetOpenTcpPorts( uint16_t * pusOutTcpPortsArray,
 /**
  * @brief Get a list of the open UDP ports.
  *
- * This function finds the open UDP ports. It can be called with
- * @p pusOutUdpPortsArray NULL to get the number of the open UDP ports.
+ * This function finds the open UDP ports in the last snapshot. It can be
+ * called with @p pusOutUdpPortsArray NULL to get the number of the open UDP
+ * ports.
  *
  * @param[out] pusOutUdpPortsArray The array to write the open UDP ports into. Can
  * be NULL, if only number of open ports is needed.
@@ -126,7 +157,7 @@ eMetricsCollectorStatus eGetOpenUdpPorts( uint16_t * pusOutUdpPortsArray,
 /**
  * @brief Get a list of established connections.
  *
- * This function finds the established TCP connections.
+ * This function finds the established TCP connections in the last snapshot.
  * It can be called with @p pxOutConnectionsArray NULL to get the number of
  * established connections.
  *
@@ -146,4 +177,55 @@ eMetricsCollectorStatus eGetEstablishedConnections( Connection_t * pxOutConnecti
                                                     size_t xConnectionsArrayLength,
                                                     size_t * pxOutNumEstablishedConnections );
 
+/**
+ * @brief Get the TCP ports opened and closed between the last two snapshots.
+ *
+ * After the first snapshot, all open ports are reported as opened. The arrays
+ * can be NULL to get the numbers only.
+ *
+ * @param[out] pusOutOpenedPortsArray The array to write the opened ports into.
+ * @param[in] xOpenedPortsArrayLength Length of the pusOutOpenedPortsArray.
+ * @param[out] pxOutNumOpenedPorts Number of opened ports if @p
+ * pusOutOpenedPortsArray is NULL, else number of opened ports written.
+ * @param[out] pusOutClosedPortsArray The array to write the closed ports into.
+ * @param[in] xClosedPortsArrayLength Length of the pusOutClosedPortsArray.
+ * @param[out] pxOutNumClosedPorts Number of closed ports if @p
+ * pusOutClosedPortsArray is NULL, else number of closed ports written.
+ *
+ * @return #eMetricsCollectorSuccess if the changes are successfully obtained;
+ * #eMetricsCollectorCollectionFailed if the collection methods failed.
+ */
+eMetricsCollectorStatus eGetTcpPortChanges( uint16_t * pusOutOpenedPortsArray,
+                                            size_t xOpenedPortsArrayLength,
+                                            size_t * pxOutNumOpenedPorts,
+                                            uint16_t * pusOutClosedPortsArray,
+                                            size_t xClosedPortsArrayLength,
+                                            size_t * pxOutNumClosedPorts );
+
+/**
+ * @brief Get the UDP ports opened and closed between the last two snapshots.
+ *
+ * See eGetTcpPortChanges() for the parameters.
+ */
+eMetricsCollectorStatus eGetUdpPortChanges( uint16_t * pusOutOpenedPortsArray,
+                                            size_t xOpenedPortsArrayLength,
+                                            size_t * pxOutNumOpenedPorts,
+                                            uint16_t * pusOutClosedPortsArray,
+                                            size_t xClosedPortsArrayLength,
+                                            size_t * pxOutNumClosedPorts );
+
+/**
+ * @brief Get the established connections opened and closed between the last
+ * two snapshots.
+ *
+ * A connection is identified by its local port and its remote address and
+ * port. See eGetTcpPortChanges() for the parameters.
+ */
+eMetricsCollectorStatus eGetConnectionChanges( Connection_t * pxOutOpenedConnectionsArray,
+                                               size_t xOpenedConnectionsArrayLength,
+                                               size_t * pxOutNumOpenedConnections,
+                                               Connection_t * pxOutClosedConnectionsArray,
+                                               size_t xClosedConnectionsArrayLength,
+                                               size_t * pxOutNumClosedConnections );
+
 #endif /* ifndef METRICS_COLLECTOR_H_ */
@@ -39,12 +39,21 @@
 /* Device Defender Client Library. */
 #include "defender.h"
 
+/* TinyCBOR library for CBOR encoding. */
+#include "cbor.h"
+
 /* Interface include. */
 #include "report_builder.h"
 
 /* Helper macro to check if snprintf was successful. */
 #define reportbuilderSNPRINTF_SUCCESS( retVal, bufLen )    ( ( retVal > 0 ) && ( ( uint32_t ) retVal < bufLen ) )
 
+/* Longest remote address text in the CBOR report, with the terminator. */
+#define reportbuilderREMOTE_ADDR_MAX_LENGTH                sizeof( "255.255.255.255:65535" )
+
+/* Longest version text in the CBOR report, with the terminator. */
+#define reportbuilderVERSION_MAX_LENGTH                    sizeof( "4294967295.4294967295" )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -124,6 +133,73 @@ static eReportBuilderStatus prvWriteTaskIdArray( char * pcBuffer,
                                                  const TaskStatus_t * pxTaskStatusArray,
                                                  size_t xTaskStatusArrayLength,
                                                  size_t * pxOutCharsWritten );
+
+/**
+ * @brief Encode a text string key and an unsigned integer value into a CBOR
+ * map.
+ *
+ * @param[in] pxMapEncoder The encoder of the map.
+ * @param[in] pcKey The key.
+ * @param[in] ullValue The value.
+ *
+ * @return The tinycbor error of the first call that failed, or CborNoError.
+ */
+static CborError prvEncodeKeyUint( CborEncoder * pxMapEncoder,
+                                   const char * pcKey,
+                                   uint64_t ullValue );
+
+/**
+ * @brief Encode a listening ports map into a CBOR map.
+ *
+ * The map has the same layout as in the JSON report:
+ * { "pts": [ { "pt": 44207 }, { "pt": 53 } ], "t": 2 }
+ *
+ * @param[in] pxMapEncoder The encoder of the enclosing map.
+ * @param[in] pcKey The key of the ports map, for TCP or UDP ports.
+ * @param[in] pusOpenPortsArray The array containing the open ports.
+ * @param[in] xOpenPortsArrayLength Length of the pusOpenPortsArray array.
+ *
+ * @return The tinycbor error of the first call that failed, or CborNoError.
+ */
+static CborError prvEncodePortsMap( CborEncoder * pxMapEncoder,
+                                    const char * pcKey,
+                                    const uint16_t * pusOpenPortsArray,
+                                    size_t xOpenPortsArrayLength );
+
+/**
+ * @brief Encode the network statistics map into a CBOR map.
+ *
+ * @param[in] pxMapEncoder The encoder of the enclosing map.
+ * @param[in] pxNetworkStats The network statistics.
+ *
+ * @return The tinycbor error of the first call that failed, or CborNoError.
+ */
+static CborError prvEncodeNetworkStatsMap( CborEncoder * pxMapEncoder,
+                                           const NetworkStats_t * pxNetworkStats );
+
+/**
+ * @brief Encode the TCP connections map into a CBOR map.
+ *
+ * @param[in] pxMapEncoder The encoder of the enclosing map.
+ * @param[in] pxConnectionsArray The array containing the established connections.
+ * @param[in] xConnectionsArrayLength Length of the pxConnectionsArray array.
+ *
+ * @return The tinycbor error of the first call that failed, or CborNoError.
+ */
+static CborError prvEncodeConnectionsMap( CborEncoder * pxMapEncoder,
+                                          const Connection_t * pxConnectionsArray,
+                                          size_t xConnectionsArrayLength );
+
+/**
+ * @brief Encode the custom metrics map into a CBOR map.
+ *
+ * @param[in] pxMapEncoder The encoder of the enclosing map.
+ * @param[in] pxMetrics Metrics holding the stack high water mark and tasks.
+ *
+ * @return The tinycbor error of the first call that failed, or CborNoError.
+ */
+static CborError prvEncodeCustomMetricsMap( CborEncoder * pxMapEncoder,
+                                            const ReportMetrics_t * pxMetrics );
 /*-----------------------------------------------------------*/
 
 static eReportBuilderStatus prvWritePortsArray( char * pcBuffer,
@@ -621,3 +697,497 @@ eReportBuilderStatus eGenerateJsonReport( char * pcBuffer,
     return eStatus;
 }
 /*-----------------------------------------------------------*/
+
+static CborError prvEncodeKeyUint( CborEncoder * pxMapEncoder,
+                                   const char * pcKey,
+                                   uint64_t ullValue )
+{
+    CborError xCborRet;
+
+    xCborRet = cbor_encode_text_stringz( pxMapEncoder, pcKey );
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encode_uint( pxMapEncoder, ullValue );
+    }
+
+    return xCborRet;
+}
+/*-----------------------------------------------------------*/
+
+static CborError prvEncodePortsMap( CborEncoder * pxMapEncoder,
+                                    const char * pcKey,
+                                    const uint16_t * pusOpenPortsArray,
+                                    size_t xOpenPortsArrayLength )
+{
+    CborEncoder xPortsMapEncoder, xArrayEncoder, xPortEncoder;
+    CborError xCborRet;
+    size_t uxIdx;
+
+    configASSERT( pusOpenPortsArray != NULL );
+
+    xCborRet = cbor_encode_text_stringz( pxMapEncoder, pcKey );
+
+    if( xCborRet == CborNoError )
+    {
+        /* The ports map has the "pts" array and the "t" total. */
+        xCborRet = cbor_encoder_create_map( pxMapEncoder, &xPortsMapEncoder, 2 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encode_text_stringz( &xPortsMapEncoder, DEFENDER_REPORT_PORTS_KEY );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_array( &xPortsMapEncoder, &xArrayEncoder, xOpenPortsArrayLength );
+    }
+
+    for( uxIdx = 0U; ( ( uxIdx < xOpenPortsArrayLength ) && ( xCborRet == CborNoError ) ); uxIdx++ )
+    {
+        xCborRet = cbor_encoder_create_map( &xArrayEncoder, &xPortEncoder, 1 );
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodeKeyUint( &xPortEncoder, DEFENDER_REPORT_PORT_KEY, pusOpenPortsArray[ uxIdx ] );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encoder_close_container( &xArrayEncoder, &xPortEncoder );
+        }
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xPortsMapEncoder, &xArrayEncoder );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = prvEncodeKeyUint( &xPortsMapEncoder, DEFENDER_REPORT_TOTAL_KEY, xOpenPortsArrayLength );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( pxMapEncoder, &xPortsMapEncoder );
+    }
+
+    return xCborRet;
+}
+/*-----------------------------------------------------------*/
+
+static CborError prvEncodeNetworkStatsMap( CborEncoder * pxMapEncoder,
+                                           const NetworkStats_t * pxNetworkStats )
+{
+    CborEncoder xStatsEncoder;
+    CborError xCborRet;
+
+    configASSERT( pxNetworkStats != NULL );
+
+    xCborRet = cbor_encode_text_stringz( pxMapEncoder, DEFENDER_REPORT_NETWORK_STATS_KEY );
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_map( pxMapEncoder, &xStatsEncoder, 4 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = prvEncodeKeyUint( &xStatsEncoder, DEFENDER_REPORT_BYTES_IN_KEY, pxNetworkStats->uxBytesReceived );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = prvEncodeKeyUint( &xStatsEncoder, DEFENDER_REPORT_BYTES_OUT_KEY, pxNetworkStats->uxBytesSent );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = prvEncodeKeyUint( &xStatsEncoder, DEFENDER_REPORT_PKTS_IN_KEY, pxNetworkStats->uxPacketsReceived );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = prvEncodeKeyUint( &xStatsEncoder, DEFENDER_REPORT_PKTS_OUT_KEY, pxNetworkStats->uxPacketsSent );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( pxMapEncoder, &xStatsEncoder );
+    }
+
+    return xCborRet;
+}
+/*-----------------------------------------------------------*/
+
+static CborError prvEncodeConnectionsMap( CborEncoder * pxMapEncoder,
+                                          const Connection_t * pxConnectionsArray,
+                                          size_t xConnectionsArrayLength )
+{
+    CborEncoder xTcpConnectionsEncoder, xEstablishedEncoder, xArrayEncoder, xConnectionEncoder;
+    CborError xCborRet;
+    size_t uxIdx;
+    const Connection_t * pxConn;
+    char pcRemoteAddr[ reportbuilderREMOTE_ADDR_MAX_LENGTH ];
+    int32_t lCharactersWritten;
+
+    configASSERT( pxConnectionsArray != NULL );
+
+    xCborRet = cbor_encode_text_stringz( pxMapEncoder, DEFENDER_REPORT_TCP_CONNECTIONS_KEY );
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_map( pxMapEncoder, &xTcpConnectionsEncoder, 1 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encode_text_stringz( &xTcpConnectionsEncoder, DEFENDER_REPORT_ESTABLISHED_CONNECTIONS_KEY );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        /* The established connections map has the "cs" array and the "t"
+         * total. */
+        xCborRet = cbor_encoder_create_map( &xTcpConnectionsEncoder, &xEstablishedEncoder, 2 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encode_text_stringz( &xEstablishedEncoder, DEFENDER_REPORT_CONNECTIONS_KEY );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_array( &xEstablishedEncoder, &xArrayEncoder, xConnectionsArrayLength );
+    }
+
+    for( uxIdx = 0U; ( ( uxIdx < xConnectionsArrayLength ) && ( xCborRet == CborNoError ) ); uxIdx++ )
+    {
+        pxConn = &( pxConnectionsArray[ uxIdx ] );
+
+        /* The service expects the remote address as an "a.b.c.d:port" text
+         * string in both formats. */
+        lCharactersWritten = snprintf( pcRemoteAddr,
+                                       sizeof( pcRemoteAddr ),
+                                       "%u.%u.%u.%u:%u",
+                                       ( unsigned int ) ( pxConn->ulRemoteIp >> 24 ) & 0xFF,
+                                       ( unsigned int ) ( pxConn->ulRemoteIp >> 16 ) & 0xFF,
+                                       ( unsigned int ) ( pxConn->ulRemoteIp >> 8 ) & 0xFF,
+                                       ( unsigned int ) ( pxConn->ulRemoteIp ) & 0xFF,
+                                       ( unsigned int ) pxConn->usRemotePort );
+        configASSERT( reportbuilderSNPRINTF_SUCCESS( lCharactersWritten, sizeof( pcRemoteAddr ) ) );
+
+        xCborRet = cbor_encoder_create_map( &xArrayEncoder, &xConnectionEncoder, 2 );
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodeKeyUint( &xConnectionEncoder, DEFENDER_REPORT_LOCAL_PORT_KEY, pxConn->usLocalPort );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encode_text_stringz( &xConnectionEncoder, DEFENDER_REPORT_REMOTE_ADDR_KEY );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encode_text_string( &xConnectionEncoder, pcRemoteAddr, ( size_t ) lCharactersWritten );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encoder_close_container( &xArrayEncoder, &xConnectionEncoder );
+        }
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xEstablishedEncoder, &xArrayEncoder );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = prvEncodeKeyUint( &xEstablishedEncoder, DEFENDER_REPORT_TOTAL_KEY, xConnectionsArrayLength );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xTcpConnectionsEncoder, &xEstablishedEncoder );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( pxMapEncoder, &xTcpConnectionsEncoder );
+    }
+
+    return xCborRet;
+}
+/*-----------------------------------------------------------*/
+
+static CborError prvEncodeCustomMetricsMap( CborEncoder * pxMapEncoder,
+                                            const ReportMetrics_t * pxMetrics )
+{
+    CborEncoder xCustomEncoder, xMetricArrayEncoder, xMetricEncoder, xListEncoder;
+    CborError xCborRet;
+    size_t uxIdx;
+
+    configASSERT( pxMetrics->pxTaskStatusArray != NULL );
+
+    xCborRet = cbor_encode_text_stringz( pxMapEncoder, DEFENDER_REPORT_CUSTOM_METRICS_KEY );
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_map( pxMapEncoder, &xCustomEncoder, 2 );
+    }
+
+    /* "stack_high_water_mark": [ { "number": <value> } ] */
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encode_text_stringz( &xCustomEncoder, "stack_high_water_mark" );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_array( &xCustomEncoder, &xMetricArrayEncoder, 1 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_map( &xMetricArrayEncoder, &xMetricEncoder, 1 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = prvEncodeKeyUint( &xMetricEncoder, DEFENDER_REPORT_NUMBER_KEY, pxMetrics->ulStackHighWaterMark );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xMetricArrayEncoder, &xMetricEncoder );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xCustomEncoder, &xMetricArrayEncoder );
+    }
+
+    /* "task_numbers": [ { "number_list": [ <id>, ... ] } ] */
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encode_text_stringz( &xCustomEncoder, "task_numbers" );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_array( &xCustomEncoder, &xMetricArrayEncoder, 1 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_map( &xMetricArrayEncoder, &xMetricEncoder, 1 );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encode_text_stringz( &xMetricEncoder, DEFENDER_REPORT_NUMBER_LIST_KEY );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_create_array( &xMetricEncoder, &xListEncoder, pxMetrics->xTaskStatusArrayLength );
+    }
+
+    for( uxIdx = 0U; ( ( uxIdx < pxMetrics->xTaskStatusArrayLength ) && ( xCborRet == CborNoError ) ); uxIdx++ )
+    {
+        xCborRet = cbor_encode_uint( &xListEncoder, pxMetrics->pxTaskStatusArray[ uxIdx ].xTaskNumber );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xMetricEncoder, &xListEncoder );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xMetricArrayEncoder, &xMetricEncoder );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( &xCustomEncoder, &xMetricArrayEncoder );
+    }
+
+    if( xCborRet == CborNoError )
+    {
+        xCborRet = cbor_encoder_close_container( pxMapEncoder, &xCustomEncoder );
+    }
+
+    return xCborRet;
+}
+/*-----------------------------------------------------------*/
+
+eReportBuilderStatus eGenerateCborReport( uint8_t * pucBuffer,
+                                          size_t xBufferLength,
+                                          const ReportMetrics_t * pxMetrics,
+                                          uint32_t ulMajorReportVersion,
+                                          uint32_t ulMinorReportVersion,
+                                          uint32_t ulReportId,
+                                          size_t * pxOutReportLength )
+{
+    CborEncoder xEncoder, xReportEncoder, xHeaderEncoder, xMetricsEncoder;
+    CborError xCborRet = CborNoError;
+    eReportBuilderStatus eStatus = eReportBuilderSuccess;
+    char pcVersion[ reportbuilderVERSION_MAX_LENGTH ];
+    int32_t lCharactersWritten;
+
+    configASSERT( pucBuffer != NULL );
+    configASSERT( pxMetrics != NULL );
+    configASSERT( pxOutReportLength != NULL );
+    configASSERT( xBufferLength != 0 );
+
+    if( ( pucBuffer == NULL ) ||
+        ( xBufferLength == 0 ) ||
+        ( pxMetrics == NULL ) ||
+        ( pxOutReportLength == NULL ) )
+    {
+        LogError( ( "Invalid parameters. pucBuffer: %p, xBufferLength: %u"
+                    " pMetrics: %p, pOutReprotLength: %p.",
+                    pucBuffer,
+                    xBufferLength,
+                    pxMetrics,
+                    pxOutReportLength ) );
+        eStatus = eReportBuilderBadParameter;
+    }
+
+    if( eStatus == eReportBuilderSuccess )
+    {
+        /* The version is a "major.minor" text string, as in the JSON report. */
+        lCharactersWritten = snprintf( pcVersion,
+                                       sizeof( pcVersion ),
+                                       "%u.%u",
+                                       ( unsigned int ) ulMajorReportVersion,
+                                       ( unsigned int ) ulMinorReportVersion );
+
+        if( !reportbuilderSNPRINTF_SUCCESS( lCharactersWritten, sizeof( pcVersion ) ) )
+        {
+            eStatus = eReportBuilderBadParameter;
+        }
+    }
+
+    if( eStatus == eReportBuilderSuccess )
+    {
+        cbor_encoder_init( &xEncoder, pucBuffer, xBufferLength, 0 );
+
+        /* The report is a map with the header, the metrics and the custom
+         * metrics, all with definite lengths so that no break bytes are
+         * needed. */
+        xCborRet = cbor_encoder_create_map( &xEncoder, &xReportEncoder, 3 );
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encode_text_stringz( &xReportEncoder, DEFENDER_REPORT_HEADER_KEY );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encoder_create_map( &xReportEncoder, &xHeaderEncoder, 2 );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodeKeyUint( &xHeaderEncoder, DEFENDER_REPORT_ID_KEY, ulReportId );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encode_text_stringz( &xHeaderEncoder, DEFENDER_REPORT_VERSION_KEY );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encode_text_string( &xHeaderEncoder, pcVersion, ( size_t ) lCharactersWritten );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encoder_close_container( &xReportEncoder, &xHeaderEncoder );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encode_text_stringz( &xReportEncoder, DEFENDER_REPORT_METRICS_KEY );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encoder_create_map( &xReportEncoder, &xMetricsEncoder, 4 );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodePortsMap( &xMetricsEncoder,
+                                          DEFENDER_REPORT_TCP_LISTENING_PORTS_KEY,
+                                          pxMetrics->pusOpenTcpPortsArray,
+                                          pxMetrics->xOpenTcpPortsArrayLength );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodePortsMap( &xMetricsEncoder,
+                                          DEFENDER_REPORT_UDP_LISTENING_PORTS_KEY,
+                                          pxMetrics->pusOpenUdpPortsArray,
+                                          pxMetrics->xOpenUdpPortsArrayLength );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodeNetworkStatsMap( &xMetricsEncoder, pxMetrics->pxNetworkStats );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodeConnectionsMap( &xMetricsEncoder,
+                                                pxMetrics->pxEstablishedConnectionsArray,
+                                                pxMetrics->xEstablishedConnectionsArrayLength );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encoder_close_container( &xReportEncoder, &xMetricsEncoder );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = prvEncodeCustomMetricsMap( &xReportEncoder, pxMetrics );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            xCborRet = cbor_encoder_close_container( &xEncoder, &xReportEncoder );
+        }
+
+        if( xCborRet == CborNoError )
+        {
+            *pxOutReportLength = cbor_encoder_get_buffer_size( &xEncoder, pucBuffer );
+        }
+        else
+        {
+            LogError( ( "Error during CBOR encoding: %s", cbor_error_string( xCborRet ) ) );
+
+            if( ( xCborRet & CborErrorOutOfMemory ) != 0 )
+            {
+                eStatus = eReportBuilderBufferTooSmall;
+            }
+            else
+            {
+                eStatus = eReportBuilderBadParameter;
+            }
+        }
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
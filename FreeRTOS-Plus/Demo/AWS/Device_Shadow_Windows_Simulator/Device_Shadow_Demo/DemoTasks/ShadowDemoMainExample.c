@@ -63,6 +63,9 @@
 /* JSON library includes. */
 #include "core_json.h"
 
+/* Single walk dispatch of Shadow document keys. */
+#include "shadow_delta_processor.h"
+
 /* Include MQTT demo helpers header. */
 #include "mqtt_demo_helpers.h"
 
@@ -182,11 +185,6 @@
  */
 #define SHADOW_DELETE_REJECTED_ERROR_CODE_KEY           "code"
 
-/**
- * @brief Length of #SHADOW_DELETE_REJECTED_ERROR_CODE_KEY.
- */
-#define SHADOW_DELETE_REJECTED_ERROR_CODE_KEY_LENGTH    ( ( uint16_t ) ( sizeof( SHADOW_DELETE_REJECTED_ERROR_CODE_KEY ) - 1 ) )
-
 /**
  * @brief Error response code sent from AWS IoT Shadow service when an attempt
  * is made to delete a Shadow document that doesn't exist.
@@ -228,6 +226,25 @@ struct NetworkContext
     TlsTransportParams_t * pParams;
 };
 
+/**
+ * @brief An unsigned integer field found by the delta processor.
+ */
+typedef struct ShadowUint32Field
+{
+    uint32_t ulValue;
+    BaseType_t xFound;
+} ShadowUint32Field_t;
+
+/**
+ * @brief A string or number field found by the delta processor. The value
+ * points into the incoming payload.
+ */
+typedef struct ShadowStringField
+{
+    const char * pcValue;
+    size_t xValueLength;
+} ShadowStringField_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -373,6 +390,34 @@ static void prvDeleteRejectedHandler( MQTTPublishInfo_t * pxPublishInfo );
  */
 static BaseType_t prvWaitForDeleteResponse( MQTTContext_t * pxMQTTContext );
 
+/**
+ * @brief Delta processor handler that stores a number, or a string of digits
+ * such as the clientToken, in a #ShadowUint32Field_t.
+ *
+ * @param[in] pcValue The value of the key.
+ * @param[in] xValueLength The length of the value.
+ * @param[in] xType The JSON type of the value.
+ * @param[in] pvContext The #ShadowUint32Field_t to fill in.
+ */
+static void prvUint32FieldHandler( const char * pcValue,
+                                   size_t xValueLength,
+                                   JSONTypes_t xType,
+                                   void * pvContext );
+
+/**
+ * @brief Delta processor handler that stores the location of a value in a
+ * #ShadowStringField_t.
+ *
+ * @param[in] pcValue The value of the key.
+ * @param[in] xValueLength The length of the value.
+ * @param[in] xType The JSON type of the value.
+ * @param[in] pvContext The #ShadowStringField_t to fill in.
+ */
+static void prvStringFieldHandler( const char * pcValue,
+                                   size_t xValueLength,
+                                   JSONTypes_t xType,
+                                   void * pvContext );
+
 /*-----------------------------------------------------------*/
 
 extern BaseType_t xPlatformIsNetworkUp( void );
@@ -411,16 +456,74 @@ static BaseType_t prvWaitForDeleteResponse( MQTTContext_t * pxMQTTContext )
 
 /*-----------------------------------------------------------*/
 
+static void prvUint32FieldHandler( const char * pcValue,
+                                   size_t xValueLength,
+                                   JSONTypes_t xType,
+                                   void * pvContext )
+{
+    ShadowUint32Field_t * pxField = ( ShadowUint32Field_t * ) pvContext;
+    uint32_t ulValue = 0U;
+    size_t uxIdx;
+
+    configASSERT( pxField != NULL );
+
+    pxField->xFound = pdFALSE;
+
+    if( ( ( xType == JSONNumber ) || ( xType == JSONString ) ) &&
+        ( xValueLength > 0U ) &&
+        ( xValueLength <= 10U ) )
+    {
+        /* The value is not terminated, so convert it within its length. */
+        for( uxIdx = 0U; uxIdx < xValueLength; uxIdx++ )
+        {
+            if( ( pcValue[ uxIdx ] < '0' ) || ( pcValue[ uxIdx ] > '9' ) )
+            {
+                break;
+            }
+
+            ulValue = ( ulValue * 10U ) + ( uint32_t ) ( pcValue[ uxIdx ] - '0' );
+        }
+
+        if( uxIdx == xValueLength )
+        {
+            pxField->ulValue = ulValue;
+            pxField->xFound = pdTRUE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStringFieldHandler( const char * pcValue,
+                                   size_t xValueLength,
+                                   JSONTypes_t xType,
+                                   void * pvContext )
+{
+    ShadowStringField_t * pxField = ( ShadowStringField_t * ) pvContext;
+
+    ( void ) xType;
+
+    configASSERT( pxField != NULL );
+
+    pxField->pcValue = pcValue;
+    pxField->xValueLength = xValueLength;
+}
+/*-----------------------------------------------------------*/
+
 static void prvDeleteRejectedHandler( MQTTPublishInfo_t * pxPublishInfo )
 {
-    JSONStatus_t result = JSONSuccess;
-    char * pcOutValue = NULL;
-    uint32_t ulOutValueLength = 0UL;
+    ShadowStringField_t xErrorCode = { 0 };
+    const ShadowDeltaHandlerEntry_t xHandlers[] =
+    {
+        { SHADOW_DELETE_REJECTED_ERROR_CODE_KEY, prvStringFieldHandler, &xErrorCode }
+    };
+    eShadowDeltaStatus eStatus;
 
     configASSERT( pxPublishInfo != NULL );
     configASSERT( pxPublishInfo->pPayload != NULL );
 
-    LogInfo( ( "/delete/rejected json payload:%s.", ( const char * ) pxPublishInfo->pPayload ) );
+    LogInfo( ( "/delete/rejected json payload:%.*s.",
+               ( int ) pxPublishInfo->payloadLength,
+               ( const char * ) pxPublishInfo->pPayload ) );
 
     /* The payload will look similar to this:
      * {
@@ -431,37 +534,23 @@ static void prvDeleteRejectedHandler( MQTTPublishInfo_t * pxPublishInfo )
      * }
      */
 
-    /* Make sure the payload is a valid json document. */
-    result = JSON_Validate( pxPublishInfo->pPayload,
-                            pxPublishInfo->payloadLength );
-
-    if( result == JSONSuccess )
-    {
-        /* Then we start to get the version value by JSON keyword "version". */
-        result = JSON_SearchConst( pxPublishInfo->pPayload,
+    /* Walk the document once to find the error code. */
+    eStatus = eShadowDeltaProcess( ( const char * ) pxPublishInfo->pPayload,
                                    pxPublishInfo->payloadLength,
-                                   SHADOW_DELETE_REJECTED_ERROR_CODE_KEY,
-                                   SHADOW_DELETE_REJECTED_ERROR_CODE_KEY_LENGTH,
-                                   &pcOutValue,
-                                   ( size_t * ) &ulOutValueLength,
-                                   NULL );
-    }
-    else
-    {
-        LogError( ( "The json document is invalid!!" ) );
-    }
+                                   xHandlers,
+                                   sizeof( xHandlers ) / sizeof( xHandlers[ 0 ] ) );
 
-    if( result == JSONSuccess )
+    if( ( eStatus == eShadowDeltaSuccess ) && ( xErrorCode.pcValue != NULL ) )
     {
         LogInfo( ( "Error code is: %.*s.",
-                   ulOutValueLength,
-                   pcOutValue ) );
+                   ( int ) xErrorCode.xValueLength,
+                   xErrorCode.pcValue ) );
 
         /* Check if error code is `404`. An error code `404` indicates that an
          * attempt was made to delete a Shadow document that didn't exist. */
-        if( ulOutValueLength == SHADOW_NO_SHADOW_EXISTS_ERROR_CODE_LENGTH )
+        if( xErrorCode.xValueLength == SHADOW_NO_SHADOW_EXISTS_ERROR_CODE_LENGTH )
         {
-            if( strncmp( pcOutValue, SHADOW_NO_SHADOW_EXISTS_ERROR_CODE,
+            if( strncmp( xErrorCode.pcValue, SHADOW_NO_SHADOW_EXISTS_ERROR_CODE,
                          SHADOW_NO_SHADOW_EXISTS_ERROR_CODE_LENGTH ) == 0 )
             {
                 xShadowDeleted = pdTRUE;
@@ -479,16 +568,21 @@ static void prvDeleteRejectedHandler( MQTTPublishInfo_t * pxPublishInfo )
 static void prvUpdateDeltaHandler( MQTTPublishInfo_t * pxPublishInfo )
 {
     static uint32_t ulCurrentVersion = 0; /* Remember the latestVersion # we've ever received */
-    uint32_t ulVersion = 0U;
-    uint32_t ulNewState = 0U;
-    char * pcOutValue = NULL;
-    uint32_t ulOutValueLength = 0U;
-    JSONStatus_t result = JSONSuccess;
+    ShadowUint32Field_t xVersion = { 0 };
+    ShadowUint32Field_t xPowerOn = { 0 };
+    const ShadowDeltaHandlerEntry_t xHandlers[] =
+    {
+        { "version",       prvUint32FieldHandler, &xVersion },
+        { "state.powerOn", prvUint32FieldHandler, &xPowerOn }
+    };
+    eShadowDeltaStatus eStatus;
 
     configASSERT( pxPublishInfo != NULL );
     configASSERT( pxPublishInfo->pPayload != NULL );
 
-    LogInfo( ( "/update/delta json payload:%s.", ( const char * ) pxPublishInfo->pPayload ) );
+    LogInfo( ( "/update/delta json payload:%.*s.",
+               ( int ) pxPublishInfo->payloadLength,
+               ( const char * ) pxPublishInfo->pPayload ) );
 
     /* The payload will look similar to this:
      * {
@@ -506,107 +600,87 @@ static void prvUpdateDeltaHandler( MQTTPublishInfo_t * pxPublishInfo )
      *  }
      */
 
-    /* Make sure the payload is a valid json document. */
-    result = JSON_Validate( pxPublishInfo->pPayload,
-                            pxPublishInfo->payloadLength );
-
-    if( result == JSONSuccess )
-    {
-        /* Then we start to get the version value by JSON keyword "version". */
-        result = JSON_Search( ( char * ) pxPublishInfo->pPayload,
-                              pxPublishInfo->payloadLength,
-                              "version",
-                              sizeof( "version" ) - 1,
-                              &pcOutValue,
-                              ( size_t * ) &ulOutValueLength );
-    }
-    else
-    {
-        LogError( ( "The json document is invalid!!" ) );
-    }
+    /* Walk the document once. The handlers pick up the version and the
+     * powerOn state wherever they are, and "metadata" is skipped as a whole
+     * since no handler is registered inside it. The values are acted on after
+     * the walk, as the version may come after the state. */
+    eStatus = eShadowDeltaProcess( ( const char * ) pxPublishInfo->pPayload,
+                                   pxPublishInfo->payloadLength,
+                                   xHandlers,
+                                   sizeof( xHandlers ) / sizeof( xHandlers[ 0 ] ) );
 
-    if( result == JSONSuccess )
+    if( eStatus != eShadowDeltaSuccess )
     {
-        LogInfo( ( "version: %.*s",
-                   ulOutValueLength,
-                   pcOutValue ) );
-
-        /* Convert the extracted value to an unsigned integer value. */
-        ulVersion = ( uint32_t ) strtoul( pcOutValue, NULL, 10 );
+        xUpdateDeltaReturn = pdFAIL;
     }
-    else
+    else if( xVersion.xFound != pdTRUE )
     {
         LogError( ( "No version in json document!!" ) );
     }
-
-    LogInfo( ( "version:%d, ulCurrentVersion:%d \r\n", ulVersion, ulCurrentVersion ) );
-
-    /* When the version is much newer than the one we retained, that means the powerOn
-     * state is valid for us. */
-    if( ulVersion > ulCurrentVersion )
-    {
-        /* Set to received version as the current version. */
-        ulCurrentVersion = ulVersion;
-
-        /* Get powerOn state from json documents. */
-        result = JSON_Search( ( char * ) pxPublishInfo->pPayload,
-                              pxPublishInfo->payloadLength,
-                              "state.powerOn",
-                              sizeof( "state.powerOn" ) - 1,
-                              &pcOutValue,
-                              ( size_t * ) &ulOutValueLength );
-    }
     else
     {
-        /* In this demo, we discard the incoming message
-         * if the version number is not newer than the latest
-         * that we've received before. Your application may use a
-         * different approach.
-         */
-        LogWarn( ( "The received version is smaller than current one!!" ) );
-    }
-
-    if( result == JSONSuccess )
-    {
-        /* Convert the powerOn state value to an unsigned integer value. */
-        ulNewState = ( uint32_t ) strtoul( pcOutValue, NULL, 10 );
+        LogInfo( ( "version:%d, ulCurrentVersion:%d \r\n", xVersion.ulValue, ulCurrentVersion ) );
 
-        LogInfo( ( "The new power on state newState:%d, ulCurrentPowerOnState:%d \r\n",
-                   ulNewState, ulCurrentPowerOnState ) );
+        /* When the version is much newer than the one we retained, that means the powerOn
+         * state is valid for us. */
+        if( xVersion.ulValue > ulCurrentVersion )
+        {
+            /* Set to received version as the current version. */
+            ulCurrentVersion = xVersion.ulValue;
 
-        if( ulNewState != ulCurrentPowerOnState )
+            if( xPowerOn.xFound == pdTRUE )
+            {
+                LogInfo( ( "The new power on state newState:%d, ulCurrentPowerOnState:%d \r\n",
+                           xPowerOn.ulValue, ulCurrentPowerOnState ) );
+
+                if( xPowerOn.ulValue != ulCurrentPowerOnState )
+                {
+                    /* The received powerOn state is different from the one we retained before, so we switch them
+                     * and set the flag. */
+                    ulCurrentPowerOnState = xPowerOn.ulValue;
+
+                    /* State change will be handled in main(), where we will publish a "reported"
+                     * state to the device shadow. We do not do it here because we are inside of
+                     * a callback from the MQTT library, so that we don't re-enter
+                     * the MQTT library. */
+                    stateChanged = true;
+                }
+            }
+            else
+            {
+                LogError( ( "No powerOn in json document!!" ) );
+                xUpdateDeltaReturn = pdFAIL;
+            }
+        }
+        else
         {
-            /* The received powerOn state is different from the one we retained before, so we switch them
-             * and set the flag. */
-            ulCurrentPowerOnState = ulNewState;
-
-            /* State change will be handled in main(), where we will publish a "reported"
-             * state to the device shadow. We do not do it here because we are inside of
-             * a callback from the MQTT library, so that we don't re-enter
-             * the MQTT library. */
-            stateChanged = true;
+            /* In this demo, we discard the incoming message
+             * if the version number is not newer than the latest
+             * that we've received before. Your application may use a
+             * different approach.
+             */
+            LogWarn( ( "The received version is smaller than current one!!" ) );
         }
     }
-    else
-    {
-        LogError( ( "No powerOn in json document!!" ) );
-        xUpdateDeltaReturn = pdFAIL;
-    }
 }
 
 /*-----------------------------------------------------------*/
 
 static void prvUpdateAcceptedHandler( MQTTPublishInfo_t * pxPublishInfo )
 {
-    char * pcOutValue = NULL;
-    uint32_t ulOutValueLength = 0U;
-    uint32_t ulReceivedToken = 0U;
-    JSONStatus_t result = JSONSuccess;
+    ShadowUint32Field_t xClientToken = { 0 };
+    const ShadowDeltaHandlerEntry_t xHandlers[] =
+    {
+        { "clientToken", prvUint32FieldHandler, &xClientToken }
+    };
+    eShadowDeltaStatus eStatus;
 
     configASSERT( pxPublishInfo != NULL );
     configASSERT( pxPublishInfo->pPayload != NULL );
 
-    LogInfo( ( "/update/accepted json payload:%s.", ( const char * ) pxPublishInfo->pPayload ) );
+    LogInfo( ( "/update/accepted json payload:%.*s.",
+               ( int ) pxPublishInfo->payloadLength,
+               ( const char * ) pxPublishInfo->pPayload ) );
 
     /* Handle the reported state with state change in /update/accepted topic.
      * Thus we will retrieve the client token from the json document to see if
@@ -631,39 +705,20 @@ static void prvUpdateAcceptedHandler( MQTTPublishInfo_t * pxPublishInfo )
      *  }
      */
 
-    /* Make sure the payload is a valid json document. */
-    result = JSON_Validate( pxPublishInfo->pPayload,
-                            pxPublishInfo->payloadLength );
-
-    if( result == JSONSuccess )
-    {
-        /* Get clientToken from json documents. */
-        result = JSON_Search( ( char * ) pxPublishInfo->pPayload,
-                              pxPublishInfo->payloadLength,
-                              "clientToken",
-                              sizeof( "clientToken" ) - 1,
-                              &pcOutValue,
-                              ( size_t * ) &ulOutValueLength );
-    }
-    else
-    {
-        LogError( ( "Invalid json documents !!" ) );
-    }
+    /* Walk the document once to find the clientToken. */
+    eStatus = eShadowDeltaProcess( ( const char * ) pxPublishInfo->pPayload,
+                                   pxPublishInfo->payloadLength,
+                                   xHandlers,
+                                   sizeof( xHandlers ) / sizeof( xHandlers[ 0 ] ) );
 
-    if( result == JSONSuccess )
+    if( ( eStatus == eShadowDeltaSuccess ) && ( xClientToken.xFound == pdTRUE ) )
     {
-        LogInfo( ( "clientToken: %.*s", ulOutValueLength,
-                   pcOutValue ) );
-
-        /* Convert the code to an unsigned integer value. */
-        ulReceivedToken = ( uint32_t ) strtoul( pcOutValue, NULL, 10 );
-
-        LogInfo( ( "receivedToken:%u, clientToken:%u \r\n", ulReceivedToken, ulClientToken ) );
+        LogInfo( ( "receivedToken:%u, clientToken:%u \r\n", xClientToken.ulValue, ulClientToken ) );
 
         /* If the clientToken in this update/accepted message matches the one we
          * published before, it means the device shadow has accepted our latest
          * reported state. We are done. */
-        if( ulReceivedToken == ulClientToken )
+        if( xClientToken.ulValue == ulClientToken )
         {
             LogInfo( ( "Received response from the device shadow. Previously published "
                        "update with clientToken=%u has been accepted. ", ulClientToken ) );
@@ -671,7 +726,7 @@ static void prvUpdateAcceptedHandler( MQTTPublishInfo_t * pxPublishInfo )
         else
         {
             LogWarn( ( "The received clientToken=%u is not identical with the one=%u we sent ",
-                       ulReceivedToken, ulClientToken ) );
+                       xClientToken.ulValue, ulClientToken ) );
         }
     }
     else
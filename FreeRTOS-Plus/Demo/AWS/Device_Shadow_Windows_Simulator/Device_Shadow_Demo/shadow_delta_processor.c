@@ -0,0 +1,280 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file shadow_delta_processor.c
+ *
+ * @brief Dispatch the keys of a Shadow document to handlers in a single walk.
+ *
+ * The document is walked with JSON_Iterate(), one level at a time. A key is
+ * compared against the registered paths as it is met, so one walk serves all
+ * the handlers, instead of one JSON_Search() from the start of the document
+ * per key.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+
+/* Demo Specific config file. */
+#include "demo_config.h"
+
+/* Interface include. */
+#include "shadow_delta_processor.h"
+
+/**
+ * @brief How a registered path compares with the path of a key.
+ */
+typedef enum
+{
+    eKeyNoMatch = 0, /**< The key is not on the path. */
+    eKeyOnPath,      /**< The path continues inside the value of the key. */
+    eKeyMatch        /**< The path ends at the key. */
+} eKeyMatch_t;
+
+/**
+ * @brief A key on the path from the root of the document.
+ */
+typedef struct KeySegment
+{
+    const char * pcKey;
+    size_t xKeyLength;
+} KeySegment_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compare a registered dotted path with the path of a key.
+ *
+ * @param[in] pcPath The registered path.
+ * @param[in] pxSegments The keys from the root of the document to the key.
+ * @param[in] uxSegmentCount The number of keys in pxSegments.
+ *
+ * @return How the path compares with the keys.
+ */
+static eKeyMatch_t prvMatchPath( const char * pcPath,
+                                 const KeySegment_t * pxSegments,
+                                 size_t uxSegmentCount );
+
+/**
+ * @brief Dispatch the keys of an object and of the objects on registered
+ * paths inside it.
+ *
+ * @param[in] pcObject The object.
+ * @param[in] xObjectLength The length of the object.
+ * @param[in,out] pxSegments The keys from the root of the document to the
+ * object, the keys of the object are added after them.
+ * @param[in] uxDepth The number of keys in pxSegments.
+ * @param[in] pxHandlers The handlers.
+ * @param[in] xHandlerCount The number of handlers.
+ *
+ * @return #eShadowDeltaSuccess if the object was walked;
+ * #eShadowDeltaIllegalDocument otherwise.
+ */
+static eShadowDeltaStatus prvProcessObject( const char * pcObject,
+                                            size_t xObjectLength,
+                                            KeySegment_t * pxSegments,
+                                            size_t uxDepth,
+                                            const ShadowDeltaHandlerEntry_t * pxHandlers,
+                                            size_t xHandlerCount );
+
+/*-----------------------------------------------------------*/
+
+static eKeyMatch_t prvMatchPath( const char * pcPath,
+                                 const KeySegment_t * pxSegments,
+                                 size_t uxSegmentCount )
+{
+    eKeyMatch_t eMatch = eKeyNoMatch;
+    const char * pcRemaining = pcPath;
+    size_t uxIdx;
+
+    for( uxIdx = 0U; uxIdx < uxSegmentCount; uxIdx++ )
+    {
+        /* strncmp() stops at the end of the path, so a path shorter than the
+         * key does not match. */
+        if( strncmp( pcRemaining, pxSegments[ uxIdx ].pcKey, pxSegments[ uxIdx ].xKeyLength ) != 0 )
+        {
+            break;
+        }
+
+        pcRemaining += pxSegments[ uxIdx ].xKeyLength;
+
+        if( uxIdx == ( uxSegmentCount - 1U ) )
+        {
+            if( *pcRemaining == '\0' )
+            {
+                eMatch = eKeyMatch;
+            }
+            else if( *pcRemaining == '.' )
+            {
+                eMatch = eKeyOnPath;
+            }
+            else
+            {
+                /* The key is only a prefix of the path segment. */
+            }
+        }
+        else if( *pcRemaining == '.' )
+        {
+            pcRemaining++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return eMatch;
+}
+/*-----------------------------------------------------------*/
+
+static eShadowDeltaStatus prvProcessObject( const char * pcObject,
+                                            size_t xObjectLength,
+                                            KeySegment_t * pxSegments,
+                                            size_t uxDepth,
+                                            const ShadowDeltaHandlerEntry_t * pxHandlers,
+                                            size_t xHandlerCount )
+{
+    eShadowDeltaStatus eStatus = eShadowDeltaSuccess;
+    JSONStatus_t xResult;
+    JSONPair_t xPair;
+    size_t xStart = 0U;
+    size_t xNext = 0U;
+    size_t uxIdx;
+    eKeyMatch_t eMatch;
+    BaseType_t xEnter;
+
+    do
+    {
+        xResult = JSON_Iterate( pcObject, xObjectLength, &xStart, &xNext, &xPair );
+
+        if( ( xResult == JSONSuccess ) && ( xPair.key == NULL ) )
+        {
+            /* An array rather than an object. */
+            xResult = JSONIllegalDocument;
+        }
+
+        if( xResult == JSONSuccess )
+        {
+            pxSegments[ uxDepth ].pcKey = xPair.key;
+            pxSegments[ uxDepth ].xKeyLength = xPair.keyLength;
+            xEnter = pdFALSE;
+
+            for( uxIdx = 0U; uxIdx < xHandlerCount; uxIdx++ )
+            {
+                eMatch = prvMatchPath( pxHandlers[ uxIdx ].pcKey, pxSegments, uxDepth + 1U );
+
+                if( eMatch == eKeyMatch )
+                {
+                    pxHandlers[ uxIdx ].xHandler( xPair.value,
+                                                  xPair.valueLength,
+                                                  xPair.jsonType,
+                                                  pxHandlers[ uxIdx ].pvContext );
+                }
+                else if( ( eMatch == eKeyOnPath ) && ( xPair.jsonType == JSONObject ) )
+                {
+                    xEnter = pdTRUE;
+                }
+                else
+                {
+                    /* Not a registered key. */
+                }
+            }
+
+            /* Only enter objects that hold a registered key. */
+            if( ( xEnter == pdTRUE ) && ( ( uxDepth + 1U ) < shadowdeltaMAX_DEPTH ) )
+            {
+                eStatus = prvProcessObject( xPair.value,
+                                            xPair.valueLength,
+                                            pxSegments,
+                                            uxDepth + 1U,
+                                            pxHandlers,
+                                            xHandlerCount );
+            }
+        }
+    } while( ( xResult == JSONSuccess ) && ( eStatus == eShadowDeltaSuccess ) );
+
+    /* JSONNotFound marks the end of the object. */
+    if( ( xResult != JSONSuccess ) && ( xResult != JSONNotFound ) )
+    {
+        eStatus = eShadowDeltaIllegalDocument;
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
+
+eShadowDeltaStatus eShadowDeltaProcess( const char * pcDocument,
+                                        size_t xDocumentLength,
+                                        const ShadowDeltaHandlerEntry_t * pxHandlers,
+                                        size_t xHandlerCount )
+{
+    eShadowDeltaStatus eStatus = eShadowDeltaSuccess;
+    KeySegment_t xSegments[ shadowdeltaMAX_DEPTH ];
+    size_t uxIdx;
+
+    if( ( pcDocument == NULL ) ||
+        ( xDocumentLength == 0U ) ||
+        ( ( pxHandlers == NULL ) && ( xHandlerCount != 0U ) ) )
+    {
+        LogError( ( "Invalid parameters. pcDocument: %p, xDocumentLength: %u, "
+                    "pxHandlers: %p, xHandlerCount: %u.",
+                    pcDocument,
+                    ( unsigned int ) xDocumentLength,
+                    pxHandlers,
+                    ( unsigned int ) xHandlerCount ) );
+        eStatus = eShadowDeltaBadParameter;
+    }
+
+    for( uxIdx = 0U; ( uxIdx < xHandlerCount ) && ( eStatus == eShadowDeltaSuccess ); uxIdx++ )
+    {
+        if( ( pxHandlers[ uxIdx ].pcKey == NULL ) || ( pxHandlers[ uxIdx ].xHandler == NULL ) )
+        {
+            LogError( ( "Handler %u has no key or no function.", ( unsigned int ) uxIdx ) );
+            eStatus = eShadowDeltaBadParameter;
+        }
+    }
+
+    if( eStatus == eShadowDeltaSuccess )
+    {
+        eStatus = prvProcessObject( pcDocument,
+                                    xDocumentLength,
+                                    &( xSegments[ 0 ] ),
+                                    0U,
+                                    pxHandlers,
+                                    xHandlerCount );
+
+        if( eStatus != eShadowDeltaSuccess )
+        {
+            LogError( ( "The json document is invalid!!" ) );
+        }
+    }
+
+    return eStatus;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,111 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file shadow_delta_processor.h
+ *
+ * @brief Dispatch the keys of a Shadow document to handlers in a single walk.
+ */
+
+#ifndef SHADOW_DELTA_PROCESSOR_H_
+#define SHADOW_DELTA_PROCESSOR_H_
+
+/* Standard includes. */
+#include <stddef.h>
+
+/* JSON library includes. */
+#include "core_json.h"
+
+/**
+ * @brief Maximum nesting depth of the keys that can be dispatched.
+ *
+ * Objects nested deeper than this are skipped.
+ */
+#ifndef shadowdeltaMAX_DEPTH
+    #define shadowdeltaMAX_DEPTH    ( 4U )
+#endif
+
+/**
+ * @brief Return codes from the delta processor.
+ */
+typedef enum
+{
+    eShadowDeltaSuccess = 0,
+    eShadowDeltaBadParameter,
+    eShadowDeltaIllegalDocument
+} eShadowDeltaStatus;
+
+/**
+ * @brief Handler called for a key of the document.
+ *
+ * The value points into the document and is not terminated. Strings are given
+ * without their quotes, objects and arrays with their brackets.
+ *
+ * @param[in] pcValue The value of the key.
+ * @param[in] xValueLength The length of the value.
+ * @param[in] xType The JSON type of the value.
+ * @param[in] pvContext The context registered with the handler.
+ */
+typedef void ( * ShadowDeltaHandler_t )( const char * pcValue,
+                                         size_t xValueLength,
+                                         JSONTypes_t xType,
+                                         void * pvContext );
+
+/**
+ * @brief A handler and the key it is registered for.
+ */
+typedef struct ShadowDeltaHandlerEntry
+{
+    const char * pcKey;            /**< Dotted path of the key, e.g. "state.powerOn". */
+    ShadowDeltaHandler_t xHandler; /**< Called when the key is found. */
+    void * pvContext;              /**< Passed to the handler. */
+} ShadowDeltaHandlerEntry_t;
+
+/**
+ * @brief Walk a Shadow document once and call the handler of every registered
+ * key that it contains.
+ *
+ * Handlers are called in document order. Objects are only entered when a
+ * registered key lies inside them, so unrelated parts of the document, such as
+ * "metadata", are skipped without being looked at key by key.
+ *
+ * @param[in] pcDocument The document, e.g. the payload of `/update/delta`.
+ * @param[in] xDocumentLength The length of the document.
+ * @param[in] pxHandlers The handlers.
+ * @param[in] xHandlerCount The number of handlers.
+ *
+ * @return #eShadowDeltaSuccess if the whole document was walked;
+ * #eShadowDeltaBadParameter if invalid parameters are passed;
+ * #eShadowDeltaIllegalDocument if the document is not a JSON object or is
+ * malformed. Handlers for the keys before the malformed part may have been
+ * called.
+ */
+eShadowDeltaStatus eShadowDeltaProcess( const char * pcDocument,
+                                        size_t xDocumentLength,
+                                        const ShadowDeltaHandlerEntry_t * pxHandlers,
+                                        size_t xHandlerCount );
+
+#endif /* ifndef SHADOW_DELTA_PROCESSOR_H_ */
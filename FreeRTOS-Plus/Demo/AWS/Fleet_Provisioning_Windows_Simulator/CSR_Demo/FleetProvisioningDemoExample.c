@@ -55,6 +55,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
@@ -241,6 +242,25 @@ static MQTTFixedBuffer_t xBuffer =
     democonfigNETWORK_BUFFER_SIZE
 };
 
+#if ( democonfigPREGENERATE_KEY_PAIR != 0 )
+
+/**
+ * @brief Handle of the demo task, notified by the key generation task once
+ * it has finished.
+ */
+    static TaskHandle_t xDemoTaskHandle = NULL;
+
+/**
+ * @brief The CSR written by the key generation task.
+ */
+    static char pcPregeneratedCsr[ fpdemoCSR_BUFFER_LENGTH ];
+
+/**
+ * @brief Length of #pcPregeneratedCsr, or 0 if the key generation task failed.
+ */
+    static size_t xPregeneratedCsrLength = 0;
+#endif /* democonfigPREGENERATE_KEY_PAIR */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -290,6 +310,31 @@ static bool prvUnsubscribeFromRegisterThingResponseTopics( void );
  */
 static int prvFleetProvisioningTask( void * pvParameters );
 
+#if ( democonfigPREGENERATE_KEY_PAIR != 0 )
+
+/**
+ * @brief Task that prepares the device key pair and the CSR at boot, so that
+ * the demo task does not have to generate them once the network is up.
+ *
+ * @param[in] pvParameters Parameters as passed at the time of task creation.
+ * Not used in this example.
+ */
+    static void prvKeyGenerationTask( void * pvParameters );
+
+/**
+ * @brief Wait for the key generation task and copy its CSR.
+ *
+ * @param[out] pcCsr The buffer to copy the CSR to, of fpdemoCSR_BUFFER_LENGTH
+ * bytes.
+ * @param[out] pxCsrLength The length of the CSR.
+ *
+ * @return True if a CSR was copied, false if the key generation task failed
+ * or its CSR was used already.
+ */
+    static bool prvTakePregeneratedCsr( char * pcCsr,
+                                        size_t * pxCsrLength );
+#endif /* democonfigPREGENERATE_KEY_PAIR */
+
 
 /*-----------------------------------------------------------*/
 
@@ -519,11 +564,103 @@ static bool prvUnsubscribeFromRegisterThingResponseTopics( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( democonfigPREGENERATE_KEY_PAIR != 0 )
+
+    static void prvKeyGenerationTask( void * pvParameters )
+    {
+        CK_SESSION_HANDLE xP11Session;
+        bool xStatus = false;
+        size_t xCsrLength = 0;
+
+        ( void ) pvParameters;
+
+        if( xInitializePkcs11Session( &xP11Session ) != CKR_OK )
+        {
+            LogError( ( "Failed to initialize PKCS #11 for the key generation." ) );
+        }
+        else
+        {
+            /* A key pair stored at an earlier boot may be reused, what
+             * remains is to sign a new CSR. */
+            xStatus = xGenerateCsrForStoredKey( xP11Session,
+                                                pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS,
+                                                pcPregeneratedCsr,
+                                                fpdemoCSR_BUFFER_LENGTH,
+                                                &xCsrLength );
+
+            if( xStatus == true )
+            {
+                LogInfo( ( "Created a CSR for the stored device key pair." ) );
+            }
+            else
+            {
+                xStatus = xGenerateKeyAndCsr( xP11Session,
+                                              pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS,
+                                              pkcs11configLABEL_DEVICE_PUBLIC_KEY_FOR_TLS,
+                                              pcPregeneratedCsr,
+                                              fpdemoCSR_BUFFER_LENGTH,
+                                              &xCsrLength );
+
+                if( xStatus == true )
+                {
+                    LogInfo( ( "Generated the device key pair and its CSR." ) );
+                }
+                else
+                {
+                    LogError( ( "Failed to generate Key and Certificate Signing Request in the background." ) );
+                }
+            }
+
+            xPkcs11CloseSession( xP11Session );
+        }
+
+        xPregeneratedCsrLength = ( xStatus == true ) ? xCsrLength : 0U;
+
+        xTaskNotifyGive( xDemoTaskHandle );
+        vTaskDelete( NULL );
+    }
+/*-----------------------------------------------------------*/
+
+    static bool prvTakePregeneratedCsr( char * pcCsr,
+                                        size_t * pxCsrLength )
+    {
+        static bool xKeyTaskDone = false;
+        bool xStatus = false;
+
+        if( xKeyTaskDone == false )
+        {
+            LogInfo( ( "Waiting for the background key generation..." ) );
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+            xKeyTaskDone = true;
+        }
+
+        /* The CSR is only used once, a retry of the demo loop signs a new
+         * one. */
+        if( ( xPregeneratedCsrLength > 0U ) && ( xPregeneratedCsrLength < fpdemoCSR_BUFFER_LENGTH ) )
+        {
+            ( void ) memcpy( pcCsr, pcPregeneratedCsr, xPregeneratedCsrLength + 1U );
+            *pxCsrLength = xPregeneratedCsrLength;
+            xPregeneratedCsrLength = 0U;
+            xStatus = true;
+        }
+
+        return xStatus;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* democonfigPREGENERATE_KEY_PAIR */
+
 /**
  * @brief Create the task that demonstrates the Fleet Provisioning library API
  */
 void vStartFleetProvisioningDemo()
 {
+    TaskHandle_t * pxDemoTaskHandle = NULL;
+
+    #if ( democonfigPREGENERATE_KEY_PAIR != 0 )
+        pxDemoTaskHandle = &xDemoTaskHandle;
+    #endif
+
     /* This example uses a single application task, which shows that how to use
      * Fleet Provisioning library to generate and sign certificates with AWS IoT
      * and create new IoT Things using the AWS IoT Fleet Provisioning API */
@@ -532,7 +669,19 @@ void vStartFleetProvisioningDemo()
                  democonfigDEMO_STACKSIZE, /* Size of stack (in words, not bytes) to allocate for the task. */
                  NULL,                     /* Task parameter - not used in this case. */
                  tskIDLE_PRIORITY,         /* Task priority, must be between 0 and configMAX_PRIORITIES - 1. */
-                 NULL );                   /* Used to pass out a handle to the created task - not used in this case. */
+                 pxDemoTaskHandle );       /* Used to pass out a handle to the created task - only used to pre-generate the key pair. */
+
+    #if ( democonfigPREGENERATE_KEY_PAIR != 0 )
+        {
+            /* The key pair is generated while the network comes up. */
+            xTaskCreate( prvKeyGenerationTask,
+                         "KeyGenTask",
+                         democonfigDEMO_STACKSIZE,
+                         NULL,
+                         tskIDLE_PRIORITY,
+                         NULL );
+        }
+    #endif
 }
 
 /* This example uses a single application task, which shows that how to use
@@ -595,12 +744,23 @@ int prvFleetProvisioningTask( void * pvParameters )
         }
         else
         {
-            xStatus = xGenerateKeyAndCsr( xP11Session,
-                                          pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS,
-                                          pkcs11configLABEL_DEVICE_PUBLIC_KEY_FOR_TLS,
-                                          pcCsr,
-                                          fpdemoCSR_BUFFER_LENGTH,
-                                          &xCsrLength );
+            xStatus = false;
+
+            #if ( democonfigPREGENERATE_KEY_PAIR != 0 )
+                {
+                    xStatus = prvTakePregeneratedCsr( pcCsr, &xCsrLength );
+                }
+            #endif
+
+            if( xStatus == false )
+            {
+                xStatus = xGenerateKeyAndCsr( xP11Session,
+                                              pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS,
+                                              pkcs11configLABEL_DEVICE_PUBLIC_KEY_FOR_TLS,
+                                              pcCsr,
+                                              fpdemoCSR_BUFFER_LENGTH,
+                                              &xCsrLength );
+            }
 
             if( xStatus == false )
             {
@@ -177,6 +177,20 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define democonfigDEMO_STACKSIZE            configMINIMAL_STACK_SIZE
 
+/**
+ * @brief Set to 1 to generate the device key pair and the CSR in a background
+ * task as soon as the demo starts, while the network is still coming up,
+ * instead of in the demo task once the network is up.
+ *
+ * A key pair that is already stored in the PKCS #11 module, from an earlier
+ * boot, is reused and only a new CSR is signed with it. The provisioning
+ * session itself then only carries the CreateCertificateFromCsr and the
+ * RegisterThing exchanges.
+ */
+#ifndef democonfigPREGENERATE_KEY_PAIR
+    #define democonfigPREGENERATE_KEY_PAIR    0
+#endif
+
 /**
  * @brief Size of the network buffer for MQTT packets. Must be large enough to
  * hold the GetCertificateFromCsr response, which, among other things, includes
@@ -33,6 +33,7 @@
 /* Standard includes. */
 #include <errno.h>
 #include <assert.h>
+#include <stdio.h>
 
 /* Config include. */
 #include "demo_config.h"
@@ -54,6 +55,14 @@
 #include "mbedtls/x509_crt.h"
 #include "mbedtls/x509_csr.h"
 
+/**
+ * @brief The size of the chunks #xPkcs11DigestStream reads and passes to
+ * C_DigestUpdate.
+ */
+#ifndef democonfigPKCS11_DIGEST_CHUNK_SIZE
+    #define democonfigPKCS11_DIGEST_CHUNK_SIZE    ( 1024U )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -84,6 +93,23 @@ static CK_RV prvGenerateKeyPairEC( CK_SESSION_HANDLE xSession,
                                    CK_OBJECT_HANDLE_PTR xPrivateKeyHandlePtr,
                                    CK_OBJECT_HANDLE_PTR xPublicKeyHandlePtr );
 
+/**
+ * @brief Write a certificate signing request (CSR) for a private key.
+ *
+ * @param[in] xSession The PKCS #11 session.
+ * @param[in] xPrivKeyHandle The handle of the private key.
+ * @param[out] pcCsrBuffer The buffer to write the CSR to.
+ * @param[in] xCsrBufferLength Length of #pcCsrBuffer.
+ * @param[out] pxOutCsrLength The length of the written CSR.
+ *
+ * @return True on success.
+ */
+static bool prvWriteCsr( CK_SESSION_HANDLE xSession,
+                         CK_OBJECT_HANDLE xPrivKeyHandle,
+                         char * pcCsrBuffer,
+                         size_t xCsrBufferLength,
+                         size_t * pxOutCsrLength );
+
 /*-----------------------------------------------------------*/
 
 static CK_RV prvDestroyProvidedObjects( CK_SESSION_HANDLE xSession,
@@ -203,36 +229,18 @@ static CK_RV prvGenerateKeyPairEC( CK_SESSION_HANDLE xSession,
 
 /*-----------------------------------------------------------*/
 
-bool xGenerateKeyAndCsr( CK_SESSION_HANDLE xP11Session,
-                         const char * pcPrivKeyLabel,
-                         const char * pcPubKeyLabel,
+static bool prvWriteCsr( CK_SESSION_HANDLE xSession,
+                         CK_OBJECT_HANDLE xPrivKeyHandle,
                          char * pcCsrBuffer,
                          size_t xCsrBufferLength,
                          size_t * pxOutCsrLength )
 {
-    CK_OBJECT_HANDLE xPrivKeyHandle;
-    CK_OBJECT_HANDLE xPubKeyHandle;
-    CK_RV xPkcs11Ret = CKR_OK;
+    CK_RV xPkcs11Ret;
     mbedtls_pk_context xPrivKey;
     mbedtls_x509write_csr xReq;
     int32_t ulMbedtlsRet = -1;
-    const mbedtls_pk_info_t * pxHeader = mbedtls_pk_info_from_type( MBEDTLS_PK_ECKEY );
 
-    configASSERT( pcPrivKeyLabel != NULL );
-    configASSERT( pcPubKeyLabel != NULL );
-    configASSERT( pcCsrBuffer != NULL );
-    configASSERT( pxOutCsrLength != NULL );
-
-    xPkcs11Ret = prvGenerateKeyPairEC( xP11Session,
-                                       pcPrivKeyLabel,
-                                       pcPubKeyLabel,
-                                       &xPrivKeyHandle,
-                                       &xPubKeyHandle );
-
-    if( xPkcs11Ret == CKR_OK )
-    {
-        xPkcs11Ret = xPKCS11_initMbedtlsPkContext( &xPrivKey, xP11Session, xPrivKeyHandle );
-    }
+    xPkcs11Ret = xPKCS11_initMbedtlsPkContext( &xPrivKey, xSession, xPrivKeyHandle );
 
     if( xPkcs11Ret == CKR_OK )
     {
@@ -259,7 +267,7 @@ bool xGenerateKeyAndCsr( CK_SESSION_HANDLE xP11Session,
                                                       ( unsigned char * ) pcCsrBuffer,
                                                       xCsrBufferLength,
                                                       &lMbedCryptoRngCallbackPKCS11,
-                                                      &xP11Session );
+                                                      &xSession );
         }
 
         mbedtls_x509write_csr_free( &xReq );
@@ -274,6 +282,77 @@ bool xGenerateKeyAndCsr( CK_SESSION_HANDLE xP11Session,
 
 /*-----------------------------------------------------------*/
 
+bool xGenerateKeyAndCsr( CK_SESSION_HANDLE xP11Session,
+                         const char * pcPrivKeyLabel,
+                         const char * pcPubKeyLabel,
+                         char * pcCsrBuffer,
+                         size_t xCsrBufferLength,
+                         size_t * pxOutCsrLength )
+{
+    CK_OBJECT_HANDLE xPrivKeyHandle;
+    CK_OBJECT_HANDLE xPubKeyHandle;
+    CK_RV xPkcs11Ret = CKR_OK;
+    bool xStatus = false;
+
+    configASSERT( pcPrivKeyLabel != NULL );
+    configASSERT( pcPubKeyLabel != NULL );
+    configASSERT( pcCsrBuffer != NULL );
+    configASSERT( pxOutCsrLength != NULL );
+
+    xPkcs11Ret = prvGenerateKeyPairEC( xP11Session,
+                                       pcPrivKeyLabel,
+                                       pcPubKeyLabel,
+                                       &xPrivKeyHandle,
+                                       &xPubKeyHandle );
+
+    if( xPkcs11Ret == CKR_OK )
+    {
+        xStatus = prvWriteCsr( xP11Session, xPrivKeyHandle, pcCsrBuffer, xCsrBufferLength, pxOutCsrLength );
+    }
+    else
+    {
+        *pxOutCsrLength = 0;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+bool xGenerateCsrForStoredKey( CK_SESSION_HANDLE xP11Session,
+                               const char * pcPrivKeyLabel,
+                               char * pcCsrBuffer,
+                               size_t xCsrBufferLength,
+                               size_t * pxOutCsrLength )
+{
+    CK_OBJECT_HANDLE xPrivKeyHandle = CK_INVALID_HANDLE;
+    CK_RV xPkcs11Ret;
+    bool xStatus = false;
+
+    configASSERT( pcPrivKeyLabel != NULL );
+    configASSERT( pcCsrBuffer != NULL );
+    configASSERT( pxOutCsrLength != NULL );
+
+    *pxOutCsrLength = 0;
+
+    xPkcs11Ret = xFindObjectWithLabelAndClass( xP11Session, ( char * ) pcPrivKeyLabel,
+                                               strnlen( pcPrivKeyLabel, pkcs11configMAX_LABEL_LENGTH ),
+                                               CKO_PRIVATE_KEY, &xPrivKeyHandle );
+
+    if( ( xPkcs11Ret == CKR_OK ) && ( xPrivKeyHandle != CK_INVALID_HANDLE ) )
+    {
+        xStatus = prvWriteCsr( xP11Session, xPrivKeyHandle, pcCsrBuffer, xCsrBufferLength, pxOutCsrLength );
+    }
+    else
+    {
+        LogDebug( ( "No stored private key with label %s.", pcPrivKeyLabel ) );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
 bool xLoadCertificate( CK_SESSION_HANDLE xP11Session,
                        const char * pcCertificate,
                        const char * pcLabel,
@@ -380,6 +459,295 @@ bool xLoadCertificate( CK_SESSION_HANDLE xP11Session,
 
 /*-----------------------------------------------------------*/
 
+bool xPkcs11DigestStart( CK_SESSION_HANDLE xP11Session )
+{
+    CK_RV xResult = CKR_OK;
+    CK_FUNCTION_LIST_PTR xFunctionList = NULL;
+    CK_MECHANISM xDigestMechanism = { CKM_SHA256, NULL, 0 };
+
+    xResult = C_GetFunctionList( &xFunctionList );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFunctionList->C_DigestInit( xP11Session, &xDigestMechanism );
+    }
+
+    if( xResult != CKR_OK )
+    {
+        LogError( ( "Failed to start a SHA-256 digest: 0x%lx.", ( unsigned long ) xResult ) );
+    }
+
+    return( xResult == CKR_OK );
+}
+
+/*-----------------------------------------------------------*/
+
+bool xPkcs11DigestUpdate( CK_SESSION_HANDLE xP11Session,
+                          const uint8_t * pucData,
+                          size_t xDataLength )
+{
+    CK_RV xResult = CKR_OK;
+    CK_FUNCTION_LIST_PTR xFunctionList = NULL;
+
+    configASSERT( ( pucData != NULL ) || ( xDataLength == 0U ) );
+
+    xResult = C_GetFunctionList( &xFunctionList );
+
+    if( ( xResult == CKR_OK ) && ( xDataLength > 0U ) )
+    {
+        xResult = xFunctionList->C_DigestUpdate( xP11Session,
+                                                 ( CK_BYTE_PTR ) pucData,
+                                                 ( CK_ULONG ) xDataLength );
+    }
+
+    if( xResult != CKR_OK )
+    {
+        LogError( ( "Failed to update a SHA-256 digest: 0x%lx.", ( unsigned long ) xResult ) );
+    }
+
+    return( xResult == CKR_OK );
+}
+
+/*-----------------------------------------------------------*/
+
+bool xPkcs11DigestFinish( CK_SESSION_HANDLE xP11Session,
+                          uint8_t * pucDigest )
+{
+    CK_RV xResult = CKR_OK;
+    CK_FUNCTION_LIST_PTR xFunctionList = NULL;
+    CK_ULONG ulDigestLength = pkcs11SHA256_DIGEST_LENGTH;
+
+    configASSERT( pucDigest != NULL );
+
+    xResult = C_GetFunctionList( &xFunctionList );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFunctionList->C_DigestFinal( xP11Session, pucDigest, &ulDigestLength );
+    }
+
+    if( xResult != CKR_OK )
+    {
+        LogError( ( "Failed to finish a SHA-256 digest: 0x%lx.", ( unsigned long ) xResult ) );
+    }
+
+    return( ( xResult == CKR_OK ) && ( ulDigestLength == pkcs11SHA256_DIGEST_LENGTH ) );
+}
+
+/*-----------------------------------------------------------*/
+
+bool xPkcs11DigestStream( CK_SESSION_HANDLE xP11Session,
+                          Pkcs11StreamReader_t xReader,
+                          void * pvContext,
+                          uint8_t * pucDigest )
+{
+    bool xStatus = false;
+    uint8_t * pucChunk = NULL;
+    uint8_t ucDiscard[ pkcs11SHA256_DIGEST_LENGTH ];
+    int32_t lBytesRead = 0;
+
+    configASSERT( xReader != NULL );
+    configASSERT( pucDigest != NULL );
+
+    pucChunk = ( uint8_t * ) malloc( democonfigPKCS11_DIGEST_CHUNK_SIZE );
+
+    if( pucChunk == NULL )
+    {
+        LogError( ( "Failed to allocate a buffer for digesting a stream." ) );
+    }
+    else
+    {
+        xStatus = xPkcs11DigestStart( xP11Session );
+
+        while( xStatus == true )
+        {
+            lBytesRead = xReader( pvContext, pucChunk, democonfigPKCS11_DIGEST_CHUNK_SIZE );
+
+            if( lBytesRead <= 0 )
+            {
+                break;
+            }
+
+            xStatus = xPkcs11DigestUpdate( xP11Session, pucChunk, ( size_t ) lBytesRead );
+        }
+
+        if( xStatus == true )
+        {
+            if( lBytesRead < 0 )
+            {
+                LogError( ( "Failed to read the stream being digested." ) );
+
+                /* Finish the digest anyway, so the session can start another. */
+                ( void ) xPkcs11DigestFinish( xP11Session, ucDiscard );
+                xStatus = false;
+            }
+            else
+            {
+                xStatus = xPkcs11DigestFinish( xP11Session, pucDigest );
+            }
+        }
+
+        free( pucChunk );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvReadFile( void * pvContext,
+                            uint8_t * pucBuffer,
+                            size_t xBufferLength )
+{
+    FILE * pxFile = ( FILE * ) pvContext;
+    size_t xBytesRead;
+
+    xBytesRead = fread( pucBuffer, 1, xBufferLength, pxFile );
+
+    return ( ( xBytesRead == 0U ) && ( ferror( pxFile ) != 0 ) ) ? -1 : ( int32_t ) xBytesRead;
+}
+
+/*-----------------------------------------------------------*/
+
+bool xPkcs11DigestFile( CK_SESSION_HANDLE xP11Session,
+                        const char * pcFilePath,
+                        uint8_t * pucDigest )
+{
+    bool xStatus = false;
+    FILE * pxFile = NULL;
+
+    configASSERT( pcFilePath != NULL );
+
+    pxFile = fopen( pcFilePath, "rb" );
+
+    if( pxFile == NULL )
+    {
+        LogError( ( "Failed to open \"%s\" for digesting: %d.", pcFilePath, errno ) );
+    }
+    else
+    {
+        xStatus = xPkcs11DigestStream( xP11Session, prvReadFile, pxFile, pucDigest );
+        fclose( pxFile );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+bool xPkcs11SignDigest( CK_SESSION_HANDLE xP11Session,
+                        const char * pcPrivKeyLabel,
+                        const uint8_t * pucDigest,
+                        uint8_t * pucSignature,
+                        size_t xSignatureBufferLength,
+                        size_t * pxOutSignatureLength )
+{
+    CK_RV xResult = CKR_OK;
+    CK_FUNCTION_LIST_PTR xFunctionList = NULL;
+    CK_MECHANISM xMechanism = { CKM_ECDSA, NULL, 0 };
+    CK_OBJECT_HANDLE xPrivKeyHandle = CK_INVALID_HANDLE;
+    CK_ULONG ulSignatureLength = ( CK_ULONG ) xSignatureBufferLength;
+
+    configASSERT( pcPrivKeyLabel != NULL );
+    configASSERT( pucDigest != NULL );
+    configASSERT( pucSignature != NULL );
+    configASSERT( pxOutSignatureLength != NULL );
+
+    xResult = C_GetFunctionList( &xFunctionList );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFindObjectWithLabelAndClass( xP11Session, ( char * ) pcPrivKeyLabel,
+                                                strnlen( pcPrivKeyLabel, pkcs11configMAX_LABEL_LENGTH ),
+                                                CKO_PRIVATE_KEY, &xPrivKeyHandle );
+    }
+
+    if( ( xResult == CKR_OK ) && ( xPrivKeyHandle == CK_INVALID_HANDLE ) )
+    {
+        xResult = CKR_KEY_HANDLE_INVALID;
+    }
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFunctionList->C_SignInit( xP11Session, &xMechanism, xPrivKeyHandle );
+    }
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFunctionList->C_Sign( xP11Session,
+                                         ( CK_BYTE_PTR ) pucDigest,
+                                         pkcs11SHA256_DIGEST_LENGTH,
+                                         pucSignature,
+                                         &ulSignatureLength );
+    }
+
+    if( xResult == CKR_OK )
+    {
+        *pxOutSignatureLength = ( size_t ) ulSignatureLength;
+    }
+    else
+    {
+        LogError( ( "Failed to sign with \"%s\": 0x%lx.", pcPrivKeyLabel, ( unsigned long ) xResult ) );
+    }
+
+    return( xResult == CKR_OK );
+}
+
+/*-----------------------------------------------------------*/
+
+bool xPkcs11VerifyDigest( CK_SESSION_HANDLE xP11Session,
+                          const char * pcPubKeyLabel,
+                          const uint8_t * pucDigest,
+                          const uint8_t * pucSignature,
+                          size_t xSignatureLength )
+{
+    CK_RV xResult = CKR_OK;
+    CK_FUNCTION_LIST_PTR xFunctionList = NULL;
+    CK_MECHANISM xMechanism = { CKM_ECDSA, NULL, 0 };
+    CK_OBJECT_HANDLE xPubKeyHandle = CK_INVALID_HANDLE;
+
+    configASSERT( pcPubKeyLabel != NULL );
+    configASSERT( pucDigest != NULL );
+    configASSERT( pucSignature != NULL );
+
+    xResult = C_GetFunctionList( &xFunctionList );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFindObjectWithLabelAndClass( xP11Session, ( char * ) pcPubKeyLabel,
+                                                strnlen( pcPubKeyLabel, pkcs11configMAX_LABEL_LENGTH ),
+                                                CKO_PUBLIC_KEY, &xPubKeyHandle );
+    }
+
+    if( ( xResult == CKR_OK ) && ( xPubKeyHandle == CK_INVALID_HANDLE ) )
+    {
+        xResult = CKR_KEY_HANDLE_INVALID;
+    }
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFunctionList->C_VerifyInit( xP11Session, &xMechanism, xPubKeyHandle );
+    }
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFunctionList->C_Verify( xP11Session,
+                                           ( CK_BYTE_PTR ) pucDigest,
+                                           pkcs11SHA256_DIGEST_LENGTH,
+                                           ( CK_BYTE_PTR ) pucSignature,
+                                           ( CK_ULONG ) xSignatureLength );
+    }
+
+    if( xResult != CKR_OK )
+    {
+        LogError( ( "Signature verification with \"%s\" failed: 0x%lx.", pcPubKeyLabel, ( unsigned long ) xResult ) );
+    }
+
+    return( xResult == CKR_OK );
+}
+
+/*-----------------------------------------------------------*/
+
 bool xPkcs11CloseSession( CK_SESSION_HANDLE xP11Session )
 {
     CK_RV xResult = CKR_OK;
@@ -30,6 +30,7 @@
 /* Standard includes. */
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* corePKCS11 include. */
 #include "core_pkcs11.h"
@@ -58,6 +59,25 @@ bool xGenerateKeyAndCsr( CK_SESSION_HANDLE xP11Session,
                          size_t xCsrBufferLength,
                          size_t * pcOutCsrLength );
 
+/**
+ * @brief Generate a certificate signing request (CSR) for a private key that
+ * is already stored in the PKCS #11 module, for example by an earlier call to
+ * #xGenerateKeyAndCsr. Only a signature is computed, no key pair is generated.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ * @param[in] pcPrivKeyLabel PKCS #11 label of the private key.
+ * @param[out] pcCsrBuffer The buffer to write the CSR to.
+ * @param[in] xCsrBufferLength Length of #pcCsrBuffer.
+ * @param[out] pxOutCsrLength The length of the written CSR.
+ *
+ * @return True on success, false if there is no such key or on error.
+ */
+bool xGenerateCsrForStoredKey( CK_SESSION_HANDLE xP11Session,
+                               const char * pcPrivKeyLabel,
+                               char * pcCsrBuffer,
+                               size_t xCsrBufferLength,
+                               size_t * pxOutCsrLength );
+
 /**
  * @brief Save the device client certificate into the PKCS #11 module.
  *
@@ -73,6 +93,122 @@ bool xLoadCertificate( CK_SESSION_HANDLE xP11Session,
                        const char * pcLabel,
                        size_t xCertificateLength );
 
+/**
+ * @brief Read the next part of a stream that is being digested.
+ *
+ * @param[in] pvContext The context passed to #xPkcs11DigestStream.
+ * @param[out] pucBuffer The buffer to read into.
+ * @param[in] xBufferLength Length of #pucBuffer.
+ *
+ * @return The number of bytes read, 0 at the end of the stream, or a negative
+ * value on error.
+ */
+typedef int32_t ( * Pkcs11StreamReader_t )( void * pvContext,
+                                            uint8_t * pucBuffer,
+                                            size_t xBufferLength );
+
+/**
+ * @brief Start a SHA-256 digest that is fed with #xPkcs11DigestUpdate, for
+ * example with each part of a file while it is downloaded.
+ *
+ * Only one digest can be in progress on a session at a time.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ *
+ * @return True on success.
+ */
+bool xPkcs11DigestStart( CK_SESSION_HANDLE xP11Session );
+
+/**
+ * @brief Add data to the digest started by #xPkcs11DigestStart.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ * @param[in] pucData The data to add.
+ * @param[in] xDataLength Length of #pucData.
+ *
+ * @return True on success.
+ */
+bool xPkcs11DigestUpdate( CK_SESSION_HANDLE xP11Session,
+                          const uint8_t * pucData,
+                          size_t xDataLength );
+
+/**
+ * @brief Finish the digest started by #xPkcs11DigestStart.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ * @param[out] pucDigest The SHA-256 digest, pkcs11SHA256_DIGEST_LENGTH bytes.
+ *
+ * @return True on success.
+ */
+bool xPkcs11DigestFinish( CK_SESSION_HANDLE xP11Session,
+                          uint8_t * pucDigest );
+
+/**
+ * @brief Compute the SHA-256 digest of a stream, such as a file or a socket,
+ * reading it in chunks of democonfigPKCS11_DIGEST_CHUNK_SIZE bytes so that it
+ * never needs to be in memory as a whole.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ * @param[in] xReader The function that reads the stream.
+ * @param[in] pvContext Passed to #xReader.
+ * @param[out] pucDigest The SHA-256 digest, pkcs11SHA256_DIGEST_LENGTH bytes.
+ *
+ * @return True on success.
+ */
+bool xPkcs11DigestStream( CK_SESSION_HANDLE xP11Session,
+                          Pkcs11StreamReader_t xReader,
+                          void * pvContext,
+                          uint8_t * pucDigest );
+
+/**
+ * @brief Compute the SHA-256 digest of a file with #xPkcs11DigestStream.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ * @param[in] pcFilePath The file to digest.
+ * @param[out] pucDigest The SHA-256 digest, pkcs11SHA256_DIGEST_LENGTH bytes.
+ *
+ * @return True on success.
+ */
+bool xPkcs11DigestFile( CK_SESSION_HANDLE xP11Session,
+                        const char * pcFilePath,
+                        uint8_t * pucDigest );
+
+/**
+ * @brief Sign a SHA-256 digest with an ECDSA private key.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ * @param[in] pcPrivKeyLabel PKCS #11 label for the private key.
+ * @param[in] pucDigest The SHA-256 digest to sign.
+ * @param[out] pucSignature The raw 64 byte signature, r followed by s.
+ * @param[in] xSignatureBufferLength Length of #pucSignature.
+ * @param[out] pxOutSignatureLength The length of the written signature.
+ *
+ * @return True on success.
+ */
+bool xPkcs11SignDigest( CK_SESSION_HANDLE xP11Session,
+                        const char * pcPrivKeyLabel,
+                        const uint8_t * pucDigest,
+                        uint8_t * pucSignature,
+                        size_t xSignatureBufferLength,
+                        size_t * pxOutSignatureLength );
+
+/**
+ * @brief Verify an ECDSA signature of a SHA-256 digest.
+ *
+ * @param[in] xP11Session The PKCS #11 session to use.
+ * @param[in] pcPubKeyLabel PKCS #11 label for the public key.
+ * @param[in] pucDigest The SHA-256 digest that was signed.
+ * @param[in] pucSignature The raw 64 byte signature, r followed by s.
+ * @param[in] xSignatureLength Length of #pucSignature.
+ *
+ * @return True if the signature is valid.
+ */
+bool xPkcs11VerifyDigest( CK_SESSION_HANDLE xP11Session,
+                          const char * pcPubKeyLabel,
+                          const uint8_t * pucDigest,
+                          const uint8_t * pucSignature,
+                          size_t xSignatureLength );
+
 /**
  * @brief Close the PKCS #11 session.
  *
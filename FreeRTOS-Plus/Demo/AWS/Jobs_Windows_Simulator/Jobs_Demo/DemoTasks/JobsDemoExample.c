@@ -54,10 +54,23 @@
  * contain a "message" and "topic" to publish to, e.g.
  * { "action": "publish", "topic": "demo/jobs", "message": "Hello World!" }.
  * An "exit" job exits the demo. Sending { "action": "exit" } will end the demo program.
+ *
+ * Jobs are run as a pipeline, so that a device with many small jobs queued
+ * does not wait for a round trip to the service between them. The demo task
+ * fetches the list of pending jobs, and requests the documents of as many of
+ * them as there are free job slots. A job is handed to a pool of worker tasks
+ * as soon as its document arrives, while the documents of the next jobs are
+ * still on the way. The demo task sends the status updates of all the jobs
+ * that finished since its last pass together, without waiting for the
+ * acknowledgement of each one, and fetches the pending jobs again when a slot
+ * is free. Only the demo task uses the MQTT connection, so the workers leave
+ * the publish of a "publish" job to it. An "exit" job lets the jobs already
+ * started finish before the demo ends.
  */
 
 /* Standard includes. */
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
@@ -79,6 +92,9 @@
 /* Include common MQTT demo helpers. */
 #include "mqtt_demo_helpers.h"
 
+/* Arena allocator include. */
+#include "arena.h"
+
 /*------------- Demo configurations -------------------------*/
 
 #ifndef democonfigTHING_NAME
@@ -180,16 +196,28 @@
  */
 #define jobsexampleQUERY_KEY_FOR_TOPIC_LENGTH       ( sizeof( jobsexampleQUERY_KEY_FOR_TOPIC ) - 1 )
 
+/**
+ * @brief The keys of the lists of jobs in the response of the
+ * GetPendingJobExecutions API, in the order in which they are run.
+ */
+#define jobsexamplePENDING_JOBS_LIST_KEYS    { "inProgressJobs", "queuedJobs" }
+
+/**
+ * @brief The longest query for the ID of a job in a list of pending jobs,
+ * such as "inProgressJobs[12].jobId".
+ */
+#define jobsexamplePENDING_JOB_QUERY_LENGTH    ( 32U )
+
 /**
  * @brief Utility macro to generate the PUBLISH topic string to the
- * DescribeJobExecution API of AWS IoT Jobs service for requesting
- * the next pending job information.
+ * GetPendingJobExecutions API of AWS IoT Jobs service for requesting
+ * the list of the pending jobs.
  *
  * @param[in] thingName The name of the Thing resource to query for the
- * next pending job.
+ * pending jobs.
  */
-#define DESCRIBE_NEXT_JOB_TOPIC( thingName ) \
-    ( JOBS_API_PREFIX thingName JOBS_API_BRIDGE JOBS_API_JOBID_NEXT "/" JOBS_API_GETPENDING )
+#define GET_PENDING_JOBS_TOPIC( thingName ) \
+    ( JOBS_API_PREFIX thingName JOBS_API_BRIDGE JOBS_API_GETPENDING )
 
 /**
  * @brief Utility macro to generate the subscription topic string for the
@@ -230,6 +258,45 @@
  */
 #define JOBS_MESSAGE_QUEUE_LEN                       ( 10U )
 
+/**
+ * @brief The number of worker tasks that run jobs.
+ */
+#ifndef jobsexampleWORKER_COUNT
+    #define jobsexampleWORKER_COUNT    ( 2U )
+#endif
+
+/**
+ * @brief The number of jobs that can be fetched, run or reported at the same
+ * time. Slots beyond #jobsexampleWORKER_COUNT hold the documents fetched
+ * ahead for the next jobs.
+ *
+ * @note MAX_OUTGOING_PUBLISHES in demo_config.h must allow for a request or a
+ * status update per slot, and a publish for a "publish" job.
+ */
+#ifndef jobsexampleMAX_JOBS_IN_FLIGHT
+    #define jobsexampleMAX_JOBS_IN_FLIGHT    ( 4U )
+#endif
+
+/**
+ * @brief The longest job document that can be run.
+ */
+#ifndef jobsexampleMAX_JOB_DOCUMENT_LENGTH
+    #define jobsexampleMAX_JOB_DOCUMENT_LENGTH    ( 512U )
+#endif
+
+/**
+ * @brief The size of the arena the incoming Jobs messages are copied to until
+ * they are handled.  The arena is reset once the messages received by each
+ * call to MQTT_ProcessLoop() have been handled, so it must hold all of them.
+ */
+#ifndef jobsexampleMESSAGE_ARENA_SIZE
+    #define jobsexampleMESSAGE_ARENA_SIZE    ( 2U * democonfigNETWORK_BUFFER_SIZE )
+#endif
+
+#if ( jobsexampleMAX_JOBS_IN_FLIGHT < jobsexampleWORKER_COUNT )
+    #error "jobsexampleMAX_JOBS_IN_FLIGHT must be at least jobsexampleWORKER_COUNT."
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -243,6 +310,44 @@ typedef enum JobActionType
     JOB_ACTION_UNKNOWN  /**< Unknown action. */
 } JobActionType;
 
+/**
+ * @brief The stages of a job in the pipeline.
+ */
+typedef enum JobSlotState
+{
+    JOB_SLOT_FREE,     /**< The slot holds no job. */
+    JOB_SLOT_FETCHING, /**< The job document has been requested. */
+    JOB_SLOT_RUNNING,  /**< The job is with a worker, or waits to be reported. */
+    JOB_SLOT_UPDATING  /**< The status update has been sent. */
+} JobSlotState;
+
+/**
+ * @brief A job in the pipeline. The demo task owns the slot, except while it
+ * is in #xJobWorkQueue or with a worker.
+ */
+typedef struct JobSlot
+{
+    JobSlotState xState;
+    char pcJobId[ JOBS_JOBID_MAX_LENGTH ];
+    uint16_t usJobIdLength;
+    char pcJobDocument[ jobsexampleMAX_JOB_DOCUMENT_LENGTH ];
+    size_t uxJobDocumentLength;
+
+    /* Set by the worker that ran the job. The topic and message of a
+     * "publish" job point into pcJobDocument. */
+    JobActionType xAction;
+    const char * pcStatusReport;
+    char * pcTopic;
+    size_t uxTopicLength;
+    char * pcMessage;
+    size_t uxMessageLength;
+
+    /* The topics of the requests for the job, which have to stay valid until
+     * they are acknowledged. */
+    char pcDescribeTopic[ JOBS_API_MAX_LENGTH( THING_NAME_LENGTH ) ];
+    char pcUpdateTopic[ JOBS_API_MAX_LENGTH( THING_NAME_LENGTH ) ];
+} JobSlot;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -280,19 +385,11 @@ static TlsTransportParams_t xTlsTransportParams;
 static uint8_t usMqttConnectionBuffer[ democonfigNETWORK_BUFFER_SIZE ];
 
 /**
- * @brief Static buffer used to hold the job ID of the single job that
- * is executed at a time in the demo. This buffer allows re-use of the MQTT
- * connection context for sending status updates of a job while it is being
- * processed.
- */
-static uint8_t usJobIdBuffer[ democonfigNETWORK_BUFFER_SIZE ];
-
-/**
- * @brief Static buffer used to hold the job document of the single job that
- * is executed at a time in the demo. This buffer allows re-use of the MQTT
- * connection context for sending status updates of a job while it is being processed.
+ * @brief The jobs in the pipeline. Each slot holds a copy of the job ID and
+ * document, so that the MQTT connection buffer can be used for other messages
+ * while the job is fetched, run and reported.
  */
-static uint8_t usJobsDocumentBuffer[ democonfigNETWORK_BUFFER_SIZE ];
+static JobSlot xJobSlots[ jobsexampleMAX_JOBS_IN_FLIGHT ];
 
 /**
  * @brief Static buffer used to hold MQTT messages being sent and received.
@@ -322,6 +419,40 @@ static BaseType_t xDemoEncounteredError = pdFALSE;
  */
 static QueueHandle_t xJobMessageQueue;
 
+/**
+ * @brief The arena the messages in #xJobMessageQueue are copied to, and its
+ * memory.
+ */
+static Arena_t xJobMessageArena;
+static uint8_t ucJobMessageArenaBuffer[ jobsexampleMESSAGE_ARENA_SIZE ];
+
+/**
+ * @brief Queue of the jobs for the worker tasks to run.
+ */
+static QueueHandle_t xJobWorkQueue;
+
+/**
+ * @brief Queue of the jobs that the worker tasks have run, to be reported by
+ * the demo task.
+ */
+static QueueHandle_t xJobDoneQueue;
+
+/**
+ * @brief The worker tasks.
+ */
+static TaskHandle_t xJobWorkerTasks[ jobsexampleWORKER_COUNT ];
+
+/**
+ * @brief pdTRUE while a request for the list of pending jobs is outstanding.
+ */
+static BaseType_t xPendingJobsRequested = pdFALSE;
+
+/**
+ * @brief pdTRUE when the list of pending jobs may have changed since it was
+ * last fetched, because a job finished or the service notified a change.
+ */
+static BaseType_t xPendingJobsChanged = pdTRUE;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -351,44 +482,112 @@ static void prvEventCallback( MQTTContext_t * pxMqttContext,
                               MQTTDeserializedInfo_t * pxDeserializedInfo );
 
 /**
- * @brief Process payload from NextJobExecutionChanged and DescribeJobExecution
- * API MQTT topics of AWS IoT Jobs service.
- *
- * This handler parses the received payload about the next pending job, identifies
- * the action requested in the job document, and executes the action.
+ * @brief Process a message from the NextJobExecutionChanged,
+ * GetPendingJobExecutions and DescribeJobExecution APIs of AWS IoT Jobs
+ * service, queued by prvEventCallback().
  *
- * @param[in] pPublishInfo Deserialized publish info pointer for the incoming
+ * @param[in] pxPublishInfo Deserialized publish info pointer for the incoming
  * packet.
  */
-static void prvNextJobHandler( MQTTPublishInfo_t * pxPublishInfo );
+static void prvJobMessageHandler( MQTTPublishInfo_t * pxPublishInfo );
+
+/**
+ * @brief Request the documents of the pending jobs, for as many of them as
+ * there are free slots.
+ *
+ * @param[in] pcPayload The response of the GetPendingJobExecutions API.
+ * @param[in] uxPayloadLength The length of @p pcPayload.
+ */
+static void prvFetchPendingJobs( char * pcPayload,
+                                 size_t uxPayloadLength );
+
+/**
+ * @brief Hand a job whose document has arrived to the workers.
+ *
+ * @param[in] pcPayload The response of the DescribeJobExecution API.
+ * @param[in] uxPayloadLength The length of @p pcPayload.
+ * @param[in] pcJobId The job ID in the topic of the response.
+ * @param[in] usJobIdLength The length of @p pcJobId.
+ */
+static void prvStartJob( char * pcPayload,
+                         size_t uxPayloadLength,
+                         const char * pcJobId,
+                         uint16_t usJobIdLength );
+
+/**
+ * @brief Find the slot of a job, or a free slot.
+ *
+ * @param[in] pcJobId The job ID, or NULL for a free slot.
+ * @param[in] usJobIdLength The length of @p pcJobId.
+ *
+ * @return The slot; NULL if there is none.
+ */
+static JobSlot * prvFindJobSlot( const char * pcJobId,
+                                 uint16_t usJobIdLength );
+
+/**
+ * @brief Count the slots that hold a job.
+ *
+ * @return The number of jobs in the pipeline.
+ */
+static UBaseType_t prvCountBusyJobSlots( void );
+
+/**
+ * @brief Request the list of pending jobs, if it may have changed and a slot
+ * is free.
+ *
+ * @return pdPASS if the request was sent or was not needed; pdFAIL otherwise.
+ */
+static BaseType_t prvRequestPendingJobs( void );
+
+/**
+ * @brief Send the status updates of all the jobs the workers have finished,
+ * without waiting for the acknowledgement of each one.
+ */
+static void prvSendJobUpdates( void );
 
 /**
  * @brief Sends an update for a job to the UpdateJobExecution API of the AWS IoT Jobs service.
  *
- * @param[in] pcJobId The job ID whose status has to be updated.
- * @param[in] usJobIdLength The length of the job ID string.
- * @param[in] pcJobStatusReport The JSON formatted report to send to the AWS IoT Jobs service
- * to update the status of @p pcJobId.
+ * @param[in] pxJob The job, with the JSON formatted report to send to the
+ * AWS IoT Jobs service in pcStatusReport.
  */
-static void prvSendUpdateForJob( char * pcJobId,
-                                 uint16_t usJobIdLength,
-                                 const char * pcJobStatusReport );
+static void prvSendUpdateForJob( JobSlot * pxJob );
 
 /**
- * @brief Executes a job received from AWS IoT Jobs service and sends an update back to the service.
- * It parses the received job document, executes the job depending on the job "Action" type, and
- * sends an update to AWS for the Job.
+ * @brief Called when the status update of a job has been acknowledged, to
+ * free its slot.
  *
- * @param[in] pcJobId The ID of the job to execute.
- * @param[in] usJobIdLength The length of the job ID string.
- * @param[in] pcJobDocument The JSON document associated with the @a pcJobID job
- * that is to be processed.
- * @param[in] usDocumentLength The length of the job document.
+ * @param[in] pvCallbackContext The #JobSlot of the job.
+ * @param[in] usPacketId The packet identifier of the update.
+ * @param[in] xAcked pdTRUE if the update was acknowledged.
  */
-static void prvProcessJobDocument( char * pcJobId,
-                                   uint16_t usJobIdLength,
-                                   char * pcJobDocument,
-                                   size_t uxJobDocumentLength );
+static void prvJobUpdateComplete( void * pvCallbackContext,
+                                  uint16_t usPacketId,
+                                  BaseType_t xAcked );
+
+/**
+ * @brief Wait for the workers to return the jobs they hold, and free all the
+ * slots.
+ */
+static void prvReleaseJobSlots( void );
+
+/**
+ * @brief Executes a job received from AWS IoT Jobs service.
+ * It parses the job document and executes the job depending on the job
+ * "Action" type. The result is left in the slot for the demo task to report,
+ * together with the message to publish for a "publish" job.
+ *
+ * @param[in] pxJob The job to execute.
+ */
+static void prvProcessJobDocument( JobSlot * pxJob );
+
+/**
+ * @brief The worker tasks, which run the jobs from #xJobWorkQueue.
+ *
+ * @param[in] pvParameters Not used.
+ */
+static void prvJobWorkerTask( void * pvParameters );
 
 /**
  * @brief The task used to demonstrate the Jobs library API.
@@ -427,68 +626,437 @@ static JobActionType prvGetAction( const char * pcAction,
     return xAction;
 }
 
-static void prvSendUpdateForJob( char * pcJobId,
-                                 uint16_t usJobIdLength,
-                                 const char * pcJobStatusReport )
+static JobSlot * prvFindJobSlot( const char * pcJobId,
+                                 uint16_t usJobIdLength )
+{
+    JobSlot * pxFound = NULL;
+    UBaseType_t uxIndex;
+
+    for( uxIndex = 0U; ( uxIndex < jobsexampleMAX_JOBS_IN_FLIGHT ) && ( pxFound == NULL ); uxIndex++ )
+    {
+        if( pcJobId == NULL )
+        {
+            if( xJobSlots[ uxIndex ].xState == JOB_SLOT_FREE )
+            {
+                pxFound = &( xJobSlots[ uxIndex ] );
+            }
+        }
+        else if( ( xJobSlots[ uxIndex ].xState != JOB_SLOT_FREE ) &&
+                 ( xJobSlots[ uxIndex ].usJobIdLength == usJobIdLength ) &&
+                 ( memcmp( xJobSlots[ uxIndex ].pcJobId, pcJobId, usJobIdLength ) == 0 ) )
+        {
+            pxFound = &( xJobSlots[ uxIndex ] );
+        }
+    }
+
+    return pxFound;
+}
+
+static UBaseType_t prvCountBusyJobSlots( void )
+{
+    UBaseType_t uxIndex, uxBusy = 0U;
+
+    for( uxIndex = 0U; uxIndex < jobsexampleMAX_JOBS_IN_FLIGHT; uxIndex++ )
+    {
+        if( xJobSlots[ uxIndex ].xState != JOB_SLOT_FREE )
+        {
+            uxBusy++;
+        }
+    }
+
+    return uxBusy;
+}
+
+static BaseType_t prvRequestPendingJobs( void )
+{
+    BaseType_t xStatus = pdPASS;
+
+    if( ( xPendingJobsChanged == pdTRUE ) &&
+        ( xPendingJobsRequested == pdFALSE ) &&
+        ( xExitActionJobReceived == pdFALSE ) &&
+        ( prvFindJobSlot( NULL, 0U ) != NULL ) )
+    {
+        /* Publish to AWS IoT Jobs on the GetPendingJobExecutions API to request the pending jobs.
+         *
+         * Note: It is not required to make MQTT subscriptions to the response topics of the
+         * GetPendingJobExecutions and DescribeJobExecution APIs because the AWS IoT Jobs service
+         * sends responses for the PUBLISH commands on the same MQTT connection irrespective of
+         * whether the client has subscribed to the response topics or not.
+         * This demo processes incoming messages from the response topics of the APIs in the
+         * prvEventCallback() handler that is supplied to the coreMQTT library. */
+        xStatus = xPublishToTopicPipelined( &xMqttContext,
+                                            GET_PENDING_JOBS_TOPIC( democonfigTHING_NAME ),
+                                            sizeof( GET_PENDING_JOBS_TOPIC( democonfigTHING_NAME ) ) - 1,
+                                            NULL,
+                                            0,
+                                            NULL,
+                                            NULL,
+                                            NULL );
+
+        if( xStatus == pdPASS )
+        {
+            xPendingJobsRequested = pdTRUE;
+            xPendingJobsChanged = pdFALSE;
+        }
+        else
+        {
+            LogError( ( "Failed to publish to GetPendingJobExecutions API of AWS IoT Jobs service: "
+                        "Topic=%s", GET_PENDING_JOBS_TOPIC( democonfigTHING_NAME ) ) );
+        }
+    }
+
+    return xStatus;
+}
+
+static void prvFetchPendingJobs( char * pcPayload,
+                                 size_t uxPayloadLength )
+{
+    static const char * const pcListKeys[] = jobsexamplePENDING_JOBS_LIST_KEYS;
+    char pcQuery[ jobsexamplePENDING_JOB_QUERY_LENGTH ];
+    char * pcJobId = NULL;
+    size_t ulJobIdLength = 0UL;
+    size_t uxQueryLength;
+    size_t uxTopicLength = 0U;
+    UBaseType_t uxList, uxIndex;
+    JobSlot * pxJob = NULL;
+    BaseType_t xSlotsLeft = pdTRUE;
+
+    /* Check validity of JSON message response from server.*/
+    if( JSON_Validate( pcPayload, uxPayloadLength ) != JSONSuccess )
+    {
+        LogError( ( "Received invalid JSON payload from AWS IoT Jobs service" ) );
+        xSlotsLeft = pdFALSE;
+    }
+
+    /* The jobs already in the pipeline are in the lists too, so they are
+     * skipped. A job is skipped or takes a slot, so the walk is bounded by
+     * twice the number of slots. */
+    for( uxList = 0U; ( uxList < ( sizeof( pcListKeys ) / sizeof( pcListKeys[ 0 ] ) ) ) && ( xSlotsLeft == pdTRUE ); uxList++ )
+    {
+        for( uxIndex = 0U; xSlotsLeft == pdTRUE; uxIndex++ )
+        {
+            uxQueryLength = ( size_t ) snprintf( pcQuery, sizeof( pcQuery ), "%s[%u].jobId",
+                                                 pcListKeys[ uxList ], ( unsigned ) uxIndex );
+
+            if( ( uxQueryLength >= sizeof( pcQuery ) ) ||
+                ( JSON_Search( pcPayload,
+                               uxPayloadLength,
+                               pcQuery,
+                               uxQueryLength,
+                               &pcJobId,
+                               &ulJobIdLength ) != JSONSuccess ) )
+            {
+                /* The end of the list. */
+                break;
+            }
+
+            if( ( ulJobIdLength == 0UL ) || ( ulJobIdLength >= JOBS_JOBID_MAX_LENGTH ) )
+            {
+                LogWarn( ( "Skipping pending job with invalid ID: JobID=%.*s",
+                           ulJobIdLength, pcJobId ) );
+                continue;
+            }
+
+            if( prvFindJobSlot( pcJobId, ( uint16_t ) ulJobIdLength ) != NULL )
+            {
+                /* Already fetched, running or being reported. */
+                continue;
+            }
+
+            pxJob = prvFindJobSlot( NULL, 0U );
+
+            if( pxJob == NULL )
+            {
+                xSlotsLeft = pdFALSE;
+                break;
+            }
+
+            memcpy( pxJob->pcJobId, pcJobId, ulJobIdLength );
+            pxJob->usJobIdLength = ( uint16_t ) ulJobIdLength;
+
+            /* Generate the PUBLISH topic string for the DescribeJobExecution API of AWS IoT Jobs service. */
+            if( Jobs_Describe( pxJob->pcDescribeTopic,
+                               sizeof( pxJob->pcDescribeTopic ),
+                               democonfigTHING_NAME,
+                               THING_NAME_LENGTH,
+                               pxJob->pcJobId,
+                               pxJob->usJobIdLength,
+                               &uxTopicLength ) != JobsSuccess )
+            {
+                LogError( ( "Failed to generate Publish topic string for describing job: JobID=%.*s",
+                            pxJob->usJobIdLength, pxJob->pcJobId ) );
+                continue;
+            }
+
+            /* Request the document while the jobs ahead of it run. */
+            if( xPublishToTopicPipelined( &xMqttContext,
+                                          pxJob->pcDescribeTopic,
+                                          ( int32_t ) uxTopicLength,
+                                          NULL,
+                                          0,
+                                          NULL,
+                                          NULL,
+                                          NULL ) == pdPASS )
+            {
+                LogInfo( ( "Requested the document of pending job: JobID=%.*s",
+                           pxJob->usJobIdLength, pxJob->pcJobId ) );
+                pxJob->xState = JOB_SLOT_FETCHING;
+            }
+            else
+            {
+                /* Set global flag to terminate demo as PUBLISH operation to describe a job failed. */
+                xDemoEncounteredError = pdTRUE;
+                xSlotsLeft = pdFALSE;
+
+                LogError( ( "Failed to publish to DescribeJobExecution API of AWS IoT Jobs service: "
+                            "JobID=%.*s", pxJob->usJobIdLength, pxJob->pcJobId ) );
+            }
+        }
+    }
+}
+
+static void prvStartJob( char * pcPayload,
+                         size_t uxPayloadLength,
+                         const char * pcJobId,
+                         uint16_t usJobIdLength )
+{
+    JobSlot * pxJob = NULL;
+    char * pcJobDocLoc = NULL;
+    size_t ulJobDocLength = 0UL;
+
+    pxJob = ( pcJobId != NULL ) ? prvFindJobSlot( pcJobId, usJobIdLength ) : NULL;
+
+    if( ( pxJob == NULL ) || ( pxJob->xState != JOB_SLOT_FETCHING ) )
+    {
+        LogWarn( ( "Ignoring document of a job that was not requested: JobID=%.*s",
+                   usJobIdLength, pcJobId ) );
+    }
+    else if( xExitActionJobReceived == pdTRUE )
+    {
+        /* The job stays pending in the service, for the next run. */
+        LogInfo( ( "Not running job as the demo is exiting: JobID=%.*s",
+                   pxJob->usJobIdLength, pxJob->pcJobId ) );
+        pxJob->xState = JOB_SLOT_FREE;
+    }
+    else
+    {
+        pxJob->xAction = JOB_ACTION_UNKNOWN;
+        pxJob->pcStatusReport = MAKE_STATUS_REPORT( "FAILED" );
+        pxJob->uxJobDocumentLength = 0U;
+        pxJob->xState = JOB_SLOT_RUNNING;
+
+        /* Check validity of JSON message response from server, and search
+         * for the jobs document in the payload. */
+        if( ( JSON_Validate( pcPayload, uxPayloadLength ) != JSONSuccess ) ||
+            ( JSON_Search( pcPayload,
+                           uxPayloadLength,
+                           jobsexampleQUERY_KEY_FOR_JOBS_DOC,
+                           jobsexampleQUERY_KEY_FOR_JOBS_DOC_LENGTH,
+                           &pcJobDocLoc,
+                           &ulJobDocLength ) != JSONSuccess ) )
+        {
+            LogWarn( ( "Failed to parse document of job received from AWS IoT Jobs service: "
+                       "JobID=%.*s", pxJob->usJobIdLength, pxJob->pcJobId ) );
+        }
+        else if( ulJobDocLength > sizeof( pxJob->pcJobDocument ) )
+        {
+            LogError( ( "Job document is longer than jobsexampleMAX_JOB_DOCUMENT_LENGTH: "
+                        "JobID=%.*s, Length=%lu",
+                        pxJob->usJobIdLength, pxJob->pcJobId, ( unsigned long ) ulJobDocLength ) );
+        }
+        else
+        {
+            LogInfo( ( "Received a Job from AWS IoT Jobs service: JobId=%.*s",
+                       pxJob->usJobIdLength, pxJob->pcJobId ) );
+
+            /* Copy the Job document in the slot. This is done so that the MQTT connection buffer can
+             * be used for other messages while the job runs. */
+            memcpy( pxJob->pcJobDocument, pcJobDocLoc, ulJobDocLength );
+            pxJob->uxJobDocumentLength = ulJobDocLength;
+        }
+
+        /* A job that could not be read goes straight to the demo task to be
+         * reported as failed. The queues hold every slot, so they are never
+         * full. */
+        if( pxJob->uxJobDocumentLength > 0U )
+        {
+            ( void ) xQueueSend( xJobWorkQueue, &pxJob, 0 );
+        }
+        else
+        {
+            ( void ) xQueueSend( xJobDoneQueue, &pxJob, 0 );
+        }
+    }
+}
+
+static void prvSendUpdateForJob( JobSlot * pxJob )
 {
-    char pUpdateJobTopic[ JOBS_API_MAX_LENGTH( THING_NAME_LENGTH ) ];
     size_t ulTopicLength = 0;
     JobsStatus_t xStatus = JobsSuccess;
 
-    configASSERT( ( pcJobId != NULL ) && ( usJobIdLength > 0 ) );
-    configASSERT( pcJobStatusReport != NULL );
+    configASSERT( ( pxJob != NULL ) && ( pxJob->usJobIdLength > 0 ) );
+    configASSERT( pxJob->pcStatusReport != NULL );
 
     /* Generate the PUBLISH topic string for the UpdateJobExecution API of AWS IoT Jobs service. */
-    xStatus = Jobs_Update( pUpdateJobTopic,
-                           sizeof( pUpdateJobTopic ),
+    xStatus = Jobs_Update( pxJob->pcUpdateTopic,
+                           sizeof( pxJob->pcUpdateTopic ),
                            democonfigTHING_NAME,
                            THING_NAME_LENGTH,
-                           pcJobId,
-                           usJobIdLength,
+                           pxJob->pcJobId,
+                           pxJob->usJobIdLength,
                            &ulTopicLength );
 
     if( xStatus == JobsSuccess )
     {
-        if( xPublishToTopic( &xMqttContext,
-                             pUpdateJobTopic,
-                             ulTopicLength,
-                             pcJobStatusReport,
-                             strlen( pcJobStatusReport ) ) == pdFALSE )
+        /* The slot is freed when the update is acknowledged, so the topic
+         * stays valid until then. */
+        pxJob->xState = JOB_SLOT_UPDATING;
+
+        if( xPublishToTopicPipelined( &xMqttContext,
+                                      pxJob->pcUpdateTopic,
+                                      ulTopicLength,
+                                      pxJob->pcStatusReport,
+                                      strlen( pxJob->pcStatusReport ),
+                                      prvJobUpdateComplete,
+                                      pxJob,
+                                      NULL ) == pdFALSE )
         {
             /* Set global flag to terminate demo as PUBLISH operation to update job status failed. */
             xDemoEncounteredError = pdTRUE;
+            pxJob->xState = JOB_SLOT_FREE;
 
             LogError( ( "Failed to update the status of job: JobID=%.*s, NewStatePayload=%s",
-                        usJobIdLength, pcJobId, pcJobStatusReport ) );
+                        pxJob->usJobIdLength, pxJob->pcJobId, pxJob->pcStatusReport ) );
         }
     }
     else
     {
         /* Set global flag to terminate demo as topic generation for UpdateJobExecution API failed. */
         xDemoEncounteredError = pdTRUE;
+        pxJob->xState = JOB_SLOT_FREE;
 
         LogError( ( "Failed to generate Publish topic string for sending job update: "
                     "JobID=%.*s, NewStatePayload=%s",
-                    usJobIdLength, pcJobId, pcJobStatusReport ) );
+                    pxJob->usJobIdLength, pxJob->pcJobId, pxJob->pcStatusReport ) );
+    }
+}
+
+static void prvJobUpdateComplete( void * pvCallbackContext,
+                                  uint16_t usPacketId,
+                                  BaseType_t xAcked )
+{
+    JobSlot * pxJob = ( JobSlot * ) pvCallbackContext;
+
+    ( void ) usPacketId;
+
+    configASSERT( pxJob != NULL );
+
+    /* The slot may have been released already when the session is
+     * re-established. */
+    if( pxJob->xState == JOB_SLOT_UPDATING )
+    {
+        if( xAcked == pdFALSE )
+        {
+            /* Set global flag to terminate demo as the job status update was lost. */
+            xDemoEncounteredError = pdTRUE;
+
+            LogError( ( "The status update of job was not acknowledged: JobID=%.*s",
+                        pxJob->usJobIdLength, pxJob->pcJobId ) );
+        }
+
+        pxJob->xState = JOB_SLOT_FREE;
+
+        /* The job has left the list of pending jobs, and a slot is free for
+         * the next one. */
+        xPendingJobsChanged = pdTRUE;
+    }
+}
+
+static void prvSendJobUpdates( void )
+{
+    JobSlot * pxJob = NULL;
+
+    /* All the jobs that finished since the last pass are reported together.
+     * Each update is its own request to the UpdateJobExecution API, but none
+     * waits for the acknowledgement of the one before. */
+    while( ( xDemoEncounteredError == pdFALSE ) &&
+           ( xQueueReceive( xJobDoneQueue, &pxJob, 0 ) == pdTRUE ) )
+    {
+        if( pxJob->xAction == JOB_ACTION_PUBLISH )
+        {
+            /* Publish to the parsed MQTT topic with the message obtained from
+             * the Jobs document. The worker left this to the demo task, which
+             * owns the MQTT connection. */
+            if( xPublishToTopicPipelined( &xMqttContext,
+                                          pxJob->pcTopic,
+                                          ( int32_t ) pxJob->uxTopicLength,
+                                          pxJob->pcMessage,
+                                          pxJob->uxMessageLength,
+                                          NULL,
+                                          NULL,
+                                          NULL ) == pdFALSE )
+            {
+                /* Set global flag to terminate demo as PUBLISH operation to execute job failed. */
+                xDemoEncounteredError = pdTRUE;
+
+                LogError( ( "Failed to execute job with \"publish\" action: Failed to publish to topic. "
+                            "JobID=%.*s, Topic=%.*s",
+                            pxJob->usJobIdLength, pxJob->pcJobId, pxJob->uxTopicLength, pxJob->pcTopic ) );
+            }
+        }
+        else if( pxJob->xAction == JOB_ACTION_EXIT )
+        {
+            LogInfo( ( "Received job contains \"exit\" action. Updating state of demo." ) );
+            xExitActionJobReceived = pdTRUE;
+        }
+
+        prvSendUpdateForJob( pxJob );
+    }
+}
+
+static void prvReleaseJobSlots( void )
+{
+    JobSlot * pxJob = NULL;
+    UBaseType_t uxIndex, uxRunning = 0U;
+
+    for( uxIndex = 0U; uxIndex < jobsexampleMAX_JOBS_IN_FLIGHT; uxIndex++ )
+    {
+        if( xJobSlots[ uxIndex ].xState == JOB_SLOT_RUNNING )
+        {
+            uxRunning++;
+        }
+    }
+
+    /* Every running job comes back through the done queue, either still
+     * waiting there or once its worker has finished with it. */
+    for( ; uxRunning > 0U; uxRunning-- )
+    {
+        ( void ) xQueueReceive( xJobDoneQueue, &pxJob, portMAX_DELAY );
+    }
+
+    /* The jobs that were not reported stay pending in the service, and are
+     * fetched again in the next iteration. */
+    for( uxIndex = 0U; uxIndex < jobsexampleMAX_JOBS_IN_FLIGHT; uxIndex++ )
+    {
+        xJobSlots[ uxIndex ].xState = JOB_SLOT_FREE;
     }
+
+    xPendingJobsRequested = pdFALSE;
+    xPendingJobsChanged = pdTRUE;
 }
 
-static void prvProcessJobDocument( char * pcJobId,
-                                   uint16_t usJobIdLength,
-                                   char * pcJobDocument,
-                                   size_t uxJobDocumentLength )
+static void prvProcessJobDocument( JobSlot * pxJob )
 {
     char * pcAction = NULL;
     size_t uActionLength = 0U;
     JSONStatus_t xJsonStatus = JSONSuccess;
 
-    configASSERT( pcJobId != NULL );
-    configASSERT( usJobIdLength > 0 );
-    configASSERT( pcJobDocument != NULL );
-    configASSERT( uxJobDocumentLength > 0 );
+    configASSERT( pxJob != NULL );
+    configASSERT( pxJob->usJobIdLength > 0 );
+    configASSERT( pxJob->uxJobDocumentLength > 0 );
 
-    xJsonStatus = JSON_Search( pcJobDocument,
-                               uxJobDocumentLength,
+    xJsonStatus = JSON_Search( pxJob->pcJobDocument,
+                               pxJob->uxJobDocumentLength,
                                jobsexampleQUERY_KEY_FOR_ACTION,
                                jobsexampleQUERY_KEY_FOR_ACTION_LENGTH,
                                &pcAction,
@@ -497,7 +1065,7 @@ static void prvProcessJobDocument( char * pcJobId,
     if( xJsonStatus != JSONSuccess )
     {
         LogError( ( "Job document schema is invalid. Missing expected \"action\" key in document." ) );
-        prvSendUpdateForJob( pcJobId, usJobIdLength, MAKE_STATUS_REPORT( "FAILED" ) );
+        pxJob->pcStatusReport = MAKE_STATUS_REPORT( "FAILED" );
     }
     else
     {
@@ -510,16 +1078,15 @@ static void prvProcessJobDocument( char * pcJobId,
         switch( xActionType )
         {
             case JOB_ACTION_EXIT:
-                LogInfo( ( "Received job contains \"exit\" action. Updating state of demo." ) );
-                xExitActionJobReceived = pdTRUE;
-                prvSendUpdateForJob( pcJobId, usJobIdLength, MAKE_STATUS_REPORT( "SUCCEEDED" ) );
+                /* The demo task exits once the jobs already started are done. */
+                pxJob->xAction = JOB_ACTION_EXIT;
+                pxJob->pcStatusReport = MAKE_STATUS_REPORT( "SUCCEEDED" );
                 break;
 
             case JOB_ACTION_PRINT:
                 LogInfo( ( "Received job contains \"print\" action." ) );
-
-                xJsonStatus = JSON_Search( pcJobDocument,
-                                           uxJobDocumentLength,
+                xJsonStatus = JSON_Search( pxJob->pcJobDocument,
+                                           pxJob->uxJobDocumentLength,
                                            jobsexampleQUERY_KEY_FOR_MESSAGE,
                                            jobsexampleQUERY_KEY_FOR_MESSAGE_LENGTH,
                                            &pcMessage,
@@ -535,12 +1102,12 @@ static void prvProcessJobDocument( char * pcJobId,
                                "\r\n"
                                "/*-----------------------------------------------------------*/\r\n"
                                "\r\n", ulMessageLength, pcMessage ) );
-                    prvSendUpdateForJob( pcJobId, usJobIdLength, MAKE_STATUS_REPORT( "SUCCEEDED" ) );
+                    pxJob->pcStatusReport = MAKE_STATUS_REPORT( "SUCCEEDED" );
                 }
                 else
                 {
                     LogError( ( "Job document schema is invalid. Missing \"message\" for \"print\" action type." ) );
-                    prvSendUpdateForJob( pcJobId, usJobIdLength, MAKE_STATUS_REPORT( "FAILED" ) );
+                    pxJob->pcStatusReport = MAKE_STATUS_REPORT( "FAILED" );
                 }
 
                 break;
@@ -550,8 +1117,8 @@ static void prvProcessJobDocument( char * pcJobId,
                 char * pcTopic = NULL;
                 size_t ulTopicLength = 0U;
 
-                xJsonStatus = JSON_Search( pcJobDocument,
-                                           uxJobDocumentLength,
+                xJsonStatus = JSON_Search( pxJob->pcJobDocument,
+                                           pxJob->uxJobDocumentLength,
                                            jobsexampleQUERY_KEY_FOR_TOPIC,
                                            jobsexampleQUERY_KEY_FOR_TOPIC_LENGTH,
                                            &pcTopic,
@@ -561,12 +1128,12 @@ static void prvProcessJobDocument( char * pcJobId,
                 if( xJsonStatus != JSONSuccess )
                 {
                     LogError( ( "Job document schema is invalid. Missing \"topic\" key for \"publish\" action type." ) );
-                    prvSendUpdateForJob( pcJobId, usJobIdLength, MAKE_STATUS_REPORT( "FAILED" ) );
+                    pxJob->pcStatusReport = MAKE_STATUS_REPORT( "FAILED" );
                 }
                 else
                 {
-                    xJsonStatus = JSON_Search( pcJobDocument,
-                                               uxJobDocumentLength,
+                    xJsonStatus = JSON_Search( pxJob->pcJobDocument,
+                                               pxJob->uxJobDocumentLength,
                                                jobsexampleQUERY_KEY_FOR_MESSAGE,
                                                jobsexampleQUERY_KEY_FOR_MESSAGE_LENGTH,
                                                &pcMessage,
@@ -575,109 +1142,121 @@ static void prvProcessJobDocument( char * pcJobId,
                     /* Search for "message" key in Jobs document.*/
                     if( xJsonStatus == JSONSuccess )
                     {
-                        /* Publish to the parsed MQTT topic with the message obtained from
-                         * the Jobs document.*/
-                        if( xPublishToTopic( &xMqttContext,
-                                             pcTopic,
-                                             ulTopicLength,
-                                             pcMessage,
-                                             ulMessageLength ) == pdFALSE )
-                        {
-                            /* Set global flag to terminate demo as PUBLISH operation to execute job failed. */
-                            xDemoEncounteredError = pdTRUE;
-
-                            LogError( ( "Failed to execute job with \"publish\" action: Failed to publish to topic. "
-                                        "JobID=%.*s, Topic=%.*s",
-                                        usJobIdLength, pcJobId, ulTopicLength, pcTopic ) );
-                        }
-
-                        prvSendUpdateForJob( pcJobId, usJobIdLength, MAKE_STATUS_REPORT( "SUCCEEDED" ) );
+                        /* The demo task publishes the message, as only it
+                         * uses the MQTT connection. */
+                        pxJob->xAction = JOB_ACTION_PUBLISH;
+                        pxJob->pcTopic = pcTopic;
+                        pxJob->uxTopicLength = ulTopicLength;
+                        pxJob->pcMessage = pcMessage;
+                        pxJob->uxMessageLength = ulMessageLength;
+                        pxJob->pcStatusReport = MAKE_STATUS_REPORT( "SUCCEEDED" );
                     }
                     else
                     {
                         LogError( ( "Job document schema is invalid. Missing \"message\" key for \"publish\" action type." ) );
-                        prvSendUpdateForJob( pcJobId, usJobIdLength, MAKE_STATUS_REPORT( "FAILED" ) );
+                        pxJob->pcStatusReport = MAKE_STATUS_REPORT( "FAILED" );
                     }
                 }
 
                 break;
 
             default:
+                /* Reported as failed, so that the job does not stay at the
+                 * head of the pending list. */
                 configPRINTF( ( "Received Job document with unknown action %.*s.",
                                 uActionLength, pcAction ) );
+                pxJob->pcStatusReport = MAKE_STATUS_REPORT( "FAILED" );
                 break;
         }
     }
 }
 
-static void prvNextJobHandler( MQTTPublishInfo_t * pxPublishInfo )
+static void prvJobWorkerTask( void * pvParameters )
 {
-    configASSERT( pxPublishInfo != NULL );
-    configASSERT( ( pxPublishInfo->pPayload != NULL ) && ( pxPublishInfo->payloadLength > 0 ) );
+    JobSlot * pxJob = NULL;
 
-    /* Check validity of JSON message response from server.*/
-    if( JSON_Validate( pxPublishInfo->pPayload, pxPublishInfo->payloadLength ) != JSONSuccess )
+    /* Remove compiler warnings about unused parameters. */
+    ( void ) pvParameters;
+
+    for( ; ; )
     {
-        LogError( ( "Received invalid JSON payload from AWS IoT Jobs service" ) );
+        if( xQueueReceive( xJobWorkQueue, &pxJob, portMAX_DELAY ) == pdTRUE )
+        {
+            prvProcessJobDocument( pxJob );
+
+            /* Hand the job back to the demo task to report it. */
+            ( void ) xQueueSend( xJobDoneQueue, &pxJob, portMAX_DELAY );
+        }
     }
-    else
-    {
-        char * pcJobId = NULL;
-        size_t ulJobIdLength = 0UL;
+}
+
+static void prvJobMessageHandler( MQTTPublishInfo_t * pxPublishInfo )
+{
+    JobsTopic_t xTopicType = JobsMaxTopic;
+    char * pcJobId = NULL;
+    uint16_t usJobIdLength = 0U;
 
-        /* Parse the Job ID of the next pending job execution from the JSON payload. */
-        if( JSON_Search( ( char * ) pxPublishInfo->pPayload,
+    configASSERT( pxPublishInfo != NULL );
+    configASSERT( ( pxPublishInfo->pPayload != NULL ) && ( pxPublishInfo->payloadLength > 0 ) );
+
+    /* prvEventCallback() only queues Jobs messages, this gets the job ID
+     * from the topic as well. */
+    ( void ) Jobs_MatchTopic( ( char * ) pxPublishInfo->pTopicName,
+                              pxPublishInfo->topicNameLength,
+                              democonfigTHING_NAME,
+                              THING_NAME_LENGTH,
+                              &xTopicType,
+                              &pcJobId,
+                              &usJobIdLength );
+
+    switch( xTopicType )
+    {
+        case JobsNextJobChanged:
+            /* The next job is fetched with the rest of the pending list. */
+            xPendingJobsChanged = pdTRUE;
+            break;
+
+        case JobsGetPendingSuccess:
+            xPendingJobsRequested = pdFALSE;
+            prvFetchPendingJobs( ( char * ) pxPublishInfo->pPayload,
+                                 pxPublishInfo->payloadLength );
+            break;
+
+        case JobsGetPendingFailed:
+            xPendingJobsRequested = pdFALSE;
+            LogWarn( ( "Request for pending jobs rejected: RejectedResponse=%.*s.",
+                       pxPublishInfo->payloadLength,
+                       ( const char * ) pxPublishInfo->pPayload ) );
+            break;
+
+        case JobsDescribeSuccess:
+            prvStartJob( ( char * ) pxPublishInfo->pPayload,
                          pxPublishInfo->payloadLength,
-                         jobsexampleQUERY_KEY_FOR_JOB_ID,
-                         jobsexampleQUERY_KEY_FOR_JOB_ID_LENGTH,
-                         &pcJobId,
-                         &ulJobIdLength ) != JSONSuccess )
-        {
-            LogWarn( ( "Failed to parse Job ID in message received from AWS IoT Jobs service: "
-                       "IncomingTopic=%.*s, Payload=%.*s",
-                       pxPublishInfo->topicNameLength, pxPublishInfo->pTopicName,
-                       pxPublishInfo->payloadLength, pxPublishInfo->pPayload ) );
-        }
-        else
+                         pcJobId,
+                         usJobIdLength );
+            break;
+
+        case JobsDescribeFailed:
         {
-            char * pcJobDocLoc = NULL;
-            size_t ulJobDocLength = 0UL;
+            JobSlot * pxJob = ( pcJobId != NULL ) ? prvFindJobSlot( pcJobId, usJobIdLength ) : NULL;
 
-            configASSERT( ulJobIdLength < JOBS_JOBID_MAX_LENGTH );
-            LogInfo( ( "Received a Job from AWS IoT Jobs service: JobId=%.*s",
-                       ulJobIdLength, pcJobId ) );
-
-            /* Copy the Job ID in the global buffer. This is done so that
-             * the MQTT context's network buffer can be used for sending jobs
-             * status updates to the AWS IoT Jobs service. */
-            memcpy( usJobIdBuffer, pcJobId, ulJobIdLength );
-
-            /* Search for the jobs document in the payload. */
-            if( JSON_Search( ( char * ) pxPublishInfo->pPayload,
-                             pxPublishInfo->payloadLength,
-                             jobsexampleQUERY_KEY_FOR_JOBS_DOC,
-                             jobsexampleQUERY_KEY_FOR_JOBS_DOC_LENGTH,
-                             &pcJobDocLoc,
-                             &ulJobDocLength ) != JSONSuccess )
-            {
-                LogWarn( ( "Failed to parse document of next job received from AWS IoT Jobs service: "
-                           "Topic=%.*s, JobID=%.*s",
-                           pxPublishInfo->topicNameLength, pxPublishInfo->pTopicName,
-                           ulJobIdLength, pcJobId ) );
-            }
-            else
+            LogWarn( ( "Request for job document rejected: JobID=%.*s, RejectedResponse=%.*s.",
+                       usJobIdLength, pcJobId,
+                       pxPublishInfo->payloadLength,
+                       ( const char * ) pxPublishInfo->pPayload ) );
+
+            if( ( pxJob != NULL ) && ( pxJob->xState == JOB_SLOT_FETCHING ) )
             {
-                /* Copy the Job document in buffer. This is done so that the MQTT connection buffer can
-                 * be used for sending jobs status updates to the AWS IoT Jobs service. */
-                memcpy( usJobsDocumentBuffer, pcJobDocLoc, ulJobDocLength );
-
-                /* Process the Job document and execute the job. */
-                prvProcessJobDocument( usJobIdBuffer,
-                                       ( uint16_t ) ulJobIdLength,
-                                       usJobsDocumentBuffer,
-                                       ulJobDocLength );
+                pxJob->xState = JOB_SLOT_FREE;
             }
+
+            break;
         }
+
+        default:
+            LogWarn( ( "Received an unexpected messages from AWS IoT Jobs service: "
+                       "JobsTopicType=%u", xTopicType ) );
+            break;
     }
 }
 
@@ -727,35 +1306,27 @@ static void prvEventCallback( MQTTContext_t * pxMqttContext,
         if( xStatus == JobsSuccess )
         {
             /* Upon successful return, the messageType has been filled in. */
-            if( ( topicType == JobsDescribeSuccess ) || ( topicType == JobsNextJobChanged ) )
+            if( ( topicType == JobsGetPendingSuccess ) || ( topicType == JobsGetPendingFailed ) ||
+                ( topicType == JobsDescribeSuccess ) || ( topicType == JobsDescribeFailed ) ||
+                ( topicType == JobsNextJobChanged ) )
             {
                 MQTTPublishInfo_t * pxJobMessagePublishInfo = NULL;
                 char * pcTopicName = NULL;
                 char * pcPayload = NULL;
 
-                /* Copy message to pass into queue. */
-                pxJobMessagePublishInfo = ( MQTTPublishInfo_t * ) pvPortMalloc( sizeof( MQTTPublishInfo_t ) );
-                pcTopicName = ( char * ) pvPortMalloc( pxDeserializedInfo->pPublishInfo->topicNameLength );
-                pcPayload = ( char * ) pvPortMalloc( pxDeserializedInfo->pPublishInfo->payloadLength );
+                ArenaMark_t xMark = xArenaGetMark( &xJobMessageArena );
+
+                /* Copy message to pass into queue.  The copies are freed
+                 * together once the queue has been emptied. */
+                pxJobMessagePublishInfo = ( MQTTPublishInfo_t * ) pvArenaAlloc( &xJobMessageArena, sizeof( MQTTPublishInfo_t ) );
+                pcTopicName = ( char * ) pvArenaAlloc( &xJobMessageArena, pxDeserializedInfo->pPublishInfo->topicNameLength );
+                pcPayload = ( char * ) pvArenaAlloc( &xJobMessageArena, pxDeserializedInfo->pPublishInfo->payloadLength );
 
                 if( ( pxJobMessagePublishInfo == NULL ) || ( pcTopicName == NULL ) || ( pcPayload == NULL ) )
                 {
-                    LogError( ( "Malloc failed for copying job publish info." ) );
-
-                    if( pxJobMessagePublishInfo != NULL )
-                    {
-                        vPortFree( pxJobMessagePublishInfo );
-                    }
-
-                    if( pcTopicName != NULL )
-                    {
-                        vPortFree( pcTopicName );
-                    }
-
-                    if( pcPayload != NULL )
-                    {
-                        vPortFree( pcPayload );
-                    }
+                    LogError( ( "Jobs message arena too small to copy job publish info, "
+                                "increase jobsexampleMESSAGE_ARENA_SIZE." ) );
+                    vArenaResetToMark( &xJobMessageArena, xMark );
                 }
                 else
                 {
@@ -770,9 +1341,7 @@ static void prvEventCallback( MQTTContext_t * pxMqttContext,
                     {
                         LogError( ( "Could not enqueue Jobs message." ) );
 
-                        vPortFree( pxJobMessagePublishInfo );
-                        vPortFree( pcTopicName );
-                        vPortFree( pcPayload );
+                        vArenaResetToMark( &xJobMessageArena, xMark );
                     }
                 }
             }
@@ -847,6 +1416,7 @@ void prvJobsDemoTask( void * pvParameters )
 {
     BaseType_t xDemoStatus = pdPASS;
     UBaseType_t uxDemoRunCount = 0UL;
+    UBaseType_t uxWorker;
     BaseType_t retryDemoLoop = pdFALSE;
 
     /* Remove compiler warnings about unused parameters. */
@@ -858,6 +1428,25 @@ void prvJobsDemoTask( void * pvParameters )
     /* Initialize Jobs message queue. */
     xJobMessageQueue = xQueueCreate( JOBS_MESSAGE_QUEUE_LEN, sizeof( MQTTPublishInfo_t * ) );
     configASSERT( xJobMessageQueue != NULL );
+    vArenaInitStatic( &xJobMessageArena, ucJobMessageArenaBuffer, sizeof( ucJobMessageArenaBuffer ) );
+
+    /* Initialize the queues of the job pipeline, which hold every slot. */
+    xJobWorkQueue = xQueueCreate( jobsexampleMAX_JOBS_IN_FLIGHT, sizeof( JobSlot * ) );
+    configASSERT( xJobWorkQueue != NULL );
+    xJobDoneQueue = xQueueCreate( jobsexampleMAX_JOBS_IN_FLIGHT, sizeof( JobSlot * ) );
+    configASSERT( xJobDoneQueue != NULL );
+
+    /* Start the worker tasks that run the jobs. */
+    for( uxWorker = 0U; uxWorker < jobsexampleWORKER_COUNT; uxWorker++ )
+    {
+        xDemoStatus = xTaskCreate( prvJobWorkerTask,
+                                   "JobWorker",
+                                   democonfigDEMO_STACKSIZE,
+                                   NULL,
+                                   tskIDLE_PRIORITY,
+                                   &( xJobWorkerTasks[ uxWorker ] ) );
+        configASSERT( xDemoStatus == pdPASS );
+    }
 
     /* This demo runs a single loop unless there are failures in the demo execution.
      * In case of failures in the demo execution, demo loop will be retried for up to
@@ -932,30 +1521,9 @@ void prvJobsDemoTask( void * pvParameters )
             }
         }
 
-        if( xDemoStatus == pdPASS )
-        {
-            /* Publish to AWS IoT Jobs on the DescribeJobExecution API to request the next pending job.
-             *
-             * Note: It is not required to make MQTT subscriptions to the response topics of the
-             * DescribeJobExecution API because the AWS IoT Jobs service sends responses for
-             * the PUBLISH commands on the same MQTT connection irrespective of whether the client has subscribed
-             * to the response topics or not.
-             * This demo processes incoming messages from the response topics of the API in the prvEventCallback()
-             * handler that is supplied to the coreMQTT library. */
-            if( xPublishToTopic( &xMqttContext,
-                                 DESCRIBE_NEXT_JOB_TOPIC( democonfigTHING_NAME ),
-                                 sizeof( DESCRIBE_NEXT_JOB_TOPIC( democonfigTHING_NAME ) ) - 1,
-                                 NULL,
-                                 0 ) != pdPASS )
-            {
-                xDemoStatus = pdFAIL;
-                LogError( ( "Failed to publish to DescribeJobExecution API of AWS IoT Jobs service: "
-                            "Topic=%s", DESCRIBE_NEXT_JOB_TOPIC( democonfigTHING_NAME ) ) );
-            }
-        }
-
-        /* Keep on running the demo until we receive a job for the "exit" action to exit the demo. */
-        while( ( xExitActionJobReceived == pdFALSE ) &&
+        /* Keep on running the demo until we receive a job for the "exit" action to exit the demo,
+         * and the jobs started before it are done. */
+        while( ( ( xExitActionJobReceived == pdFALSE ) || ( prvCountBusyJobSlots() > 0U ) ) &&
                ( xDemoEncounteredError == pdFALSE ) &&
                ( xDemoStatus == pdPASS ) )
         {
@@ -963,17 +1531,28 @@ void prvJobsDemoTask( void * pvParameters )
             MQTTStatus_t xMqttStatus = MQTTSuccess;
 
             /* Check if we have notification for the next pending job in the queue from the
-             * NextJobExecutionChanged API of the AWS IoT Jobs service. */
+             * NextJobExecutionChanged API, or responses from the other APIs of the AWS IoT
+             * Jobs service. */
             xMqttStatus = MQTT_ProcessLoop( &xMqttContext );
 
-            /* Receive any incoming Jobs message. */
-            if( xQueueReceive( xJobMessageQueue, &pxJobMessagePublishInfo, 0 ) == pdTRUE )
+            /* Receive all the incoming Jobs messages. */
+            while( xQueueReceive( xJobMessageQueue, &pxJobMessagePublishInfo, 0 ) == pdTRUE )
             {
                 /* Handler function to process Jobs message payload. */
-                prvNextJobHandler( pxJobMessagePublishInfo );
-                vPortFree( ( void * ) ( pxJobMessagePublishInfo->pTopicName ) );
-                vPortFree( ( void * ) ( pxJobMessagePublishInfo->pPayload ) );
-                vPortFree( pxJobMessagePublishInfo );
+                prvJobMessageHandler( pxJobMessagePublishInfo );
+            }
+
+            /* The handler copied what it needs from the messages, so free
+             * them all at once. */
+            vArenaReset( &xJobMessageArena );
+
+            /* Report the jobs the workers have finished. */
+            prvSendJobUpdates();
+
+            /* Fetch more jobs when a slot is free. */
+            if( prvRequestPendingJobs() != pdPASS )
+            {
+                xDemoStatus = pdFAIL;
             }
 
             if( xMqttStatus != MQTTSuccess )
@@ -984,6 +1563,10 @@ void prvJobsDemoTask( void * pvParameters )
             }
         }
 
+        /* Take the jobs back from the workers. Any that were not reported are
+         * fetched again if the demo loop is retried. */
+        prvReleaseJobSlots();
+
         /* Increment the demo run count. */
         uxDemoRunCount++;
 
@@ -1047,6 +1630,12 @@ void prvJobsDemoTask( void * pvParameters )
 
     LogInfo( ( "-------DEMO FINISHED-------\r\n" ) );
 
+    /* Delete the worker tasks, which hold no jobs anymore. */
+    for( uxWorker = 0U; uxWorker < jobsexampleWORKER_COUNT; uxWorker++ )
+    {
+        vTaskDelete( xJobWorkerTasks[ uxWorker ] );
+    }
+
     /* Delete this demo task. */
     LogInfo( ( "Deleting Jobs Demo task." ) );
     vTaskDelete( NULL );
@@ -229,4 +229,13 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define democonfigNETWORK_BUFFER_SIZE    ( 1024U )
 
+/**
+ * @brief Maximum number of outgoing publishes in flight in mqtt_demo_helpers.c.
+ *
+ * The job pipeline keeps a document request or a status update in flight for
+ * each of its jobsexampleMAX_JOBS_IN_FLIGHT slots, plus the messages of
+ * "publish" jobs.
+ */
+#define MAX_OUTGOING_PUBLISHES           ( 8U )
+
 #endif /* DEMO_CONFIG_H */
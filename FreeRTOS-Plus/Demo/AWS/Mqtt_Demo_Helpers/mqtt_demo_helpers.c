@@ -50,8 +50,8 @@
 /* MQTT library includes. */
 #include "core_mqtt.h"
 
-/* Exponential backoff retry include. */
-#include "backoff_algorithm.h"
+/* Backoff shared by every connection to the broker. */
+#include "endpoint_backoff.h"
 
 /* Transport interface implementation include header for TLS. */
 #include "transport_mbedtls.h"
@@ -59,6 +59,18 @@
 /* Demo specific config. */
 #include "demo_config.h"
 
+/**
+ * @brief Set to 1 to build xPublishToTopicCompressed() and
+ * xDecompressIncomingPublish(), which need mqtt_payload_compression.c.
+ */
+#ifndef mqttexampleCOMPRESS_PAYLOADS
+    #define mqttexampleCOMPRESS_PAYLOADS    0
+#endif
+
+#if ( mqttexampleCOMPRESS_PAYLOADS == 1 )
+    #include "mqtt_payload_compression.h"
+#endif
+
 /*------------- Demo configurations -------------------------*/
 
 /**
@@ -101,6 +113,24 @@
  */
 #define RETRY_BACKOFF_BASE_MS                        ( 500U )
 
+/**
+ * @brief The number of consecutive failures, by any task, after which no
+ * connection to the broker is attempted for #RETRY_CIRCUIT_OPEN_MS.
+ */
+#define RETRY_CIRCUIT_FAILURE_THRESHOLD              ( 5U )
+
+/**
+ * @brief How long (in milliseconds) no connection to the broker is attempted
+ * after #RETRY_CIRCUIT_FAILURE_THRESHOLD consecutive failures.
+ */
+#define RETRY_CIRCUIT_OPEN_MS                        ( 30000U )
+
+/**
+ * @brief The longest time (in milliseconds) to wait for the broker to become
+ * available to one more attempt.
+ */
+#define RETRY_MAX_WAIT_MS                            ( 60000U )
+
 /**
  * @brief Timeout for receiving CONNACK packet in milliseconds.
  */
@@ -143,12 +173,47 @@
  */
 #define mqttexampleTRANSPORT_SEND_RECV_TIMEOUT_MS    ( 200U )
 
+/**
+ * @brief Maximum number of outgoing publishes maintained in the application
+ * until an ack is received from the broker.
+ *
+ * @note With more than one, xPublishToTopic() can return before the PUBACK
+ * arrives, so the topic and payload passed to it must stay valid until then.
+ */
+#ifndef MAX_OUTGOING_PUBLISHES
+    #define MAX_OUTGOING_PUBLISHES    ( 1U )
+#endif
+
+/**
+ * @brief The number of times an outgoing publish is resent after the session
+ * is re-established, before it is dropped.
+ */
+#ifndef mqttexampleMAX_PUBLISH_RESENDS
+    #define mqttexampleMAX_PUBLISH_RESENDS    ( 3U )
+#endif
+
+/**
+ * @brief The number of buckets used to find an outgoing publish by its packet
+ * identifier.  More than MAX_OUTGOING_PUBLISHES, so that a bucket is always
+ * free.
+ */
+#define OUTGOING_PUBLISH_MAP_SIZE     ( ( 2U * MAX_OUTGOING_PUBLISHES ) + 1U )
+
+/**
+ * @brief Marks the end of a list of outgoing publish slots.
+ */
+#define OUTGOING_PUBLISH_NO_SLOT      ( 0xFFFFU )
+
 /**
  * @brief The length of the outgoing publish records array used by the coreMQTT
  * library to track QoS > 0 packet ACKS for outgoing publishes.
  * This length depends on the Number of publishes & can be updated accordingly.
  */
-#define mqttexampleOUTGOING_PUBLISH_RECORD_LEN       ( 15U )
+#if ( MAX_OUTGOING_PUBLISHES > 15U )
+    #define mqttexampleOUTGOING_PUBLISH_RECORD_LEN    MAX_OUTGOING_PUBLISHES
+#else
+    #define mqttexampleOUTGOING_PUBLISH_RECORD_LEN    ( 15U )
+#endif
 
 /**
  * @brief The length of the incoming publish records array used by the coreMQTT
@@ -158,10 +223,16 @@
 #define mqttexampleINCOMING_PUBLISH_RECORD_LEN       ( 15U )
 
 /**
- * @brief Maximum number of outgoing publishes maintained in the application
- * until an ack is received from the broker.
+ * @brief The bytes kept in front of the topic in the buffer of a publish
+ * template, for the fixed header: the packet type and flags, and a remaining
+ * length of at most four bytes.
+ */
+#define PUBLISH_TEMPLATE_HEADER_RESERVE              ( 5U )
+
+/**
+ * @brief The largest remaining length of an MQTT packet.
  */
-#define MAX_OUTGOING_PUBLISHES                       ( 1U )
+#define MQTT_MAX_REMAINING_LENGTH                    ( 268435455UL )
 
 /**
  * @brief Milliseconds per second.
@@ -198,6 +269,22 @@ typedef struct PublishPackets
      * @brief Publish info of the publish packet.
      */
     MQTTPublishInfo_t pubInfo;
+
+    /**
+     * @brief Called when the publish completes, NULL when the caller waits
+     * for completion itself.
+     */
+    PublishCompleteCallback_t pxCallback;
+
+    /**
+     * @brief Passed to pxCallback.
+     */
+    void * pvCallbackContext;
+
+    /**
+     * @brief The number of times the publish was resent.
+     */
+    uint8_t ucResendCount;
 } PublishPackets_t;
 
 /*-----------------------------------------------------------*/
@@ -249,6 +336,25 @@ static uint16_t globalUnsubscribePacketIdentifier = 0U;
  */
 static PublishPackets_t outgoingPublishPackets[ MAX_OUTGOING_PUBLISHES ] = { 0 };
 
+/**
+ * @brief Finds the slot of an outgoing publish by its packet identifier.
+ * Holds the slot index plus one, zero for a free bucket.  Collisions are
+ * resolved by linear probing from bucket ( packetId % OUTGOING_PUBLISH_MAP_SIZE ).
+ */
+static uint16_t usOutgoingPublishMap[ OUTGOING_PUBLISH_MAP_SIZE ];
+
+/**
+ * @brief Link the free slots, and the slots in flight in the order in which
+ * the publishes were sent, which is the order in which they are resent.
+ */
+static uint16_t usNextOutgoingSlot[ MAX_OUTGOING_PUBLISHES ];
+static uint16_t usPrevOutgoingSlot[ MAX_OUTGOING_PUBLISHES ];
+static uint16_t usFreeOutgoingSlots = OUTGOING_PUBLISH_NO_SLOT;
+static uint16_t usFirstOutgoingSlot = OUTGOING_PUBLISH_NO_SLOT;
+static uint16_t usLastOutgoingSlot = OUTGOING_PUBLISH_NO_SLOT;
+static uint16_t usOutgoingInFlight = 0U;
+static BaseType_t xOutgoingSlotsInitialised = pdFALSE;
+
 /**
  * @brief Array to track the outgoing publish records for outgoing publishes
  * with QoS > 0.
@@ -267,6 +373,15 @@ static MQTTPubAckInfo_t pOutgoingPublishRecords[ mqttexampleOUTGOING_PUBLISH_REC
  */
 static MQTTPubAckInfo_t pIncomingPublishRecords[ mqttexampleINCOMING_PUBLISH_RECORD_LEN ];
 
+#if ( mqttexampleCOMPRESS_PAYLOADS == 1 )
+
+/**
+ * @brief The working memory of the compressor, used by the task which
+ * publishes.
+ */
+    static PayloadCompressor_t xPayloadCompressor;
+#endif
+
 
 /*-----------------------------------------------------------*/
 
@@ -303,21 +418,50 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
  * @brief Function to get the free index at which an outgoing publish
  * can be stored.
  *
- * @param[out] pucIndex The output parameter to return the index at which an
+ * @param[out] pusIndex The output parameter to return the index at which an
  * outgoing publish message can be stored.
  *
  * @return pdFAIL if no more publishes can be stored;
  * pdTRUE if an index to store the next outgoing publish is obtained.
  */
-static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint8_t * pucIndex );
+static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint16_t * pusIndex );
+
+/**
+ * @brief Function to record the publish at the given index as in flight,
+ * once its packet identifier has been set.
+ *
+ * @param[in] usIndex The index returned by prvGetNextFreeIndexForOutgoingPublishes().
+ */
+static void prvTrackOutgoingPublishAt( uint16_t usIndex );
+
+/**
+ * @brief Function to find the bucket of #usOutgoingPublishMap that holds a
+ * packet identifier.
+ *
+ * @param[in] usPacketId The packet identifier.
+ *
+ * @return The bucket, or OUTGOING_PUBLISH_MAP_SIZE if the packet identifier
+ * is not in flight.
+ */
+static uint16_t prvFindOutgoingPublish( uint16_t usPacketId );
 
 /**
  * @brief Function to clean up an outgoing publish at given index from the
  * #outgoingPublishPackets array.
  *
- * @param[in] ucIndex The index at which a publish message has to be cleaned up.
+ * @param[in] usIndex The index at which a publish message has to be cleaned up.
  */
-static void vCleanupOutgoingPublishAt( uint8_t ucIndex );
+static void vCleanupOutgoingPublishAt( uint16_t usIndex );
+
+/**
+ * @brief Function to clean up an outgoing publish at given index, and to
+ * call its completion callback.
+ *
+ * @param[in] usIndex The index of the publish.
+ * @param[in] xAcked Passed to the callback.
+ */
+static void prvCompleteOutgoingPublishAt( uint16_t usIndex,
+                                          BaseType_t xAcked );
 
 /**
  * @brief Function to clean up all the outgoing publishes maintained in the
@@ -349,6 +493,33 @@ static BaseType_t xHandlePublishResend( MQTTContext_t * pxMqttContext );
  */
 static uint32_t prvGetTimeMs( void );
 
+/**
+ * @brief Take a free outgoing publish slot. When all are in flight, handle
+ * incoming packets until a PUBACK frees one, for at most
+ * mqttexamplePROCESS_LOOP_TIMEOUT_MS.
+ *
+ * @param[in] pxMqttContext MQTT context pointer.
+ * @param[out] pusIndex The index of the slot.
+ *
+ * @return pdPASS if a slot was taken; pdFAIL otherwise.
+ */
+static BaseType_t prvReserveOutgoingPublish( MQTTContext_t * pxMqttContext,
+                                             uint16_t * pusIndex );
+
+/**
+ * @brief Send buffers over the transport of an MQTT context, with a single
+ * vectored write when the transport supports it.
+ *
+ * @param[in] pxMqttContext MQTT context pointer.
+ * @param[in, out] pxVectors The buffers to send, changed as they are sent.
+ * @param[in] xVectorCount The number of buffers.
+ *
+ * @return pdPASS if all bytes were sent; pdFAIL otherwise.
+ */
+static BaseType_t prvSendVectors( MQTTContext_t * pxMqttContext,
+                                  TransportOutVector_t * pxVectors,
+                                  size_t xVectorCount );
+
 /**
  * @brief Call #MQTT_ProcessLoop in a loop for the duration of a timeout or
  * #MQTT_ProcessLoop returns a failure.
@@ -377,10 +548,16 @@ static int32_t prvGenerateRandomNumber()
 static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext_t * pxNetworkContext )
 {
     TlsTransportStatus_t xNetworkStatus = TLS_TRANSPORT_SUCCESS;
-    BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
-    BackoffAlgorithmContext_t xReconnectParams = { 0 };
+    static const EndpointBackoffConfig_t xBackoffConfig =
+    {
+        .ulBaseDelayMs      = RETRY_BACKOFF_BASE_MS,
+        .ulMaxDelayMs       = RETRY_MAX_BACKOFF_DELAY_MS,
+        .ulFailureThreshold = RETRY_CIRCUIT_FAILURE_THRESHOLD,
+        .ulOpenMs           = RETRY_CIRCUIT_OPEN_MS
+    };
+    EndpointBackoff_t * pxBackoff;
+    uint32_t ulAttempts = 0U;
     NetworkCredentials_t xNetworkCredentials = { 0 };
-    uint16_t usNextRetryBackOff = 0U;
 
     #if defined( democonfigCLIENT_USERNAME )
 
@@ -434,18 +611,27 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
 
     xNetworkCredentials.disableSni = pdFALSE;
 
-    /* Initialize reconnect attempts and interval.*/
-    BackoffAlgorithm_InitializeParams( &xReconnectParams,
-                                       RETRY_BACKOFF_BASE_MS,
-                                       RETRY_MAX_BACKOFF_DELAY_MS,
-                                       RETRY_MAX_ATTEMPTS );
+    /* Every task connecting to the broker shares the retry times, so they
+     * do not each retry on their own while it is unavailable. */
+    pxBackoff = pxEndpointBackoffGet( democonfigMQTT_BROKER_ENDPOINT,
+                                      democonfigMQTT_BROKER_PORT,
+                                      &xBackoffConfig );
+    configASSERT( pxBackoff != NULL );
 
     /* Attempt to connect to MQTT broker. If connection fails, retry after
-     * a timeout. Timeout value will exponentially increase until maximum
-     * attempts are reached.
+     * a timeout. Timeout value will increase with jitter until maximum
+     * attempts are reached, and no attempt is made while the circuit of the
+     * broker is open.
      */
     do
     {
+        if( xEndpointBackoffWait( pxBackoff, pdMS_TO_TICKS( RETRY_MAX_WAIT_MS ) ) != pdTRUE )
+        {
+            LogError( ( "Connection to the broker not attempted, it has been failing for too long." ) );
+            xNetworkStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+            break;
+        }
+
         /* Establish a TCP connection with the MQTT broker. This example connects to
          * the MQTT broker as specified in democonfigMQTT_BROKER_ENDPOINT and
          * democonfigMQTT_BROKER_PORT at the top of this file. */
@@ -458,61 +644,118 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
                                                &xNetworkCredentials,
                                                mqttexampleTRANSPORT_SEND_RECV_TIMEOUT_MS,
                                                mqttexampleTRANSPORT_SEND_RECV_TIMEOUT_MS );
+        ulAttempts++;
 
-        if( xNetworkStatus != TLS_TRANSPORT_SUCCESS )
+        if( xNetworkStatus == TLS_TRANSPORT_SUCCESS )
         {
-            /* Generate a random number and calculate backoff value (in milliseconds) for
-             * the next connection retry.
+            vEndpointBackoffSuccess( pxBackoff );
+        }
+        else
+        {
+            /* Set the time of the next attempt from a random number.
              * Note: It is recommended to seed the random number generator with a device-specific
              * entropy source so that possibility of multiple devices retrying failed network operations
              * at similar intervals can be avoided. */
-            xBackoffAlgStatus = BackoffAlgorithm_GetNextBackoff( &xReconnectParams, uxRand(), &usNextRetryBackOff );
+            ( void ) xEndpointBackoffFailure( pxBackoff, ( uint32_t ) uxRand() );
 
-            if( xBackoffAlgStatus == BackoffAlgorithmRetriesExhausted )
+            if( ulAttempts >= RETRY_MAX_ATTEMPTS )
             {
                 LogError( ( "Connection to the broker failed, all attempts exhausted." ) );
             }
-            else if( xBackoffAlgStatus == BackoffAlgorithmSuccess )
+            else
             {
                 LogWarn( ( "Connection to the broker failed. "
                            "Retrying connection with backoff and jitter." ) );
-                vTaskDelay( pdMS_TO_TICKS( usNextRetryBackOff ) );
             }
         }
-    } while( ( xNetworkStatus != TLS_TRANSPORT_SUCCESS ) && ( xBackoffAlgStatus == BackoffAlgorithmSuccess ) );
+    } while( ( xNetworkStatus != TLS_TRANSPORT_SUCCESS ) && ( ulAttempts < RETRY_MAX_ATTEMPTS ) );
 
     return xNetworkStatus;
 }
 
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint8_t * pucIndex )
+static BaseType_t prvGetNextFreeIndexForOutgoingPublishes( uint16_t * pusIndex )
 {
     BaseType_t xReturnStatus = pdFAIL;
-    uint8_t ucIndex = 0;
+    uint16_t usIndex = MAX_OUTGOING_PUBLISHES;
 
     configASSERT( outgoingPublishPackets != NULL );
-    configASSERT( pucIndex != NULL );
+    configASSERT( pusIndex != NULL );
 
-    for( ucIndex = 0; ucIndex < MAX_OUTGOING_PUBLISHES; ucIndex++ )
+    if( xOutgoingSlotsInitialised == pdFALSE )
     {
-        /* A free ucIndex is marked by invalid packet id.
-         * Check if the ucIndex has a free slot. */
-        if( outgoingPublishPackets[ ucIndex ].packetId == MQTT_PACKET_ID_INVALID )
-        {
-            xReturnStatus = pdPASS;
-            break;
-        }
+        vCleanupOutgoingPublishes();
     }
 
-    /* Copy the available ucIndex into the output param. */
-    *pucIndex = ucIndex;
+    /* Take the first slot from the free list. */
+    if( usFreeOutgoingSlots != OUTGOING_PUBLISH_NO_SLOT )
+    {
+        usIndex = usFreeOutgoingSlots;
+        usFreeOutgoingSlots = usNextOutgoingSlot[ usIndex ];
+        usNextOutgoingSlot[ usIndex ] = OUTGOING_PUBLISH_NO_SLOT;
+        xReturnStatus = pdPASS;
+    }
+
+    /* Copy the available usIndex into the output param. */
+    *pusIndex = usIndex;
 
     return xReturnStatus;
 }
 
 /*-----------------------------------------------------------*/
 
+static void prvTrackOutgoingPublishAt( uint16_t usIndex )
+{
+    uint16_t usBucket;
+
+    configASSERT( usIndex < MAX_OUTGOING_PUBLISHES );
+    configASSERT( outgoingPublishPackets[ usIndex ].packetId != MQTT_PACKET_ID_INVALID );
+
+    /* The map always has a free bucket, as it is larger than the array. */
+    usBucket = outgoingPublishPackets[ usIndex ].packetId % OUTGOING_PUBLISH_MAP_SIZE;
+
+    while( usOutgoingPublishMap[ usBucket ] != 0U )
+    {
+        usBucket = ( uint16_t ) ( ( usBucket + 1U ) % OUTGOING_PUBLISH_MAP_SIZE );
+    }
+
+    usOutgoingPublishMap[ usBucket ] = ( uint16_t ) ( usIndex + 1U );
+
+    /* Append to the publishes in flight. */
+    usPrevOutgoingSlot[ usIndex ] = usLastOutgoingSlot;
+    usNextOutgoingSlot[ usIndex ] = OUTGOING_PUBLISH_NO_SLOT;
+
+    if( usLastOutgoingSlot == OUTGOING_PUBLISH_NO_SLOT )
+    {
+        usFirstOutgoingSlot = usIndex;
+    }
+    else
+    {
+        usNextOutgoingSlot[ usLastOutgoingSlot ] = usIndex;
+    }
+
+    usLastOutgoingSlot = usIndex;
+    usOutgoingInFlight++;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvFindOutgoingPublish( uint16_t usPacketId )
+{
+    uint16_t usBucket = usPacketId % OUTGOING_PUBLISH_MAP_SIZE;
+
+    while( ( usOutgoingPublishMap[ usBucket ] != 0U ) &&
+           ( outgoingPublishPackets[ usOutgoingPublishMap[ usBucket ] - 1U ].packetId != usPacketId ) )
+    {
+        usBucket = ( uint16_t ) ( ( usBucket + 1U ) % OUTGOING_PUBLISH_MAP_SIZE );
+    }
+
+    return ( usOutgoingPublishMap[ usBucket ] != 0U ) ? usBucket : ( uint16_t ) OUTGOING_PUBLISH_MAP_SIZE;
+}
+
+/*-----------------------------------------------------------*/
+
 static MQTTStatus_t prvProcessLoopWithTimeout( MQTTContext_t * pMqttContext,
                                                uint32_t ulTimeoutMs )
 {
@@ -543,46 +786,151 @@ static MQTTStatus_t prvProcessLoopWithTimeout( MQTTContext_t * pMqttContext,
 
 /*-----------------------------------------------------------*/
 
-static void vCleanupOutgoingPublishAt( uint8_t ucIndex )
+static void vCleanupOutgoingPublishAt( uint16_t usIndex )
 {
+    uint16_t usBucket, usNext, usHome;
+
     configASSERT( outgoingPublishPackets != NULL );
-    configASSERT( ucIndex < MAX_OUTGOING_PUBLISHES );
+    configASSERT( usIndex < MAX_OUTGOING_PUBLISHES );
+
+    usBucket = ( outgoingPublishPackets[ usIndex ].packetId != MQTT_PACKET_ID_INVALID ) ?
+               prvFindOutgoingPublish( outgoingPublishPackets[ usIndex ].packetId ) :
+               ( uint16_t ) OUTGOING_PUBLISH_MAP_SIZE;
+
+    if( ( usBucket < OUTGOING_PUBLISH_MAP_SIZE ) && ( usOutgoingPublishMap[ usBucket ] == ( usIndex + 1U ) ) )
+    {
+        /* Remove the bucket, and move up the entries after it that would no
+         * longer be found by probing from their home bucket. */
+        usNext = usBucket;
+
+        for( ; ; )
+        {
+            usNext = ( uint16_t ) ( ( usNext + 1U ) % OUTGOING_PUBLISH_MAP_SIZE );
+
+            if( usOutgoingPublishMap[ usNext ] == 0U )
+            {
+                break;
+            }
+
+            usHome = outgoingPublishPackets[ usOutgoingPublishMap[ usNext ] - 1U ].packetId % OUTGOING_PUBLISH_MAP_SIZE;
+
+            if( ( ( usNext > usBucket ) && ( ( usHome <= usBucket ) || ( usHome > usNext ) ) ) ||
+                ( ( usNext < usBucket ) && ( usHome <= usBucket ) && ( usHome > usNext ) ) )
+            {
+                usOutgoingPublishMap[ usBucket ] = usOutgoingPublishMap[ usNext ];
+                usBucket = usNext;
+            }
+        }
+
+        usOutgoingPublishMap[ usBucket ] = 0U;
+
+        /* Unlink from the publishes in flight. */
+        if( usPrevOutgoingSlot[ usIndex ] == OUTGOING_PUBLISH_NO_SLOT )
+        {
+            usFirstOutgoingSlot = usNextOutgoingSlot[ usIndex ];
+        }
+        else
+        {
+            usNextOutgoingSlot[ usPrevOutgoingSlot[ usIndex ] ] = usNextOutgoingSlot[ usIndex ];
+        }
+
+        if( usNextOutgoingSlot[ usIndex ] == OUTGOING_PUBLISH_NO_SLOT )
+        {
+            usLastOutgoingSlot = usPrevOutgoingSlot[ usIndex ];
+        }
+        else
+        {
+            usPrevOutgoingSlot[ usNextOutgoingSlot[ usIndex ] ] = usPrevOutgoingSlot[ usIndex ];
+        }
+
+        usOutgoingInFlight--;
+    }
 
     /* Clear the outgoing publish packet. */
-    ( void ) memset( &( outgoingPublishPackets[ ucIndex ] ),
+    ( void ) memset( &( outgoingPublishPackets[ usIndex ] ),
                      0x00,
-                     sizeof( outgoingPublishPackets[ ucIndex ] ) );
+                     sizeof( outgoingPublishPackets[ usIndex ] ) );
+
+    /* Return the slot to the free list. */
+    usNextOutgoingSlot[ usIndex ] = usFreeOutgoingSlots;
+    usFreeOutgoingSlots = usIndex;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCompleteOutgoingPublishAt( uint16_t usIndex,
+                                          BaseType_t xAcked )
+{
+    PublishCompleteCallback_t pxCallback = outgoingPublishPackets[ usIndex ].pxCallback;
+    void * pvCallbackContext = outgoingPublishPackets[ usIndex ].pvCallbackContext;
+    uint16_t usPacketId = outgoingPublishPackets[ usIndex ].packetId;
+
+    /* Free the slot first, so that the callback can publish again. */
+    vCleanupOutgoingPublishAt( usIndex );
+
+    if( pxCallback != NULL )
+    {
+        pxCallback( pvCallbackContext, usPacketId, xAcked );
+    }
 }
 
 /*-----------------------------------------------------------*/
 
 static void vCleanupOutgoingPublishes( void )
 {
+    uint16_t usIndex, usCount;
+
     configASSERT( outgoingPublishPackets != NULL );
 
-    /* Clean up all the outgoing publish packets. */
-    ( void ) memset( outgoingPublishPackets, 0x00, sizeof( outgoingPublishPackets ) );
+    if( xOutgoingSlotsInitialised != pdFALSE )
+    {
+        /* Drop the publishes in flight.  Their callbacks may publish again,
+         * which appends to the list, so only the current ones are dropped. */
+        for( usCount = usOutgoingInFlight; ( usCount > 0U ) && ( usFirstOutgoingSlot != OUTGOING_PUBLISH_NO_SLOT ); usCount-- )
+        {
+            prvCompleteOutgoingPublishAt( usFirstOutgoingSlot, pdFALSE );
+        }
+    }
+    else
+    {
+        /* Clean up all the outgoing publish packets. */
+        ( void ) memset( outgoingPublishPackets, 0x00, sizeof( outgoingPublishPackets ) );
+        ( void ) memset( usOutgoingPublishMap, 0x00, sizeof( usOutgoingPublishMap ) );
+
+        /* All slots are free, the lowest index is used first. */
+        usFreeOutgoingSlots = OUTGOING_PUBLISH_NO_SLOT;
+
+        for( usIndex = MAX_OUTGOING_PUBLISHES; usIndex > 0U; usIndex-- )
+        {
+            usNextOutgoingSlot[ usIndex - 1U ] = usFreeOutgoingSlots;
+            usFreeOutgoingSlots = ( uint16_t ) ( usIndex - 1U );
+        }
+
+        usFirstOutgoingSlot = OUTGOING_PUBLISH_NO_SLOT;
+        usLastOutgoingSlot = OUTGOING_PUBLISH_NO_SLOT;
+        usOutgoingInFlight = 0U;
+        xOutgoingSlotsInitialised = pdTRUE;
+    }
 }
 
 /*-----------------------------------------------------------*/
 
 static void vCleanupOutgoingPublishWithPacketID( uint16_t usPacketId )
 {
-    uint8_t ucIndex = 0;
+    uint16_t usBucket;
 
     configASSERT( outgoingPublishPackets != NULL );
     configASSERT( usPacketId != MQTT_PACKET_ID_INVALID );
 
-    /* Clean up all the saved outgoing publishes. */
-    for( ; ucIndex < MAX_OUTGOING_PUBLISHES; ucIndex++ )
+    usBucket = ( xOutgoingSlotsInitialised != pdFALSE ) ?
+               prvFindOutgoingPublish( usPacketId ) :
+               ( uint16_t ) OUTGOING_PUBLISH_MAP_SIZE;
+
+    if( usBucket < OUTGOING_PUBLISH_MAP_SIZE )
     {
-        if( outgoingPublishPackets[ ucIndex ].packetId == usPacketId )
-        {
-            vCleanupOutgoingPublishAt( ucIndex );
-            LogInfo( ( "Cleaned up outgoing publish packet with packet id %u.\n\n",
-                       usPacketId ) );
-            break;
-        }
+        prvCompleteOutgoingPublishAt( ( uint16_t ) ( usOutgoingPublishMap[ usBucket ] - 1U ), pdTRUE );
+        LogInfo( ( "Cleaned up outgoing publish packet with packet id %u.\n\n",
+                   usPacketId ) );
     }
 }
 
@@ -634,39 +982,51 @@ static BaseType_t xHandlePublishResend( MQTTContext_t * pxMqttContext )
 {
     BaseType_t xReturnStatus = pdTRUE;
     MQTTStatus_t xMQTTStatus = MQTTSuccess;
-    uint8_t ucIndex = 0U;
+    uint16_t usIndex, usNext, usCount;
 
     configASSERT( outgoingPublishPackets != NULL );
 
-    /* Resend all the QoS1 publishes still in the array. These are the
-     * publishes that haven't received a PUBACK. When a PUBACK is
-     * received, the publish is removed from the array. */
-    for( ucIndex = 0U; ucIndex < MAX_OUTGOING_PUBLISHES; ucIndex++ )
+    /* Resend all the QoS1 publishes still in flight, in the order in which
+     * they were first sent. These are the publishes that haven't received a
+     * PUBACK. When a PUBACK is received, the publish is removed from the
+     * list. */
+    usIndex = ( xOutgoingSlotsInitialised != pdFALSE ) ? usFirstOutgoingSlot : ( uint16_t ) OUTGOING_PUBLISH_NO_SLOT;
+
+    for( usCount = usOutgoingInFlight; ( usCount > 0U ) && ( usIndex != OUTGOING_PUBLISH_NO_SLOT ); usCount--, usIndex = usNext )
     {
-        if( outgoingPublishPackets[ ucIndex ].packetId != MQTT_PACKET_ID_INVALID )
+        usNext = usNextOutgoingSlot[ usIndex ];
+
+        if( outgoingPublishPackets[ usIndex ].ucResendCount >= mqttexampleMAX_PUBLISH_RESENDS )
         {
-            outgoingPublishPackets[ ucIndex ].pubInfo.dup = true;
+            LogWarn( ( "Dropping PUBLISH with packet id %u after %u resends.",
+                       outgoingPublishPackets[ usIndex ].packetId,
+                       ( unsigned ) mqttexampleMAX_PUBLISH_RESENDS ) );
+            prvCompleteOutgoingPublishAt( usIndex, pdFALSE );
+            continue;
+        }
 
-            LogInfo( ( "Sending duplicate PUBLISH with packet id %u.",
-                       outgoingPublishPackets[ ucIndex ].packetId ) );
-            xMQTTStatus = MQTT_Publish( pxMqttContext,
-                                        &outgoingPublishPackets[ ucIndex ].pubInfo,
-                                        outgoingPublishPackets[ ucIndex ].packetId );
+        outgoingPublishPackets[ usIndex ].ucResendCount++;
+        outgoingPublishPackets[ usIndex ].pubInfo.dup = true;
 
-            if( xMQTTStatus != MQTTSuccess )
-            {
-                LogError( ( "Sending duplicate PUBLISH for packet id %u "
-                            " failed with status %s.",
-                            outgoingPublishPackets[ ucIndex ].packetId,
-                            MQTT_Status_strerror( xMQTTStatus ) ) );
-                xReturnStatus = pdFAIL;
-                break;
-            }
-            else
-            {
-                LogInfo( ( "Sent duplicate PUBLISH successfully for packet id %u.\n\n",
-                           outgoingPublishPackets[ ucIndex ].packetId ) );
-            }
+        LogInfo( ( "Sending duplicate PUBLISH with packet id %u.",
+                   outgoingPublishPackets[ usIndex ].packetId ) );
+        xMQTTStatus = MQTT_Publish( pxMqttContext,
+                                    &outgoingPublishPackets[ usIndex ].pubInfo,
+                                    outgoingPublishPackets[ usIndex ].packetId );
+
+        if( xMQTTStatus != MQTTSuccess )
+        {
+            LogError( ( "Sending duplicate PUBLISH for packet id %u "
+                        " failed with status %s.",
+                        outgoingPublishPackets[ usIndex ].packetId,
+                        MQTT_Status_strerror( xMQTTStatus ) ) );
+            xReturnStatus = pdFAIL;
+            break;
+        }
+        else
+        {
+            LogInfo( ( "Sent duplicate PUBLISH successfully for packet id %u.\n\n",
+                       outgoingPublishPackets[ usIndex ].packetId ) );
         }
     }
 
@@ -707,7 +1067,7 @@ BaseType_t xEstablishMqttSession( MQTTContext_t * pxMqttContext,
         xTransport.pNetworkContext = pxNetworkContext;
         xTransport.send = TLS_FreeRTOS_send;
         xTransport.recv = TLS_FreeRTOS_recv;
-        xTransport.writev = NULL;
+        xTransport.writev = TLS_FreeRTOS_writev;
 
         /* Initialize MQTT library. */
         xMQTTStatus = MQTT_Init( pxMqttContext,
@@ -997,7 +1357,7 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
 {
     BaseType_t xReturnStatus = pdPASS;
     MQTTStatus_t xMQTTStatus = MQTTSuccess;
-    uint8_t ucPublishIndex = MAX_OUTGOING_PUBLISHES;
+    uint16_t usPublishIndex = MAX_OUTGOING_PUBLISHES;
 
     configASSERT( pxMqttContext != NULL );
     configASSERT( pcTopicFilter != NULL );
@@ -1007,7 +1367,7 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
      * publishes are stored until a PUBACK is received. These messages are
      * stored for supporting a resend if a network connection is broken before
      * receiving a PUBACK. */
-    xReturnStatus = prvGetNextFreeIndexForOutgoingPublishes( &ucPublishIndex );
+    xReturnStatus = prvGetNextFreeIndexForOutgoingPublishes( &usPublishIndex );
 
     if( xReturnStatus == pdFAIL )
     {
@@ -1017,25 +1377,26 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
     {
         LogInfo( ( "the published payload:%.*s \r\n ", payloadLength, pcPayload ) );
         /* This example publishes to only one topic and uses QOS1. */
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.qos = MQTTQoS1;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.pTopicName = pcTopicFilter;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.topicNameLength = topicFilterLength;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.pPayload = pcPayload;
-        outgoingPublishPackets[ ucPublishIndex ].pubInfo.payloadLength = payloadLength;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.qos = MQTTQoS1;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.pTopicName = pcTopicFilter;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.topicNameLength = topicFilterLength;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.pPayload = pcPayload;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.payloadLength = payloadLength;
 
         /* Get a new packet id. */
-        outgoingPublishPackets[ ucPublishIndex ].packetId = MQTT_GetPacketId( pxMqttContext );
+        outgoingPublishPackets[ usPublishIndex ].packetId = MQTT_GetPacketId( pxMqttContext );
+        prvTrackOutgoingPublishAt( usPublishIndex );
 
         /* Send PUBLISH packet. */
         xMQTTStatus = MQTT_Publish( pxMqttContext,
-                                    &outgoingPublishPackets[ ucPublishIndex ].pubInfo,
-                                    outgoingPublishPackets[ ucPublishIndex ].packetId );
+                                    &outgoingPublishPackets[ usPublishIndex ].pubInfo,
+                                    outgoingPublishPackets[ usPublishIndex ].packetId );
 
         if( xMQTTStatus != MQTTSuccess )
         {
             LogError( ( "Failed to send PUBLISH packet to broker with error = %s.",
                         MQTT_Status_strerror( xMQTTStatus ) ) );
-            vCleanupOutgoingPublishAt( ucPublishIndex );
+            vCleanupOutgoingPublishAt( usPublishIndex );
             xReturnStatus = pdFAIL;
         }
         else
@@ -1043,7 +1404,7 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
             LogInfo( ( "PUBLISH sent for topic %.*s to broker with packet ID %u.\n\n",
                        topicFilterLength,
                        pcTopicFilter,
-                       outgoingPublishPackets[ ucPublishIndex ].packetId ) );
+                       outgoingPublishPackets[ usPublishIndex ].packetId ) );
 
             /* Calling MQTT_ProcessLoop to process incoming publish echo, since
              * application subscribed to the same topic the broker will send
@@ -1067,6 +1428,514 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
 
 /*-----------------------------------------------------------*/
 
+#if ( mqttexampleCOMPRESS_PAYLOADS == 1 )
+
+    BaseType_t xPublishToTopicCompressed( MQTTContext_t * pxMqttContext,
+                                          const char * pcTopicFilter,
+                                          int32_t topicFilterLength,
+                                          const char * pcPayload,
+                                          size_t payloadLength,
+                                          uint8_t * pucBuffer,
+                                          size_t xBufferLength )
+    {
+        BaseType_t xCompressed = pdFAIL;
+        size_t xTopicLength = ( size_t ) topicFilterLength + mqttcompressTOPIC_SUFFIX_LENGTH;
+        size_t xCompressedLength = 0U;
+        size_t xOutputLength;
+        TickType_t xStartTicks;
+
+        configASSERT( pcTopicFilter != NULL );
+        configASSERT( topicFilterLength > 0 );
+        configASSERT( pucBuffer != NULL );
+
+        /* Only send the compressed payload when it saves more bytes than the
+         * suffix adds to the topic. */
+        if( ( xTopicLength < xBufferLength ) &&
+            ( xTopicLength <= UINT16_MAX ) &&
+            ( payloadLength > mqttcompressTOPIC_SUFFIX_LENGTH ) )
+        {
+            xOutputLength = xBufferLength - xTopicLength;
+
+            if( xOutputLength >= ( payloadLength - mqttcompressTOPIC_SUFFIX_LENGTH ) )
+            {
+                xOutputLength = payloadLength - mqttcompressTOPIC_SUFFIX_LENGTH - 1U;
+            }
+
+            xStartTicks = xTaskGetTickCount();
+            xCompressed = xPayloadCompress( &xPayloadCompressor,
+                                            ( const uint8_t * ) pcPayload,
+                                            payloadLength,
+                                            &( pucBuffer[ xTopicLength ] ),
+                                            xOutputLength,
+                                            &xCompressedLength );
+
+            LogDebug( ( "Payload of %lu bytes %s to %lu bytes in %lu ticks.",
+                        ( unsigned long ) payloadLength,
+                        ( xCompressed == pdPASS ) ? "compressed" : "not compressed",
+                        ( unsigned long ) ( ( xCompressed == pdPASS ) ? xCompressedLength : payloadLength ),
+                        ( unsigned long ) ( xTaskGetTickCount() - xStartTicks ) ) );
+        }
+
+        if( xCompressed == pdPASS )
+        {
+            ( void ) memcpy( pucBuffer, pcTopicFilter, ( size_t ) topicFilterLength );
+            ( void ) memcpy( &( pucBuffer[ topicFilterLength ] ), mqttcompressTOPIC_SUFFIX, mqttcompressTOPIC_SUFFIX_LENGTH );
+
+            xCompressed = xPublishToTopic( pxMqttContext,
+                                           ( const char * ) pucBuffer,
+                                           ( int32_t ) xTopicLength,
+                                           ( const char * ) &( pucBuffer[ xTopicLength ] ),
+                                           xCompressedLength );
+        }
+        else
+        {
+            xCompressed = xPublishToTopic( pxMqttContext,
+                                           pcTopicFilter,
+                                           topicFilterLength,
+                                           pcPayload,
+                                           payloadLength );
+        }
+
+        return xCompressed;
+    }
+
+/*-----------------------------------------------------------*/
+
+    BaseType_t xDecompressIncomingPublish( const MQTTPublishInfo_t * pxPublishInfo,
+                                           uint8_t * pucOutput,
+                                           size_t xOutputLength,
+                                           size_t * pxPayloadLength )
+    {
+        BaseType_t xReturnStatus = pdFAIL;
+        PayloadDecompressor_t xDecompressor;
+        PayloadDecompressStatus_t xStatus;
+        size_t xInputUsed = 0U;
+
+        configASSERT( pxPublishInfo != NULL );
+        configASSERT( pxPayloadLength != NULL );
+
+        vPayloadDecompressInit( &xDecompressor );
+        xStatus = xPayloadDecompress( &xDecompressor,
+                                      ( const uint8_t * ) pxPublishInfo->pPayload,
+                                      pxPublishInfo->payloadLength,
+                                      &xInputUsed,
+                                      pucOutput,
+                                      xOutputLength,
+                                      pxPayloadLength );
+
+        if( xStatus == PayloadDecompressDone )
+        {
+            xReturnStatus = pdPASS;
+        }
+        else
+        {
+            LogError( ( "Failed to decompress the payload of a publish to %.*s, status %d.",
+                        pxPublishInfo->topicNameLength,
+                        pxPublishInfo->pTopicName,
+                        ( int ) xStatus ) );
+        }
+
+        return xReturnStatus;
+    }
+
+#endif /* if ( mqttexampleCOMPRESS_PAYLOADS == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPublishToTopicPipelined( MQTTContext_t * pxMqttContext,
+                                     const char * pcTopicFilter,
+                                     int32_t topicFilterLength,
+                                     const char * pcPayload,
+                                     size_t payloadLength,
+                                     PublishCompleteCallback_t pxCallback,
+                                     void * pvCallbackContext,
+                                     uint16_t * pusPacketId )
+{
+    BaseType_t xReturnStatus = pdPASS;
+    MQTTStatus_t xMQTTStatus = MQTTSuccess;
+    uint16_t usPublishIndex = MAX_OUTGOING_PUBLISHES;
+
+    configASSERT( pxMqttContext != NULL );
+    configASSERT( pcTopicFilter != NULL );
+    configASSERT( topicFilterLength > 0 );
+
+    xReturnStatus = prvReserveOutgoingPublish( pxMqttContext, &usPublishIndex );
+
+    if( xReturnStatus == pdPASS )
+    {
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.qos = MQTTQoS1;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.pTopicName = pcTopicFilter;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.topicNameLength = topicFilterLength;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.pPayload = pcPayload;
+        outgoingPublishPackets[ usPublishIndex ].pubInfo.payloadLength = payloadLength;
+        outgoingPublishPackets[ usPublishIndex ].pxCallback = pxCallback;
+        outgoingPublishPackets[ usPublishIndex ].pvCallbackContext = pvCallbackContext;
+
+        /* Get a new packet id. */
+        outgoingPublishPackets[ usPublishIndex ].packetId = MQTT_GetPacketId( pxMqttContext );
+        prvTrackOutgoingPublishAt( usPublishIndex );
+
+        /* Send PUBLISH packet, the PUBACK is handled by a later process loop. */
+        xMQTTStatus = MQTT_Publish( pxMqttContext,
+                                    &outgoingPublishPackets[ usPublishIndex ].pubInfo,
+                                    outgoingPublishPackets[ usPublishIndex ].packetId );
+
+        if( xMQTTStatus != MQTTSuccess )
+        {
+            LogError( ( "Failed to send PUBLISH packet to broker with error = %s.",
+                        MQTT_Status_strerror( xMQTTStatus ) ) );
+            vCleanupOutgoingPublishAt( usPublishIndex );
+            xReturnStatus = pdFAIL;
+        }
+        else
+        {
+            LogDebug( ( "PUBLISH sent for topic %.*s to broker with packet ID %u, %u in flight.",
+                        topicFilterLength,
+                        pcTopicFilter,
+                        outgoingPublishPackets[ usPublishIndex ].packetId,
+                        usOutgoingInFlight ) );
+
+            if( pusPacketId != NULL )
+            {
+                *pusPacketId = outgoingPublishPackets[ usPublishIndex ].packetId;
+            }
+        }
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReserveOutgoingPublish( MQTTContext_t * pxMqttContext,
+                                             uint16_t * pusIndex )
+{
+    BaseType_t xReturnStatus;
+    MQTTStatus_t xMQTTStatus = MQTTSuccess;
+    uint32_t ulStartTime;
+
+    xReturnStatus = prvGetNextFreeIndexForOutgoingPublishes( pusIndex );
+
+    /* When the window is full, handle incoming packets until a PUBACK frees
+     * a slot. */
+    ulStartTime = pxMqttContext->getTime();
+
+    while( ( xReturnStatus == pdFAIL ) &&
+           ( ( xMQTTStatus == MQTTSuccess ) || ( xMQTTStatus == MQTTNeedMoreBytes ) ) &&
+           ( ( pxMqttContext->getTime() - ulStartTime ) < mqttexamplePROCESS_LOOP_TIMEOUT_MS ) )
+    {
+        xMQTTStatus = MQTT_ProcessLoop( pxMqttContext );
+        xReturnStatus = prvGetNextFreeIndexForOutgoingPublishes( pusIndex );
+    }
+
+    if( xReturnStatus == pdFAIL )
+    {
+        LogError( ( "No PUBACK freed a spot for an outgoing PUBLISH message, status = %s.\n\n",
+                    MQTT_Status_strerror( xMQTTStatus ) ) );
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendVectors( MQTTContext_t * pxMqttContext,
+                                  TransportOutVector_t * pxVectors,
+                                  size_t xVectorCount )
+{
+    TransportInterface_t * pxTransport = &pxMqttContext->transportInterface;
+    BaseType_t xReturnStatus = pdPASS;
+    uint32_t ulStartTime = pxMqttContext->getTime();
+    int32_t lSent;
+    size_t xAdvance;
+
+    /* Skip empty buffers, e.g. an empty payload. */
+    while( ( xVectorCount > 0U ) && ( pxVectors->iov_len == 0U ) )
+    {
+        pxVectors++;
+        xVectorCount--;
+    }
+
+    while( ( xReturnStatus == pdPASS ) && ( xVectorCount > 0U ) )
+    {
+        if( pxTransport->writev != NULL )
+        {
+            lSent = pxTransport->writev( pxTransport->pNetworkContext, pxVectors, xVectorCount );
+        }
+        else
+        {
+            lSent = pxTransport->send( pxTransport->pNetworkContext, pxVectors->iov_base, pxVectors->iov_len );
+        }
+
+        if( lSent < 0 )
+        {
+            LogError( ( "Transport send failed with %d.", ( int ) lSent ) );
+            xReturnStatus = pdFAIL;
+        }
+        else if( ( lSent == 0 ) &&
+                 ( ( pxMqttContext->getTime() - ulStartTime ) >= mqttexamplePROCESS_LOOP_TIMEOUT_MS ) )
+        {
+            LogError( ( "Timed out sending a PUBLISH packet." ) );
+            xReturnStatus = pdFAIL;
+        }
+        else
+        {
+            /* Move past the bytes sent, which may end within a buffer, and
+             * past any empty buffers after them. */
+            while( ( xVectorCount > 0U ) && ( ( lSent > 0 ) || ( pxVectors->iov_len == 0U ) ) )
+            {
+                xAdvance = ( ( size_t ) lSent < pxVectors->iov_len ) ? ( size_t ) lSent : pxVectors->iov_len;
+                pxVectors->iov_base = ( const uint8_t * ) pxVectors->iov_base + xAdvance;
+                pxVectors->iov_len -= xAdvance;
+                lSent -= ( int32_t ) xAdvance;
+
+                if( pxVectors->iov_len == 0U )
+                {
+                    pxVectors++;
+                    xVectorCount--;
+                }
+            }
+        }
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xInitPublishTemplate( PublishTemplate_t * pxTemplate,
+                                 uint8_t * pucBuffer,
+                                 size_t xBufferLength,
+                                 const char * pcTopicName,
+                                 uint16_t usTopicLength,
+                                 MQTTQoS_t xQoS,
+                                 bool xRetain )
+{
+    BaseType_t xReturnStatus = pdPASS;
+
+    configASSERT( pxTemplate != NULL );
+    configASSERT( pucBuffer != NULL );
+    configASSERT( pcTopicName != NULL );
+
+    if( ( usTopicLength == 0U ) ||
+        ( xBufferLength < mqttexamplePUBLISH_TEMPLATE_BUFFER_LENGTH( ( size_t ) usTopicLength ) ) ||
+        ( ( xQoS != MQTTQoS0 ) && ( xQoS != MQTTQoS1 ) ) )
+    {
+        LogError( ( "Invalid PUBLISH template for topic %.*s.",
+                    usTopicLength,
+                    pcTopicName ) );
+        xReturnStatus = pdFAIL;
+    }
+    else
+    {
+        pxTemplate->pucBuffer = pucBuffer;
+        pxTemplate->pcTopicName = pcTopicName;
+        pxTemplate->usTopicLength = usTopicLength;
+        pxTemplate->xQoS = xQoS;
+        pxTemplate->xRetain = xRetain;
+
+        /* The topic name, as a length-prefixed string, follows the space kept
+         * for the fixed header. The packet identifier is written after it
+         * with each publish. */
+        pucBuffer[ PUBLISH_TEMPLATE_HEADER_RESERVE ] = ( uint8_t ) ( usTopicLength >> 8 );
+        pucBuffer[ PUBLISH_TEMPLATE_HEADER_RESERVE + 1U ] = ( uint8_t ) ( usTopicLength & 0xFFU );
+        ( void ) memcpy( &pucBuffer[ PUBLISH_TEMPLATE_HEADER_RESERVE + 2U ], pcTopicName, usTopicLength );
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPublishFromTemplate( MQTTContext_t * pxMqttContext,
+                                 PublishTemplate_t * pxTemplate,
+                                 const char * pcPayload,
+                                 size_t payloadLength,
+                                 PublishCompleteCallback_t pxCallback,
+                                 void * pvCallbackContext,
+                                 uint16_t * pusPacketId )
+{
+    BaseType_t xReturnStatus = pdPASS;
+    MQTTStatus_t xMQTTStatus = MQTTSuccess;
+    MQTTPublishState_t xPublishState = MQTTStateNull;
+    uint16_t usPublishIndex = MAX_OUTGOING_PUBLISHES;
+    uint16_t usPacketId = MQTT_PACKET_ID_INVALID;
+    TransportOutVector_t xVectors[ 2 ];
+    uint8_t ucEncoded[ 4 ];
+    size_t xEncodedLength = 0U;
+    size_t xVariableLength;
+    size_t xRemainingLength;
+    size_t xHeaderStart;
+    size_t i;
+
+    configASSERT( pxMqttContext != NULL );
+    configASSERT( pxTemplate != NULL );
+    configASSERT( ( pcPayload != NULL ) || ( payloadLength == 0U ) );
+
+    /* The topic name, and the packet identifier of a QoS1 publish. */
+    xVariableLength = 2U + ( size_t ) pxTemplate->usTopicLength +
+                      ( ( pxTemplate->xQoS == MQTTQoS0 ) ? 0U : 2U );
+
+    if( pxMqttContext->connectStatus != MQTTConnected )
+    {
+        LogError( ( "Cannot publish from a template while disconnected." ) );
+        xReturnStatus = pdFAIL;
+    }
+    else if( payloadLength > ( MQTT_MAX_REMAINING_LENGTH - xVariableLength ) )
+    {
+        LogError( ( "PUBLISH payload of %u bytes is too long.",
+                    ( unsigned ) payloadLength ) );
+        xReturnStatus = pdFAIL;
+    }
+    else if( pxTemplate->xQoS != MQTTQoS0 )
+    {
+        /* A QoS1 publish is tracked as by xPublishToTopicPipelined(), so that
+         * it is resent with MQTT_Publish() after a reconnect. */
+        xReturnStatus = prvReserveOutgoingPublish( pxMqttContext, &usPublishIndex );
+
+        if( xReturnStatus == pdPASS )
+        {
+            outgoingPublishPackets[ usPublishIndex ].pubInfo.qos = pxTemplate->xQoS;
+            outgoingPublishPackets[ usPublishIndex ].pubInfo.retain = pxTemplate->xRetain;
+            outgoingPublishPackets[ usPublishIndex ].pubInfo.pTopicName = pxTemplate->pcTopicName;
+            outgoingPublishPackets[ usPublishIndex ].pubInfo.topicNameLength = pxTemplate->usTopicLength;
+            outgoingPublishPackets[ usPublishIndex ].pubInfo.pPayload = pcPayload;
+            outgoingPublishPackets[ usPublishIndex ].pubInfo.payloadLength = payloadLength;
+            outgoingPublishPackets[ usPublishIndex ].pxCallback = pxCallback;
+            outgoingPublishPackets[ usPublishIndex ].pvCallbackContext = pvCallbackContext;
+
+            usPacketId = MQTT_GetPacketId( pxMqttContext );
+            outgoingPublishPackets[ usPublishIndex ].packetId = usPacketId;
+
+            /* Let the library expect the PUBACK, as MQTT_Publish() would. */
+            xMQTTStatus = MQTT_ReserveState( pxMqttContext, usPacketId, pxTemplate->xQoS );
+
+            if( xMQTTStatus != MQTTSuccess )
+            {
+                LogError( ( "Failed to reserve a state record for packet ID %u with error = %s.",
+                            usPacketId,
+                            MQTT_Status_strerror( xMQTTStatus ) ) );
+                outgoingPublishPackets[ usPublishIndex ].packetId = MQTT_PACKET_ID_INVALID;
+                vCleanupOutgoingPublishAt( usPublishIndex );
+                xReturnStatus = pdFAIL;
+            }
+            else
+            {
+                prvTrackOutgoingPublishAt( usPublishIndex );
+
+                pxTemplate->pucBuffer[ xVariableLength + PUBLISH_TEMPLATE_HEADER_RESERVE - 2U ] = ( uint8_t ) ( usPacketId >> 8 );
+                pxTemplate->pucBuffer[ xVariableLength + PUBLISH_TEMPLATE_HEADER_RESERVE - 1U ] = ( uint8_t ) ( usPacketId & 0xFFU );
+            }
+        }
+    }
+    else
+    {
+        /* Empty else marker. */
+    }
+
+    if( xReturnStatus == pdPASS )
+    {
+        /* Encode the remaining length, and write the fixed header right in
+         * front of the topic name. */
+        xRemainingLength = xVariableLength + payloadLength;
+
+        do
+        {
+            ucEncoded[ xEncodedLength ] = ( uint8_t ) ( xRemainingLength & 0x7FU );
+            xRemainingLength >>= 7;
+
+            if( xRemainingLength > 0U )
+            {
+                ucEncoded[ xEncodedLength ] |= 0x80U;
+            }
+
+            xEncodedLength++;
+        } while( xRemainingLength > 0U );
+
+        xHeaderStart = PUBLISH_TEMPLATE_HEADER_RESERVE - 1U - xEncodedLength;
+        pxTemplate->pucBuffer[ xHeaderStart ] = ( uint8_t ) ( MQTT_PACKET_TYPE_PUBLISH |
+                                                              ( ( uint8_t ) pxTemplate->xQoS << 1 ) |
+                                                              ( ( pxTemplate->xRetain ) ? 1U : 0U ) );
+
+        for( i = 0; i < xEncodedLength; i++ )
+        {
+            pxTemplate->pucBuffer[ xHeaderStart + 1U + i ] = ucEncoded[ i ];
+        }
+
+        xVectors[ 0 ].iov_base = &pxTemplate->pucBuffer[ xHeaderStart ];
+        xVectors[ 0 ].iov_len = PUBLISH_TEMPLATE_HEADER_RESERVE - xHeaderStart + xVariableLength;
+        xVectors[ 1 ].iov_base = pcPayload;
+        xVectors[ 1 ].iov_len = payloadLength;
+
+        xReturnStatus = prvSendVectors( pxMqttContext, xVectors, 2U );
+
+        if( xReturnStatus == pdPASS )
+        {
+            pxMqttContext->lastPacketTxTime = pxMqttContext->getTime();
+
+            if( pxTemplate->xQoS != MQTTQoS0 )
+            {
+                ( void ) MQTT_UpdateStatePublish( pxMqttContext,
+                                                  usPacketId,
+                                                  MQTT_SEND,
+                                                  pxTemplate->xQoS,
+                                                  &xPublishState );
+
+                if( pusPacketId != NULL )
+                {
+                    *pusPacketId = usPacketId;
+                }
+            }
+
+            LogDebug( ( "PUBLISH sent from the template for topic %.*s with packet ID %u.",
+                        pxTemplate->usTopicLength,
+                        pxTemplate->pcTopicName,
+                        usPacketId ) );
+        }
+        else if( pxTemplate->xQoS != MQTTQoS0 )
+        {
+            vCleanupOutgoingPublishAt( usPublishIndex );
+        }
+        else
+        {
+            /* Empty else marker. */
+        }
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xWaitForOutgoingPublishes( MQTTContext_t * pxMqttContext,
+                                      uint32_t ulTimeoutMs )
+{
+    MQTTStatus_t xMQTTStatus = MQTTSuccess;
+    uint32_t ulStartTime;
+
+    configASSERT( pxMqttContext != NULL );
+
+    ulStartTime = pxMqttContext->getTime();
+
+    while( ( usOutgoingInFlight > 0U ) &&
+           ( ( xMQTTStatus == MQTTSuccess ) || ( xMQTTStatus == MQTTNeedMoreBytes ) ) &&
+           ( ( pxMqttContext->getTime() - ulStartTime ) < ulTimeoutMs ) )
+    {
+        xMQTTStatus = MQTT_ProcessLoop( pxMqttContext );
+    }
+
+    if( usOutgoingInFlight > 0U )
+    {
+        LogError( ( "%u PUBLISH messages are still waiting for a PUBACK, status = %s.",
+                    usOutgoingInFlight,
+                    MQTT_Status_strerror( xMQTTStatus ) ) );
+    }
+
+    return ( usOutgoingInFlight == 0U ) ? pdPASS : pdFAIL;
+}
+
+/*-----------------------------------------------------------*/
+
 BaseType_t xProcessLoop( MQTTContext_t * pxMqttContext,
                          uint32_t ulTimeoutMs )
 {
@@ -122,6 +122,197 @@ BaseType_t xPublishToTopic( MQTTContext_t * pxMqttContext,
                             const char * pcPayload,
                             size_t payloadLength );
 
+/**
+ * @brief Publish a message to a MQTT topic, compressed with
+ * xPayloadCompress() when that makes it shorter.
+ *
+ * A compressed payload is sent to the topic followed by
+ * mqttcompressTOPIC_SUFFIX, which the subscribers use to tell it from a plain
+ * one, and a payload that does not get shorter is sent to the topic as is.
+ * Only use it with topics defined by the application, as the reserved topics
+ * of AWS IoT services, such as the shadow and Device Defender topics, expect
+ * their own payload formats.
+ *
+ * Available when mqttexampleCOMPRESS_PAYLOADS is 1 in demo_config.h, and
+ * mqtt_payload_compression.c is built.
+ *
+ * @param[in] pxMqttContext The MQTT context for the MQTT connection.
+ * @param[in] pcTopicFilter Points to the topic.
+ * @param[in] topicFilterLength The length of the topic.
+ * @param[in] pcPayload Points to the payload.
+ * @param[in] payloadLength The length of the payload.
+ * @param[in] pucBuffer The buffer for the topic with its suffix and the
+ * compressed payload.  As with the payload of xPublishToTopic(), it must stay
+ * valid until the PUBACK arrives.
+ * @param[in] xBufferLength The length of @p pucBuffer.
+ *
+ * @return pdPASS if PUBLISH was successfully sent;
+ * pdFAIL otherwise.
+ */
+BaseType_t xPublishToTopicCompressed( MQTTContext_t * pxMqttContext,
+                                      const char * pcTopicFilter,
+                                      int32_t topicFilterLength,
+                                      const char * pcPayload,
+                                      size_t payloadLength,
+                                      uint8_t * pucBuffer,
+                                      size_t xBufferLength );
+
+/**
+ * @brief Decompress the payload of an incoming publish to a topic for which
+ * xIsCompressedTopic() is true.
+ *
+ * The payload is decompressed in one call of xPayloadDecompress(), an
+ * application that consumes the payload in parts can call it directly
+ * instead, with a smaller output buffer.
+ *
+ * Available when mqttexampleCOMPRESS_PAYLOADS is 1 in demo_config.h.
+ *
+ * @param[in] pxPublishInfo The incoming publish.
+ * @param[out] pucOutput The buffer for the payload.
+ * @param[in] xOutputLength The length of @p pucOutput.
+ * @param[out] pxPayloadLength The length of the payload.
+ *
+ * @return pdPASS if the whole payload was decompressed;
+ * pdFAIL if the payload is not valid or does not fit in @p pucOutput.
+ */
+BaseType_t xDecompressIncomingPublish( const MQTTPublishInfo_t * pxPublishInfo,
+                                       uint8_t * pucOutput,
+                                       size_t xOutputLength,
+                                       size_t * pxPayloadLength );
+
+/**
+ * @brief Called when a publish sent by xPublishToTopicPipelined() completes.
+ *
+ * @param[in] pvCallbackContext The context passed with the publish.
+ * @param[in] usPacketId The packet identifier of the publish.
+ * @param[in] xAcked pdTRUE when the broker acknowledged the publish; pdFALSE
+ * when it was dropped, because a clean session was started or because it was
+ * resent too often.
+ */
+typedef void (* PublishCompleteCallback_t )( void * pvCallbackContext,
+                                             uint16_t usPacketId,
+                                             BaseType_t xAcked );
+
+/**
+ * @brief Publish a QoS1 message without waiting for its PUBACK.
+ *
+ * Up to MAX_OUTGOING_PUBLISHES publishes are kept in flight.  When all are in
+ * flight, the process loop is run until a PUBACK frees one, for at most
+ * mqttexamplePROCESS_LOOP_TIMEOUT_MS.  PUBACKs are handled by xProcessLoop(),
+ * xWaitForOutgoingPublishes() and this function, in the order in which they
+ * arrive, and the callback of the publish is called from there.  The topic
+ * and payload must stay valid until the callback is called.
+ *
+ * @param[in] pxMqttContext The MQTT context for the MQTT connection.
+ * @param[in] pcTopicFilter Points to the topic.
+ * @param[in] topicFilterLength The length of the topic.
+ * @param[in] pcPayload Points to the payload.
+ * @param[in] payloadLength The length of the payload.
+ * @param[in] pxCallback Called when the publish completes, may be NULL.
+ * @param[in] pvCallbackContext Passed to pxCallback.
+ * @param[out] pusPacketId The packet identifier of the publish, may be NULL.
+ *
+ * @return pdPASS if PUBLISH was successfully sent;
+ * pdFAIL otherwise, in which case the callback is not called.
+ */
+BaseType_t xPublishToTopicPipelined( MQTTContext_t * pxMqttContext,
+                                     const char * pcTopicFilter,
+                                     int32_t topicFilterLength,
+                                     const char * pcPayload,
+                                     size_t payloadLength,
+                                     PublishCompleteCallback_t pxCallback,
+                                     void * pvCallbackContext,
+                                     uint16_t * pusPacketId );
+
+/**
+ * @brief Run the process loop until all outgoing publishes are acknowledged.
+ *
+ * @param[in] pxMqttContext The MQTT context for the MQTT connection.
+ * @param[in] ulTimeoutMs The longest time to wait.
+ *
+ * @return pdPASS if no publish is in flight anymore;
+ * pdFAIL otherwise.
+ */
+BaseType_t xWaitForOutgoingPublishes( MQTTContext_t * pxMqttContext,
+                                      uint32_t ulTimeoutMs );
+
+/**
+ * @brief The length of the buffer of a publish template for a topic of
+ * @p topicLength characters: the longest fixed header, the topic and a packet
+ * identifier.
+ */
+#define mqttexamplePUBLISH_TEMPLATE_BUFFER_LENGTH( topicLength )    ( 5U + 2U + ( topicLength ) + 2U )
+
+/**
+ * @brief A PUBLISH packet serialized once for a topic, see
+ * xInitPublishTemplate().
+ */
+typedef struct PublishTemplate
+{
+    uint8_t * pucBuffer;      /**< The fixed header, topic and packet identifier. */
+    const char * pcTopicName; /**< The topic, kept for resends. */
+    uint16_t usTopicLength;   /**< The length of pcTopicName. */
+    MQTTQoS_t xQoS;           /**< The QoS of the publishes. */
+    bool xRetain;             /**< The retain flag of the publishes. */
+} PublishTemplate_t;
+
+/**
+ * @brief Serialize the parts of a PUBLISH packet which are the same for every
+ * publish to a topic.
+ *
+ * The topic is serialized into @p pucBuffer once.  xPublishFromTemplate() then
+ * only writes the remaining length and the packet identifier around it, and
+ * sends the packet and the payload with one vectored write.
+ *
+ * @param[out] pxTemplate The template to initialize.
+ * @param[in] pucBuffer The buffer of the template, which must stay valid while
+ * the template is used.
+ * @param[in] xBufferLength The length of @p pucBuffer, at least
+ * mqttexamplePUBLISH_TEMPLATE_BUFFER_LENGTH( usTopicLength ).
+ * @param[in] pcTopicName The topic, which must stay valid while the template
+ * is used.
+ * @param[in] usTopicLength The length of the topic.
+ * @param[in] xQoS MQTTQoS0 or MQTTQoS1.
+ * @param[in] xRetain The retain flag of the publishes.
+ *
+ * @return pdPASS if the template was initialized;
+ * pdFAIL otherwise.
+ */
+BaseType_t xInitPublishTemplate( PublishTemplate_t * pxTemplate,
+                                 uint8_t * pucBuffer,
+                                 size_t xBufferLength,
+                                 const char * pcTopicName,
+                                 uint16_t usTopicLength,
+                                 MQTTQoS_t xQoS,
+                                 bool xRetain );
+
+/**
+ * @brief Publish a message to the topic of a template.
+ *
+ * A QoS1 publish is tracked and completed as with xPublishToTopicPipelined(),
+ * so the payload must stay valid until the callback is called.  A QoS0
+ * publish is complete when the function returns, and the callback is not
+ * used.
+ *
+ * @param[in] pxMqttContext The MQTT context for the MQTT connection.
+ * @param[in, out] pxTemplate The template initialized by xInitPublishTemplate().
+ * @param[in] pcPayload Points to the payload.
+ * @param[in] payloadLength The length of the payload.
+ * @param[in] pxCallback Called when a QoS1 publish completes, may be NULL.
+ * @param[in] pvCallbackContext Passed to pxCallback.
+ * @param[out] pusPacketId The packet identifier of a QoS1 publish, may be NULL.
+ *
+ * @return pdPASS if PUBLISH was successfully sent;
+ * pdFAIL otherwise, in which case the callback is not called.
+ */
+BaseType_t xPublishFromTemplate( MQTTContext_t * pxMqttContext,
+                                 PublishTemplate_t * pxTemplate,
+                                 const char * pcPayload,
+                                 size_t payloadLength,
+                                 PublishCompleteCallback_t pxCallback,
+                                 void * pvCallbackContext,
+                                 uint16_t * pusPacketId );
+
 /**
  * @brief Invoke the core MQTT library's process loop function.
  *
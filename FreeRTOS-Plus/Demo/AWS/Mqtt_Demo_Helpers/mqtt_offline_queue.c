@@ -0,0 +1,893 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file mqtt_offline_queue.c
+ *
+ * @brief A store-and-forward queue of MQTT publishes on a Reliance Edge
+ * volume, for devices which keep producing telemetry while the broker cannot
+ * be reached.
+ *
+ * The queue is a directory of segment files named after their sequence
+ * number, such as "0000002a.seg".  Records are appended to the newest segment
+ * and replayed from the oldest.  Each segment is preallocated with
+ * red_fallocate() when it is started, so it is laid out sequentially and the
+ * replay reads it back with few, large device reads.  The unused part of a
+ * preallocated segment reads as zeroes, which ends the records in it.
+ *
+ * Each record is a header of mqttofflineRECORD_HEADER_LENGTH bytes followed by
+ * the topic and the payload.  The header holds a marker byte, a reserved byte,
+ * the topic length in two bytes and the payload length in four bytes, all in
+ * little-endian order.
+ *
+ * The replay position is kept in a file named "cursor", which holds the
+ * segment and the offset of the next record to replay.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Offline queue include. */
+#include "mqtt_offline_queue.h"
+
+/* Demo specific config. */
+#include "demo_config.h"
+
+/*-----------------------------------------------------------*/
+
+#if ( REDCONF_READ_ONLY == 1 ) || ( REDCONF_API_POSIX_MKDIR == 0 ) || ( REDCONF_API_POSIX_UNLINK == 0 ) || ( REDCONF_API_POSIX_READDIR == 0 )
+    #error "The offline queue needs a writable volume with red_mkdir(), red_unlink() and red_readdir()."
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The first byte of every record, which tells a record from the zeroes
+ * of the unused part of a segment.
+ */
+#define mqttofflineRECORD_MARKER      ( 0xA5U )
+
+/**
+ * @brief The length of the name of a segment file, "0000002a.seg".
+ */
+#define mqttofflineSEGMENT_NAME_LENGTH    ( 12U )
+
+/**
+ * @brief The size of the buffer for the path of a file of the queue.
+ */
+#define mqttofflineFILE_PATH_LENGTH       ( mqttofflineMAX_PATH_LENGTH + 1U + mqttofflineSEGMENT_NAME_LENGTH )
+
+/**
+ * @brief The name of the file which holds the replay position.
+ */
+#define mqttofflineCURSOR_NAME            "cursor"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Build the path of a file of the queue.
+ *
+ * @param[in] pxQueue The queue.
+ * @param[in] pcName The name of the file, or NULL for the segment @p ulSegment.
+ * @param[in] ulSegment The number of the segment.
+ * @param[out] pcPath The buffer of mqttofflineFILE_PATH_LENGTH bytes for the path.
+ */
+static void prvMakePath( const OfflineQueue_t * pxQueue,
+                         const char * pcName,
+                         uint32_t ulSegment,
+                         char * pcPath );
+
+/**
+ * @brief Parse the name of a segment file.
+ *
+ * @param[in] pcName The name of a file in the queue directory.
+ * @param[out] pulSegment The number of the segment.
+ *
+ * @return pdTRUE if @p pcName is the name of a segment file;
+ * pdFALSE otherwise.
+ */
+static BaseType_t prvParseSegmentName( const char * pcName,
+                                       uint32_t * pulSegment );
+
+/**
+ * @brief Find the oldest and the newest segment in the queue directory.
+ *
+ * @param[in, out] pxQueue The queue, whose ulFirstSegment and ulWriteSegment
+ * are set.
+ *
+ * @return pdTRUE if any segment was found;
+ * pdFALSE otherwise.
+ */
+static BaseType_t prvFindSegments( OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Find the end of the records in the newest segment, and open it for
+ * appending.
+ *
+ * @param[in, out] pxQueue The queue.
+ *
+ * @return pdPASS if the segment was opened;
+ * pdFAIL otherwise.
+ */
+static BaseType_t prvOpenWriteSegment( OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Start a new segment after the current one, discarding the oldest
+ * segment if the queue is full.
+ *
+ * @param[in, out] pxQueue The queue.
+ *
+ * @return pdPASS if the segment was started;
+ * pdFAIL otherwise.
+ */
+static BaseType_t prvStartSegment( OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Delete the oldest segment, and replay from the start of the next one.
+ *
+ * @param[in, out] pxQueue The queue, which holds more than one segment.
+ *
+ * @return pdPASS if the segment was deleted;
+ * pdFAIL otherwise.
+ */
+static BaseType_t prvDeleteFirstSegment( OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Load the replay position saved by prvSaveCursor().
+ *
+ * @param[in, out] pxQueue The queue, whose ulReadOffset is set.
+ */
+static void prvLoadCursor( OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Save the replay position.
+ *
+ * @param[in] pxQueue The queue.
+ *
+ * @return pdPASS if the position was saved;
+ * pdFAIL otherwise.
+ */
+static BaseType_t prvSaveCursor( const OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Called when a replayed publish completes.
+ *
+ * @param[in] pvCallbackContext The queue.
+ * @param[in] usPacketId The packet identifier of the publish.
+ * @param[in] xAcked Whether the broker acknowledged the publish.
+ */
+static void prvReplayComplete( void * pvCallbackContext,
+                               uint16_t usPacketId,
+                               BaseType_t xAcked );
+
+/**
+ * @brief Serialize a record header.
+ */
+static void prvEncodeHeader( uint8_t * pucHeader,
+                             uint16_t usTopicLength,
+                             uint32_t ulPayloadLength );
+
+/**
+ * @brief Parse a record header.
+ *
+ * @return The length of the whole record, or zero if @p pucHeader is not the
+ * header of a record.
+ */
+static uint32_t prvDecodeHeader( const uint8_t * pucHeader,
+                                 uint16_t * pusTopicLength,
+                                 uint32_t * pulPayloadLength );
+
+/*-----------------------------------------------------------*/
+
+static void prvMakePath( const OfflineQueue_t * pxQueue,
+                         const char * pcName,
+                         uint32_t ulSegment,
+                         char * pcPath )
+{
+    static const char cHexDigits[] = "0123456789abcdef";
+    size_t xLength = strlen( pxQueue->cDirectory );
+    uint32_t ulDigit;
+
+    ( void ) memcpy( pcPath, pxQueue->cDirectory, xLength );
+    pcPath[ xLength ] = '/';
+    xLength++;
+
+    if( pcName != NULL )
+    {
+        ( void ) strcpy( &pcPath[ xLength ], pcName );
+    }
+    else
+    {
+        for( ulDigit = 0U; ulDigit < 8U; ulDigit++ )
+        {
+            pcPath[ xLength + ulDigit ] = cHexDigits[ ( ulSegment >> ( 28U - ( ulDigit * 4U ) ) ) & 0xFU ];
+        }
+
+        ( void ) strcpy( &pcPath[ xLength + 8U ], ".seg" );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseSegmentName( const char * pcName,
+                                       uint32_t * pulSegment )
+{
+    BaseType_t xIsSegment = pdFALSE;
+    uint32_t ulSegment = 0U;
+    uint32_t ulDigit;
+
+    if( ( strlen( pcName ) == mqttofflineSEGMENT_NAME_LENGTH ) && ( strcmp( &pcName[ 8 ], ".seg" ) == 0 ) )
+    {
+        xIsSegment = pdTRUE;
+
+        for( ulDigit = 0U; ( ulDigit < 8U ) && ( xIsSegment == pdTRUE ); ulDigit++ )
+        {
+            char cDigit = pcName[ ulDigit ];
+
+            if( ( cDigit >= '0' ) && ( cDigit <= '9' ) )
+            {
+                ulSegment = ( ulSegment << 4 ) | ( uint32_t ) ( cDigit - '0' );
+            }
+            else if( ( cDigit >= 'a' ) && ( cDigit <= 'f' ) )
+            {
+                ulSegment = ( ulSegment << 4 ) | ( uint32_t ) ( cDigit - 'a' + 10 );
+            }
+            else
+            {
+                xIsSegment = pdFALSE;
+            }
+        }
+    }
+
+    *pulSegment = ulSegment;
+
+    return xIsSegment;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvFindSegments( OfflineQueue_t * pxQueue )
+{
+    BaseType_t xFound = pdFALSE;
+    REDDIR * pxDir;
+    REDDIRENT * pxEntry;
+    uint32_t ulSegment;
+
+    pxDir = red_opendir( pxQueue->cDirectory );
+
+    if( pxDir != NULL )
+    {
+        for( pxEntry = red_readdir( pxDir ); pxEntry != NULL; pxEntry = red_readdir( pxDir ) )
+        {
+            if( prvParseSegmentName( pxEntry->d_name, &ulSegment ) == pdTRUE )
+            {
+                if( ( xFound == pdFALSE ) || ( ulSegment < pxQueue->ulFirstSegment ) )
+                {
+                    pxQueue->ulFirstSegment = ulSegment;
+                }
+
+                if( ( xFound == pdFALSE ) || ( ulSegment > pxQueue->ulWriteSegment ) )
+                {
+                    pxQueue->ulWriteSegment = ulSegment;
+                }
+
+                xFound = pdTRUE;
+            }
+        }
+
+        ( void ) red_closedir( pxDir );
+    }
+
+    return xFound;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvOpenWriteSegment( OfflineQueue_t * pxQueue )
+{
+    BaseType_t xReturnStatus = pdPASS;
+    char cPath[ mqttofflineFILE_PATH_LENGTH ];
+    uint8_t ucHeader[ mqttofflineRECORD_HEADER_LENGTH ];
+    uint16_t usTopicLength;
+    uint32_t ulPayloadLength;
+    uint32_t ulRecordLength = 1U;
+
+    prvMakePath( pxQueue, NULL, pxQueue->ulWriteSegment, cPath );
+    pxQueue->lWriteFile = red_open( cPath, RED_O_RDWR );
+
+    if( pxQueue->lWriteFile < 0 )
+    {
+        LogError( ( "Failed to open the queue segment %s, error %d.", cPath, ( int ) red_errno ) );
+        xReturnStatus = pdFAIL;
+    }
+    else
+    {
+        /* The records end at the first header which is missing or zeroed. */
+        pxQueue->ulWriteOffset = 0U;
+
+        while( ( ulRecordLength != 0U ) &&
+               ( ( pxQueue->ulWriteOffset + mqttofflineRECORD_HEADER_LENGTH ) <= mqttofflineSEGMENT_SIZE ) )
+        {
+            ulRecordLength = 0U;
+
+            if( ( red_lseek( pxQueue->lWriteFile, ( int64_t ) pxQueue->ulWriteOffset, RED_SEEK_SET ) >= 0 ) &&
+                ( red_read( pxQueue->lWriteFile, ucHeader, sizeof( ucHeader ) ) == ( int32_t ) sizeof( ucHeader ) ) )
+            {
+                ulRecordLength = prvDecodeHeader( ucHeader, &usTopicLength, &ulPayloadLength );
+
+                if( ( pxQueue->ulWriteOffset + ulRecordLength ) > mqttofflineSEGMENT_SIZE )
+                {
+                    ulRecordLength = 0U;
+                }
+
+                pxQueue->ulWriteOffset += ulRecordLength;
+            }
+        }
+
+        if( red_lseek( pxQueue->lWriteFile, ( int64_t ) pxQueue->ulWriteOffset, RED_SEEK_SET ) < 0 )
+        {
+            xReturnStatus = pdFAIL;
+        }
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStartSegment( OfflineQueue_t * pxQueue )
+{
+    BaseType_t xReturnStatus = pdPASS;
+    char cPath[ mqttofflineFILE_PATH_LENGTH ];
+
+    if( pxQueue->lWriteFile >= 0 )
+    {
+        ( void ) red_close( pxQueue->lWriteFile );
+        pxQueue->lWriteFile = -1;
+        pxQueue->ulWriteSegment++;
+    }
+
+    /* Keep at most mqttofflineMAX_SEGMENTS segments: the oldest telemetry is
+     * the least useful. */
+    if( ( pxQueue->ulWriteSegment - pxQueue->ulFirstSegment ) >= mqttofflineMAX_SEGMENTS )
+    {
+        LogWarn( ( "The offline queue is full, discarding segment %lu.",
+                   ( unsigned long ) pxQueue->ulFirstSegment ) );
+        pxQueue->ulSegmentsDropped++;
+        xReturnStatus = prvDeleteFirstSegment( pxQueue );
+    }
+
+    if( xReturnStatus == pdPASS )
+    {
+        prvMakePath( pxQueue, NULL, pxQueue->ulWriteSegment, cPath );
+        pxQueue->lWriteFile = red_open( cPath, RED_O_RDWR | RED_O_CREAT | RED_O_TRUNC );
+        pxQueue->ulWriteOffset = 0U;
+
+        if( pxQueue->lWriteFile < 0 )
+        {
+            LogError( ( "Failed to create the queue segment %s, error %d.", cPath, ( int ) red_errno ) );
+            xReturnStatus = pdFAIL;
+        }
+
+        #if REDCONF_API_POSIX_FALLOCATE == 1
+            else if( red_fallocate( pxQueue->lWriteFile, 0U, mqttofflineSEGMENT_SIZE ) != 0 )
+            {
+                /* The segment still works, it is only not laid out in one
+                 * piece. */
+                LogWarn( ( "Failed to preallocate the queue segment %s, error %d.", cPath, ( int ) red_errno ) );
+            }
+        #endif
+        else
+        {
+            /* Nothing to do. */
+        }
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDeleteFirstSegment( OfflineQueue_t * pxQueue )
+{
+    BaseType_t xReturnStatus = pdPASS;
+    char cPath[ mqttofflineFILE_PATH_LENGTH ];
+
+    configASSERT( pxQueue->ulFirstSegment != pxQueue->ulWriteSegment );
+
+    if( pxQueue->lReadFile >= 0 )
+    {
+        ( void ) red_close( pxQueue->lReadFile );
+        pxQueue->lReadFile = -1;
+    }
+
+    prvMakePath( pxQueue, NULL, pxQueue->ulFirstSegment, cPath );
+
+    if( ( red_unlink( cPath ) != 0 ) && ( red_errno != RED_ENOENT ) )
+    {
+        LogError( ( "Failed to delete the queue segment %s, error %d.", cPath, ( int ) red_errno ) );
+        xReturnStatus = pdFAIL;
+    }
+    else
+    {
+        /* A cursor which names a deleted segment means the start of the next
+         * one, so the segment is deleted before the cursor is saved. */
+        pxQueue->ulFirstSegment++;
+        pxQueue->ulReadOffset = 0U;
+        ( void ) prvSaveCursor( pxQueue );
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvLoadCursor( OfflineQueue_t * pxQueue )
+{
+    char cPath[ mqttofflineFILE_PATH_LENGTH ];
+    uint32_t ulCursor[ 2 ];
+    int32_t lFile;
+
+    pxQueue->ulReadOffset = 0U;
+
+    prvMakePath( pxQueue, mqttofflineCURSOR_NAME, 0U, cPath );
+    lFile = red_open( cPath, RED_O_RDONLY );
+
+    if( lFile >= 0 )
+    {
+        if( ( red_read( lFile, ulCursor, sizeof( ulCursor ) ) == ( int32_t ) sizeof( ulCursor ) ) &&
+            ( ulCursor[ 0 ] == pxQueue->ulFirstSegment ) &&
+            ( ulCursor[ 1 ] <= mqttofflineSEGMENT_SIZE ) )
+        {
+            pxQueue->ulReadOffset = ulCursor[ 1 ];
+        }
+
+        ( void ) red_close( lFile );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSaveCursor( const OfflineQueue_t * pxQueue )
+{
+    BaseType_t xReturnStatus = pdFAIL;
+    char cPath[ mqttofflineFILE_PATH_LENGTH ];
+    uint32_t ulCursor[ 2 ];
+    int32_t lFile;
+
+    ulCursor[ 0 ] = pxQueue->ulFirstSegment;
+    ulCursor[ 1 ] = pxQueue->ulReadOffset;
+
+    prvMakePath( pxQueue, mqttofflineCURSOR_NAME, 0U, cPath );
+    lFile = red_open( cPath, RED_O_WRONLY | RED_O_CREAT );
+
+    if( lFile >= 0 )
+    {
+        if( red_write( lFile, ulCursor, sizeof( ulCursor ) ) == ( int32_t ) sizeof( ulCursor ) )
+        {
+            xReturnStatus = pdPASS;
+        }
+
+        ( void ) red_close( lFile );
+    }
+
+    if( xReturnStatus != pdPASS )
+    {
+        LogError( ( "Failed to save the offline queue cursor, error %d.", ( int ) red_errno ) );
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReplayComplete( void * pvCallbackContext,
+                               uint16_t usPacketId,
+                               BaseType_t xAcked )
+{
+    OfflineQueue_t * pxQueue = ( OfflineQueue_t * ) pvCallbackContext;
+
+    ( void ) usPacketId;
+
+    if( xAcked == pdTRUE )
+    {
+        pxQueue->ulBatchAcked++;
+    }
+    else
+    {
+        pxQueue->ulBatchDropped++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvEncodeHeader( uint8_t * pucHeader,
+                             uint16_t usTopicLength,
+                             uint32_t ulPayloadLength )
+{
+    pucHeader[ 0 ] = mqttofflineRECORD_MARKER;
+    pucHeader[ 1 ] = 0U;
+    pucHeader[ 2 ] = ( uint8_t ) usTopicLength;
+    pucHeader[ 3 ] = ( uint8_t ) ( usTopicLength >> 8 );
+    pucHeader[ 4 ] = ( uint8_t ) ulPayloadLength;
+    pucHeader[ 5 ] = ( uint8_t ) ( ulPayloadLength >> 8 );
+    pucHeader[ 6 ] = ( uint8_t ) ( ulPayloadLength >> 16 );
+    pucHeader[ 7 ] = ( uint8_t ) ( ulPayloadLength >> 24 );
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvDecodeHeader( const uint8_t * pucHeader,
+                                 uint16_t * pusTopicLength,
+                                 uint32_t * pulPayloadLength )
+{
+    uint32_t ulRecordLength = 0U;
+
+    *pusTopicLength = ( uint16_t ) ( pucHeader[ 2 ] | ( ( uint16_t ) pucHeader[ 3 ] << 8 ) );
+    *pulPayloadLength = ( uint32_t ) pucHeader[ 4 ] |
+                        ( ( uint32_t ) pucHeader[ 5 ] << 8 ) |
+                        ( ( uint32_t ) pucHeader[ 6 ] << 16 ) |
+                        ( ( uint32_t ) pucHeader[ 7 ] << 24 );
+
+    if( ( pucHeader[ 0 ] == mqttofflineRECORD_MARKER ) &&
+        ( *pusTopicLength > 0U ) &&
+        ( *pulPayloadLength <= mqttofflineSEGMENT_SIZE ) )
+    {
+        ulRecordLength = mqttofflineRECORD_HEADER_LENGTH + *pusTopicLength + *pulPayloadLength;
+    }
+
+    return ulRecordLength;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xOfflineQueueInit( OfflineQueue_t * pxQueue,
+                              const char * pcDirectory )
+{
+    BaseType_t xReturnStatus = pdPASS;
+
+    configASSERT( pxQueue != NULL );
+    configASSERT( pcDirectory != NULL );
+
+    ( void ) memset( pxQueue, 0, sizeof( *pxQueue ) );
+    pxQueue->lWriteFile = -1;
+    pxQueue->lReadFile = -1;
+
+    if( strlen( pcDirectory ) >= sizeof( pxQueue->cDirectory ) )
+    {
+        LogError( ( "The offline queue path %s is too long.", pcDirectory ) );
+        xReturnStatus = pdFAIL;
+    }
+    else
+    {
+        ( void ) strcpy( pxQueue->cDirectory, pcDirectory );
+
+        if( ( red_mkdir( pcDirectory ) != 0 ) && ( red_errno != RED_EEXIST ) )
+        {
+            LogError( ( "Failed to create the offline queue directory %s, error %d.", pcDirectory, ( int ) red_errno ) );
+            xReturnStatus = pdFAIL;
+        }
+    }
+
+    if( xReturnStatus == pdPASS )
+    {
+        if( prvFindSegments( pxQueue ) == pdTRUE )
+        {
+            prvLoadCursor( pxQueue );
+            xReturnStatus = prvOpenWriteSegment( pxQueue );
+
+            if( ( pxQueue->ulFirstSegment == pxQueue->ulWriteSegment ) &&
+                ( pxQueue->ulReadOffset > pxQueue->ulWriteOffset ) )
+            {
+                pxQueue->ulReadOffset = pxQueue->ulWriteOffset;
+            }
+        }
+        else
+        {
+            xReturnStatus = prvStartSegment( pxQueue );
+        }
+    }
+
+    if( xReturnStatus == pdPASS )
+    {
+        LogInfo( ( "Offline queue %s holds segments %lu to %lu.",
+                   pcDirectory,
+                   ( unsigned long ) pxQueue->ulFirstSegment,
+                   ( unsigned long ) pxQueue->ulWriteSegment ) );
+    }
+    else
+    {
+        vOfflineQueueDeinit( pxQueue );
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+void vOfflineQueueDeinit( OfflineQueue_t * pxQueue )
+{
+    configASSERT( pxQueue != NULL );
+
+    if( pxQueue->lReadFile >= 0 )
+    {
+        ( void ) red_close( pxQueue->lReadFile );
+        pxQueue->lReadFile = -1;
+    }
+
+    if( pxQueue->lWriteFile >= 0 )
+    {
+        ( void ) red_close( pxQueue->lWriteFile );
+        pxQueue->lWriteFile = -1;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xOfflineQueueAppend( OfflineQueue_t * pxQueue,
+                                const char * pcTopicName,
+                                uint16_t usTopicLength,
+                                const void * pvPayload,
+                                uint32_t ulPayloadLength )
+{
+    BaseType_t xReturnStatus = pdPASS;
+    uint8_t ucHeader[ mqttofflineRECORD_HEADER_LENGTH ];
+    uint32_t ulRecordLength;
+    uint32_t ulRecordOffset;
+
+    configASSERT( pxQueue != NULL );
+    configASSERT( pcTopicName != NULL );
+    configASSERT( usTopicLength > 0U );
+    configASSERT( ( pvPayload != NULL ) || ( ulPayloadLength == 0U ) );
+
+    ulRecordLength = mqttofflineRECORD_HEADER_LENGTH + usTopicLength + ulPayloadLength;
+
+    if( ( ulPayloadLength > mqttofflineSEGMENT_SIZE ) || ( ulRecordLength > mqttofflineSEGMENT_SIZE ) )
+    {
+        LogError( ( "A record of %lu bytes does not fit in a queue segment.", ( unsigned long ) ulRecordLength ) );
+        xReturnStatus = pdFAIL;
+    }
+    else if( ( pxQueue->lWriteFile < 0 ) || ( ( pxQueue->ulWriteOffset + ulRecordLength ) > mqttofflineSEGMENT_SIZE ) )
+    {
+        xReturnStatus = prvStartSegment( pxQueue );
+    }
+    else
+    {
+        /* The open segment has room. */
+    }
+
+    if( xReturnStatus == pdPASS )
+    {
+        ulRecordOffset = pxQueue->ulWriteOffset;
+
+        /* Write the topic and the payload first and then the header, so that
+         * a transaction point in between leaves a zeroed header, which ends
+         * the records of the segment. */
+        if( ( red_lseek( pxQueue->lWriteFile, ( int64_t ) ( ulRecordOffset + mqttofflineRECORD_HEADER_LENGTH ), RED_SEEK_SET ) < 0 ) ||
+            ( red_write( pxQueue->lWriteFile, pcTopicName, usTopicLength ) != ( int32_t ) usTopicLength ) ||
+            ( ( ulPayloadLength > 0U ) &&
+              ( red_write( pxQueue->lWriteFile, pvPayload, ulPayloadLength ) != ( int32_t ) ulPayloadLength ) ) )
+        {
+            xReturnStatus = pdFAIL;
+        }
+        else
+        {
+            prvEncodeHeader( ucHeader, usTopicLength, ulPayloadLength );
+
+            if( ( red_lseek( pxQueue->lWriteFile, ( int64_t ) ulRecordOffset, RED_SEEK_SET ) < 0 ) ||
+                ( red_write( pxQueue->lWriteFile, ucHeader, sizeof( ucHeader ) ) != ( int32_t ) sizeof( ucHeader ) ) )
+            {
+                xReturnStatus = pdFAIL;
+            }
+        }
+
+        if( xReturnStatus == pdPASS )
+        {
+            pxQueue->ulWriteOffset += ulRecordLength;
+            pxQueue->ulAppended++;
+        }
+        else
+        {
+            LogError( ( "Failed to append to the offline queue, error %d.", ( int ) red_errno ) );
+        }
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xOfflineQueueFlush( OfflineQueue_t * pxQueue )
+{
+    BaseType_t xReturnStatus = pdPASS;
+
+    configASSERT( pxQueue != NULL );
+
+    if( ( pxQueue->lWriteFile >= 0 ) && ( red_fsync( pxQueue->lWriteFile ) != 0 ) )
+    {
+        LogError( ( "Failed to commit the offline queue, error %d.", ( int ) red_errno ) );
+        xReturnStatus = pdFAIL;
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xOfflineQueueReplay( OfflineQueue_t * pxQueue,
+                                MQTTContext_t * pxMqttContext,
+                                uint8_t * pucBuffer,
+                                uint32_t ulBufferLength,
+                                uint32_t ulTimeoutMs )
+{
+    BaseType_t xReturnStatus = pdPASS;
+    char cPath[ mqttofflineFILE_PATH_LENGTH ];
+    uint32_t ulLimit;
+    uint32_t ulLength;
+    uint32_t ulOffset;
+    uint32_t ulRecordLength;
+    uint32_t ulPublishes;
+    uint32_t ulPayloadLength;
+    uint16_t usTopicLength;
+    int32_t lRead;
+    BaseType_t xSegmentEnds;
+
+    configASSERT( pxQueue != NULL );
+    configASSERT( pxMqttContext != NULL );
+    configASSERT( pucBuffer != NULL );
+    configASSERT( ulBufferLength >= mqttofflineRECORD_HEADER_LENGTH );
+
+    while( ( xReturnStatus == pdPASS ) && ( xOfflineQueueIsEmpty( pxQueue ) == pdFALSE ) )
+    {
+        /* The newest segment ends where the appended records end. */
+        ulLimit = ( pxQueue->ulFirstSegment == pxQueue->ulWriteSegment ) ? pxQueue->ulWriteOffset : mqttofflineSEGMENT_SIZE;
+        ulLength = configMIN( ulBufferLength, ulLimit - pxQueue->ulReadOffset );
+        lRead = 0;
+
+        if( pxQueue->lReadFile < 0 )
+        {
+            prvMakePath( pxQueue, NULL, pxQueue->ulFirstSegment, cPath );
+            pxQueue->lReadFile = red_open( cPath, RED_O_RDONLY );
+        }
+
+        /* One large sequential read per batch, which reads the preallocated
+         * segment with few device requests. */
+        if( ( pxQueue->lReadFile < 0 ) ||
+            ( red_lseek( pxQueue->lReadFile, ( int64_t ) pxQueue->ulReadOffset, RED_SEEK_SET ) < 0 ) ||
+            ( ( lRead = red_read( pxQueue->lReadFile, pucBuffer, ulLength ) ) < 0 ) )
+        {
+            LogError( ( "Failed to read the offline queue, error %d.", ( int ) red_errno ) );
+            xReturnStatus = pdFAIL;
+            break;
+        }
+
+        ulLength = ( uint32_t ) lRead;
+        ulOffset = 0U;
+        ulPublishes = 0U;
+        xSegmentEnds = ( ulLength < mqttofflineRECORD_HEADER_LENGTH ) ? pdTRUE : pdFALSE;
+        pxQueue->ulBatchAcked = 0U;
+        pxQueue->ulBatchDropped = 0U;
+
+        while( ( xReturnStatus == pdPASS ) && ( ( ulOffset + mqttofflineRECORD_HEADER_LENGTH ) <= ulLength ) )
+        {
+            ulRecordLength = prvDecodeHeader( &pucBuffer[ ulOffset ], &usTopicLength, &ulPayloadLength );
+
+            if( ( ulRecordLength == 0U ) || ( ( pxQueue->ulReadOffset + ulOffset + ulRecordLength ) > ulLimit ) )
+            {
+                xSegmentEnds = pdTRUE;
+                break;
+            }
+
+            if( ( ulOffset + ulRecordLength ) > ulLength )
+            {
+                if( ulOffset == 0U )
+                {
+                    LogWarn( ( "Skipping a queued record of %lu bytes, which is larger than the replay buffer.",
+                               ( unsigned long ) ulRecordLength ) );
+                    pxQueue->ulRecordsSkipped++;
+                    ulOffset = ulRecordLength;
+                }
+
+                break;
+            }
+
+            xReturnStatus = xPublishToTopicPipelined( pxMqttContext,
+                                                      ( const char * ) &pucBuffer[ ulOffset + mqttofflineRECORD_HEADER_LENGTH ],
+                                                      ( int32_t ) usTopicLength,
+                                                      ( const char * ) &pucBuffer[ ulOffset + mqttofflineRECORD_HEADER_LENGTH + usTopicLength ],
+                                                      ulPayloadLength,
+                                                      prvReplayComplete,
+                                                      pxQueue,
+                                                      NULL );
+
+            if( xReturnStatus == pdPASS )
+            {
+                ulPublishes++;
+                ulOffset += ulRecordLength;
+            }
+        }
+
+        if( ulPublishes > 0U )
+        {
+            /* The batch leaves the queue only when every publish of it was
+             * acknowledged, otherwise it is replayed again. */
+            if( ( xWaitForOutgoingPublishes( pxMqttContext, ulTimeoutMs ) != pdPASS ) ||
+                ( pxQueue->ulBatchAcked != ulPublishes ) )
+            {
+                xReturnStatus = pdFAIL;
+            }
+        }
+
+        if( xReturnStatus == pdPASS )
+        {
+            pxQueue->ulReadOffset += ulOffset;
+            pxQueue->ulReplayed += ulPublishes;
+
+            if( ( xSegmentEnds == pdTRUE ) && ( pxQueue->ulFirstSegment != pxQueue->ulWriteSegment ) )
+            {
+                xReturnStatus = prvDeleteFirstSegment( pxQueue );
+            }
+            else if( ( xSegmentEnds == pdTRUE ) && ( ulOffset == 0U ) )
+            {
+                /* The newest segment holds a damaged record: everything
+                 * before it was replayed. */
+                LogWarn( ( "The offline queue ends with a damaged record." ) );
+                pxQueue->ulReadOffset = pxQueue->ulWriteOffset;
+                ( void ) prvSaveCursor( pxQueue );
+            }
+            else if( ulOffset > 0U )
+            {
+                ( void ) prvSaveCursor( pxQueue );
+            }
+            else
+            {
+                /* Nothing was read. */
+            }
+        }
+    }
+
+    if( xReturnStatus != pdPASS )
+    {
+        LogWarn( ( "Replay of the offline queue stopped, %lu publishes of the batch were not acknowledged.",
+                   ( unsigned long ) ( pxQueue->ulBatchDropped ) ) );
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xOfflineQueueIsEmpty( const OfflineQueue_t * pxQueue )
+{
+    configASSERT( pxQueue != NULL );
+
+    return ( ( pxQueue->ulFirstSegment == pxQueue->ulWriteSegment ) &&
+             ( pxQueue->ulReadOffset >= pxQueue->ulWriteOffset ) ) ? pdTRUE : pdFALSE;
+}
@@ -0,0 +1,196 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef MQTT_OFFLINE_QUEUE_H
+#define MQTT_OFFLINE_QUEUE_H
+
+/* MQTT demo helpers, used to replay the queued publishes. */
+#include "mqtt_demo_helpers.h"
+
+/* Reliance Edge POSIX-like API. */
+#include <redposix.h>
+
+/**
+ * @brief The size, in bytes, of a segment file of the queue.
+ *
+ * A segment is preallocated in one piece when it is started, so that it is
+ * written and read back sequentially.  A record must fit in one segment.
+ */
+#ifndef mqttofflineSEGMENT_SIZE
+    #define mqttofflineSEGMENT_SIZE       ( 65536UL )
+#endif
+
+/**
+ * @brief The most segments kept.  When a new segment would exceed this, the
+ * oldest segment is discarded with the records it still holds.
+ */
+#ifndef mqttofflineMAX_SEGMENTS
+    #define mqttofflineMAX_SEGMENTS       ( 16UL )
+#endif
+
+/**
+ * @brief The size of the buffer for the path of the queue directory, including
+ * the null terminator.
+ */
+#ifndef mqttofflineMAX_PATH_LENGTH
+    #define mqttofflineMAX_PATH_LENGTH    ( 48U )
+#endif
+
+#if mqttofflineMAX_SEGMENTS < 2UL
+    #error "mqttofflineMAX_SEGMENTS must be at least 2."
+#endif
+
+/**
+ * @brief The length of the header in front of each record in a segment.
+ */
+#define mqttofflineRECORD_HEADER_LENGTH    ( 8U )
+
+/**
+ * @brief A queue of publishes kept on a Reliance Edge volume while the broker
+ * cannot be reached, see xOfflineQueueInit().
+ *
+ * The members are private to mqtt_offline_queue.c, except for the counters.
+ */
+typedef struct OfflineQueue
+{
+    char cDirectory[ mqttofflineMAX_PATH_LENGTH ]; /**< The directory of the segment files. */
+    uint32_t ulFirstSegment;                       /**< The oldest segment, which is being replayed. */
+    uint32_t ulReadOffset;                         /**< The offset of the next record to replay in ulFirstSegment. */
+    uint32_t ulWriteSegment;                       /**< The newest segment, which is being appended to. */
+    uint32_t ulWriteOffset;                        /**< The end of the records in ulWriteSegment. */
+    int32_t lWriteFile;                            /**< The file descriptor of ulWriteSegment, or -1. */
+    int32_t lReadFile;                             /**< The file descriptor of ulFirstSegment, or -1. */
+    uint32_t ulBatchAcked;                         /**< The publishes of the current batch acknowledged by the broker. */
+    uint32_t ulBatchDropped;                       /**< The publishes of the current batch which were dropped. */
+    uint32_t ulAppended;                           /**< The records appended since xOfflineQueueInit(). */
+    uint32_t ulReplayed;                           /**< The records replayed and acknowledged since xOfflineQueueInit(). */
+    uint32_t ulSegmentsDropped;                    /**< The segments discarded because the queue was full. */
+    uint32_t ulRecordsSkipped;                     /**< The records too large for the replay buffer, which were skipped. */
+} OfflineQueue_t;
+
+/**
+ * @brief Open the queue kept in a directory of a mounted Reliance Edge volume,
+ * creating the directory if needed.
+ *
+ * The queue is a log of segment files which are appended to in order.  The
+ * progress of the replay is kept in a cursor file in the same directory, so
+ * the records which remain after a reset are replayed when the broker can be
+ * reached again.  A record may be replayed twice if the device is reset
+ * after the broker acknowledged it but before the cursor was saved.
+ *
+ * The functions of a queue must not be called by more than one task at a
+ * time.
+ *
+ * @param[out] pxQueue The queue to initialize.
+ * @param[in] pcDirectory The path of the directory, such as "/telemetry".
+ *
+ * @return pdPASS if the queue was opened;
+ * pdFAIL otherwise.
+ */
+BaseType_t xOfflineQueueInit( OfflineQueue_t * pxQueue,
+                              const char * pcDirectory );
+
+/**
+ * @brief Close the files of a queue.  The records which are not replayed yet
+ * are kept for the next xOfflineQueueInit().
+ *
+ * @param[in, out] pxQueue The queue to close.
+ */
+void vOfflineQueueDeinit( OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Append a publish to the queue.
+ *
+ * The record is written to the open segment and is durable at the next
+ * transaction point of the volume, such as one made by xOfflineQueueFlush().
+ * The header of a record is written after its topic and payload, so an
+ * automatic transaction never commits half a record.
+ *
+ * @param[in, out] pxQueue The queue.
+ * @param[in] pcTopicName The topic of the publish.
+ * @param[in] usTopicLength The length of the topic.
+ * @param[in] pvPayload The payload of the publish.
+ * @param[in] ulPayloadLength The length of the payload.
+ *
+ * @return pdPASS if the record was appended;
+ * pdFAIL otherwise.
+ */
+BaseType_t xOfflineQueueAppend( OfflineQueue_t * pxQueue,
+                                const char * pcTopicName,
+                                uint16_t usTopicLength,
+                                const void * pvPayload,
+                                uint32_t ulPayloadLength );
+
+/**
+ * @brief Commit the appended records to the volume.
+ *
+ * @param[in] pxQueue The queue.
+ *
+ * @return pdPASS if the records were committed;
+ * pdFAIL otherwise.
+ */
+BaseType_t xOfflineQueueFlush( OfflineQueue_t * pxQueue );
+
+/**
+ * @brief Publish the queued records with QoS1, in the order in which they were
+ * appended, until the queue is empty.
+ *
+ * Each batch is read from the segment with one red_read() into @p pucBuffer,
+ * all complete records in it are sent with xPublishToTopicPipelined(), and
+ * then the PUBACKs are awaited with xWaitForOutgoingPublishes().  Only then is
+ * the batch removed from the queue.  Segments which are fully replayed are
+ * deleted.  A record larger than @p pucBuffer cannot be replayed and is
+ * skipped.
+ *
+ * @param[in, out] pxQueue The queue.
+ * @param[in] pxMqttContext The MQTT context for the MQTT connection.
+ * @param[in] pucBuffer The buffer for a batch.  If the function fails, the
+ * PUBLISH messages which are still in flight refer to it, so it must not be
+ * reused until they complete or the session ends.
+ * @param[in] ulBufferLength The length of @p pucBuffer.
+ * @param[in] ulTimeoutMs The longest time to wait for the PUBACKs of a batch.
+ *
+ * @return pdPASS if the queue is empty;
+ * pdFAIL if a publish failed or was not acknowledged, in which case the
+ * current batch stays in the queue.
+ */
+BaseType_t xOfflineQueueReplay( OfflineQueue_t * pxQueue,
+                                MQTTContext_t * pxMqttContext,
+                                uint8_t * pucBuffer,
+                                uint32_t ulBufferLength,
+                                uint32_t ulTimeoutMs );
+
+/**
+ * @brief Whether the queue holds records which are not replayed yet.
+ *
+ * @param[in] pxQueue The queue.
+ *
+ * @return pdTRUE if the queue is empty;
+ * pdFALSE otherwise.
+ */
+BaseType_t xOfflineQueueIsEmpty( const OfflineQueue_t * pxQueue );
+
+#endif /* ifndef MQTT_OFFLINE_QUEUE_H */
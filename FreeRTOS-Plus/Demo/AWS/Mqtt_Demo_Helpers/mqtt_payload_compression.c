@@ -0,0 +1,600 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file mqtt_payload_compression.c
+ *
+ * @brief A small LZSS codec for MQTT payloads, for links on which every byte
+ * counts, such as metered cellular links.
+ *
+ * The compressor works on a payload which is in RAM anyway, so besides it
+ * only needs a PayloadCompressor_t, 1 KB with the default configuration.
+ * Matches are found through a hash of the next three bytes and a chain of the
+ * earlier positions with the same hash, limited to mqttcompressMAX_CHAIN.  The
+ * decompressor is streaming and needs a PayloadDecompressor_t, which is
+ * dominated by its window of mqttcompressWINDOW_SIZE bytes.
+ *
+ * The bits of the stream are written from the most significant bit of each
+ * byte.  A literal is a 1 bit followed by the byte.  A match is a 0 bit
+ * followed by the distance minus one in mqttcompressWINDOW_BITS bits and the
+ * length minus mqttcompressMIN_MATCH in mqttcompressLENGTH_BITS bits.  The
+ * stream ends when the length given in the header has been output, the
+ * remaining bits of the last byte are zero.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+
+/* Payload compression include. */
+#include "mqtt_payload_compression.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The shortest match that is encoded, shorter ones are sent as
+ * literals.
+ */
+#define mqttcompressMIN_MATCH          ( 3U )
+
+/**
+ * @brief The longest match that is encoded.
+ */
+#define mqttcompressMAX_MATCH          ( mqttcompressMIN_MATCH + ( 1U << mqttcompressLENGTH_BITS ) - 1U )
+
+/**
+ * @brief The longest payload that can be compressed, as positions are kept
+ * plus one in 16 bits.
+ */
+#define mqttcompressMAX_INPUT          ( 65535U )
+
+/**
+ * @brief The first byte of the header.
+ */
+#define mqttcompressPARAMETERS         ( ( uint8_t ) ( ( mqttcompressWINDOW_BITS << 4U ) | mqttcompressLENGTH_BITS ) )
+
+/**
+ * @brief The states of a PayloadDecompressor_t.
+ */
+#define mqttcompressSTATE_HEADER       ( 0U )
+#define mqttcompressSTATE_FLAG         ( 1U )
+#define mqttcompressSTATE_LITERAL      ( 2U )
+#define mqttcompressSTATE_DISTANCE     ( 3U )
+#define mqttcompressSTATE_LENGTH       ( 4U )
+#define mqttcompressSTATE_COPY         ( 5U )
+#define mqttcompressSTATE_DONE         ( 6U )
+#define mqttcompressSTATE_ERROR        ( 7U )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The output of the compressor, written a bit at a time.
+ */
+typedef struct BitWriter
+{
+    uint8_t * pucOutput;  /**< The output buffer. */
+    size_t xLength;       /**< The length of pucOutput. */
+    size_t xWritten;      /**< The bytes written to pucOutput. */
+    uint32_t ulBits;      /**< The bits not written yet. */
+    uint8_t ucBitCount;   /**< The number of bits held in ulBits. */
+    BaseType_t xOverflow; /**< pdTRUE once pucOutput is full. */
+} BitWriter_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Hash the three bytes at a position.
+ *
+ * @param[in] pucData The bytes.
+ *
+ * @return The bucket of the position.
+ */
+static uint32_t prvHash( const uint8_t * pucData );
+
+/**
+ * @brief Record a position in the hash chains.
+ *
+ * @param[in, out] pxCompressor The working memory.
+ * @param[in] pucInput The payload.
+ * @param[in] ulPosition The position, which must be followed by at least
+ * mqttcompressMIN_MATCH - 1 bytes.
+ */
+static void prvInsertPosition( PayloadCompressor_t * pxCompressor,
+                               const uint8_t * pucInput,
+                               uint32_t ulPosition );
+
+/**
+ * @brief Append bits to the output of the compressor.
+ *
+ * @param[in, out] pxWriter The output.
+ * @param[in] ulValue The bits, in the least significant bits.
+ * @param[in] ucCount The number of bits, at most 16.
+ */
+static void prvWriteBits( BitWriter_t * pxWriter,
+                          uint32_t ulValue,
+                          uint8_t ucCount );
+
+/**
+ * @brief Take bits from the input of the decompressor.
+ *
+ * @param[in, out] pxDecompressor The state of the decompression.
+ * @param[in] pucInput The input.
+ * @param[in] xInputLength The length of @p pucInput.
+ * @param[in, out] pxInputUsed The bytes of @p pucInput used so far.
+ * @param[in] ucCount The number of bits, at most 16.
+ * @param[out] pulValue The bits.
+ *
+ * @return pdTRUE if the bits were taken;
+ * pdFALSE if the input ran out first.
+ */
+static BaseType_t prvReadBits( PayloadDecompressor_t * pxDecompressor,
+                               const uint8_t * pucInput,
+                               size_t xInputLength,
+                               size_t * pxInputUsed,
+                               uint8_t ucCount,
+                               uint32_t * pulValue );
+
+/**
+ * @brief Output a byte of the payload and keep it in the window.
+ *
+ * @param[in, out] pxDecompressor The state of the decompression.
+ * @param[out] pucOutput Where to write the byte.
+ * @param[in] ucByte The byte.
+ */
+static void prvOutputByte( PayloadDecompressor_t * pxDecompressor,
+                           uint8_t * pucOutput,
+                           uint8_t ucByte );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvHash( const uint8_t * pucData )
+{
+    uint32_t ulValue = ( ( uint32_t ) pucData[ 0 ] << 16U ) |
+                       ( ( uint32_t ) pucData[ 1 ] << 8U ) |
+                       ( uint32_t ) pucData[ 2 ];
+
+    /* Multiplicative hashing, taking the top mqttcompressHASH_BITS bits. */
+    return ( uint32_t ) ( ulValue * 2654435761UL ) >> ( 32U - mqttcompressHASH_BITS );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvInsertPosition( PayloadCompressor_t * pxCompressor,
+                               const uint8_t * pucInput,
+                               uint32_t ulPosition )
+{
+    uint32_t ulBucket = prvHash( &( pucInput[ ulPosition ] ) );
+
+    pxCompressor->usPrev[ ulPosition & ( mqttcompressWINDOW_SIZE - 1U ) ] = pxCompressor->usHead[ ulBucket ];
+    pxCompressor->usHead[ ulBucket ] = ( uint16_t ) ( ulPosition + 1U );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWriteBits( BitWriter_t * pxWriter,
+                          uint32_t ulValue,
+                          uint8_t ucCount )
+{
+    pxWriter->ulBits = ( pxWriter->ulBits << ucCount ) | ( ulValue & ( ( 1UL << ucCount ) - 1UL ) );
+    pxWriter->ucBitCount += ucCount;
+
+    while( pxWriter->ucBitCount >= 8U )
+    {
+        pxWriter->ucBitCount -= 8U;
+
+        if( pxWriter->xWritten < pxWriter->xLength )
+        {
+            pxWriter->pucOutput[ pxWriter->xWritten ] = ( uint8_t ) ( pxWriter->ulBits >> pxWriter->ucBitCount );
+            pxWriter->xWritten++;
+        }
+        else
+        {
+            pxWriter->xOverflow = pdTRUE;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReadBits( PayloadDecompressor_t * pxDecompressor,
+                               const uint8_t * pucInput,
+                               size_t xInputLength,
+                               size_t * pxInputUsed,
+                               uint8_t ucCount,
+                               uint32_t * pulValue )
+{
+    BaseType_t xReturn = pdTRUE;
+
+    while( ( pxDecompressor->ucBitCount < ucCount ) && ( *pxInputUsed < xInputLength ) )
+    {
+        pxDecompressor->ulBits = ( pxDecompressor->ulBits << 8U ) | pucInput[ *pxInputUsed ];
+        pxDecompressor->ucBitCount += 8U;
+        ( *pxInputUsed )++;
+    }
+
+    if( pxDecompressor->ucBitCount < ucCount )
+    {
+        xReturn = pdFALSE;
+    }
+    else
+    {
+        pxDecompressor->ucBitCount -= ucCount;
+        *pulValue = ( pxDecompressor->ulBits >> pxDecompressor->ucBitCount ) & ( ( 1UL << ucCount ) - 1UL );
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvOutputByte( PayloadDecompressor_t * pxDecompressor,
+                           uint8_t * pucOutput,
+                           uint8_t ucByte )
+{
+    *pucOutput = ucByte;
+    pxDecompressor->ucWindow[ pxDecompressor->ulOutput & ( mqttcompressWINDOW_SIZE - 1U ) ] = ucByte;
+    pxDecompressor->ulOutput++;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPayloadCompress( PayloadCompressor_t * pxCompressor,
+                             const uint8_t * pucInput,
+                             size_t xInputLength,
+                             uint8_t * pucOutput,
+                             size_t xOutputLength,
+                             size_t * pxCompressedLength )
+{
+    BaseType_t xReturn = pdFAIL;
+    BitWriter_t xWriter = { 0 };
+    uint32_t ulPosition = 0U;
+    uint32_t ulCandidate, ulDistance, ulMatch, ulBestMatch, ulBestDistance, ulLongest, ulChain;
+    uint16_t usEntry;
+
+    configASSERT( pxCompressor != NULL );
+    configASSERT( ( pucInput != NULL ) || ( xInputLength == 0U ) );
+    configASSERT( pucOutput != NULL );
+    configASSERT( pxCompressedLength != NULL );
+
+    if( ( xInputLength <= mqttcompressMAX_INPUT ) && ( xOutputLength >= mqttcompressHEADER_LENGTH ) )
+    {
+        ( void ) memset( pxCompressor->usHead, 0, sizeof( pxCompressor->usHead ) );
+
+        pucOutput[ 0 ] = mqttcompressPARAMETERS;
+        pucOutput[ 1 ] = ( uint8_t ) xInputLength;
+        pucOutput[ 2 ] = ( uint8_t ) ( xInputLength >> 8U );
+        pucOutput[ 3 ] = 0U;
+        pucOutput[ 4 ] = 0U;
+
+        xWriter.pucOutput = &( pucOutput[ mqttcompressHEADER_LENGTH ] );
+        xWriter.xLength = xOutputLength - mqttcompressHEADER_LENGTH;
+        xWriter.xOverflow = pdFALSE;
+
+        while( ( ulPosition < xInputLength ) && ( xWriter.xOverflow == pdFALSE ) )
+        {
+            ulBestMatch = 0U;
+            ulBestDistance = 0U;
+
+            if( ( ulPosition + mqttcompressMIN_MATCH ) <= xInputLength )
+            {
+                ulLongest = xInputLength - ulPosition;
+
+                if( ulLongest > mqttcompressMAX_MATCH )
+                {
+                    ulLongest = mqttcompressMAX_MATCH;
+                }
+
+                usEntry = pxCompressor->usHead[ prvHash( &( pucInput[ ulPosition ] ) ) ];
+
+                /* Walk the earlier positions with the same hash, from the
+                 * nearest, until one is out of the window. */
+                for( ulChain = 0U; ( usEntry != 0U ) && ( ulChain < mqttcompressMAX_CHAIN ); ulChain++ )
+                {
+                    ulCandidate = ( uint32_t ) usEntry - 1U;
+                    ulDistance = ulPosition - ulCandidate;
+
+                    if( ulDistance > mqttcompressWINDOW_SIZE )
+                    {
+                        break;
+                    }
+
+                    ulMatch = 0U;
+
+                    while( ( ulMatch < ulLongest ) && ( pucInput[ ulCandidate + ulMatch ] == pucInput[ ulPosition + ulMatch ] ) )
+                    {
+                        ulMatch++;
+                    }
+
+                    if( ulMatch > ulBestMatch )
+                    {
+                        ulBestMatch = ulMatch;
+                        ulBestDistance = ulDistance;
+
+                        if( ulMatch == ulLongest )
+                        {
+                            break;
+                        }
+                    }
+
+                    usEntry = pxCompressor->usPrev[ ulCandidate & ( mqttcompressWINDOW_SIZE - 1U ) ];
+                }
+            }
+
+            if( ulBestMatch >= mqttcompressMIN_MATCH )
+            {
+                prvWriteBits( &xWriter, 0U, 1U );
+                prvWriteBits( &xWriter, ulBestDistance - 1U, mqttcompressWINDOW_BITS );
+                prvWriteBits( &xWriter, ulBestMatch - mqttcompressMIN_MATCH, mqttcompressLENGTH_BITS );
+            }
+            else
+            {
+                ulBestMatch = 1U;
+                prvWriteBits( &xWriter, 1U, 1U );
+                prvWriteBits( &xWriter, pucInput[ ulPosition ], 8U );
+            }
+
+            /* Record every position covered by the token. */
+            for( ulMatch = 0U; ulMatch < ulBestMatch; ulMatch++ )
+            {
+                if( ( ulPosition + mqttcompressMIN_MATCH ) <= xInputLength )
+                {
+                    prvInsertPosition( pxCompressor, pucInput, ulPosition );
+                }
+
+                ulPosition++;
+            }
+        }
+
+        /* Pad the last byte with zeroes. */
+        if( xWriter.ucBitCount > 0U )
+        {
+            prvWriteBits( &xWriter, 0U, ( uint8_t ) ( 8U - xWriter.ucBitCount ) );
+        }
+
+        if( xWriter.xOverflow == pdFALSE )
+        {
+            *pxCompressedLength = mqttcompressHEADER_LENGTH + xWriter.xWritten;
+            xReturn = pdPASS;
+        }
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+void vPayloadDecompressInit( PayloadDecompressor_t * pxDecompressor )
+{
+    configASSERT( pxDecompressor != NULL );
+
+    pxDecompressor->ucState = mqttcompressSTATE_HEADER;
+    pxDecompressor->ucBitCount = 0U;
+    pxDecompressor->ulBits = 0U;
+    pxDecompressor->ulOutput = 0U;
+    pxDecompressor->ulTotal = 0U;
+    pxDecompressor->usDistance = 0U;
+    pxDecompressor->usCopy = 0U;
+}
+
+/*-----------------------------------------------------------*/
+
+PayloadDecompressStatus_t xPayloadDecompress( PayloadDecompressor_t * pxDecompressor,
+                                              const uint8_t * pucInput,
+                                              size_t xInputLength,
+                                              size_t * pxInputUsed,
+                                              uint8_t * pucOutput,
+                                              size_t xOutputLength,
+                                              size_t * pxOutputWritten )
+{
+    PayloadDecompressStatus_t xStatus = PayloadDecompressMoreInput;
+    BaseType_t xRunning = pdTRUE;
+    size_t xUsed = 0U;
+    size_t xWritten = 0U;
+    uint32_t ulValue = 0U;
+
+    configASSERT( pxDecompressor != NULL );
+    configASSERT( ( pucInput != NULL ) || ( xInputLength == 0U ) );
+    configASSERT( ( pucOutput != NULL ) || ( xOutputLength == 0U ) );
+
+    while( xRunning == pdTRUE )
+    {
+        /* The header is read a byte at a time, the header state keeps the
+         * number of bytes received in ulOutput until it is complete. */
+        if( ( pxDecompressor->ucState != mqttcompressSTATE_HEADER ) &&
+            ( pxDecompressor->ucState != mqttcompressSTATE_ERROR ) &&
+            ( pxDecompressor->ulOutput == pxDecompressor->ulTotal ) )
+        {
+            pxDecompressor->ucState = mqttcompressSTATE_DONE;
+        }
+
+        switch( pxDecompressor->ucState )
+        {
+            case mqttcompressSTATE_HEADER:
+
+                if( xUsed == xInputLength )
+                {
+                    xRunning = pdFALSE;
+                }
+                else
+                {
+                    pxDecompressor->ucHeader[ pxDecompressor->ulOutput ] = pucInput[ xUsed ];
+                    pxDecompressor->ulOutput++;
+                    xUsed++;
+
+                    if( pxDecompressor->ulOutput == mqttcompressHEADER_LENGTH )
+                    {
+                        pxDecompressor->ulOutput = 0U;
+                        pxDecompressor->ulTotal = ( uint32_t ) pxDecompressor->ucHeader[ 1 ] |
+                                                  ( ( uint32_t ) pxDecompressor->ucHeader[ 2 ] << 8U ) |
+                                                  ( ( uint32_t ) pxDecompressor->ucHeader[ 3 ] << 16U ) |
+                                                  ( ( uint32_t ) pxDecompressor->ucHeader[ 4 ] << 24U );
+                        pxDecompressor->ucState = ( pxDecompressor->ucHeader[ 0 ] == mqttcompressPARAMETERS ) ?
+                                                  mqttcompressSTATE_FLAG : mqttcompressSTATE_ERROR;
+                    }
+                }
+
+                break;
+
+            case mqttcompressSTATE_FLAG:
+
+                if( prvReadBits( pxDecompressor, pucInput, xInputLength, &xUsed, 1U, &ulValue ) == pdFALSE )
+                {
+                    xRunning = pdFALSE;
+                }
+                else
+                {
+                    pxDecompressor->ucState = ( ulValue == 1U ) ? mqttcompressSTATE_LITERAL : mqttcompressSTATE_DISTANCE;
+                }
+
+                break;
+
+            case mqttcompressSTATE_LITERAL:
+
+                if( xWritten == xOutputLength )
+                {
+                    xStatus = PayloadDecompressOutputFull;
+                    xRunning = pdFALSE;
+                }
+                else if( prvReadBits( pxDecompressor, pucInput, xInputLength, &xUsed, 8U, &ulValue ) == pdFALSE )
+                {
+                    xRunning = pdFALSE;
+                }
+                else
+                {
+                    prvOutputByte( pxDecompressor, &( pucOutput[ xWritten ] ), ( uint8_t ) ulValue );
+                    xWritten++;
+                    pxDecompressor->ucState = mqttcompressSTATE_FLAG;
+                }
+
+                break;
+
+            case mqttcompressSTATE_DISTANCE:
+
+                if( prvReadBits( pxDecompressor, pucInput, xInputLength, &xUsed, mqttcompressWINDOW_BITS, &ulValue ) == pdFALSE )
+                {
+                    xRunning = pdFALSE;
+                }
+                else
+                {
+                    pxDecompressor->usDistance = ( uint16_t ) ( ulValue + 1U );
+                    pxDecompressor->ucState = mqttcompressSTATE_LENGTH;
+                }
+
+                break;
+
+            case mqttcompressSTATE_LENGTH:
+
+                if( prvReadBits( pxDecompressor, pucInput, xInputLength, &xUsed, mqttcompressLENGTH_BITS, &ulValue ) == pdFALSE )
+                {
+                    xRunning = pdFALSE;
+                }
+                else
+                {
+                    pxDecompressor->usCopy = ( uint16_t ) ( ulValue + mqttcompressMIN_MATCH );
+
+                    /* A match may not start before the payload or run past
+                     * its end. */
+                    if( ( pxDecompressor->usDistance > pxDecompressor->ulOutput ) ||
+                        ( pxDecompressor->usCopy > ( pxDecompressor->ulTotal - pxDecompressor->ulOutput ) ) )
+                    {
+                        pxDecompressor->ucState = mqttcompressSTATE_ERROR;
+                    }
+                    else
+                    {
+                        pxDecompressor->ucState = mqttcompressSTATE_COPY;
+                    }
+                }
+
+                break;
+
+            case mqttcompressSTATE_COPY:
+
+                while( ( pxDecompressor->usCopy > 0U ) && ( xWritten < xOutputLength ) )
+                {
+                    prvOutputByte( pxDecompressor,
+                                   &( pucOutput[ xWritten ] ),
+                                   pxDecompressor->ucWindow[ ( pxDecompressor->ulOutput - pxDecompressor->usDistance ) & ( mqttcompressWINDOW_SIZE - 1U ) ] );
+                    xWritten++;
+                    pxDecompressor->usCopy--;
+                }
+
+                if( pxDecompressor->usCopy == 0U )
+                {
+                    pxDecompressor->ucState = mqttcompressSTATE_FLAG;
+                }
+                else
+                {
+                    xStatus = PayloadDecompressOutputFull;
+                    xRunning = pdFALSE;
+                }
+
+                break;
+
+            case mqttcompressSTATE_DONE:
+                xStatus = PayloadDecompressDone;
+                xRunning = pdFALSE;
+                break;
+
+            default:
+                xStatus = PayloadDecompressError;
+                xRunning = pdFALSE;
+                break;
+        }
+    }
+
+    if( pxInputUsed != NULL )
+    {
+        *pxInputUsed = xUsed;
+    }
+
+    if( pxOutputWritten != NULL )
+    {
+        *pxOutputWritten = xWritten;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsCompressedTopic( const char * pcTopicName,
+                               uint16_t usTopicLength )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( pcTopicName != NULL ) &&
+        ( usTopicLength > mqttcompressTOPIC_SUFFIX_LENGTH ) &&
+        ( memcmp( &( pcTopicName[ usTopicLength - mqttcompressTOPIC_SUFFIX_LENGTH ] ),
+                  mqttcompressTOPIC_SUFFIX,
+                  mqttcompressTOPIC_SUFFIX_LENGTH ) == 0 ) )
+    {
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
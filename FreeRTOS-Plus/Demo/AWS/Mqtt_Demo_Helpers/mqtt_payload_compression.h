@@ -0,0 +1,214 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef MQTT_PAYLOAD_COMPRESSION_H
+#define MQTT_PAYLOAD_COMPRESSION_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+
+/**
+ * @brief log2 of the size of the window in which matches are searched.  The
+ * decompressor keeps a window of this size, so it bounds its RAM.  The same
+ * value must be used by both ends.
+ */
+#ifndef mqttcompressWINDOW_BITS
+    #define mqttcompressWINDOW_BITS       ( 8U )
+#endif
+
+/**
+ * @brief The number of bits holding the length of a match.  The same value
+ * must be used by both ends.
+ */
+#ifndef mqttcompressLENGTH_BITS
+    #define mqttcompressLENGTH_BITS       ( 4U )
+#endif
+
+/**
+ * @brief log2 of the number of buckets of the hash table used by the
+ * compressor to find matches.
+ */
+#ifndef mqttcompressHASH_BITS
+    #define mqttcompressHASH_BITS         ( 8U )
+#endif
+
+/**
+ * @brief The most earlier positions compared for each match.  Higher values
+ * find longer matches at the cost of more CPU time.
+ */
+#ifndef mqttcompressMAX_CHAIN
+    #define mqttcompressMAX_CHAIN         ( 16U )
+#endif
+
+/**
+ * @brief Appended to the topic of a compressed publish, which is how the
+ * receiver tells it from a plain one.
+ */
+#ifndef mqttcompressTOPIC_SUFFIX
+    #define mqttcompressTOPIC_SUFFIX      "/lzss"
+#endif
+
+#if ( mqttcompressWINDOW_BITS < 4U ) || ( mqttcompressWINDOW_BITS > 15U )
+    #error "mqttcompressWINDOW_BITS must be between 4 and 15."
+#endif
+
+#if ( mqttcompressLENGTH_BITS < 2U ) || ( mqttcompressLENGTH_BITS > 8U )
+    #error "mqttcompressLENGTH_BITS must be between 2 and 8."
+#endif
+
+/**
+ * @brief The size of the window.
+ */
+#define mqttcompressWINDOW_SIZE           ( 1UL << mqttcompressWINDOW_BITS )
+
+/**
+ * @brief The length of the header of a compressed payload: a byte holding
+ * mqttcompressWINDOW_BITS and mqttcompressLENGTH_BITS, and the length of the
+ * uncompressed payload in four bytes, in little-endian order.
+ */
+#define mqttcompressHEADER_LENGTH         ( 5U )
+
+/**
+ * @brief The length of mqttcompressTOPIC_SUFFIX.
+ */
+#define mqttcompressTOPIC_SUFFIX_LENGTH   ( sizeof( mqttcompressTOPIC_SUFFIX ) - 1U )
+
+/**
+ * @brief The working memory of xPayloadCompress().
+ */
+typedef struct PayloadCompressor
+{
+    uint16_t usHead[ 1UL << mqttcompressHASH_BITS ]; /**< The most recent position plus one of each hash, zero if none. */
+    uint16_t usPrev[ mqttcompressWINDOW_SIZE ];      /**< The previous position plus one with the same hash, for each position in the window. */
+} PayloadCompressor_t;
+
+/**
+ * @brief The state of a streaming decompression, see xPayloadDecompress().
+ *
+ * The members are private to mqtt_payload_compression.c.
+ */
+typedef struct PayloadDecompressor
+{
+    uint8_t ucWindow[ mqttcompressWINDOW_SIZE ];     /**< The last bytes output. */
+    uint8_t ucHeader[ mqttcompressHEADER_LENGTH ];   /**< The header, while it is being received. */
+    uint8_t ucState;                                 /**< The part of the stream expected next. */
+    uint8_t ucBitCount;                              /**< The number of bits held in ulBits. */
+    uint32_t ulBits;                                 /**< The bits received and not decoded yet. */
+    uint32_t ulOutput;                               /**< The bytes output so far. */
+    uint32_t ulTotal;                                /**< The length of the uncompressed payload. */
+    uint16_t usDistance;                             /**< The distance of the match being copied. */
+    uint16_t usCopy;                                 /**< The bytes of the match still to copy. */
+} PayloadDecompressor_t;
+
+/**
+ * @brief The result of xPayloadDecompress().
+ */
+typedef enum PayloadDecompressStatus
+{
+    PayloadDecompressDone = 0,   /**< The whole payload was output. */
+    PayloadDecompressMoreInput,  /**< All the input was used, call again with the next part. */
+    PayloadDecompressOutputFull, /**< The output buffer is full, call again with the rest of the input. */
+    PayloadDecompressError       /**< The stream is not valid for this configuration. */
+} PayloadDecompressStatus_t;
+
+/**
+ * @brief Compress a payload with LZSS.
+ *
+ * The output is a header of mqttcompressHEADER_LENGTH bytes followed by a
+ * stream of tokens, each a one bit flag followed by either a literal byte or
+ * the distance and length of a match in the last mqttcompressWINDOW_SIZE
+ * bytes.  The compressor only needs @p pxCompressor besides the input and
+ * output buffers, and the decompressor only needs a PayloadDecompressor_t.
+ *
+ * @param[in, out] pxCompressor The working memory, which needs no
+ * initialization.
+ * @param[in] pucInput The payload.
+ * @param[in] xInputLength The length of the payload, at most 65535 bytes.
+ * @param[out] pucOutput The buffer for the compressed payload.
+ * @param[in] xOutputLength The length of @p pucOutput.
+ * @param[out] pxCompressedLength The length of the compressed payload.
+ *
+ * @return pdPASS if the payload was compressed;
+ * pdFAIL if it is too long or does not fit in @p pucOutput, in which case it
+ * should be sent uncompressed.
+ */
+BaseType_t xPayloadCompress( PayloadCompressor_t * pxCompressor,
+                             const uint8_t * pucInput,
+                             size_t xInputLength,
+                             uint8_t * pucOutput,
+                             size_t xOutputLength,
+                             size_t * pxCompressedLength );
+
+/**
+ * @brief Start the decompression of a payload.
+ *
+ * @param[out] pxDecompressor The state to initialize.
+ */
+void vPayloadDecompressInit( PayloadDecompressor_t * pxDecompressor );
+
+/**
+ * @brief Decompress part of a payload compressed by xPayloadCompress().
+ *
+ * The input and the output may be split in any way across calls, so that a
+ * payload can be decompressed into a buffer much smaller than it.
+ *
+ * @param[in, out] pxDecompressor The state initialized by
+ * vPayloadDecompressInit().
+ * @param[in] pucInput The next part of the compressed payload.
+ * @param[in] xInputLength The length of @p pucInput.
+ * @param[out] pxInputUsed The bytes of @p pucInput that were used.
+ * @param[out] pucOutput The buffer for the next part of the payload.
+ * @param[in] xOutputLength The length of @p pucOutput.
+ * @param[out] pxOutputWritten The bytes written to @p pucOutput.
+ *
+ * @return The status of the decompression.
+ */
+PayloadDecompressStatus_t xPayloadDecompress( PayloadDecompressor_t * pxDecompressor,
+                                              const uint8_t * pucInput,
+                                              size_t xInputLength,
+                                              size_t * pxInputUsed,
+                                              uint8_t * pucOutput,
+                                              size_t xOutputLength,
+                                              size_t * pxOutputWritten );
+
+/**
+ * @brief Whether a topic carries compressed payloads, that is whether it ends
+ * with mqttcompressTOPIC_SUFFIX.
+ *
+ * @param[in] pcTopicName The topic.
+ * @param[in] usTopicLength The length of the topic.
+ *
+ * @return pdTRUE if the payloads of the topic are compressed;
+ * pdFALSE otherwise.
+ */
+BaseType_t xIsCompressedTopic( const char * pcTopicName,
+                               uint16_t usTopicLength );
+
+#endif /* ifndef MQTT_PAYLOAD_COMPRESSION_H */
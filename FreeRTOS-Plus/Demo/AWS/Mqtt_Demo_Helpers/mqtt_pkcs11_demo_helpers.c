@@ -50,8 +50,8 @@
 /* MQTT library includes. */
 #include "core_mqtt.h"
 
-/* Exponential backoff retry include. */
-#include "backoff_algorithm.h"
+/* Backoff shared by every connection to the broker. */
+#include "endpoint_backoff.h"
 
 /* Transport interface implementation include header for TLS. */
 #include "transport_mbedtls_pkcs11.h"
@@ -94,6 +94,24 @@
  */
 #define RETRY_BACKOFF_BASE_MS                        ( 500U )
 
+/**
+ * @brief The number of consecutive failures, by any task, after which no
+ * connection to the broker is attempted for #RETRY_CIRCUIT_OPEN_MS.
+ */
+#define RETRY_CIRCUIT_FAILURE_THRESHOLD              ( 5U )
+
+/**
+ * @brief How long (in milliseconds) no connection to the broker is attempted
+ * after #RETRY_CIRCUIT_FAILURE_THRESHOLD consecutive failures.
+ */
+#define RETRY_CIRCUIT_OPEN_MS                        ( 30000U )
+
+/**
+ * @brief The longest time (in milliseconds) to wait for the broker to become
+ * available to one more attempt.
+ */
+#define RETRY_MAX_WAIT_MS                            ( 60000U )
+
 /**
  * @brief Timeout for receiving CONNACK packet in milliseconds.
  */
@@ -375,10 +393,16 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
                                                                   char * pcPrivateKeyLabel )
 {
     TlsTransportStatus_t xNetworkStatus = TLS_TRANSPORT_SUCCESS;
-    BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
-    BackoffAlgorithmContext_t xReconnectParams = { 0 };
+    static const EndpointBackoffConfig_t xBackoffConfig =
+    {
+        .ulBaseDelayMs      = RETRY_BACKOFF_BASE_MS,
+        .ulMaxDelayMs       = RETRY_MAX_BACKOFF_DELAY_MS,
+        .ulFailureThreshold = RETRY_CIRCUIT_FAILURE_THRESHOLD,
+        .ulOpenMs           = RETRY_CIRCUIT_OPEN_MS
+    };
+    EndpointBackoff_t * pxBackoff;
+    uint32_t ulAttempts = 0U;
     NetworkCredentials_t xNetworkCredentials = { 0 };
-    uint16_t usNextRetryBackOff = 0U;
 
     #if defined( democonfigCLIENT_USERNAME )
 
@@ -428,18 +452,27 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
 
     xNetworkCredentials.disableSni = pdFALSE;
 
-    /* Initialize reconnect attempts and interval.*/
-    BackoffAlgorithm_InitializeParams( &xReconnectParams,
-                                       RETRY_BACKOFF_BASE_MS,
-                                       RETRY_MAX_BACKOFF_DELAY_MS,
-                                       RETRY_MAX_ATTEMPTS );
+    /* Every task connecting to the broker shares the retry times, so they
+     * do not each retry on their own while it is unavailable. */
+    pxBackoff = pxEndpointBackoffGet( democonfigMQTT_BROKER_ENDPOINT,
+                                      democonfigMQTT_BROKER_PORT,
+                                      &xBackoffConfig );
+    configASSERT( pxBackoff != NULL );
 
     /* Attempt to connect to MQTT broker. If connection fails, retry after
-     * a timeout. Timeout value will exponentially increase until maximum
-     * attempts are reached.
+     * a timeout. Timeout value will increase with jitter until maximum
+     * attempts are reached, and no attempt is made while the circuit of the
+     * broker is open.
      */
     do
     {
+        if( xEndpointBackoffWait( pxBackoff, pdMS_TO_TICKS( RETRY_MAX_WAIT_MS ) ) != pdTRUE )
+        {
+            LogError( ( "Connection to the broker not attempted, it has been failing for too long." ) );
+            xNetworkStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+            break;
+        }
+
         /* Establish a TCP connection with the MQTT broker. This example connects to
          * the MQTT broker as specified in democonfigMQTT_BROKER_ENDPOINT and
          * democonfigMQTT_BROKER_PORT at the top of this file. */
@@ -452,28 +485,31 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkContext
                                                &xNetworkCredentials,
                                                mqttexampleTRANSPORT_SEND_RECV_TIMEOUT_MS,
                                                mqttexampleTRANSPORT_SEND_RECV_TIMEOUT_MS );
+        ulAttempts++;
 
-        if( xNetworkStatus != TLS_TRANSPORT_SUCCESS )
+        if( xNetworkStatus == TLS_TRANSPORT_SUCCESS )
         {
-            /* Generate a random number and calculate backoff value (in milliseconds) for
-             * the next connection retry.
+            vEndpointBackoffSuccess( pxBackoff );
+        }
+        else
+        {
+            /* Set the time of the next attempt from a random number.
              * Note: It is recommended to seed the random number generator with a device-specific
              * entropy source so that possibility of multiple devices retrying failed network operations
              * at similar intervals can be avoided. */
-            xBackoffAlgStatus = BackoffAlgorithm_GetNextBackoff( &xReconnectParams, uxRand(), &usNextRetryBackOff );
+            ( void ) xEndpointBackoffFailure( pxBackoff, ( uint32_t ) uxRand() );
 
-            if( xBackoffAlgStatus == BackoffAlgorithmRetriesExhausted )
+            if( ulAttempts >= RETRY_MAX_ATTEMPTS )
             {
                 LogError( ( "Connection to the broker failed, all attempts exhausted." ) );
             }
-            else if( xBackoffAlgStatus == BackoffAlgorithmSuccess )
+            else
             {
                 LogWarn( ( "Connection to the broker failed. "
                            "Retrying connection with backoff and jitter." ) );
-                vTaskDelay( pdMS_TO_TICKS( usNextRetryBackOff ) );
             }
         }
-    } while( ( xNetworkStatus != TLS_TRANSPORT_SUCCESS ) && ( xBackoffAlgStatus == BackoffAlgorithmSuccess ) );
+    } while( ( xNetworkStatus != TLS_TRANSPORT_SUCCESS ) && ( ulAttempts < RETRY_MAX_ATTEMPTS ) );
 
     return xNetworkStatus;
 }
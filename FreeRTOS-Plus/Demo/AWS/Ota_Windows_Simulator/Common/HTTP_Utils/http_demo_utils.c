@@ -29,8 +29,8 @@
 
 #include "http_demo_utils.h"
 
-/* Exponential backoff retry include. */
-#include "backoff_algorithm.h"
+/* Backoff shared by every connection to a server. */
+#include "endpoint_backoff.h"
 
 /*-----------------------------------------------------------*/
 
@@ -51,6 +51,24 @@
  */
 #define RETRY_BACKOFF_BASE_MS         ( 500U )
 
+/**
+ * @brief The number of consecutive failures, by any task, after which no
+ * connection to a server is attempted for #RETRY_CIRCUIT_OPEN_MS.
+ */
+#define RETRY_CIRCUIT_FAILURE_THRESHOLD    ( 5U )
+
+/**
+ * @brief How long (in milliseconds) no connection to a server is attempted
+ * after #RETRY_CIRCUIT_FAILURE_THRESHOLD consecutive failures.
+ */
+#define RETRY_CIRCUIT_OPEN_MS              ( 30000U )
+
+/**
+ * @brief The longest time (in milliseconds) to wait for a server to become
+ * available to one more attempt.
+ */
+#define RETRY_MAX_WAIT_MS                  ( 60000U )
+
 /**
  * @brief The separator between the "https" scheme and the host in a URL.
  */
@@ -83,48 +101,72 @@ extern UBaseType_t uxRand();
 BaseType_t connectToServerWithBackoffRetries( TransportConnect_t connectFunction,
                                               NetworkContext_t * pxNetworkContext )
 {
+    return connectToEndpointWithBackoffRetries( connectFunction, pxNetworkContext, "", 0U );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t connectToEndpointWithBackoffRetries( TransportConnect_t connectFunction,
+                                                NetworkContext_t * pxNetworkContext,
+                                                const char * pcHost,
+                                                uint16_t usPort )
+{
+    static const EndpointBackoffConfig_t xBackoffConfig =
+    {
+        .ulBaseDelayMs      = RETRY_BACKOFF_BASE_MS,
+        .ulMaxDelayMs       = RETRY_MAX_BACKOFF_DELAY_MS,
+        .ulFailureThreshold = RETRY_CIRCUIT_FAILURE_THRESHOLD,
+        .ulOpenMs           = RETRY_CIRCUIT_OPEN_MS
+    };
     BaseType_t xReturn = pdFAIL;
-    /* Status returned by the retry utilities. */
-    BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
-    /* Struct containing the next backoff time. */
-    BackoffAlgorithmContext_t xReconnectParams;
-    uint16_t usNextBackoff = 0U;
+    EndpointBackoff_t * pxBackoff;
+    uint32_t ulAttempts = 0U;
+    TickType_t xNextBackoff;
 
     assert( connectFunction != NULL );
+    assert( pcHost != NULL );
 
-    /* Initialize reconnect attempts and interval */
-    BackoffAlgorithm_InitializeParams( &xReconnectParams,
-                                       RETRY_BACKOFF_BASE_MS,
-                                       RETRY_MAX_BACKOFF_DELAY_MS,
-                                       RETRY_MAX_ATTEMPTS );
+    pxBackoff = pxEndpointBackoffGet( pcHost, usPort, &xBackoffConfig );
+    assert( pxBackoff != NULL );
 
     /* Attempt to connect to the HTTP server. If connection fails, retry after a
-     * timeout. The timeout value will exponentially increase until either the
+     * timeout. The timeout value will increase with jitter until either the
      * maximum timeout value is reached or the set number of attempts are
-     * exhausted.*/
+     * exhausted. No attempt is made while the circuit of the server is open. */
     do
     {
+        if( xEndpointBackoffWait( pxBackoff, pdMS_TO_TICKS( RETRY_MAX_WAIT_MS ) ) != pdTRUE )
+        {
+            LogError( ( "Connection to the HTTP server not attempted, it has been failing for too long." ) );
+            break;
+        }
+
         xReturn = connectFunction( pxNetworkContext );
+        ulAttempts++;
 
-        if( xReturn != pdPASS )
+        if( xReturn == pdPASS )
+        {
+            vEndpointBackoffSuccess( pxBackoff );
+        }
+        else
         {
-            /* Generate a random number and calculate backoff value (in milliseconds) for
-             * the next connection retry.
+            /* Set the time of the next attempt from a random number.
              * Note: It is recommended to seed the random number generator with a device-specific
              * entropy source so that possibility of multiple devices retrying failed network operations
              * at similar intervals can be avoided. */
-            xBackoffAlgStatus = BackoffAlgorithm_GetNextBackoff( &xReconnectParams, uxRand(), &usNextBackoff );
+            xNextBackoff = xEndpointBackoffFailure( pxBackoff, ( uint32_t ) uxRand() );
 
-            if( xBackoffAlgStatus == BackoffAlgorithmSuccess )
+            if( ulAttempts < RETRY_MAX_ATTEMPTS )
             {
                 LogWarn( ( "Connection to the HTTP server failed. "
                            "Retrying connection with backoff and jitter." ) );
-                LogInfo( ( "Retry attempt %lu out of maximum retry attempts %lu.",
-                           xReconnectParams.attemptsDone,
-                           RETRY_MAX_ATTEMPTS ) );
+                LogInfo( ( "Retry attempt %lu out of maximum retry attempts %lu in %lu ms.",
+                           ulAttempts,
+                           RETRY_MAX_ATTEMPTS,
+                           ( unsigned long ) ( xNextBackoff * portTICK_PERIOD_MS ) ) );
             }
         }
-    } while( ( xReturn == pdFAIL ) && ( xBackoffAlgStatus == BackoffAlgorithmSuccess ) );
+    } while( ( xReturn == pdFAIL ) && ( ulAttempts < RETRY_MAX_ATTEMPTS ) );
 
     if( xReturn == pdFAIL )
     {
@@ -51,9 +51,9 @@ typedef BaseType_t ( * TransportConnect_t )( NetworkContext_t * pxNetworkContext
 /**
  * @brief Connect to a server with reconnection retries.
  *
- * If connection fails, retry is attempted after a timeout. The timeout value
- * will exponentially increase until either the maximum timeout value is reached
- * or the set number of attempts are exhausted.
+ * Equivalent to #connectToEndpointWithBackoffRetries with an empty host name
+ * and port 0, so every caller shares the backoff of the one server of the
+ * demo.
  *
  * @param[in] connectFunction Function pointer for establishing connection to a
  * server.
@@ -64,6 +64,29 @@ typedef BaseType_t ( * TransportConnect_t )( NetworkContext_t * pxNetworkContext
 BaseType_t connectToServerWithBackoffRetries( TransportConnect_t connectFunction,
                                               NetworkContext_t * pxNetworkContext );
 
+/**
+ * @brief Connect to a server with reconnection retries, sharing the backoff
+ * with every other task connecting to the same server.
+ *
+ * If connection fails, retry is attempted after a timeout. The timeout value
+ * increases with jitter until either the maximum timeout value is reached or
+ * the set number of attempts are exhausted.  The timeouts are shared by every
+ * task connecting to @p pcHost and @p usPort, and after repeated failures no
+ * task connects to it for a while, see endpoint_backoff.h.
+ *
+ * @param[in] connectFunction Function pointer for establishing connection to a
+ * server.
+ * @param[out] pxNetworkContext Implementation-defined network context.
+ * @param[in] pcHost The host name of the server.
+ * @param[in] usPort The port of the server.
+ *
+ * @return pdFAIL on failure; pdPASS on successful connection.
+ */
+BaseType_t connectToEndpointWithBackoffRetries( TransportConnect_t connectFunction,
+                                                NetworkContext_t * pxNetworkContext,
+                                                const char * pcHost,
+                                                uint16_t usPort );
+
 /**
  * @brief Retrieve the path from the input URL.
  *
@@ -42,4 +42,32 @@
  */
 OtaPalMainStatus_t xValidateImageSignature( OtaFileContext_t * const pFileContext );
 
+/**
+ * @brief Start hashing a new image while it is received, so that
+ * xValidateImageSignature() does not need to read the whole file again.
+ * @param[in] pFileContext pointer to File context
+ * @return pdTRUE if hashing was started, or pdFALSE otherwise.
+ */
+BaseType_t xImageHashStart( OtaFileContext_t * const pFileContext );
+
+/**
+ * @brief Add a block that was written to the image to its hash. Blocks are
+ * hashed as long as they arrive in order, the rest of the image is read back
+ * from the file by xValidateImageSignature().
+ * @param[in] pFileContext pointer to File context
+ * @param[in] ulOffset Offset of the block in the image.
+ * @param[in] pucData The block.
+ * @param[in] ulBlockSize Length of the block in bytes.
+ */
+void vImageHashUpdate( OtaFileContext_t * const pFileContext,
+                       uint32_t ulOffset,
+                       const uint8_t * pucData,
+                       uint32_t ulBlockSize );
+
+/**
+ * @brief Drop the hash of an image that is not going to be validated.
+ * @param[in] pFileContext pointer to File context
+ */
+void vImageHashAbort( OtaFileContext_t * const pFileContext );
+
 #endif
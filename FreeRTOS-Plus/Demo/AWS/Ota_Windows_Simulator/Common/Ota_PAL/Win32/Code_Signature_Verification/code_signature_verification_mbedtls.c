@@ -83,6 +83,18 @@ typedef struct SignatureVerificationState
     mbedtls_sha256_context xSHA256Context;
 } SignatureVerificationState_t, * SignatureVerificationStatePtr_t;
 
+/**
+ * @brief The hash of the image being received, see xImageHashStart().
+ */
+typedef struct ImageHashState
+{
+    OtaFileContext_t * pxFileContext; /* The image being hashed, NULL if none. */
+    void * pvSigVerifyContext;        /* The hash so far. */
+    uint32_t ulHashedBytes;           /* Length of the image hashed so far. */
+} ImageHashState_t;
+
+static ImageHashState_t xImageHash = { 0 };
+
 /**
  * @brief Initializes digital signature verification.
  *
@@ -389,6 +401,60 @@ static BaseType_t prvSignatureVerificationFinal( void * pvContext,
     return xResult;
 }
 
+BaseType_t xImageHashStart( OtaFileContext_t * const C )
+{
+    BaseType_t xResult;
+
+    /* Drop the hash of a previous image that was neither validated nor aborted. */
+    vImageHashAbort( xImageHash.pxFileContext );
+
+    /* Verify an ECDSA-SHA256 signature. */
+    xResult = prvSignatureVerificationStart( &xImageHash.pvSigVerifyContext, ASYMMETRIC_ALGORITHM_ECDSA, HASH_ALGORITHM_SHA256 );
+
+    if( pdTRUE == xResult )
+    {
+        xImageHash.pxFileContext = C;
+        xImageHash.ulHashedBytes = 0;
+    }
+    else
+    {
+        xImageHash.pvSigVerifyContext = NULL;
+    }
+
+    return xResult;
+}
+
+void vImageHashUpdate( OtaFileContext_t * const C,
+                       uint32_t ulOffset,
+                       const uint8_t * pucData,
+                       uint32_t ulBlockSize )
+{
+    uint32_t ulSkip;
+
+    /* A block after a gap is hashed when the signature is validated. A
+     * block that was received before is not hashed again. */
+    if( ( C != NULL ) &&
+        ( C == xImageHash.pxFileContext ) &&
+        ( ulOffset <= xImageHash.ulHashedBytes ) &&
+        ( ( ulOffset + ulBlockSize ) > xImageHash.ulHashedBytes ) )
+    {
+        ulSkip = xImageHash.ulHashedBytes - ulOffset;
+        prvSignatureVerificationUpdate( xImageHash.pvSigVerifyContext, &pucData[ ulSkip ], ulBlockSize - ulSkip );
+        xImageHash.ulHashedBytes = ulOffset + ulBlockSize;
+    }
+}
+
+void vImageHashAbort( OtaFileContext_t * const C )
+{
+    if( ( C != NULL ) && ( C == xImageHash.pxFileContext ) )
+    {
+        /* Frees the context without verifying anything. */
+        ( void ) prvSignatureVerificationFinal( xImageHash.pvSigVerifyContext, NULL, 0, NULL, 0 );
+        xImageHash.pxFileContext = NULL;
+        xImageHash.pvSigVerifyContext = NULL;
+    }
+}
+
 /* Verify the signature of the specified file. */
 OtaPalMainStatus_t xValidateImageSignature( OtaFileContext_t * const C )
 {
@@ -396,17 +462,33 @@ OtaPalMainStatus_t xValidateImageSignature( OtaFileContext_t * const C )
     uint32_t ulBytesRead;
     uint32_t ulSignerCertSize;
     uint8_t * pucBuf, * pucSignerCert;
-    void * pvSigVerifyContext;
+    void * pvSigVerifyContext = NULL;
+    uint32_t ulHashedBytes = 0;
+    BaseType_t xStarted = pdTRUE;
 
-    /* Verify an ECDSA-SHA256 signature. */
-    if( pdFALSE == prvSignatureVerificationStart( &pvSigVerifyContext, ASYMMETRIC_ALGORITHM_ECDSA, HASH_ALGORITHM_SHA256 ) )
+    /* Continue the hash computed while the image was received, if any. */
+    if( C == xImageHash.pxFileContext )
+    {
+        pvSigVerifyContext = xImageHash.pvSigVerifyContext;
+        ulHashedBytes = xImageHash.ulHashedBytes;
+        xImageHash.pxFileContext = NULL;
+        xImageHash.pvSigVerifyContext = NULL;
+    }
+    else
+    {
+        /* Verify an ECDSA-SHA256 signature. */
+        xStarted = prvSignatureVerificationStart( &pvSigVerifyContext, ASYMMETRIC_ALGORITHM_ECDSA, HASH_ALGORITHM_SHA256 );
+    }
+
+    if( pdFALSE == xStarted )
     {
         eResult = OtaPalSignatureCheckFailed;
     }
     else
     {
-        LogInfo( ( "Started %s signature verification, file: %s\r\n",
-                   OTA_JsonFileSignatureKey, ( const char * ) C->pCertFilepath ) );
+        LogInfo( ( "Started %s signature verification, file: %s, %u bytes hashed while received\r\n",
+                   OTA_JsonFileSignatureKey, ( const char * ) C->pCertFilepath,
+                   ( unsigned ) ulHashedBytes ) );
         pucSignerCert = otaPal_ReadAndAssumeCertificate( ( const uint8_t * const ) C->pCertFilepath, &ulSignerCertSize );
 
         if( pucSignerCert != NULL )
@@ -415,9 +497,9 @@ OtaPalMainStatus_t xValidateImageSignature( OtaFileContext_t * const C )
 
             if( pucBuf != NULL )
             {
-                /* Rewind the received file to the beginning. */
-                if( fseek( C->pFile, 0L, SEEK_SET ) == 0 ) /*lint !e586
-                                                            * C standard library call is being used for portability. */
+                /* Move to the part of the received file that is not hashed yet. */
+                if( fseek( C->pFile, ( long ) ulHashedBytes, SEEK_SET ) == 0 ) /*lint !e586
+                                                                                * C standard library call is being used for portability. */
                 {
                     do
                     {
@@ -459,6 +541,12 @@ OtaPalMainStatus_t xValidateImageSignature( OtaFileContext_t * const C )
         {
             eResult = OtaPalBadSignerCert;
         }
+
+        if( pvSigVerifyContext != NULL )
+        {
+            /* Free the context, the signature was not verified. */
+            ( void ) prvSignatureVerificationFinal( pvSigVerifyContext, NULL, 0, NULL, 0 );
+        }
     }
 
     return eResult;
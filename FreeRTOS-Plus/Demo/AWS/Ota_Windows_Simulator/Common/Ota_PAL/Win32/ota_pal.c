@@ -79,6 +79,13 @@ OtaPalStatus_t otaPal_CreateFileForRx( OtaFileContext_t * const C )
             {
                 mainErr = OtaPalSuccess;
                 LogInfo( ( "Receive file created.\r\n" ) );
+
+                /* Hash the blocks as they are written. If that fails, the
+                 * signature check reads the whole file instead. */
+                if( xImageHashStart( C ) != pdTRUE )
+                {
+                    LogWarn( ( "Failed to start hashing the received file.\r\n" ) );
+                }
             }
             else
             {
@@ -114,6 +121,8 @@ OtaPalStatus_t otaPal_Abort( OtaFileContext_t * const C )
 
     if( NULL != C )
     {
+        vImageHashAbort( C );
+
         /* Close the OTA update file if it's open. */
         if( NULL != C->pFile )
         {
@@ -166,7 +175,11 @@ int16_t otaPal_WriteBlock( OtaFileContext_t * const C,
             lResult = fwrite( pacData, 1, ulBlockSize, C->pFile ); /*lint !e586 !e713 !e9034
                                                                     * C standard library call is being used for portability. */
 
-            if( lResult < 0 )
+            if( lResult == ( int32_t ) ulBlockSize )
+            {
+                vImageHashUpdate( C, ulOffset, pacData, ulBlockSize );
+            }
+            else if( lResult < 0 )
             {
                 LogError( ( "ERROR - fwrite failed\r\n" ) );
                 /* Mask to return a negative value. */
@@ -212,6 +225,7 @@ OtaPalStatus_t otaPal_CloseFile( OtaFileContext_t * const C )
         {
             LogError( ( "NULL OTA Signature structure.\r\n" ) );
             mainErr = OtaPalSignatureCheckFailed;
+            vImageHashAbort( C );
         }
 
         /* Close the file. */
@@ -35,12 +35,480 @@
 /* Subscription manager header include. */
 #include "subscription_manager.h"
 
+#if ( SUBSCRIPTION_MANAGER_USE_TRIE != 0 )
 
-bool addSubscription( SubscriptionElement_t * pxSubscriptionList,
-                      const char * pcTopicFilterString,
-                      uint16_t usTopicFilterLength,
-                      IncomingPubCallback_t pxIncomingPublishCallback,
-                      void * pvIncomingPublishCallbackContext )
+/**
+ * @brief Marks the end of a chain of subscriptions, or of trie nodes.  The
+ * root is node 0, so no link points to it.
+ */
+    #define trieNO_SUBSCRIPTION    ( 0xFFFFU )
+    #define trieNO_NODE            ( 0U )
+
+/**
+ * @brief One level of one or more topic filters.
+ *
+ * pcLevel points into the filter string of a subscription below the node, as
+ * the filter strings are not copied.
+ */
+    typedef struct TopicTrieNode
+    {
+        const char * pcLevel;         /* The level, not terminated. */
+        uint16_t usLevelLength;       /* The length of pcLevel. */
+        uint16_t usLevelHash;         /* Compared before pcLevel. */
+        uint16_t usParent;            /* The node of the level above. */
+        uint16_t usFirstChild;        /* The first of the literal levels below. */
+        uint16_t usNextSibling;       /* The next literal level below usParent, or the next free node. */
+        uint16_t usPlusChild;         /* The '+' level below, if any. */
+        uint16_t usHashChild;         /* The '#' level below, if any. */
+        uint16_t usFirstSubscription; /* The subscriptions whose filter ends here. */
+        uint16_t usSubscriptionCount; /* The subscriptions at and below this node. */
+        uint8_t ucDepth;              /* 1 for the first level of a filter. */
+    } TopicTrieNode_t;
+
+/**
+ * @brief The trie, and the list that it indexes.
+ */
+    static TopicTrieNode_t xTrieNodes[ SUBSCRIPTION_MANAGER_TRIE_NODES ];
+    static SubscriptionElement_t * pxTrieList = NULL;
+    static bool xTrieValid = false;
+    static uint16_t usFreeNodes = trieNO_NODE;
+
+/**
+ * @brief Links the subscriptions that end at the same node, and the unused
+ * entries of the list, by index.
+ */
+    static uint16_t usNextSubscription[ SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS ];
+    static uint16_t usFreeSubscriptions = trieNO_SUBSCRIPTION;
+
+/**
+ * @brief The indexes of the subscriptions matched by one publish, collected
+ * before the callbacks are called, as a callback may change the subscriptions.
+ */
+    static uint16_t usMatches[ SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS ];
+    static size_t uxMatchCount;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the level that starts at *pusPosition in a topic or filter.
+ *
+ * @return `false` when all levels have been returned.
+ */
+    static bool prvNextLevel( const char * pcTopic,
+                              uint16_t usTopicLength,
+                              uint16_t * pusPosition,
+                              const char ** ppcLevel,
+                              uint16_t * pusLevelLength )
+    {
+        uint16_t usEnd = *pusPosition;
+        bool xFound = false;
+
+        if( *pusPosition <= usTopicLength )
+        {
+            while( ( usEnd < usTopicLength ) && ( pcTopic[ usEnd ] != '/' ) )
+            {
+                usEnd++;
+            }
+
+            *ppcLevel = &( pcTopic[ *pusPosition ] );
+            *pusLevelLength = ( uint16_t ) ( usEnd - *pusPosition );
+            *pusPosition = ( uint16_t ) ( usEnd + 1U );
+            xFound = true;
+        }
+
+        return xFound;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static uint16_t prvLevelHash( const char * pcLevel,
+                                  uint16_t usLevelLength )
+    {
+        uint32_t ulHash = 2166136261UL;
+        uint16_t x;
+
+        for( x = 0; x < usLevelLength; x++ )
+        {
+            ulHash = ( ulHash ^ ( uint8_t ) pcLevel[ x ] ) * 16777619UL;
+        }
+
+        return ( uint16_t ) ( ulHash ^ ( ulHash >> 16 ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Find the child of usNode for a level of a filter, in which '+' and
+ * '#' are the wildcard children.
+ */
+    static uint16_t prvFindChild( uint16_t usNode,
+                                  const char * pcLevel,
+                                  uint16_t usLevelLength,
+                                  uint16_t usLevelHash )
+    {
+        uint16_t usChild;
+
+        if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '+' ) )
+        {
+            usChild = xTrieNodes[ usNode ].usPlusChild;
+        }
+        else if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '#' ) )
+        {
+            usChild = xTrieNodes[ usNode ].usHashChild;
+        }
+        else
+        {
+            for( usChild = xTrieNodes[ usNode ].usFirstChild; usChild != trieNO_NODE; usChild = xTrieNodes[ usChild ].usNextSibling )
+            {
+                if( ( xTrieNodes[ usChild ].usLevelHash == usLevelHash ) &&
+                    ( xTrieNodes[ usChild ].usLevelLength == usLevelLength ) &&
+                    ( memcmp( xTrieNodes[ usChild ].pcLevel, pcLevel, usLevelLength ) == 0 ) )
+                {
+                    break;
+                }
+            }
+        }
+
+        return usChild;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Follow the levels of a filter.
+ *
+ * @return The node of the last level, or trieNO_NODE when it does not exist.
+ * *pusMissing is set to the number of levels that do not exist.
+ */
+    static uint16_t prvFindFilter( const char * pcFilter,
+                                   uint16_t usFilterLength,
+                                   uint16_t * pusMissing )
+    {
+        uint16_t usNode = 0U, usChild, usPosition = 0U, usLevelLength, usMissing = 0U;
+        const char * pcLevel;
+
+        while( prvNextLevel( pcFilter, usFilterLength, &usPosition, &pcLevel, &usLevelLength ) )
+        {
+            usChild = ( usMissing == 0U ) ? prvFindChild( usNode, pcLevel, usLevelLength, prvLevelHash( pcLevel, usLevelLength ) ) : trieNO_NODE;
+
+            if( usChild == trieNO_NODE )
+            {
+                usMissing++;
+            }
+            else
+            {
+                usNode = usChild;
+            }
+        }
+
+        *pusMissing = usMissing;
+
+        return ( usMissing == 0U ) ? usNode : trieNO_NODE;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Add the subscription at usIndex of the trie list to the trie.
+ *
+ * @return `false` when there are not enough free nodes.
+ */
+    static bool prvTrieInsert( uint16_t usIndex )
+    {
+        const char * pcFilter = pxTrieList[ usIndex ].pcSubscriptionFilterString;
+        uint16_t usFilterLength = pxTrieList[ usIndex ].usFilterStringLength;
+        uint16_t usNode = 0U, usChild, usPosition = 0U, usLevelLength, usMissing, usFree = 0U, usHash;
+        const char * pcLevel;
+        bool xReturn = false;
+
+        /* Make sure that all levels fit, before changing anything. */
+        ( void ) prvFindFilter( pcFilter, usFilterLength, &usMissing );
+
+        for( usChild = usFreeNodes; ( usChild != trieNO_NODE ) && ( usFree < usMissing ); usChild = xTrieNodes[ usChild ].usNextSibling )
+        {
+            usFree++;
+        }
+
+        if( usFree >= usMissing )
+        {
+            xTrieNodes[ 0 ].usSubscriptionCount++;
+
+            while( prvNextLevel( pcFilter, usFilterLength, &usPosition, &pcLevel, &usLevelLength ) )
+            {
+                usHash = prvLevelHash( pcLevel, usLevelLength );
+                usChild = prvFindChild( usNode, pcLevel, usLevelLength, usHash );
+
+                if( usChild == trieNO_NODE )
+                {
+                    usChild = usFreeNodes;
+                    usFreeNodes = xTrieNodes[ usChild ].usNextSibling;
+
+                    memset( &( xTrieNodes[ usChild ] ), 0x00, sizeof( TopicTrieNode_t ) );
+                    xTrieNodes[ usChild ].pcLevel = pcLevel;
+                    xTrieNodes[ usChild ].usLevelLength = usLevelLength;
+                    xTrieNodes[ usChild ].usLevelHash = usHash;
+                    xTrieNodes[ usChild ].usParent = usNode;
+                    xTrieNodes[ usChild ].usFirstSubscription = trieNO_SUBSCRIPTION;
+                    xTrieNodes[ usChild ].ucDepth = ( uint8_t ) ( xTrieNodes[ usNode ].ucDepth + 1U );
+
+                    if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '+' ) )
+                    {
+                        xTrieNodes[ usNode ].usPlusChild = usChild;
+                    }
+                    else if( ( usLevelLength == 1U ) && ( pcLevel[ 0 ] == '#' ) )
+                    {
+                        xTrieNodes[ usNode ].usHashChild = usChild;
+                    }
+                    else
+                    {
+                        xTrieNodes[ usChild ].usNextSibling = xTrieNodes[ usNode ].usFirstChild;
+                        xTrieNodes[ usNode ].usFirstChild = usChild;
+                    }
+                }
+
+                usNode = usChild;
+                xTrieNodes[ usNode ].usSubscriptionCount++;
+            }
+
+            usNextSubscription[ usIndex ] = xTrieNodes[ usNode ].usFirstSubscription;
+            xTrieNodes[ usNode ].usFirstSubscription = usIndex;
+            xReturn = true;
+        }
+
+        return xReturn;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Point the level of a node into a filter that is still subscribed,
+ * after the subscriptions that provided it may have been removed.
+ */
+    static void prvTrieRepoint( uint16_t usNode )
+    {
+        uint16_t usBelow = usNode, usPosition = 0U, usLevelLength = 0U, usDepth;
+        const char * pcFilter;
+        const char * pcLevel = NULL;
+        uint16_t usFilterLength;
+
+        /* Every node below has subscriptions, so go down until one ends. */
+        while( xTrieNodes[ usBelow ].usFirstSubscription == trieNO_SUBSCRIPTION )
+        {
+            if( xTrieNodes[ usBelow ].usFirstChild != trieNO_NODE )
+            {
+                usBelow = xTrieNodes[ usBelow ].usFirstChild;
+            }
+            else if( xTrieNodes[ usBelow ].usPlusChild != trieNO_NODE )
+            {
+                usBelow = xTrieNodes[ usBelow ].usPlusChild;
+            }
+            else
+            {
+                usBelow = xTrieNodes[ usBelow ].usHashChild;
+            }
+        }
+
+        pcFilter = pxTrieList[ xTrieNodes[ usBelow ].usFirstSubscription ].pcSubscriptionFilterString;
+        usFilterLength = pxTrieList[ xTrieNodes[ usBelow ].usFirstSubscription ].usFilterStringLength;
+
+        for( usDepth = 0U; usDepth < xTrieNodes[ usNode ].ucDepth; usDepth++ )
+        {
+            ( void ) prvNextLevel( pcFilter, usFilterLength, &usPosition, &pcLevel, &usLevelLength );
+        }
+
+        xTrieNodes[ usNode ].pcLevel = pcLevel;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Remove all subscriptions with the given filter from the trie and
+ * from the trie list.
+ */
+    static void prvTrieRemove( const char * pcFilter,
+                               uint16_t usFilterLength )
+    {
+        uint16_t usNode, usParent, usIndex, usNext, usMissing, usRemoved = 0U;
+        uint16_t * pusLink;
+
+        usNode = prvFindFilter( pcFilter, usFilterLength, &usMissing );
+
+        if( ( usNode != trieNO_NODE ) && ( xTrieNodes[ usNode ].usFirstSubscription != trieNO_SUBSCRIPTION ) )
+        {
+            /* All subscriptions that end at a node have the same filter. */
+            for( usIndex = xTrieNodes[ usNode ].usFirstSubscription; usIndex != trieNO_SUBSCRIPTION; usIndex = usNext )
+            {
+                usNext = usNextSubscription[ usIndex ];
+                memset( &( pxTrieList[ usIndex ] ), 0x00, sizeof( SubscriptionElement_t ) );
+                usNextSubscription[ usIndex ] = usFreeSubscriptions;
+                usFreeSubscriptions = usIndex;
+                usRemoved++;
+            }
+
+            xTrieNodes[ usNode ].usFirstSubscription = trieNO_SUBSCRIPTION;
+            xTrieNodes[ 0 ].usSubscriptionCount -= usRemoved;
+
+            /* Walk up, freeing the nodes that have no subscriptions left. */
+            while( usNode != 0U )
+            {
+                usParent = xTrieNodes[ usNode ].usParent;
+                xTrieNodes[ usNode ].usSubscriptionCount -= usRemoved;
+
+                if( xTrieNodes[ usNode ].usSubscriptionCount == 0U )
+                {
+                    if( xTrieNodes[ usParent ].usPlusChild == usNode )
+                    {
+                        xTrieNodes[ usParent ].usPlusChild = trieNO_NODE;
+                    }
+                    else if( xTrieNodes[ usParent ].usHashChild == usNode )
+                    {
+                        xTrieNodes[ usParent ].usHashChild = trieNO_NODE;
+                    }
+                    else
+                    {
+                        for( pusLink = &( xTrieNodes[ usParent ].usFirstChild ); *pusLink != usNode; pusLink = &( xTrieNodes[ *pusLink ].usNextSibling ) )
+                        {
+                        }
+
+                        *pusLink = xTrieNodes[ usNode ].usNextSibling;
+                    }
+
+                    xTrieNodes[ usNode ].usNextSibling = usFreeNodes;
+                    usFreeNodes = usNode;
+                }
+                else
+                {
+                    prvTrieRepoint( usNode );
+                }
+
+                usNode = usParent;
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Collect the subscriptions below usNode that match the topic levels
+ * from usPosition onwards.
+ */
+    static void prvTrieMatch( uint16_t usNode,
+                              const char * pcTopic,
+                              uint16_t usTopicLength,
+                              uint16_t usPosition )
+    {
+        uint16_t usIndex, usChild, usLevelLength;
+        const char * pcLevel;
+        bool xWildcardsAllowed;
+
+        /* Wildcards in the first level do not match topics that start with '$'. */
+        xWildcardsAllowed = ( usNode != 0U ) || ( usTopicLength == 0U ) || ( pcTopic[ 0 ] != '$' );
+
+        /* '#' matches the rest of the topic, and the parent level itself. */
+        if( xWildcardsAllowed && ( xTrieNodes[ usNode ].usHashChild != trieNO_NODE ) )
+        {
+            for( usIndex = xTrieNodes[ xTrieNodes[ usNode ].usHashChild ].usFirstSubscription; usIndex != trieNO_SUBSCRIPTION; usIndex = usNextSubscription[ usIndex ] )
+            {
+                usMatches[ uxMatchCount++ ] = usIndex;
+            }
+        }
+
+        if( prvNextLevel( pcTopic, usTopicLength, &usPosition, &pcLevel, &usLevelLength ) == false )
+        {
+            /* All levels of the topic have been matched. */
+            for( usIndex = xTrieNodes[ usNode ].usFirstSubscription; usIndex != trieNO_SUBSCRIPTION; usIndex = usNextSubscription[ usIndex ] )
+            {
+                usMatches[ uxMatchCount++ ] = usIndex;
+            }
+        }
+        else
+        {
+            if( ( usLevelLength != 1U ) || ( ( pcLevel[ 0 ] != '+' ) && ( pcLevel[ 0 ] != '#' ) ) )
+            {
+                usChild = prvFindChild( usNode, pcLevel, usLevelLength, prvLevelHash( pcLevel, usLevelLength ) );
+
+                if( usChild != trieNO_NODE )
+                {
+                    prvTrieMatch( usChild, pcTopic, usTopicLength, usPosition );
+                }
+            }
+
+            if( xWildcardsAllowed && ( xTrieNodes[ usNode ].usPlusChild != trieNO_NODE ) )
+            {
+                prvTrieMatch( xTrieNodes[ usNode ].usPlusChild, pcTopic, usTopicLength, usPosition );
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief (Re)build the trie for a list.
+ */
+    static void prvTrieBuild( SubscriptionElement_t * pxSubscriptionList )
+    {
+        int32_t lIndex;
+        uint16_t usNode;
+
+        memset( &( xTrieNodes[ 0 ] ), 0x00, sizeof( TopicTrieNode_t ) );
+        xTrieNodes[ 0 ].usFirstSubscription = trieNO_SUBSCRIPTION;
+        usFreeNodes = trieNO_NODE;
+
+        for( usNode = ( uint16_t ) ( SUBSCRIPTION_MANAGER_TRIE_NODES - 1U ); usNode > 0U; usNode-- )
+        {
+            xTrieNodes[ usNode ].usNextSibling = usFreeNodes;
+            usFreeNodes = usNode;
+        }
+
+        pxTrieList = pxSubscriptionList;
+        xTrieValid = true;
+        usFreeSubscriptions = trieNO_SUBSCRIPTION;
+
+        /* Backwards, so that the lowest free index is used first. */
+        for( lIndex = ( int32_t ) SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS - 1; lIndex >= 0; lIndex-- )
+        {
+            if( pxSubscriptionList[ lIndex ].usFilterStringLength == 0U )
+            {
+                usNextSubscription[ lIndex ] = usFreeSubscriptions;
+                usFreeSubscriptions = ( uint16_t ) lIndex;
+            }
+            else if( prvTrieInsert( ( uint16_t ) lIndex ) == false )
+            {
+                xTrieValid = false;
+            }
+        }
+
+        if( xTrieValid == false )
+        {
+            LogWarn( ( "Not enough trie nodes, increase SUBSCRIPTION_MANAGER_TRIE_NODES." ) );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check whether the trie can be used for a list.
+ */
+    static bool prvTrieReady( SubscriptionElement_t * pxSubscriptionList )
+    {
+        if( pxTrieList == NULL )
+        {
+            prvTrieBuild( pxSubscriptionList );
+        }
+
+        return ( pxTrieList == pxSubscriptionList ) && xTrieValid;
+    }
+
+#endif /* SUBSCRIPTION_MANAGER_USE_TRIE */
+
+/*-----------------------------------------------------------*/
+
+
+static bool prvAddToList( SubscriptionElement_t * pxSubscriptionList,
+                          const char * pcTopicFilterString,
+                          uint16_t usTopicFilterLength,
+                          IncomingPubCallback_t pxIncomingPublishCallback,
+                          void * pvIncomingPublishCallbackContext )
 {
     int32_t lIndex = 0;
     size_t xAvailableIndex = SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS;
@@ -98,9 +566,9 @@ bool addSubscription( SubscriptionElement_t * pxSubscriptionList,
 
 /*-----------------------------------------------------------*/
 
-void removeSubscription( SubscriptionElement_t * pxSubscriptionList,
-                         const char * pcTopicFilterString,
-                         uint16_t usTopicFilterLength )
+static void prvRemoveFromList( SubscriptionElement_t * pxSubscriptionList,
+                               const char * pcTopicFilterString,
+                               uint16_t usTopicFilterLength )
 {
     int32_t lIndex = 0;
 
@@ -131,8 +599,8 @@ void removeSubscription( SubscriptionElement_t * pxSubscriptionList,
 
 /*-----------------------------------------------------------*/
 
-bool handleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
-                              MQTTPublishInfo_t * pxPublishInfo )
+static bool prvHandleFromList( SubscriptionElement_t * pxSubscriptionList,
+                               MQTTPublishInfo_t * pxPublishInfo )
 {
     int32_t lIndex = 0;
     bool isMatched = false, publishHandled = false;
@@ -168,3 +636,141 @@ bool handleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
 
     return publishHandled;
 }
+
+/*-----------------------------------------------------------*/
+
+bool addSubscription( SubscriptionElement_t * pxSubscriptionList,
+                      const char * pcTopicFilterString,
+                      uint16_t usTopicFilterLength,
+                      IncomingPubCallback_t pxIncomingPublishCallback,
+                      void * pvIncomingPublishCallbackContext )
+{
+    bool xReturnStatus = false;
+
+    #if ( SUBSCRIPTION_MANAGER_USE_TRIE != 0 )
+        uint16_t usNode, usIndex, usMissing;
+
+        if( ( pxSubscriptionList != NULL ) &&
+            ( pcTopicFilterString != NULL ) &&
+            ( usTopicFilterLength != 0U ) &&
+            ( pxIncomingPublishCallback != NULL ) &&
+            ( prvTrieReady( pxSubscriptionList ) ) )
+        {
+            usNode = prvFindFilter( pcTopicFilterString, usTopicFilterLength, &usMissing );
+            usIndex = ( usNode != trieNO_NODE ) ? xTrieNodes[ usNode ].usFirstSubscription : trieNO_SUBSCRIPTION;
+
+            for( ; usIndex != trieNO_SUBSCRIPTION; usIndex = usNextSubscription[ usIndex ] )
+            {
+                /* If a subscription already exists, don't do anything. */
+                if( ( pxSubscriptionList[ usIndex ].pxIncomingPublishCallback == pxIncomingPublishCallback ) &&
+                    ( pxSubscriptionList[ usIndex ].pvIncomingPublishCallbackContext == pvIncomingPublishCallbackContext ) )
+                {
+                    LogWarn( ( "Subscription already exists.\n" ) );
+                    xReturnStatus = true;
+                    break;
+                }
+            }
+
+            if( ( xReturnStatus == false ) && ( usFreeSubscriptions != trieNO_SUBSCRIPTION ) )
+            {
+                usIndex = usFreeSubscriptions;
+                usFreeSubscriptions = usNextSubscription[ usIndex ];
+
+                pxSubscriptionList[ usIndex ].pcSubscriptionFilterString = pcTopicFilterString;
+                pxSubscriptionList[ usIndex ].usFilterStringLength = usTopicFilterLength;
+                pxSubscriptionList[ usIndex ].pxIncomingPublishCallback = pxIncomingPublishCallback;
+                pxSubscriptionList[ usIndex ].pvIncomingPublishCallbackContext = pvIncomingPublishCallbackContext;
+                xReturnStatus = true;
+
+                if( prvTrieInsert( usIndex ) == false )
+                {
+                    /* The subscription is in the list, which is scanned until
+                     * the trie fits again. */
+                    LogWarn( ( "Not enough trie nodes, increase SUBSCRIPTION_MANAGER_TRIE_NODES." ) );
+                    xTrieValid = false;
+                }
+            }
+        }
+        else
+    #endif /* SUBSCRIPTION_MANAGER_USE_TRIE */
+    {
+        xReturnStatus = prvAddToList( pxSubscriptionList,
+                                      pcTopicFilterString,
+                                      usTopicFilterLength,
+                                      pxIncomingPublishCallback,
+                                      pvIncomingPublishCallbackContext );
+    }
+
+    return xReturnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+void removeSubscription( SubscriptionElement_t * pxSubscriptionList,
+                         const char * pcTopicFilterString,
+                         uint16_t usTopicFilterLength )
+{
+    #if ( SUBSCRIPTION_MANAGER_USE_TRIE != 0 )
+        if( ( pxSubscriptionList != NULL ) &&
+            ( pcTopicFilterString != NULL ) &&
+            ( usTopicFilterLength != 0U ) &&
+            ( prvTrieReady( pxSubscriptionList ) ) )
+        {
+            prvTrieRemove( pcTopicFilterString, usTopicFilterLength );
+        }
+        else
+    #endif /* SUBSCRIPTION_MANAGER_USE_TRIE */
+    {
+        prvRemoveFromList( pxSubscriptionList, pcTopicFilterString, usTopicFilterLength );
+
+        #if ( SUBSCRIPTION_MANAGER_USE_TRIE != 0 )
+        {
+            if( ( pxSubscriptionList != NULL ) && ( pxSubscriptionList == pxTrieList ) && ( xTrieValid == false ) )
+            {
+                /* The remaining subscriptions may fit in the trie now. */
+                prvTrieBuild( pxSubscriptionList );
+            }
+        }
+        #endif
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+bool handleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
+                              MQTTPublishInfo_t * pxPublishInfo )
+{
+    bool publishHandled = false;
+
+    #if ( SUBSCRIPTION_MANAGER_USE_TRIE != 0 )
+        size_t uxMatch;
+        uint16_t usIndex;
+
+        if( ( pxSubscriptionList != NULL ) &&
+            ( pxPublishInfo != NULL ) &&
+            ( prvTrieReady( pxSubscriptionList ) ) )
+        {
+            uxMatchCount = 0U;
+            prvTrieMatch( 0U, pxPublishInfo->pTopicName, pxPublishInfo->topicNameLength, 0U );
+
+            for( uxMatch = 0U; uxMatch < uxMatchCount; uxMatch++ )
+            {
+                usIndex = usMatches[ uxMatch ];
+
+                /* An earlier callback may have removed the subscription. */
+                if( pxSubscriptionList[ usIndex ].usFilterStringLength > 0U )
+                {
+                    pxSubscriptionList[ usIndex ].pxIncomingPublishCallback( pxSubscriptionList[ usIndex ].pvIncomingPublishCallbackContext,
+                                                                             pxPublishInfo );
+                    publishHandled = true;
+                }
+            }
+        }
+        else
+    #endif /* SUBSCRIPTION_MANAGER_USE_TRIE */
+    {
+        publishHandled = prvHandleFromList( pxSubscriptionList, pxPublishInfo );
+    }
+
+    return publishHandled;
+}
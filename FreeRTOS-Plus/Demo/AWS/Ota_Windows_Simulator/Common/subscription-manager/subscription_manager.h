@@ -70,6 +70,29 @@
     #define SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS    10U
 #endif
 
+/**
+ * @brief Set to 1 to index the subscriptions in a trie of topic levels.
+ *
+ * An incoming publish is then matched by following the levels of its topic,
+ * including the '+' and '#' wildcard levels, instead of by calling
+ * MQTT_MatchTopic() for every subscription.  Adding and removing a
+ * subscription also follows the levels of its filter.  The trie belongs to
+ * one subscription list, the first one passed to the functions below; another
+ * list, or a list that does not fit in SUBSCRIPTION_MANAGER_TRIE_NODES, is
+ * scanned as before.
+ */
+#ifndef SUBSCRIPTION_MANAGER_USE_TRIE
+    #define SUBSCRIPTION_MANAGER_USE_TRIE    0
+#endif
+
+/**
+ * @brief The number of trie nodes, one per distinct topic level of the
+ * filters, plus one for the root.  Must be less than 65535.
+ */
+#ifndef SUBSCRIPTION_MANAGER_TRIE_NODES
+    #define SUBSCRIPTION_MANAGER_TRIE_NODES    ( ( SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS * 4U ) + 1U )
+#endif
+
 /**
  * @brief Callback function called when receiving a publish.
  *
@@ -323,6 +323,31 @@
 /* HTTP buffers used for http request and response. */
 #define HTTP_USER_BUFFER_LENGTH                     ( otaconfigFILE_BLOCK_SIZE + HTTP_HEADER_SIZE_MAX )
 
+/**
+ * @brief The number of HTTP connections used to download the image.
+ *
+ * With 1 the OTA agent sends one range request at a time and waits for its
+ * response. With 2 to 4 every connection has a download task, and the file
+ * blocks following the one requested by the OTA agent are fetched ahead, so
+ * that this many range requests are in flight. The blocks are still passed to
+ * the OTA agent one at a time in the order it requests them.
+ */
+#ifndef otaexampleHTTP_DOWNLOAD_CONNECTIONS
+    #define otaexampleHTTP_DOWNLOAD_CONNECTIONS     ( 1U )
+#endif
+
+/**
+ * @brief Stack size and priority of the HTTP download tasks.
+ */
+#define HTTP_DOWNLOAD_TASK_STACK_SIZE               ( 6000U )
+#define HTTP_DOWNLOAD_TASK_PRIORITY                 ( tskIDLE_PRIORITY )
+
+/**
+ * @brief The longest time the OTA agent waits for a download task to fetch
+ * the block it requested.
+ */
+#define HTTP_DOWNLOAD_TIMEOUT_MS                    ( 10000U )
+
 /* Compile time error for some undefined configs, and provide default values
  * for others. */
 #ifndef democonfigMQTT_BROKER_ENDPOINT
@@ -510,6 +535,46 @@ struct NetworkContext
     TlsTransportParams_t * pParams;
 };
 
+/**
+ * @brief A connection to the HTTP server, with the buffer used for its
+ * requests and responses.
+ */
+typedef struct HttpConnection
+{
+    NetworkContext_t xNetworkContext;
+    TlsTransportParams_t xTlsTransportParams;
+    TransportInterface_t xTransportInterface;
+    uint8_t ucBuffer[ HTTP_USER_BUFFER_LENGTH ];
+} HttpConnection_t;
+
+#if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U )
+
+/**
+ * @brief The state of a download slot.
+ */
+    typedef enum DownloadState
+    {
+        eDownloadIdle = 0, /* No range is assigned to the slot. */
+        eDownloadBusy,     /* The download task of the slot fetches the range. */
+        eDownloadDone,     /* xResponse holds the response for the range. */
+        eDownloadFailed    /* The range could not be fetched. */
+    } DownloadState_t;
+
+/**
+ * @brief A range fetched by the download task of one connection. The file
+ * block with index n always goes to slot n % otaexampleHTTP_DOWNLOAD_CONNECTIONS.
+ */
+    typedef struct DownloadSlot
+    {
+        TaskHandle_t xTask;
+        DownloadState_t eState;
+        uint32_t ulGeneration; /* The value of ulDownloadGeneration when the range was assigned. */
+        uint32_t ulRangeStart;
+        uint32_t ulRangeEnd;
+        HTTPResponse_t xResponse;
+    } DownloadSlot_t;
+#endif /* otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U */
+
 
 /*---------------------------------------------------------*/
 
@@ -539,9 +604,38 @@ static MQTTAgentMessageContext_t xCommandQueue;
 static NetworkContext_t xNetworkContextMqtt;
 
 /**
- * @brief Network connection context used for HTTP connection.
+ * @brief The connections to the HTTP server. The first one is used by the OTA
+ * agent when only one connection is configured.
+ *
+ * @note This demo shows how the same buffer can be re-used for storing the HTTP
+ * response after the HTTP request is sent out. However, the user can also
+ * decide to use separate buffers for storing the HTTP request and response.
+ */
+static HttpConnection_t xHttpConnections[ otaexampleHTTP_DOWNLOAD_CONNECTIONS ];
+
+#if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U )
+
+/**
+ * @brief One download slot per HTTP connection.
+ */
+    static DownloadSlot_t xDownloadSlots[ otaexampleHTTP_DOWNLOAD_CONNECTIONS ];
+
+/**
+ * @brief Mutex protecting the state of the download slots.
+ */
+    static SemaphoreHandle_t xDownloadMutex;
+
+/**
+ * @brief Given by a download task when it has finished a range.
  */
-static NetworkContext_t xNetworkContextHttp;
+    static SemaphoreHandle_t xDownloadDoneSemaphore;
+
+/**
+ * @brief Incremented when the downloads are reset, so that ranges fetched for
+ * a previous file are dropped.
+ */
+    static uint32_t ulDownloadGeneration;
+#endif /* otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U */
 
 /**
  * @brief The host address string extracted from the pre-signed URL.
@@ -556,26 +650,11 @@ static char acServerHost[ 256 ];
  */
 static size_t xServerHostLength;
 
-/**
- * @brief A buffer used in the demo for storing HTTP request headers and
- * HTTP response headers and body.
- *
- * @note This demo shows how the same buffer can be re-used for storing the HTTP
- * response after the HTTP request is sent out. However, the user can also
- * decide to use separate buffers for storing the HTTP request and response.
- */
-static uint8_t aucHttpUserBuffer[ HTTP_USER_BUFFER_LENGTH ];
-
 /**
  * @brief The parameters for the network context using a TLS channel.
  */
 static TlsTransportParams_t xTlsTransportParams;
 
-/**
- * @brief The parameters for the network context using a TLS channel for https.
- */
-static TlsTransportParams_t xTlsTransportParamsHttps;
-
 /**
  * @brief The global array of subscription elements.
  *
@@ -647,9 +726,6 @@ static SemaphoreHandle_t xBufferSemaphore;
  */
 static MQTTAgentContext_t xGlobalMqttAgentContext;
 
-/* The transport layer interface used by the HTTP Client library. */
-static TransportInterface_t xTransportInterfaceHttp;
-
 /**
  * @brief The location of the path within the pre-signed URL.
  */
@@ -1847,91 +1923,46 @@ static OtaHttpStatus_t handleHttpResponse( const HTTPResponse_t * pResponse )
     return ret;
 }
 
-static OtaHttpStatus_t httpInit( char * pUrl )
+static BaseType_t prvReconnectToS3Server( HttpConnection_t * pxConnection )
 {
-    /* OTA lib return error code. */
-    OtaHttpStatus_t ret = OtaHttpSuccess;
+    BaseType_t xStatus;
 
-    /* HTTPS Client library return status. */
-    HTTPStatus_t httpStatus = HTTPSuccess;
-
-    /* Return value from libraries. */
-    BaseType_t xReturnStatus = pdFAIL;
-
-    /* The length of the path within the pre-signed URL. This variable is
-     * defined in order to store the length returned from parsing the URL, but
-     * it is unused. The path used for the requests in this demo needs all the
-     * query information following the location of the object, to the end of the
-     * S3 presigned URL. */
-    size_t xPathLen = 0;
-
-    /* Establish HTTPs connection */
-    LogInfo( ( "Performing TLS handshake on top of the TCP connection." ) );
-
-    xNetworkContextHttp.pParams = &xTlsTransportParamsHttps;
+    /* End TLS session, then close TCP connection. */
+    TLS_FreeRTOS_Disconnect( &pxConnection->xNetworkContext );
 
-    /* Attempt to connect to the HTTPs server. If connection fails, retry after
-     * a timeout. Timeout value will be exponentially increased till the maximum
-     * attempts are reached or maximum timeout value is reached. The function
-     * returns EXIT_FAILURE if the TCP connection cannot be established to
-     * broker after configured number of attempts. */
-    xReturnStatus = connectToS3Server( &xNetworkContextHttp, pUrl );
+    /* Try establishing connection to S3 server again. */
+    xStatus = connectToS3Server( &pxConnection->xNetworkContext, NULL );
 
-    if( xReturnStatus == pdPASS )
-    {
-        /* Define the transport interface. */
-        ( void ) memset( &xTransportInterfaceHttp, 0, sizeof( xTransportInterfaceHttp ) );
-        /* Define the transport interface. */
-        xTransportInterfaceHttp.pNetworkContext = &xNetworkContextHttp;
-        xTransportInterfaceHttp.send = TLS_FreeRTOS_send;
-        xTransportInterfaceHttp.recv = TLS_FreeRTOS_recv;
-
-        /* Retrieve the path location from url. This
-         * function returns the length of the path without the query into
-         * pathLen, which is left unused in this demo. */
-        httpStatus = getUrlPath( pUrl,
-                                 strlen( pUrl ),
-                                 &pcPath,
-                                 &xPathLen );
-
-        ret = ( httpStatus == HTTPSuccess ) ? OtaHttpSuccess : OtaHttpInitFailed;
-    }
-    else
+    if( xStatus != pdPASS )
     {
         /* Log an error to indicate connection failure after all
          * reconnect attempts are over. */
         LogError( ( "Failed to connect to HTTP server %s.",
                     acServerHost ) );
-
-        ret = OtaHttpInitFailed;
     }
 
-    return ret;
+    return xStatus;
 }
 
-static OtaHttpStatus_t httpRequest( uint32_t rangeStart,
-                                    uint32_t rangeEnd )
-{
-    /* OTA lib return error code. */
-    OtaHttpStatus_t ret = OtaHttpSuccess;
+/*-----------------------------------------------------------*/
 
+static HTTPStatus_t prvSendRangeRequest( HttpConnection_t * pxConnection,
+                                         uint32_t ulRangeStart,
+                                         uint32_t ulRangeEnd,
+                                         HTTPResponse_t * pxResponse )
+{
     /* Configurations of the initial request headers that are passed to
      * #HTTPClient_InitializeRequestHeaders. */
     HTTPRequestInfo_t requestInfo;
-    /* Represents a response returned from an HTTP server. */
-    HTTPResponse_t response;
     /* Represents header data that will be sent in an HTTP request. */
     HTTPRequestHeaders_t requestHeaders;
 
     /* Return value of all methods from the HTTP Client library API. */
     HTTPStatus_t httpStatus = HTTPSuccess;
 
-    /* Reconnection required flag. */
-    bool reconnectRequired = false;
-
     /* Initialize all HTTP Client library API structs to 0. */
     ( void ) memset( &requestInfo, 0, sizeof( requestInfo ) );
-    ( void ) memset( &response, 0, sizeof( response ) );
+    ( void ) memset( pxResponse, 0, sizeof( *pxResponse ) );
     ( void ) memset( &requestHeaders, 0, sizeof( requestHeaders ) );
 
     /* Initialize the request object. */
@@ -1947,27 +1978,27 @@ static OtaHttpStatus_t httpRequest( uint32_t rangeStart,
     requestInfo.reqFlags = HTTP_REQUEST_KEEP_ALIVE_FLAG;
 
     /* Set the buffer used for storing request headers. */
-    requestHeaders.pBuffer = aucHttpUserBuffer;
+    requestHeaders.pBuffer = pxConnection->ucBuffer;
     requestHeaders.bufferLen = HTTP_USER_BUFFER_LENGTH;
 
     httpStatus = HTTPClient_InitializeRequestHeaders( &requestHeaders,
                                                       &requestInfo );
 
-    HTTPClient_AddRangeHeader( &requestHeaders, rangeStart, rangeEnd );
+    HTTPClient_AddRangeHeader( &requestHeaders, ulRangeStart, ulRangeEnd );
 
     if( httpStatus == HTTPSuccess )
     {
         /* Initialize the response object. The same buffer used for storing
          * request headers is reused here. */
-        response.pBuffer = aucHttpUserBuffer;
-        response.bufferLen = HTTP_USER_BUFFER_LENGTH;
+        pxResponse->pBuffer = pxConnection->ucBuffer;
+        pxResponse->bufferLen = HTTP_USER_BUFFER_LENGTH;
 
         /* Send the request and receive the response. */
-        httpStatus = HTTPClient_Send( &xTransportInterfaceHttp,
+        httpStatus = HTTPClient_Send( &pxConnection->xTransportInterface,
                                       &requestHeaders,
                                       NULL,
                                       0,
-                                      &response,
+                                      pxResponse,
                                       0 );
     }
     else
@@ -1976,53 +2007,424 @@ static OtaHttpStatus_t httpRequest( uint32_t rangeStart,
                     HTTPClient_strerror( httpStatus ) ) );
     }
 
-    if( httpStatus != HTTPSuccess )
+    return httpStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U )
+
+    static void prvResetDownloads( void )
     {
-        if( ( httpStatus == HTTPNoResponse ) || ( httpStatus == HTTPNetworkError ) )
+        UBaseType_t uxIndex, uxBusy;
+
+        ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+
+        /* A task still fetching a range drops it when it finishes, as the
+         * generation no longer matches. */
+        ulDownloadGeneration++;
+
+        do
         {
-            reconnectRequired = true;
+            uxBusy = 0U;
+
+            for( uxIndex = 0; uxIndex < otaexampleHTTP_DOWNLOAD_CONNECTIONS; uxIndex++ )
+            {
+                if( xDownloadSlots[ uxIndex ].eState != eDownloadBusy )
+                {
+                    xDownloadSlots[ uxIndex ].eState = eDownloadIdle;
+                }
+                else
+                {
+                    uxBusy++;
+                }
+            }
+
+            ( void ) xSemaphoreGive( xDownloadMutex );
+
+            /* Wait for the tasks to stop using their connections, as these may
+             * be connected again next. */
+            if( ( uxBusy > 0U ) &&
+                ( xSemaphoreTake( xDownloadDoneSemaphore, pdMS_TO_TICKS( HTTP_DOWNLOAD_TIMEOUT_MS ) ) == pdFALSE ) )
+            {
+                LogWarn( ( "%u HTTP download tasks are still busy.",
+                           ( unsigned ) uxBusy ) );
+                uxBusy = 0U;
+            }
+
+            ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+        } while( uxBusy > 0U );
+
+        ( void ) xSemaphoreGive( xDownloadMutex );
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Must be called with xDownloadMutex held. */
+    static void prvScheduleDownload( uint32_t ulRangeStart,
+                                     uint32_t ulRangeEnd )
+    {
+        DownloadSlot_t * pxSlot;
+
+        pxSlot = &xDownloadSlots[ ( ulRangeStart >> otaconfigLOG2_FILE_BLOCK_SIZE ) % otaexampleHTTP_DOWNLOAD_CONNECTIONS ];
+
+        /* A slot that is busy is rescheduled when its task has finished. A
+         * slot that holds the range already, or is fetching it, is left as it
+         * is, unless fetching the range failed. */
+        if( ( pxSlot->eState != eDownloadBusy ) &&
+            ( ( pxSlot->eState != eDownloadDone ) ||
+              ( pxSlot->ulRangeStart != ulRangeStart ) ) )
+        {
+            pxSlot->eState = eDownloadBusy;
+            pxSlot->ulGeneration = ulDownloadGeneration;
+            pxSlot->ulRangeStart = ulRangeStart;
+            pxSlot->ulRangeEnd = ulRangeEnd;
+            ( void ) xTaskNotifyGive( pxSlot->xTask );
         }
-        else
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvDownloadTask( void * pvParameters )
+    {
+        UBaseType_t uxIndex = ( UBaseType_t ) pvParameters;
+        HttpConnection_t * pxConnection = &xHttpConnections[ uxIndex ];
+        DownloadSlot_t * pxSlot = &xDownloadSlots[ uxIndex ];
+        HTTPStatus_t httpStatus;
+        uint32_t ulRangeStart, ulRangeEnd;
+        bool reconnectRequired;
+
+        for( ; ; )
         {
-            LogError( ( "HTTPClient_Send failed: Error=%s.",
-                        HTTPClient_strerror( httpStatus ) ) );
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
 
-            ret = OtaHttpRequestFailed;
+            ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+            ulRangeStart = pxSlot->ulRangeStart;
+            ulRangeEnd = pxSlot->ulRangeEnd;
+            ( void ) xSemaphoreGive( xDownloadMutex );
+
+            /* The slot is only written to by the other tasks while it is not
+             * busy, so the response can be received without holding the mutex. */
+            httpStatus = prvSendRangeRequest( pxConnection,
+                                              ulRangeStart,
+                                              ulRangeEnd,
+                                              &pxSlot->xResponse );
+
+            if( httpStatus == HTTPSuccess )
+            {
+                reconnectRequired = ( ( pxSlot->xResponse.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG ) != 0U );
+            }
+            else
+            {
+                reconnectRequired = ( ( httpStatus == HTTPNoResponse ) || ( httpStatus == HTTPNetworkError ) );
+
+                LogError( ( "Fetching range %u-%u failed: Error=%s.",
+                            ( unsigned ) ulRangeStart,
+                            ( unsigned ) ulRangeEnd,
+                            HTTPClient_strerror( httpStatus ) ) );
+            }
+
+            if( reconnectRequired == true )
+            {
+                ( void ) prvReconnectToS3Server( pxConnection );
+            }
+
+            ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+
+            if( pxSlot->ulGeneration != ulDownloadGeneration )
+            {
+                pxSlot->eState = eDownloadIdle;
+            }
+            else
+            {
+                pxSlot->eState = ( httpStatus == HTTPSuccess ) ? eDownloadDone : eDownloadFailed;
+            }
+
+            ( void ) xSemaphoreGive( xDownloadMutex );
+            ( void ) xSemaphoreGive( xDownloadDoneSemaphore );
         }
     }
-    else
+
+/*-----------------------------------------------------------*/
+
+    static OtaHttpStatus_t prvStartDownloads( void )
     {
-        /* Check if reconnection required. */
-        if( response.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG )
+        OtaHttpStatus_t ret = OtaHttpSuccess;
+        UBaseType_t uxIndex;
+
+        /* The tasks are created by the first init, and kept for later files. */
+        if( xDownloadMutex == NULL )
         {
-            reconnectRequired = true;
+            xDownloadMutex = xSemaphoreCreateMutex();
+            xDownloadDoneSemaphore = xSemaphoreCreateBinary();
+
+            if( ( xDownloadMutex == NULL ) || ( xDownloadDoneSemaphore == NULL ) )
+            {
+                LogError( ( "Failed to create the HTTP download semaphores." ) );
+                ret = OtaHttpInitFailed;
+            }
+
+            for( uxIndex = 0; ( uxIndex < otaexampleHTTP_DOWNLOAD_CONNECTIONS ) && ( ret == OtaHttpSuccess ); uxIndex++ )
+            {
+                if( xTaskCreate( prvDownloadTask,
+                                 "HTTP Download",
+                                 HTTP_DOWNLOAD_TASK_STACK_SIZE,
+                                 ( void * ) uxIndex,
+                                 HTTP_DOWNLOAD_TASK_PRIORITY,
+                                 &xDownloadSlots[ uxIndex ].xTask ) != pdPASS )
+                {
+                    LogError( ( "Failed to create HTTP download task %u.",
+                                ( unsigned ) uxIndex ) );
+                    ret = OtaHttpInitFailed;
+                }
+            }
         }
 
-        /* Handle the http response received. */
-        ret = handleHttpResponse( &response );
+        if( ret == OtaHttpSuccess )
+        {
+            prvResetDownloads();
+        }
+
+        return ret;
     }
 
-    if( reconnectRequired == true )
+/*-----------------------------------------------------------*/
+
+    static OtaHttpStatus_t prvDownloadRange( uint32_t rangeStart,
+                                             uint32_t rangeEnd )
     {
-        /* End TLS session, then close TCP connection. */
-        TLS_FreeRTOS_Disconnect( &xNetworkContextHttp );
+        OtaHttpStatus_t ret = OtaHttpSuccess;
+        DownloadSlot_t * pxSlot;
+        TickType_t xStartTime = xTaskGetTickCount();
+        TickType_t xElapsed = 0;
+        uint32_t ulAhead;
+
+        pxSlot = &xDownloadSlots[ ( rangeStart >> otaconfigLOG2_FILE_BLOCK_SIZE ) % otaexampleHTTP_DOWNLOAD_CONNECTIONS ];
+
+        ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+
+        /* Keep the blocks following the requested one in flight. Once past the
+         * end of the file, the server answers them with an error status, which
+         * is never passed to the OTA agent. */
+        prvScheduleDownload( rangeStart, rangeEnd );
 
-        /* Try establishing connection to S3 server again. */
-        if( connectToS3Server( &xNetworkContextHttp, NULL ) == EXIT_SUCCESS )
+        for( ulAhead = 1U; ulAhead < otaexampleHTTP_DOWNLOAD_CONNECTIONS; ulAhead++ )
         {
-            ret = HTTPSuccess;
+            prvScheduleDownload( rangeStart + ( ulAhead * otaconfigFILE_BLOCK_SIZE ),
+                                 rangeStart + ( ( ulAhead + 1U ) * otaconfigFILE_BLOCK_SIZE ) - 1U );
         }
-        else
+
+        /* Wait for the requested range. The slot may still be busy with a
+         * range from before, in which case it is scheduled again once done. */
+        while( ( pxSlot->eState != eDownloadDone ) || ( pxSlot->ulRangeStart != rangeStart ) )
         {
-            /* Log an error to indicate connection failure after all
-             * reconnect attempts are over. */
-            LogError( ( "Failed to connect to HTTP server %s.",
-                        acServerHost ) );
+            if( ( pxSlot->eState == eDownloadFailed ) && ( pxSlot->ulRangeStart == rangeStart ) )
+            {
+                ret = OtaHttpRequestFailed;
+                break;
+            }
 
-            ret = OtaHttpRequestFailed;
+            prvScheduleDownload( rangeStart, rangeEnd );
+
+            ( void ) xSemaphoreGive( xDownloadMutex );
+
+            xElapsed = xTaskGetTickCount() - xStartTime;
+
+            if( ( xElapsed >= pdMS_TO_TICKS( HTTP_DOWNLOAD_TIMEOUT_MS ) ) ||
+                ( xSemaphoreTake( xDownloadDoneSemaphore, pdMS_TO_TICKS( HTTP_DOWNLOAD_TIMEOUT_MS ) - xElapsed ) == pdFALSE ) )
+            {
+                LogError( ( "Timed out fetching range %u-%u.",
+                            ( unsigned ) rangeStart,
+                            ( unsigned ) rangeEnd ) );
+                ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+                ret = OtaHttpRequestFailed;
+                break;
+            }
+
+            ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+        }
+
+        ( void ) xSemaphoreGive( xDownloadMutex );
+
+        if( ret == OtaHttpSuccess )
+        {
+            /* The download task does not touch a slot that is done, so the
+             * response is handled without holding the mutex. */
+            ret = handleHttpResponse( &pxSlot->xResponse );
+        }
+
+        ( void ) xSemaphoreTake( xDownloadMutex, portMAX_DELAY );
+
+        if( ( pxSlot->eState != eDownloadBusy ) && ( pxSlot->ulRangeStart == rangeStart ) )
+        {
+            pxSlot->eState = eDownloadIdle;
+
+            /* Refill the slot with the next block it is responsible for. */
+            if( ret == OtaHttpSuccess )
+            {
+                ulAhead = otaexampleHTTP_DOWNLOAD_CONNECTIONS;
+                prvScheduleDownload( rangeStart + ( ulAhead * otaconfigFILE_BLOCK_SIZE ),
+                                     rangeStart + ( ( ulAhead + 1U ) * otaconfigFILE_BLOCK_SIZE ) - 1U );
+            }
         }
+
+        ( void ) xSemaphoreGive( xDownloadMutex );
+
+        return ret;
     }
 
+#endif /* otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U */
+
+/*-----------------------------------------------------------*/
+
+static OtaHttpStatus_t httpInit( char * pUrl )
+{
+    /* OTA lib return error code. */
+    OtaHttpStatus_t ret = OtaHttpSuccess;
+
+    /* HTTPS Client library return status. */
+    HTTPStatus_t httpStatus = HTTPSuccess;
+
+    /* Return value from libraries. */
+    BaseType_t xReturnStatus = pdPASS;
+
+    /* The length of the path within the pre-signed URL. This variable is
+     * defined in order to store the length returned from parsing the URL, but
+     * it is unused. The path used for the requests in this demo needs all the
+     * query information following the location of the object, to the end of the
+     * S3 presigned URL. */
+    size_t xPathLen = 0;
+
+    UBaseType_t uxIndex;
+
+    HttpConnection_t * pxConnection;
+
+    #if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U )
+        /* Stop the downloads of a previous URL before connecting again. */
+        if( xDownloadMutex != NULL )
+        {
+            prvResetDownloads();
+        }
+    #endif
+
+    /* Establish HTTPs connection */
+    LogInfo( ( "Performing TLS handshake on top of the TCP connection." ) );
+
+    for( uxIndex = 0; ( uxIndex < otaexampleHTTP_DOWNLOAD_CONNECTIONS ) && ( xReturnStatus == pdPASS ); uxIndex++ )
+    {
+        pxConnection = &xHttpConnections[ uxIndex ];
+        pxConnection->xNetworkContext.pParams = &pxConnection->xTlsTransportParams;
+
+        /* Attempt to connect to the HTTPs server. If connection fails, retry after
+         * a timeout. Timeout value will be exponentially increased till the maximum
+         * attempts are reached or maximum timeout value is reached. The function
+         * returns EXIT_FAILURE if the TCP connection cannot be established to
+         * broker after configured number of attempts. The host is parsed from the
+         * URL for the first connection only. */
+        xReturnStatus = connectToS3Server( &pxConnection->xNetworkContext,
+                                           ( uxIndex == 0U ) ? pUrl : NULL );
+
+        if( xReturnStatus == pdPASS )
+        {
+            /* Define the transport interface. */
+            ( void ) memset( &pxConnection->xTransportInterface, 0, sizeof( pxConnection->xTransportInterface ) );
+            /* Define the transport interface. */
+            pxConnection->xTransportInterface.pNetworkContext = &pxConnection->xNetworkContext;
+            pxConnection->xTransportInterface.send = TLS_FreeRTOS_send;
+            pxConnection->xTransportInterface.recv = TLS_FreeRTOS_recv;
+        }
+    }
+
+    if( xReturnStatus == pdPASS )
+    {
+        /* Retrieve the path location from url. This
+         * function returns the length of the path without the query into
+         * pathLen, which is left unused in this demo. */
+        httpStatus = getUrlPath( pUrl,
+                                 strlen( pUrl ),
+                                 &pcPath,
+                                 &xPathLen );
+
+        ret = ( httpStatus == HTTPSuccess ) ? OtaHttpSuccess : OtaHttpInitFailed;
+    }
+    else
+    {
+        /* Log an error to indicate connection failure after all
+         * reconnect attempts are over. */
+        LogError( ( "Failed to connect to HTTP server %s.",
+                    acServerHost ) );
+
+        ret = OtaHttpInitFailed;
+    }
+
+    #if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U )
+        if( ret == OtaHttpSuccess )
+        {
+            ret = prvStartDownloads();
+        }
+    #endif
+
+    return ret;
+}
+
+static OtaHttpStatus_t httpRequest( uint32_t rangeStart,
+                                    uint32_t rangeEnd )
+{
+    /* OTA lib return error code. */
+    OtaHttpStatus_t ret = OtaHttpSuccess;
+
+    #if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U )
+        ret = prvDownloadRange( rangeStart, rangeEnd );
+    #else
+        /* Represents a response returned from an HTTP server. */
+        HTTPResponse_t response;
+
+        /* Return value of all methods from the HTTP Client library API. */
+        HTTPStatus_t httpStatus = HTTPSuccess;
+
+        /* Reconnection required flag. */
+        bool reconnectRequired = false;
+
+        httpStatus = prvSendRangeRequest( &xHttpConnections[ 0 ],
+                                          rangeStart,
+                                          rangeEnd,
+                                          &response );
+
+        if( httpStatus != HTTPSuccess )
+        {
+            if( ( httpStatus == HTTPNoResponse ) || ( httpStatus == HTTPNetworkError ) )
+            {
+                reconnectRequired = true;
+            }
+            else
+            {
+                LogError( ( "HTTPClient_Send failed: Error=%s.",
+                            HTTPClient_strerror( httpStatus ) ) );
+
+                ret = OtaHttpRequestFailed;
+            }
+        }
+        else
+        {
+            /* Check if reconnection required. */
+            if( response.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG )
+            {
+                reconnectRequired = true;
+            }
+
+            /* Handle the http response received. */
+            ret = handleHttpResponse( &response );
+        }
+
+        if( reconnectRequired == true )
+        {
+            if( prvReconnectToS3Server( &xHttpConnections[ 0 ] ) != pdPASS )
+            {
+                ret = OtaHttpRequestFailed;
+            }
+        }
+    #endif /* if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U ) */
+
     return ret;
 }
 
@@ -2032,7 +2434,13 @@ static OtaHttpStatus_t httpDeinit( void )
 {
     OtaHttpStatus_t ret = OtaHttpSuccess;
 
-    /* Nothing special to do here .*/
+    #if ( otaexampleHTTP_DOWNLOAD_CONNECTIONS > 1U )
+        /* Drop the blocks fetched ahead, they belong to this file. */
+        if( xDownloadMutex != NULL )
+        {
+            prvResetDownloads();
+        }
+    #endif
 
     return ret;
 }
@@ -184,6 +184,14 @@
  */
 #define otaexampleMAX_UINT32                     ( 0xffffffff )
 
+/**
+ * @brief Every block of a request must find a free event buffer, or it is
+ * dropped and only requested again after otaconfigFILE_REQUEST_WAIT_MS.
+ */
+#if ( otaconfigMAX_NUM_OTA_DATA_BUFFERS <= otaconfigMAX_NUM_BLOCKS_REQUEST )
+    #error "otaconfigMAX_NUM_OTA_DATA_BUFFERS must be larger than otaconfigMAX_NUM_BLOCKS_REQUEST."
+#endif
+
 /**
  * @brief Dimensions the buffer used to serialize and deserialize MQTT packets.
  * @note Specified in bytes.  Must be large enough to hold the maximum
@@ -1007,7 +1015,8 @@ static void prvMqttDataCallback( void * pvIncomingPublishCallbackContext,
     configASSERT( pxPublishInfo != NULL );
     ( void ) pvIncomingPublishCallbackContext;
 
-    LogInfo( ( "Received data message callback, size %zu.\n\n", pxPublishInfo->payloadLength ) );
+    /* Called for every block of the window, so only logged for debugging. */
+    LogDebug( ( "Received data message callback, size %zu.\n\n", pxPublishInfo->payloadLength ) );
 
     pxData = prvOTAEventBufferGet();
 
@@ -1023,7 +1032,7 @@ static void prvMqttDataCallback( void * pvIncomingPublishCallbackContext,
     }
     else
     {
-        LogError( ( "Error: No OTA data buffers available.\r\n" ) );
+        LogError( ( "Error: No OTA data buffers available, the block is dropped.\r\n" ) );
     }
 }
 
@@ -94,8 +94,12 @@ extern void vLoggingPrintf( const char * pcFormatString,
  *
  * The wait timer is reset whenever a data block is received from the OTA service so we will only send
  * the request message after being idle for this amount of time.
+ *
+ * The blocks of a request arrive back to back, so this only has to cover the
+ * round trip to the service.  A block lost in the window is requested again
+ * after this time.
  */
-#define otaconfigFILE_REQUEST_WAIT_MS           10000U
+#define otaconfigFILE_REQUEST_WAIT_MS           3000U
 
 /**
  * @brief The maximum allowed length of the thing name used by the OTA agent.
@@ -118,8 +122,11 @@ extern void vLoggingPrintf( const char * pcFormatString,
  *  how many data blocks response is expected for each data requests.
  *  Please note that this must be set larger than zero.
  *
+ *  The next request is only sent once the blocks of the previous one were received, so the time
+ *  of an update is dominated by one round trip per request. 16 blocks of 2 KB keep 32 KB in flight.
+ *
  */
-#define otaconfigMAX_NUM_BLOCKS_REQUEST         4U
+#define otaconfigMAX_NUM_BLOCKS_REQUEST         16U
 
 /**
  * @brief The maximum number of requests allowed to send without a response before we abort.
@@ -135,8 +142,12 @@ extern void vLoggingPrintf( const char * pcFormatString,
  *
  * This configurations parameter sets the maximum number of static data buffers used by
  * the OTA agent for job and file data blocks received.
+ *
+ * A block that arrives while all buffers are in use is dropped, and only requested again after
+ * otaconfigFILE_REQUEST_WAIT_MS, so there is a buffer for each block of a request and one for a
+ * control message.
  */
-#define otaconfigMAX_NUM_OTA_DATA_BUFFERS       5U
+#define otaconfigMAX_NUM_OTA_DATA_BUFFERS       ( otaconfigMAX_NUM_BLOCKS_REQUEST + 1U )
 
 /**
  * @brief How frequently the device will report its OTA progress to the cloud.
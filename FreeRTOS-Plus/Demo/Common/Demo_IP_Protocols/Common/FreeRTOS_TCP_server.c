@@ -55,6 +55,31 @@
 /* Remove slashes at the end of a path. */
     static void prvRemoveSlash( char * pcDir );
 
+    #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        static void prvCreateWorkers( TCPServer_t * pxServer );
+        static void prvWorkerTask( void * pvParameters );
+        static BaseType_t prvHandOver( TCPServer_t * pxServer,
+                                       TCPClient_t * pxClient );
+        static void prvTakeNewClients( TCPServer_t * pxWorker );
+    #endif
+
+    #if ( tcpserverUSE_ADMISSION != 0 )
+        static size_t prvWindowMemory( enum eSERVER_TYPE eType );
+        static BaseType_t prvAdmit( TCPServer_t * pxServer,
+                                    BaseType_t xIndex );
+        static void prvAdmissionTake( TCPServer_t * pxServer,
+                                      enum eSERVER_TYPE eType );
+        static void prvAdmissionRelease( TCPServer_t * pxServer,
+                                         enum eSERVER_TYPE eType );
+        static void prvAcceptOrWait( TCPServer_t * pxServer,
+                                     BaseType_t xIndex,
+                                     Socket_t xNexSocket );
+        static void prvRefuse( TCPServer_t * pxServer,
+                               BaseType_t xIndex,
+                               Socket_t xSocket );
+        static void prvServiceWaiting( TCPServer_t * pxServer );
+    #endif
+
     TCPServer_t * FreeRTOS_CreateTCPServer( const struct xSERVER_CONFIG * pxConfigs,
                                             BaseType_t xCount )
     {
@@ -144,6 +169,12 @@
                         }
                     }
                 }
+
+                #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+                {
+                    prvCreateWorkers( pxServer );
+                }
+                #endif
             }
             else
             {
@@ -169,7 +200,12 @@
         BaseType_t xSize = 0;
         FTCPWorkFunction fWorkFunc = NULL;
         FTCPDeleteFunction fDeleteFunc = NULL;
+        TickType_t xIdleTimeout = 0;
         const char * pcType = "Unknown";
+        struct freertos_sockaddr xRemoteAddress;
+
+        /* Read the address while the socket is certainly still open. */
+        FreeRTOS_GetRemoteAddress( xNexSocket, &xRemoteAddress );
 
         /*_RB_ Can the work and delete functions be part of the xSERVER_CONFIG structure
          * becomes generic, with no pre-processing required? */
@@ -180,6 +216,7 @@
                 xSize = sizeof( HTTPClient_t );
                 fWorkFunc = xHTTPClientWork;
                 fDeleteFunc = vHTTPClientDelete;
+                xIdleTimeout = pdMS_TO_TICKS( ipconfigHTTP_IDLE_TIMEOUT_MS );
                 pcType = "HTTP";
             }
         }
@@ -205,8 +242,16 @@
 
         if( pxClient != NULL )
         {
+            BaseType_t xOwnClient = pdTRUE;
+
             memset( pxClient, '\0', xSize );
 
+            #if ( tcpserverUSE_ADMISSION != 0 )
+            {
+                prvAdmissionTake( pxServer, pxServer->xServers[ xIndex ].eType );
+            }
+            #endif
+
             /* Put the new client in front of the list. */
             pxClient->eType = pxServer->xServers[ xIndex ].eType;
             pxClient->pcRootDir = pxServer->xServers[ xIndex ].pcRootDir;
@@ -215,9 +260,30 @@
             pxClient->pxNextClient = pxServer->pxClients;
             pxClient->fWorkFunction = fWorkFunc;
             pxClient->fDeleteFunction = fDeleteFunc;
-            pxServer->pxClients = pxClient;
+            pxClient->xLastActivity = xTaskGetTickCount();
+            pxClient->xIdleTimeout = xIdleTimeout;
+
+            #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+            {
+                if( pxServer->xWorkerCount > 0 )
+                {
+                    /* A worker will serve the client. */
+                    xOwnClient = pdFALSE;
 
-            FreeRTOS_FD_SET( xNexSocket, pxServer->xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+                    if( prvHandOver( pxServer, pxClient ) == pdFALSE )
+                    {
+                        pcType = "closed";
+                    }
+                }
+            }
+            #endif
+
+            if( xOwnClient != pdFALSE )
+            {
+                pxServer->pxClients = pxClient;
+
+                FreeRTOS_FD_SET( xNexSocket, pxServer->xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+            }
         }
         else
         {
@@ -226,8 +292,6 @@
         }
 
         {
-            struct freertos_sockaddr xRemoteAddress;
-            FreeRTOS_GetRemoteAddress( pxClient->xSocket, &xRemoteAddress );
             #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
             {
                 FreeRTOS_printf( ( "TPC-server: new %s client %xip\n", pcType, ( unsigned ) FreeRTOS_ntohl( xRemoteAddress.sin_address.ulIP_IPv4 ) ) );
@@ -251,6 +315,26 @@
         BaseType_t xIndex;
         BaseType_t xRc;
 
+        #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        {
+            if( pxServer->xNewClients != NULL )
+            {
+                /* This is a worker, adopt the clients accepted for it. */
+                prvTakeNewClients( pxServer );
+            }
+        }
+        #endif
+
+        #if ( tcpserverUSE_ADMISSION != 0 )
+        {
+            /* Waiting connections must be looked at regularly. */
+            if( ( pxServer->uxWaitingCount > 0U ) && ( xBlockingTime > pdMS_TO_TICKS( 50 ) ) )
+            {
+                xBlockingTime = pdMS_TO_TICKS( 50 );
+            }
+        }
+        #endif
+
         /* Let the server do one working cycle */
         xRc = FreeRTOS_select( pxServer->xSocketSet, xBlockingTime );
 
@@ -272,7 +356,15 @@
 
                 if( ( xNexSocket != FREERTOS_NO_SOCKET ) && ( xNexSocket != FREERTOS_INVALID_SOCKET ) )
                 {
-                    prvReceiveNewClient( pxServer, xIndex, xNexSocket );
+                    #if ( tcpserverUSE_ADMISSION != 0 )
+                    {
+                        prvAcceptOrWait( pxServer, xIndex, xNexSocket );
+                    }
+                    #else
+                    {
+                        prvReceiveNewClient( pxServer, xIndex, xNexSocket );
+                    }
+                    #endif
                 }
             }
         }
@@ -282,26 +374,495 @@
         while( ( *ppxClient ) != NULL )
         {
             TCPClient_t * pxThis = *ppxClient;
+            TickType_t xNow;
 
             /* Almost C++ */
             xRc = pxThis->fWorkFunction( pxThis );
+            xNow = xTaskGetTickCount();
+
+            if( xRc > 0 )
+            {
+                pxThis->xLastActivity = xNow;
+            }
+            else if( ( xRc == 0 ) &&
+                     ( pxThis->xIdleTimeout != 0 ) &&
+                     ( ( xNow - pxThis->xLastActivity ) >= pxThis->xIdleTimeout ) )
+            {
+                FreeRTOS_printf( ( "TCP-server: closing idle client after %u requests\n", ( unsigned ) pxThis->ulRequestCount ) );
+                xRc = -1;
+            }
 
             if( xRc < 0 )
             {
                 *ppxClient = pxThis->pxNextClient;
+
+                #if ( tcpserverUSE_ADMISSION != 0 )
+                {
+                    /* Clients of a worker were admitted by the accepting server. */
+                    prvAdmissionRelease( ( pxServer->pxAcceptor != NULL ) ? pxServer->pxAcceptor : pxServer, pxThis->eType );
+                }
+                #endif
+
                 /* Close handles, resources */
                 pxThis->fDeleteFunction( pxThis );
                 /* Free the space */
                 vPortFreeLarge( pxThis );
+
+                #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+                {
+                    if( pxServer->xNewClients != NULL )
+                    {
+                        pxServer->uxClientCount--;
+                    }
+                }
+                #endif
             }
             else
             {
                 ppxClient = &( pxThis->pxNextClient );
             }
         }
+
+        #if ( tcpserverUSE_ADMISSION != 0 )
+        {
+            if( pxServer->uxWaitingCount > 0U )
+            {
+                prvServiceWaiting( pxServer );
+            }
+        }
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t FreeRTOS_TCPServerGetClientStats( TCPServer_t * pxServer,
+                                                 TCPClientStats_t * pxStats,
+                                                 BaseType_t xMaxCount )
+    {
+        TCPClient_t * pxClient;
+        BaseType_t xCount = 0;
+        TickType_t xNow = xTaskGetTickCount();
+
+        #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+            BaseType_t xWorker;
+
+            /* The client lists of the workers may not change while they are
+             * being read. */
+            vTaskSuspendAll();
+        #endif
+
+        for( pxClient = pxServer->pxClients; ( pxClient != NULL ) && ( xCount < xMaxCount ); pxClient = pxClient->pxNextClient )
+        {
+            pxStats[ xCount ].eType = pxClient->eType;
+            pxStats[ xCount ].xSocket = pxClient->xSocket;
+            pxStats[ xCount ].ulRequestCount = pxClient->ulRequestCount;
+            pxStats[ xCount ].xIdleTime = xNow - pxClient->xLastActivity;
+            xCount++;
+        }
+
+        #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        {
+            for( xWorker = 0; xWorker < pxServer->xWorkerCount; xWorker++ )
+            {
+                xCount += FreeRTOS_TCPServerGetClientStats( pxServer->pxWorkers[ xWorker ], pxStats + xCount, xMaxCount - xCount );
+            }
+
+            ( void ) xTaskResumeAll();
+        }
+        #endif
+
+        return xCount;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+
+        static void prvCreateWorkers( TCPServer_t * pxServer )
+        {
+            BaseType_t xIndex;
+
+            for( xIndex = 0; xIndex < ipconfigTCP_SERVER_WORKERS; xIndex++ )
+            {
+                TCPServer_t * pxWorker;
+                BaseType_t xSize = sizeof( *pxWorker );
+                char pcName[ configMAX_TASK_NAME_LEN ];
+
+                /* A worker is a server without listening sockets. */
+                pxWorker = ( TCPServer_t * ) pvPortMallocLarge( xSize );
+
+                if( pxWorker == NULL )
+                {
+                    break;
+                }
+
+                memset( pxWorker, '\0', xSize );
+                #if ( tcpserverUSE_ADMISSION != 0 )
+                {
+                    pxWorker->pxAcceptor = pxServer;
+                }
+                #endif
+                pxWorker->xSocketSet = FreeRTOS_CreateSocketSet();
+                pxWorker->xNewClients = xQueueCreate( ipconfigTCP_SERVER_WORKER_QUEUE_LENGTH, sizeof( TCPClient_t * ) );
+                snprintf( pcName, sizeof( pcName ), "TCPWork%d", ( int ) xIndex );
+
+                if( ( pxWorker->xSocketSet == NULL ) ||
+                    ( pxWorker->xNewClients == NULL ) ||
+                    ( xTaskCreate( prvWorkerTask, pcName, ipconfigTCP_SERVER_WORKER_STACK_SIZE, pxWorker,
+                                   ipconfigTCP_SERVER_WORKER_PRIORITY, NULL ) != pdPASS ) )
+                {
+                    if( pxWorker->xSocketSet != NULL )
+                    {
+                        FreeRTOS_DeleteSocketSet( pxWorker->xSocketSet );
+                    }
+
+                    if( pxWorker->xNewClients != NULL )
+                    {
+                        vQueueDelete( pxWorker->xNewClients );
+                    }
+
+                    vPortFreeLarge( pxWorker );
+                    break;
+                }
+
+                pxServer->pxWorkers[ pxServer->xWorkerCount ] = pxWorker;
+                pxServer->xWorkerCount++;
+            }
+
+            /* Without workers, the server serves its clients itself. */
+            FreeRTOS_printf( ( "TCP-server: %d worker tasks\n", ( int ) pxServer->xWorkerCount ) );
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvWorkerTask( void * pvParameters )
+        {
+            TCPServer_t * pxWorker = ( TCPServer_t * ) pvParameters;
+
+            for( ; ; )
+            {
+                FreeRTOS_TCPServerWork( pxWorker, pdMS_TO_TICKS( ipconfigTCP_SERVER_WORKER_POLL_MS ) );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvHandOver( TCPServer_t * pxServer,
+                                       TCPClient_t * pxClient )
+        {
+            TCPServer_t * pxWorker = pxServer->pxWorkers[ 0 ];
+            BaseType_t xIndex;
+            BaseType_t xResult;
+
+            /* Choose the worker that owns the fewest clients.  uxClientCount is
+             * only written by the worker itself, an outdated value just makes
+             * the choice a little less optimal. */
+            for( xIndex = 1; xIndex < pxServer->xWorkerCount; xIndex++ )
+            {
+                if( pxServer->pxWorkers[ xIndex ]->uxClientCount < pxWorker->uxClientCount )
+                {
+                    pxWorker = pxServer->pxWorkers[ xIndex ];
+                }
+            }
+
+            /* From now on, only the worker will access the client. */
+            pxClient->pxParent = pxWorker;
+            xResult = xQueueSend( pxWorker->xNewClients, &pxClient, 0 );
+
+            if( xResult != pdPASS )
+            {
+                FreeRTOS_printf( ( "TCP-server: worker is busy, closing new client\n" ) );
+
+                #if ( tcpserverUSE_ADMISSION != 0 )
+                {
+                    prvAdmissionRelease( pxServer, pxClient->eType );
+                }
+                #endif
+
+                FreeRTOS_closesocket( pxClient->xSocket );
+                vPortFreeLarge( pxClient );
+                xResult = pdFALSE;
+            }
+            else
+            {
+                xResult = pdTRUE;
+            }
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvTakeNewClients( TCPServer_t * pxWorker )
+        {
+            TCPClient_t * pxClient;
+
+            while( xQueueReceive( pxWorker->xNewClients, &pxClient, 0 ) == pdPASS )
+            {
+                pxClient->pxNextClient = pxWorker->pxClients;
+                pxWorker->pxClients = pxClient;
+                pxWorker->uxClientCount++;
+
+                FreeRTOS_FD_SET( pxClient->xSocket, pxWorker->xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+            }
+
+            #if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+            {
+                if( pxWorker->xFlushCache != pdFALSE )
+                {
+                    pxWorker->xFlushCache = pdFALSE;
+                    vHTTPServerFlushCache( pxWorker );
+                }
+            }
+            #endif
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* ipconfigTCP_SERVER_WORKERS */
+
+    void FreeRTOS_TCPServerGetAdmissionStats( TCPServer_t * pxServer,
+                                              TCPServerAdmissionStats_t * pxStats )
+    {
+        memset( pxStats, '\0', sizeof( *pxStats ) );
+
+        #if ( tcpserverUSE_ADMISSION != 0 )
+        {
+            taskENTER_CRITICAL();
+            {
+                pxStats->uxClients = pxServer->uxAdmitted;
+                pxStats->uxWindowMemory = pxServer->uxWindowMemory;
+            }
+            taskEXIT_CRITICAL();
+
+            pxStats->uxWaiting = pxServer->uxWaitingCount;
+            pxStats->ulQueued = pxServer->ulQueued;
+            pxStats->ulRefused = pxServer->ulRefused;
+        }
+        #else
+        {
+            ( void ) pxServer;
+        }
+        #endif
     }
 /*-----------------------------------------------------------*/
 
+    #if ( tcpserverUSE_ADMISSION != 0 )
+
+        static size_t prvWindowMemory( enum eSERVER_TYPE eType )
+        {
+            /* The accepted socket gets the default buffers, unless the
+             * listening socket has other window properties. */
+            size_t uxSize = ( size_t ) ( ipconfigTCP_TX_BUFFER_LENGTH + ipconfigTCP_RX_BUFFER_LENGTH );
+
+            #if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_RX_BUFSIZE > 0 )
+            {
+                if( eType == eSERVER_HTTP )
+                {
+                    uxSize = ( size_t ) ( ipconfigHTTP_TX_BUFSIZE + ipconfigHTTP_RX_BUFSIZE );
+                }
+            }
+            #endif
+
+            #if ( ipconfigUSE_FTP != 0 ) && ( ipconfigFTP_TX_BUFSIZE > 0 )
+            {
+                if( eType == eSERVER_FTP )
+                {
+                    /* Add the data connection. */
+                    uxSize += ( size_t ) ( ipconfigFTP_TX_BUFSIZE + ipconfigFTP_RX_BUFSIZE );
+                }
+            }
+            #endif
+
+            ( void ) eType;
+
+            return uxSize;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvAdmit( TCPServer_t * pxServer,
+                                    BaseType_t xIndex )
+        {
+            BaseType_t xResult = pdTRUE;
+
+            /* Only the accepting server increases the counters, so they can
+             * only be too high, in which case the client waits a bit longer. */
+            #if ( ipconfigTCP_SERVER_MAX_CLIENTS > 0 )
+            {
+                if( pxServer->uxAdmitted >= ( UBaseType_t ) ipconfigTCP_SERVER_MAX_CLIENTS )
+                {
+                    xResult = pdFALSE;
+                }
+            }
+            #endif
+
+            #if ( ipconfigTCP_SERVER_MAX_WINDOW_MEMORY > 0 )
+            {
+                if( pxServer->uxWindowMemory + prvWindowMemory( pxServer->xServers[ xIndex ].eType ) > ( size_t ) ipconfigTCP_SERVER_MAX_WINDOW_MEMORY )
+                {
+                    xResult = pdFALSE;
+                }
+            }
+            #endif
+
+            ( void ) xIndex;
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvAdmissionTake( TCPServer_t * pxServer,
+                                      enum eSERVER_TYPE eType )
+        {
+            size_t uxSize = prvWindowMemory( eType );
+
+            taskENTER_CRITICAL();
+            {
+                pxServer->uxAdmitted++;
+                pxServer->uxWindowMemory += uxSize;
+            }
+            taskEXIT_CRITICAL();
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvAdmissionRelease( TCPServer_t * pxServer,
+                                         enum eSERVER_TYPE eType )
+        {
+            size_t uxSize = prvWindowMemory( eType );
+
+            /* Workers release their clients from their own tasks. */
+            taskENTER_CRITICAL();
+            {
+                pxServer->uxAdmitted--;
+                pxServer->uxWindowMemory -= uxSize;
+            }
+            taskEXIT_CRITICAL();
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvAcceptOrWait( TCPServer_t * pxServer,
+                                     BaseType_t xIndex,
+                                     Socket_t xNexSocket )
+        {
+            if( ( pxServer->uxWaitingCount == 0U ) && ( prvAdmit( pxServer, xIndex ) != pdFALSE ) )
+            {
+                prvReceiveNewClient( pxServer, xIndex, xNexSocket );
+            }
+            else if( pxServer->uxWaitingCount < ( UBaseType_t ) ipconfigTCP_SERVER_MAX_WAITING )
+            {
+                /* Wait behind the connections that arrived earlier. */
+                TCPWaiting_t * pxWaiting = &( pxServer->xWaiting[ pxServer->uxWaitingCount ] );
+
+                pxWaiting->xSocket = xNexSocket;
+                pxWaiting->xIndex = xIndex;
+                pxWaiting->xSince = xTaskGetTickCount();
+                pxWaiting->xRefused = pdFALSE;
+                pxServer->uxWaitingCount++;
+                FreeRTOS_printf( ( "TCP-server: limit reached, %u connections waiting\n", ( unsigned ) pxServer->uxWaitingCount ) );
+            }
+            else
+            {
+                /* No room to wait, not even to wait for a graceful close. */
+                prvRefuse( pxServer, xIndex, xNexSocket );
+                FreeRTOS_closesocket( xNexSocket );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvRefuse( TCPServer_t * pxServer,
+                               BaseType_t xIndex,
+                               Socket_t xSocket )
+        {
+            const char * pcReply = NULL;
+
+            #if ( ipconfigUSE_HTTP != 0 )
+            {
+                if( pxServer->xServers[ xIndex ].eType == eSERVER_HTTP )
+                {
+                    pcReply = "HTTP/1.1 503 Service Unavailable\r\n"
+                              "Retry-After: 1\r\n"
+                              "Content-Length: 0\r\n"
+                              "Connection: close\r\n"
+                              "\r\n";
+                }
+            }
+            #endif
+
+            #if ( ipconfigUSE_FTP != 0 )
+            {
+                if( pxServer->xServers[ xIndex ].eType == eSERVER_FTP )
+                {
+                    pcReply = "421 Too many connections, try again later.\r\n";
+                }
+            }
+            #endif
+
+            if( pcReply != NULL )
+            {
+                FreeRTOS_send( xSocket, pcReply, strlen( pcReply ), 0 );
+            }
+
+            FreeRTOS_shutdown( xSocket, FREERTOS_SHUT_RDWR );
+            pxServer->ulRefused++;
+            FreeRTOS_printf( ( "TCP-server: connection refused (%u)\n", ( unsigned ) pxServer->ulRefused ) );
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvServiceWaiting( TCPServer_t * pxServer )
+        {
+            TickType_t xNow = xTaskGetTickCount();
+            TickType_t xMaxWait = pdMS_TO_TICKS( ipconfigTCP_SERVER_MAX_WAIT_MS );
+            BaseType_t xMayAdmit = pdTRUE;
+            UBaseType_t uxIndex = 0U;
+
+            while( uxIndex < pxServer->uxWaitingCount )
+            {
+                TCPWaiting_t * pxWaiting = &( pxServer->xWaiting[ uxIndex ] );
+                BaseType_t xRemove = pdFALSE;
+
+                if( pxWaiting->xRefused != pdFALSE )
+                {
+                    /* Give the refusal time to arrive before closing. */
+                    if( ( FreeRTOS_issocketconnected( pxWaiting->xSocket ) == pdFALSE ) || ( ( xNow - pxWaiting->xSince ) >= xMaxWait ) )
+                    {
+                        FreeRTOS_closesocket( pxWaiting->xSocket );
+                        xRemove = pdTRUE;
+                    }
+                }
+                else if( FreeRTOS_issocketconnected( pxWaiting->xSocket ) == pdFALSE )
+                {
+                    /* The peer gave up. */
+                    FreeRTOS_closesocket( pxWaiting->xSocket );
+                    xRemove = pdTRUE;
+                }
+                else if( ( xMayAdmit != pdFALSE ) && ( prvAdmit( pxServer, pxWaiting->xIndex ) != pdFALSE ) )
+                {
+                    pxServer->ulQueued++;
+                    prvReceiveNewClient( pxServer, pxWaiting->xIndex, pxWaiting->xSocket );
+                    xRemove = pdTRUE;
+                }
+                else
+                {
+                    /* Admit in order of arrival. */
+                    xMayAdmit = pdFALSE;
+
+                    if( ( xNow - pxWaiting->xSince ) >= xMaxWait )
+                    {
+                        prvRefuse( pxServer, pxWaiting->xIndex, pxWaiting->xSocket );
+                        pxWaiting->xRefused = pdTRUE;
+                        pxWaiting->xSince = xNow;
+                    }
+                }
+
+                if( xRemove != pdFALSE )
+                {
+                    pxServer->uxWaitingCount--;
+                    memmove( pxWaiting, pxWaiting + 1, ( pxServer->uxWaitingCount - uxIndex ) * sizeof( *pxWaiting ) );
+                }
+                else
+                {
+                    uxIndex++;
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* tcpserverUSE_ADMISSION */
+
     static char * strnew( const char * pcString )
     {
         BaseType_t xLength;
@@ -330,6 +891,104 @@
     }
 /*-----------------------------------------------------------*/
 
+    BaseType_t xTCPServerSendFile( Socket_t xSocket,
+                                   FF_FILE * pxFile,
+                                   size_t * puxBytesLeft,
+                                   char * pcBuffer,
+                                   size_t uxBufferSize,
+                                   BaseType_t xFlags )
+    {
+        BaseType_t xRc = 0;
+        BaseType_t xTotal = 0;
+
+        while( *puxBytesLeft > 0u )
+        {
+            size_t uxCount;
+            size_t uxOffset;
+            size_t uxItemsRead;
+            char * pcTarget = pcBuffer;
+
+            uxCount = FreeRTOS_min_uint32( *puxBytesLeft, ( uint32_t ) FreeRTOS_tx_space( xSocket ) );
+
+            if( ( xFlags & tcpserverSEND_ZERO_COPY ) != 0 )
+            {
+                BaseType_t xHeadLength;
+                char * pcHead;
+
+                /* FreeRTOS_get_tx_head() returns a direct pointer to the TX stream
+                 * and sets xHeadLength to the space there is before it wraps. */
+                pcHead = ( char * ) FreeRTOS_get_tx_head( xSocket, &xHeadLength );
+
+                if( ( pcHead != NULL ) && ( xHeadLength >= ( BaseType_t ) ipconfigTCP_SERVER_FILE_BLOCK_SIZE ) )
+                {
+                    pcTarget = pcHead;
+                    uxCount = FreeRTOS_min_uint32( uxCount, ( uint32_t ) xHeadLength );
+                }
+            }
+
+            if( pcTarget == pcBuffer )
+            {
+                uxCount = FreeRTOS_min_uint32( uxCount, uxBufferSize );
+            }
+
+            /* Make the reads end on a sector boundary, so that all but the first
+             * and the last one are whole, aligned sectors. */
+            if( uxCount < *puxBytesLeft )
+            {
+                uxOffset = ( size_t ) ff_ftell( pxFile ) % ipconfigTCP_SERVER_FILE_BLOCK_SIZE;
+
+                if( uxCount + uxOffset >= ipconfigTCP_SERVER_FILE_BLOCK_SIZE )
+                {
+                    uxCount -= ( uxCount + uxOffset ) % ipconfigTCP_SERVER_FILE_BLOCK_SIZE;
+                }
+            }
+
+            if( uxCount == 0u )
+            {
+                break;
+            }
+
+            uxItemsRead = ff_fread( pcTarget, 1, uxCount, pxFile );
+
+            if( uxItemsRead != uxCount )
+            {
+                FreeRTOS_printf( ( "xTCPServerSendFile: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
+                FreeRTOS_shutdown( xSocket, FREERTOS_SHUT_RDWR );
+                *puxBytesLeft = 0u;
+                xRc = -pdFREERTOS_ERRNO_EIO;
+                break;
+            }
+
+            *puxBytesLeft -= uxCount;
+
+            if( ( *puxBytesLeft == 0u ) && ( ( xFlags & tcpserverSEND_CLOSE_AFTER_SEND ) != 0 ) )
+            {
+                BaseType_t xTrueValue = 1;
+
+                FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
+            }
+
+            /* A NULL buffer tells FreeRTOS_send() that the data is already in
+             * the TX stream. */
+            xRc = FreeRTOS_send( xSocket, ( pcTarget == pcBuffer ) ? pcBuffer : NULL, uxCount, 0 );
+
+            if( xRc < 0 )
+            {
+                break;
+            }
+
+            xTotal += xRc;
+        }
+
+        if( xRc >= 0 )
+        {
+            xRc = xTotal;
+        }
+
+        return xRc;
+    }
+/*-----------------------------------------------------------*/
+
     #if ( ipconfigSUPPORT_SIGNALS != 0 )
 
 /* FreeRTOS_TCPServerWork() calls select().
@@ -96,6 +96,22 @@
         #define ipconfigFTP_ZERO_COPY_ALIGNED_WRITES    0
     #endif
 
+    #if !defined( ipconfigFTP_PREFERRED_WRITE_SIZE )
+
+/* If you store data on flash, it may be profitable to give 'ipconfigFTP_PREFERRED_WRITE_SIZE'
+ * the same size as the size of the flash' erase blocks, e.g. 4KB */
+        #define ipconfigFTP_PREFERRED_WRITE_SIZE    512ul
+    #endif
+
+/*
+ * ipconfigFTP_STREAM_REPORT_MS : when streaming (ipconfigFTP_STREAMING), log the
+ * progress and the average speed of a transfer this often.  Zero: only log
+ * the totals at the end of a transfer.
+ */
+    #ifndef ipconfigFTP_STREAM_REPORT_MS
+        #define ipconfigFTP_STREAM_REPORT_MS    5000
+    #endif
+
 /*
  * This module only has 2 public functions:
  */
@@ -235,12 +251,39 @@
     static BaseType_t prvListSendPrep( FTPClient_t * pxClient );
     static BaseType_t prvListSendWork( FTPClient_t * pxClient );
 
+    #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+
+/*
+ * Find a listing of pcDirectory that is not stale, or claim an entry to store
+ * a new one in.  Both return NULL when there is none.
+ */
+        static FTPListCacheEntry_t * prvListCacheFind( FTPClient_t * pxClient,
+                                                       const char * pcDirectory );
+        static FTPListCacheEntry_t * prvListCacheClaim( FTPClient_t * pxClient,
+                                                        const char * pcDirectory );
+
+/*
+ * Stop storing or sending pxClient->pxListCache.
+ */
+        static void prvListCacheRelease( FTPClient_t * pxClient );
+
+/*
+ * LIST: send a cached listing.
+ */
+        static BaseType_t prvListSendCached( FTPClient_t * pxClient );
+
+/* Incremented each time the file system is changed through an FTP server,
+ * which makes all cached listings stale.  All workers share it. */
+        static volatile uint32_t ulListGeneration = 0U;
+    #endif /* ipconfigFTP_LIST_CACHE_ENTRIES */
+
 /*
  * RETR: Send a file to the FTP client.
  */
     static BaseType_t prvRetrieveFilePrep( FTPClient_t * pxClient,
                                            char * pcFileName );
     static BaseType_t prvRetrieveFileWork( FTPClient_t * pxClient );
+    static BaseType_t prvRetrieveFileDirect( FTPClient_t * pxClient );
 
 /*
  * STOR: Receive a file from the FTP client and store it.
@@ -248,6 +291,20 @@
     static BaseType_t prvStoreFilePrep( FTPClient_t * pxClient,
                                         char * pcFileName );
     static BaseType_t prvStoreFileWork( FTPClient_t * pxClient );
+    static BaseType_t prvStoreFileDirect( FTPClient_t * pxClient );
+
+    #if ( ipconfigFTP_STREAMING != 0 )
+
+/*
+ * Streaming versions of STOR and RETR, which use the staging buffer pucStream.
+ */
+        static uint8_t * prvStreamBuffer( FTPClient_t * pxClient );
+        static BaseType_t prvStoreFileStream( FTPClient_t * pxClient );
+        static BaseType_t prvStoreFileFlush( FTPClient_t * pxClient,
+                                             BaseType_t xFinal );
+        static BaseType_t prvRetrieveFileStream( FTPClient_t * pxClient );
+        static void prvStreamReport( FTPClient_t * pxClient );
+    #endif
 
 /*
  * Print/format a single directory entry in Unix style.
@@ -906,6 +963,25 @@
             pxClient->bits.bInRename = pdFALSE_UNSIGNED;
         }
 
+        #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+        {
+            switch( pxFTPCommand->ucCommandType )
+            {
+                case ECMD_STOR:
+                case ECMD_DELE:
+                case ECMD_RNTO:
+                case ECMD_MKD:
+                case ECMD_RMD:
+                    /* Whether it succeeded or not, cached listings may be wrong now. */
+                    vFTPServerFlushListCache();
+                    break;
+
+                default:
+                    break;
+            }
+        }
+        #endif /* ipconfigFTP_LIST_CACHE_ENTRIES */
+
         if( pcMyReply != NULL )
         {
             xResult = prvSendReply( pxClient->xSocket, pcMyReply, strlen( pcMyReply ) );
@@ -1172,6 +1248,17 @@
             BaseType_t xLength;
             char pcStrBuf[ 32 ];
 
+            #if ( ipconfigFTP_STREAMING != 0 )
+            {
+                /* Write the bytes still waiting in the staging buffer now, so
+                 * that a write error is reported with a 451. */
+                if( ( pxClient->pucStream != NULL ) && ( pxClient->pxWriteHandle != NULL ) )
+                {
+                    ( void ) prvStoreFileFlush( pxClient, pdTRUE );
+                }
+            }
+            #endif /* ipconfigFTP_STREAMING */
+
             if( pxClient->bits1.bHadError == pdFALSE_UNSIGNED )
             {
                 xLength = snprintf( pxClient->pcClientAck, sizeof( pxClient->pcClientAck ),
@@ -1223,15 +1310,40 @@
         pxClient->bits1.bDirHasEntry = pdFALSE_UNSIGNED;
         pxClient->bits1.bClientConnected = pdFALSE_UNSIGNED;
         pxClient->bits1.bHadError = pdFALSE_UNSIGNED;
+
+        #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+        {
+            /* A listing that was not sent completely is not stored either. */
+            prvListCacheRelease( pxClient );
+        }
+        #endif
     }
 /*-----------------------------------------------------------*/
 
     static void prvTransferCloseFile( FTPClient_t * pxClient )
     {
+        #if ( ipconfigFTP_STREAMING != 0 )
+        {
+            if( pxClient->pucStream != NULL )
+            {
+                ( void ) prvStoreFileFlush( pxClient, pdTRUE );
+                vPortFreeLarge( pxClient->pucStream );
+                pxClient->pucStream = NULL;
+                pxClient->uxStreamCount = 0u;
+            }
+        }
+        #endif /* ipconfigFTP_STREAMING */
+
         if( pxClient->pxWriteHandle != NULL )
         {
             ff_fclose( pxClient->pxWriteHandle );
             pxClient->pxWriteHandle = NULL;
+            #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+            {
+                /* The size of the file has changed while it was received. */
+                vFTPServerFlushListCache();
+            }
+            #endif
             #if ( ipconfigFTP_HAS_RECEIVED_HOOK != 0 )
             {
                 vApplicationFTPReceivedHook( pxClient->pcFileName, pxClient->ulRecvBytes, pxClient );
@@ -1542,7 +1654,7 @@
 
     #if ( ipconfigFTP_ZERO_COPY_ALIGNED_WRITES == 0 )
 
-        static BaseType_t prvStoreFileWork( FTPClient_t * pxClient )
+        static BaseType_t prvStoreFileDirect( FTPClient_t * pxClient )
         {
             BaseType_t xRc, xWritten;
 
@@ -1579,14 +1691,7 @@
 
     #else /* ipconfigFTP_ZERO_COPY_ALIGNED_WRITES != 0 */
 
-        #if !defined( ipconfigFTP_PREFERRED_WRITE_SIZE )
-
-/* If you store data on flash, it may be profitable to give 'ipconfigFTP_PREFERRED_WRITE_SIZE'
- * the same size as the size of the flash' erase blocks, e.g. 4KB */
-            #define ipconfigFTP_PREFERRED_WRITE_SIZE    512ul
-        #endif
-
-        static BaseType_t prvStoreFileWork( FTPClient_t * pxClient )
+        static BaseType_t prvStoreFileDirect( FTPClient_t * pxClient )
         {
             BaseType_t xRc, xWritten;
 
@@ -1680,6 +1785,32 @@
     #endif /* ipconfigFTP_ZERO_COPY_ALIGNED_WRITES */
 /*-----------------------------------------------------------*/
 
+    static BaseType_t prvStoreFileWork( FTPClient_t * pxClient )
+    {
+        BaseType_t xRc;
+
+        #if ( ipconfigFTP_STREAMING != 0 )
+        {
+            /* Without memory for a staging buffer, write directly. */
+            if( prvStreamBuffer( pxClient ) != NULL )
+            {
+                xRc = prvStoreFileStream( pxClient );
+            }
+            else
+            {
+                xRc = prvStoreFileDirect( pxClient );
+            }
+        }
+        #else
+        {
+            xRc = prvStoreFileDirect( pxClient );
+        }
+        #endif /* ipconfigFTP_STREAMING */
+
+        return xRc;
+    }
+/*-----------------------------------------------------------*/
+
 /*
  ######                          #                           #######   #   ###
  #    #          #              #                            #   ##   #     #
@@ -1800,182 +1931,321 @@
     }
 /*-----------------------------------------------------------*/
 
-    static BaseType_t prvRetrieveFileWork( FTPClient_t * pxClient )
+    static BaseType_t prvRetrieveFileDirect( FTPClient_t * pxClient )
     {
-        size_t uxSpace;
-        size_t uxCount, uxItemsRead;
-        BaseType_t xRc = 0;
+        BaseType_t xRc;
+        BaseType_t xFlags = tcpserverSEND_CLOSE_AFTER_SEND;
         BaseType_t xSetEvent = pdFALSE;
 
-        do
+        #if ( ipconfigFTP_TX_ZERO_COPY != 0 )
         {
-            #if ( ipconfigFTP_TX_ZERO_COPY != 0 )
-                char * pcBuffer;
-                BaseType_t xBufferLength;
-            #endif /* ipconfigFTP_TX_ZERO_COPY */
+            /* Read disk data directly into the TX stream of the socket. */
+            xFlags |= tcpserverSEND_ZERO_COPY;
+        }
+        #endif
 
-            /* Take the lesser of the two: tx_space (number of bytes that can be
-             * queued for transmission) and uxBytesLeft (the number of bytes left to
-             * read from the file) */
-            uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
+        if( FreeRTOS_tx_space( pxClient->xTransferSocket ) == 0 )
+        {
+            FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE | eSELECT_EXCEPT );
+            ( void ) FreeRTOS_select( pxClient->pxParent->xSocketSet, 200 );
+        }
 
-            if( uxSpace == 0 )
-            {
-                FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE | eSELECT_EXCEPT );
-                xRc = FreeRTOS_select( pxClient->pxParent->xSocketSet, 200 );
-                uxSpace = FreeRTOS_tx_space( pxClient->xTransferSocket );
-            }
+        /* Queue as much of the file as the TX stream will take.  The last
+         * block sets FREERTOS_SO_CLOSE_AFTER_SEND. */
+        xRc = xTCPServerSendFile( pxClient->xTransferSocket, pxClient->pxReadHandle, &( pxClient->uxBytesLeft ),
+                                  pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), xFlags );
 
-            uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, uxSpace );
+        if( xRc > 0 )
+        {
+            pxClient->ulRecvBytes += xRc;
+        }
+        else if( xRc == -pdFREERTOS_ERRNO_EIO )
+        {
+            /* bHadError: a transfer got aborted because of an error. */
+            pxClient->bits1.bHadError = pdTRUE_UNSIGNED;
+        }
 
-            if( uxCount == 0 )
-            {
-                break;
-            }
+        if( xRc < 0 )
+        {
+            FreeRTOS_printf( ( "prvRetrieveFileWork: already disconnected\n" ) );
+        }
+        else if( pxClient->uxBytesLeft <= 0u )
+        {
+            BaseType_t x;
 
-            #if ( ipconfigFTP_TX_ZERO_COPY == 0 )
+            for( x = 0; x < 5; x++ )
             {
-                if( uxCount > sizeof( pcFILE_BUFFER ) )
-                {
-                    uxCount = sizeof( pcFILE_BUFFER );
-                }
-
-                uxItemsRead = ff_fread( pcFILE_BUFFER, 1, uxCount, pxClient->pxReadHandle );
+                xRc = FreeRTOS_recv( pxClient->xTransferSocket, pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), 0 );
 
-                if( uxItemsRead != uxCount )
+                if( xRc < 0 )
                 {
-                    FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
-                    xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
-                    pxClient->uxBytesLeft = 0u;
                     break;
                 }
+            }
 
-                pxClient->uxBytesLeft -= uxCount;
+/*		FreeRTOS_printf( ( "prvRetrieveFileWork: %s all sent: xRc %ld\n", pxClient->pcFileName, xRc ) ); */
+        }
+        else
+        {
+            FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+            xSetEvent = pdTRUE;
+        }
 
-                if( pxClient->uxBytesLeft == 0u )
-                {
-                    BaseType_t xTrueValue = 1;
+        if( xSetEvent == pdFALSE )
+        {
+            FreeRTOS_FD_CLR( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+        }
 
-                    FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
-                }
+        return xRc;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvRetrieveFileWork( FTPClient_t * pxClient )
+    {
+        BaseType_t xRc;
+
+        #if ( ipconfigFTP_STREAMING != 0 )
+        {
+            /* Without memory for a staging buffer, read into the TX stream. */
+            if( prvStreamBuffer( pxClient ) != NULL )
+            {
+                xRc = prvRetrieveFileStream( pxClient );
+            }
+            else
+            {
+                xRc = prvRetrieveFileDirect( pxClient );
+            }
+        }
+        #else
+        {
+            xRc = prvRetrieveFileDirect( pxClient );
+        }
+        #endif /* ipconfigFTP_STREAMING */
+
+        return xRc;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ipconfigFTP_STREAMING != 0 )
 
-                xRc = FreeRTOS_send( pxClient->xTransferSocket, pcFILE_BUFFER, uxCount, 0 );
+        static uint8_t * prvStreamBuffer( FTPClient_t * pxClient )
+        {
+            if( pxClient->pucStream == NULL )
+            {
+                pxClient->pucStream = ( uint8_t * ) pvPortMallocLarge( ipconfigFTP_STREAM_BUFFER_SIZE );
+                pxClient->uxStreamStart = 0u;
+                pxClient->uxStreamCount = 0u;
+                pxClient->xLastReport = xTaskGetTickCount();
             }
-            #else /* ipconfigFTP_TX_ZERO_COPY != 0 */
+
+            return pxClient->pucStream;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvStoreFileStream( FTPClient_t * pxClient )
+        {
+            BaseType_t xRc;
+
+            for( ; ; )
             {
-                /* Use zero-copy transmission:
-                 * FreeRTOS_get_tx_head() returns a direct pointer to the TX stream and
-                 * set xBufferLength to know how much space there is left. */
-                pcBuffer = ( char * ) FreeRTOS_get_tx_head( pxClient->xTransferSocket, &xBufferLength );
+                size_t uxSpace = ipconfigFTP_STREAM_BUFFER_SIZE - pxClient->uxStreamCount;
 
-                if( ( pcBuffer != NULL ) && ( xBufferLength >= 512 ) )
+                /* Move data from the RX stream to the staging buffer.  The space
+                 * freed in the RX stream re-opens the TCP window, so the peer keeps
+                 * sending while the data is being written to disk. */
+                if( uxSpace > 0u )
                 {
-                    /* Will read disk data directly to the TX stream of the socket. */
-                    uxCount = FreeRTOS_min_uint32( uxCount, ( uint32_t ) xBufferLength );
+                    xRc = FreeRTOS_recv( pxClient->xTransferSocket, ( void * ) ( pxClient->pucStream + pxClient->uxStreamCount ),
+                                         uxSpace, FREERTOS_MSG_DONTWAIT );
 
-                    if( uxCount > ( size_t ) 0x40000u )
+                    if( xRc > 0 )
                     {
-                        uxCount = ( size_t ) 0x40000u;
+                        pxClient->ulRecvBytes += xRc;
+                        pxClient->uxStreamCount += ( size_t ) xRc;
+
+                        if( ( size_t ) xRc < uxSpace )
+                        {
+                            /* See if more data has arrived in the mean time. */
+                            continue;
+                        }
                     }
                 }
                 else
                 {
-                    /* Use the normal file i/o buffer. */
-                    pcBuffer = pcFILE_BUFFER;
-
-                    if( uxCount > sizeof( pcFILE_BUFFER ) )
-                    {
-                        uxCount = sizeof( pcFILE_BUFFER );
-                    }
+                    xRc = 1;
                 }
 
-                if( pxClient->uxBytesLeft >= 1024u )
+                /* A negative xRc means that the connection is closed and that the
+                 * RX stream is empty: write everything that is left. */
+                if( prvStoreFileFlush( pxClient, ( xRc < 0 ) ? pdTRUE : pdFALSE ) == pdFAIL )
                 {
-                    uxCount &= ~( ( size_t ) 512u - 1u );
+                    xRc = -1;
                 }
 
-                if( uxCount <= 0u )
+                if( xRc <= 0 )
                 {
-                    /* Nothing to send after rounding down to a multiple of a sector size. */
                     break;
                 }
+            }
 
-                uxItemsRead = ff_fread( pcBuffer, 1, uxCount, pxClient->pxReadHandle );
+            prvStreamReport( pxClient );
 
-                if( uxCount != uxItemsRead )
+            return xRc;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvStoreFileFlush( FTPClient_t * pxClient,
+                                             BaseType_t xFinal )
+        {
+            size_t uxCount = pxClient->uxStreamCount;
+            BaseType_t xResult = pdPASS;
+
+            /* Write whole blocks of ipconfigFTP_PREFERRED_WRITE_SIZE bytes, unless
+             * this is the end of the file, or when the block doesn't even fit. */
+            if( ( xFinal == pdFALSE ) && ( uxCount < ipconfigFTP_STREAM_BUFFER_SIZE ) )
+            {
+                uxCount -= uxCount % ipconfigFTP_PREFERRED_WRITE_SIZE;
+            }
+
+            if( ( uxCount > 0u ) && ( pxClient->pxWriteHandle != NULL ) && ( pxClient->bits1.bHadError == pdFALSE_UNSIGNED ) )
+            {
+                if( ff_fwrite( pxClient->pucStream, 1, uxCount, pxClient->pxWriteHandle ) != uxCount )
                 {
-                    FreeRTOS_printf( ( "prvRetrieveFileWork: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
-                    xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
-                    pxClient->uxBytesLeft = 0u;
-                    break;
+                    /* bHadError: a transfer got aborted because of an error. */
+                    pxClient->bits1.bHadError = pdTRUE_UNSIGNED;
+                    pxClient->uxStreamCount = 0u;
+                    xResult = pdFAIL;
+                }
+                else
+                {
+                    pxClient->uxStreamCount -= uxCount;
+                    memmove( pxClient->pucStream, pxClient->pucStream + uxCount, pxClient->uxStreamCount );
+                }
+            }
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvRetrieveFileStream( FTPClient_t * pxClient )
+        {
+            size_t uxCount, uxItemsRead;
+            BaseType_t xRc = 0;
+
+            for( ; ; )
+            {
+                if( ( pxClient->uxStreamCount == 0u ) && ( pxClient->uxBytesLeft > 0u ) )
+                {
+                    /* Read the next block while the IP task is still sending the
+                     * previous one from the TX stream. */
+                    uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, ipconfigFTP_STREAM_BUFFER_SIZE );
+                    uxItemsRead = ff_fread( pxClient->pucStream, 1, uxCount, pxClient->pxReadHandle );
+
+                    if( uxItemsRead != uxCount )
+                    {
+                        FreeRTOS_printf( ( "prvRetrieveFileStream: Got %u Expected %u\n", ( unsigned ) uxItemsRead, ( unsigned ) uxCount ) );
+                        xRc = FreeRTOS_shutdown( pxClient->xTransferSocket, FREERTOS_SHUT_RDWR );
+                        pxClient->uxBytesLeft = 0u;
+                        break;
+                    }
+
+                    pxClient->uxBytesLeft -= uxCount;
+                    pxClient->uxStreamStart = 0u;
+                    pxClient->uxStreamCount = uxCount;
                 }
 
-                pxClient->uxBytesLeft -= uxCount;
+                /* Queue as much as the TX stream will take, without blocking. */
+                uxCount = FreeRTOS_min_uint32( pxClient->uxStreamCount, ( uint32_t ) FreeRTOS_tx_space( pxClient->xTransferSocket ) );
+
+                if( uxCount == 0u )
+                {
+                    break;
+                }
 
-                if( pxClient->uxBytesLeft == 0u )
+                if( ( pxClient->uxBytesLeft == 0u ) && ( uxCount == pxClient->uxStreamCount ) )
                 {
                     BaseType_t xTrueValue = 1;
 
                     FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
                 }
 
-                if( pcBuffer != pcFILE_BUFFER )
+                xRc = FreeRTOS_send( pxClient->xTransferSocket, pxClient->pucStream + pxClient->uxStreamStart, uxCount, 0 );
+
+                if( xRc <= 0 )
                 {
-                    pcBuffer = NULL;
+                    break;
                 }
 
-                xRc = FreeRTOS_send( pxClient->xTransferSocket, pcBuffer, uxCount, 0 );
+                pxClient->ulRecvBytes += xRc;
+                pxClient->uxStreamStart += ( size_t ) xRc;
+                pxClient->uxStreamCount -= ( size_t ) xRc;
             }
-            #endif /* ipconfigFTP_TX_ZERO_COPY */
 
             if( xRc < 0 )
             {
-                break;
+                FreeRTOS_printf( ( "prvRetrieveFileStream: already disconnected\n" ) );
             }
+            else if( ( pxClient->uxBytesLeft == 0u ) && ( pxClient->uxStreamCount == 0u ) )
+            {
+                BaseType_t x;
 
-            pxClient->ulRecvBytes += xRc;
+                FreeRTOS_FD_CLR( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+
+                /* Everything is queued, FREERTOS_SO_CLOSE_AFTER_SEND will close
+                 * the connection, and recv() will return a negative value. */
+                for( x = 0; x < 5; x++ )
+                {
+                    xRc = FreeRTOS_recv( pxClient->xTransferSocket, pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), 0 );
 
-            if( pxClient->uxBytesLeft == 0u )
+                    if( xRc < 0 )
+                    {
+                        break;
+                    }
+                }
+            }
+            else
             {
-                break;
+                /* Wake up as soon as there is TX space again. */
+                FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
             }
-        } while( uxCount > 0u );
 
-        if( xRc < 0 )
-        {
-            FreeRTOS_printf( ( "prvRetrieveFileWork: already disconnected\n" ) );
+            prvStreamReport( pxClient );
+
+            return xRc;
         }
-        else if( pxClient->uxBytesLeft <= 0u )
-        {
-            BaseType_t x;
+/*-----------------------------------------------------------*/
 
-            for( x = 0; x < 5; x++ )
+        static void prvStreamReport( FTPClient_t * pxClient )
+        {
+            #if ( ipconfigHAS_PRINTF != 0 ) && ( ipconfigFTP_STREAM_REPORT_MS > 0 )
             {
-                xRc = FreeRTOS_recv( pxClient->xTransferSocket, pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), 0 );
+                TickType_t xNow = xTaskGetTickCount();
 
-                if( xRc < 0 )
+                if( ( xNow - pxClient->xLastReport ) >= pdMS_TO_TICKS( ipconfigFTP_STREAM_REPORT_MS ) )
                 {
-                    break;
-                }
-            }
+                    char pcStrBuf[ 32 ];
+                    uint32_t ulAverage;
 
-/*		FreeRTOS_printf( ( "prvRetrieveFileWork: %s all sent: xRc %ld\n", pxClient->pcFileName, xRc ) ); */
-        }
-        else
-        {
-            FreeRTOS_FD_SET( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
-            xSetEvent = pdTRUE;
-        }
+                    pxClient->xLastReport = xNow;
+                    ulAverage = ulGetAverage( pxClient->ulRecvBytes, ( xNow - pxClient->xStartTime ) * portTICK_PERIOD_MS );
 
-        if( xSetEvent == pdFALSE )
-        {
-            FreeRTOS_FD_CLR( pxClient->xTransferSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+                    FreeRTOS_printf( ( "FTP: %s: '%s' %lu Bytes so far (%s/sec)\n",
+                                       pxClient->pxReadHandle ? "sending" : "receiving",
+                                       pxClient->pcFileName,
+                                       pxClient->ulRecvBytes,
+                                       pcMkSize( ulAverage, pcStrBuf, sizeof( pcStrBuf ) ) ) );
+                }
+            }
+            #else
+            {
+                ( void ) pxClient;
+            }
+            #endif /* if ( ipconfigHAS_PRINTF != 0 ) && ( ipconfigFTP_STREAM_REPORT_MS > 0 ) */
         }
-
-        return xRc;
-    }
 /*-----------------------------------------------------------*/
 
+    #endif /* ipconfigFTP_STREAMING */
+
 /*
  ###     #####  ####  #####
  #        #   #    # # # #
@@ -2016,6 +2286,34 @@
         pxClient->xDirCount = 0;
         xMakeAbsolute( pxClient, pcNEW_DIR, sizeof( pcNEW_DIR ), pxClient->pcCurrentDir );
 
+        #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+        {
+            prvListCacheRelease( pxClient );
+            pxClient->pxListCache = prvListCacheFind( pxClient, pcNEW_DIR );
+
+            if( pxClient->pxListCache != NULL )
+            {
+                FreeRTOS_printf( ( "prvListSendPrep: cached (%s)\n", pcNEW_DIR ) );
+                pxClient->pxListCache->uxUsers++;
+                pxClient->uxListOffset = 0U;
+                pxClient->xDirCount = pxClient->pxListCache->xDirCount;
+                pxClient->bits1.bListFromCache = pdTRUE_UNSIGNED;
+
+                /* Let xFTPClientWork() call prvListSendWork(). */
+                pxClient->bits1.bDirHasEntry = pdTRUE_UNSIGNED;
+                pxClient->pcClientAck[ 0 ] = '\0';
+
+                /* Although against the coding standard of FreeRTOS, a return is
+                 * done here to avoid reading the directory. */
+                return pxClient->xDirCount;
+            }
+
+            /* Store the listing while it is sent, if there is room. */
+            pxClient->pxListCache = prvListCacheClaim( pxClient, pcNEW_DIR );
+            pxClient->bits1.bListFromCache = pdFALSE_UNSIGNED;
+        }
+        #endif /* ipconfigFTP_LIST_CACHE_ENTRIES */
+
         xFindResult = ff_findfirst( pcNEW_DIR, &pxClient->xFindData );
 
         pxClient->bits1.bDirHasEntry = ( xFindResult >= 0 );
@@ -2034,6 +2332,16 @@
             prvSendReply( pxClient->xSocket, REPL_451, 0 );
         }
 
+        #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+        {
+            if( xFindResult < 0 )
+            {
+                /* Empty directories and errors are not cached. */
+                prvListCacheRelease( pxClient );
+            }
+        }
+        #endif
+
         pxClient->pcClientAck[ 0 ] = '\0';
 
         return pxClient->xDirCount;
@@ -2046,6 +2354,17 @@
     {
         BaseType_t xTxSpace;
 
+        #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+        {
+            if( pxClient->bits1.bListFromCache != pdFALSE_UNSIGNED )
+            {
+                /* Although against the coding standard of FreeRTOS, a return
+                 * is done here to simplify this conditional code. */
+                return prvListSendCached( pxClient );
+            }
+        }
+        #endif
+
         while( pxClient->bits1.bClientConnected != pdFALSE_UNSIGNED )
         {
             char * pcWritePtr = pcCOMMAND_BUFFER;
@@ -2110,6 +2429,36 @@
                           pxClient->xDirCount, ulTotalCount / 1024, ulPercentage );
             }
 
+            #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+            {
+                FTPListCacheEntry_t * pxEntry = pxClient->pxListCache;
+
+                if( pxEntry == NULL )
+                {
+                    /* Not stored. */
+                }
+                else if( pxEntry->uxLength + ( size_t ) xWriteLength > ipconfigFTP_LIST_CACHE_SIZE )
+                {
+                    /* The listing does not fit. */
+                    prvListCacheRelease( pxClient );
+                }
+                else
+                {
+                    memcpy( pxEntry->pcListing + pxEntry->uxLength, pcCOMMAND_BUFFER, ( size_t ) xWriteLength );
+                    pxEntry->uxLength += ( size_t ) xWriteLength;
+
+                    if( pxClient->bits1.bDirHasEntry == pdFALSE_UNSIGNED )
+                    {
+                        /* The listing is complete, it includes the ACK. */
+                        pxEntry->xDirCount = pxClient->xDirCount;
+                        strcpy( pxEntry->pcClientAck, pxClient->pcClientAck );
+                        pxEntry->xComplete = pdTRUE;
+                        prvListCacheRelease( pxClient );
+                    }
+                }
+            }
+            #endif /* ipconfigFTP_LIST_CACHE_ENTRIES */
+
             if( xWriteLength )
             {
                 if( pxClient->bits1.bDirHasEntry == pdFALSE_UNSIGNED )
@@ -2133,6 +2482,180 @@
     }
 /*-----------------------------------------------------------*/
 
+    #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+
+        static BaseType_t prvListSendCached( FTPClient_t * pxClient )
+        {
+            FTPListCacheEntry_t * pxEntry = pxClient->pxListCache;
+            BaseType_t xRc;
+
+            while( ( pxClient->bits1.bClientConnected != pdFALSE_UNSIGNED ) && ( pxClient->uxListOffset < pxEntry->uxLength ) )
+            {
+                const char * pcSource = pxEntry->pcListing + pxClient->uxListOffset;
+                size_t uxCount;
+
+                uxCount = FreeRTOS_min_uint32( pxEntry->uxLength - pxClient->uxListOffset,
+                                               ( uint32_t ) FreeRTOS_tx_space( pxClient->xTransferSocket ) );
+
+                #if ( ipconfigFTP_TX_ZERO_COPY != 0 )
+                {
+                    BaseType_t xHeadLength;
+                    char * pcHead = ( char * ) FreeRTOS_get_tx_head( pxClient->xTransferSocket, &xHeadLength );
+
+                    /* Copy the listing straight into the TX stream. */
+                    if( ( pcHead != NULL ) && ( uxCount > 0U ) )
+                    {
+                        uxCount = FreeRTOS_min_uint32( uxCount, ( uint32_t ) xHeadLength );
+                        memcpy( pcHead, pcSource, uxCount );
+                        pcSource = NULL;
+                    }
+                }
+                #endif /* ipconfigFTP_TX_ZERO_COPY */
+
+                if( uxCount == 0U )
+                {
+                    break;
+                }
+
+                if( pxClient->uxListOffset + uxCount == pxEntry->uxLength )
+                {
+                    BaseType_t xTrueValue = 1;
+
+                    FreeRTOS_setsockopt( pxClient->xTransferSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
+                }
+
+                /* A NULL buffer tells FreeRTOS_send() that the data is already
+                 * in the TX stream. */
+                xRc = FreeRTOS_send( pxClient->xTransferSocket, pcSource, uxCount, 0 );
+
+                if( xRc <= 0 )
+                {
+                    break;
+                }
+
+                pxClient->uxListOffset += ( size_t ) xRc;
+            }
+
+            if( pxClient->uxListOffset >= pxEntry->uxLength )
+            {
+                strcpy( pxClient->pcClientAck, pxEntry->pcClientAck );
+                pxClient->bits1.bDirHasEntry = pdFALSE_UNSIGNED;
+                prvListCacheRelease( pxClient );
+                prvSendReply( pxClient->xSocket, pxClient->pcClientAck, 0 );
+            }
+
+            return 0;
+        }
+/*-----------------------------------------------------------*/
+
+        static FTPListCacheEntry_t * prvListCacheFind( FTPClient_t * pxClient,
+                                                       const char * pcDirectory )
+        {
+            struct xTCP_SERVER * pxParent = pxClient->pxParent;
+            FTPListCacheEntry_t * pxResult = NULL;
+            BaseType_t x;
+
+            for( x = 0; x < ipconfigFTP_LIST_CACHE_ENTRIES; x++ )
+            {
+                FTPListCacheEntry_t * pxEntry = &( pxParent->xListCache[ x ] );
+
+                if( ( pxEntry->xComplete != pdFALSE ) &&
+                    ( pxEntry->ulGeneration == ulListGeneration ) &&
+                    ( strcmp( pxEntry->pcDirectory, pcDirectory ) == 0 ) )
+                {
+                    pxEntry->ulLastUsed = ++pxParent->ulListClock;
+                    pxResult = pxEntry;
+                    break;
+                }
+            }
+
+            return pxResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static FTPListCacheEntry_t * prvListCacheClaim( FTPClient_t * pxClient,
+                                                        const char * pcDirectory )
+        {
+            struct xTCP_SERVER * pxParent = pxClient->pxParent;
+            FTPListCacheEntry_t * pxEntry = NULL;
+            BaseType_t x;
+
+            /* Take a free or a stale entry, or else the least recently used
+             * one that is not being stored or sent. */
+            for( x = 0; x < ipconfigFTP_LIST_CACHE_ENTRIES; x++ )
+            {
+                FTPListCacheEntry_t * pxThis = &( pxParent->xListCache[ x ] );
+
+                if( pxThis->uxUsers != 0U )
+                {
+                    continue;
+                }
+
+                if( ( pxThis->pcDirectory[ 0 ] == '\0' ) || ( pxThis->ulGeneration != ulListGeneration ) )
+                {
+                    pxEntry = pxThis;
+                    break;
+                }
+
+                if( ( pxEntry == NULL ) || ( ( int32_t ) ( pxThis->ulLastUsed - pxEntry->ulLastUsed ) < 0 ) )
+                {
+                    pxEntry = pxThis;
+                }
+            }
+
+            if( ( pxEntry != NULL ) && ( pxEntry->pcListing == NULL ) )
+            {
+                /* The buffer is kept for the next listing stored in the entry. */
+                pxEntry->pcListing = ( char * ) pvPortMallocLarge( ipconfigFTP_LIST_CACHE_SIZE );
+
+                if( pxEntry->pcListing == NULL )
+                {
+                    pxEntry = NULL;
+                }
+            }
+
+            if( pxEntry != NULL )
+            {
+                snprintf( pxEntry->pcDirectory, sizeof( pxEntry->pcDirectory ), "%s", pcDirectory );
+                pxEntry->uxLength = 0U;
+                pxEntry->xComplete = pdFALSE;
+                pxEntry->ulGeneration = ulListGeneration;
+                pxEntry->ulLastUsed = ++pxParent->ulListClock;
+                pxEntry->uxUsers = 1U;
+            }
+
+            return pxEntry;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvListCacheRelease( FTPClient_t * pxClient )
+        {
+            FTPListCacheEntry_t * pxEntry = pxClient->pxListCache;
+
+            if( pxEntry != NULL )
+            {
+                pxClient->pxListCache = NULL;
+                pxClient->bits1.bListFromCache = pdFALSE_UNSIGNED;
+                pxEntry->uxUsers--;
+
+                if( pxEntry->xComplete == pdFALSE )
+                {
+                    /* An incomplete listing is dropped. */
+                    pxEntry->pcDirectory[ 0 ] = '\0';
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        void vFTPServerFlushListCache( void )
+        {
+            /* The entries are reused once they are found to be stale. */
+            ulListGeneration++;
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* ipconfigFTP_LIST_CACHE_ENTRIES */
+
     static const char * pcMonthAbbrev( BaseType_t xMonth )
     {
         static const char pcMonthList[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
@@ -62,6 +62,32 @@
         #define USE_HTML_CHUNKS    ( 0 )
     #endif
 
+/* When non-zero, prvSendFile() reads file data straight into the TX stream of
+ * the socket, see xTCPServerSendFile(), as the FTP server does when
+ * ipconfigFTP_TX_ZERO_COPY is set.  pcFileBuffer is only used when the free
+ * space at the head of the stream is too short, because it wraps around the
+ * end of the stream. */
+    #ifndef ipconfigHTTP_TX_ZERO_COPY
+        #define ipconfigHTTP_TX_ZERO_COPY    ( 1 )
+    #endif
+
+/* When non-zero, a client that accepts gzip gets "name.gz" in stead of "name"
+ * when it exists, with "Content-Encoding: gzip".  The compressed files are
+ * made when the file system image is built, e.g. with "gzip -k -9 name", so
+ * no CPU time is spent on compression at run time. */
+    #ifndef ipconfigHTTP_USE_GZIP
+        #define ipconfigHTTP_USE_GZIP    ( 1 )
+    #endif
+
+/* When non-zero, a GET with a "Range: bytes=..." header gets "206 Partial
+ * Content" with only the bytes asked for, so a client can resume a download
+ * or fetch parts of a file over several connections at once.  A request for
+ * more than one range gets the whole file, "multipart/byteranges" replies are
+ * not made. */
+    #ifndef ipconfigHTTP_USE_RANGES
+        #define ipconfigHTTP_USE_RANGES    ( 1 )
+    #endif
+
     #if !defined( ARRAY_SIZE )
         #define ARRAY_SIZE( x )    ( BaseType_t ) ( sizeof( x ) / sizeof( x )[ 0 ] )
     #endif
@@ -84,6 +110,45 @@
     static BaseType_t prvSendFile( HTTPClient_t * pxClient );
     static BaseType_t prvSendReply( HTTPClient_t * pxClient,
                                     BaseType_t xCode );
+    static BaseType_t prvHeaderLength( const char * pcBuffer,
+                                       BaseType_t xLength );
+    static const char * prvFindHeader( const char * pcHeaders,
+                                       const char * pcName );
+    static void prvParseHeaders( HTTPClient_t * pxClient );
+    #if ( ipconfigHTTP_USE_GZIP != 0 )
+        static BaseType_t prvAcceptsGzip( const HTTPClient_t * pxClient );
+    #endif
+    #if ( ipconfigHTTP_USE_RANGES != 0 )
+        static BaseType_t prvIsRangeEnd( char cChar );
+        static BaseType_t prvParseRange( HTTPClient_t * pxClient,
+                                         size_t uxSize,
+                                         const char * pcETag );
+    #endif
+    static BaseType_t prvSendRangeError( HTTPClient_t * pxClient,
+                                         size_t uxSize );
+    static BaseType_t prvHandleRequest( HTTPClient_t * pxClient,
+                                        BaseType_t xLength );
+    static BaseType_t prvReplyBusy( const HTTPClient_t * pxClient );
+
+    #if ( ipconfigHTTP_HAS_STREAM_REQUEST_HOOK != 0 )
+        static BaseType_t prvSendStream( HTTPClient_t * pxClient );
+        static void prvStreamEnd( HTTPClient_t * pxClient );
+    #endif
+
+    #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        static HTTPCacheEntry_t * prvCacheFind( HTTPClient_t * pxClient );
+        static HTTPCacheEntry_t * prvCacheStore( HTTPClient_t * pxClient );
+        static BaseType_t prvCacheLoadBody( HTTPCachedBody_t * pxBody,
+                                            FF_FILE * pxFile,
+                                            const char * pcType,
+                                            const char * pcEncoding,
+                                            BaseType_t xVary );
+        static void prvCacheFree( HTTPCacheEntry_t * pxEntry );
+        static void prvCacheRelease( HTTPClient_t * pxClient );
+        static BaseType_t prvCacheReply( HTTPClient_t * pxClient,
+                                         HTTPCacheEntry_t * pxEntry );
+        static BaseType_t prvSendCached( HTTPClient_t * pxClient );
+    #endif
 
     static const char pcEmptyString[ 1 ] = { '\0' };
 
@@ -114,6 +179,8 @@
     {
         HTTPClient_t * pxClient = ( HTTPClient_t * ) pxTCPClient;
 
+        FreeRTOS_printf( ( "HTTP client closed after %u requests\n", ( unsigned ) pxClient->ulRequestCount ) );
+
         /* This HTTP client stops, close / release all resources. */
         if( pxClient->xSocket != FREERTOS_NO_SOCKET )
         {
@@ -123,6 +190,18 @@
         }
 
         prvFileClose( pxClient );
+
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            prvCacheRelease( pxClient );
+        }
+        #endif
+
+        #if ( ipconfigHTTP_HAS_STREAM_REQUEST_HOOK != 0 )
+        {
+            prvStreamEnd( pxClient );
+        }
+        #endif
     }
 /*-----------------------------------------------------------*/
 
@@ -142,22 +221,36 @@
     {
         struct xTCP_SERVER * pxParent = pxClient->pxParent;
         BaseType_t xRc;
+        const char * pcLength = pcEmptyString;
 
         /* A normal command reply on the main socket (port 21). */
         char * pcBuffer = pxParent->pcFileBuffer;
 
+        #if ( USE_HTML_CHUNKS == 0 )
+        {
+            /* A reply without a body must say so, otherwise the client of a
+             * persistent connection can not tell where the next reply starts. */
+            if( pxParent->pcExtraContents[ 0 ] == '\0' )
+            {
+                pcLength = "Content-Length: 0\r\n";
+            }
+        }
+        #endif
+
         xRc = snprintf( pcBuffer, sizeof( pxParent->pcFileBuffer ),
                         "HTTP/1.1 %d %s\r\n"
                         #if USE_HTML_CHUNKS
                             "Transfer-Encoding: chunked\r\n"
                         #endif
                         "Content-Type: %s\r\n"
-                        "Connection: keep-alive\r\n"
-                        "%s\r\n",
+                        "Connection: %s\r\n"
+                        "%s%s\r\n",
                         ( int ) xCode,
                         webCodename( xCode ),
                         pxParent->pcContentsType[ 0 ] ? pxParent->pcContentsType : "text/html",
-                        pxParent->pcExtraContents );
+                        pxClient->bits1.bCloseAfterReply ? "close" : "keep-alive",
+                        pxParent->pcExtraContents,
+                        pcLength );
 
         pxParent->pcContentsType[ 0 ] = '\0';
         pxParent->pcExtraContents[ 0 ] = '\0';
@@ -171,55 +264,58 @@
 
     static BaseType_t prvSendFile( HTTPClient_t * pxClient )
     {
-        size_t uxSpace;
-        size_t uxCount;
         BaseType_t xRc = 0;
 
         if( pxClient->bits.bReplySent == pdFALSE_UNSIGNED )
         {
+            BaseType_t xCode = WEB_REPLY_OK;
+            char * pcExtra = pxClient->pxParent->pcExtraContents;
+            size_t uxExtraSize = sizeof( pxClient->pxParent->pcExtraContents );
+            int iLength;
+
             pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
 
             strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
-            snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
-                      "Content-Length: %d\r\n", ( int ) pxClient->uxBytesLeft );
+            iLength = snprintf( pcExtra, uxExtraSize, "Content-Length: %lu\r\n%s", ( unsigned long ) pxClient->uxBytesLeft,
+                                pxClient->bits.bGzip ? "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n" : "" );
 
-            /* "Requested file action OK". */
-            xRc = prvSendReply( pxClient, WEB_REPLY_OK );
+            if( pxClient->bits.bRange != pdFALSE_UNSIGNED )
+            {
+                xCode = WEB_PARTIAL_CONTENT;
+                snprintf( pcExtra + iLength, uxExtraSize - ( size_t ) iLength, "Content-Range: bytes %lu-%lu/%lu\r\n",
+                          ( unsigned long ) ( pxClient->uxRangeEnd - pxClient->uxBytesLeft ),
+                          ( unsigned long ) ( pxClient->uxRangeEnd - 1U ),
+                          ( unsigned long ) pxClient->pxFileHandle->ulFileSize );
+            }
+            else if( ipconfigHTTP_USE_RANGES != 0 )
+            {
+                snprintf( pcExtra + iLength, uxExtraSize - ( size_t ) iLength, "Accept-Ranges: bytes\r\n" );
+            }
+
+            /* "Requested file action OK", or a part of it. */
+            xRc = prvSendReply( pxClient, xCode );
         }
 
         if( xRc >= 0 )
         {
-            do
-            {
-                uxSpace = FreeRTOS_tx_space( pxClient->xSocket );
-
-                if( pxClient->uxBytesLeft < uxSpace )
-                {
-                    uxCount = pxClient->uxBytesLeft;
-                }
-                else
-                {
-                    uxCount = uxSpace;
-                }
-
-                if( uxCount > 0u )
-                {
-                    if( uxCount > sizeof( pxClient->pxParent->pcFileBuffer ) )
-                    {
-                        uxCount = sizeof( pxClient->pxParent->pcFileBuffer );
-                    }
+            BaseType_t xFlags = 0;
 
-                    ff_fread( pxClient->pxParent->pcFileBuffer, 1, uxCount, pxClient->pxFileHandle );
-                    pxClient->uxBytesLeft -= uxCount;
+            #if ( ipconfigHTTP_TX_ZERO_COPY != 0 )
+            {
+                xFlags |= tcpserverSEND_ZERO_COPY;
+            }
+            #endif
 
-                    xRc = FreeRTOS_send( pxClient->xSocket, pxClient->pxParent->pcFileBuffer, uxCount, 0 );
+            xRc = xTCPServerSendFile( pxClient->xSocket, pxClient->pxFileHandle, &( pxClient->uxBytesLeft ),
+                                      pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), xFlags );
 
-                    if( xRc < 0 )
-                    {
-                        break;
-                    }
-                }
-            } while( uxCount > 0u );
+            if( xRc == -pdFREERTOS_ERRNO_EIO )
+            {
+                /* The reply promised more bytes, which cannot be sent now, and
+                 * the connection has been shut down. */
+                pxClient->bits1.bCloseAfterReply = pdTRUE_UNSIGNED;
+                pxClient->bits1.bShutdownSent = pdTRUE_UNSIGNED;
+            }
         }
 
         if( pxClient->uxBytesLeft == 0u )
@@ -241,10 +337,36 @@
     static BaseType_t prvOpenURL( HTTPClient_t * pxClient )
     {
         BaseType_t xRc;
+        BaseType_t xCode = WEB_REPLY_OK;
         char pcSlash[ 2 ];
 
         pxClient->bits.ulFlags = 0;
 
+        #if ( ipconfigHTTP_HAS_STREAM_REQUEST_HOOK != 0 )
+        {
+            if( ( strchr( pxClient->pcUrlData, ipconfigHTTP_REQUEST_CHARACTER ) != NULL ) &&
+                ( xApplicationHTTPStreamStartHook( pxClient->pcUrlData, &( pxClient->pvStreamContext ) ) != pdFALSE ) )
+            {
+                pxClient->bits.bStream = pdTRUE_UNSIGNED;
+
+                /* HTTP/1.0 clients do not know chunks, the end of their reply
+                 * is marked by closing the connection. */
+                if( strncmp( pxClient->pcRestData, "HTTP/1.1", 8 ) == 0 )
+                {
+                    pxClient->bits.bChunked = pdTRUE_UNSIGNED;
+                }
+                else
+                {
+                    pxClient->bits1.bCloseAfterReply = pdTRUE_UNSIGNED;
+                }
+
+                /* As with the hook below, a return keeps this conditional
+                 * code simple. */
+                return prvSendStream( pxClient );
+            }
+        }
+        #endif /* ipconfigHTTP_HAS_STREAM_REQUEST_HOOK */
+
         #if ( ipconfigHTTP_HAS_HANDLE_REQUEST_HOOK != 0 )
         {
             if( strchr( pxClient->pcUrlData, ipconfigHTTP_REQUEST_CHARACTER ) != NULL )
@@ -290,11 +412,59 @@
                   pcSlash,
                   pxClient->pcUrlData );
 
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            HTTPCacheEntry_t * pxEntry = prvCacheFind( pxClient );
+
+            if( pxEntry != NULL )
+            {
+                /* Served from RAM, the file system is not accessed. */
+                return prvCacheReply( pxClient, pxEntry );
+            }
+        }
+        #endif /* ipconfigHTTP_CACHE_ENTRIES */
+
         pxClient->pxFileHandle = ff_fopen( pxClient->pcCurrentFilename, "rb" );
 
         FreeRTOS_printf( ( "Open file '%s': %s\n", pxClient->pcCurrentFilename,
                            pxClient->pxFileHandle != NULL ? "Ok" : strerror( stdioGET_ERRNO() ) ) );
 
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            if( ( pxClient->pxFileHandle != NULL ) && ( pxClient->pxFileHandle->ulFileSize <= ipconfigHTTP_CACHE_MAX_FILE_SIZE ) )
+            {
+                HTTPCacheEntry_t * pxEntry = prvCacheStore( pxClient );
+
+                if( pxEntry != NULL )
+                {
+                    return prvCacheReply( pxClient, pxEntry );
+                }
+            }
+        }
+        #endif /* ipconfigHTTP_CACHE_ENTRIES */
+
+        #if ( ipconfigHTTP_USE_GZIP != 0 )
+        {
+            if( prvAcceptsGzip( pxClient ) != pdFALSE )
+            {
+                FF_FILE * pxGzipFile;
+
+                /* pcCurrentFilename keeps the original name, which determines
+                 * the Content-Type. */
+                snprintf( pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), "%s.gz", pxClient->pcCurrentFilename );
+                pxGzipFile = ff_fopen( pcFILE_BUFFER, "rb" );
+
+                if( pxGzipFile != NULL )
+                {
+                    FreeRTOS_printf( ( "Open file '%s': Ok\n", pcFILE_BUFFER ) );
+                    prvFileClose( pxClient );
+                    pxClient->pxFileHandle = pxGzipFile;
+                    pxClient->bits.bGzip = pdTRUE_UNSIGNED;
+                }
+            }
+        }
+        #endif /* ipconfigHTTP_USE_GZIP */
+
         if( pxClient->pxFileHandle == NULL )
         {
             /* "404 File not found". */
@@ -303,7 +473,32 @@
         else
         {
             pxClient->uxBytesLeft = ( size_t ) pxClient->pxFileHandle->ulFileSize;
-            xRc = prvSendFile( pxClient );
+            pxClient->uxRangeEnd = pxClient->uxBytesLeft;
+
+            #if ( ipconfigHTTP_USE_RANGES != 0 )
+            {
+                /* A file has no ETag, an "If-Range" always gets the whole file. */
+                xCode = prvParseRange( pxClient, ( size_t ) pxClient->pxFileHandle->ulFileSize, NULL );
+            }
+            #endif
+
+            if( xCode == WEB_RANGE_NOT_SATISFIABLE )
+            {
+                xRc = prvSendRangeError( pxClient, ( size_t ) pxClient->pxFileHandle->ulFileSize );
+                prvFileClose( pxClient );
+            }
+            else if( ( xCode == WEB_PARTIAL_CONTENT ) &&
+                     ( ff_fseek( pxClient->pxFileHandle, ( long ) ( pxClient->uxRangeEnd - pxClient->uxBytesLeft ), FF_SEEK_SET ) != 0 ) )
+            {
+                /* The handle belongs to this client only, other clients may be
+                 * reading other parts of the same file. */
+                xRc = prvSendReply( pxClient, WEB_INTERNAL_SERVER_ERROR );
+                prvFileClose( pxClient );
+            }
+            else
+            {
+                xRc = prvSendFile( pxClient );
+            }
         }
 
         return xRc;
@@ -333,6 +528,9 @@
             case ECMD_UNK:
                 FreeRTOS_printf( ( "prvProcessCmd: Not implemented: %s\n",
                                    xWebCommands[ xIndex ].pcCommandName ) );
+                /* Every request must be answered, or the replies to the
+                 * pipelined requests that follow would not match. */
+                xResult = prvSendReply( pxClient, WEB_NOT_IMPLEMENTED );
                 break;
         }
 
@@ -340,89 +538,969 @@
     }
 /*-----------------------------------------------------------*/
 
-    BaseType_t xHTTPClientWork( TCPClient_t * pxTCPClient )
+    static BaseType_t prvHeaderLength( const char * pcBuffer,
+                                       BaseType_t xLength )
     {
-        BaseType_t xRc;
-        HTTPClient_t * pxClient = ( HTTPClient_t * ) pxTCPClient;
+        BaseType_t xIndex;
+        BaseType_t xResult = 0;
 
-        if( pxClient->pxFileHandle != NULL )
+        /* Return the length of the request line plus the headers, including
+         * the empty line that ends them, or zero when the empty line has not
+         * been received yet. */
+        for( xIndex = 0; xIndex < xLength; xIndex++ )
         {
-            prvSendFile( pxClient );
+            if( pcBuffer[ xIndex ] == '\n' )
+            {
+                if( ( xIndex + 1 < xLength ) && ( pcBuffer[ xIndex + 1 ] == '\n' ) )
+                {
+                    xResult = xIndex + 2;
+                    break;
+                }
+
+                if( ( xIndex + 2 < xLength ) && ( pcBuffer[ xIndex + 1 ] == '\r' ) && ( pcBuffer[ xIndex + 2 ] == '\n' ) )
+                {
+                    xResult = xIndex + 3;
+                    break;
+                }
+            }
         }
 
-        xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), 0 );
+        return xResult;
+    }
+/*-----------------------------------------------------------*/
+
+    static const char * prvFindHeader( const char * pcHeaders,
+                                       const char * pcName )
+    {
+        size_t uxNameLength = strlen( pcName );
+        const char * pcLine;
+        const char * pcResult = NULL;
 
-        if( xRc > 0 )
+        /* The first line holds the protocol version, the headers follow. */
+        for( pcLine = strchr( pcHeaders, '\n' ); pcLine != NULL; pcLine = strchr( pcLine, '\n' ) )
         {
-            BaseType_t xIndex;
-            const char * pcEndOfCmd;
-            const struct xWEB_COMMAND * curCmd;
-            char * pcBuffer = pcCOMMAND_BUFFER;
+            pcLine++;
+
+            if( ( strncasecmp( pcLine, pcName, uxNameLength ) == 0 ) && ( pcLine[ uxNameLength ] == ':' ) )
+            {
+                pcResult = pcLine + uxNameLength + 1;
+
+                while( ( *pcResult == ' ' ) || ( *pcResult == '\t' ) )
+                {
+                    pcResult++;
+                }
+
+                break;
+            }
+        }
+
+        return pcResult;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvParseHeaders( HTTPClient_t * pxClient )
+    {
+        const char * pcValue;
+        BaseType_t xPersistent;
+
+        /* HTTP/1.1 connections are persistent unless the client asks to close
+         * them, older versions only when the client asks for keep-alive. */
+        xPersistent = ( strncmp( pxClient->pcRestData, "HTTP/1.1", 8 ) == 0 ) ? pdTRUE : pdFALSE;
 
-            if( xRc < ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) )
+        pcValue = prvFindHeader( pxClient->pcRestData, "Connection" );
+
+        if( pcValue != NULL )
+        {
+            if( strncasecmp( pcValue, "close", 5 ) == 0 )
+            {
+                xPersistent = pdFALSE;
+            }
+            else if( strncasecmp( pcValue, "keep-alive", 10 ) == 0 )
             {
-                pcBuffer[ xRc ] = '\0';
+                xPersistent = pdTRUE;
             }
+        }
+
+        if( xPersistent == pdFALSE )
+        {
+            pxClient->bits1.bCloseAfterReply = pdTRUE_UNSIGNED;
+        }
+
+        /* A request body is not used, it will be skipped before the next
+         * request is parsed. */
+        pcValue = prvFindHeader( pxClient->pcRestData, "Content-Length" );
+
+        if( pcValue != NULL )
+        {
+            pxClient->uxBodyBytesLeft = ( size_t ) strtoul( pcValue, NULL, 10 );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ipconfigHTTP_USE_GZIP != 0 )
+        static BaseType_t prvAcceptsGzip( const HTTPClient_t * pxClient )
+        {
+            const char * pcValue = prvFindHeader( pxClient->pcRestData, "Accept-Encoding" );
+            BaseType_t xResult = pdFALSE;
 
-            while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
+            if( ( pcValue != NULL ) && ( strstr( pcValue, "gzip" ) != NULL ) )
             {
-                pcBuffer[ --xRc ] = '\0';
+                xResult = pdTRUE;
             }
 
-            pcEndOfCmd = pcBuffer + xRc;
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+    #endif /* ipconfigHTTP_USE_GZIP */
+
+    #if ( ipconfigHTTP_USE_RANGES != 0 )
+        static BaseType_t prvIsRangeEnd( char cChar )
+        {
+            BaseType_t xResult = pdFALSE;
 
-            curCmd = xWebCommands;
+            /* A range ends where the header line ends, a ',' starts the next
+             * range. */
+            if( ( cChar == '\0' ) || ( cChar == '\r' ) || ( cChar == '\n' ) || ( cChar == ' ' ) || ( cChar == '\t' ) )
+            {
+                xResult = pdTRUE;
+            }
 
-            /* Pointing to "/index.html HTTP/1.1". */
-            pxClient->pcUrlData = pcBuffer;
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
 
-            /* Pointing to "HTTP/1.1". */
-            pxClient->pcRestData = pcEmptyString;
+        static BaseType_t prvParseRange( HTTPClient_t * pxClient,
+                                         size_t uxSize,
+                                         const char * pcETag )
+        {
+            const char * pcValue = prvFindHeader( pxClient->pcRestData, "Range" );
+            const char * pcIfRange = prvFindHeader( pxClient->pcRestData, "If-Range" );
+            BaseType_t xResult = WEB_REPLY_OK;
+            unsigned long ulFirst;
+            unsigned long ulLast;
+            char * pcEnd;
+
+            /* The whole file is sent, unless the header holds a single valid
+             * range and any "If-Range" names the current version.  Headers
+             * that can not be parsed are ignored, as RFC 9110 asks. */
+            if( ( pcValue == NULL ) || ( strncasecmp( pcValue, "bytes=", 6 ) != 0 ) )
+            {
+                pcValue = NULL;
+            }
+            else if( ( pcIfRange != NULL ) && ( ( pcETag == NULL ) || ( strncmp( pcIfRange, pcETag, strlen( pcETag ) ) != 0 ) ) )
+            {
+                pcValue = NULL;
+            }
+            else
+            {
+                pcValue += 6;
+            }
 
-            /* Last entry is "ECMD_UNK". */
-            for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
+            if( pcValue == NULL )
+            {
+                /* Send the whole file. */
+            }
+            else if( *pcValue == '-' )
             {
-                BaseType_t xLength;
+                /* "bytes=-500": the last 500 bytes. */
+                ulLast = strtoul( pcValue + 1, &pcEnd, 10 );
 
-                xLength = curCmd->xCommandLength;
+                if( ( pcEnd != pcValue + 1 ) && ( prvIsRangeEnd( *pcEnd ) != pdFALSE ) )
+                {
+                    if( ( ulLast == 0UL ) || ( uxSize == 0U ) )
+                    {
+                        xResult = WEB_RANGE_NOT_SATISFIABLE;
+                    }
+                    else
+                    {
+                        pxClient->uxBytesLeft = ( size_t ) FreeRTOS_min_uint32( ulLast, uxSize );
+                        pxClient->uxRangeEnd = uxSize;
+                        xResult = WEB_PARTIAL_CONTENT;
+                    }
+                }
+            }
+            else if( ( *pcValue >= '0' ) && ( *pcValue <= '9' ) )
+            {
+                /* "bytes=500-999", or "bytes=500-" up to the end. */
+                ulFirst = strtoul( pcValue, &pcEnd, 10 );
+                ulLast = ( unsigned long ) uxSize;
 
-                if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
+                if( *pcEnd == '-' )
                 {
-                    char * pcLastPtr;
+                    BaseType_t xValid = pdTRUE;
 
-                    pxClient->pcUrlData += xLength + 1;
+                    pcValue = pcEnd + 1;
+                    pcEnd = ( char * ) pcValue;
 
-                    for( pcLastPtr = ( char * ) pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
+                    if( ( *pcValue >= '0' ) && ( *pcValue <= '9' ) )
                     {
-                        char ch = *pcLastPtr;
+                        ulLast = strtoul( pcValue, &pcEnd, 10 );
+
+                        /* "bytes=999-500" is invalid, not unsatisfiable. */
+                        xValid = ( ulLast >= ulFirst ) ? pdTRUE : pdFALSE;
+
+                        /* The last byte is inclusive. */
+                        ulLast = ( ulLast < ( unsigned long ) uxSize ) ? ulLast + 1UL : ( unsigned long ) uxSize;
+                    }
 
-                        if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
+                    /* Several ranges, or an invalid header, get the whole file. */
+                    if( ( xValid != pdFALSE ) && ( prvIsRangeEnd( *pcEnd ) != pdFALSE ) )
+                    {
+                        if( ulFirst >= ( unsigned long ) uxSize )
+                        {
+                            xResult = WEB_RANGE_NOT_SATISFIABLE;
+                        }
+                        else
                         {
-                            *pcLastPtr = '\0';
-                            pxClient->pcRestData = pcLastPtr + 1;
-                            break;
+                            pxClient->uxBytesLeft = ( size_t ) ( ulLast - ulFirst );
+                            pxClient->uxRangeEnd = ( size_t ) ulLast;
+                            xResult = WEB_PARTIAL_CONTENT;
                         }
                     }
-
-                    break;
                 }
             }
 
-            if( xIndex < ( WEB_CMD_COUNT - 1 ) )
+            if( xResult == WEB_PARTIAL_CONTENT )
             {
-                xRc = prvProcessCmd( pxClient, xIndex );
+                pxClient->bits.bRange = pdTRUE_UNSIGNED;
             }
+
+            return xResult;
         }
-        else if( xRc < 0 )
+/*-----------------------------------------------------------*/
+    #endif /* ipconfigHTTP_USE_RANGES */
+
+    static BaseType_t prvSendRangeError( HTTPClient_t * pxClient,
+                                         size_t uxSize )
+    {
+        /* The reply tells the size, so the client may ask again. */
+        snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+                  "Content-Range: bytes */%lu\r\nContent-Length: 0\r\n", ( unsigned long ) uxSize );
+
+        return prvSendReply( pxClient, WEB_RANGE_NOT_SATISFIABLE );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvHandleRequest( HTTPClient_t * pxClient,
+                                        BaseType_t xLength )
+    {
+        BaseType_t xRc = xLength;
+        BaseType_t xIndex;
+        const char * pcEndOfCmd;
+        const struct xWEB_COMMAND * curCmd;
+        char * pcBuffer = pcCOMMAND_BUFFER;
+
+        pcBuffer[ xRc ] = '\0';
+
+        while( xRc && ( pcBuffer[ xRc - 1 ] == 13 || pcBuffer[ xRc - 1 ] == 10 ) )
         {
-            /* The connection will be closed and the client will be deleted. */
-            FreeRTOS_printf( ( "xHTTPClientWork: rc = %ld\n", xRc ) );
+            pcBuffer[ --xRc ] = '\0';
+        }
+
+        pcEndOfCmd = pcBuffer + xRc;
+
+        curCmd = xWebCommands;
+
+        /* Pointing to "/index.html HTTP/1.1". */
+        pxClient->pcUrlData = pcBuffer;
+
+        /* Pointing to "HTTP/1.1". */
+        pxClient->pcRestData = pcEmptyString;
+
+        /* Last entry is "ECMD_UNK". */
+        for( xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++ )
+        {
+            BaseType_t xLength;
+
+            xLength = curCmd->xCommandLength;
+
+            if( ( xRc >= xLength ) && ( memcmp( curCmd->pcCommandName, pcBuffer, xLength ) == 0 ) )
+            {
+                char * pcLastPtr;
+
+                pxClient->pcUrlData += xLength + 1;
+
+                for( pcLastPtr = ( char * ) pxClient->pcUrlData; pcLastPtr < pcEndOfCmd; pcLastPtr++ )
+                {
+                    char ch = *pcLastPtr;
+
+                    if( ( ch == '\0' ) || ( strchr( "\n\r \t", ch ) != NULL ) )
+                    {
+                        *pcLastPtr = '\0';
+                        pxClient->pcRestData = pcLastPtr + 1;
+                        break;
+                    }
+                }
+
+                break;
+            }
+        }
+
+        pxClient->ulRequestCount++;
+        prvParseHeaders( pxClient );
+
+        if( xIndex < ( WEB_CMD_COUNT - 1 ) )
+        {
+            xRc = prvProcessCmd( pxClient, xIndex );
+        }
+        else
+        {
+            /* Not a request line, the rest of the stream can not be trusted. */
+            pxClient->bits1.bCloseAfterReply = pdTRUE_UNSIGNED;
+            xRc = prvSendReply( pxClient, WEB_BAD_REQUEST );
         }
 
         return xRc;
     }
 /*-----------------------------------------------------------*/
 
+    static BaseType_t prvReplyBusy( const HTTPClient_t * pxClient )
+    {
+        BaseType_t xResult = pdFALSE;
+
+        /* Is a file, or a cached file, still being sent? */
+        if( pxClient->pxFileHandle != NULL )
+        {
+            xResult = pdTRUE;
+        }
+
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            if( pxClient->pxCacheEntry != NULL )
+            {
+                xResult = pdTRUE;
+            }
+        }
+        #endif
+
+        if( pxClient->bits.bStream != pdFALSE_UNSIGNED )
+        {
+            xResult = pdTRUE;
+        }
+
+        return xResult;
+    }
+/*-----------------------------------------------------------*/
+
+    BaseType_t xHTTPClientWork( TCPClient_t * pxTCPClient )
+    {
+        BaseType_t xRc = 0;
+        BaseType_t xLength;
+        BaseType_t xResult = 0;
+        HTTPClient_t * pxClient = ( HTTPClient_t * ) pxTCPClient;
+
+        if( pxClient->pxFileHandle != NULL )
+        {
+            if( prvSendFile( pxClient ) != 0 )
+            {
+                xResult = 1;
+            }
+        }
+
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        {
+            if( pxClient->pxCacheEntry != NULL )
+            {
+                if( prvSendCached( pxClient ) != 0 )
+                {
+                    xResult = 1;
+                }
+            }
+        }
+        #endif
+
+        #if ( ipconfigHTTP_HAS_STREAM_REQUEST_HOOK != 0 )
+        {
+            if( pxClient->bits.bStream != pdFALSE_UNSIGNED )
+            {
+                if( prvSendStream( pxClient ) != 0 )
+                {
+                    xResult = 1;
+                }
+            }
+        }
+        #endif
+
+        /* Requests are taken from the RX stream of the socket one by one: the
+         * headers are first peeked at, and only consumed once they are
+         * complete.  Pipelined requests wait in the stream until the reply to
+         * the previous request, possibly a long file, has been sent. */
+        while( ( prvReplyBusy( pxClient ) == pdFALSE ) && ( pxClient->bits1.bCloseAfterReply == pdFALSE_UNSIGNED ) )
+        {
+            if( pxClient->uxBodyBytesLeft > 0u )
+            {
+                /* Skip the body of the last request. */
+                xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER,
+                                     FreeRTOS_min_uint32( pxClient->uxBodyBytesLeft, sizeof( pcCOMMAND_BUFFER ) ), 0 );
+
+                if( xRc <= 0 )
+                {
+                    break;
+                }
+
+                pxClient->uxBodyBytesLeft -= ( size_t ) xRc;
+                xResult = 1;
+                continue;
+            }
+
+            xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ) - 1, FREERTOS_MSG_PEEK );
+
+            if( xRc <= 0 )
+            {
+                break;
+            }
+
+            xLength = prvHeaderLength( pcCOMMAND_BUFFER, xRc );
+
+            if( xLength == 0 )
+            {
+                if( xRc >= ( BaseType_t ) sizeof( pcCOMMAND_BUFFER ) - 1 )
+                {
+                    /* The headers do not fit in the command buffer. */
+                    FreeRTOS_printf( ( "xHTTPClientWork: request too long\n" ) );
+                    pxClient->bits1.bCloseAfterReply = pdTRUE_UNSIGNED;
+                    prvSendReply( pxClient, WEB_BAD_REQUEST );
+                    xResult = 1;
+                }
+
+                /* Wait for the rest of the headers. */
+                xRc = 0;
+                break;
+            }
+
+            /* Consume the request line and the headers that were peeked at. */
+            xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER, xLength, 0 );
+
+            if( xRc <= 0 )
+            {
+                break;
+            }
+
+            prvHandleRequest( pxClient, xRc );
+            xResult = 1;
+        }
+
+        if( ( pxClient->bits1.bCloseAfterReply != pdFALSE_UNSIGNED ) && ( prvReplyBusy( pxClient ) == pdFALSE ) )
+        {
+            /* The last reply has been queued, close the connection gracefully
+             * and wait for the peer to do the same. */
+            if( pxClient->bits1.bShutdownSent == pdFALSE_UNSIGNED )
+            {
+                FreeRTOS_shutdown( pxClient->xSocket, FREERTOS_SHUT_RDWR );
+                pxClient->bits1.bShutdownSent = pdTRUE_UNSIGNED;
+            }
+
+            xRc = FreeRTOS_recv( pxClient->xSocket, ( void * ) pcCOMMAND_BUFFER, sizeof( pcCOMMAND_BUFFER ), 0 );
+        }
+
+        /* A negative xRc from FreeRTOS_recv() means that the connection is
+         * closed and that no data is left. */
+        if( xRc < 0 )
+        {
+            /* The connection will be closed and the client will be deleted. */
+            FreeRTOS_printf( ( "xHTTPClientWork: rc = %ld\n", xRc ) );
+            xResult = xRc;
+        }
+
+        return xResult;
+    }
+/*-----------------------------------------------------------*/
+
+    #if ( ipconfigHTTP_HAS_STREAM_REQUEST_HOOK != 0 )
+
+        static BaseType_t prvSendStream( HTTPClient_t * pxClient )
+        {
+            /* A chunk is "XXXX\r\n", the data and "\r\n", the last one is
+             * "0\r\n\r\n".  The size has a fixed width, so the data can be
+             * written before its size is known. */
+            const size_t uxChunkHeader = pxClient->bits.bChunked ? 6U : 0U;
+            const size_t uxChunkOverhead = pxClient->bits.bChunked ? 8U : 0U;
+            static const char pcLastChunk[] = "0\r\n\r\n";
+            BaseType_t xRc = 0;
+
+            if( pxClient->bits.bReplySent == pdFALSE_UNSIGNED )
+            {
+                /* The reply has no Content-Length, dynamic contents are not
+                 * cached by the client. */
+                snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+                          "Cache-Control: no-store\r\n%s", pxClient->bits.bChunked ? "Transfer-Encoding: chunked\r\n" : "" );
+                xRc = prvSendReply( pxClient, WEB_REPLY_OK );
+            }
+
+            while( xRc >= 0 )
+            {
+                size_t uxSpace = ( size_t ) FreeRTOS_tx_space( pxClient->xSocket );
+                char * pcTarget = pcFILE_BUFFER;
+                size_t uxLength;
+
+                /* Leave room for the last chunk, and do not let the hook write
+                 * tiny parts. */
+                if( uxSpace < uxChunkOverhead + sizeof( pcLastChunk ) + 32U )
+                {
+                    break;
+                }
+
+                uxSpace = FreeRTOS_min_uint32( uxSpace, sizeof( pcFILE_BUFFER ) );
+
+                #if ( ipconfigHTTP_TX_ZERO_COPY != 0 )
+                {
+                    BaseType_t xHeadLength;
+                    char * pcHead = ( char * ) FreeRTOS_get_tx_head( pxClient->xSocket, &xHeadLength );
+
+                    /* Let the hook write straight into the TX stream, unless
+                     * the space at its head is short because it wraps. */
+                    if( ( pcHead != NULL ) && ( ( size_t ) xHeadLength >= uxSpace / 2U ) )
+                    {
+                        pcTarget = pcHead;
+                        uxSpace = FreeRTOS_min_uint32( uxSpace, ( uint32_t ) xHeadLength );
+                    }
+                }
+                #endif /* ipconfigHTTP_TX_ZERO_COPY */
+
+                uxLength = FreeRTOS_min_uint32( uxSpace - uxChunkOverhead, 0xffffU );
+                uxSpace = uxLength;
+                uxLength = uxApplicationHTTPStreamWriteHook( pxClient->pvStreamContext, pcTarget + uxChunkHeader, uxSpace );
+                configASSERT( uxLength <= uxSpace );
+
+                if( uxLength == 0U )
+                {
+                    if( pxClient->bits.bChunked != pdFALSE_UNSIGNED )
+                    {
+                        xRc = FreeRTOS_send( pxClient->xSocket, pcLastChunk, sizeof( pcLastChunk ) - 1U, 0 );
+                    }
+
+                    prvStreamEnd( pxClient );
+                    break;
+                }
+
+                if( pxClient->bits.bChunked != pdFALSE_UNSIGNED )
+                {
+                    char pcHeader[ 7 ];
+
+                    /* snprintf() would write a nul in front of the data. */
+                    snprintf( pcHeader, sizeof( pcHeader ), "%04x\r\n", ( unsigned ) uxLength );
+                    memcpy( pcTarget, pcHeader, uxChunkHeader );
+                    memcpy( pcTarget + uxChunkHeader + uxLength, "\r\n", 2U );
+                }
+
+                /* A NULL buffer tells FreeRTOS_send() that the data is already
+                 * in the TX stream. */
+                xRc = FreeRTOS_send( pxClient->xSocket, ( pcTarget == pcFILE_BUFFER ) ? pcFILE_BUFFER : NULL, uxLength + uxChunkOverhead, 0 );
+            }
+
+            if( xRc < 0 )
+            {
+                /* The connection is gone, the rest of the reply is not made. */
+                prvStreamEnd( pxClient );
+            }
+
+            if( pxClient->bits.bStream == pdFALSE_UNSIGNED )
+            {
+                /* Writing is ready, no need for further 'eSELECT_WRITE' events. */
+                FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+            }
+            else
+            {
+                /* Wake up the TCP task as soon as this socket may be written to. */
+                FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+            }
+
+            return xRc;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvStreamEnd( HTTPClient_t * pxClient )
+        {
+            if( pxClient->bits.bStream != pdFALSE_UNSIGNED )
+            {
+                pxClient->bits.bStream = pdFALSE_UNSIGNED;
+                vApplicationHTTPStreamEndHook( pxClient->pvStreamContext );
+                pxClient->pvStreamContext = NULL;
+            }
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* ipconfigHTTP_HAS_STREAM_REQUEST_HOOK */
+
+    #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+
+        static HTTPCacheEntry_t * prvCacheFind( HTTPClient_t * pxClient )
+        {
+            struct xTCP_SERVER * pxParent = pxClient->pxParent;
+            HTTPCacheEntry_t * pxResult = NULL;
+            BaseType_t x;
+
+            for( x = 0; x < ipconfigHTTP_CACHE_ENTRIES; x++ )
+            {
+                HTTPCacheEntry_t * pxEntry = &( pxParent->xCache[ x ] );
+
+                if( ( pxEntry->pcFilename[ 0 ] != '\0' ) && ( strcmp( pxEntry->pcFilename, pxClient->pcCurrentFilename ) == 0 ) )
+                {
+                    pxResult = pxEntry;
+                    break;
+                }
+            }
+
+            return pxResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static HTTPCacheEntry_t * prvCacheStore( HTTPClient_t * pxClient )
+        {
+            struct xTCP_SERVER * pxParent = pxClient->pxParent;
+            HTTPCacheEntry_t * pxEntry = NULL;
+            const char * pcType;
+            BaseType_t x;
+
+            /* Take a free entry, or else the least recently used one that is
+             * not being sent. */
+            for( x = 0; x < ipconfigHTTP_CACHE_ENTRIES; x++ )
+            {
+                HTTPCacheEntry_t * pxThis = &( pxParent->xCache[ x ] );
+
+                if( pxThis->uxUsers != 0U )
+                {
+                    continue;
+                }
+
+                if( pxThis->xPlain.pucResponse == NULL )
+                {
+                    pxEntry = pxThis;
+                    break;
+                }
+
+                if( ( pxEntry == NULL ) || ( ( int32_t ) ( pxThis->ulLastUsed - pxEntry->ulLastUsed ) < 0 ) )
+                {
+                    pxEntry = pxThis;
+                }
+            }
+
+            if( pxEntry != NULL )
+            {
+                prvCacheFree( pxEntry );
+                pcType = pcGetContentsType( pxClient->pcCurrentFilename );
+
+                #if ( ipconfigHTTP_USE_GZIP != 0 )
+                {
+                    FF_FILE * pxGzipFile;
+
+                    /* A pre-compressed copy is stored as "name.gz". */
+                    snprintf( pcFILE_BUFFER, sizeof( pcFILE_BUFFER ), "%s.gz", pxClient->pcCurrentFilename );
+                    pxGzipFile = ff_fopen( pcFILE_BUFFER, "rb" );
+
+                    if( pxGzipFile != NULL )
+                    {
+                        if( pxGzipFile->ulFileSize <= ipconfigHTTP_CACHE_MAX_FILE_SIZE )
+                        {
+                            ( void ) prvCacheLoadBody( &( pxEntry->xGzip ), pxGzipFile, pcType, "gzip", pdTRUE );
+                        }
+
+                        ff_fclose( pxGzipFile );
+                    }
+                }
+                #endif /* ipconfigHTTP_USE_GZIP */
+
+                if( prvCacheLoadBody( &( pxEntry->xPlain ), pxClient->pxFileHandle, pcType, NULL,
+                                      ( pxEntry->xGzip.pucResponse != NULL ) ? pdTRUE : pdFALSE ) != pdFALSE )
+                {
+                    FreeRTOS_printf( ( "HTTP cache: stored '%s'%s\n", pxClient->pcCurrentFilename,
+                                       ( pxEntry->xGzip.pucResponse != NULL ) ? " (+gzip)" : "" ) );
+                    strcpy( pxEntry->pcFilename, pxClient->pcCurrentFilename );
+                    prvFileClose( pxClient );
+                }
+                else
+                {
+                    /* No memory or a read error, send the file as usual. */
+                    prvCacheFree( pxEntry );
+                    ( void ) ff_fseek( pxClient->pxFileHandle, 0, FF_SEEK_SET );
+                    pxEntry = NULL;
+                }
+            }
+
+            return pxEntry;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvCacheLoadBody( HTTPCachedBody_t * pxBody,
+                                            FF_FILE * pxFile,
+                                            const char * pcType,
+                                            const char * pcEncoding,
+                                            BaseType_t xVary )
+        {
+            /* Room for the headers, which are formatted once the ETag is known. */
+            const size_t uxHeaderSpace = 224U;
+            size_t uxSize = ( size_t ) pxFile->ulFileSize;
+            uint32_t ulHash = 2166136261UL;
+            BaseType_t xResult = pdFALSE;
+            uint8_t * pucBuffer;
+            size_t uxIndex;
+            int iLength;
+
+            pucBuffer = ( uint8_t * ) pvPortMallocLarge( uxHeaderSpace + uxSize );
+
+            if( pucBuffer != NULL )
+            {
+                if( ff_fread( pucBuffer + uxHeaderSpace, 1, uxSize, pxFile ) == uxSize )
+                {
+                    /* The ETag is an FNV-1a hash of the contents plus the size. */
+                    for( uxIndex = 0; uxIndex < uxSize; uxIndex++ )
+                    {
+                        ulHash = ( ulHash ^ pucBuffer[ uxHeaderSpace + uxIndex ] ) * 16777619UL;
+                    }
+
+                    snprintf( pxBody->pcETag, sizeof( pxBody->pcETag ), "\"%08lx-%lx%s\"",
+                              ( unsigned long ) ulHash, ( unsigned long ) uxSize, ( pcEncoding != NULL ) ? "z" : "" );
+
+                    iLength = snprintf( ( char * ) pucBuffer, uxHeaderSpace,
+                                        "HTTP/1.1 %d %s\r\n"
+                                        "Content-Type: %s\r\n"
+                                        "Content-Length: %lu\r\n"
+                                        "ETag: %s\r\n"
+                                        "%s%s%s"
+                                        "%s%s",
+                                        ( int ) WEB_REPLY_OK,
+                                        webCodename( WEB_REPLY_OK ),
+                                        pcType,
+                                        ( unsigned long ) uxSize,
+                                        pxBody->pcETag,
+                                        ( pcEncoding != NULL ) ? "Content-Encoding: " : "",
+                                        ( pcEncoding != NULL ) ? pcEncoding : "",
+                                        ( pcEncoding != NULL ) ? "\r\n" : "",
+                                        ( xVary != pdFALSE ) ? "Vary: Accept-Encoding\r\n" : "",
+                                        ( ipconfigHTTP_USE_RANGES != 0 ) ? "Accept-Ranges: bytes\r\n" : "" );
+
+                    if( ( iLength > 0 ) && ( ( size_t ) iLength < uxHeaderSpace ) )
+                    {
+                        /* Let the body follow the headers directly. */
+                        memmove( pucBuffer + iLength, pucBuffer + uxHeaderSpace, uxSize );
+                        pxBody->pucResponse = pucBuffer;
+                        pxBody->uxHeaderLength = ( size_t ) iLength;
+                        pxBody->uxBodyLength = uxSize;
+                        xResult = pdTRUE;
+                    }
+                }
+
+                if( xResult == pdFALSE )
+                {
+                    vPortFreeLarge( pucBuffer );
+                }
+            }
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvCacheFree( HTTPCacheEntry_t * pxEntry )
+        {
+            if( pxEntry->xPlain.pucResponse != NULL )
+            {
+                vPortFreeLarge( pxEntry->xPlain.pucResponse );
+            }
+
+            if( pxEntry->xGzip.pucResponse != NULL )
+            {
+                vPortFreeLarge( pxEntry->xGzip.pucResponse );
+            }
+
+            memset( pxEntry, '\0', sizeof( *pxEntry ) );
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvCacheRelease( HTTPClient_t * pxClient )
+        {
+            HTTPCacheEntry_t * pxEntry = pxClient->pxCacheEntry;
+
+            if( pxEntry != NULL )
+            {
+                pxClient->pxCacheEntry = NULL;
+                pxClient->pxCachedBody = NULL;
+                pxEntry->uxUsers--;
+
+                /* An entry that was flushed while it was being sent is freed
+                 * by its last user. */
+                if( ( pxEntry->uxUsers == 0U ) && ( pxEntry->pcFilename[ 0 ] == '\0' ) )
+                {
+                    prvCacheFree( pxEntry );
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvCacheReply( HTTPClient_t * pxClient,
+                                         HTTPCacheEntry_t * pxEntry )
+        {
+            const HTTPCachedBody_t * pxBody = &( pxEntry->xPlain );
+            const char * pcValue;
+            BaseType_t xCode = WEB_REPLY_OK;
+            BaseType_t xRc;
+
+            pxEntry->ulLastUsed = ++pxClient->pxParent->ulCacheClock;
+
+            #if ( ipconfigHTTP_USE_GZIP != 0 )
+            {
+                if( ( pxEntry->xGzip.pucResponse != NULL ) && ( prvAcceptsGzip( pxClient ) != pdFALSE ) )
+                {
+                    pxBody = &( pxEntry->xGzip );
+                }
+            }
+            #endif
+
+            pcValue = prvFindHeader( pxClient->pcRestData, "If-None-Match" );
+
+            if( ( pcValue != NULL ) && ( ( *pcValue == '*' ) || ( strstr( pcValue, pxBody->pcETag ) != NULL ) ) )
+            {
+                /* The client has this version already. */
+                snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+                          "ETag: %s\r\n", pxBody->pcETag );
+                xRc = prvSendReply( pxClient, WEB_NOT_MODIFIED );
+            }
+            else
+            {
+                pxClient->uxBytesLeft = pxBody->uxBodyLength;
+                pxClient->uxRangeEnd = pxBody->uxBodyLength;
+
+                #if ( ipconfigHTTP_USE_RANGES != 0 )
+                {
+                    /* A range of the gzipped body is a range of "name.gz",
+                     * which has its own ETag. */
+                    xCode = prvParseRange( pxClient, pxBody->uxBodyLength, pxBody->pcETag );
+                }
+                #endif
+
+                if( xCode == WEB_RANGE_NOT_SATISFIABLE )
+                {
+                    xRc = prvSendRangeError( pxClient, pxBody->uxBodyLength );
+                }
+                else
+                {
+                    /* Every client has its own offset in the shared buffer. */
+                    pxEntry->uxUsers++;
+                    pxClient->pxCacheEntry = pxEntry;
+                    pxClient->pxCachedBody = pxBody;
+                    xRc = prvSendCached( pxClient );
+                }
+            }
+
+            return xRc;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvSendCached( HTTPClient_t * pxClient )
+        {
+            const HTTPCachedBody_t * pxBody = pxClient->pxCachedBody;
+            const uint8_t * pucBody = pxBody->pucResponse + pxBody->uxHeaderLength;
+            BaseType_t xRc = 0;
+            size_t uxCount;
+
+            if( pxClient->bits.bReplySent == pdFALSE_UNSIGNED )
+            {
+                const char * pcConnection = pxClient->bits1.bCloseAfterReply ? "Connection: close\r\n\r\n" : "Connection: keep-alive\r\n\r\n";
+
+                pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
+
+                if( pxClient->bits.bRange != pdFALSE_UNSIGNED )
+                {
+                    const HTTPCacheEntry_t * pxEntry = pxClient->pxCacheEntry;
+
+                    /* The pre-rendered headers are those of the whole file. */
+                    strcpy( pxClient->pxParent->pcContentsType, pcGetContentsType( pxClient->pcCurrentFilename ) );
+                    snprintf( pxClient->pxParent->pcExtraContents, sizeof( pxClient->pxParent->pcExtraContents ),
+                              "Content-Length: %lu\r\n"
+                              "Content-Range: bytes %lu-%lu/%lu\r\n"
+                              "ETag: %s\r\n"
+                              "%s%s",
+                              ( unsigned long ) pxClient->uxBytesLeft,
+                              ( unsigned long ) ( pxClient->uxRangeEnd - pxClient->uxBytesLeft ),
+                              ( unsigned long ) ( pxClient->uxRangeEnd - 1U ),
+                              ( unsigned long ) pxBody->uxBodyLength,
+                              pxBody->pcETag,
+                              ( pxBody == &( pxEntry->xGzip ) ) ? "Content-Encoding: gzip\r\n" : "",
+                              ( pxEntry->xGzip.pucResponse != NULL ) ? "Vary: Accept-Encoding\r\n" : "" );
+                    xRc = prvSendReply( pxClient, WEB_PARTIAL_CONTENT );
+                }
+                else
+                {
+                    /* The pre-rendered headers, and the one header that depends on
+                     * the request. */
+                    xRc = FreeRTOS_send( pxClient->xSocket, pxBody->pucResponse, pxBody->uxHeaderLength, 0 );
+
+                    if( xRc >= 0 )
+                    {
+                        xRc = FreeRTOS_send( pxClient->xSocket, pcConnection, strlen( pcConnection ), 0 );
+                    }
+                }
+            }
+
+            while( ( xRc >= 0 ) && ( pxClient->uxBytesLeft > 0u ) )
+            {
+                uxCount = FreeRTOS_min_uint32( pxClient->uxBytesLeft, ( uint32_t ) FreeRTOS_tx_space( pxClient->xSocket ) );
+
+                if( uxCount == 0u )
+                {
+                    break;
+                }
+
+                xRc = FreeRTOS_send( pxClient->xSocket, pucBody + ( pxClient->uxRangeEnd - pxClient->uxBytesLeft ), uxCount, 0 );
+
+                if( xRc <= 0 )
+                {
+                    break;
+                }
+
+                pxClient->uxBytesLeft -= ( size_t ) xRc;
+            }
+
+            if( ( pxClient->uxBytesLeft == 0u ) || ( xRc < 0 ) )
+            {
+                /* Writing is ready, no need for further 'eSELECT_WRITE' events. */
+                FreeRTOS_FD_CLR( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+                pxClient->uxBytesLeft = 0u;
+                prvCacheRelease( pxClient );
+            }
+            else
+            {
+                /* Wake up the TCP task as soon as this socket may be written to. */
+                FreeRTOS_FD_SET( pxClient->xSocket, pxClient->pxParent->xSocketSet, eSELECT_WRITE );
+            }
+
+            return xRc;
+        }
+/*-----------------------------------------------------------*/
+
+        void vHTTPServerFlushCache( TCPServer_t * pxServer )
+        {
+            BaseType_t x;
+
+            #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+            {
+                /* Each worker has its own cache, and flushes it in its own
+                 * task. */
+                for( x = 0; x < pxServer->xWorkerCount; x++ )
+                {
+                    pxServer->pxWorkers[ x ]->xFlushCache = pdTRUE;
+                }
+            }
+            #endif
+
+            for( x = 0; x < ipconfigHTTP_CACHE_ENTRIES; x++ )
+            {
+                HTTPCacheEntry_t * pxEntry = &( pxServer->xCache[ x ] );
+
+                if( pxEntry->uxUsers == 0U )
+                {
+                    prvCacheFree( pxEntry );
+                }
+                else
+                {
+                    /* Still being sent, prvCacheRelease() will free it. */
+                    pxEntry->pcFilename[ 0 ] = '\0';
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* ipconfigHTTP_CACHE_ENTRIES */
+
     static const char * pcGetContentsType( const char * apFname )
     {
         const char * slash = NULL;
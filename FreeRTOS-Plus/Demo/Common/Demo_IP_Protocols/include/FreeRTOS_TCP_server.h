@@ -107,6 +107,34 @@
                                                           size_t uxBufferLength );
     #endif /* ipconfigHTTP_HAS_HANDLE_REQUEST_HOOK */
 
+    #if ( ipconfigHTTP_HAS_STREAM_REQUEST_HOOK != 0 )
+
+/*
+ * A GET request is received containing the special character, and the reply
+ * may be produced bit by bit, without knowing its length in advance.
+ * Return pdTRUE to stream the reply, pdFALSE to let the request be handled
+ * as usual.  *ppvContext is passed to the other two hooks.
+ */
+        extern BaseType_t xApplicationHTTPStreamStartHook( const char * pcURLData,
+                                                           void ** ppvContext );
+
+/*
+ * Called whenever the socket can take more data: write the next part of the
+ * reply in pcBuffer, at most uxBufferLength bytes, and return its length.
+ * Return zero when the reply is complete.  pcBuffer points into the TX
+ * stream of the socket when possible, each part becomes one HTTP chunk.
+ */
+        extern size_t uxApplicationHTTPStreamWriteHook( void * pvContext,
+                                                        char * pcBuffer,
+                                                        size_t uxBufferLength );
+
+/*
+ * The reply is complete, or the connection has been closed before that:
+ * release whatever pvContext refers to.
+ */
+        extern void vApplicationHTTPStreamEndHook( void * pvContext );
+    #endif /* ipconfigHTTP_HAS_STREAM_REQUEST_HOOK */
+
     struct xSERVER_CONFIG
     {
         enum eSERVER_TYPE eType;      /* eSERVER_HTTP | eSERVER_FTP */
@@ -118,11 +146,57 @@
     struct xTCP_SERVER;
     typedef struct xTCP_SERVER TCPServer_t;
 
+/* A snapshot of one connected client, see FreeRTOS_TCPServerGetClientStats(). */
+    typedef struct xTCP_CLIENT_STATS
+    {
+        enum eSERVER_TYPE eType; /* eSERVER_HTTP | eSERVER_FTP */
+        Socket_t xSocket;        /* The socket of the connection. */
+        uint32_t ulRequestCount; /* Requests handled on the connection, counted by HTTP clients. */
+        TickType_t xIdleTime;    /* Ticks since the client last did any work. */
+    }
+    TCPClientStats_t;
+
+/* The admission counters of a server, see ipconfigTCP_SERVER_MAX_CLIENTS. */
+    typedef struct xTCP_SERVER_ADMISSION_STATS
+    {
+        UBaseType_t uxClients;   /* Clients admitted now. */
+        size_t uxWindowMemory;   /* TCP buffer space reserved for them. */
+        UBaseType_t uxWaiting;   /* Connections waiting for admission now. */
+        uint32_t ulQueued;       /* Connections admitted after waiting. */
+        uint32_t ulRefused;      /* Connections refused because of a limit. */
+    }
+    TCPServerAdmissionStats_t;
+
     TCPServer_t * FreeRTOS_CreateTCPServer( const struct xSERVER_CONFIG * pxConfigs,
                                             BaseType_t xCount );
     void FreeRTOS_TCPServerWork( TCPServer_t * pxServer,
                                  TickType_t xBlockingTime );
 
+/* Fill in at most xMaxCount entries of pxStats, one per connected client, and
+ * return the number filled in.  Call it from the task that calls
+ * FreeRTOS_TCPServerWork(). */
+    BaseType_t FreeRTOS_TCPServerGetClientStats( TCPServer_t * pxServer,
+                                                 TCPClientStats_t * pxStats,
+                                                 BaseType_t xMaxCount );
+
+/* Fill in the admission counters, all zero when no limits are configured. */
+    void FreeRTOS_TCPServerGetAdmissionStats( TCPServer_t * pxServer,
+                                              TCPServerAdmissionStats_t * pxStats );
+
+    #if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+
+/* Drop all files from the HTTP cache, e.g. after files have been changed.
+ * Call it from the task that calls FreeRTOS_TCPServerWork(). */
+        void vHTTPServerFlushCache( TCPServer_t * pxServer );
+    #endif
+
+    #if ( ipconfigUSE_FTP != 0 ) && ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+
+/* Mark the directory listings cached by all FTP servers as stale, e.g. after
+ * files have been changed by other tasks.  May be called from any task. */
+        void vFTPServerFlushListCache( void );
+    #endif
+
     #if ( ipconfigSUPPORT_SIGNALS != 0 )
 
 /* FreeRTOS_TCPServerWork() calls select().
@@ -57,11 +57,154 @@
     #define ipconfigTCP_FILE_BUFFER_SIZE    ( 2048 )
 #endif
 
+/*
+ * ipconfigHTTP_IDLE_TIMEOUT_MS sets how long an HTTP connection may stay open
+ * without a request or a reply in progress.  FreeRTOS_TCPServerWork() closes
+ * idle connections, so persistent (keep-alive) connections do not hold on to
+ * sockets forever.  Zero disables the timeout.
+ */
+#ifndef ipconfigHTTP_IDLE_TIMEOUT_MS
+    #define ipconfigHTTP_IDLE_TIMEOUT_MS    ( 30000 )
+#endif
+
+/*
+ * ipconfigHTTP_CACHE_ENTRIES is the number of files that an HTTP server keeps
+ * in RAM, together with their response headers.  A cached file is served
+ * without accessing the file system.  When a file "name.gz" exists next to a
+ * cached file, it is cached as well and sent to clients that accept gzip, see
+ * ipconfigHTTP_USE_GZIP.
+ * Only files up to ipconfigHTTP_CACHE_MAX_FILE_SIZE bytes are cached.  The
+ * least recently used file makes room for a new one.  Zero disables the cache.
+ */
+#ifndef ipconfigHTTP_CACHE_ENTRIES
+    #define ipconfigHTTP_CACHE_ENTRIES    ( 0 )
+#endif
+
+#ifndef ipconfigHTTP_CACHE_MAX_FILE_SIZE
+    #define ipconfigHTTP_CACHE_MAX_FILE_SIZE    ( 4096 )
+#endif
+
+/*
+ * ipconfigTCP_SERVER_WORKERS sets the number of worker tasks that a TCP server
+ * creates.  Zero (the default) lets the task that calls FreeRTOS_TCPServerWork()
+ * serve all clients, which suits small devices.  Otherwise that task only
+ * accepts connections, and hands every new client to the worker that owns the
+ * fewest clients.  A worker is the only task that ever touches its clients, and
+ * it has its own socket set, buffers and HTTP cache, so client state needs no
+ * locks, and a slow client only delays the others of the same worker.
+ * A worker checks for new clients at least every
+ * ipconfigTCP_SERVER_WORKER_POLL_MS.
+ */
+#ifndef ipconfigTCP_SERVER_WORKERS
+    #define ipconfigTCP_SERVER_WORKERS    ( 0 )
+#endif
+
+#if ( ipconfigTCP_SERVER_WORKERS > 0 )
+    #include "queue.h"
+
+    #ifndef ipconfigTCP_SERVER_WORKER_STACK_SIZE
+        #define ipconfigTCP_SERVER_WORKER_STACK_SIZE    ( 4 * configMINIMAL_STACK_SIZE )
+    #endif
+
+    #ifndef ipconfigTCP_SERVER_WORKER_PRIORITY
+        #define ipconfigTCP_SERVER_WORKER_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+    #endif
+
+    #ifndef ipconfigTCP_SERVER_WORKER_POLL_MS
+        #define ipconfigTCP_SERVER_WORKER_POLL_MS    ( 20 )
+    #endif
+
+/* The number of accepted clients that may wait for a worker to pick them up. */
+    #ifndef ipconfigTCP_SERVER_WORKER_QUEUE_LENGTH
+        #define ipconfigTCP_SERVER_WORKER_QUEUE_LENGTH    ( 4 )
+    #endif
+#endif /* ipconfigTCP_SERVER_WORKERS */
+
+/*
+ * ipconfigFTP_STREAMING : when non-zero, STOR and RETR move file data through
+ * a staging buffer of ipconfigFTP_STREAM_BUFFER_SIZE bytes per transfer, so
+ * that disk access overlaps with the network transfer done by the IP task.
+ * The buffer is by default as large as the TX buffer of the data socket.
+ */
+#ifndef ipconfigFTP_STREAMING
+    #define ipconfigFTP_STREAMING    ( 0 )
+#endif
+
+#if ( ipconfigFTP_STREAMING != 0 )
+    #ifndef ipconfigFTP_STREAM_BUFFER_SIZE
+        #if ( ipconfigFTP_TX_BUFSIZE > 0 )
+            #define ipconfigFTP_STREAM_BUFFER_SIZE    ( ipconfigFTP_TX_BUFSIZE )
+        #else
+            #define ipconfigFTP_STREAM_BUFFER_SIZE    ( 8192 )
+        #endif
+    #endif
+#endif
+
+/*
+ * ipconfigFTP_LIST_CACHE_ENTRIES is the number of directory listings that an
+ * FTP server keeps in RAM, as the text that LIST sends.  A directory that is
+ * listed again is sent from RAM, without accessing the file system.  Listings
+ * of up to ipconfigFTP_LIST_CACHE_SIZE bytes are cached.  All listings become
+ * stale when a client of the server stores, deletes or renames a file, or
+ * makes or removes a directory, or when vFTPServerFlushListCache() is called.
+ * Zero disables the cache.
+ */
+#ifndef ipconfigFTP_LIST_CACHE_ENTRIES
+    #define ipconfigFTP_LIST_CACHE_ENTRIES    ( 0 )
+#endif
+
+#ifndef ipconfigFTP_LIST_CACHE_SIZE
+    #define ipconfigFTP_LIST_CACHE_SIZE    ( 4096 )
+#endif
+
+/*
+ * Admission control.  A TCP server admits at most ipconfigTCP_SERVER_MAX_CLIENTS
+ * clients, and only as long as the TCP buffers of its clients together stay
+ * within ipconfigTCP_SERVER_MAX_WINDOW_MEMORY bytes.  Zero means no limit.
+ * A connection that arrives while a limit is reached waits, in order of
+ * arrival, for at most ipconfigTCP_SERVER_MAX_WAIT_MS.  After that, or when
+ * already ipconfigTCP_SERVER_MAX_WAITING connections wait, it gets a short
+ * refusal ("503" for HTTP, "421" for FTP) and is closed.
+ */
+#ifndef ipconfigTCP_SERVER_MAX_CLIENTS
+    #define ipconfigTCP_SERVER_MAX_CLIENTS    ( 0 )
+#endif
+
+#ifndef ipconfigTCP_SERVER_MAX_WINDOW_MEMORY
+    #define ipconfigTCP_SERVER_MAX_WINDOW_MEMORY    ( 0 )
+#endif
+
+#define tcpserverUSE_ADMISSION    ( ( ipconfigTCP_SERVER_MAX_CLIENTS > 0 ) || ( ipconfigTCP_SERVER_MAX_WINDOW_MEMORY > 0 ) )
+
+#if ( tcpserverUSE_ADMISSION != 0 )
+    #ifndef ipconfigTCP_SERVER_MAX_WAITING
+        #define ipconfigTCP_SERVER_MAX_WAITING    ( 4 )
+    #endif
+
+    #ifndef ipconfigTCP_SERVER_MAX_WAIT_MS
+        #define ipconfigTCP_SERVER_MAX_WAIT_MS    ( 2000 )
+    #endif
+
+/* An accepted connection that has not been admitted yet. */
+    typedef struct xTCP_WAITING
+    {
+        Socket_t xSocket;
+        BaseType_t xIndex;    /* The index of the listening socket in xServers[]. */
+        TickType_t xSince;    /* When it started waiting, or when it was refused. */
+        BaseType_t xRefused;  /* pdTRUE when it was refused and waits for the peer to close. */
+    } TCPWaiting_t;
+#endif /* tcpserverUSE_ADMISSION */
+
 struct xTCP_CLIENT;
 
 typedef BaseType_t ( * FTCPWorkFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 typedef void ( * FTCPDeleteFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
 
+/*
+ * The work function returns a negative value when the client must be deleted,
+ * a positive value when it did some work, and zero when it was idle.  A client
+ * with a non-zero xIdleTimeout is deleted once it has been idle for that long.
+ */
 #define TCP_CLIENT_FIELDS               \
     enum eSERVER_TYPE eType;            \
     struct xTCP_SERVER * pxParent;      \
@@ -69,6 +212,9 @@ typedef void ( * FTCPDeleteFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
     const char * pcRootDir;             \
     FTCPWorkFunction fWorkFunction;     \
     FTCPDeleteFunction fDeleteFunction; \
+    TickType_t xLastActivity;           \
+    TickType_t xIdleTimeout;            \
+    uint32_t ulRequestCount;            \
     struct xTCP_CLIENT * pxNextClient
 
 typedef struct xTCP_CLIENT
@@ -78,6 +224,25 @@ typedef struct xTCP_CLIENT
     /* --- Keep at the top  --- */
 } TCPClient_t;
 
+#if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+    typedef struct xHTTP_CACHED_BODY
+    {
+        uint8_t * pucResponse; /* The response headers, without the Connection header, followed by the body. */
+        size_t uxHeaderLength;
+        size_t uxBodyLength;
+        char pcETag[ 24 ];     /* e.g. "\"1a2b3c4d-5e6\"" */
+    } HTTPCachedBody_t;
+
+    typedef struct xHTTP_CACHE_ENTRY
+    {
+        char pcFilename[ ffconfigMAX_FILENAME ]; /* Empty when the entry is free or flushed. */
+        uint32_t ulLastUsed;                     /* The value of ulCacheClock when it was last used. */
+        UBaseType_t uxUsers;                     /* The number of clients sending it. */
+        HTTPCachedBody_t xPlain;
+        HTTPCachedBody_t xGzip;                  /* pucResponse is NULL when there is no "name.gz". */
+    } HTTPCacheEntry_t;
+#endif /* ipconfigHTTP_CACHE_ENTRIES */
+
 struct xHTTP_CLIENT
 {
     /* This define contains fields which must come first within each of the client structs */
@@ -88,21 +253,60 @@ struct xHTTP_CLIENT
     const char * pcRestData;
     char pcCurrentFilename[ ffconfigMAX_FILENAME ];
     size_t uxBytesLeft;
-    FF_FILE * pxFileHandle;
+    size_t uxRangeEnd;      /* The offset just after the last byte to send, the offset of the next byte is uxRangeEnd - uxBytesLeft. */
+    size_t uxBodyBytesLeft; /* Bytes of a request body still to be discarded. */
+    FF_FILE * pxFileHandle; /* Every client opens its own handle, so ranges of one file can be sent to several clients at once. */
+    #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+        HTTPCacheEntry_t * pxCacheEntry;        /* The cached file being sent, or NULL. */
+        const HTTPCachedBody_t * pxCachedBody; /* Its plain or gzipped body. */
+    #endif
+    #if ( ipconfigHTTP_HAS_STREAM_REQUEST_HOOK != 0 )
+        void * pvStreamContext; /* Set by xApplicationHTTPStreamStartHook(). */
+    #endif
     union
     {
         struct
         {
             uint32_t
-                bReplySent : 1;
+                bReplySent : 1,
+                bGzip : 1,  /* pdTRUE when "name.gz" is sent in stead of "name". */
+                bRange : 1,   /* pdTRUE when a "206 Partial Content" reply is sent. */
+                bStream : 1,  /* pdTRUE while uxApplicationHTTPStreamWriteHook() produces the reply. */
+                bChunked : 1; /* pdTRUE when the streamed reply is sent in chunks, otherwise the connection is closed after it. */
         };
         uint32_t ulFlags;
     }
     bits;
+    union
+    {
+        struct
+        {
+            uint32_t
+                bCloseAfterReply : 1, /* pdTRUE when the connection is not persistent. */
+                bShutdownSent : 1;    /* pdTRUE once FreeRTOS_shutdown() was called. */
+        };
+        uint32_t ulConnFlags;
+    }
+    bits1;
 };
 
 typedef struct xHTTP_CLIENT HTTPClient_t;
 
+#if ( ipconfigUSE_FTP != 0 ) && ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+    typedef struct xFTP_LIST_CACHE_ENTRY
+    {
+        char pcDirectory[ ffconfigMAX_FILENAME ]; /* Empty when the entry is free. */
+        char * pcListing;                         /* ipconfigFTP_LIST_CACHE_SIZE bytes, allocated when first used. */
+        size_t uxLength;
+        BaseType_t xComplete;                     /* pdFALSE while the listing is being stored. */
+        BaseType_t xDirCount;
+        uint32_t ulGeneration;                    /* The listing is stale when this differs from the current generation. */
+        uint32_t ulLastUsed;                      /* The value of ulListClock when it was last used. */
+        UBaseType_t uxUsers;                      /* The number of clients storing or sending it. */
+        char pcClientAck[ 128 ];                  /* The "226" reply that follows the listing. */
+    } FTPListCacheEntry_t;
+#endif /* ipconfigFTP_LIST_CACHE_ENTRIES */
+
 struct xFTP_CLIENT
 {
     /* This define contains fields which must come first within each of the client structs */
@@ -125,6 +329,16 @@ struct xFTP_CLIENT
     char pcFileName[ ffconfigMAX_FILENAME ];
     char pcConnectionAck[ 128 ];
     char pcClientAck[ 128 ];
+    #if ( ipconfigFTP_STREAMING != 0 )
+        uint8_t * pucStream;    /* The staging buffer of STOR and RETR, allocated per transfer. */
+        size_t uxStreamStart;   /* RETR: the offset of the first byte not sent yet. */
+        size_t uxStreamCount;   /* The number of bytes waiting in pucStream. */
+        TickType_t xLastReport; /* When the throughput was last logged. */
+    #endif
+    #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+        FTPListCacheEntry_t * pxListCache; /* The listing being stored in, or sent from, the cache, or NULL. */
+        size_t uxListOffset;               /* The next byte of a cached listing to send. */
+    #endif
     union
     {
         struct
@@ -148,7 +362,8 @@ struct xFTP_CLIENT
                 bDirHasEntry : 1,     /* pdTRUE if ff_findfirst() was successful. */
                 bClientConnected : 1, /* pdTRUE after connect() or accept() has succeeded. */
                 bEmptyFile : 1,       /* pdTRUE if a connection-without-data was received. */
-                bHadError : 1;        /* pdTRUE if a transfer got aborted because of an error. */
+                bHadError : 1,        /* pdTRUE if a transfer got aborted because of an error. */
+                bListFromCache : 1;   /* pdTRUE if pxListCache is sent, not stored. */
         };
         uint32_t ulConnFlags;
     }
@@ -172,6 +387,33 @@ BaseType_t xMakeRelative( FTPClient_t * pxClient,
                           BaseType_t xBufferLength,
                           const char * pcFileName );
 
+/*
+ * ipconfigTCP_SERVER_FILE_BLOCK_SIZE : the sector size of the file system.
+ * xTCPServerSendFile() reads whole, aligned sectors where it can, so that
+ * +FAT copies them from the disk to the TX stream without using its cache.
+ */
+#ifndef ipconfigTCP_SERVER_FILE_BLOCK_SIZE
+    #define ipconfigTCP_SERVER_FILE_BLOCK_SIZE    ( 512u )
+#endif
+
+/* The flags of xTCPServerSendFile(). */
+#define tcpserverSEND_ZERO_COPY           ( 0x01 ) /* Read into the TX stream of the socket. */
+#define tcpserverSEND_CLOSE_AFTER_SEND    ( 0x02 ) /* Set FREERTOS_SO_CLOSE_AFTER_SEND with the last byte. */
+
+/*
+ * Send at most *puxBytesLeft bytes from pxFile to xSocket, as much as the TX
+ * stream will take without blocking, and decrease *puxBytesLeft.  pcBuffer is
+ * used when the data can not be read into the TX stream directly.  Returns the
+ * number of bytes queued, -pdFREERTOS_ERRNO_EIO after a read error, which
+ * also shuts down the connection, or the negative result of FreeRTOS_send().
+ */
+BaseType_t xTCPServerSendFile( Socket_t xSocket,
+                               FF_FILE * pxFile,
+                               size_t * puxBytesLeft,
+                               char * pcBuffer,
+                               size_t uxBufferSize,
+                               BaseType_t xFlags );
+
 struct xTCP_SERVER
 {
     SocketSet_t xSocketSet;
@@ -182,10 +424,36 @@ struct xTCP_SERVER
 
     #if ( ipconfigUSE_FTP != 0 )
         char pcNewDir[ ffconfigMAX_FILENAME ];
+        #if ( ipconfigFTP_LIST_CACHE_ENTRIES > 0 )
+            uint32_t ulListClock;
+            FTPListCacheEntry_t xListCache[ ipconfigFTP_LIST_CACHE_ENTRIES ];
+        #endif
     #endif
     #if ( ipconfigUSE_HTTP != 0 )
         char pcContentsType[ 40 ];  /* Space for the msg: "text/javascript" */
-        char pcExtraContents[ 40 ]; /* Space for the msg: "Content-Length: 346500" */
+        char pcExtraContents[ 192 ]; /* Space for the msg: "Content-Length: 346500", plus "Content-Range", "ETag", "Content-Encoding: gzip" and "Vary" */
+        #if ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+            uint32_t ulCacheClock;
+            HTTPCacheEntry_t xCache[ ipconfigHTTP_CACHE_ENTRIES ];
+        #endif
+    #endif
+    #if ( ipconfigTCP_SERVER_WORKERS > 0 )
+        BaseType_t xWorkerCount;                                  /* The accepting server: the number of workers created. */
+        struct xTCP_SERVER * pxWorkers[ ipconfigTCP_SERVER_WORKERS ];
+        QueueHandle_t xNewClients;                                /* A worker: clients handed over to it. */
+        volatile UBaseType_t uxClientCount;                       /* A worker: the number of clients it owns. */
+        #if ( ipconfigUSE_HTTP != 0 ) && ( ipconfigHTTP_CACHE_ENTRIES > 0 )
+            volatile BaseType_t xFlushCache;                      /* A worker: flush its HTTP cache. */
+        #endif
+    #endif
+    #if ( tcpserverUSE_ADMISSION != 0 )
+        struct xTCP_SERVER * pxAcceptor; /* A worker: the server that admitted its clients. */
+        volatile UBaseType_t uxAdmitted; /* The number of clients admitted. */
+        volatile size_t uxWindowMemory;  /* The TCP buffer space of those clients. */
+        uint32_t ulQueued;               /* The number of connections admitted after waiting. */
+        uint32_t ulRefused;              /* The number of connections refused. */
+        UBaseType_t uxWaitingCount;
+        TCPWaiting_t xWaiting[ ipconfigTCP_SERVER_MAX_WAITING ];
     #endif
     BaseType_t xServerCount;
     TCPClient_t * pxClients;
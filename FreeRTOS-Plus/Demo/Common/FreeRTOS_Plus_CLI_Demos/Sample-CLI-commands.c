@@ -53,6 +53,42 @@
     #define configINCLUDE_QUERY_HEAP_COMMAND    0
 #endif
 
+#ifndef configUSE_MUTEX_PROFILER
+    #define configUSE_MUTEX_PROFILER    0
+#endif
+
+#if ( configUSE_MUTEX_PROFILER == 1 )
+    #include "queue.h"
+    #include "MutexProfiler.h"
+
+/* The number of mutexes listed by the mutex-stats command. */
+    #ifndef configMUTEX_STATS_COMMAND_ENTRIES
+        #define configMUTEX_STATS_COMMAND_ENTRIES    8
+    #endif
+#endif
+
+#ifndef configUSE_STACK_SIZER
+    #define configUSE_STACK_SIZER    0
+#endif
+
+#if ( configUSE_STACK_SIZER == 1 )
+    #include "StackSizer.h"
+#endif
+
+#ifndef configUSE_TASK_STATS_EXPORT
+    #define configUSE_TASK_STATS_EXPORT    0
+#endif
+
+#if ( configUSE_TASK_STATS_EXPORT == 1 )
+    #include "TaskStatsExport.h"
+
+/* The largest sample the task-stats-cbor command can output, in bytes
+ * before base64 encoding. */
+    #ifndef configTASK_STATS_EXPORT_BUFFER_SIZE
+        #define configTASK_STATS_EXPORT_BUFFER_SIZE    512
+    #endif
+#endif
+
 /*
  * The function that registers the commands that are defined within this file.
  */
@@ -106,6 +142,33 @@ static BaseType_t prvParameterEchoCommand( char * pcWriteBuffer,
                                                 const char * pcCommandString );
 #endif
 
+/*
+ * Implements the "mutex-stats" command.
+ */
+#if ( configUSE_MUTEX_PROFILER == 1 )
+    static BaseType_t prvMutexStatsCommand( char * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const char * pcCommandString );
+#endif
+
+/*
+ * Implements the "stack-sizes" command.
+ */
+#if ( configUSE_STACK_SIZER == 1 )
+    static BaseType_t prvStackSizesCommand( char * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const char * pcCommandString );
+#endif
+
+/*
+ * Implements the "task-stats-cbor" command.
+ */
+#if ( configUSE_TASK_STATS_EXPORT == 1 )
+    static BaseType_t prvTaskStatsCBORCommand( char * pcWriteBuffer,
+                                               size_t xWriteBufferLen,
+                                               const char * pcCommandString );
+#endif
+
 /* Structure that defines the "task-stats" command line command.  This generates
  * a table that gives information on each task in the system. */
 static const CLI_Command_Definition_t xTaskStats =
@@ -175,6 +238,48 @@ static const CLI_Command_Definition_t xParameterEcho =
     };
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
 
+#if ( configUSE_MUTEX_PROFILER == 1 )
+
+/* Structure that defines the "mutex-stats" command line command.  This lists
+ * the most contended mutexes, or with the parameter "reset" zeros the
+ * counters. */
+    static const CLI_Command_Definition_t xMutexStats =
+    {
+        "mutex-stats",
+        "\r\nmutex-stats [reset]:\r\n Displays the most contended mutexes, or zeros the counters\r\n",
+        prvMutexStatsCommand, /* The function to run. */
+        -1                    /* Either no parameter or "reset". */
+    };
+#endif /* configUSE_MUTEX_PROFILER */
+
+#if ( configUSE_STACK_SIZER == 1 )
+
+/* Structure that defines the "stack-sizes" command line command.  This lists
+ * the stack depth recommended for each task, and the heap size recommended,
+ * with a margin of stkszMARGIN_PERCENT percent or the percentage given. */
+    static const CLI_Command_Definition_t xStackSizes =
+    {
+        "stack-sizes",
+        "\r\nstack-sizes [margin]:\r\n Displays the stack depth and heap size recommended from what was used, plus margin percent\r\n",
+        prvStackSizesCommand, /* The function to run. */
+        -1                    /* Either no parameter or the margin. */
+    };
+#endif /* configUSE_STACK_SIZER */
+
+#if ( configUSE_TASK_STATS_EXPORT == 1 )
+
+/* Structure that defines the "task-stats-cbor" command line command.  This
+ * outputs a CBOR sample of the task states and run times as base64, with run
+ * times since the previous sample if the parameter "delta" is given. */
+    static const CLI_Command_Definition_t xTaskStatsCBOR =
+    {
+        "task-stats-cbor",
+        "\r\ntask-stats-cbor [delta]:\r\n Outputs the state and run time of each task as base64 encoded CBOR\r\n",
+        prvTaskStatsCBORCommand, /* The function to run. */
+        -1                       /* Either no parameter or "delta". */
+    };
+#endif /* configUSE_TASK_STATS_EXPORT */
+
 /*-----------------------------------------------------------*/
 
 void vRegisterSampleCLICommands( void )
@@ -201,6 +306,24 @@ void vRegisterSampleCLICommands( void )
         FreeRTOS_CLIRegisterCommand( &xStartStopTrace );
     }
     #endif
+
+    #if ( configUSE_MUTEX_PROFILER == 1 )
+    {
+        FreeRTOS_CLIRegisterCommand( &xMutexStats );
+    }
+    #endif
+
+    #if ( configUSE_STACK_SIZER == 1 )
+    {
+        FreeRTOS_CLIRegisterCommand( &xStackSizes );
+    }
+    #endif
+
+    #if ( configUSE_TASK_STATS_EXPORT == 1 )
+    {
+        FreeRTOS_CLIRegisterCommand( &xTaskStatsCBOR );
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -505,3 +628,257 @@ static BaseType_t prvParameterEchoCommand( char * pcWriteBuffer,
     }
 
 #endif /* configINCLUDE_TRACE_RELATED_CLI_COMMANDS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEX_PROFILER == 1 )
+
+    static BaseType_t prvMutexStatsCommand( char * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const char * pcCommandString )
+    {
+        static MutexProfile_t xProfiles[ configMUTEX_STATS_COMMAND_ENTRIES ];
+        static uint32_t ulProfiles = 0, ulNextProfile = 0;
+        static BaseType_t xHeaderPrinted = pdFALSE;
+        const MutexProfile_t * pxProfile;
+        const char * pcParameter, * pcName;
+        BaseType_t xParameterStringLength, xReturn;
+
+        /* Remove compile time warnings about unused parameters, and check the
+         * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
+         * write buffer length is adequate, so does not check for buffer overflows. */
+        ( void ) xWriteBufferLen;
+        configASSERT( pcWriteBuffer );
+
+        if( xHeaderPrinted == pdFALSE )
+        {
+            pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+
+            if( ( pcParameter != NULL ) && ( strncmp( pcParameter, "reset", strlen( "reset" ) ) == 0 ) )
+            {
+                vMutexProfilerReset();
+                sprintf( pcWriteBuffer, "Mutex counters zeroed.\r\n" );
+                return pdFALSE;
+            }
+
+            /* Take a copy so the table is consistent across the calls that
+             * print it a line at a time. */
+            ulProfiles = ulMutexProfilerGetTop( xProfiles, configMUTEX_STATS_COMMAND_ENTRIES );
+            ulNextProfile = 0;
+            xHeaderPrinted = pdTRUE;
+
+            sprintf( pcWriteBuffer, "Mutex              Takes  Contended  Timeouts  Inherits  Avg wait  Max wait  Avg hold  Max hold\r\n" );
+            xReturn = ( ulProfiles != 0 ) ? pdTRUE : pdFALSE;
+        }
+        else
+        {
+            pxProfile = &( xProfiles[ ulNextProfile ] );
+            pcName = NULL;
+
+            #if ( configQUEUE_REGISTRY_SIZE > 0 )
+            {
+                pcName = pcQueueGetName( ( QueueHandle_t ) pxProfile->pvMutex );
+            }
+            #endif
+
+            sprintf( pcWriteBuffer, "%-16s %7lu %10lu %9lu %9lu %9llu %9llu %9llu %9llu\r\n",
+                     ( pcName != NULL ) ? pcName : "(unnamed)",
+                     ( unsigned long ) pxProfile->ulAcquires,
+                     ( unsigned long ) pxProfile->ulContended,
+                     ( unsigned long ) pxProfile->ulTimeouts,
+                     ( unsigned long ) pxProfile->ulInheritances,
+                     ( unsigned long long ) ( ( pxProfile->ulContended != 0 ) ? ( pxProfile->ullWaitTime / pxProfile->ulContended ) : 0 ),
+                     ( unsigned long long ) pxProfile->ullMaxWait,
+                     ( unsigned long long ) ( ( pxProfile->ulAcquires != 0 ) ? ( pxProfile->ullHoldTime / pxProfile->ulAcquires ) : 0 ),
+                     ( unsigned long long ) pxProfile->ullMaxHold );
+
+            ulNextProfile++;
+            xReturn = ( ulNextProfile < ulProfiles ) ? pdTRUE : pdFALSE;
+        }
+
+        if( xReturn == pdFALSE )
+        {
+            /* Start from the header next time. */
+            xHeaderPrinted = pdFALSE;
+        }
+
+        return xReturn;
+    }
+
+#endif /* configUSE_MUTEX_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_STACK_SIZER == 1 )
+
+    static BaseType_t prvStackSizesCommand( char * pcWriteBuffer,
+                                            size_t xWriteBufferLen,
+                                            const char * pcCommandString )
+    {
+        static StackSizerTask_t xTasks[ stkszMAX_TASKS ];
+        static uint32_t ulTasks = 0, ulNextTask = 0, ulMarginPercent = stkszMARGIN_PERCENT;
+        static BaseType_t xHeaderPrinted = pdFALSE;
+        const StackSizerTask_t * pxTask;
+        const char * pcParameter;
+        BaseType_t xParameterStringLength, xReturn;
+
+        /* Remove compile time warnings about unused parameters, and check the
+         * write buffer is not NULL.  NOTE - for simplicity, this example assumes the
+         * write buffer length is adequate, so does not check for buffer overflows. */
+        ( void ) xWriteBufferLen;
+        configASSERT( pcWriteBuffer );
+
+        if( xHeaderPrinted == pdFALSE )
+        {
+            pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+            ulMarginPercent = ( pcParameter != NULL ) ? ( uint32_t ) strtoul( pcParameter, NULL, 10 ) : stkszMARGIN_PERCENT;
+
+            /* Take a copy so the table is consistent across the calls that
+             * print it a line at a time.  This also samples every task. */
+            ulTasks = ulStackSizerGetTasks( xTasks, stkszMAX_TASKS );
+            ulNextTask = 0;
+            xHeaderPrinted = pdTRUE;
+
+            sprintf( pcWriteBuffer, "Task         Depth  Min free  Recommended (+%lu%%)\r\n", ( unsigned long ) ulMarginPercent );
+            xReturn = pdTRUE;
+        }
+        else if( ulNextTask < ulTasks )
+        {
+            pxTask = &( xTasks[ ulNextTask ] );
+
+            if( pxTask->ulSamples == 0 )
+            {
+                /* Deleted before it was sampled. */
+                sprintf( pcWriteBuffer, "%-12s %5lu         -            -\r\n",
+                         pxTask->cName,
+                         ( unsigned long ) pxTask->ulDepth );
+            }
+            else
+            {
+                sprintf( pcWriteBuffer, "%-12s %5lu %9lu %12lu\r\n",
+                         pxTask->cName,
+                         ( unsigned long ) pxTask->ulDepth,
+                         ( unsigned long ) pxTask->ulMinimumFree,
+                         ( unsigned long ) ulStackSizerRecommendedDepth( pxTask, ulMarginPercent ) );
+            }
+
+            ulNextTask++;
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            /* The last line summarises what is not in the table. */
+            pcWriteBuffer[ 0 ] = '\0';
+
+            if( ulStackSizerGetUntracked() != 0 )
+            {
+                sprintf( pcWriteBuffer, "%lu tasks were not recorded, increase stkszMAX_TASKS\r\n",
+                         ( unsigned long ) ulStackSizerGetUntracked() );
+            }
+
+            #if ( stkszINCLUDE_HEAP == 1 )
+            {
+                sprintf( pcWriteBuffer + strlen( pcWriteBuffer ), "Heap %lu bytes, minimum ever free %lu, recommended %lu\r\n",
+                         ( unsigned long ) ulStackSizerHeapSize(),
+                         ( unsigned long ) ulStackSizerHeapMinimumEverFree(),
+                         ( unsigned long ) ulStackSizerRecommendedHeapSize( ulMarginPercent ) );
+            }
+            #endif
+
+            xReturn = pdFALSE;
+        }
+
+        if( xReturn == pdFALSE )
+        {
+            /* Start from the header next time. */
+            xHeaderPrinted = pdFALSE;
+        }
+
+        return xReturn;
+    }
+
+#endif /* configUSE_STACK_SIZER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_STATS_EXPORT == 1 )
+
+    static BaseType_t prvTaskStatsCBORCommand( char * pcWriteBuffer,
+                                               size_t xWriteBufferLen,
+                                               const char * pcCommandString )
+    {
+        static const char cBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        static uint8_t ucSample[ configTASK_STATS_EXPORT_BUFFER_SIZE ];
+        static size_t xSampleLength = 0, xNextByte = 0;
+        const char * pcParameter;
+        BaseType_t xParameterStringLength, xDeltas;
+        size_t xGroups, xBytes;
+        uint32_t ulGroup;
+
+        configASSERT( pcWriteBuffer );
+        configASSERT( xWriteBufferLen > 4 );
+
+        if( xSampleLength == 0 )
+        {
+            pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterStringLength );
+            xDeltas = ( ( pcParameter != NULL ) && ( strncmp( pcParameter, "delta", strlen( "delta" ) ) == 0 ) ) ? pdTRUE : pdFALSE;
+
+            /* Take the whole sample now, so it is consistent across the calls
+             * that output it. */
+            xSampleLength = xTaskStatsExportSample( ucSample, sizeof( ucSample ), xDeltas );
+            xNextByte = 0;
+
+            if( xSampleLength == 0 )
+            {
+                snprintf( pcWriteBuffer, xWriteBufferLen, "Sample too large\r\n" );
+                return pdFALSE;
+            }
+        }
+
+        /* As many groups of 3 bytes, which become 4 characters, as fit with
+         * the line end and the terminator. */
+        xGroups = ( xWriteBufferLen - 3 ) / 4;
+
+        while( ( xGroups > 0 ) && ( xNextByte < xSampleLength ) )
+        {
+            xBytes = xSampleLength - xNextByte;
+
+            if( xBytes > 3 )
+            {
+                xBytes = 3;
+            }
+
+            ulGroup = ( uint32_t ) ucSample[ xNextByte ] << 16;
+
+            if( xBytes > 1 )
+            {
+                ulGroup |= ( uint32_t ) ucSample[ xNextByte + 1 ] << 8;
+            }
+
+            if( xBytes > 2 )
+            {
+                ulGroup |= ( uint32_t ) ucSample[ xNextByte + 2 ];
+            }
+
+            pcWriteBuffer[ 0 ] = cBase64[ ( ulGroup >> 18 ) & 0x3fUL ];
+            pcWriteBuffer[ 1 ] = cBase64[ ( ulGroup >> 12 ) & 0x3fUL ];
+            pcWriteBuffer[ 2 ] = ( xBytes > 1 ) ? cBase64[ ( ulGroup >> 6 ) & 0x3fUL ] : '=';
+            pcWriteBuffer[ 3 ] = ( xBytes > 2 ) ? cBase64[ ulGroup & 0x3fUL ] : '=';
+
+            pcWriteBuffer += 4;
+            xNextByte += xBytes;
+            xGroups--;
+        }
+
+        *pcWriteBuffer = 0x00;
+
+        if( xNextByte < xSampleLength )
+        {
+            /* More to output. */
+            return pdTRUE;
+        }
+
+        strcpy( pcWriteBuffer, "\r\n" );
+        xSampleLength = 0;
+
+        return pdFALSE;
+    }
+
+#endif /* configUSE_TASK_STATS_EXPORT */
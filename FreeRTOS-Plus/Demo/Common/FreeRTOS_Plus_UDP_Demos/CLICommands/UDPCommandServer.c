@@ -48,8 +48,35 @@
 /* Dimensions the buffer into which string outputs can be placed. */
 #define cmdMAX_OUTPUT_SIZE             1250
 
+/* The largest datagram that is sent or received without being fragmented.
+ * The output of all the commands in one received datagram is packed into
+ * datagrams of this size. */
+#ifndef cmdMAX_DATAGRAM_SIZE
+    #ifdef ipconfigNETWORK_MTU
+        #define cmdMAX_DATAGRAM_SIZE    ( ipconfigNETWORK_MTU - 28 )
+    #else
+        #define cmdMAX_DATAGRAM_SIZE    1472
+    #endif
+#endif
+
 /* Dimensions the buffer passed to the recvfrom() call. */
-#define cmdSOCKET_INPUT_BUFFER_SIZE    60
+#define cmdSOCKET_INPUT_BUFFER_SIZE    cmdMAX_DATAGRAM_SIZE
+
+/* A datagram whose first line is "#<sequence number>" is a batch.  All its
+ * lines are executed, and the output is sent in up to cmdMAX_REPLY_PARTS
+ * datagrams, each starting with the line "#<sequence>:<part><flag>", where
+ * sequence and part are 10 and 2 decimal digits, and the flag is '+' when
+ * more parts follow, '.' for the last part, or '!' for the last part of an
+ * output that did not fit in cmdMAX_REPLY_PARTS datagrams.  The reply is kept, so when a batch with the
+ * same sequence number arrives again from the same address, e.g. because a
+ * part of the reply got lost, the reply is sent again without executing the
+ * commands a second time. */
+#ifndef cmdMAX_REPLY_PARTS
+    #define cmdMAX_REPLY_PARTS    8
+#endif
+
+/* The length of "#0123456789:01+\n". */
+#define cmdREPLY_HEADER_SIZE      16
 
 /*
  * The task that runs FreeRTOS+CLI.
@@ -61,6 +88,55 @@ void vUDPCommandInterpreterTask( void * pvParameters );
  */
 static xSocket_t prvOpenUDPServerSocket( uint16_t usPort );
 
+/*
+ * Return pdTRUE and the sequence number when the datagram starts with a
+ * "#<sequence number>" line, and set *plStart to the first byte after it.
+ */
+static BaseType_t prvParseSequence( const char * pcBuffer,
+                                    long lBytes,
+                                    uint32_t * pulSequence,
+                                    long * plStart );
+
+/*
+ * Start a new reply, and add text to it.  Full datagrams are sent as soon as
+ * more text follows, the last one by prvReplyEnd().
+ */
+static void prvReplyStart( BaseType_t xBatch,
+                           uint32_t ulSequence );
+static void prvReplyAdd( xSocket_t xSocket,
+                         const char * pcText,
+                         size_t uxLength );
+static void prvReplyEnd( xSocket_t xSocket );
+
+/*
+ * Send all the datagrams of the last batch reply again.
+ */
+static void prvReplyResend( xSocket_t xSocket );
+
+/*
+ * Send one part of the reply.
+ */
+static void prvReplySendPart( xSocket_t xSocket,
+                              BaseType_t xPart,
+                              char cFlag );
+
+/*-----------------------------------------------------------*/
+
+/* The reply to the last datagram. */
+static struct xREPLY
+{
+    struct freertos_sockaddr xClient; /* Where the reply goes to. */
+    uint32_t ulSequence;              /* The sequence number of the batch. */
+    BaseType_t xBatch;                /* pdTRUE when the datagram was a batch, and the reply has headers. */
+    BaseType_t xValid;                /* pdTRUE when the parts can be sent again. */
+    BaseType_t xTruncated;            /* pdTRUE when output could not be stored. */
+    BaseType_t xPart;                 /* The part being filled. */
+    size_t uxLength[ cmdMAX_REPLY_PARTS ];
+    char cParts[ cmdMAX_REPLY_PARTS ][ cmdMAX_DATAGRAM_SIZE ];
+} xReply;
+
+static socklen_t xClientAddressLength = 0; /* This is required as a parameter to maintain the sendto() Berkeley sockets API - but it is not actually used so can take any value. */
+
 /*-----------------------------------------------------------*/
 
 void vStartUDPCommandInterpreterTask( uint16_t usStackSize,
@@ -81,9 +157,9 @@ void vUDPCommandInterpreterTask( void * pvParameters )
     long lBytes, lByte;
     signed char cInChar, cInputIndex = 0;
     static char cInputString[ cmdMAX_INPUT_SIZE ], cOutputString[ cmdMAX_OUTPUT_SIZE ], cLocalBuffer[ cmdSOCKET_INPUT_BUFFER_SIZE ];
-    BaseType_t xMoreDataToFollow;
+    BaseType_t xMoreDataToFollow, xBatch;
     struct freertos_sockaddr xClient;
-    socklen_t xClientAddressLength = 0; /* This is required as a parameter to maintain the sendto() Berkeley sockets API - but it is not actually used so can take any value. */
+    uint32_t ulSequence;
     xSocket_t xSocket;
 
     /* Just to prevent compiler warnings. */
@@ -105,6 +181,35 @@ void vUDPCommandInterpreterTask( void * pvParameters )
             {
                 /* Process each received byte in turn. */
                 lByte = 0;
+                xBatch = prvParseSequence( cLocalBuffer, lBytes, &ulSequence, &lByte );
+
+                if( xBatch != pdFALSE )
+                {
+                    if( ( xReply.xValid != pdFALSE ) &&
+                        ( xReply.ulSequence == ulSequence ) &&
+                        ( xReply.xClient.sin_addr == xClient.sin_addr ) &&
+                        ( xReply.xClient.sin_port == xClient.sin_port ) )
+                    {
+                        /* A retry of the last batch: it has been executed
+                         * already. */
+                        prvReplyResend( xSocket );
+                        continue;
+                    }
+
+                    /* A batch is complete in itself: it does not continue a
+                     * line from an earlier datagram, and its last line does not
+                     * need a newline. */
+                    cInputIndex = 0;
+                    memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
+
+                    if( ( lBytes > lByte ) && ( cLocalBuffer[ lBytes - 1 ] != '\n' ) && ( lBytes < ( long ) sizeof( cLocalBuffer ) ) )
+                    {
+                        cLocalBuffer[ lBytes++ ] = '\n';
+                    }
+                }
+
+                xReply.xClient = xClient;
+                prvReplyStart( xBatch, ulSequence );
 
                 while( lByte < lBytes )
                 {
@@ -123,20 +228,20 @@ void vUDPCommandInterpreterTask( void * pvParameters )
                             /* Pass the string to FreeRTOS+CLI. */
                             xMoreDataToFollow = FreeRTOS_CLIProcessCommand( cInputString, cOutputString, cmdMAX_OUTPUT_SIZE );
 
-                            /* Send the output generated by the command's
-                             * implementation. */
-                            FreeRTOS_sendto( xSocket, cOutputString, strlen( cOutputString ), 0, &xClient, xClientAddressLength );
+                            /* Add the output generated by the command's
+                             * implementation to the reply. */
+                            prvReplyAdd( xSocket, cOutputString, strlen( cOutputString ) );
                         } while( xMoreDataToFollow != pdFALSE ); /* Until the command does not generate any more output. */
 
                         /* All the strings generated by the command processing
-                         * have been sent.  Clear the input string ready to receive
-                         * the next command. */
+                         * have been added.  Clear the input string ready to
+                         * receive the next command. */
                         cInputIndex = 0;
                         memset( cInputString, 0x00, cmdMAX_INPUT_SIZE );
 
-                        /* Transmit a spacer, just to make the command console
-                         * easier to read. */
-                        FreeRTOS_sendto( xSocket, "\r\n", strlen( "\r\n" ), 0, &xClient, xClientAddressLength );
+                        /* Add a spacer, just to make the command console easier
+                         * to read. */
+                        prvReplyAdd( xSocket, "\r\n", strlen( "\r\n" ) );
                     }
                     else
                     {
@@ -168,6 +273,9 @@ void vUDPCommandInterpreterTask( void * pvParameters )
                         }
                     }
                 }
+
+                /* Send what has not been sent yet. */
+                prvReplyEnd( xSocket );
             }
         }
     }
@@ -179,6 +287,147 @@ void vUDPCommandInterpreterTask( void * pvParameters )
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvParseSequence( const char * pcBuffer,
+                                    long lBytes,
+                                    uint32_t * pulSequence,
+                                    long * plStart )
+{
+    BaseType_t xResult = pdFALSE;
+    uint32_t ulSequence = 0UL;
+    long lIndex = 1;
+
+    if( ( lBytes > 1 ) && ( pcBuffer[ 0 ] == '#' ) && ( pcBuffer[ 1 ] >= '0' ) && ( pcBuffer[ 1 ] <= '9' ) )
+    {
+        for( ; lIndex < lBytes; lIndex++ )
+        {
+            char cChar = pcBuffer[ lIndex ];
+
+            if( ( cChar >= '0' ) && ( cChar <= '9' ) )
+            {
+                ulSequence = ( ulSequence * 10UL ) + ( uint32_t ) ( cChar - '0' );
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        /* Skip the rest of the line. */
+        while( ( lIndex < lBytes ) && ( pcBuffer[ lIndex ] != '\n' ) )
+        {
+            lIndex++;
+        }
+
+        *pulSequence = ulSequence;
+        *plStart = lIndex + 1;
+        xResult = pdTRUE;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyStart( BaseType_t xBatch,
+                           uint32_t ulSequence )
+{
+    xReply.xBatch = xBatch;
+    xReply.ulSequence = ulSequence;
+    xReply.xValid = pdFALSE;
+    xReply.xTruncated = pdFALSE;
+    xReply.xPart = 0;
+    xReply.uxLength[ 0 ] = ( xBatch != pdFALSE ) ? cmdREPLY_HEADER_SIZE : 0U;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyAdd( xSocket_t xSocket,
+                         const char * pcText,
+                         size_t uxLength )
+{
+    while( ( uxLength > 0U ) && ( xReply.xTruncated == pdFALSE ) )
+    {
+        size_t uxSpace = sizeof( xReply.cParts[ 0 ] ) - xReply.uxLength[ xReply.xPart ];
+        size_t uxCount;
+
+        if( uxSpace == 0U )
+        {
+            if( ( xReply.xBatch != pdFALSE ) && ( xReply.xPart >= ( cmdMAX_REPLY_PARTS - 1 ) ) )
+            {
+                /* No more parts can be kept for a retry.  prvReplyEnd() will
+                 * send this last part with the flag '!'. */
+                xReply.xTruncated = pdTRUE;
+                break;
+            }
+
+            /* The part is full, and more text follows. */
+            prvReplySendPart( xSocket, xReply.xPart, '+' );
+
+            if( xReply.xBatch == pdFALSE )
+            {
+                /* Without a sequence number there is no retry, so the same
+                 * buffer can be used again. */
+                xReply.uxLength[ 0 ] = 0U;
+            }
+            else
+            {
+                xReply.xPart++;
+                xReply.uxLength[ xReply.xPart ] = cmdREPLY_HEADER_SIZE;
+            }
+
+            continue;
+        }
+
+        uxCount = ( uxLength < uxSpace ) ? uxLength : uxSpace;
+        memcpy( &( xReply.cParts[ xReply.xPart ][ xReply.uxLength[ xReply.xPart ] ] ), pcText, uxCount );
+        xReply.uxLength[ xReply.xPart ] += uxCount;
+        pcText += uxCount;
+        uxLength -= uxCount;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyEnd( xSocket_t xSocket )
+{
+    prvReplySendPart( xSocket, xReply.xPart, ( xReply.xTruncated == pdFALSE ) ? '.' : '!' );
+
+    xReply.xValid = xReply.xBatch;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplyResend( xSocket_t xSocket )
+{
+    BaseType_t xPart;
+
+    for( xPart = 0; xPart <= xReply.xPart; xPart++ )
+    {
+        /* The headers of the parts have been written already. */
+        FreeRTOS_sendto( xSocket, xReply.cParts[ xPart ], xReply.uxLength[ xPart ], 0, &( xReply.xClient ), xClientAddressLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplySendPart( xSocket_t xSocket,
+                              BaseType_t xPart,
+                              char cFlag )
+{
+    char * pcPart = xReply.cParts[ xPart ];
+
+    if( xReply.xBatch != pdFALSE )
+    {
+        char cHeader[ cmdREPLY_HEADER_SIZE + 1 ];
+
+        /* snprintf() writes a terminating zero, which must not end up in the
+         * part. */
+        snprintf( cHeader, sizeof( cHeader ), "#%010lu:%02u%c\n", ( unsigned long ) xReply.ulSequence, ( unsigned ) xPart, cFlag );
+        memcpy( pcPart, cHeader, cmdREPLY_HEADER_SIZE );
+    }
+
+    if( xReply.uxLength[ xPart ] > 0U )
+    {
+        FreeRTOS_sendto( xSocket, pcPart, xReply.uxLength[ xPart ], 0, &( xReply.xClient ), xClientAddressLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
 static xSocket_t prvOpenUDPServerSocket( uint16_t usPort )
 {
     struct freertos_sockaddr xServer;
@@ -0,0 +1,789 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Logging utility that allows FreeRTOS tasks running in the POSIX simulator to
+ * log to stdout, a disk file and a UDP port without making any system calls
+ * themselves.
+ *
+ * This is the POSIX counterpart of Logging_WinSim.c.  Messages are placed in a
+ * ring of message slots, which a pthread that is not a FreeRTOS task empties
+ * periodically, writing all the waiting messages at once.  Any number of tasks
+ * can claim slots without a lock, so logging never blocks the calling task.
+ * Messages logged while the ring is full are dropped and counted.  UDP messages
+ * are sent with host sockets from the same pthread, so FreeRTOS+TCP is not
+ * needed.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo includes. */
+#include "logging.h"
+
+/*-----------------------------------------------------------*/
+
+/* The maximum size to which the log file may grow, before being renamed
+ * to .ful. */
+#define dlLOGGING_FILE_SIZE          ( 40ul * 1024ul * 1024ul )
+
+/* Dimensions the arrays into which print messages are created. */
+#define dlMAX_PRINT_STRING_LENGTH    255
+
+/* The number of message slots in the ring used to pass messages from FreeRTOS
+ * tasks to the logging thread.  Must be a power of 2. */
+#define dlLOGGING_RING_SLOTS         128
+
+/* The logging thread empties the ring this often. */
+#define dlLOGGING_FLUSH_PERIOD_MS    20
+
+/* The messages taken from the ring are joined in a buffer of this size, so that
+ * each output is written once for many messages. */
+#define dlLOGGING_BATCH_SIZE         8192
+
+/* The most a single UDP datagram sent by the logging thread carries. */
+#define dlLOGGING_UDP_MAX_PAYLOAD    1400
+
+/* One message in the ring.  A slot at ring position n is free to be claimed
+ * when ulSequence equals n, and holds a complete message when ulSequence equals
+ * n + 1. */
+typedef struct LogSlot
+{
+    uint32_t ulSequence;
+    size_t xLength;
+    char cMessage[ dlMAX_PRINT_STRING_LENGTH ];
+} LogSlot_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called from vLoggingInit() to start a new disk log file.
+ */
+static void prvFileLoggingInit( void );
+
+/*
+ * Attempt to write messages to the file.
+ */
+static void prvLogToFile( const char * pcMessage,
+                          size_t xLength );
+
+/*
+ * Simply close the logging file, if it is open.
+ */
+static void prvFileClose( void );
+
+/*
+ * Send messages to the UDP port, as datagrams of at most
+ * dlLOGGING_UDP_MAX_PAYLOAD bytes broken at line ends.
+ */
+static void prvLogToUDP( const char * pcMessage,
+                         size_t xLength );
+
+/*
+ * Take every message waiting in the ring and write them out.  Called
+ * periodically by the logging thread, and when the logging is stopped.
+ */
+static void prvLoggingFlushBuffer( void );
+
+/*
+ * Write the first xLength bytes of the batch buffer to every output selected
+ * when vLoggingInit() was called.
+ */
+static void prvLoggingWriteBatch( size_t xLength );
+
+/*
+ * The pthread that performs the actual writing of messages.  It is not a
+ * FreeRTOS task, so the system calls it makes do not disrupt the simulation.
+ */
+static void * prvPosixLoggingThread( void * pvParameter );
+
+/*
+ * Converts IP addresses in a formatted message to dot notation, writing it
+ * into a slot of the ring.
+ */
+static void prvLoggingOutput( const char * pcPrintString );
+
+/*
+ * Claim the next free slot of the ring, returning NULL if the ring is full.
+ * The slot is passed to the logging thread by prvReleaseSlot().
+ */
+static LogSlot_t * prvClaimSlot( uint32_t * pulPosition );
+static void prvReleaseSlot( LogSlot_t * pxSlot,
+                            uint32_t ulPosition );
+
+/*
+ * Registered with atexit() so that messages waiting in the ring are not lost
+ * when the simulator exits.
+ */
+static void prvFlushAtExit( void );
+
+/*-----------------------------------------------------------*/
+
+/* Stores the selected logging targets passed in as parameters to the
+ * vLoggingInit() function. */
+BaseType_t xStdoutLoggingUsed = pdFALSE, xDiskFileLoggingUsed = pdFALSE, xUDPLoggingUsed = pdFALSE;
+
+/* Ring of message slots used to pass messages from the FreeRTOS tasks to the
+ * logging thread.  ulRingHead is the next position to be claimed by a task, and
+ * ulRingTail the next position to be read by the logging thread. */
+static LogSlot_t xLogRing[ dlLOGGING_RING_SLOTS ];
+static uint32_t ulRingHead = 0;
+static uint32_t ulRingTail = 0;
+static BaseType_t xLogRingUsed = pdFALSE;
+
+/* The number of messages dropped because the ring was full. */
+static uint32_t ulDroppedMessages = 0;
+
+/* Buffer in which messages read from the ring are joined before being
+ * written. */
+static char cLogBatch[ dlLOGGING_BATCH_SIZE ];
+
+/* Serialises the readers of the ring - the logging thread, and whichever
+ * thread stops the logging or exits. */
+static pthread_mutex_t xFlushMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Handle to the file used for logging.  This is left open while there are
+ * messages waiting to be logged, then closed again in between logs. */
+static FILE * pxLoggingFileHandle = NULL;
+
+/* File names for the in use and complete (full) log files. */
+static const char * pcLogFileName = "RTOSDemo.log";
+static const char * pcFullLogFileName = "RTOSDemo.ful";
+
+/* As an optimization, the current file size is kept in a variable. */
+static size_t ulSizeOfLoggingFile = 0ul;
+
+/* The host socket and address on/to which print messages are sent. */
+static int iPrintSocket = -1;
+static struct sockaddr_in xPrintUDPAddress;
+
+/* The logging thread, and the flag that tells it to exit. */
+static pthread_t xLoggingThread;
+static BaseType_t xLoggingThreadStarted = pdFALSE;
+static BaseType_t xLoggingThreadExit = pdFALSE;
+
+/* Sequence number printed at the start of each line, and whether the next
+ * vLoggingPrintf() call starts a new line. */
+static BaseType_t xMessageNumber = 0;
+static BaseType_t xAfterLineBreak = pdTRUE;
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStrEndedWithLineBreak( const char * pcStr )
+{
+    BaseType_t xReturn;
+    size_t uxStrLen = strnlen( pcStr, dlMAX_PRINT_STRING_LENGTH );
+
+    if( uxStrLen < 2 )
+    {
+        xReturn = pdFALSE;
+    }
+    else if( pcStr[ uxStrLen - 2 ] != '\r' )
+    {
+        xReturn = pdFALSE;
+    }
+    else if( pcStr[ uxStrLen - 1 ] != '\n' )
+    {
+        xReturn = pdFALSE;
+    }
+    else
+    {
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingInit( BaseType_t xLogToStdout,
+                   BaseType_t xLogToFile,
+                   BaseType_t xLogToUDP,
+                   uint32_t ulRemoteIPAddress,
+                   uint16_t usRemotePort )
+{
+    UBaseType_t uxSlot;
+    sigset_t xAllSignals, xOriginalSignals;
+    int iResult;
+
+    /* Can only be called before the scheduler has started. */
+    configASSERT( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED );
+
+    /* Record which output methods are to be used. */
+    xStdoutLoggingUsed = xLogToStdout;
+    xDiskFileLoggingUsed = xLogToFile;
+    xUDPLoggingUsed = xLogToUDP;
+
+    /* If a disk file is used then initialize it now. */
+    if( xDiskFileLoggingUsed != pdFALSE )
+    {
+        prvFileLoggingInit();
+    }
+
+    /* If UDP logging is used then create the host socket, and store the
+     * address to which the log data will be sent.  The address is in network
+     * byte order, as returned by FreeRTOS_inet_addr(). */
+    if( xUDPLoggingUsed != pdFALSE )
+    {
+        iPrintSocket = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+        configASSERT( iPrintSocket >= 0 );
+
+        memset( &xPrintUDPAddress, 0x00, sizeof( xPrintUDPAddress ) );
+        xPrintUDPAddress.sin_family = AF_INET;
+        xPrintUDPAddress.sin_port = htons( usRemotePort );
+        xPrintUDPAddress.sin_addr.s_addr = ulRemoteIPAddress;
+    }
+
+    if( ( xStdoutLoggingUsed != pdFALSE ) || ( xDiskFileLoggingUsed != pdFALSE ) || ( xUDPLoggingUsed != pdFALSE ) )
+    {
+        /* Each slot is free for the first pass around the ring. */
+        for( uxSlot = 0; uxSlot < dlLOGGING_RING_SLOTS; uxSlot++ )
+        {
+            xLogRing[ uxSlot ].ulSequence = ( uint32_t ) uxSlot;
+        }
+
+        ulRingHead = 0;
+        ulRingTail = 0;
+        xLogRingUsed = pdTRUE;
+        __atomic_store_n( &xLoggingThreadExit, pdFALSE, __ATOMIC_RELAXED );
+
+        /* The POSIX port drives the tick with a signal.  Block every signal
+         * while the logging thread is created, so that it inherits a mask that
+         * leaves the signals to the FreeRTOS threads. */
+        ( void ) sigfillset( &xAllSignals );
+        ( void ) pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOriginalSignals );
+        iResult = pthread_create( &xLoggingThread, NULL, prvPosixLoggingThread, NULL );
+        ( void ) pthread_sigmask( SIG_SETMASK, &xOriginalSignals, NULL );
+        configASSERT( iResult == 0 );
+
+        xLoggingThreadStarted = ( iResult == 0 ) ? pdTRUE : pdFALSE;
+
+        ( void ) atexit( prvFlushAtExit );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static LogSlot_t * prvClaimSlot( uint32_t * pulPosition )
+{
+    LogSlot_t * pxSlot;
+    uint32_t ulPosition = __atomic_load_n( &ulRingHead, __ATOMIC_RELAXED );
+    int32_t lDifference;
+
+    for( ; ; )
+    {
+        pxSlot = &( xLogRing[ ulPosition & ( dlLOGGING_RING_SLOTS - 1 ) ] );
+        lDifference = ( int32_t ) ( __atomic_load_n( &( pxSlot->ulSequence ), __ATOMIC_ACQUIRE ) - ulPosition );
+
+        if( lDifference == 0 )
+        {
+            /* The slot is free - try to move the head past it.  If another task
+             * moved the head first then ulPosition is updated to where it now
+             * is, and the loop tries again. */
+            if( __atomic_compare_exchange_n( &ulRingHead, &ulPosition, ulPosition + 1UL, pdFALSE,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
+        else if( lDifference < 0 )
+        {
+            /* The slot still holds the message written one pass ago, so the
+             * ring is full. */
+            pxSlot = NULL;
+            break;
+        }
+        else
+        {
+            /* Another task has claimed this slot already. */
+            ulPosition = __atomic_load_n( &ulRingHead, __ATOMIC_RELAXED );
+        }
+    }
+
+    *pulPosition = ulPosition;
+
+    return pxSlot;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseSlot( LogSlot_t * pxSlot,
+                            uint32_t ulPosition )
+{
+    /* The release store makes the message visible to the logging thread
+     * before the sequence number that says it is there. */
+    __atomic_store_n( &( pxSlot->ulSequence ), ulPosition + 1UL, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingOutput( const char * pcPrintString )
+{
+    const char * pcSource;
+    char * pcTarget, * pcBegin, * pcLimit;
+    size_t rc;
+    uint32_t ulIPAddress;
+    LogSlot_t * pxSlot;
+    uint32_t ulPosition;
+
+    pxSlot = prvClaimSlot( &ulPosition );
+
+    if( pxSlot == NULL )
+    {
+        ( void ) __atomic_fetch_add( &ulDroppedMessages, 1UL, __ATOMIC_RELAXED );
+    }
+    else
+    {
+        /* For ease of viewing, copy the string into the slot, converting IP
+         * addresses to dot notation on the way.  Stop with room left for one
+         * address in dot notation, the line ending and the terminator. */
+        pcSource = pcPrintString;
+        pcTarget = pxSlot->cMessage;
+        pcLimit = pxSlot->cMessage + dlMAX_PRINT_STRING_LENGTH - 17 - 2;
+
+        while( ( ( *pcSource ) != '\0' ) && ( pcTarget < pcLimit ) )
+        {
+            *pcTarget = *pcSource;
+            pcTarget++;
+            pcSource++;
+
+            /* Look forward for an IP address denoted by 'ip'. */
+            if( ( isxdigit( ( unsigned char ) pcSource[ 0 ] ) != 0 ) && ( pcSource[ 1 ] == 'i' ) && ( pcSource[ 2 ] == 'p' ) )
+            {
+                *pcTarget = *pcSource;
+                pcTarget++;
+                *pcTarget = '\0';
+                pcBegin = pcTarget - 8;
+
+                if( pcBegin < pxSlot->cMessage )
+                {
+                    pcBegin = pxSlot->cMessage;
+                }
+
+                while( ( pcTarget > pcBegin ) && ( isxdigit( ( unsigned char ) pcTarget[ -1 ] ) != 0 ) )
+                {
+                    pcTarget--;
+                }
+
+                ( void ) sscanf( pcTarget, "%8X", &ulIPAddress );
+                rc = sprintf( pcTarget, "%lu.%lu.%lu.%lu",
+                              ( unsigned long ) ( ulIPAddress >> 24UL ),
+                              ( unsigned long ) ( ( ulIPAddress >> 16UL ) & 0xffUL ),
+                              ( unsigned long ) ( ( ulIPAddress >> 8UL ) & 0xffUL ),
+                              ( unsigned long ) ( ulIPAddress & 0xffUL ) );
+                pcTarget += rc;
+                pcSource += 3; /* skip "<n>ip" */
+            }
+        }
+
+        /* A truncated message still ends the line, as it did before the
+         * message was cut short. */
+        if( *pcSource != '\0' )
+        {
+            *pcTarget = '\r';
+            pcTarget++;
+            *pcTarget = '\n';
+            pcTarget++;
+        }
+
+        *pcTarget = '\0';
+
+        /* How far through the buffer was written? */
+        pxSlot->xLength = ( size_t ) ( pcTarget - pxSlot->cMessage );
+        prvReleaseSlot( pxSlot, ulPosition );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    size_t xLength;
+    int iLength;
+    va_list args;
+    const char * pcTaskName;
+    const char * pcNoTask = "None";
+
+    if( xLogRingUsed != pdFALSE )
+    {
+        /* There are a variable number of parameters. */
+        va_start( args, pcFormat );
+
+        /* Additional info to place at the start of the log. */
+        if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+        {
+            pcTaskName = pcTaskGetName( NULL );
+        }
+        else
+        {
+            pcTaskName = pcNoTask;
+        }
+
+        /* Print metadata only after line break. Metadata won't be printed in string
+         * contains line break only. */
+        if( ( xAfterLineBreak == pdTRUE ) && ( strcmp( pcFormat, "\r\n" ) != 0 ) )
+        {
+            iLength = snprintf( cPrintString, dlMAX_PRINT_STRING_LENGTH, "%lu %lu [%s] ",
+                                ( unsigned long ) __atomic_fetch_add( &xMessageNumber, 1, __ATOMIC_RELAXED ),
+                                ( unsigned long ) xTaskGetTickCount(),
+                                pcTaskName );
+            xLength = ( iLength < 0 ) ? 0 : ( ( size_t ) iLength < dlMAX_PRINT_STRING_LENGTH ) ? ( size_t ) iLength : ( dlMAX_PRINT_STRING_LENGTH - 1 );
+
+            /* Print metadata for next message if this message ends with line
+             * break. */
+            xAfterLineBreak = prvStrEndedWithLineBreak( pcFormat );
+        }
+        else
+        {
+            xLength = 0;
+
+            /* Continue to print without metadata if the string doesn't end with line
+             * break. */
+            if( prvStrEndedWithLineBreak( pcFormat ) != pdFALSE )
+            {
+                xAfterLineBreak = pdTRUE;
+            }
+        }
+
+        iLength = vsnprintf( cPrintString + xLength, dlMAX_PRINT_STRING_LENGTH - xLength, pcFormat, args );
+
+        if( iLength < 0 )
+        {
+            /* Clean up. */
+            cPrintString[ xLength ] = '\0';
+        }
+
+        va_end( args );
+
+        prvLoggingOutput( cPrintString );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintfLine( const char * pcPrefix,
+                         const char * pcFunction,
+                         int iLine,
+                         const char * pcFormat,
+                         ... )
+{
+    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    size_t xLength;
+    int iLength;
+    va_list args;
+    const char * pcTaskName;
+    const char * pcNoTask = "None";
+
+    if( xLogRingUsed != pdFALSE )
+    {
+        if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+        {
+            pcTaskName = pcTaskGetName( NULL );
+        }
+        else
+        {
+            pcTaskName = pcNoTask;
+        }
+
+        /* Leave room for the line ending, which is written even if the message
+         * is truncated. */
+        iLength = snprintf( cPrintString, dlMAX_PRINT_STRING_LENGTH - 2, "%lu %lu [%s] %s[%s:%d] ",
+                            ( unsigned long ) __atomic_fetch_add( &xMessageNumber, 1, __ATOMIC_RELAXED ),
+                            ( unsigned long ) xTaskGetTickCount(),
+                            pcTaskName,
+                            pcPrefix,
+                            pcFunction,
+                            iLine );
+        xLength = ( iLength < 0 ) ? 0 : ( ( size_t ) iLength < ( dlMAX_PRINT_STRING_LENGTH - 2 ) ) ? ( size_t ) iLength : ( dlMAX_PRINT_STRING_LENGTH - 3 );
+
+        va_start( args, pcFormat );
+        iLength = vsnprintf( cPrintString + xLength, dlMAX_PRINT_STRING_LENGTH - 2 - xLength, pcFormat, args );
+        va_end( args );
+
+        if( iLength > 0 )
+        {
+            xLength += ( ( size_t ) iLength < ( dlMAX_PRINT_STRING_LENGTH - 2 - xLength ) ) ? ( size_t ) iLength : ( dlMAX_PRINT_STRING_LENGTH - 3 - xLength );
+        }
+
+        cPrintString[ xLength ] = '\r';
+        cPrintString[ xLength + 1 ] = '\n';
+        cPrintString[ xLength + 2 ] = '\0';
+
+        /* The line is complete, so whatever follows starts a new line. */
+        xAfterLineBreak = pdTRUE;
+
+        prvLoggingOutput( cPrintString );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingWriteBatch( size_t xLength )
+{
+    ssize_t xWritten;
+    size_t xOffset = 0;
+
+    /* Write the messages to standard out if requested to do so when
+     * vLoggingInit() was called. */
+    if( xStdoutLoggingUsed != pdFALSE )
+    {
+        while( xOffset < xLength )
+        {
+            xWritten = write( STDOUT_FILENO, &( cLogBatch[ xOffset ] ), xLength - xOffset );
+
+            if( xWritten <= 0 )
+            {
+                break;
+            }
+
+            xOffset += ( size_t ) xWritten;
+        }
+    }
+
+    /* Write the messages to a file if requested to do so when
+     * vLoggingInit() was called. */
+    if( xDiskFileLoggingUsed != pdFALSE )
+    {
+        prvLogToFile( cLogBatch, xLength );
+    }
+
+    if( xUDPLoggingUsed != pdFALSE )
+    {
+        prvLogToUDP( cLogBatch, xLength );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingFlushBuffer( void )
+{
+    LogSlot_t * pxSlot;
+    size_t xBatchLength = 0;
+    uint32_t ulDropped;
+
+    ( void ) pthread_mutex_lock( &xFlushMutex );
+
+    /* Join every message waiting in the ring in the batch buffer, writing the
+     * buffer out each time it cannot take the next message. */
+    for( ; ; )
+    {
+        pxSlot = &( xLogRing[ ulRingTail & ( dlLOGGING_RING_SLOTS - 1 ) ] );
+
+        /* The acquire load means the message is not read before the sequence
+         * number that says it is complete. */
+        if( __atomic_load_n( &( pxSlot->ulSequence ), __ATOMIC_ACQUIRE ) != ( ulRingTail + 1UL ) )
+        {
+            /* The next slot is empty, or still being written. */
+            break;
+        }
+
+        if( ( xBatchLength + pxSlot->xLength ) > sizeof( cLogBatch ) )
+        {
+            prvLoggingWriteBatch( xBatchLength );
+            xBatchLength = 0;
+        }
+
+        memcpy( &( cLogBatch[ xBatchLength ] ), pxSlot->cMessage, pxSlot->xLength );
+        xBatchLength += pxSlot->xLength;
+
+        /* Free the slot for the next pass around the ring. */
+        __atomic_store_n( &( pxSlot->ulSequence ), ulRingTail + dlLOGGING_RING_SLOTS, __ATOMIC_RELEASE );
+        ulRingTail++;
+    }
+
+    /* Say how many messages were lost since the last write. */
+    ulDropped = __atomic_exchange_n( &ulDroppedMessages, 0UL, __ATOMIC_RELAXED );
+
+    if( ulDropped != 0UL )
+    {
+        if( ( xBatchLength + dlMAX_PRINT_STRING_LENGTH ) > sizeof( cLogBatch ) )
+        {
+            prvLoggingWriteBatch( xBatchLength );
+            xBatchLength = 0;
+        }
+
+        xBatchLength += ( size_t ) snprintf( &( cLogBatch[ xBatchLength ] ), dlMAX_PRINT_STRING_LENGTH,
+                                             "[%lu log messages dropped]\r\n", ( unsigned long ) ulDropped );
+    }
+
+    if( xBatchLength > 0 )
+    {
+        prvLoggingWriteBatch( xBatchLength );
+    }
+
+    prvFileClose();
+
+    ( void ) pthread_mutex_unlock( &xFlushMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void * prvPosixLoggingThread( void * pvParameter )
+{
+    const struct timespec xFlushPeriod =
+    {
+        .tv_sec  = 0,
+        .tv_nsec = dlLOGGING_FLUSH_PERIOD_MS * 1000000L
+    };
+
+    ( void ) pvParameter;
+
+    while( __atomic_load_n( &xLoggingThreadExit, __ATOMIC_RELAXED ) == pdFALSE )
+    {
+        /* Wait until it is time to empty the ring again. */
+        ( void ) nanosleep( &xFlushPeriod, NULL );
+
+        /* Write out all waiting messages. */
+        prvLoggingFlushBuffer();
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlushAtExit( void )
+{
+    prvLoggingFlushBuffer();
+}
+/*-----------------------------------------------------------*/
+
+static void prvFileLoggingInit( void )
+{
+    FILE * pxHandle = fopen( pcLogFileName, "a" );
+
+    if( pxHandle != NULL )
+    {
+        fseek( pxHandle, 0L, SEEK_END );
+        ulSizeOfLoggingFile = ( size_t ) ftell( pxHandle );
+        fclose( pxHandle );
+    }
+    else
+    {
+        ulSizeOfLoggingFile = 0ul;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvFileClose( void )
+{
+    if( pxLoggingFileHandle != NULL )
+    {
+        fclose( pxLoggingFileHandle );
+        pxLoggingFileHandle = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLogToFile( const char * pcMessage,
+                          size_t xLength )
+{
+    if( pxLoggingFileHandle == NULL )
+    {
+        pxLoggingFileHandle = fopen( pcLogFileName, "a" );
+    }
+
+    if( pxLoggingFileHandle != NULL )
+    {
+        fwrite( pcMessage, 1, xLength, pxLoggingFileHandle );
+        ulSizeOfLoggingFile += xLength;
+
+        /* If the file has grown to its maximum permissible size then close and
+         * rename it - then start with a new file. */
+        if( ulSizeOfLoggingFile > ( size_t ) dlLOGGING_FILE_SIZE )
+        {
+            prvFileClose();
+
+            if( access( pcFullLogFileName, F_OK ) == 0 )
+            {
+                remove( pcFullLogFileName );
+            }
+
+            ( void ) rename( pcLogFileName, pcFullLogFileName );
+            ulSizeOfLoggingFile = 0;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLogToUDP( const char * pcMessage,
+                         size_t xLength )
+{
+    size_t xOffset = 0, xChunk, xLineEnd;
+
+    while( xOffset < xLength )
+    {
+        xChunk = xLength - xOffset;
+
+        if( xChunk > dlLOGGING_UDP_MAX_PAYLOAD )
+        {
+            /* Break the datagram after the last complete line that fits, if
+             * there is one. */
+            xChunk = dlLOGGING_UDP_MAX_PAYLOAD;
+
+            for( xLineEnd = xChunk; xLineEnd > 0; xLineEnd-- )
+            {
+                if( pcMessage[ xOffset + xLineEnd - 1 ] == '\n' )
+                {
+                    xChunk = xLineEnd;
+                    break;
+                }
+            }
+        }
+
+        ( void ) sendto( iPrintSocket, &( pcMessage[ xOffset ] ), xChunk, 0,
+                         ( const struct sockaddr * ) &xPrintUDPAddress, sizeof( xPrintUDPAddress ) );
+        xOffset += xChunk;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vPlatformInitLogging( void )
+{
+    vLoggingInit( pdTRUE, pdFALSE, pdFALSE, 0U, 0U );
+}
+/*-----------------------------------------------------------*/
+
+void vPlatformStopLoggingThreadAndFlush( void )
+{
+    if( xLoggingThreadStarted != pdFALSE )
+    {
+        __atomic_store_n( &xLoggingThreadExit, pdTRUE, __ATOMIC_RELAXED );
+        ( void ) pthread_join( xLoggingThread, NULL );
+        xLoggingThreadStarted = pdFALSE;
+
+        prvLoggingFlushBuffer();
+    }
+}
+/*-----------------------------------------------------------*/
@@ -30,8 +30,11 @@
  *
  * Messages logged to a UDP port are sent directly (using FreeRTOS+TCP), but as
  * FreeRTOS tasks cannot make Win32 system calls messages sent to stdout or a
- * disk file are sent via a stream buffer to a Win32 thread which then performs
- * the actual output.
+ * disk file are placed in a ring of message slots, which a Win32 thread
+ * empties periodically, writing all the waiting messages at once.  Any number
+ * of tasks can claim slots without a lock, so logging never raises the
+ * priority of, or blocks, the calling task.  Messages logged while the ring is
+ * full are dropped and counted.
  */
 
 /* Standard includes. */
@@ -49,7 +52,6 @@
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
-#include "FreeRTOS_Stream_Buffer.h"
 
 /* Demo includes. */
 #include "logging.h"
@@ -63,14 +65,33 @@
 /* Dimensions the arrays into which print messages are created. */
 #define dlMAX_PRINT_STRING_LENGTH       255
 
-/* The size of the stream buffer used to pass messages from FreeRTOS tasks to
- * the Win32 thread that is responsible for making any Win32 system calls that are
- * necessary for the selected logging method. */
-#define dlLOGGING_STREAM_BUFFER_SIZE    32768
+/* The number of message slots in the ring used to pass messages from FreeRTOS
+ * tasks to the Win32 thread that is responsible for making any Win32 system
+ * calls that are necessary for the selected logging method.  Must be a power of
+ * 2. */
+#define dlLOGGING_RING_SLOTS            128
+
+/* The Win32 thread empties the ring at least this often, and also whenever a
+ * task finds the ring half full. */
+#define dlLOGGING_FLUSH_PERIOD_MS       20
+
+/* The messages taken from the ring are joined in a buffer of this size, so that
+ * stdout and the disk file are written once for many messages. */
+#define dlLOGGING_BATCH_SIZE            8192
 
 /* A block time of zero simply means don't block. */
 #define dlDONT_BLOCK                    0
 
+/* One message in the ring.  A slot at ring position n is free to be claimed
+ * when lSequence equals n, and holds a complete message when lSequence equals
+ * n + 1. */
+typedef struct LogSlot
+{
+    volatile LONG lSequence;
+    size_t xLength;
+    char cMessage[ dlMAX_PRINT_STRING_LENGTH ];
+} LogSlot_t;
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -98,6 +119,12 @@ static void prvFileClose( void );
  */
 static void prvLoggingFlushBuffer( void );
 
+/*
+ * Write the first xLength bytes of the batch buffer to stdout and the disk
+ * file, as selected when vLoggingInit() was called.
+ */
+static void prvLoggingWriteBatch( size_t xLength );
+
 /*
  * The windows thread that performs the actual writing of messages that require
  * Win32 system calls.  Only the windows thread can make system calls so as not
@@ -114,6 +141,21 @@ static DWORD WINAPI prvWin32LoggingThread( void * pvParam );
 static void prvCreatePrintSocket( void * pvParameter1,
                                   uint32_t ulParameter2 );
 
+/*
+ * Converts IP addresses in a formatted message to dot notation, then sends the
+ * message to the UDP port and passes it to the Win32 thread, as selected when
+ * vLoggingInit() was called.
+ */
+static void prvLoggingOutput( const char * pcPrintString );
+
+/*
+ * Claim the next free slot of the ring, returning NULL if the ring is full.
+ * The slot is passed to the Win32 thread by prvReleaseSlot().
+ */
+static LogSlot_t * prvClaimSlot( ULONG * pulPosition );
+static void prvReleaseSlot( LogSlot_t * pxSlot,
+                            ULONG ulPosition );
+
 /*-----------------------------------------------------------*/
 
 /* Windows event used to wake the Win32 thread which performs any logging that
@@ -124,10 +166,21 @@ static void * pvLoggingThreadEvent = NULL;
  * vLoggingInit() function. */
 BaseType_t xStdoutLoggingUsed = pdFALSE, xDiskFileLoggingUsed = pdFALSE, xUDPLoggingUsed = pdFALSE;
 
-/* Circular buffer used to pass messages from the FreeRTOS tasks to the Win32
- * thread that is responsible for making Win32 calls (when stdout or a disk log is
- * used). */
-static StreamBuffer_t * xLogStreamBuffer = NULL;
+/* Ring of message slots used to pass messages from the FreeRTOS tasks to the
+ * Win32 thread that is responsible for making Win32 calls (when stdout or a disk
+ * log is used).  lRingHead is the next position to be claimed by a task, and
+ * ulRingTail the next position to be read by the Win32 thread. */
+static LogSlot_t xLogRing[ dlLOGGING_RING_SLOTS ];
+static volatile LONG lRingHead = 0;
+static volatile ULONG ulRingTail = 0;
+static BaseType_t xLogRingUsed = pdFALSE;
+
+/* The number of messages dropped because the ring was full. */
+static volatile LONG lDroppedMessages = 0;
+
+/* Buffer in which messages read from the ring are joined before being
+ * written. */
+static char cLogBatch[ dlLOGGING_BATCH_SIZE ];
 
 /* Handle to the file used for logging.  This is left open while there are
  * messages waiting to be logged, then closed again in between logs. */
@@ -155,6 +208,11 @@ HANDLE pvLoggingThread = NULL;
 /* Windows event used to stop the logging thread and flush the logging buffer. */
 static void * pvLoggingThreadExitEvent = NULL;
 
+/* Sequence number printed at the start of each line, and whether the next
+ * vLoggingPrintf() call starts a new line. */
+static BaseType_t xMessageNumber = 0;
+static BaseType_t xAfterLineBreak = pdTRUE;
+
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvStrEndedWithLineBreak( const char * pcStr )
@@ -229,16 +287,22 @@ void vLoggingInit( BaseType_t xLogToStdout,
 
         /* If a disk file or stdout are to be used then Win32 system calls will
          * have to be made.  Such system calls cannot be made from FreeRTOS tasks
-         * so create a stream buffer to pass the messages to a Win32 thread, then
+         * so prepare the ring to pass the messages to a Win32 thread, then
          * create the thread itself, along with a Win32 event that can be used to
          * unblock the thread. */
         if( ( xStdoutLoggingUsed != pdFALSE ) || ( xDiskFileLoggingUsed != pdFALSE ) )
         {
-            /* Create the buffer. */
-            xLogStreamBuffer = ( StreamBuffer_t * ) malloc( sizeof( *xLogStreamBuffer ) - sizeof( xLogStreamBuffer->ucArray ) + dlLOGGING_STREAM_BUFFER_SIZE + 1 );
-            configASSERT( xLogStreamBuffer );
-            memset( xLogStreamBuffer, '\0', sizeof( *xLogStreamBuffer ) - sizeof( xLogStreamBuffer->ucArray ) );
-            xLogStreamBuffer->LENGTH = dlLOGGING_STREAM_BUFFER_SIZE + 1;
+            UBaseType_t uxSlot;
+
+            /* Each slot is free for the first pass around the ring. */
+            for( uxSlot = 0; uxSlot < dlLOGGING_RING_SLOTS; uxSlot++ )
+            {
+                xLogRing[ uxSlot ].lSequence = ( LONG ) uxSlot;
+            }
+
+            lRingHead = 0;
+            ulRingTail = 0;
+            xLogRingUsed = pdTRUE;
 
             /* Create the Windows event. */
             pvLoggingThreadEvent = CreateEvent( NULL, FALSE, TRUE, L"StdoutLoggingEvent" );
@@ -303,22 +367,210 @@ static void prvCreatePrintSocket( void * pvParameter1,
 }
 /*-----------------------------------------------------------*/
 
+static LogSlot_t * prvClaimSlot( ULONG * pulPosition )
+{
+    LogSlot_t * pxSlot;
+    ULONG ulPosition = ( ULONG ) lRingHead;
+    LONG lDifference;
+
+    for( ; ; )
+    {
+        pxSlot = &( xLogRing[ ulPosition & ( dlLOGGING_RING_SLOTS - 1 ) ] );
+        lDifference = ( LONG ) ( ( ULONG ) pxSlot->lSequence - ulPosition );
+
+        if( lDifference == 0 )
+        {
+            /* The slot is free - try to move the head past it.  If another task
+             * moved the head first then try again from where it now is. */
+            if( ( ULONG ) InterlockedCompareExchange( &lRingHead, ( LONG ) ( ulPosition + 1UL ), ( LONG ) ulPosition ) == ulPosition )
+            {
+                break;
+            }
+
+            ulPosition = ( ULONG ) lRingHead;
+        }
+        else if( lDifference < 0 )
+        {
+            /* The slot still holds the message written one pass ago, so the
+             * ring is full. */
+            pxSlot = NULL;
+            break;
+        }
+        else
+        {
+            /* Another task has claimed this slot already. */
+            ulPosition = ( ULONG ) lRingHead;
+        }
+    }
+
+    *pulPosition = ulPosition;
+
+    return pxSlot;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseSlot( LogSlot_t * pxSlot,
+                            ULONG ulPosition )
+{
+    /* InterlockedExchange() is a full barrier, so the message is visible to
+     * the Win32 thread before the sequence number that says it is there. */
+    ( void ) InterlockedExchange( &( pxSlot->lSequence ), ( LONG ) ( ulPosition + 1UL ) );
+
+    /* With the ring half full do not wait for the Win32 thread to wake up
+     * by itself. */
+    if( ( ( ULONG ) lRingHead - ulRingTail ) >= ( dlLOGGING_RING_SLOTS / 2 ) )
+    {
+        if( ( xDirectPrint == pdFALSE ) && ( pvLoggingThreadEvent != NULL ) )
+        {
+            SetEvent( pvLoggingThreadEvent );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingOutput( const char * pcPrintString )
+{
+    char cOutputString[ dlMAX_PRINT_STRING_LENGTH ];
+    const char * pcSource;
+    char * pcOutput, * pcTarget, * pcBegin, * pcLimit;
+    size_t xLength, rc;
+    uint32_t ulIPAddress;
+    LogSlot_t * pxSlot = NULL;
+    ULONG ulPosition = 0;
+
+    /* When the ring is used the message is written straight into a slot of it.
+     * Otherwise, or if the ring is full, it is only sent to the UDP port. */
+    if( xLogRingUsed != pdFALSE )
+    {
+        pxSlot = prvClaimSlot( &ulPosition );
+
+        if( pxSlot == NULL )
+        {
+            ( void ) InterlockedIncrement( &lDroppedMessages );
+        }
+    }
+
+    if( pxSlot != NULL )
+    {
+        pcOutput = pxSlot->cMessage;
+    }
+    else
+    {
+        pcOutput = cOutputString;
+    }
+
+    /* For ease of viewing, copy the string into the output buffer, converting
+     * IP addresses to dot notation on the way.  Stop with room left for one
+     * address in dot notation, the line ending and the terminator. */
+    pcSource = pcPrintString;
+    pcTarget = pcOutput;
+    pcLimit = pcOutput + dlMAX_PRINT_STRING_LENGTH - 17 - 2;
+
+    while( ( ( *pcSource ) != '\0' ) && ( pcTarget < pcLimit ) )
+    {
+        *pcTarget = *pcSource;
+        pcTarget++;
+        pcSource++;
+
+        /* Look forward for an IP address denoted by 'ip'. */
+        if( ( isxdigit( pcSource[ 0 ] ) != pdFALSE ) && ( pcSource[ 1 ] == 'i' ) && ( pcSource[ 2 ] == 'p' ) )
+        {
+            *pcTarget = *pcSource;
+            pcTarget++;
+            *pcTarget = '\0';
+            pcBegin = pcTarget - 8;
+
+            if( pcBegin < pcOutput )
+            {
+                pcBegin = pcOutput;
+            }
+
+            while( ( pcTarget > pcBegin ) && ( isxdigit( pcTarget[ -1 ] ) != pdFALSE ) )
+            {
+                pcTarget--;
+            }
+
+            ( void ) sscanf( pcTarget, "%8X", &ulIPAddress );
+            rc = sprintf( pcTarget, "%lu.%lu.%lu.%lu",
+                          ( unsigned long ) ( ulIPAddress >> 24UL ),
+                          ( unsigned long ) ( ( ulIPAddress >> 16UL ) & 0xffUL ),
+                          ( unsigned long ) ( ( ulIPAddress >> 8UL ) & 0xffUL ),
+                          ( unsigned long ) ( ulIPAddress & 0xffUL ) );
+            pcTarget += rc;
+            pcSource += 3; /* skip "<n>ip" */
+        }
+    }
+
+    /* A truncated message still ends the line, as it did before the message
+     * was cut short. */
+    if( *pcSource != '\0' )
+    {
+        *pcTarget = '\r';
+        pcTarget++;
+        *pcTarget = '\n';
+        pcTarget++;
+    }
+
+    *pcTarget = '\0';
+
+    /* How far through the buffer was written? */
+    xLength = ( size_t ) ( pcTarget - pcOutput );
+
+    /* If the message is to be logged to a UDP port then it can be sent directly
+     * because it only uses FreeRTOS function (not Win32 functions). */
+    if( xUDPLoggingUsed != pdFALSE )
+    {
+        if( ( xPrintSocket == FREERTOS_INVALID_SOCKET ) && ( FreeRTOS_IsNetworkUp() != pdFALSE ) )
+        {
+            /* Create and bind the socket to which print messages are sent.  The
+             * xTimerPendFunctionCall() function is used even though this is
+             * not an interrupt because this function is called from the IP task
+             * and the	IP task cannot itself wait for a socket to bind.  The
+             * parameters to prvCreatePrintSocket() are not required so set to
+             * NULL or 0. */
+            xTimerPendFunctionCall( prvCreatePrintSocket, NULL, 0, dlDONT_BLOCK );
+        }
+
+        if( xPrintSocket != FREERTOS_INVALID_SOCKET )
+        {
+            FreeRTOS_sendto( xPrintSocket, pcOutput, xLength, 0, &xPrintUDPAddress, sizeof( xPrintUDPAddress ) );
+
+            /* Just because the UDP data logger I'm using is dumb. */
+            FreeRTOS_sendto( xPrintSocket, "\r", sizeof( char ), 0, &xPrintUDPAddress, sizeof( xPrintUDPAddress ) );
+        }
+    }
+
+    /* If logging is also to go to either stdout or a disk file then it cannot
+     * be output here - so instead pass the slot to the Win32 thread which will
+     * perform the actual output. */
+    if( pxSlot != NULL )
+    {
+        pxSlot->xLength = xLength;
+        prvReleaseSlot( pxSlot, ulPosition );
+
+        /* xDirectPrint is initialized to pdTRUE, and while it remains true the
+         * logging output function is called directly.  When the system is running
+         * the output function cannot be called directly because it would get
+         * called from both FreeRTOS tasks and Win32 threads - so instead the
+         * Win32 thread responsible for the actual output empties the ring. */
+        if( xDirectPrint != pdFALSE )
+        {
+            /* While starting up, the thread which calls prvWin32LoggingThread()
+             * is not running yet and xDirectPrint will be pdTRUE. */
+            prvLoggingFlushBuffer();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
 void vLoggingPrintf( const char * pcFormat,
                      ... )
 {
     char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
-    char cOutputString[ dlMAX_PRINT_STRING_LENGTH ];
-    char * pcSource, * pcTarget, * pcBegin;
-    size_t xLength, xLength2, rc;
-    static BaseType_t xMessageNumber = 0;
-    static BaseType_t xAfterLineBreak = pdTRUE;
+    size_t xLength, xLength2;
     va_list args;
-    uint32_t ulIPAddress;
     const char * pcTaskName;
     const char * pcNoTask = "None";
-    int iOriginalPriority;
-    HANDLE xCurrentTask;
-
 
     if( ( xStdoutLoggingUsed != pdFALSE ) || ( xDiskFileLoggingUsed != pdFALSE ) || ( xUDPLoggingUsed != pdFALSE ) )
     {
@@ -373,145 +625,140 @@ void vLoggingPrintf( const char * pcFormat,
         xLength += xLength2;
         va_end( args );
 
-        /* For ease of viewing, copy the string into another buffer, converting
-         * IP addresses to dot notation on the way. */
-        pcSource = cPrintString;
-        pcTarget = cOutputString;
+        prvLoggingOutput( cPrintString );
+    }
+}
+/*-----------------------------------------------------------*/
 
-        while( ( *pcSource ) != '\0' )
-        {
-            *pcTarget = *pcSource;
-            pcTarget++;
-            pcSource++;
+void vLoggingPrintfLine( const char * pcPrefix,
+                         const char * pcFunction,
+                         int iLine,
+                         const char * pcFormat,
+                         ... )
+{
+    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    size_t xLength;
+    int iLength;
+    va_list args;
+    const char * pcTaskName;
+    const char * pcNoTask = "None";
 
-            /* Look forward for an IP address denoted by 'ip'. */
-            if( ( isxdigit( pcSource[ 0 ] ) != pdFALSE ) && ( pcSource[ 1 ] == 'i' ) && ( pcSource[ 2 ] == 'p' ) )
-            {
-                *pcTarget = *pcSource;
-                pcTarget++;
-                *pcTarget = '\0';
-                pcBegin = pcTarget - 8;
-
-                while( ( pcTarget > pcBegin ) && ( isxdigit( pcTarget[ -1 ] ) != pdFALSE ) )
-                {
-                    pcTarget--;
-                }
-
-                ( void ) sscanf( pcTarget, "%8X", &ulIPAddress );
-                rc = sprintf( pcTarget, "%lu.%lu.%lu.%lu",
-                              ( unsigned long ) ( ulIPAddress >> 24UL ),
-                              ( unsigned long ) ( ( ulIPAddress >> 16UL ) & 0xffUL ),
-                              ( unsigned long ) ( ( ulIPAddress >> 8UL ) & 0xffUL ),
-                              ( unsigned long ) ( ulIPAddress & 0xffUL ) );
-                pcTarget += rc;
-                pcSource += 3; /* skip "<n>ip" */
-            }
+    if( ( xStdoutLoggingUsed != pdFALSE ) || ( xDiskFileLoggingUsed != pdFALSE ) || ( xUDPLoggingUsed != pdFALSE ) )
+    {
+        if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+        {
+            pcTaskName = pcTaskGetName( NULL );
         }
-
-        /* How far through the buffer was written? */
-        xLength = ( BaseType_t ) ( pcTarget - cOutputString );
-
-        /* If the message is to be logged to a UDP port then it can be sent directly
-         * because it only uses FreeRTOS function (not Win32 functions). */
-        if( xUDPLoggingUsed != pdFALSE )
+        else
         {
-            if( ( xPrintSocket == FREERTOS_INVALID_SOCKET ) && ( FreeRTOS_IsNetworkUp() != pdFALSE ) )
-            {
-                /* Create and bind the socket to which print messages are sent.  The
-                 * xTimerPendFunctionCall() function is used even though this is
-                 * not an interrupt because this function is called from the IP task
-                 * and the	IP task cannot itself wait for a socket to bind.  The
-                 * parameters to prvCreatePrintSocket() are not required so set to
-                 * NULL or 0. */
-                xTimerPendFunctionCall( prvCreatePrintSocket, NULL, 0, dlDONT_BLOCK );
-            }
+            pcTaskName = pcNoTask;
+        }
 
-            if( xPrintSocket != FREERTOS_INVALID_SOCKET )
-            {
-                FreeRTOS_sendto( xPrintSocket, cOutputString, xLength, 0, &xPrintUDPAddress, sizeof( xPrintUDPAddress ) );
+        /* Leave room for the line ending, which is written even if the message
+         * is truncated. */
+        iLength = snprintf( cPrintString, dlMAX_PRINT_STRING_LENGTH - 2, "%lu %lu [%s] %s[%s:%d] ",
+                            xMessageNumber++,
+                            ( unsigned long ) xTaskGetTickCount(),
+                            pcTaskName,
+                            pcPrefix,
+                            pcFunction,
+                            iLine );
+        xLength = ( iLength < 0 ) ? 0 : ( ( size_t ) iLength < ( dlMAX_PRINT_STRING_LENGTH - 2 ) ) ? ( size_t ) iLength : ( dlMAX_PRINT_STRING_LENGTH - 3 );
 
-                /* Just because the UDP data logger I'm using is dumb. */
-                FreeRTOS_sendto( xPrintSocket, "\r", sizeof( char ), 0, &xPrintUDPAddress, sizeof( xPrintUDPAddress ) );
-            }
-        }
+        va_start( args, pcFormat );
+        iLength = vsnprintf( cPrintString + xLength, dlMAX_PRINT_STRING_LENGTH - 2 - xLength, pcFormat, args );
+        va_end( args );
 
-        /* If logging is also to go to either stdout or a disk file then it cannot
-         * be output here - so instead write the message to the stream buffer and wake
-         * the Win32 thread which will read it from the stream buffer and perform the
-         * actual output. */
-        if( ( xStdoutLoggingUsed != pdFALSE ) || ( xDiskFileLoggingUsed != pdFALSE ) )
+        if( iLength > 0 )
         {
-            configASSERT( xLogStreamBuffer );
+            xLength += ( ( size_t ) iLength < ( dlMAX_PRINT_STRING_LENGTH - 2 - xLength ) ) ? ( size_t ) iLength : ( dlMAX_PRINT_STRING_LENGTH - 3 - xLength );
+        }
 
-            /* How much space is in the buffer? */
-            xLength2 = uxStreamBufferGetSpace( xLogStreamBuffer );
+        cPrintString[ xLength ] = '\r';
+        cPrintString[ xLength + 1 ] = '\n';
+        cPrintString[ xLength + 2 ] = '\0';
 
-            /* There must be enough space to write both the string and the length of
-             * the string. */
-            if( xLength2 >= ( xLength + sizeof( xLength ) ) )
-            {
-                /* First write in the length of the data, then write in the data
-                 * itself.  Raising the thread priority is used as a critical section
-                 * as there are potentially multiple writers.  The stream buffer is
-                 * only thread safe when there is a single writer (likewise for
-                 * reading from the buffer). */
-                xCurrentTask = GetCurrentThread();
-                iOriginalPriority = GetThreadPriority( xCurrentTask );
-                SetThreadPriority( GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL );
-                uxStreamBufferAdd( xLogStreamBuffer, 0, ( const uint8_t * ) &( xLength ), sizeof( xLength ) );
-                uxStreamBufferAdd( xLogStreamBuffer, 0, ( const uint8_t * ) cOutputString, xLength );
-                SetThreadPriority( GetCurrentThread(), iOriginalPriority );
-            }
+        /* The line is complete, so whatever follows starts a new line. */
+        xAfterLineBreak = pdTRUE;
 
-            /* xDirectPrint is initialized to pdTRUE, and while it remains true the
-             * logging output function is called directly.  When the system is running
-             * the output function cannot be called directly because it would get
-             * called from both FreeRTOS tasks and Win32 threads - so instead wake the
-             * Win32 thread responsible for the actual output. */
-            if( xDirectPrint != pdFALSE )
-            {
-                /* While starting up, the thread which calls prvWin32LoggingThread()
-                 * is not running yet and xDirectPrint will be pdTRUE. */
-                prvLoggingFlushBuffer();
-            }
-            else if( pvLoggingThreadEvent != NULL )
-            {
-                /* While running, wake up prvWin32LoggingThread() to send the
-                 * logging data. */
-                SetEvent( pvLoggingThreadEvent );
-            }
-        }
+        prvLoggingOutput( cPrintString );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingWriteBatch( size_t xLength )
+{
+    /* Write the messages to standard out if requested to do so when
+     * vLoggingInit() was called, or if the network is not yet up. */
+    if( ( xStdoutLoggingUsed != pdFALSE ) || ( FreeRTOS_IsNetworkUp() == pdFALSE ) )
+    {
+        /* Write the messages to stdout. */
+        _write( _fileno( stdout ), cLogBatch, ( unsigned int ) xLength );
+    }
+
+    /* Write the messages to a file if requested to do so when
+     * vLoggingInit() was called. */
+    if( xDiskFileLoggingUsed != pdFALSE )
+    {
+        prvLogToFile( cLogBatch, xLength );
     }
 }
 /*-----------------------------------------------------------*/
 
 static void prvLoggingFlushBuffer( void )
 {
-    size_t xLength;
-    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    LogSlot_t * pxSlot;
+    size_t xBatchLength = 0;
+    LONG lDropped;
 
-    /* Is there more than the length value stored in the circular buffer
-     * used to pass data from the FreeRTOS simulator into this Win32 thread? */
-    while( uxStreamBufferGetSize( xLogStreamBuffer ) > sizeof( xLength ) )
+    /* Join every message waiting in the ring in the batch buffer, writing the
+     * buffer out each time it cannot take the next message. */
+    for( ; ; )
     {
-        memset( cPrintString, 0x00, dlMAX_PRINT_STRING_LENGTH );
-        uxStreamBufferGet( xLogStreamBuffer, 0, ( uint8_t * ) &xLength, sizeof( xLength ), pdFALSE );
-        uxStreamBufferGet( xLogStreamBuffer, 0, ( uint8_t * ) cPrintString, xLength, pdFALSE );
+        pxSlot = &( xLogRing[ ulRingTail & ( dlLOGGING_RING_SLOTS - 1 ) ] );
 
-        /* Write the message to standard out if requested to do so when
-         * vLoggingInit() was called, or if the network is not yet up. */
-        if( ( xStdoutLoggingUsed != pdFALSE ) || ( FreeRTOS_IsNetworkUp() == pdFALSE ) )
+        if( ( ULONG ) pxSlot->lSequence != ( ulRingTail + 1UL ) )
         {
-            /* Write the message to stdout. */
-            _write( _fileno( stdout ), cPrintString, strlen( cPrintString ) );
+            /* The next slot is empty, or still being written. */
+            break;
         }
 
-        /* Write the message to a file if requested to do so when
-         * vLoggingInit() was called. */
-        if( xDiskFileLoggingUsed != pdFALSE )
+        /* Do not read the message before the sequence number that says it is
+         * complete. */
+        MemoryBarrier();
+
+        if( ( xBatchLength + pxSlot->xLength ) > sizeof( cLogBatch ) )
+        {
+            prvLoggingWriteBatch( xBatchLength );
+            xBatchLength = 0;
+        }
+
+        memcpy( &( cLogBatch[ xBatchLength ] ), pxSlot->cMessage, pxSlot->xLength );
+        xBatchLength += pxSlot->xLength;
+
+        /* Free the slot for the next pass around the ring. */
+        ( void ) InterlockedExchange( &( pxSlot->lSequence ), ( LONG ) ( ulRingTail + dlLOGGING_RING_SLOTS ) );
+        ulRingTail++;
+    }
+
+    /* Say how many messages were lost since the last write. */
+    lDropped = InterlockedExchange( &lDroppedMessages, 0 );
+
+    if( lDropped != 0 )
+    {
+        if( ( xBatchLength + dlMAX_PRINT_STRING_LENGTH ) > sizeof( cLogBatch ) )
         {
-            prvLogToFile( cPrintString, xLength );
+            prvLoggingWriteBatch( xBatchLength );
+            xBatchLength = 0;
         }
+
+        xBatchLength += ( size_t ) snprintf( &( cLogBatch[ xBatchLength ] ), dlMAX_PRINT_STRING_LENGTH,
+                                             "[%lu log messages dropped]\r\n", ( unsigned long ) lDropped );
+    }
+
+    if( xBatchLength > 0 )
+    {
+        prvLoggingWriteBatch( xBatchLength );
     }
 
     prvFileClose();
@@ -520,8 +767,6 @@ static void prvLoggingFlushBuffer( void )
 
 static DWORD WINAPI prvWin32LoggingThread( void * pvParameter )
 {
-    const DWORD xMaxWait = 1000;
-
     ( void ) pvParameter;
 
     /* From now on, prvLoggingFlushBuffer() will only be called from this
@@ -530,8 +775,9 @@ static DWORD WINAPI prvWin32LoggingThread( void * pvParameter )
 
     for( ; ; )
     {
-        /* Wait to be told there are message waiting to be logged. */
-        WaitForSingleObject( pvLoggingThreadEvent, xMaxWait );
+        /* Wait until it is time to empty the ring again, or until a task finds
+         * it half full. */
+        WaitForSingleObject( pvLoggingThreadEvent, dlLOGGING_FLUSH_PERIOD_MS );
 
         /* Write out all waiting messages. */
         prvLoggingFlushBuffer();
@@ -617,7 +863,7 @@ void vPlatformInitLogging( void )
 void vPlatformStopLoggingThreadAndFlush( void )
 {
     #if ( ( ipconfigHAS_DEBUG_PRINTF == 1 ) || ( ipconfigHAS_PRINTF == 1 ) )
-        if( xLogStreamBuffer != NULL )
+        if( xLogRingUsed != pdFALSE )
         {
             SetEvent( pvLoggingThreadExitEvent );
 
@@ -35,12 +35,153 @@
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
 /* Header include. */
 #include "freertos_agent_message.h"
 #include "core_mqtt_agent_message_interface.h"
 
+/* MQTT agent include, for the command types. */
+#include "core_mqtt_agent.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send a command to its lane of a context.
+ *
+ * @param[in] pMsgCtx The context.
+ * @param[in] pCommandToSend Pointer to the command to send.
+ * @param[in] blockTicks Block time to wait for room in the lane.
+ *
+ * @return pdPASS if the command was sent, else pdFAIL.
+ */
+static BaseType_t prvSendToLane( const MQTTAgentMessageContext_t * pMsgCtx,
+                                 MQTTAgentCommand_t * const * pCommandToSend,
+                                 TickType_t blockTicks );
+
+/**
+ * @brief Receive a command from a context, from the priority lane first
+ * within the limit of the burst of the lanes.
+ *
+ * @param[in] pMsgCtx The context.
+ * @param[out] pReceivedCommand Pointer to write the received command to.
+ * @param[in] blockTicks Block time to wait for a command.
+ *
+ * @return pdPASS if a command was received, else pdFAIL.
+ */
+static BaseType_t prvReceiveFromLanes( const MQTTAgentMessageContext_t * pMsgCtx,
+                                       MQTTAgentCommand_t ** pReceivedCommand,
+                                       TickType_t blockTicks );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendToLane( const MQTTAgentMessageContext_t * pMsgCtx,
+                                 MQTTAgentCommand_t * const * pCommandToSend,
+                                 TickType_t blockTicks )
+{
+    BaseType_t queueStatus;
+    MQTTAgentMessageLanes_t * pLanes = pMsgCtx->pLanes;
+    MQTTAgentMessageClassifier_t classify;
+    QueueHandle_t queue = pMsgCtx->queue;
+
+    if( pLanes != NULL )
+    {
+        classify = ( pLanes->classify != NULL ) ? pLanes->classify : Agent_MessageIsPriorityCommand;
+
+        if( classify( *pCommandToSend ) == true )
+        {
+            queue = pLanes->priorityQueue;
+        }
+    }
+
+    queueStatus = xQueueSendToBack( queue, pCommandToSend, blockTicks );
+
+    if( ( queueStatus == pdPASS ) && ( pLanes != NULL ) )
+    {
+        /* Given after the command is queued, so whenever the receiver takes
+         * pending there is a command in one of the lanes. */
+        ( void ) xSemaphoreGive( pLanes->pending );
+    }
+
+    return queueStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReceiveFromLanes( const MQTTAgentMessageContext_t * pMsgCtx,
+                                       MQTTAgentCommand_t ** pReceivedCommand,
+                                       TickType_t blockTicks )
+{
+    BaseType_t queueStatus = pdFAIL;
+    MQTTAgentMessageLanes_t * pLanes = pMsgCtx->pLanes;
+
+    if( pLanes == NULL )
+    {
+        queueStatus = xQueueReceive( pMsgCtx->queue, pReceivedCommand, blockTicks );
+    }
+    else if( xSemaphoreTake( pLanes->pending, blockTicks ) == pdPASS )
+    {
+        /* Let one bulk command through after a full burst of priority ones. */
+        if( ( pLanes->burst > 0U ) && ( pLanes->consecutive >= pLanes->burst ) )
+        {
+            queueStatus = xQueueReceive( pMsgCtx->queue, pReceivedCommand, 0U );
+        }
+
+        if( queueStatus == pdPASS )
+        {
+            pLanes->consecutive = 0U;
+        }
+        else if( xQueueReceive( pLanes->priorityQueue, pReceivedCommand, 0U ) == pdPASS )
+        {
+            if( pLanes->consecutive < pLanes->burst )
+            {
+                pLanes->consecutive++;
+            }
+
+            queueStatus = pdPASS;
+        }
+        else
+        {
+            /* The semaphore was taken, so the command is in the bulk lane. */
+            queueStatus = xQueueReceive( pMsgCtx->queue, pReceivedCommand, 0U );
+            pLanes->consecutive = 0U;
+        }
+    }
+    else
+    {
+        /* No command arrived in time. */
+    }
+
+    return queueStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+bool Agent_MessageIsPriorityCommand( const MQTTAgentCommand_t * pCommand )
+{
+    return ( ( pCommand != NULL ) && ( pCommand->commandType != PUBLISH ) ) ? true : false;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t Agent_MessagesWaiting( const MQTTAgentMessageContext_t * pMsgCtx )
+{
+    size_t waiting = 0U;
+
+    if( pMsgCtx != NULL )
+    {
+        waiting = ( size_t ) uxQueueMessagesWaiting( pMsgCtx->queue );
+
+        if( pMsgCtx->pLanes != NULL )
+        {
+            waiting += ( size_t ) uxQueueMessagesWaiting( pMsgCtx->pLanes->priorityQueue );
+        }
+    }
+
+    return waiting;
+}
+
 /*-----------------------------------------------------------*/
 
 bool Agent_MessageSend( const MQTTAgentMessageContext_t * pMsgCtx,
@@ -51,7 +192,7 @@ bool Agent_MessageSend( const MQTTAgentMessageContext_t * pMsgCtx,
 
     if( ( pMsgCtx != NULL ) && ( pCommandToSend != NULL ) )
     {
-        queueStatus = xQueueSendToBack( pMsgCtx->queue, pCommandToSend, pdMS_TO_TICKS( blockTimeMs ) );
+        queueStatus = prvSendToLane( pMsgCtx, pCommandToSend, pdMS_TO_TICKS( blockTimeMs ) );
     }
 
     return ( queueStatus == pdPASS ) ? true : false;
@@ -64,11 +205,94 @@ bool Agent_MessageReceive( const MQTTAgentMessageContext_t * pMsgCtx,
                            uint32_t blockTimeMs )
 {
     BaseType_t queueStatus = pdFAIL;
+    MQTTAgentMessageBatch_t * pBatch;
 
     if( ( pMsgCtx != NULL ) && ( pReceivedCommand != NULL ) )
     {
-        queueStatus = xQueueReceive( pMsgCtx->queue, pReceivedCommand, pdMS_TO_TICKS( blockTimeMs ) );
+        pBatch = pMsgCtx->pBatch;
+
+        if( ( pBatch == NULL ) || ( pBatch->pCommands == NULL ) || ( pBatch->length == 0U ) )
+        {
+            queueStatus = prvReceiveFromLanes( pMsgCtx, pReceivedCommand, pdMS_TO_TICKS( blockTimeMs ) );
+        }
+        else
+        {
+            if( pBatch->next >= pBatch->count )
+            {
+                /* The batch is empty, drain the queue into it. */
+                pBatch->count = Agent_MessageReceiveMany( pMsgCtx, pBatch->pCommands, pBatch->length, blockTimeMs );
+                pBatch->next = 0U;
+            }
+
+            if( pBatch->next < pBatch->count )
+            {
+                *pReceivedCommand = pBatch->pCommands[ pBatch->next ];
+                pBatch->next++;
+                queueStatus = pdPASS;
+            }
+        }
     }
 
     return ( queueStatus == pdPASS ) ? true : false;
 }
+
+/*-----------------------------------------------------------*/
+
+size_t Agent_MessageSendMany( const MQTTAgentMessageContext_t * pMsgCtx,
+                              MQTTAgentCommand_t * const * pCommandsToSend,
+                              size_t commandCount,
+                              uint32_t blockTimeMs )
+{
+    size_t sent = 0U;
+
+    if( ( pMsgCtx != NULL ) && ( pCommandsToSend != NULL ) )
+    {
+        /* Queue as many as fit without blocking, so that the receiving task
+         * is only unblocked once xTaskResumeAll() is called. */
+        vTaskSuspendAll();
+        {
+            while( ( sent < commandCount ) &&
+                   ( prvSendToLane( pMsgCtx, &( pCommandsToSend[ sent ] ), 0U ) == pdPASS ) )
+            {
+                sent++;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        /* A lane is full, wait for room for the remaining commands. */
+        while( ( sent < commandCount ) &&
+               ( prvSendToLane( pMsgCtx, &( pCommandsToSend[ sent ] ), pdMS_TO_TICKS( blockTimeMs ) ) == pdPASS ) )
+        {
+            sent++;
+        }
+    }
+
+    return sent;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t Agent_MessageReceiveMany( const MQTTAgentMessageContext_t * pMsgCtx,
+                                 MQTTAgentCommand_t ** pReceivedCommands,
+                                 size_t maxCommands,
+                                 uint32_t blockTimeMs )
+{
+    size_t received = 0U;
+
+    if( ( pMsgCtx != NULL ) && ( pReceivedCommands != NULL ) && ( maxCommands > 0U ) )
+    {
+        /* Only wait for the first command, then take what is pending. */
+        if( prvReceiveFromLanes( pMsgCtx, &( pReceivedCommands[ 0 ] ), pdMS_TO_TICKS( blockTimeMs ) ) == pdPASS )
+        {
+            received++;
+
+            while( ( received < maxCommands ) &&
+                   ( prvReceiveFromLanes( pMsgCtx, &( pReceivedCommands[ received ] ), 0U ) == pdPASS ) )
+            {
+                received++;
+            }
+        }
+    }
+
+    return received;
+}
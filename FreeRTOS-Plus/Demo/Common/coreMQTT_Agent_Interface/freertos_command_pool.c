@@ -36,6 +36,7 @@
 /* Kernel includes. */
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "atomic.h"
 
 /* Header include. */
 #include "freertos_command_pool.h"
@@ -44,6 +45,20 @@
 /* Demo config include. */
 #include "demo_config.h"
 
+/**
+ * @brief Set to 1 to keep the free commands in a bit mask that is updated with
+ * the atomic operations of atomic.h, instead of in a queue.
+ *
+ * Getting or releasing a command then costs a few atomic operations, and no
+ * queue operation, as long as no task is waiting for a command.  When the pool
+ * is empty, a task that is willing to wait blocks on a counting semaphore,
+ * which a release only gives when a task is waiting.  The queue (the default)
+ * remains the most portable implementation.
+ */
+#ifndef MQTT_COMMAND_POOL_LOCK_FREE
+    #define MQTT_COMMAND_POOL_LOCK_FREE    0
+#endif
+
 /*-----------------------------------------------------------*/
 
 #define QUEUE_NOT_INITIALIZED    ( 0U )
@@ -56,13 +71,44 @@
  */
 static MQTTAgentCommand_t commandStructurePool[ MQTT_COMMAND_CONTEXTS_POOL_SIZE ];
 
+#if ( MQTT_COMMAND_POOL_LOCK_FREE == 0 )
+
 /**
  * @brief The message context used to guard the pool of MQTTAgentCommand_t structures.
  * For FreeRTOS, this is implemented with a queue. Structures may be
  * obtained by receiving a pointer from the queue, and returned by
  * sending the pointer back into it.
  */
-static MQTTAgentMessageContext_t commandStructMessageCtx;
+    static MQTTAgentMessageContext_t commandStructMessageCtx;
+#else
+
+/**
+ * @brief The number of 32-bit words in the free mask.
+ */
+    #define FREE_MASK_WORDS    ( ( MQTT_COMMAND_CONTEXTS_POOL_SIZE + 31U ) / 32U )
+
+/**
+ * @brief One bit per structure in the pool, set when the structure is free.
+ */
+    static volatile uint32_t freeMask[ FREE_MASK_WORDS ];
+
+/**
+ * @brief The number of tasks in Agent_GetCommand() that wait for a structure.
+ */
+    static volatile uint32_t waitingTasks = 0U;
+
+/**
+ * @brief Given by Agent_ReleaseCommand() to wake up a waiting task.
+ */
+    static SemaphoreHandle_t commandReleasedSemaphore;
+#endif /* MQTT_COMMAND_POOL_LOCK_FREE */
+
+/**
+ * @brief The counters returned by Agent_GetPoolStats().
+ */
+static volatile uint32_t commandsInUse = 0U;
+static volatile uint32_t commandsHighWatermark = 0U;
+static volatile uint32_t poolExhaustedCount = 0U;
 
 /**
  * @brief Initialization status of the queue.
@@ -71,30 +117,114 @@ static volatile uint8_t initStatus = QUEUE_NOT_INITIALIZED;
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Update the counters after a structure was taken from the pool.
+ */
+static void prvCommandTaken( void )
+{
+    uint32_t inUse = Atomic_Increment_u32( &commandsInUse ) + 1U;
+    uint32_t highWatermark;
+
+    do
+    {
+        highWatermark = commandsHighWatermark;
+
+        if( inUse <= highWatermark )
+        {
+            break;
+        }
+    } while( Atomic_CompareAndSwap_u32( &commandsHighWatermark, inUse, highWatermark ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( MQTT_COMMAND_POOL_LOCK_FREE != 0 )
+
+/**
+ * @brief Clear the lowest bit that is set in the free mask, and return the
+ * structure that it stands for.
+ *
+ * @return The structure, or NULL when the pool is empty.
+ */
+    static MQTTAgentCommand_t * prvTakeFromFreeMask( void )
+    {
+        MQTTAgentCommand_t * structToUse = NULL;
+        uint32_t mask, lowestBit, index;
+        size_t word;
+
+        for( word = 0; ( word < FREE_MASK_WORDS ) && ( structToUse == NULL ); word++ )
+        {
+            do
+            {
+                mask = freeMask[ word ];
+                lowestBit = mask & ( ~mask + 1U );
+            } while( ( mask != 0U ) &&
+                     ( Atomic_CompareAndSwap_u32( &freeMask[ word ], mask & ~lowestBit, mask ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS ) );
+
+            if( mask != 0U )
+            {
+                for( index = 0U; ( lowestBit & 1U ) == 0U; index++ )
+                {
+                    lowestBit >>= 1;
+                }
+
+                structToUse = &commandStructurePool[ ( word * 32U ) + index ];
+            }
+        }
+
+        return structToUse;
+    }
+#endif /* MQTT_COMMAND_POOL_LOCK_FREE */
+
+/*-----------------------------------------------------------*/
+
 void Agent_InitializePool( void )
 {
-    size_t i;
-    MQTTAgentCommand_t * pCommand;
-    static uint8_t staticQueueStorageArea[ MQTT_COMMAND_CONTEXTS_POOL_SIZE * sizeof( MQTTAgentCommand_t * ) ];
-    static StaticQueue_t staticQueueStructure;
-    bool commandAdded = false;
+    #if ( MQTT_COMMAND_POOL_LOCK_FREE == 0 )
+        size_t i;
+        MQTTAgentCommand_t * pCommand;
+        static uint8_t staticQueueStorageArea[ MQTT_COMMAND_CONTEXTS_POOL_SIZE * sizeof( MQTTAgentCommand_t * ) ];
+        static StaticQueue_t staticQueueStructure;
+        bool commandAdded = false;
+    #else
+        static StaticSemaphore_t staticSemaphoreStructure;
+        size_t i;
+    #endif
 
     if( initStatus == QUEUE_NOT_INITIALIZED )
     {
         memset( ( void * ) commandStructurePool, 0x00, sizeof( commandStructurePool ) );
-        commandStructMessageCtx.queue = xQueueCreate( MQTT_COMMAND_CONTEXTS_POOL_SIZE,
-                                                      sizeof( MQTTAgentCommand_t * ) );
-        configASSERT( commandStructMessageCtx.queue );
 
-        /* Populate the queue. */
-        for( i = 0; i < MQTT_COMMAND_CONTEXTS_POOL_SIZE; i++ )
+        #if ( MQTT_COMMAND_POOL_LOCK_FREE == 0 )
         {
-            /* Store the address as a variable. */
-            pCommand = &commandStructurePool[ i ];
-            /* Send the pointer to the queue. */
-            commandAdded = Agent_MessageSend( &commandStructMessageCtx, &pCommand, 0U );
-            configASSERT( commandAdded );
+            commandStructMessageCtx.queue = xQueueCreate( MQTT_COMMAND_CONTEXTS_POOL_SIZE,
+                                                          sizeof( MQTTAgentCommand_t * ) );
+            configASSERT( commandStructMessageCtx.queue );
+
+            /* Populate the queue. */
+            for( i = 0; i < MQTT_COMMAND_CONTEXTS_POOL_SIZE; i++ )
+            {
+                /* Store the address as a variable. */
+                pCommand = &commandStructurePool[ i ];
+                /* Send the pointer to the queue. */
+                commandAdded = Agent_MessageSend( &commandStructMessageCtx, &pCommand, 0U );
+                configASSERT( commandAdded );
+            }
         }
+        #else
+        {
+            commandReleasedSemaphore = xSemaphoreCreateCountingStatic( MQTT_COMMAND_CONTEXTS_POOL_SIZE,
+                                                                       0U,
+                                                                       &staticSemaphoreStructure );
+            configASSERT( commandReleasedSemaphore );
+
+            /* Mark every structure as free. */
+            for( i = 0; i < MQTT_COMMAND_CONTEXTS_POOL_SIZE; i++ )
+            {
+                freeMask[ i / 32U ] |= ( 1UL << ( i % 32U ) );
+            }
+        }
+        #endif /* MQTT_COMMAND_POOL_LOCK_FREE */
 
         initStatus = QUEUE_INITIALIZED;
     }
@@ -110,13 +240,69 @@ MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs )
     /* Check queue has been created. */
     configASSERT( initStatus == QUEUE_INITIALIZED );
 
-    /* Retrieve a struct from the queue. */
-    structRetrieved = Agent_MessageReceive( &commandStructMessageCtx, &( structToUse ), blockTimeMs );
+    #if ( MQTT_COMMAND_POOL_LOCK_FREE == 0 )
+    {
+        /* Retrieve a struct from the queue, without waiting first so that an
+         * empty pool is counted. */
+        structRetrieved = Agent_MessageReceive( &commandStructMessageCtx, &( structToUse ), 0U );
+
+        if( !structRetrieved )
+        {
+            ( void ) Atomic_Increment_u32( &poolExhaustedCount );
+
+            if( blockTimeMs > 0U )
+            {
+                structRetrieved = Agent_MessageReceive( &commandStructMessageCtx, &( structToUse ), blockTimeMs );
+            }
+        }
+    }
+    #else
+    {
+        TimeOut_t timeOut;
+        TickType_t ticksToWait = pdMS_TO_TICKS( blockTimeMs );
+
+        structToUse = prvTakeFromFreeMask();
+
+        if( structToUse == NULL )
+        {
+            ( void ) Atomic_Increment_u32( &poolExhaustedCount );
+
+            if( ticksToWait > 0U )
+            {
+                /* Announce the wait before looking again, so that a structure
+                 * released in between either is found here or gives the
+                 * semaphore. */
+                vTaskSetTimeOutState( &timeOut );
+                ( void ) Atomic_Increment_u32( &waitingTasks );
+
+                while( ( structToUse = prvTakeFromFreeMask() ) == NULL )
+                {
+                    if( xTaskCheckForTimeOut( &timeOut, &ticksToWait ) != pdFALSE )
+                    {
+                        break;
+                    }
+
+                    /* Another waiting task may take the structure, in which
+                     * case this task looks and waits again. */
+                    ( void ) xSemaphoreTake( commandReleasedSemaphore, ticksToWait );
+                }
+
+                ( void ) Atomic_Decrement_u32( &waitingTasks );
+            }
+        }
+
+        structRetrieved = ( structToUse != NULL );
+    }
+    #endif /* MQTT_COMMAND_POOL_LOCK_FREE */
 
     if( !structRetrieved )
     {
         LogError( ( "No command structure available." ) );
     }
+    else
+    {
+        prvCommandTaken();
+    }
 
     return structToUse;
 }
@@ -133,14 +319,50 @@ bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease )
     if( ( pCommandToRelease >= commandStructurePool ) &&
         ( pCommandToRelease < ( commandStructurePool + MQTT_COMMAND_CONTEXTS_POOL_SIZE ) ) )
     {
-        structReturned = Agent_MessageSend( &commandStructMessageCtx, &pCommandToRelease, 0U );
+        #if ( MQTT_COMMAND_POOL_LOCK_FREE == 0 )
+        {
+            structReturned = Agent_MessageSend( &commandStructMessageCtx, &pCommandToRelease, 0U );
+
+            /* The send should not fail as the queue was created to hold every command
+             * in the pool. */
+            configASSERT( structReturned );
+        }
+        #else
+        {
+            size_t index = ( size_t ) ( pCommandToRelease - commandStructurePool );
+            uint32_t bit = 1UL << ( index % 32U );
+
+            /* A structure that is already free must not be counted twice. */
+            structReturned = ( ( Atomic_OR_u32( &freeMask[ index / 32U ], bit ) & bit ) == 0U );
+            configASSERT( structReturned );
+
+            if( waitingTasks > 0U )
+            {
+                ( void ) xSemaphoreGive( commandReleasedSemaphore );
+            }
+        }
+        #endif /* MQTT_COMMAND_POOL_LOCK_FREE */
+
+        if( structReturned )
+        {
+            ( void ) Atomic_Decrement_u32( &commandsInUse );
+        }
 
-        /* The send should not fail as the queue was created to hold every command
-         * in the pool. */
-        configASSERT( structReturned );
         LogDebug( ( "Returned Command Context %d to pool",
                     ( int ) ( pCommandToRelease - commandStructurePool ) ) );
     }
 
     return structReturned;
 }
+
+/*-----------------------------------------------------------*/
+
+void Agent_GetPoolStats( CommandPoolStats_t * pStats )
+{
+    configASSERT( pStats != NULL );
+
+    pStats->poolSize = MQTT_COMMAND_CONTEXTS_POOL_SIZE;
+    pStats->inUse = commandsInUse;
+    pStats->highWatermark = commandsHighWatermark;
+    pStats->exhaustedCount = poolExhaustedCount;
+}
@@ -38,10 +38,58 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "semphr.h"
 
 /* Include MQTT agent messaging interface. */
 #include "core_mqtt_agent_message_interface.h"
 
+/**
+ * @brief Commands drained from the queue by Agent_MessageReceive() and not yet
+ * returned to the caller.
+ *
+ * Only attach a batch to a context that is read by one task, such as the
+ * command queue of the agent task.  The storage is provided by the owner of
+ * the context, count and next must initially be zero.
+ */
+typedef struct MQTTAgentMessageBatch
+{
+    MQTTAgentCommand_t ** pCommands; /**< @brief Storage for length command pointers. */
+    size_t length;                   /**< @brief The most commands drained per wake up. */
+    size_t count;                    /**< @brief Commands held in pCommands. */
+    size_t next;                     /**< @brief The next command to return. */
+} MQTTAgentMessageBatch_t;
+
+/**
+ * @brief Decides the lane of a command, see MQTTAgentMessageLanes_t.
+ *
+ * @param[in] pCommand The command being sent.
+ *
+ * @return `true` to send the command on the priority lane, `false` to send it
+ * on the bulk lane.
+ */
+typedef bool ( * MQTTAgentMessageClassifier_t )( const MQTTAgentCommand_t * pCommand );
+
+/**
+ * @brief A second, high priority, queue for a context.
+ *
+ * Commands the classifier selects are sent to priorityQueue, all others to the
+ * queue of the context.  The receiver takes commands from priorityQueue first
+ * but, after burst priority commands in a row, takes one command from the bulk
+ * lane if one is waiting, so that the bulk lane is never starved.  Every send
+ * gives pending, so the receiver can block on both lanes at once.
+ *
+ * The storage is provided by the owner of the context, consecutive must
+ * initially be zero.
+ */
+typedef struct MQTTAgentMessageLanes
+{
+    QueueHandle_t priorityQueue;           /**< @brief The queue of the priority lane. */
+    SemaphoreHandle_t pending;             /**< @brief Counting semaphore, with a maximum count of at least the length of both queues. */
+    MQTTAgentMessageClassifier_t classify; /**< @brief Optional, NULL to use Agent_MessageIsPriorityCommand(). */
+    size_t burst;                          /**< @brief The most priority commands taken in a row while the bulk lane waits, 0 for no limit. */
+    size_t consecutive;                    /**< @brief Priority commands taken in a row. */
+} MQTTAgentMessageLanes_t;
+
 /**
  * @ingroup mqtt_agent_struct_types
  * @brief Context with which tasks may deliver messages to the agent.
@@ -49,10 +97,38 @@
 struct MQTTAgentMessageContext
 {
     QueueHandle_t queue;
+    MQTTAgentMessageBatch_t * pBatch; /**< @brief Optional, NULL to receive one command per queue operation. */
+    MQTTAgentMessageLanes_t * pLanes; /**< @brief Optional, NULL to send every command to queue. */
 };
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief The default classifier of MQTTAgentMessageLanes_t.
+ *
+ * PUBLISH commands, which carry the bulk of the traffic, go to the bulk lane.
+ * All other commands, such as PING, SUBSCRIBE or the process loop wake ups,
+ * go to the priority lane.  An application that also wants some publishes,
+ * such as job status updates or shadow reports, on the priority lane can
+ * provide a classifier that checks the topic in the MQTTPublishInfo_t pointed
+ * to by the pArgs of a PUBLISH command, and calls this function otherwise.
+ *
+ * @param[in] pCommand The command being sent.
+ *
+ * @return `true` if the command is not a PUBLISH.
+ */
+bool Agent_MessageIsPriorityCommand( const MQTTAgentCommand_t * pCommand );
+
+/**
+ * @brief The number of commands waiting in the specified context, in both
+ * lanes.  Commands already drained into a batch are not counted.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
+ *
+ * @return The number of commands waiting.
+ */
+size_t Agent_MessagesWaiting( const MQTTAgentMessageContext_t * pMsgCtx );
+
 /**
  * @brief Send a message to the specified context.
  * Must be thread safe.
@@ -71,6 +147,12 @@ bool Agent_MessageSend( const MQTTAgentMessageContext_t * pMsgCtx,
  * @brief Receive a message from the specified context.
  * Must be thread safe.
  *
+ * @note When the context has a batch, a call that finds the batch empty
+ * drains every pending command, up to the length of the batch, and the
+ * following calls return them without accessing the queue.  With lanes, the
+ * batch holds the priority commands first, so a priority command sent while
+ * the batch is served waits for the rest of the batch.
+ *
  * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
  * @param[in] pReceivedCommand Pointer to write address of received command.
  * @param[in] blockTimeMs Block time to wait for a receive.
@@ -81,4 +163,45 @@ bool Agent_MessageReceive( const MQTTAgentMessageContext_t * pMsgCtx,
                            MQTTAgentCommand_t ** pReceivedCommand,
                            uint32_t blockTimeMs );
 
+/**
+ * @brief Send several messages to the specified context, waking up the
+ * receiving task once for all of them.
+ * Must be thread safe.
+ *
+ * @note The messages that fit in the queue are sent with the scheduler
+ * suspended.  Only the remaining messages wait up to blockTimeMs each.  With
+ * lanes, the order of the messages is kept within each lane.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
+ * @param[in] pCommandsToSend The commands, sent in order.
+ * @param[in] commandCount The number of commands.
+ * @param[in] blockTimeMs Block time to wait for each send, once the queue is full.
+ *
+ * @return The number of commands sent, from the start of pCommandsToSend.
+ */
+size_t Agent_MessageSendMany( const MQTTAgentMessageContext_t * pMsgCtx,
+                              MQTTAgentCommand_t * const * pCommandsToSend,
+                              size_t commandCount,
+                              uint32_t blockTimeMs );
+
+/**
+ * @brief Receive all pending messages, up to a maximum, from the specified
+ * context.
+ * Must be thread safe.
+ *
+ * @note With lanes, the messages are taken in the same order as by
+ * Agent_MessageReceive() without a batch.
+ *
+ * @param[in] pMsgCtx An #MQTTAgentMessageContext_t.
+ * @param[out] pReceivedCommands Array to write the received commands to.
+ * @param[in] maxCommands The length of pReceivedCommands.
+ * @param[in] blockTimeMs Block time to wait for the first message.
+ *
+ * @return The number of commands received, 0 if none arrived in time.
+ */
+size_t Agent_MessageReceiveMany( const MQTTAgentMessageContext_t * pMsgCtx,
+                                 MQTTAgentCommand_t ** pReceivedCommands,
+                                 size_t maxCommands,
+                                 uint32_t blockTimeMs );
+
 #endif /* FREERTOS_AGENT_MESSAGE_H */
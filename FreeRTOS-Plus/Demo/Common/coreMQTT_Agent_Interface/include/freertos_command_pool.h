@@ -34,6 +34,17 @@
 /* MQTT agent includes. */
 #include "core_mqtt_agent.h"
 
+/**
+ * @brief The usage counters of the pool, see Agent_GetPoolStats().
+ */
+typedef struct CommandPoolStats
+{
+    uint32_t poolSize;       /**< @brief MQTT_COMMAND_CONTEXTS_POOL_SIZE. */
+    uint32_t inUse;          /**< @brief Structures obtained and not yet released. */
+    uint32_t highWatermark;  /**< @brief The largest value of inUse so far. */
+    uint32_t exhaustedCount; /**< @brief Calls to Agent_GetCommand() that found the pool empty. */
+} CommandPoolStats_t;
+
 /**
  * @brief Initialize the common task pool. Not thread safe.
  */
@@ -80,4 +91,12 @@ MQTTAgentCommand_t * Agent_GetCommand( uint32_t blockTimeMs );
  */
 bool Agent_ReleaseCommand( MQTTAgentCommand_t * pCommandToRelease );
 
+/**
+ * @brief Get the usage counters of the pool, e.g. to choose a value for
+ * MQTT_COMMAND_CONTEXTS_POOL_SIZE.
+ *
+ * @param[out] pStats Populated with the counters.
+ */
+void Agent_GetPoolStats( CommandPoolStats_t * pStats );
+
 #endif /* FREERTOS_COMMAND_POOL_H */
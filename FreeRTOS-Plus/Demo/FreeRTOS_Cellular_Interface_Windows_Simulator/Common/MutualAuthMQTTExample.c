@@ -229,6 +229,17 @@
  */
 #define mqttexampleINCOMING_PUBLISH_RECORD_LEN            ( 15U )
 
+/**
+ * @brief Size of the buffer holding the cached address of the broker.
+ */
+#define mqttexampleBROKER_ADDRESS_LENGTH                  ( 64U )
+
+/**
+ * @brief Time in milliseconds after which the cached address of the broker is
+ * resolved again, so that a change of the DNS record is picked up.
+ */
+#define mqttexampleBROKER_ADDRESS_MAX_AGE_MS              ( 60U * 60U * 1000U )
+
 /**
  * Provide default values for undefined configuration settings.
  */
@@ -279,6 +290,23 @@ struct NetworkContext
     TlsTransportParams_t * pParams;
 };
 
+/**
+ * @brief State the reconnect manager keeps between connections, so that a
+ * reconnect only redoes the steps which the loss of a connection undid.
+ *
+ * The cellular registration and PDN context are set up once by setupCellular()
+ * and are only checked again after a loss.  The TLS session is resumed from
+ * the session cache of the transport when TLS_TRANSPORT_SESSION_CACHE_ENTRIES
+ * is not 0.
+ */
+typedef struct ReconnectManager
+{
+    char cBrokerAddress[ mqttexampleBROKER_ADDRESS_LENGTH ]; /**< Cached address of the broker, empty when unknown. */
+    uint32_t ulBrokerAddressTimeMs;                         /**< Time at which cBrokerAddress was resolved. */
+    BaseType_t xConnectionLost;                             /**< pdTRUE when the last connection failed instead of being closed. */
+    uint32_t ulConnectCount;                                /**< Connections established so far. */
+} ReconnectManager_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -290,13 +318,40 @@ struct NetworkContext
 static void prvMQTTDemoTask( void * pvParameters );
 
 
+/**
+ * @brief Set the credentials for the TLS connections to the broker.
+ *
+ * @param[out] pxNetworkCredentials The credentials to set.
+ */
+static void prvInitializeNetworkCredentials( NetworkCredentials_t * pxNetworkCredentials );
+
+/**
+ * @brief Prepare the MQTT CONNECT information once, so that each connection
+ * only has to send it.
+ */
+static void prvInitializeConnectInfo( void );
+
+/**
+ * @brief Get the address to open the TCP connection to the broker with.
+ *
+ * The address is resolved by the cellular module when it is not cached or the
+ * cached one is older than mqttexampleBROKER_ADDRESS_MAX_AGE_MS.
+ *
+ * @return The cached address, or NULL to let the module resolve the host name
+ * when the connection is opened.
+ */
+static const char * prvGetBrokerAddress( void );
+
 /**
  * @brief Connect to MQTT broker with reconnection retries.
  *
  * If connection fails, retry is attempted after a timeout.
  * Timeout value will exponentially increase until maximum
  * timeout value is reached or the number of attempts are exhausted.
+ * After a loss the cellular network is checked before each attempt, and after
+ * a failed attempt the cached address of the broker is dropped.
  *
+ * @param[in, out] pxNetworkCredentials The credentials to connect with.
  * @param[out] pxNetworkContext The parameter to return the created network context.
  *
  * @return The status of the final connection attempt.
@@ -309,9 +364,11 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkCredent
  *
  * @param[in, out] pxMQTTContext MQTT context pointer.
  * @param[in] xNetworkContext Network context.
+ *
+ * @return The status of #MQTT_Connect.
  */
-static void prvCreateMQTTConnectionWithBroker( MQTTContext_t * pxMQTTContext,
-                                               NetworkContext_t * pxNetworkContext );
+static MQTTStatus_t prvCreateMQTTConnectionWithBroker( MQTTContext_t * pxMQTTContext,
+                                                       NetworkContext_t * pxNetworkContext );
 
 /**
  * @brief Function to update variable #xTopicFilterContext with status
@@ -328,23 +385,29 @@ static void prvUpdateSubAckStatus( MQTTPacketInfo_t * pxPacketInfo );
  * retried using an exponential backoff strategy with jitter.
  *
  * @param[in] pxMQTTContext MQTT context pointer.
+ *
+ * @return MQTTSuccess, or the status of the MQTT call which failed.
  */
-static void prvMQTTSubscribeWithBackoffRetries( MQTTContext_t * pxMQTTContext );
+static MQTTStatus_t prvMQTTSubscribeWithBackoffRetries( MQTTContext_t * pxMQTTContext );
 
 /**
  * @brief Publishes a message mqttexampleMESSAGE on mqttexampleTOPIC topic.
  *
  * @param[in] pxMQTTContext MQTT context pointer.
+ *
+ * @return The status of #MQTT_Publish.
  */
-static void prvMQTTPublishToTopic( MQTTContext_t * pxMQTTContext );
+static MQTTStatus_t prvMQTTPublishToTopic( MQTTContext_t * pxMQTTContext );
 
 /**
  * @brief Unsubscribes from the previously subscribed topic as specified
  * in mqttexampleTOPIC.
  *
  * @param[in] pxMQTTContext MQTT context pointer.
+ *
+ * @return The status of #MQTT_Unsubscribe.
  */
-static void prvMQTTUnsubscribeFromTopic( MQTTContext_t * pxMQTTContext );
+static MQTTStatus_t prvMQTTUnsubscribeFromTopic( MQTTContext_t * pxMQTTContext );
 
 /**
  * @brief The timer query function provided to the MQTT context.
@@ -401,6 +464,12 @@ static MQTTStatus_t prvProcessLoopWithTimeout( MQTTContext_t * pMqttContext,
 
 extern UBaseType_t uxRand();
 
+/* Provided by cellular_setup.c. */
+extern bool recoverCellular( void );
+extern bool resolveHostCellular( const char * pHostName,
+                                 char * pAddress,
+                                 size_t addressLength );
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -479,6 +548,16 @@ static MQTTPubAckInfo_t pOutgoingPublishRecords[ mqttexampleOUTGOING_PUBLISH_REC
  */
 static MQTTPubAckInfo_t pIncomingPublishRecords[ mqttexampleINCOMING_PUBLISH_RECORD_LEN ];
 
+/**
+ * @brief The MQTT CONNECT information, prepared once by #prvInitializeConnectInfo.
+ */
+static MQTTConnectInfo_t xConnectInfo;
+
+/**
+ * @brief The state of the reconnect manager.
+ */
+static ReconnectManager_t xReconnectManager;
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -524,6 +603,7 @@ static void prvMQTTDemoTask( void * pvParameters )
     MQTTContext_t xMQTTContext = { 0 };
     MQTTStatus_t xMQTTStatus;
     TlsTransportStatus_t xNetworkStatus;
+    uint32_t ulConnectStartTimeMs;
 
     /* Remove compiler warnings about unused parameters. */
     ( void ) pvParameters;
@@ -537,10 +617,17 @@ static void prvMQTTDemoTask( void * pvParameters )
     /* Set the pParams member of the network context with desired transport. */
     xNetworkContext.pParams = &xTlsTransportParams;
 
+    /* Everything which does not change between connections is set up once,
+     * so that a reconnect starts the TLS handshake, and the MQTT CONNECT right
+     * after it, without delay. */
+    prvInitializeNetworkCredentials( &xNetworkCredentials );
+    prvInitializeConnectInfo();
+
     for( ; ; )
     {
         LogInfo( ( "---------STARTING DEMO---------\r\n" ) );
         /****************************** Connect. ******************************/
+        ulConnectStartTimeMs = prvGetTimeMs();
 
         /* Attempt to establish TLS session with MQTT broker. If connection fails,
          * retry after a timeout. Timeout value will be exponentially increased
@@ -555,52 +642,84 @@ static void prvMQTTDemoTask( void * pvParameters )
         /* Sends an MQTT Connect packet over the already established TLS connection,
          * and waits for connection acknowledgment (CONNACK) packet. */
         LogInfo( ( "Creating an MQTT connection to %s.\r\n", democonfigMQTT_BROKER_ENDPOINT ) );
-        prvCreateMQTTConnectionWithBroker( &xMQTTContext, &xNetworkContext );
+        xMQTTStatus = prvCreateMQTTConnectionWithBroker( &xMQTTContext, &xNetworkContext );
+
+        if( xMQTTStatus == MQTTSuccess )
+        {
+            xReconnectManager.ulConnectCount++;
+            LogInfo( ( "%s %u connected in %u ms.\r\n",
+                       ( xReconnectManager.xConnectionLost == pdTRUE ) ? "Reconnect after a loss" : "Connection",
+                       ( unsigned int ) xReconnectManager.ulConnectCount,
+                       ( unsigned int ) ( prvGetTimeMs() - ulConnectStartTimeMs ) ) );
+
+            #if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+            {
+                TlsSessionCacheStats_t xSessionCacheStats;
+
+                TLS_FreeRTOS_GetSessionCacheStats( &xSessionCacheStats );
+                LogInfo( ( "TLS handshakes: %u full, %u resumed.\r\n",
+                           ( unsigned int ) xSessionCacheStats.fullHandshakes,
+                           ( unsigned int ) xSessionCacheStats.resumedHandshakes ) );
+            }
+            #endif
 
-        /**************************** Subscribe. ******************************/
+            /**************************** Subscribe. ******************************/
 
-        /* If server rejected the subscription request, attempt to resubscribe to
-         * topic. Attempts are made according to the exponential backoff retry
-         * strategy implemented in BackoffAlgorithm. */
-        prvMQTTSubscribeWithBackoffRetries( &xMQTTContext );
+            /* If server rejected the subscription request, attempt to resubscribe to
+             * topic. Attempts are made according to the exponential backoff retry
+             * strategy implemented in BackoffAlgorithm. */
+            xMQTTStatus = prvMQTTSubscribeWithBackoffRetries( &xMQTTContext );
+        }
 
         /****************** Publish and Keep Alive Loop. **********************/
         /* Publish messages with QoS1, send and process Keep alive messages. */
-        for( ulPublishCount = 0; ulPublishCount < ulMaxPublishCount; ulPublishCount++ )
+        for( ulPublishCount = 0; ( xMQTTStatus == MQTTSuccess ) && ( ulPublishCount < ulMaxPublishCount ); ulPublishCount++ )
         {
             LogInfo( ( "Publish to the MQTT topic %s.\r\n", mqttexampleTOPIC ) );
-            prvMQTTPublishToTopic( &xMQTTContext );
+            xMQTTStatus = prvMQTTPublishToTopic( &xMQTTContext );
 
-            /* Process incoming publish echo, since application subscribed to the
-             * same topic, the broker will send publish message back to the
-             * application. */
-            LogInfo( ( "Attempt to receive publish message from broker.\r\n" ) );
-            xMQTTStatus = prvProcessLoopWithTimeout( &xMQTTContext, mqttexamplePROCESS_LOOP_TIMEOUT_MS );
-            configASSERT( xMQTTStatus == MQTTSuccess );
+            if( xMQTTStatus == MQTTSuccess )
+            {
+                /* Process incoming publish echo, since application subscribed to the
+                 * same topic, the broker will send publish message back to the
+                 * application. */
+                LogInfo( ( "Attempt to receive publish message from broker.\r\n" ) );
+                xMQTTStatus = prvProcessLoopWithTimeout( &xMQTTContext, mqttexamplePROCESS_LOOP_TIMEOUT_MS );
+            }
 
-            /* Leave Connection Idle for some time. */
-            LogInfo( ( "Keeping Connection Idle...\r\n\r\n" ) );
-            vTaskDelay( mqttexampleDELAY_BETWEEN_PUBLISHES_TICKS );
+            if( xMQTTStatus == MQTTSuccess )
+            {
+                /* Leave Connection Idle for some time. */
+                LogInfo( ( "Keeping Connection Idle...\r\n\r\n" ) );
+                vTaskDelay( mqttexampleDELAY_BETWEEN_PUBLISHES_TICKS );
+            }
         }
 
         /******************** Unsubscribe from the topic. *********************/
-        LogInfo( ( "Unsubscribe from the MQTT topic %s.\r\n", mqttexampleTOPIC ) );
-        prvMQTTUnsubscribeFromTopic( &xMQTTContext );
+        if( xMQTTStatus == MQTTSuccess )
+        {
+            LogInfo( ( "Unsubscribe from the MQTT topic %s.\r\n", mqttexampleTOPIC ) );
+            xMQTTStatus = prvMQTTUnsubscribeFromTopic( &xMQTTContext );
+        }
 
-        /* Process incoming UNSUBACK packet from the broker. */
-        xMQTTStatus = prvProcessLoopWithTimeout( &xMQTTContext, mqttexamplePROCESS_LOOP_TIMEOUT_MS );
-        configASSERT( xMQTTStatus == MQTTSuccess );
+        if( xMQTTStatus == MQTTSuccess )
+        {
+            /* Process incoming UNSUBACK packet from the broker. */
+            xMQTTStatus = prvProcessLoopWithTimeout( &xMQTTContext, mqttexamplePROCESS_LOOP_TIMEOUT_MS );
+        }
 
         /**************************** Disconnect. *****************************/
 
-        /* Send an MQTT Disconnect packet over the already connected TLS over
-         * TCP connection. There is no corresponding response for the disconnect
-         * packet. After sending disconnect, client must close the network
-         * connection. */
-        LogInfo( ( "Disconnecting the MQTT connection with %s.\r\n",
-                   democonfigMQTT_BROKER_ENDPOINT ) );
-        xMQTTStatus = MQTT_Disconnect( &xMQTTContext );
-        configASSERT( xMQTTStatus == MQTTSuccess );
+        if( xMQTTStatus == MQTTSuccess )
+        {
+            /* Send an MQTT Disconnect packet over the already connected TLS over
+             * TCP connection. There is no corresponding response for the disconnect
+             * packet. After sending disconnect, client must close the network
+             * connection. */
+            LogInfo( ( "Disconnecting the MQTT connection with %s.\r\n",
+                       democonfigMQTT_BROKER_ENDPOINT ) );
+            xMQTTStatus = MQTT_Disconnect( &xMQTTContext );
+        }
 
         /* Close the network connection.  */
         TLS_FreeRTOS_Disconnect( &xNetworkContext );
@@ -612,27 +731,36 @@ static void prvMQTTDemoTask( void * pvParameters )
             xTopicFilterContext[ ulTopicCount ].xSubAckStatus = MQTTSubAckFailure;
         }
 
-        /* Wait for some time between two iterations to ensure that we do not
-         * bombard the broker. */
-        LogInfo( ( "prvMQTTDemoTask() completed an iteration successfully. "
-                   "Total free heap is %u.\r\n",
-                   xPortGetFreeHeapSize() ) );
-        LogInfo( ( "Demo completed successfully.\r\n" ) );
-        LogInfo( ( "-------DEMO FINISHED-------\r\n" ) );
-        LogInfo( ( "Short delay before starting the next iteration.... \r\n\r\n" ) );
-        vTaskDelay( mqttexampleDELAY_BETWEEN_DEMO_ITERATIONS_TICKS );
+        if( xMQTTStatus == MQTTSuccess )
+        {
+            xReconnectManager.xConnectionLost = pdFALSE;
+
+            /* Wait for some time between two iterations to ensure that we do not
+             * bombard the broker. */
+            LogInfo( ( "prvMQTTDemoTask() completed an iteration successfully. "
+                       "Total free heap is %u.\r\n",
+                       xPortGetFreeHeapSize() ) );
+            LogInfo( ( "Demo completed successfully.\r\n" ) );
+            LogInfo( ( "-------DEMO FINISHED-------\r\n" ) );
+            LogInfo( ( "Short delay before starting the next iteration.... \r\n\r\n" ) );
+            vTaskDelay( mqttexampleDELAY_BETWEEN_DEMO_ITERATIONS_TICKS );
+        }
+        else
+        {
+            /* Reconnect at once.  The backoff of
+             * prvConnectToServerWithBackoffRetries() paces the attempts if the
+             * broker cannot be reached. */
+            LogWarn( ( "The MQTT connection with %s was lost with status %s. Reconnecting.\r\n",
+                       democonfigMQTT_BROKER_ENDPOINT,
+                       MQTT_Status_strerror( xMQTTStatus ) ) );
+            xReconnectManager.xConnectionLost = pdTRUE;
+        }
     }
 }
 /*-----------------------------------------------------------*/
 
-static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkCredentials_t * pxNetworkCredentials,
-                                                                  NetworkContext_t * pxNetworkContext )
+static void prvInitializeNetworkCredentials( NetworkCredentials_t * pxNetworkCredentials )
 {
-    TlsTransportStatus_t xNetworkStatus;
-    BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
-    BackoffAlgorithmContext_t xReconnectParams;
-    uint16_t usNextRetryBackOff = 0U;
-
     #ifdef democonfigUSE_AWS_IOT_CORE_BROKER
     #if defined( democonfigCLIENT_USERNAME )
 
@@ -686,6 +814,52 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkCredent
         pxNetworkCredentials->privateKeySize = sizeof( democonfigCLIENT_PRIVATE_KEY_PEM );
     #endif
 
+    /* No address is cached yet, so the TCP connection goes to the host name. */
+    pxNetworkCredentials->pServerAddress = NULL;
+}
+/*-----------------------------------------------------------*/
+
+static const char * prvGetBrokerAddress( void )
+{
+    uint32_t ulNowMs = prvGetTimeMs();
+
+    if( ( xReconnectManager.cBrokerAddress[ 0 ] != '\0' ) &&
+        ( ( ulNowMs - xReconnectManager.ulBrokerAddressTimeMs ) >= mqttexampleBROKER_ADDRESS_MAX_AGE_MS ) )
+    {
+        xReconnectManager.cBrokerAddress[ 0 ] = '\0';
+    }
+
+    if( xReconnectManager.cBrokerAddress[ 0 ] == '\0' )
+    {
+        if( resolveHostCellular( democonfigMQTT_BROKER_ENDPOINT,
+                                 xReconnectManager.cBrokerAddress,
+                                 sizeof( xReconnectManager.cBrokerAddress ) ) == true )
+        {
+            xReconnectManager.ulBrokerAddressTimeMs = ulNowMs;
+            LogInfo( ( "Resolved %s to %s.\r\n",
+                       democonfigMQTT_BROKER_ENDPOINT,
+                       xReconnectManager.cBrokerAddress ) );
+        }
+        else
+        {
+            /* The module resolves the host name when the connection is
+             * opened instead. */
+            xReconnectManager.cBrokerAddress[ 0 ] = '\0';
+        }
+    }
+
+    return ( xReconnectManager.cBrokerAddress[ 0 ] != '\0' ) ? xReconnectManager.cBrokerAddress : NULL;
+}
+/*-----------------------------------------------------------*/
+
+static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkCredentials_t * pxNetworkCredentials,
+                                                                  NetworkContext_t * pxNetworkContext )
+{
+    TlsTransportStatus_t xNetworkStatus;
+    BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
+    BackoffAlgorithmContext_t xReconnectParams;
+    uint16_t usNextRetryBackOff = 0U;
+
     /* Initialize reconnect attempts and interval. */
     BackoffAlgorithm_InitializeParams( &xReconnectParams,
                                        mqttexampleRETRY_BACKOFF_BASE_MS,
@@ -698,11 +872,21 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkCredent
      */
     do
     {
+        /* After a loss, only reactivate what the network actually dropped.
+         * Usually the registration and the PDN context survived it. */
+        if( ( xReconnectManager.xConnectionLost == pdTRUE ) && ( recoverCellular() == false ) )
+        {
+            LogWarn( ( "The cellular network is not available yet.\r\n" ) );
+        }
+
+        pxNetworkCredentials->pServerAddress = prvGetBrokerAddress();
+
         /* Establish a TLS session with the MQTT broker. This example connects to
          * the MQTT broker as specified in democonfigMQTT_BROKER_ENDPOINT and
          * democonfigMQTT_BROKER_PORT at the top of this file. */
         LogInfo( ( "Creating a TLS connection to %s:%u.\r\n",
-                   democonfigMQTT_BROKER_ENDPOINT,
+                   ( pxNetworkCredentials->pServerAddress != NULL ) ?
+                   pxNetworkCredentials->pServerAddress : democonfigMQTT_BROKER_ENDPOINT,
                    democonfigMQTT_BROKER_PORT ) );
         /* Attempt to create a mutually authenticated TLS connection. */
         xNetworkStatus = TLS_FreeRTOS_Connect( pxNetworkContext,
@@ -714,6 +898,11 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkCredent
 
         if( xNetworkStatus != TLS_TRANSPORT_SUCCESS )
         {
+            /* The cached address or the network may be what failed, so resolve
+             * the address again and check the network before the next attempt. */
+            xReconnectManager.cBrokerAddress[ 0 ] = '\0';
+            xReconnectManager.xConnectionLost = pdTRUE;
+
             /* Generate a random number and calculate backoff value (in milliseconds) for
              * the next connection retry.
              * Note: It is recommended to seed the random number generator with a device-specific
@@ -738,35 +927,8 @@ static TlsTransportStatus_t prvConnectToServerWithBackoffRetries( NetworkCredent
 }
 /*-----------------------------------------------------------*/
 
-static void prvCreateMQTTConnectionWithBroker( MQTTContext_t * pxMQTTContext,
-                                               NetworkContext_t * pxNetworkContext )
+static void prvInitializeConnectInfo( void )
 {
-    MQTTStatus_t xResult;
-    MQTTConnectInfo_t xConnectInfo;
-    bool xSessionPresent;
-    TransportInterface_t xTransport;
-
-    /***
-     * For readability, error handling in this function is restricted to the use of
-     * asserts().
-     ***/
-
-    /* Fill in Transport Interface send and receive function pointers. */
-    xTransport.pNetworkContext = pxNetworkContext;
-    xTransport.send = TLS_FreeRTOS_send;
-    xTransport.recv = TLS_FreeRTOS_recv;
-    xTransport.writev = NULL;
-
-    /* Initialize MQTT library. */
-    xResult = MQTT_Init( pxMQTTContext, &xTransport, prvGetTimeMs, prvEventCallback, &xBuffer );
-    configASSERT( xResult == MQTTSuccess );
-    xResult = MQTT_InitStatefulQoS( pxMQTTContext,
-                                    pOutgoingPublishRecords,
-                                    mqttexampleOUTGOING_PUBLISH_RECORD_LEN,
-                                    pIncomingPublishRecords,
-                                    mqttexampleINCOMING_PUBLISH_RECORD_LEN );
-    configASSERT( xResult == MQTTSuccess );
-
     /* Some fields are not used in this demo so start with everything at 0. */
     ( void ) memset( ( void * ) &xConnectInfo, 0x00, sizeof( xConnectInfo ) );
 
@@ -813,6 +975,31 @@ static void prvCreateMQTTConnectionWithBroker( MQTTContext_t * pxMQTTContext,
             xConnectInfo.passwordLength = ( uint16_t ) strlen( democonfigCLIENT_PASSWORD );
         #endif /* ifdef democonfigCLIENT_USERNAME */
     #endif /* ifdef democonfigUSE_AWS_IOT_CORE_BROKER */
+}
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t prvCreateMQTTConnectionWithBroker( MQTTContext_t * pxMQTTContext,
+                                                       NetworkContext_t * pxNetworkContext )
+{
+    MQTTStatus_t xResult;
+    bool xSessionPresent;
+    TransportInterface_t xTransport;
+
+    /* Fill in Transport Interface send and receive function pointers. */
+    xTransport.pNetworkContext = pxNetworkContext;
+    xTransport.send = TLS_FreeRTOS_send;
+    xTransport.recv = TLS_FreeRTOS_recv;
+    xTransport.writev = NULL;
+
+    /* Initialize MQTT library. */
+    xResult = MQTT_Init( pxMQTTContext, &xTransport, prvGetTimeMs, prvEventCallback, &xBuffer );
+    configASSERT( xResult == MQTTSuccess );
+    xResult = MQTT_InitStatefulQoS( pxMQTTContext,
+                                    pOutgoingPublishRecords,
+                                    mqttexampleOUTGOING_PUBLISH_RECORD_LEN,
+                                    pIncomingPublishRecords,
+                                    mqttexampleINCOMING_PUBLISH_RECORD_LEN );
+    configASSERT( xResult == MQTTSuccess );
 
     /* Send MQTT CONNECT packet to broker. LWT is not used in this demo, so it
      * is passed as NULL. */
@@ -821,10 +1008,20 @@ static void prvCreateMQTTConnectionWithBroker( MQTTContext_t * pxMQTTContext,
                             NULL,
                             mqttexampleCONNACK_RECV_TIMEOUT_MS,
                             &xSessionPresent );
-    configASSERT( xResult == MQTTSuccess );
 
-    /* Successfully established and MQTT connection with the broker. */
-    LogInfo( ( "An MQTT connection is established with %s.", democonfigMQTT_BROKER_ENDPOINT ) );
+    if( xResult == MQTTSuccess )
+    {
+        /* Successfully established and MQTT connection with the broker. */
+        LogInfo( ( "An MQTT connection is established with %s.", democonfigMQTT_BROKER_ENDPOINT ) );
+    }
+    else
+    {
+        LogError( ( "Failed to establish an MQTT connection with %s: %s.",
+                    democonfigMQTT_BROKER_ENDPOINT,
+                    MQTT_Status_strerror( xResult ) ) );
+    }
+
+    return xResult;
 }
 /*-----------------------------------------------------------*/
 
@@ -848,7 +1045,7 @@ static void prvUpdateSubAckStatus( MQTTPacketInfo_t * pxPacketInfo )
 }
 /*-----------------------------------------------------------*/
 
-static void prvMQTTSubscribeWithBackoffRetries( MQTTContext_t * pxMQTTContext )
+static MQTTStatus_t prvMQTTSubscribeWithBackoffRetries( MQTTContext_t * pxMQTTContext )
 {
     MQTTStatus_t xResult = MQTTSuccess;
     BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
@@ -890,7 +1087,11 @@ static void prvMQTTSubscribeWithBackoffRetries( MQTTContext_t * pxMQTTContext )
                                   xMQTTSubscription,
                                   sizeof( xMQTTSubscription ) / sizeof( MQTTSubscribeInfo_t ),
                                   usSubscribePacketIdentifier );
-        configASSERT( xResult == MQTTSuccess );
+
+        if( xResult != MQTTSuccess )
+        {
+            break;
+        }
 
         LogInfo( ( "SUBSCRIBE sent for topic %s to broker.\n\n", mqttexampleTOPIC ) );
 
@@ -902,7 +1103,11 @@ static void prvMQTTSubscribeWithBackoffRetries( MQTTContext_t * pxMQTTContext )
          * must be ready to receive any packet.  This demo uses the generic packet
          * processing function everywhere to highlight this fact. */
         xResult = prvProcessLoopWithTimeout( pxMQTTContext, mqttexamplePROCESS_LOOP_TIMEOUT_MS );
-        configASSERT( xResult == MQTTSuccess );
+
+        if( xResult != MQTTSuccess )
+        {
+            break;
+        }
 
         /* Reset flag before checking suback responses. */
         xFailedSubscribeToTopic = false;
@@ -943,19 +1148,16 @@ static void prvMQTTSubscribeWithBackoffRetries( MQTTContext_t * pxMQTTContext )
 
         configASSERT( xBackoffAlgStatus != BackoffAlgorithmRetriesExhausted );
     } while( ( xFailedSubscribeToTopic == true ) && ( xBackoffAlgStatus == BackoffAlgorithmSuccess ) );
+
+    return xResult;
 }
 /*-----------------------------------------------------------*/
 
-static void prvMQTTPublishToTopic( MQTTContext_t * pxMQTTContext )
+static MQTTStatus_t prvMQTTPublishToTopic( MQTTContext_t * pxMQTTContext )
 {
     MQTTStatus_t xResult;
     MQTTPublishInfo_t xMQTTPublishInfo;
 
-    /***
-     * For readability, error handling in this function is restricted to the use of
-     * asserts().
-     ***/
-
     /* Some fields are not used by this demo so start with everything at 0. */
     ( void ) memset( ( void * ) &xMQTTPublishInfo, 0x00, sizeof( xMQTTPublishInfo ) );
 
@@ -973,11 +1175,11 @@ static void prvMQTTPublishToTopic( MQTTContext_t * pxMQTTContext )
     /* Send PUBLISH packet. Packet ID is not used for a QoS1 publish. */
     xResult = MQTT_Publish( pxMQTTContext, &xMQTTPublishInfo, usPublishPacketIdentifier );
 
-    configASSERT( xResult == MQTTSuccess );
+    return xResult;
 }
 /*-----------------------------------------------------------*/
 
-static void prvMQTTUnsubscribeFromTopic( MQTTContext_t * pxMQTTContext )
+static MQTTStatus_t prvMQTTUnsubscribeFromTopic( MQTTContext_t * pxMQTTContext )
 {
     MQTTStatus_t xResult;
     MQTTSubscribeInfo_t xMQTTSubscription[ mqttexampleTOPIC_COUNT ];
@@ -1003,7 +1205,7 @@ static void prvMQTTUnsubscribeFromTopic( MQTTContext_t * pxMQTTContext )
                                 sizeof( xMQTTSubscription ) / sizeof( MQTTSubscribeInfo_t ),
                                 usUnsubscribePacketIdentifier );
 
-    configASSERT( xResult == MQTTSuccess );
+    return xResult;
 }
 /*-----------------------------------------------------------*/
 
@@ -0,0 +1,303 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/**
+ * @file cellular_bench.c
+ * @brief Measure AT command and socket throughput over the cellular comm interface.
+ *
+ * The bench is run instead of the MQTT demo when democonfigCELLULAR_BENCH is set
+ * to 1 in demo_config.h. It prints one "BENCH <name> <value>" line per figure,
+ * so that runs with comm_if_windows.c and with comm_if_windows_ring_buffer.c can
+ * be compared.
+ */
+
+/* Standard includes. */
+#include <string.h>
+#include <stdio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo Specific configs. */
+#include "demo_config.h"
+
+/* The config header is always included first. */
+#ifndef CELLULAR_DO_NOT_USE_CUSTOM_CONFIG
+    /* Include custom config file before other headers. */
+    #include "cellular_config.h"
+#endif
+#include "cellular_config_defaults.h"
+#include "cellular_types.h"
+#include "cellular_api.h"
+#include "comm_if_ring_buffer.h"
+
+/* TCP sockets wrapper include. */
+#include "tcp_sockets_wrapper.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The number of "AT" commands sent to measure the AT command rate.
+ */
+#ifndef democonfigCELLULAR_BENCH_AT_COMMANDS
+    #define democonfigCELLULAR_BENCH_AT_COMMANDS    ( 200U )
+#endif
+
+/**
+ * @brief The number of bytes sent to, and echoed back by, the echo server.
+ */
+#ifndef democonfigCELLULAR_BENCH_SOCKET_BYTES
+    #define democonfigCELLULAR_BENCH_SOCKET_BYTES    ( 64U * 1024U )
+#endif
+
+/**
+ * @brief The number of bytes sent at once to the echo server.
+ */
+#ifndef democonfigCELLULAR_BENCH_SOCKET_CHUNK_SIZE
+    #define democonfigCELLULAR_BENCH_SOCKET_CHUNK_SIZE    ( 1024U )
+#endif
+
+/**
+ * @brief The socket timeouts of the bench in milliseconds.
+ */
+#ifndef democonfigCELLULAR_BENCH_SOCKET_TIMEOUT_MS
+    #define democonfigCELLULAR_BENCH_SOCKET_TIMEOUT_MS    ( 10000U )
+#endif
+
+/*
+ * The socket throughput is only measured when democonfigCELLULAR_BENCH_ECHO_SERVER
+ * and democonfigCELLULAR_BENCH_ECHO_PORT name a TCP echo server, for example:
+ *
+ * #define democonfigCELLULAR_BENCH_ECHO_SERVER    "...insert here..."
+ * #define democonfigCELLULAR_BENCH_ECHO_PORT      ( 7 )
+ */
+
+/*-----------------------------------------------------------*/
+
+/* The cellular handle set up by setupCellular(). */
+extern CellularHandle_t CellularHandle;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send "AT" commands back to back and print the rate and the mean latency.
+ */
+static void prvBenchATCommands( void );
+
+#if defined( democonfigCELLULAR_BENCH_ECHO_SERVER ) && defined( democonfigCELLULAR_BENCH_ECHO_PORT )
+
+/**
+ * @brief Send data through the echo server one chunk at a time, and print the
+ * throughput of the data received back.
+ */
+    static void prvBenchSocket( void );
+#endif
+
+/**
+ * @brief Print the rate per second of an amount of work done in a number of ticks.
+ */
+static void prvPrintRate( const char * pcName,
+                          uint32_t ulAmount,
+                          TickType_t xTicks );
+
+/*-----------------------------------------------------------*/
+
+static void prvPrintRate( const char * pcName,
+                          uint32_t ulAmount,
+                          TickType_t xTicks )
+{
+    uint32_t ulMilliseconds = ( uint32_t ) ( xTicks * portTICK_PERIOD_MS );
+
+    if( ulMilliseconds == 0U )
+    {
+        ulMilliseconds = 1U;
+    }
+
+    LogInfo( ( "BENCH %s %lu", pcName,
+               ( unsigned long ) ( ( ( uint64_t ) ulAmount * 1000U ) / ulMilliseconds ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBenchATCommands( void )
+{
+    CellularError_t xStatus = CELLULAR_SUCCESS;
+    TickType_t xStart;
+    TickType_t xTicks;
+    uint32_t ulCommands = 0U;
+
+    xStart = xTaskGetTickCount();
+
+    for( ulCommands = 0U; ulCommands < democonfigCELLULAR_BENCH_AT_COMMANDS; ulCommands++ )
+    {
+        xStatus = Cellular_ATCommandRaw( CellularHandle, NULL, "AT", CELLULAR_AT_NO_RESULT, NULL, NULL, 0U );
+
+        if( xStatus != CELLULAR_SUCCESS )
+        {
+            LogError( ( "AT command %lu failed %d", ( unsigned long ) ulCommands, xStatus ) );
+            break;
+        }
+    }
+
+    xTicks = xTaskGetTickCount() - xStart;
+
+    prvPrintRate( "at_commands_per_sec", ulCommands, xTicks );
+
+    if( ulCommands > 0U )
+    {
+        LogInfo( ( "BENCH at_command_us %lu",
+                   ( unsigned long ) ( ( ( uint64_t ) xTicks * portTICK_PERIOD_MS * 1000U ) / ulCommands ) ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if defined( democonfigCELLULAR_BENCH_ECHO_SERVER ) && defined( democonfigCELLULAR_BENCH_ECHO_PORT )
+
+    static void prvBenchSocket( void )
+    {
+        static uint8_t ucSendBuffer[ democonfigCELLULAR_BENCH_SOCKET_CHUNK_SIZE ];
+        static uint8_t ucReceiveBuffer[ democonfigCELLULAR_BENCH_SOCKET_CHUNK_SIZE ];
+        Socket_t xSocket = NULL;
+        TickType_t xStart;
+        TickType_t xTicks;
+        uint32_t ulEchoed = 0U;
+        uint32_t ulReceived = 0U;
+        int32_t lResult = 0;
+        BaseType_t xMismatch = pdFALSE;
+        TCPSocketsSendStats_t xSendStats = { 0 };
+        size_t i;
+
+        for( i = 0; i < sizeof( ucSendBuffer ); i++ )
+        {
+            ucSendBuffer[ i ] = ( uint8_t ) i;
+        }
+
+        if( TCP_Sockets_Connect( &xSocket,
+                                 democonfigCELLULAR_BENCH_ECHO_SERVER,
+                                 democonfigCELLULAR_BENCH_ECHO_PORT,
+                                 democonfigCELLULAR_BENCH_SOCKET_TIMEOUT_MS,
+                                 democonfigCELLULAR_BENCH_SOCKET_TIMEOUT_MS ) != 0 )
+        {
+            LogError( ( "Failed to connect to the echo server %s:%d.",
+                        democonfigCELLULAR_BENCH_ECHO_SERVER, democonfigCELLULAR_BENCH_ECHO_PORT ) );
+        }
+        else
+        {
+            xStart = xTaskGetTickCount();
+
+            while( ( ulEchoed < democonfigCELLULAR_BENCH_SOCKET_BYTES ) && ( xMismatch == pdFALSE ) )
+            {
+                lResult = TCP_Sockets_Send( xSocket, ucSendBuffer, sizeof( ucSendBuffer ) );
+
+                if( lResult != ( int32_t ) sizeof( ucSendBuffer ) )
+                {
+                    LogError( ( "Echo send failed %ld", ( long ) lResult ) );
+                    break;
+                }
+
+                /* Wait for the whole chunk to come back before sending the next. */
+                for( ulReceived = 0U; ulReceived < sizeof( ucReceiveBuffer ); ulReceived += ( uint32_t ) lResult )
+                {
+                    lResult = TCP_Sockets_Recv( xSocket,
+                                                &ucReceiveBuffer[ ulReceived ],
+                                                sizeof( ucReceiveBuffer ) - ulReceived );
+
+                    if( lResult <= 0 )
+                    {
+                        LogError( ( "Echo receive failed %ld", ( long ) lResult ) );
+                        break;
+                    }
+                }
+
+                if( ulReceived < sizeof( ucReceiveBuffer ) )
+                {
+                    break;
+                }
+
+                if( memcmp( ucSendBuffer, ucReceiveBuffer, sizeof( ucSendBuffer ) ) != 0 )
+                {
+                    LogError( ( "Echo data mismatch at byte %lu", ( unsigned long ) ulEchoed ) );
+                    xMismatch = pdTRUE;
+                }
+                else
+                {
+                    ulEchoed += sizeof( ucSendBuffer );
+                }
+            }
+
+            xTicks = xTaskGetTickCount() - xStart;
+
+            if( TCP_Sockets_GetSendStats( xSocket, &xSendStats ) == TCP_SOCKETS_ERRNO_NONE )
+            {
+                LogInfo( ( "BENCH socket_send_commands %lu", ( unsigned long ) xSendStats.sendCount ) );
+                LogInfo( ( "BENCH socket_send_credit_waits %lu", ( unsigned long ) xSendStats.creditWaits ) );
+                LogInfo( ( "BENCH socket_send_max_outstanding %lu", ( unsigned long ) xSendStats.maxOutstanding ) );
+                LogInfo( ( "BENCH socket_send_bytes_per_sec %lu", ( unsigned long ) xSendStats.bytesPerSecond ) );
+            }
+
+            TCP_Sockets_Disconnect( xSocket );
+
+            LogInfo( ( "BENCH socket_bytes_echoed %lu", ( unsigned long ) ulEchoed ) );
+            prvPrintRate( "socket_bytes_per_sec", ulEchoed, xTicks );
+        }
+    }
+
+#endif /* if defined( democonfigCELLULAR_BENCH_ECHO_SERVER ) && defined( democonfigCELLULAR_BENCH_ECHO_PORT ) */
+
+/*-----------------------------------------------------------*/
+
+void vRunCellularBench( void )
+{
+    #if ( CELLULAR_COMM_IF_USE_RING_BUFFER == 1 )
+        CellularCommIntfStats_t xStats = { 0 };
+    #endif
+
+    LogInfo( ( "BENCH comm_if %s",
+               ( CELLULAR_COMM_IF_USE_RING_BUFFER == 1 ) ? "ring_buffer" : "windows" ) );
+
+    prvBenchATCommands();
+
+    #if defined( democonfigCELLULAR_BENCH_ECHO_SERVER ) && defined( democonfigCELLULAR_BENCH_ECHO_PORT )
+        prvBenchSocket();
+    #else
+        LogInfo( ( "Define democonfigCELLULAR_BENCH_ECHO_SERVER and democonfigCELLULAR_BENCH_ECHO_PORT to measure socket throughput." ) );
+    #endif
+
+    #if ( CELLULAR_COMM_IF_USE_RING_BUFFER == 1 )
+        CellularCommIntf_GetStats( &xStats );
+        LogInfo( ( "BENCH comm_bytes_received %lu", ( unsigned long ) xStats.bytesReceived ) );
+        LogInfo( ( "BENCH comm_receive_bursts %lu", ( unsigned long ) xStats.receiveBursts ) );
+        LogInfo( ( "BENCH comm_buffer_full_waits %lu", ( unsigned long ) xStats.bufferFullWaits ) );
+        LogInfo( ( "BENCH comm_max_buffer_level %lu", ( unsigned long ) xStats.maxBufferLevel ) );
+    #endif
+
+    LogInfo( ( "BENCH done" ) );
+}
+
+/*-----------------------------------------------------------*/
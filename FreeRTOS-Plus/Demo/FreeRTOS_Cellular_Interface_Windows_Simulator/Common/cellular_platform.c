@@ -25,6 +25,7 @@
  */
 
 #include <stdbool.h>
+#include <string.h>
 
 #include "cellular_platform.h"
 
@@ -40,6 +41,37 @@ typedef struct threadInfo
 
 /*-----------------------------------------------------------*/
 
+#if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 )
+
+/* Atomic operations on the lock state and the counters. Both are full
+ * barriers, so the data guarded by a mutex is not accessed outside it. */
+    #if defined( _MSC_VER )
+        #include <intrin.h>
+        #define MUTEX_STATE_CAS( pState, expected, desired ) \
+    ( _InterlockedCompareExchange( ( volatile long * ) ( pState ), ( long ) ( desired ), ( long ) ( expected ) ) == ( long ) ( expected ) )
+        #define MUTEX_STATE_EXCHANGE( pState, value ) \
+    ( ( uint32_t ) _InterlockedExchange( ( volatile long * ) ( pState ), ( long ) ( value ) ) )
+        #define MUTEX_STATS_INCREMENT( pCounter ) \
+    ( ( void ) _InterlockedIncrement( ( volatile long * ) ( pCounter ) ) )
+    #else
+        #define MUTEX_STATE_CAS( pState, expected, desired ) \
+    __sync_bool_compare_and_swap( ( pState ), ( expected ), ( desired ) )
+        #define MUTEX_STATE_EXCHANGE( pState, value ) \
+    __atomic_exchange_n( ( pState ), ( value ), __ATOMIC_SEQ_CST )
+        #define MUTEX_STATS_INCREMENT( pCounter ) \
+    ( ( void ) __atomic_fetch_add( ( pCounter ), 1U, __ATOMIC_RELAXED ) )
+    #endif
+
+    #define MUTEX_UNLOCKED     ( 0U ) /* No owner. */
+    #define MUTEX_LOCKED       ( 1U ) /* Owned, and nobody waits. */
+    #define MUTEX_CONTENDED    ( 2U ) /* Owned, and a task may wait on the semaphore. */
+
+/* Lock counters of all the mutexes. */
+    static PlatformMutexStats_t mutexStats = { 0 };
+#endif /* if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 ) */
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Sends provided buffer to network using transport send.
  *
@@ -74,27 +106,103 @@ static void prvThreadRoutineWrapper( void * pArgument )
 
 /*-----------------------------------------------------------*/
 
-static bool prIotMutexTimedLock( PlatformMutex_t * pMutex,
-                                 TickType_t timeout )
-{
-    BaseType_t lockResult = pdTRUE;
+#if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 )
 
-    configASSERT( pMutex != NULL );
+    static bool prIotMutexTimedLock( PlatformMutex_t * pMutex,
+                                     TickType_t timeout )
+    {
+        bool isLocked = false;
+        TaskHandle_t currentTask = NULL;
+        TimeOut_t lockTimeOut = { 0 };
 
-    LogDebug( ( "Locking mutex %p.", pMutex ) );
+        configASSERT( pMutex != NULL );
 
-    /* Call the correct FreeRTOS mutex take function based on mutex type. */
-    if( pMutex->recursive == pdTRUE )
-    {
-        lockResult = xSemaphoreTakeRecursive( ( SemaphoreHandle_t ) &pMutex->xMutex, timeout );
+        LogDebug( ( "Locking mutex %p.", pMutex ) );
+
+        currentTask = xTaskGetCurrentTaskHandle();
+
+        if( ( pMutex->recursive == pdTRUE ) && ( pMutex->owner == currentTask ) )
+        {
+            /* Only the owner sets the owner, so this is not racing. */
+            pMutex->lockCount++;
+            isLocked = true;
+        }
+        else if( MUTEX_STATE_CAS( &pMutex->lockState, MUTEX_UNLOCKED, MUTEX_LOCKED ) )
+        {
+            isLocked = true;
+        }
+        else
+        {
+            MUTEX_STATS_INCREMENT( &mutexStats.contendedLocks );
+            vTaskSetTimeOutState( &lockTimeOut );
+
+            /* Marking the mutex contended makes the owner give the semaphore
+             * when it unlocks. A try lock does not mark it, as it would not
+             * take the semaphore. */
+            while( ( isLocked == false ) && ( timeout != 0U ) )
+            {
+                if( MUTEX_STATE_EXCHANGE( &pMutex->lockState, MUTEX_CONTENDED ) == MUTEX_UNLOCKED )
+                {
+                    isLocked = true;
+                }
+                else if( xTaskCheckForTimeOut( &lockTimeOut, &timeout ) == pdFALSE )
+                {
+                    /* The semaphore may hold a wakeup meant for a task which
+                     * took the mutex meanwhile, so check again after waking. */
+                    MUTEX_STATS_INCREMENT( &mutexStats.blockedWaits );
+                    ( void ) xSemaphoreTake( ( SemaphoreHandle_t ) &pMutex->xMutex, timeout );
+                }
+                else
+                {
+                    timeout = 0U;
+                }
+            }
+
+            if( isLocked == false )
+            {
+                MUTEX_STATS_INCREMENT( &mutexStats.lockTimeouts );
+            }
+        }
+
+        if( ( isLocked == true ) && ( pMutex->recursive == pdTRUE ) && ( pMutex->owner != currentTask ) )
+        {
+            pMutex->owner = currentTask;
+            pMutex->lockCount = 1U;
+        }
+
+        if( isLocked == true )
+        {
+            MUTEX_STATS_INCREMENT( &mutexStats.locks );
+        }
+
+        return isLocked;
     }
-    else
+
+#else /* if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 ) */
+
+    static bool prIotMutexTimedLock( PlatformMutex_t * pMutex,
+                                     TickType_t timeout )
     {
-        lockResult = xSemaphoreTake( ( SemaphoreHandle_t ) &pMutex->xMutex, timeout );
+        BaseType_t lockResult = pdTRUE;
+
+        configASSERT( pMutex != NULL );
+
+        LogDebug( ( "Locking mutex %p.", pMutex ) );
+
+        /* Call the correct FreeRTOS mutex take function based on mutex type. */
+        if( pMutex->recursive == pdTRUE )
+        {
+            lockResult = xSemaphoreTakeRecursive( ( SemaphoreHandle_t ) &pMutex->xMutex, timeout );
+        }
+        else
+        {
+            lockResult = xSemaphoreTake( ( SemaphoreHandle_t ) &pMutex->xMutex, timeout );
+        }
+
+        return( lockResult == pdTRUE );
     }
 
-    return( lockResult == pdTRUE );
-}
+#endif /* if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 ) */
 
 /*-----------------------------------------------------------*/
 
@@ -157,14 +265,23 @@ bool PlatformMutex_Create( PlatformMutex_t * pNewMutex,
 
     LogDebug( ( "Creating new mutex %p.", pNewMutex ) );
 
-    if( recursive == true )
-    {
-        xSemaphore = xSemaphoreCreateRecursiveMutexStatic( &pNewMutex->xMutex );
-    }
-    else
-    {
-        xSemaphore = xSemaphoreCreateMutexStatic( &pNewMutex->xMutex );
-    }
+    #if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 )
+        /* The semaphore only wakes the tasks waiting for the mutex, for both
+         * mutex types. */
+        xSemaphore = xSemaphoreCreateBinaryStatic( &pNewMutex->xMutex );
+        pNewMutex->lockState = MUTEX_UNLOCKED;
+        pNewMutex->owner = NULL;
+        pNewMutex->lockCount = 0U;
+    #else
+        if( recursive == true )
+        {
+            xSemaphore = xSemaphoreCreateRecursiveMutexStatic( &pNewMutex->xMutex );
+        }
+        else
+        {
+            xSemaphore = xSemaphoreCreateMutexStatic( &pNewMutex->xMutex );
+        }
+    #endif /* if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 ) */
 
     /* Remember the type of mutex. */
     if( recursive == true )
@@ -216,19 +333,60 @@ bool PlatformMutex_TryLock( PlatformMutex_t * pMutex )
 
 void PlatformMutex_Unlock( PlatformMutex_t * pMutex )
 {
+    #if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 )
+        bool isUnlocked = true;
+    #endif
+
     configASSERT( pMutex != NULL );
 
     LogDebug( ( "Unlocking mutex %p.", pMutex ) );
 
-    /* Call the correct FreeRTOS mutex unlock function based on mutex type. */
-    if( pMutex->recursive == pdTRUE )
-    {
-        ( void ) xSemaphoreGiveRecursive( ( SemaphoreHandle_t ) &pMutex->xMutex );
-    }
-    else
-    {
-        ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &pMutex->xMutex );
-    }
+    #if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 )
+        if( pMutex->recursive == pdTRUE )
+        {
+            configASSERT( pMutex->owner == xTaskGetCurrentTaskHandle() );
+            pMutex->lockCount--;
+
+            if( pMutex->lockCount > 0U )
+            {
+                isUnlocked = false;
+            }
+            else
+            {
+                pMutex->owner = NULL;
+            }
+        }
+
+        /* Wake a waiting task, which takes the mutex or waits again. */
+        if( ( isUnlocked == true ) &&
+            ( MUTEX_STATE_EXCHANGE( &pMutex->lockState, MUTEX_UNLOCKED ) == MUTEX_CONTENDED ) )
+        {
+            ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &pMutex->xMutex );
+        }
+    #else /* if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 ) */
+        /* Call the correct FreeRTOS mutex unlock function based on mutex type. */
+        if( pMutex->recursive == pdTRUE )
+        {
+            ( void ) xSemaphoreGiveRecursive( ( SemaphoreHandle_t ) &pMutex->xMutex );
+        }
+        else
+        {
+            ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &pMutex->xMutex );
+        }
+    #endif /* if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 ) */
+}
+
+/*-----------------------------------------------------------*/
+
+void PlatformMutex_GetStats( PlatformMutexStats_t * pStats )
+{
+    configASSERT( pStats != NULL );
+
+    #if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 )
+        *pStats = mutexStats;
+    #else
+        ( void ) memset( pStats, 0, sizeof( PlatformMutexStats_t ) );
+    #endif
 }
 
 /*-----------------------------------------------------------*/
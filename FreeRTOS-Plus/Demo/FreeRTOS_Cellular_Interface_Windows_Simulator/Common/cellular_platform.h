@@ -28,6 +28,7 @@
 #define __CELLULAR_PLATFORM_H__
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "queue.h"
 #include "semphr.h"
 #include "event_groups.h"
@@ -102,14 +103,41 @@ bool Platform_CreateDetachedThread( void ( * threadRoutine )( void * ),
  * PlatfromMutex_ prefix function in the following link.
  * https://docs.aws.amazon.com/freertos/latest/lib-ref/c-sdk/platform/platform_threads_functions.html
  *
+ * When CELLULAR_PLATFORM_FAST_MUTEX is set to 1, for example in FreeRTOSConfig.h,
+ * an unowned mutex is taken and given with a single atomic exchange, and the
+ * FreeRTOS semaphore is only used to block tasks that find the mutex owned.
+ * Most of the cellular library locks are uncontended, so this saves a kernel
+ * call for each of them. Unlike a FreeRTOS mutex, it does not raise the
+ * priority of the owner while a higher priority task waits.
+ *
  */
 
+#ifndef CELLULAR_PLATFORM_FAST_MUTEX
+    #define CELLULAR_PLATFORM_FAST_MUTEX    ( 0 )
+#endif
+
 typedef struct PlatformMutex
 {
-    StaticSemaphore_t xMutex; /**< FreeRTOS mutex. */
+    StaticSemaphore_t xMutex; /**< FreeRTOS mutex, or the semaphore waited on with CELLULAR_PLATFORM_FAST_MUTEX. */
     BaseType_t recursive;     /**< Type; used for indicating if this is reentrant or normal. */
+    #if ( CELLULAR_PLATFORM_FAST_MUTEX == 1 )
+        volatile uint32_t lockState; /**< 0 unlocked, 1 locked, 2 locked and maybe waited for. */
+        TaskHandle_t owner;          /**< Task holding a recursive mutex. */
+        UBaseType_t lockCount;       /**< Times the owner has locked a recursive mutex. */
+    #endif
 } PlatformMutex_t;
 
+/**
+ * @brief Lock counters of all the platform mutexes, see PlatformMutex_GetStats().
+ */
+typedef struct PlatformMutexStats
+{
+    uint32_t locks;          /**< Locks taken, including by PlatformMutex_TryLock(). */
+    uint32_t contendedLocks; /**< Locks that found the mutex owned by another task. */
+    uint32_t blockedWaits;   /**< Times a task blocked on the semaphore waiting for a mutex. */
+    uint32_t lockTimeouts;   /**< Locks that failed because the mutex stayed owned. */
+} PlatformMutexStats_t;
+
 bool PlatformMutex_Create( PlatformMutex_t * pNewMutex,
                            bool recursive );
 void PlatformMutex_Destroy( PlatformMutex_t * pMutex );
@@ -117,6 +145,10 @@ void PlatformMutex_Lock( PlatformMutex_t * pMutex );
 bool PlatformMutex_TryLock( PlatformMutex_t * pMutex );
 void PlatformMutex_Unlock( PlatformMutex_t * pMutex );
 
+/* The counters are only kept with CELLULAR_PLATFORM_FAST_MUTEX, and are all
+ * zero otherwise. */
+void PlatformMutex_GetStats( PlatformMutexStats_t * pStats );
+
 /*-----------------------------------------------------------*/
 
 /**
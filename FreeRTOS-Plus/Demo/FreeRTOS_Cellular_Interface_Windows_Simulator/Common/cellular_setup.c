@@ -36,6 +36,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 /* Demo Specific configs. */
 #include "demo_config.h"
@@ -79,23 +80,131 @@ uint8_t CellularSocketPdnContextId = CELLULAR_PDN_CONTEXT_ID;
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Wait until the module is registered to the packet switched network.
+ *
+ * @return CELLULAR_SUCCESS once registered, CELLULAR_TIMEOUT if not registered
+ * within CELLULAR_PDN_CONNECT_TIMEOUT, or the error of the last status query.
+ */
+static CellularError_t prvWaitForRegistration( void );
+
+/**
+ * @brief Check that the PDN context of the sockets is active.
+ *
+ * @param[out] pLocalIP Set to the IP address of the context, or NULL.
+ * @param[in] localIPLength Size of pLocalIP.
+ *
+ * @return true if the context is active.
+ */
+static bool prvIsPdnActive( char * pLocalIP,
+                            uint32_t localIPLength );
+
+/*-----------------------------------------------------------*/
+
+static CellularError_t prvWaitForRegistration( void )
+{
+    CellularError_t cellularStatus = CELLULAR_SUCCESS;
+    CellularServiceStatus_t serviceStatus = { 0 };
+    uint32_t timeoutCountLimit = ( CELLULAR_PDN_CONNECT_TIMEOUT / CELLULAR_PDN_CONNECT_WAIT_INTERVAL_MS ) + 1U;
+    uint32_t timeoutCount = 0;
+
+    while( timeoutCount < timeoutCountLimit )
+    {
+        cellularStatus = Cellular_GetServiceStatus( CellularHandle, &serviceStatus );
+
+        if( ( cellularStatus == CELLULAR_SUCCESS ) &&
+            ( ( serviceStatus.psRegistrationStatus == REGISTRATION_STATUS_REGISTERED_HOME ) ||
+              ( serviceStatus.psRegistrationStatus == REGISTRATION_STATUS_ROAMING_REGISTERED ) ) )
+        {
+            configPRINTF( ( ">>>  Cellular module registered  <<<\r\n" ) );
+            break;
+        }
+        else
+        {
+            configPRINTF( ( ">>>  Cellular GetServiceStatus failed %d, ps registration status %d  <<<\r\n",
+                            cellularStatus, serviceStatus.psRegistrationStatus ) );
+        }
+
+        timeoutCount++;
+
+        if( timeoutCount >= timeoutCountLimit )
+        {
+            /* Return timeout to indicate network is not registered within
+             * CELLULAR_PDN_CONNECT_TIMEOUT. */
+            cellularStatus = CELLULAR_TIMEOUT;
+            configPRINTF( ( ">>>  Cellular module can't be registered within CELLULAR_PDN_CONNECT_TIMEOUT <<<\r\n" ) );
+        }
+
+        vTaskDelay( pdMS_TO_TICKS( CELLULAR_PDN_CONNECT_WAIT_INTERVAL_MS ) );
+    }
+
+    return cellularStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool prvIsPdnActive( char * pLocalIP,
+                            uint32_t localIPLength )
+{
+    CellularError_t cellularStatus = CELLULAR_SUCCESS;
+    CellularPdnStatus_t PdnStatusBuffers[ CELLULAR_PDN_CONTEXT_NUM ] = { 0 };
+    uint8_t NumStatus = 0;
+    bool pdnStatus = false;
+    uint32_t i = 0U;
+
+    if( pLocalIP != NULL )
+    {
+        cellularStatus = Cellular_GetIPAddress( CellularHandle, CellularSocketPdnContextId, pLocalIP, localIPLength );
+
+        if( cellularStatus != CELLULAR_SUCCESS )
+        {
+            configPRINTF( ( ">>>  Cellular_GetIPAddress failure %d  <<<\r\n", cellularStatus ) );
+        }
+    }
+
+    if( cellularStatus == CELLULAR_SUCCESS )
+    {
+        cellularStatus = Cellular_GetPdnStatus( CellularHandle, PdnStatusBuffers, CELLULAR_PDN_CONTEXT_NUM, &NumStatus );
+
+        if( cellularStatus != CELLULAR_SUCCESS )
+        {
+            configPRINTF( ( ">>>  Cellular_GetPdnStatus failure %d  <<<\r\n", cellularStatus ) );
+        }
+    }
+
+    if( cellularStatus == CELLULAR_SUCCESS )
+    {
+        for( i = 0U; i < NumStatus; i++ )
+        {
+            if( ( PdnStatusBuffers[ i ].contextId == CellularSocketPdnContextId ) && ( PdnStatusBuffers[ i ].state == 1 ) )
+            {
+                pdnStatus = true;
+                break;
+            }
+        }
+
+        if( pdnStatus == false )
+        {
+            configPRINTF( ( ">>>  Cellular PDN is not activated <<<\r\n" ) );
+        }
+    }
+
+    return pdnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
 bool setupCellular( void )
 {
     bool cellularRet = true;
     CellularError_t cellularStatus = CELLULAR_SUCCESS;
     CellularSimCardStatus_t simStatus = { 0 };
-    CellularServiceStatus_t serviceStatus = { 0 };
     CellularCommInterface_t * pCommIntf = &CellularCommInterface;
     uint8_t tries = 0;
     CellularPdnConfig_t pdnConfig = { CELLULAR_PDN_CONTEXT_IPV4, CELLULAR_PDN_AUTH_NONE, CELLULAR_APN, "", "" };
-    CellularPdnStatus_t PdnStatusBuffers[ CELLULAR_PDN_CONTEXT_NUM ] = { 0 };
     char localIP[ CELLULAR_IP_ADDRESS_MAX_SIZE ] = { '\0' };
-    uint32_t timeoutCountLimit = ( CELLULAR_PDN_CONNECT_TIMEOUT / CELLULAR_PDN_CONNECT_WAIT_INTERVAL_MS ) + 1U;
-    uint32_t timeoutCount = 0;
-    uint8_t NumStatus = 0;
     CellularPsmSettings_t psmSettings = { 0 };
     bool pdnStatus = false;
-    uint32_t i = 0U;
 
     /* Initialize Cellular Comm Interface. */
     cellularStatus = Cellular_Init( &CellularHandle, pCommIntf );
@@ -181,35 +290,7 @@ bool setupCellular( void )
     /* Get service status. */
     if( cellularStatus == CELLULAR_SUCCESS )
     {
-        while( timeoutCount < timeoutCountLimit )
-        {
-            cellularStatus = Cellular_GetServiceStatus( CellularHandle, &serviceStatus );
-
-            if( ( cellularStatus == CELLULAR_SUCCESS ) &&
-                ( ( serviceStatus.psRegistrationStatus == REGISTRATION_STATUS_REGISTERED_HOME ) ||
-                  ( serviceStatus.psRegistrationStatus == REGISTRATION_STATUS_ROAMING_REGISTERED ) ) )
-            {
-                configPRINTF( ( ">>>  Cellular module registered  <<<\r\n" ) );
-                break;
-            }
-            else
-            {
-                configPRINTF( ( ">>>  Cellular GetServiceStatus failed %d, ps registration status %d  <<<\r\n",
-                                cellularStatus, serviceStatus.psRegistrationStatus ) );
-            }
-
-            timeoutCount++;
-
-            if( timeoutCount >= timeoutCountLimit )
-            {
-                /* Return timeout to indicate network is not registered within
-                 * CELLULAR_PDN_CONNECT_TIMEOUT. */
-                cellularStatus = CELLULAR_TIMEOUT;
-                configPRINTF( ( ">>>  Cellular module can't be registered within CELLULAR_PDN_CONNECT_TIMEOUT <<<\r\n" ) );
-            }
-
-            vTaskDelay( pdMS_TO_TICKS( CELLULAR_PDN_CONNECT_WAIT_INTERVAL_MS ) );
-        }
+        cellularStatus = prvWaitForRegistration();
     }
 
     if( cellularStatus == CELLULAR_SUCCESS )
@@ -224,52 +305,84 @@ bool setupCellular( void )
 
     if( cellularStatus == CELLULAR_SUCCESS )
     {
-        cellularStatus = Cellular_GetIPAddress( CellularHandle, CellularSocketPdnContextId, localIP, sizeof( localIP ) );
-
-        if( cellularStatus != CELLULAR_SUCCESS )
-        {
-            configPRINTF( ( ">>>  Cellular_GetIPAddress failure %d  <<<\r\n", cellularStatus ) );
-        }
+        pdnStatus = prvIsPdnActive( localIP, sizeof( localIP ) );
     }
 
-    if( cellularStatus == CELLULAR_SUCCESS )
+    if( ( cellularStatus == CELLULAR_SUCCESS ) && ( pdnStatus == true ) )
     {
-        cellularStatus = Cellular_GetPdnStatus( CellularHandle, PdnStatusBuffers, CELLULAR_PDN_CONTEXT_NUM, &NumStatus );
-
-        if( cellularStatus != CELLULAR_SUCCESS )
-        {
-            configPRINTF( ( ">>>  Cellular_GetPdnStatus failure %d  <<<\r\n", cellularStatus ) );
-        }
+        configPRINTF( ( ">>>  Cellular module registered, IP address %s  <<<\r\n", localIP ) );
+        cellularRet = true;
+    }
+    else
+    {
+        cellularRet = false;
     }
 
-    if( cellularStatus == CELLULAR_SUCCESS )
+    return cellularRet;
+}
+
+/*-----------------------------------------------------------*/
+
+bool recoverCellular( void )
+{
+    CellularError_t cellularStatus = CELLULAR_SUCCESS;
+    bool pdnStatus = false;
+
+    /* The modem keeps the registration and the PDN configuration through a
+     * short outage, and often the PDN context itself, so check before redoing
+     * any of the work of setupCellular(). */
+    pdnStatus = prvIsPdnActive( NULL, 0U );
+
+    if( pdnStatus == false )
     {
-        for( i = 0U; i < NumStatus; i++ )
+        cellularStatus = prvWaitForRegistration();
+
+        if( cellularStatus == CELLULAR_SUCCESS )
         {
-            if( ( PdnStatusBuffers[ i ].contextId == CellularSocketPdnContextId ) && ( PdnStatusBuffers[ i ].state == 1 ) )
+            cellularStatus = Cellular_ActivatePdn( CellularHandle, CellularSocketPdnContextId );
+
+            if( cellularStatus != CELLULAR_SUCCESS )
             {
-                pdnStatus = true;
-                break;
+                configPRINTF( ( ">>>  Cellular_ActivatePdn failure %d  <<<\r\n", cellularStatus ) );
             }
         }
 
-        if( pdnStatus == false )
+        if( cellularStatus == CELLULAR_SUCCESS )
         {
-            configPRINTF( ( ">>>  Cellular PDN is not activated <<<\r\n" ) );
+            pdnStatus = prvIsPdnActive( NULL, 0U );
         }
     }
 
-    if( ( cellularStatus == CELLULAR_SUCCESS ) && ( pdnStatus == true ) )
+    return pdnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+bool resolveHostCellular( const char * pHostName,
+                          char * pAddress,
+                          size_t addressLength )
+{
+    CellularError_t cellularStatus = CELLULAR_SUCCESS;
+    char resolvedAddress[ CELLULAR_IP_ADDRESS_MAX_SIZE + 1U ] = { '\0' };
+    bool resolveRet = false;
+
+    cellularStatus = Cellular_GetHostByName( CellularHandle, CellularSocketPdnContextId, pHostName, resolvedAddress );
+
+    if( cellularStatus != CELLULAR_SUCCESS )
     {
-        configPRINTF( ( ">>>  Cellular module registered, IP address %s  <<<\r\n", localIP ) );
-        cellularRet = true;
+        configPRINTF( ( ">>>  Cellular_GetHostByName %s failure %d  <<<\r\n", pHostName, cellularStatus ) );
+    }
+    else if( strlen( resolvedAddress ) >= addressLength )
+    {
+        configPRINTF( ( ">>>  Cellular address of %s too long  <<<\r\n", pHostName ) );
     }
     else
     {
-        cellularRet = false;
+        ( void ) strcpy( pAddress, resolvedAddress );
+        resolveRet = true;
     }
 
-    return cellularRet;
+    return resolveRet;
 }
 
 /*-----------------------------------------------------------*/
@@ -0,0 +1,139 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/**
+ * @file comm_if_ring_buffer.h
+ * @brief Ring buffer receive API of the reference cellular comm interface.
+ *
+ * The reference comm interface in comm_if_windows_ring_buffer.c receives the
+ * data of the cellular module into a circular buffer, the way a UART with a
+ * DMA channel in circular mode does. The receive callback of the cellular
+ * library is called once per burst of data, when the line goes idle or the
+ * buffer half it is written into is full, instead of once per chunk read by
+ * the driver. The data can be read from the buffer in place with
+ * CellularCommIntf_ReceiveZeroCopy().
+ *
+ * The reference comm interface is used instead of comm_if_windows.c when
+ * CELLULAR_COMM_IF_USE_RING_BUFFER is set to 1 in cellular_config.h.
+ */
+
+#ifndef __COMM_IF_RING_BUFFER_H__
+#define __COMM_IF_RING_BUFFER_H__
+
+#include <stdint.h>
+
+#include "cellular_comm_interface.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Set to 1 to use the ring buffer comm interface.
+ */
+#ifndef CELLULAR_COMM_IF_USE_RING_BUFFER
+    #define CELLULAR_COMM_IF_USE_RING_BUFFER    ( 0 )
+#endif
+
+/**
+ * @brief The size of the receive ring buffer in bytes. It must be a power of 2.
+ */
+#ifndef CELLULAR_COMM_IF_RING_BUFFER_SIZE
+    #define CELLULAR_COMM_IF_RING_BUFFER_SIZE    ( 8192U )
+#endif
+
+/**
+ * @brief The time without received data, in milliseconds, after which the line
+ * is considered idle and the received data is passed on.
+ */
+#ifndef CELLULAR_COMM_IF_IDLE_LINE_TIMEOUT_MS
+    #define CELLULAR_COMM_IF_IDLE_LINE_TIMEOUT_MS    ( 2U )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Counters of the ring buffer comm interface.
+ */
+typedef struct CellularCommIntfStats
+{
+    uint32_t bytesReceived;   /* Bytes written into the ring buffer. */
+    uint32_t receiveBursts;   /* Receive callbacks, one per idle line or full buffer half. */
+    uint32_t bufferFullWaits; /* Times the receiver waited for the buffer to be read. */
+    uint32_t maxBufferLevel;  /* The most bytes held in the ring buffer at once. */
+} CellularCommIntfStats_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Receive data from the comm interface without copying it.
+ *
+ * Waits like the recv function of the comm interface for data, and then points
+ * @p ppData at the received data in the ring buffer. The data stays in the ring
+ * buffer, and is returned again by the next receive, until it is released with
+ * CellularCommIntf_ReceiveRelease(). Only data stored contiguously is returned,
+ * so fewer bytes than are available may be returned when the data wraps around
+ * the end of the ring buffer.
+ *
+ * @param[in] commInterfaceHandle The handle returned by the open function.
+ * @param[out] ppData Set to point at the received data.
+ * @param[in] maxLength The maximum number of bytes to return.
+ * @param[in] timeoutMilliseconds The time to wait for data.
+ * @param[out] pDataReceivedLength The number of bytes at @p ppData.
+ *
+ * @return IOT_COMM_INTERFACE_SUCCESS if the receive was successful, with
+ * @p pDataReceivedLength set to 0 if no data was received in time. Otherwise an
+ * error code defined in CellularCommInterfaceError_t.
+ */
+CellularCommInterfaceError_t CellularCommIntf_ReceiveZeroCopy( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                               const uint8_t ** ppData,
+                                                               uint32_t maxLength,
+                                                               uint32_t timeoutMilliseconds,
+                                                               uint32_t * pDataReceivedLength );
+
+/**
+ * @brief Release data returned by CellularCommIntf_ReceiveZeroCopy(), so that
+ * its space in the ring buffer can be used for new data.
+ *
+ * @param[in] commInterfaceHandle The handle returned by the open function.
+ * @param[in] length The number of bytes to release, at most the number returned
+ * by CellularCommIntf_ReceiveZeroCopy().
+ *
+ * @return IOT_COMM_INTERFACE_SUCCESS if the data is released. Otherwise an error
+ * code defined in CellularCommInterfaceError_t.
+ */
+CellularCommInterfaceError_t CellularCommIntf_ReceiveRelease( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                              uint32_t length );
+
+/**
+ * @brief Get the counters of the ring buffer comm interface.
+ *
+ * @param[out] pStats Filled in with the counters since the comm interface was opened.
+ */
+void CellularCommIntf_GetStats( CellularCommIntfStats_t * pStats );
+
+/*-----------------------------------------------------------*/
+
+#endif /* __COMM_IF_RING_BUFFER_H__ */
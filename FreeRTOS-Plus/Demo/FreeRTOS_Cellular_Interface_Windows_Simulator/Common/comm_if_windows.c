@@ -41,75 +41,80 @@
 #include "cellular_config.h"
 #include "cellular_config_defaults.h"
 #include "cellular_comm_interface.h"
+#include "comm_if_ring_buffer.h"
+
+/* The ring buffer comm interface in comm_if_windows_ring_buffer.c is used instead
+ * when CELLULAR_COMM_IF_USE_RING_BUFFER is set to 1. */
+#if ( CELLULAR_COMM_IF_USE_RING_BUFFER == 0 )
 
 /*-----------------------------------------------------------*/
 
 /* Define the COM port used as comm interface. */
-#ifndef CELLULAR_COMM_INTERFACE_PORT
-    #error "Define CELLULAR_COMM_INTERFACE_PORT in cellular_config.h"
-#endif
-#define CELLULAR_COMM_PATH              "\\\\.\\"CELLULAR_COMM_INTERFACE_PORT
+    #ifndef CELLULAR_COMM_INTERFACE_PORT
+        #error "Define CELLULAR_COMM_INTERFACE_PORT in cellular_config.h"
+    #endif
+    #define CELLULAR_COMM_PATH              "\\\\.\\"CELLULAR_COMM_INTERFACE_PORT
 
 /* Define the simulated UART interrupt number. */
-#define appINTERRUPT_UART               portINTERRUPT_APPLICATION_DEFINED_START
+    #define appINTERRUPT_UART               portINTERRUPT_APPLICATION_DEFINED_START
 
 /* Define the read write buffer size. */
-#define COMM_TX_BUFFER_SIZE             ( 8192 )
-#define COMM_RX_BUFFER_SIZE             ( 8192 )
+    #define COMM_TX_BUFFER_SIZE             ( 8192 )
+    #define COMM_RX_BUFFER_SIZE             ( 8192 )
 
 /* Receive thread timeout in ms. */
-#define COMM_RECV_THREAD_TIMEOUT        ( 5000 )
+    #define COMM_RECV_THREAD_TIMEOUT        ( 5000 )
 
 /* Write operation timeout in ms. */
-#define COMM_WRITE_OPERATION_TIMEOUT    ( 500 )
+    #define COMM_WRITE_OPERATION_TIMEOUT    ( 500 )
 
 /* Comm status. */
-#define CELLULAR_COMM_OPEN_BIT          ( 0x01U )
+    #define CELLULAR_COMM_OPEN_BIT          ( 0x01U )
 
 /*-----------------------------------------------------------*/
 
-typedef struct cellularCommContext
-{
-    CellularCommInterfaceReceiveCallback_t commReceiveCallback;
-    HANDLE commReceiveCallbackThread;
-    uint8_t commStatus;
-    void * pUserData;
-    HANDLE commFileHandle;
-    CellularCommInterface_t * pCommInterface;
-    bool commTaskThreadStarted;
-} cellularCommContext_t;
+    typedef struct cellularCommContext
+    {
+        CellularCommInterfaceReceiveCallback_t commReceiveCallback;
+        HANDLE commReceiveCallbackThread;
+        uint8_t commStatus;
+        void * pUserData;
+        HANDLE commFileHandle;
+        CellularCommInterface_t * pCommInterface;
+        bool commTaskThreadStarted;
+    } cellularCommContext_t;
 
 /*-----------------------------------------------------------*/
 
 /**
  * @brief CellularCommInterfaceOpen_t implementation.
  */
-static CellularCommInterfaceError_t prvCommIntfOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
-                                                     void * pUserData,
-                                                     CellularCommInterfaceHandle_t * pCommInterfaceHandle );
+    static CellularCommInterfaceError_t prvCommIntfOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
+                                                         void * pUserData,
+                                                         CellularCommInterfaceHandle_t * pCommInterfaceHandle );
 
 /**
  * @brief CellularCommInterfaceSend_t implementation.
  */
-static CellularCommInterfaceError_t prvCommIntfSend( CellularCommInterfaceHandle_t commInterfaceHandle,
-                                                     const uint8_t * pData,
-                                                     uint32_t dataLength,
-                                                     uint32_t timeoutMilliseconds,
-                                                     uint32_t * pDataSentLength );
+    static CellularCommInterfaceError_t prvCommIntfSend( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                         const uint8_t * pData,
+                                                         uint32_t dataLength,
+                                                         uint32_t timeoutMilliseconds,
+                                                         uint32_t * pDataSentLength );
 
 /**
  * @brief CellularCommInterfaceRecv_t implementation.
  */
-static CellularCommInterfaceError_t prvCommIntfReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
-                                                        uint8_t * pBuffer,
-                                                        uint32_t bufferLength,
-                                                        uint32_t timeoutMilliseconds,
-                                                        uint32_t * pDataReceivedLength );
+    static CellularCommInterfaceError_t prvCommIntfReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                            uint8_t * pBuffer,
+                                                            uint32_t bufferLength,
+                                                            uint32_t timeoutMilliseconds,
+                                                            uint32_t * pDataReceivedLength );
 
 /**
  * @brief CellularCommInterfaceClose_t implementation.
  */
-static CellularCommInterfaceError_t prvCommIntfClose( CellularCommInterfaceHandle_t commInterfaceHandle );
+    static CellularCommInterfaceError_t prvCommIntfClose( CellularCommInterfaceHandle_t commInterfaceHandle );
 
 /**
  * @brief UART interrupt handler.
@@ -117,7 +122,7 @@ static CellularCommInterfaceError_t prvCommIntfClose( CellularCommInterfaceHandl
  * @return pdTRUE if the operation is successful, otherwise
  * an error code indicating the cause of the error.
  */
-static uint32_t prvProcessUartInt( void );
+    static uint32_t prvProcessUartInt( void );
 
 /**
  * @brief Communication receiver thread function.
@@ -125,7 +130,7 @@ static uint32_t prvProcessUartInt( void );
  * @param[in] pArgument windows COM port handle.
  * @return 0 if thread function exit without error. Others for error.
  */
-static DWORD WINAPI prvCellularCommReceiveCBThreadFunc( LPVOID pArgument );
+    static DWORD WINAPI prvCellularCommReceiveCBThreadFunc( LPVOID pArgument );
 
 /**
  * @brief Set COM port timeout settings.
@@ -135,7 +140,7 @@ static DWORD WINAPI prvCellularCommReceiveCBThreadFunc( LPVOID pArgument );
  * @return On success, IOT_COMM_INTERFACE_SUCCESS is returned. If an error occurred, error code defined
  * in CellularCommInterfaceError_t is returned.
  */
-static CellularCommInterfaceError_t prvSetupCommTimeout( HANDLE hComm );
+    static CellularCommInterfaceError_t prvSetupCommTimeout( HANDLE hComm );
 
 /**
  * @brief Set COM port control settings.
@@ -145,563 +150,565 @@ static CellularCommInterfaceError_t prvSetupCommTimeout( HANDLE hComm );
  * @return On success, IOT_COMM_INTERFACE_SUCCESS is returned. If an error occurred, error code defined
  * in CellularCommInterfaceError_t is returned.
  */
-static CellularCommInterfaceError_t prvSetupCommState( HANDLE hComm );
+    static CellularCommInterfaceError_t prvSetupCommState( HANDLE hComm );
 
 /*-----------------------------------------------------------*/
 
-CellularCommInterface_t CellularCommInterface =
-{
-    .open  = prvCommIntfOpen,
-    .send  = prvCommIntfSend,
-    .recv  = prvCommIntfReceive,
-    .close = prvCommIntfClose
-};
-
-static cellularCommContext_t uxCellularCommContext =
-{
-    .commReceiveCallback       = NULL,
-    .commReceiveCallbackThread = NULL,
-    .pCommInterface            = &CellularCommInterface,
-    .commFileHandle            = NULL,
-    .pUserData                 = NULL,
-    .commStatus                = 0U,
-    .commTaskThreadStarted     = false
-};
+    CellularCommInterface_t CellularCommInterface =
+    {
+        .open  = prvCommIntfOpen,
+        .send  = prvCommIntfSend,
+        .recv  = prvCommIntfReceive,
+        .close = prvCommIntfClose
+    };
 
-/*-----------------------------------------------------------*/
+    static cellularCommContext_t uxCellularCommContext =
+    {
+        .commReceiveCallback       = NULL,
+        .commReceiveCallbackThread = NULL,
+        .pCommInterface            = &CellularCommInterface,
+        .commFileHandle            = NULL,
+        .pUserData                 = NULL,
+        .commStatus                = 0U,
+        .commTaskThreadStarted     = false
+    };
 
-static uint32_t prvProcessUartInt( void )
-{
-    cellularCommContext_t * pCellularCommContext = &uxCellularCommContext;
-    CellularCommInterfaceError_t callbackRet = IOT_COMM_INTERFACE_FAILURE;
-    uint32_t retUartInt = pdTRUE;
+/*-----------------------------------------------------------*/
 
-    if( pCellularCommContext->commReceiveCallback != NULL )
+    static uint32_t prvProcessUartInt( void )
     {
-        callbackRet = pCellularCommContext->commReceiveCallback( pCellularCommContext->pUserData,
-                                                                 ( CellularCommInterfaceHandle_t ) pCellularCommContext );
-    }
+        cellularCommContext_t * pCellularCommContext = &uxCellularCommContext;
+        CellularCommInterfaceError_t callbackRet = IOT_COMM_INTERFACE_FAILURE;
+        uint32_t retUartInt = pdTRUE;
 
-    if( callbackRet == IOT_COMM_INTERFACE_SUCCESS )
-    {
-        retUartInt = pdTRUE;
-    }
-    else
-    {
-        retUartInt = pdFALSE;
-    }
+        if( pCellularCommContext->commReceiveCallback != NULL )
+        {
+            callbackRet = pCellularCommContext->commReceiveCallback( pCellularCommContext->pUserData,
+                                                                     ( CellularCommInterfaceHandle_t ) pCellularCommContext );
+        }
+
+        if( callbackRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            retUartInt = pdTRUE;
+        }
+        else
+        {
+            retUartInt = pdFALSE;
+        }
 
-    return retUartInt;
-}
+        return retUartInt;
+    }
 
 /*-----------------------------------------------------------*/
 
-static DWORD WINAPI prvCellularCommReceiveCBThreadFunc( LPVOID pArgument )
-{
-    DWORD dwCommStatus = 0;
-    HANDLE hComm = ( HANDLE ) pArgument;
-    BOOL retWait = FALSE;
-    DWORD retValue = 0;
-
-    if( hComm == ( HANDLE ) INVALID_HANDLE_VALUE )
-    {
-        retValue = ERROR_INVALID_HANDLE;
-    }
-    else
+    static DWORD WINAPI prvCellularCommReceiveCBThreadFunc( LPVOID pArgument )
     {
-        for( ; ; )
-        {
-            retWait = WaitCommEvent( hComm, &dwCommStatus, NULL );
+        DWORD dwCommStatus = 0;
+        HANDLE hComm = ( HANDLE ) pArgument;
+        BOOL retWait = FALSE;
+        DWORD retValue = 0;
 
-            if( ( retWait != FALSE ) && ( ( dwCommStatus & EV_RXCHAR ) != 0 ) )
-            {
-                /* Generate a simulated interrupt when data is received in the input buffer in driver.
-                 * The interrupt handler prvProcessUartInt() will be called in prvProcessSimulatedInterrupts().
-                 * This ensures no other task or ISR is running. */
-                vPortGenerateSimulatedInterruptFromWindowsThread( appINTERRUPT_UART );
-            }
-            else
+        if( hComm == ( HANDLE ) INVALID_HANDLE_VALUE )
+        {
+            retValue = ERROR_INVALID_HANDLE;
+        }
+        else
+        {
+            for( ; ; )
             {
-                retValue = GetLastError();
+                retWait = WaitCommEvent( hComm, &dwCommStatus, NULL );
 
-                if( ( retValue == ERROR_INVALID_HANDLE ) || ( retValue == ERROR_OPERATION_ABORTED ) )
+                if( ( retWait != FALSE ) && ( ( dwCommStatus & EV_RXCHAR ) != 0 ) )
                 {
-                    /* COM port closed. */
-                    LogInfo( ( "Cellular COM port %p closed", hComm ) );
+                    /* Generate a simulated interrupt when data is received in the input buffer in driver.
+                     * The interrupt handler prvProcessUartInt() will be called in prvProcessSimulatedInterrupts().
+                     * This ensures no other task or ISR is running. */
+                    vPortGenerateSimulatedInterruptFromWindowsThread( appINTERRUPT_UART );
                 }
                 else
                 {
-                    LogInfo( ( "Cellular receiver thread wait comm error %p %d", hComm, retValue ) );
+                    retValue = GetLastError();
+
+                    if( ( retValue == ERROR_INVALID_HANDLE ) || ( retValue == ERROR_OPERATION_ABORTED ) )
+                    {
+                        /* COM port closed. */
+                        LogInfo( ( "Cellular COM port %p closed", hComm ) );
+                    }
+                    else
+                    {
+                        LogInfo( ( "Cellular receiver thread wait comm error %p %d", hComm, retValue ) );
+                    }
+
+                    break;
                 }
-
-                break;
             }
         }
-    }
-
-    return retValue;
-}
 
-/*-----------------------------------------------------------*/
-
-static CellularCommInterfaceError_t prvSetupCommTimeout( HANDLE hComm )
-{
-    CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
-    COMMTIMEOUTS xCommTimeouts = { 0 };
-    BOOL Status = TRUE;
-
-    /* Set ReadIntervalTimeout to MAXDWORD and zero values for both
-     * ReadTotalTimeoutConstant and ReadTotalTimeoutMultiplier to return
-     * immediately with the bytes that already been received. */
-    xCommTimeouts.ReadIntervalTimeout = MAXDWORD;
-    xCommTimeouts.ReadTotalTimeoutConstant = 0;
-    xCommTimeouts.ReadTotalTimeoutMultiplier = 0;
-    xCommTimeouts.WriteTotalTimeoutConstant = COMM_WRITE_OPERATION_TIMEOUT;
-    xCommTimeouts.WriteTotalTimeoutMultiplier = 0;
-    Status = SetCommTimeouts( hComm, &xCommTimeouts );
-
-    if( Status == FALSE )
-    {
-        LogError( ( "Cellular SetCommTimeouts fail %d", GetLastError() ) );
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        return retValue;
     }
 
-    return commIntRet;
-}
-
 /*-----------------------------------------------------------*/
 
-static CellularCommInterfaceError_t prvSetupCommState( HANDLE hComm )
-{
-    CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
-    DCB dcbSerialParams = { 0 };
-    BOOL Status = TRUE;
-
-    ( void ) memset( &dcbSerialParams, 0, sizeof( dcbSerialParams ) );
-    dcbSerialParams.DCBlength = sizeof( dcbSerialParams );
-    dcbSerialParams.BaudRate = CBR_115200;
-    dcbSerialParams.fBinary = 1;
-    dcbSerialParams.ByteSize = 8;
-    dcbSerialParams.StopBits = ONESTOPBIT;
-    dcbSerialParams.Parity = NOPARITY;
+    static CellularCommInterfaceError_t prvSetupCommTimeout( HANDLE hComm )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        COMMTIMEOUTS xCommTimeouts = { 0 };
+        BOOL Status = TRUE;
 
-    dcbSerialParams.fOutxCtsFlow = FALSE;
-    dcbSerialParams.fOutxDsrFlow = FALSE;
-    dcbSerialParams.fDtrControl = DTR_CONTROL_ENABLE;
-    dcbSerialParams.fRtsControl = RTS_CONTROL_ENABLE;
+        /* Set ReadIntervalTimeout to MAXDWORD and zero values for both
+         * ReadTotalTimeoutConstant and ReadTotalTimeoutMultiplier to return
+         * immediately with the bytes that already been received. */
+        xCommTimeouts.ReadIntervalTimeout = MAXDWORD;
+        xCommTimeouts.ReadTotalTimeoutConstant = 0;
+        xCommTimeouts.ReadTotalTimeoutMultiplier = 0;
+        xCommTimeouts.WriteTotalTimeoutConstant = COMM_WRITE_OPERATION_TIMEOUT;
+        xCommTimeouts.WriteTotalTimeoutMultiplier = 0;
+        Status = SetCommTimeouts( hComm, &xCommTimeouts );
 
-    Status = SetCommState( hComm, &dcbSerialParams );
+        if( Status == FALSE )
+        {
+            LogError( ( "Cellular SetCommTimeouts fail %d", GetLastError() ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
 
-    if( Status == FALSE )
-    {
-        LogError( ( "Cellular SetCommState fail %d", GetLastError() ) );
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        return commIntRet;
     }
 
-    return commIntRet;
-}
-
 /*-----------------------------------------------------------*/
 
-static CellularCommInterfaceError_t prvCommIntfOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
-                                                     void * pUserData,
-                                                     CellularCommInterfaceHandle_t * pCommInterfaceHandle )
-{
-    CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
-    HANDLE hComm = ( HANDLE ) INVALID_HANDLE_VALUE;
-    BOOL Status = TRUE;
-    cellularCommContext_t * pCellularCommContext = &uxCellularCommContext;
-    DWORD dwRes = 0;
-
-    if( pCellularCommContext == NULL )
-    {
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
-    }
-    else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) != 0 )
-    {
-        LogError( ( "Cellular comm interface opened already" ) );
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
-    }
-    else
+    static CellularCommInterfaceError_t prvSetupCommState( HANDLE hComm )
     {
-        /* Clear the context. */
-        memset( pCellularCommContext, 0, sizeof( cellularCommContext_t ) );
-        pCellularCommContext->pCommInterface = &CellularCommInterface;
-
-        /* If CreateFile fails, the return value is INVALID_HANDLE_VALUE. */
-        hComm = CreateFile( TEXT( CELLULAR_COMM_PATH ),
-                            GENERIC_READ | GENERIC_WRITE,
-                            0,
-                            NULL,
-                            OPEN_EXISTING,
-                            FILE_FLAG_OVERLAPPED,
-                            NULL );
-    }
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        DCB dcbSerialParams = { 0 };
+        BOOL Status = TRUE;
 
-    /* Comm port is just closed. Wait 1 second and retry. */
-    if( ( hComm == ( HANDLE ) INVALID_HANDLE_VALUE ) && ( GetLastError() == ERROR_ACCESS_DENIED ) )
-    {
-        vTaskDelay( pdMS_TO_TICKS( 1000UL ) );
-        hComm = CreateFile( TEXT( CELLULAR_COMM_PATH ),
-                            GENERIC_READ | GENERIC_WRITE,
-                            0,
-                            NULL,
-                            OPEN_EXISTING,
-                            FILE_FLAG_OVERLAPPED,
-                            NULL );
-    }
+        ( void ) memset( &dcbSerialParams, 0, sizeof( dcbSerialParams ) );
+        dcbSerialParams.DCBlength = sizeof( dcbSerialParams );
+        dcbSerialParams.BaudRate = CBR_115200;
+        dcbSerialParams.fBinary = 1;
+        dcbSerialParams.ByteSize = 8;
+        dcbSerialParams.StopBits = ONESTOPBIT;
+        dcbSerialParams.Parity = NOPARITY;
 
-    if( hComm == ( HANDLE ) INVALID_HANDLE_VALUE )
-    {
-        LogError( ( "Cellular open COM port fail %d", GetLastError() ) );
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
-    }
-    else
-    {
-        Status = SetupComm( hComm, COMM_TX_BUFFER_SIZE, COMM_RX_BUFFER_SIZE );
+        dcbSerialParams.fOutxCtsFlow = FALSE;
+        dcbSerialParams.fOutxDsrFlow = FALSE;
+        dcbSerialParams.fDtrControl = DTR_CONTROL_ENABLE;
+        dcbSerialParams.fRtsControl = RTS_CONTROL_ENABLE;
+
+        Status = SetCommState( hComm, &dcbSerialParams );
 
         if( Status == FALSE )
         {
-            LogError( ( "Cellular setup COM port fail %d", GetLastError() ) );
+            LogError( ( "Cellular SetCommState fail %d", GetLastError() ) );
             commIntRet = IOT_COMM_INTERFACE_FAILURE;
         }
-    }
 
-    if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
-    {
-        commIntRet = prvSetupCommTimeout( hComm );
+        return commIntRet;
     }
 
-    if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
-    {
-        commIntRet = prvSetupCommState( hComm );
-    }
+/*-----------------------------------------------------------*/
 
-    if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+    static CellularCommInterfaceError_t prvCommIntfOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
+                                                         void * pUserData,
+                                                         CellularCommInterfaceHandle_t * pCommInterfaceHandle )
     {
-        Status = SetCommMask( hComm, EV_RXCHAR );
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        HANDLE hComm = ( HANDLE ) INVALID_HANDLE_VALUE;
+        BOOL Status = TRUE;
+        cellularCommContext_t * pCellularCommContext = &uxCellularCommContext;
+        DWORD dwRes = 0;
 
-        if( Status == FALSE )
+        if( pCellularCommContext == NULL )
         {
-            LogError( ( "Cellular SetCommMask fail %d", GetLastError() ) );
             commIntRet = IOT_COMM_INTERFACE_FAILURE;
         }
-    }
-
-    if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
-    {
-        pCellularCommContext->commReceiveCallback = receiveCallback;
-
-        vPortSetInterruptHandler( appINTERRUPT_UART, prvProcessUartInt );
-        pCellularCommContext->commReceiveCallbackThread =
-            CreateThread( NULL, 0, prvCellularCommReceiveCBThreadFunc, hComm, 0, NULL );
-
-        /* CreateThread return NULL for error. */
-        if( pCellularCommContext->commReceiveCallbackThread == NULL )
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) != 0 )
         {
-            LogError( ( "Cellular CreateThread fail %d", GetLastError() ) );
+            LogError( ( "Cellular comm interface opened already" ) );
             commIntRet = IOT_COMM_INTERFACE_FAILURE;
         }
-    }
+        else
+        {
+            /* Clear the context. */
+            memset( pCellularCommContext, 0, sizeof( cellularCommContext_t ) );
+            pCellularCommContext->pCommInterface = &CellularCommInterface;
+
+            /* If CreateFile fails, the return value is INVALID_HANDLE_VALUE. */
+            hComm = CreateFile( TEXT( CELLULAR_COMM_PATH ),
+                                GENERIC_READ | GENERIC_WRITE,
+                                0,
+                                NULL,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OVERLAPPED,
+                                NULL );
+        }
 
-    if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
-    {
-        pCellularCommContext->pUserData = pUserData;
-        pCellularCommContext->commFileHandle = hComm;
-        *pCommInterfaceHandle = ( CellularCommInterfaceHandle_t ) pCellularCommContext;
-        pCellularCommContext->commStatus |= CELLULAR_COMM_OPEN_BIT;
-    }
-    else
-    {
-        /* Comm interface open fail. Clean the data. */
-        if( hComm != ( HANDLE ) INVALID_HANDLE_VALUE )
+        /* Comm port is just closed. Wait 1 second and retry. */
+        if( ( hComm == ( HANDLE ) INVALID_HANDLE_VALUE ) && ( GetLastError() == ERROR_ACCESS_DENIED ) )
         {
-            ( void ) CloseHandle( hComm );
-            hComm = INVALID_HANDLE_VALUE;
-            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            vTaskDelay( pdMS_TO_TICKS( 1000UL ) );
+            hComm = CreateFile( TEXT( CELLULAR_COMM_PATH ),
+                                GENERIC_READ | GENERIC_WRITE,
+                                0,
+                                NULL,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OVERLAPPED,
+                                NULL );
         }
 
-        /* Wait for the commReceiveCallbackThread exit. */
-        if( pCellularCommContext->commReceiveCallbackThread != NULL )
+        if( hComm == ( HANDLE ) INVALID_HANDLE_VALUE )
+        {
+            LogError( ( "Cellular open COM port fail %d", GetLastError() ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else
         {
-            dwRes = WaitForSingleObject( pCellularCommContext->commReceiveCallbackThread, COMM_RECV_THREAD_TIMEOUT );
+            Status = SetupComm( hComm, COMM_TX_BUFFER_SIZE, COMM_RX_BUFFER_SIZE );
 
-            if( dwRes != WAIT_OBJECT_0 )
+            if( Status == FALSE )
             {
-                LogDebug( ( "Cellular close wait receiveCallbackThread %p fail %d",
-                            pCellularCommContext->commReceiveCallbackThread, dwRes ) );
+                LogError( ( "Cellular setup COM port fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
             }
         }
 
-        pCellularCommContext->commReceiveCallbackThread = NULL;
-    }
-
-    return commIntRet;
-}
-
-/*-----------------------------------------------------------*/
-
-static CellularCommInterfaceError_t prvCommIntfClose( CellularCommInterfaceHandle_t commInterfaceHandle )
-{
-    CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
-    cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
-    HANDLE hComm = NULL;
-    BOOL Status = TRUE;
-    DWORD dwRes = 0;
-
-    if( pCellularCommContext == NULL )
-    {
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
-    }
-    else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
-    {
-        LogError( ( "Cellular close comm interface is not opened before." ) );
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
-    }
-    else
-    {
-        /* clean the receive callback. */
-        pCellularCommContext->commReceiveCallback = NULL;
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            commIntRet = prvSetupCommTimeout( hComm );
+        }
 
-        /* Close the COM port. */
-        hComm = pCellularCommContext->commFileHandle;
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            commIntRet = prvSetupCommState( hComm );
+        }
 
-        if( hComm != ( HANDLE ) INVALID_HANDLE_VALUE )
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
         {
-            Status = CloseHandle( hComm );
+            Status = SetCommMask( hComm, EV_RXCHAR );
 
             if( Status == FALSE )
             {
-                LogDebug( ( "Cellular close CloseHandle %p fail", hComm ) );
+                LogError( ( "Cellular SetCommMask fail %d", GetLastError() ) );
                 commIntRet = IOT_COMM_INTERFACE_FAILURE;
             }
         }
-        else
+
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
         {
-            commIntRet = IOT_COMM_INTERFACE_FAILURE;
-        }
+            pCellularCommContext->commReceiveCallback = receiveCallback;
 
-        pCellularCommContext->commFileHandle = NULL;
+            vPortSetInterruptHandler( appINTERRUPT_UART, prvProcessUartInt );
+            pCellularCommContext->commReceiveCallbackThread =
+                CreateThread( NULL, 0, prvCellularCommReceiveCBThreadFunc, hComm, 0, NULL );
 
-        /* Wait for the thread exit. */
-        if( pCellularCommContext->commReceiveCallbackThread != NULL )
-        {
-            dwRes = WaitForSingleObject( pCellularCommContext->commReceiveCallbackThread, COMM_RECV_THREAD_TIMEOUT );
+            /* CreateThread return NULL for error. */
+            if( pCellularCommContext->commReceiveCallbackThread == NULL )
+            {
+                LogError( ( "Cellular CreateThread fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
+        }
 
-            if( dwRes != WAIT_OBJECT_0 )
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            pCellularCommContext->pUserData = pUserData;
+            pCellularCommContext->commFileHandle = hComm;
+            *pCommInterfaceHandle = ( CellularCommInterfaceHandle_t ) pCellularCommContext;
+            pCellularCommContext->commStatus |= CELLULAR_COMM_OPEN_BIT;
+        }
+        else
+        {
+            /* Comm interface open fail. Clean the data. */
+            if( hComm != ( HANDLE ) INVALID_HANDLE_VALUE )
             {
-                LogDebug( ( "Cellular close wait receiveCallbackThread %p fail %d",
-                            pCellularCommContext->commReceiveCallbackThread, dwRes ) );
+                ( void ) CloseHandle( hComm );
+                hComm = INVALID_HANDLE_VALUE;
                 commIntRet = IOT_COMM_INTERFACE_FAILURE;
             }
-            else
+
+            /* Wait for the commReceiveCallbackThread exit. */
+            if( pCellularCommContext->commReceiveCallbackThread != NULL )
             {
-                CloseHandle( pCellularCommContext->commReceiveCallbackThread );
+                dwRes = WaitForSingleObject( pCellularCommContext->commReceiveCallbackThread, COMM_RECV_THREAD_TIMEOUT );
+
+                if( dwRes != WAIT_OBJECT_0 )
+                {
+                    LogDebug( ( "Cellular close wait receiveCallbackThread %p fail %d",
+                                pCellularCommContext->commReceiveCallbackThread, dwRes ) );
+                }
             }
-        }
 
-        pCellularCommContext->commReceiveCallbackThread = NULL;
+            pCellularCommContext->commReceiveCallbackThread = NULL;
+        }
 
-        /* clean the data structure. */
-        pCellularCommContext->commStatus &= ~( CELLULAR_COMM_OPEN_BIT );
+        return commIntRet;
     }
 
-    return commIntRet;
-}
-
 /*-----------------------------------------------------------*/
 
-static CellularCommInterfaceError_t prvCommIntfSend( CellularCommInterfaceHandle_t commInterfaceHandle,
-                                                     const uint8_t * pData,
-                                                     uint32_t dataLength,
-                                                     uint32_t timeoutMilliseconds,
-                                                     uint32_t * pDataSentLength )
-{
-    CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
-    cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
-    HANDLE hComm = NULL;
-    OVERLAPPED osWrite = { 0 };
-    DWORD dwRes = 0;
-    DWORD dwWritten = 0;
-    BOOL Status = TRUE;
-
-    if( pCellularCommContext == NULL )
-    {
-        commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
-    }
-    else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
-    {
-        LogError( ( "Cellular send comm interface is not opened before." ) );
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
-    }
-    else
+    static CellularCommInterfaceError_t prvCommIntfClose( CellularCommInterfaceHandle_t commInterfaceHandle )
     {
-        hComm = pCellularCommContext->commFileHandle;
-        osWrite.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
+        HANDLE hComm = NULL;
+        BOOL Status = TRUE;
+        DWORD dwRes = 0;
 
-        if( osWrite.hEvent == NULL )
+        if( pCellularCommContext == NULL )
         {
-            LogError( ( "Cellular CreateEvent fail %d", GetLastError() ) );
             commIntRet = IOT_COMM_INTERFACE_FAILURE;
         }
-    }
-
-    if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
-    {
-        Status = WriteFile( hComm, pData, dataLength, &dwWritten, &osWrite );
-
-        /* WriteFile fail and error is not the ERROR_IO_PENDING. */
-        if( ( Status == FALSE ) && ( GetLastError() != ERROR_IO_PENDING ) )
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
         {
-            LogError( ( "Cellular WriteFile fail %d", GetLastError() ) );
+            LogError( ( "Cellular close comm interface is not opened before." ) );
             commIntRet = IOT_COMM_INTERFACE_FAILURE;
         }
-
-        if( Status == TRUE )
+        else
         {
-            *pDataSentLength = ( uint32_t ) dwWritten;
-        }
-    }
+            /* clean the receive callback. */
+            pCellularCommContext->commReceiveCallback = NULL;
 
-    /* Handle pending I/O. */
-    if( ( commIntRet == IOT_COMM_INTERFACE_SUCCESS ) && ( Status == FALSE ) )
-    {
-        dwRes = WaitForSingleObject( osWrite.hEvent, timeoutMilliseconds );
+            /* Close the COM port. */
+            hComm = pCellularCommContext->commFileHandle;
 
-        switch( dwRes )
-        {
-            case WAIT_OBJECT_0:
+            if( hComm != ( HANDLE ) INVALID_HANDLE_VALUE )
+            {
+                Status = CloseHandle( hComm );
 
-                if( GetOverlappedResult( hComm, &osWrite, &dwWritten, FALSE ) == FALSE )
+                if( Status == FALSE )
                 {
-                    LogError( ( "Cellular GetOverlappedResult fail %d", GetLastError() ) );
+                    LogDebug( ( "Cellular close CloseHandle %p fail", hComm ) );
                     commIntRet = IOT_COMM_INTERFACE_FAILURE;
                 }
+            }
+            else
+            {
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
 
-                break;
+            pCellularCommContext->commFileHandle = NULL;
 
-            case STATUS_TIMEOUT:
-                LogError( ( "Cellular WaitForSingleObject timeout" ) );
-                commIntRet = IOT_COMM_INTERFACE_TIMEOUT;
-                break;
+            /* Wait for the thread exit. */
+            if( pCellularCommContext->commReceiveCallbackThread != NULL )
+            {
+                dwRes = WaitForSingleObject( pCellularCommContext->commReceiveCallbackThread, COMM_RECV_THREAD_TIMEOUT );
 
-            default:
-                LogError( ( "Cellular WaitForSingleObject fail %d", dwRes ) );
-                commIntRet = IOT_COMM_INTERFACE_FAILURE;
-                break;
+                if( dwRes != WAIT_OBJECT_0 )
+                {
+                    LogDebug( ( "Cellular close wait receiveCallbackThread %p fail %d",
+                                pCellularCommContext->commReceiveCallbackThread, dwRes ) );
+                    commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                }
+                else
+                {
+                    CloseHandle( pCellularCommContext->commReceiveCallbackThread );
+                }
+            }
+
+            pCellularCommContext->commReceiveCallbackThread = NULL;
+
+            /* clean the data structure. */
+            pCellularCommContext->commStatus &= ~( CELLULAR_COMM_OPEN_BIT );
         }
 
-        *pDataSentLength = ( uint32_t ) dwWritten;
+        return commIntRet;
     }
 
-    if( osWrite.hEvent != NULL )
-    {
-        Status = CloseHandle( osWrite.hEvent );
+/*-----------------------------------------------------------*/
 
-        if( Status == FALSE )
+    static CellularCommInterfaceError_t prvCommIntfSend( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                         const uint8_t * pData,
+                                                         uint32_t dataLength,
+                                                         uint32_t timeoutMilliseconds,
+                                                         uint32_t * pDataSentLength )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
+        HANDLE hComm = NULL;
+        OVERLAPPED osWrite = { 0 };
+        DWORD dwRes = 0;
+        DWORD dwWritten = 0;
+        BOOL Status = TRUE;
+
+        if( pCellularCommContext == NULL )
         {
-            LogDebug( ( "Cellular send CloseHandle fail" ) );
+            commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
         }
-    }
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
+        {
+            LogError( ( "Cellular send comm interface is not opened before." ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else
+        {
+            hComm = pCellularCommContext->commFileHandle;
+            osWrite.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
 
-    return commIntRet;
-}
+            if( osWrite.hEvent == NULL )
+            {
+                LogError( ( "Cellular CreateEvent fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
+        }
 
-/*-----------------------------------------------------------*/
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            Status = WriteFile( hComm, pData, dataLength, &dwWritten, &osWrite );
 
-static CellularCommInterfaceError_t prvCommIntfReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
-                                                        uint8_t * pBuffer,
-                                                        uint32_t bufferLength,
-                                                        uint32_t timeoutMilliseconds,
-                                                        uint32_t * pDataReceivedLength )
-{
-    CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
-    cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
-    HANDLE hComm = NULL;
-    OVERLAPPED osRead = { 0 };
-    BOOL Status = TRUE;
-    DWORD dwRes = 0;
-    DWORD dwRead = 0;
-
-    if( pCellularCommContext == NULL )
-    {
-        commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
-    }
-    else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
-    {
-        LogError( ( "Cellular read comm interface is not opened before." ) );
-        commIntRet = IOT_COMM_INTERFACE_FAILURE;
-    }
-    else
-    {
-        hComm = pCellularCommContext->commFileHandle;
-        osRead.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+            /* WriteFile fail and error is not the ERROR_IO_PENDING. */
+            if( ( Status == FALSE ) && ( GetLastError() != ERROR_IO_PENDING ) )
+            {
+                LogError( ( "Cellular WriteFile fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
 
-        if( osRead.hEvent == NULL )
+            if( Status == TRUE )
+            {
+                *pDataSentLength = ( uint32_t ) dwWritten;
+            }
+        }
+
+        /* Handle pending I/O. */
+        if( ( commIntRet == IOT_COMM_INTERFACE_SUCCESS ) && ( Status == FALSE ) )
         {
-            LogError( ( "Cellular CreateEvent fail %d", GetLastError() ) );
-            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            dwRes = WaitForSingleObject( osWrite.hEvent, timeoutMilliseconds );
+
+            switch( dwRes )
+            {
+                case WAIT_OBJECT_0:
+
+                    if( GetOverlappedResult( hComm, &osWrite, &dwWritten, FALSE ) == FALSE )
+                    {
+                        LogError( ( "Cellular GetOverlappedResult fail %d", GetLastError() ) );
+                        commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                    }
+
+                    break;
+
+                case STATUS_TIMEOUT:
+                    LogError( ( "Cellular WaitForSingleObject timeout" ) );
+                    commIntRet = IOT_COMM_INTERFACE_TIMEOUT;
+                    break;
+
+                default:
+                    LogError( ( "Cellular WaitForSingleObject fail %d", dwRes ) );
+                    commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                    break;
+            }
+
+            *pDataSentLength = ( uint32_t ) dwWritten;
+        }
+
+        if( osWrite.hEvent != NULL )
+        {
+            Status = CloseHandle( osWrite.hEvent );
+
+            if( Status == FALSE )
+            {
+                LogDebug( ( "Cellular send CloseHandle fail" ) );
+            }
         }
+
+        return commIntRet;
     }
 
-    if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
-    {
-        Status = ReadFile( hComm, pBuffer, bufferLength, &dwRead, &osRead );
+/*-----------------------------------------------------------*/
 
-        if( ( Status == FALSE ) && ( GetLastError() != ERROR_IO_PENDING ) )
+    static CellularCommInterfaceError_t prvCommIntfReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                            uint8_t * pBuffer,
+                                                            uint32_t bufferLength,
+                                                            uint32_t timeoutMilliseconds,
+                                                            uint32_t * pDataReceivedLength )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
+        HANDLE hComm = NULL;
+        OVERLAPPED osRead = { 0 };
+        BOOL Status = TRUE;
+        DWORD dwRes = 0;
+        DWORD dwRead = 0;
+
+        if( pCellularCommContext == NULL )
         {
-            LogError( ( "Cellular ReadFile fail %d", GetLastError() ) );
+            commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
+        }
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
+        {
+            LogError( ( "Cellular read comm interface is not opened before." ) );
             commIntRet = IOT_COMM_INTERFACE_FAILURE;
         }
-
-        if( Status == TRUE )
+        else
         {
-            *pDataReceivedLength = ( uint32_t ) dwRead;
+            hComm = pCellularCommContext->commFileHandle;
+            osRead.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+
+            if( osRead.hEvent == NULL )
+            {
+                LogError( ( "Cellular CreateEvent fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
         }
-    }
 
-    /* Handle pending I/O. */
-    if( ( commIntRet == IOT_COMM_INTERFACE_SUCCESS ) && ( Status == FALSE ) )
-    {
-        dwRes = WaitForSingleObject( osRead.hEvent, timeoutMilliseconds );
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            Status = ReadFile( hComm, pBuffer, bufferLength, &dwRead, &osRead );
+
+            if( ( Status == FALSE ) && ( GetLastError() != ERROR_IO_PENDING ) )
+            {
+                LogError( ( "Cellular ReadFile fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
 
-        switch( dwRes )
+            if( Status == TRUE )
+            {
+                *pDataReceivedLength = ( uint32_t ) dwRead;
+            }
+        }
+
+        /* Handle pending I/O. */
+        if( ( commIntRet == IOT_COMM_INTERFACE_SUCCESS ) && ( Status == FALSE ) )
         {
-            case WAIT_OBJECT_0:
+            dwRes = WaitForSingleObject( osRead.hEvent, timeoutMilliseconds );
 
-                if( GetOverlappedResult( hComm, &osRead, &dwRead, FALSE ) == FALSE )
-                {
-                    LogError( ( "Cellular receive GetOverlappedResult fail %d", GetLastError() ) );
-                    commIntRet = IOT_COMM_INTERFACE_FAILURE;
-                }
+            switch( dwRes )
+            {
+                case WAIT_OBJECT_0:
 
-                break;
+                    if( GetOverlappedResult( hComm, &osRead, &dwRead, FALSE ) == FALSE )
+                    {
+                        LogError( ( "Cellular receive GetOverlappedResult fail %d", GetLastError() ) );
+                        commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                    }
 
-            case STATUS_TIMEOUT:
-                LogError( ( "Cellular receive WaitForSingleObject timeout" ) );
-                commIntRet = IOT_COMM_INTERFACE_TIMEOUT;
-                break;
+                    break;
 
-            default:
-                LogError( ( "Cellular receive WaitForSingleObject fail %d", dwRes ) );
-                commIntRet = IOT_COMM_INTERFACE_FAILURE;
-                break;
-        }
+                case STATUS_TIMEOUT:
+                    LogError( ( "Cellular receive WaitForSingleObject timeout" ) );
+                    commIntRet = IOT_COMM_INTERFACE_TIMEOUT;
+                    break;
 
-        *pDataReceivedLength = ( uint32_t ) dwRead;
-    }
+                default:
+                    LogError( ( "Cellular receive WaitForSingleObject fail %d", dwRes ) );
+                    commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                    break;
+            }
 
-    if( osRead.hEvent != NULL )
-    {
-        Status = CloseHandle( osRead.hEvent );
+            *pDataReceivedLength = ( uint32_t ) dwRead;
+        }
 
-        if( Status == FALSE )
+        if( osRead.hEvent != NULL )
         {
-            LogDebug( ( "Cellular recv CloseHandle fail" ) );
+            Status = CloseHandle( osRead.hEvent );
+
+            if( Status == FALSE )
+            {
+                LogDebug( ( "Cellular recv CloseHandle fail" ) );
+            }
         }
-    }
 
-    return commIntRet;
-}
+        return commIntRet;
+    }
 
 /*-----------------------------------------------------------*/
+
+#endif /* CELLULAR_COMM_IF_USE_RING_BUFFER == 0 */
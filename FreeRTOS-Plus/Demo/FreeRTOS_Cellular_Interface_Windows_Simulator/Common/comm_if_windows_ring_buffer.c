@@ -0,0 +1,867 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/**
+ * @file comm_if_windows_ring_buffer.c
+ * @brief Windows Simulator file for a reference cellular comm interface that
+ * receives into a ring buffer.
+ *
+ * A receive thread stands in for a UART DMA channel in circular mode. It reads
+ * the COM port into a ring buffer, one half of the buffer at a time, and each
+ * read completes when the line has been idle for CELLULAR_COMM_IF_IDLE_LINE_TIMEOUT_MS
+ * or when the half is full. Each completed read raises one simulated UART
+ * interrupt, like the idle line and half transfer interrupts of a DMA driven
+ * UART, and the interrupt calls the receive callback of the cellular library.
+ * The cellular library then reads the data out of the ring buffer.
+ */
+
+/*-----------------------------------------------------------*/
+
+/* Windows include file for COM port I/O. */
+#include <windows.h>
+
+/* Platform layer includes. */
+#include "cellular_platform.h"
+
+/* Cellular comm interface include file. */
+#include "cellular_config.h"
+#include "cellular_config_defaults.h"
+#include "cellular_comm_interface.h"
+#include "comm_if_ring_buffer.h"
+
+#if ( CELLULAR_COMM_IF_USE_RING_BUFFER == 1 )
+
+/*-----------------------------------------------------------*/
+
+/* Define the COM port used as comm interface. */
+    #ifndef CELLULAR_COMM_INTERFACE_PORT
+        #error "Define CELLULAR_COMM_INTERFACE_PORT in cellular_config.h"
+    #endif
+    #define CELLULAR_COMM_PATH              "\\\\.\\"CELLULAR_COMM_INTERFACE_PORT
+
+/* Define the simulated UART interrupt number. */
+    #define appINTERRUPT_UART               portINTERRUPT_APPLICATION_DEFINED_START
+
+/* Define the read write buffer size of the COM port driver. */
+    #define COMM_TX_BUFFER_SIZE             ( 8192 )
+    #define COMM_RX_BUFFER_SIZE             ( 8192 )
+
+/* Receive thread timeout in ms. */
+    #define COMM_RECV_THREAD_TIMEOUT        ( 5000 )
+
+/* Write operation timeout in ms. */
+    #define COMM_WRITE_OPERATION_TIMEOUT    ( 500 )
+
+/* Comm status. */
+    #define CELLULAR_COMM_OPEN_BIT          ( 0x01U )
+
+/* The ring buffer is filled one half at a time. */
+    #define COMM_RING_BUFFER_MASK           ( CELLULAR_COMM_IF_RING_BUFFER_SIZE - 1U )
+    #define COMM_RING_BUFFER_HALF_SIZE      ( CELLULAR_COMM_IF_RING_BUFFER_SIZE / 2U )
+
+    #if ( ( CELLULAR_COMM_IF_RING_BUFFER_SIZE & COMM_RING_BUFFER_MASK ) != 0 )
+        #error "CELLULAR_COMM_IF_RING_BUFFER_SIZE must be a power of 2"
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @note The ring buffer has a single writer, the receive thread, which only
+ * advances rxHead, and a single reader, the cellular library, which only
+ * advances rxTail. Both indexes run freely and are masked to index the buffer.
+ */
+    typedef struct cellularCommContext
+    {
+        CellularCommInterfaceReceiveCallback_t commReceiveCallback;
+        HANDLE commReceiveThread;
+        uint8_t commStatus;
+        void * pUserData;
+        HANDLE commFileHandle;
+        CellularCommInterface_t * pCommInterface;
+        HANDLE rxSpaceEvent;            /* Set by the reader when space is released. */
+        SemaphoreHandle_t rxSemaphore;  /* Given by the UART interrupt when data is received. */
+        volatile uint32_t rxHead;
+        volatile uint32_t rxTail;
+        CellularCommIntfStats_t stats;
+        uint8_t rxBuffer[ CELLULAR_COMM_IF_RING_BUFFER_SIZE ];
+    } cellularCommContext_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief CellularCommInterfaceOpen_t implementation.
+ */
+    static CellularCommInterfaceError_t prvCommIntfOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
+                                                         void * pUserData,
+                                                         CellularCommInterfaceHandle_t * pCommInterfaceHandle );
+
+/**
+ * @brief CellularCommInterfaceSend_t implementation.
+ */
+    static CellularCommInterfaceError_t prvCommIntfSend( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                         const uint8_t * pData,
+                                                         uint32_t dataLength,
+                                                         uint32_t timeoutMilliseconds,
+                                                         uint32_t * pDataSentLength );
+
+/**
+ * @brief CellularCommInterfaceRecv_t implementation.
+ *
+ * Copies the data out of the ring buffer with CellularCommIntf_ReceiveZeroCopy().
+ */
+    static CellularCommInterfaceError_t prvCommIntfReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                            uint8_t * pBuffer,
+                                                            uint32_t bufferLength,
+                                                            uint32_t timeoutMilliseconds,
+                                                            uint32_t * pDataReceivedLength );
+
+/**
+ * @brief CellularCommInterfaceClose_t implementation.
+ */
+    static CellularCommInterfaceError_t prvCommIntfClose( CellularCommInterfaceHandle_t commInterfaceHandle );
+
+/**
+ * @brief UART interrupt handler.
+ *
+ * @return pdTRUE if a context switch is required, otherwise pdFALSE.
+ */
+    static uint32_t prvProcessUartInt( void );
+
+/**
+ * @brief Communication receiver thread function, which fills the ring buffer.
+ *
+ * @param[in] pArgument The comm interface context.
+ * @return 0 if thread function exit without error. Others for error.
+ */
+    static DWORD WINAPI prvCellularCommReceiveThreadFunc( LPVOID pArgument );
+
+/**
+ * @brief Set COM port timeout settings for idle line detection.
+ *
+ * @param[in] hComm COM handle returned by CreateFile.
+ *
+ * @return On success, IOT_COMM_INTERFACE_SUCCESS is returned. If an error occurred, error code defined
+ * in CellularCommInterfaceError_t is returned.
+ */
+    static CellularCommInterfaceError_t prvSetupCommTimeout( HANDLE hComm );
+
+/**
+ * @brief Set COM port control settings.
+ *
+ * @param[in] hComm COM handle returned by CreateFile.
+ *
+ * @return On success, IOT_COMM_INTERFACE_SUCCESS is returned. If an error occurred, error code defined
+ * in CellularCommInterfaceError_t is returned.
+ */
+    static CellularCommInterfaceError_t prvSetupCommState( HANDLE hComm );
+
+/**
+ * @brief Free the resources of the context after open failed or at close.
+ *
+ * @param[in] pCellularCommContext The comm interface context.
+ */
+    static void prvCleanupContext( cellularCommContext_t * pCellularCommContext );
+
+/*-----------------------------------------------------------*/
+
+    CellularCommInterface_t CellularCommInterface =
+    {
+        .open  = prvCommIntfOpen,
+        .send  = prvCommIntfSend,
+        .recv  = prvCommIntfReceive,
+        .close = prvCommIntfClose
+    };
+
+    static cellularCommContext_t uxCellularCommContext =
+    {
+        .commReceiveCallback = NULL,
+        .commReceiveThread   = NULL,
+        .pCommInterface      = &CellularCommInterface,
+        .commFileHandle      = NULL,
+        .pUserData           = NULL,
+        .commStatus          = 0U,
+        .rxSpaceEvent        = NULL,
+        .rxSemaphore         = NULL
+    };
+
+/*-----------------------------------------------------------*/
+
+    static uint32_t prvProcessUartInt( void )
+    {
+        cellularCommContext_t * pCellularCommContext = &uxCellularCommContext;
+        CellularCommInterfaceError_t callbackRet = IOT_COMM_INTERFACE_FAILURE;
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        /* Wake a task waiting in the receive function. */
+        if( pCellularCommContext->rxSemaphore != NULL )
+        {
+            ( void ) xSemaphoreGiveFromISR( pCellularCommContext->rxSemaphore, &xHigherPriorityTaskWoken );
+        }
+
+        if( pCellularCommContext->commReceiveCallback != NULL )
+        {
+            callbackRet = pCellularCommContext->commReceiveCallback( pCellularCommContext->pUserData,
+                                                                     ( CellularCommInterfaceHandle_t ) pCellularCommContext );
+        }
+
+        return ( ( callbackRet == IOT_COMM_INTERFACE_SUCCESS ) || ( xHigherPriorityTaskWoken != pdFALSE ) ) ? pdTRUE : pdFALSE;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static DWORD WINAPI prvCellularCommReceiveThreadFunc( LPVOID pArgument )
+    {
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) pArgument;
+        HANDLE hComm = pCellularCommContext->commFileHandle;
+        OVERLAPPED osRead = { 0 };
+        uint32_t freeSpace = 0;
+        uint32_t readLength = 0;
+        uint32_t level = 0;
+        DWORD dwRead = 0;
+        DWORD retValue = 0;
+        BOOL Status = TRUE;
+
+        osRead.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+
+        if( osRead.hEvent == NULL )
+        {
+            retValue = GetLastError();
+        }
+
+        while( retValue == 0 )
+        {
+            freeSpace = CELLULAR_COMM_IF_RING_BUFFER_SIZE - ( pCellularCommContext->rxHead - pCellularCommContext->rxTail );
+
+            if( freeSpace == 0U )
+            {
+                /* The reader is behind. Leave the data in the driver buffer until it
+                 * releases space, as a UART with hardware flow control would. */
+                pCellularCommContext->stats.bufferFullWaits++;
+                ( void ) WaitForSingleObject( pCellularCommContext->rxSpaceEvent, COMM_RECV_THREAD_TIMEOUT );
+                continue;
+            }
+
+            /* Read at most up to the end of the current half of the buffer. */
+            readLength = COMM_RING_BUFFER_HALF_SIZE - ( pCellularCommContext->rxHead & ( COMM_RING_BUFFER_HALF_SIZE - 1U ) );
+
+            if( readLength > freeSpace )
+            {
+                readLength = freeSpace;
+            }
+
+            ( void ) ResetEvent( osRead.hEvent );
+            dwRead = 0;
+            Status = ReadFile( hComm,
+                               &pCellularCommContext->rxBuffer[ pCellularCommContext->rxHead & COMM_RING_BUFFER_MASK ],
+                               readLength,
+                               &dwRead,
+                               &osRead );
+
+            if( ( Status == FALSE ) && ( GetLastError() == ERROR_IO_PENDING ) )
+            {
+                /* The read completes when the line goes idle after data, or when
+                 * the half of the buffer is full. */
+                Status = GetOverlappedResult( hComm, &osRead, &dwRead, TRUE );
+            }
+
+            if( Status == FALSE )
+            {
+                retValue = GetLastError();
+
+                if( ( retValue == ERROR_INVALID_HANDLE ) || ( retValue == ERROR_OPERATION_ABORTED ) )
+                {
+                    /* COM port closed. */
+                    LogInfo( ( "Cellular COM port %p closed", hComm ) );
+                }
+                else
+                {
+                    LogInfo( ( "Cellular receiver thread read error %p %d", hComm, retValue ) );
+                }
+            }
+            else if( dwRead > 0U )
+            {
+                /* Make the data visible before the new head. */
+                MemoryBarrier();
+                pCellularCommContext->rxHead += ( uint32_t ) dwRead;
+
+                level = pCellularCommContext->rxHead - pCellularCommContext->rxTail;
+                pCellularCommContext->stats.bytesReceived += ( uint32_t ) dwRead;
+                pCellularCommContext->stats.receiveBursts++;
+
+                if( level > pCellularCommContext->stats.maxBufferLevel )
+                {
+                    pCellularCommContext->stats.maxBufferLevel = level;
+                }
+
+                /* Generate a simulated interrupt when a burst of data is in the ring buffer.
+                 * The interrupt handler prvProcessUartInt() will be called in prvProcessSimulatedInterrupts().
+                 * This ensures no other task or ISR is running. */
+                vPortGenerateSimulatedInterruptFromWindowsThread( appINTERRUPT_UART );
+            }
+            else
+            {
+                /* No data, read again. */
+            }
+        }
+
+        if( osRead.hEvent != NULL )
+        {
+            ( void ) CloseHandle( osRead.hEvent );
+        }
+
+        return retValue;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static CellularCommInterfaceError_t prvSetupCommTimeout( HANDLE hComm )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        COMMTIMEOUTS xCommTimeouts = { 0 };
+        BOOL Status = TRUE;
+
+        /* Set ReadIntervalTimeout with zero values for both ReadTotalTimeoutConstant
+         * and ReadTotalTimeoutMultiplier, so that a read waits for the first byte,
+         * and then returns when no byte has been received for the interval time
+         * or when the buffer is full. This is the idle line detection. */
+        xCommTimeouts.ReadIntervalTimeout = CELLULAR_COMM_IF_IDLE_LINE_TIMEOUT_MS;
+        xCommTimeouts.ReadTotalTimeoutConstant = 0;
+        xCommTimeouts.ReadTotalTimeoutMultiplier = 0;
+        xCommTimeouts.WriteTotalTimeoutConstant = COMM_WRITE_OPERATION_TIMEOUT;
+        xCommTimeouts.WriteTotalTimeoutMultiplier = 0;
+        Status = SetCommTimeouts( hComm, &xCommTimeouts );
+
+        if( Status == FALSE )
+        {
+            LogError( ( "Cellular SetCommTimeouts fail %d", GetLastError() ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static CellularCommInterfaceError_t prvSetupCommState( HANDLE hComm )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        DCB dcbSerialParams = { 0 };
+        BOOL Status = TRUE;
+
+        ( void ) memset( &dcbSerialParams, 0, sizeof( dcbSerialParams ) );
+        dcbSerialParams.DCBlength = sizeof( dcbSerialParams );
+        dcbSerialParams.BaudRate = CBR_115200;
+        dcbSerialParams.fBinary = 1;
+        dcbSerialParams.ByteSize = 8;
+        dcbSerialParams.StopBits = ONESTOPBIT;
+        dcbSerialParams.Parity = NOPARITY;
+
+        dcbSerialParams.fOutxCtsFlow = FALSE;
+        dcbSerialParams.fOutxDsrFlow = FALSE;
+        dcbSerialParams.fDtrControl = DTR_CONTROL_ENABLE;
+        dcbSerialParams.fRtsControl = RTS_CONTROL_ENABLE;
+
+        Status = SetCommState( hComm, &dcbSerialParams );
+
+        if( Status == FALSE )
+        {
+            LogError( ( "Cellular SetCommState fail %d", GetLastError() ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvCleanupContext( cellularCommContext_t * pCellularCommContext )
+    {
+        DWORD dwRes = 0;
+
+        /* Closing the COM port aborts the read of the receive thread. */
+        if( ( pCellularCommContext->commFileHandle != NULL ) &&
+            ( pCellularCommContext->commFileHandle != ( HANDLE ) INVALID_HANDLE_VALUE ) )
+        {
+            ( void ) CancelIoEx( pCellularCommContext->commFileHandle, NULL );
+
+            if( CloseHandle( pCellularCommContext->commFileHandle ) == FALSE )
+            {
+                LogDebug( ( "Cellular close CloseHandle %p fail", pCellularCommContext->commFileHandle ) );
+            }
+        }
+
+        pCellularCommContext->commFileHandle = NULL;
+
+        /* Wait for the thread exit. */
+        if( pCellularCommContext->commReceiveThread != NULL )
+        {
+            /* Wake the thread if it waits for space in the ring buffer. */
+            ( void ) SetEvent( pCellularCommContext->rxSpaceEvent );
+
+            dwRes = WaitForSingleObject( pCellularCommContext->commReceiveThread, COMM_RECV_THREAD_TIMEOUT );
+
+            if( dwRes != WAIT_OBJECT_0 )
+            {
+                LogDebug( ( "Cellular close wait receiveThread %p fail %d",
+                            pCellularCommContext->commReceiveThread, dwRes ) );
+            }
+            else
+            {
+                ( void ) CloseHandle( pCellularCommContext->commReceiveThread );
+            }
+        }
+
+        pCellularCommContext->commReceiveThread = NULL;
+
+        if( pCellularCommContext->rxSpaceEvent != NULL )
+        {
+            ( void ) CloseHandle( pCellularCommContext->rxSpaceEvent );
+            pCellularCommContext->rxSpaceEvent = NULL;
+        }
+
+        if( pCellularCommContext->rxSemaphore != NULL )
+        {
+            vSemaphoreDelete( pCellularCommContext->rxSemaphore );
+            pCellularCommContext->rxSemaphore = NULL;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static CellularCommInterfaceError_t prvCommIntfOpen( CellularCommInterfaceReceiveCallback_t receiveCallback,
+                                                         void * pUserData,
+                                                         CellularCommInterfaceHandle_t * pCommInterfaceHandle )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        HANDLE hComm = ( HANDLE ) INVALID_HANDLE_VALUE;
+        BOOL Status = TRUE;
+        cellularCommContext_t * pCellularCommContext = &uxCellularCommContext;
+
+        if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) != 0 )
+        {
+            LogError( ( "Cellular comm interface opened already" ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else
+        {
+            /* Clear the context. */
+            memset( pCellularCommContext, 0, sizeof( cellularCommContext_t ) );
+            pCellularCommContext->pCommInterface = &CellularCommInterface;
+
+            /* If CreateFile fails, the return value is INVALID_HANDLE_VALUE. */
+            hComm = CreateFile( TEXT( CELLULAR_COMM_PATH ),
+                                GENERIC_READ | GENERIC_WRITE,
+                                0,
+                                NULL,
+                                OPEN_EXISTING,
+                                FILE_FLAG_OVERLAPPED,
+                                NULL );
+
+            /* Comm port is just closed. Wait 1 second and retry. */
+            if( ( hComm == ( HANDLE ) INVALID_HANDLE_VALUE ) && ( GetLastError() == ERROR_ACCESS_DENIED ) )
+            {
+                vTaskDelay( pdMS_TO_TICKS( 1000UL ) );
+                hComm = CreateFile( TEXT( CELLULAR_COMM_PATH ),
+                                    GENERIC_READ | GENERIC_WRITE,
+                                    0,
+                                    NULL,
+                                    OPEN_EXISTING,
+                                    FILE_FLAG_OVERLAPPED,
+                                    NULL );
+            }
+
+            if( hComm == ( HANDLE ) INVALID_HANDLE_VALUE )
+            {
+                LogError( ( "Cellular open COM port fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
+            else
+            {
+                pCellularCommContext->commFileHandle = hComm;
+                Status = SetupComm( hComm, COMM_TX_BUFFER_SIZE, COMM_RX_BUFFER_SIZE );
+
+                if( Status == FALSE )
+                {
+                    LogError( ( "Cellular setup COM port fail %d", GetLastError() ) );
+                    commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                }
+            }
+        }
+
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            commIntRet = prvSetupCommTimeout( hComm );
+        }
+
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            commIntRet = prvSetupCommState( hComm );
+        }
+
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            /* Auto-reset event, set whenever the reader releases space. */
+            pCellularCommContext->rxSpaceEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
+            pCellularCommContext->rxSemaphore = xSemaphoreCreateBinary();
+
+            if( ( pCellularCommContext->rxSpaceEvent == NULL ) || ( pCellularCommContext->rxSemaphore == NULL ) )
+            {
+                LogError( ( "Cellular ring buffer events create fail" ) );
+                commIntRet = IOT_COMM_INTERFACE_NO_MEMORY;
+            }
+        }
+
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            pCellularCommContext->commReceiveCallback = receiveCallback;
+            pCellularCommContext->pUserData = pUserData;
+
+            vPortSetInterruptHandler( appINTERRUPT_UART, prvProcessUartInt );
+            pCellularCommContext->commReceiveThread =
+                CreateThread( NULL, 0, prvCellularCommReceiveThreadFunc, pCellularCommContext, 0, NULL );
+
+            /* CreateThread return NULL for error. */
+            if( pCellularCommContext->commReceiveThread == NULL )
+            {
+                LogError( ( "Cellular CreateThread fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
+        }
+
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            *pCommInterfaceHandle = ( CellularCommInterfaceHandle_t ) pCellularCommContext;
+            pCellularCommContext->commStatus |= CELLULAR_COMM_OPEN_BIT;
+        }
+        else
+        {
+            /* Comm interface open fail. Clean the data. */
+            pCellularCommContext->commReceiveCallback = NULL;
+            prvCleanupContext( pCellularCommContext );
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static CellularCommInterfaceError_t prvCommIntfClose( CellularCommInterfaceHandle_t commInterfaceHandle )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
+
+        if( pCellularCommContext == NULL )
+        {
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
+        {
+            LogError( ( "Cellular close comm interface is not opened before." ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else
+        {
+            /* clean the receive callback. */
+            pCellularCommContext->commReceiveCallback = NULL;
+
+            prvCleanupContext( pCellularCommContext );
+
+            /* clean the data structure. */
+            pCellularCommContext->commStatus &= ~( CELLULAR_COMM_OPEN_BIT );
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static CellularCommInterfaceError_t prvCommIntfSend( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                         const uint8_t * pData,
+                                                         uint32_t dataLength,
+                                                         uint32_t timeoutMilliseconds,
+                                                         uint32_t * pDataSentLength )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
+        HANDLE hComm = NULL;
+        OVERLAPPED osWrite = { 0 };
+        DWORD dwRes = 0;
+        DWORD dwWritten = 0;
+        BOOL Status = TRUE;
+
+        if( pCellularCommContext == NULL )
+        {
+            commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
+        }
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
+        {
+            LogError( ( "Cellular send comm interface is not opened before." ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else
+        {
+            hComm = pCellularCommContext->commFileHandle;
+            osWrite.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+
+            if( osWrite.hEvent == NULL )
+            {
+                LogError( ( "Cellular CreateEvent fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
+        }
+
+        if( commIntRet == IOT_COMM_INTERFACE_SUCCESS )
+        {
+            Status = WriteFile( hComm, pData, dataLength, &dwWritten, &osWrite );
+
+            /* WriteFile fail and error is not the ERROR_IO_PENDING. */
+            if( ( Status == FALSE ) && ( GetLastError() != ERROR_IO_PENDING ) )
+            {
+                LogError( ( "Cellular WriteFile fail %d", GetLastError() ) );
+                commIntRet = IOT_COMM_INTERFACE_FAILURE;
+            }
+
+            if( Status == TRUE )
+            {
+                *pDataSentLength = ( uint32_t ) dwWritten;
+            }
+        }
+
+        /* Handle pending I/O. */
+        if( ( commIntRet == IOT_COMM_INTERFACE_SUCCESS ) && ( Status == FALSE ) )
+        {
+            dwRes = WaitForSingleObject( osWrite.hEvent, timeoutMilliseconds );
+
+            switch( dwRes )
+            {
+                case WAIT_OBJECT_0:
+
+                    if( GetOverlappedResult( hComm, &osWrite, &dwWritten, FALSE ) == FALSE )
+                    {
+                        LogError( ( "Cellular GetOverlappedResult fail %d", GetLastError() ) );
+                        commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                    }
+
+                    break;
+
+                case STATUS_TIMEOUT:
+                    LogError( ( "Cellular WaitForSingleObject timeout" ) );
+                    commIntRet = IOT_COMM_INTERFACE_TIMEOUT;
+                    break;
+
+                default:
+                    LogError( ( "Cellular WaitForSingleObject fail %d", dwRes ) );
+                    commIntRet = IOT_COMM_INTERFACE_FAILURE;
+                    break;
+            }
+
+            *pDataSentLength = ( uint32_t ) dwWritten;
+        }
+
+        if( osWrite.hEvent != NULL )
+        {
+            Status = CloseHandle( osWrite.hEvent );
+
+            if( Status == FALSE )
+            {
+                LogDebug( ( "Cellular send CloseHandle fail" ) );
+            }
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    CellularCommInterfaceError_t CellularCommIntf_ReceiveZeroCopy( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                                   const uint8_t ** ppData,
+                                                                   uint32_t maxLength,
+                                                                   uint32_t timeoutMilliseconds,
+                                                                   uint32_t * pDataReceivedLength )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
+        TickType_t xTicksToWait = pdMS_TO_TICKS( timeoutMilliseconds );
+        TimeOut_t xTimeOut;
+        uint32_t available = 0;
+        uint32_t contiguous = 0;
+        uint32_t tail = 0;
+
+        if( ( pCellularCommContext == NULL ) || ( ppData == NULL ) || ( pDataReceivedLength == NULL ) )
+        {
+            commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
+        }
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
+        {
+            LogError( ( "Cellular read comm interface is not opened before." ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else
+        {
+            vTaskSetTimeOutState( &xTimeOut );
+
+            for( ; ; )
+            {
+                tail = pCellularCommContext->rxTail;
+                available = pCellularCommContext->rxHead - tail;
+
+                if( available > 0U )
+                {
+                    /* Read the data only after the head that covers it. */
+                    MemoryBarrier();
+                    break;
+                }
+
+                /* Wait for the next UART interrupt. A stale give only causes
+                 * another check of the head. */
+                if( ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE ) ||
+                    ( xSemaphoreTake( pCellularCommContext->rxSemaphore, xTicksToWait ) == pdFALSE ) )
+                {
+                    /* The head may have moved just before the time out. */
+                    tail = pCellularCommContext->rxTail;
+                    available = pCellularCommContext->rxHead - tail;
+                    MemoryBarrier();
+                    break;
+                }
+            }
+
+            contiguous = CELLULAR_COMM_IF_RING_BUFFER_SIZE - ( tail & COMM_RING_BUFFER_MASK );
+
+            if( available > contiguous )
+            {
+                available = contiguous;
+            }
+
+            if( available > maxLength )
+            {
+                available = maxLength;
+            }
+
+            *ppData = &pCellularCommContext->rxBuffer[ tail & COMM_RING_BUFFER_MASK ];
+            *pDataReceivedLength = available;
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    CellularCommInterfaceError_t CellularCommIntf_ReceiveRelease( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                                  uint32_t length )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        cellularCommContext_t * pCellularCommContext = ( cellularCommContext_t * ) commInterfaceHandle;
+
+        if( pCellularCommContext == NULL )
+        {
+            commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
+        }
+        else if( ( pCellularCommContext->commStatus & CELLULAR_COMM_OPEN_BIT ) == 0 )
+        {
+            LogError( ( "Cellular read comm interface is not opened before." ) );
+            commIntRet = IOT_COMM_INTERFACE_FAILURE;
+        }
+        else if( length > ( pCellularCommContext->rxHead - pCellularCommContext->rxTail ) )
+        {
+            LogError( ( "Cellular release of %u bytes is more than received.", length ) );
+            commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
+        }
+        else if( length > 0U )
+        {
+            /* Finish reading the data before the space is reused. */
+            MemoryBarrier();
+            pCellularCommContext->rxTail += length;
+            ( void ) SetEvent( pCellularCommContext->rxSpaceEvent );
+        }
+        else
+        {
+            /* Nothing to release. */
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static CellularCommInterfaceError_t prvCommIntfReceive( CellularCommInterfaceHandle_t commInterfaceHandle,
+                                                            uint8_t * pBuffer,
+                                                            uint32_t bufferLength,
+                                                            uint32_t timeoutMilliseconds,
+                                                            uint32_t * pDataReceivedLength )
+    {
+        CellularCommInterfaceError_t commIntRet = IOT_COMM_INTERFACE_SUCCESS;
+        const uint8_t * pData = NULL;
+        uint32_t dataLength = 0;
+        uint32_t copied = 0;
+
+        if( ( pBuffer == NULL ) || ( pDataReceivedLength == NULL ) )
+        {
+            commIntRet = IOT_COMM_INTERFACE_BAD_PARAMETER;
+        }
+
+        /* Copy until the buffer is full or the received data is used up. The data
+         * takes two copies when it wraps around the end of the ring buffer. Only
+         * the first receive waits for data. */
+        while( ( commIntRet == IOT_COMM_INTERFACE_SUCCESS ) && ( copied < bufferLength ) )
+        {
+            commIntRet = CellularCommIntf_ReceiveZeroCopy( commInterfaceHandle,
+                                                           &pData,
+                                                           bufferLength - copied,
+                                                           ( copied == 0U ) ? timeoutMilliseconds : 0U,
+                                                           &dataLength );
+
+            if( ( commIntRet != IOT_COMM_INTERFACE_SUCCESS ) || ( dataLength == 0U ) )
+            {
+                break;
+            }
+
+            ( void ) memcpy( &pBuffer[ copied ], pData, dataLength );
+            copied += dataLength;
+            commIntRet = CellularCommIntf_ReceiveRelease( commInterfaceHandle, dataLength );
+        }
+
+        if( pDataReceivedLength != NULL )
+        {
+            *pDataReceivedLength = copied;
+        }
+
+        return commIntRet;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void CellularCommIntf_GetStats( CellularCommIntfStats_t * pStats )
+    {
+        if( pStats != NULL )
+        {
+            *pStats = uxCellularCommContext.stats;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* CELLULAR_COMM_IF_USE_RING_BUFFER == 1 */
@@ -41,6 +41,12 @@
 /* Demo Specific configs. */
 #include "demo_config.h"
 
+/* Set democonfigCELLULAR_BENCH to 1 to run the comm interface bench instead of
+ * the MQTT demo. */
+#ifndef democonfigCELLULAR_BENCH
+    #define democonfigCELLULAR_BENCH    ( 0 )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* FreeRTOS Cellular Library init and setup cellular network registration. */
@@ -49,6 +55,9 @@ extern bool setupCellular( void );
 /* The MQTT demo entry function. */
 extern void vStartSimpleMQTTDemo( void );
 
+/* The comm interface bench entry function. */
+extern void vRunCellularBench( void );
+
 /* Task to handle connecting the cellular module. */
 static void vCellularDemoTask( void * pvParameters );
 
@@ -62,7 +71,11 @@ static void vCellularDemoTask( void * pvParameters )
     /* Setup cellular. */
     configASSERT( setupCellular() == true );
 
-    vStartSimpleMQTTDemo();
+    #if ( democonfigCELLULAR_BENCH == 1 )
+        vRunCellularBench();
+    #else
+        vStartSimpleMQTTDemo();
+    #endif
 
     vTaskDelete( NULL );
 }
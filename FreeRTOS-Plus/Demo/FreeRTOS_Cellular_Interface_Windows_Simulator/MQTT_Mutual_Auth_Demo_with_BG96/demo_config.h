@@ -270,4 +270,17 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define democonfigRANGE_SIZE             ( 1000U )
 
+/**
+ * @brief Set to 1 to measure AT command and socket throughput over the cellular
+ * comm interface instead of running the MQTT demo. The socket throughput is
+ * measured against a TCP echo server, for example:
+ *
+ * #define democonfigCELLULAR_BENCH_ECHO_SERVER    "...insert here..."
+ * #define democonfigCELLULAR_BENCH_ECHO_PORT      ( 7 )
+ *
+ * Set CELLULAR_COMM_IF_USE_RING_BUFFER to 1 in cellular_config.h to run the
+ * bench with the ring buffer comm interface.
+ */
+#define democonfigCELLULAR_BENCH         ( 0 )
+
 #endif /* DEMO_CONFIG_H */
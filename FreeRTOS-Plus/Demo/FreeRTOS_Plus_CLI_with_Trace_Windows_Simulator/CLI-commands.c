@@ -42,7 +42,9 @@
  * Writes trace data to a disk file when the trace recording is stopped.
  * This function will simply overwrite any trace files that already exist.
  */
-static void prvSaveTraceFile( void );
+#if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT )
+    static void prvSaveTraceFile( void );
+#endif
 
 /*
  * Defines a command that returns a table showing the state of each task at the
@@ -84,6 +86,17 @@ static BaseType_t prvStartStopTraceCommand( char * pcWriteBuffer,
                                             size_t xWriteBufferLen,
                                             const char * pcCommandString );
 
+#if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
+
+/*
+ * Defines a command that prints the counters of the trace stream, including
+ * the events dropped because the ring of the stream port was full.
+ */
+    static BaseType_t prvTraceStreamStatsCommand( char * pcWriteBuffer,
+                                                  size_t xWriteBufferLen,
+                                                  const char * pcCommandString );
+#endif
+
 /* Structure that defines the "run-time-stats" command line command. */
 static const CLI_Command_Definition_t xRunTimeStats =
 {
@@ -134,6 +147,18 @@ static const CLI_Command_Definition_t xStartTrace =
     1                         /* One parameter is expected.  Valid values are "start" and "stop". */
 };
 
+#if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
+
+/* Structure that defines the "trace-stream" command line command. */
+    static const CLI_Command_Definition_t xTraceStreamStats =
+    {
+        "trace-stream",
+        "\r\ntrace-stream:\r\n Displays the events streamed to the trace host and the events dropped\r\n\r\n",
+        prvTraceStreamStatsCommand, /* The function to run. */
+        0                           /* No parameters are expected. */
+    };
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vRegisterCLICommands( void )
@@ -144,6 +169,12 @@ void vRegisterCLICommands( void )
     FreeRTOS_CLIRegisterCommand( &xThreeParameterEcho );
     FreeRTOS_CLIRegisterCommand( &xParameterEcho );
     FreeRTOS_CLIRegisterCommand( &xStartTrace );
+
+    #if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
+    {
+        FreeRTOS_CLIRegisterCommand( &xTraceStreamStats );
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -359,9 +390,14 @@ static BaseType_t prvStartStopTraceCommand( char * pcWriteBuffer,
     /* There are only two valid parameter values. */
     if( strncmp( pcParameter, "start", strlen( "start" ) ) == 0 )
     {
-        /* Start or restart the trace. */
+        /* Start or restart the trace.  A restarted stream begins again in
+         * the ring of the stream port, so there is nothing to clear. */
         vTraceStop();
-        vTraceClear();
+        #if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT )
+        {
+            vTraceClear();
+        }
+        #endif
 
         vTraceEnable( TRC_START );
         traceSTART();
@@ -372,8 +408,19 @@ static BaseType_t prvStartStopTraceCommand( char * pcWriteBuffer,
     {
         /* End the trace, if one is running. */
         vTraceStop();
-        sprintf( pcWriteBuffer, "Stopping trace recording and dumping log to disk.\r\n" );
-        prvSaveTraceFile();
+
+        #if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
+        {
+            /* The trace has been streamed as it was recorded, the stream task
+             * sends what is left in its ring. */
+            sprintf( pcWriteBuffer, "Stopping trace recording.\r\n" );
+        }
+        #else
+        {
+            sprintf( pcWriteBuffer, "Stopping trace recording and dumping log to disk.\r\n" );
+            prvSaveTraceFile();
+        }
+        #endif
     }
     else
     {
@@ -386,20 +433,63 @@ static BaseType_t prvStartStopTraceCommand( char * pcWriteBuffer,
 }
 /*-----------------------------------------------------------*/
 
-static void prvSaveTraceFile( void )
-{
-    FILE * pxOutputFile;
-
-    fopen_s( &pxOutputFile, "Trace.dump", "wb" );
+#if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
 
-    if( pxOutputFile != NULL )
+    static BaseType_t prvTraceStreamStatsCommand( char * pcWriteBuffer,
+                                                  size_t xWriteBufferLen,
+                                                  const char * pcCommandString )
     {
-        fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
-        fclose( pxOutputFile );
-        printf( "\r\nTrace output saved to Trace.dump\r\n" );
+        TraceStreamPortStats_t xStreamStats;
+
+        /* Remove compile time warnings about unused parameters, and check the
+         * write buffer is not NULL. */
+        ( void ) pcCommandString;
+        configASSERT( pcWriteBuffer );
+
+        vTraceStreamPortGetStats( &xStreamStats );
+
+        snprintf( pcWriteBuffer, xWriteBufferLen,
+                  "Host connected: %s, TCP connections: %lu\r\n"
+                  "Events streamed: %lu, dropped: %lu (%lu bytes)\r\n"
+                  "Bytes sent: %lu, queued: %lu, ring high water mark: %lu of %lu\r\n"
+                  "Send errors: %lu\r\n",
+                  ( xStreamStats.ulHostConnected != 0U ) ? "yes" : "no",
+                  ( unsigned long ) xStreamStats.ulConnections,
+                  ( unsigned long ) xStreamStats.ulEventsCommitted,
+                  ( unsigned long ) xStreamStats.ulEventsDropped,
+                  ( unsigned long ) xStreamStats.ulBytesDropped,
+                  ( unsigned long ) xStreamStats.ulBytesSent,
+                  ( unsigned long ) xStreamStats.ulBytesQueued,
+                  ( unsigned long ) xStreamStats.ulHighWaterMark,
+                  ( unsigned long ) TRC_CFG_STREAM_PORT_BUFFER_SIZE,
+                  ( unsigned long ) xStreamStats.ulSendErrors );
+
+        /* There is no more data to return after this single string, so return
+         * pdFALSE. */
+        return pdFALSE;
     }
-    else
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING ) */
+
+#if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT )
+
+    static void prvSaveTraceFile( void )
     {
-        printf( "\r\nFailed to create trace dump file\r\n" );
+        FILE * pxOutputFile;
+
+        fopen_s( &pxOutputFile, "Trace.dump", "wb" );
+
+        if( pxOutputFile != NULL )
+        {
+            fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
+            fclose( pxOutputFile );
+            printf( "\r\nTrace output saved to Trace.dump\r\n" );
+        }
+        else
+        {
+            printf( "\r\nFailed to create trace dump file\r\n" );
+        }
     }
-}
+
+#endif /* if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_SNAPSHOT ) */
@@ -0,0 +1,447 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A stream port for the trace recorder that sends the trace over TCP or UDP,
+ * selected by TRC_CFG_STREAM_PORT_TRANSPORT in trcStreamPortConfig.h.
+ *
+ * The recorder commits each event into a bounded ring, which never blocks
+ * the task or interrupt that generated the event.  The recorder serialises
+ * events with its critical section, so there is only ever one producer.  An
+ * event that does not fit in the ring is dropped whole and counted, so the
+ * stream stays parseable and Tracealyzer shows the gap as missed events.
+ *
+ * vTraceStreamTask() is the only consumer.  It runs at the idle priority, so
+ * sending the trace only uses time the demo tasks leave, and sends the ring
+ * to the host in the order it was written.  Over TCP it listens for one host
+ * at a time, like Tracealyzer connecting to 127.0.0.1:12000.  The ring holds
+ * the start of the trace until a host connects, and a host that connects to
+ * a trace another host already received part of restarts the trace, so every
+ * host receives a stream from its beginning.  Over UDP it sends datagrams to
+ * a fixed address whether or not anything listens.
+ *
+ * The "trace-stream" command prints the counters of vTraceStreamPortGetStats().
+ */
+
+#pragma comment( lib, "ws2_32.lib" )
+
+/* Win32 includes. */
+#include <WinSock2.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+Trace includes. */
+#include "trcRecorder.h"
+
+#if ( TRC_USE_TRACEALYZER_RECORDER == 1 ) && ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
+
+    #if ( ( TRC_CFG_STREAM_PORT_BUFFER_SIZE & ( TRC_CFG_STREAM_PORT_BUFFER_SIZE - 1 ) ) != 0 )
+        #error TRC_CFG_STREAM_PORT_BUFFER_SIZE must be a power of two.
+    #endif
+
+    #if ( TRC_CFG_STREAM_PORT_TRANSPORT != TRC_STREAM_PORT_TRANSPORT_TCP ) && ( TRC_CFG_STREAM_PORT_TRANSPORT != TRC_STREAM_PORT_TRANSPORT_UDP )
+        #error TRC_CFG_STREAM_PORT_TRANSPORT must be TRC_STREAM_PORT_TRANSPORT_TCP or TRC_STREAM_PORT_TRANSPORT_UDP.
+    #endif
+
+    #define trcSTREAM_INDEX_MASK    ( ( uint32_t ) ( TRC_CFG_STREAM_PORT_BUFFER_SIZE ) - 1U )
+
+/*
+ * Open the socket the trace is sent from, listening on
+ * TRC_CFG_STREAM_PORT_PORT for TCP.
+ */
+    static SOCKET prvOpenStreamSocket( void );
+
+/*
+ * Send the bytes of the ring from ulTail for the current trace, which may
+ * stop short at the end of the ring.  Returns pdFAIL if the send failed.
+ */
+    static BaseType_t prvSendRing( SOCKET xSocket,
+                                   const struct sockaddr_in * pxDestination );
+
+/*-----------------------------------------------------------*/
+
+/* The ring.  ulHead is only written by the recorder and ulTail only by
+ * vTraceStreamTask().  Both count bytes from the start of the trace and wrap
+ * at 2^32, so the number of bytes in the ring is ulHead - ulTail.  Both are
+ * read and written by the task in a critical section, which excludes the
+ * recorder. */
+    static uint8_t ucRingBuffer[ TRC_CFG_STREAM_PORT_BUFFER_SIZE ];
+    static volatile uint32_t ulHead = 0;
+    static volatile uint32_t ulTail = 0;
+
+/* Incremented each time a trace begins, so the task knows that the ring was
+ * reset under it and that the host needs a new stream. */
+    static volatile uint32_t ulTraceGeneration = 0;
+
+/* The counters of the stream, written in critical sections. */
+    static TraceStreamPortStats_t xStats = { 0 };
+
+/*-----------------------------------------------------------*/
+
+    traceResult prvTraceStreamPortWriteData( void * pvData,
+                                             uint32_t uiSize,
+                                             int32_t * piBytesWritten )
+    {
+        uint32_t ulLocalHead = ulHead;
+        uint32_t ulIndex, ulFirst, ulUsed;
+
+        /* Always report the event as written, a dropped event must not make
+         * the recorder retry or stop. */
+        *piBytesWritten = ( int32_t ) uiSize;
+        ulUsed = ulLocalHead - ulTail;
+
+        if( ( ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ulUsed ) < uiSize )
+        {
+            xStats.ulEventsDropped++;
+            xStats.ulBytesDropped += uiSize;
+            return TRC_SUCCESS;
+        }
+
+        ulIndex = ulLocalHead & trcSTREAM_INDEX_MASK;
+        ulFirst = ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ulIndex;
+
+        if( ulFirst >= uiSize )
+        {
+            memcpy( &( ucRingBuffer[ ulIndex ] ), pvData, uiSize );
+        }
+        else
+        {
+            memcpy( &( ucRingBuffer[ ulIndex ] ), pvData, ulFirst );
+            memcpy( ucRingBuffer, ( uint8_t * ) pvData + ulFirst, uiSize - ulFirst );
+        }
+
+        ulHead = ulLocalHead + uiSize;
+        xStats.ulEventsCommitted++;
+
+        if( ( ulUsed + uiSize ) > xStats.ulHighWaterMark )
+        {
+            xStats.ulHighWaterMark = ulUsed + uiSize;
+        }
+
+        return TRC_SUCCESS;
+    }
+/*-----------------------------------------------------------*/
+
+    traceResult xTraceStreamPortInitialize( TraceStreamPortBuffer_t * pxBuffer )
+    {
+        if( pxBuffer == NULL )
+        {
+            return TRC_FAIL;
+        }
+
+        return TRC_SUCCESS;
+    }
+/*-----------------------------------------------------------*/
+
+    traceResult xTraceStreamPortOnTraceBegin( void )
+    {
+        uint32_t ulConnections = xStats.ulConnections;
+        uint32_t ulHostConnected = xStats.ulHostConnected;
+
+        /* The recorder writes the header of the trace next, so the ring
+         * starts empty. */
+        ulHead = 0;
+        ulTail = 0;
+        memset( &xStats, 0x00, sizeof( xStats ) );
+        xStats.ulConnections = ulConnections;
+        xStats.ulHostConnected = ulHostConnected;
+        ulTraceGeneration++;
+
+        return TRC_SUCCESS;
+    }
+/*-----------------------------------------------------------*/
+
+    void vTraceStreamPortGetStats( TraceStreamPortStats_t * pxStats )
+    {
+        taskENTER_CRITICAL();
+        {
+            *pxStats = xStats;
+            pxStats->ulBytesQueued = ulHead - ulTail;
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    void vTraceStreamTask( void * pvParameters )
+    {
+        SOCKET xSocket, xHost = INVALID_SOCKET;
+        struct sockaddr_in xDestination;
+        uint32_t ulGeneration, ulStreamedGeneration = 0, ulLocalHead, ulLocalTail;
+
+        /* Just to prevent compiler warnings. */
+        ( void ) pvParameters;
+
+        memset( ( void * ) &xDestination, 0x00, sizeof( xDestination ) );
+        xDestination.sin_family = AF_INET;
+        xDestination.sin_port = htons( TRC_CFG_STREAM_PORT_PORT );
+        xDestination.sin_addr.s_addr = inet_addr( TRC_CFG_STREAM_PORT_UDP_HOST );
+
+        xSocket = prvOpenStreamSocket();
+
+        if( xSocket == INVALID_SOCKET )
+        {
+            /* The socket could not be opened, events are dropped once the
+             * ring is full. */
+            vTaskDelete( NULL );
+        }
+
+        #if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_UDP )
+        {
+            xHost = xSocket;
+            xStats.ulHostConnected = 1U;
+        }
+        #endif
+
+        for( ; ; )
+        {
+            #if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP )
+            {
+                if( xHost == INVALID_SOCKET )
+                {
+                    /* Wait for a host, the ring holds the trace meanwhile. */
+                    xHost = accept( xSocket, NULL, NULL );
+
+                    if( xHost == INVALID_SOCKET )
+                    {
+                        vTaskDelay( pdMS_TO_TICKS( TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS ) );
+                        continue;
+                    }
+
+                    taskENTER_CRITICAL();
+                    {
+                        xStats.ulConnections++;
+                        xStats.ulHostConnected = 1U;
+                    }
+                    taskEXIT_CRITICAL();
+
+                    /* The previous host received the start of this trace, so
+                     * restart it for the new one. */
+                    if( ulStreamedGeneration == ulTraceGeneration )
+                    {
+                        vTraceStop();
+                        vTraceEnable( TRC_START );
+                    }
+
+                    ulStreamedGeneration = 0U;
+
+                    printf( "\r\nTrace streaming to a host on port %d\r\n", TRC_CFG_STREAM_PORT_PORT );
+                }
+            }
+            #endif /* if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP ) */
+
+            taskENTER_CRITICAL();
+            {
+                ulGeneration = ulTraceGeneration;
+                ulLocalHead = ulHead;
+                ulLocalTail = ulTail;
+            }
+            taskEXIT_CRITICAL();
+
+            #if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP )
+            {
+                /* A trace begun while the host received the previous one
+                 * cannot follow it on the same connection. */
+                if( ( ulStreamedGeneration != 0U ) && ( ulStreamedGeneration != ulGeneration ) )
+                {
+                    closesocket( xHost );
+                    xHost = INVALID_SOCKET;
+                    ulStreamedGeneration = 0U;
+
+                    taskENTER_CRITICAL();
+                    {
+                        xStats.ulHostConnected = 0U;
+                    }
+                    taskEXIT_CRITICAL();
+
+                    printf( "\r\nTrace restarted, reconnect the host to receive it\r\n" );
+                    continue;
+                }
+            }
+            #endif
+
+            if( ulLocalHead == ulLocalTail )
+            {
+                vTaskDelay( pdMS_TO_TICKS( TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS ) );
+            }
+            else
+            {
+                ulStreamedGeneration = ulGeneration;
+
+                if( prvSendRing( xHost, &xDestination ) == pdFAIL )
+                {
+                    #if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP )
+                    {
+                        /* The host went away, the next one restarts the
+                         * trace. */
+                        closesocket( xHost );
+                        xHost = INVALID_SOCKET;
+
+                        taskENTER_CRITICAL();
+                        {
+                            xStats.ulHostConnected = 0U;
+                        }
+                        taskEXIT_CRITICAL();
+                    }
+                    #else
+                    {
+                        vTaskDelay( pdMS_TO_TICKS( TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS ) );
+                    }
+                    #endif
+                }
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvSendRing( SOCKET xSocket,
+                                   const struct sockaddr_in * pxDestination )
+    {
+        uint32_t ulGeneration, ulLocalHead, ulLocalTail, ulIndex, ulLength;
+        int iSent;
+        BaseType_t xReturn = pdPASS;
+
+        taskENTER_CRITICAL();
+        {
+            ulGeneration = ulTraceGeneration;
+            ulLocalHead = ulHead;
+            ulLocalTail = ulTail;
+        }
+        taskEXIT_CRITICAL();
+
+        /* Send up to the end of the ring, the rest goes on the next call.
+         * The recorder does not write to the bytes from ulTail to ulHead, so
+         * they are sent without holding the critical section. */
+        ulIndex = ulLocalTail & trcSTREAM_INDEX_MASK;
+        ulLength = ulLocalHead - ulLocalTail;
+
+        if( ulLength > ( ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ulIndex ) )
+        {
+            ulLength = ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ulIndex;
+        }
+
+        #if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP )
+        {
+            ( void ) pxDestination;
+            iSent = send( xSocket, ( const char * ) &( ucRingBuffer[ ulIndex ] ), ( int ) ulLength, 0 );
+        }
+        #else
+        {
+            if( ulLength > ( uint32_t ) TRC_CFG_STREAM_PORT_UDP_PAYLOAD )
+            {
+                ulLength = ( uint32_t ) TRC_CFG_STREAM_PORT_UDP_PAYLOAD;
+            }
+
+            iSent = sendto( xSocket, ( const char * ) &( ucRingBuffer[ ulIndex ] ), ( int ) ulLength, 0,
+                            ( const struct sockaddr * ) pxDestination, sizeof( *pxDestination ) );
+        }
+        #endif /* if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP ) */
+
+        taskENTER_CRITICAL();
+        {
+            if( iSent == SOCKET_ERROR )
+            {
+                xStats.ulSendErrors++;
+                xReturn = pdFAIL;
+            }
+            else if( ulGeneration == ulTraceGeneration )
+            {
+                /* Unless a new trace reset the ring meanwhile, the bytes sent
+                 * are free for the recorder again. */
+                ulTail = ulLocalTail + ( uint32_t ) iSent;
+                xStats.ulBytesSent += ( uint32_t ) iSent;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static SOCKET prvOpenStreamSocket( void )
+    {
+        WSADATA xWSAData;
+        struct sockaddr_in xServer;
+        SOCKET xSocket = INVALID_SOCKET;
+
+        /* Prepare to use WinSock. */
+        if( WSAStartup( MAKEWORD( 2, 2 ), &xWSAData ) != 0 )
+        {
+            fprintf( stderr, "Could not open Windows connection.\n" );
+        }
+        else
+        {
+            #if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP )
+            {
+                xSocket = socket( AF_INET, SOCK_STREAM, 0 );
+            }
+            #else
+            {
+                xSocket = socket( AF_INET, SOCK_DGRAM, 0 );
+            }
+            #endif
+
+            if( xSocket == INVALID_SOCKET )
+            {
+                fprintf( stderr, "Could not create trace stream socket.\n" );
+                WSACleanup();
+            }
+        }
+
+        #if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP )
+        {
+            if( xSocket != INVALID_SOCKET )
+            {
+                /* Listen on the loopback address, like the CLI. */
+                memset( ( void * ) &xServer, 0x00, sizeof( struct sockaddr_in ) );
+                xServer.sin_family = AF_INET;
+                xServer.sin_port = htons( TRC_CFG_STREAM_PORT_PORT );
+                xServer.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+                if( ( bind( xSocket, ( struct sockaddr * ) &xServer, sizeof( struct sockaddr_in ) ) == SOCKET_ERROR ) ||
+                    ( listen( xSocket, 1 ) == SOCKET_ERROR ) )
+                {
+                    fprintf( stderr, "Could not listen for the trace host on port %d.\n", TRC_CFG_STREAM_PORT_PORT );
+                    closesocket( xSocket );
+                    xSocket = INVALID_SOCKET;
+                    WSACleanup();
+                }
+            }
+        }
+        #else
+        {
+            ( void ) xServer;
+        }
+        #endif /* if ( TRC_CFG_STREAM_PORT_TRANSPORT == TRC_STREAM_PORT_TRANSPORT_TCP ) */
+
+        return xSocket;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* ( TRC_USE_TRACEALYZER_RECORDER == 1 ) && ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING ) */
@@ -96,8 +96,15 @@
  * Values:
  * TRC_RECORDER_MODE_SNAPSHOT
  * TRC_RECORDER_MODE_STREAMING
+ *
+ * The demo streams the trace over TCP or UDP, using the port in
+ * TraceStreamServer.c, when projTRACE_STREAMING is defined as 1.
  ******************************************************************************/
-    #define TRC_CFG_RECORDER_MODE                    TRC_RECORDER_MODE_SNAPSHOT
+    #if defined( projTRACE_STREAMING ) && ( projTRACE_STREAMING == 1 )
+        #define TRC_CFG_RECORDER_MODE                TRC_RECORDER_MODE_STREAMING
+    #else
+        #define TRC_CFG_RECORDER_MODE                TRC_RECORDER_MODE_SNAPSHOT
+    #endif
 
 /******************************************************************************
  * TRC_CFG_FREERTOS_VERSION
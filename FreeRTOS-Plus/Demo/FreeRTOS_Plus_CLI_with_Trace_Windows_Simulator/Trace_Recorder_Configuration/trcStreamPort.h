@@ -0,0 +1,115 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A stream port for the trace recorder that sends the trace over TCP or UDP
+ * from a low priority task, so scheduling can be watched live and long runs
+ * can be traced without the buffer of snapshot mode wrapping.  See
+ * TraceStreamServer.c.
+ */
+
+#ifndef TRC_STREAM_PORT_H
+#define TRC_STREAM_PORT_H
+
+#include <trcTypes.h>
+#include <trcStreamPortConfig.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/* Events are copied straight into the ring of the task that sends them, so
+ * the recorder's internal buffer is not needed. */
+#define TRC_USE_INTERNAL_BUFFER        0
+
+#define TRC_STREAM_PORT_BUFFER_SIZE    ( sizeof( TraceUnsignedBaseType_t ) )
+
+typedef struct TraceStreamPortBuffer
+{
+    uint8_t buffer[ TRC_STREAM_PORT_BUFFER_SIZE ];
+} TraceStreamPortBuffer_t;
+
+/**
+ * @brief The counters of the stream, read with vTraceStreamPortGetStats().
+ * They are cleared when a trace begins.
+ */
+typedef struct TraceStreamPortStats
+{
+    uint32_t ulEventsCommitted;  /**< Events written to the ring. */
+    uint32_t ulEventsDropped;    /**< Events dropped because the ring was full. */
+    uint32_t ulBytesDropped;     /**< The bytes of the events dropped. */
+    uint32_t ulBytesSent;        /**< Bytes sent to the host. */
+    uint32_t ulBytesQueued;      /**< Bytes in the ring, not sent yet. */
+    uint32_t ulHighWaterMark;    /**< The most bytes the ring held. */
+    uint32_t ulSendErrors;       /**< Sends that failed, after which a TCP host is disconnected. */
+    uint32_t ulConnections;      /**< TCP hosts accepted, always 0 for UDP. */
+    uint32_t ulHostConnected;    /**< 1 while a TCP host is connected, always 1 for UDP. */
+} TraceStreamPortStats_t;
+
+traceResult prvTraceStreamPortWriteData( void * pvData,
+                                         uint32_t uiSize,
+                                         int32_t * piBytesWritten );
+
+traceResult xTraceStreamPortInitialize( TraceStreamPortBuffer_t * pxBuffer );
+
+traceResult xTraceStreamPortOnTraceBegin( void );
+
+/**
+ * @brief Read the counters of the stream.
+ *
+ * @param[out] pxStats The counters.
+ */
+void vTraceStreamPortGetStats( TraceStreamPortStats_t * pxStats );
+
+/**
+ * @brief The task that sends the trace, created by main() at a low priority.
+ *
+ * @param[in] pvParameters Not used.
+ */
+void vTraceStreamTask( void * pvParameters );
+
+#define xTraceStreamPortAllocate( uiSize, ppvData )                   ( ( void ) ( uiSize ), xTraceStaticBufferGet( ppvData ) )
+
+#define xTraceStreamPortCommit( pvData, uiSize, piBytesCommitted )    prvTraceStreamPortWriteData( pvData, uiSize, piBytesCommitted )
+
+#define xTraceStreamPortWriteData( pvData, uiSize, piBytesWritten )   prvTraceStreamPortWriteData( pvData, uiSize, piBytesWritten )
+
+/* Commands from Tracealyzer are not read back over the stream, the trace is
+ * started and stopped with the "trace" command instead. */
+#define xTraceStreamPortReadData( pvData, uiSize, piBytesRead )       ( ( void ) ( pvData ), ( void ) ( uiSize ), ( void ) ( piBytesRead ), TRC_SUCCESS )
+
+#define xTraceStreamPortOnEnable( uiStartOption )                     ( ( void ) ( uiStartOption ), TRC_SUCCESS )
+
+#define xTraceStreamPortOnDisable()                                   ( TRC_SUCCESS )
+
+/* The task sends what is left in the ring after the trace ends. */
+#define xTraceStreamPortOnTraceEnd()                                  ( TRC_SUCCESS )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRC_STREAM_PORT_H */
@@ -0,0 +1,115 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Configuration of the network stream port of the CLI with Trace demo, see
+ * TraceStreamServer.c.
+ */
+
+#ifndef TRC_STREAM_PORT_CONFIG_H
+#define TRC_STREAM_PORT_CONFIG_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/**
+ * @def TRC_STREAM_PORT_TRANSPORT_TCP
+ * @def TRC_STREAM_PORT_TRANSPORT_UDP
+ * @brief The values of TRC_CFG_STREAM_PORT_TRANSPORT.
+ */
+#define TRC_STREAM_PORT_TRANSPORT_TCP    1
+#define TRC_STREAM_PORT_TRANSPORT_UDP    2
+
+/**
+ * @def TRC_CFG_STREAM_PORT_TRANSPORT
+ * @brief How the trace leaves the device.
+ *
+ * TRC_STREAM_PORT_TRANSPORT_TCP listens on TRC_CFG_STREAM_PORT_PORT for one
+ * host, such as Tracealyzer with a TCP connection to 127.0.0.1:12000, and
+ * sends it the trace from its beginning.
+ *
+ * TRC_STREAM_PORT_TRANSPORT_UDP sends the trace as datagrams to
+ * TRC_CFG_STREAM_PORT_UDP_HOST, port TRC_CFG_STREAM_PORT_PORT, whether or not
+ * anything is listening.  A datagram lost on the way leaves a gap in the
+ * stream, so UDP is only suited to a host on the loopback address or another
+ * link that does not lose datagrams.
+ */
+#ifndef TRC_CFG_STREAM_PORT_TRANSPORT
+    #define TRC_CFG_STREAM_PORT_TRANSPORT    TRC_STREAM_PORT_TRANSPORT_TCP
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_PORT
+ * @brief The TCP port listened on, or the UDP port the trace is sent to.
+ */
+#ifndef TRC_CFG_STREAM_PORT_PORT
+    #define TRC_CFG_STREAM_PORT_PORT    12000
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_UDP_HOST
+ * @brief The IPv4 address the datagrams of TRC_STREAM_PORT_TRANSPORT_UDP are
+ * sent to.
+ */
+#ifndef TRC_CFG_STREAM_PORT_UDP_HOST
+    #define TRC_CFG_STREAM_PORT_UDP_HOST    "127.0.0.1"
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_UDP_PAYLOAD
+ * @brief The largest datagram sent, kept below the MTU so that datagrams are
+ * not fragmented.
+ */
+#ifndef TRC_CFG_STREAM_PORT_UDP_PAYLOAD
+    #define TRC_CFG_STREAM_PORT_UDP_PAYLOAD    1400
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_BUFFER_SIZE
+ * @brief The size in bytes of the ring between the recorder and the task that
+ * sends the trace.  Must be a power of two.  An event that does not fit is
+ * dropped, counted by the "trace-stream" command, and Tracealyzer shows the
+ * gap as missed events.
+ */
+#ifndef TRC_CFG_STREAM_PORT_BUFFER_SIZE
+    #define TRC_CFG_STREAM_PORT_BUFFER_SIZE    ( 64UL * 1024UL )
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS
+ * @brief How long the task that sends the trace waits when the ring is empty,
+ * or for a host to connect.
+ */
+#ifndef TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS
+    #define TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS    10
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRC_STREAM_PORT_CONFIG_H */
@@ -86,6 +86,7 @@
 #define mainQUEUE_RECEIVE_TASK_PRIORITY    ( tskIDLE_PRIORITY + 2 )
 #define mainQUEUE_SEND_TASK_PRIORITY       ( tskIDLE_PRIORITY + 1 )
 #define mainUDP_CLI_TASK_PRIORITY          ( tskIDLE_PRIORITY )
+#define mainTRACE_STREAM_TASK_PRIORITY     ( tskIDLE_PRIORITY )
 
 /* The rate at which data is sent to the queue.  The (simulated) 250ms value is
  * converted to ticks using the portTICK_RATE_MS constant. */
@@ -151,6 +152,14 @@ int main( void )
      * is set using the configUDP_CLI_PORT_NUMBER setting in FreeRTOSConfig.h. */
     xTaskCreate( vUDPCommandInterpreterTask, "CLI", configMINIMAL_STACK_SIZE, NULL, mainUDP_CLI_TASK_PRIORITY, NULL );
 
+    #if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
+    {
+        /* Create the task that sends the trace to the host as it is recorded,
+         * see TraceStreamServer.c. */
+        xTaskCreate( vTraceStreamTask, "TzStream", configMINIMAL_STACK_SIZE, NULL, mainTRACE_STREAM_TASK_PRIORITY, NULL );
+    }
+    #endif
+
     /* Register commands with the FreeRTOS+CLI command interpreter. */
     vRegisterCLICommands();
 
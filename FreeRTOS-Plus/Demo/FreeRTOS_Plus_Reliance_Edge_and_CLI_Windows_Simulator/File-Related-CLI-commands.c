@@ -46,6 +46,10 @@
 
 #define cliNEW_LINE     "\r\n"
 
+/* The number of directory entries the DIR command reads from the file system
+ * at a time. */
+#define cliDIR_BATCH    8
+
 /*******************************************************************************
  * See the URL in the comments within main.c for the location of the online
  * documentation.
@@ -170,6 +174,40 @@ static BaseType_t prvTRANSMASKSETCommand( char * pcWriteBuffer,
                                           size_t xWriteBufferLen,
                                           const char * pcCommandString );
 
+#if REDCONF_STATS == 1
+
+/*
+ * Implements the IOSTATS command.
+ */
+    static BaseType_t prvIOSTATSCommand( char * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const char * pcCommandString );
+
+/*
+ * Implements the IOSTATSRESET command.
+ */
+    static BaseType_t prvIOSTATSRESETCommand( char * pcWriteBuffer,
+                                              size_t xWriteBufferLen,
+                                              const char * pcCommandString );
+#endif /* REDCONF_STATS == 1 */
+
+#if REDCONF_LATENCY_STATS == 1
+
+/*
+ * Implements the LATENCY command.
+ */
+    static BaseType_t prvLATENCYCommand( char * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const char * pcCommandString );
+
+/*
+ * Implements the LATENCYRESET command.
+ */
+    static BaseType_t prvLATENCYRESETCommand( char * pcWriteBuffer,
+                                              size_t xWriteBufferLen,
+                                              const char * pcCommandString );
+#endif /* REDCONF_LATENCY_STATS == 1 */
+
 /*
  * Implements the ABORT command.
  */
@@ -184,6 +222,13 @@ static BaseType_t prvTESTFSCommand( char * pcWriteBuffer,
                                     size_t xWriteBufferLen,
                                     const char * pcCommandString );
 
+/*
+ * Implements the BENCH-FS command.
+ */
+static BaseType_t prvBENCHFSCommand( char * pcWriteBuffer,
+                                     size_t xWriteBufferLen,
+                                     const char * pcCommandString );
+
 
 /* Structure that defines the DIR command line command, which lists all the
  * files in the current directory. */
@@ -332,6 +377,52 @@ static const CLI_Command_Definition_t xTRANSMASKSET =
     1                       /* One parameter is expected. */
 };
 
+#if REDCONF_STATS == 1
+
+/* Structure that defines the IOSTATS command line command, which shows the
+ * I/O and cache statistics of the file system volume. */
+    static const CLI_Command_Definition_t xIOSTATS =
+    {
+        "iostats",         /* The command string to type. */
+        "\r\niostats:\r\n Show file system I/O and cache statistics\r\n",
+        prvIOSTATSCommand, /* The function to run. */
+        0                  /* No parameters are expected. */
+    };
+
+/* Structure that defines the IOSTATSRESET command line command, which zeroes
+ * the I/O and cache statistics. */
+    static const CLI_Command_Definition_t xIOSTATSRESET =
+    {
+        "iostatsreset",         /* The command string to type. */
+        "\r\niostatsreset:\r\n Reset file system I/O and cache statistics to zero\r\n",
+        prvIOSTATSRESETCommand, /* The function to run. */
+        0                       /* No parameters are expected. */
+    };
+#endif /* REDCONF_STATS == 1 */
+
+#if REDCONF_LATENCY_STATS == 1
+
+/* Structure that defines the LATENCY command line command, which shows the
+ * latency histograms of the timed file system calls. */
+    static const CLI_Command_Definition_t xLATENCY =
+    {
+        "latency",         /* The command string to type. */
+        "\r\nlatency:\r\n Show file system call latency percentiles and histograms\r\n",
+        prvLATENCYCommand, /* The function to run. */
+        0                  /* No parameters are expected. */
+    };
+
+/* Structure that defines the LATENCYRESET command line command, which zeroes
+ * the latency histograms. */
+    static const CLI_Command_Definition_t xLATENCYRESET =
+    {
+        "latencyreset",         /* The command string to type. */
+        "\r\nlatencyreset:\r\n Reset file system call latency histograms to zero\r\n",
+        prvLATENCYRESETCommand, /* The function to run. */
+        0                       /* No parameters are expected. */
+    };
+#endif /* REDCONF_LATENCY_STATS == 1 */
+
 /* Structure that defines the ABORT command line command, which rolls back
  * changes which have not been transacted. */
 static const CLI_Command_Definition_t xABORT =
@@ -352,6 +443,16 @@ static const CLI_Command_Definition_t xTEST_FS =
     0                 /* No parameters are expected. */
 };
 
+/* Structure that defines the BENCH-FS command line command, which measures
+ * file system throughput and latency. */
+static const CLI_Command_Definition_t xBENCH_FS =
+{
+    "bench-fs",        /* The command string to type. */
+    "\r\nbench-fs:\r\n Measures file system throughput and latency.  Existing files are left\r\n in place.\r\n",
+    prvBENCHFSCommand, /* The function to run. */
+    0                  /* No parameters are expected. */
+};
+
 /*-----------------------------------------------------------*/
 
 void vRegisterFileSystemCLICommands( void )
@@ -372,8 +473,17 @@ void vRegisterFileSystemCLICommands( void )
     FreeRTOS_CLIRegisterCommand( &xTRANSACT );
     FreeRTOS_CLIRegisterCommand( &xTRANSMASKGET );
     FreeRTOS_CLIRegisterCommand( &xTRANSMASKSET );
+    #if REDCONF_STATS == 1
+        FreeRTOS_CLIRegisterCommand( &xIOSTATS );
+        FreeRTOS_CLIRegisterCommand( &xIOSTATSRESET );
+    #endif
+    #if REDCONF_LATENCY_STATS == 1
+        FreeRTOS_CLIRegisterCommand( &xLATENCY );
+        FreeRTOS_CLIRegisterCommand( &xLATENCYRESET );
+    #endif
     FreeRTOS_CLIRegisterCommand( &xABORT );
     FreeRTOS_CLIRegisterCommand( &xTEST_FS );
+    FreeRTOS_CLIRegisterCommand( &xBENCH_FS );
 }
 /*-----------------------------------------------------------*/
 
@@ -382,7 +492,8 @@ static BaseType_t prvDIRCommand( char * pcWriteBuffer,
                                  const char * pcCommandString )
 {
     static REDDIR * pxDir = NULL;
-    REDDIRENT * pxDirent;
+    static REDDIRENT xDirents[ cliDIR_BATCH ];
+    static int32_t lDirentCount = 0, lDirentNext = 0;
     const char * pcParameter;
     BaseType_t xParameterStringLength, xReturn = pdFALSE;
 
@@ -409,22 +520,27 @@ static BaseType_t prvDIRCommand( char * pcWriteBuffer,
         /* This is the first time this function has been executed since the Dir
          * command was run.  Open the directory. */
         pxDir = red_opendir( pcParameter );
+        lDirentCount = 0;
+        lDirentNext = 0;
     }
 
     if( pxDir )
     {
-        /* red_readdir() returns NULL either on error or upon reaching the
-         * end of the directory.  Clear errno so these conditions can be
-         * distinguished. */
-        red_errno = 0;
-        pxDirent = red_readdir( pxDir );
+        /* The command prints one entry per call, but the entries are read
+         * from the file system several at a time. */
+        if( lDirentNext >= lDirentCount )
+        {
+            lDirentCount = red_readdirmulti( pxDir, xDirents, cliDIR_BATCH );
+            lDirentNext = 0;
+        }
 
-        if( pxDirent )
+        if( lDirentCount > 0 )
         {
-            prvCreateFileInfoString( pcWriteBuffer, pxDirent );
+            prvCreateFileInfoString( pcWriteBuffer, &xDirents[ lDirentNext ] );
+            lDirentNext++;
             xReturn = pdPASS;
         }
-        else if( red_errno == 0 )
+        else if( lDirentCount == 0 )
         {
             /* There are no more files.  Close the directory. */
             red_closedir( pxDir );
@@ -1430,6 +1546,226 @@ static BaseType_t prvTRANSMASKSETCommand( char * pcWriteBuffer,
 }
 /*-----------------------------------------------------------*/
 
+#if REDCONF_STATS == 1
+
+    static BaseType_t prvIOSTATSCommand( char * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const char * pcCommandString )
+    {
+        REDVOLSTATS xStats;
+        int32_t lStatus;
+
+        /* Avoid compiler warnings. */
+        ( void ) pcCommandString;
+
+        /* Ensure the buffer leaves space for the \r\n. */
+        configASSERT( xWriteBufferLen > ( strlen( cliNEW_LINE ) * 2 ) );
+        xWriteBufferLen -= strlen( cliNEW_LINE );
+
+        lStatus = red_getstats( "", &xStats, false );
+
+        if( lStatus == -1 )
+        {
+            snprintf( pcWriteBuffer, xWriteBufferLen, "Error %d querying I/O statistics.", ( int ) red_errno );
+        }
+        else
+        {
+            int iLen;
+
+            iLen = snprintf( pcWriteBuffer, xWriteBufferLen,
+                             "Buffer hits: %lu\r\n"
+                             "Buffer misses: %lu\r\n"
+                             "Buffer write-backs: %lu\r\n"
+                             "Read-ahead blocks: %lu\r\n"
+                             "Buffers held: %lu (%lu lost, %lu reserve overruns)\r\n"
+                             "Read requests: %lu (%llu sectors)\r\n"
+                             "Write requests: %lu (%llu sectors)\r\n"
+                             "Flush requests: %lu\r\n"
+                             "Discard requests: %lu (%llu sectors)\r\n"
+                             "Transactions: %lu (%llu us total, %lu us max)\r\n"
+                             "Allocator searches: %lu (%llu blocks scanned, %lu max)\r\n",
+                             ( unsigned long ) xStats.ulBufferHits, ( unsigned long ) xStats.ulBufferMisses,
+                             ( unsigned long ) xStats.ulBufferWritebacks, ( unsigned long ) xStats.ulReadAheadBlocks,
+                             ( unsigned long ) xStats.ulBuffersHeld, ( unsigned long ) xStats.ulBuffersLost,
+                             ( unsigned long ) xStats.ulReserveOverruns,
+                             ( unsigned long ) xStats.ulReadRequests, ( unsigned long long ) xStats.ullSectorsRead,
+                             ( unsigned long ) xStats.ulWriteRequests, ( unsigned long long ) xStats.ullSectorsWritten,
+                             ( unsigned long ) xStats.ulFlushRequests,
+                             ( unsigned long ) xStats.ulDiscardRequests, ( unsigned long long ) xStats.ullSectorsDiscarded,
+                             ( unsigned long ) xStats.ulTransactions, ( unsigned long long ) xStats.ullTransactMicrosec,
+                             ( unsigned long ) xStats.ulTransactMaxMicrosec,
+                             ( unsigned long ) xStats.ulAllocSearches, ( unsigned long long ) xStats.ullAllocScanBlocks,
+                             ( unsigned long ) xStats.ulAllocScanMax );
+
+            #if REDCONF_PATH_CACHE_ENTRIES > 0U
+                {
+                    REDPATHCACHESTATS xPathStats;
+
+                    if( ( iLen > 0 ) && ( ( size_t ) iLen < xWriteBufferLen ) && ( red_pathcachestats( &xPathStats, false ) == 0 ) )
+                    {
+                        snprintf( &pcWriteBuffer[ iLen ], xWriteBufferLen - ( size_t ) iLen,
+                                  "Path cache hits: %lu\r\n"
+                                  "Path cache misses: %lu\r\n",
+                                  ( unsigned long ) xPathStats.ulHits, ( unsigned long ) xPathStats.ulMisses );
+                    }
+                }
+            #else
+                ( void ) iLen;
+            #endif
+        }
+
+        strcat( pcWriteBuffer, cliNEW_LINE );
+
+        return pdFALSE;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvIOSTATSRESETCommand( char * pcWriteBuffer,
+                                              size_t xWriteBufferLen,
+                                              const char * pcCommandString )
+    {
+        REDVOLSTATS xStats;
+        int32_t lStatus;
+
+        /* Avoid compiler warnings. */
+        ( void ) pcCommandString;
+
+        /* This function assumes xWriteBufferLen is large enough! */
+        ( void ) xWriteBufferLen;
+
+        lStatus = red_getstats( "", &xStats, true );
+
+        #if REDCONF_PATH_CACHE_ENTRIES > 0U
+            if( lStatus == 0 )
+            {
+                REDPATHCACHESTATS xPathStats;
+
+                lStatus = red_pathcachestats( &xPathStats, true );
+            }
+        #endif
+
+        if( lStatus == -1 )
+        {
+            sprintf( pcWriteBuffer, "Error %d resetting I/O statistics.", ( int ) red_errno );
+        }
+        else
+        {
+            strcpy( pcWriteBuffer, "I/O statistics reset." );
+        }
+
+        strcat( pcWriteBuffer, cliNEW_LINE );
+
+        return pdFALSE;
+    }
+/*-----------------------------------------------------------*/
+#endif /* REDCONF_STATS == 1 */
+
+#if REDCONF_LATENCY_STATS == 1
+
+    static BaseType_t prvLATENCYCommand( char * pcWriteBuffer,
+                                         size_t xWriteBufferLen,
+                                         const char * pcCommandString )
+    {
+        static const char * const pcOpNames[ RED_LATOP_COUNT ] =
+        {
+            "open", "read", "write", "transact", "unlink", "readdir"
+        };
+        static REDLATSTATS xStats;
+        static uint32_t ulNextOp = RED_LATOP_COUNT;
+        BaseType_t xReturn = pdFALSE;
+
+        /* Avoid compiler warnings. */
+        ( void ) pcCommandString;
+
+        /* Ensure the buffer leaves space for the \r\n. */
+        configASSERT( xWriteBufferLen > ( strlen( cliNEW_LINE ) * 2 ) );
+        xWriteBufferLen -= strlen( cliNEW_LINE );
+
+        /* The command prints one call's histogram per call, all taken from the
+         * snapshot made by the first call. */
+        if( ulNextOp >= RED_LATOP_COUNT )
+        {
+            if( red_latencystats( &xStats, false ) == 0 )
+            {
+                ulNextOp = 0;
+            }
+            else
+            {
+                snprintf( pcWriteBuffer, xWriteBufferLen, "Error %d querying latency statistics.", ( int ) red_errno );
+            }
+        }
+
+        if( ulNextOp < RED_LATOP_COUNT )
+        {
+            const REDLATHIST * pxHist = &xStats.aOp[ ulNextOp ];
+            uint32_t ulBucket;
+            int iLen;
+
+            iLen = snprintf( pcWriteBuffer, xWriteBufferLen,
+                             "%s: %lu calls, avg %lu us, p50 %lu us, p90 %lu us, p99 %lu us, p99.9 %lu us, max %lu us\r\n",
+                             pcOpNames[ ulNextOp ], ( unsigned long ) pxHist->ulCalls,
+                             ( unsigned long ) ( ( pxHist->ulCalls == 0U ) ? 0U : ( pxHist->ullTotalMicrosec / pxHist->ulCalls ) ),
+                             ( unsigned long ) red_latencypercentile( pxHist, 500U ),
+                             ( unsigned long ) red_latencypercentile( pxHist, 900U ),
+                             ( unsigned long ) red_latencypercentile( pxHist, 990U ),
+                             ( unsigned long ) red_latencypercentile( pxHist, 999U ),
+                             ( unsigned long ) pxHist->ulMaxMicrosec );
+
+            /* List the non-empty buckets by their upper bound. */
+            for( ulBucket = 0U; ulBucket < RED_LAT_BUCKETS; ulBucket++ )
+            {
+                if( ( iLen <= 0 ) || ( ( size_t ) iLen >= xWriteBufferLen ) )
+                {
+                    break;
+                }
+
+                if( pxHist->aulBuckets[ ulBucket ] != 0U )
+                {
+                    iLen += snprintf( &pcWriteBuffer[ iLen ], xWriteBufferLen - ( size_t ) iLen, " %s%lu:%lu",
+                                      ( ulBucket == ( RED_LAT_BUCKETS - 1U ) ) ? ">=" : "<",
+                                      ( unsigned long ) ( ( ulBucket == ( RED_LAT_BUCKETS - 1U ) ) ? ( 1UL << ( ulBucket - 1U ) ) : ( 1UL << ulBucket ) ),
+                                      ( unsigned long ) pxHist->aulBuckets[ ulBucket ] );
+                }
+            }
+
+            ulNextOp++;
+            xReturn = ( ulNextOp < RED_LATOP_COUNT ) ? pdTRUE : pdFALSE;
+        }
+
+        strcat( pcWriteBuffer, cliNEW_LINE );
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvLATENCYRESETCommand( char * pcWriteBuffer,
+                                              size_t xWriteBufferLen,
+                                              const char * pcCommandString )
+    {
+        REDLATSTATS xStats;
+
+        /* Avoid compiler warnings. */
+        ( void ) pcCommandString;
+
+        /* This function assumes xWriteBufferLen is large enough! */
+        ( void ) xWriteBufferLen;
+
+        if( red_latencystats( &xStats, true ) == -1 )
+        {
+            sprintf( pcWriteBuffer, "Error %d resetting latency statistics.", ( int ) red_errno );
+        }
+        else
+        {
+            strcpy( pcWriteBuffer, "Latency statistics reset." );
+        }
+
+        strcat( pcWriteBuffer, cliNEW_LINE );
+
+        return pdFALSE;
+    }
+/*-----------------------------------------------------------*/
+#endif /* REDCONF_LATENCY_STATS == 1 */
+
 static BaseType_t prvABORTCommand( char * pcWriteBuffer,
                                    size_t xWriteBufferLen,
                                    const char * pcCommandString )
@@ -1541,6 +1877,45 @@ static BaseType_t prvTESTFSCommand( char * pcWriteBuffer,
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvBENCHFSCommand( char * pcWriteBuffer,
+                                     size_t xWriteBufferLen,
+                                     const char * pcCommandString )
+{
+    UBaseType_t uxOriginalPriority;
+    FSBENCHPARAM param;
+
+    /* Avoid compiler warnings. */
+    ( void ) xWriteBufferLen;
+    ( void ) pcCommandString;
+
+    /* As with test-fs, raise the priority so that the idle task hook does not
+     * distort the measurements. */
+    uxOriginalPriority = uxTaskPriorityGet( NULL );
+    vTaskPrioritySet( NULL, configMAX_PRIORITIES - 1 );
+
+    /* The benchmark works in its own directory and removes it afterwards, so
+     * there is no need to format the volume. */
+    FsBenchDefaultParams( &param );
+    param.pszVolume = "";
+
+    if( FsBenchStart( &param ) == 0 )
+    {
+        sprintf( pcWriteBuffer, "%s", "Benchmark results were sent to Windows console" );
+    }
+    else
+    {
+        sprintf( pcWriteBuffer, "%s", "Benchmark failed, see Windows console" );
+    }
+
+    /* Reset back to the original priority. */
+    vTaskPrioritySet( NULL, uxOriginalPriority );
+
+    strcat( pcWriteBuffer, cliNEW_LINE );
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvPerformCopy( int32_t lSourceFildes,
                                   int32_t lDestinationFiledes,
                                   char * pxWriteBuffer,
@@ -317,4 +317,14 @@ extern void vLoggingPrintf( const char * pcFormatString,
 
 #define ipconfigETHERNET_DRIVER_FILTERS_PACKETS    ( 1 )
 
+/* Define the trace macros of the stack as counters, see ip_trace_stats.h.
+ * This is last so that the macros defined above take precedence. */
+#ifndef projIP_TRACE_STATS
+    #define projIP_TRACE_STATS    0
+#endif
+
+#if ( projIP_TRACE_STATS == 1 )
+    #include "ip_trace_stats.h"
+#endif
+
 #endif /* FREERTOS_IP_CONFIG_H */
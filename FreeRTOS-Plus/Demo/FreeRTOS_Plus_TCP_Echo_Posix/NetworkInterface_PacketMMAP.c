@@ -0,0 +1,560 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A FreeRTOS+TCP network interface for the Linux simulator that exchanges raw
+ * Ethernet frames with a host interface, such as a TAP device, through
+ * AF_PACKET rings that are shared with the kernel by mmap().  It is selected
+ * with "make NETIF=packet_mmap", and needs CAP_NET_RAW.
+ *
+ * Receive uses a TPACKET_V3 ring.  The kernel fills whole blocks of frames and
+ * hands a block over when it is full or niRX_BLOCK_TIMEOUT_MS after its first
+ * frame, so the MAC task handles frames a block at a time, straight from the
+ * shared memory and without a system call per frame.
+ *
+ * Transmit uses a TPACKET_V2 ring on a second socket.  pfOutput only copies
+ * the frame into the next free slot and marks it ready.  A single send() then
+ * passes every ready slot to the kernel.  That happens when niTX_BATCH frames
+ * are waiting, or when the MAC task next runs.  The MAC task runs below the
+ * IP task, so that is once the IP task has finished its current burst of
+ * work.
+ *
+ * The only copies are between the rings and the network buffers.  The rings
+ * are only accessed by FreeRTOS tasks, so no Linux threads or signals are
+ * involved.  The MAC task polls the receive ring every tick while both rings
+ * are idle.
+ */
+
+/* Standard includes. */
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+#include "FreeRTOS_Routing.h"
+
+/* The host interface to attach to, for example a TAP device created with
+ * "ip tuntap add tap0 mode tap". */
+#ifndef niINTERFACE_NAME
+    #define niINTERFACE_NAME         "tap0"
+#endif
+
+/* The receive ring is niRX_BLOCK_COUNT blocks of niRX_BLOCK_SIZE bytes. */
+#ifndef niRX_BLOCK_SIZE
+    #define niRX_BLOCK_SIZE          ( 1U << 17 )
+#endif
+#ifndef niRX_BLOCK_COUNT
+    #define niRX_BLOCK_COUNT         32U
+#endif
+
+/* The longest a partly filled receive block is kept by the kernel. */
+#ifndef niRX_BLOCK_TIMEOUT_MS
+    #define niRX_BLOCK_TIMEOUT_MS    1U
+#endif
+
+/* The transmit ring is niTX_FRAME_COUNT slots of niFRAME_SIZE bytes. */
+#ifndef niTX_FRAME_COUNT
+    #define niTX_FRAME_COUNT         256U
+#endif
+
+/* Frames written to the transmit ring before it is flushed without waiting
+ * for the MAC task. */
+#ifndef niTX_BATCH
+    #define niTX_BATCH               32U
+#endif
+
+#ifndef niMAC_TASK_PRIORITY
+    #define niMAC_TASK_PRIORITY      ( ipconfigIP_TASK_PRIORITY - 1 )
+#endif
+
+/* Room for a frame and the packet header in a ring slot. */
+#define niFRAME_SIZE                 2048U
+
+/* Transmit slots per transmit ring block, which must be a multiple of the page
+ * size. */
+#define niTX_FRAMES_PER_BLOCK        32U
+
+/* Where the frame starts in a transmit slot. */
+#define niTX_DATA_OFFSET             TPACKET_ALIGN( sizeof( struct tpacket2_hdr ) )
+
+/* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
+ * driver will filter incoming packets and only pass the stack those packets it
+ * considers need processing. */
+#if ( ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES == 0 )
+    #define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer )    eProcessBuffer
+#else
+    #define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer )    eConsiderFrameForProcessing( ( pucEthernetBuffer ) )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Open an AF_PACKET socket on the host interface with a ring of the given
+ * version, map the ring, and return the socket, or -1 on failure.
+ */
+static int prvOpenRingSocket( unsigned int uxInterfaceIndex,
+                              int iVersion,
+                              int iRingOption,
+                              const void * pvRequest,
+                              socklen_t xRequestLength,
+                              size_t uxRingSize,
+                              uint8_t ** ppucRing );
+
+/*
+ * Pass every frame of the next receive block to the IP task, if the kernel
+ * has handed the block over.  Returns pdTRUE if there was such a block.
+ */
+static BaseType_t prvReceiveBlock( void );
+
+/*
+ * Pass a received frame to the IP task.
+ */
+static void prvPassFrameToStack( const uint8_t * pucFrame,
+                                 size_t uxLength );
+
+/*
+ * Ask the kernel to send every ready transmit slot.
+ */
+static void prvFlushTransmitRing( void );
+
+/*
+ * Receives frames and flushes the transmit ring, as described at the top of
+ * the file.
+ */
+static void prvMACTask( void * pvParameters );
+
+static BaseType_t xPacketMMAP_NetworkInterfaceInitialise( NetworkInterface_t * pxInterface );
+static BaseType_t xPacketMMAP_NetworkInterfaceOutput( NetworkInterface_t * pxInterface,
+                                                      NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                                      BaseType_t bReleaseAfterSend );
+static BaseType_t xPacketMMAP_GetPhyLinkStatus( NetworkInterface_t * pxInterface );
+
+NetworkInterface_t * pxPacketMMAP_FillInterfaceDescriptor( BaseType_t xEMACIndex,
+                                                           NetworkInterface_t * pxInterface );
+
+/*-----------------------------------------------------------*/
+
+/* The interface the frames received are passed with. */
+static NetworkInterface_t * pxMyInterface = NULL;
+
+static int iRxSocket = -1;
+static int iTxSocket = -1;
+
+static uint8_t * pucRxRing = NULL;
+static uint8_t * pucTxRing = NULL;
+
+static struct tpacket_req3 xRxRequest;
+static struct tpacket_req xTxRequest;
+
+static uint32_t ulNextRxBlock = 0;
+static uint32_t ulNextTxFrame = 0;
+
+/* Transmit slots marked ready since the last flush. */
+static volatile uint32_t ulTxPending = 0;
+
+static TaskHandle_t xMACTaskHandle = NULL;
+
+/* For viewing in the debugger only.  Transmit drops are frames for which
+ * there was no free slot. */
+static volatile uint32_t ulRxFrames = 0;
+static volatile uint32_t ulTxFrames = 0;
+static volatile uint32_t ulTxDrops = 0;
+static volatile uint32_t ulTxFailures = 0;
+
+/*-----------------------------------------------------------*/
+
+static int prvOpenRingSocket( unsigned int uxInterfaceIndex,
+                              int iVersion,
+                              int iRingOption,
+                              const void * pvRequest,
+                              socklen_t xRequestLength,
+                              size_t uxRingSize,
+                              uint8_t ** ppucRing )
+{
+    struct sockaddr_ll xAddress;
+    void * pvRing;
+    int iSocket;
+
+    /* The transmit socket does not need to receive anything. */
+    iSocket = socket( AF_PACKET, SOCK_RAW, ( iRingOption == PACKET_RX_RING ) ? htons( ETH_P_ALL ) : 0 );
+
+    if( iSocket < 0 )
+    {
+        FreeRTOS_printf( ( "PacketMMAP: socket() failed: %s\n", strerror( errno ) ) );
+        return -1;
+    }
+
+    /* The ring must be set up before binding, so no frame is received
+     * outside it. */
+    if( ( setsockopt( iSocket, SOL_PACKET, PACKET_VERSION, &iVersion, sizeof( iVersion ) ) != 0 ) ||
+        ( setsockopt( iSocket, SOL_PACKET, iRingOption, pvRequest, xRequestLength ) != 0 ) )
+    {
+        FreeRTOS_printf( ( "PacketMMAP: ring setup failed: %s\n", strerror( errno ) ) );
+        close( iSocket );
+        return -1;
+    }
+
+    pvRing = mmap( NULL, uxRingSize, PROT_READ | PROT_WRITE, MAP_SHARED, iSocket, 0 );
+
+    if( pvRing == MAP_FAILED )
+    {
+        FreeRTOS_printf( ( "PacketMMAP: mmap() failed: %s\n", strerror( errno ) ) );
+        close( iSocket );
+        return -1;
+    }
+
+    memset( &xAddress, '\0', sizeof( xAddress ) );
+    xAddress.sll_family = AF_PACKET;
+    xAddress.sll_protocol = ( iRingOption == PACKET_RX_RING ) ? htons( ETH_P_ALL ) : 0;
+    xAddress.sll_ifindex = ( int ) uxInterfaceIndex;
+
+    if( bind( iSocket, ( struct sockaddr * ) &xAddress, sizeof( xAddress ) ) != 0 )
+    {
+        FreeRTOS_printf( ( "PacketMMAP: bind() failed: %s\n", strerror( errno ) ) );
+        munmap( pvRing, uxRingSize );
+        close( iSocket );
+        return -1;
+    }
+
+    *ppucRing = ( uint8_t * ) pvRing;
+
+    return iSocket;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t xPacketMMAP_NetworkInterfaceInitialise( NetworkInterface_t * pxInterface )
+{
+    struct packet_mreq xMembership;
+    unsigned int uxInterfaceIndex;
+
+    ( void ) pxInterface;
+
+    if( iRxSocket >= 0 )
+    {
+        /* Already open. */
+        return pdPASS;
+    }
+
+    uxInterfaceIndex = if_nametoindex( niINTERFACE_NAME );
+
+    if( uxInterfaceIndex == 0U )
+    {
+        FreeRTOS_printf( ( "PacketMMAP: no interface named %s\n", niINTERFACE_NAME ) );
+        return pdFAIL;
+    }
+
+    memset( &xRxRequest, '\0', sizeof( xRxRequest ) );
+    xRxRequest.tp_block_size = niRX_BLOCK_SIZE;
+    xRxRequest.tp_block_nr = niRX_BLOCK_COUNT;
+    xRxRequest.tp_frame_size = niFRAME_SIZE;
+    xRxRequest.tp_frame_nr = ( niRX_BLOCK_SIZE / niFRAME_SIZE ) * niRX_BLOCK_COUNT;
+    xRxRequest.tp_retire_blk_tov = niRX_BLOCK_TIMEOUT_MS;
+
+    memset( &xTxRequest, '\0', sizeof( xTxRequest ) );
+    xTxRequest.tp_block_size = niFRAME_SIZE * niTX_FRAMES_PER_BLOCK;
+    xTxRequest.tp_block_nr = niTX_FRAME_COUNT / niTX_FRAMES_PER_BLOCK;
+    xTxRequest.tp_frame_size = niFRAME_SIZE;
+    xTxRequest.tp_frame_nr = niTX_FRAME_COUNT;
+
+    iRxSocket = prvOpenRingSocket( uxInterfaceIndex, TPACKET_V3, PACKET_RX_RING, &xRxRequest, sizeof( xRxRequest ),
+                                   ( size_t ) niRX_BLOCK_SIZE * niRX_BLOCK_COUNT, &pucRxRing );
+    iTxSocket = prvOpenRingSocket( uxInterfaceIndex, TPACKET_V2, PACKET_TX_RING, &xTxRequest, sizeof( xTxRequest ),
+                                   ( size_t ) niFRAME_SIZE * niTX_FRAME_COUNT, &pucTxRing );
+
+    if( ( iRxSocket < 0 ) || ( iTxSocket < 0 ) )
+    {
+        if( iRxSocket >= 0 )
+        {
+            munmap( pucRxRing, ( size_t ) niRX_BLOCK_SIZE * niRX_BLOCK_COUNT );
+            close( iRxSocket );
+            iRxSocket = -1;
+        }
+
+        if( iTxSocket >= 0 )
+        {
+            munmap( pucTxRing, ( size_t ) niFRAME_SIZE * niTX_FRAME_COUNT );
+            close( iTxSocket );
+            iTxSocket = -1;
+        }
+
+        return pdFAIL;
+    }
+
+    /* The MAC and IP addresses are simulated, so receive frames for any
+     * address. */
+    memset( &xMembership, '\0', sizeof( xMembership ) );
+    xMembership.mr_ifindex = ( int ) uxInterfaceIndex;
+    xMembership.mr_type = PACKET_MR_PROMISC;
+
+    if( setsockopt( iRxSocket, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &xMembership, sizeof( xMembership ) ) != 0 )
+    {
+        FreeRTOS_printf( ( "PacketMMAP: promiscuous mode failed: %s\n", strerror( errno ) ) );
+    }
+
+    FreeRTOS_printf( ( "PacketMMAP: attached to %s\n", niINTERFACE_NAME ) );
+
+    xTaskCreate( prvMACTask, "MAC_ISR", configMINIMAL_STACK_SIZE, NULL, niMAC_TASK_PRIORITY, &xMACTaskHandle );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlushTransmitRing( void )
+{
+    ssize_t xResult;
+
+    if( ulTxPending != 0U )
+    {
+        ulTxPending = 0U;
+
+        do
+        {
+            /* Sends every slot marked TP_STATUS_SEND_REQUEST. */
+            xResult = send( iTxSocket, NULL, 0, MSG_DONTWAIT );
+        } while( ( xResult < 0 ) && ( errno == EINTR ) );
+
+        if( ( xResult < 0 ) && ( errno != EAGAIN ) && ( errno != ENOBUFS ) )
+        {
+            ulTxFailures++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t xPacketMMAP_NetworkInterfaceOutput( NetworkInterface_t * pxInterface,
+                                                      NetworkBufferDescriptor_t * const pxNetworkBuffer,
+                                                      BaseType_t bReleaseAfterSend )
+{
+    struct tpacket2_hdr * pxSlot;
+
+    ( void ) pxInterface;
+
+    iptraceNETWORK_INTERFACE_TRANSMIT();
+
+    pxSlot = ( struct tpacket2_hdr * ) &( pucTxRing[ ( size_t ) ulNextTxFrame * niFRAME_SIZE ] );
+
+    if( ( iTxSocket >= 0 ) &&
+        ( pxNetworkBuffer->xDataLength <= ( niFRAME_SIZE - niTX_DATA_OFFSET ) ) &&
+        ( ( __atomic_load_n( &( pxSlot->tp_status ), __ATOMIC_ACQUIRE ) & ( TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING ) ) == 0U ) )
+    {
+        /* The packets sent will be written to a C source file,
+         * only if 'ipconfigUSE_DUMP_PACKETS' is defined.
+         * Otherwise, there is no action. */
+        iptraceDUMP_PACKET( pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength, pdFALSE );
+
+        memcpy( ( ( uint8_t * ) pxSlot ) + niTX_DATA_OFFSET, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
+        pxSlot->tp_len = ( uint32_t ) pxNetworkBuffer->xDataLength;
+
+        /* The kernel may take the slot as soon as the status changes. */
+        __atomic_store_n( &( pxSlot->tp_status ), TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE );
+
+        ulNextTxFrame = ( ulNextTxFrame + 1U ) % niTX_FRAME_COUNT;
+        ulTxPending++;
+        ulTxFrames++;
+
+        if( ulTxPending >= niTX_BATCH )
+        {
+            prvFlushTransmitRing();
+        }
+        else
+        {
+            /* The MAC task flushes the rest once the IP task blocks. */
+            xTaskNotifyGive( xMACTaskHandle );
+        }
+    }
+    else
+    {
+        ulTxDrops++;
+
+        /* The ring may be full because nothing was flushed yet. */
+        prvFlushTransmitRing();
+    }
+
+    /* The frame has been copied so the buffer can be released. */
+    if( bReleaseAfterSend != pdFALSE )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t xPacketMMAP_GetPhyLinkStatus( NetworkInterface_t * pxInterface )
+{
+    ( void ) pxInterface;
+
+    return ( iRxSocket >= 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+NetworkInterface_t * pxPacketMMAP_FillInterfaceDescriptor( BaseType_t xEMACIndex,
+                                                           NetworkInterface_t * pxInterface )
+{
+    static char pcName[ 17 ];
+
+    /* Make sure that the object pointed to by 'pxInterface' is declared static
+     * or global, and that it will remain to exist. */
+
+    pxMyInterface = pxInterface;
+
+    snprintf( pcName, sizeof( pcName ), "eth%ld", xEMACIndex );
+
+    memset( pxInterface, '\0', sizeof( *pxInterface ) );
+    pxInterface->pcName = pcName;                    /* Just for logging, debugging. */
+    pxInterface->pvArgument = ( void * ) xEMACIndex; /* Has only meaning for the driver functions. */
+    pxInterface->pfInitialise = xPacketMMAP_NetworkInterfaceInitialise;
+    pxInterface->pfOutput = xPacketMMAP_NetworkInterfaceOutput;
+    pxInterface->pfGetPhyLinkStatus = xPacketMMAP_GetPhyLinkStatus;
+
+    FreeRTOS_AddNetworkInterface( pxInterface );
+
+    return pxInterface;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPassFrameToStack( const uint8_t * pucFrame,
+                                 size_t uxLength )
+{
+    NetworkBufferDescriptor_t * pxNetworkBuffer;
+    IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
+
+    iptraceNETWORK_INTERFACE_RECEIVE();
+
+    if( ( uxLength < sizeof( EthernetHeader_t ) ) ||
+        ( uxLength > ipTOTAL_ETHERNET_FRAME_SIZE ) ||
+        ( ipCONSIDER_FRAME_FOR_PROCESSING( pucFrame ) != eProcessBuffer ) )
+    {
+        return;
+    }
+
+    pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxLength, 0 );
+
+    if( pxNetworkBuffer == NULL )
+    {
+        iptraceETHERNET_RX_EVENT_LOST();
+        return;
+    }
+
+    memcpy( pxNetworkBuffer->pucEthernetBuffer, pucFrame, uxLength );
+    pxNetworkBuffer->xDataLength = uxLength;
+    pxNetworkBuffer->pxInterface = pxMyInterface;
+    pxNetworkBuffer->pxEndPoint = FreeRTOS_MatchingEndpoint( pxMyInterface, pxNetworkBuffer->pucEthernetBuffer );
+
+    if( pxNetworkBuffer->pxEndPoint == NULL )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+        return;
+    }
+
+    xRxEvent.pvData = ( void * ) pxNetworkBuffer;
+
+    if( xSendEventStructToIPTask( &xRxEvent, ( TickType_t ) 0 ) == pdFAIL )
+    {
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+        iptraceETHERNET_RX_EVENT_LOST();
+    }
+    else
+    {
+        ulRxFrames++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReceiveBlock( void )
+{
+    struct tpacket_block_desc * pxBlock;
+    struct tpacket3_hdr * pxFrame;
+    const struct sockaddr_ll * pxAddress;
+    uint32_t ulFrame;
+
+    pxBlock = ( struct tpacket_block_desc * ) &( pucRxRing[ ( size_t ) ulNextRxBlock * niRX_BLOCK_SIZE ] );
+
+    if( ( __atomic_load_n( &( pxBlock->hdr.bh1.block_status ), __ATOMIC_ACQUIRE ) & TP_STATUS_USER ) == 0U )
+    {
+        return pdFALSE;
+    }
+
+    pxFrame = ( struct tpacket3_hdr * ) ( ( ( uint8_t * ) pxBlock ) + pxBlock->hdr.bh1.offset_to_first_pkt );
+
+    for( ulFrame = 0; ulFrame < pxBlock->hdr.bh1.num_pkts; ulFrame++ )
+    {
+        pxAddress = ( const struct sockaddr_ll * ) ( ( ( uint8_t * ) pxFrame ) + TPACKET_ALIGN( sizeof( struct tpacket3_hdr ) ) );
+
+        /* The frames sent through the transmit socket are seen here too. */
+        if( pxAddress->sll_pkttype != PACKET_OUTGOING )
+        {
+            prvPassFrameToStack( ( ( const uint8_t * ) pxFrame ) + pxFrame->tp_mac, ( size_t ) pxFrame->tp_snaplen );
+        }
+
+        pxFrame = ( struct tpacket3_hdr * ) ( ( ( uint8_t * ) pxFrame ) + pxFrame->tp_next_offset );
+    }
+
+    /* Hand the block back to the kernel. */
+    __atomic_store_n( &( pxBlock->hdr.bh1.block_status ), TP_STATUS_KERNEL, __ATOMIC_RELEASE );
+    ulNextRxBlock = ( ulNextRxBlock + 1U ) % niRX_BLOCK_COUNT;
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMACTask( void * pvParameters )
+{
+    BaseType_t xReceived;
+
+    /* Remove compiler warnings about unused parameters. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Send what the IP task queued before it blocked. */
+        prvFlushTransmitRing();
+
+        xReceived = prvReceiveBlock();
+
+        if( xReceived == pdFALSE )
+        {
+            /* Nothing to receive, so wait for a frame to be queued for
+             * transmission, or poll again on the next tick. */
+            ( void ) ulTaskNotifyTake( pdTRUE, 1 );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
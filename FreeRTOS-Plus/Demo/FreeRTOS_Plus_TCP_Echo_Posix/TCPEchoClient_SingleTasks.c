@@ -34,17 +34,28 @@
  * See the following web page for essential demo usage and configuration
  * details:
  * https://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_TCP/examples_FreeRTOS_simulator.html
+ *
+ * When configECHO_BENCHMARK is set to 1 (e.g. "make BENCHMARK=1"), the tasks
+ * measure the stack instead: the rate of connections, the round trip times
+ * of configECHO_BENCHMARK_MESSAGE_SIZE byte messages, the bulk throughput and
+ * the CPU time used per MB.  All configECHO_BENCHMARK_CLIENTS tasks run each
+ * phase at the same time, and the results are printed as lines that start
+ * with "BENCH", followed by "BENCH done".  echo_benchmark.py runs the demo
+ * against an echo server on the host and compares the results to a baseline.
  */
 
 /* Standard includes. */
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "event_groups.h"
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
@@ -68,8 +79,48 @@
     #define echoBUFFER_SIZE_MULTIPLIER    ( 3 )
     #define echoBUFFER_SIZES              ( ipconfigTCP_MSS * echoBUFFER_SIZE_MULTIPLIER )
 
+/* Set to 1 to measure the performance of the stack, see the top of this
+ * file. */
+    #ifndef configECHO_BENCHMARK
+        #define configECHO_BENCHMARK    0
+    #endif
+
+    #if ( configECHO_BENCHMARK == 1 )
+
+/* The number of client tasks that run the benchmark concurrently, at most 24,
+ * the number of bits in an event group. */
+        #ifndef configECHO_BENCHMARK_CLIENTS
+            #define configECHO_BENCHMARK_CLIENTS    ( 1 )
+        #endif
+
+/* The size of the messages sent in the latency and throughput phases. */
+        #ifndef configECHO_BENCHMARK_MESSAGE_SIZE
+            #define configECHO_BENCHMARK_MESSAGE_SIZE    ( 1024 )
+        #endif
+
+/* The number of connections each task opens and closes in the first phase. */
+        #ifndef configECHO_BENCHMARK_CONNECTIONS
+            #define configECHO_BENCHMARK_CONNECTIONS    ( 100 )
+        #endif
+
+/* The number of messages that each task sends and waits for in the latency
+ * phase. */
+        #ifndef configECHO_BENCHMARK_ROUND_TRIPS
+            #define configECHO_BENCHMARK_ROUND_TRIPS    ( 1000 )
+        #endif
+
+/* The number of bytes each task streams to the echo server in the throughput
+ * phase, while it receives the echo. */
+        #ifndef configECHO_BENCHMARK_BULK_BYTES
+            #define configECHO_BENCHMARK_BULK_BYTES    ( 8UL * 1024UL * 1024UL )
+        #endif
+
+        #define echoNUM_ECHO_CLIENTS    configECHO_BENCHMARK_CLIENTS
+    #else
+
 /* The number of instances of the echo client task to create. */
-    #define echoNUM_ECHO_CLIENTS          ( 1 )
+        #define echoNUM_ECHO_CLIENTS    ( 1 )
+    #endif /* configECHO_BENCHMARK */
 
 /*-----------------------------------------------------------*/
 
@@ -85,6 +136,56 @@
     static BaseType_t prvCreateTxData( char * ucBuffer,
                                        uint32_t ulBufferLength );
 
+    #if ( configECHO_BENCHMARK == 1 )
+
+/*
+ * Runs the benchmark phases, instead of prvEchoClientTask().
+ */
+        static void prvBenchmarkTask( void * pvParameters );
+
+/*
+ * Create a socket and connect it to the echo server.  Returns
+ * FREERTOS_INVALID_SOCKET when the connection can not be made.
+ */
+        static Socket_t prvBenchmarkConnect( void );
+
+/*
+ * Shut a connection down gracefully, and close the socket.
+ */
+        static void prvBenchmarkClose( Socket_t xSocket );
+
+/*
+ * The three phases.  Each returns pdPASS when the echo server answered as
+ * expected.
+ */
+        static BaseType_t prvBenchmarkConnections( BaseType_t xInstance );
+        static BaseType_t prvBenchmarkLatency( BaseType_t xInstance );
+        static BaseType_t prvBenchmarkThroughput( BaseType_t xInstance );
+
+/*
+ * Wait until all benchmark tasks have reached the same point.
+ */
+        static void prvBenchmarkSync( BaseType_t xInstance );
+
+/*
+ * Print the results of all tasks, called by the first task.
+ */
+        static void prvBenchmarkReport( void );
+
+/*
+ * Print the counters and levels of the stack, and write its snapshot next to
+ * the binary, see ip_trace_stats.h.
+ */
+        #if ( projIP_TRACE_STATS == 1 )
+            static void prvIPTraceStatsReport( void );
+        #endif
+
+/*
+ * Time, in microseconds, from CLOCK_MONOTONIC or CLOCK_PROCESS_CPUTIME_ID.
+ */
+        static uint64_t ullBenchmarkTime( clockid_t xClock );
+    #endif /* configECHO_BENCHMARK */
+
 /*-----------------------------------------------------------*/
 
 /* Rx and Tx time outs are used to ensure the sockets do not wait too long for
@@ -101,6 +202,29 @@
     static char cTxBuffers[ echoNUM_ECHO_CLIENTS ][ echoBUFFER_SIZES ],
                 cRxBuffers[ echoNUM_ECHO_CLIENTS ][ echoBUFFER_SIZES ];
 
+    #if ( configECHO_BENCHMARK == 1 )
+
+/* The results of one task. */
+        typedef struct xBENCHMARK_RESULT
+        {
+            BaseType_t xPassed;     /* pdPASS when all phases succeeded. */
+            uint32_t ulConnections; /* Connections made in the first phase. */
+            uint64_t ullBulkBytes;  /* Bytes echoed in the throughput phase. */
+            uint32_t ulRoundTrips;  /* Valid entries in ulRoundTripUs[]. */
+            uint32_t ulRoundTripUs[ configECHO_BENCHMARK_ROUND_TRIPS ];
+        } BenchmarkResult_t;
+
+        static BenchmarkResult_t xBenchmarkResults[ echoNUM_ECHO_CLIENTS ];
+
+/* Used by prvBenchmarkSync() to let the tasks start every phase together. */
+        static EventGroupHandle_t xBenchmarkSync;
+
+/* Wall clock and CPU time at the start and end of each phase, recorded by the
+ * first task. */
+        static uint64_t ullPhaseStart, ullPhaseCpuStart;
+        static uint64_t ullConnectTime, ullLatencyTime, ullBulkTime, ullBulkCpuTime;
+    #endif /* configECHO_BENCHMARK */
+
 /*-----------------------------------------------------------*/
 
     void vStartTCPEchoClientTasks_SingleTasks( configSTACK_DEPTH_TYPE uxTaskStackSize,
@@ -108,11 +232,22 @@
     {
         BaseType_t x;
 
+        #if ( configECHO_BENCHMARK == 1 )
+        {
+            xBenchmarkSync = xEventGroupCreate();
+            configASSERT( xBenchmarkSync != NULL );
+        }
+        #endif
+
         /* Create the echo client tasks. */
         for( x = 0; x < echoNUM_ECHO_CLIENTS; x++ )
         {
             xTaskCreate(
-                prvEchoClientTask, /* The function that implements the task. */
+                #if ( configECHO_BENCHMARK == 1 )
+                    prvBenchmarkTask,  /* The function that runs the benchmark. */
+                #else
+                    prvEchoClientTask, /* The function that implements the task. */
+                #endif
                 "Echo0",           /* Just a text name for the task to aid debugging. */
                 uxTaskStackSize,   /* The stack size is defined in FreeRTOSIPConfig.h. */
                 ( void * ) x,      /* The task parameter, not used in this case. */
@@ -368,6 +503,431 @@
     }
 /*-----------------------------------------------------------*/
 
+    #if ( configECHO_BENCHMARK == 1 )
+
+        static void prvBenchmarkTask( void * pvParameters )
+        {
+            BaseType_t xInstance = ( BaseType_t ) pvParameters;
+            BenchmarkResult_t * pxResult = &( xBenchmarkResults[ xInstance ] );
+
+            pxResult->xPassed = pdPASS;
+
+            /* Phase 1: connections per second. */
+            prvBenchmarkSync( xInstance );
+
+            if( prvBenchmarkConnections( xInstance ) != pdPASS )
+            {
+                pxResult->xPassed = pdFAIL;
+            }
+
+            prvBenchmarkSync( xInstance );
+
+            /* Phase 2: round trip times of single messages. */
+            if( prvBenchmarkLatency( xInstance ) != pdPASS )
+            {
+                pxResult->xPassed = pdFAIL;
+            }
+
+            prvBenchmarkSync( xInstance );
+
+            /* Phase 3: throughput and CPU time of a bulk transfer. */
+            if( prvBenchmarkThroughput( xInstance ) != pdPASS )
+            {
+                pxResult->xPassed = pdFAIL;
+            }
+
+            prvBenchmarkSync( xInstance );
+
+            if( xInstance == 0 )
+            {
+                prvBenchmarkReport();
+            }
+
+            vTaskDelete( NULL );
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvBenchmarkSync( BaseType_t xInstance )
+        {
+            const EventBits_t xAllBits = ( EventBits_t ) ( ( 1UL << echoNUM_ECHO_CLIENTS ) - 1UL );
+            uint64_t ullNow;
+
+            ( void ) xEventGroupSync( xBenchmarkSync, ( EventBits_t ) ( 1UL << xInstance ), xAllBits, portMAX_DELAY );
+
+            /* The first task keeps time: a phase ends when the last task gets
+             * here, and the next one starts. */
+            if( xInstance == 0 )
+            {
+                static BaseType_t xPhase = 0;
+
+                ullNow = ullBenchmarkTime( CLOCK_MONOTONIC );
+
+                switch( xPhase )
+                {
+                    case 1:
+                        ullConnectTime = ullNow - ullPhaseStart;
+                        break;
+
+                    case 2:
+                        ullLatencyTime = ullNow - ullPhaseStart;
+                        break;
+
+                    case 3:
+                        ullBulkTime = ullNow - ullPhaseStart;
+                        ullBulkCpuTime = ullBenchmarkTime( CLOCK_PROCESS_CPUTIME_ID ) - ullPhaseCpuStart;
+                        break;
+
+                    default:
+                        break;
+                }
+
+                xPhase++;
+                ullPhaseStart = ullNow;
+                ullPhaseCpuStart = ullBenchmarkTime( CLOCK_PROCESS_CPUTIME_ID );
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static Socket_t prvBenchmarkConnect( void )
+        {
+            Socket_t xSocket;
+            struct freertos_sockaddr xEchoServerAddress;
+            WinProperties_t xWinProps;
+
+            memset( &xEchoServerAddress, 0, sizeof( xEchoServerAddress ) );
+            xEchoServerAddress.sin_port = FreeRTOS_htons( echoECHO_PORT );
+            xEchoServerAddress.sin_family = FREERTOS_AF_INET;
+
+            #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+            {
+                xEchoServerAddress.sin_address.ulIP_IPv4 = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+                                                                                     configECHO_SERVER_ADDR1,
+                                                                                     configECHO_SERVER_ADDR2,
+                                                                                     configECHO_SERVER_ADDR3 );
+            }
+            #else
+            {
+                xEchoServerAddress.sin_addr = FreeRTOS_inet_addr_quick( configECHO_SERVER_ADDR0,
+                                                                        configECHO_SERVER_ADDR1,
+                                                                        configECHO_SERVER_ADDR2,
+                                                                        configECHO_SERVER_ADDR3 );
+            }
+            #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+            /* The same buffer and window sizes as the echo client. */
+            xWinProps.lTxBufSize = 6 * ipconfigTCP_MSS;
+            xWinProps.lTxWinSize = 3;
+            xWinProps.lRxBufSize = 6 * ipconfigTCP_MSS;
+            xWinProps.lRxWinSize = 3;
+
+            xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+            if( xSocket != FREERTOS_INVALID_SOCKET )
+            {
+                FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+                FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &xSendTimeOut, sizeof( xSendTimeOut ) );
+                FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_WIN_PROPERTIES, ( void * ) &xWinProps, sizeof( xWinProps ) );
+
+                if( FreeRTOS_connect( xSocket, &xEchoServerAddress, sizeof( xEchoServerAddress ) ) != 0 )
+                {
+                    FreeRTOS_closesocket( xSocket );
+                    xSocket = FREERTOS_INVALID_SOCKET;
+                }
+            }
+
+            return xSocket;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvBenchmarkClose( Socket_t xSocket )
+        {
+            TickType_t xTimeOnEntering;
+            char cBuffer[ 64 ];
+
+            /* Initiate a graceful close: FIN, FIN+ACK, ACK, and expect
+             * FreeRTOS_recv() to return an error once it is complete. */
+            FreeRTOS_shutdown( xSocket, FREERTOS_SHUT_RDWR );
+            xTimeOnEntering = xTaskGetTickCount();
+
+            do
+            {
+                if( FreeRTOS_recv( xSocket, cBuffer, sizeof( cBuffer ), 0 ) < 0 )
+                {
+                    break;
+                }
+            } while( ( xTaskGetTickCount() - xTimeOnEntering ) < xReceiveTimeOut );
+
+            FreeRTOS_closesocket( xSocket );
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvBenchmarkConnections( BaseType_t xInstance )
+        {
+            BenchmarkResult_t * pxResult = &( xBenchmarkResults[ xInstance ] );
+            BaseType_t xResult = pdPASS;
+            uint32_t ulCount;
+            Socket_t xSocket;
+
+            for( ulCount = 0; ulCount < configECHO_BENCHMARK_CONNECTIONS; ulCount++ )
+            {
+                xSocket = prvBenchmarkConnect();
+
+                if( xSocket == FREERTOS_INVALID_SOCKET )
+                {
+                    xResult = pdFAIL;
+                    break;
+                }
+
+                ulConnections[ xInstance ]++;
+                pxResult->ulConnections++;
+                prvBenchmarkClose( xSocket );
+            }
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvBenchmarkLatency( BaseType_t xInstance )
+        {
+            BenchmarkResult_t * pxResult = &( xBenchmarkResults[ xInstance ] );
+            char * pcTxBuffer = &( cTxBuffers[ xInstance ][ 0 ] );
+            char * pcRxBuffer = &( cRxBuffers[ xInstance ][ 0 ] );
+            const BaseType_t xLength = FreeRTOS_min_int32( configECHO_BENCHMARK_MESSAGE_SIZE, echoBUFFER_SIZES );
+            BaseType_t xResult = pdFAIL;
+            BaseType_t xReceived, xReturned;
+            uint64_t ullStart;
+            uint32_t ulCount;
+            Socket_t xSocket;
+
+            xSocket = prvBenchmarkConnect();
+
+            if( xSocket != FREERTOS_INVALID_SOCKET )
+            {
+                xResult = pdPASS;
+                ( void ) prvCreateTxData( pcTxBuffer, echoBUFFER_SIZES );
+
+                for( ulCount = 0; ulCount < configECHO_BENCHMARK_ROUND_TRIPS; ulCount++ )
+                {
+                    /* Make every message unique. */
+                    memcpy( pcTxBuffer, &ulCount, sizeof( ulCount ) );
+
+                    ullStart = ullBenchmarkTime( CLOCK_MONOTONIC );
+
+                    if( FreeRTOS_send( xSocket, pcTxBuffer, xLength, 0 ) != xLength )
+                    {
+                        xResult = pdFAIL;
+                        break;
+                    }
+
+                    for( xReceived = 0; xReceived < xLength; xReceived += xReturned )
+                    {
+                        xReturned = FreeRTOS_recv( xSocket, &( pcRxBuffer[ xReceived ] ), xLength - xReceived, 0 );
+
+                        if( xReturned <= 0 )
+                        {
+                            /* An error, or a time out. */
+                            break;
+                        }
+                    }
+
+                    if( ( xReceived != xLength ) || ( memcmp( pcRxBuffer, pcTxBuffer, xLength ) != 0 ) )
+                    {
+                        ulTxRxFailures[ xInstance ]++;
+                        xResult = pdFAIL;
+                        break;
+                    }
+
+                    pxResult->ulRoundTripUs[ pxResult->ulRoundTrips++ ] = ( uint32_t ) ( ullBenchmarkTime( CLOCK_MONOTONIC ) - ullStart );
+                    ulTxRxCycles[ xInstance ]++;
+                }
+
+                prvBenchmarkClose( xSocket );
+            }
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvBenchmarkThroughput( BaseType_t xInstance )
+        {
+            BenchmarkResult_t * pxResult = &( xBenchmarkResults[ xInstance ] );
+            char * pcTxBuffer = &( cTxBuffers[ xInstance ][ 0 ] );
+            char * pcRxBuffer = &( cRxBuffers[ xInstance ][ 0 ] );
+            const BaseType_t xLength = FreeRTOS_min_int32( configECHO_BENCHMARK_MESSAGE_SIZE, echoBUFFER_SIZES );
+            uint64_t ullSent = 0, ullReceived = 0;
+            BaseType_t xResult = pdFAIL;
+            BaseType_t xReturned, xFlags;
+            Socket_t xSocket;
+
+            xSocket = prvBenchmarkConnect();
+
+            if( xSocket != FREERTOS_INVALID_SOCKET )
+            {
+                xResult = pdPASS;
+                ( void ) prvCreateTxData( pcTxBuffer, echoBUFFER_SIZES );
+
+                while( ullReceived < configECHO_BENCHMARK_BULK_BYTES )
+                {
+                    BaseType_t xSpace = FreeRTOS_tx_space( xSocket );
+
+                    /* Keep the TX stream filled, without blocking. */
+                    if( ( ullSent < configECHO_BENCHMARK_BULK_BYTES ) && ( xSpace > 0 ) )
+                    {
+                        BaseType_t xCount = FreeRTOS_min_int32( xLength, xSpace );
+
+                        xCount = ( BaseType_t ) FreeRTOS_min_uint32( ( uint32_t ) xCount, ( uint32_t ) ( configECHO_BENCHMARK_BULK_BYTES - ullSent ) );
+                        xReturned = FreeRTOS_send( xSocket, pcTxBuffer, xCount, FREERTOS_MSG_DONTWAIT );
+
+                        if( xReturned < 0 )
+                        {
+                            xResult = pdFAIL;
+                            break;
+                        }
+
+                        ullSent += ( uint64_t ) xReturned;
+                        xSpace -= xReturned;
+                    }
+
+                    /* Only block in recv() when there is nothing to send. */
+                    xFlags = ( ( ullSent < configECHO_BENCHMARK_BULK_BYTES ) && ( xSpace > 0 ) ) ? FREERTOS_MSG_DONTWAIT : 0;
+                    xReturned = FreeRTOS_recv( xSocket, pcRxBuffer, echoBUFFER_SIZES, xFlags );
+
+                    if( ( xReturned < 0 ) || ( ( xReturned == 0 ) && ( xFlags == 0 ) ) )
+                    {
+                        /* An error, or a time out. */
+                        xResult = pdFAIL;
+                        break;
+                    }
+
+                    ullReceived += ( uint64_t ) xReturned;
+                }
+
+                pxResult->ullBulkBytes = ullReceived;
+                prvBenchmarkClose( xSocket );
+            }
+
+            return xResult;
+        }
+/*-----------------------------------------------------------*/
+
+        static int prvCompareRoundTrips( const void * pvLeft,
+                                         const void * pvRight )
+        {
+            uint32_t ulLeft = *( ( const uint32_t * ) pvLeft );
+            uint32_t ulRight = *( ( const uint32_t * ) pvRight );
+
+            return ( ulLeft > ulRight ) - ( ulLeft < ulRight );
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvBenchmarkReport( void )
+        {
+            static uint32_t ulAllRoundTrips[ echoNUM_ECHO_CLIENTS * configECHO_BENCHMARK_ROUND_TRIPS ];
+            uint32_t ulCount = 0, ulConnectionCount = 0;
+            uint64_t ullBulkBytes = 0;
+            BaseType_t x, xPassed = pdPASS;
+            double dSeconds, dMegaBytes;
+
+            /* Pool the results of all tasks. */
+            for( x = 0; x < echoNUM_ECHO_CLIENTS; x++ )
+            {
+                memcpy( &( ulAllRoundTrips[ ulCount ] ), xBenchmarkResults[ x ].ulRoundTripUs, xBenchmarkResults[ x ].ulRoundTrips * sizeof( uint32_t ) );
+                ulCount += xBenchmarkResults[ x ].ulRoundTrips;
+                ulConnectionCount += xBenchmarkResults[ x ].ulConnections;
+                ullBulkBytes += xBenchmarkResults[ x ].ullBulkBytes;
+
+                if( xBenchmarkResults[ x ].xPassed != pdPASS )
+                {
+                    xPassed = pdFAIL;
+                }
+            }
+
+            printf( "BENCH clients %d\n", ( int ) echoNUM_ECHO_CLIENTS );
+            printf( "BENCH message_size %d\n", ( int ) configECHO_BENCHMARK_MESSAGE_SIZE );
+
+            dSeconds = ( double ) ullConnectTime / 1e6;
+            printf( "BENCH connections_per_sec %.1f\n", ( dSeconds > 0.0 ) ? ( double ) ulConnectionCount / dSeconds : 0.0 );
+
+            if( ulCount > 0 )
+            {
+                qsort( ulAllRoundTrips, ulCount, sizeof( ulAllRoundTrips[ 0 ] ), prvCompareRoundTrips );
+                printf( "BENCH rtt_us_p50 %u\n", ( unsigned ) ulAllRoundTrips[ ( ulCount * 50U ) / 100U ] );
+                printf( "BENCH rtt_us_p90 %u\n", ( unsigned ) ulAllRoundTrips[ ( ulCount * 90U ) / 100U ] );
+                printf( "BENCH rtt_us_p99 %u\n", ( unsigned ) ulAllRoundTrips[ ( ulCount * 99U ) / 100U ] );
+                printf( "BENCH rtt_us_max %u\n", ( unsigned ) ulAllRoundTrips[ ulCount - 1U ] );
+            }
+
+            dSeconds = ( double ) ullLatencyTime / 1e6;
+            printf( "BENCH round_trips_per_sec %.1f\n", ( dSeconds > 0.0 ) ? ( double ) ulCount / dSeconds : 0.0 );
+
+            dSeconds = ( double ) ullBulkTime / 1e6;
+            dMegaBytes = ( double ) ullBulkBytes / ( 1024.0 * 1024.0 );
+            printf( "BENCH bulk_mbit_per_sec %.2f\n", ( dSeconds > 0.0 ) ? ( dMegaBytes * 8.0 ) / dSeconds : 0.0 );
+            printf( "BENCH cpu_ms_per_mb %.2f\n", ( dMegaBytes > 0.0 ) ? ( ( double ) ullBulkCpuTime / 1e3 ) / dMegaBytes : 0.0 );
+
+            #if ( projIP_TRACE_STATS == 1 )
+                prvIPTraceStatsReport();
+            #endif
+
+            printf( "BENCH result %s\n", ( xPassed == pdPASS ) ? "pass" : "fail" );
+            printf( "BENCH done\n" );
+            fflush( stdout );
+        }
+/*-----------------------------------------------------------*/
+
+        #if ( projIP_TRACE_STATS == 1 )
+
+            static void prvIPTraceStatsReport( void )
+            {
+                static uint8_t ucSnapshot[ iptracestatsSNAPSHOT_MAX_LENGTH ];
+                IPTraceStatsLevels_t xLevels;
+                const char * pcName;
+                uint32_t ulValue;
+                UBaseType_t uxIndex;
+                size_t uxLength;
+                FILE * pxFile;
+
+                for( uxIndex = 0; xIPTraceStatsGetCounter( uxIndex, &pcName, &ulValue ) == pdPASS; uxIndex++ )
+                {
+                    printf( "BENCH ip_%s %u\n", pcName, ( unsigned ) ulValue );
+                }
+
+                vIPTraceStatsGetLevels( &xLevels );
+                printf( "BENCH ip_lowest_free_buffers %u\n", ( unsigned ) xLevels.ulLowestFreeBuffers );
+                printf( "BENCH ip_deepest_event_queue %u\n", ( unsigned ) xLevels.ulDeepestEventQueue );
+
+                if( xLevels.ulLatencyCount > 0U )
+                {
+                    printf( "BENCH ip_rx_latency_ticks_min %u\n", ( unsigned ) xLevels.ulLatencyMin );
+                    printf( "BENCH ip_rx_latency_ticks_max %u\n", ( unsigned ) xLevels.ulLatencyMax );
+                    printf( "BENCH ip_rx_latency_ticks_mean %.2f\n", ( double ) xLevels.ulLatencyTotal / ( double ) xLevels.ulLatencyCount );
+                }
+
+                uxLength = xIPTraceStatsSnapshot( ucSnapshot, sizeof( ucSnapshot ) );
+                pxFile = fopen( BUILD_DIR "/ip_trace_stats.bin", "wb" );
+
+                if( pxFile != NULL )
+                {
+                    ( void ) fwrite( ucSnapshot, 1, uxLength, pxFile );
+                    ( void ) fclose( pxFile );
+                }
+            }
+/*-----------------------------------------------------------*/
+
+        #endif /* projIP_TRACE_STATS */
+
+        static uint64_t ullBenchmarkTime( clockid_t xClock )
+        {
+            struct timespec xNow;
+
+            clock_gettime( xClock, &xNow );
+
+            return ( ( uint64_t ) xNow.tv_sec * 1000000ULL ) + ( ( uint64_t ) xNow.tv_nsec / 1000ULL );
+        }
+/*-----------------------------------------------------------*/
+
+    #endif /* configECHO_BENCHMARK */
+
     BaseType_t xAreSingleTaskTCPEchoClientsStillRunning( void )
     {
         static uint32_t ulLastEchoSocketCount[ echoNUM_ECHO_CLIENTS ] = { 0 }, ulLastConnections[ echoNUM_ECHO_CLIENTS ] = { 0 };
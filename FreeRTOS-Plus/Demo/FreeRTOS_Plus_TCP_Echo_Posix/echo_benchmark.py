@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+#
+# FreeRTOS V202212.00
+# Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+# https://www.FreeRTOS.org
+# https://github.com/FreeRTOS
+#
+"""Run the echo demo benchmark and compare it with a baseline.
+
+Build the demo with "make BENCHMARK=1", then:
+
+    echo_benchmark.py serve --port 5000
+        Only run the echo server on the host, e.g. when the demo is started
+        by hand.
+
+    echo_benchmark.py run --exe build/posix_demo --port 5000 \\
+                          --output results.json --baseline baseline.json
+        Start the echo server, run the demo until it prints "BENCH done",
+        write the results as JSON, and compare them with the baseline.  The
+        exit status is 1 when a figure is worse than the baseline by more
+        than --tolerance percent, or when the demo failed.
+
+The port must match echoECHO_PORT in TCPEchoClient_SingleTasks.c, and the
+address of the host must match configECHO_SERVER_ADDR0..3 in FreeRTOSConfig.h.
+"""
+
+import argparse
+import json
+import socket
+import subprocess
+import sys
+import threading
+import time
+
+# Figures where a larger value is better.  All others are better when smaller.
+HIGHER_IS_BETTER = (
+    "connections_per_sec",
+    "round_trips_per_sec",
+    "bulk_mbit_per_sec",
+)
+
+# Figures that are compared with the baseline.
+COMPARED = HIGHER_IS_BETTER + (
+    "rtt_us_p50",
+    "rtt_us_p90",
+    "rtt_us_p99",
+    "cpu_ms_per_mb",
+)
+
+
+def echo_connection(conn):
+    with conn:
+        conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        while True:
+            data = conn.recv(65536)
+            if not data:
+                break
+            conn.sendall(data)
+
+
+def start_echo_server(port):
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("0.0.0.0", port))
+    server.listen(64)
+
+    def accept_loop():
+        while True:
+            conn, _ = server.accept()
+            threading.Thread(target=echo_connection, args=(conn,), daemon=True).start()
+
+    threading.Thread(target=accept_loop, daemon=True).start()
+    return server
+
+
+def parse_value(text):
+    for convert in (int, float):
+        try:
+            return convert(text)
+        except ValueError:
+            pass
+    return text
+
+
+def run_demo(exe, timeout):
+    """Run the demo and return the BENCH figures, or None on a time out."""
+    results = {}
+    proc = subprocess.Popen([exe], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True, bufsize=1)
+    deadline = time.monotonic() + timeout
+    timer = threading.Timer(timeout, proc.kill)
+    timer.start()
+    done = False
+    try:
+        for line in proc.stdout:
+            words = line.split()
+            if len(words) >= 2 and words[0] == "BENCH":
+                if words[1] == "done":
+                    done = True
+                    break
+                results[words[1]] = parse_value(" ".join(words[2:]))
+            if time.monotonic() > deadline:
+                break
+    finally:
+        timer.cancel()
+        proc.kill()
+        proc.wait()
+    return results if done else None
+
+
+def compare(results, baseline, tolerance):
+    """Print a line per figure and return the number of regressions."""
+    regressions = 0
+    for name in COMPARED:
+        if name not in results or name not in baseline:
+            continue
+        new, old = float(results[name]), float(baseline[name])
+        if old == 0.0:
+            continue
+        change = 100.0 * (new - old) / old
+        if name in HIGHER_IS_BETTER:
+            worse = change < -tolerance
+        else:
+            worse = change > tolerance
+        regressions += worse
+        print("%-22s %12.2f %12.2f %+8.1f%%%s" %
+              (name, old, new, change, "  REGRESSION" if worse else ""))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+
+    serve = sub.add_parser("serve", help="run the echo server only")
+    serve.add_argument("--port", type=int, default=5000)
+
+    run = sub.add_parser("run", help="run the demo and compare the results")
+    run.add_argument("--exe", required=True, help="the demo built with BENCHMARK=1")
+    run.add_argument("--port", type=int, default=5000)
+    run.add_argument("--timeout", type=float, default=300.0, help="seconds")
+    run.add_argument("--output", help="write the results to this JSON file")
+    run.add_argument("--baseline", help="compare with this JSON file")
+    run.add_argument("--tolerance", type=float, default=10.0, help="percent")
+
+    args = parser.parse_args()
+
+    server = start_echo_server(args.port)
+
+    if args.command == "serve":
+        print("Echo server on port %d, press Ctrl-C to stop" % args.port)
+        try:
+            while True:
+                time.sleep(3600)
+        except KeyboardInterrupt:
+            return 0
+
+    results = run_demo(args.exe, args.timeout)
+    server.close()
+
+    if results is None:
+        print("The demo did not finish within %.0f seconds" % args.timeout)
+        return 1
+
+    print(json.dumps(results, indent=2, sort_keys=True))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+
+    status = 0 if results.get("result") == "pass" else 1
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if compare(results, baseline, args.tolerance) > 0:
+            status = 1
+
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
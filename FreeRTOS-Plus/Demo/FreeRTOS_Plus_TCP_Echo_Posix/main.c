@@ -62,6 +62,9 @@
 /* Local includes. */
 #include "console.h"
 
+/* Demo logging includes. */
+#include "logging.h"
+
 #include <trcRecorder.h>
 
 #define    ECHO_CLIENT_DEMO         0
@@ -125,6 +128,10 @@ int main( void )
     }
     #endif
 
+    /* vLoggingPrintf() output is passed to a pthread that writes it to
+     * stdout in batches. */
+    vLoggingInit( pdTRUE, pdFALSE, pdFALSE, 0U, 0U );
+
     console_init();
     #if ( mainSELECTED_APPLICATION == ECHO_CLIENT_DEMO )
     {
@@ -231,17 +238,6 @@ void traceOnEnter()
     }
 }
 
-void vLoggingPrintf( const char * pcFormat,
-                     ... )
-{
-    va_list arg;
-
-    va_start( arg, pcFormat );
-    vprintf( pcFormat, arg );
-    va_end( arg );
-}
-/*-----------------------------------------------------------*/
-
 void vApplicationDaemonTaskStartupHook( void )
 {
     /* This function will be called once only, when the daemon task starts to
@@ -77,6 +77,12 @@
  *
  */
 #define mainCREATE_TCP_ECHO_TASKS_SINGLE              1
+
+/* Set to 1 by "make NETIF=packet_mmap" to use NetworkInterface_PacketMMAP.c
+ * instead of the libslirp network interface. */
+#ifndef configUSE_PACKET_MMAP_INTERFACE
+    #define configUSE_PACKET_MMAP_INTERFACE           0
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -160,9 +166,16 @@ void main_tcp_echo_client_tasks( void )
     memcpy( ipLOCAL_MAC_ADDRESS, ucMACAddress, sizeof( ucMACAddress ) );
 
     #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-        extern NetworkInterface_t * pxLibslirp_FillInterfaceDescriptor( BaseType_t xEMACIndex,
-                                                                        NetworkInterface_t * pxInterface );
-        pxLibslirp_FillInterfaceDescriptor( 0, &( xInterfaces[ 0 ] ) );
+        #if ( configUSE_PACKET_MMAP_INTERFACE == 1 )
+            /* Built with "make NETIF=packet_mmap", see NetworkInterface_PacketMMAP.c. */
+            extern NetworkInterface_t * pxPacketMMAP_FillInterfaceDescriptor( BaseType_t xEMACIndex,
+                                                                              NetworkInterface_t * pxInterface );
+            pxPacketMMAP_FillInterfaceDescriptor( 0, &( xInterfaces[ 0 ] ) );
+        #else
+            extern NetworkInterface_t * pxLibslirp_FillInterfaceDescriptor( BaseType_t xEMACIndex,
+                                                                            NetworkInterface_t * pxInterface );
+            pxLibslirp_FillInterfaceDescriptor( 0, &( xInterfaces[ 0 ] ) );
+        #endif
 
         /* === End-point 0 === */
         FreeRTOS_FillEndPoint( &( xInterfaces[ 0 ] ), &( xEndPoints[ 0 ] ), ucIPAddress, ucNetMask, ucGatewayAddress, ucDNSServerAddress, ucMACAddress );
@@ -29,8 +29,8 @@
 
 #include "http_demo_utils.h"
 
-/* Exponential backoff retry include. */
-#include "backoff_algorithm.h"
+/* Backoff shared by every connection to a server. */
+#include "endpoint_backoff.h"
 
 /*-----------------------------------------------------------*/
 
@@ -51,6 +51,24 @@
  */
 #define RETRY_BACKOFF_BASE_MS         ( 500U )
 
+/**
+ * @brief The number of consecutive failures, by any task, after which no
+ * connection to a server is attempted for #RETRY_CIRCUIT_OPEN_MS.
+ */
+#define RETRY_CIRCUIT_FAILURE_THRESHOLD    ( 5U )
+
+/**
+ * @brief How long (in milliseconds) no connection to a server is attempted
+ * after #RETRY_CIRCUIT_FAILURE_THRESHOLD consecutive failures.
+ */
+#define RETRY_CIRCUIT_OPEN_MS              ( 30000U )
+
+/**
+ * @brief The longest time (in milliseconds) to wait for a server to become
+ * available to one more attempt.
+ */
+#define RETRY_MAX_WAIT_MS                  ( 60000U )
+
 /**
  * @brief The separator between the "https" scheme and the host in a URL.
  */
@@ -83,48 +101,72 @@ extern UBaseType_t uxRand();
 BaseType_t connectToServerWithBackoffRetries( TransportConnect_t connectFunction,
                                               NetworkContext_t * pxNetworkContext )
 {
+    return connectToEndpointWithBackoffRetries( connectFunction, pxNetworkContext, "", 0U );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t connectToEndpointWithBackoffRetries( TransportConnect_t connectFunction,
+                                                NetworkContext_t * pxNetworkContext,
+                                                const char * pcHost,
+                                                uint16_t usPort )
+{
+    static const EndpointBackoffConfig_t xBackoffConfig =
+    {
+        .ulBaseDelayMs      = RETRY_BACKOFF_BASE_MS,
+        .ulMaxDelayMs       = RETRY_MAX_BACKOFF_DELAY_MS,
+        .ulFailureThreshold = RETRY_CIRCUIT_FAILURE_THRESHOLD,
+        .ulOpenMs           = RETRY_CIRCUIT_OPEN_MS
+    };
     BaseType_t xReturn = pdFAIL;
-    /* Status returned by the retry utilities. */
-    BackoffAlgorithmStatus_t xBackoffAlgStatus = BackoffAlgorithmSuccess;
-    /* Struct containing the next backoff time. */
-    BackoffAlgorithmContext_t xReconnectParams;
-    uint16_t usNextBackoff = 0U;
+    EndpointBackoff_t * pxBackoff;
+    uint32_t ulAttempts = 0U;
+    TickType_t xNextBackoff;
 
     assert( connectFunction != NULL );
+    assert( pcHost != NULL );
 
-    /* Initialize reconnect attempts and interval */
-    BackoffAlgorithm_InitializeParams( &xReconnectParams,
-                                       RETRY_BACKOFF_BASE_MS,
-                                       RETRY_MAX_BACKOFF_DELAY_MS,
-                                       RETRY_MAX_ATTEMPTS );
+    pxBackoff = pxEndpointBackoffGet( pcHost, usPort, &xBackoffConfig );
+    assert( pxBackoff != NULL );
 
     /* Attempt to connect to the HTTP server. If connection fails, retry after a
-     * timeout. The timeout value will exponentially increase until either the
+     * timeout. The timeout value will increase with jitter until either the
      * maximum timeout value is reached or the set number of attempts are
-     * exhausted.*/
+     * exhausted. No attempt is made while the circuit of the server is open. */
     do
     {
+        if( xEndpointBackoffWait( pxBackoff, pdMS_TO_TICKS( RETRY_MAX_WAIT_MS ) ) != pdTRUE )
+        {
+            LogError( ( "Connection to the HTTP server not attempted, it has been failing for too long." ) );
+            break;
+        }
+
         xReturn = connectFunction( pxNetworkContext );
+        ulAttempts++;
 
-        if( xReturn != pdPASS )
+        if( xReturn == pdPASS )
         {
-            /* Generate a random number and calculate backoff value (in milliseconds) for
-             * the next connection retry.
+            vEndpointBackoffSuccess( pxBackoff );
+        }
+        else
+        {
+            /* Set the time of the next attempt from a random number.
              * Note: It is recommended to seed the random number generator with a device-specific
              * entropy source so that possibility of multiple devices retrying failed network operations
              * at similar intervals can be avoided. */
-            xBackoffAlgStatus = BackoffAlgorithm_GetNextBackoff( &xReconnectParams, uxRand(), &usNextBackoff );
+            xNextBackoff = xEndpointBackoffFailure( pxBackoff, ( uint32_t ) uxRand() );
 
-            if( xBackoffAlgStatus == BackoffAlgorithmSuccess )
+            if( ulAttempts < RETRY_MAX_ATTEMPTS )
             {
                 LogWarn( ( "Connection to the HTTP server failed. "
                            "Retrying connection with backoff and jitter." ) );
-                LogInfo( ( "Retry attempt %lu out of maximum retry attempts %lu.",
-                           xReconnectParams.attemptsDone,
-                           RETRY_MAX_ATTEMPTS ) );
+                LogInfo( ( "Retry attempt %lu out of maximum retry attempts %lu in %lu ms.",
+                           ulAttempts,
+                           RETRY_MAX_ATTEMPTS,
+                           ( unsigned long ) ( xNextBackoff * portTICK_PERIOD_MS ) ) );
             }
         }
-    } while( ( xReturn == pdFAIL ) && ( xBackoffAlgStatus == BackoffAlgorithmSuccess ) );
+    } while( ( xReturn == pdFAIL ) && ( ulAttempts < RETRY_MAX_ATTEMPTS ) );
 
     if( xReturn == pdFAIL )
     {
@@ -136,6 +178,230 @@ BaseType_t connectToServerWithBackoffRetries( TransportConnect_t connectFunction
 
 /*-----------------------------------------------------------*/
 
+BaseType_t xHTTPConnectionPoolInit( HTTPConnectionPool_t * pxPool,
+                                    HTTPPooledConnection_t * pxConnections,
+                                    NetworkContext_t * pxNetworkContexts,
+                                    size_t xConnectionCount,
+                                    TransportDisconnect_t disconnectFunction,
+                                    TickType_t xIdleTimeout )
+{
+    BaseType_t xReturn = pdPASS;
+    size_t i;
+
+    assert( pxPool != NULL );
+    assert( pxConnections != NULL );
+    assert( pxNetworkContexts != NULL );
+    assert( xConnectionCount > 0U );
+    assert( disconnectFunction != NULL );
+
+    memset( pxPool, 0, sizeof( *pxPool ) );
+    memset( pxConnections, 0, xConnectionCount * sizeof( *pxConnections ) );
+
+    for( i = 0; i < xConnectionCount; i++ )
+    {
+        pxConnections[ i ].pxNetworkContext = &pxNetworkContexts[ i ];
+    }
+
+    pxPool->pxConnections = pxConnections;
+    pxPool->xConnectionCount = xConnectionCount;
+    pxPool->disconnectFunction = disconnectFunction;
+    pxPool->xIdleTimeout = xIdleTimeout;
+    pxPool->xMutex = xSemaphoreCreateMutex();
+    pxPool->xFreeCount = xSemaphoreCreateCounting( ( UBaseType_t ) xConnectionCount,
+                                                   ( UBaseType_t ) xConnectionCount );
+
+    if( ( pxPool->xMutex == NULL ) || ( pxPool->xFreeCount == NULL ) )
+    {
+        LogError( ( "Failed to create the connection pool semaphores." ) );
+        xReturn = pdFAIL;
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+NetworkContext_t * pxHTTPConnectionPoolAcquire( HTTPConnectionPool_t * pxPool,
+                                                const char * pcHost,
+                                                uint16_t usPort,
+                                                TransportConnect_t connectFunction,
+                                                TickType_t xBlockTime )
+{
+    HTTPPooledConnection_t * pxChosen = NULL;
+    HTTPPooledConnection_t * pxConnection;
+    BaseType_t xDisconnect = pdFALSE;
+    TickType_t xNow;
+    size_t i;
+
+    assert( pxPool != NULL );
+    assert( pcHost != NULL );
+    assert( connectFunction != NULL );
+
+    /* Wait until a connection is not in use. */
+    if( xSemaphoreTake( pxPool->xFreeCount, xBlockTime ) == pdTRUE )
+    {
+        ( void ) xSemaphoreTake( pxPool->xMutex, portMAX_DELAY );
+        xNow = xTaskGetTickCount();
+
+        /* Reuse an open connection to the same server. Connections left idle
+         * for too long are closed on the way, the server may have dropped
+         * them. */
+        for( i = 0; i < pxPool->xConnectionCount; i++ )
+        {
+            pxConnection = &pxPool->pxConnections[ i ];
+
+            if( ( pxConnection->xInUse == pdFALSE ) && ( pxConnection->xConnected == pdTRUE ) )
+            {
+                if( ( xNow - pxConnection->xLastUsed ) >= pxPool->xIdleTimeout )
+                {
+                    LogInfo( ( "Closing the idle connection to %s:%u.",
+                               pxConnection->pcHost,
+                               pxConnection->usPort ) );
+                    pxPool->disconnectFunction( pxConnection->pxNetworkContext );
+                    pxConnection->xConnected = pdFALSE;
+                }
+                else if( ( pxConnection->usPort == usPort ) &&
+                         ( strcmp( pxConnection->pcHost, pcHost ) == 0 ) )
+                {
+                    pxChosen = pxConnection;
+                    break;
+                }
+            }
+        }
+
+        if( pxChosen == NULL )
+        {
+            /* Prefer a closed connection over closing the one idle for the
+             * longest time. */
+            for( i = 0; i < pxPool->xConnectionCount; i++ )
+            {
+                pxConnection = &pxPool->pxConnections[ i ];
+
+                if( pxConnection->xInUse == pdFALSE )
+                {
+                    if( pxConnection->xConnected == pdFALSE )
+                    {
+                        pxChosen = pxConnection;
+                        break;
+                    }
+                    else if( ( pxChosen == NULL ) ||
+                             ( ( xNow - pxConnection->xLastUsed ) > ( xNow - pxChosen->xLastUsed ) ) )
+                    {
+                        pxChosen = pxConnection;
+                    }
+                }
+            }
+
+            /* The counting semaphore guarantees a connection is not in use. */
+            assert( pxChosen != NULL );
+
+            xDisconnect = pxChosen->xConnected;
+            pxChosen->xConnected = pdFALSE;
+            pxChosen->pcHost = pcHost;
+            pxChosen->usPort = usPort;
+        }
+
+        pxChosen->xInUse = pdTRUE;
+        ( void ) xSemaphoreGive( pxPool->xMutex );
+
+        /* The connection belongs to this task now, so it can be closed and
+         * established without holding the mutex. */
+        if( xDisconnect == pdTRUE )
+        {
+            pxPool->disconnectFunction( pxChosen->pxNetworkContext );
+        }
+
+        if( pxChosen->xConnected == pdFALSE )
+        {
+            if( connectToEndpointWithBackoffRetries( connectFunction, pxChosen->pxNetworkContext, pcHost, usPort ) == pdPASS )
+            {
+                pxChosen->xConnected = pdTRUE;
+            }
+            else
+            {
+                vHTTPConnectionPoolRelease( pxPool, pxChosen->pxNetworkContext, pdFALSE );
+                pxChosen = NULL;
+            }
+        }
+        else
+        {
+            LogInfo( ( "Reusing the open connection to %s:%u.",
+                       pcHost,
+                       usPort ) );
+        }
+    }
+    else
+    {
+        LogError( ( "No connection of the pool was released in time." ) );
+    }
+
+    return ( pxChosen != NULL ) ? pxChosen->pxNetworkContext : NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+void vHTTPConnectionPoolRelease( HTTPConnectionPool_t * pxPool,
+                                 NetworkContext_t * pxNetworkContext,
+                                 BaseType_t xKeepOpen )
+{
+    HTTPPooledConnection_t * pxConnection = NULL;
+    size_t i;
+
+    assert( pxPool != NULL );
+
+    for( i = 0; i < pxPool->xConnectionCount; i++ )
+    {
+        if( pxPool->pxConnections[ i ].pxNetworkContext == pxNetworkContext )
+        {
+            pxConnection = &pxPool->pxConnections[ i ];
+            break;
+        }
+    }
+
+    assert( pxConnection != NULL );
+    assert( pxConnection->xInUse == pdTRUE );
+
+    if( ( xKeepOpen == pdFALSE ) && ( pxConnection->xConnected == pdTRUE ) )
+    {
+        pxPool->disconnectFunction( pxNetworkContext );
+        pxConnection->xConnected = pdFALSE;
+    }
+
+    ( void ) xSemaphoreTake( pxPool->xMutex, portMAX_DELAY );
+    pxConnection->xLastUsed = xTaskGetTickCount();
+    pxConnection->xInUse = pdFALSE;
+    ( void ) xSemaphoreGive( pxPool->xMutex );
+
+    ( void ) xSemaphoreGive( pxPool->xFreeCount );
+}
+
+/*-----------------------------------------------------------*/
+
+void vHTTPConnectionPoolCloseIdle( HTTPConnectionPool_t * pxPool )
+{
+    HTTPPooledConnection_t * pxConnection;
+    size_t i;
+
+    assert( pxPool != NULL );
+
+    ( void ) xSemaphoreTake( pxPool->xMutex, portMAX_DELAY );
+
+    for( i = 0; i < pxPool->xConnectionCount; i++ )
+    {
+        pxConnection = &pxPool->pxConnections[ i ];
+
+        if( ( pxConnection->xInUse == pdFALSE ) && ( pxConnection->xConnected == pdTRUE ) )
+        {
+            pxPool->disconnectFunction( pxConnection->pxNetworkContext );
+            pxConnection->xConnected = pdFALSE;
+        }
+    }
+
+    ( void ) xSemaphoreGive( pxPool->xMutex );
+}
+
+/*-----------------------------------------------------------*/
+
 HTTPStatus_t getUrlPath( const char * pcUrl,
                          size_t xUrlLen,
                          const char ** pcPath,
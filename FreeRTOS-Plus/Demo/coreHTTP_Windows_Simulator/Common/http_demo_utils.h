@@ -35,6 +35,7 @@
 /* Kernel includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 
 /* HTTP API header. */
 #include "core_http_client.h"
@@ -51,9 +52,9 @@ typedef BaseType_t ( * TransportConnect_t )( NetworkContext_t * pxNetworkContext
 /**
  * @brief Connect to a server with reconnection retries.
  *
- * If connection fails, retry is attempted after a timeout. The timeout value
- * will exponentially increase until either the maximum timeout value is reached
- * or the set number of attempts are exhausted.
+ * Equivalent to #connectToEndpointWithBackoffRetries with an empty host name
+ * and port 0, so every caller shares the backoff of the one server of the
+ * demo.
  *
  * @param[in] connectFunction Function pointer for establishing connection to a
  * server.
@@ -64,6 +65,139 @@ typedef BaseType_t ( * TransportConnect_t )( NetworkContext_t * pxNetworkContext
 BaseType_t connectToServerWithBackoffRetries( TransportConnect_t connectFunction,
                                               NetworkContext_t * pxNetworkContext );
 
+/**
+ * @brief Connect to a server with reconnection retries, sharing the backoff
+ * with every other task connecting to the same server.
+ *
+ * If connection fails, retry is attempted after a timeout. The timeout value
+ * increases with jitter until either the maximum timeout value is reached or
+ * the set number of attempts are exhausted.  The timeouts are shared by every
+ * task connecting to @p pcHost and @p usPort, and after repeated failures no
+ * task connects to it for a while, see endpoint_backoff.h.
+ *
+ * @param[in] connectFunction Function pointer for establishing connection to a
+ * server.
+ * @param[out] pxNetworkContext Implementation-defined network context.
+ * @param[in] pcHost The host name of the server.
+ * @param[in] usPort The port of the server.
+ *
+ * @return pdFAIL on failure; pdPASS on successful connection.
+ */
+BaseType_t connectToEndpointWithBackoffRetries( TransportConnect_t connectFunction,
+                                                NetworkContext_t * pxNetworkContext,
+                                                const char * pcHost,
+                                                uint16_t usPort );
+
+/**
+ * @brief Function pointer for closing a connection established by a
+ * #TransportConnect_t function.
+ *
+ * @param[in] pxNetworkContext Implementation-defined network context.
+ */
+typedef void ( * TransportDisconnect_t )( NetworkContext_t * pxNetworkContext );
+
+/**
+ * @brief A connection kept open by an HTTP connection pool.
+ *
+ * @note The members are private to the pool.
+ */
+typedef struct HTTPPooledConnection
+{
+    NetworkContext_t * pxNetworkContext; /**< @brief Provided by the application. */
+    const char * pcHost;                 /**< @brief The server the connection is open to. */
+    uint16_t usPort;                     /**< @brief The port the connection is open to. */
+    TickType_t xLastUsed;                /**< @brief When the connection was last released. */
+    BaseType_t xConnected;               /**< @brief pdTRUE while the connection is open. */
+    BaseType_t xInUse;                   /**< @brief pdTRUE while the connection is handed out. */
+} HTTPPooledConnection_t;
+
+/**
+ * @brief A pool of connections that are kept open between requests, so that
+ * consecutive requests to the same server avoid a new TCP and TLS handshake.
+ * Requests must be sent with HTTP_REQUEST_KEEP_ALIVE_FLAG for servers to keep
+ * the connections open.
+ *
+ * @note The members are private to the pool.
+ */
+typedef struct HTTPConnectionPool
+{
+    HTTPPooledConnection_t * pxConnections;
+    size_t xConnectionCount;
+    TransportDisconnect_t disconnectFunction;
+    TickType_t xIdleTimeout;
+    SemaphoreHandle_t xMutex;     /**< @brief Protects pxConnections. */
+    SemaphoreHandle_t xFreeCount; /**< @brief Counts the connections not handed out. */
+} HTTPConnectionPool_t;
+
+/**
+ * @brief Initialize a connection pool.
+ *
+ * @param[out] pxPool The pool to initialize.
+ * @param[in] pxConnections Storage for xConnectionCount pooled connections.
+ * @param[in] pxNetworkContexts xConnectionCount network contexts, with their
+ * transport parameters set, used for the connections of the pool.
+ * @param[in] xConnectionCount The maximum number of open connections.
+ * @param[in] disconnectFunction Function closing a connection.
+ * @param[in] xIdleTimeout A connection that was not used for this long is
+ * closed instead of reused, as the server has most likely dropped it. This
+ * should be shorter than the keep-alive timeout of the servers.
+ *
+ * @return pdFAIL on failure; pdPASS on success.
+ */
+BaseType_t xHTTPConnectionPoolInit( HTTPConnectionPool_t * pxPool,
+                                    HTTPPooledConnection_t * pxConnections,
+                                    NetworkContext_t * pxNetworkContexts,
+                                    size_t xConnectionCount,
+                                    TransportDisconnect_t disconnectFunction,
+                                    TickType_t xIdleTimeout );
+
+/**
+ * @brief Get a connection to a server from the pool.
+ *
+ * An open connection to pcHost:usPort is reused if there is one. Otherwise a
+ * connection is established with #connectToServerWithBackoffRetries, closing
+ * the connection that was idle for the longest time if all are open. The
+ * connection belongs to the caller until it is given back with
+ * #vHTTPConnectionPoolRelease, so different tasks may use different
+ * connections of a pool at the same time.
+ *
+ * @param[in] pxPool The pool.
+ * @param[in] pcHost The server, which must stay valid while the pool is used.
+ * @param[in] usPort The port of the server.
+ * @param[in] connectFunction Function establishing a connection to
+ * pcHost:usPort.
+ * @param[in] xBlockTime How long to wait for a connection to be released when
+ * all connections are in use.
+ *
+ * @return The network context of the connection, or NULL on failure.
+ */
+NetworkContext_t * pxHTTPConnectionPoolAcquire( HTTPConnectionPool_t * pxPool,
+                                                const char * pcHost,
+                                                uint16_t usPort,
+                                                TransportConnect_t connectFunction,
+                                                TickType_t xBlockTime );
+
+/**
+ * @brief Give a connection obtained with #pxHTTPConnectionPoolAcquire back to
+ * the pool.
+ *
+ * @param[in] pxPool The pool.
+ * @param[in] pxNetworkContext The network context of the connection.
+ * @param[in] xKeepOpen pdTRUE to keep the connection open for later requests.
+ * pdFALSE to close it, e.g. after a network error or when the response had
+ * the HTTP_RESPONSE_CONNECTION_CLOSE_FLAG set.
+ */
+void vHTTPConnectionPoolRelease( HTTPConnectionPool_t * pxPool,
+                                 NetworkContext_t * pxNetworkContext,
+                                 BaseType_t xKeepOpen );
+
+/**
+ * @brief Close the connections of the pool that are not in use.
+ *
+ * @param[in] pxPool The pool.
+ */
+void vHTTPConnectionPoolCloseIdle( HTTPConnectionPool_t * pxPool );
+
 /**
  * @brief Retrieve the path from the input URL.
  *
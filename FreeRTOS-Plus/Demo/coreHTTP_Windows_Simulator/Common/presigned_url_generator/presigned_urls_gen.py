@@ -33,6 +33,45 @@ def get_presigned_urls(bucket_name, key_name, region_name) -> None:
         print("#define democonfigS3_PRESIGNED_" + method + "_URL" + "    " + '"' + url + '"\n')
 
 
+def get_presigned_multipart_urls(bucket_name, key_name, region_name, part_count, part_size) -> None:
+    """
+    Starts a multipart upload of the given object key in the given S3 bucket,
+    then prints the presigned URLs of its parts, of the request completing it
+    and of the request aborting it, assigned to the demo specific C macros.
+    The upload stays open until it is completed or aborted, so it must be
+    aborted if the demo is not run.
+    Args:
+        bucket_name (str): S3 bucket
+        key_name (str):  S3 object key
+        region_name (str): S3 bucket's region
+        part_count (int): The number of parts
+        part_size (int): The size of every part but the last
+    """
+
+    s3 = boto3.client("s3", config=Config(signature_version="s3v4", region_name=region_name))
+
+    upload_id = s3.create_multipart_upload(Bucket=bucket_name, Key=key_name)["UploadId"]
+    params = {"Bucket": bucket_name, "Key": key_name, "UploadId": upload_id}
+
+    part_urls = [
+        s3.generate_presigned_url(ClientMethod="upload_part", Params=dict(params, PartNumber=part_number))
+        for part_number in range(1, part_count + 1)
+    ]
+    print("#define democonfigS3_PRESIGNED_PART_URLS    \\")
+    print("    {                                       \\")
+    for url in part_urls:
+        print('        "' + url + '",    \\')
+    print("    }\n")
+
+    url = s3.generate_presigned_url(ClientMethod="complete_multipart_upload", Params=params, HttpMethod="POST")
+    print("#define democonfigS3_PRESIGNED_COMPLETE_URL    " + '"' + url + '"\n')
+
+    url = s3.generate_presigned_url(ClientMethod="abort_multipart_upload", Params=params, HttpMethod="DELETE")
+    print("#define democonfigS3_PRESIGNED_ABORT_URL    " + '"' + url + '"\n')
+
+    print("#define democonfigS3_MULTIPART_PART_SIZE    ( " + str(part_size) + "UL )\n")
+
+
 def main():
     """
     Generate demo C macro strings, on the console, for the input S3 bucket and object key.
@@ -59,10 +98,36 @@ def main():
         dest="region_name",
         help="The region in which the S3 bucket of interest is created.",
     )
+    parser.add_argument(
+        "--parts",
+        action="store",
+        required=False,
+        type=int,
+        dest="part_count",
+        help="Also start a multipart upload of the object in this many parts, and print its URLs.",
+    )
+    parser.add_argument(
+        "--part-size",
+        action="store",
+        required=False,
+        type=int,
+        default=5 * 1024 * 1024,
+        dest="part_size",
+        help="The size in bytes of every part of the multipart upload but the last. S3 requires at least 5 MiB.",
+    )
     args = parser.parse_args()
 
+    if args.part_count is not None and args.part_count < 1:
+        parser.error("--parts must be at least 1.")
+
+    if args.part_size < 5 * 1024 * 1024:
+        parser.error("--part-size must be at least 5 MiB.")
+
     get_presigned_urls(args.bucket_name, args.key_name, args.region_name)
 
+    if args.part_count is not None:
+        get_presigned_multipart_urls(args.bucket_name, args.key_name, args.region_name, args.part_count, args.part_size)
+
 
 if __name__ == "__main__":  # pragma: no cover
     main()
@@ -0,0 +1,819 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/**
+ * @file s3_multipart_upload.c
+ * @brief Uploads an object to S3 in parts, several at a time, with pre-signed
+ * S3 multipart upload URLs.
+ *
+ * The pre-signed URLs of the parts contain the upload ID, so the upload must
+ * be created, with CreateMultipartUpload, before they are signed, see
+ * presigned_urls_gen.py.
+ */
+
+/* Standard includes. */
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "s3_multipart_upload.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Each compilation unit that consumes the NetworkContext must define it.
+ * The connections of the pool only pass through this file, so define this
+ * pointer as void *.
+ */
+struct NetworkContext
+{
+    void * pParams;
+};
+
+/**
+ * @brief The HTTP DELETE method, which core_http_client.h does not define.
+ */
+#define s3multipartHTTP_METHOD_DELETE         "DELETE"
+
+/**
+ * @brief The status code of a successful UploadPart or CompleteMultipartUpload.
+ */
+#define s3multipartSTATUS_OK                  ( 200U )
+
+/**
+ * @brief The status code of a successful AbortMultipartUpload.
+ */
+#define s3multipartSTATUS_NO_CONTENT          ( 204U )
+
+/**
+ * @brief The most attempts to send in a row that send no byte before a
+ * request fails.
+ */
+#define s3multipartMAX_EMPTY_SENDS            ( 10U )
+
+/**
+ * @brief Field names of the headers used.
+ */
+#define s3multipartCONTENT_LENGTH_FIELD       "Content-Length"
+#define s3multipartETAG_FIELD                 "ETag"
+
+/**
+ * @brief Found in the body of a CompleteMultipartUpload response that failed
+ * after S3 already returned the 200 status code.
+ */
+#define s3multipartERROR_ELEMENT              "<Error>"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Where the body of a request comes from while HTTPClient_Send() sends
+ * the request headers.
+ *
+ * The request is sent with a transport interface whose network context is a
+ * BodyStream_t.  Once the headers have been sent, its send function sends the
+ * body from the object, so that coreHTTP never needs the body in one buffer.
+ */
+typedef struct BodyStream
+{
+    TransportInterface_t xTransport; /**< The transport of the connection. */
+    S3MultipartWorker_t * pxWorker;  /**< The worker, which has the chunk buffer. */
+    size_t xHeadersLength;           /**< The length of the request headers. */
+    size_t xHeadersSent;             /**< The bytes of the headers sent. */
+    size_t xOffset;                  /**< The offset of the body in the object. */
+    size_t xLength;                  /**< The length of the body. */
+    BaseType_t xBodySent;            /**< pdTRUE once the body was sent. */
+} BodyStream_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send a buffer over a transport, retrying partial sends.
+ *
+ * @param[in] pxTransport The transport.
+ * @param[in] pucData The data.
+ * @param[in] xLength The length of the data.
+ *
+ * @return pdPASS if all the data was sent;
+ * pdFAIL otherwise.
+ */
+static BaseType_t prvSendAll( const TransportInterface_t * pxTransport,
+                              const uint8_t * pucData,
+                              size_t xLength );
+
+/**
+ * @brief The send function of a BodyStream_t, see BodyStream_t.
+ *
+ * @param[in] pxNetworkContext The BodyStream_t.
+ * @param[in] pvBuffer The bytes of the headers to send.
+ * @param[in] xBytesToSend The length of @p pvBuffer.
+ *
+ * @return The bytes of @p pvBuffer sent, or a negative value on failure.
+ */
+static int32_t prvStreamSend( NetworkContext_t * pxNetworkContext,
+                              const void * pvBuffer,
+                              size_t xBytesToSend );
+
+/**
+ * @brief The receive function of a BodyStream_t, which receives from the
+ * connection.
+ *
+ * @param[in] pxNetworkContext The BodyStream_t.
+ * @param[out] pvBuffer The buffer to receive into.
+ * @param[in] xBytesToRecv The length of @p pvBuffer.
+ *
+ * @return The bytes received, or a negative value on failure.
+ */
+static int32_t prvStreamRecv( NetworkContext_t * pxNetworkContext,
+                              void * pvBuffer,
+                              size_t xBytesToRecv );
+
+/**
+ * @brief Send a request to a pre-signed URL and receive the response.
+ *
+ * @param[in] pxUpload The upload.
+ * @param[in] pxWorker The buffers for the request and the response.
+ * @param[in] pxNetworkContext The connection to send the request over.
+ * @param[in] pcMethod The method of the request.
+ * @param[in] pcUrl The pre-signed URL.
+ * @param[in] pucBody The body, or NULL to send @p xLength bytes of the object
+ * from @p xOffset.
+ * @param[in] xOffset The offset in the object of a body read from the object.
+ * @param[in] xLength The length of the body.
+ * @param[out] pxResponse The response.
+ * @param[out] pxKeepOpen Whether the connection can be used again.
+ *
+ * @return HTTPSuccess if a response was received, or the error.
+ */
+static HTTPStatus_t prvSendRequest( const S3MultipartUpload_t * pxUpload,
+                                    S3MultipartWorker_t * pxWorker,
+                                    NetworkContext_t * pxNetworkContext,
+                                    const char * pcMethod,
+                                    const char * pcUrl,
+                                    const uint8_t * pucBody,
+                                    size_t xOffset,
+                                    size_t xLength,
+                                    HTTPResponse_t * pxResponse,
+                                    BaseType_t * pxKeepOpen );
+
+/**
+ * @brief Upload a part and keep its ETag.
+ *
+ * @param[in] pxWorker The worker uploading the part.
+ * @param[in] xIndex The index of the part.
+ *
+ * @return pdPASS if the part was uploaded;
+ * pdFAIL otherwise.
+ */
+static BaseType_t prvUploadPart( S3MultipartWorker_t * pxWorker,
+                                 size_t xIndex );
+
+/**
+ * @brief The task of a worker, which uploads parts until none are left.
+ *
+ * @param[in] pvParameters The S3MultipartWorker_t.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/**
+ * @brief Whether a response body contains a string.
+ *
+ * @param[in] pxResponse The response.
+ * @param[in] pcString The null-terminated string.
+ *
+ * @return pdTRUE if the body contains @p pcString;
+ * pdFALSE otherwise.
+ */
+static BaseType_t prvBodyContains( const HTTPResponse_t * pxResponse,
+                                   const char * pcString );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendAll( const TransportInterface_t * pxTransport,
+                              const uint8_t * pucData,
+                              size_t xLength )
+{
+    size_t xSent = 0U;
+    uint32_t ulEmptySends = 0U;
+    int32_t lResult;
+
+    while( ( xSent < xLength ) && ( ulEmptySends < s3multipartMAX_EMPTY_SENDS ) )
+    {
+        lResult = pxTransport->send( pxTransport->pNetworkContext, &( pucData[ xSent ] ), xLength - xSent );
+
+        if( lResult < 0 )
+        {
+            break;
+        }
+        else if( lResult == 0 )
+        {
+            ulEmptySends++;
+        }
+        else
+        {
+            xSent += ( size_t ) lResult;
+            ulEmptySends = 0U;
+        }
+    }
+
+    return ( xSent == xLength ) ? pdPASS : pdFAIL;
+}
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvStreamSend( NetworkContext_t * pxNetworkContext,
+                              const void * pvBuffer,
+                              size_t xBytesToSend )
+{
+    BodyStream_t * pxStream = ( BodyStream_t * ) pxNetworkContext;
+    S3MultipartUpload_t * pxUpload = pxStream->pxWorker->pxUpload;
+    size_t xDone = 0U;
+    size_t xChunk;
+    int32_t lSent;
+
+    lSent = pxStream->xTransport.send( pxStream->xTransport.pNetworkContext, pvBuffer, xBytesToSend );
+
+    if( ( lSent > 0 ) && ( pxStream->xBodySent == pdFALSE ) )
+    {
+        pxStream->xHeadersSent += ( size_t ) lSent;
+
+        if( pxStream->xHeadersSent >= pxStream->xHeadersLength )
+        {
+            pxStream->xBodySent = pdTRUE;
+
+            /* Send the body before returning the last part of the headers to
+             * coreHTTP, which then waits for the response. */
+            while( ( xDone < pxStream->xLength ) && ( lSent > 0 ) )
+            {
+                xChunk = pxStream->xLength - xDone;
+
+                if( xChunk > pxStream->pxWorker->xChunkLength )
+                {
+                    xChunk = pxStream->pxWorker->xChunkLength;
+                }
+
+                if( pxUpload->readFunction( pxUpload->pvReaderContext,
+                                            pxStream->xOffset + xDone,
+                                            pxStream->pxWorker->pucChunk,
+                                            xChunk ) != pdPASS )
+                {
+                    LogError( ( "Failed to read %lu bytes of the object at offset %lu.",
+                                ( unsigned long ) xChunk,
+                                ( unsigned long ) ( pxStream->xOffset + xDone ) ) );
+                    lSent = -1;
+                }
+                else if( prvSendAll( &( pxStream->xTransport ), pxStream->pxWorker->pucChunk, xChunk ) != pdPASS )
+                {
+                    LogError( ( "Failed to send the body of a part." ) );
+                    lSent = -1;
+                }
+                else
+                {
+                    xDone += xChunk;
+                }
+            }
+        }
+    }
+
+    return lSent;
+}
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvStreamRecv( NetworkContext_t * pxNetworkContext,
+                              void * pvBuffer,
+                              size_t xBytesToRecv )
+{
+    BodyStream_t * pxStream = ( BodyStream_t * ) pxNetworkContext;
+
+    return pxStream->xTransport.recv( pxStream->xTransport.pNetworkContext, pvBuffer, xBytesToRecv );
+}
+
+/*-----------------------------------------------------------*/
+
+static HTTPStatus_t prvSendRequest( const S3MultipartUpload_t * pxUpload,
+                                    S3MultipartWorker_t * pxWorker,
+                                    NetworkContext_t * pxNetworkContext,
+                                    const char * pcMethod,
+                                    const char * pcUrl,
+                                    const uint8_t * pucBody,
+                                    size_t xOffset,
+                                    size_t xLength,
+                                    HTTPResponse_t * pxResponse,
+                                    BaseType_t * pxKeepOpen )
+{
+    HTTPStatus_t xHTTPStatus;
+    HTTPRequestHeaders_t xRequestHeaders = { 0 };
+    HTTPRequestInfo_t xRequestInfo = { 0 };
+    TransportInterface_t xTransportInterface = { 0 };
+    BodyStream_t xStream = { 0 };
+    const char * pcPath = NULL;
+    size_t xPathLength = 0U;
+    char cContentLength[ 11 ];
+    uint32_t ulSendFlags = 0U;
+
+    *pxKeepOpen = pdFALSE;
+    ( void ) memset( pxResponse, 0, sizeof( *pxResponse ) );
+
+    /* The path used for the request needs all the query information following
+     * the location of the object, to the end of the pre-signed URL. */
+    xHTTPStatus = getUrlPath( pcUrl, strlen( pcUrl ), &pcPath, &xPathLength );
+
+    if( xHTTPStatus == HTTPSuccess )
+    {
+        xRequestInfo.pHost = pxUpload->pcHost;
+        xRequestInfo.hostLen = strlen( pxUpload->pcHost );
+        xRequestInfo.pMethod = pcMethod;
+        xRequestInfo.methodLen = strlen( pcMethod );
+        xRequestInfo.pPath = pcPath;
+        xRequestInfo.pathLen = strlen( pcPath );
+        xRequestInfo.reqFlags = HTTP_REQUEST_KEEP_ALIVE_FLAG;
+
+        /* The same buffer holds the request headers, then the response. */
+        xRequestHeaders.pBuffer = pxWorker->pucBuffer;
+        xRequestHeaders.bufferLen = pxWorker->xBufferLength;
+        pxResponse->pBuffer = pxWorker->pucBuffer;
+        pxResponse->bufferLen = pxWorker->xBufferLength;
+
+        xHTTPStatus = HTTPClient_InitializeRequestHeaders( &xRequestHeaders, &xRequestInfo );
+    }
+
+    xTransportInterface.pNetworkContext = pxNetworkContext;
+    xTransportInterface.send = pxUpload->sendFunction;
+    xTransportInterface.recv = pxUpload->recvFunction;
+
+    if( ( xHTTPStatus == HTTPSuccess ) && ( pucBody == NULL ) && ( xLength > 0U ) )
+    {
+        /* coreHTTP sends no body, so it must not add its own Content-Length. */
+        ( void ) snprintf( cContentLength, sizeof( cContentLength ), "%lu", ( unsigned long ) xLength );
+        xHTTPStatus = HTTPClient_AddHeader( &xRequestHeaders,
+                                            s3multipartCONTENT_LENGTH_FIELD,
+                                            sizeof( s3multipartCONTENT_LENGTH_FIELD ) - 1U,
+                                            cContentLength,
+                                            strlen( cContentLength ) );
+        ulSendFlags = HTTP_SEND_DISABLE_CONTENT_LENGTH_FLAG;
+
+        xStream.xTransport = xTransportInterface;
+        xStream.pxWorker = pxWorker;
+        xStream.xHeadersLength = xRequestHeaders.headersLen;
+        xStream.xOffset = xOffset;
+        xStream.xLength = xLength;
+        xStream.xBodySent = pdFALSE;
+
+        xTransportInterface.pNetworkContext = ( NetworkContext_t * ) &xStream;
+        xTransportInterface.send = prvStreamSend;
+        xTransportInterface.recv = prvStreamRecv;
+    }
+
+    if( xHTTPStatus == HTTPSuccess )
+    {
+        xHTTPStatus = HTTPClient_Send( &xTransportInterface,
+                                       &xRequestHeaders,
+                                       pucBody,
+                                       ( pucBody != NULL ) ? xLength : 0U,
+                                       pxResponse,
+                                       ulSendFlags );
+    }
+
+    if( xHTTPStatus == HTTPSuccess )
+    {
+        *pxKeepOpen = ( ( pxResponse->respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG ) == 0U ) ? pdTRUE : pdFALSE;
+    }
+    else
+    {
+        LogError( ( "Failed to send the HTTP %s request to %s: Error=%s.",
+                    pcMethod,
+                    pxUpload->pcHost,
+                    HTTPClient_strerror( xHTTPStatus ) ) );
+    }
+
+    return xHTTPStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUploadPart( S3MultipartWorker_t * pxWorker,
+                                 size_t xIndex )
+{
+    S3MultipartUpload_t * pxUpload = pxWorker->pxUpload;
+    S3MultipartPart_t * pxPart = &( pxUpload->pxParts[ xIndex ] );
+    NetworkContext_t * pxNetworkContext;
+    HTTPResponse_t xResponse;
+    HTTPStatus_t xHTTPStatus;
+    BaseType_t xStatus = pdFAIL;
+    BaseType_t xKeepOpen = pdFALSE;
+    const char * pcETag = NULL;
+    size_t xETagLength = 0U;
+    size_t xOffset = xIndex * pxUpload->xPartSize;
+    size_t xLength = pxUpload->xObjectSize - xOffset;
+
+    if( xLength > pxUpload->xPartSize )
+    {
+        xLength = pxUpload->xPartSize;
+    }
+
+    pxNetworkContext = pxHTTPConnectionPoolAcquire( pxUpload->pxPool,
+                                                    pxUpload->pcHost,
+                                                    pxUpload->usPort,
+                                                    pxUpload->connectFunction,
+                                                    portMAX_DELAY );
+
+    if( pxNetworkContext != NULL )
+    {
+        LogInfo( ( "Uploading part %lu, %lu bytes at offset %lu, attempt %u.",
+                   ( unsigned long ) ( xIndex + 1U ),
+                   ( unsigned long ) xLength,
+                   ( unsigned long ) xOffset,
+                   ( unsigned ) pxPart->ucAttempts ) );
+
+        xHTTPStatus = prvSendRequest( pxUpload,
+                                      pxWorker,
+                                      pxNetworkContext,
+                                      HTTP_METHOD_PUT,
+                                      pxPart->pcPresignedUrl,
+                                      NULL,
+                                      xOffset,
+                                      xLength,
+                                      &xResponse,
+                                      &xKeepOpen );
+
+        if( ( xHTTPStatus == HTTPSuccess ) && ( xResponse.statusCode == s3multipartSTATUS_OK ) )
+        {
+            xHTTPStatus = HTTPClient_ReadHeader( &xResponse,
+                                                 s3multipartETAG_FIELD,
+                                                 sizeof( s3multipartETAG_FIELD ) - 1U,
+                                                 &pcETag,
+                                                 &xETagLength );
+
+            if( ( xHTTPStatus == HTTPSuccess ) && ( xETagLength < s3multipartETAG_LENGTH ) )
+            {
+                ( void ) memcpy( pxPart->cETag, pcETag, xETagLength );
+                pxPart->cETag[ xETagLength ] = '\0';
+                pxPart->xETagLength = xETagLength;
+                xStatus = pdPASS;
+            }
+            else
+            {
+                LogError( ( "The response to part %lu has no valid ETag header.",
+                            ( unsigned long ) ( xIndex + 1U ) ) );
+            }
+        }
+        else if( xHTTPStatus == HTTPSuccess )
+        {
+            LogError( ( "Part %lu was rejected (Status Code: %u).",
+                        ( unsigned long ) ( xIndex + 1U ),
+                        xResponse.statusCode ) );
+        }
+        else
+        {
+            /* The error was logged by prvSendRequest(). */
+        }
+
+        vHTTPConnectionPoolRelease( pxUpload->pxPool, pxNetworkContext, xKeepOpen );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    S3MultipartWorker_t * pxWorker = ( S3MultipartWorker_t * ) pvParameters;
+    S3MultipartUpload_t * pxUpload = pxWorker->pxUpload;
+    S3MultipartPart_t * pxPart;
+    size_t xIndex;
+
+    while( ( pxUpload->xFailed == pdFALSE ) &&
+           ( xQueueReceive( pxUpload->xPartQueue, &xIndex, 0U ) == pdPASS ) )
+    {
+        pxPart = &( pxUpload->pxParts[ xIndex ] );
+        pxPart->ucAttempts++;
+
+        if( pxPart->ucAttempts > 1U )
+        {
+            vTaskDelay( pdMS_TO_TICKS( s3multipartRETRY_DELAY_MS << ( pxPart->ucAttempts - 2U ) ) );
+        }
+
+        if( prvUploadPart( pxWorker, xIndex ) == pdPASS )
+        {
+            LogInfo( ( "Part %lu uploaded, ETag %s.",
+                       ( unsigned long ) ( xIndex + 1U ),
+                       pxPart->cETag ) );
+        }
+        else if( pxPart->ucAttempts >= s3multipartMAX_PART_ATTEMPTS )
+        {
+            LogError( ( "Part %lu failed %u times, giving up the upload.",
+                        ( unsigned long ) ( xIndex + 1U ),
+                        ( unsigned ) pxPart->ucAttempts ) );
+            pxUpload->xFailed = pdTRUE;
+        }
+        else
+        {
+            /* Only this part is sent again, after the parts already queued.
+             * The queue holds every part, so there is room for it. */
+            LogWarn( ( "Part %lu failed, it will be sent again.",
+                       ( unsigned long ) ( xIndex + 1U ) ) );
+            ( void ) xQueueSendToBack( pxUpload->xPartQueue, &xIndex, 0U );
+        }
+    }
+
+    ( void ) xSemaphoreGive( pxUpload->xWorkersDone );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBodyContains( const HTTPResponse_t * pxResponse,
+                                   const char * pcString )
+{
+    BaseType_t xFound = pdFALSE;
+    size_t xLength = strlen( pcString );
+    size_t i;
+
+    if( ( pxResponse->pBody != NULL ) && ( pxResponse->bodyLen >= xLength ) )
+    {
+        for( i = 0U; ( i <= ( pxResponse->bodyLen - xLength ) ) && ( xFound == pdFALSE ); i++ )
+        {
+            if( memcmp( &( pxResponse->pBody[ i ] ), pcString, xLength ) == 0 )
+            {
+                xFound = pdTRUE;
+            }
+        }
+    }
+
+    return xFound;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xS3MultipartUploadParts( S3MultipartUpload_t * pxUpload,
+                                    S3MultipartWorker_t * pxWorkers,
+                                    size_t xWorkerCount )
+{
+    BaseType_t xStatus = pdPASS;
+    size_t xStarted = 0U;
+    size_t i;
+
+    assert( pxUpload != NULL );
+    assert( pxWorkers != NULL );
+    assert( xWorkerCount > 0U );
+
+    if( ( pxUpload->xPartSize == 0U ) ||
+        ( pxUpload->xPartCount != ( ( pxUpload->xObjectSize + pxUpload->xPartSize - 1U ) / pxUpload->xPartSize ) ) )
+    {
+        LogError( ( "%lu pre-signed part URLs given for %lu parts of %lu bytes.",
+                    ( unsigned long ) pxUpload->xPartCount,
+                    ( unsigned long ) ( ( pxUpload->xObjectSize + pxUpload->xPartSize - 1U ) / pxUpload->xPartSize ),
+                    ( unsigned long ) pxUpload->xPartSize ) );
+        xStatus = pdFAIL;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        pxUpload->xFailed = pdFALSE;
+        pxUpload->xPartQueue = xQueueCreate( ( UBaseType_t ) pxUpload->xPartCount, sizeof( size_t ) );
+        pxUpload->xWorkersDone = xSemaphoreCreateCounting( ( UBaseType_t ) xWorkerCount, 0U );
+
+        if( ( pxUpload->xPartQueue == NULL ) || ( pxUpload->xWorkersDone == NULL ) )
+        {
+            LogError( ( "Failed to create the part queue." ) );
+            xStatus = pdFAIL;
+        }
+    }
+
+    if( xStatus == pdPASS )
+    {
+        /* Parts uploaded by an earlier call keep their ETag and are skipped,
+         * so a failed upload can be resumed. */
+        for( i = 0U; i < pxUpload->xPartCount; i++ )
+        {
+            if( pxUpload->pxParts[ i ].xETagLength == 0U )
+            {
+                pxUpload->pxParts[ i ].ucAttempts = 0U;
+                ( void ) xQueueSendToBack( pxUpload->xPartQueue, &i, 0U );
+            }
+        }
+
+        for( i = 0U; i < xWorkerCount; i++ )
+        {
+            pxWorkers[ i ].pxUpload = pxUpload;
+
+            if( xTaskCreate( prvWorkerTask,
+                             "S3Part",
+                             s3multipartWORKER_STACK_SIZE,
+                             &( pxWorkers[ i ] ),
+                             s3multipartWORKER_PRIORITY,
+                             NULL ) == pdPASS )
+            {
+                xStarted++;
+            }
+        }
+
+        if( xStarted == 0U )
+        {
+            LogError( ( "Failed to create the part upload tasks." ) );
+            xStatus = pdFAIL;
+        }
+
+        for( i = 0U; i < xStarted; i++ )
+        {
+            ( void ) xSemaphoreTake( pxUpload->xWorkersDone, portMAX_DELAY );
+        }
+
+        for( i = 0U; ( i < pxUpload->xPartCount ) && ( xStatus == pdPASS ); i++ )
+        {
+            if( pxUpload->pxParts[ i ].xETagLength == 0U )
+            {
+                xStatus = pdFAIL;
+            }
+        }
+    }
+
+    if( pxUpload->xPartQueue != NULL )
+    {
+        vQueueDelete( pxUpload->xPartQueue );
+        pxUpload->xPartQueue = NULL;
+    }
+
+    if( pxUpload->xWorkersDone != NULL )
+    {
+        vSemaphoreDelete( pxUpload->xWorkersDone );
+        pxUpload->xWorkersDone = NULL;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xS3MultipartComplete( S3MultipartUpload_t * pxUpload,
+                                 const char * pcPresignedUrl,
+                                 S3MultipartWorker_t * pxWorker,
+                                 char * pcBody,
+                                 size_t xBodyLength )
+{
+    BaseType_t xStatus = pdPASS;
+    BaseType_t xKeepOpen = pdFALSE;
+    NetworkContext_t * pxNetworkContext;
+    HTTPResponse_t xResponse;
+    HTTPStatus_t xHTTPStatus;
+    size_t xUsed;
+    int lWritten;
+    size_t i;
+
+    assert( pxUpload != NULL );
+    assert( pcPresignedUrl != NULL );
+    assert( pxWorker != NULL );
+    assert( pcBody != NULL );
+
+    pxWorker->pxUpload = pxUpload;
+
+    lWritten = snprintf( pcBody, xBodyLength, "<CompleteMultipartUpload>" );
+    xUsed = ( lWritten > 0 ) ? ( size_t ) lWritten : xBodyLength;
+
+    for( i = 0U; ( i < pxUpload->xPartCount ) && ( xUsed < xBodyLength ); i++ )
+    {
+        lWritten = snprintf( &( pcBody[ xUsed ] ), xBodyLength - xUsed,
+                             "<Part><PartNumber>%lu</PartNumber><ETag>%s</ETag></Part>",
+                             ( unsigned long ) ( i + 1U ),
+                             pxUpload->pxParts[ i ].cETag );
+        xUsed += ( lWritten > 0 ) ? ( size_t ) lWritten : xBodyLength;
+    }
+
+    if( xUsed < xBodyLength )
+    {
+        lWritten = snprintf( &( pcBody[ xUsed ] ), xBodyLength - xUsed, "</CompleteMultipartUpload>" );
+        xUsed += ( lWritten > 0 ) ? ( size_t ) lWritten : xBodyLength;
+    }
+
+    if( xUsed >= xBodyLength )
+    {
+        LogError( ( "The list of the %lu parts does not fit in %lu bytes.",
+                    ( unsigned long ) pxUpload->xPartCount,
+                    ( unsigned long ) xBodyLength ) );
+        xStatus = pdFAIL;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        pxNetworkContext = pxHTTPConnectionPoolAcquire( pxUpload->pxPool,
+                                                        pxUpload->pcHost,
+                                                        pxUpload->usPort,
+                                                        pxUpload->connectFunction,
+                                                        portMAX_DELAY );
+        xStatus = ( pxNetworkContext != NULL ) ? pdPASS : pdFAIL;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        xHTTPStatus = prvSendRequest( pxUpload,
+                                      pxWorker,
+                                      pxNetworkContext,
+                                      HTTP_METHOD_POST,
+                                      pcPresignedUrl,
+                                      ( const uint8_t * ) pcBody,
+                                      0U,
+                                      xUsed,
+                                      &xResponse,
+                                      &xKeepOpen );
+
+        /* S3 may report a failure of the assembly after the 200 status code
+         * was sent, in the body of the response. */
+        if( ( xHTTPStatus != HTTPSuccess ) ||
+            ( xResponse.statusCode != s3multipartSTATUS_OK ) ||
+            ( prvBodyContains( &xResponse, s3multipartERROR_ELEMENT ) == pdTRUE ) )
+        {
+            LogError( ( "Failed to complete the multipart upload (Status Code: %u).",
+                        xResponse.statusCode ) );
+            LogDebug( ( "Response Body:\n%.*s\n",
+                        ( int32_t ) xResponse.bodyLen,
+                        xResponse.pBody ) );
+            xStatus = pdFAIL;
+        }
+
+        vHTTPConnectionPoolRelease( pxUpload->pxPool, pxNetworkContext, xKeepOpen );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xS3MultipartAbort( S3MultipartUpload_t * pxUpload,
+                              const char * pcPresignedUrl,
+                              S3MultipartWorker_t * pxWorker )
+{
+    BaseType_t xStatus = pdFAIL;
+    BaseType_t xKeepOpen = pdFALSE;
+    NetworkContext_t * pxNetworkContext;
+    HTTPResponse_t xResponse;
+    HTTPStatus_t xHTTPStatus;
+
+    assert( pxUpload != NULL );
+    assert( pcPresignedUrl != NULL );
+    assert( pxWorker != NULL );
+
+    pxWorker->pxUpload = pxUpload;
+
+    pxNetworkContext = pxHTTPConnectionPoolAcquire( pxUpload->pxPool,
+                                                    pxUpload->pcHost,
+                                                    pxUpload->usPort,
+                                                    pxUpload->connectFunction,
+                                                    portMAX_DELAY );
+
+    if( pxNetworkContext != NULL )
+    {
+        xHTTPStatus = prvSendRequest( pxUpload,
+                                      pxWorker,
+                                      pxNetworkContext,
+                                      s3multipartHTTP_METHOD_DELETE,
+                                      pcPresignedUrl,
+                                      NULL,
+                                      0U,
+                                      0U,
+                                      &xResponse,
+                                      &xKeepOpen );
+
+        if( ( xHTTPStatus == HTTPSuccess ) && ( xResponse.statusCode == s3multipartSTATUS_NO_CONTENT ) )
+        {
+            xStatus = pdPASS;
+        }
+        else
+        {
+            LogError( ( "Failed to abort the multipart upload (Status Code: %u).",
+                        xResponse.statusCode ) );
+        }
+
+        vHTTPConnectionPoolRelease( pxUpload->pxPool, pxNetworkContext, xKeepOpen );
+    }
+
+    return xStatus;
+}
@@ -0,0 +1,213 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+#ifndef S3_MULTIPART_UPLOAD_H
+#define S3_MULTIPART_UPLOAD_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* HTTP API header. */
+#include "core_http_client.h"
+
+/* Common HTTP demo utilities, for the connection pool. */
+#include "http_demo_utils.h"
+
+/**
+ * @brief The number of times a part is sent before the upload fails.
+ */
+#ifndef s3multipartMAX_PART_ATTEMPTS
+    #define s3multipartMAX_PART_ATTEMPTS    ( 3U )
+#endif
+
+/**
+ * @brief The delay before a failed part is sent again, doubled for every
+ * further attempt.
+ */
+#ifndef s3multipartRETRY_DELAY_MS
+    #define s3multipartRETRY_DELAY_MS       ( 1000U )
+#endif
+
+/**
+ * @brief The stack size, in words, of the tasks which upload the parts.
+ */
+#ifndef s3multipartWORKER_STACK_SIZE
+    #define s3multipartWORKER_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4U )
+#endif
+
+/**
+ * @brief The priority of the tasks which upload the parts.
+ */
+#ifndef s3multipartWORKER_PRIORITY
+    #define s3multipartWORKER_PRIORITY      ( tskIDLE_PRIORITY )
+#endif
+
+/**
+ * @brief The size of the buffer for the ETag of a part, S3 returns the quoted
+ * hex MD5 digest of the part.
+ */
+#define s3multipartETAG_LENGTH              ( 64U )
+
+/**
+ * @brief The smallest part size accepted by S3, except for the last part.
+ */
+#define s3multipartMIN_PART_SIZE            ( 5UL * 1024UL * 1024UL )
+
+/**
+ * @brief Read the object to upload.
+ *
+ * Called by several tasks at once, each for the part it uploads, so it must be
+ * thread safe.
+ *
+ * @param[in] pvReaderContext The context given in the S3MultipartUpload_t.
+ * @param[in] xOffset The offset in the object of the first byte to read.
+ * @param[out] pucBuffer The buffer to read into.
+ * @param[in] xLength The number of bytes to read.
+ *
+ * @return pdPASS if @p xLength bytes were read;
+ * pdFAIL otherwise.
+ */
+typedef BaseType_t ( * S3ObjectRead_t )( void * pvReaderContext,
+                                         size_t xOffset,
+                                         uint8_t * pucBuffer,
+                                         size_t xLength );
+
+/**
+ * @brief A part of an upload.
+ */
+typedef struct S3MultipartPart
+{
+    const char * pcPresignedUrl;          /**< @brief The pre-signed UploadPart URL of the part, set by the application. */
+    char cETag[ s3multipartETAG_LENGTH ]; /**< @brief The ETag returned by S3, needed to complete the upload. */
+    size_t xETagLength;                   /**< @brief The length of cETag, 0 until the part is uploaded. */
+    uint8_t ucAttempts;                   /**< @brief The number of times the part was sent. */
+} S3MultipartPart_t;
+
+/**
+ * @brief The buffers of a task uploading parts.  One is needed per part
+ * uploaded at the same time.
+ */
+typedef struct S3MultipartWorker
+{
+    uint8_t * pucBuffer;                  /**< @brief Holds the request headers, then the response. */
+    size_t xBufferLength;                 /**< @brief The length of pucBuffer. */
+    uint8_t * pucChunk;                   /**< @brief Holds the part of the body being sent. */
+    size_t xChunkLength;                  /**< @brief The length of pucChunk, so the most read from the object at a time. */
+    struct S3MultipartUpload * pxUpload;  /**< @brief Private, the upload the worker serves. */
+} S3MultipartWorker_t;
+
+/**
+ * @brief An upload of an object in parts, see xS3MultipartUploadParts().
+ *
+ * The members up to pvReaderContext are set by the application, the others
+ * are private to s3_multipart_upload.c.
+ */
+typedef struct S3MultipartUpload
+{
+    HTTPConnectionPool_t * pxPool;     /**< @brief The pool the connections are taken from, with at least one connection per worker. */
+    TransportConnect_t connectFunction; /**< @brief Connects a connection of the pool to pcHost. */
+    TransportSend_t sendFunction;      /**< @brief Sends over a connection of the pool. */
+    TransportRecv_t recvFunction;      /**< @brief Receives from a connection of the pool. */
+    const char * pcHost;               /**< @brief The host of the pre-signed URLs, null-terminated. */
+    uint16_t usPort;                   /**< @brief The port of the host. */
+    size_t xObjectSize;                /**< @brief The size of the object. */
+    size_t xPartSize;                  /**< @brief The size of every part but the last. */
+    S3MultipartPart_t * pxParts;       /**< @brief The parts, one per xPartSize bytes of the object. */
+    size_t xPartCount;                 /**< @brief The number of parts. */
+    S3ObjectRead_t readFunction;       /**< @brief Reads the object. */
+    void * pvReaderContext;            /**< @brief Passed to readFunction. */
+
+    QueueHandle_t xPartQueue;          /**< @brief The indexes of the parts still to upload. */
+    SemaphoreHandle_t xWorkersDone;    /**< @brief Given by each worker when it stops. */
+    volatile BaseType_t xFailed;       /**< @brief pdTRUE once a part failed too often. */
+} S3MultipartUpload_t;
+
+/**
+ * @brief Upload the parts of an object.
+ *
+ * A task is created for each worker.  The tasks take the parts from a shared
+ * queue and upload each over a connection of the pool, so up to
+ * @p xWorkerCount parts are in flight at once.  The body of a part is read
+ * from the object and sent a chunk of the worker at a time, so a part is never
+ * held in RAM as a whole.  A part that fails is put back at the end of the
+ * queue, over a new connection, and the upload fails once a part was sent
+ * s3multipartMAX_PART_ATTEMPTS times.  The function returns when all the
+ * tasks stopped.
+ *
+ * @param[in, out] pxUpload The upload, the pxParts of which get their ETags.
+ * @param[in] pxWorkers The buffers of the tasks.
+ * @param[in] xWorkerCount The number of tasks.
+ *
+ * @return pdPASS if every part was uploaded;
+ * pdFAIL otherwise.
+ */
+BaseType_t xS3MultipartUploadParts( S3MultipartUpload_t * pxUpload,
+                                    S3MultipartWorker_t * pxWorkers,
+                                    size_t xWorkerCount );
+
+/**
+ * @brief Complete an upload of which every part was uploaded, with a
+ * CompleteMultipartUpload request.
+ *
+ * @param[in] pxUpload The upload.
+ * @param[in] pcPresignedUrl The pre-signed CompleteMultipartUpload URL.
+ * @param[in] pxWorker The buffers for the request.
+ * @param[out] pcBody The buffer for the XML list of the parts, sent as the
+ * body of the request.  About 80 bytes per part are needed.
+ * @param[in] xBodyLength The length of @p pcBody.
+ *
+ * @return pdPASS if S3 assembled the object;
+ * pdFAIL otherwise.
+ */
+BaseType_t xS3MultipartComplete( S3MultipartUpload_t * pxUpload,
+                                 const char * pcPresignedUrl,
+                                 S3MultipartWorker_t * pxWorker,
+                                 char * pcBody,
+                                 size_t xBodyLength );
+
+/**
+ * @brief Abort an upload with an AbortMultipartUpload request, so that S3
+ * frees the parts already uploaded.
+ *
+ * @param[in] pxUpload The upload.
+ * @param[in] pcPresignedUrl The pre-signed AbortMultipartUpload URL.
+ * @param[in] pxWorker The buffers for the request.
+ *
+ * @return pdPASS if the upload was aborted;
+ * pdFAIL otherwise.
+ */
+BaseType_t xS3MultipartAbort( S3MultipartUpload_t * pxUpload,
+                              const char * pcPresignedUrl,
+                              S3MultipartWorker_t * pxWorker );
+
+#endif /* ifndef S3_MULTIPART_UPLOAD_H */
@@ -227,6 +227,18 @@
  */
 #define AWS_HTTP_AUTH_HEADER_VALUE_LEN                2048U
 
+/**
+ * @brief The number of connections kept open by the demo, one to the AWS IoT
+ * credential provider and one to AWS S3.
+ */
+#define HTTP_POOL_CONNECTIONS                         2U
+
+/**
+ * @brief How long an open connection may stay unused before it is closed
+ * instead of reused. Kept below the keep-alive timeout of the servers.
+ */
+#define HTTP_POOL_IDLE_TIMEOUT_TICKS                  ( pdMS_TO_TICKS( 4000U ) )
+
 /**
  * @brief Length in bytes of hex encoded hash digest.
  */
@@ -354,6 +366,14 @@ static const char * pcSecurityToken;
  */
 static size_t xSecurityTokenLen;
 
+/**
+ * @brief The connections to the servers, kept open between requests.
+ */
+static HTTPConnectionPool_t xConnectionPool;
+static HTTPPooledConnection_t xPooledConnections[ HTTP_POOL_CONNECTIONS ];
+static NetworkContext_t xPoolNetworkContexts[ HTTP_POOL_CONNECTIONS ];
+static TlsTransportParams_t xPoolTlsTransportParams[ HTTP_POOL_CONNECTIONS ];
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -602,9 +622,8 @@ static void prvHTTPDemoTask( void * pvParameters )
     /* The transport layer interface used by the HTTP Client library. */
     TransportInterface_t xTransportInterface;
     /* The network context for the transport layer interface. */
-    NetworkContext_t xNetworkContext = { 0 };
-    TlsTransportParams_t xTlsTransportParams = { 0 };
-    BaseType_t xIsConnectionEstablished = pdFALSE;
+    NetworkContext_t * pxNetworkContext;
+    UBaseType_t uxIndex;
     UBaseType_t uxDemoRunCount = 0UL;
     /* Response from IoT credential provider */
     HTTPResponse_t xCredentialResponse = { 0 };
@@ -615,8 +634,20 @@ static void prvHTTPDemoTask( void * pvParameters )
     /* Remove compiler warnings about unused parameters. */
     ( void ) pvParameters;
 
-    /* Set the pParams member of the network context with desired transport. */
-    xNetworkContext.pParams = &xTlsTransportParams;
+    /* Set the pParams member of the network contexts with desired transport. */
+    for( uxIndex = 0; uxIndex < HTTP_POOL_CONNECTIONS; uxIndex++ )
+    {
+        xPoolNetworkContexts[ uxIndex ].pParams = &xPoolTlsTransportParams[ uxIndex ];
+    }
+
+    /* The connections are kept open when a demo iteration is retried. */
+    xDemoStatus = xHTTPConnectionPoolInit( &xConnectionPool,
+                                           xPooledConnections,
+                                           xPoolNetworkContexts,
+                                           HTTP_POOL_CONNECTIONS,
+                                           TLS_FreeRTOS_Disconnect,
+                                           HTTP_POOL_IDLE_TIMEOUT_TICKS );
+    configASSERT( xDemoStatus == pdPASS );
 
     LogInfo( ( "HTTP Client Synchronous S3 download demo using temporary credentials fetched from iot credential provider" ) );
 
@@ -640,21 +671,25 @@ static void prvHTTPDemoTask( void * pvParameters )
 
         /**************************** Connect. ******************************/
 
-        /* Attempt to connect to the HTTP server. If connection fails, retry after a
-         * timeout. The timeout value will be exponentially increased until either the
-         * maximum number of attempts or the maximum timeout value is reached. The
-         * function returns pdFAIL if the TCP connection cannot be established with
-         * the server after configured number of attempts. */
-        xDemoStatus = connectToServerWithBackoffRetries( prvConnectToIotServer,
-                                                         &xNetworkContext );
+        /* Get a connection to the HTTP server from the pool, which reuses an
+         * open one if there is. Otherwise it attempts to connect, and if
+         * connection fails, retries after a timeout. The timeout value will be
+         * exponentially increased until either the maximum number of attempts
+         * or the maximum timeout value is reached. NULL is returned if the TCP
+         * connection cannot be established with the server after configured
+         * number of attempts. */
+        pxNetworkContext = pxHTTPConnectionPoolAcquire( &xConnectionPool,
+                                                        democonfigIOT_CREDENTIAL_PROVIDER_ENDPOINT,
+                                                        democonfigHTTPS_PORT,
+                                                        prvConnectToIotServer,
+                                                        portMAX_DELAY );
+        xDemoStatus = ( pxNetworkContext != NULL ) ? pdPASS : pdFAIL;
 
         if( xDemoStatus == pdPASS )
         {
-            /* Set a flag indicating that a TLS connection exists. */
-            xIsConnectionEstablished = pdTRUE;
-
             /* Define the transport interface. */
-            xTransportInterface.pNetworkContext = &xNetworkContext;
+            memset( &xTransportInterface, 0, sizeof( xTransportInterface ) );
+            xTransportInterface.pNetworkContext = pxNetworkContext;
             xTransportInterface.send = TLS_FreeRTOS_send;
             xTransportInterface.recv = TLS_FreeRTOS_recv;
         }
@@ -678,18 +713,23 @@ static void prvHTTPDemoTask( void * pvParameters )
             }
         }
 
-        if( xIsConnectionEstablished == pdTRUE )
+        if( pxNetworkContext != NULL )
         {
-            /* Close the connection with IoT credential provider. */
-            TLS_FreeRTOS_Disconnect( &xNetworkContext );
-            xIsConnectionEstablished = pdFALSE;
+            /* Keep the connection with IoT credential provider open for the
+             * next iteration, unless the request failed. */
+            vHTTPConnectionPoolRelease( &xConnectionPool, pxNetworkContext, xDemoStatus );
+            pxNetworkContext = NULL;
         }
 
         /************************ Connect to S3 server ************************/
         if( xDemoStatus == pdPASS )
         {
-            xDemoStatus = connectToServerWithBackoffRetries( prvConnectToS3Server,
-                                                             &xNetworkContext );
+            pxNetworkContext = pxHTTPConnectionPoolAcquire( &xConnectionPool,
+                                                            AWS_S3_ENDPOINT,
+                                                            democonfigHTTPS_PORT,
+                                                            prvConnectToS3Server,
+                                                            portMAX_DELAY );
+            xDemoStatus = ( pxNetworkContext != NULL ) ? pdPASS : pdFAIL;
 
             if( xDemoStatus != pdPASS )
             {
@@ -700,10 +740,9 @@ static void prvHTTPDemoTask( void * pvParameters )
         if( xDemoStatus == pdPASS )
         {
             memset( &xTransportInterface, 0, sizeof( xTransportInterface ) );
-            xTransportInterface.pNetworkContext = &xNetworkContext;
+            xTransportInterface.pNetworkContext = pxNetworkContext;
             xTransportInterface.send = TLS_FreeRTOS_send;
             xTransportInterface.recv = TLS_FreeRTOS_recv;
-            xIsConnectionEstablished = pdTRUE;
         }
 
         /******************** Download S3 Object File. **********************/
@@ -716,12 +755,11 @@ static void prvHTTPDemoTask( void * pvParameters )
 
         /************************** Disconnect. *****************************/
 
-        /* Close the network connection to clean up any system resources that the
-         * demo may have consumed. */
-        if( xIsConnectionEstablished == pdTRUE )
+        /* Give the connection back to the pool. It is closed after a failure,
+         * as the state of the connection is unknown. */
+        if( pxNetworkContext != NULL )
         {
-            /* Close the network connection.  */
-            TLS_FreeRTOS_Disconnect( &xNetworkContext );
+            vHTTPConnectionPoolRelease( &xConnectionPool, pxNetworkContext, xDemoStatus );
         }
 
         /*********************** Retry in case of failure. ************************/
@@ -747,6 +785,10 @@ static void prvHTTPDemoTask( void * pvParameters )
         }
     } while( xDemoStatus != pdPASS );
 
+    /* Close the network connections to clean up any system resources that the
+     * demo may have consumed. */
+    vHTTPConnectionPoolCloseIdle( &xConnectionPool );
+
     if( xDemoStatus == pdPASS )
     {
         LogInfo( ( "prvHTTPDemoTask() completed successfully. "
@@ -57,10 +57,17 @@
  * (located in located in coreHTTP_Windows_Simulator/Common) to generate these
  * URLs. For detailed instructions, see the accompanied README.md.
  *
+ * The size of the ranges adapts to the connection. It starts at
+ * democonfigRANGE_REQUEST_LENGTH, and after each response the main task
+ * estimates the throughput and the round trip time, and sizes the next ranges
+ * so that a request takes several round trips to complete. The response bodies
+ * are passed to the response task in pieces, so the queue items stay small
+ * whatever the size of the range.
+ *
  * @note If your file requires more than 99 range requests to S3 (depending on the
- * size of the file and the length specified in democonfigRANGE_REQUEST_LENGTH),
- * your connection may be dropped by S3. In this case, either increase the
- * buffer size and range request length (if feasible), to reduce the number of
+ * size of the file and democonfigRESPONSE_BUFFER_LENGTH, which bounds the size
+ * of a range), your connection may be dropped by S3. In this case, either
+ * increase the response buffer size (if feasible), to reduce the number of
  * requests required, or re-establish the connection with S3 after receiving a
  * "Connection: close" response header.
  */
@@ -129,6 +136,39 @@
     #define democonfigRANGE_REQUEST_LENGTH    ( 1024 )
 #endif
 
+/* Check that a size for the response buffer is defined. */
+#ifndef democonfigRESPONSE_BUFFER_LENGTH
+    #define democonfigRESPONSE_BUFFER_LENGTH    ( 32 * 1024 )
+#endif
+
+/**
+ * @brief The part of the response buffer kept for the response headers. We
+ * don't expect S3 to send more than 1024 bytes of headers.
+ */
+#define httpexampleRESPONSE_HEADER_RESERVE    ( 1024 )
+
+#if ( democonfigRESPONSE_BUFFER_LENGTH < ( democonfigRANGE_REQUEST_LENGTH + httpexampleRESPONSE_HEADER_RESERVE ) )
+    #error "democonfigRESPONSE_BUFFER_LENGTH must hold democonfigRANGE_REQUEST_LENGTH bytes and the response headers."
+#endif
+
+/**
+ * @brief The largest range requested, which must fit in the response buffer
+ * together with the headers.
+ */
+#define httpexampleMAX_RANGE_LENGTH           ( democonfigRESPONSE_BUFFER_LENGTH - httpexampleRESPONSE_HEADER_RESERVE )
+
+/**
+ * @brief The number of round trip times a range request should take to
+ * download. The time waiting for the first byte of a response is then at most
+ * a fifth of the time of a request.
+ */
+#define httpexampleRANGE_RTT_MULTIPLE         ( 4U )
+
+/**
+ * @brief The largest piece of a response body passed in a response queue item.
+ */
+#define httpexampleRESPONSE_CHUNK_LENGTH      ( 1024 )
+
 /**
  * @brief Length of the pre-signed GET URL defined in demo_config.h.
  */
@@ -247,16 +287,31 @@ typedef struct RequestItem
 /**
  * @brief Data type for the response queue.
  *
- * Contains the response data type and its corresponding buffer, to be enqueued
- * by the main task, and interpreted by the response task. The buffer is
- * included to avoid pointer inaccuracy during queue copy operations.
+ * Contains a piece of a response body, to be enqueued by the main task, and
+ * interpreted by the response task. A response is passed as one or more items,
+ * the last one having xIsLastChunk set. The body is included to avoid pointer
+ * inaccuracy during queue copy operations.
  */
 typedef struct ResponseItem
 {
-    HTTPResponse_t xResponse;
-    uint8_t ucResponseBuffer[ democonfigUSER_BUFFER_LENGTH ];
+    uint16_t usStatusCode;
+    size_t xFileSize;        /**< The file size from the Content-Range header. */
+    size_t xOffset;          /**< The position of ucBody in the file. */
+    size_t xLength;          /**< The number of bytes in ucBody. */
+    BaseType_t xIsLastChunk; /**< pdTRUE for the last item of a response. */
+    uint8_t ucBody[ httpexampleRESPONSE_CHUNK_LENGTH ];
 } ResponseItem_t;
 
+/**
+ * @brief The state used to size the range requests.
+ */
+typedef struct RangeEstimator
+{
+    uint32_t ulMinRttMs;       /**< The shortest request seen, taken as the round trip time. */
+    uint32_t ulBytesPerSecond; /**< The smoothed throughput, 0 until measured. */
+    BaseType_t xHasRtt;        /**< pdTRUE once a request has been measured. */
+} RangeEstimator_t;
+
 /**
  * @brief Struct used by the request task to add requests to the request queue.
  *
@@ -287,15 +342,36 @@ static ResponseItem_t xResponseItem = { 0 };
 static RequestItem_t xDownloadReqItem = { 0 };
 
 /**
- * @brief Struct used by the main HTTP task to receive responses from the server
- * and place them on the response queue.
+ * @brief Struct used by the main HTTP task to place the pieces of a response
+ * on the response queue.
  *
  * This structure is modified only by the main HTTP task. Since queue operations
  * are done by-copy, it is safe for the main task to modify this struct once the
- * previous response has been successfully enqueued.
+ * previous piece has been successfully enqueued.
  */
 static ResponseItem_t xDownloadRespItem = { 0 };
 
+/**
+ * @brief The response received by the main HTTP task from the server.
+ */
+static HTTPResponse_t xDownloadResponse = { 0 };
+
+/**
+ * @brief The buffer the main HTTP task receives responses into.
+ */
+static uint8_t ucDownloadBuffer[ democonfigRESPONSE_BUFFER_LENGTH ];
+
+/**
+ * @brief The measurements of the main HTTP task used to size the ranges.
+ */
+static RangeEstimator_t xRangeEstimator;
+
+/**
+ * @brief The number of bytes to request with the next range request. Written
+ * by the main HTTP task, read by the request task.
+ */
+static size_t xRangeLength = democonfigRANGE_REQUEST_LENGTH;
+
 /**
  * @brief Queue for HTTP requests. Requests are enqueued by the request task,
  * and dequeued by the main HTTP task.
@@ -328,11 +404,6 @@ static TaskHandle_t xMainTask;
  */
 static size_t xFileSize = 0;
 
-/**
- * @brief The number of responses expected by the response task.
- */
-static size_t xResponseCount = 0;
-
 /*-----------------------------------------------------------*/
 
 /**
@@ -427,6 +498,41 @@ static void prvResponseTask( void * pvArgs );
  */
 static BaseType_t prvDownloadLoop( void );
 
+/**
+ * @brief Parse the value of a Content-Range header, e.g. "bytes 0-1023/4096".
+ *
+ * @param[in] pcValue The header value, not NUL terminated.
+ * @param[in] xValueLength The length of pcValue.
+ * @param[out] pxStart The position of the first byte of the range.
+ * @param[out] pxFileSize The size of the file.
+ *
+ * @return pdPASS if the value was parsed; pdFAIL otherwise.
+ */
+static BaseType_t prvParseContentRange( const char * pcValue,
+                                        size_t xValueLength,
+                                        size_t * pxStart,
+                                        size_t * pxFileSize );
+
+/**
+ * @brief Pass the body of a response on to the response task, in as many
+ * response queue items as needed. Called by the main task for each response.
+ *
+ * @param[in] pxResponse The response received from the server.
+ *
+ * @return pdFAIL on failure; pdPASS on success.
+ */
+static BaseType_t prvStreamResponseBody( const HTTPResponse_t * pxResponse );
+
+/**
+ * @brief Update the range length from the time taken by a request.
+ *
+ * @param[in] xBodyLength The number of body bytes received.
+ * @param[in] xElapsed The time from sending the request to the end of its
+ * response.
+ */
+static void prvUpdateRangeLength( size_t xBodyLength,
+                                  TickType_t xElapsed );
+
 /*-----------------------------------------------------------*/
 
 extern BaseType_t xPlatformIsNetworkUp( void );
@@ -579,6 +685,11 @@ static void prvHTTPDemoTask( void * pvParameters )
         /************* Open queues and create additional tasks. *************/
         if( xDemoStatus == pdPASS )
         {
+            /* Start each download with small ranges. */
+            memset( &xRangeEstimator, 0, sizeof( xRangeEstimator ) );
+            xRangeLength = democonfigRANGE_REQUEST_LENGTH;
+            xFileSize = 0;
+
             /* Open request and response queues. */
             xRequestQueue = xQueueCreate( democonfigQUEUE_SIZE,
                                           sizeof( RequestItem_t ) );
@@ -842,24 +953,25 @@ static void prvRequestTask( void * pvArgs )
         }
     }
 
-    /* Set the number of bytes to request in each iteration, defined by the user
-     * in democonfigRANGE_REQUEST_LENGTH. */
-    if( xFileSize < democonfigRANGE_REQUEST_LENGTH )
-    {
-        xNumReqBytes = xFileSize;
-    }
-    else
-    {
-        xNumReqBytes = democonfigRANGE_REQUEST_LENGTH;
-    }
-
-    /* Here we continuously add range requests to the request queue (and keep
-     * track of their count, with xResponseCount), until the entire length of
-     * the file has been requested. We keep track of the next starting byte to
-     * download with xCurByte, and increment by xNumReqBytes after each
-     * iteration, until xCurByte has reached xFileSize. */
+    /* Here we continuously add range requests to the request queue, until the
+     * entire length of the file has been requested. We keep track of the next
+     * starting byte to download with xCurByte, and increment by xNumReqBytes
+     * after each iteration, until xCurByte has reached xFileSize. */
     while( ( xStatus != pdFAIL ) && ( xCurByte < xFileSize ) )
     {
+        /* Request as many bytes as the main task last found to keep the
+         * connection busy. As requests are queued ahead, the change shows
+         * after at most democonfigQUEUE_SIZE requests. */
+        xNumReqBytes = xRangeLength;
+
+        /* If the number of bytes left to download is less than xNumReqBytes,
+         * set xNumReqBytes to equal the accurate number of remaining bytes
+         * left to download. */
+        if( ( xFileSize - xCurByte ) < xNumReqBytes )
+        {
+            xNumReqBytes = xFileSize - xCurByte;
+        }
+
         /* Add range request to the request queue. */
         xStatus = prvRequestS3ObjectRange( &xRequestInfo,
                                            xCurByte,
@@ -867,18 +979,6 @@ static void prvRequestTask( void * pvArgs )
 
         /* Update the starting byte for the next iteration.*/
         xCurByte += xNumReqBytes;
-
-        /* If the number of bytes left to download is less than the
-         * pre-defined constant xNumReqBytes, set xNumReqBytes to equal the
-         * accurate number of remaining bytes left to download. */
-        if( ( xFileSize - xCurByte ) < xNumReqBytes )
-        {
-            xNumReqBytes = xFileSize - xCurByte;
-        }
-
-        /* If the request was successfully enqueued, we expect a
-         * corresponding response. */
-        xResponseCount += 1;
     }
 
     /* Clear this task's notifications. */
@@ -898,74 +998,35 @@ static void prvRequestTask( void * pvArgs )
 static BaseType_t prvReadFileSize( void )
 {
     BaseType_t xStatus = pdPASS;
-    HTTPStatus_t xHTTPStatus = HTTPSuccess;
-
-    /* The location of the file size in pcContentRangeValStr. */
-    char * pcFileSizeStr = NULL;
-
-    /* String to store the Content-Range header value. */
-    char * pcContentRangeValStr = NULL;
-    size_t xContentRangeValStrLength = 0;
 
     for( ; ; )
     {
         if( xQueueReceive( xResponseQueue, &xResponseItem, httpexampleDEMO_TICKS_TO_WAIT ) != pdFAIL )
         {
-            /* Ensure that the buffer pointer is accurate after being copied from the queue. */
-            xResponseItem.xResponse.pBuffer = xResponseItem.ucResponseBuffer;
-
             /* Ensure that we received a successful response from the server. */
-            if( xResponseItem.xResponse.statusCode != httpexampleHTTP_STATUS_CODE_PARTIAL_CONTENT )
+            if( xResponseItem.usStatusCode != httpexampleHTTP_STATUS_CODE_PARTIAL_CONTENT )
+            {
+                LogError( ( "Received response with unexpected status code: %d.", xResponseItem.usStatusCode ) );
+                xStatus = pdFAIL;
+            }
+            /* The response to the file size request has a single byte, so it
+             * is passed in one item. */
+            else if( xResponseItem.xIsLastChunk != pdTRUE )
             {
-                LogError( ( "Received response with unexpected status code: %d.", xResponseItem.xResponse.statusCode ) );
+                LogError( ( "Received more than one byte in response to the file size request." ) );
                 xStatus = pdFAIL;
             }
             else
             {
-                xHTTPStatus = HTTPClient_ReadHeader( &xResponseItem.xResponse,
-                                                     ( char * ) httpexampleHTTP_CONTENT_RANGE_HEADER_FIELD,
-                                                     ( size_t ) httpexampleHTTP_CONTENT_RANGE_HEADER_FIELD_LENGTH,
-                                                     ( const char ** ) &pcContentRangeValStr,
-                                                     &xContentRangeValStrLength );
-
-                if( xHTTPStatus != HTTPSuccess )
-                {
-                    LogError( ( "Failed to read Content-Range header from HTTP response: Error=%s.",
-                                HTTPClient_strerror( xHTTPStatus ) ) );
-                    xStatus = pdFAIL;
-                }
+                /* The main task read the file size from the Content-Range
+                 * header. */
+                xFileSize = xResponseItem.xFileSize;
             }
 
             break;
         }
     }
 
-    /* Parse the Content-Range header value to get the file size. */
-    if( xStatus == pdPASS )
-    {
-        pcFileSizeStr = strstr( pcContentRangeValStr, "/" );
-
-        if( pcFileSizeStr == NULL )
-        {
-            LogError( ( "'/' not present in Content-Range header value: %s.",
-                        pcContentRangeValStr ) );
-            xStatus = pdFAIL;
-        }
-    }
-
-    if( xStatus == pdPASS )
-    {
-        pcFileSizeStr += sizeof( char );
-        xFileSize = ( size_t ) strtoul( pcFileSizeStr, NULL, 10 );
-
-        if( ( xFileSize == 0 ) || ( xFileSize == UINT32_MAX ) )
-        {
-            LogError( ( "Error using strtoul to get the file size from %s: xFileSize=%d.",
-                        pcFileSizeStr, ( int32_t ) xFileSize ) );
-            xStatus = pdFAIL;
-        }
-    }
-
     if( xStatus == pdPASS )
     {
         LogInfo( ( "The file is %d bytes long.", ( int32_t ) xFileSize ) );
@@ -981,6 +1042,9 @@ static void prvResponseTask( void * pvArgs )
     uint32_t ulWaitCounter = 0UL;
     uint32_t ulNotification = 0UL;
     size_t xNumResponses = 0;
+    /* The number of bytes of the file received so far. */
+    size_t xBytesReceived = 0;
+    BaseType_t xStatus = pdPASS;
 
     ( void ) pvArgs;
 
@@ -999,36 +1063,56 @@ static void prvResponseTask( void * pvArgs )
             /* Retrieve response from the response queue, if available. */
             while( ( xQueueReceive( xResponseQueue, &xResponseItem, httpexampleDEMO_TICKS_TO_WAIT ) != pdFAIL ) )
             {
-                /* Ensure that the buffer pointer is accurate after being copied from the queue. */
-                xResponseItem.xResponse.pBuffer = xResponseItem.ucResponseBuffer;
-
-                /* Log contents of server response. */
-                LogInfo( ( "The response task retrieved a server response from the response queue." ) );
-                LogDebug( ( "Response Headers:\n%.*s",
-                            ( int32_t ) xResponseItem.xResponse.headersLen,
-                            xResponseItem.xResponse.pHeaders ) );
-                LogDebug( ( "Response Status:\n%u",
-                            xResponseItem.xResponse.statusCode ) );
-                LogInfo( ( "Response Body:\n%.*s\n",
-                           ( int32_t ) xResponseItem.xResponse.bodyLen,
-                           xResponseItem.xResponse.pBody ) );
-
                 /* Check for a partial content status code (206), indicating a
                  * successful server response. */
-                if( xResponseItem.xResponse.statusCode != httpexampleHTTP_STATUS_CODE_PARTIAL_CONTENT )
+                if( xResponseItem.usStatusCode != httpexampleHTTP_STATUS_CODE_PARTIAL_CONTENT )
                 {
-                    LogError( ( "Received response with unexpected status code: %d", xResponseItem.xResponse.statusCode ) );
+                    LogError( ( "Received response with unexpected status code: %d", xResponseItem.usStatusCode ) );
+                    xStatus = pdFAIL;
                     break;
                 }
 
-                /* Increment the number of responses found on the queue. */
-                xNumResponses += 1;
+                /* The ranges are requested in order over a single connection,
+                 * so each piece must follow the previous one. */
+                if( xResponseItem.xOffset != xBytesReceived )
+                {
+                    LogError( ( "Received bytes from position %d, expected position %d.",
+                                ( int32_t ) xResponseItem.xOffset,
+                                ( int32_t ) xBytesReceived ) );
+                    xStatus = pdFAIL;
+                    break;
+                }
+
+                /* Log contents of server response. */
+                LogDebug( ( "Response Body:\n%.*s\n",
+                            ( int32_t ) xResponseItem.xLength,
+                            xResponseItem.ucBody ) );
+
+                xBytesReceived += xResponseItem.xLength;
+
+                if( xResponseItem.xIsLastChunk == pdTRUE )
+                {
+                    /* Increment the number of responses found on the queue. */
+                    xNumResponses += 1;
+                    LogInfo( ( "The response task retrieved server response %d, %d of %d bytes received.",
+                               ( int32_t ) xNumResponses,
+                               ( int32_t ) xBytesReceived,
+                               ( int32_t ) xFileSize ) );
+                }
+
                 /* Reset the wait counter every time a response is received. */
                 ulWaitCounter = 0;
             }
 
-            /* Break if we have received all expected responses. */
-            if( xNumResponses >= xResponseCount )
+            if( xStatus != pdPASS )
+            {
+                /* Notify the main task of failure. */
+                xTaskNotify( xMainTask, httpexampleHTTP_FAILURE, eSetBits );
+                break;
+            }
+
+            /* Break if the whole file has been received. */
+            if( xBytesReceived >= xFileSize )
             {
                 break;
             }
@@ -1094,6 +1178,7 @@ static BaseType_t prvDownloadLoop( void )
     BaseType_t xStatus = pdPASS;
     uint32_t ulNotification = 0UL;
     uint32_t ulWaitCounter = 0UL;
+    TickType_t xRequestStart;
 
     /* Expected task completion notifications. */
     uint32_t ulExpectedNotifications = httpexampleREQUEST_TASK_COMPLETION |
@@ -1105,8 +1190,8 @@ static BaseType_t prvDownloadLoop( void )
     xTransportInterface.recv = TLS_FreeRTOS_recv;
 
     /* Initialize response struct. */
-    xDownloadRespItem.xResponse.pBuffer = xDownloadRespItem.ucResponseBuffer;
-    xDownloadRespItem.xResponse.bufferLen = democonfigUSER_BUFFER_LENGTH;
+    xDownloadResponse.pBuffer = ucDownloadBuffer;
+    xDownloadResponse.bufferLen = democonfigRESPONSE_BUFFER_LENGTH;
 
     for( ; ; )
     {
@@ -1141,11 +1226,12 @@ static BaseType_t prvDownloadLoop( void )
                     ( char * ) xDownloadReqItem.xRequestHeaders.pBuffer ) );
 
         /* Send request to the S3 server. */
+        xRequestStart = xTaskGetTickCount();
         xHTTPStatus = HTTPClient_Send( &xTransportInterface,
                                        &xDownloadReqItem.xRequestHeaders,
                                        NULL,
                                        0,
-                                       &xDownloadRespItem.xResponse,
+                                       &xDownloadResponse,
                                        0 );
 
         if( xHTTPStatus != HTTPSuccess )
@@ -1163,10 +1249,12 @@ static BaseType_t prvDownloadLoop( void )
         {
             LogInfo( ( "The HTTP task received a response from the server. Adding to response queue." ) );
 
+            /* Size the next ranges from how long this one took. */
+            prvUpdateRangeLength( xDownloadResponse.bodyLen,
+                                  xTaskGetTickCount() - xRequestStart );
+
             /* Add response to response queue. */
-            xStatus = xQueueSendToBack( xResponseQueue,
-                                        &xDownloadRespItem,
-                                        httpexampleDEMO_TICKS_TO_WAIT );
+            xStatus = prvStreamResponseBody( &xDownloadResponse );
 
             /* Ensure response was added to the queue successfully. */
             if( xStatus != pdPASS )
@@ -1188,5 +1276,240 @@ static BaseType_t prvDownloadLoop( void )
         }
     }
 
+    /* The response task reports a response it could not use. */
+    if( ( ulNotification & httpexampleHTTP_FAILURE ) != 0U )
+    {
+        xStatus = pdFAIL;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseContentRange( const char * pcValue,
+                                        size_t xValueLength,
+                                        size_t * pxStart,
+                                        size_t * pxFileSize )
+{
+    /* The value looks like "bytes START-END/SIZE". The numbers are read in
+     * turn, each after the separator that precedes it. */
+    static const char cSeparators[ 3 ] = { ' ', '-', '/' };
+    size_t xNumbers[ 3 ] = { 0 };
+    size_t xIndex = 0;
+    size_t xNumber;
+    BaseType_t xStatus = pdPASS;
+    BaseType_t xHasDigits;
+
+    configASSERT( pcValue != NULL );
+
+    for( xNumber = 0; ( xNumber < 3U ) && ( xStatus == pdPASS ); xNumber++ )
+    {
+        while( ( xIndex < xValueLength ) && ( pcValue[ xIndex ] != cSeparators[ xNumber ] ) )
+        {
+            xIndex++;
+        }
+
+        xIndex++;
+        xHasDigits = pdFALSE;
+
+        while( ( xIndex < xValueLength ) && ( pcValue[ xIndex ] >= '0' ) && ( pcValue[ xIndex ] <= '9' ) )
+        {
+            xNumbers[ xNumber ] = ( xNumbers[ xNumber ] * 10U ) + ( size_t ) ( pcValue[ xIndex ] - '0' );
+            xHasDigits = pdTRUE;
+            xIndex++;
+        }
+
+        if( xHasDigits == pdFALSE )
+        {
+            xStatus = pdFAIL;
+        }
+    }
+
+    if( ( xStatus == pdPASS ) && ( ( xNumbers[ 1 ] < xNumbers[ 0 ] ) || ( xNumbers[ 2 ] <= xNumbers[ 1 ] ) ) )
+    {
+        xStatus = pdFAIL;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        *pxStart = xNumbers[ 0 ];
+        *pxFileSize = xNumbers[ 2 ];
+    }
+    else
+    {
+        LogError( ( "Could not parse the Content-Range header value: %.*s.",
+                    ( int32_t ) xValueLength,
+                    pcValue ) );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStreamResponseBody( const HTTPResponse_t * pxResponse )
+{
+    HTTPStatus_t xHTTPStatus = HTTPSuccess;
+    BaseType_t xStatus = pdPASS;
+    const char * pcContentRange = NULL;
+    size_t xContentRangeLength = 0;
+    size_t xSent = 0;
+
+    configASSERT( pxResponse != NULL );
+
+    xDownloadRespItem.usStatusCode = pxResponse->statusCode;
+    xDownloadRespItem.xFileSize = 0;
+    xDownloadRespItem.xOffset = 0;
+
+    /* The position of the body in the file is given by the Content-Range
+     * header of a partial content response. Other responses are passed on
+     * without a body, for the response task to report. */
+    if( pxResponse->statusCode == httpexampleHTTP_STATUS_CODE_PARTIAL_CONTENT )
+    {
+        xHTTPStatus = HTTPClient_ReadHeader( pxResponse,
+                                             httpexampleHTTP_CONTENT_RANGE_HEADER_FIELD,
+                                             httpexampleHTTP_CONTENT_RANGE_HEADER_FIELD_LENGTH,
+                                             &pcContentRange,
+                                             &xContentRangeLength );
+
+        if( xHTTPStatus != HTTPSuccess )
+        {
+            LogError( ( "Failed to read Content-Range header from HTTP response: Error=%s.",
+                        HTTPClient_strerror( xHTTPStatus ) ) );
+            xStatus = pdFAIL;
+        }
+        else
+        {
+            xStatus = prvParseContentRange( pcContentRange,
+                                            xContentRangeLength,
+                                            &xDownloadRespItem.xOffset,
+                                            &xDownloadRespItem.xFileSize );
+        }
+
+        if( xStatus != pdPASS )
+        {
+            /* Pass the response on as a failed one. */
+            xDownloadRespItem.usStatusCode = 0;
+            xStatus = pdPASS;
+        }
+    }
+
+    /* Enqueue the body in pieces, and at least one item for an empty body. */
+    do
+    {
+        xDownloadRespItem.xLength = 0;
+
+        if( xDownloadRespItem.usStatusCode == httpexampleHTTP_STATUS_CODE_PARTIAL_CONTENT )
+        {
+            xDownloadRespItem.xLength = pxResponse->bodyLen - xSent;
+
+            if( xDownloadRespItem.xLength > httpexampleRESPONSE_CHUNK_LENGTH )
+            {
+                xDownloadRespItem.xLength = httpexampleRESPONSE_CHUNK_LENGTH;
+            }
+
+            memcpy( xDownloadRespItem.ucBody, &pxResponse->pBody[ xSent ], xDownloadRespItem.xLength );
+        }
+
+        xSent += xDownloadRespItem.xLength;
+        xDownloadRespItem.xIsLastChunk = ( xSent >= pxResponse->bodyLen ) ? pdTRUE : pdFALSE;
+
+        if( xDownloadRespItem.xLength == 0U )
+        {
+            xDownloadRespItem.xIsLastChunk = pdTRUE;
+        }
+
+        xStatus = xQueueSendToBack( xResponseQueue,
+                                    &xDownloadRespItem,
+                                    httpexampleDEMO_TICKS_TO_WAIT );
+
+        xDownloadRespItem.xOffset += xDownloadRespItem.xLength;
+    } while( ( xStatus == pdPASS ) && ( xDownloadRespItem.xIsLastChunk == pdFALSE ) );
+
     return xStatus;
 }
+
+/*-----------------------------------------------------------*/
+
+static void prvUpdateRangeLength( size_t xBodyLength,
+                                  TickType_t xElapsed )
+{
+    uint32_t ulElapsedMs = ( uint32_t ) ( xElapsed * portTICK_PERIOD_MS );
+    uint32_t ulTransferMs;
+    uint32_t ulSample;
+    uint64_t ullTarget;
+
+    /* A request shorter than a tick is counted as a whole tick. */
+    if( ulElapsedMs == 0U )
+    {
+        ulElapsedMs = portTICK_PERIOD_MS;
+    }
+
+    /* The shortest request seen is mostly waiting for the first byte of the
+     * response, so it is taken as the round trip time. The first request is
+     * for a single byte. */
+    if( ( xRangeEstimator.xHasRtt == pdFALSE ) || ( ulElapsedMs < xRangeEstimator.ulMinRttMs ) )
+    {
+        xRangeEstimator.ulMinRttMs = ulElapsedMs;
+        xRangeEstimator.xHasRtt = pdTRUE;
+    }
+
+    /* The rest of the time was spent transferring the body. */
+    ulTransferMs = ulElapsedMs - xRangeEstimator.ulMinRttMs;
+
+    if( ulTransferMs > 0U )
+    {
+        ulSample = ( uint32_t ) ( ( ( uint64_t ) xBodyLength * 1000U ) / ulTransferMs );
+
+        /* Smooth the samples, a single slow request should not shrink the
+         * ranges much. */
+        if( xRangeEstimator.ulBytesPerSecond == 0U )
+        {
+            xRangeEstimator.ulBytesPerSecond = ulSample;
+        }
+        else
+        {
+            xRangeEstimator.ulBytesPerSecond = ( uint32_t ) ( ( ( ( uint64_t ) xRangeEstimator.ulBytesPerSecond * 3U ) + ulSample ) / 4U );
+        }
+    }
+
+    if( xRangeEstimator.ulBytesPerSecond == 0U )
+    {
+        /* The transfer was too quick to measure, so the range is too small
+         * to tell the throughput. */
+        ullTarget = ( uint64_t ) xRangeLength * 2U;
+    }
+    else
+    {
+        /* Request the bytes the connection carries in a few round trips. */
+        ullTarget = ( ( uint64_t ) xRangeEstimator.ulBytesPerSecond * xRangeEstimator.ulMinRttMs * httpexampleRANGE_RTT_MULTIPLE ) / 1000U;
+    }
+
+    /* Grow the ranges by at most twice at a time, so that a rough early
+     * estimate does not cost a long request. */
+    if( ullTarget > ( ( uint64_t ) xRangeLength * 2U ) )
+    {
+        ullTarget = ( uint64_t ) xRangeLength * 2U;
+    }
+
+    if( ullTarget > httpexampleMAX_RANGE_LENGTH )
+    {
+        ullTarget = httpexampleMAX_RANGE_LENGTH;
+    }
+    else if( ullTarget < democonfigRANGE_REQUEST_LENGTH )
+    {
+        ullTarget = democonfigRANGE_REQUEST_LENGTH;
+    }
+
+    if( ( size_t ) ullTarget != xRangeLength )
+    {
+        LogDebug( ( "Range length changed from %d to %d bytes: RTT=%ums, throughput=%u bytes/s.",
+                    ( int32_t ) xRangeLength,
+                    ( int32_t ) ullTarget,
+                    ( unsigned ) xRangeEstimator.ulMinRttMs,
+                    ( unsigned ) xRangeEstimator.ulBytesPerSecond ) );
+    }
+
+    xRangeLength = ( size_t ) ullTarget;
+}
@@ -128,14 +128,23 @@ extern void vLoggingPrintf( const char * pcFormatString,
 #define democonfigUSER_BUFFER_LENGTH                ( 2048 )
 
 /**
- * @brief The size of the range of the file to download, with each request.
+ * @brief The size of the range of the file to download with the first
+ * requests, and the smallest range requested.
  *
- * @note This should account for the response headers that will also be stored
- * in the user buffer. We don't expect S3 to send more than 1024 bytes of
- * headers.
+ * @note The range size grows from this value to keep the connection busy, as
+ * measured from the throughput and round trip time of past requests.
  */
 #define democonfigRANGE_REQUEST_LENGTH              ( 1024 )
 
+/**
+ * @brief The length in bytes of the buffer the responses are received into.
+ *
+ * @note This bounds the largest range requested, less 1024 bytes kept for the
+ * response headers. The body is handed on to the response task in pieces, so
+ * only the main task needs a buffer of this size.
+ */
+#define democonfigRESPONSE_BUFFER_LENGTH            ( 32 * 1024 )
+
 /**
  * @brief The number of items that can be held in each queue.
  */
@@ -34,7 +34,14 @@
  * the HTTP server so that all communication is encrypted. After which, the HTTP
  * Client library API is used to upload a file to a S3 bucket by sending a PUT
  * request, and verify the file was uploaded using a GET request. If any request
- * fails, an error code is returned.
+ * request fails, an error code is returned.
+ *
+ * When pre-signed multipart upload URLs are defined in demo_config.h, a larger
+ * object is uploaded instead, in parts of democonfigS3_MULTIPART_PART_SIZE
+ * bytes.  democonfigS3_MULTIPART_WORKERS parts are uploaded at the same time,
+ * each over its own connection of a connection pool, a part that fails is sent
+ * again on its own, and the parts are read from the object while they are
+ * sent, see s3_multipart_upload.h.
  *
  * @note This demo requires user-generated pre-signed URLs to be pasted into
  * demo_config.h. Please use the provided script "presigned_urls_gen.py"
@@ -68,6 +75,14 @@
 /* Common HTTP demo utilities. */
 #include "http_demo_utils.h"
 
+/* Multipart upload of large objects. */
+#include "s3_multipart_upload.h"
+
+#ifdef democonfigS3_UPLOAD_FILE_PATH
+    /* Reliance Edge POSIX-like API, to read the file to upload. */
+    #include <redposix.h>
+#endif
+
 /*------------- Demo configurations -------------------------*/
 
 /* Check that the root CA certificate is defined. */
@@ -105,6 +120,46 @@
     #define democonfigDEMO_HTTP_UPLOAD_DATA    "Hello World!"
 #endif
 
+/**
+ * @brief The object is uploaded in parts when the pre-signed part URLs are
+ * defined.
+ */
+#ifdef democonfigS3_PRESIGNED_PART_URLS
+    #define httpexampleMULTIPART_UPLOAD    1
+#else
+    #define httpexampleMULTIPART_UPLOAD    0
+#endif
+
+#if ( httpexampleMULTIPART_UPLOAD == 1 )
+
+/* Check that the pre-signed CompleteMultipartUpload URL is defined. */
+    #ifndef democonfigS3_PRESIGNED_COMPLETE_URL
+        #error "Please define democonfigS3_PRESIGNED_COMPLETE_URL in demo_config.h."
+    #endif
+
+/* The size of every part but the last. */
+    #ifndef democonfigS3_MULTIPART_PART_SIZE
+        #define democonfigS3_MULTIPART_PART_SIZE    s3multipartMIN_PART_SIZE
+    #endif
+
+/* The number of parts uploaded at the same time. */
+    #ifndef democonfigS3_MULTIPART_WORKERS
+        #define democonfigS3_MULTIPART_WORKERS    ( 3U )
+    #endif
+
+/* The most bytes of a part read from the object and sent at a time. */
+    #ifndef democonfigS3_MULTIPART_CHUNK_LENGTH
+        #define democonfigS3_MULTIPART_CHUNK_LENGTH    ( 1024U )
+    #endif
+
+/**
+ * @brief How long an open connection may stay unused before it is closed
+ * instead of reused. Kept below the keep-alive timeout of S3.
+ */
+    #define httpexampleHTTP_POOL_IDLE_TIMEOUT_TICKS    ( pdMS_TO_TICKS( 4000U ) )
+
+#endif /* if ( httpexampleMULTIPART_UPLOAD == 1 ) */
+
 /**
  * @brief Length of the pre-signed GET URL defined in demo_config.h.
  */
@@ -222,6 +277,75 @@ static size_t xServerHostLength;
  */
 static const char * pcRequestURI;
 
+/**
+ * @brief The size of the object uploaded, checked against the size found on
+ * S3.
+ */
+static size_t xUploadObjectSize = httpexampleDEMO_HTTP_UPLOAD_DATA_LENGTH;
+
+#if ( httpexampleMULTIPART_UPLOAD == 1 )
+
+/**
+ * @brief The pre-signed UploadPart URLs, in the order of the parts.
+ */
+    static const char * const pcPresignedPartUrls[] = democonfigS3_PRESIGNED_PART_URLS;
+
+/**
+ * @brief The number of parts.
+ */
+    #define httpexampleMULTIPART_PART_COUNT    ( sizeof( pcPresignedPartUrls ) / sizeof( pcPresignedPartUrls[ 0 ] ) )
+
+/* The size of the object generated for the upload, half a part more than the
+ * other parts.  Not used when the object is read from democonfigS3_UPLOAD_FILE_PATH. */
+    #ifndef democonfigS3_MULTIPART_OBJECT_SIZE
+        #define democonfigS3_MULTIPART_OBJECT_SIZE \
+    ( ( ( httpexampleMULTIPART_PART_COUNT - 1U ) * democonfigS3_MULTIPART_PART_SIZE ) + ( democonfigS3_MULTIPART_PART_SIZE / 2U ) )
+    #endif
+
+/**
+ * @brief The length of the buffer for the list of the parts sent to complete
+ * the upload.
+ */
+    #define httpexampleCOMPLETE_BODY_LENGTH    ( ( httpexampleMULTIPART_PART_COUNT * 96U ) + 64U )
+
+/**
+ * @brief The upload, kept across demo iterations so that a retried iteration
+ * only sends the parts that were not uploaded yet.
+ */
+    static S3MultipartUpload_t xMultipartUpload;
+    static S3MultipartPart_t xMultipartParts[ httpexampleMULTIPART_PART_COUNT ];
+
+/**
+ * @brief The buffers of the tasks uploading the parts.
+ */
+    static S3MultipartWorker_t xMultipartWorkers[ democonfigS3_MULTIPART_WORKERS ];
+    static uint8_t ucWorkerBuffers[ democonfigS3_MULTIPART_WORKERS ][ democonfigUSER_BUFFER_LENGTH ];
+    static uint8_t ucWorkerChunks[ democonfigS3_MULTIPART_WORKERS ][ democonfigS3_MULTIPART_CHUNK_LENGTH ];
+
+/**
+ * @brief The list of the parts sent to complete the upload.
+ */
+    static char cCompleteBody[ httpexampleCOMPLETE_BODY_LENGTH ];
+
+/**
+ * @brief The connections used to upload the parts, one per worker.
+ */
+    static HTTPConnectionPool_t xConnectionPool;
+    static HTTPPooledConnection_t xPooledConnections[ democonfigS3_MULTIPART_WORKERS ];
+    static NetworkContext_t xPoolNetworkContexts[ democonfigS3_MULTIPART_WORKERS ];
+    static TlsTransportParams_t xPoolTlsTransportParams[ democonfigS3_MULTIPART_WORKERS ];
+
+    #ifdef democonfigS3_UPLOAD_FILE_PATH
+
+/**
+ * @brief The file uploaded, and the mutex serializing the reads of the tasks
+ * uploading its parts.
+ */
+        static int32_t lUploadFile = -1;
+        static SemaphoreHandle_t xUploadFileMutex;
+    #endif
+#endif /* if ( httpexampleMULTIPART_UPLOAD == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -232,6 +356,13 @@ static const char * pcRequestURI;
  */
 static void prvHTTPDemoTask( void * pvParameters );
 
+/**
+ * @brief Copy the host of democonfigS3_PRESIGNED_GET_URL to cServerHost.
+ *
+ * @return pdPASS on success; pdFAIL otherwise.
+ */
+static BaseType_t prvParseServerHost( void );
+
 /**
  * @brief Connect to HTTP server with reconnection retries.
  *
@@ -293,6 +424,35 @@ static BaseType_t prvUploadS3ObjectFile( const TransportInterface_t * pxTranspor
 static BaseType_t prvVerifyS3ObjectFileSize( const TransportInterface_t * pxTransportInterface,
                                              const char * pcPath );
 
+#if ( httpexampleMULTIPART_UPLOAD == 1 )
+
+/**
+ * @brief Upload the object in parts over the connection pool, then complete
+ * the multipart upload.
+ *
+ * @return pdPASS on success; pdFAIL otherwise.
+ */
+    static BaseType_t prvMultipartUploadS3Object( void );
+
+/**
+ * @brief Read the object uploaded in parts, see S3ObjectRead_t.
+ *
+ * Without democonfigS3_UPLOAD_FILE_PATH, the object is democonfigDEMO_HTTP_UPLOAD_DATA
+ * repeated, generated as it is read.
+ *
+ * @param[in] pvReaderContext Not used.
+ * @param[in] xOffset The offset in the object of the first byte to read.
+ * @param[out] pucBuffer The buffer to read into.
+ * @param[in] xLength The number of bytes to read.
+ *
+ * @return pdPASS on success; pdFAIL otherwise.
+ */
+    static BaseType_t prvReadUploadObject( void * pvReaderContext,
+                                           size_t xOffset,
+                                           uint8_t * pucBuffer,
+                                           size_t xLength );
+#endif /* if ( httpexampleMULTIPART_UPLOAD == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 extern BaseType_t xPlatformIsNetworkUp( void );
@@ -335,7 +495,7 @@ void vStartSimpleHTTPDemo( void )
 static void prvHTTPDemoTask( void * pvParameters )
 {
     /* The transport layer interface used by the HTTP Client library. */
-    TransportInterface_t xTransportInterface;
+    TransportInterface_t xTransportInterface = { 0 };
     /* The network context for the transport layer interface. */
     NetworkContext_t xNetworkContext = { 0 };
     TlsTransportParams_t xTlsTransportParams = { 0 };
@@ -363,6 +523,52 @@ static void prvHTTPDemoTask( void * pvParameters )
     LogInfo( ( "HTTP Client Synchronous S3 upload demo using pre-signed URL:\n%s",
                democonfigS3_PRESIGNED_PUT_URL ) );
 
+    /* Every connection, including those of the pool, is made to the host of
+     * the pre-signed URLs. */
+    xDemoStatus = prvParseServerHost();
+    configASSERT( xDemoStatus == pdPASS );
+
+    #if ( httpexampleMULTIPART_UPLOAD == 1 )
+    {
+        UBaseType_t uxIndex;
+
+        for( uxIndex = 0; uxIndex < democonfigS3_MULTIPART_WORKERS; uxIndex++ )
+        {
+            xPoolNetworkContexts[ uxIndex ].pParams = &xPoolTlsTransportParams[ uxIndex ];
+            xMultipartWorkers[ uxIndex ].pucBuffer = ucWorkerBuffers[ uxIndex ];
+            xMultipartWorkers[ uxIndex ].xBufferLength = democonfigUSER_BUFFER_LENGTH;
+            xMultipartWorkers[ uxIndex ].pucChunk = ucWorkerChunks[ uxIndex ];
+            xMultipartWorkers[ uxIndex ].xChunkLength = democonfigS3_MULTIPART_CHUNK_LENGTH;
+        }
+
+        for( uxIndex = 0; uxIndex < httpexampleMULTIPART_PART_COUNT; uxIndex++ )
+        {
+            xMultipartParts[ uxIndex ].pcPresignedUrl = pcPresignedPartUrls[ uxIndex ];
+        }
+
+        xDemoStatus = xHTTPConnectionPoolInit( &xConnectionPool,
+                                               xPooledConnections,
+                                               xPoolNetworkContexts,
+                                               democonfigS3_MULTIPART_WORKERS,
+                                               TLS_FreeRTOS_Disconnect,
+                                               httpexampleHTTP_POOL_IDLE_TIMEOUT_TICKS );
+        configASSERT( xDemoStatus == pdPASS );
+
+        xMultipartUpload.pxPool = &xConnectionPool;
+        xMultipartUpload.connectFunction = prvConnectToServer;
+        xMultipartUpload.sendFunction = TLS_FreeRTOS_send;
+        xMultipartUpload.recvFunction = TLS_FreeRTOS_recv;
+        xMultipartUpload.pcHost = cServerHost;
+        xMultipartUpload.usPort = democonfigHTTPS_PORT;
+        xMultipartUpload.xObjectSize = democonfigS3_MULTIPART_OBJECT_SIZE;
+        xMultipartUpload.xPartSize = democonfigS3_MULTIPART_PART_SIZE;
+        xMultipartUpload.pxParts = xMultipartParts;
+        xMultipartUpload.xPartCount = httpexampleMULTIPART_PART_COUNT;
+        xMultipartUpload.readFunction = prvReadUploadObject;
+        xMultipartUpload.pvReaderContext = NULL;
+    }
+    #endif /* if ( httpexampleMULTIPART_UPLOAD == 1 ) */
+
     /* This demo runs once, unless there are failures in the demo execution. In
      * case of failures, the demo loop will run up to HTTP_MAX_DEMO_LOOP_COUNT
      * times. */
@@ -381,6 +587,20 @@ static void prvHTTPDemoTask( void * pvParameters )
             }
         }
 
+        /*************************** Upload in parts. ***************************/
+
+        #if ( httpexampleMULTIPART_UPLOAD == 1 )
+        {
+            /* The parts are uploaded over the connections of the pool, the
+             * connection below is only used to verify the object. */
+            xDemoStatus = prvMultipartUploadS3Object();
+        }
+        #else
+        {
+            xDemoStatus = pdPASS;
+        }
+        #endif
+
         /**************************** Connect. ******************************/
 
         /* Attempt to connect to the HTTP server. If connection fails, retry after a
@@ -388,8 +608,19 @@ static void prvHTTPDemoTask( void * pvParameters )
          * maximum number of attempts or the maximum timeout value is reached. The
          * function returns pdFAIL if the TCP connection cannot be established with
          * the server after configured number of attempts. */
-        xDemoStatus = connectToServerWithBackoffRetries( prvConnectToServer,
-                                                         &xNetworkContext );
+        if( xDemoStatus == pdPASS )
+        {
+            xDemoStatus = connectToServerWithBackoffRetries( prvConnectToServer,
+                                                             &xNetworkContext );
+
+            if( xDemoStatus == pdFAIL )
+            {
+                /* Log an error to indicate connection failure after all
+                 * reconnect attempts are over. */
+                LogError( ( "Failed to connect to HTTP server %s.",
+                            cServerHost ) );
+            }
+        }
 
         if( xDemoStatus == pdPASS )
         {
@@ -401,16 +632,10 @@ static void prvHTTPDemoTask( void * pvParameters )
             xTransportInterface.send = TLS_FreeRTOS_send;
             xTransportInterface.recv = TLS_FreeRTOS_recv;
         }
-        else
-        {
-            /* Log an error to indicate connection failure after all
-             * reconnect attempts are over. */
-            LogError( ( "Failed to connect to HTTP server %s.",
-                        cServerHost ) );
-        }
 
         /********************** Upload S3 Object File. **********************/
 
+        #if ( httpexampleMULTIPART_UPLOAD == 0 )
         if( xDemoStatus == pdPASS )
         {
             /* Retrieve the path location from democonfigS3_PRESIGNED_PUT_URL. This
@@ -429,6 +654,7 @@ static void prvHTTPDemoTask( void * pvParameters )
             xDemoStatus = prvUploadS3ObjectFile( &xTransportInterface,
                                                  pcRequestURI );
         }
+        #endif /* if ( httpexampleMULTIPART_UPLOAD == 0 ) */
 
         /******************* Verify S3 Object File Upload. ********************/
 
@@ -460,6 +686,7 @@ static void prvHTTPDemoTask( void * pvParameters )
         {
             /* Close the network connection.  */
             TLS_FreeRTOS_Disconnect( &xNetworkContext );
+            xIsConnectionEstablished = pdFALSE;
         }
 
         /*********************** Retry in case of failure. ************************/
@@ -481,10 +708,24 @@ static void prvHTTPDemoTask( void * pvParameters )
         else
         {
             LogError( ( "All %d demo iterations failed.", HTTP_MAX_DEMO_LOOP_COUNT ) );
+
+            #if ( httpexampleMULTIPART_UPLOAD == 1 ) && defined( democonfigS3_PRESIGNED_ABORT_URL )
+            {
+                /* Let S3 free the parts that were uploaded. */
+                ( void ) xS3MultipartAbort( &xMultipartUpload,
+                                            democonfigS3_PRESIGNED_ABORT_URL,
+                                            &xMultipartWorkers[ 0 ] );
+            }
+            #endif
+
             break;
         }
     } while( xDemoStatus != pdPASS );
 
+    #if ( httpexampleMULTIPART_UPLOAD == 1 )
+        vHTTPConnectionPoolCloseIdle( &xConnectionPool );
+    #endif
+
     if( xDemoStatus == pdPASS )
     {
         LogInfo( ( "prvHTTPDemoTask() completed successfully. "
@@ -498,10 +739,8 @@ static void prvHTTPDemoTask( void * pvParameters )
 
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvConnectToServer( NetworkContext_t * pxNetworkContext )
+static BaseType_t prvParseServerHost( void )
 {
-    TlsTransportStatus_t xNetworkStatus;
-    NetworkCredentials_t xNetworkCredentials = { 0 };
     BaseType_t xStatus = pdPASS;
     HTTPStatus_t xHTTPStatus = HTTPSuccess;
 
@@ -522,7 +761,22 @@ static BaseType_t prvConnectToServer( NetworkContext_t * pxNetworkContext )
          * democonfigS3_PRESIGNED_GET_URL. */
         memcpy( cServerHost, pcAddress, xServerHostLength );
         cServerHost[ xServerHostLength ] = '\0';
+    }
 
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvConnectToServer( NetworkContext_t * pxNetworkContext )
+{
+    TlsTransportStatus_t xNetworkStatus;
+    NetworkCredentials_t xNetworkCredentials = { 0 };
+    BaseType_t xStatus = pdPASS;
+
+    /* cServerHost is only read here, as the tasks uploading the parts may
+     * connect at the same time. */
+    {
         xNetworkCredentials.disableSni = democonfigDISABLE_SNI;
         /* Set the credentials for establishing a TLS connection. */
         xNetworkCredentials.pRootCa = ( const unsigned char * ) democonfigROOT_CA_PEM;
@@ -834,20 +1088,145 @@ static BaseType_t prvVerifyS3ObjectFileSize( const TransportInterface_t * pxTran
 
     if( xStatus == pdPASS )
     {
-        if( xFileSize != httpexampleDEMO_HTTP_UPLOAD_DATA_LENGTH )
+        if( xFileSize != xUploadObjectSize )
         {
             LogError( ( "Failed to upload the data to S3. The file size found is %d, but it should be %d.",
                         ( int32_t ) xFileSize,
-                        ( int32_t ) httpexampleDEMO_HTTP_UPLOAD_DATA_LENGTH ) );
+                        ( int32_t ) xUploadObjectSize ) );
+            xStatus = pdFAIL;
         }
         else
         {
             LogInfo( ( "Successfully verified that the size of the file found on S3 matches the file size uploaded "
                        "(Uploaded: %d bytes, Found: %d bytes).",
-                       ( int32_t ) httpexampleDEMO_HTTP_UPLOAD_DATA_LENGTH,
+                       ( int32_t ) xUploadObjectSize,
                        ( int32_t ) xFileSize ) );
         }
     }
 
     return xStatus;
 }
+
+/*-----------------------------------------------------------*/
+
+#if ( httpexampleMULTIPART_UPLOAD == 1 )
+
+    static BaseType_t prvMultipartUploadS3Object( void )
+    {
+        BaseType_t xStatus = pdPASS;
+
+        #ifdef democonfigS3_UPLOAD_FILE_PATH
+            REDSTAT xStat;
+
+            /* The file is opened on the first iteration and stays open for
+             * the retries. The Reliance Edge volume must be mounted. */
+            if( lUploadFile < 0 )
+            {
+                xUploadFileMutex = xSemaphoreCreateMutex();
+                lUploadFile = red_open( democonfigS3_UPLOAD_FILE_PATH, RED_O_RDONLY );
+
+                if( ( xUploadFileMutex == NULL ) ||
+                    ( lUploadFile < 0 ) ||
+                    ( red_fstat( lUploadFile, &xStat ) != 0 ) )
+                {
+                    LogError( ( "Failed to open %s for the upload.",
+                                democonfigS3_UPLOAD_FILE_PATH ) );
+                    xStatus = pdFAIL;
+                }
+                else
+                {
+                    xMultipartUpload.xObjectSize = ( size_t ) xStat.st_size;
+                }
+
+                if( ( xStatus == pdFAIL ) && ( lUploadFile >= 0 ) )
+                {
+                    ( void ) red_close( lUploadFile );
+                    lUploadFile = -1;
+                }
+
+                if( ( xStatus == pdFAIL ) && ( xUploadFileMutex != NULL ) )
+                {
+                    vSemaphoreDelete( xUploadFileMutex );
+                    xUploadFileMutex = NULL;
+                }
+            }
+        #endif /* ifdef democonfigS3_UPLOAD_FILE_PATH */
+
+        if( xStatus == pdPASS )
+        {
+            xUploadObjectSize = xMultipartUpload.xObjectSize;
+
+            LogInfo( ( "Uploading %lu bytes in %lu parts with %u tasks.",
+                       ( unsigned long ) xMultipartUpload.xObjectSize,
+                       ( unsigned long ) xMultipartUpload.xPartCount,
+                       ( unsigned ) democonfigS3_MULTIPART_WORKERS ) );
+
+            xStatus = xS3MultipartUploadParts( &xMultipartUpload,
+                                               xMultipartWorkers,
+                                               democonfigS3_MULTIPART_WORKERS );
+        }
+
+        if( xStatus == pdPASS )
+        {
+            xStatus = xS3MultipartComplete( &xMultipartUpload,
+                                            democonfigS3_PRESIGNED_COMPLETE_URL,
+                                            &xMultipartWorkers[ 0 ],
+                                            cCompleteBody,
+                                            sizeof( cCompleteBody ) );
+        }
+
+        if( xStatus == pdPASS )
+        {
+            LogInfo( ( "Completed the multipart upload." ) );
+        }
+        else
+        {
+            LogError( ( "Failed to upload the object in parts." ) );
+        }
+
+        return xStatus;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvReadUploadObject( void * pvReaderContext,
+                                           size_t xOffset,
+                                           uint8_t * pucBuffer,
+                                           size_t xLength )
+    {
+        BaseType_t xStatus = pdPASS;
+
+        ( void ) pvReaderContext;
+
+        #ifdef democonfigS3_UPLOAD_FILE_PATH
+        {
+            /* The tasks uploading the parts share the file offset. */
+            ( void ) xSemaphoreTake( xUploadFileMutex, portMAX_DELAY );
+
+            if( ( red_lseek( lUploadFile, ( int64_t ) xOffset, RED_SEEK_SET ) != ( int64_t ) xOffset ) ||
+                ( red_read( lUploadFile, pucBuffer, ( uint32_t ) xLength ) != ( int32_t ) xLength ) )
+            {
+                LogError( ( "Failed to read %lu bytes at offset %lu of %s.",
+                            ( unsigned long ) xLength,
+                            ( unsigned long ) xOffset,
+                            democonfigS3_UPLOAD_FILE_PATH ) );
+                xStatus = pdFAIL;
+            }
+
+            ( void ) xSemaphoreGive( xUploadFileMutex );
+        }
+        #else /* ifdef democonfigS3_UPLOAD_FILE_PATH */
+        {
+            size_t xIndex;
+
+            for( xIndex = 0; xIndex < xLength; xIndex++ )
+            {
+                pucBuffer[ xIndex ] = ( uint8_t ) democonfigDEMO_HTTP_UPLOAD_DATA[ ( xOffset + xIndex ) % httpexampleDEMO_HTTP_UPLOAD_DATA_LENGTH ];
+            }
+        }
+        #endif /* ifdef democonfigS3_UPLOAD_FILE_PATH */
+
+        return xStatus;
+    }
+
+#endif /* if ( httpexampleMULTIPART_UPLOAD == 1 ) */
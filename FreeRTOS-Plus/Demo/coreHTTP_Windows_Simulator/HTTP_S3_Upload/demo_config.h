@@ -115,6 +115,43 @@ extern void vLoggingPrintf( const char * pcFormatString,
  * #define democonfigS3_PRESIGNED_PUT_URL         "...insert here..."
  */
 
+/**
+ * @brief The pre-signed URLs of a multipart upload, generated by the same
+ * script run with the --parts option. When they are defined, a larger object
+ * is uploaded in parts, several at a time, instead of with the PUT URL.
+ *
+ * democonfigS3_PRESIGNED_PART_URLS is an initializer with one UploadPart URL
+ * per part, democonfigS3_PRESIGNED_COMPLETE_URL completes the upload and the
+ * optional democonfigS3_PRESIGNED_ABORT_URL aborts it when every demo
+ * iteration failed.
+ *
+ * #define democonfigS3_PRESIGNED_PART_URLS       { "...insert here...", "...insert here..." }
+ * #define democonfigS3_PRESIGNED_COMPLETE_URL    "...insert here..."
+ * #define democonfigS3_PRESIGNED_ABORT_URL       "...insert here..."
+ */
+
+/**
+ * @brief The size of every part of a multipart upload but the last. It must
+ * match the --part-size given to the script, and S3 requires at least 5 MiB.
+ *
+ * #define democonfigS3_MULTIPART_PART_SIZE       ( 5UL * 1024UL * 1024UL )
+ */
+
+/**
+ * @brief The number of parts uploaded at the same time, each by its own task
+ * over its own connection.
+ *
+ * #define democonfigS3_MULTIPART_WORKERS         ( 3U )
+ */
+
+/**
+ * @brief The path of a file on a mounted Reliance Edge volume to upload in
+ * parts. When it is not defined, an object of half a part more than the parts
+ * before the last is generated from democonfigDEMO_HTTP_UPLOAD_DATA.
+ *
+ * #define democonfigS3_UPLOAD_FILE_PATH          "/upload.bin"
+ */
+
 /**
  * @brief An option to disable Server Name Indication.
  *
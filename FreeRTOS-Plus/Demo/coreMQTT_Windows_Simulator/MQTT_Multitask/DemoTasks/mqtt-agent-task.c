@@ -183,6 +183,31 @@
     #define MQTT_AGENT_COMMAND_QUEUE_LENGTH    ( 10U )
 #endif
 
+/**
+ * @brief The most commands the agent task takes from its queue per wake up,
+ * see Agent_MessageReceive().  Set to 0 to take one command at a time.
+ */
+#ifndef MQTT_AGENT_COMMAND_BATCH_LENGTH
+    #define MQTT_AGENT_COMMAND_BATCH_LENGTH    ( 8U )
+#endif
+
+/**
+ * @brief The length of the queue used to hold the commands other than PUBLISH,
+ * such as PING and SUBSCRIBE, so that they are not delayed behind a burst of
+ * publishes.  Set to 0 to send every command to the same queue.
+ */
+#ifndef MQTT_AGENT_PRIORITY_QUEUE_LENGTH
+    #define MQTT_AGENT_PRIORITY_QUEUE_LENGTH    ( 5U )
+#endif
+
+/**
+ * @brief The most commands the agent takes in a row from the priority queue
+ * while publishes are waiting, see MQTTAgentMessageLanes_t.
+ */
+#ifndef MQTT_AGENT_PRIORITY_BURST
+    #define MQTT_AGENT_PRIORITY_BURST    ( 4U )
+#endif
+
 
 /**
  * These configuration settings are required to run the demo.
@@ -504,6 +529,43 @@ static MQTTStatus_t prvMQTTInit( void )
     xCommandQueue.queue = xQueueCreate( MQTT_AGENT_COMMAND_QUEUE_LENGTH,
                                         sizeof( MQTTAgentCommand_t * ) );
     configASSERT( xCommandQueue.queue );
+
+    #if ( MQTT_AGENT_COMMAND_BATCH_LENGTH > 0 )
+    {
+        /* Only the agent task receives from xCommandQueue, so it can drain
+         * the queue into a batch. */
+        static MQTTAgentCommand_t * pxCommandBatchStorage[ MQTT_AGENT_COMMAND_BATCH_LENGTH ];
+        static MQTTAgentMessageBatch_t xCommandBatch =
+        {
+            .pCommands = pxCommandBatchStorage,
+            .length    = MQTT_AGENT_COMMAND_BATCH_LENGTH
+        };
+
+        xCommandQueue.pBatch = &xCommandBatch;
+    }
+    #endif
+
+    #if ( MQTT_AGENT_PRIORITY_QUEUE_LENGTH > 0 )
+    {
+        /* PUBLISH commands stay on xCommandQueue.queue, the default classifier
+         * sends all other commands to the priority queue. */
+        static MQTTAgentMessageLanes_t xCommandLanes =
+        {
+            .classify = NULL,
+            .burst    = MQTT_AGENT_PRIORITY_BURST
+        };
+
+        xCommandLanes.priorityQueue = xQueueCreate( MQTT_AGENT_PRIORITY_QUEUE_LENGTH,
+                                                    sizeof( MQTTAgentCommand_t * ) );
+        configASSERT( xCommandLanes.priorityQueue );
+        xCommandLanes.pending = xSemaphoreCreateCounting( MQTT_AGENT_COMMAND_QUEUE_LENGTH + MQTT_AGENT_PRIORITY_QUEUE_LENGTH,
+                                                          0U );
+        configASSERT( xCommandLanes.pending );
+
+        xCommandQueue.pLanes = &xCommandLanes;
+    }
+    #endif
+
     messageInterface.pMsgCtx = &xCommandQueue;
 
     /* Initialize the task pool. */
@@ -896,7 +958,7 @@ static void prvMQTTClientSocketWakeupCallback( Socket_t pxSocket )
 
     /* A socket used by the MQTT task may need attention.  Send an event
      * to the MQTT task to make sure the task is not blocked on xCommandQueue. */
-    if( ( uxQueueMessagesWaiting( xCommandQueue.queue ) == 0U ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
+    if( ( Agent_MessagesWaiting( &xCommandQueue ) == 0U ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
     {
         /* Don't block as this is called from the context of the IP task. */
         xCommandParams.blockTimeMs = 0U;
@@ -912,13 +974,25 @@ static void prvIncomingPublishCallback( MQTTAgentContext_t * pMqttAgentContext,
 {
     bool xPublishHandled = false;
     char cOriginalChar, * pcLocation;
+    MQTTPublishInfo_t * pxHeldPublishInfo;
 
     ( void ) packetId;
 
+    /* Move the publish into a receive buffer, from which the subscribers can
+     * take it into their own tasks instead of copying it in this one.  If no
+     * buffer is free then the callbacks get the publish in the network
+     * buffer. */
+    pxHeldPublishInfo = holdIncomingPublish( pxPublishInfo );
+
     /* Fan out the incoming publishes to the callbacks registered using
      * subscription manager. */
     xPublishHandled = handleIncomingPublishes( ( SubscriptionElement_t * ) pMqttAgentContext->pIncomingCallbackContext,
-                                               pxPublishInfo );
+                                               ( pxHeldPublishInfo != NULL ) ? pxHeldPublishInfo : pxPublishInfo );
+
+    if( pxHeldPublishInfo != NULL )
+    {
+        releaseIncomingPublish( pxHeldPublishInfo );
+    }
 
     /* If there are no callbacks to handle the incoming publishes,
      * handle it as an unsolicited publish. */
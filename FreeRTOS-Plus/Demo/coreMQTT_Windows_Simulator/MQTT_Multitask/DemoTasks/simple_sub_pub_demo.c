@@ -39,6 +39,12 @@
  * task checks the number it receives from the callback equals the number it
  * previously set in the command context before printing out either a success
  * or failure message.
+ *
+ * Each task also receives the messages echoed back from its topic.  The agent
+ * holds each incoming publish in a reference counted receive buffer of the
+ * subscription manager.  The subscription callback, which executes in the
+ * agent task, only queues a pointer to that buffer to the subscribed task, and
+ * the task releases the buffer once it has processed the publish.
  */
 
 
@@ -94,6 +100,12 @@
  */
 #define mqttexampleMAX_COMMAND_SEND_BLOCK_TIME_MS         ( 500 )
 
+/**
+ * @brief The number of incoming publishes that can wait to be processed by
+ * each task.  Further publishes are dropped until the task catches up.
+ */
+#define mqttexampleINCOMING_PUBLISH_QUEUE_LENGTH          ( 3 )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -106,6 +118,7 @@ struct MQTTAgentCommandContext
     TaskHandle_t xTaskToNotify;
     uint32_t ulNotificationValue;
     void * pArgs;
+    QueueHandle_t xIncomingPublishQueue;
 };
 
 /*-----------------------------------------------------------*/
@@ -162,17 +175,29 @@ static BaseType_t prvWaitForCommandAcknowledgment( uint32_t * pulNotifiedValue )
 /**
  * @brief Passed into MQTTAgent_Subscribe() as the callback to execute when
  * there is an incoming publish on the topic being subscribed to.  Its
- * implementation just logs information about the incoming publish including
- * the publish messages source topic and payload.
+ * implementation passes the incoming publish to the subscribed task by
+ * pointer, or, if the publish is not held in a receive buffer, logs
+ * information about the incoming publish including the publish messages
+ * payload.
  *
  * See https://freertos.org/mqtt/mqtt-agent-demo.html#example_mqtt_api_call
  *
- * @param[in] pvIncomingPublishCallbackContext Context of the initial command.
+ * @param[in] pvIncomingPublishCallbackContext The queue of the subscribed task.
  * @param[in] pxPublishInfo Deserialized publish.
  */
 static void prvIncomingPublishCallback( void * pvIncomingPublishCallbackContext,
                                         MQTTPublishInfo_t * pxPublishInfo );
 
+/**
+ * @brief Wait for incoming publishes queued by prvIncomingPublishCallback(),
+ * log them and release their receive buffers.
+ *
+ * @param[in] xIncomingPublishQueue The queue of the task.
+ * @param[in] xTicksToWait The time to wait for publishes.
+ */
+static void prvProcessIncomingPublishes( QueueHandle_t xIncomingPublishQueue,
+                                         TickType_t xTicksToWait );
+
 /**
  * @brief Subscribe to the topic the demo task will also publish to - that
  * results in all outgoing publishes being published back to the task
@@ -181,9 +206,12 @@ static void prvIncomingPublishCallback( void * pvIncomingPublishCallbackContext,
  * @param[in] xQoS The quality of service (QoS) to use.  Can be zero or one
  * for all MQTT brokers.  Can also be QoS2 if supported by the broker.  AWS IoT
  * does not support QoS2.
+ * @param[in] xIncomingPublishQueue The queue to which incoming publishes are
+ * sent.
  */
 static bool prvSubscribeToTopic( MQTTQoS_t xQoS,
-                                 char * pcTopicFilter );
+                                 char * pcTopicFilter,
+                                 QueueHandle_t xIncomingPublishQueue );
 
 /**
  * @brief The function that implements the task demonstrated by this file.
@@ -279,7 +307,7 @@ static void prvSubscribeCommandCallback( void * pxCommandContext,
                                               pxSubscribeArgs->pSubscribeInfo->pTopicFilter,
                                               pxSubscribeArgs->pSubscribeInfo->topicFilterLength,
                                               prvIncomingPublishCallback,
-                                              NULL );
+                                              ( void * ) pxApplicationDefinedContext->xIncomingPublishQueue );
 
         if( xSubscriptionAdded == false )
         {
@@ -315,29 +343,67 @@ static void prvIncomingPublishCallback( void * pvIncomingPublishCallbackContext,
                                         MQTTPublishInfo_t * pxPublishInfo )
 {
     static char cTerminatedString[ mqttexampleSTRING_BUFFER_LENGTH ];
+    QueueHandle_t xIncomingPublishQueue = ( QueueHandle_t ) pvIncomingPublishCallbackContext;
 
-    ( void ) pvIncomingPublishCallbackContext;
-
-    /* Create a message that contains the incoming MQTT payload to the logger,
-     * terminating the string first. */
-    if( pxPublishInfo->payloadLength < mqttexampleSTRING_BUFFER_LENGTH )
+    if( retainIncomingPublish( pxPublishInfo ) == true )
     {
-        memcpy( ( void * ) cTerminatedString, pxPublishInfo->pPayload, pxPublishInfo->payloadLength );
-        cTerminatedString[ pxPublishInfo->payloadLength ] = 0x00;
+        /* The publish stays valid until it is released, so only a pointer to
+         * it is sent to the subscribed task.  Do not block the agent task if
+         * the subscribed task is behind. */
+        if( xQueueSend( xIncomingPublishQueue, &pxPublishInfo, 0U ) != pdPASS )
+        {
+            LogWarn( ( "Dropped an incoming publish, the queue of the subscribed task is full." ) );
+            releaseIncomingPublish( pxPublishInfo );
+        }
     }
     else
     {
-        memcpy( ( void * ) cTerminatedString, pxPublishInfo->pPayload, mqttexampleSTRING_BUFFER_LENGTH );
-        cTerminatedString[ mqttexampleSTRING_BUFFER_LENGTH - 1 ] = 0x00;
+        /* Create a message that contains the incoming MQTT payload to the logger,
+         * terminating the string first. */
+        if( pxPublishInfo->payloadLength < mqttexampleSTRING_BUFFER_LENGTH )
+        {
+            memcpy( ( void * ) cTerminatedString, pxPublishInfo->pPayload, pxPublishInfo->payloadLength );
+            cTerminatedString[ pxPublishInfo->payloadLength ] = 0x00;
+        }
+        else
+        {
+            memcpy( ( void * ) cTerminatedString, pxPublishInfo->pPayload, mqttexampleSTRING_BUFFER_LENGTH );
+            cTerminatedString[ mqttexampleSTRING_BUFFER_LENGTH - 1 ] = 0x00;
+        }
+
+        LogInfo( ( "Received incoming publish message %s", cTerminatedString ) );
     }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvProcessIncomingPublishes( QueueHandle_t xIncomingPublishQueue,
+                                         TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    MQTTPublishInfo_t * pxPublishInfo;
 
-    LogInfo( ( "Received incoming publish message %s", cTerminatedString ) );
+    vTaskSetTimeOutState( &xTimeOut );
+
+    while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+    {
+        if( xQueueReceive( xIncomingPublishQueue, &pxPublishInfo, xTicksToWait ) == pdPASS )
+        {
+            /* The payload is read in place, in the receive buffer. */
+            LogInfo( ( "Received incoming publish message %.*s",
+                       ( int ) pxPublishInfo->payloadLength,
+                       ( const char * ) pxPublishInfo->pPayload ) );
+
+            releaseIncomingPublish( pxPublishInfo );
+        }
+    }
 }
 
 /*-----------------------------------------------------------*/
 
 static bool prvSubscribeToTopic( MQTTQoS_t xQoS,
-                                 char * pcTopicFilter )
+                                 char * pcTopicFilter,
+                                 QueueHandle_t xIncomingPublishQueue )
 {
     MQTTStatus_t xCommandAdded;
     BaseType_t xCommandAcknowledged = pdFALSE;
@@ -374,6 +440,7 @@ static bool prvSubscribeToTopic( MQTTQoS_t xQoS,
     xApplicationDefinedContext.ulNotificationValue = ulNextSubscribeMessageID;
     xApplicationDefinedContext.xTaskToNotify = xTaskGetCurrentTaskHandle();
     xApplicationDefinedContext.pArgs = ( void * ) &xSubscribeArgs;
+    xApplicationDefinedContext.xIncomingPublishQueue = xIncomingPublishQueue;
 
     xCommandParams.blockTimeMs = mqttexampleMAX_COMMAND_SEND_BLOCK_TIME_MS;
     xCommandParams.cmdCompleteCallback = prvSubscribeCommandCallback;
@@ -389,7 +456,6 @@ static bool prvSubscribeToTopic( MQTTQoS_t xQoS,
 
     do
     {
-        /* TODO: prvIncomingPublish as publish callback. */
         xCommandAdded = MQTTAgent_Subscribe( &xGlobalMqttAgentContext,
                                              &xSubscribeArgs,
                                              &xCommandParams );
@@ -434,6 +500,7 @@ static void prvSimpleSubscribePublishTask( void * pvParameters )
     TickType_t xTicksToDelay;
     MQTTAgentCommandInfo_t xCommandParams = { 0 };
     char * pcTopicBuffer = topicBuf[ ulTaskNumber ];
+    QueueHandle_t xIncomingPublishQueue;
 
     /* Have different tasks use different QoS.  0 and 1.  2 can also be used
      * if supported by the broker. */
@@ -448,10 +515,16 @@ static void prvSimpleSubscribePublishTask( void * pvParameters )
 
     LogInfo( ( "Task: %s: ---------STARTING DEMO---------\r\n", taskName ) );
 
+    /* Create the queue on which the incoming publishes are passed to this
+     * task. */
+    xIncomingPublishQueue = xQueueCreate( mqttexampleINCOMING_PUBLISH_QUEUE_LENGTH,
+                                          sizeof( MQTTPublishInfo_t * ) );
+    configASSERT( xIncomingPublishQueue != NULL );
+
     /* Subscribe to the same topic to which this task will publish.  That will
      * result in each published message being published from the server back to
      * the target. */
-    prvSubscribeToTopic( xQoS, pcTopicBuffer );
+    prvSubscribeToTopic( xQoS, pcTopicBuffer, xIncomingPublishQueue );
 
     /* Configure the publish operation. */
     memset( ( void * ) &xPublishInfo, 0x00, sizeof( xPublishInfo ) );
@@ -519,10 +592,10 @@ static void prvSimpleSubscribePublishTask( void * pvParameters )
         LogInfo( ( "Task: %s: Short delay before next iteration... \r\n\r\n", taskName ) );
 
         /* Add a little randomness into the delay so the tasks don't remain
-         * in lockstep. */
+         * in lockstep.  The echoed publishes are processed meanwhile. */
         xTicksToDelay = pdMS_TO_TICKS( mqttexampleDELAY_BETWEEN_PUBLISH_OPERATIONS_MS ) +
                         ( uxRand() % 0xff );
-        vTaskDelay( xTicksToDelay );
+        prvProcessIncomingPublishes( xIncomingPublishQueue, xTicksToDelay );
     }
 
     /* Delete the task if it is complete. */
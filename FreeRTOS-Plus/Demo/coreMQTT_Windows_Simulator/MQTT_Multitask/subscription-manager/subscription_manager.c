@@ -32,9 +32,60 @@
 /* Standard includes. */
 #include <string.h>
 
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "atomic.h"
+
 /* Subscription manager header include. */
 #include "subscription_manager.h"
 
+#if ( SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS > 0 )
+
+/**
+ * @brief A copy of an incoming publish, shared by the tasks it is delivered to.
+ *
+ * @note xPublishInfo is the first member, so that the publish info passed to
+ * the subscribers is also the address of its buffer.
+ */
+    typedef struct ReceiveBuffer
+    {
+        MQTTPublishInfo_t xPublishInfo;
+        volatile uint32_t ulReferences;
+        uint8_t ucData[ SUBSCRIPTION_MANAGER_RECEIVE_BUFFER_SIZE ];
+    } ReceiveBuffer_t;
+
+/**
+ * @brief The pool of receive buffers.  A buffer is free while it has no
+ * references.
+ */
+    static ReceiveBuffer_t xReceiveBuffers[ SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS ];
+
+/**
+ * @brief Get the receive buffer that holds a publish.
+ *
+ * @param[in] pxPublishInfo The publish.
+ *
+ * @return The receive buffer, or NULL if the publish is not held in one.
+ */
+    static ReceiveBuffer_t * prvGetReceiveBuffer( MQTTPublishInfo_t * pxPublishInfo )
+    {
+        ReceiveBuffer_t * pxBuffer = NULL;
+        size_t xIndex;
+
+        for( xIndex = 0; xIndex < SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS; xIndex++ )
+        {
+            if( pxPublishInfo == &( xReceiveBuffers[ xIndex ].xPublishInfo ) )
+            {
+                pxBuffer = &( xReceiveBuffers[ xIndex ] );
+                break;
+            }
+        }
+
+        return pxBuffer;
+    }
+#endif /* SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS */
+
+/*-----------------------------------------------------------*/
 
 bool addSubscription( SubscriptionElement_t * pxSubscriptionList,
                       const char * pcTopicFilterString,
@@ -168,3 +219,91 @@ bool handleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
 
     return publishHandled;
 }
+
+/*-----------------------------------------------------------*/
+
+MQTTPublishInfo_t * holdIncomingPublish( const MQTTPublishInfo_t * pxPublishInfo )
+{
+    MQTTPublishInfo_t * pxHeldPublishInfo = NULL;
+
+    #if ( SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS > 0 )
+        ReceiveBuffer_t * pxBuffer = NULL;
+        size_t xIndex;
+
+        if( ( pxPublishInfo != NULL ) &&
+            ( ( ( size_t ) pxPublishInfo->topicNameLength + pxPublishInfo->payloadLength ) <= SUBSCRIPTION_MANAGER_RECEIVE_BUFFER_SIZE ) )
+        {
+            for( xIndex = 0; xIndex < SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS; xIndex++ )
+            {
+                /* Other tasks only ever release references, so a free buffer
+                 * stays free until it is claimed here. */
+                if( Atomic_CompareAndSwap_u32( &( xReceiveBuffers[ xIndex ].ulReferences ), 1U, 0U ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+                {
+                    pxBuffer = &( xReceiveBuffers[ xIndex ] );
+                    break;
+                }
+            }
+        }
+
+        if( pxBuffer != NULL )
+        {
+            /* The network buffer is overwritten by the next packet, so this is
+             * the one copy of the publish, whatever the number of its
+             * subscribers. */
+            pxBuffer->xPublishInfo = *pxPublishInfo;
+            ( void ) memcpy( pxBuffer->ucData, pxPublishInfo->pTopicName, pxPublishInfo->topicNameLength );
+            ( void ) memcpy( &( pxBuffer->ucData[ pxPublishInfo->topicNameLength ] ), pxPublishInfo->pPayload, pxPublishInfo->payloadLength );
+            pxBuffer->xPublishInfo.pTopicName = ( const char * ) pxBuffer->ucData;
+            pxBuffer->xPublishInfo.pPayload = &( pxBuffer->ucData[ pxPublishInfo->topicNameLength ] );
+            pxHeldPublishInfo = &( pxBuffer->xPublishInfo );
+        }
+        else
+        {
+            LogDebug( ( "No receive buffer for an incoming publish, it is only delivered to the callbacks." ) );
+        }
+    #else /* if ( SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS > 0 ) */
+        ( void ) pxPublishInfo;
+    #endif /* if ( SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS > 0 ) */
+
+    return pxHeldPublishInfo;
+}
+
+/*-----------------------------------------------------------*/
+
+bool retainIncomingPublish( MQTTPublishInfo_t * pxPublishInfo )
+{
+    bool xRetained = false;
+
+    #if ( SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS > 0 )
+        ReceiveBuffer_t * pxBuffer = prvGetReceiveBuffer( pxPublishInfo );
+
+        /* The agent holds a reference while the callbacks run, so the count
+         * cannot drop to 0 meanwhile. */
+        if( pxBuffer != NULL )
+        {
+            ( void ) Atomic_Increment_u32( &( pxBuffer->ulReferences ) );
+            xRetained = true;
+        }
+    #else
+        ( void ) pxPublishInfo;
+    #endif
+
+    return xRetained;
+}
+
+/*-----------------------------------------------------------*/
+
+void releaseIncomingPublish( MQTTPublishInfo_t * pxPublishInfo )
+{
+    #if ( SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS > 0 )
+        ReceiveBuffer_t * pxBuffer = prvGetReceiveBuffer( pxPublishInfo );
+
+        if( pxBuffer != NULL )
+        {
+            configASSERT( pxBuffer->ulReferences > 0U );
+            ( void ) Atomic_Decrement_u32( &( pxBuffer->ulReferences ) );
+        }
+    #else
+        ( void ) pxPublishInfo;
+    #endif
+}
@@ -70,6 +70,23 @@
     #define SUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS    10U
 #endif
 
+/**
+ * @brief Number of buffers in which incoming publishes can be held until the
+ * tasks that subscribed to them have consumed them, see holdIncomingPublish().
+ * Set to 0 to only deliver incoming publishes within the callbacks.
+ */
+#ifndef SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS
+    #define SUBSCRIPTION_MANAGER_RECEIVE_BUFFERS    4U
+#endif
+
+/**
+ * @brief Size of each of the receive buffers, which hold the topic name and
+ * the payload of one publish.
+ */
+#ifndef SUBSCRIPTION_MANAGER_RECEIVE_BUFFER_SIZE
+    #define SUBSCRIPTION_MANAGER_RECEIVE_BUFFER_SIZE    256U
+#endif
+
 /**
  * @brief Callback function called when receiving a publish.
  *
@@ -147,4 +164,42 @@ void removeSubscription( SubscriptionElement_t * pxSubscriptionList,
 bool handleIncomingPublishes( SubscriptionElement_t * pxSubscriptionList,
                               MQTTPublishInfo_t * pxPublishInfo );
 
+/**
+ * @brief Move an incoming publish out of the network buffer of the MQTT
+ * context into one of the receive buffers, so that subscribers can keep it
+ * beyond their callback.
+ *
+ * The agent calls this once per incoming publish, before the publish is passed
+ * to handleIncomingPublishes(), and holds the first reference.  A callback that
+ * hands the publish to its task calls retainIncomingPublish(), and the task
+ * calls releaseIncomingPublish() once it has consumed it.  The buffer returns
+ * to the pool when the last reference is released.
+ *
+ * @note Only the agent task may call this function.
+ *
+ * @param[in] pxPublishInfo The publish, as deserialized in the network buffer.
+ *
+ * @return The publish within its receive buffer, or NULL if no buffer is free
+ * or the publish does not fit in one.
+ */
+MQTTPublishInfo_t * holdIncomingPublish( const MQTTPublishInfo_t * pxPublishInfo );
+
+/**
+ * @brief Take another reference to a publish held by holdIncomingPublish().
+ *
+ * @param[in] pxPublishInfo The publish passed to a subscription callback.
+ *
+ * @return `true` if a reference was taken, `false` if the publish is not held
+ * in a receive buffer, in which case it is only valid within the callback.
+ */
+bool retainIncomingPublish( MQTTPublishInfo_t * pxPublishInfo );
+
+/**
+ * @brief Release a reference taken by holdIncomingPublish() or
+ * retainIncomingPublish().  Can be called from any task.
+ *
+ * @param[in] pxPublishInfo The held publish.
+ */
+void releaseIncomingPublish( MQTTPublishInfo_t * pxPublishInfo );
+
 #endif /* SUBSCRIPTION_MANAGER_H */
@@ -0,0 +1,518 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Standard includes. */
+#include "stdio.h"
+#include "string.h"
+
+/* Windows includes, for the high resolution performance counter. */
+#ifdef _WIN32
+    #include <Windows.h>
+#endif
+
+/* PKCS #11 includes. */
+#include "core_pkcs11_config.h"
+#include "core_pkcs11.h"
+#include "pkcs11.h"
+
+/* Demo includes. */
+#include "demo_helpers.h"
+#include "pkcs11_demo_config.h"
+#include "pkcs11_demos.h"
+
+/* The number of times each operation is timed, in each session mode. */
+#ifndef configPKCS11_BENCHMARK_ITERATIONS
+    #define configPKCS11_BENCHMARK_ITERATIONS    100
+#endif
+
+/* The labels of the RSA-2048 key pair used for the RSA figures.  The mbed TLS
+ * software token cannot generate RSA keys, so by default these are the labels
+ * of the key pair the "objects.c" demo generates, which is an EC key pair, and
+ * the RSA figures are skipped.  Import an RSA key pair, or point these at the
+ * labels of one held by a hardware token, to get them. */
+#ifndef configPKCS11_BENCHMARK_RSA_PRIVATE_KEY_LABEL
+    #define configPKCS11_BENCHMARK_RSA_PRIVATE_KEY_LABEL    pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS
+#endif
+#ifndef configPKCS11_BENCHMARK_RSA_PUBLIC_KEY_LABEL
+    #define configPKCS11_BENCHMARK_RSA_PUBLIC_KEY_LABEL     pkcs11configLABEL_DEVICE_PUBLIC_KEY_FOR_TLS
+#endif
+
+/* The largest buffer that is digested. */
+#define pkcs11benchMAX_DIGEST_INPUT    16384U
+
+/* The number of random bytes requested per C_GenerateRandom call, the size of
+ * a TLS client random. */
+#define pkcs11benchRANDOM_LENGTH       32U
+
+/* The RSA-2048 signature length. */
+#define pkcs11benchRSA_SIGNATURE_LENGTH    ( pkcs11RSA_2048_MODULUS_BITS / 8U )
+
+/*-----------------------------------------------------------*/
+
+/* Everything an operation needs, set up before the timing starts. */
+typedef struct BenchContext
+{
+    CK_FUNCTION_LIST_PTR pxFunctionList;
+    CK_SLOT_ID xSlotId;
+    CK_OBJECT_HANDLE xEcPrivateKey;
+    CK_OBJECT_HANDLE xEcPublicKey;
+    CK_OBJECT_HANDLE xRsaPrivateKey;
+    CK_OBJECT_HANDLE xRsaPublicKey;
+    CK_BYTE * pucData;
+    CK_ULONG ulDataLength;
+    CK_BYTE xDigest[ pkcs11SHA256_DIGEST_LENGTH ];
+    CK_BYTE xEcSignature[ pkcs11ECDSA_P256_SIGNATURE_LENGTH ];
+    CK_ULONG ulEcSignatureLength;
+    CK_BYTE xRsaInput[ pkcs11RSA_SIGNATURE_INPUT_LENGTH ];
+    CK_BYTE xRsaSignature[ pkcs11benchRSA_SIGNATURE_LENGTH ];
+    CK_ULONG ulRsaSignatureLength;
+} BenchContext_t;
+
+/* A single timed operation on the given session. */
+typedef CK_RV ( * BenchOperation_t )( CK_SESSION_HANDLE xSession,
+                                      BenchContext_t * pxContext );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * A free running microsecond count.  The performance counter is used on the
+ * Windows simulator, as a tick is too long for a single operation, otherwise
+ * the tick count is used.
+ */
+static uint64_t prvGetTimeUs( void );
+
+/*
+ * Time ulIterations calls of xOperation, first all on the session opened by
+ * vStart(), then each on a session opened just for that call, and print the
+ * figures of both.
+ */
+static void prvBenchmark( const char * pcName,
+                          BenchOperation_t xOperation,
+                          BenchContext_t * pxContext );
+
+/*
+ * Find a key by label, and return it only if it is of the expected type.
+ */
+static CK_OBJECT_HANDLE prvFindKey( CK_SESSION_HANDLE xSession,
+                                    const char * pcLabel,
+                                    CK_OBJECT_CLASS xClass,
+                                    CK_KEY_TYPE xKeyType );
+
+/* The timed operations. */
+static CK_RV prvDigest( CK_SESSION_HANDLE xSession,
+                        BenchContext_t * pxContext );
+static CK_RV prvGenerateRandom( CK_SESSION_HANDLE xSession,
+                                BenchContext_t * pxContext );
+static CK_RV prvEcdsaSign( CK_SESSION_HANDLE xSession,
+                           BenchContext_t * pxContext );
+static CK_RV prvEcdsaVerify( CK_SESSION_HANDLE xSession,
+                             BenchContext_t * pxContext );
+static CK_RV prvRsaSign( CK_SESSION_HANDLE xSession,
+                         BenchContext_t * pxContext );
+static CK_RV prvRsaVerify( CK_SESSION_HANDLE xSession,
+                           BenchContext_t * pxContext );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvGetTimeUs( void )
+{
+    #ifdef _WIN32
+        static LARGE_INTEGER xFrequency = { 0 };
+        LARGE_INTEGER xCount;
+
+        if( xFrequency.QuadPart == 0 )
+        {
+            QueryPerformanceFrequency( &xFrequency );
+        }
+
+        QueryPerformanceCounter( &xCount );
+
+        return ( uint64_t ) ( ( xCount.QuadPart * 1000000LL ) / xFrequency.QuadPart );
+    #else
+        return ( ( uint64_t ) xTaskGetTickCount() * 1000000ULL ) / configTICK_RATE_HZ;
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static CK_OBJECT_HANDLE prvFindKey( CK_SESSION_HANDLE xSession,
+                                    const char * pcLabel,
+                                    CK_OBJECT_CLASS xClass,
+                                    CK_KEY_TYPE xKeyType )
+{
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+    CK_OBJECT_HANDLE xHandle = CK_INVALID_HANDLE;
+    CK_KEY_TYPE xFoundType = ( CK_KEY_TYPE ) ~0UL;
+    CK_ATTRIBUTE xTemplate = { CKA_KEY_TYPE, &xFoundType, sizeof( xFoundType ) };
+    CK_RV xResult;
+
+    xResult = C_GetFunctionList( &pxFunctionList );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = xFindObjectWithLabelAndClass( xSession,
+                                                ( char * ) pcLabel,
+                                                strlen( pcLabel ),
+                                                xClass,
+                                                &xHandle );
+    }
+
+    if( ( xResult == CKR_OK ) && ( xHandle != CK_INVALID_HANDLE ) )
+    {
+        xResult = pxFunctionList->C_GetAttributeValue( xSession, xHandle, &xTemplate, 1 );
+
+        if( ( xResult != CKR_OK ) || ( xFoundType != xKeyType ) )
+        {
+            xHandle = CK_INVALID_HANDLE;
+        }
+    }
+    else
+    {
+        xHandle = CK_INVALID_HANDLE;
+    }
+
+    return xHandle;
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvDigest( CK_SESSION_HANDLE xSession,
+                        BenchContext_t * pxContext )
+{
+    CK_MECHANISM xMechanism = { CKM_SHA256, NULL, 0 };
+    CK_ULONG ulDigestLength = sizeof( pxContext->xDigest );
+    CK_RV xResult;
+
+    xResult = pxContext->pxFunctionList->C_DigestInit( xSession, &xMechanism );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = pxContext->pxFunctionList->C_DigestUpdate( xSession,
+                                                             pxContext->pucData,
+                                                             pxContext->ulDataLength );
+    }
+
+    if( xResult == CKR_OK )
+    {
+        xResult = pxContext->pxFunctionList->C_DigestFinal( xSession,
+                                                            pxContext->xDigest,
+                                                            &ulDigestLength );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvGenerateRandom( CK_SESSION_HANDLE xSession,
+                                BenchContext_t * pxContext )
+{
+    return pxContext->pxFunctionList->C_GenerateRandom( xSession,
+                                                        pxContext->pucData,
+                                                        pkcs11benchRANDOM_LENGTH );
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvEcdsaSign( CK_SESSION_HANDLE xSession,
+                           BenchContext_t * pxContext )
+{
+    CK_MECHANISM xMechanism = { CKM_ECDSA, NULL, 0 };
+    CK_RV xResult;
+
+    pxContext->ulEcSignatureLength = sizeof( pxContext->xEcSignature );
+
+    xResult = pxContext->pxFunctionList->C_SignInit( xSession,
+                                                     &xMechanism,
+                                                     pxContext->xEcPrivateKey );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = pxContext->pxFunctionList->C_Sign( xSession,
+                                                     pxContext->xDigest,
+                                                     sizeof( pxContext->xDigest ),
+                                                     pxContext->xEcSignature,
+                                                     &( pxContext->ulEcSignatureLength ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvEcdsaVerify( CK_SESSION_HANDLE xSession,
+                             BenchContext_t * pxContext )
+{
+    CK_MECHANISM xMechanism = { CKM_ECDSA, NULL, 0 };
+    CK_RV xResult;
+
+    xResult = pxContext->pxFunctionList->C_VerifyInit( xSession,
+                                                       &xMechanism,
+                                                       pxContext->xEcPublicKey );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = pxContext->pxFunctionList->C_Verify( xSession,
+                                                       pxContext->xDigest,
+                                                       sizeof( pxContext->xDigest ),
+                                                       pxContext->xEcSignature,
+                                                       pxContext->ulEcSignatureLength );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvRsaSign( CK_SESSION_HANDLE xSession,
+                         BenchContext_t * pxContext )
+{
+    /* The input is the SHA-256 digest with its DigestInfo prefix, as used by
+     * the mbed TLS PKCS #11 transport. */
+    CK_MECHANISM xMechanism = { CKM_RSA_PKCS, NULL, 0 };
+    CK_RV xResult;
+
+    pxContext->ulRsaSignatureLength = sizeof( pxContext->xRsaSignature );
+
+    xResult = pxContext->pxFunctionList->C_SignInit( xSession,
+                                                     &xMechanism,
+                                                     pxContext->xRsaPrivateKey );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = pxContext->pxFunctionList->C_Sign( xSession,
+                                                     pxContext->xRsaInput,
+                                                     sizeof( pxContext->xRsaInput ),
+                                                     pxContext->xRsaSignature,
+                                                     &( pxContext->ulRsaSignatureLength ) );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvRsaVerify( CK_SESSION_HANDLE xSession,
+                           BenchContext_t * pxContext )
+{
+    CK_MECHANISM xMechanism = { CKM_RSA_PKCS, NULL, 0 };
+    CK_RV xResult;
+
+    xResult = pxContext->pxFunctionList->C_VerifyInit( xSession,
+                                                       &xMechanism,
+                                                       pxContext->xRsaPublicKey );
+
+    if( xResult == CKR_OK )
+    {
+        xResult = pxContext->pxFunctionList->C_Verify( xSession,
+                                                       pxContext->xRsaInput,
+                                                       sizeof( pxContext->xRsaInput ),
+                                                       pxContext->xRsaSignature,
+                                                       pxContext->ulRsaSignatureLength );
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmark( const char * pcName,
+                          BenchOperation_t xOperation,
+                          BenchContext_t * pxContext )
+{
+    static const char * const pcModes[] = { "reused-session", "session-per-call" };
+    CK_SESSION_HANDLE xSession = CK_INVALID_HANDLE;
+    CK_ULONG ulIteration;
+    CK_RV xResult = CKR_OK;
+    BaseType_t xMode;
+    uint64_t ullStart, ullLatency, ullTotal, ullMin, ullMax;
+
+    for( xMode = 0; xMode < 2; xMode++ )
+    {
+        ullTotal = 0;
+        ullMin = UINT64_MAX;
+        ullMax = 0;
+
+        if( xMode == 0 )
+        {
+            xResult = pxContext->pxFunctionList->C_OpenSession( pxContext->xSlotId,
+                                                                CKF_SERIAL_SESSION | CKF_RW_SESSION,
+                                                                NULL,
+                                                                NULL,
+                                                                &xSession );
+        }
+
+        for( ulIteration = 0; ( ulIteration < configPKCS11_BENCHMARK_ITERATIONS ) && ( xResult == CKR_OK ); ulIteration++ )
+        {
+            ullStart = prvGetTimeUs();
+
+            /* The user is already logged in to the token by vStart(), and the
+             * login state is shared by every session of the application. */
+            if( xMode == 1 )
+            {
+                xResult = pxContext->pxFunctionList->C_OpenSession( pxContext->xSlotId,
+                                                                    CKF_SERIAL_SESSION | CKF_RW_SESSION,
+                                                                    NULL,
+                                                                    NULL,
+                                                                    &xSession );
+            }
+
+            if( xResult == CKR_OK )
+            {
+                xResult = xOperation( xSession, pxContext );
+            }
+
+            if( ( xMode == 1 ) && ( xSession != CK_INVALID_HANDLE ) )
+            {
+                ( void ) pxContext->pxFunctionList->C_CloseSession( xSession );
+                xSession = CK_INVALID_HANDLE;
+            }
+
+            ullLatency = prvGetTimeUs() - ullStart;
+            ullTotal += ullLatency;
+            ullMin = ( ullLatency < ullMin ) ? ullLatency : ullMin;
+            ullMax = ( ullLatency > ullMax ) ? ullLatency : ullMax;
+        }
+
+        if( ( xMode == 0 ) && ( xSession != CK_INVALID_HANDLE ) )
+        {
+            ( void ) pxContext->pxFunctionList->C_CloseSession( xSession );
+            xSession = CK_INVALID_HANDLE;
+        }
+
+        if( xResult != CKR_OK )
+        {
+            configPRINTF( ( "%-24s %-16s failed with 0x%lx\r\n", pcName, pcModes[ xMode ], ( unsigned long ) xResult ) );
+
+            /* The other mode would fail the same way. */
+            break;
+        }
+
+        /* A zero total is possible with the tick count, so report the
+         * operations per second as 0 rather than divide by zero. */
+        configPRINTF( ( "%-24s %-16s ops/s %8lu  latency us min %8lu avg %8lu max %8lu\r\n",
+                        pcName,
+                        pcModes[ xMode ],
+                        ( unsigned long ) ( ( ullTotal == 0 ) ? 0 : ( ( uint64_t ) configPKCS11_BENCHMARK_ITERATIONS * 1000000ULL ) / ullTotal ),
+                        ( unsigned long ) ullMin,
+                        ( unsigned long ) ( ullTotal / configPKCS11_BENCHMARK_ITERATIONS ),
+                        ( unsigned long ) ullMax ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * This function measures how many operations per second the Cryptoki library
+ * can do, and how long each takes, for the operations a TLS handshake uses:
+ * ECDSA P-256 and RSA-2048 sign and verify, SHA-256 digests over a range of
+ * input sizes, and C_GenerateRandom.  Each operation is timed both on a
+ * session that stays open, and on a session opened and closed around every
+ * call, which shows what caching a session saves.
+ *
+ * Only functions of the CK_FUNCTION_LIST are used, so the same figures can be
+ * taken for the mbed TLS software token or for a hardware token by linking
+ * against its Cryptoki library instead.
+ *
+ * Warning: This demo depends on the objects created in the objects demo.
+ */
+void vPKCS11BenchmarkDemo( void )
+{
+    static const CK_ULONG ulDigestSizes[] = { 64, 256, 1024, 4096, pkcs11benchMAX_DIGEST_INPUT };
+    static BenchContext_t xContext;
+    CK_SESSION_HANDLE hSession = CK_INVALID_HANDLE;
+    CK_SLOT_ID * pxSlotId = NULL;
+    CK_RV xResult = CKR_OK;
+    char cName[ 32 ];
+    size_t xIndex;
+
+    configPRINTF( ( "\r\nStarting PKCS #11 Benchmark Demo, %d iterations per figure.\r\n",
+                    configPKCS11_BENCHMARK_ITERATIONS ) );
+
+    vStart( &hSession, &pxSlotId );
+
+    memset( &xContext, 0, sizeof( xContext ) );
+    xResult = C_GetFunctionList( &( xContext.pxFunctionList ) );
+    configASSERT( xResult == CKR_OK );
+    xContext.xSlotId = pxSlotId[ 0 ];
+
+    xContext.pucData = pvPortMalloc( pkcs11benchMAX_DIGEST_INPUT );
+    configASSERT( xContext.pucData != NULL );
+    memset( xContext.pucData, 0xA5, pkcs11benchMAX_DIGEST_INPUT );
+
+    /******************************* Digests ********************************/
+    for( xIndex = 0; xIndex < sizeof( ulDigestSizes ) / sizeof( ulDigestSizes[ 0 ] ); xIndex++ )
+    {
+        xContext.ulDataLength = ulDigestSizes[ xIndex ];
+        snprintf( cName, sizeof( cName ), "SHA-256 %lu bytes", ( unsigned long ) ulDigestSizes[ xIndex ] );
+        prvBenchmark( cName, prvDigest, &xContext );
+    }
+
+    /******************************** Random ********************************/
+    prvBenchmark( "Random 32 bytes", prvGenerateRandom, &xContext );
+
+    /* The signatures are over the digest of a 64 byte message. */
+    xContext.ulDataLength = 64;
+    xResult = prvDigest( hSession, &xContext );
+    configASSERT( xResult == CKR_OK );
+
+    /******************************* ECDSA P-256 ****************************/
+    xContext.xEcPrivateKey = prvFindKey( hSession, pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS, CKO_PRIVATE_KEY, CKK_EC );
+    xContext.xEcPublicKey = prvFindKey( hSession, pkcs11configLABEL_DEVICE_PUBLIC_KEY_FOR_TLS, CKO_PUBLIC_KEY, CKK_EC );
+
+    if( ( xContext.xEcPrivateKey != CK_INVALID_HANDLE ) && ( xContext.xEcPublicKey != CK_INVALID_HANDLE ) )
+    {
+        prvBenchmark( "ECDSA P-256 sign", prvEcdsaSign, &xContext );
+
+        /* Verify the signature made by the last sign. */
+        prvBenchmark( "ECDSA P-256 verify", prvEcdsaVerify, &xContext );
+    }
+    else
+    {
+        configPRINTF( ( "No EC key pair found, run the objects demo first to create one.\r\n" ) );
+    }
+
+    /******************************* RSA-2048 *******************************/
+    xContext.xRsaPrivateKey = prvFindKey( hSession, configPKCS11_BENCHMARK_RSA_PRIVATE_KEY_LABEL, CKO_PRIVATE_KEY, CKK_RSA );
+    xContext.xRsaPublicKey = prvFindKey( hSession, configPKCS11_BENCHMARK_RSA_PUBLIC_KEY_LABEL, CKO_PUBLIC_KEY, CKK_RSA );
+
+    if( xContext.xRsaPrivateKey != CK_INVALID_HANDLE )
+    {
+        xResult = vAppendSHA256AlgorithmIdentifierSequence( xContext.xDigest, xContext.xRsaInput );
+        configASSERT( xResult == CKR_OK );
+
+        prvBenchmark( "RSA-2048 sign", prvRsaSign, &xContext );
+
+        if( xContext.xRsaPublicKey != CK_INVALID_HANDLE )
+        {
+            prvBenchmark( "RSA-2048 verify", prvRsaVerify, &xContext );
+        }
+    }
+    else
+    {
+        configPRINTF( ( "No RSA key pair found under the configured labels, skipping RSA-2048.\r\n" ) );
+    }
+
+    vPortFree( xContext.pucData );
+
+    configPRINTF( ( "Finished PKCS #11 Benchmark Demo.\r\n" ) );
+    vEnd( hSession, pxSlotId );
+}
@@ -55,4 +55,13 @@ void vPKCS11ObjectDemo( void );
  */
 void vPKCS11SignVerifyDemo( void );
 
+/* Prototype for the PKCS #11 "Benchmark" demo. This demo measures operations
+ * per second and latency for ECDSA P-256 and RSA-2048 sign and verify, SHA-256
+ * digests of several sizes and C_GenerateRandom, both reusing one session and
+ * opening a session per call.
+ *
+ * Warning: This demo depends on the objects created in the objects demo.
+ */
+void vPKCS11BenchmarkDemo( void );
+
 #endif /* _PKCS11_DEMOS_h_ */
@@ -71,6 +71,9 @@ static void prvPKCS11DemoTask( void * pvParameters )
     #if ( configPKCS11_SIGN_AND_VERIFY_DEMO == 1 )
         vPKCS11SignVerifyDemo();
     #endif
+    #if ( configPKCS11_BENCHMARK_DEMO == 1 )
+        vPKCS11BenchmarkDemo();
+    #endif
     configPRINTF( ( "---------Finished DEMO---------\r\n" ) );
 
     vPlatformStopLoggingThreadAndFlush();
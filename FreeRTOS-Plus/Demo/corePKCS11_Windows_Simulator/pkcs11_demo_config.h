@@ -57,4 +57,18 @@
  */
 #define configPKCS11_SIGN_AND_VERIFY_DEMO           1
 
+/*
+ * @brief set this macro to "1" in order to run the PKCS #11 benchmark, which
+ * measures the throughput and latency of sign, verify, digest and random
+ * number generation.
+ *
+ * @warning This demo relies on the objects created in the object demo.
+ */
+#define configPKCS11_BENCHMARK_DEMO                 0
+
+/*
+ * @brief the number of times each operation is timed by the benchmark.
+ */
+#define configPKCS11_BENCHMARK_ITERATIONS           100
+
 #endif /* ifndef _PKCS11_DEMO_CONFIG_ */
@@ -66,8 +66,10 @@
 /* SNTP library include. */
 #include "core_sntp_client.h"
 
-/* Synchronization primitive include. */
-#include "semphr.h"
+/* Compiler intrinsics for the memory barrier of the system clock. */
+#if defined( _MSC_VER )
+    #include <intrin.h>
+#endif
 
 /* FreeRTOS+TCP includes */
 #include "FreeRTOS_IP.h"
@@ -121,6 +123,44 @@
     #define democonfigRECEIVE_SERVER_RESPONSE_BLOCK_TIME_MS    ( 200 )
 #endif
 
+/**
+ * @brief The time (in seconds) for which the resolved address of a time server
+ * is reused for time requests, as long as the server keeps responding.
+ */
+#ifndef democonfigDNS_CACHE_MAX_AGE_SECONDS
+    #define democonfigDNS_CACHE_MAX_AGE_SECONDS    ( 3600 )
+#endif
+
+/**
+ * @brief The clock offset (in milliseconds) above which the system clock is stepped to the
+ * server time instead of being slewed towards it.
+ */
+#ifndef democonfigSYSTEM_CLOCK_STEP_THRESHOLD_MS
+    #define democonfigSYSTEM_CLOCK_STEP_THRESHOLD_MS    ( 5000 )
+#endif
+
+/**
+ * @brief The largest clock adjustment rate, in parts per million of the tick rate, that
+ * slewing may use. It is kept below 1000000, so that the system time never runs backwards.
+ */
+#ifndef democonfigSYSTEM_CLOCK_MAX_SLEW_PPM
+    #define democonfigSYSTEM_CLOCK_MAX_SLEW_PPM    ( 500000 )
+#endif
+
+/**
+ * @brief Memory barrier that orders the accesses to the system clock time bases
+ * against the accesses to their sequence number.
+ */
+#ifndef SYSTEM_CLOCK_MEMORY_BARRIER
+    #if defined( _MSC_VER )
+        #define SYSTEM_CLOCK_MEMORY_BARRIER()    _ReadWriteBarrier()
+    #elif defined( __GNUC__ )
+        #define SYSTEM_CLOCK_MEMORY_BARRIER()    __atomic_thread_fence( __ATOMIC_ACQ_REL )
+    #else
+        #define SYSTEM_CLOCK_MEMORY_BARRIER()
+    #endif
+#endif
+
 /**
  * @brief The size for network buffer that is allocated for initializing the coreSNTP library in the
  * demo.
@@ -210,6 +250,7 @@
 struct NetworkContext
 {
     Socket_t socket;
+    TickType_t sendTickCount; /* Tick count at which the last time request was sent. */
 };
 
 /**
@@ -229,33 +270,58 @@ struct SntpAuthContext
 };
 
 /**
- * @brief Structure aggregating state variables for RAM-based wall-clock time
- * in Coordinated Universal Time (UTC) for system.
+ * @brief The parameters of the RAM-based wall-clock time in Coordinated
+ * Universal Time (UTC) that are set at each time synchronization.
  *
  * @note This demo uses the following mathematical model to represent current
  * time in RAM.
  *
- *  BaseTime = Time set at boot or the last synchronized time
- *  Slew Rate = Number of milliseconds to adjust per system time second
- *  No. of ticks since last SNTP sync = Current FreeRTOS Tick Count -
- *                                      Tick count at last SNTP sync
- *
+ *  BaseTime = Time set at boot, or the system time at the last synchronization
+ *  Frequency Correction = Adjustment, in parts per million, for the drift of
+ *                         the tick rate, learnt from the clock offsets
+ *  Phase Correction = Adjustment, in parts per million, that slews away the
+ *                     clock offset of the last synchronization over the
+ *                     poll period
  *  Time Elapsed since last SNTP sync = No. of ticks since last SNTP sync
  *                                                    x
  *                                      Number of milliseconds per FreeRTOS tick
  *
- *  Slew Adjustment = Slew Rate x Time Elapsed since last SNTP sync
- *
  *  Current Time = Base Time +
  *                 Time Elapsed since last SNTP sync +
- *                 Slew Adjustment
+ *                 Frequency Correction x Time Elapsed since last SNTP sync +
+ *                 Phase Correction x Time Elapsed since last SNTP sync,
+ *                 up to the end of the phase correction period
+ *
+ * As the time is only slewed, it stays continuous across synchronizations,
+ * except when the clock offset is larger than
+ * democonfigSYSTEM_CLOCK_STEP_THRESHOLD_MS.
  */
-typedef struct SystemClock
+typedef struct SystemClockTimeBase
 {
-    UTCTime_t baseTime;
+    uint64_t baseTimeMs; /* UNIX time in milliseconds at lastSyncTickCount. */
     TickType_t lastSyncTickCount;
+    int32_t frequencyPpm;
+    int32_t phasePpm;
+    uint32_t phaseDurationMs;
+} SystemClockTimeBase_t;
+
+/**
+ * @brief Structure aggregating state variables for RAM-based wall-clock time
+ * in Coordinated Universal Time (UTC) for system.
+ *
+ * The time base is double buffered so that queries do not block. Only the
+ * SNTP client task writes it: it fills in the time base that is not in use,
+ * and then increments the sequence number, whose lowest bit selects the time
+ * base in use. A query copies the time base selected by the sequence number,
+ * and copies it again if the sequence number changed meanwhile. A query
+ * therefore never waits for the SNTP client task, whatever the priorities of
+ * the two tasks.
+ */
+typedef struct SystemClock
+{
+    SystemClockTimeBase_t timeBase[ 2 ];
+    volatile uint32_t sequence;
     uint32_t pollPeriod;
-    uint64_t slewRate; /* Milliseconds/Seconds */
     bool firstTimeSyncDone;
 } SystemClock_t;
 
@@ -266,10 +332,44 @@ typedef struct SystemClock
 static SystemClock_t systemClock;
 
 /**
- * @brief Mutex for protecting access to the shared memory of the
- * system clock parameters.
+ * @brief A time sample received from a time server, kept until the samples of
+ * all the servers queried in a poll have been compared.
+ */
+typedef struct TimeSample
+{
+    SntpTimestamp_t serverTime;
+    int64_t clockOffsetMs;       /* Offset of the system clock at receiveTickCount. */
+    TickType_t receiveTickCount;
+    TickType_t roundTripTicks;   /* Ticks between sending the request and receiving the response. */
+    bool valid;
+} TimeSample_t;
+
+/**
+ * @brief The state of the time requests to one of the configured time servers.
+ *
+ * Each time server is queried through its own coreSNTP context and UDP socket
+ * so that the requests to all servers are outstanding at the same time, and a
+ * server that does not respond does not delay time synchronization with the
+ * other servers.
  */
-static SemaphoreHandle_t xMutex = NULL;
+typedef struct TimeServerQuery
+{
+    SntpContext_t context;
+    SntpServerInfo_t server;
+    NetworkContext_t udpContext;
+    SntpAuthContext_t authContext;
+    uint8_t contextBuffer[ SNTP_PACKET_AUTHENTICATED_MODE_SIZE ];
+    uint32_t cachedIpV4Addr; /* Resolved address of the server, 0 when not known. */
+    TickType_t cachedTickCount;
+    bool pending;
+    TimeSample_t sample;
+} TimeServerQuery_t;
+
+/**
+ * @brief The queries of the configured time servers, one per server in the
+ * order of democonfigLIST_OF_TIME_SERVERS.
+ */
+static TimeServerQuery_t * pServerQueries = NULL;
 
 /*
  * @brief Stores the configured time servers in an array.
@@ -303,54 +403,92 @@ static const int32_t pAuthKeyIds[] = { democonfigLIST_OF_AUTHENTICATION_KEY_IDS
 static uint32_t translateYearToUnixSeconds( uint16_t year );
 
 /**
- * @brief Calculates the current time in the system.
- * It calculates the current time as:
+ * @brief Reads the time base of the system clock that is in use, without
+ * blocking.
  *
- *   BaseTime = Time set at device boot or the last synchronized time
- *   SlewRate = Number of milliseconds to adjust per system time second
+ * @param[out] pTimeBase This will be populated with a consistent copy of the
+ * time base.
+ */
+static void readSystemClockTimeBase( SystemClockTimeBase_t * pTimeBase );
+
+/**
+ * @brief Replaces the time base of the system clock. It MUST only be called
+ * from one task at a time, the SNTP client task once the scheduler runs.
+ *
+ * @param[in] pTimeBase The new time base.
+ */
+static void writeSystemClockTimeBase( const SystemClockTimeBase_t * pTimeBase );
+
+/**
+ * @brief Calculates the current time in the system, in milliseconds since
+ * the UNIX epoch.
+ * It calculates the current time as:
  *
  *   Current Time = Base Time +
  *                  Time since last SNTP Synchronization +
- *                  Slew Adjustment (if slew rate > 0) for time period since
+ *                  Frequency and Phase Corrections for the time period since
  *                  last SNTP synchronization
  *
- * @param[in] pBaseTime The base time in the system clock parameters.
- * @param[in] lastSyncTickCount The tick count at the last time synchronization
- * with a time server.
- * @param[in] slewRate The slew rate as seconds of clock adjustment per FreeRTOS
- * system time second.
+ * @param[in] pTimeBase The time base of the system clock.
+ * @param[in] tickCount The tick count to calculate the time for.
+ *
+ * @return The current time in milliseconds.
+ */
+static uint64_t calculateCurrentTimeMs( const SystemClockTimeBase_t * pTimeBase,
+                                        TickType_t tickCount );
+
+/**
+ * @brief Calculates the current time in the system.
+ *
+ * @param[in] pTimeBase The time base of the system clock.
  * @param[out] pCurrentTime This will be populated with the calculated current
  * UTC time in the system.
  */
-static void calculateCurrentTime( UTCTime_t * pBaseTime,
-                                  TickType_t lastSyncTickCount,
-                                  uint64_t slewRate,
+static void calculateCurrentTime( const SystemClockTimeBase_t * pTimeBase,
                                   UTCTime_t * pCurrentTime );
 
 /**
- * @brief Initializes the SNTP context for the SNTP client task.
- * This function generates an array of the configured time servers, creates a FreeRTOS UDP socket
- * for the UDP transport interface and initializes the passed SNTP context by calling the
- * Sntp_Init() API of the coreSNTP library.
- *
- * @param[in, out] pContext The memory for the SNTP client context that will be initialized with
- * Sntp_Init API.
- * @param[in] pTimeServers The list of time servers configured through the democonfigLIST_OF_TIME_SERVERS
- * macro in demo_config.h.
- * @param[in] numOfServers The number of time servers configured in democonfigLIST_OF_TIME_SERVERS.
- * @param[in] pContextBuffer The allocated network buffer that will be initialized in the SNTP context.
- * @param[in] pUdpContext The memory for the network context for the UDP transport interface that will
- * be passed to the SNTP client context. This will be filled with a UDP context created by this function.
- *
- * @return Returns `true` if initialization of SNTP client context is successful; otherwise `false`.
+ * @brief Allocates the queries of the time servers configured through the
+ * democonfigLIST_OF_TIME_SERVERS macro in demo_config.h, and populates the
+ * authentication context of each server.
+ *
+ * @return Returns `true` if the queries are allocated; otherwise `false`.
+ */
+static bool initializeServerQueries( void );
+
+/**
+ * @brief Initializes the SNTP context of a time server query, for the single
+ * server of the query, by calling the Sntp_Init() API of the coreSNTP library.
+ *
+ * @note The context is initialized again for every poll, as the coreSNTP
+ * library rotates away from a server that rejects a time request or does not
+ * respond, and each context only knows its own server.
+ *
+ * @param[in, out] pQuery The query whose SNTP context is initialized.
  */
-static bool initializeSntpClient( SntpContext_t * pContext,
-                                  const char ** pTimeServers,
-                                  size_t numOfServers,
-                                  uint8_t * pContextBuffer,
-                                  size_t contextBufferSize,
-                                  NetworkContext_t * pUdpContext,
-                                  SntpAuthContext_t * pAuthContext );
+static void initializeSntpClient( TimeServerQuery_t * pQuery );
+
+/**
+ * @brief Finds the query of a time server passed to an interface function by
+ * the coreSNTP library.
+ *
+ * @param[in] pServer The time server of one of the SNTP contexts.
+ *
+ * @return The query that holds @p pServer.
+ */
+static TimeServerQuery_t * findServerQuery( const SntpServerInfo_t * pServer );
+
+/**
+ * @brief Sends a time request to every configured time server, and waits for
+ * their responses until no outstanding server can give a sample with a shorter
+ * round trip than the best sample received.
+ *
+ * @param[out] pRejected Set to `true` if a server rejected its time request.
+ *
+ * @return The query with the sample of the shortest round trip, or NULL if no
+ * server responded with a usable time.
+ */
+static TimeServerQuery_t * queryTimeServers( bool * pRejected );
 
 /**
  * @brief The demo implementation of the @ref SntpResolveDns_t interface to
@@ -424,46 +562,20 @@ static void sntpClient_GetTime( SntpTimestamp_t * pCurrentTime );
 
 /**
  * @brief The demo implementation of the @ref SntpSetTime_t interface
- * for correcting the system clock time based on the  time received
- * from the server response and the clock-offset value calculated by
- * the coreSNTP library.
- *
- * @note This demo uses a combination of "step" AND "slew" methodology
- * for system clock correction.
- * 1. "Step" correction is ALWAYS used to immediately correct the system clock
- *    to match server time on every successful time synchronization with a
- *    time server (that occurs periodically on the poll interval gaps).
- *
- * 2. "Slew" correction approach is used for compensating system clock drift
- *    during the poll interval period between time synchronization attempts with
- *    time server(s) when latest time server is not known. The "slew rate" is
- *    calculated ONLY once on the occasion of the second successful time
- *    synchronization with a time server. This is because the demo initializes
- *    system time with (the first second of) the democonfigSYSTEM_START_YEAR
- *    configuration, and thus, the the actual system clock drift over a period
- *    of time can be calculated only AFTER the demo system time has been synchronized
- *    with server time once. Thus, after the first time period of poll interval has
- *    transpired, the system clock drift is calculated correctly on the subsequent
- *    successful time synchronization with a time server.
- *
- * @note The above system clock correction algorithm is just one example of a correction
- * approach. It can be modified to suit your application needs. For example, your
- * application can use ONLY the "step" correction methodology for simplicity of system clock
- * time calculation logic if the application is not sensitive to abrupt time changes
- * (that occur at the instances of periodic time synchronization attempts). In such a case,
- * the Sntp_CalculatePollInterval() API of coreSNTP library can be used to calculate
- * the optimum time polling period for your application based on the factors of your
- * system's clock drift rate and the maximum clock drift tolerable by your application.
+ * for receiving the time from a server response and the clock-offset value
+ * calculated by the coreSNTP library.
  *
+ * The time is stored as a sample of the server, together with the round trip
+ * of the time request. The system clock is corrected with the best sample of
+ * a poll by correctSystemClock().
  *
  * @param[in] pTimeServer The time server from whom the time has been received.
  * @param[in] pServerTime The most recent time of the server, @p pTimeServer, sent in its
  * time response.
  * @param[in] clockOffsetMs The value, in milliseconds, of system clock offset relative
  * to the server time calculated by the coreSNTP library. If the value is positive, then
- * the system is BEHIND the server time, and a "slew" clock correction approach is used in
- * this demo. If the value is negative, then the system time is AHEAD of the server time,
- * and a "step" clock correction approach is used in this demo.
+ * the system is BEHIND the server time. If the value is negative, then the system time
+ * is AHEAD of the server time.
  * @param[in] leapSecondInfo This indicates whether there is an upcoming leap second insertion
  * or deletion (according to astronomical time) the last minute of the end of the month that the
  * system time needs to adjust for. Leap second adjustment is valuable for applications that
@@ -475,6 +587,35 @@ static void sntpClient_SetTime( const SntpServerInfo_t * pTimeServer,
                                 int64_t clockOffsetMs,
                                 SntpLeapSecondInfo_t leapSecondInfo );
 
+/**
+ * @brief Corrects the system clock with a time sample received from a time server.
+ *
+ * @note This demo uses a combination of "step" AND "slew" methodology
+ * for system clock correction.
+ * 1. "Step" correction is used to immediately correct the system clock to match
+ *    server time on the first time synchronization since device boot-up, and
+ *    whenever the clock offset is larger than democonfigSYSTEM_CLOCK_STEP_THRESHOLD_MS.
+ *
+ * 2. "Slew" correction is used otherwise. The offset is added to a frequency
+ *    correction that compensates the drift of the tick rate, and is slewed away
+ *    by a phase correction over the next poll period, so that the system time
+ *    stays continuous.
+ *
+ * @note The above system clock correction algorithm is just one example of a correction
+ * approach. It can be modified to suit your application needs. For example, your
+ * application can use ONLY the "step" correction methodology for simplicity of system clock
+ * time calculation logic if the application is not sensitive to abrupt time changes
+ * (that occur at the instances of periodic time synchronization attempts). In such a case,
+ * the Sntp_CalculatePollInterval() API of coreSNTP library can be used to calculate
+ * the optimum time polling period for your application based on the factors of your
+ * system's clock drift rate and the maximum clock drift tolerable by your application.
+ *
+ * @param[in] pServerName The time server from whom the sample has been received.
+ * @param[in] pSample The time sample of the server.
+ */
+static void correctSystemClock( const char * pServerName,
+                                const TimeSample_t * pSample );
+
 /**
  * @brief Utility function to create a PKCS11 session and a PKCS11 object, and obtain the PKCS11
  * global function list for performing 128 bit AES-CMAC operations.
@@ -662,80 +803,121 @@ static uint32_t translateYearToUnixSeconds( uint16_t year )
     return( numOfDaysSince1970 * 24 * 3600 );
 }
 
-void calculateCurrentTime( UTCTime_t * pBaseTime,
-                           TickType_t lastSyncTickCount,
-                           uint64_t slewRate,
-                           UTCTime_t * pCurrentTime )
+static void readSystemClockTimeBase( SystemClockTimeBase_t * pTimeBase )
+{
+    uint32_t sequence;
+
+    do
+    {
+        sequence = systemClock.sequence;
+        SYSTEM_CLOCK_MEMORY_BARRIER();
+
+        *pTimeBase = systemClock.timeBase[ sequence & 1U ];
+
+        /* The copy is only torn if the SNTP client task has started writing
+         * this time base, which it only does after switching to the other one. */
+        SYSTEM_CLOCK_MEMORY_BARRIER();
+    } while( sequence != systemClock.sequence );
+}
+
+static void writeSystemClockTimeBase( const SystemClockTimeBase_t * pTimeBase )
+{
+    uint32_t sequence = systemClock.sequence + 1U;
+
+    /* Fill in the time base that is not in use, and then switch to it. */
+    systemClock.timeBase[ sequence & 1U ] = *pTimeBase;
+    SYSTEM_CLOCK_MEMORY_BARRIER();
+
+    systemClock.sequence = sequence;
+}
+
+static uint64_t calculateCurrentTimeMs( const SystemClockTimeBase_t * pTimeBase,
+                                        TickType_t tickCount )
 {
-    uint64_t msElapsedSinceLastSync = 0;
-    uint64_t currentTimeSecs;
-    TickType_t ticksElapsedSinceLastSync = xTaskGetTickCount() - lastSyncTickCount;
+    uint64_t msElapsedSinceLastSync;
+    uint64_t msPhaseCorrected;
+    int64_t adjustmentUs;
 
     /* Calculate time elapsed since last synchronization according to the number
      * of system ticks passed. */
-    msElapsedSinceLastSync = ticksElapsedSinceLastSync * MILLISECONDS_PER_TICK;
+    msElapsedSinceLastSync = ( uint64_t ) ( tickCount - pTimeBase->lastSyncTickCount ) * MILLISECONDS_PER_TICK;
 
-    /* If slew rate is set, then apply the slew-based clock adjustment for the elapsed time. */
-    if( slewRate > 0 )
-    {
-        /* Slew Adjustment = Slew Rate ( Milliseconds/seconds )
-         *                                      x
-         *                   No. of seconds since last synchronization. */
-        msElapsedSinceLastSync += slewRate * ( msElapsedSinceLastSync / 1000 );
-    }
+    /* The phase correction only applies until the offset has been slewed away. */
+    msPhaseCorrected = ( msElapsedSinceLastSync < pTimeBase->phaseDurationMs ) ?
+                       msElapsedSinceLastSync : pTimeBase->phaseDurationMs;
 
-    /* Set the current UTC time in the output parameter. */
-    if( msElapsedSinceLastSync >= 1000 )
-    {
-        currentTimeSecs = ( uint64_t ) ( pBaseTime->secs ) + ( msElapsedSinceLastSync / 1000 );
+    /* Parts per million of milliseconds are nanoseconds, so the adjustments
+     * are summed as microseconds before they are rounded down. */
+    adjustmentUs = ( ( ( int64_t ) msElapsedSinceLastSync * pTimeBase->frequencyPpm ) +
+                     ( ( int64_t ) msPhaseCorrected * pTimeBase->phasePpm ) ) / 1000;
 
-        /* Support case of UTC timestamp rollover on 7 February 2038. */
-        if( currentTimeSecs > UINT32_MAX )
-        {
-            /* Assert when the UTC timestamp rollover. */
-            configASSERT( !( currentTimeSecs > UINT32_MAX ) );
+    return pTimeBase->baseTimeMs + msElapsedSinceLastSync + ( adjustmentUs / 1000 );
+}
 
-            /* Subtract an extra second as timestamp 0 represents the epoch for
-             * UTC era 1. */
-            LogWarn( ( "UTC timestamp rollover." ) );
-            pCurrentTime->secs = ( uint32_t ) ( currentTimeSecs - UINT32_MAX - 1 );
-        }
-        else
-        {
-            pCurrentTime->secs = ( uint32_t ) ( currentTimeSecs );
-        }
+static void calculateCurrentTime( const SystemClockTimeBase_t * pTimeBase,
+                                  UTCTime_t * pCurrentTime )
+{
+    uint64_t currentTimeMs = calculateCurrentTimeMs( pTimeBase, xTaskGetTickCount() );
+    uint64_t currentTimeSecs = currentTimeMs / 1000;
+
+    /* Support case of UTC timestamp rollover on 7 February 2038. */
+    if( currentTimeSecs > UINT32_MAX )
+    {
+        /* Assert when the UTC timestamp rollover. */
+        configASSERT( !( currentTimeSecs > UINT32_MAX ) );
 
-        pCurrentTime->msecs = msElapsedSinceLastSync % 1000;
+        /* Subtract an extra second as timestamp 0 represents the epoch for
+         * UTC era 1. */
+        LogWarn( ( "UTC timestamp rollover." ) );
+        pCurrentTime->secs = ( uint32_t ) ( currentTimeSecs - UINT32_MAX - 1 );
     }
     else
     {
-        pCurrentTime->secs = pBaseTime->secs;
-        pCurrentTime->msecs = ( uint32_t ) ( msElapsedSinceLastSync );
+        pCurrentTime->secs = ( uint32_t ) ( currentTimeSecs );
     }
+
+    pCurrentTime->msecs = ( uint32_t ) ( currentTimeMs % 1000 );
 }
 
 /********************** DNS Resolution Interface *******************************/
 static bool resolveDns( const SntpServerInfo_t * pServerAddr,
                         uint32_t * pIpV4Addr )
 {
+    TimeServerQuery_t * pQuery = findServerQuery( pServerAddr );
+    TickType_t tickCount = xTaskGetTickCount();
     uint32_t resolvedAddr = 0;
     bool status = false;
 
-    resolvedAddr = FreeRTOS_gethostbyname( pServerAddr->pServerName );
-
-    /* Set the output parameter if DNS look up succeeded. */
-    if( resolvedAddr != 0 )
+    /* Reuse the address resolved for an earlier poll, so that the time request
+     * is not held up by a DNS look up. The address is forgotten when the server
+     * does not respond. */
+    if( ( pQuery->cachedIpV4Addr != 0 ) &&
+        ( ( tickCount - pQuery->cachedTickCount ) < ( ( TickType_t ) democonfigDNS_CACHE_MAX_AGE_SECONDS * configTICK_RATE_HZ ) ) )
     {
-        /* DNS Look up succeeded. */
+        *pIpV4Addr = pQuery->cachedIpV4Addr;
         status = true;
+    }
+    else
+    {
+        resolvedAddr = FreeRTOS_gethostbyname( pServerAddr->pServerName );
 
-        *pIpV4Addr = FreeRTOS_ntohl( resolvedAddr );
+        /* Set the output parameter if DNS look up succeeded. */
+        if( resolvedAddr != 0 )
+        {
+            /* DNS Look up succeeded. */
+            status = true;
 
-        #if defined( LIBRARY_LOG_LEVEL ) && ( LIBRARY_LOG_LEVEL != LOG_NONE )
-            uint8_t stringAddr[ 16 ];
-            FreeRTOS_inet_ntoa( resolvedAddr, stringAddr );
-            LogInfo( ( "Resolved time server as %s", stringAddr ) );
-        #endif
+            *pIpV4Addr = FreeRTOS_ntohl( resolvedAddr );
+
+            pQuery->cachedIpV4Addr = *pIpV4Addr;
+            pQuery->cachedTickCount = tickCount;
+
+            #if defined( LIBRARY_LOG_LEVEL ) && ( LIBRARY_LOG_LEVEL != LOG_NONE )
+                uint8_t stringAddr[ 16 ];
+                FreeRTOS_inet_ntoa( resolvedAddr, stringAddr );
+                LogInfo( ( "Resolved time server %s as %s", pServerAddr->pServerName, stringAddr ) );
+            #endif
+        }
     }
 
     return status;
@@ -764,6 +946,9 @@ int32_t UdpTransport_Send( NetworkContext_t * pNetworkContext,
     destinationAddress.sin_port = FreeRTOS_htons( serverPort );
     destinationAddress.sin_family = FREERTOS_AF_INET;
 
+    /* Record the send time for the round trip of the time sample. */
+    pNetworkContext->sendTickCount = xTaskGetTickCount();
+
     /* Send the buffer with ulFlags set to 0, so the FREERTOS_ZERO_COPY bit
      * is clear. */
     bytesSent = FreeRTOS_sendto( /* The socket being send to. */
@@ -859,19 +1044,14 @@ static int32_t UdpTransport_Recv( NetworkContext_t * pNetworkContext,
 /**************************** Time Interfaces ************************************************/
 static void sntpClient_GetTime( SntpTimestamp_t * pCurrentTime )
 {
+    SystemClockTimeBase_t timeBase;
     UTCTime_t currentTime;
     uint32_t ntpSecs;
 
-    /* Obtain mutex for accessing system clock variables */
-    xSemaphoreTake( xMutex, portMAX_DELAY );
-
-    calculateCurrentTime( &systemClock.baseTime,
-                          systemClock.lastSyncTickCount,
-                          systemClock.slewRate,
-                          &currentTime );
+    /* Read the system clock variables without blocking. */
+    readSystemClockTimeBase( &timeBase );
 
-    /* Release mutex. */
-    xSemaphoreGive( xMutex );
+    calculateCurrentTime( &timeBase, &currentTime );
 
     /* Convert UTC time from UNIX timescale to SNTP timestamp format. */
     ntpSecs = currentTime.secs + SNTP_TIME_AT_UNIX_EPOCH_SECS;
@@ -912,36 +1092,115 @@ static void sntpClient_SetTime( const SntpServerInfo_t * pTimeServer,
      */
     ( void ) leapSecondInfo;
 
-    LogInfo( ( "Received time from time server: %s", pTimeServer->pServerName ) );
+    TimeServerQuery_t * pQuery = findServerQuery( pTimeServer );
+
+    pQuery->sample.serverTime = *pServerTime;
+    pQuery->sample.clockOffsetMs = clockOffsetMs;
+    pQuery->sample.receiveTickCount = xTaskGetTickCount();
+    pQuery->sample.roundTripTicks = pQuery->sample.receiveTickCount - pQuery->udpContext.sendTickCount;
+    pQuery->sample.valid = true;
+
+    LogInfo( ( "Received time from time server: %s: ClockOffset=%lldms, RoundTrip=%lums",
+               pTimeServer->pServerName, ( long long ) clockOffsetMs,
+               ( unsigned long ) ( pQuery->sample.roundTripTicks * MILLISECONDS_PER_TICK ) ) );
+}
 
-    /* Obtain the mutext for accessing system clock variables. */
-    xSemaphoreTake( xMutex, portMAX_DELAY );
+/*-----------------------------------------------------------*/
 
-    /* Always correct the system base time on receiving time from server.*/
+static void correctSystemClock( const char * pServerName,
+                                const TimeSample_t * pSample )
+{
     SntpStatus_t status;
     uint32_t unixSecs;
     uint32_t unixMicroSecs;
-
-    /* Convert server time from NTP timestamp to UNIX format. */
-    status = Sntp_ConvertToUnixTime( pServerTime,
-                                     &unixSecs,
-                                     &unixMicroSecs );
-    configASSERT( status == SntpSuccess );
-
-    /* Always correct the base time of the system clock as the time received from the server. */
-    systemClock.baseTime.secs = unixSecs;
-    systemClock.baseTime.msecs = unixMicroSecs / 1000;
-
-    /* Set the clock adjustment "slew" rate of system clock if it wasn't set already and this is NOT
-     * the first clock synchronization since device boot-up. */
-    if( ( systemClock.firstTimeSyncDone == true ) && ( systemClock.slewRate == 0 ) )
+    SystemClockTimeBase_t timeBase;
+    TickType_t tickCount;
+    uint64_t systemTimeMs;
+    uint64_t elapsedMs;
+    int64_t clockOffsetMs = pSample->clockOffsetMs;
+    int64_t frequencyPpm;
+    int64_t phasePpm;
+    int64_t ratePpm;
+
+    LogInfo( ( "Correcting system clock with the time from time server: %s", pServerName ) );
+
+    /* Only this task writes the system clock, so the time base in use can be
+     * read without a retry. */
+    timeBase = systemClock.timeBase[ systemClock.sequence & 1U ];
+    tickCount = xTaskGetTickCount();
+    systemTimeMs = calculateCurrentTimeMs( &timeBase, tickCount );
+    elapsedMs = ( uint64_t ) ( tickCount - timeBase.lastSyncTickCount ) * MILLISECONDS_PER_TICK;
+
+    if( ( systemClock.firstTimeSyncDone == false ) ||
+        ( clockOffsetMs > democonfigSYSTEM_CLOCK_STEP_THRESHOLD_MS ) ||
+        ( clockOffsetMs < -democonfigSYSTEM_CLOCK_STEP_THRESHOLD_MS ) )
+    {
+        /* Convert server time from NTP timestamp to UNIX format. */
+        status = Sntp_ConvertToUnixTime( &pSample->serverTime,
+                                         &unixSecs,
+                                         &unixMicroSecs );
+        configASSERT( status == SntpSuccess );
+
+        /* Step the system clock to the time received from the server, on the
+         * first time synchronization since device boot-up or when the offset
+         * is too large to slew away. The learnt frequency correction is kept.
+         * The server time is advanced by the time passed since the sample was
+         * received, while the samples of the other servers were awaited. */
+        LogInfo( ( "Stepping system clock by %lld ms.", ( long long ) clockOffsetMs ) );
+        timeBase.baseTimeMs = ( ( uint64_t ) unixSecs * 1000U ) + ( unixMicroSecs / 1000U ) +
+                              ( ( uint64_t ) ( tickCount - pSample->receiveTickCount ) * MILLISECONDS_PER_TICK );
+        timeBase.phasePpm = 0;
+        timeBase.phaseDurationMs = 0;
+    }
+    else
     {
         /* We will use a "slew" correction approach to compensate for system clock
          * drift over poll interval period that exists between consecutive time synchronizations
-         * with time server. */
+         * with time server. The base time is the current system time, so that the time does
+         * not jump. */
+        timeBase.baseTimeMs = systemTimeMs;
+
+        /* The offset built up since the last synchronization is the drift that
+         * the frequency correction missed, so it is added to the correction. */
+        frequencyPpm = timeBase.frequencyPpm;
+
+        if( elapsedMs > 0U )
+        {
+            frequencyPpm += ( clockOffsetMs * 1000000 ) / ( int64_t ) elapsedMs;
+        }
+
+        /* Slew the offset away over the next poll period. */
+        timeBase.phaseDurationMs = systemClock.pollPeriod * 1000U;
+        phasePpm = ( timeBase.phaseDurationMs > 0U ) ?
+                   ( ( clockOffsetMs * 1000000 ) / ( int64_t ) timeBase.phaseDurationMs ) : 0;
+
+        /* Bound the total rate adjustment so that the system time never runs
+         * backwards. The phase correction is reduced first. */
+        if( frequencyPpm > democonfigSYSTEM_CLOCK_MAX_SLEW_PPM )
+        {
+            frequencyPpm = democonfigSYSTEM_CLOCK_MAX_SLEW_PPM;
+        }
+        else if( frequencyPpm < -democonfigSYSTEM_CLOCK_MAX_SLEW_PPM )
+        {
+            frequencyPpm = -democonfigSYSTEM_CLOCK_MAX_SLEW_PPM;
+        }
 
-        /* Calculate the "slew" rate for system clock as milliseconds of adjustment needed per second. */
-        systemClock.slewRate = clockOffsetMs / systemClock.pollPeriod;
+        ratePpm = frequencyPpm + phasePpm;
+
+        if( ratePpm > democonfigSYSTEM_CLOCK_MAX_SLEW_PPM )
+        {
+            phasePpm = democonfigSYSTEM_CLOCK_MAX_SLEW_PPM - frequencyPpm;
+        }
+        else if( ratePpm < -democonfigSYSTEM_CLOCK_MAX_SLEW_PPM )
+        {
+            phasePpm = -democonfigSYSTEM_CLOCK_MAX_SLEW_PPM - frequencyPpm;
+        }
+
+        timeBase.frequencyPpm = ( int32_t ) frequencyPpm;
+        timeBase.phasePpm = ( int32_t ) phasePpm;
+
+        LogInfo( ( "Slewing system clock by %lld ms: FrequencyCorrection=%ldppm, PhaseCorrection=%ldppm",
+                   ( long long ) clockOffsetMs, ( long ) timeBase.frequencyPpm, ( long ) timeBase.phasePpm ) );
     }
 
     /* Set the system clock flag that indicates completion of the first time synchronization since device boot-up. */
@@ -951,9 +1210,9 @@ static void sntpClient_SetTime( const SntpServerInfo_t * pTimeServer,
     }
 
     /* Store the tick count of the current time synchronization in the system clock. */
-    systemClock.lastSyncTickCount = xTaskGetTickCount();
+    timeBase.lastSyncTickCount = tickCount;
 
-    xSemaphoreGive( xMutex );
+    writeSystemClockTimeBase( &timeBase );
 }
 
 /**************************** Authentication Utilities and Interface Functions ***********************************************/
@@ -1327,16 +1586,17 @@ void initializeSystemClock( void )
 {
     /* On boot-up initialize the system time as the first second in the configured year. */
     uint32_t startupTimeInUnixSecs = translateYearToUnixSeconds( democonfigSYSTEM_START_YEAR );
+    SystemClockTimeBase_t timeBase = { 0 };
+    UTCTime_t startupTime = { 0 };
 
-    systemClock.baseTime.secs = startupTimeInUnixSecs;
-    systemClock.baseTime.msecs = 0;
+    timeBase.baseTimeMs = ( uint64_t ) startupTimeInUnixSecs * 1000U;
+    timeBase.lastSyncTickCount = xTaskGetTickCount();
+    writeSystemClockTimeBase( &timeBase );
 
-    LogInfo( ( "System time has been initialized to the year %u", democonfigSYSTEM_START_YEAR ) );
-    printTime( &systemClock.baseTime );
+    startupTime.secs = startupTimeInUnixSecs;
 
-    /* Initialize semaphore for guarding access to system clock variables. */
-    xMutex = xSemaphoreCreateMutex();
-    configASSERT( xMutex );
+    LogInfo( ( "System time has been initialized to the year %u", democonfigSYSTEM_START_YEAR ) );
+    printTime( &startupTime );
 
     /* Clear the first time sync completed flag of the system clock object so that a "step" correction
      * of system time is utilized for the first time synchronization from a time server. */
@@ -1345,56 +1605,30 @@ void initializeSystemClock( void )
 
 /*-----------------------------------------------------------*/
 
-static bool initializeSntpClient( SntpContext_t * pContext,
-                                  const char ** pTimeServers,
-                                  size_t numOfServers,
-                                  uint8_t * pContextBuffer,
-                                  size_t contextBufferSize,
-                                  NetworkContext_t * pUdpContext,
-                                  SntpAuthContext_t * pAuthContext )
+static bool initializeServerQueries( void )
 {
     bool initStatus = false;
 
     /* Populate the list of time servers. */
-    SntpServerInfo_t * pServers = pvPortMalloc( sizeof( SntpServerInfo_t ) * numOfServers );
+    pServerQueries = pvPortMalloc( sizeof( TimeServerQuery_t ) * numOfServers );
 
-    if( pServers == NULL )
+    if( pServerQueries == NULL )
     {
         LogError( ( "Unable to initialize SNTP client: Malloc failed for memory of configured time servers." ) );
     }
     else
     {
-        UdpTransportInterface_t udpTransportIntf;
-        SntpAuthenticationInterface_t symmetricKeyAuthIntf;
+        memset( pServerQueries, 0, sizeof( TimeServerQuery_t ) * numOfServers );
 
         for( uint8_t index = 0; index < numOfServers; index++ )
         {
-            pServers[ index ].pServerName = pTimeServers[ index ];
-            pServers[ index ].port = SNTP_DEFAULT_SERVER_PORT;
-        }
+            pServerQueries[ index ].server.pServerName = pTimeServers[ index ];
+            pServerQueries[ index ].server.port = SNTP_DEFAULT_SERVER_PORT;
 
-        /* Set the UDP transport interface object. */
-        udpTransportIntf.pUserContext = pUdpContext;
-        udpTransportIntf.sendTo = UdpTransport_Send;
-        udpTransportIntf.recvFrom = UdpTransport_Recv;
-
-        /* Set the authentication interface object. */
-        symmetricKeyAuthIntf.pAuthContext = pAuthContext;
-        symmetricKeyAuthIntf.generateClientAuth = addClientAuthCode;
-        symmetricKeyAuthIntf.validateServerAuth = validateServerAuth;
-
-        /* Initialize context. */
-        Sntp_Init( pContext,
-                   pServers,
-                   numOfServers,
-                   democonfigSERVER_RESPONSE_TIMEOUT_MS,
-                   pContextBuffer,
-                   contextBufferSize,
-                   resolveDns,
-                   sntpClient_GetTime,
-                   sntpClient_SetTime,
-                   &udpTransportIntf,
-                   &symmetricKeyAuthIntf );
+            /* Initialize the authentication context with the information of the time
+             * server and its keys configured in the demo. */
+            populateAuthContextForServer( pTimeServers[ index ], &pServerQueries[ index ].authContext );
+        }
 
         initStatus = true;
     }
@@ -1404,6 +1638,214 @@ static bool initializeSntpClient( SntpContext_t * pContext,
 
 /*-----------------------------------------------------------*/
 
+static void initializeSntpClient( TimeServerQuery_t * pQuery )
+{
+    UdpTransportInterface_t udpTransportIntf;
+    SntpAuthenticationInterface_t symmetricKeyAuthIntf;
+    SntpStatus_t status;
+
+    /* Set the UDP transport interface object. */
+    udpTransportIntf.pUserContext = &pQuery->udpContext;
+    udpTransportIntf.sendTo = UdpTransport_Send;
+    udpTransportIntf.recvFrom = UdpTransport_Recv;
+
+    /* Set the authentication interface object. */
+    symmetricKeyAuthIntf.pAuthContext = &pQuery->authContext;
+    symmetricKeyAuthIntf.generateClientAuth = addClientAuthCode;
+    symmetricKeyAuthIntf.validateServerAuth = validateServerAuth;
+
+    /* Initialize context. */
+    status = Sntp_Init( &pQuery->context,
+                        &pQuery->server,
+                        1,
+                        democonfigSERVER_RESPONSE_TIMEOUT_MS,
+                        pQuery->contextBuffer,
+                        sizeof( pQuery->contextBuffer ),
+                        resolveDns,
+                        sntpClient_GetTime,
+                        sntpClient_SetTime,
+                        &udpTransportIntf,
+                        &symmetricKeyAuthIntf );
+    configASSERT( status == SntpSuccess );
+}
+
+/*-----------------------------------------------------------*/
+
+static TimeServerQuery_t * findServerQuery( const SntpServerInfo_t * pServer )
+{
+    TimeServerQuery_t * pQuery = NULL;
+
+    for( size_t index = 0; index < numOfServers; index++ )
+    {
+        if( &pServerQueries[ index ].server == pServer )
+        {
+            pQuery = &pServerQueries[ index ];
+            break;
+        }
+    }
+
+    configASSERT( pQuery != NULL );
+
+    return pQuery;
+}
+
+/*-----------------------------------------------------------*/
+
+static TimeServerQuery_t * queryTimeServers( bool * pRejected )
+{
+    TimeServerQuery_t * pBestQuery = NULL;
+    TimeServerQuery_t * pQuery;
+    SocketSet_t socketSet;
+    size_t pendingCount = 0;
+    SntpStatus_t status;
+    bool socketStatus;
+
+    *pRejected = false;
+
+    socketSet = FreeRTOS_CreateSocketSet();
+    configASSERT( socketSet != NULL );
+
+    /* Send a time request to every server before waiting for any response. A
+     * server whose address is cached is sent its request at once, so the DNS
+     * look ups of the other servers overlap with its round trip. */
+    for( size_t index = 0; index < numOfServers; index++ )
+    {
+        pQuery = &pServerQueries[ index ];
+        pQuery->pending = false;
+        pQuery->sample.valid = false;
+
+        initializeSntpClient( pQuery );
+
+        /* Create a UDP socket for the current iteration of time polling. */
+        socketStatus = createUdpSocket( &pQuery->udpContext.socket );
+        configASSERT( socketStatus == true );
+
+        status = Sntp_SendTimeRequest( &pQuery->context, generateRandomNumber(), democonfigSEND_TIME_REQUEST_TIMEOUT_MS );
+
+        if( status == SntpSuccess )
+        {
+            FreeRTOS_FD_SET( pQuery->udpContext.socket, socketSet, eSELECT_READ );
+            pQuery->pending = true;
+            pendingCount++;
+        }
+        else
+        {
+            LogWarn( ( "Failed to send time request to %s: Status=%s",
+                       pQuery->server.pServerName, Sntp_StatusToStr( status ) ) );
+            closeUdpSocket( &pQuery->udpContext.socket );
+        }
+    }
+
+    while( pendingCount > 0 )
+    {
+        TickType_t blockTime = pdMS_TO_TICKS( democonfigRECEIVE_SERVER_RESPONSE_BLOCK_TIME_MS );
+
+        /* Once a sample has been received, an outstanding server can only give a
+         * better sample while its request has been out for less than the round
+         * trip of the best sample. Stop waiting when no server can. */
+        if( pBestQuery != NULL )
+        {
+            TickType_t tickCount = xTaskGetTickCount();
+            bool canImprove = false;
+
+            for( size_t index = 0; index < numOfServers; index++ )
+            {
+                pQuery = &pServerQueries[ index ];
+
+                if( pQuery->pending == true )
+                {
+                    TickType_t outstandingTicks = tickCount - pQuery->udpContext.sendTickCount;
+
+                    if( outstandingTicks < pBestQuery->sample.roundTripTicks )
+                    {
+                        canImprove = true;
+
+                        if( ( pBestQuery->sample.roundTripTicks - outstandingTicks ) < blockTime )
+                        {
+                            blockTime = pBestQuery->sample.roundTripTicks - outstandingTicks;
+                        }
+                    }
+                }
+            }
+
+            if( canImprove == false )
+            {
+                break;
+            }
+        }
+
+        /* Wait for a response from any of the servers. The block time is bounded so
+         * that the coreSNTP library can detect the servers that do not respond. */
+        ( void ) FreeRTOS_select( socketSet, blockTime );
+
+        for( size_t index = 0; index < numOfServers; index++ )
+        {
+            pQuery = &pServerQueries[ index ];
+
+            if( pQuery->pending == true )
+            {
+                /* The sockets do not block, so this only reads a response that has
+                 * already arrived, or detects the response timeout. */
+                status = Sntp_ReceiveTimeResponse( &pQuery->context, 0 );
+
+                if( status != SntpNoResponseReceived )
+                {
+                    /* Close the UDP socket irrespective of whether a server response is received. */
+                    FreeRTOS_FD_CLR( pQuery->udpContext.socket, socketSet, eSELECT_ALL );
+                    closeUdpSocket( &pQuery->udpContext.socket );
+                    pQuery->pending = false;
+                    pendingCount--;
+
+                    if( ( status == SntpSuccess ) && ( pQuery->sample.valid == true ) )
+                    {
+                        /* Servers earlier in the list win ties. */
+                        if( ( pBestQuery == NULL ) ||
+                            ( pQuery->sample.roundTripTicks < pBestQuery->sample.roundTripTicks ) )
+                        {
+                            pBestQuery = pQuery;
+                        }
+                    }
+                    else
+                    {
+                        LogWarn( ( "No time from time server %s: Status=%s",
+                                   pQuery->server.pServerName, Sntp_StatusToStr( status ) ) );
+
+                        if( status == SntpRejectedResponse )
+                        {
+                            *pRejected = true;
+                        }
+                        else if( status == SntpErrorResponseTimeout )
+                        {
+                            /* Resolve the server again for the next poll, in case it moved. */
+                            pQuery->cachedIpV4Addr = 0;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /* Close the sockets of the servers that cannot give a better sample, so that
+     * their responses are dropped. */
+    for( size_t index = 0; index < numOfServers; index++ )
+    {
+        pQuery = &pServerQueries[ index ];
+
+        if( pQuery->pending == true )
+        {
+            FreeRTOS_FD_CLR( pQuery->udpContext.socket, socketSet, eSELECT_ALL );
+            closeUdpSocket( &pQuery->udpContext.socket );
+            pQuery->pending = false;
+        }
+    }
+
+    FreeRTOS_DeleteSocketSet( socketSet );
+
+    return pBestQuery;
+}
+
+/*-----------------------------------------------------------*/
+
 static bool createUdpSocket( Socket_t * pSocket )
 {
     bool status = false;
@@ -1425,6 +1867,12 @@ static bool createUdpSocket( Socket_t * pSocket )
     }
     else
     {
+        /* Reads do not block, so that the responses of several time servers can be
+         * waited for together with FreeRTOS_select(). */
+        TickType_t receiveTimeout = 0;
+
+        ( void ) FreeRTOS_setsockopt( *pSocket, 0, FREERTOS_SO_RCVTIMEO, &receiveTimeout, sizeof( receiveTimeout ) );
+
         /* Use a random UDP port for SNTP communication with server for protection against
          * spoofing vulnerability from "network off-path" attackers. */
         uint16_t randomPort = ( generateRandomNumber() % UINT16_MAX );
@@ -1504,7 +1952,6 @@ static bool calculateBackoffForNextPoll( BackoffAlgorithmContext_t * pBackoffCon
 
 void sntpTask( void * pParameters )
 {
-    SntpContext_t clientContext;
     bool initStatus = false;
     CK_RV pkcs11Status;
 
@@ -1513,49 +1960,24 @@ void sntpTask( void * pParameters )
     configASSERT( numOfServers == ( sizeof( pAESCMACAuthKeys ) / sizeof( pAESCMACAuthKeys[ 0 ] ) ) );
     configASSERT( numOfServers == sizeof( pAuthKeyIds ) / sizeof( pAuthKeyIds[ 0 ] ) );
 
-    /* Variable representing the SNTP client context. */
-    static SntpContext_t context;
-
-    /* Memory for the SNTP packet buffer in the SNTP context. */
-    static uint8_t contextBuffer[ SNTP_PACKET_AUTHENTICATED_MODE_SIZE ];
-
-    /* Memory for the network context representing the UDP socket that will be
-     * passed to the SNTP client context. */
-    static NetworkContext_t udpContext;
-
     /* Initialize PKCS11 module for cryptographic operations of AES-128-CMAC show
      * shown in this demo for authentication mechanism in SNTP communication with server. */
     pkcs11Status = xInitializePKCS11();
     configASSERT( pkcs11Status == CKR_OK );
 
-    /* Memory for authentication context that will be passed to  the SNTP client context through
-     * the authentication interface. This represents a combination of the time server and
-     * its authentication key information that will be utilized for authentication communication
-     * between client and server, if the server supports authentication. */
-    static SntpAuthContext_t authContext;
-
     /* Context used for calculating backoff that is applied to polling interval when the configured
      * time server rejects time request.
      * Note: Backoff is applied to polling interval ONLY when a single server is configured in the demo
-     * because in the case of multiple server configurations, the coreSNTP library handles server
-     * rejection by rotating server. */
+     * because in the case of multiple server configurations, every server is queried in each poll, and
+     * the time is taken from the other servers when one rejects the time request. */
     static BackoffAlgorithmContext_t backoffContext;
 
-    /* Initialize the authentication context for information for the first time server and its
-     * keys configured in the demo. */
-    populateAuthContextForServer( pTimeServers[ 0 ], &authContext );
-
-    initStatus = initializeSntpClient( &clientContext,
-                                       pTimeServers,
-                                       numOfServers,
-                                       contextBuffer,
-                                       sizeof( contextBuffer ),
-                                       &udpContext,
-                                       &authContext );
+    initStatus = initializeServerQueries();
 
     if( initStatus == true )
     {
-        SntpStatus_t status;
+        TimeServerQuery_t * pBestQuery = NULL;
+        bool rejected = false;
         bool backoffModeFlag = false;
 
         /* Set the polling interval for periodic time synchronization attempts by the SNTP client. */
@@ -1566,13 +1988,13 @@ void sntpTask( void * pParameters )
         LogInfo( ( "Initialized SNTP Client context. Starting SNTP client loop to poll time every %lu seconds",
                    systemClock.pollPeriod ) );
 
-        /* The loop of the SNTP Client task that synchronizes system time with a time server (in the configured list of time servers)
+        /* The loop of the SNTP Client task that synchronizes system time with the time servers (in the configured list of time servers)
          * periodically at intervals of polling period. Each iteration of time synchronization is performed by calling the coreSNTP
-         * APIs for sending time request to the server and receiving time response from the server. */
+         * APIs for sending time requests to all servers, and receiving time responses from the servers. The system clock is
+         * corrected with the response of the shortest round trip, as its clock offset has the smallest error. */
         while( 1 )
         {
             LogInfo( ( "---------STARTING DEMO---------\r\n" ) );
-            bool socketStatus = false;
 
             /* For security, this demo keeps a UDP socket open only for one iteration of SNTP request-response cycle.
              * There is a security risk of a UDP socket being flooded with invalid or malicious server response packets
@@ -1595,27 +2017,17 @@ void sntpTask( void * pParameters )
                 }
             }
 
-            /* Create a UDP socket for the current iteration of time polling. */
-            socketStatus = createUdpSocket( &udpContext.socket );
-            configASSERT( socketStatus == true );
+            /* Query all the time servers, waiting for server responses for a maximum time of server response timeout. */
+            pBestQuery = queryTimeServers( &rejected );
 
-            status = Sntp_SendTimeRequest( &clientContext, generateRandomNumber(), democonfigSEND_TIME_REQUEST_TIMEOUT_MS );
-            configASSERT( status == SntpSuccess );
-
-            /* Wait for server response for a maximum time of server response timeout. */
-            do
+            if( pBestQuery != NULL )
             {
-                /* Attempt to receive server response each time for a smaller block time
-                 * than the total duration for the server response to time out. */
-                status = Sntp_ReceiveTimeResponse( &clientContext, democonfigRECEIVE_SERVER_RESPONSE_BLOCK_TIME_MS );
-            } while( status == SntpNoResponseReceived );
-
-            /* Close the UDP socket irrespective of whether a server response is received. */
-            closeUdpSocket( &udpContext.socket );
+                correctSystemClock( pBestQuery->server.pServerName, &pBestQuery->sample );
+            }
 
             /* Apply back-off delay before the next poll iteration if the demo has been configured with only
              * a single time server. */
-            if( ( status == SntpRejectedResponse ) && ( numOfServers == 1 ) )
+            if( ( pBestQuery == NULL ) && ( rejected == true ) && ( numOfServers == 1 ) )
             {
                 bool backoffStatus = false;
 
@@ -1669,20 +2081,15 @@ void sntpTask( void * pParameters )
 
 void systemGetWallClockTime( UTCTime_t * pTime )
 {
-    TickType_t xTickCount = 0;
-    uint32_t ulTimeMs = 0UL;
+    SystemClockTimeBase_t timeBase;
 
-    /* Obtain the mutext for accessing system clock variables. */
-    xSemaphoreTake( xMutex, portMAX_DELAY );
+    /* Read the system clock variables without blocking, so that tasks which
+     * timestamp often do not contend with each other or the SNTP client task. */
+    readSystemClockTimeBase( &timeBase );
 
     /* Calculate the current RAM-based time using a mathematical formula using
      * system clock state parameters and the time transpired since last synchronization. */
-    calculateCurrentTime( &systemClock.baseTime,
-                          systemClock.lastSyncTickCount,
-                          systemClock.slewRate,
-                          pTime );
-
-    xSemaphoreGive( xMutex );
+    calculateCurrentTime( &timeBase, pTime );
 }
 
 /*-----------------------------------------------------------*/
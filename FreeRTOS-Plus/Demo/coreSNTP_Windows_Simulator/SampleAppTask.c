@@ -42,6 +42,7 @@
 /* Kernel includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 
 /* Demo includes. */
 #include "common_demo_include.h"
@@ -54,6 +55,34 @@
  */
 #define CLOCK_QUERY_TASK_DELAY_MS    ( 1000 )
 
+/**
+ * @brief Set to 1 to measure the cost of a system clock query when the task starts.
+ */
+#ifndef democonfigBENCHMARK_CLOCK_QUERIES
+    #define democonfigBENCHMARK_CLOCK_QUERIES    ( 0 )
+#endif
+
+/**
+ * @brief The duration, in milliseconds, of each clock query benchmark run.
+ */
+#define CLOCK_QUERY_BENCHMARK_DURATION_MS    ( 1000 )
+
+/*-----------------------------------------------------------*/
+
+#if ( democonfigBENCHMARK_CLOCK_QUERIES == 1 )
+
+/**
+ * @brief Count the system clock queries that complete in
+ * CLOCK_QUERY_BENCHMARK_DURATION_MS, and log the cost of each.
+ *
+ * @param[in] pcName The name of the run.
+ * @param[in] xMutex A mutex to take around every query, as a query that locks
+ * the system clock does, or NULL for no lock.
+ */
+    static void prvBenchmarkClockQueries( const char * pcName,
+                                          SemaphoreHandle_t xMutex );
+#endif
+
 /*-----------------------------------------------------------*/
 
 void printTime( const UTCTime_t * pUnixTime )
@@ -74,11 +103,74 @@ void printTime( const UTCTime_t * pUnixTime )
 
 /*************************************************************************************/
 
+#if ( democonfigBENCHMARK_CLOCK_QUERIES == 1 )
+
+    static void prvBenchmarkClockQueries( const char * pcName,
+                                          SemaphoreHandle_t xMutex )
+    {
+        UTCTime_t systemTime;
+        TickType_t xStart;
+        uint32_t ulQueries = 0;
+
+        /* Start on a tick boundary, so that the run lasts whole ticks. */
+        xStart = xTaskGetTickCount();
+
+        while( xTaskGetTickCount() == xStart )
+        {
+        }
+
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < pdMS_TO_TICKS( CLOCK_QUERY_BENCHMARK_DURATION_MS ) )
+        {
+            if( xMutex != NULL )
+            {
+                xSemaphoreTake( xMutex, portMAX_DELAY );
+            }
+
+            systemGetWallClockTime( &systemTime );
+
+            if( xMutex != NULL )
+            {
+                xSemaphoreGive( xMutex );
+            }
+
+            ulQueries++;
+        }
+
+        /* The tick count itself is read on each iteration, which is part of
+         * the cost of a query too. */
+        LogInfo( ( "Clock query benchmark (%s): %lu queries in %d ms, %lu ns per query.",
+                   pcName, ulQueries, CLOCK_QUERY_BENCHMARK_DURATION_MS,
+                   ( ulQueries > 0 ) ?
+                   ( unsigned long ) ( ( ( uint64_t ) CLOCK_QUERY_BENCHMARK_DURATION_MS * 1000000U ) / ulQueries ) : 0UL ) );
+    }
+
+#endif /* if ( democonfigBENCHMARK_CLOCK_QUERIES == 1 ) */
+
+/*************************************************************************************/
+
 /* Sample application task that will query and log system time every second. */
 void sampleAppTask( void * pvParameters )
 {
     UTCTime_t systemTime;
 
+    #if ( democonfigBENCHMARK_CLOCK_QUERIES == 1 )
+    {
+        SemaphoreHandle_t xMutex = xSemaphoreCreateMutex();
+
+        configASSERT( xMutex != NULL );
+
+        /* The lock-free query, and the same query behind a mutex as a query
+         * that locks the system clock pays for. The times are in ticks of the
+         * simulator, so they compare the two rather than measure the device. */
+        prvBenchmarkClockQueries( "lock-free", NULL );
+        prvBenchmarkClockQueries( "mutex", xMutex );
+
+        vSemaphoreDelete( xMutex );
+    }
+    #endif /* if ( democonfigBENCHMARK_CLOCK_QUERIES == 1 ) */
+
     while( 1 )
     {
         systemGetWallClockTime( &systemTime );
@@ -163,17 +163,30 @@ extern void vLoggingPrintf( const char * pcFormatString,
 #define democonfigSEND_TIME_REQUEST_TIMEOUT_MS             ( 50 )
 
 /**
- * @brief The maximum block time (in milliseconds) for an attempt to read server response (to a time request)
- * from the network through the Sntp_ReceiveTimeResponse API.
- *
- * @note This value MAY BE less than the server response timeout (configured in democonfigSERVER_RESPONSE_TIMEOUT_MS)
- * to support use-cases when application DOES NOT want to block for the entire server response timeout period.
- * In such a case, the Sntp_ReceiveTimeResponse API can be called multiple times (with block time duration
- * that is orders of degree shorter than the response timeout value) to check whether an expected server response
- * has been received as well as performing other application logic in the same thread context.
+ * @brief The maximum block time (in milliseconds) for an attempt to read server responses (to the time requests)
+ * from the network.
+ *
+ * @note The demo sends a time request to every configured time server, and waits for the responses of all the
+ * servers together with the FreeRTOS_select API, for at most this block time at once. The Sntp_ReceiveTimeResponse
+ * API is then called for each server to read its response or to detect that the server response timeout
+ * (configured in democonfigSERVER_RESPONSE_TIMEOUT_MS) has passed. This value MUST therefore be less than the
+ * server response timeout.
  */
 #define democonfigRECEIVE_SERVER_RESPONSE_BLOCK_TIME_MS    ( 200 )
 
+/**
+ * @brief The time (in seconds) for which the demo reuses the resolved address of a time server, so that
+ * time requests after the first are not delayed by DNS look ups. The address is resolved again earlier if
+ * the server does not respond.
+ */
+#define democonfigDNS_CACHE_MAX_AGE_SECONDS                ( 3600 )
+
+/**
+ * @brief Set to 1 for the sample application task to measure the cost of a system
+ * clock query, with and without a mutex around it, before it starts logging the time.
+ */
+#define democonfigBENCHMARK_CLOCK_QUERIES                  ( 0 )
+
 /**
  * @brief Set the stack size of the main demo task.
  *
@@ -0,0 +1,705 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file crypto_accel.c
+ * @brief Serializes the hooks of the crypto accelerator and gives them
+ * DMA-friendly buffers.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "crypto_accel.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Round a length up to a multiple of #CRYPTO_ACCEL_GRANULE.
+ */
+#define ROUND_UP_TO_GRANULE( length ) \
+    ( ( ( length ) + ( CRYPTO_ACCEL_GRANULE - 1U ) ) & ~( ( size_t ) CRYPTO_ACCEL_GRANULE - 1U ) )
+
+/**
+ * @brief The size of the buffer of the additional data of an AES-GCM
+ * message.
+ */
+#define AAD_BUFFER_SIZE    ROUND_UP_TO_GRANULE( CRYPTO_ACCEL_GCM_MAX_AAD_LENGTH )
+
+/**
+ * @brief What processChunks() gives to the hook of a chunk.
+ */
+typedef struct ChunkContext
+{
+    const CryptoAccelOps_t * pOps;
+    CryptoAccelSha256State_t * pState;
+} ChunkContext_t;
+
+/**
+ * @brief The hook of a chunk of data, see processChunks().
+ */
+typedef CryptoAccelStatus_t ( * ChunkHook_t )( const ChunkContext_t * pContext,
+                                               const uint8_t * pInput,
+                                               uint8_t * pOutput,
+                                               size_t length );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The order of the P-256 curve, big-endian.
+ */
+static const uint8_t p256Order[ CRYPTO_ACCEL_P256_LENGTH ] =
+{
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0x00U, 0x00U, 0x00U, 0x00U,
+    0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0xFFU,
+    0xBCU, 0xE6U, 0xFAU, 0xADU, 0xA7U, 0x17U, 0x9EU, 0x84U,
+    0xF3U, 0xB9U, 0xCAU, 0xC2U, 0xFCU, 0x63U, 0x25U, 0x51U
+};
+
+/**
+ * @brief The operations of the accelerator, or NULL.
+ */
+static const CryptoAccelOps_t * pAccelOps = NULL;
+
+/**
+ * @brief Serializes the hooks.
+ */
+static SemaphoreHandle_t accelLock = NULL;
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/**
+ * @brief The storage of accelLock.
+ */
+    static StaticSemaphore_t accelLockBuffer;
+#endif
+
+/**
+ * @brief The counters of the operations.
+ */
+static CryptoAccelStats_t accelStats;
+
+/**
+ * @brief The storage of the bounce buffer, which is aligned at run time.
+ */
+static uint8_t bounceStorage[ CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE + CRYPTO_ACCEL_DMA_ALIGNMENT - 1U ];
+
+/**
+ * @brief The storage of the padded additional data of an AES-GCM message.
+ */
+static uint8_t aadStorage[ AAD_BUFFER_SIZE + CRYPTO_ACCEL_DMA_ALIGNMENT - 1U ];
+
+/**
+ * @brief The tag of an AES-GCM message, aligned for the hook.
+ */
+static uint32_t tagWords[ CRYPTO_ACCEL_GCM_TAG_LENGTH / sizeof( uint32_t ) ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Return the first address in some storage aligned to
+ * #CRYPTO_ACCEL_DMA_ALIGNMENT.
+ */
+static uint8_t * alignBuffer( uint8_t * pStorage );
+
+/**
+ * @brief Take the lock and return the operations of the accelerator.  If
+ * there are none, return NULL without the lock held.
+ */
+static const CryptoAccelOps_t * acquireAccel( void );
+
+/**
+ * @brief Give the lock taken by acquireAccel().
+ */
+static void releaseAccel( void );
+
+/**
+ * @brief Count an operation according to its result.
+ */
+static void countOperation( CryptoAccelAlgorithm_t algorithm,
+                            CryptoAccelStatus_t status );
+
+/**
+ * @brief Give data to a hook in chunks, directly from the buffers of the
+ * caller where they are DMA-friendly and otherwise through the bounce
+ * buffer.  Called with the lock held.
+ *
+ * All chunks but the last are multiples of #CRYPTO_ACCEL_GRANULE, so a
+ * chunk of the caller's buffers can be cleaned and invalidated on its own.
+ *
+ * @param[in] hook The hook.
+ * @param[in] pContext What the hook is given.
+ * @param[in] pInput The input.
+ * @param[out] pOutput The output, which may be @p pInput, or NULL.
+ * @param[in] length The length of the input.
+ *
+ * @return The result of the first hook which did not succeed, or
+ * CRYPTO_ACCEL_SUCCESS.
+ */
+static CryptoAccelStatus_t processChunks( ChunkHook_t hook,
+                                          const ChunkContext_t * pContext,
+                                          const uint8_t * pInput,
+                                          uint8_t * pOutput,
+                                          size_t length );
+
+/**
+ * @brief Adapt ops->gcmUpdate to processChunks().
+ */
+static CryptoAccelStatus_t gcmChunk( const ChunkContext_t * pContext,
+                                     const uint8_t * pInput,
+                                     uint8_t * pOutput,
+                                     size_t length );
+
+/**
+ * @brief Adapt ops->sha256Update to processChunks().
+ */
+static CryptoAccelStatus_t sha256Chunk( const ChunkContext_t * pContext,
+                                        const uint8_t * pInput,
+                                        uint8_t * pOutput,
+                                        size_t length );
+
+/*-----------------------------------------------------------*/
+
+static uint8_t * alignBuffer( uint8_t * pStorage )
+{
+    uintptr_t address = ( uintptr_t ) pStorage;
+
+    address = ( address + ( CRYPTO_ACCEL_DMA_ALIGNMENT - 1U ) ) & ~( ( uintptr_t ) CRYPTO_ACCEL_DMA_ALIGNMENT - 1U );
+
+    return ( uint8_t * ) address;
+}
+
+/*-----------------------------------------------------------*/
+
+static const CryptoAccelOps_t * acquireAccel( void )
+{
+    const CryptoAccelOps_t * pOps = NULL;
+
+    if( accelLock != NULL )
+    {
+        ( void ) xSemaphoreTake( accelLock, portMAX_DELAY );
+
+        pOps = pAccelOps;
+
+        if( pOps == NULL )
+        {
+            ( void ) xSemaphoreGive( accelLock );
+        }
+    }
+
+    return pOps;
+}
+
+/*-----------------------------------------------------------*/
+
+static void releaseAccel( void )
+{
+    ( void ) xSemaphoreGive( accelLock );
+}
+
+/*-----------------------------------------------------------*/
+
+static void countOperation( CryptoAccelAlgorithm_t algorithm,
+                            CryptoAccelStatus_t status )
+{
+    uint32_t * pAccelerated;
+    uint32_t * pSoftware;
+
+    switch( algorithm )
+    {
+        case CRYPTO_ACCEL_ALGORITHM_GCM:
+            pAccelerated = &accelStats.gcmAccelerated;
+            pSoftware = &accelStats.gcmSoftware;
+            break;
+
+        case CRYPTO_ACCEL_ALGORITHM_SHA256:
+            pAccelerated = &accelStats.sha256Accelerated;
+            pSoftware = &accelStats.sha256Software;
+            break;
+
+        default:
+            pAccelerated = &accelStats.eccAccelerated;
+            pSoftware = &accelStats.eccSoftware;
+            break;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        if( status == CRYPTO_ACCEL_UNSUPPORTED )
+        {
+            ( *pSoftware )++;
+        }
+        else if( status == CRYPTO_ACCEL_HW_ERROR )
+        {
+            accelStats.errors++;
+        }
+        else
+        {
+            ( *pAccelerated )++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t processChunks( ChunkHook_t hook,
+                                          const ChunkContext_t * pContext,
+                                          const uint8_t * pInput,
+                                          uint8_t * pOutput,
+                                          size_t length )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_SUCCESS;
+    uint8_t * pBounce = alignBuffer( bounceStorage );
+    const uint8_t * pChunkInput;
+    uint8_t * pChunkOutput;
+    size_t offset = 0U;
+    size_t remaining;
+    size_t chunk;
+    size_t bounced = 0U;
+
+    while( ( status == CRYPTO_ACCEL_SUCCESS ) && ( offset < length ) )
+    {
+        pChunkInput = &pInput[ offset ];
+        pChunkOutput = ( pOutput != NULL ) ? &pOutput[ offset ] : NULL;
+        remaining = length - offset;
+
+        if( ( remaining >= CRYPTO_ACCEL_GRANULE ) &&
+            CRYPTO_ACCEL_DMA_CAPABLE( pChunkInput ) &&
+            ( ( pChunkOutput == NULL ) || CRYPTO_ACCEL_DMA_CAPABLE( pChunkOutput ) ) )
+        {
+            chunk = remaining - ( remaining % CRYPTO_ACCEL_GRANULE );
+
+            if( chunk > CRYPTO_ACCEL_MAX_TRANSFER )
+            {
+                chunk = CRYPTO_ACCEL_MAX_TRANSFER;
+            }
+
+            status = hook( pContext, pChunkInput, pChunkOutput, chunk );
+        }
+        else
+        {
+            chunk = ( remaining < CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE ) ? remaining : CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE;
+
+            ( void ) memcpy( pBounce, pChunkInput, chunk );
+            ( void ) memset( &pBounce[ chunk ], 0, ROUND_UP_TO_GRANULE( chunk ) - chunk );
+
+            status = hook( pContext, pBounce, ( pChunkOutput != NULL ) ? pBounce : NULL, chunk );
+
+            if( ( status == CRYPTO_ACCEL_SUCCESS ) && ( pChunkOutput != NULL ) )
+            {
+                ( void ) memcpy( pChunkOutput, pBounce, chunk );
+            }
+
+            bounced += chunk;
+        }
+
+        offset += chunk;
+    }
+
+    if( bounced > 0U )
+    {
+        /* Do not leave plaintext behind. */
+        ( void ) memset( pBounce, 0, CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE );
+
+        taskENTER_CRITICAL();
+        {
+            accelStats.bytesBounced += ( uint32_t ) bounced;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t gcmChunk( const ChunkContext_t * pContext,
+                                     const uint8_t * pInput,
+                                     uint8_t * pOutput,
+                                     size_t length )
+{
+    return pContext->pOps->gcmUpdate( pInput, pOutput, length );
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t sha256Chunk( const ChunkContext_t * pContext,
+                                        const uint8_t * pInput,
+                                        uint8_t * pOutput,
+                                        size_t length )
+{
+    ( void ) pOutput;
+
+    return pContext->pOps->sha256Update( pContext->pState, pInput, length );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CryptoAccel_Init( const CryptoAccelOps_t * pOps )
+{
+    BaseType_t result = pdPASS;
+
+    if( accelLock == NULL )
+    {
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            accelLock = xSemaphoreCreateMutexStatic( &accelLockBuffer );
+        #else
+            accelLock = xSemaphoreCreateMutex();
+        #endif
+    }
+
+    if( accelLock != NULL )
+    {
+        ( void ) CryptoAccel_SetOps( pOps );
+    }
+    else
+    {
+        result = pdFAIL;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+const CryptoAccelOps_t * CryptoAccel_SetOps( const CryptoAccelOps_t * pOps )
+{
+    const CryptoAccelOps_t * pPrevious;
+
+    configASSERT( accelLock != NULL );
+
+    ( void ) xSemaphoreTake( accelLock, portMAX_DELAY );
+    pPrevious = pAccelOps;
+    pAccelOps = pOps;
+    ( void ) xSemaphoreGive( accelLock );
+
+    return pPrevious;
+}
+
+/*-----------------------------------------------------------*/
+
+CryptoAccelStatus_t CryptoAccel_Gcm( const CryptoAccelGcmRequest_t * pRequest,
+                                     uint8_t * pTag )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_UNSUPPORTED;
+    CryptoAccelStatus_t finishStatus;
+    CryptoAccelGcmRequest_t start;
+    ChunkContext_t context = { 0 };
+    uint8_t * pAad = alignBuffer( aadStorage );
+
+    configASSERT( pRequest != NULL );
+    configASSERT( pTag != NULL );
+
+    if( pRequest->aadLength <= CRYPTO_ACCEL_GCM_MAX_AAD_LENGTH )
+    {
+        context.pOps = acquireAccel();
+
+        if( context.pOps != NULL )
+        {
+            if( ( context.pOps->gcmStart != NULL ) &&
+                ( context.pOps->gcmUpdate != NULL ) &&
+                ( context.pOps->gcmFinish != NULL ) )
+            {
+                if( pRequest->aadLength > 0U )
+                {
+                    ( void ) memcpy( pAad, pRequest->pAad, pRequest->aadLength );
+                }
+
+                start = *pRequest;
+                start.pAad = pAad;
+                start.pInput = NULL;
+                start.pOutput = NULL;
+
+                status = context.pOps->gcmStart( &start );
+
+                if( status == CRYPTO_ACCEL_SUCCESS )
+                {
+                    status = processChunks( gcmChunk, &context, pRequest->pInput, pRequest->pOutput, pRequest->length );
+                    finishStatus = context.pOps->gcmFinish( ( uint8_t * ) tagWords );
+
+                    if( ( status == CRYPTO_ACCEL_SUCCESS ) && ( finishStatus == CRYPTO_ACCEL_SUCCESS ) )
+                    {
+                        ( void ) memcpy( pTag, tagWords, CRYPTO_ACCEL_GCM_TAG_LENGTH );
+                    }
+                    else
+                    {
+                        status = CRYPTO_ACCEL_HW_ERROR;
+                    }
+
+                    ( void ) memset( tagWords, 0, sizeof( tagWords ) );
+                }
+
+                ( void ) memset( pAad, 0, AAD_BUFFER_SIZE );
+            }
+
+            releaseAccel();
+        }
+    }
+
+    countOperation( CRYPTO_ACCEL_ALGORITHM_GCM, status );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+CryptoAccelStatus_t CryptoAccel_Sha256Start( CryptoAccelSha256State_t * pState )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_UNSUPPORTED;
+    const CryptoAccelOps_t * pOps;
+
+    configASSERT( pState != NULL );
+
+    pOps = acquireAccel();
+
+    if( pOps != NULL )
+    {
+        if( ( pOps->sha256Start != NULL ) &&
+            ( pOps->sha256Update != NULL ) &&
+            ( pOps->sha256Finish != NULL ) )
+        {
+            status = pOps->sha256Start( pState );
+        }
+
+        releaseAccel();
+    }
+
+    countOperation( CRYPTO_ACCEL_ALGORITHM_SHA256, status );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+CryptoAccelStatus_t CryptoAccel_Sha256Update( CryptoAccelSha256State_t * pState,
+                                              const uint8_t * pData,
+                                              size_t length )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_HW_ERROR;
+    ChunkContext_t context;
+
+    configASSERT( pState != NULL );
+    configASSERT( ( pData != NULL ) || ( length == 0U ) );
+
+    context.pOps = acquireAccel();
+    context.pState = pState;
+
+    if( context.pOps != NULL )
+    {
+        if( context.pOps->sha256Update != NULL )
+        {
+            status = processChunks( sha256Chunk, &context, pData, NULL, length );
+        }
+
+        releaseAccel();
+    }
+
+    if( status != CRYPTO_ACCEL_SUCCESS )
+    {
+        countOperation( CRYPTO_ACCEL_ALGORITHM_SHA256, CRYPTO_ACCEL_HW_ERROR );
+        status = CRYPTO_ACCEL_HW_ERROR;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+CryptoAccelStatus_t CryptoAccel_Sha256Finish( CryptoAccelSha256State_t * pState,
+                                              uint8_t * pDigest )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_HW_ERROR;
+    const CryptoAccelOps_t * pOps;
+
+    configASSERT( pState != NULL );
+    configASSERT( pDigest != NULL );
+
+    pOps = acquireAccel();
+
+    if( pOps != NULL )
+    {
+        if( pOps->sha256Finish != NULL )
+        {
+            status = pOps->sha256Finish( pState, pDigest );
+        }
+
+        releaseAccel();
+    }
+
+    if( status != CRYPTO_ACCEL_SUCCESS )
+    {
+        countOperation( CRYPTO_ACCEL_ALGORITHM_SHA256, CRYPTO_ACCEL_HW_ERROR );
+        status = CRYPTO_ACCEL_HW_ERROR;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+CryptoAccelStatus_t CryptoAccel_EcdsaSign( const uint8_t * pPrivateKey,
+                                           const uint8_t * pHash,
+                                           const uint8_t * pNonce,
+                                           uint8_t * pSignature )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_UNSUPPORTED;
+    const CryptoAccelOps_t * pOps = acquireAccel();
+
+    if( pOps != NULL )
+    {
+        if( pOps->ecdsaSign != NULL )
+        {
+            status = pOps->ecdsaSign( pPrivateKey, pHash, pNonce, pSignature );
+        }
+
+        releaseAccel();
+    }
+
+    countOperation( CRYPTO_ACCEL_ALGORITHM_ECC, status );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+CryptoAccelStatus_t CryptoAccel_EcdsaVerify( const uint8_t * pPublicKey,
+                                             const uint8_t * pHash,
+                                             const uint8_t * pSignature )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_UNSUPPORTED;
+    const CryptoAccelOps_t * pOps = acquireAccel();
+
+    if( pOps != NULL )
+    {
+        if( pOps->ecdsaVerify != NULL )
+        {
+            status = pOps->ecdsaVerify( pPublicKey, pHash, pSignature );
+        }
+
+        releaseAccel();
+    }
+
+    countOperation( CRYPTO_ACCEL_ALGORITHM_ECC, status );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+CryptoAccelStatus_t CryptoAccel_Ecdh( const uint8_t * pPrivateKey,
+                                      const uint8_t * pPeerPublicKey,
+                                      uint8_t * pSharedSecret )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_UNSUPPORTED;
+    const CryptoAccelOps_t * pOps = acquireAccel();
+
+    if( pOps != NULL )
+    {
+        if( pOps->ecdh != NULL )
+        {
+            status = pOps->ecdh( pPrivateKey, pPeerPublicKey, pSharedSecret );
+        }
+
+        releaseAccel();
+    }
+
+    countOperation( CRYPTO_ACCEL_ALGORITHM_ECC, status );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void CryptoAccel_CountSoftware( CryptoAccelAlgorithm_t algorithm )
+{
+    countOperation( algorithm, CRYPTO_ACCEL_UNSUPPORTED );
+}
+
+/*-----------------------------------------------------------*/
+
+void CryptoAccel_GetStats( CryptoAccelStats_t * pStats )
+{
+    configASSERT( pStats != NULL );
+
+    taskENTER_CRITICAL();
+    {
+        *pStats = accelStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+void CryptoAccel_P256HashToScalar( const uint8_t * pHash,
+                                   size_t hashLength,
+                                   uint8_t * pScalar )
+{
+    size_t used = ( hashLength < CRYPTO_ACCEL_P256_LENGTH ) ? hashLength : CRYPTO_ACCEL_P256_LENGTH;
+    uint32_t borrow = 0U;
+    uint32_t difference;
+    size_t index;
+
+    ( void ) memset( pScalar, 0, CRYPTO_ACCEL_P256_LENGTH - used );
+    ( void ) memcpy( &pScalar[ CRYPTO_ACCEL_P256_LENGTH - used ], pHash, used );
+
+    /* The value is below twice the order, so one subtraction reduces it. */
+    if( memcmp( pScalar, p256Order, CRYPTO_ACCEL_P256_LENGTH ) >= 0 )
+    {
+        for( index = CRYPTO_ACCEL_P256_LENGTH; index > 0U; index-- )
+        {
+            difference = ( uint32_t ) pScalar[ index - 1U ] - ( uint32_t ) p256Order[ index - 1U ] - borrow;
+            pScalar[ index - 1U ] = ( uint8_t ) difference;
+            borrow = ( difference >> 8 ) & 1U;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t CryptoAccel_P256IsValidScalar( const uint8_t * pScalar )
+{
+    uint32_t borrow = 0U;
+    uint32_t nonZero = 0U;
+    uint32_t difference;
+    size_t index;
+
+    /* Subtract the order without branching on the secret value: the scalar
+     * is below the order if the subtraction borrows. */
+    for( index = CRYPTO_ACCEL_P256_LENGTH; index > 0U; index-- )
+    {
+        difference = ( uint32_t ) pScalar[ index - 1U ] - ( uint32_t ) p256Order[ index - 1U ] - borrow;
+        borrow = ( difference >> 8 ) & 1U;
+        nonZero |= pScalar[ index - 1U ];
+    }
+
+    return ( ( borrow == 1U ) && ( nonZero != 0U ) ) ? pdTRUE : pdFALSE;
+}
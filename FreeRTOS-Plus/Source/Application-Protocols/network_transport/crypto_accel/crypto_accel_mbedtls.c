@@ -0,0 +1,2029 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file crypto_accel_mbedtls.c
+ * @brief The mbedTLS alternatives which use the crypto accelerator, and the
+ * benchmark of the accelerator.
+ *
+ * Each alternative is compiled when its macro is defined in the mbedTLS
+ * configuration.  An alternative replaces the software of mbedTLS, so each
+ * one carries its own software for what the accelerator does not accept.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Mbedtls Includes */
+#ifndef MBEDTLS_ALLOW_PRIVATE_ACCESS
+    #define MBEDTLS_ALLOW_PRIVATE_ACCESS
+#endif /* MBEDTLS_ALLOW_PRIVATE_ACCESS */
+
+/* MBedTLS Includes */
+#if !defined( MBEDTLS_CONFIG_FILE )
+    #include "mbedtls/mbedtls_config.h"
+#else
+    #include MBEDTLS_CONFIG_FILE
+#endif
+
+#include "mbedtls/platform.h"
+#include "mbedtls/platform_util.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecdh.h"
+
+#include "crypto_accel.h"
+
+#ifndef MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED
+    #define MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED    -0x0070
+#endif
+
+/**
+ * @brief Returned by the accelerated paths when the operation must be done in
+ * software.  mbedTLS results are zero or negative.
+ */
+#define USE_SOFTWARE    1
+
+/*-----------------------------------------------------------*/
+
+#if defined( MBEDTLS_GCM_ALT ) || defined( MBEDTLS_SHA256_ALT )
+
+/**
+ * @brief Read a big-endian 32-bit value.
+ */
+    static uint32_t loadBigEndian32( const unsigned char * pBytes );
+
+/*-----------------------------------------------------------*/
+
+    static uint32_t loadBigEndian32( const unsigned char * pBytes )
+    {
+        return ( ( uint32_t ) pBytes[ 0 ] << 24 ) |
+               ( ( uint32_t ) pBytes[ 1 ] << 16 ) |
+               ( ( uint32_t ) pBytes[ 2 ] << 8 ) |
+               ( uint32_t ) pBytes[ 3 ];
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* defined( MBEDTLS_GCM_ALT ) || defined( MBEDTLS_SHA256_ALT ) */
+
+#if defined( MBEDTLS_GCM_ALT ) || defined( MBEDTLS_SHA256_ALT ) || ( defined( MBEDTLS_GCM_C ) && defined( MBEDTLS_SHA256_C ) )
+
+/**
+ * @brief Write a big-endian 32-bit value.
+ */
+    static void storeBigEndian32( uint32_t value,
+                                  unsigned char * pBytes );
+
+/*-----------------------------------------------------------*/
+
+    static void storeBigEndian32( uint32_t value,
+                                  unsigned char * pBytes )
+    {
+        pBytes[ 0 ] = ( unsigned char ) ( value >> 24 );
+        pBytes[ 1 ] = ( unsigned char ) ( value >> 16 );
+        pBytes[ 2 ] = ( unsigned char ) ( value >> 8 );
+        pBytes[ 3 ] = ( unsigned char ) value;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if defined( MBEDTLS_GCM_ALT ) || defined( MBEDTLS_SHA256_ALT ) || ( defined( MBEDTLS_GCM_C ) && defined( MBEDTLS_SHA256_C ) ) */
+
+#if defined( MBEDTLS_GCM_ALT )
+
+    #if !defined( MBEDTLS_AES_C )
+        #error "MBEDTLS_GCM_ALT in crypto_accel_mbedtls.c requires MBEDTLS_AES_C."
+    #endif
+
+/**
+ * @brief The reduction of the 4-bit GHASH table.
+ */
+    static const uint64_t gcmLast4[ 16 ] =
+    {
+        0x0000U, 0x1c20U, 0x3840U, 0x2460U, 0x7080U, 0x6ca0U, 0x48c0U, 0x54e0U,
+        0xe100U, 0xfd20U, 0xd940U, 0xc560U, 0x9180U, 0x8da0U, 0xa9c0U, 0xb5e0U
+    };
+
+/**
+ * @brief Compute the hash subkey and the GHASH table of a key.
+ */
+    static int gcmGenerateTable( mbedtls_gcm_context * ctx );
+
+/**
+ * @brief Multiply a block by the hash subkey in GF(2^128).  @p x and
+ * @p output may be the same.
+ */
+    static void gcmMultiply( const mbedtls_gcm_context * ctx,
+                             const unsigned char x[ 16 ],
+                             unsigned char output[ 16 ] );
+
+/**
+ * @brief Encrypt the counter.
+ */
+    static int gcmEncryptCounter( mbedtls_gcm_context * ctx,
+                                  unsigned char ectr[ 16 ] );
+
+/**
+ * @brief Mask part of a block with the encrypted counter and add the
+ * ciphertext to the GHASH accumulator.
+ */
+    static void gcmMask( mbedtls_gcm_context * ctx,
+                         const unsigned char ectr[ 16 ],
+                         size_t offset,
+                         size_t length,
+                         const unsigned char * input,
+                         unsigned char * output );
+
+/**
+ * @brief Do a whole message on the accelerator.
+ *
+ * @return 0 on success, USE_SOFTWARE if the message must be done in
+ * software, or an mbedTLS error.
+ */
+    static int gcmAccelerated( mbedtls_gcm_context * ctx,
+                               int mode,
+                               size_t length,
+                               const unsigned char * iv,
+                               size_t iv_len,
+                               const unsigned char * add,
+                               size_t add_len,
+                               const unsigned char * input,
+                               unsigned char * output,
+                               size_t tag_len,
+                               unsigned char * tag );
+
+/*-----------------------------------------------------------*/
+
+    static int gcmGenerateTable( mbedtls_gcm_context * ctx )
+    {
+        int ret;
+        int i;
+        int j;
+        uint64_t vh;
+        uint64_t vl;
+        uint32_t t;
+        unsigned char h[ 16 ] = { 0 };
+
+        ret = mbedtls_aes_crypt_ecb( &ctx->aes, MBEDTLS_AES_ENCRYPT, h, h );
+
+        if( ret == 0 )
+        {
+            vh = ( ( uint64_t ) loadBigEndian32( &h[ 0 ] ) << 32 ) | loadBigEndian32( &h[ 4 ] );
+            vl = ( ( uint64_t ) loadBigEndian32( &h[ 8 ] ) << 32 ) | loadBigEndian32( &h[ 12 ] );
+
+            /* 8 = 1000 corresponds to 1 in GF(2^128), and 0 to 0. */
+            ctx->HL[ 8 ] = vl;
+            ctx->HH[ 8 ] = vh;
+            ctx->HL[ 0 ] = 0U;
+            ctx->HH[ 0 ] = 0U;
+
+            for( i = 4; i > 0; i >>= 1 )
+            {
+                t = ( uint32_t ) ( vl & 1U ) * 0xe1000000U;
+                vl = ( vh << 63 ) | ( vl >> 1 );
+                vh = ( vh >> 1 ) ^ ( ( uint64_t ) t << 32 );
+                ctx->HL[ i ] = vl;
+                ctx->HH[ i ] = vh;
+            }
+
+            for( i = 2; i <= 8; i *= 2 )
+            {
+                for( j = 1; j < i; j++ )
+                {
+                    ctx->HH[ i + j ] = ctx->HH[ i ] ^ ctx->HH[ j ];
+                    ctx->HL[ i + j ] = ctx->HL[ i ] ^ ctx->HL[ j ];
+                }
+            }
+        }
+
+        mbedtls_platform_zeroize( h, sizeof( h ) );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void gcmMultiply( const mbedtls_gcm_context * ctx,
+                             const unsigned char x[ 16 ],
+                             unsigned char output[ 16 ] )
+    {
+        int i;
+        unsigned char lo;
+        unsigned char hi;
+        unsigned char rem;
+        uint64_t zh;
+        uint64_t zl;
+
+        lo = x[ 15 ] & 0x0FU;
+        zh = ctx->HH[ lo ];
+        zl = ctx->HL[ lo ];
+
+        for( i = 15; i >= 0; i-- )
+        {
+            lo = x[ i ] & 0x0FU;
+            hi = ( x[ i ] >> 4 ) & 0x0FU;
+
+            if( i != 15 )
+            {
+                rem = ( unsigned char ) ( zl & 0x0FU );
+                zl = ( zh << 60 ) | ( zl >> 4 );
+                zh = ( zh >> 4 ) ^ ( gcmLast4[ rem ] << 48 );
+                zh ^= ctx->HH[ lo ];
+                zl ^= ctx->HL[ lo ];
+            }
+
+            rem = ( unsigned char ) ( zl & 0x0FU );
+            zl = ( zh << 60 ) | ( zl >> 4 );
+            zh = ( zh >> 4 ) ^ ( gcmLast4[ rem ] << 48 );
+            zh ^= ctx->HH[ hi ];
+            zl ^= ctx->HL[ hi ];
+        }
+
+        storeBigEndian32( ( uint32_t ) ( zh >> 32 ), &output[ 0 ] );
+        storeBigEndian32( ( uint32_t ) zh, &output[ 4 ] );
+        storeBigEndian32( ( uint32_t ) ( zl >> 32 ), &output[ 8 ] );
+        storeBigEndian32( ( uint32_t ) zl, &output[ 12 ] );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int gcmEncryptCounter( mbedtls_gcm_context * ctx,
+                                  unsigned char ectr[ 16 ] )
+    {
+        int i;
+
+        /* Increment the last 32 bits of the counter. */
+        for( i = 16; i > 12; i-- )
+        {
+            if( ++ctx->y[ i - 1 ] != 0U )
+            {
+                break;
+            }
+        }
+
+        return mbedtls_aes_crypt_ecb( &ctx->aes, MBEDTLS_AES_ENCRYPT, ctx->y, ectr );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void gcmMask( mbedtls_gcm_context * ctx,
+                         const unsigned char ectr[ 16 ],
+                         size_t offset,
+                         size_t length,
+                         const unsigned char * input,
+                         unsigned char * output )
+    {
+        size_t i;
+        unsigned char ciphertext;
+
+        for( i = 0; i < length; i++ )
+        {
+            if( ctx->mode == MBEDTLS_GCM_DECRYPT )
+            {
+                ciphertext = input[ i ];
+                output[ i ] = ectr[ offset + i ] ^ input[ i ];
+            }
+            else
+            {
+                output[ i ] = ectr[ offset + i ] ^ input[ i ];
+                ciphertext = output[ i ];
+            }
+
+            ctx->buf[ offset + i ] ^= ciphertext;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int gcmAccelerated( mbedtls_gcm_context * ctx,
+                               int mode,
+                               size_t length,
+                               const unsigned char * iv,
+                               size_t iv_len,
+                               const unsigned char * add,
+                               size_t add_len,
+                               const unsigned char * input,
+                               unsigned char * output,
+                               size_t tag_len,
+                               unsigned char * tag )
+    {
+        int ret = USE_SOFTWARE;
+        CryptoAccelStatus_t status;
+        CryptoAccelGcmRequest_t request;
+        uint8_t fullTag[ CRYPTO_ACCEL_GCM_TAG_LENGTH ];
+
+        /* Leave the errors in the parameters to the software. */
+        if( ( ctx->key_bits != 0U ) && ( iv_len != 0U ) &&
+            ( tag_len >= 4U ) && ( tag_len <= CRYPTO_ACCEL_GCM_TAG_LENGTH ) &&
+            ( ( length == 0U ) || ( ( input != NULL ) && ( output != NULL ) ) ) )
+        {
+            request.direction = ( mode == MBEDTLS_GCM_ENCRYPT ) ? CRYPTO_ACCEL_ENCRYPT : CRYPTO_ACCEL_DECRYPT;
+            request.pKey = ctx->key;
+            request.keyLength = ctx->key_bits / 8U;
+            request.pIv = iv;
+            request.ivLength = iv_len;
+            request.pAad = add;
+            request.aadLength = add_len;
+            request.pInput = input;
+            request.pOutput = output;
+            request.length = length;
+
+            status = CryptoAccel_Gcm( &request, fullTag );
+
+            if( status == CRYPTO_ACCEL_SUCCESS )
+            {
+                ( void ) memcpy( tag, fullTag, tag_len );
+                ret = 0;
+            }
+            else if( status != CRYPTO_ACCEL_UNSUPPORTED )
+            {
+                ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+            }
+            else
+            {
+                /* Done in software. */
+            }
+
+            mbedtls_platform_zeroize( fullTag, sizeof( fullTag ) );
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void mbedtls_gcm_init( mbedtls_gcm_context * ctx )
+    {
+        ( void ) memset( ctx, 0, sizeof( mbedtls_gcm_context ) );
+        mbedtls_aes_init( &ctx->aes );
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_gcm_setkey( mbedtls_gcm_context * ctx,
+                            mbedtls_cipher_id_t cipher,
+                            const unsigned char * key,
+                            unsigned int keybits )
+    {
+        int ret = 0;
+
+        if( ( cipher != MBEDTLS_CIPHER_ID_AES ) ||
+            ( ( keybits != 128U ) && ( keybits != 192U ) && ( keybits != 256U ) ) )
+        {
+            ret = MBEDTLS_ERR_GCM_BAD_INPUT;
+        }
+
+        if( ret == 0 )
+        {
+            ctx->key_bits = 0U;
+            mbedtls_aes_free( &ctx->aes );
+            mbedtls_aes_init( &ctx->aes );
+            ret = mbedtls_aes_setkey_enc( &ctx->aes, key, keybits );
+        }
+
+        if( ret == 0 )
+        {
+            ret = gcmGenerateTable( ctx );
+        }
+
+        if( ret == 0 )
+        {
+            ( void ) memcpy( ctx->key, key, keybits / 8U );
+            ctx->key_bits = keybits;
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_gcm_starts( mbedtls_gcm_context * ctx,
+                            int mode,
+                            const unsigned char * iv,
+                            size_t iv_len )
+    {
+        int ret = 0;
+        unsigned char work[ 16 ] = { 0 };
+        size_t useLength;
+        size_t i;
+        const unsigned char * p = iv;
+
+        /* The IV is limited to 2^64 bits, so 2^61 bytes. */
+        if( ( iv_len == 0U ) || ( ( ( uint64_t ) iv_len >> 61 ) != 0U ) )
+        {
+            ret = MBEDTLS_ERR_GCM_BAD_INPUT;
+        }
+        else
+        {
+            ( void ) memset( ctx->y, 0, sizeof( ctx->y ) );
+            ( void ) memset( ctx->buf, 0, sizeof( ctx->buf ) );
+            ctx->mode = mode;
+            ctx->len = 0U;
+            ctx->add_len = 0U;
+
+            if( iv_len == 12U )
+            {
+                ( void ) memcpy( ctx->y, iv, iv_len );
+                ctx->y[ 15 ] = 1U;
+            }
+            else
+            {
+                storeBigEndian32( ( uint32_t ) ( ( ( uint64_t ) iv_len * 8U ) >> 32 ), &work[ 8 ] );
+                storeBigEndian32( ( uint32_t ) ( iv_len * 8U ), &work[ 12 ] );
+
+                while( iv_len > 0U )
+                {
+                    useLength = ( iv_len < 16U ) ? iv_len : 16U;
+
+                    for( i = 0; i < useLength; i++ )
+                    {
+                        ctx->y[ i ] ^= p[ i ];
+                    }
+
+                    gcmMultiply( ctx, ctx->y, ctx->y );
+                    iv_len -= useLength;
+                    p += useLength;
+                }
+
+                for( i = 0; i < 16U; i++ )
+                {
+                    ctx->y[ i ] ^= work[ i ];
+                }
+
+                gcmMultiply( ctx, ctx->y, ctx->y );
+            }
+
+            ret = mbedtls_aes_crypt_ecb( &ctx->aes, MBEDTLS_AES_ENCRYPT, ctx->y, ctx->base_ectr );
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_gcm_update_ad( mbedtls_gcm_context * ctx,
+                               const unsigned char * add,
+                               size_t add_len )
+    {
+        int ret = 0;
+        size_t offset;
+        size_t useLength;
+        size_t i;
+        const unsigned char * p = add;
+
+        /* The additional data comes before the data, and is limited to 2^64
+         * bits. */
+        if( ( ctx->len != 0U ) || ( ( ( uint64_t ) add_len >> 61 ) != 0U ) ||
+            ( ( ctx->add_len + add_len ) < ctx->add_len ) ||
+            ( ( ( ctx->add_len + add_len ) >> 61 ) != 0U ) )
+        {
+            ret = MBEDTLS_ERR_GCM_BAD_INPUT;
+        }
+        else
+        {
+            offset = ( size_t ) ( ctx->add_len % 16U );
+
+            if( offset != 0U )
+            {
+                useLength = 16U - offset;
+
+                if( useLength > add_len )
+                {
+                    useLength = add_len;
+                }
+
+                for( i = 0; i < useLength; i++ )
+                {
+                    ctx->buf[ offset + i ] ^= p[ i ];
+                }
+
+                if( ( offset + useLength ) == 16U )
+                {
+                    gcmMultiply( ctx, ctx->buf, ctx->buf );
+                }
+
+                ctx->add_len += useLength;
+                add_len -= useLength;
+                p += useLength;
+            }
+
+            ctx->add_len += add_len;
+
+            while( add_len >= 16U )
+            {
+                for( i = 0; i < 16U; i++ )
+                {
+                    ctx->buf[ i ] ^= p[ i ];
+                }
+
+                gcmMultiply( ctx, ctx->buf, ctx->buf );
+                add_len -= 16U;
+                p += 16U;
+            }
+
+            for( i = 0; i < add_len; i++ )
+            {
+                ctx->buf[ i ] ^= p[ i ];
+            }
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_gcm_update( mbedtls_gcm_context * ctx,
+                            const unsigned char * input,
+                            size_t input_length,
+                            unsigned char * output,
+                            size_t output_size,
+                            size_t * output_length )
+    {
+        int ret = 0;
+        unsigned char ectr[ 16 ];
+        size_t offset;
+        size_t useLength;
+        const unsigned char * p = input;
+        unsigned char * outP = output;
+
+        if( output_size < input_length )
+        {
+            ret = MBEDTLS_ERR_GCM_BUFFER_TOO_SMALL;
+        }
+        else
+        {
+            *output_length = input_length;
+        }
+
+        /* The output must not overlap the input after its start. */
+        if( ( ret == 0 ) && ( input_length > 0U ) &&
+            ( output > input ) && ( ( size_t ) ( output - input ) < input_length ) )
+        {
+            ret = MBEDTLS_ERR_GCM_BAD_INPUT;
+        }
+
+        /* The data is limited to 2^39 - 256 bits. */
+        if( ( ret == 0 ) &&
+            ( ( ( ctx->len + input_length ) < ctx->len ) ||
+              ( ( ctx->len + input_length ) > 0xFFFFFFFE0ULL ) ) )
+        {
+            ret = MBEDTLS_ERR_GCM_BAD_INPUT;
+        }
+
+        if( ( ret == 0 ) && ( input_length > 0U ) )
+        {
+            if( ( ctx->len == 0U ) && ( ( ctx->add_len % 16U ) != 0U ) )
+            {
+                gcmMultiply( ctx, ctx->buf, ctx->buf );
+            }
+
+            offset = ( size_t ) ( ctx->len % 16U );
+
+            if( offset != 0U )
+            {
+                useLength = 16U - offset;
+
+                if( useLength > input_length )
+                {
+                    useLength = input_length;
+                }
+
+                /* The counter of the partial block is still current. */
+                ret = mbedtls_aes_crypt_ecb( &ctx->aes, MBEDTLS_AES_ENCRYPT, ctx->y, ectr );
+
+                if( ret == 0 )
+                {
+                    gcmMask( ctx, ectr, offset, useLength, p, outP );
+
+                    if( ( offset + useLength ) == 16U )
+                    {
+                        gcmMultiply( ctx, ctx->buf, ctx->buf );
+                    }
+
+                    ctx->len += useLength;
+                    input_length -= useLength;
+                    p += useLength;
+                    outP += useLength;
+                }
+            }
+
+            if( ret == 0 )
+            {
+                ctx->len += input_length;
+            }
+
+            while( ( ret == 0 ) && ( input_length >= 16U ) )
+            {
+                ret = gcmEncryptCounter( ctx, ectr );
+
+                if( ret == 0 )
+                {
+                    gcmMask( ctx, ectr, 0U, 16U, p, outP );
+                    gcmMultiply( ctx, ctx->buf, ctx->buf );
+                    input_length -= 16U;
+                    p += 16U;
+                    outP += 16U;
+                }
+            }
+
+            if( ( ret == 0 ) && ( input_length > 0U ) )
+            {
+                ret = gcmEncryptCounter( ctx, ectr );
+
+                if( ret == 0 )
+                {
+                    gcmMask( ctx, ectr, 0U, input_length, p, outP );
+                }
+            }
+
+            mbedtls_platform_zeroize( ectr, sizeof( ectr ) );
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_gcm_finish( mbedtls_gcm_context * ctx,
+                            unsigned char * output,
+                            size_t output_size,
+                            size_t * output_length,
+                            unsigned char * tag,
+                            size_t tag_len )
+    {
+        int ret = 0;
+        unsigned char work[ 16 ] = { 0 };
+        uint64_t bitLength = ctx->len * 8U;
+        uint64_t addBitLength = ctx->add_len * 8U;
+        size_t i;
+
+        ( void ) output;
+        ( void ) output_size;
+
+        if( ( tag_len < 4U ) || ( tag_len > 16U ) )
+        {
+            ret = MBEDTLS_ERR_GCM_BAD_INPUT;
+        }
+        else
+        {
+            *output_length = 0U;
+
+            if( ( ctx->len == 0U ) && ( ( ctx->add_len % 16U ) != 0U ) )
+            {
+                gcmMultiply( ctx, ctx->buf, ctx->buf );
+            }
+
+            if( ( ctx->len % 16U ) != 0U )
+            {
+                gcmMultiply( ctx, ctx->buf, ctx->buf );
+            }
+
+            ( void ) memcpy( tag, ctx->base_ectr, tag_len );
+
+            if( ( bitLength != 0U ) || ( addBitLength != 0U ) )
+            {
+                storeBigEndian32( ( uint32_t ) ( addBitLength >> 32 ), &work[ 0 ] );
+                storeBigEndian32( ( uint32_t ) addBitLength, &work[ 4 ] );
+                storeBigEndian32( ( uint32_t ) ( bitLength >> 32 ), &work[ 8 ] );
+                storeBigEndian32( ( uint32_t ) bitLength, &work[ 12 ] );
+
+                for( i = 0; i < 16U; i++ )
+                {
+                    ctx->buf[ i ] ^= work[ i ];
+                }
+
+                gcmMultiply( ctx, ctx->buf, ctx->buf );
+
+                for( i = 0; i < tag_len; i++ )
+                {
+                    tag[ i ] ^= ctx->buf[ i ];
+                }
+            }
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_gcm_crypt_and_tag( mbedtls_gcm_context * ctx,
+                                   int mode,
+                                   size_t length,
+                                   const unsigned char * iv,
+                                   size_t iv_len,
+                                   const unsigned char * add,
+                                   size_t add_len,
+                                   const unsigned char * input,
+                                   unsigned char * output,
+                                   size_t tag_len,
+                                   unsigned char * tag )
+    {
+        int ret;
+        size_t outputLength;
+
+        ret = gcmAccelerated( ctx, mode, length, iv, iv_len, add, add_len, input, output, tag_len, tag );
+
+        if( ret == USE_SOFTWARE )
+        {
+            ret = mbedtls_gcm_starts( ctx, mode, iv, iv_len );
+
+            if( ret == 0 )
+            {
+                ret = mbedtls_gcm_update_ad( ctx, add, add_len );
+            }
+
+            if( ret == 0 )
+            {
+                ret = mbedtls_gcm_update( ctx, input, length, output, length, &outputLength );
+            }
+
+            if( ret == 0 )
+            {
+                ret = mbedtls_gcm_finish( ctx, NULL, 0U, &outputLength, tag, tag_len );
+            }
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_gcm_auth_decrypt( mbedtls_gcm_context * ctx,
+                                  size_t length,
+                                  const unsigned char * iv,
+                                  size_t iv_len,
+                                  const unsigned char * add,
+                                  size_t add_len,
+                                  const unsigned char * tag,
+                                  size_t tag_len,
+                                  const unsigned char * input,
+                                  unsigned char * output )
+    {
+        int ret = 0;
+        unsigned char checkTag[ 16 ];
+        unsigned char difference = 0U;
+        size_t i;
+
+        if( ( tag_len < 4U ) || ( tag_len > 16U ) )
+        {
+            ret = MBEDTLS_ERR_GCM_BAD_INPUT;
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_gcm_crypt_and_tag( ctx, MBEDTLS_GCM_DECRYPT, length, iv, iv_len,
+                                             add, add_len, input, output, tag_len, checkTag );
+        }
+
+        if( ret == 0 )
+        {
+            /* Compare in constant time. */
+            for( i = 0; i < tag_len; i++ )
+            {
+                difference |= tag[ i ] ^ checkTag[ i ];
+            }
+
+            if( difference != 0U )
+            {
+                mbedtls_platform_zeroize( output, length );
+                ret = MBEDTLS_ERR_GCM_AUTH_FAILED;
+            }
+        }
+
+        mbedtls_platform_zeroize( checkTag, sizeof( checkTag ) );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void mbedtls_gcm_free( mbedtls_gcm_context * ctx )
+    {
+        if( ctx != NULL )
+        {
+            mbedtls_aes_free( &ctx->aes );
+            mbedtls_platform_zeroize( ctx, sizeof( mbedtls_gcm_context ) );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* MBEDTLS_GCM_ALT */
+
+#if defined( MBEDTLS_SHA256_ALT )
+
+/**
+ * @brief The round constants of SHA-256.
+ */
+    static const uint32_t sha256K[ 64 ] =
+    {
+        0x428A2F98U, 0x71374491U, 0xB5C0FBCFU, 0xE9B5DBA5U, 0x3956C25BU, 0x59F111F1U, 0x923F82A4U, 0xAB1C5ED5U,
+        0xD807AA98U, 0x12835B01U, 0x243185BEU, 0x550C7DC3U, 0x72BE5D74U, 0x80DEB1FEU, 0x9BDC06A7U, 0xC19BF174U,
+        0xE49B69C1U, 0xEFBE4786U, 0x0FC19DC6U, 0x240CA1CCU, 0x2DE92C6FU, 0x4A7484AAU, 0x5CB0A9DCU, 0x76F988DAU,
+        0x983E5152U, 0xA831C66DU, 0xB00327C8U, 0xBF597FC7U, 0xC6E00BF3U, 0xD5A79147U, 0x06CA6351U, 0x14292967U,
+        0x27B70A85U, 0x2E1B2138U, 0x4D2C6DFCU, 0x53380D13U, 0x650A7354U, 0x766A0ABBU, 0x81C2C92EU, 0x92722C85U,
+        0xA2BFE8A1U, 0xA81A664BU, 0xC24B8B70U, 0xC76C51A3U, 0xD192E819U, 0xD6990624U, 0xF40E3585U, 0x106AA070U,
+        0x19A4C116U, 0x1E376C08U, 0x2748774CU, 0x34B0BCB5U, 0x391C0CB3U, 0x4ED8AA4AU, 0x5B9CCA4FU, 0x682E6FF3U,
+        0x748F82EEU, 0x78A5636FU, 0x84C87814U, 0x8CC70208U, 0x90BEFFFAU, 0xA4506CEBU, 0xBEF9A3F7U, 0xC67178F2U
+    };
+
+/**
+ * @brief The initial states of SHA-256 and of SHA-224.
+ */
+    static const uint32_t sha256Iv[ 8 ] =
+    {
+        0x6A09E667U, 0xBB67AE85U, 0x3C6EF372U, 0xA54FF53AU, 0x510E527FU, 0x9B05688CU, 0x1F83D9ABU, 0x5BE0CD19U
+    };
+    static const uint32_t sha224Iv[ 8 ] =
+    {
+        0xC1059ED8U, 0x367CD507U, 0x3070DD17U, 0xF70E5939U, 0xFFC00B31U, 0x68581511U, 0x64F98FA7U, 0xBEFA4FA4U
+    };
+
+    #define SHA256_ROTR( x, n )    ( ( ( x ) >> ( n ) ) | ( ( x ) << ( 32U - ( n ) ) ) )
+
+/*-----------------------------------------------------------*/
+
+    void mbedtls_sha256_init( mbedtls_sha256_context * ctx )
+    {
+        ( void ) memset( ctx, 0, sizeof( mbedtls_sha256_context ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+    void mbedtls_sha256_free( mbedtls_sha256_context * ctx )
+    {
+        if( ctx != NULL )
+        {
+            mbedtls_platform_zeroize( ctx, sizeof( mbedtls_sha256_context ) );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void mbedtls_sha256_clone( mbedtls_sha256_context * dst,
+                               const mbedtls_sha256_context * src )
+    {
+        /* The state of the accelerator is in the context, see
+         * CryptoAccelSha256State_t. */
+        *dst = *src;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_sha256_starts( mbedtls_sha256_context * ctx,
+                               int is224 )
+    {
+        int ret = 0;
+        CryptoAccelStatus_t status;
+
+        #if defined( MBEDTLS_SHA224_C )
+            if( ( is224 != 0 ) && ( is224 != 1 ) )
+            {
+                ret = MBEDTLS_ERR_SHA256_BAD_INPUT_DATA;
+            }
+        #else
+            if( is224 != 0 )
+            {
+                ret = MBEDTLS_ERR_SHA256_BAD_INPUT_DATA;
+            }
+        #endif
+
+        if( ret == 0 )
+        {
+            ctx->total[ 0 ] = 0U;
+            ctx->total[ 1 ] = 0U;
+            ctx->is224 = is224;
+            ctx->accelerated = 0;
+            ( void ) memcpy( ctx->state, ( is224 == 0 ) ? sha256Iv : sha224Iv, sizeof( ctx->state ) );
+
+            if( is224 == 0 )
+            {
+                status = CryptoAccel_Sha256Start( &ctx->accel );
+
+                if( status == CRYPTO_ACCEL_SUCCESS )
+                {
+                    ctx->accelerated = 1;
+                }
+                else if( status != CRYPTO_ACCEL_UNSUPPORTED )
+                {
+                    ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+                }
+                else
+                {
+                    /* Hashed in software. */
+                }
+            }
+            else
+            {
+                CryptoAccel_CountSoftware( CRYPTO_ACCEL_ALGORITHM_SHA256 );
+            }
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_internal_sha256_process( mbedtls_sha256_context * ctx,
+                                         const unsigned char data[ 64 ] )
+    {
+        uint32_t w[ 64 ];
+        uint32_t a[ 8 ];
+        uint32_t s0;
+        uint32_t s1;
+        uint32_t t1;
+        uint32_t t2;
+        size_t i;
+
+        for( i = 0; i < 16U; i++ )
+        {
+            w[ i ] = loadBigEndian32( &data[ 4U * i ] );
+        }
+
+        for( i = 16; i < 64U; i++ )
+        {
+            s0 = SHA256_ROTR( w[ i - 15U ], 7U ) ^ SHA256_ROTR( w[ i - 15U ], 18U ) ^ ( w[ i - 15U ] >> 3 );
+            s1 = SHA256_ROTR( w[ i - 2U ], 17U ) ^ SHA256_ROTR( w[ i - 2U ], 19U ) ^ ( w[ i - 2U ] >> 10 );
+            w[ i ] = w[ i - 16U ] + s0 + w[ i - 7U ] + s1;
+        }
+
+        ( void ) memcpy( a, ctx->state, sizeof( a ) );
+
+        for( i = 0; i < 64U; i++ )
+        {
+            s1 = SHA256_ROTR( a[ 4 ], 6U ) ^ SHA256_ROTR( a[ 4 ], 11U ) ^ SHA256_ROTR( a[ 4 ], 25U );
+            t1 = a[ 7 ] + s1 + ( ( a[ 4 ] & a[ 5 ] ) ^ ( ~a[ 4 ] & a[ 6 ] ) ) + sha256K[ i ] + w[ i ];
+            s0 = SHA256_ROTR( a[ 0 ], 2U ) ^ SHA256_ROTR( a[ 0 ], 13U ) ^ SHA256_ROTR( a[ 0 ], 22U );
+            t2 = s0 + ( ( a[ 0 ] & a[ 1 ] ) ^ ( a[ 0 ] & a[ 2 ] ) ^ ( a[ 1 ] & a[ 2 ] ) );
+            a[ 7 ] = a[ 6 ];
+            a[ 6 ] = a[ 5 ];
+            a[ 5 ] = a[ 4 ];
+            a[ 4 ] = a[ 3 ] + t1;
+            a[ 3 ] = a[ 2 ];
+            a[ 2 ] = a[ 1 ];
+            a[ 1 ] = a[ 0 ];
+            a[ 0 ] = t1 + t2;
+        }
+
+        for( i = 0; i < 8U; i++ )
+        {
+            ctx->state[ i ] += a[ i ];
+        }
+
+        mbedtls_platform_zeroize( w, sizeof( w ) );
+        mbedtls_platform_zeroize( a, sizeof( a ) );
+
+        return 0;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_sha256_update( mbedtls_sha256_context * ctx,
+                               const unsigned char * input,
+                               size_t ilen )
+    {
+        int ret = 0;
+        size_t fill;
+        uint32_t left;
+
+        if( ctx->accelerated != 0 )
+        {
+            if( CryptoAccel_Sha256Update( &ctx->accel, input, ilen ) != CRYPTO_ACCEL_SUCCESS )
+            {
+                ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+            }
+        }
+        else if( ilen > 0U )
+        {
+            left = ctx->total[ 0 ] & 0x3FU;
+            fill = 64U - left;
+
+            ctx->total[ 0 ] += ( uint32_t ) ilen;
+
+            if( ctx->total[ 0 ] < ( uint32_t ) ilen )
+            {
+                ctx->total[ 1 ]++;
+            }
+
+            ctx->total[ 1 ] += ( uint32_t ) ( ( uint64_t ) ilen >> 32 );
+
+            if( ( left != 0U ) && ( ilen >= fill ) )
+            {
+                ( void ) memcpy( &ctx->buffer[ left ], input, fill );
+                ( void ) mbedtls_internal_sha256_process( ctx, ctx->buffer );
+                input += fill;
+                ilen -= fill;
+                left = 0U;
+            }
+
+            while( ilen >= 64U )
+            {
+                ( void ) mbedtls_internal_sha256_process( ctx, input );
+                input += 64U;
+                ilen -= 64U;
+            }
+
+            if( ilen > 0U )
+            {
+                ( void ) memcpy( &ctx->buffer[ left ], input, ilen );
+            }
+        }
+        else
+        {
+            /* Nothing to hash. */
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_sha256_finish( mbedtls_sha256_context * ctx,
+                               unsigned char * output )
+    {
+        int ret = 0;
+        uint32_t used;
+        uint32_t high;
+        uint32_t low;
+        size_t i;
+
+        if( ctx->accelerated != 0 )
+        {
+            if( CryptoAccel_Sha256Finish( &ctx->accel, output ) != CRYPTO_ACCEL_SUCCESS )
+            {
+                ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+            }
+
+            ctx->accelerated = 0;
+        }
+        else
+        {
+            used = ctx->total[ 0 ] & 0x3FU;
+            ctx->buffer[ used++ ] = 0x80U;
+
+            if( used > 56U )
+            {
+                ( void ) memset( &ctx->buffer[ used ], 0, 64U - used );
+                ( void ) mbedtls_internal_sha256_process( ctx, ctx->buffer );
+                used = 0U;
+            }
+
+            ( void ) memset( &ctx->buffer[ used ], 0, 56U - used );
+
+            high = ( ctx->total[ 0 ] >> 29 ) | ( ctx->total[ 1 ] << 3 );
+            low = ctx->total[ 0 ] << 3;
+            storeBigEndian32( high, &ctx->buffer[ 56 ] );
+            storeBigEndian32( low, &ctx->buffer[ 60 ] );
+            ( void ) mbedtls_internal_sha256_process( ctx, ctx->buffer );
+
+            for( i = 0; i < ( ( ctx->is224 != 0 ) ? 7U : 8U ); i++ )
+            {
+                storeBigEndian32( ctx->state[ i ], &output[ 4U * i ] );
+            }
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* MBEDTLS_SHA256_ALT */
+
+#if defined( MBEDTLS_ECDSA_SIGN_ALT ) || defined( MBEDTLS_ECDSA_VERIFY_ALT ) || defined( MBEDTLS_ECDH_COMPUTE_SHARED_ALT )
+
+/**
+ * @brief The number of nonces drawn before a signature fails.
+ */
+    #define ECDSA_MAX_TRIES    10
+
+/**
+ * @brief Write the coordinates of a P-256 point as X || Y.
+ */
+    static int writeP256Point( const mbedtls_ecp_point * pPoint,
+                               uint8_t * pOutput );
+
+/*-----------------------------------------------------------*/
+
+    static int writeP256Point( const mbedtls_ecp_point * pPoint,
+                               uint8_t * pOutput )
+    {
+        int ret;
+
+        ret = mbedtls_mpi_write_binary( &pPoint->X, pOutput, CRYPTO_ACCEL_P256_LENGTH );
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_write_binary( &pPoint->Y, &pOutput[ CRYPTO_ACCEL_P256_LENGTH ], CRYPTO_ACCEL_P256_LENGTH );
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if defined( MBEDTLS_ECDSA_SIGN_ALT ) || defined( MBEDTLS_ECDSA_VERIFY_ALT ) || defined( MBEDTLS_ECDH_COMPUTE_SHARED_ALT ) */
+
+#if defined( MBEDTLS_ECDSA_SIGN_ALT ) || defined( MBEDTLS_ECDSA_VERIFY_ALT )
+
+/**
+ * @brief Convert a hash to an integer modulo the order of the curve, as
+ * ECDSA does.
+ */
+    static int hashToMpi( const mbedtls_ecp_group * grp,
+                          mbedtls_mpi * x,
+                          const unsigned char * buf,
+                          size_t blen );
+
+/*-----------------------------------------------------------*/
+
+    static int hashToMpi( const mbedtls_ecp_group * grp,
+                          mbedtls_mpi * x,
+                          const unsigned char * buf,
+                          size_t blen )
+    {
+        int ret;
+        size_t orderLength = ( grp->nbits + 7U ) / 8U;
+        size_t useLength = ( blen > orderLength ) ? orderLength : blen;
+
+        ret = mbedtls_mpi_read_binary( x, buf, useLength );
+
+        if( ( ret == 0 ) && ( ( useLength * 8U ) > grp->nbits ) )
+        {
+            ret = mbedtls_mpi_shift_r( x, ( useLength * 8U ) - grp->nbits );
+        }
+
+        if( ( ret == 0 ) && ( mbedtls_mpi_cmp_mpi( x, &grp->N ) >= 0 ) )
+        {
+            ret = mbedtls_mpi_sub_mpi( x, x, &grp->N );
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if defined( MBEDTLS_ECDSA_SIGN_ALT ) || defined( MBEDTLS_ECDSA_VERIFY_ALT ) */
+
+#if defined( MBEDTLS_ECDSA_SIGN_ALT )
+
+/**
+ * @brief Sign with a nonce in software.
+ *
+ * @return 0 on success, USE_SOFTWARE if the nonce gave a zero r or s, or an
+ * mbedTLS error.
+ */
+    static int ecdsaSignSoftware( mbedtls_ecp_group * grp,
+                                  mbedtls_mpi * r,
+                                  mbedtls_mpi * s,
+                                  const mbedtls_mpi * d,
+                                  const mbedtls_mpi * e,
+                                  const mbedtls_mpi * k,
+                                  int ( * f_rng )( void *, unsigned char *, size_t ),
+                                  void * p_rng );
+
+/**
+ * @brief Sign a P-256 hash with a nonce on the accelerator.
+ *
+ * @return 0 on success, USE_SOFTWARE if the signature must be done in
+ * software, or an mbedTLS error.
+ */
+    static int ecdsaSignAccelerated( mbedtls_mpi * r,
+                                     mbedtls_mpi * s,
+                                     const mbedtls_mpi * d,
+                                     const mbedtls_mpi * e,
+                                     const mbedtls_mpi * k );
+
+/*-----------------------------------------------------------*/
+
+    static int ecdsaSignSoftware( mbedtls_ecp_group * grp,
+                                  mbedtls_mpi * r,
+                                  mbedtls_mpi * s,
+                                  const mbedtls_mpi * d,
+                                  const mbedtls_mpi * e,
+                                  const mbedtls_mpi * k,
+                                  int ( * f_rng )( void *, unsigned char *, size_t ),
+                                  void * p_rng )
+    {
+        int ret;
+        mbedtls_ecp_point R;
+        mbedtls_mpi t;
+        mbedtls_mpi blindedK;
+
+        mbedtls_ecp_point_init( &R );
+        mbedtls_mpi_init( &t );
+        mbedtls_mpi_init( &blindedK );
+
+        ret = mbedtls_ecp_mul( grp, &R, k, &grp->G, f_rng, p_rng );
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mod_mpi( r, &R.X, &grp->N );
+        }
+
+        if( ( ret == 0 ) && ( mbedtls_mpi_cmp_int( r, 0 ) == 0 ) )
+        {
+            ret = USE_SOFTWARE;
+        }
+
+        /* s = ( e + r * d ) / k, blinded by a random t so that the
+         * inversion does not handle k itself. */
+        if( ret == 0 )
+        {
+            ret = mbedtls_ecp_gen_privkey( grp, &t, f_rng, p_rng );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mul_mpi( s, r, d );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_add_mpi( s, s, e );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mul_mpi( s, s, &t );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mul_mpi( &blindedK, k, &t );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mod_mpi( &blindedK, &blindedK, &grp->N );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_inv_mod( &blindedK, &blindedK, &grp->N );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mul_mpi( s, s, &blindedK );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mod_mpi( s, s, &grp->N );
+        }
+
+        if( ( ret == 0 ) && ( mbedtls_mpi_cmp_int( s, 0 ) == 0 ) )
+        {
+            ret = USE_SOFTWARE;
+        }
+
+        mbedtls_ecp_point_free( &R );
+        mbedtls_mpi_free( &t );
+        mbedtls_mpi_free( &blindedK );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int ecdsaSignAccelerated( mbedtls_mpi * r,
+                                     mbedtls_mpi * s,
+                                     const mbedtls_mpi * d,
+                                     const mbedtls_mpi * e,
+                                     const mbedtls_mpi * k )
+    {
+        int ret;
+        CryptoAccelStatus_t status = CRYPTO_ACCEL_UNSUPPORTED;
+        uint8_t privateKey[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t hash[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t nonce[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t signature[ 2U * CRYPTO_ACCEL_P256_LENGTH ];
+
+        ret = mbedtls_mpi_write_binary( d, privateKey, sizeof( privateKey ) );
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_write_binary( e, hash, sizeof( hash ) );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_write_binary( k, nonce, sizeof( nonce ) );
+        }
+
+        if( ret == 0 )
+        {
+            status = CryptoAccel_EcdsaSign( privateKey, hash, nonce, signature );
+
+            if( status == CRYPTO_ACCEL_SUCCESS )
+            {
+                ret = mbedtls_mpi_read_binary( r, signature, CRYPTO_ACCEL_P256_LENGTH );
+
+                if( ret == 0 )
+                {
+                    ret = mbedtls_mpi_read_binary( s, &signature[ CRYPTO_ACCEL_P256_LENGTH ], CRYPTO_ACCEL_P256_LENGTH );
+                }
+            }
+            else if( status == CRYPTO_ACCEL_UNSUPPORTED )
+            {
+                ret = USE_SOFTWARE;
+            }
+            else
+            {
+                ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+            }
+        }
+
+        mbedtls_platform_zeroize( privateKey, sizeof( privateKey ) );
+        mbedtls_platform_zeroize( nonce, sizeof( nonce ) );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_ecdsa_sign( mbedtls_ecp_group * grp,
+                            mbedtls_mpi * r,
+                            mbedtls_mpi * s,
+                            const mbedtls_mpi * d,
+                            const unsigned char * buf,
+                            size_t blen,
+                            int ( * f_rng )( void *, unsigned char *, size_t ),
+                            void * p_rng )
+    {
+        int ret = 0;
+        int tries;
+        int isP256 = ( grp->id == MBEDTLS_ECP_DP_SECP256R1 ) ? 1 : 0;
+        mbedtls_mpi e;
+        mbedtls_mpi k;
+
+        if( ( mbedtls_ecdsa_can_do( grp->id ) == 0 ) || ( grp->N.p == NULL ) )
+        {
+            ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        }
+        else if( ( mbedtls_mpi_cmp_int( d, 1 ) < 0 ) || ( mbedtls_mpi_cmp_mpi( d, &grp->N ) >= 0 ) )
+        {
+            ret = MBEDTLS_ERR_ECP_INVALID_KEY;
+        }
+        else if( f_rng == NULL )
+        {
+            ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        }
+        else
+        {
+            /* Valid input. */
+        }
+
+        mbedtls_mpi_init( &e );
+        mbedtls_mpi_init( &k );
+
+        if( ret == 0 )
+        {
+            ret = hashToMpi( grp, &e, buf, blen );
+        }
+
+        if( ( ret == 0 ) && ( isP256 == 0 ) )
+        {
+            CryptoAccel_CountSoftware( CRYPTO_ACCEL_ALGORITHM_ECC );
+        }
+
+        /* With MBEDTLS_ECDSA_DETERMINISTIC, f_rng gives the nonces of
+         * RFC 6979, so it is drawn from once for each nonce before anything
+         * else. */
+        for( tries = 0; ( ret == 0 ) && ( tries < ECDSA_MAX_TRIES ); tries++ )
+        {
+            ret = mbedtls_ecp_gen_privkey( grp, &k, f_rng, p_rng );
+
+            if( ( ret == 0 ) && ( isP256 != 0 ) )
+            {
+                ret = ecdsaSignAccelerated( r, s, d, &e, &k );
+
+                if( ret == USE_SOFTWARE )
+                {
+                    isP256 = 0;
+                    ret = ecdsaSignSoftware( grp, r, s, d, &e, &k, f_rng, p_rng );
+                }
+            }
+            else if( ret == 0 )
+            {
+                ret = ecdsaSignSoftware( grp, r, s, d, &e, &k, f_rng, p_rng );
+            }
+            else
+            {
+                /* The nonce could not be drawn. */
+            }
+
+            if( ret == 0 )
+            {
+                break;
+            }
+
+            if( ret == USE_SOFTWARE )
+            {
+                /* The nonce gave a zero r or s. */
+                ret = 0;
+            }
+        }
+
+        if( ( ret == 0 ) && ( tries == ECDSA_MAX_TRIES ) )
+        {
+            ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+        }
+
+        mbedtls_mpi_free( &e );
+        mbedtls_mpi_free( &k );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* MBEDTLS_ECDSA_SIGN_ALT */
+
+#if defined( MBEDTLS_ECDSA_VERIFY_ALT )
+
+/**
+ * @brief Verify a signature in software.
+ */
+    static int ecdsaVerifySoftware( mbedtls_ecp_group * grp,
+                                    const mbedtls_mpi * e,
+                                    const mbedtls_ecp_point * Q,
+                                    const mbedtls_mpi * r,
+                                    const mbedtls_mpi * s );
+
+/**
+ * @brief Verify a P-256 signature on the accelerator.
+ *
+ * @return 0 if the signature is valid, USE_SOFTWARE if it must be verified
+ * in software, or an mbedTLS error.
+ */
+    static int ecdsaVerifyAccelerated( const mbedtls_mpi * e,
+                                       const mbedtls_ecp_point * Q,
+                                       const mbedtls_mpi * r,
+                                       const mbedtls_mpi * s );
+
+/*-----------------------------------------------------------*/
+
+    static int ecdsaVerifySoftware( mbedtls_ecp_group * grp,
+                                    const mbedtls_mpi * e,
+                                    const mbedtls_ecp_point * Q,
+                                    const mbedtls_mpi * r,
+                                    const mbedtls_mpi * s )
+    {
+        int ret;
+        mbedtls_mpi sInverse;
+        mbedtls_mpi u1;
+        mbedtls_mpi u2;
+        mbedtls_ecp_point R;
+
+        mbedtls_mpi_init( &sInverse );
+        mbedtls_mpi_init( &u1 );
+        mbedtls_mpi_init( &u2 );
+        mbedtls_ecp_point_init( &R );
+
+        /* R = ( e / s ) * G + ( r / s ) * Q */
+        ret = mbedtls_mpi_inv_mod( &sInverse, s, &grp->N );
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mul_mpi( &u1, e, &sInverse );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mod_mpi( &u1, &u1, &grp->N );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mul_mpi( &u2, r, &sInverse );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mod_mpi( &u2, &u2, &grp->N );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_ecp_muladd( grp, &R, &u1, &grp->G, &u2, Q );
+        }
+
+        if( ( ret == 0 ) && ( mbedtls_ecp_is_zero( &R ) != 0 ) )
+        {
+            ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_mod_mpi( &R.X, &R.X, &grp->N );
+        }
+
+        if( ( ret == 0 ) && ( mbedtls_mpi_cmp_mpi( &R.X, r ) != 0 ) )
+        {
+            ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+
+        mbedtls_mpi_free( &sInverse );
+        mbedtls_mpi_free( &u1 );
+        mbedtls_mpi_free( &u2 );
+        mbedtls_ecp_point_free( &R );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int ecdsaVerifyAccelerated( const mbedtls_mpi * e,
+                                       const mbedtls_ecp_point * Q,
+                                       const mbedtls_mpi * r,
+                                       const mbedtls_mpi * s )
+    {
+        int ret;
+        CryptoAccelStatus_t status;
+        uint8_t publicKey[ 2U * CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t hash[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t signature[ 2U * CRYPTO_ACCEL_P256_LENGTH ];
+
+        ret = writeP256Point( Q, publicKey );
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_write_binary( e, hash, sizeof( hash ) );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_write_binary( r, signature, CRYPTO_ACCEL_P256_LENGTH );
+        }
+
+        if( ret == 0 )
+        {
+            ret = mbedtls_mpi_write_binary( s, &signature[ CRYPTO_ACCEL_P256_LENGTH ], CRYPTO_ACCEL_P256_LENGTH );
+        }
+
+        if( ret == 0 )
+        {
+            status = CryptoAccel_EcdsaVerify( publicKey, hash, signature );
+
+            if( status == CRYPTO_ACCEL_UNSUPPORTED )
+            {
+                ret = USE_SOFTWARE;
+            }
+            else if( status == CRYPTO_ACCEL_VERIFY_FAILED )
+            {
+                ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+            }
+            else if( status != CRYPTO_ACCEL_SUCCESS )
+            {
+                ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+            }
+            else
+            {
+                /* The signature is valid. */
+            }
+        }
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_ecdsa_verify( mbedtls_ecp_group * grp,
+                              const unsigned char * buf,
+                              size_t blen,
+                              const mbedtls_ecp_point * Q,
+                              const mbedtls_mpi * r,
+                              const mbedtls_mpi * s )
+    {
+        int ret = 0;
+        mbedtls_mpi e;
+
+        mbedtls_mpi_init( &e );
+
+        if( ( mbedtls_ecdsa_can_do( grp->id ) == 0 ) || ( grp->N.p == NULL ) )
+        {
+            ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        }
+        else if( ( mbedtls_mpi_cmp_int( r, 1 ) < 0 ) || ( mbedtls_mpi_cmp_mpi( r, &grp->N ) >= 0 ) ||
+                 ( mbedtls_mpi_cmp_int( s, 1 ) < 0 ) || ( mbedtls_mpi_cmp_mpi( s, &grp->N ) >= 0 ) )
+        {
+            ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+        }
+        else
+        {
+            ret = hashToMpi( grp, &e, buf, blen );
+        }
+
+        if( ( ret == 0 ) && ( grp->id == MBEDTLS_ECP_DP_SECP256R1 ) )
+        {
+            ret = mbedtls_ecp_check_pubkey( grp, Q );
+
+            if( ret == 0 )
+            {
+                ret = ecdsaVerifyAccelerated( &e, Q, r, s );
+            }
+
+            if( ret == USE_SOFTWARE )
+            {
+                ret = ecdsaVerifySoftware( grp, &e, Q, r, s );
+            }
+        }
+        else if( ret == 0 )
+        {
+            CryptoAccel_CountSoftware( CRYPTO_ACCEL_ALGORITHM_ECC );
+            ret = ecdsaVerifySoftware( grp, &e, Q, r, s );
+        }
+        else
+        {
+            /* The signature is not valid. */
+        }
+
+        mbedtls_mpi_free( &e );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* MBEDTLS_ECDSA_VERIFY_ALT */
+
+#if defined( MBEDTLS_ECDH_COMPUTE_SHARED_ALT )
+
+/**
+ * @brief Compute a P-256 shared secret on the accelerator.
+ *
+ * @return 0 on success, USE_SOFTWARE if it must be computed in software, or
+ * an mbedTLS error.
+ */
+    static int ecdhAccelerated( mbedtls_mpi * z,
+                                const mbedtls_ecp_point * Q,
+                                const mbedtls_mpi * d );
+
+/*-----------------------------------------------------------*/
+
+    static int ecdhAccelerated( mbedtls_mpi * z,
+                                const mbedtls_ecp_point * Q,
+                                const mbedtls_mpi * d )
+    {
+        int ret;
+        CryptoAccelStatus_t status;
+        uint8_t privateKey[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t peerPublicKey[ 2U * CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t sharedSecret[ CRYPTO_ACCEL_P256_LENGTH ];
+
+        ret = mbedtls_mpi_write_binary( d, privateKey, sizeof( privateKey ) );
+
+        if( ret == 0 )
+        {
+            ret = writeP256Point( Q, peerPublicKey );
+        }
+
+        if( ret == 0 )
+        {
+            status = CryptoAccel_Ecdh( privateKey, peerPublicKey, sharedSecret );
+
+            if( status == CRYPTO_ACCEL_SUCCESS )
+            {
+                ret = mbedtls_mpi_read_binary( z, sharedSecret, sizeof( sharedSecret ) );
+            }
+            else if( status == CRYPTO_ACCEL_UNSUPPORTED )
+            {
+                ret = USE_SOFTWARE;
+            }
+            else
+            {
+                ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+            }
+        }
+
+        mbedtls_platform_zeroize( privateKey, sizeof( privateKey ) );
+        mbedtls_platform_zeroize( sharedSecret, sizeof( sharedSecret ) );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+    int mbedtls_ecdh_compute_shared( mbedtls_ecp_group * grp,
+                                     mbedtls_mpi * z,
+                                     const mbedtls_ecp_point * Q,
+                                     const mbedtls_mpi * d,
+                                     int ( * f_rng )( void *, unsigned char *, size_t ),
+                                     void * p_rng )
+    {
+        int ret = USE_SOFTWARE;
+        mbedtls_ecp_point P;
+
+        mbedtls_ecp_point_init( &P );
+
+        if( grp->id == MBEDTLS_ECP_DP_SECP256R1 )
+        {
+            ret = mbedtls_ecp_check_pubkey( grp, Q );
+
+            if( ret == 0 )
+            {
+                ret = mbedtls_ecp_check_privkey( grp, d );
+            }
+
+            if( ret == 0 )
+            {
+                ret = ecdhAccelerated( z, Q, d );
+            }
+        }
+        else
+        {
+            CryptoAccel_CountSoftware( CRYPTO_ACCEL_ALGORITHM_ECC );
+        }
+
+        if( ret == USE_SOFTWARE )
+        {
+            /* mbedtls_ecp_mul() checks the keys. */
+            ret = mbedtls_ecp_mul( grp, &P, d, Q, f_rng, p_rng );
+
+            if( ( ret == 0 ) && ( mbedtls_ecp_is_zero( &P ) != 0 ) )
+            {
+                ret = MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+            }
+
+            if( ret == 0 )
+            {
+                ret = mbedtls_mpi_copy( z, &P.X );
+            }
+        }
+
+        mbedtls_ecp_point_free( &P );
+
+        return ret;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* MBEDTLS_ECDH_COMPUTE_SHARED_ALT */
+
+#if defined( MBEDTLS_GCM_C ) && defined( MBEDTLS_SHA256_C )
+
+/**
+ * @brief The offset of the records in the unaligned pass of the benchmark,
+ * which is that of the payload of a TLS 1.2 record after its header and
+ * explicit nonce.
+ */
+    #define BENCHMARK_UNALIGNED_OFFSET    13U
+
+/**
+ * @brief The length of the additional data of a record, which is that of
+ * TLS 1.2.
+ */
+    #define BENCHMARK_AAD_LENGTH          13U
+
+/**
+ * @brief The times of one pass of the benchmark, in milliseconds.
+ */
+    typedef struct BenchmarkTimes
+    {
+        uint32_t gcmMs;
+        uint32_t sha256Ms;
+    } BenchmarkTimes_t;
+
+/**
+ * @brief Run one pass of the benchmark on records starting at @p pData.
+ *
+ * @return #CRYPTO_ACCEL_SUCCESS, #CRYPTO_ACCEL_VERIFY_FAILED if a record did
+ * not decrypt to its plaintext, or #CRYPTO_ACCEL_HW_ERROR.
+ */
+    static CryptoAccelStatus_t benchmarkPass( uint8_t * pData,
+                                              size_t recordLength,
+                                              size_t recordCount,
+                                              uint8_t * pTags,
+                                              uint8_t * pDigest,
+                                              BenchmarkTimes_t * pTimes );
+
+/**
+ * @brief Convert a number of bytes processed in a time to kilobytes per
+ * second.
+ */
+    static uint32_t benchmarkRate( uint64_t bytes,
+                                   uint32_t milliseconds );
+
+/*-----------------------------------------------------------*/
+
+    static CryptoAccelStatus_t benchmarkPass( uint8_t * pData,
+                                              size_t recordLength,
+                                              size_t recordCount,
+                                              uint8_t * pTags,
+                                              uint8_t * pDigest,
+                                              BenchmarkTimes_t * pTimes )
+    {
+        static const unsigned char key[ 16 ] =
+        {
+            0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
+        };
+        CryptoAccelStatus_t status = CRYPTO_ACCEL_SUCCESS;
+        mbedtls_gcm_context gcm;
+        mbedtls_sha256_context sha256;
+        unsigned char iv[ 12 ] = { 0 };
+        unsigned char aad[ BENCHMARK_AAD_LENGTH ] = { 0 };
+        size_t i;
+        size_t record;
+        TickType_t start;
+        uint8_t * pRecord;
+
+        for( i = 0; i < ( recordLength * recordCount ); i++ )
+        {
+            pData[ i ] = ( uint8_t ) ( ( i * 31U ) + 7U );
+        }
+
+        mbedtls_gcm_init( &gcm );
+        mbedtls_sha256_init( &sha256 );
+
+        if( mbedtls_gcm_setkey( &gcm, MBEDTLS_CIPHER_ID_AES, key, 128U ) != 0 )
+        {
+            status = CRYPTO_ACCEL_HW_ERROR;
+        }
+
+        start = xTaskGetTickCount();
+
+        for( record = 0; ( status == CRYPTO_ACCEL_SUCCESS ) && ( record < recordCount ); record++ )
+        {
+            storeBigEndian32( ( uint32_t ) record, &iv[ 8 ] );
+            storeBigEndian32( ( uint32_t ) record, &aad[ 4 ] );
+            pRecord = &pData[ record * recordLength ];
+
+            if( mbedtls_gcm_crypt_and_tag( &gcm, MBEDTLS_GCM_ENCRYPT, recordLength, iv, sizeof( iv ),
+                                           aad, sizeof( aad ), pRecord, pRecord,
+                                           CRYPTO_ACCEL_GCM_TAG_LENGTH,
+                                           &pTags[ record * CRYPTO_ACCEL_GCM_TAG_LENGTH ] ) != 0 )
+            {
+                status = CRYPTO_ACCEL_HW_ERROR;
+            }
+        }
+
+        for( record = recordCount; ( status == CRYPTO_ACCEL_SUCCESS ) && ( record > 0U ); record-- )
+        {
+            storeBigEndian32( ( uint32_t ) ( record - 1U ), &iv[ 8 ] );
+            storeBigEndian32( ( uint32_t ) ( record - 1U ), &aad[ 4 ] );
+            pRecord = &pData[ ( record - 1U ) * recordLength ];
+
+            if( mbedtls_gcm_auth_decrypt( &gcm, recordLength, iv, sizeof( iv ), aad, sizeof( aad ),
+                                          &pTags[ ( record - 1U ) * CRYPTO_ACCEL_GCM_TAG_LENGTH ],
+                                          CRYPTO_ACCEL_GCM_TAG_LENGTH, pRecord, pRecord ) != 0 )
+            {
+                status = CRYPTO_ACCEL_VERIFY_FAILED;
+            }
+        }
+
+        pTimes->gcmMs = ( uint32_t ) ( ( ( uint64_t ) ( xTaskGetTickCount() - start ) * 1000U ) / configTICK_RATE_HZ );
+
+        for( i = 0; ( status == CRYPTO_ACCEL_SUCCESS ) && ( i < ( recordLength * recordCount ) ); i++ )
+        {
+            if( pData[ i ] != ( uint8_t ) ( ( i * 31U ) + 7U ) )
+            {
+                status = CRYPTO_ACCEL_VERIFY_FAILED;
+            }
+        }
+
+        start = xTaskGetTickCount();
+
+        if( ( status == CRYPTO_ACCEL_SUCCESS ) && ( mbedtls_sha256_starts( &sha256, 0 ) != 0 ) )
+        {
+            status = CRYPTO_ACCEL_HW_ERROR;
+        }
+
+        for( record = 0; ( status == CRYPTO_ACCEL_SUCCESS ) && ( record < recordCount ); record++ )
+        {
+            if( mbedtls_sha256_update( &sha256, &pData[ record * recordLength ], recordLength ) != 0 )
+            {
+                status = CRYPTO_ACCEL_HW_ERROR;
+            }
+        }
+
+        if( ( status == CRYPTO_ACCEL_SUCCESS ) && ( mbedtls_sha256_finish( &sha256, pDigest ) != 0 ) )
+        {
+            status = CRYPTO_ACCEL_HW_ERROR;
+        }
+
+        pTimes->sha256Ms = ( uint32_t ) ( ( ( uint64_t ) ( xTaskGetTickCount() - start ) * 1000U ) / configTICK_RATE_HZ );
+
+        mbedtls_gcm_free( &gcm );
+        mbedtls_sha256_free( &sha256 );
+
+        return status;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static uint32_t benchmarkRate( uint64_t bytes,
+                                   uint32_t milliseconds )
+    {
+        /* A byte per millisecond is a kilobyte per second. */
+        return ( uint32_t ) ( bytes / ( ( milliseconds == 0U ) ? 1U : milliseconds ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+    CryptoAccelStatus_t CryptoAccel_Benchmark( size_t recordLength,
+                                               size_t recordCount,
+                                               CryptoAccelBenchmark_t * pResult )
+    {
+        CryptoAccelStatus_t status = CRYPTO_ACCEL_SUCCESS;
+        const CryptoAccelOps_t * pOps;
+        uint8_t * pBuffer;
+        uint8_t * pAligned;
+        uint8_t * pTags;
+        uint8_t softwareDigest[ 32 ];
+        uint8_t digest[ 32 ];
+        BenchmarkTimes_t times;
+        size_t dataLength = recordLength * recordCount;
+        size_t tagsLength = recordCount * CRYPTO_ACCEL_GCM_TAG_LENGTH;
+        uint64_t gcmBytes = 2U * ( uint64_t ) dataLength;
+
+        /* The records, room to align them and to shift them by the offset,
+         * and the tags of software and of the accelerator. */
+        pBuffer = ( uint8_t * ) pvPortMalloc( dataLength + CRYPTO_ACCEL_DMA_ALIGNMENT + BENCHMARK_UNALIGNED_OFFSET +
+                                              ( 2U * tagsLength ) );
+
+        if( pBuffer == NULL )
+        {
+            status = CRYPTO_ACCEL_HW_ERROR;
+        }
+        else
+        {
+            pAligned = ( uint8_t * ) ( ( ( uintptr_t ) pBuffer + CRYPTO_ACCEL_DMA_ALIGNMENT - 1U ) &
+                                       ~( ( uintptr_t ) CRYPTO_ACCEL_DMA_ALIGNMENT - 1U ) );
+            pTags = &pAligned[ dataLength + BENCHMARK_UNALIGNED_OFFSET ];
+
+            ( void ) memset( pResult, 0, sizeof( CryptoAccelBenchmark_t ) );
+
+            /* Software, with the accelerator out of the way. */
+            pOps = CryptoAccel_SetOps( NULL );
+            status = benchmarkPass( pAligned, recordLength, recordCount, pTags, softwareDigest, &times );
+            ( void ) CryptoAccel_SetOps( pOps );
+            pResult->gcmSoftware = benchmarkRate( gcmBytes, times.gcmMs );
+            pResult->sha256Software = benchmarkRate( dataLength, times.sha256Ms );
+
+            if( status == CRYPTO_ACCEL_SUCCESS )
+            {
+                status = benchmarkPass( pAligned, recordLength, recordCount, &pTags[ tagsLength ], digest, &times );
+                pResult->gcmAligned = benchmarkRate( gcmBytes, times.gcmMs );
+                pResult->sha256Accelerated = benchmarkRate( dataLength, times.sha256Ms );
+            }
+
+            if( ( status == CRYPTO_ACCEL_SUCCESS ) &&
+                ( ( memcmp( pTags, &pTags[ tagsLength ], tagsLength ) != 0 ) ||
+                  ( memcmp( softwareDigest, digest, sizeof( digest ) ) != 0 ) ) )
+            {
+                status = CRYPTO_ACCEL_VERIFY_FAILED;
+            }
+
+            if( status == CRYPTO_ACCEL_SUCCESS )
+            {
+                status = benchmarkPass( &pAligned[ BENCHMARK_UNALIGNED_OFFSET ], recordLength, recordCount,
+                                        &pTags[ tagsLength ], digest, &times );
+                pResult->gcmUnaligned = benchmarkRate( gcmBytes, times.gcmMs );
+            }
+
+            if( ( status == CRYPTO_ACCEL_SUCCESS ) &&
+                ( ( memcmp( pTags, &pTags[ tagsLength ], tagsLength ) != 0 ) ||
+                  ( memcmp( softwareDigest, digest, sizeof( digest ) ) != 0 ) ) )
+            {
+                status = CRYPTO_ACCEL_VERIFY_FAILED;
+            }
+
+            vPortFree( pBuffer );
+        }
+
+        return status;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* defined( MBEDTLS_GCM_C ) && defined( MBEDTLS_SHA256_C ) */
@@ -0,0 +1,489 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file crypto_accel_wolfssl.c
+ * @brief The wolfSSL crypto callback device which uses the crypto
+ * accelerator for AES-GCM and for ECC P-256.
+ *
+ * The callback returns CRYPTOCB_UNAVAILABLE for every other request, and for
+ * the requests the accelerator does not accept, so that wolfSSL does them in
+ * software.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* WolfSSL includes. */
+#include "user_settings.h"
+#include "wolfssl/wolfcrypt/settings.h"
+#include "wolfssl/wolfcrypt/error-crypt.h"
+#include "wolfssl/wolfcrypt/cryptocb.h"
+#include "wolfssl/wolfcrypt/aes.h"
+#include "wolfssl/wolfcrypt/ecc.h"
+#include "wolfssl/wolfcrypt/random.h"
+
+#include "crypto_accel.h"
+
+#if !defined( WOLF_CRYPTO_CB )
+    #error "crypto_accel_wolfssl.c requires WOLF_CRYPTO_CB in user_settings.h."
+#endif
+
+/**
+ * @brief The number of nonces drawn before a signature fails.
+ */
+#define ECDSA_MAX_TRIES    10
+
+/*-----------------------------------------------------------*/
+
+#if defined( HAVE_AESGCM )
+
+/**
+ * @brief Encrypt or decrypt an AES-GCM message on the accelerator.
+ */
+    static int gcmCallback( wc_CryptoInfo * pInfo );
+
+#endif
+
+#if defined( HAVE_ECC )
+
+/**
+ * @brief Sign, verify or compute a shared secret with P-256 keys on the
+ * accelerator.
+ */
+    static int eccCallback( wc_CryptoInfo * pInfo );
+
+/**
+ * @brief Export the public key of a P-256 key as X || Y.
+ */
+    static int exportP256PublicKey( ecc_key * pKey,
+                                    uint8_t * pOutput );
+
+/**
+ * @brief Export the private key of a P-256 key.
+ */
+    static int exportP256PrivateKey( ecc_key * pKey,
+                                     uint8_t * pOutput );
+
+/**
+ * @brief Copy a big-endian integer of at most 32 bytes into a 32-byte field,
+ * padding it on the left.
+ */
+    static int padP256Integer( const uint8_t * pInteger,
+                               word32 length,
+                               uint8_t * pOutput );
+
+#endif
+
+/**
+ * @brief The crypto callback of the device.
+ */
+static int cryptoCallback( int devId,
+                           wc_CryptoInfo * pInfo,
+                           void * pContext );
+
+/**
+ * @brief Convert the result of an accelerator operation to a wolfSSL result.
+ */
+static int toWolfSSLResult( CryptoAccelStatus_t status );
+
+/*-----------------------------------------------------------*/
+
+static int toWolfSSLResult( CryptoAccelStatus_t status )
+{
+    int result;
+
+    switch( status )
+    {
+        case CRYPTO_ACCEL_SUCCESS:
+            result = 0;
+            break;
+
+        case CRYPTO_ACCEL_UNSUPPORTED:
+            result = CRYPTOCB_UNAVAILABLE;
+            break;
+
+        default:
+            result = WC_HW_E;
+            break;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+#if defined( HAVE_AESGCM )
+
+    static int gcmCallback( wc_CryptoInfo * pInfo )
+    {
+        int result;
+        CryptoAccelGcmRequest_t request;
+        uint8_t tag[ CRYPTO_ACCEL_GCM_TAG_LENGTH ];
+        uint8_t difference = 0U;
+        Aes * pAes;
+        word32 i;
+
+        if( pInfo->cipher.enc != 0 )
+        {
+            pAes = pInfo->cipher.aesgcm_enc.aes;
+            request.direction = CRYPTO_ACCEL_ENCRYPT;
+            request.pIv = pInfo->cipher.aesgcm_enc.iv;
+            request.ivLength = pInfo->cipher.aesgcm_enc.ivSz;
+            request.pAad = pInfo->cipher.aesgcm_enc.authIn;
+            request.aadLength = pInfo->cipher.aesgcm_enc.authInSz;
+            request.pInput = pInfo->cipher.aesgcm_enc.in;
+            request.pOutput = pInfo->cipher.aesgcm_enc.out;
+            request.length = pInfo->cipher.aesgcm_enc.sz;
+        }
+        else
+        {
+            pAes = pInfo->cipher.aesgcm_dec.aes;
+            request.direction = CRYPTO_ACCEL_DECRYPT;
+            request.pIv = pInfo->cipher.aesgcm_dec.iv;
+            request.ivLength = pInfo->cipher.aesgcm_dec.ivSz;
+            request.pAad = pInfo->cipher.aesgcm_dec.authIn;
+            request.aadLength = pInfo->cipher.aesgcm_dec.authInSz;
+            request.pInput = pInfo->cipher.aesgcm_dec.in;
+            request.pOutput = pInfo->cipher.aesgcm_dec.out;
+            request.length = pInfo->cipher.aesgcm_dec.sz;
+        }
+
+        /* AES-GCM keys are kept in devKey for the callback. */
+        request.pKey = ( const uint8_t * ) pAes->devKey;
+        request.keyLength = pAes->keylen;
+
+        result = toWolfSSLResult( CryptoAccel_Gcm( &request, tag ) );
+
+        if( ( result == 0 ) && ( pInfo->cipher.enc != 0 ) )
+        {
+            if( pInfo->cipher.aesgcm_enc.authTagSz > CRYPTO_ACCEL_GCM_TAG_LENGTH )
+            {
+                result = BAD_FUNC_ARG;
+            }
+            else
+            {
+                ( void ) memcpy( pInfo->cipher.aesgcm_enc.authTag, tag, pInfo->cipher.aesgcm_enc.authTagSz );
+            }
+        }
+        else if( result == 0 )
+        {
+            if( pInfo->cipher.aesgcm_dec.authTagSz > CRYPTO_ACCEL_GCM_TAG_LENGTH )
+            {
+                result = BAD_FUNC_ARG;
+            }
+            else
+            {
+                /* Compare in constant time. */
+                for( i = 0; i < pInfo->cipher.aesgcm_dec.authTagSz; i++ )
+                {
+                    difference |= pInfo->cipher.aesgcm_dec.authTag[ i ] ^ tag[ i ];
+                }
+
+                if( difference != 0U )
+                {
+                    result = AES_GCM_AUTH_E;
+                }
+            }
+
+            if( result != 0 )
+            {
+                ForceZero( pInfo->cipher.aesgcm_dec.out, pInfo->cipher.aesgcm_dec.sz );
+            }
+        }
+        else
+        {
+            /* Done in software, or failed. */
+        }
+
+        ForceZero( tag, sizeof( tag ) );
+
+        return result;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* HAVE_AESGCM */
+
+#if defined( HAVE_ECC )
+
+    static int exportP256PublicKey( ecc_key * pKey,
+                                    uint8_t * pOutput )
+    {
+        word32 xLength = CRYPTO_ACCEL_P256_LENGTH;
+        word32 yLength = CRYPTO_ACCEL_P256_LENGTH;
+        int result;
+
+        result = wc_ecc_export_public_raw( pKey, pOutput, &xLength,
+                                           &pOutput[ CRYPTO_ACCEL_P256_LENGTH ], &yLength );
+
+        if( ( result == 0 ) &&
+            ( ( xLength != CRYPTO_ACCEL_P256_LENGTH ) || ( yLength != CRYPTO_ACCEL_P256_LENGTH ) ) )
+        {
+            result = ECC_BAD_ARG_E;
+        }
+
+        return result;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int exportP256PrivateKey( ecc_key * pKey,
+                                     uint8_t * pOutput )
+    {
+        word32 length = CRYPTO_ACCEL_P256_LENGTH;
+        int result;
+
+        result = wc_ecc_export_private_only( pKey, pOutput, &length );
+
+        if( ( result == 0 ) && ( length != CRYPTO_ACCEL_P256_LENGTH ) )
+        {
+            result = ECC_BAD_ARG_E;
+        }
+
+        return result;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int padP256Integer( const uint8_t * pInteger,
+                               word32 length,
+                               uint8_t * pOutput )
+    {
+        int result = 0;
+
+        if( length > CRYPTO_ACCEL_P256_LENGTH )
+        {
+            result = ASN_PARSE_E;
+        }
+        else
+        {
+            ( void ) memset( pOutput, 0, CRYPTO_ACCEL_P256_LENGTH - length );
+            ( void ) memcpy( &pOutput[ CRYPTO_ACCEL_P256_LENGTH - length ], pInteger, length );
+        }
+
+        return result;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static int eccCallback( wc_CryptoInfo * pInfo )
+    {
+        int result = CRYPTOCB_UNAVAILABLE;
+        int tries;
+        uint8_t privateKey[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t publicKey[ 2U * CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t scalar[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t nonce[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t signature[ 2U * CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t r[ CRYPTO_ACCEL_P256_LENGTH ];
+        uint8_t s[ CRYPTO_ACCEL_P256_LENGTH ];
+        word32 rLength = sizeof( r );
+        word32 sLength = sizeof( s );
+
+        switch( pInfo->pk.type )
+        {
+            case WC_PK_TYPE_ECDH:
+
+                if( ( pInfo->pk.ecdh.private_key->dp != NULL ) &&
+                    ( pInfo->pk.ecdh.private_key->dp->id == ECC_SECP256R1 ) &&
+                    ( *pInfo->pk.ecdh.outlen >= CRYPTO_ACCEL_P256_LENGTH ) )
+                {
+                    result = exportP256PrivateKey( pInfo->pk.ecdh.private_key, privateKey );
+
+                    if( result == 0 )
+                    {
+                        result = exportP256PublicKey( pInfo->pk.ecdh.public_key, publicKey );
+                    }
+
+                    if( result == 0 )
+                    {
+                        result = toWolfSSLResult( CryptoAccel_Ecdh( privateKey, publicKey, pInfo->pk.ecdh.out ) );
+                    }
+
+                    if( result == 0 )
+                    {
+                        *pInfo->pk.ecdh.outlen = CRYPTO_ACCEL_P256_LENGTH;
+                    }
+                }
+                else
+                {
+                    CryptoAccel_CountSoftware( CRYPTO_ACCEL_ALGORITHM_ECC );
+                }
+
+                break;
+
+            case WC_PK_TYPE_ECDSA_SIGN:
+
+                if( ( pInfo->pk.eccsign.key->dp != NULL ) &&
+                    ( pInfo->pk.eccsign.key->dp->id == ECC_SECP256R1 ) )
+                {
+                    result = exportP256PrivateKey( pInfo->pk.eccsign.key, privateKey );
+                    CryptoAccel_P256HashToScalar( pInfo->pk.eccsign.in, pInfo->pk.eccsign.inlen, scalar );
+
+                    for( tries = 0; ( result == 0 ) && ( tries < ECDSA_MAX_TRIES ); tries++ )
+                    {
+                        result = wc_RNG_GenerateBlock( pInfo->pk.eccsign.rng, nonce, sizeof( nonce ) );
+
+                        if( ( result == 0 ) && ( CryptoAccel_P256IsValidScalar( nonce ) == pdTRUE ) )
+                        {
+                            break;
+                        }
+                    }
+
+                    if( ( result == 0 ) && ( tries == ECDSA_MAX_TRIES ) )
+                    {
+                        result = RNG_FAILURE_E;
+                    }
+
+                    if( result == 0 )
+                    {
+                        result = toWolfSSLResult( CryptoAccel_EcdsaSign( privateKey, scalar, nonce, signature ) );
+                    }
+
+                    if( result == 0 )
+                    {
+                        result = wc_ecc_rs_raw_to_sig( signature, CRYPTO_ACCEL_P256_LENGTH,
+                                                       &signature[ CRYPTO_ACCEL_P256_LENGTH ], CRYPTO_ACCEL_P256_LENGTH,
+                                                       pInfo->pk.eccsign.out, pInfo->pk.eccsign.outlen );
+                    }
+                }
+                else
+                {
+                    CryptoAccel_CountSoftware( CRYPTO_ACCEL_ALGORITHM_ECC );
+                }
+
+                break;
+
+            case WC_PK_TYPE_ECDSA_VERIFY:
+
+                if( ( pInfo->pk.eccverify.key->dp != NULL ) &&
+                    ( pInfo->pk.eccverify.key->dp->id == ECC_SECP256R1 ) )
+                {
+                    *pInfo->pk.eccverify.res = 0;
+                    result = wc_ecc_sig_to_rs( pInfo->pk.eccverify.sig, pInfo->pk.eccverify.siglen,
+                                               r, &rLength, s, &sLength );
+
+                    if( result == 0 )
+                    {
+                        result = padP256Integer( r, rLength, signature );
+                    }
+
+                    if( result == 0 )
+                    {
+                        result = padP256Integer( s, sLength, &signature[ CRYPTO_ACCEL_P256_LENGTH ] );
+                    }
+
+                    if( result == 0 )
+                    {
+                        result = exportP256PublicKey( pInfo->pk.eccverify.key, publicKey );
+                    }
+
+                    if( result == 0 )
+                    {
+                        CryptoAccel_P256HashToScalar( pInfo->pk.eccverify.hash, pInfo->pk.eccverify.hashlen, scalar );
+
+                        switch( CryptoAccel_EcdsaVerify( publicKey, scalar, signature ) )
+                        {
+                            case CRYPTO_ACCEL_SUCCESS:
+                                *pInfo->pk.eccverify.res = 1;
+                                break;
+
+                            case CRYPTO_ACCEL_VERIFY_FAILED:
+                                /* A signature which does not verify is not an
+                                 * error of the callback. */
+                                break;
+
+                            case CRYPTO_ACCEL_UNSUPPORTED:
+                                result = CRYPTOCB_UNAVAILABLE;
+                                break;
+
+                            default:
+                                result = WC_HW_E;
+                                break;
+                        }
+                    }
+                }
+                else
+                {
+                    CryptoAccel_CountSoftware( CRYPTO_ACCEL_ALGORITHM_ECC );
+                }
+
+                break;
+
+            default:
+                /* Done in software. */
+                break;
+        }
+
+        ForceZero( privateKey, sizeof( privateKey ) );
+        ForceZero( nonce, sizeof( nonce ) );
+
+        return result;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* HAVE_ECC */
+
+static int cryptoCallback( int devId,
+                           wc_CryptoInfo * pInfo,
+                           void * pContext )
+{
+    int result = CRYPTOCB_UNAVAILABLE;
+
+    ( void ) devId;
+    ( void ) pContext;
+
+    #if defined( HAVE_AESGCM )
+        if( ( pInfo->algo_type == WC_ALGO_TYPE_CIPHER ) &&
+            ( pInfo->cipher.type == WC_CIPHER_AES_GCM ) )
+        {
+            result = gcmCallback( pInfo );
+        }
+    #endif
+
+    #if defined( HAVE_ECC )
+        if( pInfo->algo_type == WC_ALGO_TYPE_PK )
+        {
+            result = eccCallback( pInfo );
+        }
+    #endif
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+int CryptoAccel_WolfSSLRegister( void )
+{
+    return wc_CryptoCb_RegisterDevice( CRYPTO_ACCEL_WOLFSSL_DEVICE_ID, cryptoCallback, NULL );
+}
+
+/*-----------------------------------------------------------*/
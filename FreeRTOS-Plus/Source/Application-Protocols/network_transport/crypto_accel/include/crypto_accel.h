@@ -0,0 +1,512 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file crypto_accel.h
+ * @brief Hooks through which the TLS transports offload AES-GCM, SHA-256 and
+ * ECC P-256 to a hardware crypto accelerator.
+ *
+ * A port fills in a #CryptoAccelOps_t with the operations its accelerator
+ * implements and passes it to #CryptoAccel_Init.  The glue of each TLS stack
+ * calls the hooks through the CryptoAccel_ functions below, which serialize
+ * them, and does in software whatever a hook does not accept:
+ *
+ * - crypto_accel_mbedtls.c implements the mbedTLS alternatives
+ *   MBEDTLS_GCM_ALT, MBEDTLS_SHA256_ALT, MBEDTLS_ECDSA_SIGN_ALT,
+ *   MBEDTLS_ECDSA_VERIFY_ALT and MBEDTLS_ECDH_COMPUTE_SHARED_ALT.  Define
+ *   those which are wanted in the mbedTLS configuration, and add the
+ *   directory of this file to the include path so that mbedTLS finds
+ *   gcm_alt.h and sha256_alt.h.
+ * - crypto_accel_wolfssl.c registers a wolfSSL crypto callback device for
+ *   AES-GCM and ECC, which transport_wolfSSL.c selects for its contexts when
+ *   #TLS_TRANSPORT_CRYPTO_ACCEL is 1.  wolfSSL keeps hashing in software, as
+ *   the callback interface cannot keep an accelerator state per hash.
+ *
+ * A hook returns #CRYPTO_ACCEL_UNSUPPORTED for a request it cannot handle,
+ * such as a key size or a length the hardware does not support, before it
+ * touches the hardware; the request is then done in software.
+ *
+ * The buffers given to the data hooks are DMA-friendly: they start at a
+ * multiple of #CRYPTO_ACCEL_DMA_ALIGNMENT, pass #CRYPTO_ACCEL_DMA_CAPABLE,
+ * and may be read, written, cleaned and invalidated up to their length
+ * rounded up to #CRYPTO_ACCEL_GRANULE without touching other data.  Buffers
+ * of the caller which do not qualify are copied through an internal bounce
+ * buffer, whose bytes past the length are zero.  mbedTLS and wolfSSL keep
+ * the payload of a record at an odd offset, so records go through the bounce
+ * buffer; application buffers passed to the GCM functions directly can avoid
+ * the copy.
+ */
+
+#ifndef CRYPTO_ACCEL_H
+#define CRYPTO_ACCEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/**
+ * @brief The alignment, in bytes, of the buffers given to the hooks.
+ *
+ * A power of two.  The default of 32 is the data cache line of a Cortex-M7,
+ * so that a port can clean and invalidate the cache over a buffer.
+ */
+#ifndef CRYPTO_ACCEL_DMA_ALIGNMENT
+    #define CRYPTO_ACCEL_DMA_ALIGNMENT    32U
+#endif
+
+/**
+ * @brief Whether the accelerator can reach a buffer of the caller by DMA.
+ *
+ * The default only checks the alignment.  A port whose DMA cannot reach
+ * some memory, such as a core coupled RAM, defines it to also check the
+ * address range.
+ */
+#ifndef CRYPTO_ACCEL_DMA_CAPABLE
+    #define CRYPTO_ACCEL_DMA_CAPABLE( pAddress ) \
+    ( ( ( ( uintptr_t ) ( pAddress ) ) & ( ( uintptr_t ) CRYPTO_ACCEL_DMA_ALIGNMENT - 1U ) ) == 0U )
+#endif
+
+/**
+ * @brief The size, in bytes, of the bounce buffer.  A multiple of
+ * #CRYPTO_ACCEL_GRANULE.  Defaults to 1024.
+ */
+#ifndef CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE
+    #define CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE    1024U
+#endif
+
+/**
+ * @brief The most bytes given to a data hook at once.  A multiple of
+ * #CRYPTO_ACCEL_GRANULE.  Defaults to 32768.
+ */
+#ifndef CRYPTO_ACCEL_MAX_TRANSFER
+    #define CRYPTO_ACCEL_MAX_TRANSFER    32768U
+#endif
+
+/**
+ * @brief The longest additional data of an AES-GCM message given to the
+ * accelerator.  Messages with more are done in software.  TLS uses 13 bytes
+ * with TLS 1.2 and 5 bytes with TLS 1.3.  Defaults to 32.
+ */
+#ifndef CRYPTO_ACCEL_GCM_MAX_AAD_LENGTH
+    #define CRYPTO_ACCEL_GCM_MAX_AAD_LENGTH    32U
+#endif
+
+/**
+ * @brief The size, in 32-bit words, of the state a port keeps for a SHA-256
+ * hash, see #CryptoAccelSha256State_t.  Defaults to 64.
+ */
+#ifndef CRYPTO_ACCEL_SHA256_STATE_WORDS
+    #define CRYPTO_ACCEL_SHA256_STATE_WORDS    64U
+#endif
+
+/**
+ * @brief The wolfSSL device identifier of the crypto callback.
+ */
+#ifndef CRYPTO_ACCEL_WOLFSSL_DEVICE_ID
+    #define CRYPTO_ACCEL_WOLFSSL_DEVICE_ID    0x43414343
+#endif
+
+/**
+ * @brief The lengths given to the data hooks are multiples of the granule,
+ * except the last one of a message: the larger of an AES block and
+ * #CRYPTO_ACCEL_DMA_ALIGNMENT.
+ */
+#if ( CRYPTO_ACCEL_DMA_ALIGNMENT > 16U )
+    #define CRYPTO_ACCEL_GRANULE    CRYPTO_ACCEL_DMA_ALIGNMENT
+#else
+    #define CRYPTO_ACCEL_GRANULE    16U
+#endif
+
+#if ( ( CRYPTO_ACCEL_DMA_ALIGNMENT & ( CRYPTO_ACCEL_DMA_ALIGNMENT - 1U ) ) != 0U )
+    #error "CRYPTO_ACCEL_DMA_ALIGNMENT must be a power of two."
+#endif
+
+#if ( ( CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE == 0U ) || ( ( CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE % CRYPTO_ACCEL_GRANULE ) != 0U ) )
+    #error "CRYPTO_ACCEL_BOUNCE_BUFFER_SIZE must be a multiple of CRYPTO_ACCEL_GRANULE."
+#endif
+
+#if ( ( CRYPTO_ACCEL_MAX_TRANSFER == 0U ) || ( ( CRYPTO_ACCEL_MAX_TRANSFER % CRYPTO_ACCEL_GRANULE ) != 0U ) )
+    #error "CRYPTO_ACCEL_MAX_TRANSFER must be a multiple of CRYPTO_ACCEL_GRANULE."
+#endif
+
+/**
+ * @brief The length of a P-256 scalar or coordinate, in bytes.
+ */
+#define CRYPTO_ACCEL_P256_LENGTH    32U
+
+/**
+ * @brief The length of an AES-GCM tag, in bytes.
+ */
+#define CRYPTO_ACCEL_GCM_TAG_LENGTH    16U
+
+/**
+ * @brief Results of the hooks and of the CryptoAccel_ functions.
+ */
+typedef enum CryptoAccelStatus
+{
+    CRYPTO_ACCEL_SUCCESS = 0,    /**< The accelerator did the operation. */
+    CRYPTO_ACCEL_UNSUPPORTED,    /**< The accelerator cannot do the operation, which is done in software. */
+    CRYPTO_ACCEL_VERIFY_FAILED,  /**< The signature is not valid. */
+    CRYPTO_ACCEL_HW_ERROR        /**< The accelerator failed after it started the operation. */
+} CryptoAccelStatus_t;
+
+/**
+ * @brief The direction of an AES-GCM message.
+ */
+typedef enum CryptoAccelDirection
+{
+    CRYPTO_ACCEL_ENCRYPT = 0,
+    CRYPTO_ACCEL_DECRYPT
+} CryptoAccelDirection_t;
+
+/**
+ * @brief The algorithms counted in #CryptoAccelStats_t.
+ */
+typedef enum CryptoAccelAlgorithm
+{
+    CRYPTO_ACCEL_ALGORITHM_GCM = 0,
+    CRYPTO_ACCEL_ALGORITHM_SHA256,
+    CRYPTO_ACCEL_ALGORITHM_ECC
+} CryptoAccelAlgorithm_t;
+
+/**
+ * @brief An AES-GCM message.
+ *
+ * For #CryptoAccel_Gcm, pInput and pOutput are the buffers of the caller and
+ * may be the same.  For the gcmStart hook, pInput and pOutput are NULL and
+ * pAad is DMA-friendly and zero padded up to a multiple of 16 bytes.
+ */
+typedef struct CryptoAccelGcmRequest
+{
+    CryptoAccelDirection_t direction;
+    const uint8_t * pKey;   /**< The AES key. */
+    size_t keyLength;       /**< 16, 24 or 32. */
+    const uint8_t * pIv;
+    size_t ivLength;        /**< 12 with TLS. */
+    const uint8_t * pAad;   /**< The additional authenticated data. */
+    size_t aadLength;
+    const uint8_t * pInput;
+    uint8_t * pOutput;
+    size_t length;          /**< The length of the plaintext or ciphertext, in bytes. */
+} CryptoAccelGcmRequest_t;
+
+/**
+ * @brief The state of a SHA-256 hash done by the accelerator, which is
+ * private to the port.
+ *
+ * A hash is not bound to the hardware between calls: the hooks of several
+ * hashes may be called in any interleaving, and a state may be copied to
+ * clone a hash.  A port whose hardware keeps the intermediate state saves it
+ * here before a hook returns and restores it on the next call.
+ */
+typedef struct CryptoAccelSha256State
+{
+    uint32_t words[ CRYPTO_ACCEL_SHA256_STATE_WORDS ];
+} CryptoAccelSha256State_t;
+
+/**
+ * @brief The operations of an accelerator.  A NULL hook means the operation
+ * is done in software.
+ *
+ * The hooks are called with the accelerator lock held, one at a time and
+ * only from tasks.  The ECC hooks take big-endian P-256 values: scalars and
+ * hashes of #CRYPTO_ACCEL_P256_LENGTH bytes, where a hash is already
+ * truncated and reduced modulo the order of the curve, public keys as X
+ * followed by Y, and signatures as r followed by s.
+ */
+typedef struct CryptoAccelOps
+{
+    /**
+     * @brief Begin an AES-GCM message.  The lock is held until gcmFinish.
+     */
+    CryptoAccelStatus_t ( * gcmStart )( const CryptoAccelGcmRequest_t * pRequest );
+
+    /**
+     * @brief Encrypt or decrypt the next part of the message.  pInput and
+     * pOutput may be the same.  length is a multiple of #CRYPTO_ACCEL_GRANULE
+     * except in the last call.
+     */
+    CryptoAccelStatus_t ( * gcmUpdate )( const uint8_t * pInput,
+                                         uint8_t * pOutput,
+                                         size_t length );
+
+    /**
+     * @brief End the message and write its 16-byte tag to the 4-byte aligned
+     * pTag.  Called after gcmStart succeeded, even if gcmUpdate failed.
+     */
+    CryptoAccelStatus_t ( * gcmFinish )( uint8_t * pTag );
+
+    /**
+     * @brief Begin a SHA-256 hash.
+     */
+    CryptoAccelStatus_t ( * sha256Start )( CryptoAccelSha256State_t * pState );
+
+    /**
+     * @brief Add data to a hash.  length is a multiple of
+     * #CRYPTO_ACCEL_GRANULE except in the last call of each
+     * #CryptoAccel_Sha256Update.
+     */
+    CryptoAccelStatus_t ( * sha256Update )( CryptoAccelSha256State_t * pState,
+                                            const uint8_t * pData,
+                                            size_t length );
+
+    /**
+     * @brief End a hash and write its 32-byte digest.
+     */
+    CryptoAccelStatus_t ( * sha256Finish )( CryptoAccelSha256State_t * pState,
+                                            uint8_t * pDigest );
+
+    /**
+     * @brief Sign a hash with the nonce, a random scalar between 1 and the
+     * order of the curve.  Hardware with its own random source may ignore
+     * the nonce.
+     */
+    CryptoAccelStatus_t ( * ecdsaSign )( const uint8_t * pPrivateKey,
+                                         const uint8_t * pHash,
+                                         const uint8_t * pNonce,
+                                         uint8_t * pSignature );
+
+    /**
+     * @brief Verify a signature of a hash.  Returns #CRYPTO_ACCEL_VERIFY_FAILED
+     * if it is not valid.
+     */
+    CryptoAccelStatus_t ( * ecdsaVerify )( const uint8_t * pPublicKey,
+                                           const uint8_t * pHash,
+                                           const uint8_t * pSignature );
+
+    /**
+     * @brief Compute the X coordinate of the product of a private key and
+     * the public key of the peer.
+     */
+    CryptoAccelStatus_t ( * ecdh )( const uint8_t * pPrivateKey,
+                                    const uint8_t * pPeerPublicKey,
+                                    uint8_t * pSharedSecret );
+} CryptoAccelOps_t;
+
+/**
+ * @brief Counters of the operations, see #CryptoAccel_GetStats.
+ */
+typedef struct CryptoAccelStats
+{
+    uint32_t gcmAccelerated;     /**< AES-GCM messages done by the accelerator. */
+    uint32_t gcmSoftware;        /**< AES-GCM messages done in software. */
+    uint32_t sha256Accelerated;  /**< SHA-256 hashes begun on the accelerator. */
+    uint32_t sha256Software;     /**< SHA-256 hashes done in software. */
+    uint32_t eccAccelerated;     /**< ECC operations done by the accelerator. */
+    uint32_t eccSoftware;        /**< ECC operations done in software. */
+    uint32_t bytesBounced;       /**< Bytes copied through the bounce buffer. */
+    uint32_t errors;             /**< Operations the accelerator failed. */
+} CryptoAccelStats_t;
+
+/**
+ * @brief Results of #CryptoAccel_Benchmark, in kilobytes per second.
+ */
+typedef struct CryptoAccelBenchmark
+{
+    uint32_t gcmSoftware;        /**< AES-128-GCM in software. */
+    uint32_t gcmAligned;         /**< AES-128-GCM on the accelerator, on DMA-friendly records. */
+    uint32_t gcmUnaligned;       /**< AES-128-GCM on the accelerator, on records at the offset of a TLS 1.2 record payload. */
+    uint32_t sha256Software;     /**< SHA-256 in software. */
+    uint32_t sha256Accelerated;  /**< SHA-256 on the accelerator. */
+} CryptoAccelBenchmark_t;
+
+/**
+ * @brief Set the operations of the accelerator.
+ *
+ * Must be called once, before the first TLS connection.  Until then, and if
+ * @p pOps is NULL, all operations are done in software.
+ *
+ * @param[in] pOps The operations of the accelerator, which must stay valid.
+ *
+ * @return pdPASS if the lock could be created;
+ * pdFAIL otherwise.
+ */
+BaseType_t CryptoAccel_Init( const CryptoAccelOps_t * pOps );
+
+/**
+ * @brief Replace the operations of the accelerator, such as to compare it
+ * with software.
+ *
+ * @param[in] pOps The new operations, or NULL for software.
+ *
+ * @return The previous operations.
+ */
+const CryptoAccelOps_t * CryptoAccel_SetOps( const CryptoAccelOps_t * pOps );
+
+/**
+ * @brief Encrypt or decrypt a whole AES-GCM message on the accelerator,
+ * copying the parts of the buffers which are not DMA-friendly through the
+ * bounce buffer.
+ *
+ * When decrypting, the caller compares the tag, and erases the plaintext if
+ * it does not match.
+ *
+ * @param[in] pRequest The message.
+ * @param[out] pTag The 16-byte tag computed over the ciphertext.
+ *
+ * @return #CRYPTO_ACCEL_SUCCESS if the accelerator did the message;
+ * #CRYPTO_ACCEL_UNSUPPORTED if it must be done in software;
+ * #CRYPTO_ACCEL_HW_ERROR if the accelerator failed, in which case the output
+ * is not valid.
+ */
+CryptoAccelStatus_t CryptoAccel_Gcm( const CryptoAccelGcmRequest_t * pRequest,
+                                     uint8_t * pTag );
+
+/**
+ * @brief Begin a SHA-256 hash on the accelerator.
+ *
+ * @param[out] pState The state of the hash.
+ *
+ * @return #CRYPTO_ACCEL_SUCCESS if the hash continues with
+ * #CryptoAccel_Sha256Update; otherwise it must be done in software.
+ */
+CryptoAccelStatus_t CryptoAccel_Sha256Start( CryptoAccelSha256State_t * pState );
+
+/**
+ * @brief Add data to a hash begun by #CryptoAccel_Sha256Start.
+ *
+ * @param[in, out] pState The state of the hash.
+ * @param[in] pData The data.
+ * @param[in] length The length of the data.
+ *
+ * @return #CRYPTO_ACCEL_SUCCESS or #CRYPTO_ACCEL_HW_ERROR.
+ */
+CryptoAccelStatus_t CryptoAccel_Sha256Update( CryptoAccelSha256State_t * pState,
+                                              const uint8_t * pData,
+                                              size_t length );
+
+/**
+ * @brief End a hash begun by #CryptoAccel_Sha256Start.
+ *
+ * @param[in, out] pState The state of the hash.
+ * @param[out] pDigest The 32-byte digest.
+ *
+ * @return #CRYPTO_ACCEL_SUCCESS or #CRYPTO_ACCEL_HW_ERROR.
+ */
+CryptoAccelStatus_t CryptoAccel_Sha256Finish( CryptoAccelSha256State_t * pState,
+                                              uint8_t * pDigest );
+
+/**
+ * @brief Sign a P-256 hash on the accelerator, see CryptoAccelOps_t::ecdsaSign.
+ */
+CryptoAccelStatus_t CryptoAccel_EcdsaSign( const uint8_t * pPrivateKey,
+                                           const uint8_t * pHash,
+                                           const uint8_t * pNonce,
+                                           uint8_t * pSignature );
+
+/**
+ * @brief Verify a P-256 signature on the accelerator, see
+ * CryptoAccelOps_t::ecdsaVerify.
+ */
+CryptoAccelStatus_t CryptoAccel_EcdsaVerify( const uint8_t * pPublicKey,
+                                             const uint8_t * pHash,
+                                             const uint8_t * pSignature );
+
+/**
+ * @brief Compute a P-256 shared secret on the accelerator, see
+ * CryptoAccelOps_t::ecdh.
+ */
+CryptoAccelStatus_t CryptoAccel_Ecdh( const uint8_t * pPrivateKey,
+                                      const uint8_t * pPeerPublicKey,
+                                      uint8_t * pSharedSecret );
+
+/**
+ * @brief Count an operation which the glue does in software without asking
+ * the accelerator, such as a hash with SHA-224 or a signature on another
+ * curve than P-256.  The CryptoAccel_ functions count the operations for
+ * which they return #CRYPTO_ACCEL_UNSUPPORTED themselves.
+ *
+ * @param[in] algorithm The algorithm of the operation.
+ */
+void CryptoAccel_CountSoftware( CryptoAccelAlgorithm_t algorithm );
+
+/**
+ * @brief Read the counters of the operations.
+ *
+ * @param[out] pStats The counters.
+ */
+void CryptoAccel_GetStats( CryptoAccelStats_t * pStats );
+
+/**
+ * @brief Convert a hash to a P-256 scalar, truncating it to its leftmost 32
+ * bytes and reducing it modulo the order of the curve, as ECDSA does.
+ *
+ * @param[in] pHash The hash.
+ * @param[in] hashLength The length of the hash.
+ * @param[out] pScalar The #CRYPTO_ACCEL_P256_LENGTH byte scalar.
+ */
+void CryptoAccel_P256HashToScalar( const uint8_t * pHash,
+                                   size_t hashLength,
+                                   uint8_t * pScalar );
+
+/**
+ * @brief Whether a P-256 scalar is between 1 and the order of the curve,
+ * such as a random nonce.
+ *
+ * @param[in] pScalar The #CRYPTO_ACCEL_P256_LENGTH byte scalar.
+ *
+ * @return pdTRUE if it is; pdFALSE otherwise.
+ */
+BaseType_t CryptoAccel_P256IsValidScalar( const uint8_t * pScalar );
+
+/**
+ * @brief Time AES-128-GCM and SHA-256 over a bulk transfer, in software and
+ * on the accelerator, through the mbedTLS API.  Implemented by
+ * crypto_accel_mbedtls.c.
+ *
+ * Each record is encrypted in place with its own IV, then all records are
+ * decrypted in the reverse order, and all of them are hashed.  The results
+ * of the accelerator are checked against those of software.  The times have
+ * the resolution of the tick, so the transfer should take at least a second.
+ *
+ * @param[in] recordLength The length of a record, such as 16384.
+ * @param[in] recordCount The number of records, such as 64.
+ * @param[out] pResult The throughputs.
+ *
+ * @return #CRYPTO_ACCEL_SUCCESS if the benchmark ran;
+ * #CRYPTO_ACCEL_VERIFY_FAILED if the accelerator gave other results than
+ * software;
+ * #CRYPTO_ACCEL_HW_ERROR if an operation or the allocation of the records
+ * failed.
+ */
+CryptoAccelStatus_t CryptoAccel_Benchmark( size_t recordLength,
+                                           size_t recordCount,
+                                           CryptoAccelBenchmark_t * pResult );
+
+/**
+ * @brief Register the accelerator with wolfSSL as the crypto callback device
+ * #CRYPTO_ACCEL_WOLFSSL_DEVICE_ID.  Implemented by crypto_accel_wolfssl.c,
+ * which requires WOLF_CRYPTO_CB.
+ *
+ * Must be called after wolfSSL_Init() and #CryptoAccel_Init.
+ *
+ * @return 0 on success, or a wolfSSL error.
+ */
+int CryptoAccel_WolfSSLRegister( void );
+
+#endif /* ifndef CRYPTO_ACCEL_H */
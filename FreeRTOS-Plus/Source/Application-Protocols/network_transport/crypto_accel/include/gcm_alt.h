@@ -0,0 +1,62 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file gcm_alt.h
+ * @brief The AES-GCM context of MBEDTLS_GCM_ALT, implemented by
+ * crypto_accel_mbedtls.c.
+ *
+ * Whole messages, which is how TLS records are protected, are given to the
+ * accelerator.  The streaming functions and the messages the accelerator
+ * does not accept use the software AES of mbedTLS with a 4-bit GHASH table.
+ */
+
+#ifndef GCM_ALT_H
+#define GCM_ALT_H
+
+#include <stdint.h>
+
+#include "mbedtls/aes.h"
+
+/**
+ * @brief The AES-GCM context.
+ */
+typedef struct mbedtls_gcm_context
+{
+    mbedtls_aes_context aes;       /**< The key schedule of software AES. */
+    uint64_t HL[ 16 ];             /**< The GHASH table, low halves. */
+    uint64_t HH[ 16 ];             /**< The GHASH table, high halves. */
+    uint64_t len;                  /**< The length of the data processed so far. */
+    uint64_t add_len;              /**< The length of the additional data. */
+    unsigned char base_ectr[ 16 ]; /**< The first encrypted counter, which masks the tag. */
+    unsigned char y[ 16 ];         /**< The counter. */
+    unsigned char buf[ 16 ];       /**< The GHASH accumulator. */
+    int mode;                      /**< MBEDTLS_GCM_ENCRYPT or MBEDTLS_GCM_DECRYPT. */
+    unsigned char key[ 32 ];       /**< The key, for the accelerator. */
+    unsigned int key_bits;         /**< The size of the key in bits, or 0 before the key is set. */
+} mbedtls_gcm_context;
+
+#endif /* ifndef GCM_ALT_H */
@@ -0,0 +1,56 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file sha256_alt.h
+ * @brief The SHA-256 context of MBEDTLS_SHA256_ALT, implemented by
+ * crypto_accel_mbedtls.c.
+ *
+ * A SHA-256 hash is done by the accelerator when it accepts it.  SHA-224,
+ * and the hashes the accelerator does not accept, are done in software.
+ */
+
+#ifndef SHA256_ALT_H
+#define SHA256_ALT_H
+
+#include <stdint.h>
+
+#include "crypto_accel.h"
+
+/**
+ * @brief The SHA-256 and SHA-224 context.
+ */
+typedef struct mbedtls_sha256_context
+{
+    uint32_t total[ 2 ];              /**< The number of bytes processed, in software. */
+    uint32_t state[ 8 ];              /**< The intermediate digest, in software. */
+    unsigned char buffer[ 64 ];       /**< The data of the block being filled, in software. */
+    int is224;                        /**< Whether the hash is SHA-224. */
+    int accelerated;                  /**< Whether the accelerator does the hash. */
+    CryptoAccelSha256State_t accel;   /**< The state of the hash on the accelerator. */
+} mbedtls_sha256_context;
+
+#endif /* ifndef SHA256_ALT_H */
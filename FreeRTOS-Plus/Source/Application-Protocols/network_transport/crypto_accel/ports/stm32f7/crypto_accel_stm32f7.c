@@ -0,0 +1,569 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file crypto_accel_stm32f7.c
+ * @brief The crypto accelerator port for the CRYP and HASH peripherals of the
+ * STM32F756.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* ST includes. */
+#include "stm32f7xx_hal.h"
+
+#include "crypto_accel_stm32f7.h"
+
+/**
+ * @brief The context swap registers of HASH used by SHA-256 without HMAC.
+ */
+#define HASH_CONTEXT_REGISTERS    38U
+
+/**
+ * @brief The size of a SHA-256 block.
+ */
+#define HASH_BLOCK_LENGTH         64U
+
+/**
+ * @brief The state of a hash between calls, kept in a
+ * #CryptoAccelSha256State_t.
+ *
+ * The last block of the message is held back in the buffer until the hash is
+ * finished, as HASH must be told the number of valid bits of its last word.
+ */
+typedef struct HashState
+{
+    uint32_t started;                        /**< Whether HASH has been given a block. */
+    uint32_t imr;                            /**< The saved HASH_IMR. */
+    uint32_t str;                            /**< The saved HASH_STR. */
+    uint32_t cr;                             /**< The saved HASH_CR. */
+    uint32_t csr[ HASH_CONTEXT_REGISTERS ];  /**< The saved HASH_CSR0 to HASH_CSR37. */
+    uint8_t buffer[ HASH_BLOCK_LENGTH ];     /**< The bytes held back. */
+    uint32_t bufferLength;                   /**< The number of bytes held back. */
+} HashState_t;
+
+#if ( CRYPTO_ACCEL_SHA256_STATE_WORDS * 4U ) < ( ( HASH_CONTEXT_REGISTERS + 5U ) * 4U + HASH_BLOCK_LENGTH )
+    #error "CRYPTO_ACCEL_SHA256_STATE_WORDS is too small for the state of HASH."
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The AES-GCM hooks.
+ */
+static CryptoAccelStatus_t gcmStart( const CryptoAccelGcmRequest_t * pRequest );
+static CryptoAccelStatus_t gcmUpdate( const uint8_t * pInput,
+                                      uint8_t * pOutput,
+                                      size_t length );
+static CryptoAccelStatus_t gcmFinish( uint8_t * pTag );
+
+/**
+ * @brief The SHA-256 hooks.
+ */
+static CryptoAccelStatus_t sha256Start( CryptoAccelSha256State_t * pState );
+static CryptoAccelStatus_t sha256Update( CryptoAccelSha256State_t * pState,
+                                         const uint8_t * pData,
+                                         size_t length );
+static CryptoAccelStatus_t sha256Finish( CryptoAccelSha256State_t * pState,
+                                         uint8_t * pDigest );
+
+/**
+ * @brief Give HASH the context of a hash, or start a new one.
+ */
+static void hashRestore( const HashState_t * pHash );
+
+/**
+ * @brief Save the context of HASH once it waits for a new block.
+ *
+ * @return pdPASS, or pdFAIL if HASH did not become ready in time.
+ */
+static BaseType_t hashSave( HashState_t * pHash );
+
+/**
+ * @brief Write bytes to HASH, a word at a time.  The last word is padded with
+ * zeroes.
+ */
+static void hashWrite( const uint8_t * pData,
+                       size_t length );
+
+/**
+ * @brief Wait until the bits of HASH_SR in @p mask are set and HASH is not
+ * busy.
+ */
+static BaseType_t hashWait( uint32_t mask );
+
+#if ( CRYPTO_ACCEL_STM32F7_USE_DMA > 0 )
+
+/**
+ * @brief Move a payload chunk with DMA and wait for it.
+ */
+    static HAL_StatusTypeDef gcmTransferDma( uint8_t * pInput,
+                                             uint16_t size,
+                                             uint8_t * pOutput );
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The handle of CRYP.
+ */
+static CRYP_HandleTypeDef crypHandle;
+
+/**
+ * @brief The key and the initial counter of the current message, as words
+ * since the HAL reads them as words.
+ */
+static uint32_t gcmKey[ 8 ];
+static uint32_t gcmCounter[ 4 ];
+
+/**
+ * @brief The direction and length of the current message.
+ */
+static CryptoAccelDirection_t gcmDirection;
+static uint32_t gcmLength;
+
+#if ( CRYPTO_ACCEL_STM32F7_USE_DMA > 0 )
+
+/**
+ * @brief The task waiting for a DMA transfer, and whether it failed.
+ */
+    static TaskHandle_t gcmWaitingTask = NULL;
+    static volatile BaseType_t gcmDmaError = pdFALSE;
+
+#endif
+
+/**
+ * @brief The operations of the port.  There is no public key accelerator.
+ */
+static const CryptoAccelOps_t stm32f7Ops =
+{
+    .gcmStart     = gcmStart,
+    .gcmUpdate    = gcmUpdate,
+    .gcmFinish    = gcmFinish,
+    .sha256Start  = sha256Start,
+    .sha256Update = sha256Update,
+    .sha256Finish = sha256Finish,
+    .ecdsaSign    = NULL,
+    .ecdsaVerify  = NULL,
+    .ecdh         = NULL
+};
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t gcmStart( const CryptoAccelGcmRequest_t * pRequest )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_SUCCESS;
+    uint32_t keySize = CRYP_KEYSIZE_128B;
+
+    switch( pRequest->keyLength )
+    {
+        case 16U:
+            keySize = CRYP_KEYSIZE_128B;
+            break;
+
+        case 24U:
+            keySize = CRYP_KEYSIZE_192B;
+            break;
+
+        case 32U:
+            keySize = CRYP_KEYSIZE_256B;
+            break;
+
+        default:
+            status = CRYPTO_ACCEL_UNSUPPORTED;
+            break;
+    }
+
+    /* CRYP only takes 96-bit IVs, and cannot encrypt a partial last block. */
+    if( ( pRequest->ivLength != 12U ) ||
+        ( ( pRequest->direction == CRYPTO_ACCEL_ENCRYPT ) && ( ( pRequest->length % 16U ) != 0U ) ) )
+    {
+        status = CRYPTO_ACCEL_UNSUPPORTED;
+    }
+
+    if( status == CRYPTO_ACCEL_SUCCESS )
+    {
+        /* The HAL reads the key from its lowest word for every key size. */
+        ( void ) memset( gcmKey, 0, sizeof( gcmKey ) );
+        ( void ) memcpy( gcmKey, pRequest->pKey, pRequest->keyLength );
+
+        /* The first counter is IV || 0x00000002, as the tag uses 1. */
+        ( void ) memcpy( gcmCounter, pRequest->pIv, 12U );
+        gcmCounter[ 3 ] = __REV( 2U );
+
+        crypHandle.Instance = CRYP;
+        crypHandle.Init.DataType = CRYP_DATATYPE_8B;
+        crypHandle.Init.KeySize = keySize;
+        crypHandle.Init.pKey = ( uint8_t * ) gcmKey;
+        crypHandle.Init.pInitVect = ( uint8_t * ) gcmCounter;
+        crypHandle.Init.Header = ( uint8_t * ) pRequest->pAad;
+        crypHandle.Init.HeaderSize = pRequest->aadLength;
+
+        /* A timeout leaves the handle locked. */
+        crypHandle.Lock = HAL_UNLOCKED;
+
+        if( HAL_CRYP_Init( &crypHandle ) != HAL_OK )
+        {
+            status = CRYPTO_ACCEL_HW_ERROR;
+        }
+
+        gcmDirection = pRequest->direction;
+        gcmLength = 0U;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t gcmUpdate( const uint8_t * pInput,
+                                      uint8_t * pOutput,
+                                      size_t length )
+{
+    HAL_StatusTypeDef result;
+    uint16_t size;
+
+    /* The core pads a partial last block with zeroes, which only reaches
+     * here when decrypting.  GHASH pads the ciphertext the same way. */
+    size = ( uint16_t ) ( ( length + 15U ) & ~( ( size_t ) 15U ) );
+
+    #if ( CRYPTO_ACCEL_STM32F7_USE_DMA > 0 )
+        result = gcmTransferDma( ( uint8_t * ) pInput, size, pOutput );
+    #else
+        if( gcmDirection == CRYPTO_ACCEL_ENCRYPT )
+        {
+            result = HAL_CRYPEx_AESGCM_Encrypt( &crypHandle, ( uint8_t * ) pInput, size, pOutput,
+                                                CRYPTO_ACCEL_STM32F7_TIMEOUT_MS );
+        }
+        else
+        {
+            result = HAL_CRYPEx_AESGCM_Decrypt( &crypHandle, ( uint8_t * ) pInput, size, pOutput,
+                                                CRYPTO_ACCEL_STM32F7_TIMEOUT_MS );
+        }
+    #endif
+
+    gcmLength += ( uint32_t ) length;
+
+    return ( result == HAL_OK ) ? CRYPTO_ACCEL_SUCCESS : CRYPTO_ACCEL_HW_ERROR;
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t gcmFinish( uint8_t * pTag )
+{
+    HAL_StatusTypeDef result;
+
+    result = HAL_CRYPEx_AESGCM_Finish( &crypHandle, gcmLength, pTag, CRYPTO_ACCEL_STM32F7_TIMEOUT_MS );
+
+    ( void ) memset( gcmKey, 0, sizeof( gcmKey ) );
+
+    return ( result == HAL_OK ) ? CRYPTO_ACCEL_SUCCESS : CRYPTO_ACCEL_HW_ERROR;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( CRYPTO_ACCEL_STM32F7_USE_DMA > 0 )
+
+    static HAL_StatusTypeDef gcmTransferDma( uint8_t * pInput,
+                                             uint16_t size,
+                                             uint8_t * pOutput )
+    {
+        HAL_StatusTypeDef result;
+
+        /* The buffers are aligned to cache lines and may be maintained up to
+         * the granule, see crypto_accel.h. */
+        SCB_CleanDCache_by_Addr( ( uint32_t * ) pInput, ( int32_t ) size );
+        SCB_InvalidateDCache_by_Addr( ( uint32_t * ) pOutput, ( int32_t ) size );
+
+        gcmWaitingTask = xTaskGetCurrentTaskHandle();
+        gcmDmaError = pdFALSE;
+        ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+        if( gcmDirection == CRYPTO_ACCEL_ENCRYPT )
+        {
+            result = HAL_CRYPEx_AESGCM_Encrypt_DMA( &crypHandle, pInput, size, pOutput );
+        }
+        else
+        {
+            result = HAL_CRYPEx_AESGCM_Decrypt_DMA( &crypHandle, pInput, size, pOutput );
+        }
+
+        if( ( result == HAL_OK ) &&
+            ( ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( CRYPTO_ACCEL_STM32F7_TIMEOUT_MS ) ) == 0U ) )
+        {
+            result = HAL_TIMEOUT;
+        }
+
+        if( ( result == HAL_OK ) && ( gcmDmaError != pdFALSE ) )
+        {
+            result = HAL_ERROR;
+        }
+
+        gcmWaitingTask = NULL;
+
+        /* Drop lines the CPU may have fetched during the transfer. */
+        SCB_InvalidateDCache_by_Addr( ( uint32_t * ) pOutput, ( int32_t ) size );
+
+        return result;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void HAL_CRYP_OutCpltCallback( CRYP_HandleTypeDef * hcryp )
+    {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+        ( void ) hcryp;
+
+        if( gcmWaitingTask != NULL )
+        {
+            vTaskNotifyGiveFromISR( gcmWaitingTask, &higherPriorityTaskWoken );
+        }
+
+        portYIELD_FROM_ISR( higherPriorityTaskWoken );
+    }
+
+/*-----------------------------------------------------------*/
+
+    void HAL_CRYP_ErrorCallback( CRYP_HandleTypeDef * hcryp )
+    {
+        gcmDmaError = pdTRUE;
+        HAL_CRYP_OutCpltCallback( hcryp );
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( CRYPTO_ACCEL_STM32F7_USE_DMA > 0 ) */
+
+static BaseType_t hashWait( uint32_t mask )
+{
+    BaseType_t result = pdPASS;
+    TickType_t start = xTaskGetTickCount();
+
+    while( ( ( HASH->SR & mask ) != mask ) || ( ( HASH->SR & HASH_SR_BUSY ) != 0U ) )
+    {
+        if( ( xTaskGetTickCount() - start ) > pdMS_TO_TICKS( CRYPTO_ACCEL_STM32F7_TIMEOUT_MS ) )
+        {
+            result = pdFAIL;
+            break;
+        }
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static void hashRestore( const HashState_t * pHash )
+{
+    uint32_t i;
+
+    if( pHash->started == 0U )
+    {
+        /* SHA-256 on bytes, starting a new digest. */
+        HASH->CR = HASH_CR_DATATYPE_1 | HASH_CR_ALGO | HASH_CR_INIT;
+    }
+    else
+    {
+        HASH->IMR = pHash->imr;
+        HASH->STR = pHash->str;
+        HASH->CR = pHash->cr | HASH_CR_INIT;
+
+        for( i = 0; i < HASH_CONTEXT_REGISTERS; i++ )
+        {
+            HASH->CSR[ i ] = pHash->csr[ i ];
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t hashSave( HashState_t * pHash )
+{
+    BaseType_t result;
+    uint32_t i;
+
+    result = hashWait( HASH_SR_DINIS );
+
+    if( result == pdPASS )
+    {
+        pHash->imr = HASH->IMR;
+        pHash->str = HASH->STR;
+        pHash->cr = HASH->CR;
+
+        for( i = 0; i < HASH_CONTEXT_REGISTERS; i++ )
+        {
+            pHash->csr[ i ] = HASH->CSR[ i ];
+        }
+
+        pHash->started = 1U;
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static void hashWrite( const uint8_t * pData,
+                       size_t length )
+{
+    uint32_t word;
+    size_t i;
+
+    for( i = 0; i < length; i += 4U )
+    {
+        word = 0U;
+        ( void ) memcpy( &word, &pData[ i ], ( ( length - i ) < 4U ) ? ( length - i ) : 4U );
+        HASH->DIN = word;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t sha256Start( CryptoAccelSha256State_t * pState )
+{
+    HashState_t * pHash = ( HashState_t * ) pState->words;
+
+    /* HASH is only touched once a block is complete. */
+    pHash->started = 0U;
+    pHash->bufferLength = 0U;
+
+    return CRYPTO_ACCEL_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t sha256Update( CryptoAccelSha256State_t * pState,
+                                         const uint8_t * pData,
+                                         size_t length )
+{
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_SUCCESS;
+    HashState_t * pHash = ( HashState_t * ) pState->words;
+    size_t fill;
+
+    if( ( pHash->bufferLength + length ) <= HASH_BLOCK_LENGTH )
+    {
+        ( void ) memcpy( &pHash->buffer[ pHash->bufferLength ], pData, length );
+        pHash->bufferLength += ( uint32_t ) length;
+    }
+    else
+    {
+        hashRestore( pHash );
+
+        if( pHash->bufferLength != 0U )
+        {
+            fill = HASH_BLOCK_LENGTH - pHash->bufferLength;
+            ( void ) memcpy( &pHash->buffer[ pHash->bufferLength ], pData, fill );
+            hashWrite( pHash->buffer, HASH_BLOCK_LENGTH );
+            pData = &pData[ fill ];
+            length -= fill;
+        }
+
+        /* Keep back the last 1 to 64 bytes. */
+        while( length > HASH_BLOCK_LENGTH )
+        {
+            hashWrite( pData, HASH_BLOCK_LENGTH );
+            pData = &pData[ HASH_BLOCK_LENGTH ];
+            length -= HASH_BLOCK_LENGTH;
+        }
+
+        ( void ) memcpy( pHash->buffer, pData, length );
+        pHash->bufferLength = ( uint32_t ) length;
+
+        if( hashSave( pHash ) != pdPASS )
+        {
+            status = CRYPTO_ACCEL_HW_ERROR;
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static CryptoAccelStatus_t sha256Finish( CryptoAccelSha256State_t * pState,
+                                         uint8_t * pDigest )
+{
+    static const uint8_t emptyDigest[ 32 ] =
+    {
+        0xE3, 0xB0, 0xC4, 0x42, 0x98, 0xFC, 0x1C, 0x14, 0x9A, 0xFB, 0xF4, 0xC8, 0x99, 0x6F, 0xB9, 0x24,
+        0x27, 0xAE, 0x41, 0xE4, 0x64, 0x9B, 0x93, 0x4C, 0xA4, 0x95, 0x99, 0x1B, 0x78, 0x52, 0xB8, 0x55
+    };
+    CryptoAccelStatus_t status = CRYPTO_ACCEL_SUCCESS;
+    HashState_t * pHash = ( HashState_t * ) pState->words;
+    uint32_t word;
+    uint32_t i;
+
+    if( pHash->bufferLength == 0U )
+    {
+        /* Only an empty message holds nothing back. */
+        ( void ) memcpy( pDigest, emptyDigest, sizeof( emptyDigest ) );
+    }
+    else
+    {
+        hashRestore( pHash );
+        hashWrite( pHash->buffer, pHash->bufferLength );
+
+        /* The number of valid bits of the last word, then the padding. */
+        HASH->STR = 8U * ( pHash->bufferLength % 4U );
+        HASH->STR |= HASH_STR_DCAL;
+
+        if( hashWait( HASH_SR_DCIS ) != pdPASS )
+        {
+            status = CRYPTO_ACCEL_HW_ERROR;
+        }
+        else
+        {
+            for( i = 0; i < 8U; i++ )
+            {
+                word = __REV( ( i < 5U ) ? HASH->HR[ i ] : HASH_DIGEST->HR[ i ] );
+                ( void ) memcpy( &pDigest[ 4U * i ], &word, sizeof( word ) );
+            }
+        }
+    }
+
+    ( void ) memset( pHash, 0, sizeof( HashState_t ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+const CryptoAccelOps_t * CryptoAccelStm32f7_Init( void )
+{
+    __HAL_RCC_CRYP_CLK_ENABLE();
+    __HAL_RCC_HASH_CLK_ENABLE();
+
+    return &stm32f7Ops;
+}
+
+/*-----------------------------------------------------------*/
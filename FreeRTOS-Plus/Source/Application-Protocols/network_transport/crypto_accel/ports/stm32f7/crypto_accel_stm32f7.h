@@ -0,0 +1,84 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file crypto_accel_stm32f7.h
+ * @brief The crypto accelerator port for the CRYP and HASH peripherals of the
+ * STM32F756.
+ *
+ * AES-GCM runs on CRYP through the STM32F7 HAL, and SHA-256 on HASH through
+ * its registers, saving and restoring the context of HASH between calls so
+ * that hashes can be interleaved.  The device has no public key accelerator,
+ * so ECC stays in software.
+ *
+ * CRYP cannot encrypt a message whose length is not a multiple of 16 bytes
+ * with GCM, as it would hash the ciphertext of the padding into the tag;
+ * those messages are done in software.  Decryption has no such limit.
+ */
+
+#ifndef CRYPTO_ACCEL_STM32F7_H
+#define CRYPTO_ACCEL_STM32F7_H
+
+#include "crypto_accel.h"
+
+/**
+ * @brief The longest time to wait for an operation of CRYP or HASH, in
+ * milliseconds.
+ */
+#ifndef CRYPTO_ACCEL_STM32F7_TIMEOUT_MS
+    #define CRYPTO_ACCEL_STM32F7_TIMEOUT_MS    100U
+#endif
+
+/**
+ * @brief Set to 1 to move the AES-GCM payload with DMA and wait for it on a
+ * task notification, instead of moving it with the CPU.
+ *
+ * The application must link the DMA streams of CRYP in HAL_CRYP_MspInit(),
+ * enable their interrupts and call HAL_DMA_IRQHandler() from them.  This
+ * port defines HAL_CRYP_OutCpltCallback() and HAL_CRYP_ErrorCallback().
+ * Defaults to 0.
+ */
+#ifndef CRYPTO_ACCEL_STM32F7_USE_DMA
+    #define CRYPTO_ACCEL_STM32F7_USE_DMA    0
+#endif
+
+#if ( CRYPTO_ACCEL_MAX_TRANSFER > 65520U )
+    #error "CRYP takes at most 65520 bytes at a time; lower CRYPTO_ACCEL_MAX_TRANSFER."
+#endif
+
+#if ( CRYPTO_ACCEL_STM32F7_USE_DMA > 0 ) && ( CRYPTO_ACCEL_DMA_ALIGNMENT < 32U )
+    #error "DMA requires CRYPTO_ACCEL_DMA_ALIGNMENT to be at least the 32-byte cache line."
+#endif
+
+/**
+ * @brief Enable the clocks of CRYP and HASH and return the operations of the
+ * port, for #CryptoAccel_Init.
+ *
+ * @return The operations.
+ */
+const CryptoAccelOps_t * CryptoAccelStm32f7_Init( void );
+
+#endif /* ifndef CRYPTO_ACCEL_STM32F7_H */
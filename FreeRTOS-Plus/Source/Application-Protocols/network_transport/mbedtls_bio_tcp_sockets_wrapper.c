@@ -29,6 +29,9 @@
  * @brief Implements mbed TLS platform send/receive functions for the TCP sockets wrapper.
  */
 
+/* Standard includes. */
+#include <string.h>
+
 /* MbedTLS includes. */
 #if !defined( MBEDTLS_CONFIG_FILE )
     #include "mbedtls/mbedtls_config.h"
@@ -46,10 +49,43 @@
 /* MbedTLS Bio TCP sockets wrapper include. */
 #include "mbedtls_bio_tcp_sockets_wrapper.h"
 
+#if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+    #define bioSOCKET( ctx )    ( ( ( MbedTLSBioContext_t * ) ( ctx ) )->xSocket )
+#else
+    #define bioSOCKET( ctx )    ( ( Socket_t ) ( ctx ) )
+#endif
+
+/**
+ * @brief Receives data from TCP socket, mapping the errors for mbed TLS.
+ *
+ * @param[in] xSocket The socket to receive from.
+ * @param[out] buf Buffer to receive bytes into.
+ * @param[in] len Number of bytes to receive from the network.
+ *
+ * @return Number of bytes received if successful; Negative value on error.
+ */
+static int prvSocketRecv( Socket_t xSocket,
+                          unsigned char * buf,
+                          size_t len );
+
+#if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+
+    void vMbedTLSBioInit( MbedTLSBioContext_t * pxContext,
+                          Socket_t xSocket )
+    {
+        configASSERT( pxContext != NULL );
+
+        /* The buffer is the last member, and needs no clearing. */
+        ( void ) memset( pxContext, 0, offsetof( MbedTLSBioContext_t, buffer ) );
+        pxContext->xSocket = xSocket;
+    }
+#endif
+
 /**
  * @brief Sends data over TCP socket.
  *
- * @param[in] ctx The network context containing the socket handle.
+ * @param[in] ctx The network context containing the socket handle, or the
+ * #MbedTLSBioContext_t if MBEDTLS_BIO_RECV_BUFFER_SIZE is non-zero.
  * @param[in] buf Buffer containing the bytes to send.
  * @param[in] len Number of bytes to send from the buffer.
  *
@@ -64,7 +100,7 @@ int xMbedTLSBioTCPSocketsWrapperSend( void * ctx,
     configASSERT( ctx != NULL );
     configASSERT( buf != NULL );
 
-    xReturnStatus = TCP_Sockets_Send( ( Socket_t ) ctx, buf, len );
+    xReturnStatus = TCP_Sockets_Send( bioSOCKET( ctx ), buf, len );
 
     switch( xReturnStatus )
     {
@@ -91,25 +127,13 @@ int xMbedTLSBioTCPSocketsWrapperSend( void * ctx,
     return ( int ) xReturnStatus;
 }
 
-/**
- * @brief Receives data from TCP socket.
- *
- * @param[in] ctx The network context containing the socket handle.
- * @param[out] buf Buffer to receive bytes into.
- * @param[in] len Number of bytes to receive from the network.
- *
- * @return Number of bytes received if successful; Negative value on error.
- */
-int xMbedTLSBioTCPSocketsWrapperRecv( void * ctx,
-                                      unsigned char * buf,
-                                      size_t len )
+static int prvSocketRecv( Socket_t xSocket,
+                          unsigned char * buf,
+                          size_t len )
 {
     int32_t xReturnStatus;
 
-    configASSERT( ctx != NULL );
-    configASSERT( buf != NULL );
-
-    xReturnStatus = TCP_Sockets_Recv( ( Socket_t ) ctx, buf, len );
+    xReturnStatus = TCP_Sockets_Recv( xSocket, buf, len );
 
     switch( xReturnStatus )
     {
@@ -133,3 +157,72 @@ int xMbedTLSBioTCPSocketsWrapperRecv( void * ctx,
 
     return ( int ) xReturnStatus;
 }
+
+/**
+ * @brief Receives data from TCP socket.
+ *
+ * @param[in] ctx The network context containing the socket handle, or the
+ * #MbedTLSBioContext_t if MBEDTLS_BIO_RECV_BUFFER_SIZE is non-zero.
+ * @param[out] buf Buffer to receive bytes into.
+ * @param[in] len Number of bytes to receive from the network.
+ *
+ * @return Number of bytes received if successful; Negative value on error.
+ */
+int xMbedTLSBioTCPSocketsWrapperRecv( void * ctx,
+                                      unsigned char * buf,
+                                      size_t len )
+{
+    int xReturnStatus = 0;
+
+    #if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+        MbedTLSBioContext_t * pxContext = ( MbedTLSBioContext_t * ) ctx;
+        size_t xCopyLength;
+    #endif
+
+    configASSERT( ctx != NULL );
+    configASSERT( buf != NULL );
+
+    #if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+        pxContext->stats.recvCalls++;
+
+        if( pxContext->length > 0U )
+        {
+            pxContext->stats.bufferHits++;
+        }
+        else if( len >= MBEDTLS_BIO_RECV_BUFFER_SIZE )
+        {
+            /* Nothing is gained by staging a large read in the buffer. */
+            pxContext->stats.socketReads++;
+            xReturnStatus = prvSocketRecv( pxContext->xSocket, buf, len );
+        }
+        else
+        {
+            pxContext->stats.socketReads++;
+            xReturnStatus = prvSocketRecv( pxContext->xSocket, pxContext->buffer, MBEDTLS_BIO_RECV_BUFFER_SIZE );
+
+            if( xReturnStatus > 0 )
+            {
+                pxContext->offset = 0U;
+                pxContext->length = ( size_t ) xReturnStatus;
+            }
+        }
+
+        if( xReturnStatus > 0 )
+        {
+            pxContext->stats.bytesRead += ( uint32_t ) xReturnStatus;
+        }
+
+        if( pxContext->length > 0U )
+        {
+            xCopyLength = ( len < pxContext->length ) ? len : pxContext->length;
+            ( void ) memcpy( buf, &( pxContext->buffer[ pxContext->offset ] ), xCopyLength );
+            pxContext->offset += xCopyLength;
+            pxContext->length -= xCopyLength;
+            xReturnStatus = ( int ) xCopyLength;
+        }
+    #else /* if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 ) */
+        xReturnStatus = prvSocketRecv( ( Socket_t ) ctx, buf, len );
+    #endif /* if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 ) */
+
+    return xReturnStatus;
+}
@@ -32,10 +32,68 @@
 #ifndef MBEDTLS_BIO_TCP_SOCKETS_WRAPPER
 #define MBEDTLS_BIO_TCP_SOCKETS_WRAPPER
 
+#include <stddef.h>
+#include <stdint.h>
+
+/* TCP Sockets Wrapper include.*/
+#include "tcp_sockets_wrapper.h"
+
+/**
+ * @brief Size of the receive buffer of each connection, in bytes.
+ *
+ * mbed TLS reads each record in two small reads, its 5 byte header and then
+ * its body.  When non-zero, a read smaller than this takes as much as the
+ * socket has available, up to this size, and the following reads are served
+ * from the buffer until it is empty.  This saves a socket call, and on the
+ * cellular port a modem read, per record.  The context passed to the receive
+ * and send functions is then a #MbedTLSBioContext_t rather than a socket.
+ * Zero (the default) reads from the socket for every read.
+ */
+#ifndef MBEDTLS_BIO_RECV_BUFFER_SIZE
+    #define MBEDTLS_BIO_RECV_BUFFER_SIZE    0
+#endif
+
+#if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+
+/**
+ * @brief Counters of the receive buffer of a connection.
+ */
+    typedef struct MbedTLSBioStats
+    {
+        uint32_t recvCalls;   /**< @brief Reads by mbed TLS. */
+        uint32_t bufferHits;  /**< @brief Reads served from the buffer without a socket call. */
+        uint32_t socketReads; /**< @brief Calls to TCP_Sockets_Recv(). */
+        uint32_t bytesRead;   /**< @brief Bytes received from the socket. */
+    } MbedTLSBioStats_t;
+
+/**
+ * @brief Socket and receive buffer of a connection.
+ */
+    typedef struct MbedTLSBioContext
+    {
+        Socket_t xSocket;                                  /**< @brief The connected socket. */
+        size_t offset;                                     /**< @brief Offset of the first unread byte of buffer. */
+        size_t length;                                     /**< @brief Number of unread bytes in buffer. */
+        MbedTLSBioStats_t stats;                           /**< @brief Counters of the buffer. */
+        uint8_t buffer[ MBEDTLS_BIO_RECV_BUFFER_SIZE ];    /**< @brief Data received but not yet read. */
+    } MbedTLSBioContext_t;
+
+/**
+ * @brief Set up the receive buffer of a connection, to pass to
+ * mbedtls_ssl_set_bio() as its context.
+ *
+ * @param[out] pxContext The context to set up.
+ * @param[in] xSocket The connected socket.
+ */
+    void vMbedTLSBioInit( MbedTLSBioContext_t * pxContext,
+                          Socket_t xSocket );
+#endif /* if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 ) */
+
 /**
  * @brief Sends data over TCP socket.
  *
- * @param[in] ctx The network context containing the socket handle.
+ * @param[in] ctx The network context containing the socket handle, or the
+ * #MbedTLSBioContext_t if MBEDTLS_BIO_RECV_BUFFER_SIZE is non-zero.
  * @param[in] buf Buffer containing the bytes to send.
  * @param[in] len Number of bytes to send from the buffer.
  *
@@ -48,7 +106,8 @@ int xMbedTLSBioTCPSocketsWrapperSend( void * ctx,
 /**
  * @brief Receives data from TCP socket.
  *
- * @param[in] ctx The network context containing the socket handle.
+ * @param[in] ctx The network context containing the socket handle, or the
+ * #MbedTLSBioContext_t if MBEDTLS_BIO_RECV_BUFFER_SIZE is non-zero.
  * @param[out] buf Buffer to receive bytes into.
  * @param[in] len Number of bytes to receive from the network.
  *
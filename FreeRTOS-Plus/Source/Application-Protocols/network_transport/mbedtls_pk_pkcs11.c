@@ -67,10 +67,17 @@
 
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
+#include "mbedtls_pkcs11.h"
 
 /* PKCS11 Includes */
 #include "pkcs11t.h"
 
+#if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "queue.h"
+#endif
+
 /*-----------------------------------------------------------*/
 
 typedef struct P11PkCtx
@@ -92,6 +99,39 @@ typedef struct P11RsaCtx
     P11PkCtx_t xP11PkCtx;
 } P11RsaCtx_t;
 
+#if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+
+/**
+ * @brief Progress of an ECDSA signature computed by the worker task.
+ */
+    typedef enum P11SignState
+    {
+        P11_SIGN_IDLE = 0, /**< The signature has not been queued. */
+        P11_SIGN_PENDING,  /**< The worker task owns the request. */
+        P11_SIGN_DONE      /**< The worker task has finished with the request. */
+    } P11SignState_t;
+
+/**
+ * @brief An ECDSA signature request, used as the mbedTLS restart context.
+ *
+ * The state and the abandoned flag are shared with the worker task and are
+ * only accessed in critical sections.
+ */
+    typedef struct P11SignRequest
+    {
+        P11SignState_t xState;
+        BaseType_t xAbandoned;
+        CK_RV xResult;
+        P11PkCtx_t xP11PkCtx;
+        TaskHandle_t xRequester;
+        unsigned char pucHash[ MBEDTLS_MD_MAX_SIZE ];
+        CK_ULONG ulHashLen;
+        unsigned char pucSig[ MBEDTLS_ECDSA_MAX_LEN ];
+        CK_ULONG ulSigLen;
+    } P11SignRequest_t;
+
+#endif /* MBEDTLS_PKCS11_ASYNC_SIGN > 0 */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -197,6 +237,80 @@ static int prvEcdsaSigToASN1InPlace( unsigned char * pucSig,
                                      size_t xSigBufferSize,
                                      size_t * pxSigLen );
 
+/**
+ * @brief Compute a raw ECDSA signature with the PKCS #11 module.
+ *
+ * @param pxP11Ctx PKCS #11 session and key to sign with.
+ * @param pucHash Hash to sign; the module may modify it.
+ * @param ulHashLen Length of the hash.
+ * @param pucSig Buffer for the signature.
+ * @param pulSigLen Length of pucSig on entry, length of the signature on exit.
+ * @return CKR_OK on success.
+ */
+static CK_RV prvP11EcdsaSign( const P11PkCtx_t * pxP11Ctx,
+                              unsigned char * pucHash,
+                              CK_ULONG ulHashLen,
+                              unsigned char * pucSig,
+                              CK_ULONG * pulSigLen );
+
+#if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+
+/**
+ * @brief Restartable ECDSA sign operation which computes the signature in the
+ * worker task.
+ *
+ * @param pvRsCtx The P11SignRequest_t allocated by p11_ecdsa_rs_alloc.
+ * @return 0 on success
+ * @return MBEDTLS_ERR_ECP_IN_PROGRESS while the worker task is signing.
+ * @return A negative number on failure
+ */
+    static int p11_ecdsa_sign_rs( mbedtls_pk_context * pk,
+                                  mbedtls_md_type_t xMdAlg,
+                                  const unsigned char * pucHash,
+                                  size_t xHashLen,
+                                  unsigned char * pucSig,
+                                  size_t xSigBufferSize,
+                                  size_t * pxSigLen,
+                                  int ( * plRng )( void *, unsigned char *, size_t ),
+                                  void * pvRng,
+                                  void * pvRsCtx );
+
+/**
+ * @brief Allocates a P11SignRequest_t.
+ *
+ * @return A void pointer to the newly created P11SignRequest_t.
+ */
+    static void * p11_ecdsa_rs_alloc( void );
+
+/**
+ * @brief Frees a P11SignRequest_t, or leaves it to the worker task to free if
+ * the worker task still owns it.
+ *
+ * @param pvRsCtx void pointer to the request to be freed.
+ */
+    static void p11_ecdsa_rs_free( void * pvRsCtx );
+
+/**
+ * @brief Create the signing queue and worker task if they do not exist yet.
+ *
+ * @return pdTRUE if the worker task is running.
+ */
+    static BaseType_t prvStartSignWorker( void );
+
+/**
+ * @brief Worker task which computes queued ECDSA signatures.
+ *
+ * @param pvParameters Unused.
+ */
+    static void prvSignWorkerTask( void * pvParameters );
+
+/**
+ * @brief Queue of P11SignRequest_t pointers for the worker task.
+ */
+    static QueueHandle_t xSignQueue = NULL;
+
+#endif /* MBEDTLS_PKCS11_ASYNC_SIGN > 0 */
+
 static int prvASN1WriteBigIntFromOctetStr( unsigned char ** ppucPosition,
                                            const unsigned char * pucStart,
                                            const unsigned char * pucOctetStr,
@@ -213,7 +327,10 @@ mbedtls_pk_info_t mbedtls_pkcs11_pk_ecdsa =
     .can_do             = p11_ecdsa_can_do,
     .verify_func        = p11_ecdsa_verify,
     .sign_func          = p11_ecdsa_sign,
-    #if defined( MBEDTLS_ECDSA_C ) && defined( MBEDTLS_ECP_RESTARTABLE )
+    #if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+        .verify_rs_func = NULL,
+        .sign_rs_func   = p11_ecdsa_sign_rs,
+    #elif defined( MBEDTLS_ECDSA_C ) && defined( MBEDTLS_ECP_RESTARTABLE )
         .verify_rs_func = NULL,
         .sign_rs_func   = NULL,
     #endif /* MBEDTLS_ECDSA_C && MBEDTLS_ECP_RESTARTABLE */
@@ -222,7 +339,10 @@ mbedtls_pk_info_t mbedtls_pkcs11_pk_ecdsa =
     .check_pair_func    = p11_ecdsa_check_pair,
     .ctx_alloc_func     = p11_ecdsa_ctx_alloc,
     .ctx_free_func      = p11_ecdsa_ctx_free,
-    #if defined( MBEDTLS_ECDSA_C ) && defined( MBEDTLS_ECP_RESTARTABLE )
+    #if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+        .rs_alloc_func  = p11_ecdsa_rs_alloc,
+        .rs_free_func   = p11_ecdsa_rs_free,
+    #elif defined( MBEDTLS_ECDSA_C ) && defined( MBEDTLS_ECP_RESTARTABLE )
         .rs_alloc_func  = NULL,
         .rs_free_func   = NULL,
     #endif /* MBEDTLS_ECDSA_C && MBEDTLS_ECP_RESTARTABLE */
@@ -693,13 +813,6 @@ static int p11_ecdsa_sign( mbedtls_pk_context * pk,
     const P11PkCtx_t * pxP11Ctx = NULL;
     unsigned char pucHashCopy[ MBEDTLS_MD_MAX_SIZE ];
 
-    CK_MECHANISM xMech =
-    {
-        .mechanism      = CKM_ECDSA,
-        .pParameter     = NULL,
-        .ulParameterLen = 0
-    };
-
     /* Unused parameters. */
     ( void ) ( xMdAlg );
     ( void ) ( plRng );
@@ -720,23 +833,13 @@ static int p11_ecdsa_sign( mbedtls_pk_context * pk,
         xResult = CKR_FUNCTION_FAILED;
     }
 
-    if( CKR_OK == xResult )
-    {
-        /* Use the PKCS#11 module to sign. */
-        xResult = pxP11Ctx->pxFunctionList->C_SignInit( pxP11Ctx->xSessionHandle,
-                                                        &xMech,
-                                                        pxP11Ctx->xPkHandle );
-    }
-
     if( CKR_OK == xResult )
     {
         CK_ULONG ulSigLen = xSigBufferSize;
 
         ( void ) memcpy( pucHashCopy, pucHash, xHashLen );
 
-        xResult = pxP11Ctx->pxFunctionList->C_Sign( pxP11Ctx->xSessionHandle,
-                                                    pucHashCopy, xHashLen,
-                                                    pucSig, &ulSigLen );
+        xResult = prvP11EcdsaSign( pxP11Ctx, pucHashCopy, xHashLen, pucSig, &ulSigLen );
 
         if( xResult == CKR_OK )
         {
@@ -759,6 +862,278 @@ static int p11_ecdsa_sign( mbedtls_pk_context * pk,
 
 /*-----------------------------------------------------------*/
 
+static CK_RV prvP11EcdsaSign( const P11PkCtx_t * pxP11Ctx,
+                              unsigned char * pucHash,
+                              CK_ULONG ulHashLen,
+                              unsigned char * pucSig,
+                              CK_ULONG * pulSigLen )
+{
+    CK_RV xResult = CKR_OK;
+
+    CK_MECHANISM xMech =
+    {
+        .mechanism      = CKM_ECDSA,
+        .pParameter     = NULL,
+        .ulParameterLen = 0
+    };
+
+    /* Use the PKCS#11 module to sign. */
+    xResult = pxP11Ctx->pxFunctionList->C_SignInit( pxP11Ctx->xSessionHandle,
+                                                    &xMech,
+                                                    pxP11Ctx->xPkHandle );
+
+    if( CKR_OK == xResult )
+    {
+        xResult = pxP11Ctx->pxFunctionList->C_Sign( pxP11Ctx->xSessionHandle,
+                                                    pucHash, ulHashLen,
+                                                    pucSig, pulSigLen );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+
+    static int p11_ecdsa_sign_rs( mbedtls_pk_context * pk,
+                                  mbedtls_md_type_t xMdAlg,
+                                  const unsigned char * pucHash,
+                                  size_t xHashLen,
+                                  unsigned char * pucSig,
+                                  size_t xSigBufferSize,
+                                  size_t * pxSigLen,
+                                  int ( * plRng )( void *, unsigned char *, size_t ),
+                                  void * pvRng,
+                                  void * pvRsCtx )
+    {
+        int lResult = 0;
+        const P11EcDsaCtx_t * pxEcDsaCtx = ( P11EcDsaCtx_t * ) pk->pk_ctx;
+        P11SignRequest_t * pxRequest = ( P11SignRequest_t * ) pvRsCtx;
+        P11SignState_t xState = P11_SIGN_IDLE;
+
+        configASSERT( pucSig != NULL );
+        configASSERT( pxSigLen != NULL );
+
+        if( ( pxEcDsaCtx == NULL ) || ( pxRequest == NULL ) )
+        {
+            lResult = -1;
+        }
+        else
+        {
+            taskENTER_CRITICAL();
+            {
+                xState = pxRequest->xState;
+            }
+            taskEXIT_CRITICAL();
+        }
+
+        if( lResult != 0 )
+        {
+            /* Empty else for MISRA 15.7 compliance. */
+        }
+        else if( xState == P11_SIGN_IDLE )
+        {
+            configASSERT( pucHash != NULL );
+            configASSERT( xHashLen <= sizeof( pxRequest->pucHash ) );
+
+            /* mbedTLS does not keep the hash for the calls which follow an
+             * MBEDTLS_ERR_ECP_IN_PROGRESS, so the request keeps a copy. */
+            ( void ) memcpy( pxRequest->pucHash, pucHash, xHashLen );
+            pxRequest->ulHashLen = xHashLen;
+            pxRequest->ulSigLen = sizeof( pxRequest->pucSig );
+            pxRequest->xP11PkCtx = pxEcDsaCtx->xP11PkCtx;
+            pxRequest->xRequester = xTaskGetCurrentTaskHandle();
+            pxRequest->xState = P11_SIGN_PENDING;
+
+            if( ( prvStartSignWorker() == pdTRUE ) &&
+                ( xQueueSend( xSignQueue, &pxRequest, 0 ) == pdPASS ) )
+            {
+                lResult = MBEDTLS_ERR_ECP_IN_PROGRESS;
+            }
+            else
+            {
+                /* The worker task is not available or is busy with other
+                 * signatures, so sign in this task. */
+                pxRequest->xState = P11_SIGN_IDLE;
+                lResult = p11_ecdsa_sign( pk, xMdAlg, pucHash, xHashLen,
+                                          pucSig, xSigBufferSize, pxSigLen,
+                                          plRng, pvRng );
+            }
+        }
+        else if( xState == P11_SIGN_PENDING )
+        {
+            lResult = MBEDTLS_ERR_ECP_IN_PROGRESS;
+        }
+        else if( pxRequest->xResult != CKR_OK )
+        {
+            LogError( ( "Failed to sign message using PKCS #11 with error code %02X.", pxRequest->xResult ) );
+            lResult = -1;
+        }
+        else if( pxRequest->ulSigLen >= xSigBufferSize )
+        {
+            LogError( ( "PKCS #11 signature of %lu bytes does not fit in the signature buffer.",
+                        ( unsigned long ) pxRequest->ulSigLen ) );
+            lResult = -1;
+        }
+        else
+        {
+            ( void ) memcpy( pucSig, pxRequest->pucSig, pxRequest->ulSigLen );
+            *pxSigLen = pxRequest->ulSigLen;
+            lResult = prvEcdsaSigToASN1InPlace( pucSig, xSigBufferSize, pxSigLen );
+        }
+
+        return lResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void * p11_ecdsa_rs_alloc( void )
+    {
+        P11SignRequest_t * pxRequest = NULL;
+
+        /* The worker task may free the request, so it comes from the FreeRTOS
+         * heap rather than the mbedTLS allocator. */
+        pxRequest = ( P11SignRequest_t * ) pvPortMalloc( sizeof( P11SignRequest_t ) );
+
+        if( pxRequest != NULL )
+        {
+            ( void ) memset( pxRequest, 0, sizeof( P11SignRequest_t ) );
+            pxRequest->xState = P11_SIGN_IDLE;
+            pxRequest->xAbandoned = pdFALSE;
+            pxRequest->xResult = CKR_OK;
+        }
+
+        return pxRequest;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void p11_ecdsa_rs_free( void * pvRsCtx )
+    {
+        P11SignRequest_t * pxRequest = ( P11SignRequest_t * ) pvRsCtx;
+        BaseType_t xFree = pdTRUE;
+
+        if( pxRequest != NULL )
+        {
+            taskENTER_CRITICAL();
+            {
+                if( pxRequest->xState == P11_SIGN_PENDING )
+                {
+                    /* The handshake was abandoned; the worker task frees the
+                     * request when it finishes signing. */
+                    pxRequest->xAbandoned = pdTRUE;
+                    xFree = pdFALSE;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( xFree == pdTRUE )
+            {
+                vPortFree( pxRequest );
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvStartSignWorker( void )
+    {
+        BaseType_t xRunning = pdFALSE;
+
+        /* Suspend the scheduler so that two connections cannot both create
+         * the queue and the worker task. */
+        vTaskSuspendAll();
+        {
+            if( xSignQueue == NULL )
+            {
+                xSignQueue = xQueueCreate( MBEDTLS_PKCS11_ASYNC_SIGN_QUEUE_LENGTH,
+                                           sizeof( P11SignRequest_t * ) );
+
+                if( ( xSignQueue != NULL ) &&
+                    ( xTaskCreate( prvSignWorkerTask,
+                                   "P11Sign",
+                                   MBEDTLS_PKCS11_ASYNC_SIGN_TASK_STACK_SIZE,
+                                   NULL,
+                                   MBEDTLS_PKCS11_ASYNC_SIGN_TASK_PRIORITY,
+                                   NULL ) != pdPASS ) )
+                {
+                    vQueueDelete( xSignQueue );
+                    xSignQueue = NULL;
+                }
+            }
+
+            xRunning = ( xSignQueue != NULL ) ? pdTRUE : pdFALSE;
+        }
+        ( void ) xTaskResumeAll();
+
+        if( xRunning == pdFALSE )
+        {
+            LogError( ( "Failed to start the PKCS #11 signing task." ) );
+        }
+
+        return xRunning;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvSignWorkerTask( void * pvParameters )
+    {
+        P11SignRequest_t * pxRequest = NULL;
+        CK_RV xResult = CKR_OK;
+        BaseType_t xAbandoned = pdFALSE;
+        TaskHandle_t xRequester = NULL;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            if( xQueueReceive( xSignQueue, &pxRequest, portMAX_DELAY ) == pdPASS )
+            {
+                xResult = prvP11EcdsaSign( &( pxRequest->xP11PkCtx ),
+                                           pxRequest->pucHash,
+                                           pxRequest->ulHashLen,
+                                           pxRequest->pucSig,
+                                           &( pxRequest->ulSigLen ) );
+
+                taskENTER_CRITICAL();
+                {
+                    pxRequest->xResult = xResult;
+                    pxRequest->xState = P11_SIGN_DONE;
+                    xAbandoned = pxRequest->xAbandoned;
+                    xRequester = pxRequest->xRequester;
+                }
+                taskEXIT_CRITICAL();
+
+                /* Once the state is DONE the requester may free the request,
+                 * so only the copies taken above are used from here on. */
+                if( xAbandoned == pdTRUE )
+                {
+                    vPortFree( pxRequest );
+                }
+                else
+                {
+                    ( void ) xTaskNotifyGiveIndexed( xRequester, MBEDTLS_PKCS11_ASYNC_SIGN_NOTIFY_INDEX );
+                }
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    BaseType_t xPKCS11_WaitForAsyncSign( TickType_t xTicksToWait )
+    {
+        uint32_t ulNotified = ulTaskNotifyTakeIndexed( MBEDTLS_PKCS11_ASYNC_SIGN_NOTIFY_INDEX,
+                                                       pdTRUE,
+                                                       xTicksToWait );
+
+        return ( ulNotified > 0U ) ? pdTRUE : pdFALSE;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* MBEDTLS_PKCS11_ASYNC_SIGN > 0 */
+
 static size_t p11_ecdsa_get_bitlen( const mbedtls_pk_context * pxMbedtlsPkCtx )
 {
     configASSERT( mbedtls_ecdsa_info.get_bitlen );
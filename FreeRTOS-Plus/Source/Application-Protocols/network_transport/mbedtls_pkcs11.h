@@ -32,6 +32,147 @@
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
 
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Compute PKCS #11 ECDSA signatures in a worker task.
+ *
+ * When non-zero, the mbedtls_pk context returned by
+ * #xPKCS11_initMbedtlsPkContext for an ECDSA key implements the restartable
+ * signing hooks of mbedTLS.  The first call queues the signature to a worker
+ * task and returns MBEDTLS_ERR_ECP_IN_PROGRESS, which the TLS layer reports as
+ * MBEDTLS_ERR_SSL_CRYPTO_IN_PROGRESS; the caller waits with
+ * #xPKCS11_WaitForAsyncSign and calls mbedtls_ssl_handshake again.  This lets
+ * a secure element that takes tens of milliseconds per signature sign in the
+ * background.  mbedTLS only uses these hooks in TLS 1.2 ECDHE-ECDSA handshakes
+ * while restartable ECC is enabled; RSA keys and all other uses still sign in
+ * the calling task.  Requires MBEDTLS_ECP_RESTARTABLE and MBEDTLS_ECDSA_C.
+ * Zero (the default) always signs in the calling task.
+ */
+#ifndef MBEDTLS_PKCS11_ASYNC_SIGN
+    #define MBEDTLS_PKCS11_ASYNC_SIGN    0
+#endif
+
+#if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+
+    #if !defined( MBEDTLS_ECP_RESTARTABLE ) || !defined( MBEDTLS_ECDSA_C )
+        #error "MBEDTLS_PKCS11_ASYNC_SIGN requires MBEDTLS_ECP_RESTARTABLE and MBEDTLS_ECDSA_C."
+    #endif
+
+/**
+ * @brief Number of signatures which may wait for the worker task.
+ *
+ * A signature which finds the queue full is computed in the calling task.
+ */
+    #ifndef MBEDTLS_PKCS11_ASYNC_SIGN_QUEUE_LENGTH
+        #define MBEDTLS_PKCS11_ASYNC_SIGN_QUEUE_LENGTH    4
+    #endif
+
+/**
+ * @brief Priority of the signing worker task.
+ */
+    #ifndef MBEDTLS_PKCS11_ASYNC_SIGN_TASK_PRIORITY
+        #define MBEDTLS_PKCS11_ASYNC_SIGN_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+    #endif
+
+/**
+ * @brief Stack size, in words, of the signing worker task.
+ */
+    #ifndef MBEDTLS_PKCS11_ASYNC_SIGN_TASK_STACK_SIZE
+        #define MBEDTLS_PKCS11_ASYNC_SIGN_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+    #endif
+
+/**
+ * @brief Task notification index used to wake the task waiting for a
+ * signature.
+ *
+ * Choose an index the application does not use for other notifications.
+ */
+    #ifndef MBEDTLS_PKCS11_ASYNC_SIGN_NOTIFY_INDEX
+        #define MBEDTLS_PKCS11_ASYNC_SIGN_NOTIFY_INDEX    tskDEFAULT_INDEX_TO_NOTIFY
+    #endif
+
+/**
+ * @brief Longest time, in milliseconds, the TLS transport waits for a
+ * notification before calling mbedtls_ssl_handshake again.
+ */
+    #ifndef MBEDTLS_PKCS11_ASYNC_SIGN_POLL_MS
+        #define MBEDTLS_PKCS11_ASYNC_SIGN_POLL_MS    100
+    #endif
+
+#endif /* MBEDTLS_PKCS11_ASYNC_SIGN > 0 */
+
+/**
+ * @brief Size, in bytes, of a pool of random bytes shared by all callers of
+ * #lMbedCryptoRngCallbackPKCS11.
+ *
+ * A handshake asks for random bytes many times, a few bytes at a time.  When
+ * non-zero, the pool is filled with one C_GenerateRandom call and the requests
+ * are served from it, so most of them do not reach the token.  Bytes are
+ * erased from the pool as they are handed out.  Zero (the default) calls
+ * C_GenerateRandom for every request.
+ */
+#ifndef MBEDTLS_PKCS11_RNG_POOL_SIZE
+    #define MBEDTLS_PKCS11_RNG_POOL_SIZE    0
+#endif
+
+#if ( MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 )
+
+/**
+ * @brief Refill the random pool from a low priority task.
+ *
+ * When non-zero, a task with its own PKCS #11 session tops the pool up once
+ * half of it has been used, so that requests are rarely delayed by a refill.
+ * A request which finds the pool empty still refills it in the calling task.
+ * Zero (the default) refills the pool only when it is empty.
+ */
+    #ifndef MBEDTLS_PKCS11_RNG_POOL_REFILL_TASK
+        #define MBEDTLS_PKCS11_RNG_POOL_REFILL_TASK    0
+    #endif
+
+/**
+ * @brief Priority of the random pool refill task.
+ */
+    #ifndef MBEDTLS_PKCS11_RNG_POOL_TASK_PRIORITY
+        #define MBEDTLS_PKCS11_RNG_POOL_TASK_PRIORITY    ( tskIDLE_PRIORITY )
+    #endif
+
+/**
+ * @brief Stack size, in words, of the random pool refill task.
+ */
+    #ifndef MBEDTLS_PKCS11_RNG_POOL_TASK_STACK_SIZE
+        #define MBEDTLS_PKCS11_RNG_POOL_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 2 )
+    #endif
+
+#endif /* MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 */
+
+/**
+ * @brief Count the random number requests and the C_GenerateRandom calls.
+ *
+ * When non-zero, #vPKCS11_GetRngStats reports the counters and the PKCS #11
+ * TLS transport logs, at debug level, the C_GenerateRandom calls made during
+ * each handshake.  Zero (the default) keeps no counters.
+ */
+#ifndef MBEDTLS_PKCS11_RNG_STATS
+    #define MBEDTLS_PKCS11_RNG_STATS    0
+#endif
+
+#if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+
+/**
+ * @brief Random number generation counters.
+ */
+    typedef struct PKCS11RngStats
+    {
+        uint32_t ulRequests;   /**< @brief Calls to #lMbedCryptoRngCallbackPKCS11. */
+        uint32_t ulBytes;      /**< @brief Random bytes returned to the callers. */
+        uint32_t ulTokenCalls; /**< @brief Calls to C_GenerateRandom, including pool refills. */
+    } PKCS11RngStats_t;
+
+#endif /* MBEDTLS_PKCS11_RNG_STATS > 0 */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -59,4 +200,35 @@ int lMbedCryptoRngCallbackPKCS11( void * pvCtx,
                                   unsigned char * pucOutput,
                                   size_t uxLen );
 
+#if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+
+/**
+ * @brief Read the random number generation counters.
+ *
+ * @param[out] pxStats Populated with the counters.
+ * @param[in] xReset pdTRUE to zero the counters after reading them.
+ */
+    void vPKCS11_GetRngStats( PKCS11RngStats_t * pxStats,
+                              BaseType_t xReset );
+
+#endif /* MBEDTLS_PKCS11_RNG_STATS > 0 */
+
+#if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+
+/**
+ * @brief Wait for a signature queued by the calling task to complete.
+ *
+ * Call after an mbedTLS function returns MBEDTLS_ERR_SSL_CRYPTO_IN_PROGRESS
+ * or MBEDTLS_ERR_ECP_IN_PROGRESS, then call that function again.  The
+ * function may return early, in which case calling it again reports that the
+ * signature is still in progress.
+ *
+ * @param[in] xTicksToWait Longest time to wait.
+ *
+ * @return pdTRUE if the worker task signalled completion, pdFALSE on timeout.
+ */
+    BaseType_t xPKCS11_WaitForAsyncSign( TickType_t xTicksToWait );
+
+#endif /* MBEDTLS_PKCS11_ASYNC_SIGN > 0 */
+
 #endif /* MBEDTLS_PKCS11_H */
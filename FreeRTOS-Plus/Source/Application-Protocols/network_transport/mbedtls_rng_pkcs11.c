@@ -41,8 +41,111 @@
  * @brief Implements an mbedtls RNG callback using the PKCS#11 API
  */
 
+#include <string.h>
+
 #include "core_pkcs11_config.h"
 #include "core_pkcs11.h"
+#include "mbedtls_pkcs11.h"
+
+#if ( MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 )
+    #include "semphr.h"
+    #include "transport_mutex.h"
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Fill a buffer with random bytes from the PKCS #11 module.
+ *
+ * @param[in] xSession PKCS #11 session to use.
+ * @param[out] pucOutput Buffer to fill.
+ * @param[in] uxLen Length of the buffer.
+ *
+ * @return CKR_OK on success.
+ */
+static CK_RV prvGenerateRandom( CK_SESSION_HANDLE xSession,
+                                unsigned char * pucOutput,
+                                size_t uxLen );
+
+#if ( MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 )
+
+/**
+ * @brief Serve a request from the random pool, refilling it when it is
+ * empty.
+ *
+ * @param[in] xSession PKCS #11 session used to refill the pool.
+ * @param[out] pucOutput Buffer to fill.
+ * @param[in] uxLen Length of the buffer.
+ *
+ * @return CKR_OK on success.
+ */
+    static CK_RV prvRngPoolRead( CK_SESSION_HANDLE xSession,
+                                 unsigned char * pucOutput,
+                                 size_t uxLen );
+
+/**
+ * @brief Fill the unused part of the random pool.
+ *
+ * The pool mutex must be held.
+ *
+ * @param[in] xSession PKCS #11 session to use.
+ *
+ * @return CKR_OK on success.
+ */
+    static CK_RV prvRngPoolRefill( CK_SESSION_HANDLE xSession );
+
+    #if ( MBEDTLS_PKCS11_RNG_POOL_REFILL_TASK > 0 )
+
+/**
+ * @brief Task which tops the random pool up when it is notified.
+ *
+ * @param[in] pvParameters Unused.
+ */
+        static void prvRngPoolRefillTask( void * pvParameters );
+
+/**
+ * @brief Wake the refill task, creating it on first use.
+ *
+ * The pool mutex must be held.
+ */
+        static void prvRngPoolSignalRefill( void );
+    #endif
+
+/**
+ * @brief Random bytes not yet handed out.
+ *
+ * The first #uxRngPoolAvailable bytes are unused and the rest are zero.
+ * Requests take bytes from the end of the unused part, so a refill only
+ * writes the contiguous space after it.
+ */
+    static unsigned char ucRngPool[ MBEDTLS_PKCS11_RNG_POOL_SIZE ];
+
+/**
+ * @brief Number of unused bytes at the start of #ucRngPool.
+ */
+    static size_t uxRngPoolAvailable = 0;
+
+/**
+ * @brief Mutex protecting the random pool.
+ */
+    static SemaphoreHandle_t xRngPoolMutex = NULL;
+
+    #if ( MBEDTLS_PKCS11_RNG_POOL_REFILL_TASK > 0 )
+
+/**
+ * @brief Handle of the refill task, or NULL before it is created.
+ */
+        static TaskHandle_t xRngPoolRefillTask = NULL;
+    #endif
+#endif /* MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 */
+
+#if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+
+/**
+ * @brief Random number generation counters.
+ */
+    static PKCS11RngStats_t xRngStats = { 0 };
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -51,7 +154,6 @@ int lMbedCryptoRngCallbackPKCS11( void * pvCtx,
                                   size_t uxLen )
 {
     int lRslt;
-    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
     CK_SESSION_HANDLE * pxSessionHandle = ( CK_SESSION_HANDLE * ) pvCtx;
 
     if( pucOutput == NULL )
@@ -65,21 +167,223 @@ int lMbedCryptoRngCallbackPKCS11( void * pvCtx,
     }
     else
     {
-        lRslt = ( int ) C_GetFunctionList( &pxFunctionList );
+        #if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+            taskENTER_CRITICAL();
+            {
+                xRngStats.ulRequests++;
+                xRngStats.ulBytes += ( uint32_t ) uxLen;
+            }
+            taskEXIT_CRITICAL();
+        #endif
+
+        #if ( MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 )
+            lRslt = ( int ) prvRngPoolRead( *pxSessionHandle, pucOutput, uxLen );
+        #else
+            lRslt = ( int ) prvGenerateRandom( *pxSessionHandle, pucOutput, uxLen );
+        #endif
     }
 
-    if( ( lRslt != CKR_OK ) ||
+    return lRslt;
+}
+
+/*-----------------------------------------------------------*/
+
+static CK_RV prvGenerateRandom( CK_SESSION_HANDLE xSession,
+                                unsigned char * pucOutput,
+                                size_t uxLen )
+{
+    CK_RV xResult;
+    CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+
+    xResult = C_GetFunctionList( &pxFunctionList );
+
+    if( ( xResult != CKR_OK ) ||
         ( pxFunctionList == NULL ) ||
         ( pxFunctionList->C_GenerateRandom == NULL ) )
     {
-        lRslt = -1;
+        xResult = CKR_FUNCTION_FAILED;
     }
     else
     {
-        lRslt = ( int ) pxFunctionList->C_GenerateRandom( *pxSessionHandle, pucOutput, uxLen );
+        #if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+            taskENTER_CRITICAL();
+            {
+                xRngStats.ulTokenCalls++;
+            }
+            taskEXIT_CRITICAL();
+        #endif
+
+        xResult = pxFunctionList->C_GenerateRandom( xSession, pucOutput, uxLen );
     }
 
-    return lRslt;
+    return xResult;
 }
 
 /*-----------------------------------------------------------*/
+
+#if ( MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 )
+
+    static CK_RV prvRngPoolRead( CK_SESSION_HANDLE xSession,
+                                 unsigned char * pucOutput,
+                                 size_t uxLen )
+    {
+        CK_RV xResult = CKR_OK;
+        size_t uxRemaining = uxLen;
+        size_t uxChunk = 0;
+        BaseType_t xLocked = TLS_Mutex_Take( &xRngPoolMutex );
+
+        if( xLocked == pdFALSE )
+        {
+            /* Without the pool, ask the token directly. */
+            xResult = prvGenerateRandom( xSession, pucOutput, uxLen );
+            uxRemaining = 0;
+        }
+
+        while( ( xResult == CKR_OK ) && ( uxRemaining > 0U ) )
+        {
+            if( uxRngPoolAvailable == 0U )
+            {
+                xResult = prvRngPoolRefill( xSession );
+            }
+
+            if( xResult == CKR_OK )
+            {
+                uxChunk = ( uxRemaining < uxRngPoolAvailable ) ? uxRemaining : uxRngPoolAvailable;
+                uxRngPoolAvailable -= uxChunk;
+
+                ( void ) memcpy( &( pucOutput[ uxLen - uxRemaining ] ),
+                                 &( ucRngPool[ uxRngPoolAvailable ] ),
+                                 uxChunk );
+
+                /* Never hand the same bytes out twice. */
+                ( void ) memset( &( ucRngPool[ uxRngPoolAvailable ] ), 0, uxChunk );
+                uxRemaining -= uxChunk;
+            }
+        }
+
+        if( xLocked == pdTRUE )
+        {
+            #if ( MBEDTLS_PKCS11_RNG_POOL_REFILL_TASK > 0 )
+                if( uxRngPoolAvailable < ( MBEDTLS_PKCS11_RNG_POOL_SIZE / 2U ) )
+                {
+                    prvRngPoolSignalRefill();
+                }
+            #endif
+
+            ( void ) xSemaphoreGive( xRngPoolMutex );
+        }
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static CK_RV prvRngPoolRefill( CK_SESSION_HANDLE xSession )
+    {
+        CK_RV xResult = CKR_OK;
+
+        if( uxRngPoolAvailable < MBEDTLS_PKCS11_RNG_POOL_SIZE )
+        {
+            xResult = prvGenerateRandom( xSession,
+                                         &( ucRngPool[ uxRngPoolAvailable ] ),
+                                         MBEDTLS_PKCS11_RNG_POOL_SIZE - uxRngPoolAvailable );
+
+            if( xResult == CKR_OK )
+            {
+                uxRngPoolAvailable = MBEDTLS_PKCS11_RNG_POOL_SIZE;
+            }
+            else
+            {
+                LogError( ( "Failed to refill the random pool from the PKCS #11 module." ) );
+                ( void ) memset( &( ucRngPool[ uxRngPoolAvailable ] ), 0,
+                                 MBEDTLS_PKCS11_RNG_POOL_SIZE - uxRngPoolAvailable );
+            }
+        }
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    #if ( MBEDTLS_PKCS11_RNG_POOL_REFILL_TASK > 0 )
+
+        static void prvRngPoolSignalRefill( void )
+        {
+            if( xRngPoolRefillTask == NULL )
+            {
+                if( xTaskCreate( prvRngPoolRefillTask,
+                                 "P11Rng",
+                                 MBEDTLS_PKCS11_RNG_POOL_TASK_STACK_SIZE,
+                                 NULL,
+                                 MBEDTLS_PKCS11_RNG_POOL_TASK_PRIORITY,
+                                 &xRngPoolRefillTask ) != pdPASS )
+                {
+                    LogError( ( "Failed to create the random pool refill task." ) );
+                    xRngPoolRefillTask = NULL;
+                }
+            }
+
+            if( xRngPoolRefillTask != NULL )
+            {
+                ( void ) xTaskNotifyGive( xRngPoolRefillTask );
+            }
+        }
+
+/*-----------------------------------------------------------*/
+
+        static void prvRngPoolRefillTask( void * pvParameters )
+        {
+            CK_SESSION_HANDLE xSession = CK_INVALID_HANDLE;
+
+            ( void ) pvParameters;
+
+            for( ; ; )
+            {
+                ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+                /* The callers' sessions may be closed at any time, so the
+                 * task opens its own. */
+                if( ( xSession == CK_INVALID_HANDLE ) &&
+                    ( xInitializePkcs11Session( &xSession ) != CKR_OK ) )
+                {
+                    LogError( ( "Failed to open a PKCS #11 session for the random pool." ) );
+                    xSession = CK_INVALID_HANDLE;
+                }
+
+                if( ( xSession != CK_INVALID_HANDLE ) &&
+                    ( TLS_Mutex_Take( &xRngPoolMutex ) == pdTRUE ) )
+                {
+                    ( void ) prvRngPoolRefill( xSession );
+                    ( void ) xSemaphoreGive( xRngPoolMutex );
+                }
+            }
+        }
+
+/*-----------------------------------------------------------*/
+
+    #endif /* MBEDTLS_PKCS11_RNG_POOL_REFILL_TASK > 0 */
+
+#endif /* MBEDTLS_PKCS11_RNG_POOL_SIZE > 0 */
+
+#if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+
+    void vPKCS11_GetRngStats( PKCS11RngStats_t * pxStats,
+                              BaseType_t xReset )
+    {
+        configASSERT( pxStats != NULL );
+
+        taskENTER_CRITICAL();
+        {
+            *pxStats = xRngStats;
+
+            if( xReset == pdTRUE )
+            {
+                ( void ) memset( &xRngStats, 0, sizeof( xRngStats ) );
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* MBEDTLS_PKCS11_RNG_STATS > 0 */
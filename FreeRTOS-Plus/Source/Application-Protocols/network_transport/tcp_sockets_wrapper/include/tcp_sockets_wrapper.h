@@ -39,6 +39,9 @@
 /* FreeRTOS Kernel includes. */
 #include "FreeRTOS.h"
 
+/* Transport interface include, for TransportOutVector_t. */
+#include "transport_interface.h"
+
 /* Error codes. */
 #define TCP_SOCKETS_ERRNO_NONE                ( 0 )   /*!< No error. */
 #define TCP_SOCKETS_ERRNO_ERROR               ( -1 )  /*!< Catch-all sockets error code. */
@@ -58,6 +61,18 @@
     typedef struct xSOCKET * Socket_t; /**< @brief Socket handle data type. */
 #endif
 
+/**
+ * @brief Send statistics of a socket, see TCP_Sockets_GetSendStats().
+ */
+typedef struct TCPSocketsSendStats
+{
+    uint32_t bytesSent;      /**< @brief Bytes accepted by the modem or stack. */
+    uint32_t sendCount;      /**< @brief Data-send commands completed. */
+    uint32_t creditWaits;    /**< @brief Sends that found the send pipeline full. */
+    uint32_t maxOutstanding; /**< @brief Most sends outstanding at once. */
+    uint32_t bytesPerSecond; /**< @brief Throughput from the first send to the latest completed one. */
+} TCPSocketsSendStats_t;
+
 /**
  * @brief Establish a connection to server.
  *
@@ -69,6 +84,15 @@
  *
  * @note A timeout of 0 means infinite timeout.
  *
+ * @note The host name is resolved through the resolver cache of
+ * Utilities/dns_cache, and its entry is removed if the connection fails.
+ *
+ * @note With FreeRTOS+TCP built with ipconfigUSE_IPv6, a host which has both
+ * an IPv6 and an IPv4 address is connected to as in RFC 8305: the address
+ * family which last succeeded for the host, or else IPv6, is tried first and
+ * the other family is tried as well if it has not connected within
+ * FREERTOS_SOCKETS_WRAPPER_ATTEMPT_DELAY_MS.  The first connection wins.
+ *
  * @return Non-zero value on error, 0 on success.
  */
 BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
@@ -77,6 +101,52 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
                                 uint32_t receiveTimeoutMs,
                                 uint32_t sendTimeoutMs );
 
+/**
+ * @brief Begin a connection to server, without waiting for it to be established.
+ *
+ * The host name is resolved before returning.  The socket is left with zero
+ * receive and send timeouts, so that it can be used without blocking; call
+ * TCP_Sockets_ConnectPoll() until it reports the connection established, and
+ * then TCP_Sockets_SetTimeouts() for the timeouts wanted afterwards.
+ *
+ * @param[out] pTcpSocket The output parameter to return the created socket descriptor.
+ * @param[in] pHostName Server hostname to connect to.
+ * @param[in] port Server port to connect to.
+ *
+ * @return Non-zero value on error, 0 if the connection was begun.
+ */
+BaseType_t TCP_Sockets_ConnectStart( Socket_t * pTcpSocket,
+                                     const char * pHostName,
+                                     uint16_t port );
+
+/**
+ * @brief Check on a connection begun by TCP_Sockets_ConnectStart().
+ *
+ * After an error, the socket must still be released with
+ * TCP_Sockets_Disconnect().
+ *
+ * @param[in] tcpSocket The socket descriptor.
+ *
+ * @return
+ * * TCP_SOCKETS_ERRNO_NONE once the connection is established.
+ * * TCP_SOCKETS_ERRNO_EWOULDBLOCK while it is being established.
+ * * Any other negative value if it failed. @ref SocketsErrors
+ */
+BaseType_t TCP_Sockets_ConnectPoll( Socket_t tcpSocket );
+
+/**
+ * @brief Set the timeouts of a connected socket.
+ *
+ * @param[in] tcpSocket The socket descriptor.
+ * @param[in] receiveTimeoutMs Timeout (in milliseconds) for transport receive.
+ * @param[in] sendTimeoutMs Timeout (in milliseconds) for transport send.
+ *
+ * @return Non-zero value on error, 0 on success.
+ */
+BaseType_t TCP_Sockets_SetTimeouts( Socket_t tcpSocket,
+                                    uint32_t receiveTimeoutMs,
+                                    uint32_t sendTimeoutMs );
+
 /**
  * @brief End connection to server.
  *
@@ -84,6 +154,18 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
  */
 void TCP_Sockets_Disconnect( Socket_t tcpSocket );
 
+/**
+ * @brief Resolve again the cached host names which are in use and about to
+ * expire, so that the next connection to them does not wait for the resolver.
+ *
+ * Does nothing unless dnscachePREFETCH_MS is set.  Call it periodically, more
+ * often than dnscachePREFETCH_MS, from a task which may block on the
+ * resolver.
+ *
+ * @return The number of host names resolved again.
+ */
+UBaseType_t TCP_Sockets_DnsPrefetch( void );
+
 /**
  * @brief Transmit data to the remote socket.
  *
@@ -101,6 +183,122 @@ int32_t TCP_Sockets_Send( Socket_t xSocket,
                           const void * pvBuffer,
                           size_t xDataLength );
 
+/**
+ * @brief Transmit the data of several buffers to the remote socket.
+ *
+ * The buffers are sent in order, as if they were one contiguous buffer.  The
+ * socket must have already been created using a call to TCP_Sockets_Connect().
+ *
+ * @param[in] xSocket The handle of the sending socket.
+ * @param[in] pxVectors The buffers containing the data to be sent.
+ * @param[in] xVectorCount The number of buffers in @p pxVectors.
+ *
+ * @return
+ * * On success, the number of bytes actually sent is returned.  This is fewer
+ *   than the total length of the buffers if sending stopped part way.
+ * * If an error occurred before any data was sent, a negative value is
+ *   returned. @ref SocketsErrors
+ */
+int32_t TCP_Sockets_SendVector( Socket_t xSocket,
+                                const TransportOutVector_t * pxVectors,
+                                size_t xVectorCount );
+
+/**
+ * @brief Hold back small sends so that they leave the socket together.
+ *
+ * While a socket is corked, the data of small sends is collected instead of
+ * being passed on one send at a time, as with TCP_CORK.  Uncorking sends the
+ * collected data; cork again afterwards to collect more.  Uncork before
+ * waiting for a reply to the collected data.
+ *
+ * @note The FreeRTOS+TCP port only sends full-size segments while corked.  The
+ * cellular port collects the data in a per-socket buffer of
+ * CELLULAR_SOCKET_SEND_BUFFER_SIZE bytes, which it also sends before a receive
+ * and once the data is older than CELLULAR_SOCKET_CORK_DEADLINE_MS; it sends
+ * every send at once if the buffer size is zero.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[in] xCork pdTRUE to cork the socket, pdFALSE to uncork it.
+ *
+ * @return
+ * * TCP_SOCKETS_ERRNO_NONE on success.
+ * * Otherwise a negative value, including if the collected data could not be
+ *   sent on uncorking. @ref SocketsErrors
+ */
+BaseType_t TCP_Sockets_SetCork( Socket_t xSocket,
+                                BaseType_t xCork );
+
+/**
+ * @brief Let the next connection to the same server carry on over the
+ * connection of this socket instead of opening a new one.
+ *
+ * Mark the socket before TCP_Sockets_Disconnect(), once the application
+ * protocol has reached a point where the server keeps the connection open for
+ * another exchange, for example after an HTTP/1.1 response without
+ * "Connection: close".  The socket is then only kept if it is still connected
+ * and no data is left over in either direction, and the next
+ * TCP_Sockets_Connect() to the same host name and port returns it.
+ *
+ * @note Only the cellular port pools sockets, up to CELLULAR_SOCKET_POOL_SIZE
+ * of them, each for up to CELLULAR_SOCKET_POOL_IDLE_MS.  This saves the AT
+ * command round trips of opening a modem socket.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[in] xReuse pdTRUE to keep the socket on disconnect, pdFALSE to close it.
+ *
+ * @return
+ * * TCP_SOCKETS_ERRNO_NONE on success.
+ * * TCP_SOCKETS_ERRNO_ENOPROTOOPT if the port does not pool sockets.
+ * * Otherwise a negative value. @ref SocketsErrors
+ */
+BaseType_t TCP_Sockets_SetReuse( Socket_t xSocket,
+                                 BaseType_t xReuse );
+
+/**
+ * @brief Keep sockets to a server opened ahead, so that TCP_Sockets_Connect()
+ * to it does not wait for the socket to open.
+ *
+ * Opens sockets to the host name and port until @p uxCount of them are
+ * pooled, and opens more whenever a connection is disconnected.  Any
+ * application protocol can use them, as they were never used before.  A count
+ * of zero stops opening sockets for the server, and those already open are
+ * closed once idle.
+ *
+ * @note Only the cellular port pools sockets; see TCP_Sockets_SetReuse().
+ *
+ * @param[in] pHostName The host name of the server, as passed to TCP_Sockets_Connect().
+ * @param[in] port The port of the server.
+ * @param[in] uxCount The number of sockets to keep open.
+ *
+ * @return
+ * * TCP_SOCKETS_ERRNO_NONE on success, even if not all the sockets opened.
+ * * TCP_SOCKETS_ERRNO_ENOSPC if servers are reserved for every pool entry.
+ * * TCP_SOCKETS_ERRNO_ENOPROTOOPT if the port does not pool sockets.
+ * * Otherwise a negative value. @ref SocketsErrors
+ */
+BaseType_t TCP_Sockets_Reserve( const char * pHostName,
+                                uint16_t port,
+                                UBaseType_t uxCount );
+
+/**
+ * @brief Get the send statistics of a socket.
+ *
+ * @note The cellular port counts every data-send command it passes to the
+ * modem.  With CELLULAR_SOCKET_SEND_PIPELINE_DEPTH set, up to that many sends
+ * are outstanding while the caller continues.  The FreeRTOS+TCP port has no
+ * per-command figures, as the stack sends from the Tx stream by itself.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[out] pStats Filled in with the statistics.
+ *
+ * @return
+ * * TCP_SOCKETS_ERRNO_NONE on success.
+ * * TCP_SOCKETS_ERRNO_ENOPROTOOPT if the port keeps no send statistics.
+ * * Otherwise a negative value. @ref SocketsErrors
+ */
+BaseType_t TCP_Sockets_GetSendStats( Socket_t xSocket,
+                                     TCPSocketsSendStats_t * pStats );
+
 /**
  * @brief Receive data from a TCP socket.
  *
@@ -122,4 +320,43 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
                           void * pvBuffer,
                           size_t xBufferLength );
 
+/**
+ * @brief Receive data from a TCP socket without copying it.
+ *
+ * Waits like TCP_Sockets_Recv() for data, and then points @p ppvData at the
+ * received data where the socket holds it.  The data stays in the socket, and
+ * is returned again by the next receive, until it is released with
+ * TCP_Sockets_RecvRelease().  Only data stored contiguously is returned, so
+ * fewer bytes than are available may be returned.
+ *
+ * @param[in] xSocket The handle of the socket from which data is being received.
+ * @param[out] ppvData Set to point at the received data.
+ * @param[in] xMaxLength The maximum number of bytes to return.
+ *
+ * @return
+ * * If the receive was successful then the number of bytes at @p ppvData is
+ *   returned.
+ * * If a timeout occurred before data could be received then 0 is returned.
+ * * TCP_SOCKETS_ERRNO_ENOPROTOOPT if the port cannot receive without copying;
+ *   use TCP_Sockets_Recv() instead.
+ * * If another error occurred, a negative value is returned. @ref SocketsErrors
+ */
+int32_t TCP_Sockets_RecvZeroCopy( Socket_t xSocket,
+                                  const void ** ppvData,
+                                  size_t xMaxLength );
+
+/**
+ * @brief Release data returned by TCP_Sockets_RecvZeroCopy().
+ *
+ * @param[in] xSocket The handle of the socket from which data was received.
+ * @param[in] xLength The number of bytes to release, at most the number
+ * returned by TCP_Sockets_RecvZeroCopy().
+ *
+ * @return
+ * * On success, the number of bytes released is returned.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+int32_t TCP_Sockets_RecvRelease( Socket_t xSocket,
+                                 size_t xLength );
+
 #endif /* ifndef TCP_SOCKETS_WRAPPER_H */
@@ -58,6 +58,9 @@ extern void vLoggingPrintf( const char * pcFormatString,
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "event_groups.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
 
 /* TCP sockets wrapper includes. */
 #include "tcp_sockets_wrapper.h"
@@ -67,6 +70,9 @@ extern void vLoggingPrintf( const char * pcFormatString,
 #include "cellular_config_defaults.h"
 #include "cellular_api.h"
 
+/* Resolver cache shared by the sockets wrapper ports. */
+#include "dns_cache.h"
+
 /* Configure logs for the functions in this file. */
 #include "logging_levels.h"
 #ifndef LIBRARY_LOG_NAME
@@ -88,6 +94,10 @@ extern CellularHandle_t CellularHandle;
 /* coverity[misra_c_2012_rule_8_6_violation] */
 extern uint8_t CellularSocketPdnContextId;
 
+#if ( dnscacheADDRESS_SIZE < ( CELLULAR_IP_ADDRESS_MAX_SIZE + 1U ) )
+    #error "dnscacheADDRESS_SIZE must hold a cellular IP address and its terminating null."
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Windows simulator implementation. */
@@ -122,6 +132,72 @@ extern uint8_t CellularSocketPdnContextId;
 /* Invalid socket. */
 #define CELLULAR_INVALID_SOCKET                ( ( Socket_t ) ~0U )
 
+/* Size of the per-socket receive buffer. When non-zero, a receive smaller than
+ * this reads as much as the buffer holds from the modem, and later receives are
+ * served from the buffer until it is empty, saving a modem round trip for each
+ * small read. Zero reads from the modem for every receive. */
+#ifndef CELLULAR_SOCKET_RECV_BUFFER_SIZE
+    #define CELLULAR_SOCKET_RECV_BUFFER_SIZE    ( 0U )
+#endif
+
+/* Size of the per-socket send buffer used while a socket is corked with
+ * TCP_Sockets_SetCork(). Small sends are collected in it and passed to the
+ * modem in one Cellular_SocketSend() when it fills, when the socket is uncorked
+ * or receives, or when a send finds the oldest collected data older than
+ * CELLULAR_SOCKET_CORK_DEADLINE_MS. Zero disables corking. */
+#ifndef CELLULAR_SOCKET_SEND_BUFFER_SIZE
+    #define CELLULAR_SOCKET_SEND_BUFFER_SIZE    ( 0U )
+#endif
+
+#ifndef CELLULAR_SOCKET_CORK_DEADLINE_MS
+    #define CELLULAR_SOCKET_CORK_DEADLINE_MS    ( 20U )
+#endif
+
+/* Number of sends each socket may have outstanding in the send pipeline. When
+ * non-zero, TCP_Sockets_Send() copies the data into one of that many slots of
+ * CELLULAR_SOCKET_SEND_SLOT_SIZE bytes and returns, and a send task passes the
+ * slots to the modem in order. The caller only waits when all the slots are in
+ * use, so it can prepare the next data while the modem completes the previous
+ * send. Zero sends from the calling task. */
+#ifndef CELLULAR_SOCKET_SEND_PIPELINE_DEPTH
+    #define CELLULAR_SOCKET_SEND_PIPELINE_DEPTH    ( 0U )
+#endif
+
+#ifndef CELLULAR_SOCKET_SEND_SLOT_SIZE
+    #define CELLULAR_SOCKET_SEND_SLOT_SIZE         ( 1460U )
+#endif
+
+#ifndef CELLULAR_SOCKET_SEND_TASK_PRIORITY
+    #define CELLULAR_SOCKET_SEND_TASK_PRIORITY     ( tskIDLE_PRIORITY + 1U )
+#endif
+
+#ifndef CELLULAR_SOCKET_SEND_TASK_STACK_SIZE
+    #define CELLULAR_SOCKET_SEND_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4U )
+#endif
+
+/* Number of modem sockets kept open between connections. When non-zero,
+ * TCP_Sockets_Disconnect() keeps a socket marked with TCP_Sockets_SetReuse()
+ * open if it is still connected and has no unread data, and the next
+ * TCP_Sockets_Connect() to the same host name and port takes it instead of
+ * opening a modem socket. TCP_Sockets_Reserve() keeps sockets to an endpoint
+ * opened ahead of those connections in the same pool. Zero closes every socket
+ * on disconnect. */
+#ifndef CELLULAR_SOCKET_POOL_SIZE
+    #define CELLULAR_SOCKET_POOL_SIZE              ( 0U )
+#endif
+
+/* Time a socket stays in the pool before it is closed, as servers close idle
+ * connections after a while. */
+#ifndef CELLULAR_SOCKET_POOL_IDLE_MS
+    #define CELLULAR_SOCKET_POOL_IDLE_MS           ( 30000U )
+#endif
+
+/* Size of the host names kept to match pooled sockets, including the
+ * terminating null. Sockets to longer host names are not pooled. */
+#ifndef CELLULAR_SOCKET_POOL_HOST_NAME_SIZE
+    #define CELLULAR_SOCKET_POOL_HOST_NAME_SIZE    ( 64U )
+#endif
+
 /*-----------------------------------------------------------*/
 
 typedef struct xSOCKET
@@ -133,8 +209,52 @@ typedef struct xSOCKET
     TickType_t sendTimeout;
 
     EventGroupHandle_t socketEventGroupHandle;
+
+    #if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U )
+        uint8_t recvBuffer[ CELLULAR_SOCKET_RECV_BUFFER_SIZE ];
+        size_t recvBufferOffset; /* Offset of the first unread byte in recvBuffer. */
+        size_t recvBufferLength; /* Number of unread bytes in recvBuffer. */
+    #endif
+
+    #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+        uint8_t sendBuffer[ CELLULAR_SOCKET_SEND_BUFFER_SIZE ];
+        size_t sendBufferLength;    /* Number of bytes waiting in sendBuffer. */
+        uint64_t sendBufferStartMs; /* Time the oldest byte in sendBuffer was queued. */
+        BaseType_t isCorked;        /* Whether small sends are collected in sendBuffer. */
+    #endif
+
+    #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+        uint8_t sendSlots[ CELLULAR_SOCKET_SEND_PIPELINE_DEPTH ][ CELLULAR_SOCKET_SEND_SLOT_SIZE ];
+        size_t sendSlotLength[ CELLULAR_SOCKET_SEND_PIPELINE_DEPTH ];
+        size_t sendSlotHead;                   /* Next slot to fill, used by the sending task. */
+        size_t sendSlotTail;                   /* Next slot to send, used by the send task. */
+        SemaphoreHandle_t sendCredits;         /* Counts the free slots. */
+        volatile BaseType_t sendPipelineError; /* First error of a pipelined send. */
+    #endif
+
+    #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+        char hostName[ CELLULAR_SOCKET_POOL_HOST_NAME_SIZE ]; /* Host name connected to, empty if too long to pool. */
+        uint16_t port;                                        /* Server port connected to. */
+        BaseType_t isReusable;                                /* Set by TCP_Sockets_SetReuse(). */
+        uint64_t parkedMs;                                    /* Time the socket was put in the pool. */
+    #endif
+
+    TCPSocketsSendStats_t sendStats;
+    uint64_t sendStartMs;    /* Time of the first send. */
+    uint64_t sendCompleteMs; /* Time the modem accepted the latest send. */
 } cellularSocketWrapper_t;
 
+#if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+
+/* Number of sockets TCP_Sockets_Reserve() keeps open to an endpoint. */
+    typedef struct cellularSocketReserve
+    {
+        char hostName[ CELLULAR_SOCKET_POOL_HOST_NAME_SIZE ];
+        uint16_t port;
+        UBaseType_t count; /* Zero if the entry is free. */
+    } cellularSocketReserve_t;
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -164,6 +284,108 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
                                           uint8_t * buf,
                                           size_t len );
 
+#if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U )
+
+/**
+ * @brief Receive data from cellular socket through the socket receive buffer.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[out] buf The data buffer for receiving data.
+ * @param[in] len The length of the data buffer
+ *
+ * @note Buffered data is returned without touching the modem. Otherwise a
+ * receive of at least CELLULAR_SOCKET_RECV_BUFFER_SIZE bytes reads directly into
+ * buf, and a smaller one refills the receive buffer first. The timeout behaves
+ * as for prvNetworkRecvCellular.
+ *
+ * @return Positive value indicate the number of bytes received. Otherwise, error code defined
+ * in sockets_wrapper.h is returned.
+ */
+    static BaseType_t prvNetworkRecvBuffered( cellularSocketWrapper_t * pCellularSocketContext,
+                                              uint8_t * buf,
+                                              size_t len );
+#endif /* if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U ) */
+
+/**
+ * @brief Send data to cellular socket.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[in] buf The data to send.
+ * @param[in] len The length of the data.
+ *
+ * @note This function sends the data until timeout or data is completely sent to server.
+ *
+ * @return The number of bytes sent, 0 if the socket is closed, or TCP_SOCKETS_ERRNO_ERROR.
+ */
+static BaseType_t prvNetworkSendCellular( const cellularSocketWrapper_t * pCellularSocketContext,
+                                          const uint8_t * buf,
+                                          size_t len );
+
+/**
+ * @brief Count data accepted by the modem in the send statistics of a socket.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[in] sentLength The number of bytes the modem accepted.
+ */
+static void prvUpdateSendStats( cellularSocketWrapper_t * pCellularSocketContext,
+                                BaseType_t sentLength );
+
+/**
+ * @brief Send data to cellular socket, through the send pipeline if there is one.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ * @param[in] buf The data to send.
+ * @param[in] len The length of the data.
+ *
+ * @note With a send pipeline, the data is only copied to free send slots, and an
+ * error of an earlier pipelined send is returned by a later call.
+ *
+ * @return The number of bytes sent or queued, 0 if the socket is closed or no
+ * slot became free within the send timeout, or a negative error code.
+ */
+static BaseType_t prvSocketSend( cellularSocketWrapper_t * pCellularSocketContext,
+                                 const uint8_t * buf,
+                                 size_t len );
+
+#if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+
+/**
+ * @brief Create the send task and its queue, if not created yet.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE on success, or TCP_SOCKETS_ERRNO_ENOMEM.
+ */
+    static BaseType_t prvStartSendTask( void );
+
+/**
+ * @brief The send task, which passes the filled send slots of all the sockets to
+ * the modem in the order they were filled.
+ *
+ * @param[in] pvParameters Not used.
+ */
+    static void prvSendTask( void * pvParameters );
+
+/**
+ * @brief Wait until the send task has sent all the filled slots of a socket.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ */
+    static void prvDrainSendPipeline( cellularSocketWrapper_t * pCellularSocketContext );
+#endif /* if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U ) */
+
+#if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+
+/**
+ * @brief Pass the data collected in the socket send buffer to the modem.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context for socket operations.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE if the send buffer is empty afterwards,
+ * TCP_SOCKETS_ERRNO_ENOSPC if the send timed out with data left in it, or
+ * TCP_SOCKETS_ERRNO_ERROR.
+ */
+    static BaseType_t prvFlushSendBuffer( cellularSocketWrapper_t * pCellularSocketContext );
+#endif
+
 /**
  * @brief Callback used to inform about the status of socket open.
  *
@@ -239,6 +461,113 @@ static BaseType_t prvSetupSocketSendTimeout( cellularSocketWrapper_t * pCellular
 static BaseType_t prvCellularSocketRegisterCallback( CellularSocketHandle_t cellularSocketHandle,
                                                      cellularSocketWrapper_t * pCellularSocketContext );
 
+/**
+ * @brief Create a cellular socket and begin its connection to a server.
+ *
+ * @param[out] ppCellularSocketContext The created socket context, or NULL on error.
+ * @param[in] pHostName Server hostname to connect to.
+ * @param[in] port Server port to connect to.
+ * @param[in] receiveTimeoutMs Timeout (in milliseconds) for transport receive.
+ * @param[in] sendTimeoutMs Timeout (in milliseconds) for transport send.
+ *
+ * @return On success, TCP_SOCKETS_ERRNO_NONE is returned. If an error occurred, error code defined
+ * in sockets_wrapper.h is returned.
+ */
+static BaseType_t prvCellularSocketConnectStart( cellularSocketWrapper_t ** ppCellularSocketContext,
+                                                 const char * pHostName,
+                                                 uint16_t port,
+                                                 uint32_t receiveTimeoutMs,
+                                                 uint32_t sendTimeoutMs );
+
+/**
+ * @brief Resolve a host name through the modem, for the resolver cache.
+ *
+ * @param[in] pHostName Server hostname to resolve.
+ * @param[out] pAddress Filled in with the address in text form.
+ * @param[in, out] pTtlMs Left at the default, as the modem does not report
+ * the time to live.
+ *
+ * @return pdPASS if the host name was resolved, otherwise pdFAIL.
+ */
+static BaseType_t prvDnsResolve( const char * pHostName,
+                                 void * pAddress,
+                                 uint32_t * pTtlMs );
+
+/**
+ * @brief Find the address to connect to for a host name.  Addresses are used
+ * as they are, and other names are resolved through the resolver cache.
+ *
+ * @param[in] pHostName Server hostname to connect to.
+ * @param[out] pAddress The CELLULAR_IP_ADDRESS_MAX_SIZE + 1 bytes to fill in.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE on success, otherwise TCP_SOCKETS_ERRNO_ERROR.
+ */
+static BaseType_t prvResolveServerAddress( const char * pHostName,
+                                           char * pAddress );
+
+#if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+
+/**
+ * @brief Check whether a pooled socket can no longer be handed out.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context of the pooled socket.
+ * @param[in] currentTimeMs The current time from getTimeMs().
+ *
+ * @return True if the socket failed to open, was closed by the server, received
+ * data nobody asked for, or stayed in the pool for CELLULAR_SOCKET_POOL_IDLE_MS.
+ */
+    static bool prvIsPooledSocketStale( cellularSocketWrapper_t * pCellularSocketContext,
+                                        uint64_t currentTimeMs );
+
+/**
+ * @brief Close the pooled sockets which are stale.
+ */
+    static void prvPoolSweep( void );
+
+/**
+ * @brief Take a pooled socket to an endpoint out of the pool.
+ *
+ * @param[in] pHostName Server hostname to connect to.
+ * @param[in] port Server port to connect to.
+ *
+ * @return A socket that is connected, or still opening, to the endpoint, or
+ * NULL if there is none in the pool. A connected one is preferred.
+ */
+    static cellularSocketWrapper_t * prvPoolTake( const char * pHostName,
+                                                  uint16_t port );
+
+/**
+ * @brief Put a socket in the pool.
+ *
+ * @param[in] pCellularSocketContext Cellular socket wrapper context of the socket.
+ *
+ * @return True if the socket was pooled, false if the pool is full.
+ */
+    static bool prvPoolPark( cellularSocketWrapper_t * pCellularSocketContext );
+
+/**
+ * @brief Close the socket that has been in the pool the longest.
+ *
+ * @return True if a socket was closed, false if the pool is empty.
+ */
+    static bool prvPoolEvictOldest( void );
+
+/**
+ * @brief Open sockets until every endpoint has the number TCP_Sockets_Reserve()
+ * asked for in the pool, or the pool is full.
+ */
+    static void prvPoolReplenish( void );
+#endif /* if ( CELLULAR_SOCKET_POOL_SIZE > 0U ) */
+
+/**
+ * @brief Close a cellular socket which is not connected to a caller, and free its context.
+ *
+ * @param[in] cellularSocketHandle Cellular socket handle, or NULL.
+ * @param[in] pCellularSocketContext Cellular socket wrapper context, or NULL.
+ */
+static void prvCellularSocketCleanup( CellularSocketHandle_t cellularSocketHandle,
+                                      cellularSocketWrapper_t * pCellularSocketContext );
+
 /**
  * @brief Calculate elapsed time from current time and input parameters.
  *
@@ -255,6 +584,25 @@ static bool _calculateElapsedTime( uint64_t entryTimeMs,
 
 /*-----------------------------------------------------------*/
 
+#if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+
+/* Filled send slots, identified by their socket, in the order they were
+ * filled. Each socket has at most CELLULAR_SOCKET_SEND_PIPELINE_DEPTH entries,
+ * so the queue never fills. */
+    static QueueHandle_t sendQueue = NULL;
+#endif
+
+#if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+
+/* Sockets kept open for later connections, NULL for the free entries. The
+ * pool and the reserves are only accessed with the scheduler suspended, and
+ * the modem is only called outside those sections. */
+    static cellularSocketWrapper_t * socketPool[ CELLULAR_SOCKET_POOL_SIZE ] = { 0 };
+    static cellularSocketReserve_t socketReserves[ CELLULAR_SOCKET_POOL_SIZE ] = { 0 };
+#endif
+
+/*-----------------------------------------------------------*/
+
 static uint64_t getTimeMs( void )
 {
     TimeOut_t xCurrentTime = { 0 };
@@ -365,123 +713,734 @@ static BaseType_t prvNetworkRecvCellular( const cellularSocketWrapper_t * pCellu
 
 /*-----------------------------------------------------------*/
 
-static void prvCellularSocketOpenCallback( CellularUrcEvent_t urcEvent,
-                                           CellularSocketHandle_t socketHandle,
-                                           void * pCallbackContext )
+static BaseType_t prvNetworkSendCellular( const cellularSocketWrapper_t * pCellularSocketContext,
+                                          const uint8_t * buf,
+                                          size_t len )
 {
-    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) pCallbackContext;
+    CellularSocketHandle_t cellularSocketHandle = NULL;
+    BaseType_t retSendLength = 0;
+    uint32_t sentLength = 0;
+    CellularError_t socketStatus = CELLULAR_SUCCESS;
+    uint32_t bytesToSend = ( uint32_t ) len;
+    uint64_t entryTimeMs = getTimeMs();
+    uint64_t elapsedTimeMs = 0;
+    uint32_t sendTimeoutMs = 0;
 
-    ( void ) socketHandle;
+    cellularSocketHandle = pCellularSocketContext->cellularSocketHandle;
 
-    if( pCellularSocketContext != NULL )
+    /* Convert ticks to ms delay. */
+    if( ( pCellularSocketContext->sendTimeout >= UINT32_MAX_MS_TICKS ) || ( pCellularSocketContext->sendTimeout >= portMAX_DELAY ) )
     {
-        LogDebug( ( "Socket open callback on Socket %p %d %d.",
-                    pCellularSocketContext, socketHandle, urcEvent ) );
-
-        if( urcEvent == CELLULAR_URC_SOCKET_OPENED )
-        {
-            pCellularSocketContext->ulFlags = pCellularSocketContext->ulFlags | CELLULAR_SOCKET_CONNECT_FLAG;
-            ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
-                                         SOCKET_OPEN_CALLBACK_BIT );
-        }
-        else
-        {
-            /* Socket open failed. */
-            ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
-                                         SOCKET_OPEN_FAILED_CALLBACK_BIT );
-        }
+        /* Check if the ticks cause overflow. */
+        sendTimeoutMs = UINT32_MAX_DELAY_MS;
     }
     else
     {
-        LogError( ( "Spurious socket open callback." ) );
+        sendTimeoutMs = TICKS_TO_MS( pCellularSocketContext->sendTimeout );
     }
-}
 
-/*-----------------------------------------------------------*/
+    /* Loop sending data until data is sent completely or timeout. */
+    while( bytesToSend > 0U )
+    {
+        socketStatus = Cellular_SocketSend( CellularHandle,
+                                            cellularSocketHandle,
+                                            &buf[ retSendLength ],
+                                            bytesToSend,
+                                            &sentLength );
 
-static void prvCellularSocketDataReadyCallback( CellularSocketHandle_t socketHandle,
-                                                void * pCallbackContext )
-{
-    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) pCallbackContext;
+        if( socketStatus == CELLULAR_SUCCESS )
+        {
+            retSendLength = retSendLength + ( BaseType_t ) sentLength;
+            bytesToSend = bytesToSend - sentLength;
+        }
 
-    ( void ) socketHandle;
+        /* Check socket status or timeout break. */
+        if( ( socketStatus != CELLULAR_SUCCESS ) ||
+            ( _calculateElapsedTime( entryTimeMs, sendTimeoutMs, &elapsedTimeMs ) ) )
+        {
+            if( socketStatus == CELLULAR_SOCKET_CLOSED )
+            {
+                /* Socket already closed. No data is sent. */
+                retSendLength = 0;
+            }
+            else if( socketStatus != CELLULAR_SUCCESS )
+            {
+                retSendLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_ERROR;
+            }
 
-    if( pCellularSocketContext != NULL )
-    {
-        LogDebug( ( "Data ready on Socket %p", pCellularSocketContext ) );
-        ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
-                                     SOCKET_DATA_RECEIVED_CALLBACK_BIT );
-    }
-    else
-    {
-        LogError( ( "spurious data callback" ) );
+            break;
+        }
     }
+
+    LogDebug( ( "prvNetworkSendCellular expect %d write %d", len, retSendLength ) );
+
+    return retSendLength;
 }
 
 /*-----------------------------------------------------------*/
 
-static void prvCellularSocketClosedCallback( CellularSocketHandle_t socketHandle,
-                                             void * pCallbackContext )
+static void prvUpdateSendStats( cellularSocketWrapper_t * pCellularSocketContext,
+                                BaseType_t sentLength )
 {
-    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) pCallbackContext;
-
-    ( void ) socketHandle;
-
-    if( pCellularSocketContext != NULL )
-    {
-        LogInfo( ( "Socket Close on Socket %p", pCellularSocketContext ) );
-        pCellularSocketContext->ulFlags = pCellularSocketContext->ulFlags & ( ~CELLULAR_SOCKET_CONNECT_FLAG );
-        ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
-                                     SOCKET_CLOSE_CALLBACK_BIT );
-    }
-    else
+    if( sentLength > 0 )
     {
-        LogError( ( "spurious socket close callback" ) );
+        taskENTER_CRITICAL();
+        {
+            pCellularSocketContext->sendStats.bytesSent += ( uint32_t ) sentLength;
+            pCellularSocketContext->sendStats.sendCount++;
+            pCellularSocketContext->sendCompleteMs = getTimeMs();
+        }
+        taskEXIT_CRITICAL();
     }
 }
 
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvSetupSocketRecvTimeout( cellularSocketWrapper_t * pCellularSocketContext,
-                                             TickType_t receiveTimeout )
+static BaseType_t prvSocketSend( cellularSocketWrapper_t * pCellularSocketContext,
+                                 const uint8_t * buf,
+                                 size_t len )
 {
-    BaseType_t retSetSockOpt = TCP_SOCKETS_ERRNO_NONE;
+    BaseType_t retSendLength = 0;
 
-    if( pCellularSocketContext == NULL )
+    #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+        size_t slot = 0;
+        size_t copyLength = 0;
+        UBaseType_t outstanding = 0;
+        TimeOut_t sendTimeOut = { 0 };
+        TickType_t creditTimeout = pCellularSocketContext->sendTimeout;
+    #endif
+
+    if( pCellularSocketContext->sendStartMs == 0U )
     {
-        retSetSockOpt = TCP_SOCKETS_ERRNO_EINVAL;
+        pCellularSocketContext->sendStartMs = getTimeMs();
     }
-    else
-    {
-        if( receiveTimeout >= portMAX_DELAY )
+
+    #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+        if( pCellularSocketContext->sendPipelineError != TCP_SOCKETS_ERRNO_NONE )
         {
-            pCellularSocketContext->receiveTimeout = portMAX_DELAY;
+            retSendLength = pCellularSocketContext->sendPipelineError;
         }
         else
         {
-            pCellularSocketContext->receiveTimeout = receiveTimeout;
+            vTaskSetTimeOutState( &sendTimeOut );
+
+            while( ( size_t ) retSendLength < len )
+            {
+                /* A credit is a free slot, returned by the send task once the
+                 * modem accepted the data of the slot. */
+                if( xSemaphoreTake( pCellularSocketContext->sendCredits, 0 ) != pdTRUE )
+                {
+                    pCellularSocketContext->sendStats.creditWaits++;
+
+                    /* All the slots wait within the one send timeout. */
+                    if( ( xTaskCheckForTimeOut( &sendTimeOut, &creditTimeout ) != pdFALSE ) ||
+                        ( xSemaphoreTake( pCellularSocketContext->sendCredits, creditTimeout ) != pdTRUE ) )
+                    {
+                        /* Timed out with all the slots still being sent. */
+                        break;
+                    }
+                }
+
+                copyLength = len - ( size_t ) retSendLength;
+
+                if( copyLength > CELLULAR_SOCKET_SEND_SLOT_SIZE )
+                {
+                    copyLength = CELLULAR_SOCKET_SEND_SLOT_SIZE;
+                }
+
+                slot = pCellularSocketContext->sendSlotHead;
+                ( void ) memcpy( pCellularSocketContext->sendSlots[ slot ], &buf[ retSendLength ], copyLength );
+                pCellularSocketContext->sendSlotLength[ slot ] = copyLength;
+                pCellularSocketContext->sendSlotHead = ( slot + 1U ) % CELLULAR_SOCKET_SEND_PIPELINE_DEPTH;
+
+                ( void ) xQueueSend( sendQueue, &pCellularSocketContext, portMAX_DELAY );
+                retSendLength = retSendLength + ( BaseType_t ) copyLength;
+
+                outstanding = CELLULAR_SOCKET_SEND_PIPELINE_DEPTH - uxSemaphoreGetCount( pCellularSocketContext->sendCredits );
+
+                if( outstanding > pCellularSocketContext->sendStats.maxOutstanding )
+                {
+                    pCellularSocketContext->sendStats.maxOutstanding = ( uint32_t ) outstanding;
+                }
+            }
         }
-    }
+    #else /* if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U ) */
+        retSendLength = prvNetworkSendCellular( pCellularSocketContext, buf, len );
+        prvUpdateSendStats( pCellularSocketContext, retSendLength );
+        pCellularSocketContext->sendStats.maxOutstanding = 1U;
+    #endif /* if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U ) */
 
-    return retSetSockOpt;
+    return retSendLength;
 }
 
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvSetupSocketSendTimeout( cellularSocketWrapper_t * pCellularSocketContext,
-                                             TickType_t sendTimeout )
-{
-    BaseType_t retSetSockOpt = TCP_SOCKETS_ERRNO_NONE;
-    uint32_t sendTimeoutMs = 0;
-    CellularSocketHandle_t cellularSocketHandle = NULL;
+#if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
 
-    if( pCellularSocketContext == NULL )
-    {
-        retSetSockOpt = TCP_SOCKETS_ERRNO_EINVAL;
-    }
-    else
+    static BaseType_t prvStartSendTask( void )
     {
-        cellularSocketHandle = pCellularSocketContext->cellularSocketHandle;
+        BaseType_t retStart = TCP_SOCKETS_ERRNO_NONE;
+
+        /* Sockets may be connected from several tasks at once. */
+        vTaskSuspendAll();
+        {
+            if( sendQueue == NULL )
+            {
+                sendQueue = xQueueCreate( CELLULAR_NUM_SOCKET_MAX * CELLULAR_SOCKET_SEND_PIPELINE_DEPTH,
+                                          sizeof( cellularSocketWrapper_t * ) );
+
+                if( sendQueue == NULL )
+                {
+                    retStart = TCP_SOCKETS_ERRNO_ENOMEM;
+                }
+                else if( xTaskCreate( prvSendTask,
+                                      "CellularSend",
+                                      CELLULAR_SOCKET_SEND_TASK_STACK_SIZE,
+                                      NULL,
+                                      CELLULAR_SOCKET_SEND_TASK_PRIORITY,
+                                      NULL ) != pdPASS )
+                {
+                    vQueueDelete( sendQueue );
+                    sendQueue = NULL;
+                    retStart = TCP_SOCKETS_ERRNO_ENOMEM;
+                }
+                else
+                {
+                    /* Empty else marker. */
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( retStart != TCP_SOCKETS_ERRNO_NONE )
+        {
+            LogError( ( "Failed to create the cellular socket send task." ) );
+        }
+
+        return retStart;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvSendTask( void * pvParameters )
+    {
+        cellularSocketWrapper_t * pCellularSocketContext = NULL;
+        BaseType_t sentLength = 0;
+        size_t slot = 0;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            ( void ) xQueueReceive( sendQueue, &pCellularSocketContext, portMAX_DELAY );
+
+            slot = pCellularSocketContext->sendSlotTail;
+
+            /* After an error the rest of the stream is dropped, as the peer
+             * could not make sense of it with data missing. */
+            if( pCellularSocketContext->sendPipelineError == TCP_SOCKETS_ERRNO_NONE )
+            {
+                sentLength = prvNetworkSendCellular( pCellularSocketContext,
+                                                     pCellularSocketContext->sendSlots[ slot ],
+                                                     pCellularSocketContext->sendSlotLength[ slot ] );
+                prvUpdateSendStats( pCellularSocketContext, sentLength );
+
+                if( ( size_t ) sentLength != pCellularSocketContext->sendSlotLength[ slot ] )
+                {
+                    LogError( ( "Pipelined send on Socket %p failed %d", pCellularSocketContext, sentLength ) );
+                    pCellularSocketContext->sendPipelineError = TCP_SOCKETS_ERRNO_ERROR;
+                }
+            }
+
+            pCellularSocketContext->sendSlotTail = ( slot + 1U ) % CELLULAR_SOCKET_SEND_PIPELINE_DEPTH;
+            ( void ) xSemaphoreGive( pCellularSocketContext->sendCredits );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvDrainSendPipeline( cellularSocketWrapper_t * pCellularSocketContext )
+    {
+        size_t credit = 0;
+
+        /* Each send is bounded by the send timeout and the AT command timeouts
+         * of the cellular library, so all the credits come back. */
+        for( credit = 0; credit < CELLULAR_SOCKET_SEND_PIPELINE_DEPTH; credit++ )
+        {
+            ( void ) xSemaphoreTake( pCellularSocketContext->sendCredits, portMAX_DELAY );
+        }
+
+        for( credit = 0; credit < CELLULAR_SOCKET_SEND_PIPELINE_DEPTH; credit++ )
+        {
+            ( void ) xSemaphoreGive( pCellularSocketContext->sendCredits );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U ) */
+
+#if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+
+    static BaseType_t prvFlushSendBuffer( cellularSocketWrapper_t * pCellularSocketContext )
+    {
+        BaseType_t retFlush = TCP_SOCKETS_ERRNO_NONE;
+        BaseType_t sentLength = 0;
+
+        if( pCellularSocketContext->sendBufferLength > 0U )
+        {
+            sentLength = prvSocketSend( pCellularSocketContext,
+                                        pCellularSocketContext->sendBuffer,
+                                        pCellularSocketContext->sendBufferLength );
+
+            if( sentLength < 0 )
+            {
+                retFlush = sentLength;
+            }
+            else if( ( size_t ) sentLength < pCellularSocketContext->sendBufferLength )
+            {
+                /* Keep the unsent data, in order, for the next flush. */
+                pCellularSocketContext->sendBufferLength -= ( size_t ) sentLength;
+                ( void ) memmove( pCellularSocketContext->sendBuffer,
+                                  &( pCellularSocketContext->sendBuffer[ sentLength ] ),
+                                  pCellularSocketContext->sendBufferLength );
+                retFlush = TCP_SOCKETS_ERRNO_ENOSPC;
+            }
+            else
+            {
+                pCellularSocketContext->sendBufferLength = 0U;
+            }
+        }
+
+        return retFlush;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U ) */
+
+#if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U )
+
+    static BaseType_t prvNetworkRecvBuffered( cellularSocketWrapper_t * pCellularSocketContext,
+                                              uint8_t * buf,
+                                              size_t len )
+    {
+        BaseType_t retRecvLength = 0;
+        size_t copyLength = 0;
+
+        if( pCellularSocketContext->recvBufferLength == 0U )
+        {
+            if( len >= CELLULAR_SOCKET_RECV_BUFFER_SIZE )
+            {
+                /* Nothing is gained by staging a large read in the buffer. */
+                retRecvLength = prvNetworkRecvCellular( pCellularSocketContext, buf, len );
+            }
+            else
+            {
+                retRecvLength = prvNetworkRecvCellular( pCellularSocketContext,
+                                                        pCellularSocketContext->recvBuffer,
+                                                        CELLULAR_SOCKET_RECV_BUFFER_SIZE );
+
+                if( retRecvLength > 0 )
+                {
+                    pCellularSocketContext->recvBufferOffset = 0U;
+                    pCellularSocketContext->recvBufferLength = ( size_t ) retRecvLength;
+                    retRecvLength = 0;
+                }
+            }
+        }
+
+        if( pCellularSocketContext->recvBufferLength > 0U )
+        {
+            copyLength = len;
+
+            if( copyLength > pCellularSocketContext->recvBufferLength )
+            {
+                copyLength = pCellularSocketContext->recvBufferLength;
+            }
+
+            ( void ) memcpy( buf,
+                             &( pCellularSocketContext->recvBuffer[ pCellularSocketContext->recvBufferOffset ] ),
+                             copyLength );
+            pCellularSocketContext->recvBufferOffset += copyLength;
+            pCellularSocketContext->recvBufferLength -= copyLength;
+            retRecvLength = ( BaseType_t ) copyLength;
+        }
+
+        return retRecvLength;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U ) */
+
+#if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+
+    static bool prvIsPooledSocketStale( cellularSocketWrapper_t * pCellularSocketContext,
+                                        uint64_t currentTimeMs )
+    {
+        EventBits_t eventBits = xEventGroupGetBits( pCellularSocketContext->socketEventGroupHandle );
+        bool isStale = false;
+
+        if( ( eventBits & ( SOCKET_OPEN_FAILED_CALLBACK_BIT | SOCKET_CLOSE_CALLBACK_BIT ) ) != 0U )
+        {
+            isStale = true;
+        }
+        else if( ( pCellularSocketContext->isReusable != pdFALSE ) &&
+                 ( ( eventBits & SOCKET_DATA_RECEIVED_CALLBACK_BIT ) != 0U ) )
+        {
+            /* A reused stream must be where the last connection left it. A
+             * reserved socket was never handed out, so its data is the start
+             * of the stream. */
+            isStale = true;
+        }
+        else if( ( currentTimeMs - pCellularSocketContext->parkedMs ) >= CELLULAR_SOCKET_POOL_IDLE_MS )
+        {
+            isStale = true;
+        }
+        else
+        {
+            /* Empty else marker. */
+        }
+
+        return isStale;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvPoolSweep( void )
+    {
+        cellularSocketWrapper_t * staleSockets[ CELLULAR_SOCKET_POOL_SIZE ] = { 0 };
+        uint64_t currentTimeMs = getTimeMs();
+        size_t staleCount = 0;
+        size_t index = 0;
+
+        vTaskSuspendAll();
+        {
+            for( index = 0; index < CELLULAR_SOCKET_POOL_SIZE; index++ )
+            {
+                if( ( socketPool[ index ] != NULL ) &&
+                    ( prvIsPooledSocketStale( socketPool[ index ], currentTimeMs ) ) )
+                {
+                    staleSockets[ staleCount ] = socketPool[ index ];
+                    staleCount++;
+                    socketPool[ index ] = NULL;
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        for( index = 0; index < staleCount; index++ )
+        {
+            LogDebug( ( "Closing pooled Socket %p.", staleSockets[ index ] ) );
+            prvCellularSocketCleanup( staleSockets[ index ]->cellularSocketHandle, staleSockets[ index ] );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static cellularSocketWrapper_t * prvPoolTake( const char * pHostName,
+                                                  uint16_t port )
+    {
+        cellularSocketWrapper_t * pCellularSocketContext = NULL;
+        size_t found = CELLULAR_SOCKET_POOL_SIZE;
+        size_t index = 0;
+
+        prvPoolSweep();
+
+        vTaskSuspendAll();
+        {
+            for( index = 0; index < CELLULAR_SOCKET_POOL_SIZE; index++ )
+            {
+                if( ( socketPool[ index ] != NULL ) &&
+                    ( socketPool[ index ]->port == port ) &&
+                    ( strcmp( socketPool[ index ]->hostName, pHostName ) == 0 ) )
+                {
+                    found = index;
+
+                    if( ( socketPool[ index ]->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U )
+                    {
+                        break;
+                    }
+                }
+            }
+
+            if( found < CELLULAR_SOCKET_POOL_SIZE )
+            {
+                pCellularSocketContext = socketPool[ found ];
+                socketPool[ found ] = NULL;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return pCellularSocketContext;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static bool prvPoolPark( cellularSocketWrapper_t * pCellularSocketContext )
+    {
+        bool isParked = false;
+        size_t index = 0;
+
+        prvPoolSweep();
+
+        pCellularSocketContext->parkedMs = getTimeMs();
+
+        vTaskSuspendAll();
+        {
+            for( index = 0; index < CELLULAR_SOCKET_POOL_SIZE; index++ )
+            {
+                if( socketPool[ index ] == NULL )
+                {
+                    socketPool[ index ] = pCellularSocketContext;
+                    isParked = true;
+                    break;
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        return isParked;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static bool prvPoolEvictOldest( void )
+    {
+        cellularSocketWrapper_t * pCellularSocketContext = NULL;
+        size_t oldest = CELLULAR_SOCKET_POOL_SIZE;
+        size_t index = 0;
+
+        vTaskSuspendAll();
+        {
+            for( index = 0; index < CELLULAR_SOCKET_POOL_SIZE; index++ )
+            {
+                if( ( socketPool[ index ] != NULL ) &&
+                    ( ( oldest == CELLULAR_SOCKET_POOL_SIZE ) ||
+                      ( socketPool[ index ]->parkedMs < socketPool[ oldest ]->parkedMs ) ) )
+                {
+                    oldest = index;
+                }
+            }
+
+            if( oldest < CELLULAR_SOCKET_POOL_SIZE )
+            {
+                pCellularSocketContext = socketPool[ oldest ];
+                socketPool[ oldest ] = NULL;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( pCellularSocketContext != NULL )
+        {
+            LogDebug( ( "Closing pooled Socket %p for a new connection.", pCellularSocketContext ) );
+            prvCellularSocketCleanup( pCellularSocketContext->cellularSocketHandle, pCellularSocketContext );
+        }
+
+        return ( pCellularSocketContext != NULL );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvPoolReplenish( void )
+    {
+        cellularSocketWrapper_t * pCellularSocketContext = NULL;
+        char hostName[ CELLULAR_SOCKET_POOL_HOST_NAME_SIZE ];
+        uint16_t port = 0;
+        UBaseType_t pooledCount = 0;
+        bool hasFreeEntry = false;
+        bool isMissing = false;
+        size_t reserve = 0;
+        size_t index = 0;
+
+        prvPoolSweep();
+
+        for( reserve = 0; reserve < CELLULAR_SOCKET_POOL_SIZE; reserve++ )
+        {
+            do
+            {
+                isMissing = false;
+
+                vTaskSuspendAll();
+                {
+                    if( socketReserves[ reserve ].count > 0U )
+                    {
+                        pooledCount = 0;
+                        hasFreeEntry = false;
+
+                        for( index = 0; index < CELLULAR_SOCKET_POOL_SIZE; index++ )
+                        {
+                            if( socketPool[ index ] == NULL )
+                            {
+                                hasFreeEntry = true;
+                            }
+                            else if( ( socketPool[ index ]->port == socketReserves[ reserve ].port ) &&
+                                     ( strcmp( socketPool[ index ]->hostName, socketReserves[ reserve ].hostName ) == 0 ) )
+                            {
+                                pooledCount++;
+                            }
+                            else
+                            {
+                                /* Empty else marker. */
+                            }
+                        }
+
+                        if( ( pooledCount < socketReserves[ reserve ].count ) && hasFreeEntry )
+                        {
+                            ( void ) strcpy( hostName, socketReserves[ reserve ].hostName );
+                            port = socketReserves[ reserve ].port;
+                            isMissing = true;
+                        }
+                    }
+                }
+                ( void ) xTaskResumeAll();
+
+                if( isMissing )
+                {
+                    /* The socket is pooled while it opens; TCP_Sockets_Connect()
+                     * waits for the rest of the open if it takes it early. */
+                    if( prvCellularSocketConnectStart( &pCellularSocketContext, hostName, port, 0U, 0U ) != TCP_SOCKETS_ERRNO_NONE )
+                    {
+                        LogWarn( ( "Failed to open a reserved socket to %s:%u.", hostName, port ) );
+                        isMissing = false;
+                    }
+                    else if( !prvPoolPark( pCellularSocketContext ) )
+                    {
+                        /* Another task filled the pool meanwhile. */
+                        prvCellularSocketCleanup( pCellularSocketContext->cellularSocketHandle, pCellularSocketContext );
+                        isMissing = false;
+                    }
+                    else
+                    {
+                        LogDebug( ( "Reserved Socket %p to %s:%u.", pCellularSocketContext, hostName, port ) );
+                    }
+                }
+            } while( isMissing );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( CELLULAR_SOCKET_POOL_SIZE > 0U ) */
+
+static void prvCellularSocketOpenCallback( CellularUrcEvent_t urcEvent,
+                                           CellularSocketHandle_t socketHandle,
+                                           void * pCallbackContext )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) pCallbackContext;
+
+    ( void ) socketHandle;
+
+    if( pCellularSocketContext != NULL )
+    {
+        LogDebug( ( "Socket open callback on Socket %p %d %d.",
+                    pCellularSocketContext, socketHandle, urcEvent ) );
+
+        if( urcEvent == CELLULAR_URC_SOCKET_OPENED )
+        {
+            pCellularSocketContext->ulFlags = pCellularSocketContext->ulFlags | CELLULAR_SOCKET_CONNECT_FLAG;
+            ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                         SOCKET_OPEN_CALLBACK_BIT );
+        }
+        else
+        {
+            /* Socket open failed. */
+            ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                         SOCKET_OPEN_FAILED_CALLBACK_BIT );
+        }
+    }
+    else
+    {
+        LogError( ( "Spurious socket open callback." ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCellularSocketDataReadyCallback( CellularSocketHandle_t socketHandle,
+                                                void * pCallbackContext )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) pCallbackContext;
+
+    ( void ) socketHandle;
+
+    if( pCellularSocketContext != NULL )
+    {
+        LogDebug( ( "Data ready on Socket %p", pCellularSocketContext ) );
+        ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                     SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+    }
+    else
+    {
+        LogError( ( "spurious data callback" ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCellularSocketClosedCallback( CellularSocketHandle_t socketHandle,
+                                             void * pCallbackContext )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) pCallbackContext;
+
+    ( void ) socketHandle;
+
+    if( pCellularSocketContext != NULL )
+    {
+        LogInfo( ( "Socket Close on Socket %p", pCellularSocketContext ) );
+        pCellularSocketContext->ulFlags = pCellularSocketContext->ulFlags & ( ~CELLULAR_SOCKET_CONNECT_FLAG );
+        ( void ) xEventGroupSetBits( pCellularSocketContext->socketEventGroupHandle,
+                                     SOCKET_CLOSE_CALLBACK_BIT );
+    }
+    else
+    {
+        LogError( ( "spurious socket close callback" ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSetupSocketRecvTimeout( cellularSocketWrapper_t * pCellularSocketContext,
+                                             TickType_t receiveTimeout )
+{
+    BaseType_t retSetSockOpt = TCP_SOCKETS_ERRNO_NONE;
+
+    if( pCellularSocketContext == NULL )
+    {
+        retSetSockOpt = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        if( receiveTimeout >= portMAX_DELAY )
+        {
+            pCellularSocketContext->receiveTimeout = portMAX_DELAY;
+        }
+        else
+        {
+            pCellularSocketContext->receiveTimeout = receiveTimeout;
+        }
+    }
+
+    return retSetSockOpt;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSetupSocketSendTimeout( cellularSocketWrapper_t * pCellularSocketContext,
+                                             TickType_t sendTimeout )
+{
+    BaseType_t retSetSockOpt = TCP_SOCKETS_ERRNO_NONE;
+    uint32_t sendTimeoutMs = 0;
+    CellularSocketHandle_t cellularSocketHandle = NULL;
+
+    if( pCellularSocketContext == NULL )
+    {
+        retSetSockOpt = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        cellularSocketHandle = pCellularSocketContext->cellularSocketHandle;
 
         if( sendTimeout >= UINT32_MAX_MS_TICKS )
         {
@@ -597,32 +1556,89 @@ static bool _calculateElapsedTime( uint64_t entryTimeMs,
 
 /*-----------------------------------------------------------*/
 
-BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
-                                const char * pHostName,
-                                uint16_t port,
-                                uint32_t receiveTimeoutMs,
-                                uint32_t sendTimeoutMs )
+static BaseType_t prvDnsResolve( const char * pHostName,
+                                 void * pAddress,
+                                 uint32_t * pTtlMs )
+{
+    CellularError_t cellularStatus;
+
+    ( void ) pTtlMs;
+
+    cellularStatus = Cellular_GetHostByName( CellularHandle,
+                                             CellularSocketPdnContextId,
+                                             pHostName,
+                                             ( char * ) pAddress );
+
+    return ( cellularStatus == CELLULAR_SUCCESS ) ? pdPASS : pdFAIL;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvResolveServerAddress( const char * pHostName,
+                                           char * pAddress )
+{
+    BaseType_t retResolve = TCP_SOCKETS_ERRNO_NONE;
+    char resolvedAddress[ dnscacheADDRESS_SIZE ];
+    const char * pChar;
+    bool isAddress = true;
+
+    /* IPv4 and IPv6 addresses are passed to the modem as they are. */
+    for( pChar = pHostName; ( *pChar != '\0' ) && isAddress; pChar++ )
+    {
+        isAddress = ( ( *pChar >= '0' ) && ( *pChar <= '9' ) ) || ( *pChar == '.' ) || ( *pChar == ':' );
+    }
+
+    if( isAddress )
+    {
+        ( void ) strncpy( pAddress, pHostName, CELLULAR_IP_ADDRESS_MAX_SIZE );
+    }
+    else if( xDnsCacheLookup( pHostName, resolvedAddress, prvDnsResolve ) == pdPASS )
+    {
+        resolvedAddress[ CELLULAR_IP_ADDRESS_MAX_SIZE ] = '\0';
+        ( void ) strncpy( pAddress, resolvedAddress, CELLULAR_IP_ADDRESS_MAX_SIZE );
+    }
+    else
+    {
+        LogError( ( "Failed to resolve %s.", pHostName ) );
+        retResolve = TCP_SOCKETS_ERRNO_ERROR;
+    }
+
+    return retResolve;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCellularSocketConnectStart( cellularSocketWrapper_t ** ppCellularSocketContext,
+                                                 const char * pHostName,
+                                                 uint16_t port,
+                                                 uint32_t receiveTimeoutMs,
+                                                 uint32_t sendTimeoutMs )
 {
     CellularSocketHandle_t cellularSocketHandle = NULL;
     cellularSocketWrapper_t * pCellularSocketContext = NULL;
     CellularError_t cellularSocketStatus = CELLULAR_INVALID_HANDLE;
 
     CellularSocketAddress_t serverAddress = { 0 };
-    EventBits_t waitEventBits = 0;
     BaseType_t retConnect = TCP_SOCKETS_ERRNO_NONE;
 
-    /* Create a new TCP socket. */
-    cellularSocketStatus = Cellular_CreateSocket( CellularHandle,
-                                                  CellularSocketPdnContextId,
-                                                  CELLULAR_SOCKET_DOMAIN_AF_INET,
-                                                  CELLULAR_SOCKET_TYPE_STREAM,
-                                                  CELLULAR_SOCKET_PROTOCOL_TCP,
-                                                  &cellularSocketHandle );
+    /* Resolve the host name before taking a socket of the modem. */
+    retConnect = prvResolveServerAddress( pHostName, serverAddress.ipAddress.ipAddress );
 
-    if( cellularSocketStatus != CELLULAR_SUCCESS )
+    /* Create a new TCP socket. */
+    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
     {
-        LogError( ( "Failed to create cellular sockets. %d", cellularSocketStatus ) );
-        retConnect = TCP_SOCKETS_ERRNO_ERROR;
+        cellularSocketStatus = Cellular_CreateSocket( CellularHandle,
+                                                      CellularSocketPdnContextId,
+                                                      CELLULAR_SOCKET_DOMAIN_AF_INET,
+                                                      CELLULAR_SOCKET_TYPE_STREAM,
+                                                      CELLULAR_SOCKET_PROTOCOL_TCP,
+                                                      &cellularSocketHandle );
+
+        if( cellularSocketStatus != CELLULAR_SUCCESS )
+        {
+            LogError( ( "Failed to create cellular sockets. %d", cellularSocketStatus ) );
+            retConnect = TCP_SOCKETS_ERRNO_ENOSPC;
+        }
     }
 
     /* Allocate socket context. */
@@ -644,6 +1660,16 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
             pCellularSocketContext->cellularSocketHandle = cellularSocketHandle;
             pCellularSocketContext->ulFlags |= CELLULAR_SOCKET_OPEN_FLAG;
             pCellularSocketContext->socketEventGroupHandle = NULL;
+
+            #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+                /* A name that does not fit is left empty, so it matches no pooled socket. */
+                if( strlen( pHostName ) < CELLULAR_SOCKET_POOL_HOST_NAME_SIZE )
+                {
+                    ( void ) strcpy( pCellularSocketContext->hostName, pHostName );
+                }
+
+                pCellularSocketContext->port = port;
+            #endif
         }
     }
 
@@ -659,44 +1685,176 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
         }
     }
 
+    #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+        /* Allocate the send credits and start the send task. */
+        if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+        {
+            pCellularSocketContext->sendCredits = xSemaphoreCreateCounting( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH,
+                                                                            CELLULAR_SOCKET_SEND_PIPELINE_DEPTH );
+
+            if( pCellularSocketContext->sendCredits == NULL )
+            {
+                LogError( ( "Failed create cellular socket send credits %p.", pCellularSocketContext ) );
+                retConnect = TCP_SOCKETS_ERRNO_ENOMEM;
+            }
+            else
+            {
+                retConnect = prvStartSendTask();
+            }
+        }
+    #endif /* if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U ) */
+
     /* Register cellular socket callback function. */
     if( retConnect == TCP_SOCKETS_ERRNO_NONE )
     {
         serverAddress.ipAddress.ipAddressType = CELLULAR_IP_ADDRESS_V4;
-        strncpy( serverAddress.ipAddress.ipAddress, pHostName, CELLULAR_IP_ADDRESS_MAX_SIZE );
         serverAddress.port = port;
 
-        LogDebug( ( "Ip address %s port %d\r\n", serverAddress.ipAddress.ipAddress, serverAddress.port ) );
-        retConnect = prvCellularSocketRegisterCallback( cellularSocketHandle, pCellularSocketContext );
-    }
+        LogDebug( ( "Ip address %s port %d\r\n", serverAddress.ipAddress.ipAddress, serverAddress.port ) );
+        retConnect = prvCellularSocketRegisterCallback( cellularSocketHandle, pCellularSocketContext );
+    }
+
+    /* Setup cellular socket send/recv timeout. */
+    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+    {
+        retConnect = prvSetupSocketSendTimeout( pCellularSocketContext, pdMS_TO_TICKS( sendTimeoutMs ) );
+    }
+
+    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+    {
+        retConnect = prvSetupSocketRecvTimeout( pCellularSocketContext, pdMS_TO_TICKS( receiveTimeoutMs ) );
+    }
+
+    /* Cellular socket connect. */
+    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+    {
+        ( void ) xEventGroupClearBits( pCellularSocketContext->socketEventGroupHandle,
+                                       SOCKET_DATA_RECEIVED_CALLBACK_BIT | SOCKET_OPEN_FAILED_CALLBACK_BIT );
+        cellularSocketStatus = Cellular_SocketConnect( CellularHandle, cellularSocketHandle, CELLULAR_SOCKET_ACCESS_MODE, &serverAddress );
+
+        if( cellularSocketStatus != CELLULAR_SUCCESS )
+        {
+            LogError( ( "Failed to establish new connection. Socket status %d.", cellularSocketStatus ) );
+            retConnect = TCP_SOCKETS_ERRNO_ERROR;
+        }
+    }
+
+    /* Cleanup the socket if any error. */
+    if( retConnect != TCP_SOCKETS_ERRNO_NONE )
+    {
+        prvCellularSocketCleanup( cellularSocketHandle, pCellularSocketContext );
+        pCellularSocketContext = NULL;
+    }
+
+    *ppCellularSocketContext = pCellularSocketContext;
+
+    return retConnect;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCellularSocketCleanup( CellularSocketHandle_t cellularSocketHandle,
+                                      cellularSocketWrapper_t * pCellularSocketContext )
+{
+    if( cellularSocketHandle != NULL )
+    {
+        ( void ) Cellular_SocketClose( CellularHandle, cellularSocketHandle );
+        ( void ) Cellular_SocketRegisterDataReadyCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
+        ( void ) Cellular_SocketRegisterSocketOpenCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
+        ( void ) Cellular_SocketRegisterClosedCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
+
+        if( pCellularSocketContext != NULL )
+        {
+            pCellularSocketContext->cellularSocketHandle = NULL;
+        }
+    }
+
+    if( ( pCellularSocketContext != NULL ) && ( pCellularSocketContext->socketEventGroupHandle != NULL ) )
+    {
+        vEventGroupDelete( pCellularSocketContext->socketEventGroupHandle );
+        pCellularSocketContext->socketEventGroupHandle = NULL;
+    }
+
+    #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+        /* Nothing is outstanding on a socket that failed to connect, and a
+         * pooled socket was drained before it was pooled. */
+        if( ( pCellularSocketContext != NULL ) && ( pCellularSocketContext->sendCredits != NULL ) )
+        {
+            vSemaphoreDelete( pCellularSocketContext->sendCredits );
+            pCellularSocketContext->sendCredits = NULL;
+        }
+    #endif
+
+    if( pCellularSocketContext != NULL )
+    {
+        vPortFree( pCellularSocketContext );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
+                                const char * pHostName,
+                                uint16_t port,
+                                uint32_t receiveTimeoutMs,
+                                uint32_t sendTimeoutMs )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = NULL;
+    EventBits_t waitEventBits = 0;
+    BaseType_t retConnect = TCP_SOCKETS_ERRNO_NONE;
+
+    #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+        pCellularSocketContext = prvPoolTake( pHostName, port );
 
-    /* Setup cellular socket send/recv timeout. */
-    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
-    {
-        retConnect = prvSetupSocketSendTimeout( pCellularSocketContext, pdMS_TO_TICKS( sendTimeoutMs ) );
-    }
+        if( pCellularSocketContext != NULL )
+        {
+            LogDebug( ( "Using pooled Socket %p for %s:%u.", pCellularSocketContext, pHostName, port ) );
 
-    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+            /* The socket starts over as a new connection. */
+            pCellularSocketContext->isReusable = pdFALSE;
+            ( void ) memset( &( pCellularSocketContext->sendStats ), 0, sizeof( pCellularSocketContext->sendStats ) );
+            pCellularSocketContext->sendStartMs = 0U;
+            pCellularSocketContext->sendCompleteMs = 0U;
+
+            #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+                pCellularSocketContext->isCorked = pdFALSE;
+            #endif
+
+            ( void ) prvSetupSocketSendTimeout( pCellularSocketContext, pdMS_TO_TICKS( sendTimeoutMs ) );
+            ( void ) prvSetupSocketRecvTimeout( pCellularSocketContext, pdMS_TO_TICKS( receiveTimeoutMs ) );
+        }
+        else
+    #endif /* if ( CELLULAR_SOCKET_POOL_SIZE > 0U ) */
     {
-        retConnect = prvSetupSocketRecvTimeout( pCellularSocketContext, pdMS_TO_TICKS( receiveTimeoutMs ) );
+        retConnect = prvCellularSocketConnectStart( &pCellularSocketContext,
+                                                    pHostName,
+                                                    port,
+                                                    receiveTimeoutMs,
+                                                    sendTimeoutMs );
+
+        #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+            /* The pooled sockets may hold all the sockets of the modem. */
+            if( ( retConnect == TCP_SOCKETS_ERRNO_ENOSPC ) && prvPoolEvictOldest() )
+            {
+                retConnect = prvCellularSocketConnectStart( &pCellularSocketContext,
+                                                            pHostName,
+                                                            port,
+                                                            receiveTimeoutMs,
+                                                            sendTimeoutMs );
+            }
+        #endif
     }
 
-    /* Cellular socket connect. */
-    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+    /* Wait the socket connection, unless it is a pooled socket which is
+     * already connected. */
+    if( ( retConnect == TCP_SOCKETS_ERRNO_NONE ) &&
+        ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U ) )
     {
+        /* The open callback of a socket opened ahead may not have been waited for. */
         ( void ) xEventGroupClearBits( pCellularSocketContext->socketEventGroupHandle,
-                                       SOCKET_DATA_RECEIVED_CALLBACK_BIT | SOCKET_OPEN_FAILED_CALLBACK_BIT );
-        cellularSocketStatus = Cellular_SocketConnect( CellularHandle, cellularSocketHandle, CELLULAR_SOCKET_ACCESS_MODE, &serverAddress );
-
-        if( cellularSocketStatus != CELLULAR_SUCCESS )
-        {
-            LogError( ( "Failed to establish new connection. Socket status %d.", cellularSocketStatus ) );
-            retConnect = TCP_SOCKETS_ERRNO_ERROR;
-        }
+                                       SOCKET_OPEN_CALLBACK_BIT );
     }
-
-    /* Wait the socket connection. */
-    if( retConnect == TCP_SOCKETS_ERRNO_NONE )
+    else if( retConnect == TCP_SOCKETS_ERRNO_NONE )
     {
         waitEventBits = xEventGroupWaitBits( pCellularSocketContext->socketEventGroupHandle,
                                              SOCKET_OPEN_CALLBACK_BIT | SOCKET_OPEN_FAILED_CALLBACK_BIT,
@@ -708,53 +1866,122 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
         {
             LogError( ( "Socket connect timeout." ) );
             retConnect = TCP_SOCKETS_ERRNO_ENOTCONN;
+
+            /* The server may have moved, so resolve it again next time. */
+            vDnsCacheInvalidate( pHostName );
         }
     }
 
     /* Cleanup the socket if any error. */
-    if( retConnect != TCP_SOCKETS_ERRNO_NONE )
+    if( ( retConnect != TCP_SOCKETS_ERRNO_NONE ) && ( pCellularSocketContext != NULL ) )
     {
-        if( cellularSocketHandle != NULL )
-        {
-            ( void ) Cellular_SocketClose( CellularHandle, cellularSocketHandle );
-            ( void ) Cellular_SocketRegisterDataReadyCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
-            ( void ) Cellular_SocketRegisterSocketOpenCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
-            ( void ) Cellular_SocketRegisterClosedCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
+        prvCellularSocketCleanup( pCellularSocketContext->cellularSocketHandle, pCellularSocketContext );
+        pCellularSocketContext = NULL;
+    }
 
-            if( pCellularSocketContext != NULL )
-            {
-                pCellularSocketContext->cellularSocketHandle = NULL;
-            }
-        }
+    *pTcpSocket = pCellularSocketContext;
+
+    return retConnect;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_ConnectStart( Socket_t * pTcpSocket,
+                                     const char * pHostName,
+                                     uint16_t port )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = NULL;
+    BaseType_t retConnect = TCP_SOCKETS_ERRNO_NONE;
+
+    /* Zero timeouts let the caller send and receive without blocking until
+     * it sets the timeouts it wants. */
+    retConnect = prvCellularSocketConnectStart( &pCellularSocketContext, pHostName, port, 0U, 0U );
+
+    *pTcpSocket = pCellularSocketContext;
+
+    return retConnect;
+}
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t TCP_Sockets_DnsPrefetch( void )
+{
+    return uxDnsCachePrefetch( prvDnsResolve );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_ConnectPoll( Socket_t xSocket )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+    EventBits_t waitEventBits = 0;
+    BaseType_t retConnect = TCP_SOCKETS_ERRNO_NONE;
+
+    if( pCellularSocketContext == NULL )
+    {
+        retConnect = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else if( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U )
+    {
+        /* Already reported connected. */
+    }
+    else
+    {
+        waitEventBits = xEventGroupWaitBits( pCellularSocketContext->socketEventGroupHandle,
+                                             SOCKET_OPEN_CALLBACK_BIT | SOCKET_OPEN_FAILED_CALLBACK_BIT,
+                                             pdTRUE,
+                                             pdFALSE,
+                                             0 );
 
-        if( ( pCellularSocketContext != NULL ) && ( pCellularSocketContext->socketEventGroupHandle != NULL ) )
+        if( waitEventBits == 0U )
         {
-            vEventGroupDelete( pCellularSocketContext->socketEventGroupHandle );
-            pCellularSocketContext->socketEventGroupHandle = NULL;
+            retConnect = TCP_SOCKETS_ERRNO_EWOULDBLOCK;
         }
-
-        if( pCellularSocketContext != NULL )
+        else if( waitEventBits != SOCKET_OPEN_CALLBACK_BIT )
         {
-            vPortFree( pCellularSocketContext );
-            pCellularSocketContext = NULL;
+            LogError( ( "Socket connect failed." ) );
+            retConnect = TCP_SOCKETS_ERRNO_ENOTCONN;
+        }
+        else
+        {
+            /* Empty else marker. */
         }
     }
 
-    *pTcpSocket = pCellularSocketContext;
-
     return retConnect;
 }
 
 /*-----------------------------------------------------------*/
 
+BaseType_t TCP_Sockets_SetTimeouts( Socket_t xSocket,
+                                    uint32_t receiveTimeoutMs,
+                                    uint32_t sendTimeoutMs )
+{
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+    BaseType_t retSetSockOpt = TCP_SOCKETS_ERRNO_NONE;
+
+    retSetSockOpt = prvSetupSocketRecvTimeout( pCellularSocketContext, pdMS_TO_TICKS( receiveTimeoutMs ) );
+
+    if( retSetSockOpt == TCP_SOCKETS_ERRNO_NONE )
+    {
+        retSetSockOpt = prvSetupSocketSendTimeout( pCellularSocketContext, pdMS_TO_TICKS( sendTimeoutMs ) );
+    }
+
+    return retSetSockOpt;
+}
+
+/*-----------------------------------------------------------*/
+
 void TCP_Sockets_Disconnect( Socket_t xSocket )
 {
     int32_t retClose = TCP_SOCKETS_ERRNO_NONE;
     cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
     CellularSocketHandle_t cellularSocketHandle = NULL;
     uint32_t recvLength = 0;
+    uint32_t drainedLength = 0;
     uint8_t buf[ 128 ] = { 0 };
     CellularError_t cellularSocketStatus = CELLULAR_SUCCESS;
+    bool isParked = false;
 
     /* xSocket need to be check against SOCKET_INVALID_SOCKET. */
     /* coverity[misra_c_2012_rule_11_4_violation] */
@@ -772,34 +1999,100 @@ void TCP_Sockets_Disconnect( Socket_t xSocket )
     {
         if( cellularSocketHandle != NULL )
         {
+            #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+                /* Send data still waiting in the send buffer. */
+                if( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U )
+                {
+                    ( void ) prvFlushSendBuffer( pCellularSocketContext );
+                }
+            #endif
+
+            #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+                /* The send task must be done with the socket before it is freed. */
+                prvDrainSendPipeline( pCellularSocketContext );
+            #endif
+
+            #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+                /* Data arriving from here on marks a pooled socket stale. */
+                ( void ) xEventGroupClearBits( pCellularSocketContext->socketEventGroupHandle,
+                                               SOCKET_DATA_RECEIVED_CALLBACK_BIT );
+            #endif
+
             /* Receive all the data before socket close. */
             do
             {
                 recvLength = 0;
                 cellularSocketStatus = Cellular_SocketRecv( CellularHandle, cellularSocketHandle, buf, 128, &recvLength );
+                drainedLength += recvLength;
                 LogDebug( ( "%u bytes received in close", recvLength ) );
             } while( ( recvLength != 0 ) && ( cellularSocketStatus == CELLULAR_SUCCESS ) );
 
-            /* Close sockets. */
-            if( Cellular_SocketClose( CellularHandle, cellularSocketHandle ) != CELLULAR_SUCCESS )
+            #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+                /* Only a stream with nothing left over in either direction can
+                 * carry the next connection. */
+                if( ( pCellularSocketContext->isReusable != pdFALSE ) &&
+                    ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U ) &&
+                    ( pCellularSocketContext->hostName[ 0 ] != '\0' ) &&
+                    ( cellularSocketStatus == CELLULAR_SUCCESS ) &&
+                    ( drainedLength == 0U )
+                    #if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U )
+                        && ( pCellularSocketContext->recvBufferLength == 0U )
+                    #endif
+                    #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+                        && ( pCellularSocketContext->sendBufferLength == 0U )
+                    #endif
+                    #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+                        && ( pCellularSocketContext->sendPipelineError == TCP_SOCKETS_ERRNO_NONE )
+                    #endif
+                    )
+                {
+                    isParked = prvPoolPark( pCellularSocketContext );
+                }
+            #endif /* if ( CELLULAR_SOCKET_POOL_SIZE > 0U ) */
+
+            if( isParked )
             {
-                LogWarn( ( "Failed to destroy connection." ) );
-                retClose = TCP_SOCKETS_ERRNO_ERROR;
+                LogDebug( ( "Pooled Socket %p for the next connection.", pCellularSocketContext ) );
             }
+            else
+            {
+                /* Close sockets. */
+                if( Cellular_SocketClose( CellularHandle, cellularSocketHandle ) != CELLULAR_SUCCESS )
+                {
+                    LogWarn( ( "Failed to destroy connection." ) );
+                    retClose = TCP_SOCKETS_ERRNO_ERROR;
+                }
 
-            ( void ) Cellular_SocketRegisterDataReadyCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
-            ( void ) Cellular_SocketRegisterSocketOpenCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
-            ( void ) Cellular_SocketRegisterClosedCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
-            pCellularSocketContext->cellularSocketHandle = NULL;
+                ( void ) Cellular_SocketRegisterDataReadyCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
+                ( void ) Cellular_SocketRegisterSocketOpenCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
+                ( void ) Cellular_SocketRegisterClosedCallback( CellularHandle, cellularSocketHandle, NULL, NULL );
+                pCellularSocketContext->cellularSocketHandle = NULL;
+            }
         }
 
-        if( pCellularSocketContext->socketEventGroupHandle != NULL )
+        if( !isParked )
         {
-            vEventGroupDelete( pCellularSocketContext->socketEventGroupHandle );
-            pCellularSocketContext->socketEventGroupHandle = NULL;
+            if( pCellularSocketContext->socketEventGroupHandle != NULL )
+            {
+                vEventGroupDelete( pCellularSocketContext->socketEventGroupHandle );
+                pCellularSocketContext->socketEventGroupHandle = NULL;
+            }
+
+            #if ( CELLULAR_SOCKET_SEND_PIPELINE_DEPTH > 0U )
+                if( pCellularSocketContext->sendCredits != NULL )
+                {
+                    vSemaphoreDelete( pCellularSocketContext->sendCredits );
+                    pCellularSocketContext->sendCredits = NULL;
+                }
+            #endif
+
+            vPortFree( pCellularSocketContext );
         }
 
-        vPortFree( pCellularSocketContext );
+        #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+            /* Open ahead here, so that a connection does not wait for it. */
+            prvPoolReplenish();
+        #endif
     }
 
     LogDebug( ( "Sockets close exit with code %d", retClose ) );
@@ -820,6 +2113,14 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
         LogError( ( "Cellular prvNetworkRecv Invalid xSocket %p", pCellularSocketContext ) );
         retRecvLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_EINVAL;
     }
+    #if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U )
+        /* Data received before the remote end closed the connection can still be read. */
+        else if( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) != 0U ) &&
+                 ( pCellularSocketContext->recvBufferLength > 0U ) )
+        {
+            retRecvLength = prvNetworkRecvBuffered( pCellularSocketContext, buf, xBufferLength );
+        }
+    #endif
     else if( ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_OPEN_FLAG ) == 0U ) ||
              ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) == 0U ) )
     {
@@ -829,7 +2130,16 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
     }
     else
     {
-        retRecvLength = ( BaseType_t ) prvNetworkRecvCellular( pCellularSocketContext, buf, xBufferLength );
+        #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+            /* The peer cannot answer data still waiting in the send buffer. */
+            ( void ) prvFlushSendBuffer( pCellularSocketContext );
+        #endif
+
+        #if ( CELLULAR_SOCKET_RECV_BUFFER_SIZE > 0U )
+            retRecvLength = prvNetworkRecvBuffered( pCellularSocketContext, buf, xBufferLength );
+        #else
+            retRecvLength = ( BaseType_t ) prvNetworkRecvCellular( pCellularSocketContext, buf, xBufferLength );
+        #endif
     }
 
     return retRecvLength;
@@ -837,24 +2147,51 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
 
 /*-----------------------------------------------------------*/
 
+/* The cellular library always copies received data into the caller's buffer,
+ * so there is no data to point at; callers fall back to TCP_Sockets_Recv(). */
+int32_t TCP_Sockets_RecvZeroCopy( Socket_t xSocket,
+                                  const void ** ppvData,
+                                  size_t xMaxLength )
+{
+    ( void ) xSocket;
+    ( void ) ppvData;
+    ( void ) xMaxLength;
+
+    return ( int32_t ) TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t TCP_Sockets_RecvRelease( Socket_t xSocket,
+                                 size_t xLength )
+{
+    ( void ) xSocket;
+    ( void ) xLength;
+
+    return ( int32_t ) TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+}
+
+/*-----------------------------------------------------------*/
+
 /* This function sends the data until timeout or data is completely sent to server.
  * Send timeout unit is TickType_t. Any timeout value greater than UINT32_MAX_MS_TICKS
  * or portMAX_DELAY will be regarded as MAX delay. In this case, this function
- * will not return until all bytes of data are sent successfully or until an error occurs. */
+ * will not return until all bytes of data are sent successfully or until an error occurs.
+ * While the socket is corked, small sends are only copied to the send buffer. With a
+ * send pipeline, the data is only copied to the send slots, and the timeout applies to
+ * waiting for a free slot. */
 int32_t TCP_Sockets_Send( Socket_t xSocket,
                           const void * pvBuffer,
                           size_t xDataLength )
 {
-    uint8_t * buf = ( uint8_t * ) pvBuffer;
-    CellularSocketHandle_t cellularSocketHandle = NULL;
+    const uint8_t * buf = ( const uint8_t * ) pvBuffer;
     BaseType_t retSendLength = 0;
-    uint32_t sentLength = 0;
-    CellularError_t socketStatus = CELLULAR_SUCCESS;
     cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
-    uint32_t bytesToSend = xDataLength;
-    uint64_t entryTimeMs = getTimeMs();
-    uint64_t elapsedTimeMs = 0;
-    uint32_t sendTimeoutMs = 0;
+
+    #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+        BaseType_t flushStatus = TCP_SOCKETS_ERRNO_NONE;
+        BaseType_t isBuffered = pdFALSE;
+    #endif
 
     if( pCellularSocketContext == NULL )
     {
@@ -870,56 +2207,277 @@ int32_t TCP_Sockets_Send( Socket_t xSocket,
     }
     else
     {
-        cellularSocketHandle = pCellularSocketContext->cellularSocketHandle;
+        #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+            /* Send the collected data first if this data does not fit after it,
+             * if it has waited long enough, or if the socket was uncorked. */
+            if( ( pCellularSocketContext->sendBufferLength > 0U ) &&
+                ( ( pCellularSocketContext->isCorked == pdFALSE ) ||
+                  ( ( pCellularSocketContext->sendBufferLength + xDataLength ) > CELLULAR_SOCKET_SEND_BUFFER_SIZE ) ||
+                  ( ( getTimeMs() - pCellularSocketContext->sendBufferStartMs ) >= CELLULAR_SOCKET_CORK_DEADLINE_MS ) ) )
+            {
+                flushStatus = prvFlushSendBuffer( pCellularSocketContext );
+            }
+
+            if( flushStatus == TCP_SOCKETS_ERRNO_ENOSPC )
+            {
+                /* Timed out with earlier data still waiting; none of this data is sent. */
+                isBuffered = pdTRUE;
+                retSendLength = 0;
+            }
+            else if( flushStatus != TCP_SOCKETS_ERRNO_NONE )
+            {
+                isBuffered = pdTRUE;
+                retSendLength = flushStatus;
+            }
+            else if( ( pCellularSocketContext->isCorked == pdTRUE ) &&
+                     ( xDataLength < CELLULAR_SOCKET_SEND_BUFFER_SIZE ) )
+            {
+                if( pCellularSocketContext->sendBufferLength == 0U )
+                {
+                    pCellularSocketContext->sendBufferStartMs = getTimeMs();
+                }
+
+                ( void ) memcpy( &( pCellularSocketContext->sendBuffer[ pCellularSocketContext->sendBufferLength ] ),
+                                 buf,
+                                 xDataLength );
+                pCellularSocketContext->sendBufferLength += xDataLength;
+                isBuffered = pdTRUE;
+                retSendLength = ( BaseType_t ) xDataLength;
+            }
+            else
+            {
+                /* Empty else marker. */
+            }
 
-        /* Convert ticks to ms delay. */
-        if( ( pCellularSocketContext->sendTimeout >= UINT32_MAX_MS_TICKS ) || ( pCellularSocketContext->sendTimeout >= portMAX_DELAY ) )
+            if( isBuffered == pdFALSE )
+        #endif /* if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U ) */
         {
-            /* Check if the ticks cause overflow. */
-            sendTimeoutMs = UINT32_MAX_DELAY_MS;
+            retSendLength = prvSocketSend( pCellularSocketContext, buf, xDataLength );
         }
-        else
+
+        LogDebug( ( "TCP_Sockets_Send expect %d write %d", xDataLength, retSendLength ) );
+    }
+
+    return retSendLength;
+}
+
+/*-----------------------------------------------------------*/
+
+/* This function sends each buffer with TCP_Sockets_Send(), so it returns only when
+ * all the data is sent, the send timeout expires for one of the buffers, or an
+ * error occurs. */
+int32_t TCP_Sockets_SendVector( Socket_t xSocket,
+                                const TransportOutVector_t * pxVectors,
+                                size_t xVectorCount )
+{
+    int32_t sendStatus = 0;
+    int32_t retSendLength = 0;
+    size_t index = 0;
+
+    if( pxVectors == NULL )
+    {
+        LogError( ( "Cellular TCP_Sockets_SendVector Invalid pxVectors" ) );
+        retSendLength = ( int32_t ) TCP_SOCKETS_ERRNO_ERROR;
+    }
+    else
+    {
+        for( index = 0; index < xVectorCount; index++ )
         {
-            sendTimeoutMs = TICKS_TO_MS( pCellularSocketContext->sendTimeout );
+            if( pxVectors[ index ].iov_len > 0U )
+            {
+                sendStatus = TCP_Sockets_Send( xSocket,
+                                               pxVectors[ index ].iov_base,
+                                               pxVectors[ index ].iov_len );
+
+                if( sendStatus < 0 )
+                {
+                    /* Report the error only if no data was sent. */
+                    if( retSendLength == 0 )
+                    {
+                        retSendLength = sendStatus;
+                    }
+
+                    break;
+                }
+
+                retSendLength = retSendLength + sendStatus;
+
+                /* TCP_Sockets_Send() returns early only on timeout or socket closure. */
+                if( ( size_t ) sendStatus < pxVectors[ index ].iov_len )
+                {
+                    break;
+                }
+            }
         }
+    }
 
-        /* Loop sending data until data is sent completely or timeout. */
-        while( bytesToSend > 0U )
-        {
-            socketStatus = Cellular_SocketSend( CellularHandle,
-                                                cellularSocketHandle,
-                                                &buf[ retSendLength ],
-                                                bytesToSend,
-                                                &sentLength );
+    return retSendLength;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_SetCork( Socket_t xSocket,
+                                BaseType_t xCork )
+{
+    BaseType_t retSetCork = TCP_SOCKETS_ERRNO_NONE;
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+
+    if( pCellularSocketContext == NULL )
+    {
+        LogError( ( "Cellular TCP_Sockets_SetCork Invalid xSocket %p", pCellularSocketContext ) );
+        retSetCork = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        #if ( CELLULAR_SOCKET_SEND_BUFFER_SIZE > 0U )
+            pCellularSocketContext->isCorked = ( xCork != pdFALSE ) ? pdTRUE : pdFALSE;
+
+            if( ( pCellularSocketContext->isCorked == pdFALSE ) &&
+                ( ( pCellularSocketContext->ulFlags & CELLULAR_SOCKET_CONNECT_FLAG ) != 0U ) )
+            {
+                retSetCork = prvFlushSendBuffer( pCellularSocketContext );
+            }
+        #else
+            /* Without a send buffer every send goes to the modem at once. */
+            ( void ) xCork;
+        #endif
+    }
+
+    return retSetCork;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_SetReuse( Socket_t xSocket,
+                                 BaseType_t xReuse )
+{
+    BaseType_t retSetReuse = TCP_SOCKETS_ERRNO_NONE;
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+
+    if( pCellularSocketContext == NULL )
+    {
+        LogError( ( "Cellular TCP_Sockets_SetReuse Invalid xSocket %p", pCellularSocketContext ) );
+        retSetReuse = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+            pCellularSocketContext->isReusable = ( xReuse != pdFALSE ) ? pdTRUE : pdFALSE;
+        #else
+            /* Without a pool every socket is closed on disconnect. */
+            ( void ) xReuse;
+            retSetReuse = TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+        #endif
+    }
+
+    return retSetReuse;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_Reserve( const char * pHostName,
+                                uint16_t port,
+                                UBaseType_t uxCount )
+{
+    BaseType_t retReserve = TCP_SOCKETS_ERRNO_NONE;
 
-            if( socketStatus == CELLULAR_SUCCESS )
+    #if ( CELLULAR_SOCKET_POOL_SIZE > 0U )
+        size_t found = CELLULAR_SOCKET_POOL_SIZE;
+        size_t index = 0;
+
+        if( ( pHostName == NULL ) || ( strlen( pHostName ) >= CELLULAR_SOCKET_POOL_HOST_NAME_SIZE ) )
+        {
+            LogError( ( "Cellular TCP_Sockets_Reserve Invalid pHostName" ) );
+            retReserve = TCP_SOCKETS_ERRNO_EINVAL;
+        }
+        else
+        {
+            if( uxCount > CELLULAR_SOCKET_POOL_SIZE )
             {
-                retSendLength = retSendLength + ( BaseType_t ) sentLength;
-                bytesToSend = bytesToSend - sentLength;
+                uxCount = CELLULAR_SOCKET_POOL_SIZE;
             }
 
-            /* Check socket status or timeout break. */
-            if( ( socketStatus != CELLULAR_SUCCESS ) ||
-                ( _calculateElapsedTime( entryTimeMs, sendTimeoutMs, &elapsedTimeMs ) ) )
+            vTaskSuspendAll();
             {
-                if( socketStatus == CELLULAR_SOCKET_CLOSED )
+                /* Update the entry of the endpoint, or else take a free one. */
+                for( index = 0; index < CELLULAR_SOCKET_POOL_SIZE; index++ )
                 {
-                    /* Socket already closed. No data is sent. */
-                    retSendLength = 0;
+                    if( ( socketReserves[ index ].count > 0U ) &&
+                        ( socketReserves[ index ].port == port ) &&
+                        ( strcmp( socketReserves[ index ].hostName, pHostName ) == 0 ) )
+                    {
+                        found = index;
+                        break;
+                    }
+                    else if( ( socketReserves[ index ].count == 0U ) && ( found == CELLULAR_SOCKET_POOL_SIZE ) )
+                    {
+                        found = index;
+                    }
+                    else
+                    {
+                        /* Empty else marker. */
+                    }
                 }
-                else if( socketStatus != CELLULAR_SUCCESS )
+
+                if( found < CELLULAR_SOCKET_POOL_SIZE )
                 {
-                    retSendLength = ( BaseType_t ) TCP_SOCKETS_ERRNO_ERROR;
+                    ( void ) strcpy( socketReserves[ found ].hostName, pHostName );
+                    socketReserves[ found ].port = port;
+                    socketReserves[ found ].count = uxCount;
                 }
+            }
+            ( void ) xTaskResumeAll();
 
-                break;
+            if( found == CELLULAR_SOCKET_POOL_SIZE )
+            {
+                retReserve = TCP_SOCKETS_ERRNO_ENOSPC;
+            }
+            else
+            {
+                prvPoolReplenish();
             }
         }
+    #else /* if ( CELLULAR_SOCKET_POOL_SIZE > 0U ) */
+        ( void ) pHostName;
+        ( void ) port;
+        ( void ) uxCount;
+        retReserve = TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+    #endif /* if ( CELLULAR_SOCKET_POOL_SIZE > 0U ) */
+
+    return retReserve;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TCP_Sockets_GetSendStats( Socket_t xSocket,
+                                     TCPSocketsSendStats_t * pStats )
+{
+    BaseType_t retGetStats = TCP_SOCKETS_ERRNO_NONE;
+    cellularSocketWrapper_t * pCellularSocketContext = ( cellularSocketWrapper_t * ) xSocket;
+    uint64_t sendDurationMs = 0;
+
+    if( ( pCellularSocketContext == NULL ) || ( pStats == NULL ) )
+    {
+        LogError( ( "Cellular TCP_Sockets_GetSendStats Invalid parameter %p %p", pCellularSocketContext, pStats ) );
+        retGetStats = TCP_SOCKETS_ERRNO_EINVAL;
+    }
+    else
+    {
+        /* The send task updates the figures while sends are outstanding. */
+        taskENTER_CRITICAL();
+        {
+            *pStats = pCellularSocketContext->sendStats;
+            sendDurationMs = pCellularSocketContext->sendCompleteMs - pCellularSocketContext->sendStartMs;
+        }
+        taskEXIT_CRITICAL();
 
-        LogDebug( ( "TCP_Sockets_Send expect %d write %d", xDataLength, sentLength ) );
+        if( ( pStats->bytesSent > 0U ) && ( sendDurationMs > 0U ) )
+        {
+            pStats->bytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) pStats->bytesSent * 1000U ) / sendDurationMs );
+        }
     }
 
-    return retSendLength;
+    return retGetStats;
 }
 
 /*-----------------------------------------------------------*/
@@ -37,6 +37,7 @@
 
 /* FreeRTOS+TCP includes. */
 #include "FreeRTOS_IP.h"
+#include "FreeRTOS_TCP_IP.h"
 #include "FreeRTOS_Sockets.h"
 #include "FreeRTOS_DNS.h"
 
@@ -61,6 +62,9 @@ extern void vLoggingPrintf( const char * pcFormatString,
 #define SOCKET_T_TYPEDEFED
 #include "tcp_sockets_wrapper.h"
 
+/* Resolver cache shared by the sockets wrapper ports. */
+#include "dns_cache.h"
+
 /**
  * @brief Maximum number of times to call FreeRTOS_recv when initiating a graceful shutdown.
  */
@@ -73,104 +77,670 @@ extern void vLoggingPrintf( const char * pcFormatString,
  */
 #define FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR    ( -1 )
 
+#if ( ipconfigUSE_IPv6 != 0 )
+
 /**
- * @brief Establish a connection to server.
+ * @brief The head start given to the connection to the preferred address
+ * family before the other family is tried as well, as the Connection Attempt
+ * Delay of RFC 8305.
+ */
+    #ifndef FREERTOS_SOCKETS_WRAPPER_ATTEMPT_DELAY_MS
+        #define FREERTOS_SOCKETS_WRAPPER_ATTEMPT_DELAY_MS    ( 250U )
+    #endif
+
+/**
+ * @brief The interval at which the racing connections are checked.
+ */
+    #ifndef FREERTOS_SOCKETS_WRAPPER_RACE_POLL_MS
+        #define FREERTOS_SOCKETS_WRAPPER_RACE_POLL_MS    ( 10U )
+    #endif
+
+/**
+ * @brief The number of host names whose last successful address family is
+ * remembered.
+ */
+    #ifndef FREERTOS_SOCKETS_WRAPPER_FAMILY_CACHE_SIZE
+        #define FREERTOS_SOCKETS_WRAPPER_FAMILY_CACHE_SIZE    ( 4U )
+    #endif
+
+/**
+ * @brief The most addresses of a server, one of each address family.
+ */
+    #define FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES    ( 2U )
+
+/**
+ * @brief The addresses of a host name, as kept in the resolver cache.
+ */
+typedef struct ResolvedAddresses
+{
+    uint32_t ipv4Address;                          /**< @brief The IPv4 address in network byte order, or 0. */
+    uint8_t ipv6Address[ ipSIZE_OF_IPv6_ADDRESS ]; /**< @brief The IPv6 address, valid if hasIpv6Address is set. */
+    BaseType_t hasIpv6Address;                     /**< @brief pdTRUE if the host has an IPv6 address. */
+} ResolvedAddresses_t;
+
+/**
+ * @brief The address family which last won the connection race to a host.
+ */
+typedef struct FamilyPreference
+{
+    char hostName[ dnscacheMAX_HOST_LENGTH ]; /**< @brief The host name, or an empty string. */
+    BaseType_t family;                        /**< @brief FREERTOS_AF_INET6 or FREERTOS_AF_INET4. */
+} FamilyPreference_t;
+
+/**
+ * @brief The remembered address families, replaced in turn.
+ */
+static FamilyPreference_t familyPreferences[ FREERTOS_SOCKETS_WRAPPER_FAMILY_CACHE_SIZE ];
+
+/**
+ * @brief The entry of familyPreferences to replace next.
+ */
+static UBaseType_t nextFamilyPreference = 0U;
+
+#else /* if ( ipconfigUSE_IPv6 != 0 ) */
+
+/**
+ * @brief The most addresses of a server.
+ */
+    #define FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES    ( 1U )
+
+#endif /* if ( ipconfigUSE_IPv6 != 0 ) */
+
+#if ( ipconfigUSE_IPv6 != 0 )
+
+/**
+ * @brief Resolve a host name with the DNS client of FreeRTOS+TCP, for the
+ * resolver cache.
  *
- * @param[out] pTcpSocket The output parameter to return the created socket descriptor.
- * @param[in] pHostName Server hostname to connect to.
- * @param[in] pServerInfo Server port to connect to.
- * @param[in] receiveTimeoutMs Timeout (in milliseconds) for transport receive.
- * @param[in] sendTimeoutMs Timeout (in milliseconds) for transport send.
+ * Both the AAAA and the A record are asked for, so that TCP_Sockets_Connect()
+ * can race the two address families.
  *
- * @note A timeout of 0 means infinite timeout.
+ * @param[in] pHostName Server hostname to resolve.
+ * @param[out] pAddress Filled in with a ResolvedAddresses_t.
+ * @param[in, out] pTtlMs Left at the default, as FreeRTOS_getaddrinfo() does
+ * not report the time to live.
  *
- * @return Non-zero value on error, 0 on success.
+ * @return pdPASS if an address of either family was found, otherwise pdFAIL.
  */
-BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
-                                const char * pHostName,
-                                uint16_t port,
-                                uint32_t receiveTimeoutMs,
-                                uint32_t sendTimeoutMs )
-{
-    Socket_t tcpSocket = FREERTOS_INVALID_SOCKET;
-    BaseType_t socketStatus = 0;
-    struct freertos_sockaddr serverAddress = { 0 };
-    TickType_t transportTimeout = 0;
+    static BaseType_t prvDnsResolve( const char * pHostName,
+                                     void * pAddress,
+                                     uint32_t * pTtlMs )
+    {
+        static const BaseType_t families[ FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES ] = { FREERTOS_AF_INET6, FREERTOS_AF_INET4 };
+        ResolvedAddresses_t addresses;
+        struct freertos_addrinfo hints;
+        struct freertos_addrinfo * pResults;
+        const struct freertos_addrinfo * pResult;
+        size_t index;
 
-    configASSERT( pTcpSocket != NULL );
-    configASSERT( pHostName != NULL );
+        ( void ) pTtlMs;
 
-    /* Create a new TCP socket. */
-    tcpSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        configASSERT( sizeof( addresses ) <= dnscacheADDRESS_SIZE );
 
-    if( tcpSocket == FREERTOS_INVALID_SOCKET )
+        ( void ) memset( &addresses, 0, sizeof( addresses ) );
+
+        if( FreeRTOS_inet_pton( FREERTOS_AF_INET6, pHostName, addresses.ipv6Address ) == pdPASS )
+        {
+            addresses.hasIpv6Address = pdTRUE;
+        }
+        else if( FreeRTOS_inet_pton( FREERTOS_AF_INET4, pHostName, &( addresses.ipv4Address ) ) == pdPASS )
+        {
+            /* An IPv4 address, nothing to resolve. */
+        }
+        else
+        {
+            for( index = 0U; index < FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES; index++ )
+            {
+                ( void ) memset( &hints, 0, sizeof( hints ) );
+                hints.ai_family = families[ index ];
+                pResults = NULL;
+
+                if( ( FreeRTOS_getaddrinfo( pHostName, NULL, &hints, &pResults ) == 0 ) && ( pResults != NULL ) )
+                {
+                    for( pResult = pResults; pResult != NULL; pResult = pResult->ai_next )
+                    {
+                        if( ( pResult->ai_family == FREERTOS_AF_INET6 ) && ( addresses.hasIpv6Address == pdFALSE ) )
+                        {
+                            ( void ) memcpy( addresses.ipv6Address,
+                                             pResult->ai_addr->sin_address.xIP_IPv6.ucBytes,
+                                             ipSIZE_OF_IPv6_ADDRESS );
+                            addresses.hasIpv6Address = pdTRUE;
+                        }
+                        else if( ( pResult->ai_family == FREERTOS_AF_INET4 ) && ( addresses.ipv4Address == 0U ) )
+                        {
+                            addresses.ipv4Address = pResult->ai_addr->sin_address.ulIP_IPv4;
+                        }
+                        else
+                        {
+                            /* Only the first address of a family is used. */
+                        }
+                    }
+                }
+
+                if( pResults != NULL )
+                {
+                    FreeRTOS_freeaddrinfo( pResults );
+                }
+            }
+        }
+
+        ( void ) memcpy( pAddress, &addresses, sizeof( addresses ) );
+
+        return ( ( addresses.hasIpv6Address != pdFALSE ) || ( addresses.ipv4Address != 0U ) ) ? pdPASS : pdFAIL;
+    }
+
+/**
+ * @brief Return the address family which last won the connection race to a
+ * host, or FREERTOS_AF_INET6 if none is remembered.
+ *
+ * @param[in] pHostName The host name.
+ *
+ * @return FREERTOS_AF_INET6 or FREERTOS_AF_INET4.
+ */
+    static BaseType_t prvGetPreferredFamily( const char * pHostName )
     {
-        LogError( ( "Failed to create new socket." ) );
-        socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
+        BaseType_t family = FREERTOS_AF_INET6;
+        UBaseType_t index;
+
+        taskENTER_CRITICAL();
+        {
+            for( index = 0U; index < FREERTOS_SOCKETS_WRAPPER_FAMILY_CACHE_SIZE; index++ )
+            {
+                if( strncmp( familyPreferences[ index ].hostName, pHostName, dnscacheMAX_HOST_LENGTH ) == 0 )
+                {
+                    family = familyPreferences[ index ].family;
+                    break;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return family;
     }
-    else
+
+/**
+ * @brief Remember the address family which won the connection race to a host.
+ *
+ * @param[in] pHostName The host name.
+ * @param[in] family FREERTOS_AF_INET6 or FREERTOS_AF_INET4.
+ */
+    static void prvSetPreferredFamily( const char * pHostName,
+                                       BaseType_t family )
     {
-        LogDebug( ( "Created new TCP socket." ) );
+        UBaseType_t index;
 
-        /* Connection parameters. */
-        serverAddress.sin_family = FREERTOS_AF_INET;
-        serverAddress.sin_port = FreeRTOS_htons( port );
-        serverAddress.sin_len = ( uint8_t ) sizeof( serverAddress );
+        if( ( pHostName[ 0 ] != '\0' ) && ( strlen( pHostName ) < dnscacheMAX_HOST_LENGTH ) )
+        {
+            taskENTER_CRITICAL();
+            {
+                for( index = 0U; index < FREERTOS_SOCKETS_WRAPPER_FAMILY_CACHE_SIZE; index++ )
+                {
+                    if( strncmp( familyPreferences[ index ].hostName, pHostName, dnscacheMAX_HOST_LENGTH ) == 0 )
+                    {
+                        break;
+                    }
+                }
 
-        #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
-            serverAddress.sin_address.ulIP_IPv4 = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
+                if( index == FREERTOS_SOCKETS_WRAPPER_FAMILY_CACHE_SIZE )
+                {
+                    index = nextFamilyPreference;
+                    nextFamilyPreference = ( nextFamilyPreference + 1U ) % FREERTOS_SOCKETS_WRAPPER_FAMILY_CACHE_SIZE;
+                    ( void ) strcpy( familyPreferences[ index ].hostName, pHostName );
+                }
 
-            /* Check for errors from DNS lookup. */
-            if( serverAddress.sin_address.ulIP_IPv4 == 0U )
-        #else
-            serverAddress.sin_addr = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
+                familyPreferences[ index ].family = family;
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
 
-            /* Check for errors from DNS lookup. */
-            if( serverAddress.sin_addr == 0U )
-        #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+/**
+ * @brief Resolve the addresses of a server.
+ *
+ * @param[in] pHostName Server hostname to resolve.
+ * @param[in] port Server port.
+ * @param[out] pServerAddresses The addresses to connect to, in the order in
+ * which they are to be tried.  Room for FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES.
+ * @param[out] pAddressCount The number of addresses filled in.
+ *
+ * @return Non-zero value on error, 0 on success.
+ */
+    static BaseType_t prvResolveServerAddress( const char * pHostName,
+                                               uint16_t port,
+                                               struct freertos_sockaddr * pServerAddresses,
+                                               size_t * pAddressCount )
+    {
+        BaseType_t socketStatus = 0;
+        uint8_t address[ dnscacheADDRESS_SIZE ];
+        ResolvedAddresses_t addresses;
+        struct freertos_sockaddr * pIpv6Address;
+        struct freertos_sockaddr * pIpv4Address;
+
+        *pAddressCount = 0U;
 
+        /* Check for errors from DNS lookup. */
+        if( xDnsCacheLookup( pHostName, address, prvDnsResolve ) != pdPASS )
         {
             LogError( ( "Failed to connect to server: DNS resolution failed: Hostname=%s.",
                         pHostName ) );
             socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
         }
+        else
+        {
+            ( void ) memcpy( &addresses, address, sizeof( addresses ) );
+
+            /* The family which last won the race to the host is tried first. */
+            if( prvGetPreferredFamily( pHostName ) == FREERTOS_AF_INET4 )
+            {
+                pIpv4Address = &( pServerAddresses[ 0 ] );
+                pIpv6Address = &( pServerAddresses[ ( addresses.ipv4Address != 0U ) ? 1 : 0 ] );
+            }
+            else
+            {
+                pIpv6Address = &( pServerAddresses[ 0 ] );
+                pIpv4Address = &( pServerAddresses[ ( addresses.hasIpv6Address != pdFALSE ) ? 1 : 0 ] );
+            }
+
+            if( addresses.hasIpv6Address != pdFALSE )
+            {
+                ( void ) memset( pIpv6Address, 0, sizeof( *pIpv6Address ) );
+                pIpv6Address->sin_family = FREERTOS_AF_INET6;
+                pIpv6Address->sin_port = FreeRTOS_htons( port );
+                pIpv6Address->sin_len = ( uint8_t ) sizeof( *pIpv6Address );
+                ( void ) memcpy( pIpv6Address->sin_address.xIP_IPv6.ucBytes, addresses.ipv6Address, ipSIZE_OF_IPv6_ADDRESS );
+                ( *pAddressCount )++;
+            }
+
+            if( addresses.ipv4Address != 0U )
+            {
+                ( void ) memset( pIpv4Address, 0, sizeof( *pIpv4Address ) );
+                pIpv4Address->sin_family = FREERTOS_AF_INET4;
+                pIpv4Address->sin_port = FreeRTOS_htons( port );
+                pIpv4Address->sin_len = ( uint8_t ) sizeof( *pIpv4Address );
+                pIpv4Address->sin_address.ulIP_IPv4 = addresses.ipv4Address;
+                ( *pAddressCount )++;
+            }
+        }
+
+        return socketStatus;
     }
 
-    if( socketStatus == 0 )
+#else /* if ( ipconfigUSE_IPv6 != 0 ) */
+
+/**
+ * @brief Resolve a host name with the DNS client of FreeRTOS+TCP, for the
+ * resolver cache.
+ *
+ * @param[in] pHostName Server hostname to resolve.
+ * @param[out] pAddress Filled in with the IPv4 address, in network byte order.
+ * @param[in, out] pTtlMs Left at the default, as FreeRTOS_gethostbyname() does
+ * not report the time to live.
+ *
+ * @return pdPASS if the host name was resolved, otherwise pdFAIL.
+ */
+    static BaseType_t prvDnsResolve( const char * pHostName,
+                                     void * pAddress,
+                                     uint32_t * pTtlMs )
+    {
+        uint32_t ipAddress = ( uint32_t ) FreeRTOS_gethostbyname( pHostName );
+
+        ( void ) pTtlMs;
+
+        ( void ) memcpy( pAddress, &ipAddress, sizeof( ipAddress ) );
+
+        return ( ipAddress != 0U ) ? pdPASS : pdFAIL;
+    }
+
+/**
+ * @brief Resolve the address of a server.
+ *
+ * @param[in] pHostName Server hostname to resolve.
+ * @param[in] port Server port.
+ * @param[out] pServerAddresses The address to connect to.
+ * @param[out] pAddressCount Set to 1 on success.
+ *
+ * @return Non-zero value on error, 0 on success.
+ */
+    static BaseType_t prvResolveServerAddress( const char * pHostName,
+                                               uint16_t port,
+                                               struct freertos_sockaddr * pServerAddresses,
+                                               size_t * pAddressCount )
     {
-        /* Establish connection. */
-        LogDebug( ( "Creating TCP Connection to %s.", pHostName ) );
-        socketStatus = FreeRTOS_connect( tcpSocket, &serverAddress, sizeof( serverAddress ) );
+        BaseType_t socketStatus = 0;
+        uint8_t address[ dnscacheADDRESS_SIZE ];
+        uint32_t ipAddress = 0U;
+
+        *pAddressCount = 0U;
+
+        /* Connection parameters. */
+        pServerAddresses->sin_family = FREERTOS_AF_INET;
+        pServerAddresses->sin_port = FreeRTOS_htons( port );
+        pServerAddresses->sin_len = ( uint8_t ) sizeof( *pServerAddresses );
 
-        if( socketStatus != 0 )
+        /* Check for errors from DNS lookup. */
+        if( xDnsCacheLookup( pHostName, address, prvDnsResolve ) != pdPASS )
         {
-            LogError( ( "Failed to connect to server: FreeRTOS_Connect failed: ReturnCode=%d,"
-                        " Hostname=%s, Port=%u.",
-                        socketStatus,
-                        pHostName,
-                        port ) );
+            LogError( ( "Failed to connect to server: DNS resolution failed: Hostname=%s.",
+                        pHostName ) );
+            socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
+        }
+        else
+        {
+            ( void ) memcpy( &ipAddress, address, sizeof( ipAddress ) );
+            *pAddressCount = 1U;
         }
+
+        #if defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 )
+            pServerAddresses->sin_address.ulIP_IPv4 = ipAddress;
+        #else
+            pServerAddresses->sin_addr = ipAddress;
+        #endif /* defined( ipconfigIPv4_BACKWARD_COMPATIBLE ) && ( ipconfigIPv4_BACKWARD_COMPATIBLE == 0 ) */
+
+        return socketStatus;
     }
 
-    if( socketStatus == 0 )
+#endif /* if ( ipconfigUSE_IPv6 != 0 ) */
+
+/**
+ * @brief Create a socket for the family of an address and send the SYN to it,
+ * without waiting for the connection to be established.
+ *
+ * @param[in] pServerAddress The address to connect to.
+ *
+ * @return The socket, with zero receive and send timeouts, or
+ * FREERTOS_INVALID_SOCKET on error.
+ */
+static Socket_t prvConnectStart( const struct freertos_sockaddr * pServerAddress )
+{
+    Socket_t tcpSocket = FREERTOS_INVALID_SOCKET;
+    BaseType_t socketStatus = 0;
+    TickType_t transportTimeout = 0;
+
+    /* Create a new TCP socket. */
+    tcpSocket = FreeRTOS_socket( pServerAddress->sin_family, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+    if( tcpSocket == FREERTOS_INVALID_SOCKET )
+    {
+        LogError( ( "Failed to create new socket." ) );
+    }
+    else
     {
-        /* Set socket receive timeout. */
-        transportTimeout = pdMS_TO_TICKS( receiveTimeoutMs );
-        /* Setting the receive block time cannot fail. */
+        LogDebug( ( "Created new TCP socket." ) );
+
+        /* With zero timeouts, FreeRTOS_connect() only sends the SYN, and
+         * sends and receives return at once. */
         ( void ) FreeRTOS_setsockopt( tcpSocket,
                                       0,
                                       FREERTOS_SO_RCVTIMEO,
                                       &transportTimeout,
                                       sizeof( TickType_t ) );
-
-        /* Set socket send timeout. */
-        transportTimeout = pdMS_TO_TICKS( sendTimeoutMs );
-        /* Setting the send block time cannot fail. */
         ( void ) FreeRTOS_setsockopt( tcpSocket,
                                       0,
                                       FREERTOS_SO_SNDTIMEO,
                                       &transportTimeout,
                                       sizeof( TickType_t ) );
+
+        socketStatus = FreeRTOS_connect( tcpSocket, pServerAddress, sizeof( *pServerAddress ) );
+
+        if( ( socketStatus != 0 ) &&
+            ( socketStatus != -pdFREERTOS_ERRNO_EWOULDBLOCK ) &&
+            ( socketStatus != -pdFREERTOS_ERRNO_EINPROGRESS ) )
+        {
+            LogError( ( "Failed to connect to server: FreeRTOS_Connect failed: ReturnCode=%d.",
+                        socketStatus ) );
+            ( void ) FreeRTOS_closesocket( tcpSocket );
+            tcpSocket = FREERTOS_INVALID_SOCKET;
+        }
+    }
+
+    return tcpSocket;
+}
+
+#if ( ipconfigUSE_IPv6 != 0 )
+
+/**
+ * @brief Race connections to the addresses of a server, as in RFC 8305.
+ *
+ * The first address is tried at once.  The next one is tried when the one
+ * before it failed or has had FREERTOS_SOCKETS_WRAPPER_ATTEMPT_DELAY_MS to
+ * connect.  The first connection established wins and the others are closed.
+ *
+ * @param[in] pServerAddresses The addresses, in the order in which they are
+ * to be tried.
+ * @param[in] addressCount The number of addresses.
+ * @param[out] pWinner Set to the index of the address connected to.
+ *
+ * @return The connected socket, with zero receive and send timeouts, or
+ * FREERTOS_INVALID_SOCKET if no connection was established within
+ * ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME, the time FreeRTOS_connect() would
+ * have blocked for.
+ */
+    static Socket_t prvConnectRace( const struct freertos_sockaddr * pServerAddresses,
+                                    size_t addressCount,
+                                    size_t * pWinner )
+    {
+        Socket_t tcpSockets[ FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES ];
+        Socket_t tcpSocket = FREERTOS_INVALID_SOCKET;
+        const TickType_t attemptDelay = pdMS_TO_TICKS( FREERTOS_SOCKETS_WRAPPER_ATTEMPT_DELAY_MS );
+        const TickType_t pollDelay = ( pdMS_TO_TICKS( FREERTOS_SOCKETS_WRAPPER_RACE_POLL_MS ) > 0U ) ?
+                                     pdMS_TO_TICKS( FREERTOS_SOCKETS_WRAPPER_RACE_POLL_MS ) : 1U;
+        const TickType_t startTime = xTaskGetTickCount();
+        TickType_t elapsed = 0U;
+        size_t started = 0U;
+        size_t connecting = 0U;
+        size_t index;
+
+        configASSERT( addressCount <= FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES );
+
+        for( ; ; )
+        {
+            /* Start the next attempt once the previous ones had their head
+             * start, or at once if they have all failed. */
+            if( ( started < addressCount ) &&
+                ( ( connecting == 0U ) || ( elapsed >= ( attemptDelay * ( TickType_t ) started ) ) ) )
+            {
+                LogDebug( ( "Trying the IPv%c address of the server.",
+                            ( pServerAddresses[ started ].sin_family == FREERTOS_AF_INET6 ) ? '6' : '4' ) );
+                tcpSockets[ started ] = prvConnectStart( &( pServerAddresses[ started ] ) );
+                started++;
+            }
+
+            connecting = 0U;
+
+            for( index = 0U; index < started; index++ )
+            {
+                if( tcpSockets[ index ] != FREERTOS_INVALID_SOCKET )
+                {
+                    BaseType_t pollStatus = TCP_Sockets_ConnectPoll( tcpSockets[ index ] );
+
+                    if( pollStatus == TCP_SOCKETS_ERRNO_NONE )
+                    {
+                        tcpSocket = tcpSockets[ index ];
+                        tcpSockets[ index ] = FREERTOS_INVALID_SOCKET;
+                        *pWinner = index;
+                        break;
+                    }
+                    else if( pollStatus == TCP_SOCKETS_ERRNO_EWOULDBLOCK )
+                    {
+                        connecting++;
+                    }
+                    else
+                    {
+                        ( void ) FreeRTOS_closesocket( tcpSockets[ index ] );
+                        tcpSockets[ index ] = FREERTOS_INVALID_SOCKET;
+                    }
+                }
+            }
+
+            elapsed = xTaskGetTickCount() - startTime;
+
+            if( ( tcpSocket != FREERTOS_INVALID_SOCKET ) ||
+                ( ( connecting == 0U ) && ( started == addressCount ) ) ||
+                ( elapsed >= ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME ) )
+            {
+                break;
+            }
+
+            if( connecting > 0U )
+            {
+                vTaskDelay( pollDelay );
+                elapsed = xTaskGetTickCount() - startTime;
+            }
+        }
+
+        /* Close the attempts which lost the race. */
+        for( index = 0U; index < started; index++ )
+        {
+            if( tcpSockets[ index ] != FREERTOS_INVALID_SOCKET )
+            {
+                ( void ) FreeRTOS_closesocket( tcpSockets[ index ] );
+            }
+        }
+
+        return tcpSocket;
+    }
+
+#endif /* if ( ipconfigUSE_IPv6 != 0 ) */
+
+/**
+ * @brief Convert the return value of FreeRTOS_recv() to a sockets wrapper one.
+ *
+ * @param[in] xRecvStatus The value returned by FreeRTOS_recv().
+ *
+ * @return The number of bytes received, 0 on timeout, or a negative
+ * @ref SocketsErrors value.
+ */
+static int32_t prvConvertRecvStatus( BaseType_t xRecvStatus )
+{
+    int xReturnStatus = TCP_SOCKETS_ERRNO_ERROR;
+
+    switch( xRecvStatus )
+    {
+        /* Socket was closed or just got closed. */
+        case -pdFREERTOS_ERRNO_ENOTCONN:
+            xReturnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+            break;
+
+        /* Not enough memory for the socket to create either an Rx or Tx stream. */
+        case -pdFREERTOS_ERRNO_ENOMEM:
+            xReturnStatus = TCP_SOCKETS_ERRNO_ENOMEM;
+            break;
+
+        /* Socket is not valid, is not a TCP socket, or is not bound. */
+        case -pdFREERTOS_ERRNO_EINVAL:
+            xReturnStatus = TCP_SOCKETS_ERRNO_EINVAL;
+            break;
+
+        /* Socket received a signal, causing the read operation to be aborted. */
+        case -pdFREERTOS_ERRNO_EINTR:
+            xReturnStatus = TCP_SOCKETS_ERRNO_EINTR;
+            break;
+
+        default:
+            xReturnStatus = ( int ) xRecvStatus;
+            break;
+    }
+
+    return xReturnStatus;
+}
+
+/**
+ * @brief Establish a connection to server.
+ *
+ * @param[out] pTcpSocket The output parameter to return the created socket descriptor.
+ * @param[in] pHostName Server hostname to connect to.
+ * @param[in] pServerInfo Server port to connect to.
+ * @param[in] receiveTimeoutMs Timeout (in milliseconds) for transport receive.
+ * @param[in] sendTimeoutMs Timeout (in milliseconds) for transport send.
+ *
+ * @note A timeout of 0 means infinite timeout.
+ *
+ * @return Non-zero value on error, 0 on success.
+ */
+BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
+                                const char * pHostName,
+                                uint16_t port,
+                                uint32_t receiveTimeoutMs,
+                                uint32_t sendTimeoutMs )
+{
+    Socket_t tcpSocket = FREERTOS_INVALID_SOCKET;
+    BaseType_t socketStatus = 0;
+    struct freertos_sockaddr serverAddresses[ FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES ] = { 0 };
+    size_t addressCount = 0U;
+
+    configASSERT( pTcpSocket != NULL );
+    configASSERT( pHostName != NULL );
+
+    socketStatus = prvResolveServerAddress( pHostName, port, serverAddresses, &addressCount );
+
+    #if ( ipconfigUSE_IPv6 != 0 )
+        if( ( socketStatus == 0 ) && ( addressCount > 1U ) )
+        {
+            size_t winner = 0U;
+
+            /* Race the two address families, so that a broken path of one
+             * of them does not cost a whole connect timeout. */
+            LogDebug( ( "Racing TCP Connections to %s.", pHostName ) );
+            tcpSocket = prvConnectRace( serverAddresses, addressCount, &winner );
+
+            if( tcpSocket == FREERTOS_INVALID_SOCKET )
+            {
+                LogError( ( "Failed to connect to server: no address family connected:"
+                            " Hostname=%s, Port=%u.",
+                            pHostName,
+                            port ) );
+                socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
+            }
+            else
+            {
+                prvSetPreferredFamily( pHostName, serverAddresses[ winner ].sin_family );
+            }
+        }
+        else
+    #endif /* if ( ipconfigUSE_IPv6 != 0 ) */
+
+    if( socketStatus == 0 )
+    {
+        /* Create a new TCP socket. */
+        tcpSocket = FreeRTOS_socket( serverAddresses[ 0 ].sin_family, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+        if( tcpSocket == FREERTOS_INVALID_SOCKET )
+        {
+            LogError( ( "Failed to create new socket." ) );
+            socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
+        }
+        else
+        {
+            LogDebug( ( "Created new TCP socket." ) );
+
+            /* Establish connection. */
+            LogDebug( ( "Creating TCP Connection to %s.", pHostName ) );
+            socketStatus = FreeRTOS_connect( tcpSocket, &( serverAddresses[ 0 ] ), sizeof( serverAddresses[ 0 ] ) );
+
+            if( socketStatus != 0 )
+            {
+                LogError( ( "Failed to connect to server: FreeRTOS_Connect failed: ReturnCode=%d,"
+                            " Hostname=%s, Port=%u.",
+                            socketStatus,
+                            pHostName,
+                            port ) );
+            }
+        }
+    }
+    else
+    {
+        /* Empty else marker. */
+    }
+
+    if( ( socketStatus != 0 ) && ( addressCount > 0U ) )
+    {
+        /* The server may have moved, so resolve it again next time. */
+        vDnsCacheInvalidate( pHostName );
+    }
+
+    if( socketStatus == 0 )
+    {
+        ( void ) TCP_Sockets_SetTimeouts( tcpSocket, receiveTimeoutMs, sendTimeoutMs );
     }
 
     /* Clean up on failure. */
@@ -192,6 +762,136 @@ BaseType_t TCP_Sockets_Connect( Socket_t * pTcpSocket,
     return socketStatus;
 }
 
+/**
+ * @brief Begin a connection to server, without waiting for it to be established.
+ *
+ * @param[out] pTcpSocket The output parameter to return the created socket descriptor.
+ * @param[in] pHostName Server hostname to connect to.
+ * @param[in] port Server port to connect to.
+ *
+ * @note The DNS lookup still blocks, unless the host name is an address or is
+ * in the DNS cache.  Only the preferred address of the server is tried.
+ *
+ * @return Non-zero value on error, 0 if the connection was begun.
+ */
+BaseType_t TCP_Sockets_ConnectStart( Socket_t * pTcpSocket,
+                                     const char * pHostName,
+                                     uint16_t port )
+{
+    Socket_t tcpSocket = FREERTOS_INVALID_SOCKET;
+    BaseType_t socketStatus = 0;
+    struct freertos_sockaddr serverAddresses[ FREERTOS_SOCKETS_WRAPPER_MAX_ADDRESSES ] = { 0 };
+    size_t addressCount = 0U;
+
+    configASSERT( pTcpSocket != NULL );
+    configASSERT( pHostName != NULL );
+
+    socketStatus = prvResolveServerAddress( pHostName, port, serverAddresses, &addressCount );
+
+    if( socketStatus == 0 )
+    {
+        LogDebug( ( "Starting TCP Connection to %s.", pHostName ) );
+        tcpSocket = prvConnectStart( &( serverAddresses[ 0 ] ) );
+
+        if( tcpSocket == FREERTOS_INVALID_SOCKET )
+        {
+            LogError( ( "Failed to start connection: Hostname=%s, Port=%u.",
+                        pHostName,
+                        port ) );
+            socketStatus = FREERTOS_SOCKETS_WRAPPER_NETWORK_ERROR;
+        }
+        else
+        {
+            /* Set the socket. */
+            *pTcpSocket = tcpSocket;
+        }
+    }
+
+    return socketStatus;
+}
+
+/**
+ * @brief Refresh the cached resolutions which are about to expire.
+ *
+ * @return The number of host names resolved again.
+ */
+UBaseType_t TCP_Sockets_DnsPrefetch( void )
+{
+    return uxDnsCachePrefetch( prvDnsResolve );
+}
+
+/**
+ * @brief Check on a connection begun by TCP_Sockets_ConnectStart().
+ *
+ * @param[in] tcpSocket The socket descriptor.
+ *
+ * @return TCP_SOCKETS_ERRNO_NONE once connected, TCP_SOCKETS_ERRNO_EWOULDBLOCK
+ * while connecting, or TCP_SOCKETS_ERRNO_ENOTCONN if the connection failed.
+ */
+BaseType_t TCP_Sockets_ConnectPoll( Socket_t tcpSocket )
+{
+    BaseType_t socketStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
+    BaseType_t tcpState;
+
+    configASSERT( tcpSocket != NULL );
+
+    tcpState = FreeRTOS_connstatus( tcpSocket );
+
+    if( FreeRTOS_issocketconnected( tcpSocket ) == pdTRUE )
+    {
+        socketStatus = TCP_SOCKETS_ERRNO_NONE;
+    }
+    else if( ( tcpState == ( BaseType_t ) eCONNECT_SYN ) ||
+             ( tcpState == ( BaseType_t ) eSYN_FIRST ) ||
+             ( tcpState == ( BaseType_t ) eSYN_RECEIVED ) )
+    {
+        socketStatus = TCP_SOCKETS_ERRNO_EWOULDBLOCK;
+    }
+    else
+    {
+        /* The connection was refused, or timed out. */
+        LogError( ( "Failed to connect to server: TCP state %d.", ( int ) tcpState ) );
+    }
+
+    return socketStatus;
+}
+
+/**
+ * @brief Set the timeouts of a connected socket.
+ *
+ * @param[in] tcpSocket The socket descriptor.
+ * @param[in] receiveTimeoutMs Timeout (in milliseconds) for transport receive.
+ * @param[in] sendTimeoutMs Timeout (in milliseconds) for transport send.
+ *
+ * @return Non-zero value on error, 0 on success.
+ */
+BaseType_t TCP_Sockets_SetTimeouts( Socket_t tcpSocket,
+                                    uint32_t receiveTimeoutMs,
+                                    uint32_t sendTimeoutMs )
+{
+    TickType_t transportTimeout = 0;
+
+    configASSERT( tcpSocket != NULL );
+
+    /* Setting the receive block time cannot fail. */
+    transportTimeout = pdMS_TO_TICKS( receiveTimeoutMs );
+    ( void ) FreeRTOS_setsockopt( tcpSocket,
+                                  0,
+                                  FREERTOS_SO_RCVTIMEO,
+                                  &transportTimeout,
+                                  sizeof( TickType_t ) );
+
+    /* Setting the send block time cannot fail. */
+    transportTimeout = pdMS_TO_TICKS( sendTimeoutMs );
+    ( void ) FreeRTOS_setsockopt( tcpSocket,
+                                  0,
+                                  FREERTOS_SO_SNDTIMEO,
+                                  &transportTimeout,
+                                  sizeof( TickType_t ) );
+
+    return 0;
+}
+
 /**
  * @brief End connection to server.
  *
@@ -283,6 +983,153 @@ int32_t TCP_Sockets_Send( Socket_t xSocket,
     return xReturnStatus;
 }
 
+/**
+ * @brief Transmit the data of several buffers to the remote socket.
+ *
+ * The socket must have already been created using a call to TCP_Sockets_Connect().
+ *
+ * @param[in] xSocket The handle of the sending socket.
+ * @param[in] pxVectors The buffers containing the data to be sent.
+ * @param[in] xVectorCount The number of buffers in @p pxVectors.
+ *
+ * @return
+ * * On success, the number of bytes actually sent is returned.
+ * * If an error occurred before any data was sent, a negative value is returned. @ref SocketsErrors
+ */
+int32_t TCP_Sockets_SendVector( Socket_t xSocket,
+                                const TransportOutVector_t * pxVectors,
+                                size_t xVectorCount )
+{
+    int32_t xSendStatus = 0;
+    int32_t xReturnStatus = 0;
+    size_t xIndex;
+
+    configASSERT( xSocket != NULL );
+    configASSERT( pxVectors != NULL );
+
+    /* FreeRTOS_send() only copies the data into the socket's Tx stream, so the
+     * buffers are still sent together in as few segments as the stream allows. */
+    for( xIndex = 0U; xIndex < xVectorCount; xIndex++ )
+    {
+        if( pxVectors[ xIndex ].iov_len > 0U )
+        {
+            xSendStatus = TCP_Sockets_Send( xSocket,
+                                            pxVectors[ xIndex ].iov_base,
+                                            pxVectors[ xIndex ].iov_len );
+
+            if( xSendStatus < 0 )
+            {
+                /* Report the error only if no data was sent; otherwise the
+                 * next send reports it. */
+                if( xReturnStatus == 0 )
+                {
+                    xReturnStatus = xSendStatus;
+                }
+
+                break;
+            }
+
+            xReturnStatus += xSendStatus;
+
+            /* Stop when the Tx stream is full. */
+            if( ( size_t ) xSendStatus < pxVectors[ xIndex ].iov_len )
+            {
+                break;
+            }
+        }
+    }
+
+    return xReturnStatus;
+}
+
+/**
+ * @brief Hold back small sends so that they leave the socket together.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[in] xCork pdTRUE to cork the socket, pdFALSE to uncork it.
+ *
+ * @return 0 on success, or a negative value on error.
+ */
+BaseType_t TCP_Sockets_SetCork( Socket_t xSocket,
+                                BaseType_t xCork )
+{
+    BaseType_t xReturnStatus = TCP_SOCKETS_ERRNO_NONE;
+    BaseType_t xFullSize = ( xCork != pdFALSE ) ? pdTRUE : pdFALSE;
+
+    configASSERT( xSocket != NULL );
+
+    /* With full-size sending, the stack holds back a segment smaller than the
+     * MSS until the option is cleared again, which sends what is waiting in the
+     * Tx stream. */
+    if( FreeRTOS_setsockopt( xSocket,
+                             0,
+                             FREERTOS_SO_SET_FULL_SIZE,
+                             &xFullSize,
+                             sizeof( xFullSize ) ) != 0 )
+    {
+        LogError( ( "Failed to set FREERTOS_SO_SET_FULL_SIZE." ) );
+        xReturnStatus = TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+    }
+
+    return xReturnStatus;
+}
+
+/**
+ * @brief Let the next connection to the same server reuse this socket.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[in] xReuse Not used.
+ *
+ * @return TCP_SOCKETS_ERRNO_ENOPROTOOPT, as opening a socket of the stack
+ * costs no round trips to a modem, so sockets are not pooled.
+ */
+BaseType_t TCP_Sockets_SetReuse( Socket_t xSocket,
+                                 BaseType_t xReuse )
+{
+    ( void ) xSocket;
+    ( void ) xReuse;
+
+    return TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+}
+
+/**
+ * @brief Keep sockets to a server opened ahead.
+ *
+ * @param[in] pHostName Not used.
+ * @param[in] port Not used.
+ * @param[in] uxCount Not used.
+ *
+ * @return TCP_SOCKETS_ERRNO_ENOPROTOOPT, as sockets are not pooled.
+ */
+BaseType_t TCP_Sockets_Reserve( const char * pHostName,
+                                uint16_t port,
+                                UBaseType_t uxCount )
+{
+    ( void ) pHostName;
+    ( void ) port;
+    ( void ) uxCount;
+
+    return TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+}
+
+/**
+ * @brief Get the send statistics of a socket.
+ *
+ * @param[in] xSocket The socket descriptor.
+ * @param[out] pStats Not changed.
+ *
+ * @return TCP_SOCKETS_ERRNO_ENOPROTOOPT, as the stack sends from the Tx
+ * stream by itself and keeps no per-send figures.
+ */
+BaseType_t TCP_Sockets_GetSendStats( Socket_t xSocket,
+                                     TCPSocketsSendStats_t * pStats )
+{
+    ( void ) xSocket;
+    ( void ) pStats;
+
+    return TCP_SOCKETS_ERRNO_ENOPROTOOPT;
+}
+
 /**
  * @brief Receive data from a TCP socket.
  *
@@ -305,39 +1152,71 @@ int32_t TCP_Sockets_Recv( Socket_t xSocket,
                           size_t xBufferLength )
 {
     BaseType_t xRecvStatus;
-    int xReturnStatus = TCP_SOCKETS_ERRNO_ERROR;
 
     configASSERT( xSocket != NULL );
     configASSERT( pvBuffer != NULL );
 
     xRecvStatus = FreeRTOS_recv( xSocket, pvBuffer, xBufferLength, 0 );
 
-    switch( xRecvStatus )
-    {
-        /* Socket was closed or just got closed. */
-        case -pdFREERTOS_ERRNO_ENOTCONN:
-            xReturnStatus = TCP_SOCKETS_ERRNO_ENOTCONN;
-            break;
+    return prvConvertRecvStatus( xRecvStatus );
+}
 
-        /* Not enough memory for the socket to create either an Rx or Tx stream. */
-        case -pdFREERTOS_ERRNO_ENOMEM:
-            xReturnStatus = TCP_SOCKETS_ERRNO_ENOMEM;
-            break;
+/**
+ * @brief Receive data from a TCP socket without copying it.
+ *
+ * @param[in] xSocket The handle of the socket from which data is being received.
+ * @param[out] ppvData Set to point at the received data in the Rx stream.
+ * @param[in] xMaxLength The maximum number of bytes to return.
+ *
+ * @return The number of bytes at @p ppvData, 0 on timeout, or a negative
+ * value on error.
+ */
+int32_t TCP_Sockets_RecvZeroCopy( Socket_t xSocket,
+                                  const void ** ppvData,
+                                  size_t xMaxLength )
+{
+    BaseType_t xRecvStatus;
+    uint8_t * pucData = NULL;
 
-        /* Socket is not valid, is not a TCP socket, or is not bound. */
-        case -pdFREERTOS_ERRNO_EINVAL:
-            xReturnStatus = TCP_SOCKETS_ERRNO_EINVAL;
-            break;
+    configASSERT( xSocket != NULL );
+    configASSERT( ppvData != NULL );
 
-        /* Socket received a signal, causing the read operation to be aborted. */
-        case -pdFREERTOS_ERRNO_EINTR:
-            xReturnStatus = TCP_SOCKETS_ERRNO_EINTR;
-            break;
+    /* With FREERTOS_ZERO_COPY, FreeRTOS_recv() returns a pointer into the Rx
+     * stream and the number of contiguous bytes there, without consuming
+     * them. */
+    xRecvStatus = FreeRTOS_recv( xSocket, &pucData, xMaxLength, FREERTOS_ZERO_COPY );
 
-        default:
-            xReturnStatus = ( int ) xRecvStatus;
-            break;
+    if( xRecvStatus > 0 )
+    {
+        if( ( size_t ) xRecvStatus > xMaxLength )
+        {
+            xRecvStatus = ( BaseType_t ) xMaxLength;
+        }
+
+        *ppvData = pucData;
     }
 
-    return xReturnStatus;
+    return prvConvertRecvStatus( xRecvStatus );
+}
+
+/**
+ * @brief Release data returned by TCP_Sockets_RecvZeroCopy().
+ *
+ * @param[in] xSocket The handle of the socket from which data was received.
+ * @param[in] xLength The number of bytes to release.
+ *
+ * @return The number of bytes released, or a negative value on error.
+ */
+int32_t TCP_Sockets_RecvRelease( Socket_t xSocket,
+                                 size_t xLength )
+{
+    BaseType_t xRecvStatus;
+
+    configASSERT( xSocket != NULL );
+
+    /* A receive into a NULL buffer consumes the bytes without copying them,
+     * and lets the stack advertise the freed space to the peer. */
+    xRecvStatus = FreeRTOS_recv( xSocket, NULL, xLength, FREERTOS_MSG_DONTWAIT );
+
+    return prvConvertRecvStatus( xRecvStatus );
 }
@@ -48,6 +48,12 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 
+/* The session cache reads the session ID of an mbedtls_ssl_session, which is a
+ * private field as of mbed TLS 3.0. */
+#ifndef MBEDTLS_ALLOW_PRIVATE_ACCESS
+    #define MBEDTLS_ALLOW_PRIVATE_ACCESS
+#endif /* MBEDTLS_ALLOW_PRIVATE_ACCESS */
+
 /* MBedTLS Includes */
 #if !defined( MBEDTLS_CONFIG_FILE )
     #include "mbedtls/mbedtls_config.h"
@@ -71,6 +77,25 @@
 /* TLS transport header. */
 #include "transport_mbedtls.h"
 
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+    /* Semaphore include, for the mutex protecting the session cache. */
+    #include "semphr.h"
+    #include "transport_mutex.h"
+#endif
+
+#if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+    #if !defined( MBEDTLS_PLATFORM_MEMORY ) || defined( MBEDTLS_PLATFORM_CALLOC_MACRO ) || defined( MBEDTLS_PLATFORM_FREE_MACRO )
+        #error "TLS_TRANSPORT_ARENA_SIZE requires MBEDTLS_PLATFORM_MEMORY, without MBEDTLS_PLATFORM_CALLOC_MACRO and MBEDTLS_PLATFORM_FREE_MACRO."
+    #endif
+
+    #if ( configNUM_THREAD_LOCAL_STORAGE_POINTERS <= TLS_TRANSPORT_ARENA_TLS_INDEX )
+        #error "TLS_TRANSPORT_ARENA_SIZE requires configNUM_THREAD_LOCAL_STORAGE_POINTERS to be greater than TLS_TRANSPORT_ARENA_TLS_INDEX."
+    #endif
+
+    /* MBedTLS platform include, for mbedtls_platform_set_calloc_free(). */
+    #include "mbedtls/platform.h"
+#endif /* if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -118,6 +143,71 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
 
 /*-----------------------------------------------------------*/
 
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+
+/**
+ * @brief A TLS session kept for resumption with a server.
+ */
+    typedef struct TlsSessionCacheEntry
+    {
+        BaseType_t isValid;                                        /**< @brief Whether the entry holds a session. */
+        char hostName[ TLS_TRANSPORT_SESSION_CACHE_HOST_LENGTH + 1 ]; /**< @brief Host name of the server. */
+        uint16_t port;                                             /**< @brief Port of the server. */
+        uint32_t lastUsed;                                         /**< @brief Value of #sessionCacheClock when the entry was last stored or offered. */
+        mbedtls_ssl_session session;                               /**< @brief The session negotiated with the server. */
+    } TlsSessionCacheEntry_t;
+
+/**
+ * @brief The cached sessions.
+ */
+    static TlsSessionCacheEntry_t sessionCache[ TLS_TRANSPORT_SESSION_CACHE_ENTRIES ];
+
+/**
+ * @brief Handshake counts reported by #TLS_FreeRTOS_GetSessionCacheStats.
+ */
+    static TlsSessionCacheStats_t sessionCacheStats;
+
+/**
+ * @brief Incremented each time an entry is used, to find the least recently
+ * used entry.
+ */
+    static uint32_t sessionCacheClock = 0U;
+
+/**
+ * @brief Mutex protecting the session cache, created on first use.
+ */
+    static SemaphoreHandle_t sessionCacheMutex = NULL;
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 ) */
+
+#if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+
+/**
+ * @brief Header of a block of an arena.
+ */
+    typedef struct TlsArenaBlock
+    {
+        struct TlsArenaBlock * pNext; /**< @brief Next free block, in address order; only used while the block is free. */
+        size_t size;                  /**< @brief Size of the block, including this header. */
+    } TlsArenaBlock_t;
+
+/**
+ * @brief Round a size up to the alignment of the port.
+ */
+    #define tlsArenaALIGN( size )    ( ( ( size ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/**
+ * @brief Size of a block header, keeping the memory after it aligned.
+ */
+    #define tlsArenaHEADER_SIZE      tlsArenaALIGN( sizeof( TlsArenaBlock_t ) )
+
+/**
+ * @brief Smallest block worth splitting off a free block.
+ */
+    #define tlsArenaMIN_BLOCK_SIZE    ( tlsArenaHEADER_SIZE * 2U )
+#endif /* if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) */
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Initialize the mbed TLS structures in a network connection.
  *
@@ -193,16 +283,68 @@ static int32_t setCredentials( SSLContext_t * pSslContext,
 /**
  * @brief Set optional configurations for the TLS connection.
  *
- * This function is used to set SNI and ALPN protocols.
+ * This function is used to set ALPN protocols and the maximum fragment length.
  *
  * @param[in] pSslContext SSL context to which the optional configurations are to be set.
- * @param[in] pHostName Remote host name, used for server name indication.
  * @param[in] pNetworkCredentials TLS setup parameters.
  */
 static void setOptionalConfigurations( SSLContext_t * pSslContext,
-                                       const char * pHostName,
                                        const NetworkCredentials_t * pNetworkCredentials );
 
+#ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+
+/**
+ * @brief Convert a maximum fragment length in bytes to its mbed TLS code.
+ *
+ * @param[in] maxFragmentLength 512, 1024, 2048 or 4096.
+ *
+ * @return The MBEDTLS_SSL_MAX_FRAG_LEN_ code, or MBEDTLS_SSL_MAX_FRAG_LEN_NONE
+ * for any other length.
+ */
+    static unsigned char maxFragmentLengthCode( uint32_t maxFragmentLength );
+#endif
+
+/**
+ * @brief Set the server name for server name indication, if enabled.
+ *
+ * @param[in] pSslContext SSL context whose server name is to be set.
+ * @param[in] pHostName Remote host name, used for server name indication.
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ */
+static void setServerName( SSLContext_t * pSslContext,
+                           const char * pHostName,
+                           const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Set up the SSL configuration and the credentials of an SSL context
+ * initialized by #sslContextInit.
+ *
+ * @param[in] pSslContext SSL context whose configuration is to be set up.
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INSUFFICIENT_MEMORY, or
+ * #TLS_TRANSPORT_INVALID_CREDENTIALS.
+ */
+static TlsTransportStatus_t sslConfigSetup( SSLContext_t * pSslContext,
+                                            const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Tell whether a connection is to be set up with a shared configuration.
+ *
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ *
+ * @return pdTRUE if #NetworkCredentials_t.pSharedConfig is set; otherwise pdFALSE.
+ */
+static BaseType_t usesSharedConfig( const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Free the mbed TLS structures of a connection, and release its shared
+ * configuration, if any.
+ *
+ * @param[in] pTlsTransportParams Parameters of the connection.
+ */
+static void tlsContextFree( TlsTransportParams_t * pTlsTransportParams );
+
 /**
  * @brief Setup TLS by initializing contexts and setting configurations.
  *
@@ -217,16 +359,113 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
                                       const char * pHostName,
                                       const NetworkCredentials_t * pNetworkCredentials );
 
+/**
+ * @brief Prepare the TLS handshake on a TCP connection.
+ *
+ * The server is the one recorded in the network context parameters.
+ *
+ * @param[in] pNetworkContext Network context.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS or #TLS_TRANSPORT_INTERNAL_ERROR.
+ */
+static TlsTransportStatus_t tlsHandshakeStart( NetworkContext_t * pNetworkContext );
+
+/**
+ * @brief Advance the TLS handshake prepared by #tlsHandshakeStart.
+ *
+ * @param[in] pNetworkContext Network context.
+ * @param[in] isNonBlocking pdTRUE if the socket timeouts are zero, so that a
+ * send timeout only means the socket is busy.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_IN_PROGRESS, or
+ * #TLS_TRANSPORT_HANDSHAKE_FAILED.
+ */
+static TlsTransportStatus_t tlsHandshakeStep( NetworkContext_t * pNetworkContext,
+                                              BaseType_t isNonBlocking );
+
 /**
  * @brief Perform the TLS handshake on a TCP connection.
  *
  * @param[in] pNetworkContext Network context.
- * @param[in] pNetworkCredentials TLS setup parameters.
  *
  * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_HANDSHAKE_FAILED, or #TLS_TRANSPORT_INTERNAL_ERROR.
  */
-static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
-                                          const NetworkCredentials_t * pNetworkCredentials );
+static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext );
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+/**
+ * @brief Perform the TLS handshake one step at a time, adding the time of
+ * each step to the statistics of the connection.
+ *
+ * @param[in] pTlsTransportParams TLS transport parameters of the connection.
+ *
+ * @return The return value of mbedtls_ssl_handshake.
+ */
+    static int32_t statsHandshake( TlsTransportParams_t * pTlsTransportParams );
+
+/**
+ * @brief Record the largest record payloads negotiated by the handshake in
+ * the statistics of the connection.
+ *
+ * @param[in] pTlsTransportParams TLS transport parameters of the connection.
+ */
+    static void statsRecordSizes( TlsTransportParams_t * pTlsTransportParams );
+#endif
+
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+
+/**
+ * @brief Find the cache entry of a server.
+ *
+ * The session cache mutex must be held.
+ *
+ * @param[in] pHostName Host name of the server.
+ * @param[in] port Port of the server.
+ *
+ * @return The entry, or NULL if no session is cached for the server.
+ */
+    static TlsSessionCacheEntry_t * sessionCacheFind( const char * pHostName,
+                                                      uint16_t port );
+
+/**
+ * @brief Offer the cached session of a server, if there is one, in the
+ * handshake about to be performed.
+ *
+ * @param[in] pSslContext SSL context which has been set up.
+ * @param[in] pHostName Host name of the server.
+ * @param[in] port Port of the server.
+ * @param[out] pOffer Populated with the offered session ID.
+ */
+    static void sessionCacheOffer( SSLContext_t * pSslContext,
+                                   const char * pHostName,
+                                   uint16_t port,
+                                   TlsSessionOffer_t * pOffer );
+
+/**
+ * @brief Count a successful handshake, and keep its session for the next
+ * connection to the server.
+ *
+ * @param[in] pSslContext SSL context which has completed a handshake.
+ * @param[in] pHostName Host name of the server.
+ * @param[in] port Port of the server.
+ * @param[in] pOffer The session ID offered by #sessionCacheOffer.
+ */
+    static void sessionCacheStore( SSLContext_t * pSslContext,
+                                   const char * pHostName,
+                                   uint16_t port,
+                                   const TlsSessionOffer_t * pOffer );
+
+/**
+ * @brief Forget the cached session of a server, after a handshake offering it
+ * failed.
+ *
+ * @param[in] pHostName Host name of the server.
+ * @param[in] port Port of the server.
+ */
+    static void sessionCacheRemove( const char * pHostName,
+                                    uint16_t port );
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 ) */
 
 /**
  * @brief Initialize mbedTLS.
@@ -239,6 +478,78 @@ static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
 static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyContext,
                                          mbedtls_ctr_drbg_context * pCtrDrbgContext );
 
+/**
+ * @brief Send a buffer with as few TLS records as its length allows.
+ *
+ * @param[in] pTlsTransportParams TLS transport parameters of the connection.
+ * @param[in] pBuffer Buffer containing the bytes to send.
+ * @param[in] bytesToSend Number of bytes to send from the buffer.
+ *
+ * @return Number of bytes sent, which is fewer than @p bytesToSend if the
+ * socket timed out; else, if no bytes were sent, a negative mbed TLS error.
+ */
+static int32_t tlsSendAll( TlsTransportParams_t * pTlsTransportParams,
+                           const uint8_t * pBuffer,
+                           size_t bytesToSend );
+
+#if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+
+/**
+ * @brief Make an arena one free block, for a new connection.
+ *
+ * @param[in] pArena The arena.
+ */
+    static void arenaInit( TlsTransportArena_t * pArena );
+
+/**
+ * @brief Make mbed TLS allocations by the calling task come from an arena.
+ *
+ * @param[in] pArena The arena, or NULL to allocate from the heap.
+ *
+ * @return The arena used before, to be passed back when done.
+ */
+    static TlsTransportArena_t * arenaSelect( TlsTransportArena_t * pArena );
+
+/**
+ * @brief Allocate a block from an arena.
+ *
+ * @param[in] pArena The arena.
+ * @param[in] size Number of bytes needed.
+ *
+ * @return The memory, or NULL if no free block is large enough.
+ */
+    static void * arenaAlloc( TlsTransportArena_t * pArena,
+                              size_t size );
+
+/**
+ * @brief Return a block to an arena, merging it with free neighbours.
+ *
+ * @param[in] pArena The arena.
+ * @param[in] pMemory Memory returned by #arenaAlloc.
+ */
+    static void arenaFree( TlsTransportArena_t * pArena,
+                           void * pMemory );
+
+/**
+ * @brief The calloc() of mbed TLS: allocate from the arena of the calling
+ * task, or from the heap.
+ *
+ * @param[in] nmemb Number of members to allocate.
+ * @param[in] size Size of each member.
+ *
+ * @return The zeroed memory, or NULL.
+ */
+    static void * arenaCalloc( size_t nmemb,
+                               size_t size );
+
+/**
+ * @brief The free() of mbed TLS.
+ *
+ * @param[in] pMemory Memory returned by #arenaCalloc, or NULL.
+ */
+    static void arenaCallocFree( void * pMemory );
+#endif /* if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) */
+
 /*-----------------------------------------------------------*/
 
 #ifdef MBEDTLS_DEBUG_C
@@ -433,13 +744,11 @@ static int32_t setCredentials( SSLContext_t * pSslContext,
 /*-----------------------------------------------------------*/
 
 static void setOptionalConfigurations( SSLContext_t * pSslContext,
-                                       const char * pHostName,
                                        const NetworkCredentials_t * pNetworkCredentials )
 {
     int32_t mbedtlsError = -1;
 
     configASSERT( pSslContext != NULL );
-    configASSERT( pHostName != NULL );
     configASSERT( pNetworkCredentials != NULL );
 
     if( pNetworkCredentials->pAlpnProtos != NULL )
@@ -457,59 +766,108 @@ static void setOptionalConfigurations( SSLContext_t * pSslContext,
         }
     }
 
-    /* Enable SNI if requested. */
-    if( pNetworkCredentials->disableSni == pdFALSE )
+    /* Set Maximum Fragment Length if enabled. */
+    #ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
     {
-        mbedtlsError = mbedtls_ssl_set_hostname( &( pSslContext->context ),
-                                                 pHostName );
+        uint32_t maxFragmentLength = ( uint32_t ) TLS_TRANSPORT_MAX_FRAGMENT_LENGTH;
+        unsigned char maxFragmentCode;
 
-        if( mbedtlsError != 0 )
+        if( pNetworkCredentials->maxFragmentLength != 0U )
         {
-            LogError( ( "Failed to set server name: mbedTLSError= %s : %s.",
-                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
-                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+            maxFragmentLength = pNetworkCredentials->maxFragmentLength;
         }
-    }
 
-    /* Set Maximum Fragment Length if enabled. */
-    #ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+        maxFragmentCode = maxFragmentLengthCode( maxFragmentLength );
 
         /* Enable the max fragment extension. 4096 bytes is currently the largest fragment size permitted.
-         * See RFC 8449 https://tools.ietf.org/html/rfc8449 for more information.
-         *
-         * Smaller values can be found in "mbedtls/include/ssl.h".
-         */
-        mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pSslContext->config ), MBEDTLS_SSL_MAX_FRAG_LEN_4096 );
+         * See RFC 6066 https://tools.ietf.org/html/rfc6066 for more information. */
+        if( maxFragmentCode != MBEDTLS_SSL_MAX_FRAG_LEN_NONE )
+        {
+            mbedtlsError = mbedtls_ssl_conf_max_frag_len( &( pSslContext->config ), maxFragmentCode );
+
+            if( mbedtlsError != 0 )
+            {
+                LogError( ( "Failed to maximum fragment length extension: mbedTLSError= %s : %s.",
+                            mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                            mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+            }
+        }
+    }
+    #endif /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+}
+/*-----------------------------------------------------------*/
+
+#ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+
+    static unsigned char maxFragmentLengthCode( uint32_t maxFragmentLength )
+    {
+        unsigned char maxFragmentCode = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+
+        switch( maxFragmentLength )
+        {
+            case 512U:
+                maxFragmentCode = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+                break;
+
+            case 1024U:
+                maxFragmentCode = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+                break;
+
+            case 2048U:
+                maxFragmentCode = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+                break;
+
+            case 4096U:
+                maxFragmentCode = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+                break;
+
+            default:
+                /* Leave the extension out. */
+                break;
+        }
+
+        return maxFragmentCode;
+    }
+/*-----------------------------------------------------------*/
+#endif /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+
+static void setServerName( SSLContext_t * pSslContext,
+                           const char * pHostName,
+                           const NetworkCredentials_t * pNetworkCredentials )
+{
+    int32_t mbedtlsError = -1;
+
+    configASSERT( pSslContext != NULL );
+    configASSERT( pHostName != NULL );
+    configASSERT( pNetworkCredentials != NULL );
+
+    /* Enable SNI if requested. */
+    if( pNetworkCredentials->disableSni == pdFALSE )
+    {
+        mbedtlsError = mbedtls_ssl_set_hostname( &( pSslContext->context ),
+                                                 pHostName );
 
         if( mbedtlsError != 0 )
         {
-            LogError( ( "Failed to maximum fragment length extension: mbedTLSError= %s : %s.",
+            LogError( ( "Failed to set server name: mbedTLSError= %s : %s.",
                         mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
                         mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
         }
-    #endif /* ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+    }
 }
 /*-----------------------------------------------------------*/
 
-static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
-                                      const char * pHostName,
-                                      const NetworkCredentials_t * pNetworkCredentials )
+static TlsTransportStatus_t sslConfigSetup( SSLContext_t * pSslContext,
+                                            const NetworkCredentials_t * pNetworkCredentials )
 {
-    TlsTransportParams_t * pTlsTransportParams = NULL;
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     int32_t mbedtlsError = 0;
 
-    configASSERT( pNetworkContext != NULL );
-    configASSERT( pNetworkContext->pParams != NULL );
-    configASSERT( pHostName != NULL );
+    configASSERT( pSslContext != NULL );
     configASSERT( pNetworkCredentials != NULL );
     configASSERT( pNetworkCredentials->pRootCa != NULL );
 
-    pTlsTransportParams = pNetworkContext->pParams;
-    /* Initialize the mbed TLS context structures. */
-    sslContextInit( &( pTlsTransportParams->sslContext ) );
-
-    mbedtlsError = mbedtls_ssl_config_defaults( &( pTlsTransportParams->sslContext.config ),
+    mbedtlsError = mbedtls_ssl_config_defaults( &( pSslContext->config ),
                                                 MBEDTLS_SSL_IS_CLIENT,
                                                 MBEDTLS_SSL_TRANSPORT_STREAM,
                                                 MBEDTLS_SSL_PRESET_DEFAULT );
@@ -526,7 +884,7 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        mbedtlsError = setCredentials( &( pTlsTransportParams->sslContext ),
+        mbedtlsError = setCredentials( pSslContext,
                                        pNetworkCredentials );
 
         if( mbedtlsError != 0 )
@@ -535,9 +893,8 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
         }
         else
         {
-            /* Optionally set SNI and ALPN protocols. */
-            setOptionalConfigurations( &( pTlsTransportParams->sslContext ),
-                                       pHostName,
+            /* Optionally set ALPN protocols. */
+            setOptionalConfigurations( pSslContext,
                                        pNetworkCredentials );
         }
     }
@@ -546,84 +903,583 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 }
 /*-----------------------------------------------------------*/
 
-static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext,
-                                          const NetworkCredentials_t * pNetworkCredentials )
+static BaseType_t usesSharedConfig( const NetworkCredentials_t * pNetworkCredentials )
+{
+    BaseType_t isShared = pdFALSE;
+
+    configASSERT( pNetworkCredentials != NULL );
+
+    #if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+        if( pNetworkCredentials->pSharedConfig != NULL )
+        {
+            isShared = pdTRUE;
+        }
+    #else
+        ( void ) pNetworkCredentials;
+    #endif
+
+    return isShared;
+}
+/*-----------------------------------------------------------*/
+
+static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
+                                      const char * pHostName,
+                                      const NetworkCredentials_t * pNetworkCredentials )
 {
     TlsTransportParams_t * pTlsTransportParams = NULL;
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
-    int32_t mbedtlsError = 0;
 
     configASSERT( pNetworkContext != NULL );
     configASSERT( pNetworkContext->pParams != NULL );
+    configASSERT( pHostName != NULL );
     configASSERT( pNetworkCredentials != NULL );
 
     pTlsTransportParams = pNetworkContext->pParams;
-    /* Initialize the mbed TLS secured connection context. */
-    mbedtlsError = mbedtls_ssl_setup( &( pTlsTransportParams->sslContext.context ),
-                                      &( pTlsTransportParams->sslContext.config ) );
 
-    if( mbedtlsError != 0 )
+    #if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+        pTlsTransportParams->pSharedConfig = NULL;
+    #endif
+
+    if( usesSharedConfig( pNetworkCredentials ) == pdTRUE )
     {
-        LogError( ( "Failed to set up mbed TLS SSL context: mbedTLSError= %s : %s.",
-                    mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
-                    mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+        #if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+            configASSERT( pNetworkCredentials->pSharedConfig->isInitialized == pdTRUE );
 
-        returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+            /* The configuration, the credentials and the RNG are set up
+             * already; only the SSL context belongs to the connection. */
+            mbedtls_ssl_init( &( pTlsTransportParams->sslContext.context ) );
+
+            taskENTER_CRITICAL();
+            {
+                pNetworkCredentials->pSharedConfig->connectionCount++;
+            }
+            taskEXIT_CRITICAL();
+
+            pTlsTransportParams->pSharedConfig = pNetworkCredentials->pSharedConfig;
+        #endif /* if ( TLS_TRANSPORT_SHARED_CONFIG > 0 ) */
     }
     else
     {
-        /* Set the underlying IO for the TLS connection. */
-
-        /* MISRA Rule 11.2 flags the following line for casting the second
-         * parameter to void *. This rule is suppressed because
-         * #mbedtls_ssl_set_bio requires the second parameter as void *.
-         */
-        /* coverity[misra_c_2012_rule_11_2_violation] */
+        /* Initialize the mbed TLS context structures. */
+        sslContextInit( &( pTlsTransportParams->sslContext ) );
 
-        /* These two macros MBEDTLS_SSL_SEND and MBEDTLS_SSL_RECV need to be
-         * defined in mbedtls_config.h according to which implementation you use.
-         */
-        mbedtls_ssl_set_bio( &( pTlsTransportParams->sslContext.context ),
-                             ( void * ) pTlsTransportParams->tcpSocket,
-                             xMbedTLSBioTCPSocketsWrapperSend,
-                             xMbedTLSBioTCPSocketsWrapperRecv,
-                             NULL );
+        returnStatus = sslConfigSetup( &( pTlsTransportParams->sslContext ),
+                                       pNetworkCredentials );
     }
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        /* Perform the TLS handshake. */
-        do
-        {
-            mbedtlsError = mbedtls_ssl_handshake( &( pTlsTransportParams->sslContext.context ) );
-        } while( ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
-                 ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) );
+        /* Optionally set SNI. */
+        setServerName( &( pTlsTransportParams->sslContext ),
+                       pHostName,
+                       pNetworkCredentials );
+    }
 
-        if( mbedtlsError != 0 )
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+static void tlsContextFree( TlsTransportParams_t * pTlsTransportParams )
+{
+    configASSERT( pTlsTransportParams != NULL );
+
+    #if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+        if( pTlsTransportParams->pSharedConfig != NULL )
         {
-            LogError( ( "Failed to perform TLS handshake: mbedTLSError= %s : %s.",
-                        mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
-                        mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+            mbedtls_ssl_free( &( pTlsTransportParams->sslContext.context ) );
 
-            returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
+            taskENTER_CRITICAL();
+            {
+                configASSERT( pTlsTransportParams->pSharedConfig->connectionCount > 0U );
+                pTlsTransportParams->pSharedConfig->connectionCount--;
+            }
+            taskEXIT_CRITICAL();
+
+            pTlsTransportParams->pSharedConfig = NULL;
         }
         else
         {
-            LogInfo( ( "(Network connection %p) TLS handshake successful.",
-                       pNetworkContext ) );
+            sslContextFree( &( pTlsTransportParams->sslContext ) );
         }
+    #else /* if ( TLS_TRANSPORT_SHARED_CONFIG > 0 ) */
+        sslContextFree( &( pTlsTransportParams->sslContext ) );
+    #endif /* if ( TLS_TRANSPORT_SHARED_CONFIG > 0 ) */
+}
+/*-----------------------------------------------------------*/
+
+static TlsTransportStatus_t tlsHandshakeStart( NetworkContext_t * pNetworkContext )
+{
+    TlsTransportParams_t * pTlsTransportParams = NULL;
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    int32_t mbedtlsError = 0;
+    const mbedtls_ssl_config * pConfig = NULL;
+
+    configASSERT( pNetworkContext != NULL );
+    configASSERT( pNetworkContext->pParams != NULL );
+
+    pTlsTransportParams = pNetworkContext->pParams;
+    configASSERT( pTlsTransportParams->pHostName != NULL );
+
+    pConfig = &( pTlsTransportParams->sslContext.config );
+
+    #if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+        if( pTlsTransportParams->pSharedConfig != NULL )
+        {
+            pConfig = &( pTlsTransportParams->pSharedConfig->sslContext.config );
+        }
+    #endif
+
+    /* Initialize the mbed TLS secured connection context. */
+    mbedtlsError = mbedtls_ssl_setup( &( pTlsTransportParams->sslContext.context ),
+                                      pConfig );
+
+    if( mbedtlsError != 0 )
+    {
+        LogError( ( "Failed to set up mbed TLS SSL context: mbedTLSError= %s : %s.",
+                    mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                    mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+
+        returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+    }
+    else
+    {
+        /* Set the underlying IO for the TLS connection. */
+
+        /* MISRA Rule 11.2 flags the following line for casting the second
+         * parameter to void *. This rule is suppressed because
+         * #mbedtls_ssl_set_bio requires the second parameter as void *.
+         */
+        /* coverity[misra_c_2012_rule_11_2_violation] */
+
+        /* These two macros MBEDTLS_SSL_SEND and MBEDTLS_SSL_RECV need to be
+         * defined in mbedtls_config.h according to which implementation you use.
+         */
+        #if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+            /* mbed TLS reads through the receive buffer of the connection. */
+            vMbedTLSBioInit( &( pTlsTransportParams->bioContext ), pTlsTransportParams->tcpSocket );
+            mbedtls_ssl_set_bio( &( pTlsTransportParams->sslContext.context ),
+                                 ( void * ) &( pTlsTransportParams->bioContext ),
+                                 xMbedTLSBioTCPSocketsWrapperSend,
+                                 xMbedTLSBioTCPSocketsWrapperRecv,
+                                 NULL );
+        #else
+            mbedtls_ssl_set_bio( &( pTlsTransportParams->sslContext.context ),
+                                 ( void * ) pTlsTransportParams->tcpSocket,
+                                 xMbedTLSBioTCPSocketsWrapperSend,
+                                 xMbedTLSBioTCPSocketsWrapperRecv,
+                                 NULL );
+        #endif
+
+        #if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+            sessionCacheOffer( &( pTlsTransportParams->sslContext ),
+                               pTlsTransportParams->pHostName,
+                               pTlsTransportParams->port,
+                               &( pTlsTransportParams->sessionOffer ) );
+        #endif
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+static TlsTransportStatus_t tlsHandshakeStep( NetworkContext_t * pNetworkContext,
+                                              BaseType_t isNonBlocking )
+{
+    TlsTransportParams_t * pTlsTransportParams = NULL;
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    int32_t mbedtlsError = 0;
+
+    configASSERT( pNetworkContext != NULL );
+    configASSERT( pNetworkContext->pParams != NULL );
+
+    pTlsTransportParams = pNetworkContext->pParams;
+
+    #if ( TLS_TRANSPORT_STATS > 0 )
+        mbedtlsError = statsHandshake( pTlsTransportParams );
+    #else
+        mbedtlsError = mbedtls_ssl_handshake( &( pTlsTransportParams->sslContext.context ) );
+    #endif
+
+    if( ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
+        ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
+        ( ( isNonBlocking == pdTRUE ) && ( mbedtlsError == MBEDTLS_ERR_SSL_TIMEOUT ) ) )
+    {
+        returnStatus = TLS_TRANSPORT_IN_PROGRESS;
+    }
+    else if( mbedtlsError != 0 )
+    {
+        LogError( ( "Failed to perform TLS handshake: mbedTLSError= %s : %s.",
+                    mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                    mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+
+        returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
+
+        #if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+            /* Do not offer the session again if it may be the cause. */
+            if( pTlsTransportParams->sessionOffer.idLength > 0U )
+            {
+                sessionCacheRemove( pTlsTransportParams->pHostName,
+                                    pTlsTransportParams->port );
+            }
+        #endif
+    }
+    else
+    {
+        LogInfo( ( "(Network connection %p) TLS handshake successful.",
+                   pNetworkContext ) );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            statsRecordSizes( pTlsTransportParams );
+        #endif
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            pTlsTransportParams->arena.handshakePeakBytes = pTlsTransportParams->arena.peakBytesInUse;
+            LogInfo( ( "(Network connection %p) TLS setup and handshake used at most %u of %u arena bytes.",
+                       pNetworkContext,
+                       ( unsigned int ) pTlsTransportParams->arena.handshakePeakBytes,
+                       ( unsigned int ) TLS_TRANSPORT_ARENA_SIZE ) );
+        #endif
+
+        #if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+            sessionCacheStore( &( pTlsTransportParams->sslContext ),
+                               pTlsTransportParams->pHostName,
+                               pTlsTransportParams->port,
+                               &( pTlsTransportParams->sessionOffer ) );
+        #endif
     }
 
     return returnStatus;
 }
 /*-----------------------------------------------------------*/
 
+static TlsTransportStatus_t tlsHandshake( NetworkContext_t * pNetworkContext )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+    returnStatus = tlsHandshakeStart( pNetworkContext );
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        /* Perform the TLS handshake. */
+        do
+        {
+            returnStatus = tlsHandshakeStep( pNetworkContext, pdFALSE );
+        } while( returnStatus == TLS_TRANSPORT_IN_PROGRESS );
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+    static int32_t statsHandshake( TlsTransportParams_t * pTlsTransportParams )
+    {
+        mbedtls_ssl_context * pSslContext = &( pTlsTransportParams->sslContext.context );
+        TlsTransportStats_t * pStats = &( pTlsTransportParams->stats );
+        int32_t mbedtlsError = 0;
+        int state = 0;
+        uint32_t stepMs = 0U;
+
+        while( ( mbedtlsError == 0 ) && ( mbedtls_ssl_is_handshake_over( pSslContext ) == 0 ) )
+        {
+            state = pSslContext->MBEDTLS_PRIVATE( state );
+            pStats->phaseStartMs = TLS_TRANSPORT_STATS_TIME_MS();
+
+            mbedtlsError = mbedtls_ssl_handshake_step( pSslContext );
+
+            stepMs = TLS_TRANSPORT_STATS_TIME_MS() - pStats->phaseStartMs;
+            pStats->handshakeMs += stepMs;
+
+            switch( state )
+            {
+                case MBEDTLS_SSL_SERVER_CERTIFICATE:
+                    pStats->serverCertificateMs += stepMs;
+                    break;
+
+                case MBEDTLS_SSL_SERVER_KEY_EXCHANGE:
+                case MBEDTLS_SSL_CLIENT_KEY_EXCHANGE:
+                    pStats->keyExchangeMs += stepMs;
+                    break;
+
+                case MBEDTLS_SSL_CERTIFICATE_VERIFY:
+
+                    /* In TLS 1.3, this step checks the server's signature. */
+                    if( mbedtls_ssl_get_version_number( pSslContext ) == MBEDTLS_SSL_VERSION_TLS1_3 )
+                    {
+                        pStats->serverCertificateMs += stepMs;
+                    }
+                    else
+                    {
+                        pStats->certificateVerifyMs += stepMs;
+                    }
+
+                    break;
+
+                case MBEDTLS_SSL_CLIENT_CERTIFICATE_VERIFY:
+                    pStats->certificateVerifyMs += stepMs;
+                    break;
+
+                default:
+                    /* The other steps only count towards the total. */
+                    break;
+            }
+        }
+
+        return mbedtlsError;
+    }
+/*-----------------------------------------------------------*/
+
+    static void statsRecordSizes( TlsTransportParams_t * pTlsTransportParams )
+    {
+        const mbedtls_ssl_context * pSslContext = &( pTlsTransportParams->sslContext.context );
+        int maxPayload = 0;
+
+        /* These are MBEDTLS_SSL_IN_CONTENT_LEN and MBEDTLS_SSL_OUT_CONTENT_LEN
+         * unless the server accepted a maximum fragment length. */
+        maxPayload = mbedtls_ssl_get_max_in_record_payload( pSslContext );
+        pTlsTransportParams->stats.maxRecordReceived = ( maxPayload > 0 ) ? ( uint32_t ) maxPayload : 0U;
+
+        maxPayload = mbedtls_ssl_get_max_out_record_payload( pSslContext );
+        pTlsTransportParams->stats.maxRecordSent = ( maxPayload > 0 ) ? ( uint32_t ) maxPayload : 0U;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_STATS > 0 ) */
+
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+
+    static TlsSessionCacheEntry_t * sessionCacheFind( const char * pHostName,
+                                                      uint16_t port )
+    {
+        TlsSessionCacheEntry_t * pEntry = NULL;
+        size_t i;
+
+        for( i = 0U; i < ( size_t ) TLS_TRANSPORT_SESSION_CACHE_ENTRIES; i++ )
+        {
+            if( ( sessionCache[ i ].isValid == pdTRUE ) &&
+                ( sessionCache[ i ].port == port ) &&
+                ( strcmp( sessionCache[ i ].hostName, pHostName ) == 0 ) )
+            {
+                pEntry = &( sessionCache[ i ] );
+                break;
+            }
+        }
+
+        return pEntry;
+    }
+/*-----------------------------------------------------------*/
+
+    static void sessionCacheOffer( SSLContext_t * pSslContext,
+                                   const char * pHostName,
+                                   uint16_t port,
+                                   TlsSessionOffer_t * pOffer )
+    {
+        TlsSessionCacheEntry_t * pEntry = NULL;
+        int32_t mbedtlsError = 0;
+
+        configASSERT( pSslContext != NULL );
+        configASSERT( pOffer != NULL );
+
+        pOffer->idLength = 0U;
+
+        if( TLS_Mutex_Take( &sessionCacheMutex ) == pdTRUE )
+        {
+            pEntry = sessionCacheFind( pHostName, port );
+
+            if( pEntry != NULL )
+            {
+                /* A failure here only costs a full handshake. */
+                mbedtlsError = mbedtls_ssl_set_session( &( pSslContext->context ),
+                                                        &( pEntry->session ) );
+
+                if( mbedtlsError != 0 )
+                {
+                    LogWarn( ( "Failed to offer a cached TLS session to %s:%u: mbedTLSError= %s : %s.",
+                               pHostName,
+                               ( unsigned int ) port,
+                               mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                               mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+                }
+                else
+                {
+                    pOffer->idLength = pEntry->session.id_len;
+                    ( void ) memcpy( pOffer->id, pEntry->session.id, pOffer->idLength );
+                    pEntry->lastUsed = ++sessionCacheClock;
+                }
+            }
+
+            ( void ) xSemaphoreGive( sessionCacheMutex );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void sessionCacheStore( SSLContext_t * pSslContext,
+                                   const char * pHostName,
+                                   uint16_t port,
+                                   const TlsSessionOffer_t * pOffer )
+    {
+        TlsSessionCacheEntry_t * pEntry = NULL;
+        mbedtls_ssl_session session;
+        BaseType_t haveSession = pdFALSE;
+        BaseType_t resumed = pdFALSE;
+        int32_t mbedtlsError = 0;
+        size_t i;
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            TlsTransportArena_t * pArena = NULL;
+        #endif
+
+        configASSERT( pSslContext != NULL );
+        configASSERT( pOffer != NULL );
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            /* Cached sessions outlive the connection, so they must come from
+             * the heap. */
+            pArena = arenaSelect( NULL );
+        #endif
+
+        /* Only TLS 1.2 sessions are cached: a TLS 1.3 session is resumed with a
+         * ticket which arrives after the handshake, and which cannot be offered
+         * again once it has been used. */
+        if( strcmp( mbedtls_ssl_get_version( &( pSslContext->context ) ), "TLSv1.2" ) == 0 )
+        {
+            mbedtls_ssl_session_init( &session );
+            mbedtlsError = mbedtls_ssl_get_session( &( pSslContext->context ), &session );
+
+            if( mbedtlsError != 0 )
+            {
+                LogWarn( ( "Failed to save the TLS session with %s:%u: mbedTLSError= %s : %s.",
+                           pHostName,
+                           ( unsigned int ) port,
+                           mbedtlsHighLevelCodeOrDefault( mbedtlsError ),
+                           mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
+                mbedtls_ssl_session_free( &session );
+            }
+            else
+            {
+                haveSession = pdTRUE;
+
+                /* A server resuming a session echoes its ID; a server declining
+                 * to resume it chooses a new one. */
+                if( ( pOffer->idLength > 0U ) &&
+                    ( session.id_len == pOffer->idLength ) &&
+                    ( memcmp( session.id, pOffer->id, pOffer->idLength ) == 0 ) )
+                {
+                    resumed = pdTRUE;
+                }
+            }
+        }
+
+        if( TLS_Mutex_Take( &sessionCacheMutex ) == pdTRUE )
+        {
+            if( resumed == pdTRUE )
+            {
+                sessionCacheStats.resumedHandshakes++;
+            }
+            else
+            {
+                sessionCacheStats.fullHandshakes++;
+            }
+
+            /* A host name too long for an entry is never cached, rather than
+             * being truncated into a name which might match another host. */
+            if( ( haveSession == pdTRUE ) &&
+                ( strlen( pHostName ) <= ( size_t ) TLS_TRANSPORT_SESSION_CACHE_HOST_LENGTH ) )
+            {
+                pEntry = sessionCacheFind( pHostName, port );
+
+                if( pEntry == NULL )
+                {
+                    /* Use a free entry, or else the least recently used one. */
+                    pEntry = &( sessionCache[ 0 ] );
+
+                    for( i = 0U; i < ( size_t ) TLS_TRANSPORT_SESSION_CACHE_ENTRIES; i++ )
+                    {
+                        if( sessionCache[ i ].isValid == pdFALSE )
+                        {
+                            pEntry = &( sessionCache[ i ] );
+                            break;
+                        }
+                        else if( sessionCache[ i ].lastUsed < pEntry->lastUsed )
+                        {
+                            pEntry = &( sessionCache[ i ] );
+                        }
+                        else
+                        {
+                            /* Empty else marker. */
+                        }
+                    }
+                }
+
+                if( pEntry->isValid == pdTRUE )
+                {
+                    mbedtls_ssl_session_free( &( pEntry->session ) );
+                }
+
+                /* The entry takes ownership of the memory held by the session. */
+                pEntry->session = session;
+                ( void ) strcpy( pEntry->hostName, pHostName );
+                pEntry->port = port;
+                pEntry->lastUsed = ++sessionCacheClock;
+                pEntry->isValid = pdTRUE;
+                haveSession = pdFALSE;
+            }
+
+            ( void ) xSemaphoreGive( sessionCacheMutex );
+        }
+
+        if( haveSession == pdTRUE )
+        {
+            mbedtls_ssl_session_free( &session );
+        }
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pArena );
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+    static void sessionCacheRemove( const char * pHostName,
+                                    uint16_t port )
+    {
+        TlsSessionCacheEntry_t * pEntry = NULL;
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            TlsTransportArena_t * pArena = arenaSelect( NULL );
+        #endif
+
+        if( TLS_Mutex_Take( &sessionCacheMutex ) == pdTRUE )
+        {
+            pEntry = sessionCacheFind( pHostName, port );
+
+            if( pEntry != NULL )
+            {
+                mbedtls_ssl_session_free( &( pEntry->session ) );
+                pEntry->isValid = pdFALSE;
+            }
+
+            ( void ) xSemaphoreGive( sessionCacheMutex );
+        }
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pArena );
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 ) */
+
 static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyContext,
                                          mbedtls_ctr_drbg_context * pCtrDrbgContext )
 {
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     int32_t mbedtlsError = 0;
 
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) && defined( MBEDTLS_PSA_CRYPTO_C )
+        TlsTransportArena_t * pArena = NULL;
+    #endif
+
     #if defined( MBEDTLS_THREADING_ALT )
         /* Set the mutex functions for mbed TLS thread safety. */
         mbedtls_platform_threading_init();
@@ -644,8 +1500,18 @@ static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyConte
     #ifdef MBEDTLS_PSA_CRYPTO_C
         if( returnStatus == TLS_TRANSPORT_SUCCESS )
         {
+            #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+                /* The PSA state outlives the connection, so it must come from
+                 * the heap. */
+                pArena = arenaSelect( NULL );
+            #endif
+
             mbedtlsError = psa_crypto_init();
 
+            #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+                ( void ) arenaSelect( pArena );
+            #endif
+
             if( mbedtlsError != PSA_SUCCESS )
             {
                 LogError( ( "Failed to initialize PSA Crypto implementation: %s", ( int ) mbedtlsError ) );
@@ -681,6 +1547,300 @@ static TlsTransportStatus_t initMbedtls( mbedtls_entropy_context * pEntropyConte
 }
 /*-----------------------------------------------------------*/
 
+static int32_t tlsSendAll( TlsTransportParams_t * pTlsTransportParams,
+                           const uint8_t * pBuffer,
+                           size_t bytesToSend )
+{
+    int32_t tlsStatus = 0;
+    size_t bytesSent = 0U;
+
+    /* mbedtls_ssl_write() sends at most one record, so call it until the whole
+     * buffer is sent. */
+    while( bytesSent < bytesToSend )
+    {
+        tlsStatus = ( int32_t ) mbedtls_ssl_write( &( pTlsTransportParams->sslContext.context ),
+                                                   &( pBuffer[ bytesSent ] ),
+                                                   bytesToSend - bytesSent );
+
+        if( tlsStatus <= 0 )
+        {
+            break;
+        }
+
+        bytesSent += ( size_t ) tlsStatus;
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            pTlsTransportParams->stats.bytesSent += ( uint32_t ) tlsStatus;
+            pTlsTransportParams->stats.recordsSent++;
+        #endif
+    }
+
+    if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
+        ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
+        ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
+        ( tlsStatus == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET ) )
+    {
+        LogDebug( ( "Failed to send data. However, send can be retried on this error. "
+                    "mbedTLSError= %s : %s.",
+                    mbedtlsHighLevelCodeOrDefault( tlsStatus ),
+                    mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+
+        /* Mark these set of errors as a timeout. The libraries may retry send
+         * on these errors. */
+        tlsStatus = ( int32_t ) bytesSent;
+    }
+    else if( ( tlsStatus < 0 ) && ( bytesSent == 0U ) )
+    {
+        LogError( ( "Failed to send data:  mbedTLSError= %s : %s.",
+                    mbedtlsHighLevelCodeOrDefault( tlsStatus ),
+                    mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+    }
+    else
+    {
+        /* Report the bytes sent; an error after some bytes were sent is
+         * reported by the next send. */
+        tlsStatus = ( int32_t ) bytesSent;
+    }
+
+    return tlsStatus;
+}
+/*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+
+    static void arenaInit( TlsTransportArena_t * pArena )
+    {
+        TlsArenaBlock_t * pBlock = NULL;
+        size_t offset = 0U;
+
+        configASSERT( pArena != NULL );
+
+        /* Align the first block, which spans the whole arena. */
+        offset = tlsArenaALIGN( ( size_t ) ( portPOINTER_SIZE_TYPE ) pArena->storage ) -
+                 ( size_t ) ( portPOINTER_SIZE_TYPE ) pArena->storage;
+
+        pArena->pFreeList = NULL;
+        pArena->bytesInUse = 0U;
+        pArena->peakBytesInUse = 0U;
+        pArena->handshakePeakBytes = 0U;
+        pArena->failedAllocations = 0U;
+
+        if( ( offset + tlsArenaMIN_BLOCK_SIZE ) <= sizeof( pArena->storage ) )
+        {
+            pBlock = ( TlsArenaBlock_t * ) &( pArena->storage[ offset ] );
+            pBlock->pNext = NULL;
+            pBlock->size = ( sizeof( pArena->storage ) - offset ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+            pArena->pFreeList = pBlock;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static TlsTransportArena_t * arenaSelect( TlsTransportArena_t * pArena )
+    {
+        TlsTransportArena_t * pPrevious = NULL;
+
+        pPrevious = ( TlsTransportArena_t * ) pvTaskGetThreadLocalStoragePointer( NULL, TLS_TRANSPORT_ARENA_TLS_INDEX );
+        vTaskSetThreadLocalStoragePointer( NULL, TLS_TRANSPORT_ARENA_TLS_INDEX, pArena );
+
+        return pPrevious;
+    }
+/*-----------------------------------------------------------*/
+
+    static void * arenaAlloc( TlsTransportArena_t * pArena,
+                              size_t size )
+    {
+        TlsArenaBlock_t * pPrevious = NULL;
+        TlsArenaBlock_t * pBlock = NULL;
+        TlsArenaBlock_t * pRemainder = NULL;
+        void * pMemory = NULL;
+        size_t blockSize = 0U;
+
+        /* Reject sizes which would overflow once the header is added. */
+        if( size <= ( ( size_t ) TLS_TRANSPORT_ARENA_SIZE - tlsArenaHEADER_SIZE ) )
+        {
+            blockSize = tlsArenaALIGN( size + tlsArenaHEADER_SIZE );
+            pBlock = ( TlsArenaBlock_t * ) pArena->pFreeList;
+
+            /* First fit. */
+            while( ( pBlock != NULL ) && ( pBlock->size < blockSize ) )
+            {
+                pPrevious = pBlock;
+                pBlock = pBlock->pNext;
+            }
+        }
+
+        if( pBlock != NULL )
+        {
+            if( ( pBlock->size - blockSize ) >= tlsArenaMIN_BLOCK_SIZE )
+            {
+                /* Leave the rest of the block free. */
+                pRemainder = ( TlsArenaBlock_t * ) &( ( ( uint8_t * ) pBlock )[ blockSize ] );
+                pRemainder->size = pBlock->size - blockSize;
+                pRemainder->pNext = pBlock->pNext;
+                pBlock->size = blockSize;
+            }
+            else
+            {
+                pRemainder = pBlock->pNext;
+            }
+
+            if( pPrevious == NULL )
+            {
+                pArena->pFreeList = pRemainder;
+            }
+            else
+            {
+                pPrevious->pNext = pRemainder;
+            }
+
+            pBlock->pNext = NULL;
+            pArena->bytesInUse += pBlock->size;
+
+            if( pArena->bytesInUse > pArena->peakBytesInUse )
+            {
+                pArena->peakBytesInUse = pArena->bytesInUse;
+            }
+
+            pMemory = &( ( ( uint8_t * ) pBlock )[ tlsArenaHEADER_SIZE ] );
+        }
+        else
+        {
+            pArena->failedAllocations++;
+        }
+
+        return pMemory;
+    }
+/*-----------------------------------------------------------*/
+
+    static void arenaFree( TlsTransportArena_t * pArena,
+                           void * pMemory )
+    {
+        TlsArenaBlock_t * pBlock = NULL;
+        TlsArenaBlock_t * pPrevious = NULL;
+        TlsArenaBlock_t * pNext = NULL;
+
+        pBlock = ( TlsArenaBlock_t * ) ( ( ( uint8_t * ) pMemory ) - tlsArenaHEADER_SIZE );
+
+        configASSERT( pArena->bytesInUse >= pBlock->size );
+        pArena->bytesInUse -= pBlock->size;
+
+        /* Find the free blocks on either side, keeping the list in address
+         * order so that neighbours can be merged. */
+        pNext = ( TlsArenaBlock_t * ) pArena->pFreeList;
+
+        while( ( pNext != NULL ) && ( pNext < pBlock ) )
+        {
+            pPrevious = pNext;
+            pNext = pNext->pNext;
+        }
+
+        if( ( pNext != NULL ) &&
+            ( &( ( ( uint8_t * ) pBlock )[ pBlock->size ] ) == ( uint8_t * ) pNext ) )
+        {
+            pBlock->size += pNext->size;
+            pBlock->pNext = pNext->pNext;
+        }
+        else
+        {
+            pBlock->pNext = pNext;
+        }
+
+        if( pPrevious == NULL )
+        {
+            pArena->pFreeList = pBlock;
+        }
+        else if( &( ( ( uint8_t * ) pPrevious )[ pPrevious->size ] ) == ( uint8_t * ) pBlock )
+        {
+            pPrevious->size += pBlock->size;
+            pPrevious->pNext = pBlock->pNext;
+        }
+        else
+        {
+            pPrevious->pNext = pBlock;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void * arenaCalloc( size_t nmemb,
+                               size_t size )
+    {
+        TlsTransportArena_t * pArena = NULL;
+        size_t totalSize = nmemb * size;
+        void * pMemory = NULL;
+
+        if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+        {
+            pArena = ( TlsTransportArena_t * ) pvTaskGetThreadLocalStoragePointer( NULL, TLS_TRANSPORT_ARENA_TLS_INDEX );
+        }
+
+        /* Check that neither nmemb nor size were 0, and for overflow. */
+        if( ( totalSize > 0U ) && ( ( totalSize / size ) == nmemb ) )
+        {
+            if( pArena != NULL )
+            {
+                /* The tasks sending and receiving on a connection may allocate
+                 * from its arena at once. */
+                vTaskSuspendAll();
+                {
+                    pMemory = arenaAlloc( pArena, totalSize );
+                }
+                ( void ) xTaskResumeAll();
+
+                if( pMemory == NULL )
+                {
+                    LogError( ( "TLS arena exhausted: %u bytes requested, %u of %u bytes in use.",
+                                ( unsigned int ) totalSize,
+                                ( unsigned int ) pArena->bytesInUse,
+                                ( unsigned int ) TLS_TRANSPORT_ARENA_SIZE ) );
+                }
+            }
+            else
+            {
+                pMemory = pvPortMalloc( totalSize );
+            }
+
+            if( pMemory != NULL )
+            {
+                ( void ) memset( pMemory, 0, totalSize );
+            }
+        }
+
+        return pMemory;
+    }
+/*-----------------------------------------------------------*/
+
+    static void arenaCallocFree( void * pMemory )
+    {
+        TlsTransportArena_t * pArena = NULL;
+
+        if( pMemory != NULL )
+        {
+            if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+            {
+                pArena = ( TlsTransportArena_t * ) pvTaskGetThreadLocalStoragePointer( NULL, TLS_TRANSPORT_ARENA_TLS_INDEX );
+            }
+
+            /* Memory outside the arena of the calling task came from the heap. */
+            if( ( pArena != NULL ) &&
+                ( ( uint8_t * ) pMemory > pArena->storage ) &&
+                ( ( uint8_t * ) pMemory < &( pArena->storage[ sizeof( pArena->storage ) ] ) ) )
+            {
+                vTaskSuspendAll();
+                {
+                    arenaFree( pArena, pMemory );
+                }
+                ( void ) xTaskResumeAll();
+            }
+            else
+            {
+                vPortFree( pMemory );
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) */
+
 TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                            const char * pHostName,
                                            uint16_t port,
@@ -691,7 +1851,168 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     TlsTransportParams_t * pTlsTransportParams = NULL;
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     BaseType_t socketStatus = 0;
-    BaseType_t isSocketConnected = pdFALSE, isTlsSetup = pdFALSE;
+    BaseType_t isSocketConnected = pdFALSE, isTlsSetup = pdFALSE;
+
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t * pPreviousArena = NULL;
+    #endif
+
+    if( ( pNetworkContext == NULL ) ||
+        ( pNetworkContext->pParams == NULL ) ||
+        ( pHostName == NULL ) ||
+        ( pNetworkCredentials == NULL ) )
+    {
+        LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. pNetworkContext=%p, "
+                    "pHostName=%p, pNetworkCredentials=%p.",
+                    pNetworkContext,
+                    pHostName,
+                    pNetworkCredentials ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( ( pNetworkCredentials->pRootCa == NULL ) &&
+             ( usesSharedConfig( pNetworkCredentials ) == pdFALSE ) )
+    {
+        LogError( ( "pRootCa cannot be NULL." ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
+    }
+
+    /* Establish a TCP connection with the server. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        pTlsTransportParams = pNetworkContext->pParams;
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            /* Allocate the contexts of this connection from its arena. */
+            ( void ) mbedtls_platform_set_calloc_free( arenaCalloc, arenaCallocFree );
+            arenaInit( &( pTlsTransportParams->arena ) );
+            pPreviousArena = arenaSelect( &( pTlsTransportParams->arena ) );
+        #endif
+
+        /* Initialize tcpSocket. */
+        pTlsTransportParams->tcpSocket = NULL;
+        pTlsTransportParams->connectState = TLS_CONNECT_STATE_IDLE;
+        pTlsTransportParams->pHostName = pHostName;
+        pTlsTransportParams->port = port;
+        pTlsTransportParams->receiveTimeoutMs = receiveTimeoutMs;
+        pTlsTransportParams->sendTimeoutMs = sendTimeoutMs;
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Reset( &( pTlsTransportParams->stats ) );
+        #endif
+
+        /* Connect to the server address when one is given, e.g. from a DNS
+         * cache of the application.  The host name is still used for SNI and
+         * the session cache. */
+        socketStatus = TCP_Sockets_Connect( &( pTlsTransportParams->tcpSocket ),
+                                            ( pNetworkCredentials->pServerAddress != NULL ) ?
+                                            pNetworkCredentials->pServerAddress : pHostName,
+                                            port,
+                                            receiveTimeoutMs,
+                                            sendTimeoutMs );
+
+        if( socketStatus != 0 )
+        {
+            LogError( ( "Failed to connect to %s with error %d.",
+                        pHostName,
+                        socketStatus ) );
+            returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+        }
+    }
+
+    /* Initialize mbedtls. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        isSocketConnected = pdTRUE;
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_EndPhase( &( pTlsTransportParams->stats ),
+                                &( pTlsTransportParams->stats.tcpConnectMs ) );
+        #endif
+
+        /* A shared configuration has its own RNG, seeded already. */
+        if( usesSharedConfig( pNetworkCredentials ) == pdFALSE )
+        {
+            returnStatus = initMbedtls( &( pTlsTransportParams->sslContext.entropyContext ),
+                                        &( pTlsTransportParams->sslContext.ctrDrbgContext ) );
+        }
+    }
+
+    /* Initialize TLS contexts and set credentials. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        returnStatus = tlsSetup( pNetworkContext, pHostName, pNetworkCredentials );
+    }
+
+    /* Perform TLS handshake. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        isTlsSetup = pdTRUE;
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_EndPhase( &( pTlsTransportParams->stats ),
+                                &( pTlsTransportParams->stats.setupMs ) );
+        #endif
+
+        returnStatus = tlsHandshake( pNetworkContext );
+    }
+
+    /* Clean up on failure. */
+    if( returnStatus != TLS_TRANSPORT_SUCCESS )
+    {
+        /* Free SSL context if it's setup. */
+        if( isTlsSetup == pdTRUE )
+        {
+            tlsContextFree( pTlsTransportParams );
+        }
+
+        /* Call Sockets_Disconnect if socket was connected. */
+        if( isSocketConnected == pdTRUE )
+        {
+            TCP_Sockets_Disconnect( pTlsTransportParams->tcpSocket );
+            pTlsTransportParams->tcpSocket = NULL;
+        }
+    }
+    else
+    {
+        LogInfo( ( "(Network connection %p) Connection to %s established.",
+                   pNetworkContext,
+                   pHostName ) );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Track( &( pTlsTransportParams->stats ) );
+        #endif
+    }
+
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        if( pTlsTransportParams != NULL )
+        {
+            ( void ) arenaSelect( pPreviousArena );
+        }
+    #endif
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_ConnectStart( NetworkContext_t * pNetworkContext,
+                                                const char * pHostName,
+                                                uint16_t port,
+                                                const NetworkCredentials_t * pNetworkCredentials,
+                                                uint32_t receiveTimeoutMs,
+                                                uint32_t sendTimeoutMs )
+{
+    TlsTransportParams_t * pTlsTransportParams = NULL;
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    BaseType_t socketStatus = 0;
+    BaseType_t isSocketConnected = pdFALSE;
+
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t * pPreviousArena = NULL;
+    #endif
 
     if( ( pNetworkContext == NULL ) ||
         ( pNetworkContext->pParams == NULL ) ||
@@ -705,7 +2026,8 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                     pNetworkCredentials ) );
         returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
     }
-    else if( ( pNetworkCredentials->pRootCa == NULL ) )
+    else if( ( pNetworkCredentials->pRootCa == NULL ) &&
+             ( usesSharedConfig( pNetworkCredentials ) == pdFALSE ) )
     {
         LogError( ( "pRootCa cannot be NULL." ) );
         returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
@@ -715,23 +2037,37 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         /* Empty else for MISRA 15.7 compliance. */
     }
 
-    /* Establish a TCP connection with the server. */
+    /* Begin a TCP connection with the server. */
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
         pTlsTransportParams = pNetworkContext->pParams;
 
-        /* Initialize tcpSocket. */
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            /* Allocate the contexts of this connection from its arena. */
+            ( void ) mbedtls_platform_set_calloc_free( arenaCalloc, arenaCallocFree );
+            arenaInit( &( pTlsTransportParams->arena ) );
+            pPreviousArena = arenaSelect( &( pTlsTransportParams->arena ) );
+        #endif
+
         pTlsTransportParams->tcpSocket = NULL;
+        pTlsTransportParams->connectState = TLS_CONNECT_STATE_IDLE;
+        pTlsTransportParams->pHostName = pHostName;
+        pTlsTransportParams->port = port;
+        pTlsTransportParams->receiveTimeoutMs = receiveTimeoutMs;
+        pTlsTransportParams->sendTimeoutMs = sendTimeoutMs;
 
-        socketStatus = TCP_Sockets_Connect( &( pTlsTransportParams->tcpSocket ),
-                                            pHostName,
-                                            port,
-                                            receiveTimeoutMs,
-                                            sendTimeoutMs );
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Reset( &( pTlsTransportParams->stats ) );
+        #endif
+
+        socketStatus = TCP_Sockets_ConnectStart( &( pTlsTransportParams->tcpSocket ),
+                                                 ( pNetworkCredentials->pServerAddress != NULL ) ?
+                                                 pNetworkCredentials->pServerAddress : pHostName,
+                                                 port );
 
         if( socketStatus != 0 )
         {
-            LogError( ( "Failed to connect to %s with error %d.",
+            LogError( ( "Failed to begin connecting to %s with error %d.",
                         pHostName,
                         socketStatus ) );
             returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
@@ -743,45 +2079,174 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     {
         isSocketConnected = pdTRUE;
 
-        returnStatus = initMbedtls( &( pTlsTransportParams->sslContext.entropyContext ),
-                                    &( pTlsTransportParams->sslContext.ctrDrbgContext ) );
+        /* A shared configuration has its own RNG, seeded already. */
+        if( usesSharedConfig( pNetworkCredentials ) == pdFALSE )
+        {
+            returnStatus = initMbedtls( &( pTlsTransportParams->sslContext.entropyContext ),
+                                        &( pTlsTransportParams->sslContext.ctrDrbgContext ) );
+        }
     }
 
-    /* Initialize TLS contexts and set credentials. */
+    /* Initialize TLS contexts and set credentials, while the TCP connection
+     * is being established. */
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            /* The TCP connection stays the current phase, so time the setup
+             * separately. */
+            uint32_t setupStartMs = TLS_TRANSPORT_STATS_TIME_MS();
+        #endif
+
         returnStatus = tlsSetup( pNetworkContext, pHostName, pNetworkCredentials );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            pTlsTransportParams->stats.setupMs = TLS_TRANSPORT_STATS_TIME_MS() - setupStartMs;
+        #endif
     }
 
-    /* Perform TLS handshake. */
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        isTlsSetup = pdTRUE;
+        pTlsTransportParams->connectState = TLS_CONNECT_STATE_TCP_CONNECTING;
+        returnStatus = TLS_TRANSPORT_IN_PROGRESS;
+    }
+    else if( isSocketConnected == pdTRUE )
+    {
+        /* tlsSetup frees the SSL context itself when it fails. */
+        TCP_Sockets_Disconnect( pTlsTransportParams->tcpSocket );
+        pTlsTransportParams->tcpSocket = NULL;
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
+    }
+
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        if( pTlsTransportParams != NULL )
+        {
+            ( void ) arenaSelect( pPreviousArena );
+        }
+    #endif
 
-        returnStatus = tlsHandshake( pNetworkContext, pNetworkCredentials );
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_ConnectPoll( NetworkContext_t * pNetworkContext )
+{
+    TlsTransportParams_t * pTlsTransportParams = NULL;
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    BaseType_t socketStatus = 0;
+
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t * pPreviousArena = NULL;
+    #endif
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. pNetworkContext=%p.",
+                    pNetworkContext ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( pNetworkContext->pParams->connectState == TLS_CONNECT_STATE_IDLE )
+    {
+        LogError( ( "(Network connection %p) No connection is in progress.",
+                    pNetworkContext ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
     }
 
-    /* Clean up on failure. */
-    if( returnStatus != TLS_TRANSPORT_SUCCESS )
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        /* Free SSL context if it's setup. */
-        if( isTlsSetup == pdTRUE )
+        pTlsTransportParams = pNetworkContext->pParams;
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            pPreviousArena = arenaSelect( &( pTlsTransportParams->arena ) );
+        #endif
+
+        if( pTlsTransportParams->connectState == TLS_CONNECT_STATE_TCP_CONNECTING )
         {
-            sslContextFree( &( pTlsTransportParams->sslContext ) );
+            socketStatus = TCP_Sockets_ConnectPoll( pTlsTransportParams->tcpSocket );
+
+            if( socketStatus == TCP_SOCKETS_ERRNO_EWOULDBLOCK )
+            {
+                returnStatus = TLS_TRANSPORT_IN_PROGRESS;
+            }
+            else if( socketStatus != TCP_SOCKETS_ERRNO_NONE )
+            {
+                LogError( ( "Failed to connect to %s with error %d.",
+                            pTlsTransportParams->pHostName,
+                            socketStatus ) );
+                returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+            }
+            else
+            {
+                #if ( TLS_TRANSPORT_STATS > 0 )
+                    TLS_Stats_EndPhase( &( pTlsTransportParams->stats ),
+                                        &( pTlsTransportParams->stats.tcpConnectMs ) );
+                #endif
+
+                returnStatus = tlsHandshakeStart( pNetworkContext );
+
+                if( returnStatus == TLS_TRANSPORT_SUCCESS )
+                {
+                    pTlsTransportParams->connectState = TLS_CONNECT_STATE_HANDSHAKING;
+                }
+            }
         }
 
-        /* Call Sockets_Disconnect if socket was connected. */
-        if( isSocketConnected == pdTRUE )
+        /* Send the first handshake message as soon as the TCP connection is
+         * up, rather than on the next poll. */
+        if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) &&
+            ( pTlsTransportParams->connectState == TLS_CONNECT_STATE_HANDSHAKING ) )
+        {
+            returnStatus = tlsHandshakeStep( pNetworkContext, pdTRUE );
+        }
+
+        if( returnStatus == TLS_TRANSPORT_SUCCESS )
+        {
+            socketStatus = TCP_Sockets_SetTimeouts( pTlsTransportParams->tcpSocket,
+                                                    pTlsTransportParams->receiveTimeoutMs,
+                                                    pTlsTransportParams->sendTimeoutMs );
+
+            if( socketStatus != TCP_SOCKETS_ERRNO_NONE )
+            {
+                LogError( ( "Failed to set the socket timeouts with error %d.",
+                            socketStatus ) );
+                returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+            }
+        }
+
+        if( returnStatus == TLS_TRANSPORT_IN_PROGRESS )
+        {
+            /* The connection is still being established. */
+        }
+        else if( returnStatus == TLS_TRANSPORT_SUCCESS )
+        {
+            pTlsTransportParams->connectState = TLS_CONNECT_STATE_IDLE;
+
+            LogInfo( ( "(Network connection %p) Connection to %s established.",
+                       pNetworkContext,
+                       pTlsTransportParams->pHostName ) );
+
+            #if ( TLS_TRANSPORT_STATS > 0 )
+                TLS_Stats_Track( &( pTlsTransportParams->stats ) );
+            #endif
+        }
+        else
         {
+            /* Clean up on failure. */
+            tlsContextFree( pTlsTransportParams );
             TCP_Sockets_Disconnect( pTlsTransportParams->tcpSocket );
             pTlsTransportParams->tcpSocket = NULL;
+            pTlsTransportParams->connectState = TLS_CONNECT_STATE_IDLE;
         }
-    }
-    else
-    {
-        LogInfo( ( "(Network connection %p) Connection to %s established.",
-                   pNetworkContext,
-                   pHostName ) );
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pPreviousArena );
+        #endif
     }
 
     return returnStatus;
@@ -793,43 +2258,77 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
     TlsTransportParams_t * pTlsTransportParams = NULL;
     BaseType_t tlsStatus = 0;
 
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t * pPreviousArena = NULL;
+    #endif
+
     if( ( pNetworkContext != NULL ) && ( pNetworkContext->pParams != NULL ) )
     {
         pTlsTransportParams = pNetworkContext->pParams;
-        /* Attempting to terminate TLS connection. */
-        tlsStatus = ( BaseType_t ) mbedtls_ssl_close_notify( &( pTlsTransportParams->sslContext.context ) );
 
-        /* Ignore the WANT_READ and WANT_WRITE return values. */
-        if( ( tlsStatus != ( BaseType_t ) MBEDTLS_ERR_SSL_WANT_READ ) &&
-            ( tlsStatus != ( BaseType_t ) MBEDTLS_ERR_SSL_WANT_WRITE ) )
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            pPreviousArena = arenaSelect( &( pTlsTransportParams->arena ) );
+        #endif
+        if( pTlsTransportParams->connectState != TLS_CONNECT_STATE_IDLE )
+        {
+            /* Abandon a connection begun by TLS_FreeRTOS_ConnectStart; there
+             * is no TLS session to close. */
+            LogInfo( ( "(Network connection %p) Connection in progress abandoned.",
+                       pNetworkContext ) );
+            pTlsTransportParams->connectState = TLS_CONNECT_STATE_IDLE;
+        }
+        else
         {
-            if( tlsStatus == 0 )
+            /* Attempting to terminate TLS connection. */
+            tlsStatus = ( BaseType_t ) mbedtls_ssl_close_notify( &( pTlsTransportParams->sslContext.context ) );
+
+            /* Ignore the WANT_READ and WANT_WRITE return values. */
+            if( ( tlsStatus != ( BaseType_t ) MBEDTLS_ERR_SSL_WANT_READ ) &&
+                ( tlsStatus != ( BaseType_t ) MBEDTLS_ERR_SSL_WANT_WRITE ) )
             {
-                LogInfo( ( "(Network connection %p) TLS close-notify sent.",
-                           pNetworkContext ) );
+                if( tlsStatus == 0 )
+                {
+                    LogInfo( ( "(Network connection %p) TLS close-notify sent.",
+                               pNetworkContext ) );
+                }
+                else
+                {
+                    LogError( ( "(Network connection %p) Failed to send TLS close-notify: mbedTLSError= %s : %s.",
+                                pNetworkContext,
+                                mbedtlsHighLevelCodeOrDefault( tlsStatus ),
+                                mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+                }
             }
             else
             {
-                LogError( ( "(Network connection %p) Failed to send TLS close-notify: mbedTLSError= %s : %s.",
-                            pNetworkContext,
-                            mbedtlsHighLevelCodeOrDefault( tlsStatus ),
-                            mbedtlsLowLevelCodeOrDefault( tlsStatus ) ) );
+                /* WANT_READ and WANT_WRITE can be ignored. Logging for debugging purposes. */
+                LogInfo( ( "(Network connection %p) TLS close-notify sent; "
+                           "received %s as the TLS status can be ignored for close-notify.",
+                           ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ? "WANT_READ" : "WANT_WRITE",
+                           pNetworkContext ) );
             }
         }
-        else
-        {
-            /* WANT_READ and WANT_WRITE can be ignored. Logging for debugging purposes. */
-            LogInfo( ( "(Network connection %p) TLS close-notify sent; "
-                       "received %s as the TLS status can be ignored for close-notify.",
-                       ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ? "WANT_READ" : "WANT_WRITE",
-                       pNetworkContext ) );
-        }
 
         /* Call socket shutdown function to close connection. */
         TCP_Sockets_Disconnect( pTlsTransportParams->tcpSocket );
 
         /* Free mbed TLS contexts. */
-        sslContextFree( &( pTlsTransportParams->sslContext ) );
+        tlsContextFree( pTlsTransportParams );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Untrack( &( pTlsTransportParams->stats ) );
+        #endif
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pPreviousArena );
+
+            if( pTlsTransportParams->arena.bytesInUse != 0U )
+            {
+                LogWarn( ( "(Network connection %p) %u arena bytes still in use after disconnecting.",
+                           pNetworkContext,
+                           ( unsigned int ) pTlsTransportParams->arena.bytesInUse ) );
+            }
+        #endif
     }
 }
 /*-----------------------------------------------------------*/
@@ -841,6 +2340,10 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
     TlsTransportParams_t * pTlsTransportParams = NULL;
     int32_t tlsStatus = 0;
 
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t * pPreviousArena = NULL;
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -860,10 +2363,31 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
     {
         pTlsTransportParams = pNetworkContext->pParams;
 
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            pPreviousArena = arenaSelect( &( pTlsTransportParams->arena ) );
+        #endif
+
         tlsStatus = ( int32_t ) mbedtls_ssl_read( &( pTlsTransportParams->sslContext.context ),
                                                   pBuffer,
                                                   bytesToRecv );
 
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pPreviousArena );
+        #endif
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            if( tlsStatus > 0 )
+            {
+                pTlsTransportParams->stats.bytesReceived += ( uint32_t ) tlsStatus;
+
+                /* A record is counted once it has been read in full. */
+                if( mbedtls_ssl_get_bytes_avail( &( pTlsTransportParams->sslContext.context ) ) == 0U )
+                {
+                    pTlsTransportParams->stats.recordsReceived++;
+                }
+            }
+        #endif
+
         if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
@@ -906,6 +2430,10 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     TlsTransportParams_t * pTlsTransportParams = NULL;
     int32_t tlsStatus = 0;
 
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t * pPreviousArena = NULL;
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -925,10 +2453,26 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     {
         pTlsTransportParams = pNetworkContext->pParams;
 
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            pPreviousArena = arenaSelect( &( pTlsTransportParams->arena ) );
+        #endif
+
         tlsStatus = ( int32_t ) mbedtls_ssl_write( &( pTlsTransportParams->sslContext.context ),
                                                    pBuffer,
                                                    bytesToSend );
 
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pPreviousArena );
+        #endif
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            if( tlsStatus > 0 )
+            {
+                pTlsTransportParams->stats.bytesSent += ( uint32_t ) tlsStatus;
+                pTlsTransportParams->stats.recordsSent++;
+            }
+        #endif
+
         if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
@@ -963,3 +2507,298 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount )
+{
+    TlsTransportParams_t * pTlsTransportParams = NULL;
+    int32_t tlsStatus = 0;
+    int32_t bytesSent = 0;
+    size_t bytesToSend = 0U;
+    size_t index = 0U;
+
+    #if ( TLS_TRANSPORT_WRITEV_BUFFER_SIZE > 0 )
+        uint8_t gatherBuffer[ TLS_TRANSPORT_WRITEV_BUFFER_SIZE ];
+        size_t gatherLength = 0U;
+    #endif
+
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t * pPreviousArena = NULL;
+    #endif
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
+        bytesSent = -1;
+    }
+    else if( pIoVec == NULL )
+    {
+        LogError( ( "invalid input, pIoVec == NULL" ) );
+        bytesSent = -1;
+    }
+    else if( ioVecCount == 0 )
+    {
+        LogError( ( "invalid input, ioVecCount == 0" ) );
+        bytesSent = -1;
+    }
+    else
+    {
+        pTlsTransportParams = pNetworkContext->pParams;
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            pPreviousArena = arenaSelect( &( pTlsTransportParams->arena ) );
+        #endif
+
+        while( index < ioVecCount )
+        {
+            #if ( TLS_TRANSPORT_WRITEV_BUFFER_SIZE > 0 )
+                /* Gather as many of the following vectors as fit in the buffer,
+                 * to send them as one record. */
+                gatherLength = 0U;
+
+                while( ( index < ioVecCount ) &&
+                       ( pIoVec[ index ].iov_len <= ( sizeof( gatherBuffer ) - gatherLength ) ) )
+                {
+                    ( void ) memcpy( &( gatherBuffer[ gatherLength ] ),
+                                     pIoVec[ index ].iov_base,
+                                     pIoVec[ index ].iov_len );
+                    gatherLength += pIoVec[ index ].iov_len;
+                    index++;
+                }
+
+                if( gatherLength > 0U )
+                {
+                    bytesToSend = gatherLength;
+                    tlsStatus = tlsSendAll( pTlsTransportParams, gatherBuffer, bytesToSend );
+                }
+                else
+            #endif /* if ( TLS_TRANSPORT_WRITEV_BUFFER_SIZE > 0 ) */
+            {
+                /* Send a vector too large for the buffer in place. */
+                bytesToSend = pIoVec[ index ].iov_len;
+                tlsStatus = tlsSendAll( pTlsTransportParams,
+                                        ( const uint8_t * ) pIoVec[ index ].iov_base,
+                                        bytesToSend );
+                index++;
+            }
+
+            if( tlsStatus < 0 )
+            {
+                /* Report the error only if no bytes were sent. */
+                if( bytesSent == 0 )
+                {
+                    bytesSent = tlsStatus;
+                }
+
+                break;
+            }
+
+            bytesSent += tlsStatus;
+
+            /* Stop on a timeout; the caller sends the rest again. */
+            if( ( size_t ) tlsStatus < bytesToSend )
+            {
+                break;
+            }
+        }
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pPreviousArena );
+        #endif
+    }
+
+    return bytesSent;
+}
+/*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+
+    void TLS_FreeRTOS_GetSessionCacheStats( TlsSessionCacheStats_t * pStats )
+    {
+        configASSERT( pStats != NULL );
+
+        if( TLS_Mutex_Take( &sessionCacheMutex ) == pdTRUE )
+        {
+            *pStats = sessionCacheStats;
+            ( void ) xSemaphoreGive( sessionCacheMutex );
+        }
+        else
+        {
+            ( void ) memset( pStats, 0, sizeof( *pStats ) );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void TLS_FreeRTOS_ClearSessionCache( void )
+    {
+        size_t i;
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+
+            /* Cached sessions came from the heap. */
+            TlsTransportArena_t * pArena = arenaSelect( NULL );
+        #endif
+
+        if( TLS_Mutex_Take( &sessionCacheMutex ) == pdTRUE )
+        {
+            for( i = 0U; i < ( size_t ) TLS_TRANSPORT_SESSION_CACHE_ENTRIES; i++ )
+            {
+                if( sessionCache[ i ].isValid == pdTRUE )
+                {
+                    mbedtls_ssl_session_free( &( sessionCache[ i ].session ) );
+                    sessionCache[ i ].isValid = pdFALSE;
+                }
+            }
+
+            ( void ) memset( &sessionCacheStats, 0, sizeof( sessionCacheStats ) );
+            ( void ) xSemaphoreGive( sessionCacheMutex );
+        }
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            ( void ) arenaSelect( pArena );
+        #endif
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 ) */
+
+#if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+
+    void TLS_FreeRTOS_GetArenaStats( const NetworkContext_t * pNetworkContext,
+                                     TlsArenaStats_t * pStats )
+    {
+        const TlsTransportArena_t * pArena = NULL;
+
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pNetworkContext->pParams != NULL );
+        configASSERT( pStats != NULL );
+
+        pArena = &( pNetworkContext->pParams->arena );
+
+        vTaskSuspendAll();
+        {
+            pStats->arenaSize = ( size_t ) TLS_TRANSPORT_ARENA_SIZE;
+            pStats->bytesInUse = pArena->bytesInUse;
+            pStats->handshakePeakBytes = pArena->handshakePeakBytes;
+            pStats->peakBytesInUse = pArena->peakBytesInUse;
+            pStats->failedAllocations = pArena->failedAllocations;
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) */
+
+#if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+
+    TlsTransportStatus_t TLS_FreeRTOS_SharedConfigInit( TlsSharedConfig_t * pSharedConfig,
+                                                        const NetworkCredentials_t * pNetworkCredentials )
+    {
+        TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            TlsTransportArena_t * pPreviousArena = NULL;
+        #endif
+
+        if( ( pSharedConfig == NULL ) ||
+            ( pNetworkCredentials == NULL ) )
+        {
+            LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. pSharedConfig=%p, "
+                        "pNetworkCredentials=%p.",
+                        pSharedConfig,
+                        pNetworkCredentials ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else if( pNetworkCredentials->pRootCa == NULL )
+        {
+            LogError( ( "pRootCa cannot be NULL." ) );
+            returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+        }
+        else
+        {
+            #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+                /* The configuration outlives the connections, so it must come
+                 * from the heap. */
+                ( void ) mbedtls_platform_set_calloc_free( arenaCalloc, arenaCallocFree );
+                pPreviousArena = arenaSelect( NULL );
+            #endif
+
+            pSharedConfig->connectionCount = 0U;
+            pSharedConfig->isInitialized = pdFALSE;
+
+            sslContextInit( &( pSharedConfig->sslContext ) );
+
+            returnStatus = initMbedtls( &( pSharedConfig->sslContext.entropyContext ),
+                                        &( pSharedConfig->sslContext.ctrDrbgContext ) );
+
+            if( returnStatus == TLS_TRANSPORT_SUCCESS )
+            {
+                returnStatus = sslConfigSetup( &( pSharedConfig->sslContext ),
+                                               pNetworkCredentials );
+            }
+
+            if( returnStatus == TLS_TRANSPORT_SUCCESS )
+            {
+                pSharedConfig->isInitialized = pdTRUE;
+            }
+            else
+            {
+                sslContextFree( &( pSharedConfig->sslContext ) );
+            }
+
+            #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+                ( void ) arenaSelect( pPreviousArena );
+            #endif
+        }
+
+        return returnStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    void TLS_FreeRTOS_SharedConfigFree( TlsSharedConfig_t * pSharedConfig )
+    {
+        #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+            TlsTransportArena_t * pPreviousArena = NULL;
+        #endif
+
+        if( ( pSharedConfig != NULL ) && ( pSharedConfig->isInitialized == pdTRUE ) )
+        {
+            /* A connection still set up with the configuration would use it
+             * after it is freed. */
+            configASSERT( pSharedConfig->connectionCount == 0U );
+
+            #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+                pPreviousArena = arenaSelect( NULL );
+            #endif
+
+            sslContextFree( &( pSharedConfig->sslContext ) );
+            pSharedConfig->isInitialized = pdFALSE;
+
+            #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+                ( void ) arenaSelect( pPreviousArena );
+            #endif
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_SHARED_CONFIG > 0 ) */
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats )
+    {
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pNetworkContext->pParams != NULL );
+        configASSERT( pStats != NULL );
+
+        vTaskSuspendAll();
+        {
+            *pStats = pNetworkContext->pParams->stats;
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_STATS > 0 ) */
@@ -90,9 +90,118 @@ extern void vLoggingPrintf( const char * pcFormatString,
 /* TCP Sockets Wrapper include.*/
 #include "tcp_sockets_wrapper.h"
 
+/* MbedTLS Bio TCP sockets wrapper include, for the receive buffer. */
+#include "mbedtls_bio_tcp_sockets_wrapper.h"
+
 /* Transport interface include. */
 #include "transport_interface.h"
 
+/* Transport statistics include. */
+#include "transport_stats.h"
+
+/**
+ * @brief Number of TLS sessions kept for resumption, one per server.
+ *
+ * When non-zero, the session negotiated with a server (host name and port) is
+ * kept after #TLS_FreeRTOS_Disconnect, and offered again by the next
+ * #TLS_FreeRTOS_Connect to the same server.  A server which accepts it, by
+ * session ID or session ticket, skips the certificate exchange and the key
+ * exchange, which saves most of the CPU time and traffic of a full handshake.
+ * Only TLS 1.2 sessions are kept.  When all entries are in use, the least
+ * recently used one is replaced.  Zero (the default) disables the cache.
+ */
+#ifndef TLS_TRANSPORT_SESSION_CACHE_ENTRIES
+    #define TLS_TRANSPORT_SESSION_CACHE_ENTRIES    0
+#endif
+
+/**
+ * @brief Longest host name, in characters, whose session is kept in the cache.
+ *
+ * Sessions with servers whose host names are longer are not kept.
+ */
+#ifndef TLS_TRANSPORT_SESSION_CACHE_HOST_LENGTH
+    #define TLS_TRANSPORT_SESSION_CACHE_HOST_LENGTH    64
+#endif
+
+/**
+ * @brief Size, in bytes, of the stack buffer in which #TLS_FreeRTOS_writev
+ * gathers small vectors.
+ *
+ * Vectors which fit together in the buffer are copied into it and sent as one
+ * TLS record, rather than as a record each, which saves the record overhead
+ * and a socket send for every vector after the first.  Larger vectors are sent
+ * in place.  Zero (the default) sends every vector in place, so that the
+ * stack of tasks calling #TLS_FreeRTOS_writev need not grow.
+ */
+#ifndef TLS_TRANSPORT_WRITEV_BUFFER_SIZE
+    #define TLS_TRANSPORT_WRITEV_BUFFER_SIZE    0
+#endif
+
+/**
+ * @brief Size, in bytes, of the memory of each connection from which mbed TLS
+ * allocates while the transport works on that connection.
+ *
+ * Each #TlsTransportParams_t then holds an arena of this size, so that the
+ * allocations of the setup, the handshake and the traffic of a connection
+ * neither fragment the FreeRTOS heap nor contend for it.  The transport
+ * installs its allocator with mbedtls_platform_set_calloc_free(), which
+ * requires MBEDTLS_PLATFORM_MEMORY without MBEDTLS_PLATFORM_CALLOC_MACRO and
+ * MBEDTLS_PLATFORM_FREE_MACRO; allocations made outside the transport, and
+ * those which outlive a connection, come from pvPortMalloc().  Use
+ * #TLS_FreeRTOS_GetArenaStats to size the arena.  Zero (the default) leaves
+ * mbed TLS allocating from its configured allocator.
+ */
+#ifndef TLS_TRANSPORT_ARENA_SIZE
+    #define TLS_TRANSPORT_ARENA_SIZE    0
+#endif
+
+/**
+ * @brief Index of the thread local storage pointer which tells the allocator
+ * the arena of the connection that the calling task is working on.
+ *
+ * configNUM_THREAD_LOCAL_STORAGE_POINTERS must be greater than this index.
+ */
+#ifndef TLS_TRANSPORT_ARENA_TLS_INDEX
+    #define TLS_TRANSPORT_ARENA_TLS_INDEX    0
+#endif
+
+/**
+ * @brief Allow connections to share one TLS configuration.
+ *
+ * When non-zero, #TLS_FreeRTOS_SharedConfigInit sets up an SSL configuration,
+ * parses the root CA, the client certificate and the private key, and seeds a
+ * CTR-DRBG once.  Connections whose #NetworkCredentials_t.pSharedConfig points
+ * to it then set up only their own SSL context, which saves the parsing, the
+ * seeding and the heap they would otherwise each take.  Connections in
+ * different tasks use the shared DRBG and key at once, so mbed TLS must be
+ * built with MBEDTLS_THREADING_C.  Zero (the default) sets up everything for
+ * every connection.
+ */
+#ifndef TLS_TRANSPORT_SHARED_CONFIG
+    #define TLS_TRANSPORT_SHARED_CONFIG    0
+#endif
+
+/**
+ * @brief Largest TLS record payload, in bytes, that connections negotiate
+ * with the server in either direction, with the max_fragment_length extension
+ * of RFC 6066.
+ *
+ * One of 512, 1024, 2048 or 4096; any other value leaves the extension out.
+ * Smaller records reach the application sooner on slow links, since a record
+ * can only be decrypted once all of it has arrived.  With
+ * MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH, mbed TLS also shrinks the input and
+ * output buffers of the connection to the negotiated length once the
+ * handshake is over, instead of keeping MBEDTLS_SSL_IN_CONTENT_LEN and
+ * MBEDTLS_SSL_OUT_CONTENT_LEN for the life of the connection.  Requires
+ * MBEDTLS_SSL_MAX_FRAGMENT_LENGTH.
+ *
+ * @note The RFC 8449 record_size_limit extension is not used: mbed TLS only
+ * offers it for TLS 1.3, and not yet for production use.
+ */
+#ifndef TLS_TRANSPORT_MAX_FRAGMENT_LENGTH
+    #define TLS_TRANSPORT_MAX_FRAGMENT_LENGTH    4096
+#endif
+
 /**
  * @brief Secured connection context.
  */
@@ -108,6 +217,73 @@ typedef struct SSLContext
     mbedtls_ctr_drbg_context ctrDrbgContext; /**< @brief CTR DRBG context for random number generation. */
 } SSLContext_t;
 
+#if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+
+/**
+ * @brief A TLS configuration shared by several connections.
+ *
+ * Set up by #TLS_FreeRTOS_SharedConfigInit, and not to be changed while
+ * connections use it.
+ */
+    typedef struct TlsSharedConfig
+    {
+        SSLContext_t sslContext;  /**< @brief Configuration, credentials and RNG; the SSL context itself is unused. */
+        uint32_t connectionCount; /**< @brief Connections set up with the configuration and not yet closed. */
+        BaseType_t isInitialized; /**< @brief pdTRUE between a successful init and the free. */
+    } TlsSharedConfig_t;
+#endif /* if ( TLS_TRANSPORT_SHARED_CONFIG > 0 ) */
+
+#if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+
+/**
+ * @brief The memory from which mbed TLS allocates for one connection.
+ */
+    typedef struct TlsTransportArena
+    {
+        void * pFreeList;                            /**< @brief First free block, in address order. */
+        size_t bytesInUse;                           /**< @brief Bytes allocated, including block headers. */
+        size_t peakBytesInUse;                       /**< @brief Most bytes allocated at once since the connection began. */
+        size_t handshakePeakBytes;                   /**< @brief Value of peakBytesInUse when the handshake finished. */
+        uint32_t failedAllocations;                  /**< @brief Allocations which did not fit since the connection began. */
+        uint8_t storage[ TLS_TRANSPORT_ARENA_SIZE ]; /**< @brief The memory allocated from. */
+    } TlsTransportArena_t;
+
+/**
+ * @brief Memory usage of the arena of a connection.
+ */
+    typedef struct TlsArenaStats
+    {
+        size_t arenaSize;           /**< @brief Size of the arena, #TLS_TRANSPORT_ARENA_SIZE. */
+        size_t bytesInUse;          /**< @brief Bytes allocated now. */
+        size_t handshakePeakBytes;  /**< @brief Most bytes allocated at once during the setup and handshake. */
+        size_t peakBytesInUse;      /**< @brief Most bytes allocated at once since the connection began. */
+        uint32_t failedAllocations; /**< @brief Allocations which did not fit in the arena. */
+    } TlsArenaStats_t;
+#endif /* if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) */
+
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+
+/**
+ * @brief The session ID offered to a server, to tell afterwards whether the
+ * server resumed the session.
+ */
+    typedef struct TlsSessionOffer
+    {
+        size_t idLength;       /**< @brief Length of the offered session ID; zero if nothing was offered. */
+        unsigned char id[ 32 ]; /**< @brief The offered session ID. */
+    } TlsSessionOffer_t;
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 ) */
+
+/**
+ * @brief Progress of a connection begun by #TLS_FreeRTOS_ConnectStart.
+ */
+typedef enum TlsConnectState
+{
+    TLS_CONNECT_STATE_IDLE = 0,       /**< No connection is being established. */
+    TLS_CONNECT_STATE_TCP_CONNECTING, /**< Waiting for the TCP connection. */
+    TLS_CONNECT_STATE_HANDSHAKING     /**< Performing the TLS handshake. */
+} TlsConnectState_t;
+
 /**
  * @brief Parameters for the network context of the transport interface
  * implementation that uses mbedTLS and FreeRTOS+TCP sockets.
@@ -116,6 +292,26 @@ typedef struct TlsTransportParams
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    #if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+        MbedTLSBioContext_t bioContext; /**< @brief Receive buffer between mbed TLS and the socket. */
+    #endif
+    TlsConnectState_t connectState; /**< @brief Progress of a connection begun by #TLS_FreeRTOS_ConnectStart. */
+    const char * pHostName;         /**< @brief Host name of the server while connecting. */
+    uint16_t port;                  /**< @brief Port of the server while connecting. */
+    uint32_t receiveTimeoutMs;      /**< @brief Receive timeout to set once connected. */
+    uint32_t sendTimeoutMs;         /**< @brief Send timeout to set once connected. */
+    #if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+        TlsSessionOffer_t sessionOffer;
+    #endif
+    #if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+        TlsTransportArena_t arena;
+    #endif
+    #if ( TLS_TRANSPORT_STATS > 0 )
+        TlsTransportStats_t stats; /**< @brief Timings and traffic of the connection. */
+    #endif
+    #if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+        TlsSharedConfig_t * pSharedConfig; /**< @brief Configuration the connection was set up with; NULL if its own. */
+    #endif
 } TlsTransportParams_t;
 
 /**
@@ -144,6 +340,37 @@ typedef struct NetworkCredentials
     size_t clientCertSize;       /**< @brief Size associated with #NetworkCredentials.pClientCert. */
     const uint8_t * pPrivateKey; /**< @brief String representing the client certificate's private key. */
     size_t privateKeySize;       /**< @brief Size associated with #NetworkCredentials.pPrivateKey. */
+
+    /**
+     * @brief Address to open the TCP connection to, e.g. a cached result of
+     * a DNS lookup, or NULL to use the host name of the connection.
+     *
+     * The host name is still used for SNI and the session cache.
+     */
+    const char * pServerAddress;
+
+    /**
+     * @brief Largest TLS record payload to negotiate, or 0 to use
+     * #TLS_TRANSPORT_MAX_FRAGMENT_LENGTH.
+     *
+     * With pSharedConfig, the value given to #TLS_FreeRTOS_SharedConfigInit
+     * applies instead.
+     */
+    uint16_t maxFragmentLength;
+
+    #if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+
+        /**
+         * @brief Configuration to set the connection up with, instead of its
+         * own.
+         *
+         * When not NULL, the root CA, client certificate, private key, ALPN
+         * protocols and maximum fragment length above are ignored, and those
+         * given to #TLS_FreeRTOS_SharedConfigInit are used.  SNI is still set from
+         * disableSni and the host name of each connection.
+         */
+        TlsSharedConfig_t * pSharedConfig;
+    #endif
 } NetworkCredentials_t;
 
 /**
@@ -157,9 +384,22 @@ typedef enum TlsTransportStatus
     TLS_TRANSPORT_INVALID_CREDENTIALS, /**< Provided credentials were invalid. */
     TLS_TRANSPORT_HANDSHAKE_FAILED,    /**< Performing TLS handshake with server failed. */
     TLS_TRANSPORT_INTERNAL_ERROR,      /**< A call to a system API resulted in an internal error. */
-    TLS_TRANSPORT_CONNECT_FAILURE      /**< Initial connection to the server failed. */
+    TLS_TRANSPORT_CONNECT_FAILURE,     /**< Initial connection to the server failed. */
+    TLS_TRANSPORT_IN_PROGRESS          /**< The connection is still being established. */
 } TlsTransportStatus_t;
 
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+
+/**
+ * @brief Handshake counts of the TLS session cache.
+ */
+    typedef struct TlsSessionCacheStats
+    {
+        uint32_t fullHandshakes;    /**< @brief Handshakes which negotiated a new session. */
+        uint32_t resumedHandshakes; /**< @brief Handshakes which resumed a cached session. */
+    } TlsSessionCacheStats_t;
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 ) */
+
 /**
  * @brief Create a TLS connection with FreeRTOS sockets.
  *
@@ -181,6 +421,52 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                            uint32_t receiveTimeoutMs,
                                            uint32_t sendTimeoutMs );
 
+/**
+ * @brief Begin a TLS connection with FreeRTOS sockets, without waiting for it.
+ *
+ * The TCP connection is begun and the TLS contexts are set up; call
+ * #TLS_FreeRTOS_ConnectPoll to advance the connection and the handshake.
+ * One task can so establish several connections at once.  @p pHostName must
+ * remain valid until the connection is established or has failed.
+ *
+ * @note The DNS lookup of @p pHostName may still block.
+ *
+ * @param[out] pNetworkContext Pointer to a network context to contain the
+ * initialized socket handle.
+ * @param[in] pHostName The hostname of the remote endpoint.
+ * @param[in] port The destination port.
+ * @param[in] pNetworkCredentials Credentials for the TLS connection.
+ * @param[in] receiveTimeoutMs Receive socket timeout, once connected.
+ * @param[in] sendTimeoutMs Send socket timeout, once connected.
+ *
+ * @return #TLS_TRANSPORT_IN_PROGRESS, #TLS_TRANSPORT_INVALID_PARAMETER,
+ * #TLS_TRANSPORT_INSUFFICIENT_MEMORY, #TLS_TRANSPORT_INVALID_CREDENTIALS,
+ * #TLS_TRANSPORT_INTERNAL_ERROR, or #TLS_TRANSPORT_CONNECT_FAILURE.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_ConnectStart( NetworkContext_t * pNetworkContext,
+                                                const char * pHostName,
+                                                uint16_t port,
+                                                const NetworkCredentials_t * pNetworkCredentials,
+                                                uint32_t receiveTimeoutMs,
+                                                uint32_t sendTimeoutMs );
+
+/**
+ * @brief Advance a connection begun by #TLS_FreeRTOS_ConnectStart, without
+ * blocking.
+ *
+ * Call this again, for example when the socket has data or after a short
+ * delay, while it returns #TLS_TRANSPORT_IN_PROGRESS.  On failure, the
+ * connection is released as by a failed #TLS_FreeRTOS_Connect.  To abandon a
+ * connection in progress, call #TLS_FreeRTOS_Disconnect.
+ *
+ * @param[in] pNetworkContext Network context.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS once connected, #TLS_TRANSPORT_IN_PROGRESS,
+ * #TLS_TRANSPORT_INVALID_PARAMETER, #TLS_TRANSPORT_HANDSHAKE_FAILED,
+ * #TLS_TRANSPORT_INTERNAL_ERROR, or #TLS_TRANSPORT_CONNECT_FAILURE.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_ConnectPoll( NetworkContext_t * pNetworkContext );
+
 /**
  * @brief Gracefully disconnect an established TLS connection.
  *
@@ -224,6 +510,101 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+/**
+ * @brief Sends the data of several buffers over an established TLS connection.
+ *
+ * @note This is the TLS version of the transport interface's
+ * #TransportWritev_t function.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes (> 0) sent on success, which may be fewer than the
+ * total length of the buffers; 0 if the socket times out without sending any
+ * bytes; else a negative value to represent error.
+ */
+int32_t TLS_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                             TransportOutVector_t * pIoVec,
+                             size_t ioVecCount );
+
+#if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 )
+
+/**
+ * @brief Get the handshake counts of the TLS session cache.
+ *
+ * @param[out] pStats Populated with the number of full and resumed handshakes
+ * since boot or the last #TLS_FreeRTOS_ClearSessionCache.
+ */
+    void TLS_FreeRTOS_GetSessionCacheStats( TlsSessionCacheStats_t * pStats );
+
+/**
+ * @brief Forget every cached TLS session, and zero the handshake counts.
+ *
+ * Call this when the credentials change, so that no session negotiated with
+ * the old credentials is resumed.
+ */
+    void TLS_FreeRTOS_ClearSessionCache( void );
+#endif /* if ( TLS_TRANSPORT_SESSION_CACHE_ENTRIES > 0 ) */
+
+#if ( TLS_TRANSPORT_ARENA_SIZE > 0 )
+
+/**
+ * @brief Get the memory usage of the arena of a connection.
+ *
+ * The peaks cover the connection begun by the last #TLS_FreeRTOS_Connect, so
+ * the largest handshakePeakBytes seen over the expected servers, plus the
+ * traffic peak, is the size the arena needs.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[out] pStats Populated with the memory usage.
+ */
+    void TLS_FreeRTOS_GetArenaStats( const NetworkContext_t * pNetworkContext,
+                                     TlsArenaStats_t * pStats );
+#endif /* if ( TLS_TRANSPORT_ARENA_SIZE > 0 ) */
+
+#if ( TLS_TRANSPORT_SHARED_CONFIG > 0 )
+
+/**
+ * @brief Set up a TLS configuration for connections to share.
+ *
+ * @param[out] pSharedConfig The configuration to set up.
+ * @param[in] pNetworkCredentials Root CA, client credentials and ALPN
+ * protocols of the configuration; the ALPN list must outlive the
+ * configuration.  Its pSharedConfig member is ignored.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_PARAMETER,
+ * #TLS_TRANSPORT_INSUFFICIENT_MEMORY, #TLS_TRANSPORT_INVALID_CREDENTIALS, or
+ * #TLS_TRANSPORT_INTERNAL_ERROR.
+ */
+    TlsTransportStatus_t TLS_FreeRTOS_SharedConfigInit( TlsSharedConfig_t * pSharedConfig,
+                                                        const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Free a configuration set up by #TLS_FreeRTOS_SharedConfigInit.
+ *
+ * Every connection set up with it must have been disconnected first.
+ *
+ * @param[in] pSharedConfig The configuration to free.
+ */
+    void TLS_FreeRTOS_SharedConfigFree( TlsSharedConfig_t * pSharedConfig );
+#endif /* if ( TLS_TRANSPORT_SHARED_CONFIG > 0 ) */
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+/**
+ * @brief Get the connect timings and the traffic counters of a connection.
+ *
+ * The statistics cover the connection begun by the last #TLS_FreeRTOS_Connect
+ * or #TLS_FreeRTOS_ConnectStart, and remain readable after it is closed.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[out] pStats Populated with the statistics.
+ */
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats );
+#endif /* if ( TLS_TRANSPORT_STATS > 0 ) */
+
 
 #ifdef MBEDTLS_DEBUG_C
 
@@ -79,6 +79,12 @@
 #include "pkcs11.h"
 #include "core_pki_utils.h"
 
+#if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+    #include "task.h"
+    #include "semphr.h"
+    #include "transport_mutex.h"
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -126,6 +132,37 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
 
 /*-----------------------------------------------------------*/
 
+#if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+
+/**
+ * @brief Client credentials kept across connections.
+ */
+    typedef struct TlsCredentialCache
+    {
+        BaseType_t isLoaded;                                      /**< @brief pdTRUE if the fields below hold credentials. */
+        BaseType_t isInUse;                                       /**< @brief pdTRUE while a connection uses or is loading the credentials. */
+        BaseType_t isStale;                                       /**< @brief pdTRUE if the credentials are to be released once no longer in use. */
+        char privateKeyLabel[ pkcs11configMAX_LABEL_LENGTH + 1 ]; /**< @brief Label of the private key. */
+        char clientCertLabel[ pkcs11configMAX_LABEL_LENGTH + 1 ]; /**< @brief Label of the client certificate. */
+        CK_SESSION_HANDLE xP11Session;                            /**< @brief The logged-in session. */
+        CK_OBJECT_HANDLE xP11PrivateKey;                          /**< @brief Handle of the private key. */
+        mbedtls_pk_context privKey;                               /**< @brief Private key context, which signs through the session. */
+        mbedtls_x509_crt clientCert;                              /**< @brief The parsed client certificate. */
+    } TlsCredentialCache_t;
+
+/**
+ * @brief The cached credentials.
+ */
+    static TlsCredentialCache_t credentialCache = { 0 };
+
+/**
+ * @brief Mutex protecting #credentialCache, created on first use.
+ */
+    static SemaphoreHandle_t credentialCacheMutex = NULL;
+#endif /* if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 ) */
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Initialize the mbed TLS structures in a network connection.
  *
@@ -154,6 +191,72 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
                                       const char * pHostName,
                                       const NetworkCredentials_t * pNetworkCredentials );
 
+/**
+ * @brief Set up the client private key and certificate of a connection.
+ *
+ * @param[in] pSslContext The SSL context, whose configuration has been set up.
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS or #TLS_TRANSPORT_INVALID_CREDENTIALS.
+ */
+static TlsTransportStatus_t setupClientCredentials( SSLContext_t * pSslContext,
+                                                    const NetworkCredentials_t * pNetworkCredentials );
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+/**
+ * @brief Perform the TLS handshake one step at a time, adding the time of
+ * each step to the statistics of the connection.
+ *
+ * @param[in] pTlsTransportParams TLS transport parameters of the connection.
+ *
+ * @return The return value of mbedtls_ssl_handshake.
+ */
+    static int32_t statsHandshake( TlsTransportParams_t * pTlsTransportParams );
+#endif
+
+#if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+
+/**
+ * @brief Release the cached credentials.
+ *
+ * The credential cache mutex must be held.
+ */
+    static void credentialCacheUnload( void );
+
+/**
+ * @brief Use the cached credentials for a connection, if they match it and no
+ * other connection uses them.
+ *
+ * @param[in] pSslContext The SSL context of the connection.
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ * @param[out] pIsReserved Set to pdTRUE if the cache held no matching
+ * credentials but is reserved for the connection, which is then to load its
+ * credentials and pass them to #credentialCacheAdopt or give the cache up
+ * with #credentialCacheRelease.
+ *
+ * @return pdTRUE if the connection now uses the cached credentials.
+ */
+    static BaseType_t credentialCacheAcquire( SSLContext_t * pSslContext,
+                                              const NetworkCredentials_t * pNetworkCredentials,
+                                              BaseType_t * pIsReserved );
+
+/**
+ * @brief Move the credentials just loaded by a connection into the reserved
+ * cache, for the connection and the ones after it to use.
+ *
+ * @param[in] pSslContext The SSL context of the connection.
+ * @param[in] pNetworkCredentials TLS setup parameters.
+ */
+    static void credentialCacheAdopt( SSLContext_t * pSslContext,
+                                      const NetworkCredentials_t * pNetworkCredentials );
+
+/**
+ * @brief Give up the use or reservation of the cache by a connection.
+ */
+    static void credentialCacheRelease( void );
+#endif /* if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 ) */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -249,6 +352,7 @@ static void sslContextInit( SSLContext_t * pSslContext )
     mbedtls_ssl_config_init( &( pSslContext->config ) );
     mbedtls_x509_crt_init( &( pSslContext->rootCa ) );
     mbedtls_x509_crt_init( &( pSslContext->clientCert ) );
+    mbedtls_pk_init( &( pSslContext->privKey ) );
     mbedtls_ssl_init( &( pSslContext->context ) );
     #ifdef MBEDTLS_DEBUG_C
         mbedtls_debug_set_threshold( LIBRARY_LOG_LEVEL + 1U );
@@ -257,7 +361,13 @@ static void sslContextInit( SSLContext_t * pSslContext )
                               NULL );
     #endif /* MBEDTLS_DEBUG_C */
 
-    xInitializePkcs11Session( &( pSslContext->xP11Session ) );
+    #if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+        /* The session is opened only if the cached one cannot be used. */
+        pSslContext->xP11Session = CK_INVALID_HANDLE;
+        pSslContext->usesCredentialCache = pdFALSE;
+    #else
+        xInitializePkcs11Session( &( pSslContext->xP11Session ) );
+    #endif
     C_GetFunctionList( &( pSslContext->pxP11FunctionList ) );
 }
 /*-----------------------------------------------------------*/
@@ -273,7 +383,26 @@ static void sslContextFree( SSLContext_t * pSslContext )
 
     mbedtls_pk_free( &( pSslContext->privKey ) );
 
-    pSslContext->pxP11FunctionList->C_CloseSession( pSslContext->xP11Session );
+    #if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+        if( pSslContext->usesCredentialCache == pdTRUE )
+        {
+            /* The session, key and certificate stay in the cache. */
+            pSslContext->usesCredentialCache = pdFALSE;
+            credentialCacheRelease();
+        }
+        else if( pSslContext->xP11Session != CK_INVALID_HANDLE )
+        {
+            pSslContext->pxP11FunctionList->C_CloseSession( pSslContext->xP11Session );
+        }
+        else
+        {
+            /* Empty else for MISRA 15.7 compliance. */
+        }
+
+        pSslContext->xP11Session = CK_INVALID_HANDLE;
+    #else
+        pSslContext->pxP11FunctionList->C_CloseSession( pSslContext->xP11Session );
+    #endif
 }
 
 /*-----------------------------------------------------------*/
@@ -285,7 +414,6 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
     TlsTransportParams_t * pTlsTransportParams = NULL;
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     int32_t mbedtlsError = 0;
-    CK_RV xResult = CKR_OK;
 
     configASSERT( pNetworkContext != NULL );
     configASSERT( pNetworkContext->pParams != NULL );
@@ -315,6 +443,16 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
         returnStatus = TLS_TRANSPORT_INSUFFICIENT_MEMORY;
     }
 
+    #if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+        /* mbedTLS only calls the restartable signing hook of the PKCS #11 key
+         * while restartable ECC is enabled.  The largest budget enables it
+         * without making software ECC operations return early. */
+        if( mbedtls_ecp_restart_is_enabled() == 0 )
+        {
+            mbedtls_ecp_set_max_ops( ~0U );
+        }
+    #endif
+
     #ifdef MBEDTLS_PSA_CRYPTO_C
         mbedtlsError = psa_crypto_init();
 
@@ -375,37 +513,8 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
-        /* Setup the client private key. */
-        xResult = initializeClientKeys( &( pTlsTransportParams->sslContext ),
-                                        pNetworkCredentials->pPrivateKeyLabel );
-
-        if( xResult != CKR_OK )
-        {
-            LogError( ( "Failed to setup key handling by PKCS #11." ) );
-
-            returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
-        }
-        else
-        {
-            /* Setup the client certificate. */
-            xResult = readCertificateIntoContext( &( pTlsTransportParams->sslContext ),
-                                                  pNetworkCredentials->pClientCertLabel,
-                                                  CKO_CERTIFICATE,
-                                                  &( pTlsTransportParams->sslContext.clientCert ) );
-
-            if( xResult != CKR_OK )
-            {
-                LogError( ( "Failed to get certificate from PKCS #11 module." ) );
-
-                returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
-            }
-            else
-            {
-                ( void ) mbedtls_ssl_conf_own_cert( &( pTlsTransportParams->sslContext.config ),
-                                                    &( pTlsTransportParams->sslContext.clientCert ),
-                                                    &( pTlsTransportParams->sslContext.privKey ) );
-            }
-        }
+        returnStatus = setupClientCredentials( &( pTlsTransportParams->sslContext ),
+                                               pNetworkCredentials );
     }
 
     if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) && ( pNetworkCredentials->pAlpnProtos != NULL ) )
@@ -448,11 +557,21 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
              * #mbedtls_ssl_set_bio requires the second parameter as void *.
              */
             /* coverity[misra_c_2012_rule_11_2_violation] */
-            mbedtls_ssl_set_bio( &( pTlsTransportParams->sslContext.context ),
-                                 ( void * ) pTlsTransportParams->tcpSocket,
-                                 xMbedTLSBioTCPSocketsWrapperSend,
-                                 xMbedTLSBioTCPSocketsWrapperRecv,
-                                 NULL );
+            #if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+                /* mbed TLS reads through the receive buffer of the connection. */
+                vMbedTLSBioInit( &( pTlsTransportParams->bioContext ), pTlsTransportParams->tcpSocket );
+                mbedtls_ssl_set_bio( &( pTlsTransportParams->sslContext.context ),
+                                     ( void * ) &( pTlsTransportParams->bioContext ),
+                                     xMbedTLSBioTCPSocketsWrapperSend,
+                                     xMbedTLSBioTCPSocketsWrapperRecv,
+                                     NULL );
+            #else
+                mbedtls_ssl_set_bio( &( pTlsTransportParams->sslContext.context ),
+                                     ( void * ) pTlsTransportParams->tcpSocket,
+                                     xMbedTLSBioTCPSocketsWrapperSend,
+                                     xMbedTLSBioTCPSocketsWrapperRecv,
+                                     NULL );
+            #endif
         }
     }
 
@@ -498,14 +617,49 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_EndPhase( &( pTlsTransportParams->stats ),
+                                &( pTlsTransportParams->stats.setupMs ) );
+        #endif
+
+        #if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+            PKCS11RngStats_t xRngStatsBefore;
+            PKCS11RngStats_t xRngStatsAfter;
+
+            vPKCS11_GetRngStats( &xRngStatsBefore, pdFALSE );
+        #endif
+
         /* Perform the TLS handshake. */
         do
         {
-            mbedtlsError = mbedtls_ssl_handshake( &( pTlsTransportParams->sslContext.context ) );
+            #if ( TLS_TRANSPORT_STATS > 0 )
+                mbedtlsError = statsHandshake( pTlsTransportParams );
+            #else
+                mbedtlsError = mbedtls_ssl_handshake( &( pTlsTransportParams->sslContext.context ) );
+            #endif
+
+            #if ( MBEDTLS_PKCS11_ASYNC_SIGN > 0 )
+                if( mbedtlsError == MBEDTLS_ERR_SSL_CRYPTO_IN_PROGRESS )
+                {
+                    /* The PKCS #11 worker task is computing the signature. */
+                    ( void ) xPKCS11_WaitForAsyncSign( pdMS_TO_TICKS( MBEDTLS_PKCS11_ASYNC_SIGN_POLL_MS ) );
+                }
+            #endif
         } while( ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_READ ) ||
                  ( mbedtlsError == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
+                 ( mbedtlsError == MBEDTLS_ERR_SSL_CRYPTO_IN_PROGRESS ) ||
                  ( mbedtlsError == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET ) );
 
+        #if ( MBEDTLS_PKCS11_RNG_STATS > 0 )
+            /* The counters are shared, so this includes any other connection
+             * made at the same time. */
+            vPKCS11_GetRngStats( &xRngStatsAfter, pdFALSE );
+            LogDebug( ( "(Network connection %p) TLS handshake made %u random number requests and %u C_GenerateRandom calls.",
+                        pNetworkContext,
+                        ( unsigned ) ( xRngStatsAfter.ulRequests - xRngStatsBefore.ulRequests ),
+                        ( unsigned ) ( xRngStatsAfter.ulTokenCalls - xRngStatsBefore.ulTokenCalls ) ) );
+        #endif
+
         if( mbedtlsError != 0 )
         {
             if( mbedtlsError == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET )
@@ -519,6 +673,15 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
                             mbedtlsLowLevelCodeOrDefault( mbedtlsError ) ) );
 
                 returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
+
+                #if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+                    /* Load the credentials again next time, in case a stale
+                     * session or key handle failed the signature. */
+                    if( pTlsTransportParams->sslContext.usesCredentialCache == pdTRUE )
+                    {
+                        TLS_FreeRTOS_InvalidateCredentialCache();
+                    }
+                #endif
             }
         }
     }
@@ -538,17 +701,294 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
 
 /*-----------------------------------------------------------*/
 
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+    static int32_t statsHandshake( TlsTransportParams_t * pTlsTransportParams )
+    {
+        mbedtls_ssl_context * pSslContext = &( pTlsTransportParams->sslContext.context );
+        TlsTransportStats_t * pStats = &( pTlsTransportParams->stats );
+        int32_t mbedtlsError = 0;
+        int state = 0;
+        uint32_t stepMs = 0U;
+
+        while( ( mbedtlsError == 0 ) && ( mbedtls_ssl_is_handshake_over( pSslContext ) == 0 ) )
+        {
+            state = pSslContext->MBEDTLS_PRIVATE( state );
+            pStats->phaseStartMs = TLS_TRANSPORT_STATS_TIME_MS();
+
+            mbedtlsError = mbedtls_ssl_handshake_step( pSslContext );
+
+            stepMs = TLS_TRANSPORT_STATS_TIME_MS() - pStats->phaseStartMs;
+            pStats->handshakeMs += stepMs;
+
+            switch( state )
+            {
+                case MBEDTLS_SSL_SERVER_CERTIFICATE:
+                    pStats->serverCertificateMs += stepMs;
+                    break;
+
+                case MBEDTLS_SSL_SERVER_KEY_EXCHANGE:
+                case MBEDTLS_SSL_CLIENT_KEY_EXCHANGE:
+                    pStats->keyExchangeMs += stepMs;
+                    break;
+
+                case MBEDTLS_SSL_CERTIFICATE_VERIFY:
+
+                    /* In TLS 1.3, this step checks the server's signature. */
+                    if( mbedtls_ssl_get_version_number( pSslContext ) == MBEDTLS_SSL_VERSION_TLS1_3 )
+                    {
+                        pStats->serverCertificateMs += stepMs;
+                    }
+                    else
+                    {
+                        pStats->certificateVerifyMs += stepMs;
+                    }
+
+                    break;
+
+                case MBEDTLS_SSL_CLIENT_CERTIFICATE_VERIFY:
+                    pStats->certificateVerifyMs += stepMs;
+                    break;
+
+                default:
+                    /* The other steps only count towards the total. */
+                    break;
+            }
+        }
+
+        return mbedtlsError;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_STATS > 0 ) */
+
+static TlsTransportStatus_t setupClientCredentials( SSLContext_t * pSslContext,
+                                                    const NetworkCredentials_t * pNetworkCredentials )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    CK_RV xResult = CKR_OK;
+    mbedtls_x509_crt * pClientCert = &( pSslContext->clientCert );
+    mbedtls_pk_context * pPrivKey = &( pSslContext->privKey );
+
+    #if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+        BaseType_t isCached = pdFALSE;
+        BaseType_t isReserved = pdFALSE;
+
+        isCached = credentialCacheAcquire( pSslContext, pNetworkCredentials, &isReserved );
+
+        if( isCached == pdTRUE )
+        {
+            LogDebug( ( "Using the cached PKCS #11 credentials." ) );
+            pClientCert = &( credentialCache.clientCert );
+            pPrivKey = &( credentialCache.privKey );
+        }
+        else
+        {
+            xResult = xInitializePkcs11Session( &( pSslContext->xP11Session ) );
+
+            if( xResult != CKR_OK )
+            {
+                LogError( ( "Failed to open a PKCS #11 session." ) );
+
+                returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
+            }
+        }
+
+        if( ( isCached == pdFALSE ) && ( returnStatus == TLS_TRANSPORT_SUCCESS ) )
+    #endif /* if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 ) */
+    {
+        /* Setup the client private key. */
+        xResult = initializeClientKeys( pSslContext,
+                                        pNetworkCredentials->pPrivateKeyLabel );
+
+        if( xResult != CKR_OK )
+        {
+            LogError( ( "Failed to setup key handling by PKCS #11." ) );
+
+            returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
+        }
+        else
+        {
+            /* Setup the client certificate. */
+            xResult = readCertificateIntoContext( pSslContext,
+                                                  pNetworkCredentials->pClientCertLabel,
+                                                  CKO_CERTIFICATE,
+                                                  &( pSslContext->clientCert ) );
+
+            if( xResult != CKR_OK )
+            {
+                LogError( ( "Failed to get certificate from PKCS #11 module." ) );
+
+                returnStatus = TLS_TRANSPORT_INVALID_CREDENTIALS;
+            }
+        }
+    }
+
+    #if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+        if( isReserved == pdTRUE )
+        {
+            if( returnStatus == TLS_TRANSPORT_SUCCESS )
+            {
+                credentialCacheAdopt( pSslContext, pNetworkCredentials );
+                pClientCert = &( credentialCache.clientCert );
+                pPrivKey = &( credentialCache.privKey );
+            }
+            else
+            {
+                credentialCacheRelease();
+            }
+        }
+    #endif
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        ( void ) mbedtls_ssl_conf_own_cert( &( pSslContext->config ),
+                                            pClientCert,
+                                            pPrivKey );
+    }
+
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+
+    static void credentialCacheUnload( void )
+    {
+        CK_FUNCTION_LIST_PTR pxFunctionList = NULL;
+
+        if( credentialCache.isLoaded == pdTRUE )
+        {
+            mbedtls_x509_crt_free( &( credentialCache.clientCert ) );
+            mbedtls_pk_free( &( credentialCache.privKey ) );
+
+            if( ( C_GetFunctionList( &pxFunctionList ) == CKR_OK ) && ( pxFunctionList != NULL ) )
+            {
+                ( void ) pxFunctionList->C_CloseSession( credentialCache.xP11Session );
+            }
+
+            credentialCache.xP11Session = CK_INVALID_HANDLE;
+            credentialCache.xP11PrivateKey = CK_INVALID_HANDLE;
+            credentialCache.isLoaded = pdFALSE;
+        }
+
+        credentialCache.isStale = pdFALSE;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static BaseType_t credentialCacheAcquire( SSLContext_t * pSslContext,
+                                              const NetworkCredentials_t * pNetworkCredentials,
+                                              BaseType_t * pIsReserved )
+    {
+        BaseType_t isCached = pdFALSE;
+
+        *pIsReserved = pdFALSE;
+
+        if( TLS_Mutex_Take( &credentialCacheMutex ) == pdTRUE )
+        {
+            if( credentialCache.isInUse == pdTRUE )
+            {
+                /* Another connection is using the cached session. */
+            }
+            else if( ( credentialCache.isLoaded == pdTRUE ) &&
+                     ( credentialCache.isStale == pdFALSE ) &&
+                     ( strncmp( credentialCache.privateKeyLabel,
+                                pNetworkCredentials->pPrivateKeyLabel,
+                                sizeof( credentialCache.privateKeyLabel ) ) == 0 ) &&
+                     ( strncmp( credentialCache.clientCertLabel,
+                                pNetworkCredentials->pClientCertLabel,
+                                sizeof( credentialCache.clientCertLabel ) ) == 0 ) )
+            {
+                credentialCache.isInUse = pdTRUE;
+                pSslContext->xP11Session = credentialCache.xP11Session;
+                pSslContext->xP11PrivateKey = credentialCache.xP11PrivateKey;
+                pSslContext->usesCredentialCache = pdTRUE;
+                isCached = pdTRUE;
+            }
+            else
+            {
+                /* Make room for the credentials of this connection. */
+                credentialCacheUnload();
+                credentialCache.isInUse = pdTRUE;
+                *pIsReserved = pdTRUE;
+            }
+
+            ( void ) xSemaphoreGive( credentialCacheMutex );
+        }
+
+        return isCached;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void credentialCacheAdopt( SSLContext_t * pSslContext,
+                                      const NetworkCredentials_t * pNetworkCredentials )
+    {
+        if( TLS_Mutex_Take( &credentialCacheMutex ) == pdTRUE )
+        {
+            ( void ) strncpy( credentialCache.privateKeyLabel,
+                              pNetworkCredentials->pPrivateKeyLabel,
+                              sizeof( credentialCache.privateKeyLabel ) - 1U );
+            credentialCache.privateKeyLabel[ sizeof( credentialCache.privateKeyLabel ) - 1U ] = '\0';
+            ( void ) strncpy( credentialCache.clientCertLabel,
+                              pNetworkCredentials->pClientCertLabel,
+                              sizeof( credentialCache.clientCertLabel ) - 1U );
+            credentialCache.clientCertLabel[ sizeof( credentialCache.clientCertLabel ) - 1U ] = '\0';
+
+            /* Move the contexts into the cache. Nothing refers to the head of
+             * a certificate chain or to a PK context by address yet, since
+             * the SSL configuration is given the cached ones. */
+            credentialCache.privKey = pSslContext->privKey;
+            mbedtls_pk_init( &( pSslContext->privKey ) );
+            credentialCache.clientCert = pSslContext->clientCert;
+            mbedtls_x509_crt_init( &( pSslContext->clientCert ) );
+
+            credentialCache.xP11Session = pSslContext->xP11Session;
+            credentialCache.xP11PrivateKey = pSslContext->xP11PrivateKey;
+            credentialCache.isLoaded = pdTRUE;
+            pSslContext->usesCredentialCache = pdTRUE;
+
+            ( void ) xSemaphoreGive( credentialCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void credentialCacheRelease( void )
+    {
+        if( TLS_Mutex_Take( &credentialCacheMutex ) == pdTRUE )
+        {
+            credentialCache.isInUse = pdFALSE;
+
+            if( credentialCache.isStale == pdTRUE )
+            {
+                credentialCacheUnload();
+            }
+
+            ( void ) xSemaphoreGive( credentialCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 ) */
+
 static int32_t generateRandomBytes( void * pvCtx,
                                     unsigned char * pucRandom,
                                     size_t xRandomLength )
 {
     /* Must cast from void pointer to conform to mbed TLS API. */
     SSLContext_t * pxCtx = ( SSLContext_t * ) pvCtx;
-    CK_RV xResult;
+    int32_t xResult;
 
-    xResult = pxCtx->pxP11FunctionList->C_GenerateRandom( pxCtx->xP11Session, pucRandom, xRandomLength );
+    /* Go through the shared callback, which may serve the request from its
+     * random pool. */
+    xResult = lMbedCryptoRngCallbackPKCS11( &( pxCtx->xP11Session ), pucRandom, xRandomLength );
 
-    if( xResult != CKR_OK )
+    if( xResult != 0 )
     {
         LogError( ( "Failed to generate random bytes from the PKCS #11 module." ) );
     }
@@ -681,6 +1121,13 @@ static CK_RV initializeClientKeys( SSLContext_t * pxCtx,
                                                                     sizeof( configPKCS11_DEFAULT_USER_PIN ) - 1 );
     }
 
+    /* Login state is shared by the sessions of an application, so another
+     * open session, such as a cached one, may already have logged in. */
+    if( CKR_USER_ALREADY_LOGGED_IN == xResult )
+    {
+        xResult = CKR_OK;
+    }
+
     if( CKR_OK == xResult )
     {
         /* Get the handle of the device private key. */
@@ -755,6 +1202,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         /* Initialize tcpSocket. */
         pTlsTransportParams->tcpSocket = NULL;
 
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Reset( &( pTlsTransportParams->stats ) );
+        #endif
+
         socketStatus = TCP_Sockets_Connect( &( pTlsTransportParams->tcpSocket ),
                                             pHostName,
                                             port,
@@ -775,6 +1226,11 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     {
         isSocketConnected = pdTRUE;
 
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_EndPhase( &( pTlsTransportParams->stats ),
+                                &( pTlsTransportParams->stats.tcpConnectMs ) );
+        #endif
+
         returnStatus = tlsSetup( pNetworkContext, pHostName, pNetworkCredentials );
     }
 
@@ -792,6 +1248,10 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         LogInfo( ( "(Network connection %p) Connection to %s established.",
                    pNetworkContext,
                    pHostName ) );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Track( &( pTlsTransportParams->stats ) );
+        #endif
     }
 
     return returnStatus;
@@ -833,6 +1293,10 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
 
         /* Free mbed TLS contexts. */
         sslContextFree( &( pTlsTransportParams->sslContext ) );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Untrack( &( pTlsTransportParams->stats ) );
+        #endif
     }
 }
 
@@ -868,6 +1332,19 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
                                                   pBuffer,
                                                   bytesToRecv );
 
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            if( tlsStatus > 0 )
+            {
+                pTlsTransportParams->stats.bytesReceived += ( uint32_t ) tlsStatus;
+
+                /* A record is counted once it has been read in full. */
+                if( mbedtls_ssl_get_bytes_avail( &( pTlsTransportParams->sslContext.context ) ) == 0U )
+                {
+                    pTlsTransportParams->stats.recordsReceived++;
+                }
+            }
+        #endif
+
         if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
@@ -933,6 +1410,14 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                                                    pBuffer,
                                                    bytesToSend );
 
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            if( tlsStatus > 0 )
+            {
+                pTlsTransportParams->stats.bytesSent += ( uint32_t ) tlsStatus;
+                pTlsTransportParams->stats.recordsSent++;
+            }
+        #endif
+
         if( ( tlsStatus == MBEDTLS_ERR_SSL_TIMEOUT ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_READ ) ||
             ( tlsStatus == MBEDTLS_ERR_SSL_WANT_WRITE ) ||
@@ -967,3 +1452,46 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+
+    void TLS_FreeRTOS_InvalidateCredentialCache( void )
+    {
+        if( TLS_Mutex_Take( &credentialCacheMutex ) == pdTRUE )
+        {
+            if( credentialCache.isInUse == pdTRUE )
+            {
+                credentialCache.isStale = pdTRUE;
+            }
+            else
+            {
+                credentialCacheUnload();
+            }
+
+            ( void ) xSemaphoreGive( credentialCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 ) */
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats )
+    {
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pNetworkContext->pParams != NULL );
+        configASSERT( pStats != NULL );
+
+        vTaskSuspendAll();
+        {
+            *pStats = pNetworkContext->pParams->stats;
+        }
+        ( void ) xTaskResumeAll();
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_STATS > 0 ) */
@@ -48,9 +48,15 @@
 /* TCP Sockets Wrapper include.*/
 #include "tcp_sockets_wrapper.h"
 
+/* MbedTLS Bio TCP sockets wrapper include, for the receive buffer. */
+#include "mbedtls_bio_tcp_sockets_wrapper.h"
+
 /* Transport interface include. */
 #include "transport_interface.h"
 
+/* Transport statistics include. */
+#include "transport_stats.h"
+
 /* mbed TLS includes. */
 #include "mbedtls/build_info.h"
 #include "mbedtls/ctr_drbg.h"
@@ -66,6 +72,23 @@
 /* PKCS #11 includes. */
 #include "core_pkcs11.h"
 
+/**
+ * @brief Keep the client credentials loaded from PKCS #11 across connections.
+ *
+ * When non-zero, the logged-in PKCS #11 session, the private key handle and
+ * context, and the parsed client certificate of a connection are kept after
+ * #TLS_FreeRTOS_Disconnect.  The next #TLS_FreeRTOS_Connect with the same
+ * labels uses them instead of opening a session, logging in, finding the
+ * objects, and reading and parsing the certificate again.  A second
+ * connection made while the first is open loads its own credentials, so that
+ * two handshakes never share a session.  Call
+ * #TLS_FreeRTOS_InvalidateCredentialCache after changing the key or
+ * certificate.  Zero (the default) loads the credentials for every connection.
+ */
+#ifndef TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE
+    #define TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE    0
+#endif
+
 /**
  * @brief Secured connection context.
  */
@@ -83,6 +106,10 @@ typedef struct SSLContext
     CK_FUNCTION_LIST_PTR pxP11FunctionList;
     CK_SESSION_HANDLE xP11Session;
     CK_OBJECT_HANDLE xP11PrivateKey;
+
+    #if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+        BaseType_t usesCredentialCache; /**< @brief pdTRUE if the session, key and certificate are the cached ones. */
+    #endif
 } SSLContext_t;
 
 /**
@@ -93,6 +120,12 @@ typedef struct TlsTransportParams
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    #if ( MBEDTLS_BIO_RECV_BUFFER_SIZE > 0 )
+        MbedTLSBioContext_t bioContext; /**< @brief Receive buffer between mbed TLS and the socket. */
+    #endif
+    #if ( TLS_TRANSPORT_STATS > 0 )
+        TlsTransportStats_t stats; /**< @brief Timings and traffic of the connection. */
+    #endif
 } TlsTransportParams_t;
 
 /**
@@ -203,6 +236,32 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+#if ( TLS_TRANSPORT_PKCS11_CREDENTIAL_CACHE > 0 )
+
+/**
+ * @brief Forget the cached PKCS #11 credentials.
+ *
+ * Call this when the client key or certificate objects change, or after the
+ * PKCS #11 module is finalized, so that the next connection loads them again.
+ * Credentials still in use by a connection are released when it disconnects.
+ */
+    void TLS_FreeRTOS_InvalidateCredentialCache( void );
+#endif
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+/**
+ * @brief Get the connect timings and the traffic counters of a connection.
+ *
+ * The statistics cover the connection begun by the last #TLS_FreeRTOS_Connect,
+ * and remain readable after it is closed.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[out] pStats Populated with the statistics.
+ */
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats );
+#endif
 
 #ifdef MBEDTLS_DEBUG_C
 
@@ -0,0 +1,85 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_mutex.c
+ * @brief Creates the mutexes of the TLS transports on first use.
+ */
+
+#include "logging_levels.h"
+
+#ifndef LIBRARY_LOG_NAME
+    #define LIBRARY_LOG_NAME    "TransportMutex"
+#endif /* LIBRARY_LOG_NAME */
+
+#ifndef LIBRARY_LOG_LEVEL
+    #define LIBRARY_LOG_LEVEL    LOG_ERROR
+#endif /* LIBRARY_LOG_LEVEL */
+
+#include "logging_stack.h"
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Transport mutex include. */
+#include "transport_mutex.h"
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_Mutex_Take( SemaphoreHandle_t * pMutex )
+{
+    BaseType_t returnStatus = pdFALSE;
+
+    configASSERT( pMutex != NULL );
+
+    /* Create the mutex with the scheduler suspended, so that two tasks
+     * taking it for the first time cannot both create it. */
+    if( *pMutex == NULL )
+    {
+        vTaskSuspendAll();
+        {
+            if( *pMutex == NULL )
+            {
+                *pMutex = xSemaphoreCreateMutex();
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+
+    if( *pMutex == NULL )
+    {
+        LogError( ( "Failed to create a TLS transport mutex." ) );
+    }
+    else
+    {
+        returnStatus = xSemaphoreTake( *pMutex, portMAX_DELAY );
+    }
+
+    return returnStatus;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,53 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_mutex.h
+ * @brief Mutexes created on first use, shared by the TLS transports.
+ */
+
+#ifndef TRANSPORT_MUTEX_H
+#define TRANSPORT_MUTEX_H
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/**
+ * @brief Take a mutex, creating it first if @p pMutex is NULL.
+ *
+ * A module whose state may be used by any task before the application calls
+ * anything else keeps a NULL handle and takes the mutex through this
+ * function.  The mutex is never deleted.
+ *
+ * @param[in,out] pMutex Handle of the mutex, initially NULL.
+ *
+ * @return pdTRUE if the mutex was taken, or pdFALSE if it could not be
+ * created.
+ */
+BaseType_t TLS_Mutex_Take( SemaphoreHandle_t * pMutex );
+
+#endif /* ifndef TRANSPORT_MUTEX_H */
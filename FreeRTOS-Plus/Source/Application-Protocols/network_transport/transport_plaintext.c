@@ -149,6 +149,66 @@ int32_t Plaintext_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
     return socketStatus;
 }
 
+int32_t Plaintext_FreeRTOS_recvZeroCopy( NetworkContext_t * pNetworkContext,
+                                         const void ** ppBuffer,
+                                         size_t bytesToRecv )
+{
+    PlaintextTransportParams_t * pPlaintextTransportParams = NULL;
+    int32_t socketStatus = 1;
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
+        socketStatus = -1;
+    }
+    else if( ppBuffer == NULL )
+    {
+        LogError( ( "invalid input, ppBuffer == NULL" ) );
+        socketStatus = -1;
+    }
+    else if( bytesToRecv == 0 )
+    {
+        LogError( ( "invalid input, bytesToRecv == 0" ) );
+        socketStatus = -1;
+    }
+    else
+    {
+        pPlaintextTransportParams = pNetworkContext->pParams;
+
+        socketStatus = TCP_Sockets_RecvZeroCopy( pPlaintextTransportParams->tcpSocket,
+                                                 ppBuffer,
+                                                 bytesToRecv );
+    }
+
+    return socketStatus;
+}
+
+int32_t Plaintext_FreeRTOS_recvRelease( NetworkContext_t * pNetworkContext,
+                                        size_t bytesToRelease )
+{
+    PlaintextTransportParams_t * pPlaintextTransportParams = NULL;
+    int32_t socketStatus = 0;
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
+        socketStatus = -1;
+    }
+    else if( bytesToRelease > 0U )
+    {
+        pPlaintextTransportParams = pNetworkContext->pParams;
+
+        socketStatus = TCP_Sockets_RecvRelease( pPlaintextTransportParams->tcpSocket,
+                                                bytesToRelease );
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
+    }
+
+    return socketStatus;
+}
+
 int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                                  const void * pBuffer,
                                  size_t bytesToSend )
@@ -181,3 +241,36 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
 
     return socketStatus;
 }
+
+int32_t Plaintext_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                                   TransportOutVector_t * pIoVec,
+                                   size_t ioVecCount )
+{
+    PlaintextTransportParams_t * pPlaintextTransportParams = NULL;
+    int32_t socketStatus = 0;
+
+    if( ( pNetworkContext == NULL ) || ( pNetworkContext->pParams == NULL ) )
+    {
+        LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
+        socketStatus = -1;
+    }
+    else if( pIoVec == NULL )
+    {
+        LogError( ( "invalid input, pIoVec == NULL" ) );
+        socketStatus = -1;
+    }
+    else if( ioVecCount == 0 )
+    {
+        LogError( ( "invalid input, ioVecCount == 0" ) );
+        socketStatus = -1;
+    }
+    else
+    {
+        pPlaintextTransportParams = pNetworkContext->pParams;
+        socketStatus = TCP_Sockets_SendVector( pPlaintextTransportParams->tcpSocket,
+                                               pIoVec,
+                                               ioVecCount );
+    }
+
+    return socketStatus;
+}
@@ -135,6 +135,38 @@ int32_t Plaintext_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
                                  void * pBuffer,
                                  size_t bytesToRecv );
 
+/**
+ * @brief Receives data from an established TCP connection without copying it.
+ *
+ * Points @p ppBuffer at received data held by the socket, for a caller that
+ * can parse it in place.  The data is returned again by the next receive until
+ * it is released with #Plaintext_FreeRTOS_recvRelease.
+ *
+ * @param[in] pNetworkContext The network context containing the TCP socket
+ * handle.
+ * @param[out] ppBuffer Set to point at the received bytes.
+ * @param[in] bytesToRecv Maximum number of bytes to return.
+ *
+ * @return Number of bytes at @p ppBuffer if successful; 0 if the socket times
+ * out; Negative value on error, including if the sockets port cannot receive
+ * without copying.
+ */
+int32_t Plaintext_FreeRTOS_recvZeroCopy( NetworkContext_t * pNetworkContext,
+                                         const void ** ppBuffer,
+                                         size_t bytesToRecv );
+
+/**
+ * @brief Releases data returned by #Plaintext_FreeRTOS_recvZeroCopy.
+ *
+ * @param[in] pNetworkContext The network context containing the TCP socket
+ * handle.
+ * @param[in] bytesToRelease Number of bytes consumed by the caller.
+ *
+ * @return Number of bytes released on success; else a negative value.
+ */
+int32_t Plaintext_FreeRTOS_recvRelease( NetworkContext_t * pNetworkContext,
+                                        size_t bytesToRelease );
+
 /**
  * @brief Sends data over an established TCP connection.
  *
@@ -149,4 +181,19 @@ int32_t Plaintext_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                                  const void * pBuffer,
                                  size_t bytesToSend );
 
+/**
+ * @brief Sends the data of several buffers over an established TCP connection.
+ *
+ * @param[in] pNetworkContext The network context containing the TCP socket
+ * handle.
+ * @param[in] pIoVec Array of buffers to send, in order.
+ * @param[in] ioVecCount Number of buffers in @p pIoVec.
+ *
+ * @return Number of bytes sent on success, which may be fewer than the total
+ * length of the buffers; else a negative value.
+ */
+int32_t Plaintext_FreeRTOS_writev( NetworkContext_t * pNetworkContext,
+                                   TransportOutVector_t * pIoVec,
+                                   size_t ioVecCount );
+
 #endif /* ifndef USING_PLAINTEXT_H */
@@ -0,0 +1,238 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_stats.c
+ * @brief Keeps the list of open connections whose statistics the
+ * "tls-stats" FreeRTOS+CLI command prints.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Transport statistics include. */
+#include "transport_stats.h"
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+    #if ( TLS_TRANSPORT_STATS_CLI > 0 )
+        #include "FreeRTOS_CLI.h"
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Statistics of the open connections.  Empty slots are NULL.
+ */
+    static const TlsTransportStats_t * trackedStats[ TLS_TRANSPORT_STATS_MAX_CONNECTIONS ] = { NULL };
+
+    #if ( TLS_TRANSPORT_STATS_CLI > 0 )
+
+/**
+ * @brief Implements the "tls-stats" command, printing one connection per
+ * call.
+ *
+ * @param[out] pcWriteBuffer Buffer for the output.
+ * @param[in] xWriteBufferLen Length of pcWriteBuffer.
+ * @param[in] pcCommandString Unused.
+ *
+ * @return pdTRUE while there are more connections to print.
+ */
+        static BaseType_t statsCommand( char * pcWriteBuffer,
+                                        size_t xWriteBufferLen,
+                                        const char * pcCommandString );
+
+/**
+ * @brief Definition of the "tls-stats" command.
+ */
+        static const CLI_Command_Definition_t statsCommandDefinition =
+        {
+            "tls-stats",
+            "\r\ntls-stats:\r\n Displays the connect timings, in ms, and the traffic of each open TLS connection\r\n",
+            statsCommand,
+            0
+        };
+    #endif /* TLS_TRANSPORT_STATS_CLI > 0 */
+
+/*-----------------------------------------------------------*/
+
+    void TLS_Stats_Reset( TlsTransportStats_t * pStats )
+    {
+        configASSERT( pStats != NULL );
+
+        ( void ) memset( pStats, 0, sizeof( TlsTransportStats_t ) );
+        pStats->phaseStartMs = TLS_TRANSPORT_STATS_TIME_MS();
+    }
+
+/*-----------------------------------------------------------*/
+
+    void TLS_Stats_EndPhase( TlsTransportStats_t * pStats,
+                             uint32_t * pPhaseMs )
+    {
+        uint32_t nowMs = TLS_TRANSPORT_STATS_TIME_MS();
+
+        configASSERT( pStats != NULL );
+        configASSERT( pPhaseMs != NULL );
+
+        *pPhaseMs += nowMs - pStats->phaseStartMs;
+        pStats->phaseStartMs = nowMs;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void TLS_Stats_Track( const TlsTransportStats_t * pStats )
+    {
+        size_t i;
+        size_t freeSlot = ( size_t ) TLS_TRANSPORT_STATS_MAX_CONNECTIONS;
+        BaseType_t isTracked = pdFALSE;
+
+        configASSERT( pStats != NULL );
+
+        taskENTER_CRITICAL();
+        {
+            /* A connection made again without being closed keeps its slot. */
+            for( i = 0U; i < ( size_t ) TLS_TRANSPORT_STATS_MAX_CONNECTIONS; i++ )
+            {
+                if( trackedStats[ i ] == pStats )
+                {
+                    isTracked = pdTRUE;
+                }
+                else if( ( trackedStats[ i ] == NULL ) && ( freeSlot == ( size_t ) TLS_TRANSPORT_STATS_MAX_CONNECTIONS ) )
+                {
+                    freeSlot = i;
+                }
+                else
+                {
+                    /* Empty else for MISRA 15.7 compliance. */
+                }
+            }
+
+            if( ( isTracked == pdFALSE ) && ( freeSlot < ( size_t ) TLS_TRANSPORT_STATS_MAX_CONNECTIONS ) )
+            {
+                trackedStats[ freeSlot ] = pStats;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+/*-----------------------------------------------------------*/
+
+    void TLS_Stats_Untrack( const TlsTransportStats_t * pStats )
+    {
+        size_t i;
+
+        taskENTER_CRITICAL();
+        {
+            for( i = 0U; i < ( size_t ) TLS_TRANSPORT_STATS_MAX_CONNECTIONS; i++ )
+            {
+                if( trackedStats[ i ] == pStats )
+                {
+                    trackedStats[ i ] = NULL;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+/*-----------------------------------------------------------*/
+
+    #if ( TLS_TRANSPORT_STATS_CLI > 0 )
+
+        void TLS_Stats_RegisterCLICommand( void )
+        {
+            ( void ) FreeRTOS_CLIRegisterCommand( &statsCommandDefinition );
+        }
+
+/*-----------------------------------------------------------*/
+
+        static BaseType_t statsCommand( char * pcWriteBuffer,
+                                        size_t xWriteBufferLen,
+                                        const char * pcCommandString )
+        {
+            /* The slot to look at next.  FreeRTOS+CLI calls the command until
+             * it returns pdFALSE. */
+            static size_t nextSlot = 0U;
+            TlsTransportStats_t stats;
+            BaseType_t isFound = pdFALSE;
+            BaseType_t isMore = pdFALSE;
+
+            ( void ) pcCommandString;
+            configASSERT( pcWriteBuffer != NULL );
+
+            pcWriteBuffer[ 0 ] = '\0';
+
+            /* Copy the statistics in a critical section, so that the
+             * connection cannot be closed while they are being read. */
+            while( ( isFound == pdFALSE ) && ( nextSlot < ( size_t ) TLS_TRANSPORT_STATS_MAX_CONNECTIONS ) )
+            {
+                taskENTER_CRITICAL();
+                {
+                    if( trackedStats[ nextSlot ] != NULL )
+                    {
+                        stats = *( trackedStats[ nextSlot ] );
+                        isFound = pdTRUE;
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                nextSlot++;
+            }
+
+            if( isFound == pdTRUE )
+            {
+                ( void ) snprintf( pcWriteBuffer, xWriteBufferLen,
+                                   "%u: tcp %lu setup %lu handshake %lu (cert %lu kex %lu sign %lu) "
+                                   "tx %lu B/%lu rec rx %lu B/%lu rec max rec tx %lu rx %lu\r\n",
+                                   ( unsigned ) ( nextSlot - 1U ),
+                                   ( unsigned long ) stats.tcpConnectMs,
+                                   ( unsigned long ) stats.setupMs,
+                                   ( unsigned long ) stats.handshakeMs,
+                                   ( unsigned long ) stats.serverCertificateMs,
+                                   ( unsigned long ) stats.keyExchangeMs,
+                                   ( unsigned long ) stats.certificateVerifyMs,
+                                   ( unsigned long ) stats.bytesSent,
+                                   ( unsigned long ) stats.recordsSent,
+                                   ( unsigned long ) stats.bytesReceived,
+                                   ( unsigned long ) stats.recordsReceived,
+                                   ( unsigned long ) stats.maxRecordSent,
+                                   ( unsigned long ) stats.maxRecordReceived );
+                isMore = pdTRUE;
+            }
+            else
+            {
+                ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "\r\n" );
+                nextSlot = 0U;
+            }
+
+            return isMore;
+        }
+
+/*-----------------------------------------------------------*/
+
+    #endif /* TLS_TRANSPORT_STATS_CLI > 0 */
+
+#endif /* TLS_TRANSPORT_STATS > 0 */
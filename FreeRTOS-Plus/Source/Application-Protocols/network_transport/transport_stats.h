@@ -0,0 +1,157 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file transport_stats.h
+ * @brief Connection timing and traffic counters shared by the TLS transports.
+ */
+
+#ifndef TRANSPORT_STATS_H
+#define TRANSPORT_STATS_H
+
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief Time the phases of each connection and count its traffic.
+ *
+ * When non-zero, each #TlsTransportParams_t holds a #TlsTransportStats_t
+ * which the TLS transport fills in while connecting, sending and receiving,
+ * and #TLS_FreeRTOS_GetStats reads.  Zero (the default) keeps no statistics.
+ */
+#ifndef TLS_TRANSPORT_STATS
+    #define TLS_TRANSPORT_STATS    0
+#endif
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+/**
+ * @brief Current time, in milliseconds, used to time the phases.
+ *
+ * The default has the resolution of the tick.  Define it to read a faster
+ * timer for finer timings; it only needs to count up and wrap at 2^32.
+ */
+    #ifndef TLS_TRANSPORT_STATS_TIME_MS
+        #define TLS_TRANSPORT_STATS_TIME_MS()    ( ( uint32_t ) pdTICKS_TO_MS( xTaskGetTickCount() ) )
+    #endif
+
+/**
+ * @brief Register a "tls-stats" FreeRTOS+CLI command which prints the
+ * statistics of the open connections.
+ *
+ * Requires FreeRTOS+CLI.  Zero (the default) adds no command.
+ */
+    #ifndef TLS_TRANSPORT_STATS_CLI
+        #define TLS_TRANSPORT_STATS_CLI    0
+    #endif
+
+/**
+ * @brief Number of open connections the "tls-stats" command can list.
+ */
+    #ifndef TLS_TRANSPORT_STATS_MAX_CONNECTIONS
+        #define TLS_TRANSPORT_STATS_MAX_CONNECTIONS    4
+    #endif
+
+/**
+ * @brief Timings and traffic counters of a connection.
+ *
+ * The phases of a connection made with #TLS_FreeRTOS_ConnectStart overlap:
+ * the TLS setup runs while the TCP connection is being established, and the
+ * TCP time runs until the connection is found to be up.  The handshake times
+ * only include the time spent in the TLS library, so they do not include the
+ * time between two polls.  The handshake steps, which include waiting for the
+ * server's messages, are only timed by the mbedTLS transports; the wolfSSL
+ * transport reports them as zero.  The record sizes are only reported by
+ * transport_mbedtls.c.
+ */
+    typedef struct TlsTransportStats
+    {
+        uint32_t tcpConnectMs;         /**< @brief Resolving the server's name and connecting over TCP. */
+        uint32_t setupMs;              /**< @brief Configuring TLS and loading and parsing the certificates and keys. */
+        uint32_t handshakeMs;          /**< @brief The TLS handshake in total. */
+        uint32_t serverCertificateMs;  /**< @brief Receiving and verifying the server's certificate chain. */
+        uint32_t keyExchangeMs;        /**< @brief The key exchange, including ECDHE and checking the server's signature. */
+        uint32_t certificateVerifyMs;  /**< @brief Signing the client's CertificateVerify message with the private key. */
+        uint32_t bytesSent;            /**< @brief Application bytes sent. */
+        uint32_t bytesReceived;        /**< @brief Application bytes received. */
+        uint32_t recordsSent;          /**< @brief Application data records sent. */
+        uint32_t recordsReceived;      /**< @brief Application data records received in full. */
+        uint32_t maxRecordSent;        /**< @brief Largest record payload the connection sends, after any maximum fragment length negotiation. */
+        uint32_t maxRecordReceived;    /**< @brief Largest record payload the connection accepts, after any maximum fragment length negotiation. */
+        uint32_t phaseStartMs;         /**< @brief Internal: when the current phase began. */
+    } TlsTransportStats_t;
+
+/**
+ * @brief Zero the statistics of a connection and start timing its first
+ * phase.
+ *
+ * @param[out] pStats Statistics of the connection.
+ */
+    void TLS_Stats_Reset( TlsTransportStats_t * pStats );
+
+/**
+ * @brief Add the time since the current phase began to a phase of a
+ * connection, and start timing the next phase.
+ *
+ * @param[in,out] pStats Statistics of the connection.
+ * @param[in,out] pPhaseMs The member of @p pStats timing the phase which
+ * ended.
+ */
+    void TLS_Stats_EndPhase( TlsTransportStats_t * pStats,
+                             uint32_t * pPhaseMs );
+
+/**
+ * @brief List the statistics of a connection in the "tls-stats" command.
+ *
+ * The TLS transports call this once a connection is established.
+ *
+ * @param[in] pStats Statistics of the connection.
+ */
+    void TLS_Stats_Track( const TlsTransportStats_t * pStats );
+
+/**
+ * @brief Stop listing the statistics of a connection.
+ *
+ * The TLS transports call this when a connection is closed.
+ *
+ * @param[in] pStats Statistics of the connection.
+ */
+    void TLS_Stats_Untrack( const TlsTransportStats_t * pStats );
+
+    #if ( TLS_TRANSPORT_STATS_CLI > 0 )
+
+/**
+ * @brief Register the "tls-stats" command with FreeRTOS+CLI.
+ */
+        void TLS_Stats_RegisterCLICommand( void );
+    #endif
+
+#endif /* TLS_TRANSPORT_STATS > 0 */
+
+#endif /* ifndef TRANSPORT_STATS_H */
@@ -46,6 +46,11 @@
 /* FreeRTOS Socket wrapper include. */
 #include "tcp_sockets_wrapper.h"
 
+#if ( TLS_TRANSPORT_CRYPTO_ACCEL > 0 )
+    /* Hardware crypto accelerator include. */
+    #include "crypto_accel.h"
+#endif
+
 /* wolfSSL user settings header */
 #include "user_settings.h"
 
@@ -67,19 +72,36 @@ static void sslContextInit( SSLContext_t * pSslContext );
 static void sslContextFree( SSLContext_t * pSslContext );
 
 /**
- * @brief Set up TLS on a TCP connection.
+ * @brief Set up the wolfSSL objects of a TCP connection.
  *
  * @param[in] pNetworkContext Network context.
  * @param[in] pHostName Remote host name, used for server name indication.
  * @param[in] pNetworkCredentials TLS setup parameters.
  *
- * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INSUFFICIENT_MEMORY, #TLS_TRANSPORT_INVALID_CREDENTIALS,
- * #TLS_TRANSPORT_HANDSHAKE_FAILED, or #TLS_TRANSPORT_INTERNAL_ERROR.
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_INVALID_CREDENTIALS,
+ * #TLS_TRANSPORT_INTERNAL_ERROR, or #TLS_TRANSPORT_CONNECT_FAILURE.
  */
 static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetworkContext,
                                       const char * pHostName,
                                       const NetworkCredentials_t * pNetworkCredentials );
 
+/**
+ * @brief Advance the TLS handshake on a connection set up by #tlsSetup.
+ *
+ * @param[in] pNetworkContext Network context.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS, #TLS_TRANSPORT_IN_PROGRESS if the socket
+ * would block, or #TLS_TRANSPORT_HANDSHAKE_FAILED.
+ */
+static TlsTransportStatus_t tlsHandshakeStep( NetworkContext_t * pNetworkContext );
+
+/**
+ * @brief Free the wolfSSL objects of a connection which is not established.
+ *
+ * @param[in] pNetworkContext Network context.
+ */
+static void tlsContextFree( NetworkContext_t * pNetworkContext );
+
 /**
  * @brief  Initialize TLS component.
  *
@@ -95,7 +117,8 @@ static TlsTransportStatus_t initTLS( void );
  *  @param[in] sz  Size to receive
  *  @param[in] context Socket to be received from
  *
- *  @return received size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_READ.
+ *  @return received size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_READ,
+ *  #WOLFSSL_CBIO_ERR_ISR, or #WOLFSSL_CBIO_ERR_GENERAL.
  */
 static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
                                char * buf,
@@ -110,7 +133,8 @@ static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
  *  @param[in] sz  Size to send
  *  @param[in] context Socket to be sent to
  *
- *  @return received size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_WRITE.
+ *  @return sent size( > 0 ), #WOLFSSL_CBIO_ERR_CONN_CLOSE, #WOLFSSL_CBIO_ERR_WANT_WRITE,
+ *  #WOLFSSL_CBIO_ERR_ISR, or #WOLFSSL_CBIO_ERR_GENERAL.
  */
 static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
                                char * buf,
@@ -142,15 +166,25 @@ static int wolfSSL_IORecvGlue( WOLFSSL * ssl,
 
     read = TCP_Sockets_Recv( xSocket, ( void * ) buf, ( size_t ) sz );
 
+    /* With a zero timeout, no data means the socket would block. */
     if( ( read == 0 ) ||
         ( read == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) )
     {
         read = WOLFSSL_CBIO_ERR_WANT_READ;
     }
-    else if( read == TCP_SOCKETS_ERRNO_ENOTCONN )
+    else if( ( read == TCP_SOCKETS_ERRNO_ENOTCONN ) ||
+             ( read == TCP_SOCKETS_ERRNO_ECLOSED ) )
     {
         read = WOLFSSL_CBIO_ERR_CONN_CLOSE;
     }
+    else if( read == TCP_SOCKETS_ERRNO_EINTR )
+    {
+        read = WOLFSSL_CBIO_ERR_ISR;
+    }
+    else if( read < 0 )
+    {
+        read = WOLFSSL_CBIO_ERR_GENERAL;
+    }
     else
     {
         /* do nothing */
@@ -169,14 +203,27 @@ static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
     Socket_t xSocket = ( Socket_t ) context;
     BaseType_t sent = TCP_Sockets_Send( xSocket, ( void * ) buf, ( size_t ) sz );
 
-    if( sent == TCP_SOCKETS_ERRNO_EWOULDBLOCK )
+    /* A full socket means it would block; wolfSSL sends the rest of the
+     * record on the next call. */
+    if( ( sent == 0 ) ||
+        ( sent == TCP_SOCKETS_ERRNO_EWOULDBLOCK ) ||
+        ( sent == TCP_SOCKETS_ERRNO_ENOSPC ) )
     {
         sent = WOLFSSL_CBIO_ERR_WANT_WRITE;
     }
-    else if( sent == TCP_SOCKETS_ERRNO_ENOTCONN )
+    else if( ( sent == TCP_SOCKETS_ERRNO_ENOTCONN ) ||
+             ( sent == TCP_SOCKETS_ERRNO_ECLOSED ) )
     {
         sent = WOLFSSL_CBIO_ERR_CONN_CLOSE;
     }
+    else if( sent == TCP_SOCKETS_ERRNO_EINTR )
+    {
+        sent = WOLFSSL_CBIO_ERR_ISR;
+    }
+    else if( sent < 0 )
+    {
+        sent = WOLFSSL_CBIO_ERR_GENERAL;
+    }
     else
     {
         /* do nothing */
@@ -188,6 +235,8 @@ static int wolfSSL_IOSendGlue( WOLFSSL * ssl,
 /*-----------------------------------------------------------*/
 static TlsTransportStatus_t initTLS( void )
 {
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+
     /* initialize wolfSSL */
     wolfSSL_Init();
 
@@ -195,7 +244,16 @@ static TlsTransportStatus_t initTLS( void )
         wolfSSL_Debugging_ON();
     #endif
 
-    return TLS_TRANSPORT_SUCCESS;
+    #if ( TLS_TRANSPORT_CRYPTO_ACCEL > 0 )
+        /* Registering the device again replaces it. */
+        if( CryptoAccel_WolfSSLRegister() != 0 )
+        {
+            LogError( ( "Failed to register the crypto accelerator with wolfSSL" ) );
+            returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+        }
+    #endif
+
+    return returnStatus;
 }
 
 /*-----------------------------------------------------------*/
@@ -298,6 +356,16 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
             wolfSSL_CTX_new( wolfSSLv23_client_method_ex( NULL ) );
     }
 
+    #if ( TLS_TRANSPORT_CRYPTO_ACCEL > 0 )
+        if( ( pNetCtx->sslContext.ctx != NULL ) &&
+            ( wolfSSL_CTX_SetDevId( pNetCtx->sslContext.ctx,
+                                    CRYPTO_ACCEL_WOLFSSL_DEVICE_ID ) != WOLFSSL_SUCCESS ) )
+        {
+            /* The connection still works, in software. */
+            LogWarn( ( "Failed to select the crypto accelerator" ) );
+        }
+    #endif
+
     if( pNetCtx->sslContext.ctx != NULL )
     {
         /* load credentials from file */
@@ -321,23 +389,7 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
                 wolfSSL_SetIOReadCtx( pNetCtx->sslContext.ssl, xSocket );
                 wolfSSL_SetIOWriteCtx( pNetCtx->sslContext.ssl, xSocket );
 
-                /* let wolfSSL perform tls handshake */
-                if( wolfSSL_connect( pNetCtx->sslContext.ssl )
-                    == SSL_SUCCESS )
-                {
-                    returnStatus = TLS_TRANSPORT_SUCCESS;
-                }
-                else
-                {
-                    wolfSSL_shutdown( pNetCtx->sslContext.ssl );
-                    wolfSSL_free( pNetCtx->sslContext.ssl );
-                    pNetCtx->sslContext.ssl = NULL;
-                    wolfSSL_CTX_free( pNetCtx->sslContext.ctx );
-                    pNetCtx->sslContext.ctx = NULL;
-
-                    LogError( ( "Failed to establish a TLS connection" ) );
-                    returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
-                }
+                returnStatus = TLS_TRANSPORT_SUCCESS;
             }
             else
             {
@@ -368,6 +420,60 @@ static TlsTransportStatus_t tlsSetup( NetworkContext_t * pNetCtx,
 
 /*-----------------------------------------------------------*/
 
+static TlsTransportStatus_t tlsHandshakeStep( NetworkContext_t * pNetCtx )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    int connectResult = 0;
+    int sslError = 0;
+
+    configASSERT( pNetCtx != NULL );
+    configASSERT( pNetCtx->sslContext.ssl != NULL );
+
+    /* let wolfSSL perform tls handshake, as far as the socket allows */
+    connectResult = wolfSSL_connect( pNetCtx->sslContext.ssl );
+
+    if( connectResult == SSL_SUCCESS )
+    {
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_EndPhase( &( pNetCtx->stats ),
+                                &( pNetCtx->stats.handshakeMs ) );
+        #endif
+
+        LogInfo( ( "(Network connection %p) TLS handshake successful.",
+                   pNetCtx ) );
+        returnStatus = TLS_TRANSPORT_SUCCESS;
+    }
+    else
+    {
+        sslError = wolfSSL_get_error( pNetCtx->sslContext.ssl, connectResult );
+
+        if( ( sslError == WOLFSSL_ERROR_WANT_READ ) ||
+            ( sslError == WOLFSSL_ERROR_WANT_WRITE ) )
+        {
+            returnStatus = TLS_TRANSPORT_IN_PROGRESS;
+        }
+        else
+        {
+            LogError( ( "Failed to establish a TLS connection %d : %s",
+                        sslError, wolfSSL_ERR_reason_error_string( sslError ) ) );
+            returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
+        }
+    }
+
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void tlsContextFree( NetworkContext_t * pNetCtx )
+{
+    configASSERT( pNetCtx != NULL );
+
+    wolfSSL_free( pNetCtx->sslContext.ssl );
+    pNetCtx->sslContext.ssl = NULL;
+    wolfSSL_CTX_free( pNetCtx->sslContext.ctx );
+    pNetCtx->sslContext.ctx = NULL;
+}
 
 /*-----------------------------------------------------------*/
 
@@ -380,7 +486,7 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
 {
     TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
     BaseType_t socketStatus = 0;
-    BaseType_t isSocketConnected = pdFALSE;
+    BaseType_t isSocketConnected = pdFALSE, isTlsSetup = pdFALSE;
 
     if( ( pNetworkContext == NULL ) ||
         ( pHostName == NULL ) ||
@@ -403,6 +509,14 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
         pNetworkContext->tcpSocket = NULL;
+        pNetworkContext->connectState = TLS_CONNECT_STATE_IDLE;
+        pNetworkContext->pHostName = pHostName;
+        pNetworkContext->receiveTimeoutMs = receiveTimeoutMs;
+        pNetworkContext->sendTimeoutMs = sendTimeoutMs;
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Reset( &( pNetworkContext->stats ) );
+        #endif
 
         socketStatus = TCP_Sockets_Connect( &( pNetworkContext->tcpSocket ),
                                             pHostName,
@@ -424,18 +538,48 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
     {
         isSocketConnected = pdTRUE;
 
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_EndPhase( &( pNetworkContext->stats ),
+                                &( pNetworkContext->stats.tcpConnectMs ) );
+        #endif
+
         returnStatus = initTLS();
     }
 
-    /* Perform TLS handshake. */
+    /* Set up TLS. */
     if( returnStatus == TLS_TRANSPORT_SUCCESS )
     {
         returnStatus = tlsSetup( pNetworkContext, pHostName, pNetworkCredentials );
     }
 
+    /* Perform TLS handshake. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        isTlsSetup = pdTRUE;
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_EndPhase( &( pNetworkContext->stats ),
+                                &( pNetworkContext->stats.setupMs ) );
+        #endif
+
+        returnStatus = tlsHandshakeStep( pNetworkContext );
+
+        if( returnStatus == TLS_TRANSPORT_IN_PROGRESS )
+        {
+            /* The socket timed out during the handshake. */
+            LogError( ( "Failed to establish a TLS connection: timed out." ) );
+            returnStatus = TLS_TRANSPORT_HANDSHAKE_FAILED;
+        }
+    }
+
     /* Clean up on failure. */
     if( returnStatus != TLS_TRANSPORT_SUCCESS )
     {
+        if( isTlsSetup == pdTRUE )
+        {
+            tlsContextFree( pNetworkContext );
+        }
+
         if( isSocketConnected == pdTRUE )
         {
             TCP_Sockets_Disconnect( pNetworkContext->tcpSocket );
@@ -447,6 +591,212 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
         LogInfo( ( "(Network connection %p) Connection to %s established.",
                    pNetworkContext,
                    pHostName ) );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Track( &( pNetworkContext->stats ) );
+        #endif
+    }
+
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_ConnectStart( NetworkContext_t * pNetworkContext,
+                                                const char * pHostName,
+                                                uint16_t port,
+                                                const NetworkCredentials_t * pNetworkCredentials,
+                                                uint32_t receiveTimeoutMs,
+                                                uint32_t sendTimeoutMs )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    BaseType_t socketStatus = 0;
+    BaseType_t isSocketConnected = pdFALSE;
+
+    if( ( pNetworkContext == NULL ) ||
+        ( pHostName == NULL ) ||
+        ( pNetworkCredentials == NULL ) )
+    {
+        LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. pNetworkContext=%p, "
+                    "pHostName=%p, pNetworkCredentials=%p.",
+                    pNetworkContext,
+                    pHostName,
+                    pNetworkCredentials ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( ( pNetworkCredentials->pRootCa == NULL ) )
+    {
+        LogError( ( "pRootCa cannot be NULL." ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+
+    /* Begin a TCP connection with the server. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        pNetworkContext->tcpSocket = NULL;
+        pNetworkContext->connectState = TLS_CONNECT_STATE_IDLE;
+        pNetworkContext->pHostName = pHostName;
+        pNetworkContext->receiveTimeoutMs = receiveTimeoutMs;
+        pNetworkContext->sendTimeoutMs = sendTimeoutMs;
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Reset( &( pNetworkContext->stats ) );
+        #endif
+
+        socketStatus = TCP_Sockets_ConnectStart( &( pNetworkContext->tcpSocket ),
+                                                 pHostName,
+                                                 port );
+
+        if( socketStatus != 0 )
+        {
+            LogError( ( "Failed to begin connecting to %s with error %d.",
+                        pHostName,
+                        socketStatus ) );
+            returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+        }
+    }
+
+    /* Initialize tls. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        isSocketConnected = pdTRUE;
+
+        returnStatus = initTLS();
+    }
+
+    /* Set up TLS while the TCP connection is being established. */
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            /* The TCP connection stays the current phase, so time the setup
+             * separately. */
+            uint32_t setupStartMs = TLS_TRANSPORT_STATS_TIME_MS();
+        #endif
+
+        returnStatus = tlsSetup( pNetworkContext, pHostName, pNetworkCredentials );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            pNetworkContext->stats.setupMs = TLS_TRANSPORT_STATS_TIME_MS() - setupStartMs;
+        #endif
+    }
+
+    if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        pNetworkContext->connectState = TLS_CONNECT_STATE_TCP_CONNECTING;
+        returnStatus = TLS_TRANSPORT_IN_PROGRESS;
+    }
+    else if( isSocketConnected == pdTRUE )
+    {
+        /* tlsSetup frees the wolfSSL objects itself when it fails. */
+        TCP_Sockets_Disconnect( pNetworkContext->tcpSocket );
+        pNetworkContext->tcpSocket = NULL;
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
+    }
+
+    return returnStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+TlsTransportStatus_t TLS_FreeRTOS_ConnectPoll( NetworkContext_t * pNetworkContext )
+{
+    TlsTransportStatus_t returnStatus = TLS_TRANSPORT_SUCCESS;
+    BaseType_t socketStatus = 0;
+
+    if( pNetworkContext == NULL )
+    {
+        LogError( ( "Invalid input parameter(s): Arguments cannot be NULL. pNetworkContext=%p.",
+                    pNetworkContext ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else if( pNetworkContext->connectState == TLS_CONNECT_STATE_IDLE )
+    {
+        LogError( ( "(Network connection %p) No connection is in progress.",
+                    pNetworkContext ) );
+        returnStatus = TLS_TRANSPORT_INVALID_PARAMETER;
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
+    }
+
+    if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) &&
+        ( pNetworkContext->connectState == TLS_CONNECT_STATE_TCP_CONNECTING ) )
+    {
+        socketStatus = TCP_Sockets_ConnectPoll( pNetworkContext->tcpSocket );
+
+        if( socketStatus == TCP_SOCKETS_ERRNO_EWOULDBLOCK )
+        {
+            returnStatus = TLS_TRANSPORT_IN_PROGRESS;
+        }
+        else if( socketStatus != TCP_SOCKETS_ERRNO_NONE )
+        {
+            LogError( ( "Failed to connect to %s with error %d.",
+                        pNetworkContext->pHostName,
+                        socketStatus ) );
+            returnStatus = TLS_TRANSPORT_CONNECT_FAILURE;
+        }
+        else
+        {
+            #if ( TLS_TRANSPORT_STATS > 0 )
+                TLS_Stats_EndPhase( &( pNetworkContext->stats ),
+                                    &( pNetworkContext->stats.tcpConnectMs ) );
+            #endif
+
+            pNetworkContext->connectState = TLS_CONNECT_STATE_HANDSHAKING;
+        }
+    }
+
+    /* Send the first handshake message as soon as the TCP connection is up,
+     * rather than on the next poll. */
+    if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) &&
+        ( pNetworkContext->connectState == TLS_CONNECT_STATE_HANDSHAKING ) )
+    {
+        returnStatus = tlsHandshakeStep( pNetworkContext );
+    }
+
+    if( ( returnStatus == TLS_TRANSPORT_SUCCESS ) &&
+        ( pNetworkContext->connectState == TLS_CONNECT_STATE_HANDSHAKING ) )
+    {
+        socketStatus = TCP_Sockets_SetTimeouts( pNetworkContext->tcpSocket,
+                                                pNetworkContext->receiveTimeoutMs,
+                                                pNetworkContext->sendTimeoutMs );
+
+        if( socketStatus != TCP_SOCKETS_ERRNO_NONE )
+        {
+            LogError( ( "Failed to set the socket timeouts with error %d.",
+                        socketStatus ) );
+            returnStatus = TLS_TRANSPORT_INTERNAL_ERROR;
+        }
+    }
+
+    if( ( returnStatus == TLS_TRANSPORT_IN_PROGRESS ) ||
+        ( returnStatus == TLS_TRANSPORT_INVALID_PARAMETER ) )
+    {
+        /* The connection is still being established, or there is none. */
+    }
+    else if( returnStatus == TLS_TRANSPORT_SUCCESS )
+    {
+        pNetworkContext->connectState = TLS_CONNECT_STATE_IDLE;
+
+        LogInfo( ( "(Network connection %p) Connection to %s established.",
+                   pNetworkContext,
+                   pNetworkContext->pHostName ) );
+
+        #if ( TLS_TRANSPORT_STATS > 0 )
+            TLS_Stats_Track( &( pNetworkContext->stats ) );
+        #endif
+    }
+    else
+    {
+        /* Clean up on failure. */
+        tlsContextFree( pNetworkContext );
+        TCP_Sockets_Disconnect( pNetworkContext->tcpSocket );
+        pNetworkContext->tcpSocket = NULL;
+        pNetworkContext->connectState = TLS_CONNECT_STATE_IDLE;
     }
 
     return returnStatus;
@@ -454,13 +804,65 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
 
 /*-----------------------------------------------------------*/
 
+uint32_t TLS_FreeRTOS_PollEvents( const NetworkContext_t * pNetworkContext )
+{
+    uint32_t events = 0U;
+    WOLFSSL * pSsl = NULL;
+
+    configASSERT( pNetworkContext != NULL );
+
+    pSsl = pNetworkContext->sslContext.ssl;
+
+    if( pNetworkContext->connectState == TLS_CONNECT_STATE_TCP_CONNECTING )
+    {
+        /* The socket becomes writable once it is connected. */
+        events = TLS_TRANSPORT_EVENT_WANT_WRITE;
+    }
+    else if( pSsl != NULL )
+    {
+        if( wolfSSL_pending( pSsl ) > 0 )
+        {
+            events |= TLS_TRANSPORT_EVENT_READ_PENDING;
+        }
+
+        if( wolfSSL_want_read( pSsl ) == 1 )
+        {
+            events |= TLS_TRANSPORT_EVENT_WANT_READ;
+        }
+
+        if( wolfSSL_want_write( pSsl ) == 1 )
+        {
+            events |= TLS_TRANSPORT_EVENT_WANT_WRITE;
+        }
+    }
+    else
+    {
+        /* Empty else for MISRA 15.7 compliance. */
+    }
+
+    return events;
+}
+
+/*-----------------------------------------------------------*/
+
 void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
 {
     WOLFSSL * pSsl = pNetworkContext->sslContext.ssl;
     WOLFSSL_CTX * pCtx = NULL;
 
-    /* shutdown an active TLS connection */
-    wolfSSL_shutdown( pSsl );
+    if( pNetworkContext->connectState != TLS_CONNECT_STATE_IDLE )
+    {
+        /* Abandon a connection begun by TLS_FreeRTOS_ConnectStart; there is
+         * no TLS session to close. */
+        LogInfo( ( "(Network connection %p) Connection in progress abandoned.",
+                   pNetworkContext ) );
+        pNetworkContext->connectState = TLS_CONNECT_STATE_IDLE;
+    }
+    else
+    {
+        /* shutdown an active TLS connection */
+        wolfSSL_shutdown( pSsl );
+    }
 
     /* cleanup WOLFSSL object */
     wolfSSL_free( pSsl );
@@ -475,6 +877,10 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext )
     wolfSSL_CTX_free( pCtx );
     pNetworkContext->sslContext.ctx = NULL;
 
+    #if ( TLS_TRANSPORT_STATS > 0 )
+        TLS_Stats_Untrack( &( pNetworkContext->stats ) );
+    #endif
+
     wolfSSL_Cleanup();
 }
 
@@ -512,9 +918,22 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
         if( iResult > 0 )
         {
             tlsStatus = iResult;
+
+            #if ( TLS_TRANSPORT_STATS > 0 )
+                pNetworkContext->stats.bytesReceived += ( uint32_t ) iResult;
+
+                /* A record is counted once it has been read in full. */
+                if( wolfSSL_pending( pSsl ) == 0 )
+                {
+                    pNetworkContext->stats.recordsReceived++;
+                }
+            #endif
         }
-        else if( wolfSSL_want_read( pSsl ) == 1 )
+        else if( ( wolfSSL_want_read( pSsl ) == 1 ) ||
+                 ( wolfSSL_want_write( pSsl ) == 1 ) )
         {
+            /* The socket would block; TLS_FreeRTOS_PollEvents tells on
+             * which direction. */
             tlsStatus = 0;
         }
         else
@@ -538,6 +957,10 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     int iResult = 0;
     WOLFSSL * pSsl = NULL;
 
+    #if ( TLS_TRANSPORT_STATS > 0 )
+        int maxRecordSize = 0;
+    #endif
+
     if( ( pNetworkContext == NULL ) || ( pNetworkContext->sslContext.ssl == NULL ) )
     {
         LogError( ( "invalid input, pNetworkContext=%p", pNetworkContext ) );
@@ -562,9 +985,22 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
         if( iResult > 0 )
         {
             tlsStatus = iResult;
+
+            #if ( TLS_TRANSPORT_STATS > 0 )
+                /* wolfSSL_write splits the data into as many records as it
+                 * needs. */
+                maxRecordSize = wolfSSL_GetMaxOutputSize( pSsl );
+
+                pNetworkContext->stats.bytesSent += ( uint32_t ) iResult;
+                pNetworkContext->stats.recordsSent += ( maxRecordSize > 0 ) ?
+                                                      ( uint32_t ) ( ( iResult + maxRecordSize - 1 ) / maxRecordSize ) : 1U;
+            #endif
         }
-        else if( wolfSSL_want_write( pSsl ) == 1 )
+        else if( ( wolfSSL_want_read( pSsl ) == 1 ) ||
+                 ( wolfSSL_want_write( pSsl ) == 1 ) )
         {
+            /* The socket would block; TLS_FreeRTOS_PollEvents tells on
+             * which direction. */
             tlsStatus = 0;
         }
         else
@@ -578,3 +1014,22 @@ int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
     return tlsStatus;
 }
 /*-----------------------------------------------------------*/
+
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats )
+    {
+        configASSERT( pNetworkContext != NULL );
+        configASSERT( pStats != NULL );
+
+        vTaskSuspendAll();
+        {
+            *pStats = pNetworkContext->stats;
+        }
+        ( void ) xTaskResumeAll();
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( TLS_TRANSPORT_STATS > 0 ) */
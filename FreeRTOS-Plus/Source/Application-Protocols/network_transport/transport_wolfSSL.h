@@ -63,9 +63,25 @@
 /* Transport interface include. */
 #include "transport_interface.h"
 
+/* Transport statistics include. */
+#include "transport_stats.h"
+
 /* wolfSSL interface include. */
 #include "wolfssl/ssl.h"
 
+/**
+ * @brief Set to 1 to offload AES-GCM and ECC P-256 to the hardware crypto
+ * accelerator registered by crypto_accel/crypto_accel_wolfssl.c.
+ *
+ * The application calls CryptoAccel_Init() with the operations of its port
+ * before the first connection; the transport then registers the wolfSSL
+ * crypto callback device and selects it for its contexts.  Requires
+ * WOLF_CRYPTO_CB.  Zero (the default) keeps all cryptography in software.
+ */
+#ifndef TLS_TRANSPORT_CRYPTO_ACCEL
+    #define TLS_TRANSPORT_CRYPTO_ACCEL    0
+#endif
+
 /**
  * @brief Secured connection context.
  */
@@ -75,6 +91,33 @@ typedef struct SSLContext
     WOLFSSL * ssl;     /**< @brief wolfSSL ssl session context */
 } SSLContext_t;
 
+/**
+ * @brief Progress of a connection begun by #TLS_FreeRTOS_ConnectStart.
+ */
+typedef enum TlsConnectState
+{
+    TLS_CONNECT_STATE_IDLE = 0,       /**< No connection is being established. */
+    TLS_CONNECT_STATE_TCP_CONNECTING, /**< Waiting for the TCP connection. */
+    TLS_CONNECT_STATE_HANDSHAKING     /**< Performing the TLS handshake. */
+} TlsConnectState_t;
+
+/**
+ * @brief The TLS connection has decrypted data which can be read at once.
+ */
+#define TLS_TRANSPORT_EVENT_READ_PENDING    ( 1U << 0 )
+
+/**
+ * @brief The last call stopped because the socket had no data to receive;
+ * call again once it has.
+ */
+#define TLS_TRANSPORT_EVENT_WANT_READ       ( 1U << 1 )
+
+/**
+ * @brief The last call stopped because the socket could not take more data;
+ * call again, with the same data, once it can.
+ */
+#define TLS_TRANSPORT_EVENT_WANT_WRITE      ( 1U << 2 )
+
 /**
  * @brief Definition of the network context for the transport interface
  * implementation that uses mbedTLS and FreeRTOS+TLS sockets.
@@ -83,6 +126,13 @@ struct NetworkContext
 {
     Socket_t tcpSocket;
     SSLContext_t sslContext;
+    TlsConnectState_t connectState; /**< @brief Progress of a connection begun by #TLS_FreeRTOS_ConnectStart. */
+    const char * pHostName;         /**< @brief Host name of the server while connecting. */
+    uint32_t receiveTimeoutMs;      /**< @brief Receive timeout to set once connected. */
+    uint32_t sendTimeoutMs;         /**< @brief Send timeout to set once connected. */
+    #if ( TLS_TRANSPORT_STATS > 0 )
+        TlsTransportStats_t stats; /**< @brief Timings and traffic of the connection. */
+    #endif
 };
 
 /**
@@ -129,7 +179,8 @@ typedef enum TlsTransportStatus
     TLS_TRANSPORT_INVALID_CREDENTIALS, /**< Provided credentials were invalid. */
     TLS_TRANSPORT_HANDSHAKE_FAILED,    /**< Performing TLS handshake with server failed. */
     TLS_TRANSPORT_INTERNAL_ERROR,      /**< A call to a system API resulted in an internal error. */
-    TLS_TRANSPORT_CONNECT_FAILURE      /**< Initial connection to the server failed. */
+    TLS_TRANSPORT_CONNECT_FAILURE,     /**< Initial connection to the server failed. */
+    TLS_TRANSPORT_IN_PROGRESS          /**< The connection is still being established. */
 } TlsTransportStatus_t;
 
 /**
@@ -153,6 +204,71 @@ TlsTransportStatus_t TLS_FreeRTOS_Connect( NetworkContext_t * pNetworkContext,
                                            uint32_t receiveTimeoutMs,
                                            uint32_t sendTimeoutMs );
 
+/**
+ * @brief Begin a TLS connection with FreeRTOS sockets, without waiting for it.
+ *
+ * The TCP connection is begun and the wolfSSL objects are set up; call
+ * #TLS_FreeRTOS_ConnectPoll to advance the connection and the handshake.
+ * One task can so establish, and with zero timeouts then serve, several
+ * connections at once.  @p pHostName must remain valid until the connection
+ * is established or has failed.
+ *
+ * @note The DNS lookup of @p pHostName may still block.
+ *
+ * @param[out] pNetworkContext Pointer to a network context to contain the
+ * initialized socket handle.
+ * @param[in] pHostName The hostname of the remote endpoint.
+ * @param[in] port The destination port.
+ * @param[in] pNetworkCredentials Credentials for the TLS connection.
+ * @param[in] receiveTimeoutMs Receive socket timeout, once connected; zero
+ * for #TLS_FreeRTOS_recv to return at once when no data has arrived.
+ * @param[in] sendTimeoutMs Send socket timeout, once connected; zero for
+ * #TLS_FreeRTOS_send to return at once when the socket is full.
+ *
+ * @return #TLS_TRANSPORT_IN_PROGRESS, #TLS_TRANSPORT_INVALID_PARAMETER,
+ * #TLS_TRANSPORT_INVALID_CREDENTIALS, #TLS_TRANSPORT_INTERNAL_ERROR, or
+ * #TLS_TRANSPORT_CONNECT_FAILURE.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_ConnectStart( NetworkContext_t * pNetworkContext,
+                                                const char * pHostName,
+                                                uint16_t port,
+                                                const NetworkCredentials_t * pNetworkCredentials,
+                                                uint32_t receiveTimeoutMs,
+                                                uint32_t sendTimeoutMs );
+
+/**
+ * @brief Advance a connection begun by #TLS_FreeRTOS_ConnectStart, without
+ * blocking.
+ *
+ * Call this again, when #TLS_FreeRTOS_PollEvents reports the socket is wanted
+ * or after a short delay, while it returns #TLS_TRANSPORT_IN_PROGRESS.  On
+ * failure, the connection is released as by a failed #TLS_FreeRTOS_Connect.
+ * To abandon a connection in progress, call #TLS_FreeRTOS_Disconnect.
+ *
+ * @param[in] pNetworkContext Network context.
+ *
+ * @return #TLS_TRANSPORT_SUCCESS once connected, #TLS_TRANSPORT_IN_PROGRESS,
+ * #TLS_TRANSPORT_INVALID_PARAMETER, #TLS_TRANSPORT_HANDSHAKE_FAILED,
+ * #TLS_TRANSPORT_INTERNAL_ERROR, or #TLS_TRANSPORT_CONNECT_FAILURE.
+ */
+TlsTransportStatus_t TLS_FreeRTOS_ConnectPoll( NetworkContext_t * pNetworkContext );
+
+/**
+ * @brief Tell what a connection is waiting for.
+ *
+ * A task serving several connections with zero timeouts reads each
+ * connection reporting #TLS_TRANSPORT_EVENT_READ_PENDING at once, and waits,
+ * for example with FreeRTOS_select() on the tcpSocket of each, for the
+ * sockets of the others to be readable or writable as they want.
+ *
+ * @param[in] pNetworkContext Network context.
+ *
+ * @return A combination of #TLS_TRANSPORT_EVENT_READ_PENDING,
+ * #TLS_TRANSPORT_EVENT_WANT_READ and #TLS_TRANSPORT_EVENT_WANT_WRITE; zero if
+ * the connection waits for nothing.
+ */
+uint32_t TLS_FreeRTOS_PollEvents( const NetworkContext_t * pNetworkContext );
+
 /**
  * @brief Gracefully disconnect an established TLS connection.
  *
@@ -171,7 +287,8 @@ void TLS_FreeRTOS_Disconnect( NetworkContext_t * pNetworkContext );
  * @param[in] bytesToRecv Number of bytes to receive from the network.
  *
  * @return Number of bytes (> 0) received if successful;
- * 0 if the socket times out without reading any bytes;
+ * 0 if the socket times out without reading any bytes, which with a zero
+ * timeout means no data has arrived;
  * negative value on error.
  */
 int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
@@ -189,11 +306,28 @@ int32_t TLS_FreeRTOS_recv( NetworkContext_t * pNetworkContext,
  * @param[in] bytesToSend Number of bytes to send from the buffer.
  *
  * @return Number of bytes (> 0) sent on success;
- * 0 if the socket times out without sending any bytes;
+ * 0 if the socket times out without sending any bytes, in which case the
+ * same data must be sent again;
  * else a negative value to represent error.
  */
 int32_t TLS_FreeRTOS_send( NetworkContext_t * pNetworkContext,
                            const void * pBuffer,
                            size_t bytesToSend );
 
+#if ( TLS_TRANSPORT_STATS > 0 )
+
+/**
+ * @brief Get the connect timings and the traffic counters of a connection.
+ *
+ * The statistics cover the connection begun by the last #TLS_FreeRTOS_Connect,
+ * and remain readable after it is closed.  wolfSSL performs the handshake in
+ * one call, so only its total is timed.
+ *
+ * @param[in] pNetworkContext The network context.
+ * @param[out] pStats Populated with the statistics.
+ */
+    void TLS_FreeRTOS_GetStats( const NetworkContext_t * pNetworkContext,
+                                TlsTransportStats_t * pStats );
+#endif
+
 #endif /* ifndef USING_WOLFSSL_H */
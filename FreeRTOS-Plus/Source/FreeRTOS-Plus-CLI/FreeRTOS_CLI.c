@@ -63,11 +63,147 @@ static BaseType_t prvHelpCommand( char * pcWriteBuffer,
                                   size_t xWriteBufferLen,
                                   const char * pcCommandString );
 
+/*
+ * Return the help string of the command *ppxHelpCommand, and move
+ * *ppxHelpCommand on to the next command.  Returns pdFALSE once the help
+ * string of the last command has been returned.
+ */
+static BaseType_t prvWriteNextHelpString( const CLI_Definition_List_Item_t ** ppxHelpCommand,
+                                          char * pcWriteBuffer,
+                                          size_t xWriteBufferLen );
+
+/*
+ * Run the command interpreter for pcCommandInput, keeping the continuation
+ * state in pxSession and writing the output into pcWriteBuffer.
+ */
+static BaseType_t prvProcessCommand( CLI_Session_t * pxSession,
+                                     const char * const pcCommandInput,
+                                     char * pcWriteBuffer,
+                                     size_t xWriteBufferLen );
+
+/*
+ * Return the registered command that pcCommandInput starts with, or NULL if
+ * there is none.
+ */
+static const CLI_Definition_List_Item_t * prvFindCommand( const char * const pcCommandInput );
+
+/*
+ * Return pdTRUE if pcCommandInput has the number of parameters pxCommand
+ * expects, otherwise pdFALSE.  The parameters are recorded in pxSession, if
+ * configCOMMAND_INT_MAX_PARAMETERS is above 0.
+ */
+static BaseType_t prvParametersValid( CLI_Session_t * pxSession,
+                                      const CLI_Definition_List_Item_t * pxCommand,
+                                      const char * const pcCommandInput );
+
+/*
+ * Return the uxWantedParameter'th parameter of pcCommandString, and its length
+ * in *pxParameterStringLength, by scanning the string from the start.
+ */
+static const char * prvScanForParameter( const char * pcCommandString,
+                                         UBaseType_t uxWantedParameter,
+                                         BaseType_t * pxParameterStringLength );
+
+/*
+ * Write the next part of the output of pxCommand into pcWriteBuffer.  Returns
+ * pdTRUE if there is more output to come, or pdFALSE if this was the last
+ * part.
+ */
+static BaseType_t prvCallInterpreter( CLI_Session_t * pxSession,
+                                      const CLI_Definition_List_Item_t * pxCommand,
+                                      const char * const pcCommandInput,
+                                      char * pcWriteBuffer,
+                                      size_t xWriteBufferLen );
+
+#if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+/*
+ * Run pcCommandInput to completion in pxSession, writing the output to
+ * pxSink.  pcWriteBuffer holds each part of the output of commands that do not
+ * stream it.
+ */
+    static BaseType_t prvProcessCommandToSink( CLI_Session_t * pxSession,
+                                               const char * const pcCommandInput,
+                                               const CLI_Output_Sink_t * pxSink,
+                                               char * pcWriteBuffer,
+                                               size_t xWriteBufferLen );
+
+/*
+ * The writer used when a command that streams its output is run by
+ * FreeRTOS_CLIProcessCommand, which appends the output to the buffer
+ * described by the CLIBufferSink_t pointed to by pvContext.  Returns pdFAIL
+ * once the buffer is full, so the command stops.
+ */
+    static BaseType_t prvBufferWriter( void * pvContext,
+                                       const char * pcData,
+                                       size_t xDataLength );
+
+/* The buffer written by prvBufferWriter(). */
+    typedef struct xCLI_BUFFER_SINK
+    {
+        char * pcBuffer;
+        size_t xBufferLength;
+        size_t xBytesWritten;
+    } CLIBufferSink_t;
+#endif /* if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 ) */
+
+#if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+
+/*
+ * Record the position of each parameter in pcCommandString in pxParameters.
+ */
+    static void prvRecordParameters( CLI_Parameters_t * pxParameters,
+                                     const char * pcCommandString );
+
+/*
+ * Make the parameters in pxParameters available to FreeRTOS_CLIGetParameter()
+ * while the command they were found for runs, and remove them again once it
+ * returns.
+ */
+    static void prvActivateParameters( CLI_Parameters_t * pxParameters );
+    static void prvDeactivateParameters( CLI_Parameters_t * pxParameters );
+
+/*
+ * Return the parameters recorded for pcCommandString, if it is the string
+ * passed to a running command, otherwise NULL.
+ */
+    static const CLI_Parameters_t * prvGetActiveParameters( const char * pcCommandString );
+#endif /* if ( configCOMMAND_INT_MAX_PARAMETERS > 0 ) */
+
 /*
  * Return the number of parameters that follow the command name.
  */
 static int8_t prvGetNumberOfParameters( const char * pcCommandString );
 
+#if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+
+/*
+ * Return the hash table bucket of the first space delimited word in
+ * pcCommandString.
+ */
+    static UBaseType_t prvHashCommand( const char * pcCommandString );
+
+/*
+ * Cache the length of the command referenced by pxListItem, and add the list
+ * item to the end of the chain of its hash table bucket.  Must be called from
+ * a critical section.
+ */
+    static void prvAddCommandToBucket( CLI_Definition_List_Item_t * pxListItem );
+
+/*
+ * Add the help command to the hash table, if that has not been done yet.
+ */
+    static void prvAddHelpCommandToBucket( void );
+
+/* The next command which could match the input is the next one in the same
+ * hash table bucket. */
+    #define cliNEXT_CANDIDATE( pxCommand )    ( ( pxCommand )->pxNextInBucket )
+#else
+
+/* Any registered command could match the input. */
+    #define cliNEXT_CANDIDATE( pxCommand )    ( ( pxCommand )->pxNext )
+#endif /* if ( configCOMMAND_INT_HASH_BUCKETS > 0 ) */
+
 /* The definition of the "help" command.  This command is always at the front
  * of the list of registered commands. */
 static const CLI_Command_Definition_t xHelpCommand =
@@ -76,16 +212,38 @@ static const CLI_Command_Definition_t xHelpCommand =
     "\r\nhelp:\r\n Lists all the registered commands\r\n\r\n",
     prvHelpCommand,
     0
+    #if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+        , NULL
+    #endif
 };
 
+/* The outputs returned when the input is not a valid command. */
+#define cliCOMMAND_NOT_RECOGNISED    "Command not recognised.  Enter 'help' to view a list of available commands.\r\n\r\n"
+#define cliINCORRECT_PARAMETERS      "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n"
+
 /* The definition of the list of commands.  Commands that are registered are
  * added to this list. */
 static CLI_Definition_List_Item_t xRegisteredCommands =
 {
     &xHelpCommand, /* The first command in the list is always the help command, defined in this file. */
-    NULL           /* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+    NULL,          /* The next pointer is initialised to NULL, as there are no other registered commands yet. */
+    #if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+        NULL,      /* The help command is added to its bucket on first use. */
+        0          /* The length is cached when it is. */
+    #endif
 };
 
+#if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+
+/* The hash table of registered commands.  Each bucket holds the first of the
+ * commands whose first words hash to it, chained through pxNextInBucket. */
+    static CLI_Definition_List_Item_t * pxCommandBuckets[ configCOMMAND_INT_HASH_BUCKETS ] = { NULL };
+
+/* Set to pdTRUE once the help command, which is not registered, has been
+ * added to the hash table. */
+    static BaseType_t xHelpCommandInBucket = pdFALSE;
+#endif
+
 /* A buffer into which command outputs can be written is declared here, rather
 * than in the command console implementation, to allow multiple command consoles
 * to share the same buffer.  For example, an application may allow access to the
@@ -104,6 +262,16 @@ static CLI_Definition_List_Item_t xRegisteredCommands =
     extern char cOutputBuffer[ configCOMMAND_INT_MAX_OUTPUT_SIZE ];
 #endif
 
+/* The continuation state of FreeRTOS_CLIProcessCommand(), which is not
+ * re-entrant.  Consoles using the session API each have their own. */
+static CLI_Session_t xDefaultSession;
+
+#if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+
+/* The parameters of the commands that are running, one for each session. */
+    static CLI_Parameters_t * pxActiveParameters = NULL;
+#endif
+
 
 /*-----------------------------------------------------------*/
 
@@ -154,79 +322,89 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput,
                                        char * pcWriteBuffer,
                                        size_t xWriteBufferLen )
 {
-    static const CLI_Definition_List_Item_t * pxCommand = NULL;
-    BaseType_t xReturn = pdTRUE;
-    const char * pcRegisteredCommandString;
-    size_t xCommandStringLength;
-
     /* Note:  This function is not re-entrant.  It must not be called from more
      * thank one task. */
+    return prvProcessCommand( &xDefaultSession, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+}
+/*-----------------------------------------------------------*/
 
-    if( pxCommand == NULL )
-    {
-        /* Search for the command string in the list of registered commands. */
-        for( pxCommand = &xRegisteredCommands; pxCommand != NULL; pxCommand = pxCommand->pxNext )
-        {
-            pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
-            xCommandStringLength = strlen( pcRegisteredCommandString );
+void FreeRTOS_CLISessionInit( CLI_Session_t * pxSession,
+                              char * pcOutputBuffer,
+                              size_t xOutputBufferLength )
+{
+    /* Check the parameters are not NULL. */
+    configASSERT( pxSession != NULL );
+    configASSERT( pcOutputBuffer != NULL );
 
-            /* To ensure the string lengths match exactly, so as not to pick up
-             * a sub-string of a longer command, check the byte after the expected
-             * end of the string is either the end of the string or a space before
-             * a parameter. */
-            if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
-            {
-                if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
-                {
-                    /* The command has been found.  Check it has the expected
-                     * number of parameters.  If cExpectedNumberOfParameters is -1,
-                     * then there could be a variable number of parameters and no
-                     * check is made. */
-                    if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
-                    {
-                        if( prvGetNumberOfParameters( pcCommandInput ) != pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
-                        {
-                            xReturn = pdFALSE;
-                        }
-                    }
+    pxSession->pxCommand = NULL;
+    pxSession->pxHelpCommand = NULL;
+    pxSession->pcOutputBuffer = pcOutputBuffer;
+    pxSession->xOutputBufferLength = xOutputBufferLength;
 
-                    break;
-                }
-            }
-        }
+    #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+    {
+        pxSession->xParameters.pcCommandString = NULL;
+        pxSession->xParameters.pxNextActive = NULL;
+        pxSession->xParameters.uxNumberOfParameters = 0;
     }
+    #endif
+}
+/*-----------------------------------------------------------*/
 
-    if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
+BaseType_t FreeRTOS_CLISessionProcessCommand( CLI_Session_t * pxSession,
+                                              const char * const pcCommandInput )
+{
+    configASSERT( pxSession != NULL );
+    configASSERT( pxSession->pcOutputBuffer != NULL );
+
+    return prvProcessCommand( pxSession, pcCommandInput, pxSession->pcOutputBuffer, pxSession->xOutputBufferLength );
+}
+/*-----------------------------------------------------------*/
+
+char * FreeRTOS_CLISessionGetOutputBuffer( const CLI_Session_t * pxSession )
+{
+    configASSERT( pxSession != NULL );
+
+    return pxSession->pcOutputBuffer;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+    BaseType_t FreeRTOS_CLIProcessCommandToSink( const char * const pcCommandInput,
+                                                 const CLI_Output_Sink_t * pxSink )
     {
-        /* The command was found, but the number of parameters with the command
-         * was incorrect. */
-        strncpy( pcWriteBuffer, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n", xWriteBufferLen );
-        pxCommand = NULL;
+        /* Note:  This function is not re-entrant.  It must not be called from
+         * more thank one task. */
+        return prvProcessCommandToSink( &xDefaultSession, pcCommandInput, pxSink, cOutputBuffer, configCOMMAND_INT_MAX_OUTPUT_SIZE );
     }
-    else if( pxCommand != NULL )
+/*-----------------------------------------------------------*/
+
+    BaseType_t FreeRTOS_CLISessionProcessCommandToSink( CLI_Session_t * pxSession,
+                                                        const char * const pcCommandInput,
+                                                        const CLI_Output_Sink_t * pxSink )
     {
-        /* Call the callback function that is registered to this command. */
-        xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+        configASSERT( pxSession != NULL );
+        configASSERT( pxSession->pcOutputBuffer != NULL );
 
-        /* If xReturn is pdFALSE, then no further strings will be returned
-         * after this one, and	pxCommand can be reset to NULL ready to search
-         * for the next entered command. */
-        if( xReturn == pdFALSE )
-        {
-            pxCommand = NULL;
-        }
+        return prvProcessCommandToSink( pxSession, pcCommandInput, pxSink, pxSession->pcOutputBuffer, pxSession->xOutputBufferLength );
     }
-    else
+/*-----------------------------------------------------------*/
+
+    BaseType_t FreeRTOS_CLIWriteString( const CLI_Output_Sink_t * pxSink,
+                                        const char * pcString )
     {
-        /* pxCommand was NULL, the command was not found. */
-        strncpy( pcWriteBuffer, "Command not recognised.  Enter 'help' to view a list of available commands.\r\n\r\n", xWriteBufferLen );
-        xReturn = pdFALSE;
-    }
+        configASSERT( pxSink != NULL );
+        configASSERT( pxSink->pxWriter != NULL );
+        configASSERT( pcString != NULL );
 
-    return xReturn;
-}
+        return pxSink->pxWriter( pxSink->pvContext, pcString, strlen( pcString ) );
+    }
 /*-----------------------------------------------------------*/
 
+#endif /* if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 ) */
+
+
 char * FreeRTOS_CLIGetOutputBuffer( void )
 {
     return cOutputBuffer;
@@ -236,6 +414,79 @@ char * FreeRTOS_CLIGetOutputBuffer( void )
 const char * FreeRTOS_CLIGetParameter( const char * pcCommandString,
                                        UBaseType_t uxWantedParameter,
                                        BaseType_t * pxParameterStringLength )
+{
+    const char * pcReturn;
+
+    #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+        const CLI_Parameters_t * pxParameters = prvGetActiveParameters( pcCommandString );
+
+        if( ( pxParameters != NULL ) && ( uxWantedParameter > pxParameters->uxNumberOfParameters ) )
+        {
+            /* There is no such parameter. */
+            *pxParameterStringLength = 0;
+            pcReturn = NULL;
+        }
+        else if( ( pxParameters != NULL ) && ( uxWantedParameter > 0U ) && ( uxWantedParameter <= ( UBaseType_t ) configCOMMAND_INT_MAX_PARAMETERS ) )
+        {
+            /* The position of the parameter was recorded when the command was
+             * found. */
+            *pxParameterStringLength = ( BaseType_t ) pxParameters->xLengths[ uxWantedParameter - 1U ];
+            pcReturn = &( pcCommandString[ pxParameters->xOffsets[ uxWantedParameter - 1U ] ] );
+        }
+        else
+    #endif /* if ( configCOMMAND_INT_MAX_PARAMETERS > 0 ) */
+    {
+        pcReturn = prvScanForParameter( pcCommandString, uxWantedParameter, pxParameterStringLength );
+    }
+
+    return pcReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t FreeRTOS_CLIGetNumberOfParameters( const char * pcCommandString )
+{
+    UBaseType_t uxReturn;
+
+    #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+        const CLI_Parameters_t * pxParameters = prvGetActiveParameters( pcCommandString );
+
+        if( pxParameters != NULL )
+        {
+            uxReturn = pxParameters->uxNumberOfParameters;
+        }
+        else
+    #endif
+    {
+        uxReturn = ( UBaseType_t ) prvGetNumberOfParameters( pcCommandString );
+    }
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+const CLI_Command_Definition_t * FreeRTOS_CLIGetCommand( UBaseType_t uxCommandIndex )
+{
+    const CLI_Definition_List_Item_t * pxCommand = &xRegisteredCommands;
+    const CLI_Command_Definition_t * pxReturn = NULL;
+
+    while( ( pxCommand != NULL ) && ( uxCommandIndex > 0U ) )
+    {
+        pxCommand = pxCommand->pxNext;
+        uxCommandIndex--;
+    }
+
+    if( pxCommand != NULL )
+    {
+        pxReturn = pxCommand->pxCommandLineDefinition;
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static const char * prvScanForParameter( const char * pcCommandString,
+                                         UBaseType_t uxWantedParameter,
+                                         BaseType_t * pxParameterStringLength )
 {
     UBaseType_t uxParametersFound = 0;
     const char * pcReturn = NULL;
@@ -301,6 +552,17 @@ static void prvRegisterCommand( const CLI_Command_Definition_t * const pxCommand
     configASSERT( pxCommandToRegister != NULL );
     configASSERT( pxCliDefinitionListItemBuffer != NULL );
 
+    /* Check the command has a way of returning its output. */
+    #if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+    {
+        configASSERT( ( pxCommandToRegister->pxCommandInterpreter != NULL ) || ( pxCommandToRegister->pxStreamInterpreter != NULL ) );
+    }
+    #else
+    {
+        configASSERT( pxCommandToRegister->pxCommandInterpreter != NULL );
+    }
+    #endif
+
     taskENTER_CRITICAL();
     {
         /* Reference the command being registered from the newly created
@@ -317,20 +579,418 @@ static void prvRegisterCommand( const CLI_Command_Definition_t * const pxCommand
 
         /* Set the end of list marker to the new list item. */
         pxLastCommandInList = pxCliDefinitionListItemBuffer;
+
+        #if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+        {
+            /* Keep the help command ahead of the registered commands in its
+             * bucket, as it is in the list. */
+            prvAddHelpCommandToBucket();
+            prvAddCommandToBucket( pxCliDefinitionListItemBuffer );
+        }
+        #endif
     }
     taskEXIT_CRITICAL();
 }
 /*-----------------------------------------------------------*/
 
+#if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+
+    static UBaseType_t prvHashCommand( const char * pcCommandString )
+    {
+        /* 32-bit FNV-1a hash of the characters before the first space. */
+        uint32_t ulHash = 2166136261UL;
+
+        while( ( *pcCommandString != 0x00 ) && ( *pcCommandString != ' ' ) )
+        {
+            ulHash ^= ( uint32_t ) ( uint8_t ) *pcCommandString;
+            ulHash *= 16777619UL;
+            pcCommandString++;
+        }
+
+        return ( UBaseType_t ) ( ulHash % ( uint32_t ) configCOMMAND_INT_HASH_BUCKETS );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvAddCommandToBucket( CLI_Definition_List_Item_t * pxListItem )
+    {
+        CLI_Definition_List_Item_t ** ppxLink;
+
+        /* A command containing spaces is added to the bucket of its first
+         * word, which is the bucket searched for input starting with it. */
+        pxListItem->xCommandLength = strlen( pxListItem->pxCommandLineDefinition->pcCommand );
+        pxListItem->pxNextInBucket = NULL;
+
+        /* Add the command to the end of the chain, so that where several
+         * commands could match an input, the first registered is found, as
+         * when searching the list. */
+        ppxLink = &( pxCommandBuckets[ prvHashCommand( pxListItem->pxCommandLineDefinition->pcCommand ) ] );
+
+        while( *ppxLink != NULL )
+        {
+            ppxLink = &( ( *ppxLink )->pxNextInBucket );
+        }
+
+        *ppxLink = pxListItem;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvAddHelpCommandToBucket( void )
+    {
+        /* Only the first call has anything to do, so avoid the critical
+         * section on every command entered. */
+        if( xHelpCommandInBucket == pdFALSE )
+        {
+            taskENTER_CRITICAL();
+            {
+                if( xHelpCommandInBucket == pdFALSE )
+                {
+                    prvAddCommandToBucket( &xRegisteredCommands );
+                    xHelpCommandInBucket = pdTRUE;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( configCOMMAND_INT_HASH_BUCKETS > 0 ) */
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvProcessCommand( CLI_Session_t * pxSession,
+                                     const char * const pcCommandInput,
+                                     char * pcWriteBuffer,
+                                     size_t xWriteBufferLen )
+{
+    const CLI_Definition_List_Item_t * pxCommand = pxSession->pxCommand;
+    BaseType_t xReturn = pdTRUE;
+
+    /* Note:  Only the state of pxSession is changed, so calls for different
+     * sessions can be made by different tasks. */
+
+    if( pxCommand == NULL )
+    {
+        pxCommand = prvFindCommand( pcCommandInput );
+
+        if( pxCommand != NULL )
+        {
+            xReturn = prvParametersValid( pxSession, pxCommand, pcCommandInput );
+        }
+    }
+
+    if( ( pxCommand != NULL ) && ( xReturn == pdFALSE ) )
+    {
+        /* The command was found, but the number of parameters with the command
+         * was incorrect. */
+        strncpy( pcWriteBuffer, cliINCORRECT_PARAMETERS, xWriteBufferLen );
+        pxCommand = NULL;
+    }
+    else if( pxCommand != NULL )
+    {
+        xReturn = prvCallInterpreter( pxSession, pxCommand, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+
+        /* If xReturn is pdFALSE, then no further strings will be returned
+         * after this one, and	pxCommand can be reset to NULL ready to search
+         * for the next entered command. */
+        if( xReturn == pdFALSE )
+        {
+            pxCommand = NULL;
+        }
+    }
+    else
+    {
+        /* pxCommand was NULL, the command was not found. */
+        strncpy( pcWriteBuffer, cliCOMMAND_NOT_RECOGNISED, xWriteBufferLen );
+        xReturn = pdFALSE;
+    }
+
+    pxSession->pxCommand = pxCommand;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static const CLI_Definition_List_Item_t * prvFindCommand( const char * const pcCommandInput )
+{
+    const CLI_Definition_List_Item_t * pxCommand;
+    const char * pcRegisteredCommandString;
+    size_t xCommandStringLength;
+
+    #if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+    {
+        /* Only the commands in the bucket of the first word of the input can
+         * match it. */
+        prvAddHelpCommandToBucket();
+        pxCommand = pxCommandBuckets[ prvHashCommand( pcCommandInput ) ];
+    }
+    #else
+    {
+        pxCommand = &xRegisteredCommands;
+    }
+    #endif /* if ( configCOMMAND_INT_HASH_BUCKETS > 0 ) */
+
+    /* Search for the command string in the list of registered commands. */
+    for( ; pxCommand != NULL; pxCommand = cliNEXT_CANDIDATE( pxCommand ) )
+    {
+        pcRegisteredCommandString = pxCommand->pxCommandLineDefinition->pcCommand;
+
+        #if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+        {
+            xCommandStringLength = pxCommand->xCommandLength;
+        }
+        #else
+        {
+            xCommandStringLength = strlen( pcRegisteredCommandString );
+        }
+        #endif
+
+        /* To ensure the string lengths match exactly, so as not to pick up
+         * a sub-string of a longer command, check the byte after the expected
+         * end of the string is either the end of the string or a space before
+         * a parameter. */
+        if( strncmp( pcCommandInput, pcRegisteredCommandString, xCommandStringLength ) == 0 )
+        {
+            if( ( pcCommandInput[ xCommandStringLength ] == ' ' ) || ( pcCommandInput[ xCommandStringLength ] == 0x00 ) )
+            {
+                /* The command has been found. */
+                break;
+            }
+        }
+    }
+
+    return pxCommand;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParametersValid( CLI_Session_t * pxSession,
+                                      const CLI_Definition_List_Item_t * pxCommand,
+                                      const char * const pcCommandInput )
+{
+    BaseType_t xReturn = pdTRUE;
+    UBaseType_t uxNumberOfParameters;
+
+    #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+    {
+        /* Find the parameters once, for both this check and the command. */
+        prvRecordParameters( &( pxSession->xParameters ), pcCommandInput );
+        uxNumberOfParameters = pxSession->xParameters.uxNumberOfParameters;
+    }
+    #else
+    {
+        ( void ) pxSession;
+        uxNumberOfParameters = ( UBaseType_t ) prvGetNumberOfParameters( pcCommandInput );
+    }
+    #endif
+
+    /* Check the command has the expected number of parameters.  If
+     * cExpectedNumberOfParameters is -1, then there could be a variable number
+     * of parameters and no check is made. */
+    if( pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters >= 0 )
+    {
+        if( uxNumberOfParameters != ( UBaseType_t ) pxCommand->pxCommandLineDefinition->cExpectedNumberOfParameters )
+        {
+            xReturn = pdFALSE;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCallInterpreter( CLI_Session_t * pxSession,
+                                      const CLI_Definition_List_Item_t * pxCommand,
+                                      const char * const pcCommandInput,
+                                      char * pcWriteBuffer,
+                                      size_t xWriteBufferLen )
+{
+    BaseType_t xReturn;
+
+    #if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+        CLIBufferSink_t xBufferSink;
+        CLI_Output_Sink_t xSink;
+    #endif
+
+    if( pxCommand->pxCommandLineDefinition == &xHelpCommand )
+    {
+        /* Keep the position reached in the help strings in the session,
+         * rather than in prvHelpCommand(). */
+        xReturn = prvWriteNextHelpString( &( pxSession->pxHelpCommand ), pcWriteBuffer, xWriteBufferLen );
+    }
+
+    #if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+        else if( pxCommand->pxCommandLineDefinition->pxStreamInterpreter != NULL )
+        {
+            /* Collect the output of the command in pcWriteBuffer.  Any output
+             * that does not fit is lost, as the command cannot be resumed. */
+            xBufferSink.pcBuffer = pcWriteBuffer;
+            xBufferSink.xBufferLength = xWriteBufferLen;
+            xBufferSink.xBytesWritten = 0;
+            xSink.pxWriter = prvBufferWriter;
+            xSink.pvContext = &xBufferSink;
+
+            if( xWriteBufferLen > 0 )
+            {
+                pcWriteBuffer[ 0 ] = 0x00;
+            }
+
+            #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+                prvActivateParameters( &( pxSession->xParameters ) );
+            #endif
+
+            ( void ) pxCommand->pxCommandLineDefinition->pxStreamInterpreter( &xSink, pcCommandInput );
+            xReturn = pdFALSE;
+
+            #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+                prvDeactivateParameters( &( pxSession->xParameters ) );
+            #endif
+        }
+    #endif /* if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 ) */
+    else
+    {
+        #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+            prvActivateParameters( &( pxSession->xParameters ) );
+        #endif
+
+        /* Call the callback function that is registered to this command. */
+        xReturn = pxCommand->pxCommandLineDefinition->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+
+        #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+            prvDeactivateParameters( &( pxSession->xParameters ) );
+        #endif
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+    static BaseType_t prvProcessCommandToSink( CLI_Session_t * pxSession,
+                                               const char * const pcCommandInput,
+                                               const CLI_Output_Sink_t * pxSink,
+                                               char * pcWriteBuffer,
+                                               size_t xWriteBufferLen )
+    {
+        const CLI_Definition_List_Item_t * pxCommand;
+        BaseType_t xParametersValid, xMoreOutput = pdFALSE, xReturn;
+        const char * pcEnd;
+
+        configASSERT( pxSink != NULL );
+        configASSERT( pxSink->pxWriter != NULL );
+        configASSERT( xWriteBufferLen > 0U );
+
+        /* A command run by FreeRTOS_CLIProcessCommand() must have returned all
+         * of its output before the next command is run. */
+        configASSERT( pxSession->pxCommand == NULL );
+
+        pxCommand = prvFindCommand( pcCommandInput );
+
+        if( pxCommand != NULL )
+        {
+            xParametersValid = prvParametersValid( pxSession, pxCommand, pcCommandInput );
+        }
+
+        if( pxCommand == NULL )
+        {
+            xReturn = FreeRTOS_CLIWriteString( pxSink, cliCOMMAND_NOT_RECOGNISED );
+        }
+        else if( xParametersValid == pdFALSE )
+        {
+            xReturn = FreeRTOS_CLIWriteString( pxSink, cliINCORRECT_PARAMETERS );
+        }
+        else if( pxCommand->pxCommandLineDefinition->pxStreamInterpreter != NULL )
+        {
+            #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+                prvActivateParameters( &( pxSession->xParameters ) );
+            #endif
+
+            xReturn = pxCommand->pxCommandLineDefinition->pxStreamInterpreter( pxSink, pcCommandInput );
+
+            #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+                prvDeactivateParameters( &( pxSession->xParameters ) );
+            #endif
+        }
+        else
+        {
+            /* Write each buffer of output in turn, until the command has no
+             * more output or the sink stops accepting it. */
+            do
+            {
+                pcWriteBuffer[ 0 ] = 0x00;
+                xMoreOutput = prvCallInterpreter( pxSession, pxCommand, pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+
+                /* The output need not be NULL terminated if it filled the
+                 * buffer. */
+                pcEnd = memchr( pcWriteBuffer, 0x00, xWriteBufferLen );
+
+                if( pcEnd == NULL )
+                {
+                    pcEnd = &( pcWriteBuffer[ xWriteBufferLen ] );
+                }
+
+                xReturn = pxSink->pxWriter( pxSink->pvContext, pcWriteBuffer, ( size_t ) ( pcEnd - pcWriteBuffer ) );
+            } while( ( xMoreOutput != pdFALSE ) && ( xReturn != pdFAIL ) );
+
+            if( xMoreOutput != pdFALSE )
+            {
+                /* The rest of the output was abandoned, so "help" starts from
+                 * the beginning next time. */
+                pxSession->pxHelpCommand = NULL;
+            }
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvBufferWriter( void * pvContext,
+                                       const char * pcData,
+                                       size_t xDataLength )
+    {
+        CLIBufferSink_t * pxBufferSink = ( CLIBufferSink_t * ) pvContext;
+        BaseType_t xReturn = pdPASS;
+        size_t xSpace;
+
+        /* Leave room for the NULL terminator. */
+        xSpace = ( pxBufferSink->xBufferLength > pxBufferSink->xBytesWritten ) ? ( pxBufferSink->xBufferLength - pxBufferSink->xBytesWritten - 1U ) : 0U;
+
+        if( xDataLength > xSpace )
+        {
+            xDataLength = xSpace;
+            xReturn = pdFAIL;
+        }
+
+        if( pxBufferSink->xBufferLength > 0U )
+        {
+            memcpy( &( pxBufferSink->pcBuffer[ pxBufferSink->xBytesWritten ] ), pcData, xDataLength );
+            pxBufferSink->xBytesWritten += xDataLength;
+            pxBufferSink->pcBuffer[ pxBufferSink->xBytesWritten ] = 0x00;
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 ) */
+
 static BaseType_t prvHelpCommand( char * pcWriteBuffer,
                                   size_t xWriteBufferLen,
                                   const char * pcCommandString )
 {
     static const CLI_Definition_List_Item_t * pxCommand = NULL;
-    BaseType_t xReturn;
 
     ( void ) pcCommandString;
 
+    return prvWriteNextHelpString( &pxCommand, pcWriteBuffer, xWriteBufferLen );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteNextHelpString( const CLI_Definition_List_Item_t ** ppxHelpCommand,
+                                          char * pcWriteBuffer,
+                                          size_t xWriteBufferLen )
+{
+    const CLI_Definition_List_Item_t * pxCommand = *ppxHelpCommand;
+    BaseType_t xReturn;
+
     if( pxCommand == NULL )
     {
         /* Reset the pxCommand pointer back to the start of the list. */
@@ -353,10 +1013,116 @@ static BaseType_t prvHelpCommand( char * pcWriteBuffer,
         xReturn = pdTRUE;
     }
 
+    *ppxHelpCommand = pxCommand;
+
     return xReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+
+    static void prvRecordParameters( CLI_Parameters_t * pxParameters,
+                                     const char * pcCommandString )
+    {
+        const char * pcCharacter = pcCommandString;
+        const char * pcStart;
+        UBaseType_t uxParameter = 0;
+
+        /* Skip the command itself, which is the first word. */
+        while( ( *pcCharacter != 0x00 ) && ( *pcCharacter != ' ' ) )
+        {
+            pcCharacter++;
+        }
+
+        /* Each space delimited word after the command is a parameter, as for
+         * prvScanForParameter() and prvGetNumberOfParameters(). */
+        for( ; ; )
+        {
+            while( *pcCharacter == ' ' )
+            {
+                pcCharacter++;
+            }
+
+            if( *pcCharacter == 0x00 )
+            {
+                break;
+            }
+
+            pcStart = pcCharacter;
+
+            while( ( *pcCharacter != 0x00 ) && ( *pcCharacter != ' ' ) )
+            {
+                pcCharacter++;
+            }
+
+            if( uxParameter < ( UBaseType_t ) configCOMMAND_INT_MAX_PARAMETERS )
+            {
+                pxParameters->xOffsets[ uxParameter ] = ( size_t ) ( pcStart - pcCommandString );
+                pxParameters->xLengths[ uxParameter ] = ( size_t ) ( pcCharacter - pcStart );
+            }
+
+            uxParameter++;
+        }
+
+        pxParameters->pcCommandString = pcCommandString;
+        pxParameters->uxNumberOfParameters = uxParameter;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvActivateParameters( CLI_Parameters_t * pxParameters )
+    {
+        taskENTER_CRITICAL();
+        {
+            pxParameters->pxNextActive = pxActiveParameters;
+            pxActiveParameters = pxParameters;
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvDeactivateParameters( CLI_Parameters_t * pxParameters )
+    {
+        CLI_Parameters_t ** ppxLink;
+
+        taskENTER_CRITICAL();
+        {
+            for( ppxLink = &pxActiveParameters; *ppxLink != NULL; ppxLink = &( ( *ppxLink )->pxNextActive ) )
+            {
+                if( *ppxLink == pxParameters )
+                {
+                    *ppxLink = pxParameters->pxNextActive;
+                    break;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+    static const CLI_Parameters_t * prvGetActiveParameters( const char * pcCommandString )
+    {
+        const CLI_Parameters_t * pxParameters;
+
+        /* The parameters found belong to the session whose command is calling
+         * this function, so they cannot change after the list is left. */
+        taskENTER_CRITICAL();
+        {
+            for( pxParameters = pxActiveParameters; pxParameters != NULL; pxParameters = pxParameters->pxNextActive )
+            {
+                if( pxParameters->pcCommandString == pcCommandString )
+                {
+                    break;
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        return pxParameters;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( configCOMMAND_INT_MAX_PARAMETERS > 0 ) */
+
 static int8_t prvGetNumberOfParameters( const char * pcCommandString )
 {
     int8_t cParameters = 0;
@@ -42,6 +42,43 @@ typedef BaseType_t (* pdCOMMAND_LINE_CALLBACK)( char * pcWriteBuffer,
                                                 size_t xWriteBufferLen,
                                                 const char * pcCommandString );
 
+/* Set configCOMMAND_INT_STREAMING_OUTPUT to 1 to allow commands to write their
+ * output through a CLI_Output_Sink_t, such as a UART or a socket, as they
+ * produce it, instead of returning it one buffer at a time.  Such commands set
+ * pxStreamInterpreter in their definition and leave pxCommandInterpreter NULL.
+ * Defaults to 0, in which case commands only have pxCommandInterpreter. */
+#ifndef configCOMMAND_INT_STREAMING_OUTPUT
+    #define configCOMMAND_INT_STREAMING_OUTPUT    0
+#endif
+
+#if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+/* The prototype to which functions that send command output to its
+ * destination must comply.  pvContext is the pvContext member of the sink, and
+ * pcData points to xDataLength bytes of output, which are not NULL terminated.
+ * The function may block until the destination can accept the data, and should
+ * return pdPASS if all the data was sent, or pdFAIL if it could not be sent. */
+    typedef BaseType_t (* pdCOMMAND_LINE_WRITER)( void * pvContext,
+                                                  const char * pcData,
+                                                  size_t xDataLength );
+
+/* The destination of the output of a command. */
+    typedef struct xCLI_OUTPUT_SINK
+    {
+        pdCOMMAND_LINE_WRITER pxWriter; /* The function that sends the output. */
+        void * pvContext;               /* Passed to pxWriter, for example a UART or socket handle. */
+    } CLI_Output_Sink_t;
+
+/* The prototype to which callback functions that stream their output must
+ * comply.  The whole output of the command is written to pxSink, normally with
+ * FreeRTOS_CLIWriteString(), in a single call, so the function does not need
+ * to remember its position between calls.  pcCommandString is the entire
+ * string as input by the user.  Return pdFAIL as soon as a write fails, or
+ * pdPASS once all the output has been written. */
+    typedef BaseType_t (* pdCOMMAND_LINE_STREAM_CALLBACK)( const CLI_Output_Sink_t * pxSink,
+                                                           const char * pcCommandString );
+#endif /* if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 ) */
+
 /* The structure that defines command line commands.  A command line command
  * should be defined by declaring a const structure of this type. */
 typedef struct xCOMMAND_LINE_INPUT
@@ -50,15 +87,70 @@ typedef struct xCOMMAND_LINE_INPUT
     const char * const pcHelpString;                    /* String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
     const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter; /* A pointer to the callback function that will return the output generated by the command. */
     int8_t cExpectedNumberOfParameters;                 /* Commands expect a fixed number of parameters, which may be zero. */
+    #if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+        const pdCOMMAND_LINE_STREAM_CALLBACK pxStreamInterpreter; /* A pointer to the callback function that writes the output of the command to a sink, or NULL if pxCommandInterpreter is used. */
+    #endif
 } CLI_Command_Definition_t;
 
+/* The number of buckets in the hash table used to find the command entered.
+ * When set above 0, each registered command is also added to the bucket of its
+ * first word, and its length is cached, so FreeRTOS_CLIProcessCommand() only
+ * compares the input with the commands in one bucket rather than with every
+ * registered command.  Choosing roughly as many buckets as there are commands
+ * keeps the buckets short.  The default of 0 searches the list of all
+ * commands, as before. */
+#ifndef configCOMMAND_INT_HASH_BUCKETS
+    #define configCOMMAND_INT_HASH_BUCKETS    0
+#endif
+
 /* The structure that defines a command line list entry. */
 typedef struct xCOMMAND_INPUT_LIST
 {
     const CLI_Command_Definition_t * pxCommandLineDefinition;
     struct xCOMMAND_INPUT_LIST * pxNext;
+    #if ( configCOMMAND_INT_HASH_BUCKETS > 0 )
+        struct xCOMMAND_INPUT_LIST * pxNextInBucket; /* The next command, in order of registration, whose first word hashes to the same bucket. */
+        size_t xCommandLength;                       /* The length of pcCommand, cached when the command is registered. */
+    #endif
 } CLI_Definition_List_Item_t;
 
+/* The number of parameters of the command being run whose position is recorded
+ * when the command is found, so FreeRTOS_CLIGetParameter() and
+ * FreeRTOS_CLIGetNumberOfParameters() do not need to scan the command string.
+ * FreeRTOS_CLIGetParameter() scans for parameters beyond this number, as it
+ * does for any string other than the one passed to the running command.  The
+ * default of 0 records nothing. */
+#ifndef configCOMMAND_INT_MAX_PARAMETERS
+    #define configCOMMAND_INT_MAX_PARAMETERS    0
+#endif
+
+#if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+
+/* The parameters found in the string passed to a running command. */
+    typedef struct xCLI_PARAMETERS
+    {
+        const char * pcCommandString;                        /* The string the parameters were found in. */
+        struct xCLI_PARAMETERS * pxNextActive;               /* The parameters of the next command being run by another session. */
+        UBaseType_t uxNumberOfParameters;                    /* The number of parameters, including any beyond configCOMMAND_INT_MAX_PARAMETERS. */
+        size_t xOffsets[ configCOMMAND_INT_MAX_PARAMETERS ]; /* The offset of each parameter in pcCommandString. */
+        size_t xLengths[ configCOMMAND_INT_MAX_PARAMETERS ]; /* The length of each parameter. */
+    } CLI_Parameters_t;
+#endif
+
+/* The state of one command console, so that several consoles can run
+ * commands at the same time.  A session should be initialised with
+ * FreeRTOS_CLISessionInit() and then only used by the console that owns it. */
+typedef struct xCLI_SESSION
+{
+    const CLI_Definition_List_Item_t * pxCommand;     /* The command still returning output, or NULL when the next input is a new command. */
+    const CLI_Definition_List_Item_t * pxHelpCommand; /* The command whose help string "help" returns next, or NULL when "help" starts from the beginning. */
+    char * pcOutputBuffer;                            /* The buffer into which the output of commands run in the session is written. */
+    size_t xOutputBufferLength;                       /* The size, in bytes, of pcOutputBuffer. */
+    #if ( configCOMMAND_INT_MAX_PARAMETERS > 0 )
+        CLI_Parameters_t xParameters;                 /* The parameters of the command being run. */
+    #endif
+} CLI_Session_t;
+
 /* For backward compatibility. */
 #define xCommandLineInput    CLI_Command_Definition_t
 
@@ -96,6 +188,73 @@ BaseType_t FreeRTOS_CLIProcessCommand( const char * const pcCommandInput,
                                        char * pcWriteBuffer,
                                        size_t xWriteBufferLen );
 
+/*
+ * Initialise a command console session that writes the output of its commands
+ * into the pcOutputBuffer buffer, which is xOutputBufferLength bytes long.
+ */
+void FreeRTOS_CLISessionInit( CLI_Session_t * pxSession,
+                              char * pcOutputBuffer,
+                              size_t xOutputBufferLength );
+
+/*
+ * Runs the command interpreter for the command string "pcCommandInput" in the
+ * session pxSession.  Any output generated by running the command will be
+ * placed into the output buffer of the session, returned by
+ * FreeRTOS_CLISessionGetOutputBuffer().
+ *
+ * FreeRTOS_CLISessionProcessCommand should be called repeatedly until it
+ * returns pdFALSE.
+ *
+ * Unlike FreeRTOS_CLIProcessCommand, calls for different sessions may be made
+ * by different tasks at the same time, provided the commands run are
+ * themselves re-entrant - that is, commands which return pdTRUE must not keep
+ * the position reached in their output in static variables.  The "help"
+ * command keeps its position in the session.
+ */
+BaseType_t FreeRTOS_CLISessionProcessCommand( CLI_Session_t * pxSession,
+                                              const char * const pcCommandInput );
+
+/*
+ * Returns the address of the output buffer of the session pxSession.
+ */
+char * FreeRTOS_CLISessionGetOutputBuffer( const CLI_Session_t * pxSession );
+
+#if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 )
+
+/*
+ * Runs the command string "pcCommandInput" to completion, writing all of its
+ * output to pxSink.  Commands that stream their output write it to pxSink
+ * directly.  Commands that return their output one buffer at a time are
+ * called until they return pdFALSE, and each buffer is written to pxSink in
+ * turn, so the caller does not need to loop.
+ *
+ * Returns pdPASS if all the output was written, or pdFAIL if a write to
+ * pxSink failed, in which case the rest of the output is discarded.
+ *
+ * Like FreeRTOS_CLIProcessCommand, FreeRTOS_CLIProcessCommandToSink is not
+ * reentrant, and must not be used while a command run by
+ * FreeRTOS_CLIProcessCommand still has output to return.
+ */
+    BaseType_t FreeRTOS_CLIProcessCommandToSink( const char * const pcCommandInput,
+                                                 const CLI_Output_Sink_t * pxSink );
+
+/*
+ * As FreeRTOS_CLIProcessCommandToSink, but for the session pxSession, whose
+ * output buffer holds the output of commands that return it one buffer at a
+ * time.
+ */
+    BaseType_t FreeRTOS_CLISessionProcessCommandToSink( CLI_Session_t * pxSession,
+                                                        const char * const pcCommandInput,
+                                                        const CLI_Output_Sink_t * pxSink );
+
+/*
+ * Write the NULL terminated string pcString to pxSink.  Returns the value
+ * returned by the writer of the sink.
+ */
+    BaseType_t FreeRTOS_CLIWriteString( const CLI_Output_Sink_t * pxSink,
+                                        const char * pcString );
+#endif /* if ( configCOMMAND_INT_STREAMING_OUTPUT == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -118,6 +277,19 @@ const char * FreeRTOS_CLIGetParameter( const char * pcCommandString,
                                        UBaseType_t uxWantedParameter,
                                        BaseType_t * pxParameterStringLength );
 
+/*
+ * Return the number of parameters that follow the command name in
+ * pcCommandString.
+ */
+UBaseType_t FreeRTOS_CLIGetNumberOfParameters( const char * pcCommandString );
+
+/*
+ * Return the definition of the uxCommandIndex'th registered command, counting
+ * from 0 in the order the commands were registered, or NULL if fewer commands
+ * are registered.  Command 0 is always "help".
+ */
+const CLI_Command_Definition_t * FreeRTOS_CLIGetCommand( UBaseType_t uxCommandIndex );
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
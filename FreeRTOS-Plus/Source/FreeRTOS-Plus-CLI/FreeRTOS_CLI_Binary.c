@@ -0,0 +1,450 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/* Standard includes. */
+#include <string.h>
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Utils includes. */
+#include "FreeRTOS_CLI_Binary.h"
+
+/* The size of the fixed part of a TLV parameter. */
+#define cliBINARY_TLV_HEADER_LENGTH    ( 2U )
+
+/*
+ * Update the CRC-16/CCITT-FALSE usCRC with the xLength bytes at pucData.
+ */
+static uint16_t prvUpdateCRC( uint16_t usCRC,
+                              const uint8_t * pucData,
+                              size_t xLength );
+
+/*
+ * Read the little endian 16-bit value at pucData.
+ */
+static uint16_t prvReadUint16( const uint8_t * pucData );
+
+/*
+ * Send one response frame carrying the xOutputLength bytes at pcOutput.
+ */
+static BaseType_t prvSendResponse( const CLI_Binary_Adapter_t * pxAdapter,
+                                   uint8_t ucSequence,
+                                   uint8_t ucStatus,
+                                   uint8_t ucFragment,
+                                   const char * pcOutput,
+                                   size_t xOutputLength );
+
+/*
+ * Build the command line for pxCommand from the xParametersLength bytes of
+ * TLV parameters at pucParameters in the command buffer of pxAdapter.  Returns
+ * cliBINARY_STATUS_OK, or the status to report if a command line could not be
+ * built.
+ */
+static uint8_t prvBuildCommandLine( CLI_Binary_Adapter_t * pxAdapter,
+                                    const CLI_Command_Definition_t * pxCommand,
+                                    const uint8_t * pucParameters,
+                                    size_t xParametersLength );
+
+/*
+ * Append the xLength characters at pcString to the command line being built
+ * in pxAdapter, after *pxUsed characters.  Returns pdFALSE if there is not
+ * room for them and the NULL terminator.
+ */
+static BaseType_t prvAppend( CLI_Binary_Adapter_t * pxAdapter,
+                             size_t * pxUsed,
+                             const char * pcString,
+                             size_t xLength );
+
+/*
+ * Append ulValue in decimal, preceded by a '-' if xNegative is pdTRUE.
+ */
+static BaseType_t prvAppendDecimal( CLI_Binary_Adapter_t * pxAdapter,
+                                    size_t * pxUsed,
+                                    uint32_t ulValue,
+                                    BaseType_t xNegative );
+
+/*-----------------------------------------------------------*/
+
+void FreeRTOS_CLIBinaryInit( CLI_Binary_Adapter_t * pxAdapter,
+                             char * pcCommandBuffer,
+                             size_t xCommandBufferLength,
+                             char * pcOutputBuffer,
+                             size_t xOutputBufferLength,
+                             CLIBinaryWriter_t pxWriter,
+                             void * pvWriterContext )
+{
+    /* Check the parameters are not NULL. */
+    configASSERT( pxAdapter != NULL );
+    configASSERT( pcCommandBuffer != NULL );
+    configASSERT( pxWriter != NULL );
+
+    /* The payload length of a response frame is 16 bits. */
+    configASSERT( ( xOutputBufferLength > 0U ) && ( xOutputBufferLength <= 0xFFFFU ) );
+
+    FreeRTOS_CLISessionInit( &( pxAdapter->xSession ), pcOutputBuffer, xOutputBufferLength );
+    pxAdapter->pcCommandBuffer = pcCommandBuffer;
+    pxAdapter->xCommandBufferLength = xCommandBufferLength;
+    pxAdapter->pxWriter = pxWriter;
+    pxAdapter->pvWriterContext = pvWriterContext;
+}
+/*-----------------------------------------------------------*/
+
+size_t FreeRTOS_CLIBinaryGetFrameLength( const uint8_t * pucHeader )
+{
+    size_t xReturn = 0;
+
+    configASSERT( pucHeader != NULL );
+
+    if( pucHeader[ 0 ] == cliBINARY_REQUEST_SYNC )
+    {
+        xReturn = cliBINARY_REQUEST_HEADER_LENGTH + ( size_t ) prvReadUint16( &( pucHeader[ 4 ] ) ) + cliBINARY_CRC_LENGTH;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t FreeRTOS_CLIBinaryProcessFrame( CLI_Binary_Adapter_t * pxAdapter,
+                                           const uint8_t * pucFrame,
+                                           size_t xFrameLength )
+{
+    BaseType_t xReturn, xMoreOutput;
+    const CLI_Command_Definition_t * pxCommand = NULL;
+    uint8_t ucSequence = 0, ucStatus = cliBINARY_STATUS_OK, ucFragment = 0;
+    uint16_t usCRC;
+    const char * pcOutput;
+    const char * pcEnd;
+
+    configASSERT( pxAdapter != NULL );
+    configASSERT( pucFrame != NULL );
+
+    if( xFrameLength > 1U )
+    {
+        ucSequence = pucFrame[ 1 ];
+    }
+
+    /* Check the frame is complete and undamaged. */
+    if( ( xFrameLength < ( cliBINARY_REQUEST_HEADER_LENGTH + cliBINARY_CRC_LENGTH ) ) ||
+        ( FreeRTOS_CLIBinaryGetFrameLength( pucFrame ) != xFrameLength ) )
+    {
+        ucStatus = cliBINARY_STATUS_BAD_FRAME;
+    }
+    else
+    {
+        usCRC = prvUpdateCRC( 0xFFFFU, pucFrame, xFrameLength - cliBINARY_CRC_LENGTH );
+
+        if( usCRC != prvReadUint16( &( pucFrame[ xFrameLength - cliBINARY_CRC_LENGTH ] ) ) )
+        {
+            ucStatus = cliBINARY_STATUS_BAD_FRAME;
+        }
+    }
+
+    if( ucStatus == cliBINARY_STATUS_OK )
+    {
+        pxCommand = FreeRTOS_CLIGetCommand( ( UBaseType_t ) prvReadUint16( &( pucFrame[ 2 ] ) ) );
+
+        if( pxCommand == NULL )
+        {
+            ucStatus = cliBINARY_STATUS_UNKNOWN_COMMAND;
+        }
+        else
+        {
+            ucStatus = prvBuildCommandLine( pxAdapter,
+                                            pxCommand,
+                                            &( pucFrame[ cliBINARY_REQUEST_HEADER_LENGTH ] ),
+                                            xFrameLength - cliBINARY_REQUEST_HEADER_LENGTH - cliBINARY_CRC_LENGTH );
+        }
+    }
+
+    if( ucStatus != cliBINARY_STATUS_OK )
+    {
+        xReturn = prvSendResponse( pxAdapter, ucSequence, ucStatus, 0, NULL, 0 );
+    }
+    else
+    {
+        /* Run the command as the text interpreter would, sending each part of
+         * its output in its own response frame. */
+        pcOutput = FreeRTOS_CLISessionGetOutputBuffer( &( pxAdapter->xSession ) );
+
+        do
+        {
+            xMoreOutput = FreeRTOS_CLISessionProcessCommand( &( pxAdapter->xSession ), pxAdapter->pcCommandBuffer );
+
+            /* The output need not be NULL terminated if it filled the
+             * buffer. */
+            pcEnd = memchr( pcOutput, 0x00, pxAdapter->xSession.xOutputBufferLength );
+
+            if( pcEnd == NULL )
+            {
+                pcEnd = &( pcOutput[ pxAdapter->xSession.xOutputBufferLength ] );
+            }
+
+            xReturn = prvSendResponse( pxAdapter,
+                                       ucSequence,
+                                       ( xMoreOutput != pdFALSE ) ? cliBINARY_STATUS_MORE : cliBINARY_STATUS_OK,
+                                       ucFragment,
+                                       pcOutput,
+                                       ( size_t ) ( pcEnd - pcOutput ) );
+            ucFragment++;
+        } while( ( xMoreOutput != pdFALSE ) && ( xReturn != pdFAIL ) );
+
+        /* If the host could not be written to, run the command to completion
+         * anyway, so the session is ready for the next request. */
+        while( xMoreOutput != pdFALSE )
+        {
+            xMoreOutput = FreeRTOS_CLISessionProcessCommand( &( pxAdapter->xSession ), pxAdapter->pcCommandBuffer );
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvUpdateCRC( uint16_t usCRC,
+                              const uint8_t * pucData,
+                              size_t xLength )
+{
+    size_t x;
+    UBaseType_t uxBit;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        usCRC ^= ( uint16_t ) ( ( uint16_t ) pucData[ x ] << 8 );
+
+        for( uxBit = 0; uxBit < 8U; uxBit++ )
+        {
+            if( ( usCRC & 0x8000U ) != 0U )
+            {
+                usCRC = ( uint16_t ) ( ( usCRC << 1 ) ^ 0x1021U );
+            }
+            else
+            {
+                usCRC = ( uint16_t ) ( usCRC << 1 );
+            }
+        }
+    }
+
+    return usCRC;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvReadUint16( const uint8_t * pucData )
+{
+    return ( uint16_t ) ( ( uint16_t ) pucData[ 0 ] | ( uint16_t ) ( ( uint16_t ) pucData[ 1 ] << 8 ) );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendResponse( const CLI_Binary_Adapter_t * pxAdapter,
+                                   uint8_t ucSequence,
+                                   uint8_t ucStatus,
+                                   uint8_t ucFragment,
+                                   const char * pcOutput,
+                                   size_t xOutputLength )
+{
+    uint8_t ucHeader[ cliBINARY_RESPONSE_HEADER_LENGTH ];
+    uint8_t ucCRC[ cliBINARY_CRC_LENGTH ];
+    uint16_t usCRC;
+    BaseType_t xReturn;
+
+    ucHeader[ 0 ] = cliBINARY_RESPONSE_SYNC;
+    ucHeader[ 1 ] = ucSequence;
+    ucHeader[ 2 ] = ucStatus;
+    ucHeader[ 3 ] = ucFragment;
+    ucHeader[ 4 ] = ( uint8_t ) ( xOutputLength & 0xFFU );
+    ucHeader[ 5 ] = ( uint8_t ) ( ( xOutputLength >> 8 ) & 0xFFU );
+
+    usCRC = prvUpdateCRC( 0xFFFFU, ucHeader, sizeof( ucHeader ) );
+    usCRC = prvUpdateCRC( usCRC, ( const uint8_t * ) pcOutput, xOutputLength );
+    ucCRC[ 0 ] = ( uint8_t ) ( usCRC & 0xFFU );
+    ucCRC[ 1 ] = ( uint8_t ) ( usCRC >> 8 );
+
+    xReturn = pxAdapter->pxWriter( pxAdapter->pvWriterContext, ucHeader, sizeof( ucHeader ) );
+
+    if( ( xReturn != pdFAIL ) && ( xOutputLength > 0U ) )
+    {
+        xReturn = pxAdapter->pxWriter( pxAdapter->pvWriterContext, ( const uint8_t * ) pcOutput, xOutputLength );
+    }
+
+    if( xReturn != pdFAIL )
+    {
+        xReturn = pxAdapter->pxWriter( pxAdapter->pvWriterContext, ucCRC, sizeof( ucCRC ) );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvBuildCommandLine( CLI_Binary_Adapter_t * pxAdapter,
+                                    const CLI_Command_Definition_t * pxCommand,
+                                    const uint8_t * pucParameters,
+                                    size_t xParametersLength )
+{
+    uint8_t ucStatus = cliBINARY_STATUS_OK;
+    size_t xUsed = 0, xOffset = 0, xValueLength;
+    const uint8_t * pucValue;
+    uint32_t ulValue;
+    int8_t cParameters = 0;
+    BaseType_t xFits;
+
+    xFits = prvAppend( pxAdapter, &xUsed, pxCommand->pcCommand, strlen( pxCommand->pcCommand ) );
+
+    while( ( ucStatus == cliBINARY_STATUS_OK ) && ( xFits != pdFALSE ) && ( xOffset < xParametersLength ) )
+    {
+        if( ( xParametersLength - xOffset ) < cliBINARY_TLV_HEADER_LENGTH )
+        {
+            ucStatus = cliBINARY_STATUS_BAD_PARAMETERS;
+            break;
+        }
+
+        xValueLength = ( size_t ) pucParameters[ xOffset + 1U ];
+        pucValue = &( pucParameters[ xOffset + cliBINARY_TLV_HEADER_LENGTH ] );
+
+        if( ( xParametersLength - xOffset - cliBINARY_TLV_HEADER_LENGTH ) < xValueLength )
+        {
+            ucStatus = cliBINARY_STATUS_BAD_PARAMETERS;
+            break;
+        }
+
+        xFits = prvAppend( pxAdapter, &xUsed, " ", 1 );
+
+        switch( pucParameters[ xOffset ] )
+        {
+            case cliBINARY_TLV_STRING:
+
+                /* The interpreter separates parameters with spaces, so a
+                 * string parameter cannot contain one. */
+                if( ( xValueLength == 0U ) ||
+                    ( memchr( pucValue, ' ', xValueLength ) != NULL ) ||
+                    ( memchr( pucValue, 0x00, xValueLength ) != NULL ) )
+                {
+                    ucStatus = cliBINARY_STATUS_BAD_PARAMETERS;
+                }
+                else if( xFits != pdFALSE )
+                {
+                    xFits = prvAppend( pxAdapter, &xUsed, ( const char * ) pucValue, xValueLength );
+                }
+
+                break;
+
+            case cliBINARY_TLV_UINT32:
+            case cliBINARY_TLV_INT32:
+
+                if( xValueLength != 4U )
+                {
+                    ucStatus = cliBINARY_STATUS_BAD_PARAMETERS;
+                }
+                else if( xFits != pdFALSE )
+                {
+                    ulValue = ( uint32_t ) pucValue[ 0 ] |
+                              ( ( uint32_t ) pucValue[ 1 ] << 8 ) |
+                              ( ( uint32_t ) pucValue[ 2 ] << 16 ) |
+                              ( ( uint32_t ) pucValue[ 3 ] << 24 );
+
+                    if( ( pucParameters[ xOffset ] == cliBINARY_TLV_INT32 ) && ( ( ulValue & 0x80000000UL ) != 0UL ) )
+                    {
+                        xFits = prvAppendDecimal( pxAdapter, &xUsed, ( ~ulValue ) + 1UL, pdTRUE );
+                    }
+                    else
+                    {
+                        xFits = prvAppendDecimal( pxAdapter, &xUsed, ulValue, pdFALSE );
+                    }
+                }
+
+                break;
+
+            default:
+                ucStatus = cliBINARY_STATUS_BAD_PARAMETERS;
+                break;
+        }
+
+        cParameters++;
+        xOffset += cliBINARY_TLV_HEADER_LENGTH + xValueLength;
+    }
+
+    if( ( ucStatus == cliBINARY_STATUS_OK ) && ( xFits == pdFALSE ) )
+    {
+        ucStatus = cliBINARY_STATUS_COMMAND_TOO_LONG;
+    }
+    else if( ( ucStatus == cliBINARY_STATUS_OK ) &&
+             ( pxCommand->cExpectedNumberOfParameters >= 0 ) &&
+             ( cParameters != pxCommand->cExpectedNumberOfParameters ) )
+    {
+        /* Report the wrong number of parameters in the status, rather than
+         * in the text the interpreter would return. */
+        ucStatus = cliBINARY_STATUS_BAD_PARAMETERS;
+    }
+
+    return ucStatus;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAppend( CLI_Binary_Adapter_t * pxAdapter,
+                             size_t * pxUsed,
+                             const char * pcString,
+                             size_t xLength )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( pxAdapter->xCommandBufferLength > *pxUsed ) && ( ( pxAdapter->xCommandBufferLength - *pxUsed ) > xLength ) )
+    {
+        memcpy( &( pxAdapter->pcCommandBuffer[ *pxUsed ] ), pcString, xLength );
+        *pxUsed += xLength;
+        pxAdapter->pcCommandBuffer[ *pxUsed ] = 0x00;
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAppendDecimal( CLI_Binary_Adapter_t * pxAdapter,
+                                    size_t * pxUsed,
+                                    uint32_t ulValue,
+                                    BaseType_t xNegative )
+{
+    /* Room for a sign and the ten digits of the largest 32-bit value. */
+    char cDigits[ 11 ];
+    size_t xStart = sizeof( cDigits );
+
+    do
+    {
+        xStart--;
+        cDigits[ xStart ] = ( char ) ( '0' + ( char ) ( ulValue % 10UL ) );
+        ulValue /= 10UL;
+    } while( ulValue != 0UL );
+
+    if( xNegative != pdFALSE )
+    {
+        xStart--;
+        cDigits[ xStart ] = '-';
+    }
+
+    return prvAppend( pxAdapter, pxUsed, &( cDigits[ xStart ] ), sizeof( cDigits ) - xStart );
+}
+/*-----------------------------------------------------------*/
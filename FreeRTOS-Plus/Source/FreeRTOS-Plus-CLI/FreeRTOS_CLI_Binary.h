@@ -0,0 +1,146 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef COMMAND_INTERPRETER_BINARY_H
+#define COMMAND_INTERPRETER_BINARY_H
+
+#include "FreeRTOS_CLI.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/*
+ * A compact binary framing of FreeRTOS+CLI commands, for hosts that drive a
+ * device at a high rate and do not want to format and parse command lines.
+ * All multi-byte fields are little endian.
+ *
+ * A request frame is:
+ *   uint8_t  sync            cliBINARY_REQUEST_SYNC
+ *   uint8_t  sequence        Echoed in every response frame.
+ *   uint16_t command index   The command's position in the order the commands
+ *                            were registered, see FreeRTOS_CLIGetCommand().
+ *   uint16_t payload length  The number of bytes of parameters that follow.
+ *   ...      parameters      Zero or more TLVs: uint8_t type, uint8_t length,
+ *                            then length bytes of value.
+ *   uint16_t crc             CRC-16/CCITT-FALSE of all the preceding bytes.
+ *
+ * The command is answered by one or more response frames, which carry the
+ * output of the command in as many parts as the command returns:
+ *   uint8_t  sync            cliBINARY_RESPONSE_SYNC
+ *   uint8_t  sequence        The sequence number of the request.
+ *   uint8_t  status          One of the cliBINARY_STATUS_ values.
+ *   uint8_t  fragment        0 for the first response frame, then 1, 2...
+ *   uint16_t payload length  The number of bytes of output that follow.
+ *   ...      output          The text written by the command.
+ *   uint16_t crc             CRC-16/CCITT-FALSE of all the preceding bytes.
+ *
+ * The command is run by its registered pxCommandInterpreter, exactly as if
+ * the command name and the parameters had been typed, so no command needs to
+ * be changed to be used through the binary framing.
+ */
+
+/* The first byte of every request and response frame. */
+#define cliBINARY_REQUEST_SYNC                 ( ( uint8_t ) 0xA5U )
+#define cliBINARY_RESPONSE_SYNC                ( ( uint8_t ) 0x5AU )
+
+/* The size of the fixed parts of the frames. */
+#define cliBINARY_REQUEST_HEADER_LENGTH        ( 6U )
+#define cliBINARY_RESPONSE_HEADER_LENGTH       ( 6U )
+#define cliBINARY_CRC_LENGTH                   ( 2U )
+
+/* The types of TLV parameter.  A string must not contain spaces. */
+#define cliBINARY_TLV_STRING                   ( ( uint8_t ) 0x01U )
+#define cliBINARY_TLV_UINT32                   ( ( uint8_t ) 0x02U ) /* 4 bytes, passed to the command in decimal. */
+#define cliBINARY_TLV_INT32                    ( ( uint8_t ) 0x03U ) /* 4 bytes, passed to the command in decimal. */
+
+/* The status of a response frame. */
+#define cliBINARY_STATUS_OK                    ( ( uint8_t ) 0x00U ) /* The last part of the output of the command. */
+#define cliBINARY_STATUS_MORE                  ( ( uint8_t ) 0x01U ) /* More response frames follow. */
+#define cliBINARY_STATUS_BAD_FRAME             ( ( uint8_t ) 0x10U ) /* The request was too short, or its CRC was wrong. */
+#define cliBINARY_STATUS_UNKNOWN_COMMAND       ( ( uint8_t ) 0x11U ) /* No command is registered with the index. */
+#define cliBINARY_STATUS_BAD_PARAMETERS        ( ( uint8_t ) 0x12U ) /* A TLV was malformed, or the command expects a different number. */
+#define cliBINARY_STATUS_COMMAND_TOO_LONG      ( ( uint8_t ) 0x13U ) /* The command line did not fit the command buffer. */
+
+/* The prototype to which functions that send response frames to the host must
+ * comply.  pvContext is the pvWriterContext passed to FreeRTOS_CLIBinaryInit().
+ * Should return pdPASS if all xDataLength bytes were sent, otherwise pdFAIL. */
+typedef BaseType_t (* CLIBinaryWriter_t)( void * pvContext,
+                                          const uint8_t * pucData,
+                                          size_t xDataLength );
+
+/* The state of one binary command connection.  Initialise it with
+ * FreeRTOS_CLIBinaryInit(), and do not access the members directly. */
+typedef struct xCLI_BINARY_ADAPTER
+{
+    CLI_Session_t xSession;      /* The session the commands are run in. */
+    char * pcCommandBuffer;      /* The buffer in which the command line is built from a request. */
+    size_t xCommandBufferLength; /* The size, in bytes, of pcCommandBuffer. */
+    CLIBinaryWriter_t pxWriter;  /* The function that sends response frames. */
+    void * pvWriterContext;      /* Passed to pxWriter. */
+} CLI_Binary_Adapter_t;
+
+/*
+ * Initialise pxAdapter.  Command lines are built in pcCommandBuffer, the output
+ * of the commands is written to pcOutputBuffer, which limits the size of the
+ * output carried by one response frame, and response frames are sent with
+ * pxWriter.
+ */
+void FreeRTOS_CLIBinaryInit( CLI_Binary_Adapter_t * pxAdapter,
+                             char * pcCommandBuffer,
+                             size_t xCommandBufferLength,
+                             char * pcOutputBuffer,
+                             size_t xOutputBufferLength,
+                             CLIBinaryWriter_t pxWriter,
+                             void * pvWriterContext );
+
+/*
+ * Return the length of the whole request frame whose first
+ * cliBINARY_REQUEST_HEADER_LENGTH bytes are pucHeader, or 0 if pucHeader does
+ * not start with cliBINARY_REQUEST_SYNC.  Lets the receiver know how many more
+ * bytes to read before calling FreeRTOS_CLIBinaryProcessFrame().
+ */
+size_t FreeRTOS_CLIBinaryGetFrameLength( const uint8_t * pucHeader );
+
+/*
+ * Check and run the request frame pucFrame, which is xFrameLength bytes long,
+ * sending the response frames before returning.  Returns pdFAIL if the writer
+ * failed to send a response frame, otherwise pdPASS, including when the
+ * response reports an error in the request.
+ */
+BaseType_t FreeRTOS_CLIBinaryProcessFrame( CLI_Binary_Adapter_t * pxAdapter,
+                                           const uint8_t * pucFrame,
+                                           size_t xFrameLength );
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* COMMAND_INTERPRETER_BINARY_H */
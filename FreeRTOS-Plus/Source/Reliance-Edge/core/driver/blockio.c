@@ -41,6 +41,28 @@
 #include <redcore.h>
 
 
+/*  When each volume has its own lock, a task may give up the FS mutex while it
+ *  reads from its volume, so another task may access the same block device
+ *  concurrently (for example, to write back a dirty buffer it is evicting).
+ *  The block device lock serializes those accesses.
+ */
+#if REDCONF_LOCK_PER_VOLUME == 1
+    #define BDEV_LOCK( bVolNum )      RedOsBDevMutexAcquire( bVolNum )
+    #define BDEV_UNLOCK( bVolNum )    RedOsBDevMutexRelease( bVolNum )
+#else
+    #define BDEV_LOCK( bVolNum )      ( ( void ) 0 )
+    #define BDEV_UNLOCK( bVolNum )    ( ( void ) 0 )
+#endif
+
+
+#if REDCONF_READ_ONLY == 0
+    static REDSTATUS IoWriteSectors( uint8_t bVolNum,
+                                     uint64_t ullSectorStart,
+                                     uint32_t ulSectorCount,
+                                     const void * pBuffer );
+#endif
+
+
 /** @brief Read a range of logical blocks.
  *
  *  @param bVolNum      The volume whose block device is being read from.
@@ -80,14 +102,54 @@ REDSTATUS RedIoRead( uint8_t bVolNum,
         REDASSERT( bSectorShift < 32U );
         REDASSERT( ( ulSectorCount >> bSectorShift ) == ulBlockCount );
 
-        for( bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++ )
+        #if REDCONF_BDEV_XIP == 1
+            if( gaRedVolume[ bVolNum ].pbMapped != NULL )
+            {
+                /*  A memory-mapped block device is read by the CPU, so there
+                 *  is no driver request to serialize or retry.
+                 */
+                RedMemCpy( pBuffer, &gaRedVolume[ bVolNum ].pbMapped[ ( uint64_t ) ulBlockStart << BLOCK_SIZE_P2 ], ulBlockCount << BLOCK_SIZE_P2 );
+
+                #if REDCONF_STATS == 1
+                    gaRedVolStats[ bVolNum ].ulReadRequests++;
+                    gaRedVolStats[ bVolNum ].ullSectorsRead += ulSectorCount;
+                #endif
+            }
+            else
+        #endif
+        #if REDCONF_BDEV_RAM_ALIAS == 1
+            if( gaRedVolume[ bVolNum ].pbAliased != NULL )
+            {
+                /*  Likewise for a RAM disk.
+                 */
+                RedMemCpy( pBuffer, &gaRedVolume[ bVolNum ].pbAliased[ ( uint64_t ) ulBlockStart << BLOCK_SIZE_P2 ], ulBlockCount << BLOCK_SIZE_P2 );
+
+                #if REDCONF_STATS == 1
+                    gaRedVolStats[ bVolNum ].ulReadRequests++;
+                    gaRedVolStats[ bVolNum ].ullSectorsRead += ulSectorCount;
+                #endif
+            }
+            else
+        #endif
         {
-            ret = RedOsBDevRead( bVolNum, ullSectorStart, ulSectorCount, pBuffer );
+            BDEV_LOCK( bVolNum );
 
-            if( ret == 0 )
+            for( bRetryIdx = 0U; bRetryIdx <= gaRedVolConf[ bVolNum ].bBlockIoRetries; bRetryIdx++ )
             {
-                break;
+                ret = RedOsBDevRead( bVolNum, ullSectorStart, ulSectorCount, pBuffer );
+
+                if( ret == 0 )
+                {
+                    break;
+                }
             }
+
+            #if REDCONF_STATS == 1
+                gaRedVolStats[ bVolNum ].ulReadRequests++;
+                gaRedVolStats[ bVolNum ].ullSectorsRead += ulSectorCount;
+            #endif
+
+            BDEV_UNLOCK( bVolNum );
         }
     }
 
@@ -133,12 +195,111 @@ REDSTATUS RedIoRead( uint8_t bVolNum,
             uint8_t bSectorShift = gaRedVolume[ bVolNum ].bBlockSectorShift;
             uint64_t ullSectorStart = ( uint64_t ) ulBlockStart << bSectorShift;
             uint32_t ulSectorCount = ulBlockCount << bSectorShift;
-            uint8_t bRetryIdx;
 
             REDASSERT( bSectorShift < 32U );
             REDASSERT( ( ulSectorCount >> bSectorShift ) == ulBlockCount );
 
-            for( bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++ )
+            ret = IoWriteSectors( bVolNum, ullSectorStart, ulSectorCount, pBuffer );
+        }
+
+        return ret;
+    }
+
+
+    #if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+/** @brief Write a range of sectors.
+ *
+ *  Used for structures, like the intent log, which are written in units
+ *  smaller than a logical block.
+ *
+ *  @param bVolNum          The volume whose block device is being written to.
+ *  @param ullSectorStart   The first sector to write.
+ *  @param ulSectorCount    The number of sectors to write.
+ *  @param pBuffer          The buffer containing the data to write.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+        REDSTATUS RedIoSectorWrite( uint8_t bVolNum,
+                                    uint64_t ullSectorStart,
+                                    uint32_t ulSectorCount,
+                                    const void * pBuffer )
+        {
+            REDSTATUS ret;
+
+            if( bVolNum >= REDCONF_VOLUME_COUNT )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                uint64_t ullVolSectors = ( uint64_t ) gaRedVolume[ bVolNum ].ulBlockCount << gaRedVolume[ bVolNum ].bBlockSectorShift;
+
+                if( ( ullSectorStart >= ullVolSectors ) ||
+                    ( ( ullVolSectors - ullSectorStart ) < ulSectorCount ) ||
+                    ( ulSectorCount == 0U ) ||
+                    ( pBuffer == NULL ) )
+                {
+                    REDERROR();
+                    ret = -RED_EINVAL;
+                }
+                else
+                {
+                    ret = IoWriteSectors( bVolNum, ullSectorStart, ulSectorCount, pBuffer );
+                }
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_INTENT_LOG_BLOCKS > 0U */
+
+
+/** @brief Write a range of sectors to the block device, retrying on failure.
+ *
+ *  @param bVolNum          The volume whose block device is being written to.
+ *  @param ullSectorStart   The first sector to write.
+ *  @param ulSectorCount    The number of sectors to write.
+ *  @param pBuffer          The buffer containing the data to write.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+    static REDSTATUS IoWriteSectors( uint8_t bVolNum,
+                                     uint64_t ullSectorStart,
+                                     uint32_t ulSectorCount,
+                                     const void * pBuffer )
+    {
+        REDSTATUS ret = 0;
+        uint8_t bRetryIdx;
+
+        #if REDCONF_BDEV_RAM_ALIAS == 1
+            if( gaRedVolume[ bVolNum ].pbAliased != NULL )
+            {
+                /*  A RAM disk is written by the CPU, so there is no driver
+                 *  request to serialize or retry.
+                 */
+                uint32_t ulSectorSize = gaRedVolConf[ bVolNum ].ulSectorSize;
+
+                RedMemCpy( &gaRedVolume[ bVolNum ].pbAliased[ ullSectorStart * ulSectorSize ], pBuffer, ulSectorCount * ulSectorSize );
+
+                #if REDCONF_STATS == 1
+                    gaRedVolStats[ bVolNum ].ulWriteRequests++;
+                    gaRedVolStats[ bVolNum ].ullSectorsWritten += ulSectorCount;
+                #endif
+            }
+            else
+        #endif
+        {
+            BDEV_LOCK( bVolNum );
+
+            for( bRetryIdx = 0U; bRetryIdx <= gaRedVolConf[ bVolNum ].bBlockIoRetries; bRetryIdx++ )
             {
                 ret = RedOsBDevWrite( bVolNum, ullSectorStart, ulSectorCount, pBuffer );
 
@@ -147,6 +308,13 @@ REDSTATUS RedIoRead( uint8_t bVolNum,
                     break;
                 }
             }
+
+            #if REDCONF_STATS == 1
+                gaRedVolStats[ bVolNum ].ulWriteRequests++;
+                gaRedVolStats[ bVolNum ].ullSectorsWritten += ulSectorCount;
+            #endif
+
+            BDEV_UNLOCK( bVolNum );
         }
 
         CRITICAL_ASSERT( ret == 0 );
@@ -179,7 +347,9 @@ REDSTATUS RedIoRead( uint8_t bVolNum,
         {
             uint8_t bRetryIdx;
 
-            for( bRetryIdx = 0U; bRetryIdx <= gpRedVolConf->bBlockIoRetries; bRetryIdx++ )
+            BDEV_LOCK( bVolNum );
+
+            for( bRetryIdx = 0U; bRetryIdx <= gaRedVolConf[ bVolNum ].bBlockIoRetries; bRetryIdx++ )
             {
                 ret = RedOsBDevFlush( bVolNum );
 
@@ -188,10 +358,188 @@ REDSTATUS RedIoRead( uint8_t bVolNum,
                     break;
                 }
             }
+
+            #if REDCONF_STATS == 1
+                gaRedVolStats[ bVolNum ].ulFlushRequests++;
+            #endif
+
+            BDEV_UNLOCK( bVolNum );
         }
 
         CRITICAL_ASSERT( ret == 0 );
 
         return ret;
     }
+
+
+    #if REDCONF_DISCARDS == 1
+
+/** @brief Tell the block device that a range of logical blocks is unused.
+ *
+ *  Unlike the other block I/O functions, failure here is not a critical
+ *  error: a discard is only a hint, and the blocks are already free on disk.
+ *
+ *  @param bVolNum      The volume whose block device is being discarded.
+ *  @param ulBlockStart The first block to discard.
+ *  @param ulBlockCount The number of blocks to discard.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL Invalid parameters.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOSYS The block device does not support discards.
+ */
+        REDSTATUS RedIoDiscard( uint8_t bVolNum,
+                                uint32_t ulBlockStart,
+                                uint32_t ulBlockCount )
+        {
+            REDSTATUS ret;
+
+            if( ( bVolNum >= REDCONF_VOLUME_COUNT ) ||
+                ( ulBlockStart >= gaRedVolume[ bVolNum ].ulBlockCount ) ||
+                ( ( gaRedVolume[ bVolNum ].ulBlockCount - ulBlockStart ) < ulBlockCount ) ||
+                ( ulBlockCount == 0U ) )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                uint8_t bSectorShift = gaRedVolume[ bVolNum ].bBlockSectorShift;
+                uint64_t ullSectorStart = ( uint64_t ) ulBlockStart << bSectorShift;
+                uint64_t ullSectorCount = ( uint64_t ) ulBlockCount << bSectorShift;
+
+                BDEV_LOCK( bVolNum );
+
+                ret = RedOsBDevDiscard( bVolNum, ullSectorStart, ullSectorCount );
+
+                #if REDCONF_STATS == 1
+                    if( ret == 0 )
+                    {
+                        gaRedVolStats[ bVolNum ].ulDiscardRequests++;
+                        gaRedVolStats[ bVolNum ].ullSectorsDiscarded += ullSectorCount;
+                    }
+                #endif
+
+                BDEV_UNLOCK( bVolNum );
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_DISCARDS == 1 */
+
+
+    #if REDCONF_BDEV_ASYNC_DEPTH > 0U
+
+/** @brief Start an asynchronous write of a range of logical blocks.
+ *
+ *  If this function succeeds, RedIoWriteFinish() must be called for @p pReq
+ *  before the request or the buffer is reused.
+ *
+ *  @param bVolNum      The volume whose block device is being written to.
+ *  @param ulBlockStart The first block to write.
+ *  @param ulBlockCount The number of blocks to write.
+ *  @param pBuffer      The buffer containing the data to write.
+ *  @param pReq         The request structure to use for the write.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+        REDSTATUS RedIoWriteStart( uint8_t bVolNum,
+                                   uint32_t ulBlockStart,
+                                   uint32_t ulBlockCount,
+                                   void * pBuffer,
+                                   BDEVREQ * pReq )
+        {
+            REDSTATUS ret;
+
+            if( ( bVolNum >= REDCONF_VOLUME_COUNT ) ||
+                ( ulBlockStart >= gaRedVolume[ bVolNum ].ulBlockCount ) ||
+                ( ( gaRedVolume[ bVolNum ].ulBlockCount - ulBlockStart ) < ulBlockCount ) ||
+                ( ulBlockCount == 0U ) ||
+                ( pBuffer == NULL ) ||
+                ( pReq == NULL ) )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                uint8_t bSectorShift = gaRedVolume[ bVolNum ].bBlockSectorShift;
+
+                REDASSERT( bSectorShift < 32U );
+
+                pReq->ullSectorStart = ( uint64_t ) ulBlockStart << bSectorShift;
+                pReq->ulSectorCount = ulBlockCount << bSectorShift;
+                pReq->pBuffer = pBuffer;
+                pReq->fWrite = true;
+                pReq->pfnComplete = NULL;
+                pReq->pContext = NULL;
+
+                REDASSERT( ( pReq->ulSectorCount >> bSectorShift ) == ulBlockCount );
+
+                BDEV_LOCK( bVolNum );
+                ret = RedOsBDevSubmit( bVolNum, pReq );
+
+                #if REDCONF_STATS == 1
+                    gaRedVolStats[ bVolNum ].ulWriteRequests++;
+                    gaRedVolStats[ bVolNum ].ullSectorsWritten += pReq->ulSectorCount;
+                #endif
+
+                BDEV_UNLOCK( bVolNum );
+            }
+
+            CRITICAL_ASSERT( ret == 0 );
+
+            return ret;
+        }
+
+
+/** @brief Wait for an asynchronous write started by RedIoWriteStart().
+ *
+ *  If the write failed and bBlockIoRetries is greater than 0 for the volume,
+ *  the write is retried synchronously.
+ *
+ *  @param bVolNum  The volume whose block device is being written to.
+ *  @param pReq     The request passed to RedIoWriteStart().
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+        REDSTATUS RedIoWriteFinish( uint8_t bVolNum,
+                                    BDEVREQ * pReq )
+        {
+            REDSTATUS ret;
+
+            if( ( bVolNum >= REDCONF_VOLUME_COUNT ) || ( pReq == NULL ) )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                uint8_t bRetryIdx;
+
+                ret = RedOsBDevWait( pReq );
+
+                for( bRetryIdx = 0U; ( ret != 0 ) && ( bRetryIdx < gaRedVolConf[ bVolNum ].bBlockIoRetries ); bRetryIdx++ )
+                {
+                    BDEV_LOCK( bVolNum );
+                    ret = RedOsBDevWrite( bVolNum, pReq->ullSectorStart, pReq->ulSectorCount, pReq->pBuffer );
+                    BDEV_UNLOCK( bVolNum );
+                }
+            }
+
+            CRITICAL_ASSERT( ret == 0 );
+
+            return ret;
+        }
+    #endif /* REDCONF_BDEV_ASYNC_DEPTH > 0U */
 #endif /* REDCONF_READ_ONLY == 0 */
@@ -33,6 +33,17 @@
  *  volumes).  Block buffers may be either dirty or clean.  Most I/O passes
  *  through this module.  When a buffer is needed for a block which is not in
  *  the cache, a "victim" is selected via a simple LRU scheme.
+ *
+ *  By default, buffers are found by scanning the buffer heads and the LRU order
+ *  is kept in an array of buffer indices.  Both are linear in the number of
+ *  buffers, which is fine for the small buffer counts typical of embedded
+ *  systems.  When REDCONF_BUFFER_HASH is enabled, buffers are instead found via
+ *  an open-addressed hash table and the LRU order is kept in a doubly linked
+ *  list, so large buffer caches can be used without per-access linear costs.
+ *
+ *  When REDCONF_BDEV_RAM_ALIAS is enabled and the volume is on a RAM disk,
+ *  file data blocks are not buffered at all: the "buffer" handed out for such
+ *  a block is the block in the RAM disk itself.
  */
 #include <redfs.h>
 #include <redcore.h>
@@ -82,16 +93,36 @@
  *  buffer, and an imap buffer.
  *
  *  Unlink is the same, since the parent inode buffers are released before
- *  the inode is deleted.
+ *  the inode is deleted.  So is red_copy(), which holds the data buffer of
+ *  the source while writing the destination.
  */
         #define MINIMUM_BUFFER_COUNT    ( INODE_BUFFERS + 1U + IMAP_BUFFERS )
     #endif /* if REDCONF_API_POSIX_RENAME == 1 */
 #endif /* if ( REDCONF_READ_ONLY == 1 ) || ( REDCONF_API_FSE == 1 ) */
 
-#if REDCONF_BUFFER_COUNT < MINIMUM_BUFFER_COUNT
+/*  Buffers lent out by red_readbuf() stay referenced between operations, so
+ *  they are unavailable to the operations counted below.
+ */
+#define LENT_BUFFER_COUNT    REDCONF_READBUF_COUNT
+
+#if REDCONF_BUFFER_COUNT < ( MINIMUM_BUFFER_COUNT + LENT_BUFFER_COUNT )
     #error "REDCONF_BUFFER_COUNT is too low for the configuration"
 #endif
 
+/*  With a lock per volume, an operation on each volume may be in progress at
+ *  the same time, each holding up to MINIMUM_BUFFER_COUNT buffers.
+ */
+#if ( REDCONF_LOCK_PER_VOLUME == 1 ) && ( REDCONF_BUFFER_COUNT < ( ( MINIMUM_BUFFER_COUNT * REDCONF_VOLUME_COUNT ) + LENT_BUFFER_COUNT ) )
+    #error "REDCONF_BUFFER_COUNT is too low for the configuration: with REDCONF_LOCK_PER_VOLUME, each volume needs its own set of buffers"
+#endif
+
+/*  With shared readers, up to REDCONF_LOCK_SHARED_READERS reads may be in
+ *  progress on each volume, each holding up to INODE_BUFFERS buffers.
+ */
+#if ( REDCONF_LOCK_SHARED_READERS > 0U ) && ( REDCONF_BUFFER_COUNT < ( ( INODE_BUFFERS * REDCONF_LOCK_SHARED_READERS * REDCONF_VOLUME_COUNT ) + LENT_BUFFER_COUNT ) )
+    #error "REDCONF_BUFFER_COUNT is too low for the configuration: with REDCONF_LOCK_SHARED_READERS, each reader needs its own set of buffers"
+#endif
+
 
 /*  A note on the typecasts in the below macros: Operands to bitwise operators
  *  are subject to the "usual arithmetic conversions".  This means that the
@@ -110,6 +141,46 @@
 #define BBLK_INVALID    UINT32_MAX
 
 
+/*  Whether buffer flushes keep several asynchronous writes in flight.
+ *  Coalesced flushes are written through a single staging buffer, so they
+ *  remain synchronous.
+ */
+#define BUFFER_FLUSH_ASYNC    ( ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_FLUSH_COALESCE_BLOCKS == 0U ) && ( REDCONF_BDEV_ASYNC_DEPTH > 0U ) )
+
+
+#if REDCONF_BUFFER_HASH == 1
+
+/*  Number of slots in the buffer hash table, as a power of two.  The table
+ *  always has at least twice as many slots as there are buffers, which keeps
+ *  the linear probe sequences short.
+ */
+    #if REDCONF_BUFFER_COUNT <= 4U
+        #define BUFFER_HASH_SHIFT    3U
+    #elif REDCONF_BUFFER_COUNT <= 8U
+        #define BUFFER_HASH_SHIFT    4U
+    #elif REDCONF_BUFFER_COUNT <= 16U
+        #define BUFFER_HASH_SHIFT    5U
+    #elif REDCONF_BUFFER_COUNT <= 32U
+        #define BUFFER_HASH_SHIFT    6U
+    #elif REDCONF_BUFFER_COUNT <= 64U
+        #define BUFFER_HASH_SHIFT    7U
+    #elif REDCONF_BUFFER_COUNT <= 128U
+        #define BUFFER_HASH_SHIFT    8U
+    #else
+        #define BUFFER_HASH_SHIFT    9U
+    #endif
+
+    #define BUFFER_HASH_SLOTS        ( 1U << BUFFER_HASH_SHIFT )
+    #define BUFFER_HASH_MASK         ( BUFFER_HASH_SLOTS - 1U )
+
+/*  An invalid buffer index.  Used to mark empty hash table slots and the ends
+ *  of the LRU list.  REDCONF_BUFFER_COUNT is at most 255, so this value is
+ *  never a valid buffer index.
+ */
+    #define BIDX_INVALID             UINT8_MAX
+#endif /* REDCONF_BUFFER_HASH == 1 */
+
+
 /** @brief Metadata stored for each block buffer.
  *
  *  To make better use of CPU caching when searching the BUFFERHEAD array, this
@@ -132,13 +203,32 @@ typedef struct
      */
     uint16_t uNumUsed;
 
-    /** MRU array.  Each element of the array stores a buffer index; each buffer
-     *  index appears in the array once and only once.  The first element of the
-     *  array is the most-recently-used (MRU) buffer, followed by the next most
-     *  recently used, and so on, till the last element, which is the least-
-     *  recently-used (LRU) buffer.
-     */
-    uint8_t abMRU[ REDCONF_BUFFER_COUNT ];
+    #if REDCONF_BUFFER_HASH == 1
+
+        /** Hash table of valid buffers.  Each slot stores either a buffer index
+         *  or BIDX_INVALID.  Collisions are resolved by linear probing.
+         */
+        uint8_t abHash[ BUFFER_HASH_SLOTS ];
+
+        /** LRU list links.  Each element stores the index of the next more
+         *  recently used (abPrev) or less recently used (abNext) buffer, or
+         *  BIDX_INVALID at either end of the list.
+         */
+        uint8_t abPrev[ REDCONF_BUFFER_COUNT ];
+        uint8_t abNext[ REDCONF_BUFFER_COUNT ];
+
+        uint8_t bMRU; /**< Index of the most recently used buffer. */
+        uint8_t bLRU; /**< Index of the least recently used buffer. */
+    #else
+
+        /** MRU array.  Each element of the array stores a buffer index; each
+         *  buffer index appears in the array once and only once.  The first
+         *  element of the array is the most-recently-used (MRU) buffer,
+         *  followed by the next most recently used, and so on, till the last
+         *  element, which is the least-recently-used (LRU) buffer.
+         */
+        uint8_t abMRU[ REDCONF_BUFFER_COUNT ];
+    #endif
 
     /** Buffer heads, storing metadata for each buffer.
      */
@@ -150,6 +240,29 @@ typedef struct
      *  to cast buffer pointers to node structure pointers.
      */
     ALIGNED_2D_BYTE_ARRAY( b, aabBuffer, REDCONF_BUFFER_COUNT, REDCONF_BLOCK_SIZE );
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_FLUSH_COALESCE_BLOCKS > 0U )
+
+        /** Indices of the dirty buffers being flushed, in block order.
+         */
+        uint8_t abFlush[ REDCONF_BUFFER_COUNT ];
+
+        /** Staging buffer into which runs of contiguous dirty blocks are
+         *  gathered, so that each run is written with one request.
+         */
+        ALIGNED_2D_BYTE_ARRAY( s, aabStage, REDCONF_FLUSH_COALESCE_BLOCKS, REDCONF_BLOCK_SIZE );
+    #endif
+
+    #if BUFFER_FLUSH_ASYNC
+
+        /** Asynchronous write requests used when flushing.
+         */
+        BDEVREQ aReq[ REDCONF_BDEV_ASYNC_DEPTH ];
+
+        /** Index of the buffer being written by each request in aReq.
+         */
+        uint8_t abReqBuf[ REDCONF_BDEV_ASYNC_DEPTH ];
+    #endif
 } BUFFERCTX;
 
 
@@ -157,15 +270,66 @@ static bool BufferIsValid( const uint8_t * pbBuffer,
                            uint16_t uFlags );
 static bool BufferToIdx( const void * pBuffer,
                          uint8_t * pbIdx );
+#if REDCONF_BDEV_XIP == 1
+    static bool BufferIsMapped( const void * pBuffer );
+#endif
+#if REDCONF_BDEV_RAM_ALIAS == 1
+    static bool BufferIsAliased( const void * pBuffer );
+#endif
+#if REDCONF_LOCK_PER_VOLUME == 1
+    static REDSTATUS BufferReadUnlocked( uint8_t bIdx,
+                                         uint32_t ulBlock );
+#endif
 #if REDCONF_READ_ONLY == 0
     static REDSTATUS BufferWrite( uint8_t bIdx );
     static REDSTATUS BufferFinalize( uint8_t * pbBuffer,
+                                     uint8_t bVolNum,
                                      uint16_t uFlags );
+    #if REDCONF_FLUSH_COALESCE_BLOCKS > 0U
+        static REDSTATUS BufferFlushCoalesced( uint32_t ulBlockStart,
+                                               uint32_t ulBlockCount );
+        static REDSTATUS BufferWriteRun( uint32_t ulFirst,
+                                         uint32_t ulCount );
+    #endif
+    #if BUFFER_FLUSH_ASYNC
+        static REDSTATUS BufferFlushAsync( uint32_t ulBlockStart,
+                                           uint32_t ulBlockCount );
+        static REDSTATUS BufferWriteStart( uint8_t bIdx,
+                                           uint32_t ulReq );
+        static REDSTATUS BufferWriteFinish( uint32_t ulReq );
+    #endif
 #endif
 static void BufferMakeLRU( uint8_t bIdx );
 static void BufferMakeMRU( uint8_t bIdx );
+static uint8_t BufferChooseVictim( uint16_t uFlags );
+static uint8_t BufferFindVictim( bool fSkipMeta,
+                                 const bool * pafSkipVol );
+static bool BufferIsSkipped( uint8_t bIdx,
+                             bool fSkipMeta,
+                             const bool * pafSkipVol );
+static bool BufferHoldsMeta( uint8_t bIdx );
+#if REDCONF_BUFFER_VOL_RESERVE == 1
+    static bool BufferVolReserved( bool * pafReserved );
+#endif
+#if REDCONF_BUFFER_META_RESERVE > 0U
+    static uint32_t BufferMetaCount( void );
+#endif
 static bool BufferFind( uint32_t ulBlock,
                         uint8_t * pbIdx );
+static bool BufferNextInRange( uint32_t ulBlockStart,
+                               uint32_t ulBlockCount,
+                               uint32_t * pulCursor,
+                               uint8_t * pbIdx );
+static void BufferSetBlock( uint8_t bIdx,
+                            uint8_t bVolNum,
+                            uint32_t ulBlock );
+#if REDCONF_BUFFER_HASH == 1
+    static uint32_t BufferHashSlot( uint8_t bVolNum,
+                                    uint32_t ulBlock );
+    static void BufferHashInsert( uint8_t bIdx );
+    static void BufferHashRemove( uint8_t bIdx );
+    static void BufferListUnlink( uint8_t bIdx );
+#endif
 
 #ifdef REDCONF_ENDIAN_SWAP
     static void BufferEndianSwap( const void * pBuffer,
@@ -189,14 +353,32 @@ void RedBufferInit( void )
 
     RedMemSet( &gBufCtx, 0U, sizeof( gBufCtx ) );
 
-    for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
-    {
+    #if REDCONF_BUFFER_HASH == 1
+        RedMemSet( gBufCtx.abHash, BIDX_INVALID, sizeof( gBufCtx.abHash ) );
+
         /*  When the buffers have been freshly initialized, acquire the buffers
-         *  in the order in which they appear in the array.
+         *  in the order in which they appear in the array: buffer zero is the
+         *  LRU buffer and the last buffer is the MRU buffer.
          */
-        gBufCtx.abMRU[ bIdx ] = ( uint8_t ) ( ( REDCONF_BUFFER_COUNT - bIdx ) - 1U );
-        gBufCtx.aHead[ bIdx ].ulBlock = BBLK_INVALID;
-    }
+        for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
+        {
+            gBufCtx.abPrev[ bIdx ] = ( bIdx == ( REDCONF_BUFFER_COUNT - 1U ) ) ? BIDX_INVALID : ( uint8_t ) ( bIdx + 1U );
+            gBufCtx.abNext[ bIdx ] = ( bIdx == 0U ) ? BIDX_INVALID : ( uint8_t ) ( bIdx - 1U );
+            gBufCtx.aHead[ bIdx ].ulBlock = BBLK_INVALID;
+        }
+
+        gBufCtx.bMRU = ( uint8_t ) ( REDCONF_BUFFER_COUNT - 1U );
+        gBufCtx.bLRU = 0U;
+    #else
+        for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
+        {
+            /*  When the buffers have been freshly initialized, acquire the
+             *  buffers in the order in which they appear in the array.
+             */
+            gBufCtx.abMRU[ bIdx ] = ( uint8_t ) ( ( REDCONF_BUFFER_COUNT - bIdx ) - 1U );
+            gBufCtx.aHead[ bIdx ].ulBlock = BBLK_INVALID;
+        }
+    #endif /* if REDCONF_BUFFER_HASH == 1 */
 }
 
 
@@ -225,10 +407,43 @@ REDSTATUS RedBufferGet( uint32_t ulBlock,
         REDERROR();
         ret = -RED_EINVAL;
     }
+
+    #if REDCONF_BDEV_XIP == 1
+        else if( ( gpRedVolume->pbMapped != NULL ) && ( ( uFlags & BFLAG_META ) == 0U ) )
+        {
+            /*  File data on a memory-mapped volume is used in place: no buffer
+             *  is taken and nothing is copied.  Metadata still goes through the
+             *  buffers, so that it is validated once when it is read.
+             */
+            *ppBuffer = CAST_AWAY_CONST_UINT8_PTR( &gpRedVolume->pbMapped[ ( uint64_t ) ulBlock << BLOCK_SIZE_P2 ] );
+        }
+    #endif
+    #if REDCONF_BDEV_RAM_ALIAS == 1
+        else if( ( gpRedVolume->pbAliased != NULL ) && ( ( uFlags & BFLAG_META ) == 0U ) )
+        {
+            /*  File data on a RAM disk is used in place, and changed in place:
+             *  the block is only ever one which is not part of the committed
+             *  state, since committed blocks are branched (copied elsewhere)
+             *  with RedBufferAliasBranch() before they are changed.
+             */
+            uint8_t * pbBlock = &gpRedVolume->pbAliased[ ( uint64_t ) ulBlock << BLOCK_SIZE_P2 ];
+
+            if( ( uFlags & BFLAG_NEW ) != 0U )
+            {
+                RedMemSet( pbBlock, 0U, REDCONF_BLOCK_SIZE );
+            }
+
+            *ppBuffer = pbBlock;
+        }
+    #endif
     else
     {
         if( BufferFind( ulBlock, &bIdx ) )
         {
+            #if REDCONF_STATS == 1
+                gaRedVolStats[ gbRedVolNum ].ulBufferHits++;
+            #endif
+
             /*  Error if the buffer exists and BFLAG_NEW was specified, since
              *  the new flag is used when a block is newly allocated/created, so
              *  the block was previously free and and there should never be an
@@ -256,22 +471,22 @@ REDSTATUS RedBufferGet( uint32_t ulBlock,
         {
             BUFFERHEAD * pHead;
 
-            /*  Search for the least recently used buffer which is not
-             *  referenced.
-             */
-            for( bIdx = ( uint8_t ) ( REDCONF_BUFFER_COUNT - 1U ); bIdx > 0U; bIdx-- )
-            {
-                if( gBufCtx.aHead[ gBufCtx.abMRU[ bIdx ] ].bRefCount == 0U )
-                {
-                    break;
-                }
-            }
+            #if REDCONF_LOCK_SHARED_READERS > 0U
+                uint8_t bOtherIdx;
+            #endif
 
-            bIdx = gBufCtx.abMRU[ bIdx ];
+            bIdx = BufferChooseVictim( uFlags );
             pHead = &gBufCtx.aHead[ bIdx ];
 
             if( pHead->bRefCount == 0U )
             {
+                #if REDCONF_STATS == 1
+                    if( ( pHead->ulBlock != BBLK_INVALID ) && ( pHead->bVolNum != gbRedVolNum ) )
+                    {
+                        gaRedVolStats[ pHead->bVolNum ].ulBuffersLost++;
+                    }
+                #endif
+
                 /*  If the LRU buffer is valid and dirty, write it out before
                  *  repurposing it.
                  */
@@ -281,6 +496,10 @@ REDSTATUS RedBufferGet( uint32_t ulBlock,
                         CRITICAL_ERROR();
                         ret = -RED_EFUBAR;
                     #else
+                        #if REDCONF_STATS == 1
+                            gaRedVolStats[ pHead->bVolNum ].ulBufferWritebacks++;
+                        #endif
+
                         ret = BufferWrite( bIdx );
                     #endif
                 }
@@ -307,9 +526,17 @@ REDSTATUS RedBufferGet( uint32_t ulBlock,
                      *  buffer were to be used subsequently with its partially
                      *  erroneous contents, bad things could happen.
                      */
-                    pHead->ulBlock = BBLK_INVALID;
+                    BufferSetBlock( bIdx, pHead->bVolNum, BBLK_INVALID );
+
+                    #if REDCONF_STATS == 1
+                        gaRedVolStats[ gbRedVolNum ].ulBufferMisses++;
+                    #endif
 
-                    ret = RedIoRead( gbRedVolNum, ulBlock, 1U, gBufCtx.b.aabBuffer[ bIdx ] );
+                    #if REDCONF_LOCK_PER_VOLUME == 1
+                        ret = BufferReadUnlocked( bIdx, ulBlock );
+                    #else
+                        ret = RedIoRead( gbRedVolNum, ulBlock, 1U, gBufCtx.b.aabBuffer[ bIdx ] );
+                    #endif
 
                     if( ( ret == 0 ) && ( ( uFlags & BFLAG_META ) != 0U ) )
                     {
@@ -339,10 +566,22 @@ REDSTATUS RedBufferGet( uint32_t ulBlock,
                 }
             }
 
+            #if REDCONF_LOCK_SHARED_READERS > 0U
+                if( ( ret == 0 ) && ( ( uFlags & BFLAG_NEW ) == 0U ) && BufferFind( ulBlock, &bOtherIdx ) )
+                {
+                    /*  Another reader of this volume read the same block while
+                     *  the FS mutex was released.  Nothing can have written the
+                     *  block meanwhile, so use that buffer and leave this one
+                     *  invalid.
+                     */
+                    BufferMakeLRU( bIdx );
+                    bIdx = bOtherIdx;
+                }
+                else
+            #endif
             if( ret == 0 )
             {
-                pHead->bVolNum = gbRedVolNum;
-                pHead->ulBlock = ulBlock;
+                BufferSetBlock( bIdx, gbRedVolNum, ulBlock );
                 pHead->uFlags = 0U;
             }
         }
@@ -387,6 +626,23 @@ void RedBufferPut( const void * pBuffer )
 {
     uint8_t bIdx;
 
+    #if REDCONF_BDEV_XIP == 1
+        if( BufferIsMapped( pBuffer ) )
+        {
+            /*  Blocks used in place on a memory-mapped volume are not
+             *  referenced, so there is nothing to release.
+             */
+        }
+        else
+    #endif
+    #if REDCONF_BDEV_RAM_ALIAS == 1
+        if( BufferIsAliased( pBuffer ) )
+        {
+            /*  Likewise for blocks used in place on a RAM disk.
+             */
+        }
+        else
+    #endif
     if( !BufferToIdx( pBuffer, &bIdx ) )
     {
         REDERROR();
@@ -405,6 +661,31 @@ void RedBufferPut( const void * pBuffer )
 }
 
 
+#if REDCONF_INODE_INLINE == 1
+
+/** @brief Take another reference to a buffer which is already referenced.
+ *
+ *  The extra reference is released with RedBufferPut(), like any other.
+ *
+ *  @param pBuffer  The buffer to reference.
+ */
+    void RedBufferReference( const void * pBuffer )
+    {
+        uint8_t bIdx;
+
+        if( !BufferToIdx( pBuffer, &bIdx ) )
+        {
+            REDERROR();
+        }
+        else
+        {
+            REDASSERT( gBufCtx.aHead[ bIdx ].bRefCount > 0U );
+            gBufCtx.aHead[ bIdx ].bRefCount++;
+        }
+    }
+#endif /* REDCONF_INODE_INLINE == 1 */
+
+
 #if REDCONF_READ_ONLY == 0
 
 /** @brief Flush all buffers for the active volume in the given range of blocks.
@@ -433,30 +714,33 @@ void RedBufferPut( const void * pBuffer )
         }
         else
         {
-            uint8_t bIdx;
-
-            for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
-            {
-                BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
-
-                if( ( pHead->bVolNum == gbRedVolNum ) &&
-                    ( pHead->ulBlock != BBLK_INVALID ) &&
-                    ( ( pHead->uFlags & BFLAG_DIRTY ) != 0U ) &&
-                    ( pHead->ulBlock >= ulBlockStart ) &&
-                    ( pHead->ulBlock < ( ulBlockStart + ulBlockCount ) ) )
+            #if REDCONF_FLUSH_COALESCE_BLOCKS > 0U
+                ret = BufferFlushCoalesced( ulBlockStart, ulBlockCount );
+            #elif BUFFER_FLUSH_ASYNC
+                ret = BufferFlushAsync( ulBlockStart, ulBlockCount );
+            #else
+                uint32_t ulCursor = 0U;
+                uint8_t bIdx;
+
+                while( BufferNextInRange( ulBlockStart, ulBlockCount, &ulCursor, &bIdx ) )
                 {
-                    ret = BufferWrite( bIdx );
+                    BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
 
-                    if( ret == 0 )
-                    {
-                        pHead->uFlags &= ( ~BFLAG_DIRTY );
-                    }
-                    else
+                    if( ( pHead->uFlags & BFLAG_DIRTY ) != 0U )
                     {
-                        break;
+                        ret = BufferWrite( bIdx );
+
+                        if( ret == 0 )
+                        {
+                            pHead->uFlags &= ( ~BFLAG_DIRTY );
+                        }
+                        else
+                        {
+                            break;
+                        }
                     }
                 }
-            }
+            #endif /* if REDCONF_FLUSH_COALESCE_BLOCKS > 0U */
         }
 
         return ret;
@@ -471,6 +755,15 @@ void RedBufferPut( const void * pBuffer )
     {
         uint8_t bIdx;
 
+        #if REDCONF_BDEV_RAM_ALIAS == 1
+            if( BufferIsAliased( pBuffer ) )
+            {
+                /*  Blocks used in place on a RAM disk are written as they are
+                 *  changed, so they are never dirty.
+                 */
+            }
+            else
+        #endif
         if( !BufferToIdx( pBuffer, &bIdx ) )
         {
             REDERROR();
@@ -507,11 +800,43 @@ void RedBufferPut( const void * pBuffer )
             REDASSERT( ( pHead->uFlags & BFLAG_DIRTY ) == 0U );
 
             pHead->uFlags |= BFLAG_DIRTY;
-            pHead->ulBlock = ulBlockNew;
+            BufferSetBlock( bIdx, pHead->bVolNum, ulBlockNew );
         }
     }
 
 
+    #if REDCONF_BDEV_RAM_ALIAS == 1
+
+/** @brief Branch a file data block which is used in place on a RAM disk.
+ *
+ *  Unlike a buffer, a block used in place cannot be given a new block number,
+ *  so its data is copied to the new block, which is then used in place.  The
+ *  committed block is not changed.  This is the only copy made of file data
+ *  on a RAM disk.
+ *
+ *  @param ppBuffer     On entry, the block to branch, as returned by
+ *                      RedBufferGet().  On exit, the branched block.
+ *  @param ulBlockNew   The new block number for the data.
+ */
+        void RedBufferAliasBranch( void ** ppBuffer,
+                                   uint32_t ulBlockNew )
+        {
+            if( ( ppBuffer == NULL ) || !BufferIsAliased( *ppBuffer ) ||
+                ( ulBlockNew >= gpRedVolume->ulBlockCount ) )
+            {
+                REDERROR();
+            }
+            else
+            {
+                uint8_t * pbBlockNew = &gpRedVolume->pbAliased[ ( uint64_t ) ulBlockNew << BLOCK_SIZE_P2 ];
+
+                RedMemCpy( pbBlockNew, *ppBuffer, REDCONF_BLOCK_SIZE );
+                *ppBuffer = pbBlockNew;
+            }
+        }
+    #endif /* REDCONF_BDEV_RAM_ALIAS == 1 */
+
+
     #if ( REDCONF_API_POSIX == 1 ) || FORMAT_SUPPORTED
 
 /** @brief Discard a buffer, releasing it and marking it invalid.
@@ -532,7 +857,7 @@ void RedBufferPut( const void * pBuffer )
                 REDASSERT( gBufCtx.uNumUsed > 0U );
 
                 gBufCtx.aHead[ bIdx ].bRefCount = 0U;
-                gBufCtx.aHead[ bIdx ].ulBlock = BBLK_INVALID;
+                BufferSetBlock( bIdx, gBufCtx.aHead[ bIdx ].bVolNum, BBLK_INVALID );
 
                 gBufCtx.uNumUsed--;
 
@@ -569,43 +894,38 @@ REDSTATUS RedBufferDiscardRange( uint32_t ulBlockStart,
     }
     else
     {
+        uint32_t ulCursor = 0U;
         uint8_t bIdx;
 
-        for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
+        while( BufferNextInRange( ulBlockStart, ulBlockCount, &ulCursor, &bIdx ) )
         {
             BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
 
-            if( ( pHead->bVolNum == gbRedVolNum ) &&
-                ( pHead->ulBlock != BBLK_INVALID ) &&
-                ( pHead->ulBlock >= ulBlockStart ) &&
-                ( pHead->ulBlock < ( ulBlockStart + ulBlockCount ) ) )
+            if( pHead->bRefCount == 0U )
             {
-                if( pHead->bRefCount == 0U )
-                {
-                    pHead->ulBlock = BBLK_INVALID;
+                BufferSetBlock( bIdx, pHead->bVolNum, BBLK_INVALID );
 
-                    BufferMakeLRU( bIdx );
-                }
-                else
-                {
-                    /*  This should never happen.  There are three general cases
-                     *  when this function is used:
-                     *
-                     *  1) Discarding every block, as happens during unmount
-                     *     and at the end of format.  There should no longer be
-                     *     any referenced buffers at those points.
-                     *  2) Discarding a block which has become free.  All
-                     *     buffers for such blocks should be put or branched
-                     *     beforehand.
-                     *  3) Discarding of blocks that were just written straight
-                     *     to disk, leaving stale data in the buffer.  The write
-                     *     code should never reference buffers for these blocks,
-                     *     since they would not be needed or used.
-                     */
-                    CRITICAL_ERROR();
-                    ret = -RED_EBUSY;
-                    break;
-                }
+                BufferMakeLRU( bIdx );
+            }
+            else
+            {
+                /*  This should never happen.  There are three general cases
+                 *  when this function is used:
+                 *
+                 *  1) Discarding every block, as happens during unmount
+                 *     and at the end of format.  There should no longer be
+                 *     any referenced buffers at those points.
+                 *  2) Discarding a block which has become free.  All
+                 *     buffers for such blocks should be put or branched
+                 *     beforehand.
+                 *  3) Discarding of blocks that were just written straight
+                 *     to disk, leaving stale data in the buffer.  The write
+                 *     code should never reference buffers for these blocks,
+                 *     since they would not be needed or used.
+                 */
+                CRITICAL_ERROR();
+                ret = -RED_EBUSY;
+                break;
             }
         }
     }
@@ -614,72 +934,310 @@ REDSTATUS RedBufferDiscardRange( uint32_t ulBlockStart,
 }
 
 
-/** Determine whether a metadata buffer is valid.
+#if REDCONF_READAHEAD_BLOCKS > 0U
+
+/** @brief Read a run of blocks into the buffers before they are needed.
  *
- *  This includes checking its signature, CRC, and sequence number.
+ *  The blocks are read with a single device request into a run of adjacent,
+ *  unreferenced buffers.  The read stops short of the first block which is
+ *  already buffered, since a buffered block may be newer than its on-disk
+ *  copy.  Read-ahead is opportunistic: if no suitable run of buffers is
+ *  available, fewer blocks (possibly none) are read.
  *
- *  @param pbBuffer Pointer to the metadata buffer to validate.
- *  @param uFlags   The buffer flags provided by the caller.  Used to determine
- *                  the expected signature.
+ *  The blocks are buffered as file data blocks, so nothing is read ahead on a
+ *  memory-mapped volume, where file data is not buffered.
  *
- *  @return Whether the metadata buffer is valid.
+ *  @param ulBlockStart     The first block to read.
+ *  @param pulBlockCount    On entry, the maximum number of blocks to read; on
+ *                          successful exit, the number of blocks which were
+ *                          read, which may be zero.
  *
- *  @retval true    The metadata buffer is valid.
- *  @retval false   The metadata buffer is invalid.
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
  */
-static bool BufferIsValid( const uint8_t * pbBuffer,
-                           uint16_t uFlags )
-{
-    bool fValid;
-
-    if( ( pbBuffer == NULL ) || ( ( uFlags & BFLAG_MASK ) != uFlags ) )
+    REDSTATUS RedBufferReadAhead( uint32_t ulBlockStart,
+                                  uint32_t * pulBlockCount )
     {
-        REDERROR();
-        fValid = false;
-    }
-    else
-    {
-        NODEHEADER buf;
-        uint16_t uMetaFlags = uFlags & BFLAG_META_MASK;
+        REDSTATUS ret = 0;
 
-        /*  Casting pbBuffer to (NODEHEADER *) would run afoul MISRA-C:2012
-         *  R11.3, so instead copy the fields out.
-         */
-        RedMemCpy( &buf.ulSignature, &pbBuffer[ NODEHEADER_OFFSET_SIG ], sizeof( buf.ulSignature ) );
-        RedMemCpy( &buf.ulCRC, &pbBuffer[ NODEHEADER_OFFSET_CRC ], sizeof( buf.ulCRC ) );
-        RedMemCpy( &buf.ullSequence, &pbBuffer[ NODEHEADER_OFFSET_SEQ ], sizeof( buf.ullSequence ) );
+        if( ( pulBlockCount == NULL ) ||
+            ( ulBlockStart >= gpRedVolume->ulBlockCount ) ||
+            ( ( gpRedVolume->ulBlockCount - ulBlockStart ) < *pulBlockCount ) )
+        {
+            REDERROR();
+            ret = -RED_EINVAL;
+        }
 
-        #ifdef REDCONF_ENDIAN_SWAP
-            buf.ulCRC = RedRev32( buf.ulCRC );
-            buf.ulSignature = RedRev32( buf.ulSignature );
-            buf.ullSequence = RedRev64( buf.ullSequence );
+        #if REDCONF_BDEV_XIP == 1
+            else if( gpRedVolume->pbMapped != NULL )
+            {
+                /*  File data is used in place, so it is never buffered.
+                 */
+                *pulBlockCount = 0U;
+            }
         #endif
-
-        /*  Make sure the signature is correct for the type of metadata block
-         *  requested by the caller.
-         */
-        switch( buf.ulSignature )
+        #if REDCONF_BDEV_RAM_ALIAS == 1
+            else if( gpRedVolume->pbAliased != NULL )
+            {
+                /*  Likewise on a RAM disk.
+                 */
+                *pulBlockCount = 0U;
+            }
+        #endif
+        else
         {
-            case META_SIG_MASTER:
-                fValid = ( uMetaFlags == BFLAG_META_MASTER );
-                break;
+            uint32_t ulCount = REDMIN( *pulBlockCount, REDCONF_READAHEAD_BLOCKS );
+            uint32_t ulBestCost = UINT32_MAX;
+            uint8_t bFirst = 0U;
+            uint32_t ulIdx;
+            uint8_t bIdx;
 
-                #if REDCONF_IMAP_EXTERNAL == 1
-                    case META_SIG_IMAP:
-                        fValid = ( uMetaFlags == BFLAG_META_IMAP );
-                        break;
-                #endif
-            case META_SIG_INODE:
-                fValid = ( uMetaFlags == BFLAG_META_INODE );
-                break;
+            #if REDCONF_BUFFER_META_RESERVE > 0U
+                bool fKeepMeta = BufferMetaCount() <= REDCONF_BUFFER_META_RESERVE;
+            #else
+                bool fKeepMeta = false;
+            #endif
 
-                #if DINDIR_POINTERS > 0U
-                    case META_SIG_DINDIR:
-                        fValid = ( uMetaFlags == BFLAG_META_DINDIR );
-                        break;
-                #endif
-                #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
-                    case META_SIG_INDIR:
+            for( ulIdx = 0U; ulIdx < ulCount; ulIdx++ )
+            {
+                if( BufferFind( ulBlockStart + ulIdx, &bIdx ) )
+                {
+                    ulCount = ulIdx;
+                }
+            }
+
+            /*  Find the run of unreferenced buffers which is cheapest to
+             *  repurpose.  Unused buffers are free, clean data buffers are
+             *  cheap, and metadata buffers, which are likely to be needed
+             *  again soon, and dirty buffers, which must be written first,
+             *  are expensive.  Metadata buffers are not used at all while no
+             *  more than the reserved number of buffers hold metadata.  If no
+             *  run is long enough, try a shorter run.
+             */
+            while( ( ulBestCost == UINT32_MAX ) && ( ulCount > 1U ) )
+            {
+                for( ulIdx = 0U; ( ulIdx + ulCount ) <= REDCONF_BUFFER_COUNT; ulIdx++ )
+                {
+                    uint32_t ulCost = 0U;
+                    uint32_t ulRunIdx;
+
+                    for( ulRunIdx = ulIdx; ulRunIdx < ( ulIdx + ulCount ); ulRunIdx++ )
+                    {
+                        const BUFFERHEAD * pHead = &gBufCtx.aHead[ ulRunIdx ];
+
+                        if( ( pHead->bRefCount != 0U ) || ( fKeepMeta && BufferHoldsMeta( ( uint8_t ) ulRunIdx ) ) )
+                        {
+                            ulCost = UINT32_MAX;
+                            break;
+                        }
+
+                        if( pHead->ulBlock != BBLK_INVALID )
+                        {
+                            ulCost += ( ( pHead->uFlags & BFLAG_META ) != 0U ) ? 4U : 1U;
+                            ulCost += ( ( pHead->uFlags & BFLAG_DIRTY ) != 0U ) ? 2U : 0U;
+                        }
+                    }
+
+                    if( ulCost < ulBestCost )
+                    {
+                        ulBestCost = ulCost;
+                        bFirst = ( uint8_t ) ulIdx;
+                    }
+                }
+
+                if( ulBestCost == UINT32_MAX )
+                {
+                    ulCount--;
+                }
+            }
+
+            if( ulBestCost == UINT32_MAX )
+            {
+                ulCount = 0U;
+            }
+
+            for( ulIdx = 0U; ( ret == 0 ) && ( ulIdx < ulCount ); ulIdx++ )
+            {
+                BUFFERHEAD * pHead;
+
+                bIdx = ( uint8_t ) ( bFirst + ulIdx );
+                pHead = &gBufCtx.aHead[ bIdx ];
+
+                #if REDCONF_READ_ONLY == 0
+                    if( ( pHead->ulBlock != BBLK_INVALID ) && ( ( pHead->uFlags & BFLAG_DIRTY ) != 0U ) )
+                    {
+                        ret = BufferWrite( bIdx );
+                    }
+                #endif
+
+                if( ret == 0 )
+                {
+                    BufferSetBlock( bIdx, pHead->bVolNum, BBLK_INVALID );
+                    pHead->uFlags = 0U;
+                }
+            }
+
+            /*  The buffers in the run are adjacent in memory, so the whole run
+             *  is read with one request.
+             */
+            if( ( ret == 0 ) && ( ulCount > 0U ) )
+            {
+                ret = RedIoRead( gbRedVolNum, ulBlockStart, ulCount, gBufCtx.b.aabBuffer[ bFirst ] );
+
+                for( ulIdx = 0U; ulIdx < ulCount; ulIdx++ )
+                {
+                    bIdx = ( uint8_t ) ( bFirst + ulIdx );
+
+                    if( ret == 0 )
+                    {
+                        BufferSetBlock( bIdx, gbRedVolNum, ulBlockStart + ulIdx );
+                        BufferMakeMRU( bIdx );
+                    }
+                    else
+                    {
+                        BufferMakeLRU( bIdx );
+                    }
+                }
+            }
+
+            if( ret == 0 )
+            {
+                #if REDCONF_STATS == 1
+                    gaRedVolStats[ gbRedVolNum ].ulReadAheadBlocks += ulCount;
+                #endif
+
+                *pulBlockCount = ulCount;
+            }
+        }
+
+        return ret;
+    }
+#endif /* REDCONF_READAHEAD_BLOCKS > 0U */
+
+
+#if REDCONF_TRANSACT_TASK == 1
+
+/** @brief Count the dirty buffers which belong to the current volume.
+ *
+ *  @return The number of dirty buffers for the current volume.
+ */
+    uint32_t RedBufferDirtyCount( void )
+    {
+        uint32_t ulCount = 0U;
+        uint8_t bIdx;
+
+        for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
+        {
+            const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+
+            if( ( pHead->ulBlock != BBLK_INVALID ) &&
+                ( pHead->bVolNum == gbRedVolNum ) &&
+                ( ( pHead->uFlags & BFLAG_DIRTY ) != 0U ) )
+            {
+                ulCount++;
+            }
+        }
+
+        return ulCount;
+    }
+#endif /* REDCONF_TRANSACT_TASK == 1 */
+
+
+#if REDCONF_STATS == 1
+
+/** @brief Count the buffers which hold blocks of the current volume.
+ *
+ *  @return The number of valid buffers for the current volume.
+ */
+    uint32_t RedBufferVolCount( void )
+    {
+        uint32_t ulCount = 0U;
+        uint8_t bIdx;
+
+        for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
+        {
+            const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+
+            if( ( pHead->ulBlock != BBLK_INVALID ) && ( pHead->bVolNum == gbRedVolNum ) )
+            {
+                ulCount++;
+            }
+        }
+
+        return ulCount;
+    }
+#endif /* REDCONF_STATS == 1 */
+
+
+/** Determine whether a metadata buffer is valid.
+ *
+ *  This includes checking its signature, CRC, and sequence number.
+ *
+ *  @param pbBuffer Pointer to the metadata buffer to validate.
+ *  @param uFlags   The buffer flags provided by the caller.  Used to determine
+ *                  the expected signature.
+ *
+ *  @return Whether the metadata buffer is valid.
+ *
+ *  @retval true    The metadata buffer is valid.
+ *  @retval false   The metadata buffer is invalid.
+ */
+static bool BufferIsValid( const uint8_t * pbBuffer,
+                           uint16_t uFlags )
+{
+    bool fValid;
+
+    if( ( pbBuffer == NULL ) || ( ( uFlags & BFLAG_MASK ) != uFlags ) )
+    {
+        REDERROR();
+        fValid = false;
+    }
+    else
+    {
+        NODEHEADER buf;
+        uint16_t uMetaFlags = uFlags & BFLAG_META_MASK;
+
+        /*  Casting pbBuffer to (NODEHEADER *) would run afoul MISRA-C:2012
+         *  R11.3, so instead copy the fields out.
+         */
+        RedMemCpy( &buf.ulSignature, &pbBuffer[ NODEHEADER_OFFSET_SIG ], sizeof( buf.ulSignature ) );
+        RedMemCpy( &buf.ulCRC, &pbBuffer[ NODEHEADER_OFFSET_CRC ], sizeof( buf.ulCRC ) );
+        RedMemCpy( &buf.ullSequence, &pbBuffer[ NODEHEADER_OFFSET_SEQ ], sizeof( buf.ullSequence ) );
+
+        #ifdef REDCONF_ENDIAN_SWAP
+            buf.ulCRC = RedRev32( buf.ulCRC );
+            buf.ulSignature = RedRev32( buf.ulSignature );
+            buf.ullSequence = RedRev64( buf.ullSequence );
+        #endif
+
+        /*  Make sure the signature is correct for the type of metadata block
+         *  requested by the caller.
+         */
+        switch( buf.ulSignature )
+        {
+            case META_SIG_MASTER:
+                fValid = ( uMetaFlags == BFLAG_META_MASTER );
+                break;
+
+                #if REDCONF_IMAP_EXTERNAL == 1
+                    case META_SIG_IMAP:
+                        fValid = ( uMetaFlags == BFLAG_META_IMAP );
+                        break;
+                #endif
+            case META_SIG_INODE:
+                fValid = ( uMetaFlags == BFLAG_META_INODE );
+                break;
+
+                #if DINDIR_POINTERS > 0U
+                    case META_SIG_DINDIR:
+                        fValid = ( uMetaFlags == BFLAG_META_DINDIR );
+                        break;
+                #endif
+                #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
+                    case META_SIG_INDIR:
                         fValid = ( uMetaFlags == BFLAG_META_INDIR );
                         break;
                 #endif
@@ -771,6 +1329,94 @@ static bool BufferToIdx( const void * pBuffer,
 }
 
 
+#if REDCONF_BDEV_XIP == 1
+
+/** @brief Determine whether a pointer refers to a block used in place on the
+ *         memory-mapped block device of the current volume.
+ *
+ *  @param pBuffer  The pointer to check.
+ *
+ *  @return Whether @p pBuffer points into the mapping of the current volume.
+ */
+    static bool BufferIsMapped( const void * pBuffer )
+    {
+        return ( gpRedVolume->pbMapped != NULL ) &&
+               PTR_IN_RANGE( pBuffer, gpRedVolume->pbMapped, ( uint64_t ) gpRedVolume->ulBlockCount << BLOCK_SIZE_P2 );
+    }
+#endif /* REDCONF_BDEV_XIP == 1 */
+
+
+#if REDCONF_BDEV_RAM_ALIAS == 1
+
+/** @brief Determine whether a pointer refers to a block used in place on the
+ *         RAM disk of the current volume.
+ *
+ *  @param pBuffer  The pointer to check.
+ *
+ *  @return Whether @p pBuffer points into the RAM disk of the current volume.
+ */
+    static bool BufferIsAliased( const void * pBuffer )
+    {
+        return ( gpRedVolume->pbAliased != NULL ) &&
+               PTR_IN_RANGE( pBuffer, gpRedVolume->pbAliased, ( uint64_t ) gpRedVolume->ulBlockCount << BLOCK_SIZE_P2 );
+    }
+#endif /* REDCONF_BDEV_RAM_ALIAS == 1 */
+
+
+#if REDCONF_LOCK_PER_VOLUME == 1
+
+/** @brief Read a block from the current volume into a buffer, releasing the FS
+ *         mutex for the duration of the read.
+ *
+ *  This lets tasks operating on other volumes make progress while this task
+ *  waits for its block device.  The caller holds the lock for the current
+ *  volume, so no other task can touch the state of this volume in the
+ *  meantime; the buffer is referenced for the duration of the read, so that
+ *  no other task can repurpose it.  The current volume is a global, and is
+ *  restored after the FS mutex is reacquired.
+ *
+ *  @param bIdx     The index of the buffer to read into.  The buffer must not
+ *                  be referenced.
+ *  @param ulBlock  The block number to read.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+    static REDSTATUS BufferReadUnlocked( uint8_t bIdx,
+                                         uint32_t ulBlock )
+    {
+        uint8_t bVolNum = gbRedVolNum;
+        BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+        REDSTATUS ret;
+
+        REDASSERT( pHead->bRefCount == 0U );
+
+        pHead->bRefCount = 1U;
+        gBufCtx.uNumUsed++;
+
+        RedOsMutexRelease();
+
+        ret = RedIoRead( bVolNum, ulBlock, 1U, gBufCtx.b.aabBuffer[ bIdx ] );
+
+        RedOsMutexAcquire();
+
+        if( RedCoreVolSetCurrent( bVolNum ) != 0 )
+        {
+            REDERROR();
+            ret = -RED_EINVAL;
+        }
+
+        pHead->bRefCount = 0U;
+        gBufCtx.uNumUsed--;
+
+        return ret;
+    }
+#endif /* REDCONF_LOCK_PER_VOLUME == 1 */
+
+
 #if REDCONF_READ_ONLY == 0
 
 /** @brief Write out a dirty buffer.
@@ -795,7 +1441,7 @@ static bool BufferToIdx( const void * pBuffer,
 
             if( ( pHead->uFlags & BFLAG_META ) != 0U )
             {
-                ret = BufferFinalize( gBufCtx.b.aabBuffer[ bIdx ], pHead->uFlags );
+                ret = BufferFinalize( gBufCtx.b.aabBuffer[ bIdx ], pHead->bVolNum, pHead->uFlags );
             }
 
             if( ret == 0 )
@@ -817,54 +1463,338 @@ static bool BufferToIdx( const void * pBuffer,
     }
 
 
-/** @brief Finalize a metadata buffer.
+    #if REDCONF_FLUSH_COALESCE_BLOCKS > 0U
+
+/** @brief Flush the dirty buffers in a range, coalescing contiguous blocks.
  *
- *  This updates the CRC and the sequence number.  It also sets the signature,
- *  though this is only truly needed if the buffer is new.
+ *  The dirty buffers are sorted by block number, and each run of contiguous
+ *  blocks is written with a single request.
  *
- *  @param pbBuffer Pointer to the metadata buffer to finalize.
- *  @param uFlags   The associated buffer flags.  Used to determine the expected
- *                  signature.
+ *  @param ulBlockStart Starting block number to flush.
+ *  @param ulBlockCount Count of blocks, starting at @p ulBlockStart, to flush.
  *
  *  @return A negated ::REDSTATUS code indicating the operation result.
  *
  *  @retval 0           Operation was successful.
- *  @retval -RED_EINVAL Invalid parameter; or maximum sequence number reached.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
  */
-    static REDSTATUS BufferFinalize( uint8_t * pbBuffer,
-                                     uint16_t uFlags )
-    {
-        REDSTATUS ret = 0;
-
-        if( ( pbBuffer == NULL ) || ( ( uFlags & BFLAG_MASK ) != uFlags ) )
-        {
-            REDERROR();
-            ret = -RED_EINVAL;
-        }
-        else
+        static REDSTATUS BufferFlushCoalesced( uint32_t ulBlockStart,
+                                               uint32_t ulBlockCount )
         {
-            uint32_t ulSignature;
+            REDSTATUS ret = 0;
+            uint32_t ulCursor = 0U;
+            uint32_t ulDirty = 0U;
+            uint32_t ulFirst = 0U;
+            uint8_t bIdx;
 
-            switch( uFlags & BFLAG_META_MASK )
+            /*  Gather the dirty buffers, keeping them sorted by block number
+             *  with an insertion sort.  The number of buffers is small, and at
+             *  a transaction point they are often nearly sorted already.
+             */
+            while( BufferNextInRange( ulBlockStart, ulBlockCount, &ulCursor, &bIdx ) )
             {
-                case BFLAG_META_MASTER:
-                    ulSignature = META_SIG_MASTER;
-                    break;
+                if( ( gBufCtx.aHead[ bIdx ].uFlags & BFLAG_DIRTY ) != 0U )
+                {
+                    uint32_t ulPos = ulDirty;
 
-                    #if REDCONF_IMAP_EXTERNAL == 1
-                        case BFLAG_META_IMAP:
-                            ulSignature = META_SIG_IMAP;
-                            break;
-                    #endif
-                case BFLAG_META_INODE:
-                    ulSignature = META_SIG_INODE;
-                    break;
+                    while( ( ulPos > 0U ) && ( gBufCtx.aHead[ gBufCtx.abFlush[ ulPos - 1U ] ].ulBlock > gBufCtx.aHead[ bIdx ].ulBlock ) )
+                    {
+                        gBufCtx.abFlush[ ulPos ] = gBufCtx.abFlush[ ulPos - 1U ];
+                        ulPos--;
+                    }
 
-                    #if DINDIR_POINTERS > 0U
-                        case BFLAG_META_DINDIR:
-                            ulSignature = META_SIG_DINDIR;
-                            break;
-                    #endif
+                    gBufCtx.abFlush[ ulPos ] = bIdx;
+                    ulDirty++;
+                }
+            }
+
+            while( ( ret == 0 ) && ( ulFirst < ulDirty ) )
+            {
+                uint32_t ulCount = 1U;
+
+                while( ( ( ulFirst + ulCount ) < ulDirty ) &&
+                       ( ulCount < REDCONF_FLUSH_COALESCE_BLOCKS ) &&
+                       ( gBufCtx.aHead[ gBufCtx.abFlush[ ulFirst + ulCount ] ].ulBlock == ( gBufCtx.aHead[ gBufCtx.abFlush[ ulFirst ] ].ulBlock + ulCount ) ) )
+                {
+                    ulCount++;
+                }
+
+                if( ulCount == 1U )
+                {
+                    ret = BufferWrite( gBufCtx.abFlush[ ulFirst ] );
+                }
+                else
+                {
+                    ret = BufferWriteRun( ulFirst, ulCount );
+                }
+
+                if( ret == 0 )
+                {
+                    uint32_t ulIdx;
+
+                    for( ulIdx = ulFirst; ulIdx < ( ulFirst + ulCount ); ulIdx++ )
+                    {
+                        gBufCtx.aHead[ gBufCtx.abFlush[ ulIdx ] ].uFlags &= ( ~BFLAG_DIRTY );
+                    }
+
+                    ulFirst += ulCount;
+                }
+            }
+
+            return ret;
+        }
+
+
+/** @brief Write out a run of dirty buffers for contiguous blocks.
+ *
+ *  @param ulFirst  Index into the abFlush array of the first buffer in the run.
+ *  @param ulCount  Number of buffers in the run.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+        static REDSTATUS BufferWriteRun( uint32_t ulFirst,
+                                         uint32_t ulCount )
+        {
+            REDSTATUS ret = 0;
+            uint32_t ulIdx;
+
+            REDASSERT( ulCount <= REDCONF_FLUSH_COALESCE_BLOCKS );
+
+            for( ulIdx = 0U; ( ret == 0 ) && ( ulIdx < ulCount ); ulIdx++ )
+            {
+                uint8_t bIdx = gBufCtx.abFlush[ ulFirst + ulIdx ];
+                const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+
+                REDASSERT( ( pHead->uFlags & BFLAG_DIRTY ) != 0U );
+
+                if( ( pHead->uFlags & BFLAG_META ) != 0U )
+                {
+                    ret = BufferFinalize( gBufCtx.b.aabBuffer[ bIdx ], pHead->bVolNum, pHead->uFlags );
+                }
+
+                if( ret == 0 )
+                {
+                    RedMemCpy( gBufCtx.s.aabStage[ ulIdx ], gBufCtx.b.aabBuffer[ bIdx ], REDCONF_BLOCK_SIZE );
+
+                    #ifdef REDCONF_ENDIAN_SWAP
+                        BufferEndianSwap( gBufCtx.b.aabBuffer[ bIdx ], pHead->uFlags );
+                    #endif
+                }
+            }
+
+            if( ret == 0 )
+            {
+                ret = RedIoWrite( gbRedVolNum, gBufCtx.aHead[ gBufCtx.abFlush[ ulFirst ] ].ulBlock, ulCount, gBufCtx.s.aabStage[ 0U ] );
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_FLUSH_COALESCE_BLOCKS > 0U */
+
+
+    #if BUFFER_FLUSH_ASYNC
+
+/** @brief Flush the dirty buffers in a range with asynchronous writes.
+ *
+ *  Up to REDCONF_BDEV_ASYNC_DEPTH writes are kept in flight, so that the next
+ *  buffer can be finalized (which computes its CRC) while earlier buffers are
+ *  still being transferred.
+ *
+ *  @param ulBlockStart Starting block number to flush.
+ *  @param ulBlockCount Count of blocks, starting at @p ulBlockStart, to flush.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+        static REDSTATUS BufferFlushAsync( uint32_t ulBlockStart,
+                                           uint32_t ulBlockCount )
+        {
+            REDSTATUS ret = 0;
+            uint32_t ulCursor = 0U;
+            uint32_t ulNextReq = 0U;
+            uint32_t ulPending = 0U;
+            uint8_t bIdx;
+
+            while( ( ret == 0 ) && BufferNextInRange( ulBlockStart, ulBlockCount, &ulCursor, &bIdx ) )
+            {
+                if( ( gBufCtx.aHead[ bIdx ].uFlags & BFLAG_DIRTY ) != 0U )
+                {
+                    /*  If every request is in flight, the next request to use
+                     *  is the oldest one: wait for it to finish.
+                     */
+                    if( ulPending == REDCONF_BDEV_ASYNC_DEPTH )
+                    {
+                        ret = BufferWriteFinish( ulNextReq );
+                        ulPending--;
+                    }
+
+                    if( ret == 0 )
+                    {
+                        ret = BufferWriteStart( bIdx, ulNextReq );
+                    }
+
+                    if( ret == 0 )
+                    {
+                        ulPending++;
+                        ulNextReq = ( ulNextReq + 1U ) % REDCONF_BDEV_ASYNC_DEPTH;
+                    }
+                }
+            }
+
+            /*  Wait for the remaining writes, even after an error, since the
+             *  buffers must not be touched while they are in flight.
+             */
+            while( ulPending > 0U )
+            {
+                REDSTATUS finishRet = BufferWriteFinish( ( ulNextReq + REDCONF_BDEV_ASYNC_DEPTH - ulPending ) % REDCONF_BDEV_ASYNC_DEPTH );
+
+                if( ret == 0 )
+                {
+                    ret = finishRet;
+                }
+
+                ulPending--;
+            }
+
+            return ret;
+        }
+
+
+/** @brief Finalize a dirty buffer and start writing it asynchronously.
+ *
+ *  @param bIdx     The index of the buffer to write.
+ *  @param ulReq    The index of the request to use.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+        static REDSTATUS BufferWriteStart( uint8_t bIdx,
+                                           uint32_t ulReq )
+        {
+            const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+            REDSTATUS ret = 0;
+
+            REDASSERT( ( pHead->uFlags & BFLAG_DIRTY ) != 0U );
+
+            if( ( pHead->uFlags & BFLAG_META ) != 0U )
+            {
+                ret = BufferFinalize( gBufCtx.b.aabBuffer[ bIdx ], pHead->bVolNum, pHead->uFlags );
+            }
+
+            if( ret == 0 )
+            {
+                gBufCtx.abReqBuf[ ulReq ] = bIdx;
+
+                ret = RedIoWriteStart( pHead->bVolNum, pHead->ulBlock, 1U, gBufCtx.b.aabBuffer[ bIdx ], &gBufCtx.aReq[ ulReq ] );
+
+                #ifdef REDCONF_ENDIAN_SWAP
+                    if( ret != 0 )
+                    {
+                        BufferEndianSwap( gBufCtx.b.aabBuffer[ bIdx ], pHead->uFlags );
+                    }
+                #endif
+            }
+
+            return ret;
+        }
+
+
+/** @brief Wait for an asynchronous buffer write to finish.
+ *
+ *  If the write succeeded, the buffer is no longer dirty.
+ *
+ *  @param ulReq    The index of the request to wait for.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+        static REDSTATUS BufferWriteFinish( uint32_t ulReq )
+        {
+            uint8_t bIdx = gBufCtx.abReqBuf[ ulReq ];
+            BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+            REDSTATUS ret;
+
+            ret = RedIoWriteFinish( pHead->bVolNum, &gBufCtx.aReq[ ulReq ] );
+
+            #ifdef REDCONF_ENDIAN_SWAP
+                BufferEndianSwap( gBufCtx.b.aabBuffer[ bIdx ], pHead->uFlags );
+            #endif
+
+            if( ret == 0 )
+            {
+                pHead->uFlags &= ( ~BFLAG_DIRTY );
+            }
+
+            return ret;
+        }
+    #endif /* BUFFER_FLUSH_ASYNC */
+
+
+/** @brief Finalize a metadata buffer.
+ *
+ *  This updates the CRC and the sequence number.  It also sets the signature,
+ *  though this is only truly needed if the buffer is new.
+ *
+ *  @param pbBuffer Pointer to the metadata buffer to finalize.
+ *  @param bVolNum  The volume the buffer belongs to, which need not be the
+ *                  current volume when a buffer is evicted.
+ *  @param uFlags   The associated buffer flags.  Used to determine the expected
+ *                  signature.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL Invalid parameter; or maximum sequence number reached.
+ */
+    static REDSTATUS BufferFinalize( uint8_t * pbBuffer,
+                                     uint8_t bVolNum,
+                                     uint16_t uFlags )
+    {
+        REDSTATUS ret = 0;
+
+        if( ( pbBuffer == NULL ) || ( bVolNum >= REDCONF_VOLUME_COUNT ) || ( ( uFlags & BFLAG_MASK ) != uFlags ) )
+        {
+            REDERROR();
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            uint32_t ulSignature;
+
+            switch( uFlags & BFLAG_META_MASK )
+            {
+                case BFLAG_META_MASTER:
+                    ulSignature = META_SIG_MASTER;
+                    break;
+
+                    #if REDCONF_IMAP_EXTERNAL == 1
+                        case BFLAG_META_IMAP:
+                            ulSignature = META_SIG_IMAP;
+                            break;
+                    #endif
+                case BFLAG_META_INODE:
+                    ulSignature = META_SIG_INODE;
+                    break;
+
+                    #if DINDIR_POINTERS > 0U
+                        case BFLAG_META_DINDIR:
+                            ulSignature = META_SIG_DINDIR;
+                            break;
+                    #endif
                     #if REDCONF_DIRECT_POINTERS < INODE_ENTRIES
                         case BFLAG_META_INDIR:
                             ulSignature = META_SIG_INDIR;
@@ -882,9 +1812,9 @@ static bool BufferToIdx( const void * pBuffer,
             }
             else
             {
-                uint64_t ullSeqNum = gpRedVolume->ullSequence;
+                uint64_t ullSeqNum = gaRedVolume[ bVolNum ].ullSequence;
 
-                ret = RedVolSeqNumIncrement();
+                ret = RedVolSeqNumIncrement( bVolNum );
 
                 if( ret == 0 )
                 {
@@ -1003,6 +1933,7 @@ static bool BufferToIdx( const void * pBuffer,
             pMaster->uMaxNameLen = RedRev16( pMaster->uMaxNameLen );
             pMaster->uDirectPointers = RedRev16( pMaster->uDirectPointers );
             pMaster->uIndirectPointers = RedRev16( pMaster->uIndirectPointers );
+            pMaster->ulIntentLogBlocks = RedRev32( pMaster->ulIntentLogBlocks );
         }
     }
 
@@ -1080,137 +2011,691 @@ static bool BufferToIdx( const void * pBuffer,
 #endif /* #ifdef REDCONF_ENDIAN_SWAP */
 
 
+#if REDCONF_BUFFER_HASH == 1
+
 /** @brief Mark a buffer as least recently used.
  *
  *  @param bIdx The index of the buffer to make LRU.
  */
-static void BufferMakeLRU( uint8_t bIdx )
-{
-    if( bIdx >= REDCONF_BUFFER_COUNT )
-    {
-        REDERROR();
-    }
-    else if( bIdx != gBufCtx.abMRU[ REDCONF_BUFFER_COUNT - 1U ] )
+    static void BufferMakeLRU( uint8_t bIdx )
     {
-        uint8_t bMruIdx;
-
-        /*  Find the current position of the buffer in the MRU array.  We do not
-         *  need to check the last slot, since we already know from the above
-         *  check that the index is not there.
-         */
-        for( bMruIdx = 0U; bMruIdx < ( REDCONF_BUFFER_COUNT - 1U ); bMruIdx++ )
+        if( bIdx >= REDCONF_BUFFER_COUNT )
         {
-            if( bIdx == gBufCtx.abMRU[ bMruIdx ] )
-            {
-                break;
-            }
+            REDERROR();
         }
-
-        if( bMruIdx < ( REDCONF_BUFFER_COUNT - 1U ) )
+        else if( bIdx != gBufCtx.bLRU )
         {
-            /*  Move the buffer index to the back of the MRU array, making it
-             *  the LRU buffer.
-             */
-            RedMemMove( &gBufCtx.abMRU[ bMruIdx ], &gBufCtx.abMRU[ bMruIdx + 1U ], REDCONF_BUFFER_COUNT - ( ( uint32_t ) bMruIdx + 1U ) );
-            gBufCtx.abMRU[ REDCONF_BUFFER_COUNT - 1U ] = bIdx;
+            BufferListUnlink( bIdx );
+
+            gBufCtx.abPrev[ bIdx ] = gBufCtx.bLRU;
+            gBufCtx.abNext[ bIdx ] = BIDX_INVALID;
+            gBufCtx.abNext[ gBufCtx.bLRU ] = bIdx;
+            gBufCtx.bLRU = bIdx;
         }
         else
         {
-            REDERROR();
+            /*  Buffer already LRU, nothing to do.
+             */
         }
     }
-    else
-    {
-        /*  Buffer already LRU, nothing to do.
-         */
-    }
-}
 
 
 /** @brief Mark a buffer as most recently used.
  *
  *  @param bIdx The index of the buffer to make MRU.
  */
-static void BufferMakeMRU( uint8_t bIdx )
-{
-    if( bIdx >= REDCONF_BUFFER_COUNT )
+    static void BufferMakeMRU( uint8_t bIdx )
     {
-        REDERROR();
-    }
-    else if( bIdx != gBufCtx.abMRU[ 0U ] )
-    {
-        uint8_t bMruIdx;
-
-        /*  Find the current position of the buffer in the MRU array.  We do not
-         *  need to check the first slot, since we already know from the above
-         *  check that the index is not there.
-         */
-        for( bMruIdx = 1U; bMruIdx < REDCONF_BUFFER_COUNT; bMruIdx++ )
+        if( bIdx >= REDCONF_BUFFER_COUNT )
         {
-            if( bIdx == gBufCtx.abMRU[ bMruIdx ] )
-            {
-                break;
-            }
+            REDERROR();
         }
-
-        if( bMruIdx < REDCONF_BUFFER_COUNT )
+        else if( bIdx != gBufCtx.bMRU )
         {
-            /*  Move the buffer index to the front of the MRU array, making it
-             *  the MRU buffer.
-             */
-            RedMemMove( &gBufCtx.abMRU[ 1U ], &gBufCtx.abMRU[ 0U ], bMruIdx );
-            gBufCtx.abMRU[ 0U ] = bIdx;
+            BufferListUnlink( bIdx );
+
+            gBufCtx.abPrev[ bIdx ] = BIDX_INVALID;
+            gBufCtx.abNext[ bIdx ] = gBufCtx.bMRU;
+            gBufCtx.abPrev[ gBufCtx.bMRU ] = bIdx;
+            gBufCtx.bMRU = bIdx;
         }
         else
         {
-            REDERROR();
+            /*  Buffer already MRU, nothing to do.
+             */
         }
     }
-    else
-    {
-        /*  Buffer already MRU, nothing to do.
-         */
-    }
-}
 
 
-/** @brief Find a block in the buffers.
- *
- *  @param ulBlock  The block number to find.
- *  @param pbIdx    If the block is buffered (true is returned), populated with
- *                  the index of the buffer.
+/** @brief Remove a buffer from the LRU list.
  *
- *  @return Boolean indicating whether or not the block is buffered.
+ *  The buffer must not be the only buffer in the list, which holds since the
+ *  minimum buffer count is greater than one.  The caller is responsible for
+ *  linking the buffer back into the list.
  *
- *  @retval true    @p ulBlock is buffered, and its index has been stored in
- *                  @p pbIdx.
- *  @retval false   @p ulBlock is not buffered.
+ *  @param bIdx The index of the buffer to unlink.
  */
-static bool BufferFind( uint32_t ulBlock,
-                        uint8_t * pbIdx )
-{
-    bool ret = false;
-
-    if( ( ulBlock >= gpRedVolume->ulBlockCount ) || ( pbIdx == NULL ) )
+    static void BufferListUnlink( uint8_t bIdx )
     {
-        REDERROR();
+        uint8_t bPrev = gBufCtx.abPrev[ bIdx ];
+        uint8_t bNext = gBufCtx.abNext[ bIdx ];
+
+        REDASSERT( ( bPrev != BIDX_INVALID ) || ( bNext != BIDX_INVALID ) );
+
+        if( bPrev == BIDX_INVALID )
+        {
+            gBufCtx.bMRU = bNext;
+        }
+        else
+        {
+            gBufCtx.abNext[ bPrev ] = bNext;
+        }
+
+        if( bNext == BIDX_INVALID )
+        {
+            gBufCtx.bLRU = bPrev;
+        }
+        else
+        {
+            gBufCtx.abPrev[ bNext ] = bPrev;
+        }
     }
-    else
+
+
+/** @brief Find the least recently used buffer which is not referenced.
+ *
+ *  @param fSkipMeta    Whether buffers holding metadata are also passed over.
+ *  @param pafSkipVol   If not `NULL`, an array indexed by volume number of
+ *                      whether buffers of that volume are also passed over.
+ *
+ *  @return The index of the least recently used unreferenced buffer.  If every
+ *          buffer is passed over, the index of the MRU buffer is returned; the
+ *          caller must check the reference count.
+ */
+    static uint8_t BufferFindVictim( bool fSkipMeta,
+                                     const bool * pafSkipVol )
+    {
+        uint8_t bIdx = gBufCtx.bLRU;
+
+        /*  Referenced buffers tend to be recently used, and there are never
+         *  more than a handful of them, so this loop almost always stops
+         *  within the first few buffers.
+         */
+        while( ( ( gBufCtx.aHead[ bIdx ].bRefCount != 0U ) || BufferIsSkipped( bIdx, fSkipMeta, pafSkipVol ) ) &&
+               ( gBufCtx.abPrev[ bIdx ] != BIDX_INVALID ) )
+        {
+            bIdx = gBufCtx.abPrev[ bIdx ];
+        }
+
+        return bIdx;
+    }
+
+
+/** @brief Find a block in the buffers.
+ *
+ *  @param ulBlock  The block number to find.
+ *  @param pbIdx    If the block is buffered (true is returned), populated with
+ *                  the index of the buffer.
+ *
+ *  @return Boolean indicating whether or not the block is buffered.
+ *
+ *  @retval true    @p ulBlock is buffered, and its index has been stored in
+ *                  @p pbIdx.
+ *  @retval false   @p ulBlock is not buffered.
+ */
+    static bool BufferFind( uint32_t ulBlock,
+                            uint8_t * pbIdx )
+    {
+        bool ret = false;
+
+        if( ( ulBlock >= gpRedVolume->ulBlockCount ) || ( pbIdx == NULL ) )
+        {
+            REDERROR();
+        }
+        else
+        {
+            uint32_t ulSlot = BufferHashSlot( gbRedVolNum, ulBlock );
+
+            /*  The table is never more than half full, so there is always an
+             *  empty slot to terminate the probe sequence.
+             */
+            while( gBufCtx.abHash[ ulSlot ] != BIDX_INVALID )
+            {
+                const BUFFERHEAD * pHead = &gBufCtx.aHead[ gBufCtx.abHash[ ulSlot ] ];
+
+                if( ( pHead->bVolNum == gbRedVolNum ) && ( pHead->ulBlock == ulBlock ) )
+                {
+                    *pbIdx = gBufCtx.abHash[ ulSlot ];
+                    ret = true;
+                    break;
+                }
+
+                ulSlot = ( ulSlot + 1U ) & BUFFER_HASH_MASK;
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Compute the home hash table slot for a block.
+ *
+ *  @param bVolNum  The volume the block resides on.
+ *  @param ulBlock  The block number.
+ *
+ *  @return The index of the first hash table slot to probe.
+ */
+    static uint32_t BufferHashSlot( uint8_t bVolNum,
+                                    uint32_t ulBlock )
+    {
+        /*  Fibonacci hashing: the multiplication spreads sequential block
+         *  numbers, which are the common case, across the whole table, and the
+         *  high bits of the product are the best mixed.
+         */
+        uint32_t ulKey = ulBlock ^ ( ( uint32_t ) bVolNum << 24U );
+
+        return ( ulKey * 0x9E3779B1U ) >> ( 32U - BUFFER_HASH_SHIFT );
+    }
+
+
+/** @brief Add a valid buffer to the hash table.
+ *
+ *  @param bIdx The index of the buffer to insert.
+ */
+    static void BufferHashInsert( uint8_t bIdx )
+    {
+        const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+        uint32_t ulSlot = BufferHashSlot( pHead->bVolNum, pHead->ulBlock );
+
+        while( gBufCtx.abHash[ ulSlot ] != BIDX_INVALID )
+        {
+            REDASSERT( gBufCtx.abHash[ ulSlot ] != bIdx );
+            ulSlot = ( ulSlot + 1U ) & BUFFER_HASH_MASK;
+        }
+
+        gBufCtx.abHash[ ulSlot ] = bIdx;
+    }
+
+
+/** @brief Remove a valid buffer from the hash table.
+ *
+ *  Uses backward-shift deletion, so no tombstones are needed and probe
+ *  sequences do not degrade over time.
+ *
+ *  @param bIdx The index of the buffer to remove.
+ */
+    static void BufferHashRemove( uint8_t bIdx )
     {
+        const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+        uint32_t ulHole = BufferHashSlot( pHead->bVolNum, pHead->ulBlock );
+
+        while( ( gBufCtx.abHash[ ulHole ] != bIdx ) && ( gBufCtx.abHash[ ulHole ] != BIDX_INVALID ) )
+        {
+            ulHole = ( ulHole + 1U ) & BUFFER_HASH_MASK;
+        }
+
+        if( gBufCtx.abHash[ ulHole ] != bIdx )
+        {
+            REDERROR();
+        }
+        else
+        {
+            uint32_t ulSlot = ( ulHole + 1U ) & BUFFER_HASH_MASK;
+
+            /*  Move each entry in the rest of the probe cluster back into the
+             *  hole, unless doing so would move it in front of its home slot.
+             */
+            while( gBufCtx.abHash[ ulSlot ] != BIDX_INVALID )
+            {
+                const BUFFERHEAD * pMoved = &gBufCtx.aHead[ gBufCtx.abHash[ ulSlot ] ];
+                uint32_t ulHome = BufferHashSlot( pMoved->bVolNum, pMoved->ulBlock );
+
+                if( ( ( ulSlot - ulHome ) & BUFFER_HASH_MASK ) >= ( ( ulSlot - ulHole ) & BUFFER_HASH_MASK ) )
+                {
+                    gBufCtx.abHash[ ulHole ] = gBufCtx.abHash[ ulSlot ];
+                    ulHole = ulSlot;
+                }
+
+                ulSlot = ( ulSlot + 1U ) & BUFFER_HASH_MASK;
+            }
+
+            gBufCtx.abHash[ ulHole ] = BIDX_INVALID;
+        }
+    }
+
+#else /* REDCONF_BUFFER_HASH == 1 */
+
+/** @brief Mark a buffer as least recently used.
+ *
+ *  @param bIdx The index of the buffer to make LRU.
+ */
+    static void BufferMakeLRU( uint8_t bIdx )
+    {
+        if( bIdx >= REDCONF_BUFFER_COUNT )
+        {
+            REDERROR();
+        }
+        else if( bIdx != gBufCtx.abMRU[ REDCONF_BUFFER_COUNT - 1U ] )
+        {
+            uint8_t bMruIdx;
+
+            /*  Find the current position of the buffer in the MRU array.  We do not
+             *  need to check the last slot, since we already know from the above
+             *  check that the index is not there.
+             */
+            for( bMruIdx = 0U; bMruIdx < ( REDCONF_BUFFER_COUNT - 1U ); bMruIdx++ )
+            {
+                if( bIdx == gBufCtx.abMRU[ bMruIdx ] )
+                {
+                    break;
+                }
+            }
+
+            if( bMruIdx < ( REDCONF_BUFFER_COUNT - 1U ) )
+            {
+                /*  Move the buffer index to the back of the MRU array, making it
+                 *  the LRU buffer.
+                 */
+                RedMemMove( &gBufCtx.abMRU[ bMruIdx ], &gBufCtx.abMRU[ bMruIdx + 1U ], REDCONF_BUFFER_COUNT - ( ( uint32_t ) bMruIdx + 1U ) );
+                gBufCtx.abMRU[ REDCONF_BUFFER_COUNT - 1U ] = bIdx;
+            }
+            else
+            {
+                REDERROR();
+            }
+        }
+        else
+        {
+            /*  Buffer already LRU, nothing to do.
+             */
+        }
+    }
+
+
+/** @brief Mark a buffer as most recently used.
+ *
+ *  @param bIdx The index of the buffer to make MRU.
+ */
+    static void BufferMakeMRU( uint8_t bIdx )
+    {
+        if( bIdx >= REDCONF_BUFFER_COUNT )
+        {
+            REDERROR();
+        }
+        else if( bIdx != gBufCtx.abMRU[ 0U ] )
+        {
+            uint8_t bMruIdx;
+
+            /*  Find the current position of the buffer in the MRU array.  We do not
+             *  need to check the first slot, since we already know from the above
+             *  check that the index is not there.
+             */
+            for( bMruIdx = 1U; bMruIdx < REDCONF_BUFFER_COUNT; bMruIdx++ )
+            {
+                if( bIdx == gBufCtx.abMRU[ bMruIdx ] )
+                {
+                    break;
+                }
+            }
+
+            if( bMruIdx < REDCONF_BUFFER_COUNT )
+            {
+                /*  Move the buffer index to the front of the MRU array, making it
+                 *  the MRU buffer.
+                 */
+                RedMemMove( &gBufCtx.abMRU[ 1U ], &gBufCtx.abMRU[ 0U ], bMruIdx );
+                gBufCtx.abMRU[ 0U ] = bIdx;
+            }
+            else
+            {
+                REDERROR();
+            }
+        }
+        else
+        {
+            /*  Buffer already MRU, nothing to do.
+             */
+        }
+    }
+
+
+/** @brief Find the least recently used buffer which is not referenced.
+ *
+ *  @param fSkipMeta    Whether buffers holding metadata are also passed over.
+ *  @param pafSkipVol   If not `NULL`, an array indexed by volume number of
+ *                      whether buffers of that volume are also passed over.
+ *
+ *  @return The index of the least recently used unreferenced buffer.  If every
+ *          buffer is passed over, the index of the MRU buffer is returned; the
+ *          caller must check the reference count.
+ */
+    static uint8_t BufferFindVictim( bool fSkipMeta,
+                                     const bool * pafSkipVol )
+    {
+        uint8_t bMruIdx;
+
+        for( bMruIdx = ( uint8_t ) ( REDCONF_BUFFER_COUNT - 1U ); bMruIdx > 0U; bMruIdx-- )
+        {
+            uint8_t bIdx = gBufCtx.abMRU[ bMruIdx ];
+
+            if( ( gBufCtx.aHead[ bIdx ].bRefCount == 0U ) && !BufferIsSkipped( bIdx, fSkipMeta, pafSkipVol ) )
+            {
+                break;
+            }
+        }
+
+        return gBufCtx.abMRU[ bMruIdx ];
+    }
+
+
+/** @brief Find a block in the buffers.
+ *
+ *  @param ulBlock  The block number to find.
+ *  @param pbIdx    If the block is buffered (true is returned), populated with
+ *                  the index of the buffer.
+ *
+ *  @return Boolean indicating whether or not the block is buffered.
+ *
+ *  @retval true    @p ulBlock is buffered, and its index has been stored in
+ *                  @p pbIdx.
+ *  @retval false   @p ulBlock is not buffered.
+ */
+    static bool BufferFind( uint32_t ulBlock,
+                            uint8_t * pbIdx )
+    {
+        bool ret = false;
+
+        if( ( ulBlock >= gpRedVolume->ulBlockCount ) || ( pbIdx == NULL ) )
+        {
+            REDERROR();
+        }
+        else
+        {
+            uint8_t bIdx;
+
+            for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
+            {
+                const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+
+                if( ( pHead->bVolNum == gbRedVolNum ) && ( pHead->ulBlock == ulBlock ) )
+                {
+                    *pbIdx = bIdx;
+                    ret = true;
+                    break;
+                }
+            }
+        }
+
+        return ret;
+    }
+#endif /* REDCONF_BUFFER_HASH == 1 */
+
+
+/** @brief Choose the buffer to repurpose for a block which is not buffered.
+ *
+ *  Normally this is the least recently used unreferenced buffer.  With
+ *  REDCONF_BUFFER_META_RESERVE, a file data block passes over metadata buffers
+ *  when no more than the reserved number of buffers hold metadata, so that
+ *  streaming data only recycles other data buffers.  With
+ *  REDCONF_BUFFER_VOL_RESERVE, a block passes over the buffers of any other
+ *  volume which holds no more than its reserve.
+ *
+ *  @param uFlags   The flags of the block which is to be buffered.
+ *
+ *  @return The index of the buffer to repurpose.  The caller must check the
+ *          reference count.
+ */
+static uint8_t BufferChooseVictim( uint16_t uFlags )
+{
+    uint8_t bIdx = BufferFindVictim( false, NULL );
+    bool fSkipMeta = false;
+
+    #if REDCONF_BUFFER_META_RESERVE > 0U
+        if( ( ( uFlags & BFLAG_META ) == 0U ) && BufferHoldsMeta( bIdx ) && ( BufferMetaCount() <= REDCONF_BUFFER_META_RESERVE ) )
+        {
+            uint8_t bDataIdx = BufferFindVictim( true, NULL );
+
+            /*  If every unreferenced buffer holds metadata, the reservation
+             *  gives way rather than failing the request.
+             */
+            if( ( gBufCtx.aHead[ bDataIdx ].bRefCount == 0U ) && !BufferHoldsMeta( bDataIdx ) )
+            {
+                bIdx = bDataIdx;
+                fSkipMeta = true;
+            }
+        }
+    #else
+        ( void ) uFlags;
+    #endif
+
+    #if REDCONF_BUFFER_VOL_RESERVE == 1
+        {
+            const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+            bool afReserved[ REDCONF_VOLUME_COUNT ];
+
+            if( ( pHead->ulBlock != BBLK_INVALID ) &&
+                ( pHead->bVolNum != gbRedVolNum ) &&
+                BufferVolReserved( afReserved ) &&
+                afReserved[ pHead->bVolNum ] )
+            {
+                uint8_t bOtherIdx = BufferFindVictim( fSkipMeta, afReserved );
+
+                /*  Like the metadata reservation, the volume reservations give
+                 *  way rather than failing the request.
+                 */
+                if( ( gBufCtx.aHead[ bOtherIdx ].bRefCount == 0U ) && !BufferIsSkipped( bOtherIdx, fSkipMeta, afReserved ) )
+                {
+                    bIdx = bOtherIdx;
+                }
+                else
+                {
+                    #if REDCONF_STATS == 1
+                        gaRedVolStats[ pHead->bVolNum ].ulReserveOverruns++;
+                    #endif
+                }
+            }
+        }
+    #else
+        ( void ) fSkipMeta;
+    #endif /* REDCONF_BUFFER_VOL_RESERVE == 1 */
+
+    return bIdx;
+}
+
+
+/** @brief Determine whether a buffer is passed over when looking for a buffer
+ *         to repurpose.
+ *
+ *  @param bIdx         The index of the buffer.
+ *  @param fSkipMeta    Whether buffers holding metadata are passed over.
+ *  @param pafSkipVol   If not `NULL`, an array indexed by volume number of
+ *                      whether buffers of that volume are passed over.
+ *
+ *  @return Whether the buffer is passed over.  Its reference count is not
+ *          considered.
+ */
+static bool BufferIsSkipped( uint8_t bIdx,
+                             bool fSkipMeta,
+                             const bool * pafSkipVol )
+{
+    const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+    bool fSkip = fSkipMeta && BufferHoldsMeta( bIdx );
+
+    if( !fSkip && ( pafSkipVol != NULL ) && ( pHead->ulBlock != BBLK_INVALID ) )
+    {
+        fSkip = pafSkipVol[ pHead->bVolNum ];
+    }
+
+    return fSkip;
+}
+
+
+/** @brief Determine whether a buffer holds a metadata block.
+ *
+ *  @param bIdx The index of the buffer.
+ *
+ *  @return Whether the buffer is valid and holds metadata.
+ */
+static bool BufferHoldsMeta( uint8_t bIdx )
+{
+    const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+
+    return ( pHead->ulBlock != BBLK_INVALID ) && ( ( pHead->uFlags & BFLAG_META ) != 0U );
+}
+
+
+#if REDCONF_BUFFER_META_RESERVE > 0U
+
+/** @brief Count the buffers which hold metadata blocks.
+ *
+ *  @return The number of valid metadata buffers, for all volumes.
+ */
+    static uint32_t BufferMetaCount( void )
+    {
+        uint32_t ulCount = 0U;
         uint8_t bIdx;
 
+        for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
+        {
+            if( BufferHoldsMeta( bIdx ) )
+            {
+                ulCount++;
+            }
+        }
+
+        return ulCount;
+    }
+#endif /* REDCONF_BUFFER_META_RESERVE > 0U */
+
+
+#if REDCONF_BUFFER_VOL_RESERVE == 1
+
+/** @brief Find the volumes, other than the current volume, whose buffers are
+ *         protected by their reserves.
+ *
+ *  @param pafReserved  Array indexed by volume number, populated with whether
+ *                      the volume holds no more buffers than its reserve.  The
+ *                      entry for the current volume is always false.
+ *
+ *  @return Whether any volume is protected.
+ */
+    static bool BufferVolReserved( bool * pafReserved )
+    {
+        uint32_t aulHeld[ REDCONF_VOLUME_COUNT ];
+        bool fAny = false;
+        uint8_t bIdx;
+        uint8_t bVolNum;
+
+        RedMemSet( aulHeld, 0U, sizeof( aulHeld ) );
+
         for( bIdx = 0U; bIdx < REDCONF_BUFFER_COUNT; bIdx++ )
         {
             const BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
 
-            if( ( pHead->bVolNum == gbRedVolNum ) && ( pHead->ulBlock == ulBlock ) )
+            if( pHead->ulBlock != BBLK_INVALID )
             {
-                *pbIdx = bIdx;
-                ret = true;
-                break;
+                aulHeld[ pHead->bVolNum ]++;
+            }
+        }
+
+        for( bVolNum = 0U; bVolNum < REDCONF_VOLUME_COUNT; bVolNum++ )
+        {
+            pafReserved[ bVolNum ] = ( bVolNum != gbRedVolNum ) &&
+                                     ( aulHeld[ bVolNum ] > 0U ) &&
+                                     ( aulHeld[ bVolNum ] <= gaRedVolConf[ bVolNum ].bBufferReserve );
+            fAny = fAny || pafReserved[ bVolNum ];
+        }
+
+        return fAny;
+    }
+#endif /* REDCONF_BUFFER_VOL_RESERVE == 1 */
+
+
+/** @brief Associate a buffer with a block, or mark it invalid.
+ *
+ *  All changes to the block number or volume of a buffer head go through this
+ *  function, so that the hash table (when enabled) stays consistent.
+ *
+ *  @param bIdx     The index of the buffer.
+ *  @param bVolNum  The volume the block resides on.
+ *  @param ulBlock  The block number, or BBLK_INVALID to mark the buffer unused.
+ */
+static void BufferSetBlock( uint8_t bIdx,
+                            uint8_t bVolNum,
+                            uint32_t ulBlock )
+{
+    BUFFERHEAD * pHead = &gBufCtx.aHead[ bIdx ];
+
+    #if REDCONF_BUFFER_HASH == 1
+        if( pHead->ulBlock != BBLK_INVALID )
+        {
+            BufferHashRemove( bIdx );
+        }
+    #endif
+
+    pHead->bVolNum = bVolNum;
+    pHead->ulBlock = ulBlock;
+
+    #if REDCONF_BUFFER_HASH == 1
+        if( ulBlock != BBLK_INVALID )
+        {
+            BufferHashInsert( bIdx );
+        }
+    #endif
+}
+
+
+/** @brief Find the next buffer for the active volume in a range of blocks.
+ *
+ *  @param ulBlockStart Starting block number of the range.
+ *  @param ulBlockCount Count of blocks, starting at @p ulBlockStart, in the
+ *                      range.
+ *  @param pulCursor    Iteration state.  Must be zero on the first call and
+ *                      otherwise left untouched by the caller.
+ *  @param pbIdx        If a buffer is found (true is returned), populated with
+ *                      the index of the buffer.
+ *
+ *  @return Boolean indicating whether another buffer was found.
+ */
+static bool BufferNextInRange( uint32_t ulBlockStart,
+                               uint32_t ulBlockCount,
+                               uint32_t * pulCursor,
+                               uint8_t * pbIdx )
+{
+    bool fFound = false;
+
+    #if REDCONF_BUFFER_HASH == 1
+        if( ulBlockCount < REDCONF_BUFFER_COUNT )
+        {
+            /*  Small ranges, such as single blocks being freed, are cheaper to
+             *  look up block-by-block in the hash table than to visit every
+             *  buffer head.
+             */
+            while( !fFound && ( *pulCursor < ulBlockCount ) )
+            {
+                fFound = BufferFind( ulBlockStart + *pulCursor, pbIdx );
+                ( *pulCursor )++;
             }
         }
+        else
+    #endif
+    {
+        while( !fFound && ( *pulCursor < REDCONF_BUFFER_COUNT ) )
+        {
+            const BUFFERHEAD * pHead = &gBufCtx.aHead[ *pulCursor ];
+
+            if( ( pHead->bVolNum == gbRedVolNum ) &&
+                ( pHead->ulBlock != BBLK_INVALID ) &&
+                ( pHead->ulBlock >= ulBlockStart ) &&
+                ( pHead->ulBlock < ( ulBlockStart + ulBlockCount ) ) )
+            {
+                *pbIdx = ( uint8_t ) *pulCursor;
+                fFound = true;
+            }
+
+            ( *pulCursor )++;
+        }
     }
 
-    return ret;
+    return fFound;
 }
@@ -60,16 +60,33 @@
                                  uint32_t ulDstPInode,
                                  const char * pszDstName );
 #endif
+#if REDCONF_INTENT_LOG_BLOCKS > 0U
+    static REDSTATUS CoreFileMount( CINODE * pInode,
+                                    bool * pfChanged );
+#endif
 #if REDCONF_READ_ONLY == 0
     static REDSTATUS CoreFileWrite( uint32_t ulInode,
                                     uint64_t ullStart,
                                     uint32_t * pulLen,
                                     const void * pBuffer );
 #endif
+#if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_IOVEC == 1 )
+    static REDSTATUS CoreFileWriteV( uint32_t ulInode,
+                                     uint64_t ullStart,
+                                     const REDFSEIOVEC * pIov,
+                                     uint32_t ulIovCount,
+                                     uint32_t * pulIovDone,
+                                     uint32_t * pulLen );
+#endif
 #if TRUNCATE_SUPPORTED
     static REDSTATUS CoreFileTruncate( uint32_t ulInode,
                                        uint64_t ullSize );
 #endif
+#if FALLOCATE_SUPPORTED
+    static REDSTATUS CoreFileAllocate( uint32_t ulInode,
+                                       uint64_t ullStart,
+                                       uint64_t ullLen );
+#endif
 
 
 VOLUME gaRedVolume[ REDCONF_VOLUME_COUNT ];
@@ -82,6 +99,10 @@ METAROOT * gpRedMR = &gaCoreVol[ 0U ].aMR[ 0U ];
 
 CONST_IF_ONE_VOLUME uint8_t gbRedVolNum = 0;
 
+#if REDCONF_STATS == 1
+    REDVOLSTATS gaRedVolStats[ REDCONF_VOLUME_COUNT ];
+#endif
+
 
 /** @brief Initialize the Reliance Edge file system driver.
  *
@@ -119,6 +140,9 @@ REDSTATUS RedCoreInit( void )
 
     RedMemSet( gaRedVolume, 0U, sizeof( gaRedVolume ) );
     RedMemSet( gaCoreVol, 0U, sizeof( gaCoreVol ) );
+    #if REDCONF_STATS == 1
+        RedMemSet( gaRedVolStats, 0U, sizeof( gaRedVolStats ) );
+    #endif
 
     RedBufferInit();
 
@@ -199,6 +223,7 @@ REDSTATUS RedCoreInit( void )
                  *  - Metaroots (2 blocks)
                  *  - External imap blocks (variable * 2 blocks)
                  *  - Inode blocks (pVolConf->ulInodeCount * 2 blocks)
+                 *  - Intent log blocks (REDCONF_INTENT_LOG_BLOCKS blocks)
                  */
 
                 /*  The imap needs bits for all inode and allocable blocks.  If
@@ -243,6 +268,11 @@ REDSTATUS RedCoreInit( void )
         {
             pCoreVol->ulFirstAllocableBN = pCoreVol->ulInodeTableStartBN + ( pVolConf->ulInodeCount * 2U );
 
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+                pCoreVol->ulIntentLogStartBN = pCoreVol->ulFirstAllocableBN;
+                pCoreVol->ulFirstAllocableBN += REDCONF_INTENT_LOG_BLOCKS;
+            #endif
+
             if( pCoreVol->ulFirstAllocableBN > pVol->ulBlockCount )
             {
                 /*  We can get here if there is not enough space for the number
@@ -262,6 +292,26 @@ REDSTATUS RedCoreInit( void )
         }
     }
 
+    #if REDCONF_BUFFER_VOL_RESERVE == 1
+
+        /*  The reserves must leave some buffers which any volume can use.
+         */
+        if( ret == 0 )
+        {
+            uint32_t ulReserved = 0U;
+
+            for( bVolNum = 0U; bVolNum < REDCONF_VOLUME_COUNT; bVolNum++ )
+            {
+                ulReserved += gaRedVolConf[ bVolNum ].bBufferReserve;
+            }
+
+            if( ulReserved >= REDCONF_BUFFER_COUNT )
+            {
+                ret = -RED_EINVAL;
+            }
+        }
+    #endif
+
     /*  Make sure the configured endianness is correct.
      */
     if( ret == 0 )
@@ -296,6 +346,21 @@ REDSTATUS RedCoreInit( void )
                 }
             }
         #endif
+
+        #if ( REDCONF_STATS == 1 ) || ( REDCONF_LATENCY_STATS == 1 )
+            if( ret == 0 )
+            {
+                ret = RedOsTimestampInit();
+
+                if( ret != 0 )
+                {
+                    #if REDCONF_TASK_COUNT > 1U
+                        ( void ) RedOsMutexUninit();
+                    #endif
+                    ( void ) RedOsClockUninit();
+                }
+            }
+        #endif
     }
 
     return ret;
@@ -329,6 +394,13 @@ REDSTATUS RedCoreUninit( void )
         ret = RedOsClockUninit();
     }
 
+    #if ( REDCONF_STATS == 1 ) || ( REDCONF_LATENCY_STATS == 1 )
+        if( ret == 0 )
+        {
+            ret = RedOsTimestampUninit();
+        }
+    #endif
+
     return ret;
 }
 
@@ -453,6 +525,14 @@ REDSTATUS RedCoreVolUnmount( void )
     if( ret == 0 )
     {
         gpRedVolume->fMounted = false;
+
+        #if REDCONF_BDEV_XIP == 1
+            gpRedVolume->pbMapped = NULL;
+        #endif
+
+        #if REDCONF_BDEV_RAM_ALIAS == 1
+            gpRedVolume->pbAliased = NULL;
+        #endif
     }
 
     return ret;
@@ -500,6 +580,110 @@ REDSTATUS RedCoreVolUnmount( void )
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
+#if REDCONF_TRANSACT_TASK == 1
+
+/** @brief Commit a transaction point if the volume has crossed one of the
+ *         transaction task thresholds.
+ *
+ *  Called periodically by the transaction task.  A volume which is not
+ *  mounted, is read-only, or has no uncommitted changes is left alone.
+ *
+ *  @param ulElapsedMs  Milliseconds since the previous call for this volume,
+ *                      added to the time the volume has been branched.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+    REDSTATUS RedCoreVolTransactPolicy( uint32_t ulElapsedMs )
+    {
+        REDSTATUS ret = 0;
+
+        if( gpRedVolume->fMounted && !gpRedVolume->fReadOnly && gpRedCoreVol->fBranched )
+        {
+            bool fTransact = false;
+
+            if( gpRedCoreVol->ulBranchedMs > ( UINT32_MAX - ulElapsedMs ) )
+            {
+                gpRedCoreVol->ulBranchedMs = UINT32_MAX;
+            }
+            else
+            {
+                gpRedCoreVol->ulBranchedMs += ulElapsedMs;
+            }
+
+            #if REDCONF_TRANSACT_TASK_MAX_AGE_MS > 0U
+                if( gpRedCoreVol->ulBranchedMs >= REDCONF_TRANSACT_TASK_MAX_AGE_MS )
+                {
+                    fTransact = true;
+                }
+            #endif
+
+            #if REDCONF_TRANSACT_TASK_DIRTY_BUFFERS > 0U
+                if( RedBufferDirtyCount() >= REDCONF_TRANSACT_TASK_DIRTY_BUFFERS )
+                {
+                    fTransact = true;
+                }
+            #endif
+
+            #if REDCONF_TRANSACT_TASK_DIRTY_BYTES > 0U
+                if( gpRedCoreVol->ullBytesWritten >= REDCONF_TRANSACT_TASK_DIRTY_BYTES )
+                {
+                    fTransact = true;
+                }
+            #endif
+
+            if( fTransact )
+            {
+                ret = RedVolTransact();
+            }
+        }
+
+        return ret;
+    }
+#endif /* REDCONF_TRANSACT_TASK == 1 */
+
+
+#if REDCONF_STATS == 1
+
+/** @brief Query I/O and cache statistics for the current volume.
+ *
+ *  The volume need not be mounted.
+ *
+ *  @param pStats   The buffer to populate with the statistics.
+ *  @param fReset   Whether to zero the statistics after reading them.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p pStats is `NULL`.
+ */
+    REDSTATUS RedCoreVolStats( REDVOLSTATS * pStats,
+                               bool fReset )
+    {
+        REDSTATUS ret = 0;
+
+        if( pStats == NULL )
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            *pStats = gaRedVolStats[ gbRedVolNum ];
+            pStats->ulBuffersHeld = RedBufferVolCount();
+
+            if( fReset )
+            {
+                RedMemSet( &gaRedVolStats[ gbRedVolNum ], 0U, sizeof( gaRedVolStats[ gbRedVolNum ] ) );
+            }
+        }
+
+        return ret;
+    }
+#endif /* REDCONF_STATS == 1 */
+
+
 #if REDCONF_API_POSIX == 1
 
 /** @brief Query file system status information.
@@ -1488,7 +1672,7 @@ REDSTATUS RedCoreVolUnmount( void )
 
                 pStat->st_dev = gbRedVolNum;
                 pStat->st_ino = ulInode;
-                pStat->st_mode = ino.pInodeBuf->uMode;
+                pStat->st_mode = ( uint16_t ) ( ino.pInodeBuf->uMode & ~INODE_MODE_INLINE );
                 #if REDCONF_API_POSIX_LINK == 1
                     pStat->st_nlink = ino.pInodeBuf->uNLink;
                 #else
@@ -1623,6 +1807,181 @@ REDSTATUS RedCoreFileRead( uint32_t ulInode,
 }
 
 
+#if ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_IOVEC == 1 )
+
+/** @brief Read a contiguous range of a file into several buffers.
+ *
+ *  The buffers are filled in order, starting at @p ullStart, as if by one
+ *  RedCoreFileRead() call per buffer; but the file is only mounted once, and
+ *  since each buffer continues where the last one ended, the seek coordinates
+ *  of the file carry over from one to the next.  The read stops at the
+ *  end-of-file.
+ *
+ *  @param ulInode      The inode number of the file to read.
+ *  @param ullStart     The file offset to read from.
+ *  @param pIov         The buffers to populate with the data read.
+ *  @param ulIovCount   The number of buffers in @p pIov.
+ *  @param pulLen       On successful exit, populated with the number of bytes
+ *                      read.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  @p ulInode is not a valid inode number.
+ *  @retval -RED_EINVAL The volume is not mounted; or @p pIov is `NULL` and
+ *                      @p ulIovCount is nonzero; or a buffer is `NULL`; or
+ *                      @p pulLen is `NULL`.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR The inode is a directory inode.
+ */
+    REDSTATUS RedCoreFileReadV( uint32_t ulInode,
+                                uint64_t ullStart,
+                                const REDFSEIOVEC * pIov,
+                                uint32_t ulIovCount,
+                                uint32_t * pulLen )
+    {
+        REDSTATUS ret;
+
+        if( !gpRedVolume->fMounted || ( pulLen == NULL ) || ( ( pIov == NULL ) && ( ulIovCount > 0U ) ) )
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            #if ( REDCONF_ATIME == 1 ) && ( REDCONF_READ_ONLY == 0 )
+                bool fUpdateAtime = ( ulIovCount > 0U ) && !gpRedVolume->fReadOnly;
+            #else
+                bool fUpdateAtime = false;
+            #endif
+            CINODE ino;
+
+            ino.ulInode = ulInode;
+            ret = RedInodeMount( &ino, FTYPE_FILE, fUpdateAtime );
+
+            if( ret == 0 )
+            {
+                uint32_t ulLen = 0U;
+                uint32_t ulIdx;
+
+                for( ulIdx = 0U; ulIdx < ulIovCount; ulIdx++ )
+                {
+                    uint32_t ulThisLen = pIov[ ulIdx ].ulLength;
+
+                    ret = RedInodeDataRead( &ino, ullStart + ulLen, &ulThisLen, pIov[ ulIdx ].pBuffer );
+
+                    if( ret != 0 )
+                    {
+                        break;
+                    }
+
+                    ulLen += ulThisLen;
+
+                    /*  A short read means the end-of-file was reached.
+                     */
+                    if( ulThisLen < pIov[ ulIdx ].ulLength )
+                    {
+                        break;
+                    }
+                }
+
+                if( ret == 0 )
+                {
+                    *pulLen = ulLen;
+                }
+
+                #if ( REDCONF_ATIME == 1 ) && ( REDCONF_READ_ONLY == 0 )
+                    RedInodePut( &ino, ( ( ret == 0 ) && fUpdateAtime ) ? IPUT_UPDATE_ATIME : 0U );
+                #else
+                    RedInodePut( &ino, 0U );
+                #endif
+            }
+        }
+
+        return ret;
+    }
+#endif /* ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_IOVEC == 1 ) */
+
+
+#if REDCONF_READBUF_COUNT > 0U
+
+/** @brief Lend the buffer holding file data at a given offset.
+ *
+ *  Rather than copying the data like RedCoreFileRead(), the block containing
+ *  @p ullStart is left referenced in the buffer cache and handed out; it must
+ *  be given back with RedCoreFileReturn().  Until then, the caller must not
+ *  allow the file data to be modified.
+ *
+ *  @param ulInode  The inode number of the file to read.
+ *  @param ullStart The file offset to read from.
+ *  @param pulLen   On entry, contains the maximum number of bytes to lend; on
+ *                  successful exit, contains the number of bytes available at
+ *                  @p ullStart, which never extend past the end of its block.
+ *                  Zero if @p ullStart is at or beyond the end-of-file.
+ *  @param ppbBlock On successful exit, if @p pulLen is nonzero, populated with
+ *                  the start of the lent block, to be given back.
+ *  @param ppbData  On successful exit, if @p pulLen is nonzero, populated with
+ *                  the data at @p ullStart.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  @p ulInode is not a valid inode number.
+ *  @retval -RED_EINVAL The volume is not mounted; or @p ppbBlock or @p ppbData
+ *                      is `NULL`.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR The inode is a directory inode.
+ */
+    REDSTATUS RedCoreFileLend( uint32_t ulInode,
+                               uint64_t ullStart,
+                               uint32_t * pulLen,
+                               const uint8_t ** ppbBlock,
+                               const uint8_t ** ppbData )
+    {
+        REDSTATUS ret;
+
+        if( !gpRedVolume->fMounted || ( pulLen == NULL ) )
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            #if ( REDCONF_ATIME == 1 ) && ( REDCONF_READ_ONLY == 0 )
+                bool fUpdateAtime = ( *pulLen > 0U ) && !gpRedVolume->fReadOnly;
+            #else
+                bool fUpdateAtime = false;
+            #endif
+            CINODE ino;
+
+            ino.ulInode = ulInode;
+            ret = RedInodeMount( &ino, FTYPE_FILE, fUpdateAtime );
+
+            if( ret == 0 )
+            {
+                ret = RedInodeDataLend( &ino, ullStart, pulLen, ppbBlock, ppbData );
+
+                #if ( REDCONF_ATIME == 1 ) && ( REDCONF_READ_ONLY == 0 )
+                    RedInodePut( &ino, ( ( ret == 0 ) && fUpdateAtime ) ? IPUT_UPDATE_ATIME : 0U );
+                #else
+                    RedInodePut( &ino, 0U );
+                #endif
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Give back a block lent by RedCoreFileLend().
+ *
+ *  @param pbBlock  The start of the lent block.
+ */
+    void RedCoreFileReturn( const uint8_t * pbBlock )
+    {
+        RedInodeDataReturn( pbBlock );
+    }
+#endif /* if REDCONF_READBUF_COUNT > 0U */
+
+
 #if REDCONF_READ_ONLY == 0
 
 /** @brief Write to a file.
@@ -1739,50 +2098,501 @@ REDSTATUS RedCoreFileRead( uint32_t ulInode,
         {
             CINODE ino;
 
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+                bool fChanged;
+            #endif
+
             ino.ulInode = ulInode;
-            ret = RedInodeMount( &ino, FTYPE_FILE, true );
+
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+                ret = CoreFileMount( &ino, &fChanged );
+            #else
+                ret = RedInodeMount( &ino, FTYPE_FILE, true );
+            #endif
 
             if( ret == 0 )
             {
                 ret = RedInodeDataWrite( &ino, ullStart, pulLen, pBuffer );
 
                 RedInodePut( &ino, ( ret == 0 ) ? ( uint8_t ) ( IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME ) : 0U );
+
+                #if REDCONF_INTENT_LOG_BLOCKS > 0U
+                    if( ret == 0 )
+                    {
+                        RedIntentRecord( ulInode, fChanged, INTENT_WRITE, ullStart, *pulLen, pBuffer );
+                    }
+                    else
+                    {
+                        /*  The write may have changed part of the file.
+                         */
+                        RedIntentDrop( ulInode );
+                    }
+                #endif
             }
+
+            #if REDCONF_TRANSACT_TASK == 1
+                if( ret == 0 )
+                {
+                    gpRedCoreVol->ullBytesWritten += *pulLen;
+                }
+            #endif
         }
 
         return ret;
     }
-#endif /* REDCONF_READ_ONLY == 0 */
 
 
-#if TRUNCATE_SUPPORTED
+    #if ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_IOVEC == 1 )
 
-/** @brief Set the file size.
+/** @brief Write a contiguous range of a file from several buffers.
  *
- *  Allows the file size to be increased, decreased, or to remain the same.  If
- *  the file size is increased, the new area is sparse (will read as zeroes).
- *  If the file size is decreased, the data beyond the new end-of-file will
- *  return to free space once it is no longer part of the committed state
- *  (either immediately or after the next transaction point).
+ *  The buffers are written in order, starting at @p ullStart, as if by one
+ *  RedCoreFileWrite() call per buffer; but the file is only mounted once,
+ *  the seek coordinates carry over from one buffer to the next, and the
+ *  automatic transaction for #RED_TRANSACT_WRITE happens once, at the end.
  *
- *  @param ulInode  The inode of the file to truncate.
- *  @param ullSize  The new file size, in bytes.
+ *  As with RedCoreFileWrite(), a short write indicates that the file system
+ *  ran out of space, or that the file reached the maximum file size, after
+ *  some of the data was written.
+ *
+ *  @param ulInode      The file number of the file to write.
+ *  @param ullStart     The file offset to write at.
+ *  @param pIov         The buffers containing the data to be written.
+ *  @param ulIovCount   The number of buffers in @p pIov.
+ *  @param pulLen       On successful exit, populated with the number of bytes
+ *                      written.
  *
  *  @return A negated ::REDSTATUS code indicating the operation result.
  *
  *  @retval 0           Operation was successful.
- *  @retval -RED_EBADF  @p ulInode is not a valid inode number.
- *  @retval -RED_EFBIG  @p ullSize exceeds the maximum file size.
- *  @retval -RED_EINVAL The volume is not mounted.
+ *  @retval -RED_EBADF  @p ulInode is not a valid file number.
+ *  @retval -RED_EFBIG  No data can be written to the given file offset since
+ *                      the resulting file size would exceed the maximum file
+ *                      size.
+ *  @retval -RED_EINVAL The volume is not mounted; or @p pIov is `NULL` and
+ *                      @p ulIovCount is nonzero; or a buffer is `NULL`; or
+ *                      @p pulLen is `NULL`.
  *  @retval -RED_EIO    A disk I/O error occurred.
  *  @retval -RED_EISDIR The inode is a directory inode.
- *  @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+ *  @retval -RED_ENOSPC No data can be written because there is insufficient
+ *                      free space.
  *  @retval -RED_EROFS  The file system volume is read-only.
  */
-    REDSTATUS RedCoreFileTruncate( uint32_t ulInode,
-                                   uint64_t ullSize )
-    {
-        REDSTATUS ret;
+        REDSTATUS RedCoreFileWriteV( uint32_t ulInode,
+                                     uint64_t ullStart,
+                                     const REDFSEIOVEC * pIov,
+                                     uint32_t ulIovCount,
+                                     uint32_t * pulLen )
+        {
+            REDSTATUS ret;
+
+            if( !gpRedVolume->fMounted || ( pulLen == NULL ) || ( ( pIov == NULL ) && ( ulIovCount > 0U ) ) )
+            {
+                ret = -RED_EINVAL;
+            }
+            else if( gpRedVolume->fReadOnly )
+            {
+                ret = -RED_EROFS;
+            }
+            else
+            {
+                uint32_t ulIovDone;
+                uint32_t ulLen;
+
+                ret = CoreFileWriteV( ulInode, ullStart, pIov, ulIovCount, &ulIovDone, &ulLen );
+
+                if( ( ret == -RED_ENOSPC ) &&
+                    ( ( gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL ) != 0U ) &&
+                    ( gpRedCoreVol->ulAlmostFreeBlocks > 0U ) )
+                {
+                    ret = RedVolTransact();
+
+                    if( ret == 0 )
+                    {
+                        uint32_t ulMoreIovDone;
+                        uint32_t ulMoreLen;
+
+                        /*  Nothing of the buffer which ran out of space was
+                         *  written, so resume with it.
+                         */
+                        ret = CoreFileWriteV( ulInode, ullStart + ulLen, &pIov[ ulIovDone ], ulIovCount - ulIovDone, &ulMoreIovDone, &ulMoreLen );
+                        ulLen += ulMoreLen;
+                    }
+                }
+
+                /*  Running out of space or reaching the maximum file size
+                 *  after some of the buffers were written is a short write.
+                 */
+                if( ( ( ret == -RED_ENOSPC ) || ( ret == -RED_EFBIG ) ) && ( ulLen > 0U ) )
+                {
+                    ret = 0;
+                }
+
+                if( ( ret == 0 ) && ( ( gpRedVolume->ulTransMask & RED_TRANSACT_WRITE ) != 0U ) )
+                {
+                    ret = RedVolTransact();
+                }
+
+                if( ret == 0 )
+                {
+                    *pulLen = ulLen;
+                }
+            }
+
+            return ret;
+        }
+
+
+/** @brief Write a contiguous range of a file from several buffers, with the
+ *         file mounted once.
+ *
+ *  @param ulInode      The file number of the file to write.
+ *  @param ullStart     The file offset to write at.
+ *  @param pIov         The buffers containing the data to be written.
+ *  @param ulIovCount   The number of buffers in @p pIov.
+ *  @param pulIovDone   Populated with the index of the buffer the write
+ *                      stopped at: @p ulIovCount if all were written.  On
+ *                      error, nothing of that buffer was written.
+ *  @param pulLen       Populated with the number of bytes written, even on
+ *                      error.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  @p ulInode is not a valid file number.
+ *  @retval -RED_EFBIG  The buffer at *@p pulIovDone cannot be written since
+ *                      the file would exceed the maximum file size.
+ *  @retval -RED_EINVAL A buffer is `NULL`.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR The inode is a directory inode.
+ *  @retval -RED_ENOSPC The buffer at *@p pulIovDone cannot be written because
+ *                      there is insufficient free space.
+ */
+        static REDSTATUS CoreFileWriteV( uint32_t ulInode,
+                                         uint64_t ullStart,
+                                         const REDFSEIOVEC * pIov,
+                                         uint32_t ulIovCount,
+                                         uint32_t * pulIovDone,
+                                         uint32_t * pulLen )
+        {
+            REDSTATUS ret;
+            CINODE ino;
+            uint32_t ulIdx = 0U;
+            uint32_t ulLen = 0U;
+
+            ino.ulInode = ulInode;
+            ret = RedInodeMount( &ino, FTYPE_FILE, true );
+
+            if( ret == 0 )
+            {
+                while( ulIdx < ulIovCount )
+                {
+                    uint32_t ulThisLen = pIov[ ulIdx ].ulLength;
+
+                    ret = RedInodeDataWrite( &ino, ullStart + ulLen, &ulThisLen, pIov[ ulIdx ].pBuffer );
+
+                    if( ret != 0 )
+                    {
+                        break;
+                    }
+
+                    ulLen += ulThisLen;
+
+                    if( ulThisLen < pIov[ ulIdx ].ulLength )
+                    {
+                        break;
+                    }
+
+                    ulIdx++;
+                }
+
+                RedInodePut( &ino, ( ulLen > 0U ) ? ( uint8_t ) ( IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME ) : 0U );
+            }
+
+            #if REDCONF_TRANSACT_TASK == 1
+                gpRedCoreVol->ullBytesWritten += ulLen;
+            #endif
+
+            *pulIovDone = ulIdx;
+            *pulLen = ulLen;
+
+            return ret;
+        }
+    #endif /* ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_IOVEC == 1 ) */
+
+
+    #if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+/** @brief Mount and branch a file which is about to be changed.
+ *
+ *  @param pInode       The cached inode structure, with pInode->ulInode set to
+ *                      the file to mount.
+ *  @param pfChanged    Populated with whether the file had already changed
+ *                      since the last transaction point.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  pInode->ulInode is not a valid inode number.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR The inode is a directory inode.
+ */
+        static REDSTATUS CoreFileMount( CINODE * pInode,
+                                        bool * pfChanged )
+        {
+            REDSTATUS ret;
+
+            ret = RedInodeMount( pInode, FTYPE_FILE, false );
+
+            if( ret == 0 )
+            {
+                /*  Any change to a file branches its inode, so an inode which is
+                 *  not yet branched is the same as in the committed state.
+                 */
+                *pfChanged = pInode->fBranched;
+
+                ret = RedInodeBranch( pInode );
+
+                if( ret != 0 )
+                {
+                    RedInodePut( pInode, 0U );
+                }
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_INTENT_LOG_BLOCKS > 0U */
+#endif /* REDCONF_READ_ONLY == 0 */
+
+
+#if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )
+
+/** @brief Make the changes to a file durable.
+ *
+ *  If every change to the file since the last transaction point is held by
+ *  the intent log, a sync record for the file is added to the log and only the
+ *  log is written; otherwise, a transaction point is committed.
+ *
+ *  @param ulInode  The inode number of the file or directory.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The volume is not mounted.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EROFS  The file system volume is read-only.
+ */
+    REDSTATUS RedCoreFileSync( uint32_t ulInode )
+    {
+        REDSTATUS ret;
+
+        if( !gpRedVolume->fMounted )
+        {
+            ret = -RED_EINVAL;
+        }
+        else if( gpRedVolume->fReadOnly )
+        {
+            ret = -RED_EROFS;
+        }
+
+        #if REDCONF_INTENT_LOG_BLOCKS > 0U
+            else if( RedIntentSync( ulInode ) )
+            {
+                ret = RedIntentFlush();
+            }
+        #endif
+        else
+        {
+            ( void ) ulInode;
+
+            ret = RedVolTransact();
+        }
+
+        return ret;
+    }
+#endif /* ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 ) */
+
+
+#if COPY_SUPPORTED
+
+/** @brief Copy data from one file to another.
+ *
+ *  The data is copied a block at a time: each source block is read into the
+ *  buffer cache and written to the destination directly from its buffer, so
+ *  no intermediate buffer is needed.  Sparse source data is copied as zeroes.
+ *
+ *  A short copy -- where the number of bytes copied is less than requested --
+ *  indicates that the end of the source file was reached; or, if some data was
+ *  copied, that the file system ran out of space or that the destination
+ *  reached the maximum file size.
+ *
+ *  If an error is returned, either no data was copied or a critical error
+ *  occurred (like an I/O error) and the file system volume will be read-only.
+ *
+ *  @param ulSrcInode   The inode number of the file to copy from.
+ *  @param ullSrcStart  The file offset to copy from.
+ *  @param ulDstInode   The inode number of the file to copy to.  Must not be
+ *                      the same as @p ulSrcInode.
+ *  @param ullDstStart  The file offset to copy to.
+ *  @param pulLen       On entry, the number of bytes to copy; on successful
+ *                      exit, the number of bytes actually copied.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  @p ulSrcInode or @p ulDstInode is not a valid inode
+ *                      number.
+ *  @retval -RED_EFBIG  No data can be written to the given destination offset
+ *                      since the resulting file size would exceed the maximum
+ *                      file size.
+ *  @retval -RED_EINVAL The volume is not mounted; or @p pulLen is `NULL`; or
+ *                      @p ulSrcInode and @p ulDstInode are the same.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR Either inode is a directory inode.
+ *  @retval -RED_ENOSPC No data can be copied because there is insufficient
+ *                      free space.
+ *  @retval -RED_EROFS  The file system volume is read-only.
+ */
+    REDSTATUS RedCoreFileCopy( uint32_t ulSrcInode,
+                               uint64_t ullSrcStart,
+                               uint32_t ulDstInode,
+                               uint64_t ullDstStart,
+                               uint32_t * pulLen )
+    {
+        REDSTATUS ret = 0;
+
+        if( !gpRedVolume->fMounted || ( pulLen == NULL ) || ( ulSrcInode == ulDstInode ) )
+        {
+            ret = -RED_EINVAL;
+        }
+        else if( gpRedVolume->fReadOnly )
+        {
+            ret = -RED_EROFS;
+        }
+        else
+        {
+            #if REDCONF_ATIME == 1
+                bool fUpdateAtime = true;
+            #else
+                bool fUpdateAtime = false;
+            #endif
+            uint32_t ulCopied = 0U;
+            bool fDone = false;
+
+            while( ( ret == 0 ) && !fDone && ( ulCopied < *pulLen ) )
+            {
+                uint32_t ulLen = *pulLen - ulCopied;
+                const uint8_t * pbBlock = NULL;
+                const uint8_t * pbData = NULL;
+                CINODE ino;
+
+                /*  Only the data buffer of the source stays referenced while
+                 *  the destination is written, which together need no more
+                 *  buffers than a create.
+                 */
+                ino.ulInode = ulSrcInode;
+                ret = RedInodeMount( &ino, FTYPE_FILE, fUpdateAtime );
+
+                if( ret == 0 )
+                {
+                    ret = RedInodeDataLend( &ino, ullSrcStart + ulCopied, &ulLen, &pbBlock, &pbData );
+
+                    RedInodePut( &ino, ( ( ret == 0 ) && fUpdateAtime ) ? IPUT_UPDATE_ATIME : 0U );
+                }
+
+                if( ( ret == 0 ) && ( ulLen == 0U ) )
+                {
+                    /*  End of the source file.
+                     */
+                    fDone = true;
+                }
+                else if( ret == 0 )
+                {
+                    uint32_t ulLenWrote = ulLen;
+
+                    ret = CoreFileWrite( ulDstInode, ullDstStart + ulCopied, &ulLenWrote, pbData );
+
+                    if( ( ret == -RED_ENOSPC ) &&
+                        ( ( gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL ) != 0U ) &&
+                        ( gpRedCoreVol->ulAlmostFreeBlocks > 0U ) )
+                    {
+                        ret = RedVolTransact();
+
+                        if( ret == 0 )
+                        {
+                            ulLenWrote = ulLen;
+                            ret = CoreFileWrite( ulDstInode, ullDstStart + ulCopied, &ulLenWrote, pbData );
+                        }
+                    }
+
+                    RedInodeDataReturn( pbBlock );
+
+                    if( ret == 0 )
+                    {
+                        ulCopied += ulLenWrote;
+                        fDone = ulLenWrote < ulLen;
+                    }
+                }
+                else
+                {
+                    /*  No action, just return the error.
+                     */
+                }
+            }
+
+            /*  Like a short write, running out of space or reaching the
+             *  maximum file size part way through is not an error: the data
+             *  copied so far is reported.
+             */
+            if( ( ulCopied > 0U ) && ( ( ret == -RED_ENOSPC ) || ( ret == -RED_EFBIG ) ) )
+            {
+                ret = 0;
+            }
+
+            if( ret == 0 )
+            {
+                *pulLen = ulCopied;
+
+                if( ( ulCopied > 0U ) && ( ( gpRedVolume->ulTransMask & RED_TRANSACT_WRITE ) != 0U ) )
+                {
+                    ret = RedVolTransact();
+                }
+            }
+        }
+
+        return ret;
+    }
+#endif /* COPY_SUPPORTED */
+
+
+#if TRUNCATE_SUPPORTED
+
+/** @brief Set the file size.
+ *
+ *  Allows the file size to be increased, decreased, or to remain the same.  If
+ *  the file size is increased, the new area is sparse (will read as zeroes).
+ *  If the file size is decreased, the data beyond the new end-of-file will
+ *  return to free space once it is no longer part of the committed state
+ *  (either immediately or after the next transaction point).
+ *
+ *  @param ulInode  The inode of the file to truncate.
+ *  @param ullSize  The new file size, in bytes.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  @p ulInode is not a valid inode number.
+ *  @retval -RED_EFBIG  @p ullSize exceeds the maximum file size.
+ *  @retval -RED_EINVAL The volume is not mounted.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR The inode is a directory inode.
+ *  @retval -RED_ENOSPC Insufficient free space to perform the truncate.
+ *  @retval -RED_EROFS  The file system volume is read-only.
+ */
+    REDSTATUS RedCoreFileTruncate( uint32_t ulInode,
+                                   uint64_t ullSize )
+    {
+        REDSTATUS ret;
 
         if( !gpRedVolume->fMounted )
         {
@@ -1846,8 +2656,17 @@ REDSTATUS RedCoreFileRead( uint32_t ulInode,
         {
             CINODE ino;
 
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+                bool fChanged;
+            #endif
+
             ino.ulInode = ulInode;
-            ret = RedInodeMount( &ino, FTYPE_FILE, true );
+
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+                ret = CoreFileMount( &ino, &fChanged );
+            #else
+                ret = RedInodeMount( &ino, FTYPE_FILE, true );
+            #endif
 
             if( ret == 0 )
             {
@@ -1862,6 +2681,17 @@ REDSTATUS RedCoreFileRead( uint32_t ulInode,
                 #endif
 
                 RedInodePut( &ino, ( ret == 0 ) ? ( uint8_t ) ( IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME ) : 0U );
+
+                #if REDCONF_INTENT_LOG_BLOCKS > 0U
+                    if( ret == 0 )
+                    {
+                        RedIntentRecord( ulInode, fChanged, INTENT_TRUNCATE, ullSize, 0U, NULL );
+                    }
+                    else
+                    {
+                        RedIntentDrop( ulInode );
+                    }
+                #endif
             }
         }
 
@@ -1870,6 +2700,152 @@ REDSTATUS RedCoreFileRead( uint32_t ulInode,
 #endif /* TRUNCATE_SUPPORTED */
 
 
+#if FALLOCATE_SUPPORTED
+
+/** @brief Allocate the data blocks of a range of a file.
+ *
+ *  Sparse blocks in the range are allocated and zeroed, in contiguous runs as
+ *  far as free space allows, so that data later written to the range is laid
+ *  out sequentially on disk.  If the range extends beyond the end-of-file, the
+ *  file size is increased to the end of the range; the new area reads as
+ *  zeroes.
+ *
+ *  Since blocks are copied on write, writing to an allocated block after a
+ *  transaction point moves it, which undoes the layout for that block.  For
+ *  the best layout, write the range before the next transaction point.
+ *
+ *  @param ulInode  The inode of the file.
+ *  @param ullStart The file offset of the start of the range.
+ *  @param ullLen   The length of the range, in bytes.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  @p ulInode is not a valid inode number.
+ *  @retval -RED_EFBIG  The range extends beyond the maximum file size.
+ *  @retval -RED_EINVAL The volume is not mounted.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR The inode is a directory inode.
+ *  @retval -RED_ENOSPC Insufficient free space to allocate the whole range.
+ *  @retval -RED_EROFS  The file system volume is read-only.
+ */
+    REDSTATUS RedCoreFileAllocate( uint32_t ulInode,
+                                   uint64_t ullStart,
+                                   uint64_t ullLen )
+    {
+        REDSTATUS ret;
+
+        if( !gpRedVolume->fMounted )
+        {
+            ret = -RED_EINVAL;
+        }
+        else if( gpRedVolume->fReadOnly )
+        {
+            ret = -RED_EROFS;
+        }
+        else
+        {
+            ret = CoreFileAllocate( ulInode, ullStart, ullLen );
+
+            if( ( ret == -RED_ENOSPC ) &&
+                ( ( gpRedVolume->ulTransMask & RED_TRANSACT_VOLFULL ) != 0U ) &&
+                ( gpRedCoreVol->ulAlmostFreeBlocks > 0U ) )
+            {
+                ret = RedVolTransact();
+
+                if( ret == 0 )
+                {
+                    ret = CoreFileAllocate( ulInode, ullStart, ullLen );
+                }
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Allocate the data blocks of a range of a file.
+ *
+ *  @param ulInode  The inode of the file.
+ *  @param ullStart The file offset of the start of the range.
+ *  @param ullLen   The length of the range, in bytes.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBADF  @p ulInode is not a valid inode number.
+ *  @retval -RED_EFBIG  The range extends beyond the maximum file size.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EISDIR The inode is a directory inode.
+ *  @retval -RED_ENOSPC Insufficient free space to allocate the whole range.
+ */
+    static REDSTATUS CoreFileAllocate( uint32_t ulInode,
+                                       uint64_t ullStart,
+                                       uint64_t ullLen )
+    {
+        CINODE ino;
+        REDSTATUS ret;
+
+        ino.ulInode = ulInode;
+        ret = RedInodeMount( &ino, FTYPE_FILE, true );
+
+        if( ret == 0 )
+        {
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+                /*  Allocations are not logged, so from now on the file can only
+                 *  be made durable by a transaction point.
+                 */
+                RedIntentDrop( ulInode );
+            #endif
+
+            ret = RedInodeDataAllocate( &ino, ullStart, ullLen );
+
+            /*  Even on failure, part of the range may have been allocated and
+             *  the file size increased, so the inode is always updated.
+             */
+            RedInodePut( &ino, ( uint8_t ) ( IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME ) );
+        }
+
+        return ret;
+    }
+#endif /* FALLOCATE_SUPPORTED */
+
+
+#if REDCONF_READAHEAD_BLOCKS > 0U
+
+/** @brief Read the read-ahead statistics.
+ *
+ *  The statistics are shared by all volumes.
+ *
+ *  @param pStats   Populated with the read-ahead statistics.
+ *  @param fReset   Whether to zero the statistics after reading them.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p pStats is `NULL`.
+ */
+    REDSTATUS RedCoreReadAheadStats( REDRASTATS * pStats,
+                                     bool fReset )
+    {
+        REDSTATUS ret;
+
+        if( pStats == NULL )
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            RedInodeDataReadAheadStats( pStats, fReset );
+            ret = 0;
+        }
+
+        return ret;
+    }
+#endif /* REDCONF_READAHEAD_BLOCKS > 0U */
+
+
 #if ( REDCONF_API_POSIX == 1 ) && ( REDCONF_API_POSIX_READDIR == 1 )
 
 /** @brief Read from a directory.
@@ -71,6 +71,38 @@
     } DIRENT;
 
 
+    #if REDCONF_DIR_INDEX_DIRS > 0U
+        #define DIR_INDEX_SLOT_EMPTY      UINT32_MAX
+        #define DIR_INDEX_SLOT_DELETED    ( UINT32_MAX - 1U )
+        #define DIR_INDEX_SLOT_LIMIT      ( ( REDCONF_DIR_INDEX_SLOTS / 4U ) * 3U )
+
+/** @brief One slot in a directory index hash table.
+ */
+        typedef struct
+        {
+            uint32_t ulHash;     /**< Hash of the name in the directory entry. */
+            uint32_t ulEntryIdx; /**< Directory entry index, or DIR_INDEX_SLOT_EMPTY or DIR_INDEX_SLOT_DELETED. */
+        } DIRINDEXSLOT;
+
+/** @brief In-memory name hash index for one directory.
+ *
+ *  The index maps the hash of each name in the directory to the position of
+ *  its directory entry.  It is never written to disk: it is built by scanning
+ *  the directory, kept up to date as entries are written, and discarded at
+ *  mount time and when the directory inode is freed.
+ */
+        typedef struct
+        {
+            uint32_t ulInode;    /**< Directory inode number, or INODE_INVALID if the index is unused. */
+            bool fOverflow;      /**< The directory has too many entries to be indexed. */
+            uint32_t ulUsed;     /**< Number of slots which are not empty, including deleted slots. */
+            uint32_t ulFreeHint; /**< Every directory entry before this index is known to be in use. */
+            uint32_t ulLastUse;  /**< Value of gulDirIndexTick when the index was last used. */
+            DIRINDEXSLOT aSlot[ REDCONF_DIR_INDEX_SLOTS ];
+        } DIRINDEX;
+    #endif /* REDCONF_DIR_INDEX_DIRS > 0U */
+
+
     #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RENAME == 1 )
         static REDSTATUS DirCyclicRenameCheck( uint32_t ulSrcInode,
                                                const CINODE * pDstPInode );
@@ -84,6 +116,47 @@
         static uint64_t DirEntryIndexToOffset( uint32_t ulIdx );
     #endif
     static uint32_t DirOffsetToEntryIndex( uint64_t ullOffset );
+    static REDSTATUS DirEntryScan( CINODE * pPInode,
+                                   const char * pszName,
+                                   uint32_t ulNameLen,
+                                   uint32_t * pulEntryIdx,
+                                   uint32_t * pulInode );
+    static bool DirentNameMatches( const DIRENT * pDirent,
+                                   const char * pszName,
+                                   uint32_t ulNameLen );
+    #if REDCONF_DIR_INDEX_DIRS > 0U
+        static REDSTATUS DirIndexGet( CINODE * pPInode,
+                                      DIRINDEX ** ppIndex );
+        static REDSTATUS DirIndexLookup( CINODE * pPInode,
+                                         DIRINDEX * pIndex,
+                                         const char * pszName,
+                                         uint32_t ulNameLen,
+                                         uint32_t * pulEntryIdx,
+                                         uint32_t * pulInode );
+        static REDSTATUS DirIndexFreeEntry( CINODE * pPInode,
+                                            DIRINDEX * pIndex,
+                                            uint32_t * pulFreeIdx );
+        static bool DirIndexInsert( DIRINDEX * pIndex,
+                                    uint32_t ulHash,
+                                    uint32_t ulEntryIdx );
+        static uint32_t DirNameHash( const char * pszName,
+                                     uint32_t ulNameLen );
+        #if REDCONF_READ_ONLY == 0
+            static void DirIndexUpdate( const CINODE * pPInode,
+                                        uint32_t ulEntryIdx,
+                                        uint32_t ulInode,
+                                        const char * pszName,
+                                        uint32_t ulNameLen,
+                                        REDSTATUS status );
+        #endif
+
+
+/*  The indexes are kept per volume so that, when each volume has its own lock,
+ *  a task on one volume never replaces an index in use by a task on another.
+ */
+        static DIRINDEX gaDirIndex[ REDCONF_VOLUME_COUNT ][ REDCONF_DIR_INDEX_DIRS ];
+        static uint32_t gulDirIndexTick;
+    #endif /* REDCONF_DIR_INDEX_DIRS > 0U */
 
 
     #if REDCONF_READ_ONLY == 0
@@ -266,6 +339,10 @@
                 {
                     ret = RedInodeDataTruncate( pPInode, DirEntryIndexToOffset( ulTruncIdx ) );
                 }
+
+                #if REDCONF_DIR_INDEX_DIRS > 0U
+                    DirIndexUpdate( pPInode, ulDeleteIdx, INODE_INVALID, "", 0U, ret );
+                #endif
             }
             else
             {
@@ -340,121 +417,163 @@
             }
             else
             {
-                uint32_t ulIdx = 0U;
-                uint32_t ulDirentCount = DirOffsetToEntryIndex( pPInode->pInodeBuf->ullSize );
-                uint32_t ulFreeIdx = DIR_INDEX_INVALID; /* Index of first free dirent. */
+                #if REDCONF_DIR_INDEX_DIRS > 0U
+                    DIRINDEX * pIndex;
 
-                /*  Loop over the directory blocks, searching each block for a
-                 *  dirent that matches the given name.
-                 */
-                while( ( ret == 0 ) && ( ulIdx < ulDirentCount ) )
-                {
-                    ret = RedInodeDataSeekAndRead( pPInode, ulIdx / DIRENTS_PER_BLOCK );
+                    ret = DirIndexGet( pPInode, &pIndex );
 
-                    if( ret == 0 )
+                    if( ( ret == 0 ) && ( pIndex != NULL ) )
                     {
-                        const DIRENT * pDirents = CAST_CONST_DIRENT_PTR( pPInode->pbData );
-                        uint32_t ulBlockLastIdx = REDMIN( DIRENTS_PER_BLOCK, ulDirentCount - ulIdx );
-                        uint32_t ulBlockIdx;
+                        ret = DirIndexLookup( pPInode, pIndex, pszName, ulNameLen, pulEntryIdx, pulInode );
+                    }
+                    else if( ret == 0 )
+                    {
+                        ret = DirEntryScan( pPInode, pszName, ulNameLen, pulEntryIdx, pulInode );
+                    }
+                    else
+                    {
+                        /*  Unexpected error, no action.
+                         */
+                    }
+                #else
+                    ret = DirEntryScan( pPInode, pszName, ulNameLen, pulEntryIdx, pulInode );
+                #endif
+            }
+        }
 
-                        for( ulBlockIdx = 0U; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++ )
-                        {
-                            const DIRENT * pDirent = &pDirents[ ulBlockIdx ];
+        return ret;
+    }
 
-                            if( pDirent->ulInode != INODE_INVALID )
-                            {
-                                /*  The name in the dirent will not be null
-                                 *  terminated if it is of the maximum length, so
-                                 *  use a bounded string compare and then make sure
-                                 *  there is nothing more to the name.
-                                 */
-                                if( ( RedStrNCmp( pDirent->acName, pszName, ulNameLen ) == 0 ) &&
-                                    ( ( ulNameLen == REDCONF_NAME_MAX ) || ( pDirent->acName[ ulNameLen ] == '\0' ) ) )
-                                {
-                                    /*  Found a matching dirent, stop and return its
-                                     *  information.
-                                     */
-                                    if( pulInode != NULL )
-                                    {
-                                        *pulInode = pDirent->ulInode;
-
-                                        #ifdef REDCONF_ENDIAN_SWAP
-                                            *pulInode = RedRev32( *pulInode );
-                                        #endif
-                                    }
-
-                                    ulIdx += ulBlockIdx;
-                                    break;
-                                }
-                            }
-                            else if( ulFreeIdx == DIR_INDEX_INVALID )
-                            {
-                                ulFreeIdx = ulIdx + ulBlockIdx;
-                            }
-                            else
-                            {
-                                /*  The directory entry is free, but we already found a free one, so there's
-                                 *  nothing to do here.
-                                 */
-                            }
-                        }
 
-                        if( ulBlockIdx < ulBlockLastIdx )
+/** @brief Search a directory for a given name by reading every block.
+ *
+ *  @param pPInode      A pointer to the cached inode structure of the directory
+ *                      to search.
+ *  @param pszName      The name of the desired entry.
+ *  @param ulNameLen    The length of @p pszName.
+ *  @param pulEntryIdx  As for RedDirEntryLookup().
+ *  @param pulInode     As for RedDirEntryLookup().
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOENT @p pszName does not name an existing file or directory.
+ */
+    static REDSTATUS DirEntryScan( CINODE * pPInode,
+                                   const char * pszName,
+                                   uint32_t ulNameLen,
+                                   uint32_t * pulEntryIdx,
+                                   uint32_t * pulInode )
+    {
+        REDSTATUS ret = 0;
+        uint32_t ulIdx = 0U;
+        uint32_t ulDirentCount = DirOffsetToEntryIndex( pPInode->pInodeBuf->ullSize );
+        uint32_t ulFreeIdx = DIR_INDEX_INVALID; /* Index of first free dirent. */
+
+        /*  Loop over the directory blocks, searching each block for a
+         *  dirent that matches the given name.
+         */
+        while( ( ret == 0 ) && ( ulIdx < ulDirentCount ) )
+        {
+            ret = RedInodeDataSeekAndRead( pPInode, ulIdx / DIRENTS_PER_BLOCK );
+
+            if( ret == 0 )
+            {
+                const DIRENT * pDirents = CAST_CONST_DIRENT_PTR( pPInode->pbData );
+                uint32_t ulBlockLastIdx = REDMIN( DIRENTS_PER_BLOCK, ulDirentCount - ulIdx );
+                uint32_t ulBlockIdx;
+
+                for( ulBlockIdx = 0U; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++ )
+                {
+                    const DIRENT * pDirent = &pDirents[ ulBlockIdx ];
+
+                    if( pDirent->ulInode != INODE_INVALID )
+                    {
+                        if( DirentNameMatches( pDirent, pszName, ulNameLen ) )
                         {
-                            /*  If we broke out of the for loop, we found a matching
-                             *  dirent and can stop the search.
+                            /*  Found a matching dirent, stop and return its
+                             *  information.
                              */
+                            if( pulInode != NULL )
+                            {
+                                *pulInode = pDirent->ulInode;
+
+                                #ifdef REDCONF_ENDIAN_SWAP
+                                    *pulInode = RedRev32( *pulInode );
+                                #endif
+                            }
+
+                            ulIdx += ulBlockIdx;
                             break;
                         }
-
-                        ulIdx += ulBlockLastIdx;
                     }
-                    else if( ret == -RED_ENODATA )
+                    else if( ulFreeIdx == DIR_INDEX_INVALID )
                     {
-                        if( ulFreeIdx == DIR_INDEX_INVALID )
-                        {
-                            ulFreeIdx = ulIdx;
-                        }
-
-                        ret = 0;
-                        ulIdx += DIRENTS_PER_BLOCK;
+                        ulFreeIdx = ulIdx + ulBlockIdx;
                     }
                     else
                     {
-                        /*  Unexpected error, let the loop terminate, no action
-                         *  here.
+                        /*  The directory entry is free, but we already found a free one, so there's
+                         *  nothing to do here.
                          */
                     }
                 }
 
-                if( ret == 0 )
+                if( ulBlockIdx < ulBlockLastIdx )
                 {
-                    /*  If we made it all the way to the end of the directory
-                     *  without stopping, then the given name does not exist in the
-                     *  directory.
+                    /*  If we broke out of the for loop, we found a matching
+                     *  dirent and can stop the search.
                      */
-                    if( ulIdx == ulDirentCount )
-                    {
-                        /*  If the directory had no sparse dirents, then the first
-                         *  free dirent is beyond the end of the directory.  If the
-                         *  directory is already the maximum size, then there is no
-                         *  free dirent.
-                         */
-                        if( ( ulFreeIdx == DIR_INDEX_INVALID ) && ( ulDirentCount < DIRENTS_MAX ) )
-                        {
-                            ulFreeIdx = ulDirentCount;
-                        }
+                    break;
+                }
 
-                        ulIdx = ulFreeIdx;
+                ulIdx += ulBlockLastIdx;
+            }
+            else if( ret == -RED_ENODATA )
+            {
+                if( ulFreeIdx == DIR_INDEX_INVALID )
+                {
+                    ulFreeIdx = ulIdx;
+                }
 
-                        ret = -RED_ENOENT;
-                    }
+                ret = 0;
+                ulIdx += DIRENTS_PER_BLOCK;
+            }
+            else
+            {
+                /*  Unexpected error, let the loop terminate, no action
+                 *  here.
+                 */
+            }
+        }
 
-                    if( pulEntryIdx != NULL )
-                    {
-                        *pulEntryIdx = ulIdx;
-                    }
+        if( ret == 0 )
+        {
+            /*  If we made it all the way to the end of the directory
+             *  without stopping, then the given name does not exist in the
+             *  directory.
+             */
+            if( ulIdx == ulDirentCount )
+            {
+                /*  If the directory had no sparse dirents, then the first
+                 *  free dirent is beyond the end of the directory.  If the
+                 *  directory is already the maximum size, then there is no
+                 *  free dirent.
+                 */
+                if( ( ulFreeIdx == DIR_INDEX_INVALID ) && ( ulDirentCount < DIRENTS_MAX ) )
+                {
+                    ulFreeIdx = ulDirentCount;
                 }
+
+                ulIdx = ulFreeIdx;
+
+                ret = -RED_ENOENT;
+            }
+
+            if( pulEntryIdx != NULL )
+            {
+                *pulEntryIdx = ulIdx;
             }
         }
 
@@ -462,6 +581,27 @@
     }
 
 
+/** @brief Determine whether the name in a directory entry matches a name.
+ *
+ *  @param pDirent      The directory entry.
+ *  @param pszName      The name to compare against.
+ *  @param ulNameLen    The length of @p pszName.
+ *
+ *  @return Whether the names match.
+ */
+    static bool DirentNameMatches( const DIRENT * pDirent,
+                                   const char * pszName,
+                                   uint32_t ulNameLen )
+    {
+        /*  The name in the dirent will not be null terminated if it is of the
+         *  maximum length, so use a bounded string compare and then make sure
+         *  there is nothing more to the name.
+         */
+        return ( RedStrNCmp( pDirent->acName, pszName, ulNameLen ) == 0 ) &&
+               ( ( ulNameLen == REDCONF_NAME_MAX ) || ( pDirent->acName[ ulNameLen ] == '\0' ) );
+    }
+
+
     #if ( REDCONF_API_POSIX_READDIR == 1 ) || ( REDCONF_CHECKER == 1 )
 
 /** @brief Read the next entry from a directory, given a starting index.
@@ -900,19 +1040,35 @@
             {
                 uint64_t ullOffset = DirEntryIndexToOffset( ulIdx );
                 uint32_t ulLen = DIRENT_SIZE;
-                static DIRENT de;
 
-                RedMemSet( &de, 0U, sizeof( de ) );
+                /*  Static to keep it off the stack.  With a lock per volume,
+                 *  tasks on different volumes can be here at the same time
+                 *  (the write may give up the FS mutex to read a block), so
+                 *  each volume needs its own.
+                 */
+                #if REDCONF_LOCK_PER_VOLUME == 1
+                    static DIRENT ade[ REDCONF_VOLUME_COUNT ];
+                    DIRENT * pDe = &ade[ gbRedVolNum ];
+                #else
+                    static DIRENT de;
+                    DIRENT * pDe = &de;
+                #endif
+
+                RedMemSet( pDe, 0U, sizeof( *pDe ) );
 
-                de.ulInode = ulInode;
+                pDe->ulInode = ulInode;
 
                 #ifdef REDCONF_ENDIAN_SWAP
-                    de.ulInode = RedRev32( de.ulInode );
+                    pDe->ulInode = RedRev32( pDe->ulInode );
                 #endif
 
-                RedStrNCpy( de.acName, pszName, ulNameLen );
+                RedStrNCpy( pDe->acName, pszName, ulNameLen );
 
-                ret = RedInodeDataWrite( pPInode, ullOffset, &ulLen, &de );
+                ret = RedInodeDataWrite( pPInode, ullOffset, &ulLen, pDe );
+
+                #if REDCONF_DIR_INDEX_DIRS > 0U
+                    DirIndexUpdate( pPInode, ulIdx, ulInode, pszName, ulNameLen, ret );
+                #endif
             }
 
             return ret;
@@ -963,4 +1119,528 @@
     }
 
 
+    #if REDCONF_DIR_INDEX_DIRS > 0U
+
+/** @brief Discard directory indexes on the current volume.
+ *
+ *  @param ulInode  The directory inode whose index is to be discarded, or
+ *                  INODE_INVALID to discard every index on the current volume.
+ */
+        void RedDirIndexDiscard( uint32_t ulInode )
+        {
+            uint32_t ulDir;
+
+            for( ulDir = 0U; ulDir < REDCONF_DIR_INDEX_DIRS; ulDir++ )
+            {
+                DIRINDEX * pIndex = &gaDirIndex[ gbRedVolNum ][ ulDir ];
+
+                if( ( ulInode == INODE_INVALID ) || ( pIndex->ulInode == ulInode ) )
+                {
+                    pIndex->ulInode = INODE_INVALID;
+                }
+            }
+        }
+
+
+/** @brief Get the index for a directory, building it if necessary.
+ *
+ *  @param pPInode  A pointer to the cached inode structure of the directory.
+ *  @param ppIndex  On successful return, populated with the index for the
+ *                  directory, or with `NULL` if the directory is too small to
+ *                  be worth indexing or has too many entries to be indexed.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+        static REDSTATUS DirIndexGet( CINODE * pPInode,
+                                      DIRINDEX ** ppIndex )
+        {
+            uint32_t ulDirentCount = DirOffsetToEntryIndex( pPInode->pInodeBuf->ullSize );
+            DIRINDEX * pIndex = NULL;
+            DIRINDEX * pVictim = &gaDirIndex[ gbRedVolNum ][ 0U ];
+            REDSTATUS ret = 0;
+            uint32_t ulDir;
+
+            gulDirIndexTick++;
+
+            for( ulDir = 0U; ulDir < REDCONF_DIR_INDEX_DIRS; ulDir++ )
+            {
+                DIRINDEX * pThis = &gaDirIndex[ gbRedVolNum ][ ulDir ];
+
+                if( pThis->ulInode == INODE_INVALID )
+                {
+                    if( pVictim->ulInode != INODE_INVALID )
+                    {
+                        pVictim = pThis;
+                    }
+                }
+                else if( pThis->ulInode == pPInode->ulInode )
+                {
+                    pIndex = pThis;
+                    break;
+                }
+                else if( ( pVictim->ulInode != INODE_INVALID ) && ( pThis->ulLastUse < pVictim->ulLastUse ) )
+                {
+                    pVictim = pThis;
+                }
+                else
+                {
+                    /*  Neither a match nor a better victim.
+                     */
+                }
+            }
+
+            if( ( pIndex == NULL ) && ( ulDirentCount <= DIRENTS_PER_BLOCK ) )
+            {
+                /*  Searching a directory of one block costs one block read
+                 *  regardless, so it is not worth evicting another directory's
+                 *  index for it.
+                 */
+            }
+            else if( pIndex == NULL )
+            {
+                uint32_t ulIdx = 0U;
+
+                /*  Build the index by scanning every block of the directory.
+                 */
+                pIndex = pVictim;
+                pIndex->ulInode = pPInode->ulInode;
+                pIndex->fOverflow = false;
+                pIndex->ulUsed = 0U;
+                pIndex->ulFreeHint = DIR_INDEX_INVALID;
+                RedMemSet( pIndex->aSlot, 0xFFU, sizeof( pIndex->aSlot ) );
+
+                while( ( ret == 0 ) && !pIndex->fOverflow && ( ulIdx < ulDirentCount ) )
+                {
+                    ret = RedInodeDataSeekAndRead( pPInode, ulIdx / DIRENTS_PER_BLOCK );
+
+                    if( ret == 0 )
+                    {
+                        const DIRENT * pDirents = CAST_CONST_DIRENT_PTR( pPInode->pbData );
+                        uint32_t ulBlockLastIdx = REDMIN( DIRENTS_PER_BLOCK, ulDirentCount - ulIdx );
+                        uint32_t ulBlockIdx;
+
+                        for( ulBlockIdx = 0U; ulBlockIdx < ulBlockLastIdx; ulBlockIdx++ )
+                        {
+                            const DIRENT * pDirent = &pDirents[ ulBlockIdx ];
+
+                            if( pDirent->ulInode != INODE_INVALID )
+                            {
+                                uint32_t ulNameLen = 0U;
+
+                                while( ( ulNameLen < REDCONF_NAME_MAX ) && ( pDirent->acName[ ulNameLen ] != '\0' ) )
+                                {
+                                    ulNameLen++;
+                                }
+
+                                if( !DirIndexInsert( pIndex, DirNameHash( pDirent->acName, ulNameLen ), ulIdx + ulBlockIdx ) )
+                                {
+                                    pIndex->fOverflow = true;
+                                }
+                            }
+                            else if( pIndex->ulFreeHint == DIR_INDEX_INVALID )
+                            {
+                                pIndex->ulFreeHint = ulIdx + ulBlockIdx;
+                            }
+                            else
+                            {
+                                /*  Already found a free entry.
+                                 */
+                            }
+                        }
+
+                        ulIdx += ulBlockLastIdx;
+                    }
+                    else if( ret == -RED_ENODATA )
+                    {
+                        if( pIndex->ulFreeHint == DIR_INDEX_INVALID )
+                        {
+                            pIndex->ulFreeHint = ulIdx;
+                        }
+
+                        ret = 0;
+                        ulIdx += DIRENTS_PER_BLOCK;
+                    }
+                    else
+                    {
+                        /*  Unexpected error, let the loop terminate.
+                         */
+                    }
+                }
+
+                if( ret != 0 )
+                {
+                    pIndex->ulInode = INODE_INVALID;
+                }
+                else if( pIndex->ulFreeHint == DIR_INDEX_INVALID )
+                {
+                    pIndex->ulFreeHint = ulDirentCount;
+                }
+                else
+                {
+                    /*  Free hint already found.
+                     */
+                }
+            }
+
+            if( ret == 0 )
+            {
+                if( pIndex != NULL )
+                {
+                    pIndex->ulLastUse = gulDirIndexTick;
+
+                    /*  Directories too large to index keep their (empty) index,
+                     *  so that every lookup does not try to build it again.
+                     */
+                    if( pIndex->fOverflow )
+                    {
+                        pIndex = NULL;
+                    }
+                }
+
+                *ppIndex = pIndex;
+            }
+
+            return ret;
+        }
+
+
+/** @brief Look up a name using a directory index.
+ *
+ *  Only the directory blocks holding entries whose name hash matches that of
+ *  @p pszName are read.
+ *
+ *  @param pPInode      A pointer to the cached inode structure of the directory
+ *                      to search.
+ *  @param pIndex       The index for @p pPInode.
+ *  @param pszName      The name of the desired entry.
+ *  @param ulNameLen    The length of @p pszName.
+ *  @param pulEntryIdx  As for RedDirEntryLookup().
+ *  @param pulInode     As for RedDirEntryLookup().
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOENT @p pszName does not name an existing file or directory.
+ */
+        static REDSTATUS DirIndexLookup( CINODE * pPInode,
+                                         DIRINDEX * pIndex,
+                                         const char * pszName,
+                                         uint32_t ulNameLen,
+                                         uint32_t * pulEntryIdx,
+                                         uint32_t * pulInode )
+        {
+            uint32_t ulHash = DirNameHash( pszName, ulNameLen );
+            uint32_t ulSlot = ulHash & ( REDCONF_DIR_INDEX_SLOTS - 1U );
+            uint32_t ulProbes = 0U;
+            uint32_t ulEntryIdx = DIR_INDEX_INVALID;
+            REDSTATUS ret = 0;
+
+            while( ( ret == 0 ) &&
+                   ( ulEntryIdx == DIR_INDEX_INVALID ) &&
+                   ( ulProbes < REDCONF_DIR_INDEX_SLOTS ) &&
+                   ( pIndex->aSlot[ ulSlot ].ulEntryIdx != DIR_INDEX_SLOT_EMPTY ) )
+            {
+                const DIRINDEXSLOT * pSlot = &pIndex->aSlot[ ulSlot ];
+
+                if( ( pSlot->ulEntryIdx != DIR_INDEX_SLOT_DELETED ) && ( pSlot->ulHash == ulHash ) )
+                {
+                    ret = RedInodeDataSeekAndRead( pPInode, pSlot->ulEntryIdx / DIRENTS_PER_BLOCK );
+
+                    if( ret == 0 )
+                    {
+                        const DIRENT * pDirent = &CAST_CONST_DIRENT_PTR( pPInode->pbData )[ pSlot->ulEntryIdx % DIRENTS_PER_BLOCK ];
+
+                        if( ( pDirent->ulInode != INODE_INVALID ) && DirentNameMatches( pDirent, pszName, ulNameLen ) )
+                        {
+                            ulEntryIdx = pSlot->ulEntryIdx;
+
+                            if( pulInode != NULL )
+                            {
+                                *pulInode = pDirent->ulInode;
+
+                                #ifdef REDCONF_ENDIAN_SWAP
+                                    *pulInode = RedRev32( *pulInode );
+                                #endif
+                            }
+                        }
+                    }
+                    else if( ret == -RED_ENODATA )
+                    {
+                        /*  The index says there is an entry in a sparse block.
+                         */
+                        CRITICAL_ERROR();
+                        ret = -RED_EFUBAR;
+                    }
+                    else
+                    {
+                        /*  Unexpected error, let the loop terminate.
+                         */
+                    }
+                }
+
+                ulSlot = ( ulSlot + 1U ) & ( REDCONF_DIR_INDEX_SLOTS - 1U );
+                ulProbes++;
+            }
+
+            if( ( ret == 0 ) && ( ulEntryIdx == DIR_INDEX_INVALID ) )
+            {
+                /*  Only look for a free entry if the caller wants one, since
+                 *  that may require reading directory blocks.
+                 */
+                if( pulEntryIdx != NULL )
+                {
+                    ret = DirIndexFreeEntry( pPInode, pIndex, &ulEntryIdx );
+                }
+
+                if( ret == 0 )
+                {
+                    ret = -RED_ENOENT;
+                }
+            }
+
+            if( ( ( ret == 0 ) || ( ret == -RED_ENOENT ) ) && ( pulEntryIdx != NULL ) )
+            {
+                *pulEntryIdx = ulEntryIdx;
+            }
+
+            return ret;
+        }
+
+
+/** @brief Find the first available entry in an indexed directory.
+ *
+ *  The search starts from the free hint in the index, below which all entries
+ *  are known to be in use, so usually no more than one block is read.
+ *
+ *  @param pPInode      A pointer to the cached inode structure of the
+ *                      directory.
+ *  @param pIndex       The index for @p pPInode.
+ *  @param pulFreeIdx   On successful return, populated with the position of
+ *                      the first available entry, or DIR_INDEX_INVALID if the
+ *                      directory is full.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+        static REDSTATUS DirIndexFreeEntry( CINODE * pPInode,
+                                            DIRINDEX * pIndex,
+                                            uint32_t * pulFreeIdx )
+        {
+            uint32_t ulDirentCount = DirOffsetToEntryIndex( pPInode->pInodeBuf->ullSize );
+            uint32_t ulIdx = REDMIN( pIndex->ulFreeHint, ulDirentCount );
+            bool fFound = false;
+            REDSTATUS ret = 0;
+
+            while( ( ret == 0 ) && !fFound && ( ulIdx < ulDirentCount ) )
+            {
+                ret = RedInodeDataSeekAndRead( pPInode, ulIdx / DIRENTS_PER_BLOCK );
+
+                if( ret == 0 )
+                {
+                    const DIRENT * pDirents = CAST_CONST_DIRENT_PTR( pPInode->pbData );
+                    uint32_t ulBlockIdx = ulIdx % DIRENTS_PER_BLOCK;
+
+                    while( !fFound && ( ulBlockIdx < DIRENTS_PER_BLOCK ) && ( ulIdx < ulDirentCount ) )
+                    {
+                        if( pDirents[ ulBlockIdx ].ulInode == INODE_INVALID )
+                        {
+                            fFound = true;
+                        }
+                        else
+                        {
+                            ulBlockIdx++;
+                            ulIdx++;
+                        }
+                    }
+                }
+                else if( ret == -RED_ENODATA )
+                {
+                    /*  Sparse block: every entry in it is available.
+                     */
+                    ret = 0;
+                    fFound = true;
+                }
+                else
+                {
+                    /*  Unexpected error, let the loop terminate.
+                     */
+                }
+            }
+
+            if( ret == 0 )
+            {
+                pIndex->ulFreeHint = ulIdx;
+
+                if( !fFound && ( ulDirentCount >= DIRENTS_MAX ) )
+                {
+                    ulIdx = DIR_INDEX_INVALID;
+                }
+
+                *pulFreeIdx = ulIdx;
+            }
+
+            return ret;
+        }
+
+
+/** @brief Add an entry to a directory index.
+ *
+ *  @param pIndex       The directory index.
+ *  @param ulHash       Hash of the name in the directory entry.
+ *  @param ulEntryIdx   Position of the directory entry.
+ *
+ *  @return Whether the entry was added; false if the index is full.
+ */
+        static bool DirIndexInsert( DIRINDEX * pIndex,
+                                    uint32_t ulHash,
+                                    uint32_t ulEntryIdx )
+        {
+            uint32_t ulSlot = ulHash & ( REDCONF_DIR_INDEX_SLOTS - 1U );
+            bool fInserted = false;
+
+            /*  The limit on used slots guarantees that an empty slot exists, so
+             *  the probe terminates.
+             */
+            while( ( pIndex->aSlot[ ulSlot ].ulEntryIdx != DIR_INDEX_SLOT_EMPTY ) &&
+                   ( pIndex->aSlot[ ulSlot ].ulEntryIdx != DIR_INDEX_SLOT_DELETED ) )
+            {
+                ulSlot = ( ulSlot + 1U ) & ( REDCONF_DIR_INDEX_SLOTS - 1U );
+            }
+
+            if( pIndex->aSlot[ ulSlot ].ulEntryIdx == DIR_INDEX_SLOT_DELETED )
+            {
+                fInserted = true;
+            }
+            else if( pIndex->ulUsed < DIR_INDEX_SLOT_LIMIT )
+            {
+                pIndex->ulUsed++;
+                fInserted = true;
+            }
+            else
+            {
+                /*  Index is full.
+                 */
+            }
+
+            if( fInserted )
+            {
+                pIndex->aSlot[ ulSlot ].ulHash = ulHash;
+                pIndex->aSlot[ ulSlot ].ulEntryIdx = ulEntryIdx;
+            }
+
+            return fInserted;
+        }
+
+
+        #if REDCONF_READ_ONLY == 0
+
+/** @brief Update the index of a directory after one of its entries has been
+ *         written.
+ *
+ *  @param pPInode      A pointer to the cached inode structure of the
+ *                      directory.
+ *  @param ulEntryIdx   Position of the entry which was written.
+ *  @param ulInode      The inode number written to the entry, or
+ *                      INODE_INVALID if the entry was deleted.
+ *  @param pszName      The name written to the entry.
+ *  @param ulNameLen    The length of @p pszName.
+ *  @param status       The result of writing the entry.  If the write failed,
+ *                      the state of the entry is unknown, so the index is
+ *                      discarded.
+ */
+            static void DirIndexUpdate( const CINODE * pPInode,
+                                        uint32_t ulEntryIdx,
+                                        uint32_t ulInode,
+                                        const char * pszName,
+                                        uint32_t ulNameLen,
+                                        REDSTATUS status )
+            {
+                uint32_t ulDir;
+
+                for( ulDir = 0U; ulDir < REDCONF_DIR_INDEX_DIRS; ulDir++ )
+                {
+                    DIRINDEX * pIndex = &gaDirIndex[ gbRedVolNum ][ ulDir ];
+
+                    if( pIndex->ulInode == pPInode->ulInode )
+                    {
+                        if( status != 0 )
+                        {
+                            pIndex->ulInode = INODE_INVALID;
+                        }
+                        else if( !pIndex->fOverflow )
+                        {
+                            uint32_t ulSlot;
+
+                            /*  Remove whatever the index held for this position.
+                             */
+                            for( ulSlot = 0U; ulSlot < REDCONF_DIR_INDEX_SLOTS; ulSlot++ )
+                            {
+                                if( pIndex->aSlot[ ulSlot ].ulEntryIdx == ulEntryIdx )
+                                {
+                                    pIndex->aSlot[ ulSlot ].ulEntryIdx = DIR_INDEX_SLOT_DELETED;
+                                }
+                            }
+
+                            if( ulInode == INODE_INVALID )
+                            {
+                                pIndex->ulFreeHint = REDMIN( pIndex->ulFreeHint, ulEntryIdx );
+                            }
+                            else if( !DirIndexInsert( pIndex, DirNameHash( pszName, ulNameLen ), ulEntryIdx ) )
+                            {
+                                /*  Too many deleted slots or too many entries.
+                                 *  Rebuilding the index will tell which.
+                                 */
+                                pIndex->ulInode = INODE_INVALID;
+                            }
+                            else if( ulEntryIdx == pIndex->ulFreeHint )
+                            {
+                                pIndex->ulFreeHint++;
+                            }
+                            else
+                            {
+                                /*  Entry added past the free hint.
+                                 */
+                            }
+                        }
+                        else
+                        {
+                            /*  Directory is too large to be indexed.
+                             */
+                        }
+                    }
+                }
+            }
+        #endif /* REDCONF_READ_ONLY == 0 */
+
+
+/** @brief Hash a directory entry name.
+ *
+ *  @param pszName      The name to hash.
+ *  @param ulNameLen    The length of @p pszName.
+ *
+ *  @return The 32-bit FNV-1a hash of the name.
+ */
+        static uint32_t DirNameHash( const char * pszName,
+                                     uint32_t ulNameLen )
+        {
+            uint32_t ulHash = 2166136261U;
+            uint32_t ulIdx;
+
+            for( ulIdx = 0U; ulIdx < ulNameLen; ulIdx++ )
+            {
+                ulHash ^= ( uint8_t ) pszName[ ulIdx ];
+                ulHash *= 16777619U;
+            }
+
+            return ulHash;
+        }
+    #endif /* REDCONF_DIR_INDEX_DIRS > 0U */
+
+
 #endif /* REDCONF_API_POSIX == 1 */
@@ -55,6 +55,32 @@
             ret = RedOsBDevOpen( gbRedVolNum, BDEV_O_RDWR );
         }
 
+        #if REDCONF_INODE_CACHE_ENTRIES > 0U
+            if( ret == 0 )
+            {
+                /*  The inodes of the previous file system are about to go.
+                 */
+                RedInodeCacheReset();
+            }
+        #endif
+
+        #if REDCONF_API_POSIX == 1
+            if( ret == 0 )
+            {
+                RedInodeFreeMapReset();
+            }
+        #endif
+
+        #if REDCONF_FAST_MOUNT == 1
+            if( ret == 0 )
+            {
+                /*  The metaroots are about to be replaced, so the hint no
+                 *  longer describes them.
+                 */
+                RedOsMountHintStore( gbRedVolNum, NULL );
+            }
+        #endif
+
         if( ret == 0 )
         {
             MASTERBLOCK * pMB;
@@ -77,7 +103,11 @@
                 ret = RedIoFlush( gbRedVolNum );
             }
 
-            #if REDCONF_IMAP_EXTERNAL == 1
+            /*  With a lazy format, the imap nodes are left as they are: the
+             *  metaroots written below record that none of them have been
+             *  written, so their contents are never read.
+             */
+            #if ( REDCONF_IMAP_EXTERNAL == 1 ) && ( REDCONF_IMAP_LAZY_FORMAT == 0 )
                 if( ( ret == 0 ) && !gpRedCoreVol->fImapInline )
                 {
                     uint32_t ulImapBlock;
@@ -103,7 +133,18 @@
                         RedBufferPut( pImap );
                     }
                 }
-            #endif /* if REDCONF_IMAP_EXTERNAL == 1 */
+            #endif /* if ( REDCONF_IMAP_EXTERNAL == 1 ) && ( REDCONF_IMAP_LAZY_FORMAT == 0 ) */
+
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+                /*  Sequence numbers start over, so a log left by a previous
+                 *  format could otherwise pass for a current one.
+                 */
+                if( ret == 0 )
+                {
+                    ret = RedIntentErase();
+                }
+            #endif
 
             /*  Write the first metaroot.
              */
@@ -193,6 +234,7 @@
                 pMB->uDirectPointers = REDCONF_DIRECT_POINTERS;
                 pMB->uIndirectPointers = REDCONF_INDIRECT_POINTERS;
                 pMB->bBlockSizeP2 = BLOCK_SIZE_P2;
+                pMB->ulIntentLogBlocks = REDCONF_INTENT_LOG_BLOCKS;
 
                 #if REDCONF_API_POSIX == 1
                     pMB->bFlags |= MBFLAG_API_POSIX;
@@ -206,6 +248,12 @@
                 #if ( REDCONF_API_POSIX == 1 ) && ( REDCONF_API_POSIX_LINK == 1 )
                     pMB->bFlags |= MBFLAG_INODE_NLINK;
                 #endif
+                #if REDCONF_INODE_INLINE == 1
+                    pMB->bFlags |= MBFLAG_INODE_INLINE;
+                #endif
+                #if REDCONF_IMAP_LAZY_FORMAT == 1
+                    pMB->bFlags |= MBFLAG_IMAP_LAZY;
+                #endif
 
                 ret = RedBufferFlush( BLOCK_NUM_MASTER, 1U );
 
@@ -35,6 +35,12 @@
 #include <redcore.h>
 
 
+#if REDCONF_READ_ONLY == 0
+    static REDSTATUS ImapFindFree( uint32_t ulBlockStart,
+                                   uint32_t ulBlockEnd,
+                                   uint32_t * pulBlock );
+#endif
+
 /** @brief Get the allocation bit of a block from either metaroot.
  *
  *  Will pass the call down either to the inline imap or to the external imap
@@ -183,10 +189,21 @@ REDSTATUS RedImapBlockGet( uint8_t bMR,
                     if( fWasAllocated )
                     {
                         gpRedCoreVol->ulAlmostFreeBlocks++;
+
+                        #if REDCONF_DISCARDS == 1
+                            RedVolDiscardAdd( ulBlock, 1U );
+                        #endif
                     }
                     else
                     {
                         gpRedMR->ulFreeBlocks++;
+
+                        #if ( REDCONF_IMAP_EXTERNAL == 1 ) && ( REDCONF_IMAP_SUMMARY == 1 )
+                            if( !gpRedCoreVol->fImapInline )
+                            {
+                                RedBitClear( gpRedCoreVol->abImapFull, ( ulBlock - gpRedCoreVol->ulInodeTableStartBN ) / IMAPNODE_ENTRIES );
+                            }
+                        #endif
                     }
                 }
             }
@@ -196,6 +213,97 @@ REDSTATUS RedImapBlockGet( uint8_t bMR,
     }
 
 
+/** @brief Free a run of contiguous allocable blocks in the working metaroot.
+ *
+ *  Equivalent to calling RedImapBlockSet() to free each block of the run, but
+ *  with the external imap each imap node is updated once for the whole part of
+ *  the run which it covers, and the buffers are discarded with one call.
+ *
+ *  @param ulBlockStart The first block to free.
+ *  @param ulBlockCount The number of blocks to free.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p ulBlockCount is zero; or the run is not entirely
+ *                      within the allocable blocks.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+    REDSTATUS RedImapBlockRangeFree( uint32_t ulBlockStart,
+                                     uint32_t ulBlockCount )
+    {
+        REDSTATUS ret = 0;
+
+        if( ( ulBlockStart < gpRedCoreVol->ulFirstAllocableBN ) ||
+            ( ulBlockStart >= gpRedVolume->ulBlockCount ) ||
+            ( ulBlockCount == 0U ) ||
+            ( ulBlockCount > ( gpRedVolume->ulBlockCount - ulBlockStart ) ) )
+        {
+            REDERROR();
+            ret = -RED_EINVAL;
+        }
+        else if( ( gpRedMR->ulFreeBlocks > gpRedVolume->ulBlocksAllocable ) ||
+                 ( ulBlockCount > ( gpRedVolume->ulBlocksAllocable - gpRedMR->ulFreeBlocks ) ) )
+        {
+            /*  Attempting to free more blocks than are allocable.  This could
+             *  indicate metadata corruption.
+             */
+            CRITICAL_ERROR();
+            ret = -RED_EFUBAR;
+        }
+        else
+        {
+            #if ( REDCONF_IMAP_INLINE == 1 ) && ( REDCONF_IMAP_EXTERNAL == 1 )
+                bool fInline = gpRedCoreVol->fImapInline;
+            #elif REDCONF_IMAP_INLINE == 1
+                bool fInline = true;
+            #else
+                bool fInline = false;
+            #endif
+
+            if( fInline )
+            {
+                uint32_t ulIdx;
+
+                /*  The inline imap lives in the metaroot, so there is no imap node
+                 *  I/O to save by freeing the blocks together.
+                 */
+                for( ulIdx = 0U; ( ret == 0 ) && ( ulIdx < ulBlockCount ); ulIdx++ )
+                {
+                    ret = RedImapBlockSet( ulBlockStart + ulIdx, false );
+                }
+            }
+            else
+            {
+                #if REDCONF_IMAP_EXTERNAL == 1
+                    uint32_t ulAlmostFree;
+
+                    ret = RedImapERangeFree( ulBlockStart, ulBlockCount, &ulAlmostFree );
+
+                    /*  Any change to the allocation state of a block indicates that
+                     *  the volume is now branched.
+                     */
+                    gpRedCoreVol->fBranched = true;
+
+                    if( ret == 0 )
+                    {
+                        ret = RedBufferDiscardRange( ulBlockStart, ulBlockCount );
+                        CRITICAL_ASSERT( ret == 0 );
+                    }
+
+                    if( ret == 0 )
+                    {
+                        gpRedCoreVol->ulAlmostFreeBlocks += ulAlmostFree;
+                        gpRedMR->ulFreeBlocks += ulBlockCount - ulAlmostFree;
+                    }
+                #endif /* REDCONF_IMAP_EXTERNAL == 1 */
+            }
+        }
+
+        return ret;
+    }
+
+
 /** @brief Allocate one block.
  *
  *  @param pulBlock On successful return, populated with the allocated block
@@ -209,10 +317,42 @@ REDSTATUS RedImapBlockGet( uint8_t bMR,
  *  @retval -RED_ENOSPC Insufficient free space to perform the allocation.
  */
     REDSTATUS RedImapAllocBlock( uint32_t * pulBlock )
+    {
+        uint32_t ulBlockCount = 1U;
+
+        return RedImapAllocBlocks( pulBlock, &ulBlockCount );
+    }
+
+
+/** @brief Allocate a run of contiguous blocks.
+ *
+ *  The search for free blocks starts at the allocation cursor and wraps around
+ *  the end of the volume, as with RedImapAllocBlock().  The first free block
+ *  found is allocated, together with as many of the free blocks which
+ *  immediately follow it as were requested; the run is never extended past the
+ *  end of the volume, so fewer blocks than requested may be allocated.
+ *
+ *  @param pulBlock         On successful return, populated with the first
+ *                          allocated block number.
+ *  @param pulBlockCount    On entry, the maximum number of blocks to allocate,
+ *                          which must be nonzero.  On successful return,
+ *                          populated with the number of blocks allocated, which
+ *                          is at least one.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p pulBlock or @p pulBlockCount is `NULL`; or
+ *                      `*pulBlockCount` is zero.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOSPC Insufficient free space to perform the allocation.
+ */
+    REDSTATUS RedImapAllocBlocks( uint32_t * pulBlock,
+                                  uint32_t * pulBlockCount )
     {
         REDSTATUS ret;
 
-        if( pulBlock == NULL )
+        if( ( pulBlock == NULL ) || ( pulBlockCount == NULL ) || ( *pulBlockCount == 0U ) )
         {
             REDERROR();
             ret = -RED_EINVAL;
@@ -223,50 +363,146 @@ REDSTATUS RedImapBlockGet( uint8_t bMR,
         }
         else
         {
-            uint32_t ulStopBlock = gpRedMR->ulAllocNextBlock;
-            bool fAllocated = false;
+            uint32_t ulFirst;
+
+            ret = ImapFindFree( gpRedMR->ulAllocNextBlock, gpRedVolume->ulBlockCount, &ulFirst );
 
-            do
+            if( ( ret == 0 ) && ( ulFirst == gpRedVolume->ulBlockCount ) )
             {
-                ALLOCSTATE state;
+                ret = ImapFindFree( gpRedCoreVol->ulFirstAllocableBN, gpRedMR->ulAllocNextBlock, &ulFirst );
 
-                ret = RedImapBlockState( gpRedMR->ulAllocNextBlock, &state );
-                CRITICAL_ASSERT( ret == 0 );
+                if( ( ret == 0 ) && ( ulFirst == gpRedMR->ulAllocNextBlock ) )
+                {
+                    /*  The free block count was already determined to be non-zero,
+                     *  no error occurred while looking for free blocks, but no free
+                     *  blocks were found.  This indicates metadata corruption.
+                     */
+                    CRITICAL_ERROR();
+                    ret = -RED_EFUBAR;
+                }
+            }
 
+            CRITICAL_ASSERT( ret == 0 );
+
+            #if REDCONF_STATS == 1
                 if( ret == 0 )
                 {
-                    if( state == ALLOCSTATE_FREE )
+                    REDVOLSTATS * pStats = &gaRedVolStats[ gbRedVolNum ];
+                    uint32_t ulScanned;
+
+                    /*  The number of in-use blocks passed over, from the cursor
+                     *  to the free block found, wrapping around the end.
+                     */
+                    if( ulFirst >= gpRedMR->ulAllocNextBlock )
                     {
-                        ret = RedImapBlockSet( gpRedMR->ulAllocNextBlock, true );
-                        CRITICAL_ASSERT( ret == 0 );
+                        ulScanned = ulFirst - gpRedMR->ulAllocNextBlock;
+                    }
+                    else
+                    {
+                        ulScanned = ( gpRedVolume->ulBlockCount - gpRedMR->ulAllocNextBlock ) + ( ulFirst - gpRedCoreVol->ulFirstAllocableBN );
+                    }
+
+                    pStats->ulAllocSearches++;
+                    pStats->ullAllocScanBlocks += ulScanned;
+
+                    if( ulScanned > pStats->ulAllocScanMax )
+                    {
+                        pStats->ulAllocScanMax = ulScanned;
+                    }
+                }
+            #endif /* REDCONF_STATS == 1 */
+
+            if( ret == 0 )
+            {
+                uint32_t ulMaxCount = REDMIN( *pulBlockCount, gpRedMR->ulFreeBlocks );
+                uint32_t ulCount = 1U;
+                uint32_t ulIdx;
+
+                /*  Extend the run while the blocks which follow are also free.
+                 */
+                while( ( ret == 0 ) && ( ulCount < ulMaxCount ) && ( ( ulFirst + ulCount ) < gpRedVolume->ulBlockCount ) )
+                {
+                    uint32_t ulNext;
+
+                    ret = ImapFindFree( ulFirst + ulCount, ulFirst + ulCount + 1U, &ulNext );
 
-                        *pulBlock = gpRedMR->ulAllocNextBlock;
-                        fAllocated = true;
+                    if( ( ret == 0 ) && ( ulNext == ( ulFirst + ulCount ) ) )
+                    {
+                        ulCount++;
+                    }
+                    else
+                    {
+                        ulMaxCount = ulCount;
                     }
+                }
+
+                CRITICAL_ASSERT( ret == 0 );
 
-                    /*  Increment the next block number, wrapping it when the end of
-                     *  the volume is reached.
+                for( ulIdx = 0U; ( ret == 0 ) && ( ulIdx < ulCount ); ulIdx++ )
+                {
+                    ret = RedImapBlockSet( ulFirst + ulIdx, true );
+                    CRITICAL_ASSERT( ret == 0 );
+                }
+
+                if( ret == 0 )
+                {
+                    /*  Advance the next block number past the run, wrapping it when
+                     *  the end of the volume is reached.
                      */
-                    gpRedMR->ulAllocNextBlock++;
+                    gpRedMR->ulAllocNextBlock = ulFirst + ulCount;
 
                     if( gpRedMR->ulAllocNextBlock == gpRedVolume->ulBlockCount )
                     {
                         gpRedMR->ulAllocNextBlock = gpRedCoreVol->ulFirstAllocableBN;
                     }
+
+                    *pulBlock = ulFirst;
+                    *pulBlockCount = ulCount;
                 }
             }
-            while( ( ret == 0 ) && !fAllocated && ( gpRedMR->ulAllocNextBlock != ulStopBlock ) );
+        }
+
+        return ret;
+    }
 
-            if( ( ret == 0 ) && !fAllocated )
+
+/** @brief Find the first free block in a range of blocks.
+ *
+ *  Will pass the call down either to the inline imap or to the external imap
+ *  implementation, whichever is appropriate for the current volume.
+ *
+ *  @param ulBlockStart The first block to examine.
+ *  @param ulBlockEnd   The block after the last block to examine.
+ *  @param pulBlock     On successful return, populated with the first free
+ *                      block in the range, or with @p ulBlockEnd if there are
+ *                      no free blocks in the range.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The range is invalid; or @p pulBlock is `NULL`.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+    static REDSTATUS ImapFindFree( uint32_t ulBlockStart,
+                                   uint32_t ulBlockEnd,
+                                   uint32_t * pulBlock )
+    {
+        REDSTATUS ret;
+
+        #if ( REDCONF_IMAP_INLINE == 1 ) && ( REDCONF_IMAP_EXTERNAL == 1 )
+            if( gpRedCoreVol->fImapInline )
             {
-                /*  The free block count was already determined to be non-zero, no
-                 *  error occurred while looking for free blocks, but no free blocks
-                 *  were found.  This indicates metadata corruption.
-                 */
-                CRITICAL_ERROR();
-                ret = -RED_EFUBAR;
+                ret = RedImapIFindFree( ulBlockStart, ulBlockEnd, pulBlock );
             }
-        }
+            else
+            {
+                ret = RedImapEFindFree( ulBlockStart, ulBlockEnd, pulBlock );
+            }
+        #elif REDCONF_IMAP_INLINE == 1
+            ret = RedImapIFindFree( ulBlockStart, ulBlockEnd, pulBlock );
+        #else /* if ( REDCONF_IMAP_INLINE == 1 ) && ( REDCONF_IMAP_EXTERNAL == 1 ) */
+            ret = RedImapEFindFree( ulBlockStart, ulBlockEnd, pulBlock );
+        #endif /* if ( REDCONF_IMAP_INLINE == 1 ) && ( REDCONF_IMAP_EXTERNAL == 1 ) */
 
         return ret;
     }
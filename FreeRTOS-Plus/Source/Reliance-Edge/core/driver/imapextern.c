@@ -43,6 +43,18 @@
         static REDSTATUS ImapNodeBranch( uint32_t ulImapNode,
                                          IMAPNODE ** ppImap );
         static bool ImapNodeIsBranched( uint32_t ulImapNode );
+        #if REDCONF_IMAP_LAZY_FORMAT == 1
+            static REDSTATUS ImapNodeMaterialize( uint32_t ulImapNode,
+                                                  IMAPNODE ** ppImap );
+        #endif
+        static REDSTATUS ImapNodeFindFree( uint32_t ulImapNode,
+                                           uint32_t ulOffsetStart,
+                                           uint32_t ulOffsetEnd,
+                                           uint32_t * pulOffset );
+    #endif
+    #if REDCONF_IMAP_LAZY_FORMAT == 1
+        static bool ImapNodeIsInit( uint8_t bMR,
+                                    uint32_t ulImapNode );
     #endif
 
 
@@ -98,13 +110,23 @@
                 }
             #endif
 
-            ret = RedBufferGet( RedImapNodeBlock( bMRToRead, ulImapNode ), BFLAG_META_IMAP, CAST_VOID_PTR_PTR( &pImap ) );
-
-            if( ret == 0 )
+            #if REDCONF_IMAP_LAZY_FORMAT == 1
+                if( !ImapNodeIsInit( bMRToRead, ulImapNode ) )
+                {
+                    *pfAllocated = false;
+                    ret = 0;
+                }
+                else
+            #endif
             {
-                *pfAllocated = RedBitGet( pImap->abEntries, ulOffset % IMAPNODE_ENTRIES );
+                ret = RedBufferGet( RedImapNodeBlock( bMRToRead, ulImapNode ), BFLAG_META_IMAP, CAST_VOID_PTR_PTR( &pImap ) );
+
+                if( ret == 0 )
+                {
+                    *pfAllocated = RedBitGet( pImap->abEntries, ulOffset % IMAPNODE_ENTRIES );
 
-                RedBufferPut( pImap );
+                    RedBufferPut( pImap );
+                }
             }
         }
 
@@ -176,6 +198,371 @@
         }
 
 
+/** @brief Free a run of contiguous blocks in the working-state imap.
+ *
+ *  Each imap node touched by the run is branched and buffered once, and its
+ *  bits for the run are cleared together rather than one at a time.  The
+ *  committed copy of each branched node is consulted once to divide the run
+ *  into blocks which become almost free and blocks which become free.  Almost
+ *  free blocks are also remembered for discard, and the summary bit of any
+ *  imap node which gains free blocks is cleared.
+ *
+ *  @param ulBlockStart     The first block to free.
+ *  @param ulBlockCount     The number of blocks to free.
+ *  @param pulAlmostFree    On successful return, populated with the number of
+ *                          blocks in the run which were allocated in the
+ *                          committed state, and so are now almost free rather
+ *                          than free.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The range is invalid; or @p pulAlmostFree is `NULL`.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+        REDSTATUS RedImapERangeFree( uint32_t ulBlockStart,
+                                     uint32_t ulBlockCount,
+                                     uint32_t * pulAlmostFree )
+        {
+            REDSTATUS ret = 0;
+
+            if( gpRedCoreVol->fImapInline ||
+                ( ulBlockStart < gpRedCoreVol->ulInodeTableStartBN ) ||
+                ( ulBlockCount == 0U ) ||
+                ( ulBlockCount > ( gpRedVolume->ulBlockCount - ulBlockStart ) ) ||
+                ( pulAlmostFree == NULL ) )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                uint32_t ulOffset = ulBlockStart - gpRedCoreVol->ulInodeTableStartBN;
+                uint32_t ulOffsetEnd = ulOffset + ulBlockCount;
+
+                *pulAlmostFree = 0U;
+
+                while( ( ret == 0 ) && ( ulOffset < ulOffsetEnd ) )
+                {
+                    uint32_t ulImapNode = ulOffset / IMAPNODE_ENTRIES;
+                    uint32_t ulEntryStart = ulOffset % IMAPNODE_ENTRIES;
+                    uint32_t ulEntryEnd = REDMIN( IMAPNODE_ENTRIES, ulEntryStart + ( ulOffsetEnd - ulOffset ) );
+                    uint32_t ulEntryCount = ulEntryEnd - ulEntryStart;
+                    bool fWasBranched = ImapNodeIsBranched( ulImapNode );
+                    IMAPNODE * pImap;
+
+                    ret = ImapNodeBranch( ulImapNode, &pImap );
+
+                    if( ret == 0 )
+                    {
+                        if( RedBitCountSet( pImap->abEntries, ulEntryStart, ulEntryEnd ) != ulEntryCount )
+                        {
+                            /*  Every block being freed must be allocated; freeing a
+                             *  free block indicates that the imap is corrupt.
+                             */
+                            CRITICAL_ERROR();
+                            ret = -RED_EFUBAR;
+                        }
+                        else
+                        {
+                            RedBitClearRange( pImap->abEntries, ulEntryStart, ulEntryEnd );
+                        }
+
+                        RedBufferPut( pImap );
+                    }
+
+                    if( ret == 0 )
+                    {
+                        uint32_t ulAlmostFree = ulEntryCount;
+
+                        /*  If the node was not branched, the committed copy was
+                         *  identical to the working copy, in which every block of
+                         *  the run was just verified to be allocated.
+                         */
+                        #if REDCONF_IMAP_LAZY_FORMAT == 1
+                            if( fWasBranched && !ImapNodeIsInit( 1U - gpRedCoreVol->bCurMR, ulImapNode ) )
+                            {
+                                /*  The node was written for the first time in
+                                 *  this transaction, so none of the run was
+                                 *  allocated in the committed state.
+                                 */
+                                ulAlmostFree = 0U;
+                            }
+                            else
+                        #endif
+                        if( fWasBranched )
+                        {
+                            IMAPNODE * pOldImap;
+
+                            ret = RedBufferGet( RedImapNodeBlock( 1U - gpRedCoreVol->bCurMR, ulImapNode ), BFLAG_META_IMAP, CAST_VOID_PTR_PTR( &pOldImap ) );
+
+                            if( ret == 0 )
+                            {
+                                ulAlmostFree = RedBitCountSet( pOldImap->abEntries, ulEntryStart, ulEntryEnd );
+
+                                #if REDCONF_DISCARDS == 1
+                                    if( ulAlmostFree == ulEntryCount )
+                                    {
+                                        RedVolDiscardAdd( gpRedCoreVol->ulInodeTableStartBN + ulOffset, ulEntryCount );
+                                    }
+                                    else if( ulAlmostFree > 0U )
+                                    {
+                                        uint32_t ulEntry = ulEntryStart;
+
+                                        while( ulEntry < ulEntryEnd )
+                                        {
+                                            if( RedBitGet( pOldImap->abEntries, ulEntry ) )
+                                            {
+                                                uint32_t ulRunEnd = RedBitFindClear( pOldImap->abEntries, ulEntry, ulEntryEnd );
+
+                                                RedVolDiscardAdd( gpRedCoreVol->ulInodeTableStartBN + ( ulOffset - ulEntryStart ) + ulEntry, ulRunEnd - ulEntry );
+                                                ulEntry = ulRunEnd;
+                                            }
+                                            else
+                                            {
+                                                ulEntry++;
+                                            }
+                                        }
+                                    }
+                                    else
+                                    {
+                                        /*  Nothing in the run was committed, so there
+                                         *  is nothing to discard.
+                                         */
+                                    }
+                                #endif /* REDCONF_DISCARDS == 1 */
+
+                                RedBufferPut( pOldImap );
+                            }
+                        }
+                        else
+                        {
+                            #if REDCONF_DISCARDS == 1
+                                RedVolDiscardAdd( gpRedCoreVol->ulInodeTableStartBN + ulOffset, ulEntryCount );
+                            #endif
+                        }
+
+                        if( ret == 0 )
+                        {
+                            #if REDCONF_IMAP_SUMMARY == 1
+                                if( ulAlmostFree < ulEntryCount )
+                                {
+                                    RedBitClear( gpRedCoreVol->abImapFull, ulImapNode );
+                                }
+                            #endif
+
+                            *pulAlmostFree += ulAlmostFree;
+                            ulOffset += ulEntryCount;
+                        }
+                    }
+                }
+            }
+
+            return ret;
+        }
+
+
+/** @brief Find the first free block in a range of blocks.
+ *
+ *  A free block is one whose allocation bit is clear in both metaroots.  Blocks
+ *  which are clear only in the working metaroot are almost free and are
+ *  skipped.
+ *
+ *  @param ulBlockStart The first block to examine.
+ *  @param ulBlockEnd   The block after the last block to examine.
+ *  @param pulBlock     On successful return, populated with the first free
+ *                      block in the range, or with @p ulBlockEnd if there are
+ *                      no free blocks in the range.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The range is invalid; or @p pulBlock is `NULL`.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+        REDSTATUS RedImapEFindFree( uint32_t ulBlockStart,
+                                    uint32_t ulBlockEnd,
+                                    uint32_t * pulBlock )
+        {
+            REDSTATUS ret;
+
+            if( gpRedCoreVol->fImapInline ||
+                ( ulBlockStart < gpRedCoreVol->ulInodeTableStartBN ) ||
+                ( ulBlockEnd > gpRedVolume->ulBlockCount ) ||
+                ( ulBlockStart > ulBlockEnd ) ||
+                ( pulBlock == NULL ) )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                uint32_t ulOffsetEnd = ulBlockEnd - gpRedCoreVol->ulInodeTableStartBN;
+                uint32_t ulOffset = ulBlockStart - gpRedCoreVol->ulInodeTableStartBN;
+                bool fFound = false;
+
+                ret = 0;
+
+                while( ( ret == 0 ) && !fFound && ( ulOffset < ulOffsetEnd ) )
+                {
+                    uint32_t ulImapNode = ulOffset / IMAPNODE_ENTRIES;
+                    uint32_t ulNodeEnd = ( ulImapNode + 1U ) * IMAPNODE_ENTRIES;
+                    uint32_t ulFound;
+
+                    if( ulNodeEnd > ulOffsetEnd )
+                    {
+                        ulNodeEnd = ulOffsetEnd;
+                    }
+
+                    ret = ImapNodeFindFree( ulImapNode, ulOffset, ulNodeEnd, &ulFound );
+
+                    if( ret == 0 )
+                    {
+                        fFound = ulFound < ulNodeEnd;
+                        ulOffset = ulFound;
+                    }
+                }
+
+                if( ret == 0 )
+                {
+                    *pulBlock = ulOffset + gpRedCoreVol->ulInodeTableStartBN;
+                }
+            }
+
+            return ret;
+        }
+
+
+/** @brief Find the first free block within one imap node.
+ *
+ *  @param ulImapNode       The imap node to examine.
+ *  @param ulOffsetStart    The first imap entry to examine, relative to the
+ *                          start of the imap (not of the node).
+ *  @param ulOffsetEnd      The entry after the last entry to examine; must not
+ *                          be beyond the end of @p ulImapNode.
+ *  @param pulOffset        On successful return, populated with the first free
+ *                          entry, or with @p ulOffsetEnd if there are none.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+        static REDSTATUS ImapNodeFindFree( uint32_t ulImapNode,
+                                           uint32_t ulOffsetStart,
+                                           uint32_t ulOffsetEnd,
+                                           uint32_t * pulOffset )
+        {
+            uint32_t ulNodeBase = ulImapNode * IMAPNODE_ENTRIES;
+            uint32_t ulOffset = ulOffsetStart;
+            bool fNodeFull = false;
+            REDSTATUS ret = 0;
+
+            REDASSERT( ulImapNode < gpRedCoreVol->ulImapNodeCount );
+            REDASSERT( ( ulOffsetStart >= ulNodeBase ) && ( ulOffsetEnd <= ( ulNodeBase + IMAPNODE_ENTRIES ) ) );
+
+            #if REDCONF_IMAP_SUMMARY == 1
+                fNodeFull = RedBitGet( gpRedCoreVol->abImapFull, ulImapNode );
+            #endif
+
+            if( fNodeFull )
+            {
+                ulOffset = ulOffsetEnd;
+            }
+
+            #if REDCONF_IMAP_LAZY_FORMAT == 1
+                else if( !ImapNodeIsInit( gpRedCoreVol->bCurMR, ulImapNode ) )
+                {
+                    /*  Nothing covered by the node has been allocated since
+                     *  format, in either state.
+                     */
+                }
+            #endif
+            else
+            {
+                bool fBranched = ImapNodeIsBranched( ulImapNode );
+                bool fFound = false;
+
+                while( ( ret == 0 ) && !fFound && ( ulOffset < ulOffsetEnd ) )
+                {
+                    IMAPNODE * pImap;
+
+                    ret = RedBufferGet( RedImapNodeBlock( gpRedCoreVol->bCurMR, ulImapNode ), BFLAG_META_IMAP, CAST_VOID_PTR_PTR( &pImap ) );
+
+                    if( ret == 0 )
+                    {
+                        ulOffset = ulNodeBase + RedBitFindClear( pImap->abEntries, ulOffset - ulNodeBase, ulOffsetEnd - ulNodeBase );
+
+                        RedBufferPut( pImap );
+                    }
+
+                    if( ( ret == 0 ) && ( ulOffset < ulOffsetEnd ) )
+                    {
+                        if( fBranched )
+                        {
+                            bool fWasAllocated;
+
+                            /*  Clear in the working state; if also clear in the
+                             *  committed state the block is free, otherwise it is
+                             *  almost free.
+                             */
+                            ret = RedImapEBlockGet( 1U - gpRedCoreVol->bCurMR, ulOffset + gpRedCoreVol->ulInodeTableStartBN, &fWasAllocated );
+
+                            if( ret == 0 )
+                            {
+                                if( fWasAllocated )
+                                {
+                                    ulOffset++;
+                                }
+                                else
+                                {
+                                    fFound = true;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            fFound = true;
+                        }
+                    }
+                }
+
+                #if REDCONF_IMAP_SUMMARY == 1
+                    if( ( ret == 0 ) && !fFound )
+                    {
+                        uint32_t ulNodeFirst = gpRedCoreVol->ulFirstAllocableBN - gpRedCoreVol->ulInodeTableStartBN;
+                        uint32_t ulNodeLimit = gpRedVolume->ulBlockCount - gpRedCoreVol->ulInodeTableStartBN;
+
+                        if( ulNodeFirst < ulNodeBase )
+                        {
+                            ulNodeFirst = ulNodeBase;
+                        }
+
+                        if( ulNodeLimit > ( ulNodeBase + IMAPNODE_ENTRIES ) )
+                        {
+                            ulNodeLimit = ulNodeBase + IMAPNODE_ENTRIES;
+                        }
+
+                        /*  Only a scan of every allocable entry in the node proves
+                         *  that it has no free blocks.
+                         */
+                        if( ( ulOffsetStart <= ulNodeFirst ) && ( ulOffsetEnd >= ulNodeLimit ) )
+                        {
+                            RedBitSet( gpRedCoreVol->abImapFull, ulImapNode );
+                        }
+                    }
+                #endif
+            }
+
+            if( ret == 0 )
+            {
+                *pulOffset = ulOffset;
+            }
+
+            return ret;
+        }
+
+
 /** @brief Branch an imap node and get a buffer for it.
  *
  *  If the imap node is already branched, it can be overwritten in its current
@@ -204,6 +591,13 @@
                 REDERROR();
                 ret = -RED_EINVAL;
             }
+
+            #if REDCONF_IMAP_LAZY_FORMAT == 1
+                else if( !ImapNodeIsInit( gpRedCoreVol->bCurMR, ulImapNode ) )
+                {
+                    ret = ImapNodeMaterialize( ulImapNode, ppImap );
+                }
+            #endif
             else if( ImapNodeIsBranched( ulImapNode ) )
             {
                 /*  Imap node is already branched, so just get it buffered dirty.
@@ -268,9 +662,96 @@
              */
             return fNodeBitSetInMetaroot0 != fNodeBitSetInMetaroot1;
         }
+
+
+        #if REDCONF_IMAP_LAZY_FORMAT == 1
+
+/** @brief Write an imap node for the first time since format.
+ *
+ *  Nodes are written in order, so any unwritten nodes before @p ulImapNode
+ *  are written as well.  Each is branched and buffered as a new, all-free
+ *  node; the committed state has no copy of them to preserve.
+ *
+ *  @param ulImapNode   The imap node to write; must not yet be written in the
+ *                      working state.
+ *  @param ppImap       On successful return, populated with the imap node
+ *                      buffer, which will be marked dirty.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+            static REDSTATUS ImapNodeMaterialize( uint32_t ulImapNode,
+                                                  IMAPNODE ** ppImap )
+            {
+                uint16_t uImapFlags = ( uint16_t ) ( ( uint32_t ) BFLAG_META_IMAP | BFLAG_NEW | BFLAG_DIRTY );
+                REDSTATUS ret = 0;
+
+                REDASSERT( gpRedMR->ulImapNodesInit <= ulImapNode );
+
+                while( ( ret == 0 ) && ( gpRedMR->ulImapNodesInit <= ulImapNode ) )
+                {
+                    uint32_t ulNode = gpRedMR->ulImapNodesInit;
+                    uint32_t ulBlock;
+                    IMAPNODE * pImap;
+
+                    /*  Neither metaroot has used the node yet, so both point at
+                     *  its first location; move the working state to the other.
+                     */
+                    REDASSERT( !RedBitGet( gpRedMR->abEntries, ulNode ) );
+                    RedBitSet( gpRedMR->abEntries, ulNode );
+                    ulBlock = RedImapNodeBlock( gpRedCoreVol->bCurMR, ulNode );
+
+                    ret = RedBufferDiscardRange( ulBlock, 1U );
+
+                    if( ret == 0 )
+                    {
+                        ret = RedBufferGet( ulBlock, uImapFlags, CAST_VOID_PTR_PTR( &pImap ) );
+                    }
+
+                    if( ret == 0 )
+                    {
+                        gpRedMR->ulImapNodesInit++;
+
+                        if( ulNode == ulImapNode )
+                        {
+                            *ppImap = pImap;
+                        }
+                        else
+                        {
+                            RedBufferPut( pImap );
+                        }
+                    }
+                }
+
+                return ret;
+            }
+        #endif /* REDCONF_IMAP_LAZY_FORMAT == 1 */
     #endif /* REDCONF_READ_ONLY == 0 */
 
 
+    #if REDCONF_IMAP_LAZY_FORMAT == 1
+
+/** @brief Determine whether an imap node has been written in the given
+ *         metaroot.
+ *
+ *  An imap node which has not been written since format has no valid copy on
+ *  disk, and every block it covers is free.
+ *
+ *  @param bMR          Which metaroot to examine.
+ *  @param ulImapNode   The imap node to examine.
+ *
+ *  @return Whether the imap node has been written.
+ */
+        static bool ImapNodeIsInit( uint8_t bMR,
+                                    uint32_t ulImapNode )
+        {
+            return ulImapNode < gpRedCoreVol->aMR[ bMR ].ulImapNodesInit;
+        }
+    #endif
+
+
 /** @brief Calculate the block number of the imap node location indicated by the
  *         given metaroot.
  *
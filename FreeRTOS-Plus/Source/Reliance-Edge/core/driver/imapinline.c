@@ -128,6 +128,67 @@
 
             return ret;
         }
+
+
+/** @brief Find the first free block in a range of blocks.
+ *
+ *  A free block is one whose allocation bit is clear in both metaroots.  Blocks
+ *  which are clear only in the working metaroot are almost free and are
+ *  skipped.
+ *
+ *  @param ulBlockStart The first block to examine.
+ *  @param ulBlockEnd   The block after the last block to examine.
+ *  @param pulBlock     On successful return, populated with the first free
+ *                      block in the range, or with @p ulBlockEnd if there are
+ *                      no free blocks in the range.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The range is invalid; or @p pulBlock is `NULL`; or the
+ *                      current volume does not use the inline imap.
+ */
+        REDSTATUS RedImapIFindFree( uint32_t ulBlockStart,
+                                    uint32_t ulBlockEnd,
+                                    uint32_t * pulBlock )
+        {
+            REDSTATUS ret;
+
+            if( ( !gpRedCoreVol->fImapInline ) ||
+                ( ulBlockStart < gpRedCoreVol->ulInodeTableStartBN ) ||
+                ( ulBlockEnd > gpRedVolume->ulBlockCount ) ||
+                ( ulBlockStart > ulBlockEnd ) ||
+                ( pulBlock == NULL ) )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                const uint8_t * pbOld = gpRedCoreVol->aMR[ 1U - gpRedCoreVol->bCurMR ].abEntries;
+                uint32_t ulOffsetEnd = ulBlockEnd - gpRedCoreVol->ulInodeTableStartBN;
+                uint32_t ulOffset = ulBlockStart - gpRedCoreVol->ulInodeTableStartBN;
+
+                while( ulOffset < ulOffsetEnd )
+                {
+                    ulOffset = RedBitFindClear( gpRedMR->abEntries, ulOffset, ulOffsetEnd );
+
+                    if( ( ulOffset == ulOffsetEnd ) || !RedBitGet( pbOld, ulOffset ) )
+                    {
+                        break;
+                    }
+
+                    /*  Almost free: keep looking.
+                     */
+                    ulOffset++;
+                }
+
+                *pulBlock = ulOffset + gpRedCoreVol->ulInodeTableStartBN;
+                ret = 0;
+            }
+
+            return ret;
+        }
     #endif /* if REDCONF_READ_ONLY == 0 */
 
 #endif /* REDCONF_IMAP_INLINE == 1 */
@@ -37,6 +37,11 @@
 #endif
 #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )
     static REDSTATUS InodeFindFree( uint32_t * pulInode );
+    static void InodeFreeMapSet( uint32_t ulInode,
+                                 bool fInUse );
+    #if REDCONF_INODE_FREE_MAP_INODES > 0U
+        static REDSTATUS InodeFreeMapLoad( void );
+    #endif
 #endif
 #if REDCONF_READ_ONLY == 0
     static REDSTATUS InodeGetWriteableCopy( uint32_t ulInode,
@@ -51,6 +56,15 @@ static REDSTATUS InodeGetCurrentCopy( uint32_t ulInode,
 #endif
 static uint32_t InodeBlock( uint32_t ulInode,
                             uint8_t bWhich );
+#if REDCONF_INODE_CACHE_ENTRIES > 0U
+    static bool InodeCacheLookup( uint32_t ulInode,
+                                  uint8_t * pbWhich,
+                                  bool * pfBranched );
+    static void InodeCacheInsert( uint32_t ulInode,
+                                  uint8_t bWhich,
+                                  bool fBranched );
+    static void InodeCacheDrop( uint32_t ulInode );
+#endif
 
 
 /** @brief Mount an existing inode.
@@ -108,11 +122,23 @@ REDSTATUS RedInodeMount( CINODE * pInode,
     {
         uint32_t ulInode = pInode->ulInode;
         uint8_t bWhich = 0U; /* Init'd to quiet warnings. */
+        bool fCached = false;
+
+        #if REDCONF_INODE_CACHE_ENTRIES > 0U
+            bool fCachedBranched = false;
+        #endif
 
         RedMemSet( pInode, 0U, sizeof( *pInode ) );
         pInode->ulInode = ulInode;
 
-        ret = InodeGetCurrentCopy( pInode->ulInode, &bWhich );
+        #if REDCONF_INODE_CACHE_ENTRIES > 0U
+            fCached = InodeCacheLookup( pInode->ulInode, &bWhich, &fCachedBranched );
+
+            if( !fCached )
+        #endif
+        {
+            ret = InodeGetCurrentCopy( pInode->ulInode, &bWhich );
+        }
 
         if( ret == 0 )
         {
@@ -122,10 +148,32 @@ REDSTATUS RedInodeMount( CINODE * pInode,
         #if REDCONF_READ_ONLY == 0
             if( ret == 0 )
             {
-                ret = InodeIsBranched( pInode->ulInode, &pInode->fBranched );
+                #if REDCONF_INODE_CACHE_ENTRIES > 0U
+                    if( fCached )
+                    {
+                        pInode->fBranched = fCachedBranched;
+                    }
+                    else
+                #endif
+                {
+                    ret = InodeIsBranched( pInode->ulInode, &pInode->fBranched );
+                }
             }
         #endif
 
+        #if REDCONF_INODE_CACHE_ENTRIES > 0U
+            if( ( ret == 0 ) && !fCached )
+            {
+                #if REDCONF_READ_ONLY == 0
+                    InodeCacheInsert( pInode->ulInode, bWhich, pInode->fBranched );
+                #else
+                    InodeCacheInsert( pInode->ulInode, bWhich, false );
+                #endif
+            }
+        #else
+            ( void ) fCached;
+        #endif
+
         if( ret == 0 )
         {
             if( RED_S_ISREG( pInode->pInodeBuf->uMode ) )
@@ -285,6 +333,13 @@ REDSTATUS RedInodeMount( CINODE * pInode,
                         {
                             RedBufferPut( pInode->pInodeBuf );
                         }
+
+                        #if REDCONF_API_POSIX == 1
+                            else
+                            {
+                                InodeFreeMapSet( pInode->ulInode, true );
+                            }
+                        #endif
                     }
                 }
             }
@@ -301,6 +356,15 @@ REDSTATUS RedInodeMount( CINODE * pInode,
 
                 pInode->pInodeBuf->uMode = uMode;
 
+                #if REDCONF_INODE_INLINE == 1
+                    if( RED_S_ISREG( uMode ) )
+                    {
+                        /*  A new file is empty, so its data starts out inline.
+                         */
+                        pInode->pInodeBuf->uMode |= INODE_MODE_INLINE;
+                    }
+                #endif
+
                 #if REDCONF_API_POSIX == 1
                     #if REDCONF_API_POSIX_LINK == 1
                         pInode->pInodeBuf->uNLink = 1U;
@@ -428,6 +492,21 @@ REDSTATUS RedInodeMount( CINODE * pInode,
         {
             bool fSlot0Allocated;
 
+            #if REDCONF_DIR_INDEX_DIRS > 0U
+
+                /*  The inode number may be reused for a new directory.
+                 */
+                RedDirIndexDiscard( pInode->ulInode );
+            #endif
+
+            #if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+                /*  Likewise, the inode number may be reused for a new file,
+                 *  whose changes must not be logged as changes to this one.
+                 */
+                RedIntentDrop( pInode->ulInode );
+            #endif
+
             RedBufferDiscard( pInode->pInodeBuf );
             pInode->pInodeBuf = NULL;
 
@@ -477,6 +556,11 @@ REDSTATUS RedInodeMount( CINODE * pInode,
                 }
             }
 
+            if( ret == 0 )
+            {
+                InodeFreeMapSet( pInode->ulInode, false );
+            }
+
             pInode->ulInode = INODE_INVALID;
 
             if( ret == 0 )
@@ -769,6 +853,15 @@ void RedInodePutData( CINODE * pInode )
                 ret = InodeBitSet( pInode->ulInode, bWhich, true );
             }
 
+            #if REDCONF_INODE_CACHE_ENTRIES > 0U
+                if( ret == 0 )
+                {
+                    /*  The writeable copy is now the current copy.
+                     */
+                    InodeCacheInsert( pInode->ulInode, bWhich, true );
+                }
+            #endif
+
             CRITICAL_ASSERT( ret == 0 );
         }
         else
@@ -786,6 +879,11 @@ void RedInodePutData( CINODE * pInode )
 #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )
 
 /** @brief Find a free inode number.
+ *
+ *  The lowest free inode number is returned.  The search starts from the
+ *  volume's free inode hint, below which no inode is free, and uses the RAM
+ *  map of inodes in use when the volume has one, so that it does not need to
+ *  read the imap.
  *
  *  @param pulInode On successful return, populated with a free inode number.
  *
@@ -811,26 +909,52 @@ void RedInodePutData( CINODE * pInode )
         }
         else
         {
-            uint32_t ulInode;
+            uint32_t ulInodeEnd = INODE_FIRST_VALID + gpRedVolConf->ulInodeCount;
+            uint32_t ulInode = gpRedCoreVol->ulInodeFreeHint;
+
+            REDASSERT( ulInode >= INODE_FIRST_FREE );
 
             ret = 0;
 
-            for( ulInode = INODE_FIRST_FREE; ulInode < ( INODE_FIRST_VALID + gpRedVolConf->ulInodeCount ); ulInode++ )
+            #if REDCONF_INODE_FREE_MAP_INODES > 0U
+                if( gpRedVolConf->ulInodeCount <= REDCONF_INODE_FREE_MAP_INODES )
+                {
+                    if( !gpRedCoreVol->fInodeMapValid )
+                    {
+                        ret = InodeFreeMapLoad();
+                    }
+
+                    if( ret == 0 )
+                    {
+                        ulInode = INODE_FIRST_VALID + RedBitFindClear( gpRedCoreVol->abInodeUsed, ulInode - INODE_FIRST_VALID, gpRedVolConf->ulInodeCount );
+                    }
+                }
+                else
+            #endif
             {
-                bool fFree;
+                while( ulInode < ulInodeEnd )
+                {
+                    bool fFree;
 
-                ret = RedInodeIsFree( ulInode, &fFree );
+                    ret = RedInodeIsFree( ulInode, &fFree );
 
-                if( ( ret != 0 ) || fFree )
-                {
-                    break;
+                    if( ( ret != 0 ) || fFree )
+                    {
+                        break;
+                    }
+
+                    ulInode++;
                 }
             }
 
             if( ret == 0 )
             {
-                if( ulInode < ( INODE_FIRST_VALID + gpRedVolConf->ulInodeCount ) )
+                if( ulInode < ulInodeEnd )
                 {
+                    /*  Every inode number between the hint and this one is in
+                     *  use, so the hint can move up to it.
+                     */
+                    gpRedCoreVol->ulInodeFreeHint = ulInode;
                     *pulInode = ulInode;
                 }
                 else
@@ -845,6 +969,106 @@ void RedInodePutData( CINODE * pInode )
 
         return ret;
     }
+
+
+/** @brief Forget what is known about which inode numbers are free.
+ *
+ *  Called when the imap is replaced wholesale, i.e., at mount and format.  The
+ *  RAM map of inodes in use, if any, is loaded again by the next search.
+ */
+    void RedInodeFreeMapReset( void )
+    {
+        gpRedCoreVol->ulInodeFreeHint = INODE_FIRST_FREE;
+
+        #if REDCONF_INODE_FREE_MAP_INODES > 0U
+            gpRedCoreVol->fInodeMapValid = false;
+        #endif
+    }
+
+
+/** @brief Record that an inode number has been allocated or freed.
+ *
+ *  @param ulInode  The inode number.
+ *  @param fInUse   Whether the inode is now in use (true) or free (false).
+ */
+    static void InodeFreeMapSet( uint32_t ulInode,
+                                 bool fInUse )
+    {
+        REDASSERT( INODE_IS_VALID( ulInode ) );
+
+        if( fInUse )
+        {
+            if( ulInode == gpRedCoreVol->ulInodeFreeHint )
+            {
+                gpRedCoreVol->ulInodeFreeHint++;
+            }
+        }
+        else if( ulInode < gpRedCoreVol->ulInodeFreeHint )
+        {
+            gpRedCoreVol->ulInodeFreeHint = ulInode;
+        }
+        else
+        {
+            /*  The hint is already at or below the freed inode.
+             */
+        }
+
+        #if REDCONF_INODE_FREE_MAP_INODES > 0U
+            if( gpRedCoreVol->fInodeMapValid )
+            {
+                if( fInUse )
+                {
+                    RedBitSet( gpRedCoreVol->abInodeUsed, ulInode - INODE_FIRST_VALID );
+                }
+                else
+                {
+                    RedBitClear( gpRedCoreVol->abInodeUsed, ulInode - INODE_FIRST_VALID );
+                }
+            }
+        #endif
+    }
+
+
+    #if REDCONF_INODE_FREE_MAP_INODES > 0U
+
+/** @brief Load the RAM map of inodes in use from the imap.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+        static REDSTATUS InodeFreeMapLoad( void )
+        {
+            REDSTATUS ret = 0;
+            uint32_t ulInode;
+
+            REDASSERT( gpRedVolConf->ulInodeCount <= REDCONF_INODE_FREE_MAP_INODES );
+
+            RedMemSet( gpRedCoreVol->abInodeUsed, 0U, sizeof( gpRedCoreVol->abInodeUsed ) );
+
+            for( ulInode = INODE_FIRST_VALID; ulInode < ( INODE_FIRST_VALID + gpRedVolConf->ulInodeCount ); ulInode++ )
+            {
+                bool fFree;
+
+                ret = RedInodeIsFree( ulInode, &fFree );
+
+                if( ret != 0 )
+                {
+                    break;
+                }
+
+                if( !fFree )
+                {
+                    RedBitSet( gpRedCoreVol->abInodeUsed, ulInode - INODE_FIRST_VALID );
+                }
+            }
+
+            gpRedCoreVol->fInodeMapValid = ( ret == 0 );
+
+            return ret;
+        }
+    #endif /* REDCONF_INODE_FREE_MAP_INODES > 0U */
 #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 ) */
 
 
@@ -1102,6 +1326,10 @@ REDSTATUS RedInodeBitGet( uint8_t bMR,
         }
         else
         {
+            #if REDCONF_INODE_CACHE_ENTRIES > 0U
+                InodeCacheDrop( ulInode );
+            #endif
+
             ret = RedImapBlockSet( InodeBlock( ulInode, bWhich ), fAllocated );
         }
 
@@ -1125,3 +1353,134 @@ static uint32_t InodeBlock( uint32_t ulInode,
 
     return gpRedCoreVol->ulInodeTableStartBN + ( ( ulInode - INODE_FIRST_VALID ) * 2U ) + bWhich;
 }
+
+
+#if REDCONF_INODE_CACHE_ENTRIES > 0U
+
+/** @brief Forget all the inodes in the inode cache.
+ *
+ *  Called when the imap is replaced wholesale, i.e., at mount and format.
+ */
+    void RedInodeCacheReset( void )
+    {
+        uint32_t ulIdx;
+
+        for( ulIdx = 0U; ulIdx < REDCONF_INODE_CACHE_ENTRIES; ulIdx++ )
+        {
+            gpRedCoreVol->aInodeCache[ ulIdx ].ulInode = INODE_INVALID;
+        }
+
+        gpRedCoreVol->bInodeCacheNext = 0U;
+    }
+
+
+    #if REDCONF_READ_ONLY == 0
+
+/** @brief Update the inode cache for a transaction point.
+ *
+ *  The current copy of each inode is unchanged by a transaction point, but no
+ *  inode is branched afterward.
+ */
+        void RedInodeCacheCommit( void )
+        {
+            uint32_t ulIdx;
+
+            for( ulIdx = 0U; ulIdx < REDCONF_INODE_CACHE_ENTRIES; ulIdx++ )
+            {
+                gpRedCoreVol->aInodeCache[ ulIdx ].fBranched = false;
+            }
+        }
+    #endif
+
+
+/** @brief Look up an inode in the inode cache.
+ *
+ *  @param ulInode      The inode number.
+ *  @param pbWhich      On a hit, populated with which copy of the inode is
+ *                      current.
+ *  @param pfBranched   On a hit, populated with whether the inode is branched.
+ *
+ *  @return Whether the inode was found in the cache.
+ */
+    static bool InodeCacheLookup( uint32_t ulInode,
+                                  uint8_t * pbWhich,
+                                  bool * pfBranched )
+    {
+        bool fFound = false;
+        uint32_t ulIdx;
+
+        for( ulIdx = 0U; ( ulIdx < REDCONF_INODE_CACHE_ENTRIES ) && !fFound; ulIdx++ )
+        {
+            const INODECACHEENTRY * pEntry = &gpRedCoreVol->aInodeCache[ ulIdx ];
+
+            if( pEntry->ulInode == ulInode )
+            {
+                *pbWhich = pEntry->bWhich;
+                *pfBranched = pEntry->fBranched;
+                fFound = true;
+            }
+        }
+
+        return fFound;
+    }
+
+
+/** @brief Record the current copy of an inode in the inode cache.
+ *
+ *  An existing entry for the inode is updated; otherwise the entries are
+ *  replaced in turn.
+ *
+ *  @param ulInode      The inode number.
+ *  @param bWhich       Which copy of the inode is current.
+ *  @param fBranched    Whether the inode is branched.
+ */
+    static void InodeCacheInsert( uint32_t ulInode,
+                                  uint8_t bWhich,
+                                  bool fBranched )
+    {
+        INODECACHEENTRY * pEntry = NULL;
+        uint32_t ulIdx;
+
+        for( ulIdx = 0U; ( ulIdx < REDCONF_INODE_CACHE_ENTRIES ) && ( pEntry == NULL ); ulIdx++ )
+        {
+            if( gpRedCoreVol->aInodeCache[ ulIdx ].ulInode == ulInode )
+            {
+                pEntry = &gpRedCoreVol->aInodeCache[ ulIdx ];
+            }
+        }
+
+        if( pEntry == NULL )
+        {
+            pEntry = &gpRedCoreVol->aInodeCache[ gpRedCoreVol->bInodeCacheNext ];
+
+            gpRedCoreVol->bInodeCacheNext++;
+
+            if( gpRedCoreVol->bInodeCacheNext == REDCONF_INODE_CACHE_ENTRIES )
+            {
+                gpRedCoreVol->bInodeCacheNext = 0U;
+            }
+        }
+
+        pEntry->ulInode = ulInode;
+        pEntry->bWhich = bWhich;
+        pEntry->fBranched = fBranched;
+    }
+
+
+/** @brief Remove an inode from the inode cache.
+ *
+ *  @param ulInode  The inode number, whose imap bits are about to change.
+ */
+    static void InodeCacheDrop( uint32_t ulInode )
+    {
+        uint32_t ulIdx;
+
+        for( ulIdx = 0U; ulIdx < REDCONF_INODE_CACHE_ENTRIES; ulIdx++ )
+        {
+            if( gpRedCoreVol->aInodeCache[ ulIdx ].ulInode == ulInode )
+            {
+                gpRedCoreVol->aInodeCache[ ulIdx ].ulInode = INODE_INVALID;
+            }
+        }
+    }
+#endif /* REDCONF_INODE_CACHE_ENTRIES > 0U */
@@ -55,6 +55,50 @@ typedef enum
 } BRANCHDEPTH;
 
 
+#if REDCONF_INODE_INLINE == 1
+
+/*  Whether the data of a cached inode is stored in its block pointer array.
+ */
+    #define INODE_IS_INLINE( pInode )    ( ( ( pInode )->pInodeBuf->uMode & INODE_MODE_INLINE ) != 0U )
+
+/*  The file data of an inline inode.
+ */
+    #define INODE_INLINE_DATA( pInode )    ( CAST_VOID_PTR_TO_UINT8_PTR( ( pInode )->pInodeBuf->aulEntries ) )
+#endif
+
+
+#if REDCONF_READAHEAD_BLOCKS > 0U
+
+/*  State of a sequential read stream, used to decide when and how far to read
+ *  ahead.  Streams are identified by volume and inode number, so two handles
+ *  reading the same file share a stream.
+ */
+    typedef struct
+    {
+        uint64_t ullNextOffset; /* Offset at which the next sequential read starts. */
+        uint32_t ulInode;       /* Inode number; INODE_INVALID if the slot is unused. */
+        uint32_t ulLastBlock;   /* Last file block read by this stream. */
+        uint32_t ulHitStart;    /* First file block read ahead by the last request. */
+        uint32_t ulNext;        /* File block after the last block read ahead. */
+        uint8_t bVolNum;        /* Volume the inode resides on. */
+    } RASTREAM;
+#endif
+
+
+#if FALLOCATE_SUPPORTED
+
+/*  A run of contiguous blocks allocated by RedInodeDataAllocate(), from which
+ *  BranchOneBlock() takes file data blocks.  Empty except while the inode data
+ *  is being allocated.
+ */
+    typedef struct
+    {
+        uint32_t ulNext;  /* Next block of the run. */
+        uint32_t ulCount; /* Number of blocks left in the run. */
+    } ALLOCRUN;
+#endif
+
+
 #if REDCONF_READ_ONLY == 0
     #if DELETE_SUPPORTED || TRUNCATE_SUPPORTED
         static REDSTATUS Shrink( CINODE * pInode,
@@ -67,12 +111,16 @@ typedef enum
             static REDSTATUS TruncIndir( CINODE * pInode,
                                          bool * pfFreed );
         #endif
-        static REDSTATUS TruncDataBlock( const CINODE * pInode,
-                                         uint32_t * pulBlock,
-                                         bool fPropagate );
+        static REDSTATUS TruncDataBlocks( const CINODE * pInode,
+                                          uint32_t * pulBlocks,
+                                          uint32_t ulBlockCount,
+                                          bool fPropagate );
     #endif /* if DELETE_SUPPORTED || TRUNCATE_SUPPORTED */
     static REDSTATUS ExpandPrepare( CINODE * pInode );
 #endif /* if REDCONF_READ_ONLY == 0 */
+#if FALLOCATE_SUPPORTED
+    static REDSTATUS AllocRunRelease( void );
+#endif
 static void SeekCoord( CINODE * pInode,
                        uint32_t ulBlock );
 static REDSTATUS ReadUnaligned( CINODE * pInode,
@@ -108,7 +156,39 @@ static REDSTATUS GetExtent( CINODE * pInode,
                                       BRANCHDEPTH depth,
                                       uint32_t * pulCost );
     static uint32_t FreeBlockCount( void );
+    #if REDCONF_INODE_INLINE == 1
+        static REDSTATUS InlineEvict( CINODE * pInode );
+    #endif
 #endif /* if REDCONF_READ_ONLY == 0 */
+#if REDCONF_READAHEAD_BLOCKS > 0U
+    static RASTREAM * ReadAheadStream( uint32_t ulInode,
+                                       uint64_t ullStart,
+                                       uint32_t ulLen );
+    static REDSTATUS ReadAheadBlock( CINODE * pInode,
+                                     RASTREAM * pStream,
+                                     uint32_t ulBlock );
+    static REDSTATUS ReadBuffered( CINODE * pInode,
+                                   RASTREAM * pStream,
+                                   uint32_t ulBlockStart,
+                                   uint32_t ulBlockCount,
+                                   uint8_t * pbBuffer );
+
+
+    static RASTREAM gaRaStream[ REDCONF_READAHEAD_STREAMS ];
+    static uint8_t gbRaStreamNext;
+    static REDRASTATS gRaStats;
+#endif
+
+#if FALLOCATE_SUPPORTED
+    static ALLOCRUN gaAllocRun[ REDCONF_VOLUME_COUNT ];
+#endif
+
+#if ( REDCONF_READBUF_COUNT > 0U ) || COPY_SUPPORTED
+
+/*  Lent in place of a buffer for sparse data, which reads as zeroes.
+ */
+    static const uint8_t gabZeroBlock[ REDCONF_BLOCK_SIZE ] = { 0U };
+#endif
 
 
 /** @brief Read data from an inode.
@@ -148,6 +228,16 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
         /*  Do nothing, just return success.
          */
     }
+
+    #if REDCONF_INODE_INLINE == 1
+        else if( INODE_IS_INLINE( pInode ) )
+        {
+            uint32_t ulLen = ( uint32_t ) REDMIN( *pulLen, pInode->pInodeBuf->ullSize - ullStart );
+
+            RedMemCpy( pBuffer, &INODE_INLINE_DATA( pInode )[ ullStart ], ulLen );
+            *pulLen = ulLen;
+        }
+    #endif
     else
     {
         uint8_t * pbBuffer = CAST_VOID_PTR_TO_UINT8_PTR( pBuffer );
@@ -155,6 +245,10 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
         uint32_t ulLen = *pulLen;
         uint32_t ulRemaining;
 
+        #if REDCONF_READAHEAD_BLOCKS > 0U
+            RASTREAM * pStream;
+        #endif
+
         /*  Reading beyond the end of the file is not allowed.  If the requested
          *  read extends beyond the end of the file, truncate the read length so
          *  that the read stops at the end of the file.
@@ -166,6 +260,14 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
 
         ulRemaining = ulLen;
 
+        /*  Small sequential reads are served from the buffer cache, and the
+         *  buffers are filled ahead of the reader.  Other reads bypass the
+         *  buffers for whole blocks, as usual.
+         */
+        #if REDCONF_READAHEAD_BLOCKS > 0U
+            pStream = ReadAheadStream( pInode->ulInode, ullStart, ulLen );
+        #endif
+
         /*  Unaligned partial block at start.
          */
         if( ( ullStart & ( REDCONF_BLOCK_SIZE - 1U ) ) != 0U )
@@ -173,7 +275,14 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
             uint32_t ulBytesInFirstBlock = REDCONF_BLOCK_SIZE - ( uint32_t ) ( ullStart & ( REDCONF_BLOCK_SIZE - 1U ) );
             uint32_t ulThisRead = REDMIN( ulRemaining, ulBytesInFirstBlock );
 
-            ret = ReadUnaligned( pInode, ullStart, ulThisRead, pbBuffer );
+            #if REDCONF_READAHEAD_BLOCKS > 0U
+                ret = ReadAheadBlock( pInode, pStream, ( uint32_t ) ( ullStart >> BLOCK_SIZE_P2 ) );
+
+                if( ret == 0 )
+            #endif
+            {
+                ret = ReadUnaligned( pInode, ullStart, ulThisRead, pbBuffer );
+            }
 
             if( ret == 0 )
             {
@@ -191,7 +300,16 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
 
             REDASSERT( ( ( ullStart + ulReadIndex ) & ( REDCONF_BLOCK_SIZE - 1U ) ) == 0U );
 
-            ret = ReadAligned( pInode, ulBlockOffset, ulBlockCount, &pbBuffer[ ulReadIndex ] );
+            #if REDCONF_READAHEAD_BLOCKS > 0U
+                if( pStream != NULL )
+                {
+                    ret = ReadBuffered( pInode, pStream, ulBlockOffset, ulBlockCount, &pbBuffer[ ulReadIndex ] );
+                }
+                else
+            #endif
+            {
+                ret = ReadAligned( pInode, ulBlockOffset, ulBlockCount, &pbBuffer[ ulReadIndex ] );
+            }
 
             if( ret == 0 )
             {
@@ -207,7 +325,14 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
             REDASSERT( ulRemaining < REDCONF_BLOCK_SIZE );
             REDASSERT( ( ( ullStart + ulReadIndex ) & ( REDCONF_BLOCK_SIZE - 1U ) ) == 0U );
 
-            ret = ReadUnaligned( pInode, ullStart + ulReadIndex, ulRemaining, &pbBuffer[ ulReadIndex ] );
+            #if REDCONF_READAHEAD_BLOCKS > 0U
+                ret = ReadAheadBlock( pInode, pStream, ( uint32_t ) ( ( ullStart + ulReadIndex ) >> BLOCK_SIZE_P2 ) );
+
+                if( ret == 0 )
+            #endif
+            {
+                ret = ReadUnaligned( pInode, ullStart + ulReadIndex, ulRemaining, &pbBuffer[ ulReadIndex ] );
+            }
         }
 
         if( ret == 0 )
@@ -220,6 +345,130 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
 }
 
 
+#if ( REDCONF_READBUF_COUNT > 0U ) || COPY_SUPPORTED
+
+/** @brief Lend the buffer holding the data of an inode at a given offset.
+ *
+ *  The data is not copied: the buffer stays referenced, and must not change,
+ *  until it is given back with RedInodeDataReturn().  The lent data never
+ *  extends past the end of the block containing @p ullStart.  The data of an
+ *  inline inode is lent from the inode buffer.
+ *
+ *  @param pInode   A pointer to the cached inode structure of the inode from
+ *                  which to read.
+ *  @param ullStart The file offset at which to read.
+ *  @param pulLen   On input, the maximum number of bytes to lend.  On
+ *                  successful return, populated with the number of bytes
+ *                  which are available at @p ullStart in the lent block.
+ *  @param ppbBlock On successful return, if @p pulLen is nonzero, populated
+ *                  with the start of the lent block, to be given back.
+ *  @param ppbData  On successful return, if @p pulLen is nonzero, populated
+ *                  with the data at @p ullStart.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL @p pInode is not a mounted cached inode pointer; or
+ *                      @p pulLen is `NULL`; or @p ppbBlock is `NULL`; or
+ *                      @p ppbData is `NULL`.
+ */
+    REDSTATUS RedInodeDataLend( CINODE * pInode,
+                                uint64_t ullStart,
+                                uint32_t * pulLen,
+                                const uint8_t ** ppbBlock,
+                                const uint8_t ** ppbData )
+    {
+        REDSTATUS ret = 0;
+
+        if( !CINODE_IS_MOUNTED( pInode ) || ( pulLen == NULL ) || ( ppbBlock == NULL ) || ( ppbData == NULL ) )
+        {
+            ret = -RED_EINVAL;
+        }
+        else if( ( ullStart >= pInode->pInodeBuf->ullSize ) || ( *pulLen == 0U ) )
+        {
+            *pulLen = 0U;
+        }
+
+        #if REDCONF_INODE_INLINE == 1
+            else if( INODE_IS_INLINE( pInode ) )
+            {
+                /*  The cached inode holds its own reference to the inode
+                 *  buffer; take another one on behalf of the borrower.
+                 */
+                RedBufferReference( pInode->pInodeBuf );
+
+                *ppbBlock = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pInode->pInodeBuf );
+                *ppbData = &INODE_INLINE_DATA( pInode )[ ullStart ];
+                *pulLen = ( uint32_t ) REDMIN( *pulLen, pInode->pInodeBuf->ullSize - ullStart );
+            }
+        #endif
+        else
+        {
+            uint32_t ulBlockOffset = ( uint32_t ) ( ullStart & ( REDCONF_BLOCK_SIZE - 1U ) );
+            uint32_t ulLen = REDMIN( *pulLen, REDCONF_BLOCK_SIZE - ulBlockOffset );
+
+            if( ( pInode->pInodeBuf->ullSize - ullStart ) < ulLen )
+            {
+                ulLen = ( uint32_t ) ( pInode->pInodeBuf->ullSize - ullStart );
+            }
+
+            ret = RedInodeDataSeekAndRead( pInode, ( uint32_t ) ( ullStart >> BLOCK_SIZE_P2 ) );
+
+            if( ret == 0 )
+            {
+                void * pBuffer;
+
+                /*  The cached inode holds its own reference to the data
+                 *  buffer, which is released when the inode is put; take
+                 *  another one on behalf of the borrower.
+                 */
+                ret = RedBufferGet( pInode->ulDataBlock, 0U, &pBuffer );
+
+                if( ret == 0 )
+                {
+                    *ppbBlock = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pBuffer );
+                }
+            }
+            else if( ret == -RED_ENODATA )
+            {
+                /*  Sparse block, lend zeroed data.
+                 */
+                *ppbBlock = gabZeroBlock;
+                ret = 0;
+            }
+            else
+            {
+                /*  No action, just return the error.
+                 */
+            }
+
+            if( ret == 0 )
+            {
+                *ppbData = &( *ppbBlock )[ ulBlockOffset ];
+                *pulLen = ulLen;
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Give back a block lent by RedInodeDataLend().
+ *
+ *  @param pbBlock  The start of the lent block, as populated in the
+ *                  `ppbBlock` parameter of RedInodeDataLend().
+ */
+    void RedInodeDataReturn( const uint8_t * pbBlock )
+    {
+        if( pbBlock != gabZeroBlock )
+        {
+            RedBufferPut( pbBlock );
+        }
+    }
+#endif /* if ( REDCONF_READBUF_COUNT > 0U ) || COPY_SUPPORTED */
+
+
 #if REDCONF_READ_ONLY == 0
 
 /** @brief Write to an inode.
@@ -264,6 +513,22 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
             /*  Do nothing, just return success.
              */
         }
+
+        #if REDCONF_INODE_INLINE == 1
+            else if( INODE_IS_INLINE( pInode ) && ( ullStart <= INODE_INLINE_MAX ) && ( *pulLen <= ( INODE_INLINE_MAX - ( uint32_t ) ullStart ) ) )
+            {
+                /*  The write fits inline.  Any gap beyond the old end of the
+                 *  file already reads as zeroes, since inline bytes beyond the
+                 *  end of the file are kept zeroed.
+                 */
+                RedMemCpy( &INODE_INLINE_DATA( pInode )[ ullStart ], pBuffer, *pulLen );
+
+                if( ( ullStart + *pulLen ) > pInode->pInodeBuf->ullSize )
+                {
+                    pInode->pInodeBuf->ullSize = ullStart + *pulLen;
+                }
+            }
+        #endif
         else
         {
             const uint8_t * pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pBuffer );
@@ -278,11 +543,18 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
 
             ulRemaining = ulLen;
 
+            #if REDCONF_INODE_INLINE == 1
+                if( INODE_IS_INLINE( pInode ) )
+                {
+                    ret = InlineEvict( pInode );
+                }
+            #endif
+
             /*  If the write is beyond the current end of the file, and the current
              *  end of the file is not block-aligned, then there may be some data
              *  that needs to be zeroed in the last block.
              */
-            if( ullStart > pInode->pInodeBuf->ullSize )
+            if( ( ret == 0 ) && ( ullStart > pInode->pInodeBuf->ullSize ) )
             {
                 ret = ExpandPrepare( pInode );
             }
@@ -375,6 +647,163 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
     }
 
 
+    #if FALLOCATE_SUPPORTED
+
+/** @brief Allocate the data blocks of a range of an inode.
+ *
+ *  Each sparse block in the range is given a zeroed data block, which is taken
+ *  from a run of contiguous blocks allocated up front, so that the blocks of
+ *  the range are laid out sequentially on disk as far as free space allows.
+ *  If the range extends beyond the end of the file, the file size is
+ *  increased to the end of the range.
+ *
+ *  If there is not enough free space, the blocks allocated before running out
+ *  of space remain allocated and the file size covers them.
+ *
+ *  @param pInode   A pointer to the cached inode structure.
+ *  @param ullStart The file offset of the start of the range.
+ *  @param ullLen   The length of the range, in bytes.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EFBIG  The range extends beyond the maximum file size.
+ *  @retval -RED_EINVAL @p pInode is not a mounted dirty cached inode pointer.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOSPC Insufficient free space to allocate the whole range.
+ */
+        REDSTATUS RedInodeDataAllocate( CINODE * pInode,
+                                        uint64_t ullStart,
+                                        uint64_t ullLen )
+        {
+            REDSTATUS ret = 0;
+
+            if( !CINODE_IS_DIRTY( pInode ) )
+            {
+                ret = -RED_EINVAL;
+            }
+            else if( ( ullStart > INODE_SIZE_MAX ) || ( ( INODE_SIZE_MAX - ullStart ) < ullLen ) )
+            {
+                ret = -RED_EFBIG;
+            }
+            else if( ullLen == 0U )
+            {
+                /*  Do nothing, just return success.
+                 */
+            }
+
+            #if REDCONF_INODE_INLINE == 1
+                else if( INODE_IS_INLINE( pInode ) && ( ( ullStart + ullLen ) <= INODE_INLINE_MAX ) )
+                {
+                    /*  Inline data is always allocated, and reads as zeroes
+                     *  beyond the end of the file.
+                     */
+                    if( ( ullStart + ullLen ) > pInode->pInodeBuf->ullSize )
+                    {
+                        pInode->pInodeBuf->ullSize = ullStart + ullLen;
+                    }
+                }
+            #endif
+            else
+            {
+                uint64_t ullEnd = ullStart + ullLen;
+                uint32_t ulBlock = ( uint32_t ) ( ullStart >> BLOCK_SIZE_P2 );
+                uint32_t ulBlockEnd = ( uint32_t ) ( ( ( ullEnd - 1U ) >> BLOCK_SIZE_P2 ) + 1U );
+                ALLOCRUN * pRun = &gaAllocRun[ gbRedVolNum ];
+                REDSTATUS ret2;
+
+                REDASSERT( pRun->ulCount == 0U );
+
+                #if REDCONF_INODE_INLINE == 1
+                    if( INODE_IS_INLINE( pInode ) )
+                    {
+                        ret = InlineEvict( pInode );
+                    }
+                #endif
+
+                if( ( ret == 0 ) && ( ullEnd > pInode->pInodeBuf->ullSize ) )
+                {
+                    ret = ExpandPrepare( pInode );
+                }
+
+                while( ( ret == 0 ) && ( ulBlock < ulBlockEnd ) )
+                {
+                    ret = RedInodeDataSeek( pInode, ulBlock );
+
+                    if( ret == -RED_ENODATA )
+                    {
+                        ret = 0;
+
+                        if( pRun->ulCount == 0U )
+                        {
+                            /*  Allocate a run for all of the remaining blocks,
+                             *  not knowing how many of them are sparse; blocks
+                             *  left over are freed again below.  When free
+                             *  space is short, leave room for the indirect and
+                             *  double indirect nodes which map the run.
+                             */
+                            uint32_t ulFree = FreeBlockCount();
+                            uint32_t ulCount = REDMIN( ulBlockEnd - ulBlock, ulFree );
+                            uint32_t ulNodes = ( ulCount / INDIR_ENTRIES ) + ( ulCount / ( INDIR_ENTRIES * INDIR_ENTRIES ) ) + 2U;
+
+                            if( ( ulCount > 1U ) && ( ( ulFree - ulCount ) < ulNodes ) )
+                            {
+                                ulCount = ( ulFree > ulNodes ) ? ( ulFree - ulNodes ) : 1U;
+                            }
+
+                            if( ulCount == 0U )
+                            {
+                                ret = -RED_ENOSPC;
+                            }
+                            else
+                            {
+                                ret = RedImapAllocBlocks( &pRun->ulNext, &ulCount );
+
+                                if( ret == 0 )
+                                {
+                                    pRun->ulCount = ulCount;
+                                }
+                            }
+                        }
+
+                        if( ret == 0 )
+                        {
+                            ret = BranchBlock( pInode, BRANCHDEPTH_FILE_DATA, true );
+                        }
+                    }
+
+                    if( ret == 0 )
+                    {
+                        uint64_t ullBlockEndOffset = ( uint64_t ) ulBlock << BLOCK_SIZE_P2;
+
+                        ulBlock++;
+                        ullBlockEndOffset += REDCONF_BLOCK_SIZE;
+
+                        /*  Grow the file along with the allocation, so that no
+                         *  block is left allocated beyond the end of the file.
+                         *  A range which ends inside the block holding the end
+                         *  of the file must not shrink it.
+                         */
+                        if( ullBlockEndOffset > pInode->pInodeBuf->ullSize )
+                        {
+                            pInode->pInodeBuf->ullSize = REDMAX( pInode->pInodeBuf->ullSize, REDMIN( ullBlockEndOffset, ullEnd ) );
+                        }
+                    }
+                }
+
+                ret2 = AllocRunRelease();
+
+                if( ret == 0 )
+                {
+                    ret = ret2;
+                }
+            }
+
+            return ret;
+        }
+    #endif /* if FALLOCATE_SUPPORTED */
+
+
     #if DELETE_SUPPORTED || TRUNCATE_SUPPORTED
 
 /** @brief Change the size of an inode.
@@ -407,9 +836,35 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
             {
                 ret = -RED_EFBIG;
             }
+
+            #if REDCONF_INODE_INLINE == 1
+                else if( INODE_IS_INLINE( pInode ) && ( ullSize <= INODE_INLINE_MAX ) )
+                {
+                    /*  Keep the inline bytes beyond the end of the file zeroed.
+                     */
+                    if( ullSize < pInode->pInodeBuf->ullSize )
+                    {
+                        RedMemSet( &INODE_INLINE_DATA( pInode )[ ullSize ], 0U, ( uint32_t ) ( pInode->pInodeBuf->ullSize - ullSize ) );
+                    }
+
+                    pInode->pInodeBuf->ullSize = ullSize;
+                }
+            #endif
             else
             {
-                if( ullSize > pInode->pInodeBuf->ullSize )
+                #if REDCONF_INODE_INLINE == 1
+                    if( INODE_IS_INLINE( pInode ) )
+                    {
+                        ret = InlineEvict( pInode );
+                    }
+                #endif
+
+                if( ret != 0 )
+                {
+                    /*  No action, just return the error.
+                     */
+                }
+                else if( ullSize > pInode->pInodeBuf->ullSize )
                 {
                     ret = ExpandPrepare( pInode );
                 }
@@ -426,6 +881,17 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
                 if( ret == 0 )
                 {
                     pInode->pInodeBuf->ullSize = ullSize;
+
+                    #if REDCONF_INODE_INLINE == 1
+
+                        /*  An empty file has no blocks left, so its data can
+                         *  go back inline.
+                         */
+                        if( ( ullSize == 0U ) && RED_S_ISREG( pInode->pInodeBuf->uMode ) )
+                        {
+                            pInode->pInodeBuf->uMode |= INODE_MODE_INLINE;
+                        }
+                    #endif
                 }
             }
 
@@ -465,16 +931,11 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
                 RedInodePutData( pInode );
 
                 #if REDCONF_DIRECT_POINTERS > 0U
-                    while( ulTruncBlock < REDCONF_DIRECT_POINTERS )
+                    if( ulTruncBlock < REDCONF_DIRECT_POINTERS )
                     {
-                        ret = TruncDataBlock( pInode, &pInode->pInodeBuf->aulEntries[ ulTruncBlock ], true );
+                        ret = TruncDataBlocks( pInode, &pInode->pInodeBuf->aulEntries[ ulTruncBlock ], REDCONF_DIRECT_POINTERS - ulTruncBlock, true );
 
-                        if( ret != 0 )
-                        {
-                            break;
-                        }
-
-                        ulTruncBlock++;
+                        ulTruncBlock = REDCONF_DIRECT_POINTERS;
                     }
                 #endif /* if REDCONF_DIRECT_POINTERS > 0U */
 
@@ -729,15 +1190,7 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
 
                     if( ret == 0 )
                     {
-                        for( uEntry = pInode->uIndirEntry; uEntry < INDIR_ENTRIES; uEntry++ )
-                        {
-                            ret = TruncDataBlock( pInode, &pInode->pIndir->aulEntries[ uEntry ], fBranch );
-
-                            if( ret != 0 )
-                            {
-                                break;
-                            }
-                        }
+                        ret = TruncDataBlocks( pInode, &pInode->pIndir->aulEntries[ pInode->uIndirEntry ], INDIR_ENTRIES - pInode->uIndirEntry, fBranch );
 
                         if( ret == 0 )
                         {
@@ -758,12 +1211,18 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
         #endif /* REDCONF_DIRECT_POINTERS < INODE_ENTRIES */
 
 
-/** @brief Truncate a file data block.
+/** @brief Truncate a range of file data block pointers.
+ *
+ *  Runs of pointers to contiguous blocks, which are common in files written
+ *  sequentially, are freed with one call to RedImapBlockRangeFree() rather
+ *  than block by block.
  *
  *  @param pInode       A pointer to the cached inode structure.
- *  @param pulBlock     On entry, contains the block to be truncated.  On
- *                      successful return, if @p fPropagate is true, populated
- *                      with BLOCK_SPARSE, otherwise unmodified.
+ *  @param pulBlocks    On entry, contains the blocks to be truncated, any of
+ *                      which may be BLOCK_SPARSE.  On successful return, if
+ *                      @p fPropagate is true, every entry is populated with
+ *                      BLOCK_SPARSE, otherwise they are unmodified.
+ *  @param ulBlockCount The number of entries in @p pulBlocks.
  *  @param fPropagate   Whether the parent node is being branched.
  *
  *  @return A negated ::REDSTATUS code indicating the operation result.
@@ -772,46 +1231,71 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
  *  @retval -RED_EIO    A disk I/O error occurred.
  *  @retval -RED_EINVAL Invalid parameters.
  */
-        static REDSTATUS TruncDataBlock( const CINODE * pInode,
-                                         uint32_t * pulBlock,
-                                         bool fPropagate )
+        static REDSTATUS TruncDataBlocks( const CINODE * pInode,
+                                          uint32_t * pulBlocks,
+                                          uint32_t ulBlockCount,
+                                          bool fPropagate )
         {
             REDSTATUS ret = 0;
 
-            if( !CINODE_IS_MOUNTED( pInode ) || ( pulBlock == NULL ) )
+            if( !CINODE_IS_MOUNTED( pInode ) || ( pulBlocks == NULL ) )
             {
                 REDERROR();
                 ret = -RED_EINVAL;
             }
-            else if( *pulBlock != BLOCK_SPARSE )
+            else
             {
-                ret = RedImapBlockSet( *pulBlock, false );
+                uint32_t ulIdx = 0U;
 
-                #if REDCONF_INODE_BLOCKS == 1
-                    if( ret == 0 )
+                while( ( ret == 0 ) && ( ulIdx < ulBlockCount ) )
+                {
+                    uint32_t ulRunCount = 1U;
+
+                    if( pulBlocks[ ulIdx ] == BLOCK_SPARSE )
+                    {
+                        /*  Data block is sparse, nothing to truncate.
+                         */
+                    }
+                    else
                     {
-                        if( pInode->pInodeBuf->ulBlocks == 0U )
+                        while( ( ( ulIdx + ulRunCount ) < ulBlockCount ) &&
+                               ( pulBlocks[ ulIdx + ulRunCount ] != BLOCK_SPARSE ) &&
+                               ( pulBlocks[ ulIdx + ulRunCount ] == ( pulBlocks[ ulIdx ] + ulRunCount ) ) )
                         {
-                            CRITICAL_ERROR();
-                            ret = -RED_EFUBAR;
+                            ulRunCount++;
                         }
-                        else
+
+                        ret = RedImapBlockRangeFree( pulBlocks[ ulIdx ], ulRunCount );
+
+                        #if REDCONF_INODE_BLOCKS == 1
+                            if( ret == 0 )
+                            {
+                                if( pInode->pInodeBuf->ulBlocks < ulRunCount )
+                                {
+                                    CRITICAL_ERROR();
+                                    ret = -RED_EFUBAR;
+                                }
+                                else
+                                {
+                                    pInode->pInodeBuf->ulBlocks -= ulRunCount;
+                                }
+                            }
+                        #endif /* if REDCONF_INODE_BLOCKS == 1 */
+
+                        if( ( ret == 0 ) && fPropagate )
                         {
-                            pInode->pInodeBuf->ulBlocks--;
+                            uint32_t ulRunIdx;
+
+                            for( ulRunIdx = 0U; ulRunIdx < ulRunCount; ulRunIdx++ )
+                            {
+                                pulBlocks[ ulIdx + ulRunIdx ] = BLOCK_SPARSE;
+                            }
                         }
                     }
-                #endif /* if REDCONF_INODE_BLOCKS == 1 */
 
-                if( ( ret == 0 ) && fPropagate )
-                {
-                    *pulBlock = BLOCK_SPARSE;
+                    ulIdx += ulRunCount;
                 }
             }
-            else
-            {
-                /*  Data block is sparse, nothing to truncate.
-                 */
-            }
 
             return ret;
         }
@@ -877,6 +1361,40 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
+#if FALLOCATE_SUPPORTED
+
+/** @brief Free the blocks left over in the allocation run of the current
+ *         volume.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+    static REDSTATUS AllocRunRelease( void )
+    {
+        ALLOCRUN * pRun = &gaAllocRun[ gbRedVolNum ];
+        REDSTATUS ret = 0;
+
+        if( pRun->ulCount > 0U )
+        {
+            /*  The blocks of the run were never used, so they are in the new
+             *  state and become free immediately.
+             */
+            ret = RedImapBlockRangeFree( pRun->ulNext, pRun->ulCount );
+            CRITICAL_ASSERT( ret == 0 );
+        }
+
+        /*  Never leave blocks in the run, even after an error: the next
+         *  allocation must not take them.
+         */
+        pRun->ulCount = 0U;
+
+        return ret;
+    }
+#endif /* if FALLOCATE_SUPPORTED */
+
+
 /** @brief Seek to a given position within an inode, then buffer the data block.
  *
  *  On successful return, pInode->pbData will be populated with a buffer
@@ -1287,6 +1805,222 @@ static REDSTATUS ReadAligned( CINODE * pInode,
 }
 
 
+#if REDCONF_READAHEAD_BLOCKS > 0U
+
+/** @brief Retrieve the read-ahead statistics.
+ *
+ *  @param pStats   Populated with the read-ahead statistics.
+ *  @param fReset   Whether to zero the statistics after reading them.
+ */
+    void RedInodeDataReadAheadStats( REDRASTATS * pStats,
+                                     bool fReset )
+    {
+        if( pStats == NULL )
+        {
+            REDERROR();
+        }
+        else
+        {
+            *pStats = gRaStats;
+
+            if( fReset )
+            {
+                RedMemSet( &gRaStats, 0U, sizeof( gRaStats ) );
+            }
+        }
+    }
+
+
+/** @brief Find the read stream for a read and update its state.
+ *
+ *  A read is sequential if it starts where the previous read of the same
+ *  inode ended, or if it is the first read of an inode and starts at the
+ *  beginning of the file.
+ *
+ *  @param ulInode  The inode number being read.
+ *  @param ullStart The file offset at which the read starts.
+ *  @param ulLen    The number of bytes which will be read.
+ *
+ *  @return The read stream, if the read is sequential and small enough to
+ *          benefit from read-ahead; otherwise `NULL`.
+ */
+    static RASTREAM * ReadAheadStream( uint32_t ulInode,
+                                       uint64_t ullStart,
+                                       uint32_t ulLen )
+    {
+        RASTREAM * pStream = NULL;
+        bool fSequential;
+        uint8_t bIdx;
+
+        for( bIdx = 0U; bIdx < REDCONF_READAHEAD_STREAMS; bIdx++ )
+        {
+            if( ( gaRaStream[ bIdx ].ulInode == ulInode ) && ( gaRaStream[ bIdx ].bVolNum == gbRedVolNum ) )
+            {
+                pStream = &gaRaStream[ bIdx ];
+                break;
+            }
+        }
+
+        if( pStream != NULL )
+        {
+            fSequential = ( ullStart == pStream->ullNextOffset );
+        }
+        else
+        {
+            /*  Replace streams in round-robin order.
+             */
+            pStream = &gaRaStream[ gbRaStreamNext ];
+            gbRaStreamNext = ( uint8_t ) ( ( gbRaStreamNext + 1U ) % REDCONF_READAHEAD_STREAMS );
+
+            pStream->ulInode = ulInode;
+            pStream->bVolNum = gbRedVolNum;
+            pStream->ulLastBlock = UINT32_MAX;
+            pStream->ulHitStart = 0U;
+            pStream->ulNext = 0U;
+            fSequential = ( ullStart == 0U );
+        }
+
+        pStream->ullNextOffset = ullStart + ulLen;
+
+        if( !fSequential )
+        {
+            pStream->ulLastBlock = UINT32_MAX;
+            pStream = NULL;
+        }
+        else
+        {
+            gRaStats.ulSeqReads++;
+
+            /*  Large reads already go to disk a whole extent at a time, which
+             *  read-ahead cannot improve upon.
+             */
+            if( ulLen >= ( REDCONF_READAHEAD_BLOCKS << BLOCK_SIZE_P2 ) )
+            {
+                pStream = NULL;
+            }
+        }
+
+        return pStream;
+    }
+
+
+/** @brief Read ahead, if needed, before reading a block of a sequential stream.
+ *
+ *  If the block was read ahead by an earlier request, the read-ahead was a
+ *  hit.  Otherwise, read the block and as many of the blocks after it as are
+ *  contiguous on disk, up to the read-ahead limit, into the buffers.
+ *
+ *  @param pInode   A pointer to the cached inode structure.
+ *  @param pStream  The read stream; may be `NULL`, in which case this
+ *                  function does nothing.
+ *  @param ulBlock  The file block offset about to be read.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+    static REDSTATUS ReadAheadBlock( CINODE * pInode,
+                                     RASTREAM * pStream,
+                                     uint32_t ulBlock )
+    {
+        REDSTATUS ret = 0;
+
+        /*  Partial reads at either end of a request may read the same block
+         *  twice; only consider the first.
+         */
+        if( ( pStream != NULL ) && ( ulBlock != pStream->ulLastBlock ) )
+        {
+            pStream->ulLastBlock = ulBlock;
+
+            if( ( ulBlock >= pStream->ulHitStart ) && ( ulBlock < pStream->ulNext ) )
+            {
+                gRaStats.ulHits++;
+            }
+            else
+            {
+                uint32_t ulLastFileBlock = ( uint32_t ) ( ( pInode->pInodeBuf->ullSize - 1U ) >> BLOCK_SIZE_P2 );
+                uint32_t ulExtentStart;
+                uint32_t ulExtentLen = REDMIN( REDCONF_READAHEAD_BLOCKS, ( ulLastFileBlock - ulBlock ) + 1U );
+
+                pStream->ulHitStart = ulBlock + 1U;
+                pStream->ulNext = ulBlock + 1U;
+
+                if( ulExtentLen > 1U )
+                {
+                    ret = GetExtent( pInode, ulBlock, &ulExtentStart, &ulExtentLen );
+
+                    if( ( ret == 0 ) && ( ulExtentLen > 1U ) )
+                    {
+                        ret = RedBufferReadAhead( ulExtentStart, &ulExtentLen );
+
+                        if( ( ret == 0 ) && ( ulExtentLen > 0U ) )
+                        {
+                            gRaStats.ulRequests++;
+                            gRaStats.ulBlocks += ulExtentLen - 1U;
+                            pStream->ulNext = ulBlock + ulExtentLen;
+                        }
+                    }
+                    else if( ret == -RED_ENODATA )
+                    {
+                        /*  Sparse block, nothing to read ahead.
+                         */
+                        ret = 0;
+                    }
+                    else
+                    {
+                        /*  No action, just return the result.
+                         */
+                    }
+                }
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Read one or more whole blocks through the buffers.
+ *
+ *  @param pInode       A pointer to the cached inode structure.
+ *  @param pStream      The read stream.
+ *  @param ulBlockStart The file block offset at which to read.
+ *  @param ulBlockCount The number of blocks to read.
+ *  @param pbBuffer     The buffer to read into.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EINVAL Invalid parameters.
+ */
+    static REDSTATUS ReadBuffered( CINODE * pInode,
+                                   RASTREAM * pStream,
+                                   uint32_t ulBlockStart,
+                                   uint32_t ulBlockCount,
+                                   uint8_t * pbBuffer )
+    {
+        REDSTATUS ret = 0;
+        uint32_t ulBlockIndex;
+
+        for( ulBlockIndex = 0U; ( ret == 0 ) && ( ulBlockIndex < ulBlockCount ); ulBlockIndex++ )
+        {
+            uint32_t ulBlock = ulBlockStart + ulBlockIndex;
+
+            ret = ReadAheadBlock( pInode, pStream, ulBlock );
+
+            if( ret == 0 )
+            {
+                ret = ReadUnaligned( pInode, ( uint64_t ) ulBlock << BLOCK_SIZE_P2, REDCONF_BLOCK_SIZE, &pbBuffer[ ulBlockIndex << BLOCK_SIZE_P2 ] );
+            }
+        }
+
+        return ret;
+    }
+#endif /* REDCONF_READAHEAD_BLOCKS > 0U */
+
+
 #if REDCONF_READ_ONLY == 0
 
 /** @brief Write an unaligned portion of a block.
@@ -1541,6 +2275,17 @@ static REDSTATUS GetExtent( CINODE * pInode,
 
         ret = BranchBlockCost( pInode, depth, &ulCost );
 
+        #if FALLOCATE_SUPPORTED
+            /*  A new file data block taken from the allocation run has already
+             *  been allocated.
+             */
+            if( ( ret == 0 ) && ( depth == BRANCHDEPTH_FILE_DATA ) && ( pInode->ulDataBlock == BLOCK_SPARSE ) && ( gaAllocRun[ gbRedVolNum ].ulCount > 0U ) )
+            {
+                REDASSERT( ulCost > 0U );
+                ulCost--;
+            }
+        #endif
+
         if( ( ret == 0 ) && ( ulCost > FreeBlockCount() ) )
         {
             ret = -RED_ENOSPC;
@@ -1713,7 +2458,20 @@ static REDSTATUS GetExtent( CINODE * pInode,
                     /*  Block does not exist or is committed state, so allocate a
                      *  new block for the branch.
                      */
-                    ret = RedImapAllocBlock( pulBlock );
+                    #if FALLOCATE_SUPPORTED
+                        ALLOCRUN * pRun = &gaAllocRun[ gbRedVolNum ];
+
+                        if( ( uBFlag == 0U ) && ( pRun->ulCount > 0U ) )
+                        {
+                            *pulBlock = pRun->ulNext;
+                            pRun->ulNext++;
+                            pRun->ulCount--;
+                        }
+                        else
+                    #endif
+                    {
+                        ret = RedImapAllocBlock( pulBlock );
+                    }
 
                     if( ret == 0 )
                     {
@@ -1750,6 +2508,13 @@ static REDSTATUS GetExtent( CINODE * pInode,
                                     ret = RedBufferGet( ulPrevBlock, uBFlag, ppBuffer );
                                 }
 
+                                #if REDCONF_BDEV_RAM_ALIAS == 1
+                                    if( ( ret == 0 ) && ( uBFlag == 0U ) && ( gpRedVolume->pbAliased != NULL ) )
+                                    {
+                                        RedBufferAliasBranch( ppBuffer, *pulBlock );
+                                    }
+                                    else
+                                #endif
                                 if( ret == 0 )
                                 {
                                     RedBufferBranch( *ppBuffer, *pulBlock );
@@ -1933,4 +2698,81 @@ static REDSTATUS GetExtent( CINODE * pInode,
 
         return ulFreeBlocks;
     }
+
+
+    #if REDCONF_INODE_INLINE == 1
+
+/** @brief Move the data of an inline inode into a data block.
+ *
+ *  Afterward, the file data is stored in the usual way, in file block zero,
+ *  and the inode is no longer inline.
+ *
+ *  @param pInode   A pointer to the cached inode structure of an inline inode.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL Invalid parameters.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOSPC Insufficient free space for the data block.
+ */
+        static REDSTATUS InlineEvict( CINODE * pInode )
+        {
+            REDSTATUS ret = 0;
+
+            if( !CINODE_IS_DIRTY( pInode ) || !INODE_IS_INLINE( pInode ) )
+            {
+                REDERROR();
+                ret = -RED_EINVAL;
+            }
+            else if( pInode->pInodeBuf->ullSize == 0U )
+            {
+                /*  No data, so all the block pointers are already sparse.
+                 */
+                pInode->pInodeBuf->uMode &= ( uint16_t ) ~INODE_MODE_INLINE;
+            }
+            else if( FreeBlockCount() == 0U )
+            {
+                ret = -RED_ENOSPC;
+            }
+            else
+            {
+                uint8_t * pbInline = INODE_INLINE_DATA( pInode );
+                uint32_t ulLen = ( uint32_t ) pInode->pInodeBuf->ullSize;
+                uint32_t ulFirst = pInode->pInodeBuf->aulEntries[ 0U ];
+                uint8_t * pbData = NULL;
+
+                /*  The first direct pointer overlaps the first bytes of the
+                 *  inline data, which are saved in ulFirst meanwhile.
+                 */
+                RedInodePutCoord( pInode );
+                pInode->pInodeBuf->aulEntries[ 0U ] = BLOCK_SPARSE;
+
+                ret = BranchOneBlock( &pInode->pInodeBuf->aulEntries[ 0U ], CAST_VOID_PTR_PTR( &pbData ), 0U );
+
+                if( ret == 0 )
+                {
+                    uint32_t ulBlock = pInode->pInodeBuf->aulEntries[ 0U ];
+
+                    pInode->pInodeBuf->aulEntries[ 0U ] = ulFirst;
+                    RedMemCpy( pbData, pbInline, ulLen );
+                    RedBufferPut( pbData );
+
+                    RedMemSet( pbInline, 0U, INODE_INLINE_MAX );
+                    pInode->pInodeBuf->aulEntries[ 0U ] = ulBlock;
+                    pInode->pInodeBuf->uMode &= ( uint16_t ) ~INODE_MODE_INLINE;
+
+                    #if REDCONF_INODE_BLOCKS == 1
+                        pInode->pInodeBuf->ulBlocks = 1U;
+                    #endif
+                }
+                else
+                {
+                    pInode->pInodeBuf->aulEntries[ 0U ] = ulFirst;
+                }
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_INODE_INLINE == 1 */
 #endif /* REDCONF_READ_ONLY == 0 */
@@ -0,0 +1,813 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements the intent log.
+ *
+ *  The intent log lets red_fsync() make the recent changes of a file durable
+ *  without a transaction point.  Writes and truncates of the files being
+ *  tracked are appended, as records, to a RAM copy of the log; red_fsync() of
+ *  a tracked file appends a sync record for it and flushes the log, writing
+ *  only the sectors which changed since the last flush.  Each sector is
+ *  stamped with the sequence number of the committed metaroot: mount replays
+ *  the records of the sectors which match, in order, on top of the committed
+ *  state, and the next transaction point, which changes that sequence number,
+ *  retires them.
+ *
+ *  A flush writes the records of every file, but mount replays a record only
+ *  if a later sync record of the same file covers it.  Each file therefore
+ *  comes back as it was at its own last red_fsync(): the changes of other files
+ *  which were written to the log but not synced are ignored.  A sync record
+ *  covers only the sectors written since the log was last loaded or reset, so
+ *  the records which a mount did not replay are never replayed later.
+ *
+ *  A file is tracked from its first change after a transaction point, so that
+ *  every later change of it is in the log, until a change cannot be logged
+ *  (the log is full, an operation other than a write or truncate, or an error
+ *  part way through).  Only durability is affected: red_fsync() of a file which
+ *  is not tracked commits a transaction point, as without the log.
+ *
+ *  Unless the block device writes sectors atomically, a sector which has been
+ *  flushed is never written again until the next transaction point, so that
+ *  power loss during a flush cannot damage records which are already durable.
+ */
+#include <redfs.h>
+#include <redcore.h>
+
+#if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+
+/*  The number of sectors in the intent log of the current volume.
+ */
+#define INTENT_SECTORS    ( ( uint32_t ) REDCONF_INTENT_LOG_BLOCKS << gpRedVolume->bBlockSectorShift )
+
+
+static uint8_t * IntentSector( uint32_t ulSector );
+static uint32_t IntentFileFind( uint32_t ulInode );
+static bool IntentAppend( uint32_t ulInode,
+                          uint16_t uType,
+                          uint64_t ullOffset,
+                          uint32_t ulLen,
+                          const uint8_t * pbData );
+static void IntentSeal( uint32_t ulSector,
+                        uint64_t ullSequence );
+static bool IntentSectorIsValid( uint32_t ulSector,
+                                 uint64_t * pullSequence );
+static bool IntentRecordRead( uint32_t ulSector,
+                              uint32_t ulOffset,
+                              INTENTRECORD * pRecord );
+static bool IntentRecordIsSynced( const INTENTRECORD * pRecord,
+                                  uint32_t ulSector,
+                                  uint32_t ulOffset );
+static REDSTATUS IntentReplaySector( uint32_t ulSector );
+static REDSTATUS IntentApply( const INTENTRECORD * pRecord,
+                              const uint8_t * pbData );
+#ifdef REDCONF_ENDIAN_SWAP
+    static void IntentSectorEndianSwap( INTENTSECTOR * pSector );
+    static void IntentRecordEndianSwap( INTENTRECORD * pRecord );
+#endif
+
+
+/** @brief Load the intent log of a volume being mounted, and replay it.
+ *
+ *  Called after the metaroot is mounted.  The records found which are covered
+ *  by a sync record of their file are applied to the working state, in which
+ *  each file then matches its state at its last red_fsync(); the log is left
+ *  on disk, so that power loss before the next transaction point replays it
+ *  again.  Records are appended after it from a new sector on.
+ *
+ *  If a record cannot be applied, which can only happen if the log is
+ *  corrupt, the volume is mounted without the log, and the log is erased.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+REDSTATUS RedIntentLoad( void )
+{
+    REDSTATUS ret;
+
+    RedIntentReset();
+
+    ret = RedIoRead( gbRedVolNum, gpRedCoreVol->ulIntentLogStartBN, REDCONF_INTENT_LOG_BLOCKS, gpRedCoreVol->aulIntentLog );
+
+    if( ret == 0 )
+    {
+        uint64_t ullSequence = 0U;
+        uint32_t ulSectors = 0U;
+        uint32_t ulSector;
+
+        /*  Whether a record is replayed depends on the sync records after it,
+         *  so find the end of the log first.
+         */
+        while( ( ulSectors < INTENT_SECTORS ) && IntentSectorIsValid( ulSectors, &ullSequence ) )
+        {
+            ulSectors++;
+        }
+
+        gpRedCoreVol->ulIntentSectors = ulSectors;
+
+        for( ulSector = 0U; ( ret == 0 ) && ( ulSector < ulSectors ); ulSector++ )
+        {
+            ret = IntentReplaySector( ulSector );
+        }
+
+        if( ret == 0 )
+        {
+            /*  Start a new sector, so that the sync records written from now
+             *  on cover none of the records which were not replayed.
+             */
+            gpRedCoreVol->ulIntentOffset = gpRedVolConf->ulSectorSize;
+            gpRedCoreVol->ulIntentDurable = ulSectors;
+            gpRedCoreVol->ulIntentFirst = ulSectors;
+
+            /*  The sectors flushed from now on must have higher sequence
+             *  numbers than those already in the log, which may be higher
+             *  than the one the metaroot left, or the next mount would take
+             *  them for stale sectors.
+             */
+            if( ullSequence >= gpRedVolume->ullSequence )
+            {
+                gpRedVolume->ullSequence = ullSequence + 1U;
+            }
+        }
+        else if( ret != -RED_EIO )
+        {
+            /*  Go back to the committed state, as it was before the replay.
+             */
+            ret = RedBufferDiscardRange( 0U, gpRedVolume->ulBlockCount );
+
+            if( ret == 0 )
+            {
+                ret = RedVolMountMetaroot();
+            }
+
+            if( ret == 0 )
+            {
+                ret = RedIntentErase();
+            }
+        }
+        else
+        {
+            /*  I/O error: the mount fails.
+             */
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Erase the intent log on disk and empty it in RAM.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+REDSTATUS RedIntentErase( void )
+{
+    REDSTATUS ret;
+
+    RedIntentReset();
+    RedMemSet( gpRedCoreVol->aulIntentLog, 0U, sizeof( gpRedCoreVol->aulIntentLog ) );
+
+    ret = RedIoWrite( gbRedVolNum, gpRedCoreVol->ulIntentLogStartBN, REDCONF_INTENT_LOG_BLOCKS, gpRedCoreVol->aulIntentLog );
+
+    if( ret == 0 )
+    {
+        ret = RedIoFlush( gbRedVolNum );
+    }
+
+    return ret;
+}
+
+
+/** @brief Empty the intent log and stop tracking all files.
+ *
+ *  Called when a transaction point has made every logged change part of the
+ *  committed state.  The log on disk is left alone: its sectors no longer
+ *  match the committed metaroot, so mount ignores them.
+ */
+void RedIntentReset( void )
+{
+    uint32_t ulIdx;
+
+    gpRedCoreVol->ulIntentSectors = 0U;
+    gpRedCoreVol->ulIntentOffset = 0U;
+    gpRedCoreVol->ulIntentDurable = 0U;
+    gpRedCoreVol->ulIntentFirst = 0U;
+
+    for( ulIdx = 0U; ulIdx < INTENT_LOG_FILES; ulIdx++ )
+    {
+        gpRedCoreVol->aulIntentInodes[ ulIdx ] = INODE_INVALID;
+        gpRedCoreVol->afIntentUnsynced[ ulIdx ] = false;
+    }
+}
+
+
+/** @brief Record a change to a file which has just been made.
+ *
+ *  Nothing is recorded for a file which is not tracked, unless this is its
+ *  first change since the last transaction point and a tracking entry is free.
+ *  If the change does not fit in the log, the file stops being tracked.
+ *
+ *  @param ulInode      The inode number of the file.
+ *  @param fChanged     Whether the file had already changed since the last
+ *                      transaction point, before this change.
+ *  @param uType        #INTENT_WRITE or #INTENT_TRUNCATE.
+ *  @param ullOffset    The file offset written, or the new file size.
+ *  @param ulLen        The number of bytes written; zero for a truncate.
+ *  @param pData        The data written; `NULL` for a truncate.
+ */
+void RedIntentRecord( uint32_t ulInode,
+                      bool fChanged,
+                      uint16_t uType,
+                      uint64_t ullOffset,
+                      uint32_t ulLen,
+                      const void * pData )
+{
+    uint32_t ulIdx = IntentFileFind( ulInode );
+
+    if( ( ulIdx == INTENT_LOG_FILES ) && !fChanged )
+    {
+        ulIdx = IntentFileFind( INODE_INVALID );
+
+        if( ulIdx < INTENT_LOG_FILES )
+        {
+            gpRedCoreVol->aulIntentInodes[ ulIdx ] = ulInode;
+        }
+    }
+
+    if( ulIdx < INTENT_LOG_FILES )
+    {
+        if( IntentAppend( ulInode, uType, ullOffset, ulLen, CAST_VOID_PTR_TO_CONST_UINT8_PTR( pData ) ) )
+        {
+            gpRedCoreVol->afIntentUnsynced[ ulIdx ] = true;
+        }
+        else
+        {
+            gpRedCoreVol->aulIntentInodes[ ulIdx ] = INODE_INVALID;
+        }
+    }
+}
+
+
+/** @brief Stop tracking a file, after a change which cannot be logged.
+ *
+ *  Records already logged for the file are kept, but only those covered by a
+ *  sync record of the file are replayed, which yields the file as it was at
+ *  its last red_fsync() through the log.  No sync record is written for the
+ *  file after this, so none of its later records are replayed.
+ *
+ *  @param ulInode  The inode number of the file.
+ */
+void RedIntentDrop( uint32_t ulInode )
+{
+    uint32_t ulIdx = IntentFileFind( ulInode );
+
+    if( ulIdx < INTENT_LOG_FILES )
+    {
+        gpRedCoreVol->aulIntentInodes[ ulIdx ] = INODE_INVALID;
+    }
+}
+
+
+/** @brief Mark the logged changes of a file as synced, so that flushing the
+ *         intent log makes the file durable.
+ *
+ *  A sync record for the file is appended, unless there have been no records
+ *  of it since its last one.  Nothing is appended for a file which is not
+ *  tracked.
+ *
+ *  @param ulInode  The inode number of the file.
+ *
+ *  @return Whether flushing the log makes the file durable: false if some
+ *          change to the file since the last transaction point is not in the
+ *          log, or if the log has no room for the sync record.
+ */
+bool RedIntentSync( uint32_t ulInode )
+{
+    uint32_t ulIdx = ( ulInode == INODE_INVALID ) ? INTENT_LOG_FILES : IntentFileFind( ulInode );
+    bool fSynced = ( ulIdx < INTENT_LOG_FILES );
+
+    if( fSynced && gpRedCoreVol->afIntentUnsynced[ ulIdx ] )
+    {
+        fSynced = IntentAppend( ulInode, INTENT_SYNC, gpRedCoreVol->ulIntentFirst, 0U, NULL );
+
+        if( fSynced )
+        {
+            gpRedCoreVol->afIntentUnsynced[ ulIdx ] = false;
+        }
+    }
+
+    return fSynced;
+}
+
+
+/** @brief Write the sectors of the intent log which changed since the last
+ *         flush.
+ *
+ *  The records of every file are written, but mount ignores those which no
+ *  sync record written by RedIntentSync() covers.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+REDSTATUS RedIntentFlush( void )
+{
+    REDSTATUS ret = 0;
+    uint32_t ulFirst = gpRedCoreVol->ulIntentDurable;
+    uint32_t ulCount = gpRedCoreVol->ulIntentSectors - ulFirst;
+
+    if( ulCount > 0U )
+    {
+        uint64_t ullSequence = gpRedVolume->ullSequence;
+
+        ret = RedVolSeqNumIncrement( gbRedVolNum );
+
+        if( ret == 0 )
+        {
+            uint32_t ulSector;
+
+            for( ulSector = ulFirst; ulSector < gpRedCoreVol->ulIntentSectors; ulSector++ )
+            {
+                IntentSeal( ulSector, ullSequence );
+            }
+
+            ret = RedIoSectorWrite( gbRedVolNum,
+                                    ( ( uint64_t ) gpRedCoreVol->ulIntentLogStartBN << gpRedVolume->bBlockSectorShift ) + ulFirst,
+                                    ulCount, IntentSector( ulFirst ) );
+        }
+
+        if( ret == 0 )
+        {
+            ret = RedIoFlush( gbRedVolNum );
+        }
+
+        if( ret == 0 )
+        {
+            gpRedCoreVol->ulIntentDurable = gpRedCoreVol->ulIntentSectors;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Get the RAM copy of a sector of the intent log.
+ *
+ *  @param ulSector The sector index within the log.
+ *
+ *  @return Pointer to the start of the sector.
+ */
+static uint8_t * IntentSector( uint32_t ulSector )
+{
+    REDASSERT( ulSector < INTENT_SECTORS );
+
+    return &CAST_VOID_PTR_TO_UINT8_PTR( gpRedCoreVol->aulIntentLog )[ ulSector * gpRedVolConf->ulSectorSize ];
+}
+
+
+/** @brief Find the tracking entry of a file.
+ *
+ *  @param ulInode  The inode number to look for; #INODE_INVALID finds an unused
+ *                  entry.
+ *
+ *  @return The index of the entry, or #INTENT_LOG_FILES if there is none.
+ */
+static uint32_t IntentFileFind( uint32_t ulInode )
+{
+    uint32_t ulIdx;
+
+    for( ulIdx = 0U; ulIdx < INTENT_LOG_FILES; ulIdx++ )
+    {
+        if( gpRedCoreVol->aulIntentInodes[ ulIdx ] == ulInode )
+        {
+            break;
+        }
+    }
+
+    return ulIdx;
+}
+
+
+/** @brief Append a change to the RAM copy of the intent log.
+ *
+ *  A write which does not fit in the rest of the current sector is split
+ *  into records for consecutive ranges.  Either the whole change is appended
+ *  or, if the log is too full, none of it.
+ *
+ *  @param ulInode      The inode number of the file.
+ *  @param uType        #INTENT_WRITE or #INTENT_TRUNCATE.
+ *  @param ullOffset    The file offset written, or the new file size.
+ *  @param ulLen        The number of bytes written.
+ *  @param pbData       The data written.
+ *
+ *  @return Whether the change was appended.
+ */
+static bool IntentAppend( uint32_t ulInode,
+                          uint16_t uType,
+                          uint64_t ullOffset,
+                          uint32_t ulLen,
+                          const uint8_t * pbData )
+{
+    uint32_t ulSectorSize = gpRedVolConf->ulSectorSize;
+    uint32_t ulSectors = gpRedCoreVol->ulIntentSectors;
+    uint32_t ulOffset = gpRedCoreVol->ulIntentOffset;
+    uint32_t ulDurable = gpRedCoreVol->ulIntentDurable;
+    uint32_t ulDone = 0U;
+    bool fFits = true;
+
+    do
+    {
+        /*  A record needs room for at least one byte of data.  A sector which
+         *  has been flushed is only added to if rewriting it cannot tear the
+         *  records it already holds.
+         */
+        if( ( ulSectors == 0U ) ||
+            ( ( ulSectorSize - ulOffset ) <= INTENTRECORD_SIZE ) ||
+            ( ( ulDurable == ulSectors ) && !gpRedVolConf->fAtomicSectorWrite ) )
+        {
+            if( ulSectors == INTENT_SECTORS )
+            {
+                fFits = false;
+            }
+            else
+            {
+                /*  Unused space reads as #INTENT_NONE, which ends the sector.
+                 */
+                RedMemSet( IntentSector( ulSectors ), 0U, ulSectorSize );
+                ulSectors++;
+                ulOffset = INTENTSECTOR_HEADER_SIZE;
+            }
+        }
+
+        if( fFits )
+        {
+            uint8_t * pbSector = IntentSector( ulSectors - 1U );
+            uint32_t ulChunk = REDMIN( ulLen - ulDone, ulSectorSize - ulOffset - INTENTRECORD_SIZE );
+            INTENTRECORD record;
+
+            record.ullOffset = ullOffset + ulDone;
+            record.ulInode = ulInode;
+            record.uType = uType;
+            record.uLen = ( uint16_t ) ulChunk;
+
+            #ifdef REDCONF_ENDIAN_SWAP
+                IntentRecordEndianSwap( &record );
+            #endif
+
+            RedMemCpy( &pbSector[ ulOffset ], &record, INTENTRECORD_SIZE );
+
+            if( ulChunk > 0U )
+            {
+                RedMemCpy( &pbSector[ ulOffset + INTENTRECORD_SIZE ], &pbData[ ulDone ], ulChunk );
+            }
+
+            ulOffset += INTENTRECORD_SIZE + ulChunk;
+            ulDone += ulChunk;
+
+            if( ulDurable == ulSectors )
+            {
+                ulDurable--;
+            }
+        }
+    } while( fFits && ( ulDone < ulLen ) );
+
+    if( fFits )
+    {
+        gpRedCoreVol->ulIntentSectors = ulSectors;
+        gpRedCoreVol->ulIntentOffset = ulOffset;
+        gpRedCoreVol->ulIntentDurable = ulDurable;
+    }
+    else if( gpRedCoreVol->ulIntentSectors > 0U )
+    {
+        /*  Clear anything added to the last sector, so that it matches the
+         *  log on disk again if it had been flushed.
+         */
+        uint32_t ulOldOffset = gpRedCoreVol->ulIntentOffset;
+
+        RedMemSet( &IntentSector( gpRedCoreVol->ulIntentSectors - 1U )[ ulOldOffset ], 0U, ulSectorSize - ulOldOffset );
+    }
+    else
+    {
+        /*  The log was empty; there is nothing to clear.
+         */
+    }
+
+    return fFits;
+}
+
+
+/** @brief Fill in the header and CRC of a sector of the intent log, before it
+ *         is written.
+ *
+ *  @param ulSector     The sector index within the log.
+ *  @param ullSequence  The sequence number of this flush.
+ */
+static void IntentSeal( uint32_t ulSector,
+                        uint64_t ullSequence )
+{
+    uint8_t * pbSector = IntentSector( ulSector );
+    INTENTSECTOR hdr;
+    uint32_t ulCRC;
+
+    RedMemSet( &hdr, 0U, sizeof( hdr ) );
+    hdr.hdr.ulSignature = META_SIG_INTENT;
+    hdr.hdr.ullSequence = ullSequence;
+    hdr.ullCommitSeq = gpRedCoreVol->aMR[ 1U - gpRedCoreVol->bCurMR ].hdr.ullSequence;
+    hdr.ulIndex = ulSector;
+
+    #ifdef REDCONF_ENDIAN_SWAP
+        IntentSectorEndianSwap( &hdr );
+    #endif
+
+    RedMemCpy( pbSector, &hdr, INTENTSECTOR_HEADER_SIZE );
+
+    ulCRC = RedCrc32Update( 0U, &pbSector[ NODEHEADER_OFFSET_SEQ ], gpRedVolConf->ulSectorSize - NODEHEADER_OFFSET_SEQ );
+
+    #ifdef REDCONF_ENDIAN_SWAP
+        ulCRC = RedRev32( ulCRC );
+    #endif
+
+    RedMemCpy( &pbSector[ NODEHEADER_OFFSET_CRC ], &ulCRC, sizeof( ulCRC ) );
+}
+
+
+/** @brief Determine whether a sector of the intent log, as read at mount,
+ *         belongs to the current log.
+ *
+ *  @param ulSector     The sector index within the log.
+ *  @param pullSequence On entry, the sequence number of the previous sector
+ *                      (zero for the first); on a true return, the sequence
+ *                      number of this sector.  Sectors of one log are flushed
+ *                      in order, so a lower number marks a stale sector which
+ *                      an interrupted flush left behind.
+ *
+ *  @return Whether the sector is valid.
+ */
+static bool IntentSectorIsValid( uint32_t ulSector,
+                                 uint64_t * pullSequence )
+{
+    const uint8_t * pbSector = IntentSector( ulSector );
+    INTENTSECTOR hdr;
+    bool fValid;
+
+    RedMemCpy( &hdr, pbSector, INTENTSECTOR_HEADER_SIZE );
+
+    #ifdef REDCONF_ENDIAN_SWAP
+        IntentSectorEndianSwap( &hdr );
+    #endif
+
+    if( ( hdr.hdr.ulSignature != META_SIG_INTENT ) ||
+        ( hdr.ullCommitSeq != gpRedCoreVol->aMR[ 1U - gpRedCoreVol->bCurMR ].hdr.ullSequence ) ||
+        ( hdr.ulIndex != ulSector ) ||
+        ( hdr.hdr.ullSequence < *pullSequence ) )
+    {
+        fValid = false;
+    }
+    else
+    {
+        uint32_t ulCRC = RedCrc32Update( 0U, &pbSector[ NODEHEADER_OFFSET_SEQ ], gpRedVolConf->ulSectorSize - NODEHEADER_OFFSET_SEQ );
+
+        fValid = ( ulCRC == hdr.hdr.ulCRC );
+
+        if( fValid )
+        {
+            *pullSequence = hdr.hdr.ullSequence;
+        }
+    }
+
+    return fValid;
+}
+
+
+/** @brief Read a record of the intent log.
+ *
+ *  @param ulSector The sector index within the log.
+ *  @param ulOffset The offset of the record within the sector.
+ *  @param pRecord  Populated with the record.
+ *
+ *  @return Whether there is a record at @p ulOffset; false at the end of the
+ *          records of the sector.
+ */
+static bool IntentRecordRead( uint32_t ulSector,
+                              uint32_t ulOffset,
+                              INTENTRECORD * pRecord )
+{
+    bool fFound = false;
+
+    if( ( gpRedVolConf->ulSectorSize - ulOffset ) >= INTENTRECORD_SIZE )
+    {
+        RedMemCpy( pRecord, &IntentSector( ulSector )[ ulOffset ], INTENTRECORD_SIZE );
+
+        #ifdef REDCONF_ENDIAN_SWAP
+            IntentRecordEndianSwap( pRecord );
+        #endif
+
+        fFound = ( pRecord->uType != INTENT_NONE );
+    }
+
+    return fFound;
+}
+
+
+/** @brief Determine whether a record of the intent log is covered by a later
+ *         sync record of its file.
+ *
+ *  @param pRecord  The record.
+ *  @param ulSector The sector index of the record within the log.
+ *  @param ulOffset The offset just past the record and its data.
+ *
+ *  @return Whether the record is to be replayed.
+ */
+static bool IntentRecordIsSynced( const INTENTRECORD * pRecord,
+                                  uint32_t ulSector,
+                                  uint32_t ulOffset )
+{
+    uint32_t ulSectorSize = gpRedVolConf->ulSectorSize;
+    uint32_t ulSyncSector = ulSector;
+    uint32_t ulSyncOffset = ulOffset;
+    bool fSynced = false;
+
+    while( !fSynced && ( ulSyncSector < gpRedCoreVol->ulIntentSectors ) )
+    {
+        INTENTRECORD sync;
+
+        if( IntentRecordRead( ulSyncSector, ulSyncOffset, &sync ) &&
+            ( sync.uLen <= ( ulSectorSize - ulSyncOffset - INTENTRECORD_SIZE ) ) )
+        {
+            fSynced = ( sync.uType == INTENT_SYNC ) && ( sync.ulInode == pRecord->ulInode ) && ( sync.ullOffset <= ulSector );
+            ulSyncOffset += INTENTRECORD_SIZE + sync.uLen;
+        }
+        else
+        {
+            /*  End of the sector, or a malformed record, which the replay
+             *  reports when it gets there.
+             */
+            ulSyncSector++;
+            ulSyncOffset = INTENTSECTOR_HEADER_SIZE;
+        }
+    }
+
+    return fSynced;
+}
+
+
+/** @brief Apply the records of one sector of the intent log which are covered
+ *         by a sync record.
+ *
+ *  @param ulSector     The sector index within the log.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EFUBAR A record is malformed or cannot be applied.
+ */
+static REDSTATUS IntentReplaySector( uint32_t ulSector )
+{
+    const uint8_t * pbSector = IntentSector( ulSector );
+    uint32_t ulSectorSize = gpRedVolConf->ulSectorSize;
+    uint32_t ulOffset = INTENTSECTOR_HEADER_SIZE;
+    REDSTATUS ret = 0;
+    INTENTRECORD record;
+
+    while( ( ret == 0 ) && IntentRecordRead( ulSector, ulOffset, &record ) )
+    {
+        if( record.uLen > ( ulSectorSize - ulOffset - INTENTRECORD_SIZE ) )
+        {
+            ret = -RED_EFUBAR;
+        }
+        else
+        {
+            uint32_t ulNext = ulOffset + INTENTRECORD_SIZE + record.uLen;
+
+            if( ( record.uType != INTENT_SYNC ) && IntentRecordIsSynced( &record, ulSector, ulNext ) )
+            {
+                ret = IntentApply( &record, &pbSector[ ulOffset + INTENTRECORD_SIZE ] );
+            }
+
+            ulOffset = ulNext;
+        }
+    }
+
+    return ret;
+}
+
+
+/** @brief Apply one record of the intent log to the working state.
+ *
+ *  @param pRecord  The record.
+ *  @param pbData   The data following the record.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_EFUBAR The record cannot be applied.
+ */
+static REDSTATUS IntentApply( const INTENTRECORD * pRecord,
+                              const uint8_t * pbData )
+{
+    CINODE ino;
+    REDSTATUS ret;
+
+    ino.ulInode = pRecord->ulInode;
+    ret = RedInodeMount( &ino, FTYPE_FILE, true );
+
+    if( ret == 0 )
+    {
+        if( pRecord->uType == INTENT_WRITE )
+        {
+            uint32_t ulLen = pRecord->uLen;
+
+            ret = RedInodeDataWrite( &ino, pRecord->ullOffset, &ulLen, pbData );
+
+            if( ( ret == 0 ) && ( ulLen != pRecord->uLen ) )
+            {
+                ret = -RED_ENOSPC;
+            }
+        }
+
+        #if TRUNCATE_SUPPORTED
+            else if( pRecord->uType == INTENT_TRUNCATE )
+            {
+                #if RESERVED_BLOCKS > 0U
+                    gpRedCoreVol->fUseReservedBlocks = ( pRecord->ullOffset < ino.pInodeBuf->ullSize );
+                #endif
+
+                ret = RedInodeDataTruncate( &ino, pRecord->ullOffset );
+
+                #if RESERVED_BLOCKS > 0U
+                    gpRedCoreVol->fUseReservedBlocks = false;
+                #endif
+            }
+        #endif
+        else
+        {
+            ret = -RED_EFUBAR;
+        }
+
+        RedInodePut( &ino, ( ret == 0 ) ? ( uint8_t ) ( IPUT_UPDATE_MTIME | IPUT_UPDATE_CTIME ) : 0U );
+    }
+
+    /*  Any other failure means the record does not fit the committed state.
+     */
+    if( ( ret != 0 ) && ( ret != -RED_EIO ) )
+    {
+        ret = -RED_EFUBAR;
+    }
+
+    return ret;
+}
+
+
+#ifdef REDCONF_ENDIAN_SWAP
+    static void IntentSectorEndianSwap( INTENTSECTOR * pSector )
+    {
+        pSector->hdr.ulSignature = RedRev32( pSector->hdr.ulSignature );
+        pSector->hdr.ulCRC = RedRev32( pSector->hdr.ulCRC );
+        pSector->hdr.ullSequence = RedRev64( pSector->hdr.ullSequence );
+        pSector->ullCommitSeq = RedRev64( pSector->ullCommitSeq );
+        pSector->ulIndex = RedRev32( pSector->ulIndex );
+    }
+
+
+    static void IntentRecordEndianSwap( INTENTRECORD * pRecord )
+    {
+        pRecord->ullOffset = RedRev64( pRecord->ullOffset );
+        pRecord->ulInode = RedRev32( pRecord->ulInode );
+        pRecord->uType = RedRev16( pRecord->uType );
+        pRecord->uLen = RedRev16( pRecord->uLen );
+    }
+#endif /* ifdef REDCONF_ENDIAN_SWAP */
+
+#endif /* REDCONF_INTENT_LOG_BLOCKS > 0U */
@@ -36,6 +36,14 @@ static bool MetarootIsValid( METAROOT * pMR,
 #ifdef REDCONF_ENDIAN_SWAP
     static void MetaRootEndianSwap( METAROOT * pMetaRoot );
 #endif
+#if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_DISCARDS == 1 )
+    static void DiscardIssue( void );
+#endif
+#if REDCONF_FAST_MOUNT == 1
+    static REDSTATUS MetarootReadHinted( bool * pfFound );
+    static void MetarootHintStore( const METAROOT * pMR,
+                                   uint8_t bMR );
+#endif
 
 
 /** @brief Mount a file system volume.
@@ -57,6 +65,14 @@ REDSTATUS RedVolMount( void )
 
     if( ret == 0 )
     {
+        #if REDCONF_BDEV_XIP == 1
+            gpRedVolume->pbMapped = CAST_VOID_PTR_TO_CONST_UINT8_PTR( RedOsBDevMap( gbRedVolNum ) );
+        #endif
+
+        #if REDCONF_BDEV_RAM_ALIAS == 1
+            gpRedVolume->pbAliased = CAST_VOID_PTR_TO_UINT8_PTR( RedOsBDevAlias( gbRedVolNum ) );
+        #endif
+
         ret = RedVolMountMaster();
 
         if( ret == 0 )
@@ -64,6 +80,13 @@ REDSTATUS RedVolMount( void )
             ret = RedVolMountMetaroot();
         }
 
+        #if REDCONF_INTENT_LOG_BLOCKS > 0U
+            if( ret == 0 )
+            {
+                ret = RedIntentLoad();
+            }
+        #endif
+
         if( ret != 0 )
         {
             /*  If we fail to mount, invalidate the buffers to prevent any
@@ -71,6 +94,14 @@ REDSTATUS RedVolMount( void )
              */
             ( void ) RedBufferDiscardRange( 0U, gpRedVolume->ulBlockCount );
             ( void ) RedOsBDevClose( gbRedVolNum );
+
+            #if REDCONF_BDEV_XIP == 1
+                gpRedVolume->pbMapped = NULL;
+            #endif
+
+            #if REDCONF_BDEV_RAM_ALIAS == 1
+                gpRedVolume->pbAliased = NULL;
+            #endif
         }
     }
 
@@ -110,9 +141,12 @@ REDSTATUS RedVolMountMaster( void )
             ( pMB->uDirectPointers != REDCONF_DIRECT_POINTERS ) ||
             ( pMB->uIndirectPointers != REDCONF_INDIRECT_POINTERS ) ||
             ( pMB->bBlockSizeP2 != BLOCK_SIZE_P2 ) ||
+            ( pMB->ulIntentLogBlocks != REDCONF_INTENT_LOG_BLOCKS ) ||
             ( ( ( pMB->bFlags & MBFLAG_API_POSIX ) != 0U ) != ( REDCONF_API_POSIX == 1 ) ) ||
             ( ( ( pMB->bFlags & MBFLAG_INODE_TIMESTAMPS ) != 0U ) != ( REDCONF_INODE_TIMESTAMPS == 1 ) ) ||
-            ( ( ( pMB->bFlags & MBFLAG_INODE_BLOCKS ) != 0U ) != ( REDCONF_INODE_BLOCKS == 1 ) ) )
+            ( ( ( pMB->bFlags & MBFLAG_INODE_BLOCKS ) != 0U ) != ( REDCONF_INODE_BLOCKS == 1 ) ) ||
+            ( ( ( pMB->bFlags & MBFLAG_INODE_INLINE ) != 0U ) != ( REDCONF_INODE_INLINE == 1 ) ) ||
+            ( ( ( pMB->bFlags & MBFLAG_IMAP_LAZY ) != 0U ) != ( REDCONF_IMAP_LAZY_FORMAT == 1 ) ) )
         {
             ret = -RED_EIO;
         }
@@ -157,11 +191,19 @@ REDSTATUS RedVolMountMaster( void )
  */
 REDSTATUS RedVolMountMetaroot( void )
 {
-    REDSTATUS ret;
+    REDSTATUS ret = 0;
+    bool fFound = false;
 
-    ret = RedIoRead( gbRedVolNum, BLOCK_NUM_FIRST_METAROOT, 1U, &gpRedCoreVol->aMR[ 0U ] );
+    #if REDCONF_FAST_MOUNT == 1
+        ret = MetarootReadHinted( &fFound );
+    #endif
 
-    if( ret == 0 )
+    if( ( ret == 0 ) && !fFound )
+    {
+        ret = RedIoRead( gbRedVolNum, BLOCK_NUM_FIRST_METAROOT, 1U, &gpRedCoreVol->aMR[ 0U ] );
+    }
+
+    if( ( ret == 0 ) && !fFound )
     {
         ret = RedIoRead( gbRedVolNum, BLOCK_NUM_FIRST_METAROOT + 1U, 1U, &gpRedCoreVol->aMR[ 1U ] );
     }
@@ -169,7 +211,7 @@ REDSTATUS RedVolMountMetaroot( void )
     /*  Determine which metaroot is the most recent copy that was written
      *  completely.
      */
-    if( ret == 0 )
+    if( ( ret == 0 ) && !fFound )
     {
         uint8_t bMR = UINT8_MAX;
         bool fSectorCRCIsValid;
@@ -230,6 +272,10 @@ REDSTATUS RedVolMountMetaroot( void )
             {
                 gpRedCoreVol->bCurMR = bMR;
                 gpRedMR = &gpRedCoreVol->aMR[ bMR ];
+
+                #if REDCONF_FAST_MOUNT == 1
+                    MetarootHintStore( gpRedMR, bMR );
+                #endif
             }
         }
     }
@@ -250,7 +296,7 @@ REDSTATUS RedVolMountMetaroot( void )
          *  giving the next node written to disk the same sequence number as the
          *  metaroot, increment it here.
          */
-        ret = RedVolSeqNumIncrement();
+        ret = RedVolSeqNumIncrement( gbRedVolNum );
     }
 
     if( ret == 0 )
@@ -265,15 +311,125 @@ REDSTATUS RedVolMountMetaroot( void )
         #endif
         gpRedCoreVol->ulAlmostFreeBlocks = 0U;
 
+        #if REDCONF_DISCARDS == 1
+            gpRedCoreVol->ulDiscardCount = 0U;
+            gpRedCoreVol->fDiscardUnsupported = false;
+        #endif
+
+        #if REDCONF_TRANSACT_TASK == 1
+            gpRedCoreVol->ulBranchedMs = 0U;
+            gpRedCoreVol->ullBytesWritten = 0U;
+        #endif
+
         gpRedCoreVol->aMR[ 1U - gpRedCoreVol->bCurMR ] = *gpRedMR;
         gpRedCoreVol->bCurMR = 1U - gpRedCoreVol->bCurMR;
         gpRedMR = &gpRedCoreVol->aMR[ gpRedCoreVol->bCurMR ];
+
+        #if ( REDCONF_IMAP_EXTERNAL == 1 ) && ( REDCONF_IMAP_SUMMARY == 1 )
+            RedMemSet( gpRedCoreVol->abImapFull, 0U, sizeof( gpRedCoreVol->abImapFull ) );
+        #endif
+
+        #if REDCONF_INODE_CACHE_ENTRIES > 0U
+            RedInodeCacheReset();
+        #endif
+
+        #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )
+            RedInodeFreeMapReset();
+        #endif
+
+        #if ( REDCONF_API_POSIX == 1 ) && ( REDCONF_DIR_INDEX_DIRS > 0U )
+
+            /*  Directory contents may differ from the last time the volume was
+             *  mounted, e.g. after a rollback.
+             */
+            RedDirIndexDiscard( INODE_INVALID );
+        #endif
     }
 
     return ret;
 }
 
 
+#if REDCONF_FAST_MOUNT == 1
+
+/** @brief Read the metaroot named by the mount hint, if it is still current.
+ *
+ *  Only the hinted metaroot is read.  It is used if it is valid and has the
+ *  sequence number and CRC recorded in the hint; since the hint is stored
+ *  before each metaroot write, the other metaroot cannot be newer.
+ *
+ *  @param pfFound  Populated with whether the hinted metaroot was mounted.  If
+ *                  false, both metaroots must be read as usual.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+    static REDSTATUS MetarootReadHinted( bool * pfFound )
+    {
+        REDSTATUS ret = 0;
+        REDMOUNTHINT hint;
+
+        *pfFound = false;
+
+        if( RedOsMountHintLoad( gbRedVolNum, &hint ) )
+        {
+            METAROOT * pMR = &gpRedCoreVol->aMR[ hint.bMR ];
+
+            ret = RedIoRead( gbRedVolNum, BLOCK_NUM_FIRST_METAROOT + hint.bMR, 1U, pMR );
+
+            if( ret == 0 )
+            {
+                bool fSectorCRCIsValid;
+
+                if( MetarootIsValid( pMR, &fSectorCRCIsValid ) &&
+                    ( pMR->hdr.ullSequence == hint.ullSequence ) &&
+                    ( pMR->hdr.ulCRC == hint.ulCRC ) )
+                {
+                    #ifdef REDCONF_ENDIAN_SWAP
+                        MetaRootEndianSwap( pMR );
+                    #endif
+
+                    gpRedCoreVol->bCurMR = hint.bMR;
+                    gpRedMR = pMR;
+                    *pfFound = true;
+                }
+                else
+                {
+                    /*  The hint is stale, e.g. the last metaroot write was
+                     *  interrupted; forget it and fall back to reading both
+                     *  metaroots.
+                     */
+                    RedOsMountHintStore( gbRedVolNum, NULL );
+                }
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Record a metaroot as the one committed last.
+ *
+ *  @param pMR  The metaroot, with its header as stored on disk.
+ *  @param bMR  Which metaroot (0 or 1) it is stored in.
+ */
+    static void MetarootHintStore( const METAROOT * pMR,
+                                   uint8_t bMR )
+    {
+        REDMOUNTHINT hint;
+
+        hint.ullSequence = pMR->hdr.ullSequence;
+        hint.ulCRC = pMR->hdr.ulCRC;
+        hint.bMR = bMR;
+
+        RedOsMountHintStore( gbRedVolNum, &hint );
+    }
+
+#endif /* REDCONF_FAST_MOUNT == 1 */
+
+
 /** @brief Determine whether the metaroot is valid.
  *
  *  @param pMR                  The metaroot buffer.
@@ -364,6 +520,10 @@ static bool MetarootIsValid( METAROOT * pMR,
 
         if( gpRedCoreVol->fBranched )
         {
+            #if REDCONF_STATS == 1
+                REDTIMESTAMP tsStart = RedOsTimestamp();
+            #endif
+
             gpRedMR->ulFreeBlocks += gpRedCoreVol->ulAlmostFreeBlocks;
             gpRedCoreVol->ulAlmostFreeBlocks = 0U;
 
@@ -374,7 +534,7 @@ static bool MetarootIsValid( METAROOT * pMR,
                 gpRedMR->hdr.ulSignature = META_SIG_METAROOT;
                 gpRedMR->hdr.ullSequence = gpRedVolume->ullSequence;
 
-                ret = RedVolSeqNumIncrement();
+                ret = RedVolSeqNumIncrement( gbRedVolNum );
             }
 
             if( ret == 0 )
@@ -415,6 +575,18 @@ static bool MetarootIsValid( METAROOT * pMR,
                 ret = RedIoFlush( gbRedVolNum );
             }
 
+            #if REDCONF_FAST_MOUNT == 1
+                if( ret == 0 )
+                {
+                    /*  Store the hint before writing the metaroot, so that it
+                     *  never names a metaroot newer than the one on disk.  If
+                     *  the write does not complete, the next mount will not find
+                     *  a match and will read both metaroots.
+                     */
+                    MetarootHintStore( gpRedMR, gpRedCoreVol->bCurMR );
+                }
+            #endif
+
             if( ret == 0 )
             {
                 ret = RedIoWrite( gbRedVolNum, BLOCK_NUM_FIRST_METAROOT + gpRedCoreVol->bCurMR, 1U, gpRedMR );
@@ -445,6 +617,55 @@ static bool MetarootIsValid( METAROOT * pMR,
                 gpRedMR = &gpRedCoreVol->aMR[ gpRedCoreVol->bCurMR ];
 
                 gpRedCoreVol->fBranched = false;
+
+                #if REDCONF_TRANSACT_TASK == 1
+                    gpRedCoreVol->ulBranchedMs = 0U;
+                    gpRedCoreVol->ullBytesWritten = 0U;
+                #endif
+
+                #if ( REDCONF_IMAP_EXTERNAL == 1 ) && ( REDCONF_IMAP_SUMMARY == 1 )
+
+                    /*  Almost free blocks are now free, so imap nodes which were
+                     *  full may not be any longer.
+                     */
+                    RedMemSet( gpRedCoreVol->abImapFull, 0U, sizeof( gpRedCoreVol->abImapFull ) );
+                #endif
+
+                #if REDCONF_INODE_CACHE_ENTRIES > 0U
+                    RedInodeCacheCommit();
+                #endif
+
+                #if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+                    /*  The logged changes are now part of the committed state,
+                     *  and the log on disk no longer matches its sequence number.
+                     */
+                    RedIntentReset();
+                #endif
+
+                #if REDCONF_DISCARDS == 1
+
+                    /*  The blocks freed by this transaction are no longer
+                     *  referenced by the committed state, and cannot have been
+                     *  reallocated yet, so the device may now forget them.
+                     */
+                    DiscardIssue();
+                #endif
+
+                #if REDCONF_STATS == 1
+                    {
+                        REDVOLSTATS * pStats = &gaRedVolStats[ gbRedVolNum ];
+                        uint64_t ullMicrosec = RedOsTimePassed( tsStart );
+
+                        pStats->ulTransactions++;
+                        pStats->ullTransactMicrosec += ullMicrosec;
+
+                        if( ullMicrosec > pStats->ulTransactMaxMicrosec )
+                        {
+                            pStats->ulTransactMaxMicrosec = ( uint32_t ) REDMIN( ullMicrosec, UINT32_MAX );
+                        }
+                    }
+                #endif
             }
 
             CRITICAL_ASSERT( ret == 0 );
@@ -452,6 +673,126 @@ static bool MetarootIsValid( METAROOT * pMR,
 
         return ret;
     }
+
+
+    #if REDCONF_DISCARDS == 1
+
+/** @brief Remember a run of blocks which have become almost free, so that they
+ *         can be discarded once the next transaction point makes them free.
+ *
+ *  Only blocks which are allocated in the committed state belong here: a block
+ *  which was allocated and freed within the working state is free immediately,
+ *  and may be reallocated and written before the transaction point.
+ *
+ *  A run adjacent to a remembered range is merged into it.  If the run fits no
+ *  range and the table is full, it is simply not discarded: discards are hints,
+ *  and missing one costs nothing but a little device efficiency.
+ *
+ *  @param ulBlockStart The first block which is now almost free.
+ *  @param ulBlockCount The number of blocks in the run.
+ */
+        void RedVolDiscardAdd( uint32_t ulBlockStart,
+                               uint32_t ulBlockCount )
+        {
+            if( !gpRedCoreVol->fDiscardUnsupported && ( ulBlockCount > 0U ) )
+            {
+                uint32_t ulIdx;
+                bool fMerged = false;
+
+                for( ulIdx = 0U; ( !fMerged ) && ( ulIdx < gpRedCoreVol->ulDiscardCount ); ulIdx++ )
+                {
+                    DISCARDRANGE * pRange = &gpRedCoreVol->aDiscard[ ulIdx ];
+
+                    if( ulBlockStart == ( pRange->ulBlockStart + pRange->ulBlockCount ) )
+                    {
+                        pRange->ulBlockCount += ulBlockCount;
+                        fMerged = true;
+                    }
+                    else if( ( ulBlockStart + ulBlockCount ) == pRange->ulBlockStart )
+                    {
+                        pRange->ulBlockStart = ulBlockStart;
+                        pRange->ulBlockCount += ulBlockCount;
+                        fMerged = true;
+                    }
+                    else
+                    {
+                        /*  Not adjacent to this range; keep looking.
+                         */
+                    }
+                }
+
+                if( ( !fMerged ) && ( gpRedCoreVol->ulDiscardCount < REDCONF_DISCARD_RANGES ) )
+                {
+                    gpRedCoreVol->aDiscard[ gpRedCoreVol->ulDiscardCount ].ulBlockStart = ulBlockStart;
+                    gpRedCoreVol->aDiscard[ gpRedCoreVol->ulDiscardCount ].ulBlockCount = ulBlockCount;
+                    gpRedCoreVol->ulDiscardCount++;
+                }
+            }
+        }
+
+
+/** @brief Discard the blocks freed by the transaction point just committed.
+ *
+ *  The remembered ranges are sorted and any which have grown to touch are
+ *  joined, so that each contiguous run of freed blocks is one request.
+ */
+        static void DiscardIssue( void )
+        {
+            DISCARDRANGE * pRanges = gpRedCoreVol->aDiscard;
+            uint32_t ulCount = gpRedCoreVol->ulDiscardCount;
+            uint32_t ulIdx;
+            uint32_t ulOut = 0U;
+
+            /*  Insertion sort by starting block; there are only a few ranges.
+             */
+            for( ulIdx = 1U; ulIdx < ulCount; ulIdx++ )
+            {
+                DISCARDRANGE range = pRanges[ ulIdx ];
+                uint32_t ulPos = ulIdx;
+
+                while( ( ulPos > 0U ) && ( pRanges[ ulPos - 1U ].ulBlockStart > range.ulBlockStart ) )
+                {
+                    pRanges[ ulPos ] = pRanges[ ulPos - 1U ];
+                    ulPos--;
+                }
+
+                pRanges[ ulPos ] = range;
+            }
+
+            for( ulIdx = 1U; ulIdx < ulCount; ulIdx++ )
+            {
+                if( pRanges[ ulIdx ].ulBlockStart == ( pRanges[ ulOut ].ulBlockStart + pRanges[ ulOut ].ulBlockCount ) )
+                {
+                    pRanges[ ulOut ].ulBlockCount += pRanges[ ulIdx ].ulBlockCount;
+                }
+                else
+                {
+                    ulOut++;
+                    pRanges[ ulOut ] = pRanges[ ulIdx ];
+                }
+            }
+
+            if( ulCount > 0U )
+            {
+                ulCount = ulOut + 1U;
+            }
+
+            for( ulIdx = 0U; ( ulIdx < ulCount ) && !gpRedCoreVol->fDiscardUnsupported; ulIdx++ )
+            {
+                REDSTATUS ret = RedIoDiscard( gbRedVolNum, pRanges[ ulIdx ].ulBlockStart, pRanges[ ulIdx ].ulBlockCount );
+
+                /*  Other errors are ignored: the transaction point has already
+                 *  been committed, and the blocks are free either way.
+                 */
+                if( ret == -RED_ENOSYS )
+                {
+                    gpRedCoreVol->fDiscardUnsupported = true;
+                }
+            }
+
+            gpRedCoreVol->ulDiscardCount = 0U;
+        }
+    #endif /* REDCONF_DISCARDS == 1 */
 #endif /* if REDCONF_READ_ONLY == 0 */
 
 
@@ -470,6 +811,9 @@ static bool MetarootIsValid( METAROOT * pMR,
                 pMetaRoot->ulFreeInodes = RedRev32( pMetaRoot->ulFreeInodes );
             #endif
             pMetaRoot->ulAllocNextBlock = RedRev32( pMetaRoot->ulAllocNextBlock );
+            #if REDCONF_IMAP_LAZY_FORMAT == 1
+                pMetaRoot->ulImapNodesInit = RedRev32( pMetaRoot->ulImapNodesInit );
+            #endif
         }
     }
 #endif /* ifdef REDCONF_ENDIAN_SWAP */
@@ -510,6 +854,8 @@ void RedVolCriticalError( const char * pszFileName,
 
 
 /** @brief Increment the sequence number.
+ *
+ *  @param bVolNum  The volume whose sequence number is to be incremented.
  *
  *  @return A negated ::REDSTATUS code indicating the operation result.
  *
@@ -517,11 +863,16 @@ void RedVolCriticalError( const char * pszFileName,
  *  @retval -RED_EINVAL Cannot increment sequence number: maximum value reached.
  *                      This should not ever happen.
  */
-REDSTATUS RedVolSeqNumIncrement( void )
+REDSTATUS RedVolSeqNumIncrement( uint8_t bVolNum )
 {
     REDSTATUS ret;
 
-    if( gpRedVolume->ullSequence == UINT64_MAX )
+    if( bVolNum >= REDCONF_VOLUME_COUNT )
+    {
+        REDERROR();
+        ret = -RED_EINVAL;
+    }
+    else if( gaRedVolume[ bVolNum ].ullSequence == UINT64_MAX )
     {
         /*  In practice this should never, ever happen; to get here, there would
          *  need to be UINT64_MAX disk writes, which would take eons: longer
@@ -534,7 +885,7 @@ REDSTATUS RedVolSeqNumIncrement( void )
     }
     else
     {
-        gpRedVolume->ullSequence++;
+        gaRedVolume[ bVolNum ].ullSequence++;
         ret = 0;
     }
 
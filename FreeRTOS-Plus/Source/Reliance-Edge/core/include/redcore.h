@@ -31,6 +31,7 @@
 
 
 #include <redstat.h>
+#include <redcoreapi.h>
 #include <redvolume.h>
 #include "rednodes.h"
 #include "redcoremacs.h"
@@ -43,6 +44,7 @@
 #define META_SIG_INODE       ( 0x444F4E49U ) /* 'INOD' */
 #define META_SIG_DINDIR      ( 0x494C4244U ) /* 'DBLI' */
 #define META_SIG_INDIR       ( 0x49444E49U ) /* 'INDI' */
+#define META_SIG_INTENT      ( 0x4C544E49U ) /* 'INTL' */
 
 
 REDSTATUS RedIoRead( uint8_t bVolNum,
@@ -54,7 +56,29 @@ REDSTATUS RedIoRead( uint8_t bVolNum,
                           uint32_t ulBlockStart,
                           uint32_t ulBlockCount,
                           const void * pBuffer );
+    #if REDCONF_INTENT_LOG_BLOCKS > 0U
+        REDSTATUS RedIoSectorWrite( uint8_t bVolNum,
+                                    uint64_t ullSectorStart,
+                                    uint32_t ulSectorCount,
+                                    const void * pBuffer );
+    #endif
     REDSTATUS RedIoFlush( uint8_t bVolNum );
+
+    #if REDCONF_DISCARDS == 1
+        REDSTATUS RedIoDiscard( uint8_t bVolNum,
+                                uint32_t ulBlockStart,
+                                uint32_t ulBlockCount );
+    #endif
+
+    #if REDCONF_BDEV_ASYNC_DEPTH > 0U
+        REDSTATUS RedIoWriteStart( uint8_t bVolNum,
+                                   uint32_t ulBlockStart,
+                                   uint32_t ulBlockCount,
+                                   void * pBuffer,
+                                   BDEVREQ * pReq );
+        REDSTATUS RedIoWriteFinish( uint8_t bVolNum,
+                                    BDEVREQ * pReq );
+    #endif
 #endif
 
 
@@ -101,18 +125,35 @@ REDSTATUS RedBufferGet( uint32_t ulBlock,
                         uint16_t uFlags,
                         void ** ppBuffer );
 void RedBufferPut( const void * pBuffer );
+#if REDCONF_INODE_INLINE == 1
+    void RedBufferReference( const void * pBuffer );
+#endif
 #if REDCONF_READ_ONLY == 0
     REDSTATUS RedBufferFlush( uint32_t ulBlockStart,
                               uint32_t ulBlockCount );
     void RedBufferDirty( const void * pBuffer );
     void RedBufferBranch( const void * pBuffer,
                           uint32_t ulBlockNew );
+    #if REDCONF_BDEV_RAM_ALIAS == 1
+        void RedBufferAliasBranch( void ** ppBuffer,
+                                   uint32_t ulBlockNew );
+    #endif
     #if ( REDCONF_API_POSIX == 1 ) || FORMAT_SUPPORTED
         void RedBufferDiscard( const void * pBuffer );
     #endif
 #endif
 REDSTATUS RedBufferDiscardRange( uint32_t ulBlockStart,
                                  uint32_t ulBlockCount );
+#if REDCONF_READAHEAD_BLOCKS > 0U
+    REDSTATUS RedBufferReadAhead( uint32_t ulBlockStart,
+                                  uint32_t * pulBlockCount );
+#endif
+#if REDCONF_TRANSACT_TASK == 1
+    uint32_t RedBufferDirtyCount( void );
+#endif
+#if REDCONF_STATS == 1
+    uint32_t RedBufferVolCount( void );
+#endif
 
 
 /** @brief Allocation state of a block.
@@ -131,7 +172,11 @@ REDSTATUS RedImapBlockGet( uint8_t bMR,
 #if REDCONF_READ_ONLY == 0
     REDSTATUS RedImapBlockSet( uint32_t ulBlock,
                                bool fAllocated );
+    REDSTATUS RedImapBlockRangeFree( uint32_t ulBlockStart,
+                                     uint32_t ulBlockCount );
     REDSTATUS RedImapAllocBlock( uint32_t * pulBlock );
+    REDSTATUS RedImapAllocBlocks( uint32_t * pulBlock,
+                                  uint32_t * pulBlockCount );
 #endif
 REDSTATUS RedImapBlockState( uint32_t ulBlock,
                              ALLOCSTATE * pState );
@@ -142,6 +187,9 @@ REDSTATUS RedImapBlockState( uint32_t ulBlock,
                                 bool * pfAllocated );
     REDSTATUS RedImapIBlockSet( uint32_t ulBlock,
                                 bool fAllocated );
+    REDSTATUS RedImapIFindFree( uint32_t ulBlockStart,
+                                uint32_t ulBlockEnd,
+                                uint32_t * pulBlock );
 #endif
 
 #if REDCONF_IMAP_EXTERNAL == 1
@@ -150,6 +198,12 @@ REDSTATUS RedImapBlockState( uint32_t ulBlock,
                                 bool * pfAllocated );
     REDSTATUS RedImapEBlockSet( uint32_t ulBlock,
                                 bool fAllocated );
+    REDSTATUS RedImapERangeFree( uint32_t ulBlockStart,
+                                 uint32_t ulBlockCount,
+                                 uint32_t * pulAlmostFree );
+    REDSTATUS RedImapEFindFree( uint32_t ulBlockStart,
+                                uint32_t ulBlockEnd,
+                                uint32_t * pulBlock );
     uint32_t RedImapNodeBlock( uint8_t bMR,
                                uint32_t ulImapNode );
 #endif
@@ -245,11 +299,28 @@ REDSTATUS RedInodeBitGet( uint8_t bMR,
                           uint32_t ulInode,
                           uint8_t bWhich,
                           bool * pfAllocated );
+#if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )
+    void RedInodeFreeMapReset( void );
+#endif
+#if REDCONF_INODE_CACHE_ENTRIES > 0U
+    void RedInodeCacheReset( void );
+    #if REDCONF_READ_ONLY == 0
+        void RedInodeCacheCommit( void );
+    #endif
+#endif
 
 REDSTATUS RedInodeDataRead( CINODE * pInode,
                             uint64_t ullStart,
                             uint32_t * pulLen,
                             void * pBuffer );
+#if ( REDCONF_READBUF_COUNT > 0U ) || COPY_SUPPORTED
+    REDSTATUS RedInodeDataLend( CINODE * pInode,
+                                uint64_t ullStart,
+                                uint32_t * pulLen,
+                                const uint8_t ** ppbBlock,
+                                const uint8_t ** ppbData );
+    void RedInodeDataReturn( const uint8_t * pbBlock );
+#endif
 #if REDCONF_READ_ONLY == 0
     REDSTATUS RedInodeDataWrite( CINODE * pInode,
                                  uint64_t ullStart,
@@ -259,6 +330,15 @@ REDSTATUS RedInodeDataRead( CINODE * pInode,
         REDSTATUS RedInodeDataTruncate( CINODE * pInode,
                                         uint64_t ullSize );
     #endif
+    #if FALLOCATE_SUPPORTED
+        REDSTATUS RedInodeDataAllocate( CINODE * pInode,
+                                        uint64_t ullStart,
+                                        uint64_t ullLen );
+    #endif
+#endif
+#if REDCONF_READAHEAD_BLOCKS > 0U
+    void RedInodeDataReadAheadStats( REDRASTATS * pStats,
+                                     bool fReset );
 #endif
 REDSTATUS RedInodeDataSeekAndRead( CINODE * pInode,
                                    uint32_t ulBlock );
@@ -293,6 +373,9 @@ REDSTATUS RedInodeDataSeek( CINODE * pInode,
                                      const char * pszDstName,
                                      CINODE * pDstInode );
     #endif
+    #if REDCONF_DIR_INDEX_DIRS > 0U
+        void RedDirIndexDiscard( uint32_t ulInode );
+    #endif
 #endif /* if REDCONF_API_POSIX == 1 */
 
 REDSTATUS RedVolMount( void );
@@ -300,14 +383,33 @@ REDSTATUS RedVolMountMaster( void );
 REDSTATUS RedVolMountMetaroot( void );
 #if REDCONF_READ_ONLY == 0
     REDSTATUS RedVolTransact( void );
+    #if REDCONF_DISCARDS == 1
+        void RedVolDiscardAdd( uint32_t ulBlockStart,
+                               uint32_t ulBlockCount );
+    #endif
 #endif
 void RedVolCriticalError( const char * pszFileName,
                           uint32_t ulLineNum );
-REDSTATUS RedVolSeqNumIncrement( void );
+REDSTATUS RedVolSeqNumIncrement( uint8_t bVolNum );
 
 #if FORMAT_SUPPORTED
     REDSTATUS RedVolFormat( void );
 #endif
 
+#if REDCONF_INTENT_LOG_BLOCKS > 0U
+    REDSTATUS RedIntentLoad( void );
+    REDSTATUS RedIntentErase( void );
+    void RedIntentReset( void );
+    void RedIntentRecord( uint32_t ulInode,
+                          bool fChanged,
+                          uint16_t uType,
+                          uint64_t ullOffset,
+                          uint32_t ulLen,
+                          const void * pData );
+    void RedIntentDrop( uint32_t ulInode );
+    bool RedIntentSync( uint32_t ulInode );
+    REDSTATUS RedIntentFlush( void );
+#endif
+
 
 #endif /* ifndef REDCORE_H */
@@ -30,6 +30,40 @@
 #define REDCOREVOL_H
 
 
+#if REDCONF_DISCARDS == 1
+
+/** @brief A range of blocks waiting to be discarded.
+ */
+    typedef struct
+    {
+        uint32_t ulBlockStart; /**< First block in the range. */
+        uint32_t ulBlockCount; /**< Number of blocks in the range. */
+    } DISCARDRANGE;
+#endif
+
+
+#if REDCONF_INODE_CACHE_ENTRIES > 0U
+
+/** @brief Remembers which copy of a recently mounted inode is current.
+ */
+    typedef struct
+    {
+        uint32_t ulInode; /**< Inode number; INODE_INVALID if the entry is unused. */
+        uint8_t bWhich;   /**< Which copy of the inode (0 or 1) is current. */
+        bool fBranched;   /**< Whether the inode is branched. */
+    } INODECACHEENTRY;
+#endif
+
+
+#if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+/*  Number of files per volume whose changes since the last transaction point
+ *  can be made durable through the intent log.
+ */
+    #define INTENT_LOG_FILES    ( 4U )
+#endif
+
+
 /** @brief Per-volume run-time data specific to the core.
  */
 typedef struct
@@ -49,6 +83,16 @@ typedef struct
         /** The number of double-allocated imap nodes that make up the imap.
          */
         uint32_t ulImapNodeCount;
+
+        #if REDCONF_IMAP_SUMMARY == 1
+
+            /** One bit per imap node, set when the node is known to have no
+             *  free blocks, so that the allocator can skip it.  Cleared when
+             *  a block in the node becomes free, and entirely at mount and at
+             *  each transaction point (when almost free blocks become free).
+             */
+            uint8_t abImapFull[ METAROOT_ENTRY_BYTES ];
+        #endif
     #endif
 
     /** Block number where the inode table starts.
@@ -82,6 +126,109 @@ typedef struct
          */
         bool fUseReservedBlocks;
     #endif
+
+    #if REDCONF_DISCARDS == 1
+
+        /** Ranges of blocks which became almost free in the working state,
+         *  to be discarded once the next transaction point makes them free.
+         */
+        DISCARDRANGE aDiscard[ REDCONF_DISCARD_RANGES ];
+
+        /** The number of entries in use in aDiscard.
+         */
+        uint32_t ulDiscardCount;
+
+        /** Set when the block device reports that it does not support
+         *  discards, to stop issuing them until the next mount.
+         */
+        bool fDiscardUnsupported;
+    #endif
+
+    #if REDCONF_INODE_CACHE_ENTRIES > 0U
+
+        /** Recently mounted inodes.  Entries are dropped when the imap bits
+         *  for the inode change, and all at mount and format.
+         */
+        INODECACHEENTRY aInodeCache[ REDCONF_INODE_CACHE_ENTRIES ];
+
+        /** The next entry of aInodeCache to be replaced.
+         */
+        uint8_t bInodeCacheNext;
+    #endif
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )
+
+        /** No inode number below this one is free in the working state, so
+         *  the search for a free inode number starts here.
+         */
+        uint32_t ulInodeFreeHint;
+
+        #if REDCONF_INODE_FREE_MAP_INODES > 0U
+
+            /** Whether abInodeUsed is up to date.  Cleared at mount and
+             *  format; the map is loaded by the first search afterward.
+             */
+            bool fInodeMapValid;
+
+            /** One bit per inode number, starting with INODE_FIRST_VALID, set
+             *  when the inode is in use in the working state.
+             */
+            uint8_t abInodeUsed[ ( REDCONF_INODE_FREE_MAP_INODES + 7U ) / 8U ];
+        #endif
+    #endif
+
+    #if REDCONF_INTENT_LOG_BLOCKS > 0U
+
+        /** First block number of the intent log, which lies between the inode
+         *  table and the first allocable block.
+         */
+        uint32_t ulIntentLogStartBN;
+
+        /** RAM copy of the intent log, as it is stored on disk.
+         */
+        uint32_t aulIntentLog[ ( REDCONF_INTENT_LOG_BLOCKS * REDCONF_BLOCK_SIZE ) / 4U ];
+
+        /** The number of log sectors holding records.
+         */
+        uint32_t ulIntentSectors;
+
+        /** Offset of the first unused byte of the last sector holding records.
+         */
+        uint32_t ulIntentOffset;
+
+        /** The number of leading log sectors whose RAM copy has been written to
+         *  disk and not changed since.
+         */
+        uint32_t ulIntentDurable;
+
+        /** The first log sector written since the log was loaded or reset.
+         *  Earlier sectors may hold records which were never synced.
+         */
+        uint32_t ulIntentFirst;
+
+        /** Files whose every change since the last transaction point is in the
+         *  log; INODE_INVALID for unused entries.
+         */
+        uint32_t aulIntentInodes[ INTENT_LOG_FILES ];
+
+        /** Whether each file in aulIntentInodes has records after its last
+         *  sync record.
+         */
+        bool afIntentUnsynced[ INTENT_LOG_FILES ];
+    #endif
+
+    #if REDCONF_TRANSACT_TASK == 1
+
+        /** Approximately how many milliseconds the volume has been branched,
+         *  as counted by the transaction task.
+         */
+        uint32_t ulBranchedMs;
+
+        /** The number of bytes of file data written since the last transaction
+         *  point.
+         */
+        uint64_t ullBytesWritten;
+    #endif
 } COREVOLUME;
 
 /*  Pointer to the core volume currently being accessed; populated during
@@ -94,5 +241,12 @@ extern COREVOLUME * CONST_IF_ONE_VOLUME gpRedCoreVol;
  */
 extern METAROOT * gpRedMR;
 
+#if REDCONF_STATS == 1
+
+/*  I/O and cache statistics, indexed by volume number.
+ */
+    extern REDVOLSTATS gaRedVolStats[ REDCONF_VOLUME_COUNT ];
+#endif
+
 
 #endif /* ifndef REDCOREVOL_H */
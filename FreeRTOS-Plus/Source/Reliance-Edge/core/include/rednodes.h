@@ -57,6 +57,12 @@ typedef struct
 /** Flag set in the master block when (REDCONF_API_POSIX == 1) && (REDCONF_API_POSIX_LINK == 1). */
 #define MBFLAG_INODE_NLINK         ( 0x08U )
 
+/** Flag set in the master block when REDCONF_INODE_INLINE == 1. */
+#define MBFLAG_INODE_INLINE        ( 0x10U )
+
+/** Flag set in the master block when REDCONF_IMAP_LAZY_FORMAT == 1. */
+#define MBFLAG_IMAP_LAZY           ( 0x20U )
+
 
 /** @brief Node which identifies the volume and stores static volume information.
  */
@@ -74,13 +80,19 @@ typedef struct
     uint16_t uIndirectPointers; /**< Compile-time configured number of indirect pointers per inode. */
     uint8_t bBlockSizeP2;       /**< Compile-time configured block size, expressed as a power of two. */
     uint8_t bFlags;             /**< Compile-time booleans which affect on-disk structures. */
+    uint32_t ulIntentLogBlocks; /**< Compile-time configured number of intent log blocks. */
 } MASTERBLOCK;
 
 
 #if REDCONF_API_POSIX == 1
-    #define METAROOT_HEADER_SIZE    ( NODEHEADER_SIZE + 16U )                     /* Size in bytes of the metaroot header fields. */
+    #define METAROOT_FIELDS_SIZE    ( 16U )                                       /* Size in bytes of the metaroot fields which precede the imap bitmap. */
+#else
+    #define METAROOT_FIELDS_SIZE    ( 12U )                                       /* Size in bytes of the metaroot fields which precede the imap bitmap. */
+#endif
+#if REDCONF_IMAP_LAZY_FORMAT == 1
+    #define METAROOT_HEADER_SIZE    ( NODEHEADER_SIZE + METAROOT_FIELDS_SIZE + 4U ) /* Size in bytes of the metaroot header fields. */
 #else
-    #define METAROOT_HEADER_SIZE    ( NODEHEADER_SIZE + 12U )                     /* Size in bytes of the metaroot header fields. */
+    #define METAROOT_HEADER_SIZE    ( NODEHEADER_SIZE + METAROOT_FIELDS_SIZE )    /* Size in bytes of the metaroot header fields. */
 #endif
 #define METAROOT_ENTRY_BYTES        ( REDCONF_BLOCK_SIZE - METAROOT_HEADER_SIZE ) /* Number of bytes remaining in the metaroot block for entries. */
 #define METAROOT_ENTRIES            ( METAROOT_ENTRY_BYTES * 8U )
@@ -97,6 +109,9 @@ typedef struct
         uint32_t ulFreeInodes; /**< Number of inode slots that are free. */
     #endif
     uint32_t ulAllocNextBlock; /**< Forward allocation pointer. */
+    #if REDCONF_IMAP_LAZY_FORMAT == 1
+        uint32_t ulImapNodesInit; /**< Number of external imap nodes, from the start, written since format. */
+    #endif
 
     /** Imap bitmap.  With inline imaps, this is the imap bitmap that indicates
      *  which inode blocks are used and which allocable blocks are used.
@@ -174,6 +189,15 @@ typedef struct
 } INODE;
 
 
+/** Number of bytes of file data which can be stored inside an inode. */
+#define INODE_INLINE_MAX     ( INODE_ENTRIES * 4U )
+
+/** Bit in INODE::uMode which is set while the data of a regular file is stored
+ *  in INODE::aulEntries.  Never reported by stat.
+ */
+#define INODE_MODE_INLINE    ( 0x0001U )
+
+
 #define INDIR_HEADER_SIZE    ( NODEHEADER_SIZE + 4U )
 #define INDIR_ENTRIES        ( ( REDCONF_BLOCK_SIZE - INDIR_HEADER_SIZE ) / 4U )
 
@@ -194,4 +218,50 @@ typedef struct
 } INDIR, DINDIR;
 
 
+#if REDCONF_INTENT_LOG_BLOCKS > 0U
+    #define INTENTSECTOR_HEADER_SIZE    ( NODEHEADER_SIZE + 16U )
+    #define INTENTRECORD_SIZE           ( 16U )
+
+/** INTENTRECORD::uType of the unused space after the last record of a sector. */
+    #define INTENT_NONE                 ( 0U )
+
+/** INTENTRECORD::uType of a write; the data follows the record. */
+    #define INTENT_WRITE                ( 1U )
+
+/** INTENTRECORD::uType of a change of the file size to INTENTRECORD::ullOffset. */
+    #define INTENT_TRUNCATE             ( 2U )
+
+/** INTENTRECORD::uType of a red_fsync() of the file: the records of the file
+ *  before it, in log sectors from INTENTRECORD::ullOffset on, are durable.
+ */
+    #define INTENT_SYNC                 ( 3U )
+
+/** @brief Header at the start of each sector of the intent log.
+ *
+ *  The sector CRC covers the sector from the sequence number to its end.
+ */
+    typedef struct
+    {
+        NODEHEADER hdr;          /**< Common node header; the sequence number increases with each log write. */
+
+        uint64_t ullCommitSeq;   /**< Sequence number of the committed metaroot the records apply to. */
+        uint32_t ulIndex;        /**< Position of this sector in the log. */
+        uint8_t abPadding[ 4U ]; /**< Padding to 64-bit align the records. */
+    } INTENTSECTOR;
+
+/** @brief One change to a file, stored in the intent log.
+ *
+ *  Records are packed after the sector header; one which does not fit is split
+ *  across sectors.
+ */
+    typedef struct
+    {
+        uint64_t ullOffset; /**< File offset of the write, the new file size, or the first sector a sync covers. */
+        uint32_t ulInode;   /**< Inode number of the file. */
+        uint16_t uType;     /**< INTENT_WRITE, INTENT_TRUNCATE or INTENT_SYNC. */
+        uint16_t uLen;      /**< Number of bytes of write data following the record. */
+    } INTENTRECORD;
+#endif /* REDCONF_INTENT_LOG_BLOCKS > 0U */
+
+
 #endif /* ifndef REDNODES_H */
@@ -42,6 +42,10 @@
 
     static REDSTATUS FseEnter( uint8_t bVolNum );
     static void FseLeave( void );
+    #if REDCONF_API_FSE_IOVEC == 1
+        static REDSTATUS FseIovCheck( const REDFSEIOVEC * pIov,
+                                      uint32_t ulIovCount );
+    #endif
 
 
     static bool gfFseInited; /* Whether driver is initialized. */
@@ -409,6 +413,146 @@
     #endif /* if REDCONF_READ_ONLY == 0 */
 
 
+    #if REDCONF_API_FSE_IOVEC == 1
+
+/** @brief Read a contiguous range of a file into several buffers.
+ *
+ *  Like RedFseRead(), except that the data is scattered into the buffers of
+ *  @p pIov in order: the first buffer is filled from @p ullFileOffset, the
+ *  second from where the first ended, and so on.  The whole request is one
+ *  call into the file system, with the file looked up once, which is cheaper
+ *  than a RedFseRead() per buffer.
+ *
+ *  A short read indicates that the end-of-file was reached; the buffers after
+ *  the one where it was reached are left unchanged.
+ *
+ *  @param bVolNum          The volume number of the file to read.
+ *  @param ulFileNum        The file number of the file to read.
+ *  @param ullFileOffset    The file offset to read from.
+ *  @param pIov             The buffers to populate with the data read.
+ *  @param ulIovCount       The number of buffers in @p pIov.
+ *
+ *  @return The number of bytes read (nonnegative) or a negated ::REDSTATUS
+ *          code indicating the operation result (negative).
+ *
+ *  @retval >=0         The number of bytes read from the file.
+ *  @retval -RED_EBADF  @p ulFileNum is not a valid file number.
+ *  @retval -RED_EINVAL @p bVolNum is an invalid volume number or not mounted;
+ *                      or @p pIov is `NULL`, or one of its buffers is `NULL`;
+ *                      or the total length of the buffers exceeds INT32_MAX
+ *                      and cannot be returned properly.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+        int32_t RedFseReadV( uint8_t bVolNum,
+                             uint32_t ulFileNum,
+                             uint64_t ullFileOffset,
+                             const REDFSEIOVEC * pIov,
+                             uint32_t ulIovCount )
+        {
+            int32_t ret;
+
+            ret = FseIovCheck( pIov, ulIovCount );
+
+            if( ret == 0 )
+            {
+                ret = FseEnter( bVolNum );
+            }
+
+            if( ret == 0 )
+            {
+                uint32_t ulReadLen;
+
+                ret = RedCoreFileReadV( ulFileNum, ullFileOffset, pIov, ulIovCount, &ulReadLen );
+
+                FseLeave();
+
+                if( ret == 0 )
+                {
+                    ret = ( int32_t ) ulReadLen;
+                }
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_API_FSE_IOVEC == 1 */
+
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_FSE_IOVEC == 1 )
+
+/** @brief Write a contiguous range of a file from several buffers.
+ *
+ *  Like RedFseWrite(), except that the data is gathered from the buffers of
+ *  @p pIov in order, and written to the file as one contiguous range starting
+ *  at @p ullFileOffset.  The whole request is one call into the file system,
+ *  with the file looked up once and, if #RED_TRANSACT_WRITE is enabled, one
+ *  transaction point at the end, rather than one per buffer.
+ *
+ *  A short write has the same meaning as for RedFseWrite(): the file system
+ *  ran out of space, or the file reached the maximum file size, after some of
+ *  the data was written.  The data written is always a prefix of the
+ *  gathered data.
+ *
+ *  If an error is returned (negative return), either none of the data was
+ *  written or a critical error occurred (like an I/O error) and the file
+ *  system volume will be read-only.
+ *
+ *  @param bVolNum          The volume number of the file to write.
+ *  @param ulFileNum        The file number of the file to write.
+ *  @param ullFileOffset    The file offset to write at.
+ *  @param pIov             The buffers containing the data to be written.
+ *  @param ulIovCount       The number of buffers in @p pIov.
+ *
+ *  @return The number of bytes written (nonnegative) or a negated ::REDSTATUS
+ *          code indicating the operation result (negative).
+ *
+ *  @retval >=0         The number of bytes written to the file.
+ *  @retval -RED_EBADF  @p ulFileNum is not a valid file number.
+ *  @retval -RED_EFBIG  No data can be written to the given file offset since
+ *                      the resulting file size would exceed the maximum file
+ *                      size.
+ *  @retval -RED_EINVAL @p bVolNum is an invalid volume number or not mounted;
+ *                      or @p pIov is `NULL`, or one of its buffers is `NULL`;
+ *                      or the total length of the buffers exceeds INT32_MAX
+ *                      and cannot be returned properly.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOSPC No data can be written because there is insufficient
+ *                      free space.
+ *  @retval -RED_EROFS  The file system volume is read-only.
+ */
+        int32_t RedFseWriteV( uint8_t bVolNum,
+                              uint32_t ulFileNum,
+                              uint64_t ullFileOffset,
+                              const REDFSEIOVEC * pIov,
+                              uint32_t ulIovCount )
+        {
+            int32_t ret;
+
+            ret = FseIovCheck( pIov, ulIovCount );
+
+            if( ret == 0 )
+            {
+                ret = FseEnter( bVolNum );
+            }
+
+            if( ret == 0 )
+            {
+                uint32_t ulWriteLen;
+
+                ret = RedCoreFileWriteV( ulFileNum, ullFileOffset, pIov, ulIovCount, &ulWriteLen );
+
+                FseLeave();
+
+                if( ret == 0 )
+                {
+                    ret = ( int32_t ) ulWriteLen;
+                }
+            }
+
+            return ret;
+        }
+    #endif /* ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_FSE_IOVEC == 1 ) */
+
+
     #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_FSE_TRUNCATE == 1 )
 
 /** @brief Truncate a file (set the file size).
@@ -683,4 +827,48 @@
     }
 
 
+    #if REDCONF_API_FSE_IOVEC == 1
+
+/** @brief Check the buffers of a vectored request.
+ *
+ *  @param pIov         The buffers of the request.
+ *  @param ulIovCount   The number of buffers in @p pIov.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p pIov is `NULL`; or the total length of the buffers
+ *                      exceeds INT32_MAX.
+ */
+        static REDSTATUS FseIovCheck( const REDFSEIOVEC * pIov,
+                                      uint32_t ulIovCount )
+        {
+            REDSTATUS ret = 0;
+
+            if( pIov == NULL )
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                uint32_t ulTotal = 0U;
+                uint32_t ulIdx;
+
+                for( ulIdx = 0U; ulIdx < ulIovCount; ulIdx++ )
+                {
+                    if( pIov[ ulIdx ].ulLength > ( ( uint32_t ) INT32_MAX - ulTotal ) )
+                    {
+                        ret = -RED_EINVAL;
+                        break;
+                    }
+
+                    ulTotal += pIov[ ulIdx ].ulLength;
+                }
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_API_FSE_IOVEC == 1 */
+
+
 #endif /* REDCONF_API_FSE == 1 */
@@ -177,6 +177,363 @@
 #endif
 
 
+/*  The settings below are optional.  Configuration files generated by the
+ *  Configuration Utility do not define them, so they default to the behavior
+ *  of the original driver.  Define them in redconf.h to override.
+ */
+
+/** Set to 1 to index the block buffers with a hash table keyed on volume and
+ *  block number and to order them with a linked LRU list, so that buffer
+ *  lookups and promotions take constant time regardless of
+ *  REDCONF_BUFFER_COUNT.  Costs roughly four bytes of RAM per buffer.
+ */
+#ifndef REDCONF_BUFFER_HASH
+    #define REDCONF_BUFFER_HASH    0
+#endif
+
+/** Number of block buffers kept for metadata (inode, indirect, imap, and
+ *  directory nodes) when file data is being buffered.  A file data block does
+ *  not replace a metadata buffer while this many or fewer buffers hold
+ *  metadata, so a long sequential read or write does not flush the hot
+ *  metadata from the cache.  Zero disables the reservation, giving plain LRU.
+ */
+#ifndef REDCONF_BUFFER_META_RESERVE
+    #define REDCONF_BUFFER_META_RESERVE    0U
+#endif
+
+/** Whether each volume can reserve block buffers for itself, with the
+ *  bBufferReserve member of its ::VOLCONF entry.  A block of one volume does
+ *  not replace a buffer of another volume while that volume holds no more than
+ *  its reserve, so a burst of I/O on one volume cannot flush the cache of
+ *  another.
+ */
+#ifndef REDCONF_BUFFER_VOL_RESERVE
+    #define REDCONF_BUFFER_VOL_RESERVE    0
+#endif
+
+/** Maximum number of blocks to read ahead when a file is being read
+ *  sequentially in small pieces.  The blocks are read into the buffer cache
+ *  with a single device request, so subsequent reads are cache hits.  Zero
+ *  disables read-ahead.
+ */
+#ifndef REDCONF_READAHEAD_BLOCKS
+    #define REDCONF_READAHEAD_BLOCKS    0U
+#endif
+
+/** Number of sequential read streams tracked for read-ahead.  Each stream
+ *  costs about 24 bytes of RAM.  Only used when REDCONF_READAHEAD_BLOCKS is
+ *  nonzero.
+ */
+#ifndef REDCONF_READAHEAD_STREAMS
+    #define REDCONF_READAHEAD_STREAMS    4U
+#endif
+
+/** Maximum number of contiguous dirty blocks combined into one device write
+ *  when buffers are flushed, such as at a transaction point.  Dirty buffers
+ *  are written in block order and each run of contiguous blocks is copied into
+ *  a staging buffer of this many blocks, which is written with one request.
+ *  Zero disables coalescing.
+ */
+#ifndef REDCONF_FLUSH_COALESCE_BLOCKS
+    #define REDCONF_FLUSH_COALESCE_BLOCKS    0U
+#endif
+
+/** Maximum number of asynchronous block device writes kept in flight when
+ *  buffers are flushed.  When non-zero, the block device must implement
+ *  RedOsBDevSubmit() and RedOsBDevWait(), and the buffer flush finalizes the
+ *  next buffer while earlier writes are still in progress.  This is only used
+ *  when REDCONF_FLUSH_COALESCE_BLOCKS is zero.  Zero disables asynchronous I/O.
+ */
+#ifndef REDCONF_BDEV_ASYNC_DEPTH
+    #define REDCONF_BDEV_ASYNC_DEPTH    0U
+#endif
+
+/** Whether a read-only volume may be accessed in place, when its block device
+ *  is memory-mapped (such as NOR or QSPI flash in memory-mapped mode).  The
+ *  block device reports the mapping with RedOsBDevMap(); file data is then
+ *  used straight from the mapping, rather than being read into a buffer.
+ *  Requires REDCONF_READ_ONLY.
+ */
+#ifndef REDCONF_BDEV_XIP
+    #define REDCONF_BDEV_XIP    0
+#endif
+
+/** Whether file data on a writable RAM volume is used in place, rather than
+ *  being copied between the RAM disk and the buffers.  The block device
+ *  reports the RAM with RedOsBDevAlias().  Metadata is still buffered; file
+ *  data blocks are only copied when a committed block is branched.  Requires
+ *  REDCONF_READ_ONLY == 0; REDCONF_BDEV_XIP covers read-only volumes.
+ */
+#ifndef REDCONF_BDEV_RAM_ALIAS
+    #define REDCONF_BDEV_RAM_ALIAS    0
+#endif
+
+/** Whether the data of a small regular file is stored inside its inode, rather
+ *  than in a data block of its own.  Up to the size of the inode's block
+ *  pointer array fits; when a file grows beyond that, its data is moved into a
+ *  data block.  This makes larger block sizes practical on volumes which also
+ *  hold many small files.  Affects the on-disk layout, so volumes must be
+ *  formatted with the same setting.
+ */
+#ifndef REDCONF_INODE_INLINE
+    #define REDCONF_INODE_INLINE    0
+#endif
+
+/** The software CRC algorithm used when REDCONF_CRC_ALGORITHM is CRC_HARDWARE
+ *  and the port cannot compute a given CRC in hardware.
+ */
+#ifndef REDCONF_CRC_FALLBACK
+    #define REDCONF_CRC_FALLBACK    CRC_SARWATE
+#endif
+
+/** Whether all of the CRC algorithms are compiled in, so that the CRC
+ *  benchmark can compare them.  Increases code size.
+ */
+#ifndef REDCONF_CRC_BENCHMARK
+    #define REDCONF_CRC_BENCHMARK    0
+#endif
+
+/** Whether volumes with an external imap keep an in-memory summary of which
+ *  imap nodes have no free blocks, so that allocation can skip over fully
+ *  allocated regions without reading their imap nodes.  Costs a bitmap of
+ *  about one block in size for each volume.
+ */
+#ifndef REDCONF_IMAP_SUMMARY
+    #define REDCONF_IMAP_SUMMARY    0
+#endif
+
+/** Whether format leaves the external imap unwritten.  Each metaroot records
+ *  how many imap nodes have been written; the rest read as all free and are
+ *  written the first time a block they cover is allocated, so formatting takes
+ *  about the same time regardless of volume size.  Changes the on-disk layout,
+ *  so volumes must be formatted with the same setting they are mounted with.
+ */
+#ifndef REDCONF_IMAP_LAZY_FORMAT
+    #define REDCONF_IMAP_LAZY_FORMAT    0
+#endif
+
+/** Whether the default memory functions in util/memory.c copy, set, and
+ *  compare 32-bit words when the buffers allow it.  If zero, the simple byte
+ *  loops are used instead.  Has no effect on functions replaced in redconf.h.
+ */
+#ifndef REDCONF_MEM_WORD_ACCESS
+    #define REDCONF_MEM_WORD_ACCESS    1
+#endif
+
+/** Minimum length at which the default RedMemCpy() offers the copy to the
+ *  port-supplied RedOsMemCpy(), such as a DMA-assisted or SIMD copy.  Zero
+ *  disables the hook.
+ */
+#ifndef REDCONF_MEMCPY_HOOK_THRESHOLD
+    #define REDCONF_MEMCPY_HOOK_THRESHOLD    0U
+#endif
+
+/** Number of directories on each volume for which an in-memory name hash
+ *  index is kept, so
+ *  that looking up a name reads only the directory blocks holding entries
+ *  whose name hash matches, instead of the whole directory.  The index for a
+ *  directory is built by scanning it once on first lookup; the least recently
+ *  used index is replaced.  Zero disables the index.
+ */
+#ifndef REDCONF_DIR_INDEX_DIRS
+    #define REDCONF_DIR_INDEX_DIRS    0U
+#endif
+
+/** Number of hash slots in each directory index; must be a power of two.  A
+ *  directory with more entries than three quarters of this is not indexed.
+ *  Each slot costs eight bytes.
+ */
+#ifndef REDCONF_DIR_INDEX_SLOTS
+    #define REDCONF_DIR_INDEX_SLOTS    256U
+#endif
+
+/** Number of entries in the POSIX path component cache, which maps a parent
+ *  directory inode and a name to the inode the name refers to, sparing path
+ *  resolution a directory lookup for each cached component.  Zero disables the
+ *  cache.
+ */
+#ifndef REDCONF_PATH_CACHE_ENTRIES
+    #define REDCONF_PATH_CACHE_ENTRIES    0U
+#endif
+
+/** Whether each volume has its own lock, so that POSIX API calls on different
+ *  volumes can make progress concurrently.  A task holds the lock of the one
+ *  volume it is operating on for the whole call, and gives up the FS mutex
+ *  while it waits for a block to be read from that volume.  Requires the POSIX
+ *  API, more than one task, and more than one volume.
+ */
+#ifndef REDCONF_LOCK_PER_VOLUME
+    #define REDCONF_LOCK_PER_VOLUME    0
+#endif
+
+/** Number of tasks which may hold the lock of a volume shared at the same
+ *  time, for the POSIX calls which only read: red_read(), red_fstat(), and
+ *  red_readdir().  Such calls on one volume then run concurrently with each
+ *  other, and remain exclusive against every other call on the volume.  Zero
+ *  disables shared locking.  Requires #REDCONF_LOCK_PER_VOLUME.
+ */
+#ifndef REDCONF_LOCK_SHARED_READERS
+    #define REDCONF_LOCK_SHARED_READERS    0U
+#endif
+
+/** Whether red_fallocate() is included, to allocate the blocks of a file
+ *  ahead of writing them in contiguous runs.
+ */
+#ifndef REDCONF_API_POSIX_FALLOCATE
+    #define REDCONF_API_POSIX_FALLOCATE    0
+#endif
+
+/** Whether red_copy() is included, to copy data from one file to another
+ *  through the buffer cache, without a bounce buffer in the caller.
+ */
+#ifndef REDCONF_API_POSIX_COPY
+    #define REDCONF_API_POSIX_COPY    0
+#endif
+
+/** Whether RedFseReadV() and RedFseWriteV() are included, to read or write a
+ *  contiguous range of a file from several buffers in one call.
+ */
+#ifndef REDCONF_API_FSE_IOVEC
+    #define REDCONF_API_FSE_IOVEC    0
+#endif
+
+/** Maximum number of buffers which red_readbuf() may lend out at one time.
+ *  A lent buffer stays referenced until it is given back with
+ *  red_releasebuf(), so this many buffers are set aside on top of those the
+ *  file system itself needs.  Zero disables red_readbuf().
+ */
+#ifndef REDCONF_READBUF_COUNT
+    #define REDCONF_READBUF_COUNT    0U
+#endif
+
+/** Whether a background task is started by red_init() to commit transactions
+ *  on its own, according to the thresholds below.  It is in addition to, not
+ *  instead of, the automatic transaction events set with red_settransmask().
+ *  The task counts against #REDCONF_TASK_COUNT.  Requires the POSIX API, a
+ *  writable file system, and more than one task.
+ */
+#ifndef REDCONF_TRANSACT_TASK
+    #define REDCONF_TRANSACT_TASK    0
+#endif
+
+/** How often, in milliseconds, the transaction task wakes up to check each
+ *  mounted volume against the thresholds below.
+ */
+#ifndef REDCONF_TRANSACT_TASK_PERIOD_MS
+    #define REDCONF_TRANSACT_TASK_PERIOD_MS    1000U
+#endif
+
+/** The transaction task commits a volume once it has held uncommitted changes
+ *  for at least this many milliseconds.  Zero disables this threshold.
+ */
+#ifndef REDCONF_TRANSACT_TASK_MAX_AGE_MS
+    #define REDCONF_TRANSACT_TASK_MAX_AGE_MS    5000U
+#endif
+
+/** The transaction task commits a volume once at least this many of its
+ *  buffers are dirty.  Zero disables this threshold.
+ */
+#ifndef REDCONF_TRANSACT_TASK_DIRTY_BUFFERS
+    #define REDCONF_TRANSACT_TASK_DIRTY_BUFFERS    0U
+#endif
+
+/** The transaction task commits a volume once at least this many bytes of file
+ *  data have been written to it since it was last committed.  Zero disables
+ *  this threshold.
+ */
+#ifndef REDCONF_TRANSACT_TASK_DIRTY_BYTES
+    #define REDCONF_TRANSACT_TASK_DIRTY_BYTES    0U
+#endif
+
+/** Size in bytes of the staging ring for write-behind.  When non-zero,
+ *  red_write() copies the data into the ring and returns, and a background
+ *  task started by red_init() writes it to the file system.  Any other call
+ *  into the POSIX API first finishes the queued writes, so that they are seen
+ *  in order; errors from queued writes are reported by red_fsync() and
+ *  red_close().  The task counts against #REDCONF_TASK_COUNT.  Requires the
+ *  POSIX API, a writable file system, more than one task, and a single FS
+ *  lock (#REDCONF_LOCK_PER_VOLUME disabled).  Zero disables write-behind.
+ */
+#ifndef REDCONF_WRITE_BEHIND_BYTES
+    #define REDCONF_WRITE_BEHIND_BYTES    0U
+#endif
+
+/** Maximum number of writes queued in the write-behind staging ring.
+ */
+#ifndef REDCONF_WRITE_BEHIND_ENTRIES
+    #define REDCONF_WRITE_BEHIND_ENTRIES    8U
+#endif
+
+/** Whether per-volume I/O and cache statistics are kept, for red_getstats():
+ *  buffer hits and misses, block device requests and sectors, transaction
+ *  durations, and allocator scan lengths.  Requires the POSIX API.
+ */
+#ifndef REDCONF_STATS
+    #define REDCONF_STATS    0
+#endif
+
+/** Whether the POSIX API keeps a histogram of the latency of each call to
+ *  red_open(), red_read(), red_write(), red_transact(), red_unlink(), and
+ *  red_readdir(), for red_latencystats().  Costs two calls to
+ *  RedOsTimestamp() per timed call and about 700 bytes of RAM.  Requires the
+ *  POSIX API.
+ */
+#ifndef REDCONF_LATENCY_STATS
+    #define REDCONF_LATENCY_STATS    0
+#endif
+
+/** With REDCONF_DISCARDS, the number of freed block ranges remembered per
+ *  volume between transaction points.  Blocks freed next to a remembered range
+ *  extend it; a freed block which fits no range once all are in use is not
+ *  discarded.
+ */
+#ifndef REDCONF_DISCARD_RANGES
+    #define REDCONF_DISCARD_RANGES    16U
+#endif
+
+/** Whether mount uses a hint, kept by RedOsMountHintLoad() and
+ *  RedOsMountHintStore(), naming the metaroot committed last.  When the hint
+ *  matches what is on disk, only that metaroot is read at mount; otherwise
+ *  both are read as usual.  Intended for non-removable media: if the media is
+ *  modified elsewhere, the hint can select an older (but consistent) state.
+ */
+#ifndef REDCONF_FAST_MOUNT
+    #define REDCONF_FAST_MOUNT    0
+#endif
+
+/** Number of recently mounted inodes per volume whose current copy (and
+ *  whether they are branched) is remembered, so that mounting one of them
+ *  again does not need to consult the imap.  Zero disables the cache.
+ */
+#ifndef REDCONF_INODE_CACHE_ENTRIES
+    #define REDCONF_INODE_CACHE_ENTRIES    0U
+#endif
+
+/** Largest inode count of a volume for which a RAM bitmap of the inode numbers
+ *  in use is kept, so that creating a file finds a free inode number without
+ *  reading the imap.  Each volume costs one bit per inode up to this count.
+ *  Volumes with more inodes, or zero here, find free inode numbers by reading
+ *  the imap from the lowest number which might be free.
+ */
+#ifndef REDCONF_INODE_FREE_MAP_INODES
+    #define REDCONF_INODE_FREE_MAP_INODES    0U
+#endif
+
+/** Number of blocks per volume reserved for the intent log.  When the only
+ *  changes to a file since the last transaction point are writes and
+ *  truncates which fit in the log, red_fsync() of that file makes them
+ *  durable by writing the new log sectors, usually one or two, instead of
+ *  committing a transaction point; mount replays the logged changes of each
+ *  file up to its last such red_fsync() on top of the committed state, and the
+ *  next transaction point folds them in.  Each volume keeps a RAM copy of its
+ *  log (this many blocks).  Volumes must be formatted with the same value.
+ *  Zero disables the intent log.
+ */
+#ifndef REDCONF_INTENT_LOG_BLOCKS
+    #define REDCONF_INTENT_LOG_BLOCKS    0U
+#endif
+
+
 #if ( REDCONF_READ_ONLY != 0 ) && ( REDCONF_READ_ONLY != 1 )
     #error "Configuration error: REDCONF_READ_ONLY must be either 0 or 1"
 #endif
@@ -225,6 +582,14 @@
         #error "Configuration error: REDCONF_API_POSIX_FTRUNCATE must be either 0 or 1."
     #endif
 
+    #if ( REDCONF_API_POSIX_FALLOCATE != 0 ) && ( REDCONF_API_POSIX_FALLOCATE != 1 )
+        #error "Configuration error: REDCONF_API_POSIX_FALLOCATE must be either 0 or 1."
+    #endif
+
+    #if ( REDCONF_API_POSIX_COPY != 0 ) && ( REDCONF_API_POSIX_COPY != 1 )
+        #error "Configuration error: REDCONF_API_POSIX_COPY must be either 0 or 1."
+    #endif
+
     #if ( REDCONF_API_POSIX_READDIR != 0 ) && ( REDCONF_API_POSIX_READDIR != 1 )
         #error "Configuration error: REDCONF_API_POSIX_READDIR must be either 0 or 1."
     #endif
@@ -261,6 +626,10 @@
     #if ( REDCONF_API_FSE_TRANSMASKGET != 0 ) && ( REDCONF_API_FSE_TRANSMASKGET != 1 )
         #error "Configuration error: REDCONF_API_FSE_TRANSMASKGET must be either 0 or 1."
     #endif
+
+    #if ( REDCONF_API_FSE_IOVEC != 0 ) && ( REDCONF_API_FSE_IOVEC != 1 )
+        #error "Configuration error: REDCONF_API_FSE_IOVEC must be either 0 or 1."
+    #endif
 #endif /* if REDCONF_API_FSE == 1 */
 
 #if REDCONF_TASK_COUNT < 1U
@@ -275,7 +644,7 @@
     #error "Configuration error: invalid value REDCONF_ALIGNMENT_SIZE"
 #endif
 
-/*  REDCONF_CRC_ALGORITHM checked in crc.c
+/*  REDCONF_CRC_ALGORITHM and REDCONF_CRC_FALLBACK checked in crc.c
  */
 
 #if ( REDCONF_INODE_TIMESTAMPS != 0 ) && ( REDCONF_INODE_TIMESTAMPS != 1 )
@@ -328,12 +697,188 @@
     #error "Configuration error: REDCONF_DISCARDS must be either 0 or 1."
 #endif
 
+#if ( REDCONF_DISCARDS == 1 ) && ( REDCONF_READ_ONLY == 1 )
+    #error "Configuration error: REDCONF_DISCARDS requires REDCONF_READ_ONLY == 0"
+#endif
+
+#if ( REDCONF_DISCARDS == 1 ) && ( ( REDCONF_DISCARD_RANGES < 1U ) || ( REDCONF_DISCARD_RANGES > 255U ) )
+    #error "Configuration error: REDCONF_DISCARD_RANGES must be between 1 and 255"
+#endif
+
+#if ( REDCONF_FAST_MOUNT != 0 ) && ( REDCONF_FAST_MOUNT != 1 )
+    #error "Configuration error: REDCONF_FAST_MOUNT must be either 0 or 1."
+#endif
+
+#if REDCONF_INODE_CACHE_ENTRIES > 255U
+    #error "Configuration error: REDCONF_INODE_CACHE_ENTRIES cannot be greater than 255"
+#endif
+
 /*  REDCONF_BUFFER_COUNT lower limit checked in buffer.c
  */
 #if REDCONF_BUFFER_COUNT > 255U
     #error "REDCONF_BUFFER_COUNT cannot be greater than 255"
 #endif
 
+#if ( REDCONF_BUFFER_HASH != 0 ) && ( REDCONF_BUFFER_HASH != 1 )
+    #error "Configuration error: REDCONF_BUFFER_HASH must be either 0 or 1."
+#endif
+
+#if REDCONF_BUFFER_META_RESERVE >= REDCONF_BUFFER_COUNT
+    #error "Configuration error: REDCONF_BUFFER_META_RESERVE must be less than REDCONF_BUFFER_COUNT"
+#endif
+
+#if ( REDCONF_BUFFER_VOL_RESERVE != 0 ) && ( REDCONF_BUFFER_VOL_RESERVE != 1 )
+    #error "Configuration error: REDCONF_BUFFER_VOL_RESERVE must be either 0 or 1."
+#endif
+
+#if ( REDCONF_READAHEAD_BLOCKS == 1U ) || ( REDCONF_READAHEAD_BLOCKS > ( REDCONF_BUFFER_COUNT / 2U ) )
+    #error "Configuration error: REDCONF_READAHEAD_BLOCKS must be zero or between 2 and half of REDCONF_BUFFER_COUNT"
+#endif
+
+#if ( REDCONF_READAHEAD_STREAMS < 1U ) || ( REDCONF_READAHEAD_STREAMS > 255U )
+    #error "Configuration error: invalid value of REDCONF_READAHEAD_STREAMS"
+#endif
+
+#if ( REDCONF_FLUSH_COALESCE_BLOCKS == 1U ) || ( REDCONF_FLUSH_COALESCE_BLOCKS > REDCONF_BUFFER_COUNT )
+    #error "Configuration error: REDCONF_FLUSH_COALESCE_BLOCKS must be zero or between 2 and REDCONF_BUFFER_COUNT"
+#endif
+
+#if ( REDCONF_IMAP_SUMMARY != 0 ) && ( REDCONF_IMAP_SUMMARY != 1 )
+    #error "Configuration error: REDCONF_IMAP_SUMMARY must be either 0 or 1."
+#endif
+
+#if ( REDCONF_IMAP_LAZY_FORMAT != 0 ) && ( REDCONF_IMAP_LAZY_FORMAT != 1 )
+    #error "Configuration error: REDCONF_IMAP_LAZY_FORMAT must be either 0 or 1."
+#endif
+
+#if ( REDCONF_IMAP_LAZY_FORMAT == 1 ) && ( REDCONF_IMAP_EXTERNAL == 0 )
+    #error "Configuration error: REDCONF_IMAP_LAZY_FORMAT requires REDCONF_IMAP_EXTERNAL"
+#endif
+
+#if ( REDCONF_MEM_WORD_ACCESS != 0 ) && ( REDCONF_MEM_WORD_ACCESS != 1 )
+    #error "Configuration error: REDCONF_MEM_WORD_ACCESS must be either 0 or 1."
+#endif
+
+#if ( REDCONF_CRC_BENCHMARK != 0 ) && ( REDCONF_CRC_BENCHMARK != 1 )
+    #error "Configuration error: REDCONF_CRC_BENCHMARK must be either 0 or 1."
+#endif
+
+#if ( REDCONF_DIR_INDEX_DIRS > 0U ) && ( ( REDCONF_DIR_INDEX_SLOTS < 4U ) || ( ( REDCONF_DIR_INDEX_SLOTS & ( REDCONF_DIR_INDEX_SLOTS - 1U ) ) != 0U ) )
+    #error "Configuration error: REDCONF_DIR_INDEX_SLOTS must be a power of two and at least 4"
+#endif
+
+#if REDCONF_PATH_CACHE_ENTRIES > 255U
+    #error "Configuration error: REDCONF_PATH_CACHE_ENTRIES cannot be greater than 255"
+#endif
+
+#if ( REDCONF_LOCK_PER_VOLUME != 0 ) && ( REDCONF_LOCK_PER_VOLUME != 1 )
+    #error "Configuration error: REDCONF_LOCK_PER_VOLUME must be either 0 or 1."
+#endif
+
+#if ( REDCONF_LOCK_PER_VOLUME == 1 ) && ( ( REDCONF_API_POSIX == 0 ) || ( REDCONF_API_FSE == 1 ) || ( REDCONF_TASK_COUNT < 2U ) || ( REDCONF_VOLUME_COUNT < 2U ) )
+    #error "Configuration error: REDCONF_LOCK_PER_VOLUME requires the POSIX API alone, REDCONF_TASK_COUNT > 1, and REDCONF_VOLUME_COUNT > 1"
+#endif
+
+#if ( REDCONF_LOCK_SHARED_READERS > 0U ) && ( REDCONF_LOCK_PER_VOLUME == 0 )
+    #error "Configuration error: REDCONF_LOCK_SHARED_READERS requires REDCONF_LOCK_PER_VOLUME"
+#endif
+
+#if ( REDCONF_LOCK_SHARED_READERS == 1U ) || ( REDCONF_LOCK_SHARED_READERS > REDCONF_TASK_COUNT )
+    #error "Configuration error: REDCONF_LOCK_SHARED_READERS must be zero, or between 2 and REDCONF_TASK_COUNT"
+#endif
+
+#if ( REDCONF_LOCK_SHARED_READERS > 0U ) && ( REDCONF_ATIME == 1 ) && ( REDCONF_READ_ONLY == 0 )
+    #error "Configuration error: REDCONF_LOCK_SHARED_READERS cannot be used with REDCONF_ATIME, since reading updates the access time"
+#endif
+
+#if ( REDCONF_READBUF_COUNT > 0U ) && ( REDCONF_API_POSIX == 0 )
+    #error "Configuration error: REDCONF_READBUF_COUNT requires the POSIX API"
+#endif
+
+#if REDCONF_READBUF_COUNT > 64U
+    #error "Configuration error: REDCONF_READBUF_COUNT cannot be greater than 64"
+#endif
+
+#if ( REDCONF_TRANSACT_TASK != 0 ) && ( REDCONF_TRANSACT_TASK != 1 )
+    #error "Configuration error: REDCONF_TRANSACT_TASK must be either 0 or 1."
+#endif
+
+#if ( REDCONF_TRANSACT_TASK == 1 ) && ( ( REDCONF_API_POSIX == 0 ) || ( REDCONF_READ_ONLY == 1 ) || ( REDCONF_TASK_COUNT < 2U ) )
+    #error "Configuration error: REDCONF_TRANSACT_TASK requires the POSIX API, REDCONF_READ_ONLY == 0, and REDCONF_TASK_COUNT > 1"
+#endif
+
+#if ( REDCONF_TRANSACT_TASK == 1 ) && ( REDCONF_TRANSACT_TASK_PERIOD_MS == 0U )
+    #error "Configuration error: REDCONF_TRANSACT_TASK_PERIOD_MS must be nonzero"
+#endif
+
+#if ( REDCONF_STATS != 0 ) && ( REDCONF_STATS != 1 )
+    #error "Configuration error: REDCONF_STATS must be either 0 or 1."
+#endif
+
+#if ( REDCONF_STATS == 1 ) && ( REDCONF_API_POSIX == 0 )
+    #error "Configuration error: REDCONF_STATS requires the POSIX API"
+#endif
+
+#if ( REDCONF_LATENCY_STATS != 0 ) && ( REDCONF_LATENCY_STATS != 1 )
+    #error "Configuration error: REDCONF_LATENCY_STATS must be either 0 or 1."
+#endif
+
+#if ( REDCONF_LATENCY_STATS == 1 ) && ( REDCONF_API_POSIX == 0 )
+    #error "Configuration error: REDCONF_LATENCY_STATS requires the POSIX API"
+#endif
+
+#if REDCONF_TRANSACT_TASK_DIRTY_BUFFERS > REDCONF_BUFFER_COUNT
+    #error "Configuration error: REDCONF_TRANSACT_TASK_DIRTY_BUFFERS cannot be greater than REDCONF_BUFFER_COUNT"
+#endif
+
+#if ( REDCONF_WRITE_BEHIND_BYTES > 0U ) && ( ( REDCONF_API_POSIX == 0 ) || ( REDCONF_READ_ONLY == 1 ) || ( REDCONF_TASK_COUNT < 2U ) || ( REDCONF_LOCK_PER_VOLUME == 1 ) )
+    #error "Configuration error: REDCONF_WRITE_BEHIND_BYTES requires the POSIX API, REDCONF_READ_ONLY == 0, REDCONF_TASK_COUNT > 1, and REDCONF_LOCK_PER_VOLUME == 0"
+#endif
+
+#if REDCONF_WRITE_BEHIND_BYTES > 0x7FFFFFFFU
+    #error "Configuration error: REDCONF_WRITE_BEHIND_BYTES cannot be greater than INT32_MAX"
+#endif
+
+#if ( REDCONF_WRITE_BEHIND_BYTES > 0U ) && ( ( REDCONF_WRITE_BEHIND_ENTRIES == 0U ) || ( REDCONF_WRITE_BEHIND_ENTRIES > 255U ) )
+    #error "Configuration error: REDCONF_WRITE_BEHIND_ENTRIES must be between 1 and 255"
+#endif
+
+#if ( REDCONF_INTENT_LOG_BLOCKS > 0U ) && ( ( REDCONF_API_POSIX == 0 ) || ( REDCONF_READ_ONLY == 1 ) )
+    #error "Configuration error: REDCONF_INTENT_LOG_BLOCKS requires the POSIX API and REDCONF_READ_ONLY == 0"
+#endif
+
+#if REDCONF_BDEV_ASYNC_DEPTH > REDCONF_BUFFER_COUNT
+    #error "Configuration error: REDCONF_BDEV_ASYNC_DEPTH must be less than or equal to REDCONF_BUFFER_COUNT"
+#endif
+
+#if ( REDCONF_BDEV_XIP != 0 ) && ( REDCONF_BDEV_XIP != 1 )
+    #error "Configuration error: REDCONF_BDEV_XIP must be either 0 or 1."
+#endif
+
+#if ( REDCONF_BDEV_XIP == 1 ) && ( REDCONF_READ_ONLY == 0 )
+    #error "Configuration error: REDCONF_BDEV_XIP requires REDCONF_READ_ONLY == 1"
+#endif
+
+#if ( REDCONF_BDEV_RAM_ALIAS != 0 ) && ( REDCONF_BDEV_RAM_ALIAS != 1 )
+    #error "Configuration error: REDCONF_BDEV_RAM_ALIAS must be either 0 or 1."
+#endif
+
+#if ( REDCONF_BDEV_RAM_ALIAS == 1 ) && ( REDCONF_READ_ONLY == 1 )
+    #error "Configuration error: REDCONF_BDEV_RAM_ALIAS requires REDCONF_READ_ONLY == 0"
+#endif
+
+#if ( REDCONF_INODE_INLINE != 0 ) && ( REDCONF_INODE_INLINE != 1 )
+    #error "Configuration error: REDCONF_INODE_INLINE must be either 0 or 1."
+#endif
+
+#if ( REDCONF_INODE_INLINE == 1 ) && ( REDCONF_DIRECT_POINTERS == 0U )
+    #error "Configuration error: REDCONF_INODE_INLINE requires REDCONF_DIRECT_POINTERS > 0"
+#endif
+
+#if ( REDCONF_INODE_INLINE == 1 ) && defined( REDCONF_ENDIAN_SWAP )
+    #error "Configuration error: REDCONF_INODE_INLINE cannot be used with REDCONF_ENDIAN_SWAP"
+#endif
+
 #if ( REDCONF_IMAGE_BUILDER != 0 ) && ( REDCONF_IMAGE_BUILDER != 1 )
     #error "Configuration error: REDCONF_IMAGE_BUILDER must be either 0 or 1."
 #endif
@@ -343,9 +888,4 @@
 #endif
 
 
-#if ( REDCONF_DISCARDS == 1 ) && ( RED_KIT == RED_KIT_GPL )
-    #error "REDCONF_DISCARDS not supported in Reliance Edge under GPL. Contact sales@datalight.com to upgrade."
-#endif
-
-
 #endif /* ifndef REDCONFIGCHK_H */
@@ -31,6 +31,25 @@
 
 
 #include <redstat.h>
+#if REDCONF_API_FSE == 1
+    #include <redfse.h>
+#endif
+
+
+#if REDCONF_READAHEAD_BLOCKS > 0U
+
+/** @brief Read-ahead statistics.
+ *
+ *  The read-ahead hit rate is ulHits divided by ulBlocks.
+ */
+    typedef struct
+    {
+        uint32_t ulSeqReads; /**< Reads which continued a sequential stream. */
+        uint32_t ulRequests; /**< Read-ahead device requests issued. */
+        uint32_t ulBlocks;   /**< Blocks read ahead of the reader. */
+        uint32_t ulHits;     /**< Reads of blocks which had been read ahead. */
+    } REDRASTATS;
+#endif
 
 
 REDSTATUS RedCoreInit( void );
@@ -49,6 +68,13 @@ REDSTATUS RedCoreVolUnmount( void );
 #if REDCONF_READ_ONLY == 0
     REDSTATUS RedCoreVolTransact( void );
 #endif
+#if REDCONF_TRANSACT_TASK == 1
+    REDSTATUS RedCoreVolTransactPolicy( uint32_t ulElapsedMs );
+#endif
+#if REDCONF_STATS == 1
+    REDSTATUS RedCoreVolStats( REDVOLSTATS * pStats,
+                               bool fReset );
+#endif
 #if REDCONF_API_POSIX == 1
     REDSTATUS RedCoreVolStat( REDSTATFS * pStatFS );
 #endif
@@ -99,17 +125,60 @@ REDSTATUS RedCoreFileRead( uint32_t ulInode,
                            uint64_t ullStart,
                            uint32_t * pulLen,
                            void * pBuffer );
+#if REDCONF_READBUF_COUNT > 0U
+    REDSTATUS RedCoreFileLend( uint32_t ulInode,
+                               uint64_t ullStart,
+                               uint32_t * pulLen,
+                               const uint8_t ** ppbBlock,
+                               const uint8_t ** ppbData );
+    void RedCoreFileReturn( const uint8_t * pbBlock );
+#endif
+#if ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_IOVEC == 1 )
+    REDSTATUS RedCoreFileReadV( uint32_t ulInode,
+                                uint64_t ullStart,
+                                const REDFSEIOVEC * pIov,
+                                uint32_t ulIovCount,
+                                uint32_t * pulLen );
+#endif
 #if REDCONF_READ_ONLY == 0
     REDSTATUS RedCoreFileWrite( uint32_t ulInode,
                                 uint64_t ullStart,
                                 uint32_t * pulLen,
                                 const void * pBuffer );
 #endif
+#if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_IOVEC == 1 )
+    REDSTATUS RedCoreFileWriteV( uint32_t ulInode,
+                                 uint64_t ullStart,
+                                 const REDFSEIOVEC * pIov,
+                                 uint32_t ulIovCount,
+                                 uint32_t * pulLen );
+#endif
+#if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )
+    REDSTATUS RedCoreFileSync( uint32_t ulInode );
+#endif
+#if COPY_SUPPORTED
+    REDSTATUS RedCoreFileCopy( uint32_t ulSrcInode,
+                               uint64_t ullSrcStart,
+                               uint32_t ulDstInode,
+                               uint64_t ullDstStart,
+                               uint32_t * pulLen );
+#endif
 #if TRUNCATE_SUPPORTED
     REDSTATUS RedCoreFileTruncate( uint32_t ulInode,
                                    uint64_t ullSize );
 #endif
 
+#if FALLOCATE_SUPPORTED
+    REDSTATUS RedCoreFileAllocate( uint32_t ulInode,
+                                   uint64_t ullStart,
+                                   uint64_t ullLen );
+#endif
+
+#if REDCONF_READAHEAD_BLOCKS > 0U
+    REDSTATUS RedCoreReadAheadStats( REDRASTATS * pStats,
+                                     bool fReset );
+#endif
+
 #if ( REDCONF_API_POSIX == 1 ) && ( REDCONF_API_POSIX_READDIR == 1 )
     REDSTATUS RedCoreDirRead( uint32_t ulInode,
                               uint32_t * pulPos,
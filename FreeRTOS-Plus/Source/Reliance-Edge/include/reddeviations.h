@@ -223,4 +223,59 @@
 #define IS_ALIGNED_PTR( ptr )    ( ( ( uintptr_t ) ( ptr ) & ( REDCONF_ALIGNMENT_SIZE - 1U ) ) == 0U )
 
 
+/** @brief Determine the offset of a pointer from the previous 32-bit boundary.
+ *
+ *  This is used by the word-at-a-time memory functions in memory.c, which need
+ *  to know whether two buffers can be brought to 32-bit alignment together.
+ *
+ *  Usage of this macro deviates from MISRA C:2012 Rule 11.4 (advisory), for
+ *  the same reasons as IS_ALIGNED_PTR().  As Rule 11.4 is advisory, a
+ *  deviation record is not required.  This notice is the only record of the
+ *  deviation.
+ */
+#define WORD_OFFSET_PTR( ptr )    ( ( uint32_t ) ( ( uintptr_t ) ( ptr ) & ( sizeof( uint32_t ) - 1U ) ) )
+
+
+/** @brief Cast a pointer to a uint32_t pointer.
+ *
+ *  Usages of this macro may deviate from MISRA C:2012 Rule 11.5 (advisory)
+ *  and Rule 11.3 (required), like CAST_CONST_UINT32_PTR().  It is only used by
+ *  the word-at-a-time memory functions, on pointers which have been checked to
+ *  be 32-bit aligned.
+ *
+ *  As Rule 11.3 is required, a separate deviation record is required.
+ */
+#define CAST_VOID_PTR_TO_UINT32_PTR( PTR )    ( ( uint32_t * ) ( void * ) ( PTR ) )
+
+
+/** @brief Determine whether a pointer is within a memory range.
+ *
+ *  This is used to tell whether a block pointer refers to a memory-mapped
+ *  block device rather than to a block buffer.  The pointer and the range are
+ *  not necessarily part of the same object, so a relational comparison of the
+ *  pointers would be undefined behavior (and would deviate from MISRA C:2012
+ *  Rule 18.3 (required)); the addresses are compared as integers instead.
+ *
+ *  Usage of this macro deviates from MISRA C:2012 Rule 11.4 (advisory), for
+ *  the same reasons as IS_ALIGNED_PTR().  As Rule 11.4 is advisory, a
+ *  deviation record is not required.  This notice is the only record of the
+ *  deviation.
+ */
+#define PTR_IN_RANGE( ptr, base, len ) \
+    ( ( ( uintptr_t ) ( ptr ) >= ( uintptr_t ) ( base ) ) && ( ( ( uintptr_t ) ( ptr ) - ( uintptr_t ) ( base ) ) < ( len ) ) )
+
+
+/** @brief Cast away the const qualifier of a uint8_t pointer.
+ *
+ *  Usages of this macro deviate from MISRA C:2012 Rule 11.8 (required).  It is
+ *  only used to return blocks of a memory-mapped, read-only volume through
+ *  the buffer interface, which takes non-const pointers.  With
+ *  REDCONF_READ_ONLY, nothing writes to a buffer after it has been read, so
+ *  the mapped memory is never modified.
+ *
+ *  As Rule 11.8 is required, a separate deviation record is required.
+ */
+#define CAST_AWAY_CONST_UINT8_PTR( PTR )    ( ( uint8_t * ) ( PTR ) )
+
+
 #endif /* ifndef REDDEVIATIONS_H */
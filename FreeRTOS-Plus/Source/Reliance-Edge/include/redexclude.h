@@ -44,6 +44,18 @@
         && ( ( ( REDCONF_API_POSIX == 1 ) && ( REDCONF_API_POSIX_FTRUNCATE == 1 ) ) \
              || ( ( REDCONF_API_FSE == 1 ) && ( REDCONF_API_FSE_TRUNCATE == 1 ) ) ) )
 
+#define FALLOCATE_SUPPORTED                           \
+    (                                                 \
+        ( REDCONF_READ_ONLY == 0 )                    \
+        && ( REDCONF_API_POSIX == 1 )                 \
+        && ( REDCONF_API_POSIX_FALLOCATE == 1 ) )
+
+#define COPY_SUPPORTED                            \
+    (                                             \
+        ( REDCONF_READ_ONLY == 0 )                \
+        && ( REDCONF_API_POSIX == 1 )             \
+        && ( REDCONF_API_POSIX_COPY == 1 ) )
+
 #define FORMAT_SUPPORTED                                                         \
     (                                                                            \
         ( REDCONF_READ_ONLY == 0 )                                               \
@@ -71,6 +71,18 @@
         #define RED_FILENUM_FIRST_VALID    ( 2U )
 
 
+        #if REDCONF_API_FSE_IOVEC == 1
+
+/** @brief One buffer of a RedFseReadV() or RedFseWriteV() request.
+ */
+            typedef struct
+            {
+                void * pBuffer;    /**< The data; only read from by RedFseWriteV(). */
+                uint32_t ulLength; /**< The number of bytes in the buffer. */
+            } REDFSEIOVEC;
+        #endif
+
+
         REDSTATUS RedFseInit( void );
         REDSTATUS RedFseUninit( void );
         REDSTATUS RedFseMount( uint8_t bVolNum );
@@ -90,6 +102,20 @@
                                  uint32_t ulLength,
                                  const void * pBuffer );
         #endif
+        #if REDCONF_API_FSE_IOVEC == 1
+            int32_t RedFseReadV( uint8_t bVolNum,
+                                 uint32_t ulFileNum,
+                                 uint64_t ullFileOffset,
+                                 const REDFSEIOVEC * pIov,
+                                 uint32_t ulIovCount );
+        #endif
+        #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_FSE_IOVEC == 1 )
+            int32_t RedFseWriteV( uint8_t bVolNum,
+                                  uint32_t ulFileNum,
+                                  uint64_t ullFileOffset,
+                                  const REDFSEIOVEC * pIov,
+                                  uint32_t ulIovCount );
+        #endif
         #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_FSE_TRUNCATE == 1 )
             REDSTATUS RedFseTruncate( uint8_t bVolNum,
                                       uint32_t ulFileNum,
@@ -85,6 +85,7 @@
 #endif /* if   REDCONF_BLOCK_SIZE == 256U */
 
 #define REDMIN( a, b )    ( ( ( a ) < ( b ) ) ? ( a ) : ( b ) )
+#define REDMAX( a, b )    ( ( ( a ) > ( b ) ) ? ( a ) : ( b ) )
 
 #define INODE_INVALID        ( 0U )                /* General-purpose invalid inode number (must be zero). */
 #define INODE_FIRST_VALID    ( 2U )                /* First valid inode number. */
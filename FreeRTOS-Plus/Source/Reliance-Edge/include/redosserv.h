@@ -56,8 +56,61 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
                               uint32_t ulSectorCount,
                               const void * pBuffer );
     REDSTATUS RedOsBDevFlush( uint8_t bVolNum );
+    #if REDCONF_DISCARDS == 1
+        REDSTATUS RedOsBDevDiscard( uint8_t bVolNum,
+                                    uint64_t ullSectorStart,
+                                    uint64_t ullSectorCount );
+    #endif
 #endif
 
+#if REDCONF_BDEV_XIP == 1
+    const void * RedOsBDevMap( uint8_t bVolNum );
+#endif
+
+#if REDCONF_BDEV_RAM_ALIAS == 1
+    void * RedOsBDevAlias( uint8_t bVolNum );
+#endif
+
+#if REDCONF_BDEV_ASYNC_DEPTH > 0U
+
+/** @brief An asynchronous block device request.
+ *
+ *  The caller fills in the fields up to and including pContext and passes the
+ *  request to RedOsBDevSubmit().  The request, and the buffer it refers to,
+ *  must remain valid and unmodified until RedOsBDevWait() has returned.
+ */
+    typedef struct sBDEVREQ BDEVREQ;
+
+/** @brief Completion callback for an asynchronous block device request.
+ *
+ *  Called once the transfer has finished, possibly from interrupt context.
+ */
+    typedef void ( * BDEVCOMPLETE )( BDEVREQ * pReq );
+
+    struct sBDEVREQ
+    {
+        uint64_t ullSectorStart;   /**< The starting sector number. */
+        uint32_t ulSectorCount;    /**< The number of sectors to transfer. */
+        void * pBuffer;            /**< The buffer to read into or write from. */
+        bool fWrite;               /**< Whether the request is a write. */
+        BDEVCOMPLETE pfnComplete;  /**< Optional completion callback, or `NULL`. */
+        void * pContext;           /**< Caller context for the completion callback. */
+
+        /*  The fields below are owned by the block device while the request is
+         *  in flight.
+         */
+        void * pWaiter;            /**< Task waiting for the request to complete. */
+        volatile REDSTATUS status; /**< Result of the transfer. */
+        volatile bool fDone;       /**< Whether the transfer has completed. */
+    };
+
+    REDSTATUS RedOsBDevSubmit( uint8_t bVolNum,
+                               BDEVREQ * pReq );
+    REDSTATUS RedOsBDevWait( BDEVREQ * pReq );
+    void RedOsBDevComplete( BDEVREQ * pReq,
+                            REDSTATUS status );
+#endif /* REDCONF_BDEV_ASYNC_DEPTH > 0U */
+
 /*  Non-standard API: for host machines only.
  */
 REDSTATUS RedOsBDevConfig( uint8_t bVolNum,
@@ -69,9 +122,46 @@ REDSTATUS RedOsBDevConfig( uint8_t bVolNum,
     REDSTATUS RedOsMutexUninit( void );
     void RedOsMutexAcquire( void );
     void RedOsMutexRelease( void );
+    #if REDCONF_LOCK_PER_VOLUME == 1
+        void RedOsVolMutexAcquire( uint8_t bVolNum,
+                                   bool fShared );
+        bool RedOsVolMutexTryAcquire( uint8_t bVolNum,
+                                      bool fShared );
+        void RedOsVolMutexRelease( uint8_t bVolNum,
+                                   bool fShared );
+        void RedOsBDevMutexAcquire( uint8_t bVolNum );
+        void RedOsBDevMutexRelease( uint8_t bVolNum );
+    #endif
 #endif
 #if ( REDCONF_TASK_COUNT > 1U ) && ( REDCONF_API_POSIX == 1 )
     uint32_t RedOsTaskId( void );
+    REDSTATUS RedOsWorkerTasksRun( uint32_t ulCount,
+                                   void ( * pfnWork )( uint32_t ulIndex ) );
+#endif
+#if REDCONF_TRANSACT_TASK == 1
+    REDSTATUS RedOsTransactTaskStart( void ( * pfnPoll )( void ) );
+    void RedOsTransactTaskStop( void );
+#endif
+#if REDCONF_WRITE_BEHIND_BYTES > 0U
+    REDSTATUS RedOsWriteBehindTaskStart( void ( * pfnWork )( void ) );
+    void RedOsWriteBehindTaskStop( void );
+    void RedOsWriteBehindSignal( void );
+#endif
+#if REDCONF_FAST_MOUNT == 1
+
+/** @brief Names the metaroot which was committed last on a volume.
+ */
+    typedef struct
+    {
+        uint64_t ullSequence; /**< Sequence number of the metaroot. */
+        uint32_t ulCRC;       /**< Metadata CRC of the metaroot, as stored on disk. */
+        uint8_t bMR;          /**< Which metaroot (0 or 1) it was written to. */
+    } REDMOUNTHINT;
+
+    bool RedOsMountHintLoad( uint8_t bVolNum,
+                             REDMOUNTHINT * pHint );
+    void RedOsMountHintStore( uint8_t bVolNum,
+                              const REDMOUNTHINT * pHint );
 #endif
 
 REDSTATUS RedOsClockInit( void );
@@ -83,6 +173,19 @@ REDSTATUS RedOsTimestampUninit( void );
 REDTIMESTAMP RedOsTimestamp( void );
 uint64_t RedOsTimePassed( REDTIMESTAMP tsSince );
 
+#if REDCONF_CRC_ALGORITHM == CRC_HARDWARE
+    bool RedOsCrc32Update( uint32_t ulInitCrc32,
+                           const void * pBuffer,
+                           uint32_t ulLength,
+                           uint32_t * pulCrc32 );
+#endif
+
+#if REDCONF_MEMCPY_HOOK_THRESHOLD > 0U
+    bool RedOsMemCpy( void * pDest,
+                      const void * pSrc,
+                      uint32_t ulLen );
+#endif
+
 #if REDCONF_OUTPUT == 1
     void RedOsOutputString( const char * pszString );
 #endif
@@ -39,6 +39,16 @@ REDSTATUS RedPathLookup( const char * pszLocalPath,
 REDSTATUS RedPathToName( const char * pszLocalPath,
                          uint32_t * pulPInode,
                          const char ** ppszName );
+REDSTATUS RedPathLookupName( uint32_t ulPInode,
+                             const char * pszName,
+                             uint32_t * pulInode );
+#if REDCONF_PATH_CACHE_ENTRIES > 0U
+    void RedPathCacheRemove( uint32_t ulPInode,
+                             const char * pszName );
+    void RedPathCacheDiscard( uint8_t bVolNum );
+    void RedPathCacheStats( REDPATHCACHESTATS * pStats,
+                            bool fReset );
+#endif
 
 
 #endif /* ifndef REDPATH_H */
@@ -136,6 +136,109 @@
         #endif /* if REDCONF_API_POSIX_READDIR == 1 */
 
 
+        #if REDCONF_PATH_CACHE_ENTRIES > 0U
+
+/** @brief Path component cache statistics.
+ */
+            typedef struct
+            {
+                uint32_t ulHits;   /**< Name lookups satisfied by the cache. */
+                uint32_t ulMisses; /**< Name lookups which had to search the directory. */
+            } REDPATHCACHESTATS;
+        #endif
+
+
+        #if REDCONF_WRITE_BEHIND_BYTES > 0U
+
+/** @brief Write-behind queue statistics.
+ */
+            typedef struct
+            {
+                uint32_t ulWrites;   /**< Writes queued, counting each piece of a write larger than the ring. */
+                uint32_t ulStalls;   /**< Writes which found the ring full, and finished the queued writes first. */
+                uint32_t ulDepth;    /**< Writes queued now. */
+                uint32_t ulMaxDepth; /**< Most writes queued at once. */
+                uint32_t ulMaxBytes; /**< Most bytes of the ring in use at once. */
+            } REDWBSTATS;
+        #endif
+
+
+        #if ( REDCONF_STATS == 1 ) && ( REDCONF_TASK_COUNT > 1U )
+
+/** @brief Lock contention statistics.
+ *
+ *  Wait times are measured with RedOsTimestamp(), so waits shorter than its
+ *  resolution count as zero; over many calls, the totals still show how much
+ *  time the tasks spend waiting for each other.
+ */
+            typedef struct
+            {
+                uint32_t ulEnters;               /**< Calls which acquired the FS mutex on entry to the driver. */
+                uint32_t ulEnterWaits;           /**< Those calls which waited a measurable time for the FS mutex. */
+                uint64_t ullEnterWaitMicrosec;   /**< Total time spent waiting for the FS mutex on entry. */
+                uint32_t ulEnterWaitMaxMicrosec; /**< Longest wait for the FS mutex on entry. */
+                uint32_t ulVolWaits;             /**< Calls which found their volume locked by another task; zero unless REDCONF_LOCK_PER_VOLUME is 1. */
+                uint64_t ullVolWaitMicrosec;     /**< Total time spent waiting for volume locks. */
+            } REDLOCKSTATS;
+        #endif
+
+
+        #if REDCONF_LATENCY_STATS == 1
+
+/** Index of the red_open() histogram in ::REDLATSTATS. */
+            #define RED_LATOP_OPEN        0U
+
+/** Index of the red_read() histogram in ::REDLATSTATS. */
+            #define RED_LATOP_READ        1U
+
+/** Index of the red_write() histogram in ::REDLATSTATS. */
+            #define RED_LATOP_WRITE       2U
+
+/** Index of the red_transact() histogram in ::REDLATSTATS. */
+            #define RED_LATOP_TRANSACT    3U
+
+/** Index of the red_unlink() histogram in ::REDLATSTATS. */
+            #define RED_LATOP_UNLINK      4U
+
+/** Index of the red_readdir() and red_readdirmulti() histogram in
+ *  ::REDLATSTATS.  A red_readdirmulti() call is one sample, however many
+ *  entries it reads. */
+            #define RED_LATOP_READDIR     5U
+
+/** Number of histograms in ::REDLATSTATS. */
+            #define RED_LATOP_COUNT       6U
+
+/** Number of buckets in a latency histogram.  Bucket zero counts calls which
+ *  took less than a microsecond, and bucket n counts calls which took at least
+ *  2^(n-1) and less than 2^n microseconds; the last bucket also counts all
+ *  longer calls.
+ */
+            #define RED_LAT_BUCKETS       24U
+
+/** @brief Latency histogram for one kind of call.
+ *
+ *  Latencies are measured with RedOsTimestamp() from entry to the call until
+ *  it leaves the driver, so they include waits for other tasks.  Calls which
+ *  fail before entering the driver, such as for invalid arguments, are not
+ *  counted.
+ */
+            typedef struct
+            {
+                uint32_t ulCalls;                       /**< Calls counted. */
+                uint32_t ulMaxMicrosec;                 /**< Longest call. */
+                uint64_t ullTotalMicrosec;              /**< Total time spent in the calls. */
+                uint32_t aulBuckets[ RED_LAT_BUCKETS ]; /**< Calls counted in each log2 bucket. */
+            } REDLATHIST;
+
+/** @brief Latency histograms for the timed calls, indexed by RED_LATOP_*.
+ */
+            typedef struct
+            {
+                REDLATHIST aOp[ RED_LATOP_COUNT ];
+            } REDLATSTATS;
+        #endif /* REDCONF_LATENCY_STATS == 1 */
+
+
         int32_t red_init( void );
         int32_t red_uninit( void );
         int32_t red_mount( const char * pszVolume );
@@ -154,6 +257,11 @@
                                   uint32_t * pulEventMask );
         int32_t red_statvfs( const char * pszVolume,
                              REDSTATFS * pStatvfs );
+        #if REDCONF_STATS == 1
+            int32_t red_getstats( const char * pszVolume,
+                                  REDVOLSTATS * pStats,
+                                  bool fReset );
+        #endif
         int32_t red_open( const char * pszPath,
                           uint32_t ulOpenMode );
         #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_UNLINK == 1 )
@@ -177,11 +285,22 @@
         int32_t red_read( int32_t iFildes,
                           void * pBuffer,
                           uint32_t ulLength );
+        #if REDCONF_READBUF_COUNT > 0U
+            int32_t red_readbuf( int32_t iFildes,
+                                 const void ** ppData,
+                                 uint32_t ulLength );
+            int32_t red_releasebuf( const void * pData );
+        #endif
         #if REDCONF_READ_ONLY == 0
             int32_t red_write( int32_t iFildes,
                                const void * pBuffer,
                                uint32_t ulLength );
         #endif
+        #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_COPY == 1 )
+            int32_t red_copy( int32_t iSrcFildes,
+                              int32_t iDstFildes,
+                              uint32_t ulLength );
+        #endif
         #if REDCONF_READ_ONLY == 0
             int32_t red_fsync( int32_t iFildes );
         #endif
@@ -192,15 +311,44 @@
             int32_t red_ftruncate( int32_t iFildes,
                                    uint64_t ullSize );
         #endif
+        #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_FALLOCATE == 1 )
+            int32_t red_fallocate( int32_t iFildes,
+                                   uint64_t ullOffset,
+                                   uint64_t ullLen );
+        #endif
         int32_t red_fstat( int32_t iFildes,
                            REDSTAT * pStat );
         #if REDCONF_API_POSIX_READDIR == 1
             REDDIR * red_opendir( const char * pszPath );
             REDDIRENT * red_readdir( REDDIR * pDirStream );
+            int32_t red_readdirmulti( REDDIR * pDirStream,
+                                      REDDIRENT * pEntries,
+                                      uint32_t ulCount );
             void red_rewinddir( REDDIR * pDirStream );
             int32_t red_closedir( REDDIR * pDirStream );
         #endif
+        #if REDCONF_PATH_CACHE_ENTRIES > 0U
+            int32_t red_pathcachestats( REDPATHCACHESTATS * pStats,
+                                        bool fReset );
+        #endif
+        #if REDCONF_WRITE_BEHIND_BYTES > 0U
+            int32_t red_writebehindstats( REDWBSTATS * pStats,
+                                          bool fReset );
+        #endif
+        #if ( REDCONF_STATS == 1 ) && ( REDCONF_TASK_COUNT > 1U )
+            int32_t red_lockstats( REDLOCKSTATS * pStats,
+                                   bool fReset );
+        #endif
         REDSTATUS * red_errnoptr( void );
+        #if REDCONF_LATENCY_STATS == 1
+            int32_t red_latencystats( REDLATSTATS * pStats,
+                                      bool fReset );
+            uint32_t red_latencypercentile( const REDLATHIST * pHist,
+                                            uint32_t ulPermille );
+        #endif
+        #if REDCONF_TASK_COUNT > 1U
+            int32_t red_taskrelease( void );
+        #endif
 
     #endif /* REDCONF_API_POSIX */
 
@@ -92,4 +92,37 @@ typedef struct
 } REDSTATFS;
 
 
+#if REDCONF_STATS == 1
+
+/** @brief I/O and cache statistics for a file system volume.
+ *
+ *  Counts are kept from driver initialization, or from the last time they were
+ *  reset, and are not stored on disk.
+ */
+    typedef struct
+    {
+        uint32_t ulBufferHits;          /**< Block lookups satisfied by a buffer. */
+        uint32_t ulBufferMisses;        /**< Block lookups which read the block from disk. */
+        uint32_t ulBufferWritebacks;    /**< Dirty buffers written out to make room for another block. */
+        uint32_t ulReadAheadBlocks;     /**< Blocks read into the buffers before they were needed. */
+        uint32_t ulReadRequests;        /**< Block device read requests. */
+        uint64_t ullSectorsRead;        /**< Sectors read from the block device. */
+        uint32_t ulWriteRequests;       /**< Block device write requests. */
+        uint64_t ullSectorsWritten;     /**< Sectors written to the block device. */
+        uint32_t ulFlushRequests;       /**< Block device flush requests. */
+        uint32_t ulDiscardRequests;     /**< Block device discard requests; zero unless REDCONF_DISCARDS is 1. */
+        uint64_t ullSectorsDiscarded;   /**< Sectors passed to those discard requests. */
+        uint32_t ulTransactions;        /**< Transaction points committed. */
+        uint64_t ullTransactMicrosec;   /**< Total time spent committing transaction points. */
+        uint32_t ulTransactMaxMicrosec; /**< Longest time spent committing a transaction point. */
+        uint32_t ulAllocSearches;       /**< Searches of the imap for a free block. */
+        uint64_t ullAllocScanBlocks;    /**< Total in-use blocks passed over by those searches. */
+        uint32_t ulAllocScanMax;        /**< Most in-use blocks passed over by one search. */
+        uint32_t ulBuffersHeld;         /**< Buffers holding blocks of the volume when queried; not reset. */
+        uint32_t ulBuffersLost;         /**< Buffers of the volume replaced by blocks of other volumes. */
+        uint32_t ulReserveOverruns;     /**< Of those, buffers taken although the volume held no more than its reserve; zero unless REDCONF_BUFFER_VOL_RESERVE is 1. */
+    } REDVOLSTATS;
+#endif /* REDCONF_STATS == 1 */
+
+
 #endif /* ifndef REDSTAT_H */
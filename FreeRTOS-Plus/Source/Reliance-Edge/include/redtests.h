@@ -83,6 +83,13 @@
       && ( REDCONF_OUTPUT == 1 ) && ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 ) \
       && ( REDCONF_API_POSIX_FORMAT == 1 ) && ( REDCONF_API_POSIX_FTRUNCATE == 1 ) )
 
+#define CRCBENCH_SUPPORTED    ( ( REDCONF_OUTPUT == 1 ) && ( REDCONF_CRC_BENCHMARK == 1 ) )
+
+#define FSBENCH_SUPPORTED                                                                                    \
+    ( ( ( RED_KIT == RED_KIT_GPL ) || ( RED_KIT == RED_KIT_SANDBOX ) )                                       \
+      && ( REDCONF_OUTPUT == 1 ) && ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX == 1 )                  \
+      && ( REDCONF_API_POSIX_UNLINK == 1 ) && ( REDCONF_API_POSIX_MKDIR == 1 ) && ( REDCONF_API_POSIX_RMDIR == 1 ) )
+
 
 typedef enum
 {
@@ -95,12 +102,14 @@ typedef enum
 #if FSSTRESS_SUPPORTED
     typedef struct
     {
-        bool fNoCleanup;  /**< --no-cleanup */
-        uint32_t ulLoops; /**< --loops */
-        uint32_t ulNops;  /**< --nops */
-        bool fNamePad;    /**< --namepad */
-        uint32_t ulSeed;  /**< --seed */
-        bool fVerbose;    /**< --verbose */
+        bool fNoCleanup;      /**< --no-cleanup */
+        uint32_t ulLoops;     /**< --loops */
+        uint32_t ulNops;      /**< --nops */
+        bool fNamePad;        /**< --namepad */
+        uint32_t ulSeed;      /**< --seed */
+        bool fVerbose;        /**< --verbose */
+        uint32_t ulTasks;     /**< --tasks */
+        uint32_t ulSharedPct; /**< --shared */
     } FSSTRESSPARAM;
 
     PARAMSTATUS FsstressParseParams( int argc,
@@ -297,5 +306,40 @@ typedef enum
     int DiskFullTestStart( const DISKFULLTESTPARAM * pParam );
 #endif /* if DISKFULL_TEST_SUPPORTED */
 
+#if CRCBENCH_SUPPORTED
+    typedef struct
+    {
+        uint32_t ulMinSize; /**< Smallest buffer size to measure, in bytes. */
+        uint32_t ulMaxSize; /**< Largest buffer size to measure, in bytes. */
+        uint32_t ulMS;      /**< Minimum duration of each measurement. */
+    } CRCBENCHPARAM;
+
+    void RedCrcBenchDefaultParams( CRCBENCHPARAM * pParam );
+    int RedCrcBenchStart( const CRCBENCHPARAM * pParam );
+#endif /* if CRCBENCH_SUPPORTED */
+
+#if FSBENCH_SUPPORTED
+    typedef struct
+    {
+        const char * pszVolume; /**< Volume path prefix. */
+        const char * pszTests;  /**< --tests */
+        uint32_t ulFileSize;    /**< --size */
+        uint32_t ulIOSize;      /**< --io-size */
+        uint32_t ulRandomOps;   /**< --rand-ops */
+        uint32_t ulFiles;       /**< --files */
+        uint32_t ulLookups;     /**< --lookups */
+        uint32_t ulTransacts;   /**< --transacts */
+        uint32_t ulSeed;        /**< --seed */
+    } FSBENCHPARAM;
+
+    PARAMSTATUS FsBenchParseParams( int argc,
+                                    char * argv[],
+                                    FSBENCHPARAM * pParam,
+                                    uint8_t * pbVolNum,
+                                    const char ** ppszDevice );
+    void FsBenchDefaultParams( FSBENCHPARAM * pParam );
+    int FsBenchStart( const FSBENCHPARAM * pParam );
+#endif /* if FSBENCH_SUPPORTED */
+
 
 #endif /* ifndef REDTESTS_H */
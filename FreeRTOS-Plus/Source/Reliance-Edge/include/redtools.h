@@ -40,6 +40,12 @@
 
     #define MACRO_NAME_MAX_LEN    32
 
+/*  Number of blocks of file data which the image builder copies at once.
+ */
+    #ifndef IMGBLD_COPY_BUFFER_BLOCKS
+        #define IMGBLD_COPY_BUFFER_BLOCKS    64U
+    #endif
+
     typedef struct
     {
         uint8_t bVolNumber;
@@ -88,6 +94,9 @@
                            const char * pszFullPath,
                            const char * pszBasePath,
                            char * szOutPath );
+        int IbPosixCreateFile( const char * pszVolName,
+                               const char * pszFullPath,
+                               const char * pszBasePath );
     #endif
 
 
@@ -117,8 +126,10 @@
 /*  Implemented in os-specific space (ibwin.c and iblinux.c)
  */
     #if REDCONF_API_POSIX == 1
-        int IbPosixCopyDirRecursive( const char * pszVolName,
-                                     const char * pszInDir );
+        int IbPosixWalkDir( const char * pszVolName,
+                            const char * pszBasePath,
+                            const char * pszDir,
+                            bool fCopyData );
     #endif
     #if REDCONF_API_FSE == 1
         int IbFseBuildFileList( const char * pszDirPath,
@@ -137,6 +148,7 @@
                     const FILEMAPPING * pFileMapping );
     int IbCheckFileExists( const char * pszPath,
                            bool * pfExists );
+    int IbMirrorMetaroot( uint8_t bVolNum );
 
 
 /*  Implemented separately in ibfse.c and ibposix.c
@@ -148,6 +160,9 @@
                      uint64_t ullOffset,
                      void * pData,
                      uint32_t ulDataLen );
+    int IbReserveFile( int volNum,
+                       const FILEMAPPING * pFileMapping,
+                       uint64_t ullSize );
 
 #endif /* IMAGE_BUILDER */
 
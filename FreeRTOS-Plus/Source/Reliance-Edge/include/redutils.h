@@ -62,10 +62,23 @@ void RedStrNCpy( char * pszDst,
                  const char * pszSrc,
                  uint32_t ulLen );
 
+/*  Values for REDCONF_CRC_ALGORITHM and REDCONF_CRC_FALLBACK.
+ */
+#define CRC_BITWISE     ( 0U )
+#define CRC_SARWATE     ( 1U )
+#define CRC_SLICEBY8    ( 2U )
+#define CRC_HARDWARE    ( 3U ) /* Port-supplied, see RedOsCrc32Update(). */
+
 uint32_t RedCrc32Update( uint32_t ulInitCrc32,
                          const void * pBuffer,
                          uint32_t ulLength );
 uint32_t RedCrcNode( const void * pBuffer );
+#if REDCONF_CRC_BENCHMARK == 1
+    uint32_t RedCrc32UpdateAlgorithm( uint8_t bAlgorithm,
+                                      uint32_t ulInitCrc32,
+                                      const void * pBuffer,
+                                      uint32_t ulLength );
+#endif
 
 #if REDCONF_API_POSIX == 1
     uint32_t RedNameLen( const char * pszName );
@@ -77,6 +90,15 @@ void RedBitSet( uint8_t * pbBitmap,
                 uint32_t ulBit );
 void RedBitClear( uint8_t * pbBitmap,
                   uint32_t ulBit );
+uint32_t RedBitFindClear( const uint8_t * pbBitmap,
+                          uint32_t ulBitStart,
+                          uint32_t ulBitEnd );
+uint32_t RedBitCountSet( const uint8_t * pbBitmap,
+                         uint32_t ulBitStart,
+                         uint32_t ulBitEnd );
+void RedBitClearRange( uint8_t * pbBitmap,
+                       uint32_t ulBitStart,
+                       uint32_t ulBitEnd );
 
 #ifdef REDCONF_ENDIAN_SWAP
     uint64_t RedRev64( uint64_t ullToRev );
@@ -77,6 +77,17 @@ typedef struct
          */
         const char * pszPathPrefix;
     #endif
+
+    #if REDCONF_BUFFER_VOL_RESERVE == 1
+
+        /** The number of block buffers reserved for this volume.  While the
+         *  volume holds this many buffers or fewer, they are not replaced by
+         *  blocks of other volumes, unless every other buffer is in use.  Zero
+         *  reserves none.  The reserves of all volumes together must be less
+         *  than #REDCONF_BUFFER_COUNT.
+         */
+        uint8_t bBufferReserve;
+    #endif
 } VOLCONF;
 
 extern const VOLCONF gaRedVolConf[ REDCONF_VOLUME_COUNT ];
@@ -125,6 +136,22 @@ typedef struct
      *  It is assumed to never wrap around.
      */
     uint64_t ullSequence;
+
+    #if REDCONF_BDEV_XIP == 1
+
+        /** Where the block device is memory-mapped while the volume is
+         *  mounted, or `NULL` if it is not memory-mapped.
+         */
+        const uint8_t * pbMapped;
+    #endif
+
+    #if REDCONF_BDEV_RAM_ALIAS == 1
+
+        /** Where the RAM disk holding the volume is while the volume is
+         *  mounted, or `NULL` if the block device is not a RAM disk.
+         */
+        uint8_t * pbAliased;
+    #endif
 } VOLUME;
 
 /*  Array of VOLUME structures, populated at during RedCoreInit().
@@ -33,6 +33,14 @@
 #include <redvolume.h>
 #include <redosdeviations.h>
 
+#if REDCONF_BDEV_ASYNC_DEPTH > 0U
+    #include <task.h>
+
+    #if INCLUDE_xTaskGetCurrentTaskHandle != 1
+        #error "INCLUDE_xTaskGetCurrentTaskHandle must be 1 when REDCONF_BDEV_ASYNC_DEPTH > 0"
+    #endif
+#endif
+
 
 /*------------------------------------------------------------------------------
  *   Porting Note:
@@ -129,6 +137,17 @@ static REDSTATUS DiskRead( uint8_t bVolNum,
                                 uint32_t ulSectorCount,
                                 const void * pBuffer );
     static REDSTATUS DiskFlush( uint8_t bVolNum );
+    #if REDCONF_DISCARDS == 1
+        static REDSTATUS DiskDiscard( uint8_t bVolNum,
+                                      uint64_t ullSectorStart,
+                                      uint64_t ullSectorCount );
+    #endif
+#endif
+#if REDCONF_BDEV_ASYNC_DEPTH > 0U
+    static REDSTATUS DiskSubmit( uint8_t bVolNum,
+                                 BDEVREQ * pReq );
+    static void BDevFinish( BDEVREQ * pReq,
+                            REDSTATUS status );
 #endif
 
 
@@ -330,9 +349,243 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
 
         return ret;
     }
+
+
+    #if REDCONF_DISCARDS == 1
+
+/** @brief Inform the block device that a range of sectors is no longer in use.
+ *
+ *  The file system calls this for blocks which were freed, once a transaction
+ *  point has made them free on disk.  The device may erase or unmap the
+ *  sectors, and their contents are undefined until they are next written.
+ *  This is a hint: an implementation which cannot make use of it should return
+ *  -RED_ENOSYS, and the file system will stop issuing discards to the volume
+ *  until it is next mounted.
+ *
+ *  The behavior of calling this function is undefined if the block device is
+ *  closed or if it was opened with ::BDEV_O_RDONLY.
+ *
+ *  @param bVolNum          The volume number of the volume whose block device
+ *                          is being discarded.
+ *  @param ullSectorStart   The starting sector number.
+ *  @param ullSectorCount   The number of sectors to discard.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p bVolNum is an invalid volume number, or the sector
+ *                      range is outside the volume.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOSYS The block device does not support discards.
+ */
+        REDSTATUS RedOsBDevDiscard( uint8_t bVolNum,
+                                    uint64_t ullSectorStart,
+                                    uint64_t ullSectorCount )
+        {
+            REDSTATUS ret;
+
+            if( ( bVolNum >= REDCONF_VOLUME_COUNT ) ||
+                ( ullSectorStart >= gaRedVolConf[ bVolNum ].ullSectorCount ) ||
+                ( ( gaRedVolConf[ bVolNum ].ullSectorCount - ullSectorStart ) < ullSectorCount ) ||
+                ( ullSectorCount == 0U ) )
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                ret = DiskDiscard( bVolNum, ullSectorStart, ullSectorCount );
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_DISCARDS == 1 */
 #endif /* REDCONF_READ_ONLY == 0 */
 
 
+#if REDCONF_BDEV_ASYNC_DEPTH > 0U
+
+/** @brief Start an asynchronous read or write of a block device.
+ *
+ *  The caller must fill in the sector range, buffer, direction, and optional
+ *  completion callback in @p pReq.  If this function returns success, the
+ *  caller must later call RedOsBDevWait() for the request; the request and its
+ *  buffer must not be modified until then.  Several requests may be in flight
+ *  at once.
+ *
+ *  The behavior of calling this function is undefined if the block device is
+ *  closed or was not opened with the access required by the request.
+ *
+ *  @param bVolNum  The volume number of the volume whose block device is being
+ *                  accessed.
+ *  @param pReq     The request to submit.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.  An
+ *          error from the transfer itself is reported by RedOsBDevWait().
+ *
+ *  @retval 0           The request was submitted.
+ *  @retval -RED_EINVAL @p bVolNum is an invalid volume number, @p pReq or its
+ *                      buffer is `NULL`, or the request refers to an invalid
+ *                      range of sectors.
+ */
+    REDSTATUS RedOsBDevSubmit( uint8_t bVolNum,
+                               BDEVREQ * pReq )
+    {
+        REDSTATUS ret;
+
+        if( ( bVolNum >= REDCONF_VOLUME_COUNT ) ||
+            ( pReq == NULL ) ||
+            ( pReq->pBuffer == NULL ) ||
+            ( pReq->ullSectorStart >= gaRedVolConf[ bVolNum ].ullSectorCount ) ||
+            ( ( gaRedVolConf[ bVolNum ].ullSectorCount - pReq->ullSectorStart ) < pReq->ulSectorCount ) )
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            pReq->pWaiter = xTaskGetCurrentTaskHandle();
+            pReq->status = 0;
+            pReq->fDone = false;
+
+            ret = DiskSubmit( bVolNum, pReq );
+        }
+
+        return ret;
+    }
+
+
+/** @brief Wait for an asynchronous request to complete.
+ *
+ *  The calling task blocks on its task notification until the request has
+ *  completed.  Must be called by the task which submitted the request.
+ *
+ *  @param pReq The request, previously passed to RedOsBDevSubmit().
+ *
+ *  @return A negated ::REDSTATUS code indicating the result of the transfer.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p pReq is `NULL`.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+    REDSTATUS RedOsBDevWait( BDEVREQ * pReq )
+    {
+        REDSTATUS ret;
+
+        if( pReq == NULL )
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            /*  The notification may have been given by another request, so
+             *  keep waiting until this one is done.
+             */
+            while( !pReq->fDone )
+            {
+                ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+            }
+
+            ret = pReq->status;
+        }
+
+        return ret;
+    }
+
+
+/** @brief Report the completion of an asynchronous request.
+ *
+ *  To be called by a DMA-capable DiskSubmit() implementation from its transfer
+ *  complete interrupt.  Invokes the completion callback, if any, and wakes the
+ *  task waiting in RedOsBDevWait().
+ *
+ *  @param pReq     The request which has completed.
+ *  @param status   The result of the transfer: 0 or a negated ::REDSTATUS code.
+ */
+    void RedOsBDevComplete( BDEVREQ * pReq,
+                            REDSTATUS status )
+    {
+        /*  Read the waiter first: once the request is marked done, the waiting
+         *  task may reuse it.
+         */
+        TaskHandle_t xWaiter = ( TaskHandle_t ) pReq->pWaiter;
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        BDevFinish( pReq, status );
+
+        if( xWaiter != NULL )
+        {
+            vTaskNotifyGiveFromISR( xWaiter, &xHigherPriorityTaskWoken );
+            portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+        }
+    }
+
+
+/** @brief Record the result of a request and invoke its completion callback.
+ *
+ *  @param pReq     The request which has completed.
+ *  @param status   The result of the transfer.
+ */
+    static void BDevFinish( BDEVREQ * pReq,
+                            REDSTATUS status )
+    {
+        pReq->status = status;
+        pReq->fDone = true;
+
+        if( pReq->pfnComplete != NULL )
+        {
+            pReq->pfnComplete( pReq );
+        }
+    }
+
+
+/*  Porting Note:
+ *
+ *  None of the example implementations below drive their storage with DMA, so
+ *  this DiskSubmit() services the request synchronously and completes it before
+ *  returning.  For a driver with a DMA engine (such as the STM32 HAL
+ *  BSP_SD_ReadBlocks_DMA() and BSP_SD_WriteBlocks_DMA() functions), replace it
+ *  with one which starts the transfer and returns, and call
+ *  RedOsBDevComplete() from the transfer complete interrupt.
+ */
+
+/** @brief Start an asynchronous transfer.
+ *
+ *  @param bVolNum  The volume number of the volume whose block device is being
+ *                  accessed.
+ *  @param pReq     The request to start.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0   The request was submitted.
+ */
+    static REDSTATUS DiskSubmit( uint8_t bVolNum,
+                                 BDEVREQ * pReq )
+    {
+        REDSTATUS status;
+
+        if( pReq->fWrite )
+        {
+            #if REDCONF_READ_ONLY == 0
+                status = DiskWrite( bVolNum, pReq->ullSectorStart, pReq->ulSectorCount, pReq->pBuffer );
+            #else
+                status = -RED_EINVAL;
+            #endif
+        }
+        else
+        {
+            status = DiskRead( bVolNum, pReq->ullSectorStart, pReq->ulSectorCount, pReq->pBuffer );
+        }
+
+        /*  The request completed in the context of the submitting task, so
+         *  there is no task to notify.
+         */
+        pReq->pWaiter = NULL;
+        BDevFinish( pReq, status );
+
+        return 0;
+    }
+#endif /* REDCONF_BDEV_ASYNC_DEPTH > 0U */
+
+
 #if BDEV_EXAMPLE_IMPLEMENTATION == BDEV_F_DRIVER
 
     #include <api_mdriver.h>
@@ -577,6 +830,32 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
 
             return ret;
         }
+
+
+        #if REDCONF_DISCARDS == 1
+
+/** @brief Inform the disk that a range of sectors is no longer in use.
+ *
+ *  @param bVolNum          The volume number of the volume whose block device
+ *                          is being discarded.
+ *  @param ullSectorStart   The starting sector number.
+ *  @param ullSectorCount   The number of sectors to discard.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval -RED_ENOSYS The F_DRIVER interface has no discard function.
+ */
+            static REDSTATUS DiskDiscard( uint8_t bVolNum,
+                                          uint64_t ullSectorStart,
+                                          uint64_t ullSectorCount )
+            {
+                ( void ) bVolNum;
+                ( void ) ullSectorStart;
+                ( void ) ullSectorCount;
+
+                return -RED_ENOSYS;
+            }
+        #endif /* REDCONF_DISCARDS == 1 */
     #endif /* REDCONF_READ_ONLY == 0 */
 
 
@@ -806,6 +1085,33 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
 
             return ret;
         }
+
+
+        #if REDCONF_DISCARDS == 1
+
+/** @brief Inform the disk that a range of sectors is no longer in use.
+ *
+ *  @param bVolNum          The volume number of the volume whose block device
+ *                          is being discarded.
+ *  @param ullSectorStart   The starting sector number.
+ *  @param ullSectorCount   The number of sectors to discard.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval -RED_ENOSYS Discards are not implemented for FatFs: the trim ioctl
+ *                      differs between FatFs versions.
+ */
+            static REDSTATUS DiskDiscard( uint8_t bVolNum,
+                                          uint64_t ullSectorStart,
+                                          uint64_t ullSectorCount )
+            {
+                ( void ) bVolNum;
+                ( void ) ullSectorStart;
+                ( void ) ullSectorCount;
+
+                return -RED_ENOSYS;
+            }
+        #endif /* REDCONF_DISCARDS == 1 */
     #endif /* REDCONF_READ_ONLY == 0 */
 
 
@@ -1041,6 +1347,32 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
 
             return ret;
         }
+
+
+        #if REDCONF_DISCARDS == 1
+
+/** @brief Inform the disk that a range of sectors is no longer in use.
+ *
+ *  @param bVolNum          The volume number of the volume whose block device
+ *                          is being discarded.
+ *  @param ullSectorStart   The starting sector number.
+ *  @param ullSectorCount   The number of sectors to discard.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval -RED_ENOSYS The ASF SD/MMC driver has no discard function.
+ */
+            static REDSTATUS DiskDiscard( uint8_t bVolNum,
+                                          uint64_t ullSectorStart,
+                                          uint64_t ullSectorCount )
+            {
+                ( void ) bVolNum;
+                ( void ) ullSectorStart;
+                ( void ) ullSectorCount;
+
+                return -RED_ENOSYS;
+            }
+        #endif /* REDCONF_DISCARDS == 1 */
     #endif /* REDCONF_READ_ONLY == 0 */
 
 #elif BDEV_EXAMPLE_IMPLEMENTATION == BDEV_STM32_SDIO
@@ -1081,10 +1413,26 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
  */
     #define SD_STATUS_TIMEOUT    ( 100000U )
 
+/** @brief Number of sectors in the bounce buffer used for unaligned transfers.
+ *
+ *  An unaligned request is copied through the bounce buffer in chunks of up to
+ *  this many sectors, each chunk going out as one multi-block SD command.  The
+ *  default matches the 4 KB block size most volumes use; a larger value lets
+ *  bigger unaligned transfers reach the card in fewer commands at the cost of
+ *  512 bytes of RAM per sector.  Must be at least 1.
+ */
+    #ifndef SD_BOUNCE_BUFFER_SECTORS
+        #define SD_BOUNCE_BUFFER_SECTORS    ( 8U )
+    #endif
+
+    #if SD_BOUNCE_BUFFER_SECTORS < 1U
+        #error "SD_BOUNCE_BUFFER_SECTORS must be at least 1"
+    #endif
+
 /** @brief 4-byte aligned buffer to use for DMA transfers when passed in
  *         an unaligned buffer.
  */
-    static uint32_t gaulAlignedBuffer[ 512U / sizeof( uint32_t ) ];
+    static uint32_t gaulAlignedBuffer[ ( SD_BOUNCE_BUFFER_SECTORS * 512U ) / sizeof( uint32_t ) ];
 
 
     #if SD_STATUS_TIMEOUT > 0U
@@ -1213,11 +1561,14 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
         }
         else
         {
-            uint32_t ulSectorIdx;
+            uint8_t * pbBuffer = CAST_VOID_PTR_TO_UINT8_PTR( pBuffer );
+            uint32_t ulSectorIdx = 0U;
 
-            for( ulSectorIdx = 0U; ulSectorIdx < ulSectorCount; ulSectorIdx++ )
+            while( ( redStat == 0 ) && ( ulSectorIdx < ulSectorCount ) )
             {
-                bSdError = BSP_SD_ReadBlocks_DMA( gaulAlignedBuffer, ( ullSectorStart + ulSectorIdx ) * ulSectorSize, ulSectorSize, 1U );
+                uint32_t ulTransfer = REDMIN( ulSectorCount - ulSectorIdx, SD_BOUNCE_BUFFER_SECTORS );
+
+                bSdError = BSP_SD_ReadBlocks_DMA( gaulAlignedBuffer, ( ullSectorStart + ulSectorIdx ) * ulSectorSize, ulSectorSize, ulTransfer );
 
                 if( bSdError != MSD_OK )
                 {
@@ -1233,13 +1584,8 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
 
                 if( redStat == 0 )
                 {
-                    uint8_t * pbBuffer = CAST_VOID_PTR_TO_UINT8_PTR( pBuffer );
-
-                    RedMemCpy( &pbBuffer[ ulSectorIdx * ulSectorSize ], gaulAlignedBuffer, ulSectorSize );
-                }
-                else
-                {
-                    break;
+                    RedMemCpy( &pbBuffer[ ulSectorIdx * ulSectorSize ], gaulAlignedBuffer, ulTransfer * ulSectorSize );
+                    ulSectorIdx += ulTransfer;
                 }
             }
         }
@@ -1291,15 +1637,16 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
             }
             else
             {
-                uint32_t ulSectorIdx;
+                const uint8_t * pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pBuffer );
+                uint32_t ulSectorIdx = 0U;
 
-                for( ulSectorIdx = 0U; ulSectorIdx < ulSectorCount; ulSectorIdx++ )
+                while( ( redStat == 0 ) && ( ulSectorIdx < ulSectorCount ) )
                 {
-                    const uint8_t * pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pBuffer );
+                    uint32_t ulTransfer = REDMIN( ulSectorCount - ulSectorIdx, SD_BOUNCE_BUFFER_SECTORS );
 
-                    RedMemCpy( gaulAlignedBuffer, &pbBuffer[ ulSectorIdx * ulSectorSize ], ulSectorSize );
+                    RedMemCpy( gaulAlignedBuffer, &pbBuffer[ ulSectorIdx * ulSectorSize ], ulTransfer * ulSectorSize );
 
-                    bSdError = BSP_SD_WriteBlocks_DMA( gaulAlignedBuffer, ( ullSectorStart + ulSectorIdx ) * ulSectorSize, ulSectorSize, 1U );
+                    bSdError = BSP_SD_WriteBlocks_DMA( gaulAlignedBuffer, ( ullSectorStart + ulSectorIdx ) * ulSectorSize, ulSectorSize, ulTransfer );
 
                     if( bSdError != MSD_OK )
                     {
@@ -1313,10 +1660,7 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
                         }
                     #endif
 
-                    if( redStat != 0 )
-                    {
-                        break;
-                    }
+                    ulSectorIdx += ulTransfer;
                 }
             }
 
@@ -1376,6 +1720,49 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
             }
         #endif /* if SD_STATUS_TIMEOUT > 0U */
 
+
+        #if REDCONF_DISCARDS == 1
+
+/** @brief Inform the disk that a range of sectors is no longer in use.
+ *
+ *  The sectors are erased with BSP_SD_Erase(), which on most cards is much
+ *  faster than writing them and spares the card from copying their stale
+ *  contents during its own garbage collection.
+ *
+ *  @param bVolNum          The volume number of the volume whose block device
+ *                          is being discarded.
+ *  @param ullSectorStart   The starting sector number.
+ *  @param ullSectorCount   The number of sectors to discard.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EIO    A disk I/O error occurred.
+ */
+            static REDSTATUS DiskDiscard( uint8_t bVolNum,
+                                          uint64_t ullSectorStart,
+                                          uint64_t ullSectorCount )
+            {
+                REDSTATUS redStat = 0;
+                uint32_t ulSectorSize = gaRedVolConf[ bVolNum ].ulSectorSize;
+
+                /*  The erase addresses are the first and last bytes of the range.
+                 */
+                if( BSP_SD_Erase( ullSectorStart * ulSectorSize, ( ( ullSectorStart + ullSectorCount ) * ulSectorSize ) - 1U ) != MSD_OK )
+                {
+                    redStat = -RED_EIO;
+                }
+
+                #if SD_STATUS_TIMEOUT > 0U
+                    else
+                    {
+                        redStat = CheckStatus();
+                    }
+                #endif
+
+                return redStat;
+            }
+        #endif /* REDCONF_DISCARDS == 1 */
     #endif /* REDCONF_READ_ONLY == 0 */
 
 #elif BDEV_EXAMPLE_IMPLEMENTATION == BDEV_RAM_DISK
@@ -1549,6 +1936,46 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
 
             return ret;
         }
+
+
+        #if REDCONF_DISCARDS == 1
+
+/** @brief Inform the disk that a range of sectors is no longer in use.
+ *
+ *  RAM has no use for the hint, but accepting it lets the discard path be
+ *  exercised in the simulator.
+ *
+ *  @param bVolNum          The volume number of the volume whose block device
+ *                          is being discarded.
+ *  @param ullSectorStart   The starting sector number.
+ *  @param ullSectorCount   The number of sectors to discard.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The RAM disk has not been opened.
+ */
+            static REDSTATUS DiskDiscard( uint8_t bVolNum,
+                                          uint64_t ullSectorStart,
+                                          uint64_t ullSectorCount )
+            {
+                REDSTATUS ret;
+
+                ( void ) ullSectorStart;
+                ( void ) ullSectorCount;
+
+                if( gapbRamDisk[ bVolNum ] == NULL )
+                {
+                    ret = -RED_EINVAL;
+                }
+                else
+                {
+                    ret = 0;
+                }
+
+                return ret;
+            }
+        #endif /* REDCONF_DISCARDS == 1 */
     #endif /* REDCONF_READ_ONLY == 0 */
 
 #else /* if BDEV_EXAMPLE_IMPLEMENTATION == BDEV_F_DRIVER */
@@ -1556,3 +1983,78 @@ REDSTATUS RedOsBDevRead( uint8_t bVolNum,
     #error "Invalid BDEV_EXAMPLE_IMPLEMENTATION value"
 
 #endif /* BDEV_EXAMPLE_IMPLEMENTATION == ... */
+
+
+#if REDCONF_BDEV_XIP == 1
+
+/*  Porting Note:
+ *
+ *  Of the example implementations, only the RAM disk is addressable by the
+ *  CPU.  For NOR or QSPI flash in memory-mapped mode, return the address at
+ *  which the first sector of the volume appears, for example the start of the
+ *  QSPI memory-mapped region plus the offset of the volume; the mapping must
+ *  be enabled before the volume is mounted and stay enabled until it is
+ *  unmounted.
+ */
+
+/** @brief Get the address at which a block device is memory-mapped.
+ *
+ *  Called when a volume is mounted, after RedOsBDevOpen().  If the sectors of
+ *  the block device can be read directly by the CPU, at consecutive addresses,
+ *  the file system uses file data in place instead of reading it with
+ *  RedOsBDevRead().  The memory is only ever read.
+ *
+ *  @param bVolNum  The volume number of the volume whose block device is being
+ *                  mapped.
+ *
+ *  @return The address of the first sector of the block device, or `NULL` if
+ *          the block device is not memory-mapped, in which case it is read
+ *          with RedOsBDevRead() as usual.
+ */
+    const void * RedOsBDevMap( uint8_t bVolNum )
+    {
+        const void * pMapped = NULL;
+
+        if( bVolNum < REDCONF_VOLUME_COUNT )
+        {
+            #if BDEV_EXAMPLE_IMPLEMENTATION == BDEV_RAM_DISK
+                pMapped = gapbRamDisk[ bVolNum ];
+            #endif
+        }
+
+        return pMapped;
+    }
+#endif /* REDCONF_BDEV_XIP == 1 */
+
+
+#if REDCONF_BDEV_RAM_ALIAS == 1
+
+/** @brief Get the address of the RAM which holds a block device.
+ *
+ *  Called when a volume is mounted, after RedOsBDevOpen().  If the block
+ *  device is a RAM disk, the file system reads and writes file data directly
+ *  in that RAM, instead of copying it with RedOsBDevRead() and
+ *  RedOsBDevWrite().  Only blocks outside the committed state are changed
+ *  this way, so transactions protect the volume as before.
+ *
+ *  @param bVolNum  The volume number of the volume whose block device is being
+ *                  aliased.
+ *
+ *  @return The address of the first sector of the block device, or `NULL` if
+ *          the block device is not a RAM disk, in which case it is accessed
+ *          with RedOsBDevRead() and RedOsBDevWrite() as usual.
+ */
+    void * RedOsBDevAlias( uint8_t bVolNum )
+    {
+        void * pAliased = NULL;
+
+        if( bVolNum < REDCONF_VOLUME_COUNT )
+        {
+            #if BDEV_EXAMPLE_IMPLEMENTATION == BDEV_RAM_DISK
+                pAliased = gapbRamDisk[ bVolNum ];
+            #endif
+        }
+
+        return pAliased;
+    }
+#endif /* REDCONF_BDEV_RAM_ALIAS == 1 */
@@ -0,0 +1,239 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements hardware CRC32 computation.
+ *
+ *  This service is only needed when REDCONF_CRC_ALGORITHM is CRC_HARDWARE.
+ *  The CRC is the reflected CRC-32 with polynomial 0xEDB88320 (as used by
+ *  Ethernet and zlib), which is the same CRC computed by the software
+ *  algorithms in util/crc.c.
+ */
+#include <redfs.h>
+
+#if REDCONF_CRC_ALGORITHM == CRC_HARDWARE
+
+
+/*------------------------------------------------------------------------------
+ *   Porting Note:
+ *
+ *   Several example implementations are available.  If none of them suit the
+ *   target, implement RedOsCrc32Update() to return false: the CRC will then be
+ *   computed with the REDCONF_CRC_FALLBACK software algorithm.
+ *  ------------------------------------------------------------------------------*/
+
+/** @brief No hardware CRC: always use the software fallback.
+ */
+    #define OSCRC_NONE        ( 0U )
+
+/** @brief The ARMv8 CRC32 instructions, via the ACLE intrinsics.
+ *
+ *  Available on ARMv8-A cores, and on ARMv8-M and ARMv8-R cores which
+ *  implement the CRC32 extension.  The compiler defines __ARM_FEATURE_CRC32
+ *  when the instructions are available to the target.
+ */
+    #define OSCRC_ARM_ACLE    ( 1U )
+
+/** @brief The STM32 CRC calculation unit.
+ *
+ *  Requires a CRC unit with a programmable initial value and bit reversal of
+ *  input and output data, as found on the STM32F0, F7, L4, H7 and most later
+ *  families (but not the STM32F1, F2 or F4).  The STM32 device header must be
+ *  in the include directory path.  The CRC unit must not be used by other
+ *  software while the file system is using it.
+ */
+    #define OSCRC_STM32       ( 2U )
+
+/** @brief Pick which example implementation is compiled.
+ *
+ *  Must be one of:
+ *  - #OSCRC_NONE
+ *  - #OSCRC_ARM_ACLE
+ *  - #OSCRC_STM32
+ */
+    #ifndef OSCRC_EXAMPLE_IMPLEMENTATION
+        #ifdef __ARM_FEATURE_CRC32
+            #define OSCRC_EXAMPLE_IMPLEMENTATION    OSCRC_ARM_ACLE
+        #else
+            #define OSCRC_EXAMPLE_IMPLEMENTATION    OSCRC_NONE
+        #endif
+    #endif
+
+
+    #if OSCRC_EXAMPLE_IMPLEMENTATION == OSCRC_NONE
+
+/** @brief Compute a CRC32 in hardware.
+ *
+ *  @param ulInitCrc32  Starting CRC value.
+ *  @param pBuffer      Data buffer to calculate the CRC from.
+ *  @param ulLength     Number of bytes of data in the given buffer.
+ *  @param pulCrc32     On success, populated with the updated CRC value.
+ *
+ *  @return Whether the CRC was computed.  If false, the caller computes it in
+ *          software.
+ */
+        bool RedOsCrc32Update( uint32_t ulInitCrc32,
+                               const void * pBuffer,
+                               uint32_t ulLength,
+                               uint32_t * pulCrc32 )
+        {
+            ( void ) ulInitCrc32;
+            ( void ) pBuffer;
+            ( void ) ulLength;
+            ( void ) pulCrc32;
+
+            return false;
+        }
+
+    #elif OSCRC_EXAMPLE_IMPLEMENTATION == OSCRC_ARM_ACLE
+
+        #ifndef __ARM_FEATURE_CRC32
+            #error "OSCRC_ARM_ACLE requires a target with the CRC32 instructions"
+        #endif
+
+        #include <arm_acle.h>
+
+
+/** @brief Compute a CRC32 in hardware.
+ *
+ *  @param ulInitCrc32  Starting CRC value.
+ *  @param pBuffer      Data buffer to calculate the CRC from.
+ *  @param ulLength     Number of bytes of data in the given buffer.
+ *  @param pulCrc32     On success, populated with the updated CRC value.
+ *
+ *  @return Whether the CRC was computed.  If false, the caller computes it in
+ *          software.
+ */
+        bool RedOsCrc32Update( uint32_t ulInitCrc32,
+                               const void * pBuffer,
+                               uint32_t ulLength,
+                               uint32_t * pulCrc32 )
+        {
+            const uint8_t * pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pBuffer );
+            uint32_t ulCrc32 = ~ulInitCrc32;
+            uint32_t ulIdx = 0U;
+
+            /*  The word-sized instruction requires aligned loads on some
+             *  cores, so handle any unaligned initial bytes one at a time.
+             */
+            while( ( ulIdx < ulLength ) && ( ( ( uintptr_t ) &pbBuffer[ ulIdx ] & 3U ) != 0U ) )
+            {
+                ulCrc32 = __crc32b( ulCrc32, pbBuffer[ ulIdx ] );
+                ulIdx++;
+            }
+
+            while( ( ulLength - ulIdx ) >= 4U )
+            {
+                ulCrc32 = __crc32w( ulCrc32, *CAST_CONST_UINT32_PTR( &pbBuffer[ ulIdx ] ) );
+                ulIdx += 4U;
+            }
+
+            while( ulIdx < ulLength )
+            {
+                ulCrc32 = __crc32b( ulCrc32, pbBuffer[ ulIdx ] );
+                ulIdx++;
+            }
+
+            *pulCrc32 = ~ulCrc32;
+
+            return true;
+        }
+
+    #elif OSCRC_EXAMPLE_IMPLEMENTATION == OSCRC_STM32
+
+        #include <stm32_hal.h> /* Substitute the device header, e.g. stm32f7xx_hal.h. */
+
+
+/** @brief Compute a CRC32 in hardware.
+ *
+ *  The CRC unit computes a non-reflected CRC; the reflected CRC is obtained by
+ *  enabling bit reversal of the input and output, and by seeding the unit with
+ *  the bit-reversed, inverted starting CRC.
+ *
+ *  @param ulInitCrc32  Starting CRC value.
+ *  @param pBuffer      Data buffer to calculate the CRC from.
+ *  @param ulLength     Number of bytes of data in the given buffer.
+ *  @param pulCrc32     On success, populated with the updated CRC value.
+ *
+ *  @return Whether the CRC was computed.  If false, the caller computes it in
+ *          software.
+ */
+        bool RedOsCrc32Update( uint32_t ulInitCrc32,
+                               const void * pBuffer,
+                               uint32_t ulLength,
+                               uint32_t * pulCrc32 )
+        {
+            const uint8_t * pbBuffer = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pBuffer );
+            uint32_t ulIdx = 0U;
+
+            __HAL_RCC_CRC_CLK_ENABLE();
+
+            /*  Default polynomial and 32-bit size; reverse the input by word
+             *  and reverse the output.
+             */
+            CRC->POL = 0x04C11DB7U;
+            CRC->INIT = __RBIT( ~ulInitCrc32 );
+            CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_IN_1 | CRC_CR_REV_OUT | CRC_CR_RESET;
+
+            while( ( ulLength - ulIdx ) >= 4U )
+            {
+                uint32_t ulWord;
+
+                /*  The buffer may not be aligned: assemble the word from
+                 *  bytes, least significant first, as the reflected CRC
+                 *  consumes them.
+                 */
+                ulWord = ( uint32_t ) pbBuffer[ ulIdx ];
+                ulWord |= ( uint32_t ) pbBuffer[ ulIdx + 1U ] << 8U;
+                ulWord |= ( uint32_t ) pbBuffer[ ulIdx + 2U ] << 16U;
+                ulWord |= ( uint32_t ) pbBuffer[ ulIdx + 3U ] << 24U;
+
+                CRC->DR = ulWord;
+                ulIdx += 4U;
+            }
+
+            /*  Bytes written individually must be reversed by byte.
+             */
+            CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_OUT;
+
+            while( ulIdx < ulLength )
+            {
+                *( ( volatile uint8_t * ) &CRC->DR ) = pbBuffer[ ulIdx ];
+                ulIdx++;
+            }
+
+            *pulCrc32 = ~CRC->DR;
+
+            return true;
+        }
+
+    #else /* if OSCRC_EXAMPLE_IMPLEMENTATION == OSCRC_NONE */
+
+        #error "Invalid OSCRC_EXAMPLE_IMPLEMENTATION value"
+
+    #endif /* OSCRC_EXAMPLE_IMPLEMENTATION == ... */
+
+#endif /* REDCONF_CRC_ALGORITHM == CRC_HARDWARE */
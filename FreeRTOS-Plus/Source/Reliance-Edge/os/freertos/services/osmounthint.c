@@ -0,0 +1,153 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements storage for the fast mount hints.
+ *
+ *  The default implementation keeps the hints in RAM, which helps when a volume
+ *  is unmounted and mounted again, e.g. around a low-power state in which RAM
+ *  is retained.  To keep the hints across a reset, define
+ *  REDOS_MOUNT_HINT_ATTRIBUTE to place them in a section which the startup code
+ *  does not initialize, such as `__attribute__( ( section( ".noinit" ) ) )`, or
+ *  replace these functions with ones that use backup registers or EEPROM.
+ *
+ *  A hint must never name a metaroot newer than the one on disk, so the core
+ *  stores it before writing the metaroot.  A stale or corrupt hint only costs
+ *  a normal mount, since the core verifies the hinted metaroot before trusting
+ *  it.
+ */
+#include <redfs.h>
+
+#if REDCONF_FAST_MOUNT == 1
+
+    #ifndef REDOS_MOUNT_HINT_ATTRIBUTE
+        #define REDOS_MOUNT_HINT_ATTRIBUTE
+    #endif
+
+/*  Identifies a stored hint; uninitialized memory is unlikely to hold it.
+ */
+    #define MOUNT_HINT_SIG    0x54484D52U /* "RMHT" */
+
+    typedef struct
+    {
+        uint32_t ulSignature;
+        REDMOUNTHINT hint;
+        uint32_t ulRecordCRC;
+    } MOUNTHINTRECORD;
+
+
+    static uint32_t HintRecordCRC( const MOUNTHINTRECORD * pRecord );
+
+
+    static MOUNTHINTRECORD gaHint[ REDCONF_VOLUME_COUNT ] REDOS_MOUNT_HINT_ATTRIBUTE;
+
+
+/** @brief Load the mount hint for a volume.
+ *
+ *  @param bVolNum  The volume number of the volume whose hint is loaded.
+ *  @param pHint    Populated with the hint.
+ *
+ *  @return Whether a hint was available.
+ *
+ *  @retval true    A hint was loaded into @p pHint.
+ *  @retval false   There is no hint for the volume.
+ */
+    bool RedOsMountHintLoad( uint8_t bVolNum,
+                             REDMOUNTHINT * pHint )
+    {
+        bool fRet = false;
+
+        if( ( bVolNum >= REDCONF_VOLUME_COUNT ) || ( pHint == NULL ) )
+        {
+            REDERROR();
+        }
+        else
+        {
+            const MOUNTHINTRECORD * pRecord = &gaHint[ bVolNum ];
+
+            if( ( pRecord->ulSignature == MOUNT_HINT_SIG ) &&
+                ( pRecord->ulRecordCRC == HintRecordCRC( pRecord ) ) &&
+                ( pRecord->hint.bMR <= 1U ) )
+            {
+                *pHint = pRecord->hint;
+                fRet = true;
+            }
+        }
+
+        return fRet;
+    }
+
+
+/** @brief Store the mount hint for a volume.
+ *
+ *  @param bVolNum  The volume number of the volume whose hint is stored.
+ *  @param pHint    The hint to store, or `NULL` to forget the hint.
+ */
+    void RedOsMountHintStore( uint8_t bVolNum,
+                              const REDMOUNTHINT * pHint )
+    {
+        if( bVolNum >= REDCONF_VOLUME_COUNT )
+        {
+            REDERROR();
+        }
+        else if( pHint == NULL )
+        {
+            RedMemSet( &gaHint[ bVolNum ], 0U, sizeof( gaHint[ bVolNum ] ) );
+        }
+        else
+        {
+            MOUNTHINTRECORD * pRecord = &gaHint[ bVolNum ];
+
+            /*  Zero the record first, so that any padding is included in the
+             *  CRC consistently.
+             */
+            RedMemSet( pRecord, 0U, sizeof( *pRecord ) );
+            pRecord->ulSignature = MOUNT_HINT_SIG;
+            pRecord->hint.ullSequence = pHint->ullSequence;
+            pRecord->hint.ulCRC = pHint->ulCRC;
+            pRecord->hint.bMR = pHint->bMR;
+            pRecord->ulRecordCRC = HintRecordCRC( pRecord );
+        }
+    }
+
+
+/** @brief Compute the CRC which protects a stored hint.
+ *
+ *  @param pRecord  The stored hint.
+ *
+ *  @return The CRC of the signature and the hint.
+ */
+    static uint32_t HintRecordCRC( const MOUNTHINTRECORD * pRecord )
+    {
+        uint32_t ulCRC;
+
+        ulCRC = RedCrc32Update( 0U, &pRecord->ulSignature, sizeof( pRecord->ulSignature ) );
+        ulCRC = RedCrc32Update( ulCRC, &pRecord->hint, sizeof( pRecord->hint ) );
+
+        return ulCRC;
+    }
+
+#endif /* REDCONF_FAST_MOUNT == 1 */
@@ -40,6 +40,40 @@
     #if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
         static StaticSemaphore_t xMutexBuffer;
     #endif
+    #if REDCONF_LOCK_PER_VOLUME == 1
+
+/*  Per-volume mutexes: the volume lock, held by the task operating on the
+ *  volume for the whole of a POSIX API call, and the block device lock, held
+ *  only for the duration of each block device access.  The lock ordering is:
+ *  volume lock, then FS mutex, then block device lock.
+ *
+ *  With shared readers, the volume lock is a counting semaphore with one token
+ *  per reader: a shared holder takes one token and an exclusive holder takes
+ *  them all.  Tokens are only taken while holding the gate mutex, so that two
+ *  tasks never hold part of the tokens each waiting for the rest, and so that
+ *  readers arriving after an exclusive waiter queue behind it.
+ */
+        static SemaphoreHandle_t axVolMutex[ REDCONF_VOLUME_COUNT ];
+        static SemaphoreHandle_t axBDevMutex[ REDCONF_VOLUME_COUNT ];
+        #if REDCONF_LOCK_SHARED_READERS > 0U
+            static SemaphoreHandle_t axVolGate[ REDCONF_VOLUME_COUNT ];
+        #endif
+        #if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            static StaticSemaphore_t axVolMutexBuffer[ REDCONF_VOLUME_COUNT ];
+            static StaticSemaphore_t axBDevMutexBuffer[ REDCONF_VOLUME_COUNT ];
+            #if REDCONF_LOCK_SHARED_READERS > 0U
+                static StaticSemaphore_t axVolGateBuffer[ REDCONF_VOLUME_COUNT ];
+            #endif
+        #endif
+
+        #if REDCONF_LOCK_SHARED_READERS > 0U
+            static bool VolTokensTake( uint8_t bVolNum,
+                                       UBaseType_t uxCount,
+                                       TickType_t xTicksToWait );
+            static void VolTokensGive( uint8_t bVolNum,
+                                       UBaseType_t uxCount );
+        #endif
+    #endif /* if REDCONF_LOCK_PER_VOLUME == 1 */
 
 
 /** @brief Initialize the mutex.
@@ -77,6 +111,51 @@
             }
         #endif /* if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
 
+        #if REDCONF_LOCK_PER_VOLUME == 1
+            if( ret == 0 )
+            {
+                uint8_t bVolNum;
+
+                for( bVolNum = 0U; bVolNum < REDCONF_VOLUME_COUNT; bVolNum++ )
+                {
+                    #if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                        #if REDCONF_LOCK_SHARED_READERS > 0U
+                            axVolMutex[ bVolNum ] = xSemaphoreCreateCountingStatic( REDCONF_LOCK_SHARED_READERS, REDCONF_LOCK_SHARED_READERS, &axVolMutexBuffer[ bVolNum ] );
+                            axVolGate[ bVolNum ] = xSemaphoreCreateMutexStatic( &axVolGateBuffer[ bVolNum ] );
+                        #else
+                            axVolMutex[ bVolNum ] = xSemaphoreCreateMutexStatic( &axVolMutexBuffer[ bVolNum ] );
+                        #endif
+                        axBDevMutex[ bVolNum ] = xSemaphoreCreateMutexStatic( &axBDevMutexBuffer[ bVolNum ] );
+                    #else
+                        #if REDCONF_LOCK_SHARED_READERS > 0U
+                            axVolMutex[ bVolNum ] = xSemaphoreCreateCounting( REDCONF_LOCK_SHARED_READERS, REDCONF_LOCK_SHARED_READERS );
+                            axVolGate[ bVolNum ] = xSemaphoreCreateMutex();
+                        #else
+                            axVolMutex[ bVolNum ] = xSemaphoreCreateMutex();
+                        #endif
+                        axBDevMutex[ bVolNum ] = xSemaphoreCreateMutex();
+                    #endif
+
+                    if( ( axVolMutex[ bVolNum ] == NULL ) || ( axBDevMutex[ bVolNum ] == NULL ) )
+                    {
+                        ret = -RED_ENOMEM;
+                    }
+
+                    #if REDCONF_LOCK_SHARED_READERS > 0U
+                        if( axVolGate[ bVolNum ] == NULL )
+                        {
+                            ret = -RED_ENOMEM;
+                        }
+                    #endif
+                }
+
+                if( ret != 0 )
+                {
+                    ( void ) RedOsMutexUninit();
+                }
+            }
+        #endif /* if REDCONF_LOCK_PER_VOLUME == 1 */
+
         return ret;
     }
 
@@ -96,6 +175,35 @@
         vSemaphoreDelete( xMutex );
         xMutex = NULL;
 
+        #if REDCONF_LOCK_PER_VOLUME == 1
+            {
+                uint8_t bVolNum;
+
+                for( bVolNum = 0U; bVolNum < REDCONF_VOLUME_COUNT; bVolNum++ )
+                {
+                    if( axVolMutex[ bVolNum ] != NULL )
+                    {
+                        vSemaphoreDelete( axVolMutex[ bVolNum ] );
+                        axVolMutex[ bVolNum ] = NULL;
+                    }
+
+                    if( axBDevMutex[ bVolNum ] != NULL )
+                    {
+                        vSemaphoreDelete( axBDevMutex[ bVolNum ] );
+                        axBDevMutex[ bVolNum ] = NULL;
+                    }
+
+                    #if REDCONF_LOCK_SHARED_READERS > 0U
+                        if( axVolGate[ bVolNum ] != NULL )
+                        {
+                            vSemaphoreDelete( axVolGate[ bVolNum ] );
+                            axVolGate[ bVolNum ] = NULL;
+                        }
+                    #endif
+                }
+            }
+        #endif
+
         return 0;
     }
 
@@ -132,4 +240,204 @@
         IGNORE_ERRORS( xSuccess );
     }
 
+
+    #if REDCONF_LOCK_PER_VOLUME == 1
+
+/** @brief Acquire the lock for a volume.
+ *
+ *  The caller must not hold the FS mutex, since the volume lock is ordered
+ *  before it.
+ *
+ *  @param bVolNum  The volume number of the volume to lock.
+ *  @param fShared  Whether to acquire the lock shared with other readers,
+ *                  rather than exclusively.  Only meaningful when
+ *                  #REDCONF_LOCK_SHARED_READERS is nonzero.
+ */
+        void RedOsVolMutexAcquire( uint8_t bVolNum,
+                                   bool fShared )
+        {
+            REDASSERT( bVolNum < REDCONF_VOLUME_COUNT );
+
+            #if REDCONF_LOCK_SHARED_READERS > 0U
+                while( !VolTokensTake( bVolNum, fShared ? 1U : REDCONF_LOCK_SHARED_READERS, portMAX_DELAY ) )
+                {
+                }
+            #else
+                REDASSERT( !fShared );
+                ( void ) fShared;
+
+                while( xSemaphoreTake( axVolMutex[ bVolNum ], portMAX_DELAY ) != pdTRUE )
+                {
+                }
+            #endif
+        }
+
+
+/** @brief Acquire the lock for a volume if it is available, without waiting.
+ *
+ *  Unlike RedOsVolMutexAcquire(), this may be called while holding the FS
+ *  mutex.
+ *
+ *  @param bVolNum  The volume number of the volume to lock.
+ *  @param fShared  Whether to acquire the lock shared with other readers,
+ *                  rather than exclusively.
+ *
+ *  @return Whether the volume lock was acquired.
+ */
+        bool RedOsVolMutexTryAcquire( uint8_t bVolNum,
+                                      bool fShared )
+        {
+            bool fAcquired;
+
+            REDASSERT( bVolNum < REDCONF_VOLUME_COUNT );
+
+            #if REDCONF_LOCK_SHARED_READERS > 0U
+                fAcquired = VolTokensTake( bVolNum, fShared ? 1U : REDCONF_LOCK_SHARED_READERS, 0U );
+            #else
+                REDASSERT( !fShared );
+                ( void ) fShared;
+
+                fAcquired = ( xSemaphoreTake( axVolMutex[ bVolNum ], 0U ) == pdTRUE );
+            #endif
+
+            return fAcquired;
+        }
+
+
+/** @brief Release the lock for a volume.
+ *
+ *  @param bVolNum  The volume number of the volume to unlock.
+ *  @param fShared  Whether the lock is held shared, as passed when it was
+ *                  acquired.
+ */
+        void RedOsVolMutexRelease( uint8_t bVolNum,
+                                   bool fShared )
+        {
+            REDASSERT( bVolNum < REDCONF_VOLUME_COUNT );
+
+            #if REDCONF_LOCK_SHARED_READERS > 0U
+                VolTokensGive( bVolNum, fShared ? 1U : REDCONF_LOCK_SHARED_READERS );
+            #else
+                {
+                    BaseType_t xSuccess;
+
+                    REDASSERT( !fShared );
+                    ( void ) fShared;
+
+                    xSuccess = xSemaphoreGive( axVolMutex[ bVolNum ] );
+                    REDASSERT( xSuccess == pdTRUE );
+                    IGNORE_ERRORS( xSuccess );
+                }
+            #endif
+        }
+
+
+/** @brief Acquire the block device lock for a volume.
+ *
+ *  The block device lock is the innermost lock: nothing else is acquired
+ *  while it is held.
+ *
+ *  @param bVolNum  The volume number of the block device to lock.
+ */
+        void RedOsBDevMutexAcquire( uint8_t bVolNum )
+        {
+            REDASSERT( bVolNum < REDCONF_VOLUME_COUNT );
+
+            while( xSemaphoreTake( axBDevMutex[ bVolNum ], portMAX_DELAY ) != pdTRUE )
+            {
+            }
+        }
+
+
+/** @brief Release the block device lock for a volume.
+ *
+ *  @param bVolNum  The volume number of the block device to unlock.
+ */
+        void RedOsBDevMutexRelease( uint8_t bVolNum )
+        {
+            BaseType_t xSuccess;
+
+            REDASSERT( bVolNum < REDCONF_VOLUME_COUNT );
+
+            xSuccess = xSemaphoreGive( axBDevMutex[ bVolNum ] );
+            REDASSERT( xSuccess == pdTRUE );
+            IGNORE_ERRORS( xSuccess );
+        }
+
+
+        #if REDCONF_LOCK_SHARED_READERS > 0U
+
+/** @brief Take tokens from the volume lock semaphore.
+ *
+ *  @param bVolNum      The volume number of the volume to lock.
+ *  @param uxCount      The number of tokens to take: one for a shared holder,
+ *                      all of them for an exclusive holder.
+ *  @param xTicksToWait How long to wait for the gate and for each token.
+ *
+ *  @return Whether the tokens were taken.  If not, none are held.
+ */
+            static bool VolTokensTake( uint8_t bVolNum,
+                                       UBaseType_t uxCount,
+                                       TickType_t xTicksToWait )
+            {
+                bool fTaken = false;
+
+                if( xSemaphoreTake( axVolGate[ bVolNum ], xTicksToWait ) == pdTRUE )
+                {
+                    UBaseType_t uxTaken;
+                    BaseType_t xSuccess;
+
+                    for( uxTaken = 0U; uxTaken < uxCount; uxTaken++ )
+                    {
+                        if( xSemaphoreTake( axVolMutex[ bVolNum ], xTicksToWait ) != pdTRUE )
+                        {
+                            break;
+                        }
+                    }
+
+                    if( uxTaken == uxCount )
+                    {
+                        fTaken = true;
+                    }
+                    else if( uxTaken > 0U )
+                    {
+                        VolTokensGive( bVolNum, uxTaken );
+                    }
+                    else
+                    {
+                        /*  Nothing taken, nothing to give back.
+                         */
+                    }
+
+                    xSuccess = xSemaphoreGive( axVolGate[ bVolNum ] );
+                    REDASSERT( xSuccess == pdTRUE );
+                    IGNORE_ERRORS( xSuccess );
+                }
+
+                return fTaken;
+            }
+
+
+/** @brief Give tokens back to the volume lock semaphore.
+ *
+ *  @param bVolNum  The volume number of the volume to unlock.
+ *  @param uxCount  The number of tokens to give.
+ */
+            static void VolTokensGive( uint8_t bVolNum,
+                                       UBaseType_t uxCount )
+            {
+                UBaseType_t uxGiven;
+
+                for( uxGiven = 0U; uxGiven < uxCount; uxGiven++ )
+                {
+                    BaseType_t xSuccess;
+
+                    xSuccess = xSemaphoreGive( axVolMutex[ bVolNum ] );
+                    REDASSERT( xSuccess == pdTRUE );
+                    IGNORE_ERRORS( xSuccess );
+                }
+            }
+        #endif /* REDCONF_LOCK_SHARED_READERS > 0U */
+    #endif /* REDCONF_LOCK_PER_VOLUME == 1 */
+
 #endif /* if REDCONF_TASK_COUNT > 1U */
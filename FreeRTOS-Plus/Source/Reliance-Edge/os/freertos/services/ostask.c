@@ -66,4 +66,447 @@
         return ulTaskPtr + 1U;
     }
 
+
+/*  Priority and stack depth (in words) of the tasks started by
+ *  RedOsWorkerTasksRun().
+ */
+    #ifndef REDCONF_WORKER_TASK_PRIORITY
+        #define REDCONF_WORKER_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1U )
+    #endif
+    #ifndef REDCONF_WORKER_TASK_STACK_SIZE
+        #define REDCONF_WORKER_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 8U )
+    #endif
+
+    #if ( INCLUDE_vTaskDelay == 1 ) && ( INCLUDE_vTaskDelete == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+        typedef struct
+        {
+            TaskHandle_t xTask; /* The worker task. */
+            uint32_t ulIndex;   /* Index passed to the work function. */
+        } WORKERTASK;
+
+        static void WorkerTask( void * pvParameters );
+
+        static WORKERTASK gaWorker[ REDCONF_TASK_COUNT ];
+        static void ( * gpfnWorkerWork )( uint32_t ulIndex );
+        static TaskHandle_t xWorkerParent;
+    #endif
+
+
+/** @brief Run a function in several tasks at once, and wait for all of them
+ *         to return.
+ *
+ *  Used by tests which measure how the file system scales with the number of
+ *  tasks using it.  The tasks are all created before any of them runs, so
+ *  that they start together, and are deleted once they have all returned.
+ *  Each task which calls the file system takes one of the #REDCONF_TASK_COUNT
+ *  task slots, so @p pfnWork should finish by calling red_taskrelease().
+ *
+ *  @param ulCount  The number of tasks to run, at most #REDCONF_TASK_COUNT.
+ *  @param pfnWork  The function to run; each task passes it a different index,
+ *                  from zero to @p ulCount minus one.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0               Operation was successful.
+ *  @retval -RED_EINVAL     @p pfnWork is `NULL`, or @p ulCount is zero or too
+ *                          large.
+ *  @retval -RED_ENOMEM     Not enough memory to create the tasks; none of
+ *                          them ran.
+ *  @retval -RED_ENOSYS     The FreeRTOS configuration cannot create and delete
+ *                          tasks at run time.
+ */
+    REDSTATUS RedOsWorkerTasksRun( uint32_t ulCount,
+                                   void ( * pfnWork )( uint32_t ulIndex ) )
+    {
+        REDSTATUS ret;
+
+        if( ( pfnWork == NULL ) || ( ulCount == 0U ) || ( ulCount > REDCONF_TASK_COUNT ) )
+        {
+            REDERROR();
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            #if ( INCLUDE_vTaskDelay == 1 ) && ( INCLUDE_vTaskDelete == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+                uint32_t ulIdx;
+
+                ret = 0;
+                gpfnWorkerWork = pfnWork;
+                xWorkerParent = xTaskGetCurrentTaskHandle();
+
+                vTaskSuspendAll();
+
+                for( ulIdx = 0U; ulIdx < ulCount; ulIdx++ )
+                {
+                    gaWorker[ ulIdx ].ulIndex = ulIdx;
+
+                    if( xTaskCreate( WorkerTask, "RedWorker", REDCONF_WORKER_TASK_STACK_SIZE, &gaWorker[ ulIdx ],
+                                     REDCONF_WORKER_TASK_PRIORITY, &gaWorker[ ulIdx ].xTask ) != pdPASS )
+                    {
+                        ret = -RED_ENOMEM;
+                        break;
+                    }
+                }
+
+                if( ret != 0 )
+                {
+                    /*  None of the tasks has run yet, so they can all be
+                     *  deleted without having touched the file system.
+                     */
+                    while( ulIdx > 0U )
+                    {
+                        ulIdx--;
+                        vTaskDelete( gaWorker[ ulIdx ].xTask );
+                    }
+                }
+
+                ( void ) xTaskResumeAll();
+
+                if( ret == 0 )
+                {
+                    for( ulIdx = 0U; ulIdx < ulCount; ulIdx++ )
+                    {
+                        ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+                    }
+
+                    /*  Every task has returned from the work function and is
+                     *  parked, so it can be deleted from here.
+                     */
+                    for( ulIdx = 0U; ulIdx < ulCount; ulIdx++ )
+                    {
+                        vTaskDelete( gaWorker[ ulIdx ].xTask );
+                    }
+                }
+            #else /* if ( INCLUDE_vTaskDelay == 1 ) && ( INCLUDE_vTaskDelete == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+                ret = -RED_ENOSYS;
+            #endif /* if ( INCLUDE_vTaskDelay == 1 ) && ( INCLUDE_vTaskDelete == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+        }
+
+        return ret;
+    }
+
+
+    #if ( INCLUDE_vTaskDelay == 1 ) && ( INCLUDE_vTaskDelete == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+/** @brief Body of a task started by RedOsWorkerTasksRun().
+ *
+ *  @param pvParameters The ::WORKERTASK of the task.
+ */
+        static void WorkerTask( void * pvParameters )
+        {
+            const WORKERTASK * pWorker = ( const WORKERTASK * ) pvParameters;
+
+            gpfnWorkerWork( pWorker->ulIndex );
+
+            ( void ) xTaskNotifyGive( xWorkerParent );
+
+            for( ; ; )
+            {
+                vTaskDelay( portMAX_DELAY );
+            }
+        }
+    #endif
+
 #endif /* if ( REDCONF_TASK_COUNT > 1U ) && ( REDCONF_API_POSIX == 1 ) */
+
+
+#if REDCONF_TRANSACT_TASK == 1
+
+    #if ( INCLUDE_vTaskDelay != 1 ) || ( INCLUDE_vTaskDelayUntil != 1 ) || ( INCLUDE_vTaskDelete != 1 )
+        #error "INCLUDE_vTaskDelay, INCLUDE_vTaskDelayUntil, and INCLUDE_vTaskDelete must be 1 when REDCONF_TRANSACT_TASK == 1"
+    #endif
+
+/*  Priority and stack depth (in words) of the transaction task.  The task only
+ *  needs to run when nothing more urgent is, but a priority above idle keeps
+ *  it from being starved by busy tasks at the idle priority.
+ */
+    #ifndef REDCONF_TRANSACT_TASK_PRIORITY
+        #define REDCONF_TRANSACT_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1U )
+    #endif
+    #ifndef REDCONF_TRANSACT_TASK_STACK_SIZE
+        #define REDCONF_TRANSACT_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4U )
+    #endif
+
+    static void TransactTask( void * pvParameters );
+
+    static TaskHandle_t xTransactTask;
+    static void ( * gpfnTransactPoll )( void );
+    static volatile bool gfTransactStop;
+    static volatile bool gfTransactStopped;
+    #if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        static StackType_t axTransactStack[ REDCONF_TRANSACT_TASK_STACK_SIZE ];
+        static StaticTask_t xTransactTaskBuffer;
+    #endif
+
+
+/** @brief Start the transaction task.
+ *
+ *  The task calls @p pfnPoll every #REDCONF_TRANSACT_TASK_PERIOD_MS
+ *  milliseconds, until it is stopped with RedOsTransactTaskStop().
+ *
+ *  The behavior of calling this function when the task is already running is
+ *  undefined.
+ *
+ *  @param pfnPoll  The function to call each period.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0               Operation was successful.
+ *  @retval -RED_EINVAL     @p pfnPoll is `NULL`.
+ *  @retval -RED_ENOMEM     Not enough memory to create the task.
+ */
+    REDSTATUS RedOsTransactTaskStart( void ( * pfnPoll )( void ) )
+    {
+        REDSTATUS ret = 0;
+
+        if( pfnPoll == NULL )
+        {
+            REDERROR();
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            gpfnTransactPoll = pfnPoll;
+            gfTransactStop = false;
+            gfTransactStopped = false;
+
+            #if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                xTransactTask = xTaskCreateStatic( TransactTask, "RedTransact", REDCONF_TRANSACT_TASK_STACK_SIZE, NULL,
+                                                   REDCONF_TRANSACT_TASK_PRIORITY, axTransactStack, &xTransactTaskBuffer );
+
+                if( xTransactTask == NULL )
+                {
+                    /*  The only error case for xTaskCreateStatic is that one of
+                     *  the buffer parameters is NULL, which is not the case.
+                     */
+                    REDERROR();
+                    ret = -RED_EINVAL;
+                }
+            #else
+                if( xTaskCreate( TransactTask, "RedTransact", REDCONF_TRANSACT_TASK_STACK_SIZE, NULL,
+                                 REDCONF_TRANSACT_TASK_PRIORITY, &xTransactTask ) != pdPASS )
+                {
+                    xTransactTask = NULL;
+                    ret = -RED_ENOMEM;
+                }
+            #endif /* if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
+        }
+
+        return ret;
+    }
+
+
+/** @brief Stop the transaction task.
+ *
+ *  Waits for the task to wake up and finish any poll in progress, which may
+ *  take up to one period, then deletes the task.  Does nothing
+ *  if the task is not running.  Must not be called from the transaction task
+ *  itself.
+ */
+    void RedOsTransactTaskStop( void )
+    {
+        if( xTransactTask != NULL )
+        {
+            gfTransactStop = true;
+
+            while( !gfTransactStopped )
+            {
+                vTaskDelay( 1U );
+            }
+
+            /*  The task is parked and no longer touches the file system, so it
+             *  can be deleted from here; deleting another task frees it at
+             *  once, which deleting itself would not.
+             */
+            vTaskDelete( xTransactTask );
+            xTransactTask = NULL;
+        }
+    }
+
+
+/** @brief Body of the transaction task.
+ *
+ *  @param pvParameters Unused.
+ */
+    static void TransactTask( void * pvParameters )
+    {
+        TickType_t xLastWake = xTaskGetTickCount();
+
+        ( void ) pvParameters;
+
+        while( !gfTransactStop )
+        {
+            vTaskDelayUntil( &xLastWake, pdMS_TO_TICKS( REDCONF_TRANSACT_TASK_PERIOD_MS ) );
+
+            if( !gfTransactStop )
+            {
+                gpfnTransactPoll();
+            }
+        }
+
+        gfTransactStopped = true;
+
+        for( ; ; )
+        {
+            vTaskDelay( portMAX_DELAY );
+        }
+    }
+
+#endif /* REDCONF_TRANSACT_TASK == 1 */
+
+
+#if REDCONF_WRITE_BEHIND_BYTES > 0U
+
+    #if ( INCLUDE_vTaskDelay != 1 ) || ( INCLUDE_vTaskDelete != 1 )
+        #error "INCLUDE_vTaskDelay and INCLUDE_vTaskDelete must be 1 when REDCONF_WRITE_BEHIND_BYTES > 0"
+    #endif
+    #if defined( configUSE_TASK_NOTIFICATIONS ) && ( configUSE_TASK_NOTIFICATIONS == 0 )
+        #error "configUSE_TASK_NOTIFICATIONS must be 1 when REDCONF_WRITE_BEHIND_BYTES > 0"
+    #endif
+
+/*  Priority and stack depth (in words) of the write-behind task.  Queued writes
+ *  are only finished promptly if the task can preempt the tasks which queue
+ *  them, so by default it runs above the idle priority like the transaction
+ *  task; raise it if writers at higher priorities keep the ring full.
+ */
+    #ifndef REDCONF_WRITE_BEHIND_TASK_PRIORITY
+        #define REDCONF_WRITE_BEHIND_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1U )
+    #endif
+    #ifndef REDCONF_WRITE_BEHIND_TASK_STACK_SIZE
+        #define REDCONF_WRITE_BEHIND_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4U )
+    #endif
+
+    static void WriteBehindTask( void * pvParameters );
+
+    static TaskHandle_t xWriteBehindTask;
+    static void ( * gpfnWriteBehindWork )( void );
+    static volatile bool gfWriteBehindStop;
+    static volatile bool gfWriteBehindStopped;
+    #if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        static StackType_t axWriteBehindStack[ REDCONF_WRITE_BEHIND_TASK_STACK_SIZE ];
+        static StaticTask_t xWriteBehindTaskBuffer;
+    #endif
+
+
+/** @brief Start the write-behind task.
+ *
+ *  The task calls @p pfnWork each time it is woken with
+ *  RedOsWriteBehindSignal(), until it is stopped with
+ *  RedOsWriteBehindTaskStop().
+ *
+ *  The behavior of calling this function when the task is already running is
+ *  undefined.
+ *
+ *  @param pfnWork  The function which finishes the queued writes.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0               Operation was successful.
+ *  @retval -RED_EINVAL     @p pfnWork is `NULL`.
+ *  @retval -RED_ENOMEM     Not enough memory to create the task.
+ */
+    REDSTATUS RedOsWriteBehindTaskStart( void ( * pfnWork )( void ) )
+    {
+        REDSTATUS ret = 0;
+
+        if( pfnWork == NULL )
+        {
+            REDERROR();
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            gpfnWriteBehindWork = pfnWork;
+            gfWriteBehindStop = false;
+            gfWriteBehindStopped = false;
+
+            #if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                xWriteBehindTask = xTaskCreateStatic( WriteBehindTask, "RedWriteBehind", REDCONF_WRITE_BEHIND_TASK_STACK_SIZE, NULL,
+                                                      REDCONF_WRITE_BEHIND_TASK_PRIORITY, axWriteBehindStack, &xWriteBehindTaskBuffer );
+
+                if( xWriteBehindTask == NULL )
+                {
+                    /*  The only error case for xTaskCreateStatic is that one of
+                     *  the buffer parameters is NULL, which is not the case.
+                     */
+                    REDERROR();
+                    ret = -RED_EINVAL;
+                }
+            #else
+                if( xTaskCreate( WriteBehindTask, "RedWriteBehind", REDCONF_WRITE_BEHIND_TASK_STACK_SIZE, NULL,
+                                 REDCONF_WRITE_BEHIND_TASK_PRIORITY, &xWriteBehindTask ) != pdPASS )
+                {
+                    xWriteBehindTask = NULL;
+                    ret = -RED_ENOMEM;
+                }
+            #endif /* if defined( configSUPPORT_STATIC_ALLOCATION ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) */
+        }
+
+        return ret;
+    }
+
+
+/** @brief Stop the write-behind task.
+ *
+ *  Wakes the task and waits for it to finish any work in progress, then
+ *  deletes the task.  Does nothing if the task is not running.  Must not be
+ *  called from the write-behind task itself.
+ */
+    void RedOsWriteBehindTaskStop( void )
+    {
+        if( xWriteBehindTask != NULL )
+        {
+            gfWriteBehindStop = true;
+
+            while( !gfWriteBehindStopped )
+            {
+                xTaskNotifyGive( xWriteBehindTask );
+                vTaskDelay( 1U );
+            }
+
+            vTaskDelete( xWriteBehindTask );
+            xWriteBehindTask = NULL;
+        }
+    }
+
+
+/** @brief Wake the write-behind task, after a write has been queued.
+ *
+ *  Wakeups are counted, so a signal sent while the task is busy is not lost.
+ */
+    void RedOsWriteBehindSignal( void )
+    {
+        if( xWriteBehindTask != NULL )
+        {
+            xTaskNotifyGive( xWriteBehindTask );
+        }
+    }
+
+
+/** @brief Body of the write-behind task.
+ *
+ *  @param pvParameters Unused.
+ */
+    static void WriteBehindTask( void * pvParameters )
+    {
+        ( void ) pvParameters;
+
+        while( !gfWriteBehindStop )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+            if( !gfWriteBehindStop )
+            {
+                gpfnWriteBehindWork();
+            }
+        }
+
+        gfWriteBehindStopped = true;
+
+        for( ; ; )
+        {
+            vTaskDelay( portMAX_DELAY );
+        }
+    }
+
+#endif /* REDCONF_WRITE_BEHIND_BYTES > 0U */
@@ -37,8 +37,38 @@
     #include <redpath.h>
 
 
+    #if REDCONF_PATH_CACHE_ENTRIES > 0U
+
+/** @brief An entry in the path component cache.
+ */
+        typedef struct
+        {
+            uint8_t bVolNum;                   /**< Volume of the parent directory. */
+            uint32_t ulPInode;                 /**< Parent directory inode, or INODE_INVALID if the entry is unused. */
+            uint32_t ulInode;                  /**< Inode named by acName in ulPInode. */
+            uint32_t ulHash;                   /**< Hash of acName, to speed up comparisons. */
+            uint32_t ulLastUse;                /**< Value of gulPathCacheTick when the entry was last used. */
+            char acName[ REDCONF_NAME_MAX ];   /**< Name; not null terminated if of the maximum length. */
+        } PATHCACHEENTRY;
+    #endif
+
+
     static bool IsRootDir( const char * pszLocalPath );
     static bool PathHasMoreNames( const char * pszPathIdx );
+    #if REDCONF_PATH_CACHE_ENTRIES > 0U
+        static uint32_t PathNameHash( const char * pszName,
+                                      uint32_t ulNameLen );
+        static bool PathCacheEntryMatches( const PATHCACHEENTRY * pEntry,
+                                           uint32_t ulPInode,
+                                           const char * pszName,
+                                           uint32_t ulNameLen,
+                                           uint32_t ulHash );
+
+
+        static PATHCACHEENTRY gaPathCache[ REDCONF_PATH_CACHE_ENTRIES ];
+        static uint32_t gulPathCacheTick;
+        static REDPATHCACHESTATS gPathCacheStats;
+    #endif
 
 
 /** @brief Split a path into its component parts: a volume and a volume-local
@@ -236,7 +266,7 @@
 
             if( ret == 0 )
             {
-                ret = RedCoreLookup( ulPInode, pszName, pulInode );
+                ret = RedPathLookupName( ulPInode, pszName, pulInode );
             }
         }
 
@@ -336,7 +366,7 @@
                  */
                 if( PathHasMoreNames( &pszLocalPath[ ulPathIdx + ulNameLen ] ) )
                 {
-                    ret = RedCoreLookup( ulPInode, &pszLocalPath[ ulPathIdx ], &ulInode );
+                    ret = RedPathLookupName( ulPInode, &pszLocalPath[ ulPathIdx ], &ulInode );
                 }
 
                 /*  Move on to the next path element.
@@ -359,6 +389,228 @@
     }
 
 
+/** @brief Look up a name in a directory, using the path component cache.
+ *
+ *  Takes the same parameters, and returns the same errors, as RedCoreLookup(),
+ *  which is called when the component is not cached.
+ *
+ *  @param ulPInode The inode number of the parent directory.
+ *  @param pszName  The name to look up, terminated by a null or a path
+ *                  separator.
+ *  @param pulInode On successful return, populated with the inode number named
+ *                  by @p pszName.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ */
+    REDSTATUS RedPathLookupName( uint32_t ulPInode,
+                                 const char * pszName,
+                                 uint32_t * pulInode )
+    {
+        REDSTATUS ret;
+
+        #if REDCONF_PATH_CACHE_ENTRIES > 0U
+            uint32_t ulNameLen = ( pszName == NULL ) ? 0U : RedNameLen( pszName );
+            PATHCACHEENTRY * pEntry = NULL;
+
+            if( ( pulInode != NULL ) && ( ulNameLen > 0U ) && ( ulNameLen <= REDCONF_NAME_MAX ) )
+            {
+                uint32_t ulHash = PathNameHash( pszName, ulNameLen );
+                uint32_t ulIdx;
+
+                gulPathCacheTick++;
+
+                for( ulIdx = 0U; ulIdx < REDCONF_PATH_CACHE_ENTRIES; ulIdx++ )
+                {
+                    if( PathCacheEntryMatches( &gaPathCache[ ulIdx ], ulPInode, pszName, ulNameLen, ulHash ) )
+                    {
+                        pEntry = &gaPathCache[ ulIdx ];
+                        break;
+                    }
+                }
+
+                if( pEntry != NULL )
+                {
+                    gPathCacheStats.ulHits++;
+                    pEntry->ulLastUse = gulPathCacheTick;
+                    *pulInode = pEntry->ulInode;
+                    ret = 0;
+                }
+                else
+                {
+                    gPathCacheStats.ulMisses++;
+
+                    ret = RedCoreLookup( ulPInode, pszName, pulInode );
+
+                    if( ret == 0 )
+                    {
+                        /*  Replace an unused entry, or else the least recently used
+                         *  entry.
+                         */
+                        pEntry = &gaPathCache[ 0U ];
+
+                        for( ulIdx = 1U; ( ulIdx < REDCONF_PATH_CACHE_ENTRIES ) && ( pEntry->ulPInode != INODE_INVALID ); ulIdx++ )
+                        {
+                            if( ( gaPathCache[ ulIdx ].ulPInode == INODE_INVALID ) || ( gaPathCache[ ulIdx ].ulLastUse < pEntry->ulLastUse ) )
+                            {
+                                pEntry = &gaPathCache[ ulIdx ];
+                            }
+                        }
+
+                        pEntry->bVolNum = gbRedVolNum;
+                        pEntry->ulPInode = ulPInode;
+                        pEntry->ulInode = *pulInode;
+                        pEntry->ulHash = ulHash;
+                        pEntry->ulLastUse = gulPathCacheTick;
+                        RedMemSet( pEntry->acName, 0U, sizeof( pEntry->acName ) );
+                        RedMemCpy( pEntry->acName, pszName, ulNameLen );
+                    }
+                }
+            }
+            else
+            {
+                /*  Let the core report the error.
+                 */
+                ret = RedCoreLookup( ulPInode, pszName, pulInode );
+            }
+        #else /* if REDCONF_PATH_CACHE_ENTRIES > 0U */
+            ret = RedCoreLookup( ulPInode, pszName, pulInode );
+        #endif /* if REDCONF_PATH_CACHE_ENTRIES > 0U */
+
+        return ret;
+    }
+
+
+    #if REDCONF_PATH_CACHE_ENTRIES > 0U
+
+/** @brief Remove a name from the path component cache.
+ *
+ *  Must be called before a name is unlinked or renamed, including when a
+ *  directory is removed or a rename replaces an existing name.
+ *
+ *  @param ulPInode The inode number of the parent directory on the current
+ *                  volume.
+ *  @param pszName  The name, terminated by a null or a path separator.
+ */
+        void RedPathCacheRemove( uint32_t ulPInode,
+                                 const char * pszName )
+        {
+            if( pszName == NULL )
+            {
+                REDERROR();
+            }
+            else
+            {
+                uint32_t ulNameLen = RedNameLen( pszName );
+
+                if( ulNameLen <= REDCONF_NAME_MAX )
+                {
+                    uint32_t ulHash = PathNameHash( pszName, ulNameLen );
+                    uint32_t ulIdx;
+
+                    for( ulIdx = 0U; ulIdx < REDCONF_PATH_CACHE_ENTRIES; ulIdx++ )
+                    {
+                        if( PathCacheEntryMatches( &gaPathCache[ ulIdx ], ulPInode, pszName, ulNameLen, ulHash ) )
+                        {
+                            gaPathCache[ ulIdx ].ulPInode = INODE_INVALID;
+                        }
+                    }
+                }
+            }
+        }
+
+
+/** @brief Remove every entry for a volume from the path component cache.
+ *
+ *  @param bVolNum  The volume number.
+ */
+        void RedPathCacheDiscard( uint8_t bVolNum )
+        {
+            uint32_t ulIdx;
+
+            for( ulIdx = 0U; ulIdx < REDCONF_PATH_CACHE_ENTRIES; ulIdx++ )
+            {
+                if( gaPathCache[ ulIdx ].bVolNum == bVolNum )
+                {
+                    gaPathCache[ ulIdx ].ulPInode = INODE_INVALID;
+                }
+            }
+        }
+
+
+/** @brief Read the path component cache statistics.
+ *
+ *  @param pStats   Populated with the statistics.
+ *  @param fReset   Whether to zero the statistics after reading them.
+ */
+        void RedPathCacheStats( REDPATHCACHESTATS * pStats,
+                                bool fReset )
+        {
+            if( pStats == NULL )
+            {
+                REDERROR();
+            }
+            else
+            {
+                *pStats = gPathCacheStats;
+
+                if( fReset )
+                {
+                    RedMemSet( &gPathCacheStats, 0U, sizeof( gPathCacheStats ) );
+                }
+            }
+        }
+
+
+/** @brief Determine whether a path component cache entry is for a given name.
+ *
+ *  @param pEntry       The cache entry to examine.
+ *  @param ulPInode     The parent directory inode number.
+ *  @param pszName      The name.
+ *  @param ulNameLen    The length of @p pszName.
+ *  @param ulHash       The hash of @p pszName.
+ *
+ *  @return Whether @p pEntry is for @p pszName in @p ulPInode on the current
+ *          volume.
+ */
+        static bool PathCacheEntryMatches( const PATHCACHEENTRY * pEntry,
+                                           uint32_t ulPInode,
+                                           const char * pszName,
+                                           uint32_t ulNameLen,
+                                           uint32_t ulHash )
+        {
+            return ( pEntry->ulPInode == ulPInode ) &&
+                   ( ulPInode != INODE_INVALID ) &&
+                   ( pEntry->bVolNum == gbRedVolNum ) &&
+                   ( pEntry->ulHash == ulHash ) &&
+                   ( RedStrNCmp( pEntry->acName, pszName, ulNameLen ) == 0 ) &&
+                   ( ( ulNameLen == REDCONF_NAME_MAX ) || ( pEntry->acName[ ulNameLen ] == '\0' ) );
+        }
+
+
+/** @brief Hash a path component.
+ *
+ *  @param pszName      The name to hash.
+ *  @param ulNameLen    The length of @p pszName.
+ *
+ *  @return The 32-bit FNV-1a hash of the name.
+ */
+        static uint32_t PathNameHash( const char * pszName,
+                                      uint32_t ulNameLen )
+        {
+            uint32_t ulHash = 2166136261U;
+            uint32_t ulIdx;
+
+            for( ulIdx = 0U; ulIdx < ulNameLen; ulIdx++ )
+            {
+                ulHash ^= ( uint8_t ) pszName[ ulIdx ];
+                ulHash *= 16777619U;
+            }
+
+            return ulHash;
+        }
+    #endif /* REDCONF_PATH_CACHE_ENTRIES > 0U */
+
+
 /** @brief Determine whether a path names the root directory.
  *
  *  @param pszLocalPath The path to examine; this is a local path, without any
@@ -88,6 +88,10 @@
     #define HFLAG_WRITEABLE    0x04U /* Handle is writeable. */
     #define HFLAG_APPENDING    0x08U /* Handle was opened in append mode. */
 
+    #if REDCONF_LOCK_PER_VOLUME == 1
+        #define HANDLE_INODE_RESERVED    UINT32_MAX /* Handle is reserved by an open in progress. */
+    #endif
+
 /*  @brief Handle structure, used to implement file descriptors and directory
  *         streams.
  */
@@ -100,6 +104,9 @@
         #if REDCONF_API_POSIX_READDIR == 1
             REDDIRENT dirent; /**< Dirent structure returned by red_readdir(). */
         #endif
+        #if REDCONF_WRITE_BEHIND_BYTES > 0U
+            REDSTATUS wbError; /**< First error of a queued write through this handle; zero if none. */
+        #endif
     } REDHANDLE;
 
 /*-------------------------------------------------------------------
@@ -114,9 +121,48 @@
         {
             uint32_t ulTaskId; /**< ID of the task which owns this slot; 0 if free. */
             REDSTATUS iErrno;  /**< Last error value. */
+            #if REDCONF_LOCK_PER_VOLUME == 1
+                bool fVolLocked;   /**< Whether this task holds a volume lock. */
+                uint8_t bVolLocked; /**< The volume whose lock this task holds, if fVolLocked. */
+                bool fVolShared;    /**< Whether the current call locks its volume shared. */
+            #endif
         } TASKSLOT;
     #endif
 
+/*-------------------------------------------------------------------
+ *   Lent buffers
+ *  -------------------------------------------------------------------*/
+
+    #if REDCONF_READBUF_COUNT > 0U
+
+/*  @brief A block of file data lent out by red_readbuf().
+ */
+        typedef struct
+        {
+            const REDHANDLE * pHandle; /**< Handle the data was read through; `NULL` if the entry is free. */
+            const uint8_t * pbBlock;   /**< Start of the lent block; `NULL` while the read is in progress. */
+            const uint8_t * pbData;    /**< Data pointer given to the borrower. */
+        } READBUF;
+    #endif
+
+/*-------------------------------------------------------------------
+ *   Write-behind queue
+ *  -------------------------------------------------------------------*/
+
+    #if REDCONF_WRITE_BEHIND_BYTES > 0U
+
+/*  @brief A write queued by red_write(), whose data is in the staging ring.
+ */
+        typedef struct
+        {
+            REDHANDLE * pHandle; /**< Handle the data was written through. */
+            uint64_t ullOffset;  /**< File offset to write at, unless appending. */
+            uint32_t ulPos;      /**< Position of the data in the staging ring. */
+            uint32_t ulLen;      /**< Length of the data, in bytes. */
+            bool fAppend;        /**< Whether the data is written at the end-of-file. */
+        } WBENTRY;
+    #endif
+
 /*-------------------------------------------------------------------
  *   Local Prototypes
  *  -------------------------------------------------------------------*/
@@ -143,15 +189,53 @@
         static bool DirStreamIsValid( const REDDIR * pDirStream );
     #endif
     static REDSTATUS PosixEnter( void );
+    static REDSTATUS PosixEnterNoFence( void );
     static void PosixLeave( void );
+    #if REDCONF_VOLUME_COUNT > 1U
+        static REDSTATUS PosixVolSetCurrent( uint8_t bVolNum );
+    #endif
+    #if REDCONF_LOCK_PER_VOLUME == 1
+        static REDSTATUS PosixVolLock( uint8_t bVolNum );
+    #endif
+    #if REDCONF_LOCK_SHARED_READERS > 0U
+        static REDSTATUS PosixEnterShared( void );
+    #else
+        #define PosixEnterShared    PosixEnter
+    #endif
     static REDSTATUS ModeTypeCheck( uint16_t uMode,
                                     FTYPE expectedType );
     #if ( REDCONF_READ_ONLY == 0 ) && ( ( REDCONF_API_POSIX_UNLINK == 1 ) || ( REDCONF_API_POSIX_RMDIR == 1 ) || ( ( REDCONF_API_POSIX_RENAME == 1 ) && ( REDCONF_RENAME_ATOMIC == 1 ) ) )
         static REDSTATUS InodeUnlinkCheck( uint32_t ulInode );
     #endif
+    #if REDCONF_READBUF_COUNT > 0U
+        static void ReadBufReleaseHandle( const REDHANDLE * pHandle );
+    #endif
+    #if ( REDCONF_READBUF_COUNT > 0U ) && ( REDCONF_READ_ONLY == 0 )
+        static REDSTATUS ReadBufInodeCheck( uint8_t bVolNum,
+                                            uint32_t ulInode );
+    #else
+        #define ReadBufInodeCheck( bVolNum, ulInode )    ( 0 )
+    #endif
     #if REDCONF_TASK_COUNT > 1U
         static REDSTATUS TaskRegister( uint32_t * pulTaskIdx );
     #endif
+    #if REDCONF_TRANSACT_TASK == 1
+        static void TransactTaskPoll( void );
+    #endif
+    #if REDCONF_WRITE_BEHIND_BYTES > 0U
+        static void WriteBehindQueue( REDHANDLE * pHandle,
+                                      const uint8_t * pbBuffer,
+                                      uint32_t ulLen );
+        static bool WriteBehindReserve( uint32_t ulLen,
+                                        uint32_t * pulPos );
+        static void WriteBehindApply( void );
+        static void WriteBehindFence( void );
+        static void WriteBehindWork( void );
+    #endif
+    #if REDCONF_LATENCY_STATS == 1
+        static void LatencyRecord( uint32_t ulOp,
+                                   REDTIMESTAMP tsStart );
+    #endif
     static int32_t PosixReturn( REDSTATUS iError );
 
 /*-------------------------------------------------------------------
@@ -163,6 +247,24 @@
     #if REDCONF_TASK_COUNT > 1U
         static TASKSLOT gaTask[ REDCONF_TASK_COUNT ];  /* Array of task slots. */
     #endif
+    #if REDCONF_READBUF_COUNT > 0U
+        static READBUF gaReadBuf[ REDCONF_READBUF_COUNT ]; /* Array of lent buffers. */
+    #endif
+    #if REDCONF_WRITE_BEHIND_BYTES > 0U
+        static uint8_t gabWbRing[ REDCONF_WRITE_BEHIND_BYTES ];     /* Staging ring for the data of queued writes. */
+        static WBENTRY gaWbEntry[ REDCONF_WRITE_BEHIND_ENTRIES ]; /* Queued writes, oldest first from gulWbFirst. */
+        static uint32_t gulWbFirst;                                /* Index of the oldest queued write. */
+        static uint32_t gulWbCount;                                /* Number of queued writes. */
+        static uint32_t gulWbNextPos;                              /* Ring position after the data of the newest queued write. */
+        static uint32_t gulWbBytes;                                /* Bytes of data queued. */
+        static REDWBSTATS gWbStats;                                /* Write-behind statistics. */
+    #endif
+    #if ( REDCONF_STATS == 1 ) && ( REDCONF_TASK_COUNT > 1U )
+        static REDLOCKSTATS gLockStats; /* Lock contention statistics. */
+    #endif
+    #if REDCONF_LATENCY_STATS == 1
+        static REDLATSTATS gLatStats; /* Latency histograms of the timed calls. */
+    #endif
 
 /*  Array of volume mount "generations".  These are incremented for a volume
  *  each time that volume is mounted.  The generation number (along with the
@@ -189,11 +291,17 @@
  *  This function is not thread safe: attempting to initialize from multiple
  *  threads could leave things in a bad state.
  *
+ *  When #REDCONF_TRANSACT_TASK is enabled, this also starts the background
+ *  transaction task, which runs until red_uninit().  Likewise, when
+ *  #REDCONF_WRITE_BEHIND_BYTES is non-zero, this starts the write-behind task.
+ *
  *  @return On success, zero is returned.  On error, -1 is returned and
  #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
  *  - #RED_EINVAL: The volume path prefix configuration is invalid.
+ *  - #RED_ENOMEM: Not enough memory to create the transaction task or the
+ *    write-behind task.
  */
     int32_t red_init( void )
     {
@@ -215,7 +323,48 @@
                     RedMemSet( gaTask, 0U, sizeof( gaTask ) );
                 #endif
 
+                #if ( REDCONF_STATS == 1 ) && ( REDCONF_TASK_COUNT > 1U )
+                    RedMemSet( &gLockStats, 0U, sizeof( gLockStats ) );
+                #endif
+
+                #if REDCONF_LATENCY_STATS == 1
+                    RedMemSet( &gLatStats, 0U, sizeof( gLatStats ) );
+                #endif
+
                 gfPosixInited = true;
+
+                #if REDCONF_TRANSACT_TASK == 1
+                    ret = RedOsTransactTaskStart( TransactTaskPoll );
+
+                    if( ret != 0 )
+                    {
+                        gfPosixInited = false;
+                        ( void ) RedCoreUninit();
+                    }
+                #endif
+
+                #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                    if( ret == 0 )
+                    {
+                        gulWbFirst = 0U;
+                        gulWbCount = 0U;
+                        gulWbNextPos = 0U;
+                        gulWbBytes = 0U;
+                        RedMemSet( &gWbStats, 0U, sizeof( gWbStats ) );
+
+                        ret = RedOsWriteBehindTaskStart( WriteBehindWork );
+
+                        if( ret != 0 )
+                        {
+                            #if REDCONF_TRANSACT_TASK == 1
+                                RedOsTransactTaskStop();
+                            #endif
+
+                            gfPosixInited = false;
+                            ( void ) RedCoreUninit();
+                        }
+                    }
+                #endif
             }
         }
 
@@ -247,6 +396,18 @@
 
         if( gfPosixInited )
         {
+            #if REDCONF_TRANSACT_TASK == 1
+
+                /*  Stop the transaction task before tearing anything down, so
+                 *  that it is not using the FS mutex when it gets uninitialized.
+                 */
+                RedOsTransactTaskStop();
+            #endif
+
+            #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                RedOsWriteBehindTaskStop();
+            #endif
+
             ret = PosixEnter();
 
             if( ret == 0 )
@@ -293,6 +454,31 @@
                  */
                 REDASSERT( ret == 0 );
             }
+
+            #if REDCONF_TRANSACT_TASK == 1
+                if( gfPosixInited )
+                {
+                    REDSTATUS restartRet;
+
+                    /*  The driver is still initialized, so put the transaction
+                     *  task back.
+                     */
+                    restartRet = RedOsTransactTaskStart( TransactTaskPoll );
+                    REDASSERT( restartRet == 0 );
+                    ( void ) restartRet;
+                }
+            #endif
+
+            #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                if( gfPosixInited )
+                {
+                    REDSTATUS restartRet;
+
+                    restartRet = RedOsWriteBehindTaskStart( WriteBehindWork );
+                    REDASSERT( restartRet == 0 );
+                    ( void ) restartRet;
+                }
+            #endif
         }
         else
         {
@@ -335,6 +521,15 @@
 
             ret = RedPathSplit( pszVolume, &bVolNum, NULL );
 
+            #if REDCONF_LOCK_PER_VOLUME == 1
+                /*  Lock the volume before examining its state.
+                 */
+                if( ret == 0 )
+                {
+                    ret = PosixVolLock( bVolNum );
+                }
+            #endif
+
             /*  The core will return success if the volume is already mounted, so
              *  check for that condition here to propagate the error.
              */
@@ -346,7 +541,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( bVolNum );
+                    ret = PosixVolSetCurrent( bVolNum );
                 }
             #endif
 
@@ -355,6 +550,15 @@
                 ret = RedCoreVolMount();
             }
 
+            #if REDCONF_PATH_CACHE_ENTRIES > 0U
+                if( ret == 0 )
+                {
+                    /*  The volume may have changed since it was last mounted.
+                     */
+                    RedPathCacheDiscard( bVolNum );
+                }
+            #endif
+
             if( ret == 0 )
             {
                 /*  Increment the mount generation, invalidating file descriptors
@@ -430,6 +634,15 @@
 
             ret = RedPathSplit( pszVolume, &bVolNum, NULL );
 
+            #if REDCONF_LOCK_PER_VOLUME == 1
+                /*  Lock the volume before examining its state and its handles.
+                 */
+                if( ret == 0 )
+                {
+                    ret = PosixVolLock( bVolNum );
+                }
+            #endif
+
             /*  The core will return success if the volume is already unmounted, so
              *  check for that condition here to propagate the error.
              */
@@ -459,7 +672,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( bVolNum );
+                    ret = PosixVolSetCurrent( bVolNum );
                 }
             #endif
 
@@ -511,7 +724,7 @@
                 #if REDCONF_VOLUME_COUNT > 1U
                     if( ret == 0 )
                     {
-                        ret = RedCoreVolSetCurrent( bVolNum );
+                        ret = PosixVolSetCurrent( bVolNum );
                     }
                 #endif
 
@@ -555,6 +768,10 @@
         {
             REDSTATUS ret;
 
+            #if REDCONF_LATENCY_STATS == 1
+                REDTIMESTAMP tsStart = RedOsTimestamp();
+            #endif
+
             ret = PosixEnter();
 
             if( ret == 0 )
@@ -566,7 +783,7 @@
                 #if REDCONF_VOLUME_COUNT > 1U
                     if( ret == 0 )
                     {
-                        ret = RedCoreVolSetCurrent( bVolNum );
+                        ret = PosixVolSetCurrent( bVolNum );
                     }
                 #endif
 
@@ -575,6 +792,10 @@
                     ret = RedCoreVolTransact();
                 }
 
+                #if REDCONF_LATENCY_STATS == 1
+                    LatencyRecord( RED_LATOP_TRANSACT, tsStart );
+                #endif
+
                 PosixLeave();
             }
 
@@ -639,7 +860,7 @@
                 #if REDCONF_VOLUME_COUNT > 1U
                     if( ret == 0 )
                     {
-                        ret = RedCoreVolSetCurrent( bVolNum );
+                        ret = PosixVolSetCurrent( bVolNum );
                     }
                 #endif
 
@@ -691,7 +912,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( bVolNum );
+                    ret = PosixVolSetCurrent( bVolNum );
                 }
             #endif
 
@@ -741,7 +962,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( bVolNum );
+                    ret = PosixVolSetCurrent( bVolNum );
                 }
             #endif
 
@@ -757,170 +978,84 @@
     }
 
 
-/** @brief Open a file or directory.
- *
- *  Exactly one file access mode must be specified:
- *
- *  - #RED_O_RDONLY: Open for reading only.
- *  - #RED_O_WRONLY: Open for writing only.
- *  - #RED_O_RDWR: Open for reading and writing.
- *
- *  Directories can only be opened with `RED_O_RDONLY`.
- *
- *  The following flags may also be used:
- *
- *  - #RED_O_APPEND: Set the file offset to the end-of-file prior to each
- *    write.
- *  - #RED_O_CREAT: Create the named file if it does not exist.
- *  - #RED_O_EXCL: In combination with `RED_O_CREAT`, return an error if the
- *    path already exists.
- *  - #RED_O_TRUNC: Truncate the opened file to size zero.  Only supported when
- #REDCONF_API_POSIX_FTRUNCATE is true.
- *
- #RED_O_CREAT, #RED_O_EXCL, and #RED_O_TRUNC are invalid with #RED_O_RDONLY.
- #RED_O_EXCL is invalid without #RED_O_CREAT.
- *
- *  If the volume is read-only, #RED_O_RDONLY is the only valid open flag; use
- *  of any other flag will result in an error.
- *
- *  If #RED_O_TRUNC frees data which is in the committed state, it will not
- *  return to free space until after a transaction point.
+    #if REDCONF_STATS == 1
+
+/** @brief Query I/O and cache statistics for a volume.
  *
- *  The returned file descriptor must later be closed with red_close().
+ *  The statistics are kept whether or not the volume is mounted, and are
+ *  useful for tuning #REDCONF_BUFFER_COUNT and related settings: for example,
+ *  a high ratio of buffer misses to hits, or many write-backs, indicate that
+ *  more buffers would help.
  *
- *  Unlike POSIX open, there is no optional third argument for the permissions
- *  (which Reliance Edge does not use) and other open flags (like `O_SYNC`) are
- *  not supported.
+ *  @p pszVolume should name a valid volume prefix or a valid root directory.
  *
- *  @param pszPath      The path to the file or directory.
- *  @param ulOpenMode   The open flags (mask of `RED_O_` values).
+ *  @param pszVolume    The path prefix of the volume to query.
+ *  @param pStats       The buffer to populate with the statistics.
+ *  @param fReset       Whether to zero the statistics after reading them.
  *
- *  @return On success, a nonnegative file descriptor is returned.  On error,
- *          -1 is returned and #red_errno is set appropriately.
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
- *  - #RED_EEXIST: Using #RED_O_CREAT and #RED_O_EXCL, and the indicated path
- *    already exists.
- *  - #RED_EINVAL: @p ulOpenMode is invalid; or @p pszPath is `NULL`; or the
- *    volume containing the path is not mounted.
- *  - #RED_EIO: A disk I/O error occurred.
- *  - #RED_EISDIR: The path names a directory and @p ulOpenMode includes
- #RED_O_WRONLY or #RED_O_RDWR.
- *  - #RED_EMFILE: There are no available file descriptors.
- *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
- #REDCONF_NAME_MAX.
- *  - #RED_ENFILE: Attempting to create a file but the file system has used all
- *    available inode slots.
- *  - #RED_ENOENT: #RED_O_CREAT is not set and the named file does not exist; or
- #RED_O_CREAT is set and the parent directory does not exist; or the
- *    volume does not exist; or the @p pszPath argument, after removing the
- *    volume prefix, points to an empty string.
- *  - #RED_ENOSPC: The file does not exist and #RED_O_CREAT was specified, but
- *    there is insufficient free space to expand the directory or to create the
- *    new file.
- *  - #RED_ENOTDIR: A component of the prefix in @p pszPath does not name a
- *    directory.
- *  - #RED_EROFS: The path resides on a read-only file system and a write
- *    operation was requested.
+ *  - #RED_EINVAL: @p pszVolume is `NULL`; or @p pStats is `NULL`; or the
+ *    driver is uninitialized.
+ *  - #RED_ENOENT: @p pszVolume is not a valid volume path prefix.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
  */
-    int32_t red_open( const char * pszPath,
-                      uint32_t ulOpenMode )
-    {
-        int32_t iFildes = -1; /* Init'd to quiet warnings. */
-        REDSTATUS ret;
+        int32_t red_getstats( const char * pszVolume,
+                              REDVOLSTATS * pStats,
+                              bool fReset )
+        {
+            REDSTATUS ret;
 
-        #if REDCONF_READ_ONLY == 1
-            if( ulOpenMode != RED_O_RDONLY )
-            {
-                ret = -RED_EROFS;
-            }
-        #else
-            if( ( ulOpenMode != ( ulOpenMode & RED_O_MASK ) ) ||
-                ( ( ulOpenMode & ( RED_O_RDONLY | RED_O_WRONLY | RED_O_RDWR ) ) == 0U ) ||
-                ( ( ( ulOpenMode & RED_O_RDONLY ) != 0U ) && ( ( ulOpenMode & ( RED_O_WRONLY | RED_O_RDWR ) ) != 0U ) ) ||
-                ( ( ( ulOpenMode & RED_O_WRONLY ) != 0U ) && ( ( ulOpenMode & ( RED_O_RDONLY | RED_O_RDWR ) ) != 0U ) ) ||
-                ( ( ( ulOpenMode & RED_O_RDWR ) != 0U ) && ( ( ulOpenMode & ( RED_O_RDONLY | RED_O_WRONLY ) ) != 0U ) ) ||
-                ( ( ( ulOpenMode & ( RED_O_TRUNC | RED_O_CREAT | RED_O_EXCL ) ) != 0U ) && ( ( ulOpenMode & RED_O_RDONLY ) != 0U ) ) ||
-                ( ( ( ulOpenMode & RED_O_EXCL ) != 0U ) && ( ( ulOpenMode & RED_O_CREAT ) == 0U ) ) )
+            ret = PosixEnter();
+
+            if( ret == 0 )
             {
-                ret = -RED_EINVAL;
-            }
+                uint8_t bVolNum;
 
-            #if REDCONF_API_POSIX_FTRUNCATE == 0
-                else if( ( ulOpenMode & RED_O_TRUNC ) != 0U )
+                ret = RedPathSplit( pszVolume, &bVolNum, NULL );
+
+                #if REDCONF_VOLUME_COUNT > 1U
+                    if( ret == 0 )
+                    {
+                        ret = PosixVolSetCurrent( bVolNum );
+                    }
+                #endif
+
+                if( ret == 0 )
                 {
-                    ret = -RED_EINVAL;
+                    ret = RedCoreVolStats( pStats, fReset );
                 }
-            #endif
-        #endif /* if REDCONF_READ_ONLY == 1 */
-        else
-        {
-            ret = PosixEnter();
-        }
-
-        if( ret == 0 )
-        {
-            ret = FildesOpen( pszPath, ulOpenMode, FTYPE_EITHER, &iFildes );
 
-            PosixLeave();
-        }
+                PosixLeave();
+            }
 
-        if( ret != 0 )
-        {
-            iFildes = PosixReturn( ret );
+            return PosixReturn( ret );
         }
-
-        return iFildes;
-    }
+    #endif /* REDCONF_STATS == 1 */
 
 
-    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_UNLINK == 1 )
+    #if REDCONF_PATH_CACHE_ENTRIES > 0U
 
-/** @brief Delete a file or directory.
- *
- *  The given name is deleted and the link count of the corresponding inode is
- *  decremented.  If the link count falls to zero (no remaining hard links),
- *  the inode will be deleted.
- *
- *  Unlike POSIX unlink, deleting a file or directory with open handles (file
- *  descriptors or directory streams) will fail with an #RED_EBUSY error.  This
- *  only applies when deleting an inode with a link count of one; if a file has
- *  multiple names (hard links), all but the last name may be deleted even if
- *  the file is open.
- *
- *  If the path names a directory which is not empty, the unlink will fail.
- *
- *  If the deletion frees data in the committed state, it will not return to
- *  free space until after a transaction point.
+/** @brief Query path component cache statistics.
  *
- *  Unlike POSIX unlink, this function can fail when the disk is full.  To fix
- *  this, transact and try again: Reliance Edge guarantees that it is possible
- *  to delete at least one file or directory after a transaction point.  If disk
- *  full automatic transactions are enabled, this will happen automatically.
+ *  The path component cache is shared by all volumes.  Its hit rate shows
+ *  whether #REDCONF_PATH_CACHE_ENTRIES is large enough for the application's
+ *  working set of directories.
  *
- *  @param pszPath  The path of the file or directory to delete.
+ *  @param pStats   The buffer to populate with the statistics.
+ *  @param fReset   Whether to zero the statistics after reading them.
  *
  *  @return On success, zero is returned.  On error, -1 is returned and
  #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
- *  - #RED_EBUSY: @p pszPath points to an inode with open handles and a link
- *    count of one.
- *  - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
- *    not mounted.
- *  - #RED_EIO: A disk I/O error occurred.
- *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
- #REDCONF_NAME_MAX.
- *  - #RED_ENOENT: The path does not name an existing file; or the @p pszPath
- *    argument, after removing the volume prefix, points to an empty string.
- *  - #RED_ENOTDIR: A component of the path prefix is not a directory.
- *  - #RED_ENOTEMPTY: The path names a directory which is not empty.
- *  - #RED_ENOSPC: The file system does not have enough space to modify the
- *    parent directory to perform the deletion.
+ *  - #RED_EINVAL: @p pStats is `NULL`; or the driver is uninitialized.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
  */
-        int32_t red_unlink( const char * pszPath )
+        int32_t red_pathcachestats( REDPATHCACHESTATS * pStats,
+                                    bool fReset )
         {
             REDSTATUS ret;
 
@@ -928,76 +1063,68 @@
 
             if( ret == 0 )
             {
-                ret = UnlinkSub( pszPath, FTYPE_EITHER );
-
-                PosixLeave();
-            }
+                if( pStats == NULL )
+                {
+                    ret = -RED_EINVAL;
+                }
+                else
+                {
+                    RedPathCacheStats( pStats, fReset );
+                }
+
+                PosixLeave();
+            }
 
             return PosixReturn( ret );
         }
-    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_UNLINK == 1 ) */
+    #endif /* REDCONF_PATH_CACHE_ENTRIES > 0U */
 
 
-    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_MKDIR == 1 )
+    #if REDCONF_WRITE_BEHIND_BYTES > 0U
 
-/** @brief Create a new directory.
+/** @brief Query write-behind queue statistics.
  *
- *  Unlike POSIX mkdir, this function has no second argument for the
- *  permissions (which Reliance Edge does not use).
+ *  The statistics show whether #REDCONF_WRITE_BEHIND_BYTES and
+ *  #REDCONF_WRITE_BEHIND_ENTRIES are large enough for the application's
+ *  bursts of writes: each stall is a red_write() which had to wait for the
+ *  queued writes to be finished.  Querying the statistics does not finish the
+ *  queued writes.
  *
- *  @param pszPath  The name and location of the directory to create.
+ *  @param pStats   The buffer to populate with the statistics.
+ *  @param fReset   Whether to zero the statistics after reading them.  The
+ *                  depth of the queue is not reset, and the maximums restart
+ *                  from the current depth and byte count.
  *
  *  @return On success, zero is returned.  On error, -1 is returned and
  #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
- *  - #RED_EEXIST: @p pszPath points to an existing file or directory.
- *  - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
- *    not mounted.
- *  - #RED_EIO: A disk I/O error occurred.
- *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
- #REDCONF_NAME_MAX.
- *  - #RED_ENOENT: A component of the path prefix does not name an existing
- *    directory; or the @p pszPath argument, after removing the volume prefix,
- *    points to an empty string.
- *  - #RED_ENOSPC: The file system does not have enough space for the new
- *    directory or to extend the parent directory of the new directory.
- *  - #RED_ENOTDIR: A component of the path prefix is not a directory.
- *  - #RED_EROFS: The parent directory resides on a read-only file system.
+ *  - #RED_EINVAL: @p pStats is `NULL`; or the driver is uninitialized.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
  */
-        int32_t red_mkdir( const char * pszPath )
+        int32_t red_writebehindstats( REDWBSTATS * pStats,
+                                      bool fReset )
         {
             REDSTATUS ret;
 
-            ret = PosixEnter();
+            ret = PosixEnterNoFence();
 
             if( ret == 0 )
             {
-                const char * pszLocalPath;
-                uint8_t bVolNum;
-
-                ret = RedPathSplit( pszPath, &bVolNum, &pszLocalPath );
-
-                #if REDCONF_VOLUME_COUNT > 1U
-                    if( ret == 0 )
-                    {
-                        ret = RedCoreVolSetCurrent( bVolNum );
-                    }
-                #endif
-
-                if( ret == 0 )
+                if( pStats == NULL )
                 {
-                    const char * pszName;
-                    uint32_t ulPInode;
-
-                    ret = RedPathToName( pszLocalPath, &ulPInode, &pszName );
+                    ret = -RED_EINVAL;
+                }
+                else
+                {
+                    gWbStats.ulDepth = gulWbCount;
+                    *pStats = gWbStats;
 
-                    if( ret == 0 )
+                    if( fReset )
                     {
-                        uint32_t ulInode;
-
-                        ret = RedCoreCreate( ulPInode, pszName, true, &ulInode );
+                        RedMemSet( &gWbStats, 0U, sizeof( gWbStats ) );
+                        gWbStats.ulMaxDepth = gulWbCount;
+                        gWbStats.ulMaxBytes = gulWbBytes;
                     }
                 }
 
@@ -1006,238 +1133,670 @@
 
             return PosixReturn( ret );
         }
-    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_MKDIR == 1 ) */
+    #endif /* REDCONF_WRITE_BEHIND_BYTES > 0U */
 
 
-    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RMDIR == 1 )
+    #if ( REDCONF_STATS == 1 ) && ( REDCONF_TASK_COUNT > 1U )
 
-/** @brief Delete a directory.
- *
- *  The given directory name is deleted and the corresponding directory inode
- *  will be deleted.
- *
- *  Unlike POSIX rmdir, deleting a directory with open handles (file
- *  descriptors or directory streams) will fail with an #RED_EBUSY error.
- *
- *  If the path names a directory which is not empty, the deletion will fail.
- *  If the path names the root directory of a file system volume, the deletion
- *  will fail.
- *
- *  If the path names a regular file, the deletion will fail.  This provides
- *  type checking and may be useful in cases where an application knows the
- *  path to be deleted should name a directory.
- *
- *  If the deletion frees data in the committed state, it will not return to
- *  free space until after a transaction point.
+/** @brief Query lock contention statistics.
  *
- *  Unlike POSIX rmdir, this function can fail when the disk is full.  To fix
- *  this, transact and try again: Reliance Edge guarantees that it is possible
- *  to delete at least one file or directory after a transaction point.  If disk
- *  full automatic transactions are enabled, this will happen automatically.
+ *  The statistics show how long tasks wait for each other to enter the file
+ *  system driver and, with #REDCONF_LOCK_PER_VOLUME, to lock their volume.
+ *  The call which queries the statistics is counted in them.
  *
- *  @param pszPath  The path of the directory to delete.
+ *  @param pStats   The buffer to populate with the statistics.
+ *  @param fReset   Whether to zero the statistics after reading them.
  *
  *  @return On success, zero is returned.  On error, -1 is returned and
  #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
- *  - #RED_EBUSY: @p pszPath points to a directory with open handles.
- *  - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
- *    not mounted.
- *  - #RED_EIO: A disk I/O error occurred.
- *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
- #REDCONF_NAME_MAX.
- *  - #RED_ENOENT: The path does not name an existing directory; or the
- *    @p pszPath argument, after removing the volume prefix, points to an empty
- *    string.
- *  - #RED_ENOTDIR: A component of the path is not a directory.
- *  - #RED_ENOTEMPTY: The path names a directory which is not empty.
- *  - #RED_ENOSPC: The file system does not have enough space to modify the
- *    parent directory to perform the deletion.
- *  - #RED_EROFS: The directory to be removed resides on a read-only file
- *    system.
+ *  - #RED_EINVAL: @p pStats is `NULL`; or the driver is uninitialized.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
  */
-        int32_t red_rmdir( const char * pszPath )
+        int32_t red_lockstats( REDLOCKSTATS * pStats,
+                               bool fReset )
         {
             REDSTATUS ret;
 
-            ret = PosixEnter();
+            ret = PosixEnterNoFence();
 
             if( ret == 0 )
             {
-                ret = UnlinkSub( pszPath, FTYPE_DIR );
+                if( pStats == NULL )
+                {
+                    ret = -RED_EINVAL;
+                }
+                else
+                {
+                    *pStats = gLockStats;
+
+                    if( fReset )
+                    {
+                        RedMemSet( &gLockStats, 0U, sizeof( gLockStats ) );
+                    }
+                }
 
                 PosixLeave();
             }
 
             return PosixReturn( ret );
         }
-    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RMDIR == 1 ) */
+    #endif /* ( REDCONF_STATS == 1 ) && ( REDCONF_TASK_COUNT > 1U ) */
 
 
-    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RENAME == 1 )
+    #if REDCONF_LATENCY_STATS == 1
 
-/** @brief Rename a file or directory.
- *
- *  Both paths must reside on the same file system volume.  Attempting to use
- *  this API to move a file to a different volume will result in an error.
- *
- *  If @p pszNewPath names an existing file or directory, the behavior depends
- *  on the configuration.  If #REDCONF_RENAME_ATOMIC is false, and if the
- *  destination name exists, this function always fails and sets #red_errno to
- #RED_EEXIST.  This behavior is contrary to POSIX.
- *
- *  If #REDCONF_RENAME_ATOMIC is true, and if the new name exists, then in one
- *  atomic operation, @p pszNewPath is unlinked and @p pszOldPath is renamed to
- *  @p pszNewPath.  Both @p pszNewPath and @p pszOldPath must be of the same
- *  type (both files or both directories).  As with red_unlink(), if
- *  @p pszNewPath is a directory, it must be empty.  The major exception to this
- *  behavior is that if both @p pszOldPath and @p pszNewPath are links to the
- *  same inode, then the rename does nothing and both names continue to exist.
- *  Unlike POSIX rename, if @p pszNewPath points to an inode with a link count
- *  of one and open handles (file descriptors or directory streams), the
- *  rename will fail with #RED_EBUSY.
+/** @brief Query the latency histograms of the timed calls.
  *
- *  If the rename deletes the old destination, it may free data in the
- *  committed state, which will not return to free space until after a
- *  transaction point.  Similarly, if the deleted inode was part of the
- *  committed state, the inode slot will not be available until after a
- *  transaction point.
+ *  The histograms are indexed by the RED_LATOP_* values and are shared by all
+ *  volumes.  Use red_latencypercentile() to estimate percentiles from them.
  *
- *  @param pszOldPath   The path of the file or directory to rename.
- *  @param pszNewPath   The new name and location after the rename.
+ *  @param pStats   The buffer to populate with the histograms.
+ *  @param fReset   Whether to zero the histograms after reading them.
  *
  *  @return On success, zero is returned.  On error, -1 is returned and
  #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
- *  - #RED_EBUSY: #REDCONF_RENAME_ATOMIC is true and @p pszNewPath points to an
- *    inode with open handles and a link count of one.
- *  - #RED_EEXIST: #REDCONF_RENAME_ATOMIC is false and @p pszNewPath exists.
- *  - #RED_EINVAL: @p pszOldPath is `NULL`; or @p pszNewPath is `NULL`; or the
- *    volume containing the path is not mounted.
- *  - #RED_EIO: A disk I/O error occurred.
- *  - #RED_EISDIR: The @p pszNewPath argument names a directory and the
- *    @p pszOldPath argument names a non-directory.
- *  - #RED_ENAMETOOLONG: The length of a component of either @p pszOldPath or
- *    @p pszNewPath is longer than #REDCONF_NAME_MAX.
- *  - #RED_ENOENT: The link named by @p pszOldPath does not name an existing
- *    entry; or either @p pszOldPath or @p pszNewPath, after removing the volume
- *    prefix, point to an empty string.
- *  - #RED_ENOTDIR: A component of either path prefix is not a directory; or
- *    @p pszOldPath names a directory and @p pszNewPath names a file.
- *  - #RED_ENOTEMPTY: The path named by @p pszNewPath is a directory which is
- *    not empty.
- *  - #RED_ENOSPC: The file system does not have enough space to extend the
- *    directory that would contain @p pszNewPath.
- *  - #RED_EROFS: The directory to be removed resides on a read-only file
- *    system.
+ *  - #RED_EINVAL: @p pStats is `NULL`; or the driver is uninitialized.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
- *  - #RED_EXDEV: @p pszOldPath and @p pszNewPath are on different file system
- *    volumes.
  */
-        int32_t red_rename( const char * pszOldPath,
-                            const char * pszNewPath )
+        int32_t red_latencystats( REDLATSTATS * pStats,
+                                  bool fReset )
         {
             REDSTATUS ret;
 
-            ret = PosixEnter();
+            ret = PosixEnterNoFence();
 
             if( ret == 0 )
             {
-                const char * pszOldLocalPath;
-                uint8_t bOldVolNum;
-
-                ret = RedPathSplit( pszOldPath, &bOldVolNum, &pszOldLocalPath );
-
-                if( ret == 0 )
+                if( pStats == NULL )
                 {
-                    const char * pszNewLocalPath;
-                    uint8_t bNewVolNum;
-
-                    ret = RedPathSplit( pszNewPath, &bNewVolNum, &pszNewLocalPath );
+                    ret = -RED_EINVAL;
+                }
+                else
+                {
+                    *pStats = gLatStats;
 
-                    if( ( ret == 0 ) && ( bOldVolNum != bNewVolNum ) )
+                    if( fReset )
                     {
-                        ret = -RED_EXDEV;
+                        RedMemSet( &gLatStats, 0U, sizeof( gLatStats ) );
                     }
+                }
 
-                    #if REDCONF_VOLUME_COUNT > 1U
-                        if( ret == 0 )
-                        {
-                            ret = RedCoreVolSetCurrent( bOldVolNum );
-                        }
-                    #endif
+                PosixLeave();
+            }
 
-                    if( ret == 0 )
-                    {
-                        const char * pszOldName;
-                        uint32_t ulOldPInode;
+            return PosixReturn( ret );
+        }
 
-                        ret = RedPathToName( pszOldLocalPath, &ulOldPInode, &pszOldName );
 
-                        if( ret == 0 )
-                        {
-                            const char * pszNewName;
-                            uint32_t ulNewPInode;
+/** @brief Estimate a percentile of the latencies in a histogram.
+ *
+ *  The bucket which holds the percentile is found from the bucket counts, and
+ *  the latency is interpolated linearly within the bucket, so the estimate is
+ *  within a factor of two of the true value.  It is never more than the
+ *  longest latency counted.
+ *
+ *  @param pHist        The histogram, as returned by red_latencystats().
+ *  @param ulPermille   The percentile, in tenths of a percent: for example,
+ *                      500 for the median, 990 for the 99th percentile, and
+ *                      999 for the 99.9th.  Values above 1000 are taken to mean
+ *                      1000, the longest latency.
+ *
+ *  @return The estimated latency in microseconds, or zero if @p pHist is
+ *          `NULL` or counts no calls.
+ */
+        uint32_t red_latencypercentile( const REDLATHIST * pHist,
+                                        uint32_t ulPermille )
+        {
+            uint32_t ulMicrosec = 0U;
 
-                            ret = RedPathToName( pszNewLocalPath, &ulNewPInode, &pszNewName );
+            if( ( pHist != NULL ) && ( pHist->ulCalls > 0U ) )
+            {
+                uint64_t ullRank = ( ( ( uint64_t ) pHist->ulCalls * REDMIN( ulPermille, 1000U ) ) + 999U ) / 1000U;
+                uint64_t ullBefore = 0U;
+                uint32_t ulBucket;
 
-                            #if REDCONF_RENAME_ATOMIC == 1
-                                if( ret == 0 )
-                                {
-                                    uint32_t ulDestInode;
+                if( ullRank == 0U )
+                {
+                    ullRank = 1U;
+                }
 
-                                    ret = RedCoreLookup( ulNewPInode, pszNewName, &ulDestInode );
+                for( ulBucket = 0U; ulBucket < RED_LAT_BUCKETS; ulBucket++ )
+                {
+                    uint32_t ulCount = pHist->aulBuckets[ ulBucket ];
 
-                                    if( ret == 0 )
-                                    {
-                                        ret = InodeUnlinkCheck( ulDestInode );
-                                    }
-                                    else if( ret == -RED_ENOENT )
-                                    {
-                                        ret = 0;
-                                    }
-                                    else
-                                    {
-                                        /*  Unexpected error, nothing to do.
-                                         */
-                                    }
-                                }
-                            #endif /* if REDCONF_RENAME_ATOMIC == 1 */
+                    if( ( ullBefore + ulCount ) >= ullRank )
+                    {
+                        uint64_t ullLow = ( ulBucket == 0U ) ? 0U : ( ( uint64_t ) 1U << ( ulBucket - 1U ) );
+                        uint64_t ullHigh = ( ( uint64_t ) 1U << ulBucket ) - 1U;
+                        uint64_t ullEstimate;
 
-                            if( ret == 0 )
-                            {
-                                ret = RedCoreRename( ulOldPInode, pszOldName, ulNewPInode, pszNewName );
-                            }
+                        if( ( ulBucket == ( RED_LAT_BUCKETS - 1U ) ) || ( ullHigh > pHist->ulMaxMicrosec ) )
+                        {
+                            ullHigh = pHist->ulMaxMicrosec;
                         }
+
+                        ullEstimate = ullLow + ( ( ( ullHigh - ullLow ) * ( ullRank - ullBefore ) ) / ulCount );
+                        ulMicrosec = ( uint32_t ) REDMIN( ullEstimate, pHist->ulMaxMicrosec );
+                        break;
                     }
-                }
 
-                PosixLeave();
+                    ullBefore += ulCount;
+                }
             }
 
-            return PosixReturn( ret );
+            return ulMicrosec;
         }
-    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RENAME == 1 ) */
+    #endif /* REDCONF_LATENCY_STATS == 1 */
 
 
-    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_LINK == 1 )
-
-/** @brief Create a hard link.
+/** @brief Open a file or directory.
  *
- *  This creates an additional name (link) for the file named by @p pszPath.
- *  The new name refers to the same file with the same contents.  If a name is
- *  deleted, but the underlying file has other names, the file continues to
- *  exist.  The link count (accessible via red_fstat()) indicates the number of
- *  names that a file has.  All of a file's names are on equal footing: there
- *  is nothing special about the original name.
+ *  Exactly one file access mode must be specified:
  *
- *  If @p pszPath names a directory, the operation will fail.
+ *  - #RED_O_RDONLY: Open for reading only.
+ *  - #RED_O_WRONLY: Open for writing only.
+ *  - #RED_O_RDWR: Open for reading and writing.
  *
- *  @param pszPath      The path indicating the inode for the new link.
- *  @param pszHardLink  The name and location for the new link.
+ *  Directories can only be opened with `RED_O_RDONLY`.
+ *
+ *  The following flags may also be used:
+ *
+ *  - #RED_O_APPEND: Set the file offset to the end-of-file prior to each
+ *    write.
+ *  - #RED_O_CREAT: Create the named file if it does not exist.
+ *  - #RED_O_EXCL: In combination with `RED_O_CREAT`, return an error if the
+ *    path already exists.
+ *  - #RED_O_TRUNC: Truncate the opened file to size zero.  Only supported when
+ #REDCONF_API_POSIX_FTRUNCATE is true.
+ *
+ #RED_O_CREAT, #RED_O_EXCL, and #RED_O_TRUNC are invalid with #RED_O_RDONLY.
+ #RED_O_EXCL is invalid without #RED_O_CREAT.
+ *
+ *  If the volume is read-only, #RED_O_RDONLY is the only valid open flag; use
+ *  of any other flag will result in an error.
+ *
+ *  If #RED_O_TRUNC frees data which is in the committed state, it will not
+ *  return to free space until after a transaction point.
+ *
+ *  The returned file descriptor must later be closed with red_close().
+ *
+ *  Unlike POSIX open, there is no optional third argument for the permissions
+ *  (which Reliance Edge does not use) and other open flags (like `O_SYNC`) are
+ *  not supported.
+ *
+ *  @param pszPath      The path to the file or directory.
+ *  @param ulOpenMode   The open flags (mask of `RED_O_` values).
+ *
+ *  @return On success, a nonnegative file descriptor is returned.  On error,
+ *          -1 is returned and #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBUSY: Using #RED_O_TRUNC, and data of the file is lent out by
+ *    red_readbuf().
+ *  - #RED_EEXIST: Using #RED_O_CREAT and #RED_O_EXCL, and the indicated path
+ *    already exists.
+ *  - #RED_EINVAL: @p ulOpenMode is invalid; or @p pszPath is `NULL`; or the
+ *    volume containing the path is not mounted.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_EISDIR: The path names a directory and @p ulOpenMode includes
+ #RED_O_WRONLY or #RED_O_RDWR.
+ *  - #RED_EMFILE: There are no available file descriptors.
+ *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+ #REDCONF_NAME_MAX.
+ *  - #RED_ENFILE: Attempting to create a file but the file system has used all
+ *    available inode slots.
+ *  - #RED_ENOENT: #RED_O_CREAT is not set and the named file does not exist; or
+ #RED_O_CREAT is set and the parent directory does not exist; or the
+ *    volume does not exist; or the @p pszPath argument, after removing the
+ *    volume prefix, points to an empty string.
+ *  - #RED_ENOSPC: The file does not exist and #RED_O_CREAT was specified, but
+ *    there is insufficient free space to expand the directory or to create the
+ *    new file.
+ *  - #RED_ENOTDIR: A component of the prefix in @p pszPath does not name a
+ *    directory.
+ *  - #RED_EROFS: The path resides on a read-only file system and a write
+ *    operation was requested.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+    int32_t red_open( const char * pszPath,
+                      uint32_t ulOpenMode )
+    {
+        int32_t iFildes = -1; /* Init'd to quiet warnings. */
+        REDSTATUS ret;
+
+        #if REDCONF_LATENCY_STATS == 1
+            REDTIMESTAMP tsStart = RedOsTimestamp();
+        #endif
+
+        #if REDCONF_READ_ONLY == 1
+            if( ulOpenMode != RED_O_RDONLY )
+            {
+                ret = -RED_EROFS;
+            }
+        #else
+            if( ( ulOpenMode != ( ulOpenMode & RED_O_MASK ) ) ||
+                ( ( ulOpenMode & ( RED_O_RDONLY | RED_O_WRONLY | RED_O_RDWR ) ) == 0U ) ||
+                ( ( ( ulOpenMode & RED_O_RDONLY ) != 0U ) && ( ( ulOpenMode & ( RED_O_WRONLY | RED_O_RDWR ) ) != 0U ) ) ||
+                ( ( ( ulOpenMode & RED_O_WRONLY ) != 0U ) && ( ( ulOpenMode & ( RED_O_RDONLY | RED_O_RDWR ) ) != 0U ) ) ||
+                ( ( ( ulOpenMode & RED_O_RDWR ) != 0U ) && ( ( ulOpenMode & ( RED_O_RDONLY | RED_O_WRONLY ) ) != 0U ) ) ||
+                ( ( ( ulOpenMode & ( RED_O_TRUNC | RED_O_CREAT | RED_O_EXCL ) ) != 0U ) && ( ( ulOpenMode & RED_O_RDONLY ) != 0U ) ) ||
+                ( ( ( ulOpenMode & RED_O_EXCL ) != 0U ) && ( ( ulOpenMode & RED_O_CREAT ) == 0U ) ) )
+            {
+                ret = -RED_EINVAL;
+            }
+
+            #if REDCONF_API_POSIX_FTRUNCATE == 0
+                else if( ( ulOpenMode & RED_O_TRUNC ) != 0U )
+                {
+                    ret = -RED_EINVAL;
+                }
+            #endif
+        #endif /* if REDCONF_READ_ONLY == 1 */
+        else
+        {
+            ret = PosixEnter();
+        }
+
+        if( ret == 0 )
+        {
+            ret = FildesOpen( pszPath, ulOpenMode, FTYPE_EITHER, &iFildes );
+
+            #if REDCONF_LATENCY_STATS == 1
+                LatencyRecord( RED_LATOP_OPEN, tsStart );
+            #endif
+
+            PosixLeave();
+        }
+
+        if( ret != 0 )
+        {
+            iFildes = PosixReturn( ret );
+        }
+
+        return iFildes;
+    }
+
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_UNLINK == 1 )
+
+/** @brief Delete a file or directory.
+ *
+ *  The given name is deleted and the link count of the corresponding inode is
+ *  decremented.  If the link count falls to zero (no remaining hard links),
+ *  the inode will be deleted.
+ *
+ *  Unlike POSIX unlink, deleting a file or directory with open handles (file
+ *  descriptors or directory streams) will fail with an #RED_EBUSY error.  This
+ *  only applies when deleting an inode with a link count of one; if a file has
+ *  multiple names (hard links), all but the last name may be deleted even if
+ *  the file is open.
+ *
+ *  If the path names a directory which is not empty, the unlink will fail.
+ *
+ *  If the deletion frees data in the committed state, it will not return to
+ *  free space until after a transaction point.
+ *
+ *  Unlike POSIX unlink, this function can fail when the disk is full.  To fix
+ *  this, transact and try again: Reliance Edge guarantees that it is possible
+ *  to delete at least one file or directory after a transaction point.  If disk
+ *  full automatic transactions are enabled, this will happen automatically.
+ *
+ *  @param pszPath  The path of the file or directory to delete.
+ *
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBUSY: @p pszPath points to an inode with open handles and a link
+ *    count of one.
+ *  - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
+ *    not mounted.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+ #REDCONF_NAME_MAX.
+ *  - #RED_ENOENT: The path does not name an existing file; or the @p pszPath
+ *    argument, after removing the volume prefix, points to an empty string.
+ *  - #RED_ENOTDIR: A component of the path prefix is not a directory.
+ *  - #RED_ENOTEMPTY: The path names a directory which is not empty.
+ *  - #RED_ENOSPC: The file system does not have enough space to modify the
+ *    parent directory to perform the deletion.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+        int32_t red_unlink( const char * pszPath )
+        {
+            REDSTATUS ret;
+
+            #if REDCONF_LATENCY_STATS == 1
+                REDTIMESTAMP tsStart = RedOsTimestamp();
+            #endif
+
+            ret = PosixEnter();
+
+            if( ret == 0 )
+            {
+                ret = UnlinkSub( pszPath, FTYPE_EITHER );
+
+                #if REDCONF_LATENCY_STATS == 1
+                    LatencyRecord( RED_LATOP_UNLINK, tsStart );
+                #endif
+
+                PosixLeave();
+            }
+
+            return PosixReturn( ret );
+        }
+    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_UNLINK == 1 ) */
+
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_MKDIR == 1 )
+
+/** @brief Create a new directory.
+ *
+ *  Unlike POSIX mkdir, this function has no second argument for the
+ *  permissions (which Reliance Edge does not use).
+ *
+ *  @param pszPath  The name and location of the directory to create.
+ *
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EEXIST: @p pszPath points to an existing file or directory.
+ *  - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
+ *    not mounted.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+ #REDCONF_NAME_MAX.
+ *  - #RED_ENOENT: A component of the path prefix does not name an existing
+ *    directory; or the @p pszPath argument, after removing the volume prefix,
+ *    points to an empty string.
+ *  - #RED_ENOSPC: The file system does not have enough space for the new
+ *    directory or to extend the parent directory of the new directory.
+ *  - #RED_ENOTDIR: A component of the path prefix is not a directory.
+ *  - #RED_EROFS: The parent directory resides on a read-only file system.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+        int32_t red_mkdir( const char * pszPath )
+        {
+            REDSTATUS ret;
+
+            ret = PosixEnter();
+
+            if( ret == 0 )
+            {
+                const char * pszLocalPath;
+                uint8_t bVolNum;
+
+                ret = RedPathSplit( pszPath, &bVolNum, &pszLocalPath );
+
+                #if REDCONF_VOLUME_COUNT > 1U
+                    if( ret == 0 )
+                    {
+                        ret = PosixVolSetCurrent( bVolNum );
+                    }
+                #endif
+
+                if( ret == 0 )
+                {
+                    const char * pszName;
+                    uint32_t ulPInode;
+
+                    ret = RedPathToName( pszLocalPath, &ulPInode, &pszName );
+
+                    if( ret == 0 )
+                    {
+                        uint32_t ulInode;
+
+                        ret = RedCoreCreate( ulPInode, pszName, true, &ulInode );
+                    }
+                }
+
+                PosixLeave();
+            }
+
+            return PosixReturn( ret );
+        }
+    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_MKDIR == 1 ) */
+
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RMDIR == 1 )
+
+/** @brief Delete a directory.
+ *
+ *  The given directory name is deleted and the corresponding directory inode
+ *  will be deleted.
+ *
+ *  Unlike POSIX rmdir, deleting a directory with open handles (file
+ *  descriptors or directory streams) will fail with an #RED_EBUSY error.
+ *
+ *  If the path names a directory which is not empty, the deletion will fail.
+ *  If the path names the root directory of a file system volume, the deletion
+ *  will fail.
+ *
+ *  If the path names a regular file, the deletion will fail.  This provides
+ *  type checking and may be useful in cases where an application knows the
+ *  path to be deleted should name a directory.
+ *
+ *  If the deletion frees data in the committed state, it will not return to
+ *  free space until after a transaction point.
+ *
+ *  Unlike POSIX rmdir, this function can fail when the disk is full.  To fix
+ *  this, transact and try again: Reliance Edge guarantees that it is possible
+ *  to delete at least one file or directory after a transaction point.  If disk
+ *  full automatic transactions are enabled, this will happen automatically.
+ *
+ *  @param pszPath  The path of the directory to delete.
+ *
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBUSY: @p pszPath points to a directory with open handles.
+ *  - #RED_EINVAL: @p pszPath is `NULL`; or the volume containing the path is
+ *    not mounted.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_ENAMETOOLONG: The length of a component of @p pszPath is longer than
+ #REDCONF_NAME_MAX.
+ *  - #RED_ENOENT: The path does not name an existing directory; or the
+ *    @p pszPath argument, after removing the volume prefix, points to an empty
+ *    string.
+ *  - #RED_ENOTDIR: A component of the path is not a directory.
+ *  - #RED_ENOTEMPTY: The path names a directory which is not empty.
+ *  - #RED_ENOSPC: The file system does not have enough space to modify the
+ *    parent directory to perform the deletion.
+ *  - #RED_EROFS: The directory to be removed resides on a read-only file
+ *    system.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+        int32_t red_rmdir( const char * pszPath )
+        {
+            REDSTATUS ret;
+
+            ret = PosixEnter();
+
+            if( ret == 0 )
+            {
+                ret = UnlinkSub( pszPath, FTYPE_DIR );
+
+                PosixLeave();
+            }
+
+            return PosixReturn( ret );
+        }
+    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RMDIR == 1 ) */
+
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RENAME == 1 )
+
+/** @brief Rename a file or directory.
+ *
+ *  Both paths must reside on the same file system volume.  Attempting to use
+ *  this API to move a file to a different volume will result in an error.
+ *
+ *  If @p pszNewPath names an existing file or directory, the behavior depends
+ *  on the configuration.  If #REDCONF_RENAME_ATOMIC is false, and if the
+ *  destination name exists, this function always fails and sets #red_errno to
+ #RED_EEXIST.  This behavior is contrary to POSIX.
+ *
+ *  If #REDCONF_RENAME_ATOMIC is true, and if the new name exists, then in one
+ *  atomic operation, @p pszNewPath is unlinked and @p pszOldPath is renamed to
+ *  @p pszNewPath.  Both @p pszNewPath and @p pszOldPath must be of the same
+ *  type (both files or both directories).  As with red_unlink(), if
+ *  @p pszNewPath is a directory, it must be empty.  The major exception to this
+ *  behavior is that if both @p pszOldPath and @p pszNewPath are links to the
+ *  same inode, then the rename does nothing and both names continue to exist.
+ *  Unlike POSIX rename, if @p pszNewPath points to an inode with a link count
+ *  of one and open handles (file descriptors or directory streams), the
+ *  rename will fail with #RED_EBUSY.
+ *
+ *  If the rename deletes the old destination, it may free data in the
+ *  committed state, which will not return to free space until after a
+ *  transaction point.  Similarly, if the deleted inode was part of the
+ *  committed state, the inode slot will not be available until after a
+ *  transaction point.
+ *
+ *  @param pszOldPath   The path of the file or directory to rename.
+ *  @param pszNewPath   The new name and location after the rename.
+ *
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBUSY: #REDCONF_RENAME_ATOMIC is true and @p pszNewPath points to an
+ *    inode with open handles and a link count of one.
+ *  - #RED_EEXIST: #REDCONF_RENAME_ATOMIC is false and @p pszNewPath exists.
+ *  - #RED_EINVAL: @p pszOldPath is `NULL`; or @p pszNewPath is `NULL`; or the
+ *    volume containing the path is not mounted.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_EISDIR: The @p pszNewPath argument names a directory and the
+ *    @p pszOldPath argument names a non-directory.
+ *  - #RED_ENAMETOOLONG: The length of a component of either @p pszOldPath or
+ *    @p pszNewPath is longer than #REDCONF_NAME_MAX.
+ *  - #RED_ENOENT: The link named by @p pszOldPath does not name an existing
+ *    entry; or either @p pszOldPath or @p pszNewPath, after removing the volume
+ *    prefix, point to an empty string.
+ *  - #RED_ENOTDIR: A component of either path prefix is not a directory; or
+ *    @p pszOldPath names a directory and @p pszNewPath names a file.
+ *  - #RED_ENOTEMPTY: The path named by @p pszNewPath is a directory which is
+ *    not empty.
+ *  - #RED_ENOSPC: The file system does not have enough space to extend the
+ *    directory that would contain @p pszNewPath.
+ *  - #RED_EROFS: The directory to be removed resides on a read-only file
+ *    system.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ *  - #RED_EXDEV: @p pszOldPath and @p pszNewPath are on different file system
+ *    volumes.
+ */
+        int32_t red_rename( const char * pszOldPath,
+                            const char * pszNewPath )
+        {
+            REDSTATUS ret;
+
+            ret = PosixEnter();
+
+            if( ret == 0 )
+            {
+                const char * pszOldLocalPath;
+                uint8_t bOldVolNum;
+
+                ret = RedPathSplit( pszOldPath, &bOldVolNum, &pszOldLocalPath );
+
+                if( ret == 0 )
+                {
+                    const char * pszNewLocalPath;
+                    uint8_t bNewVolNum;
+
+                    ret = RedPathSplit( pszNewPath, &bNewVolNum, &pszNewLocalPath );
+
+                    if( ( ret == 0 ) && ( bOldVolNum != bNewVolNum ) )
+                    {
+                        ret = -RED_EXDEV;
+                    }
+
+                    #if REDCONF_VOLUME_COUNT > 1U
+                        if( ret == 0 )
+                        {
+                            ret = PosixVolSetCurrent( bOldVolNum );
+                        }
+                    #endif
+
+                    if( ret == 0 )
+                    {
+                        const char * pszOldName;
+                        uint32_t ulOldPInode;
+
+                        ret = RedPathToName( pszOldLocalPath, &ulOldPInode, &pszOldName );
+
+                        if( ret == 0 )
+                        {
+                            const char * pszNewName;
+                            uint32_t ulNewPInode;
+
+                            ret = RedPathToName( pszNewLocalPath, &ulNewPInode, &pszNewName );
+
+                            #if REDCONF_RENAME_ATOMIC == 1
+                                if( ret == 0 )
+                                {
+                                    uint32_t ulDestInode;
+
+                                    ret = RedPathLookupName( ulNewPInode, pszNewName, &ulDestInode );
+
+                                    if( ret == 0 )
+                                    {
+                                        ret = InodeUnlinkCheck( ulDestInode );
+                                    }
+                                    else if( ret == -RED_ENOENT )
+                                    {
+                                        ret = 0;
+                                    }
+                                    else
+                                    {
+                                        /*  Unexpected error, nothing to do.
+                                         */
+                                    }
+                                }
+                            #endif /* if REDCONF_RENAME_ATOMIC == 1 */
+
+                            if( ret == 0 )
+                            {
+                                #if REDCONF_PATH_CACHE_ENTRIES > 0U
+                                    RedPathCacheRemove( ulOldPInode, pszOldName );
+                                    RedPathCacheRemove( ulNewPInode, pszNewName );
+                                #endif
+
+                                ret = RedCoreRename( ulOldPInode, pszOldName, ulNewPInode, pszNewName );
+                            }
+                        }
+                    }
+                }
+
+                PosixLeave();
+            }
+
+            return PosixReturn( ret );
+        }
+    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_RENAME == 1 ) */
+
+
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_LINK == 1 )
+
+/** @brief Create a hard link.
+ *
+ *  This creates an additional name (link) for the file named by @p pszPath.
+ *  The new name refers to the same file with the same contents.  If a name is
+ *  deleted, but the underlying file has other names, the file continues to
+ *  exist.  The link count (accessible via red_fstat()) indicates the number of
+ *  names that a file has.  All of a file's names are on equal footing: there
+ *  is nothing special about the original name.
+ *
+ *  If @p pszPath names a directory, the operation will fail.
+ *
+ *  @param pszPath      The path indicating the inode for the new link.
+ *  @param pszHardLink  The name and location for the new link.
  *
  *  @return On success, zero is returned.  On error, -1 is returned and
  #red_errno is set appropriately.
@@ -1262,59 +1821,332 @@
  *  - #RED_EROFS: The requested link requires writing in a directory on a
  *    read-only file system.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
- *  - #RED_EXDEV: @p pszPath and @p pszHardLink are on different file system
- *    volumes.
+ *  - #RED_EXDEV: @p pszPath and @p pszHardLink are on different file system
+ *    volumes.
+ */
+        int32_t red_link( const char * pszPath,
+                          const char * pszHardLink )
+        {
+            REDSTATUS ret;
+
+            ret = PosixEnter();
+
+            if( ret == 0 )
+            {
+                const char * pszLocalPath;
+                uint8_t bVolNum;
+
+                ret = RedPathSplit( pszPath, &bVolNum, &pszLocalPath );
+
+                if( ret == 0 )
+                {
+                    const char * pszLinkLocalPath;
+                    uint8_t bLinkVolNum;
+
+                    ret = RedPathSplit( pszHardLink, &bLinkVolNum, &pszLinkLocalPath );
+
+                    if( ( ret == 0 ) && ( bVolNum != bLinkVolNum ) )
+                    {
+                        ret = -RED_EXDEV;
+                    }
+
+                    #if REDCONF_VOLUME_COUNT > 1U
+                        if( ret == 0 )
+                        {
+                            ret = PosixVolSetCurrent( bVolNum );
+                        }
+                    #endif
+
+                    if( ret == 0 )
+                    {
+                        uint32_t ulInode;
+
+                        ret = RedPathLookup( pszLocalPath, &ulInode );
+
+                        if( ret == 0 )
+                        {
+                            const char * pszLinkName;
+                            uint32_t ulLinkPInode;
+
+                            ret = RedPathToName( pszLinkLocalPath, &ulLinkPInode, &pszLinkName );
+
+                            if( ret == 0 )
+                            {
+                                ret = RedCoreLink( ulLinkPInode, pszLinkName, ulInode );
+                            }
+                        }
+                    }
+                }
+
+                PosixLeave();
+            }
+
+            return PosixReturn( ret );
+        }
+    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_LINK == 1 ) */
+
+
+/** @brief Close a file descriptor.
+ *
+ *  Any data lent by red_readbuf() through @p iFildes and not yet released is
+ *  released, and must no longer be accessed.
+ *
+ *  @param iFildes  The file descriptor to close.
+ *
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBADF: @p iFildes is not a valid file descriptor.
+ *  - #RED_EFBIG: A queued write through @p iFildes exceeded the maximum file
+ *    size.  The file descriptor is still closed.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_ENOSPC: A queued write through @p iFildes ran out of space.  The
+ *    file descriptor is still closed.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+    int32_t red_close( int32_t iFildes )
+    {
+        REDSTATUS ret;
+
+        ret = PosixEnter();
+
+        if( ret == 0 )
+        {
+            ret = FildesClose( iFildes );
+
+            PosixLeave();
+        }
+
+        return PosixReturn( ret );
+    }
+
+
+/** @brief Read from an open file.
+ *
+ *  The read takes place at the file offset associated with @p iFildes and
+ *  advances the file offset by the number of bytes actually read.
+ *
+ *  Data which has not yet been written, but which is before the end-of-file
+ *  (sparse data), will read as zeroes.  A short read -- where the number of
+ *  bytes read is less than requested -- indicates that the requested read was
+ *  partially or, if zero bytes were read, entirely beyond the end-of-file.
+ *
+ *  @param iFildes  The file descriptor from which to read.
+ *  @param pBuffer  The buffer to populate with data read.  Must be at least
+ *                  @p ulLength bytes in size.
+ *  @param ulLength Number of bytes to attempt to read.
+ *
+ *  @return On success, returns a nonnegative value indicating the number of
+ *          bytes actually read.  On error, -1 is returned and #red_errno is
+ *          set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+ *    for reading.
+ *  - #RED_EINVAL: @p pBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
+ *    cannot be returned properly.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_EISDIR: The @p iFildes is a file descriptor for a directory.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+    int32_t red_read( int32_t iFildes,
+                      void * pBuffer,
+                      uint32_t ulLength )
+    {
+        uint32_t ulLenRead = 0U;
+        REDSTATUS ret;
+        int32_t iReturn;
+
+        #if REDCONF_LATENCY_STATS == 1
+            REDTIMESTAMP tsStart = RedOsTimestamp();
+        #endif
+
+        if( ulLength > ( uint32_t ) INT32_MAX )
+        {
+            ret = -RED_EINVAL;
+        }
+        else
+        {
+            ret = PosixEnterShared();
+        }
+
+        if( ret == 0 )
+        {
+            REDHANDLE * pHandle;
+
+            ret = FildesToHandle( iFildes, FTYPE_FILE, &pHandle );
+
+            if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_READABLE ) == 0U ) )
+            {
+                ret = -RED_EBADF;
+            }
+
+            #if REDCONF_VOLUME_COUNT > 1U
+                if( ret == 0 )
+                {
+                    ret = PosixVolSetCurrent( pHandle->bVolNum );
+                }
+            #endif
+
+            if( ret == 0 )
+            {
+                ulLenRead = ulLength;
+                ret = RedCoreFileRead( pHandle->ulInode, pHandle->ullOffset, &ulLenRead, pBuffer );
+            }
+
+            if( ret == 0 )
+            {
+                REDASSERT( ulLenRead <= ulLength );
+
+                pHandle->ullOffset += ulLenRead;
+            }
+
+            #if REDCONF_LATENCY_STATS == 1
+                LatencyRecord( RED_LATOP_READ, tsStart );
+            #endif
+
+            PosixLeave();
+        }
+
+        if( ret == 0 )
+        {
+            iReturn = ( int32_t ) ulLenRead;
+        }
+        else
+        {
+            iReturn = PosixReturn( ret );
+        }
+
+        return iReturn;
+    }
+
+
+    #if REDCONF_READBUF_COUNT > 0U
+
+/** @brief Read from an open file without copying the data.
+ *
+ *  Like red_read(), the read takes place at the file offset associated with
+ *  @p iFildes and advances the file offset by the number of bytes read.  But
+ *  instead of being copied into a caller buffer, the data is lent out of the
+ *  file system buffer cache: @p ppData is pointed at the data, which remains
+ *  valid until it is given back with red_releasebuf() or @p iFildes is
+ *  closed.  At most #REDCONF_READBUF_COUNT buffers can be lent out at once.
+ *
+ *  The data lent never extends past the end of the file system block which
+ *  contains the file offset, so fewer than @p ulLength bytes may be returned
+ *  even when the file has more data; call again to read the next block.  Zero
+ *  is returned at or beyond the end-of-file, in which case nothing is lent and
+ *  @p ppData is set to `NULL`.
+ *
+ *  While any of its data is lent out, the file cannot be written or truncated
+ *  through any file descriptor: such calls fail with #RED_EBUSY.  The file
+ *  cannot be deleted either, since the file descriptor stays open.
+ *
+ *  @param iFildes  The file descriptor from which to read.
+ *  @param ppData   On success, populated with a pointer to the data read, or
+ *                  `NULL` if zero is returned.  The data must not be modified.
+ *  @param ulLength Maximum number of bytes to read.
+ *
+ *  @return On success, returns a nonnegative value indicating the number of
+ *          bytes available at @p ppData.  On error, -1 is returned and
+ *          #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+ *    for reading.
+ *  - #RED_EBUSY: #REDCONF_READBUF_COUNT buffers are already lent out.
+ *  - #RED_EINVAL: @p ppData is `NULL`; or @p ulLength exceeds INT32_MAX and
+ *    cannot be returned properly.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_EISDIR: The @p iFildes is a file descriptor for a directory.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
  */
-        int32_t red_link( const char * pszPath,
-                          const char * pszHardLink )
+        int32_t red_readbuf( int32_t iFildes,
+                             const void ** ppData,
+                             uint32_t ulLength )
         {
+            uint32_t ulLenRead = 0U;
             REDSTATUS ret;
+            int32_t iReturn;
 
-            ret = PosixEnter();
+            if( ( ppData == NULL ) || ( ulLength > ( uint32_t ) INT32_MAX ) )
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                ret = PosixEnterShared();
+            }
 
             if( ret == 0 )
             {
-                const char * pszLocalPath;
-                uint8_t bVolNum;
+                REDHANDLE * pHandle;
+                READBUF * pReadBuf = NULL;
 
-                ret = RedPathSplit( pszPath, &bVolNum, &pszLocalPath );
+                ret = FildesToHandle( iFildes, FTYPE_FILE, &pHandle );
 
-                if( ret == 0 )
+                if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_READABLE ) == 0U ) )
                 {
-                    const char * pszLinkLocalPath;
-                    uint8_t bLinkVolNum;
-
-                    ret = RedPathSplit( pszHardLink, &bLinkVolNum, &pszLinkLocalPath );
+                    ret = -RED_EBADF;
+                }
 
-                    if( ( ret == 0 ) && ( bVolNum != bLinkVolNum ) )
+                #if REDCONF_VOLUME_COUNT > 1U
+                    if( ret == 0 )
                     {
-                        ret = -RED_EXDEV;
+                        ret = PosixVolSetCurrent( pHandle->bVolNum );
                     }
+                #endif
 
-                    #if REDCONF_VOLUME_COUNT > 1U
-                        if( ret == 0 )
+                /*  Claim an entry before reading: the FS mutex may be given up
+                 *  while the block is read, letting other readers in.
+                 */
+                if( ret == 0 )
+                {
+                    uint32_t ulIdx;
+
+                    for( ulIdx = 0U; ( ulIdx < REDCONF_READBUF_COUNT ) && ( pReadBuf == NULL ); ulIdx++ )
+                    {
+                        if( gaReadBuf[ ulIdx ].pHandle == NULL )
                         {
-                            ret = RedCoreVolSetCurrent( bVolNum );
+                            pReadBuf = &gaReadBuf[ ulIdx ];
+                            pReadBuf->pHandle = pHandle;
                         }
-                    #endif
+                    }
 
-                    if( ret == 0 )
+                    if( pReadBuf == NULL )
                     {
-                        uint32_t ulInode;
+                        ret = -RED_EBUSY;
+                    }
+                }
 
-                        ret = RedPathLookup( pszLocalPath, &ulInode );
+                if( ret == 0 )
+                {
+                    const uint8_t * pbBlock = NULL;
+                    const uint8_t * pbData = NULL;
 
-                        if( ret == 0 )
-                        {
-                            const char * pszLinkName;
-                            uint32_t ulLinkPInode;
+                    ulLenRead = ulLength;
+                    ret = RedCoreFileLend( pHandle->ulInode, pHandle->ullOffset, &ulLenRead, &pbBlock, &pbData );
 
-                            ret = RedPathToName( pszLinkLocalPath, &ulLinkPInode, &pszLinkName );
+                    if( ( ret == 0 ) && ( ulLenRead > 0U ) )
+                    {
+                        REDASSERT( ulLenRead <= ulLength );
 
-                            if( ret == 0 )
-                            {
-                                ret = RedCoreLink( ulLinkPInode, pszLinkName, ulInode );
-                            }
+                        pReadBuf->pbBlock = pbBlock;
+                        pReadBuf->pbData = pbData;
+                        pHandle->ullOffset += ulLenRead;
+
+                        *ppData = pReadBuf->pbData;
+                    }
+                    else
+                    {
+                        /*  Nothing was lent, so release the entry.
+                         */
+                        pReadBuf->pHandle = NULL;
+
+                        if( ret == 0 )
+                        {
+                            *ppData = NULL;
                         }
                     }
                 }
@@ -1322,179 +2154,312 @@
                 PosixLeave();
             }
 
-            return PosixReturn( ret );
+            if( ret == 0 )
+            {
+                iReturn = ( int32_t ) ulLenRead;
+            }
+            else
+            {
+                iReturn = PosixReturn( ret );
+            }
+
+            return iReturn;
         }
-    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_LINK == 1 ) */
 
 
-/** @brief Close a file descriptor.
+/** @brief Give back data lent by red_readbuf().
  *
- *  @param iFildes  The file descriptor to close.
+ *  @param pData    The data pointer populated by red_readbuf().
  *
  *  @return On success, zero is returned.  On error, -1 is returned and
  #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
- *  - #RED_EBADF: @p iFildes is not a valid file descriptor.
- *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_EINVAL: @p pData is not lent data.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
  */
-    int32_t red_close( int32_t iFildes )
-    {
-        REDSTATUS ret;
+        int32_t red_releasebuf( const void * pData )
+        {
+            REDSTATUS ret;
 
-        ret = PosixEnter();
+            if( pData == NULL )
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                ret = PosixEnterShared();
+            }
 
-        if( ret == 0 )
-        {
-            ret = FildesClose( iFildes );
+            if( ret == 0 )
+            {
+                READBUF * pReadBuf = NULL;
+                uint32_t ulIdx;
 
-            PosixLeave();
+                for( ulIdx = 0U; ( ulIdx < REDCONF_READBUF_COUNT ) && ( pReadBuf == NULL ); ulIdx++ )
+                {
+                    if( ( gaReadBuf[ ulIdx ].pbBlock != NULL ) && ( gaReadBuf[ ulIdx ].pbData == pData ) )
+                    {
+                        pReadBuf = &gaReadBuf[ ulIdx ];
+                    }
+                }
+
+                if( pReadBuf == NULL )
+                {
+                    ret = -RED_EINVAL;
+                }
+                else
+                {
+                    /*  Giving back the buffer only touches the buffer cache,
+                     *  which the FS mutex protects, so the volume need not be
+                     *  made current.
+                     */
+                    RedCoreFileReturn( pReadBuf->pbBlock );
+
+                    pReadBuf->pbBlock = NULL;
+                    pReadBuf->pbData = NULL;
+                    pReadBuf->pHandle = NULL;
+                }
+
+                PosixLeave();
+            }
+
+            return PosixReturn( ret );
         }
+    #endif /* if REDCONF_READBUF_COUNT > 0U */
 
-        return PosixReturn( ret );
-    }
 
+    #if REDCONF_READ_ONLY == 0
 
-/** @brief Read from an open file.
+/** @brief Write to an open file.
  *
- *  The read takes place at the file offset associated with @p iFildes and
- *  advances the file offset by the number of bytes actually read.
+ *  The write takes place at the file offset associated with @p iFildes and
+ *  advances the file offset by the number of bytes actually written.
+ *  Alternatively, if @p iFildes was opened with #RED_O_APPEND, the file offset
+ *  is set to the end-of-file before the write begins, and likewise advances by
+ *  the number of bytes actually written.
  *
- *  Data which has not yet been written, but which is before the end-of-file
- *  (sparse data), will read as zeroes.  A short read -- where the number of
- *  bytes read is less than requested -- indicates that the requested read was
- *  partially or, if zero bytes were read, entirely beyond the end-of-file.
+ *  A short write -- where the number of bytes written is less than requested
+ *  -- indicates either that the file system ran out of space but was still
+ *  able to write some of the request; or that the request would have caused
+ *  the file to exceed the maximum file size, but some of the data could be
+ *  written prior to the file size limit.
  *
- *  @param iFildes  The file descriptor from which to read.
- *  @param pBuffer  The buffer to populate with data read.  Must be at least
- *                  @p ulLength bytes in size.
- *  @param ulLength Number of bytes to attempt to read.
+ *  If an error is returned (-1), either none of the data was written or a
+ *  critical error occurred (like an I/O error) and the file system volume will
+ *  be read-only.
+ *
+ *  @param iFildes  The file descriptor to write to.
+ *  @param pBuffer  The buffer containing the data to be written.  Must be at
+ *                  least @p ulLength bytes in size.
+ *  @param ulLength Number of bytes to attempt to write.
  *
  *  @return On success, returns a nonnegative value indicating the number of
- *          bytes actually read.  On error, -1 is returned and #red_errno is
+ *          bytes actually written.  On error, -1 is returned and #red_errno is
  *          set appropriately.
  *
  *  <b>Errno values</b>
  *  - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
- *    for reading.
+ *    for writing.  This includes the case where the file descriptor is for a
+ *    directory.
+ *  - #RED_EBUSY: Data of the file is lent out by red_readbuf().
+ *  - #RED_EFBIG: No data can be written to the current file offset since the
+ *    resulting file size would exceed the maximum file size.
  *  - #RED_EINVAL: @p pBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
  *    cannot be returned properly.
  *  - #RED_EIO: A disk I/O error occurred.
- *  - #RED_EISDIR: The @p iFildes is a file descriptor for a directory.
+ *  - #RED_ENOSPC: No data can be written because there is insufficient free
+ *    space.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ *
+ *  When #REDCONF_WRITE_BEHIND_BYTES is non-zero, the data is copied into a
+ *  staging ring and written by the write-behind task, and red_write() returns
+ *  @p ulLength.  Any other call into the file system first finishes the
+ *  queued writes, so the data is visible to it.  An error from a queued write
+ *  (#RED_EFBIG, #RED_EIO, #RED_ENOSPC) is reported by the next red_fsync() or
+ *  red_close() of the file descriptor.
  */
-    int32_t red_read( int32_t iFildes,
-                      void * pBuffer,
-                      uint32_t ulLength )
-    {
-        uint32_t ulLenRead = 0U;
-        REDSTATUS ret;
-        int32_t iReturn;
-
-        if( ulLength > ( uint32_t ) INT32_MAX )
-        {
-            ret = -RED_EINVAL;
-        }
-        else
+        int32_t red_write( int32_t iFildes,
+                           const void * pBuffer,
+                           uint32_t ulLength )
         {
-            ret = PosixEnter();
-        }
+            uint32_t ulLenWrote = 0U;
+            REDSTATUS ret;
+            int32_t iReturn;
 
-        if( ret == 0 )
-        {
-            REDHANDLE * pHandle;
+            #if REDCONF_LATENCY_STATS == 1
+                REDTIMESTAMP tsStart = RedOsTimestamp();
+            #endif
+
+            if( ulLength > ( uint32_t ) INT32_MAX )
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                /*  With write-behind, the queued writes are not finished first:
+                 *  this write is queued behind them.
+                 */
+                #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                    ret = PosixEnterNoFence();
+                #else
+                    ret = PosixEnter();
+                #endif
+            }
+
+            if( ret == 0 )
+            {
+                REDHANDLE * pHandle;
+
+                ret = FildesToHandle( iFildes, FTYPE_FILE, &pHandle );
+
+                if( ret == -RED_EISDIR )
+                {
+                    /*  POSIX says that if a file descriptor is not writable, the
+                     *  errno should be -RED_EBADF.  Directory file descriptors are
+                     *  never writable, and unlike for read(), the spec does not
+                     *  list -RED_EISDIR as an allowed errno.  Therefore -RED_EBADF
+                     *  takes precedence.
+                     */
+                    ret = -RED_EBADF;
+                }
+
+                if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_WRITEABLE ) == 0U ) )
+                {
+                    ret = -RED_EBADF;
+                }
+
+                #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                    if( ( ret == 0 ) && ( pBuffer == NULL ) )
+                    {
+                        ret = -RED_EINVAL;
+                    }
+
+                    if( ret == 0 )
+                    {
+                        ret = ReadBufInodeCheck( pHandle->bVolNum, pHandle->ulInode );
+                    }
+
+                    if( ( ret == 0 ) && ( ulLength > 0U ) )
+                    {
+                        WriteBehindQueue( pHandle, pBuffer, ulLength );
+                        ulLenWrote = ulLength;
+                    }
+                #else /* if REDCONF_WRITE_BEHIND_BYTES > 0U */
+                    #if REDCONF_VOLUME_COUNT > 1U
+                        if( ret == 0 )
+                        {
+                            ret = PosixVolSetCurrent( pHandle->bVolNum );
+                        }
+                    #endif
+
+                    if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_APPENDING ) != 0U ) )
+                    {
+                        REDSTAT s;
+
+                        ret = RedCoreStat( pHandle->ulInode, &s );
+
+                        if( ret == 0 )
+                        {
+                            pHandle->ullOffset = s.st_size;
+                        }
+                    }
+
+                    if( ret == 0 )
+                    {
+                        ret = ReadBufInodeCheck( pHandle->bVolNum, pHandle->ulInode );
+                    }
+
+                    if( ret == 0 )
+                    {
+                        ulLenWrote = ulLength;
+                        ret = RedCoreFileWrite( pHandle->ulInode, pHandle->ullOffset, &ulLenWrote, pBuffer );
+                    }
+
+                    if( ret == 0 )
+                    {
+                        REDASSERT( ulLenWrote <= ulLength );
+
+                        pHandle->ullOffset += ulLenWrote;
+                    }
+                #endif /* if REDCONF_WRITE_BEHIND_BYTES > 0U */
+
+                #if REDCONF_LATENCY_STATS == 1
+                    LatencyRecord( RED_LATOP_WRITE, tsStart );
+                #endif
 
-            ret = FildesToHandle( iFildes, FTYPE_FILE, &pHandle );
+                PosixLeave();
 
-            if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_READABLE ) == 0U ) )
-            {
-                ret = -RED_EBADF;
+                #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                    if( ulLenWrote > 0U )
+                    {
+                        RedOsWriteBehindSignal();
+                    }
+                #endif
             }
 
-            #if REDCONF_VOLUME_COUNT > 1U
-                if( ret == 0 )
-                {
-                    ret = RedCoreVolSetCurrent( pHandle->bVolNum );
-                }
-            #endif
-
             if( ret == 0 )
             {
-                ulLenRead = ulLength;
-                ret = RedCoreFileRead( pHandle->ulInode, pHandle->ullOffset, &ulLenRead, pBuffer );
+                iReturn = ( int32_t ) ulLenWrote;
             }
-
-            if( ret == 0 )
+            else
             {
-                REDASSERT( ulLenRead <= ulLength );
-
-                pHandle->ullOffset += ulLenRead;
+                iReturn = PosixReturn( ret );
             }
 
-            PosixLeave();
-        }
-
-        if( ret == 0 )
-        {
-            iReturn = ( int32_t ) ulLenRead;
-        }
-        else
-        {
-            iReturn = PosixReturn( ret );
+            return iReturn;
         }
-
-        return iReturn;
-    }
+    #endif /* if REDCONF_READ_ONLY == 0 */
 
 
-    #if REDCONF_READ_ONLY == 0
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_COPY == 1 )
 
-/** @brief Write to an open file.
+/** @brief Copy data from one open file to another.
  *
- *  The write takes place at the file offset associated with @p iFildes and
- *  advances the file offset by the number of bytes actually written.
- *  Alternatively, if @p iFildes was opened with #RED_O_APPEND, the file offset
- *  is set to the end-of-file before the write begins, and likewise advances by
- *  the number of bytes actually written.
+ *  Copies up to @p ulLength bytes from the file offset associated with
+ *  @p iSrcFildes to the file offset associated with @p iDstFildes, and
+ *  advances both file offsets by the number of bytes copied.  The result is
+ *  the same as a red_read() from @p iSrcFildes followed by a red_write() of
+ *  the data to @p iDstFildes, but the data is moved a block at a time through
+ *  the file system buffer cache, so the caller needs no buffer for it.
  *
- *  A short write -- where the number of bytes written is less than requested
- *  -- indicates either that the file system ran out of space but was still
- *  able to write some of the request; or that the request would have caused
- *  the file to exceed the maximum file size, but some of the data could be
- *  written prior to the file size limit.
+ *  If @p iDstFildes was opened with #RED_O_APPEND, the data is copied to the
+ *  end of the destination file, as with red_write().
  *
- *  If an error is returned (-1), either none of the data was written or a
- *  critical error occurred (like an I/O error) and the file system volume will
- *  be read-only.
+ *  A short copy -- where the number of bytes copied is less than requested --
+ *  means that the end of the source file was reached; or that the file system
+ *  ran out of space or the destination reached the maximum file size part way
+ *  through the copy.  If @p ulLength is zero, or the source file offset is at
+ *  or beyond the end-of-file, nothing is copied and zero is returned.
  *
- *  @param iFildes  The file descriptor to write to.
- *  @param pBuffer  The buffer containing the data to be written.  Must be at
- *                  least @p ulLength bytes in size.
- *  @param ulLength Number of bytes to attempt to write.
+ *  @param iSrcFildes   The file descriptor to copy from.
+ *  @param iDstFildes   The file descriptor to copy to.
+ *  @param ulLength     The number of bytes to copy.
  *
- *  @return On success, returns a nonnegative value indicating the number of
- *          bytes actually written.  On error, -1 is returned and #red_errno is
- *          set appropriately.
+ *  @return On success, returns the number of bytes copied.  On error, -1 is
+ *          returned and #red_errno is set appropriately.
  *
  *  <b>Errno values</b>
- *  - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
- *    for writing.  This includes the case where the file descriptor is for a
- *    directory.
- *  - #RED_EFBIG: No data can be written to the current file offset since the
- *    resulting file size would exceed the maximum file size.
- *  - #RED_EINVAL: @p pBuffer is `NULL`; or @p ulLength exceeds INT32_MAX and
- *    cannot be returned properly.
+ *  - #RED_EBADF: The @p iSrcFildes argument is not a valid file descriptor
+ *    open for reading; or the @p iDstFildes argument is not a valid file
+ *    descriptor open for writing.  This includes the case where either file
+ *    descriptor is for a directory.
+ *  - #RED_EBUSY: Data of the destination file is lent out by red_readbuf().
+ *  - #RED_EFBIG: No data can be copied to the current destination file offset
+ *    since the resulting file size would exceed the maximum file size.
+ *  - #RED_EINVAL: @p ulLength exceeds INT32_MAX and cannot be returned
+ *    properly; or both file descriptors refer to the same file.
  *  - #RED_EIO: A disk I/O error occurred.
- *  - #RED_ENOSPC: No data can be written because there is insufficient free
+ *  - #RED_ENOSPC: No data can be copied because there is insufficient free
  *    space.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ *  - #RED_EXDEV: The file descriptors refer to files on different volumes.
  */
-        int32_t red_write( int32_t iFildes,
-                           const void * pBuffer,
-                           uint32_t ulLength )
+        int32_t red_copy( int32_t iSrcFildes,
+                          int32_t iDstFildes,
+                          uint32_t ulLength )
         {
-            uint32_t ulLenWrote = 0U;
+            uint32_t ulLenCopied = 0U;
             REDSTATUS ret;
             int32_t iReturn;
 
@@ -1509,56 +2474,85 @@
 
             if( ret == 0 )
             {
-                REDHANDLE * pHandle;
+                REDHANDLE * pSrcHandle;
+                REDHANDLE * pDstHandle = NULL;
 
-                ret = FildesToHandle( iFildes, FTYPE_FILE, &pHandle );
+                ret = FildesToHandle( iSrcFildes, FTYPE_FILE, &pSrcHandle );
 
                 if( ret == -RED_EISDIR )
                 {
-                    /*  POSIX says that if a file descriptor is not writable, the
-                     *  errno should be -RED_EBADF.  Directory file descriptors are
-                     *  never writable, and unlike for read(), the spec does not
-                     *  list -RED_EISDIR as an allowed errno.  Therefore -RED_EBADF
-                     *  takes precedence.
+                    /*  Directories cannot be copied, and as for the
+                     *  destination (see below), RED_EBADF is reported.
                      */
                     ret = -RED_EBADF;
                 }
 
-                if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_WRITEABLE ) == 0U ) )
+                if( ( ret == 0 ) && ( ( pSrcHandle->bFlags & HFLAG_READABLE ) == 0U ) )
+                {
+                    ret = -RED_EBADF;
+                }
+
+                if( ret == 0 )
+                {
+                    ret = FildesToHandle( iDstFildes, FTYPE_FILE, &pDstHandle );
+
+                    if( ret == -RED_EISDIR )
+                    {
+                        /*  Similar to red_write() (see comment there), the
+                         *  RED_EBADF error for a non-writable file descriptor
+                         *  takes precedence.
+                         */
+                        ret = -RED_EBADF;
+                    }
+                }
+
+                if( ( ret == 0 ) && ( ( pDstHandle->bFlags & HFLAG_WRITEABLE ) == 0U ) )
                 {
                     ret = -RED_EBADF;
                 }
 
+                if( ( ret == 0 ) && ( pSrcHandle->bVolNum != pDstHandle->bVolNum ) )
+                {
+                    ret = -RED_EXDEV;
+                }
+
                 #if REDCONF_VOLUME_COUNT > 1U
                     if( ret == 0 )
                     {
-                        ret = RedCoreVolSetCurrent( pHandle->bVolNum );
+                        ret = PosixVolSetCurrent( pDstHandle->bVolNum );
                     }
                 #endif
 
-                if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_APPENDING ) != 0U ) )
+                if( ( ret == 0 ) && ( ( pDstHandle->bFlags & HFLAG_APPENDING ) != 0U ) )
                 {
                     REDSTAT s;
 
-                    ret = RedCoreStat( pHandle->ulInode, &s );
+                    ret = RedCoreStat( pDstHandle->ulInode, &s );
 
                     if( ret == 0 )
                     {
-                        pHandle->ullOffset = s.st_size;
+                        pDstHandle->ullOffset = s.st_size;
                     }
                 }
 
                 if( ret == 0 )
                 {
-                    ulLenWrote = ulLength;
-                    ret = RedCoreFileWrite( pHandle->ulInode, pHandle->ullOffset, &ulLenWrote, pBuffer );
+                    ret = ReadBufInodeCheck( pDstHandle->bVolNum, pDstHandle->ulInode );
                 }
 
                 if( ret == 0 )
                 {
-                    REDASSERT( ulLenWrote <= ulLength );
+                    ulLenCopied = ulLength;
+                    ret = RedCoreFileCopy( pSrcHandle->ulInode, pSrcHandle->ullOffset,
+                                           pDstHandle->ulInode, pDstHandle->ullOffset, &ulLenCopied );
+                }
+
+                if( ret == 0 )
+                {
+                    REDASSERT( ulLenCopied <= ulLength );
 
-                    pHandle->ullOffset += ulLenWrote;
+                    pSrcHandle->ullOffset += ulLenCopied;
+                    pDstHandle->ullOffset += ulLenCopied;
                 }
 
                 PosixLeave();
@@ -1566,7 +2560,7 @@
 
             if( ret == 0 )
             {
-                iReturn = ( int32_t ) ulLenWrote;
+                iReturn = ( int32_t ) ulLenCopied;
             }
             else
             {
@@ -1575,7 +2569,7 @@
 
             return iReturn;
         }
-    #endif /* if REDCONF_READ_ONLY == 0 */
+    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_COPY == 1 ) */
 
 
     #if REDCONF_READ_ONLY == 0
@@ -1590,6 +2584,13 @@
  *  buffers are flushed and a transaction point is committed.  Fsyncing one
  *  file effectively fsyncs all files.
  *
+ *  The exception is when the intent log is enabled (REDCONF_INTENT_LOG_BLOCKS)
+ *  and every change to the file since the last transaction point is a write or
+ *  truncate held by the log: then only the new log sectors are written.  After
+ *  power loss, the volume mounts with the committed state plus the logged
+ *  changes, which include those of this file; changes to other files, and to
+ *  directories, only become durable at the next transaction point.
+ *
  *  If fsync automatic transactions have been disabled, this function does
  *  nothing and returns success.  In the current implementation, this is the
  *  only real difference between this function and red_transact(): this
@@ -1609,8 +2610,14 @@
  *
  *  <b>Errno values</b>
  *  - #RED_EBADF: The @p iFildes argument is not a valid file descriptor.
+ *  - #RED_EFBIG: A queued write through @p iFildes exceeded the maximum file
+ *    size.
  *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_ENOSPC: A queued write through @p iFildes ran out of space.
  *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ *
+ *  An error from a queued write is reported once: by the first red_fsync() or
+ *  red_close() of the file descriptor after it happened.
  */
         int32_t red_fsync( int32_t iFildes )
         {
@@ -1627,7 +2634,7 @@
                 #if REDCONF_VOLUME_COUNT > 1U
                     if( ret == 0 )
                     {
-                        ret = RedCoreVolSetCurrent( pHandle->bVolNum );
+                        ret = PosixVolSetCurrent( pHandle->bVolNum );
                     }
                 #endif
 
@@ -1642,10 +2649,18 @@
 
                     if( ( ret == 0 ) && ( ( ulTransMask & RED_TRANSACT_FSYNC ) != 0U ) )
                     {
-                        ret = RedCoreVolTransact();
+                        ret = RedCoreFileSync( pHandle->ulInode );
                     }
                 }
 
+                #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                    if( ( ret == 0 ) && ( pHandle->wbError != 0 ) )
+                    {
+                        ret = pHandle->wbError;
+                        pHandle->wbError = 0;
+                    }
+                #endif
+
                 PosixLeave();
             }
 
@@ -1712,7 +2727,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( pHandle->bVolNum );
+                    ret = PosixVolSetCurrent( pHandle->bVolNum );
                 }
             #endif
 
@@ -1827,6 +2842,7 @@
  *  - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
  *    for writing.  This includes the case where the file descriptor is for a
  *    directory.
+ *  - #RED_EBUSY: Data of the file is lent out by red_readbuf().
  *  - #RED_EFBIG: @p ullSize exceeds the maximum file size.
  *  - #RED_EIO: A disk I/O error occurred.
  *  - #RED_ENOSPC: Insufficient free space to perform the truncate.
@@ -1861,10 +2877,15 @@
                 #if REDCONF_VOLUME_COUNT > 1U
                     if( ret == 0 )
                     {
-                        ret = RedCoreVolSetCurrent( pHandle->bVolNum );
+                        ret = PosixVolSetCurrent( pHandle->bVolNum );
                     }
                 #endif
 
+                if( ret == 0 )
+                {
+                    ret = ReadBufInodeCheck( pHandle->bVolNum, pHandle->ulInode );
+                }
+
                 if( ret == 0 )
                 {
                     ret = RedCoreFileTruncate( pHandle->ulInode, ullSize );
@@ -1878,6 +2899,97 @@
     #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_FTRUNCATE == 1 ) */
 
 
+    #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_FALLOCATE == 1 )
+
+/** @brief Allocate space for a range of a file.
+ *
+ *  Data blocks are allocated for every part of the range which is sparse,
+ *  taking them from contiguous runs of free blocks as far as free space
+ *  allows.  Files which are preallocated and then filled by many small writes,
+ *  such as logs, are thereby laid out sequentially on disk, and are read back
+ *  with fewer and larger device reads.  The allocated area reads as zeroes.
+ *
+ *  If the range extends beyond the end-of-file, the file size is increased to
+ *  the end of the range.  The value of the file offset is not modified by
+ *  this function.
+ *
+ *  Since Reliance Edge never overwrites blocks which are in the committed
+ *  state, data written to a preallocated block after a transaction point is
+ *  written to a newly allocated block instead.  A preallocated range keeps
+ *  its layout only if it is written before the next transaction point.
+ *
+ *  If there is insufficient free space, part of the range may have been
+ *  allocated and the file size increased to cover it.
+ *
+ *  @param iFildes      The file descriptor of the file.
+ *  @param ullOffset    The file offset of the start of the range.
+ *  @param ullLen       The length of the range, in bytes.
+ *
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBADF: The @p iFildes argument is not a valid file descriptor open
+ *    for writing.  This includes the case where the file descriptor is for a
+ *    directory.
+ *  - #RED_EBUSY: Data of the file is lent out by red_readbuf().
+ *  - #RED_EFBIG: The range extends beyond the maximum file size.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_ENOSPC: Insufficient free space to allocate the whole range.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+        int32_t red_fallocate( int32_t iFildes,
+                               uint64_t ullOffset,
+                               uint64_t ullLen )
+        {
+            REDSTATUS ret;
+
+            ret = PosixEnter();
+
+            if( ret == 0 )
+            {
+                REDHANDLE * pHandle;
+
+                ret = FildesToHandle( iFildes, FTYPE_FILE, &pHandle );
+
+                if( ret == -RED_EISDIR )
+                {
+                    /*  Similar to red_write() (see comment there), the RED_EBADF error
+                     *  for a non-writable file descriptor takes precedence.
+                     */
+                    ret = -RED_EBADF;
+                }
+
+                if( ( ret == 0 ) && ( ( pHandle->bFlags & HFLAG_WRITEABLE ) == 0U ) )
+                {
+                    ret = -RED_EBADF;
+                }
+
+                #if REDCONF_VOLUME_COUNT > 1U
+                    if( ret == 0 )
+                    {
+                        ret = PosixVolSetCurrent( pHandle->bVolNum );
+                    }
+                #endif
+
+                if( ret == 0 )
+                {
+                    ret = ReadBufInodeCheck( pHandle->bVolNum, pHandle->ulInode );
+                }
+
+                if( ret == 0 )
+                {
+                    ret = RedCoreFileAllocate( pHandle->ulInode, ullOffset, ullLen );
+                }
+
+                PosixLeave();
+            }
+
+            return PosixReturn( ret );
+        }
+    #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_FALLOCATE == 1 ) */
+
+
 /** @brief Get the status of a file or directory.
  *
  *  See the ::REDSTAT type for the details of the information returned.
@@ -1900,7 +3012,7 @@
     {
         REDSTATUS ret;
 
-        ret = PosixEnter();
+        ret = PosixEnterShared();
 
         if( ret == 0 )
         {
@@ -1911,7 +3023,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( pHandle->bVolNum );
+                    ret = PosixVolSetCurrent( pHandle->bVolNum );
                 }
             #endif
 
@@ -2016,7 +3128,11 @@
             REDSTATUS ret;
             REDDIRENT * pDirEnt = NULL;
 
-            ret = PosixEnter();
+            #if REDCONF_LATENCY_STATS == 1
+                REDTIMESTAMP tsStart = RedOsTimestamp();
+            #endif
+
+            ret = PosixEnterShared();
 
             if( ret == 0 )
             {
@@ -2028,7 +3144,17 @@
                 #if REDCONF_VOLUME_COUNT > 1U
                     else
                     {
-                        ret = RedCoreVolSetCurrent( pDirStream->bVolNum );
+                        ret = PosixVolSetCurrent( pDirStream->bVolNum );
+
+                        #if REDCONF_LOCK_PER_VOLUME == 1
+                            /*  The stream might have been closed while
+                             *  waiting for the volume lock.
+                             */
+                            if( ( ret == 0 ) && !DirStreamIsValid( pDirStream ) )
+                            {
+                                ret = -RED_EBADF;
+                            }
+                        #endif
                     }
                 #endif
 
@@ -2070,19 +3196,157 @@
                         /*  Miscellaneous error; return NULL and set errno (done below).
                          */
                     }
-                }
+                }
+
+                #if REDCONF_LATENCY_STATS == 1
+                    LatencyRecord( RED_LATOP_READDIR, tsStart );
+                #endif
+
+                PosixLeave();
+            }
+
+            if( ret != 0 )
+            {
+                REDASSERT( pDirEnt == NULL );
+
+                red_errno = -ret;
+            }
+
+            return pDirEnt;
+        }
+
+
+/** @brief Read several entries from a directory stream.
+ *
+ *  Equivalent to calling red_readdir() up to @p ulCount times, but the file
+ *  system is entered only once for the whole batch, so listing a directory
+ *  takes far fewer calls and lock acquisitions.  Each entry is populated with
+ *  the same information as red_readdir() returns, including the stat data.
+ *
+ *  If an error occurs after some entries have been read, those entries are
+ *  returned; the error will normally recur on the next call.
+ *
+ *  When latency statistics are enabled, each call counts as one sample in the
+ *  #RED_LATOP_READDIR histogram, however many entries it reads.
+ *
+ *  @param pDirStream   The directory stream to read from.
+ *  @param pEntries     Array to populate with the entries read.
+ *  @param ulCount      The number of elements in @p pEntries.
+ *
+ *  @return On success, returns the number of entries read, which is less than
+ *          @p ulCount only if the end of the directory was reached; zero means
+ *          that there are no more entries.  On error, -1 is returned and
+ *          #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EBADF: @p pDirStream is not an open directory stream.
+ *  - #RED_EINVAL: @p pEntries is `NULL`; or @p ulCount is zero or greater than
+ *    INT32_MAX.
+ *  - #RED_EIO: A disk I/O error occurred.
+ *  - #RED_EUSERS: Cannot become a file system user: too many users.
+ */
+        int32_t red_readdirmulti( REDDIR * pDirStream,
+                                  REDDIRENT * pEntries,
+                                  uint32_t ulCount )
+        {
+            REDSTATUS ret;
+            uint32_t ulRead = 0U;
+            int32_t iReturn;
+
+            #if REDCONF_LATENCY_STATS == 1
+                REDTIMESTAMP tsStart = RedOsTimestamp();
+            #endif
+
+            if( ( pEntries == NULL ) || ( ulCount == 0U ) || ( ulCount > ( uint32_t ) INT32_MAX ) )
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                ret = PosixEnterShared();
+
+                if( ret == 0 )
+                {
+                    if( !DirStreamIsValid( pDirStream ) )
+                    {
+                        ret = -RED_EBADF;
+                    }
+
+                    #if REDCONF_VOLUME_COUNT > 1U
+                        else
+                        {
+                            ret = PosixVolSetCurrent( pDirStream->bVolNum );
+
+                            #if REDCONF_LOCK_PER_VOLUME == 1
+                                if( ( ret == 0 ) && !DirStreamIsValid( pDirStream ) )
+                                {
+                                    ret = -RED_EBADF;
+                                }
+                            #endif
+                        }
+                    #endif
+
+                    if( ret == 0 )
+                    {
+                        uint32_t ulDirPosition;
+                        bool fEnd = false;
+
+                        REDASSERT( pDirStream->ullOffset <= UINT32_MAX );
+                        ulDirPosition = ( uint32_t ) pDirStream->ullOffset;
+
+                        while( ( ret == 0 ) && !fEnd && ( ulRead < ulCount ) )
+                        {
+                            REDDIRENT * pDirEnt = &pEntries[ ulRead ];
+
+                            ret = RedCoreDirRead( pDirStream->ulInode, &ulDirPosition, pDirEnt->d_name, &pDirEnt->d_ino );
+
+                            if( ret == 0 )
+                            {
+                                ret = RedCoreStat( pDirEnt->d_ino, &pDirEnt->d_stat );
+
+                                if( ret == 0 )
+                                {
+                                    ulRead++;
+                                }
+                            }
+                            else if( ret == -RED_ENOENT )
+                            {
+                                fEnd = true;
+                                ret = 0;
+                            }
+                            else
+                            {
+                                /*  Miscellaneous error; loop will terminate.
+                                 */
+                            }
+                        }
+
+                        pDirStream->ullOffset = ulDirPosition;
+
+                        if( ulRead > 0U )
+                        {
+                            ret = 0;
+                        }
+                    }
 
-                PosixLeave();
+                    #if REDCONF_LATENCY_STATS == 1
+                        LatencyRecord( RED_LATOP_READDIR, tsStart );
+                    #endif
+
+                    PosixLeave();
+                }
             }
 
-            if( ret != 0 )
+            if( ret == 0 )
             {
-                REDASSERT( pDirEnt == NULL );
-
-                red_errno = -ret;
+                iReturn = ( int32_t ) ulRead;
+            }
+            else
+            {
+                iReturn = PosixReturn( ret );
             }
 
-            return pDirEnt;
+            return iReturn;
         }
 
 
@@ -2260,6 +3524,65 @@
             return piErrno;
         #endif /* if REDCONF_TASK_COUNT == 1U */
     }
+
+
+    #if REDCONF_TASK_COUNT > 1U
+
+/** @brief Release the task slot of the calling task.
+ *
+ *  A task which has used the file system holds one of the
+ *  #REDCONF_TASK_COUNT task slots until red_uninit(), even after the task
+ *  has been deleted.  A task which is about to be deleted, and which will not
+ *  call the file system again, should call this function, so that its slot
+ *  can be used by the tasks created after it.  If the task calls the file
+ *  system again, including by reading #red_errno, it is registered again.
+ *
+ *  Does nothing if the calling task does not hold a task slot.
+ *
+ *  @return On success, zero is returned.  On error, -1 is returned and
+ #red_errno is set appropriately.
+ *
+ *  <b>Errno values</b>
+ *  - #RED_EINVAL: The driver is uninitialized.
+ */
+        int32_t red_taskrelease( void )
+        {
+            REDSTATUS ret;
+
+            if( gfPosixInited )
+            {
+                uint32_t ulTaskId = RedOsTaskId();
+                uint32_t ulIdx;
+
+                RedOsMutexAcquire();
+
+                for( ulIdx = 0U; ulIdx < REDCONF_TASK_COUNT; ulIdx++ )
+                {
+                    if( gaTask[ ulIdx ].ulTaskId == ulTaskId )
+                    {
+                        /*  Locks are only held during a call.
+                         */
+                        #if REDCONF_LOCK_PER_VOLUME == 1
+                            REDASSERT( !gaTask[ ulIdx ].fVolLocked );
+                        #endif
+
+                        RedMemSet( &gaTask[ ulIdx ], 0U, sizeof( gaTask[ ulIdx ] ) );
+                        break;
+                    }
+                }
+
+                RedOsMutexRelease();
+
+                ret = 0;
+            }
+            else
+            {
+                ret = -RED_EINVAL;
+            }
+
+            return PosixReturn( ret );
+        }
+    #endif /* REDCONF_TASK_COUNT > 1U */
 /** @} */
 
 /*-------------------------------------------------------------------
@@ -2309,7 +3632,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( bVolNum );
+                    ret = PosixVolSetCurrent( bVolNum );
                 }
             #endif
 
@@ -2324,7 +3647,7 @@
                 {
                     uint32_t ulInode;
 
-                    ret = RedCoreLookup( ulPInode, pszName, &ulInode );
+                    ret = RedPathLookupName( ulPInode, pszName, &ulInode );
 
                     /*  ModeTypeCheck() always passes when the type is FTYPE_EITHER, so
                      *  skip stat'ing the inode in that case.
@@ -2348,6 +3671,10 @@
 
                     if( ret == 0 )
                     {
+                        #if REDCONF_PATH_CACHE_ENTRIES > 0U
+                            RedPathCacheRemove( ulPInode, pszName );
+                        #endif
+
                         ret = RedCoreUnlink( ulPInode, pszName );
                     }
                 }
@@ -2408,6 +3735,15 @@
 
         ret = RedPathSplit( pszPath, &bVolNum, &pszLocalPath );
 
+        #if REDCONF_LOCK_PER_VOLUME == 1
+            /*  Lock the volume before examining its state.
+             */
+            if( ret == 0 )
+            {
+                ret = PosixVolLock( bVolNum );
+            }
+        #endif
+
         if( ret == 0 )
         {
             if( piFildes == NULL )
@@ -2449,8 +3785,18 @@
                     uint16_t uMode = 0U;
                     uint32_t ulInode = 0U; /* Init'd to quiet warnings. */
 
+                    #if REDCONF_LOCK_PER_VOLUME == 1
+                        /*  The FS mutex may be released while the lookups
+                         *  below wait for the disk, so reserve the handle
+                         *  against tasks on other volumes.  The invalid volume
+                         *  number keeps the handle from being used meanwhile.
+                         */
+                        pHandle->ulInode = HANDLE_INODE_RESERVED;
+                        pHandle->bVolNum = REDCONF_VOLUME_COUNT;
+                    #endif
+
                     #if REDCONF_VOLUME_COUNT > 1U
-                        ret = RedCoreVolSetCurrent( bVolNum );
+                        ret = PosixVolSetCurrent( bVolNum );
 
                         if( ret == 0 )
                     #endif
@@ -2476,7 +3822,7 @@
                                         /*  If the path already exists and that's OK,
                                          *  lookup its inode number.
                                          */
-                                        ret = RedCoreLookup( ulPInode, pszName, &ulInode );
+                                        ret = RedPathLookupName( ulPInode, pszName, &ulInode );
                                     }
                                     else
                                     {
@@ -2528,7 +3874,12 @@
                         #if ( REDCONF_READ_ONLY == 0 ) && ( REDCONF_API_POSIX_FTRUNCATE == 1 )
                             if( ( ret == 0 ) && ( ( ulOpenMode & RED_O_TRUNC ) != 0U ) )
                             {
-                                ret = RedCoreFileTruncate( ulInode, UINT64_SUFFIX( 0 ) );
+                                ret = ReadBufInodeCheck( bVolNum, ulInode );
+
+                                if( ret == 0 )
+                                {
+                                    ret = RedCoreFileTruncate( ulInode, UINT64_SUFFIX( 0 ) );
+                                }
                             }
                         #endif
                     }
@@ -2581,6 +3932,15 @@
                             *piFildes = iFildes;
                         }
                     }
+
+                    #if REDCONF_LOCK_PER_VOLUME == 1
+                        if( ret != 0 )
+                        {
+                            /*  Release the reservation.
+                             */
+                            pHandle->ulInode = INODE_INVALID;
+                        }
+                    #endif
                 }
             }
         }
@@ -2597,7 +3957,11 @@
  *
  *  @retval 0           Operation was successful.
  *  @retval -RED_EBADF  @p iFildes is not a valid file descriptor.
+ *  @retval -RED_EFBIG  A queued write exceeded the maximum file size.  The
+ *                      file descriptor is still closed.
  *  @retval -RED_EIO    A disk I/O error occurred.
+ *  @retval -RED_ENOSPC A queued write ran out of space.  The file descriptor
+ *                      is still closed.
  */
     static REDSTATUS FildesClose( int32_t iFildes )
     {
@@ -2610,7 +3974,7 @@
             #if REDCONF_VOLUME_COUNT > 1U
                 if( ret == 0 )
                 {
-                    ret = RedCoreVolSetCurrent( pHandle->bVolNum );
+                    ret = PosixVolSetCurrent( pHandle->bVolNum );
                 }
             #endif
 
@@ -2632,9 +3996,17 @@
 
         if( ret == 0 )
         {
+            #if REDCONF_READBUF_COUNT > 0U
+                ReadBufReleaseHandle( pHandle );
+            #endif
+
             /*  Mark this handle as unused.
              */
             pHandle->ulInode = INODE_INVALID;
+
+            #if REDCONF_WRITE_BEHIND_BYTES > 0U
+                ret = pHandle->wbError;
+            #endif
         }
 
         return ret;
@@ -2684,6 +4056,26 @@
 
             FildesUnpack( iFildes, &uHandleIdx, &bVolNum, &uGeneration );
 
+            #if REDCONF_LOCK_PER_VOLUME == 1
+                /*  Lock the volume before validating the handle, since the
+                 *  handle could be closed while waiting for the lock.
+                 */
+                if( bVolNum >= REDCONF_VOLUME_COUNT )
+                {
+                    ret = -RED_EBADF;
+                }
+                else
+                {
+                    ret = PosixVolLock( bVolNum );
+                }
+
+                if( ret != 0 )
+                {
+                    /*  Propagate the error.
+                     */
+                }
+                else
+            #endif
             if( ( uHandleIdx >= REDCONF_HANDLE_COUNT ) ||
                 ( bVolNum >= REDCONF_VOLUME_COUNT ) ||
                 ( gaHandle[ uHandleIdx ].ulInode == INODE_INVALID ) ||
@@ -2859,6 +4251,10 @@
 
 
 /** @brief Enter the file system driver.
+ *
+ *  When #REDCONF_WRITE_BEHIND_BYTES is non-zero, the queued writes are applied
+ *  before returning, so that the caller sees the data of every write which has
+ *  returned.
  *
  *  @return A negated ::REDSTATUS code indicating the operation result.
  *
@@ -2870,43 +4266,272 @@
     {
         REDSTATUS ret;
 
+        ret = PosixEnterNoFence();
+
+        #if REDCONF_WRITE_BEHIND_BYTES > 0U
+            if( ret == 0 )
+            {
+                WriteBehindFence();
+            }
+        #endif
+
+        return ret;
+    }
+
+
+/** @brief Enter the file system driver, without applying queued writes.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The file system driver is uninitialized.
+ *  @retval -RED_EUSERS Cannot become a file system user: too many users.
+ */
+    static REDSTATUS PosixEnterNoFence( void )
+    {
+        REDSTATUS ret;
+
         if( gfPosixInited )
         {
             #if REDCONF_TASK_COUNT > 1U
+                #if REDCONF_STATS == 1
+                    REDTIMESTAMP tsStart = RedOsTimestamp();
+                    uint64_t ullWait;
+                #endif
+
                 RedOsMutexAcquire();
 
+                #if REDCONF_STATS == 1
+                    ullWait = RedOsTimePassed( tsStart );
+
+                    gLockStats.ulEnters++;
+
+                    if( ullWait > 0U )
+                    {
+                        gLockStats.ulEnterWaits++;
+                        gLockStats.ullEnterWaitMicrosec += ullWait;
+
+                        if( ullWait > gLockStats.ulEnterWaitMaxMicrosec )
+                        {
+                            gLockStats.ulEnterWaitMaxMicrosec = ( uint32_t ) REDMIN( ullWait, UINT32_MAX );
+                        }
+                    }
+                #endif
+
                 ret = TaskRegister( NULL );
 
-                if( ret != 0 )
+                if( ret != 0 )
+                {
+                    RedOsMutexRelease();
+                }
+            #else
+                ret = 0;
+            #endif
+        }
+        else
+        {
+            ret = -RED_EINVAL;
+        }
+
+        return ret;
+    }
+
+
+    #if REDCONF_LOCK_SHARED_READERS > 0U
+
+/** @brief Enter the file system driver for a call which only reads.
+ *
+ *  Like PosixEnter(), but the volume lock taken later in the call is taken
+ *  shared, so that the call runs concurrently with other such calls on the
+ *  same volume.  The call must not modify the volume, nor any state which
+ *  belongs to the volume as a whole; it may modify the handle it reads from.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL The file system driver is uninitialized.
+ *  @retval -RED_EUSERS Cannot become a file system user: too many users.
+ */
+        static REDSTATUS PosixEnterShared( void )
+        {
+            REDSTATUS ret;
+
+            ret = PosixEnter();
+
+            if( ret == 0 )
+            {
+                uint32_t ulTaskIdx;
+
+                /*  The task was registered by PosixEnter(), so this cannot
+                 *  fail.
+                 */
+                ret = TaskRegister( &ulTaskIdx );
+
+                if( ret == 0 )
+                {
+                    gaTask[ ulTaskIdx ].fVolShared = true;
+                }
+                else
+                {
+                    PosixLeave();
+                }
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_LOCK_SHARED_READERS > 0U */
+
+
+/** @brief Leave the file system driver.
+ */
+    static void PosixLeave( void )
+    {
+        /*  If the driver was uninitialized, PosixEnter() should have failed and we
+         *  should not be calling PosixLeave().
+         */
+        REDASSERT( gfPosixInited );
+
+        #if REDCONF_LOCK_PER_VOLUME == 1
+            {
+                uint32_t ulTaskIdx;
+
+                /*  The task is registered, so this cannot fail.
+                 */
+                if( TaskRegister( &ulTaskIdx ) == 0 )
+                {
+                    TASKSLOT * pTask = &gaTask[ ulTaskIdx ];
+
+                    if( pTask->fVolLocked )
+                    {
+                        pTask->fVolLocked = false;
+                        RedOsVolMutexRelease( pTask->bVolLocked, pTask->fVolShared );
+                    }
+
+                    pTask->fVolShared = false;
+                }
+            }
+        #endif
+
+        #if REDCONF_TASK_COUNT > 1U
+            RedOsMutexRelease();
+        #endif
+    }
+
+
+    #if REDCONF_VOLUME_COUNT > 1U
+
+/** @brief Make a volume the current volume for the rest of the operation.
+ *
+ *  With a lock per volume, this also acquires the lock for the volume, see
+ *  PosixVolLock().
+ *
+ *  @param bVolNum  The volume number of the volume to make current.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p bVolNum is not a valid volume number.
+ *  @retval -RED_EFUBAR The calling task already holds the lock for a
+ *                      different volume.
+ */
+        static REDSTATUS PosixVolSetCurrent( uint8_t bVolNum )
+        {
+            REDSTATUS ret;
+
+            #if REDCONF_LOCK_PER_VOLUME == 1
+                ret = PosixVolLock( bVolNum );
+
+                if( ret == 0 )
+            #endif
+            {
+                ret = RedCoreVolSetCurrent( bVolNum );
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_VOLUME_COUNT > 1U */
+
+
+    #if REDCONF_LOCK_PER_VOLUME == 1
+
+/** @brief Acquire the lock for a volume, if the calling task does not already
+ *         hold it.
+ *
+ *  The lock ordering is: volume lock, then FS mutex, then block device lock.
+ *  A POSIX API call locks at most one volume (operations which name two
+ *  volumes fail with #RED_EXDEV before locking either), and holds it until
+ *  PosixLeave().  While holding its volume lock, a task releases the FS mutex
+ *  to wait for a block to be read from that volume, so that tasks on other
+ *  volumes can make progress; see the buffer module.
+ *
+ *  The caller holds the FS mutex.  If the volume is locked by another task,
+ *  the FS mutex is released while waiting for the volume lock, to respect the
+ *  lock ordering; so any global state examined before calling this function
+ *  must be examined again afterward.
+ *
+ *  @param bVolNum  The volume number of the volume to lock.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EINVAL @p bVolNum is not a valid volume number.
+ *  @retval -RED_EFUBAR The calling task already holds the lock for a
+ *                      different volume.
+ */
+        static REDSTATUS PosixVolLock( uint8_t bVolNum )
+        {
+            uint32_t ulTaskIdx;
+            REDSTATUS ret;
+
+            if( bVolNum >= REDCONF_VOLUME_COUNT )
+            {
+                ret = -RED_EINVAL;
+            }
+            else
+            {
+                ret = TaskRegister( &ulTaskIdx );
+            }
+
+            if( ret == 0 )
+            {
+                TASKSLOT * pTask = &gaTask[ ulTaskIdx ];
+
+                if( pTask->fVolLocked )
                 {
-                    RedOsMutexRelease();
+                    if( pTask->bVolLocked != bVolNum )
+                    {
+                        /*  Holding two volume locks at once could deadlock.
+                         */
+                        REDERROR();
+                        ret = -RED_EFUBAR;
+                    }
                 }
-            #else
-                ret = 0;
-            #endif
-        }
-        else
-        {
-            ret = -RED_EINVAL;
-        }
+                else
+                {
+                    if( !RedOsVolMutexTryAcquire( bVolNum, pTask->fVolShared ) )
+                    {
+                        #if REDCONF_STATS == 1
+                            REDTIMESTAMP tsStart = RedOsTimestamp();
+                        #endif
 
-        return ret;
-    }
+                        RedOsMutexRelease();
+                        RedOsVolMutexAcquire( bVolNum, pTask->fVolShared );
+                        RedOsMutexAcquire();
 
+                        #if REDCONF_STATS == 1
+                            gLockStats.ulVolWaits++;
+                            gLockStats.ullVolWaitMicrosec += RedOsTimePassed( tsStart );
+                        #endif
+                    }
 
-/** @brief Leave the file system driver.
- */
-    static void PosixLeave( void )
-    {
-        /*  If the driver was uninitialized, PosixEnter() should have failed and we
-         *  should not be calling PosixLeave().
-         */
-        REDASSERT( gfPosixInited );
+                    pTask->fVolLocked = true;
+                    pTask->bVolLocked = bVolNum;
+                }
+            }
 
-        #if REDCONF_TASK_COUNT > 1U
-            RedOsMutexRelease();
-        #endif
-    }
+            return ret;
+        }
+    #endif /* REDCONF_LOCK_PER_VOLUME == 1 */
 
 
 /** @brief Check that a mode is consistent with the given expected type.
@@ -3001,6 +4626,70 @@
     #endif /* if ( REDCONF_READ_ONLY == 0 ) && ( ( REDCONF_API_POSIX_UNLINK == 1 ) || ( REDCONF_API_POSIX_RMDIR == 1 ) || ( ( REDCONF_API_POSIX_RENAME == 1 ) && ( REDCONF_RENAME_ATOMIC == 1 ) ) ) */
 
 
+    #if REDCONF_READBUF_COUNT > 0U
+
+/** @brief Release the data lent by red_readbuf() through a handle.
+ *
+ *  @param pHandle  The handle which is being closed.
+ */
+        static void ReadBufReleaseHandle( const REDHANDLE * pHandle )
+        {
+            uint32_t ulIdx;
+
+            for( ulIdx = 0U; ulIdx < REDCONF_READBUF_COUNT; ulIdx++ )
+            {
+                READBUF * pReadBuf = &gaReadBuf[ ulIdx ];
+
+                if( ( pReadBuf->pHandle == pHandle ) && ( pReadBuf->pbBlock != NULL ) )
+                {
+                    RedCoreFileReturn( pReadBuf->pbBlock );
+
+                    pReadBuf->pbBlock = NULL;
+                    pReadBuf->pbData = NULL;
+                    pReadBuf->pHandle = NULL;
+                }
+            }
+        }
+    #endif /* if REDCONF_READBUF_COUNT > 0U */
+
+
+    #if ( REDCONF_READBUF_COUNT > 0U ) && ( REDCONF_READ_ONLY == 0 )
+
+/** @brief Check whether the data of an inode may be modified.
+ *
+ *  Data lent out by red_readbuf() must not change until it is released, so
+ *  writing or truncating a file with lent data is refused.
+ *
+ *  @param bVolNum  The volume containing the inode.
+ *  @param ulInode  The inode which is to be modified.
+ *
+ *  @return A negated ::REDSTATUS code indicating the operation result.
+ *
+ *  @retval 0           Operation was successful.
+ *  @retval -RED_EBUSY  Data of the inode is lent out.
+ */
+        static REDSTATUS ReadBufInodeCheck( uint8_t bVolNum,
+                                            uint32_t ulInode )
+        {
+            REDSTATUS ret = 0;
+            uint32_t ulIdx;
+
+            for( ulIdx = 0U; ulIdx < REDCONF_READBUF_COUNT; ulIdx++ )
+            {
+                const REDHANDLE * pHandle = gaReadBuf[ ulIdx ].pHandle;
+
+                if( ( pHandle != NULL ) && ( pHandle->ulInode == ulInode ) && ( pHandle->bVolNum == bVolNum ) )
+                {
+                    ret = -RED_EBUSY;
+                    break;
+                }
+            }
+
+            return ret;
+        }
+    #endif /* if ( REDCONF_READBUF_COUNT > 0U ) && ( REDCONF_READ_ONLY == 0 ) */
+
+
     #if REDCONF_TASK_COUNT > 1U
 
 /** @brief Register a task as a file system user, if it is not already
@@ -3079,6 +4768,353 @@
     #endif /* REDCONF_TASK_COUNT > 1U */
 
 
+    #if REDCONF_TRANSACT_TASK == 1
+
+/** @brief Check each mounted volume against the transaction task thresholds.
+ *
+ *  Called by the transaction task once every period.  Each volume is visited
+ *  in a call of its own, as with the public API, so that the volume locks are
+ *  taken as they would be for any other task.  Errors are not reported, since
+ *  there is no one to report them to; a volume which fails to commit is made
+ *  read-only by the core.
+ */
+        static void TransactTaskPoll( void )
+        {
+            uint8_t bVolNum;
+
+            for( bVolNum = 0U; bVolNum < REDCONF_VOLUME_COUNT; bVolNum++ )
+            {
+                if( PosixEnter() == 0 )
+                {
+                    if( gaRedVolume[ bVolNum ].fMounted )
+                    {
+                        REDSTATUS ret = 0;
+
+                        #if REDCONF_VOLUME_COUNT > 1U
+                            ret = PosixVolSetCurrent( bVolNum );
+                        #endif
+
+                        if( ret == 0 )
+                        {
+                            ( void ) RedCoreVolTransactPolicy( REDCONF_TRANSACT_TASK_PERIOD_MS );
+                        }
+                    }
+
+                    PosixLeave();
+                }
+            }
+        }
+    #endif /* REDCONF_TRANSACT_TASK == 1 */
+
+
+    #if REDCONF_WRITE_BEHIND_BYTES > 0U
+
+/** @brief Queue a write in the write-behind staging ring.
+ *
+ *  A write larger than the ring is queued in pieces.  When a piece does not
+ *  fit, the calling task finishes the queued writes itself, rather than
+ *  waiting for the write-behind task, and then queues the piece.  The caller
+ *  must be in the file system driver.
+ *
+ *  @param pHandle  The handle being written through.
+ *  @param pbBuffer The data to write.
+ *  @param ulLen    The number of bytes to write; must be nonzero.
+ */
+        static void WriteBehindQueue( REDHANDLE * pHandle,
+                                      const uint8_t * pbBuffer,
+                                      uint32_t ulLen )
+        {
+            uint32_t ulDone = 0U;
+
+            while( ulDone < ulLen )
+            {
+                uint32_t ulChunk = REDMIN( ulLen - ulDone, REDCONF_WRITE_BEHIND_BYTES );
+                uint32_t ulPos = 0U;
+                WBENTRY * pEntry;
+
+                if( !WriteBehindReserve( ulChunk, &ulPos ) )
+                {
+                    bool fReserved;
+
+                    gWbStats.ulStalls++;
+                    WriteBehindFence();
+
+                    /*  The ring is empty now, so any piece fits.
+                     */
+                    fReserved = WriteBehindReserve( ulChunk, &ulPos );
+                    REDASSERT( fReserved );
+                    ( void ) fReserved;
+                }
+
+                pEntry = &gaWbEntry[ ( gulWbFirst + gulWbCount ) % REDCONF_WRITE_BEHIND_ENTRIES ];
+                pEntry->pHandle = pHandle;
+                pEntry->ullOffset = pHandle->ullOffset;
+                pEntry->ulPos = ulPos;
+                pEntry->ulLen = ulChunk;
+                pEntry->fAppend = ( pHandle->bFlags & HFLAG_APPENDING ) != 0U;
+
+                RedMemCpy( &gabWbRing[ ulPos ], &pbBuffer[ ulDone ], ulChunk );
+
+                gulWbNextPos = ulPos + ulChunk;
+                gulWbCount++;
+                gulWbBytes += ulChunk;
+
+                /*  The offset of an appending handle is only known once the
+                 *  write is applied.
+                 */
+                if( !pEntry->fAppend )
+                {
+                    pHandle->ullOffset += ulChunk;
+                }
+
+                gWbStats.ulWrites++;
+
+                if( gulWbCount > gWbStats.ulMaxDepth )
+                {
+                    gWbStats.ulMaxDepth = gulWbCount;
+                }
+
+                if( gulWbBytes > gWbStats.ulMaxBytes )
+                {
+                    gWbStats.ulMaxBytes = gulWbBytes;
+                }
+
+                ulDone += ulChunk;
+            }
+        }
+
+
+/** @brief Find room in the staging ring for the data of a queued write.
+ *
+ *  The data of each write is kept contiguous: if it does not fit between the
+ *  newest data and the end of the ring, it goes at the start of the ring.
+ *
+ *  @param ulLen    The number of bytes to find room for.
+ *  @param pulPos   On success, populated with the position of the room.
+ *
+ *  @return Whether there was room for the data and a free queue entry.
+ */
+        static bool WriteBehindReserve( uint32_t ulLen,
+                                        uint32_t * pulPos )
+        {
+            bool fRet = false;
+
+            if( gulWbCount == 0U )
+            {
+                *pulPos = 0U;
+                fRet = true;
+            }
+            else if( gulWbCount < REDCONF_WRITE_BEHIND_ENTRIES )
+            {
+                uint32_t ulFirstPos = gaWbEntry[ gulWbFirst ].ulPos;
+
+                if( gulWbNextPos > ulFirstPos )
+                {
+                    /*  The queued data does not wrap: room is after it, or
+                     *  before it at the start of the ring.
+                     */
+                    if( ( REDCONF_WRITE_BEHIND_BYTES - gulWbNextPos ) >= ulLen )
+                    {
+                        *pulPos = gulWbNextPos;
+                        fRet = true;
+                    }
+                    else if( ulFirstPos >= ulLen )
+                    {
+                        *pulPos = 0U;
+                        fRet = true;
+                    }
+                    else
+                    {
+                        /*  No room.
+                         */
+                    }
+                }
+                else if( ( ulFirstPos - gulWbNextPos ) >= ulLen )
+                {
+                    /*  The queued data wraps: room is only in the gap.
+                     */
+                    *pulPos = gulWbNextPos;
+                    fRet = true;
+                }
+                else
+                {
+                    /*  No room.
+                     */
+                }
+            }
+            else
+            {
+                /*  No free entry.
+                 */
+            }
+
+            return fRet;
+        }
+
+
+/** @brief Apply the oldest queued write, and remove it from the queue.
+ *
+ *  An error is recorded in the handle, to be reported by red_fsync() or
+ *  red_close().  The caller must be in the file system driver, and the queue
+ *  must not be empty.
+ */
+        static void WriteBehindApply( void )
+        {
+            const WBENTRY * pEntry = &gaWbEntry[ gulWbFirst ];
+            REDHANDLE * pHandle = pEntry->pHandle;
+            uint64_t ullOffset = pEntry->ullOffset;
+            uint32_t ulLenWrote = 0U;
+            REDSTATUS ret = 0;
+
+            REDASSERT( gulWbCount > 0U );
+
+            #if REDCONF_VOLUME_COUNT > 1U
+                ret = PosixVolSetCurrent( pHandle->bVolNum );
+            #endif
+
+            if( ( ret == 0 ) && pEntry->fAppend )
+            {
+                REDSTAT s;
+
+                ret = RedCoreStat( pHandle->ulInode, &s );
+
+                if( ret == 0 )
+                {
+                    ullOffset = s.st_size;
+                }
+            }
+
+            if( ret == 0 )
+            {
+                uint32_t ulLen = pEntry->ulLen;
+
+                ret = RedCoreFileWrite( pHandle->ulInode, ullOffset, &ulLen, &gabWbRing[ pEntry->ulPos ] );
+
+                if( ret == 0 )
+                {
+                    ulLenWrote = ulLen;
+                }
+            }
+
+            if( ( ret == 0 ) && ( ulLenWrote < pEntry->ulLen ) )
+            {
+                uint32_t ulLenRest = pEntry->ulLen - ulLenWrote;
+
+                /*  A short write means that the volume is full or the file is
+                 *  at its maximum size.  Writing the rest gets the error which
+                 *  red_write() would have returned for it.
+                 */
+                ret = RedCoreFileWrite( pHandle->ulInode, ullOffset + ulLenWrote, &ulLenRest, &gabWbRing[ pEntry->ulPos + ulLenWrote ] );
+
+                if( ret == 0 )
+                {
+                    ulLenWrote += ulLenRest;
+
+                    if( ulLenWrote < pEntry->ulLen )
+                    {
+                        ret = -RED_ENOSPC;
+                    }
+                }
+            }
+
+            if( pEntry->fAppend )
+            {
+                pHandle->ullOffset = ullOffset + ulLenWrote;
+            }
+
+            if( ( ret != 0 ) && ( pHandle->wbError == 0 ) )
+            {
+                pHandle->wbError = ret;
+            }
+
+            gulWbFirst = ( gulWbFirst + 1U ) % REDCONF_WRITE_BEHIND_ENTRIES;
+            gulWbCount--;
+            gulWbBytes -= pEntry->ulLen;
+
+            if( gulWbCount == 0U )
+            {
+                gulWbNextPos = 0U;
+            }
+        }
+
+
+/** @brief Apply every queued write.
+ *
+ *  The caller must be in the file system driver.
+ */
+        static void WriteBehindFence( void )
+        {
+            while( gulWbCount > 0U )
+            {
+                WriteBehindApply();
+            }
+        }
+
+
+/** @brief Apply the queued writes, for the write-behind task.
+ *
+ *  Each write is applied in a call of its own, so that other tasks can use
+ *  the file system in between.  Errors are recorded in the handles by
+ *  WriteBehindApply().
+ */
+        static void WriteBehindWork( void )
+        {
+            bool fMore = true;
+
+            while( fMore )
+            {
+                fMore = false;
+
+                if( PosixEnterNoFence() == 0 )
+                {
+                    if( gulWbCount > 0U )
+                    {
+                        WriteBehindApply();
+                        fMore = gulWbCount > 0U;
+                    }
+
+                    PosixLeave();
+                }
+            }
+        }
+    #endif /* REDCONF_WRITE_BEHIND_BYTES > 0U */
+
+
+    #if REDCONF_LATENCY_STATS == 1
+
+/** @brief Count the latency of a timed call in its histogram.
+ *
+ *  Called with the FS mutex held, just before the call leaves the driver.
+ *
+ *  @param ulOp     The histogram to count the call in: one of the RED_LATOP_*
+ *                  values.
+ *  @param tsStart  The timestamp taken on entry to the call.
+ */
+        static void LatencyRecord( uint32_t ulOp,
+                                   REDTIMESTAMP tsStart )
+        {
+            uint64_t ullMicrosec = RedOsTimePassed( tsStart );
+            uint32_t ulMicrosec = ( uint32_t ) REDMIN( ullMicrosec, UINT32_MAX );
+            REDLATHIST * pHist = &gLatStats.aOp[ ulOp ];
+            uint32_t ulBucket = 0U;
+
+            while( ( ulBucket < ( RED_LAT_BUCKETS - 1U ) ) && ( ( ulMicrosec >> ulBucket ) != 0U ) )
+            {
+                ulBucket++;
+            }
+
+            pHist->ulCalls++;
+            pHist->ullTotalMicrosec += ullMicrosec;
+            pHist->aulBuckets[ ulBucket ]++;
+
+            if( ulMicrosec > pHist->ulMaxMicrosec )
+            {
+                pHist->ulMaxMicrosec = ulMicrosec;
+            }
+        }
+    #endif /* REDCONF_LATENCY_STATS == 1 */
+
+
 /** @brief Convert an error value into a simple 0 or -1 return.
  *
  *  This function is simple, but what it does is needed in many places.  It
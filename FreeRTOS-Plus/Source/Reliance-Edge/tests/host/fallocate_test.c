@@ -0,0 +1,139 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Host tests of red_fallocate().
+ */
+#include <string.h>
+
+#include <redfs.h>
+#include <redposix.h>
+#include <redvolume.h>
+
+#include "hosttest.h"
+
+
+#define FILE_SIZE    18151U
+
+static uint8_t gabData[ FILE_SIZE ];
+static uint8_t gabRead[ FILE_SIZE + 1U ];
+static char gszPath[ REDCONF_NAME_MAX + 8U ];
+
+
+/** @brief Create the test file, FILE_SIZE bytes of a pattern.
+ */
+static int32_t FileCreate( void )
+{
+    int32_t iFildes;
+    uint32_t ulIdx;
+
+    for( ulIdx = 0U; ulIdx < FILE_SIZE; ulIdx++ )
+    {
+        gabData[ ulIdx ] = ( uint8_t ) ( ( ulIdx * 7U ) + 1U );
+    }
+
+    iFildes = red_open( gszPath, RED_O_RDWR | RED_O_CREAT | RED_O_TRUNC );
+    CHECK( iFildes >= 0 );
+    CHECK( red_write( iFildes, gabData, FILE_SIZE ) == ( int32_t ) FILE_SIZE );
+
+    return iFildes;
+}
+
+
+/** @brief Check that the file still holds the data written by FileCreate(),
+ *         and nothing more.
+ */
+static void FileCheck( int32_t iFildes )
+{
+    REDSTAT st;
+
+    CHECK( red_fstat( iFildes, &st ) == 0 );
+    CHECK( st.st_size == FILE_SIZE );
+    CHECK( red_lseek( iFildes, 0, RED_SEEK_SET ) == 0 );
+    CHECK( red_read( iFildes, gabRead, sizeof( gabRead ) ) == ( int32_t ) FILE_SIZE );
+    CHECK( memcmp( gabRead, gabData, FILE_SIZE ) == 0 );
+}
+
+
+/*  A range which ends inside the block holding the end of the file allocates
+ *  nothing new, and must not shrink the file.
+ */
+static void TestRangeEndsInLastBlock( void )
+{
+    int32_t iFildes = FileCreate();
+
+    CHECK( ( ( 7390U + 10730U ) / REDCONF_BLOCK_SIZE ) == ( FILE_SIZE / REDCONF_BLOCK_SIZE ) );
+    CHECK( red_fallocate( iFildes, 7390, 10730 ) == 0 );
+    FileCheck( iFildes );
+
+    /*  Ending just before the end of the file.
+     */
+    CHECK( red_fallocate( iFildes, 0, FILE_SIZE - 1U ) == 0 );
+    FileCheck( iFildes );
+
+    CHECK( red_close( iFildes ) == 0 );
+}
+
+
+/*  A range which ends past the end of the file grows it to the end of the
+ *  range, keeping the data.
+ */
+static void TestRangeEndsPastEnd( void )
+{
+    int32_t iFildes = FileCreate();
+    REDSTAT st;
+
+    CHECK( red_fallocate( iFildes, 7390, FILE_SIZE ) == 0 );
+    CHECK( red_fstat( iFildes, &st ) == 0 );
+    CHECK( st.st_size == ( 7390U + FILE_SIZE ) );
+    CHECK( red_lseek( iFildes, 0, RED_SEEK_SET ) == 0 );
+    CHECK( red_read( iFildes, gabRead, FILE_SIZE ) == ( int32_t ) FILE_SIZE );
+    CHECK( memcmp( gabRead, gabData, FILE_SIZE ) == 0 );
+
+    CHECK( red_close( iFildes ) == 0 );
+}
+
+
+int main( void )
+{
+    const char * pszVolume = gaRedVolConf[ 0U ].pszPathPrefix;
+
+    ( void ) snprintf( gszPath, sizeof( gszPath ), "%s/file", pszVolume );
+
+    CHECK( red_init() == 0 );
+    CHECK( red_format( pszVolume ) == 0 );
+    CHECK( red_mount( pszVolume ) == 0 );
+
+    TestRangeEndsInLastBlock();
+    TestRangeEndsPastEnd();
+
+    CHECK( red_umount( pszVolume ) == 0 );
+    CHECK( red_uninit() == 0 );
+
+    printf( "%d failed checks\n", giHostFailures );
+
+    return ( giHostFailures == 0 ) ? 0 : 1;
+}
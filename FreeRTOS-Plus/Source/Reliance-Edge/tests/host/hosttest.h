@@ -0,0 +1,56 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Declarations shared by the host tests.
+ */
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+/*  Report a failed check without stopping the test.
+ */
+#define CHECK( x )                                                         \
+    do {                                                                   \
+        if( !( x ) )                                                       \
+        {                                                                  \
+            printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x ); \
+            giHostFailures++;                                              \
+        }                                                                  \
+    } while( 0 )
+
+
+extern int giHostFailures;
+
+void HostDiskSave( void );
+void HostDiskRestore( void );
+uint64_t HostDiskSectorsWritten( void );
+
+
+#endif /* HOSTTEST_H */
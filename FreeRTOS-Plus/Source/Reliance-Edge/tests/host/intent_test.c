@@ -0,0 +1,335 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Host tests of the intent log, with power loss after red_fsync().
+ *
+ *  Each test saves the RAM disk right after a red_fsync(), as a power loss
+ *  would leave it, and mounts the saved image: every file must come back as
+ *  it was when it was last made durable, by its own red_fsync() or by a
+ *  transaction point, whatever was synced or written to the log for other
+ *  files.
+ */
+#include <string.h>
+
+#include <redfs.h>
+#include <redposix.h>
+#include <redvolume.h>
+
+#include "hosttest.h"
+
+
+#define MAX_SIZE    8192U
+
+typedef struct
+{
+    char szPath[ REDCONF_NAME_MAX + 8U ];
+    int32_t iFildes;
+    uint32_t ulSize;           /* Current size of the file. */
+    uint8_t abData[ MAX_SIZE ];
+    uint32_t ulDurableSize;    /* Size of the file when last made durable. */
+    uint8_t abDurable[ MAX_SIZE ];
+} TESTFILE;
+
+static TESTFILE gFileA;
+static TESTFILE gFileB;
+static uint8_t gabRead[ MAX_SIZE + 1U ];
+static const char * gpszVolume;
+static uint32_t gulPattern;
+
+
+/** @brief Open a test file, creating it empty.
+ */
+static void FileOpen( TESTFILE * pFile,
+                      const char * pszName )
+{
+    ( void ) snprintf( pFile->szPath, sizeof( pFile->szPath ), "%s/%s", gpszVolume, pszName );
+    pFile->iFildes = red_open( pFile->szPath, RED_O_RDWR | RED_O_CREAT | RED_O_TRUNC );
+    CHECK( pFile->iFildes >= 0 );
+    pFile->ulSize = 0U;
+    pFile->ulDurableSize = 0U;
+}
+
+
+/** @brief Reopen a test file after a remount.
+ */
+static void FileReopen( TESTFILE * pFile )
+{
+    pFile->iFildes = red_open( pFile->szPath, RED_O_RDWR );
+    CHECK( pFile->iFildes >= 0 );
+}
+
+
+/** @brief Write a new pattern to a range of a test file.
+ */
+static void FileWrite( TESTFILE * pFile,
+                       uint32_t ulOffset,
+                       uint32_t ulLen )
+{
+    uint32_t ulIdx;
+
+    REDASSERT( ( ulOffset <= pFile->ulSize ) && ( ( ulOffset + ulLen ) <= MAX_SIZE ) );
+
+    for( ulIdx = 0U; ulIdx < ulLen; ulIdx++ )
+    {
+        gulPattern = ( gulPattern * 1103515245U ) + 12345U;
+        pFile->abData[ ulOffset + ulIdx ] = ( uint8_t ) ( gulPattern >> 16U );
+    }
+
+    CHECK( red_lseek( pFile->iFildes, ( int64_t ) ulOffset, RED_SEEK_SET ) == ( int64_t ) ulOffset );
+    CHECK( red_write( pFile->iFildes, &pFile->abData[ ulOffset ], ulLen ) == ( int32_t ) ulLen );
+
+    if( ( ulOffset + ulLen ) > pFile->ulSize )
+    {
+        pFile->ulSize = ulOffset + ulLen;
+    }
+}
+
+
+/** @brief Note that a test file is durable as it is now.
+ */
+static void FileDurable( TESTFILE * pFile )
+{
+    pFile->ulDurableSize = pFile->ulSize;
+    memcpy( pFile->abDurable, pFile->abData, pFile->ulSize );
+}
+
+
+/** @brief Make a test file durable with red_fsync().
+ */
+static void FileSync( TESTFILE * pFile )
+{
+    CHECK( red_fsync( pFile->iFildes ) == 0 );
+    FileDurable( pFile );
+}
+
+
+/** @brief Make every test file durable with a transaction point.
+ */
+static void VolumeTransact( void )
+{
+    CHECK( red_transact( gpszVolume ) == 0 );
+    FileDurable( &gFileA );
+    FileDurable( &gFileB );
+}
+
+
+/** @brief Check that a test file holds what it held when last made durable.
+ */
+static void FileCheckDurable( TESTFILE * pFile,
+                              int iLine )
+{
+    int32_t iFildes = red_open( pFile->szPath, RED_O_RDONLY );
+    int32_t iLen = -1;
+
+    if( iFildes >= 0 )
+    {
+        iLen = red_read( iFildes, gabRead, sizeof( gabRead ) );
+        ( void ) red_close( iFildes );
+    }
+
+    if( ( iLen != ( int32_t ) pFile->ulDurableSize ) || ( memcmp( gabRead, pFile->abDurable, pFile->ulDurableSize ) != 0 ) )
+    {
+        printf( "line %d: %s is %d bytes, expected %u\n", iLine, pFile->szPath, ( int ) iLen, ( unsigned ) pFile->ulDurableSize );
+        giHostFailures++;
+    }
+
+    /*  What mount finds is now the durable state.
+     */
+    pFile->ulSize = pFile->ulDurableSize;
+    memcpy( pFile->abData, pFile->abDurable, pFile->ulDurableSize );
+}
+
+
+/** @brief Lose power now: mount the disk as it is, and check both files,
+ *         twice, since the log is replayed again until a transaction point.
+ */
+static void PowerLoss( int iLine )
+{
+    int iMount;
+
+    HostDiskSave();
+
+    /*  Unmounting writes to the disk, but the saved image replaces it.
+     */
+    ( void ) red_close( gFileA.iFildes );
+    ( void ) red_close( gFileB.iFildes );
+    CHECK( red_umount( gpszVolume ) == 0 );
+    HostDiskRestore();
+
+    for( iMount = 0; iMount < 2; iMount++ )
+    {
+        if( iMount > 0 )
+        {
+            HostDiskSave();
+            CHECK( red_umount( gpszVolume ) == 0 );
+            HostDiskRestore();
+        }
+
+        CHECK( red_mount( gpszVolume ) == 0 );
+        FileCheckDurable( &gFileA, iLine );
+        FileCheckDurable( &gFileB, iLine );
+    }
+
+    FileReopen( &gFileA );
+    FileReopen( &gFileB );
+}
+
+
+/** @brief Format and mount the volume, and create both files, committed with
+ *         some data.
+ */
+static void Setup( void )
+{
+    CHECK( red_format( gpszVolume ) == 0 );
+    CHECK( red_mount( gpszVolume ) == 0 );
+    FileOpen( &gFileA, "a" );
+    FileOpen( &gFileB, "b" );
+    FileWrite( &gFileA, 0U, 300U );
+    FileWrite( &gFileB, 0U, 158U );
+    VolumeTransact();
+}
+
+
+static void Teardown( void )
+{
+    ( void ) red_close( gFileA.iFildes );
+    ( void ) red_close( gFileB.iFildes );
+    CHECK( red_umount( gpszVolume ) == 0 );
+}
+
+
+/*  Syncing A writes the log, which also holds the unsynced writes of B; they
+ *  must not be replayed.
+ */
+static void TestOtherFileUnsynced( void )
+{
+    Setup();
+
+    FileWrite( &gFileA, 300U, 200U );
+    FileWrite( &gFileB, 158U, 1327U );
+    FileWrite( &gFileB, 1485U, 113U );
+    FileWrite( &gFileB, 1598U, 5498U );
+    FileSync( &gFileA );
+    PowerLoss( __LINE__ );
+
+    Teardown();
+}
+
+
+/*  Both files synced through the log, then written again without a sync.
+ */
+static void TestBothSynced( void )
+{
+    uint64_t ullWritten;
+
+    Setup();
+
+    FileWrite( &gFileB, 100U, 200U );
+    FileWrite( &gFileA, 0U, 50U );
+    FileSync( &gFileB );
+    FileWrite( &gFileA, 300U, 100U );
+    FileWrite( &gFileB, 300U, 100U );
+
+    /*  Only log sectors are written, not a transaction point.
+     */
+    ullWritten = HostDiskSectorsWritten();
+    FileSync( &gFileA );
+    CHECK( ( HostDiskSectorsWritten() - ullWritten ) <= 2U );
+    FileWrite( &gFileB, 0U, 20U );
+    FileWrite( &gFileA, 0U, 20U );
+    PowerLoss( __LINE__ );
+
+    Teardown();
+}
+
+
+/*  B is synced through the log, changed further, and then dropped from the
+ *  log by a change which cannot be logged: only the synced changes of B may
+ *  be replayed when A is synced.
+ */
+static void TestDroppedFile( void )
+{
+    Setup();
+
+    FileWrite( &gFileB, 158U, 100U );
+    FileSync( &gFileB );
+    FileWrite( &gFileB, 0U, 258U );
+    CHECK( red_fallocate( gFileB.iFildes, 0U, 258U ) == 0 );
+    FileWrite( &gFileB, 258U, 10U );
+    FileWrite( &gFileA, 300U, 10U );
+    FileSync( &gFileA );
+    PowerLoss( __LINE__ );
+
+    Teardown();
+}
+
+
+/*  Records of B which were not replayed stay in the log after the remount;
+ *  they must not be replayed later, when B is changed and synced through the
+ *  log again.
+ */
+static void TestUnsyncedAcrossMount( void )
+{
+    Setup();
+
+    FileWrite( &gFileB, 158U, 1000U );
+    FileWrite( &gFileA, 300U, 10U );
+    FileSync( &gFileA );
+    PowerLoss( __LINE__ );
+
+    FileWrite( &gFileB, 0U, 50U );
+    FileSync( &gFileB );
+    PowerLoss( __LINE__ );
+
+    /*  And once more, with A.
+     */
+    FileWrite( &gFileA, 0U, 10U );
+    FileSync( &gFileA );
+    FileWrite( &gFileB, 0U, 10U );
+    PowerLoss( __LINE__ );
+
+    Teardown();
+}
+
+
+int main( void )
+{
+    gpszVolume = gaRedVolConf[ 0U ].pszPathPrefix;
+
+    CHECK( red_init() == 0 );
+
+    TestOtherFileUnsynced();
+    TestBothSynced();
+    TestDroppedFile();
+    TestUnsyncedAcrossMount();
+
+    CHECK( red_uninit() == 0 );
+
+    printf( "%d failed checks\n", giHostFailures );
+
+    return ( giHostFailures == 0 ) ? 0 : 1;
+}
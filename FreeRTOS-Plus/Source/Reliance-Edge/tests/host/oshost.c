@@ -0,0 +1,215 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements the OS services of the host tests, with a RAM disk.
+ *
+ *  Every write reaches the RAM disk at once, so the disk image at any point is
+ *  what a power loss at that point would leave.  HostDiskSave() keeps a copy
+ *  of it, and HostDiskRestore() puts the copy back, to test what mount finds
+ *  after such a power loss.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <redfs.h>
+#include <redosserv.h>
+#include <redvolume.h>
+
+#include "hosttest.h"
+
+
+#define DISK_SIZE    ( ( size_t ) gaRedVolConf[ 0U ].ullSectorCount * gaRedVolConf[ 0U ].ulSectorSize )
+
+
+int giHostFailures = 0;
+
+static uint8_t * gpbDisk;
+static uint8_t * gpbSaved;
+static uint64_t gullSectorsWritten;
+
+
+/** @brief Keep a copy of the RAM disk, as a power loss now would leave it.
+ */
+void HostDiskSave( void )
+{
+    if( gpbSaved == NULL )
+    {
+        gpbSaved = malloc( DISK_SIZE );
+    }
+
+    memcpy( gpbSaved, gpbDisk, DISK_SIZE );
+}
+
+
+/** @brief Put the copy kept by HostDiskSave() back on the RAM disk.
+ *
+ *  The volume must be unmounted, so that no state from before is cached.
+ */
+void HostDiskRestore( void )
+{
+    memcpy( gpbDisk, gpbSaved, DISK_SIZE );
+}
+
+
+/** @brief Return the number of sectors written to the RAM disk so far.
+ */
+uint64_t HostDiskSectorsWritten( void )
+{
+    return gullSectorsWritten;
+}
+
+
+REDSTATUS RedOsBDevOpen( uint8_t bVolNum,
+                         BDEVOPENMODE mode )
+{
+    ( void ) bVolNum;
+    ( void ) mode;
+
+    if( gpbDisk == NULL )
+    {
+        gpbDisk = calloc( 1U, DISK_SIZE );
+    }
+
+    return ( gpbDisk == NULL ) ? -RED_ENOMEM : 0;
+}
+
+
+REDSTATUS RedOsBDevClose( uint8_t bVolNum )
+{
+    ( void ) bVolNum;
+
+    return 0;
+}
+
+
+REDSTATUS RedOsBDevRead( uint8_t bVolNum,
+                         uint64_t ullSectorStart,
+                         uint32_t ulSectorCount,
+                         void * pBuffer )
+{
+    uint32_t ulSectorSize = gaRedVolConf[ bVolNum ].ulSectorSize;
+
+    REDASSERT( ( ullSectorStart + ulSectorCount ) <= gaRedVolConf[ bVolNum ].ullSectorCount );
+    memcpy( pBuffer, &gpbDisk[ ullSectorStart * ulSectorSize ], ( size_t ) ulSectorCount * ulSectorSize );
+
+    return 0;
+}
+
+
+REDSTATUS RedOsBDevWrite( uint8_t bVolNum,
+                          uint64_t ullSectorStart,
+                          uint32_t ulSectorCount,
+                          const void * pBuffer )
+{
+    uint32_t ulSectorSize = gaRedVolConf[ bVolNum ].ulSectorSize;
+
+    REDASSERT( ( ullSectorStart + ulSectorCount ) <= gaRedVolConf[ bVolNum ].ullSectorCount );
+    memcpy( &gpbDisk[ ullSectorStart * ulSectorSize ], pBuffer, ( size_t ) ulSectorCount * ulSectorSize );
+    gullSectorsWritten += ulSectorCount;
+
+    return 0;
+}
+
+
+REDSTATUS RedOsBDevFlush( uint8_t bVolNum )
+{
+    ( void ) bVolNum;
+
+    return 0;
+}
+
+
+REDSTATUS RedOsBDevConfig( uint8_t bVolNum,
+                           const char * pszDevice )
+{
+    ( void ) bVolNum;
+    ( void ) pszDevice;
+
+    return 0;
+}
+
+
+REDSTATUS RedOsClockInit( void )
+{
+    return 0;
+}
+
+
+REDSTATUS RedOsClockUninit( void )
+{
+    return 0;
+}
+
+
+uint32_t RedOsClockGetTime( void )
+{
+    return ( uint32_t ) time( NULL );
+}
+
+
+REDSTATUS RedOsTimestampInit( void )
+{
+    return 0;
+}
+
+
+REDSTATUS RedOsTimestampUninit( void )
+{
+    return 0;
+}
+
+
+REDTIMESTAMP RedOsTimestamp( void )
+{
+    struct timespec ts;
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return ( REDTIMESTAMP ) ( ( ( uint64_t ) ts.tv_sec * 1000000U ) + ( ( uint64_t ) ts.tv_nsec / 1000U ) );
+}
+
+
+uint64_t RedOsTimePassed( REDTIMESTAMP tsSince )
+{
+    return ( REDTIMESTAMP ) ( RedOsTimestamp() - tsSince );
+}
+
+
+void RedOsOutputString( const char * pszString )
+{
+    ( void ) fputs( pszString, stdout );
+}
+
+
+void RedOsAssertFail( const char * pszFileName,
+                      uint32_t ulLineNum )
+{
+    printf( "assertion failed: %s:%u\n", pszFileName, ( unsigned ) ulLineNum );
+    abort();
+}
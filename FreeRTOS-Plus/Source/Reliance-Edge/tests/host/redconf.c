@@ -0,0 +1,15 @@
+/*  Volume configuration of the host tests: one RAM disk of 2 MB.
+ */
+
+/** @file
+ */
+#include <redconf.h>
+#include <redtypes.h>
+#include <redmacs.h>
+#include <redvolume.h>
+
+
+const VOLCONF gaRedVolConf[ REDCONF_VOLUME_COUNT ] =
+{
+    { 512U, 4096U, false, 256U, 0U, "" }
+};
@@ -0,0 +1,1066 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief File system throughput and latency benchmark.
+ *
+ *  Where fsstress checks that the file system survives a random workload, this
+ *  benchmark measures how fast it handles a fixed one: sequential and random
+ *  reads and writes, small file create/unlink, directory lookups, and
+ *  transaction points.  Each test reports its throughput along with the
+ *  minimum, median, 90th and 99th percentile, and maximum latency of the
+ *  individual operations.
+ *
+ *  Latencies are measured with RedOsTimestamp(), so their resolution is that
+ *  of the port; on FreeRTOS, that is one tick.  Operations which complete in
+ *  less than a tick report as zero, and only the throughput is meaningful.
+ *
+ *  Automatic transactions are disabled while the benchmark runs, so that each
+ *  test measures only the transactions it requests.  The write tests finish
+ *  with a transaction point, which is included in their throughput.
+ */
+#include <redposix.h>
+#include <redtests.h>
+
+#if FSBENCH_SUPPORTED
+
+    #include "redposixcompat.h"
+
+    #include <redosserv.h>
+    #include <redutils.h>
+    #include <redmacs.h>
+    #include <redvolume.h>
+    #include <redgetopt.h>
+    #include <redtoolcmn.h>
+
+
+/*  Largest supported I/O size.
+ */
+    #define FSBENCH_MAX_IO_SIZE    32768U
+
+/*  Operations whose latency is recorded per test.  When a test runs more
+ *  operations than this, every Nth one is sampled.
+ */
+    #define FSBENCH_MAX_SAMPLES    2048U
+
+/*  Tests run when --tests is not specified.
+ */
+    #define FSBENCH_DEFAULT_TESTS    "wrWRclt"
+
+/*  Name of the directory the benchmark runs in, under the volume root.
+ */
+    #define FSBENCH_DIR            "fsbench"
+
+    #define FSBENCH_PATH_MAX       ( REDCONF_NAME_MAX + 64U )
+
+
+    typedef struct
+    {
+        uint32_t ulOps;       /* Operations timed so far. */
+        uint32_t ulStride;    /* Record every ulStride-th operation. */
+        uint32_t ulCount;     /* Latencies recorded in gaulSample. */
+        uint64_t ullTotalUS;  /* Elapsed time of the whole test. */
+        uint64_t ullBytes;    /* Bytes transferred, zero for metadata tests. */
+    } BENCHRESULT;
+
+
+    static uint64_t gaullBuffer[ FSBENCH_MAX_IO_SIZE / sizeof( uint64_t ) ];
+    static uint32_t gaulSample[ FSBENCH_MAX_SAMPLES ];
+    static char gszDir[ FSBENCH_PATH_MAX ];
+    static char gszFile[ FSBENCH_PATH_MAX ];
+
+
+    static void ResultInit( BENCHRESULT * pResult,
+                            uint32_t ulOps );
+    static void ResultSample( BENCHRESULT * pResult,
+                              REDTIMESTAMP ts );
+    static void ResultPrint( const char * pszName,
+                             BENCHRESULT * pResult );
+    static void SortSamples( uint32_t ulCount );
+    static int TestSeqWrite( const FSBENCHPARAM * pParam );
+    static int TestSeqRead( const FSBENCHPARAM * pParam );
+    static int TestRandom( const FSBENCHPARAM * pParam,
+                           bool fWrite );
+    static int TestCreateUnlink( const FSBENCHPARAM * pParam );
+    static int TestLookup( const FSBENCHPARAM * pParam );
+    static int TestTransact( const FSBENCHPARAM * pParam );
+    static int BenchFileCreate( const char * pszVolume,
+                                uint32_t ulSize );
+    static void SmallFileName( char * pszName,
+                               uint32_t ulIdx );
+    static int Fail( const char * pszWhat );
+    static void usage( const char * progname );
+
+
+/** @brief Parse parameters for the file system benchmark.
+ *
+ *  @param argc         The number of arguments from main().
+ *  @param argv         The vector of arguments from main().
+ *  @param pParam       Populated with the benchmark parameters.
+ *  @param pbVolNum     If non-NULL, populated with the volume number.
+ *  @param ppszDevice   If non-NULL, populated with the device name argument or
+ *                      NULL if no device argument is provided.
+ *
+ *  @return The result of parsing the parameters.
+ */
+    PARAMSTATUS FsBenchParseParams( int argc,
+                                    char * argv[],
+                                    FSBENCHPARAM * pParam,
+                                    uint8_t * pbVolNum,
+                                    const char ** ppszDevice )
+    {
+        int c;
+        uint8_t bVolNum;
+        const REDOPTION aLongopts[] =
+        {
+            { "files",     red_required_argument, NULL, 'f' },
+            { "io-size",   red_required_argument, NULL, 'i' },
+            { "lookups",   red_required_argument, NULL, 'l' },
+            { "rand-ops",  red_required_argument, NULL, 'o' },
+            { "seed",      red_required_argument, NULL, 's' },
+            { "tests",     red_required_argument, NULL, 't' },
+            { "transacts", red_required_argument, NULL, 'x' },
+            { "size",      red_required_argument, NULL, 'z' },
+            { "dev",       red_required_argument, NULL, 'D' },
+            { "help",      red_no_argument,       NULL, 'H' },
+            { NULL }
+        };
+
+        /*  If run without parameters, treat as a help request.
+         */
+        if( argc <= 1 )
+        {
+            goto Help;
+        }
+
+        /*  Assume no device argument to start with.
+         */
+        if( ppszDevice != NULL )
+        {
+            *ppszDevice = NULL;
+        }
+
+        /*  Set default parameters.
+         */
+        FsBenchDefaultParams( pParam );
+
+        while( ( c = RedGetoptLong( argc, argv, "f:i:l:o:s:t:x:z:D:H", aLongopts, NULL ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'f': /* --files */
+                    pParam->ulFiles = RedAtoI( red_optarg );
+                    break;
+
+                case 'i': /* --io-size */
+                    pParam->ulIOSize = RedAtoI( red_optarg );
+                    break;
+
+                case 'l': /* --lookups */
+                    pParam->ulLookups = RedAtoI( red_optarg );
+                    break;
+
+                case 'o': /* --rand-ops */
+                    pParam->ulRandomOps = RedAtoI( red_optarg );
+                    break;
+
+                case 's': /* --seed */
+                    pParam->ulSeed = RedAtoI( red_optarg );
+                    break;
+
+                case 't': /* --tests */
+                    pParam->pszTests = red_optarg;
+                    break;
+
+                case 'x': /* --transacts */
+                    pParam->ulTransacts = RedAtoI( red_optarg );
+                    break;
+
+                case 'z': /* --size */
+                    pParam->ulFileSize = RedAtoI( red_optarg );
+                    break;
+
+                case 'D': /* --dev */
+
+                    if( ppszDevice != NULL )
+                    {
+                        *ppszDevice = red_optarg;
+                    }
+
+                    break;
+
+                case 'H': /* --help */
+                    goto Help;
+
+                case '?': /* Unknown or ambiguous option */
+                case ':': /* Option missing required argument */
+                default:
+                    goto BadOpt;
+            }
+        }
+
+        if( ( pParam->ulIOSize == 0U ) || ( pParam->ulIOSize > FSBENCH_MAX_IO_SIZE ) )
+        {
+            RedPrintf( "Error: --io-size must be between 1 and %lu.\n", ( unsigned long ) FSBENCH_MAX_IO_SIZE );
+            goto BadOpt;
+        }
+
+        if( pParam->ulFileSize < pParam->ulIOSize )
+        {
+            RedPrintf( "Error: --size must be at least as large as --io-size.\n" );
+            goto BadOpt;
+        }
+
+        /*  RedGetoptLong() has permuted argv to move all non-option arguments to
+         *  the end.  We expect to find a volume identifier.
+         */
+        if( red_optind >= argc )
+        {
+            RedPrintf( "Missing volume argument\n" );
+            goto BadOpt;
+        }
+
+        bVolNum = RedFindVolumeNumber( argv[ red_optind ] );
+
+        if( bVolNum == REDCONF_VOLUME_COUNT )
+        {
+            RedPrintf( "Error: \"%s\" is not a valid volume identifier.\n", argv[ red_optind ] );
+            goto BadOpt;
+        }
+
+        pParam->pszVolume = gaRedVolConf[ bVolNum ].pszPathPrefix;
+
+        if( pbVolNum != NULL )
+        {
+            *pbVolNum = bVolNum;
+        }
+
+        red_optind++; /* Move past volume parameter. */
+
+        if( red_optind < argc )
+        {
+            int32_t ii;
+
+            for( ii = red_optind; ii < argc; ii++ )
+            {
+                RedPrintf( "Error: Unexpected command-line argument \"%s\".\n", argv[ ii ] );
+            }
+
+            goto BadOpt;
+        }
+
+        return PARAMSTATUS_OK;
+
+BadOpt:
+
+        RedPrintf( "%s - invalid parameters\n", argv[ 0U ] );
+        usage( argv[ 0U ] );
+        return PARAMSTATUS_BAD;
+
+Help:
+
+        usage( argv[ 0U ] );
+        return PARAMSTATUS_HELP;
+    }
+
+
+/** @brief Set default benchmark parameters.
+ *
+ *  @param pParam   Populated with the default benchmark parameters.
+ */
+    void FsBenchDefaultParams( FSBENCHPARAM * pParam )
+    {
+        RedMemSet( pParam, 0U, sizeof( *pParam ) );
+        pParam->pszVolume = gaRedVolConf[ 0U ].pszPathPrefix;
+        pParam->pszTests = FSBENCH_DEFAULT_TESTS;
+        pParam->ulFileSize = 1024U * 1024U;
+        pParam->ulIOSize = 4096U;
+        pParam->ulRandomOps = 1024U;
+        pParam->ulFiles = 100U;
+        pParam->ulLookups = 1000U;
+        pParam->ulTransacts = 100U;
+        pParam->ulSeed = 1U;
+    }
+
+
+/** @brief Run the file system benchmark.
+ *
+ *  The volume must already be mounted.  Everything the benchmark creates is
+ *  removed, and the removal committed, before it returns; the volume's
+ *  transaction mask is then restored.
+ *
+ *  @param pParam   Benchmark parameters, either from FsBenchParseParams() or
+ *                  constructed programatically.
+ *
+ *  @return Zero on success, otherwise nonzero.
+ */
+    int FsBenchStart( const FSBENCHPARAM * pParam )
+    {
+        int iResult = 0;
+        uint32_t ulOrigMask = 0U;
+
+        if( ( pParam == NULL ) ||
+            ( pParam->pszVolume == NULL ) ||
+            ( pParam->pszTests == NULL ) ||
+            ( pParam->ulIOSize == 0U ) ||
+            ( pParam->ulIOSize > FSBENCH_MAX_IO_SIZE ) ||
+            ( pParam->ulFileSize < pParam->ulIOSize ) )
+        {
+            RedPrintf( "fsbench: invalid parameters\n" );
+            iResult = 1;
+        }
+        else if( red_gettransmask( pParam->pszVolume, &ulOrigMask ) != 0 )
+        {
+            iResult = Fail( "red_gettransmask" );
+        }
+        else if( red_settransmask( pParam->pszVolume, RED_TRANSACT_MANUAL ) != 0 )
+        {
+            iResult = Fail( "red_settransmask" );
+        }
+        else
+        {
+            uint32_t ulSeed = ( pParam->ulSeed == 0U ) ? 1U : pParam->ulSeed;
+            uint32_t ulIdx;
+
+            for( ulIdx = 0U; ulIdx < ( FSBENCH_MAX_IO_SIZE / sizeof( uint64_t ) ); ulIdx++ )
+            {
+                gaullBuffer[ ulIdx ] = ( ( uint64_t ) RedRand32( &ulSeed ) << 32U ) | RedRand32( &ulSeed );
+            }
+
+            ( void ) RedSNPrintf( gszDir, sizeof( gszDir ), "%s/" FSBENCH_DIR, pParam->pszVolume );
+            ( void ) RedSNPrintf( gszFile, sizeof( gszFile ), "%s/data", gszDir );
+
+            if( mkdir( gszDir ) != 0 )
+            {
+                iResult = Fail( "mkdir" );
+            }
+            else
+            {
+                const char * pszTest;
+
+                RedPrintf( "fsbench: file size %lu, I/O size %lu\n",
+                           ( unsigned long ) pParam->ulFileSize, ( unsigned long ) pParam->ulIOSize );
+                RedPrintf( "%-12s %8s %10s %9s %8s %8s %8s %8s %8s\n",
+                           "test", "ops", "ops/s", "KB/s", "min", "p50", "p90", "p99", "max(us)" );
+
+                for( pszTest = pParam->pszTests; ( iResult == 0 ) && ( *pszTest != '\0' ); pszTest++ )
+                {
+                    switch( *pszTest )
+                    {
+                        case 'w':
+                            iResult = TestSeqWrite( pParam );
+                            break;
+
+                        case 'r':
+                            iResult = TestSeqRead( pParam );
+                            break;
+
+                        case 'W':
+                            iResult = TestRandom( pParam, true );
+                            break;
+
+                        case 'R':
+                            iResult = TestRandom( pParam, false );
+                            break;
+
+                        case 'c':
+                            iResult = TestCreateUnlink( pParam );
+                            break;
+
+                        case 'l':
+                            iResult = TestLookup( pParam );
+                            break;
+
+                        case 't':
+                            iResult = TestTransact( pParam );
+                            break;
+
+                        default:
+                            RedPrintf( "fsbench: unknown test '%c'\n", *pszTest );
+                            iResult = 1;
+                            break;
+                    }
+                }
+
+                /*  The tests remove their own files, except for the data file,
+                 *  which is shared by the read and write tests.
+                 */
+                ( void ) unlink( gszFile );
+                ( void ) rmdir( gszDir );
+                ( void ) red_transact( pParam->pszVolume );
+            }
+
+            ( void ) red_settransmask( pParam->pszVolume, ulOrigMask );
+        }
+
+        return iResult;
+    }
+
+
+/** @brief Sequentially write the data file, from the beginning, then
+ *         transact.
+ */
+    static int TestSeqWrite( const FSBENCHPARAM * pParam )
+    {
+        BENCHRESULT result;
+        REDTIMESTAMP tsStart = RedOsTimestamp();
+        int iResult = BenchFileCreate( pParam->pszVolume, 0U );
+
+        ResultInit( &result, pParam->ulFileSize / pParam->ulIOSize );
+
+        if( iResult >= 0 )
+        {
+            int fd = iResult;
+            uint32_t ulOp;
+
+            iResult = 0;
+
+            for( ulOp = 0U; ( iResult == 0 ) && ( ulOp < ( pParam->ulFileSize / pParam->ulIOSize ) ); ulOp++ )
+            {
+                REDTIMESTAMP ts = RedOsTimestamp();
+
+                if( write( fd, gaullBuffer, pParam->ulIOSize ) != ( int32_t ) pParam->ulIOSize )
+                {
+                    iResult = Fail( "write" );
+                }
+                else
+                {
+                    ResultSample( &result, ts );
+                    result.ullBytes += pParam->ulIOSize;
+                }
+            }
+
+            if( close( fd ) != 0 )
+            {
+                iResult = Fail( "close" );
+            }
+
+            if( ( iResult == 0 ) && ( red_transact( pParam->pszVolume ) != 0 ) )
+            {
+                iResult = Fail( "red_transact" );
+            }
+
+            if( iResult == 0 )
+            {
+                result.ullTotalUS = RedOsTimePassed( tsStart );
+                ResultPrint( "seq-write", &result );
+            }
+        }
+
+        return iResult;
+    }
+
+
+/** @brief Sequentially read the data file, from the beginning.
+ */
+    static int TestSeqRead( const FSBENCHPARAM * pParam )
+    {
+        int iResult = BenchFileCreate( pParam->pszVolume, pParam->ulFileSize );
+
+        if( iResult >= 0 )
+        {
+            BENCHRESULT result;
+            REDTIMESTAMP tsStart = RedOsTimestamp();
+            int fd = iResult;
+            uint32_t ulOp;
+
+            iResult = 0;
+            ResultInit( &result, pParam->ulFileSize / pParam->ulIOSize );
+
+            for( ulOp = 0U; ( iResult == 0 ) && ( ulOp < ( pParam->ulFileSize / pParam->ulIOSize ) ); ulOp++ )
+            {
+                REDTIMESTAMP ts = RedOsTimestamp();
+
+                if( read( fd, gaullBuffer, pParam->ulIOSize ) != ( int32_t ) pParam->ulIOSize )
+                {
+                    iResult = Fail( "read" );
+                }
+                else
+                {
+                    ResultSample( &result, ts );
+                    result.ullBytes += pParam->ulIOSize;
+                }
+            }
+
+            result.ullTotalUS = RedOsTimePassed( tsStart );
+
+            if( close( fd ) != 0 )
+            {
+                iResult = Fail( "close" );
+            }
+
+            if( iResult == 0 )
+            {
+                ResultPrint( "seq-read", &result );
+            }
+        }
+
+        return iResult;
+    }
+
+
+/** @brief Read or write I/O-size chunks at random aligned offsets within the
+ *         data file.  Writes are followed by a transaction point.
+ */
+    static int TestRandom( const FSBENCHPARAM * pParam,
+                           bool fWrite )
+    {
+        int iResult = BenchFileCreate( pParam->pszVolume, pParam->ulFileSize );
+
+        if( iResult >= 0 )
+        {
+            BENCHRESULT result;
+            REDTIMESTAMP tsStart = RedOsTimestamp();
+            uint32_t ulSeed = pParam->ulSeed;
+            uint32_t ulChunks = pParam->ulFileSize / pParam->ulIOSize;
+            int fd = iResult;
+            uint32_t ulOp;
+
+            iResult = 0;
+            ResultInit( &result, pParam->ulRandomOps );
+
+            for( ulOp = 0U; ( iResult == 0 ) && ( ulOp < pParam->ulRandomOps ); ulOp++ )
+            {
+                int64_t llOffset = ( int64_t ) ( RedRand32( &ulSeed ) % ulChunks ) * pParam->ulIOSize;
+                REDTIMESTAMP ts = RedOsTimestamp();
+                int32_t len;
+
+                if( lseek( fd, llOffset, SEEK_SET ) != llOffset )
+                {
+                    iResult = Fail( "lseek" );
+                }
+                else
+                {
+                    if( fWrite )
+                    {
+                        len = write( fd, gaullBuffer, pParam->ulIOSize );
+                    }
+                    else
+                    {
+                        len = read( fd, gaullBuffer, pParam->ulIOSize );
+                    }
+
+                    if( len != ( int32_t ) pParam->ulIOSize )
+                    {
+                        iResult = Fail( fWrite ? "write" : "read" );
+                    }
+                    else
+                    {
+                        ResultSample( &result, ts );
+                        result.ullBytes += pParam->ulIOSize;
+                    }
+                }
+            }
+
+            if( close( fd ) != 0 )
+            {
+                iResult = Fail( "close" );
+            }
+
+            if( ( iResult == 0 ) && fWrite && ( red_transact( pParam->pszVolume ) != 0 ) )
+            {
+                iResult = Fail( "red_transact" );
+            }
+
+            if( iResult == 0 )
+            {
+                result.ullTotalUS = RedOsTimePassed( tsStart );
+                ResultPrint( fWrite ? "rand-write" : "rand-read", &result );
+            }
+        }
+
+        return iResult;
+    }
+
+
+/** @brief Create, then unlink, a set of small files.  Both phases are timed
+ *         and reported separately.
+ */
+    static int TestCreateUnlink( const FSBENCHPARAM * pParam )
+    {
+        BENCHRESULT result;
+        REDTIMESTAMP tsStart = RedOsTimestamp();
+        int iResult = 0;
+        uint32_t ulCreated = 0U;
+        uint32_t ulIdx;
+
+        ResultInit( &result, pParam->ulFiles );
+
+        for( ulIdx = 0U; ( iResult == 0 ) && ( ulIdx < pParam->ulFiles ); ulIdx++ )
+        {
+            REDTIMESTAMP ts = RedOsTimestamp();
+            int fd;
+
+            SmallFileName( gszFile, ulIdx );
+            fd = open( gszFile, O_WRONLY | O_CREAT | O_EXCL );
+
+            if( fd < 0 )
+            {
+                iResult = Fail( "open" );
+            }
+            else
+            {
+                ulCreated++;
+
+                if( write( fd, gaullBuffer, 512U ) != 512 )
+                {
+                    iResult = Fail( "write" );
+                }
+
+                if( close( fd ) != 0 )
+                {
+                    iResult = Fail( "close" );
+                }
+
+                ResultSample( &result, ts );
+            }
+        }
+
+        if( ( iResult == 0 ) && ( red_transact( pParam->pszVolume ) != 0 ) )
+        {
+            iResult = Fail( "red_transact" );
+        }
+
+        if( iResult == 0 )
+        {
+            result.ullTotalUS = RedOsTimePassed( tsStart );
+            ResultPrint( "create", &result );
+            ResultInit( &result, ulCreated );
+            tsStart = RedOsTimestamp();
+        }
+
+        /*  Unlink whatever was created, even after a failure, so that the
+         *  directory can be removed.
+         */
+        for( ulIdx = 0U; ulIdx < ulCreated; ulIdx++ )
+        {
+            REDTIMESTAMP ts = RedOsTimestamp();
+
+            SmallFileName( gszFile, ulIdx );
+
+            if( unlink( gszFile ) != 0 )
+            {
+                iResult = ( iResult == 0 ) ? Fail( "unlink" ) : iResult;
+            }
+            else
+            {
+                ResultSample( &result, ts );
+            }
+        }
+
+        if( ( iResult == 0 ) && ( red_transact( pParam->pszVolume ) != 0 ) )
+        {
+            iResult = Fail( "red_transact" );
+        }
+
+        if( iResult == 0 )
+        {
+            result.ullTotalUS = RedOsTimePassed( tsStart );
+            ResultPrint( "unlink", &result );
+        }
+
+        ( void ) RedSNPrintf( gszFile, sizeof( gszFile ), "%s/data", gszDir );
+
+        return iResult;
+    }
+
+
+/** @brief Populate the directory with empty files, then time opening and
+ *         closing them in random order.
+ */
+    static int TestLookup( const FSBENCHPARAM * pParam )
+    {
+        int iResult = 0;
+        uint32_t ulCreated = 0U;
+        uint32_t ulIdx;
+
+        for( ulIdx = 0U; ( iResult == 0 ) && ( ulIdx < pParam->ulFiles ); ulIdx++ )
+        {
+            int fd;
+
+            SmallFileName( gszFile, ulIdx );
+            fd = open( gszFile, O_WRONLY | O_CREAT | O_EXCL );
+
+            if( fd < 0 )
+            {
+                iResult = Fail( "open" );
+            }
+            else
+            {
+                ulCreated++;
+
+                if( close( fd ) != 0 )
+                {
+                    iResult = Fail( "close" );
+                }
+            }
+        }
+
+        if( ( iResult == 0 ) && ( ulCreated > 0U ) )
+        {
+            BENCHRESULT result;
+            REDTIMESTAMP tsStart;
+            uint32_t ulSeed = pParam->ulSeed;
+
+            if( red_transact( pParam->pszVolume ) != 0 )
+            {
+                iResult = Fail( "red_transact" );
+            }
+
+            ResultInit( &result, pParam->ulLookups );
+            tsStart = RedOsTimestamp();
+
+            for( ulIdx = 0U; ( iResult == 0 ) && ( ulIdx < pParam->ulLookups ); ulIdx++ )
+            {
+                REDTIMESTAMP ts;
+                int fd;
+
+                /*  Format the name before starting the clock.
+                 */
+                SmallFileName( gszFile, RedRand32( &ulSeed ) % ulCreated );
+                ts = RedOsTimestamp();
+                fd = open( gszFile, O_RDONLY );
+
+                if( fd < 0 )
+                {
+                    iResult = Fail( "open" );
+                }
+                else if( close( fd ) != 0 )
+                {
+                    iResult = Fail( "close" );
+                }
+                else
+                {
+                    ResultSample( &result, ts );
+                }
+            }
+
+            if( iResult == 0 )
+            {
+                result.ullTotalUS = RedOsTimePassed( tsStart );
+                ResultPrint( "lookup", &result );
+            }
+        }
+
+        for( ulIdx = 0U; ulIdx < ulCreated; ulIdx++ )
+        {
+            SmallFileName( gszFile, ulIdx );
+
+            if( ( unlink( gszFile ) != 0 ) && ( iResult == 0 ) )
+            {
+                iResult = Fail( "unlink" );
+            }
+        }
+
+        ( void ) RedSNPrintf( gszFile, sizeof( gszFile ), "%s/data", gszDir );
+
+        return iResult;
+    }
+
+
+/** @brief Time transaction points, each one committing a single I/O-size
+ *         write to the data file.  Only the red_transact() call is timed.
+ */
+    static int TestTransact( const FSBENCHPARAM * pParam )
+    {
+        int iResult = BenchFileCreate( pParam->pszVolume, pParam->ulFileSize );
+
+        if( iResult >= 0 )
+        {
+            BENCHRESULT result;
+            uint32_t ulSeed = pParam->ulSeed;
+            uint32_t ulChunks = pParam->ulFileSize / pParam->ulIOSize;
+            int fd = iResult;
+            uint32_t ulOp;
+
+            iResult = 0;
+            ResultInit( &result, pParam->ulTransacts );
+
+            for( ulOp = 0U; ( iResult == 0 ) && ( ulOp < pParam->ulTransacts ); ulOp++ )
+            {
+                int64_t llOffset = ( int64_t ) ( RedRand32( &ulSeed ) % ulChunks ) * pParam->ulIOSize;
+
+                if( lseek( fd, llOffset, SEEK_SET ) != llOffset )
+                {
+                    iResult = Fail( "lseek" );
+                }
+                else if( write( fd, gaullBuffer, pParam->ulIOSize ) != ( int32_t ) pParam->ulIOSize )
+                {
+                    iResult = Fail( "write" );
+                }
+                else
+                {
+                    REDTIMESTAMP ts = RedOsTimestamp();
+
+                    if( red_transact( pParam->pszVolume ) != 0 )
+                    {
+                        iResult = Fail( "red_transact" );
+                    }
+                    else
+                    {
+                        /*  Sum only the transaction time, so the throughput
+                         *  figure is transactions per second.
+                         */
+                        result.ullTotalUS += RedOsTimePassed( ts );
+                        ResultSample( &result, ts );
+                    }
+                }
+            }
+
+            if( close( fd ) != 0 )
+            {
+                iResult = Fail( "close" );
+            }
+
+            if( iResult == 0 )
+            {
+                ResultPrint( "transact", &result );
+            }
+        }
+
+        return iResult;
+    }
+
+
+/** @brief Open the data file for reading and writing, first making sure it
+ *         holds at least @p ulSize bytes.
+ *
+ *  @param pszVolume    Volume containing the file, to transact once it has
+ *                      been filled.
+ *  @param ulSize       Minimum size of the file.  Zero truncates the file.
+ *
+ *  @return A file descriptor positioned at the start of the file, or -1.
+ */
+    static int BenchFileCreate( const char * pszVolume,
+                                uint32_t ulSize )
+    {
+        int fd = open( gszFile, O_RDWR | O_CREAT | ( ( ulSize == 0U ) ? O_TRUNC : 0U ) );
+
+        if( fd < 0 )
+        {
+            ( void ) Fail( "open" );
+        }
+        else if( ulSize > 0U )
+        {
+            int64_t llEnd = lseek( fd, 0, SEEK_END );
+
+            while( ( fd >= 0 ) && ( llEnd >= 0 ) && ( ( uint64_t ) llEnd < ulSize ) )
+            {
+                uint32_t ulLen = REDMIN( ( uint32_t ) sizeof( gaullBuffer ), ulSize - ( uint32_t ) llEnd );
+
+                if( write( fd, gaullBuffer, ulLen ) != ( int32_t ) ulLen )
+                {
+                    llEnd = -1;
+                }
+                else
+                {
+                    llEnd += ulLen;
+                }
+            }
+
+            if( ( llEnd < 0 ) || ( red_transact( pszVolume ) != 0 ) ||
+                ( lseek( fd, 0, SEEK_SET ) != 0 ) )
+            {
+                ( void ) Fail( "preparing data file" );
+                ( void ) close( fd );
+                fd = -1;
+            }
+        }
+        else
+        {
+            /*  Nothing more to do for an empty file.
+             */
+        }
+
+        return fd;
+    }
+
+
+/** @brief Format the name of one of the small files.
+ */
+    static void SmallFileName( char * pszName,
+                               uint32_t ulIdx )
+    {
+        ( void ) RedSNPrintf( pszName, FSBENCH_PATH_MAX, "%s/f%lu", gszDir, ( unsigned long ) ulIdx );
+    }
+
+
+/** @brief Report a failed operation.
+ *
+ *  @return Nonzero, for the caller's result.
+ */
+    static int Fail( const char * pszWhat )
+    {
+        RedPrintf( "fsbench: %s failed, errno %d\n", pszWhat, ( int ) red_errno );
+        return 1;
+    }
+
+
+/** @brief Prepare to time a test.
+ *
+ *  @param pResult  The result to initialize.
+ *  @param ulOps    Number of operations the test expects to time, which
+ *                  determines how often latencies are sampled.
+ */
+    static void ResultInit( BENCHRESULT * pResult,
+                            uint32_t ulOps )
+    {
+        RedMemSet( pResult, 0U, sizeof( *pResult ) );
+        pResult->ulStride = ( ulOps + ( FSBENCH_MAX_SAMPLES - 1U ) ) / FSBENCH_MAX_SAMPLES;
+
+        if( pResult->ulStride == 0U )
+        {
+            pResult->ulStride = 1U;
+        }
+    }
+
+
+/** @brief Count one operation, recording its latency if it is sampled.
+ *
+ *  @param pResult  The result to update.
+ *  @param ts       When the operation started.
+ */
+    static void ResultSample( BENCHRESULT * pResult,
+                              REDTIMESTAMP ts )
+    {
+        uint64_t ullUS = RedOsTimePassed( ts );
+
+        if( ( ( pResult->ulOps % pResult->ulStride ) == 0U ) && ( pResult->ulCount < FSBENCH_MAX_SAMPLES ) )
+        {
+            gaulSample[ pResult->ulCount ] = ( ullUS > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ullUS;
+            pResult->ulCount++;
+        }
+
+        pResult->ulOps++;
+    }
+
+
+/** @brief Print the throughput and latency distribution of a test.
+ *
+ *  @param pszName  Name of the test.
+ *  @param pResult  The result of the test.
+ */
+    static void ResultPrint( const char * pszName,
+                             BENCHRESULT * pResult )
+    {
+        uint64_t ullUS = ( pResult->ullTotalUS == 0U ) ? 1U : pResult->ullTotalUS;
+        uint32_t ulLast = ( pResult->ulCount == 0U ) ? 0U : pResult->ulCount - 1U;
+
+        if( pResult->ulCount == 0U )
+        {
+            gaulSample[ 0U ] = 0U;
+        }
+
+        SortSamples( pResult->ulCount );
+
+        RedPrintf( "%-12s %8lu %10lu %9lu %8lu %8lu %8lu %8lu %8lu\n", pszName,
+                   ( unsigned long ) pResult->ulOps,
+                   ( unsigned long ) RedMulDiv64( pResult->ulOps, 1000000U, ullUS ),
+                   ( unsigned long ) RedMulDiv64( pResult->ullBytes, 1000000U, ullUS * 1024U ),
+                   ( unsigned long ) gaulSample[ 0U ],
+                   ( unsigned long ) gaulSample[ ( ulLast * 50U ) / 100U ],
+                   ( unsigned long ) gaulSample[ ( ulLast * 90U ) / 100U ],
+                   ( unsigned long ) gaulSample[ ( ulLast * 99U ) / 100U ],
+                   ( unsigned long ) gaulSample[ ulLast ] );
+    }
+
+
+/** @brief Sort the recorded latencies in ascending order.
+ *
+ *  A Shell sort, which is short, needs no extra memory, and is plenty fast
+ *  for the number of samples kept.
+ *
+ *  @param ulCount  Number of samples in gaulSample.
+ */
+    static void SortSamples( uint32_t ulCount )
+    {
+        uint32_t ulGap;
+
+        for( ulGap = ulCount / 2U; ulGap > 0U; ulGap /= 2U )
+        {
+            uint32_t ulIdx;
+
+            for( ulIdx = ulGap; ulIdx < ulCount; ulIdx++ )
+            {
+                uint32_t ulVal = gaulSample[ ulIdx ];
+                uint32_t ulPos = ulIdx;
+
+                while( ( ulPos >= ulGap ) && ( gaulSample[ ulPos - ulGap ] > ulVal ) )
+                {
+                    gaulSample[ ulPos ] = gaulSample[ ulPos - ulGap ];
+                    ulPos -= ulGap;
+                }
+
+                gaulSample[ ulPos ] = ulVal;
+            }
+        }
+    }
+
+
+    static void usage( const char * progname )
+    {
+        RedPrintf( "usage: %s VolumeID [Options]\n", progname );
+        RedPrintf( "File system throughput and latency benchmark.\n\n" );
+        RedPrintf( "Where:\n" );
+        RedPrintf( "  VolumeID\n" );
+        RedPrintf( "      A volume number (e.g., 2) or a volume path prefix (e.g., VOL1: or /data)\n" );
+        RedPrintf( "      of the volume to test.\n" );
+        RedPrintf( "And 'Options' are any of the following:\n" );
+        RedPrintf( "  --tests=letters, -t letters\n" );
+        RedPrintf( "      Specifies which tests to run, in order (default \"%s\"):\n", FSBENCH_DEFAULT_TESTS );
+        RedPrintf( "        w  sequential write       r  sequential read\n" );
+        RedPrintf( "        W  random write           R  random read\n" );
+        RedPrintf( "        c  small file create and unlink\n" );
+        RedPrintf( "        l  directory lookup       t  transaction point latency\n" );
+        RedPrintf( "  --size=bytes, -z bytes\n" );
+        RedPrintf( "      Specifies the size of the data file (default 1048576).\n" );
+        RedPrintf( "  --io-size=bytes, -i bytes\n" );
+        RedPrintf( "      Specifies the size of each read or write (default 4096, maximum %lu).\n",
+                   ( unsigned long ) FSBENCH_MAX_IO_SIZE );
+        RedPrintf( "  --rand-ops=count, -o count\n" );
+        RedPrintf( "      Specifies the number of random reads or writes (default 1024).\n" );
+        RedPrintf( "  --files=count, -f count\n" );
+        RedPrintf( "      Specifies the number of files for the create and lookup tests\n" );
+        RedPrintf( "      (default 100).\n" );
+        RedPrintf( "  --lookups=count, -l count\n" );
+        RedPrintf( "      Specifies the number of lookups (default 1000).\n" );
+        RedPrintf( "  --transacts=count, -x count\n" );
+        RedPrintf( "      Specifies the number of timed transaction points (default 100).\n" );
+        RedPrintf( "  --seed=value, -s value\n" );
+        RedPrintf( "      Specifies the seed for the random offsets and names (default 1).\n" );
+        RedPrintf( "  --dev=devname, -D devname\n" );
+        RedPrintf( "      Specifies the device name.  This is typically only meaningful when\n" );
+        RedPrintf( "      running the test on a host machine.  This can be \"ram\" to test on a RAM\n" );
+        RedPrintf( "      disk, the path and name of a file disk (e.g., red.bin); or an OS-specific\n" );
+        RedPrintf( "      reference to a device (on Windows, a drive letter like G: or a device name\n" );
+        RedPrintf( "      like \\\\.\\PhysicalDrive7).\n" );
+        RedPrintf( "  --help, -H\n" );
+        RedPrintf( "      Prints this usage text and exits.\n\n" );
+        RedPrintf( "The volume must be mounted.  Latencies are in microseconds, at the resolution\n" );
+        RedPrintf( "of the OS timestamp.\n\n" );
+    }
+
+#endif /* FSBENCH_SUPPORTED */
@@ -35,6 +35,12 @@
  *
  *  This version of SGI fsstress has been modified to be single-threaded and to
  *  work with the Reliance Edge POSIX-like API.
+ *
+ *  With --tasks, a separate multi-task mode runs instead: several tasks run a
+ *  simpler mix of operations at once, on files in a directory of their own
+ *  and in a directory they share, and the throughput and lock wait times are
+ *  reported as the number of tasks grows.  The SGI code keeps its state in
+ *  globals, so it only ever runs in the task which called FsstressStart().
  */
 #include <stdio.h>
 #include <stdlib.h>
@@ -654,6 +660,9 @@
                                 off64_t length );
     static int unlink_path( pathname_t * name );
     static void usage( const char * progname );
+    #if REDCONF_TASK_COUNT > 1U
+        static int MultiTaskStart( const FSSTRESSPARAM * pParam );
+    #endif
 
 
 /** @brief Parse parameters for fsstress.
@@ -682,6 +691,8 @@
             { "nops",       red_required_argument, NULL, 'n' },
             { "namepad",    red_no_argument,       NULL, 'r' },
             { "seed",       red_required_argument, NULL, 's' },
+            { "tasks",      red_required_argument, NULL, 't' },
+            { "shared",     red_required_argument, NULL, 'S' },
             { "verbose",    red_no_argument,       NULL, 'v' },
             { "dev",        red_required_argument, NULL, 'D' },
             { "help",       red_no_argument,       NULL, 'H' },
@@ -706,7 +717,7 @@
          */
         FsstressDefaultParams( pParam );
 
-        while( ( c = RedGetoptLong( argc, argv, "cl:n:rs:vD:H", aLongopts, NULL ) ) != -1 )
+        while( ( c = RedGetoptLong( argc, argv, "cl:n:rs:t:S:vD:H", aLongopts, NULL ) ) != -1 )
         {
             switch( c )
             {
@@ -730,6 +741,21 @@
                     pParam->ulSeed = RedAtoI( red_optarg );
                     break;
 
+                case 't': /* --tasks */
+                    pParam->ulTasks = RedAtoI( red_optarg );
+                    break;
+
+                case 'S': /* --shared */
+                    pParam->ulSharedPct = RedAtoI( red_optarg );
+
+                    if( pParam->ulSharedPct > 100U )
+                    {
+                        RedPrintf( "Error: --shared must be a percentage.\n" );
+                        goto BadOpt;
+                    }
+
+                    break;
+
                 case 'v': /* --verbose */
                     pParam->fVerbose = true;
                     break;
@@ -813,6 +839,8 @@ Help:
         RedMemSet( pParam, 0U, sizeof( *pParam ) );
         pParam->ulLoops = 1U;
         pParam->ulNops = 10000U;
+        pParam->ulTasks = 1U;
+        pParam->ulSharedPct = 50U;
     }
 
 
@@ -832,6 +860,16 @@ Help:
         int loops;
         int loopcntr = 1;
 
+        if( pParam->ulTasks > 1U )
+        {
+            #if REDCONF_TASK_COUNT > 1U
+                return MultiTaskStart( pParam );
+            #else
+                RedPrintf( "Error: --tasks requires REDCONF_TASK_COUNT > 1.\n" );
+                return 1;
+            #endif
+        }
+
         nops = sizeof( ops ) / sizeof( ops[ 0 ] );
         ops_end = &ops[ nops ];
 
@@ -1850,6 +1888,15 @@ Help:
         RedPrintf( "      Specifies to use random name padding (resulting in longer names).\n" );
         RedPrintf( "  --seed=value, -s value\n" );
         RedPrintf( "      Specifies the seed for the random number generator (default timestamp).\n" );
+        RedPrintf( "  --tasks=count, -t count\n" );
+        RedPrintf( "      Specifies the most tasks to run at once.  With more than one, runs the\n" );
+        RedPrintf( "      multi-task mode: the operations are run with 1, 2, 4, ... tasks up to\n" );
+        RedPrintf( "      count, and the operations per second and the lock wait times are\n" );
+        RedPrintf( "      reported for each.  --nops is per task.  Default 1.\n" );
+        RedPrintf( "  --shared=percent, -S percent\n" );
+        RedPrintf( "      In the multi-task mode, the percentage of operations on files in the\n" );
+        RedPrintf( "      directory shared by all tasks; the rest use a directory per task.\n" );
+        RedPrintf( "      Default 50.\n" );
         RedPrintf( "  --verbose, -v\n" );
         RedPrintf( "      Specifies verbose mode (without this, test is very quiet).\n" );
         RedPrintf( "  --dev=devname, -D devname\n" );
@@ -2644,4 +2691,429 @@ Help:
     #endif /* if REDCONF_CHECKER == 1 */
 
 
+    #if REDCONF_TASK_COUNT > 1U
+
+/*-------------------------------------------------------------------
+ *   Multi-task mode
+ *  -------------------------------------------------------------------*/
+
+/*  Directory the multi-task mode runs in, under the volume root; and the
+ *  names of the shared directory and of the per-task directories in it.
+ */
+        #define MT_DIR             "fsstress.mt"
+        #define MT_SHARED_DIR      "shared"
+        #define MT_PRIVATE_DIR     "t%u"
+
+/*  Files per directory, largest I/O, and the offset below which writes start,
+ *  which bounds the size of the files.
+ */
+        #define MT_FILES           16U
+        #define MT_IO_SIZE         2048U
+        #define MT_MAX_OFFSET      65536U
+
+        #define MT_PATH_MAX        ( 128U + REDCONF_NAME_MAX )
+
+        typedef enum
+        {
+            MTOP_WRITE,
+            MTOP_READ,
+            MTOP_STAT,
+            MTOP_TRUNCATE,
+            MTOP_UNLINK,
+            MTOP_RENAME,
+            MTOP_READDIR,
+            MTOP_FSYNC,
+            MTOP_COUNT
+        } MTOP;
+
+        typedef struct
+        {
+            uint32_t ulSeed;                 /* Random number generator state. */
+            uint32_t ulOps;                  /* Operations run, including those which failed as expected. */
+            uint32_t ulErrors;               /* Operations which failed unexpectedly. */
+            REDSTATUS firstError;            /* The error of the first such operation. */
+            char szPath[ MT_PATH_MAX ];      /* Path of the file of the current operation. */
+            char szPath2[ MT_PATH_MAX ];     /* Second path of the current operation. */
+            uint8_t abBuffer[ MT_IO_SIZE ];  /* Data buffer. */
+        } MTWORKER;
+
+        static void MultiTaskWork( uint32_t ulIndex );
+        static REDSTATUS MultiTaskOp( MTWORKER * pWorker,
+                                      uint32_t ulIndex );
+        static void MultiTaskPath( char * pszPath,
+                                   uint32_t ulIndex,
+                                   bool fShared,
+                                   uint32_t ulFile );
+
+        static MTWORKER gaMtWorker[ REDCONF_TASK_COUNT ];
+        static const char * gpszMtVolume;
+        static uint32_t gulMtNops;
+        static uint32_t gulMtSharedPct;
+
+
+/** @brief Run the multi-task mode.
+ *
+ *  @param pParam   fsstress parameters.
+ *
+ *  @return Zero on success, otherwise nonzero.
+ */
+        static int MultiTaskStart( const FSSTRESSPARAM * pParam )
+        {
+            char szPath[ MT_PATH_MAX ];
+            uint32_t ulSeed = pParam->ulSeed;
+            uint32_t ulLoop;
+            uint32_t ulTask;
+            int iResult = 0;
+
+            /*  The calling task holds a task slot of its own.
+             */
+            if( pParam->ulTasks > ( REDCONF_TASK_COUNT - 1U ) )
+            {
+                RedPrintf( "Error: --tasks can be at most %u, one less than REDCONF_TASK_COUNT.\n",
+                           ( unsigned ) ( REDCONF_TASK_COUNT - 1U ) );
+                return 1;
+            }
+
+            if( ulSeed == 0U )
+            {
+                ulSeed = RedOsClockGetTime();
+                RedPrintf( "seed = %lu\n", ( unsigned long ) ulSeed );
+            }
+
+            gpszMtVolume = gpRedVolConf->pszPathPrefix;
+            gulMtNops = pParam->ulNops;
+            gulMtSharedPct = pParam->ulSharedPct;
+
+            ( void ) RedSNPrintf( szPath, sizeof( szPath ), "%s/" MT_DIR, gpszMtVolume );
+            ( void ) red_mkdir( szPath );
+            ( void ) RedSNPrintf( szPath, sizeof( szPath ), "%s/" MT_DIR "/" MT_SHARED_DIR, gpszMtVolume );
+            ( void ) red_mkdir( szPath );
+
+            for( ulTask = 0U; ulTask < pParam->ulTasks; ulTask++ )
+            {
+                ( void ) RedSNPrintf( szPath, sizeof( szPath ), "%s/" MT_DIR "/" MT_PRIVATE_DIR, gpszMtVolume, ( unsigned ) ulTask );
+                ( void ) red_mkdir( szPath );
+            }
+
+            RedPrintf( "tasks        ops    msec    ops/sec  enter waits  wait msec  vol waits  wait msec\n" );
+
+            for( ulLoop = 0U; ( ulLoop < pParam->ulLoops ) || ( pParam->ulLoops == 0U ); ulLoop++ )
+            {
+                uint32_t ulTasks = 1U;
+
+                while( ( iResult == 0 ) && ( ulTasks <= pParam->ulTasks ) )
+                {
+                    REDTIMESTAMP tsStart;
+                    uint32_t ulMsec;
+                    uint32_t ulOps = 0U;
+                    uint32_t ulErrors = 0U;
+                    REDSTATUS ret;
+
+                    #if REDCONF_STATS == 1
+                        REDLOCKSTATS lockStats;
+                    #endif
+
+                    for( ulTask = 0U; ulTask < ulTasks; ulTask++ )
+                    {
+                        gaMtWorker[ ulTask ].ulSeed = ulSeed + ( ulLoop * 1000U ) + ( ulTasks * 100U ) + ulTask;
+                        gaMtWorker[ ulTask ].ulOps = 0U;
+                        gaMtWorker[ ulTask ].ulErrors = 0U;
+                        gaMtWorker[ ulTask ].firstError = 0;
+                    }
+
+                    #if REDCONF_STATS == 1
+                        ( void ) red_lockstats( &lockStats, true );
+                    #endif
+
+                    tsStart = RedOsTimestamp();
+                    ret = RedOsWorkerTasksRun( ulTasks, MultiTaskWork );
+                    ulMsec = ( uint32_t ) ( RedOsTimePassed( tsStart ) / 1000U );
+
+                    #if REDCONF_STATS == 1
+                        ( void ) red_lockstats( &lockStats, false );
+                    #endif
+
+                    if( ret != 0 )
+                    {
+                        RedPrintf( "Error: unable to start %u tasks: %d\n", ( unsigned ) ulTasks, ( int ) -ret );
+                        iResult = 1;
+                        break;
+                    }
+
+                    for( ulTask = 0U; ulTask < ulTasks; ulTask++ )
+                    {
+                        ulOps += gaMtWorker[ ulTask ].ulOps;
+                        ulErrors += gaMtWorker[ ulTask ].ulErrors;
+
+                        if( gaMtWorker[ ulTask ].ulErrors > 0U )
+                        {
+                            RedPrintf( "Task %u: %u unexpected errors, the first was %d\n", ( unsigned ) ulTask,
+                                       ( unsigned ) gaMtWorker[ ulTask ].ulErrors, ( int ) gaMtWorker[ ulTask ].firstError );
+                        }
+                    }
+
+                    #if REDCONF_STATS == 1
+                        RedPrintf( "%5u %10u %7u %10u %12u %10u %10u %10u\n", ( unsigned ) ulTasks, ( unsigned ) ulOps, ( unsigned ) ulMsec,
+                                   ( unsigned ) ( ( ( uint64_t ) ulOps * 1000U ) / ( ( ulMsec == 0U ) ? 1U : ulMsec ) ),
+                                   ( unsigned ) lockStats.ulEnterWaits, ( unsigned ) ( lockStats.ullEnterWaitMicrosec / 1000U ),
+                                   ( unsigned ) lockStats.ulVolWaits, ( unsigned ) ( lockStats.ullVolWaitMicrosec / 1000U ) );
+                    #else
+                        RedPrintf( "%5u %10u %7u %10u %12s %10s %10s %10s\n", ( unsigned ) ulTasks, ( unsigned ) ulOps, ( unsigned ) ulMsec,
+                                   ( unsigned ) ( ( ( uint64_t ) ulOps * 1000U ) / ( ( ulMsec == 0U ) ? 1U : ulMsec ) ), "-", "-", "-", "-" );
+                    #endif
+
+                    if( ulErrors > 0U )
+                    {
+                        iResult = 1;
+                    }
+
+                    /*  Double the tasks each round, finishing with the most
+                     *  tasks requested.
+                     */
+                    if( ulTasks == pParam->ulTasks )
+                    {
+                        break;
+                    }
+
+                    ulTasks = REDMIN( ulTasks * 2U, pParam->ulTasks );
+                }
+
+                if( iResult != 0 )
+                {
+                    break;
+                }
+            }
+
+            if( !pParam->fNoCleanup )
+            {
+                uint32_t ulFile;
+
+                /*  The tasks only ever use the names from MultiTaskPath(), so
+                 *  those are all there is to remove.
+                 */
+                for( ulTask = 0U; ulTask <= pParam->ulTasks; ulTask++ )
+                {
+                    bool fShared = ( ulTask == pParam->ulTasks );
+
+                    for( ulFile = 0U; ulFile < MT_FILES; ulFile++ )
+                    {
+                        MultiTaskPath( szPath, ulTask, fShared, ulFile );
+                        ( void ) red_unlink( szPath );
+                    }
+
+                    *strrchr( szPath, '/' ) = '\0';
+                    ( void ) red_rmdir( szPath );
+                }
+
+                ( void ) RedSNPrintf( szPath, sizeof( szPath ), "%s/" MT_DIR, gpszMtVolume );
+                ( void ) red_rmdir( szPath );
+            }
+
+            return iResult;
+        }
+
+
+/** @brief Body of each task of the multi-task mode.
+ *
+ *  @param ulIndex  The index of the task.
+ */
+        static void MultiTaskWork( uint32_t ulIndex )
+        {
+            MTWORKER * pWorker = &gaMtWorker[ ulIndex ];
+            uint32_t ulOp;
+
+            for( ulOp = 0U; ulOp < gulMtNops; ulOp++ )
+            {
+                REDSTATUS ret = MultiTaskOp( pWorker, ulIndex );
+
+                pWorker->ulOps++;
+
+                /*  The tasks race with each other in the shared directory, so
+                 *  files come and go, or are open, under them.  The volume may
+                 *  also fill up, and the handles run out.
+                 */
+                if( ( ret != 0 ) && ( ret != RED_ENOENT ) && ( ret != RED_EEXIST ) && ( ret != RED_EBUSY ) &&
+                    ( ret != RED_ENOSPC ) && ( ret != RED_EMFILE ) && ( ret != RED_ENFILE ) )
+                {
+                    if( pWorker->ulErrors == 0U )
+                    {
+                        pWorker->firstError = ret;
+                    }
+
+                    pWorker->ulErrors++;
+                }
+            }
+
+            /*  The task is deleted next; let the tasks of the next round have
+             *  its slot.
+             */
+            ( void ) red_taskrelease();
+        }
+
+
+/** @brief Run one random operation of the multi-task mode.
+ *
+ *  @param pWorker  The state of the calling task.
+ *  @param ulIndex  The index of the calling task.
+ *
+ *  @return Zero if the operation succeeded, otherwise its errno value.
+ */
+        static REDSTATUS MultiTaskOp( MTWORKER * pWorker,
+                                      uint32_t ulIndex )
+        {
+            uint32_t ulRand = RedRand32( &pWorker->ulSeed );
+            bool fShared = ( ulRand % 100U ) < gulMtSharedPct;
+            uint32_t ulFile = ( ulRand >> 8U ) % MT_FILES;
+            MTOP op = ( MTOP ) ( ( ulRand >> 16U ) % ( uint32_t ) MTOP_COUNT );
+            uint32_t ulLen = ( RedRand32( &pWorker->ulSeed ) % MT_IO_SIZE ) + 1U;
+            int32_t iFd = -1;
+            int32_t iRet;
+            REDSTAT sb;
+            REDDIR * pDir;
+            REDSTATUS ret;
+
+            MultiTaskPath( pWorker->szPath, ulIndex, fShared, ulFile );
+
+            switch( op )
+            {
+                case MTOP_WRITE:
+                case MTOP_FSYNC:
+                    iFd = red_open( pWorker->szPath, RED_O_WRONLY | RED_O_CREAT );
+                    iRet = iFd;
+
+                    if( iRet >= 0 )
+                    {
+                        RedMemSet( pWorker->abBuffer, ( uint8_t ) ulRand, ulLen );
+                        iRet = ( int32_t ) red_lseek( iFd, ( int64_t ) ( RedRand32( &pWorker->ulSeed ) % MT_MAX_OFFSET ), RED_SEEK_SET );
+                    }
+
+                    if( iRet >= 0 )
+                    {
+                        iRet = red_write( iFd, pWorker->abBuffer, ulLen );
+                    }
+
+                    if( ( iRet >= 0 ) && ( op == MTOP_FSYNC ) )
+                    {
+                        iRet = red_fsync( iFd );
+                    }
+
+                    break;
+
+                case MTOP_READ:
+                    iFd = red_open( pWorker->szPath, RED_O_RDONLY );
+                    iRet = iFd;
+
+                    while( iRet > 0 )
+                    {
+                        iRet = red_read( iFd, pWorker->abBuffer, ulLen );
+                    }
+
+                    break;
+
+                case MTOP_STAT:
+                    iFd = red_open( pWorker->szPath, RED_O_RDONLY );
+                    iRet = iFd;
+
+                    if( iRet >= 0 )
+                    {
+                        iRet = red_fstat( iFd, &sb );
+                    }
+
+                    break;
+
+                case MTOP_TRUNCATE:
+                    iFd = red_open( pWorker->szPath, RED_O_WRONLY );
+                    iRet = iFd;
+
+                    if( iRet >= 0 )
+                    {
+                        iRet = red_ftruncate( iFd, RedRand32( &pWorker->ulSeed ) % MT_MAX_OFFSET );
+                    }
+
+                    break;
+
+                case MTOP_UNLINK:
+                    iRet = red_unlink( pWorker->szPath );
+                    break;
+
+                case MTOP_RENAME:
+                    MultiTaskPath( pWorker->szPath2, ulIndex, fShared, RedRand32( &pWorker->ulSeed ) % MT_FILES );
+                    iRet = red_rename( pWorker->szPath, pWorker->szPath2 );
+                    break;
+
+                case MTOP_READDIR:
+                default:
+                    /*  List the directory of the file.
+                     */
+                    *strrchr( pWorker->szPath, '/' ) = '\0';
+                    pDir = red_opendir( pWorker->szPath );
+                    iRet = ( pDir == NULL ) ? -1 : 0;
+
+                    if( pDir != NULL )
+                    {
+                        /*  red_readdir() returns NULL both at the end of the
+                         *  directory and on error; only the latter sets
+                         *  red_errno.
+                         */
+                        red_errno = 0;
+
+                        while( red_readdir( pDir ) != NULL )
+                        {
+                        }
+
+                        if( red_errno != 0 )
+                        {
+                            iRet = -1;
+                        }
+
+                        ( void ) red_closedir( pDir );
+                    }
+
+                    break;
+            }
+
+            /*  red_errno must be read before closing the file.
+             */
+            if( iRet < 0 )
+            {
+                ret = red_errno;
+            }
+            else
+            {
+                ret = 0;
+            }
+
+            if( iFd >= 0 )
+            {
+                ( void ) red_close( iFd );
+            }
+
+            return ret;
+        }
+
+
+/** @brief Build the path of a file of the multi-task mode.
+ *
+ *  @param pszPath  Populated with the path; #MT_PATH_MAX bytes.
+ *  @param ulIndex  The index of the calling task.
+ *  @param fShared  Whether the file is in the shared directory.
+ *  @param ulFile   The number of the file in its directory.
+ */
+        static void MultiTaskPath( char * pszPath,
+                                   uint32_t ulIndex,
+                                   bool fShared,
+                                   uint32_t ulFile )
+        {
+            if( fShared )
+            {
+                ( void ) RedSNPrintf( pszPath, MT_PATH_MAX, "%s/" MT_DIR "/" MT_SHARED_DIR "/f%u", gpszMtVolume, ( unsigned ) ulFile );
+            }
+            else
+            {
+                ( void ) RedSNPrintf( pszPath, MT_PATH_MAX, "%s/" MT_DIR "/" MT_PRIVATE_DIR "/f%u", gpszMtVolume, ( unsigned ) ulIndex, ( unsigned ) ulFile );
+            }
+        }
+    #endif /* REDCONF_TASK_COUNT > 1U */
+
+
 #endif /* FSSTRESS_SUPPORTED */
@@ -0,0 +1,156 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements a benchmark which compares the CRC32 implementations.
+ *
+ *  Each available algorithm is timed over a range of buffer sizes, and its
+ *  result is checked against the bitwise algorithm, which is the reference.
+ */
+#include <redfs.h>
+#include <redtests.h>
+
+#if CRCBENCH_SUPPORTED
+
+
+/*  Largest buffer size which can be measured.
+ */
+    #define CRCBENCH_MAX_SIZE    65536U
+
+
+    typedef struct
+    {
+        uint8_t bAlgorithm;
+        const char * pszName;
+    } CRCALGORITHM;
+
+
+    static const CRCALGORITHM gaAlgorithm[] =
+    {
+        { CRC_BITWISE,  "bitwise"    },
+        { CRC_SARWATE,  "sarwate"    },
+        { CRC_SLICEBY8, "slice-by-8" },
+        #if REDCONF_CRC_ALGORITHM == CRC_HARDWARE
+            { CRC_HARDWARE, "hardware" },
+        #endif
+    };
+
+/*  Aligned as a block buffer would be.
+ */
+    static uint64_t gaullBuffer[ CRCBENCH_MAX_SIZE / sizeof( uint64_t ) ];
+
+
+/** @brief Populate a CRCBENCHPARAM structure with the default settings.
+ *
+ *  @param pParam   Populated with the default settings.
+ */
+    void RedCrcBenchDefaultParams( CRCBENCHPARAM * pParam )
+    {
+        if( pParam == NULL )
+        {
+            REDERROR();
+        }
+        else
+        {
+            pParam->ulMinSize = 64U;
+            pParam->ulMaxSize = REDCONF_BLOCK_SIZE;
+            pParam->ulMS = 250U;
+        }
+    }
+
+
+/** @brief Run the CRC benchmark.
+ *
+ *  For each buffer size, in powers of two from the minimum to the maximum, the
+ *  throughput of each algorithm is printed in KB/s.
+ *
+ *  @param pParam   Benchmark parameters.
+ *
+ *  @return Zero on success; nonzero if the parameters are invalid or if the
+ *          algorithms disagreed about a CRC.
+ */
+    int RedCrcBenchStart( const CRCBENCHPARAM * pParam )
+    {
+        int iResult = 0;
+
+        if( ( pParam == NULL ) ||
+            ( pParam->ulMinSize == 0U ) ||
+            ( pParam->ulMinSize > pParam->ulMaxSize ) ||
+            ( pParam->ulMaxSize > CRCBENCH_MAX_SIZE ) )
+        {
+            RedPrintf( "CRC benchmark: invalid parameters\n" );
+            iResult = 1;
+        }
+        else
+        {
+            uint32_t ulSeed = 1U;
+            uint32_t ulIdx;
+            uint32_t ulSize;
+
+            for( ulIdx = 0U; ulIdx < ( CRCBENCH_MAX_SIZE / sizeof( uint32_t ) ); ulIdx++ )
+            {
+                uint32_t ulRand = RedRand32( &ulSeed );
+
+                RedMemCpy( &CAST_VOID_PTR_TO_UINT8_PTR( gaullBuffer )[ ulIdx * sizeof( uint32_t ) ], &ulRand, sizeof( ulRand ) );
+            }
+
+            RedPrintf( "%-10s %8s %10s  %s\n", "algorithm", "bytes", "KB/s", "CRC" );
+
+            for( ulSize = pParam->ulMinSize; ( iResult == 0 ) && ( ulSize <= pParam->ulMaxSize ); ulSize <<= 1U )
+            {
+                uint32_t ulReference = RedCrc32UpdateAlgorithm( CRC_BITWISE, 0U, gaullBuffer, ulSize );
+
+                for( ulIdx = 0U; ulIdx < ( sizeof( gaAlgorithm ) / sizeof( gaAlgorithm[ 0U ] ) ); ulIdx++ )
+                {
+                    const CRCALGORITHM * pAlg = &gaAlgorithm[ ulIdx ];
+                    uint32_t ulCrc = 0U;
+                    uint64_t ullBytes = 0U;
+                    uint64_t ullUS;
+                    REDTIMESTAMP ts = RedOsTimestamp();
+
+                    do
+                    {
+                        ulCrc = RedCrc32UpdateAlgorithm( pAlg->bAlgorithm, 0U, gaullBuffer, ulSize );
+                        ullBytes += ulSize;
+                        ullUS = RedOsTimePassed( ts );
+                    } while( ullUS < ( ( uint64_t ) pParam->ulMS * 1000U ) );
+
+                    RedPrintf( "%-10s %8lu %10lu  %08lx%s\n", pAlg->pszName, ( unsigned long ) ulSize,
+                               ( unsigned long ) RedMulDiv64( ullBytes, 1000000U, ullUS * 1024U ),
+                               ( unsigned long ) ulCrc, ( ulCrc == ulReference ) ? "" : " MISMATCH" );
+
+                    if( ulCrc != ulReference )
+                    {
+                        iResult = 1;
+                    }
+                }
+            }
+        }
+
+        return iResult;
+    }
+
+#endif /* CRCBENCH_SUPPORTED */
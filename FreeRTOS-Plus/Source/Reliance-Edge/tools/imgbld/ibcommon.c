@@ -0,0 +1,205 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements image builder helpers which do not depend on the API.
+ */
+#include <stdio.h>
+
+#include <redfs.h>
+
+#if REDCONF_IMAGE_BUILDER == 1
+
+    #include <redcore.h>
+    #include <redvolume.h>
+    #include <redtools.h>
+
+/*  After the Reliance Edge headers: the host's <sys/stat.h> may define macros,
+ *  such as st_atime, which clash with the field names of REDSTAT.
+ */
+    #include <sys/types.h>
+    #include <sys/stat.h>
+
+
+/** @brief Copy the data of a host file into a file in the volume.
+ *
+ *  The file is reserved at its full size before any data is written, so that
+ *  it is laid out contiguously if the API supports preallocation.
+ *
+ *  @param volNum       The volume number; used only by the FSE API.
+ *  @param pFileMapping The host file and the file it is copied to.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int IbCopyFile( int volNum,
+                    const FILEMAPPING * pFileMapping )
+    {
+        int ret = 0;
+        FILE * pFile = fopen( pFileMapping->asInFilePath, "rb" );
+
+        if( pFile == NULL )
+        {
+            fprintf( stderr, "Unable to open \"%s\" for reading.\n", pFileMapping->asInFilePath );
+            ret = -1;
+        }
+        else
+        {
+            struct stat st;
+
+            if( stat( pFileMapping->asInFilePath, &st ) != 0 )
+            {
+                fprintf( stderr, "Unable to get the size of \"%s\".\n", pFileMapping->asInFilePath );
+                ret = -1;
+            }
+            else
+            {
+                ret = IbReserveFile( volNum, pFileMapping, ( uint64_t ) st.st_size );
+            }
+
+            if( ret == 0 )
+            {
+                uint64_t ullOffset = 0U;
+                size_t len;
+
+                do
+                {
+                    len = fread( gpCopyBuffer, 1U, gulCopyBufferSize, pFile );
+
+                    if( len > 0U )
+                    {
+                        ret = IbWriteFile( volNum, pFileMapping, ullOffset, gpCopyBuffer, ( uint32_t ) len );
+                        ullOffset += len;
+                    }
+                } while( ( ret == 0 ) && ( len == gulCopyBufferSize ) );
+
+                if( ( ret == 0 ) && ferror( pFile ) )
+                {
+                    fprintf( stderr, "Error reading \"%s\".\n", pFileMapping->asInFilePath );
+                    ret = -1;
+                }
+            }
+
+            ( void ) fclose( pFile );
+        }
+
+        return ret;
+    }
+
+
+/** @brief Determine whether a host file or directory exists.
+ *
+ *  @param pszPath      The host path.
+ *  @param pfExists     On successful return, populated with whether the path
+ *                      exists.
+ *
+ *  @return Zero on success, nonzero on failure.
+ */
+    int IbCheckFileExists( const char * pszPath,
+                           bool * pfExists )
+    {
+        struct stat st;
+
+        *pfExists = ( stat( pszPath, &st ) == 0 );
+
+        return 0;
+    }
+
+
+/** @brief Make both metaroots of a volume describe its committed state.
+ *
+ *  Normally the older metaroot describes the state before the last transaction
+ *  point, so that it can be fallen back on.  A freshly built image has no
+ *  useful older state: the older metaroot describes an empty or half built
+ *  tree.  Copying the newer metaroot over it means that, whichever metaroot is
+ *  used at mount, the finished tree is found.
+ *
+ *  Must be called while the volume is mounted, after a transaction point and
+ *  before any further change; the block device is accessed directly.
+ *
+ *  @param bVolNum  The volume number.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int IbMirrorMetaroot( uint8_t bVolNum )
+    {
+        int ret = 0;
+        uint8_t * pbBlocks = gpCopyBuffer;
+
+        if( gulCopyBufferSize < ( 2U * REDCONF_BLOCK_SIZE ) )
+        {
+            REDERROR();
+            ret = -1;
+        }
+        else if( RedIoRead( bVolNum, BLOCK_NUM_FIRST_METAROOT, 2U, pbBlocks ) != 0 )
+        {
+            fprintf( stderr, "Unable to read the metaroots.\n" );
+            ret = -1;
+        }
+        else
+        {
+            const NODEHEADER * pHdr0 = ( const NODEHEADER * ) pbBlocks;
+            const NODEHEADER * pHdr1 = ( const NODEHEADER * ) &pbBlocks[ REDCONF_BLOCK_SIZE ];
+            uint32_t ulSig0 = pHdr0->ulSignature;
+            uint32_t ulSig1 = pHdr1->ulSignature;
+            uint64_t ullSeq0 = pHdr0->ullSequence;
+            uint64_t ullSeq1 = pHdr1->ullSequence;
+
+            #ifdef REDCONF_ENDIAN_SWAP
+                ulSig0 = RedRev32( ulSig0 );
+                ulSig1 = RedRev32( ulSig1 );
+                ullSeq0 = RedRev64( ullSeq0 );
+                ullSeq1 = RedRev64( ullSeq1 );
+            #endif
+
+            if( ( ulSig0 != META_SIG_METAROOT ) || ( ulSig1 != META_SIG_METAROOT ) )
+            {
+                fprintf( stderr, "The metaroots are not valid.\n" );
+                ret = -1;
+            }
+            else if( ullSeq0 != ullSeq1 )
+            {
+                uint32_t ulNewer = ( ullSeq0 > ullSeq1 ) ? 0U : 1U;
+
+                if( ( RedIoWrite( bVolNum, BLOCK_NUM_FIRST_METAROOT + ( 1U - ulNewer ), 1U, &pbBlocks[ ulNewer * REDCONF_BLOCK_SIZE ] ) != 0 ) ||
+                    ( RedIoFlush( bVolNum ) != 0 ) )
+                {
+                    fprintf( stderr, "Unable to write the metaroot.\n" );
+                    ret = -1;
+                }
+            }
+            else
+            {
+                /*  Already identical.
+                 */
+            }
+        }
+
+        return ret;
+    }
+
+#endif /* REDCONF_IMAGE_BUILDER == 1 */
@@ -0,0 +1,193 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements the Linux host parts of the image builder.
+ */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+
+#include <redfs.h>
+
+#if REDCONF_IMAGE_BUILDER == 1
+
+    #include <redtools.h>
+
+/*  After the Reliance Edge headers: the host's <sys/stat.h> may define macros,
+ *  such as st_atime, which clash with the field names of REDSTAT.
+ */
+    #include <sys/types.h>
+    #include <sys/stat.h>
+
+
+    #if REDCONF_API_POSIX == 1
+
+/** @brief Walk a host directory tree, creating it in the volume or copying the
+ *         data of its files.
+ *
+ *  Entries are visited in name order, so the same tree always produces the
+ *  same image.  Within each directory, every entry is handled before the
+ *  walk descends into the subdirectories, which keeps each directory's
+ *  entries together.  Entries other than directories and regular files, such
+ *  as symbolic links, are skipped with a warning.
+ *
+ *  @param pszVolName   The volume path prefix.
+ *  @param pszBasePath  The host directory which corresponds to the root of the
+ *                      volume.
+ *  @param pszDir       The host directory to walk.
+ *  @param fCopyData    If false, create the directories and empty files; if
+ *                      true, copy the data into the files already created.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+        int IbPosixWalkDir( const char * pszVolName,
+                            const char * pszBasePath,
+                            const char * pszDir,
+                            bool fCopyData )
+        {
+            int ret = 0;
+            struct dirent ** ppEntries;
+            int entryCount = scandir( pszDir, &ppEntries, NULL, alphasort );
+
+            if( entryCount < 0 )
+            {
+                fprintf( stderr, "Unable to read directory \"%s\".\n", pszDir );
+                ret = -1;
+            }
+            else
+            {
+                int pass;
+                int idx;
+
+                /*  Pass 0 handles this directory's entries; pass 1 descends into
+                 *  its subdirectories.
+                 */
+                for( pass = 0; ( ret == 0 ) && ( pass < 2 ); pass++ )
+                {
+                    for( idx = 0; ( ret == 0 ) && ( idx < entryCount ); idx++ )
+                    {
+                        const char * pszName = ppEntries[ idx ]->d_name;
+                        char szPath[ HOST_PATH_MAX ];
+                        struct stat st;
+
+                        if( ( strcmp( pszName, "." ) == 0 ) || ( strcmp( pszName, ".." ) == 0 ) )
+                        {
+                            /*  Not part of the tree.
+                             */
+                        }
+                        else if( ( size_t ) snprintf( szPath, sizeof( szPath ), "%s%c%s", pszDir, HOST_PSEP, pszName ) >= sizeof( szPath ) )
+                        {
+                            fprintf( stderr, "Path too long: \"%s%c%s\"\n", pszDir, HOST_PSEP, pszName );
+                            ret = -1;
+                        }
+                        else if( lstat( szPath, &st ) != 0 )
+                        {
+                            fprintf( stderr, "Unable to examine \"%s\".\n", szPath );
+                            ret = -1;
+                        }
+                        else if( S_ISDIR( st.st_mode ) )
+                        {
+                            if( pass == 1 )
+                            {
+                                ret = IbPosixWalkDir( pszVolName, pszBasePath, szPath, fCopyData );
+                            }
+                            else if( !fCopyData )
+                            {
+                                ret = IbPosixCreateDir( pszVolName, szPath, pszBasePath );
+                            }
+                            else
+                            {
+                                /*  Already created by the first walk.
+                                 */
+                            }
+                        }
+                        else if( S_ISREG( st.st_mode ) )
+                        {
+                            if( pass == 1 )
+                            {
+                                /*  Files were handled in pass 0.
+                                 */
+                            }
+                            else if( !fCopyData )
+                            {
+                                ret = IbPosixCreateFile( pszVolName, szPath, pszBasePath );
+                            }
+                            else
+                            {
+                                FILEMAPPING mapping;
+
+                                ( void ) snprintf( mapping.asInFilePath, sizeof( mapping.asInFilePath ), "%s", szPath );
+                                ret = IbConvertPath( pszVolName, szPath, pszBasePath, mapping.asOutFilePath );
+
+                                if( ret == 0 )
+                                {
+                                    ret = IbCopyFile( 0, &mapping );
+                                }
+                            }
+                        }
+                        else if( ( pass == 0 ) && !fCopyData )
+                        {
+                            fprintf( stderr, "Warning: skipping \"%s\", which is not a regular file or directory.\n", szPath );
+                        }
+                        else
+                        {
+                            /*  Skipped, and already warned about.
+                             */
+                        }
+                    }
+                }
+
+                for( idx = 0; idx < entryCount; idx++ )
+                {
+                    free( ppEntries[ idx ] );
+                }
+
+                free( ppEntries );
+            }
+
+            return ret;
+        }
+    #endif /* REDCONF_API_POSIX == 1 */
+
+
+/** @brief Determine whether a host path names a regular file.
+ *
+ *  @param pszPath  The host path.
+ *
+ *  @return Whether @p pszPath exists and is a regular file.
+ */
+    bool IsRegularFile( const char * pszPath )
+    {
+        struct stat st;
+
+        return ( stat( pszPath, &st ) == 0 ) && S_ISREG( st.st_mode );
+    }
+
+#endif /* REDCONF_IMAGE_BUILDER == 1 */
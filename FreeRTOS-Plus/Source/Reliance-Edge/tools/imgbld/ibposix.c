@@ -0,0 +1,378 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements the parts of the image builder which use the POSIX-like
+ *         API.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <redfs.h>
+
+#if ( REDCONF_IMAGE_BUILDER == 1 ) && ( REDCONF_API_POSIX == 1 )
+
+    #include <redposix.h>
+    #include <redtools.h>
+
+
+    static int OutFileOpen( const char * pszPath );
+
+
+/*  The volume file being written, kept open between calls to IbWriteFile() so
+ *  that a file is opened once however many chunks it is written in.
+ */
+    static int32_t giOutFile = -1;
+    static char gasOutFilePath[ HOST_PATH_MAX ];
+
+
+/** @brief Copy a host directory tree into the volume.
+ *
+ *  The tree is walked twice.  The first walk creates every directory and an
+ *  empty file for every file, so that all of the directory data is allocated
+ *  before any file data; the second walk copies the file data.
+ *
+ *  @param pszVolName   The volume path prefix.
+ *  @param pszInDir     The host directory whose contents are copied.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    REDSTATUS IbPosixCopyDir( const char * pszVolName,
+                              const char * pszInDir )
+    {
+        REDSTATUS ret = 0;
+
+        if( IbPosixWalkDir( pszVolName, pszInDir, pszInDir, false ) != 0 )
+        {
+            ret = -RED_EIO;
+        }
+        else if( IbPosixWalkDir( pszVolName, pszInDir, pszInDir, true ) != 0 )
+        {
+            ret = -RED_EIO;
+        }
+        else
+        {
+            /*  The tree has been copied.
+             */
+        }
+
+        /*  Close the last file written, so that the volume can be unmounted.
+         */
+        if( ( giOutFile >= 0 ) && ( red_close( giOutFile ) != 0 ) && ( ret == 0 ) )
+        {
+            ret = -RED_EIO;
+        }
+
+        giOutFile = -1;
+
+        return ret;
+    }
+
+
+/** @brief Create a directory in the volume to match a host directory.
+ *
+ *  @param pszVolName   The volume path prefix.
+ *  @param pszFullPath  The host directory.
+ *  @param pszBasePath  The host directory which corresponds to the root of the
+ *                      volume.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int IbPosixCreateDir( const char * pszVolName,
+                          const char * pszFullPath,
+                          const char * pszBasePath )
+    {
+        char szOutPath[ HOST_PATH_MAX ];
+        int ret = IbConvertPath( pszVolName, pszFullPath, pszBasePath, szOutPath );
+
+        if( ( ret == 0 ) && ( red_mkdir( szOutPath ) != 0 ) )
+        {
+            fprintf( stderr, "Unable to create directory \"%s\": error %d\n", szOutPath, ( int ) red_errno );
+            ret = -1;
+        }
+
+        return ret;
+    }
+
+
+/** @brief Create an empty file in the volume to match a host file.
+ *
+ *  @param pszVolName   The volume path prefix.
+ *  @param pszFullPath  The host file.
+ *  @param pszBasePath  The host directory which corresponds to the root of the
+ *                      volume.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int IbPosixCreateFile( const char * pszVolName,
+                           const char * pszFullPath,
+                           const char * pszBasePath )
+    {
+        char szOutPath[ HOST_PATH_MAX ];
+        int ret = IbConvertPath( pszVolName, pszFullPath, pszBasePath, szOutPath );
+
+        if( ret == 0 )
+        {
+            int32_t iFildes = red_open( szOutPath, RED_O_WRONLY | RED_O_CREAT | RED_O_EXCL );
+
+            if( iFildes < 0 )
+            {
+                fprintf( stderr, "Unable to create file \"%s\": error %d\n", szOutPath, ( int ) red_errno );
+                ret = -1;
+            }
+            else if( red_close( iFildes ) != 0 )
+            {
+                ret = -1;
+            }
+            else
+            {
+                /*  Created.
+                 */
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Convert a host path into the corresponding volume path.
+ *
+ *  @param pszVolName   The volume path prefix.
+ *  @param pszFullPath  The host path, which must be within @p pszBasePath.
+ *  @param pszBasePath  The host directory which corresponds to the root of the
+ *                      volume.
+ *  @param szOutPath    Populated with the volume path; must be #HOST_PATH_MAX
+ *                      bytes.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int IbConvertPath( const char * pszVolName,
+                       const char * pszFullPath,
+                       const char * pszBasePath,
+                       char * szOutPath )
+    {
+        int ret = 0;
+        size_t baseLen = strlen( pszBasePath );
+
+        if( strncmp( pszFullPath, pszBasePath, baseLen ) != 0 )
+        {
+            REDERROR();
+            ret = -1;
+        }
+        else
+        {
+            const char * pszRelPath = &pszFullPath[ baseLen ];
+            size_t outLen;
+            size_t idx;
+
+            while( *pszRelPath == HOST_PSEP )
+            {
+                pszRelPath++;
+            }
+
+            if( ( size_t ) snprintf( szOutPath, HOST_PATH_MAX, "%s%c%s", pszVolName, REDCONF_PATH_SEPARATOR, pszRelPath ) >= HOST_PATH_MAX )
+            {
+                fprintf( stderr, "Path too long: \"%s\"\n", pszFullPath );
+                ret = -1;
+            }
+            else
+            {
+                outLen = strlen( szOutPath );
+
+                for( idx = strlen( pszVolName ); idx < outLen; idx++ )
+                {
+                    if( szOutPath[ idx ] == HOST_PSEP )
+                    {
+                        szOutPath[ idx ] = REDCONF_PATH_SEPARATOR;
+                    }
+                }
+            }
+        }
+
+        return ret;
+    }
+
+
+/** @brief Initialize the POSIX-like API.
+ *
+ *  @return Zero on success, nonzero on failure.
+ */
+    int IbApiInit( void )
+    {
+        int ret = 0;
+
+        if( red_init() != 0 )
+        {
+            fprintf( stderr, "Unable to initialize Reliance Edge: error %d\n", ( int ) red_errno );
+            ret = -1;
+        }
+
+        return ret;
+    }
+
+
+/** @brief Uninitialize the POSIX-like API.
+ *
+ *  @return Zero on success, nonzero on failure.
+ */
+    int IbApiUninit( void )
+    {
+        int ret = 0;
+
+        if( red_uninit() != 0 )
+        {
+            fprintf( stderr, "Unable to uninitialize Reliance Edge: error %d\n", ( int ) red_errno );
+            ret = -1;
+        }
+
+        return ret;
+    }
+
+
+/** @brief Write data to a file in the volume.
+ *
+ *  @param volNum       Unused by the POSIX-like API.
+ *  @param pFileMapping The file to write.
+ *  @param ullOffset    The file offset at which to write.
+ *  @param pData        The data to write.
+ *  @param ulDataLen    The number of bytes to write.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int IbWriteFile( int volNum,
+                     const FILEMAPPING * pFileMapping,
+                     uint64_t ullOffset,
+                     void * pData,
+                     uint32_t ulDataLen )
+    {
+        int ret = OutFileOpen( pFileMapping->asOutFilePath );
+
+        ( void ) volNum;
+
+        if( ( ret == 0 ) && ( red_lseek( giOutFile, ( int64_t ) ullOffset, RED_SEEK_SET ) != ( int64_t ) ullOffset ) )
+        {
+            ret = -1;
+        }
+
+        if( ( ret == 0 ) && ( red_write( giOutFile, pData, ulDataLen ) != ( int32_t ) ulDataLen ) )
+        {
+            ret = -1;
+        }
+
+        if( ret != 0 )
+        {
+            fprintf( stderr, "Unable to write \"%s\": error %d\n", pFileMapping->asOutFilePath, ( int ) red_errno );
+        }
+
+        return ret;
+    }
+
+
+/** @brief Reserve the blocks for a file in the volume before it is written.
+ *
+ *  With red_fallocate(), the blocks are allocated in as few contiguous runs as
+ *  the free space allows.  Without it, nothing is reserved, and the file is
+ *  laid out as it is written.
+ *
+ *  @param volNum       Unused by the POSIX-like API.
+ *  @param pFileMapping The file to reserve.
+ *  @param ullSize      The size the file will have.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int IbReserveFile( int volNum,
+                       const FILEMAPPING * pFileMapping,
+                       uint64_t ullSize )
+    {
+        int ret = 0;
+
+        ( void ) volNum;
+
+        #if REDCONF_API_POSIX_FALLOCATE == 1
+            if( ullSize > 0U )
+            {
+                ret = OutFileOpen( pFileMapping->asOutFilePath );
+
+                if( ( ret == 0 ) && ( red_fallocate( giOutFile, 0U, ullSize ) != 0 ) )
+                {
+                    fprintf( stderr, "Unable to allocate %llu bytes for \"%s\": error %d\n",
+                             ( unsigned long long ) ullSize, pFileMapping->asOutFilePath, ( int ) red_errno );
+                    ret = -1;
+                }
+            }
+        #else
+            ( void ) pFileMapping;
+            ( void ) ullSize;
+        #endif
+
+        return ret;
+    }
+
+
+/** @brief Make a volume file the open output file.
+ *
+ *  @param pszPath  The volume path of the file.
+ *
+ *  @return Zero on success, nonzero on failure.
+ */
+    static int OutFileOpen( const char * pszPath )
+    {
+        int ret = 0;
+
+        if( ( giOutFile < 0 ) || ( strcmp( pszPath, gasOutFilePath ) != 0 ) )
+        {
+            if( ( giOutFile >= 0 ) && ( red_close( giOutFile ) != 0 ) )
+            {
+                ret = -1;
+            }
+
+            giOutFile = -1;
+
+            if( ret == 0 )
+            {
+                giOutFile = red_open( pszPath, RED_O_WRONLY );
+
+                if( giOutFile < 0 )
+                {
+                    ret = -1;
+                }
+                else
+                {
+                    ( void ) snprintf( gasOutFilePath, sizeof( gasOutFilePath ), "%s", pszPath );
+                }
+            }
+        }
+
+        return ret;
+    }
+
+#endif /* ( REDCONF_IMAGE_BUILDER == 1 ) && ( REDCONF_API_POSIX == 1 ) */
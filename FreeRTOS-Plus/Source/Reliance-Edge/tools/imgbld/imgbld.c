@@ -0,0 +1,373 @@
+/*             ----> DO NOT REMOVE THE FOLLOWING NOTICE <----
+ *
+ *                 Copyright (c) 2014-2015 Datalight, Inc.
+ *                     All Rights Reserved Worldwide.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; use version 2 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but "AS-IS," WITHOUT ANY WARRANTY; without even the implied warranty
+ *  of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*  Businesses and individuals that for commercial or other reasons cannot
+ *  comply with the terms of the GPLv2 license may obtain a commercial license
+ *  before incorporating Reliance Edge into proprietary software for
+ *  distribution in any form.  Visit http://www.datalight.com/reliance-edge for
+ *  more information.
+ */
+
+/** @file
+ *  @brief Implements the image builder: a host tool which creates a complete
+ *         Reliance Edge volume image from a directory tree.
+ *
+ *  The image is built by the file system itself, running on the host against
+ *  a block device which is the output file, and is laid out for fast
+ *  provisioning:
+ *
+ *  - Every directory, and every directory entry, is created before any file
+ *    data is written, so the directory blocks are together at the start of
+ *    the volume and do not break up the file data.
+ *  - Each file is preallocated to its full size before it is written, so its
+ *    data is one contiguous run of blocks wherever the free space allows.
+ *  - No transaction point is made until the tree has been copied, so nothing
+ *    is written twice and no blocks are left almost free.
+ *  - After the final transaction point, the new metaroot is copied over the
+ *    old one, so that both metaroots describe the finished tree.
+ *  - The image file is padded to the full size of the volume, so it can be
+ *    written to the device in one bulk write.
+ *
+ *  Only the POSIX-like API is supported.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <redfs.h>
+
+#if REDCONF_IMAGE_BUILDER == 1
+
+    #include <redposix.h>
+    #include <redvolume.h>
+    #include <redgetopt.h>
+    #include <redtoolcmn.h>
+    #include <redtools.h>
+
+
+    #if REDCONF_API_POSIX == 0
+        #error "The image builder requires REDCONF_API_POSIX"
+    #endif
+
+    #if ( REDCONF_API_POSIX_FORMAT == 0 ) || ( REDCONF_API_POSIX_MKDIR == 0 )
+        #error "The image builder requires REDCONF_API_POSIX_FORMAT and REDCONF_API_POSIX_MKDIR"
+    #endif
+
+
+    static void Usage( const char * pszProgramName );
+    static int ImagePad( const char * pszImage,
+                         uint64_t ullSize );
+
+
+    void * gpCopyBuffer;
+    uint32_t gulCopyBufferSize;
+
+
+/** @brief Parse the image builder command line.
+ *
+ *  Prints a message and exits if the command line is invalid or help was
+ *  requested.
+ *
+ *  @param argc     The number of arguments from main().
+ *  @param argv     The argument values from main().
+ *  @param pParam   Populated with the image builder parameters.
+ */
+    void ImgbldParseParams( int argc,
+                            char * argv[],
+                            IMGBLDPARAM * pParam )
+    {
+        int32_t c;
+        const REDOPTION aLongopts[] =
+        {
+            { "dir",  red_required_argument, NULL, 'i' },
+            { "dev",  red_required_argument, NULL, 'D' },
+            { "help", red_no_argument,       NULL, 'H' },
+            { NULL }
+        };
+
+        memset( pParam, 0, sizeof( *pParam ) );
+
+        while( ( c = RedGetoptLong( argc, argv, "i:D:H", aLongopts, NULL ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'i': /* --dir */
+                    pParam->pszInputDir = red_optarg;
+                    break;
+
+                case 'D': /* --dev */
+                    pParam->pszOutputFile = red_optarg;
+                    break;
+
+                case 'H': /* --help */
+                    Usage( argv[ 0U ] );
+                    exit( 0 );
+
+                case '?': /* Unknown or ambiguous option */
+                case ':': /* Option missing required argument */
+                default:
+                    Usage( argv[ 0U ] );
+                    exit( 1 );
+            }
+        }
+
+        /*  RedGetoptLong() has permuted argv to move all non-option arguments to
+         *  the end.  We expect to find exactly one: the volume identifier.
+         */
+        if( red_optind != ( argc - 1 ) )
+        {
+            fprintf( stderr, "Expected one volume argument\n" );
+            Usage( argv[ 0U ] );
+            exit( 1 );
+        }
+
+        pParam->bVolNumber = RedFindVolumeNumber( argv[ red_optind ] );
+
+        if( pParam->bVolNumber == REDCONF_VOLUME_COUNT )
+        {
+            fprintf( stderr, "Error: \"%s\" is not a valid volume identifier.\n", argv[ red_optind ] );
+            exit( 1 );
+        }
+
+        if( ( pParam->pszInputDir == NULL ) || ( pParam->pszOutputFile == NULL ) )
+        {
+            fprintf( stderr, "Both --dir and --dev must be specified.\n" );
+            Usage( argv[ 0U ] );
+            exit( 1 );
+        }
+
+        pParam->pszVolName = gaRedVolConf[ pParam->bVolNumber ].pszPathPrefix;
+    }
+
+
+/** @brief Build a volume image.
+ *
+ *  @param pParam   The image builder parameters.
+ *
+ *  @return Zero on success, nonzero on failure.  A message has been printed
+ *          for any failure.
+ */
+    int ImgbldStart( IMGBLDPARAM * pParam )
+    {
+        int ret = 0;
+        bool fInit = false;
+        bool fMounted = false;
+        bool fExists;
+
+        if( ( IbCheckFileExists( pParam->pszInputDir, &fExists ) != 0 ) || !fExists )
+        {
+            fprintf( stderr, "Input directory \"%s\" does not exist.\n", pParam->pszInputDir );
+            ret = -1;
+        }
+
+        if( ret == 0 )
+        {
+            gulCopyBufferSize = IMGBLD_COPY_BUFFER_BLOCKS * REDCONF_BLOCK_SIZE;
+            gpCopyBuffer = malloc( gulCopyBufferSize );
+
+            if( gpCopyBuffer == NULL )
+            {
+                fprintf( stderr, "Unable to allocate a %lu byte copy buffer.\n", ( unsigned long ) gulCopyBufferSize );
+                ret = -1;
+            }
+        }
+
+        if( ret == 0 )
+        {
+            ret = IbApiInit();
+            fInit = ( ret == 0 );
+        }
+
+        if( ret == 0 )
+        {
+            if( RedOsBDevConfig( pParam->bVolNumber, pParam->pszOutputFile ) != 0 )
+            {
+                fprintf( stderr, "Unable to use \"%s\" as the block device.\n", pParam->pszOutputFile );
+                ret = -1;
+            }
+        }
+
+        if( ret == 0 )
+        {
+            if( red_format( pParam->pszVolName ) != 0 )
+            {
+                fprintf( stderr, "Unable to format %s: error %d\n", pParam->pszVolName, ( int ) red_errno );
+                ret = -1;
+            }
+        }
+
+        if( ret == 0 )
+        {
+            if( red_mount( pParam->pszVolName ) != 0 )
+            {
+                fprintf( stderr, "Unable to mount %s: error %d\n", pParam->pszVolName, ( int ) red_errno );
+                ret = -1;
+            }
+            else
+            {
+                fMounted = true;
+            }
+        }
+
+        if( ret == 0 )
+        {
+            /*  The whole tree goes into one transaction.
+             */
+            if( red_settransmask( pParam->pszVolName, RED_TRANSACT_MANUAL ) != 0 )
+            {
+                fprintf( stderr, "Unable to disable automatic transactions: error %d\n", ( int ) red_errno );
+                ret = -1;
+            }
+        }
+
+        if( ret == 0 )
+        {
+            ret = ( int ) IbPosixCopyDir( pParam->pszVolName, pParam->pszInputDir );
+        }
+
+        if( ret == 0 )
+        {
+            if( red_transact( pParam->pszVolName ) != 0 )
+            {
+                fprintf( stderr, "Unable to transact %s: error %d\n", pParam->pszVolName, ( int ) red_errno );
+                ret = -1;
+            }
+        }
+
+        if( ret == 0 )
+        {
+            ret = IbMirrorMetaroot( pParam->bVolNumber );
+        }
+
+        if( fMounted && ( red_umount( pParam->pszVolName ) != 0 ) )
+        {
+            fprintf( stderr, "Unable to unmount %s: error %d\n", pParam->pszVolName, ( int ) red_errno );
+
+            if( ret == 0 )
+            {
+                ret = -1;
+            }
+        }
+
+        if( fInit && ( IbApiUninit() != 0 ) && ( ret == 0 ) )
+        {
+            ret = -1;
+        }
+
+        if( ( ret == 0 ) && IsRegularFile( pParam->pszOutputFile ) )
+        {
+            const VOLCONF * pVolConf = &gaRedVolConf[ pParam->bVolNumber ];
+
+            ret = ImagePad( pParam->pszOutputFile, pVolConf->ullSectorCount * pVolConf->ulSectorSize );
+        }
+
+        free( gpCopyBuffer );
+        gpCopyBuffer = NULL;
+
+        if( ret == 0 )
+        {
+            printf( "Image of \"%s\" written to \"%s\".\n", pParam->pszInputDir, pParam->pszOutputFile );
+        }
+
+        return ( ret == 0 ) ? 0 : 1;
+    }
+
+
+/** @brief Print the image builder usage.
+ *
+ *  @param pszProgramName   The name of the program.
+ */
+    static void Usage( const char * pszProgramName )
+    {
+        fprintf( stderr,
+                 "usage: %s VolumeID --dir=inputDir --dev=imageFile [--help]\n"
+                 "Build a Reliance Edge volume image from a directory tree.\n"
+                 "\n"
+                 "Where:\n"
+                 "  VolumeID\n"
+                 "      A volume number (e.g., 2) or a volume path prefix (e.g., VOL1: or\n"
+                 "      /data) of the volume whose configuration the image is built for.\n"
+                 "  --dir=inputDir, -i inputDir\n"
+                 "      The host directory whose contents are copied into the image.\n"
+                 "  --dev=imageFile, -D imageFile\n"
+                 "      The image file (or block device) to write.  An image file is\n"
+                 "      padded to the full size of the volume.\n"
+                 "  --help, -H\n"
+                 "      Prints this usage text and exits.\n",
+                 pszProgramName );
+    }
+
+
+/** @brief Extend an image file to the full size of the volume.
+ *
+ *  The file system never writes the unused blocks at the end of the volume, so
+ *  the file may be shorter than the volume.
+ *
+ *  @param pszImage The image file.
+ *  @param ullSize  The size of the volume in bytes.
+ *
+ *  @return Zero on success, nonzero on failure.
+ */
+    static int ImagePad( const char * pszImage,
+                         uint64_t ullSize )
+    {
+        int ret = 0;
+        FILE * pFile = fopen( pszImage, "r+b" );
+
+        if( pFile == NULL )
+        {
+            ret = -1;
+        }
+        else
+        {
+            if( ( fseek( pFile, 0L, SEEK_END ) != 0 ) || ( ftell( pFile ) < 0L ) )
+            {
+                ret = -1;
+            }
+            else if( ( uint64_t ) ftell( pFile ) < ullSize )
+            {
+                if( ( ullSize > ( uint64_t ) LONG_MAX ) ||
+                    ( fseek( pFile, ( long ) ( ullSize - 1U ), SEEK_SET ) != 0 ) ||
+                    ( fputc( 0, pFile ) == EOF ) )
+                {
+                    ret = -1;
+                }
+            }
+            else
+            {
+                /*  Already the full size.
+                 */
+            }
+
+            if( fclose( pFile ) != 0 )
+            {
+                ret = -1;
+            }
+        }
+
+        if( ret != 0 )
+        {
+            fprintf( stderr, "Unable to pad \"%s\" to %llu bytes.\n", pszImage, ( unsigned long long ) ullSize );
+        }
+
+        return ret;
+    }
+
+#endif /* REDCONF_IMAGE_BUILDER == 1 */
@@ -97,3 +97,175 @@ void RedBitClear( uint8_t * pbBitmap,
         pbBitmap[ ulBit >> 3U ] &= ~( 0x80U >> ( ulBit & 7U ) );
     }
 }
+
+
+/** @brief Find the first clear bit in a range of a bitmap.
+ *
+ *  Bytes, and runs of four bytes, which have every bit set are skipped without
+ *  examining their bits individually.
+ *
+ *  Bits are counted from most significant to least significant.  Thus, the mask
+ *  for bit zero is 0x80 applied to the first byte in the bitmap.
+ *
+ *  @param pbBitmap     Pointer to the bitmap.
+ *  @param ulBitStart   The first bit to examine.
+ *  @param ulBitEnd     The bit after the last bit to examine.
+ *
+ *  @return The first clear bit at or after @p ulBitStart, or @p ulBitEnd if
+ *          all of the bits in the range are set.
+ */
+uint32_t RedBitFindClear( const uint8_t * pbBitmap,
+                          uint32_t ulBitStart,
+                          uint32_t ulBitEnd )
+{
+    uint32_t ulBit = ulBitStart;
+
+    if( pbBitmap == NULL )
+    {
+        REDERROR();
+        ulBit = ulBitEnd;
+    }
+    else
+    {
+        while( ulBit < ulBitEnd )
+        {
+            uint32_t ulByte = ulBit >> 3U;
+
+            if( ( ( ulBit & 31U ) == 0U ) &&
+                ( ( ulBitEnd - ulBit ) >= 32U ) &&
+                ( ( pbBitmap[ ulByte ] & pbBitmap[ ulByte + 1U ] & pbBitmap[ ulByte + 2U ] & pbBitmap[ ulByte + 3U ] ) == 0xFFU ) )
+            {
+                ulBit += 32U;
+            }
+            else if( ( ( ulBit & 7U ) == 0U ) && ( ( ulBitEnd - ulBit ) >= 8U ) && ( pbBitmap[ ulByte ] == 0xFFU ) )
+            {
+                ulBit += 8U;
+            }
+            else if( ( pbBitmap[ ulByte ] & ( 0x80U >> ( ulBit & 7U ) ) ) != 0U )
+            {
+                ulBit++;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    return ulBit;
+}
+
+
+/** @brief Count the set bits in a range of a bitmap.
+ *
+ *  Whole bytes, and runs of four bytes, which have every bit set or every bit
+ *  clear are counted without examining their bits individually.
+ *
+ *  Bits are counted from most significant to least significant.  Thus, the mask
+ *  for bit zero is 0x80 applied to the first byte in the bitmap.
+ *
+ *  @param pbBitmap     Pointer to the bitmap.
+ *  @param ulBitStart   The first bit to examine.
+ *  @param ulBitEnd     The bit after the last bit to examine.
+ *
+ *  @return The number of bits in the range which are set.
+ */
+uint32_t RedBitCountSet( const uint8_t * pbBitmap,
+                         uint32_t ulBitStart,
+                         uint32_t ulBitEnd )
+{
+    uint32_t ulCount = 0U;
+
+    if( pbBitmap == NULL )
+    {
+        REDERROR();
+    }
+    else
+    {
+        uint32_t ulBit = ulBitStart;
+
+        while( ulBit < ulBitEnd )
+        {
+            uint32_t ulByte = ulBit >> 3U;
+
+            if( ( ( ulBit & 31U ) == 0U ) && ( ( ulBitEnd - ulBit ) >= 32U ) &&
+                ( ( ( pbBitmap[ ulByte ] & pbBitmap[ ulByte + 1U ] & pbBitmap[ ulByte + 2U ] & pbBitmap[ ulByte + 3U ] ) == 0xFFU ) ||
+                  ( ( pbBitmap[ ulByte ] | pbBitmap[ ulByte + 1U ] | pbBitmap[ ulByte + 2U ] | pbBitmap[ ulByte + 3U ] ) == 0U ) ) )
+            {
+                if( pbBitmap[ ulByte ] != 0U )
+                {
+                    ulCount += 32U;
+                }
+
+                ulBit += 32U;
+            }
+            else if( ( ( ulBit & 7U ) == 0U ) && ( ( ulBitEnd - ulBit ) >= 8U ) )
+            {
+                uint8_t bByte = pbBitmap[ ulByte ];
+
+                while( bByte != 0U )
+                {
+                    bByte &= ( uint8_t ) ( bByte - 1U );
+                    ulCount++;
+                }
+
+                ulBit += 8U;
+            }
+            else
+            {
+                if( ( pbBitmap[ ulByte ] & ( 0x80U >> ( ulBit & 7U ) ) ) != 0U )
+                {
+                    ulCount++;
+                }
+
+                ulBit++;
+            }
+        }
+    }
+
+    return ulCount;
+}
+
+
+/** @brief Clear a range of bits in a bitmap to zero.
+ *
+ *  The whole bytes within the range are cleared at once; only the bits in the
+ *  partial bytes at either end are masked.
+ *
+ *  Bits are counted from most significant to least significant.  Thus, the mask
+ *  for bit zero is 0x80 applied to the first byte in the bitmap.
+ *
+ *  @param pbBitmap     Pointer to the bitmap.
+ *  @param ulBitStart   The first bit to clear.
+ *  @param ulBitEnd     The bit after the last bit to clear.
+ */
+void RedBitClearRange( uint8_t * pbBitmap,
+                       uint32_t ulBitStart,
+                       uint32_t ulBitEnd )
+{
+    REDASSERT( pbBitmap != NULL );
+
+    if( ( pbBitmap != NULL ) && ( ulBitStart < ulBitEnd ) )
+    {
+        uint32_t ulFirstByte = ulBitStart >> 3U;
+        uint32_t ulLastByte = ( ulBitEnd - 1U ) >> 3U;
+        uint8_t bHeadMask = ( uint8_t ) ( 0xFFU >> ( ulBitStart & 7U ) );
+        uint8_t bTailMask = ( uint8_t ) ( 0xFFU << ( 7U - ( ( ulBitEnd - 1U ) & 7U ) ) );
+
+        if( ulFirstByte == ulLastByte )
+        {
+            pbBitmap[ ulFirstByte ] &= ( uint8_t ) ~( bHeadMask & bTailMask );
+        }
+        else
+        {
+            pbBitmap[ ulFirstByte ] &= ( uint8_t ) ~bHeadMask;
+
+            if( ( ulLastByte - ulFirstByte ) > 1U )
+            {
+                RedMemSet( &pbBitmap[ ulFirstByte + 1U ], 0U, ( ulLastByte - ulFirstByte ) - 1U );
+            }
+
+            pbBitmap[ ulLastByte ] &= ( uint8_t ) ~bTailMask;
+        }
+    }
+}
@@ -38,12 +38,163 @@
  */
 #define SUSPICIOUS_CRC_VALUE    ( 0xBAADC0DEU )
 
-#define CRC_BITWISE             ( 0U )
-#define CRC_SARWATE             ( 1U )
-#define CRC_SLICEBY8            ( 2U )
 
+/*  The software algorithm used by RedCrc32Update(): either the configured
+ *  algorithm or, when CRC_HARDWARE is configured, the fallback for requests
+ *  which the port cannot compute in hardware.
+ */
+#if REDCONF_CRC_ALGORITHM == CRC_HARDWARE
+    #define CRC_SOFTWARE    REDCONF_CRC_FALLBACK
+#else
+    #define CRC_SOFTWARE    REDCONF_CRC_ALGORITHM
+#endif
+
+/*  Whether a software algorithm must be compiled in.  The benchmark needs all
+ *  of them.
+ */
+#define CRC_NEEDED( alg )    ( ( CRC_SOFTWARE == ( alg ) ) || ( REDCONF_CRC_BENCHMARK == 1 ) )
+
+#if ( REDCONF_CRC_ALGORITHM != CRC_BITWISE ) && ( REDCONF_CRC_ALGORITHM != CRC_SARWATE ) && ( REDCONF_CRC_ALGORITHM != CRC_SLICEBY8 ) && ( REDCONF_CRC_ALGORITHM != CRC_HARDWARE )
+    #error "REDCONF_CRC_ALGORITHM must be set to CRC_BITWISE, CRC_SARWATE, CRC_SLICEBY8, or CRC_HARDWARE"
+#endif
+
+#if ( CRC_SOFTWARE != CRC_BITWISE ) && ( CRC_SOFTWARE != CRC_SARWATE ) && ( CRC_SOFTWARE != CRC_SLICEBY8 )
+    #error "REDCONF_CRC_FALLBACK must be set to CRC_BITWISE, CRC_SARWATE, or CRC_SLICEBY8"
+#endif
+
+
+#if CRC_NEEDED( CRC_BITWISE )
+    static uint32_t Crc32Bitwise( uint32_t ulInitCrc32,
+                                  const void * pBuffer,
+                                  uint32_t ulLength );
+#endif
+#if CRC_NEEDED( CRC_SARWATE )
+    static uint32_t Crc32Sarwate( uint32_t ulInitCrc32,
+                                  const void * pBuffer,
+                                  uint32_t ulLength );
+#endif
+#if CRC_NEEDED( CRC_SLICEBY8 )
+    static uint32_t Crc32SliceBy8( uint32_t ulInitCrc32,
+                                   const void * pBuffer,
+                                   uint32_t ulLength );
+#endif
+static uint32_t Crc32Software( uint32_t ulInitCrc32,
+                               const void * pBuffer,
+                               uint32_t ulLength );
+
+
+/** @brief Compute a CRC32 for the given data buffer.
+ *
+ *  For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
+ *  buffers, call this function with the previously returned CRC value.
+ *
+ *  @param ulInitCrc32  Starting CRC value.
+ *  @param pBuffer      Data buffer to calculate the CRC from.
+ *  @param ulLength     Number of bytes of data in the given buffer.
+ *
+ *  @return The updated CRC value.
+ */
+uint32_t RedCrc32Update( uint32_t ulInitCrc32,
+                         const void * pBuffer,
+                         uint32_t ulLength )
+{
+    uint32_t ulCrc32;
+
+    #if REDCONF_CRC_ALGORITHM == CRC_HARDWARE
+        if( pBuffer == NULL )
+        {
+            REDERROR();
+            ulCrc32 = SUSPICIOUS_CRC_VALUE;
+        }
+        else if( !RedOsCrc32Update( ulInitCrc32, pBuffer, ulLength, &ulCrc32 ) )
+        {
+            ulCrc32 = Crc32Software( ulInitCrc32, pBuffer, ulLength );
+        }
+        else
+        {
+            /*  Computed by the port.
+             */
+        }
+    #else
+        ulCrc32 = Crc32Software( ulInitCrc32, pBuffer, ulLength );
+    #endif
+
+    return ulCrc32;
+}
+
+
+#if REDCONF_CRC_BENCHMARK == 1
+
+/** @brief Compute a CRC32 with a specific algorithm.
+ *
+ *  Only used for benchmarking: the file system always uses RedCrc32Update().
+ *
+ *  @param bAlgorithm   The algorithm to use: one of CRC_BITWISE, CRC_SARWATE,
+ *                      CRC_SLICEBY8, or (if it is the configured algorithm)
+ *                      CRC_HARDWARE.
+ *  @param ulInitCrc32  Starting CRC value.
+ *  @param pBuffer      Data buffer to calculate the CRC from.
+ *  @param ulLength     Number of bytes of data in the given buffer.
+ *
+ *  @return The updated CRC value.
+ */
+    uint32_t RedCrc32UpdateAlgorithm( uint8_t bAlgorithm,
+                                      uint32_t ulInitCrc32,
+                                      const void * pBuffer,
+                                      uint32_t ulLength )
+    {
+        uint32_t ulCrc32;
+
+        switch( bAlgorithm )
+        {
+            case CRC_BITWISE:
+                ulCrc32 = Crc32Bitwise( ulInitCrc32, pBuffer, ulLength );
+                break;
+            case CRC_SARWATE:
+                ulCrc32 = Crc32Sarwate( ulInitCrc32, pBuffer, ulLength );
+                break;
+            case CRC_SLICEBY8:
+                ulCrc32 = Crc32SliceBy8( ulInitCrc32, pBuffer, ulLength );
+                break;
+            #if REDCONF_CRC_ALGORITHM == CRC_HARDWARE
+                case CRC_HARDWARE:
+                    ulCrc32 = RedCrc32Update( ulInitCrc32, pBuffer, ulLength );
+                    break;
+            #endif
+            default:
+                REDERROR();
+                ulCrc32 = SUSPICIOUS_CRC_VALUE;
+                break;
+        }
+
+        return ulCrc32;
+    }
+#endif /* REDCONF_CRC_BENCHMARK == 1 */
 
-#if REDCONF_CRC_ALGORITHM == CRC_BITWISE
+
+/** @brief Compute a CRC32 with the configured software algorithm.
+ *
+ *  @param ulInitCrc32  Starting CRC value.
+ *  @param pBuffer      Data buffer to calculate the CRC from.
+ *  @param ulLength     Number of bytes of data in the given buffer.
+ *
+ *  @return The updated CRC value.
+ */
+static uint32_t Crc32Software( uint32_t ulInitCrc32,
+                               const void * pBuffer,
+                               uint32_t ulLength )
+{
+    #if CRC_SOFTWARE == CRC_BITWISE
+        return Crc32Bitwise( ulInitCrc32, pBuffer, ulLength );
+    #elif CRC_SOFTWARE == CRC_SARWATE
+        return Crc32Sarwate( ulInitCrc32, pBuffer, ulLength );
+    #else
+        return Crc32SliceBy8( ulInitCrc32, pBuffer, ulLength );
+    #endif
+}
+
+
+#if CRC_NEEDED( CRC_BITWISE )
 
 /*  The following is representative of the polynomial accepted by CCITT 32-bit
  *  and in IEEE 802.3, Ethernet 2 specification.
@@ -56,7 +207,7 @@
     #define CCITT_32_POLYNOMIAL    ( 0xEDB88320U )
 
 
-/** @brief Compute a CRC32 for the given data buffer.
+/** @brief Compute a CRC32 using the bitwise algorithm.
  *
  *  For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
  *  buffers, call this function with the previously returned CRC value.
@@ -67,9 +218,9 @@
  *
  *  @return The updated CRC value.
  */
-    uint32_t RedCrc32Update( uint32_t ulInitCrc32,
-                             const void * pBuffer,
-                             uint32_t ulLength )
+    static uint32_t Crc32Bitwise( uint32_t ulInitCrc32,
+                                  const void * pBuffer,
+                                  uint32_t ulLength )
     {
         uint32_t ulCrc32;
 
@@ -105,9 +256,12 @@
         return ulCrc32;
     }
 
-#elif REDCONF_CRC_ALGORITHM == CRC_SARWATE
+#endif /* CRC_NEEDED( CRC_BITWISE ) */
 
-/** @brief Compute a CRC32 for the given data buffer.
+
+#if CRC_NEEDED( CRC_SARWATE )
+
+/** @brief Compute a CRC32 using the Sarwate (table lookup) algorithm.
  *
  *  For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
  *  buffers, call this function with the previously returned CRC value.
@@ -118,9 +272,9 @@
  *
  *  @return The updated CRC value.
  */
-    uint32_t RedCrc32Update( uint32_t ulInitCrc32,
-                             const void * pBuffer,
-                             uint32_t ulLength )
+    static uint32_t Crc32Sarwate( uint32_t ulInitCrc32,
+                                  const void * pBuffer,
+                                  uint32_t ulLength )
     {
         static const uint32_t aulCrc32Table[] =
         {
@@ -183,10 +337,13 @@
         return ulCrc32;
     }
 
-#elif REDCONF_CRC_ALGORITHM == CRC_SLICEBY8
+#endif /* CRC_NEEDED( CRC_SARWATE ) */
 
 
-/** @brief Compute a CRC32 for the given data buffer.
+#if CRC_NEEDED( CRC_SLICEBY8 )
+
+
+/** @brief Compute a CRC32 using the slice-by-8 algorithm.
  *
  *  For CCITT-32 compliance, the initial CRC must be set to 0.  To CRC multiple
  *  buffers, call this function with the previously returned CRC value.
@@ -197,9 +354,9 @@
  *
  *  @return The updated CRC value.
  */
-    uint32_t RedCrc32Update( uint32_t ulInitCrc32,
-                             const void * pBuffer,
-                             uint32_t ulLength )
+    static uint32_t Crc32SliceBy8( uint32_t ulInitCrc32,
+                                   const void * pBuffer,
+                                   uint32_t ulLength )
     {
         /*  CRC32 XOR table, with slicing-by-8 extensions.
          *
@@ -557,11 +714,7 @@
         return ulCrc32;
     }
 
-#else /* if REDCONF_CRC_ALGORITHM == CRC_BITWISE */
-
-    #error "REDCONF_CRC_ALGORITHM must be set to CRC_BITWISE, CRC_SARWATE, or CRC_SLICEBY8"
-
-#endif /* if REDCONF_CRC_ALGORITHM == CRC_BITWISE */
+#endif /* CRC_NEEDED( CRC_SLICEBY8 ) */
 
 
 /** @brief Compute a CRC32 for a metadata node buffer.
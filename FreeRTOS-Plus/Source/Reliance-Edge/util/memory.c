@@ -27,10 +27,22 @@
 /** @file
  *  @brief Default implementations of memory manipulation functions.
  *
- *  These implementations are intended to be small and simple, and thus forego
- *  all optimizations.  If the C library is available, or if there are better
- *  third-party implementations available in the system, those can be used
- *  instead by defining the appropriate macros in redconf.h.
+ *  These implementations are intended to be small and simple.  When
+ *  REDCONF_MEM_WORD_ACCESS is enabled (the default), buffers which can be
+ *  brought to a common 32-bit alignment are processed a word at a time;
+ *  otherwise, and for short lengths, simple byte loops are used.  If the C
+ *  library is available, or if there are better third-party implementations
+ *  available in the system, those can be used instead by defining the
+ *  appropriate macros in redconf.h.
+ *
+ *  For large copies, such as whole blocks, a port can instead supply a DMA-
+ *  assisted or SIMD copy without replacing these functions: set
+ *  REDCONF_MEMCPY_HOOK_THRESHOLD to the smallest length worth offloading and
+ *  implement RedOsMemCpy().  RedOsMemCpy() may return false to decline a copy
+ *  (for example, if the DMA channel is busy or the buffers are not suitably
+ *  aligned), in which case the software copy is used.  RedOsMemCpy() must not
+ *  return until the copy is complete, and must handle any cache maintenance
+ *  which the DMA engine requires.
  *
  *  These functions are not intended to be completely 100% ANSI C compatible
  *  implementations, but rather are designed to meet the needs of Reliance Edge.
@@ -40,6 +52,12 @@
 #include <redfs.h>
 
 
+/*  Shortest length for which the word-at-a-time loops are used.  Below this,
+ *  the alignment checks are not worthwhile.
+ */
+#define MEM_WORD_MIN_LEN    16U
+
+
 #ifndef RedMemCpyUnchecked
     static void RedMemCpyUnchecked( void * pDest,
                                     const void * pSrc,
@@ -60,6 +78,11 @@
                                        const void * pMem2,
                                        uint32_t ulLen );
 #endif
+#if ( REDCONF_MEM_WORD_ACCESS == 1 ) && ( !defined( RedMemCpyUnchecked ) || !defined( RedMemMoveUnchecked ) )
+    static uint32_t MemCpyWords( void * pDest,
+                                 const void * pSrc,
+                                 uint32_t ulWords );
+#endif
 
 
 /** @brief Copy memory from one address to another.
@@ -102,11 +125,32 @@ void RedMemCpy( void * pDest,
     {
         uint8_t * pbDest = CAST_VOID_PTR_TO_UINT8_PTR( pDest );
         const uint8_t * pbSrc = CAST_VOID_PTR_TO_CONST_UINT8_PTR( pSrc );
-        uint32_t ulIdx;
+        uint32_t ulIdx = 0U;
+
+        #if REDCONF_MEMCPY_HOOK_THRESHOLD > 0U
+            if( ( ulLen >= REDCONF_MEMCPY_HOOK_THRESHOLD ) && RedOsMemCpy( pDest, pSrc, ulLen ) )
+            {
+                ulIdx = ulLen;
+            }
+        #endif
+
+        #if REDCONF_MEM_WORD_ACCESS == 1
+            if( ( ( ulLen - ulIdx ) >= MEM_WORD_MIN_LEN ) && ( WORD_OFFSET_PTR( pbDest ) == WORD_OFFSET_PTR( pbSrc ) ) )
+            {
+                while( WORD_OFFSET_PTR( &pbDest[ ulIdx ] ) != 0U )
+                {
+                    pbDest[ ulIdx ] = pbSrc[ ulIdx ];
+                    ulIdx++;
+                }
 
-        for( ulIdx = 0U; ulIdx < ulLen; ulIdx++ )
+                ulIdx += MemCpyWords( &pbDest[ ulIdx ], &pbSrc[ ulIdx ], ( ulLen - ulIdx ) / sizeof( uint32_t ) );
+            }
+        #endif
+
+        while( ulIdx < ulLen )
         {
             pbDest[ ulIdx ] = pbSrc[ ulIdx ];
+            ulIdx++;
         }
     }
 #endif /* ifndef RedMemCpyUnchecked */
@@ -165,15 +209,55 @@ void RedMemMove( void * pDest,
              *  with an implementation that cannot handle any kind of buffer
              *  overlap.
              */
-            for( ulIdx = 0U; ulIdx < ulLen; ulIdx++ )
+            ulIdx = 0U;
+
+            #if REDCONF_MEM_WORD_ACCESS == 1
+
+                /*  Copying words in ascending order is safe: with a common
+                 *  alignment, the destination is at least a word below the
+                 *  source, so each word is read before it is overwritten.
+                 */
+                if( ( ulLen >= MEM_WORD_MIN_LEN ) && ( WORD_OFFSET_PTR( pbDest ) == WORD_OFFSET_PTR( pbSrc ) ) )
+                {
+                    while( WORD_OFFSET_PTR( &pbDest[ ulIdx ] ) != 0U )
+                    {
+                        pbDest[ ulIdx ] = pbSrc[ ulIdx ];
+                        ulIdx++;
+                    }
+
+                    ulIdx += MemCpyWords( &pbDest[ ulIdx ], &pbSrc[ ulIdx ], ( ulLen - ulIdx ) / sizeof( uint32_t ) );
+                }
+            #endif
+
+            while( ulIdx < ulLen )
             {
                 pbDest[ ulIdx ] = pbSrc[ ulIdx ];
+                ulIdx++;
             }
         }
         else
         {
             ulIdx = ulLen;
 
+            #if REDCONF_MEM_WORD_ACCESS == 1
+                if( ( ulLen >= MEM_WORD_MIN_LEN ) && ( WORD_OFFSET_PTR( pbDest ) == WORD_OFFSET_PTR( pbSrc ) ) )
+                {
+                    while( WORD_OFFSET_PTR( &pbDest[ ulIdx ] ) != 0U )
+                    {
+                        ulIdx--;
+                        pbDest[ ulIdx ] = pbSrc[ ulIdx ];
+                    }
+
+                    /*  Copy whole words from the end towards the start.
+                     */
+                    while( ulIdx >= sizeof( uint32_t ) )
+                    {
+                        ulIdx -= sizeof( uint32_t );
+                        *CAST_VOID_PTR_TO_UINT32_PTR( &pbDest[ ulIdx ] ) = *CAST_CONST_UINT32_PTR( &pbSrc[ ulIdx ] );
+                    }
+                }
+            #endif
+
             while( ulIdx > 0U )
             {
                 ulIdx--;
@@ -220,11 +304,48 @@ void RedMemSet( void * pDest,
                                     uint32_t ulLen )
     {
         uint8_t * pbDest = CAST_VOID_PTR_TO_UINT8_PTR( pDest );
-        uint32_t ulIdx;
+        uint32_t ulIdx = 0U;
 
-        for( ulIdx = 0U; ulIdx < ulLen; ulIdx++ )
+        #if REDCONF_MEM_WORD_ACCESS == 1
+            if( ulLen >= MEM_WORD_MIN_LEN )
+            {
+                uint32_t ulVal = ( uint32_t ) bVal * 0x01010101U;
+                uint32_t * pulDest;
+                uint32_t ulWords;
+                uint32_t ulWordIdx = 0U;
+
+                while( WORD_OFFSET_PTR( &pbDest[ ulIdx ] ) != 0U )
+                {
+                    pbDest[ ulIdx ] = bVal;
+                    ulIdx++;
+                }
+
+                pulDest = CAST_VOID_PTR_TO_UINT32_PTR( &pbDest[ ulIdx ] );
+                ulWords = ( ulLen - ulIdx ) / sizeof( uint32_t );
+
+                while( ( ulWords - ulWordIdx ) >= 4U )
+                {
+                    pulDest[ ulWordIdx ] = ulVal;
+                    pulDest[ ulWordIdx + 1U ] = ulVal;
+                    pulDest[ ulWordIdx + 2U ] = ulVal;
+                    pulDest[ ulWordIdx + 3U ] = ulVal;
+                    ulWordIdx += 4U;
+                }
+
+                while( ulWordIdx < ulWords )
+                {
+                    pulDest[ ulWordIdx ] = ulVal;
+                    ulWordIdx++;
+                }
+
+                ulIdx += ulWords * sizeof( uint32_t );
+            }
+        #endif
+
+        while( ulIdx < ulLen )
         {
             pbDest[ ulIdx ] = bVal;
+            ulIdx++;
         }
     }
 #endif /* ifndef RedMemSetUnchecked */
@@ -283,6 +404,35 @@ int32_t RedMemCmp( const void * pMem1,
         uint32_t ulIdx = 0U;
         int32_t lResult;
 
+        #if REDCONF_MEM_WORD_ACCESS == 1
+
+            /*  Skip over equal words; the byte loop below then finds the first
+             *  differing byte, if any.
+             */
+            if( ( ulLen >= MEM_WORD_MIN_LEN ) && ( WORD_OFFSET_PTR( pbMem1 ) == WORD_OFFSET_PTR( pbMem2 ) ) )
+            {
+                while( ( WORD_OFFSET_PTR( &pbMem1[ ulIdx ] ) != 0U ) && ( pbMem1[ ulIdx ] == pbMem2[ ulIdx ] ) )
+                {
+                    ulIdx++;
+                }
+
+                if( WORD_OFFSET_PTR( &pbMem1[ ulIdx ] ) == 0U )
+                {
+                    const uint32_t * pulMem1 = CAST_CONST_UINT32_PTR( &pbMem1[ ulIdx ] );
+                    const uint32_t * pulMem2 = CAST_CONST_UINT32_PTR( &pbMem2[ ulIdx ] );
+                    uint32_t ulWords = ( ulLen - ulIdx ) / sizeof( uint32_t );
+                    uint32_t ulWordIdx = 0U;
+
+                    while( ( ulWordIdx < ulWords ) && ( pulMem1[ ulWordIdx ] == pulMem2[ ulWordIdx ] ) )
+                    {
+                        ulWordIdx++;
+                    }
+
+                    ulIdx += ulWordIdx * sizeof( uint32_t );
+                }
+            }
+        #endif
+
         while( ( ulIdx < ulLen ) && ( pbMem1[ ulIdx ] == pbMem2[ ulIdx ] ) )
         {
             ulIdx++;
@@ -304,3 +454,46 @@ int32_t RedMemCmp( const void * pMem1,
         return lResult;
     }
 #endif /* ifndef RedMemCmpUnchecked */
+
+
+#if ( REDCONF_MEM_WORD_ACCESS == 1 ) && ( !defined( RedMemCpyUnchecked ) || !defined( RedMemMoveUnchecked ) )
+
+/** @brief Copy 32-bit words from one address to another, in ascending order.
+ *
+ *  @param pDest    The destination buffer.  Must be 32-bit aligned.
+ *  @param pSrc     The source buffer.  Must be 32-bit aligned.
+ *  @param ulWords  The number of words to copy.
+ *
+ *  @return The number of bytes copied.
+ */
+    static uint32_t MemCpyWords( void * pDest,
+                                 const void * pSrc,
+                                 uint32_t ulWords )
+    {
+        uint32_t * pulDest = CAST_VOID_PTR_TO_UINT32_PTR( pDest );
+        const uint32_t * pulSrc = CAST_CONST_UINT32_PTR( pSrc );
+        uint32_t ulIdx = 0U;
+
+        REDASSERT( ( WORD_OFFSET_PTR( pDest ) == 0U ) && ( WORD_OFFSET_PTR( pSrc ) == 0U ) );
+
+        /*  Four words per iteration, which lets compilers use load and store
+         *  multiple instructions where the core has them.
+         */
+        while( ( ulWords - ulIdx ) >= 4U )
+        {
+            pulDest[ ulIdx ] = pulSrc[ ulIdx ];
+            pulDest[ ulIdx + 1U ] = pulSrc[ ulIdx + 1U ];
+            pulDest[ ulIdx + 2U ] = pulSrc[ ulIdx + 2U ];
+            pulDest[ ulIdx + 3U ] = pulSrc[ ulIdx + 3U ];
+            ulIdx += 4U;
+        }
+
+        while( ulIdx < ulWords )
+        {
+            pulDest[ ulIdx ] = pulSrc[ ulIdx ];
+            ulIdx++;
+        }
+
+        return ulWords * sizeof( uint32_t );
+    }
+#endif /* if ( REDCONF_MEM_WORD_ACCESS == 1 ) && ( !defined( RedMemCpyUnchecked ) || !defined( RedMemMoveUnchecked ) ) */
@@ -0,0 +1,161 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file arena.c
+ * @brief An arena allocator for objects that live for one transaction.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+#include "arena.h"
+
+/*-----------------------------------------------------------*/
+
+void vArenaInitStatic( Arena_t * pxArena,
+                       uint8_t * pucBuffer,
+                       size_t xSize )
+{
+    configASSERT( pxArena != NULL );
+    configASSERT( ( pucBuffer != NULL ) || ( xSize == 0U ) );
+
+    memset( pxArena, 0, sizeof( *pxArena ) );
+    pxArena->pucBuffer = pucBuffer;
+    pxArena->xSize = xSize;
+    pxArena->xDynamic = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xArenaInit( Arena_t * pxArena,
+                       size_t xSize )
+{
+    BaseType_t xReturn = pdFAIL;
+    uint8_t * pucBuffer;
+
+    configASSERT( pxArena != NULL );
+
+    pucBuffer = ( uint8_t * ) pvPortMalloc( xSize );
+
+    if( pucBuffer != NULL )
+    {
+        vArenaInitStatic( pxArena, pucBuffer, xSize );
+        pxArena->xDynamic = pdTRUE;
+        xReturn = pdPASS;
+    }
+    else
+    {
+        vArenaInitStatic( pxArena, NULL, 0U );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaDeinit( Arena_t * pxArena )
+{
+    configASSERT( pxArena != NULL );
+
+    if( pxArena->xDynamic != pdFALSE )
+    {
+        vPortFree( pxArena->pucBuffer );
+    }
+
+    vArenaInitStatic( pxArena, NULL, 0U );
+}
+/*-----------------------------------------------------------*/
+
+void * pvArenaAlloc( Arena_t * pxArena,
+                     size_t xSize )
+{
+    void * pvReturn = NULL;
+    uintptr_t uxAddress;
+    size_t xPadding;
+
+    configASSERT( pxArena != NULL );
+
+    /* Align the address rather than the offset, as the buffer provided to
+     * vArenaInitStatic() need not be aligned. */
+    uxAddress = ( uintptr_t ) &( pxArena->pucBuffer[ pxArena->xUsed ] );
+    xPadding = ( size_t ) ( ( arenaALIGNMENT - ( uxAddress % arenaALIGNMENT ) ) % arenaALIGNMENT );
+
+    /* Written so that neither sum can overflow. */
+    if( ( xPadding <= ( pxArena->xSize - pxArena->xUsed ) ) &&
+        ( xSize <= ( pxArena->xSize - pxArena->xUsed - xPadding ) ) )
+    {
+        pvReturn = &( pxArena->pucBuffer[ pxArena->xUsed + xPadding ] );
+        pxArena->xUsed += xPadding + xSize;
+
+        if( pxArena->xUsed > pxArena->xHighWater )
+        {
+            pxArena->xHighWater = pxArena->xUsed;
+        }
+    }
+    else
+    {
+        pxArena->ulFailures++;
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaReset( Arena_t * pxArena )
+{
+    configASSERT( pxArena != NULL );
+
+    pxArena->xUsed = 0U;
+}
+/*-----------------------------------------------------------*/
+
+ArenaMark_t xArenaGetMark( const Arena_t * pxArena )
+{
+    configASSERT( pxArena != NULL );
+
+    return pxArena->xUsed;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaResetToMark( Arena_t * pxArena,
+                        ArenaMark_t xMark )
+{
+    configASSERT( pxArena != NULL );
+    configASSERT( xMark <= pxArena->xUsed );
+
+    pxArena->xUsed = xMark;
+}
+/*-----------------------------------------------------------*/
+
+size_t xArenaGetHighWaterMark( const Arena_t * pxArena )
+{
+    configASSERT( pxArena != NULL );
+
+    return pxArena->xHighWater;
+}
+/*-----------------------------------------------------------*/
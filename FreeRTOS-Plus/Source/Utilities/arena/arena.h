@@ -0,0 +1,156 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file arena.h
+ * @brief An arena allocator for objects that live for one transaction.
+ *
+ * Objects are allocated from an arena by advancing an offset into its buffer,
+ * and are freed all at once by resetting the arena, typically at the end of
+ * each request or message.  Neither allocating nor resetting takes the heap
+ * lock, and as the buffer is reused whole it cannot fragment the heap.
+ *
+ * The buffer is either provided by the application, see vArenaInitStatic(), or
+ * allocated once from the FreeRTOS heap, see xArenaInit().  An arena is not
+ * thread safe; it is meant to be owned by one task.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief The alignment of the blocks returned by pvArenaAlloc().  Defaults to
+ * the alignment of the FreeRTOS heap.
+ */
+#ifndef arenaALIGNMENT
+    #define arenaALIGNMENT    portBYTE_ALIGNMENT
+#endif
+
+/**
+ * @brief An arena.  Initialise with vArenaInitStatic() or xArenaInit().
+ */
+typedef struct Arena
+{
+    uint8_t * pucBuffer;  /**< @brief The memory blocks are allocated from. */
+    size_t xSize;         /**< @brief The size of pucBuffer in bytes. */
+    size_t xUsed;         /**< @brief The bytes allocated since the last reset. */
+    size_t xHighWater;    /**< @brief The most bytes ever allocated at once. */
+    uint32_t ulFailures;  /**< @brief Allocations that did not fit. */
+    BaseType_t xDynamic;  /**< @brief pdTRUE if pucBuffer came from the heap. */
+} Arena_t;
+
+/**
+ * @brief A position in an arena, see xArenaGetMark().
+ */
+typedef size_t ArenaMark_t;
+
+/**
+ * @brief Initialise an arena on a buffer provided by the application.
+ *
+ * @param[out] pxArena The arena to initialise.
+ * @param[in] pucBuffer The memory to allocate from.  It must remain valid as
+ * long as the arena is used.
+ * @param[in] xSize The size of @p pucBuffer in bytes.
+ */
+void vArenaInitStatic( Arena_t * pxArena,
+                       uint8_t * pucBuffer,
+                       size_t xSize );
+
+/**
+ * @brief Initialise an arena on a buffer allocated from the FreeRTOS heap,
+ * released again by vArenaDeinit().
+ *
+ * @param[out] pxArena The arena to initialise.
+ * @param[in] xSize The size of the buffer in bytes.
+ *
+ * @return pdPASS if the buffer was allocated, otherwise pdFAIL.
+ */
+BaseType_t xArenaInit( Arena_t * pxArena,
+                       size_t xSize );
+
+/**
+ * @brief Release the buffer of an arena initialised with xArenaInit().  Does
+ * nothing to the buffer of an arena initialised with vArenaInitStatic().
+ *
+ * @param[in] pxArena The arena.
+ */
+void vArenaDeinit( Arena_t * pxArena );
+
+/**
+ * @brief Allocate a block of xSize bytes, aligned to #arenaALIGNMENT.
+ *
+ * @param[in] pxArena The arena to allocate from.
+ * @param[in] xSize The size of the block in bytes.
+ *
+ * @return The block, or NULL if the arena does not have xSize bytes left.
+ */
+void * pvArenaAlloc( Arena_t * pxArena,
+                     size_t xSize );
+
+/**
+ * @brief Free every block allocated from an arena.
+ *
+ * @param[in] pxArena The arena.
+ */
+void vArenaReset( Arena_t * pxArena );
+
+/**
+ * @brief Return the current position of an arena, so the blocks allocated
+ * after it can be freed with vArenaResetToMark() while earlier ones are kept.
+ *
+ * @param[in] pxArena The arena.
+ *
+ * @return The position.
+ */
+ArenaMark_t xArenaGetMark( const Arena_t * pxArena );
+
+/**
+ * @brief Free the blocks allocated since xArenaGetMark() returned xMark.
+ *
+ * @param[in] pxArena The arena.
+ * @param[in] xMark A position returned by xArenaGetMark() since the last
+ * reset.
+ */
+void vArenaResetToMark( Arena_t * pxArena,
+                        ArenaMark_t xMark );
+
+/**
+ * @brief Return the most bytes that were allocated from an arena between two
+ * resets, to help size its buffer.
+ *
+ * @param[in] pxArena The arena.
+ *
+ * @return The high water mark in bytes, including alignment padding.
+ */
+size_t xArenaGetHighWaterMark( const Arena_t * pxArena );
+
+#endif /* ifndef ARENA_H */
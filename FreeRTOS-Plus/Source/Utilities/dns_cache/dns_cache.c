@@ -0,0 +1,409 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file dns_cache.c
+ * @brief A cache of host name resolutions shared by the sockets wrapper ports.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dns_cache.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The resolution of one host name.
+ */
+typedef struct DnsCacheEntry
+{
+    char cHost[ dnscacheMAX_HOST_LENGTH ];
+    uint8_t ucAddress[ dnscacheADDRESS_SIZE ];
+    BaseType_t xInUse;
+    BaseType_t xResolved; /**< @brief pdFALSE for a cached failure. */
+    BaseType_t xUsed;     /**< @brief Whether a lookup returned the entry since it was stored, for prefetching. */
+    TickType_t xStored;   /**< @brief When the entry was stored. */
+    TickType_t xLifetime; /**< @brief Ticks from xStored until the entry expires. */
+    TickType_t xLastUsed; /**< @brief When a lookup last returned the entry, for eviction. */
+} DnsCacheEntry_t;
+
+/**
+ * @brief The entries of the cache.
+ */
+static DnsCacheEntry_t xEntries[ dnscacheMAX_ENTRIES ];
+
+/**
+ * @brief The counters of the cache.
+ */
+static DnsCacheStats_t xStats;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Convert milliseconds to ticks without overflowing for long times.
+ */
+static TickType_t prvMsToTicks( uint32_t ulMs );
+
+/**
+ * @brief Return whether two host names are equal, ignoring the case of ASCII
+ * letters as DNS does.
+ */
+static BaseType_t prvHostNamesMatch( const char * pcName1,
+                                     const char * pcName2 );
+
+/**
+ * @brief Return the entry of a host, or NULL.  Called in a critical section.
+ */
+static DnsCacheEntry_t * prvFindEntry( const char * pcHostName );
+
+/**
+ * @brief Return whether an entry has not expired.  Called in a critical
+ * section.
+ */
+static BaseType_t prvIsFresh( const DnsCacheEntry_t * pxEntry,
+                              TickType_t xNow );
+
+/**
+ * @brief Store a resolution, replacing the entry of the host, a free entry,
+ * an expired entry or the least recently used entry, in that order of
+ * preference.
+ */
+static void prvStore( const char * pcHostName,
+                      BaseType_t xResolved,
+                      const uint8_t * pucAddress,
+                      uint32_t ulTtlMs );
+
+/*-----------------------------------------------------------*/
+
+static TickType_t prvMsToTicks( uint32_t ulMs )
+{
+    return ( TickType_t ) ( ( ( uint64_t ) ulMs * ( uint64_t ) configTICK_RATE_HZ ) / 1000U );
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvHostNamesMatch( const char * pcName1,
+                                     const char * pcName2 )
+{
+    char cChar1, cChar2;
+
+    /* Fold the case locally: tolower() depends on the locale and strcasecmp()
+     * is not available with every toolchain. */
+    do
+    {
+        cChar1 = *pcName1;
+        cChar2 = *pcName2;
+        pcName1++;
+        pcName2++;
+
+        if( ( cChar1 >= 'A' ) && ( cChar1 <= 'Z' ) )
+        {
+            cChar1 = ( char ) ( cChar1 - 'A' + 'a' );
+        }
+
+        if( ( cChar2 >= 'A' ) && ( cChar2 <= 'Z' ) )
+        {
+            cChar2 = ( char ) ( cChar2 - 'A' + 'a' );
+        }
+    } while( ( cChar1 == cChar2 ) && ( cChar1 != '\0' ) );
+
+    return ( cChar1 == cChar2 ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+static DnsCacheEntry_t * prvFindEntry( const char * pcHostName )
+{
+    DnsCacheEntry_t * pxFound = NULL;
+    UBaseType_t uxIndex;
+
+    for( uxIndex = 0U; uxIndex < dnscacheMAX_ENTRIES; uxIndex++ )
+    {
+        if( ( xEntries[ uxIndex ].xInUse == pdTRUE ) &&
+            ( prvHostNamesMatch( xEntries[ uxIndex ].cHost, pcHostName ) == pdTRUE ) )
+        {
+            pxFound = &xEntries[ uxIndex ];
+            break;
+        }
+    }
+
+    return pxFound;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsFresh( const DnsCacheEntry_t * pxEntry,
+                              TickType_t xNow )
+{
+    return ( ( xNow - pxEntry->xStored ) < pxEntry->xLifetime ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvStore( const char * pcHostName,
+                      BaseType_t xResolved,
+                      const uint8_t * pucAddress,
+                      uint32_t ulTtlMs )
+{
+    DnsCacheEntry_t * pxEntry;
+    UBaseType_t uxIndex;
+    TickType_t xNow;
+
+    taskENTER_CRITICAL();
+    {
+        xNow = xTaskGetTickCount();
+        pxEntry = prvFindEntry( pcHostName );
+
+        for( uxIndex = 0U; ( pxEntry == NULL ) && ( uxIndex < dnscacheMAX_ENTRIES ); uxIndex++ )
+        {
+            if( xEntries[ uxIndex ].xInUse == pdFALSE )
+            {
+                pxEntry = &xEntries[ uxIndex ];
+            }
+        }
+
+        for( uxIndex = 0U; ( pxEntry == NULL ) && ( uxIndex < dnscacheMAX_ENTRIES ); uxIndex++ )
+        {
+            if( prvIsFresh( &xEntries[ uxIndex ], xNow ) == pdFALSE )
+            {
+                pxEntry = &xEntries[ uxIndex ];
+            }
+        }
+
+        if( pxEntry == NULL )
+        {
+            pxEntry = &xEntries[ 0 ];
+
+            for( uxIndex = 1U; uxIndex < dnscacheMAX_ENTRIES; uxIndex++ )
+            {
+                if( ( xNow - xEntries[ uxIndex ].xLastUsed ) > ( xNow - pxEntry->xLastUsed ) )
+                {
+                    pxEntry = &xEntries[ uxIndex ];
+                }
+            }
+        }
+
+        ( void ) strcpy( pxEntry->cHost, pcHostName );
+
+        if( pucAddress != NULL )
+        {
+            ( void ) memcpy( pxEntry->ucAddress, pucAddress, sizeof( pxEntry->ucAddress ) );
+        }
+
+        pxEntry->xInUse = pdTRUE;
+        pxEntry->xResolved = xResolved;
+        pxEntry->xUsed = pdFALSE;
+        pxEntry->xStored = xNow;
+        pxEntry->xLifetime = prvMsToTicks( ulTtlMs );
+        pxEntry->xLastUsed = xNow;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xDnsCacheLookup( const char * pcHostName,
+                            void * pvAddress,
+                            DnsCacheResolve_t xResolve )
+{
+    BaseType_t xReturn = pdFAIL;
+    BaseType_t xHit = pdFALSE;
+    DnsCacheEntry_t * pxEntry;
+    uint8_t ucAddress[ dnscacheADDRESS_SIZE ];
+    uint32_t ulTtlMs = dnscacheDEFAULT_TTL_MS;
+    BaseType_t xCacheable;
+
+    configASSERT( pcHostName != NULL );
+    configASSERT( pvAddress != NULL );
+    configASSERT( xResolve != NULL );
+
+    xCacheable = ( strlen( pcHostName ) < dnscacheMAX_HOST_LENGTH ) ? pdTRUE : pdFALSE;
+
+    if( xCacheable == pdTRUE )
+    {
+        taskENTER_CRITICAL();
+        {
+            TickType_t xNow = xTaskGetTickCount();
+
+            pxEntry = prvFindEntry( pcHostName );
+
+            if( ( pxEntry != NULL ) && ( prvIsFresh( pxEntry, xNow ) == pdTRUE ) )
+            {
+                xHit = pdTRUE;
+                xReturn = pxEntry->xResolved;
+                pxEntry->xUsed = pdTRUE;
+                pxEntry->xLastUsed = xNow;
+
+                if( xReturn == pdPASS )
+                {
+                    ( void ) memcpy( pvAddress, pxEntry->ucAddress, sizeof( pxEntry->ucAddress ) );
+                    xStats.ulHits++;
+                }
+                else
+                {
+                    xStats.ulNegativeHits++;
+                }
+            }
+            else
+            {
+                xStats.ulMisses++;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if( xHit == pdFALSE )
+    {
+        /* Several tasks may resolve the same name at once; the last one to
+         * finish stores its result. */
+        ( void ) memset( ucAddress, 0, sizeof( ucAddress ) );
+        xReturn = xResolve( pcHostName, ucAddress, &ulTtlMs );
+
+        if( xReturn == pdPASS )
+        {
+            ( void ) memcpy( pvAddress, ucAddress, sizeof( ucAddress ) );
+        }
+
+        if( xCacheable == pdTRUE )
+        {
+            if( xReturn == pdPASS )
+            {
+                prvStore( pcHostName, pdPASS, ucAddress, configMIN( ulTtlMs, dnscacheMAX_TTL_MS ) );
+            }
+            else
+            {
+                prvStore( pcHostName, pdFAIL, NULL, dnscacheNEGATIVE_TTL_MS );
+            }
+        }
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+void vDnsCacheInvalidate( const char * pcHostName )
+{
+    DnsCacheEntry_t * pxEntry;
+
+    configASSERT( pcHostName != NULL );
+
+    taskENTER_CRITICAL();
+    {
+        pxEntry = prvFindEntry( pcHostName );
+
+        if( pxEntry != NULL )
+        {
+            pxEntry->xInUse = pdFALSE;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxDnsCachePrefetch( DnsCacheResolve_t xResolve )
+{
+    UBaseType_t uxRefreshed = 0U;
+
+    #if ( dnscachePREFETCH_MS > 0U )
+        UBaseType_t uxIndex;
+        DnsCacheEntry_t * pxEntry;
+        char cHost[ dnscacheMAX_HOST_LENGTH ];
+        uint8_t ucAddress[ dnscacheADDRESS_SIZE ];
+        uint32_t ulTtlMs;
+        BaseType_t xDue;
+
+        configASSERT( xResolve != NULL );
+
+        for( uxIndex = 0U; uxIndex < dnscacheMAX_ENTRIES; uxIndex++ )
+        {
+            xDue = pdFALSE;
+
+            taskENTER_CRITICAL();
+            {
+                TickType_t xNow = xTaskGetTickCount();
+
+                pxEntry = &xEntries[ uxIndex ];
+
+                /* Only names in use are refreshed, so that a name which is no
+                 * longer looked up lapses. */
+                if( ( pxEntry->xInUse == pdTRUE ) &&
+                    ( pxEntry->xResolved == pdPASS ) &&
+                    ( pxEntry->xUsed == pdTRUE ) &&
+                    ( prvIsFresh( pxEntry, xNow ) == pdTRUE ) &&
+                    ( ( pxEntry->xLifetime - ( xNow - pxEntry->xStored ) ) <= prvMsToTicks( dnscachePREFETCH_MS ) ) )
+                {
+                    ( void ) strcpy( cHost, pxEntry->cHost );
+                    xDue = pdTRUE;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( xDue == pdTRUE )
+            {
+                ulTtlMs = dnscacheDEFAULT_TTL_MS;
+                ( void ) memset( ucAddress, 0, sizeof( ucAddress ) );
+
+                if( xResolve( cHost, ucAddress, &ulTtlMs ) == pdPASS )
+                {
+                    prvStore( cHost, pdPASS, ucAddress, configMIN( ulTtlMs, dnscacheMAX_TTL_MS ) );
+                    uxRefreshed++;
+
+                    taskENTER_CRITICAL();
+                    {
+                        xStats.ulPrefetches++;
+                    }
+                    taskEXIT_CRITICAL();
+                }
+            }
+        }
+    #else /* if ( dnscachePREFETCH_MS > 0U ) */
+        ( void ) xResolve;
+    #endif /* if ( dnscachePREFETCH_MS > 0U ) */
+
+    return uxRefreshed;
+}
+
+/*-----------------------------------------------------------*/
+
+void vDnsCacheGetStats( DnsCacheStats_t * pxStats )
+{
+    configASSERT( pxStats != NULL );
+
+    taskENTER_CRITICAL();
+    {
+        *pxStats = xStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,185 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file dns_cache.h
+ * @brief A cache of host name resolutions shared by the sockets wrapper ports.
+ *
+ * xDnsCacheLookup() returns the address of a host from the cache while its
+ * entry is fresh, and otherwise resolves the host with the resolver of the
+ * port and stores the result.  A failed resolution is cached too, for a
+ * shorter time, so that a reconnect storm against a name which does not
+ * resolve does not query the resolver on every attempt.  Host names are
+ * matched without regard to the case of ASCII letters, so "Example.COM" finds
+ * the entry stored for "example.com".
+ *
+ * The resolver may report the time to live of the record it found; otherwise
+ * an entry lives for #dnscacheDEFAULT_TTL_MS.  Entries which were used during
+ * their lifetime can be refreshed shortly before they expire by calling
+ * uxDnsCachePrefetch() periodically, so that the next connection finds a fresh
+ * entry instead of waiting for the resolver.
+ *
+ * The cache is protected by critical sections, and the resolver is called
+ * outside of them.
+ */
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+/* Standard includes. */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief The number of host names that are cached.  Defaults to 4.
+ */
+#ifndef dnscacheMAX_ENTRIES
+    #define dnscacheMAX_ENTRIES    4U
+#endif
+
+/**
+ * @brief The longest host name that is cached, including the terminating
+ * null.  Longer names are resolved every time.  Defaults to 128.
+ */
+#ifndef dnscacheMAX_HOST_LENGTH
+    #define dnscacheMAX_HOST_LENGTH    128U
+#endif
+
+/**
+ * @brief The size of the address stored for a host.  The address is opaque to
+ * the cache; its format is chosen by the resolver of the port.  Defaults to
+ * 48, which holds an IPv6 address in text form with its terminating null.
+ */
+#ifndef dnscacheADDRESS_SIZE
+    #define dnscacheADDRESS_SIZE    48U
+#endif
+
+/**
+ * @brief How long a resolution is cached when the resolver does not report a
+ * time to live, in milliseconds.  Zero disables the cache.  Defaults to 60 s.
+ */
+#ifndef dnscacheDEFAULT_TTL_MS
+    #define dnscacheDEFAULT_TTL_MS    60000U
+#endif
+
+/**
+ * @brief The longest time a resolution is cached, whatever time to live the
+ * resolver reports, in milliseconds.  Defaults to 1 hour.
+ */
+#ifndef dnscacheMAX_TTL_MS
+    #define dnscacheMAX_TTL_MS    3600000U
+#endif
+
+/**
+ * @brief How long a failed resolution is cached, in milliseconds.  Zero
+ * disables negative caching.  Defaults to 5 s.
+ */
+#ifndef dnscacheNEGATIVE_TTL_MS
+    #define dnscacheNEGATIVE_TTL_MS    5000U
+#endif
+
+/**
+ * @brief How long before it expires an entry is refreshed by
+ * uxDnsCachePrefetch(), in milliseconds.  Zero disables prefetching.
+ * Defaults to 0.
+ */
+#ifndef dnscachePREFETCH_MS
+    #define dnscachePREFETCH_MS    0U
+#endif
+
+/**
+ * @brief Resolve a host name.
+ *
+ * @param[in] pcHostName The host name to resolve.
+ * @param[out] pvAddress The #dnscacheADDRESS_SIZE bytes to fill in with the
+ * address of the host.
+ * @param[in, out] pulTtlMs Set to #dnscacheDEFAULT_TTL_MS on entry.  The
+ * resolver may set it to the time to live of the record it found.
+ *
+ * @return pdPASS if the host name was resolved, otherwise pdFAIL.
+ */
+typedef BaseType_t ( * DnsCacheResolve_t )( const char * pcHostName,
+                                            void * pvAddress,
+                                            uint32_t * pulTtlMs );
+
+/**
+ * @brief Counters of the cache, see vDnsCacheGetStats().
+ */
+typedef struct DnsCacheStats
+{
+    uint32_t ulHits;          /**< @brief Lookups answered by a fresh entry. */
+    uint32_t ulNegativeHits;  /**< @brief Lookups failed by a cached failure. */
+    uint32_t ulMisses;        /**< @brief Lookups which called the resolver. */
+    uint32_t ulPrefetches;    /**< @brief Entries refreshed by uxDnsCachePrefetch(). */
+} DnsCacheStats_t;
+
+/**
+ * @brief Return the address of a host, from the cache if it holds a fresh
+ * entry for the host, otherwise from the resolver.
+ *
+ * @param[in] pcHostName The host name to resolve.
+ * @param[out] pvAddress The #dnscacheADDRESS_SIZE bytes to fill in with the
+ * address of the host.
+ * @param[in] xResolve The resolver of the port.
+ *
+ * @return pdPASS if the address was returned; pdFAIL if the host name did not
+ * resolve, now or within the last #dnscacheNEGATIVE_TTL_MS.
+ */
+BaseType_t xDnsCacheLookup( const char * pcHostName,
+                            void * pvAddress,
+                            DnsCacheResolve_t xResolve );
+
+/**
+ * @brief Remove the entry of a host, so that the next lookup calls the
+ * resolver.  Call it when connecting to the cached address failed.
+ *
+ * @param[in] pcHostName The host name.
+ */
+void vDnsCacheInvalidate( const char * pcHostName );
+
+/**
+ * @brief Refresh the entries which were used since they were resolved and
+ * which expire within #dnscachePREFETCH_MS.
+ *
+ * Call it periodically, more often than #dnscachePREFETCH_MS, from a task
+ * which may block on the resolver.  An entry whose refresh fails keeps its
+ * address until it expires.
+ *
+ * @param[in] xResolve The resolver of the port.
+ *
+ * @return The number of entries refreshed.
+ */
+UBaseType_t uxDnsCachePrefetch( DnsCacheResolve_t xResolve );
+
+/**
+ * @brief Get the counters of the cache.
+ *
+ * @param[out] pxStats Filled in with the counters.
+ */
+void vDnsCacheGetStats( DnsCacheStats_t * pxStats );
+
+#endif /* ifndef DNS_CACHE_H */
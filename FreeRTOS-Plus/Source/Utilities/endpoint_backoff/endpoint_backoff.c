@@ -0,0 +1,290 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file endpoint_backoff.c
+ * @brief Reconnection backoff and circuit breaking shared by every task that
+ * connects to the same endpoint.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "endpoint_backoff.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The parameters used when pxEndpointBackoffGet() is not given any.
+ */
+static const EndpointBackoffConfig_t xDefaultConfig =
+{
+    .ulBaseDelayMs      = 500U,
+    .ulMaxDelayMs       = 5000U,
+    .ulFailureThreshold = 5U,
+    .ulOpenMs           = 30000U
+};
+
+/**
+ * @brief The state of each endpoint.
+ */
+static EndpointBackoff_t xEndpoints[ endpointbackoffMAX_ENDPOINTS ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Return the next delay of an endpoint with decorrelated jitter: a
+ * random time between the base delay and three times the previous delay,
+ * capped at the maximum delay.
+ */
+static uint32_t prvNextDelayMs( EndpointBackoff_t * pxBackoff,
+                                uint32_t ulRandom );
+
+/*-----------------------------------------------------------*/
+
+EndpointBackoff_t * pxEndpointBackoffGet( const char * pcHost,
+                                          uint16_t usPort,
+                                          const EndpointBackoffConfig_t * pxConfig )
+{
+    EndpointBackoff_t * pxReturn = NULL;
+    EndpointBackoff_t * pxFree = NULL;
+    size_t i;
+
+    configASSERT( pcHost != NULL );
+
+    vTaskSuspendAll();
+    {
+        for( i = 0; i < endpointbackoffMAX_ENDPOINTS; i++ )
+        {
+            if( xEndpoints[ i ].xInUse == pdFALSE )
+            {
+                if( pxFree == NULL )
+                {
+                    pxFree = &( xEndpoints[ i ] );
+                }
+            }
+            else if( ( xEndpoints[ i ].usPort == usPort ) &&
+                     ( strncmp( xEndpoints[ i ].cHost, pcHost, endpointbackoffMAX_HOST_LENGTH - 1U ) == 0 ) )
+            {
+                pxReturn = &( xEndpoints[ i ] );
+                break;
+            }
+        }
+
+        if( ( pxReturn == NULL ) && ( pxFree != NULL ) )
+        {
+            pxReturn = pxFree;
+            memset( pxReturn, 0, sizeof( *pxReturn ) );
+            strncpy( pxReturn->cHost, pcHost, endpointbackoffMAX_HOST_LENGTH - 1U );
+            pxReturn->usPort = usPort;
+            pxReturn->xConfig = ( pxConfig != NULL ) ? *pxConfig : xDefaultConfig;
+            pxReturn->eCircuit = eEndpointBackoffClosed;
+            pxReturn->ulPreviousDelayMs = pxReturn->xConfig.ulBaseDelayMs;
+            pxReturn->xLastChange = xTaskGetTickCount();
+            pxReturn->xInUse = pdTRUE;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEndpointBackoffTryAcquire( EndpointBackoff_t * pxBackoff,
+                                       TickType_t * pxWaitTicks )
+{
+    BaseType_t xReturn = pdFALSE;
+    TickType_t xNow;
+    TickType_t xElapsed;
+    uint32_t ulProbeMs;
+
+    configASSERT( pxBackoff != NULL );
+    configASSERT( pxWaitTicks != NULL );
+
+    *pxWaitTicks = 0U;
+
+    taskENTER_CRITICAL();
+    {
+        xNow = xTaskGetTickCount();
+        xElapsed = xNow - pxBackoff->xLastChange;
+
+        if( ( pxBackoff->eCircuit == eEndpointBackoffClosed ) &&
+            ( pxBackoff->ulConsecutiveFailures == 0U ) )
+        {
+            /* The endpoint is healthy. */
+            xReturn = pdTRUE;
+        }
+        else if( xElapsed >= pxBackoff->xWaitTicks )
+        {
+            /* The endpoint is failing, so let one task through and hold the
+             * others back until it reports the outcome.  Should the outcome
+             * never be reported, let another through after the longest time
+             * an attempt could be delayed for. */
+            if( pxBackoff->eCircuit == eEndpointBackoffOpen )
+            {
+                pxBackoff->eCircuit = eEndpointBackoffHalfOpen;
+            }
+
+            ulProbeMs = ( pxBackoff->xConfig.ulOpenMs > pxBackoff->xConfig.ulMaxDelayMs ) ?
+                        pxBackoff->xConfig.ulOpenMs : pxBackoff->xConfig.ulMaxDelayMs;
+            pxBackoff->xLastChange = xNow;
+            pxBackoff->xWaitTicks = pdMS_TO_TICKS( ulProbeMs );
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            *pxWaitTicks = pxBackoff->xWaitTicks - xElapsed;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xEndpointBackoffWait( EndpointBackoff_t * pxBackoff,
+                                 TickType_t xMaxWait )
+{
+    const TickType_t xPollTicks = pdMS_TO_TICKS( pxBackoff->xConfig.ulBaseDelayMs ) + 1U;
+    TimeOut_t xTimeOut;
+    TickType_t xRemaining = xMaxWait;
+    TickType_t xWaitTicks;
+    BaseType_t xReturn;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        xReturn = xEndpointBackoffTryAcquire( pxBackoff, &xWaitTicks );
+
+        if( ( xReturn == pdTRUE ) || ( xTaskCheckForTimeOut( &xTimeOut, &xRemaining ) != pdFALSE ) )
+        {
+            break;
+        }
+
+        /* Wake up at least every base delay, as a success reported by another
+         * task ends the wait early. */
+        xWaitTicks = ( xWaitTicks < xPollTicks ) ? xWaitTicks : xPollTicks;
+        xWaitTicks = ( xWaitTicks < xRemaining ) ? xWaitTicks : xRemaining;
+        vTaskDelay( ( xWaitTicks > 0U ) ? xWaitTicks : 1U );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vEndpointBackoffSuccess( EndpointBackoff_t * pxBackoff )
+{
+    configASSERT( pxBackoff != NULL );
+
+    taskENTER_CRITICAL();
+    {
+        pxBackoff->eCircuit = eEndpointBackoffClosed;
+        pxBackoff->ulConsecutiveFailures = 0U;
+        pxBackoff->ulPreviousDelayMs = pxBackoff->xConfig.ulBaseDelayMs;
+        pxBackoff->xLastChange = xTaskGetTickCount();
+        pxBackoff->xWaitTicks = 0U;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvNextDelayMs( EndpointBackoff_t * pxBackoff,
+                                uint32_t ulRandom )
+{
+    uint32_t ulBase = pxBackoff->xConfig.ulBaseDelayMs;
+    uint32_t ulUpper;
+    uint32_t ulDelay;
+
+    /* Three times the previous delay, without overflowing. */
+    ulUpper = ( pxBackoff->ulPreviousDelayMs > ( UINT32_MAX / 3U ) ) ? UINT32_MAX : ( pxBackoff->ulPreviousDelayMs * 3U );
+
+    if( ulUpper > ulBase )
+    {
+        ulDelay = ulBase + ( ulRandom % ( ulUpper - ulBase ) );
+    }
+    else
+    {
+        ulDelay = ulBase;
+    }
+
+    if( ulDelay > pxBackoff->xConfig.ulMaxDelayMs )
+    {
+        ulDelay = pxBackoff->xConfig.ulMaxDelayMs;
+    }
+
+    pxBackoff->ulPreviousDelayMs = ulDelay;
+
+    return ulDelay;
+}
+/*-----------------------------------------------------------*/
+
+TickType_t xEndpointBackoffFailure( EndpointBackoff_t * pxBackoff,
+                                    uint32_t ulRandom )
+{
+    TickType_t xReturn;
+    uint32_t ulDelayMs;
+
+    configASSERT( pxBackoff != NULL );
+
+    taskENTER_CRITICAL();
+    {
+        pxBackoff->ulConsecutiveFailures++;
+        ulDelayMs = prvNextDelayMs( pxBackoff, ulRandom );
+
+        /* A failed probe reopens the circuit straight away.  The open time
+         * has jitter too, so devices that lost the endpoint together do not
+         * all probe it together. */
+        if( ( pxBackoff->eCircuit == eEndpointBackoffHalfOpen ) ||
+            ( ( pxBackoff->xConfig.ulFailureThreshold != 0U ) &&
+              ( pxBackoff->ulConsecutiveFailures >= pxBackoff->xConfig.ulFailureThreshold ) ) )
+        {
+            pxBackoff->eCircuit = eEndpointBackoffOpen;
+            ulDelayMs = pxBackoff->xConfig.ulOpenMs +
+                        ( ( ulRandom >> 8 ) % ( ( pxBackoff->xConfig.ulOpenMs / 4U ) + 1U ) );
+        }
+
+        pxBackoff->xLastChange = xTaskGetTickCount();
+        pxBackoff->xWaitTicks = pdMS_TO_TICKS( ulDelayMs );
+        xReturn = pxBackoff->xWaitTicks;
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+EndpointBackoffCircuit_t eEndpointBackoffGetCircuit( const EndpointBackoff_t * pxBackoff )
+{
+    configASSERT( pxBackoff != NULL );
+
+    return pxBackoff->eCircuit;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,186 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file endpoint_backoff.h
+ * @brief Reconnection backoff and circuit breaking shared by every task that
+ * connects to the same endpoint.
+ *
+ * Each endpoint (host and port) has one EndpointBackoff_t, found with
+ * pxEndpointBackoffGet().  Before connecting a task calls
+ * xEndpointBackoffWait(), and afterwards reports the outcome with
+ * vEndpointBackoffSuccess() or xEndpointBackoffFailure().  While an endpoint is
+ * failing every task waits for the same retry time, rather than each task
+ * running its own retry loop against it.
+ *
+ * The delay after each failure uses decorrelated jitter: a random time between
+ * the base delay and three times the previous delay, capped at the maximum
+ * delay.  Once the delay has passed a single task is let through, and the
+ * others wait for its outcome.  After ulFailureThreshold consecutive failures
+ * the circuit opens and no attempt is allowed for ulOpenMs, plus a random
+ * part of up to a quarter of it.  Then a single task is let through as a
+ * probe; the circuit closes again if it succeeds and reopens if it fails.  A
+ * success resets the delay to the base delay.
+ */
+
+#ifndef ENDPOINT_BACKOFF_H
+#define ENDPOINT_BACKOFF_H
+
+/* Standard includes. */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief The number of endpoints that can have backoff state.  Defaults to 4.
+ */
+#ifndef endpointbackoffMAX_ENDPOINTS
+    #define endpointbackoffMAX_ENDPOINTS    4U
+#endif
+
+/**
+ * @brief The longest host name that can be told apart from others, including
+ * the terminating null.  Defaults to 128.
+ */
+#ifndef endpointbackoffMAX_HOST_LENGTH
+    #define endpointbackoffMAX_HOST_LENGTH    128U
+#endif
+
+/**
+ * @brief The state of the circuit of an endpoint.
+ */
+typedef enum EndpointBackoffCircuit
+{
+    eEndpointBackoffClosed = 0, /**< @brief Attempts are allowed once the retry time has passed. */
+    eEndpointBackoffOpen,       /**< @brief No attempt is allowed until the open time has passed. */
+    eEndpointBackoffHalfOpen    /**< @brief One probe attempt is in progress. */
+} EndpointBackoffCircuit_t;
+
+/**
+ * @brief The parameters of the backoff of an endpoint.
+ */
+typedef struct EndpointBackoffConfig
+{
+    uint32_t ulBaseDelayMs;      /**< @brief The shortest delay after a failure. */
+    uint32_t ulMaxDelayMs;       /**< @brief The longest delay after a failure. */
+    uint32_t ulFailureThreshold; /**< @brief Consecutive failures that open the circuit, 0 for never. */
+    uint32_t ulOpenMs;           /**< @brief How long the circuit stays open. */
+} EndpointBackoffConfig_t;
+
+/**
+ * @brief The backoff state of one endpoint.
+ *
+ * @note The members are private to endpoint_backoff.c.
+ */
+typedef struct EndpointBackoff
+{
+    char cHost[ endpointbackoffMAX_HOST_LENGTH ];
+    uint16_t usPort;
+    BaseType_t xInUse;
+    EndpointBackoffConfig_t xConfig;
+    EndpointBackoffCircuit_t eCircuit;
+    uint32_t ulConsecutiveFailures;
+    uint32_t ulPreviousDelayMs;
+    TickType_t xLastChange;  /**< @brief When the retry time or the circuit state was set. */
+    TickType_t xWaitTicks;   /**< @brief Ticks from xLastChange until an attempt is allowed. */
+} EndpointBackoff_t;
+
+/**
+ * @brief Return the backoff state of an endpoint, creating it if this is the
+ * first call for the endpoint.
+ *
+ * @param[in] pcHost The host name of the endpoint.
+ * @param[in] usPort The port of the endpoint.
+ * @param[in] pxConfig The parameters used when the state is created, or NULL
+ * for a 500 ms base delay, a 5 s maximum delay, and a circuit that opens for
+ * 30 s after 5 failures.
+ *
+ * @return The state, or NULL if #endpointbackoffMAX_ENDPOINTS endpoints have
+ * state already.
+ */
+EndpointBackoff_t * pxEndpointBackoffGet( const char * pcHost,
+                                          uint16_t usPort,
+                                          const EndpointBackoffConfig_t * pxConfig );
+
+/**
+ * @brief Return whether an attempt to connect to an endpoint is allowed now.
+ * Does not block.
+ *
+ * Lets one caller through as the probe when an open circuit times out.
+ *
+ * @param[in] pxBackoff The state of the endpoint.
+ * @param[out] pxWaitTicks When the attempt is not allowed, set to the ticks to
+ * wait before asking again.
+ *
+ * @return pdTRUE if the caller may attempt to connect, otherwise pdFALSE.
+ */
+BaseType_t xEndpointBackoffTryAcquire( EndpointBackoff_t * pxBackoff,
+                                       TickType_t * pxWaitTicks );
+
+/**
+ * @brief Block until an attempt to connect to an endpoint is allowed, or until
+ * xMaxWait ticks have passed.
+ *
+ * @param[in] pxBackoff The state of the endpoint.
+ * @param[in] xMaxWait The most ticks to wait, portMAX_DELAY for no limit.
+ *
+ * @return pdTRUE if the caller may attempt to connect, otherwise pdFALSE.
+ */
+BaseType_t xEndpointBackoffWait( EndpointBackoff_t * pxBackoff,
+                                 TickType_t xMaxWait );
+
+/**
+ * @brief Report that an attempt to connect to an endpoint succeeded, which
+ * closes its circuit and resets its delay.
+ *
+ * @param[in] pxBackoff The state of the endpoint.
+ */
+void vEndpointBackoffSuccess( EndpointBackoff_t * pxBackoff );
+
+/**
+ * @brief Report that an attempt to connect to an endpoint failed, which sets
+ * the next retry time of every task connecting to it.
+ *
+ * @param[in] pxBackoff The state of the endpoint.
+ * @param[in] ulRandom A random number for the jitter.  It is recommended to
+ * seed the random number generator with a device specific entropy source, so
+ * that different devices do not retry at the same times.
+ *
+ * @return The ticks until the next attempt is allowed.
+ */
+TickType_t xEndpointBackoffFailure( EndpointBackoff_t * pxBackoff,
+                                    uint32_t ulRandom );
+
+/**
+ * @brief Return the state of the circuit of an endpoint.
+ *
+ * @param[in] pxBackoff The state of the endpoint.
+ *
+ * @return The state of the circuit.
+ */
+EndpointBackoffCircuit_t eEndpointBackoffGetCircuit( const EndpointBackoff_t * pxBackoff );
+
+#endif /* ifndef ENDPOINT_BACKOFF_H */
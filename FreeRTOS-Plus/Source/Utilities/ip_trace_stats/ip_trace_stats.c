@@ -0,0 +1,728 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file ip_trace_stats.c
+ * @brief Counters, levels and latency samples of the FreeRTOS+TCP hot paths.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ip_trace_stats.h"
+
+/*-----------------------------------------------------------*/
+
+/* The state is also updated from interrupts, so every section that touches
+ * it masks interrupts, which is allowed from tasks as well. */
+#define iptracestatsENTER_CRITICAL()    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR()
+#define iptracestatsEXIT_CRITICAL()     taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus )
+
+/* The offsets of the fields that are read from the frames. */
+#define iptracestatsETHERNET_HEADER_LENGTH    14U
+#define iptracestatsETHERTYPE_OFFSET          12U
+#define iptracestatsETHERTYPE_IPV4            0x0800U
+#define iptracestatsETHERTYPE_IPV6            0x86DDU
+#define iptracestatsIPV6_HEADER_LENGTH        40U
+#define iptracestatsPROTOCOL_TCP              6U
+#define iptracestatsPROTOCOL_UDP              17U
+#define iptracestatsTCP_FLAG_FIN              0x01U
+#define iptracestatsTCP_FLAG_SYN              0x02U
+#define iptracestatsTCP_MIN_HEADER_LENGTH     20U
+#define iptracestatsUDP_HEADER_LENGTH         8U
+
+/**
+ * @brief The transport header of a frame, as read by prvParseFrame().
+ */
+typedef struct FrameInfo
+{
+    const uint8_t * pucSourceAddress;      /**< @brief The source address in the frame. */
+    const uint8_t * pucDestinationAddress; /**< @brief The destination address in the frame. */
+    uint16_t usSourcePort;                 /**< @brief The source port. */
+    uint16_t usDestinationPort;            /**< @brief The destination port. */
+    uint8_t ucProtocol;                    /**< @brief TCP or UDP. */
+    uint8_t ucIPVersion;                   /**< @brief 4 or 6. */
+    uint32_t ulPayloadLength;              /**< @brief The length of the TCP or UDP payload. */
+    uint32_t ulSequence;                   /**< @brief The sequence number of a TCP segment. */
+    uint32_t ulSequenceLength;             /**< @brief The sequence space a TCP segment takes, SYN and FIN included. */
+} FrameInfo_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The names of the counters, in the order of IPTraceStatsCounter_t.
+ */
+static const char * const pcCounterNames[ eIPTraceStatsCounters ] =
+{
+    "rx_frames",
+    "tx_frames",
+    "rx_bytes",
+    "tx_bytes",
+    "buffers_obtained",
+    "buffers_released",
+    "buffer_failures",
+    "rx_events_lost",
+    "tx_events_lost",
+    "arp_drops",
+    "socket_create_failures",
+    "bind_failures",
+    "recv_timeouts",
+    "send_too_long",
+    "send_not_bound",
+    "send_no_buffer",
+    "tx_dma_waits",
+    "select_notify_failures",
+    "tcp_retransmits",
+    "flows_replaced"
+};
+
+/**
+ * @brief The counters.
+ */
+static uint32_t ulCounters[ eIPTraceStatsCounters ];
+
+/**
+ * @brief The levels, and the summary of the latency samples.
+ */
+static IPTraceStatsLevels_t xLevels = { .ulLowestFreeBuffers = UINT32_MAX };
+
+/**
+ * @brief The flows.
+ */
+static IPTraceStatsFlow_t xFlows[ iptracestatsMAX_FLOWS ];
+
+/**
+ * @brief The times the frames waiting for the IP task were received, a FIFO
+ * of xLevels.ulPendingRxFrames entries from uxRxHead.
+ */
+static uint32_t ulRxTimes[ iptracestatsPENDING_RX_FRAMES ];
+static UBaseType_t uxRxHead;
+
+/**
+ * @brief The ring of latency samples, the next of which is written at
+ * uxNextSample.
+ */
+static uint32_t ulSampleTimes[ iptracestatsLATENCY_SAMPLES ];
+static uint32_t ulSampleLatencies[ iptracestatsLATENCY_SAMPLES ];
+static UBaseType_t uxNextSample;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read a big endian 16 bit field of a frame.
+ *
+ * @param[in] pucField The field.
+ *
+ * @return The value of the field.
+ */
+static uint16_t prvRead16( const uint8_t * pucField );
+
+/**
+ * @brief Read a big endian 32 bit field of a frame.
+ *
+ * @param[in] pucField The field.
+ *
+ * @return The value of the field.
+ */
+static uint32_t prvRead32( const uint8_t * pucField );
+
+/**
+ * @brief Read the addresses, ports and payload length of a TCP or UDP frame.
+ *
+ * @param[in] pucFrame The Ethernet frame.
+ * @param[in] uxLength The length of the frame.
+ * @param[out] pxInfo The fields of the frame.
+ *
+ * @return pdPASS if the frame carries TCP or UDP, otherwise pdFAIL.
+ */
+static BaseType_t prvParseFrame( const uint8_t * pucFrame,
+                                 size_t uxLength,
+                                 FrameInfo_t * pxInfo );
+
+/**
+ * @brief Find the flow of a frame, or start one.  Called in a critical
+ * section.
+ *
+ * @param[in] pxInfo The fields of the frame.
+ * @param[in] pucRemoteAddress The remote address, in the frame.
+ * @param[in] usLocalPort The local port.
+ * @param[in] usRemotePort The remote port.
+ * @param[in] ulNow The current timestamp.
+ *
+ * @return The flow.
+ */
+static IPTraceStatsFlow_t * prvFindFlow( const FrameInfo_t * pxInfo,
+                                         const uint8_t * pucRemoteAddress,
+                                         uint16_t usLocalPort,
+                                         uint16_t usRemotePort,
+                                         uint32_t ulNow );
+
+/**
+ * @brief Write a little endian field of a snapshot.
+ *
+ * @param[in] pucBuffer The field.
+ * @param[in] ulValue The value.
+ * @param[in] uxBytes The size of the field, 1, 2 or 4.
+ *
+ * @return The byte after the field.
+ */
+static uint8_t * prvWrite( uint8_t * pucBuffer,
+                           uint32_t ulValue,
+                           size_t uxBytes );
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvRead16( const uint8_t * pucField )
+{
+    return ( uint16_t ) ( ( ( uint16_t ) pucField[ 0 ] << 8 ) | ( uint16_t ) pucField[ 1 ] );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRead32( const uint8_t * pucField )
+{
+    return ( ( uint32_t ) pucField[ 0 ] << 24 ) | ( ( uint32_t ) pucField[ 1 ] << 16 ) |
+           ( ( uint32_t ) pucField[ 2 ] << 8 ) | ( uint32_t ) pucField[ 3 ];
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvParseFrame( const uint8_t * pucFrame,
+                                 size_t uxLength,
+                                 FrameInfo_t * pxInfo )
+{
+    BaseType_t xResult = pdFAIL;
+    const uint8_t * pucIP = &( pucFrame[ iptracestatsETHERNET_HEADER_LENGTH ] );
+    const uint8_t * pucTransport = NULL;
+    size_t uxTransportLength = 0U;
+    size_t uxHeaderLength;
+    uint16_t usEthertype;
+
+    if( ( pucFrame != NULL ) && ( uxLength > iptracestatsETHERNET_HEADER_LENGTH ) )
+    {
+        usEthertype = prvRead16( &( pucFrame[ iptracestatsETHERTYPE_OFFSET ] ) );
+        uxLength -= iptracestatsETHERNET_HEADER_LENGTH;
+
+        if( ( usEthertype == iptracestatsETHERTYPE_IPV4 ) && ( uxLength >= 20U ) )
+        {
+            uxHeaderLength = ( size_t ) ( pucIP[ 0 ] & 0x0FU ) * 4U;
+
+            /* The transport header is only in the first fragment. */
+            if( ( uxHeaderLength >= 20U ) &&
+                ( ( prvRead16( &( pucIP[ 6 ] ) ) & 0x1FFFU ) == 0U ) &&
+                ( prvRead16( &( pucIP[ 2 ] ) ) <= uxLength ) &&
+                ( prvRead16( &( pucIP[ 2 ] ) ) > uxHeaderLength ) )
+            {
+                pxInfo->ucIPVersion = 4U;
+                pxInfo->ucProtocol = pucIP[ 9 ];
+                pxInfo->pucSourceAddress = &( pucIP[ 12 ] );
+                pxInfo->pucDestinationAddress = &( pucIP[ 16 ] );
+                pucTransport = &( pucIP[ uxHeaderLength ] );
+                uxTransportLength = ( size_t ) prvRead16( &( pucIP[ 2 ] ) ) - uxHeaderLength;
+            }
+        }
+        else if( ( usEthertype == iptracestatsETHERTYPE_IPV6 ) && ( uxLength >= iptracestatsIPV6_HEADER_LENGTH ) )
+        {
+            /* Only a transport header right after the fixed header is read. */
+            if( prvRead16( &( pucIP[ 4 ] ) ) <= ( uxLength - iptracestatsIPV6_HEADER_LENGTH ) )
+            {
+                pxInfo->ucIPVersion = 6U;
+                pxInfo->ucProtocol = pucIP[ 6 ];
+                pxInfo->pucSourceAddress = &( pucIP[ 8 ] );
+                pxInfo->pucDestinationAddress = &( pucIP[ 24 ] );
+                pucTransport = &( pucIP[ iptracestatsIPV6_HEADER_LENGTH ] );
+                uxTransportLength = ( size_t ) prvRead16( &( pucIP[ 4 ] ) );
+            }
+        }
+        else
+        {
+            /* ARP and others are only counted. */
+        }
+    }
+
+    if( pucTransport != NULL )
+    {
+        if( ( pxInfo->ucProtocol == iptracestatsPROTOCOL_TCP ) && ( uxTransportLength >= iptracestatsTCP_MIN_HEADER_LENGTH ) )
+        {
+            uxHeaderLength = ( size_t ) ( pucTransport[ 12 ] >> 4 ) * 4U;
+
+            if( ( uxHeaderLength >= iptracestatsTCP_MIN_HEADER_LENGTH ) && ( uxHeaderLength <= uxTransportLength ) )
+            {
+                pxInfo->usSourcePort = prvRead16( &( pucTransport[ 0 ] ) );
+                pxInfo->usDestinationPort = prvRead16( &( pucTransport[ 2 ] ) );
+                pxInfo->ulSequence = prvRead32( &( pucTransport[ 4 ] ) );
+                pxInfo->ulPayloadLength = ( uint32_t ) ( uxTransportLength - uxHeaderLength );
+                pxInfo->ulSequenceLength = pxInfo->ulPayloadLength;
+
+                if( ( pucTransport[ 13 ] & iptracestatsTCP_FLAG_SYN ) != 0U )
+                {
+                    pxInfo->ulSequenceLength++;
+                }
+
+                if( ( pucTransport[ 13 ] & iptracestatsTCP_FLAG_FIN ) != 0U )
+                {
+                    pxInfo->ulSequenceLength++;
+                }
+
+                xResult = pdPASS;
+            }
+        }
+        else if( ( pxInfo->ucProtocol == iptracestatsPROTOCOL_UDP ) && ( uxTransportLength >= iptracestatsUDP_HEADER_LENGTH ) )
+        {
+            pxInfo->usSourcePort = prvRead16( &( pucTransport[ 0 ] ) );
+            pxInfo->usDestinationPort = prvRead16( &( pucTransport[ 2 ] ) );
+            pxInfo->ulPayloadLength = ( uint32_t ) ( uxTransportLength - iptracestatsUDP_HEADER_LENGTH );
+            pxInfo->ulSequence = 0U;
+            pxInfo->ulSequenceLength = 0U;
+            xResult = pdPASS;
+        }
+        else
+        {
+            /* ICMP and others are only counted. */
+        }
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static IPTraceStatsFlow_t * prvFindFlow( const FrameInfo_t * pxInfo,
+                                         const uint8_t * pucRemoteAddress,
+                                         uint16_t usLocalPort,
+                                         uint16_t usRemotePort,
+                                         uint32_t ulNow )
+{
+    IPTraceStatsFlow_t * pxFlow = NULL;
+    IPTraceStatsFlow_t * pxIdlest = &( xFlows[ 0 ] );
+    size_t uxAddressLength = ( pxInfo->ucIPVersion == 4U ) ? 4U : 16U;
+    UBaseType_t uxIndex;
+
+    for( uxIndex = 0U; uxIndex < iptracestatsMAX_FLOWS; uxIndex++ )
+    {
+        if( ( xFlows[ uxIndex ].usLocalPort == usLocalPort ) &&
+            ( xFlows[ uxIndex ].usRemotePort == usRemotePort ) &&
+            ( xFlows[ uxIndex ].ucProtocol == pxInfo->ucProtocol ) &&
+            ( xFlows[ uxIndex ].ucIPVersion == pxInfo->ucIPVersion ) &&
+            ( memcmp( xFlows[ uxIndex ].ucRemoteAddress, pucRemoteAddress, uxAddressLength ) == 0 ) )
+        {
+            pxFlow = &( xFlows[ uxIndex ] );
+            break;
+        }
+
+        /* An unused entry is the idlest, then the one idle for the longest
+         * time. */
+        if( pxIdlest->usLocalPort != 0U )
+        {
+            if( ( xFlows[ uxIndex ].usLocalPort == 0U ) ||
+                ( ( ulNow - xFlows[ uxIndex ].ulLastActive ) > ( ulNow - pxIdlest->ulLastActive ) ) )
+            {
+                pxIdlest = &( xFlows[ uxIndex ] );
+            }
+        }
+    }
+
+    if( pxFlow == NULL )
+    {
+        if( pxIdlest->usLocalPort != 0U )
+        {
+            ulCounters[ eIPTraceStatsFlowsReplaced ]++;
+        }
+
+        pxFlow = pxIdlest;
+        ( void ) memset( pxFlow, 0, sizeof( *pxFlow ) );
+        ( void ) memcpy( pxFlow->ucRemoteAddress, pucRemoteAddress, uxAddressLength );
+        pxFlow->usLocalPort = usLocalPort;
+        pxFlow->usRemotePort = usRemotePort;
+        pxFlow->ucProtocol = pxInfo->ucProtocol;
+        pxFlow->ucIPVersion = pxInfo->ucIPVersion;
+    }
+
+    pxFlow->ulLastActive = ulNow;
+
+    return pxFlow;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t * prvWrite( uint8_t * pucBuffer,
+                           uint32_t ulValue,
+                           size_t uxBytes )
+{
+    size_t uxIndex;
+
+    for( uxIndex = 0U; uxIndex < uxBytes; uxIndex++ )
+    {
+        pucBuffer[ uxIndex ] = ( uint8_t ) ( ulValue >> ( 8U * uxIndex ) );
+    }
+
+    return &( pucBuffer[ uxBytes ] );
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsReset( void )
+{
+    iptracestatsENTER_CRITICAL();
+    {
+        ( void ) memset( ulCounters, 0, sizeof( ulCounters ) );
+        ( void ) memset( &xLevels, 0, sizeof( xLevels ) );
+        ( void ) memset( xFlows, 0, sizeof( xFlows ) );
+        xLevels.ulLowestFreeBuffers = UINT32_MAX;
+        uxRxHead = 0U;
+        uxNextSample = 0U;
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsCount( IPTraceStatsCounter_t eCounter )
+{
+    if( eCounter < eIPTraceStatsCounters )
+    {
+        iptracestatsENTER_CRITICAL();
+        {
+            ulCounters[ eCounter ]++;
+        }
+        iptracestatsEXIT_CRITICAL();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsBufferObtained( UBaseType_t uxFreeBuffers )
+{
+    iptracestatsENTER_CRITICAL();
+    {
+        ulCounters[ eIPTraceStatsBufferObtained ]++;
+
+        if( ( uint32_t ) uxFreeBuffers < xLevels.ulLowestFreeBuffers )
+        {
+            xLevels.ulLowestFreeBuffers = ( uint32_t ) uxFreeBuffers;
+        }
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsEventReceived( UBaseType_t uxDepth )
+{
+    uint32_t ulStale;
+
+    iptracestatsENTER_CRITICAL();
+    {
+        if( ( uint32_t ) uxDepth > xLevels.ulDeepestEventQueue )
+        {
+            xLevels.ulDeepestEventQueue = ( uint32_t ) uxDepth;
+        }
+
+        /* At most one frame waits per event in the queue, so the oldest
+         * times beyond that are of frames the driver filtered out. */
+        if( xLevels.ulPendingRxFrames > ( uint32_t ) uxDepth )
+        {
+            ulStale = xLevels.ulPendingRxFrames - ( uint32_t ) uxDepth;
+            uxRxHead = ( uxRxHead + ( UBaseType_t ) ulStale ) % iptracestatsPENDING_RX_FRAMES;
+            xLevels.ulPendingRxFrames = ( uint32_t ) uxDepth;
+        }
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsRxFrame( void )
+{
+    uint32_t ulNow = iptracestatsGET_TIMESTAMP();
+
+    iptracestatsENTER_CRITICAL();
+    {
+        ulCounters[ eIPTraceStatsRxFrames ]++;
+
+        /* When the FIFO is full the oldest time is forgotten. */
+        if( xLevels.ulPendingRxFrames == iptracestatsPENDING_RX_FRAMES )
+        {
+            uxRxHead = ( uxRxHead + 1U ) % iptracestatsPENDING_RX_FRAMES;
+            xLevels.ulPendingRxFrames--;
+        }
+
+        ulRxTimes[ ( uxRxHead + ( UBaseType_t ) xLevels.ulPendingRxFrames ) % iptracestatsPENDING_RX_FRAMES ] = ulNow;
+        xLevels.ulPendingRxFrames++;
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsRxFrameLost( void )
+{
+    iptracestatsENTER_CRITICAL();
+    {
+        ulCounters[ eIPTraceStatsRxEventLost ]++;
+
+        if( xLevels.ulPendingRxFrames > 0U )
+        {
+            /* The frame lost is the newest one. */
+            xLevels.ulPendingRxFrames--;
+        }
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsFrameInput( const uint8_t * pucFrame,
+                              size_t uxLength )
+{
+    FrameInfo_t xInfo = { 0 };
+    IPTraceStatsFlow_t * pxFlow;
+    BaseType_t xParsed = prvParseFrame( pucFrame, uxLength, &xInfo );
+    uint32_t ulNow = iptracestatsGET_TIMESTAMP();
+    uint32_t ulLatency;
+
+    iptracestatsENTER_CRITICAL();
+    {
+        ulCounters[ eIPTraceStatsRxBytes ] += ( uint32_t ) uxLength;
+
+        if( xLevels.ulPendingRxFrames > 0U )
+        {
+            ulLatency = ulNow - ulRxTimes[ uxRxHead ];
+            uxRxHead = ( uxRxHead + 1U ) % iptracestatsPENDING_RX_FRAMES;
+            xLevels.ulPendingRxFrames--;
+
+            ulSampleTimes[ uxNextSample ] = ulNow;
+            ulSampleLatencies[ uxNextSample ] = ulLatency;
+            uxNextSample = ( uxNextSample + 1U ) % iptracestatsLATENCY_SAMPLES;
+
+            if( ( xLevels.ulLatencyCount == 0U ) || ( ulLatency < xLevels.ulLatencyMin ) )
+            {
+                xLevels.ulLatencyMin = ulLatency;
+            }
+
+            if( ulLatency > xLevels.ulLatencyMax )
+            {
+                xLevels.ulLatencyMax = ulLatency;
+            }
+
+            xLevels.ulLatencyCount++;
+            xLevels.ulLatencyTotal += ulLatency;
+        }
+
+        if( xParsed == pdPASS )
+        {
+            pxFlow = prvFindFlow( &xInfo, xInfo.pucSourceAddress, xInfo.usDestinationPort, xInfo.usSourcePort, ulNow );
+            pxFlow->ulRxBytes += xInfo.ulPayloadLength;
+            pxFlow->ulRxSegments++;
+        }
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsFrameOutput( const uint8_t * pucFrame,
+                               size_t uxLength )
+{
+    FrameInfo_t xInfo = { 0 };
+    IPTraceStatsFlow_t * pxFlow;
+    BaseType_t xParsed = prvParseFrame( pucFrame, uxLength, &xInfo );
+    uint32_t ulNow = iptracestatsGET_TIMESTAMP();
+    uint32_t ulEnd;
+
+    iptracestatsENTER_CRITICAL();
+    {
+        ulCounters[ eIPTraceStatsTxBytes ] += ( uint32_t ) uxLength;
+
+        if( xParsed == pdPASS )
+        {
+            pxFlow = prvFindFlow( &xInfo, xInfo.pucDestinationAddress, xInfo.usSourcePort, xInfo.usDestinationPort, ulNow );
+
+            /* A segment that starts below the highest sequence number sent
+             * is sent again.  Bare acknowledgements take no sequence space. */
+            if( xInfo.ulSequenceLength > 0U )
+            {
+                ulEnd = xInfo.ulSequence + xInfo.ulSequenceLength;
+
+                if( pxFlow->ulTxSegments == 0U )
+                {
+                    pxFlow->ulNextTxSequence = ulEnd;
+                }
+                else if( ( int32_t ) ( xInfo.ulSequence - pxFlow->ulNextTxSequence ) < 0 )
+                {
+                    pxFlow->ulRetransmits++;
+                    ulCounters[ eIPTraceStatsTcpRetransmits ]++;
+                }
+                else
+                {
+                    /* New data. */
+                }
+
+                if( ( int32_t ) ( ulEnd - pxFlow->ulNextTxSequence ) > 0 )
+                {
+                    pxFlow->ulNextTxSequence = ulEnd;
+                }
+            }
+
+            pxFlow->ulTxBytes += xInfo.ulPayloadLength;
+            pxFlow->ulTxSegments++;
+        }
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIPTraceStatsGetCounter( UBaseType_t uxIndex,
+                                    const char ** ppcName,
+                                    uint32_t * pulValue )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    if( uxIndex < ( UBaseType_t ) eIPTraceStatsCounters )
+    {
+        *ppcName = pcCounterNames[ uxIndex ];
+
+        /* A 32 bit read is atomic. */
+        *pulValue = ulCounters[ uxIndex ];
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vIPTraceStatsGetLevels( IPTraceStatsLevels_t * pxLevels )
+{
+    iptracestatsENTER_CRITICAL();
+    {
+        *pxLevels = xLevels;
+    }
+    iptracestatsEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIPTraceStatsGetFlow( UBaseType_t uxIndex,
+                                 IPTraceStatsFlow_t * pxFlow )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    if( uxIndex < iptracestatsMAX_FLOWS )
+    {
+        iptracestatsENTER_CRITICAL();
+        {
+            *pxFlow = xFlows[ uxIndex ];
+        }
+        iptracestatsEXIT_CRITICAL();
+
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xIPTraceStatsSnapshot( uint8_t * pucBuffer,
+                              size_t uxBufferLength )
+{
+    uint8_t * pucNext = pucBuffer;
+    uint32_t ulFlows = 0U;
+    uint32_t ulSamples;
+    UBaseType_t uxIndex;
+    UBaseType_t uxSample;
+    size_t uxLength = 0U;
+    const IPTraceStatsFlow_t * pxFlow;
+
+    if( ( pucBuffer != NULL ) && ( uxBufferLength >= iptracestatsSNAPSHOT_MAX_LENGTH ) )
+    {
+        /* The snapshot is taken in one critical section, so that it is
+         * consistent.  It writes well under a kilobyte with the defaults. */
+        iptracestatsENTER_CRITICAL();
+        {
+            for( uxIndex = 0U; uxIndex < iptracestatsMAX_FLOWS; uxIndex++ )
+            {
+                if( xFlows[ uxIndex ].usLocalPort != 0U )
+                {
+                    ulFlows++;
+                }
+            }
+
+            ulSamples = ( xLevels.ulLatencyCount < iptracestatsLATENCY_SAMPLES ) ? xLevels.ulLatencyCount : iptracestatsLATENCY_SAMPLES;
+
+            ( void ) memcpy( pucNext, "IPTS", 4U );
+            pucNext = &( pucNext[ 4 ] );
+            pucNext = prvWrite( pucNext, iptracestatsSNAPSHOT_VERSION, 2U );
+            pucNext = prvWrite( pucNext, 24U, 2U );
+            pucNext = prvWrite( pucNext, iptracestatsGET_TIMESTAMP(), 4U );
+            pucNext = prvWrite( pucNext, iptracestatsTIMESTAMP_HZ, 4U );
+            pucNext = prvWrite( pucNext, ( uint32_t ) eIPTraceStatsCounters, 2U );
+            pucNext = prvWrite( pucNext, ulFlows, 2U );
+            pucNext = prvWrite( pucNext, ulSamples, 2U );
+            pucNext = prvWrite( pucNext, 0U, 2U );
+
+            for( uxIndex = 0U; uxIndex < ( UBaseType_t ) eIPTraceStatsCounters; uxIndex++ )
+            {
+                pucNext = prvWrite( pucNext, ulCounters[ uxIndex ], 4U );
+            }
+
+            pucNext = prvWrite( pucNext, xLevels.ulLowestFreeBuffers, 4U );
+            pucNext = prvWrite( pucNext, xLevels.ulDeepestEventQueue, 4U );
+            pucNext = prvWrite( pucNext, xLevels.ulPendingRxFrames, 4U );
+            pucNext = prvWrite( pucNext, xLevels.ulLatencyCount, 4U );
+            pucNext = prvWrite( pucNext, xLevels.ulLatencyMin, 4U );
+            pucNext = prvWrite( pucNext, xLevels.ulLatencyMax, 4U );
+            pucNext = prvWrite( pucNext, xLevels.ulLatencyTotal, 4U );
+
+            for( uxIndex = 0U; uxIndex < iptracestatsMAX_FLOWS; uxIndex++ )
+            {
+                pxFlow = &( xFlows[ uxIndex ] );
+
+                if( pxFlow->usLocalPort != 0U )
+                {
+                    ( void ) memcpy( pucNext, pxFlow->ucRemoteAddress, sizeof( pxFlow->ucRemoteAddress ) );
+                    pucNext = &( pucNext[ sizeof( pxFlow->ucRemoteAddress ) ] );
+                    pucNext = prvWrite( pucNext, pxFlow->usLocalPort, 2U );
+                    pucNext = prvWrite( pucNext, pxFlow->usRemotePort, 2U );
+                    pucNext = prvWrite( pucNext, pxFlow->ucProtocol, 1U );
+                    pucNext = prvWrite( pucNext, pxFlow->ucIPVersion, 1U );
+                    pucNext = prvWrite( pucNext, pxFlow->ulRxBytes, 4U );
+                    pucNext = prvWrite( pucNext, pxFlow->ulTxBytes, 4U );
+                    pucNext = prvWrite( pucNext, pxFlow->ulRxSegments, 4U );
+                    pucNext = prvWrite( pucNext, pxFlow->ulTxSegments, 4U );
+                    pucNext = prvWrite( pucNext, pxFlow->ulRetransmits, 4U );
+                    pucNext = prvWrite( pucNext, pxFlow->ulLastActive, 4U );
+                }
+            }
+
+            /* The oldest sample is the next one to be overwritten once the
+             * ring is full. */
+            uxSample = ( ulSamples < iptracestatsLATENCY_SAMPLES ) ? 0U : uxNextSample;
+
+            for( uxIndex = 0U; uxIndex < ( UBaseType_t ) ulSamples; uxIndex++ )
+            {
+                pucNext = prvWrite( pucNext, ulSampleTimes[ uxSample ], 4U );
+                pucNext = prvWrite( pucNext, ulSampleLatencies[ uxSample ], 4U );
+                uxSample = ( uxSample + 1U ) % iptracestatsLATENCY_SAMPLES;
+            }
+        }
+        iptracestatsEXIT_CRITICAL();
+
+        uxLength = ( size_t ) ( pucNext - pucBuffer );
+    }
+
+    return uxLength;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,398 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file ip_trace_stats.h
+ * @brief Counters, levels and latency samples of the FreeRTOS+TCP hot paths,
+ * gathered through the trace macros of the stack.
+ *
+ * Include this header at the end of FreeRTOSIPConfig.h.  It defines the trace
+ * macros of FreeRTOS+TCP that are not already defined, so that the stack
+ * counts its events, records the lowest number of free network buffers and
+ * the deepest network event queue, and passes every frame it receives and
+ * sends to the module.  The module parses the Ethernet, IPv4 or IPv6, and TCP
+ * or UDP headers of the frames, and keeps the bytes and segments of up to
+ * #iptracestatsMAX_FLOWS flows, that is sockets, together with the
+ * retransmissions of the TCP flows, which are the segments sent again below
+ * the highest sequence number sent already.
+ *
+ * The time from the network interface receiving a frame to the IP task
+ * processing it, after which the IP task delivers the payload to the socket,
+ * is sampled in a ring of the last #iptracestatsLATENCY_SAMPLES samples, each
+ * with the time at which it was taken.  The times of reception wait in a
+ * FIFO, which is trimmed to the depth of the network event queue whenever the
+ * IP task takes an event, as drivers also report frames they filter out.  The
+ * samples are therefore approximate when ipconfigUSE_LINKED_RX_MESSAGES
+ * passes several frames in one event.
+ *
+ * xIPTraceStatsSnapshot() serializes everything into a binary snapshot, and
+ * xIPTraceStatsGetCounter() reads the counters one by one, for instance from
+ * a CLI command.
+ *
+ * The state is updated in short critical sections, as some of the macros are
+ * called by network interface drivers from interrupts.
+ */
+
+#ifndef IP_TRACE_STATS_H
+#define IP_TRACE_STATS_H
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief The number of flows of which the bytes and segments are kept.  When
+ * the table is full, the flow that was idle for the longest time is replaced.
+ * Defaults to 8.
+ */
+#ifndef iptracestatsMAX_FLOWS
+    #define iptracestatsMAX_FLOWS    8U
+#endif
+
+/**
+ * @brief The number of latency samples kept.  Defaults to 32.
+ */
+#ifndef iptracestatsLATENCY_SAMPLES
+    #define iptracestatsLATENCY_SAMPLES    32U
+#endif
+
+/**
+ * @brief The number of received frames of which the time of reception is
+ * kept until the IP task processes them.  Defaults to 16.
+ */
+#ifndef iptracestatsPENDING_RX_FRAMES
+    #define iptracestatsPENDING_RX_FRAMES    16U
+#endif
+
+/**
+ * @brief The clock of the timestamps and latencies, which must be callable
+ * from interrupts.  Defaults to the tick count.  A free running timer gives
+ * latencies finer than a tick.
+ */
+#ifndef iptracestatsGET_TIMESTAMP
+    #define iptracestatsGET_TIMESTAMP()    ( ( uint32_t ) xTaskGetTickCountFromISR() )
+#endif
+
+/**
+ * @brief The frequency of #iptracestatsGET_TIMESTAMP, in Hz, written to the
+ * snapshots.  Defaults to configTICK_RATE_HZ.
+ */
+#ifndef iptracestatsTIMESTAMP_HZ
+    #define iptracestatsTIMESTAMP_HZ    ( ( uint32_t ) configTICK_RATE_HZ )
+#endif
+
+/**
+ * @brief The version of the snapshot format, see xIPTraceStatsSnapshot().
+ */
+#define iptracestatsSNAPSHOT_VERSION    1U
+
+/**
+ * @brief The events counted.
+ */
+typedef enum IPTraceStatsCounter
+{
+    eIPTraceStatsRxFrames = 0,        /**< @brief Frames received by the network interface. */
+    eIPTraceStatsTxFrames,            /**< @brief Frames sent by the network interface. */
+    eIPTraceStatsRxBytes,             /**< @brief Bytes of the frames processed by the IP task. */
+    eIPTraceStatsTxBytes,             /**< @brief Bytes of the frames the IP task sent. */
+    eIPTraceStatsBufferObtained,      /**< @brief Network buffers obtained. */
+    eIPTraceStatsBufferReleased,      /**< @brief Network buffers released. */
+    eIPTraceStatsBufferFailed,        /**< @brief Failed attempts to obtain a network buffer. */
+    eIPTraceStatsRxEventLost,         /**< @brief Received frames lost as the event queue was full. */
+    eIPTraceStatsTxEventLost,         /**< @brief Events of the IP task lost as the event queue was full. */
+    eIPTraceStatsArpDropped,          /**< @brief Packets dropped to send an ARP request. */
+    eIPTraceStatsSocketCreateFailed,  /**< @brief Sockets which could not be created. */
+    eIPTraceStatsBindFailed,          /**< @brief Failed calls to bind(). */
+    eIPTraceStatsRecvTimeout,         /**< @brief Receive calls which timed out. */
+    eIPTraceStatsSendTooLong,         /**< @brief Sends failed as the payload was too long. */
+    eIPTraceStatsSendNotBound,        /**< @brief Sends failed as the socket was not bound. */
+    eIPTraceStatsSendNoBuffer,        /**< @brief Sends failed as no network buffer was available. */
+    eIPTraceStatsTxDmaWait,           /**< @brief Waits of the driver for a DMA descriptor. */
+    eIPTraceStatsSelectNotifyFailed,  /**< @brief Select groups which could not be notified. */
+    eIPTraceStatsTcpRetransmits,      /**< @brief TCP segments sent again, over all flows. */
+    eIPTraceStatsFlowsReplaced,       /**< @brief Flows dropped from the full flow table. */
+    eIPTraceStatsCounters             /**< @brief The number of counters, not a counter. */
+} IPTraceStatsCounter_t;
+
+/**
+ * @brief The bytes and segments of a flow, see vIPTraceStatsGetFlow().
+ *
+ * The flow is named from the point of view of the device, so usLocalPort is
+ * the port of the socket.
+ */
+typedef struct IPTraceStatsFlow
+{
+    uint8_t ucRemoteAddress[ 16 ]; /**< @brief The remote address, IPv4 addresses in the first 4 bytes. */
+    uint16_t usLocalPort;          /**< @brief The local port, 0 for an unused entry. */
+    uint16_t usRemotePort;         /**< @brief The remote port. */
+    uint8_t ucProtocol;            /**< @brief ipPROTOCOL_TCP (6) or ipPROTOCOL_UDP (17). */
+    uint8_t ucIPVersion;           /**< @brief 4 or 6. */
+    uint32_t ulRxBytes;            /**< @brief The payload bytes received. */
+    uint32_t ulTxBytes;            /**< @brief The payload bytes sent. */
+    uint32_t ulRxSegments;         /**< @brief The segments or datagrams received. */
+    uint32_t ulTxSegments;         /**< @brief The segments or datagrams sent. */
+    uint32_t ulRetransmits;        /**< @brief The TCP segments sent again. */
+    uint32_t ulLastActive;         /**< @brief The timestamp of the last segment. */
+    uint32_t ulNextTxSequence;     /**< @brief Private, the sequence number after the highest sent. */
+} IPTraceStatsFlow_t;
+
+/**
+ * @brief The levels of the buffers and queues of the stack, and the summary
+ * of the latency samples.
+ */
+typedef struct IPTraceStatsLevels
+{
+    uint32_t ulLowestFreeBuffers;  /**< @brief The fewest free network buffers seen when one was obtained, UINT32_MAX before. */
+    uint32_t ulDeepestEventQueue;  /**< @brief The most events waiting for the IP task, including the one taken. */
+    uint32_t ulPendingRxFrames;    /**< @brief The received frames not processed by the IP task yet. */
+    uint32_t ulLatencyCount;       /**< @brief The number of latency samples taken. */
+    uint32_t ulLatencyMin;         /**< @brief The lowest latency, 0 when no sample was taken. */
+    uint32_t ulLatencyMax;         /**< @brief The highest latency. */
+    uint32_t ulLatencyTotal;       /**< @brief The sum of the latencies, which may wrap. */
+} IPTraceStatsLevels_t;
+
+/**
+ * @brief Clear the counters, levels, flows and samples.
+ */
+void vIPTraceStatsReset( void );
+
+/**
+ * @brief Count an event.  May be called from interrupts.
+ *
+ * @param[in] eCounter The event.
+ */
+void vIPTraceStatsCount( IPTraceStatsCounter_t eCounter );
+
+/**
+ * @brief Record the number of free network buffers after one was obtained.
+ *
+ * @param[in] uxFreeBuffers The number of free network buffers.
+ */
+void vIPTraceStatsBufferObtained( UBaseType_t uxFreeBuffers );
+
+/**
+ * @brief Record the depth of the network event queue when the IP task took
+ * an event from it.
+ *
+ * @param[in] uxDepth The number of events waiting, including the one taken.
+ */
+void vIPTraceStatsEventReceived( UBaseType_t uxDepth );
+
+/**
+ * @brief Record that the network interface received a frame, and the time it
+ * did.  May be called from interrupts.
+ */
+void vIPTraceStatsRxFrame( void );
+
+/**
+ * @brief Forget the newest received frame, which the stack dropped as the
+ * network event queue was full.  May be called from interrupts.
+ */
+void vIPTraceStatsRxFrameLost( void );
+
+/**
+ * @brief Account a frame processed by the IP task, and take a latency sample
+ * of the oldest received frame.
+ *
+ * @param[in] pucFrame The Ethernet frame.
+ * @param[in] uxLength The length of the frame.
+ */
+void vIPTraceStatsFrameInput( const uint8_t * pucFrame,
+                              size_t uxLength );
+
+/**
+ * @brief Account a frame sent by the IP task.
+ *
+ * @param[in] pucFrame The Ethernet frame.
+ * @param[in] uxLength The length of the frame.
+ */
+void vIPTraceStatsFrameOutput( const uint8_t * pucFrame,
+                               size_t uxLength );
+
+/**
+ * @brief Read a counter, for instance for each line of a CLI command.
+ *
+ * @param[in] uxIndex The counter, from 0 to eIPTraceStatsCounters - 1.
+ * @param[out] ppcName The name of the counter.
+ * @param[out] pulValue The value of the counter.
+ *
+ * @return pdPASS if @p uxIndex is a counter, otherwise pdFAIL.
+ */
+BaseType_t xIPTraceStatsGetCounter( UBaseType_t uxIndex,
+                                    const char ** ppcName,
+                                    uint32_t * pulValue );
+
+/**
+ * @brief Read the levels and the summary of the latency samples.
+ *
+ * @param[out] pxLevels The levels.
+ */
+void vIPTraceStatsGetLevels( IPTraceStatsLevels_t * pxLevels );
+
+/**
+ * @brief Read a flow.
+ *
+ * @param[in] uxIndex The index of the flow, below #iptracestatsMAX_FLOWS.
+ * @param[out] pxFlow The flow, the usLocalPort of which is 0 if the entry is
+ * unused.
+ *
+ * @return pdPASS if @p uxIndex is below #iptracestatsMAX_FLOWS, otherwise
+ * pdFAIL.
+ */
+BaseType_t xIPTraceStatsGetFlow( UBaseType_t uxIndex,
+                                 IPTraceStatsFlow_t * pxFlow );
+
+/**
+ * @brief Serialize the counters, levels, flows in use and latency samples into
+ * a binary snapshot, for a dashboard.
+ *
+ * All fields are little endian:
+ * - a 24 byte header: the magic "IPTS", the uint16 version
+ *   #iptracestatsSNAPSHOT_VERSION, the uint16 length of the header, the
+ *   uint32 timestamp of the snapshot, the uint32 #iptracestatsTIMESTAMP_HZ,
+ *   the uint16 numbers of counters, flows and samples, and a uint16 0;
+ * - a uint32 per counter, in the order of IPTraceStatsCounter_t;
+ * - the seven uint32 of IPTraceStatsLevels_t, in order;
+ * - 46 bytes per flow: the 16 byte remote address, the uint16 local and remote
+ *   ports, the uint8 protocol and IP version, then the uint32 received and
+ *   sent bytes, received and sent segments, retransmissions and the
+ *   timestamp it was last active;
+ * - 8 bytes per latency sample, oldest first: the uint32 timestamp at which
+ *   it was taken and the uint32 latency.
+ *
+ * A reader skips fields it does not know by the lengths of the header, and
+ * by the numbers of entries.
+ *
+ * @param[out] pucBuffer The buffer for the snapshot.
+ * @param[in] uxBufferLength The length of @p pucBuffer.
+ *
+ * @return The length of the snapshot, or 0 if it does not fit in
+ * @p pucBuffer.
+ */
+size_t xIPTraceStatsSnapshot( uint8_t * pucBuffer,
+                              size_t uxBufferLength );
+
+/**
+ * @brief The length of the largest snapshot.
+ */
+#define iptracestatsSNAPSHOT_MAX_LENGTH                                               \
+    ( 24U + ( ( size_t ) eIPTraceStatsCounters * 4U ) + ( 7U * 4U ) +                 \
+      ( ( size_t ) iptracestatsMAX_FLOWS * 46U ) + ( ( size_t ) iptracestatsLATENCY_SAMPLES * 8U ) )
+
+/*-----------------------------------------------------------*/
+
+/* The trace macros of FreeRTOS+TCP which are not defined yet.  The levels are
+ * read where the macros are expanded, inside the stack, which is where
+ * xNetworkEventQueue and uxGetNumberOfFreeNetworkBuffers() are visible. */
+
+#ifndef iptraceNETWORK_INTERFACE_RECEIVE
+    #define iptraceNETWORK_INTERFACE_RECEIVE()    vIPTraceStatsRxFrame()
+#endif
+
+#ifndef iptraceNETWORK_INTERFACE_TRANSMIT
+    #define iptraceNETWORK_INTERFACE_TRANSMIT()    vIPTraceStatsCount( eIPTraceStatsTxFrames )
+#endif
+
+#ifndef iptraceNETWORK_INTERFACE_INPUT
+    #define iptraceNETWORK_INTERFACE_INPUT( uxDataLength, pucEthernetBuffer )    vIPTraceStatsFrameInput( ( pucEthernetBuffer ), ( uxDataLength ) )
+#endif
+
+#ifndef iptraceNETWORK_INTERFACE_OUTPUT
+    #define iptraceNETWORK_INTERFACE_OUTPUT( uxDataLength, pucEthernetBuffer )    vIPTraceStatsFrameOutput( ( pucEthernetBuffer ), ( uxDataLength ) )
+#endif
+
+#ifndef iptraceNETWORK_BUFFER_OBTAINED
+    #define iptraceNETWORK_BUFFER_OBTAINED( pxBufferAddress )    vIPTraceStatsBufferObtained( uxGetNumberOfFreeNetworkBuffers() )
+#endif
+
+/* The number of free buffers is not read from an interrupt. */
+#ifndef iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR
+    #define iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxBufferAddress )    vIPTraceStatsCount( eIPTraceStatsBufferObtained )
+#endif
+
+#ifndef iptraceNETWORK_BUFFER_RELEASED
+    #define iptraceNETWORK_BUFFER_RELEASED( pxBufferAddress )    vIPTraceStatsCount( eIPTraceStatsBufferReleased )
+#endif
+
+#ifndef iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER
+    #define iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER()    vIPTraceStatsCount( eIPTraceStatsBufferFailed )
+#endif
+
+#ifndef iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR
+    #define iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR()    vIPTraceStatsCount( eIPTraceStatsBufferFailed )
+#endif
+
+#ifndef iptraceNETWORK_EVENT_RECEIVED
+    #define iptraceNETWORK_EVENT_RECEIVED( eEvent )    vIPTraceStatsEventReceived( uxQueueMessagesWaiting( xNetworkEventQueue ) + 1U )
+#endif
+
+#ifndef iptraceETHERNET_RX_EVENT_LOST
+    #define iptraceETHERNET_RX_EVENT_LOST()    vIPTraceStatsRxFrameLost()
+#endif
+
+#ifndef iptraceSTACK_TX_EVENT_LOST
+    #define iptraceSTACK_TX_EVENT_LOST( xEvent )    vIPTraceStatsCount( eIPTraceStatsTxEventLost )
+#endif
+
+#ifndef iptracePACKET_DROPPED_TO_GENERATE_ARP
+    #define iptracePACKET_DROPPED_TO_GENERATE_ARP( ulIPAddress )    vIPTraceStatsCount( eIPTraceStatsArpDropped )
+#endif
+
+#ifndef iptraceFAILED_TO_CREATE_SOCKET
+    #define iptraceFAILED_TO_CREATE_SOCKET()    vIPTraceStatsCount( eIPTraceStatsSocketCreateFailed )
+#endif
+
+#ifndef iptraceBIND_FAILED
+    #define iptraceBIND_FAILED( xSocket, usPort )    vIPTraceStatsCount( eIPTraceStatsBindFailed )
+#endif
+
+#ifndef iptraceRECVFROM_TIMEOUT
+    #define iptraceRECVFROM_TIMEOUT()    vIPTraceStatsCount( eIPTraceStatsRecvTimeout )
+#endif
+
+#ifndef iptraceSENDTO_DATA_TOO_LONG
+    #define iptraceSENDTO_DATA_TOO_LONG()    vIPTraceStatsCount( eIPTraceStatsSendTooLong )
+#endif
+
+#ifndef iptraceSENDTO_SOCKET_NOT_BOUND
+    #define iptraceSENDTO_SOCKET_NOT_BOUND()    vIPTraceStatsCount( eIPTraceStatsSendNotBound )
+#endif
+
+#ifndef iptraceNO_BUFFER_FOR_SENDTO
+    #define iptraceNO_BUFFER_FOR_SENDTO()    vIPTraceStatsCount( eIPTraceStatsSendNoBuffer )
+#endif
+
+#ifndef iptraceWAITING_FOR_TX_DMA_DESCRIPTOR
+    #define iptraceWAITING_FOR_TX_DMA_DESCRIPTOR()    vIPTraceStatsCount( eIPTraceStatsTxDmaWait )
+#endif
+
+#ifndef iptraceFAILED_TO_NOTIFY_SELECT_GROUP
+    #define iptraceFAILED_TO_NOTIFY_SELECT_GROUP( xSocket )    vIPTraceStatsCount( eIPTraceStatsSelectNotifyFailed )
+#endif
+
+#endif /* ifndef IP_TRACE_STATS_H */
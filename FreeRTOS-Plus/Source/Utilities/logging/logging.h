@@ -50,4 +50,17 @@ void vPlatformInitLogging( void );
 void vLoggingPrintf( const char * pcFormat,
                      ... );
 
+/*
+ * Log one complete line with a single call: pcPrefix, then the function name
+ * and line number, then the message formatted from pcFormat, then "\r\n".  The
+ * line is formatted and written as one record, so it does not interleave with
+ * lines logged by other tasks.  Used by logging_stack.h when
+ * LOGGING_SINGLE_CALL is 1.
+ */
+void vLoggingPrintfLine( const char * pcPrefix,
+                         const char * pcFunction,
+                         int iLine,
+                         const char * pcFormat,
+                         ... );
+
 #endif /* DEMO_LOGGING_H */
@@ -0,0 +1,902 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_deferred.c
+ * @brief Records log messages in per-core ring buffers, and formats them later.
+ */
+
+/* Standard includes. */
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "logging.h"
+#include "logging_deferred.h"
+
+#if ( ( LOGGING_DEFERRED_BUFFER_SIZE & ( LOGGING_DEFERRED_BUFFER_SIZE - 1U ) ) != 0U )
+    #error "LOGGING_DEFERRED_BUFFER_SIZE must be a power of two."
+#endif
+
+/* Older kernels are single core. */
+#ifndef configNUMBER_OF_CORES
+    #define configNUMBER_OF_CORES    1
+#endif
+
+/* Orders the writes to a record before the write that publishes it. */
+#ifdef portMEMORY_BARRIER
+    #define loggingMEMORY_BARRIER()    portMEMORY_BARRIER()
+#else
+    #define loggingMEMORY_BARRIER()
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The kinds of argument a printf conversion consumes.
+ */
+typedef enum LoggingArgType
+{
+    eLoggingArgNone = 0, /**< @brief "%%", or a conversion that is not supported. */
+    eLoggingArgInt,
+    eLoggingArgLong,
+    eLoggingArgLongLong,
+    eLoggingArgIntMax,
+    eLoggingArgSize,
+    eLoggingArgPtrdiff,
+    eLoggingArgPointer,
+    eLoggingArgDouble,
+    eLoggingArgLongDouble,
+    eLoggingArgString
+} LoggingArgType_t;
+
+/**
+ * @brief One conversion specification of a format string.
+ */
+typedef struct LoggingConversion
+{
+    const char * pcStart;        /**< @brief The '%' that starts the conversion. */
+    const char * pcEnd;          /**< @brief One past the conversion character. */
+    BaseType_t xWidthStar;       /**< @brief pdTRUE if the width is an int argument. */
+    BaseType_t xPrecisionStar;   /**< @brief pdTRUE if the precision is an int argument. */
+    LoggingArgType_t xArgType;   /**< @brief The argument the conversion consumes. */
+} LoggingConversion_t;
+
+/**
+ * @brief The start of every record.
+ */
+typedef struct LoggingRecordHeader
+{
+    const LoggingDeferredSite_t * pxSite; /**< @brief The call site of the message. */
+    const char * pcFormat;                /**< @brief The format of the message. */
+    uint16_t usLength;                    /**< @brief The length of the record, including this header. */
+} LoggingRecordHeader_t;
+
+/**
+ * @brief The ring buffer of one core.
+ *
+ * Only code running on the core writes to the ring, with that core's
+ * interrupts masked, and only #uxLoggingDeferredProcess reads from it, so
+ * the two indexes are each written by one side only.
+ */
+typedef struct LoggingRing
+{
+    volatile uint32_t ulHead;                         /**< @brief Where the next record is written.  Does not wrap at the buffer size. */
+    volatile uint32_t ulTail;                         /**< @brief Where the next record is read. */
+    uint32_t ulDropped;                               /**< @brief Records not written because the ring was full. */
+    uint8_t ucBuffer[ LOGGING_DEFERRED_BUFFER_SIZE ]; /**< @brief The records. */
+} LoggingRing_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The ring buffer of each core.
+ */
+static LoggingRing_t xRings[ configNUMBER_OF_CORES ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Parse the conversion that starts at the '%' pcFormat points to.
+ *
+ * @param[in] pcFormat The start of the conversion.
+ * @param[out] pxConversion The conversion found.
+ */
+static void prvParseConversion( const char * pcFormat,
+                                LoggingConversion_t * pxConversion );
+
+/**
+ * @brief Copy xLength bytes into the ring, wrapping at its end.
+ *
+ * @param[in] pxRing The ring to write.
+ * @param[in] ulIndex Where to write the bytes.
+ * @param[in] pvData The bytes to write.
+ * @param[in] xLength The number of bytes.
+ */
+static void prvRingWrite( LoggingRing_t * pxRing,
+                          uint32_t ulIndex,
+                          const void * pvData,
+                          size_t xLength );
+
+/**
+ * @brief Copy xLength bytes out of the ring, wrapping at its end.
+ *
+ * @param[in] pxRing The ring to read.
+ * @param[in] ulIndex Where to read the bytes.
+ * @param[out] pvData The buffer to copy the bytes into.
+ * @param[in] xLength The number of bytes.
+ */
+static void prvRingRead( const LoggingRing_t * pxRing,
+                         uint32_t ulIndex,
+                         void * pvData,
+                         size_t xLength );
+
+/**
+ * @brief Format the record pucRecord and output it.
+ *
+ * @param[in] pucRecord The record, starting with its LoggingRecordHeader_t.
+ */
+static void prvOutputRecord( const uint8_t * pucRecord );
+
+/**
+ * @brief Append the output of one conversion to the message being formatted.
+ *
+ * @param[in] pcSpecification The conversion specification, with no '*'.
+ * @param[in] xArgType The type of the argument.
+ * @param[in] pucArg The stored value of the argument.
+ * @param[in] pcLine The end of the message formatted so far.
+ * @param[in] xSpace The space left in the message buffer.
+ *
+ * @return The number of characters appended.
+ */
+static size_t prvFormatArg( const char * pcSpecification,
+                            LoggingArgType_t xArgType,
+                            const uint8_t * pucArg,
+                            char * pcLine,
+                            size_t xSpace );
+
+/**
+ * @brief The number of bytes an argument of xArgType is stored in, other than
+ * a string.
+ *
+ * @param[in] xArgType The type of the argument.
+ *
+ * @return The size of the stored argument.
+ */
+static size_t prvArgSize( LoggingArgType_t xArgType );
+
+/*-----------------------------------------------------------*/
+
+static void prvParseConversion( const char * pcFormat,
+                                LoggingConversion_t * pxConversion )
+{
+    const char * pcCharacter = &( pcFormat[ 1 ] );
+    UBaseType_t uxLongs = 0;
+    char cLength = '\0';
+
+    pxConversion->pcStart = pcFormat;
+    pxConversion->xWidthStar = pdFALSE;
+    pxConversion->xPrecisionStar = pdFALSE;
+    pxConversion->xArgType = eLoggingArgNone;
+
+    /* Flags. */
+    while( ( *pcCharacter != '\0' ) && ( strchr( "-+ #0", *pcCharacter ) != NULL ) )
+    {
+        pcCharacter++;
+    }
+
+    /* Width. */
+    if( *pcCharacter == '*' )
+    {
+        pxConversion->xWidthStar = pdTRUE;
+        pcCharacter++;
+    }
+
+    while( ( *pcCharacter >= '0' ) && ( *pcCharacter <= '9' ) )
+    {
+        pcCharacter++;
+    }
+
+    /* Precision. */
+    if( *pcCharacter == '.' )
+    {
+        pcCharacter++;
+
+        if( *pcCharacter == '*' )
+        {
+            pxConversion->xPrecisionStar = pdTRUE;
+            pcCharacter++;
+        }
+
+        while( ( *pcCharacter >= '0' ) && ( *pcCharacter <= '9' ) )
+        {
+            pcCharacter++;
+        }
+    }
+
+    /* Length modifier. */
+    while( ( *pcCharacter != '\0' ) && ( strchr( "hlzjtL", *pcCharacter ) != NULL ) )
+    {
+        if( *pcCharacter == 'l' )
+        {
+            uxLongs++;
+        }
+
+        cLength = *pcCharacter;
+        pcCharacter++;
+    }
+
+    switch( *pcCharacter )
+    {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+
+            if( uxLongs > 1U )
+            {
+                pxConversion->xArgType = eLoggingArgLongLong;
+            }
+            else if( uxLongs == 1U )
+            {
+                pxConversion->xArgType = ( *pcCharacter == 'c' ) ? eLoggingArgInt : eLoggingArgLong;
+            }
+            else if( cLength == 'j' )
+            {
+                pxConversion->xArgType = eLoggingArgIntMax;
+            }
+            else if( cLength == 'z' )
+            {
+                pxConversion->xArgType = eLoggingArgSize;
+            }
+            else if( cLength == 't' )
+            {
+                pxConversion->xArgType = eLoggingArgPtrdiff;
+            }
+            else
+            {
+                /* char and short arguments are promoted to int. */
+                pxConversion->xArgType = eLoggingArgInt;
+            }
+
+            break;
+
+        case 'p':
+            pxConversion->xArgType = eLoggingArgPointer;
+            break;
+
+        case 's':
+            pxConversion->xArgType = eLoggingArgString;
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            pxConversion->xArgType = ( cLength == 'L' ) ? eLoggingArgLongDouble : eLoggingArgDouble;
+
+            break;
+
+        default:
+            /* "%%", "%n", which cannot be supported as the message is
+             * formatted later, and anything unknown consume no argument. */
+            break;
+    }
+
+    if( *pcCharacter != '\0' )
+    {
+        pcCharacter++;
+    }
+
+    pxConversion->pcEnd = pcCharacter;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvArgSize( LoggingArgType_t xArgType )
+{
+    size_t xReturn;
+
+    switch( xArgType )
+    {
+        case eLoggingArgInt:
+            xReturn = sizeof( int );
+            break;
+
+        case eLoggingArgLong:
+            xReturn = sizeof( long );
+            break;
+
+        case eLoggingArgLongLong:
+            xReturn = sizeof( long long );
+            break;
+
+        case eLoggingArgIntMax:
+            xReturn = sizeof( intmax_t );
+            break;
+
+        case eLoggingArgSize:
+            xReturn = sizeof( size_t );
+            break;
+
+        case eLoggingArgPtrdiff:
+            xReturn = sizeof( ptrdiff_t );
+            break;
+
+        case eLoggingArgPointer:
+            xReturn = sizeof( void * );
+            break;
+
+        case eLoggingArgDouble:
+            xReturn = sizeof( double );
+            break;
+
+        case eLoggingArgLongDouble:
+            xReturn = sizeof( long double );
+            break;
+
+        default:
+            xReturn = 0;
+            break;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingWrite( LoggingRing_t * pxRing,
+                          uint32_t ulIndex,
+                          const void * pvData,
+                          size_t xLength )
+{
+    size_t xOffset = ( size_t ) ( ulIndex & ( LOGGING_DEFERRED_BUFFER_SIZE - 1U ) );
+    size_t xFirst = LOGGING_DEFERRED_BUFFER_SIZE - xOffset;
+
+    if( xFirst > xLength )
+    {
+        xFirst = xLength;
+    }
+
+    ( void ) memcpy( &( pxRing->ucBuffer[ xOffset ] ), pvData, xFirst );
+    ( void ) memcpy( pxRing->ucBuffer, &( ( ( const uint8_t * ) pvData )[ xFirst ] ), xLength - xFirst );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingRead( const LoggingRing_t * pxRing,
+                         uint32_t ulIndex,
+                         void * pvData,
+                         size_t xLength )
+{
+    size_t xOffset = ( size_t ) ( ulIndex & ( LOGGING_DEFERRED_BUFFER_SIZE - 1U ) );
+    size_t xFirst = LOGGING_DEFERRED_BUFFER_SIZE - xOffset;
+
+    if( xFirst > xLength )
+    {
+        xFirst = xLength;
+    }
+
+    ( void ) memcpy( pvData, &( pxRing->ucBuffer[ xOffset ] ), xFirst );
+    ( void ) memcpy( &( ( ( uint8_t * ) pvData )[ xFirst ] ), pxRing->ucBuffer, xLength - xFirst );
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingDeferredPrintf( const LoggingDeferredSite_t * pxSite,
+                             const char * pcFormat,
+                             ... )
+{
+    uint8_t ucRecord[ LOGGING_DEFERRED_MAX_RECORD ];
+    LoggingRecordHeader_t xHeader;
+    LoggingConversion_t xConversion;
+    LoggingRing_t * pxRing;
+    const char * pcCharacter = pcFormat;
+    const char * pcString;
+    size_t xUsed = sizeof( LoggingRecordHeader_t ), xSize;
+    BaseType_t xFull = pdFALSE;
+    UBaseType_t uxSavedInterruptStatus;
+    union
+    {
+        int iValue;
+        long lValue;
+        long long llValue;
+        intmax_t xIntMaxValue;
+        size_t xSizeValue;
+        ptrdiff_t xPtrdiffValue;
+        void * pvValue;
+        double dValue;
+        long double ldValue;
+    } xArg;
+    va_list args;
+
+    /* Store the raw value of each argument, in the order the format consumes
+     * them.  Nothing is formatted. */
+    va_start( args, pcFormat );
+
+    while( ( *pcCharacter != '\0' ) && ( xFull == pdFALSE ) )
+    {
+        if( *pcCharacter != '%' )
+        {
+            pcCharacter++;
+            continue;
+        }
+
+        prvParseConversion( pcCharacter, &xConversion );
+        pcCharacter = xConversion.pcEnd;
+
+        if( xConversion.xWidthStar != pdFALSE )
+        {
+            xArg.iValue = va_arg( args, int );
+
+            if( ( xUsed + sizeof( int ) ) <= sizeof( ucRecord ) )
+            {
+                ( void ) memcpy( &( ucRecord[ xUsed ] ), &( xArg.iValue ), sizeof( int ) );
+                xUsed += sizeof( int );
+            }
+            else
+            {
+                xFull = pdTRUE;
+            }
+        }
+
+        if( ( xConversion.xPrecisionStar != pdFALSE ) && ( xFull == pdFALSE ) )
+        {
+            xArg.iValue = va_arg( args, int );
+
+            if( ( xUsed + sizeof( int ) ) <= sizeof( ucRecord ) )
+            {
+                ( void ) memcpy( &( ucRecord[ xUsed ] ), &( xArg.iValue ), sizeof( int ) );
+                xUsed += sizeof( int );
+            }
+            else
+            {
+                xFull = pdTRUE;
+            }
+        }
+
+        if( xFull != pdFALSE )
+        {
+            break;
+        }
+
+        switch( xConversion.xArgType )
+        {
+            case eLoggingArgInt:
+                xArg.iValue = va_arg( args, int );
+                break;
+
+            case eLoggingArgLong:
+                xArg.lValue = va_arg( args, long );
+                break;
+
+            case eLoggingArgLongLong:
+                xArg.llValue = va_arg( args, long long );
+                break;
+
+            case eLoggingArgIntMax:
+                xArg.xIntMaxValue = va_arg( args, intmax_t );
+                break;
+
+            case eLoggingArgSize:
+                xArg.xSizeValue = va_arg( args, size_t );
+                break;
+
+            case eLoggingArgPtrdiff:
+                xArg.xPtrdiffValue = va_arg( args, ptrdiff_t );
+                break;
+
+            case eLoggingArgPointer:
+                xArg.pvValue = va_arg( args, void * );
+                break;
+
+            case eLoggingArgDouble:
+                xArg.dValue = va_arg( args, double );
+                break;
+
+            case eLoggingArgLongDouble:
+                xArg.ldValue = va_arg( args, long double );
+                break;
+
+            case eLoggingArgString:
+
+                /* The string may not exist by the time the message is
+                 * formatted, so store a copy, always NULL terminated. */
+                pcString = va_arg( args, const char * );
+
+                if( pcString == NULL )
+                {
+                    pcString = "(null)";
+                }
+
+                xSize = strlen( pcString );
+
+                if( xSize > LOGGING_DEFERRED_MAX_STRING )
+                {
+                    xSize = LOGGING_DEFERRED_MAX_STRING;
+                }
+
+                if( ( xUsed + xSize + 1U ) <= sizeof( ucRecord ) )
+                {
+                    ( void ) memcpy( &( ucRecord[ xUsed ] ), pcString, xSize );
+                    ucRecord[ xUsed + xSize ] = 0U;
+                    xUsed += xSize + 1U;
+                }
+                else
+                {
+                    xFull = pdTRUE;
+                }
+
+                break;
+
+            default:
+                /* No argument. */
+                break;
+        }
+
+        xSize = prvArgSize( xConversion.xArgType );
+
+        if( xSize > 0U )
+        {
+            if( ( xUsed + xSize ) <= sizeof( ucRecord ) )
+            {
+                ( void ) memcpy( &( ucRecord[ xUsed ] ), &xArg, xSize );
+                xUsed += xSize;
+            }
+            else
+            {
+                xFull = pdTRUE;
+            }
+        }
+    }
+
+    va_end( args );
+
+    xHeader.pxSite = pxSite;
+    xHeader.pcFormat = pcFormat;
+    xHeader.usLength = ( uint16_t ) xUsed;
+    ( void ) memcpy( ucRecord, &xHeader, sizeof( xHeader ) );
+
+    /* Only writers on this core use its ring, and they cannot interrupt each
+     * other while interrupts are masked.  The core is found with interrupts
+     * masked so the task cannot move to another core in between. */
+    uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+    {
+        #if ( configNUMBER_OF_CORES > 1 )
+            pxRing = &( xRings[ portGET_CORE_ID() ] );
+        #else
+            pxRing = &( xRings[ 0 ] );
+        #endif
+
+        if( ( LOGGING_DEFERRED_BUFFER_SIZE - ( pxRing->ulHead - pxRing->ulTail ) ) < xUsed )
+        {
+            pxRing->ulDropped++;
+        }
+        else
+        {
+            prvRingWrite( pxRing, pxRing->ulHead, ucRecord, xUsed );
+
+            /* Publish the record only once all of it is in the ring. */
+            loggingMEMORY_BARRIER();
+            pxRing->ulHead += ( uint32_t ) xUsed;
+        }
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFormatArg( const char * pcSpecification,
+                            LoggingArgType_t xArgType,
+                            const uint8_t * pucArg,
+                            char * pcLine,
+                            size_t xSpace )
+{
+    int iWritten = 0;
+    union
+    {
+        int iValue;
+        long lValue;
+        long long llValue;
+        intmax_t xIntMaxValue;
+        size_t xSizeValue;
+        ptrdiff_t xPtrdiffValue;
+        void * pvValue;
+        double dValue;
+        long double ldValue;
+    } xArg;
+
+    ( void ) memcpy( &xArg, pucArg, prvArgSize( xArgType ) );
+
+    switch( xArgType )
+    {
+        case eLoggingArgInt:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.iValue );
+            break;
+
+        case eLoggingArgLong:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.lValue );
+            break;
+
+        case eLoggingArgLongLong:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.llValue );
+            break;
+
+        case eLoggingArgIntMax:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.xIntMaxValue );
+            break;
+
+        case eLoggingArgSize:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.xSizeValue );
+            break;
+
+        case eLoggingArgPtrdiff:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.xPtrdiffValue );
+            break;
+
+        case eLoggingArgPointer:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.pvValue );
+            break;
+
+        case eLoggingArgDouble:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.dValue );
+            break;
+
+        case eLoggingArgLongDouble:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, xArg.ldValue );
+            break;
+
+        case eLoggingArgString:
+            iWritten = snprintf( pcLine, xSpace, pcSpecification, ( const char * ) pucArg );
+            break;
+
+        default:
+            /* Only "%%" produces output. */
+            if( ( strcmp( pcSpecification, "%%" ) == 0 ) && ( xSpace > 1U ) )
+            {
+                pcLine[ 0 ] = '%';
+                pcLine[ 1 ] = '\0';
+                iWritten = 1;
+            }
+
+            break;
+    }
+
+    if( iWritten < 0 )
+    {
+        iWritten = 0;
+    }
+
+    /* Never report more than was actually written. */
+    return ( ( size_t ) iWritten < xSpace ) ? ( size_t ) iWritten : ( ( xSpace > 0U ) ? ( xSpace - 1U ) : 0U );
+}
+/*-----------------------------------------------------------*/
+
+static void prvOutputRecord( const uint8_t * pucRecord )
+{
+    char cLine[ LOGGING_DEFERRED_LINE_LENGTH ];
+    char cSpecification[ 32 ];
+    LoggingRecordHeader_t xHeader;
+    LoggingConversion_t xConversion;
+    const char * pcCharacter;
+    const char * pcFrom;
+    const char * pcMarker = NULL;
+    size_t xUsed = 0, xOffset = sizeof( LoggingRecordHeader_t ), xSize, xSpecificationLength, xSpace;
+    BaseType_t xComplete = pdTRUE, xValid = pdTRUE;
+    int iStar;
+    int iWritten;
+
+    ( void ) memcpy( &xHeader, pucRecord, sizeof( xHeader ) );
+
+    iWritten = snprintf( cLine,
+                         sizeof( cLine ),
+                         "%s [%s] [%s:%lu] ",
+                         xHeader.pxSite->pcLevel,
+                         xHeader.pxSite->pcLibrary,
+                         xHeader.pxSite->pcFunction,
+                         ( unsigned long ) xHeader.pxSite->ulLine );
+
+    if( iWritten > 0 )
+    {
+        xUsed = ( ( size_t ) iWritten < sizeof( cLine ) ) ? ( size_t ) iWritten : ( sizeof( cLine ) - 1U );
+    }
+
+    /* Leave room for the line ending. */
+    for( pcCharacter = xHeader.pcFormat; ( *pcCharacter != '\0' ) && ( xUsed < ( sizeof( cLine ) - 3U ) ); )
+    {
+        if( *pcCharacter != '%' )
+        {
+            cLine[ xUsed ] = *pcCharacter;
+            xUsed++;
+            pcCharacter++;
+            continue;
+        }
+
+        prvParseConversion( pcCharacter, &xConversion );
+
+        /* Copy the specification, replacing any '*' with the stored width or
+         * precision, so it can be given to snprintf() with one argument.  A
+         * specification that does not fit, with its terminator, is too long
+         * to be a real conversion. */
+        xSpecificationLength = 0;
+
+        for( pcFrom = xConversion.pcStart; ( pcFrom < xConversion.pcEnd ) && ( xComplete != pdFALSE ) && ( xValid != pdFALSE ); pcFrom++ )
+        {
+            xSpace = sizeof( cSpecification ) - xSpecificationLength;
+
+            if( *pcFrom == '*' )
+            {
+                if( ( xOffset + sizeof( int ) ) > xHeader.usLength )
+                {
+                    xComplete = pdFALSE;
+                }
+                else
+                {
+                    ( void ) memcpy( &iStar, &( pucRecord[ xOffset ] ), sizeof( int ) );
+                    xOffset += sizeof( int );
+                    iWritten = snprintf( &( cSpecification[ xSpecificationLength ] ), xSpace, "%d", iStar );
+
+                    /* snprintf() returns the length it wanted to write, not
+                     * what fitted. */
+                    if( ( iWritten < 0 ) || ( ( size_t ) iWritten >= xSpace ) )
+                    {
+                        xValid = pdFALSE;
+                    }
+                    else
+                    {
+                        xSpecificationLength += ( size_t ) iWritten;
+                    }
+                }
+            }
+            else if( xSpace > 1U )
+            {
+                cSpecification[ xSpecificationLength ] = *pcFrom;
+                xSpecificationLength++;
+            }
+            else
+            {
+                xValid = pdFALSE;
+            }
+        }
+
+        cSpecification[ xSpecificationLength ] = '\0';
+
+        /* Check the argument was stored. */
+        if( xConversion.xArgType == eLoggingArgString )
+        {
+            pcFrom = ( xOffset < xHeader.usLength ) ? memchr( &( pucRecord[ xOffset ] ), 0, xHeader.usLength - xOffset ) : NULL;
+
+            /* An unterminated string was not stored completely. */
+            xSize = ( pcFrom != NULL ) ? ( ( size_t ) ( pcFrom - ( const char * ) &( pucRecord[ xOffset ] ) ) + 1U ) : ( xHeader.usLength + 1U );
+        }
+        else
+        {
+            xSize = prvArgSize( xConversion.xArgType );
+        }
+
+        if( ( xConversion.xArgType != eLoggingArgNone ) && ( ( xOffset + xSize ) > xHeader.usLength ) )
+        {
+            xComplete = pdFALSE;
+        }
+
+        if( xValid == pdFALSE )
+        {
+            pcMarker = "<invalid conversion>";
+            break;
+        }
+
+        if( xComplete == pdFALSE )
+        {
+            /* The arguments did not fit in the record. */
+            pcMarker = "...";
+            break;
+        }
+
+        xUsed += prvFormatArg( cSpecification, xConversion.xArgType, &( pucRecord[ xOffset ] ), &( cLine[ xUsed ] ), sizeof( cLine ) - 2U - xUsed );
+
+        if( xConversion.xArgType != eLoggingArgNone )
+        {
+            xOffset += xSize;
+        }
+
+        pcCharacter = xConversion.pcEnd;
+    }
+
+    if( ( pcMarker != NULL ) && ( ( xUsed + strlen( pcMarker ) ) <= ( sizeof( cLine ) - 3U ) ) )
+    {
+        ( void ) memcpy( &( cLine[ xUsed ] ), pcMarker, strlen( pcMarker ) );
+        xUsed += strlen( pcMarker );
+    }
+
+    if( xUsed > ( sizeof( cLine ) - 3U ) )
+    {
+        xUsed = sizeof( cLine ) - 3U;
+    }
+
+    cLine[ xUsed ] = '\r';
+    cLine[ xUsed + 1U ] = '\n';
+    cLine[ xUsed + 2U ] = '\0';
+
+    LOGGING_DEFERRED_OUTPUT( cLine );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxLoggingDeferredProcess( void )
+{
+    uint8_t ucRecord[ LOGGING_DEFERRED_MAX_RECORD ];
+    LoggingRecordHeader_t xHeader;
+    LoggingRing_t * pxRing;
+    UBaseType_t uxCore, uxMessages = 0;
+    uint32_t ulTail;
+
+    for( uxCore = 0; uxCore < ( UBaseType_t ) configNUMBER_OF_CORES; uxCore++ )
+    {
+        pxRing = &( xRings[ uxCore ] );
+        ulTail = pxRing->ulTail;
+
+        while( ulTail != pxRing->ulHead )
+        {
+            /* Read the record only after seeing it published. */
+            loggingMEMORY_BARRIER();
+
+            prvRingRead( pxRing, ulTail, &xHeader, sizeof( xHeader ) );
+            configASSERT( ( xHeader.usLength >= sizeof( xHeader ) ) && ( xHeader.usLength <= sizeof( ucRecord ) ) );
+            prvRingRead( pxRing, ulTail, ucRecord, xHeader.usLength );
+
+            /* Free the space before the slow formatting, so writers can use
+             * it. */
+            ulTail += xHeader.usLength;
+            loggingMEMORY_BARRIER();
+            pxRing->ulTail = ulTail;
+
+            prvOutputRecord( ucRecord );
+            uxMessages++;
+        }
+    }
+
+    return uxMessages;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulLoggingDeferredGetDropped( void )
+{
+    uint32_t ulDropped = 0;
+    UBaseType_t uxCore;
+
+    for( uxCore = 0; uxCore < ( UBaseType_t ) configNUMBER_OF_CORES; uxCore++ )
+    {
+        ulDropped += xRings[ uxCore ].ulDropped;
+    }
+
+    return ulDropped;
+}
+/*-----------------------------------------------------------*/
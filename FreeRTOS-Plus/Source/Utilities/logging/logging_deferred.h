@@ -0,0 +1,138 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_deferred.h
+ * @brief Deferred logging backend for the logging macros of logging_stack.h.
+ *
+ * When #LOGGING_DEFERRED is 1, each LogError, LogWarn, LogInfo, LogDebug and
+ * LogAlways call stores a single record - the address of a static description
+ * of the call site, the address of the format string and the raw values of the
+ * arguments - in a ring buffer of the core it runs on, and returns without
+ * formatting anything.  #uxLoggingDeferredProcess, called from a low priority
+ * task, formats the records and outputs them with #LOGGING_DEFERRED_OUTPUT,
+ * and returns how many it output.  A message whose format has a conversion
+ * specification too long to format ends with "<invalid conversion>".
+ *
+ * Writers on one core only mask that core's interrupts for as long as it
+ * takes to copy a record into the ring, and never wait for another core, so
+ * the macros may be used from interrupts.  String arguments are copied, as
+ * they may no longer exist when the record is formatted.
+ */
+
+#ifndef LOGGING_DEFERRED_H
+#define LOGGING_DEFERRED_H
+
+/* Standard Include. */
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief The size in bytes of the ring buffer of each core.  Must be a power
+ * of two.
+ */
+#ifndef LOGGING_DEFERRED_BUFFER_SIZE
+    #define LOGGING_DEFERRED_BUFFER_SIZE    2048U
+#endif
+
+/**
+ * @brief The largest record, in bytes.  Arguments that do not fit are not
+ * stored, and the message is output up to the first of them.
+ */
+#ifndef LOGGING_DEFERRED_MAX_RECORD
+    #define LOGGING_DEFERRED_MAX_RECORD    128U
+#endif
+
+/**
+ * @brief The most characters of each string argument that are stored.
+ */
+#ifndef LOGGING_DEFERRED_MAX_STRING
+    #define LOGGING_DEFERRED_MAX_STRING    32U
+#endif
+
+/**
+ * @brief The size of the buffer into which #uxLoggingDeferredProcess formats
+ * each message, including the metadata prefix and the line ending.
+ */
+#ifndef LOGGING_DEFERRED_LINE_LENGTH
+    #define LOGGING_DEFERRED_LINE_LENGTH    256U
+#endif
+
+/**
+ * @brief Output one formatted message, which ends with "\r\n".
+ */
+#ifndef LOGGING_DEFERRED_OUTPUT
+    #define LOGGING_DEFERRED_OUTPUT( pcMessage )    vLoggingPrintf( "%s", ( pcMessage ) )
+#endif
+
+/**
+ * @brief The constant parts of the metadata of a log message, stored once per
+ * call site rather than in every record.
+ */
+typedef struct LoggingDeferredSite
+{
+    const char * pcLevel;    /**< @brief The level of the message, for example "[ERROR]". */
+    const char * pcLibrary;  /**< @brief The LIBRARY_LOG_NAME of the library that logged the message. */
+    const char * pcFunction; /**< @brief The function that logged the message. */
+    uint32_t ulLine;         /**< @brief The line that logged the message. */
+} LoggingDeferredSite_t;
+
+/**
+ * @brief Record a message to be formatted later.
+ *
+ * Called by the logging macros; not normally called directly.  pxSite and
+ * pcFormat must remain valid until the message is formatted, which is the
+ * case for the static site and the string literal used by the macros.
+ *
+ * @param[in] pxSite The call site of the message.
+ * @param[in] pcFormat The printf style format of the message.
+ */
+void vLoggingDeferredPrintf( const LoggingDeferredSite_t * pxSite,
+                             const char * pcFormat,
+                             ... );
+
+/**
+ * @brief Format and output all the messages recorded so far.
+ *
+ * Must only be called from one task at a time, normally a low priority task
+ * that calls it periodically.
+ *
+ * @return The number of messages output, so 0 when none were waiting.  A
+ * task can use it to decide how long to sleep before the next call.
+ */
+UBaseType_t uxLoggingDeferredProcess( void );
+
+/**
+ * @brief Get the number of messages that were dropped because a ring buffer
+ * was full.
+ *
+ * @return The number of messages dropped on all cores since start up.
+ */
+uint32_t ulLoggingDeferredGetDropped( void );
+
+#endif /* ifndef LOGGING_DEFERRED_H */
@@ -0,0 +1,109 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_ratelimit.c
+ * @brief Rate limiting of the messages logged by each call site.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "logging_ratelimit.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The messages logged by one call site per period, indexed by level.
+ */
+static const uint32_t ulLevelLimits[] =
+{
+    0U,
+    LOGGING_RATE_LIMIT_ERROR,
+    LOGGING_RATE_LIMIT_WARN,
+    LOGGING_RATE_LIMIT_INFO,
+    LOGGING_RATE_LIMIT_DEBUG
+};
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingRateLimitCheck( LoggingRateLimit_t * pxLimit,
+                                   uint8_t ucLevel,
+                                   uint32_t * pulRepeated )
+{
+    BaseType_t xReturn = pdTRUE;
+    #if ( LOGGING_RATE_LIMIT_FROM_ISR == 1 )
+        UBaseType_t uxSavedInterruptStatus;
+    #endif
+    TickType_t xNow;
+    uint32_t ulLimit;
+
+    configASSERT( pxLimit != NULL );
+    configASSERT( pulRepeated != NULL );
+
+    *pulRepeated = 0U;
+    ulLimit = ( ucLevel < ( sizeof( ulLevelLimits ) / sizeof( ulLevelLimits[ 0 ] ) ) ) ? ulLevelLimits[ ucLevel ] : 0U;
+
+    if( ulLimit != 0U )
+    {
+        #if ( LOGGING_RATE_LIMIT_FROM_ISR == 1 )
+            /* Messages may be logged from interrupts. */
+            uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+        #else
+            taskENTER_CRITICAL();
+        #endif
+        {
+            xNow = xTaskGetTickCountFromISR();
+
+            if( ( xNow - pxLimit->xPeriodStart ) >= pdMS_TO_TICKS( LOGGING_RATE_LIMIT_PERIOD_MS ) )
+            {
+                pxLimit->xPeriodStart = xNow;
+                pxLimit->ulLogged = 0U;
+            }
+
+            if( pxLimit->ulLogged < ulLimit )
+            {
+                pxLimit->ulLogged++;
+                *pulRepeated = pxLimit->ulSuppressed;
+                pxLimit->ulSuppressed = 0U;
+            }
+            else
+            {
+                pxLimit->ulSuppressed++;
+                xReturn = pdFALSE;
+            }
+        }
+        #if ( LOGGING_RATE_LIMIT_FROM_ISR == 1 )
+            taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+        #else
+            taskEXIT_CRITICAL();
+        #endif
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,137 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_ratelimit.h
+ * @brief Rate limiting of the messages logged by each call site.
+ *
+ * When #LOGGING_RATE_LIMIT is 1, every LogError, LogWarn, LogInfo and LogDebug
+ * call site has a LoggingRateLimit_t, and logs at most the number of messages
+ * set for its level in each period of #LOGGING_RATE_LIMIT_PERIOD_MS.  Further
+ * messages are counted instead of being formatted and output.  The next message
+ * the site logs is preceded by "Last message repeated N times.", so a storm of
+ * one failure costs a few lines rather than a line per occurrence.  LogAlways
+ * is never limited.
+ */
+
+#ifndef LOGGING_RATELIMIT_H
+#define LOGGING_RATELIMIT_H
+
+/* Standard Include. */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Include header for logging level macros. */
+#include "logging_levels.h"
+
+/**
+ * @brief The length of the period over which each call site is limited, in
+ * milliseconds.  Defaults to 1000.
+ */
+#ifndef LOGGING_RATE_LIMIT_PERIOD_MS
+    #define LOGGING_RATE_LIMIT_PERIOD_MS    1000U
+#endif
+
+/**
+ * @brief The number of error messages each call site logs per period.  Zero
+ * means unlimited.  Defaults to 5.
+ */
+#ifndef LOGGING_RATE_LIMIT_ERROR
+    #define LOGGING_RATE_LIMIT_ERROR    5U
+#endif
+
+/**
+ * @brief The number of warning messages each call site logs per period.  Zero
+ * means unlimited.  Defaults to 5.
+ */
+#ifndef LOGGING_RATE_LIMIT_WARN
+    #define LOGGING_RATE_LIMIT_WARN    5U
+#endif
+
+/**
+ * @brief The number of info messages each call site logs per period.  Zero
+ * means unlimited.  Defaults to 10.
+ */
+#ifndef LOGGING_RATE_LIMIT_INFO
+    #define LOGGING_RATE_LIMIT_INFO    10U
+#endif
+
+/**
+ * @brief The number of debug messages each call site logs per period.  Zero
+ * means unlimited.  Defaults to 0, as debug output is usually wanted in full.
+ */
+#ifndef LOGGING_RATE_LIMIT_DEBUG
+    #define LOGGING_RATE_LIMIT_DEBUG    0U
+#endif
+
+/**
+ * @brief Whether messages may be logged from interrupts.
+ *
+ * When 1, the state of each call site is guarded by
+ * taskENTER_CRITICAL_FROM_ISR().  The Windows and Posix simulator ports have
+ * no real interrupts and implement that as a no-op, which would leave the
+ * state unguarded between tasks, so on a host build the default is 0 and the
+ * state is guarded by taskENTER_CRITICAL() instead.  Messages must then only
+ * be logged from tasks.
+ */
+#ifndef LOGGING_RATE_LIMIT_FROM_ISR
+    #if defined( _WIN32 ) || defined( __unix__ ) || defined( __APPLE__ )
+        #define LOGGING_RATE_LIMIT_FROM_ISR    0
+    #else
+        #define LOGGING_RATE_LIMIT_FROM_ISR    1
+    #endif
+#endif
+
+/**
+ * @brief The rate limit state of one call site.  Zero initialised.
+ */
+typedef struct LoggingRateLimit
+{
+    TickType_t xPeriodStart; /**< @brief Tick count at the start of the current period. */
+    uint32_t ulLogged;       /**< @brief Messages logged in the current period. */
+    uint32_t ulSuppressed;   /**< @brief Messages suppressed since the last one logged. */
+} LoggingRateLimit_t;
+
+/**
+ * @brief Return whether the call site of pxLimit may log a message of ucLevel
+ * now, counting the message either way.
+ *
+ * Called by the logging macros for each message whose level is on; may be
+ * called from interrupts when #LOGGING_RATE_LIMIT_FROM_ISR is 1.
+ *
+ * @param[in] pxLimit The state of the call site.
+ * @param[in] ucLevel The level of the message.
+ * @param[out] pulRepeated When the message may be logged, set to the number of
+ * messages suppressed before it, to be reported first.
+ *
+ * @return pdTRUE if the message should be logged, otherwise pdFALSE.
+ */
+BaseType_t xLoggingRateLimitCheck( LoggingRateLimit_t * pxLimit,
+                                   uint8_t ucLevel,
+                                   uint32_t * pulRepeated );
+
+#endif /* ifndef LOGGING_RATELIMIT_H */
@@ -0,0 +1,295 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_runtime.c
+ * @brief The registry of the log level of each library.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "logging_runtime.h"
+
+#if ( LOGGING_RUNTIME_LEVELS_CLI == 1 )
+    #include "FreeRTOS_CLI.h"
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The registered modules, most recently registered first.
+ */
+static LoggingModule_t * pxModules = NULL;
+
+/**
+ * @brief The level given to modules when they are registered.
+ */
+static uint8_t ucDefaultLevel = ( uint8_t ) LOGGING_RUNTIME_DEFAULT_LEVEL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Return ucLevel, lowered to the ceiling of pxModule.
+ *
+ * @param[in] pxModule The module.
+ * @param[in] ucLevel The level wanted.
+ *
+ * @return The level the module can log at.
+ */
+static uint8_t prvLimitLevel( const LoggingModule_t * pxModule,
+                              uint8_t ucLevel );
+
+#if ( LOGGING_RUNTIME_LEVELS_CLI == 1 )
+
+/**
+ * @brief Implements the "log-level" command.
+ *
+ * With no parameters, prints one module per call.  With a module name, or
+ * "*", and a level name, sets the level.
+ *
+ * @param[out] pcWriteBuffer Buffer for the output.
+ * @param[in] xWriteBufferLen Length of pcWriteBuffer.
+ * @param[in] pcCommandString The command and its parameters.
+ *
+ * @return pdTRUE while there are more modules to print.
+ */
+    static BaseType_t prvLogLevelCommand( char * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const char * pcCommandString );
+
+/**
+ * @brief The names of the levels, indexed by level.
+ */
+    static const char * const pcLevelNames[] = { "none", "error", "warn", "info", "debug" };
+
+/**
+ * @brief Definition of the "log-level" command.
+ */
+    static const CLI_Command_Definition_t xLogLevelCommand =
+    {
+        "log-level",
+        "\r\nlog-level [<module>|* <none|error|warn|info|debug>]:\r\n Lists the log level of each module, or sets the level of a module\r\n",
+        prvLogLevelCommand,
+        -1
+    };
+#endif /* if ( LOGGING_RUNTIME_LEVELS_CLI == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+static uint8_t prvLimitLevel( const LoggingModule_t * pxModule,
+                              uint8_t ucLevel )
+{
+    return ( ucLevel > pxModule->ucCeiling ) ? pxModule->ucCeiling : ucLevel;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingModuleEnabled( LoggingModule_t * pxModule,
+                                  uint8_t ucLevel )
+{
+    UBaseType_t uxSavedInterruptStatus;
+
+    configASSERT( pxModule != NULL );
+
+    /* The first message may be logged from an interrupt. */
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        /* Another message of the same file may have registered it first. */
+        if( pxModule->ucLevel == LOGGING_LEVEL_UNREGISTERED )
+        {
+            pxModule->pxNext = pxModules;
+            pxModules = pxModule;
+            pxModule->ucLevel = prvLimitLevel( pxModule, ucDefaultLevel );
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    return ( pxModule->ucLevel >= ucLevel ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingSetLevel( const char * pcName,
+                             uint8_t ucLevel )
+{
+    BaseType_t xReturn = pdFAIL;
+    BaseType_t xAll;
+    LoggingModule_t * pxModule;
+    UBaseType_t uxSavedInterruptStatus;
+
+    configASSERT( pcName != NULL );
+    configASSERT( ucLevel <= ( uint8_t ) LOG_DEBUG );
+
+    xAll = ( strcmp( pcName, "*" ) == 0 ) ? pdTRUE : pdFALSE;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        if( xAll == pdTRUE )
+        {
+            ucDefaultLevel = ucLevel;
+            xReturn = pdPASS;
+        }
+
+        /* Several files of one library each have a module with its name. */
+        for( pxModule = pxModules; pxModule != NULL; pxModule = pxModule->pxNext )
+        {
+            if( ( xAll == pdTRUE ) || ( strcmp( pxModule->pcName, pcName ) == 0 ) )
+            {
+                pxModule->ucLevel = prvLimitLevel( pxModule, ucLevel );
+                xReturn = pdPASS;
+            }
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if ( LOGGING_RUNTIME_LEVELS_CLI == 1 )
+
+    void vLoggingRegisterCLICommand( void )
+    {
+        ( void ) FreeRTOS_CLIRegisterCommand( &xLogLevelCommand );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvLogLevelCommand( char * pcWriteBuffer,
+                                          size_t xWriteBufferLen,
+                                          const char * pcCommandString )
+    {
+        /* The module to print next.  FreeRTOS+CLI calls the command until it
+         * returns pdFALSE.  Modules are only ever added at the head of the
+         * list, so the rest of the list cannot change. */
+        static const LoggingModule_t * pxNextModule = NULL;
+        static BaseType_t xListing = pdFALSE;
+        const LoggingModule_t * pxModule;
+        const LoggingModule_t * pxEarlier;
+        const char * pcName;
+        const char * pcLevel;
+        BaseType_t xNameLength, xLevelLength, xExtraLength;
+        BaseType_t xReturn = pdFALSE;
+        uint8_t ucLevel;
+
+        configASSERT( pcWriteBuffer != NULL );
+
+        pcWriteBuffer[ 0 ] = '\0';
+        pcName = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xNameLength );
+        pcLevel = FreeRTOS_CLIGetParameter( pcCommandString, 2, &xLevelLength );
+
+        if( ( pcName == NULL ) && ( pcLevel == NULL ) )
+        {
+            if( xListing == pdFALSE )
+            {
+                pxNextModule = pxModules;
+                xListing = pdTRUE;
+            }
+
+            /* Print each name once, with the level of its first module. */
+            for( pxModule = pxNextModule; pxModule != NULL; pxModule = pxModule->pxNext )
+            {
+                for( pxEarlier = pxModules; pxEarlier != pxModule; pxEarlier = pxEarlier->pxNext )
+                {
+                    if( strcmp( pxEarlier->pcName, pxModule->pcName ) == 0 )
+                    {
+                        break;
+                    }
+                }
+
+                if( pxEarlier == pxModule )
+                {
+                    break;
+                }
+            }
+
+            if( pxModule != NULL )
+            {
+                ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "%s: %s (max %s)\r\n",
+                                   pxModule->pcName,
+                                   pcLevelNames[ pxModule->ucLevel ],
+                                   pcLevelNames[ pxModule->ucCeiling ] );
+                pxNextModule = pxModule->pxNext;
+                xReturn = pdTRUE;
+            }
+            else
+            {
+                ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "\r\n" );
+                xListing = pdFALSE;
+            }
+        }
+        else if( ( pcName != NULL ) && ( pcLevel != NULL ) && ( FreeRTOS_CLIGetParameter( pcCommandString, 3, &xExtraLength ) == NULL ) )
+        {
+            for( ucLevel = 0; ucLevel <= ( uint8_t ) LOG_DEBUG; ucLevel++ )
+            {
+                if( ( strlen( pcLevelNames[ ucLevel ] ) == ( size_t ) xLevelLength ) &&
+                    ( strncmp( pcLevelNames[ ucLevel ], pcLevel, ( size_t ) xLevelLength ) == 0 ) )
+                {
+                    break;
+                }
+            }
+
+            if( ucLevel > ( uint8_t ) LOG_DEBUG )
+            {
+                ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "Unknown level.\r\n" );
+            }
+            else
+            {
+                /* The name is the start of the command string, not a string of
+                 * its own. */
+                char cName[ 32 ];
+
+                if( ( size_t ) xNameLength >= sizeof( cName ) )
+                {
+                    xNameLength = ( BaseType_t ) ( sizeof( cName ) - 1U );
+                }
+
+                ( void ) memcpy( cName, pcName, ( size_t ) xNameLength );
+                cName[ xNameLength ] = '\0';
+
+                if( xLoggingSetLevel( cName, ucLevel ) == pdPASS )
+                {
+                    ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "%s: %s\r\n", cName, pcLevelNames[ ucLevel ] );
+                }
+                else
+                {
+                    ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "Unknown module.  Modules are listed once they have logged a message.\r\n" );
+                }
+            }
+        }
+        else
+        {
+            ( void ) snprintf( pcWriteBuffer, xWriteBufferLen, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n" );
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( LOGGING_RUNTIME_LEVELS_CLI == 1 ) */
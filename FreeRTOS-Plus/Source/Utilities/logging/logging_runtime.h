@@ -0,0 +1,122 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file logging_runtime.h
+ * @brief Run time control of the log level of each library.
+ *
+ * When #LOGGING_RUNTIME_LEVELS is 1, every file that includes logging_stack.h
+ * has a LoggingModule_t holding the level its LIBRARY_LOG_NAME logs at.  The
+ * first message the file logs adds the module to a registry, after which each
+ * LogError, LogWarn, LogInfo and LogDebug call only costs a load and a compare
+ * when its level is off.  LIBRARY_LOG_LEVEL remains the compile time ceiling:
+ * levels above it are compiled out and cannot be turned on at run time.
+ */
+
+#ifndef LOGGING_RUNTIME_H
+#define LOGGING_RUNTIME_H
+
+/* Standard Include. */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Include header for logging level macros. */
+#include "logging_levels.h"
+
+/**
+ * @brief The level modules log at when they are registered, unless changed
+ * with #xLoggingSetLevel and the name "*".  Modules never log above their
+ * LIBRARY_LOG_LEVEL.  Defaults to LOG_DEBUG, so that every message compiled in
+ * is logged until a level is lowered.
+ */
+#ifndef LOGGING_RUNTIME_DEFAULT_LEVEL
+    #define LOGGING_RUNTIME_DEFAULT_LEVEL    LOG_DEBUG
+#endif
+
+/**
+ * @brief Set to 1 to provide a "log-level" FreeRTOS+CLI command, registered
+ * by #vLoggingRegisterCLICommand.  Requires FreeRTOS+CLI.  Defaults to 0.
+ */
+#ifndef LOGGING_RUNTIME_LEVELS_CLI
+    #define LOGGING_RUNTIME_LEVELS_CLI    0
+#endif
+
+/**
+ * @brief The level of a module that has not been registered yet.  Above
+ * every level, so the first message always reaches #xLoggingModuleEnabled.
+ */
+#define LOGGING_LEVEL_UNREGISTERED    ( ( uint8_t ) 0xFFU )
+
+/**
+ * @brief The log level of the files of one library.
+ */
+typedef struct LoggingModule
+{
+    const char * pcName;            /**< @brief The LIBRARY_LOG_NAME of the file. */
+    volatile uint8_t ucLevel;       /**< @brief The level logged at, or #LOGGING_LEVEL_UNREGISTERED. */
+    uint8_t ucCeiling;              /**< @brief The LIBRARY_LOG_LEVEL of the file. */
+    struct LoggingModule * pxNext;  /**< @brief The next module in the registry. */
+} LoggingModule_t;
+
+/**
+ * @brief Register pxModule, if it is not registered yet, and return whether
+ * it logs messages of ucLevel.
+ *
+ * Called by the logging macros for the first message of each file; may be
+ * called from interrupts.
+ *
+ * @param[in] pxModule The module of the file.
+ * @param[in] ucLevel The level of the message.
+ *
+ * @return pdTRUE if the message should be logged, otherwise pdFALSE.
+ */
+BaseType_t xLoggingModuleEnabled( LoggingModule_t * pxModule,
+                                  uint8_t ucLevel );
+
+/**
+ * @brief Set the level of the modules called pcName.
+ *
+ * Modules never log above their LIBRARY_LOG_LEVEL, whatever ucLevel is.  The
+ * name "*" sets the level of every module, including those registered later.
+ *
+ * @param[in] pcName The LIBRARY_LOG_NAME of the modules, or "*".
+ * @param[in] ucLevel LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO or LOG_DEBUG.
+ *
+ * @return pdPASS if a module was found, otherwise pdFAIL.
+ */
+BaseType_t xLoggingSetLevel( const char * pcName,
+                             uint8_t ucLevel );
+
+#if ( LOGGING_RUNTIME_LEVELS_CLI == 1 )
+
+/**
+ * @brief Register the "log-level" command with FreeRTOS+CLI.
+ */
+    void vLoggingRegisterCLICommand( void );
+#endif
+
+#endif /* ifndef LOGGING_RUNTIME_H */
@@ -78,6 +78,144 @@
     #define SdkLog( message )    vLoggingPrintf message
 #endif
 
+/**
+ * @brief Set to 1 to record log messages in a ring buffer, to be formatted
+ * later by uxLoggingDeferredProcess(), instead of formatting them where they
+ * are logged.  See logging_deferred.h.
+ *
+ * In deferred mode #SdkLog, #LOG_METADATA_FORMAT and #LOG_METADATA_ARGS are
+ * not used: each message is one record, and its metadata is the level, the
+ * library name, the function and the line.  Defaults to 0.
+ */
+#ifndef LOGGING_DEFERRED
+    #define LOGGING_DEFERRED    0
+#endif
+
+/**
+ * @brief Set to 1 to emit each log message with a single call to #SdkLogLine,
+ * instead of three calls to #SdkLog for the metadata prefix, the message and
+ * the line ending.  The backend then takes its lock and writes its output once
+ * per line, and lines logged by different tasks cannot interleave.
+ *
+ * The level and the library name are joined into one string at compile time.
+ * #LOG_METADATA_FORMAT and #LOG_METADATA_ARGS are not used: the backend
+ * formats the function and the line itself.  Ignored when #LOGGING_DEFERRED
+ * is 1.  Defaults to 0.
+ */
+#ifndef LOGGING_SINGLE_CALL
+    #define LOGGING_SINGLE_CALL    0
+#endif
+
+/* Removes the parentheses around the format and arguments of a message. */
+#define LOG_DEFERRED_ARGUMENTS( ... )    __VA_ARGS__
+
+/**
+ * @brief Macro that maps one complete log line to the platform-specific
+ * logging function when #LOGGING_SINGLE_CALL is 1.
+ *
+ * @note The default definition calls vLoggingPrintfLine(), which writes
+ * pcPrefix, then "[<function>:<line>] ", then the formatted message and "\r\n".
+ */
+#ifndef SdkLogLine
+    #define SdkLogLine( prefix, message )    vLoggingPrintfLine( prefix, __FUNCTION__, __LINE__, LOG_DEFERRED_ARGUMENTS message )
+#endif
+
+/**
+ * @brief Log one message, with its metadata prefix and line ending.
+ */
+#if ( LOGGING_DEFERRED == 1 )
+    #include "logging_deferred.h"
+
+    #define LOG_MESSAGE( level, message )                                       \
+    do                                                                          \
+    {                                                                           \
+        static const LoggingDeferredSite_t xLogSite =                           \
+        {                                                                       \
+            level, LIBRARY_LOG_NAME, __FUNCTION__, ( uint32_t ) __LINE__        \
+        };                                                                      \
+        vLoggingDeferredPrintf( &xLogSite, LOG_DEFERRED_ARGUMENTS message );    \
+    } while( 0 )
+#elif ( LOGGING_SINGLE_CALL == 1 )
+    #define LOG_MESSAGE( level, message )    SdkLogLine( level " [" LIBRARY_LOG_NAME "] ", message )
+#else
+    #define LOG_MESSAGE( level, message )    SdkLog( ( level " [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+#endif
+
+/**
+ * @brief Set to 1 to limit the number of messages each LogError, LogWarn,
+ * LogInfo and LogDebug call site logs per period, and to report how many were
+ * suppressed.  The limits of each level are set in logging_ratelimit.h.
+ * Defaults to 0.
+ */
+#ifndef LOGGING_RATE_LIMIT
+    #define LOGGING_RATE_LIMIT    0
+#endif
+
+/**
+ * @brief Log one message of level levelValue, subject to the rate limit of its
+ * call site.
+ */
+#if ( LOGGING_RATE_LIMIT == 1 )
+    #include "logging_ratelimit.h"
+
+    #define LOG_EMIT( levelValue, level, message )                                                             \
+    do                                                                                                         \
+    {                                                                                                          \
+        static LoggingRateLimit_t xLogRateLimit;                                                               \
+        uint32_t ulLogRepeated;                                                                                \
+        if( xLoggingRateLimitCheck( &xLogRateLimit, ( uint8_t ) ( levelValue ), &ulLogRepeated ) != pdFALSE )  \
+        {                                                                                                      \
+            if( ulLogRepeated != 0U )                                                                          \
+            {                                                                                                  \
+                LOG_MESSAGE( level, ( "Last message repeated %lu times.", ( unsigned long ) ulLogRepeated ) ); \
+            }                                                                                                  \
+            LOG_MESSAGE( level, message );                                                                     \
+        }                                                                                                      \
+    } while( 0 )
+#else
+    #define LOG_EMIT( levelValue, level, message )    LOG_MESSAGE( level, message )
+#endif
+
+/**
+ * @brief Set to 1 to allow the level of each library to be lowered, and raised
+ * again up to its LIBRARY_LOG_LEVEL, at run time.  See logging_runtime.h.
+ * Defaults to 0, in which case the level is only set by LIBRARY_LOG_LEVEL.
+ */
+#ifndef LOGGING_RUNTIME_LEVELS
+    #define LOGGING_RUNTIME_LEVELS    0
+#endif
+
+/**
+ * @brief Log one message of level levelValue, if that level is on.
+ */
+#if ( LOGGING_RUNTIME_LEVELS == 1 )
+    #include "logging_runtime.h"
+
+/* The level of this file.  One load and one compare skip a message whose
+ * level is off; the first message registers the module. */
+    static LoggingModule_t xLoggingModule = { LIBRARY_LOG_NAME, LOGGING_LEVEL_UNREGISTERED, ( uint8_t ) LIBRARY_LOG_LEVEL, NULL };
+
+/* Refers to xLoggingModule, so files that include this header without logging
+ * anything do not warn that it is unused. */
+    static inline LoggingModule_t * pxLoggingGetModule( void )
+    {
+        return &xLoggingModule;
+    }
+
+    #define LOG_AT( levelValue, level, message )                                                          \
+    do                                                                                                    \
+    {                                                                                                     \
+        if( ( xLoggingModule.ucLevel >= ( uint8_t ) ( levelValue ) ) &&                                   \
+            ( ( xLoggingModule.ucLevel != LOGGING_LEVEL_UNREGISTERED ) ||                                 \
+              ( xLoggingModuleEnabled( &xLoggingModule, ( uint8_t ) ( levelValue ) ) != pdFALSE ) ) )     \
+        {                                                                                                 \
+            LOG_EMIT( levelValue, level, message );                                                       \
+        }                                                                                                 \
+    } while( 0 )
+#else
+    #define LOG_AT( levelValue, level, message )    LOG_EMIT( levelValue, level, message )
+#endif
+
 /**
  * Disable definition of logging interface macros when generating doxygen output,
  * to avoid conflict with documentation of macros at the end of the file.
@@ -93,32 +231,32 @@
 #else
     #if LIBRARY_LOG_LEVEL == LOG_DEBUG
         /* All log level messages will logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )     SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )      SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogInfo( message )      SdkLog( ( "[INFO] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogDebug( message )     SdkLog( ( "[DEBUG] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LOG_MESSAGE( "[ALWAYS]", message )
+        #define LogError( message )     LOG_AT( LOG_ERROR, "[ERROR]", message )
+        #define LogWarn( message )      LOG_AT( LOG_WARN, "[WARN]", message )
+        #define LogInfo( message )      LOG_AT( LOG_INFO, "[INFO]", message )
+        #define LogDebug( message )     LOG_AT( LOG_DEBUG, "[DEBUG]", message )
 
     #elif LIBRARY_LOG_LEVEL == LOG_INFO
         /* Only INFO, WARNING, ERROR, and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )     SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )      SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogInfo( message )      SdkLog( ( "[INFO] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LOG_MESSAGE( "[ALWAYS]", message )
+        #define LogError( message )     LOG_AT( LOG_ERROR, "[ERROR]", message )
+        #define LogWarn( message )      LOG_AT( LOG_WARN, "[WARN]", message )
+        #define LogInfo( message )      LOG_AT( LOG_INFO, "[INFO]", message )
         #define LogDebug( message )
 
     #elif LIBRARY_LOG_LEVEL == LOG_WARN
         /* Only WARNING, ERROR, and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )     SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogWarn( message )      SdkLog( ( "[WARN] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LOG_MESSAGE( "[ALWAYS]", message )
+        #define LogError( message )     LOG_AT( LOG_ERROR, "[ERROR]", message )
+        #define LogWarn( message )      LOG_AT( LOG_WARN, "[WARN]", message )
         #define LogInfo( message )
         #define LogDebug( message )
 
     #elif LIBRARY_LOG_LEVEL == LOG_ERROR
         /* Only ERROR and ALWAYS messages will be logged. */
-        #define LogAlways( message )    SdkLog( ( "[ALWAYS] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
-        #define LogError( message )     SdkLog( ( "[ERROR] [%s] "LOG_METADATA_FORMAT, LIBRARY_LOG_NAME, LOG_METADATA_ARGS ) ); SdkLog( message ); SdkLog( ( "\r\n" ) )
+        #define LogAlways( message )    LOG_MESSAGE( "[ALWAYS]", message )
+        #define LogError( message )     LOG_AT( LOG_ERROR, "[ERROR]", message )
         #define LogWarn( message )
         #define LogInfo( message )
         #define LogDebug( message )
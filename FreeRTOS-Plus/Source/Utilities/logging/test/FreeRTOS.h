@@ -0,0 +1,28 @@
+/*
+ * The parts of FreeRTOS.h logging_deferred.c uses, for running its tests on
+ * the host.
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef long            BaseType_t;
+typedef unsigned long   UBaseType_t;
+
+#define pdFALSE                                   ( ( BaseType_t ) 0 )
+#define pdTRUE                                    ( ( BaseType_t ) 1 )
+
+#define configASSERT( x )                         assert( x )
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()         0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    ( void ) ( x )
+
+/* Capture each message instead of printing it. */
+void vTestLoggingOutput( const char * pcMessage );
+#define LOGGING_DEFERRED_OUTPUT( pcMessage )      vTestLoggingOutput( pcMessage )
+
+#endif /* INC_FREERTOS_H */
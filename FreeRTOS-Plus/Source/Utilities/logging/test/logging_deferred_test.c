@@ -0,0 +1,104 @@
+/*
+ * Host tests of logging_deferred.c: make check
+ */
+
+/* Standard includes. */
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "logging_deferred.h"
+
+static char cOutput[ LOGGING_DEFERRED_LINE_LENGTH ];
+static int iFailures = 0;
+
+static const LoggingDeferredSite_t xSite = { "[INFO]", "TEST", "test", 1 };
+
+#define CHECK( x )                                                            \
+    do {                                                                      \
+        if( !( x ) )                                                          \
+        {                                                                     \
+            printf( "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x );    \
+            iFailures++;                                                      \
+        }                                                                     \
+    } while( 0 )
+
+/* The metadata prefix of every message. */
+#define PREFIX    "[INFO] [TEST] [test:1] "
+
+/*-----------------------------------------------------------*/
+
+void vTestLoggingOutput( const char * pcMessage )
+{
+    ( void ) strncpy( cOutput, pcMessage, sizeof( cOutput ) - 1U );
+}
+
+/* Only here so logging.h, which logging_deferred.c includes, links. */
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    ( void ) pcFormat;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTestArguments( void )
+{
+    cOutput[ 0 ] = '\0';
+    vLoggingDeferredPrintf( &xSite, "%d %s %*d %.2f %%", 42, "str", 4, 7, 1.5 );
+    CHECK( uxLoggingDeferredProcess() == 1 );
+    CHECK( strcmp( cOutput, PREFIX "42 str    7 1.50 %\r\n" ) == 0 );
+}
+
+/* A '*' replaced by a long width must not overflow the specification. */
+static void prvTestOverlongSpecification( void )
+{
+    cOutput[ 0 ] = '\0';
+    vLoggingDeferredPrintf( &xSite, "a %0000000000000000000000000*d b %d", INT_MIN, 5, 6 );
+    CHECK( uxLoggingDeferredProcess() == 1 );
+    CHECK( strcmp( cOutput, PREFIX "a <invalid conversion>\r\n" ) == 0 );
+
+    /* Too long without a '*' too. */
+    vLoggingDeferredPrintf( &xSite, "c %00000000000000000000000000000000000000d", 5 );
+    CHECK( uxLoggingDeferredProcess() == 1 );
+    CHECK( strcmp( cOutput, PREFIX "c <invalid conversion>\r\n" ) == 0 );
+}
+
+/* A long double is stored, so the arguments after it are read correctly. */
+static void prvTestLongDouble( void )
+{
+    cOutput[ 0 ] = '\0';
+    vLoggingDeferredPrintf( &xSite, "%Lf %d %s", ( long double ) 2.5, 9, "end" );
+    CHECK( uxLoggingDeferredProcess() == 1 );
+    CHECK( strcmp( cOutput, PREFIX "2.500000 9 end\r\n" ) == 0 );
+}
+
+/* The arguments that do not fit in the record are left out. */
+static void prvTestRecordFull( void )
+{
+    char cLong[ LOGGING_DEFERRED_MAX_STRING + 1U ];
+
+    ( void ) memset( cLong, 'x', sizeof( cLong ) - 1U );
+    cLong[ sizeof( cLong ) - 1U ] = '\0';
+
+    cOutput[ 0 ] = '\0';
+    vLoggingDeferredPrintf( &xSite, "%s %s %s %s %s", cLong, cLong, cLong, cLong, cLong );
+    CHECK( uxLoggingDeferredProcess() == 1 );
+    CHECK( strstr( cOutput, "...\r\n" ) != NULL );
+}
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    prvTestArguments();
+    prvTestOverlongSpecification();
+    prvTestLongDouble();
+    prvTestRecordFull();
+
+    CHECK( ulLoggingDeferredGetDropped() == 0 );
+    CHECK( uxLoggingDeferredProcess() == 0 );
+
+    printf( "%d failed checks\n", iFailures );
+
+    return ( iFailures == 0 ) ? 0 : 1;
+}
@@ -0,0 +1 @@
+/* logging_deferred.c includes task.h, but uses nothing from it. */
@@ -48,9 +48,32 @@
 
 
 /* Sizes of the thread safe circular buffers used to pass data to and from the
- * WinPCAP Windows threads. */
-#define xSEND_BUFFER_SIZE    32768
-#define xRECV_BUFFER_SIZE    32768
+ * WinPCAP Windows threads.  Large enough to absorb a burst of full size frames
+ * while the FreeRTOS side is not running. */
+#ifndef xSEND_BUFFER_SIZE
+    #define xSEND_BUFFER_SIZE    262144
+#endif
+#ifndef xRECV_BUFFER_SIZE
+    #define xRECV_BUFFER_SIZE    262144
+#endif
+
+/* The Tx thread collects the packets waiting in xSendBuffer into a WinPCAP
+ * send queue of this many bytes, so a burst is passed to the driver in one
+ * call rather than one call per packet. */
+#ifndef niSEND_QUEUE_SIZE
+    #define niSEND_QUEUE_SIZE    65536
+#endif
+
+/* The most packets the Rx thread takes from WinPCAP per pcap_dispatch() call.
+ * -1 takes everything the driver has buffered. */
+#ifndef niRECV_BATCH
+    #define niRECV_BATCH         -1
+#endif
+
+/* If not 0, the packet rates and drop counts are printed this often. */
+#ifndef niSTATS_PERIOD_MS
+    #define niSTATS_PERIOD_MS    0
+#endif
 
 /* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
  * driver will filter incoming packets and only pass the stack those packets it
@@ -73,6 +96,12 @@
 DWORD WINAPI prvWinPcapRecvThread( void * pvParam );
 DWORD WINAPI prvWinPcapSendThread( void * pvParam );
 
+/*
+ * Pass the packets collected in a WinPCAP send queue to the driver, then empty
+ * the queue.
+ */
+static void prvFlushSendQueue( pcap_send_queue * pxSendQueue );
+
 /*
  * A pointer to the network interface is needed later when receiving packets.
  */
@@ -140,6 +169,13 @@ static const char * prvRemoveSpaces( char * pcBuffer,
  */
 static BaseType_t xPacketBouncedBack( const uint8_t * pucBuffer );
 
+/*
+ * Print the packet rates and drop counts since the last call.
+ */
+#if ( niSTATS_PERIOD_MS != 0 )
+    static void prvPrintStatistics( void );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Required by the WinPCap library. */
@@ -167,6 +203,15 @@ static StreamBuffer_t * xRecvBuffer = NULL;
 /* Logs the number of WinPCAP send failures, for viewing in the debugger only. */
 static volatile uint32_t ulWinPCAPSendFailures = 0;
 
+/* Packet counts, each updated by one thread only.  The drops are packets that
+ * did not fit in xRecvBuffer or xSendBuffer, and the packets WinPCAP itself
+ * dropped as reported by pcap_stats(). */
+static volatile uint32_t ulWinPCAPRecvPackets = 0;
+static volatile uint32_t ulWinPCAPRecvDrops = 0;
+static volatile uint32_t ulWinPCAPSendPackets = 0;
+static volatile uint32_t ulWinPCAPSendDrops = 0;
+static volatile uint32_t ulWinPCAPDriverDrops = 0;
+
 /*-----------------------------------------------------------*/
 
 static BaseType_t xWinPcap_NetworkInterfaceInitialise( NetworkInterface_t * pxInterface );
@@ -313,6 +358,7 @@ static BaseType_t xWinPcap_NetworkInterfaceOutput( NetworkInterface_t * pxInterf
     }
     else
     {
+        ulWinPCAPSendDrops++;
         FreeRTOS_debug_printf( ( "xNetworkInterfaceOutput: send buffers full to store %lu\n", pxNetworkBuffer->xDataLength ) );
     }
 
@@ -687,12 +733,20 @@ void pcap_callback( u_char * user,
          * a Windows thread. */
         prvStreamBufferAdd( xRecvBuffer, ( const uint8_t * ) pkt_header, sizeof( *pkt_header ) );
         prvStreamBufferAdd( xRecvBuffer, ( const uint8_t * ) pkt_data, ( size_t ) pkt_header->caplen );
+        ulWinPCAPRecvPackets++;
+    }
+    else
+    {
+        ulWinPCAPRecvDrops++;
     }
 }
 /*-----------------------------------------------------------*/
 
 DWORD WINAPI prvWinPcapRecvThread( void * pvParam )
 {
+    struct pcap_stat xStats;
+    DWORD ulLastStats = GetTickCount();
+
     ( void ) pvParam;
 
     /* THIS IS A WINDOWS THREAD - DO NOT ATTEMPT ANY FREERTOS CALLS	OR TO PRINT
@@ -700,7 +754,40 @@ DWORD WINAPI prvWinPcapRecvThread( void * pvParam )
 
     for( ; ; )
     {
-        pcap_dispatch( pxOpenedInterfaceHandle, 1, pcap_callback, ( u_char * ) "mydata" );
+        /* Handle every packet the driver returned in one read, rather than a
+         * read per packet. */
+        pcap_dispatch( pxOpenedInterfaceHandle, niRECV_BATCH, pcap_callback, ( u_char * ) "mydata" );
+
+        /* The handle is only used by this thread and the Tx thread, so the
+         * driver's own drop count is fetched here. */
+        if( ( GetTickCount() - ulLastStats ) >= 1000UL )
+        {
+            ulLastStats = GetTickCount();
+
+            if( pcap_stats( pxOpenedInterfaceHandle, &xStats ) == 0 )
+            {
+                ulWinPCAPDriverDrops = ( uint32_t ) xStats.ps_drop;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlushSendQueue( pcap_send_queue * pxSendQueue )
+{
+    /* THIS IS CALLED FROM A WINDOWS THREAD - DO NOT ATTEMPT ANY FREERTOS CALLS
+     * OR TO PRINT OUT MESSAGES HERE. */
+
+    if( pxSendQueue->len != 0 )
+    {
+        /* Send as fast as possible, rather than at the intervals given by the
+         * time stamps, which are not set. */
+        if( pcap_sendqueue_transmit( pxOpenedInterfaceHandle, pxSendQueue, 0 ) < pxSendQueue->len )
+        {
+            ulWinPCAPSendFailures++;
+        }
+
+        pxSendQueue->len = 0;
     }
 }
 /*-----------------------------------------------------------*/
@@ -709,7 +796,8 @@ DWORD WINAPI prvWinPcapSendThread( void * pvParam )
 {
     size_t xLength;
     uint8_t ucBuffer[ ipconfigNETWORK_MTU + ipSIZE_OF_ETH_HEADER ];
-    static char cErrorMessage[ 1024 ];
+    struct pcap_pkthdr xHeader;
+    pcap_send_queue * pxSendQueue;
     const DWORD xMaxMSToWait = 1000;
 
     /* THIS IS A WINDOWS THREAD - DO NOT ATTEMPT ANY FREERTOS CALLS	OR TO PRINT
@@ -718,6 +806,11 @@ DWORD WINAPI prvWinPcapSendThread( void * pvParam )
     /* Remove compiler warnings about unused parameters. */
     ( void ) pvParam;
 
+    memset( &xHeader, '\0', sizeof( xHeader ) );
+
+    /* If the queue cannot be allocated each packet is sent on its own. */
+    pxSendQueue = pcap_sendqueue_alloc( niSEND_QUEUE_SIZE );
+
     for( ; ; )
     {
         /* Wait until notified of something to send. */
@@ -735,10 +828,30 @@ DWORD WINAPI prvWinPcapSendThread( void * pvParam )
              * Otherwise, there is no action. */
             iptraceDUMP_PACKET( ucBuffer, xLength, pdFALSE );
 
-            if( pcap_sendpacket( pxOpenedInterfaceHandle, ucBuffer, xLength ) != 0 )
+            if( pxSendQueue != NULL )
+            {
+                xHeader.caplen = ( bpf_u_int32 ) xLength;
+                xHeader.len = ( bpf_u_int32 ) xLength;
+
+                /* Send what is queued to make room if the queue is full. */
+                if( pcap_sendqueue_queue( pxSendQueue, &xHeader, ucBuffer ) != 0 )
+                {
+                    prvFlushSendQueue( pxSendQueue );
+                    ( void ) pcap_sendqueue_queue( pxSendQueue, &xHeader, ucBuffer );
+                }
+            }
+            else if( pcap_sendpacket( pxOpenedInterfaceHandle, ucBuffer, xLength ) != 0 )
             {
                 ulWinPCAPSendFailures++;
             }
+
+            ulWinPCAPSendPackets++;
+        }
+
+        /* Everything waiting has been queued, so send it in one call. */
+        if( pxSendQueue != NULL )
+        {
+            prvFlushSendQueue( pxSendQueue );
         }
     }
 }
@@ -792,11 +905,25 @@ static void prvInterruptSimulatorTask( void * pvParameters )
     IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
     eFrameProcessingResult_t eResult;
 
+    #if ( niSTATS_PERIOD_MS != 0 )
+        TickType_t xLastStatistics = xTaskGetTickCount();
+    #endif
+
     /* Remove compiler warnings about unused parameters. */
     ( void ) pvParameters;
 
     for( ; ; )
     {
+        #if ( niSTATS_PERIOD_MS != 0 )
+        {
+            if( ( xTaskGetTickCount() - xLastStatistics ) >= pdMS_TO_TICKS( niSTATS_PERIOD_MS ) )
+            {
+                xLastStatistics = xTaskGetTickCount();
+                prvPrintStatistics();
+            }
+        }
+        #endif
+
         /* Does the circular buffer used to pass data from the Win32 thread that
          * handles WinPCAP Rx into the FreeRTOS simulator contain another packet? */
         if( uxStreamBufferGetSize( xRecvBuffer ) > sizeof( xHeader ) )
@@ -911,6 +1038,35 @@ static void prvInterruptSimulatorTask( void * pvParameters )
 }
 /*-----------------------------------------------------------*/
 
+#if ( niSTATS_PERIOD_MS != 0 )
+
+    static void prvPrintStatistics( void )
+    {
+        static uint32_t ulLastRecvPackets = 0, ulLastSendPackets = 0;
+        static TickType_t xLastTime = 0;
+        uint32_t ulRecvPackets = ulWinPCAPRecvPackets, ulSendPackets = ulWinPCAPSendPackets;
+        TickType_t xNow = xTaskGetTickCount();
+        uint32_t ulElapsedMS = ( uint32_t ) ( ( xNow - xLastTime ) * portTICK_PERIOD_MS );
+
+        if( ulElapsedMS != 0U )
+        {
+            FreeRTOS_printf( ( "WinPCap: rx %lu pkt/s tx %lu pkt/s, drops rx ring %lu driver %lu tx ring %lu, send failures %lu\n",
+                               ( unsigned long ) ( ( ( uint64_t ) ( ulRecvPackets - ulLastRecvPackets ) * 1000U ) / ulElapsedMS ),
+                               ( unsigned long ) ( ( ( uint64_t ) ( ulSendPackets - ulLastSendPackets ) * 1000U ) / ulElapsedMS ),
+                               ( unsigned long ) ulWinPCAPRecvDrops,
+                               ( unsigned long ) ulWinPCAPDriverDrops,
+                               ( unsigned long ) ulWinPCAPSendDrops,
+                               ( unsigned long ) ulWinPCAPSendFailures ) );
+        }
+
+        ulLastRecvPackets = ulRecvPackets;
+        ulLastSendPackets = ulSendPackets;
+        xLastTime = xNow;
+    }
+
+#endif /* niSTATS_PERIOD_MS */
+/*-----------------------------------------------------------*/
+
 static const char * prvRemoveSpaces( char * pcBuffer,
                                      int aBuflen,
                                      const char * pcMessage )
@@ -1737,7 +1737,7 @@ void mbedtls_platform_free( void * ptr );
  *
  * Comment this macro to disable support for the max_fragment_length extension
  */
-/* #define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
 
 /**
  * \def MBEDTLS_SSL_RECORD_SIZE_LIMIT
@@ -2018,7 +2018,7 @@ void mbedtls_platform_free( void * ptr );
  *
  * Requires: MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
  */
-/* #define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
 
 /**
  * \def MBEDTLS_TEST_CONSTANT_FLOW_MEMSAN
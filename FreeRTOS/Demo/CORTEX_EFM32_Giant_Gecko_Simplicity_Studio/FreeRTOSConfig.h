@@ -123,6 +123,13 @@ extern "C" {
 
 #endif
 
+/* Set configUSE_LOW_POWER_BENCHMARK to 1, with a low power demo selected, to
+run the tickless idle benchmark of Demo/Common/Minimal/LowPowerBenchmark.c in
+place of the tasks of the low power demo.  The sleep depths it reports are the
+energy modes EM0 to EM4. */
+#define configUSE_LOW_POWER_BENCHMARK	0
+#define lpbSLEEP_DEPTHS					( 5 )
+
 /* Main functions*/
 #define configUSE_PREEMPTION					( 1 )
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION	( 1 )
@@ -38,6 +38,9 @@
 #include "em_int.h"
 #include "sleep.h"
 
+/* Demo includes. */
+#include "LowPowerBenchmark.h"
+
 /* SEE THE COMMENTS ABOVE THE DEFINITION OF configCREATE_LOW_POWER_DEMO IN
 FreeRTOSConfig.h
 This file contains functions that will override the default implementations
@@ -198,9 +201,13 @@ TickType_t xModifiableIdleTime;
 		instruction. */
 		if( xModifiableIdleTime > 0 )
 		{
+			/* LowPowerBenchmark.c numbers the sleep depths by the energy mode
+			SLEEP_Sleep() enters. */
+			lpbSLEEP_ENTER( ( UBaseType_t ) SLEEP_LowestEnergyModeGet() );
 			__asm volatile( "dsb" );
 			SLEEP_Sleep();
 			__asm volatile( "isb" );
+			lpbSLEEP_EXIT();
 		}
 
 		/* Allow the application to define some post sleep processing. */
@@ -267,7 +274,9 @@ TickType_t xModifiableIdleTime;
 		BURTC_Enable( true );
 
 		/* Wind the tick forward by the number of tick periods that the CPU
-		remained in a low power state. */
+		remained in a low power state.  When the tick interrupt ended the
+		sleep the pending tick was slept through too. */
+		lpbTICKS_SLEPT( ( ulTickFlag != pdFALSE ) ? xExpectedIdleTime : ulCompleteTickPeriods );
 		vTaskStepTick( ulCompleteTickPeriods );
 	}
 }
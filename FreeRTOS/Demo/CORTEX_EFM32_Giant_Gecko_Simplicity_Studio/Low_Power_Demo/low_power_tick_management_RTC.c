@@ -36,6 +36,9 @@
 #include "em_int.h"
 #include "sleep.h"
 
+/* Demo includes. */
+#include "LowPowerBenchmark.h"
+
 #define lpINCLUDE_TEST_TIMER	1
 
 /* SEE THE COMMENTS ABOVE THE DEFINITION OF configCREATE_LOW_POWER_DEMO IN
@@ -224,9 +227,13 @@ TickType_t xModifiableIdleTime;
 		instruction. */
 		if( xModifiableIdleTime > 0 )
 		{
+			/* LowPowerBenchmark.c numbers the sleep depths by the energy mode
+			SLEEP_Sleep() enters. */
+			lpbSLEEP_ENTER( ( UBaseType_t ) SLEEP_LowestEnergyModeGet() );
 			__asm volatile( "dsb" );
 			SLEEP_Sleep();
 			__asm volatile( "isb" );
+			lpbSLEEP_EXIT();
 		}
 
 		/* Allow the application to define some post sleep processing. */
@@ -293,7 +300,9 @@ TickType_t xModifiableIdleTime;
 		RTC_Enable( true );
 
 		/* Wind the tick forward by the number of tick periods that the CPU
-		remained in a low power state. */
+		remained in a low power state.  When the tick interrupt ended the
+		sleep the pending tick was slept through too. */
+		lpbTICKS_SLEPT( ( ulTickFlag != pdFALSE ) ? xExpectedIdleTime : ulCompleteTickPeriods );
 		vTaskStepTick( ulCompleteTickPeriods );
 	}
 }
@@ -66,6 +66,9 @@
 /* SiLabs includes. */
 #include "bsp.h"
 
+/* Demo includes. */
+#include "LowPowerBenchmark.h"
+
 /* Priorities at which the tasks are created. */
 #define mainQUEUE_RECEIVE_TASK_PRIORITY		( tskIDLE_PRIORITY + 2 )
 #define	mainQUEUE_SEND_TASK_PRIORITY		( tskIDLE_PRIORITY + 1 )
@@ -105,8 +108,19 @@ static QueueHandle_t xQueue = NULL;
 
 void main_low_power( void )
 {
-	/* Create the queue. */
-	xQueue = xQueueCreate( mainQUEUE_LENGTH, sizeof( uint32_t ) );
+	#if( configUSE_LOW_POWER_BENCHMARK == 1 )
+	{
+		/* The benchmark must be the only task, so that it causes every sleep.
+		Its results are viewed in the debugger. */
+		vStartLowPowerBenchmark( mainQUEUE_SEND_TASK_PRIORITY );
+		vTaskStartScheduler();
+	}
+	#else
+	{
+		/* Create the queue. */
+		xQueue = xQueueCreate( mainQUEUE_LENGTH, sizeof( uint32_t ) );
+	}
+	#endif /* configUSE_LOW_POWER_BENCHMARK */
 
 	if( xQueue != NULL )
 	{
@@ -79,6 +79,12 @@ the comments at the top of main.c for more information. */
 
 #endif
 
+/* Set configUSE_LOW_POWER_BENCHMARK to 1, with the low power demo selected, to
+run the tickless idle benchmark of Demo/Common/Minimal/LowPowerBenchmark.c in
+place of the tasks of the low power demo.  There is a single sleep depth. */
+#define configUSE_LOW_POWER_BENCHMARK	0
+#define lpbSLEEP_DEPTHS					( 1 )
+
 #define configUSE_PREEMPTION					1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION	0
 #define configUSE_QUEUE_SETS					1
@@ -31,6 +31,9 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+/* Demo includes. */
+#include "LowPowerBenchmark.h"
+
 /* Library includes. */
 #include "htimer.h"
 
@@ -221,9 +224,11 @@ TickType_t xModifiableIdleTime;
 		instructions. */
 		if( xModifiableIdleTime > 0 )
 		{
+			lpbSLEEP_ENTER( 0 );
 			__asm {	dsb
 					wfi
 					isb };
+			lpbSLEEP_EXIT();
 		}
 
 		/* Allow the application to define some post sleep processing. */
@@ -297,6 +302,10 @@ TickType_t xModifiableIdleTime;
 		value will get set to the value required to generate exactly one tick
 		period the next time the tick interrupt executes. */
 		lpHTIMER_PRELOAD_REGISTER = ( uint16_t ) ulReloadValue;
+
+		/* When the tick interrupt ended the sleep the pending tick was slept
+		through too. */
+		lpbTICKS_SLEPT( ( ulTickFlag != pdFALSE ) ? xExpectedIdleTime : ulCompleteTickPeriods );
 	}
 
 	/* Wind the tick forward by the number of tick periods that the CPU
@@ -34,6 +34,9 @@
 /* Library includes. */
 #include <asf.h>
 
+/* Demo includes. */
+#include "LowPowerBenchmark.h"
+
 
 /*
  * When configCREATE_LOW_POWER_DEMO is set to 1 then the tick interrupt
@@ -288,8 +291,11 @@ enum sleepmgr_mode xSleepMode;
 
 			if( xSleepMode != SLEEPMGR_ACTIVE )
 			{
-				/* Sleep until something happens. */
+				/* Sleep until something happens.  LowPowerBenchmark.c numbers
+				the sleep depths by the sleep manager mode. */
+				lpbSLEEP_ENTER( ( UBaseType_t ) xSleepMode );
 				bpm_sleep( BPM, xSleepMode );
+				lpbSLEEP_EXIT();
 			}
 		}
 
@@ -348,7 +354,9 @@ enum sleepmgr_mode xSleepMode;
 		prvEnableAST();
 
 		/* Wind the tick forward by the number of tick periods that the CPU
-		remained in a low power state. */
+		remained in a low power state.  When the tick interrupt ended the
+		sleep the pending tick was slept through too. */
+		lpbTICKS_SLEPT( ( ulTickFlag != pdFALSE ) ? xExpectedIdleTime : ulCompleteTickPeriods );
 		vTaskStepTick( ulCompleteTickPeriods );
 	}
 }
@@ -56,6 +56,14 @@ or 0 to run the more comprehensive test and demo application. */
 	#define configTICK_RATE_HZ					( ( TickType_t ) 1000 )
 #endif /* configCREATE_LOW_POWER_DEMO */
 
+/* Set configUSE_LOW_POWER_BENCHMARK to 1, with the low power demo selected, to
+run the tickless idle benchmark of Demo/Common/Minimal/LowPowerBenchmark.c in
+place of the tasks of the low power demo.  The sleep depths it reports are the
+sleep manager modes.  configCPU_CLOCK_HZ is the clock of the tick so the load
+work is sized from the real CPU clock. */
+#define configUSE_LOW_POWER_BENCHMARK			0
+#define lpbLOAD_EVENT_TIME						( sysclk_get_cpu_hz() / 1000UL )
+
 #define configUSE_PREEMPTION					1
 #define configUSE_IDLE_HOOK						0
 #define configUSE_TICK_HOOK						0
@@ -83,6 +83,7 @@
 
 /* Common demo includes. */
 #include "partest.h"
+#include "LowPowerBenchmark.h"
 
 /* Priorities at which the Rx and Tx tasks are created. */
 #define configQUEUE_RECEIVE_TASK_PRIORITY	( tskIDLE_PRIORITY + 1 )
@@ -127,13 +128,23 @@ static QueueHandle_t xQueue = NULL;
 
 void main_low_power( void )
 {
-	/* Create the queue. */
-	xQueue = xQueueCreate( mainQUEUE_LENGTH, sizeof( unsigned long ) );
-	configASSERT( xQueue );
+	#if configUSE_LOW_POWER_BENCHMARK == 1
+	{
+		/* The benchmark must be the only task, so that it causes every sleep.
+		Its results are viewed in the debugger. */
+		vStartLowPowerBenchmark( configQUEUE_RECEIVE_TASK_PRIORITY );
+	}
+	#else
+	{
+		/* Create the queue. */
+		xQueue = xQueueCreate( mainQUEUE_LENGTH, sizeof( unsigned long ) );
+		configASSERT( xQueue );
 
-	/* Start the two tasks as described at the top of this file. */
-	xTaskCreate( prvQueueReceiveTask, "Rx", configMINIMAL_STACK_SIZE, NULL, configQUEUE_RECEIVE_TASK_PRIORITY, NULL );
-	xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, NULL, configQUEUE_SEND_TASK_PRIORITY, NULL );
+		/* Start the two tasks as described at the top of this file. */
+		xTaskCreate( prvQueueReceiveTask, "Rx", configMINIMAL_STACK_SIZE, NULL, configQUEUE_RECEIVE_TASK_PRIORITY, NULL );
+		xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, NULL, configQUEUE_SEND_TASK_PRIORITY, NULL );
+	}
+	#endif /* configUSE_LOW_POWER_BENCHMARK */
 
 	/* Start the scheduler running running. */
 	vTaskStartScheduler();
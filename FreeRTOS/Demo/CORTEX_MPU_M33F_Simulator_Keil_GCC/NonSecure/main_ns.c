@@ -32,6 +32,26 @@
 #include "tz_demo.h"
 #include "mpu_demo.h"
 #include "reg_tests.h"
+#include "ctx_switch_bench.h"
+#include "nsc_bench.h"
+#include "mpu_bench.h"
+
+/* Set to 1 to also measure the context switch cost of non-secure, secure and
+ * FPU tasks, see ctx_switch_bench.c.  Read xCtxSwitchBenchResults in the
+ * debugger once xIsCtxSwitchBenchComplete() returns pdTRUE.  The simulator is
+ * not cycle accurate, so the figures only compare scenarios with each other. */
+#define mainCREATE_CTX_SWITCH_BENCH		0
+
+/* Set to 1 to also measure the cost of secure calls with and without
+ * batching, see nsc_bench.c.  Read xNSCBenchResults in the debugger once
+ * pxGetNSCBenchResults() no longer returns NULL. */
+#define mainCREATE_NSC_BENCH			0
+
+/* Set to 1 to also measure the cost of system calls and context switches of
+ * privileged tasks and of unprivileged tasks using few and many MPU regions,
+ * see mpu_bench.c.  Read xMPUBenchResults in the debugger once
+ * uxGetMPUBenchResults() no longer returns 0. */
+#define mainCREATE_MPU_BENCH			0
 
 /* Externs needed by the MPU setup code. These are defined in Scatter-Loading
  * description file (FreeRTOSDemo_ns.sct). */
@@ -125,6 +145,27 @@ static void prvCreateTasks( void )
 	/* Create tasks for reg tests. */
 	vStartRegTests();
 
+	#if( mainCREATE_CTX_SWITCH_BENCH == 1 )
+	{
+		/* Create the task for the context switch benchmark. */
+		vStartCtxSwitchBench();
+	}
+	#endif
+
+	#if( mainCREATE_NSC_BENCH == 1 )
+	{
+		/* Create the task for the secure call benchmark. */
+		vStartNSCBench();
+	}
+	#endif
+
+	#if( mainCREATE_MPU_BENCH == 1 )
+	{
+		/* Create the task for the MPU benchmark. */
+		vStartMPUBench();
+	}
+	#endif
+
 }
 /*-----------------------------------------------------------*/
 
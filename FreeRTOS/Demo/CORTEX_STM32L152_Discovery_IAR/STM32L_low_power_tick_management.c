@@ -34,6 +34,9 @@
 /* ST library functions. */
 #include "stm32l1xx.h"
 
+/* Demo includes. */
+#include "LowPowerBenchmark.h"
+
 /*
  * When configCREATE_LOW_POWER_DEMO is set to 1 then the tick interrupt
  * is generated by the TIM2 peripheral.  The TIM2 configuration and handling
@@ -219,7 +222,9 @@ const TickType_t xRegulatorOffIdleTime = 30;
 		STM32L discovery board.  If the application does require the tick time
 		to keep better track of the calender time then the RTC peripheral can be
 		used to make rough adjustments. */
+		lpbSLEEP_ENTER( 2 );
 		PWR_EnterSTOPMode( PWR_Regulator_LowPower, PWR_SLEEPEntry_WFI );
+		lpbSLEEP_EXIT();
 
 		/* A user definable macro that allows application code to be inserted
 		here.  Such application code can be used to reverse any actions taken
@@ -279,14 +284,21 @@ const TickType_t xRegulatorOffIdleTime = 30;
 			{
 				/* A slightly lower power sleep mode with a longer wake up
 				time. */
+				lpbSLEEP_ENTER( 1 );
 				PWR_EnterSleepMode( PWR_Regulator_LowPower, PWR_SLEEPEntry_WFI );
 			}
 			else
 			{
 				/* A slightly higher power sleep mode with a faster wake up
 				time. */
+				lpbSLEEP_ENTER( 0 );
 				PWR_EnterSleepMode( PWR_Regulator_ON, PWR_SLEEPEntry_WFI );
 			}
+
+			/* The sleep depths are recorded for LowPowerBenchmark.c, which
+			numbers them 0 for regulator on, 1 for low power sleep and 2 for
+			STOP mode. */
+			lpbSLEEP_EXIT();
 		}
 
 		/* Allow the application to define some post sleep processing.  This is
@@ -361,7 +373,9 @@ const TickType_t xRegulatorOffIdleTime = 30;
 		TIM_Cmd( TIM2, ENABLE );
 
 		/* Wind the tick forward by the number of tick periods that the CPU
-		remained in a low power state. */
+		remained in a low power state.  When the tick interrupt ended the
+		sleep the pending tick was slept through too. */
+		lpbTICKS_SLEPT( ( ulTickFlag != pdFALSE ) ? xExpectedIdleTime : ulCompleteTickPeriods );
 		vTaskStepTick( ulCompleteTickPeriods );
 	}
 }
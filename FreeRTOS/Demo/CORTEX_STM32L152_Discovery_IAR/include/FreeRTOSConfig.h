@@ -78,6 +78,16 @@ main_low_power.c and in STM32L_low_power_tick_management.c. */
 configCREATE_LOW_POWER_DEMO at the top of this file. */
 #define configUSE_TICKLESS_IDLE					configCREATE_LOW_POWER_DEMO
 
+/* Set configUSE_LOW_POWER_BENCHMARK to 1 to run the tickless idle benchmark
+of Demo/Common/Minimal/LowPowerBenchmark.c in place of the tasks of the low
+power demo.  The wake up delays reach both sleep modes, as the low power sleep
+mode is used when more than xRegulatorOffIdleTime (30) ticks are expected.
+There are no wake ups timed from STOP mode, which is only entered when no task
+has a timeout. */
+#define configUSE_LOW_POWER_BENCHMARK			0
+#define lpbSLEEP_DEPTHS							( 3 )
+#define lpbWAKE_DELAYS							{ 25, 100 }
+
 #define configCPU_CLOCK_HZ						SystemCoreClock
 #define configUSE_PREEMPTION					1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
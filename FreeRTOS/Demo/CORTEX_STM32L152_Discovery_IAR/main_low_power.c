@@ -119,6 +119,9 @@
 #include "discover_board.h"
 #include "stm32l_discovery_lcd.h"
 
+/* Demo includes. */
+#include "LowPowerBenchmark.h"
+
 /* Priorities at which the Rx and Tx tasks are created. */
 #define configQUEUE_RECEIVE_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
 #define configQUEUE_SEND_TASK_PRIORITY       ( tskIDLE_PRIORITY + 2 )
@@ -175,9 +178,19 @@ void main_low_power( void )
     xQueue = xQueueCreate( mainQUEUE_LENGTH, sizeof( unsigned long ) );
     configASSERT( xQueue );
 
-    /* Start the two tasks as described at the top of this file. */
-    xTaskCreate( prvQueueReceiveTask, "Rx", configMINIMAL_STACK_SIZE, NULL, configQUEUE_RECEIVE_TASK_PRIORITY, NULL );
-    xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, NULL, configQUEUE_SEND_TASK_PRIORITY, NULL );
+    #if ( configUSE_LOW_POWER_BENCHMARK == 1 )
+    {
+        /* The benchmark must be the only task, so that it causes every sleep.
+         * Its results are viewed in the debugger. */
+        vStartLowPowerBenchmark( configQUEUE_RECEIVE_TASK_PRIORITY );
+    }
+    #else
+    {
+        /* Start the two tasks as described at the top of this file. */
+        xTaskCreate( prvQueueReceiveTask, "Rx", configMINIMAL_STACK_SIZE, NULL, configQUEUE_RECEIVE_TASK_PRIORITY, NULL );
+        xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, NULL, configQUEUE_SEND_TASK_PRIORITY, NULL );
+    }
+    #endif /* configUSE_LOW_POWER_BENCHMARK */
 
     /* Start the scheduler running running. */
     vTaskStartScheduler();
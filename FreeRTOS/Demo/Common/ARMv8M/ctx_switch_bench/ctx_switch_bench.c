@@ -0,0 +1,470 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Measures what a context switch costs on an ARMv8-M port depending on the
+ * context the tasks carry, so the overhead of TrustZone and FPU contexts can
+ * be known before they are enabled.  The reg tests check that the same
+ * contexts are saved and restored correctly.
+ *
+ * For each scenario two privileged tasks of the same priority are created,
+ * above every other demo task, and yield to each other.  Just before calling
+ * taskYIELD() a task stores the cycle count, and as soon as it runs again the
+ * other task reads the cycle count and records the difference.  A sample is
+ * therefore one taskYIELD() through PendSV, the save of the outgoing context,
+ * the scheduler and the restore of the incoming context.  The first
+ * CTX_SWITCH_BENCH_WARMUP switches are not recorded so that both tasks have
+ * set up their contexts.  The tick interrupt may fall within a sample, which
+ * shows in the maximum; the minimum and the average are the figures to
+ * compare.
+ *
+ * Cycles are counted with DWT CYCCNT.  Where the core has no cycle counter,
+ * as on the Cortex-M23, or the counter is not accessible from the non-secure
+ * side, SysTick is used instead, which counts core clock cycles too when the
+ * port clocks it from the core clock.
+ *
+ * The results are read with uxGetCtxSwitchBenchResults(), or in the debugger
+ * from xCtxSwitchBenchResults.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Benchmark includes. */
+#include "ctx_switch_bench.h"
+
+/* The switches recorded per scenario. */
+#ifndef CTX_SWITCH_BENCH_SAMPLES
+    #define CTX_SWITCH_BENCH_SAMPLES    ( 1000UL )
+#endif
+
+/* The switches done per scenario before recording starts. */
+#ifndef CTX_SWITCH_BENCH_WARMUP
+    #define CTX_SWITCH_BENCH_WARMUP     ( 8UL )
+#endif
+
+/* The priority of the two tasks that switch, which must be above every task
+ * other than the check task. */
+#ifndef CTX_SWITCH_BENCH_PRIORITY
+    #define CTX_SWITCH_BENCH_PRIORITY   ( configMAX_PRIORITIES - 2 )
+#endif
+
+/* The priority of the task that runs the scenarios one after the other. */
+#define CTX_SWITCH_BENCH_CONTROL_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+
+#define CTX_SWITCH_BENCH_STACK_SIZE          ( configMINIMAL_STACK_SIZE )
+
+/* Debug and timer registers. */
+#define DEMCR_REG                 ( *( ( volatile uint32_t * ) 0xe000edfc ) )
+#define DEMCR_TRCENA_BIT          ( 1UL << 24UL )
+#define DWT_CTRL_REG              ( *( ( volatile uint32_t * ) 0xe0001000 ) )
+#define DWT_CTRL_CYCCNTENA_BIT    ( 1UL << 0UL )
+#define DWT_CTRL_NOCYCCNT_BIT     ( 1UL << 25UL )
+#define DWT_CYCCNT_REG            ( *( ( volatile uint32_t * ) 0xe0001004 ) )
+#define SYSTICK_LOAD_REG          ( *( ( volatile uint32_t * ) 0xe000e014 ) )
+#define SYSTICK_CURRENT_REG       ( *( ( volatile uint32_t * ) 0xe000e018 ) )
+#define FPCCR_REG                 ( *( ( volatile uint32_t * ) 0xe000ef34 ) )
+#define FPCCR_LSPEN_BIT           ( 1UL << 30UL )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The context the two switching tasks of a scenario carry.
+ */
+typedef struct CtxSwitchScenario
+{
+    const char * pcName;
+    BaseType_t xSecureContext; /* Both tasks allocate a secure context. */
+    BaseType_t xUseFPU;        /* Both tasks use the FPU between switches. */
+    BaseType_t xLazyStacking;  /* FPCCR.LSPEN while the scenario runs. */
+} CtxSwitchScenario_t;
+
+static const CtxSwitchScenario_t xScenarios[] =
+{
+    { "non-secure",                pdFALSE, pdFALSE, pdTRUE  },
+    #if ( configENABLE_TRUSTZONE == 1 )
+        { "secure context",        pdTRUE,  pdFALSE, pdTRUE  },
+    #endif
+    #if ( configENABLE_FPU == 1 )
+        { "FPU lazy stacking",     pdFALSE, pdTRUE,  pdTRUE  },
+        { "FPU active stacking",   pdFALSE, pdTRUE,  pdFALSE },
+    #endif
+    #if ( configENABLE_TRUSTZONE == 1 ) && ( configENABLE_FPU == 1 )
+        { "secure context + FPU",  pdTRUE,  pdTRUE,  pdTRUE  },
+    #endif
+};
+
+#define CTX_SWITCH_BENCH_SCENARIOS    ( sizeof( xScenarios ) / sizeof( xScenarios[ 0 ] ) )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The results, one per entry of xScenarios.
+ */
+CtxSwitchBenchResult_t xCtxSwitchBenchResults[ CTX_SWITCH_BENCH_SCENARIOS ];
+
+/**
+ * @brief pdTRUE once all the scenarios have been run.
+ */
+static volatile BaseType_t xBenchComplete = pdFALSE;
+
+/**
+ * @brief pdTRUE when the DWT cycle counter is used, pdFALSE for SysTick.
+ */
+static BaseType_t xUseCycleCounter = pdFALSE;
+
+/**
+ * @brief What reading the counter twice costs, taken off every sample.
+ */
+static uint32_t ulReadOverhead = 0;
+
+/**
+ * @brief State shared by the two switching tasks of the running scenario.
+ */
+static volatile uint32_t ulStamp;
+static volatile BaseType_t xStampValid;
+static volatile uint32_t ulSwitches;
+static volatile BaseType_t xScenarioDone;
+static volatile UBaseType_t uxTasksDone;
+static uint32_t ulMinCycles, ulMaxCycles;
+static uint64_t ullTotalCycles;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Starts the DWT cycle counter, or selects SysTick when there is none.
+ */
+static void prvSetupCounter( void );
+
+/**
+ * @brief Reads the counter selected by prvSetupCounter().
+ */
+static uint32_t prvReadCounter( void );
+
+/**
+ * @brief Returns the cycles between two counter readings.
+ */
+static uint32_t prvElapsed( uint32_t ulStart,
+                            uint32_t ulEnd );
+
+/**
+ * @brief Records one switch of the running scenario.
+ */
+static void prvRecordSample( uint32_t ulCycles );
+
+/**
+ * @brief Implements the two tasks that yield to each other.
+ *
+ * @param pvParameters[in] The CtxSwitchScenario_t to run.
+ */
+static void prvSwitchTask( void * pvParameters );
+
+/**
+ * @brief Implements the task that runs the scenarios one after the other.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+static void prvControlTask( void * pvParameters );
+/*-----------------------------------------------------------*/
+
+void vStartCtxSwitchBench( void )
+{
+    static StackType_t xControlTaskStack[ CTX_SWITCH_BENCH_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+    static StaticTask_t xControlTaskTCB;
+
+    /* The task must be privileged to access the debug and timer registers. */
+    xTaskCreateStatic( prvControlTask,
+                       "CtxBench",
+                       CTX_SWITCH_BENCH_STACK_SIZE,
+                       NULL,
+                       CTX_SWITCH_BENCH_CONTROL_PRIORITY | portPRIVILEGE_BIT,
+                       xControlTaskStack,
+                       &( xControlTaskTCB ) );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsCtxSwitchBenchComplete( void )
+{
+    return xBenchComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetCtxSwitchBenchResults( const CtxSwitchBenchResult_t ** ppxResults )
+{
+    *ppxResults = xCtxSwitchBenchResults;
+
+    return ( UBaseType_t ) CTX_SWITCH_BENCH_SCENARIOS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupCounter( void )
+{
+    uint32_t ulFirst;
+
+    DEMCR_REG |= DEMCR_TRCENA_BIT;
+
+    if( ( DWT_CTRL_REG & DWT_CTRL_NOCYCCNT_BIT ) == 0 )
+    {
+        DWT_CTRL_REG |= DWT_CTRL_CYCCNTENA_BIT;
+
+        /* The counter does not move if debug is not allowed on this side. */
+        ulFirst = DWT_CYCCNT_REG;
+        __asm volatile ( "nop" );
+        __asm volatile ( "nop" );
+
+        if( DWT_CYCCNT_REG != ulFirst )
+        {
+            xUseCycleCounter = pdTRUE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReadCounter( void )
+{
+    uint32_t ulCount;
+
+    if( xUseCycleCounter != pdFALSE )
+    {
+        ulCount = DWT_CYCCNT_REG;
+    }
+    else
+    {
+        ulCount = SYSTICK_CURRENT_REG;
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvElapsed( uint32_t ulStart,
+                            uint32_t ulEnd )
+{
+    uint32_t ulCycles;
+
+    if( xUseCycleCounter != pdFALSE )
+    {
+        ulCycles = ulEnd - ulStart;
+    }
+    else if( ulStart >= ulEnd )
+    {
+        /* SysTick counts down. */
+        ulCycles = ulStart - ulEnd;
+    }
+    else
+    {
+        /* SysTick reloaded in between. */
+        ulCycles = ulStart + ( SYSTICK_LOAD_REG + 1UL ) - ulEnd;
+    }
+
+    return ulCycles;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordSample( uint32_t ulCycles )
+{
+    ulSwitches++;
+
+    if( ulSwitches > CTX_SWITCH_BENCH_WARMUP )
+    {
+        ulCycles = ( ulCycles > ulReadOverhead ) ? ( ulCycles - ulReadOverhead ) : 0UL;
+
+        if( ulCycles < ulMinCycles )
+        {
+            ulMinCycles = ulCycles;
+        }
+
+        if( ulCycles > ulMaxCycles )
+        {
+            ulMaxCycles = ulCycles;
+        }
+
+        ullTotalCycles += ulCycles;
+
+        if( ulSwitches == ( CTX_SWITCH_BENCH_WARMUP + CTX_SWITCH_BENCH_SAMPLES ) )
+        {
+            xScenarioDone = pdTRUE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchTask( void * pvParameters )
+{
+    const CtxSwitchScenario_t * pxScenario = ( const CtxSwitchScenario_t * ) pvParameters;
+    volatile float fValue;
+    uint32_t ulNow;
+
+    #if ( configENABLE_TRUSTZONE == 1 )
+    {
+        if( pxScenario->xSecureContext != pdFALSE )
+        {
+            portALLOCATE_SECURE_CONTEXT( configMINIMAL_SECURE_STACK_SIZE );
+        }
+    }
+    #endif /* configENABLE_TRUSTZONE */
+
+    if( pxScenario->xUseFPU != pdFALSE )
+    {
+        fValue = 1.0f;
+    }
+
+    while( xScenarioDone == pdFALSE )
+    {
+        ulNow = prvReadCounter();
+
+        if( xStampValid != pdFALSE )
+        {
+            prvRecordSample( prvElapsed( ulStamp, ulNow ) );
+        }
+
+        /* Use the FPU outside the measured time, so the task has an active
+         * FPU context at every switch. */
+        if( pxScenario->xUseFPU != pdFALSE )
+        {
+            fValue = fValue * 1.0f;
+        }
+
+        xStampValid = pdTRUE;
+        ulStamp = prvReadCounter();
+        taskYIELD();
+    }
+
+    /* The control task has a lower priority, so it only runs once both
+     * tasks got here. */
+    uxTasksDone++;
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    static StackType_t xSwitchTaskStacks[ 2 ][ CTX_SWITCH_BENCH_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+    static StaticTask_t xSwitchTaskTCBs[ 2 ];
+    TaskHandle_t xSwitchTasks[ 2 ];
+    UBaseType_t uxScenario;
+    uint32_t ulStart, ulEnd, ulCycles, i;
+
+    #if ( configENABLE_FPU == 1 )
+        uint32_t ulFPCCR = FPCCR_REG;
+    #endif
+
+    /* Just to stop compiler warnings. */
+    ( void ) pvParameters;
+
+    prvSetupCounter();
+
+    /* The counter read overhead is the smallest difference between two
+     * readings. */
+    ulReadOverhead = UINT32_MAX;
+
+    for( i = 0; i < 16UL; i++ )
+    {
+        ulStart = prvReadCounter();
+        ulEnd = prvReadCounter();
+        ulCycles = prvElapsed( ulStart, ulEnd );
+
+        if( ulCycles < ulReadOverhead )
+        {
+            ulReadOverhead = ulCycles;
+        }
+    }
+
+    for( uxScenario = 0; uxScenario < CTX_SWITCH_BENCH_SCENARIOS; uxScenario++ )
+    {
+        xCtxSwitchBenchResults[ uxScenario ].pcScenario = xScenarios[ uxScenario ].pcName;
+        xCtxSwitchBenchResults[ uxScenario ].ulSamples = 0;
+
+        #if ( configENABLE_FPU == 1 )
+        {
+            if( xScenarios[ uxScenario ].xLazyStacking != pdFALSE )
+            {
+                FPCCR_REG |= FPCCR_LSPEN_BIT;
+            }
+            else
+            {
+                FPCCR_REG &= ~FPCCR_LSPEN_BIT;
+            }
+
+            /* The secure side can stop the non-secure side from changing
+             * LSPEN. */
+            if( ( ( FPCCR_REG & FPCCR_LSPEN_BIT ) != 0 ) != ( xScenarios[ uxScenario ].xLazyStacking != pdFALSE ) )
+            {
+                continue;
+            }
+        }
+        #endif /* configENABLE_FPU */
+
+        xStampValid = pdFALSE;
+        ulSwitches = 0;
+        xScenarioDone = pdFALSE;
+        uxTasksDone = 0;
+        ulMinCycles = UINT32_MAX;
+        ulMaxCycles = 0;
+        ullTotalCycles = 0;
+
+        /* Create both tasks before either runs. */
+        vTaskSuspendAll();
+        {
+            for( i = 0; i < 2UL; i++ )
+            {
+                xSwitchTasks[ i ] = xTaskCreateStatic( prvSwitchTask,
+                                                       "CtxSwitch",
+                                                       CTX_SWITCH_BENCH_STACK_SIZE,
+                                                       ( void * ) &( xScenarios[ uxScenario ] ),
+                                                       CTX_SWITCH_BENCH_PRIORITY | portPRIVILEGE_BIT,
+                                                       xSwitchTaskStacks[ i ],
+                                                       &( xSwitchTaskTCBs[ i ] ) );
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        while( uxTasksDone < 2 )
+        {
+            vTaskDelay( 1 );
+        }
+
+        /* Deleting the tasks from here frees their secure contexts and
+         * their TCBs straight away, so the buffers can be used again. */
+        vTaskDelete( xSwitchTasks[ 0 ] );
+        vTaskDelete( xSwitchTasks[ 1 ] );
+
+        xCtxSwitchBenchResults[ uxScenario ].ulSamples = CTX_SWITCH_BENCH_SAMPLES;
+        xCtxSwitchBenchResults[ uxScenario ].ulMinCycles = ulMinCycles;
+        xCtxSwitchBenchResults[ uxScenario ].ulAverageCycles = ( uint32_t ) ( ullTotalCycles / CTX_SWITCH_BENCH_SAMPLES );
+        xCtxSwitchBenchResults[ uxScenario ].ulMaxCycles = ulMaxCycles;
+    }
+
+    #if ( configENABLE_FPU == 1 )
+    {
+        FPCCR_REG = ulFPCCR;
+    }
+    #endif
+
+    xBenchComplete = pdTRUE;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
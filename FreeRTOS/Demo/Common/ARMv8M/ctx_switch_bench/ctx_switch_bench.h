@@ -0,0 +1,70 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+#ifndef __CTX_SWITCH_BENCH_H__
+#define __CTX_SWITCH_BENCH_H__
+
+/**
+ * @brief The context switch cost of one kind of task.
+ *
+ * Times are in core clock cycles from the moment a task calls taskYIELD() to
+ * the moment the next task of the same priority runs, with the cost of
+ * reading the cycle counter taken off.
+ */
+typedef struct CtxSwitchBenchResult
+{
+    const char * pcScenario;
+    uint32_t ulSamples; /* 0 when the scenario could not be run. */
+    uint32_t ulMinCycles;
+    uint32_t ulAverageCycles;
+    uint32_t ulMaxCycles;
+} CtxSwitchBenchResult_t;
+
+/**
+ * @brief Creates the task that runs the context switch benchmark.
+ *
+ * The benchmark measures the cost of a context switch between two tasks
+ * which have no secure context and no FPU context, which both have a secure
+ * context, which both use the FPU with lazy stacking, which both use the FPU
+ * with lazy stacking turned off, and which both have a secure context and
+ * use the FPU.  Scenarios that the build does not support (TrustZone or the
+ * FPU not enabled) are left out.  Comparing a result with the first one
+ * gives the overhead of the secure or FPU context.
+ */
+void vStartCtxSwitchBench( void );
+
+/**
+ * @brief Returns pdTRUE once every scenario has been measured.
+ */
+BaseType_t xIsCtxSwitchBenchComplete( void );
+
+/**
+ * @brief Points *ppxResults at the results and returns their number.
+ */
+UBaseType_t uxGetCtxSwitchBenchResults( const CtxSwitchBenchResult_t ** ppxResults );
+
+#endif /* __CTX_SWITCH_BENCH_H__ */
@@ -0,0 +1,431 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Shows what isolating tasks with the MPU costs.  For each scenario two tasks
+ * are created, an initiator and a responder of higher priority, both above
+ * the other demo tasks.  The initiator first does mpubenchITERATIONS pairs of
+ * xQueueSend() and xQueueReceive() on a queue of its own, none of which
+ * block.  It then does mpubenchITERATIONS round trips with the responder: it
+ * sends an item to the responder, which preempts it, sends the item back and
+ * blocks, and the initiator receives the item.  A round trip is therefore two
+ * of those pairs of system calls and two context switches, and the switch
+ * cost is half of what the round trip costs beyond the system calls.
+ *
+ * Unprivileged tasks cannot read the cycle counter, so a privileged control
+ * task of lower priority times each phase as a whole: it notifies the
+ * initiator to start the phase and reads the counter again once both tasks
+ * are blocked.
+ *
+ * The ARMv8-M ports program every configurable region on every switch,
+ * whatever regions the tasks use.  Skipping that for tasks with identical
+ * region sets needs a change in the port's PendSV handler.  The last
+ * scenario measures that case, so it gives the baseline such a change has to
+ * improve on.
+ *
+ * Cycles are counted with DWT CYCCNT.  Where the core has no cycle counter,
+ * as on the Cortex-M23, or the counter does not run on the non-secure side,
+ * they are counted from the tick count and SysTick.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Benchmark includes. */
+#include "mpu_bench.h"
+
+/* The system call pairs, and the round trips, per scenario. */
+#ifndef mpubenchITERATIONS
+    #define mpubenchITERATIONS    ( 1000UL )
+#endif
+
+/* The priority of the responder task, the initiator task is one below. Both
+ * must be above every task other than the check task. */
+#ifndef mpubenchPRIORITY
+    #define mpubenchPRIORITY      ( configMAX_PRIORITIES - 2 )
+#endif
+
+#define mpubenchCONTROL_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+
+#define mpubenchREGION_SIZE         ( 32 )
+
+/* Debug and timer registers. */
+#define DEMCR_REG                 ( *( ( volatile uint32_t * ) 0xe000edfc ) )
+#define DEMCR_TRCENA_BIT          ( 1UL << 24UL )
+#define DWT_CTRL_REG              ( *( ( volatile uint32_t * ) 0xe0001000 ) )
+#define DWT_CTRL_CYCCNTENA_BIT    ( 1UL << 0UL )
+#define DWT_CTRL_NOCYCCNT_BIT     ( 1UL << 25UL )
+#define DWT_CYCCNT_REG            ( *( ( volatile uint32_t * ) 0xe0001004 ) )
+#define SYSTICK_LOAD_REG          ( *( ( volatile uint32_t * ) 0xe000e014 ) )
+#define SYSTICK_CURRENT_REG       ( *( ( volatile uint32_t * ) 0xe000e018 ) )
+#define ICSR_REG                  ( *( ( volatile uint32_t * ) 0xe000ed04 ) )
+#define ICSR_PENDSTSET_BIT        ( 1UL << 26UL )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The kind of tasks of a scenario.
+ */
+typedef struct MPUBenchScenario
+{
+    const char * pcName;
+    BaseType_t xPrivileged;
+    UBaseType_t uxRegions;    /* Regions configured per task, 0 for privileged tasks. */
+    BaseType_t xSameRegions;  /* Both tasks get the same set of regions. */
+} MPUBenchScenario_t;
+
+static const MPUBenchScenario_t xScenarios[] =
+{
+    { "privileged",                       pdTRUE,  0,                            pdFALSE },
+    { "unprivileged, 1 region",           pdFALSE, 1,                            pdFALSE },
+    { "unprivileged, all regions",        pdFALSE, portNUM_CONFIGURABLE_REGIONS, pdFALSE },
+    { "unprivileged, same region set",    pdFALSE, portNUM_CONFIGURABLE_REGIONS, pdTRUE  },
+};
+
+#define mpubenchSCENARIOS    ( sizeof( xScenarios ) / sizeof( xScenarios[ 0 ] ) )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The queues used by the two tasks, in the first region of each task
+ * so that unprivileged tasks can read the handles.  Index 0 is the queue to
+ * the initiator, index 1 the queue to the responder.
+ */
+static QueueHandle_t xBenchQueues[ mpubenchREGION_SIZE / sizeof( QueueHandle_t ) ] __attribute__( ( aligned( 32 ) ) );
+
+/**
+ * @brief Memory for the other regions, a set for each task.
+ */
+static uint8_t ucRegionMemory[ 2 ][ portNUM_CONFIGURABLE_REGIONS ][ mpubenchREGION_SIZE ] __attribute__( ( aligned( 32 ) ) );
+
+/**
+ * @brief The results, one per entry of xScenarios.
+ */
+static MPUBenchResult_t xMPUBenchResults[ mpubenchSCENARIOS ];
+
+/**
+ * @brief pdTRUE once all the scenarios have been run.
+ */
+static volatile BaseType_t xBenchComplete = pdFALSE;
+
+/**
+ * @brief pdTRUE when the DWT cycle counter is used.
+ */
+static BaseType_t xUseCycleCounter = pdFALSE;
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Starts the DWT cycle counter, or selects SysTick when there is none.
+ */
+static void prvSetupCounter( void );
+
+/**
+ * @brief Reads the counter selected by prvSetupCounter().
+ */
+static uint32_t prvReadCounter( void );
+
+/**
+ * @brief Implements the initiator task.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+static void prvInitiatorTask( void * pvParameters );
+
+/**
+ * @brief Implements the responder task.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+static void prvResponderTask( void * pvParameters );
+
+/**
+ * @brief Implements the task which runs the scenarios one after the other.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+static void prvControlTask( void * pvParameters );
+
+/**
+ * @brief Creates the initiator or the responder task of a scenario.
+ */
+static TaskHandle_t prvCreateBenchTask( const MPUBenchScenario_t * pxScenario,
+                                        BaseType_t xResponder );
+/*-----------------------------------------------------------*/
+
+void vStartMPUBench( void )
+{
+    static StackType_t xControlTaskStack[ configMINIMAL_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+    TaskParameters_t xControlTaskParameters =
+    {
+        .pvTaskCode     = prvControlTask,
+        .pcName         = "MPUBench",
+        .usStackDepth   = configMINIMAL_STACK_SIZE,
+        .pvParameters   = NULL,
+        .uxPriority     = mpubenchCONTROL_PRIORITY | portPRIVILEGE_BIT,
+        .puxStackBuffer = xControlTaskStack,
+    };
+
+    /* The task must be privileged to access the debug and timer registers. */
+    xTaskCreateRestricted( &( xControlTaskParameters ), NULL );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetMPUBenchResults( const MPUBenchResult_t ** ppxResults )
+{
+    UBaseType_t uxResults = 0;
+
+    if( xBenchComplete != pdFALSE )
+    {
+        *ppxResults = xMPUBenchResults;
+        uxResults = ( UBaseType_t ) mpubenchSCENARIOS;
+    }
+
+    return uxResults;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupCounter( void )
+{
+    uint32_t ulFirst;
+
+    DEMCR_REG |= DEMCR_TRCENA_BIT;
+
+    if( ( DWT_CTRL_REG & DWT_CTRL_NOCYCCNT_BIT ) == 0 )
+    {
+        DWT_CTRL_REG |= DWT_CTRL_CYCCNTENA_BIT;
+
+        /* The counter does not move if debug is not allowed on this side. */
+        ulFirst = DWT_CYCCNT_REG;
+        __asm volatile ( "nop" );
+        __asm volatile ( "nop" );
+
+        if( DWT_CYCCNT_REG != ulFirst )
+        {
+            xUseCycleCounter = pdTRUE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReadCounter( void )
+{
+    uint32_t ulCount, ulTicks, ulCurrent;
+
+    if( xUseCycleCounter != pdFALSE )
+    {
+        ulCount = DWT_CYCCNT_REG;
+    }
+    else
+    {
+        /* Whole tick periods plus the SysTick cycles into the current one.
+         * A tick that is pending has not been counted yet. */
+        taskENTER_CRITICAL();
+        {
+            ulTicks = ( uint32_t ) xTaskGetTickCount();
+            ulCurrent = SYSTICK_CURRENT_REG;
+
+            if( ( ICSR_REG & ICSR_PENDSTSET_BIT ) != 0 )
+            {
+                ulCurrent = SYSTICK_CURRENT_REG;
+                ulTicks++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        ulCount = ( ulTicks * ( SYSTICK_LOAD_REG + 1UL ) ) + ( SYSTICK_LOAD_REG - ulCurrent );
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitiatorTask( void * pvParameters )
+{
+    uint32_t i, ulItem = 0;
+
+    /* Unused parameters. */
+    ( void ) pvParameters;
+
+    /* System calls without context switches. */
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    for( i = 0; i < mpubenchITERATIONS; i++ )
+    {
+        ( void ) xQueueSend( xBenchQueues[ 0 ], &( ulItem ), 0 );
+        ( void ) xQueueReceive( xBenchQueues[ 0 ], &( ulItem ), 0 );
+    }
+
+    /* Round trips with the responder. */
+    ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+    for( i = 0; i < mpubenchITERATIONS; i++ )
+    {
+        ( void ) xQueueSend( xBenchQueues[ 1 ], &( i ), 0 );
+        ( void ) xQueueReceive( xBenchQueues[ 0 ], &( ulItem ), portMAX_DELAY );
+        configASSERT( ulItem == i );
+    }
+
+    /* Wait to be deleted by the control task. */
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvResponderTask( void * pvParameters )
+{
+    uint32_t ulItem;
+
+    /* Unused parameters. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        if( xQueueReceive( xBenchQueues[ 1 ], &( ulItem ), portMAX_DELAY ) == pdPASS )
+        {
+            ( void ) xQueueSend( xBenchQueues[ 0 ], &( ulItem ), 0 );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t prvCreateBenchTask( const MPUBenchScenario_t * pxScenario,
+                                        BaseType_t xResponder )
+{
+    static StackType_t xTaskStacks[ 2 ][ configMINIMAL_STACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+    TaskParameters_t xTaskParameters = { 0 };
+    TaskHandle_t xTask = NULL;
+    UBaseType_t uxRegion, uxSet;
+
+    /* Both tasks use the first set of region memory when the sets are the
+     * same. */
+    uxSet = ( ( xResponder != pdFALSE ) && ( pxScenario->xSameRegions == pdFALSE ) ) ? 1 : 0;
+
+    xTaskParameters.pvTaskCode = ( xResponder != pdFALSE ) ? prvResponderTask : prvInitiatorTask;
+    xTaskParameters.pcName = ( xResponder != pdFALSE ) ? "MPUResp" : "MPUInit";
+    xTaskParameters.usStackDepth = configMINIMAL_STACK_SIZE;
+    xTaskParameters.pvParameters = NULL;
+    xTaskParameters.uxPriority = ( xResponder != pdFALSE ) ? mpubenchPRIORITY : ( mpubenchPRIORITY - 1 );
+    xTaskParameters.puxStackBuffer = xTaskStacks[ ( xResponder != pdFALSE ) ? 1 : 0 ];
+
+    if( pxScenario->xPrivileged != pdFALSE )
+    {
+        xTaskParameters.uxPriority |= portPRIVILEGE_BIT;
+    }
+
+    for( uxRegion = 0; uxRegion < pxScenario->uxRegions; uxRegion++ )
+    {
+        if( uxRegion == 0 )
+        {
+            xTaskParameters.xRegions[ uxRegion ].pvBaseAddress = ( void * ) xBenchQueues;
+            xTaskParameters.xRegions[ uxRegion ].ulParameters = tskMPU_REGION_READ_ONLY | tskMPU_REGION_EXECUTE_NEVER;
+        }
+        else
+        {
+            xTaskParameters.xRegions[ uxRegion ].pvBaseAddress = ( void * ) ucRegionMemory[ uxSet ][ uxRegion ];
+            xTaskParameters.xRegions[ uxRegion ].ulParameters = tskMPU_REGION_READ_WRITE | tskMPU_REGION_EXECUTE_NEVER;
+        }
+
+        xTaskParameters.xRegions[ uxRegion ].ulLengthInBytes = mpubenchREGION_SIZE;
+    }
+
+    xTaskCreateRestricted( &( xTaskParameters ), &( xTask ) );
+    configASSERT( xTask != NULL );
+
+    #if ( configUSE_MPU_WRAPPERS_V1 == 0 ) && ( configENABLE_ACCESS_CONTROL_LIST == 1 )
+    {
+        /* Unprivileged tasks may only use kernel objects they are granted. */
+        vGrantAccessToQueue( xTask, xBenchQueues[ 0 ] );
+        vGrantAccessToQueue( xTask, xBenchQueues[ 1 ] );
+    }
+    #endif
+
+    return xTask;
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    MPUBenchResult_t * pxResult;
+    TaskHandle_t xInitiator, xResponder;
+    UBaseType_t uxScenario;
+    uint32_t ulStart, ulEnd;
+
+    /* Unused parameters. */
+    ( void ) pvParameters;
+
+    prvSetupCounter();
+
+    xBenchQueues[ 0 ] = xQueueCreate( 1, sizeof( uint32_t ) );
+    xBenchQueues[ 1 ] = xQueueCreate( 1, sizeof( uint32_t ) );
+    configASSERT( ( xBenchQueues[ 0 ] != NULL ) && ( xBenchQueues[ 1 ] != NULL ) );
+
+    for( uxScenario = 0; uxScenario < mpubenchSCENARIOS; uxScenario++ )
+    {
+        ( void ) xQueueReset( xBenchQueues[ 0 ] );
+        ( void ) xQueueReset( xBenchQueues[ 1 ] );
+
+        /* Both tasks have a higher priority, so each runs until it blocks
+         * as soon as it is created. */
+        xResponder = prvCreateBenchTask( &( xScenarios[ uxScenario ] ), pdTRUE );
+        xInitiator = prvCreateBenchTask( &( xScenarios[ uxScenario ] ), pdFALSE );
+
+        pxResult = &( xMPUBenchResults[ uxScenario ] );
+        pxResult->pcScenario = xScenarios[ uxScenario ].pcName;
+        pxResult->ulRegions = ( uint32_t ) xScenarios[ uxScenario ].uxRegions;
+
+        /* This task only runs again once the initiator blocks at the end of
+         * the phase. */
+        ulStart = prvReadCounter();
+        ( void ) xTaskNotifyGive( xInitiator );
+        ulEnd = prvReadCounter();
+        pxResult->ulSystemCallCycles = ( ulEnd - ulStart ) / mpubenchITERATIONS;
+
+        ulStart = prvReadCounter();
+        ( void ) xTaskNotifyGive( xInitiator );
+        ulEnd = prvReadCounter();
+        pxResult->ulRoundTripCycles = ( ulEnd - ulStart ) / mpubenchITERATIONS;
+
+        if( pxResult->ulRoundTripCycles > ( 2UL * pxResult->ulSystemCallCycles ) )
+        {
+            pxResult->ulSwitchCycles = ( pxResult->ulRoundTripCycles - ( 2UL * pxResult->ulSystemCallCycles ) ) / 2UL;
+        }
+        else
+        {
+            pxResult->ulSwitchCycles = 0;
+        }
+
+        vTaskDelete( xInitiator );
+        vTaskDelete( xResponder );
+    }
+
+    xBenchComplete = pdTRUE;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
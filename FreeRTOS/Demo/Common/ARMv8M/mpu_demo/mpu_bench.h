@@ -0,0 +1,61 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+#ifndef __MPU_BENCH_H__
+#define __MPU_BENCH_H__
+
+/**
+ * @brief What system calls and context switches cost for one kind of task.
+ *
+ * Times are in core clock cycles per iteration.  The switch cost is derived
+ * from the other two figures, see mpu_bench.c.
+ */
+typedef struct MPUBenchResult
+{
+    const char * pcScenario;
+    uint32_t ulRegions;          /* MPU regions configured per task, besides its stack. */
+    uint32_t ulSystemCallCycles; /* An xQueueSend() and an xQueueReceive() that do not block. */
+    uint32_t ulRoundTripCycles;  /* Two tasks pass an item to each other and back. */
+    uint32_t ulSwitchCycles;     /* One context switch. */
+} MPUBenchResult_t;
+
+/**
+ * @brief Creates the task that runs the MPU benchmark.
+ *
+ * The benchmark compares privileged tasks, unprivileged tasks with one MPU
+ * region, unprivileged tasks using all the configurable regions, and
+ * unprivileged tasks that use all the regions with identical region sets.
+ */
+void vStartMPUBench( void );
+
+/**
+ * @brief Points *ppxResults at the results and returns their number, or
+ * returns 0 until the benchmark is complete.
+ */
+UBaseType_t uxGetMPUBenchResults( const MPUBenchResult_t ** ppxResults );
+
+#endif /* __MPU_BENCH_H__ */
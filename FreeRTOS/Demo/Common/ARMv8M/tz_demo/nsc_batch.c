@@ -0,0 +1,79 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* Non-Secure callable functions. */
+#include "nsc_batch.h"
+/*-----------------------------------------------------------*/
+
+void vNSCBatchInit( NSCBatch_t * pxBatch )
+{
+    pxBatch->ulCount = 0;
+    pxBatch->xFlushed = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNSCBatchAdd( NSCBatch_t * pxBatch,
+                         uint8_t * pucData,
+                         uint32_t ulLength )
+{
+    BaseType_t xIndex = -1;
+
+    if( pxBatch->xFlushed != pdFALSE )
+    {
+        vNSCBatchInit( pxBatch );
+    }
+
+    if( pxBatch->ulCount < nscMAX_BATCH_OPERATIONS )
+    {
+        xIndex = ( BaseType_t ) pxBatch->ulCount;
+        pxBatch->xOperations[ xIndex ].pucData = pucData;
+        pxBatch->xOperations[ xIndex ].ulLength = ulLength;
+        pxBatch->xOperations[ xIndex ].ulResult = nscTRANSFORM_INVALID;
+        pxBatch->ulCount++;
+    }
+
+    return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulNSCBatchFlush( NSCBatch_t * pxBatch )
+{
+    uint32_t ulDone = 0;
+
+    if( pxBatch->ulCount > 0 )
+    {
+        ulDone = NSCTransformBatchFunction( pxBatch->xOperations, pxBatch->ulCount );
+    }
+
+    pxBatch->xFlushed = pdTRUE;
+
+    return ulDone;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,81 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+#ifndef __NSC_BATCH_H__
+#define __NSC_BATCH_H__
+
+#include "nsc_functions.h"
+
+/**
+ * @brief Operations collected on the non-secure side to be done by the
+ * secure side with a single transition.
+ *
+ * Many small secure calls cost more in transitions than in work, see
+ * nsc_bench.c.  Add the operations with xNSCBatchAdd() and do them all with
+ * ulNSCBatchFlush().  After the flush xOperations[ i ].ulResult holds the
+ * result of the i-th operation added, until the next xNSCBatchAdd().
+ */
+typedef struct NSCBatch
+{
+    SecureOperation_t xOperations[ nscMAX_BATCH_OPERATIONS ];
+    uint32_t ulCount;    /* Operations added. */
+    BaseType_t xFlushed; /* The next xNSCBatchAdd() starts a new batch. */
+} NSCBatch_t;
+
+/**
+ * @brief Empties a batch.
+ *
+ * @param pxBatch[out] The batch.
+ */
+void vNSCBatchInit( NSCBatch_t * pxBatch );
+
+/**
+ * @brief Adds an NSCTransformFunction() operation to a batch.
+ *
+ * @param pxBatch[in, out] The batch.
+ * @param pucData[in, out] The buffer to transform, which must stay valid
+ * until the batch is flushed.
+ * @param ulLength[in] The number of bytes in pucData.
+ *
+ * @return The index of the operation in xOperations, or -1 if the batch is
+ * full, in which case it has to be flushed first.
+ */
+BaseType_t xNSCBatchAdd( NSCBatch_t * pxBatch,
+                         uint8_t * pucData,
+                         uint32_t ulLength );
+
+/**
+ * @brief Does all the operations of a batch with one secure call.
+ *
+ * @param pxBatch[in, out] The batch.
+ *
+ * @return The number of operations done, which is less than the number
+ * added if a buffer could not be accessed.
+ */
+uint32_t ulNSCBatchFlush( NSCBatch_t * pxBatch );
+
+#endif /* __NSC_BATCH_H__ */
@@ -0,0 +1,342 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Measures what a call from the non-secure side into the secure side costs
+ * and how much of it batching saves.  The bare round trip is a call to
+ * NSCEchoFunction().  Then for each size in ulOperationSizes[] the task
+ * transforms nscbenchBATCH_SIZE buffers nscbenchITERATIONS times, once with a
+ * call to NSCTransformFunction() per buffer and once with one
+ * ulNSCBatchFlush() per nscbenchBATCH_SIZE buffers, and checks that both
+ * give the same buffers and results.
+ *
+ * Cycles are counted with DWT CYCCNT, or with SysTick where the core has no
+ * cycle counter or it does not run on the non-secure side.  The cost of
+ * reading the counter is taken off.  Read xNSCBenchResults in the debugger
+ * or call pxGetNSCBenchResults().
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Non-Secure callable functions. */
+#include "nsc_functions.h"
+#include "nsc_batch.h"
+#include "nsc_bench.h"
+
+/* The operations per batch, at most nscMAX_BATCH_OPERATIONS. */
+#ifndef nscbenchBATCH_SIZE
+    #define nscbenchBATCH_SIZE    ( 8UL )
+#endif
+
+/* The times each measurement is repeated. */
+#ifndef nscbenchITERATIONS
+    #define nscbenchITERATIONS    ( 100UL )
+#endif
+
+#ifndef nscbenchPRIORITY
+    #define nscbenchPRIORITY      ( tskIDLE_PRIORITY + 1 )
+#endif
+
+#define nscbenchMAX_SIZE          ( 256UL )
+#define nscbenchSTACK_SIZE        ( configMINIMAL_STACK_SIZE )
+
+/* Debug and timer registers. */
+#define DEMCR_REG                 ( *( ( volatile uint32_t * ) 0xe000edfc ) )
+#define DEMCR_TRCENA_BIT          ( 1UL << 24UL )
+#define DWT_CTRL_REG              ( *( ( volatile uint32_t * ) 0xe0001000 ) )
+#define DWT_CTRL_CYCCNTENA_BIT    ( 1UL << 0UL )
+#define DWT_CTRL_NOCYCCNT_BIT     ( 1UL << 25UL )
+#define DWT_CYCCNT_REG            ( *( ( volatile uint32_t * ) 0xe0001004 ) )
+#define SYSTICK_LOAD_REG          ( *( ( volatile uint32_t * ) 0xe000e014 ) )
+#define SYSTICK_CURRENT_REG       ( *( ( volatile uint32_t * ) 0xe000e018 ) )
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The operation sizes timed, typical of hashing a word up to a block
+ * of data.
+ */
+static const uint32_t ulOperationSizes[ nscbenchSIZES ] = { 4UL, 16UL, 64UL, nscbenchMAX_SIZE };
+
+/**
+ * @brief The results, see pxGetNSCBenchResults().
+ */
+NSCBenchResults_t xNSCBenchResults;
+
+/**
+ * @brief pdTRUE once xNSCBenchResults is filled in.
+ */
+static volatile BaseType_t xBenchComplete = pdFALSE;
+
+/**
+ * @brief pdTRUE when the DWT cycle counter is used, pdFALSE for SysTick.
+ */
+static BaseType_t xUseCycleCounter = pdFALSE;
+
+/**
+ * @brief What reading the counter twice costs.
+ */
+static uint32_t ulReadOverhead = 0;
+
+/**
+ * @brief The buffers transformed one call at a time and batched.
+ */
+static uint8_t ucSingleData[ nscbenchBATCH_SIZE ][ nscbenchMAX_SIZE ];
+static uint8_t ucBatchedData[ nscbenchBATCH_SIZE ][ nscbenchMAX_SIZE ];
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Starts the DWT cycle counter, or selects SysTick when there is none.
+ */
+static void prvSetupCounter( void );
+
+/**
+ * @brief Reads the counter selected by prvSetupCounter().
+ */
+static uint32_t prvReadCounter( void );
+
+/**
+ * @brief Returns the cycles between two counter readings, less the cost of
+ * reading the counter.
+ */
+static uint32_t prvElapsed( uint32_t ulStart,
+                            uint32_t ulEnd );
+
+/**
+ * @brief Implements the task which times the secure calls.
+ *
+ * @param pvParameters[in] Parameters as passed during task creation.
+ */
+static void prvNSCBenchTask( void * pvParameters );
+/*-----------------------------------------------------------*/
+
+void vStartNSCBench( void )
+{
+    static StackType_t xNSCBenchTaskStack[ nscbenchSTACK_SIZE ] __attribute__( ( aligned( 32 ) ) );
+    static StaticTask_t xNSCBenchTaskTCB;
+
+    /* The task must be privileged to access the debug and timer registers. */
+    xTaskCreateStatic( prvNSCBenchTask,
+                       "NSCBench",
+                       nscbenchSTACK_SIZE,
+                       NULL,
+                       nscbenchPRIORITY | portPRIVILEGE_BIT,
+                       xNSCBenchTaskStack,
+                       &( xNSCBenchTaskTCB ) );
+}
+/*-----------------------------------------------------------*/
+
+const NSCBenchResults_t * pxGetNSCBenchResults( void )
+{
+    return ( xBenchComplete != pdFALSE ) ? &( xNSCBenchResults ) : NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupCounter( void )
+{
+    uint32_t ulFirst;
+
+    DEMCR_REG |= DEMCR_TRCENA_BIT;
+
+    if( ( DWT_CTRL_REG & DWT_CTRL_NOCYCCNT_BIT ) == 0 )
+    {
+        DWT_CTRL_REG |= DWT_CTRL_CYCCNTENA_BIT;
+
+        /* The counter does not move if debug is not allowed on this side. */
+        ulFirst = DWT_CYCCNT_REG;
+        __asm volatile ( "nop" );
+        __asm volatile ( "nop" );
+
+        if( DWT_CYCCNT_REG != ulFirst )
+        {
+            xUseCycleCounter = pdTRUE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReadCounter( void )
+{
+    uint32_t ulCount;
+
+    if( xUseCycleCounter != pdFALSE )
+    {
+        ulCount = DWT_CYCCNT_REG;
+    }
+    else
+    {
+        ulCount = SYSTICK_CURRENT_REG;
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvElapsed( uint32_t ulStart,
+                            uint32_t ulEnd )
+{
+    uint32_t ulCycles;
+
+    if( xUseCycleCounter != pdFALSE )
+    {
+        ulCycles = ulEnd - ulStart;
+    }
+    else if( ulStart >= ulEnd )
+    {
+        /* SysTick counts down. */
+        ulCycles = ulStart - ulEnd;
+    }
+    else
+    {
+        /* SysTick reloaded in between. */
+        ulCycles = ulStart + ( SYSTICK_LOAD_REG + 1UL ) - ulEnd;
+    }
+
+    return ( ulCycles > ulReadOverhead ) ? ( ulCycles - ulReadOverhead ) : 0UL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvNSCBenchTask( void * pvParameters )
+{
+    NSCBatch_t xBatch;
+    NSCBenchSizeResult_t * pxResult;
+    uint32_t ulSingleResults[ nscbenchBATCH_SIZE ];
+    uint32_t ulStart, ulCycles, ulSingleTotal, ulBatchedTotal;
+    uint32_t ulTotal = 0, ulMin = UINT32_MAX;
+    uint32_t i, j, ulSize, ulDone;
+
+    /* Just to stop compiler warnings. */
+    ( void ) pvParameters;
+
+    /* This task calls secure side functions. So allocate a secure context for
+     * it. */
+    portALLOCATE_SECURE_CONTEXT( configMINIMAL_SECURE_STACK_SIZE );
+
+    configASSERT( nscbenchBATCH_SIZE <= nscMAX_BATCH_OPERATIONS );
+
+    prvSetupCounter();
+
+    /* The counter read overhead is the smallest difference between two
+     * readings, measured while ulReadOverhead is still 0. */
+    for( i = 0; i < 16UL; i++ )
+    {
+        ulStart = prvReadCounter();
+        ulCycles = prvElapsed( ulStart, prvReadCounter() );
+
+        if( ulCycles < ulMin )
+        {
+            ulMin = ulCycles;
+        }
+    }
+
+    ulReadOverhead = ulMin;
+    ulMin = UINT32_MAX;
+
+    /* A bare round trip. */
+    for( i = 0; i < nscbenchITERATIONS; i++ )
+    {
+        ulStart = prvReadCounter();
+        ulDone = NSCEchoFunction( i );
+        ulCycles = prvElapsed( ulStart, prvReadCounter() );
+        configASSERT( ulDone == i + 1UL );
+
+        ulTotal += ulCycles;
+
+        if( ulCycles < ulMin )
+        {
+            ulMin = ulCycles;
+        }
+    }
+
+    xNSCBenchResults.ulRoundTripMinCycles = ulMin;
+    xNSCBenchResults.ulRoundTripAverageCycles = ulTotal / nscbenchITERATIONS;
+
+    /* The same operations without and with batching. */
+    for( ulSize = 0; ulSize < nscbenchSIZES; ulSize++ )
+    {
+        for( j = 0; j < nscbenchBATCH_SIZE; j++ )
+        {
+            memset( ucSingleData[ j ], ( int ) j, nscbenchMAX_SIZE );
+            memset( ucBatchedData[ j ], ( int ) j, nscbenchMAX_SIZE );
+        }
+
+        ulSingleTotal = 0;
+        ulBatchedTotal = 0;
+
+        for( i = 0; i < nscbenchITERATIONS; i++ )
+        {
+            ulStart = prvReadCounter();
+
+            for( j = 0; j < nscbenchBATCH_SIZE; j++ )
+            {
+                ulSingleResults[ j ] = NSCTransformFunction( ucSingleData[ j ], ulOperationSizes[ ulSize ] );
+            }
+
+            ulSingleTotal += prvElapsed( ulStart, prvReadCounter() );
+
+            ulStart = prvReadCounter();
+
+            vNSCBatchInit( &( xBatch ) );
+
+            for( j = 0; j < nscbenchBATCH_SIZE; j++ )
+            {
+                ( void ) xNSCBatchAdd( &( xBatch ), ucBatchedData[ j ], ulOperationSizes[ ulSize ] );
+            }
+
+            ulDone = ulNSCBatchFlush( &( xBatch ) );
+
+            ulBatchedTotal += prvElapsed( ulStart, prvReadCounter() );
+
+            /* Both ways must have done the same. */
+            configASSERT( ulDone == nscbenchBATCH_SIZE );
+
+            for( j = 0; j < nscbenchBATCH_SIZE; j++ )
+            {
+                configASSERT( ulSingleResults[ j ] != nscTRANSFORM_INVALID );
+                configASSERT( xBatch.xOperations[ j ].ulResult == ulSingleResults[ j ] );
+            }
+        }
+
+        configASSERT( memcmp( ucSingleData, ucBatchedData, sizeof( ucSingleData ) ) == 0 );
+
+        pxResult = &( xNSCBenchResults.xSizes[ ulSize ] );
+        pxResult->ulOperationSize = ulOperationSizes[ ulSize ];
+        pxResult->ulSingleCycles = ulSingleTotal / ( nscbenchITERATIONS * nscbenchBATCH_SIZE );
+        pxResult->ulBatchedCycles = ulBatchedTotal / ( nscbenchITERATIONS * nscbenchBATCH_SIZE );
+        pxResult->ulSpeedupPercent = ( pxResult->ulBatchedCycles != 0 ) ?
+                                     ( ( pxResult->ulSingleCycles * 100UL ) / pxResult->ulBatchedCycles ) : 0UL;
+    }
+
+    xBenchComplete = pdTRUE;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,76 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+#ifndef __NSC_BENCH_H__
+#define __NSC_BENCH_H__
+
+/**
+ * @brief The sizes of operation timed, in bytes.
+ */
+#define nscbenchSIZES    ( 4 )
+
+/**
+ * @brief The cost of nscbenchBATCH_SIZE operations of one size, done with a
+ * secure call each and with one batched secure call.
+ *
+ * Cycles are per operation.  The speedup is ulSingleCycles in percent of
+ * ulBatchedCycles, so 250 means batching made the operations 2.5 times
+ * faster.
+ */
+typedef struct NSCBenchSizeResult
+{
+    uint32_t ulOperationSize;
+    uint32_t ulSingleCycles;
+    uint32_t ulBatchedCycles;
+    uint32_t ulSpeedupPercent;
+} NSCBenchSizeResult_t;
+
+/**
+ * @brief All the results of the benchmark.
+ */
+typedef struct NSCBenchResults
+{
+    uint32_t ulRoundTripMinCycles;     /* A call to NSCEchoFunction(). */
+    uint32_t ulRoundTripAverageCycles;
+    NSCBenchSizeResult_t xSizes[ nscbenchSIZES ];
+} NSCBenchResults_t;
+
+/**
+ * @brief Creates the task that measures the cost of secure calls.
+ *
+ * The task times a bare round trip into the secure side, then for each
+ * operation size the same NSCTransformFunction() operations done one secure
+ * call at a time and batched with nsc_batch.h.
+ */
+void vStartNSCBench( void );
+
+/**
+ * @brief Returns the results, or NULL until the benchmark is complete.
+ */
+const NSCBenchResults_t * pxGetNSCBenchResults( void );
+
+#endif /* __NSC_BENCH_H__ */
@@ -24,6 +24,7 @@
  *
  */
 
+#include <stddef.h>
 #include <arm_cmse.h>
 #include "nsc_functions.h"
 #include "secure_port_macros.h"
@@ -37,6 +38,33 @@ static uint32_t ulSecureCounter = 0;
  * @brief typedef for non-secure callback.
  */
 typedef void ( *NonSecureCallback_t )( void ) __attribute__( ( cmse_nonsecure_call ) );
+
+/**
+ * @brief Key used by NSCTransformFunction().
+ */
+static const uint8_t ucSecureKey[ 16 ] =
+{
+    0x3a, 0x91, 0x5c, 0xe7, 0x08, 0x6f, 0xd2, 0x44,
+    0xb9, 0x1e, 0x73, 0xc5, 0x2d, 0xf0, 0x86, 0x5b
+};
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Transforms a buffer the caller was checked to have access to.
+ */
+static uint32_t prvTransform( uint8_t * pucData,
+                              uint32_t ulLength )
+{
+    uint32_t i, ulChecksum = 0;
+
+    for( i = 0; i < ulLength; i++ )
+    {
+        pucData[ i ] ^= ucSecureKey[ i & 0x0fUL ];
+        ulChecksum = ( ulChecksum + pucData[ i ] ) & 0xffffUL;
+    }
+
+    return ulChecksum;
+}
 /*-----------------------------------------------------------*/
 
 secureportNON_SECURE_CALLABLE uint32_t NSCFunction( Callback_t pxCallback )
@@ -56,3 +84,53 @@ secureportNON_SECURE_CALLABLE uint32_t NSCFunction( Callback_t pxCallback )
     return ulSecureCounter;
 }
 /*-----------------------------------------------------------*/
+
+secureportNON_SECURE_CALLABLE uint32_t NSCEchoFunction( uint32_t ulValue )
+{
+    return ulValue + 1UL;
+}
+/*-----------------------------------------------------------*/
+
+secureportNON_SECURE_CALLABLE uint32_t NSCTransformFunction( uint8_t * pucData,
+                                                             uint32_t ulLength )
+{
+    uint32_t ulResult = nscTRANSFORM_INVALID;
+
+    /* Only touch memory the non-secure caller can read and write itself. */
+    if( cmse_check_address_range( pucData, ulLength, CMSE_NONSECURE | CMSE_MPU_READWRITE ) != NULL )
+    {
+        ulResult = prvTransform( pucData, ulLength );
+    }
+
+    return ulResult;
+}
+/*-----------------------------------------------------------*/
+
+secureportNON_SECURE_CALLABLE uint32_t NSCTransformBatchFunction( SecureOperation_t * pxOperations,
+                                                                  uint32_t ulCount )
+{
+    SecureOperation_t xOperation;
+    uint32_t i, ulDone = 0;
+
+    if( ( ulCount <= nscMAX_BATCH_OPERATIONS ) &&
+        ( cmse_check_address_range( pxOperations, ulCount * sizeof( SecureOperation_t ), CMSE_NONSECURE | CMSE_MPU_READWRITE ) != NULL ) )
+    {
+        for( i = 0; i < ulCount; i++ )
+        {
+            /* Copy the operation first so the non-secure side cannot change
+             * it between the check and the use. */
+            xOperation = pxOperations[ i ];
+
+            if( cmse_check_address_range( xOperation.pucData, xOperation.ulLength, CMSE_NONSECURE | CMSE_MPU_READWRITE ) == NULL )
+            {
+                break;
+            }
+
+            pxOperations[ i ].ulResult = prvTransform( xOperation.pucData, xOperation.ulLength );
+            ulDone++;
+        }
+    }
+
+    return ulDone;
+}
+/*-----------------------------------------------------------*/
@@ -47,4 +47,63 @@ typedef void ( * Callback_t ) ( void );
  */
 uint32_t NSCFunction( Callback_t pxCallback );
 
+/**
+ * @brief The most operations NSCTransformBatchFunction() takes in one call.
+ */
+#define nscMAX_BATCH_OPERATIONS    ( 16UL )
+
+/**
+ * @brief Returned by NSCTransformFunction() for a buffer the non-secure
+ * caller cannot read and write.
+ */
+#define nscTRANSFORM_INVALID       ( 0xffffffffUL )
+
+/**
+ * @brief One operation of a batch passed to NSCTransformBatchFunction().
+ */
+typedef struct SecureOperation
+{
+    uint8_t * pucData; /* Non-secure buffer transformed in place. */
+    uint32_t ulLength; /* Bytes in pucData. */
+    uint32_t ulResult; /* Set by the secure side to what NSCTransformFunction() would return. */
+} SecureOperation_t;
+
+/**
+ * @brief Returns ulValue plus one, to time a bare round trip into the secure
+ * side and back.
+ *
+ * @param ulValue[in] Any value.
+ *
+ * @return ulValue plus one.
+ */
+uint32_t NSCEchoFunction( uint32_t ulValue );
+
+/**
+ * @brief Transforms a buffer in place with a key only known to the secure
+ * side, as a stand in for a small crypto operation.
+ *
+ * @param pucData[in, out] The buffer to transform.
+ * @param ulLength[in] The number of bytes in pucData.
+ *
+ * @return A 16 bit checksum of the transformed buffer, or
+ * nscTRANSFORM_INVALID if the caller cannot access the whole buffer.
+ */
+uint32_t NSCTransformFunction( uint8_t * pucData,
+                               uint32_t ulLength );
+
+/**
+ * @brief Does the operations of a batch as NSCTransformFunction() does, with
+ * a single transition into the secure side.
+ *
+ * @param pxOperations[in, out] The operations, the ulResult of each is set.
+ * @param ulCount[in] The number of operations, at most
+ * nscMAX_BATCH_OPERATIONS.
+ *
+ * @return The number of operations done.  Operations stop at the first
+ * buffer the caller cannot access, and none are done if the caller cannot
+ * access the array of operations or ulCount is too large.
+ */
+uint32_t NSCTransformBatchFunction( SecureOperation_t * pxOperations,
+                                    uint32_t ulCount );
+
 #endif /* __NSC_FUNCTIONS_H__ */
@@ -0,0 +1,514 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A core to core transport in which only small descriptors cross between the
+ * cores, rather than the data itself as in MessageBufferAMP.c.  Core A takes a
+ * frame from a pool in shared memory, fills it in place, and sends the
+ * frame's descriptor to core B through the full ring.  Core B uses the frame
+ * in place, then sends it back to core A through the free ring.  Each ring has
+ * exactly one writer and one reader, so neither needs a lock, and every frame
+ * is always in exactly one ring or owned by exactly one core.
+ *
+ * After writing a ring a core generates an interrupt on the other core, whose
+ * handler unblocks the task waiting for the ring.  A port supplies:
+ *
+ * ampzcGENERATE_CORE_A_INTERRUPT() and ampzcGENERATE_CORE_B_INTERRUPT(), which
+ * trigger the other core's handler, and default to calling it directly so both
+ * cores can be emulated on one core.
+ *
+ * ampzcCLEAN_CACHE( pv, len ) and ampzcINVALIDATE_CACHE( pv, len ), which are
+ * needed when the frame pool is in cached memory, for example
+ * SCB_CleanDCache_by_Addr() and SCB_InvalidateDCache_by_Addr() on a
+ * Cortex-M7.
+ *
+ * ampzcMEMORY_BARRIER(), which must order memory accesses between the cores,
+ * for example __DMB() on Cortex-M.
+ *
+ * vStartAMPZeroCopyBenchmark() moves frames of ampzcFRAME_SIZE bytes through
+ * a message buffer, as MessageBufferAMP.c does, then through a channel, and
+ * records the frame rate and the latency from filling a frame to it being
+ * received.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_buffer.h"
+
+/* Demo app includes. */
+#include "AMPZeroCopy.h"
+
+#ifndef ampzcGENERATE_CORE_A_INTERRUPT
+    #define ampzcGENERATE_CORE_A_INTERRUPT()    vAMPZeroCopyCoreAInterruptHandler()
+#endif
+
+#ifndef ampzcGENERATE_CORE_B_INTERRUPT
+    #define ampzcGENERATE_CORE_B_INTERRUPT()    vAMPZeroCopyCoreBInterruptHandler()
+#endif
+
+#ifndef ampzcCLEAN_CACHE
+    #define ampzcCLEAN_CACHE( pv, len )
+#endif
+
+#ifndef ampzcINVALIDATE_CACHE
+    #define ampzcINVALIDATE_CACHE( pv, len )
+#endif
+
+#ifndef ampzcMEMORY_BARRIER
+    #define ampzcMEMORY_BARRIER()               portMEMORY_BARRIER()
+#endif
+
+/* The free running counter used to time the benchmark. */
+#ifndef ampzcGET_TIME
+    #define ampzcGET_TIME()                     ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+/* How long the benchmark moves frames through each transport. */
+#ifndef ampzcBENCHMARK_DURATION_MS
+    #define ampzcBENCHMARK_DURATION_MS          ( 2000 )
+#endif
+
+#if ( ( ampzcNUMBER_OF_FRAMES & ( ampzcNUMBER_OF_FRAMES - 1 ) ) != 0 )
+    #error ampzcNUMBER_OF_FRAMES must be a power of two.
+#endif
+
+#define ampzcRING_MASK                          ( ( uint32_t ) ( ampzcNUMBER_OF_FRAMES - 1 ) )
+
+/* The benchmark's tasks block for at most this long, so they notice the end of
+ * a run. */
+#define ampzcBLOCK_TIME                         pdMS_TO_TICKS( 10 )
+
+/* The consumer runs above the producer, as in MessageBufferAMP.c. */
+#define ampzcPRODUCER_PRIORITY                  ( tskIDLE_PRIORITY + 1 )
+#define ampzcCONSUMER_PRIORITY                  ( tskIDLE_PRIORITY + 2 )
+#define ampzcCONTROL_PRIORITY                   ( tskIDLE_PRIORITY + 3 )
+
+#define ampzcTRANSPORT_COPY                     ( ( UBaseType_t ) 0 )
+#define ampzcTRANSPORT_ZERO_COPY                ( ( UBaseType_t ) 1 )
+#define ampzcNUMBER_OF_TRANSPORTS               ( 2 )
+
+/*-----------------------------------------------------------*/
+
+/* Add a descriptor to a ring, which cannot be full as it has room for every
+ * frame in the pool. */
+static void prvRingWrite( AMPZeroCopyRing_t * pxRing,
+                          uint32_t ulFrame,
+                          uint32_t ulLength );
+
+/* Remove the oldest descriptor from a ring, returning pdFALSE if it is
+ * empty. */
+static BaseType_t prvRingRead( AMPZeroCopyRing_t * pxRing,
+                               AMPZeroCopyDescriptor_t * pxDescriptor );
+
+/* The benchmark tasks. */
+static void prvBenchmarkControlTask( void * pvParameters );
+static void prvBenchmarkProducerTask( void * pvParameters );
+static void prvBenchmarkConsumerTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/* The task on this core that is waiting for a ring written by the other core.
+ * Each core has its own copy of these. */
+static TaskHandle_t xCoreAWaitingTask = NULL, xCoreBWaitingTask = NULL;
+
+/* The shared memory used by the benchmark, which is just normal memory as both
+ * cores are emulated on one. */
+static AMPZeroCopyChannel_t xBenchmarkChannel;
+static uint8_t ucBenchmarkFramePool[ ampzcNUMBER_OF_FRAMES * ampzcFRAME_SIZE ];
+
+/* The message buffer the copying transport uses, and the frames copied into
+ * and out of it. */
+static MessageBufferHandle_t xBenchmarkMessageBuffer = NULL;
+static uint8_t ucCopyTxFrame[ ampzcFRAME_SIZE ], ucCopyRxFrame[ ampzcFRAME_SIZE ];
+
+static TaskHandle_t xBenchmarkControlTask = NULL, xBenchmarkProducerTask = NULL, xBenchmarkConsumerTask = NULL;
+static volatile BaseType_t xBenchmarkRunning = pdFALSE, xBenchmarkComplete = pdFALSE;
+
+/* The transport being measured, and a count of the runs started.  The
+ * interrupt handlers also notify the benchmark tasks, so the tasks use the
+ * count to tell a new run from a stray notification. */
+static volatile UBaseType_t uxBenchmarkTransport = ampzcTRANSPORT_COPY, uxBenchmarkRuns = 0;
+
+/* Counted by the consumer while a transport is measured. */
+static uint32_t ulFramesReceived, ulMaxLatency;
+static uint64_t ullTotalLatency;
+
+static const char * const pcTransportNames[ ampzcNUMBER_OF_TRANSPORTS ] = { "copy", "zero copy" };
+static AMPZeroCopyBenchmarkResult_t xResults[ ampzcNUMBER_OF_TRANSPORTS ];
+static volatile UBaseType_t uxResultCount = 0;
+
+/*-----------------------------------------------------------*/
+
+void vAMPZeroCopyInitialise( AMPZeroCopyChannel_t * pxChannel,
+                             uint8_t * pucFramePool )
+{
+    uint32_t ulFrame;
+
+    memset( pxChannel, 0x00, sizeof( *pxChannel ) );
+    pxChannel->pucFramePool = pucFramePool;
+
+    /* Core A owns every frame to start with. */
+    for( ulFrame = 0; ulFrame < ampzcNUMBER_OF_FRAMES; ulFrame++ )
+    {
+        prvRingWrite( &( pxChannel->xFreeRing ), ulFrame, 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingWrite( AMPZeroCopyRing_t * pxRing,
+                          uint32_t ulFrame,
+                          uint32_t ulLength )
+{
+    uint32_t ulHead = pxRing->ulHead;
+
+    configASSERT( ( ulHead - pxRing->ulTail ) < ampzcNUMBER_OF_FRAMES );
+
+    pxRing->xDescriptors[ ulHead & ampzcRING_MASK ].ulFrame = ulFrame;
+    pxRing->xDescriptors[ ulHead & ampzcRING_MASK ].ulLength = ulLength;
+
+    /* The descriptor must be visible to the other core before the head that
+     * publishes it. */
+    ampzcMEMORY_BARRIER();
+    pxRing->ulHead = ulHead + 1U;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRingRead( AMPZeroCopyRing_t * pxRing,
+                               AMPZeroCopyDescriptor_t * pxDescriptor )
+{
+    uint32_t ulTail = pxRing->ulTail;
+    BaseType_t xReturn = pdFALSE;
+
+    if( ulTail != pxRing->ulHead )
+    {
+        /* Do not read the descriptor before the head that published it. */
+        ampzcMEMORY_BARRIER();
+        *pxDescriptor = pxRing->xDescriptors[ ulTail & ampzcRING_MASK ];
+
+        /* Finish reading the descriptor before the writer can reuse it. */
+        ampzcMEMORY_BARRIER();
+        pxRing->ulTail = ulTail + 1U;
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void * pvAMPZeroCopyGetFrame( AMPZeroCopyChannel_t * pxChannel,
+                              TickType_t xTicksToWait )
+{
+    AMPZeroCopyDescriptor_t xDescriptor;
+    void * pvFrame = NULL;
+
+    /* Record the task to wake before looking at the ring, so a frame released
+     * after the ring is found empty still wakes it. */
+    xCoreAWaitingTask = xTaskGetCurrentTaskHandle();
+
+    do
+    {
+        if( prvRingRead( &( pxChannel->xFreeRing ), &xDescriptor ) != pdFALSE )
+        {
+            configASSERT( xDescriptor.ulFrame < ampzcNUMBER_OF_FRAMES );
+            pvFrame = &( pxChannel->pucFramePool[ xDescriptor.ulFrame * ampzcFRAME_SIZE ] );
+            break;
+        }
+    } while( ulTaskNotifyTake( pdTRUE, xTicksToWait ) != 0 );
+
+    return pvFrame;
+}
+/*-----------------------------------------------------------*/
+
+void vAMPZeroCopySendFrame( AMPZeroCopyChannel_t * pxChannel,
+                            void * pvFrame,
+                            size_t xLength )
+{
+    uint32_t ulFrame = ( uint32_t ) ( ( ( uint8_t * ) pvFrame - pxChannel->pucFramePool ) / ampzcFRAME_SIZE );
+
+    configASSERT( ulFrame < ampzcNUMBER_OF_FRAMES );
+    configASSERT( xLength <= ampzcFRAME_SIZE );
+
+    /* Write the data back to memory before core B is told it is there. */
+    ampzcCLEAN_CACHE( pvFrame, xLength );
+
+    prvRingWrite( &( pxChannel->xFullRing ), ulFrame, ( uint32_t ) xLength );
+    ampzcGENERATE_CORE_B_INTERRUPT();
+}
+/*-----------------------------------------------------------*/
+
+void * pvAMPZeroCopyReceiveFrame( AMPZeroCopyChannel_t * pxChannel,
+                                  size_t * pxLength,
+                                  TickType_t xTicksToWait )
+{
+    AMPZeroCopyDescriptor_t xDescriptor;
+    void * pvFrame = NULL;
+
+    xCoreBWaitingTask = xTaskGetCurrentTaskHandle();
+
+    do
+    {
+        if( prvRingRead( &( pxChannel->xFullRing ), &xDescriptor ) != pdFALSE )
+        {
+            configASSERT( xDescriptor.ulFrame < ampzcNUMBER_OF_FRAMES );
+            configASSERT( xDescriptor.ulLength <= ampzcFRAME_SIZE );
+            pvFrame = &( pxChannel->pucFramePool[ xDescriptor.ulFrame * ampzcFRAME_SIZE ] );
+            *pxLength = ( size_t ) xDescriptor.ulLength;
+
+            /* Discard any stale copy of the frame this core has cached. */
+            ampzcINVALIDATE_CACHE( pvFrame, xDescriptor.ulLength );
+            break;
+        }
+    } while( ulTaskNotifyTake( pdTRUE, xTicksToWait ) != 0 );
+
+    return pvFrame;
+}
+/*-----------------------------------------------------------*/
+
+void vAMPZeroCopyReleaseFrame( AMPZeroCopyChannel_t * pxChannel,
+                               void * pvFrame )
+{
+    uint32_t ulFrame = ( uint32_t ) ( ( ( uint8_t * ) pvFrame - pxChannel->pucFramePool ) / ampzcFRAME_SIZE );
+
+    configASSERT( ulFrame < ampzcNUMBER_OF_FRAMES );
+
+    prvRingWrite( &( pxChannel->xFreeRing ), ulFrame, 0 );
+    ampzcGENERATE_CORE_A_INTERRUPT();
+}
+/*-----------------------------------------------------------*/
+
+void vAMPZeroCopyCoreAInterruptHandler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if( xCoreAWaitingTask != NULL )
+    {
+        vTaskNotifyGiveFromISR( xCoreAWaitingTask, &xHigherPriorityTaskWoken );
+    }
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+void vAMPZeroCopyCoreBInterruptHandler( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if( xCoreBWaitingTask != NULL )
+    {
+        vTaskNotifyGiveFromISR( xCoreBWaitingTask, &xHigherPriorityTaskWoken );
+    }
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+void vStartAMPZeroCopyBenchmark( configSTACK_DEPTH_TYPE xStackSize )
+{
+    /* Room for all the frames, each with the message buffer's length word. */
+    xBenchmarkMessageBuffer = xMessageBufferCreate( ampzcNUMBER_OF_FRAMES * ( ampzcFRAME_SIZE + sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) ) );
+    configASSERT( xBenchmarkMessageBuffer );
+
+    vAMPZeroCopyInitialise( &xBenchmarkChannel, ucBenchmarkFramePool );
+
+    xTaskCreate( prvBenchmarkControlTask, "AMPZCCtl", xStackSize, NULL, ampzcCONTROL_PRIORITY, &xBenchmarkControlTask );
+    xTaskCreate( prvBenchmarkConsumerTask, "AMPZCRx", xStackSize, NULL, ampzcCONSUMER_PRIORITY, &xBenchmarkConsumerTask );
+    xTaskCreate( prvBenchmarkProducerTask, "AMPZCTx", xStackSize, NULL, ampzcPRODUCER_PRIORITY, &xBenchmarkProducerTask );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsAMPZeroCopyBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetAMPZeroCopyBenchmarkResults( const AMPZeroCopyBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkControlTask( void * pvParameters )
+{
+    UBaseType_t uxTransport;
+    TickType_t xStartTime, xElapsed;
+    AMPZeroCopyBenchmarkResult_t * pxResult;
+
+    ( void ) pvParameters;
+
+    for( uxTransport = 0; uxTransport < ampzcNUMBER_OF_TRANSPORTS; uxTransport++ )
+    {
+        ulFramesReceived = 0;
+        ulMaxLatency = 0;
+        ullTotalLatency = 0;
+        uxBenchmarkTransport = uxTransport;
+        xBenchmarkRunning = pdTRUE;
+        uxBenchmarkRuns++;
+        xStartTime = xTaskGetTickCount();
+
+        xTaskNotifyGive( xBenchmarkConsumerTask );
+        xTaskNotifyGive( xBenchmarkProducerTask );
+
+        vTaskDelay( pdMS_TO_TICKS( ampzcBENCHMARK_DURATION_MS ) );
+        xBenchmarkRunning = pdFALSE;
+        xElapsed = xTaskGetTickCount() - xStartTime;
+
+        /* Wait for both tasks to stop.  Each take consumes one notification. */
+        ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+        ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+
+        pxResult = &( xResults[ uxTransport ] );
+        pxResult->pcTransport = pcTransportNames[ uxTransport ];
+        pxResult->ulFramesPerSecond = ( uint32_t ) ( ( ( uint64_t ) ulFramesReceived * configTICK_RATE_HZ ) / ( ( xElapsed > 0 ) ? xElapsed : 1 ) );
+        pxResult->ulAverageLatency = ( ulFramesReceived > 0 ) ? ( uint32_t ) ( ullTotalLatency / ulFramesReceived ) : 0;
+        pxResult->ulMaxLatency = ulMaxLatency;
+        uxResultCount++;
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkProducerTask( void * pvParameters )
+{
+    UBaseType_t uxTransport, uxLastRun = 0;
+    uint32_t ulSequence = 0, ulTime;
+    uint8_t * pucFrame;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Wait for the next run to start. */
+        while( uxBenchmarkRuns == uxLastRun )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+
+        uxLastRun = uxBenchmarkRuns;
+        uxTransport = uxBenchmarkTransport;
+
+        while( xBenchmarkRunning != pdFALSE )
+        {
+            if( uxTransport == ampzcTRANSPORT_COPY )
+            {
+                pucFrame = ucCopyTxFrame;
+            }
+            else
+            {
+                pucFrame = ( uint8_t * ) pvAMPZeroCopyGetFrame( &xBenchmarkChannel, ampzcBLOCK_TIME );
+
+                if( pucFrame == NULL )
+                {
+                    continue;
+                }
+            }
+
+            /* Fill the whole frame, as a sensor frame would be, and stamp it
+             * so the consumer can measure the latency. */
+            memset( pucFrame, ( int ) ( ulSequence & 0xffU ), ampzcFRAME_SIZE );
+            ulTime = ampzcGET_TIME();
+            memcpy( pucFrame, &ulTime, sizeof( ulTime ) );
+            ulSequence++;
+
+            if( uxTransport == ampzcTRANSPORT_COPY )
+            {
+                ( void ) xMessageBufferSend( xBenchmarkMessageBuffer, pucFrame, ampzcFRAME_SIZE, ampzcBLOCK_TIME );
+            }
+            else
+            {
+                vAMPZeroCopySendFrame( &xBenchmarkChannel, pucFrame, ampzcFRAME_SIZE );
+            }
+        }
+
+        xTaskNotifyGive( xBenchmarkControlTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkConsumerTask( void * pvParameters )
+{
+    UBaseType_t uxTransport, uxLastRun = 0;
+    uint32_t ulTime, ulLatency;
+    uint8_t * pucFrame;
+    size_t xLength;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        while( uxBenchmarkRuns == uxLastRun )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+
+        uxLastRun = uxBenchmarkRuns;
+        uxTransport = uxBenchmarkTransport;
+
+        while( xBenchmarkRunning != pdFALSE )
+        {
+            if( uxTransport == ampzcTRANSPORT_COPY )
+            {
+                xLength = xMessageBufferReceive( xBenchmarkMessageBuffer, ucCopyRxFrame, sizeof( ucCopyRxFrame ), ampzcBLOCK_TIME );
+                pucFrame = ( xLength > 0 ) ? ucCopyRxFrame : NULL;
+            }
+            else
+            {
+                pucFrame = ( uint8_t * ) pvAMPZeroCopyReceiveFrame( &xBenchmarkChannel, &xLength, ampzcBLOCK_TIME );
+            }
+
+            if( pucFrame != NULL )
+            {
+                memcpy( &ulTime, pucFrame, sizeof( ulTime ) );
+                ulLatency = ampzcGET_TIME() - ulTime;
+                configASSERT( xLength == ampzcFRAME_SIZE );
+
+                if( uxTransport == ampzcTRANSPORT_ZERO_COPY )
+                {
+                    vAMPZeroCopyReleaseFrame( &xBenchmarkChannel, pucFrame );
+                }
+
+                ulFramesReceived++;
+                ullTotalLatency += ulLatency;
+
+                if( ulLatency > ulMaxLatency )
+                {
+                    ulMaxLatency = ulLatency;
+                }
+            }
+        }
+
+        xTaskNotifyGive( xBenchmarkControlTask );
+    }
+}
+/*-----------------------------------------------------------*/
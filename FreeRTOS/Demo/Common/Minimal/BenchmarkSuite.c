@@ -0,0 +1,433 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Runs a set of benchmarks and writes their results in one format, so the
+ * figures from any demo can be collected by the same script and compared
+ * across boards and releases.
+ *
+ * A demo registers each benchmark with xBenchmarkSuiteRegister(), then calls
+ * vBenchmarkSuiteRun() from a task.  The benchmarks are started one after the
+ * other, each once the previous one is complete, and the pvReport() function
+ * of each is called when it completes.  Every figure is written as one line
+ * of JSON with the keys always in the same order:
+ *
+ * {"v":1,"board":"posix","release":"V11.0.0","bench":"timer","case":"wheel/64","metric":"max_late","value":812,"unit":"counts"}
+ *
+ * "release" is tskKERNEL_VERSION_NUMBER.  "value" is always an unsigned
+ * integer, in the unit named by "unit".  Times read from the port are in
+ * bmsCYCLES_UNIT, which is "counts" of the run time stats counter unless the
+ * port says what the counter counts.  After each benchmark its duration in
+ * bmsCYCLES_UNIT is reported with the metric "duration".
+ *
+ * Lines are written with bmsPRINT_LINE(), which defaults to printf().  A line
+ * longer than bmsLINE_LENGTH is not written, rather than written cut short,
+ * and the number of lines dropped is reported with the bench "suite" at the
+ * end of the run if it is not zero.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "BenchmarkSuite.h"
+
+#ifndef bmsGET_CYCLES
+    #define bmsGET_CYCLES()           ( ( uint64_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+#ifndef bmsPRINT_LINE
+    #define bmsPRINT_LINE( pcLine )    printf( "%s\n", ( pcLine ) )
+#endif
+
+/* The most benchmarks that can be registered. */
+#ifndef bmsMAX_BENCHMARKS
+    #define bmsMAX_BENCHMARKS         ( 16 )
+#endif
+
+#ifndef bmsLINE_LENGTH
+    #define bmsLINE_LENGTH            ( 256 )
+#endif
+
+/* The longest metric name vBenchmarkSuiteReportSamples() can suffix. */
+#define bmsMAX_METRIC_LENGTH          ( 48 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Append pcString to pcLine at *pxLength, as a JSON string when xQuote is
+ * pdTRUE.  Return pdFAIL, leaving the line unterminated, if it does not fit.
+ */
+static BaseType_t prvAppend( char * pcLine,
+                             size_t * pxLength,
+                             const char * pcString,
+                             BaseType_t xQuote );
+static BaseType_t prvAppendNumber( char * pcLine,
+                                   size_t * pxLength,
+                                   uint64_t ullValue );
+
+/*
+ * Shell sort, so the percentiles need neither recursion nor the C library.
+ */
+static void prvSort( uint32_t * pulValues,
+                     size_t xCount );
+
+/*-----------------------------------------------------------*/
+
+static const BenchmarkDefinition_t * pxBenchmarks[ bmsMAX_BENCHMARKS ];
+static UBaseType_t uxRegistered = 0;
+
+/* Set for the duration of vBenchmarkSuiteRun(). */
+static const char * pcBoardName = "";
+static const char * pcRunningBenchmark = "";
+
+static uint32_t ulDroppedLines = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkSuiteRegister( const BenchmarkDefinition_t * pxBenchmark )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxBenchmark != NULL );
+    configASSERT( pxBenchmark->pxIsComplete != NULL );
+    configASSERT( pxBenchmark->pvReport != NULL );
+
+    if( uxRegistered < ( UBaseType_t ) bmsMAX_BENCHMARKS )
+    {
+        pxBenchmarks[ uxRegistered ] = pxBenchmark;
+        uxRegistered++;
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkSuiteRun( const char * pcBoard,
+                         TickType_t xPollPeriod )
+{
+    UBaseType_t ux;
+    uint64_t ullStart;
+
+    pcBoardName = pcBoard;
+    ulDroppedLines = 0;
+
+    for( ux = 0; ux < uxRegistered; ux++ )
+    {
+        pcRunningBenchmark = pxBenchmarks[ ux ]->pcName;
+        ullStart = bmsGET_CYCLES();
+
+        if( pxBenchmarks[ ux ]->pvStart != NULL )
+        {
+            pxBenchmarks[ ux ]->pvStart();
+        }
+
+        while( pxBenchmarks[ ux ]->pxIsComplete() == pdFALSE )
+        {
+            vTaskDelay( xPollPeriod );
+        }
+
+        /* A benchmark started before the run is only timed from its turn. */
+        vBenchmarkSuiteReport( "", "duration", bmsGET_CYCLES() - ullStart, bmsCYCLES_UNIT );
+        pxBenchmarks[ ux ]->pvReport();
+    }
+
+    if( ulDroppedLines != 0 )
+    {
+        pcRunningBenchmark = "suite";
+        vBenchmarkSuiteReport( "", "dropped_lines", ulDroppedLines, "lines" );
+    }
+
+    pcRunningBenchmark = "";
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkSuiteReport( const char * pcCase,
+                            const char * pcMetric,
+                            uint64_t ullValue,
+                            const char * pcUnit )
+{
+    char cLine[ bmsLINE_LENGTH ];
+    size_t xLength = 0;
+    BaseType_t xFits;
+
+    xFits = prvAppend( cLine, &xLength, "{\"v\":", pdFALSE );
+    xFits &= prvAppendNumber( cLine, &xLength, bmsFORMAT_VERSION );
+    xFits &= prvAppend( cLine, &xLength, ",\"board\":", pdFALSE );
+    xFits &= prvAppend( cLine, &xLength, pcBoardName, pdTRUE );
+    xFits &= prvAppend( cLine, &xLength, ",\"release\":", pdFALSE );
+    xFits &= prvAppend( cLine, &xLength, tskKERNEL_VERSION_NUMBER, pdTRUE );
+    xFits &= prvAppend( cLine, &xLength, ",\"bench\":", pdFALSE );
+    xFits &= prvAppend( cLine, &xLength, pcRunningBenchmark, pdTRUE );
+    xFits &= prvAppend( cLine, &xLength, ",\"case\":", pdFALSE );
+    xFits &= prvAppend( cLine, &xLength, pcCase, pdTRUE );
+    xFits &= prvAppend( cLine, &xLength, ",\"metric\":", pdFALSE );
+    xFits &= prvAppend( cLine, &xLength, pcMetric, pdTRUE );
+    xFits &= prvAppend( cLine, &xLength, ",\"value\":", pdFALSE );
+    xFits &= prvAppendNumber( cLine, &xLength, ullValue );
+    xFits &= prvAppend( cLine, &xLength, ",\"unit\":", pdFALSE );
+    xFits &= prvAppend( cLine, &xLength, pcUnit, pdTRUE );
+    xFits &= prvAppend( cLine, &xLength, "}", pdFALSE );
+
+    if( xFits != pdFALSE )
+    {
+        cLine[ xLength ] = '\0';
+        bmsPRINT_LINE( cLine );
+    }
+    else
+    {
+        ulDroppedLines++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkSamplesInit( BenchmarkSamples_t * pxSamples,
+                            uint32_t * pulStorage,
+                            size_t xCapacity )
+{
+    configASSERT( ( pulStorage != NULL ) || ( xCapacity == 0 ) );
+
+    pxSamples->pulSamples = pulStorage;
+    pxSamples->xCapacity = xCapacity;
+    pxSamples->xCount = 0;
+    pxSamples->xDropped = 0;
+    pxSamples->xSorted = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkSamplesAdd( BenchmarkSamples_t * pxSamples,
+                           uint32_t ulSample )
+{
+    if( pxSamples->xCount < pxSamples->xCapacity )
+    {
+        pxSamples->pulSamples[ pxSamples->xCount ] = ulSample;
+        pxSamples->xCount++;
+        pxSamples->xSorted = pdFALSE;
+    }
+    else
+    {
+        pxSamples->xDropped++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulBenchmarkSamplesPercentile( BenchmarkSamples_t * pxSamples,
+                                       uint32_t ulPercent )
+{
+    uint32_t ulReturn = 0;
+    uint64_t ullRank;
+
+    configASSERT( ulPercent <= 100UL );
+
+    if( pxSamples->xCount > 0 )
+    {
+        if( pxSamples->xSorted == pdFALSE )
+        {
+            prvSort( pxSamples->pulSamples, pxSamples->xCount );
+            pxSamples->xSorted = pdTRUE;
+        }
+
+        /* The nearest rank is the smallest rank that has at least ulPercent
+         * of the samples at or below it, rounded up. */
+        ullRank = ( ( ( uint64_t ) ulPercent * pxSamples->xCount ) + 99ULL ) / 100ULL;
+
+        if( ullRank == 0 )
+        {
+            ullRank = 1;
+        }
+
+        ulReturn = pxSamples->pulSamples[ ullRank - 1 ];
+    }
+
+    return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkSuiteReportSamples( const char * pcCase,
+                                   const char * pcMetric,
+                                   BenchmarkSamples_t * pxSamples,
+                                   const char * pcUnit )
+{
+    static const char * const pcSuffixes[] = { "_min", "_p50", "_p90", "_p99", "_max" };
+    static const uint32_t ulPercents[] = { 0, 50, 90, 99, 100 };
+    char cMetric[ bmsMAX_METRIC_LENGTH ];
+    uint64_t ullTotal = 0;
+    size_t x;
+
+    if( snprintf( cMetric, sizeof( cMetric ), "%s_count", pcMetric ) < ( int ) sizeof( cMetric ) )
+    {
+        vBenchmarkSuiteReport( pcCase, cMetric, pxSamples->xCount, "samples" );
+
+        if( pxSamples->xDropped != 0 )
+        {
+            ( void ) snprintf( cMetric, sizeof( cMetric ), "%s_dropped", pcMetric );
+            vBenchmarkSuiteReport( pcCase, cMetric, pxSamples->xDropped, "samples" );
+        }
+
+        if( pxSamples->xCount > 0 )
+        {
+            for( x = 0; x < sizeof( ulPercents ) / sizeof( ulPercents[ 0 ] ); x++ )
+            {
+                ( void ) snprintf( cMetric, sizeof( cMetric ), "%s%s", pcMetric, pcSuffixes[ x ] );
+                vBenchmarkSuiteReport( pcCase, cMetric, ulBenchmarkSamplesPercentile( pxSamples, ulPercents[ x ] ), pcUnit );
+            }
+
+            for( x = 0; x < pxSamples->xCount; x++ )
+            {
+                ullTotal += pxSamples->pulSamples[ x ];
+            }
+
+            ( void ) snprintf( cMetric, sizeof( cMetric ), "%s_avg", pcMetric );
+            vBenchmarkSuiteReport( pcCase, cMetric, ullTotal / pxSamples->xCount, pcUnit );
+        }
+    }
+    else
+    {
+        /* The metric name is too long to suffix. */
+        ulDroppedLines++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAppend( char * pcLine,
+                             size_t * pxLength,
+                             const char * pcString,
+                             BaseType_t xQuote )
+{
+    static const char cHexDigits[] = "0123456789abcdef";
+    char cEscaped[ 6 ];
+    size_t xEscapedLength, x;
+    BaseType_t xReturn = pdPASS;
+
+    if( pcString == NULL )
+    {
+        pcString = "";
+    }
+
+    if( xQuote != pdFALSE )
+    {
+        xReturn = prvAppend( pcLine, pxLength, "\"", pdFALSE );
+    }
+
+    while( ( *pcString != '\0' ) && ( xReturn != pdFAIL ) )
+    {
+        cEscaped[ 0 ] = *pcString;
+        xEscapedLength = 1;
+
+        if( xQuote != pdFALSE )
+        {
+            if( ( *pcString == '"' ) || ( *pcString == '\\' ) )
+            {
+                cEscaped[ 0 ] = '\\';
+                cEscaped[ 1 ] = *pcString;
+                xEscapedLength = 2;
+            }
+            else if( ( unsigned char ) *pcString < 0x20U )
+            {
+                cEscaped[ 0 ] = '\\';
+                cEscaped[ 1 ] = 'u';
+                cEscaped[ 2 ] = '0';
+                cEscaped[ 3 ] = '0';
+                cEscaped[ 4 ] = cHexDigits[ ( ( unsigned char ) *pcString ) >> 4 ];
+                cEscaped[ 5 ] = cHexDigits[ ( ( unsigned char ) *pcString ) & 0x0fU ];
+                xEscapedLength = 6;
+            }
+        }
+
+        /* Keep a byte for the terminator. */
+        if( ( *pxLength + xEscapedLength ) < bmsLINE_LENGTH )
+        {
+            for( x = 0; x < xEscapedLength; x++ )
+            {
+                pcLine[ *pxLength ] = cEscaped[ x ];
+                ( *pxLength )++;
+            }
+        }
+        else
+        {
+            xReturn = pdFAIL;
+        }
+
+        pcString++;
+    }
+
+    if( ( xQuote != pdFALSE ) && ( xReturn != pdFAIL ) )
+    {
+        xReturn = prvAppend( pcLine, pxLength, "\"", pdFALSE );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAppendNumber( char * pcLine,
+                                   size_t * pxLength,
+                                   uint64_t ullValue )
+{
+    char cDigits[ 21 ];
+    size_t x = sizeof( cDigits ) - 1;
+
+    /* Not every printf() handles 64-bit values, so convert by hand. */
+    cDigits[ x ] = '\0';
+
+    do
+    {
+        x--;
+        cDigits[ x ] = ( char ) ( '0' + ( ullValue % 10ULL ) );
+        ullValue /= 10ULL;
+    } while( ullValue != 0ULL );
+
+    return prvAppend( pcLine, pxLength, &( cDigits[ x ] ), pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSort( uint32_t * pulValues,
+                     size_t xCount )
+{
+    size_t xGap, x, y;
+    uint32_t ulValue;
+
+    for( xGap = xCount / 2; xGap > 0; xGap /= 2 )
+    {
+        for( x = xGap; x < xCount; x++ )
+        {
+            ulValue = pulValues[ x ];
+
+            for( y = x; ( y >= xGap ) && ( pulValues[ y - xGap ] > ulValue ); y -= xGap )
+            {
+                pulValues[ y ] = pulValues[ y - xGap ];
+            }
+
+            pulValues[ y ] = ulValue;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,311 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A benchmark variant of BlockQ.c, which compares moving small items through
+ * a queue one per call with moving them in batches with the multi item
+ * functions of QueueBulk.c.
+ *
+ * As in BlockQ.c, a producer task sends an incrementing number to a consumer
+ * task through a queue, with the consumer at the higher priority, with the
+ * producer at the higher priority, and with both at the same priority.  For
+ * each of these arrangements, and for each number of items per call in
+ * bqbBATCH_SIZES, the pair runs for bqbRUN_TIME, and the benchmark reports:
+ *
+ * - the items received per second;
+ * - the times either task found the queue full or empty, and so waited on
+ *   it, per 1000 items.  Each wait is a switch to the other task and back, so
+ *   this counts the context switches the transfer takes.
+ *
+ * A batch size of 1 uses xQueueSend() and xQueueReceive(), the others
+ * uxQueueSendMultiple() and uxQueueReceiveMultiple() with up to that many
+ * items per call.  The consumer checks that every number arrives once and in
+ * order.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo app includes. */
+#include "QueueBulk.h"
+#include "BlockQBenchmark.h"
+
+/* The numbers of items per call compared. */
+#ifndef bqbBATCH_SIZES
+    #define bqbBATCH_SIZES          { 1, 8, 32 }
+#endif
+
+/* The length of the queue, which must be at least the largest batch. */
+#ifndef bqbQUEUE_LENGTH
+    #define bqbQUEUE_LENGTH         ( 64 )
+#endif
+
+/* How long each combination runs. */
+#ifndef bqbRUN_TIME
+    #define bqbRUN_TIME             pdMS_TO_TICKS( 500 )
+#endif
+
+#define bqbMAX_BATCH                ( bqbQUEUE_LENGTH )
+#define bqbBLOCK_TIME               pdMS_TO_TICKS( 10 )
+#define bqbSTOP_TIMEOUT             pdMS_TO_TICKS( 1000 )
+
+#define bqbLOW_PRIORITY             ( tskIDLE_PRIORITY + 1 )
+#define bqbHIGH_PRIORITY            ( tskIDLE_PRIORITY + 2 )
+#define bqbBENCHMARK_PRIORITY       ( tskIDLE_PRIORITY + 3 )
+
+#define bqbARRAY_LENGTH( x )        ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* The priorities of the producer and of the consumer, as in BlockQ.c. */
+typedef struct BlockQArrangement
+{
+    const char * pcName;
+    UBaseType_t uxProducerPriority;
+    UBaseType_t uxConsumerPriority;
+} BlockQArrangement_t;
+
+/*-----------------------------------------------------------*/
+
+/* Runs every combination and records the results. */
+static void prvBenchmarkTask( void * pvParameters );
+
+/* Run one combination. */
+static void prvMeasure( const BlockQArrangement_t * pxArrangement,
+                        BlockQBenchmarkResult_t * pxResult );
+
+static void prvProducerTask( void * pvParameters );
+static void prvConsumerTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static const UBaseType_t uxBatchSizes[] = bqbBATCH_SIZES;
+
+static const BlockQArrangement_t xArrangements[] =
+{
+    { "consumer high", bqbLOW_PRIORITY,  bqbHIGH_PRIORITY },
+    { "producer high", bqbHIGH_PRIORITY, bqbLOW_PRIORITY  },
+    { "equal",         bqbLOW_PRIORITY,  bqbLOW_PRIORITY  }
+};
+
+static QueueHandle_t xQueue = NULL;
+static TaskHandle_t xBenchmarkTask = NULL;
+
+/* Read by the producer and the consumer. */
+static volatile UBaseType_t uxBatch = 1;
+static volatile BaseType_t xStop = pdFALSE;
+
+/* Written by the producer and the consumer. */
+static volatile uint32_t ulItemsReceived = 0;
+static volatile uint32_t ulWaits = 0;
+static volatile BaseType_t xErrorDetected = pdFALSE;
+
+static BlockQBenchmarkResult_t xResults[ bqbARRAY_LENGTH( xArrangements ) * bqbARRAY_LENGTH( uxBatchSizes ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartBlockQBenchmark( void )
+{
+    xQueue = xQueueCreate( bqbQUEUE_LENGTH, sizeof( uint16_t ) );
+    configASSERT( xQueue );
+
+    xTaskCreate( prvBenchmarkTask, "BQBench", configMINIMAL_STACK_SIZE, NULL, bqbBENCHMARK_PRIORITY, &xBenchmarkTask );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsBlockQBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetBlockQBenchmarkResults( const BlockQBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    UBaseType_t uxArrangement, uxSize;
+
+    ( void ) pvParameters;
+
+    for( uxArrangement = 0; uxArrangement < bqbARRAY_LENGTH( xArrangements ); uxArrangement++ )
+    {
+        for( uxSize = 0; uxSize < bqbARRAY_LENGTH( uxBatchSizes ); uxSize++ )
+        {
+            configASSERT( uxBatchSizes[ uxSize ] <= bqbMAX_BATCH );
+            uxBatch = uxBatchSizes[ uxSize ];
+            prvMeasure( &( xArrangements[ uxArrangement ] ), &( xResults[ uxResultCount ] ) );
+            uxResultCount++;
+        }
+    }
+
+    vQueueDelete( xQueue );
+    xQueue = NULL;
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasure( const BlockQArrangement_t * pxArrangement,
+                        BlockQBenchmarkResult_t * pxResult )
+{
+    TaskHandle_t xProducer = NULL, xConsumer = NULL;
+    TickType_t xStartTime, xElapsed;
+    uint32_t ulStartItems, ulStartWaits, ulItems, ulTaskWaits;
+
+    ( void ) xQueueReset( xQueue );
+    ulItemsReceived = 0;
+    ulWaits = 0;
+    xErrorDetected = pdFALSE;
+    xStop = pdFALSE;
+
+    /* The tasks do not run until this task blocks. */
+    xTaskCreate( prvConsumerTask, "BQBCons", configMINIMAL_STACK_SIZE, NULL, pxArrangement->uxConsumerPriority, &xConsumer );
+    xTaskCreate( prvProducerTask, "BQBProd", configMINIMAL_STACK_SIZE, NULL, pxArrangement->uxProducerPriority, &xProducer );
+    configASSERT( ( xConsumer != NULL ) && ( xProducer != NULL ) );
+
+    /* Let the pair settle before starting to count. */
+    vTaskDelay( 1 );
+
+    xStartTime = xTaskGetTickCount();
+    ulStartItems = ulItemsReceived;
+    ulStartWaits = ulWaits;
+
+    vTaskDelay( bqbRUN_TIME );
+
+    ulItems = ulItemsReceived - ulStartItems;
+    ulTaskWaits = ulWaits - ulStartWaits;
+    xElapsed = xTaskGetTickCount() - xStartTime;
+
+    /* Both tasks notify this one once they are out of the queue functions. */
+    xStop = pdTRUE;
+    ( void ) ulTaskNotifyTake( pdFALSE, bqbSTOP_TIMEOUT );
+    ( void ) ulTaskNotifyTake( pdFALSE, bqbSTOP_TIMEOUT );
+
+    vTaskDelete( xProducer );
+    vTaskDelete( xConsumer );
+
+    pxResult->pcPriorities = pxArrangement->pcName;
+    pxResult->uxBatch = uxBatch;
+    pxResult->ulItemsPerSecond = ( xElapsed > 0U ) ? ( uint32_t ) ( ( ( uint64_t ) ulItems * configTICK_RATE_HZ ) / xElapsed ) : 0U;
+    pxResult->ulWaitsPer1000 = ( ulItems > 0U ) ? ( uint32_t ) ( ( ( uint64_t ) ulTaskWaits * 1000U ) / ulItems ) : 0U;
+    pxResult->xErrorDetected = xErrorDetected;
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint16_t usItems[ bqbMAX_BATCH ];
+    uint16_t usValue = 0;
+    UBaseType_t ux, uxSent;
+
+    ( void ) pvParameters;
+
+    while( xStop == pdFALSE )
+    {
+        /* The items that were not sent by the previous call are sent again,
+         * so the numbers stay in sequence. */
+        for( ux = 0; ux < uxBatch; ux++ )
+        {
+            usItems[ ux ] = ( uint16_t ) ( usValue + ux );
+        }
+
+        if( uxQueueSpacesAvailable( xQueue ) == 0U )
+        {
+            ulWaits++;
+        }
+
+        if( uxBatch == 1U )
+        {
+            uxSent = ( xQueueSend( xQueue, usItems, bqbBLOCK_TIME ) == pdPASS ) ? 1U : 0U;
+        }
+        else
+        {
+            uxSent = uxQueueSendMultiple( xQueue, usItems, uxBatch, bqbBLOCK_TIME );
+        }
+
+        usValue = ( uint16_t ) ( usValue + uxSent );
+    }
+
+    xTaskNotifyGive( xBenchmarkTask );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    uint16_t usItems[ bqbMAX_BATCH ];
+    uint16_t usExpected = 0;
+    UBaseType_t ux, uxReceived;
+
+    ( void ) pvParameters;
+
+    while( xStop == pdFALSE )
+    {
+        if( uxQueueMessagesWaiting( xQueue ) == 0U )
+        {
+            ulWaits++;
+        }
+
+        if( uxBatch == 1U )
+        {
+            uxReceived = ( xQueueReceive( xQueue, usItems, bqbBLOCK_TIME ) == pdPASS ) ? 1U : 0U;
+        }
+        else
+        {
+            uxReceived = uxQueueReceiveMultiple( xQueue, usItems, uxBatch, bqbBLOCK_TIME );
+        }
+
+        for( ux = 0; ux < uxReceived; ux++ )
+        {
+            if( usItems[ ux ] != usExpected )
+            {
+                xErrorDetected = pdTRUE;
+            }
+
+            usExpected = ( uint16_t ) ( usItems[ ux ] + 1U );
+        }
+
+        ulItemsReceived += uxReceived;
+    }
+
+    xTaskNotifyGive( xBenchmarkTask );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,212 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Times a bare context switch, without a kernel object being signalled, so
+ * the figures of SignalBenchmark.c can be split into the cost of the
+ * primitive and the cost of the switches each round trip includes.
+ *
+ * The measuring task times cswbITERATIONS round trips to a partner task, each
+ * of which is two switches:
+ *
+ * 1) "yield" - the partner has the same priority and yields in a loop, as
+ *    does the measuring task, so each yield switches to the other task.
+ *
+ * 2) "preempt" - the partner has a higher priority and suspends itself in a
+ *    loop.  The measuring task resumes it, which preempts the measuring task
+ *    until the partner has suspended itself again.
+ *
+ * Times are read with cswbGET_TIME(), which defaults to the run time stats
+ * counter.  Define it to read a cycle counter for finer resolution.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "ContextSwitchBenchmark.h"
+
+#if ( INCLUDE_vTaskSuspend == 0 ) || ( INCLUDE_vTaskDelete == 0 )
+    #error ContextSwitchBenchmark.c requires INCLUDE_vTaskSuspend and INCLUDE_vTaskDelete to be 1
+#endif
+
+#ifndef cswbGET_TIME
+    #define cswbGET_TIME()        ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+/* The number of round trips timed for each way of switching. */
+#ifndef cswbITERATIONS
+    #define cswbITERATIONS        ( 1000 )
+#endif
+
+#ifndef cswbSTACK_SIZE
+    #define cswbSTACK_SIZE        ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#define cswbMEASURE_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+
+#define cswbYIELD                 ( 0 )
+#define cswbPREEMPT               ( 1 )
+#define cswbNUM_SWITCHES          ( 2 )
+
+/*-----------------------------------------------------------*/
+
+/* Times each way of switching in turn. */
+static void prvMeasureTask( void * pvParameters );
+
+/* The partners, which run until the measuring task deletes them. */
+static void prvYieldTask( void * pvParameters );
+static void prvSuspendTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static ContextSwitchBenchmarkResult_t xResults[ cswbNUM_SWITCHES ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartContextSwitchBenchmark( void )
+{
+    xTaskCreate( prvMeasureTask, "CSwMeas", cswbSTACK_SIZE, NULL, cswbMEASURE_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsContextSwitchBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetContextSwitchBenchmarkResults( const ContextSwitchBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureTask( void * pvParameters )
+{
+    ContextSwitchBenchmarkResult_t * pxResult;
+    TaskHandle_t xPartner = NULL;
+    uint32_t ulStart, ulTime, ulIteration, ulMinTrip, ulMaxTrip;
+    uint64_t ullTotal;
+    UBaseType_t uxSwitch;
+
+    ( void ) pvParameters;
+
+    for( uxSwitch = 0; uxSwitch < cswbNUM_SWITCHES; uxSwitch++ )
+    {
+        pxResult = &( xResults[ uxSwitch ] );
+
+        /* The yielding partner starts on this task's first yield.  The
+         * suspending partner runs as soon as it is created, and suspends
+         * itself until the first resume. */
+        if( uxSwitch == cswbYIELD )
+        {
+            pxResult->pcSwitch = "yield";
+            xTaskCreate( prvYieldTask, "CSwYield", cswbSTACK_SIZE, NULL, cswbMEASURE_PRIORITY, &xPartner );
+        }
+        else
+        {
+            pxResult->pcSwitch = "preempt";
+            xTaskCreate( prvSuspendTask, "CSwSusp", cswbSTACK_SIZE, NULL, cswbMEASURE_PRIORITY + 1, &xPartner );
+        }
+
+        configASSERT( xPartner );
+
+        ullTotal = 0;
+        ulMinTrip = UINT32_MAX;
+        ulMaxTrip = 0;
+
+        for( ulIteration = 0; ulIteration < cswbITERATIONS; ulIteration++ )
+        {
+            ulStart = cswbGET_TIME();
+
+            if( uxSwitch == cswbYIELD )
+            {
+                taskYIELD();
+            }
+            else
+            {
+                vTaskResume( xPartner );
+            }
+
+            ulTime = cswbGET_TIME() - ulStart;
+
+            ullTotal += ulTime;
+
+            if( ulTime < ulMinTrip )
+            {
+                ulMinTrip = ulTime;
+            }
+
+            if( ulTime > ulMaxTrip )
+            {
+                ulMaxTrip = ulTime;
+            }
+        }
+
+        vTaskDelete( xPartner );
+
+        /* Each round trip is two switches. */
+        pxResult->ulMinSwitch = ulMinTrip / 2UL;
+        pxResult->ulAverageSwitch = ( uint32_t ) ( ullTotal / ( 2ULL * cswbITERATIONS ) );
+        pxResult->ulMaxSwitch = ulMaxTrip / 2UL;
+
+        /* Let the idle task free the partner before the next is created. */
+        vTaskDelay( 1 );
+        uxResultCount++;
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        taskYIELD();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        vTaskSuspend( NULL );
+    }
+}
+/*-----------------------------------------------------------*/
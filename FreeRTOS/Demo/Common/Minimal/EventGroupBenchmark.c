@@ -0,0 +1,490 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures how setting event group bits, with the kernel event group and
+ * with the per bit waiter lists in IndexedEventGroup.c, scales with the
+ * number of tasks waiting on the group.  EventGroupsDemo.c tests the
+ * behaviour of the event group API with a few tasks; this file only times
+ * it, with up to egbMAX_WAITERS waiting tasks.
+ *
+ * For each implementation and each count in uxWaiterCounts[], that many
+ * subscriber tasks wait for egbSUBSCRIBER_BIT, and one target task waits for
+ * egbTARGET_BIT, clearing it on exit.  The benchmark task then:
+ *
+ * 1) Sets egbTARGET_BIT egbROUNDS times and reports the average cost of the
+ *    call.  The target has a lower priority than the benchmark task, so the
+ *    cost does not include switching to it, but does include looking at
+ *    every subscriber if the group walks all of its waiting tasks.
+ *
+ * 2) Sets egbSUBSCRIBER_BIT egbROUNDS times, waking every subscriber each
+ *    time, and reports the cost of the call per task woken.
+ *
+ * 3) Has vEventGroupBenchmarkTickHook() set egbTARGET_BIT from the tick
+ *    interrupt egbROUNDS times, and reports the time from the interrupt to
+ *    the target task running.  The kernel event group defers the work to the
+ *    timer service task, which then walks every waiting task.
+ *
+ * Times are read with egbGET_TIME(), which defaults to the run time stats
+ * counter.  Define it to read a cycle counter for finer resolution.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+/* Demo app includes. */
+#include "EventGroupBenchmark.h"
+#include "IndexedEventGroup.h"
+
+#if ( ( configUSE_TIMERS == 0 ) || ( INCLUDE_xTimerPendFunctionCall == 0 ) )
+    #error EventGroupBenchmark.c requires configUSE_TIMERS and INCLUDE_xTimerPendFunctionCall to be 1
+#endif
+
+#ifndef egbGET_TIME
+    #define egbGET_TIME()            ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+/* The most subscriber tasks, which is the last of uxWaiterCounts[]. */
+#ifndef egbMAX_WAITERS
+    #define egbMAX_WAITERS           ( 64 )
+#endif
+
+/* How many times each measurement is repeated. */
+#ifndef egbROUNDS
+    #define egbROUNDS                ( 16 )
+#endif
+
+#ifndef egbSTACK_SIZE
+    #define egbSTACK_SIZE            ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* The benchmark task runs above the target, which runs above the
+ * subscribers, so neither runs until the benchmark task blocks. */
+#define egbBENCHMARK_PRIORITY        ( tskIDLE_PRIORITY + 3 )
+#define egbTARGET_PRIORITY           ( tskIDLE_PRIORITY + 2 )
+#define egbSUBSCRIBER_PRIORITY       ( tskIDLE_PRIORITY + 1 )
+
+#define egbTARGET_BIT                ( ( EventBits_t ) 0x01 )
+#define egbSUBSCRIBER_BIT            ( ( EventBits_t ) 0x02 )
+
+/* How long the benchmark task waits for the woken tasks to run. */
+#define egbSETTLE_TICKS              ( 2 )
+#define egbMAX_SETTLE_WAITS          ( 100 )
+
+#define egbARRAY_LENGTH( x )         ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+#if ( configMAX_PRIORITIES <= egbBENCHMARK_PRIORITY )
+    #error EventGroupBenchmark.c needs more than egbBENCHMARK_PRIORITY priorities
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* One implementation of event groups, with a single group. */
+typedef struct EventGroupBackend
+{
+    const char * pcName;
+    void ( * vCreate )( void );
+    void ( * vDelete )( void );
+    EventBits_t ( * uxWait )( EventBits_t uxBitsToWaitFor,
+                              BaseType_t xClearOnExit,
+                              TickType_t xTicksToWait );
+    void ( * vSet )( EventBits_t uxBitsToSet );
+    void ( * vSetFromISR )( EventBits_t uxBitsToSet,
+                            BaseType_t * pxHigherPriorityTaskWoken );
+    void ( * vClear )( EventBits_t uxBitsToClear );
+} EventGroupBackend_t;
+
+static void prvKernelCreate( void );
+static void prvKernelDelete( void );
+static EventBits_t prvKernelWait( EventBits_t uxBitsToWaitFor,
+                                  BaseType_t xClearOnExit,
+                                  TickType_t xTicksToWait );
+static void prvKernelSet( EventBits_t uxBitsToSet );
+static void prvKernelSetFromISR( EventBits_t uxBitsToSet,
+                                 BaseType_t * pxHigherPriorityTaskWoken );
+static void prvKernelClear( EventBits_t uxBitsToClear );
+
+static void prvIndexedCreate( void );
+static void prvIndexedDelete( void );
+static EventBits_t prvIndexedWait( EventBits_t uxBitsToWaitFor,
+                                   BaseType_t xClearOnExit,
+                                   TickType_t xTicksToWait );
+static void prvIndexedSet( EventBits_t uxBitsToSet );
+static void prvIndexedSetFromISR( EventBits_t uxBitsToSet,
+                                  BaseType_t * pxHigherPriorityTaskWoken );
+static void prvIndexedClear( EventBits_t uxBitsToClear );
+
+/* Runs every combination in turn. */
+static void prvBenchmarkTask( void * pvParameters );
+
+/* Wait for egbSUBSCRIBER_BIT, or for egbTARGET_BIT, until the end of the
+ * combination. */
+static void prvSubscriberTask( void * pvParameters );
+static void prvTargetTask( void * pvParameters );
+
+/* Block until the count reaches uxExpected, or the wait gives up. */
+static void prvWaitForCount( volatile UBaseType_t * puxCount,
+                             UBaseType_t uxExpected );
+
+/*-----------------------------------------------------------*/
+
+static const EventGroupBackend_t xBackends[] =
+{
+    { "event group", prvKernelCreate,  prvKernelDelete,  prvKernelWait,  prvKernelSet,  prvKernelSetFromISR,  prvKernelClear  },
+    { "bit lists",   prvIndexedCreate, prvIndexedDelete, prvIndexedWait, prvIndexedSet, prvIndexedSetFromISR, prvIndexedClear }
+};
+
+static const UBaseType_t uxWaiterCounts[] = { 1, 16, egbMAX_WAITERS };
+
+static EventGroupHandle_t xKernelGroup = NULL;
+static IndexedEventGroup_t xIndexedGroup;
+
+/* The implementation being measured, which is only set while its group
+ * exists, and whether the waiting tasks should exit. */
+static const EventGroupBackend_t * volatile pxBackend = NULL;
+static volatile BaseType_t xStopping = pdFALSE;
+
+/* Updated by the waiting tasks. */
+static volatile UBaseType_t uxRunningTasks = 0;
+static volatile UBaseType_t uxSubscriberWakes = 0;
+static volatile UBaseType_t uxTargetWakes = 0;
+static volatile uint32_t ulTargetWakeTime = 0;
+
+/* Written by the tick hook. */
+static volatile BaseType_t xISRArmed = pdFALSE;
+static volatile uint32_t ulISRSetTime = 0;
+
+static EventGroupBenchmarkResult_t xResults[ egbARRAY_LENGTH( xBackends ) * egbARRAY_LENGTH( uxWaiterCounts ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartEventGroupBenchmark( void )
+{
+    xTaskCreate( prvBenchmarkTask, "EGBench", egbSTACK_SIZE, NULL, egbBENCHMARK_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsEventGroupBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetEventGroupBenchmarkResults( const EventGroupBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+void vEventGroupBenchmarkTickHook( void )
+{
+    const EventGroupBackend_t * pxCurrent = pxBackend;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if( ( xISRArmed != pdFALSE ) && ( pxCurrent != NULL ) )
+    {
+        xISRArmed = pdFALSE;
+        ulISRSetTime = egbGET_TIME();
+        pxCurrent->vSetFromISR( egbTARGET_BIT, &xHigherPriorityTaskWoken );
+
+        /* The tick interrupt switches to the woken task itself. */
+        ( void ) xHigherPriorityTaskWoken;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForCount( volatile UBaseType_t * puxCount,
+                             UBaseType_t uxExpected )
+{
+    UBaseType_t uxWaits;
+
+    for( uxWaits = 0; ( *puxCount != uxExpected ) && ( uxWaits < egbMAX_SETTLE_WAITS ); uxWaits++ )
+    {
+        vTaskDelay( egbSETTLE_TICKS );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSubscriberTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) pxBackend->uxWait( egbSUBSCRIBER_BIT, pdFALSE, portMAX_DELAY );
+
+        if( xStopping != pdFALSE )
+        {
+            break;
+        }
+
+        /* The subscribers share a priority, so may be time sliced. */
+        taskENTER_CRITICAL();
+        {
+            uxSubscriberWakes++;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    taskENTER_CRITICAL();
+    {
+        uxRunningTasks--;
+    }
+    taskEXIT_CRITICAL();
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTargetTask( void * pvParameters )
+{
+    uint32_t ulNow;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) pxBackend->uxWait( egbTARGET_BIT, pdTRUE, portMAX_DELAY );
+        ulNow = egbGET_TIME();
+
+        if( xStopping != pdFALSE )
+        {
+            break;
+        }
+
+        ulTargetWakeTime = ulNow;
+        uxTargetWakes++;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        uxRunningTasks--;
+    }
+    taskEXIT_CRITICAL();
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    EventGroupBenchmarkResult_t * pxResult;
+    UBaseType_t uxBackend, uxCount, uxWaiters, ux, uxRound, uxWakes, uxLatencies;
+    uint32_t ulStart, ulLatency;
+    uint64_t ullSetTotal, ullBroadcastTotal, ullLatencyTotal;
+
+    ( void ) pvParameters;
+
+    for( uxBackend = 0; uxBackend < egbARRAY_LENGTH( xBackends ); uxBackend++ )
+    {
+        for( uxCount = 0; uxCount < egbARRAY_LENGTH( uxWaiterCounts ); uxCount++ )
+        {
+            uxWaiters = uxWaiterCounts[ uxCount ];
+            pxResult = &( xResults[ uxResultCount ] );
+            pxResult->pcGroup = xBackends[ uxBackend ].pcName;
+            pxResult->uxWaiters = uxWaiters;
+
+            xBackends[ uxBackend ].vCreate();
+            pxBackend = &( xBackends[ uxBackend ] );
+            xStopping = pdFALSE;
+            uxSubscriberWakes = 0;
+            uxTargetWakes = 0;
+            uxRunningTasks = uxWaiters + 1U;
+
+            for( ux = 0; ux < uxWaiters; ux++ )
+            {
+                if( xTaskCreate( prvSubscriberTask, "EGSub", egbSTACK_SIZE, NULL, egbSUBSCRIBER_PRIORITY, NULL ) != pdPASS )
+                {
+                    configASSERT( pdFALSE );
+                }
+            }
+
+            if( xTaskCreate( prvTargetTask, "EGTarget", egbSTACK_SIZE, NULL, egbTARGET_PRIORITY, NULL ) != pdPASS )
+            {
+                configASSERT( pdFALSE );
+            }
+
+            /* Let every task start waiting. */
+            vTaskDelay( egbSETTLE_TICKS );
+
+            /* 1) Setting the bit only the target waits for. */
+            ullSetTotal = 0;
+
+            for( uxRound = 0; uxRound < egbROUNDS; uxRound++ )
+            {
+                ulStart = egbGET_TIME();
+                pxBackend->vSet( egbTARGET_BIT );
+                ullSetTotal += egbGET_TIME() - ulStart;
+                prvWaitForCount( &uxTargetWakes, uxRound + 1U );
+            }
+
+            pxResult->ulSetCost = ( uint32_t ) ( ullSetTotal / egbROUNDS );
+
+            /* 2) Setting the bit every subscriber waits for.  The bit is
+             * cleared before the subscribers run, so each only runs once. */
+            ullBroadcastTotal = 0;
+
+            for( uxRound = 0; uxRound < egbROUNDS; uxRound++ )
+            {
+                ulStart = egbGET_TIME();
+                pxBackend->vSet( egbSUBSCRIBER_BIT );
+                ullBroadcastTotal += egbGET_TIME() - ulStart;
+                pxBackend->vClear( egbSUBSCRIBER_BIT );
+                prvWaitForCount( &uxSubscriberWakes, ( uxRound + 1U ) * uxWaiters );
+            }
+
+            pxResult->ulBroadcastCost = ( uint32_t ) ( ullBroadcastTotal / ( egbROUNDS * uxWaiters ) );
+
+            /* 3) Setting the target's bit from the tick interrupt. */
+            ullLatencyTotal = 0;
+            uxLatencies = 0;
+            pxResult->ulMaxISRLatency = 0;
+
+            for( uxRound = 0; uxRound < egbROUNDS; uxRound++ )
+            {
+                uxWakes = uxTargetWakes;
+                xISRArmed = pdTRUE;
+                prvWaitForCount( &uxTargetWakes, uxWakes + 1U );
+
+                if( uxTargetWakes != uxWakes )
+                {
+                    ulLatency = ulTargetWakeTime - ulISRSetTime;
+                    ullLatencyTotal += ulLatency;
+                    uxLatencies++;
+
+                    if( ulLatency > pxResult->ulMaxISRLatency )
+                    {
+                        pxResult->ulMaxISRLatency = ulLatency;
+                    }
+                }
+            }
+
+            xISRArmed = pdFALSE;
+            pxResult->ulAverageISRLatency = ( uxLatencies > 0U ) ? ( uint32_t ) ( ullLatencyTotal / uxLatencies ) : 0U;
+
+            /* Wake every task so it sees xStopping and deletes itself
+             * before the group is deleted. */
+            xStopping = pdTRUE;
+            pxBackend->vSet( egbTARGET_BIT | egbSUBSCRIBER_BIT );
+            prvWaitForCount( &uxRunningTasks, 0 );
+            configASSERT( uxRunningTasks == 0U );
+
+            pxBackend = NULL;
+            xBackends[ uxBackend ].vDelete();
+            uxResultCount++;
+        }
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelCreate( void )
+{
+    xKernelGroup = xEventGroupCreate();
+    configASSERT( xKernelGroup );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelDelete( void )
+{
+    vEventGroupDelete( xKernelGroup );
+    xKernelGroup = NULL;
+}
+/*-----------------------------------------------------------*/
+
+static EventBits_t prvKernelWait( EventBits_t uxBitsToWaitFor,
+                                  BaseType_t xClearOnExit,
+                                  TickType_t xTicksToWait )
+{
+    return xEventGroupWaitBits( xKernelGroup, uxBitsToWaitFor, xClearOnExit, pdFALSE, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelSet( EventBits_t uxBitsToSet )
+{
+    ( void ) xEventGroupSetBits( xKernelGroup, uxBitsToSet );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelSetFromISR( EventBits_t uxBitsToSet,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+{
+    ( void ) xEventGroupSetBitsFromISR( xKernelGroup, uxBitsToSet, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelClear( EventBits_t uxBitsToClear )
+{
+    ( void ) xEventGroupClearBits( xKernelGroup, uxBitsToClear );
+}
+/*-----------------------------------------------------------*/
+
+static void prvIndexedCreate( void )
+{
+    vIndexedEventGroupInitialise( &xIndexedGroup );
+}
+/*-----------------------------------------------------------*/
+
+static void prvIndexedDelete( void )
+{
+    /* The group is statically allocated and nothing waits on it. */
+}
+/*-----------------------------------------------------------*/
+
+static EventBits_t prvIndexedWait( EventBits_t uxBitsToWaitFor,
+                                   BaseType_t xClearOnExit,
+                                   TickType_t xTicksToWait )
+{
+    return xIndexedEventGroupWaitBits( &xIndexedGroup, uxBitsToWaitFor, xClearOnExit, pdFALSE, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+static void prvIndexedSet( EventBits_t uxBitsToSet )
+{
+    ( void ) xIndexedEventGroupSetBits( &xIndexedGroup, uxBitsToSet );
+}
+/*-----------------------------------------------------------*/
+
+static void prvIndexedSetFromISR( EventBits_t uxBitsToSet,
+                                  BaseType_t * pxHigherPriorityTaskWoken )
+{
+    ( void ) xIndexedEventGroupSetBitsFromISR( &xIndexedGroup, uxBitsToSet, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static void prvIndexedClear( EventBits_t uxBitsToClear )
+{
+    ( void ) xIndexedEventGroupClearBits( &xIndexedGroup, uxBitsToClear );
+}
+/*-----------------------------------------------------------*/
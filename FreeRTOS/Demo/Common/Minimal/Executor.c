@@ -0,0 +1,412 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A stackless executor, for applications that run many more small handlers,
+ * such as protocol state machines, than they can give a task and a stack
+ * each.
+ *
+ * Every handler runs in the one executor task, on its stack, and costs only
+ * its ExecutorHandler_t.  Like a co-routine a handler is a function that
+ * returns whenever it would block, and that exeBEGIN() resumes after the
+ * exeWAIT() or exeYIELD() it last returned from.  Unlike co-routines a
+ * handler waits for event bits, signalled from tasks, interrupts or other
+ * handlers, rather than for a queue, and the executor is a task that
+ * sleeps on its notification, so nothing is polled: signalling a handler
+ * that is waiting for the event moves it to the ready list and notifies the
+ * executor, and the executor blocks as soon as the ready list is empty.
+ *
+ * Handlers run in the order they became ready, each until it next waits,
+ * and all at the priority of the executor task, so a handler that runs for
+ * long delays all the others.  Waiting with a timeout uses a timer of the
+ * timer wheel in TimerWheel.c, which is started only when the handler
+ * actually waits and stopped when it runs again.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+/* Demo program include files. */
+#include "Executor.h"
+
+/* Handler states. */
+#define exeSTATE_FINISHED    ( ( uint8_t ) 0 )
+#define exeSTATE_WAITING     ( ( uint8_t ) 1 )
+#define exeSTATE_READY       ( ( uint8_t ) 2 )
+#define exeSTATE_RUNNING     ( ( uint8_t ) 3 )
+
+/*-----------------------------------------------------------*/
+
+/* The task that runs the handlers. */
+static void prvExecutorTask( void * pvParameters );
+
+/* Append the handler to the ready list.  Called from a critical section. */
+static void prvMakeReady( ExecutorHandler_t * pxHandler );
+
+/* Record signalled events, and make the handler ready if it waits for one of
+ * them.  Called from a critical section. */
+static BaseType_t prvDeliverEvents( ExecutorHandler_t * pxHandler,
+                                    uint32_t ulEvents );
+
+#if ( exeINCLUDE_TIMEOUTS == 1 )
+    static void prvTimeoutCallback( TimerWheelTimer_t * pxTimer );
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Handlers ready to run, oldest first. */
+static ExecutorHandler_t * pxReadyHead = NULL;
+static ExecutorHandler_t * pxReadyTail = NULL;
+
+static TaskHandle_t xExecutorTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xExecutorInitialise( UBaseType_t uxPriority,
+                                configSTACK_DEPTH_TYPE uxStackDepth )
+{
+    if( xExecutorTask != NULL )
+    {
+        return pdPASS;
+    }
+
+    #if ( exeINCLUDE_TIMEOUTS == 1 )
+    {
+        if( xTimerWheelInitialise( uxPriority, uxStackDepth ) != pdPASS )
+        {
+            return pdFAIL;
+        }
+    }
+    #endif
+
+    return xTaskCreate( prvExecutorTask, "Exec", uxStackDepth, NULL, uxPriority, &xExecutorTask );
+}
+/*-----------------------------------------------------------*/
+
+void vExecutorHandlerStart( ExecutorHandler_t * pxHandler,
+                            ExecutorHandlerFunction_t pxFunction,
+                            void * pvContext )
+{
+    configASSERT( xExecutorTask != NULL );
+
+    pxHandler->pxFunction = pxFunction;
+    pxHandler->pvContext = pvContext;
+    pxHandler->ulEvents = 0;
+    pxHandler->usResumePoint = 0;
+
+    #if ( exeINCLUDE_TIMEOUTS == 1 )
+    {
+        vTimerWheelTimerInitialise( &( pxHandler->xTimeout ), prvTimeoutCallback, pxHandler );
+    }
+    #endif
+
+    taskENTER_CRITICAL();
+    {
+        pxHandler->ulPendingEvents = 0;
+        pxHandler->ulWaitEvents = 0;
+        prvMakeReady( pxHandler );
+    }
+    taskEXIT_CRITICAL();
+
+    xTaskNotifyGive( xExecutorTask );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xExecutorHandlerIsFinished( const ExecutorHandler_t * pxHandler )
+{
+    BaseType_t xReturn;
+
+    taskENTER_CRITICAL();
+    {
+        xReturn = ( pxHandler->ucState == exeSTATE_FINISHED ) ? pdTRUE : pdFALSE;
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xExecutorSignal( ExecutorHandler_t * pxHandler,
+                            uint32_t ulEvents )
+{
+    BaseType_t xMadeReady;
+
+    taskENTER_CRITICAL();
+    {
+        xMadeReady = prvDeliverEvents( pxHandler, ulEvents );
+    }
+    taskEXIT_CRITICAL();
+
+    /* The executor only needs waking when a handler joins the ready list. */
+    if( xMadeReady != pdFALSE )
+    {
+        xTaskNotifyGive( xExecutorTask );
+    }
+
+    return xMadeReady;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xExecutorSignalFromISR( ExecutorHandler_t * pxHandler,
+                                   uint32_t ulEvents,
+                                   BaseType_t * pxHigherPriorityTaskWoken )
+{
+    BaseType_t xMadeReady;
+    UBaseType_t uxSavedInterruptStatus;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        xMadeReady = prvDeliverEvents( pxHandler, ulEvents );
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xMadeReady != pdFALSE )
+    {
+        vTaskNotifyGiveFromISR( xExecutorTask, pxHigherPriorityTaskWoken );
+    }
+
+    return xMadeReady;
+}
+/*-----------------------------------------------------------*/
+
+size_t xExecutorStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
+                                  const void * pvTxData,
+                                  size_t xDataLengthBytes,
+                                  ExecutorHandler_t * pxHandler,
+                                  uint32_t ulEvent )
+{
+    size_t xSent;
+
+    xSent = xStreamBufferSend( xStreamBuffer, pvTxData, xDataLengthBytes, 0 );
+
+    if( xSent > 0 )
+    {
+        ( void ) xExecutorSignal( pxHandler, ulEvent );
+    }
+
+    return xSent;
+}
+/*-----------------------------------------------------------*/
+
+size_t xExecutorStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
+                                         const void * pvTxData,
+                                         size_t xDataLengthBytes,
+                                         ExecutorHandler_t * pxHandler,
+                                         uint32_t ulEvent,
+                                         BaseType_t * pxHigherPriorityTaskWoken )
+{
+    size_t xSent;
+
+    xSent = xStreamBufferSendFromISR( xStreamBuffer, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken );
+
+    if( xSent > 0 )
+    {
+        ( void ) xExecutorSignalFromISR( pxHandler, ulEvent, pxHigherPriorityTaskWoken );
+    }
+
+    return xSent;
+}
+/*-----------------------------------------------------------*/
+
+void vExecutorHandlerWait( ExecutorHandler_t * pxHandler,
+                           uint32_t ulEventsToWaitFor,
+                           TickType_t xTicksToWait )
+{
+    BaseType_t xStartTimeout = pdFALSE;
+
+    configASSERT( pxHandler->ucState == exeSTATE_RUNNING );
+
+    #if ( exeINCLUDE_TIMEOUTS == 0 )
+    {
+        configASSERT( ( xTicksToWait == 0 ) || ( xTicksToWait == portMAX_DELAY ) );
+    }
+    #endif
+
+    taskENTER_CRITICAL();
+    {
+        /* A timeout that expired after the handler was already made ready by
+         * another event is stale. */
+        pxHandler->ulPendingEvents &= ~exeEVENT_TIMEOUT;
+        pxHandler->ulWaitEvents = ulEventsToWaitFor | exeEVENT_TIMEOUT;
+
+        if( ( pxHandler->ulPendingEvents & ulEventsToWaitFor ) != 0 )
+        {
+            prvMakeReady( pxHandler );
+        }
+        else if( xTicksToWait == 0 )
+        {
+            pxHandler->ulPendingEvents |= exeEVENT_TIMEOUT;
+            prvMakeReady( pxHandler );
+        }
+        else
+        {
+            pxHandler->ucState = exeSTATE_WAITING;
+            xStartTimeout = ( xTicksToWait != portMAX_DELAY ) ? pdTRUE : pdFALSE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    #if ( exeINCLUDE_TIMEOUTS == 1 )
+    {
+        if( xStartTimeout != pdFALSE )
+        {
+            vTimerWheelTimerStart( &( pxHandler->xTimeout ), xTicksToWait, pdFALSE );
+        }
+    }
+    #else
+    {
+        ( void ) xStartTimeout;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+void vExecutorHandlerFinish( ExecutorHandler_t * pxHandler )
+{
+    configASSERT( pxHandler->ucState == exeSTATE_RUNNING );
+
+    pxHandler->usResumePoint = 0;
+
+    taskENTER_CRITICAL();
+    {
+        pxHandler->ulPendingEvents = 0;
+        pxHandler->ulWaitEvents = 0;
+        pxHandler->ucState = exeSTATE_FINISHED;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvMakeReady( ExecutorHandler_t * pxHandler )
+{
+    pxHandler->pxNext = NULL;
+    pxHandler->ucState = exeSTATE_READY;
+
+    if( pxReadyTail == NULL )
+    {
+        pxReadyHead = pxHandler;
+    }
+    else
+    {
+        pxReadyTail->pxNext = pxHandler;
+    }
+
+    pxReadyTail = pxHandler;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvDeliverEvents( ExecutorHandler_t * pxHandler,
+                                    uint32_t ulEvents )
+{
+    BaseType_t xMadeReady = pdFALSE;
+
+    /* A handler that is ready or running picks up the events when it next
+     * waits, and a finished handler ignores them. */
+    if( pxHandler->ucState != exeSTATE_FINISHED )
+    {
+        pxHandler->ulPendingEvents |= ulEvents;
+
+        if( ( pxHandler->ucState == exeSTATE_WAITING ) &&
+            ( ( pxHandler->ulPendingEvents & pxHandler->ulWaitEvents ) != 0 ) )
+        {
+            prvMakeReady( pxHandler );
+            xMadeReady = pdTRUE;
+        }
+    }
+
+    return xMadeReady;
+}
+/*-----------------------------------------------------------*/
+
+#if ( exeINCLUDE_TIMEOUTS == 1 )
+    static void prvTimeoutCallback( TimerWheelTimer_t * pxTimer )
+    {
+        ( void ) xExecutorSignal( ( ExecutorHandler_t * ) pvTimerWheelTimerGetID( pxTimer ), exeEVENT_TIMEOUT );
+    }
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvExecutorTask( void * pvParameters )
+{
+    ExecutorHandler_t * pxHandler;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        taskENTER_CRITICAL();
+        {
+            pxHandler = pxReadyHead;
+
+            if( pxHandler != NULL )
+            {
+                pxReadyHead = pxHandler->pxNext;
+
+                if( pxReadyHead == NULL )
+                {
+                    pxReadyTail = NULL;
+                }
+
+                /* Deliver the events the handler waited for, and leave the
+                 * others pending. */
+                pxHandler->ucState = exeSTATE_RUNNING;
+                pxHandler->ulEvents = pxHandler->ulPendingEvents & pxHandler->ulWaitEvents;
+
+                /* A timeout that expired after an event arrived is dropped. */
+                if( ( pxHandler->ulEvents & ~exeEVENT_TIMEOUT ) != 0 )
+                {
+                    pxHandler->ulEvents &= ~exeEVENT_TIMEOUT;
+                }
+
+                pxHandler->ulPendingEvents &= ~( pxHandler->ulEvents );
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxHandler == NULL )
+        {
+            /* A handler made ready since the list was found empty left the
+             * notification pending, so the take returns at once. */
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+            continue;
+        }
+
+        #if ( exeINCLUDE_TIMEOUTS == 1 )
+        {
+            vTimerWheelTimerStop( &( pxHandler->xTimeout ) );
+        }
+        #endif
+
+        pxHandler->pxFunction( pxHandler );
+
+        /* Every way out of a handler body goes through exeWAIT(), exeYIELD()
+         * or exeEND(). */
+        configASSERT( pxHandler->ucState != exeSTATE_RUNNING );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,423 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Compares running many small handlers on the stackless executor in
+ * Executor.c with giving each handler a task of its own, for the RAM they
+ * take and for how quickly they respond.
+ *
+ * For each number of handlers in exbHANDLER_COUNTS, and for each of the two
+ * models, the benchmark task:
+ *
+ * - signals each handler in turn exbROUNDS times, with the handlers at a
+ *   higher priority than itself, and records the time from the signal to
+ *   the handler running, which is the latency of an idle handler;
+ * - signals every handler at once with the scheduler suspended exbROUNDS
+ *   times, and records the time until the last handler has run, divided by
+ *   the number of handlers, which is the cost of dispatching a handler under
+ *   load.
+ *
+ * The RAM figure is what the model allocates for the handlers: a task
+ * control block and a stack of exbSTACK_SIZE words per handler for one task
+ * each, and an ExecutorHandler_t per handler plus the executor task, and the
+ * timer wheel task when the executor includes timeouts, for the executor.
+ * Both wait for the same signal, a task notification or an executor event,
+ * and do the same work when they run.
+ *
+ * Times are read with exbGET_TIME(), which defaults to the run time stats
+ * counter.  Define it to read a cycle counter for finer resolution.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "Executor.h"
+#include "ExecutorBenchmark.h"
+
+#ifndef exbGET_TIME
+    #define exbGET_TIME()           ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+/* The numbers of handlers compared. */
+#ifndef exbHANDLER_COUNTS
+    #define exbHANDLER_COUNTS       { 16, 128 }
+#endif
+
+/* The times each handler is signalled on its own, and the bursts. */
+#ifndef exbROUNDS
+    #define exbROUNDS               ( 20 )
+#endif
+
+/* The stack of the benchmark task, of the executor task and of each handler
+ * task. */
+#ifndef exbSTACK_SIZE
+    #define exbSTACK_SIZE           ( configMINIMAL_STACK_SIZE )
+#endif
+
+#define exbBENCHMARK_PRIORITY       ( tskIDLE_PRIORITY + 1 )
+#define exbHANDLER_PRIORITY         ( tskIDLE_PRIORITY + 2 )
+
+/* The executor events. */
+#define exbEVENT_RUN                ( ( uint32_t ) 0x01UL )
+#define exbEVENT_STOP               ( ( uint32_t ) 0x02UL )
+
+/* The RAM of one task. */
+#define exbTASK_RAM                 ( sizeof( StaticTask_t ) + ( ( size_t ) exbSTACK_SIZE * sizeof( StackType_t ) ) )
+
+#define exbARRAY_LENGTH( x )        ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* Runs both models for each number of handlers. */
+static void prvBenchmarkTask( void * pvParameters );
+
+/* The largest of exbHANDLER_COUNTS. */
+static UBaseType_t prvMaxHandlers( void );
+
+/* Create and stop the handlers of one model.  The create functions return
+ * the number of handlers created. */
+static UBaseType_t prvExecutorCreate( UBaseType_t uxHandlers );
+static void prvExecutorStop( UBaseType_t uxHandlers );
+static void prvExecutorSignal( UBaseType_t uxHandler );
+static UBaseType_t prvTasksCreate( UBaseType_t uxHandlers );
+static void prvTasksStop( UBaseType_t uxHandlers );
+static void prvTasksSignal( UBaseType_t uxHandler );
+
+/* Time one model with pxResult->uxHandlers handlers. */
+static void prvMeasure( ExecutorBenchmarkResult_t * pxResult,
+                        void ( * vSignal )( UBaseType_t uxHandler ) );
+
+/* The work done by a handler of either model each time it is signalled. */
+static void prvHandleSignal( void );
+
+static void prvExecutorHandler( ExecutorHandler_t * pxHandler );
+static void prvHandlerTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static const UBaseType_t uxHandlerCounts[] = exbHANDLER_COUNTS;
+
+/* Allocated for the largest count, when the benchmark starts. */
+static ExecutorHandler_t * pxHandlers = NULL;
+static TaskHandle_t * pxHandlerTasks = NULL;
+
+static TaskHandle_t xBenchmarkTask = NULL;
+
+/* Written by the benchmark task before a signal, and read by the handler. */
+static volatile uint32_t ulSignalTime = 0;
+static volatile BaseType_t xInBurst = pdFALSE;
+static volatile UBaseType_t uxBurstRemaining = 0;
+
+/* Written by the handlers. */
+static volatile uint32_t ulLatency = 0;
+
+static ExecutorBenchmarkResult_t xResults[ exbARRAY_LENGTH( uxHandlerCounts ) * 2 ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartExecutorBenchmark( void )
+{
+    xTaskCreate( prvBenchmarkTask, "ExecBench", exbSTACK_SIZE, NULL, exbBENCHMARK_PRIORITY, &xBenchmarkTask );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsExecutorBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetExecutorBenchmarkResults( const ExecutorBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvMaxHandlers( void )
+{
+    UBaseType_t ux, uxMax = 0;
+
+    for( ux = 0; ux < exbARRAY_LENGTH( uxHandlerCounts ); ux++ )
+    {
+        if( uxHandlerCounts[ ux ] > uxMax )
+        {
+            uxMax = uxHandlerCounts[ ux ];
+        }
+    }
+
+    return uxMax;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    ExecutorBenchmarkResult_t * pxResult;
+    UBaseType_t ux, uxCreated;
+
+    ( void ) pvParameters;
+
+    pxHandlers = pvPortMalloc( prvMaxHandlers() * sizeof( ExecutorHandler_t ) );
+    pxHandlerTasks = pvPortMalloc( prvMaxHandlers() * sizeof( TaskHandle_t ) );
+    configASSERT( pxHandlers );
+    configASSERT( pxHandlerTasks );
+
+    if( xExecutorInitialise( exbHANDLER_PRIORITY, exbSTACK_SIZE ) != pdPASS )
+    {
+        configASSERT( pdFALSE );
+    }
+
+    for( ux = 0; ux < exbARRAY_LENGTH( uxHandlerCounts ); ux++ )
+    {
+        uxCreated = prvExecutorCreate( uxHandlerCounts[ ux ] );
+        pxResult = &( xResults[ uxResultCount ] );
+        pxResult->pcModel = "executor";
+        pxResult->uxHandlers = uxCreated;
+        pxResult->xRAMBytes = ( uxCreated * sizeof( ExecutorHandler_t ) ) + exbTASK_RAM;
+
+        #if ( exeINCLUDE_TIMEOUTS == 1 )
+        {
+            pxResult->xRAMBytes += exbTASK_RAM;
+        }
+        #endif
+
+        prvMeasure( pxResult, prvExecutorSignal );
+        prvExecutorStop( uxCreated );
+        uxResultCount++;
+
+        /* Creating tasks can fail where the executor did not, in which case
+         * the result is for the tasks that could be created. */
+        uxCreated = prvTasksCreate( uxHandlerCounts[ ux ] );
+        pxResult = &( xResults[ uxResultCount ] );
+        pxResult->pcModel = "task each";
+        pxResult->uxHandlers = uxCreated;
+        pxResult->xRAMBytes = uxCreated * exbTASK_RAM;
+        prvMeasure( pxResult, prvTasksSignal );
+        prvTasksStop( uxCreated );
+        uxResultCount++;
+    }
+
+    vPortFree( pxHandlers );
+    vPortFree( pxHandlerTasks );
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasure( ExecutorBenchmarkResult_t * pxResult,
+                        void ( * vSignal )( UBaseType_t uxHandler ) )
+{
+    UBaseType_t uxHandler, uxRound;
+    uint32_t ulStart;
+    uint64_t ullTotal = 0, ullBurstTotal = 0;
+
+    pxResult->ulMinLatency = UINT32_MAX;
+    pxResult->ulMaxLatency = 0;
+
+    if( pxResult->uxHandlers == 0 )
+    {
+        pxResult->ulMinLatency = 0;
+        pxResult->ulAverageLatency = 0;
+        pxResult->ulBurstCost = 0;
+        return;
+    }
+
+    /* Each handler on its own.  The handler preempts this task as soon as it
+     * is signalled, so ulLatency is written before vSignal() returns. */
+    for( uxRound = 0; uxRound < exbROUNDS; uxRound++ )
+    {
+        for( uxHandler = 0; uxHandler < pxResult->uxHandlers; uxHandler++ )
+        {
+            ulSignalTime = exbGET_TIME();
+            vSignal( uxHandler );
+
+            ullTotal += ulLatency;
+
+            if( ulLatency < pxResult->ulMinLatency )
+            {
+                pxResult->ulMinLatency = ulLatency;
+            }
+
+            if( ulLatency > pxResult->ulMaxLatency )
+            {
+                pxResult->ulMaxLatency = ulLatency;
+            }
+        }
+    }
+
+    pxResult->ulAverageLatency = ( uint32_t ) ( ullTotal / ( ( uint64_t ) exbROUNDS * pxResult->uxHandlers ) );
+
+    /* Every handler at once.  The last to run notifies this task. */
+    for( uxRound = 0; uxRound < exbROUNDS; uxRound++ )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+        vTaskSuspendAll();
+        {
+            xInBurst = pdTRUE;
+            uxBurstRemaining = pxResult->uxHandlers;
+            ulStart = exbGET_TIME();
+
+            for( uxHandler = 0; uxHandler < pxResult->uxHandlers; uxHandler++ )
+            {
+                vSignal( uxHandler );
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ullBurstTotal += exbGET_TIME() - ulStart;
+        xInBurst = pdFALSE;
+    }
+
+    pxResult->ulBurstCost = ( uint32_t ) ( ullBurstTotal / ( ( uint64_t ) exbROUNDS * pxResult->uxHandlers ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHandleSignal( void )
+{
+    if( xInBurst == pdFALSE )
+    {
+        ulLatency = exbGET_TIME() - ulSignalTime;
+    }
+    else
+    {
+        uxBurstRemaining--;
+
+        if( uxBurstRemaining == 0 )
+        {
+            xTaskNotifyGive( xBenchmarkTask );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvExecutorCreate( UBaseType_t uxHandlers )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxHandlers; ux++ )
+    {
+        vExecutorHandlerStart( &( pxHandlers[ ux ] ), prvExecutorHandler, NULL );
+    }
+
+    return uxHandlers;
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecutorStop( UBaseType_t uxHandlers )
+{
+    UBaseType_t ux;
+
+    /* The executor has a higher priority, so each handler has finished by
+     * the time the signal returns. */
+    for( ux = 0; ux < uxHandlers; ux++ )
+    {
+        ( void ) xExecutorSignal( &( pxHandlers[ ux ] ), exbEVENT_STOP );
+        configASSERT( xExecutorHandlerIsFinished( &( pxHandlers[ ux ] ) ) == pdTRUE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecutorSignal( UBaseType_t uxHandler )
+{
+    ( void ) xExecutorSignal( &( pxHandlers[ uxHandler ] ), exbEVENT_RUN );
+}
+/*-----------------------------------------------------------*/
+
+static void prvExecutorHandler( ExecutorHandler_t * pxHandler )
+{
+    exeBEGIN( pxHandler );
+
+    for( ; ; )
+    {
+        exeWAIT( pxHandler, exbEVENT_RUN | exbEVENT_STOP, portMAX_DELAY );
+
+        if( ( exeEVENTS( pxHandler ) & exbEVENT_STOP ) != 0 )
+        {
+            break;
+        }
+
+        prvHandleSignal();
+    }
+
+    exeEND( pxHandler );
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvTasksCreate( UBaseType_t uxHandlers )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxHandlers; ux++ )
+    {
+        if( xTaskCreate( prvHandlerTask, "ExecTask", exbSTACK_SIZE, NULL, exbHANDLER_PRIORITY, &( pxHandlerTasks[ ux ] ) ) != pdPASS )
+        {
+            break;
+        }
+    }
+
+    return ux;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTasksStop( UBaseType_t uxHandlers )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxHandlers; ux++ )
+    {
+        vTaskDelete( pxHandlerTasks[ ux ] );
+    }
+
+    /* Let the idle task free the tasks before the next run. */
+    vTaskDelay( 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTasksSignal( UBaseType_t uxHandler )
+{
+    xTaskNotifyGive( pxHandlerTasks[ uxHandler ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHandlerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        prvHandleSignal();
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,518 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Replays allocation traces against whichever heap_n.c the application is
+ * built with, so heap schemes can be compared on figures rather than guessed
+ * at.  dynamic.c and StaticAllocation.c check the allocation APIs work; this
+ * file measures how the heap behaves under load.
+ *
+ * Each trace runs for heapbSTEPS steps.  At each step the blocks whose
+ * lifetime has ended are freed, then the trace allocates whatever it wants
+ * for that step.  The traces are:
+ *
+ *  - "packet bursts": bursts of network buffer sized blocks (mostly small, some
+ *    full Ethernet frames) that are released in roughly the order they were
+ *    allocated, a few tens of steps later.
+ *  - "long lived": a steady flow of short lived blocks of mixed sizes, with
+ *    a long lived block - a task, a queue - allocated between them every
+ *    heapbLONG_LIVED_PERIOD steps and kept until the end of the trace.  The
+ *    long lived blocks pin the memory around them.
+ *  - "mixed sizes": sizes from 16 bytes to 4 KB, spread evenly on a log
+ *    scale, freed in random order.
+ *
+ * The traces use a fixed seed, so every heap sees the same sequence.  No
+ * trace asks for more than heapbBUDGET bytes at once, so a failed
+ * allocation is caused by fragmentation or by per-block overhead, not by
+ * the trace itself.
+ *
+ * For every allocation the time taken is read with heapbGET_TIME(), which
+ * defaults to the run time stats counter, and added to a histogram with a
+ * bucket per power of two.  If heapbUSE_HEAP_STATS is 1, vPortGetHeapStats()
+ * is sampled heapbSAMPLES times per trace to record the largest free block
+ * and the number of free blocks.  heap_4.c and heap_5.c provide it; set
+ * heapbUSE_HEAP_STATS to 0 for the other heaps.
+ *
+ * Allocations are expected to fail sometimes, so if the malloc failed hook
+ * is used it should return without action while
+ * xIsHeapBenchmarkAllocating() returns pdTRUE.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "HeapBenchmark.h"
+
+#ifndef heapbGET_TIME
+    #define heapbGET_TIME()          ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+#ifndef heapbUSE_HEAP_STATS
+    #define heapbUSE_HEAP_STATS      1
+#endif
+
+/* The number of steps in each trace. */
+#ifndef heapbSTEPS
+    #define heapbSTEPS               ( 4000UL )
+#endif
+
+/* The most bytes a trace has allocated at once. */
+#ifndef heapbBUDGET
+    #define heapbBUDGET              ( configTOTAL_HEAP_SIZE / 2 )
+#endif
+
+/* The most blocks a trace has allocated at once. */
+#ifndef heapbMAX_LIVE
+    #define heapbMAX_LIVE            ( 128 )
+#endif
+
+#ifndef heapbSTACK_SIZE
+    #define heapbSTACK_SIZE          ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#define heapbPRIORITY                ( tskIDLE_PRIORITY + 1 )
+
+/* A lifetime that lasts until the end of the trace. */
+#define heapbFOREVER                 ( 0xffffffffUL )
+
+/* How often the "long lived" trace allocates a long lived block, and the
+ * share of the budget long lived blocks may use. */
+#define heapbLONG_LIVED_PERIOD       ( 32UL )
+#define heapbLONG_LIVED_BUDGET       ( heapbBUDGET / 3 )
+
+#define heapbARRAY_LENGTH( x )       ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* A trace makes the allocations of one step by calling prvAllocate(). */
+typedef struct HeapTrace
+{
+    const char * pcName;
+    void ( * vStep )( uint32_t ulStep );
+} HeapTrace_t;
+
+/* An allocated block, and the step at which it is to be freed. */
+typedef struct HeapBlock
+{
+    void * pvBlock;
+    size_t xSize;
+    uint32_t ulFreeAt;
+    BaseType_t xLongLived;
+} HeapBlock_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvPacketBurstStep( uint32_t ulStep );
+static void prvLongLivedStep( uint32_t ulStep );
+static void prvMixedSizesStep( uint32_t ulStep );
+
+/*
+ * Allocate a block that is freed ulLifetime steps later, measuring how long
+ * the allocation took.  Does nothing if the budget or the block table would
+ * overflow.
+ */
+static void prvAllocate( size_t xSize,
+                         uint32_t ulLifetime,
+                         BaseType_t xLongLived );
+
+/*
+ * Free every block whose lifetime ended at or before ulStep.
+ */
+static void prvFreeExpired( uint32_t ulStep );
+
+/*
+ * Record the fragmentation of the heap in the current result.
+ */
+static void prvSampleHeap( HeapBenchmarkSample_t * pxSample );
+
+/*
+ * Fill in the latency figures of the current result from its histogram.
+ */
+static void prvSummariseLatency( void );
+
+/*
+ * A small pseudo random number generator, so the traces are the same on
+ * every run and every heap.
+ */
+static uint32_t prvRand( void );
+
+/*
+ * Replays each trace in turn.
+ */
+static void prvBenchmarkTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static const HeapTrace_t xTraces[] =
+{
+    { "packet bursts", prvPacketBurstStep },
+    { "long lived",    prvLongLivedStep   },
+    { "mixed sizes",   prvMixedSizesStep  }
+};
+
+static HeapBlock_t xBlocks[ heapbMAX_LIVE ];
+static size_t xLiveBytes = 0;
+static size_t xLongLivedBytes = 0;
+static uint32_t ulRandState = 0;
+static uint64_t ullFreeCost = 0;
+static uint32_t ulFrees = 0;
+
+/* The result of the trace that is being replayed. */
+static HeapBenchmarkResult_t * pxResult = NULL;
+
+static HeapBenchmarkResult_t xResults[ heapbARRAY_LENGTH( xTraces ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+static volatile BaseType_t xAllocating = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartHeapBenchmark( void )
+{
+    xTaskCreate( prvBenchmarkTask, "HeapB", heapbSTACK_SIZE, NULL, heapbPRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsHeapBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsHeapBenchmarkAllocating( void )
+{
+    return xAllocating;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetHeapBenchmarkResults( const HeapBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRand( void )
+{
+    /* The constants are those of Numerical Recipes. */
+    ulRandState = ( ulRandState * 1664525UL ) + 1013904223UL;
+
+    return ulRandState >> 8;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPacketBurstStep( uint32_t ulStep )
+{
+    uint32_t ulPick;
+    size_t xSize;
+
+    /* Two packets a step for 16 steps out of every 64. */
+    if( ( ulStep % 64UL ) < 16UL )
+    {
+        for( ulPick = 0; ulPick < 2UL; ulPick++ )
+        {
+            switch( prvRand() % 20UL )
+            {
+                case 0: case 1: case 2:
+                    xSize = 1536;
+                    break;
+
+                case 3: case 4: case 5:
+                    xSize = 576;
+                    break;
+
+                case 6: case 7: case 8: case 9:
+                    xSize = 256;
+                    break;
+
+                default:
+                    xSize = 64 + ( prvRand() % 65UL );
+                    break;
+            }
+
+            /* Released in about the order they arrived. */
+            prvAllocate( xSize, 24UL + ( prvRand() % 16UL ), pdFALSE );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLongLivedStep( uint32_t ulStep )
+{
+    prvAllocate( 32 + ( prvRand() % 993UL ), 1UL + ( prvRand() % 16UL ), pdFALSE );
+
+    if( ( ( ulStep % heapbLONG_LIVED_PERIOD ) == 0UL ) && ( xLongLivedBytes < heapbLONG_LIVED_BUDGET ) )
+    {
+        prvAllocate( 128 + ( prvRand() % 385UL ), heapbFOREVER, pdTRUE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMixedSizesStep( uint32_t ulStep )
+{
+    size_t xSize;
+
+    ( void ) ulStep;
+
+    /* 16 bytes shifted left by 0 to 8 bits, so 16 to 4096 bytes, plus up to
+     * as much again. */
+    xSize = ( size_t ) 16 << ( prvRand() % 9UL );
+    xSize += prvRand() % xSize;
+    prvAllocate( xSize, 1UL + ( prvRand() % 128UL ), pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAllocate( size_t xSize,
+                         uint32_t ulLifetime,
+                         BaseType_t xLongLived )
+{
+    UBaseType_t ux, uxBucket;
+    uint32_t ulStart, ulLatency;
+    void * pvBlock;
+
+    if( ( xLiveBytes + xSize ) > heapbBUDGET )
+    {
+        return;
+    }
+
+    for( ux = 0; ux < heapbMAX_LIVE; ux++ )
+    {
+        if( xBlocks[ ux ].pvBlock == NULL )
+        {
+            break;
+        }
+    }
+
+    if( ux == heapbMAX_LIVE )
+    {
+        return;
+    }
+
+    xAllocating = pdTRUE;
+    ulStart = heapbGET_TIME();
+    pvBlock = pvPortMalloc( xSize );
+    ulLatency = heapbGET_TIME() - ulStart;
+    xAllocating = pdFALSE;
+
+    pxResult->ulAllocations++;
+
+    if( pvBlock == NULL )
+    {
+        pxResult->ulFailures++;
+    }
+    else
+    {
+        /* Touch the block, as its user would. */
+        memset( pvBlock, 0x5a, xSize );
+
+        xBlocks[ ux ].pvBlock = pvBlock;
+        xBlocks[ ux ].xSize = xSize;
+        xBlocks[ ux ].ulFreeAt = ( ulLifetime == heapbFOREVER ) ? heapbFOREVER : ( pxResult->ulSteps + ulLifetime );
+        xBlocks[ ux ].xLongLived = xLongLived;
+
+        xLiveBytes += xSize;
+
+        if( xLongLived != pdFALSE )
+        {
+            xLongLivedBytes += xSize;
+        }
+
+        if( xLiveBytes > pxResult->xPeakBytes )
+        {
+            pxResult->xPeakBytes = xLiveBytes;
+        }
+    }
+
+    /* Bucket n holds latencies below 2^n. */
+    for( uxBucket = 0; ( uxBucket < ( heapbHISTOGRAM_BUCKETS - 1 ) ) && ( ulLatency >= ( 1UL << uxBucket ) ); uxBucket++ )
+    {
+    }
+
+    pxResult->ulLatencyHistogram[ uxBucket ]++;
+    pxResult->ulMinLatency = ( ulLatency < pxResult->ulMinLatency ) ? ulLatency : pxResult->ulMinLatency;
+    pxResult->ulMaxLatency = ( ulLatency > pxResult->ulMaxLatency ) ? ulLatency : pxResult->ulMaxLatency;
+    pxResult->ullTotalLatency += ulLatency;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeExpired( uint32_t ulStep )
+{
+    UBaseType_t ux;
+    uint32_t ulStart;
+
+    for( ux = 0; ux < heapbMAX_LIVE; ux++ )
+    {
+        if( ( xBlocks[ ux ].pvBlock != NULL ) && ( xBlocks[ ux ].ulFreeAt <= ulStep ) )
+        {
+            ulStart = heapbGET_TIME();
+            vPortFree( xBlocks[ ux ].pvBlock );
+            ullFreeCost += heapbGET_TIME() - ulStart;
+            ulFrees++;
+
+            xLiveBytes -= xBlocks[ ux ].xSize;
+
+            if( xBlocks[ ux ].xLongLived != pdFALSE )
+            {
+                xLongLivedBytes -= xBlocks[ ux ].xSize;
+            }
+
+            xBlocks[ ux ].pvBlock = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSampleHeap( HeapBenchmarkSample_t * pxSample )
+{
+    #if ( heapbUSE_HEAP_STATS == 1 )
+        HeapStats_t xHeapStats;
+
+        vPortGetHeapStats( &xHeapStats );
+        pxSample->xFreeBytes = xHeapStats.xAvailableHeapSpaceInBytes;
+        pxSample->xLargestFreeBlock = xHeapStats.xSizeOfLargestFreeBlockInBytes;
+        pxSample->xFreeBlocks = xHeapStats.xNumberOfFreeBlocks;
+    #else
+        memset( pxSample, 0, sizeof( *pxSample ) );
+    #endif
+
+    pxSample->xLiveBytes = xLiveBytes;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSummariseLatency( void )
+{
+    uint32_t ulCount = 0, ulMedian, ulP99;
+    UBaseType_t uxBucket;
+
+    ulMedian = ( pxResult->ulAllocations + 1UL ) / 2UL;
+    ulP99 = pxResult->ulAllocations - ( pxResult->ulAllocations / 100UL );
+
+    for( uxBucket = 0; uxBucket < heapbHISTOGRAM_BUCKETS; uxBucket++ )
+    {
+        ulCount += pxResult->ulLatencyHistogram[ uxBucket ];
+
+        if( ( pxResult->ulLatencyP50 == 0 ) && ( ulCount >= ulMedian ) )
+        {
+            pxResult->ulLatencyP50 = 1UL << uxBucket;
+        }
+
+        if( ( pxResult->ulLatencyP99 == 0 ) && ( ulCount >= ulP99 ) )
+        {
+            pxResult->ulLatencyP99 = 1UL << uxBucket;
+        }
+    }
+
+    if( pxResult->ulAllocations != 0 )
+    {
+        pxResult->ulAverageLatency = ( uint32_t ) ( pxResult->ullTotalLatency / pxResult->ulAllocations );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    const uint32_t ulSampleInterval = heapbSTEPS / heapbSAMPLES;
+    UBaseType_t uxTrace, uxSample;
+    uint32_t ulStep;
+
+    ( void ) pvParameters;
+
+    for( uxTrace = 0; uxTrace < heapbARRAY_LENGTH( xTraces ); uxTrace++ )
+    {
+        pxResult = &( xResults[ uxTrace ] );
+        memset( pxResult, 0, sizeof( *pxResult ) );
+        pxResult->pcTrace = xTraces[ uxTrace ].pcName;
+        pxResult->ulMinLatency = 0xffffffffUL;
+        pxResult->xMinLargestFreeBlock = ( size_t ) -1;
+
+        memset( xBlocks, 0, sizeof( xBlocks ) );
+        xLiveBytes = 0;
+        xLongLivedBytes = 0;
+        ullFreeCost = 0;
+        ulFrees = 0;
+        ulRandState = 0x12345678UL;
+        uxSample = 0;
+
+        prvSampleHeap( &( pxResult->xBefore ) );
+
+        for( ulStep = 0; ulStep < heapbSTEPS; ulStep++ )
+        {
+            pxResult->ulSteps = ulStep;
+            prvFreeExpired( ulStep );
+            xTraces[ uxTrace ].vStep( ulStep );
+
+            if( ( ( ulStep + 1UL ) % ulSampleInterval ) == 0UL )
+            {
+                prvSampleHeap( &( pxResult->xSamples[ uxSample ] ) );
+
+                #if ( heapbUSE_HEAP_STATS == 1 )
+                    if( pxResult->xSamples[ uxSample ].xLargestFreeBlock < pxResult->xMinLargestFreeBlock )
+                    {
+                        pxResult->xMinLargestFreeBlock = pxResult->xSamples[ uxSample ].xLargestFreeBlock;
+                    }
+
+                    if( pxResult->xSamples[ uxSample ].xFreeBlocks > pxResult->xMaxFreeBlocks )
+                    {
+                        pxResult->xMaxFreeBlocks = pxResult->xSamples[ uxSample ].xFreeBlocks;
+                    }
+                #endif
+
+                uxSample++;
+
+                /* Let the lower priority tasks run now and then. */
+                vTaskDelay( 1 );
+            }
+        }
+
+        /* Free everything, long lived blocks included, to see whether the heap
+         * returns to the state it started in. */
+        prvFreeExpired( heapbFOREVER );
+        prvSampleHeap( &( pxResult->xAfter ) );
+
+        #if ( heapbUSE_HEAP_STATS == 0 )
+            pxResult->xMinLargestFreeBlock = 0;
+        #endif
+
+        prvSummariseLatency();
+
+        if( ulFrees != 0 )
+        {
+            pxResult->ulAverageFreeCost = ( uint32_t ) ( ullFreeCost / ulFrees );
+        }
+
+        uxResultCount = uxTrace + 1;
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,430 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * An event group for systems with many tasks waiting on a few bits each.
+ *
+ * A kernel event group keeps a single list of the tasks waiting on it, so
+ * setting any bit walks every waiting task with the scheduler suspended.
+ * Setting bits from an interrupt sends a message to the timer service task,
+ * which then does the walk, so the time from the interrupt to the right task
+ * being woken grows with the number of waiting tasks and also depends on
+ * what else the timer service task has to do.
+ *
+ * Here every bit has its own list of waiting tasks.  A task waiting for any
+ * of several bits is linked into the list of each of them, and a task
+ * waiting for all of several bits is linked into the list of the lowest bit
+ * it still needs, as it cannot be woken before that bit is set, and moves on
+ * to the next bit it needs if the others are not set yet.  Setting bits only
+ * walks the lists of the bits being set, inside a critical section, so is
+ * bounded by the number of tasks waiting for those bits, however many wait
+ * for other bits.  That also makes it short enough to do in the interrupt,
+ * so there is no deferral to the timer service task.
+ *
+ * Waiting tasks are woken with a direct to task notification, with index
+ * iegNOTIFICATION_INDEX, which they must not use for anything else while they
+ * wait.  Only bits 0 to iegBITS - 1 can be waited for.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+/* Demo program include files. */
+#include "IndexedEventGroup.h"
+
+#ifndef iegNOTIFICATION_INDEX
+    #define iegNOTIFICATION_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+#if ( configUSE_16_BIT_TICKS == 1 )
+    #define iegMAX_BITS    ( 8 )
+#else
+    #define iegMAX_BITS    ( 24 )
+#endif
+
+#if ( iegBITS > iegMAX_BITS )
+    #error iegBITS is more than an event group holds.
+#endif
+
+#define iegALL_BITS    ( ( EventBits_t ) ( ( 1UL << iegBITS ) - 1UL ) )
+
+/*-----------------------------------------------------------*/
+
+/* A task waiting on the group, which lives on the stack of the task. */
+typedef struct IndexedEventGroupWaiter
+{
+    IndexedEventGroupLink_t xLinks[ iegBITS ];
+    TaskHandle_t xTask;
+    EventBits_t uxBitsToWaitFor;
+    BaseType_t xClearOnExit;
+    BaseType_t xWaitForAllBits;
+    BaseType_t xWoken;
+    EventBits_t uxBitsWhenWoken;
+} IndexedEventGroupWaiter_t;
+
+/*-----------------------------------------------------------*/
+
+/* Whether the bits satisfy the wait. */
+static BaseType_t prvWaitConditionMet( EventBits_t uxCurrentBits,
+                                       EventBits_t uxBitsToWaitFor,
+                                       BaseType_t xWaitForAllBits );
+
+/* Link the waiter into the list of each bit it can be woken by, or take it
+ * out of them.  Called from a critical section. */
+static void prvLinkWaiter( IndexedEventGroup_t * pxGroup,
+                           IndexedEventGroupWaiter_t * pxWaiter );
+static void prvLinkWaiterToBit( IndexedEventGroup_t * pxGroup,
+                                IndexedEventGroupWaiter_t * pxWaiter,
+                                UBaseType_t uxBit );
+static void prvUnlinkWaiter( IndexedEventGroupWaiter_t * pxWaiter );
+
+/* Set the bits and wake the tasks waiting for them.  Called from a critical
+ * section, with xFromISR set if that is in an interrupt. */
+static void prvSetBits( IndexedEventGroup_t * pxGroup,
+                        EventBits_t uxBitsToSet,
+                        BaseType_t xFromISR,
+                        BaseType_t * pxHigherPriorityTaskWoken );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWaitConditionMet( EventBits_t uxCurrentBits,
+                                       EventBits_t uxBitsToWaitFor,
+                                       BaseType_t xWaitForAllBits )
+{
+    BaseType_t xReturn;
+
+    if( xWaitForAllBits == pdFALSE )
+    {
+        xReturn = ( ( uxCurrentBits & uxBitsToWaitFor ) != 0U ) ? pdTRUE : pdFALSE;
+    }
+    else
+    {
+        xReturn = ( ( uxCurrentBits & uxBitsToWaitFor ) == uxBitsToWaitFor ) ? pdTRUE : pdFALSE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLinkWaiterToBit( IndexedEventGroup_t * pxGroup,
+                                IndexedEventGroupWaiter_t * pxWaiter,
+                                UBaseType_t uxBit )
+{
+    IndexedEventGroupLink_t * pxHead = &( pxGroup->xWaiters[ uxBit ] );
+    IndexedEventGroupLink_t * pxLink = &( pxWaiter->xLinks[ uxBit ] );
+
+    pxLink->pxNext = pxHead;
+    pxLink->pxPrevious = pxHead->pxPrevious;
+    pxHead->pxPrevious->pxNext = pxLink;
+    pxHead->pxPrevious = pxLink;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLinkWaiter( IndexedEventGroup_t * pxGroup,
+                           IndexedEventGroupWaiter_t * pxWaiter )
+{
+    EventBits_t uxBitsToLink = pxWaiter->uxBitsToWaitFor;
+    UBaseType_t uxBit;
+
+    /* A task waiting for all bits only needs to be looked at when the
+     * lowest bit it does not have yet is set. */
+    if( pxWaiter->xWaitForAllBits != pdFALSE )
+    {
+        uxBitsToLink &= ~( pxGroup->uxBits );
+    }
+
+    for( uxBit = 0; uxBit < iegBITS; uxBit++ )
+    {
+        if( ( uxBitsToLink & ( ( EventBits_t ) 1U << uxBit ) ) != 0U )
+        {
+            prvLinkWaiterToBit( pxGroup, pxWaiter, uxBit );
+
+            if( pxWaiter->xWaitForAllBits != pdFALSE )
+            {
+                break;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlinkWaiter( IndexedEventGroupWaiter_t * pxWaiter )
+{
+    IndexedEventGroupLink_t * pxLink;
+    UBaseType_t uxBit;
+
+    for( uxBit = 0; uxBit < iegBITS; uxBit++ )
+    {
+        pxLink = &( pxWaiter->xLinks[ uxBit ] );
+
+        if( pxLink->pxNext != NULL )
+        {
+            pxLink->pxPrevious->pxNext = pxLink->pxNext;
+            pxLink->pxNext->pxPrevious = pxLink->pxPrevious;
+            pxLink->pxNext = NULL;
+            pxLink->pxPrevious = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetBits( IndexedEventGroup_t * pxGroup,
+                        EventBits_t uxBitsToSet,
+                        BaseType_t xFromISR,
+                        BaseType_t * pxHigherPriorityTaskWoken )
+{
+    IndexedEventGroupLink_t * pxHead, * pxLink, * pxNext;
+    IndexedEventGroupWaiter_t * pxWaiter;
+    EventBits_t uxBitsToClear = 0;
+    UBaseType_t uxBit;
+
+    pxGroup->uxBits |= uxBitsToSet;
+
+    for( uxBit = 0; uxBit < iegBITS; uxBit++ )
+    {
+        if( ( uxBitsToSet & ( ( EventBits_t ) 1U << uxBit ) ) == 0U )
+        {
+            continue;
+        }
+
+        pxHead = &( pxGroup->xWaiters[ uxBit ] );
+
+        for( pxLink = pxHead->pxNext; pxLink != pxHead; pxLink = pxNext )
+        {
+            pxNext = pxLink->pxNext;
+            pxWaiter = ( IndexedEventGroupWaiter_t * ) pxLink->pvWaiter;
+
+            if( prvWaitConditionMet( pxGroup->uxBits, pxWaiter->uxBitsToWaitFor, pxWaiter->xWaitForAllBits ) == pdFALSE )
+            {
+                /* Only a task waiting for all bits can be in the list of a
+                 * bit being set and not be woken.  Move it to a bit it still
+                 * needs, which is not being set so is not walked below. */
+                prvUnlinkWaiter( pxWaiter );
+                prvLinkWaiter( pxGroup, pxWaiter );
+            }
+            else
+            {
+                /* Unlinking may also remove the waiter's link to a later bit,
+                 * but never pxNext, which belongs to another waiter. */
+                prvUnlinkWaiter( pxWaiter );
+                pxWaiter->xWoken = pdTRUE;
+                pxWaiter->uxBitsWhenWoken = pxGroup->uxBits;
+
+                /* As with a kernel event group, the bits are cleared once
+                 * every waiting task has been looked at. */
+                if( pxWaiter->xClearOnExit != pdFALSE )
+                {
+                    uxBitsToClear |= pxWaiter->uxBitsToWaitFor;
+                }
+
+                if( xFromISR != pdFALSE )
+                {
+                    vTaskNotifyGiveIndexedFromISR( pxWaiter->xTask, iegNOTIFICATION_INDEX, pxHigherPriorityTaskWoken );
+                }
+                else
+                {
+                    ( void ) xTaskNotifyGiveIndexed( pxWaiter->xTask, iegNOTIFICATION_INDEX );
+                }
+            }
+        }
+    }
+
+    pxGroup->uxBits &= ~uxBitsToClear;
+}
+/*-----------------------------------------------------------*/
+
+void vIndexedEventGroupInitialise( IndexedEventGroup_t * pxGroup )
+{
+    UBaseType_t uxBit;
+
+    pxGroup->uxBits = 0;
+
+    for( uxBit = 0; uxBit < iegBITS; uxBit++ )
+    {
+        pxGroup->xWaiters[ uxBit ].pxNext = &( pxGroup->xWaiters[ uxBit ] );
+        pxGroup->xWaiters[ uxBit ].pxPrevious = &( pxGroup->xWaiters[ uxBit ] );
+        pxGroup->xWaiters[ uxBit ].pvWaiter = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xIndexedEventGroupWaitBits( IndexedEventGroup_t * pxGroup,
+                                        const EventBits_t uxBitsToWaitFor,
+                                        const BaseType_t xClearOnExit,
+                                        const BaseType_t xWaitForAllBits,
+                                        TickType_t xTicksToWait )
+{
+    IndexedEventGroupWaiter_t xWaiter;
+    EventBits_t uxReturn;
+    BaseType_t xDone = pdFALSE;
+    TimeOut_t xTimeOut;
+    UBaseType_t uxBit;
+
+    configASSERT( uxBitsToWaitFor != 0U );
+    configASSERT( ( uxBitsToWaitFor & ~iegALL_BITS ) == 0U );
+
+    xWaiter.xTask = xTaskGetCurrentTaskHandle();
+    xWaiter.uxBitsToWaitFor = uxBitsToWaitFor;
+    xWaiter.xClearOnExit = xClearOnExit;
+    xWaiter.xWaitForAllBits = xWaitForAllBits;
+    xWaiter.xWoken = pdFALSE;
+    xWaiter.uxBitsWhenWoken = 0;
+
+    for( uxBit = 0; uxBit < iegBITS; uxBit++ )
+    {
+        xWaiter.xLinks[ uxBit ].pxNext = NULL;
+        xWaiter.xLinks[ uxBit ].pxPrevious = NULL;
+        xWaiter.xLinks[ uxBit ].pvWaiter = &xWaiter;
+    }
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    taskENTER_CRITICAL();
+    {
+        uxReturn = pxGroup->uxBits;
+
+        if( prvWaitConditionMet( uxReturn, uxBitsToWaitFor, xWaitForAllBits ) != pdFALSE )
+        {
+            if( xClearOnExit != pdFALSE )
+            {
+                pxGroup->uxBits &= ~uxBitsToWaitFor;
+            }
+
+            xDone = pdTRUE;
+        }
+        else if( xTicksToWait == 0U )
+        {
+            xDone = pdTRUE;
+        }
+        else
+        {
+            /* A notification left from an earlier wait would only cause an
+             * extra pass round the loop below, but is cleared anyway. */
+            ( void ) ulTaskNotifyValueClearIndexed( NULL, iegNOTIFICATION_INDEX, 0xFFFFFFFFUL );
+            prvLinkWaiter( pxGroup, &xWaiter );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    while( xDone == pdFALSE )
+    {
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+        {
+            ( void ) ulTaskNotifyTakeIndexed( iegNOTIFICATION_INDEX, pdTRUE, xTicksToWait );
+        }
+        else
+        {
+            xTicksToWait = 0;
+        }
+
+        taskENTER_CRITICAL();
+        {
+            if( xWaiter.xWoken != pdFALSE )
+            {
+                uxReturn = xWaiter.uxBitsWhenWoken;
+                xDone = pdTRUE;
+            }
+            else if( xTicksToWait == 0U )
+            {
+                /* Timed out, so return the bits as they are now, which do not
+                 * meet the condition. */
+                prvUnlinkWaiter( &xWaiter );
+                uxReturn = pxGroup->uxBits;
+                xDone = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xIndexedEventGroupSetBits( IndexedEventGroup_t * pxGroup,
+                                       const EventBits_t uxBitsToSet )
+{
+    EventBits_t uxReturn;
+
+    taskENTER_CRITICAL();
+    {
+        prvSetBits( pxGroup, uxBitsToSet, pdFALSE, NULL );
+        uxReturn = pxGroup->uxBits;
+    }
+    taskEXIT_CRITICAL();
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xIndexedEventGroupSetBitsFromISR( IndexedEventGroup_t * pxGroup,
+                                              const EventBits_t uxBitsToSet,
+                                              BaseType_t * pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxSavedInterruptStatus;
+    EventBits_t uxReturn;
+
+    uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+    {
+        prvSetBits( pxGroup, uxBitsToSet, pdTRUE, pxHigherPriorityTaskWoken );
+        uxReturn = pxGroup->uxBits;
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xIndexedEventGroupClearBits( IndexedEventGroup_t * pxGroup,
+                                         const EventBits_t uxBitsToClear )
+{
+    EventBits_t uxReturn;
+
+    taskENTER_CRITICAL();
+    {
+        uxReturn = pxGroup->uxBits;
+        pxGroup->uxBits &= ~uxBitsToClear;
+    }
+    taskEXIT_CRITICAL();
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xIndexedEventGroupGetBits( IndexedEventGroup_t * pxGroup )
+{
+    EventBits_t uxReturn;
+
+    taskENTER_CRITICAL();
+    {
+        uxReturn = pxGroup->uxBits;
+    }
+    taskEXIT_CRITICAL();
+
+    return uxReturn;
+}
+/*-----------------------------------------------------------*/
@@ -46,6 +46,7 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
+#include "semphr.h"
 
 /* Demo app includes. */
 #include "IntQueue.h"
@@ -55,12 +56,39 @@
     #error INCLUDE_eTaskGetState must be set to 1 in FreeRTOSConfig.h to use this demo file.
 #endif
 
-/* Priorities used by test tasks. */
+/* Priorities used by test tasks.  The latency task must run above every
+ * other task, including the lower priority tasks while they temporarily run at
+ * intqHIGHER_PRIORITY + 1, or it is not woken straight away. */
+#if ( intqLATENCY_TEST == 1 )
+    #ifndef intqHIGHER_PRIORITY
+        #define intqHIGHER_PRIORITY      ( configMAX_PRIORITIES - 3 )
+    #endif
+    #define intqLATENCY_PRIORITY         ( configMAX_PRIORITIES - 1 )
+
+    #if ( ( intqHIGHER_PRIORITY + 1 ) >= intqLATENCY_PRIORITY )
+        #error intqHIGHER_PRIORITY must be below configMAX_PRIORITIES - 2 when intqLATENCY_TEST is 1.
+    #endif
+#endif
+
 #ifndef intqHIGHER_PRIORITY
     #define intqHIGHER_PRIORITY          ( configMAX_PRIORITIES - 2 )
 #endif
 #define intqLOWER_PRIORITY               ( tskIDLE_PRIORITY )
 
+#if ( intqLATENCY_TEST == 1 )
+    #ifndef intqLATENCY_GET_COUNT
+        #ifndef portGET_RUN_TIME_COUNTER_VALUE
+            #error Define intqLATENCY_GET_COUNT() to read a free running counter, or configGENERATE_RUN_TIME_STATS, when intqLATENCY_TEST is 1.
+        #endif
+        #define intqLATENCY_GET_COUNT()    ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+    #endif
+
+/* The object the latency task is blocked on, if any. */
+    #define intqLATENCY_WAIT_NONE         ( ( UBaseType_t ) 0 )
+    #define intqLATENCY_WAIT_QUEUE        ( ( UBaseType_t ) 1 )
+    #define intqLATENCY_WAIT_SEMAPHORE    ( ( UBaseType_t ) 2 )
+#endif
+
 /* The number of values to send/receive before checking that all values were
  * processed as expected. */
 #define intqNUM_VALUES_TO_LOG            ( 200 )
@@ -178,6 +206,45 @@ TaskHandle_t xHighPriorityNormallyEmptyTask1, xHighPriorityNormallyEmptyTask2, x
 static uint8_t ucNormallyEmptyReceivedValues[ intqNUM_VALUES_TO_LOG ] = { 0 };
 static uint8_t ucNormallyFullReceivedValues[ intqNUM_VALUES_TO_LOG ] = { 0 };
 
+#if ( intqLATENCY_TEST == 1 )
+
+/* The times sent to the latency task through xLatencyQueue. */
+    typedef struct IntQueueLatencySample
+    {
+        uint32_t ulEntryCount;
+        uint32_t ulSendCount;
+    } IntQueueLatencySample_t;
+
+/* The latency task blocks on these in turn. */
+    static QueueHandle_t xLatencyQueue;
+    static SemaphoreHandle_t xLatencySemaphore;
+
+/* Set by the latency task before it blocks, and cleared by the interrupt when it
+ * wakes the task. */
+    static volatile UBaseType_t uxLatencyWait = intqLATENCY_WAIT_NONE;
+
+/* A semaphore carries no data, so the interrupt leaves its times here. */
+    static volatile uint32_t ulSemaphoreEntryCount = 0, ulSemaphoreGiveCount = 0;
+
+/* The results, and the totals from which the averages are calculated. */
+    static IntQueueLatency_t xLatency;
+    static uint64_t ullLatencyTotals[ sizeof( IntQueueLatency_t ) / sizeof( IntQueueLatencyStats_t ) ];
+
+/* Used to detect a stall in the latency task. */
+    static volatile UBaseType_t uxLatencyLoops = 0;
+
+/* Wakes the latency task from xFirstTimerHandler(). */
+    static void prvLatencyGiveFromISR( uint32_t ulEntryCount,
+                                       BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Adds one latency to the statistics. */
+    static void prvRecordLatency( IntQueueLatencyStats_t * pxStats,
+                                  uint32_t ulLatency );
+
+/* Measures the time to wake from the queue and from the semaphore in turn. */
+    static void prvLatencyTask( void * pvParameters );
+#endif /* intqLATENCY_TEST */
+
 /* The test tasks themselves. */
 static void prvLowerPriorityNormallyEmptyTask( void * pvParameters );
 static void prvLowerPriorityNormallyFullTask( void * pvParameters );
@@ -220,6 +287,18 @@ void vStartInterruptQueueTasks( void )
      * defined to be less than 1. */
     vQueueAddToRegistry( xNormallyFullQueue, "NormallyFull" );
     vQueueAddToRegistry( xNormallyEmptyQueue, "NormallyEmpty" );
+
+    #if ( intqLATENCY_TEST == 1 )
+    {
+        xLatencyQueue = xQueueCreate( 1, ( UBaseType_t ) sizeof( IntQueueLatencySample_t ) );
+        xLatencySemaphore = xSemaphoreCreateBinary();
+        configASSERT( xLatencyQueue );
+        configASSERT( xLatencySemaphore );
+        vQueueAddToRegistry( xLatencyQueue, "Latency" );
+
+        xTaskCreate( prvLatencyTask, "IntLat", configMINIMAL_STACK_SIZE, NULL, intqLATENCY_PRIORITY, NULL );
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -644,6 +723,14 @@ BaseType_t xFirstTimerHandler( void )
     UBaseType_t uxRxedValue;
     static UBaseType_t uxNextOperation = 0;
 
+    #if ( intqLATENCY_TEST == 1 )
+    {
+        /* Read the counter first, as this is as close to the entry to the
+         * interrupt as common code can get. */
+        prvLatencyGiveFromISR( intqLATENCY_GET_COUNT(), &xHigherPriorityTaskWoken );
+    }
+    #endif
+
     /* Called from a timer interrupt.  Perform various read and write
      * accesses on the queues. */
 
@@ -737,5 +824,158 @@ BaseType_t xAreIntQueueTasksStillRunning( void )
 
     uxLastLowPriorityLoops2 = uxLowPriorityLoops2;
 
+    #if ( intqLATENCY_TEST == 1 )
+    {
+        static UBaseType_t uxLastLatencyLoops = 0;
+
+        if( uxLatencyLoops == uxLastLatencyLoops )
+        {
+            /* The latency task has stalled. */
+            prvQueueAccessLogError( __LINE__ );
+        }
+
+        uxLastLatencyLoops = uxLatencyLoops;
+    }
+    #endif
+
     return xErrorStatus;
 }
+/*-----------------------------------------------------------*/
+
+#if ( intqLATENCY_TEST == 1 )
+
+    static void prvLatencyGiveFromISR( uint32_t ulEntryCount,
+                                       BaseType_t * pxHigherPriorityTaskWoken )
+    {
+        static BaseType_t xArmed = pdFALSE;
+        IntQueueLatencySample_t xSample;
+
+        if( uxLatencyWait == intqLATENCY_WAIT_NONE )
+        {
+            xArmed = pdFALSE;
+        }
+        else if( xArmed == pdFALSE )
+        {
+            /* The task sets uxLatencyWait just before it blocks, so wait for the
+             * next interrupt to be sure it is blocked and only the wake is
+             * measured. */
+            xArmed = pdTRUE;
+        }
+        else
+        {
+            xArmed = pdFALSE;
+
+            if( uxLatencyWait == intqLATENCY_WAIT_QUEUE )
+            {
+                uxLatencyWait = intqLATENCY_WAIT_NONE;
+                xSample.ulEntryCount = ulEntryCount;
+                xSample.ulSendCount = intqLATENCY_GET_COUNT();
+
+                if( xQueueSendFromISR( xLatencyQueue, &xSample, pxHigherPriorityTaskWoken ) != pdPASS )
+                {
+                    prvQueueAccessLogError( __LINE__ );
+                }
+            }
+            else
+            {
+                uxLatencyWait = intqLATENCY_WAIT_NONE;
+                ulSemaphoreEntryCount = ulEntryCount;
+                ulSemaphoreGiveCount = intqLATENCY_GET_COUNT();
+
+                if( xSemaphoreGiveFromISR( xLatencySemaphore, pxHigherPriorityTaskWoken ) != pdPASS )
+                {
+                    prvQueueAccessLogError( __LINE__ );
+                }
+            }
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvRecordLatency( IntQueueLatencyStats_t * pxStats,
+                                  uint32_t ulLatency )
+    {
+        UBaseType_t uxBin = 0;
+        uint32_t ulRemaining = ulLatency;
+
+        if( ( pxStats->ulSamples == 0 ) || ( ulLatency < pxStats->ulMin ) )
+        {
+            pxStats->ulMin = ulLatency;
+        }
+
+        if( ulLatency > pxStats->ulMax )
+        {
+            pxStats->ulMax = ulLatency;
+        }
+
+        ullLatencyTotals[ pxStats - &( xLatency.xQueueEntryToSend ) ] += ulLatency;
+        pxStats->ulSamples++;
+
+        while( ( ulRemaining != 0 ) && ( uxBin < ( UBaseType_t ) ( intqLATENCY_HISTOGRAM_BINS - 1 ) ) )
+        {
+            ulRemaining >>= 1;
+            uxBin++;
+        }
+
+        pxStats->ulHistogram[ uxBin ]++;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvLatencyTask( void * pvParameters )
+    {
+        IntQueueLatencySample_t xSample;
+        uint32_t ulWakeCount;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            uxLatencyWait = intqLATENCY_WAIT_QUEUE;
+
+            if( xQueueReceive( xLatencyQueue, &xSample, portMAX_DELAY ) == pdPASS )
+            {
+                ulWakeCount = intqLATENCY_GET_COUNT();
+
+                prvRecordLatency( &( xLatency.xQueueEntryToSend ), xSample.ulSendCount - xSample.ulEntryCount );
+                prvRecordLatency( &( xLatency.xQueueSendToWake ), ulWakeCount - xSample.ulSendCount );
+                prvRecordLatency( &( xLatency.xQueueEntryToWake ), ulWakeCount - xSample.ulEntryCount );
+            }
+
+            uxLatencyWait = intqLATENCY_WAIT_SEMAPHORE;
+
+            if( xSemaphoreTake( xLatencySemaphore, portMAX_DELAY ) == pdPASS )
+            {
+                ulWakeCount = intqLATENCY_GET_COUNT();
+
+                prvRecordLatency( &( xLatency.xSemaphoreEntryToGive ), ulSemaphoreGiveCount - ulSemaphoreEntryCount );
+                prvRecordLatency( &( xLatency.xSemaphoreGiveToWake ), ulWakeCount - ulSemaphoreGiveCount );
+                prvRecordLatency( &( xLatency.xSemaphoreEntryToWake ), ulWakeCount - ulSemaphoreEntryCount );
+            }
+
+            uxLatencyLoops++;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vGetIntQueueLatency( IntQueueLatency_t * pxLatency )
+    {
+        IntQueueLatencyStats_t * pxStats = &( pxLatency->xQueueEntryToSend );
+        UBaseType_t ux;
+
+        /* The latency task runs at the highest priority, so stop it updating
+         * the results part way through the copy. */
+        vTaskSuspendAll();
+        {
+            memcpy( pxLatency, &xLatency, sizeof( xLatency ) );
+
+            for( ux = 0; ux < ( UBaseType_t ) ( sizeof( ullLatencyTotals ) / sizeof( ullLatencyTotals[ 0 ] ) ); ux++ )
+            {
+                if( pxStats[ ux ].ulSamples != 0 )
+                {
+                    pxStats[ ux ].ulAverage = ( uint32_t ) ( ullLatencyTotals[ ux ] / pxStats[ ux ].ulSamples );
+                }
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+
+#endif /* intqLATENCY_TEST */
@@ -0,0 +1,360 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures the tickless idle implementation of a low power demo.  The low
+ * power tick management of the demo calls lpbSLEEP_ENTER() and lpbSLEEP_EXIT()
+ * around the instruction that sleeps, giving the depth it is entering, and
+ * lpbTICKS_SLEPT() with the tick periods the sleep lasted.  The demo should
+ * run no task other than the benchmark task, which:
+ *
+ * 1) Blocks for each of the lpbWAKE_DELAYS tick counts lpbWAKE_ROUNDS times,
+ *    and times from the sleep ending to the task running again.  The latency
+ *    is recorded against the depth the sleep was in.  It only covers the
+ *    software wake path - restarting the clocks, stepping the tick count and
+ *    switching to the task - as the time the hardware takes to leave the
+ *    depth passes before lpbSLEEP_EXIT() can read the time.  Add the wake up
+ *    time from the data sheet for the total.
+ *
+ * 2) Runs an event load for lpbLOAD_SECONDS seconds: lpbLOAD_EVENTS_PER_SECOND
+ *    times a second it wakes and executes lpbLOAD_EVENT_TIME counts of work,
+ *    sleeping in between.  It reports the percentage of the load the MCU
+ *    spent in a low power state, and how the sleeping was split between the
+ *    depths.
+ *
+ * 3) If the demo defines lpbGET_REFERENCE_MS() to read a clock that keeps
+ *    running through every sleep depth and is independent of the tick, such
+ *    as a calendar RTC, blocks for lpbDRIFT_SLEEP_MS lpbDRIFT_ROUNDS times
+ *    and reports how far the tick count drifted from the reference.  The
+ *    drift is the error that builds up each time the tick count is stepped
+ *    over a sleep.
+ *
+ * The results are not printed, as the low power demos have no console.  View
+ * them in the debugger once xComplete is pdTRUE.  Times are read with
+ * lpbGET_TIME(), which defaults to the DWT cycle counter of ARMv7-M parts.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "LowPowerBenchmark.h"
+
+#if ( configUSE_LOW_POWER_BENCHMARK == 1 )
+
+#if ( configUSE_TICKLESS_IDLE == 0 )
+    #error LowPowerBenchmark.c requires configUSE_TICKLESS_IDLE to be enabled
+#endif
+
+#ifndef lpbGET_TIME
+    #define lpbDWT_CYCCNT          ( *( ( volatile uint32_t * ) 0xE0001004UL ) )
+    #define lpbDWT_CTRL            ( *( ( volatile uint32_t * ) 0xE0001000UL ) )
+    #define lpbDEMCR               ( *( ( volatile uint32_t * ) 0xE000EDFCUL ) )
+    #define lpbDEMCR_TRCENA        ( 1UL << 24UL )
+    #define lpbDWT_CYCCNTENA       ( 1UL << 0UL )
+
+    #define lpbINIT_TIME()                   \
+    {                                        \
+        lpbDEMCR |= lpbDEMCR_TRCENA;         \
+        lpbDWT_CYCCNT = 0UL;                 \
+        lpbDWT_CTRL |= lpbDWT_CYCCNTENA;     \
+    }
+    #define lpbGET_TIME()          ( lpbDWT_CYCCNT )
+#endif
+
+#ifndef lpbINIT_TIME
+    #define lpbINIT_TIME()
+#endif
+
+/* The tick counts blocked for when timing wake ups.  Choose them so every
+ * depth the demo selects by the expected idle time is reached. */
+#ifndef lpbWAKE_DELAYS
+    #define lpbWAKE_DELAYS         { pdMS_TO_TICKS( 50UL ), pdMS_TO_TICKS( 500UL ), pdMS_TO_TICKS( 2000UL ) }
+#endif
+
+#ifndef lpbWAKE_ROUNDS
+    #define lpbWAKE_ROUNDS         ( 8 )
+#endif
+
+#ifndef lpbLOAD_EVENTS_PER_SECOND
+    #define lpbLOAD_EVENTS_PER_SECOND    ( 10UL )
+#endif
+
+/* The work done for each event, in counts of lpbGET_TIME(). */
+#ifndef lpbLOAD_EVENT_TIME
+    #define lpbLOAD_EVENT_TIME     ( configCPU_CLOCK_HZ / 1000UL )
+#endif
+
+#ifndef lpbLOAD_SECONDS
+    #define lpbLOAD_SECONDS        ( 10UL )
+#endif
+
+#ifndef lpbDRIFT_SLEEP_MS
+    #define lpbDRIFT_SLEEP_MS      ( 10000UL )
+#endif
+
+#ifndef lpbDRIFT_ROUNDS
+    #define lpbDRIFT_ROUNDS        ( 3 )
+#endif
+
+#ifndef lpbSTACK_SIZE
+    #define lpbSTACK_SIZE          ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#define lpbARRAY_LENGTH( x )       ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The benchmark task, which runs the phases described at the top of this
+ * file once and then deletes itself.
+ */
+static void prvLowPowerBenchmarkTask( void * pvParameters );
+
+/*
+ * The phases.
+ */
+static void prvTimeWakeUps( void );
+static void prvRunEventLoad( void );
+static void prvMeasureDrift( void );
+
+/*-----------------------------------------------------------*/
+
+static LowPowerBenchmarkResults_t xResults;
+
+/* Written by the hooks, which run with interrupts disabled. */
+static volatile UBaseType_t uxSleepDepth = 0;
+static volatile uint32_t ulWakeTime = 0;
+static volatile uint32_t ulWakeUps = 0;
+static volatile uint32_t ulTicksAsleep[ lpbSLEEP_DEPTHS ] = { 0 };
+
+/* The sum of the wake latencies of each depth, to average. */
+static uint32_t ulLatencySums[ lpbSLEEP_DEPTHS ] = { 0 };
+
+/*-----------------------------------------------------------*/
+
+void vStartLowPowerBenchmark( UBaseType_t uxPriority )
+{
+    xTaskCreate( prvLowPowerBenchmarkTask, "LPBench", lpbSTACK_SIZE, NULL, uxPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+const LowPowerBenchmarkResults_t * pxGetLowPowerBenchmarkResults( void )
+{
+    return &xResults;
+}
+/*-----------------------------------------------------------*/
+
+void vLowPowerBenchmarkSleepEnter( UBaseType_t uxDepth )
+{
+    if( uxDepth >= lpbSLEEP_DEPTHS )
+    {
+        uxDepth = lpbSLEEP_DEPTHS - 1;
+    }
+
+    uxSleepDepth = uxDepth;
+    xResults.xDepths[ uxDepth ].ulSleeps++;
+}
+/*-----------------------------------------------------------*/
+
+void vLowPowerBenchmarkSleepExit( void )
+{
+    ulWakeTime = lpbGET_TIME();
+    ulWakeUps++;
+}
+/*-----------------------------------------------------------*/
+
+void vLowPowerBenchmarkTicksSlept( TickType_t xTicks )
+{
+    ulTicksAsleep[ uxSleepDepth ] += ( uint32_t ) xTicks;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLowPowerBenchmarkTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    lpbINIT_TIME();
+
+    prvTimeWakeUps();
+    prvRunEventLoad();
+    prvMeasureDrift();
+
+    xResults.xComplete = pdTRUE;
+
+    /* Nothing is left to run, so from here the demo sleeps as deeply as it
+     * can. */
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimeWakeUps( void )
+{
+    static const TickType_t xDelays[] = lpbWAKE_DELAYS;
+    LowPowerBenchmarkDepth_t * pxDepth;
+    uint32_t ulWakeUpsBefore, ulNow, ulLatency;
+    UBaseType_t uxDelay, uxRound, uxDepth;
+
+    for( uxDelay = 0; uxDelay < lpbARRAY_LENGTH( xDelays ); uxDelay++ )
+    {
+        for( uxRound = 0; uxRound < lpbWAKE_ROUNDS; uxRound++ )
+        {
+            ulWakeUpsBefore = ulWakeUps;
+            vTaskDelay( xDelays[ uxDelay ] );
+            ulNow = lpbGET_TIME();
+
+            /* Only a single sleep that ended with this task being unblocked
+             * is timed.  If the delay was too short to sleep, or another
+             * interrupt ended the first sleep early, the latency would not be
+             * that of the sleep that woke the task. */
+            taskENTER_CRITICAL();
+            {
+                if( ulWakeUps == ( ulWakeUpsBefore + 1UL ) )
+                {
+                    uxDepth = uxSleepDepth;
+                    ulLatency = ulNow - ulWakeTime;
+                }
+                else
+                {
+                    uxDepth = lpbSLEEP_DEPTHS;
+                    ulLatency = 0;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( uxDepth < lpbSLEEP_DEPTHS )
+            {
+                pxDepth = &( xResults.xDepths[ uxDepth ] );
+                pxDepth->ulWakeUpsTimed++;
+                ulLatencySums[ uxDepth ] += ulLatency;
+                pxDepth->ulAverageWakeLatency = ulLatencySums[ uxDepth ] / pxDepth->ulWakeUpsTimed;
+
+                if( ulLatency > pxDepth->ulMaxWakeLatency )
+                {
+                    pxDepth->ulMaxWakeLatency = ulLatency;
+                }
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunEventLoad( void )
+{
+    const TickType_t xPeriod = pdMS_TO_TICKS( 1000UL / lpbLOAD_EVENTS_PER_SECOND );
+    const uint32_t ulEvents = lpbLOAD_EVENTS_PER_SECOND * lpbLOAD_SECONDS;
+    uint32_t ulTicksBefore[ lpbSLEEP_DEPTHS ], ulEvent, ulStart, ulAsleep = 0;
+    TickType_t xLastWake, xStart;
+    UBaseType_t uxDepth;
+
+    /* Start on a tick boundary, so the first period is whole. */
+    vTaskDelay( 1 );
+
+    taskENTER_CRITICAL();
+    {
+        for( uxDepth = 0; uxDepth < lpbSLEEP_DEPTHS; uxDepth++ )
+        {
+            ulTicksBefore[ uxDepth ] = ulTicksAsleep[ uxDepth ];
+        }
+
+        xStart = xTaskGetTickCount();
+    }
+    taskEXIT_CRITICAL();
+
+    xLastWake = xStart;
+
+    for( ulEvent = 0; ulEvent < ulEvents; ulEvent++ )
+    {
+        vTaskDelayUntil( &xLastWake, xPeriod );
+
+        ulStart = lpbGET_TIME();
+
+        while( ( lpbGET_TIME() - ulStart ) < ( uint32_t ) lpbLOAD_EVENT_TIME )
+        {
+        }
+    }
+
+    taskENTER_CRITICAL();
+    {
+        xResults.xLoadTicks = xTaskGetTickCount() - xStart;
+
+        for( uxDepth = 0; uxDepth < lpbSLEEP_DEPTHS; uxDepth++ )
+        {
+            xResults.xDepths[ uxDepth ].ulLoadTicksAsleep = ulTicksAsleep[ uxDepth ] - ulTicksBefore[ uxDepth ];
+            ulAsleep += xResults.xDepths[ uxDepth ].ulLoadTicksAsleep;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xResults.xLoadTicks != 0 )
+    {
+        xResults.ulLowPowerPercent = ( ulAsleep * 100UL ) / ( uint32_t ) xResults.xLoadTicks;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureDrift( void )
+{
+    #ifdef lpbGET_REFERENCE_MS
+        TickType_t xTickBefore, xTickAfter;
+        uint32_t ulReferenceBefore, ulReferenceAfter;
+        int32_t lDrift;
+        UBaseType_t uxRound;
+
+        for( uxRound = 0; uxRound < lpbDRIFT_ROUNDS; uxRound++ )
+        {
+            taskENTER_CRITICAL();
+            {
+                xTickBefore = xTaskGetTickCount();
+                ulReferenceBefore = ( uint32_t ) lpbGET_REFERENCE_MS();
+            }
+            taskEXIT_CRITICAL();
+
+            vTaskDelay( pdMS_TO_TICKS( lpbDRIFT_SLEEP_MS ) );
+
+            taskENTER_CRITICAL();
+            {
+                xTickAfter = xTaskGetTickCount();
+                ulReferenceAfter = ( uint32_t ) lpbGET_REFERENCE_MS();
+            }
+            taskEXIT_CRITICAL();
+
+            lDrift = ( int32_t ) ( ( ( uint32_t ) ( xTickAfter - xTickBefore ) * portTICK_PERIOD_MS ) - ( ulReferenceAfter - ulReferenceBefore ) );
+
+            xResults.ulDriftSleeps++;
+            xResults.lTotalDriftMs += lDrift;
+
+            if( ( lDrift < 0 ? -lDrift : lDrift ) > ( xResults.lMaxDriftMs < 0 ? -xResults.lMaxDriftMs : xResults.lMaxDriftMs ) )
+            {
+                xResults.lMaxDriftMs = lDrift;
+            }
+        }
+    #endif /* lpbGET_REFERENCE_MS */
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_LOW_POWER_BENCHMARK */
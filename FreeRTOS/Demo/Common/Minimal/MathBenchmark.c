@@ -0,0 +1,629 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A compute benchmark built from the kind of kernels DSP code spends its time
+ * in - dot products and FIR filters - in 32-bit float and in Q15 fixed point.
+ * flop.c, sp_flop.c and integer.c check that arithmetic survives context
+ * switches; this file measures what running such code under the scheduler
+ * costs, with and without vector registers in the task context.
+ *
+ * Each kernel is vectorised with Helium (MVE) or Neon intrinsics when the
+ * compiler targets them, and the Q15 kernels use the DSP extension dual 16-bit
+ * multiply accumulate on cores that have that but no vector unit.  The
+ * "scalar" Q15 kernels are always plain C, compiled without auto
+ * vectorisation, so a task that runs only those never touches the floating
+ * point / vector register file.  On ports with lazy stacking the kernel then
+ * never saves those registers for it, which is what the comparison shows.
+ *
+ * Every kernel is run in three ways, each for mathbWINDOW_TICKS:
+ *  - by one task, which gives the raw rate;
+ *  - by mathbTASKS tasks of equal priority that are time sliced on the tick;
+ *  - by mathbTASKS tasks that yield after every call, so every call ends in a
+ *    context switch to another task that holds the same kind of context.
+ * The rates are reported as thousands of operations per second, where an
+ * operation is one multiply or one add, so for the float kernels they are
+ * kFLOPS.  The extra time each call takes when it ends in a yield is reported
+ * as the cost of a context switch, in nanoseconds.
+ *
+ * As in flop.c, every task checks each result against the first one it
+ * computed, so a corrupted context shows as a mismatch.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "MathBenchmark.h"
+
+#if defined( __ARM_FEATURE_MVE ) && ( ( __ARM_FEATURE_MVE & 2 ) != 0 )
+    #include <arm_mve.h>
+    #define mathbVECTOR_NAME    "helium"
+    #define mathbUSE_MVE        1
+#elif defined( __ARM_NEON )
+    #include <arm_neon.h>
+    #define mathbVECTOR_NAME    "neon"
+    #define mathbUSE_NEON       1
+#elif defined( __ARM_FEATURE_SIMD32 )
+    #include <arm_acle.h>
+    #define mathbVECTOR_NAME    "dsp"
+    #define mathbUSE_DSP        1
+#else
+    #define mathbVECTOR_NAME    "c"
+#endif
+
+#ifndef mathbUSE_MVE
+    #define mathbUSE_MVE        0
+#endif
+#ifndef mathbUSE_NEON
+    #define mathbUSE_NEON       0
+#endif
+#ifndef mathbUSE_DSP
+    #define mathbUSE_DSP        0
+#endif
+
+/* Keeps the scalar kernels scalar at high optimisation levels. */
+#if defined( __clang__ )
+    #define mathbSCALAR_FUNCTION
+    #define mathbSCALAR_LOOP    _Pragma( "clang loop vectorize(disable) interleave(disable)" )
+#elif defined( __GNUC__ )
+    #define mathbSCALAR_FUNCTION    __attribute__( ( optimize( "no-tree-vectorize" ) ) )
+    #define mathbSCALAR_LOOP
+#else
+    #define mathbSCALAR_FUNCTION
+    #define mathbSCALAR_LOOP
+#endif
+
+/* The number of tasks that share the processor. */
+#ifndef mathbTASKS
+    #define mathbTASKS            ( 4 )
+#endif
+
+/* How long each kernel is run for in each way. */
+#ifndef mathbWINDOW_TICKS
+    #define mathbWINDOW_TICKS     pdMS_TO_TICKS( 500 )
+#endif
+
+#ifndef mathbSTACK_SIZE
+    #define mathbSTACK_SIZE       ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* The dot product length, and the filter length and block size.  All must be
+ * multiples of 8. */
+#define mathbDOT_LENGTH           ( 256 )
+#define mathbFIR_TAPS             ( 32 )
+#define mathbFIR_BLOCK            ( 64 )
+
+#define mathbWORKER_PRIORITY      ( tskIDLE_PRIORITY + 1 )
+#define mathbCONTROL_PRIORITY     ( tskIDLE_PRIORITY + 2 )
+
+#define mathbARRAY_LENGTH( x )    ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* One kernel.  xKernel() returns a checksum of its result. */
+typedef struct MathKernel
+{
+    const char * pcName;
+    BaseType_t xUsesVectorRegisters;
+    uint32_t ulOpsPerCall;
+    uint32_t ( * xKernel )( UBaseType_t uxTask );
+} MathKernel_t;
+
+/* The state of a worker task. */
+typedef struct MathWorker
+{
+    TaskHandle_t xHandle;
+    volatile uint32_t ulCalls;
+    uint32_t ulFirstChecksum;
+    BaseType_t xMismatch;
+} MathWorker_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Dot products of length ulLength, and the kernels built on them.
+ */
+static float prvDotF32( const float * pfA,
+                        const float * pfB,
+                        uint32_t ulLength );
+static int32_t prvDotQ15( const int16_t * psA,
+                          const int16_t * psB,
+                          uint32_t ulLength );
+static int32_t prvDotQ15Scalar( const int16_t * psA,
+                                const int16_t * psB,
+                                uint32_t ulLength );
+
+static uint32_t prvKernelDotF32( UBaseType_t uxTask );
+static uint32_t prvKernelFirF32( UBaseType_t uxTask );
+static uint32_t prvKernelDotQ15( UBaseType_t uxTask );
+static uint32_t prvKernelFirQ15( UBaseType_t uxTask );
+static uint32_t prvKernelDotQ15Scalar( UBaseType_t uxTask );
+static uint32_t prvKernelFirQ15Scalar( UBaseType_t uxTask );
+
+/*
+ * Runs the current kernel whenever the control task starts it.  The first
+ * mathbTASKS workers use vector registers, the rest do not.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/*
+ * Runs every kernel in each of the three ways and records the results.
+ */
+static void prvControlTask( void * pvParameters );
+
+/*
+ * Runs the current kernel on uxTasks workers for mathbWINDOW_TICKS and
+ * returns the number of calls made per second.
+ */
+static uint32_t prvRun( UBaseType_t uxFirstWorker,
+                        UBaseType_t uxTasks,
+                        BaseType_t xYield );
+
+/*-----------------------------------------------------------*/
+
+static const MathKernel_t xKernels[] =
+{
+    { "f32 dot " mathbVECTOR_NAME, pdTRUE,  2 * mathbDOT_LENGTH,                prvKernelDotF32       },
+    { "f32 fir " mathbVECTOR_NAME, pdTRUE,  2 * mathbFIR_TAPS * mathbFIR_BLOCK, prvKernelFirF32       },
+    { "q15 dot " mathbVECTOR_NAME, pdTRUE,  2 * mathbDOT_LENGTH,                prvKernelDotQ15       },
+    { "q15 fir " mathbVECTOR_NAME, pdTRUE,  2 * mathbFIR_TAPS * mathbFIR_BLOCK, prvKernelFirQ15       },
+    { "q15 dot scalar",            pdFALSE, 2 * mathbDOT_LENGTH,                prvKernelDotQ15Scalar },
+    { "q15 fir scalar",            pdFALSE, 2 * mathbFIR_TAPS * mathbFIR_BLOCK, prvKernelFirQ15Scalar }
+};
+
+/* The inputs are shared and only read.  The filter input holds a block plus
+ * the history the first outputs need. */
+static float fVectorA[ mathbDOT_LENGTH ];
+static float fVectorB[ mathbDOT_LENGTH ];
+static float fFirInput[ mathbFIR_BLOCK + mathbFIR_TAPS ];
+static float fFirTaps[ mathbFIR_TAPS ];
+static int16_t sVectorA[ mathbDOT_LENGTH ];
+static int16_t sVectorB[ mathbDOT_LENGTH ];
+static int16_t sFirInput[ mathbFIR_BLOCK + mathbFIR_TAPS ];
+static int16_t sFirTaps[ mathbFIR_TAPS ];
+
+/* Each task filters into its own output block. */
+static float fFirOutput[ mathbTASKS ][ mathbFIR_BLOCK ];
+static int16_t sFirOutput[ mathbTASKS ][ mathbFIR_BLOCK ];
+
+static MathWorker_t xWorkers[ 2 * mathbTASKS ];
+static TaskHandle_t xControlTask = NULL;
+
+/* What the workers run while the control task waits. */
+static const MathKernel_t * volatile pxCurrentKernel = NULL;
+static volatile BaseType_t xYieldEachCall = pdFALSE;
+static volatile BaseType_t xStop = pdTRUE;
+
+static MathBenchmarkResult_t xResults[ mathbARRAY_LENGTH( xKernels ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartMathBenchmark( void )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < mathbARRAY_LENGTH( xWorkers ); ux++ )
+    {
+        xTaskCreate( prvWorkerTask, "MathB", mathbSTACK_SIZE, ( void * ) ux, mathbWORKER_PRIORITY, &( xWorkers[ ux ].xHandle ) );
+    }
+
+    xTaskCreate( prvControlTask, "MathBCtl", mathbSTACK_SIZE, NULL, mathbCONTROL_PRIORITY, &xControlTask );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsMathBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetMathBenchmarkResults( const MathBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+#if ( mathbUSE_MVE == 1 ) || ( mathbUSE_NEON == 1 )
+
+    static float prvDotF32( const float * pfA,
+                            const float * pfB,
+                            uint32_t ulLength )
+    {
+        float32x4_t xAccumulator0 = vdupq_n_f32( 0.0f );
+        float32x4_t xAccumulator1 = vdupq_n_f32( 0.0f );
+        uint32_t ul;
+
+        /* Two accumulators hide the latency of the multiply accumulate. */
+        for( ul = 0; ul < ulLength; ul += 8 )
+        {
+            #if ( mathbUSE_MVE == 1 )
+                xAccumulator0 = vfmaq_f32( xAccumulator0, vld1q_f32( &( pfA[ ul ] ) ), vld1q_f32( &( pfB[ ul ] ) ) );
+                xAccumulator1 = vfmaq_f32( xAccumulator1, vld1q_f32( &( pfA[ ul + 4 ] ) ), vld1q_f32( &( pfB[ ul + 4 ] ) ) );
+            #else
+                xAccumulator0 = vmlaq_f32( xAccumulator0, vld1q_f32( &( pfA[ ul ] ) ), vld1q_f32( &( pfB[ ul ] ) ) );
+                xAccumulator1 = vmlaq_f32( xAccumulator1, vld1q_f32( &( pfA[ ul + 4 ] ) ), vld1q_f32( &( pfB[ ul + 4 ] ) ) );
+            #endif
+        }
+
+        xAccumulator0 = vaddq_f32( xAccumulator0, xAccumulator1 );
+
+        return ( vgetq_lane_f32( xAccumulator0, 0 ) + vgetq_lane_f32( xAccumulator0, 1 ) ) +
+               ( vgetq_lane_f32( xAccumulator0, 2 ) + vgetq_lane_f32( xAccumulator0, 3 ) );
+    }
+
+#else /* if ( mathbUSE_MVE == 1 ) || ( mathbUSE_NEON == 1 ) */
+
+    static float prvDotF32( const float * pfA,
+                            const float * pfB,
+                            uint32_t ulLength )
+    {
+        float fSum0 = 0.0f, fSum1 = 0.0f, fSum2 = 0.0f, fSum3 = 0.0f;
+        uint32_t ul;
+
+        /* Four independent sums, which a compiler is free to vectorise. */
+        for( ul = 0; ul < ulLength; ul += 4 )
+        {
+            fSum0 += pfA[ ul ] * pfB[ ul ];
+            fSum1 += pfA[ ul + 1 ] * pfB[ ul + 1 ];
+            fSum2 += pfA[ ul + 2 ] * pfB[ ul + 2 ];
+            fSum3 += pfA[ ul + 3 ] * pfB[ ul + 3 ];
+        }
+
+        return ( fSum0 + fSum1 ) + ( fSum2 + fSum3 );
+    }
+
+#endif /* if ( mathbUSE_MVE == 1 ) || ( mathbUSE_NEON == 1 ) */
+/*-----------------------------------------------------------*/
+
+static int32_t prvDotQ15( const int16_t * psA,
+                          const int16_t * psB,
+                          uint32_t ulLength )
+{
+    uint32_t ul;
+
+    #if ( mathbUSE_MVE == 1 )
+        int64_t llSum = 0;
+
+        for( ul = 0; ul < ulLength; ul += 8 )
+        {
+            llSum = vmlaldavaq_s16( llSum, vld1q_s16( &( psA[ ul ] ) ), vld1q_s16( &( psB[ ul ] ) ) );
+        }
+
+        return ( int32_t ) llSum;
+    #elif ( mathbUSE_NEON == 1 )
+        int32x4_t xAccumulator = vdupq_n_s32( 0 );
+
+        for( ul = 0; ul < ulLength; ul += 8 )
+        {
+            xAccumulator = vmlal_s16( xAccumulator, vld1_s16( &( psA[ ul ] ) ), vld1_s16( &( psB[ ul ] ) ) );
+            xAccumulator = vmlal_s16( xAccumulator, vld1_s16( &( psA[ ul + 4 ] ) ), vld1_s16( &( psB[ ul + 4 ] ) ) );
+        }
+
+        return ( vgetq_lane_s32( xAccumulator, 0 ) + vgetq_lane_s32( xAccumulator, 1 ) ) +
+               ( vgetq_lane_s32( xAccumulator, 2 ) + vgetq_lane_s32( xAccumulator, 3 ) );
+    #elif ( mathbUSE_DSP == 1 )
+        int32_t lSum = 0;
+        int16x2_t xA, xB;
+
+        /* Two 16-bit multiply accumulates per instruction, in core registers
+         * only. */
+        for( ul = 0; ul < ulLength; ul += 2 )
+        {
+            memcpy( &xA, &( psA[ ul ] ), sizeof( xA ) );
+            memcpy( &xB, &( psB[ ul ] ), sizeof( xB ) );
+            lSum = __smlad( xA, xB, lSum );
+        }
+
+        return lSum;
+    #else
+        int32_t lSum0 = 0, lSum1 = 0;
+
+        for( ul = 0; ul < ulLength; ul += 2 )
+        {
+            lSum0 += ( int32_t ) psA[ ul ] * psB[ ul ];
+            lSum1 += ( int32_t ) psA[ ul + 1 ] * psB[ ul + 1 ];
+        }
+
+        return lSum0 + lSum1;
+    #endif /* if ( mathbUSE_MVE == 1 ) */
+}
+/*-----------------------------------------------------------*/
+
+static mathbSCALAR_FUNCTION int32_t prvDotQ15Scalar( const int16_t * psA,
+                                                     const int16_t * psB,
+                                                     uint32_t ulLength )
+{
+    int32_t lSum = 0;
+    uint32_t ul;
+
+    mathbSCALAR_LOOP
+    for( ul = 0; ul < ulLength; ul++ )
+    {
+        lSum += ( int32_t ) psA[ ul ] * psB[ ul ];
+    }
+
+    return lSum;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvKernelDotF32( UBaseType_t uxTask )
+{
+    float fResult;
+    uint32_t ulChecksum;
+
+    ( void ) uxTask;
+
+    fResult = prvDotF32( fVectorA, fVectorB, mathbDOT_LENGTH );
+    memcpy( &ulChecksum, &fResult, sizeof( ulChecksum ) );
+
+    return ulChecksum;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvKernelFirF32( UBaseType_t uxTask )
+{
+    float * pfOutput = fFirOutput[ uxTask % mathbTASKS ];
+    uint32_t ul, ulChecksum = 0, ulBits;
+
+    for( ul = 0; ul < mathbFIR_BLOCK; ul++ )
+    {
+        pfOutput[ ul ] = prvDotF32( &( fFirInput[ ul ] ), fFirTaps, mathbFIR_TAPS );
+        memcpy( &ulBits, &( pfOutput[ ul ] ), sizeof( ulBits ) );
+        ulChecksum ^= ulBits;
+    }
+
+    return ulChecksum;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvKernelDotQ15( UBaseType_t uxTask )
+{
+    ( void ) uxTask;
+
+    return ( uint32_t ) prvDotQ15( sVectorA, sVectorB, mathbDOT_LENGTH );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvKernelFirQ15( UBaseType_t uxTask )
+{
+    int16_t * psOutput = sFirOutput[ uxTask % mathbTASKS ];
+    uint32_t ul, ulChecksum = 0;
+
+    for( ul = 0; ul < mathbFIR_BLOCK; ul++ )
+    {
+        psOutput[ ul ] = ( int16_t ) ( prvDotQ15( &( sFirInput[ ul ] ), sFirTaps, mathbFIR_TAPS ) >> 15 );
+        ulChecksum = ( ulChecksum << 1 ) ^ ( uint16_t ) psOutput[ ul ];
+    }
+
+    return ulChecksum;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvKernelDotQ15Scalar( UBaseType_t uxTask )
+{
+    ( void ) uxTask;
+
+    return ( uint32_t ) prvDotQ15Scalar( sVectorA, sVectorB, mathbDOT_LENGTH );
+}
+/*-----------------------------------------------------------*/
+
+static mathbSCALAR_FUNCTION uint32_t prvKernelFirQ15Scalar( UBaseType_t uxTask )
+{
+    int16_t * psOutput = sFirOutput[ uxTask % mathbTASKS ];
+    uint32_t ul, ulChecksum = 0;
+
+    mathbSCALAR_LOOP
+    for( ul = 0; ul < mathbFIR_BLOCK; ul++ )
+    {
+        psOutput[ ul ] = ( int16_t ) ( prvDotQ15Scalar( &( sFirInput[ ul ] ), sFirTaps, mathbFIR_TAPS ) >> 15 );
+        ulChecksum = ( ulChecksum << 1 ) ^ ( uint16_t ) psOutput[ ul ];
+    }
+
+    return ulChecksum;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    const UBaseType_t uxIndex = ( UBaseType_t ) pvParameters;
+    MathWorker_t * const pxWorker = &( xWorkers[ uxIndex ] );
+    const MathKernel_t * pxKernel;
+    uint32_t ulChecksum;
+    BaseType_t xFirstCall;
+
+    /* Only the first set of workers runs kernels that use the floating
+     * point / vector registers, so only they declare a floating point
+     * context on the ports that need to be told. */
+    if( uxIndex < mathbTASKS )
+    {
+        portTASK_USES_FLOATING_POINT();
+    }
+
+    for( ; ; )
+    {
+        /* Wait to be started. */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        pxKernel = pxCurrentKernel;
+        xFirstCall = pdTRUE;
+
+        while( xStop == pdFALSE )
+        {
+            ulChecksum = pxKernel->xKernel( uxIndex );
+
+            if( xFirstCall != pdFALSE )
+            {
+                pxWorker->ulFirstChecksum = ulChecksum;
+                xFirstCall = pdFALSE;
+            }
+            else if( ulChecksum != pxWorker->ulFirstChecksum )
+            {
+                pxWorker->xMismatch = pdTRUE;
+            }
+
+            pxWorker->ulCalls++;
+
+            if( xYieldEachCall != pdFALSE )
+            {
+                taskYIELD();
+            }
+        }
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRun( UBaseType_t uxFirstWorker,
+                        UBaseType_t uxTasks,
+                        BaseType_t xYield )
+{
+    TickType_t xStart, xElapsed;
+    uint64_t ullCalls = 0;
+    UBaseType_t ux;
+
+    for( ux = uxFirstWorker; ux < ( uxFirstWorker + uxTasks ); ux++ )
+    {
+        xWorkers[ ux ].ulCalls = 0;
+    }
+
+    xYieldEachCall = xYield;
+    xStop = pdFALSE;
+    xStart = xTaskGetTickCount();
+
+    for( ux = uxFirstWorker; ux < ( uxFirstWorker + uxTasks ); ux++ )
+    {
+        xTaskNotifyGive( xWorkers[ ux ].xHandle );
+    }
+
+    /* The workers run while this task is blocked. */
+    vTaskDelay( mathbWINDOW_TICKS );
+
+    xStop = pdTRUE;
+    xElapsed = xTaskGetTickCount() - xStart;
+
+    for( ux = uxFirstWorker; ux < ( uxFirstWorker + uxTasks ); ux++ )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+
+    for( ux = uxFirstWorker; ux < ( uxFirstWorker + uxTasks ); ux++ )
+    {
+        ullCalls += xWorkers[ ux ].ulCalls;
+    }
+
+    return ( uint32_t ) ( ( ullCalls * configTICK_RATE_HZ ) / ( uint64_t ) xElapsed );
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    const MathKernel_t * pxKernel;
+    MathBenchmarkResult_t * pxResult;
+    UBaseType_t uxKernel, uxFirstWorker, ux;
+    uint32_t ulSingle, ulShared, ulYield;
+    uint64_t ullSingleNs, ullYieldNs;
+
+    ( void ) pvParameters;
+
+    /* Small values, so the Q15 sums cannot overflow and the float sums are
+     * exact. */
+    for( ux = 0; ux < mathbDOT_LENGTH; ux++ )
+    {
+        fVectorA[ ux ] = ( float ) ( ( int32_t ) ( ux % 17 ) - 8 );
+        fVectorB[ ux ] = ( float ) ( ( int32_t ) ( ux % 13 ) - 6 ) * 0.25f;
+        sVectorA[ ux ] = ( int16_t ) ( ( ( int32_t ) ( ux % 17 ) - 8 ) * 64 );
+        sVectorB[ ux ] = ( int16_t ) ( ( ( int32_t ) ( ux % 13 ) - 6 ) * 64 );
+    }
+
+    for( ux = 0; ux < ( mathbFIR_BLOCK + mathbFIR_TAPS ); ux++ )
+    {
+        fFirInput[ ux ] = ( float ) ( ( int32_t ) ( ux % 11 ) - 5 );
+        sFirInput[ ux ] = ( int16_t ) ( ( ( int32_t ) ( ux % 11 ) - 5 ) * 1024 );
+    }
+
+    for( ux = 0; ux < mathbFIR_TAPS; ux++ )
+    {
+        fFirTaps[ ux ] = ( float ) ( ( int32_t ) ( ux % 5 ) + 1 ) * 0.125f;
+        sFirTaps[ ux ] = ( int16_t ) ( ( ( int32_t ) ( ux % 5 ) + 1 ) * 512 );
+    }
+
+    for( uxKernel = 0; uxKernel < mathbARRAY_LENGTH( xKernels ); uxKernel++ )
+    {
+        pxKernel = &( xKernels[ uxKernel ] );
+        pxCurrentKernel = pxKernel;
+        uxFirstWorker = ( pxKernel->xUsesVectorRegisters != pdFALSE ) ? 0 : mathbTASKS;
+
+        ulSingle = prvRun( uxFirstWorker, 1, pdFALSE );
+        ulShared = prvRun( uxFirstWorker, mathbTASKS, pdFALSE );
+        ulYield = prvRun( uxFirstWorker, mathbTASKS, pdTRUE );
+
+        pxResult = &( xResults[ uxKernel ] );
+        pxResult->pcKernel = pxKernel->pcName;
+        pxResult->xUsesVectorRegisters = pxKernel->xUsesVectorRegisters;
+        pxResult->ulSingleKOps = ( uint32_t ) ( ( ( uint64_t ) ulSingle * pxKernel->ulOpsPerCall ) / 1000ULL );
+        pxResult->ulSharedKOps = ( uint32_t ) ( ( ( uint64_t ) ulShared * pxKernel->ulOpsPerCall ) / 1000ULL );
+        pxResult->ulYieldKOps = ( uint32_t ) ( ( ( uint64_t ) ulYield * pxKernel->ulOpsPerCall ) / 1000ULL );
+
+        /* Each call made while yielding is followed by one context switch. */
+        ullSingleNs = ( ulSingle != 0 ) ? ( 1000000000ULL / ulSingle ) : 0;
+        ullYieldNs = ( ulYield != 0 ) ? ( 1000000000ULL / ulYield ) : 0;
+        pxResult->ulSwitchNs = ( ullYieldNs > ullSingleNs ) ? ( uint32_t ) ( ullYieldNs - ullSingleNs ) : 0;
+
+        pxResult->xResultsMatched = pdTRUE;
+
+        for( ux = uxFirstWorker; ux < ( uxFirstWorker + mathbTASKS ); ux++ )
+        {
+            if( xWorkers[ ux ].xMismatch != pdFALSE )
+            {
+                pxResult->xResultsMatched = pdFALSE;
+            }
+
+            xWorkers[ ux ].xMismatch = pdFALSE;
+        }
+
+        uxResultCount = uxKernel + 1;
+    }
+
+    /* The workers are all waiting to be started again. */
+    for( ux = 0; ux < mathbARRAY_LENGTH( xWorkers ); ux++ )
+    {
+        vTaskDelete( xWorkers[ ux ].xHandle );
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
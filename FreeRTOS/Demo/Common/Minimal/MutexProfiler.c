@@ -0,0 +1,392 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Records, for each mutex, how often it is taken, how often a take has to
+ * wait because another task holds it, how long takes wait, how long the
+ * mutex is held, and how often a holder inherits the priority of a waiting
+ * task.  The counters are updated by the kernel trace macros defined in
+ * MutexProfiler.h, so they cover every mutex and recursive mutex in the
+ * application without changing the code that uses them, such as the mutexes
+ * used by recmutex.c, GenQTest.c and death.c in the full demos.
+ *
+ * A mutex is recognised by traceCREATE_MUTEX(), so up to
+ * mprofMAX_MUTEXES mutexes are profiled.  The trace macros for queue
+ * operations are also called for queues and semaphores, which are ignored.
+ * A recursive take or give that only changes the recursion count does not
+ * reach the queue, so hold times run from the outermost take to the
+ * outermost give.
+ *
+ * Inheritance is attributed to the mutex the current task is about to block
+ * on, as xTaskPriorityInherit() is called between
+ * traceBLOCKING_ON_QUEUE_RECEIVE() and the task blocking.  The profiler
+ * takes its own critical sections so only supports single core ports.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo program include files. */
+#include "MutexProfiler.h"
+
+#if ( configUSE_MUTEX_PROFILER == 1 )
+
+/* The most mutexes that are profiled. */
+    #ifndef mprofMAX_MUTEXES
+        #define mprofMAX_MUTEXES    32
+    #endif
+
+/* The most tasks that can be waiting for profiled mutexes at once. */
+    #ifndef mprofMAX_WAITERS
+        #define mprofMAX_WAITERS    16
+    #endif
+
+/* Wait and hold times are measured with mprofGET_TIME(), which defaults to
+ * the run time stats counter, or the tick count if there is none. */
+    #ifndef mprofGET_TIME
+        #if ( configGENERATE_RUN_TIME_STATS == 1 )
+            #define mprofGET_TIME()    ( ( uint64_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+        #else
+            #define mprofGET_TIME()    ( ( uint64_t ) xTaskGetTickCount() )
+        #endif
+    #endif
+
+typedef struct MutexProfileEntry
+{
+    MutexProfile_t xProfile;
+    uint64_t ullTakenTime;
+    BaseType_t xHeld;
+} MutexProfileEntry_t;
+
+/* A task blocked on a profiled mutex. */
+typedef struct MutexWaiter
+{
+    TaskHandle_t xTask;
+    void * pvMutex;
+    uint64_t ullBlockedTime;
+} MutexWaiter_t;
+
+/*-----------------------------------------------------------*/
+
+static MutexProfileEntry_t xMutexes[ mprofMAX_MUTEXES ];
+static UBaseType_t uxMutexes = 0;
+
+static MutexWaiter_t xWaiters[ mprofMAX_WAITERS ];
+
+/* The mutex the running task last blocked on, see vMutexProfilerInherited(). */
+static void * pvLastBlockingMutex = NULL;
+
+/*-----------------------------------------------------------*/
+
+static MutexProfileEntry_t * prvFindMutex( void * pvMutex )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxMutexes; ux++ )
+    {
+        if( xMutexes[ ux ].xProfile.pvMutex == pvMutex )
+        {
+            return &( xMutexes[ ux ] );
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* Returns the wait of the running task, or if xCreate is pdTRUE a free slot
+ * when it is not waiting. */
+static MutexWaiter_t * prvFindWaiter( BaseType_t xCreate )
+{
+    TaskHandle_t xTask = xTaskGetCurrentTaskHandle();
+    MutexWaiter_t * pxFree = NULL;
+    UBaseType_t ux;
+
+    for( ux = 0; ux < mprofMAX_WAITERS; ux++ )
+    {
+        if( xWaiters[ ux ].xTask == xTask )
+        {
+            return &( xWaiters[ ux ] );
+        }
+        else if( ( xWaiters[ ux ].xTask == NULL ) && ( pxFree == NULL ) )
+        {
+            pxFree = &( xWaiters[ ux ] );
+        }
+    }
+
+    if( ( xCreate == pdFALSE ) || ( pxFree == NULL ) )
+    {
+        return NULL;
+    }
+
+    pxFree->xTask = xTask;
+
+    return pxFree;
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerCreated( void * pvMutex )
+{
+    taskENTER_CRITICAL();
+    {
+        if( ( prvFindMutex( pvMutex ) == NULL ) && ( uxMutexes < mprofMAX_MUTEXES ) )
+        {
+            memset( &( xMutexes[ uxMutexes ] ), 0x00, sizeof( MutexProfileEntry_t ) );
+            xMutexes[ uxMutexes ].xProfile.pvMutex = pvMutex;
+            uxMutexes++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerDeleted( void * pvMutex )
+{
+    MutexProfileEntry_t * pxEntry;
+    UBaseType_t ux;
+
+    taskENTER_CRITICAL();
+    {
+        pxEntry = prvFindMutex( pvMutex );
+
+        if( pxEntry != NULL )
+        {
+            uxMutexes--;
+            *pxEntry = xMutexes[ uxMutexes ];
+
+            for( ux = 0; ux < mprofMAX_WAITERS; ux++ )
+            {
+                if( xWaiters[ ux ].pvMutex == pvMutex )
+                {
+                    xWaiters[ ux ].xTask = NULL;
+                }
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerBlocking( void * pvMutex )
+{
+    MutexWaiter_t * pxWaiter;
+
+    taskENTER_CRITICAL();
+    {
+        if( prvFindMutex( pvMutex ) != NULL )
+        {
+            pvLastBlockingMutex = pvMutex;
+            pxWaiter = prvFindWaiter( pdTRUE );
+
+            /* A take can block more than once, the wait runs from the
+             * first time. */
+            if( ( pxWaiter != NULL ) && ( pxWaiter->pvMutex != pvMutex ) )
+            {
+                pxWaiter->pvMutex = pvMutex;
+                pxWaiter->ullBlockedTime = mprofGET_TIME();
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerTaken( void * pvMutex )
+{
+    MutexProfileEntry_t * pxEntry;
+    MutexWaiter_t * pxWaiter;
+    uint64_t ullNow, ullWait;
+
+    taskENTER_CRITICAL();
+    {
+        pxEntry = prvFindMutex( pvMutex );
+
+        if( pxEntry != NULL )
+        {
+            ullNow = mprofGET_TIME();
+            pxWaiter = prvFindWaiter( pdFALSE );
+
+            if( ( pxWaiter != NULL ) && ( pxWaiter->pvMutex == pvMutex ) )
+            {
+                ullWait = ullNow - pxWaiter->ullBlockedTime;
+                pxEntry->xProfile.ulContended++;
+                pxEntry->xProfile.ullWaitTime += ullWait;
+
+                if( ullWait > pxEntry->xProfile.ullMaxWait )
+                {
+                    pxEntry->xProfile.ullMaxWait = ullWait;
+                }
+
+                pxWaiter->xTask = NULL;
+                pxWaiter->pvMutex = NULL;
+            }
+
+            pxEntry->xProfile.ulAcquires++;
+            pxEntry->ullTakenTime = ullNow;
+            pxEntry->xHeld = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerTakeFailed( void * pvMutex )
+{
+    MutexProfileEntry_t * pxEntry;
+    MutexWaiter_t * pxWaiter;
+
+    taskENTER_CRITICAL();
+    {
+        pxEntry = prvFindMutex( pvMutex );
+
+        if( pxEntry != NULL )
+        {
+            pxEntry->xProfile.ulTimeouts++;
+            pxWaiter = prvFindWaiter( pdFALSE );
+
+            if( ( pxWaiter != NULL ) && ( pxWaiter->pvMutex == pvMutex ) )
+            {
+                pxWaiter->xTask = NULL;
+                pxWaiter->pvMutex = NULL;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerGiven( void * pvMutex )
+{
+    MutexProfileEntry_t * pxEntry;
+    uint64_t ullHold;
+
+    taskENTER_CRITICAL();
+    {
+        pxEntry = prvFindMutex( pvMutex );
+
+        /* The give made when the mutex is created has no matching take. */
+        if( ( pxEntry != NULL ) && ( pxEntry->xHeld != pdFALSE ) )
+        {
+            ullHold = mprofGET_TIME() - pxEntry->ullTakenTime;
+            pxEntry->xProfile.ullHoldTime += ullHold;
+
+            if( ullHold > pxEntry->xProfile.ullMaxHold )
+            {
+                pxEntry->xProfile.ullMaxHold = ullHold;
+            }
+
+            pxEntry->xHeld = pdFALSE;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerInherited( void )
+{
+    MutexProfileEntry_t * pxEntry;
+
+    taskENTER_CRITICAL();
+    {
+        pxEntry = prvFindMutex( pvLastBlockingMutex );
+
+        if( pxEntry != NULL )
+        {
+            pxEntry->xProfile.ulInheritances++;
+        }
+
+        pvLastBlockingMutex = NULL;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulMutexProfilerGetTop( MutexProfile_t * pxProfiles,
+                                uint32_t ulMaxProfiles )
+{
+    MutexProfile_t xProfile;
+    uint32_t ulCount = 0, ul, ulInsert;
+
+    taskENTER_CRITICAL();
+    {
+        /* Insertion sort, most contended first, then longest total wait. */
+        for( ul = 0; ul < ( uint32_t ) uxMutexes; ul++ )
+        {
+            xProfile = xMutexes[ ul ].xProfile;
+            ulInsert = ulCount;
+
+            while( ( ulInsert > 0 ) &&
+                   ( ( pxProfiles[ ulInsert - 1 ].ulContended < xProfile.ulContended ) ||
+                     ( ( pxProfiles[ ulInsert - 1 ].ulContended == xProfile.ulContended ) &&
+                       ( pxProfiles[ ulInsert - 1 ].ullWaitTime < xProfile.ullWaitTime ) ) ) )
+            {
+                if( ulInsert < ulMaxProfiles )
+                {
+                    pxProfiles[ ulInsert ] = pxProfiles[ ulInsert - 1 ];
+                }
+
+                ulInsert--;
+            }
+
+            if( ulInsert < ulMaxProfiles )
+            {
+                pxProfiles[ ulInsert ] = xProfile;
+
+                if( ulCount < ulMaxProfiles )
+                {
+                    ulCount++;
+                }
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+void vMutexProfilerReset( void )
+{
+    UBaseType_t ux;
+    void * pvMutex;
+
+    taskENTER_CRITICAL();
+    {
+        for( ux = 0; ux < uxMutexes; ux++ )
+        {
+            pvMutex = xMutexes[ ux ].xProfile.pvMutex;
+            memset( &( xMutexes[ ux ].xProfile ), 0x00, sizeof( MutexProfile_t ) );
+            xMutexes[ ux ].xProfile.pvMutex = pvMutex;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+#endif /* configUSE_MUTEX_PROFILER */
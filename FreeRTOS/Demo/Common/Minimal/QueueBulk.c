@@ -0,0 +1,149 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Multi item send and receive on top of the kernel queue functions.
+ *
+ * Sending n items one by one to a queue a higher priority task waits on
+ * readies that task, and switches to it, for every item, and the same goes
+ * for receiving from a full queue a higher priority sender waits on.
+ * uxQueueSendMultiple() and uxQueueReceiveMultiple() instead move the items
+ * that fit, or are present, with the scheduler suspended.  A task the first
+ * item unblocks is then only held on the pending ready list, and is readied,
+ * and switched to, once when the scheduler is resumed, by which time the
+ * whole batch is in, or out of, the queue.  Only the first item of a batch is
+ * waited for the usual way, when the queue is full or empty.
+ *
+ * The queue functions do not block while the scheduler is suspended, as
+ * each is called with a block time of 0.  The items of a batch are copied by
+ * the kernel one at a time, each in its own short critical section, but none
+ * of them switches context.
+ *
+ * The kernel sources are not part of this tree, so this is a layer on the
+ * queue API rather than a change to queue.c.  The queues used with it are
+ * ordinary queues, and can be in queue sets.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo app includes. */
+#include "QueueBulk.h"
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueSendMultiple( QueueHandle_t xQueue,
+                                 const void * pvItems,
+                                 UBaseType_t uxItemCount,
+                                 TickType_t xTicksToWait )
+{
+    const uint8_t * pucItems = ( const uint8_t * ) pvItems;
+    UBaseType_t uxItemSize;
+    UBaseType_t uxSent = 0;
+    TimeOut_t xTimeOut;
+
+    configASSERT( xQueue );
+    uxItemSize = uxQueueGetQueueItemSize( xQueue );
+    configASSERT( ( pvItems != NULL ) || ( uxItemSize == 0U ) || ( uxItemCount == 0U ) );
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    while( uxSent < uxItemCount )
+    {
+        vTaskSuspendAll();
+        {
+            while( ( uxSent < uxItemCount ) &&
+                   ( xQueueSend( xQueue, &( pucItems[ uxSent * uxItemSize ] ), 0 ) == pdPASS ) )
+            {
+                uxSent++;
+            }
+        }
+        ( void ) xTaskResumeAll();
+
+        if( uxSent == uxItemCount )
+        {
+            break;
+        }
+
+        /* The queue is full.  Wait for space by sending the next item the
+         * usual way, within what is left of the block time. */
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            break;
+        }
+
+        if( xQueueSend( xQueue, &( pucItems[ uxSent * uxItemSize ] ), xTicksToWait ) != pdPASS )
+        {
+            break;
+        }
+
+        uxSent++;
+    }
+
+    return uxSent;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueReceiveMultiple( QueueHandle_t xQueue,
+                                    void * pvBuffer,
+                                    UBaseType_t uxMaxItems,
+                                    TickType_t xTicksToWait )
+{
+    uint8_t * pucBuffer = ( uint8_t * ) pvBuffer;
+    UBaseType_t uxItemSize;
+    UBaseType_t uxReceived = 0;
+
+    configASSERT( xQueue );
+    uxItemSize = uxQueueGetQueueItemSize( xQueue );
+    configASSERT( ( pvBuffer != NULL ) || ( uxItemSize == 0U ) || ( uxMaxItems == 0U ) );
+
+    if( uxMaxItems > 0U )
+    {
+        /* Wait for the first item the usual way. */
+        if( xQueueReceive( xQueue, pucBuffer, xTicksToWait ) == pdPASS )
+        {
+            uxReceived = 1;
+
+            vTaskSuspendAll();
+            {
+                while( ( uxReceived < uxMaxItems ) &&
+                       ( xQueueReceive( xQueue, &( pucBuffer[ uxReceived * uxItemSize ] ), 0 ) == pdPASS ) )
+                {
+                    uxReceived++;
+                }
+            }
+            ( void ) xTaskResumeAll();
+        }
+    }
+
+    return uxReceived;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,445 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures how the kernel queue set, and the ready list set in
+ * ReadyQueueSet.c, scale with the number of members.  QueueSet.c tests the
+ * behaviour of the queue set API with a few queues; this file only times it,
+ * with up to qsbMAX_MEMBERS members.
+ *
+ * For each implementation and each count in uxMemberCounts[] the benchmark
+ * task:
+ *
+ * 1) For each burst length in uxBursts[], sends that many events spread over
+ *    the members, then receives them all through the set without blocking,
+ *    qsbROUNDS times, and reports the average cost of a send and of a
+ *    receive.  A receive includes finding which of its members the task was
+ *    given, which for the kernel queue set is a search of the member handles,
+ *    as an application dispatching on the handle would do.  The burst length
+ *    stands for the event rate, as it is the number of events that are
+ *    waiting when the receiving task next runs.
+ *
+ * 2) Blocks on the empty set qsbWAKE_ROUNDS times while
+ *    vQueueSetBenchmarkTickHook() sends one event from the tick interrupt,
+ *    and reports the average time from the send to the task having received
+ *    the event, which includes the context switch.
+ *
+ * Times are read with qsbGET_TIME(), which defaults to the run time stats
+ * counter.  Define it to read a cycle counter for finer resolution.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo app includes. */
+#include "QueueSetBenchmark.h"
+#include "ReadyQueueSet.h"
+
+#if ( configUSE_QUEUE_SETS == 0 )
+    #error QueueSetBenchmark.c requires configUSE_QUEUE_SETS to be 1
+#endif
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error QueueSetBenchmark.c requires configSUPPORT_DYNAMIC_ALLOCATION to be 1
+#endif
+
+#ifndef qsbGET_TIME
+    #define qsbGET_TIME()         ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+/* The most members in a set, which is the last of uxMemberCounts[]. */
+#ifndef qsbMAX_MEMBERS
+    #define qsbMAX_MEMBERS        ( 48 )
+#endif
+
+/* The longest burst, which is the last of uxBursts[].  Every member queue is
+ * this long, so a burst to a set of one member fits. */
+#ifndef qsbMAX_BURST
+    #define qsbMAX_BURST          ( 32 )
+#endif
+
+/* How many bursts are sent and received for each combination. */
+#ifndef qsbROUNDS
+    #define qsbROUNDS             ( 64 )
+#endif
+
+/* How many wake ups are timed for each combination. */
+#ifndef qsbWAKE_ROUNDS
+    #define qsbWAKE_ROUNDS        ( 16 )
+#endif
+
+#ifndef qsbSTACK_SIZE
+    #define qsbSTACK_SIZE         ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#define qsbBENCHMARK_PRIORITY     ( tskIDLE_PRIORITY + 1 )
+
+/* Longer than the tick hook takes to send an event. */
+#define qsbWAKE_TIMEOUT           pdMS_TO_TICKS( 100UL )
+
+/* Consecutive events go to members this far apart, so a burst is spread over
+ * the set rather than filling one member after another. */
+#define qsbMEMBER_STRIDE          ( 7U )
+
+/* Returned by a receive that timed out. */
+#define qsbNO_MEMBER              ( ( UBaseType_t ) -1 )
+
+#define qsbARRAY_LENGTH( x )      ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* One implementation of a set of queues.  Each event is the index of the
+ * member it is sent to, so the receiver can check it was dispatched to the
+ * right member. */
+typedef struct QueueSetBackend
+{
+    const char * pcName;
+    void ( * vCreate )( UBaseType_t uxMembers );
+    void ( * vDelete )( UBaseType_t uxMembers );
+    void ( * vSend )( UBaseType_t uxMember );
+    void ( * vSendFromISR )( UBaseType_t uxMember,
+                             BaseType_t * pxHigherPriorityTaskWoken );
+    UBaseType_t ( * uxReceive )( UBaseType_t uxMembers,
+                                 TickType_t xTicksToWait );
+} QueueSetBackend_t;
+
+static void prvKernelCreate( UBaseType_t uxMembers );
+static void prvKernelDelete( UBaseType_t uxMembers );
+static void prvKernelSend( UBaseType_t uxMember );
+static void prvKernelSendFromISR( UBaseType_t uxMember,
+                                  BaseType_t * pxHigherPriorityTaskWoken );
+static UBaseType_t prvKernelReceive( UBaseType_t uxMembers,
+                                     TickType_t xTicksToWait );
+
+static void prvReadyCreate( UBaseType_t uxMembers );
+static void prvReadyDelete( UBaseType_t uxMembers );
+static void prvReadySend( UBaseType_t uxMember );
+static void prvReadySendFromISR( UBaseType_t uxMember,
+                                 BaseType_t * pxHigherPriorityTaskWoken );
+static UBaseType_t prvReadyReceive( UBaseType_t uxMembers,
+                                    TickType_t xTicksToWait );
+
+/* Runs every combination in turn. */
+static void prvBenchmarkTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static const QueueSetBackend_t xBackends[] =
+{
+    { "queue set",  prvKernelCreate, prvKernelDelete, prvKernelSend, prvKernelSendFromISR, prvKernelReceive },
+    { "ready list", prvReadyCreate,  prvReadyDelete,  prvReadySend,  prvReadySendFromISR,  prvReadyReceive  }
+};
+
+static const UBaseType_t uxMemberCounts[] = { 1, 8, qsbMAX_MEMBERS };
+static const UBaseType_t uxBursts[] = { 1, 8, qsbMAX_BURST };
+
+static QueueHandle_t xMemberQueues[ qsbMAX_MEMBERS ];
+static QueueSetHandle_t xKernelSet = NULL;
+static ReadyQueueSet_t xReadySet;
+static ReadyQueueSetMember_t xReadyMembers[ qsbMAX_MEMBERS ];
+
+/* Read by the tick hook.  pxWakeBackend is only set while the members exist. */
+static const QueueSetBackend_t * volatile pxWakeBackend = NULL;
+static volatile UBaseType_t uxWakeMember = 0;
+static volatile BaseType_t xWakeArmed = pdFALSE;
+static volatile uint32_t ulWakeSendTime = 0;
+
+static QueueSetBenchmarkResult_t xResults[ qsbARRAY_LENGTH( xBackends ) * qsbARRAY_LENGTH( uxMemberCounts ) * qsbARRAY_LENGTH( uxBursts ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartQueueSetBenchmark( void )
+{
+    xTaskCreate( prvBenchmarkTask, "QSetBench", qsbSTACK_SIZE, NULL, qsbBENCHMARK_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsQueueSetBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetQueueSetBenchmarkResults( const QueueSetBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+void vQueueSetBenchmarkTickHook( void )
+{
+    const QueueSetBackend_t * pxBackend = pxWakeBackend;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if( ( xWakeArmed != pdFALSE ) && ( pxBackend != NULL ) )
+    {
+        xWakeArmed = pdFALSE;
+        ulWakeSendTime = qsbGET_TIME();
+        pxBackend->vSendFromISR( uxWakeMember, &xHigherPriorityTaskWoken );
+
+        /* The tick interrupt switches to the woken task itself. */
+        ( void ) xHigherPriorityTaskWoken;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    const QueueSetBackend_t * pxBackend;
+    QueueSetBenchmarkResult_t * pxCaseResults;
+    UBaseType_t uxBackend, uxCount, uxMembers, uxBurst, ux, uxRound, uxEvent, uxMember, uxWakes;
+    uint32_t ulStart, ulSent, ulWakeTotal;
+    uint64_t ullSendTotal, ullReceiveTotal;
+
+    ( void ) pvParameters;
+
+    for( uxBackend = 0; uxBackend < qsbARRAY_LENGTH( xBackends ); uxBackend++ )
+    {
+        pxBackend = &( xBackends[ uxBackend ] );
+
+        for( uxCount = 0; uxCount < qsbARRAY_LENGTH( uxMemberCounts ); uxCount++ )
+        {
+            uxMembers = uxMemberCounts[ uxCount ];
+            pxCaseResults = &( xResults[ uxResultCount ] );
+            pxBackend->vCreate( uxMembers );
+
+            /* The cost of sending and receiving bursts of each length. */
+            for( ux = 0; ux < qsbARRAY_LENGTH( uxBursts ); ux++ )
+            {
+                uxBurst = uxBursts[ ux ];
+                ullSendTotal = 0;
+                ullReceiveTotal = 0;
+
+                for( uxRound = 0; uxRound < qsbROUNDS; uxRound++ )
+                {
+                    ulStart = qsbGET_TIME();
+
+                    for( uxEvent = 0; uxEvent < uxBurst; uxEvent++ )
+                    {
+                        pxBackend->vSend( ( ( uxRound + uxEvent ) * qsbMEMBER_STRIDE ) % uxMembers );
+                    }
+
+                    ulSent = qsbGET_TIME();
+
+                    for( uxEvent = 0; uxEvent < uxBurst; uxEvent++ )
+                    {
+                        uxMember = pxBackend->uxReceive( uxMembers, 0 );
+                        configASSERT( uxMember != qsbNO_MEMBER );
+                        ( void ) uxMember;
+                    }
+
+                    ullReceiveTotal += qsbGET_TIME() - ulSent;
+                    ullSendTotal += ulSent - ulStart;
+                }
+
+                pxCaseResults[ ux ].pcSet = pxBackend->pcName;
+                pxCaseResults[ ux ].uxMembers = uxMembers;
+                pxCaseResults[ ux ].uxBurst = uxBurst;
+                pxCaseResults[ ux ].ulSendCost = ( uint32_t ) ( ullSendTotal / ( qsbROUNDS * uxBurst ) );
+                pxCaseResults[ ux ].ulReceiveCost = ( uint32_t ) ( ullReceiveTotal / ( qsbROUNDS * uxBurst ) );
+            }
+
+            /* The cost of waking the receiver from an interrupt, which does
+             * not depend on the burst length. */
+            ulWakeTotal = 0;
+            uxWakes = 0;
+            pxWakeBackend = pxBackend;
+
+            for( uxRound = 0; uxRound < qsbWAKE_ROUNDS; uxRound++ )
+            {
+                uxWakeMember = ( uxRound * qsbMEMBER_STRIDE ) % uxMembers;
+                xWakeArmed = pdTRUE;
+
+                if( pxBackend->uxReceive( uxMembers, qsbWAKE_TIMEOUT ) == uxWakeMember )
+                {
+                    ulWakeTotal += qsbGET_TIME() - ulWakeSendTime;
+                    uxWakes++;
+                }
+            }
+
+            xWakeArmed = pdFALSE;
+            pxWakeBackend = NULL;
+
+            /* Receive any event sent after its wait timed out. */
+            while( pxBackend->uxReceive( uxMembers, 0 ) != qsbNO_MEMBER )
+            {
+            }
+
+            for( ux = 0; ux < qsbARRAY_LENGTH( uxBursts ); ux++ )
+            {
+                pxCaseResults[ ux ].ulWakeCost = ( uxWakes > 0U ) ? ( ulWakeTotal / ( uint32_t ) uxWakes ) : 0U;
+            }
+
+            pxBackend->vDelete( uxMembers );
+            uxResultCount += qsbARRAY_LENGTH( uxBursts );
+        }
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelCreate( UBaseType_t uxMembers )
+{
+    UBaseType_t ux;
+
+    xKernelSet = xQueueCreateSet( uxMembers * qsbMAX_BURST );
+    configASSERT( xKernelSet );
+
+    for( ux = 0; ux < uxMembers; ux++ )
+    {
+        xMemberQueues[ ux ] = xQueueCreate( qsbMAX_BURST, sizeof( UBaseType_t ) );
+        configASSERT( xMemberQueues[ ux ] );
+        ( void ) xQueueAddToSet( xMemberQueues[ ux ], xKernelSet );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelDelete( UBaseType_t uxMembers )
+{
+    UBaseType_t ux;
+
+    /* Every event has been received, so the members are empty and can be
+     * removed from the set, which must be done before they are deleted. */
+    for( ux = 0; ux < uxMembers; ux++ )
+    {
+        ( void ) xQueueRemoveFromSet( xMemberQueues[ ux ], xKernelSet );
+        vQueueDelete( xMemberQueues[ ux ] );
+    }
+
+    vQueueDelete( xKernelSet );
+    xKernelSet = NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelSend( UBaseType_t uxMember )
+{
+    ( void ) xQueueSendToBack( xMemberQueues[ uxMember ], &uxMember, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvKernelSendFromISR( UBaseType_t uxMember,
+                                  BaseType_t * pxHigherPriorityTaskWoken )
+{
+    ( void ) xQueueSendToBackFromISR( xMemberQueues[ uxMember ], &uxMember, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvKernelReceive( UBaseType_t uxMembers,
+                                     TickType_t xTicksToWait )
+{
+    QueueSetMemberHandle_t xActivated;
+    UBaseType_t ux, uxReceived = qsbNO_MEMBER;
+
+    xActivated = xQueueSelectFromSet( xKernelSet, xTicksToWait );
+
+    if( xActivated != NULL )
+    {
+        /* Find the member the handle belongs to. */
+        for( ux = 0; ux < uxMembers; ux++ )
+        {
+            if( xMemberQueues[ ux ] == xActivated )
+            {
+                break;
+            }
+        }
+
+        if( xQueueReceive( xActivated, &uxReceived, 0 ) == pdPASS )
+        {
+            configASSERT( uxReceived == ux );
+        }
+    }
+
+    return uxReceived;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadyCreate( UBaseType_t uxMembers )
+{
+    UBaseType_t ux;
+
+    vReadyQueueSetInitialise( &xReadySet );
+
+    for( ux = 0; ux < uxMembers; ux++ )
+    {
+        xMemberQueues[ ux ] = xQueueCreate( qsbMAX_BURST, sizeof( UBaseType_t ) );
+        configASSERT( xMemberQueues[ ux ] );
+        vReadyQueueSetAddMember( &xReadySet, &( xReadyMembers[ ux ] ), xMemberQueues[ ux ], ( void * ) ux );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadyDelete( UBaseType_t uxMembers )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxMembers; ux++ )
+    {
+        vReadyQueueSetRemoveMember( &( xReadyMembers[ ux ] ) );
+        vQueueDelete( xMemberQueues[ ux ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadySend( UBaseType_t uxMember )
+{
+    ( void ) xReadyQueueSetSend( &( xReadyMembers[ uxMember ] ), &uxMember, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadySendFromISR( UBaseType_t uxMember,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+{
+    ( void ) xReadyQueueSetSendFromISR( &( xReadyMembers[ uxMember ] ), &uxMember, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvReadyReceive( UBaseType_t uxMembers,
+                                    TickType_t xTicksToWait )
+{
+    ReadyQueueSetMember_t * pxMember;
+    UBaseType_t uxReceived = qsbNO_MEMBER;
+
+    ( void ) uxMembers;
+
+    pxMember = pxReadyQueueSetReceive( &xReadySet, &uxReceived, xTicksToWait );
+
+    if( pxMember != NULL )
+    {
+        /* The member carries its own index. */
+        configASSERT( uxReceived == ( UBaseType_t ) pvReadyQueueSetMemberGetID( pxMember ) );
+    }
+
+    return uxReceived;
+}
+/*-----------------------------------------------------------*/
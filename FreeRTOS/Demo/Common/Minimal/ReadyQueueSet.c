@@ -0,0 +1,311 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A queue set for a task that blocks on tens of queues and semaphores.
+ *
+ * A kernel queue set is itself a queue, as long as all of its members
+ * together, to which the handle of a member is copied each time an item is
+ * sent to the member.  Every event is therefore copied through two queues,
+ * and the task that selects from the set still has to find which of its
+ * members it was given, which the application usually does by comparing the
+ * handle with each of its queues in turn.
+ *
+ * Here the set is instead a list of the members that hold data, each member
+ * being in the list at most once.  Sending to a member links it to the end
+ * of the list, inside a short critical section, if it is not already there.
+ * Receiving takes the member at the front, receives one item from its queue
+ * and, if the queue still holds data, links the member back at the end, so
+ * members holding data are served in turn.  The member is returned to the
+ * caller, whose own data can be reached from its ID without a search.
+ * Sending, selecting and dispatching are therefore O(1) whatever the number
+ * of members, and the set needs no storage of its own.
+ *
+ * The receiving task waits on a direct to task notification, with index
+ * rqsNOTIFICATION_INDEX, which it must not use for anything else.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo program include files. */
+#include "ReadyQueueSet.h"
+
+#ifndef rqsNOTIFICATION_INDEX
+    #define rqsNOTIFICATION_INDEX    ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* Link the member to the end of the ready list if it is not in it already,
+ * and return the task to wake, if any.  Called from a critical section. */
+static TaskHandle_t prvListMember( ReadyQueueSetMember_t * pxMember );
+
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t prvListMember( ReadyQueueSetMember_t * pxMember )
+{
+    ReadyQueueSet_t * pxSet = pxMember->pxSet;
+    TaskHandle_t xTaskToWake;
+
+    if( pxMember->xListed == pdFALSE )
+    {
+        pxMember->xListed = pdTRUE;
+        pxMember->pxNext = NULL;
+
+        if( pxSet->pxTail == NULL )
+        {
+            pxSet->pxHead = pxMember;
+        }
+        else
+        {
+            pxSet->pxTail->pxNext = pxMember;
+        }
+
+        pxSet->pxTail = pxMember;
+    }
+
+    xTaskToWake = pxSet->xWaitingTask;
+    pxSet->xWaitingTask = NULL;
+
+    return xTaskToWake;
+}
+/*-----------------------------------------------------------*/
+
+void vReadyQueueSetInitialise( ReadyQueueSet_t * pxSet )
+{
+    pxSet->pxHead = NULL;
+    pxSet->pxTail = NULL;
+    pxSet->xWaitingTask = NULL;
+}
+/*-----------------------------------------------------------*/
+
+void vReadyQueueSetAddMember( ReadyQueueSet_t * pxSet,
+                              ReadyQueueSetMember_t * pxMember,
+                              QueueHandle_t xQueue,
+                              void * pvMemberID )
+{
+    TaskHandle_t xTaskToWake = NULL;
+
+    pxMember->pxNext = NULL;
+    pxMember->pxSet = pxSet;
+    pxMember->xQueue = xQueue;
+    pxMember->xListed = pdFALSE;
+    pxMember->pvMemberID = pvMemberID;
+
+    taskENTER_CRITICAL();
+    {
+        /* A queue that already holds data is ready straight away. */
+        if( uxQueueMessagesWaiting( xQueue ) > 0U )
+        {
+            xTaskToWake = prvListMember( pxMember );
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xTaskToWake != NULL )
+    {
+        xTaskNotifyGiveIndexed( xTaskToWake, rqsNOTIFICATION_INDEX );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vReadyQueueSetRemoveMember( ReadyQueueSetMember_t * pxMember )
+{
+    ReadyQueueSet_t * pxSet = pxMember->pxSet;
+    ReadyQueueSetMember_t * pxPrevious = NULL;
+    ReadyQueueSetMember_t * pxEntry;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxMember->xListed != pdFALSE )
+        {
+            for( pxEntry = pxSet->pxHead; pxEntry != pxMember; pxEntry = pxEntry->pxNext )
+            {
+                pxPrevious = pxEntry;
+            }
+
+            if( pxPrevious == NULL )
+            {
+                pxSet->pxHead = pxMember->pxNext;
+            }
+            else
+            {
+                pxPrevious->pxNext = pxMember->pxNext;
+            }
+
+            if( pxSet->pxTail == pxMember )
+            {
+                pxSet->pxTail = pxPrevious;
+            }
+
+            pxMember->xListed = pdFALSE;
+        }
+
+        pxMember->pxNext = NULL;
+        pxMember->pxSet = NULL;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xReadyQueueSetSend( ReadyQueueSetMember_t * pxMember,
+                               const void * pvItem,
+                               TickType_t xTicksToWait )
+{
+    TaskHandle_t xTaskToWake = NULL;
+    BaseType_t xReturn;
+
+    configASSERT( pxMember->pxSet != NULL );
+
+    xReturn = xQueueSendToBack( pxMember->xQueue, pvItem, xTicksToWait );
+
+    if( xReturn == pdPASS )
+    {
+        taskENTER_CRITICAL();
+        {
+            xTaskToWake = prvListMember( pxMember );
+        }
+        taskEXIT_CRITICAL();
+
+        if( xTaskToWake != NULL )
+        {
+            xTaskNotifyGiveIndexed( xTaskToWake, rqsNOTIFICATION_INDEX );
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xReadyQueueSetSendFromISR( ReadyQueueSetMember_t * pxMember,
+                                      const void * pvItem,
+                                      BaseType_t * pxHigherPriorityTaskWoken )
+{
+    TaskHandle_t xTaskToWake = NULL;
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t xReturn;
+
+    configASSERT( pxMember->pxSet != NULL );
+
+    xReturn = xQueueSendToBackFromISR( pxMember->xQueue, pvItem, pxHigherPriorityTaskWoken );
+
+    if( xReturn == pdPASS )
+    {
+        uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+        {
+            xTaskToWake = prvListMember( pxMember );
+        }
+        taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+        if( xTaskToWake != NULL )
+        {
+            vTaskNotifyGiveIndexedFromISR( xTaskToWake, rqsNOTIFICATION_INDEX, pxHigherPriorityTaskWoken );
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+ReadyQueueSetMember_t * pxReadyQueueSetReceive( ReadyQueueSet_t * pxSet,
+                                                void * pvBuffer,
+                                                TickType_t xTicksToWait )
+{
+    ReadyQueueSetMember_t * pxMember;
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        taskENTER_CRITICAL();
+        {
+            pxMember = pxSet->pxHead;
+
+            if( pxMember != NULL )
+            {
+                pxSet->pxHead = pxMember->pxNext;
+
+                if( pxSet->pxHead == NULL )
+                {
+                    pxSet->pxTail = NULL;
+                }
+
+                pxMember->xListed = pdFALSE;
+            }
+            else
+            {
+                /* Ask the next sender to wake this task. */
+                pxSet->xWaitingTask = xTaskGetCurrentTaskHandle();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pxMember != NULL )
+        {
+            /* The member can be listed with an empty queue if its sender was
+             * preempted between sending and listing it, while this task took
+             * the item, so try the next member if there is nothing to
+             * receive. */
+            if( xQueueReceive( pxMember->xQueue, pvBuffer, 0 ) == pdPASS )
+            {
+                taskENTER_CRITICAL();
+                {
+                    if( uxQueueMessagesWaiting( pxMember->xQueue ) > 0U )
+                    {
+                        /* Nobody is waiting, as this task is running. */
+                        ( void ) prvListMember( pxMember );
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                break;
+            }
+        }
+        else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+        {
+            taskENTER_CRITICAL();
+            {
+                pxSet->xWaitingTask = NULL;
+            }
+            taskEXIT_CRITICAL();
+
+            break;
+        }
+        else
+        {
+            /* A notification left from an earlier wait only causes another
+             * pass round the loop. */
+            ( void ) ulTaskNotifyTakeIndexed( rqsNOTIFICATION_INDEX, pdTRUE, xTicksToWait );
+        }
+    }
+
+    return pxMember;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,467 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Compares the cost of the ways one task can signal another, so the choice
+ * between them can be made from figures.  TaskNotify.c, TaskNotifyArray.c,
+ * semtest.c, BlockQ.c and the other demos test how each primitive behaves;
+ * this file only times them, using the same pattern for each.
+ *
+ * For each primitive in xPrimitives[] the initiator task first signals
+ * itself and takes the signal straight back sigbITERATIONS times, which is
+ * the cost of the API calls when no task has to be unblocked.  It then plays
+ * ping-pong with a responder task of higher priority sigbITERATIONS times:
+ * the initiator signals the responder and blocks, and the responder runs,
+ * signals the initiator back and blocks again.  Each round trip therefore
+ * includes two signals, two waits and two context switches.
+ *
+ * Times are read with sigbGET_TIME(), which defaults to the run time stats
+ * counter.  Define it to read a cycle counter for finer resolution.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "queue.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+
+/* Demo app includes. */
+#include "SignalBenchmark.h"
+
+#ifndef sigbGET_TIME
+    #define sigbGET_TIME()        ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+/* The number of round trips, and of uncontended signals, per primitive. */
+#ifndef sigbITERATIONS
+    #define sigbITERATIONS        ( 1000 )
+#endif
+
+#ifndef sigbSTACK_SIZE
+    #define sigbSTACK_SIZE        ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#define sigbINITIATOR_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define sigbRESPONDER_PRIORITY    ( tskIDLE_PRIORITY + 2 )
+
+/* A signal goes either to the responder or to the initiator. */
+#define sigbTO_RESPONDER          ( ( UBaseType_t ) 0 )
+#define sigbTO_INITIATOR          ( ( UBaseType_t ) 1 )
+
+/* The notification index used by the indexed primitive, which is the last so
+ * it differs from the index used by the non-indexed API. */
+#define sigbNOTIFY_INDEX          ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+
+#define sigbARRAY_LENGTH( x )     ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* One way of signalling.  xWait() returns pdFALSE if xTicksToWait passed
+ * without a signal. */
+typedef struct SignalPrimitive
+{
+    const char * pcName;
+    void ( * vCreate )( void );
+    void ( * vDelete )( void );
+    void ( * vSignal )( UBaseType_t uxTo );
+    BaseType_t ( * xWait )( UBaseType_t uxTo,
+                            TickType_t xTicksToWait );
+} SignalPrimitive_t;
+
+static void prvNoObjects( void );
+
+static void prvNotifySignal( UBaseType_t uxTo );
+static BaseType_t prvNotifyWait( UBaseType_t uxTo,
+                                 TickType_t xTicksToWait );
+
+#if ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 )
+    static void prvNotifyIndexedSignal( UBaseType_t uxTo );
+    static BaseType_t prvNotifyIndexedWait( UBaseType_t uxTo,
+                                            TickType_t xTicksToWait );
+#endif
+
+static void prvBinarySemaphoreCreate( void );
+#if ( configUSE_COUNTING_SEMAPHORES == 1 )
+    static void prvCountingSemaphoreCreate( void );
+#endif
+static void prvSemaphoreDelete( void );
+static void prvSemaphoreSignal( UBaseType_t uxTo );
+static BaseType_t prvSemaphoreWait( UBaseType_t uxTo,
+                                    TickType_t xTicksToWait );
+
+static void prvQueueCreate( void );
+static void prvQueueDelete( void );
+static void prvQueueSignal( UBaseType_t uxTo );
+static BaseType_t prvQueueWait( UBaseType_t uxTo,
+                                TickType_t xTicksToWait );
+
+static void prvEventGroupCreate( void );
+static void prvEventGroupDelete( void );
+static void prvEventGroupSignal( UBaseType_t uxTo );
+static BaseType_t prvEventGroupWait( UBaseType_t uxTo,
+                                     TickType_t xTicksToWait );
+
+static void prvStreamBufferCreate( void );
+static void prvStreamBufferDelete( void );
+static void prvStreamBufferSignal( UBaseType_t uxTo );
+static BaseType_t prvStreamBufferWait( UBaseType_t uxTo,
+                                       TickType_t xTicksToWait );
+
+/* Times each primitive in turn. */
+static void prvInitiatorTask( void * pvParameters );
+
+/* Created for each primitive, and deletes itself after sigbITERATIONS round
+ * trips. */
+static void prvResponderTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static const SignalPrimitive_t xPrimitives[] =
+{
+    { "notify", prvNoObjects, prvNoObjects, prvNotifySignal, prvNotifyWait },
+    #if ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 )
+        { "notify indexed", prvNoObjects, prvNoObjects, prvNotifyIndexedSignal, prvNotifyIndexedWait },
+    #endif
+    { "binary semaphore", prvBinarySemaphoreCreate, prvSemaphoreDelete, prvSemaphoreSignal, prvSemaphoreWait },
+    #if ( configUSE_COUNTING_SEMAPHORES == 1 )
+        { "counting semaphore", prvCountingSemaphoreCreate, prvSemaphoreDelete, prvSemaphoreSignal, prvSemaphoreWait },
+    #endif
+    { "queue", prvQueueCreate, prvQueueDelete, prvQueueSignal, prvQueueWait },
+    { "event group", prvEventGroupCreate, prvEventGroupDelete, prvEventGroupSignal, prvEventGroupWait },
+    { "stream buffer", prvStreamBufferCreate, prvStreamBufferDelete, prvStreamBufferSignal, prvStreamBufferWait }
+};
+
+/* One object per direction, except for the event group, which uses one bit
+ * per direction. */
+static SemaphoreHandle_t xSemaphores[ 2 ];
+static QueueHandle_t xQueues[ 2 ];
+static EventGroupHandle_t xEventGroup;
+static StreamBufferHandle_t xStreamBuffers[ 2 ];
+
+static TaskHandle_t xTasks[ 2 ];
+
+/* The primitive the responder is to use. */
+static const SignalPrimitive_t * pxResponderPrimitive = NULL;
+
+static SignalBenchmarkResult_t xResults[ sigbARRAY_LENGTH( xPrimitives ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartSignalBenchmark( void )
+{
+    xTaskCreate( prvInitiatorTask, "SigInit", sigbSTACK_SIZE, NULL, sigbINITIATOR_PRIORITY, &( xTasks[ sigbTO_INITIATOR ] ) );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsSignalBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetSignalBenchmarkResults( const SignalBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitiatorTask( void * pvParameters )
+{
+    const SignalPrimitive_t * pxPrimitive;
+    SignalBenchmarkResult_t * pxResult;
+    uint32_t ulStart, ulTime, ulIteration;
+    uint64_t ullTotal;
+    UBaseType_t uxPrimitive;
+    BaseType_t xTaken;
+
+    ( void ) pvParameters;
+
+    for( uxPrimitive = 0; uxPrimitive < sigbARRAY_LENGTH( xPrimitives ); uxPrimitive++ )
+    {
+        pxPrimitive = &( xPrimitives[ uxPrimitive ] );
+        pxResult = &( xResults[ uxPrimitive ] );
+        pxResult->pcPrimitive = pxPrimitive->pcName;
+        pxPrimitive->vCreate();
+
+        /* The uncontended cost, with this task signalling itself. */
+        ulStart = sigbGET_TIME();
+
+        for( ulIteration = 0; ulIteration < sigbITERATIONS; ulIteration++ )
+        {
+            pxPrimitive->vSignal( sigbTO_INITIATOR );
+            xTaken = pxPrimitive->xWait( sigbTO_INITIATOR, 0 );
+            configASSERT( xTaken != pdFALSE );
+            ( void ) xTaken;
+        }
+
+        pxResult->ulAverageCost = ( sigbGET_TIME() - ulStart ) / sigbITERATIONS;
+
+        /* The round trips.  The responder runs as soon as it is created, and
+         * blocks waiting for the first signal. */
+        pxResponderPrimitive = pxPrimitive;
+        xTaskCreate( prvResponderTask, "SigResp", sigbSTACK_SIZE, NULL, sigbRESPONDER_PRIORITY, &( xTasks[ sigbTO_RESPONDER ] ) );
+
+        ullTotal = 0;
+        pxResult->ulMinRoundTrip = UINT32_MAX;
+        pxResult->ulMaxRoundTrip = 0;
+
+        for( ulIteration = 0; ulIteration < sigbITERATIONS; ulIteration++ )
+        {
+            ulStart = sigbGET_TIME();
+            pxPrimitive->vSignal( sigbTO_RESPONDER );
+            ( void ) pxPrimitive->xWait( sigbTO_INITIATOR, portMAX_DELAY );
+            ulTime = sigbGET_TIME() - ulStart;
+
+            ullTotal += ulTime;
+
+            if( ulTime < pxResult->ulMinRoundTrip )
+            {
+                pxResult->ulMinRoundTrip = ulTime;
+            }
+
+            if( ulTime > pxResult->ulMaxRoundTrip )
+            {
+                pxResult->ulMaxRoundTrip = ulTime;
+            }
+        }
+
+        pxResult->ulAverageRoundTrip = ( uint32_t ) ( ullTotal / sigbITERATIONS );
+
+        /* The responder deleted itself after the last round trip.  Let the
+         * idle task free it before the objects it used are deleted. */
+        vTaskDelay( 1 );
+        pxPrimitive->vDelete();
+        uxResultCount++;
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvResponderTask( void * pvParameters )
+{
+    const SignalPrimitive_t * pxPrimitive = pxResponderPrimitive;
+    uint32_t ulIteration;
+
+    ( void ) pvParameters;
+
+    for( ulIteration = 0; ulIteration < sigbITERATIONS; ulIteration++ )
+    {
+        ( void ) pxPrimitive->xWait( sigbTO_RESPONDER, portMAX_DELAY );
+        pxPrimitive->vSignal( sigbTO_INITIATOR );
+    }
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvNoObjects( void )
+{
+    /* Notifications need no objects. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvNotifySignal( UBaseType_t uxTo )
+{
+    xTaskNotifyGive( xTasks[ uxTo ] );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNotifyWait( UBaseType_t uxTo,
+                                 TickType_t xTicksToWait )
+{
+    /* A task only waits for signals sent to itself. */
+    ( void ) uxTo;
+
+    return ( ulTaskNotifyTake( pdTRUE, xTicksToWait ) != 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 )
+
+    static void prvNotifyIndexedSignal( UBaseType_t uxTo )
+    {
+        xTaskNotifyGiveIndexed( xTasks[ uxTo ], sigbNOTIFY_INDEX );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvNotifyIndexedWait( UBaseType_t uxTo,
+                                            TickType_t xTicksToWait )
+    {
+        ( void ) uxTo;
+
+        return ( ulTaskNotifyTakeIndexed( sigbNOTIFY_INDEX, pdTRUE, xTicksToWait ) != 0 ) ? pdTRUE : pdFALSE;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 */
+
+static void prvBinarySemaphoreCreate( void )
+{
+    xSemaphores[ sigbTO_RESPONDER ] = xSemaphoreCreateBinary();
+    xSemaphores[ sigbTO_INITIATOR ] = xSemaphoreCreateBinary();
+    configASSERT( xSemaphores[ sigbTO_RESPONDER ] );
+    configASSERT( xSemaphores[ sigbTO_INITIATOR ] );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_COUNTING_SEMAPHORES == 1 )
+
+    static void prvCountingSemaphoreCreate( void )
+    {
+        xSemaphores[ sigbTO_RESPONDER ] = xSemaphoreCreateCounting( sigbITERATIONS, 0 );
+        xSemaphores[ sigbTO_INITIATOR ] = xSemaphoreCreateCounting( sigbITERATIONS, 0 );
+        configASSERT( xSemaphores[ sigbTO_RESPONDER ] );
+        configASSERT( xSemaphores[ sigbTO_INITIATOR ] );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_COUNTING_SEMAPHORES == 1 */
+
+static void prvSemaphoreDelete( void )
+{
+    vSemaphoreDelete( xSemaphores[ sigbTO_RESPONDER ] );
+    vSemaphoreDelete( xSemaphores[ sigbTO_INITIATOR ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSemaphoreSignal( UBaseType_t uxTo )
+{
+    ( void ) xSemaphoreGive( xSemaphores[ uxTo ] );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSemaphoreWait( UBaseType_t uxTo,
+                                    TickType_t xTicksToWait )
+{
+    return xSemaphoreTake( xSemaphores[ uxTo ], xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueCreate( void )
+{
+    xQueues[ sigbTO_RESPONDER ] = xQueueCreate( 1, sizeof( uint8_t ) );
+    xQueues[ sigbTO_INITIATOR ] = xQueueCreate( 1, sizeof( uint8_t ) );
+    configASSERT( xQueues[ sigbTO_RESPONDER ] );
+    configASSERT( xQueues[ sigbTO_INITIATOR ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueDelete( void )
+{
+    vQueueDelete( xQueues[ sigbTO_RESPONDER ] );
+    vQueueDelete( xQueues[ sigbTO_INITIATOR ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueueSignal( UBaseType_t uxTo )
+{
+    const uint8_t ucValue = 0;
+
+    ( void ) xQueueSend( xQueues[ uxTo ], &ucValue, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvQueueWait( UBaseType_t uxTo,
+                                TickType_t xTicksToWait )
+{
+    uint8_t ucValue;
+
+    return xQueueReceive( xQueues[ uxTo ], &ucValue, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventGroupCreate( void )
+{
+    xEventGroup = xEventGroupCreate();
+    configASSERT( xEventGroup );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventGroupDelete( void )
+{
+    vEventGroupDelete( xEventGroup );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEventGroupSignal( UBaseType_t uxTo )
+{
+    ( void ) xEventGroupSetBits( xEventGroup, ( EventBits_t ) 1 << uxTo );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEventGroupWait( UBaseType_t uxTo,
+                                     TickType_t xTicksToWait )
+{
+    const EventBits_t uxBit = ( EventBits_t ) 1 << uxTo;
+
+    return ( ( xEventGroupWaitBits( xEventGroup, uxBit, pdTRUE, pdTRUE, xTicksToWait ) & uxBit ) != 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamBufferCreate( void )
+{
+    /* One byte per signal, with a trigger level of one byte. */
+    xStreamBuffers[ sigbTO_RESPONDER ] = xStreamBufferCreate( 1, 1 );
+    xStreamBuffers[ sigbTO_INITIATOR ] = xStreamBufferCreate( 1, 1 );
+    configASSERT( xStreamBuffers[ sigbTO_RESPONDER ] );
+    configASSERT( xStreamBuffers[ sigbTO_INITIATOR ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamBufferDelete( void )
+{
+    vStreamBufferDelete( xStreamBuffers[ sigbTO_RESPONDER ] );
+    vStreamBufferDelete( xStreamBuffers[ sigbTO_INITIATOR ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamBufferSignal( UBaseType_t uxTo )
+{
+    const uint8_t ucValue = 0;
+
+    ( void ) xStreamBufferSend( xStreamBuffers[ uxTo ], &ucValue, sizeof( ucValue ), 0 );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStreamBufferWait( UBaseType_t uxTo,
+                                       TickType_t xTicksToWait )
+{
+    uint8_t ucValue;
+
+    return ( xStreamBufferReceive( xStreamBuffers[ uxTo ], &ucValue, sizeof( ucValue ), xTicksToWait ) != 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
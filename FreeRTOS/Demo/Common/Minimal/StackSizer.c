@@ -0,0 +1,330 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Recommends the stack depth to create each task with, and the size of the
+ * heap, from what they actually used while the application ran.  Run the
+ * application through a soak with vStartStackSizer(), then read the
+ * recommendations, which are the most used plus a safety margin, from
+ * ulStackSizerGetTasks() or the stack-sizes command of the sample CLI
+ * commands.
+ *
+ * The kernel's stack high water mark is already the least a task has had
+ * free since it was created, but it is lost when the task is deleted, so the
+ * tasks are sampled periodically.  A task created with the same name and
+ * depth as one that was deleted, as the tasks created by death.c in the full
+ * demos are, shares its record, so the recommendation covers every instance.
+ * The depth of each task is learnt from traceTASK_CREATE(), defined in
+ * StackSizer.h, so up to stkszMAX_TASKS tasks are recorded.  A task that is
+ * created and deleted between two samples is recorded but not measured.
+ *
+ * Stack use is as high as the deepest call chain that ran during the soak,
+ * so the soak must exercise every path, including error paths, and the
+ * margin covers what it did not.  The sizer takes its own critical sections
+ * so only supports single core ports.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo program include files. */
+#include "StackSizer.h"
+
+#if ( configUSE_STACK_SIZER == 1 )
+
+    #if ( configUSE_TRACE_FACILITY != 1 )
+        #error The stack sizer uses uxTaskGetSystemState(), so needs configUSE_TRACE_FACILITY set to 1.
+    #endif
+
+/* Recommended stack depths are rounded up to a multiple of this many
+ * words. */
+    #ifndef stkszDEPTH_ALIGNMENT
+        #define stkszDEPTH_ALIGNMENT    8
+    #endif
+
+    #ifndef stkszTASK_PRIORITY
+        #define stkszTASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+    #endif
+
+    #ifndef stkszTASK_STACK_SIZE
+        #define stkszTASK_STACK_SIZE    configMINIMAL_STACK_SIZE
+    #endif
+
+    #if ( stkszINCLUDE_HEAP == 1 )
+        #ifndef stkszHEAP_SIZE
+            #define stkszHEAP_SIZE    configTOTAL_HEAP_SIZE
+        #endif
+    #endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task started by vStartStackSizer().
+ */
+static void prvStackSizerTask( void * pvParameters );
+
+/*
+ * Returns the record of a task that exists, or NULL.
+ */
+static StackSizerTask_t * prvFindTask( void * pvTask );
+
+/*-----------------------------------------------------------*/
+
+static StackSizerTask_t xTasks[ stkszMAX_TASKS ];
+static UBaseType_t uxTasks = 0;
+static uint32_t ulUntracked = 0;
+
+/* The period of the task started by vStartStackSizer(). */
+static TickType_t xSamplePeriod;
+
+/* The state of every task, filled in by each sample. */
+static TaskStatus_t xStatus[ stkszMAX_TASKS ];
+
+/*-----------------------------------------------------------*/
+
+static StackSizerTask_t * prvFindTask( void * pvTask )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        if( xTasks[ ux ].pvTask == pvTask )
+        {
+            return &( xTasks[ ux ] );
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+void vStackSizerTaskCreated( void * pvTask,
+                             const char * pcName,
+                             uint32_t ulDepth )
+{
+    StackSizerTask_t * pxTask;
+    UBaseType_t ux;
+
+    taskENTER_CRITICAL();
+    {
+        /* A record with this handle belongs to a task that has been deleted,
+         * and whose memory has been given to the new one. */
+        pxTask = prvFindTask( pvTask );
+
+        if( pxTask != NULL )
+        {
+            pxTask->pvTask = NULL;
+            pxTask = NULL;
+        }
+
+        for( ux = 0; ux < uxTasks; ux++ )
+        {
+            if( ( xTasks[ ux ].pvTask == NULL ) &&
+                ( xTasks[ ux ].ulDepth == ulDepth ) &&
+                ( strncmp( xTasks[ ux ].cName, pcName, configMAX_TASK_NAME_LEN ) == 0 ) )
+            {
+                pxTask = &( xTasks[ ux ] );
+                break;
+            }
+        }
+
+        if( ( pxTask == NULL ) && ( uxTasks < stkszMAX_TASKS ) )
+        {
+            pxTask = &( xTasks[ uxTasks ] );
+            uxTasks++;
+
+            strncpy( pxTask->cName, pcName, configMAX_TASK_NAME_LEN );
+            pxTask->cName[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+            pxTask->ulDepth = ulDepth;
+            pxTask->ulMinimumFree = ulDepth;
+            pxTask->ulSamples = 0;
+        }
+
+        if( pxTask != NULL )
+        {
+            pxTask->pvTask = pvTask;
+        }
+        else
+        {
+            ulUntracked++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vStackSizerSample( void )
+{
+    StackSizerTask_t * pxTask;
+    UBaseType_t uxStatus, ux, uxTask;
+
+    /* With the scheduler suspended no task can be created or deleted between
+     * taking the state of the tasks and matching it to the records. */
+    vTaskSuspendAll();
+    {
+        uxStatus = uxTaskGetSystemState( xStatus, stkszMAX_TASKS, NULL );
+
+        /* uxTaskGetSystemState() returns 0 if there are more tasks than
+         * xStatus can hold, in which case nothing is known. */
+        if( uxStatus != 0 )
+        {
+            for( uxTask = 0; uxTask < uxTasks; uxTask++ )
+            {
+                pxTask = &( xTasks[ uxTask ] );
+
+                if( pxTask->pvTask != NULL )
+                {
+                    for( ux = 0; ux < uxStatus; ux++ )
+                    {
+                        if( ( void * ) xStatus[ ux ].xHandle == pxTask->pvTask )
+                        {
+                            break;
+                        }
+                    }
+
+                    if( ux < uxStatus )
+                    {
+                        if( ( uint32_t ) xStatus[ ux ].usStackHighWaterMark < pxTask->ulMinimumFree )
+                        {
+                            pxTask->ulMinimumFree = ( uint32_t ) xStatus[ ux ].usStackHighWaterMark;
+                        }
+
+                        pxTask->ulSamples++;
+                    }
+                    else
+                    {
+                        /* The task has been deleted. */
+                        pxTask->pvTask = NULL;
+                    }
+                }
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulStackSizerGetTasks( StackSizerTask_t * pxTasks,
+                               uint32_t ulMaxTasks )
+{
+    uint32_t ulCount;
+
+    vStackSizerSample();
+
+    taskENTER_CRITICAL();
+    {
+        ulCount = ( ( uint32_t ) uxTasks < ulMaxTasks ) ? ( uint32_t ) uxTasks : ulMaxTasks;
+        memcpy( pxTasks, xTasks, ulCount * sizeof( StackSizerTask_t ) );
+    }
+    taskEXIT_CRITICAL();
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulStackSizerGetUntracked( void )
+{
+    return ulUntracked;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulStackSizerRecommendedDepth( const StackSizerTask_t * pxTask,
+                                       uint32_t ulMarginPercent )
+{
+    uint32_t ulUsed, ulDepth = 0;
+
+    if( pxTask->ulSamples != 0 )
+    {
+        ulUsed = pxTask->ulDepth - pxTask->ulMinimumFree;
+        ulDepth = ulUsed + ( ( ( ulUsed * ulMarginPercent ) + 99UL ) / 100UL );
+        ulDepth = ( ( ulDepth + stkszDEPTH_ALIGNMENT - 1UL ) / stkszDEPTH_ALIGNMENT ) * stkszDEPTH_ALIGNMENT;
+    }
+
+    return ulDepth;
+}
+/*-----------------------------------------------------------*/
+
+    #if ( stkszINCLUDE_HEAP == 1 )
+
+        uint32_t ulStackSizerHeapSize( void )
+        {
+            return ( uint32_t ) stkszHEAP_SIZE;
+        }
+/*-----------------------------------------------------------*/
+
+        uint32_t ulStackSizerHeapMinimumEverFree( void )
+        {
+            return ( uint32_t ) xPortGetMinimumEverFreeHeapSize();
+        }
+/*-----------------------------------------------------------*/
+
+        uint32_t ulStackSizerRecommendedHeapSize( uint32_t ulMarginPercent )
+        {
+            uint32_t ulUsed, ulSize;
+
+            ulUsed = ulStackSizerHeapSize() - ulStackSizerHeapMinimumEverFree();
+            ulSize = ulUsed + ( ( ( ulUsed * ulMarginPercent ) + 99UL ) / 100UL );
+
+            return ( ulSize + portBYTE_ALIGNMENT - 1UL ) & ~( ( uint32_t ) portBYTE_ALIGNMENT_MASK );
+        }
+
+    #endif /* stkszINCLUDE_HEAP */
+/*-----------------------------------------------------------*/
+
+void vStartStackSizer( uint32_t ulPeriodMs )
+{
+    xSamplePeriod = pdMS_TO_TICKS( ulPeriodMs );
+
+    xTaskCreate( prvStackSizerTask,
+                 "StkSize",
+                 stkszTASK_STACK_SIZE,
+                 NULL,
+                 stkszTASK_PRIORITY,
+                 NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStackSizerTask( void * pvParameters )
+{
+    TickType_t xLastWakeTime;
+
+    /* Just to remove compiler warnings. */
+    ( void ) pvParameters;
+
+    xLastWakeTime = xTaskGetTickCount();
+
+    for( ; ; )
+    {
+        vTaskDelayUntil( &xLastWakeTime, xSamplePeriod );
+        vStackSizerSample();
+    }
+}
+
+#endif /* configUSE_STACK_SIZER */
@@ -0,0 +1,382 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures stream and message buffer throughput, rather than testing their
+ * behaviour as StreamBufferDemo.c and MessageBufferDemo.c do, so buffer
+ * lengths, trigger levels and write sizes can be chosen from figures.
+ *
+ * A control task sweeps every combination of the lengths in
+ * xBenchmarkBufferSizes[], the trigger levels in uxBenchmarkTriggerQuarters[]
+ * and the write sizes in xBenchmarkChunkSizes[], once with a task writing the
+ * buffer and once with an interrupt writing it, first for stream buffers and
+ * then for message buffers.  Each combination runs for sbbCASE_DURATION_MS,
+ * during which a reader task at a higher priority than the writer counts the
+ * bytes it receives and the number of times it had to block for them.
+ *
+ * The interrupt side is vStreamBufferBenchmarkFromISR(), which must be called
+ * from a periodic interrupt, such as the tick hook, and writes up to
+ * sbbISR_BYTES_PER_INTERRUPT bytes each time it runs.  The interrupt-to-task
+ * throughput is therefore bounded by the interrupt rate.
+ *
+ * The results are read with uxGetStreamBufferBenchmarkResults() once
+ * xIsStreamBufferBenchmarkComplete() returns pdTRUE.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+/* Demo app includes. */
+#include "StreamBufferBenchmark.h"
+
+/* How long each combination runs for. */
+#ifndef sbbCASE_DURATION_MS
+    #define sbbCASE_DURATION_MS           ( 250 )
+#endif
+
+/* The most bytes vStreamBufferBenchmarkFromISR() writes each time it runs. */
+#ifndef sbbISR_BYTES_PER_INTERRUPT
+    #define sbbISR_BYTES_PER_INTERRUPT    ( 256 )
+#endif
+
+#ifndef sbbSTACK_SIZE
+    #define sbbSTACK_SIZE                 ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/* The reader runs above the writer, so it is woken as soon as the trigger
+ * level is reached, and the control task runs above both. */
+#define sbbWRITER_PRIORITY                ( tskIDLE_PRIORITY + 1 )
+#define sbbREADER_PRIORITY                ( tskIDLE_PRIORITY + 2 )
+#define sbbCONTROL_PRIORITY               ( tskIDLE_PRIORITY + 3 )
+
+/* The longest time a task blocks on the buffer, so it notices the end of a
+ * combination even when nothing more is written. */
+#define sbbBLOCK_TIME                     pdMS_TO_TICKS( 10 )
+
+#define sbbMODE_STREAM_TASK               ( ( UBaseType_t ) 0 )
+#define sbbMODE_STREAM_ISR                ( ( UBaseType_t ) 1 )
+#define sbbMODE_MESSAGE_TASK              ( ( UBaseType_t ) 2 )
+#define sbbMODE_MESSAGE_ISR               ( ( UBaseType_t ) 3 )
+#define sbbNUM_MODES                      ( 4 )
+
+#define sbbARRAY_LENGTH( x )              ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* The parameters that are swept.  A trigger level is a number of quarters of
+ * the buffer length, where 0 means a trigger level of 1 byte. */
+static const size_t xBenchmarkBufferSizes[] = { 64, 256, 1024 };
+static const UBaseType_t uxBenchmarkTriggerQuarters[] = { 0, 1, 2, 3 };
+static const size_t xBenchmarkChunkSizes[] = { 1, 8, 32 };
+
+static const char * const pcBenchmarkModeNames[ sbbNUM_MODES ] =
+{
+    "stream task",
+    "stream ISR",
+    "message task",
+    "message ISR"
+};
+
+/* Room for every combination, although message buffers only use one trigger
+ * level. */
+static StreamBufferBenchmarkResult_t xResults[ sbbNUM_MODES *
+                                               sbbARRAY_LENGTH( xBenchmarkBufferSizes ) *
+                                               sbbARRAY_LENGTH( uxBenchmarkTriggerQuarters ) *
+                                               sbbARRAY_LENGTH( xBenchmarkChunkSizes ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/* The buffer of the combination being run, and what is written to it. */
+static StreamBufferHandle_t xBenchmarkBuffer = NULL;
+static size_t xCurrentChunkSize = 0, xCurrentTriggerLevel = 0;
+static BaseType_t xCurrentIsMessageBuffer = pdFALSE;
+
+/* Only non-NULL while the interrupt should write to the buffer. */
+static volatile StreamBufferHandle_t xISRBuffer = NULL;
+
+/* Cleared by the control task to end a combination. */
+static volatile BaseType_t xCaseRunning = pdFALSE;
+
+/* Counted by the reader during a combination. */
+static uint32_t ulBytesReceived = 0, ulWakeUps = 0;
+
+/* Written to the buffers, and read from them. */
+static uint8_t ucTxData[ 32 ];
+static uint8_t ucRxData[ 1024 ];
+
+static TaskHandle_t xControlTask = NULL, xReaderTask = NULL, xWriterTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+/* Runs the sweep. */
+static void prvControlTask( void * pvParameters );
+
+/* Run one combination and record its result. */
+static void prvRunCase( UBaseType_t uxMode,
+                        size_t xBufferSize,
+                        size_t xTriggerLevel,
+                        size_t xChunkSize );
+
+/* Read from and write to the buffer for as long as a combination runs. */
+static void prvReaderTask( void * pvParameters );
+static void prvWriterTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+void vStartStreamBufferBenchmark( void )
+{
+    configASSERT( xBenchmarkChunkSizes[ sbbARRAY_LENGTH( xBenchmarkChunkSizes ) - 1 ] <= sizeof( ucTxData ) );
+    configASSERT( xBenchmarkBufferSizes[ sbbARRAY_LENGTH( xBenchmarkBufferSizes ) - 1 ] <= sizeof( ucRxData ) );
+
+    xTaskCreate( prvReaderTask, "SBBRx", sbbSTACK_SIZE, NULL, sbbREADER_PRIORITY, &xReaderTask );
+    xTaskCreate( prvWriterTask, "SBBTx", sbbSTACK_SIZE, NULL, sbbWRITER_PRIORITY, &xWriterTask );
+    xTaskCreate( prvControlTask, "SBBCtl", sbbSTACK_SIZE, NULL, sbbCONTROL_PRIORITY, &xControlTask );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsStreamBufferBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetStreamBufferBenchmarkResults( const StreamBufferBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferBenchmarkFromISR( void )
+{
+    StreamBufferHandle_t xBuffer = xISRBuffer;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    size_t xWritten = 0;
+
+    if( xBuffer != NULL )
+    {
+        while( ( xWritten + xCurrentChunkSize ) <= sbbISR_BYTES_PER_INTERRUPT )
+        {
+            if( xStreamBufferSendFromISR( xBuffer, ucTxData, xCurrentChunkSize, &xHigherPriorityTaskWoken ) != xCurrentChunkSize )
+            {
+                /* The buffer is full. */
+                break;
+            }
+
+            xWritten += xCurrentChunkSize;
+        }
+
+        portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void * pvParameters )
+{
+    size_t xSize, xTrigger, xChunk;
+    UBaseType_t uxMode, uxTrigger;
+
+    ( void ) pvParameters;
+
+    for( uxMode = 0; uxMode < sbbNUM_MODES; uxMode++ )
+    {
+        for( xSize = 0; xSize < sbbARRAY_LENGTH( xBenchmarkBufferSizes ); xSize++ )
+        {
+            for( uxTrigger = 0; uxTrigger < sbbARRAY_LENGTH( uxBenchmarkTriggerQuarters ); uxTrigger++ )
+            {
+                xTrigger = ( xBenchmarkBufferSizes[ xSize ] * uxBenchmarkTriggerQuarters[ uxTrigger ] ) / 4U;
+
+                if( uxMode >= sbbMODE_MESSAGE_TASK )
+                {
+                    /* Message buffers have no trigger level. */
+                    if( uxTrigger > 0 )
+                    {
+                        break;
+                    }
+
+                    xTrigger = 0;
+                }
+                else if( xTrigger == 0 )
+                {
+                    xTrigger = 1;
+                }
+
+                for( xChunk = 0; xChunk < sbbARRAY_LENGTH( xBenchmarkChunkSizes ); xChunk++ )
+                {
+                    prvRunCase( uxMode, xBenchmarkBufferSizes[ xSize ], xTrigger, xBenchmarkChunkSizes[ xChunk ] );
+                }
+            }
+        }
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunCase( UBaseType_t uxMode,
+                        size_t xBufferSize,
+                        size_t xTriggerLevel,
+                        size_t xChunkSize )
+{
+    StreamBufferBenchmarkResult_t * pxResult;
+    BaseType_t xFromISR = ( ( uxMode == sbbMODE_STREAM_ISR ) || ( uxMode == sbbMODE_MESSAGE_ISR ) ) ? pdTRUE : pdFALSE;
+    TickType_t xStartTime, xElapsed;
+
+    xCurrentIsMessageBuffer = ( uxMode >= sbbMODE_MESSAGE_TASK ) ? pdTRUE : pdFALSE;
+
+    if( ( xCurrentIsMessageBuffer != pdFALSE ) && ( ( xChunkSize + sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) ) > xBufferSize ) )
+    {
+        /* The message does not fit. */
+        return;
+    }
+
+    if( xCurrentIsMessageBuffer != pdFALSE )
+    {
+        xBenchmarkBuffer = xMessageBufferCreate( xBufferSize );
+    }
+    else
+    {
+        xBenchmarkBuffer = xStreamBufferCreate( xBufferSize, xTriggerLevel );
+    }
+
+    configASSERT( xBenchmarkBuffer );
+
+    xCurrentChunkSize = xChunkSize;
+    xCurrentTriggerLevel = xTriggerLevel;
+    ulBytesReceived = 0;
+    ulWakeUps = 0;
+    xCaseRunning = pdTRUE;
+    xStartTime = xTaskGetTickCount();
+
+    xTaskNotifyGive( xReaderTask );
+
+    if( xFromISR != pdFALSE )
+    {
+        xISRBuffer = xBenchmarkBuffer;
+    }
+    else
+    {
+        xTaskNotifyGive( xWriterTask );
+    }
+
+    vTaskDelay( pdMS_TO_TICKS( sbbCASE_DURATION_MS ) );
+
+    /* A task cannot run while the interrupt is part way through a write,
+     * so the interrupt is finished with the buffer once this is cleared. */
+    xISRBuffer = NULL;
+    xCaseRunning = pdFALSE;
+    xElapsed = xTaskGetTickCount() - xStartTime;
+
+    /* Wait for the reader, and the writer if it was used, to stop.  Each
+     * take only consumes one notification, as both might already be pending. */
+    ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+
+    if( xFromISR == pdFALSE )
+    {
+        ( void ) ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+    }
+
+    vStreamBufferDelete( xBenchmarkBuffer );
+    xBenchmarkBuffer = NULL;
+
+    configASSERT( uxResultCount < sbbARRAY_LENGTH( xResults ) );
+    pxResult = &( xResults[ uxResultCount ] );
+    pxResult->pcMode = pcBenchmarkModeNames[ uxMode ];
+    pxResult->xBufferSize = xBufferSize;
+    pxResult->xTriggerLevel = xTriggerLevel;
+    pxResult->xChunkSize = xChunkSize;
+    pxResult->ulBytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) ulBytesReceived * configTICK_RATE_HZ ) / ( ( xElapsed > 0 ) ? xElapsed : 1 ) );
+    pxResult->ulWakeUpsPerMB = ( ulBytesReceived > 0 ) ? ( uint32_t ) ( ( ( uint64_t ) ulWakeUps << 20 ) / ulBytesReceived ) : 0;
+    uxResultCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReaderTask( void * pvParameters )
+{
+    size_t xReceived;
+    BaseType_t xWillBlock;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        while( xCaseRunning != pdFALSE )
+        {
+            /* Only count the reads that have to wait for the writer. */
+            if( xCurrentIsMessageBuffer != pdFALSE )
+            {
+                xWillBlock = xMessageBufferIsEmpty( xBenchmarkBuffer );
+            }
+            else
+            {
+                xWillBlock = ( xStreamBufferBytesAvailable( xBenchmarkBuffer ) < xCurrentTriggerLevel ) ? pdTRUE : pdFALSE;
+            }
+
+            xReceived = xStreamBufferReceive( xBenchmarkBuffer, ucRxData, sizeof( ucRxData ), sbbBLOCK_TIME );
+
+            if( ( xReceived > 0 ) && ( xCaseRunning != pdFALSE ) )
+            {
+                ulBytesReceived += ( uint32_t ) xReceived;
+
+                if( xWillBlock != pdFALSE )
+                {
+                    ulWakeUps++;
+                }
+            }
+        }
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriterTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        while( xCaseRunning != pdFALSE )
+        {
+            ( void ) xStreamBufferSend( xBenchmarkBuffer, ucTxData, xCurrentChunkSize, sbbBLOCK_TIME );
+        }
+
+        xTaskNotifyGive( xControlTask );
+    }
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,268 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Exports task statistics as compact CBOR records instead of the text tables
+ * of vTaskList() and vTaskGetRunTimeStats(), so they can be collected every
+ * few seconds and sent as telemetry.  The format is described in
+ * TaskStatsExport.h.
+ *
+ * The scheduler is only suspended while uxTaskGetSystemState() copies the
+ * task states, which does no formatting.  The records are then encoded with
+ * the scheduler running.  To produce deltas the run time of every task in the
+ * last sample is kept, keyed by task number, so configUSE_TRACE_FACILITY must
+ * be 1.  Run times are only meaningful if configGENERATE_RUN_TIME_STATS is
+ * also 1, otherwise they are 0.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo program include files. */
+#include "TaskStatsExport.h"
+
+/* The most tasks a sample can hold. */
+#ifndef tsexpMAX_TASKS
+    #define tsexpMAX_TASKS    32
+#endif
+
+/* CBOR major types and simple values. */
+#define tsexpCBOR_UNSIGNED    ( 0U << 5U )
+#define tsexpCBOR_TEXT        ( 3U << 5U )
+#define tsexpCBOR_ARRAY       ( 4U << 5U )
+#define tsexpCBOR_FALSE       ( 0xf4U )
+#define tsexpCBOR_TRUE        ( 0xf5U )
+#define tsexpCBOR_NULL        ( 0xf6U )
+
+#define tsexpSAMPLE_ITEMS     ( 4U )
+#define tsexpTASK_ITEMS       ( 7U )
+
+/* Where the encoder writes.  xOverflow is set, and nothing more is written,
+ * once the buffer is full. */
+typedef struct TaskStatsEncoder
+{
+    uint8_t * pucBuffer;
+    size_t xLength;
+    size_t xUsed;
+    BaseType_t xOverflow;
+} TaskStatsEncoder_t;
+
+/* The run time of a task in the previous sample. */
+typedef struct TaskStatsPrevious
+{
+    UBaseType_t uxTaskNumber;
+    configRUN_TIME_COUNTER_TYPE ulRunTime;
+} TaskStatsPrevious_t;
+
+/*-----------------------------------------------------------*/
+
+static TaskStatus_t xTaskStatus[ tsexpMAX_TASKS ];
+
+static TaskStatsPrevious_t xPrevious[ tsexpMAX_TASKS ];
+static UBaseType_t uxPreviousTasks = 0;
+static configRUN_TIME_COUNTER_TYPE ulPreviousTotalRunTime = 0;
+
+/*-----------------------------------------------------------*/
+
+static void prvEncodeBytes( TaskStatsEncoder_t * pxEncoder,
+                            const uint8_t * pucData,
+                            size_t xLength )
+{
+    size_t x;
+
+    if( ( pxEncoder->xOverflow != pdFALSE ) || ( xLength > ( pxEncoder->xLength - pxEncoder->xUsed ) ) )
+    {
+        pxEncoder->xOverflow = pdTRUE;
+    }
+    else
+    {
+        for( x = 0; x < xLength; x++ )
+        {
+            pxEncoder->pucBuffer[ pxEncoder->xUsed ] = pucData[ x ];
+            pxEncoder->xUsed++;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvEncodeHead( TaskStatsEncoder_t * pxEncoder,
+                           uint8_t ucMajorType,
+                           uint64_t ullValue )
+{
+    uint8_t ucHead[ 9 ];
+    size_t xBytes, x;
+
+    /* The shortest form that holds the value, as RFC 8949 prefers. */
+    if( ullValue < 24U )
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucMajorType | ( uint8_t ) ullValue );
+        xBytes = 0;
+    }
+    else if( ullValue <= 0xffU )
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucMajorType | 24U );
+        xBytes = 1;
+    }
+    else if( ullValue <= 0xffffU )
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucMajorType | 25U );
+        xBytes = 2;
+    }
+    else if( ullValue <= 0xffffffffUL )
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucMajorType | 26U );
+        xBytes = 4;
+    }
+    else
+    {
+        ucHead[ 0 ] = ( uint8_t ) ( ucMajorType | 27U );
+        xBytes = 8;
+    }
+
+    /* Big endian. */
+    for( x = 0; x < xBytes; x++ )
+    {
+        ucHead[ xBytes - x ] = ( uint8_t ) ( ullValue >> ( 8U * x ) );
+    }
+
+    prvEncodeBytes( pxEncoder, ucHead, xBytes + 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvEncodeText( TaskStatsEncoder_t * pxEncoder,
+                           const char * pcText )
+{
+    size_t xLength = 0;
+
+    while( ( xLength < configMAX_TASK_NAME_LEN ) && ( pcText[ xLength ] != '\0' ) )
+    {
+        xLength++;
+    }
+
+    prvEncodeHead( pxEncoder, tsexpCBOR_TEXT, xLength );
+    prvEncodeBytes( pxEncoder, ( const uint8_t * ) pcText, xLength );
+}
+/*-----------------------------------------------------------*/
+
+static const TaskStatsPrevious_t * prvFindPrevious( UBaseType_t uxTaskNumber )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxPreviousTasks; ux++ )
+    {
+        if( xPrevious[ ux ].uxTaskNumber == uxTaskNumber )
+        {
+            return &( xPrevious[ ux ] );
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+size_t xTaskStatsExportSample( uint8_t * pucBuffer,
+                               size_t xBufferLength,
+                               BaseType_t xDeltas )
+{
+    TaskStatsEncoder_t xEncoder = { pucBuffer, xBufferLength, 0, pdFALSE };
+    const TaskStatsPrevious_t * pxPrevious;
+    configRUN_TIME_COUNTER_TYPE ulTotalRunTime = 0, ulRunTime;
+    UBaseType_t uxTasks, ux, uxBasePriority;
+    uint8_t ucSimple;
+
+    configASSERT( pucBuffer != NULL );
+
+    /* The only part that runs with the scheduler suspended.  Returns 0 if
+     * xTaskStatus is too small. */
+    uxTasks = uxTaskGetSystemState( xTaskStatus, tsexpMAX_TASKS, &ulTotalRunTime );
+
+    if( uxTasks == 0 )
+    {
+        return 0;
+    }
+
+    prvEncodeHead( &xEncoder, tsexpCBOR_ARRAY, tsexpSAMPLE_ITEMS );
+    prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, tsexpFORMAT_VERSION );
+    ucSimple = ( xDeltas != pdFALSE ) ? tsexpCBOR_TRUE : tsexpCBOR_FALSE;
+    prvEncodeBytes( &xEncoder, &ucSimple, 1 );
+    prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, ( xDeltas != pdFALSE ) ? ( ulTotalRunTime - ulPreviousTotalRunTime ) : ulTotalRunTime );
+    prvEncodeHead( &xEncoder, tsexpCBOR_ARRAY, uxTasks );
+
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        pxPrevious = prvFindPrevious( xTaskStatus[ ux ].xTaskNumber );
+        ulRunTime = xTaskStatus[ ux ].ulRunTimeCounter;
+
+        prvEncodeHead( &xEncoder, tsexpCBOR_ARRAY, tsexpTASK_ITEMS );
+        prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, xTaskStatus[ ux ].xTaskNumber );
+
+        if( ( xDeltas != pdFALSE ) && ( pxPrevious != NULL ) )
+        {
+            ucSimple = tsexpCBOR_NULL;
+            prvEncodeBytes( &xEncoder, &ucSimple, 1 );
+            ulRunTime -= pxPrevious->ulRunTime;
+        }
+        else
+        {
+            prvEncodeText( &xEncoder, xTaskStatus[ ux ].pcTaskName );
+        }
+
+        #if ( configUSE_MUTEXES == 1 )
+        {
+            uxBasePriority = xTaskStatus[ ux ].uxBasePriority;
+        }
+        #else
+        {
+            uxBasePriority = xTaskStatus[ ux ].uxCurrentPriority;
+        }
+        #endif
+
+        prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, ( uint64_t ) xTaskStatus[ ux ].eCurrentState );
+        prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, xTaskStatus[ ux ].uxCurrentPriority );
+        prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, uxBasePriority );
+        prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, xTaskStatus[ ux ].usStackHighWaterMark );
+        prvEncodeHead( &xEncoder, tsexpCBOR_UNSIGNED, ulRunTime );
+    }
+
+    if( xEncoder.xOverflow != pdFALSE )
+    {
+        return 0;
+    }
+
+    /* Only a sample that was delivered becomes the base of the next delta. */
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        xPrevious[ ux ].uxTaskNumber = xTaskStatus[ ux ].xTaskNumber;
+        xPrevious[ ux ].ulRunTime = xTaskStatus[ ux ].ulRunTimeCounter;
+    }
+
+    uxPreviousTasks = uxTasks;
+    ulPreviousTotalRunTime = ulTotalRunTime;
+
+    return xEncoder.xUsed;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,421 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures how the timer service, and the hashed timer wheel in
+ * TimerWheel.c, scale with the number of running timers.  TimerDemo.c tests
+ * the behaviour of the timer API with a handful of timers; this file only
+ * times it, with up to tmbMAX_TIMERS timers.
+ *
+ * For each backend and each count in uxTimerCounts[] the benchmark task:
+ *
+ * 1) Starts that many one-shot timers with a period long enough that none
+ *    expires, then resets every timer tmbRESET_ROUNDS times and reports the
+ *    average cost of a reset.  The benchmark task has a lower priority than
+ *    the timer service task, so each reset includes the service task
+ *    processing the command.  Resetting a timer moves it to the back of the
+ *    active list, so the timer service walks every running timer, where the
+ *    wheel does a constant amount of work.
+ *
+ * 2) Restarts the timers with periods spread over tmbJITTER_SPREAD ticks,
+ *    and measures in each callback how long after the start of its expiry
+ *    tick the callback ran.  vTimerBenchmarkTickHook() records the time of
+ *    each tick.  With many timers expiring on each tick the last callbacks
+ *    run late, and a service that falls behind runs them ticks late.
+ *
+ * Times are read with tmbGET_TIME(), which defaults to the run time stats
+ * counter.  Define it to read a cycle counter for finer resolution.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* Demo app includes. */
+#include "TimerBenchmark.h"
+#include "TimerWheel.h"
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
+    #error TimerBenchmark.c requires configSUPPORT_STATIC_ALLOCATION to be 1
+#endif
+
+#ifndef tmbGET_TIME
+    #define tmbGET_TIME()            ( ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() )
+#endif
+
+/* The most timers run at once, which is the last of uxTimerCounts[]. */
+#ifndef tmbMAX_TIMERS
+    #define tmbMAX_TIMERS            ( 1024 )
+#endif
+
+/* How many times each timer is reset when measuring the cost of a reset. */
+#ifndef tmbRESET_ROUNDS
+    #define tmbRESET_ROUNDS          ( 4 )
+#endif
+
+/* The periods used when measuring lateness are tmbJITTER_BASE to
+ * tmbJITTER_BASE + tmbJITTER_SPREAD - 1 ticks. */
+#ifndef tmbJITTER_BASE
+    #define tmbJITTER_BASE           ( 10 )
+#endif
+
+#ifndef tmbJITTER_SPREAD
+    #define tmbJITTER_SPREAD         ( 16 )
+#endif
+
+#ifndef tmbSTACK_SIZE
+    #define tmbSTACK_SIZE            ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#define tmbBENCHMARK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+
+/* The wheel runs its callbacks at the same priority as the timer service. */
+#define tmbWHEEL_PRIORITY            ( configTIMER_TASK_PRIORITY )
+
+/* Longer than any part of the benchmark takes. */
+#define tmbLONG_PERIOD               pdMS_TO_TICKS( 60000UL )
+
+/* The number of ticks whose times are kept, which must be a power of two.
+ * A callback that runs later than this is counted as missed. */
+#define tmbTICK_HISTORY              ( 256 )
+
+#define tmbARRAY_LENGTH( x )         ( sizeof( x ) / sizeof( ( x )[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* One implementation of timers.  Every timer is started as a one-shot timer,
+ * and starting a running timer resets it. */
+typedef struct TimerBackend
+{
+    const char * pcName;
+    void ( * vCreate )( UBaseType_t uxTimers );
+    void ( * vDelete )( UBaseType_t uxTimers );
+    void ( * vStart )( UBaseType_t uxTimer,
+                       TickType_t xPeriod );
+    void ( * vStop )( UBaseType_t uxTimer );
+    TickType_t ( * xGetExpiryTime )( UBaseType_t uxTimer );
+} TimerBackend_t;
+
+static void prvServiceCreate( UBaseType_t uxTimers );
+static void prvServiceDelete( UBaseType_t uxTimers );
+static void prvServiceStart( UBaseType_t uxTimer,
+                             TickType_t xPeriod );
+static void prvServiceStop( UBaseType_t uxTimer );
+static TickType_t prvServiceGetExpiryTime( UBaseType_t uxTimer );
+static void prvServiceCallback( TimerHandle_t xTimer );
+
+static void prvWheelCreate( UBaseType_t uxTimers );
+static void prvWheelDelete( UBaseType_t uxTimers );
+static void prvWheelStart( UBaseType_t uxTimer,
+                           TickType_t xPeriod );
+static void prvWheelStop( UBaseType_t uxTimer );
+static TickType_t prvWheelGetExpiryTime( UBaseType_t uxTimer );
+static void prvWheelCallback( TimerWheelTimer_t * pxTimer );
+
+/* Records the lateness of timer uxTimer. */
+static void prvTimerExpired( UBaseType_t uxTimer );
+
+/* Runs every combination in turn. */
+static void prvBenchmarkTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static const TimerBackend_t xBackends[] =
+{
+    { "timer service", prvServiceCreate, prvServiceDelete, prvServiceStart, prvServiceStop, prvServiceGetExpiryTime },
+    { "timer wheel",   prvWheelCreate,   prvWheelDelete,   prvWheelStart,   prvWheelStop,   prvWheelGetExpiryTime   }
+};
+
+static const UBaseType_t uxTimerCounts[] = { 16, 64, 256, tmbMAX_TIMERS };
+
+/* The timers are statically allocated so the heap does not have to hold
+ * tmbMAX_TIMERS of them. */
+static TimerHandle_t xServiceTimers[ tmbMAX_TIMERS ];
+static StaticTimer_t xServiceTimerBuffers[ tmbMAX_TIMERS ];
+static TimerWheelTimer_t xWheelTimers[ tmbMAX_TIMERS ];
+
+/* The tick each timer is due to expire on while lateness is measured. */
+static TickType_t xExpiryTicks[ tmbMAX_TIMERS ];
+
+/* Written by the tick hook. */
+static volatile uint32_t ulTickTimes[ tmbTICK_HISTORY ];
+static volatile BaseType_t xRecordTicks = pdFALSE;
+
+/* Written by the callbacks, which run in the timer service or wheel task. */
+static volatile UBaseType_t uxExpired = 0;
+static volatile UBaseType_t uxMissed = 0;
+static volatile uint32_t ulMaxLateness = 0;
+static volatile uint64_t ullTotalLateness = 0;
+
+static TimerBenchmarkResult_t xResults[ tmbARRAY_LENGTH( xBackends ) * tmbARRAY_LENGTH( uxTimerCounts ) ];
+static volatile UBaseType_t uxResultCount = 0;
+static volatile BaseType_t xBenchmarkComplete = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void vStartTimerBenchmark( void )
+{
+    xTaskCreate( prvBenchmarkTask, "TmrBench", tmbSTACK_SIZE, NULL, tmbBENCHMARK_PRIORITY, NULL );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsTimerBenchmarkComplete( void )
+{
+    return xBenchmarkComplete;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetTimerBenchmarkResults( const TimerBenchmarkResult_t ** ppxResults )
+{
+    *ppxResults = xResults;
+
+    return uxResultCount;
+}
+/*-----------------------------------------------------------*/
+
+void vTimerBenchmarkTickHook( void )
+{
+    if( xRecordTicks != pdFALSE )
+    {
+        ulTickTimes[ xTaskGetTickCountFromISR() & ( tmbTICK_HISTORY - 1 ) ] = tmbGET_TIME();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkTask( void * pvParameters )
+{
+    const TimerBackend_t * pxBackend;
+    TimerBenchmarkResult_t * pxResult;
+    UBaseType_t uxBackend, uxCount, uxTimers, ux, uxRound, uxWaits;
+    uint32_t ulStart;
+
+    ( void ) pvParameters;
+
+    /* The reset costs include the service task processing each command. */
+    configASSERT( configTIMER_TASK_PRIORITY > tmbBENCHMARK_PRIORITY );
+
+    if( xTimerWheelInitialise( tmbWHEEL_PRIORITY, tmbSTACK_SIZE ) != pdPASS )
+    {
+        configASSERT( pdFALSE );
+    }
+
+    for( uxBackend = 0; uxBackend < tmbARRAY_LENGTH( xBackends ); uxBackend++ )
+    {
+        pxBackend = &( xBackends[ uxBackend ] );
+
+        for( uxCount = 0; uxCount < tmbARRAY_LENGTH( uxTimerCounts ); uxCount++ )
+        {
+            uxTimers = uxTimerCounts[ uxCount ];
+            pxResult = &( xResults[ uxResultCount ] );
+            pxResult->pcBackend = pxBackend->pcName;
+            pxResult->uxTimers = uxTimers;
+            pxBackend->vCreate( uxTimers );
+
+            /* The cost of a reset with uxTimers timers running. */
+            for( ux = 0; ux < uxTimers; ux++ )
+            {
+                pxBackend->vStart( ux, tmbLONG_PERIOD );
+            }
+
+            ulStart = tmbGET_TIME();
+
+            for( uxRound = 0; uxRound < tmbRESET_ROUNDS; uxRound++ )
+            {
+                for( ux = 0; ux < uxTimers; ux++ )
+                {
+                    pxBackend->vStart( ux, tmbLONG_PERIOD );
+                }
+            }
+
+            pxResult->ulAverageResetCost = ( tmbGET_TIME() - ulStart ) / ( uint32_t ) ( tmbRESET_ROUNDS * uxTimers );
+
+            for( ux = 0; ux < uxTimers; ux++ )
+            {
+                pxBackend->vStop( ux );
+            }
+
+            /* The lateness of the callbacks.  Start on a tick boundary so
+             * the timers are restarted within as few ticks as possible. */
+            uxExpired = 0;
+            uxMissed = 0;
+            ulMaxLateness = 0;
+            ullTotalLateness = 0;
+            xRecordTicks = pdTRUE;
+            vTaskDelay( 1 );
+
+            for( ux = 0; ux < uxTimers; ux++ )
+            {
+                pxBackend->vStart( ux, tmbJITTER_BASE + ( ux % tmbJITTER_SPREAD ) );
+                xExpiryTicks[ ux ] = pxBackend->xGetExpiryTime( ux );
+            }
+
+            for( uxWaits = 0; ( uxExpired < uxTimers ) && ( uxWaits < tmbTICK_HISTORY ); uxWaits++ )
+            {
+                vTaskDelay( tmbJITTER_BASE + tmbJITTER_SPREAD );
+            }
+
+            xRecordTicks = pdFALSE;
+
+            pxResult->ulAverageLateness = ( uxExpired > uxMissed ) ? ( uint32_t ) ( ullTotalLateness / ( uxExpired - uxMissed ) ) : 0;
+            pxResult->ulMaxLateness = ulMaxLateness;
+            pxResult->uxMissedExpiries = ( uxTimers - uxExpired ) + uxMissed;
+
+            pxBackend->vDelete( uxTimers );
+            uxResultCount++;
+        }
+    }
+
+    xBenchmarkComplete = pdTRUE;
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerExpired( UBaseType_t uxTimer )
+{
+    const uint32_t ulNow = tmbGET_TIME();
+    uint32_t ulLateness;
+
+    /* The tick hook has recorded the time of the expiry tick, unless the
+     * callback is so late the time has been overwritten. */
+    if( ( TickType_t ) ( xTaskGetTickCount() - xExpiryTicks[ uxTimer ] ) >= ( TickType_t ) tmbTICK_HISTORY )
+    {
+        uxMissed++;
+    }
+    else
+    {
+        ulLateness = ulNow - ulTickTimes[ xExpiryTicks[ uxTimer ] & ( tmbTICK_HISTORY - 1 ) ];
+        ullTotalLateness += ulLateness;
+
+        if( ulLateness > ulMaxLateness )
+        {
+            ulMaxLateness = ulLateness;
+        }
+    }
+
+    uxExpired++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceCreate( UBaseType_t uxTimers )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxTimers; ux++ )
+    {
+        xServiceTimers[ ux ] = xTimerCreateStatic( "Bench", tmbLONG_PERIOD, pdFALSE, ( void * ) ux, prvServiceCallback, &( xServiceTimerBuffers[ ux ] ) );
+        configASSERT( xServiceTimers[ ux ] );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceDelete( UBaseType_t uxTimers )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxTimers; ux++ )
+    {
+        ( void ) xTimerDelete( xServiceTimers[ ux ], portMAX_DELAY );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceStart( UBaseType_t uxTimer,
+                             TickType_t xPeriod )
+{
+    /* Changing the period of a timer starts it, or resets it if it is
+     * running. */
+    ( void ) xTimerChangePeriod( xServiceTimers[ uxTimer ], xPeriod, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceStop( UBaseType_t uxTimer )
+{
+    ( void ) xTimerStop( xServiceTimers[ uxTimer ], portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvServiceGetExpiryTime( UBaseType_t uxTimer )
+{
+    /* The timer service task has a higher priority than the benchmark task,
+     * so has already processed the command that started the timer. */
+    return xTimerGetExpiryTime( xServiceTimers[ uxTimer ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceCallback( TimerHandle_t xTimer )
+{
+    prvTimerExpired( ( UBaseType_t ) pvTimerGetTimerID( xTimer ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelCreate( UBaseType_t uxTimers )
+{
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxTimers; ux++ )
+    {
+        vTimerWheelTimerInitialise( &( xWheelTimers[ ux ] ), prvWheelCallback, ( void * ) ux );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelDelete( UBaseType_t uxTimers )
+{
+    UBaseType_t ux;
+
+    /* The timers are statically allocated, so only need stopping. */
+    for( ux = 0; ux < uxTimers; ux++ )
+    {
+        vTimerWheelTimerStop( &( xWheelTimers[ ux ] ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelStart( UBaseType_t uxTimer,
+                           TickType_t xPeriod )
+{
+    vTimerWheelTimerStart( &( xWheelTimers[ uxTimer ] ), xPeriod, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelStop( UBaseType_t uxTimer )
+{
+    vTimerWheelTimerStop( &( xWheelTimers[ uxTimer ] ) );
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvWheelGetExpiryTime( UBaseType_t uxTimer )
+{
+    return xTimerWheelTimerGetExpiryTime( &( xWheelTimers[ uxTimer ] ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWheelCallback( TimerWheelTimer_t * pxTimer )
+{
+    prvTimerExpired( ( UBaseType_t ) pvTimerWheelTimerGetID( pxTimer ) );
+}
+/*-----------------------------------------------------------*/
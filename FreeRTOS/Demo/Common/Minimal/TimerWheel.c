@@ -0,0 +1,397 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A hashed timer wheel, for applications that run many more timers than the
+ * timer service is designed for, such as hundreds of protocol timeouts that
+ * are reset on every packet.
+ *
+ * Each command to the timer service goes through the timer command queue,
+ * and the timer service task inserts the timer into a list sorted by expiry
+ * time, so starting or resetting a timer costs a queue send, a context
+ * switch and a walk of the list.  Here a timer is instead linked directly,
+ * inside a short critical section, into one of twSLOTS lists chosen by its
+ * expiry time modulo twSLOTS.  Starting, resetting and stopping a timer are
+ * therefore O(1) whatever the number of running timers.
+ *
+ * The wheel task visits the slot of each tick that passes, and runs the
+ * callbacks of the timers in it that expire on that tick.  Timers that
+ * expire more than twSLOTS ticks ahead stay in their slot until the wheel
+ * comes round to the right tick.  Between expiries the task blocks until the
+ * next slot that is not empty, and does not run at all while no timer is
+ * running.
+ *
+ * Callbacks run in the wheel task, in the order the timers expire, and
+ * like timer service callbacks must not block.  An auto-reload timer that
+ * is serviced late skips the periods it missed.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo program include files. */
+#include "TimerWheel.h"
+
+/* The number of slots, which must be a power of two.  More slots mean fewer
+ * timers to compare per tick. */
+#ifndef twSLOTS
+    #define twSLOTS    ( 256 )
+#endif
+
+#if ( ( twSLOTS & ( twSLOTS - 1 ) ) != 0 )
+    #error twSLOTS must be a power of two.
+#endif
+
+#define twSLOT( xTime )    ( &( xSlots[ ( xTime ) & ( ( TickType_t ) twSLOTS - 1U ) ] ) )
+
+/*-----------------------------------------------------------*/
+
+/* The task that runs the callbacks. */
+static void prvTimerWheelTask( void * pvParameters );
+
+/* Move the timers that expire at xWheelTime from its slot to the expired
+ * list.  Called from a critical section. */
+static void prvCollectExpiredTimers( void );
+
+/* The ticks from xWheelTime to the next slot holding a timer.  Called from a
+ * critical section. */
+static TickType_t prvTicksToNextSlot( void );
+
+/*-----------------------------------------------------------*/
+
+/* Each list is circular, with the head acting as the sentinel. */
+static TimerWheelLink_t xSlots[ twSLOTS ];
+static TimerWheelLink_t xExpiredTimers;
+
+/* The last tick whose slot has been visited. */
+static TickType_t xWheelTime = 0;
+
+/* The tick at which the wheel task next wakes, when xWheelIdle is pdFALSE. */
+static TickType_t xNextWakeTime = 0;
+static BaseType_t xWheelIdle = pdTRUE;
+
+/* Timers in a slot or in the expired list. */
+static UBaseType_t uxActiveTimers = 0;
+
+static TaskHandle_t xWheelTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+static void prvListInitialise( TimerWheelLink_t * pxList )
+{
+    pxList->pxNext = pxList;
+    pxList->pxPrevious = pxList;
+}
+/*-----------------------------------------------------------*/
+
+static void prvListInsertEnd( TimerWheelLink_t * pxList,
+                              TimerWheelLink_t * pxLink )
+{
+    pxLink->pxNext = pxList;
+    pxLink->pxPrevious = pxList->pxPrevious;
+    pxList->pxPrevious->pxNext = pxLink;
+    pxList->pxPrevious = pxLink;
+}
+/*-----------------------------------------------------------*/
+
+static void prvListRemove( TimerWheelLink_t * pxLink )
+{
+    pxLink->pxPrevious->pxNext = pxLink->pxNext;
+    pxLink->pxNext->pxPrevious = pxLink->pxPrevious;
+    pxLink->pxNext = NULL;
+    pxLink->pxPrevious = NULL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTimerWheelInitialise( UBaseType_t uxPriority,
+                                  configSTACK_DEPTH_TYPE uxStackDepth )
+{
+    UBaseType_t ux;
+
+    if( xWheelTask != NULL )
+    {
+        return pdPASS;
+    }
+
+    for( ux = 0; ux < twSLOTS; ux++ )
+    {
+        prvListInitialise( &( xSlots[ ux ] ) );
+    }
+
+    prvListInitialise( &xExpiredTimers );
+
+    return xTaskCreate( prvTimerWheelTask, "TWheel", uxStackDepth, NULL, uxPriority, &xWheelTask );
+}
+/*-----------------------------------------------------------*/
+
+void vTimerWheelTimerInitialise( TimerWheelTimer_t * pxTimer,
+                                 TimerWheelCallback_t pxCallback,
+                                 void * pvTimerID )
+{
+    pxTimer->xLink.pxNext = NULL;
+    pxTimer->xLink.pxPrevious = NULL;
+    pxTimer->xExpiryTime = 0;
+    pxTimer->xPeriod = 0;
+    pxTimer->xAutoReload = pdFALSE;
+    pxTimer->pxCallback = pxCallback;
+    pxTimer->pvTimerID = pvTimerID;
+}
+/*-----------------------------------------------------------*/
+
+void vTimerWheelTimerStart( TimerWheelTimer_t * pxTimer,
+                            TickType_t xPeriod,
+                            BaseType_t xAutoReload )
+{
+    BaseType_t xWakeWheel = pdFALSE;
+    TickType_t xNow;
+
+    configASSERT( xWheelTask != NULL );
+    configASSERT( ( xPeriod > 0 ) && ( xPeriod != portMAX_DELAY ) );
+
+    taskENTER_CRITICAL();
+    {
+        if( pxTimer->xLink.pxNext != NULL )
+        {
+            prvListRemove( &( pxTimer->xLink ) );
+            uxActiveTimers--;
+        }
+
+        xNow = xTaskGetTickCount();
+
+        /* With no timer running there is nothing in the ticks the wheel has
+         * not visited yet, so it can jump straight to now. */
+        if( uxActiveTimers == 0 )
+        {
+            xWheelTime = xNow;
+        }
+
+        pxTimer->xPeriod = xPeriod;
+        pxTimer->xAutoReload = xAutoReload;
+        pxTimer->xExpiryTime = xNow + xPeriod;
+        prvListInsertEnd( twSLOT( pxTimer->xExpiryTime ), &( pxTimer->xLink ) );
+        uxActiveTimers++;
+
+        /* Only wake the wheel task if it would otherwise sleep past the new
+         * expiry time. */
+        if( ( xWheelIdle != pdFALSE ) ||
+            ( ( pxTimer->xExpiryTime - xWheelTime ) < ( xNextWakeTime - xWheelTime ) ) )
+        {
+            xNextWakeTime = pxTimer->xExpiryTime;
+            xWheelIdle = pdFALSE;
+            xWakeWheel = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xWakeWheel != pdFALSE )
+    {
+        xTaskNotifyGive( xWheelTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTimerWheelTimerStop( TimerWheelTimer_t * pxTimer )
+{
+    taskENTER_CRITICAL();
+    {
+        if( pxTimer->xLink.pxNext != NULL )
+        {
+            prvListRemove( &( pxTimer->xLink ) );
+            uxActiveTimers--;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTimerWheelTimerIsActive( const TimerWheelTimer_t * pxTimer )
+{
+    BaseType_t xReturn;
+
+    taskENTER_CRITICAL();
+    {
+        xReturn = ( pxTimer->xLink.pxNext != NULL ) ? pdTRUE : pdFALSE;
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+TickType_t xTimerWheelTimerGetExpiryTime( const TimerWheelTimer_t * pxTimer )
+{
+    TickType_t xReturn;
+
+    taskENTER_CRITICAL();
+    {
+        xReturn = pxTimer->xExpiryTime;
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCollectExpiredTimers( void )
+{
+    TimerWheelLink_t * pxSlot = twSLOT( xWheelTime );
+    TimerWheelLink_t * pxLink, * pxNext;
+
+    for( pxLink = pxSlot->pxNext; pxLink != pxSlot; pxLink = pxNext )
+    {
+        pxNext = pxLink->pxNext;
+
+        /* xLink is the first member, so the link is the timer. */
+        if( ( ( TimerWheelTimer_t * ) pxLink )->xExpiryTime == xWheelTime )
+        {
+            prvListRemove( pxLink );
+            prvListInsertEnd( &xExpiredTimers, pxLink );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvTicksToNextSlot( void )
+{
+    TickType_t xTicks;
+
+    for( xTicks = 1; xTicks < ( TickType_t ) twSLOTS; xTicks++ )
+    {
+        if( twSLOT( xWheelTime + xTicks )->pxNext != twSLOT( xWheelTime + xTicks ) )
+        {
+            break;
+        }
+    }
+
+    /* Every timer is in some slot, so it is at most twSLOTS ticks away. */
+    return xTicks;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTimerWheelTask( void * pvParameters )
+{
+    TimerWheelTimer_t * pxTimer;
+    TickType_t xNow, xTicksToWait;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        /* Visit the slot of each tick that has passed, one critical section
+         * per tick. */
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                xNow = xTaskGetTickCount();
+
+                if( uxActiveTimers == 0 )
+                {
+                    xWheelTime = xNow;
+                }
+                else if( xWheelTime != xNow )
+                {
+                    xWheelTime++;
+                    prvCollectExpiredTimers();
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( xWheelTime == xNow )
+            {
+                break;
+            }
+        }
+
+        /* Run the callbacks.  Each timer is taken off the expired list in a
+         * critical section, so the timer can be stopped or restarted by
+         * other tasks, or by an earlier callback, until its callback runs. */
+        for( ; ; )
+        {
+            taskENTER_CRITICAL();
+            {
+                if( xExpiredTimers.pxNext == &xExpiredTimers )
+                {
+                    pxTimer = NULL;
+                }
+                else
+                {
+                    pxTimer = ( TimerWheelTimer_t * ) xExpiredTimers.pxNext;
+                    prvListRemove( &( pxTimer->xLink ) );
+                    uxActiveTimers--;
+
+                    if( pxTimer->xAutoReload != pdFALSE )
+                    {
+                        pxTimer->xExpiryTime += pxTimer->xPeriod;
+
+                        /* The next expiry must be after xWheelTime, or the
+                         * wheel would not come back to it for a whole
+                         * revolution. */
+                        if( ( TickType_t ) ( pxTimer->xExpiryTime - xWheelTime - 1U ) >= pxTimer->xPeriod )
+                        {
+                            pxTimer->xExpiryTime = xWheelTime + pxTimer->xPeriod;
+                        }
+
+                        prvListInsertEnd( twSLOT( pxTimer->xExpiryTime ), &( pxTimer->xLink ) );
+                        uxActiveTimers++;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( pxTimer == NULL )
+            {
+                break;
+            }
+
+            pxTimer->pxCallback( pxTimer );
+        }
+
+        /* Sleep until the next slot that holds a timer, or until a timer is
+         * started if none is running.  A timer started in between leaves the
+         * notification pending, so the take returns at once. */
+        taskENTER_CRITICAL();
+        {
+            if( uxActiveTimers == 0 )
+            {
+                xWheelIdle = pdTRUE;
+                xTicksToWait = portMAX_DELAY;
+            }
+            else
+            {
+                xWheelIdle = pdFALSE;
+                xNextWakeTime = xWheelTime + prvTicksToNextSlot();
+                xNow = xTaskGetTickCount();
+                xTicksToWait = ( ( xNextWakeTime - xWheelTime ) > ( xNow - xWheelTime ) ) ? ( xNextWakeTime - xNow ) : 0;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        ( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+    }
+}
+/*-----------------------------------------------------------*/
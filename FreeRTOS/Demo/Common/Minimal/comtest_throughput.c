@@ -0,0 +1,251 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * A throughput variant of comtest.c for ports that implement the buffer level
+ * serial functions xSerialWrite() and xSerialRead(), for example through
+ * serial_stream.c.  As with comtest.c a loopback connector must be fitted, so
+ * everything transmitted is also received.
+ *
+ * The Tx task writes an incrementing byte sequence in blocks of
+ * comtpBLOCK_SIZE bytes as fast as the port accepts it.  The Rx task, which
+ * has a higher priority, reads whatever has arrived, up to comtpBLOCK_SIZE
+ * bytes at a time, and checks it continues the sequence.  A byte out of
+ * sequence is counted as an error and the Rx task resynchronises on it.
+ *
+ * Every comtpREPORT_PERIOD the Rx task records the bytes per second received
+ * and, when run time stats are enabled, the share of time not spent in the
+ * idle task, which is the CPU load of the test plus the rest of the
+ * application.  The figures are read with vGetComThroughputResult().  At
+ * full line rate the byte rate is close to a tenth of the baud rate with 8N1
+ * framing, and the load shows what moving the data costs.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo program include files. */
+#include "serial.h"
+#include "comtest_throughput.h"
+
+#ifndef comtpSTACK_SIZE
+    #define comtpSTACK_SIZE        configMINIMAL_STACK_SIZE
+#endif
+
+/* Bytes per xSerialWrite() and the most bytes per xSerialRead(). */
+#ifndef comtpBLOCK_SIZE
+    #define comtpBLOCK_SIZE        ( 256 )
+#endif
+
+/* The length of the Rx and Tx buffers requested from the port. */
+#ifndef comtpBUFFER_LEN
+    #define comtpBUFFER_LEN        ( comtpBLOCK_SIZE * 4 )
+#endif
+
+#define comtpREPORT_PERIOD         pdMS_TO_TICKS( 1000 )
+
+/* The Rx task blocks for at most this long, so it still reports when nothing
+ * is received. */
+#define comtpRX_BLOCK_TIME         pdMS_TO_TICKS( 100 )
+
+/* The CPU load can only be measured if the idle task's run time is known. */
+#if ( configGENERATE_RUN_TIME_STATS == 1 ) && ( INCLUDE_xTaskGetIdleTaskHandle == 1 ) && defined( portGET_RUN_TIME_COUNTER_VALUE )
+    #define comtpMEASURE_CPU_LOAD  1
+#else
+    #define comtpMEASURE_CPU_LOAD  0
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The transmit task as described at the top of the file. */
+static portTASK_FUNCTION_PROTO( vComThroughputTxTask, pvParameters );
+
+/* The receive task as described at the top of the file. */
+static portTASK_FUNCTION_PROTO( vComThroughputRxTask, pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/* Handle to the com port used by both tasks. */
+static xComPortHandle xPort = NULL;
+
+/* The blocks written and read.  Not on the stacks, which can be small. */
+static uint8_t ucTxBlock[ comtpBLOCK_SIZE ];
+static uint8_t ucRxBlock[ comtpBLOCK_SIZE ];
+
+/* Updated by the Rx task at the end of each period. */
+static ComThroughputResult_t xLastResult = { 0, comtpCPU_LOAD_UNKNOWN, 0 };
+
+/* Incremented by the Rx task for every byte received in sequence, and reset
+ * by xIsComThroughputTestStillRunning(). */
+static volatile uint32_t ulRxBytesSinceCheck = 0;
+
+/*-----------------------------------------------------------*/
+
+void vStartComThroughputTest( UBaseType_t uxPriority,
+                              uint32_t ulBaudRate )
+{
+    /* Initialise the com port then spawn the Rx and Tx tasks. */
+    xPort = xSerialPortInitMinimal( ulBaudRate, comtpBUFFER_LEN );
+
+    /* The Tx task is spawned with a lower priority than the Rx task. */
+    xTaskCreate( vComThroughputTxTask, "COMTPTx", comtpSTACK_SIZE, NULL, uxPriority - 1, ( TaskHandle_t * ) NULL );
+    xTaskCreate( vComThroughputRxTask, "COMTPRx", comtpSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vComThroughputTxTask, pvParameters )
+{
+    uint8_t ucNextByte = 0;
+    size_t x, xWritten;
+
+    /* Just to stop compiler warnings. */
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        for( x = 0; x < comtpBLOCK_SIZE; x++ )
+        {
+            ucTxBlock[ x ] = ucNextByte;
+            ucNextByte++;
+        }
+
+        /* Blocks until the whole block is queued, so the port is kept busy. */
+        xWritten = xSerialWrite( xPort, ucTxBlock, comtpBLOCK_SIZE, portMAX_DELAY );
+        configASSERT( xWritten == comtpBLOCK_SIZE );
+        ( void ) xWritten;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vComThroughputRxTask, pvParameters )
+{
+    uint8_t ucExpectedByte = 0;
+    BaseType_t xFirstByte = pdTRUE;
+    uint32_t ulPeriodBytes = 0, ulErrors = 0;
+    TickType_t xPeriodStart, xElapsed;
+    size_t xReceived, x;
+
+    #if ( comtpMEASURE_CPU_LOAD == 1 )
+        uint32_t ulTotalStart, ulIdleStart, ulTotal, ulIdle;
+    #endif
+
+    /* Just to stop compiler warnings. */
+    ( void ) pvParameters;
+
+    xPeriodStart = xTaskGetTickCount();
+
+    #if ( comtpMEASURE_CPU_LOAD == 1 )
+    {
+        ulTotalStart = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE();
+        ulIdleStart = ( uint32_t ) ulTaskGetIdleRunTimeCounter();
+    }
+    #endif
+
+    for( ; ; )
+    {
+        xReceived = xSerialRead( xPort, ucRxBlock, comtpBLOCK_SIZE, comtpRX_BLOCK_TIME );
+
+        for( x = 0; x < xReceived; x++ )
+        {
+            /* The sequence may have started before this task ran. */
+            if( xFirstByte != pdFALSE )
+            {
+                ucExpectedByte = ucRxBlock[ x ];
+                xFirstByte = pdFALSE;
+            }
+
+            if( ucRxBlock[ x ] == ucExpectedByte )
+            {
+                ulPeriodBytes++;
+            }
+            else
+            {
+                /* Resynchronise on the byte received. */
+                ulErrors++;
+                ucExpectedByte = ucRxBlock[ x ];
+            }
+
+            ucExpectedByte++;
+        }
+
+        ulRxBytesSinceCheck += ( uint32_t ) xReceived;
+
+        xElapsed = xTaskGetTickCount() - xPeriodStart;
+
+        if( xElapsed >= comtpREPORT_PERIOD )
+        {
+            xLastResult.ulBytesPerSecond = ( uint32_t ) ( ( ( uint64_t ) ulPeriodBytes * configTICK_RATE_HZ ) / xElapsed );
+            xLastResult.ulErrors = ulErrors;
+
+            #if ( comtpMEASURE_CPU_LOAD == 1 )
+            {
+                ulTotal = ( uint32_t ) portGET_RUN_TIME_COUNTER_VALUE() - ulTotalStart;
+                ulIdle = ( uint32_t ) ulTaskGetIdleRunTimeCounter() - ulIdleStart;
+                ulTotalStart += ulTotal;
+                ulIdleStart += ulIdle;
+
+                if( ( ulTotal > 0 ) && ( ulIdle <= ulTotal ) )
+                {
+                    xLastResult.ulCPULoadPercent = 100UL - ( uint32_t ) ( ( ( uint64_t ) ulIdle * 100ULL ) / ulTotal );
+                }
+            }
+            #endif /* comtpMEASURE_CPU_LOAD */
+
+            xPeriodStart += xElapsed;
+            ulPeriodBytes = 0;
+        }
+    }
+} /*lint !e715 !e818 pvParameters is required for a task function even if it is not referenced. */
+/*-----------------------------------------------------------*/
+
+void vGetComThroughputResult( ComThroughputResult_t * pxResult )
+{
+    taskENTER_CRITICAL();
+    {
+        *pxResult = xLastResult;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xIsComThroughputTestStillRunning( void )
+{
+    BaseType_t xReturn = pdTRUE;
+
+    /* Fail if nothing was received since the last call, or if anything was
+     * received out of sequence. */
+    if( ( ulRxBytesSinceCheck == 0 ) || ( xLastResult.ulErrors != 0 ) )
+    {
+        xReturn = pdFALSE;
+    }
+
+    ulRxBytesSinceCheck = 0;
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,290 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * The hardware independent half of a serial port driver that moves blocks of
+ * bytes through stream buffers instead of single characters through queues,
+ * so the cost per byte no longer includes a queue operation and an interrupt.
+ * It implements xSerialWrite() and xSerialRead(), and the character and
+ * string functions of serial.h on top of them.  The port implements the
+ * hardware half, see serial_stream.h.
+ *
+ * Transmission:  xSerialWrite() writes to the transmit stream buffer.  When
+ * no transfer is active it moves up to xTxDMALength bytes from the stream
+ * buffer to pucTxDMABuffer and calls vSerialStreamPortStartTx(), which starts
+ * a DMA transfer (or enables a FIFO interrupt).  When the transfer completes
+ * the port calls vSerialStreamTxCompleteFromISR(), which starts the next
+ * transfer from the same interrupt, so a long write costs one interrupt per
+ * xTxDMALength bytes.  xTxActive ensures only one of the task and the
+ * interrupt reads the transmit stream buffer at a time.
+ *
+ * Reception:  the receive DMA writes pucRxDMABuffer in circular mode.  On the
+ * half transfer and transfer complete interrupts, and on the UART idle line
+ * interrupt that ends a burst, the port calls vSerialStreamRxDMAFromISR()
+ * with the DMA's write position, and the bytes received since the previous
+ * call are copied to the receive stream buffer.  The receive stream buffer
+ * has a trigger level of one byte, so xSerialRead() returns as soon as a
+ * burst ends rather than when a fixed amount has arrived.  The half transfer
+ * interrupt ensures the DMA never laps the bytes not yet copied.
+ *
+ * As with the stream buffers themselves, each port must only be written by
+ * one task at a time and read by one task at a time.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+/* Demo program include files. */
+#include "serial.h"
+#include "serial_stream.h"
+
+/*-----------------------------------------------------------*/
+
+/* Starts a transfer from a task if none is active. */
+static void prvStartTransmission( SerialStreamPort_t * pxPort );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xSerialStreamInit( SerialStreamPort_t * pxPort,
+                              size_t xTxStreamLength,
+                              size_t xRxStreamLength,
+                              uint8_t * pucTxDMABuffer,
+                              size_t xTxDMALength,
+                              const uint8_t * pucRxDMABuffer,
+                              size_t xRxDMALength )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( ( pucTxDMABuffer != NULL ) && ( xTxDMALength > 0 ) );
+
+    pxPort->xTxStream = xStreamBufferCreate( xTxStreamLength, 1 );
+    pxPort->xRxStream = xStreamBufferCreate( xRxStreamLength, 1 );
+    pxPort->pucTxDMABuffer = pucTxDMABuffer;
+    pxPort->xTxDMALength = xTxDMALength;
+    pxPort->pucRxDMABuffer = pucRxDMABuffer;
+    pxPort->xRxDMALength = xRxDMALength;
+    pxPort->xRxDMAPosition = 0;
+    pxPort->xTxActive = pdFALSE;
+    pxPort->ulRxOverruns = 0;
+
+    if( ( pxPort->xTxStream != NULL ) && ( pxPort->xRxStream != NULL ) )
+    {
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStartTransmission( SerialStreamPort_t * pxPort )
+{
+    BaseType_t xClaimed = pdFALSE;
+    size_t xLength;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxPort->xTxActive == pdFALSE )
+        {
+            pxPort->xTxActive = pdTRUE;
+            xClaimed = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if( xClaimed != pdFALSE )
+    {
+        /* No transfer is active, so the interrupt will not read the stream
+         * buffer until one is started. */
+        xLength = xStreamBufferReceive( pxPort->xTxStream, pxPort->pucTxDMABuffer, pxPort->xTxDMALength, 0 );
+
+        if( xLength > 0 )
+        {
+            vSerialStreamPortStartTx( pxPort, pxPort->pucTxDMABuffer, xLength );
+        }
+        else
+        {
+            pxPort->xTxActive = pdFALSE;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xSerialWrite( xComPortHandle pxPort,
+                     const void * pvTxData,
+                     size_t xDataLength,
+                     TickType_t xBlockTime )
+{
+    SerialStreamPort_t * pxStreamPort = ( SerialStreamPort_t * ) pxPort;
+    const uint8_t * pucTxData = ( const uint8_t * ) pvTxData;
+    size_t xWritten = 0;
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    while( xWritten < xDataLength )
+    {
+        xWritten += xStreamBufferSend( pxStreamPort->xTxStream, &( pucTxData[ xWritten ] ), xDataLength - xWritten, 0 );
+
+        /* Transmission must be running before blocking for space, as only
+         * the end of a transfer frees space. */
+        prvStartTransmission( pxStreamPort );
+
+        if( xWritten < xDataLength )
+        {
+            if( xTaskCheckForTimeOut( &xTimeOut, &xBlockTime ) != pdFALSE )
+            {
+                break;
+            }
+
+            xWritten += xStreamBufferSend( pxStreamPort->xTxStream, &( pucTxData[ xWritten ] ), xDataLength - xWritten, xBlockTime );
+            prvStartTransmission( pxStreamPort );
+        }
+    }
+
+    return xWritten;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSerialRead( xComPortHandle pxPort,
+                    void * pvRxData,
+                    size_t xBufferLength,
+                    TickType_t xBlockTime )
+{
+    SerialStreamPort_t * pxStreamPort = ( SerialStreamPort_t * ) pxPort;
+
+    return xStreamBufferReceive( pxStreamPort->xRxStream, pvRxData, xBufferLength, xBlockTime );
+}
+/*-----------------------------------------------------------*/
+
+signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort,
+                                     signed char cOutChar,
+                                     TickType_t xBlockTime )
+{
+    signed portBASE_TYPE xReturn = pdFAIL;
+
+    if( xSerialWrite( pxPort, &cOutChar, sizeof( cOutChar ), xBlockTime ) == sizeof( cOutChar ) )
+    {
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+signed portBASE_TYPE xSerialGetChar( xComPortHandle pxPort,
+                                     signed char * pcRxedChar,
+                                     TickType_t xBlockTime )
+{
+    signed portBASE_TYPE xReturn = pdFAIL;
+
+    if( xSerialRead( pxPort, pcRxedChar, sizeof( *pcRxedChar ), xBlockTime ) == sizeof( *pcRxedChar ) )
+    {
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vSerialPutString( xComPortHandle pxPort,
+                       const signed char * const pcString,
+                       unsigned short usStringLength )
+{
+    ( void ) xSerialWrite( pxPort, pcString, ( size_t ) usStringLength, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+void vSerialStreamTxCompleteFromISR( SerialStreamPort_t * pxPort,
+                                     BaseType_t * pxHigherPriorityTaskWoken )
+{
+    size_t xLength;
+
+    /* This also unblocks a task waiting in xSerialWrite() for space. */
+    xLength = xStreamBufferReceiveFromISR( pxPort->xTxStream, pxPort->pucTxDMABuffer, pxPort->xTxDMALength, pxHigherPriorityTaskWoken );
+
+    if( xLength > 0 )
+    {
+        vSerialStreamPortStartTx( pxPort, pxPort->pucTxDMABuffer, xLength );
+    }
+    else
+    {
+        pxPort->xTxActive = pdFALSE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vSerialStreamRxFromISR( SerialStreamPort_t * pxPort,
+                             const uint8_t * pucData,
+                             size_t xLength,
+                             BaseType_t * pxHigherPriorityTaskWoken )
+{
+    size_t xSent;
+
+    xSent = xStreamBufferSendFromISR( pxPort->xRxStream, pucData, xLength, pxHigherPriorityTaskWoken );
+
+    if( xSent < xLength )
+    {
+        pxPort->ulRxOverruns += ( uint32_t ) ( xLength - xSent );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vSerialStreamRxDMAFromISR( SerialStreamPort_t * pxPort,
+                                size_t xDMAPosition,
+                                BaseType_t * pxHigherPriorityTaskWoken )
+{
+    configASSERT( pxPort->pucRxDMABuffer != NULL );
+    configASSERT( xDMAPosition <= pxPort->xRxDMALength );
+
+    /* The transfer complete interrupt may report the end of the buffer. */
+    if( xDMAPosition == pxPort->xRxDMALength )
+    {
+        xDMAPosition = 0;
+    }
+
+    /* The DMA has wrapped, so first copy the bytes up to the end. */
+    if( xDMAPosition < pxPort->xRxDMAPosition )
+    {
+        vSerialStreamRxFromISR( pxPort,
+                                &( pxPort->pucRxDMABuffer[ pxPort->xRxDMAPosition ] ),
+                                pxPort->xRxDMALength - pxPort->xRxDMAPosition,
+                                pxHigherPriorityTaskWoken );
+        pxPort->xRxDMAPosition = 0;
+    }
+
+    if( xDMAPosition > pxPort->xRxDMAPosition )
+    {
+        vSerialStreamRxFromISR( pxPort,
+                                &( pxPort->pucRxDMABuffer[ pxPort->xRxDMAPosition ] ),
+                                xDMAPosition - pxPort->xRxDMAPosition,
+                                pxHigherPriorityTaskWoken );
+        pxPort->xRxDMAPosition = xDMAPosition;
+    }
+}
+/*-----------------------------------------------------------*/
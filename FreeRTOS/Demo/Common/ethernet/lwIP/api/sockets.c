@@ -52,6 +52,12 @@ struct lwip_socket {
   u16_t sendevent;
   u16_t  flags;
   int err;
+#if LWIP_EPOLL
+  s8_t epoll;         /* The epoll instance the socket is in, or -1. */
+  u8_t epoll_events;  /* The LWIP_EPOLLIN and LWIP_EPOLLOUT to report. */
+  u8_t epoll_queued;  /* Set while the socket is on the ready list. */
+  s16_t epoll_next;   /* The next socket on the ready list, or -1. */
+#endif /* LWIP_EPOLL */
 };
 
 struct lwip_select_cb
@@ -64,14 +70,38 @@ struct lwip_select_cb
     sys_sem_t sem;
 };
 
+#if LWIP_EPOLL
+/* An epoll instance keeps a list of its sockets that may be ready, which
+   event_callback() adds to, so that lwip_epoll_wait() only looks at those
+   rather than at every socket.  The instances, the lists and the socket
+   fields they use are protected by selectsem. */
+struct lwip_epoll
+{
+    u8_t used;
+    u8_t waiting;       /* A task is blocked on sem. */
+    s16_t ready_head;
+    s16_t ready_tail;
+    sys_sem_t sem;
+};
+#endif /* LWIP_EPOLL */
+
 static struct lwip_socket sockets[NUM_SOCKETS];
 static struct lwip_select_cb *select_cb_list = 0;
+#if LWIP_EPOLL
+static struct lwip_epoll epolls[LWIP_EPOLL_INSTANCES];
+#endif /* LWIP_EPOLL */
 
 static sys_sem_t socksem = 0;
 static sys_sem_t selectsem = 0;
 
 static void
 event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len);
+#if LWIP_EPOLL
+static void
+epoll_enqueue(struct lwip_socket *sock, int s);
+static void
+epoll_remove(struct lwip_socket *sock, int s);
+#endif /* LWIP_EPOLL */
 
 static int err_to_errno_table[11] = {
     0,      /* ERR_OK    0      No error, everything OK. */
@@ -149,6 +179,12 @@ alloc_socket(struct netconn *newconn)
       sockets[i].sendevent = 1; /* TCP send buf is empty */
       sockets[i].flags = 0;
       sockets[i].err = 0;
+#if LWIP_EPOLL
+      sockets[i].epoll = -1;
+      sockets[i].epoll_events = 0;
+      sockets[i].epoll_queued = 0;
+      sockets[i].epoll_next = -1;
+#endif /* LWIP_EPOLL */
       sys_sem_signal(socksem);
       return i;
     }
@@ -265,6 +301,14 @@ lwip_close(int s)
       return -1;
   }
 
+#if LWIP_EPOLL
+  if (!selectsem)
+      selectsem = sys_sem_new(1);
+  sys_sem_wait(selectsem);
+  epoll_remove(sock, s);
+  sys_sem_signal(selectsem);
+#endif /* LWIP_EPOLL */
+
   netconn_delete(sock->conn);
   if (sock->lastdata) {
     netbuf_delete(sock->lastdata);
@@ -851,6 +895,10 @@ event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len)
         sock->sendevent = 0;
         break;
     }
+#if LWIP_EPOLL
+    if (sock->epoll >= 0)
+        epoll_enqueue(sock, s);
+#endif /* LWIP_EPOLL */
     sys_sem_signal(selectsem);
 
     /* Now decide if anyone is waiting for this socket */
@@ -891,6 +939,275 @@ event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len)
 
 
 
+#if LWIP_EPOLL
+
+static struct lwip_epoll *
+get_epoll(int epfd)
+{
+  if ((epfd < 0) || (epfd >= LWIP_EPOLL_INSTANCES) || !epolls[epfd].used) {
+    LWIP_DEBUGF(SOCKETS_DEBUG, ("get_epoll(%d): invalid\n", epfd));
+    set_errno(EBADF);
+    return NULL;
+  }
+
+  return &epolls[epfd];
+}
+
+/* What the socket is ready for now, whether or not it was asked for. */
+static u8_t
+epoll_ready_events(struct lwip_socket *sock)
+{
+  u8_t ready = 0;
+
+  if (sock->lastdata || sock->rcvevent)
+    ready |= LWIP_EPOLLIN;
+  if (sock->sendevent)
+    ready |= LWIP_EPOLLOUT;
+
+  return ready;
+}
+
+/* Put the socket at the back of the ready list of its instance if it is
+ * ready for what it was registered for, and wake the task waiting on the
+ * instance.  Called with selectsem held, which lwip_epoll_close() takes
+ * before it frees the instance semaphore, so the semaphore is signalled
+ * here rather than once selectsem is released. */
+static void
+epoll_enqueue(struct lwip_socket *sock, int s)
+{
+  struct lwip_epoll *ep = &epolls[sock->epoll];
+
+  if (sock->epoll_queued || !(epoll_ready_events(sock) & sock->epoll_events))
+    return;
+
+  sock->epoll_queued = 1;
+  sock->epoll_next = -1;
+  if (ep->ready_tail >= 0)
+    sockets[ep->ready_tail].epoll_next = s;
+  else
+    ep->ready_head = s;
+  ep->ready_tail = s;
+
+  if (ep->waiting) {
+    ep->waiting = 0;
+    sys_sem_signal(ep->sem);
+  }
+}
+
+/* Take the socket out of its instance.  Called with selectsem held. */
+static void
+epoll_remove(struct lwip_socket *sock, int s)
+{
+  struct lwip_epoll *ep;
+  int prev, i;
+
+  if (sock->epoll < 0)
+    return;
+
+  ep = &epolls[sock->epoll];
+  if (sock->epoll_queued) {
+    prev = -1;
+    for (i = ep->ready_head; i != s; i = sockets[i].epoll_next)
+      prev = i;
+    if (prev >= 0)
+      sockets[prev].epoll_next = sock->epoll_next;
+    else
+      ep->ready_head = sock->epoll_next;
+    if (ep->ready_tail == s)
+      ep->ready_tail = prev;
+    sock->epoll_queued = 0;
+  }
+  sock->epoll = -1;
+}
+
+int
+lwip_epoll_create(void)
+{
+  int i;
+
+  if (!selectsem)
+    selectsem = sys_sem_new(1);
+  sys_sem_wait(selectsem);
+
+  for (i = 0; i < LWIP_EPOLL_INSTANCES; i++) {
+    if (!epolls[i].used) {
+      epolls[i].used = 1;
+      epolls[i].waiting = 0;
+      epolls[i].ready_head = -1;
+      epolls[i].ready_tail = -1;
+      epolls[i].sem = sys_sem_new(0);
+      sys_sem_signal(selectsem);
+      LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_epoll_create() = %d\n", i));
+      set_errno(0);
+      return i;
+    }
+  }
+
+  sys_sem_signal(selectsem);
+  set_errno(ENFILE);
+  return -1;
+}
+
+int
+lwip_epoll_close(int epfd)
+{
+  struct lwip_epoll *ep;
+  int i;
+
+  LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_epoll_close(%d)\n", epfd));
+  if (!selectsem)
+    selectsem = sys_sem_new(1);
+  sys_sem_wait(selectsem);
+
+  ep = get_epoll(epfd);
+  if (!ep) {
+    sys_sem_signal(selectsem);
+    return -1;
+  }
+
+  for (i = 0; i < NUM_SOCKETS; i++) {
+    if (sockets[i].conn && (sockets[i].epoll == epfd))
+      epoll_remove(&sockets[i], i);
+  }
+  sys_sem_free(ep->sem);
+  ep->used = 0;
+
+  sys_sem_signal(selectsem);
+  set_errno(0);
+  return 0;
+}
+
+int
+lwip_epoll_ctl(int epfd, int op, int s, u32_t events)
+{
+  struct lwip_socket *sock;
+  int err = 0;
+
+  LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_epoll_ctl(%d, %d, %d, 0x%lx)\n", epfd, op, s, (unsigned long)events));
+  if (!selectsem)
+    selectsem = sys_sem_new(1);
+  sys_sem_wait(selectsem);
+
+  sock = get_socket(s);
+  if (!get_epoll(epfd) || !sock) {
+    sys_sem_signal(selectsem);
+    set_errno(EBADF);
+    return -1;
+  }
+
+  switch (op) {
+    case LWIP_EPOLL_CTL_ADD:
+      if (sock->epoll >= 0) {
+        err = EEXIST;
+        break;
+      }
+      sock->epoll = epfd;
+      sock->epoll_events = (u8_t)(events & (LWIP_EPOLLIN | LWIP_EPOLLOUT));
+      epoll_enqueue(sock, s);
+      break;
+    case LWIP_EPOLL_CTL_MOD:
+      if (sock->epoll != epfd) {
+        err = ENOENT;
+        break;
+      }
+      /* A socket left queued that is no longer wanted is dropped by the
+       * next lwip_epoll_wait(). */
+      sock->epoll_events = (u8_t)(events & (LWIP_EPOLLIN | LWIP_EPOLLOUT));
+      epoll_enqueue(sock, s);
+      break;
+    case LWIP_EPOLL_CTL_DEL:
+      if (sock->epoll != epfd) {
+        err = ENOENT;
+        break;
+      }
+      epoll_remove(sock, s);
+      break;
+    default:
+      err = EINVAL;
+      break;
+  }
+
+  sys_sem_signal(selectsem);
+
+  set_errno(err);
+  return err ? -1 : 0;
+}
+
+int
+lwip_epoll_wait(int epfd, struct lwip_epoll_event *events, int maxevents, int timeout)
+{
+  struct lwip_epoll *ep;
+  struct lwip_socket *sock;
+  int s, i, nready;
+  u8_t ready;
+
+  if (!events || (maxevents <= 0)) {
+    set_errno(EINVAL);
+    return -1;
+  }
+
+  if (!selectsem)
+    selectsem = sys_sem_new(1);
+  sys_sem_wait(selectsem);
+
+  ep = get_epoll(epfd);
+  if (!ep) {
+    sys_sem_signal(selectsem);
+    return -1;
+  }
+
+  while (1) {
+    /* Only the sockets on the ready list are looked at, however many are
+     * registered. */
+    nready = 0;
+    while ((nready < maxevents) && (ep->ready_head >= 0)) {
+      s = ep->ready_head;
+      sock = &sockets[s];
+      ep->ready_head = sock->epoll_next;
+      if (ep->ready_head < 0)
+        ep->ready_tail = -1;
+      sock->epoll_queued = 0;
+
+      ready = epoll_ready_events(sock) & sock->epoll_events;
+      if (ready) {
+        events[nready].events = ready;
+        events[nready].fd = s;
+        nready++;
+      }
+    }
+
+    /* Readiness is level triggered: a socket that was reported goes to the
+     * back of the list again, and is dropped from it by a later call that
+     * finds it is no longer ready.  Nobody else waits on the instance, so
+     * there is no one to wake. */
+    for (i = 0; i < nready; i++)
+      epoll_enqueue(&sockets[events[i].fd], events[i].fd);
+
+    if (nready || (timeout == 0))
+      break;
+
+    ep->waiting = 1;
+    sys_sem_signal(selectsem);
+
+    /* sys_sem_wait_timeout() waits forever when given 0. */
+    i = sys_sem_wait_timeout(ep->sem, (timeout < 0) ? 0 : (u32_t)timeout);
+
+    sys_sem_wait(selectsem);
+    ep->waiting = 0;
+    if (i == 0) {
+      /* Check once more for an event that came in with the timeout. */
+      timeout = 0;
+    }
+  }
+
+  sys_sem_signal(selectsem);
+
+  LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_epoll_wait(%d): nready=%d\n", epfd, nready));
+  set_errno(0);
+  return nready;
+}
+
+#endif /* LWIP_EPOLL */
 
 int lwip_shutdown(int s, int how)
 {
@@ -84,6 +84,10 @@
 
 #if LWIP_DHCP /* don't build if not configured for use in lwipopt.h */
 
+#if LWIP_DHCP_LEASE_OPTIMISTIC && !defined(LWIP_DHCP_LEASE_CLOCK)
+#error "LWIP_DHCP_LEASE_OPTIMISTIC needs LWIP_DHCP_LEASE_CLOCK() to tell a cached lease has not expired"
+#endif
+
 /** global transaction identifier, must be
  *  unique for each DHCP request. We simply increment, starting
  *  with this value (easy to match with a packet analyzer) */
@@ -101,6 +105,12 @@ static void dhcp_bind(struct netif *netif);
 static err_t dhcp_decline(struct netif *netif);
 static err_t dhcp_rebind(struct netif *netif);
 static void dhcp_set_state(struct dhcp *dhcp, u8_t new_state);
+#if LWIP_DHCP_LEASE_CACHE
+static u8_t dhcp_lease_restore(struct netif *netif);
+static void dhcp_lease_save(struct netif *netif);
+static err_t dhcp_reboot(struct netif *netif);
+static void dhcp_reboot_failed(struct netif *netif);
+#endif /* LWIP_DHCP_LEASE_CACHE */
 
 /** receive, unfold, parse and free incoming messages */
 static void dhcp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, struct ip_addr *addr, u16_t port);
@@ -383,6 +393,25 @@ static void dhcp_timeout(struct netif *netif)
       dhcp_discover(netif);
     }
   }
+#if LWIP_DHCP_LEASE_CACHE
+  /* no answer to the INIT-REBOOT request? */
+  else if (dhcp->state == DHCP_REBOOTING) {
+    LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | DBG_STATE, ("dhcp_timeout(): REBOOTING, DHCP request timed out\n"));
+    if (dhcp->tries < DHCP_REBOOT_TRIES) {
+      dhcp_reboot(netif);
+#if LWIP_DHCP_LEASE_OPTIMISTIC
+    /* RFC 2131 allows a client to keep using an unexpired lease when no
+       server answers, while it tries to renew it as usual */
+    } else if (dhcp->offered_t0_lease != 0) {
+      LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | DBG_STATE, ("dhcp_timeout(): REBOOTING, keeping the cached lease\n"));
+      dhcp_bind(netif);
+#endif /* LWIP_DHCP_LEASE_OPTIMISTIC */
+    } else {
+      LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | DBG_STATE, ("dhcp_timeout(): REBOOTING, DISCOVERING\n"));
+      dhcp_reboot_failed(netif);
+    }
+  }
+#endif /* LWIP_DHCP_LEASE_CACHE */
 }
 
 /**
@@ -555,6 +584,22 @@ err_t dhcp_start(struct netif *netif)
     return ERR_MEM;
   }
   LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE, ("dhcp_start(): starting DHCP configuration\n"));
+#if LWIP_DHCP_LEASE_CACHE
+  /* ask for the cached lease back rather than for any lease */
+  if (dhcp_lease_restore(netif)) {
+    result = dhcp_reboot(netif);
+#if LWIP_DHCP_LEASE_OPTIMISTIC
+    /* use the address while the server confirms it, if it has not expired */
+    if ((result == ERR_OK) && (dhcp->offered_t0_lease != 0)) {
+      LWIP_DEBUGF(DHCP_DEBUG | DBG_STATE, ("dhcp_start(): using cached IP: 0x%08"X32_F"\n", dhcp->offered_ip_addr.addr));
+      netif_set_ipaddr(netif, &dhcp->offered_ip_addr);
+      netif_set_netmask(netif, &dhcp->offered_sn_mask);
+      netif_set_gw(netif, &dhcp->offered_gw_addr);
+      netif_set_up(netif);
+    }
+#endif /* LWIP_DHCP_LEASE_OPTIMISTIC */
+  } else
+#endif /* LWIP_DHCP_LEASE_CACHE */
   /* (re)start the DHCP negotiation */
   result = dhcp_discover(netif);
   if (result != ERR_OK) {
@@ -668,6 +713,10 @@ static err_t dhcp_decline(struct netif *netif)
   u16_t msecs;
   LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | 3, ("dhcp_decline()\n"));
   dhcp_set_state(dhcp, DHCP_BACKING_OFF);
+#if LWIP_DHCP_LEASE_CACHE
+  /* the address is in use, so it must not be asked for after a reboot */
+  dhcp_lease_store(netif, NULL);
+#endif /* LWIP_DHCP_LEASE_CACHE */
   /* create and initialize the DHCP message header */
   result = dhcp_create_request(netif);
   if (result == ERR_OK)
@@ -818,6 +867,9 @@ static void dhcp_bind(struct netif *netif)
   netif_set_up(netif);
   /* netif is now bound to DHCP leased address */
   dhcp_set_state(dhcp, DHCP_BOUND);
+#if LWIP_DHCP_LEASE_CACHE
+  dhcp_lease_save(netif);
+#endif /* LWIP_DHCP_LEASE_CACHE */
 }
 
 /**
@@ -948,6 +1000,10 @@ err_t dhcp_release(struct netif *netif)
   dhcp->offered_gw_addr.addr = dhcp->offered_bc_addr.addr = 0;
   dhcp->offered_t0_lease = dhcp->offered_t1_renew = dhcp->offered_t2_rebind = 0;
   dhcp->dns_count = 0;
+#if LWIP_DHCP_LEASE_CACHE
+  /* the lease is given back, so it must not be asked for after a reboot */
+  dhcp_lease_store(netif, NULL);
+#endif /* LWIP_DHCP_LEASE_CACHE */
   
   /* create and initialize the DHCP message header */
   result = dhcp_create_request(netif);
@@ -981,6 +1037,170 @@ err_t dhcp_release(struct netif *netif)
   /* TODO: netif_down(netif); */
   return result;
 }
+#if LWIP_DHCP_LEASE_CACHE
+/**
+ * Take the lease cached by dhcp_lease_save() as the offer to ask for.
+ *
+ * The remaining lease time is only known when LWIP_DHCP_LEASE_CLOCK() is
+ * defined, otherwise offered_t0_lease is left 0.
+ *
+ * @param netif the netif under DHCP control
+ * @return 1 if there was a cached lease that has not expired
+ */
+static u8_t dhcp_lease_restore(struct netif *netif)
+{
+  struct dhcp *dhcp = netif->dhcp;
+  struct dhcp_lease lease;
+#ifdef LWIP_DHCP_LEASE_CLOCK
+  u32_t now;
+#endif
+
+  if (!dhcp_lease_load(netif, &lease) || (lease.ip_addr.addr == 0)) {
+    LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE, ("dhcp_lease_restore(): no cached lease\n"));
+    return 0;
+  }
+
+  dhcp->offered_t0_lease = 0;
+#ifdef LWIP_DHCP_LEASE_CLOCK
+  if (lease.expiry == 0xffffffffUL) {
+    dhcp->offered_t0_lease = 0xffffffffUL;
+  } else if (lease.expiry != 0) {
+    now = LWIP_DHCP_LEASE_CLOCK();
+    if ((s32_t)(lease.expiry - now) <= 0) {
+      LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE, ("dhcp_lease_restore(): cached lease expired\n"));
+      dhcp_lease_store(netif, NULL);
+      return 0;
+    }
+    dhcp->offered_t0_lease = lease.expiry - now;
+  }
+#endif /* LWIP_DHCP_LEASE_CLOCK */
+
+  ip_addr_set(&dhcp->offered_ip_addr, &lease.ip_addr);
+  ip_addr_set(&dhcp->offered_sn_mask, &lease.sn_mask);
+  ip_addr_set(&dhcp->offered_gw_addr, &lease.gw_addr);
+  ip_addr_set(&dhcp->server_ip_addr, &lease.server_ip_addr);
+  /* renew and rebind at the usual shares of what is left, in case the
+     lease is used without being confirmed */
+  if (dhcp->offered_t0_lease == 0xffffffffUL) {
+    dhcp->offered_t1_renew = dhcp->offered_t2_rebind = 0xffffffffUL;
+  } else {
+    dhcp->offered_t1_renew = dhcp->offered_t0_lease / 2;
+    dhcp->offered_t2_rebind = dhcp->offered_t0_lease - dhcp->offered_t0_lease / 8;
+  }
+  LWIP_DEBUGF(DHCP_DEBUG | DBG_STATE, ("dhcp_lease_restore(): cached 0x%08"X32_F" for %"U32_F" secs\n",
+    dhcp->offered_ip_addr.addr, dhcp->offered_t0_lease));
+  return 1;
+}
+
+/**
+ * Hand the lease the interface was just bound to to the application to keep.
+ *
+ * @param netif the netif under DHCP control
+ */
+static void dhcp_lease_save(struct netif *netif)
+{
+  struct dhcp *dhcp = netif->dhcp;
+  struct dhcp_lease lease;
+
+  /* the mask and gateway the interface ended up with, which dhcp_bind()
+     may have chosen itself */
+  ip_addr_set(&lease.ip_addr, &dhcp->offered_ip_addr);
+  ip_addr_set(&lease.sn_mask, &netif->netmask);
+  ip_addr_set(&lease.gw_addr, &netif->gw);
+  ip_addr_set(&lease.server_ip_addr, &dhcp->server_ip_addr);
+  lease.expiry = 0;
+#ifdef LWIP_DHCP_LEASE_CLOCK
+  if (dhcp->offered_t0_lease == 0xffffffffUL) {
+    lease.expiry = 0xffffffffUL;
+  } else if (dhcp->offered_t0_lease != 0) {
+    lease.expiry = LWIP_DHCP_LEASE_CLOCK() + dhcp->offered_t0_lease;
+  }
+#endif /* LWIP_DHCP_LEASE_CLOCK */
+  dhcp_lease_store(netif, &lease);
+}
+
+/**
+ * Ask for the cached lease again, RFC 2131 INIT-REBOOT.
+ *
+ * Unlike a DISCOVER this takes a single exchange with the server, which
+ * answers with an ACK if the address is still ours, or a NAK.
+ *
+ * @param netif the netif under DHCP control
+ * @return lwIP specific error (see error.h)
+ */
+static err_t dhcp_reboot(struct netif *netif)
+{
+  struct dhcp *dhcp = netif->dhcp;
+  err_t result;
+  u16_t msecs;
+  LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | 3, ("dhcp_reboot()\n"));
+  dhcp_set_state(dhcp, DHCP_REBOOTING);
+
+  /* create and initialize the DHCP message header */
+  result = dhcp_create_request(netif);
+  if (result == ERR_OK) {
+    dhcp_option(dhcp, DHCP_OPTION_MESSAGE_TYPE, DHCP_OPTION_MESSAGE_TYPE_LEN);
+    dhcp_option_byte(dhcp, DHCP_REQUEST);
+
+    dhcp_option(dhcp, DHCP_OPTION_MAX_MSG_SIZE, DHCP_OPTION_MAX_MSG_SIZE_LEN);
+    dhcp_option_short(dhcp, 576);
+
+    /* MUST request the cached address, and MUST NOT name a server */
+    dhcp_option(dhcp, DHCP_OPTION_REQUESTED_IP, 4);
+    dhcp_option_long(dhcp, ntohl(dhcp->offered_ip_addr.addr));
+
+    dhcp_option(dhcp, DHCP_OPTION_PARAMETER_REQUEST_LIST, 4/*num options*/);
+    dhcp_option_byte(dhcp, DHCP_OPTION_SUBNET_MASK);
+    dhcp_option_byte(dhcp, DHCP_OPTION_ROUTER);
+    dhcp_option_byte(dhcp, DHCP_OPTION_BROADCAST);
+    dhcp_option_byte(dhcp, DHCP_OPTION_DNS_SERVER);
+
+    dhcp_option_trailer(dhcp);
+    /* ciaddr MUST be zero, even while the cached address is in use */
+    dhcp->msg_out->ciaddr.addr = 0;
+
+    pbuf_realloc(dhcp->p_out, sizeof(struct dhcp_msg) - DHCP_OPTIONS_LEN + dhcp->options_out_len);
+
+    /* set receive callback function with netif as user data */
+    udp_recv(dhcp->pcb, dhcp_recv, netif);
+    udp_bind(dhcp->pcb, IP_ADDR_ANY, DHCP_CLIENT_PORT);
+    udp_connect(dhcp->pcb, IP_ADDR_ANY, DHCP_SERVER_PORT);
+    udp_sendto(dhcp->pcb, dhcp->p_out, IP_ADDR_BROADCAST, DHCP_SERVER_PORT);
+    dhcp_delete_request(netif);
+    LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | DBG_STATE, ("dhcp_reboot: REBOOTING\n"));
+  } else {
+    LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | 2, ("dhcp_reboot: could not allocate DHCP request\n"));
+  }
+  dhcp->tries++;
+  /* a server on the link answers at once, so do not wait as long as a
+     DISCOVER would before falling back to one */
+  msecs = dhcp->tries * 1000;
+  dhcp->request_timeout = (msecs + DHCP_FINE_TIMER_MSECS - 1) / DHCP_FINE_TIMER_MSECS;
+  LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | DBG_STATE, ("dhcp_reboot(): set request timeout %"U16_F" msecs\n", msecs));
+  return result;
+}
+
+/**
+ * No lease to go back to: remove the cached address if it was already in use
+ * and start over with a DISCOVER.
+ *
+ * @param netif the netif under DHCP control
+ */
+static void dhcp_reboot_failed(struct netif *netif)
+{
+  LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | DBG_STATE, ("dhcp_reboot_failed()\n"));
+#if LWIP_DHCP_LEASE_OPTIMISTIC
+  if (netif->ip_addr.addr != 0) {
+    netif_set_down(netif);
+    netif_set_ipaddr(netif, IP_ADDR_ANY);
+    netif_set_gw(netif, IP_ADDR_ANY);
+    netif_set_netmask(netif, IP_ADDR_ANY);
+  }
+#endif /* LWIP_DHCP_LEASE_OPTIMISTIC */
+  dhcp_discover(netif);
+}
+#endif /* LWIP_DHCP_LEASE_CACHE */
+
 /**
  * Remove the DHCP client from the interface.
  *
@@ -1231,8 +1451,23 @@ static void dhcp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, struct ip_
       dhcp_bind(netif);
 #endif
     }
+#if LWIP_DHCP_LEASE_CACHE
+    /* the cached lease is still ours? */
+    else if (dhcp->state == DHCP_REBOOTING) {
+      /* the lease time and options may have changed since it was cached */
+      dhcp_handle_ack(netif);
+      dhcp->request_timeout = 0;
+#if DHCP_DOES_ARP_CHECK
+      /* another host may have taken the address while we were down */
+      dhcp_check(netif);
+#else
+      /* bind interface to the acknowledged lease address */
+      dhcp_bind(netif);
+#endif
+    }
+#endif /* LWIP_DHCP_LEASE_CACHE */
     /* already bound to the given lease address? */
-    else if ((dhcp->state == DHCP_REBOOTING) || (dhcp->state == DHCP_REBINDING) || (dhcp->state == DHCP_RENEWING)) {
+    else if ((dhcp->state == DHCP_REBINDING) || (dhcp->state == DHCP_RENEWING)) {
       dhcp->request_timeout = 0;
       dhcp_bind(netif);
     }
@@ -1243,6 +1478,14 @@ static void dhcp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, struct ip_
      (dhcp->state == DHCP_REBINDING) || (dhcp->state == DHCP_RENEWING  ))) {
     LWIP_DEBUGF(DHCP_DEBUG | DBG_TRACE | 1, ("DHCP_NAK received\n"));
     dhcp->request_timeout = 0;
+#if LWIP_DHCP_LEASE_CACHE
+    /* the lease is no longer ours */
+    dhcp_lease_store(netif, NULL);
+    /* RFC 2131 says to restart at once when the cached lease is refused */
+    if (dhcp->state == DHCP_REBOOTING) {
+      dhcp_reboot_failed(netif);
+    } else
+#endif /* LWIP_DHCP_LEASE_CACHE */
     dhcp_handle_nak(netif);
   }
   /* received a DHCP_OFFER in DHCP_SELECTING state? */
@@ -58,7 +58,23 @@
 #ifndef LWIP_CHKSUM
 #define LWIP_CHKSUM lwip_standard_chksum
 
-#if 1 /* Version A */
+/* LWIP_CHKSUM_ALGORITHM selects one of the versions below:
+ *
+ * 1 - Version A, one octet pair per iteration through byte loads.
+ * 2 - Version B, aligned 16-bit loads.
+ * 3 - Version C, aligned 32-bit loads, two per iteration.
+ * 4 - Version D, aligned 32-bit loads into a 32-bit accumulator, four per
+ *     iteration.
+ * 5 - Version E, aligned 32-bit loads into a 64-bit accumulator, four per
+ *     iteration, so no carries have to be added back inside the loop.
+ * 6 - Version F, Version D with the inner loop in ARM assembler (GCC, ARM
+ *     or Thumb-2 state), using a chain of add with carry instructions.
+ */
+#ifndef LWIP_CHKSUM_ALGORITHM
+#define LWIP_CHKSUM_ALGORITHM 4
+#endif
+
+#if (LWIP_CHKSUM_ALGORITHM == 1) /* Version A */
 /**
  * lwip checksum
  *
@@ -109,7 +125,7 @@ lwip_standard_chksum(void *dataptr, u16_t len)
 }
 #endif
 
-#if 0 /* Version B */
+#if (LWIP_CHKSUM_ALGORITHM == 2) /* Version B */
 /*
  * Curt McDowell
  * Broadcom Corp.
@@ -161,7 +177,7 @@ lwip_standard_chksum(void *dataptr, int len)
 }
 #endif
 
-#if 0 /* Version C */
+#if (LWIP_CHKSUM_ALGORITHM == 3) /* Version C */
 /**
  * An optimized checksum routine. Basically, it uses loop-unrolling on
  * the checksum loop, treating the head and tail bytes specially, whereas
@@ -236,6 +252,140 @@ lwip_standard_chksum(void *dataptr, int len)
 }
 #endif
 
+#if (LWIP_CHKSUM_ALGORITHM >= 4) && (LWIP_CHKSUM_ALGORITHM <= 6)
+/* Add a 32-bit word to a 32-bit sum, adding the carry back in. */
+#define LWIP_CHKSUM_ADD32(sum, w) do { u32_t w_ = (w); (sum) += w_; if ((sum) < w_) (sum)++; } while (0)
+
+#if (LWIP_CHKSUM_ALGORITHM == 6)
+#if !defined(__GNUC__) || !defined(__arm__) || (defined(__thumb__) && !defined(__thumb2__))
+#error LWIP_CHKSUM_ALGORITHM 6 requires GCC in ARM or Thumb-2 state
+#endif
+
+/* Add the four words at pl to sum, returning the advanced pointer. */
+static u32_t *
+lwip_chksum_add16_arm(u32_t *sum, u32_t *pl)
+{
+  u32_t acc = *sum;
+
+  __asm__ ("ldmia  %[p]!, {r4-r7}    \n\t"
+           "adds   %[s], %[s], r4    \n\t"
+           "adcs   %[s], %[s], r5    \n\t"
+           "adcs   %[s], %[s], r6    \n\t"
+           "adcs   %[s], %[s], r7    \n\t"
+           "adc    %[s], %[s], #0"
+           : [s] "+r" (acc), [p] "+r" (pl)
+           :
+           : "r4", "r5", "r6", "r7", "cc", "memory");
+  *sum = acc;
+  return pl;
+}
+#endif /* LWIP_CHKSUM_ALGORITHM == 6 */
+
+/**
+ * Versions D, E and F: as Version C, the head and tail octets are handled
+ * separately so that the bulk of the data is summed with aligned 32-bit
+ * loads, but the inner loop sums 16 octets per iteration.  Version E defers
+ * the carries to a 64-bit accumulator, which suits cores with a 64-bit add or
+ * an add with carry instruction.
+ *
+ * @param dataptr points to start of data to be summed at any boundary
+ * @param len length of data to be summed, up to 64k
+ * @return host order (!) lwip checksum (non-inverted Internet sum)
+ */
+static u16_t
+lwip_standard_chksum(void *dataptr, int len)
+{
+  u8_t *pb = (u8_t *)dataptr;
+  u16_t *ps, t = 0;
+  u32_t *pl;
+  u32_t sum = 0;
+  /* starts at odd byte address? */
+  int odd = ((mem_ptr_t)pb & 1);
+
+  if (odd && len > 0) {
+    ((u8_t *)&t)[1] = *pb++;
+    len--;
+  }
+
+  ps = (u16_t *)pb;
+
+  if (((mem_ptr_t)ps & 3) && len > 1) {
+    sum += *ps++;
+    len -= 2;
+  }
+
+  pl = (u32_t *)ps;
+
+#if (LWIP_CHKSUM_ALGORITHM == 5)
+  {
+    /* 64k of data cannot overflow the 64-bit accumulator. */
+    unsigned long long acc = sum;
+
+    while (len > 15) {
+      acc += pl[0];
+      acc += pl[1];
+      acc += pl[2];
+      acc += pl[3];
+      pl += 4;
+      len -= 16;
+    }
+
+    while (len > 3) {
+      acc += *pl++;
+      len -= 4;
+    }
+
+    acc = (acc >> 32) + (acc & 0xffffffffUL);
+    acc = (acc >> 32) + (acc & 0xffffffffUL);
+    sum = (u32_t)acc;
+  }
+#else
+  while (len > 15) {
+#if (LWIP_CHKSUM_ALGORITHM == 6)
+    pl = lwip_chksum_add16_arm(&sum, pl);
+#else
+    LWIP_CHKSUM_ADD32(sum, pl[0]);
+    LWIP_CHKSUM_ADD32(sum, pl[1]);
+    LWIP_CHKSUM_ADD32(sum, pl[2]);
+    LWIP_CHKSUM_ADD32(sum, pl[3]);
+    pl += 4;
+#endif
+    len -= 16;
+  }
+
+  while (len > 3) {
+    LWIP_CHKSUM_ADD32(sum, *pl++);
+    len -= 4;
+  }
+#endif /* LWIP_CHKSUM_ALGORITHM == 5 */
+
+  /* make room in upper bits */
+  sum = (sum >> 16) + (sum & 0xffff);
+
+  ps = (u16_t *)pl;
+
+  /* 16-bit aligned word remaining? */
+  if (len > 1) {
+    sum += *ps++;
+    len -= 2;
+  }
+
+  /* dangling tail byte remaining? */
+  if (len > 0)                  /* include odd byte */
+    ((u8_t *)&t)[0] = *(u8_t *)ps;
+
+  sum += t;                     /* add end bytes */
+
+  while (sum >> 16)             /* combine halves */
+    sum = (sum >> 16) + (sum & 0xffff);
+
+  if (odd)
+    sum = ((sum & 0xff) << 8) | ((sum & 0xff00) >> 8);
+
+  return (u16_t)sum;
+}
+#endif /* LWIP_CHKSUM_ALGORITHM >= 4 */
+
 #endif /* LWIP_CHKSUM */
 
 /* inet_chksum_pseudo:
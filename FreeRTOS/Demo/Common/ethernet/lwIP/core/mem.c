@@ -88,6 +88,145 @@ static struct mem *lfree;   /* pointer to the lowest free block */
 
 static sys_sem_t mem_sem;
 
+#if MEM_USE_SIZE_CLASSES
+/* The size classes are arrays of fixed size blocks, one after the other
+   in mem_class_ram, each with a list of its free blocks.  A block is
+   found and returned under SYS_ARCH_PROTECT in a few steps whatever the
+   state of the heap, and the class of a block follows from its address,
+   so blocks carry no header. */
+#define MEM_CLASS_BLOCK_SIZE(n) MEM_ALIGN_SIZE(MEM_CLASS##n##_SIZE)
+#define MEM_CLASS_RAM_SIZE (MEM_CLASS_BLOCK_SIZE(0) * MEM_CLASS0_NUM + \
+                            MEM_CLASS_BLOCK_SIZE(1) * MEM_CLASS1_NUM + \
+                            MEM_CLASS_BLOCK_SIZE(2) * MEM_CLASS2_NUM + \
+                            MEM_CLASS_BLOCK_SIZE(3) * MEM_CLASS3_NUM)
+
+struct mem_class_block {
+  struct mem_class_block *next;
+};
+
+static const u16_t mem_class_sizes[MEM_CLASS_MAX] = {
+  MEM_CLASS_BLOCK_SIZE(0), MEM_CLASS_BLOCK_SIZE(1),
+  MEM_CLASS_BLOCK_SIZE(2), MEM_CLASS_BLOCK_SIZE(3)
+};
+
+static const u16_t mem_class_nums[MEM_CLASS_MAX] = {
+  MEM_CLASS0_NUM, MEM_CLASS1_NUM, MEM_CLASS2_NUM, MEM_CLASS3_NUM
+};
+
+static u8_t mem_class_ram[MEM_CLASS_RAM_SIZE + MEM_ALIGNMENT];
+static u8_t *mem_class_start[MEM_CLASS_MAX + 1];
+static struct mem_class_block *mem_class_free_list[MEM_CLASS_MAX];
+
+static void
+mem_class_init(void)
+{
+  u8_t i;
+  u16_t j;
+  u8_t *p;
+  struct mem_class_block *block;
+
+  p = (u8_t *)MEM_ALIGN(mem_class_ram);
+  for (i = 0; i < MEM_CLASS_MAX; i++) {
+    LWIP_ASSERT("mem_class_init: class sizes ascending",
+      i == 0 || mem_class_sizes[i] >= mem_class_sizes[i - 1]);
+    LWIP_ASSERT("mem_class_init: block holds a list pointer",
+      mem_class_sizes[i] >= sizeof(struct mem_class_block));
+    mem_class_start[i] = p;
+    mem_class_free_list[i] = NULL;
+    for (j = 0; j < mem_class_nums[i]; j++) {
+      block = (struct mem_class_block *)p;
+      block->next = mem_class_free_list[i];
+      mem_class_free_list[i] = block;
+      p += mem_class_sizes[i];
+    }
+#if MEM_STATS
+    lwip_stats.mem_class[i].avail = mem_class_nums[i];
+#endif /* MEM_STATS */
+  }
+  mem_class_start[MEM_CLASS_MAX] = p;
+}
+
+/* A block of the smallest class that size fits in, or NULL when size is
+   larger than every class or that class is empty. */
+static void *
+mem_class_malloc(mem_size_t size)
+{
+  u8_t i;
+  struct mem_class_block *block;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  for (i = 0; i < MEM_CLASS_MAX; i++) {
+    if (size <= mem_class_sizes[i] && mem_class_nums[i] != 0) {
+      break;
+    }
+  }
+  if (i == MEM_CLASS_MAX) {
+    return NULL;
+  }
+
+  SYS_ARCH_PROTECT(old_level);
+  block = mem_class_free_list[i];
+  if (block != NULL) {
+    mem_class_free_list[i] = block->next;
+#if MEM_STATS
+    if (++lwip_stats.mem_class[i].used > lwip_stats.mem_class[i].max) {
+      lwip_stats.mem_class[i].max = lwip_stats.mem_class[i].used;
+    }
+  } else {
+    ++lwip_stats.mem_class[i].err;
+#endif /* MEM_STATS */
+  }
+  SYS_ARCH_UNPROTECT(old_level);
+
+  if (block == NULL) {
+    LWIP_DEBUGF(MEM_DEBUG | 2, ("mem_class_malloc: class %"U16_F" empty\n", (u16_t)i));
+  }
+  return block;
+}
+
+static void
+mem_class_free(void *rmem)
+{
+  u8_t i;
+  struct mem_class_block *block;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  i = MEM_CLASS_MAX - 1;
+  while ((u8_t *)rmem < mem_class_start[i]) {
+    i--;
+  }
+  LWIP_ASSERT("mem_class_free: start of a block",
+    ((u8_t *)rmem - mem_class_start[i]) % mem_class_sizes[i] == 0);
+
+  block = (struct mem_class_block *)rmem;
+  SYS_ARCH_PROTECT(old_level);
+  block->next = mem_class_free_list[i];
+  mem_class_free_list[i] = block;
+#if MEM_STATS
+  --lwip_stats.mem_class[i].used;
+#endif /* MEM_STATS */
+  SYS_ARCH_UNPROTECT(old_level);
+}
+
+#define MEM_IS_CLASS_BLOCK(rmem) ((u8_t *)(rmem) >= mem_class_start[0] && \
+                                  (u8_t *)(rmem) < mem_class_start[MEM_CLASS_MAX])
+
+/* The block size and the number of blocks of a class. */
+u16_t
+mem_class_size(u8_t cls)
+{
+  LWIP_ASSERT("mem_class_size: cls < MEM_CLASS_MAX", cls < MEM_CLASS_MAX);
+  return mem_class_sizes[cls];
+}
+
+u16_t
+mem_class_count(u8_t cls)
+{
+  LWIP_ASSERT("mem_class_count: cls < MEM_CLASS_MAX", cls < MEM_CLASS_MAX);
+  return mem_class_nums[cls];
+}
+#endif /* MEM_USE_SIZE_CLASSES */
+
 static void
 plug_holes(struct mem *mem)
 {
@@ -149,6 +288,10 @@ mem_init(void)
 #if MEM_STATS
   lwip_stats.mem.avail = MEM_SIZE;
 #endif /* MEM_STATS */
+
+#if MEM_USE_SIZE_CLASSES
+  mem_class_init();
+#endif /* MEM_USE_SIZE_CLASSES */
 }
 
 void
@@ -161,6 +304,13 @@ mem_free(void *rmem)
     return;
   }
 
+#if MEM_USE_SIZE_CLASSES
+  if (MEM_IS_CLASS_BLOCK(rmem)) {
+    mem_class_free(rmem);
+    return;
+  }
+#endif /* MEM_USE_SIZE_CLASSES */
+
   sys_sem_wait(mem_sem);
 
   LWIP_ASSERT("mem_free: legal memory", (u8_t *)rmem >= (u8_t *)ram &&
@@ -199,6 +349,13 @@ mem_realloc(void *rmem, mem_size_t newsize)
   mem_size_t ptr, ptr2;
   struct mem *mem, *mem2;
 
+#if MEM_USE_SIZE_CLASSES
+  /* Blocks keep their size, shrinking one leaves it as it is. */
+  if (MEM_IS_CLASS_BLOCK(rmem)) {
+    return rmem;
+  }
+#endif /* MEM_USE_SIZE_CLASSES */
+
   /* Expand the size of the allocated memory region so that we can
      adjust for alignment. */
   if ((newsize % MEM_ALIGNMENT) != 0) {
@@ -259,6 +416,13 @@ mem_malloc(mem_size_t size)
     return NULL;
   }
 
+#if MEM_USE_SIZE_CLASSES
+  mem = (struct mem *)mem_class_malloc(size);
+  if (mem != NULL) {
+    return mem;
+  }
+#endif /* MEM_USE_SIZE_CLASSES */
+
   /* Expand the size of the allocated memory region so that we can
      adjust for alignment. */
   if ((size % MEM_ALIGNMENT) != 0) {
@@ -333,6 +497,13 @@ mem_malloc(mem_size_t size)
     return NULL;
   }
 
+#if MEM_USE_SIZE_CLASSES
+  mem = (struct mem *)mem_class_malloc(size);
+  if (mem != NULL) {
+    return mem;
+  }
+#endif /* MEM_USE_SIZE_CLASSES */
+
   /* Expand the size of the allocated memory region so that we can
      adjust for alignment. */
   if ((size % MEM_ALIGNMENT) != 0) {
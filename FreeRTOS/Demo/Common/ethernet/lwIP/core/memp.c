@@ -236,3 +236,19 @@ memp_free(memp_t type, void *mem)
   sys_sem_signal(mutex);
 #endif /* SYS_LIGHTWEIGHT_PROT */  
 }
+
+/* The number of bytes one element of a pool takes, including the memp
+   header, and the number of elements configured for the pool. */
+u16_t
+memp_size(memp_t type)
+{
+  LWIP_ASSERT("memp_size: type < MEMP_MAX", type < MEMP_MAX);
+  return MEMP_SIZE + memp_sizes[type];
+}
+
+u16_t
+memp_count(memp_t type)
+{
+  LWIP_ASSERT("memp_count: type < MEMP_MAX", type < MEMP_MAX);
+  return memp_num[type];
+}
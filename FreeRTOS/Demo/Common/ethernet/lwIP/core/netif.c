@@ -82,6 +82,7 @@ netif_add(struct netif *netif, struct ip_addr *ipaddr, struct ip_addr *netmask,
   /* remember netif specific state information data */
   netif->state = state;
   netif->num = netifnum++;
+  netif->arp_hint = 0;
   netif->input = input;
 
   netif_set_addr(netif, ipaddr, netmask, gw);
@@ -38,16 +38,131 @@
 
 #include "lwip/stats.h"
 #include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/sys.h"
 
 
 #if LWIP_STATS
 struct stats_ lwip_stats;
 
+static const char * const pool_names[STATS_POOL_MAX] = {
+  "PBUF", "RAW_PCB", "UDP_PCB", "TCP_PCB", "TCP_PCB_LISTEN", "TCP_SEG",
+  "NETBUF", "NETCONN", "API_MSG", "TCPIP_MSG", "SYS_TIMEOUT", "PBUF_POOL"
+#if MEM_USE_SIZE_CLASSES
+  , "MEM_CLASS0", "MEM_CLASS1", "MEM_CLASS2", "MEM_CLASS3"
+#endif /* MEM_USE_SIZE_CLASSES */
+};
+
 void
 stats_init(void)
 {
   memset(&lwip_stats, 0, sizeof(struct stats_));
 }
+
+/* Restart the high water marks from the current use and clear the
+   allocation failures, e.g. once the system is up and a soak run starts. */
+void
+stats_reset_max(void)
+{
+  s16_t i;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  SYS_ARCH_PROTECT(old_level);
+  lwip_stats.pbuf.max = lwip_stats.pbuf.used;
+  lwip_stats.pbuf.err = 0;
+  lwip_stats.mem.max = lwip_stats.mem.used;
+  lwip_stats.mem.err = 0;
+#if MEM_USE_SIZE_CLASSES
+  for (i = 0; i < MEM_CLASS_MAX; i++) {
+    lwip_stats.mem_class[i].max = lwip_stats.mem_class[i].used;
+    lwip_stats.mem_class[i].err = 0;
+  }
+#endif /* MEM_USE_SIZE_CLASSES */
+  for (i = 0; i < MEMP_MAX; i++) {
+    lwip_stats.memp[i].max = lwip_stats.memp[i].used;
+    lwip_stats.memp[i].err = 0;
+  }
+  SYS_ARCH_UNPROTECT(old_level);
+}
+
+/* The high water mark plus STATS_POOL_MARGIN percent, but no more than is
+   configured, when the pool never ran dry.  When it did the high water mark
+   is the pool size, and only says the demand was larger, so the margin is
+   added to the configured size instead. */
+static u16_t
+stats_pool_recommend(u16_t num, u16_t max, u16_t err)
+{
+  u32_t recommended;
+
+  if (err != 0) {
+    recommended = num + ((u32_t)num * STATS_POOL_MARGIN + 99) / 100;
+    if (recommended == num) {
+      recommended++;
+    }
+  } else {
+    recommended = max + ((u32_t)max * STATS_POOL_MARGIN + 99) / 100;
+    if (recommended > num) {
+      recommended = num;
+    }
+    /* Keep a pool that was not used during the run. */
+    if (recommended == 0 && num != 0) {
+      recommended = 1;
+    }
+  }
+  return recommended > 0xffff ? 0xffff : (u16_t)recommended;
+}
+
+/* Fill in the size, use and recommended size of a pool, pool being a
+   memp_t, STATS_POOL_PBUF_POOL or STATS_POOL_MEM_CLASS plus a class.  Pools without statistics report their
+   configured size as the recommendation. */
+void
+stats_pool_get(u8_t pool, struct stats_pool *info)
+{
+  LWIP_ASSERT("stats_pool_get: pool < STATS_POOL_MAX", pool < STATS_POOL_MAX);
+
+  info->name = pool_names[pool];
+  info->used = info->max = info->err = 0;
+
+  if (pool == STATS_POOL_PBUF_POOL) {
+    info->size = MEM_ALIGN_SIZE(PBUF_POOL_BUFSIZE + sizeof(struct pbuf));
+    info->num = PBUF_POOL_SIZE;
+#if PBUF_STATS
+    info->used = lwip_stats.pbuf.used;
+    info->max = lwip_stats.pbuf.max;
+    info->err = lwip_stats.pbuf.err;
+#else
+    info->recommended = info->num;
+    return;
+#endif /* PBUF_STATS */
+#if MEM_USE_SIZE_CLASSES
+  } else if (pool >= STATS_POOL_MEM_CLASS) {
+    info->size = mem_class_size(pool - STATS_POOL_MEM_CLASS);
+    info->num = mem_class_count(pool - STATS_POOL_MEM_CLASS);
+#if MEM_STATS
+    info->used = (u16_t)lwip_stats.mem_class[pool - STATS_POOL_MEM_CLASS].used;
+    info->max = (u16_t)lwip_stats.mem_class[pool - STATS_POOL_MEM_CLASS].max;
+    info->err = (u16_t)lwip_stats.mem_class[pool - STATS_POOL_MEM_CLASS].err;
+#else
+    info->recommended = info->num;
+    return;
+#endif /* MEM_STATS */
+#endif /* MEM_USE_SIZE_CLASSES */
+  } else {
+    info->size = memp_size((memp_t)pool);
+    info->num = memp_count((memp_t)pool);
+#if MEMP_STATS
+    info->used = (u16_t)lwip_stats.memp[pool].used;
+    info->max = (u16_t)lwip_stats.memp[pool].max;
+    info->err = (u16_t)lwip_stats.memp[pool].err;
+#else
+    info->recommended = info->num;
+    return;
+#endif /* MEMP_STATS */
+  }
+
+  info->recommended = stats_pool_recommend(info->num, info->max, info->err);
+}
 #if LWIP_STATS_DISPLAY
 void
 stats_display_proto(struct stats_proto *proto, char *name)
@@ -95,8 +210,6 @@ void
 stats_display(void)
 {
   s16_t i;
-  char * memp_names[] = {"PBUF", "RAW_PCB", "UDP_PCB", "TCP_PCB", "TCP_PCB_LISTEN",
-        "TCP_SEG", "NETBUF", "NETCONN", "API_MSG", "TCP_MSG", "TIMEOUT"};
   stats_display_proto(&lwip_stats.link, "LINK");
   stats_display_proto(&lwip_stats.ip_frag, "IP_FRAG");
   stats_display_proto(&lwip_stats.ip, "IP");
@@ -105,11 +218,35 @@ stats_display(void)
   stats_display_proto(&lwip_stats.tcp, "TCP");
   stats_display_pbuf(&lwip_stats.pbuf);
   stats_display_mem(&lwip_stats.mem, "HEAP");
+#if MEM_USE_SIZE_CLASSES
+  for (i = 0; i < MEM_CLASS_MAX; i++) {
+    stats_display_mem(&lwip_stats.mem_class[i], (char *)pool_names[STATS_POOL_MEM_CLASS + i]);
+  }
+#endif /* MEM_USE_SIZE_CLASSES */
   for (i = 0; i < MEMP_MAX; i++) {
-    stats_display_mem(&lwip_stats.memp[i], memp_names[i]);
+    stats_display_mem(&lwip_stats.memp[i], (char *)pool_names[i]);
   }
   
 }
+
+void
+stats_display_pools(void)
+{
+  u8_t i;
+  u32_t now = 0, recommended = 0;
+  struct stats_pool info;
+
+  LWIP_PLATFORM_DIAG(("\nPOOL           size  num used  max  err  rec\n"));
+  for (i = 0; i < STATS_POOL_MAX; i++) {
+    stats_pool_get(i, &info);
+    LWIP_PLATFORM_DIAG(("%-14s %4"U16_F" %4"U16_F" %4"U16_F" %4"U16_F" %4"U16_F" %4"U16_F"%s\n",
+      info.name, info.size, info.num, info.used, info.max, info.err,
+      info.recommended, info.err != 0 ? " starved" : ""));
+    now += (u32_t)info.size * info.num;
+    recommended += (u32_t)info.size * info.recommended;
+  }
+  LWIP_PLATFORM_DIAG(("bytes now %"U32_F", recommended %"U32_F"\n", now, recommended));
+}
 #endif /* LWIP_STATS_DISPLAY */
 #endif /* LWIP_STATS */
 
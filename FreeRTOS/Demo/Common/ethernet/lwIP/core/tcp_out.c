@@ -118,11 +118,14 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
   u8_t *optdata, u8_t optlen)
 {
   struct pbuf *p;
-  struct tcp_seg *seg, *useg, *queue;
+  struct tcp_seg *seg, *useg, *queue, *last;
   u32_t left, seqno;
-  u16_t seglen;
+  u16_t seglen, segmax, space;
   void *ptr;
   u8_t queuelen;
+#if TCP_OVERSIZE
+  u16_t alloclen, oversize = 0, oversize_used = 0;
+#endif /* TCP_OVERSIZE */
 
   LWIP_DEBUGF(TCP_OUTPUT_DEBUG, ("tcp_enqueue(pcb=%p, arg=%p, len=%"U16_F", flags=%"X16_F", copy=%"U16_F")\n",
     (void *)pcb, arg, len, (u16_t)flags, (u16_t)copy));
@@ -160,15 +163,61 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
       pcb->unacked == NULL && pcb->unsent == NULL);
   }
 
+  /* Find the last segment on the unsent queue, and how much data can still
+   * be added to it.  Only data segments without SYN or FIN can grow. */
+  last = NULL;
+  space = 0;
+  if (pcb->unsent != NULL) {
+    for (last = pcb->unsent; last->next != NULL; last = last->next);
+    if (optdata == NULL && len > 0 &&
+        TCP_TCPLEN(last) != 0 &&
+        !(TCPH_FLAGS(last->tcphdr) & (TCP_SYN | TCP_FIN)) &&
+        !(flags & (TCP_SYN | TCP_FIN)) &&
+        last->len < pcb->mss) {
+      space = pcb->mss - last->len;
+    }
+  }
+
+#if TCP_OVERSIZE
+  /* As much as fits goes into the room left after the data of the last
+   * segment by an earlier write, which needs no pbuf at all.  It is only
+   * copied once everything else has been allocated, so that an ERR_MEM
+   * return leaves the unsent queue as it was. */
+  if (copy && space > 0 && pcb->unsent_oversize > 0) {
+    oversize_used = LWIP_MIN(LWIP_MIN(space, pcb->unsent_oversize), left);
+    space -= oversize_used;
+    left -= oversize_used;
+    seqno += oversize_used;
+    ptr = (void *)((u8_t *)ptr + oversize_used);
+  }
+#endif /* TCP_OVERSIZE */
+
+  /* Fail before allocating anything if the segments needed would make the
+   * queue too long: one pbuf per segment when copying, two otherwise. */
+  if (left > 0) {
+    seglen = (u16_t)((left - LWIP_MIN(left, space) + pcb->mss - 1) / pcb->mss);
+    if (space > 0) {
+      ++seglen;
+    }
+    if (queuelen + (copy ? seglen : 2 * seglen) > TCP_SND_QUEUELEN) {
+      LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 3, ("tcp_enqueue: %"U16_F" segments would make the queue too long\n", seglen));
+      TCP_STATS_INC(tcp.memerr);
+      return ERR_MEM;
+    }
+  }
+
   /* First, break up the data into segments and tuck them together in
-   * the local "queue" variable. */
+   * the local "queue" variable.  Nothing is left to do if all the data
+   * was copied into the last segment. */
   useg = queue = seg = NULL;
   seglen = 0;
-  while (queue == NULL || left > 0) {
+  while (left > 0 || (queue == NULL && len == 0)) {
 
     /* The segment length should be the MSS if the data to be enqueued
-     * is larger than the MSS. */
-    seglen = left > pcb->mss? pcb->mss: left;
+     * is larger than the MSS.  The first one only fills up the last
+     * unsent segment, so it can be chained to it below. */
+    segmax = (queue == NULL && space > 0)? space: pcb->mss;
+    seglen = left > segmax? segmax: left;
 
     /* Allocate memory for tcp_seg, and fill in fields. */
     seg = memp_malloc(MEMP_TCP_SEG);
@@ -207,10 +256,24 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
     }
     /* copy from volatile memory? */
     else if (copy) {
+#if TCP_OVERSIZE
+      /* leave room for later writes after the data of the last segment */
+      alloclen = seglen;
+      if (seglen == left && seglen < segmax) {
+        alloclen = LWIP_MIN(segmax, seglen + TCP_OVERSIZE);
+      }
+      if ((seg->p = pbuf_alloc(PBUF_TRANSPORT, alloclen, PBUF_RAM)) == NULL) {
+        LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_enqueue : could not allocate memory for pbuf copy size %"U16_F"\n", alloclen));
+        goto memerr;
+      }
+      seg->p->len = seg->p->tot_len = seglen;
+      oversize = alloclen - seglen;
+#else /* TCP_OVERSIZE */
       if ((seg->p = pbuf_alloc(PBUF_TRANSPORT, seglen, PBUF_RAM)) == NULL) {
         LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_enqueue : could not allocate memory for pbuf copy size %"U16_F"\n", seglen));
         goto memerr;
       }
+#endif /* TCP_OVERSIZE */
       ++queuelen;
       if (arg != NULL) {
         memcpy(seg->p->payload, ptr, seglen);
@@ -246,6 +309,9 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
       /* Concatenate the headers and data pbufs together. */
       pbuf_cat(seg->p/*header*/, p/*data*/);
       p = NULL;
+#if TCP_OVERSIZE
+      oversize = 0;
+#endif /* TCP_OVERSIZE */
     }
 
     /* Now that there are more segments queued, we check again if the
@@ -292,20 +358,35 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
     ptr = (void *)((u8_t *)ptr + seglen);
   }
 
+#if TCP_OVERSIZE
+  /* Nothing can fail any more, so fill the room in the last segment. */
+  if (oversize_used > 0) {
+    for (p = last->p; p->next != NULL; p = p->next) {
+      p->tot_len += oversize_used;
+    }
+    if (arg != NULL) {
+      memcpy((u8_t *)p->payload + p->len, arg, oversize_used);
+    }
+    p->len += oversize_used;
+    p->tot_len += oversize_used;
+    last->len += oversize_used;
+    pcb->unsent_oversize -= oversize_used;
+    LWIP_DEBUGF(TCP_OUTPUT_DEBUG | DBG_TRACE, ("tcp_enqueue: copied %"U16_F" into last segment, new len %"U16_F"\n", oversize_used, last->len));
+  }
+#endif /* TCP_OVERSIZE */
+
   /* Now that the data to be enqueued has been broken up into TCP
   segments in the queue variable, we add them to the end of the
   pcb->unsent queue. */
-  if (pcb->unsent == NULL) {
-    useg = NULL;
-  }
-  else {
-    for (useg = pcb->unsent; useg->next != NULL; useg = useg->next);
-  }
+  useg = last;
   /* { useg is last segment on the unsent queue, NULL if list is empty } */
 
   /* If there is room in the last pbuf on the unsent queue,
   chain the first pbuf on the queue together with that. */
-  if (useg != NULL &&
+  if (queue == NULL) {
+    /* all the data was copied into the last segment */
+  }
+  else if (useg != NULL &&
     TCP_TCPLEN(useg) != 0 &&
     !(TCPH_FLAGS(useg->tcphdr) & (TCP_SYN | TCP_FIN)) &&
     !(flags & (TCP_SYN | TCP_FIN)) &&
@@ -343,6 +424,12 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
 
   /* update number of segments on the queues */
   pcb->snd_queuelen = queuelen;
+#if TCP_OVERSIZE
+  /* the last segment enqueued, if any, is now the last unsent segment */
+  if (queue != NULL) {
+    pcb->unsent_oversize = oversize;
+  }
+#endif /* TCP_OVERSIZE */
   LWIP_DEBUGF(TCP_QLEN_DEBUG, ("tcp_enqueue: %"S16_F" (after enqueued)\n", pcb->snd_queuelen));
   if (pcb->snd_queuelen != 0) {
     LWIP_ASSERT("tcp_enqueue: valid queue length",
@@ -353,6 +440,8 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
   if the segment has data (indicated by seglen > 0). */
   if (seg != NULL && seglen > 0 && seg->tcphdr != NULL) {
     TCPH_SET_FLAG(seg->tcphdr, TCP_PSH);
+  } else if (queue == NULL && len > 0) {
+    TCPH_SET_FLAG(last->tcphdr, TCP_PSH);
   }
 
   return ERR_OK;
@@ -470,6 +559,12 @@ tcp_output(struct tcp_pcb *pcb)
 #endif /* TCP_CWND_DEBUG */
 
     pcb->unsent = seg->next;
+#if TCP_OVERSIZE
+    /* never add data to a segment that has been sent */
+    if (pcb->unsent == NULL) {
+      pcb->unsent_oversize = 0;
+    }
+#endif /* TCP_OVERSIZE */
 
     if (pcb->state != SYN_SENT) {
       TCPH_SET_FLAG(seg->tcphdr, TCP_ACK);
@@ -118,6 +118,27 @@ void dhcp_inform(struct netif *netif);
 void dhcp_arp_reply(struct netif *netif, struct ip_addr *addr);
 #endif
 
+#if LWIP_DHCP_LEASE_CACHE
+/** a lease as kept across reboots, see LWIP_DHCP_LEASE_CACHE in opt.h */
+struct dhcp_lease
+{
+  struct ip_addr ip_addr;
+  struct ip_addr sn_mask;
+  struct ip_addr gw_addr;
+  struct ip_addr server_ip_addr;
+  /** LWIP_DHCP_LEASE_CLOCK() seconds at which the lease ends, 0 if not known,
+      0xffffffff if it never ends */
+  u32_t expiry;
+};
+
+/** provided by the application: read the lease kept for netif, returning 1
+    if there was one */
+u8_t dhcp_lease_load(struct netif *netif, struct dhcp_lease *lease);
+/** provided by the application: keep lease for netif across reboots, or
+    erase the lease kept when lease is NULL */
+void dhcp_lease_store(struct netif *netif, const struct dhcp_lease *lease);
+#endif /* LWIP_DHCP_LEASE_CACHE */
+
 /** to be called every minute */
 void dhcp_coarse_tmr(void);
 /** to be called every half second */
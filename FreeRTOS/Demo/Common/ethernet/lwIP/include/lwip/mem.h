@@ -55,6 +55,18 @@ void mem_init(void);
 void *mem_malloc(mem_size_t size);
 void mem_free(void *mem);
 void *mem_realloc(void *mem, mem_size_t size);
+
+#if MEM_USE_SIZE_CLASSES
+/* The number of size classes, see MEM_USE_SIZE_CLASSES in opt.h. */
+#define MEM_CLASS_MAX 4
+
+u16_t mem_class_size(u8_t cls);
+u16_t mem_class_count(u8_t cls);
+#endif /* MEM_USE_SIZE_CLASSES */
+#endif
+
+#if MEM_LIBC_MALLOC && MEM_USE_SIZE_CLASSES
+#error "MEM_USE_SIZE_CLASSES needs the lwIP heap, set MEM_LIBC_MALLOC to 0"
 #endif
 
 #ifndef MEM_ALIGN_SIZE
@@ -59,5 +59,8 @@ void *memp_malloc(memp_t type);
 void *memp_realloc(memp_t fromtype, memp_t totype, void *mem);
 void memp_free(memp_t type, void *mem);
 
+u16_t memp_size(memp_t type);
+u16_t memp_count(memp_t type);
+
 #endif /* __LWIP_MEMP_H__  */
     
@@ -109,6 +109,8 @@ struct netif {
   char name[2];
   /** number of this interface */
   u8_t num;
+  /** ARP cache entry last used on this interface, checked first */
+  u8_t arp_hint;
 #if LWIP_SNMP
   /** link type (ifType values per RFC1213) */
   u8_t link_type;
@@ -245,6 +245,33 @@ int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptse
                 struct timeval *timeout);
 int lwip_ioctl(int s, long cmd, void *argp);
 
+#if LWIP_EPOLL
+/* An alternative to lwip_select() for a task that serves many sockets.  The
+   sockets are registered once with lwip_epoll_ctl(), and each
+   lwip_epoll_wait() costs time in proportion to the sockets that became
+   ready rather than to the sockets registered.  Readiness is level
+   triggered, as with select().  A socket can be in one instance at a time,
+   only one task may wait on an instance, and an instance must not be closed
+   while a task waits on it.  Instance numbers are not socket numbers. */
+#define LWIP_EPOLLIN          0x001
+#define LWIP_EPOLLOUT         0x004
+
+#define LWIP_EPOLL_CTL_ADD    1
+#define LWIP_EPOLL_CTL_DEL    2
+#define LWIP_EPOLL_CTL_MOD    3
+
+struct lwip_epoll_event {
+  u32_t events;  /* LWIP_EPOLLIN and LWIP_EPOLLOUT, of those registered. */
+  int fd;        /* The socket. */
+};
+
+int lwip_epoll_create(void);
+int lwip_epoll_close(int epfd);
+int lwip_epoll_ctl(int epfd, int op, int s, u32_t events);
+/* timeout is in milliseconds, and negative to wait forever. */
+int lwip_epoll_wait(int epfd, struct lwip_epoll_event *events, int maxevents, int timeout);
+#endif /* LWIP_EPOLL */
+
 #if LWIP_COMPAT_SOCKETS
 #define accept(a,b,c)         lwip_accept(a,b,c)
 #define bind(a,b,c)           lwip_bind(a,b,c)
@@ -93,18 +93,50 @@ struct stats_ {
   struct stats_proto tcp;
   struct stats_pbuf pbuf;
   struct stats_mem mem;
+#if MEM_USE_SIZE_CLASSES
+  struct stats_mem mem_class[MEM_CLASS_MAX];
+#endif /* MEM_USE_SIZE_CLASSES */
   struct stats_mem memp[MEMP_MAX];
   struct stats_sys sys;
 };
 
 extern struct stats_ lwip_stats;
 
+/* Spare elements, in percent of the high water mark, that
+   stats_pool_get() adds when it recommends the size of a pool. */
+#ifndef STATS_POOL_MARGIN
+#define STATS_POOL_MARGIN 25
+#endif
+
+/* The pools reported by stats_pool_get(): the memp pools, numbered as
+   memp_t, followed by the PBUF_POOL of pbuf.c and the size classes of
+   mem.c. */
+#define STATS_POOL_PBUF_POOL MEMP_MAX
+#if MEM_USE_SIZE_CLASSES
+#define STATS_POOL_MEM_CLASS (MEMP_MAX + 1)
+#define STATS_POOL_MAX       (MEMP_MAX + 1 + MEM_CLASS_MAX)
+#else
+#define STATS_POOL_MAX       (MEMP_MAX + 1)
+#endif /* MEM_USE_SIZE_CLASSES */
+
+struct stats_pool {
+  const char *name;
+  u16_t size;        /* Bytes per element, including overhead. */
+  u16_t num;         /* Elements configured. */
+  u16_t used;        /* Elements allocated now. */
+  u16_t max;         /* High water mark. */
+  u16_t err;         /* Failed allocations. */
+  u16_t recommended; /* Suggested number of elements. */
+};
 
 void stats_init(void);
+void stats_reset_max(void);
+void stats_pool_get(u8_t pool, struct stats_pool *info);
 
 #define STATS_INC(x) ++lwip_stats.x
 #else
 #define stats_init()
+#define stats_reset_max()
 #define STATS_INC(x)
 #endif /* LWIP_STATS */
 
@@ -147,8 +179,10 @@ void stats_init(void);
 /* Display of statistics */
 #if LWIP_STATS_DISPLAY
 void stats_display(void);
+void stats_display_pools(void);
 #else
 #define stats_display()
+#define stats_display_pools()
 #endif
 
 #endif /* __LWIP_STATS_H__ */
@@ -281,6 +281,9 @@ struct tcp_pcb {
   /* These are ordered by sequence number: */
   struct tcp_seg *unsent;   /* Unsent (queued) segments. */
   struct tcp_seg *unacked;  /* Sent but unacknowledged segments. */
+#if TCP_OVERSIZE
+  u16_t unsent_oversize;    /* Free space after the data of the last unsent segment. */
+#endif /* TCP_OVERSIZE */
 #if TCP_QUEUE_OOSEQ  
   struct tcp_seg *ooseq;    /* Received out of sequence segments. */
 #endif /* TCP_QUEUE_OOSEQ */
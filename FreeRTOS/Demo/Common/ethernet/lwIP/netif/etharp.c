@@ -100,10 +100,27 @@ struct etharp_entry {
   enum etharp_state state;
   u8_t ctime;
   struct netif *netif;
+  /** next entry in the same hash bucket, or -1 */
+  s8_t next;
 };
 
+#if (ARP_HASH_SIZE & (ARP_HASH_SIZE - 1)) != 0
+#error ARP_HASH_SIZE must be a power of two
+#endif
+
+/** Bucket of an IP address.  All four octets are folded in, as the host
+ * part of the addresses on one network is often a single octet. */
+#define ETHARP_HASH(ipaddr) ((u8_t)(((ipaddr)->addr ^ ((ipaddr)->addr >> 8) ^ \
+  ((ipaddr)->addr >> 16) ^ ((ipaddr)->addr >> 24)) & (ARP_HASH_SIZE - 1)))
+
 static const struct eth_addr ethbroadcast = {{0xff,0xff,0xff,0xff,0xff,0xff}};
 static struct etharp_entry arp_table[ARP_TABLE_SIZE];
+/** First entry of each hash bucket, or -1.  An entry is in the bucket of
+ * its address from when find_entry() gives it the address until it is
+ * emptied again. */
+static s8_t arp_hash[ARP_HASH_SIZE];
+/** Number of entries in the hash buckets, none of which are empty. */
+static u8_t arp_hashed;
 
 /**
  * Try hard to create a new entry - we want the IP address to appear in
@@ -111,6 +128,7 @@ static struct etharp_entry arp_table[ARP_TABLE_SIZE];
 #define ETHARP_TRY_HARD 1
 
 static s8_t find_entry(struct ip_addr *ipaddr, u8_t flags);
+static s8_t find_entry_hint(struct netif *netif, struct ip_addr *ipaddr, u8_t flags);
 static err_t update_arp_entry(struct netif *netif, struct ip_addr *ipaddr, struct eth_addr *ethaddr, u8_t flags);
 /**
  * Initializes ARP module.
@@ -128,6 +146,39 @@ etharp_init(void)
     arp_table[i].ctime = 0;
     arp_table[i].netif = NULL;
   }
+  for(i = 0; i < ARP_HASH_SIZE; ++i) {
+    arp_hash[i] = -1;
+  }
+  arp_hashed = 0;
+}
+
+/**
+ * Add entry i to the hash bucket of its IP address.
+ */
+static void
+etharp_hash_insert(s8_t i)
+{
+  u8_t bucket = ETHARP_HASH(&arp_table[i].ipaddr);
+
+  arp_table[i].next = arp_hash[bucket];
+  arp_hash[bucket] = i;
+  arp_hashed++;
+}
+
+/**
+ * Remove entry i from the hash bucket of its IP address.
+ */
+static void
+etharp_hash_remove(s8_t i)
+{
+  s8_t *link = &arp_hash[ETHARP_HASH(&arp_table[i].ipaddr)];
+
+  while (*link != i) {
+    LWIP_ASSERT("etharp_hash_remove: entry in its bucket", *link >= 0);
+    link = &arp_table[*link].next;
+  }
+  *link = arp_table[i].next;
+  arp_hashed--;
 }
 
 /**
@@ -177,6 +228,7 @@ etharp_tmr(void)
       }
 #endif
       /* recycle entry for re-use */      
+      etharp_hash_remove(i);
       arp_table[i].state = ETHARP_STATE_EMPTY;
     }
   }
@@ -208,6 +260,7 @@ static s8_t find_entry(struct ip_addr *ipaddr, u8_t flags)
 {
   s8_t old_pending = ARP_TABLE_SIZE, old_stable = ARP_TABLE_SIZE;
   s8_t empty = ARP_TABLE_SIZE;
+  s8_t j;
   u8_t i = 0, age_pending = 0, age_stable = 0;
 #if ARP_QUEUEING
   /* oldest entry with packets on queue */
@@ -217,18 +270,37 @@ static s8_t find_entry(struct ip_addr *ipaddr, u8_t flags)
 #endif
 
   /**
-   * a) do a search through the cache, remember candidates
-   * b) select candidate entry
-   * c) create new entry
+   * a) look for a matching entry in the hash bucket of the address
+   * b) do a search through the cache, remember candidates
+   * c) select candidate entry
+   * d) create new entry
    */
 
-  /* a) in a single search sweep, do all of this
+  /* a) only pending and stable entries can match */
+  if (ipaddr != NULL) {
+    for (j = arp_hash[ETHARP_HASH(ipaddr)]; j >= 0; j = arp_table[j].next) {
+      if (((arp_table[j].state == ETHARP_STATE_PENDING) ||
+           (arp_table[j].state == ETHARP_STATE_STABLE)) &&
+          ip_addr_cmp(ipaddr, &arp_table[j].ipaddr)) {
+        LWIP_DEBUGF(ETHARP_DEBUG | DBG_TRACE, ("find_entry: found matching entry %"U16_F"\n", (u16_t)j));
+        /* found exact IP address match, simply bail out */
+        return j;
+      }
+    }
+  }
+  /* { we have no match } => try to create a new entry */
+
+  /* no empty entry left and not allowed to recycle? */
+  if ((arp_hashed == ARP_TABLE_SIZE) && ((flags & ETHARP_TRY_HARD) == 0))
+  {
+    return (s8_t)ERR_MEM;
+  }
+
+  /* b) in a single search sweep, do all of this
    * 1) remember the first empty entry (if any)
    * 2) remember the oldest stable entry (if any)
    * 3) remember the oldest pending entry without queued packets (if any)
    * 4) remember the oldest pending entry with queued packets (if any)
-   * 5) search for a matching IP entry, either pending or stable
-   *    until 5 matches, or all entries are searched for.
    */
 
   for (i = 0; i < ARP_TABLE_SIZE; ++i) {
@@ -240,21 +312,17 @@ static s8_t find_entry(struct ip_addr *ipaddr, u8_t flags)
     }
     /* pending entry? */
     else if (arp_table[i].state == ETHARP_STATE_PENDING) {
-      /* if given, does IP address match IP address in ARP entry? */
-      if (ipaddr && ip_addr_cmp(ipaddr, &arp_table[i].ipaddr)) {
-        LWIP_DEBUGF(ETHARP_DEBUG | DBG_TRACE, ("find_entry: found matching pending entry %"U16_F"\n", (u16_t)i));
-        /* found exact IP address match, simply bail out */
-        return i;
 #if ARP_QUEUEING
       /* pending with queued packets? */
-      } else if (arp_table[i].p != NULL) {
+      if (arp_table[i].p != NULL) {
         if (arp_table[i].ctime >= age_queue) {
           old_queue = i;
           age_queue = arp_table[i].ctime;
         }
+      } else
 #endif
       /* pending without queued packets? */
-      } else {
+      {
         if (arp_table[i].ctime >= age_pending) {
           old_pending = i;
           age_pending = arp_table[i].ctime;
@@ -263,27 +331,21 @@ static s8_t find_entry(struct ip_addr *ipaddr, u8_t flags)
     }
     /* stable entry? */
     else if (arp_table[i].state == ETHARP_STATE_STABLE) {
-      /* if given, does IP address match IP address in ARP entry? */
-      if (ipaddr && ip_addr_cmp(ipaddr, &arp_table[i].ipaddr)) {
-        LWIP_DEBUGF(ETHARP_DEBUG | DBG_TRACE, ("find_entry: found matching stable entry %"U16_F"\n", (u16_t)i));
-        /* found exact IP address match, simply bail out */
-        return i;
       /* remember entry with oldest stable entry in oldest, its age in maxtime */
-      } else if (arp_table[i].ctime >= age_stable) {
+      if (arp_table[i].ctime >= age_stable) {
         old_stable = i;
         age_stable = arp_table[i].ctime;
       }
     }
   }
-  /* { we have no match } => try to create a new entry */
-   
+
   /* no empty entry found and not allowed to recycle? */
   if ((empty == ARP_TABLE_SIZE) && ((flags & ETHARP_TRY_HARD) == 0))
   {
     return (s8_t)ERR_MEM;
   }
   
-  /* b) choose the least destructive entry to recycle:
+  /* c) choose the least destructive entry to recycle:
    * 1) empty entry
    * 2) oldest stable entry
    * 3) oldest pending entry without queued packets
@@ -331,19 +393,50 @@ static s8_t find_entry(struct ip_addr *ipaddr, u8_t flags)
   if (arp_table[i].state != ETHARP_STATE_EMPTY)
   {
     snmp_delete_arpidx_tree(arp_table[i].netif, &arp_table[i].ipaddr);
+    etharp_hash_remove(i);
   }
   /* recycle entry (no-op for an already empty entry) */
   arp_table[i].state = ETHARP_STATE_EMPTY;
 
-  /* IP address given? */
+  /* d) IP address given? */
   if (ipaddr != NULL) {
     /* set IP address */
     ip_addr_set(&arp_table[i].ipaddr, ipaddr);
+    etharp_hash_insert(i);
   }
   arp_table[i].ctime = 0;
   return (err_t)i;
 }
 
+/**
+ * find_entry() with a fast path for the stable entry last used on netif,
+ * as consecutive packets usually go to the same host.
+ *
+ * @param netif network interface the entry is used on.
+ * @param ipaddr IP address to find in ARP cache, or to add if not found.
+ * @param flags as for find_entry().
+ *
+ * @return as for find_entry().
+ */
+static s8_t
+find_entry_hint(struct netif *netif, struct ip_addr *ipaddr, u8_t flags)
+{
+  u8_t hint = netif->arp_hint;
+  s8_t i;
+
+  if ((hint < ARP_TABLE_SIZE) &&
+      (arp_table[hint].state == ETHARP_STATE_STABLE) &&
+      (arp_table[hint].netif == netif) &&
+      ip_addr_cmp(ipaddr, &arp_table[hint].ipaddr)) {
+    return (s8_t)hint;
+  }
+  i = find_entry(ipaddr, flags);
+  if (i >= 0) {
+    netif->arp_hint = (u8_t)i;
+  }
+  return i;
+}
+
 /**
  * Update (or insert) a IP/MAC address pair in the ARP cache.
  *
@@ -382,7 +475,7 @@ update_arp_entry(struct netif *netif, struct ip_addr *ipaddr, struct eth_addr *e
     return ERR_ARG;
   }
   /* find or create ARP entry */
-  i = find_entry(ipaddr, flags);
+  i = find_entry_hint(netif, ipaddr, flags);
   /* bail out if no entry could be found */
   if (i < 0) return (err_t)i;
   
@@ -448,8 +541,8 @@ etharp_find_addr(struct netif *netif, struct ip_addr *ipaddr,
 {
   s8_t i;
 
-  i = 0;
-  while (i < ARP_TABLE_SIZE)
+  i = arp_hash[ETHARP_HASH(ipaddr)];
+  while (i >= 0)
   {
     if ((arp_table[i].state == ETHARP_STATE_STABLE) &&
         (arp_table[i].netif == netif) && 
@@ -459,7 +552,7 @@ etharp_find_addr(struct netif *netif, struct ip_addr *ipaddr,
       *ip_ret = &arp_table[i].ipaddr;
       return i;
     }
-    i++;
+    i = arp_table[i].next;
   }
   return -1;
 }
@@ -760,7 +853,7 @@ err_t etharp_query(struct netif *netif, struct ip_addr *ipaddr, struct pbuf *q)
   }
 
   /* find entry in ARP cache, ask to create entry if queueing packet */
-  i = find_entry(ipaddr, ETHARP_TRY_HARD);
+  i = find_entry_hint(netif, ipaddr, ETHARP_TRY_HARD);
 
   /* could not find or create entry? */
   if (i < 0)
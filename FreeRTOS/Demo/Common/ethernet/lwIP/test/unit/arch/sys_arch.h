@@ -0,0 +1,12 @@
+#ifndef __ARCH_SYS_ARCH_H__
+#define __ARCH_SYS_ARCH_H__
+
+/* NO_SYS is 1, so these are never used. */
+typedef int sys_sem_t;
+typedef int sys_mbox_t;
+typedef int sys_thread_t;
+
+#define SYS_MBOX_NULL 0
+#define SYS_SEM_NULL  0
+
+#endif /* __ARCH_SYS_ARCH_H__ */
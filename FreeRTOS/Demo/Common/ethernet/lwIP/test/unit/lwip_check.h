@@ -0,0 +1,20 @@
+#ifndef __LWIP_CHECK_H__
+#define __LWIP_CHECK_H__
+
+/* A minimal stand-in for the check framework used by the upstream lwIP unit
+ * tests: a failed check prints where it failed and fails the test. */
+#include <stdio.h>
+
+extern int lwip_check_failures;
+
+#define EXPECT(x) do { if (!(x)) { \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+    lwip_check_failures++; } } while(0)
+
+#define EXPECT_RET(x) do { if (!(x)) { \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+    lwip_check_failures++; return; } } while(0)
+
+typedef void (*testfunc)(void);
+
+#endif /* __LWIP_CHECK_H__ */
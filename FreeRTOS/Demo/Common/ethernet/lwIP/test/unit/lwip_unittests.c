@@ -0,0 +1,36 @@
+/*
+ * Runs the unit tests of the bundled lwIP on the host, see the Makefile.
+ */
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/stats.h"
+
+#include "lwip_check.h"
+
+int lwip_check_failures;
+
+extern testfunc tcp_oversize_tests[];
+
+int
+main(void)
+{
+  testfunc *test;
+  int run = 0;
+
+  stats_init();
+  mem_init();
+  memp_init();
+  pbuf_init();
+  tcp_init();
+
+  for (test = tcp_oversize_tests; *test != NULL; test++) {
+    (*test)();
+    run++;
+  }
+
+  printf("%d tests, %d failed checks\n", run, lwip_check_failures);
+  return (lwip_check_failures == 0) ? 0 : 1;
+}
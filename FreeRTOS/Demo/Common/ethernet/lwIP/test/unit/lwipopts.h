@@ -0,0 +1,25 @@
+#ifndef __LWIPOPTS_H__
+#define __LWIPOPTS_H__
+
+/* Options for the unit tests: the raw API only, on the host. */
+#define NO_SYS                          1
+#define SYS_LIGHTWEIGHT_PROT            0
+#define MEM_ALIGNMENT                   8
+#define MEM_SIZE                        16000
+#define LWIP_STATS                      1
+#define LWIP_UDP                        0
+#define LWIP_RAW                        0
+#define LWIP_DHCP                       0
+#define IP_REASSEMBLY                   0
+#define IP_FRAG                         0
+
+#define TCP_MSS                         536
+#define TCP_WND                         (4 * TCP_MSS)
+#define TCP_SND_BUF                     (8 * TCP_MSS)
+/* Small enough for a test to reach the queue length limit. */
+#define TCP_SND_QUEUELEN                6
+#define MEMP_NUM_TCP_SEG                16
+#define MEMP_NUM_PBUF                   16
+#define PBUF_POOL_SIZE                  8
+
+#endif /* __LWIPOPTS_H__ */
@@ -0,0 +1,222 @@
+/*
+ * Tests of tcp_enqueue() filling the room left after the data of the last
+ * unsent segment (TCP_OVERSIZE).  The pcb is never connected: tcp_write()
+ * only queues, so the tests look at pcb->unsent directly.
+ */
+#include "lwip/opt.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/stats.h"
+
+#include <string.h>
+
+#include "lwip_check.h"
+
+#if TCP_OVERSIZE
+
+static u8_t tx_data[TCP_SND_BUF];
+
+/* What a failed write must not change. */
+struct unsent_state {
+  struct tcp_seg *last;
+  u16_t seg_len;
+  u16_t p_len;
+  u16_t p_tot_len;
+  u16_t oversize;
+  u32_t snd_lbb;
+  u16_t snd_buf;
+  u8_t snd_queuelen;
+};
+
+static struct tcp_pcb *
+test_tcp_new(void)
+{
+  struct tcp_pcb *pcb = tcp_new();
+  u16_t i;
+
+  for (i = 0; i < sizeof(tx_data); i++) {
+    tx_data[i] = (u8_t)i;
+  }
+  if (pcb != NULL) {
+    pcb->state = ESTABLISHED;
+    pcb->local_port = 1234;
+    pcb->remote_port = 80;
+  }
+  return pcb;
+}
+
+static void
+test_tcp_free(struct tcp_pcb *pcb)
+{
+  tcp_segs_free(pcb->unsent);
+  pcb->unsent = NULL;
+  memp_free(MEMP_TCP_PCB, pcb);
+}
+
+static struct tcp_seg *
+test_tcp_last_unsent(struct tcp_pcb *pcb)
+{
+  struct tcp_seg *seg = pcb->unsent;
+
+  while (seg != NULL && seg->next != NULL) {
+    seg = seg->next;
+  }
+  return seg;
+}
+
+static void
+test_tcp_save(struct tcp_pcb *pcb, struct unsent_state *state)
+{
+  struct pbuf *p;
+
+  state->last = test_tcp_last_unsent(pcb);
+  state->seg_len = state->last->len;
+  state->p_tot_len = state->last->p->tot_len;
+  for (p = state->last->p; p->next != NULL; p = p->next);
+  state->p_len = p->len;
+  state->oversize = pcb->unsent_oversize;
+  state->snd_lbb = pcb->snd_lbb;
+  state->snd_buf = pcb->snd_buf;
+  state->snd_queuelen = pcb->snd_queuelen;
+}
+
+static int
+test_tcp_unchanged(struct tcp_pcb *pcb, const struct unsent_state *state)
+{
+  struct pbuf *p;
+
+  for (p = state->last->p; p->next != NULL; p = p->next);
+  return test_tcp_last_unsent(pcb) == state->last &&
+    state->last->next == NULL &&
+    state->last->len == state->seg_len &&
+    state->last->p->tot_len == state->p_tot_len &&
+    p->len == state->p_len &&
+    pcb->unsent_oversize == state->oversize &&
+    pcb->snd_lbb == state->snd_lbb &&
+    pcb->snd_buf == state->snd_buf &&
+    pcb->snd_queuelen == state->snd_queuelen;
+}
+
+/* Checks the data of the unsent segments follows on from *offset, and that
+ * each segment starts at the sequence number of its first byte. */
+static int
+test_tcp_check_unsent(struct tcp_pcb *pcb, u32_t iss, u32_t *offset)
+{
+  struct tcp_seg *seg;
+  struct pbuf *p;
+  u16_t i, skip, seen;
+
+  for (seg = pcb->unsent; seg != NULL; seg = seg->next) {
+    if (ntohl(seg->tcphdr->seqno) != iss + *offset) {
+      return 0;
+    }
+    skip = TCP_HLEN;
+    seen = 0;
+    for (p = seg->p; p != NULL; p = p->next) {
+      for (i = skip; i < p->len; i++, seen++) {
+        if (((u8_t *)p->payload)[i] != tx_data[*offset + seen]) {
+          return 0;
+        }
+      }
+      skip = 0;
+    }
+    if (seen != seg->len) {
+      return 0;
+    }
+    *offset += seen;
+  }
+  return 1;
+}
+
+/* Small writes are copied into the room left by the first one. */
+static void
+test_tcp_oversize_fill(void)
+{
+  struct tcp_pcb *pcb = test_tcp_new();
+  u32_t iss, offset = 0;
+
+  EXPECT_RET(pcb != NULL);
+  iss = pcb->snd_lbb;
+
+  EXPECT(tcp_write(pcb, tx_data, 10, 1) == ERR_OK);
+  EXPECT(pcb->unsent_oversize == TCP_MSS - 10);
+  EXPECT(tcp_write(pcb, tx_data + 10, 20, 1) == ERR_OK);
+  EXPECT(pcb->unsent != NULL && pcb->unsent->next == NULL);
+  EXPECT(pcb->unsent->len == 30);
+  EXPECT(pcb->unsent_oversize == TCP_MSS - 30);
+  EXPECT(pcb->snd_queuelen == 1);
+  EXPECT(test_tcp_check_unsent(pcb, iss, &offset) && offset == 30);
+
+  test_tcp_free(pcb);
+}
+
+/* A write that fills the room, then cannot allocate a segment for the rest,
+ * leaves the unsent queue as it was, and can be retried. */
+static void
+test_tcp_oversize_memerr_seg(void)
+{
+  struct tcp_pcb *pcb = test_tcp_new();
+  struct tcp_seg *segs[MEMP_NUM_TCP_SEG];
+  struct unsent_state state;
+  u32_t iss, offset = 0;
+  int n;
+
+  EXPECT_RET(pcb != NULL);
+  iss = pcb->snd_lbb;
+  EXPECT_RET(tcp_write(pcb, tx_data, 10, 1) == ERR_OK);
+  test_tcp_save(pcb, &state);
+
+  for (n = 0; n < MEMP_NUM_TCP_SEG; n++) {
+    segs[n] = memp_malloc(MEMP_TCP_SEG);
+    if (segs[n] == NULL) {
+      break;
+    }
+  }
+  EXPECT(tcp_write(pcb, tx_data + 10, 600, 1) == ERR_MEM);
+  EXPECT(test_tcp_unchanged(pcb, &state));
+  while (n-- > 0) {
+    memp_free(MEMP_TCP_SEG, segs[n]);
+  }
+
+  EXPECT(tcp_write(pcb, tx_data + 10, 600, 1) == ERR_OK);
+  EXPECT(pcb->snd_lbb == iss + 610);
+  EXPECT(test_tcp_check_unsent(pcb, iss, &offset) && offset == 610);
+
+  test_tcp_free(pcb);
+}
+
+/* A write that would make the queue too long fails before filling the
+ * room. */
+static void
+test_tcp_oversize_memerr_queuelen(void)
+{
+  struct tcp_pcb *pcb = test_tcp_new();
+  struct unsent_state state;
+  u32_t iss, offset = 0;
+
+  EXPECT_RET(pcb != NULL);
+  iss = pcb->snd_lbb;
+  EXPECT_RET(tcp_write(pcb, tx_data, 10, 1) == ERR_OK);
+  test_tcp_save(pcb, &state);
+
+  /* The room, then one pbuf more than the queue has left. */
+  EXPECT(tcp_write(pcb, tx_data + 10, (TCP_MSS - 10) + TCP_SND_QUEUELEN * TCP_MSS, 1) == ERR_MEM);
+  EXPECT(test_tcp_unchanged(pcb, &state));
+
+  EXPECT(test_tcp_check_unsent(pcb, iss, &offset) && offset == 10);
+
+  test_tcp_free(pcb);
+}
+
+#endif /* TCP_OVERSIZE */
+
+testfunc tcp_oversize_tests[] = {
+#if TCP_OVERSIZE
+  test_tcp_oversize_fill,
+  test_tcp_oversize_memerr_seg,
+  test_tcp_oversize_memerr_queuelen,
+#endif /* TCP_OVERSIZE */
+  NULL
+};
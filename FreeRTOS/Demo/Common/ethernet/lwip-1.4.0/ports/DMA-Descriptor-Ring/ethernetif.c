@@ -0,0 +1,934 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A reference lwIP netif for MACs that move frames with DMA descriptor rings.
+ *
+ * Rx: every Rx descriptor holds a pbuf - taken from PBUF_POOL, or from a
+ * static pool of custom pbufs when netifUSE_CUSTOM_PBUFS is 1 - and the DMA
+ * engine receives straight into it.  A received frame is passed to the stack
+ * in the pbufs it was received into, and the descriptors are given fresh
+ * pbufs.  If no fresh pbufs can be had the frame is dropped and its pbufs are
+ * given back to the DMA engine, so the ring never runs dry.
+ *
+ * Tx: each pbuf of the chain passed to prvLowLevelOutput() gets a descriptor
+ * of its own, so the frame is sent from the stack's buffers without a copy.
+ * The chain is referenced until the DMA engine has finished with it.  Only
+ * a chain with more than netifTX_MAX_SEGMENTS pbufs, or with a pbuf the DMA
+ * engine cannot read, is copied into a single PBUF_RAM pbuf first.
+ *
+ * Interrupt coalescing: the Rx interrupt only wakes the handler task, which
+ * then masks the interrupt and polls the ring until it is empty, so a burst
+ * of frames costs one interrupt.  vMACSetInterruptCoalescing() lets the MAC
+ * delay the interrupt too.  Tx complete interrupts are only requested when
+ * the Tx ring is nearly full, as finished descriptors are otherwise reclaimed
+ * the next time a frame is sent.
+ *
+ * The MAC specific parts are declared in ethernetif_dma.h.  lwIP only calls
+ * the linkoutput function from the tcpip thread, so the Tx ring is only ever
+ * touched by that thread and needs no lock.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* lwIP includes. */
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/mem.h"
+#include "lwip/pbuf.h"
+#include "lwip/sys.h"
+#include <lwip/stats.h>
+#include <lwip/snmp.h>
+#include "netif/etharp.h"
+
+/* Port includes. */
+#include "ethernetif_dma.h"
+
+/* Define those to better describe your network interface. */
+#define IFNAME0 'e'
+#define IFNAME1 'd'
+
+#define netifMAX_MTU 1500
+
+/* The number of descriptors in each ring.  Every Rx descriptor holds a pbuf
+permanently, so PBUF_POOL_SIZE (or netifRX_CUSTOM_BUFFERS) must leave enough
+over for the frames the stack is still processing. */
+#ifndef netifRX_DESCRIPTORS
+	#define netifRX_DESCRIPTORS			( 8 )
+#endif
+
+#ifndef netifTX_DESCRIPTORS
+	#define netifTX_DESCRIPTORS			( 16 )
+#endif
+
+/* The most frames the handler task passes to the stack before yielding, so
+the tcpip thread can run while a burst is still arriving. */
+#ifndef netifRX_BUDGET
+	#define netifRX_BUDGET				( 8 )
+#endif
+
+/* Passed to vMACSetInterruptCoalescing(). */
+#ifndef netifRX_COALESCE_FRAMES
+	#define netifRX_COALESCE_FRAMES		( 4 )
+#endif
+
+#ifndef netifRX_COALESCE_USECS
+	#define netifRX_COALESCE_USECS		( 100 )
+#endif
+
+/* A chain of more pbufs than this is copied into one pbuf before it is sent,
+so a single frame cannot take the whole Tx ring. */
+#ifndef netifTX_MAX_SEGMENTS
+	#define netifTX_MAX_SEGMENTS		( netifTX_DESCRIPTORS / 4 )
+#endif
+
+/* A Tx complete interrupt is requested for a frame that leaves fewer than
+this many descriptors free. */
+#ifndef netifTX_LOW_WATER
+	#define netifTX_LOW_WATER			( netifTX_DESCRIPTORS / 4 )
+#endif
+
+/* When a frame cannot be queued because the Tx ring is full, the tcpip
+thread waits up to netifTX_BUFFER_FREE_WAIT ticks for a Tx complete interrupt,
+netifMAX_TX_ATTEMPTS times, before dropping the frame.  Returning ERR_MEM
+straight away would lose the frame, as the stack does not retry. */
+#ifndef netifTX_BUFFER_FREE_WAIT
+	#define netifTX_BUFFER_FREE_WAIT	( ( TickType_t ) 10UL / portTICK_PERIOD_MS )
+#endif
+
+#ifndef netifMAX_TX_ATTEMPTS
+	#define netifMAX_TX_ATTEMPTS		( 5 )
+#endif
+
+/* Set to 1 to receive into a static pool of custom pbufs instead of
+PBUF_POOL, for example when the DMA engine can only reach some of the RAM. */
+#ifndef netifUSE_CUSTOM_PBUFS
+	#define netifUSE_CUSTOM_PBUFS		0
+#endif
+
+#ifndef netifRX_CUSTOM_BUFFERS
+	#define netifRX_CUSTOM_BUFFERS		( netifRX_DESCRIPTORS * 2 )
+#endif
+
+/* The size of each Rx buffer, including ETH_PAD_SIZE.  A frame longer than a
+buffer is received into several descriptors and passed up as a pbuf chain. */
+#ifndef netifRX_BUFFER_SIZE
+	#if netifUSE_CUSTOM_PBUFS == 1
+		#define netifRX_BUFFER_SIZE		( 1536 + ETH_PAD_SIZE )
+	#else
+		#define netifRX_BUFFER_SIZE		PBUF_POOL_BUFSIZE
+	#endif
+#endif
+
+/* The handler task runs at the priority of the tcpip thread by default, so
+yielding between budgets lets the tcpip thread empty its mailbox. */
+#ifndef netifINTERFACE_TASK_STACK_SIZE
+	#define netifINTERFACE_TASK_STACK_SIZE	( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+#ifndef netifINTERFACE_TASK_PRIORITY
+	#define netifINTERFACE_TASK_PRIORITY	TCPIP_THREAD_PRIO
+#endif
+
+/* Ports with a data cache must clean Tx buffers before the DMA engine reads
+them and invalidate Rx buffers before and after the DMA engine writes them. */
+#ifndef netifCACHE_CLEAN
+	#define netifCACHE_CLEAN( pvAddress, ulLength )
+#endif
+
+#ifndef netifCACHE_INVALIDATE
+	#define netifCACHE_INVALIDATE( pvAddress, ulLength )
+#endif
+
+/* Orders the accesses to a descriptor with respect to the DMA engine, for
+example __DSB() on a Cortex-M7.  The descriptors are volatile, so by default
+only the compiler is stopped from reordering them. */
+#ifndef netifDMA_BARRIER
+	#ifdef portMEMORY_BARRIER
+		#define netifDMA_BARRIER()		portMEMORY_BARRIER()
+	#else
+		#define netifDMA_BARRIER()
+	#endif
+#endif
+
+/* Placement and alignment of the rings, for example a non cacheable section
+or the alignment the DMA engine requires. */
+#ifndef netifDESCRIPTOR_ATTRIBUTE
+	#define netifDESCRIPTOR_ATTRIBUTE
+#endif
+
+/* Returns pdFALSE for an address the DMA engine cannot read, such as a
+PBUF_ROM in a flash the DMA engine is not connected to. */
+#ifndef netifTX_BUFFER_IS_DMA_CAPABLE
+	#define netifTX_BUFFER_IS_DMA_CAPABLE( pvAddress )	( pdTRUE )
+#endif
+
+/* The part of an Rx buffer the DMA engine writes into. */
+#define netifRX_DMA_SIZE	( ( unsigned long ) ( netifRX_BUFFER_SIZE - ETH_PAD_SIZE ) )
+
+#if netifTX_MAX_SEGMENTS > netifTX_LOW_WATER
+	#error netifTX_MAX_SEGMENTS must not be above netifTX_LOW_WATER, or a send waiting for descriptors might never get a Tx complete interrupt.
+#endif
+
+#if netifTX_MAX_SEGMENTS < 1
+	#error netifTX_MAX_SEGMENTS must be at least 1.
+#endif
+
+#if ( netifUSE_CUSTOM_PBUFS == 1 ) && !LWIP_SUPPORT_CUSTOM_PBUF
+	#error netifUSE_CUSTOM_PBUFS needs LWIP_SUPPORT_CUSTOM_PBUF, see lwip/opt.h.
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Perform any hardware and/or driver initialisation necessary.
+ */
+static void prvLowLevelInit( struct netif *pxNetIf );
+
+/*
+ * Queue a frame on the Tx ring without copying it, if possible.
+ */
+static err_t prvLowLevelOutput( struct netif *pxNetIf, struct pbuf *p );
+
+/*
+ * Release the pbufs of the frames the DMA engine has finished sending.
+ */
+static void prvReclaimTxDescriptors( void );
+
+/*
+ * Pass up to uxBudget received frames to the stack, returning the number of
+ * frames taken off the Rx ring.
+ */
+static unsigned portBASE_TYPE prvProcessRxRing( struct netif *pxNetIf, unsigned portBASE_TYPE uxBudget );
+
+/*
+ * Hand Rx descriptor uxIndex, and the pbuf it holds, to the DMA engine.
+ */
+static void prvGiveRxDescriptorToDMA( unsigned portBASE_TYPE uxIndex );
+
+/*
+ * Obtain an empty single pbuf of netifRX_BUFFER_SIZE bytes.
+ */
+static struct pbuf *prvAllocateRxPbuf( void );
+
+/*
+ * The task that empties the Rx ring when woken by the Rx interrupt.
+ */
+static void prvEMACHandlerTask( void *pvNetIf );
+
+/*-----------------------------------------------------------*/
+
+static xDMADescriptor xRxRing[ netifRX_DESCRIPTORS ] netifDESCRIPTOR_ATTRIBUTE;
+static xDMADescriptor xTxRing[ netifTX_DESCRIPTORS ] netifDESCRIPTOR_ATTRIBUTE;
+
+/* The pbuf held by each Rx descriptor. */
+static struct pbuf *pxRxPbufs[ netifRX_DESCRIPTORS ];
+
+/* The frame sent by each Tx descriptor, set on the last descriptor of the
+frame only so the chain is released once the whole frame has gone. */
+static struct pbuf *pxTxPbufs[ netifTX_DESCRIPTORS ];
+
+/* The next Rx descriptor the DMA engine will complete. */
+static unsigned portBASE_TYPE uxRxNext = 0;
+
+/* The next Tx descriptor to fill, the oldest one not yet reclaimed, and the
+number of free ones. */
+static unsigned portBASE_TYPE uxTxHead = 0, uxTxTail = 0, uxTxFree = netifTX_DESCRIPTORS;
+
+/* Given by the interrupt handler. */
+static SemaphoreHandle_t xRxSemaphore = NULL;
+static SemaphoreHandle_t xTxSemaphore = NULL;
+
+static xEthernetIfDMAStats xStats;
+
+#if netifUSE_CUSTOM_PBUFS == 1
+
+	typedef struct xRX_BUFFER
+	{
+		struct pbuf_custom xPbuf;	/* Must be first, pbuf_free() is given its address. */
+		struct xRX_BUFFER *pxNext;
+		unsigned char ucData[ netifRX_BUFFER_SIZE ];
+	} xRxBuffer;
+
+	static xRxBuffer xRxBuffers[ netifRX_CUSTOM_BUFFERS ];
+	static xRxBuffer *pxFreeRxBuffers = NULL;
+
+	/*
+	 * Called by pbuf_free(), from any task, when the stack is done with a
+	 * received frame.
+	 */
+	static void prvFreeRxBuffer( struct pbuf *p );
+
+#endif /* netifUSE_CUSTOM_PBUFS */
+
+/*-----------------------------------------------------------*/
+
+#define prvNextDescriptor( uxIndex, uxCount )	( ( ( uxIndex ) + 1U ) % ( uxCount ) )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * In this function, the hardware should be initialized.
+ * Called from ethernetif_init().
+ *
+ * @param pxNetIf the already initialized lwip network interface structure
+ *		for this etherpxNetIf
+ */
+static void prvLowLevelInit( struct netif *pxNetIf )
+{
+portBASE_TYPE xStatus;
+unsigned portBASE_TYPE x;
+
+	/* set MAC hardware address length */
+	pxNetIf->hwaddr_len = ETHARP_HWADDR_LEN;
+
+	/* set MAC hardware address */
+	pxNetIf->hwaddr[ 0 ] = configMAC_ADDR0;
+	pxNetIf->hwaddr[ 1 ] = configMAC_ADDR1;
+	pxNetIf->hwaddr[ 2 ] = configMAC_ADDR2;
+	pxNetIf->hwaddr[ 3 ] = configMAC_ADDR3;
+	pxNetIf->hwaddr[ 4 ] = configMAC_ADDR4;
+	pxNetIf->hwaddr[ 5 ] = configMAC_ADDR5;
+
+	/* maximum transfer unit */
+	pxNetIf->mtu = netifMAX_MTU;
+
+	/* device capabilities */
+	pxNetIf->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP;
+
+	xRxSemaphore = xSemaphoreCreateBinary();
+	xTxSemaphore = xSemaphoreCreateBinary();
+	configASSERT( xRxSemaphore );
+	configASSERT( xTxSemaphore );
+
+	#if netifUSE_CUSTOM_PBUFS == 1
+	{
+		for( x = 0; x < netifRX_CUSTOM_BUFFERS; x++ )
+		{
+			xRxBuffers[ x ].xPbuf.custom_free_function = prvFreeRxBuffer;
+			xRxBuffers[ x ].pxNext = pxFreeRxBuffers;
+			pxFreeRxBuffers = &( xRxBuffers[ x ] );
+		}
+	}
+	#endif /* netifUSE_CUSTOM_PBUFS */
+
+	/* Fill the Rx ring.  This is the only time a failure to obtain a pbuf is
+	fatal. */
+	for( x = 0; x < netifRX_DESCRIPTORS; x++ )
+	{
+		pxRxPbufs[ x ] = prvAllocateRxPbuf();
+		configASSERT( pxRxPbufs[ x ] );
+		prvGiveRxDescriptorToDMA( x );
+	}
+
+	/* The Tx ring starts out owned by the driver. */
+	for( x = 0; x < netifTX_DESCRIPTORS; x++ )
+	{
+		xTxRing[ x ].pvBuffer = NULL;
+		xTxRing[ x ].ulStatus = ( x == ( netifTX_DESCRIPTORS - 1 ) ) ? dmaDESC_WRAP : 0UL;
+		pxTxPbufs[ x ] = NULL;
+	}
+
+	xStatus = xMACInitialise( pxNetIf->hwaddr, xRxRing, netifRX_DESCRIPTORS, xTxRing, netifTX_DESCRIPTORS );
+
+	if( xStatus == pdPASS )
+	{
+		vMACSetInterruptCoalescing( netifRX_COALESCE_FRAMES, netifRX_COALESCE_USECS );
+
+		xStatus = xTaskCreate( prvEMACHandlerTask, "EMAC", netifINTERFACE_TASK_STACK_SIZE, ( void * ) pxNetIf, netifINTERFACE_TASK_PRIORITY, NULL );
+	}
+
+	if( xStatus == pdPASS )
+	{
+		vMACEnableRxInterrupt( pdTRUE );
+		vMACEnableInterrupts();
+	}
+
+	configASSERT( xStatus == pdPASS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReclaimTxDescriptors( void )
+{
+	while( uxTxFree < netifTX_DESCRIPTORS )
+	{
+		if( ( xTxRing[ uxTxTail ].ulStatus & dmaDESC_OWN ) != 0UL )
+		{
+			/* Still being sent, and so are all the descriptors after it. */
+			break;
+		}
+
+		if( pxTxPbufs[ uxTxTail ] != NULL )
+		{
+			pbuf_free( pxTxPbufs[ uxTxTail ] );
+			pxTxPbufs[ uxTxTail ] = NULL;
+		}
+
+		uxTxTail = prvNextDescriptor( uxTxTail, netifTX_DESCRIPTORS );
+		uxTxFree++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * This function should do the actual transmission of the packet. The packet is
+ * contained in the pbuf that is passed to the function. This pbuf
+ * might be chained.
+ *
+ * The chain is not copied, so the stack must not change it until the DMA
+ * engine has sent it.  The reference taken here is only dropped once the
+ * descriptors have been reclaimed, which happens long before the stack could
+ * retransmit the same TCP segment.
+ *
+ * @param pxNetIf the lwip network interface structure for this etherpxNetIf
+ * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
+ * @return ERR_OK if the packet could be sent
+ *		 an err_t value if the packet couldn't be sent
+ */
+static err_t prvLowLevelOutput( struct netif *pxNetIf, struct pbuf *p )
+{
+struct pbuf *q, *pxFrame;
+struct eth_hdr *pxHeader;
+unsigned portBASE_TYPE uxSegments = 0, uxQueued = 0, uxAttempt, uxIndex, uxFirst, uxLast = 0;
+unsigned long ulStatus, ulLength;
+unsigned char *pucData;
+portBASE_TYPE xCopy = pdFALSE;
+u16_t usTotalLength = p->tot_len - ETH_PAD_SIZE;
+err_t xReturn = ERR_OK;
+
+	/* Count the descriptors the frame needs, leaving out empty pbufs. */
+	for( q = p; q != NULL; q = q->next )
+	{
+		ulLength = ( q == p ) ? ( unsigned long ) ( q->len - ETH_PAD_SIZE ) : q->len;
+
+		if( ulLength > 0UL )
+		{
+			uxSegments++;
+
+			if( netifTX_BUFFER_IS_DMA_CAPABLE( q->payload ) == pdFALSE )
+			{
+				xCopy = pdTRUE;
+			}
+		}
+	}
+
+	LWIP_ASSERT( "uxSegments > 0", uxSegments > 0 );
+
+	if( ( xCopy != pdFALSE ) || ( uxSegments > netifTX_MAX_SEGMENTS ) )
+	{
+		pxFrame = pbuf_alloc( PBUF_RAW, p->tot_len, PBUF_RAM );
+
+		if( pxFrame != NULL )
+		{
+			pbuf_copy( pxFrame, p );
+			uxSegments = 1;
+			xStats.ulTxCopied++;
+		}
+		else
+		{
+			xReturn = ERR_MEM;
+		}
+	}
+	else
+	{
+		/* Keep the chain until the DMA engine has sent it. */
+		pbuf_ref( p );
+		pxFrame = p;
+	}
+
+	if( xReturn == ERR_OK )
+	{
+		prvReclaimTxDescriptors();
+
+		for( uxAttempt = 0; ( uxTxFree < uxSegments ) && ( uxAttempt < netifMAX_TX_ATTEMPTS ); uxAttempt++ )
+		{
+			/* The last frame queued asked for a Tx complete interrupt, as it
+			left fewer than netifTX_LOW_WATER descriptors free. */
+			xStats.ulTxWaits++;
+			xSemaphoreTake( xTxSemaphore, netifTX_BUFFER_FREE_WAIT );
+			prvReclaimTxDescriptors();
+		}
+
+		if( uxTxFree < uxSegments )
+		{
+			pbuf_free( pxFrame );
+			xReturn = ERR_BUF;
+		}
+	}
+
+	if( xReturn == ERR_OK )
+	{
+		uxFirst = uxTxHead;
+		uxIndex = uxTxHead;
+
+		for( q = pxFrame; q != NULL; q = q->next )
+		{
+			pucData = ( unsigned char * ) q->payload;
+			ulLength = q->len;
+
+			if( q == pxFrame )
+			{
+				pucData += ETH_PAD_SIZE;
+				ulLength -= ETH_PAD_SIZE;
+			}
+
+			if( ulLength == 0UL )
+			{
+				continue;
+			}
+
+			netifCACHE_CLEAN( pucData, ulLength );
+
+			ulStatus = ulLength & dmaDESC_LENGTH_MASK;
+
+			if( uxQueued == 0 )
+			{
+				/* dmaDESC_OWN is set on the first descriptor last of all, so
+				the DMA engine cannot start on a partly queued frame. */
+				ulStatus |= dmaDESC_FIRST;
+			}
+			else
+			{
+				ulStatus |= dmaDESC_OWN;
+			}
+
+			if( uxQueued == ( uxSegments - 1 ) )
+			{
+				ulStatus |= dmaDESC_LAST;
+
+				if( ( uxTxFree - uxSegments ) < netifTX_LOW_WATER )
+				{
+					ulStatus |= dmaDESC_IRQ;
+				}
+			}
+
+			if( uxIndex == ( netifTX_DESCRIPTORS - 1 ) )
+			{
+				ulStatus |= dmaDESC_WRAP;
+			}
+
+			xTxRing[ uxIndex ].pvBuffer = pucData;
+			xTxRing[ uxIndex ].ulStatus = ulStatus;
+
+			uxLast = uxIndex;
+			uxIndex = prvNextDescriptor( uxIndex, netifTX_DESCRIPTORS );
+			uxQueued++;
+		}
+
+		pxTxPbufs[ uxLast ] = pxFrame;
+		uxTxHead = uxIndex;
+		uxTxFree -= uxSegments;
+
+		netifDMA_BARRIER();
+		xTxRing[ uxFirst ].ulStatus |= dmaDESC_OWN;
+		netifDMA_BARRIER();
+		vMACResumeTx();
+
+		xStats.ulTxPackets++;
+		xStats.ulTxBytes += usTotalLength;
+
+		LINK_STATS_INC( link.xmit );
+		snmp_add_ifoutoctets( pxNetIf, usTotalLength );
+		pxHeader = ( struct eth_hdr * ) p->payload;
+
+		if( ( pxHeader->dest.addr[ 0 ] & 1 ) != 0 )
+		{
+			/* broadcast or multicast packet*/
+			snmp_inc_ifoutnucastpkts( pxNetIf );
+		}
+		else
+		{
+			/* unicast packet */
+			snmp_inc_ifoutucastpkts( pxNetIf );
+		}
+	}
+	else
+	{
+		xStats.ulTxDropped++;
+		LINK_STATS_INC( link.memerr );
+		LINK_STATS_INC( link.drop );
+		snmp_inc_ifoutdiscards( pxNetIf );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static struct pbuf *prvAllocateRxPbuf( void )
+{
+struct pbuf *p;
+
+	#if netifUSE_CUSTOM_PBUFS == 1
+	{
+	xRxBuffer *pxBuffer;
+	SYS_ARCH_DECL_PROTECT( xLevel );
+
+		SYS_ARCH_PROTECT( xLevel );
+		{
+			pxBuffer = pxFreeRxBuffers;
+
+			if( pxBuffer != NULL )
+			{
+				pxFreeRxBuffers = pxBuffer->pxNext;
+			}
+		}
+		SYS_ARCH_UNPROTECT( xLevel );
+
+		if( pxBuffer != NULL )
+		{
+			p = pbuf_alloced_custom( PBUF_RAW, netifRX_BUFFER_SIZE, PBUF_REF, &( pxBuffer->xPbuf ), pxBuffer->ucData, sizeof( pxBuffer->ucData ) );
+		}
+		else
+		{
+			p = NULL;
+		}
+	}
+	#else
+	{
+		p = pbuf_alloc( PBUF_RAW, netifRX_BUFFER_SIZE, PBUF_POOL );
+
+		/* netifRX_BUFFER_SIZE must not exceed PBUF_POOL_BUFSIZE. */
+		LWIP_ASSERT( "p->next == NULL", ( p == NULL ) || ( p->next == NULL ) );
+	}
+	#endif /* netifUSE_CUSTOM_PBUFS */
+
+	return p;
+}
+/*-----------------------------------------------------------*/
+
+#if netifUSE_CUSTOM_PBUFS == 1
+
+	static void prvFreeRxBuffer( struct pbuf *p )
+	{
+	xRxBuffer *pxBuffer = ( xRxBuffer * ) p;
+	SYS_ARCH_DECL_PROTECT( xLevel );
+
+		SYS_ARCH_PROTECT( xLevel );
+		{
+			pxBuffer->pxNext = pxFreeRxBuffers;
+			pxFreeRxBuffers = pxBuffer;
+		}
+		SYS_ARCH_UNPROTECT( xLevel );
+	}
+
+#endif /* netifUSE_CUSTOM_PBUFS */
+/*-----------------------------------------------------------*/
+
+static void prvGiveRxDescriptorToDMA( unsigned portBASE_TYPE uxIndex )
+{
+xDMADescriptor *pxDescriptor = &( xRxRing[ uxIndex ] );
+unsigned long ulStatus = dmaDESC_OWN | ( netifRX_DMA_SIZE & dmaDESC_LENGTH_MASK );
+
+	if( uxIndex == ( netifRX_DESCRIPTORS - 1 ) )
+	{
+		ulStatus |= dmaDESC_WRAP;
+	}
+
+	pxDescriptor->pvBuffer = &( ( ( unsigned char * ) pxRxPbufs[ uxIndex ]->payload )[ ETH_PAD_SIZE ] );
+	netifCACHE_INVALIDATE( pxDescriptor->pvBuffer, netifRX_DMA_SIZE );
+
+	netifDMA_BARRIER();
+	pxDescriptor->ulStatus = ulStatus;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned portBASE_TYPE prvProcessRxRing( struct netif *pxNetIf, unsigned portBASE_TYPE uxBudget )
+{
+unsigned portBASE_TYPE uxFrames = 0, uxCount, uxIndex, x;
+unsigned long ulFirstStatus, ulStatus = 0UL, ulLength, ulSegment;
+portBASE_TYPE xComplete, xGood;
+struct pbuf *pxReplacements[ netifRX_DESCRIPTORS ];
+struct pbuf *pxFrame, *q;
+struct eth_hdr *pxHeader;
+
+	while( uxFrames < uxBudget )
+	{
+		/* Find the descriptors of the next frame, stopping if the DMA engine
+		has not finished with all of them yet. */
+		uxCount = 0;
+		uxIndex = uxRxNext;
+		xComplete = pdFALSE;
+		ulFirstStatus = xRxRing[ uxIndex ].ulStatus;
+
+		while( uxCount < netifRX_DESCRIPTORS )
+		{
+			ulStatus = xRxRing[ uxIndex ].ulStatus;
+
+			if( ( ulStatus & dmaDESC_OWN ) != 0UL )
+			{
+				break;
+			}
+
+			uxCount++;
+
+			if( ( ulStatus & dmaDESC_LAST ) != 0UL )
+			{
+				xComplete = pdTRUE;
+				break;
+			}
+
+			uxIndex = prvNextDescriptor( uxIndex, netifRX_DESCRIPTORS );
+		}
+
+		if( ( xComplete == pdFALSE ) && ( uxCount < netifRX_DESCRIPTORS ) )
+		{
+			/* Nothing more received yet. */
+			break;
+		}
+
+		netifDMA_BARRIER();
+
+		ulLength = ulStatus & dmaDESC_LENGTH_MASK;
+
+		/* A frame that fills the whole ring without an end, a frame that does
+		not start on the next descriptor, and a frame the MAC didn't like are
+		all thrown away. */
+		xGood = xComplete;
+
+		if( ( ( ulFirstStatus & dmaDESC_FIRST ) == 0UL ) ||
+			( ( ulStatus & dmaDESC_ERROR ) != 0UL ) ||
+			( ulLength <= ( ( uxCount - 1 ) * netifRX_DMA_SIZE ) ) ||
+			( ulLength > ( uxCount * netifRX_DMA_SIZE ) ) )
+		{
+			xGood = pdFALSE;
+		}
+
+		if( xGood == pdFALSE )
+		{
+			xStats.ulRxErrors++;
+			LINK_STATS_INC( link.err );
+		}
+		else
+		{
+			/* Obtain the buffers that will replace the ones received into
+			before giving those to the stack. */
+			for( x = 0; x < uxCount; x++ )
+			{
+				pxReplacements[ x ] = prvAllocateRxPbuf();
+
+				if( pxReplacements[ x ] == NULL )
+				{
+					while( x > 0 )
+					{
+						x--;
+						pbuf_free( pxReplacements[ x ] );
+					}
+
+					xGood = pdFALSE;
+					xStats.ulRxDropped++;
+					LINK_STATS_INC( link.memerr );
+					LINK_STATS_INC( link.drop );
+					snmp_inc_ifindiscards( pxNetIf );
+					break;
+				}
+			}
+		}
+
+		pxFrame = NULL;
+		uxIndex = uxRxNext;
+
+		for( x = 0; x < uxCount; x++ )
+		{
+			if( xGood != pdFALSE )
+			{
+				ulSegment = ( ulLength > netifRX_DMA_SIZE ) ? netifRX_DMA_SIZE : ulLength;
+				ulLength -= ulSegment;
+
+				q = pxRxPbufs[ uxIndex ];
+				pxRxPbufs[ uxIndex ] = pxReplacements[ x ];
+				netifCACHE_INVALIDATE( xRxRing[ uxIndex ].pvBuffer, ulSegment );
+
+				if( pxFrame == NULL )
+				{
+					/* The first pbuf keeps the padding word in front of the
+					Ethernet header, as the stack expects. */
+					q->len = q->tot_len = ( u16_t ) ( ulSegment + ETH_PAD_SIZE );
+					pxFrame = q;
+				}
+				else
+				{
+					#if ETH_PAD_SIZE
+						pbuf_header( q, -ETH_PAD_SIZE );
+					#endif
+					q->len = q->tot_len = ( u16_t ) ulSegment;
+					pbuf_cat( pxFrame, q );
+				}
+			}
+
+			/* Either the fresh pbuf or, if the frame is being dropped, the
+			one that was just received into. */
+			prvGiveRxDescriptorToDMA( uxIndex );
+			uxIndex = prvNextDescriptor( uxIndex, netifRX_DESCRIPTORS );
+		}
+
+		uxRxNext = uxIndex;
+		uxFrames++;
+
+		if( pxFrame != NULL )
+		{
+			ulLength = pxFrame->tot_len - ETH_PAD_SIZE;
+			pxHeader = ( struct eth_hdr * ) pxFrame->payload;
+
+			if( ( pxHeader->dest.addr[ 0 ] & 1 ) != 0 )
+			{
+				snmp_inc_ifinnucastpkts( pxNetIf );
+			}
+			else
+			{
+				snmp_inc_ifinucastpkts( pxNetIf );
+			}
+
+			/* full packet send to tcpip_thread to process */
+			if( pxNetIf->input( pxFrame, pxNetIf ) == ERR_OK )
+			{
+				xStats.ulRxPackets++;
+				xStats.ulRxBytes += ulLength;
+				LINK_STATS_INC( link.recv );
+				snmp_add_ifinoctets( pxNetIf, ulLength );
+			}
+			else
+			{
+				LWIP_DEBUGF( NETIF_DEBUG, ( "ethernetif_input: IP input error\n" ) );
+				pbuf_free( pxFrame );
+				xStats.ulRxDropped++;
+				LINK_STATS_INC( link.drop );
+				snmp_inc_ifindiscards( pxNetIf );
+			}
+		}
+	}
+
+	if( uxFrames > 0 )
+	{
+		vMACResumeRx();
+	}
+
+	return uxFrames;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEMACHandlerTask( void *pvNetIf )
+{
+struct netif *pxNetIf = ( struct netif * ) pvNetIf;
+unsigned portBASE_TYPE uxFrames;
+
+	for( ;; )
+	{
+		xSemaphoreTake( xRxSemaphore, portMAX_DELAY );
+
+		/* The Rx interrupt stays masked while the ring is polled, so a burst
+		of frames costs one interrupt rather than one per frame. */
+		do
+		{
+			uxFrames = prvProcessRxRing( pxNetIf, netifRX_BUDGET );
+
+			if( uxFrames == netifRX_BUDGET )
+			{
+				taskYIELD();
+			}
+		} while( uxFrames == netifRX_BUDGET );
+
+		vMACEnableRxInterrupt( pdTRUE );
+
+		/* A frame that completed after the ring was last looked at, but
+		before the interrupt was unmasked, might not raise an interrupt of its
+		own. */
+		if( ( xRxRing[ uxRxNext ].ulStatus & dmaDESC_OWN ) == 0UL )
+		{
+			vMACEnableRxInterrupt( pdFALSE );
+			xSemaphoreGive( xRxSemaphore );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vEthernetIfDMAInterruptHandler( portBASE_TYPE xRxComplete, portBASE_TYPE xTxComplete, portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+	if( xRxComplete != pdFALSE )
+	{
+		xStats.ulRxInterrupts++;
+
+		/* Unmasked again by the handler task once the ring is empty. */
+		vMACEnableRxInterrupt( pdFALSE );
+		xSemaphoreGiveFromISR( xRxSemaphore, pxHigherPriorityTaskWoken );
+	}
+
+	if( xTxComplete != pdFALSE )
+	{
+		xStats.ulTxInterrupts++;
+		xSemaphoreGiveFromISR( xTxSemaphore, pxHigherPriorityTaskWoken );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vEthernetIfDMAGetStats( xEthernetIfDMAStats *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xStats;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Should be called at the beginning of the program to set up the
+ * network interface. It calls the function prvLowLevelInit() to do the
+ * actual setup of the hardware.
+ *
+ * This function should be passed as a parameter to netif_add().
+ *
+ * @param pxNetIf the lwip network interface structure for this etherpxNetIf
+ * @return ERR_OK if the loopif is initialized
+ *		 any other err_t on error
+ */
+err_t ethernetif_init( struct netif *pxNetIf )
+{
+	LWIP_ASSERT( "pxNetIf != NULL", ( pxNetIf != NULL ) );
+
+	#if LWIP_NETIF_HOSTNAME
+	{
+		/* Initialize interface hostname */
+		pxNetIf->hostname = "lwip";
+	}
+	#endif /* LWIP_NETIF_HOSTNAME */
+
+	pxNetIf->state = NULL;
+	pxNetIf->name[ 0 ] = IFNAME0;
+	pxNetIf->name[ 1 ] = IFNAME1;
+
+	/* We directly use etharp_output() here to save a function call. */
+	pxNetIf->output = etharp_output;
+	pxNetIf->linkoutput = prvLowLevelOutput;
+
+	/* initialize the hardware */
+	prvLowLevelInit( pxNetIf );
+
+	return ERR_OK;
+}
+/*-----------------------------------------------------------*/
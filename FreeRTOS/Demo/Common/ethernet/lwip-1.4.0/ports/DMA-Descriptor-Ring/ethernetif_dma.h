@@ -0,0 +1,108 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef ETHERNETIF_DMA_H
+#define ETHERNETIF_DMA_H
+
+/*
+ * The interface between the DMA descriptor ring netif in ethernetif.c and the
+ * MAC specific code of a port.  ethernetif.c owns the rings, the pbufs, the
+ * task and the counters.  The port only has to program the MAC, translate its
+ * interrupt status into a call to vEthernetIfDMAInterruptHandler(), and - when
+ * the MAC does not use the layout below - change xDMADescriptor and the
+ * dmaDESC_ bits to match the layout documented in the MAC's data sheet.
+ */
+
+/* A generic descriptor.  A descriptor belongs to the DMA engine while
+dmaDESC_OWN is set, and to the driver once the DMA engine has cleared it. */
+typedef struct xDMA_DESCRIPTOR
+{
+	volatile unsigned long ulStatus;	/* dmaDESC_ bits and the length. */
+	void * volatile pvBuffer;			/* The buffer being received into or sent from. */
+} xDMADescriptor;
+
+#define dmaDESC_OWN				0x80000000UL	/* Set by the driver, cleared by the DMA engine when done. */
+#define dmaDESC_FIRST			0x40000000UL	/* The first descriptor of a frame. */
+#define dmaDESC_LAST			0x20000000UL	/* The last descriptor of a frame. */
+#define dmaDESC_ERROR			0x10000000UL	/* Rx only: the frame was received with an error. */
+#define dmaDESC_IRQ				0x08000000UL	/* Tx only: interrupt when the descriptor completes. */
+#define dmaDESC_WRAP			0x04000000UL	/* The last descriptor of the ring. */
+#define dmaDESC_LENGTH_MASK		0x0000FFFFUL	/* Rx: buffer size, replaced by the frame length on the last descriptor.  Tx: bytes to send. */
+
+/* Counters maintained by the netif, see vEthernetIfDMAGetStats(). */
+typedef struct xETHERNETIF_DMA_STATS
+{
+	unsigned long ulRxPackets;		/* Frames passed to the stack. */
+	unsigned long ulRxBytes;		/* Bytes in those frames. */
+	unsigned long ulRxErrors;		/* Frames the MAC flagged as bad. */
+	unsigned long ulRxDropped;		/* Frames dropped for want of a buffer or by the stack. */
+	unsigned long ulTxPackets;		/* Frames handed to the DMA engine. */
+	unsigned long ulTxBytes;		/* Bytes in those frames. */
+	unsigned long ulTxCopied;		/* Frames that had to be copied into one buffer first. */
+	unsigned long ulTxWaits;		/* Times a send waited for free descriptors. */
+	unsigned long ulTxDropped;		/* Frames dropped because the Tx ring stayed full. */
+	unsigned long ulRxInterrupts;	/* Rx interrupts taken. */
+	unsigned long ulTxInterrupts;	/* Tx interrupts taken. */
+} xEthernetIfDMAStats;
+
+/*
+ * Implemented by the port.
+ */
+
+/* Reset and configure the MAC and PHY, program the MAC address, and give the
+DMA engine the base address of both rings.  The interrupts must not be enabled
+yet.  Return pdPASS if the MAC is ready. */
+portBASE_TYPE xMACInitialise( const unsigned char *pucMACAddress, xDMADescriptor *pxRxRing, unsigned portBASE_TYPE uxRxCount, xDMADescriptor *pxTxRing, unsigned portBASE_TYPE uxTxCount );
+
+/* Program the hardware interrupt moderation, if the MAC has any: raise an Rx
+interrupt after ulFrames frames or ulMicroseconds after the first one,
+whichever comes first.  An empty function is fine. */
+void vMACSetInterruptCoalescing( unsigned long ulFrames, unsigned long ulMicroseconds );
+
+/* Mask or unmask the Rx complete interrupt.  May be called from the Rx
+interrupt itself. */
+void vMACEnableRxInterrupt( portBASE_TYPE xEnable );
+
+/* Enable the MAC interrupt in the interrupt controller, once the driver is
+ready to receive it. */
+void vMACEnableInterrupts( void );
+
+/* Tell the DMA engine that descriptors have been handed to it, in case it
+suspended on a descriptor it did not own (the "poll demand" register). */
+void vMACResumeRx( void );
+void vMACResumeTx( void );
+
+/*
+ * Implemented by ethernetif.c.
+ */
+
+/* Called by the port's MAC interrupt handler with the events the MAC reports. */
+void vEthernetIfDMAInterruptHandler( portBASE_TYPE xRxComplete, portBASE_TYPE xTxComplete, portBASE_TYPE *pxHigherPriorityTaskWoken );
+
+/* Take a copy of the counters. */
+void vEthernetIfDMAGetStats( xEthernetIfDMAStats *pxStats );
+
+#endif /* ETHERNETIF_DMA_H */
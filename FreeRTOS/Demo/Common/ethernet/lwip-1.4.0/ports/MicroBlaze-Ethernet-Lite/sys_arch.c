@@ -53,6 +53,8 @@ functions are being called from an interrupt context or not.  This relies on
 the interrupt handler setting this variable manually. */
 portBASE_TYPE xInsideISR = pdFALSE;
 
+#if sysarchUSE_FAST_MBOX == 0
+
 /*---------------------------------------------------------------------------*
  * Routine:  sys_mbox_new
  *---------------------------------------------------------------------------*
@@ -287,6 +289,374 @@ portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 	return ulReturn;
 }
 
+#else /* sysarchUSE_FAST_MBOX */
+
+/* The task notification index used to wake a task that is blocked on an empty
+mailbox.  A task that fetches from a mailbox must not use this index for
+anything else.  Needs configUSE_TASK_NOTIFICATIONS and
+INCLUDE_xTaskGetCurrentTaskHandle set to 1. */
+#ifndef sysarchMBOX_NOTIFY_INDEX
+	#define sysarchMBOX_NOTIFY_INDEX	( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+#endif
+
+/* A mailbox is a ring of message pointers.  Any number of tasks can post to
+it, each inside a short critical section, but only one task at a time fetches
+from it - which is how lwIP uses its mailboxes - so fetching a message that is
+already there needs no lock at all.  A task that finds the mailbox empty
+records its handle and waits for a direct to task notification, which is much
+cheaper than the event list handling of a queue.  A task that finds the
+mailbox full does the same, and is woken by the task that fetches the next
+message.  uxHead and uxTail count the messages posted and fetched since the
+mailbox was created; the ring size is a power of two so the counts can simply
+wrap.  This relies on a single core, as nothing orders the accesses of the
+fetching task on a multicore part. */
+struct xSYS_ARCH_MBOX
+{
+	volatile unsigned portBASE_TYPE uxHead;		/* Only written by posting tasks, inside a critical section. */
+	volatile unsigned portBASE_TYPE uxTail;		/* Only written by the fetching task. */
+	unsigned portBASE_TYPE uxLength;			/* The number of messages the mailbox can hold. */
+	unsigned portBASE_TYPE uxMask;				/* The ring size minus one. */
+	TaskHandle_t volatile xWaitingTask;			/* The task blocked on the empty mailbox, or NULL. */
+	TaskHandle_t volatile xWaitingPoster;		/* A task blocked on the full mailbox, or NULL. */
+	void * volatile pvMessages[ 1 ];			/* The ring, allocated with the structure. */
+};
+
+/*
+ * Add pvMessage to the mailbox without blocking, and wake the task waiting
+ * for it, if any.  Returns pdFAIL if the mailbox is full, in which case the
+ * calling task is recorded as the one to wake when there is room if
+ * xWillWait is pdTRUE and no other task is recorded already.
+ */
+static portBASE_TYPE prvMboxPost( sys_mbox_t pxMailBox, void *pvMessage, portBASE_TYPE xWillWait );
+
+/*
+ * Wake the task waiting for room in the mailbox, if any.
+ */
+static void prvMboxWakePoster( sys_mbox_t pxMailBox );
+
+/*
+ * Take the oldest message from the mailbox, waiting up to xTicksToWait for one
+ * to arrive.  Returns pdFAIL if none arrived in time.
+ */
+static portBASE_TYPE prvMboxFetch( sys_mbox_t pxMailBox, void **ppvMessage, TickType_t xTicksToWait );
+
+/*---------------------------------------------------------------------------*/
+
+err_t sys_mbox_new( sys_mbox_t *pxMailBox, int iSize )
+{
+err_t xReturn = ERR_MEM;
+unsigned portBASE_TYPE uxRingSize = 1;
+
+	configASSERT( iSize > 0 );
+
+	while( uxRingSize < ( unsigned portBASE_TYPE ) iSize )
+	{
+		uxRingSize <<= 1;
+	}
+
+	*pxMailBox = ( sys_mbox_t ) pvPortMalloc( sizeof( struct xSYS_ARCH_MBOX ) + ( ( uxRingSize - 1 ) * sizeof( void * ) ) );
+
+	if( *pxMailBox != NULL )
+	{
+		( *pxMailBox )->uxHead = 0;
+		( *pxMailBox )->uxTail = 0;
+		( *pxMailBox )->uxLength = ( unsigned portBASE_TYPE ) iSize;
+		( *pxMailBox )->uxMask = uxRingSize - 1;
+		( *pxMailBox )->xWaitingTask = NULL;
+		( *pxMailBox )->xWaitingPoster = NULL;
+
+		xReturn = ERR_OK;
+		SYS_STATS_INC_USED( mbox );
+	}
+
+	return xReturn;
+}
+/*---------------------------------------------------------------------------*/
+
+void sys_mbox_free( sys_mbox_t *pxMailBox )
+{
+unsigned long ulMessagesWaiting;
+
+	ulMessagesWaiting = ( *pxMailBox )->uxHead - ( *pxMailBox )->uxTail;
+	configASSERT( ( ulMessagesWaiting == 0 ) );
+
+	#if SYS_STATS
+	{
+		if( ulMessagesWaiting != 0UL )
+		{
+			SYS_STATS_INC( mbox.err );
+		}
+
+		SYS_STATS_DEC( mbox.used );
+	}
+	#endif /* SYS_STATS */
+
+	vPortFree( *pxMailBox );
+}
+/*---------------------------------------------------------------------------*/
+
+void sys_mbox_post( sys_mbox_t *pxMailBox, void *pxMessageToPost )
+{
+	while( prvMboxPost( *pxMailBox, pxMessageToPost, pdTRUE ) != pdPASS )
+	{
+		/* The mailbox is full.  Wait to be woken by the task that fetches
+		from it - which only wakes one waiting task, so a task other than
+		that one polls once per tick. */
+		ulTaskNotifyTakeIndexed( sysarchMBOX_NOTIFY_INDEX, pdTRUE, 1 );
+	}
+}
+/*---------------------------------------------------------------------------*/
+
+err_t sys_mbox_trypost( sys_mbox_t *pxMailBox, void *pxMessageToPost )
+{
+err_t xReturn;
+
+	if( prvMboxPost( *pxMailBox, pxMessageToPost, pdFALSE ) == pdPASS )
+	{
+		xReturn = ERR_OK;
+	}
+	else
+	{
+		/* The mailbox was already full. */
+		xReturn = ERR_MEM;
+		SYS_STATS_INC( mbox.err );
+	}
+
+	return xReturn;
+}
+/*---------------------------------------------------------------------------*/
+
+u32_t sys_arch_mbox_fetch( sys_mbox_t *pxMailBox, void **ppvBuffer, u32_t ulTimeOut )
+{
+void *pvDummy;
+TickType_t xStartTime, xEndTime, xElapsed;
+unsigned long ulReturn;
+
+	xStartTime = xTaskGetTickCount();
+
+	configASSERT( xInsideISR == ( portBASE_TYPE ) 0 );
+	if( NULL == ppvBuffer )
+	{
+		ppvBuffer = &pvDummy;
+	}
+
+	if( ulTimeOut != 0UL )
+	{
+		if( prvMboxFetch( *pxMailBox, ppvBuffer, ulTimeOut / portTICK_PERIOD_MS ) == pdPASS )
+		{
+			xEndTime = xTaskGetTickCount();
+			xElapsed = ( xEndTime - xStartTime ) * portTICK_PERIOD_MS;
+
+			ulReturn = xElapsed;
+		}
+		else
+		{
+			/* Timed out. */
+			*ppvBuffer = NULL;
+			ulReturn = SYS_ARCH_TIMEOUT;
+		}
+	}
+	else
+	{
+		while( prvMboxFetch( *pxMailBox, ppvBuffer, portMAX_DELAY ) != pdPASS );
+		xEndTime = xTaskGetTickCount();
+		xElapsed = ( xEndTime - xStartTime ) * portTICK_PERIOD_MS;
+
+		if( xElapsed == 0UL )
+		{
+			xElapsed = 1UL;
+		}
+
+		ulReturn = xElapsed;
+	}
+
+	return ulReturn;
+}
+/*---------------------------------------------------------------------------*/
+
+u32_t sys_arch_mbox_tryfetch( sys_mbox_t *pxMailBox, void **ppvBuffer )
+{
+void *pvDummy;
+unsigned long ulReturn;
+
+	if( ppvBuffer == NULL )
+	{
+		ppvBuffer = &pvDummy;
+	}
+
+	if( prvMboxFetch( *pxMailBox, ppvBuffer, 0 ) == pdPASS )
+	{
+		ulReturn = ERR_OK;
+	}
+	else
+	{
+		ulReturn = SYS_MBOX_EMPTY;
+	}
+
+	return ulReturn;
+}
+/*---------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMboxPost( sys_mbox_t pxMailBox, void *pvMessage, portBASE_TYPE xWillWait )
+{
+portBASE_TYPE xReturn = pdFAIL;
+TaskHandle_t xTaskToWake = NULL;
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	/* Interrupts are already disabled when xInsideISR is set. */
+	if( xInsideISR == pdFALSE )
+	{
+		taskENTER_CRITICAL();
+	}
+
+	if( ( pxMailBox->uxHead - pxMailBox->uxTail ) < pxMailBox->uxLength )
+	{
+		pxMailBox->pvMessages[ pxMailBox->uxHead & pxMailBox->uxMask ] = pvMessage;
+		pxMailBox->uxHead++;
+
+		xTaskToWake = pxMailBox->xWaitingTask;
+		pxMailBox->xWaitingTask = NULL;
+		xReturn = pdPASS;
+
+		if( ( xWillWait != pdFALSE ) && ( pxMailBox->xWaitingPoster == xTaskGetCurrentTaskHandle() ) )
+		{
+			pxMailBox->xWaitingPoster = NULL;
+		}
+	}
+	else if( ( xWillWait != pdFALSE ) && ( pxMailBox->xWaitingPoster == NULL ) )
+	{
+		pxMailBox->xWaitingPoster = xTaskGetCurrentTaskHandle();
+	}
+
+	if( xInsideISR == pdFALSE )
+	{
+		taskEXIT_CRITICAL();
+	}
+
+	if( xTaskToWake != NULL )
+	{
+		if( xInsideISR != pdFALSE )
+		{
+			vTaskNotifyGiveIndexedFromISR( xTaskToWake, sysarchMBOX_NOTIFY_INDEX, &xHigherPriorityTaskWoken );
+		}
+		else
+		{
+			xTaskNotifyGiveIndexed( xTaskToWake, sysarchMBOX_NOTIFY_INDEX );
+		}
+	}
+
+	return xReturn;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvMboxWakePoster( sys_mbox_t pxMailBox )
+{
+TaskHandle_t xTaskToWake;
+portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	if( xInsideISR == pdFALSE )
+	{
+		taskENTER_CRITICAL();
+	}
+
+	xTaskToWake = pxMailBox->xWaitingPoster;
+	pxMailBox->xWaitingPoster = NULL;
+
+	if( xInsideISR == pdFALSE )
+	{
+		taskEXIT_CRITICAL();
+	}
+
+	if( xTaskToWake != NULL )
+	{
+		if( xInsideISR != pdFALSE )
+		{
+			vTaskNotifyGiveIndexedFromISR( xTaskToWake, sysarchMBOX_NOTIFY_INDEX, &xHigherPriorityTaskWoken );
+		}
+		else
+		{
+			xTaskNotifyGiveIndexed( xTaskToWake, sysarchMBOX_NOTIFY_INDEX );
+		}
+	}
+}
+/*---------------------------------------------------------------------------*/
+
+static portBASE_TYPE prvMboxFetch( sys_mbox_t pxMailBox, void **ppvMessage, TickType_t xTicksToWait )
+{
+TimeOut_t xTimeOut;
+TaskHandle_t xThisTask;
+portBASE_TYPE xReturn = pdFAIL, xWaiting;
+
+	if( xTicksToWait != 0 )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+	}
+
+	for( ;; )
+	{
+		if( pxMailBox->uxTail != pxMailBox->uxHead )
+		{
+			/* Only this task moves uxTail, and posting tasks never touch a
+			slot between uxTail and uxHead, so no lock is needed. */
+			*ppvMessage = pxMailBox->pvMessages[ pxMailBox->uxTail & pxMailBox->uxMask ];
+			pxMailBox->uxTail++;
+
+			if( pxMailBox->xWaitingPoster != NULL )
+			{
+				prvMboxWakePoster( pxMailBox );
+			}
+
+			xReturn = pdPASS;
+			break;
+		}
+
+		if( ( xTicksToWait == 0 ) || ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE ) )
+		{
+			break;
+		}
+
+		xThisTask = xTaskGetCurrentTaskHandle();
+		xWaiting = pdFALSE;
+
+		taskENTER_CRITICAL();
+		{
+			/* Check again now that no task can post. */
+			if( pxMailBox->uxTail == pxMailBox->uxHead )
+			{
+				/* Only one task at a time can fetch from a mailbox. */
+				configASSERT( ( pxMailBox->xWaitingTask == NULL ) || ( pxMailBox->xWaitingTask == xThisTask ) );
+				pxMailBox->xWaitingTask = xThisTask;
+				xWaiting = pdTRUE;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xWaiting != pdFALSE )
+		{
+			if( ulTaskNotifyTakeIndexed( sysarchMBOX_NOTIFY_INDEX, pdTRUE, xTicksToWait ) == 0UL )
+			{
+				/* Timed out.  Withdraw, unless a posting task got there
+				first, in which case there is a message to fetch. */
+				taskENTER_CRITICAL();
+				{
+					if( pxMailBox->xWaitingTask == xThisTask )
+					{
+						pxMailBox->xWaitingTask = NULL;
+					}
+				}
+				taskEXIT_CRITICAL();
+			}
+		}
+
+		/* A notification left over from an earlier wait can also end up here,
+		so go round again rather than assume there is a message. */
+	}
+
+	return xReturn;
+}
+
+#endif /* sysarchUSE_FAST_MBOX */
+
 /*---------------------------------------------------------------------------*
  * Routine:  sys_sem_new
  *---------------------------------------------------------------------------*
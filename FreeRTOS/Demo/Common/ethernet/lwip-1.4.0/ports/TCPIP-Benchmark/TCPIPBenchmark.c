@@ -0,0 +1,166 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Measures how many packets per second can be passed to the tcpip thread
+ * through tcpip_input(), which is dominated by the cost of the sys_arch
+ * mailbox.  See TCPIPBenchmark.h.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* lwIP includes. */
+#include "lwip/opt.h"
+#include "lwip/tcpip.h"
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+#include "netif/etharp.h"
+
+#include "TCPIPBenchmark.h"
+
+/* The size of each frame, the minimum Ethernet frame without the CRC. */
+#define benchFRAME_SIZE		( 60 )
+
+/* An Ethernet type reserved for local experiments, which lwIP drops. */
+#define benchETHERNET_TYPE	( 0x88b5U )
+
+/* Ports other than those in this directory tree do not have the option. */
+#ifndef sysarchUSE_FAST_MBOX
+	#define sysarchUSE_FAST_MBOX	0
+#endif
+
+/* How long to wait for the tcpip thread to process the last packet. */
+#define benchDONE_WAIT		( ( TickType_t ) 10000UL / portTICK_PERIOD_MS )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Run by the tcpip thread once it has processed all the packets posted
+ * before it.
+ */
+static void prvBenchmarkDone( void *pvSemaphore );
+
+/*-----------------------------------------------------------*/
+
+/* The interface the frames claim to have arrived on.  It is never added to
+the list of interfaces, only its flags are looked at. */
+static struct netif xBenchmarkNetIf;
+
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xTCPIPBenchmarkRun( unsigned long ulPackets, xTCPIPBenchmarkResult *pxResult )
+{
+SemaphoreHandle_t xDone;
+struct pbuf *p;
+struct eth_hdr *pxHeader;
+unsigned long ulPosted = 0;
+TickType_t xStartTime, xElapsed;
+portBASE_TYPE xReturn = pdFAIL;
+
+	memset( pxResult, 0, sizeof( *pxResult ) );
+	pxResult->uxFastMailbox = sysarchUSE_FAST_MBOX;
+
+	memset( &xBenchmarkNetIf, 0, sizeof( xBenchmarkNetIf ) );
+	xBenchmarkNetIf.flags = NETIF_FLAG_ETHARP;
+	xBenchmarkNetIf.input = tcpip_input;
+
+	xDone = xSemaphoreCreateBinary();
+
+	if( xDone != NULL )
+	{
+		xStartTime = xTaskGetTickCount();
+
+		while( ulPosted < ulPackets )
+		{
+			/* Allocate each frame as a driver would. */
+			p = pbuf_alloc( PBUF_RAW, benchFRAME_SIZE + ETH_PAD_SIZE, PBUF_POOL );
+
+			if( p == NULL )
+			{
+				pxResult->ulRetries++;
+				vTaskDelay( 1 );
+				continue;
+			}
+
+			memset( p->payload, 0, p->len );
+			pxHeader = ( struct eth_hdr * ) p->payload;
+			memset( &( pxHeader->dest ), 0xff, sizeof( pxHeader->dest ) );
+			pxHeader->type = PP_HTONS( benchETHERNET_TYPE );
+
+			while( xBenchmarkNetIf.input( p, &xBenchmarkNetIf ) != ERR_OK )
+			{
+				/* The mailbox or the message pool is exhausted.  Let the
+				tcpip thread catch up, as it might not run otherwise if this
+				task has the higher priority. */
+				pxResult->ulRetries++;
+				vTaskDelay( 1 );
+			}
+
+			ulPosted++;
+		}
+
+		/* The mailbox is first in first out, so the callback runs once the
+		tcpip thread has finished with all the packets. */
+		if( tcpip_callback( prvBenchmarkDone, ( void * ) xDone ) == ERR_OK )
+		{
+			if( xSemaphoreTake( xDone, benchDONE_WAIT ) == pdPASS )
+			{
+				xElapsed = ( xTaskGetTickCount() - xStartTime ) * portTICK_PERIOD_MS;
+
+				if( xElapsed == 0 )
+				{
+					xElapsed = 1;
+				}
+
+				pxResult->ulPackets = ulPosted;
+				pxResult->ulMilliseconds = ( unsigned long ) xElapsed;
+				pxResult->ulPacketsPerSecond = ( ( ulPosted / xElapsed ) * 1000UL ) + ( ( ( ulPosted % xElapsed ) * 1000UL ) / xElapsed );
+				xReturn = pdPASS;
+			}
+		}
+
+		/* Only deleted once the callback has given it. */
+		if( xReturn == pdPASS )
+		{
+			vSemaphoreDelete( xDone );
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchmarkDone( void *pvSemaphore )
+{
+	xSemaphoreGive( ( SemaphoreHandle_t ) pvSemaphore );
+}
+/*-----------------------------------------------------------*/
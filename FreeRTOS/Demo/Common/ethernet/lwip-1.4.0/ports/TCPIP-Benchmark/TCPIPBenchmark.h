@@ -0,0 +1,54 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TCPIP_BENCHMARK_H
+#define TCPIP_BENCHMARK_H
+
+typedef struct xTCPIP_BENCHMARK_RESULT
+{
+	unsigned long ulPackets;			/* Packets passed through tcpip_input(). */
+	unsigned long ulMilliseconds;		/* Time from the first post until the tcpip thread processed the last packet. */
+	unsigned long ulPacketsPerSecond;
+	unsigned long ulRetries;			/* Posts retried because the mailbox, the message pool or the pbuf pool was exhausted. */
+	unsigned portBASE_TYPE uxFastMailbox;	/* The value of sysarchUSE_FAST_MBOX the port was built with. */
+} xTCPIPBenchmarkResult;
+
+/*
+ * Pass ulPackets minimal Ethernet frames through tcpip_input(), and so through
+ * the tcpip thread's mailbox, and time how long the tcpip thread takes to
+ * process them.  The frames have an Ethernet type lwIP does not know, so each
+ * one is only looked at and freed.  Build the port once with
+ * sysarchUSE_FAST_MBOX set to 0 and once with it set to 1 to compare the two
+ * mailbox implementations.
+ *
+ * Must be called from a task, after tcpip_init() has completed.  The priority
+ * of the calling task relative to TCPIP_THREAD_PRIO decides whether the tcpip
+ * thread runs after every post or only when the caller blocks, so measure
+ * both ways.  Returns pdFAIL if the benchmark could not be started.
+ */
+portBASE_TYPE xTCPIPBenchmarkRun( unsigned long ulPackets, xTCPIPBenchmarkResult *pxResult );
+
+#endif /* TCPIP_BENCHMARK_H */
@@ -37,15 +37,32 @@
 #include "queue.h"
 #include "semphr.h"
 
-#define SYS_MBOX_NULL					( ( QueueHandle_t ) NULL )
+/* lwipopts.h can set sysarchUSE_FAST_MBOX. */
+#include "lwip/opt.h"
+
+/* Set sysarchUSE_FAST_MBOX to 1 to implement mailboxes as a ring buffer that
+wakes the fetching task with a direct to task notification, rather than as a
+queue.  See sys_arch.c. */
+#ifndef sysarchUSE_FAST_MBOX
+	#define sysarchUSE_FAST_MBOX		0
+#endif
+
 #define SYS_SEM_NULL					( ( SemaphoreHandle_t ) NULL )
 #define SYS_DEFAULT_THREAD_STACK_DEPTH	configMINIMAL_STACK_SIZE
 
 typedef SemaphoreHandle_t sys_sem_t;
 typedef SemaphoreHandle_t sys_mutex_t;
-typedef QueueHandle_t sys_mbox_t;
 typedef TaskHandle_t sys_thread_t;
 
+#if sysarchUSE_FAST_MBOX == 1
+	struct xSYS_ARCH_MBOX;
+	typedef struct xSYS_ARCH_MBOX * sys_mbox_t;
+	#define SYS_MBOX_NULL					( ( sys_mbox_t ) NULL )
+#else
+	typedef QueueHandle_t sys_mbox_t;
+	#define SYS_MBOX_NULL					( ( QueueHandle_t ) NULL )
+#endif
+
 typedef unsigned long sys_prot_t;
 
 #define sys_mbox_valid( x ) ( ( ( *x ) == NULL) ? pdFALSE : pdTRUE )
@@ -0,0 +1,105 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef AMP_ZERO_COPY_H
+#define AMP_ZERO_COPY_H
+
+/* The size of each frame in the pool.  Keep it a multiple of the cache line
+ * size when the frames are in cached memory. */
+#ifndef ampzcFRAME_SIZE
+    #define ampzcFRAME_SIZE           ( 1024 )
+#endif
+
+/* The number of frames in the pool, which must be a power of two. */
+#ifndef ampzcNUMBER_OF_FRAMES
+    #define ampzcNUMBER_OF_FRAMES     ( 8 )
+#endif
+
+/* Describes a frame that is passed from one core to the other. */
+typedef struct AMPZeroCopyDescriptor
+{
+    uint32_t ulFrame;  /* Index of the frame in the pool. */
+    uint32_t ulLength; /* Bytes of data in the frame. */
+} AMPZeroCopyDescriptor_t;
+
+/* A ring written by one core and read by the other.  Only the writer updates
+ * ulHead and only the reader updates ulTail, so no lock is needed. */
+typedef struct AMPZeroCopyRing
+{
+    volatile uint32_t ulHead;
+    volatile uint32_t ulTail;
+    AMPZeroCopyDescriptor_t xDescriptors[ ampzcNUMBER_OF_FRAMES ];
+} AMPZeroCopyRing_t;
+
+/* Must be at the same address on both cores, in memory that is not cached.
+ * The frame pool it points to can be cached, see ampzcCLEAN_CACHE() and
+ * ampzcINVALIDATE_CACHE() in AMPZeroCopy.c. */
+typedef struct AMPZeroCopyChannel
+{
+    AMPZeroCopyRing_t xFullRing;  /* Frames sent by core A to core B. */
+    AMPZeroCopyRing_t xFreeRing;  /* Frames released by core B back to core A. */
+    uint8_t * pucFramePool;       /* ampzcNUMBER_OF_FRAMES * ampzcFRAME_SIZE bytes. */
+} AMPZeroCopyChannel_t;
+
+/* Called once by core A, before either core uses the channel. */
+void vAMPZeroCopyInitialise( AMPZeroCopyChannel_t * pxChannel,
+                             uint8_t * pucFramePool );
+
+/* Called by one task on core A. */
+void * pvAMPZeroCopyGetFrame( AMPZeroCopyChannel_t * pxChannel,
+                              TickType_t xTicksToWait );
+void vAMPZeroCopySendFrame( AMPZeroCopyChannel_t * pxChannel,
+                            void * pvFrame,
+                            size_t xLength );
+
+/* Called by one task on core B. */
+void * pvAMPZeroCopyReceiveFrame( AMPZeroCopyChannel_t * pxChannel,
+                                  size_t * pxLength,
+                                  TickType_t xTicksToWait );
+void vAMPZeroCopyReleaseFrame( AMPZeroCopyChannel_t * pxChannel,
+                               void * pvFrame );
+
+/* The inter-core interrupt handlers, which wake the task waiting on the
+ * core they run on. */
+void vAMPZeroCopyCoreAInterruptHandler( void );
+void vAMPZeroCopyCoreBInterruptHandler( void );
+
+/* Compares the channel with copying the same frames through a message buffer,
+ * with both "cores" emulated on one core as in MessageBufferAMP.c.  Times are in
+ * counts of ampzcGET_TIME(). */
+typedef struct AMPZeroCopyBenchmarkResult
+{
+    const char * pcTransport;
+    uint32_t ulFramesPerSecond;
+    uint32_t ulAverageLatency;
+    uint32_t ulMaxLatency;
+} AMPZeroCopyBenchmarkResult_t;
+
+void vStartAMPZeroCopyBenchmark( configSTACK_DEPTH_TYPE xStackSize );
+BaseType_t xIsAMPZeroCopyBenchmarkComplete( void );
+UBaseType_t uxGetAMPZeroCopyBenchmarkResults( const AMPZeroCopyBenchmarkResult_t ** ppxResults );
+
+#endif /* AMP_ZERO_COPY_H */
@@ -0,0 +1,101 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BENCHMARK_SUITE_H
+#define BENCHMARK_SUITE_H
+
+/* The version of the line format written by vBenchmarkSuiteReport().  It is
+ * only increased when a key is renamed or its meaning changes, so results
+ * from different boards and releases can be compared by the same script. */
+#define bmsFORMAT_VERSION    1
+
+/* The unit of the times read from the port, which is the run time stats
+ * counter unless bmsGET_CYCLES() is defined. */
+#ifndef bmsCYCLES_UNIT
+    #define bmsCYCLES_UNIT    "counts"
+#endif
+
+/* A benchmark as seen by the suite.  pvStart() can be NULL if the benchmark
+ * was already started, for example before the scheduler.  pvReport() reads
+ * the results of the benchmark and passes each figure to
+ * vBenchmarkSuiteReport() or vBenchmarkSuiteReportSamples(). */
+typedef struct BenchmarkDefinition
+{
+    const char * pcName;
+    void ( * pvStart )( void );
+    BaseType_t ( * pxIsComplete )( void );
+    void ( * pvReport )( void );
+} BenchmarkDefinition_t;
+
+/* Measurements to be summarised by percentiles, held in a buffer provided by
+ * the caller. */
+typedef struct BenchmarkSamples
+{
+    uint32_t * pulSamples;
+    size_t xCapacity;
+    size_t xCount;
+    size_t xDropped;    /* Samples added after the buffer was full. */
+    BaseType_t xSorted;
+} BenchmarkSamples_t;
+
+/* Adds a benchmark to the end of the suite.  Returns pdFAIL if the suite
+ * already holds bmsMAX_BENCHMARKS benchmarks. */
+BaseType_t xBenchmarkSuiteRegister( const BenchmarkDefinition_t * pxBenchmark );
+
+/* Runs the registered benchmarks one after the other from the calling task,
+ * checking every xPollPeriod ticks whether the running one is complete.
+ * pcBoard names the board in every line written. */
+void vBenchmarkSuiteRun( const char * pcBoard,
+                         TickType_t xPollPeriod );
+
+/* Writes one result as a line of JSON.  Only to be called from the pvReport()
+ * function of a benchmark.  pcCase tells apart the results of one benchmark,
+ * for example "kernel/8" for the kernel timers with eight timers running. */
+void vBenchmarkSuiteReport( const char * pcCase,
+                            const char * pcMetric,
+                            uint64_t ullValue,
+                            const char * pcUnit );
+
+void vBenchmarkSamplesInit( BenchmarkSamples_t * pxSamples,
+                            uint32_t * pulStorage,
+                            size_t xCapacity );
+void vBenchmarkSamplesAdd( BenchmarkSamples_t * pxSamples,
+                           uint32_t ulSample );
+
+/* Returns the nearest rank percentile of the samples, so 0 is the smallest
+ * sample and 100 the largest.  Sorts the samples the first time it is called
+ * after a sample was added.  Returns 0 if there are no samples. */
+uint32_t ulBenchmarkSamplesPercentile( BenchmarkSamples_t * pxSamples,
+                                       uint32_t ulPercent );
+
+/* Reports the sample count and the min, p50, p90, p99, max and average of the
+ * samples, with the metric names suffixed "_min", "_p50" and so on. */
+void vBenchmarkSuiteReportSamples( const char * pcCase,
+                                   const char * pcMetric,
+                                   BenchmarkSamples_t * pxSamples,
+                                   const char * pcUnit );
+
+#endif /* BENCHMARK_SUITE_H */
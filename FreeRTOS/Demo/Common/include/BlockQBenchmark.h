@@ -0,0 +1,45 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef BLOCKQ_BENCHMARK_H
+#define BLOCKQ_BENCHMARK_H
+
+/* The result for one arrangement of producer and consumer priorities and one
+ * number of items per call, see BlockQBenchmark.c. */
+typedef struct BlockQBenchmarkResult
+{
+    const char * pcPriorities; /* "consumer high", "producer high" or "equal". */
+    UBaseType_t uxBatch;       /* Items per call, 1 for xQueueSend() and xQueueReceive(). */
+    uint32_t ulItemsPerSecond;
+    uint32_t ulWaitsPer1000;   /* Times a task waited on the queue, each a switch away and back, per 1000 items. */
+    BaseType_t xErrorDetected; /* pdTRUE if an item was lost, repeated or out of order. */
+} BlockQBenchmarkResult_t;
+
+void vStartBlockQBenchmark( void );
+BaseType_t xIsBlockQBenchmarkComplete( void );
+UBaseType_t uxGetBlockQBenchmarkResults( const BlockQBenchmarkResult_t ** ppxResults );
+
+#endif /* BLOCKQ_BENCHMARK_H */
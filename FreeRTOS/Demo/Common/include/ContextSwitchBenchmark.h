@@ -0,0 +1,45 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef CONTEXT_SWITCH_BENCHMARK_H
+#define CONTEXT_SWITCH_BENCHMARK_H
+
+/* The result for one way of switching between two tasks.  Times are in
+ * counts of cswbGET_TIME(), see ContextSwitchBenchmark.c, and are for a single
+ * switch, which is half of each timed round trip. */
+typedef struct ContextSwitchBenchmarkResult
+{
+    const char * pcSwitch;
+    uint32_t ulMinSwitch;
+    uint32_t ulAverageSwitch;
+    uint32_t ulMaxSwitch;
+} ContextSwitchBenchmarkResult_t;
+
+void vStartContextSwitchBenchmark( void );
+BaseType_t xIsContextSwitchBenchmarkComplete( void );
+UBaseType_t uxGetContextSwitchBenchmarkResults( const ContextSwitchBenchmarkResult_t ** ppxResults );
+
+#endif /* CONTEXT_SWITCH_BENCHMARK_H */
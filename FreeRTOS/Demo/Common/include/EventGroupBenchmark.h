@@ -0,0 +1,50 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef EVENT_GROUP_BENCHMARK_H
+#define EVENT_GROUP_BENCHMARK_H
+
+/* The result for one event group implementation and number of waiting
+ * tasks.  Times are in counts of egbGET_TIME(), see EventGroupBenchmark.c. */
+typedef struct EventGroupBenchmarkResult
+{
+    const char * pcGroup;
+    UBaseType_t uxWaiters;
+    uint32_t ulSetCost;          /* Setting a bit one task waits for, while the others wait for another bit. */
+    uint32_t ulBroadcastCost;    /* Setting a bit every waiting task waits for, per task woken. */
+    uint32_t ulAverageISRLatency; /* From setting a bit in an interrupt to the task waiting for it running. */
+    uint32_t ulMaxISRLatency;
+} EventGroupBenchmarkResult_t;
+
+void vStartEventGroupBenchmark( void );
+BaseType_t xIsEventGroupBenchmarkComplete( void );
+UBaseType_t uxGetEventGroupBenchmarkResults( const EventGroupBenchmarkResult_t ** ppxResults );
+
+/* Must be called from the tick hook while the benchmark runs, to set the bit
+ * whose interrupt latency is measured. */
+void vEventGroupBenchmarkTickHook( void );
+
+#endif /* EVENT_GROUP_BENCHMARK_H */
@@ -0,0 +1,149 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+/*
+ * A stackless executor that runs many small handlers from one task, see
+ * Executor.c.  The handler structure is allocated by the application and,
+ * apart from the context, must not be accessed directly.
+ */
+
+#include "stream_buffer.h"
+
+/* Whether handlers can wait with a timeout, which needs TimerWheel.c. */
+#ifndef exeINCLUDE_TIMEOUTS
+    #define exeINCLUDE_TIMEOUTS    1
+#endif
+
+#if ( exeINCLUDE_TIMEOUTS == 1 )
+    #include "TimerWheel.h"
+#endif
+
+/* The event delivered when a wait times out.  The other 31 bits are the
+ * application's. */
+#define exeEVENT_TIMEOUT    ( ( uint32_t ) 0x80000000UL )
+
+struct ExecutorHandler;
+
+/* Called each time the handler runs.  It must not block, and returns from
+ * an exeWAIT(), an exeYIELD() or its exeEND(). */
+typedef void (* ExecutorHandlerFunction_t)( struct ExecutorHandler * pxHandler );
+
+typedef struct ExecutorHandler
+{
+    struct ExecutorHandler * pxNext; /* The next handler ready to run. */
+    ExecutorHandlerFunction_t pxFunction;
+    void * pvContext;
+    uint32_t ulPendingEvents;        /* Signalled and not yet delivered. */
+    uint32_t ulWaitEvents;           /* The events the handler waits for. */
+    uint32_t ulEvents;               /* The events delivered to this run. */
+    uint16_t usResumePoint;          /* Where exeBEGIN() jumps to, 0 for the start. */
+    uint8_t ucState;
+    #if ( exeINCLUDE_TIMEOUTS == 1 )
+        TimerWheelTimer_t xTimeout;
+    #endif
+} ExecutorHandler_t;
+
+/*
+ * The body of a handler function is written between exeBEGIN() and exeEND()
+ * and, as with co-routines, its local variables do not keep their values
+ * across an exeWAIT() or exeYIELD(), so its state belongs in the context.
+ * exeWAIT() and exeYIELD() must be statements of their own, directly in a
+ * block, and not inside a switch statement.
+ */
+#define exeBEGIN( pxHandler )    switch( ( pxHandler )->usResumePoint ) { case 0:
+
+#define exeEND( pxHandler )                \
+    }                                      \
+    vExecutorHandlerFinish( pxHandler );   \
+    return
+
+/* Return until one of ulEventsToWaitFor is signalled, or until xTicksToWait
+ * ticks have passed, after which exeEVENTS() holds the events delivered. */
+#define exeWAIT( pxHandler, ulEventsToWaitFor, xTicksToWait )                        \
+    vExecutorHandlerWait( ( pxHandler ), ( ulEventsToWaitFor ), ( xTicksToWait ) ); \
+    ( pxHandler )->usResumePoint = ( uint16_t ) __LINE__;                            \
+    return;                                                                          \
+    case __LINE__:
+
+/* Return and run again after the handlers that are already ready. */
+#define exeYIELD( pxHandler )                               \
+    vExecutorHandlerWait( ( pxHandler ), 0, 0 );            \
+    ( pxHandler )->usResumePoint = ( uint16_t ) __LINE__;   \
+    return;                                                 \
+    case __LINE__:
+
+#define exeEVENTS( pxHandler )                      ( ( pxHandler )->ulEvents )
+#define pvExecutorHandlerGetContext( pxHandler )    ( ( pxHandler )->pvContext )
+
+/* Create the task that runs the handlers.  Returns pdFAIL if the task, or
+ * the timer wheel that times the waits, could not be created. */
+BaseType_t xExecutorInitialise( UBaseType_t uxPriority,
+                                configSTACK_DEPTH_TYPE uxStackDepth );
+
+/* Start a handler, which runs from the start of its function as soon as the
+ * executor gets to it.  A finished handler can be started again. */
+void vExecutorHandlerStart( ExecutorHandler_t * pxHandler,
+                            ExecutorHandlerFunction_t pxFunction,
+                            void * pvContext );
+
+BaseType_t xExecutorHandlerIsFinished( const ExecutorHandler_t * pxHandler );
+
+/* Signal events to a handler.  Events the handler is not waiting for stay
+ * pending until it waits for them.  Returns pdTRUE if the handler became
+ * ready to run. */
+BaseType_t xExecutorSignal( ExecutorHandler_t * pxHandler,
+                            uint32_t ulEvents );
+
+BaseType_t xExecutorSignalFromISR( ExecutorHandler_t * pxHandler,
+                                   uint32_t ulEvents,
+                                   BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Write to a stream buffer read by a handler, without blocking, and signal
+ * ulEvent to the handler if anything was written.  The handler reads the
+ * stream buffer with a block time of 0. */
+size_t xExecutorStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
+                                  const void * pvTxData,
+                                  size_t xDataLengthBytes,
+                                  ExecutorHandler_t * pxHandler,
+                                  uint32_t ulEvent );
+
+size_t xExecutorStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
+                                         const void * pvTxData,
+                                         size_t xDataLengthBytes,
+                                         ExecutorHandler_t * pxHandler,
+                                         uint32_t ulEvent,
+                                         BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Used by the macros above. */
+void vExecutorHandlerWait( ExecutorHandler_t * pxHandler,
+                           uint32_t ulEventsToWaitFor,
+                           TickType_t xTicksToWait );
+void vExecutorHandlerFinish( ExecutorHandler_t * pxHandler );
+
+#endif /* EXECUTOR_H */
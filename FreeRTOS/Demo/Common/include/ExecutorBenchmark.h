@@ -0,0 +1,47 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef EXECUTOR_BENCHMARK_H
+#define EXECUTOR_BENCHMARK_H
+
+/* The result for one way of running a number of handlers.  Times are in
+ * counts of exbGET_TIME(), see ExecutorBenchmark.c. */
+typedef struct ExecutorBenchmarkResult
+{
+    const char * pcModel;       /* "executor" or "task each". */
+    UBaseType_t uxHandlers;
+    size_t xRAMBytes;           /* Handler structures, task control blocks and stacks. */
+    uint32_t ulMinLatency;      /* From signalling an idle handler to it running. */
+    uint32_t ulAverageLatency;
+    uint32_t ulMaxLatency;
+    uint32_t ulBurstCost;       /* Per handler, when every handler is signalled at once. */
+} ExecutorBenchmarkResult_t;
+
+void vStartExecutorBenchmark( void );
+BaseType_t xIsExecutorBenchmarkComplete( void );
+UBaseType_t uxGetExecutorBenchmarkResults( const ExecutorBenchmarkResult_t ** ppxResults );
+
+#endif /* EXECUTOR_BENCHMARK_H */
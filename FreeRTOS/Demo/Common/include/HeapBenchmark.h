@@ -0,0 +1,78 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef HEAP_BENCHMARK_H
+#define HEAP_BENCHMARK_H
+
+/* The number of times the heap is sampled during a trace. */
+#ifndef heapbSAMPLES
+    #define heapbSAMPLES              ( 16 )
+#endif
+
+/* Allocation latencies are counted in a bucket per power of two. */
+#define heapbHISTOGRAM_BUCKETS        ( 24 )
+
+/* The state of the heap at one point of a trace.  Only xLiveBytes is
+ * measured when heapbUSE_HEAP_STATS is 0. */
+typedef struct HeapBenchmarkSample
+{
+    size_t xLiveBytes;        /* Bytes the trace had allocated. */
+    size_t xFreeBytes;        /* Bytes the heap had free. */
+    size_t xLargestFreeBlock; /* The largest block that could have been allocated. */
+    size_t xFreeBlocks;       /* The number of free blocks, which grows with fragmentation. */
+} HeapBenchmarkSample_t;
+
+/* The result of replaying one trace, see HeapBenchmark.c.  Times are in
+ * counts of heapbGET_TIME().  The percentiles are the upper bounds of the
+ * histogram buckets they fall in. */
+typedef struct HeapBenchmarkResult
+{
+    const char * pcTrace;
+    uint32_t ulSteps;
+    uint32_t ulAllocations;
+    uint32_t ulFailures;
+    uint32_t ulMinLatency;
+    uint32_t ulAverageLatency;
+    uint32_t ulLatencyP50;
+    uint32_t ulLatencyP99;
+    uint32_t ulMaxLatency;
+    uint32_t ulAverageFreeCost;
+    uint64_t ullTotalLatency;
+    uint32_t ulLatencyHistogram[ heapbHISTOGRAM_BUCKETS ]; /* Bucket n holds latencies below 2^n. */
+    size_t xPeakBytes;
+    size_t xMinLargestFreeBlock;
+    size_t xMaxFreeBlocks;
+    HeapBenchmarkSample_t xBefore;                         /* Before the trace started. */
+    HeapBenchmarkSample_t xSamples[ heapbSAMPLES ];        /* Evenly spaced over the trace. */
+    HeapBenchmarkSample_t xAfter;                          /* After every block was freed again. */
+} HeapBenchmarkResult_t;
+
+void vStartHeapBenchmark( void );
+BaseType_t xIsHeapBenchmarkComplete( void );
+BaseType_t xIsHeapBenchmarkAllocating( void );
+UBaseType_t uxGetHeapBenchmarkResults( const HeapBenchmarkResult_t ** ppxResults );
+
+#endif /* HEAP_BENCHMARK_H */
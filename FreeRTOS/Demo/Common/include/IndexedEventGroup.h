@@ -0,0 +1,81 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef INDEXED_EVENT_GROUP_H
+#define INDEXED_EVENT_GROUP_H
+
+/*
+ * An event group that keeps a list of waiting tasks per bit, so setting bits
+ * only visits the tasks waiting for those bits, see IndexedEventGroup.c.
+ * The group structure is allocated by the application and must not be
+ * accessed directly.
+ */
+
+/* The number of bits, from bit 0, that tasks can wait for. */
+#ifndef iegBITS
+    #define iegBITS    ( 8 )
+#endif
+
+typedef struct IndexedEventGroupLink
+{
+    struct IndexedEventGroupLink * pxNext;
+    struct IndexedEventGroupLink * pxPrevious;
+    void * pvWaiter;
+} IndexedEventGroupLink_t;
+
+typedef struct IndexedEventGroup
+{
+    EventBits_t uxBits;
+    IndexedEventGroupLink_t xWaiters[ iegBITS ]; /* The head of the list of each bit. */
+} IndexedEventGroup_t;
+
+void vIndexedEventGroupInitialise( IndexedEventGroup_t * pxGroup );
+
+/* As xEventGroupWaitBits(), for bits 0 to iegBITS - 1. */
+EventBits_t xIndexedEventGroupWaitBits( IndexedEventGroup_t * pxGroup,
+                                        const EventBits_t uxBitsToWaitFor,
+                                        const BaseType_t xClearOnExit,
+                                        const BaseType_t xWaitForAllBits,
+                                        TickType_t xTicksToWait );
+
+/* As xEventGroupSetBits(). */
+EventBits_t xIndexedEventGroupSetBits( IndexedEventGroup_t * pxGroup,
+                                       const EventBits_t uxBitsToSet );
+
+/* Unlike xEventGroupSetBitsFromISR() the waiting tasks are woken in the
+ * interrupt, without a message to the timer service task.  Returns the bits
+ * after the waiting tasks have been woken. */
+EventBits_t xIndexedEventGroupSetBitsFromISR( IndexedEventGroup_t * pxGroup,
+                                              const EventBits_t uxBitsToSet,
+                                              BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Returns the bits before they were cleared. */
+EventBits_t xIndexedEventGroupClearBits( IndexedEventGroup_t * pxGroup,
+                                         const EventBits_t uxBitsToClear );
+
+EventBits_t xIndexedEventGroupGetBits( IndexedEventGroup_t * pxGroup );
+
+#endif /* INDEXED_EVENT_GROUP_H */
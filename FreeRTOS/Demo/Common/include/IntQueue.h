@@ -32,4 +32,47 @@ BaseType_t xAreIntQueueTasksStillRunning( void );
 BaseType_t xFirstTimerHandler( void );
 BaseType_t xSecondTimerHandler( void );
 
+/* Set intqLATENCY_TEST to 1 to also measure how long it takes a task to run
+ * after the first timer interrupt sends to a queue or gives a semaphore.
+ * intqLATENCY_GET_COUNT() must then return a free running counter, and defaults
+ * to the counter used by the run time stats. */
+#ifndef intqLATENCY_TEST
+    #define intqLATENCY_TEST    0
+#endif
+
+#if ( intqLATENCY_TEST == 1 )
+
+/* Latencies are counted by their number of significant bits, so bin n holds
+ * latencies from 2^(n-1) up to (2^n)-1 counts, whatever the frequency of the
+ * counter.  The last bin also holds all longer latencies. */
+    #ifndef intqLATENCY_HISTOGRAM_BINS
+        #define intqLATENCY_HISTOGRAM_BINS    16
+    #endif
+
+/* All times are in counts of intqLATENCY_GET_COUNT(). */
+    typedef struct IntQueueLatencyStats
+    {
+        uint32_t ulSamples;
+        uint32_t ulMin;
+        uint32_t ulAverage;
+        uint32_t ulMax;
+        uint32_t ulHistogram[ intqLATENCY_HISTOGRAM_BINS ];
+    } IntQueueLatencyStats_t;
+
+/* Each path is measured from the entry to xFirstTimerHandler() to the
+ * FromISR call, from the FromISR call to the woken task running, and from end
+ * to end. */
+    typedef struct IntQueueLatency
+    {
+        IntQueueLatencyStats_t xQueueEntryToSend;
+        IntQueueLatencyStats_t xQueueSendToWake;
+        IntQueueLatencyStats_t xQueueEntryToWake;
+        IntQueueLatencyStats_t xSemaphoreEntryToGive;
+        IntQueueLatencyStats_t xSemaphoreGiveToWake;
+        IntQueueLatencyStats_t xSemaphoreEntryToWake;
+    } IntQueueLatency_t;
+
+    void vGetIntQueueLatency( IntQueueLatency_t * pxLatency );
+#endif /* intqLATENCY_TEST */
+
 #endif /* QUEUE_ACCESS_TEST */
@@ -0,0 +1,99 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef LOW_POWER_BENCHMARK_H
+#define LOW_POWER_BENCHMARK_H
+
+/*
+ * Measures the tickless idle implementation of a low power demo, see
+ * LowPowerBenchmark.c.  The low power tick management of the demo reports
+ * each sleep through the lpbSLEEP_ENTER(), lpbSLEEP_EXIT() and
+ * lpbTICKS_SLEPT() macros, which do nothing unless
+ * configUSE_LOW_POWER_BENCHMARK is 1.
+ */
+
+#ifndef configUSE_LOW_POWER_BENCHMARK
+    #define configUSE_LOW_POWER_BENCHMARK    0
+#endif
+
+/* The number of sleep depths recorded separately.  Each demo numbers its own
+ * depths from 0, the lightest. */
+#ifndef lpbSLEEP_DEPTHS
+    #define lpbSLEEP_DEPTHS    ( 8 )
+#endif
+
+#if ( configUSE_LOW_POWER_BENCHMARK == 1 )
+
+/* Called with interrupts disabled, immediately before the instruction that
+ * enters the sleep depth, immediately after it, and with the number of whole
+ * tick periods the sleep lasted. */
+    void vLowPowerBenchmarkSleepEnter( UBaseType_t uxDepth );
+    void vLowPowerBenchmarkSleepExit( void );
+    void vLowPowerBenchmarkTicksSlept( TickType_t xTicks );
+
+    #define lpbSLEEP_ENTER( uxDepth )    vLowPowerBenchmarkSleepEnter( uxDepth )
+    #define lpbSLEEP_EXIT()              vLowPowerBenchmarkSleepExit()
+    #define lpbTICKS_SLEPT( xTicks )     vLowPowerBenchmarkTicksSlept( xTicks )
+
+#else
+
+    #define lpbSLEEP_ENTER( uxDepth )
+    #define lpbSLEEP_EXIT()
+    #define lpbTICKS_SLEPT( xTicks )
+
+#endif /* configUSE_LOW_POWER_BENCHMARK */
+
+/* The figures for one sleep depth.  Latencies are in counts of lpbGET_TIME(),
+ * which are CPU cycles by default. */
+typedef struct LowPowerBenchmarkDepth
+{
+    uint32_t ulSleeps;            /* Times the depth was entered, during the whole benchmark. */
+    uint32_t ulWakeUpsTimed;      /* Wake ups whose latency was measured. */
+    uint32_t ulAverageWakeLatency; /* From leaving the depth to the woken task running. */
+    uint32_t ulMaxWakeLatency;
+    uint32_t ulLoadTicksAsleep;   /* Tick periods spent in the depth under the event load. */
+} LowPowerBenchmarkDepth_t;
+
+typedef struct LowPowerBenchmarkResults
+{
+    LowPowerBenchmarkDepth_t xDepths[ lpbSLEEP_DEPTHS ];
+    TickType_t xLoadTicks;        /* The length of the event load. */
+    uint32_t ulLowPowerPercent;   /* Of xLoadTicks spent asleep. */
+    uint32_t ulDriftSleeps;       /* Long sleeps measured against the reference clock. */
+    int32_t lTotalDriftMs;        /* Tick time minus reference time over those sleeps. */
+    int32_t lMaxDriftMs;          /* The largest drift over one of them. */
+    BaseType_t xComplete;
+} LowPowerBenchmarkResults_t;
+
+/* Create the benchmark task, which should be the only task the demo runs so
+ * that every sleep is caused by the benchmark. */
+void vStartLowPowerBenchmark( UBaseType_t uxPriority );
+
+/* The results, which are complete once xComplete is pdTRUE.  The demos do not
+ * print them, so view them in the debugger. */
+const LowPowerBenchmarkResults_t * pxGetLowPowerBenchmarkResults( void );
+
+#endif /* LOW_POWER_BENCHMARK_H */
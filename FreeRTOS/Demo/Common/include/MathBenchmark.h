@@ -0,0 +1,47 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef MATH_BENCHMARK_H
+#define MATH_BENCHMARK_H
+
+/* The result for one kernel, see MathBenchmark.c.  Rates are in thousands of
+ * multiplies and adds per second, which is kFLOPS for the float kernels. */
+typedef struct MathBenchmarkResult
+{
+    const char * pcKernel;
+    BaseType_t xUsesVectorRegisters; /* pdFALSE when the kernel only uses core registers. */
+    uint32_t ulSingleKOps;           /* Run by one task. */
+    uint32_t ulSharedKOps;           /* Run by mathbTASKS tasks time sliced on the tick. */
+    uint32_t ulYieldKOps;            /* Run by mathbTASKS tasks that yield after every call. */
+    uint32_t ulSwitchNs;             /* The extra time a call takes when it ends in a context switch. */
+    BaseType_t xResultsMatched;      /* pdFALSE if a task got a different result, which suggests a corrupted context. */
+} MathBenchmarkResult_t;
+
+void vStartMathBenchmark( void );
+BaseType_t xIsMathBenchmarkComplete( void );
+UBaseType_t uxGetMathBenchmarkResults( const MathBenchmarkResult_t ** ppxResults );
+
+#endif /* MATH_BENCHMARK_H */
@@ -0,0 +1,81 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef MUTEX_PROFILER_H
+#define MUTEX_PROFILER_H
+
+/*
+ * Mutex contention profiling, see MutexProfiler.c.  Set
+ * configUSE_MUTEX_PROFILER to 1 and include this header at the end of
+ * FreeRTOSConfig.h, so the kernel trace macros below are defined when the
+ * kernel is built.  The trace macros are not available to anything else, so
+ * the profiler cannot be used with a trace recorder.
+ *
+ * This header is included from FreeRTOSConfig.h, before the FreeRTOS types
+ * are defined, so it only uses the standard integer types.
+ */
+
+/* The counters of one mutex.  Times are in counts of mprofGET_TIME(). */
+typedef struct MutexProfile
+{
+    void * pvMutex;
+    uint32_t ulAcquires;     /* Successful takes, counting a recursive take only when it is the outermost. */
+    uint32_t ulContended;    /* Takes that had to block because another task held the mutex. */
+    uint32_t ulTimeouts;     /* Takes that failed. */
+    uint32_t ulInheritances; /* Times a holder inherited the priority of a task waiting for the mutex. */
+    uint64_t ullWaitTime;    /* Total time spent blocked by contended takes. */
+    uint64_t ullMaxWait;
+    uint64_t ullHoldTime;    /* Total time from a take to the matching give. */
+    uint64_t ullMaxHold;
+} MutexProfile_t;
+
+/* Copy the profiles of at most ulMaxProfiles mutexes into pxProfiles, most
+ * contended first, and return the number copied. */
+uint32_t ulMutexProfilerGetTop( MutexProfile_t * pxProfiles,
+                                uint32_t ulMaxProfiles );
+
+/* Zero the counters of every mutex. */
+void vMutexProfilerReset( void );
+
+/* Called by the trace macros below. */
+void vMutexProfilerCreated( void * pvMutex );
+void vMutexProfilerDeleted( void * pvMutex );
+void vMutexProfilerBlocking( void * pvMutex );
+void vMutexProfilerTaken( void * pvMutex );
+void vMutexProfilerTakeFailed( void * pvMutex );
+void vMutexProfilerGiven( void * pvMutex );
+void vMutexProfilerInherited( void );
+
+#define traceCREATE_MUTEX( pxNewQueue )                                          vMutexProfilerCreated( ( void * ) ( pxNewQueue ) )
+#define traceQUEUE_DELETE( pxQueue )                                             vMutexProfilerDeleted( ( void * ) ( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )                                vMutexProfilerBlocking( ( void * ) ( pxQueue ) )
+#define traceQUEUE_RECEIVE( pxQueue )                                            vMutexProfilerTaken( ( void * ) ( pxQueue ) )
+#define traceQUEUE_SEMAPHORE_RECEIVE( pxQueue )                                  vMutexProfilerTaken( ( void * ) ( pxQueue ) )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )                                     vMutexProfilerTakeFailed( ( void * ) ( pxQueue ) )
+#define traceQUEUE_SEND( pxQueue )                                               vMutexProfilerGiven( ( void * ) ( pxQueue ) )
+#define traceTASK_PRIORITY_INHERIT( pxTCBOfMutexHolder, uxInheritedPriority )    vMutexProfilerInherited()
+
+#endif /* MUTEX_PROFILER_H */
@@ -0,0 +1,55 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef QUEUE_BULK_H
+#define QUEUE_BULK_H
+
+/*
+ * Send and receive several items of a queue in one call, see QueueBulk.c.
+ * The queues are ordinary kernel queues, which can also be used with the
+ * single item functions at the same time.
+ */
+
+/* Send up to uxItemCount items from the array pvItems to the back of the
+ * queue, waiting up to xTicksToWait in total for space.  A task waiting to
+ * receive is readied once for all the items that fit at the time, instead of
+ * once per item.  Returns the number of items sent, which is less than
+ * uxItemCount if the wait timed out. */
+UBaseType_t uxQueueSendMultiple( QueueHandle_t xQueue,
+                                 const void * pvItems,
+                                 UBaseType_t uxItemCount,
+                                 TickType_t xTicksToWait );
+
+/* Wait up to xTicksToWait for the queue to hold an item, then receive it and
+ * up to uxMaxItems - 1 more that are already in the queue into the array
+ * pvBuffer.  A task waiting to send is readied once for all of them.  Returns
+ * the number of items received, 0 if the wait timed out. */
+UBaseType_t uxQueueReceiveMultiple( QueueHandle_t xQueue,
+                                    void * pvBuffer,
+                                    UBaseType_t uxMaxItems,
+                                    TickType_t xTicksToWait );
+
+#endif /* QUEUE_BULK_H */
@@ -0,0 +1,51 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef QUEUE_SET_BENCHMARK_H
+#define QUEUE_SET_BENCHMARK_H
+
+/* The result for one queue set implementation, number of members and number
+ * of events pending when the receiver runs.  Costs are in counts of
+ * qsbGET_TIME() per event, see QueueSetBenchmark.c. */
+typedef struct QueueSetBenchmarkResult
+{
+    const char * pcSet;
+    UBaseType_t uxMembers;
+    UBaseType_t uxBurst;
+    uint32_t ulSendCost;    /* Sending an event to a member. */
+    uint32_t ulReceiveCost; /* Selecting a member, receiving from it and finding its data. */
+    uint32_t ulWakeCost;    /* From an interrupt sending to an empty set to the receiver getting the event. */
+} QueueSetBenchmarkResult_t;
+
+void vStartQueueSetBenchmark( void );
+BaseType_t xIsQueueSetBenchmarkComplete( void );
+UBaseType_t uxGetQueueSetBenchmarkResults( const QueueSetBenchmarkResult_t ** ppxResults );
+
+/* Must be called from the tick hook while the benchmark runs, to send the
+ * events whose wake up cost is measured. */
+void vQueueSetBenchmarkTickHook( void );
+
+#endif /* QUEUE_SET_BENCHMARK_H */
@@ -0,0 +1,89 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef READY_QUEUE_SET_H
+#define READY_QUEUE_SET_H
+
+/*
+ * A queue set that keeps a list of its members that hold data, for a task
+ * that blocks on many queues and semaphores at once, see ReadyQueueSet.c.
+ * The set and member structures are allocated by the application and must
+ * not be accessed directly.
+ */
+
+struct ReadyQueueSet;
+
+typedef struct ReadyQueueSetMember
+{
+    struct ReadyQueueSetMember * pxNext;
+    struct ReadyQueueSet * pxSet;
+    QueueHandle_t xQueue;
+    BaseType_t xListed; /* pdTRUE while the member is in the ready list. */
+    void * pvMemberID;
+} ReadyQueueSetMember_t;
+
+typedef struct ReadyQueueSet
+{
+    ReadyQueueSetMember_t * pxHead;
+    ReadyQueueSetMember_t * pxTail;
+    TaskHandle_t xWaitingTask;
+} ReadyQueueSet_t;
+
+void vReadyQueueSetInitialise( ReadyQueueSet_t * pxSet );
+
+/* Add a queue or semaphore to the set.  A queue may only be in one set, and
+ * once added must only be written with xReadyQueueSetSend() or
+ * xReadyQueueSetSendFromISR(), and only read by the task receiving from the
+ * set. */
+void vReadyQueueSetAddMember( ReadyQueueSet_t * pxSet,
+                              ReadyQueueSetMember_t * pxMember,
+                              QueueHandle_t xQueue,
+                              void * pvMemberID );
+
+/* Take the member out of the set, after which its queue can be deleted. */
+void vReadyQueueSetRemoveMember( ReadyQueueSetMember_t * pxMember );
+
+/* Send to the back of the member's queue, or give it if it is a semaphore,
+ * in which case pvItem is NULL. */
+BaseType_t xReadyQueueSetSend( ReadyQueueSetMember_t * pxMember,
+                               const void * pvItem,
+                               TickType_t xTicksToWait );
+
+BaseType_t xReadyQueueSetSendFromISR( ReadyQueueSetMember_t * pxMember,
+                                      const void * pvItem,
+                                      BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Wait up to xTicksToWait for any member to hold data, and receive one item
+ * from it into pvBuffer, which must be large enough for the items of every
+ * member.  Returns the member, or NULL if the wait timed out.  Only one task
+ * may receive from a set. */
+ReadyQueueSetMember_t * pxReadyQueueSetReceive( ReadyQueueSet_t * pxSet,
+                                                void * pvBuffer,
+                                                TickType_t xTicksToWait );
+
+#define pvReadyQueueSetMemberGetID( pxMember )    ( ( pxMember )->pvMemberID )
+
+#endif /* READY_QUEUE_SET_H */
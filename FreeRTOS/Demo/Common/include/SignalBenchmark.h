@@ -0,0 +1,45 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef SIGNAL_BENCHMARK_H
+#define SIGNAL_BENCHMARK_H
+
+/* The result for one signalling primitive.  Times are in counts of
+ * sigbGET_TIME(), see SignalBenchmark.c. */
+typedef struct SignalBenchmarkResult
+{
+    const char * pcPrimitive;
+    uint32_t ulMinRoundTrip;     /* A task signals another and waits to be signalled back. */
+    uint32_t ulAverageRoundTrip;
+    uint32_t ulMaxRoundTrip;
+    uint32_t ulAverageCost;      /* A task signals itself and takes the signal, without blocking. */
+} SignalBenchmarkResult_t;
+
+void vStartSignalBenchmark( void );
+BaseType_t xIsSignalBenchmarkComplete( void );
+UBaseType_t uxGetSignalBenchmarkResults( const SignalBenchmarkResult_t ** ppxResults );
+
+#endif /* SIGNAL_BENCHMARK_H */
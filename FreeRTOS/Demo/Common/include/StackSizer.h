@@ -0,0 +1,120 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef STACK_SIZER_H
+#define STACK_SIZER_H
+
+/*
+ * Stack and heap right-sizing, see StackSizer.c.  Set configUSE_STACK_SIZER
+ * to 1 and include this header at the end of FreeRTOSConfig.h, so the kernel
+ * trace macro below is defined when the kernel is built.  The trace macro is
+ * not available to anything else, so the sizer cannot be used with a trace
+ * recorder.
+ *
+ * This header is included from FreeRTOSConfig.h, before the FreeRTOS types
+ * are defined, so it only uses the standard integer types.
+ */
+
+#if ( configRECORD_STACK_HIGH_ADDRESS != 1 )
+    #error The stack sizer needs configRECORD_STACK_HIGH_ADDRESS set to 1 to learn the stack depth of each task.
+#endif
+
+/* The margin added to the most stack or heap used to recommend a size, as a
+ * percentage, unless another is given. */
+#ifndef stkszMARGIN_PERCENT
+    #define stkszMARGIN_PERCENT    25
+#endif
+
+/* The most tasks that are recorded, including the deleted ones.  This is
+ * also the most tasks that can exist at once for a sample to be taken. */
+#ifndef stkszMAX_TASKS
+    #define stkszMAX_TASKS    32
+#endif
+
+/* Set stkszINCLUDE_HEAP to 0 for a heap that does not provide
+ * xPortGetMinimumEverFreeHeapSize(), such as heap_3.c. */
+#ifndef stkszINCLUDE_HEAP
+    #define stkszINCLUDE_HEAP    1
+#endif
+
+/* The stack of one task, or of the tasks created one after another with the
+ * same name and depth.  Depths are in words, as passed to xTaskCreate(). */
+typedef struct StackSizerTask
+{
+    void * pvTask;          /* The task handle, NULL once the task has been deleted. */
+    char cName[ configMAX_TASK_NAME_LEN ];
+    uint32_t ulDepth;
+    uint32_t ulMinimumFree; /* The lowest stack high water mark sampled. */
+    uint32_t ulSamples;     /* Samples taken, the depth used is unknown while 0. */
+} StackSizerTask_t;
+
+/* Start a task that samples the stack of every task each ulPeriodMs
+ * milliseconds, so tasks that are deleted during a soak are measured too. */
+void vStartStackSizer( uint32_t ulPeriodMs );
+
+/* Sample the stack high water mark of every task now. */
+void vStackSizerSample( void );
+
+/* Sample every task, then copy the stacks of at most ulMaxTasks tasks into
+ * pxTasks in the order they were created, and return the number copied. */
+uint32_t ulStackSizerGetTasks( StackSizerTask_t * pxTasks,
+                               uint32_t ulMaxTasks );
+
+/* The number of tasks created while the table of stacks was full. */
+uint32_t ulStackSizerGetUntracked( void );
+
+/* The stack depth to create pxTask's task with: the most it used, plus
+ * ulMarginPercent percent, rounded up to stkszDEPTH_ALIGNMENT words.  Returns
+ * 0 if the task was never sampled. */
+uint32_t ulStackSizerRecommendedDepth( const StackSizerTask_t * pxTask,
+                                       uint32_t ulMarginPercent );
+
+#if ( stkszINCLUDE_HEAP == 1 )
+
+/* The configured heap size, in bytes. */
+    uint32_t ulStackSizerHeapSize( void );
+
+/* The least the heap has had free, in bytes. */
+    uint32_t ulStackSizerHeapMinimumEverFree( void );
+
+/* The heap size to configure: the most that was allocated, plus
+ * ulMarginPercent percent, rounded up to portBYTE_ALIGNMENT. */
+    uint32_t ulStackSizerRecommendedHeapSize( uint32_t ulMarginPercent );
+#endif
+
+/* Called by the trace macro below. */
+void vStackSizerTaskCreated( void * pvTask,
+                             const char * pcName,
+                             uint32_t ulDepth );
+
+/* pxEndOfStack is the highest usable word of the stack whichever way it
+ * grows, so this is the depth the task was created with, less any words
+ * lost to aligning the top of a stack that grows down. */
+#define traceTASK_CREATE( pxNewTCB )                                                  \
+    vStackSizerTaskCreated( ( void * ) ( pxNewTCB ), ( pxNewTCB )->pcTaskName,        \
+                            ( uint32_t ) ( ( pxNewTCB )->pxEndOfStack - ( pxNewTCB )->pxStack ) + 1UL )
+
+#endif /* STACK_SIZER_H */
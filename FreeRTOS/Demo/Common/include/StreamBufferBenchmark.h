@@ -0,0 +1,47 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef STREAM_BUFFER_BENCHMARK_H
+#define STREAM_BUFFER_BENCHMARK_H
+
+/* The result of one combination of the sweep.  xTriggerLevel is 0 for message
+ * buffers, which always unblock a reader on a whole message. */
+typedef struct StreamBufferBenchmarkResult
+{
+    const char * pcMode;      /* Which buffer type, and whether a task or an interrupt writes it. */
+    size_t xBufferSize;       /* Buffer length in bytes. */
+    size_t xTriggerLevel;     /* Stream buffer trigger level in bytes. */
+    size_t xChunkSize;        /* Bytes per write, or per message. */
+    uint32_t ulBytesPerSecond;
+    uint32_t ulWakeUpsPerMB;  /* Times the reader blocked and was woken per 2^20 bytes. */
+} StreamBufferBenchmarkResult_t;
+
+void vStartStreamBufferBenchmark( void );
+void vStreamBufferBenchmarkFromISR( void );
+BaseType_t xIsStreamBufferBenchmarkComplete( void );
+UBaseType_t uxGetStreamBufferBenchmarkResults( const StreamBufferBenchmarkResult_t ** ppxResults );
+
+#endif /* STREAM_BUFFER_BENCHMARK_H */
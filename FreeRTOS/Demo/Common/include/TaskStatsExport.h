@@ -0,0 +1,60 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TASK_STATS_EXPORT_H
+#define TASK_STATS_EXPORT_H
+
+/*
+ * Compact binary task statistics, see TaskStatsExport.c.  A sample is one
+ * CBOR (RFC 8949) array:
+ *
+ *     [ version, deltas, run time, [ task, ... ] ]
+ *
+ * where version is tsexpFORMAT_VERSION, deltas is true when run times are
+ * since the previous sample rather than since the task was created, and run
+ * time is the total run time counter (or its increase).  Each task is:
+ *
+ *     [ task number, name, state, priority, base priority,
+ *       stack high water mark, run time ]
+ *
+ * The task number is the one returned by uxTaskGetTaskNumber(), which is
+ * unique to each task created.  In a delta sample the name is null for tasks
+ * that were in the previous sample, as the receiver already knows it.  The
+ * state is an eTaskState value.
+ */
+
+#define tsexpFORMAT_VERSION    1
+
+/* Encodes a sample of every task into pucBuffer, with run times since the
+ * previous sample if xDeltas is pdTRUE.  Returns the number of bytes written,
+ * or 0 if pucBuffer is too small or there are more tasks than
+ * tsexpMAX_TASKS, in which case the previous sample is kept.  Must only be
+ * called by one task at a time. */
+size_t xTaskStatsExportSample( uint8_t * pucBuffer,
+                               size_t xBufferLength,
+                               BaseType_t xDeltas );
+
+#endif /* TASK_STATS_EXPORT_H */
@@ -0,0 +1,50 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TIMER_BENCHMARK_H
+#define TIMER_BENCHMARK_H
+
+/* The result for one timer backend and number of running timers.  Times are
+ * in counts of tmbGET_TIME(), see TimerBenchmark.c. */
+typedef struct TimerBenchmarkResult
+{
+    const char * pcBackend;
+    UBaseType_t uxTimers;
+    uint32_t ulAverageResetCost;  /* Resetting one timer while all the others are running. */
+    uint32_t ulAverageLateness;   /* From the tick a timer expires on to its callback running. */
+    uint32_t ulMaxLateness;
+    UBaseType_t uxMissedExpiries; /* Timers whose callback did not run in time to be measured. */
+} TimerBenchmarkResult_t;
+
+void vStartTimerBenchmark( void );
+BaseType_t xIsTimerBenchmarkComplete( void );
+UBaseType_t uxGetTimerBenchmarkResults( const TimerBenchmarkResult_t ** ppxResults );
+
+/* Must be called from the tick hook while the benchmark runs, to record the
+ * time of each tick. */
+void vTimerBenchmarkTickHook( void );
+
+#endif /* TIMER_BENCHMARK_H */
@@ -0,0 +1,80 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+/*
+ * A hashed timer wheel for applications with many timeouts, see
+ * TimerWheel.c.  The timer structure is allocated by the application and
+ * must not be accessed directly.
+ */
+
+struct TimerWheelTimer;
+
+typedef void (* TimerWheelCallback_t)( struct TimerWheelTimer * pxTimer );
+
+typedef struct TimerWheelLink
+{
+    struct TimerWheelLink * pxNext;
+    struct TimerWheelLink * pxPrevious;
+} TimerWheelLink_t;
+
+typedef struct TimerWheelTimer
+{
+    TimerWheelLink_t xLink; /* Must be first, see TimerWheel.c. */
+    TickType_t xExpiryTime;
+    TickType_t xPeriod;
+    BaseType_t xAutoReload;
+    TimerWheelCallback_t pxCallback;
+    void * pvTimerID;
+} TimerWheelTimer_t;
+
+/* Create the task that runs the callbacks.  Returns pdFAIL if the task could
+ * not be created. */
+BaseType_t xTimerWheelInitialise( UBaseType_t uxPriority,
+                                  configSTACK_DEPTH_TYPE uxStackDepth );
+
+void vTimerWheelTimerInitialise( TimerWheelTimer_t * pxTimer,
+                                 TimerWheelCallback_t pxCallback,
+                                 void * pvTimerID );
+
+/* Start the timer to expire xPeriod ticks from now, or restart it if it is
+ * already running, which is how a timer is reset.  Only call from tasks. */
+void vTimerWheelTimerStart( TimerWheelTimer_t * pxTimer,
+                            TickType_t xPeriod,
+                            BaseType_t xAutoReload );
+
+void vTimerWheelTimerStop( TimerWheelTimer_t * pxTimer );
+
+BaseType_t xTimerWheelTimerIsActive( const TimerWheelTimer_t * pxTimer );
+
+/* The tick on which the timer next expires, if it is active. */
+TickType_t xTimerWheelTimerGetExpiryTime( const TimerWheelTimer_t * pxTimer );
+
+#define pvTimerWheelTimerGetID( pxTimer )    ( ( pxTimer )->pvTimerID )
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,48 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+#ifndef COMTEST_THROUGHPUT_H
+#define COMTEST_THROUGHPUT_H
+
+/* ulCPULoadPercent when the run time stats needed to measure it are not
+ * available. */
+#define comtpCPU_LOAD_UNKNOWN    ( ( uint32_t ) 0xffffffffUL )
+
+/* The figures of the last complete measurement period. */
+typedef struct ComThroughputResult
+{
+    uint32_t ulBytesPerSecond;  /* Bytes received intact per second. */
+    uint32_t ulCPULoadPercent;  /* Time not spent in the idle task. */
+    uint32_t ulErrors;          /* Bytes received out of sequence since the start. */
+} ComThroughputResult_t;
+
+void vStartComThroughputTest( UBaseType_t uxPriority,
+                              uint32_t ulBaudRate );
+void vGetComThroughputResult( ComThroughputResult_t * pxResult );
+BaseType_t xIsComThroughputTestStillRunning( void );
+
+#endif /* COMTEST_THROUGHPUT_H */
@@ -103,6 +103,20 @@ signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort,
                                      signed char cOutChar,
                                      TickType_t xBlockTime );
 portBASE_TYPE xSerialWaitForSemaphore( xComPortHandle xPort );
+
+/* Buffer level access.  xSerialWrite() queues up to xDataLength bytes for
+ * transmission and xSerialRead() returns up to xBufferLength bytes as soon as
+ * any are available.  Both block for at most xBlockTime and return the number
+ * of bytes actually written or read.  Only ports built on serial_stream.c, or
+ * that otherwise implement them, provide these functions. */
+size_t xSerialWrite( xComPortHandle pxPort,
+                     const void * pvTxData,
+                     size_t xDataLength,
+                     TickType_t xBlockTime );
+size_t xSerialRead( xComPortHandle pxPort,
+                    void * pvRxData,
+                    size_t xBufferLength,
+                    TickType_t xBlockTime );
 void vSerialClose( xComPortHandle xPort );
 
 #endif /* ifndef SERIAL_COMMS_H */
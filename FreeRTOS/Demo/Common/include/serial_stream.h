@@ -0,0 +1,98 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+#ifndef SERIAL_STREAM_H
+#define SERIAL_STREAM_H
+
+/*
+ * The hardware independent half of a serial port driver that moves blocks of
+ * bytes rather than single characters, see serial_stream.c.  A port's
+ * serial.c allocates a SerialStreamPort_t, calls xSerialStreamInit() from its
+ * xSerialPortInitMinimal() or xSerialPortInit(), returns the address of the
+ * SerialStreamPort_t as the xComPortHandle, and implements
+ * vSerialStreamPortStartTx().  Its interrupt handlers then call
+ * vSerialStreamTxCompleteFromISR() and vSerialStreamRxDMAFromISR() or
+ * vSerialStreamRxFromISR().
+ */
+
+#include "stream_buffer.h"
+
+typedef struct SerialStreamPort
+{
+    StreamBufferHandle_t xTxStream;  /* Bytes written by xSerialWrite() that are not yet being sent. */
+    StreamBufferHandle_t xRxStream;  /* Bytes received that are not yet read by xSerialRead(). */
+    uint8_t * pucTxDMABuffer;        /* Bytes being sent.  Must be accessible by the DMA. */
+    size_t xTxDMALength;
+    const uint8_t * pucRxDMABuffer;  /* The circular receive DMA buffer, or NULL. */
+    size_t xRxDMALength;
+    size_t xRxDMAPosition;           /* The next byte of pucRxDMABuffer to copy to xRxStream. */
+    volatile BaseType_t xTxActive;   /* pdTRUE from starting a transfer until it completes. */
+    volatile uint32_t ulRxOverruns;  /* Received bytes dropped because xRxStream was full. */
+    void * pvPortData;               /* For the port's own use, such as its UART. */
+} SerialStreamPort_t;
+
+/* Creates the stream buffers of pxPort.  pucTxDMABuffer is where transfers
+ * are started from.  pucRxDMABuffer is the buffer the receive DMA writes in
+ * circular mode, or NULL if the port passes received bytes to
+ * vSerialStreamRxFromISR() instead.  Returns pdFAIL if the stream buffers
+ * cannot be allocated. */
+BaseType_t xSerialStreamInit( SerialStreamPort_t * pxPort,
+                              size_t xTxStreamLength,
+                              size_t xRxStreamLength,
+                              uint8_t * pucTxDMABuffer,
+                              size_t xTxDMALength,
+                              const uint8_t * pucRxDMABuffer,
+                              size_t xRxDMALength );
+
+/* Implemented by the port.  Starts sending xLength bytes from pucData, which
+ * is always pxPort->pucTxDMABuffer, and calls vSerialStreamTxCompleteFromISR()
+ * once they have all gone.  Called from tasks and from
+ * vSerialStreamTxCompleteFromISR(). */
+void vSerialStreamPortStartTx( SerialStreamPort_t * pxPort,
+                               const uint8_t * pucData,
+                               size_t xLength );
+
+/* Called by the port when the transfer started by vSerialStreamPortStartTx()
+ * completes.  Starts the next transfer if more bytes are waiting. */
+void vSerialStreamTxCompleteFromISR( SerialStreamPort_t * pxPort,
+                                     BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Called by the port from its receive DMA half transfer, transfer complete
+ * and idle line interrupts, with the index in pucRxDMABuffer of the next byte
+ * the DMA will write.  Copies the bytes received since the last call to the
+ * receive stream buffer. */
+void vSerialStreamRxDMAFromISR( SerialStreamPort_t * pxPort,
+                                size_t xDMAPosition,
+                                BaseType_t * pxHigherPriorityTaskWoken );
+
+/* Called by ports without receive DMA with the bytes read from the UART. */
+void vSerialStreamRxFromISR( SerialStreamPort_t * pxPort,
+                             const uint8_t * pucData,
+                             size_t xLength,
+                             BaseType_t * pxHigherPriorityTaskWoken );
+
+#endif /* SERIAL_STREAM_H */
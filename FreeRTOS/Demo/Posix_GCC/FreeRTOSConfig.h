@@ -58,6 +58,7 @@
 #define configUSE_ALTERNATIVE_API                  0
 #define configUSE_QUEUE_SETS                       1
 #define configUSE_TASK_NOTIFICATIONS               1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES      3
 
 /* The following 2  memory allocation schemes are possible for this demo:
  *
@@ -88,9 +89,11 @@
 
 #define configMAX_PRIORITIES                       ( 7 )
 
-/* Run time stats gathering configuration options. */
-unsigned long ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
-void vConfigureTimerForRunTimeStats( void );    /* Prototype of function that initialises the run time counter. */
+/* Run time stats gathering configuration options.  The counter is the CPU
+ * time of the process in nanoseconds, see run-time-stats-utils.c. */
+#define configRUN_TIME_COUNTER_TYPE               uint64_t
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
+void vConfigureTimerForRunTimeStats( void );                  /* Prototype of function that initialises the run time counter. */
 #define configGENERATE_RUN_TIME_STATS             1
 
 /* Co-routine related configuration options. */
@@ -179,6 +182,66 @@ extern void vAssertCalled( const char * const pcFileName,
     #endif /* if ( projENABLE_TRACING == 1 ) */
 #endif /* if ( projCOVERAGE_TEST == 1 ) */
 
+/* When the trace recorder is not using the trace macros, they are used to
+ * count task switches and learn which thread runs each task for
+ * vRunTimeStatsExport().  See run-time-stats-utils.c. */
+#if ( projENABLE_TRACING == 0 )
+    struct tskTaskControlBlock;
+    void vRunTimeStatsTaskSwitchedIn( struct tskTaskControlBlock * xTask );
+    void vRunTimeStatsTaskSwitchedOut( struct tskTaskControlBlock * xTask );
+    void vRunTimeStatsTaskDeleted( struct tskTaskControlBlock * xTask );
+    #define traceTASK_SWITCHED_IN()     vRunTimeStatsTaskSwitchedIn( pxCurrentTCB )
+    #define traceTASK_SWITCHED_OUT()    vRunTimeStatsTaskSwitchedOut( pxCurrentTCB )
+    #define traceTASK_DELETE( pxTCB )    vRunTimeStatsTaskDeleted( pxTCB )
+#endif
+
+void vRunTimeStatsExport( const char * pcFileName );
+
+/* Build with MUTEX_PROFILER=1 to profile mutex contention through the trace
+ * macros, see Demo/Common/Minimal/MutexProfiler.c.  Needs NO_TRACING=1. */
+#ifndef configUSE_MUTEX_PROFILER
+    #define configUSE_MUTEX_PROFILER    0
+#endif
+
+#if ( configUSE_MUTEX_PROFILER == 1 )
+    #if ( projENABLE_TRACING == 1 )
+        #error The mutex profiler uses the trace macros, so cannot be used with the trace recorder.
+    #endif
+    #include "MutexProfiler.h"
+#endif
+
+/* Build with STACK_SIZER=1 to recommend the stack depth of each task and the
+ * heap size, see Demo/Common/Minimal/StackSizer.c.  Needs NO_TRACING=1. */
+#ifndef configUSE_STACK_SIZER
+    #define configUSE_STACK_SIZER    0
+#endif
+
+#if ( configUSE_STACK_SIZER == 1 )
+    #if ( projENABLE_TRACING == 1 )
+        #error The stack sizer uses the trace macros, so cannot be used with the trace recorder.
+    #endif
+
+/* The full demo creates more tasks than the default. */
+    #define stkszMAX_TASKS    128
+    #include "StackSizer.h"
+#endif
+
+/* Build with VIRTUAL_TIME=1 to skip over the ticks during which every task is
+ * blocked, so a demo that mostly waits runs faster than the wall clock.  The
+ * idle task jumps the tick count to the next timeout through the tickless idle
+ * hook, see virtual-time.c.  The tick hook is not called for skipped ticks. */
+#ifndef projVIRTUAL_TIME
+    #define projVIRTUAL_TIME    0
+#endif
+
+#if ( projVIRTUAL_TIME == 1 )
+    void vVirtualTimeSuppressTicks( uint64_t ullExpectedIdleTicks );
+    void vVirtualTimeIdle( void );
+    uint64_t ullVirtualTimeSkippedNs( void );
+    #define configUSE_TICKLESS_IDLE                 2
+    #define portSUPPRESS_TICKS_AND_SLEEP( x )    vVirtualTimeSuppressTicks( ( uint64_t ) ( x ) )
+#endif
+
 /* networking definitions */
 #define configMAC_ISR_SIMULATOR_PRIORITY    ( configMAX_PRIORITIES - 1 )
 
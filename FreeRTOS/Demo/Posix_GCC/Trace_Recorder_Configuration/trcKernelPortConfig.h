@@ -29,8 +29,15 @@
  * Values:
  * TRC_RECORDER_MODE_SNAPSHOT
  * TRC_RECORDER_MODE_STREAMING
+ *
+ * The Posix demo streams, using the port in Trace_Stream_Port, when built
+ * with TRACE_STREAMING=1.
  */
-#define TRC_CFG_RECORDER_MODE                    TRC_RECORDER_MODE_SNAPSHOT
+#if defined( projTRACE_STREAMING ) && ( projTRACE_STREAMING == 1 )
+    #define TRC_CFG_RECORDER_MODE                TRC_RECORDER_MODE_STREAMING
+#else
+    #define TRC_CFG_RECORDER_MODE                TRC_RECORDER_MODE_SNAPSHOT
+#endif
 
 /**
  * @def TRC_CFG_FREERTOS_VERSION
@@ -0,0 +1,72 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Configuration of the streaming trace port of the Posix simulator, see
+ * trcStreamPort.c.
+ */
+
+#ifndef TRC_STREAM_PORT_CONFIG_H
+#define TRC_STREAM_PORT_CONFIG_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_DESTINATION
+ * @brief Where the trace is streamed to.  Either the name of a file, or
+ * "tcp:<host>:<port>" to connect to a host that is listening for the trace,
+ * for example "nc -l 8888 > Trace.psf".  The destination can also be set at
+ * run time with the FREERTOS_TRACE_STREAM environment variable.
+ */
+#ifndef TRC_CFG_STREAM_PORT_DESTINATION
+    #define TRC_CFG_STREAM_PORT_DESTINATION    "Trace.psf"
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_BUFFER_SIZE
+ * @brief The size in bytes of the buffer between the recorder and the thread
+ * that writes the trace out.  Must be a power of two.  Events that do not fit
+ * are dropped, and Tracealyzer reports them as missed events.
+ */
+#ifndef TRC_CFG_STREAM_PORT_BUFFER_SIZE
+    #define TRC_CFG_STREAM_PORT_BUFFER_SIZE    ( 4UL * 1024UL * 1024UL )
+#endif
+
+/**
+ * @def TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS
+ * @brief How long the writer thread sleeps when the buffer is empty.
+ */
+#ifndef TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS
+    #define TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS    10
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRC_STREAM_PORT_CONFIG_H */
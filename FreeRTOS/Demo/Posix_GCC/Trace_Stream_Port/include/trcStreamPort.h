@@ -0,0 +1,81 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A stream port for the trace recorder that streams to a file or a TCP
+ * socket from a host thread, so long runs can be traced without the buffer
+ * of snapshot mode wrapping.  See trcStreamPort.c.
+ */
+
+#ifndef TRC_STREAM_PORT_H
+#define TRC_STREAM_PORT_H
+
+#include <trcTypes.h>
+#include <trcStreamPortConfig.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/* Events are written straight into the buffer of the writer thread, so the
+ * recorder's internal buffer is not needed. */
+#define TRC_USE_INTERNAL_BUFFER        0
+
+#define TRC_STREAM_PORT_BUFFER_SIZE    ( sizeof( TraceUnsignedBaseType_t ) )
+
+typedef struct TraceStreamPortBuffer
+{
+    uint8_t buffer[ TRC_STREAM_PORT_BUFFER_SIZE ];
+} TraceStreamPortBuffer_t;
+
+traceResult prvTraceStreamPortWriteData( void * pvData,
+                                         uint32_t uiSize,
+                                         int32_t * piBytesWritten );
+
+traceResult xTraceStreamPortInitialize( TraceStreamPortBuffer_t * pxBuffer );
+
+traceResult xTraceStreamPortOnTraceBegin( void );
+
+traceResult xTraceStreamPortOnTraceEnd( void );
+
+#define xTraceStreamPortAllocate( uiSize, ppvData )                   ( ( void ) ( uiSize ), xTraceStaticBufferGet( ppvData ) )
+
+#define xTraceStreamPortCommit( pvData, uiSize, piBytesCommitted )    prvTraceStreamPortWriteData( pvData, uiSize, piBytesCommitted )
+
+#define xTraceStreamPortWriteData( pvData, uiSize, piBytesWritten )   prvTraceStreamPortWriteData( pvData, uiSize, piBytesWritten )
+
+/* Commands from Tracealyzer are not read back over the stream. */
+#define xTraceStreamPortReadData( pvData, uiSize, piBytesRead )       ( ( void ) ( pvData ), ( void ) ( uiSize ), ( void ) ( piBytesRead ), TRC_SUCCESS )
+
+#define xTraceStreamPortOnEnable( uiStartOption )                     ( ( void ) ( uiStartOption ), TRC_SUCCESS )
+
+#define xTraceStreamPortOnDisable()                                   ( TRC_SUCCESS )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRC_STREAM_PORT_H */
@@ -0,0 +1,368 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A stream port for the trace recorder in the Posix simulator.
+ *
+ * The recorder commits each event into a single producer, single consumer
+ * ring buffer, which never blocks the task or interrupt that generated the
+ * event.  A host thread, which is not a FreeRTOS task and so does not appear
+ * in the trace, drains the ring buffer to a file or a TCP socket every
+ * TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS.  The recorder serialises events with
+ * its critical section, so there is only ever one producer.  An event that
+ * does not fit in the ring buffer is dropped whole, so the stream stays
+ * parseable and Tracealyzer shows the gap as missed events.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <trcRecorder.h>
+
+#if ( TRC_USE_TRACEALYZER_RECORDER == 1 ) && ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
+
+    #if ( ( TRC_CFG_STREAM_PORT_BUFFER_SIZE & ( TRC_CFG_STREAM_PORT_BUFFER_SIZE - 1 ) ) != 0 )
+        #error TRC_CFG_STREAM_PORT_BUFFER_SIZE must be a power of two.
+    #endif
+
+    #define trcSTREAM_INDEX_MASK    ( ( uint32_t ) ( TRC_CFG_STREAM_PORT_BUFFER_SIZE ) - 1U )
+
+/* The ring buffer.  ulHead is only written by the recorder and ulTail only by
+ * the writer thread.  Both count bytes from the start of the trace and wrap
+ * at 2^32, so the number of bytes in the buffer is ulHead - ulTail. */
+    static uint8_t ucRingBuffer[ TRC_CFG_STREAM_PORT_BUFFER_SIZE ];
+    static uint32_t ulHead = 0;
+    static uint32_t ulTail = 0;
+
+/* Bytes of events dropped because the ring buffer was full. */
+    static uint64_t ullDroppedBytes = 0;
+
+    static int iStreamFd = -1;
+    static int iStreamIsSocket = 0;
+    static int iWriterRunning = 0;
+    static pthread_t xWriterThread;
+
+/*-----------------------------------------------------------*/
+
+/* Open the file or connect the socket named by pcDestination. */
+    static int prvOpenDestination( const char * pcDestination )
+    {
+        char cHost[ 256 ];
+        const char * pcPort;
+        struct addrinfo xHints, * pxAddresses, * pxAddress;
+        size_t xHostLength;
+        int iFd = -1;
+
+        if( strncmp( pcDestination, "tcp:", 4 ) != 0 )
+        {
+            iStreamIsSocket = 0;
+            return open( pcDestination, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        }
+
+        pcDestination += 4;
+        pcPort = strrchr( pcDestination, ':' );
+
+        if( pcPort == NULL )
+        {
+            return -1;
+        }
+
+        xHostLength = ( size_t ) ( pcPort - pcDestination );
+
+        if( xHostLength >= sizeof( cHost ) )
+        {
+            return -1;
+        }
+
+        memcpy( cHost, pcDestination, xHostLength );
+        cHost[ xHostLength ] = '\0';
+
+        memset( &xHints, 0x00, sizeof( xHints ) );
+        xHints.ai_family = AF_UNSPEC;
+        xHints.ai_socktype = SOCK_STREAM;
+
+        if( getaddrinfo( cHost, pcPort + 1, &xHints, &pxAddresses ) != 0 )
+        {
+            return -1;
+        }
+
+        for( pxAddress = pxAddresses; pxAddress != NULL; pxAddress = pxAddress->ai_next )
+        {
+            iFd = socket( pxAddress->ai_family, pxAddress->ai_socktype, pxAddress->ai_protocol );
+
+            if( iFd < 0 )
+            {
+                continue;
+            }
+
+            if( connect( iFd, pxAddress->ai_addr, pxAddress->ai_addrlen ) == 0 )
+            {
+                break;
+            }
+
+            close( iFd );
+            iFd = -1;
+        }
+
+        freeaddrinfo( pxAddresses );
+        iStreamIsSocket = 1;
+
+        return iFd;
+    }
+/*-----------------------------------------------------------*/
+
+/* Write all of pucData, returning 0 if the destination has failed. */
+    static int prvWriteAll( const uint8_t * pucData,
+                            size_t xLength )
+    {
+        ssize_t xWritten;
+
+        while( xLength > 0 )
+        {
+            if( iStreamIsSocket != 0 )
+            {
+                /* MSG_NOSIGNAL so a closed connection does not raise SIGPIPE. */
+                xWritten = send( iStreamFd, pucData, xLength, MSG_NOSIGNAL );
+            }
+            else
+            {
+                xWritten = write( iStreamFd, pucData, xLength );
+            }
+
+            if( xWritten < 0 )
+            {
+                if( errno == EINTR )
+                {
+                    continue;
+                }
+
+                return 0;
+            }
+
+            pucData += xWritten;
+            xLength -= ( size_t ) xWritten;
+        }
+
+        return 1;
+    }
+/*-----------------------------------------------------------*/
+
+    static void * prvWriterThread( void * pvParameters )
+    {
+        const struct timespec xPeriod =
+        {
+            TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS / 1000,
+            ( TRC_CFG_STREAM_PORT_DRAIN_PERIOD_MS % 1000 ) * 1000000L
+        };
+        uint32_t ulLocalHead, ulLocalTail, ulIndex, ulLength;
+        int iDestinationOk = 1;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            ulLocalHead = __atomic_load_n( &ulHead, __ATOMIC_ACQUIRE );
+            ulLocalTail = ulTail;
+
+            if( ulLocalHead == ulLocalTail )
+            {
+                /* Everything committed before the trace ended has been
+                 * written. */
+                if( __atomic_load_n( &iWriterRunning, __ATOMIC_ACQUIRE ) == 0 )
+                {
+                    break;
+                }
+
+                nanosleep( &xPeriod, NULL );
+                continue;
+            }
+
+            /* Write up to the end of the ring buffer, the rest goes on the
+             * next iteration. */
+            ulIndex = ulLocalTail & trcSTREAM_INDEX_MASK;
+            ulLength = ulLocalHead - ulLocalTail;
+
+            if( ulLength > ( ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ulIndex ) )
+            {
+                ulLength = ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ulIndex;
+            }
+
+            /* Once the destination has failed the data is discarded, so the
+             * recorder keeps running. */
+            if( ( iDestinationOk != 0 ) && ( prvWriteAll( &( ucRingBuffer[ ulIndex ] ), ulLength ) == 0 ) )
+            {
+                fprintf( stderr, "\r\nTrace stream: write failed (%s), the rest of the trace is discarded\r\n", strerror( errno ) );
+                iDestinationOk = 0;
+            }
+
+            __atomic_store_n( &ulTail, ulLocalTail + ulLength, __ATOMIC_RELEASE );
+        }
+
+        return NULL;
+    }
+/*-----------------------------------------------------------*/
+
+    traceResult prvTraceStreamPortWriteData( void * pvData,
+                                             uint32_t uiSize,
+                                             int32_t * piBytesWritten )
+    {
+        uint32_t ulLocalHead = ulHead;
+        uint32_t ulIndex, ulFirst;
+
+        *piBytesWritten = ( int32_t ) uiSize;
+
+        if( ( ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ( ulLocalHead - __atomic_load_n( &ulTail, __ATOMIC_ACQUIRE ) ) ) < uiSize )
+        {
+            ullDroppedBytes += uiSize;
+            return TRC_SUCCESS;
+        }
+
+        ulIndex = ulLocalHead & trcSTREAM_INDEX_MASK;
+        ulFirst = ( uint32_t ) TRC_CFG_STREAM_PORT_BUFFER_SIZE - ulIndex;
+
+        if( ulFirst >= uiSize )
+        {
+            memcpy( &( ucRingBuffer[ ulIndex ] ), pvData, uiSize );
+        }
+        else
+        {
+            memcpy( &( ucRingBuffer[ ulIndex ] ), pvData, ulFirst );
+            memcpy( ucRingBuffer, ( uint8_t * ) pvData + ulFirst, uiSize - ulFirst );
+        }
+
+        __atomic_store_n( &ulHead, ulLocalHead + uiSize, __ATOMIC_RELEASE );
+
+        return TRC_SUCCESS;
+    }
+/*-----------------------------------------------------------*/
+
+    traceResult xTraceStreamPortInitialize( TraceStreamPortBuffer_t * pxBuffer )
+    {
+        if( pxBuffer == NULL )
+        {
+            return TRC_FAIL;
+        }
+
+        return TRC_SUCCESS;
+    }
+/*-----------------------------------------------------------*/
+
+/* Write out what is left in the ring buffer when the demo calls exit(). */
+    static void prvFlushAtExit( void )
+    {
+        ( void ) xTraceStreamPortOnTraceEnd();
+    }
+/*-----------------------------------------------------------*/
+
+    traceResult xTraceStreamPortOnTraceBegin( void )
+    {
+        static int iAtExitRegistered = 0;
+        const char * pcDestination = getenv( "FREERTOS_TRACE_STREAM" );
+        sigset_t xAllSignals, xPreviousSignals;
+        int iResult;
+
+        if( iStreamFd >= 0 )
+        {
+            return TRC_SUCCESS;
+        }
+
+        if( pcDestination == NULL )
+        {
+            pcDestination = TRC_CFG_STREAM_PORT_DESTINATION;
+        }
+
+        iStreamFd = prvOpenDestination( pcDestination );
+
+        if( iStreamFd < 0 )
+        {
+            fprintf( stderr, "\r\nTrace stream: cannot open %s\r\n", pcDestination );
+            return TRC_FAIL;
+        }
+
+        ulHead = 0;
+        ulTail = 0;
+        ullDroppedBytes = 0;
+        __atomic_store_n( &iWriterRunning, 1, __ATOMIC_RELEASE );
+
+        /* The port delivers the tick and its own signals to the process, so
+         * the writer thread must not be able to take them. */
+        sigfillset( &xAllSignals );
+        pthread_sigmask( SIG_SETMASK, &xAllSignals, &xPreviousSignals );
+        iResult = pthread_create( &xWriterThread, NULL, prvWriterThread, NULL );
+        pthread_sigmask( SIG_SETMASK, &xPreviousSignals, NULL );
+
+        if( iResult != 0 )
+        {
+            close( iStreamFd );
+            iStreamFd = -1;
+            return TRC_FAIL;
+        }
+
+        if( iAtExitRegistered == 0 )
+        {
+            iAtExitRegistered = 1;
+            atexit( prvFlushAtExit );
+        }
+
+        printf( "\r\nTrace streaming to %s\r\n", pcDestination );
+
+        return TRC_SUCCESS;
+    }
+/*-----------------------------------------------------------*/
+
+    traceResult xTraceStreamPortOnTraceEnd( void )
+    {
+        if( iStreamFd < 0 )
+        {
+            return TRC_SUCCESS;
+        }
+
+        /* The writer thread drains what is left before it exits. */
+        __atomic_store_n( &iWriterRunning, 0, __ATOMIC_RELEASE );
+        pthread_join( xWriterThread, NULL );
+
+        close( iStreamFd );
+        iStreamFd = -1;
+
+        if( ullDroppedBytes != 0 )
+        {
+            printf( "\r\nTrace stream: %llu bytes of events dropped, increase TRC_CFG_STREAM_PORT_BUFFER_SIZE\r\n",
+                    ( unsigned long long ) ullDroppedBytes );
+        }
+
+        return TRC_SUCCESS;
+    }
+
+#endif /* ( TRC_USE_TRACEALYZER_RECORDER == 1 ) && ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING ) */
@@ -25,8 +25,8 @@
  */
 
 /******************************************************************************
- * This project provides two demo applications.  A simple blinky style project,
- * a more comprehensive test and demo application.
+ * This project provides three demo applications.  A simple blinky style project,
+ * a more comprehensive test and demo application, and a benchmark.
  * The mainSELECTED_APPLICATION setting is used to select between
  * the three
  *
@@ -36,6 +36,10 @@
  * If mainSELECTED_APPLICATION = FULL_DEMO the more comprehensive test and demo
  * application built. This is implemented and described in main_full.c.
  *
+ * If mainSELECTED_APPLICATION = BENCHMARK_DEMO the stream and message buffer
+ * throughput benchmark is built.  This is implemented and described in
+ * main_benchmark.c.
+ *
  * This file implements the code that is not demo specific, including the
  * hardware setup and FreeRTOS hook functions.
  *
@@ -68,12 +72,19 @@
 /* Local includes. */
 #include "console.h"
 
+/* Demo app includes. */
+#include "HeapBenchmark.h"
+
+/* Demo logging includes. */
+#include "logging.h"
+
 #if ( projENABLE_TRACING == 1 )
     #include <trcRecorder.h>
 #endif
 
-#define    BLINKY_DEMO    0
-#define    FULL_DEMO      1
+#define    BLINKY_DEMO       0
+#define    FULL_DEMO         1
+#define    BENCHMARK_DEMO    2
 
 #ifdef BUILD_DIR
     #define BUILD         BUILD_DIR
@@ -88,12 +99,16 @@
     #define    mainSELECTED_APPLICATION     FULL_DEMO
 #endif
 
+/* How often the idle hook rewrites projRUN_TIME_STATS_FILE, when defined. */
+#define mainRUN_TIME_STATS_PERIOD    pdMS_TO_TICKS( 5000 )
+
 /* This demo uses heap_3.c (the libc provided malloc() and free()). */
 
 /*-----------------------------------------------------------*/
 
 extern void main_blinky( void );
 extern void main_full( void );
+extern void main_benchmark( void );
 static void traceOnEnter( void );
 
 /*
@@ -102,6 +117,7 @@ static void traceOnEnter( void );
  */
 void vFullDemoTickHookFunction( void );
 void vFullDemoIdleFunction( void );
+void vBenchmarkTickHookFunction( void );
 
 /*
  * Prototypes for the standard FreeRTOS application hook (callback) functions
@@ -167,6 +183,10 @@ int main( void )
     }
     #endif /* if ( projENABLE_TRACING == 1 ) */
 
+    /* vLoggingPrintf() output is passed to a pthread that writes it to
+     * stdout in batches. */
+    vLoggingInit( pdTRUE, pdFALSE, pdFALSE, 0U, 0U );
+
     console_init();
     #if ( mainSELECTED_APPLICATION == BLINKY_DEMO )
     {
@@ -178,6 +198,11 @@ int main( void )
         console_print( "Starting full demo\n" );
         main_full();
     }
+    #elif ( mainSELECTED_APPLICATION == BENCHMARK_DEMO )
+    {
+        console_print( "Starting stream buffer benchmark\n" );
+        main_benchmark();
+    }
     #else
     {
         #error "The selected demo is not valid"
@@ -203,6 +228,16 @@ void vApplicationMallocFailedHook( void )
      * (although it does not provide information on how the remaining heap might be
      * fragmented).  See http://www.freertos.org/a00111.html for more
      * information. */
+    #if ( mainSELECTED_APPLICATION == BENCHMARK_DEMO )
+    {
+        /* The heap benchmark counts its own failed allocations. */
+        if( xIsHeapBenchmarkAllocating() != pdFALSE )
+        {
+            return;
+        }
+    }
+    #endif
+
     vAssertCalled( __FILE__, __LINE__ );
 }
 
@@ -221,9 +256,32 @@ void vApplicationIdleHook( void )
      * allocated by the kernel to any task that has since deleted itself. */
 
 
-    usleep( 15000 );
+    #if ( projVIRTUAL_TIME == 1 )
+    {
+        /* Only sleep when there is no timeout to skip ahead to. */
+        vVirtualTimeIdle();
+    }
+    #else
+    {
+        usleep( 15000 );
+    }
+    #endif
     traceOnEnter();
 
+    #ifdef projRUN_TIME_STATS_FILE
+    {
+        static TickType_t xLastExport = 0;
+
+        /* Rewrite the run time statistics file every mainRUN_TIME_STATS_PERIOD
+         * ticks so it can be read while the demo is running. */
+        if( ( xTaskGetTickCount() - xLastExport ) >= mainRUN_TIME_STATS_PERIOD )
+        {
+            xLastExport = xTaskGetTickCount();
+            vRunTimeStatsExport( projRUN_TIME_STATS_FILE );
+        }
+    }
+    #endif /* projRUN_TIME_STATS_FILE */
+
     #if ( mainSELECTED_APPLICATION == FULL_DEMO )
     {
         /* Call the idle task processing used by the full demo.  The simple
@@ -263,6 +321,10 @@ void vApplicationTickHook( void )
     {
         vFullDemoTickHookFunction();
     }
+    #elif ( mainSELECTED_APPLICATION == BENCHMARK_DEMO )
+    {
+        vBenchmarkTickHookFunction();
+    }
     #endif /* mainSELECTED_APPLICATION */
 }
 
@@ -297,18 +359,6 @@ void traceOnEnter()
 
 /*-----------------------------------------------------------*/
 
-void vLoggingPrintf( const char * pcFormat,
-                     ... )
-{
-    va_list arg;
-
-    va_start( arg, pcFormat );
-    vprintf( pcFormat, arg );
-    va_end( arg );
-}
-
-/*-----------------------------------------------------------*/
-
 void vApplicationDaemonTaskStartupHook( void )
 {
     /* This function will be called once only, when the daemon task starts to
@@ -365,22 +415,33 @@ void vAssertCalled( const char * const pcFileName,
 
     static void prvSaveTraceFile( void )
     {
-        FILE * pxOutputFile;
-
-        vTraceStop();
-
-        pxOutputFile = fopen( "Trace.dump", "wb" );
-
-        if( pxOutputFile != NULL )
+        #if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING )
         {
-            fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
-            fclose( pxOutputFile );
-            printf( "\r\nTrace output saved to Trace.dump\r\n" );
+            /* The trace has been streamed out as it was recorded, stopping
+             * the recorder writes out the rest of it. */
+            xTraceDisable();
+            printf( "\r\nTrace stream closed\r\n" );
         }
-        else
+        #else
         {
-            printf( "\r\nFailed to create trace dump file\r\n" );
+            FILE * pxOutputFile;
+
+            vTraceStop();
+
+            pxOutputFile = fopen( "Trace.dump", "wb" );
+
+            if( pxOutputFile != NULL )
+            {
+                fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
+                fclose( pxOutputFile );
+                printf( "\r\nTrace output saved to Trace.dump\r\n" );
+            }
+            else
+            {
+                printf( "\r\nFailed to create trace dump file\r\n" );
+            }
         }
+        #endif /* if ( TRC_CFG_RECORDER_MODE == TRC_RECORDER_MODE_STREAMING ) */
     }
 
 #endif /* if ( projENABLE_TRACING == 1 ) */
@@ -0,0 +1,657 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/******************************************************************************
+ * NOTE: The FreeRTOS demo threads will not be running continuously, so the
+ * figures measured under the Linux port are only useful to compare one
+ * configuration with another on the same machine.  See the documentation page
+ * for the Linux port for further information:
+ * https://freertos.org/FreeRTOS-simulator-for-Linux.html
+ ******************************************************************************
+ *
+ * main_benchmark() runs the stream and message buffer throughput sweep
+ * implemented in Demo/Common/Minimal/StreamBufferBenchmark.c, with the tick
+ * hook acting as the interrupt that writes to the buffers.  When the sweep is
+ * complete one line is printed per combination.  It then compares the zero
+ * copy core to core transport in Demo/Common/Minimal/AMPZeroCopy.c with
+ * copying the same frames through a message buffer, times the signalling
+ * primitives in Demo/Common/Minimal/SignalBenchmark.c and the bare context
+ * switches in Demo/Common/Minimal/ContextSwitchBenchmark.c, and compares the
+ * kernel timer service with the timer wheel in Demo/Common/Minimal/TimerWheel.c as
+ * the number of active timers grows, compares the kernel queue set with the
+ * ready list set in Demo/Common/Minimal/ReadyQueueSet.c as the number of
+ * members grows, compares the kernel event group with the per bit waiter
+ * lists in Demo/Common/Minimal/IndexedEventGroup.c as the number of waiting
+ * tasks grows, compares the stackless executor in
+ * Demo/Common/Minimal/Executor.c with a task per handler, compares single
+ * and multi item queue calls in Demo/Common/Minimal/BlockQBenchmark.c, runs
+ * the compute kernels in
+ * Demo/Common/Minimal/MathBenchmark.c, and replays the allocation traces in
+ * Demo/Common/Minimal/HeapBenchmark.c against the heap the demo was built
+ * with.  The program exits once all the results have been printed.
+ *
+ * If mainBENCHMARK_JSON is 1 the same benchmarks are run through the suite in
+ * Demo/Common/Minimal/BenchmarkSuite.c instead, which prints every figure as
+ * a line of JSON rather than as tables.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "StreamBufferBenchmark.h"
+#include "AMPZeroCopy.h"
+#include "SignalBenchmark.h"
+#include "ContextSwitchBenchmark.h"
+#include "TimerBenchmark.h"
+#include "QueueSetBenchmark.h"
+#include "EventGroupBenchmark.h"
+#include "ExecutorBenchmark.h"
+#include "BlockQBenchmark.h"
+#include "MathBenchmark.h"
+#include "HeapBenchmark.h"
+#include "BenchmarkSuite.h"
+
+/* Local includes. */
+#include "console.h"
+
+#define mainREPORT_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define mainPOLL_PERIOD             pdMS_TO_TICKS( 1000UL )
+
+#ifndef mainBENCHMARK_JSON
+    #define mainBENCHMARK_JSON      0
+#endif
+
+/* The board named in the JSON lines, and the longest case name built for
+ * them. */
+#define mainBOARD_NAME              "posix_gcc"
+#define mainCASE_LENGTH             ( 48 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Runs the benchmarks one after the other, printing the results of each.
+ */
+#if ( mainBENCHMARK_JSON == 1 )
+    static void prvSuiteTask( void * pvParameters );
+#else
+    static void prvReportTask( void * pvParameters );
+#endif
+
+/*-----------------------------------------------------------*/
+
+void main_benchmark( void )
+{
+    vStartStreamBufferBenchmark();
+
+    #if ( mainBENCHMARK_JSON == 1 )
+        xTaskCreate( prvSuiteTask, "Suite", configMINIMAL_STACK_SIZE, NULL, mainREPORT_TASK_PRIORITY, NULL );
+    #else
+        xTaskCreate( prvReportTask, "Report", configMINIMAL_STACK_SIZE, NULL, mainREPORT_TASK_PRIORITY, NULL );
+    #endif
+
+    vTaskStartScheduler();
+
+    /* If all is well, the scheduler will now be running, and the following
+     * line will never be reached. */
+    for( ; ; )
+    {
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Called by vApplicationTickHook(), which is defined in main.c. */
+void vBenchmarkTickHookFunction( void )
+{
+    vStreamBufferBenchmarkFromISR();
+    vTimerBenchmarkTickHook();
+    vQueueSetBenchmarkTickHook();
+    vEventGroupBenchmarkTickHook();
+}
+/*-----------------------------------------------------------*/
+
+#if ( mainBENCHMARK_JSON == 1 )
+
+static void prvStartAMPZeroCopyBenchmark( void )
+{
+    vStartAMPZeroCopyBenchmark( configMINIMAL_STACK_SIZE * 2 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportStreamBuffer( void )
+{
+    const StreamBufferBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+    char cCase[ mainCASE_LENGTH ];
+
+    uxCount = uxGetStreamBufferBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        snprintf( cCase, sizeof( cCase ), "%s/%u/%u/%u", pxResults[ ux ].pcMode,
+                  ( unsigned ) pxResults[ ux ].xBufferSize,
+                  ( unsigned ) pxResults[ ux ].xTriggerLevel,
+                  ( unsigned ) pxResults[ ux ].xChunkSize );
+        vBenchmarkSuiteReport( cCase, "throughput", pxResults[ ux ].ulBytesPerSecond, "bytes/s" );
+        vBenchmarkSuiteReport( cCase, "wakes", pxResults[ ux ].ulWakeUpsPerMB, "wakes/MB" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportAMPZeroCopy( void )
+{
+    const AMPZeroCopyBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+
+    uxCount = uxGetAMPZeroCopyBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTransport, "throughput", pxResults[ ux ].ulFramesPerSecond, "frames/s" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTransport, "latency_avg", pxResults[ ux ].ulAverageLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTransport, "latency_max", pxResults[ ux ].ulMaxLatency, bmsCYCLES_UNIT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportSignal( void )
+{
+    const SignalBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+
+    uxCount = uxGetSignalBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        vBenchmarkSuiteReport( pxResults[ ux ].pcPrimitive, "round_trip_min", pxResults[ ux ].ulMinRoundTrip, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcPrimitive, "round_trip_avg", pxResults[ ux ].ulAverageRoundTrip, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcPrimitive, "round_trip_max", pxResults[ ux ].ulMaxRoundTrip, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcPrimitive, "cost_avg", pxResults[ ux ].ulAverageCost, bmsCYCLES_UNIT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportContextSwitch( void )
+{
+    const ContextSwitchBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+
+    uxCount = uxGetContextSwitchBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        vBenchmarkSuiteReport( pxResults[ ux ].pcSwitch, "switch_min", pxResults[ ux ].ulMinSwitch, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcSwitch, "switch_avg", pxResults[ ux ].ulAverageSwitch, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcSwitch, "switch_max", pxResults[ ux ].ulMaxSwitch, bmsCYCLES_UNIT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportTimer( void )
+{
+    const TimerBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+    char cCase[ mainCASE_LENGTH ];
+
+    uxCount = uxGetTimerBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        snprintf( cCase, sizeof( cCase ), "%s/%u", pxResults[ ux ].pcBackend, ( unsigned ) pxResults[ ux ].uxTimers );
+        vBenchmarkSuiteReport( cCase, "reset_cost_avg", pxResults[ ux ].ulAverageResetCost, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "lateness_avg", pxResults[ ux ].ulAverageLateness, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "lateness_max", pxResults[ ux ].ulMaxLateness, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "missed", pxResults[ ux ].uxMissedExpiries, "timers" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportQueueSet( void )
+{
+    const QueueSetBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+    char cCase[ mainCASE_LENGTH ];
+
+    uxCount = uxGetQueueSetBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        snprintf( cCase, sizeof( cCase ), "%s/%u/%u", pxResults[ ux ].pcSet,
+                  ( unsigned ) pxResults[ ux ].uxMembers,
+                  ( unsigned ) pxResults[ ux ].uxBurst );
+        vBenchmarkSuiteReport( cCase, "send_cost", pxResults[ ux ].ulSendCost, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "receive_cost", pxResults[ ux ].ulReceiveCost, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "wake_cost", pxResults[ ux ].ulWakeCost, bmsCYCLES_UNIT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportEventGroup( void )
+{
+    const EventGroupBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+    char cCase[ mainCASE_LENGTH ];
+
+    uxCount = uxGetEventGroupBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        snprintf( cCase, sizeof( cCase ), "%s/%u", pxResults[ ux ].pcGroup, ( unsigned ) pxResults[ ux ].uxWaiters );
+        vBenchmarkSuiteReport( cCase, "set_cost", pxResults[ ux ].ulSetCost, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "broadcast_cost", pxResults[ ux ].ulBroadcastCost, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "isr_latency_avg", pxResults[ ux ].ulAverageISRLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "isr_latency_max", pxResults[ ux ].ulMaxISRLatency, bmsCYCLES_UNIT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportExecutor( void )
+{
+    const ExecutorBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+    char cCase[ mainCASE_LENGTH ];
+
+    uxCount = uxGetExecutorBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        snprintf( cCase, sizeof( cCase ), "%s/%u", pxResults[ ux ].pcModel, ( unsigned ) pxResults[ ux ].uxHandlers );
+        vBenchmarkSuiteReport( cCase, "ram", pxResults[ ux ].xRAMBytes, "bytes" );
+        vBenchmarkSuiteReport( cCase, "latency_min", pxResults[ ux ].ulMinLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "latency_avg", pxResults[ ux ].ulAverageLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "latency_max", pxResults[ ux ].ulMaxLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( cCase, "burst_cost", pxResults[ ux ].ulBurstCost, bmsCYCLES_UNIT );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportBlockQ( void )
+{
+    const BlockQBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+    char cCase[ mainCASE_LENGTH ];
+
+    uxCount = uxGetBlockQBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        snprintf( cCase, sizeof( cCase ), "%s/%u", pxResults[ ux ].pcPriorities, ( unsigned ) pxResults[ ux ].uxBatch );
+        vBenchmarkSuiteReport( cCase, "throughput", pxResults[ ux ].ulItemsPerSecond, "items/s" );
+        vBenchmarkSuiteReport( cCase, "waits", pxResults[ ux ].ulWaitsPer1000, "waits/1000 items" );
+        vBenchmarkSuiteReport( cCase, "errors", ( pxResults[ ux ].xErrorDetected != pdFALSE ) ? 1 : 0, "bool" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportMath( void )
+{
+    const MathBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+
+    uxCount = uxGetMathBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        vBenchmarkSuiteReport( pxResults[ ux ].pcKernel, "single", pxResults[ ux ].ulSingleKOps, "kops/s" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcKernel, "shared", pxResults[ ux ].ulSharedKOps, "kops/s" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcKernel, "yielding", pxResults[ ux ].ulYieldKOps, "kops/s" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcKernel, "switch_cost", pxResults[ ux ].ulSwitchNs, "ns" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcKernel, "errors", ( pxResults[ ux ].xResultsMatched != pdFALSE ) ? 0 : 1, "bool" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportHeap( void )
+{
+    const HeapBenchmarkResult_t * pxResults;
+    UBaseType_t uxCount, ux;
+
+    uxCount = uxGetHeapBenchmarkResults( &pxResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "allocations", pxResults[ ux ].ulAllocations, "allocations" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "failures", pxResults[ ux ].ulFailures, "allocations" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "latency_min", pxResults[ ux ].ulMinLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "latency_avg", pxResults[ ux ].ulAverageLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "latency_p50", pxResults[ ux ].ulLatencyP50, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "latency_p99", pxResults[ ux ].ulLatencyP99, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "latency_max", pxResults[ ux ].ulMaxLatency, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "free_cost_avg", pxResults[ ux ].ulAverageFreeCost, bmsCYCLES_UNIT );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "peak", pxResults[ ux ].xPeakBytes, "bytes" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "largest_free_min", pxResults[ ux ].xMinLargestFreeBlock, "bytes" );
+        vBenchmarkSuiteReport( pxResults[ ux ].pcTrace, "free_blocks_max", pxResults[ ux ].xMaxFreeBlocks, "blocks" );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuiteTask( void * pvParameters )
+{
+    /* In the order the report task runs them.  The stream buffer benchmark
+     * is started by main_benchmark(). */
+    static const BenchmarkDefinition_t xBenchmarks[] =
+    {
+        { "stream_buffer",  NULL,                         xIsStreamBufferBenchmarkComplete,  prvReportStreamBuffer  },
+        { "amp_zero_copy",  prvStartAMPZeroCopyBenchmark, xIsAMPZeroCopyBenchmarkComplete,   prvReportAMPZeroCopy   },
+        { "signal",         vStartSignalBenchmark,        xIsSignalBenchmarkComplete,        prvReportSignal        },
+        { "context_switch", vStartContextSwitchBenchmark, xIsContextSwitchBenchmarkComplete, prvReportContextSwitch },
+        { "timer",          vStartTimerBenchmark,         xIsTimerBenchmarkComplete,         prvReportTimer         },
+        { "queue_set",      vStartQueueSetBenchmark,      xIsQueueSetBenchmarkComplete,      prvReportQueueSet      },
+        { "event_group",    vStartEventGroupBenchmark,    xIsEventGroupBenchmarkComplete,    prvReportEventGroup    },
+        { "executor",       vStartExecutorBenchmark,      xIsExecutorBenchmarkComplete,      prvReportExecutor      },
+        { "block_q",        vStartBlockQBenchmark,        xIsBlockQBenchmarkComplete,        prvReportBlockQ        },
+        { "math",           vStartMathBenchmark,          xIsMathBenchmarkComplete,          prvReportMath          },
+        { "heap",           vStartHeapBenchmark,          xIsHeapBenchmarkComplete,          prvReportHeap          }
+    };
+    UBaseType_t ux;
+
+    ( void ) pvParameters;
+
+    for( ux = 0; ux < sizeof( xBenchmarks ) / sizeof( xBenchmarks[ 0 ] ); ux++ )
+    {
+        ( void ) xBenchmarkSuiteRegister( &( xBenchmarks[ ux ] ) );
+    }
+
+    vBenchmarkSuiteRun( mainBOARD_NAME, mainPOLL_PERIOD );
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+#else /* mainBENCHMARK_JSON */
+
+static void prvReportTask( void * pvParameters )
+{
+    const StreamBufferBenchmarkResult_t * pxResults;
+    const AMPZeroCopyBenchmarkResult_t * pxAMPResults;
+    const SignalBenchmarkResult_t * pxSignalResults;
+    const ContextSwitchBenchmarkResult_t * pxSwitchResults;
+    const TimerBenchmarkResult_t * pxTimerResults;
+    const QueueSetBenchmarkResult_t * pxQueueSetResults;
+    const EventGroupBenchmarkResult_t * pxEventGroupResults;
+    const ExecutorBenchmarkResult_t * pxExecutorResults;
+    const BlockQBenchmarkResult_t * pxBlockQResults;
+    const MathBenchmarkResult_t * pxMathResults;
+    const HeapBenchmarkResult_t * pxHeapResults;
+    UBaseType_t uxCount, ux;
+
+    ( void ) pvParameters;
+
+    while( xIsStreamBufferBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetStreamBufferBenchmarkResults( &pxResults );
+
+    console_print( "%-13s %7s %7s %6s %12s %12s\n", "mode", "buffer", "trigger", "chunk", "bytes/s", "wakes/MB" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-13s %7u %7u %6u %12lu %12lu\n",
+                       pxResults[ ux ].pcMode,
+                       ( unsigned ) pxResults[ ux ].xBufferSize,
+                       ( unsigned ) pxResults[ ux ].xTriggerLevel,
+                       ( unsigned ) pxResults[ ux ].xChunkSize,
+                       ( unsigned long ) pxResults[ ux ].ulBytesPerSecond,
+                       ( unsigned long ) pxResults[ ux ].ulWakeUpsPerMB );
+    }
+
+    vStartAMPZeroCopyBenchmark( configMINIMAL_STACK_SIZE * 2 );
+
+    while( xIsAMPZeroCopyBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetAMPZeroCopyBenchmarkResults( &pxAMPResults );
+
+    console_print( "\n%-13s %12s %12s %12s   (%u byte frames, latency in run time counts)\n", "transport", "frames/s", "avg latency", "max latency", ( unsigned ) ampzcFRAME_SIZE );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-13s %12lu %12lu %12lu\n",
+                       pxAMPResults[ ux ].pcTransport,
+                       ( unsigned long ) pxAMPResults[ ux ].ulFramesPerSecond,
+                       ( unsigned long ) pxAMPResults[ ux ].ulAverageLatency,
+                       ( unsigned long ) pxAMPResults[ ux ].ulMaxLatency );
+    }
+
+    vStartSignalBenchmark();
+
+    while( xIsSignalBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetSignalBenchmarkResults( &pxSignalResults );
+
+    console_print( "\n%-19s %10s %10s %10s %10s   (run time counts)\n", "primitive", "min trip", "avg trip", "max trip", "avg cost" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-19s %10lu %10lu %10lu %10lu\n",
+                       pxSignalResults[ ux ].pcPrimitive,
+                       ( unsigned long ) pxSignalResults[ ux ].ulMinRoundTrip,
+                       ( unsigned long ) pxSignalResults[ ux ].ulAverageRoundTrip,
+                       ( unsigned long ) pxSignalResults[ ux ].ulMaxRoundTrip,
+                       ( unsigned long ) pxSignalResults[ ux ].ulAverageCost );
+    }
+
+    vStartContextSwitchBenchmark();
+
+    while( xIsContextSwitchBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetContextSwitchBenchmarkResults( &pxSwitchResults );
+
+    console_print( "\n%-19s %10s %10s %10s   (run time counts per switch)\n", "switch", "min", "avg", "max" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-19s %10lu %10lu %10lu\n",
+                       pxSwitchResults[ ux ].pcSwitch,
+                       ( unsigned long ) pxSwitchResults[ ux ].ulMinSwitch,
+                       ( unsigned long ) pxSwitchResults[ ux ].ulAverageSwitch,
+                       ( unsigned long ) pxSwitchResults[ ux ].ulMaxSwitch );
+    }
+
+    vStartTimerBenchmark();
+
+    while( xIsTimerBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetTimerBenchmarkResults( &pxTimerResults );
+
+    console_print( "\n%-13s %6s %10s %10s %10s %7s   (cost in run time counts)\n", "timers", "count", "reset cost", "avg late", "max late", "missed" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-13s %6u %10lu %10lu %10lu %7u\n",
+                       pxTimerResults[ ux ].pcBackend,
+                       ( unsigned ) pxTimerResults[ ux ].uxTimers,
+                       ( unsigned long ) pxTimerResults[ ux ].ulAverageResetCost,
+                       ( unsigned long ) pxTimerResults[ ux ].ulAverageLateness,
+                       ( unsigned long ) pxTimerResults[ ux ].ulMaxLateness,
+                       ( unsigned ) pxTimerResults[ ux ].uxMissedExpiries );
+    }
+
+    vStartQueueSetBenchmark();
+
+    while( xIsQueueSetBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetQueueSetBenchmarkResults( &pxQueueSetResults );
+
+    console_print( "\n%-13s %7s %6s %10s %10s %10s   (cost per event in run time counts)\n", "set", "members", "burst", "send", "receive", "wake" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-13s %7u %6u %10lu %10lu %10lu\n",
+                       pxQueueSetResults[ ux ].pcSet,
+                       ( unsigned ) pxQueueSetResults[ ux ].uxMembers,
+                       ( unsigned ) pxQueueSetResults[ ux ].uxBurst,
+                       ( unsigned long ) pxQueueSetResults[ ux ].ulSendCost,
+                       ( unsigned long ) pxQueueSetResults[ ux ].ulReceiveCost,
+                       ( unsigned long ) pxQueueSetResults[ ux ].ulWakeCost );
+    }
+
+    vStartEventGroupBenchmark();
+
+    while( xIsEventGroupBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetEventGroupBenchmarkResults( &pxEventGroupResults );
+
+    console_print( "\n%-13s %7s %10s %10s %10s %10s   (run time counts)\n", "group", "waiters", "set cost", "per woken", "avg ISR", "max ISR" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-13s %7u %10lu %10lu %10lu %10lu\n",
+                       pxEventGroupResults[ ux ].pcGroup,
+                       ( unsigned ) pxEventGroupResults[ ux ].uxWaiters,
+                       ( unsigned long ) pxEventGroupResults[ ux ].ulSetCost,
+                       ( unsigned long ) pxEventGroupResults[ ux ].ulBroadcastCost,
+                       ( unsigned long ) pxEventGroupResults[ ux ].ulAverageISRLatency,
+                       ( unsigned long ) pxEventGroupResults[ ux ].ulMaxISRLatency );
+    }
+
+    vStartExecutorBenchmark();
+
+    while( xIsExecutorBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetExecutorBenchmarkResults( &pxExecutorResults );
+
+    console_print( "\n%-13s %8s %10s %10s %10s %10s %10s   (run time counts)\n", "handlers", "number", "RAM bytes", "min lat", "avg lat", "max lat", "burst" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-13s %8u %10lu %10lu %10lu %10lu %10lu\n",
+                       pxExecutorResults[ ux ].pcModel,
+                       ( unsigned ) pxExecutorResults[ ux ].uxHandlers,
+                       ( unsigned long ) pxExecutorResults[ ux ].xRAMBytes,
+                       ( unsigned long ) pxExecutorResults[ ux ].ulMinLatency,
+                       ( unsigned long ) pxExecutorResults[ ux ].ulAverageLatency,
+                       ( unsigned long ) pxExecutorResults[ ux ].ulMaxLatency,
+                       ( unsigned long ) pxExecutorResults[ ux ].ulBurstCost );
+    }
+
+    vStartBlockQBenchmark();
+
+    while( xIsBlockQBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetBlockQBenchmarkResults( &pxBlockQResults );
+
+    console_print( "\n%-13s %8s %12s %12s %8s\n", "priorities", "batch", "items/s", "waits/1000", "order" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-13s %8u %12lu %12lu %8s\n",
+                       pxBlockQResults[ ux ].pcPriorities,
+                       ( unsigned ) pxBlockQResults[ ux ].uxBatch,
+                       ( unsigned long ) pxBlockQResults[ ux ].ulItemsPerSecond,
+                       ( unsigned long ) pxBlockQResults[ ux ].ulWaitsPer1000,
+                       ( pxBlockQResults[ ux ].xErrorDetected != pdFALSE ) ? "FAIL" : "ok" );
+    }
+
+    vStartMathBenchmark();
+
+    while( xIsMathBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetMathBenchmarkResults( &pxMathResults );
+
+    console_print( "\n%-16s %7s %10s %10s %10s %10s %6s\n", "kernel", "vector", "1 task", "shared", "yielding", "switch ns", "check" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-16s %7s %10lu %10lu %10lu %10lu %6s\n",
+                       pxMathResults[ ux ].pcKernel,
+                       ( pxMathResults[ ux ].xUsesVectorRegisters != pdFALSE ) ? "yes" : "no",
+                       ( unsigned long ) pxMathResults[ ux ].ulSingleKOps,
+                       ( unsigned long ) pxMathResults[ ux ].ulSharedKOps,
+                       ( unsigned long ) pxMathResults[ ux ].ulYieldKOps,
+                       ( unsigned long ) pxMathResults[ ux ].ulSwitchNs,
+                       ( pxMathResults[ ux ].xResultsMatched != pdFALSE ) ? "ok" : "FAIL" );
+    }
+
+    console_print( "(throughput in thousands of operations per second, kFLOPS for f32)\n" );
+
+    vStartHeapBenchmark();
+
+    while( xIsHeapBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetHeapBenchmarkResults( &pxHeapResults );
+
+    console_print( "\n%-14s %7s %6s %8s %8s %8s %8s %8s %7s %8s %8s\n", "trace", "allocs", "failed", "avg ns", "p50 ns", "p99 ns", "max ns", "free ns", "peak", "min big", "max frag" );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        console_print( "%-14s %7lu %6lu %8lu %8lu %8lu %8lu %8lu %7lu %8lu %8lu\n",
+                       pxHeapResults[ ux ].pcTrace,
+                       ( unsigned long ) pxHeapResults[ ux ].ulAllocations,
+                       ( unsigned long ) pxHeapResults[ ux ].ulFailures,
+                       ( unsigned long ) pxHeapResults[ ux ].ulAverageLatency,
+                       ( unsigned long ) pxHeapResults[ ux ].ulLatencyP50,
+                       ( unsigned long ) pxHeapResults[ ux ].ulLatencyP99,
+                       ( unsigned long ) pxHeapResults[ ux ].ulMaxLatency,
+                       ( unsigned long ) pxHeapResults[ ux ].ulAverageFreeCost,
+                       ( unsigned long ) pxHeapResults[ ux ].xPeakBytes,
+                       ( unsigned long ) pxHeapResults[ ux ].xMinLargestFreeBlock,
+                       ( unsigned long ) pxHeapResults[ ux ].xMaxFreeBlocks );
+    }
+
+    console_print( "(min big is the smallest largest free block seen and max frag the most free\n"
+                   " blocks, both 0 unless the heap provides vPortGetHeapStats())\n" );
+
+    exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* mainBENCHMARK_JSON */
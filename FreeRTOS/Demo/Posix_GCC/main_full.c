@@ -108,6 +108,14 @@
 #include "MessageBufferAMP.h"
 #include "console.h"
 
+#if ( configUSE_MUTEX_PROFILER == 1 )
+    #include "MutexProfiler.h"
+#endif
+
+#if ( configUSE_STACK_SIZER == 1 )
+    #include "StackSizer.h"
+#endif
+
 /* Priorities at which the tasks are created. */
 #define mainCHECK_TASK_PRIORITY         ( configMAX_PRIORITIES - 2 )
 #define mainQUEUE_POLL_PRIORITY         ( tskIDLE_PRIORITY + 1 )
@@ -122,6 +130,16 @@
 
 #define mainTIMER_TEST_PERIOD           ( 50 )
 
+/* The number of mutexes the check task reports when the mutex profiler is
+ * used. */
+#define mainMUTEX_PROFILES_TO_PRINT     ( 5 )
+
+/* When the stack sizer is used, how often it samples the stacks, and how
+ * many cycles of the check task there are between printing its
+ * recommendations. */
+#define mainSTACK_SIZER_PERIOD_MS       ( 100UL )
+#define mainSTACK_SIZES_PRINT_CYCLES    ( 6UL )
+
 /*
  * Exercises code that is not otherwise covered by the standard demo/test
  * tasks.
@@ -131,6 +149,21 @@ extern BaseType_t xRunCodeCoverageTestAdditions( void );
 /* Task function prototypes. */
 static void prvCheckTask( void * pvParameters );
 
+/*
+ * Print the most contended mutexes, see MutexProfiler.c.
+ */
+#if ( configUSE_MUTEX_PROFILER == 1 )
+    static void prvPrintMutexProfiles( void );
+#endif
+
+/*
+ * Print the stack depth recommended for each task, and the heap size if it
+ * is known, see StackSizer.c.
+ */
+#if ( configUSE_STACK_SIZER == 1 )
+    static void prvPrintStackSizes( void );
+#endif
+
 /* A task that is created from the idle task to test the functionality of
  * eTaskStateGet(). */
 static void prvTestTask( void * pvParameters );
@@ -246,6 +279,12 @@ int main_full( void )
     }
     #endif
 
+    #if ( configUSE_STACK_SIZER == 1 )
+    {
+        vStartStackSizer( mainSTACK_SIZER_PERIOD_MS );
+    }
+    #endif
+
     /* The suicide tasks must be created last as they need to know how many
      * tasks were running prior to their creation.  This then allows them to
      * ascertain whether or not the correct/expected number of tasks are running at
@@ -430,6 +469,25 @@ static void prvCheckTask( void * pvParameters )
                 pcStatusMessage,
                 xTaskGetTickCount() );
 
+        #if ( configUSE_MUTEX_PROFILER == 1 )
+        {
+            prvPrintMutexProfiles();
+        }
+        #endif
+
+        #if ( configUSE_STACK_SIZER == 1 )
+        {
+            static uint32_t ulCycles = 0;
+
+            ulCycles++;
+
+            if( ( ulCycles % mainSTACK_SIZES_PRINT_CYCLES ) == 0 )
+            {
+                prvPrintStackSizes();
+            }
+        }
+        #endif
+
         if( xErrorCount != 0 )
         {
             exit( 1 );
@@ -970,3 +1028,84 @@ static void prvDemonstrateChangingTimerReloadMode( void * pvParameters )
     xTimerDelete( xTimer, portMAX_DELAY );
     vTaskDelete( NULL );
 }
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_MUTEX_PROFILER == 1 )
+
+    static void prvPrintMutexProfiles( void )
+    {
+        static MutexProfile_t xProfiles[ mainMUTEX_PROFILES_TO_PRINT ];
+        const char * pcName;
+        uint32_t ulCount, ul;
+
+        ulCount = ulMutexProfilerGetTop( xProfiles, mainMUTEX_PROFILES_TO_PRINT );
+
+        printf( "Mutex             Takes  Contended  Timeouts  Inherits  Avg wait  Max wait  Avg hold  Max hold\r\n" );
+
+        for( ul = 0; ul < ulCount; ul++ )
+        {
+            pcName = pcQueueGetName( ( QueueHandle_t ) xProfiles[ ul ].pvMutex );
+
+            printf( "%-16s %6lu %10lu %9lu %9lu %9llu %9llu %9llu %9llu\r\n",
+                    ( pcName != NULL ) ? pcName : "(unnamed)",
+                    ( unsigned long ) xProfiles[ ul ].ulAcquires,
+                    ( unsigned long ) xProfiles[ ul ].ulContended,
+                    ( unsigned long ) xProfiles[ ul ].ulTimeouts,
+                    ( unsigned long ) xProfiles[ ul ].ulInheritances,
+                    ( unsigned long long ) ( ( xProfiles[ ul ].ulContended != 0 ) ? ( xProfiles[ ul ].ullWaitTime / xProfiles[ ul ].ulContended ) : 0 ),
+                    ( unsigned long long ) xProfiles[ ul ].ullMaxWait,
+                    ( unsigned long long ) ( ( xProfiles[ ul ].ulAcquires != 0 ) ? ( xProfiles[ ul ].ullHoldTime / xProfiles[ ul ].ulAcquires ) : 0 ),
+                    ( unsigned long long ) xProfiles[ ul ].ullMaxHold );
+        }
+    }
+
+#endif /* configUSE_MUTEX_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_STACK_SIZER == 1 )
+
+    static void prvPrintStackSizes( void )
+    {
+        static StackSizerTask_t xTasks[ stkszMAX_TASKS ];
+        uint32_t ulCount, ul;
+
+        ulCount = ulStackSizerGetTasks( xTasks, stkszMAX_TASKS );
+
+        printf( "Task         Depth  Min free  Recommended\r\n" );
+
+        for( ul = 0; ul < ulCount; ul++ )
+        {
+            if( xTasks[ ul ].ulSamples == 0 )
+            {
+                /* Deleted before it was sampled. */
+                printf( "%-12s %5lu         -            -\r\n",
+                        xTasks[ ul ].cName,
+                        ( unsigned long ) xTasks[ ul ].ulDepth );
+            }
+            else
+            {
+                printf( "%-12s %5lu %9lu %12lu\r\n",
+                        xTasks[ ul ].cName,
+                        ( unsigned long ) xTasks[ ul ].ulDepth,
+                        ( unsigned long ) xTasks[ ul ].ulMinimumFree,
+                        ( unsigned long ) ulStackSizerRecommendedDepth( &( xTasks[ ul ] ), stkszMARGIN_PERCENT ) );
+            }
+        }
+
+        if( ulStackSizerGetUntracked() != 0 )
+        {
+            printf( "%lu tasks were not recorded, increase stkszMAX_TASKS\r\n",
+                    ( unsigned long ) ulStackSizerGetUntracked() );
+        }
+
+        #if ( stkszINCLUDE_HEAP == 1 )
+        {
+            printf( "Heap %lu bytes, minimum ever free %lu, recommended %lu\r\n",
+                    ( unsigned long ) ulStackSizerHeapSize(),
+                    ( unsigned long ) ulStackSizerHeapMinimumEverFree(),
+                    ( unsigned long ) ulStackSizerRecommendedHeapSize( stkszMARGIN_PERCENT ) );
+        }
+        #endif
+    }
+
+#endif /* configUSE_STACK_SIZER */
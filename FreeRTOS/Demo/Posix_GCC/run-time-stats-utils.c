@@ -28,40 +28,302 @@
  * Utility functions required to gather run time statistics.  See:
  * https://www.FreeRTOS.org/rtos-run-time-stats.html
  *
- * Note that this is a simulated port, where simulated time is a lot slower than
- * real time, therefore the run time counter values have no real meaningful
- * units.
+ * Note that this is a simulated port, where Linux can deschedule the thread
+ * of the running task at any time.  The run time counter is therefore the CPU
+ * time used by the process, rather than the time on the wall clock, so time
+ * during which Linux ran something else is not charged to the running task.
+ * The counter is in nanoseconds and 64 bits wide, so does not overflow.
+ * With virtual time the ticks skipped over while every task was blocked are
+ * added to the counter, see virtual-time.c.
  *
- * Also note that it is assumed this demo is going to be used for short periods
- * of time only, and therefore timer overflows are not handled.
+ * Each task runs in its own pthread, so vRunTimeStatsExport() also reports
+ * the CPU time of each task's thread, read with the thread's
+ * CLOCK_THREAD_CPUTIME_ID clock, alongside the number of times the task was
+ * switched in and its stack high water mark.  The thread of a task is learnt
+ * by traceTASK_SWITCHED_OUT(), which is called from the thread of the task
+ * being switched out, so the figures are only available for tasks that have
+ * been switched out at least once.
  */
 
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 /* FreeRTOS includes. */
 #include <FreeRTOS.h>
+#include <task.h>
 
-/* Time at start of day (in ns). */
-static unsigned long ulStartTimeNs;
+/* The most tasks whose threads and switch counts are tracked. */
+#define rtsMAX_TRACKED_TASKS    128
+
+/* A thread seen switching out more than one task, such as a thread the port
+ * uses to generate ticks, is not the thread of any task. */
+#define rtsMAX_SHARED_THREADS    4
+
+typedef struct RunTimeStatsTask
+{
+    TaskHandle_t xTask;
+    pthread_t xThread;
+    BaseType_t xThreadKnown;
+    uint64_t ullSwitchedIn;
+} RunTimeStatsTask_t;
+
+/* CPU time of the process at start of day (in ns). */
+static uint64_t ullStartTimeNs;
+
+static RunTimeStatsTask_t xTrackedTasks[ rtsMAX_TRACKED_TASKS ];
+static UBaseType_t uxTrackedTasks = 0;
+
+static pthread_t xSharedThreads[ rtsMAX_SHARED_THREADS ];
+static UBaseType_t uxSharedThreads = 0;
+
+/* A task that deleted itself is switched out once more after
+ * traceTASK_DELETE(), by a thread that is about to exit. */
+static TaskHandle_t xLastDeletedTask = NULL;
 
 /*-----------------------------------------------------------*/
 
-void vConfigureTimerForRunTimeStats( void )
+static uint64_t prvReadClockNs( clockid_t xClock )
 {
     struct timespec xNow;
 
-    clock_gettime( CLOCK_MONOTONIC, &xNow );
-    ulStartTimeNs = xNow.tv_sec * 1000000000ul + xNow.tv_nsec;
+    if( clock_gettime( xClock, &xNow ) != 0 )
+    {
+        return 0;
+    }
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
 }
 /*-----------------------------------------------------------*/
 
-unsigned long ulGetRunTimeCounterValue( void )
+void vConfigureTimerForRunTimeStats( void )
 {
-    struct timespec xNow;
+    ullStartTimeNs = prvReadClockNs( CLOCK_PROCESS_CPUTIME_ID );
+}
+/*-----------------------------------------------------------*/
+
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue( void )
+{
+    uint64_t ullNow = prvReadClockNs( CLOCK_PROCESS_CPUTIME_ID ) - ullStartTimeNs;
+
+    #if ( projVIRTUAL_TIME == 1 )
+    {
+        ullNow += ullVirtualTimeSkippedNs();
+    }
+    #endif
+
+    return ( configRUN_TIME_COUNTER_TYPE ) ullNow;
+}
+/*-----------------------------------------------------------*/
+
+/* Returns the entry of xTask, adding one if there is room. */
+static RunTimeStatsTask_t * prvGetTrackedTask( TaskHandle_t xTask )
+{
+    RunTimeStatsTask_t * pxEntry = NULL;
+    UBaseType_t ux;
+
+    for( ux = 0; ux < uxTrackedTasks; ux++ )
+    {
+        if( xTrackedTasks[ ux ].xTask == xTask )
+        {
+            pxEntry = &( xTrackedTasks[ ux ] );
+            break;
+        }
+    }
+
+    if( ( pxEntry == NULL ) && ( uxTrackedTasks < rtsMAX_TRACKED_TASKS ) )
+    {
+        pxEntry = &( xTrackedTasks[ uxTrackedTasks ] );
+        memset( pxEntry, 0x00, sizeof( *pxEntry ) );
+        pxEntry->xTask = xTask;
+        uxTrackedTasks++;
+    }
+
+    return pxEntry;
+}
+/*-----------------------------------------------------------*/
+
+/* Called by traceTASK_SWITCHED_IN(), so counts every time a task is selected
+ * to run. */
+void vRunTimeStatsTaskSwitchedIn( TaskHandle_t xTask )
+{
+    RunTimeStatsTask_t * pxEntry;
+
+    /* The handle of a deleted task has been reused. */
+    if( xTask == xLastDeletedTask )
+    {
+        xLastDeletedTask = NULL;
+    }
+
+    pxEntry = prvGetTrackedTask( xTask );
+
+    if( pxEntry != NULL )
+    {
+        pxEntry->ullSwitchedIn++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Called by traceTASK_DELETE(), so the thread of a deleted task is not read,
+ * and its entry can be used for another task. */
+void vRunTimeStatsTaskDeleted( TaskHandle_t xTask )
+{
+    UBaseType_t ux;
+
+    xLastDeletedTask = xTask;
+
+    for( ux = 0; ux < uxTrackedTasks; ux++ )
+    {
+        if( xTrackedTasks[ ux ].xTask == xTask )
+        {
+            uxTrackedTasks--;
+            xTrackedTasks[ ux ] = xTrackedTasks[ uxTrackedTasks ];
+            break;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Called by traceTASK_SWITCHED_OUT() to learn which thread runs xTask. */
+void vRunTimeStatsTaskSwitchedOut( TaskHandle_t xTask )
+{
+    RunTimeStatsTask_t * pxEntry;
+    pthread_t xSelf = pthread_self();
+    UBaseType_t ux;
+
+    if( xTask == xLastDeletedTask )
+    {
+        return;
+    }
+
+    for( ux = 0; ux < uxSharedThreads; ux++ )
+    {
+        if( pthread_equal( xSharedThreads[ ux ], xSelf ) != 0 )
+        {
+            return;
+        }
+    }
+
+    pxEntry = prvGetTrackedTask( xTask );
+
+    if( ( pxEntry == NULL ) || ( ( pxEntry->xThreadKnown != pdFALSE ) && ( pthread_equal( pxEntry->xThread, xSelf ) != 0 ) ) )
+    {
+        return;
+    }
+
+    /* A thread that has already switched out another task does not belong
+     * to either of them. */
+    for( ux = 0; ux < uxTrackedTasks; ux++ )
+    {
+        if( ( xTrackedTasks[ ux ].xThreadKnown != pdFALSE ) && ( pthread_equal( xTrackedTasks[ ux ].xThread, xSelf ) != 0 ) )
+        {
+            xTrackedTasks[ ux ].xThreadKnown = pdFALSE;
+
+            if( uxSharedThreads < rtsMAX_SHARED_THREADS )
+            {
+                xSharedThreads[ uxSharedThreads ] = xSelf;
+                uxSharedThreads++;
+            }
+
+            return;
+        }
+    }
+
+    pxEntry->xThread = xSelf;
+    pxEntry->xThreadKnown = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vRunTimeStatsExport( const char * pcFileName )
+{
+    static RunTimeStatsTask_t xSnapshot[ rtsMAX_TRACKED_TASKS ];
+    static const char * const pcStates[] = { "running", "ready", "blocked", "suspended", "deleted", "invalid" };
+    TaskStatus_t * pxStatusArray;
+    UBaseType_t uxNumberOfTasks, uxSnapshotTasks, ux, uxEntry;
+    configRUN_TIME_COUNTER_TYPE ulTotalRunTime;
+    const RunTimeStatsTask_t * pxEntry;
+    size_t xNameLength = strlen( pcFileName );
+    BaseType_t xJSON = ( ( xNameLength >= 5 ) && ( strcmp( &( pcFileName[ xNameLength - 5 ] ), ".json" ) == 0 ) ) ? pdTRUE : pdFALSE;
+    clockid_t xThreadClock;
+    long long llThreadCPU;
+    FILE * pxFile;
+
+    /* Leave room for tasks created while the array is allocated. */
+    uxNumberOfTasks = uxTaskGetNumberOfTasks() + 4U;
+    pxStatusArray = ( TaskStatus_t * ) pvPortMalloc( uxNumberOfTasks * sizeof( TaskStatus_t ) );
+
+    if( pxStatusArray == NULL )
+    {
+        return;
+    }
+
+    uxNumberOfTasks = uxTaskGetSystemState( pxStatusArray, uxNumberOfTasks, &ulTotalRunTime );
+
+    taskENTER_CRITICAL();
+    {
+        uxSnapshotTasks = uxTrackedTasks;
+        memcpy( xSnapshot, xTrackedTasks, uxSnapshotTasks * sizeof( RunTimeStatsTask_t ) );
+    }
+    taskEXIT_CRITICAL();
+
+    pxFile = fopen( pcFileName, "w" );
+
+    if( pxFile != NULL )
+    {
+        if( xJSON != pdFALSE )
+        {
+            fprintf( pxFile, "{\n  \"total_run_time_ns\": %llu,\n  \"tasks\": [\n", ( unsigned long long ) ulTotalRunTime );
+        }
+        else
+        {
+            fprintf( pxFile, "task,priority,state,run_time_ns,thread_cpu_ns,switched_in,stack_high_water_mark\n" );
+        }
+
+        for( ux = 0; ux < uxNumberOfTasks; ux++ )
+        {
+            pxEntry = NULL;
+
+            for( uxEntry = 0; uxEntry < uxSnapshotTasks; uxEntry++ )
+            {
+                if( xSnapshot[ uxEntry ].xTask == pxStatusArray[ ux ].xHandle )
+                {
+                    pxEntry = &( xSnapshot[ uxEntry ] );
+                    break;
+                }
+            }
+
+            /* -1 when the thread of the task is not known. */
+            llThreadCPU = -1;
+
+            if( ( pxEntry != NULL ) && ( pxEntry->xThreadKnown != pdFALSE ) &&
+                ( pthread_getcpuclockid( pxEntry->xThread, &xThreadClock ) == 0 ) )
+            {
+                llThreadCPU = ( long long ) prvReadClockNs( xThreadClock );
+            }
+
+            fprintf( pxFile,
+                     ( xJSON != pdFALSE ) ?
+                     "    { \"task\": \"%s\", \"priority\": %u, \"state\": \"%s\", \"run_time_ns\": %llu, \"thread_cpu_ns\": %lld, \"switched_in\": %llu, \"stack_high_water_mark\": %u }%s\n" :
+                     "%s,%u,%s,%llu,%lld,%llu,%u%s\n",
+                     pxStatusArray[ ux ].pcTaskName,
+                     ( unsigned ) pxStatusArray[ ux ].uxCurrentPriority,
+                     pcStates[ ( pxStatusArray[ ux ].eCurrentState <= eInvalid ) ? pxStatusArray[ ux ].eCurrentState : eInvalid ],
+                     ( unsigned long long ) pxStatusArray[ ux ].ulRunTimeCounter,
+                     llThreadCPU,
+                     ( unsigned long long ) ( ( pxEntry != NULL ) ? pxEntry->ullSwitchedIn : 0U ),
+                     ( unsigned ) pxStatusArray[ ux ].usStackHighWaterMark,
+                     ( ( xJSON != pdFALSE ) && ( ( ux + 1U ) < uxNumberOfTasks ) ) ? "," : "" );
+        }
+
+        if( xJSON != pdFALSE )
+        {
+            fprintf( pxFile, "  ]\n}\n" );
+        }
 
-    /* Time at start. */
-    clock_gettime( CLOCK_MONOTONIC, &xNow );
+        fclose( pxFile );
+    }
 
-    return xNow.tv_sec * 1000000000ul + xNow.tv_nsec - ulStartTimeNs;
+    vPortFree( pxStatusArray );
 }
 /*-----------------------------------------------------------*/
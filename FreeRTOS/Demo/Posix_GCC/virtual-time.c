@@ -0,0 +1,123 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+
+/*
+ * Virtual time for the simulator, built with VIRTUAL_TIME=1.
+ *
+ * The tick thread of the port advances the tick count at the rate of the
+ * wall clock, so a demo that spends most of its time blocked also takes that
+ * long to run.  With virtual time the idle task instead jumps the tick count
+ * straight to the next timeout whenever every task is blocked, through the
+ * tickless idle hook portSUPPRESS_TICKS_AND_SLEEP().  While any task is ready
+ * the ticks are still generated by the port as normal, so CPU bound code sees
+ * the same tick rate as before.
+ *
+ * When no task is waiting for a timeout there is nothing to jump to, and the
+ * idle task sleeps in real time until an event from outside the simulator,
+ * such as a key press, makes a task ready.
+ *
+ * The run time counter is CPU time, see run-time-stats-utils.c.  The time
+ * skipped over is added to it, so the idle task is charged with the time it
+ * would have spent idle and the run time percentages still add up.
+ *
+ * The kernel does not call the tick hook for the skipped ticks.
+ */
+
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+#include <task.h>
+
+#if ( projVIRTUAL_TIME == 1 )
+
+/* The length of a tick in nanoseconds. */
+    #define vtNS_PER_TICK    ( 1000000000ULL / ( uint64_t ) configTICK_RATE_HZ )
+
+/* How long the idle hook sleeps when there is no timeout to jump to. */
+    #define vtIDLE_SLEEP_US    15000
+
+/* The time skipped over by jumping the tick count, in nanoseconds.  Read by
+ * the run time counter from any thread, so accessed atomically. */
+    static uint64_t ullSkippedNs = 0;
+
+/* Set when the idle task found no timeout to jump to. */
+    static volatile BaseType_t xWaitInRealTime = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/* Called by the idle task with the scheduler suspended when the next task to
+ * unblock is at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks away. */
+    void vVirtualTimeSuppressTicks( uint64_t ullExpectedIdleTicks )
+    {
+        TickType_t xExpectedIdleTicks = ( TickType_t ) ullExpectedIdleTicks;
+
+        taskENTER_CRITICAL();
+        {
+            if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+            {
+                /* A task was made ready, or a yield is pending, since the
+                 * scheduler was suspended. */
+            }
+            else if( ( TickType_t ) ( xTaskGetTickCount() + xExpectedIdleTicks ) == portMAX_DELAY )
+            {
+                /* No task is waiting for a timeout, so only an event from
+                 * outside the simulator can make a task ready. */
+                xWaitInRealTime = pdTRUE;
+            }
+            else
+            {
+                /* The kernel pends the last tick of the jump, which unblocks
+                 * the task when the scheduler is resumed. */
+                vTaskStepTick( xExpectedIdleTicks );
+                __atomic_add_fetch( &ullSkippedNs, ( uint64_t ) xExpectedIdleTicks * vtNS_PER_TICK, __ATOMIC_RELAXED );
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+/*-----------------------------------------------------------*/
+
+/* Called from the idle hook in place of sleeping on every call.  Sleeping
+ * while the tick thread runs would let ticks pass in real time, so the idle
+ * task only sleeps once it has found that there is nothing to jump to. */
+    void vVirtualTimeIdle( void )
+    {
+        if( xWaitInRealTime != pdFALSE )
+        {
+            xWaitInRealTime = pdFALSE;
+            usleep( vtIDLE_SLEEP_US );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    uint64_t ullVirtualTimeSkippedNs( void )
+    {
+        return __atomic_load_n( &ullSkippedNs, __ATOMIC_RELAXED );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* projVIRTUAL_TIME == 1 */
@@ -94,6 +94,20 @@ void vAssertCalled( void );
 	#define uartPRIMARY_PRIORITY		( configMAX_PRIORITIES - 3 )
 #endif
 
+/* The benchmark build, see main_benchmark.c, times the kernel with the
+retired instruction counter, which counts the same on every run of QEMU with
+-icount, or with the cycle counter when mainBENCHMARK_COUNT_CYCLES is
+defined. */
+#ifdef mainBENCHMARK_COUNT_CYCLES
+	#define mainBENCHMARK_COUNTER_NAME	"mcycle"
+	#define mainBENCHMARK_GET_COUNT()	ulReadMCycle()
+#else
+	#define mainBENCHMARK_COUNTER_NAME	"minstret"
+	#define mainBENCHMARK_GET_COUNT()	ulReadMInstret()
+#endif
+#define sigbGET_TIME()					mainBENCHMARK_GET_COUNT()
+#define cswbGET_TIME()					mainBENCHMARK_GET_COUNT()
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 #define INCLUDE_vTaskPrioritySet			1
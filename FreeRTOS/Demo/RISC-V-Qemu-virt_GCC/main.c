@@ -42,6 +42,7 @@ void vApplicationStackOverflowHook( TaskHandle_t pxTask,
 void vApplicationTickHook( void );
 
 int main_blinky( void );
+int main_benchmark( void );
 
 /*-----------------------------------------------------------*/
 
@@ -60,7 +61,12 @@ int main( void )
     }
     #endif
 
-    #if defined( DEMO_BLINKY )
+    /* DEMO_BENCHMARK is defined by building with "make BENCHMARK=1", in which
+     * case the kernel microbenchmarks implemented and described in
+     * main_benchmark.c are run in place of the blinky demo. */
+    #if defined( DEMO_BENCHMARK )
+        ret = main_benchmark();
+    #elif defined( DEMO_BLINKY )
         ret = main_blinky();
     #else
     #error "Please add or select demo."
@@ -124,6 +130,13 @@ void vApplicationStackOverflowHook( TaskHandle_t pxTask,
 
 void vApplicationTickHook( void )
 {
+    #if defined( DEMO_BENCHMARK )
+    {
+        extern void vBenchmarkTickHookFunction( void );
+
+        vBenchmarkTickHookFunction();
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
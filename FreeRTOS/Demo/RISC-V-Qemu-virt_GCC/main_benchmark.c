@@ -0,0 +1,203 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * main_benchmark() is used when the demo is built with "make BENCHMARK=1".  It
+ * runs the kernel microbenchmarks one after the other - the stream and message
+ * buffer throughput of Demo/Common/Minimal/StreamBufferBenchmark.c, with the
+ * tick hook acting as the interrupt that writes to the buffers, the bare
+ * context switches of Demo/Common/Minimal/ContextSwitchBenchmark.c, and the
+ * signalling round trips of Demo/Common/Minimal/SignalBenchmark.c, which
+ * include the queue ping-pong and the task notification latency.
+ *
+ * Each figure is printed over the NS16550 UART as one line:
+ *
+ * BENCH,<counter>,<benchmark>,<case>,<metric>,<value>
+ *
+ * where <counter> is the CSR the times are counts of, minstret by default, or
+ * mcycle when built with BENCHMARK_COUNTER=mcycle.  The stream buffer
+ * throughput is measured against the tick instead.  Once every figure has been
+ * printed a "BENCH,<counter>,end" line is printed and QEMU is told to exit, so
+ * the output of a run can be kept as a baseline and compared with the next.
+ * Run QEMU with -icount shift=0 for the counts to be the same on every run.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "ContextSwitchBenchmark.h"
+#include "SignalBenchmark.h"
+#include "StreamBufferBenchmark.h"
+
+/* Local includes. */
+#include "riscv-virt.h"
+
+#define mainREPORT_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#define mainPOLL_PERIOD             pdMS_TO_TICKS( 100UL )
+
+/* The report task formats lines on its stack. */
+#define mainREPORT_STACK_SIZE       ( configMINIMAL_STACK_SIZE * 4 )
+
+/* Long enough for any line printed by prvPrintFigure(). */
+#define mainMAX_LINE_LENGTH         ( 128 )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by main() when the demo is built with BENCHMARK=1.
+ */
+int main_benchmark( void );
+
+/*
+ * Called by vApplicationTickHook(), which is defined in main.c.
+ */
+void vBenchmarkTickHookFunction( void );
+
+/*
+ * Runs the benchmarks one after the other, printing the figures of each.
+ */
+static void prvReportTask( void * pvParameters );
+
+/*
+ * Prints one BENCH line.
+ */
+static void prvPrintFigure( const char * pcBenchmark,
+                            const char * pcCase,
+                            const char * pcMetric,
+                            uint32_t ulValue );
+
+/*-----------------------------------------------------------*/
+
+int main_benchmark( void )
+{
+    vStartStreamBufferBenchmark();
+
+    xTaskCreate( prvReportTask, "Report", mainREPORT_STACK_SIZE, NULL, mainREPORT_TASK_PRIORITY, NULL );
+
+    vTaskStartScheduler();
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vBenchmarkTickHookFunction( void )
+{
+    vStreamBufferBenchmarkFromISR();
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportTask( void * pvParameters )
+{
+    const StreamBufferBenchmarkResult_t * pxStreamResults;
+    const ContextSwitchBenchmarkResult_t * pxSwitchResults;
+    const SignalBenchmarkResult_t * pxSignalResults;
+    char cCase[ mainMAX_LINE_LENGTH ];
+    UBaseType_t uxCount, ux;
+
+    ( void ) pvParameters;
+
+    /* The stream buffer sweep was started by main_benchmark(), and the other
+     * benchmarks are only started once it is complete, so they time the
+     * kernel alone. */
+    while( xIsStreamBufferBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetStreamBufferBenchmarkResults( &pxStreamResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        snprintf( cCase, sizeof( cCase ), "%s/%u/%u/%u",
+                  pxStreamResults[ ux ].pcMode,
+                  ( unsigned ) pxStreamResults[ ux ].xBufferSize,
+                  ( unsigned ) pxStreamResults[ ux ].xTriggerLevel,
+                  ( unsigned ) pxStreamResults[ ux ].xChunkSize );
+        prvPrintFigure( "stream", cCase, "bytes_per_s", pxStreamResults[ ux ].ulBytesPerSecond );
+        prvPrintFigure( "stream", cCase, "wakes_per_mb", pxStreamResults[ ux ].ulWakeUpsPerMB );
+    }
+
+    vStartContextSwitchBenchmark();
+
+    while( xIsContextSwitchBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetContextSwitchBenchmarkResults( &pxSwitchResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        prvPrintFigure( "switch", pxSwitchResults[ ux ].pcSwitch, "min", pxSwitchResults[ ux ].ulMinSwitch );
+        prvPrintFigure( "switch", pxSwitchResults[ ux ].pcSwitch, "avg", pxSwitchResults[ ux ].ulAverageSwitch );
+        prvPrintFigure( "switch", pxSwitchResults[ ux ].pcSwitch, "max", pxSwitchResults[ ux ].ulMaxSwitch );
+    }
+
+    vStartSignalBenchmark();
+
+    while( xIsSignalBenchmarkComplete() == pdFALSE )
+    {
+        vTaskDelay( mainPOLL_PERIOD );
+    }
+
+    uxCount = uxGetSignalBenchmarkResults( &pxSignalResults );
+
+    for( ux = 0; ux < uxCount; ux++ )
+    {
+        prvPrintFigure( "signal", pxSignalResults[ ux ].pcPrimitive, "min_trip", pxSignalResults[ ux ].ulMinRoundTrip );
+        prvPrintFigure( "signal", pxSignalResults[ ux ].pcPrimitive, "avg_trip", pxSignalResults[ ux ].ulAverageRoundTrip );
+        prvPrintFigure( "signal", pxSignalResults[ ux ].pcPrimitive, "max_trip", pxSignalResults[ ux ].ulMaxRoundTrip );
+        prvPrintFigure( "signal", pxSignalResults[ ux ].pcPrimitive, "avg_cost", pxSignalResults[ ux ].ulAverageCost );
+    }
+
+    snprintf( cCase, sizeof( cCase ), "BENCH,%s,end", mainBENCHMARK_COUNTER_NAME );
+    vSendString( cCase );
+
+    /* End the QEMU session, so a script running the benchmark does not have
+     * to time it out. */
+    *( ( volatile uint32_t * ) TEST_FINISHER_ADDR ) = TEST_FINISHER_PASS;
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintFigure( const char * pcBenchmark,
+                            const char * pcCase,
+                            const char * pcMetric,
+                            uint32_t ulValue )
+{
+    char cLine[ mainMAX_LINE_LENGTH ];
+
+    /* vSendString() adds the newline. */
+    snprintf( cLine, sizeof( cLine ), "BENCH,%s,%s,%s,%s,%u", mainBENCHMARK_COUNTER_NAME, pcBenchmark, pcCase, pcMetric, ( unsigned ) ulValue );
+    vSendString( cLine );
+}
+/*-----------------------------------------------------------*/
@@ -123,6 +123,20 @@ machine on which the test is developed). */
 #define bktPRIMARY_PRIORITY		( configMAX_PRIORITIES - 4 )
 #define bktSECONDARY_PRIORITY	( configMAX_PRIORITIES - 5 )
 
+/* The benchmark build, see main_benchmark.c, times the kernel with the
+retired instruction counter, which counts the same on every run of QEMU with
+-icount, or with the cycle counter when mainBENCHMARK_COUNT_CYCLES is
+defined. */
+#ifdef mainBENCHMARK_COUNT_CYCLES
+	#define mainBENCHMARK_COUNTER_NAME	"mcycle"
+	#define mainBENCHMARK_GET_COUNT()	ulReadMCycle()
+#else
+	#define mainBENCHMARK_COUNTER_NAME	"minstret"
+	#define mainBENCHMARK_GET_COUNT()	ulReadMInstret()
+#endif
+#define sigbGET_TIME()					mainBENCHMARK_GET_COUNT()
+#define cswbGET_TIME()					mainBENCHMARK_GET_COUNT()
+
 #ifdef PICOLIBC_TLS
 #define configUSE_PICOLIBC_TLS                  1
 #endif
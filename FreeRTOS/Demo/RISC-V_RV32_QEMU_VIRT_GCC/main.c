@@ -67,6 +67,13 @@
  * implemented and described in main_full.c. */
 #define mainCREATE_SIMPLE_BLINKY_DEMO_ONLY    0
 
+/* mainCREATE_BENCHMARK is set to 1 by building with "make BENCHMARK=1", in
+ * which case the kernel microbenchmarks implemented and described in
+ * main_benchmark.c are built in place of either demo. */
+#ifndef mainCREATE_BENCHMARK
+    #define mainCREATE_BENCHMARK              0
+#endif
+
 /* Set to 1 to use direct mode and set to 0 to use vectored mode.
  * VECTOR MODE=Direct --> all traps into machine mode cause the pc to be set to the
  * vector base address (BASE) in the mtvec register.
@@ -100,6 +107,7 @@ extern void freertos_vector_table( void );
  */
 extern void main_blinky( void );
 extern void main_full( void );
+extern void main_benchmark( void );
 
 /*
  * Only the comprehensive demo uses application hook (callback) functions.  See
@@ -127,7 +135,11 @@ void main( void )
 
     /* The mainCREATE_SIMPLE_BLINKY_DEMO_ONLY setting is described at the top
      * of this file. */
-    #if ( mainCREATE_SIMPLE_BLINKY_DEMO_ONLY == 1 )
+    #if ( mainCREATE_BENCHMARK == 1 )
+    {
+        main_benchmark();
+    }
+    #elif ( mainCREATE_SIMPLE_BLINKY_DEMO_ONLY == 1 )
     {
         main_blinky();
     }
@@ -203,7 +215,13 @@ void vApplicationTickHook( void )
     * code must not attempt to block, and only the interrupt safe FreeRTOS API
     * functions can be used (those that end in FromISR()). */
 
-    #if ( mainCREATE_SIMPLE_BLINKY_DEMO_ONLY != 1 )
+    #if ( mainCREATE_BENCHMARK == 1 )
+    {
+        extern void vBenchmarkTickHookFunction( void );
+
+        vBenchmarkTickHookFunction();
+    }
+    #elif ( mainCREATE_SIMPLE_BLINKY_DEMO_ONLY != 1 )
     {
         extern void vFullDemoTickHookFunction( void );
 
@@ -44,11 +44,38 @@
 
 #define NS16550_ADDR		CONS(0x10000000, UL)
 
+/* Writing TEST_FINISHER_PASS to the SiFive test device ends the QEMU session
+with an exit status of 0. */
+#define TEST_FINISHER_ADDR	CONS(0x00100000, UL)
+#define TEST_FINISHER_PASS	CONS(0x5555, UL)
+
 #ifndef __ASSEMBLER__
 
+#include <stdint.h>
+
 int xGetCoreID( void );
 void vSendString( const char * s );
 
+/* The low 32 bits of the cycle and retired instruction counters, which are
+enough for the differences the benchmark build takes, see main_benchmark.c. */
+static inline uint32_t ulReadMCycle( void )
+{
+uint32_t ulCount;
+
+	__asm volatile( "csrr %0, mcycle" : "=r" ( ulCount ) );
+
+	return ulCount;
+}
+
+static inline uint32_t ulReadMInstret( void )
+{
+uint32_t ulCount;
+
+	__asm volatile( "csrr %0, minstret" : "=r" ( ulCount ) );
+
+	return ulCount;
+}
+
 #endif /* __ASSEMBLER__ */
 
 #endif /* RISCV_VIRT_H_ */
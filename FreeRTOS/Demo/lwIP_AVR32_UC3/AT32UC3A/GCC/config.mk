@@ -48,6 +48,9 @@ ETH_PATH = $(DEMO_PATH)/NETWORK
 WEB_PATH = $(ETH_PATH)/BasicWEB
 TFTP_PATH = $(ETH_PATH)/BasicTFTP
 SMTP_PATH = $(ETH_PATH)/BasicSMTP
+CHKSUM_BENCH_PATH = $(ETH_PATH)/ChecksumBench
+POOL_STATS_PATH = $(ETH_PATH)/PoolStats
+CLI_PATH = $(FREERTOS_PATH)/../FreeRTOS-Plus/Source/FreeRTOS-Plus-CLI
 LWIP_PATH = $(FREERTOS_PATH)/Demo/Common/ethernet/lwIP
 LWIP_PORT_PATH = $(ETH_PATH)/lwip-port/AT32UC3A
 
@@ -74,7 +77,7 @@ TARGET = $(PART)-lwipdemo.elf
 # Things that might be added to DEFS:
 #   BOARD             Board used: {EVKxxxx}
 #   EXT_BOARD         Extension board used (if any): {EXTxxxx}
-DEFS = -D BOARD=EVK1100 -D FREERTOS_USED -D HTTP_USED=1 -D TFTP_USED=1 -D SMTP_USED=0
+DEFS = -D BOARD=EVK1100 -D FREERTOS_USED -D HTTP_USED=1 -D TFTP_USED=1 -D SMTP_USED=0 -D CHKSUM_BENCH_USED=0 -D POOL_STATS_USED=0
 
 # Include path
 INC_PATH = \
@@ -98,7 +101,10 @@ INC_PATH = \
   $(LWIP_PORT_PATH)/ \
   $(WEB_PATH)/ \
   $(TFTP_PATH)/ \
-  $(SMTP_PATH)/
+  $(SMTP_PATH)/ \
+  $(CHKSUM_BENCH_PATH)/ \
+  $(POOL_STATS_PATH)/ \
+  $(CLI_PATH)/
 
 # C source files
 
@@ -150,6 +156,8 @@ CSRCS = \
   $(WEB_PATH)/BasicWEB.c \
   $(TFTP_PATH)/BasicTFTP.c \
   $(SMTP_PATH)/BasicSMTP.c \
+  $(CHKSUM_BENCH_PATH)/ChecksumBench.c \
+  $(POOL_STATS_PATH)/PoolStats.c \
   $(ETH_PATH)/ethernet.c \
   $(DEMO_PATH)/printf-stdarg.c
 
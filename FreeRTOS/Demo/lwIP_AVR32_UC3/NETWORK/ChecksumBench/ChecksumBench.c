@@ -0,0 +1,185 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * Times inet_chksum(), which uses the checksum routine selected by
+ * LWIP_CHKSUM_ALGORITHM (or LWIP_CHKSUM) in Demo/Common/ethernet/lwIP/core/inet.c,
+ * against a byte-wise reference that sums one octet pair per iteration.  Each
+ * length is timed at each offset from a 32-bit boundary, as the faster
+ * routines sum the head and tail of unaligned data separately.  Every result
+ * is also checked against the reference.
+ *
+ * Build with CHKSUM_BENCH_USED=1 to start the task from ethernet.c.  Rebuild
+ * with a different LWIP_CHKSUM_ALGORITHM in lwipopts.h to compare routines.
+ */
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* lwIP includes. */
+#include "lwip/opt.h"
+#include "lwip/arch.h"
+#include "lwip/def.h"
+#include "lwip/inet.h"
+
+#include "ChecksumBench.h"
+
+/*! The time each length and offset is timed for. */
+#define chkbenchPERIOD			( ( TickType_t ) 100 / portTICK_PERIOD_MS )
+
+/*! The largest length timed, one full size Ethernet payload. */
+#define chkbenchMAX_LENGTH		( 1500 )
+
+/*! The number of offsets from a 32-bit boundary timed. */
+#define chkbenchOFFSETS			( 4 )
+
+static const unsigned short usLengths[] = { 20, 64, 576, 1460 };
+
+#define chkbenchLENGTHS			( sizeof( usLengths ) / sizeof( usLengths[ 0 ] ) )
+
+/* The data, aligned to 32 bits by the union. */
+static union
+{
+	unsigned long ulAlign;
+	unsigned char ucBytes[ chkbenchMAX_LENGTH + chkbenchOFFSETS ];
+} xData;
+
+static xChecksumBenchResult xResults[ chkbenchLENGTHS * chkbenchOFFSETS ];
+static volatile unsigned portBASE_TYPE uxResults = 0;
+static unsigned long ulErrors = 0;
+
+/*-----------------------------------------------------------*/
+
+/* The byte-wise reference, returning the checksum as inet_chksum() does. */
+static u16_t prvByteWiseChecksum( const unsigned char *pucData, unsigned short usLength )
+{
+u32_t ulSum = 0;
+
+	while( usLength > 1 )
+	{
+		ulSum += ( ( u32_t ) pucData[ 0 ] << 8 ) | pucData[ 1 ];
+		pucData += 2;
+		usLength -= 2;
+	}
+
+	if( usLength > 0 )
+	{
+		ulSum += ( u32_t ) pucData[ 0 ] << 8;
+	}
+
+	while( ( ulSum >> 16 ) != 0 )
+	{
+		ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+	}
+
+	return ( u16_t ) ~htons( ( u16_t ) ulSum );
+}
+/*-----------------------------------------------------------*/
+
+/* Return the bytes per second summed by inet_chksum(), or by the reference
+ * when xByteWise is pdTRUE, checking each result against usExpected. */
+static unsigned long prvTime( const unsigned char *pucData, unsigned short usLength, u16_t usExpected, portBASE_TYPE xByteWise )
+{
+TickType_t xStart;
+unsigned long ulCalls = 0;
+u16_t usResult;
+
+	/* Start on a tick boundary. */
+	xStart = xTaskGetTickCount();
+	while( xTaskGetTickCount() == xStart )
+	{
+	}
+
+	xStart = xTaskGetTickCount();
+	while( ( TickType_t ) ( xTaskGetTickCount() - xStart ) < chkbenchPERIOD )
+	{
+		if( xByteWise == pdTRUE )
+		{
+			usResult = prvByteWiseChecksum( pucData, usLength );
+		}
+		else
+		{
+			usResult = inet_chksum( ( void * ) pucData, usLength );
+		}
+
+		if( usResult != usExpected )
+		{
+			ulErrors++;
+		}
+
+		ulCalls++;
+	}
+
+	return ( unsigned long ) ( ( ( unsigned long long ) ulCalls * usLength * configTICK_RATE_HZ ) / chkbenchPERIOD );
+}
+/*-----------------------------------------------------------*/
+
+portTASK_FUNCTION( vChecksumBench, pvParameters )
+{
+unsigned portBASE_TYPE uxLength, uxOffset, uxResult = 0;
+unsigned long ulSeed = 0x12345678UL;
+const unsigned char *pucData;
+u16_t usExpected;
+size_t x;
+
+	( void ) pvParameters;
+
+	/* Fill the data with a pseudo random pattern. */
+	for( x = 0; x < sizeof( xData.ucBytes ); x++ )
+	{
+		ulSeed = ( ulSeed * 1103515245UL ) + 12345UL;
+		xData.ucBytes[ x ] = ( unsigned char ) ( ulSeed >> 16 );
+	}
+
+	for( uxLength = 0; uxLength < chkbenchLENGTHS; uxLength++ )
+	{
+		for( uxOffset = 0; uxOffset < chkbenchOFFSETS; uxOffset++ )
+		{
+			pucData = &( xData.ucBytes[ uxOffset ] );
+			usExpected = prvByteWiseChecksum( pucData, usLengths[ uxLength ] );
+
+			xResults[ uxResult ].usLength = usLengths[ uxLength ];
+			xResults[ uxResult ].usOffset = ( unsigned short ) uxOffset;
+			xResults[ uxResult ].ulBytesPerSecond = prvTime( pucData, usLengths[ uxLength ], usExpected, pdFALSE );
+			xResults[ uxResult ].ulByteWiseBytesPerSecond = prvTime( pucData, usLengths[ uxLength ], usExpected, pdTRUE );
+			uxResult++;
+		}
+	}
+
+	uxResults = uxResult;
+
+	vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxGetChecksumBenchResults( const xChecksumBenchResult **ppxResults, unsigned long *pulErrors )
+{
+	*ppxResults = xResults;
+	*pulErrors = ulErrors;
+
+	return uxResults;
+}
@@ -0,0 +1,57 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef CHECKSUM_BENCH_H
+#define CHECKSUM_BENCH_H
+
+#include "portmacro.h"
+
+/*! The result of timing inet_chksum() for one length and alignment. */
+typedef struct
+{
+	unsigned short usLength;				/* Octets summed per call. */
+	unsigned short usOffset;				/* Offset of the data from a 32-bit boundary. */
+	unsigned long ulBytesPerSecond;			/* inet_chksum(), as selected by LWIP_CHKSUM_ALGORITHM. */
+	unsigned long ulByteWiseBytesPerSecond;	/* The byte-wise reference the result is checked against. */
+} xChecksumBenchResult;
+
+/*! \brief Checksum benchmark task.
+ *         Checks and times inet_chksum() over typical packet lengths and
+ *         alignments, then deletes itself.  The results are read with
+ *         uxGetChecksumBenchResults().
+ *
+ *  \param pvParameters   Input. Not Used.
+ *
+ */
+portTASK_FUNCTION_PROTO( vChecksumBench, pvParameters );
+
+/*! \brief Return the number of results, setting *ppxResults to the table, or
+ *         zero while the benchmark is still running.  *pulErrors is set to the
+ *         number of checksums that did not match the reference.
+ */
+unsigned portBASE_TYPE uxGetChecksumBenchResults( const xChecksumBenchResult **ppxResults, unsigned long *pulErrors );
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * A FreeRTOS+CLI command that reports how much of each lwIP pool is used, see
+ * stats_pool_get() in Demo/Common/ethernet/lwIP/core/stats.c.  Run the system
+ * under its heaviest expected load, then set MEMP_NUM_xxx and PBUF_POOL_SIZE in
+ * lwipopts.h to the recommended sizes.  A pool marked "starved" failed an
+ * allocation, so its high water mark is only a lower bound on the demand, and
+ * the recommendation is the configured size plus STATS_POOL_MARGIN percent.
+ *
+ * Build with POOL_STATS_USED=1, and with FreeRTOS_CLI.c and a console task
+ * that passes its input to FreeRTOS_CLIProcessCommand(), then call
+ * vRegisterPoolStatsCommand() before starting the console.
+ */
+
+#if (POOL_STATS_USED == 1)
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* lwIP includes. */
+#include "lwip/opt.h"
+#include "lwip/stats.h"
+
+/* FreeRTOS+CLI includes. */
+#include "FreeRTOS_CLI.h"
+
+#include "PoolStats.h"
+
+/*! The longest line written, a pool row or the totals. */
+#define poolstatsMAX_LINE		( 64 )
+
+static BaseType_t prvPoolStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+static const CLI_Command_Definition_t xPoolStatsCommand =
+{
+	"lwip-pools",
+	"\r\nlwip-pools [reset]:\r\n Lists the use and recommended size of each lwIP pool, or restarts the high water marks\r\n",
+	prvPoolStatsCommand,
+	-1
+};
+
+/*-----------------------------------------------------------*/
+
+void vRegisterPoolStatsCommand( void )
+{
+	FreeRTOS_CLIRegisterCommand( &xPoolStatsCommand );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPoolStatsCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+/* The next line to write, 0 for the heading, then one line per pool and
+the totals. */
+static u8_t ucLine = 0;
+static unsigned long ulNowBytes, ulRecommendedBytes;
+struct stats_pool xPool;
+const char *pcParameter;
+BaseType_t xParameterLength;
+
+	configASSERT( xWriteBufferLen >= poolstatsMAX_LINE );
+	( void ) xWriteBufferLen;
+
+	if( ucLine == 0 )
+	{
+		pcParameter = FreeRTOS_CLIGetParameter( pcCommandString, 1, &xParameterLength );
+
+		if( pcParameter != NULL )
+		{
+			if( ( xParameterLength == 5 ) && ( strncmp( pcParameter, "reset", 5 ) == 0 ) )
+			{
+				stats_reset_max();
+				strcpy( pcWriteBuffer, "High water marks restarted\r\n" );
+			}
+			else
+			{
+				strcpy( pcWriteBuffer, "Usage: lwip-pools [reset]\r\n" );
+			}
+
+			return pdFALSE;
+		}
+
+		ulNowBytes = 0;
+		ulRecommendedBytes = 0;
+		strcpy( pcWriteBuffer, "Pool           Size  Num Used  Max  Err  Rec\r\n" );
+		ucLine++;
+		return pdTRUE;
+	}
+
+	if( ucLine <= STATS_POOL_MAX )
+	{
+		stats_pool_get( ucLine - 1, &xPool );
+		ulNowBytes += ( unsigned long ) xPool.size * xPool.num;
+		ulRecommendedBytes += ( unsigned long ) xPool.size * xPool.recommended;
+
+		sprintf( pcWriteBuffer, "%-14s %4d %4d %4d %4d %4d %4d%s\r\n", xPool.name, ( int ) xPool.size,
+				 ( int ) xPool.num, ( int ) xPool.used, ( int ) xPool.max, ( int ) xPool.err,
+				 ( int ) xPool.recommended, ( xPool.err != 0 ) ? " starved" : "" );
+		ucLine++;
+		return pdTRUE;
+	}
+
+	sprintf( pcWriteBuffer, "Bytes now %lu, recommended %lu\r\n", ulNowBytes, ulRecommendedBytes );
+	ucLine = 0;
+	return pdFALSE;
+}
+
+#endif
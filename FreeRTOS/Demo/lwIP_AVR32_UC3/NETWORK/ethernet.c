@@ -72,6 +72,10 @@
   #include "BasicSMTP.h"
 #endif
 
+#if (CHKSUM_BENCH_USED == 1)
+  #include "ChecksumBench.h"
+#endif
+
 /* lwIP includes */
 #include "lwip/sys.h"
 #include "lwip/api.h" 
@@ -140,6 +144,12 @@ static const gpio_map_t MACB_GPIO_MAP =
   sys_thread_new( vBasicSMTPClient, ( void * ) NULL, ethSMTPCLIENT_PRIORITY );
 #endif
 
+#if (CHKSUM_BENCH_USED == 1)
+  /* Create the checksum benchmark task.  It does not use the lwIP RTOS
+  abstraction layer, so is created directly. */
+  xTaskCreate( vChecksumBench, "CHKSUM", ethCHKSUM_BENCH_STACK_SIZE, NULL, ethCHKSUM_BENCH_PRIORITY, NULL );
+#endif
+
 }
 
 
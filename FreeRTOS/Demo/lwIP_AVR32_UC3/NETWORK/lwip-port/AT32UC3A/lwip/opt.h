@@ -71,6 +71,44 @@ a lot of data that needs to be copied, this should be set high. */
 #define MEM_SIZE                        1600
 #endif
 
+/* MEM_USE_SIZE_CLASSES==1: serve mem_malloc() requests of up to
+   MEM_CLASS3_SIZE bytes from fixed size blocks in four size classes
+   instead of the first-fit heap.  Taking and returning a block takes the
+   same time however fragmented the heap is.  A request goes to the heap
+   when it is larger than every class or its class is empty.  The classes
+   take MEM_CLASSn_NUM blocks of MEM_CLASSn_SIZE bytes each on top of
+   MEM_SIZE, the sizes must be ascending and a class with no blocks is
+   unused. */
+#ifndef MEM_USE_SIZE_CLASSES
+#define MEM_USE_SIZE_CLASSES            0
+#endif
+
+/* Class 0 holds header-only TCP segments, class 3 a full segment. */
+#ifndef MEM_CLASS0_SIZE
+#define MEM_CLASS0_SIZE                 128
+#endif
+#ifndef MEM_CLASS0_NUM
+#define MEM_CLASS0_NUM                  8
+#endif
+#ifndef MEM_CLASS1_SIZE
+#define MEM_CLASS1_SIZE                 256
+#endif
+#ifndef MEM_CLASS1_NUM
+#define MEM_CLASS1_NUM                  4
+#endif
+#ifndef MEM_CLASS2_SIZE
+#define MEM_CLASS2_SIZE                 512
+#endif
+#ifndef MEM_CLASS2_NUM
+#define MEM_CLASS2_NUM                  2
+#endif
+#ifndef MEM_CLASS3_SIZE
+#define MEM_CLASS3_SIZE                 (TCP_MSS + 96)
+#endif
+#ifndef MEM_CLASS3_NUM
+#define MEM_CLASS3_NUM                  2
+#endif
+
 #ifndef MEMP_SANITY_CHECK
 #define MEMP_SANITY_CHECK       0
 #endif
@@ -165,6 +203,12 @@ a lot of data that needs to be copied, this should be set high. */
 #define ARP_TABLE_SIZE                  10
 #endif
 
+/** Number of hash buckets indexing the ARP cache by IP address, a power
+ * of two.  Around ARP_TABLE_SIZE / 2 keeps the buckets short. */
+#ifndef ARP_HASH_SIZE
+#define ARP_HASH_SIZE                   8
+#endif
+
 /**
  * If enabled, outgoing packets are queued during hardware address
  * resolution.
@@ -268,6 +312,38 @@ a lot of data that needs to be copied, this should be set high. */
 #define DHCP_DOES_ARP_CHECK             1
 #endif
 
+/* LWIP_DHCP_LEASE_CACHE==1: keep the last lease across reboots, and ask for
+   it back with an RFC 2131 INIT-REBOOT request instead of starting with a
+   DISCOVER.  A server on the link confirms the lease in one exchange.  The
+   application provides dhcp_lease_load() and dhcp_lease_store() (see
+   dhcp.h) to keep the lease in a Reliance Edge file, a flash record or
+   battery backed RAM.  The lease is stored each time it is bound, so once
+   per boot and once per renewal, and erased when a server refuses it or it
+   is released, so use dhcp_stop() rather than dhcp_release() before a
+   planned power down. */
+#ifndef LWIP_DHCP_LEASE_CACHE
+#define LWIP_DHCP_LEASE_CACHE           0
+#endif
+
+/* LWIP_DHCP_LEASE_OPTIMISTIC==1: configure the interface with the cached
+   lease as soon as the INIT-REBOOT request is sent, and keep using it when
+   no server answers, as RFC 2131 allows for an unexpired lease.  Only
+   leases known to be unexpired are used this way, so this needs
+   LWIP_DHCP_LEASE_CLOCK(). */
+#ifndef LWIP_DHCP_LEASE_OPTIMISTIC
+#define LWIP_DHCP_LEASE_OPTIMISTIC      0
+#endif
+
+/* LWIP_DHCP_LEASE_CLOCK(): seconds from a clock that keeps counting across
+   reboots, such as an RTC, used to tell when a cached lease expires.  Leave
+   undefined if there is no such clock. */
+/* #define LWIP_DHCP_LEASE_CLOCK()      rtc_get_seconds() */
+
+/* The INIT-REBOOT requests sent before falling back to a DISCOVER. */
+#ifndef DHCP_REBOOT_TRIES
+#define DHCP_REBOOT_TRIES               2
+#endif
+
 /* ---------- SNMP options ---------- */
 /** @note UDP must be available for SNMP transport */
 #ifndef LWIP_SNMP
@@ -341,6 +417,14 @@ a lot of data that needs to be copied, this should be set high. */
 #define TCP_SND_QUEUELEN                4 * TCP_SND_BUF/TCP_MSS
 #endif
 
+/* Extra bytes allocated with the last segment of a copying tcp_write(),
+   so that following small writes are copied into that segment instead of
+   getting pbufs of their own.  Segments never grow beyond the MSS.  0
+   disables it. */
+#ifndef TCP_OVERSIZE
+#define TCP_OVERSIZE                    TCP_MSS
+#endif
+
 
 /* Maximum number of retransmissions of data segments. */
 
@@ -370,6 +454,19 @@ a lot of data that needs to be copied, this should be set high. */
 #define LWIP_COMPAT_SOCKETS             1
 #endif
 
+/* LWIP_EPOLL==1: provide lwip_epoll_create(), lwip_epoll_ctl() and
+   lwip_epoll_wait().  The event callback keeps a list of the sockets that
+   may be ready, so a wait costs time in proportion to the sockets that are
+   ready instead of scanning every socket as lwip_select() does.  Each of the
+   LWIP_EPOLL_INSTANCES instances takes a semaphore while it is open. */
+#ifndef LWIP_EPOLL
+#define LWIP_EPOLL                      0
+#endif
+
+#ifndef LWIP_EPOLL_INSTANCES
+#define LWIP_EPOLL_INSTANCES            1
+#endif
+
 
 #ifndef TCPIP_THREAD_PRIO
 #define TCPIP_THREAD_PRIO               1
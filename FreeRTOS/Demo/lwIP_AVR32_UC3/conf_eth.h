@@ -54,6 +54,9 @@
 /*! define stack size for SMTP Client task */
 #define lwipBASIC_SMTP_CLIENT_STACK_SIZE  256
 
+/*! define stack size for the checksum benchmark task */
+#define ethCHKSUM_BENCH_STACK_SIZE        256
+
 /*! define stack size for lwIP task */
 #define lwipINTERFACE_STACK_SIZE          512
 
@@ -69,6 +72,9 @@
 /*! define SMTP Client priority */
 #define ethSMTPCLIENT_PRIORITY            ( tskIDLE_PRIORITY + 5 )
 
+/*! define checksum benchmark priority, below the network tasks */
+#define ethCHKSUM_BENCH_PRIORITY          ( tskIDLE_PRIORITY + 1 )
+
 /*! define lwIP task priority */
 #define lwipINTERFACE_TASK_PRIORITY       ( configMAX_PRIORITIES - 1 )
 
@@ -0,0 +1,104 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+* Configuration of the kernel built into the list and scheduler benchmarks.
+*
+* The benchmarks drive list.c and tasks.c directly from a single host thread,
+* so the port layer is a set of empty functions and no hook, timer or tickless
+* feature is enabled.  configMAX_PRIORITIES and
+* configUSE_PORT_OPTIMISED_TASK_SELECTION can be set from the command line to
+* compare the two ready list selection methods.
+*----------------------------------------------------------*/
+
+#ifndef configMAX_PRIORITIES
+    #define configMAX_PRIORITIES                     ( 32 )
+#endif
+
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+    #define configUSE_PORT_OPTIMISED_TASK_SELECTION    1
+#endif
+
+#define configUSE_PREEMPTION                         1
+#define configUSE_TICKLESS_IDLE                      0
+#define configUSE_TIME_SLICING                       1
+#define configUSE_IDLE_HOOK                          0
+#define configUSE_TICK_HOOK                          0
+#define configTICK_RATE_HZ                           ( 1000 )
+#define configMINIMAL_STACK_SIZE                     ( ( unsigned short ) 70 )
+#define configMAX_TASK_NAME_LEN                      ( 12 )
+#define configUSE_TRACE_FACILITY                     0
+#define configUSE_16_BIT_TICKS                       0
+#define configIDLE_SHOULD_YIELD                      1
+#define configUSE_MUTEXES                            1
+#define configCHECK_FOR_STACK_OVERFLOW               0
+#define configUSE_RECURSIVE_MUTEXES                  0
+#define configQUEUE_REGISTRY_SIZE                    0
+#define configUSE_MALLOC_FAILED_HOOK                 0
+#define configUSE_APPLICATION_TASK_TAG               0
+#define configUSE_COUNTING_SEMAPHORES                0
+#define configUSE_QUEUE_SETS                         0
+#define configUSE_TASK_NOTIFICATIONS                 1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS      1
+#define configSUPPORT_STATIC_ALLOCATION              0
+#define configSUPPORT_DYNAMIC_ALLOCATION             1
+#define configINITIAL_TICK_COUNT                     ( ( TickType_t ) 0 )
+#define configUSE_TIMERS                             0
+#define configGENERATE_RUN_TIME_STATS                0
+#define configUSE_STATS_FORMATTING_FUNCTIONS         0
+#define configUSE_CO_ROUTINES                        0
+#define configNUMBER_OF_CORES                        1
+
+#define portUSING_MPU_WRAPPERS                       0
+#define configENABLE_MPU                             0
+#define portHAS_STACK_OVERFLOW_CHECKING              0
+#define portSTACK_GROWTH                             ( -1 )
+
+#define INCLUDE_vTaskPrioritySet                     0
+#define INCLUDE_uxTaskPriorityGet                    0
+#define INCLUDE_vTaskDelete                          0
+#define INCLUDE_vTaskSuspend                         1
+#define INCLUDE_vTaskDelayUntil                      0
+#define INCLUDE_vTaskDelay                           1
+#define INCLUDE_xTaskGetSchedulerState               0
+#define INCLUDE_xTaskGetIdleTaskHandle               0
+#define INCLUDE_xTaskAbortDelay                      0
+
+/* A failed assertion ends the run, as the timings after it would be of a
+ * kernel in an unknown state. */
+void vBenchmarkAssertFailed( const char * pcFile,
+                             int iLine );
+#define configASSERT( x )    do { if( ( x ) == 0 ) { vBenchmarkAssertFailed( __FILE__, __LINE__ ); } } while( 0 )
+
+/* Gives the benchmarks access to the kernel's ready and delayed lists. */
+#define portREMOVE_STATIC_QUALIFIER                  1
+
+#define configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES    0
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,195 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file benchmark_port.c */
+
+/* ===============================  INCLUDES  =============================== */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* C runtime includes. */
+#include <stdlib.h>
+
+/* ==========================  PORT LAYER FUNCTIONS  ======================== */
+
+/* The benchmarks call the kernel from one host thread and switch "tasks" only
+ * by calling vTaskSwitchContext() themselves, so yields, critical sections and
+ * interrupt masks have nothing to do. */
+
+void vFakePortYield( void )
+{
+}
+
+void vFakePortYieldFromISR( void )
+{
+}
+
+void vFakePortYieldWithinAPI( void )
+{
+}
+
+void vFakePortRestoreInterrupts( UBaseType_t uxInterruptState )
+{
+    ( void ) uxInterruptState;
+}
+
+uint32_t vFakePortDisableInterrupts( void )
+{
+    return 0;
+}
+
+void vFakePortEnableInterrupts( void )
+{
+}
+
+void vFakePortClearInterruptMaskFromISR( UBaseType_t uxNewMaskValue )
+{
+    ( void ) uxNewMaskValue;
+}
+
+void vFakePortClearInterruptMask( UBaseType_t uxNewMaskValue )
+{
+    ( void ) uxNewMaskValue;
+}
+
+UBaseType_t ulFakePortSetInterruptMaskFromISR( void )
+{
+    return 0;
+}
+
+UBaseType_t ulFakePortSetInterruptMask( void )
+{
+    return 0;
+}
+
+void vFakePortAssertIfInterruptPriorityInvalid( void )
+{
+}
+
+void vFakePortEnterCriticalSection( void )
+{
+}
+
+void vFakePortExitCriticalSection( void )
+{
+}
+
+void vPortCurrentTaskDying( void * pxTaskToDelete,
+                            volatile BaseType_t * pxPendYield )
+{
+    ( void ) pxTaskToDelete;
+    ( void ) pxPendYield;
+}
+
+void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+{
+    ( void ) xExpectedIdleTime;
+}
+
+void portSetupTCB_CB( void * tcb )
+{
+    ( void ) tcb;
+}
+
+void vFakePortGetISRLock( void )
+{
+}
+
+void vFakePortReleaseISRLock( void )
+{
+}
+
+void vFakePortGetTaskLock( void )
+{
+}
+
+void vFakePortReleaseTaskLock( void )
+{
+}
+
+void vFakePortAssertIfISR( void )
+{
+}
+
+BaseType_t vFakePortCheckIfInISR( void )
+{
+    return pdFALSE;
+}
+
+unsigned int vFakePortGetCoreID( void )
+{
+    return 0;
+}
+
+void vFakePortYieldCore( int xCoreID )
+{
+    ( void ) xCoreID;
+}
+
+portBASE_TYPE vFakePortEnterCriticalFromISR( void )
+{
+    return 0;
+}
+
+void vFakePortExitCriticalFromISR( portBASE_TYPE uxSavedInterruptState )
+{
+    ( void ) uxSavedInterruptState;
+}
+
+void vFakePortAllocateSecureContext( BaseType_t stackSize )
+{
+    ( void ) stackSize;
+}
+
+/* ===========================  PORTABLE.H FUNCTIONS  ======================= */
+
+void * pvPortMalloc( size_t xSize )
+{
+    return malloc( xSize );
+}
+
+void vPortFree( void * pv )
+{
+    free( pv );
+}
+
+StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
+                                     TaskFunction_t pxCode,
+                                     void * pvParameters )
+{
+    ( void ) pxCode;
+    ( void ) pvParameters;
+
+    return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler( void )
+{
+    return pdFALSE;
+}
+
+void vPortEndScheduler( void )
+{
+}
@@ -0,0 +1,329 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file scheduler_benchmark.c
+ *
+ * Times the list and scheduler operations whose cost grows with the number of
+ * tasks, with the real list.c and tasks.c built for the host:
+ *
+ * - vListInsert() into a sorted list used as a delayed list, as the length of
+ *   the list grows;
+ * - selecting the next task from the ready lists after a task of each priority
+ *   blocks, which is where the generic and the port optimised selection
+ *   methods differ;
+ * - xTaskIncrementTick() and the vTaskDelay() that puts each woken task back
+ *   in the delayed list, with up to thousands of delayed tasks.
+ *
+ * The kernel is driven from one host thread.  The scheduler is marked as
+ * running without being started, and a "task" runs only in the sense that the
+ * benchmark sets pxCurrentTCB to it before calling an API function.
+ */
+
+/* Needed for clock_gettime() with -std=c99. */
+#define _POSIX_C_SOURCE    199309L
+
+/* ===============================  INCLUDES  =============================== */
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "list.h"
+
+/* C runtime includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* =================================  MACROS  =============================== */
+
+/* The delayed tasks wake after a period of between 1 and this many ticks. */
+#define benchMAX_PERIOD          ( 1000U )
+
+/* The number of items moved through the list at each list length. */
+#define benchINSERTIONS          ( 200000UL )
+
+/* The number of block and unblock cycles at each priority. */
+#define benchSWITCHES            ( 200000UL )
+
+/* The number of ticks processed at each number of delayed tasks. */
+#define benchTICKS               ( 20000UL )
+
+/* The largest list, and the most delayed tasks, benchmarked. */
+#define benchMAX_LIST_LENGTH     ( 4096U )
+
+/* The priority of the delayed tasks in the tick benchmark. */
+#define benchDELAYED_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+
+/* ============================  GLOBAL VARIABLES =========================== */
+
+/* Kernel state made visible by portREMOVE_STATIC_QUALIFIER. */
+extern TaskHandle_t volatile pxCurrentTCB;
+extern List_t pxReadyTasksLists[ configMAX_PRIORITIES ];
+extern volatile BaseType_t xSchedulerRunning;
+
+static const UBaseType_t uxListLengths[] = { 16U, 64U, 256U, 1024U, 4096U };
+static const UBaseType_t uxDelayedTaskCounts[] = { 16U, 256U, 1024U, 4096U };
+
+static ListItem_t xItems[ benchMAX_LIST_LENGTH ];
+static TickType_t xPeriods[ benchMAX_LIST_LENGTH ];
+static TaskHandle_t xDelayedTasks[ benchMAX_LIST_LENGTH ];
+
+/* Stands in for the idle task, the task that runs when every other is
+ * blocked. */
+static TaskHandle_t xIdleTask = NULL;
+
+static uint32_t ulRandomState = 0x12345678UL;
+
+/* ==========================  CALLBACK FUNCTIONS  ========================== */
+
+void vBenchmarkAssertFailed( const char * pcFile,
+                             int iLine )
+{
+    printf( "configASSERT failed at %s:%d\n", pcFile, iLine );
+    exit( EXIT_FAILURE );
+}
+
+/* ============================  HELPER FUNCTIONS  ========================== */
+
+static void prvTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    /* Never runs, the benchmark only needs the task's TCB. */
+    for( ; ; )
+    {
+    }
+}
+
+static uint64_t prvNanoseconds( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+
+static TickType_t prvRandomPeriod( void )
+{
+    /* xorshift32, so every run and every build sees the same periods. */
+    ulRandomState ^= ulRandomState << 13;
+    ulRandomState ^= ulRandomState >> 17;
+    ulRandomState ^= ulRandomState << 5;
+
+    return ( TickType_t ) ( 1U + ( ulRandomState % benchMAX_PERIOD ) );
+}
+
+static TaskHandle_t prvCreateTask( UBaseType_t uxPriority )
+{
+    TaskHandle_t xTask = NULL;
+
+    if( xTaskCreate( prvTask, "bench", configMINIMAL_STACK_SIZE, NULL, uxPriority, &xTask ) != pdPASS )
+    {
+        printf( "Could not create a task\n" );
+        exit( EXIT_FAILURE );
+    }
+
+    return xTask;
+}
+
+/* ============================  BENCHMARKS  ================================ */
+
+/* Keeps uxLength items in a sorted list the way the kernel keeps its delayed
+ * list: the item due first is removed, which moves time on to its wake time,
+ * and is inserted again one period later. */
+static void prvBenchmarkListInsert( UBaseType_t uxLength )
+{
+    List_t xList;
+    ListItem_t * pxItem;
+    TickType_t xNow;
+    UBaseType_t ux;
+    uint32_t ul;
+    uint64_t ullStart, ullElapsed;
+
+    vListInitialise( &xList );
+
+    for( ux = 0; ux < uxLength; ux++ )
+    {
+        vListInitialiseItem( &( xItems[ ux ] ) );
+        xPeriods[ ux ] = prvRandomPeriod();
+        listSET_LIST_ITEM_VALUE( &( xItems[ ux ] ), xPeriods[ ux ] );
+        listSET_LIST_ITEM_OWNER( &( xItems[ ux ] ), &( xPeriods[ ux ] ) );
+        vListInsert( &xList, &( xItems[ ux ] ) );
+    }
+
+    ullStart = prvNanoseconds();
+
+    for( ul = 0; ul < benchINSERTIONS; ul++ )
+    {
+        pxItem = listGET_HEAD_ENTRY( &xList );
+        xNow = listGET_LIST_ITEM_VALUE( pxItem );
+        ( void ) uxListRemove( pxItem );
+        listSET_LIST_ITEM_VALUE( pxItem, xNow + *( ( TickType_t * ) listGET_LIST_ITEM_OWNER( pxItem ) ) );
+        vListInsert( &xList, pxItem );
+    }
+
+    ullElapsed = prvNanoseconds() - ullStart;
+
+    printf( "%-12lu %14.1f\n",
+            ( unsigned long ) uxLength,
+            ( double ) ullElapsed / ( double ) benchINSERTIONS );
+}
+
+/* Unblocks a task of uxPriority and blocks it again, selecting the next task
+ * to run each time.  With the generic method the selection after the task
+ * blocks searches every priority below uxPriority down to the idle task. */
+static void prvBenchmarkReadySelection( UBaseType_t uxPriority )
+{
+    TaskHandle_t xTask;
+    uint32_t ul;
+    uint64_t ullStart, ullElapsed;
+
+    xTask = prvCreateTask( uxPriority );
+    vTaskSwitchContext();
+    vTaskSuspend( xTask );
+    vTaskSwitchContext();
+
+    ullStart = prvNanoseconds();
+
+    for( ul = 0; ul < benchSWITCHES; ul++ )
+    {
+        vTaskResume( xTask );
+        vTaskSwitchContext();
+        vTaskSuspend( NULL );
+        vTaskSwitchContext();
+    }
+
+    ullElapsed = prvNanoseconds() - ullStart;
+
+    configASSERT( pxCurrentTCB == xIdleTask );
+
+    printf( "%-12lu %14.1f\n",
+            ( unsigned long ) uxPriority,
+            ( double ) ullElapsed / ( double ) benchSWITCHES );
+}
+
+/* Delays uxTasks tasks for random periods, then processes ticks.  After each
+ * tick every task the tick woke delays itself again for its period, as a
+ * periodic task would. */
+static void prvBenchmarkTicks( UBaseType_t uxTasks )
+{
+    List_t * const pxReadyList = &( pxReadyTasksLists[ benchDELAYED_PRIORITY ] );
+    UBaseType_t ux;
+    uint32_t ul, ulDelays = 0;
+    uint64_t ullStart, ullTick, ullTicks = 0, ullMaxTick = 0, ullDelays = 0;
+
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        xDelayedTasks[ ux ] = prvCreateTask( benchDELAYED_PRIORITY );
+        pxCurrentTCB = xDelayedTasks[ ux ];
+        vTaskSetThreadLocalStoragePointer( NULL, 0, ( void * ) ( uintptr_t ) prvRandomPeriod() );
+        vTaskDelay( ( TickType_t ) ( uintptr_t ) pvTaskGetThreadLocalStoragePointer( NULL, 0 ) );
+    }
+
+    vTaskSwitchContext();
+
+    for( ul = 0; ul < benchTICKS; ul++ )
+    {
+        ullStart = prvNanoseconds();
+        ( void ) xTaskIncrementTick();
+        ullTick = prvNanoseconds() - ullStart;
+
+        ullTicks += ullTick;
+
+        if( ullTick > ullMaxTick )
+        {
+            ullMaxTick = ullTick;
+        }
+
+        ullStart = prvNanoseconds();
+
+        while( listLIST_IS_EMPTY( pxReadyList ) == pdFALSE )
+        {
+            pxCurrentTCB = listGET_OWNER_OF_HEAD_ENTRY( pxReadyList );
+            vTaskDelay( ( TickType_t ) ( uintptr_t ) pvTaskGetThreadLocalStoragePointer( NULL, 0 ) );
+            ulDelays++;
+        }
+
+        ullDelays += prvNanoseconds() - ullStart;
+
+        vTaskSwitchContext();
+    }
+
+    configASSERT( pxCurrentTCB == xIdleTask );
+
+    printf( "%-12lu %14.1f %14lu %14.1f\n",
+            ( unsigned long ) uxTasks,
+            ( double ) ullTicks / ( double ) benchTICKS,
+            ( unsigned long ) ullMaxTick,
+            ( ulDelays > 0 ) ? ( double ) ullDelays / ( double ) ulDelays : 0.0 );
+
+    /* Take this run's tasks out of the delayed lists so the next run starts
+     * with only the idle task. */
+    for( ux = 0; ux < uxTasks; ux++ )
+    {
+        vTaskSuspend( xDelayedTasks[ ux ] );
+    }
+}
+
+/* ================================  MAIN  ================================== */
+
+int main( void )
+{
+    UBaseType_t ux;
+
+    printf( "FreeRTOS list and scheduler benchmark, %s task selection, %d priorities\n",
+            ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 ) ? "port optimised" : "generic",
+            ( int ) configMAX_PRIORITIES );
+
+    printf( "\n%-12s %14s\n", "list length", "ns per insert" );
+
+    for( ux = 0; ux < ( sizeof( uxListLengths ) / sizeof( uxListLengths[ 0 ] ) ); ux++ )
+    {
+        prvBenchmarkListInsert( uxListLengths[ ux ] );
+    }
+
+    /* The idle task is created before the scheduler is marked as running, so
+     * it becomes pxCurrentTCB. */
+    xIdleTask = prvCreateTask( tskIDLE_PRIORITY );
+    xSchedulerRunning = pdTRUE;
+
+    printf( "\n%-12s %14s\n", "priority", "ns per cycle" );
+
+    for( ux = 1; ux < configMAX_PRIORITIES; ux *= 2 )
+    {
+        prvBenchmarkReadySelection( ux );
+    }
+
+    prvBenchmarkReadySelection( configMAX_PRIORITIES - 1 );
+
+    printf( "\n%-12s %14s %14s %14s\n", "tasks", "ns per tick", "max tick ns", "ns per delay" );
+
+    for( ux = 0; ux < ( sizeof( uxDelayedTaskCounts ) / sizeof( uxDelayedTaskCounts[ 0 ] ) ); ux++ )
+    {
+        prvBenchmarkTicks( uxDelayedTaskCounts[ ux ] );
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,406 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+/*! @file cost_multiple_priorities_no_timeslice_utest.c */
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Task includes */
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "event_groups.h"
+#include "queue.h"
+
+/* Test includes. */
+#include "unity.h"
+#include "unity_memory.h"
+#include "../global_vars.h"
+#include "../smp_utest_common.h"
+
+/* Mock includes. */
+#include "mock_timers.h"
+#include "mock_fake_assert.h"
+#include "mock_fake_port.h"
+
+/* ============================  Unity Fixtures  ============================ */
+/*! called before each testcase */
+void setUp( void )
+{
+    commonSetUp();
+}
+
+/*! called after each testcase */
+void tearDown( void )
+{
+    commonTearDown();
+}
+
+/*! called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/*! called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return numFailures;
+}
+
+/* ============================  FreeRTOS static allocate function  ============================ */
+
+void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                    StackType_t ** ppxIdleTaskStackBuffer,
+                                    uint32_t * pulIdleTaskStackSize )
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &( xIdleTaskTCB );
+    *ppxIdleTaskStackBuffer = &( uxIdleTaskStack[ 0 ] );
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetPassiveIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                           StackType_t ** ppxIdleTaskStackBuffer,
+                                           uint32_t * pulIdleTaskStackSize,
+                                           BaseType_t xPassiveIdleTaskIndex )
+{
+    static StaticTask_t xIdleTaskTCBs[ configNUMBER_OF_CORES - 1 ];
+    static StackType_t uxIdleTaskStacks[ configNUMBER_OF_CORES - 1 ][ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &( xIdleTaskTCBs[ xPassiveIdleTaskIndex ] );
+    *ppxIdleTaskStackBuffer = &( uxIdleTaskStacks[ xPassiveIdleTaskIndex ][ 0 ] );
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+/* ==============================  Helper functions  ============================== */
+
+/* Verify that the only portYIELD_CORE() call made was to xCoreID, and that the
+ * calling core did not yield itself. */
+static void prvVerifySingleYieldCore( const PortCallCounts_t * pxCounts,
+                                      BaseType_t xCoreID )
+{
+    BaseType_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        TEST_ASSERT_EQUAL_INT_MESSAGE( ( i == xCoreID ) ? 1 : 0, pxCounts->uxYieldCore[ i ], "Unexpected portYIELD_CORE() count" );
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE( 0, pxCounts->uxYield, "Unexpected portYIELD() count" );
+}
+
+/* Return the number of portYIELD_CORE() calls made to all the cores. */
+static UBaseType_t prvTotalYieldCore( const PortCallCounts_t * pxCounts )
+{
+    UBaseType_t uxTotal = 0;
+    BaseType_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        uxTotal += pxCounts->uxYieldCore[ i ];
+    }
+
+    return uxTotal;
+}
+
+/* ==============================  Test Cases  ============================== */
+
+/*
+ * The test cases in this file count the port calls an operation makes, so that
+ * a change which adds an inter-core interrupt or a critical section to a
+ * common path fails a test.  The counts are reset after the scenario is set up,
+ * and read before the result is verified, as verifySmpTask() enters critical
+ * sections of its own.
+ */
+
+/**
+ * @brief Resuming a task from core 0 interrupts only the idle core.
+ *
+ * A task of equal priority is created for each core and the task on core 1 is
+ * suspended, so that core 1 runs its idle task.  The task is then resumed from
+ * core 0.  Core 1 is the only core running a task of lower priority, so it is
+ * the only core that shall be interrupted, and core 0 shall not yield.
+ *
+ * #define configRUN_MULTIPLE_PRIORITIES                    1
+ * #define configUSE_TIME_SLICING                           0
+ * #define configUSE_CORE_AFFINITY                          1
+ * #define configUSE_TASK_PREEMPTION_DISABLE                1
+ * #define configNUMBER_OF_CORES                            (N > 1)
+ *
+ * Resume task (T1) from core 0
+ *
+ * Expected port calls
+ * portYIELD_CORE( 1 )          1
+ * portYIELD_CORE( others )     0
+ * portYIELD()                  0
+ * portENTER_CRITICAL()         1
+ */
+void test_cost_resume_task_on_idle_core( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    PortCallCounts_t xCounts;
+    uint32_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    vTaskSuspend( xTaskHandles[ 1 ] );
+    verifySmpTask( &xTaskHandles[ 1 ], eSuspended, -1 );
+
+    vResetPortCallCounts();
+    vTaskResume( xTaskHandles[ 1 ] );
+    vGetPortCallCounts( &xCounts );
+
+    prvVerifySingleYieldCore( &xCounts, 1 );
+    TEST_ASSERT_EQUAL_INT( 1, xCounts.uxEnterCritical );
+
+    verifySmpTask( &xTaskHandles[ 1 ], eRunning, 1 );
+}
+
+/**
+ * @brief Resuming a task from an ISR on core 0 interrupts only the idle core.
+ *
+ * As test_cost_resume_task_on_idle_core(), but the task is resumed with
+ * xTaskResumeFromISR(), which shall not request a yield of the calling core or
+ * enter the task level critical section.
+ *
+ * Expected port calls
+ * portYIELD_CORE( 1 )          1
+ * portYIELD_CORE( others )     0
+ * portENTER_CRITICAL()         0
+ */
+void test_cost_resume_task_on_idle_core_from_isr( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    PortCallCounts_t xCounts;
+    BaseType_t xReturn;
+    uint32_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    vTaskSuspend( xTaskHandles[ 1 ] );
+    verifySmpTask( &xTaskHandles[ 1 ], eSuspended, -1 );
+
+    vFakePortAssertIfInterruptPriorityInvalid_Ignore();
+
+    vResetPortCallCounts();
+    xReturn = xTaskResumeFromISR( xTaskHandles[ 1 ] );
+    vGetPortCallCounts( &xCounts );
+
+    TEST_ASSERT_EQUAL( pdFALSE, xReturn );
+    prvVerifySingleYieldCore( &xCounts, 1 );
+    TEST_ASSERT_EQUAL_INT( 0, xCounts.uxEnterCritical );
+
+    verifySmpTask( &xTaskHandles[ 1 ], eRunning, 1 );
+}
+
+/**
+ * @brief Resuming a task of lower priority than all the running tasks does
+ * not interrupt any core.
+ *
+ * A task of priority 2 is created for each core, and an additional task of
+ * priority 1 is created and suspended.  Resuming it shall only add it to the
+ * ready list.
+ *
+ * Expected port calls
+ * portYIELD_CORE( all )        0
+ * portYIELD()                  0
+ * portENTER_CRITICAL()         1
+ */
+void test_cost_resume_lower_priority_task( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES + 1 ] = { NULL };
+    PortCallCounts_t xCounts;
+    uint32_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 2, &xTaskHandles[ i ] );
+    }
+
+    xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+
+    vTaskStartScheduler();
+
+    vTaskSuspend( xTaskHandles[ configNUMBER_OF_CORES ] );
+    verifySmpTask( &xTaskHandles[ configNUMBER_OF_CORES ], eSuspended, -1 );
+
+    vResetPortCallCounts();
+    vTaskResume( xTaskHandles[ configNUMBER_OF_CORES ] );
+    vGetPortCallCounts( &xCounts );
+
+    TEST_ASSERT_EQUAL_INT( 0, prvTotalYieldCore( &xCounts ) );
+    TEST_ASSERT_EQUAL_INT( 0, xCounts.uxYield );
+    TEST_ASSERT_EQUAL_INT( 1, xCounts.uxEnterCritical );
+
+    verifySmpTask( &xTaskHandles[ configNUMBER_OF_CORES ], eReady, -1 );
+}
+
+/**
+ * @brief Resuming a high priority task interrupts only the core running the
+ * lowest priority task.
+ *
+ * A task of priority 1 and a task of priority 2 for each remaining core are
+ * created, together with a task of priority 3 that is suspended before the
+ * scheduler is started.  The priority 3 task is resumed from a core running a
+ * priority 2 task, so only the core running the priority 1 task shall be
+ * interrupted.
+ *
+ * Expected port calls
+ * portYIELD_CORE( low core )   1
+ * portYIELD_CORE( others )     0
+ * portYIELD()                  0
+ * portENTER_CRITICAL()         1
+ */
+void test_cost_resume_higher_priority_task_preempts_lowest_core( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES + 1 ] = { NULL };
+    PortCallCounts_t xCounts;
+    BaseType_t xLowCore;
+    uint32_t i;
+
+    for( i = 0; i < ( configNUMBER_OF_CORES - 1 ); i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 2, &xTaskHandles[ i ] );
+    }
+
+    xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ configNUMBER_OF_CORES - 1 ] );
+    xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 3, &xTaskHandles[ configNUMBER_OF_CORES ] );
+    vTaskSuspend( xTaskHandles[ configNUMBER_OF_CORES ] );
+
+    vTaskStartScheduler();
+
+    xLowCore = xTaskHandles[ configNUMBER_OF_CORES - 1 ]->xTaskRunState;
+    TEST_ASSERT_TRUE( ( xLowCore >= 0 ) && ( xLowCore < configNUMBER_OF_CORES ) );
+
+    /* Call from any other core, all of which run a priority 2 task. */
+    vSetCurrentCore( ( xLowCore + 1 ) % configNUMBER_OF_CORES );
+
+    vResetPortCallCounts();
+    vTaskResume( xTaskHandles[ configNUMBER_OF_CORES ] );
+    vGetPortCallCounts( &xCounts );
+
+    vSetCurrentCore( 0 );
+
+    prvVerifySingleYieldCore( &xCounts, xLowCore );
+    TEST_ASSERT_EQUAL_INT( 1, xCounts.uxEnterCritical );
+
+    verifySmpTask( &xTaskHandles[ configNUMBER_OF_CORES ], eRunning, xLowCore );
+    verifySmpTask( &xTaskHandles[ configNUMBER_OF_CORES - 1 ], eReady, -1 );
+}
+
+/**
+ * @brief Raising the priority of a ready task interrupts exactly one core.
+ *
+ * A task of priority 1 is created for each core, and an additional task of
+ * priority 1 is left in the ready state.  Raising its priority from core 0
+ * shall preempt one of the running tasks, with a single yield request.
+ *
+ * Expected port calls
+ * portYIELD_CORE() + portYIELD()    1
+ * portENTER_CRITICAL()              1
+ */
+void test_cost_raise_priority_of_ready_task( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES + 1 ] = { NULL };
+    PortCallCounts_t xCounts;
+    uint32_t i;
+
+    for( i = 0; i < ( configNUMBER_OF_CORES + 1 ); i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    verifySmpTask( &xTaskHandles[ configNUMBER_OF_CORES ], eReady, -1 );
+
+    vResetPortCallCounts();
+    vTaskPrioritySet( xTaskHandles[ configNUMBER_OF_CORES ], 2 );
+    vGetPortCallCounts( &xCounts );
+
+    TEST_ASSERT_EQUAL_INT( 1, prvTotalYieldCore( &xCounts ) + xCounts.uxYield );
+    TEST_ASSERT_EQUAL_INT( 1, xCounts.uxEnterCritical );
+
+    TEST_ASSERT_TRUE( xTaskHandles[ configNUMBER_OF_CORES ]->xTaskRunState >= 0 );
+}
+
+/**
+ * @brief A tick that unblocks a task delayed on core 1 interrupts only core 1.
+ *
+ * A task of equal priority is created for each core and the task on core 1
+ * delays itself for one tick, so that core 1 runs its idle task.  The next
+ * tick, processed by core 0, shall interrupt core 1 and shall not request a
+ * context switch on core 0.
+ *
+ * Expected port calls
+ * portYIELD_CORE( 1 )            1
+ * portYIELD_CORE( others )       0
+ * portYIELD()                    0
+ * portENTER_CRITICAL()           0
+ * portENTER_CRITICAL_FROM_ISR()  1, made by xTaskIncrementTick_helper()
+ */
+void test_cost_tick_unblocks_task_on_other_core( void )
+{
+    TaskHandle_t xTaskHandles[ configNUMBER_OF_CORES ] = { NULL };
+    PortCallCounts_t xCounts;
+    uint32_t i;
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        xTaskCreate( vSmpTestTask, "SMP Task", configMINIMAL_STACK_SIZE, NULL, 1, &xTaskHandles[ i ] );
+    }
+
+    vTaskStartScheduler();
+
+    vSetCurrentCore( 1 );
+    vTaskDelay( 1 );
+    vSetCurrentCore( 0 );
+    verifySmpTask( &xTaskHandles[ 1 ], eBlocked, -1 );
+
+    vResetPortCallCounts();
+    xTaskIncrementTick_helper();
+    vGetPortCallCounts( &xCounts );
+
+    prvVerifySingleYieldCore( &xCounts, 1 );
+    TEST_ASSERT_EQUAL_INT( 0, xCounts.uxEnterCritical );
+    TEST_ASSERT_EQUAL_INT( 1, xCounts.uxEnterCriticalFromISR );
+
+    verifySmpTask( &xTaskHandles[ 1 ], eRunning, 1 );
+}
@@ -79,6 +79,9 @@ static BaseType_t xCurrentCoreId = 0;
 static BaseType_t xIsrLockCount[ configNUMBER_OF_CORES ] = { 0 };
 static BaseType_t xTaskLockCount[ configNUMBER_OF_CORES ] = { 0 };
 
+/* The port calls made since vResetPortCallCounts() was called. */
+static PortCallCounts_t xPortCallCounts;
+
 /* ==========================  EXTERN FUNCTIONS  ========================== */
 
 extern void vTaskEnterCritical( void );
@@ -129,6 +132,8 @@ void vFakePortYieldCoreStubCallback( int xCoreID,
     BaseType_t xPreviousCoreId = xCurrentCoreId;
     int i;
 
+    xPortCallCounts.uxYieldCore[ xCoreID ]++;
+
     /* Check if the lock is acquired by any core. */
     for( i = 0; i < configNUMBER_OF_CORES; i++ )
     {
@@ -156,11 +161,13 @@ void vFakePortYieldCoreStubCallback( int xCoreID,
 
 void vFakePortYieldStubCallback( int cmock_num_calls )
 {
+    xPortCallCounts.uxYield++;
     vTaskSwitchContext( xCurrentCoreId );
 }
 
 void vFakePortEnterCriticalSectionCallback( int cmock_num_calls )
 {
+    xPortCallCounts.uxEnterCritical++;
     vTaskEnterCritical();
 }
 
@@ -269,6 +276,7 @@ portBASE_TYPE vFakePortEnterCriticalFromISRCallback( int cmock_num_calls )
 {
     portBASE_TYPE xSavedInterruptState;
 
+    xPortCallCounts.uxEnterCriticalFromISR++;
     xSavedInterruptState = vTaskEnterCriticalFromISR();
     return xSavedInterruptState;
 }
@@ -340,6 +348,7 @@ void commonSetUp( void )
     xCurrentCoreId = 0;
     memset( xTaskLockCount, 0x00, sizeof( xTaskLockCount ) );
     memset( xIsrLockCount, 0x00, sizeof( xIsrLockCount ) );
+    vResetPortCallCounts();
 }
 
 void commonTearDown( void )
@@ -381,6 +390,16 @@ void verifyIdleTask( BaseType_t index,
     TEST_ASSERT_EQUAL_INT_MESSAGE( eRunning, xTaskDetails.eCurrentState, "Idle Task Verification Failed: Incorrect eCurrentState" );
 }
 
+void vResetPortCallCounts( void )
+{
+    memset( &xPortCallCounts, 0x00, sizeof( xPortCallCounts ) );
+}
+
+void vGetPortCallCounts( PortCallCounts_t * pxCounts )
+{
+    *pxCounts = xPortCallCounts;
+}
+
 /* Helper function to simulate calling xTaskIncrementTick in critical section. */
 void xTaskIncrementTick_helper( void )
 {
@@ -42,6 +42,19 @@
 #include "task.h"
 #include "global_vars.h"
 
+/* ============================  TYPE DEFINITIONS  ============================ */
+
+/**
+ * @brief Port calls counted by the callbacks in smp_utest_common.c.
+ */
+typedef struct PortCallCounts
+{
+    UBaseType_t uxYieldCore[ configNUMBER_OF_CORES ]; /* portYIELD_CORE() calls for each core. */
+    UBaseType_t uxYield;                              /* portYIELD() calls, which yield the calling core. */
+    UBaseType_t uxEnterCritical;                      /* portENTER_CRITICAL() calls. */
+    UBaseType_t uxEnterCriticalFromISR;               /* portENTER_CRITICAL_FROM_ISR() calls. */
+} PortCallCounts_t;
+
 /* ==========================  CALLBACK FUNCTIONS =========================== */
 
 /**
@@ -106,6 +119,16 @@ void vCreateStaticTestTask( TaskHandle_t xTaskHandle,
                             BaseType_t xTaskRunState,
                             BaseType_t xTaskIsIdle );
 
+/**
+ * @brief Set the port call counts to zero.
+ */
+void vResetPortCallCounts( void );
+
+/**
+ * @brief Get the port calls made since vResetPortCallCounts() was called.
+ */
+void vGetPortCallCounts( PortCallCounts_t * pxCounts );
+
 #if ( configUSE_CORE_AFFINITY == 1 )
     void vCreateStaticTestTaskAffinity( TaskHandle_t xTaskHandle,
                                         UBaseType_t uxCoreAffinityMask,
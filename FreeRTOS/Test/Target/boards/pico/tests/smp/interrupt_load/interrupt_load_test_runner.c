@@ -0,0 +1,167 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file interrupt_load_test_runner.c
+ * @brief The implementation of main function to start test runner task.
+ *
+ * Procedure:
+ *   - Initialize environment.
+ *   - Run the test case.
+ */
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Unit testing support functions. */
+#include "unity.h"
+
+/* Pico includes. */
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The hardware alarm of core 0.  Core n uses the alarm after it.  The
+ * default alarm pool of the SDK uses alarm 3.
+ */
+#define TEST_IRQ_LOAD_FIRST_ALARM    ( 0U )
+
+/*-----------------------------------------------------------*/
+
+static void prvTestRunnerTask( void * pvParameters );
+
+static void prvAlarmCallback( uint uxAlarmNum );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The period of the interrupt of each core in microseconds.
+ */
+static uint32_t ulIrqPeriodUs[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief The time the next interrupt of each core is due at.
+ */
+static uint64_t ullIrqDueTime[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Whether the interrupt of each core is to be rearmed.
+ */
+static volatile bool xIrqRunning[ configNUMBER_OF_CORES ];
+
+/*-----------------------------------------------------------*/
+
+static void prvTestRunnerTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    /* Run test case. */
+    vRunInterruptLoadTest();
+
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAlarmCallback( uint uxAlarmNum )
+{
+    uint uxCore = get_core_num();
+
+    vTestIrqLoadHandler( ( uint32_t ) ullIrqDueTime[ uxCore ] );
+
+    if( xIrqRunning[ uxCore ] )
+    {
+        /* Keep to the period from the due times, skipping the interrupts that
+         * are already overdue. */
+        do
+        {
+            ullIrqDueTime[ uxCore ] += ulIrqPeriodUs[ uxCore ];
+        } while( hardware_alarm_set_target( uxAlarmNum, from_us_since_boot( ullIrqDueTime[ uxCore ] ) ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTestIrqLoadStart( uint32_t ulPeriodUs )
+{
+    uint uxCore = get_core_num();
+    uint uxAlarmNum = TEST_IRQ_LOAD_FIRST_ALARM + uxCore;
+
+    ulIrqPeriodUs[ uxCore ] = ulPeriodUs;
+    ullIrqDueTime[ uxCore ] = time_us_64();
+    xIrqRunning[ uxCore ] = true;
+
+    /* The alarm interrupt is enabled on the calling core. */
+    hardware_alarm_claim( uxAlarmNum );
+    hardware_alarm_set_callback( uxAlarmNum, prvAlarmCallback );
+
+    do
+    {
+        ullIrqDueTime[ uxCore ] += ulPeriodUs;
+    } while( hardware_alarm_set_target( uxAlarmNum, from_us_since_boot( ullIrqDueTime[ uxCore ] ) ) );
+}
+/*-----------------------------------------------------------*/
+
+void vTestIrqLoadStop( void )
+{
+    uint uxCore = get_core_num();
+    uint uxAlarmNum = TEST_IRQ_LOAD_FIRST_ALARM + uxCore;
+
+    xIrqRunning[ uxCore ] = false;
+
+    hardware_alarm_cancel( uxAlarmNum );
+    hardware_alarm_set_callback( uxAlarmNum, NULL );
+    hardware_alarm_unclaim( uxAlarmNum );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTestPerfGetCounter( void )
+{
+    /* The 1 MHz timer of the RP2040 is shared by both cores, and its low word
+     * is the one the alarms compare with. */
+    return time_us_32();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulTestPerfGetCounterHz( void )
+{
+    return 1000000U;
+}
+/*-----------------------------------------------------------*/
+
+void vRunTest( void )
+{
+    /* The test runner prints the results, which needs a larger stack. */
+    xTaskCreate( prvTestRunnerTask,
+                 "testRunner",
+                 configMINIMAL_STACK_SIZE * 4,
+                 NULL,
+                 configMAX_PRIORITIES - 1,
+                 NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,922 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file interrupt_load.c
+ * @brief Stress the SMP critical sections and queues with a periodic high rate
+ * interrupt on every core, and measure the interrupt latency.
+ *
+ * Procedure:
+ *   - Baseline: the periodic interrupt fires on every core every
+ *     TEST_IRQ_LOAD_PERIOD_US while only the test runner and idle tasks run.
+ *   - Critical sections: a task pinned to each core enters and leaves a
+ *     critical section in a loop, in which it increments a shared counter and
+ *     spins for TEST_IRQ_LOAD_CRITICAL_WORK iterations.  The interrupt handler
+ *     also increments the counter in a critical section.
+ *   - Queues: a producer pinned to each core sends to a consumer pinned to the
+ *     next core, and the interrupt handler sends the time it ran at to a task
+ *     through a queue of its own.
+ *   Each measurement runs for TEST_IRQ_LOAD_WINDOW_MS.
+ * Expected:
+ *   - Every core takes at least half of the interrupts that were due.
+ *   - The worst interrupt latency of each core is at most
+ *     TEST_IRQ_LOAD_MAX_LATENCY_US.
+ *   - No increment of the shared counter is lost, and every item that was
+ *     sent to a queue was either received or is still in the queue.
+ *   - The figures are printed per core as lines of the form:
+ *     PERF {"kernel":"V11.0.0","test":"irq_latency","load":"critical",...}
+ *     Times are in nanoseconds, measured with ulTestPerfGetCounter().
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Unit testing support functions. */
+#include "unity.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Timeout for each measurement.
+ */
+#define TEST_TIMEOUT_MS    ( 10000U )
+
+/**
+ * @brief Period of the interrupt on each core in microseconds.
+ */
+#ifndef TEST_IRQ_LOAD_PERIOD_US
+    #define TEST_IRQ_LOAD_PERIOD_US    ( 50U )
+#endif
+
+/**
+ * @brief Time in milliseconds each measurement runs for.
+ */
+#ifndef TEST_IRQ_LOAD_WINDOW_MS
+    #define TEST_IRQ_LOAD_WINDOW_MS    ( 1000U )
+#endif
+
+/**
+ * @brief Number of samples kept per core and figure.  The percentiles are
+ * those of the last samples, the worst case is that of all of them.
+ */
+#ifndef TEST_IRQ_LOAD_SAMPLES
+    #define TEST_IRQ_LOAD_SAMPLES    ( 500U )
+#endif
+
+/**
+ * @brief Number of iterations the tasks spin for inside a critical section.
+ */
+#ifndef TEST_IRQ_LOAD_CRITICAL_WORK
+    #define TEST_IRQ_LOAD_CRITICAL_WORK    ( 100U )
+#endif
+
+/**
+ * @brief Length of the queues.
+ */
+#ifndef TEST_IRQ_LOAD_QUEUE_LENGTH
+    #define TEST_IRQ_LOAD_QUEUE_LENGTH    ( 8U )
+#endif
+
+/**
+ * @brief The longest interrupt latency in microseconds that the test accepts.
+ */
+#ifndef TEST_IRQ_LOAD_MAX_LATENCY_US
+    #define TEST_IRQ_LOAD_MAX_LATENCY_US    ( 1000U )
+#endif
+
+/**
+ * @brief Priority of the loading tasks, below the test runner task.
+ */
+#define TEST_IRQ_LOAD_PRIORITY    ( configMAX_PRIORITIES - 2 )
+
+/**
+ * @brief Number of task handles kept for clean-up.
+ */
+#define TEST_IRQ_LOAD_MAX_TASKS    ( ( 2 * configNUMBER_OF_CORES ) + 1 )
+
+/**
+ * @brief Nop operation for busy looping.
+ */
+#ifdef portNOP
+    #define TEST_NOP    portNOP
+#else
+    #define TEST_NOP()    __asm volatile ( "nop" )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Samples of one figure.
+ */
+typedef struct SampleSet
+{
+    uint32_t ulSamples[ TEST_IRQ_LOAD_SAMPLES ]; /**< The last samples. */
+    uint32_t ulTotal;                            /**< Number of samples taken. */
+    uint32_t ulWorst;                            /**< The largest sample taken. */
+} SampleSet_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Task function to start or stop the interrupt on the core it runs on.
+ */
+static void prvIrqControlTask( void * pvParameters );
+
+/**
+ * @brief Task function which enters and leaves critical sections.
+ */
+static void prvCriticalSectionTask( void * pvParameters );
+
+/**
+ * @brief Task function of a producer.
+ */
+static void prvProducerTask( void * pvParameters );
+
+/**
+ * @brief Task function of a consumer.
+ */
+static void prvConsumerTask( void * pvParameters );
+
+/**
+ * @brief Task function which receives the items sent by the interrupt handler.
+ */
+static void prvIsrConsumerTask( void * pvParameters );
+
+/**
+ * @brief Create a loading task and keep its handle for clean-up.
+ */
+static void prvCreateTask( TaskFunction_t pxTaskCode,
+                           void * pvParameters,
+                           UBaseType_t uxCoreAffinityMask );
+
+/**
+ * @brief Wait for ulCount tasks to notify the test runner task.
+ */
+static void prvWaitForTasks( uint32_t ulCount );
+
+/**
+ * @brief Delete the tasks created by prvCreateTask().
+ */
+static void prvDeleteTasks( void );
+
+/**
+ * @brief Start or stop the interrupt on every core.
+ */
+static void prvSetIrqLoad( BaseType_t xEnable );
+
+/**
+ * @brief Run the interrupt load, and the tasks already created, for
+ * TEST_IRQ_LOAD_WINDOW_MS.  Returns the counts the measurement took.
+ */
+static uint32_t prvRunMeasurement( uint32_t ulTasksToWaitFor );
+
+/**
+ * @brief Check the interrupts taken by every core, and print their latency.
+ */
+static void prvCheckIrqLatency( const char * pcLoad,
+                                uint32_t ulElapsedTime );
+
+/**
+ * @brief Add a sample to a set.
+ */
+static void prvRecordSample( SampleSet_t * pxSet,
+                             uint32_t ulSample );
+
+/**
+ * @brief Convert counts of ulTestPerfGetCounter() to nanoseconds.
+ */
+static uint32_t prvCountsToNs( uint64_t ullCounts );
+
+/**
+ * @brief Print the minimum, median, 99th percentile and worst of a sample set.
+ *
+ * The samples are sorted in place.
+ */
+static void prvReportSamples( const char * pcTest,
+                              const char * pcLoad,
+                              uint32_t ulCore,
+                              SampleSet_t * pxSet );
+
+/**
+ * @brief Test case "Interrupt latency without load".
+ */
+void Test_InterruptLatencyBaseline( void );
+
+/**
+ * @brief Test case "Interrupt latency with critical section contention".
+ */
+void Test_InterruptLoadCriticalSections( void );
+
+/**
+ * @brief Test case "Interrupt latency with queue traffic".
+ */
+void Test_InterruptLoadQueues( void );
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES < 2 )
+    #error This test is for FreeRTOS SMP and therefore, requires at least 2 cores.
+#endif /* if ( configNUMBER_OF_CORES < 2 ) */
+
+#if ( configUSE_CORE_AFFINITY != 1 )
+    #error test_config.h must be included at the end of FreeRTOSConfig.h.
+#endif /* if ( configUSE_CORE_AFFINITY != 1 ) */
+
+#if ( configMAX_PRIORITIES <= 3 )
+    #error configMAX_PRIORITIES must be larger than 3 to avoid scheduling idle tasks unexpectedly.
+#endif /* if ( configMAX_PRIORITIES <= 3 ) */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Handles of the tasks created in this test.
+ */
+static TaskHandle_t xTaskHandles[ TEST_IRQ_LOAD_MAX_TASKS ];
+
+/**
+ * @brief Number of valid entries in xTaskHandles.
+ */
+static uint32_t ulTaskCount = 0;
+
+/**
+ * @brief Handle of the test runner task, notified by the other tasks when
+ * they are done.
+ */
+static TaskHandle_t xTestRunnerTaskHandle;
+
+/**
+ * @brief Set by the test runner task to start the loading tasks.
+ */
+static volatile BaseType_t xStart = pdFALSE;
+
+/**
+ * @brief Set by the test runner task to stop the loading tasks.
+ */
+static volatile BaseType_t xStop = pdFALSE;
+
+/**
+ * @brief Set while the interrupt handler is to record and load.
+ */
+static volatile BaseType_t xMeasuring = pdFALSE;
+
+/**
+ * @brief Whether the interrupt is started on the cores.
+ */
+static BaseType_t xIrqLoadStarted = pdFALSE;
+
+/**
+ * @brief The parameter of prvIrqControlTask().
+ */
+static BaseType_t xIrqLoadEnable;
+
+/**
+ * @brief Interrupt latency of each core.
+ */
+static SampleSet_t xIrqLatency[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Time the interrupt handler of each core waits to enter the critical
+ * section.
+ */
+static SampleSet_t xIsrCriticalWait[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Time the task of each core waits to enter the critical section.
+ */
+static SampleSet_t xCriticalWait[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Time the task of each core holds the critical section.
+ */
+static SampleSet_t xCriticalHold[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Time from the interrupt sending an item until a task receives it.
+ */
+static SampleSet_t xIsrToTask;
+
+/**
+ * @brief Counter incremented in critical sections by all cores.
+ */
+static volatile uint32_t ulSharedCounter;
+
+/**
+ * @brief Increments of ulSharedCounter done by the tasks and the interrupt
+ * handler of each core.
+ */
+static volatile uint32_t ulTaskIncrements[ configNUMBER_OF_CORES ];
+static volatile uint32_t ulIsrIncrements[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Queues of the producer and consumer pairs.
+ */
+static QueueHandle_t xQueues[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Items sent by each producer and received by each consumer.
+ */
+static volatile uint32_t ulSent[ configNUMBER_OF_CORES ];
+static volatile uint32_t ulReceived[ configNUMBER_OF_CORES ];
+
+/**
+ * @brief Queue the interrupt handler sends to, or NULL.
+ */
+static QueueHandle_t xIsrQueue;
+
+/**
+ * @brief Items sent and dropped by the interrupt handler of each core, and
+ * received from it.
+ */
+static volatile uint32_t ulIsrSent[ configNUMBER_OF_CORES ];
+static volatile uint32_t ulIsrDropped[ configNUMBER_OF_CORES ];
+static volatile uint32_t ulIsrReceived;
+
+/**
+ * @brief Indexes passed to the tasks as their parameter.
+ */
+static uint32_t ulTaskIndexes[ configNUMBER_OF_CORES ];
+/*-----------------------------------------------------------*/
+
+void vTestIrqLoadHandler( uint32_t ulDueTime )
+{
+    uint32_t ulNow = ulTestPerfGetCounter();
+    uint32_t ulLocked;
+    UBaseType_t uxCore = portGET_CORE_ID();
+    UBaseType_t uxSavedInterruptStatus;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if( xMeasuring != pdFALSE )
+    {
+        /* The counter may be read a tick early. */
+        prvRecordSample( &( xIrqLatency[ uxCore ] ),
+                         ( ( int32_t ) ( ulNow - ulDueTime ) > 0 ) ? ( ulNow - ulDueTime ) : 0U );
+
+        /* Contend with the tasks and the other cores for the kernel locks. */
+        uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+        {
+            ulLocked = ulTestPerfGetCounter();
+            ulSharedCounter++;
+        }
+        taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+        ulIsrIncrements[ uxCore ]++;
+        prvRecordSample( &( xIsrCriticalWait[ uxCore ] ), ulLocked - ulNow );
+
+        if( xIsrQueue != NULL )
+        {
+            if( xQueueSendFromISR( xIsrQueue, &ulNow, &xHigherPriorityTaskWoken ) == pdPASS )
+            {
+                ulIsrSent[ uxCore ]++;
+            }
+            else
+            {
+                ulIsrDropped[ uxCore ]++;
+            }
+
+            portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordSample( SampleSet_t * pxSet,
+                             uint32_t ulSample )
+{
+    /* Each set is only written by one core, from either a task or the
+     * interrupt handler. */
+    pxSet->ulSamples[ pxSet->ulTotal % TEST_IRQ_LOAD_SAMPLES ] = ulSample;
+    pxSet->ulTotal++;
+
+    if( ulSample > pxSet->ulWorst )
+    {
+        pxSet->ulWorst = ulSample;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCreateTask( TaskFunction_t pxTaskCode,
+                           void * pvParameters,
+                           UBaseType_t uxCoreAffinityMask )
+{
+    BaseType_t xTaskCreationResult;
+
+    TEST_ASSERT_LESS_THAN_UINT32( TEST_IRQ_LOAD_MAX_TASKS, ulTaskCount );
+
+    xTaskCreationResult = xTaskCreateAffinitySet( pxTaskCode,
+                                                  "LoadTask",
+                                                  configMINIMAL_STACK_SIZE,
+                                                  pvParameters,
+                                                  TEST_IRQ_LOAD_PRIORITY,
+                                                  uxCoreAffinityMask,
+                                                  &( xTaskHandles[ ulTaskCount ] ) );
+
+    TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xTaskCreationResult, "Task creation failed." );
+
+    ulTaskCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForTasks( uint32_t ulCount )
+{
+    uint32_t i;
+    uint32_t ulNotificationValue;
+
+    for( i = 0; i < ulCount; i++ )
+    {
+        ulNotificationValue = ulTaskNotifyTake( pdFALSE, pdMS_TO_TICKS( TEST_TIMEOUT_MS ) );
+        TEST_ASSERT_NOT_EQUAL_MESSAGE( 0U, ulNotificationValue, "Measurement timed out." );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeleteTasks( void )
+{
+    uint32_t i;
+
+    for( i = 0; i < ulTaskCount; i++ )
+    {
+        if( xTaskHandles[ i ] != NULL )
+        {
+            vTaskDelete( xTaskHandles[ i ] );
+            xTaskHandles[ i ] = NULL;
+        }
+    }
+
+    ulTaskCount = 0;
+    xStart = pdFALSE;
+    xStop = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvIrqControlTask( void * pvParameters )
+{
+    /* pvParameters is not used in this task. */
+    ( void ) pvParameters;
+
+    /* The interrupt is started and stopped on the calling core. */
+    if( xIrqLoadEnable != pdFALSE )
+    {
+        vTestIrqLoadStart( TEST_IRQ_LOAD_PERIOD_US );
+    }
+    else
+    {
+        vTestIrqLoadStop();
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetIrqLoad( BaseType_t xEnable )
+{
+    BaseType_t xTaskCreationResult;
+    UBaseType_t uxCore;
+
+    xIrqLoadEnable = xEnable;
+
+    for( uxCore = 0; uxCore < configNUMBER_OF_CORES; uxCore++ )
+    {
+        /* Above the loading tasks, so it runs on its core right away. */
+        xTaskCreationResult = xTaskCreateAffinitySet( prvIrqControlTask,
+                                                      "IrqControl",
+                                                      configMINIMAL_STACK_SIZE,
+                                                      NULL,
+                                                      configMAX_PRIORITIES - 1,
+                                                      ( 1U << uxCore ),
+                                                      NULL );
+        TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xTaskCreationResult, "Task creation failed." );
+    }
+
+    prvWaitForTasks( configNUMBER_OF_CORES );
+
+    xIrqLoadStarted = xEnable;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRunMeasurement( uint32_t ulTasksToWaitFor )
+{
+    uint32_t ulStartTime;
+    uint32_t ulElapsedTime;
+
+    prvSetIrqLoad( pdTRUE );
+
+    ulStartTime = ulTestPerfGetCounter();
+    xMeasuring = pdTRUE;
+    xStart = pdTRUE;
+
+    vTaskDelay( pdMS_TO_TICKS( TEST_IRQ_LOAD_WINDOW_MS ) );
+
+    xMeasuring = pdFALSE;
+    ulElapsedTime = ulTestPerfGetCounter() - ulStartTime;
+
+    /* Once the interrupt is stopped on a core, its handler is not running
+     * there anymore. */
+    prvSetIrqLoad( pdFALSE );
+
+    xStop = pdTRUE;
+    prvWaitForTasks( ulTasksToWaitFor );
+
+    return ulElapsedTime;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCountsToNs( uint64_t ullCounts )
+{
+    return ( uint32_t ) ( ( ullCounts * 1000000000ULL ) / ulTestPerfGetCounterHz() );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportSamples( const char * pcTest,
+                              const char * pcLoad,
+                              uint32_t ulCore,
+                              SampleSet_t * pxSet )
+{
+    uint32_t i, j;
+    uint32_t ulSample;
+    uint32_t ulCount;
+    uint32_t * pulSamples = pxSet->ulSamples;
+
+    ulCount = ( pxSet->ulTotal < TEST_IRQ_LOAD_SAMPLES ) ? pxSet->ulTotal : TEST_IRQ_LOAD_SAMPLES;
+    TEST_ASSERT_TRUE( ulCount > 0U );
+
+    /* Insertion sort, the sample counts are small. */
+    for( i = 1; i < ulCount; i++ )
+    {
+        ulSample = pulSamples[ i ];
+
+        for( j = i; ( j > 0U ) && ( pulSamples[ j - 1U ] > ulSample ); j-- )
+        {
+            pulSamples[ j ] = pulSamples[ j - 1U ];
+        }
+
+        pulSamples[ j ] = ulSample;
+    }
+
+    printf( "PERF {\"kernel\":\"%s\",\"test\":\"%s\",\"load\":\"%s\",\"core\":%lu,\"samples\":%lu,"
+            "\"min_ns\":%lu,\"p50_ns\":%lu,\"p99_ns\":%lu,\"worst_ns\":%lu}\n",
+            tskKERNEL_VERSION_NUMBER,
+            pcTest,
+            pcLoad,
+            ( unsigned long ) ulCore,
+            ( unsigned long ) pxSet->ulTotal,
+            ( unsigned long ) prvCountsToNs( pulSamples[ 0 ] ),
+            ( unsigned long ) prvCountsToNs( pulSamples[ ulCount / 2U ] ),
+            ( unsigned long ) prvCountsToNs( pulSamples[ ( ulCount * 99U ) / 100U ] ),
+            ( unsigned long ) prvCountsToNs( pxSet->ulWorst ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckIrqLatency( const char * pcLoad,
+                                uint32_t ulElapsedTime )
+{
+    uint32_t ulCore;
+    uint32_t ulExpected;
+    uint32_t ulMaxLatency;
+
+    ulExpected = ( uint32_t ) ( ( ( uint64_t ) ulElapsedTime * 1000000ULL ) /
+                                ( ( uint64_t ) ulTestPerfGetCounterHz() * TEST_IRQ_LOAD_PERIOD_US ) );
+    ulMaxLatency = ( uint32_t ) ( ( ( uint64_t ) TEST_IRQ_LOAD_MAX_LATENCY_US * ulTestPerfGetCounterHz() ) / 1000000ULL );
+
+    for( ulCore = 0; ulCore < configNUMBER_OF_CORES; ulCore++ )
+    {
+        prvReportSamples( "irq_latency", pcLoad, ulCore, &( xIrqLatency[ ulCore ] ) );
+        prvReportSamples( "isr_critical_wait", pcLoad, ulCore, &( xIsrCriticalWait[ ulCore ] ) );
+
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32_MESSAGE( ulExpected / 2U, xIrqLatency[ ulCore ].ulTotal,
+                                                     "A core missed too many interrupts." );
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE( ulMaxLatency, xIrqLatency[ ulCore ].ulWorst,
+                                                  "The interrupt latency is too long." );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvCriticalSectionTask( void * pvParameters )
+{
+    uint32_t ulCore = *( ( uint32_t * ) pvParameters );
+    uint32_t ulRequested, ulEntered, ulLeaving;
+    uint32_t i;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    while( xStop == pdFALSE )
+    {
+        ulRequested = ulTestPerfGetCounter();
+        taskENTER_CRITICAL();
+        {
+            ulEntered = ulTestPerfGetCounter();
+            ulSharedCounter++;
+
+            for( i = 0; i < TEST_IRQ_LOAD_CRITICAL_WORK; i++ )
+            {
+                TEST_NOP();
+            }
+
+            ulLeaving = ulTestPerfGetCounter();
+        }
+        taskEXIT_CRITICAL();
+
+        ulTaskIncrements[ ulCore ]++;
+
+        if( xMeasuring != pdFALSE )
+        {
+            prvRecordSample( &( xCriticalWait[ ulCore ] ), ulEntered - ulRequested );
+            prvRecordSample( &( xCriticalHold[ ulCore ] ), ulLeaving - ulEntered );
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint32_t ulPairIndex = *( ( uint32_t * ) pvParameters );
+    uint32_t ulItem = 0;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    while( xStop == pdFALSE )
+    {
+        if( xQueueSend( xQueues[ ulPairIndex ], &ulItem, pdMS_TO_TICKS( 10 ) ) == pdPASS )
+        {
+            ulItem++;
+            ulSent[ ulPairIndex ]++;
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    uint32_t ulPairIndex = *( ( uint32_t * ) pvParameters );
+    uint32_t ulItem;
+    uint32_t ulExpectedItem = 0;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    while( xStop == pdFALSE )
+    {
+        if( xQueueReceive( xQueues[ ulPairIndex ], &ulItem, pdMS_TO_TICKS( 10 ) ) == pdPASS )
+        {
+            /* Items must arrive in order and exactly once. */
+            configASSERT( ulItem == ulExpectedItem );
+            ulExpectedItem++;
+            ulReceived[ ulPairIndex ]++;
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvIsrConsumerTask( void * pvParameters )
+{
+    uint32_t ulSentTime;
+
+    /* pvParameters is not used in this task. */
+    ( void ) pvParameters;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    while( xStop == pdFALSE )
+    {
+        if( xQueueReceive( xIsrQueue, &ulSentTime, pdMS_TO_TICKS( 10 ) ) == pdPASS )
+        {
+            prvRecordSample( &xIsrToTask, ulTestPerfGetCounter() - ulSentTime );
+            ulIsrReceived++;
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+void Test_InterruptLatencyBaseline( void )
+{
+    uint32_t ulElapsedTime;
+
+    ulElapsedTime = prvRunMeasurement( 0U );
+
+    prvCheckIrqLatency( "none", ulElapsedTime );
+}
+/*-----------------------------------------------------------*/
+
+void Test_InterruptLoadCriticalSections( void )
+{
+    uint32_t ulCore;
+    uint32_t ulElapsedTime;
+    uint32_t ulIncrements = 0;
+
+    for( ulCore = 0; ulCore < configNUMBER_OF_CORES; ulCore++ )
+    {
+        prvCreateTask( prvCriticalSectionTask, &( ulTaskIndexes[ ulCore ] ), ( 1U << ulCore ) );
+    }
+
+    ulElapsedTime = prvRunMeasurement( configNUMBER_OF_CORES );
+
+    prvCheckIrqLatency( "critical", ulElapsedTime );
+
+    for( ulCore = 0; ulCore < configNUMBER_OF_CORES; ulCore++ )
+    {
+        prvReportSamples( "critical_wait", "critical", ulCore, &( xCriticalWait[ ulCore ] ) );
+        prvReportSamples( "critical_hold", "critical", ulCore, &( xCriticalHold[ ulCore ] ) );
+
+        ulIncrements += ulTaskIncrements[ ulCore ] + ulIsrIncrements[ ulCore ];
+    }
+
+    /* An increment is lost if two cores were in the critical section at the
+     * same time. */
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE( ulIncrements, ulSharedCounter, "Critical sections overlapped." );
+}
+/*-----------------------------------------------------------*/
+
+void Test_InterruptLoadQueues( void )
+{
+    uint32_t ulCore;
+    uint32_t ulElapsedTime;
+    uint32_t ulIsrSentTotal = 0;
+    uint32_t ulIsrDroppedTotal = 0;
+    uint32_t ulReceivedTotal = 0;
+
+    xIsrQueue = xQueueCreate( TEST_IRQ_LOAD_QUEUE_LENGTH, sizeof( uint32_t ) );
+    TEST_ASSERT_NOT_NULL( xIsrQueue );
+
+    for( ulCore = 0; ulCore < configNUMBER_OF_CORES; ulCore++ )
+    {
+        xQueues[ ulCore ] = xQueueCreate( TEST_IRQ_LOAD_QUEUE_LENGTH, sizeof( uint32_t ) );
+        TEST_ASSERT_NOT_NULL( xQueues[ ulCore ] );
+
+        /* Each producer sends to a consumer on the next core. */
+        prvCreateTask( prvProducerTask, &( ulTaskIndexes[ ulCore ] ), ( 1U << ulCore ) );
+        prvCreateTask( prvConsumerTask, &( ulTaskIndexes[ ulCore ] ), ( 1U << ( ( ulCore + 1U ) % configNUMBER_OF_CORES ) ) );
+    }
+
+    prvCreateTask( prvIsrConsumerTask, NULL, tskNO_AFFINITY );
+
+    ulElapsedTime = prvRunMeasurement( ( 2U * configNUMBER_OF_CORES ) + 1U );
+
+    prvCheckIrqLatency( "queues", ulElapsedTime );
+
+    for( ulCore = 0; ulCore < configNUMBER_OF_CORES; ulCore++ )
+    {
+        TEST_ASSERT_TRUE( ulReceived[ ulCore ] > 0U );
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE( ulSent[ ulCore ],
+                                          ulReceived[ ulCore ] + ( uint32_t ) uxQueueMessagesWaiting( xQueues[ ulCore ] ),
+                                          "Queue items were lost." );
+
+        ulReceivedTotal += ulReceived[ ulCore ];
+        ulIsrSentTotal += ulIsrSent[ ulCore ];
+        ulIsrDroppedTotal += ulIsrDropped[ ulCore ];
+    }
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE( ulIsrSentTotal,
+                                      ulIsrReceived + ( uint32_t ) uxQueueMessagesWaiting( xIsrQueue ),
+                                      "Items sent from the interrupt were lost." );
+
+    prvReportSamples( "isr_to_task", "queues", 0U, &xIsrToTask );
+
+    printf( "PERF {\"kernel\":\"%s\",\"test\":\"queue_items\",\"load\":\"queues\",\"duration_ns\":%lu,"
+            "\"isr_sent\":%lu,\"isr_dropped\":%lu,\"task_received\":%lu}\n",
+            tskKERNEL_VERSION_NUMBER,
+            ( unsigned long ) prvCountsToNs( ulElapsedTime ),
+            ( unsigned long ) ulIsrSentTotal,
+            ( unsigned long ) ulIsrDroppedTotal,
+            ( unsigned long ) ulReceivedTotal );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs before every test, put init calls here. */
+void setUp( void )
+{
+    uint32_t i;
+
+    xTestRunnerTaskHandle = xTaskGetCurrentTaskHandle();
+    xStart = pdFALSE;
+    xStop = pdFALSE;
+    xMeasuring = pdFALSE;
+    xIsrQueue = NULL;
+    ulSharedCounter = 0;
+    ulIsrReceived = 0;
+    ulTaskCount = 0;
+    memset( &xIsrToTask, 0x00, sizeof( xIsrToTask ) );
+
+    for( i = 0; i < TEST_IRQ_LOAD_MAX_TASKS; i++ )
+    {
+        xTaskHandles[ i ] = NULL;
+    }
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        ulTaskIndexes[ i ] = i;
+        xQueues[ i ] = NULL;
+        ulTaskIncrements[ i ] = 0;
+        ulIsrIncrements[ i ] = 0;
+        ulSent[ i ] = 0;
+        ulReceived[ i ] = 0;
+        ulIsrSent[ i ] = 0;
+        ulIsrDropped[ i ] = 0;
+        memset( &( xIrqLatency[ i ] ), 0x00, sizeof( SampleSet_t ) );
+        memset( &( xIsrCriticalWait[ i ] ), 0x00, sizeof( SampleSet_t ) );
+        memset( &( xCriticalWait[ i ] ), 0x00, sizeof( SampleSet_t ) );
+        memset( &( xCriticalHold[ i ] ), 0x00, sizeof( SampleSet_t ) );
+    }
+
+    /* Drop notifications left over from a failed measurement. */
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs after every test, put clean-up calls here. */
+void tearDown( void )
+{
+    uint32_t i;
+
+    xMeasuring = pdFALSE;
+
+    /* Stop the interrupt if a failed measurement left it running. */
+    if( xIrqLoadStarted != pdFALSE )
+    {
+        prvSetIrqLoad( pdFALSE );
+    }
+
+    /* Delete all the tasks created in the test. */
+    prvDeleteTasks();
+
+    for( i = 0; i < configNUMBER_OF_CORES; i++ )
+    {
+        if( xQueues[ i ] != NULL )
+        {
+            vQueueDelete( xQueues[ i ] );
+            xQueues[ i ] = NULL;
+        }
+    }
+
+    if( xIsrQueue != NULL )
+    {
+        vQueueDelete( xIsrQueue );
+        xIsrQueue = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Entry point for test runner to run interrupt load test.
+ */
+void vRunInterruptLoadTest( void )
+{
+    UNITY_BEGIN();
+
+    RUN_TEST( Test_InterruptLatencyBaseline );
+    RUN_TEST( Test_InterruptLoadCriticalSections );
+    RUN_TEST( Test_InterruptLoadQueues );
+
+    UNITY_END();
+}
+/*-----------------------------------------------------------*/
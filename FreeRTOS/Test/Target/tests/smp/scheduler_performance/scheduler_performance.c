@@ -0,0 +1,887 @@
+/*
+ * FreeRTOS V202212.00
+ * Copyright (C) 2022 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/**
+ * @file scheduler_performance.c
+ * @brief Measure how the SMP scheduler performs as the number of cores in use
+ * grows.
+ *
+ * Procedure:
+ *   - Cross core context switch: a task on core 0 resumes a suspended task
+ *     pinned to core 1, which preempts a lower priority task running there.
+ *     The time from the resume call until the resumed task runs is sampled.
+ *   - Yield: a pair of equal priority tasks pinned to each of the first n
+ *     cores yield to each other, for n = 1 ~ configNUMBER_OF_CORES.
+ *   - Suspend all: a task pinned to each of the first n cores suspends and
+ *     resumes the scheduler in a loop, for n = 1 ~ configNUMBER_OF_CORES.
+ *   - Cross core notification: a task on core 0 gives a notification to a
+ *     task blocked on core 1, which gives one back.  The one way and the round
+ *     trip times are sampled.
+ *   - Producer consumer: TEST_PERF_PAIRS producer and consumer pairs exchange
+ *     items through queues on the first n cores for TEST_PERF_WINDOW_MS, for
+ *     n = 1 ~ configNUMBER_OF_CORES.
+ * Expected:
+ *   - Each measurement completes within TEST_TIMEOUT_MS and prints its
+ *     figures as a line of the form:
+ *     PERF {"kernel":"V11.0.0","test":"yield","cores":2,...}
+ *     Times are in nanoseconds, measured with ulTestPerfGetCounter().  The
+ *     yield and suspend all rates are per core, the producer consumer rate
+ *     is the total of all pairs.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Unit testing support functions. */
+#include "unity.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Timeout for each measurement.
+ */
+#define TEST_TIMEOUT_MS    ( 10000U )
+
+/**
+ * @brief Number of latency samples taken by the cross core measurements.
+ */
+#ifndef TEST_PERF_SAMPLES
+    #define TEST_PERF_SAMPLES    ( 500U )
+#endif
+
+/**
+ * @brief Number of operations each task does in the yield and suspend all
+ * measurements.
+ */
+#ifndef TEST_PERF_ITERATIONS
+    #define TEST_PERF_ITERATIONS    ( 10000U )
+#endif
+
+/**
+ * @brief Number of producer and consumer pairs.
+ */
+#ifndef TEST_PERF_PAIRS
+    #define TEST_PERF_PAIRS    ( configNUMBER_OF_CORES )
+#endif
+
+/**
+ * @brief Length of the queue of each producer and consumer pair.
+ */
+#ifndef TEST_PERF_QUEUE_LENGTH
+    #define TEST_PERF_QUEUE_LENGTH    ( 8U )
+#endif
+
+/**
+ * @brief Time in milliseconds the producer consumer throughput is measured for.
+ */
+#ifndef TEST_PERF_WINDOW_MS
+    #define TEST_PERF_WINDOW_MS    ( 1000U )
+#endif
+
+/**
+ * @brief Priority of the measuring tasks, below the test runner task.
+ */
+#define TEST_PERF_PRIORITY               ( configMAX_PRIORITIES - 2 )
+
+/**
+ * @brief Priority of the task the cross core context switch preempts.
+ */
+#define TEST_PERF_BACKGROUND_PRIORITY    ( configMAX_PRIORITIES - 3 )
+
+/**
+ * @brief Number of task handles kept for clean-up.
+ */
+#if ( TEST_PERF_PAIRS > configNUMBER_OF_CORES )
+    #define TEST_PERF_MAX_TASKS    ( 2 * TEST_PERF_PAIRS )
+#else
+    #define TEST_PERF_MAX_TASKS    ( 2 * configNUMBER_OF_CORES )
+#endif
+
+/**
+ * @brief Nop operation for busy looping.
+ */
+#ifdef portNOP
+    #define TEST_NOP    portNOP
+#else
+    #define TEST_NOP()    __asm volatile ( "nop" )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Task function which resumes the measured task in the cross core
+ * context switch measurement.
+ */
+static void prvWakeTask( void * pvParameters );
+
+/**
+ * @brief Task function which is resumed in the cross core context switch
+ * measurement.
+ */
+static void prvResumedTask( void * pvParameters );
+
+/**
+ * @brief Task function to occupy a core.
+ */
+static void prvBusyRunningTask( void * pvParameters );
+
+/**
+ * @brief Task function of the yield measurement.
+ */
+static void prvYieldTask( void * pvParameters );
+
+/**
+ * @brief Task function of the suspend all measurement.
+ */
+static void prvSuspendAllTask( void * pvParameters );
+
+/**
+ * @brief Task function which sends the notifications in the cross core
+ * notification measurement.
+ */
+static void prvPingTask( void * pvParameters );
+
+/**
+ * @brief Task function which answers the notifications in the cross core
+ * notification measurement.
+ */
+static void prvPongTask( void * pvParameters );
+
+/**
+ * @brief Task function of a producer.
+ */
+static void prvProducerTask( void * pvParameters );
+
+/**
+ * @brief Task function of a consumer.
+ */
+static void prvConsumerTask( void * pvParameters );
+
+/**
+ * @brief Create a measuring task and keep its handle for clean-up.
+ */
+static void prvCreateTask( TaskFunction_t pxTaskCode,
+                           void * pvParameters,
+                           UBaseType_t uxPriority,
+                           UBaseType_t uxCoreAffinityMask );
+
+/**
+ * @brief Wait for ulCount tasks to notify the test runner task.
+ */
+static void prvWaitForTasks( uint32_t ulCount );
+
+/**
+ * @brief Delete the tasks created by prvCreateTask().
+ */
+static void prvDeleteTasks( void );
+
+/**
+ * @brief Convert counts of ulTestPerfGetCounter() spent on ullOperations
+ * operations to nanoseconds per operation.
+ */
+static uint32_t prvCountsToNs( uint64_t ullCounts,
+                               uint64_t ullOperations );
+
+/**
+ * @brief Print the minimum, median, 99th percentile and maximum of samples.
+ *
+ * The samples are sorted in place.
+ */
+static void prvReportSamples( const char * pcTest,
+                              uint32_t ulCores,
+                              uint32_t * pulSamples,
+                              uint32_t ulCount );
+
+/**
+ * @brief Print the cost of one operation and the operations per second.
+ *
+ * ullCounts is the time all the operations took; when it is the sum of the
+ * times of tasks running in parallel, the rate is that of one core.
+ */
+static void prvReportRate( const char * pcTest,
+                           uint32_t ulCores,
+                           uint64_t ullOperations,
+                           uint64_t ullCounts );
+
+/**
+ * @brief Test case "Cross core context switch latency".
+ */
+void Test_CrossCoreContextSwitch( void );
+
+/**
+ * @brief Test case "Yield cost".
+ */
+void Test_YieldCost( void );
+
+/**
+ * @brief Test case "Suspend all contention".
+ */
+void Test_SuspendAllContention( void );
+
+/**
+ * @brief Test case "Cross core notification latency".
+ */
+void Test_CrossCoreNotification( void );
+
+/**
+ * @brief Test case "Producer consumer throughput".
+ */
+void Test_ProducerConsumerThroughput( void );
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES < 2 )
+    #error This test is for FreeRTOS SMP and therefore, requires at least 2 cores.
+#endif /* if ( configNUMBER_OF_CORES < 2 ) */
+
+#if ( configUSE_CORE_AFFINITY != 1 )
+    #error test_config.h must be included at the end of FreeRTOSConfig.h.
+#endif /* if ( configUSE_CORE_AFFINITY != 1 ) */
+
+#if ( configMAX_PRIORITIES <= 3 )
+    #error configMAX_PRIORITIES must be larger than 3 to avoid scheduling idle tasks unexpectedly.
+#endif /* if ( configMAX_PRIORITIES <= 3 ) */
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Handles of the tasks created in this test.
+ */
+static TaskHandle_t xTaskHandles[ TEST_PERF_MAX_TASKS ];
+
+/**
+ * @brief Number of valid entries in xTaskHandles.
+ */
+static uint32_t ulTaskCount = 0;
+
+/**
+ * @brief Handle of the test runner task, notified by the measuring tasks when
+ * they are done.
+ */
+static TaskHandle_t xTestRunnerTaskHandle;
+
+/**
+ * @brief Handles of the tasks which notify each other, or are resumed.
+ */
+static TaskHandle_t xPingTaskHandle;
+static TaskHandle_t xPongTaskHandle;
+
+/**
+ * @brief Set by the test runner task to start a measurement.
+ */
+static volatile BaseType_t xStart = pdFALSE;
+
+/**
+ * @brief Set by the test runner task to stop a measurement.
+ */
+static volatile BaseType_t xStop = pdFALSE;
+
+/**
+ * @brief Counter value at the time the measured task was resumed or notified.
+ */
+static volatile uint32_t ulSignalTime;
+
+/**
+ * @brief Number of samples taken so far by the resumed task.
+ */
+static volatile uint32_t ulSamplesTaken;
+
+/**
+ * @brief Latency samples.
+ */
+static uint32_t ulSamples[ TEST_PERF_SAMPLES ];
+
+/**
+ * @brief Round trip samples of the cross core notification measurement.
+ */
+static uint32_t ulRoundTripSamples[ TEST_PERF_SAMPLES ];
+
+/**
+ * @brief Counts each task of the yield and suspend all measurements took.
+ */
+static volatile uint32_t ulElapsed[ TEST_PERF_MAX_TASKS ];
+
+/**
+ * @brief Indexes passed to the tasks as their parameter.
+ */
+static uint32_t ulTaskIndexes[ TEST_PERF_MAX_TASKS ];
+
+/**
+ * @brief Queues of the producer and consumer pairs.
+ */
+static QueueHandle_t xQueues[ TEST_PERF_PAIRS ];
+
+/**
+ * @brief Items received by each consumer.
+ */
+static volatile uint32_t ulReceived[ TEST_PERF_PAIRS ];
+/*-----------------------------------------------------------*/
+
+static void prvCreateTask( TaskFunction_t pxTaskCode,
+                           void * pvParameters,
+                           UBaseType_t uxPriority,
+                           UBaseType_t uxCoreAffinityMask )
+{
+    BaseType_t xTaskCreationResult;
+
+    TEST_ASSERT_LESS_THAN_UINT32( TEST_PERF_MAX_TASKS, ulTaskCount );
+
+    xTaskCreationResult = xTaskCreateAffinitySet( pxTaskCode,
+                                                  "PerfTask",
+                                                  configMINIMAL_STACK_SIZE,
+                                                  pvParameters,
+                                                  uxPriority,
+                                                  uxCoreAffinityMask,
+                                                  &( xTaskHandles[ ulTaskCount ] ) );
+
+    TEST_ASSERT_EQUAL_MESSAGE( pdPASS, xTaskCreationResult, "Task creation failed." );
+
+    ulTaskCount++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForTasks( uint32_t ulCount )
+{
+    uint32_t i;
+    uint32_t ulNotificationValue;
+
+    for( i = 0; i < ulCount; i++ )
+    {
+        ulNotificationValue = ulTaskNotifyTake( pdFALSE, pdMS_TO_TICKS( TEST_TIMEOUT_MS ) );
+        TEST_ASSERT_NOT_EQUAL_MESSAGE( 0U, ulNotificationValue, "Measurement timed out." );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvDeleteTasks( void )
+{
+    uint32_t i;
+
+    for( i = 0; i < ulTaskCount; i++ )
+    {
+        if( xTaskHandles[ i ] != NULL )
+        {
+            vTaskDelete( xTaskHandles[ i ] );
+            xTaskHandles[ i ] = NULL;
+        }
+    }
+
+    ulTaskCount = 0;
+    xStart = pdFALSE;
+    xStop = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCountsToNs( uint64_t ullCounts,
+                               uint64_t ullOperations )
+{
+    return ( uint32_t ) ( ( ullCounts * 1000000000ULL ) / ( ullOperations * ulTestPerfGetCounterHz() ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportSamples( const char * pcTest,
+                              uint32_t ulCores,
+                              uint32_t * pulSamples,
+                              uint32_t ulCount )
+{
+    uint32_t i, j;
+    uint32_t ulSample;
+    uint64_t ullSum = 0;
+
+    /* Insertion sort, the sample counts are small. */
+    for( i = 1; i < ulCount; i++ )
+    {
+        ulSample = pulSamples[ i ];
+
+        for( j = i; ( j > 0U ) && ( pulSamples[ j - 1U ] > ulSample ); j-- )
+        {
+            pulSamples[ j ] = pulSamples[ j - 1U ];
+        }
+
+        pulSamples[ j ] = ulSample;
+    }
+
+    for( i = 0; i < ulCount; i++ )
+    {
+        ullSum += pulSamples[ i ];
+    }
+
+    printf( "PERF {\"kernel\":\"%s\",\"test\":\"%s\",\"cores\":%lu,\"samples\":%lu,"
+            "\"min_ns\":%lu,\"avg_ns\":%lu,\"p50_ns\":%lu,\"p99_ns\":%lu,\"max_ns\":%lu}\n",
+            tskKERNEL_VERSION_NUMBER,
+            pcTest,
+            ( unsigned long ) ulCores,
+            ( unsigned long ) ulCount,
+            ( unsigned long ) prvCountsToNs( pulSamples[ 0 ], 1U ),
+            ( unsigned long ) prvCountsToNs( ullSum, ulCount ),
+            ( unsigned long ) prvCountsToNs( pulSamples[ ulCount / 2U ], 1U ),
+            ( unsigned long ) prvCountsToNs( pulSamples[ ( ulCount * 99U ) / 100U ], 1U ),
+            ( unsigned long ) prvCountsToNs( pulSamples[ ulCount - 1U ], 1U ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportRate( const char * pcTest,
+                           uint32_t ulCores,
+                           uint64_t ullOperations,
+                           uint64_t ullCounts )
+{
+    uint32_t ulOperationsPerSecond = 0;
+
+    if( ullCounts > 0U )
+    {
+        ulOperationsPerSecond = ( uint32_t ) ( ( ullOperations * ulTestPerfGetCounterHz() ) / ullCounts );
+    }
+
+    printf( "PERF {\"kernel\":\"%s\",\"test\":\"%s\",\"cores\":%lu,\"operations\":%lu,"
+            "\"ns_per_operation\":%lu,\"operations_per_second\":%lu}\n",
+            tskKERNEL_VERSION_NUMBER,
+            pcTest,
+            ( unsigned long ) ulCores,
+            ( unsigned long ) ullOperations,
+            ( unsigned long ) prvCountsToNs( ullCounts, ullOperations ),
+            ( unsigned long ) ulOperationsPerSecond );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWakeTask( void * pvParameters )
+{
+    uint32_t i;
+
+    /* pvParameters is not used in this task. */
+    ( void ) pvParameters;
+
+    for( i = 0; i < TEST_PERF_SAMPLES; i++ )
+    {
+        /* Wait for the resumed task to suspend itself again. */
+        while( eTaskGetState( xPongTaskHandle ) != eSuspended )
+        {
+            TEST_NOP();
+        }
+
+        ulSignalTime = ulTestPerfGetCounter();
+        vTaskResume( xPongTaskHandle );
+
+        /* Wait for the sample without calling into the kernel, which would
+         * contend for the kernel lock with the switch being measured. */
+        while( ulSamplesTaken <= i )
+        {
+            TEST_NOP();
+        }
+    }
+
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvResumedTask( void * pvParameters )
+{
+    uint32_t i;
+
+    /* pvParameters is not used in this task. */
+    ( void ) pvParameters;
+
+    for( i = 0; i < TEST_PERF_SAMPLES; i++ )
+    {
+        vTaskSuspend( NULL );
+        ulSamples[ i ] = ulTestPerfGetCounter() - ulSignalTime;
+        ulSamplesTaken = i + 1U;
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBusyRunningTask( void * pvParameters )
+{
+    /* pvParameters is not used in this task. */
+    ( void ) pvParameters;
+
+    /* Busy looping here to occupy the core. */
+    for( ; ; )
+    {
+        TEST_NOP();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldTask( void * pvParameters )
+{
+    uint32_t ulTaskIndex = *( ( uint32_t * ) pvParameters );
+    uint32_t ulStartTime;
+    uint32_t i;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    ulStartTime = ulTestPerfGetCounter();
+
+    for( i = 0; i < TEST_PERF_ITERATIONS; i++ )
+    {
+        taskYIELD();
+    }
+
+    ulElapsed[ ulTaskIndex ] = ulTestPerfGetCounter() - ulStartTime;
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendAllTask( void * pvParameters )
+{
+    uint32_t ulTaskIndex = *( ( uint32_t * ) pvParameters );
+    uint32_t ulStartTime;
+    uint32_t i;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    ulStartTime = ulTestPerfGetCounter();
+
+    for( i = 0; i < TEST_PERF_ITERATIONS; i++ )
+    {
+        vTaskSuspendAll();
+        ( void ) xTaskResumeAll();
+    }
+
+    ulElapsed[ ulTaskIndex ] = ulTestPerfGetCounter() - ulStartTime;
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPingTask( void * pvParameters )
+{
+    uint32_t ulStartTime;
+    uint32_t i;
+
+    /* pvParameters is not used in this task. */
+    ( void ) pvParameters;
+
+    for( i = 0; i < TEST_PERF_SAMPLES; i++ )
+    {
+        ulStartTime = ulTestPerfGetCounter();
+        ulSignalTime = ulStartTime;
+        xTaskNotifyGive( xPongTaskHandle );
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ulRoundTripSamples[ i ] = ulTestPerfGetCounter() - ulStartTime;
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPongTask( void * pvParameters )
+{
+    uint32_t i;
+
+    /* pvParameters is not used in this task. */
+    ( void ) pvParameters;
+
+    for( i = 0; i < TEST_PERF_SAMPLES; i++ )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        ulSamples[ i ] = ulTestPerfGetCounter() - ulSignalTime;
+        xTaskNotifyGive( xPingTaskHandle );
+    }
+
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvProducerTask( void * pvParameters )
+{
+    uint32_t ulPairIndex = *( ( uint32_t * ) pvParameters );
+    uint32_t ulItem = 0;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    while( xStop == pdFALSE )
+    {
+        if( xQueueSend( xQueues[ ulPairIndex ], &ulItem, pdMS_TO_TICKS( 10 ) ) == pdPASS )
+        {
+            ulItem++;
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvConsumerTask( void * pvParameters )
+{
+    uint32_t ulPairIndex = *( ( uint32_t * ) pvParameters );
+    uint32_t ulItem;
+
+    while( xStart == pdFALSE )
+    {
+        TEST_NOP();
+    }
+
+    while( xStop == pdFALSE )
+    {
+        if( xQueueReceive( xQueues[ ulPairIndex ], &ulItem, pdMS_TO_TICKS( 10 ) ) == pdPASS )
+        {
+            ulReceived[ ulPairIndex ]++;
+        }
+    }
+
+    xTaskNotifyGive( xTestRunnerTaskHandle );
+    vTaskSuspend( NULL );
+}
+/*-----------------------------------------------------------*/
+
+void Test_CrossCoreContextSwitch( void )
+{
+    /* Occupy core 1 with a lower priority task, so that each resume preempts
+     * it. */
+    prvCreateTask( prvBusyRunningTask, NULL, TEST_PERF_BACKGROUND_PRIORITY, ( 1U << 1 ) );
+
+    prvCreateTask( prvResumedTask, NULL, TEST_PERF_PRIORITY, ( 1U << 1 ) );
+    xPongTaskHandle = xTaskHandles[ ulTaskCount - 1U ];
+
+    prvCreateTask( prvWakeTask, NULL, TEST_PERF_PRIORITY, ( 1U << 0 ) );
+
+    prvWaitForTasks( 1U );
+
+    prvReportSamples( "cross_core_context_switch", 2U, ulSamples, TEST_PERF_SAMPLES );
+}
+/*-----------------------------------------------------------*/
+
+void Test_YieldCost( void )
+{
+    uint32_t ulCores;
+    uint32_t i;
+    uint64_t ullElapsed;
+
+    for( ulCores = 1; ulCores <= configNUMBER_OF_CORES; ulCores++ )
+    {
+        /* A pair of tasks on each core, so that each yield switches to the
+         * other task of the pair. */
+        for( i = 0; i < ( 2U * ulCores ); i++ )
+        {
+            ulElapsed[ i ] = 0;
+            prvCreateTask( prvYieldTask, &( ulTaskIndexes[ i ] ), TEST_PERF_PRIORITY, ( 1U << ( i % ulCores ) ) );
+        }
+
+        xStart = pdTRUE;
+        prvWaitForTasks( 2U * ulCores );
+
+        /* The loop of a task also spans the yields of the other task of its
+         * pair, so each loop takes twice as many switches as it yields. */
+        ullElapsed = 0;
+
+        for( i = 0; i < ( 2U * ulCores ); i++ )
+        {
+            ullElapsed += ulElapsed[ i ];
+        }
+
+        prvReportRate( "yield", ulCores, 2ULL * TEST_PERF_ITERATIONS * 2U * ulCores, ullElapsed );
+
+        prvDeleteTasks();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void Test_SuspendAllContention( void )
+{
+    uint32_t ulCores;
+    uint32_t i;
+    uint64_t ullElapsed;
+
+    for( ulCores = 1; ulCores <= configNUMBER_OF_CORES; ulCores++ )
+    {
+        for( i = 0; i < ulCores; i++ )
+        {
+            ulElapsed[ i ] = 0;
+            prvCreateTask( prvSuspendAllTask, &( ulTaskIndexes[ i ] ), TEST_PERF_PRIORITY, ( 1U << i ) );
+        }
+
+        xStart = pdTRUE;
+        prvWaitForTasks( ulCores );
+
+        ullElapsed = 0;
+
+        for( i = 0; i < ulCores; i++ )
+        {
+            ullElapsed += ulElapsed[ i ];
+        }
+
+        /* The cost of a vTaskSuspendAll() and xTaskResumeAll() pair, as seen
+         * by each core while the other cores do the same. */
+        prvReportRate( "suspend_all", ulCores, ( uint64_t ) TEST_PERF_ITERATIONS * ulCores, ullElapsed );
+
+        prvDeleteTasks();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void Test_CrossCoreNotification( void )
+{
+    prvCreateTask( prvPongTask, NULL, TEST_PERF_PRIORITY, ( 1U << 1 ) );
+    xPongTaskHandle = xTaskHandles[ ulTaskCount - 1U ];
+
+    prvCreateTask( prvPingTask, NULL, TEST_PERF_PRIORITY, ( 1U << 0 ) );
+    xPingTaskHandle = xTaskHandles[ ulTaskCount - 1U ];
+
+    prvWaitForTasks( 1U );
+
+    prvReportSamples( "cross_core_notify", 2U, ulSamples, TEST_PERF_SAMPLES );
+    prvReportSamples( "cross_core_notify_round_trip", 2U, ulRoundTripSamples, TEST_PERF_SAMPLES );
+}
+/*-----------------------------------------------------------*/
+
+void Test_ProducerConsumerThroughput( void )
+{
+    uint32_t ulCores;
+    uint32_t i;
+    uint32_t ulStartTime;
+    uint32_t ulElapsedTime;
+    uint64_t ullReceived;
+    UBaseType_t uxCoreAffinityMask;
+
+    for( i = 0; i < TEST_PERF_PAIRS; i++ )
+    {
+        xQueues[ i ] = xQueueCreate( TEST_PERF_QUEUE_LENGTH, sizeof( uint32_t ) );
+        TEST_ASSERT_NOT_NULL( xQueues[ i ] );
+    }
+
+    for( ulCores = 1; ulCores <= configNUMBER_OF_CORES; ulCores++ )
+    {
+        /* Let all the tasks run on any of the first ulCores cores. */
+        uxCoreAffinityMask = ( ( UBaseType_t ) 1U << ulCores ) - 1U;
+
+        for( i = 0; i < TEST_PERF_PAIRS; i++ )
+        {
+            ( void ) xQueueReset( xQueues[ i ] );
+            ulReceived[ i ] = 0;
+            prvCreateTask( prvProducerTask, &( ulTaskIndexes[ i ] ), TEST_PERF_PRIORITY, uxCoreAffinityMask );
+            prvCreateTask( prvConsumerTask, &( ulTaskIndexes[ i ] ), TEST_PERF_PRIORITY, uxCoreAffinityMask );
+        }
+
+        ulStartTime = ulTestPerfGetCounter();
+        xStart = pdTRUE;
+        vTaskDelay( pdMS_TO_TICKS( TEST_PERF_WINDOW_MS ) );
+
+        ullReceived = 0;
+
+        for( i = 0; i < TEST_PERF_PAIRS; i++ )
+        {
+            ullReceived += ulReceived[ i ];
+        }
+
+        ulElapsedTime = ulTestPerfGetCounter() - ulStartTime;
+
+        xStop = pdTRUE;
+        prvWaitForTasks( 2U * TEST_PERF_PAIRS );
+
+        TEST_ASSERT_TRUE( ullReceived > 0U );
+        prvReportRate( "producer_consumer", ulCores, ullReceived, ulElapsedTime );
+
+        prvDeleteTasks();
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Runs before every test, put init calls here. */
+void setUp( void )
+{
+    uint32_t i;
+
+    xTestRunnerTaskHandle = xTaskGetCurrentTaskHandle();
+    xPingTaskHandle = NULL;
+    xPongTaskHandle = NULL;
+    xStart = pdFALSE;
+    xStop = pdFALSE;
+    ulSamplesTaken = 0;
+    ulTaskCount = 0;
+
+    for( i = 0; i < TEST_PERF_MAX_TASKS; i++ )
+    {
+        ulTaskIndexes[ i ] = i;
+        xTaskHandles[ i ] = NULL;
+    }
+
+    for( i = 0; i < TEST_PERF_PAIRS; i++ )
+    {
+        xQueues[ i ] = NULL;
+    }
+
+    /* Drop notifications left over from a failed measurement. */
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs after every test, put clean-up calls here. */
+void tearDown( void )
+{
+    uint32_t i;
+
+    /* Delete all the tasks created in the test. */
+    prvDeleteTasks();
+
+    for( i = 0; i < TEST_PERF_PAIRS; i++ )
+    {
+        if( xQueues[ i ] != NULL )
+        {
+            vQueueDelete( xQueues[ i ] );
+            xQueues[ i ] = NULL;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Entry point for test runner to run scheduler performance test.
+ */
+void vRunSchedulerPerformanceTest( void )
+{
+    UNITY_BEGIN();
+
+    RUN_TEST( Test_CrossCoreContextSwitch );
+    RUN_TEST( Test_YieldCost );
+    RUN_TEST( Test_SuspendAllContention );
+    RUN_TEST( Test_CrossCoreNotification );
+    RUN_TEST( Test_ProducerConsumerThroughput );
+
+    UNITY_END();
+}
+/*-----------------------------------------------------------*/